@@ -0,0 +1,277 @@
+#!/usr/bin/env python3
+# Copyright 2023 The IREE Authors
+#
+# Licensed under the Apache License v2.0 with LLVM Exceptions.
+# See https://llvm.org/LICENSE.txt for license information.
+# SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+"""Runs the native benchmark suite and detects regressions against a baseline.
+
+The native benchmarks are the Google Benchmark binaries declared with
+`iree_cc_binary_benchmark` (ukernel, VM, HAL utility and synchronization
+benchmarks). They are all built by the `iree-native-benchmarks` target and
+listed in `native_benchmarks.txt` in the build directory.
+
+Each binary is run with repetitions and the per-repetition times are merged
+into one JSON file. When a baseline result file is given, the median time of
+every benchmark is compared against it. A benchmark regresses when it slows
+down by more than both `--threshold` and the noise of the two runs, estimated
+from the median absolute deviation of their repetitions, so noisy benchmarks
+need a larger change to be reported. The script exits with 1 if anything
+regressed.
+
+Example usage:
+  cmake --build ../iree-build --target iree-native-benchmarks
+  python3 run_native_benchmarks.py --build_dir=../iree-build \\
+    --output=base.json
+  # ... make changes and rebuild ...
+  python3 run_native_benchmarks.py --build_dir=../iree-build \\
+    --output=target.json --baseline=base.json
+
+  # Compare two existing result files without running anything:
+  python3 run_native_benchmarks.py --results=target.json --baseline=base.json
+"""
+
+import argparse
+import dataclasses
+import json
+import math
+import pathlib
+import re
+import statistics
+import subprocess
+import sys
+from typing import Dict, List, Optional, Sequence
+
+TIME_UNIT_TO_NS = {"ns": 1, "us": 1e3, "ms": 1e6, "s": 1e9}
+
+# Scales the median absolute deviation to the standard deviation of a normal
+# distribution.
+MAD_TO_STDDEV = 1.4826
+
+
+@dataclasses.dataclass
+class BenchmarkResult:
+  """Repetitions of a single benchmark case."""
+  # `<binary>/<benchmark name>`, unique across the suite.
+  name: str
+  samples_ns: List[float]
+
+  @property
+  def median_ns(self) -> float:
+    return statistics.median(self.samples_ns)
+
+  @property
+  def noise(self) -> float:
+    """Relative standard deviation of the samples estimated from the MAD."""
+    median = self.median_ns
+    if len(self.samples_ns) < 2 or median == 0:
+      return 0.0
+    mad = statistics.median(abs(s - median) for s in self.samples_ns)
+    return MAD_TO_STDDEV * mad / median
+
+
+@dataclasses.dataclass
+class Comparison:
+  name: str
+  base: BenchmarkResult
+  target: BenchmarkResult
+  # Relative change of the median time; positive is slower.
+  change: float
+  # Smallest relative change considered significant for this benchmark.
+  tolerance: float
+
+  @property
+  def is_regression(self) -> bool:
+    return self.change > self.tolerance
+
+  @property
+  def is_improvement(self) -> bool:
+    return self.change < -self.tolerance
+
+
+def parse_benchmark_json(binary_name: str,
+                         benchmark_json: dict) -> Dict[str, BenchmarkResult]:
+  """Collects the per-repetition times from Google Benchmark JSON output."""
+  results = {}
+  for entry in benchmark_json["benchmarks"]:
+    # Aggregates are recomputed from the samples; errored runs have no time.
+    if entry.get("run_type") == "aggregate" or entry.get("error_occurred"):
+      continue
+    name = f"{binary_name}/{entry.get('run_name', entry['name'])}"
+    time_ns = entry["real_time"] * TIME_UNIT_TO_NS[entry["time_unit"]]
+    results.setdefault(name, BenchmarkResult(name, [])).samples_ns.append(
+        time_ns)
+  return results
+
+
+def run_benchmark_binary(binary: pathlib.Path, repetitions: int,
+                         min_time: float,
+                         benchmark_filter: Optional[str]) -> dict:
+  cmd = [
+      str(binary), "--benchmark_format=json",
+      f"--benchmark_repetitions={repetitions}",
+      f"--benchmark_min_time={min_time}"
+  ]
+  if benchmark_filter:
+    cmd.append(f"--benchmark_filter={benchmark_filter}")
+  result = subprocess.run(cmd,
+                          stdout=subprocess.PIPE,
+                          stderr=subprocess.PIPE,
+                          text=True)
+  if result.returncode != 0:
+    raise RuntimeError(f"{binary} failed:\n{result.stderr}")
+  return json.loads(result.stdout)
+
+
+def run_suite(binaries: Sequence[pathlib.Path], repetitions: int,
+              min_time: float, binary_filter: Optional[re.Pattern],
+              benchmark_filter: Optional[str]) -> Dict[str, BenchmarkResult]:
+  results = {}
+  for binary in binaries:
+    if binary_filter and not binary_filter.search(binary.name):
+      continue
+    if not binary.exists():
+      print(f"skipping {binary}: not built (build iree-native-benchmarks)",
+            file=sys.stderr)
+      continue
+    print(f"running {binary.name}...", file=sys.stderr)
+    results.update(
+        parse_benchmark_json(
+            binary.name,
+            run_benchmark_binary(binary, repetitions, min_time,
+                                 benchmark_filter)))
+  return results
+
+
+def compare_results(base: Dict[str, BenchmarkResult],
+                    target: Dict[str, BenchmarkResult], threshold: float,
+                    noise_multiplier: float) -> List[Comparison]:
+  """Compares the benchmarks present in both result sets."""
+  comparisons = []
+  for name, target_result in target.items():
+    base_result = base.get(name)
+    if not base_result or base_result.median_ns == 0:
+      continue
+    change = target_result.median_ns / base_result.median_ns - 1
+    noise = math.hypot(base_result.noise, target_result.noise)
+    tolerance = max(threshold, noise_multiplier * noise)
+    comparisons.append(
+        Comparison(name, base_result, target_result, change, tolerance))
+  return comparisons
+
+
+def save_results(path: pathlib.Path, results: Dict[str, BenchmarkResult]):
+  path.write_text(
+      json.dumps(
+          {
+              "benchmarks": [
+                  dict(name=result.name,
+                       samples_ns=result.samples_ns,
+                       median_ns=result.median_ns,
+                       noise=result.noise) for result in results.values()
+              ]
+          },
+          indent=2))
+
+
+def load_results(path: pathlib.Path) -> Dict[str, BenchmarkResult]:
+  results_json = json.loads(path.read_text())
+  return {
+      entry["name"]: BenchmarkResult(entry["name"], entry["samples_ns"])
+      for entry in results_json["benchmarks"]
+  }
+
+
+def print_comparisons(comparisons: List[Comparison], verbose: bool):
+  comparisons = sorted(comparisons, key=lambda c: c.change, reverse=True)
+  name_width = max([len("benchmark")] + [len(c.name) for c in comparisons])
+  print(f"{'benchmark':<{name_width}}  {'base (ns)':>12}  {'target (ns)':>12}"
+        f"  {'change':>8}  {'tolerance':>9}")
+  for comparison in comparisons:
+    if comparison.is_regression:
+      status = "REGRESSED"
+    elif comparison.is_improvement:
+      status = "improved"
+    elif verbose:
+      status = ""
+    else:
+      continue
+    print(f"{comparison.name:<{name_width}}  "
+          f"{comparison.base.median_ns:>12.1f}  "
+          f"{comparison.target.median_ns:>12.1f}  "
+          f"{comparison.change:>+8.1%}  {comparison.tolerance:>9.1%}  "
+          f"{status}")
+  regressions = sum(c.is_regression for c in comparisons)
+  improvements = sum(c.is_improvement for c in comparisons)
+  print(f"{len(comparisons)} benchmarks compared: {regressions} regressed, "
+        f"{improvements} improved")
+
+
+def parse_arguments():
+  parser = argparse.ArgumentParser(
+      description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+  source = parser.add_mutually_exclusive_group(required=True)
+  source.add_argument("--build_dir",
+                      type=pathlib.Path,
+                      help="CMake build directory to run the suite from.")
+  source.add_argument("--results",
+                      type=pathlib.Path,
+                      help="Existing result file to compare instead of "
+                      "running the suite.")
+  parser.add_argument("--output",
+                      type=pathlib.Path,
+                      help="File to write the merged results to.")
+  parser.add_argument("--baseline",
+                      type=pathlib.Path,
+                      help="Result file to compare against.")
+  parser.add_argument("--binary_filter",
+                      type=re.compile,
+                      help="Only runs the binaries matching this regex.")
+  parser.add_argument("--benchmark_filter",
+                      help="Passed to the binaries as --benchmark_filter.")
+  parser.add_argument("--repetitions", type=int, default=5)
+  parser.add_argument("--min_time",
+                      type=float,
+                      default=0.1,
+                      help="Minimum seconds per repetition.")
+  parser.add_argument("--threshold",
+                      type=float,
+                      default=0.05,
+                      help="Minimum relative slowdown reported as a "
+                      "regression.")
+  parser.add_argument("--noise_multiplier",
+                      type=float,
+                      default=3.0,
+                      help="Number of standard deviations of the combined "
+                      "noise a change must exceed to be reported.")
+  parser.add_argument("--verbose",
+                      action="store_true",
+                      help="Lists unchanged benchmarks too.")
+  return parser.parse_args()
+
+
+def main(args) -> int:
+  if args.results:
+    results = load_results(args.results)
+  else:
+    manifest = args.build_dir / "native_benchmarks.txt"
+    binaries = [
+        pathlib.Path(line)
+        for line in manifest.read_text().splitlines()
+        if line.strip()
+    ]
+    results = run_suite(binaries, args.repetitions, args.min_time,
+                        args.binary_filter, args.benchmark_filter)
+  if args.output:
+    save_results(args.output, results)
+
+  if not args.baseline:
+    return 0
+  comparisons = compare_results(load_results(args.baseline), results,
+                                args.threshold, args.noise_multiplier)
+  print_comparisons(comparisons, args.verbose)
+  return 1 if any(c.is_regression for c in comparisons) else 0
+
+
+if __name__ == "__main__":
+  sys.exit(main(parse_arguments()))
@@ -0,0 +1,93 @@
+#!/usr/bin/env python3
+# Copyright 2023 The IREE Authors
+#
+# Licensed under the Apache License v2.0 with LLVM Exceptions.
+# See https://llvm.org/LICENSE.txt for license information.
+# SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+import unittest
+
+from run_native_benchmarks import BenchmarkResult, compare_results, parse_benchmark_json
+
+
+class RunNativeBenchmarksTest(unittest.TestCase):
+
+  def test_parse_benchmark_json_skips_aggregates(self):
+    benchmark_json = {
+        "benchmarks": [
+            dict(name="BM_a",
+                 run_name="BM_a",
+                 run_type="iteration",
+                 real_time=1.5,
+                 time_unit="us"),
+            dict(name="BM_a",
+                 run_name="BM_a",
+                 run_type="iteration",
+                 real_time=2000,
+                 time_unit="ns"),
+            dict(name="BM_a_mean",
+                 run_name="BM_a",
+                 run_type="aggregate",
+                 real_time=1.75,
+                 time_unit="us"),
+            dict(name="BM_b",
+                 run_name="BM_b",
+                 run_type="iteration",
+                 error_occurred=True,
+                 real_time=0,
+                 time_unit="ns"),
+        ]
+    }
+
+    results = parse_benchmark_json("vm_benchmark", benchmark_json)
+
+    self.assertEqual(list(results.keys()), ["vm_benchmark/BM_a"])
+    self.assertEqual(results["vm_benchmark/BM_a"].samples_ns, [1500, 2000])
+
+  def test_noise_is_relative_mad(self):
+    result = BenchmarkResult("a", [90, 100, 110])
+
+    self.assertEqual(result.median_ns, 100)
+    self.assertAlmostEqual(result.noise, 0.14826)
+
+  def test_compare_results_uses_threshold_for_quiet_benchmarks(self):
+    base = {"a": BenchmarkResult("a", [100, 100, 100])}
+    target = {"a": BenchmarkResult("a", [110, 110, 110])}
+
+    comparisons = compare_results(base,
+                                  target,
+                                  threshold=0.05,
+                                  noise_multiplier=3)
+
+    self.assertEqual(len(comparisons), 1)
+    self.assertAlmostEqual(comparisons[0].change, 0.1)
+    self.assertAlmostEqual(comparisons[0].tolerance, 0.05)
+    self.assertTrue(comparisons[0].is_regression)
+
+  def test_compare_results_tolerates_noise(self):
+    base = {"a": BenchmarkResult("a", [80, 100, 120])}
+    target = {"a": BenchmarkResult("a", [90, 110, 130])}
+
+    comparisons = compare_results(base,
+                                  target,
+                                  threshold=0.05,
+                                  noise_multiplier=3)
+
+    self.assertFalse(comparisons[0].is_regression)
+    self.assertFalse(comparisons[0].is_improvement)
+
+  def test_compare_results_reports_improvements(self):
+    base = {"a": BenchmarkResult("a", [100]), "b": BenchmarkResult("b", [100])}
+    target = {"a": BenchmarkResult("a", [50]), "c": BenchmarkResult("c", [1])}
+
+    comparisons = compare_results(base,
+                                  target,
+                                  threshold=0.05,
+                                  noise_multiplier=3)
+
+    self.assertEqual([c.name for c in comparisons], ["a"])
+    self.assertTrue(comparisons[0].is_improvement)
+
+
+if __name__ == "__main__":
+  unittest.main()
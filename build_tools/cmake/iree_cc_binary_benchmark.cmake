@@ -14,6 +14,10 @@ include(CMakeParseArguments)
 # billion iterations of them every time you try to run tests. So we create these
 # as binaries and then invoke them as tests with `--benchmark_min_time=0`.
 #
+# The binaries are also added to the `iree-native-benchmarks` target and listed
+# in `${IREE_BINARY_DIR}/native_benchmarks.txt` so that they can be run together
+# as one suite by build_tools/benchmarks/run_native_benchmarks.py.
+#
 # Mirrors the bzl function of the same name. See iree_cc_binary and iree_cc_test
 # for more details on those rules
 #
@@ -70,6 +74,11 @@ function(iree_cc_binary_benchmark)
     ${_MAYBE_HOSTONLY}
   )
 
+  iree_package_name(_PACKAGE_NAME)
+  set(_NAME "${_PACKAGE_NAME}_${_RULE_NAME}")
+  add_dependencies(iree-native-benchmarks "${_NAME}")
+  set_property(GLOBAL APPEND PROPERTY
+    IREE_NATIVE_BENCHMARKS "$<TARGET_FILE:${_NAME}>")
 
   iree_native_test(
     NAME
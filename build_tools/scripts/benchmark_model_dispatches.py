@@ -0,0 +1,215 @@
+#!/usr/bin/env python3
+# Copyright 2023 The IREE Authors
+#
+# Licensed under the Apache License v2.0 with LLVM Exceptions.
+# See https://llvm.org/LICENSE.txt for license information.
+# SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+"""Benchmarks every dispatch of a program and ranks them by total time.
+
+Dumps a standalone benchmark module for every dispatch of the input program
+with `--iree-hal-dump-executable-benchmarks-to=`, compiles each one and runs
+all of its dispatch benchmarks with iree-benchmark-module. This is repeated
+for each `--target=<backend>:<device>` pair.
+
+Each dispatch is reported with its time per invocation, the number of sites in
+the program that issue it with the same workload and their product, which is
+an estimate of the time the program spends in the dispatch. Dispatches are
+ranked by that estimate so the top of the table is what to optimize first.
+Site counts are static: dispatches inside loops are counted once and
+dispatches with dynamic workloads are not dumped at all.
+
+Example:
+  build_tools/scripts/benchmark_model_dispatches.py \\
+    --iree_compile=../iree-build/tools/iree-compile \\
+    --iree_benchmark_module=../iree-build/tools/iree-benchmark-module \\
+    --input=model.mlir \\
+    --target=llvm-cpu:local-task --target=vulkan-spirv:vulkan \\
+    -- --iree-llvm-target-cpu=host
+"""
+
+import argparse
+import dataclasses
+import json
+import os
+import re
+import subprocess
+import sys
+import tempfile
+import typing
+
+TIME_UNIT_TO_NS = {"ns": 1, "us": 1e3, "ms": 1e6, "s": 1e9}
+
+# Matches the dispatch benchmark functions in the dumped modules along with
+# their dispatch site count.
+BENCHMARK_FUNC_RE = re.compile(
+    r"func\.func @(\w+)\(%\w+: i32\)[^\n]*"
+    r'iree\.benchmark\.dispatch_sites = "(\d+)"')
+
+
+@dataclasses.dataclass
+class DispatchResult:
+  target: str
+  name: str
+  sites: int
+  time_ns: float
+
+  @property
+  def total_ns(self) -> float:
+    return self.time_ns * self.sites
+
+
+def run(cmd: typing.List[str], check: bool = True):
+  result = subprocess.run(cmd,
+                          stdout=subprocess.PIPE,
+                          stderr=subprocess.PIPE,
+                          text=True)
+  if check and result.returncode != 0:
+    raise RuntimeError(f"command failed: {' '.join(cmd)}\n{result.stderr}")
+  return result
+
+
+def dump_benchmarks(args, backend: str,
+                    benchmarks_dir: str) -> typing.List[str]:
+  run([
+      args.iree_compile, args.input, f"--iree-hal-target-backends={backend}",
+      *args.compile_flags,
+      f"--iree-hal-dump-executable-benchmarks-to={benchmarks_dir}", "-o",
+      os.devnull
+  ])
+  return sorted(
+      os.path.join(benchmarks_dir, name)
+      for name in os.listdir(benchmarks_dir)
+      if name.endswith(".mlir"))
+
+
+def benchmark_file(args, backend: str, device: str, benchmark_path: str,
+                   work_dir: str) -> typing.List[DispatchResult]:
+  with open(benchmark_path) as f:
+    sites = {name: int(count) for name, count in BENCHMARK_FUNC_RE.findall(
+        f.read())}
+  if not sites:
+    return []
+
+  module_path = os.path.join(work_dir, "dispatch.vmfb")
+  name = os.path.basename(benchmark_path)
+  result = run([
+      args.iree_compile, benchmark_path,
+      f"--iree-hal-target-backends={backend}", *args.compile_flags, "-o",
+      module_path
+  ],
+               check=False)
+  if result.returncode != 0:
+    print(f"{name}: failed to compile:\n{result.stderr}", file=sys.stderr)
+    return []
+  result = run([
+      args.iree_benchmark_module, f"--module_file={module_path}",
+      f"--device={device}", f"--batch_size={args.batch_size}",
+      "--benchmark_format=json",
+      f"--benchmark_repetitions={args.repetitions}"
+  ],
+               check=False)
+  if result.returncode != 0:
+    print(f"{name}: failed to benchmark:\n{result.stderr}", file=sys.stderr)
+    return []
+
+  # Use the fastest repetition of each dispatch to reduce noise.
+  times = {}
+  for entry in json.loads(result.stdout)["benchmarks"]:
+    if entry.get("run_type") == "aggregate":
+      continue
+    func_name = entry["name"].split("/")[0]
+    func_name = func_name[len("BM_"):] if func_name.startswith(
+        "BM_") else func_name
+    time_ns = entry["real_time"] * TIME_UNIT_TO_NS[entry["time_unit"]]
+    times[func_name] = min(time_ns, times.get(func_name, time_ns))
+  return [
+      DispatchResult(f"{backend}:{device}", func_name, sites[func_name],
+                     time_ns)
+      for func_name, time_ns in times.items()
+      if func_name in sites
+  ]
+
+
+def benchmark_target(args, target: str) -> typing.List[DispatchResult]:
+  backend, device = target.split(":", 1)
+  results = []
+  with tempfile.TemporaryDirectory() as work_dir:
+    benchmarks_dir = os.path.join(work_dir, "benchmarks")
+    os.makedirs(benchmarks_dir)
+    for benchmark_path in dump_benchmarks(args, backend, benchmarks_dir):
+      results.extend(
+          benchmark_file(args, backend, device, benchmark_path, work_dir))
+  return results
+
+
+def print_table(results: typing.List[DispatchResult], limit: int):
+  results = sorted(results, key=lambda result: result.total_ns, reverse=True)
+  program_ns = sum(result.total_ns for result in results)
+  name_width = max([len("dispatch")] + [len(r.name) for r in results[:limit]])
+  print(f"{'rank':>4}  {'dispatch':<{name_width}}  {'time (us)':>11}  "
+        f"{'sites':>5}  {'total (us)':>11}  {'share':>6}  "
+        f"{'cumulative':>10}")
+  cumulative_ns = 0
+  for rank, result in enumerate(results[:limit], 1):
+    cumulative_ns += result.total_ns
+    share = result.total_ns / program_ns if program_ns else 0
+    cumulative = cumulative_ns / program_ns if program_ns else 0
+    print(f"{rank:>4}  {result.name:<{name_width}}  "
+          f"{result.time_ns / 1e3:>11.3f}  {result.sites:>5}  "
+          f"{result.total_ns / 1e3:>11.3f}  {share:>6.1%}  "
+          f"{cumulative:>10.1%}")
+  print(f"{len(results)} dispatches, {program_ns / 1e3:.3f} us total")
+
+
+def parse_arguments():
+  parser = argparse.ArgumentParser(
+      description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+  parser.add_argument("--iree_compile", default="iree-compile")
+  parser.add_argument("--iree_benchmark_module",
+                      default="iree-benchmark-module")
+  parser.add_argument("--input", required=True, help="Program to benchmark.")
+  parser.add_argument("--target",
+                      action="append",
+                      required=True,
+                      help="<backend>:<device> pair to benchmark on, such as "
+                      "`llvm-cpu:local-task`. May be repeated.")
+  parser.add_argument("--batch_size",
+                      type=int,
+                      default=16,
+                      help="Dispatches per benchmark iteration; amortizes the "
+                      "submission overhead in the measured time.")
+  parser.add_argument("--repetitions", type=int, default=3)
+  parser.add_argument("--limit",
+                      type=int,
+                      default=25,
+                      help="Number of dispatches listed per target.")
+  parser.add_argument("--output_json",
+                      help="Optional file to write all results to.")
+  parser.add_argument("compile_flags",
+                      nargs="*",
+                      help="Flags passed to iree-compile after `--`.")
+  return parser.parse_args()
+
+
+def main(args):
+  all_results = []
+  for target in args.target:
+    if ":" not in target:
+      raise ValueError(f"expected <backend>:<device> but got '{target}'")
+    results = benchmark_target(args, target)
+    print(f"\n{target}:")
+    print_table(results, args.limit)
+    all_results.extend(results)
+
+  if args.output_json:
+    with open(args.output_json, "w") as f:
+      json.dump([
+          dict(dataclasses.asdict(result), total_ns=result.total_ns)
+          for result in all_results
+      ],
+                f,
+                indent=2)
+
+
+if __name__ == "__main__":
+  main(parse_arguments())
@@ -0,0 +1,291 @@
+#!/usr/bin/env python3
+# Copyright 2023 The IREE Authors
+#
+# Licensed under the Apache License v2.0 with LLVM Exceptions.
+# See https://llvm.org/LICENSE.txt for license information.
+# SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+"""Autotunes the lowering configurations of the dispatches of a program.
+
+Dumps a standalone benchmark module for every dispatch of the input program
+with `--iree-hal-dump-executable-benchmarks-to=`, compiles each one with a set
+of candidate `#iree_codegen.compilation_info` values, measures them with
+iree-benchmark-module and writes the fastest candidate of every dispatch to a
+tuning database. Passing the database back to iree-compile with
+`--iree-codegen-tuning-database=` makes it replace the configuration
+heuristics for the matching root ops.
+
+Each database line is `<key>\\t<compilation_info>` where the key is the root op
+name and its operand/result types as reported by
+`--iree-codegen-tuning-database-print-keys`. Candidates are generated for
+matmul-like root ops only; other dispatches keep their heuristic config.
+
+Example:
+  build_tools/scripts/tune_dispatch_configs.py \\
+    --iree_compile=../iree-build/tools/iree-compile \\
+    --iree_benchmark_module=../iree-build/tools/iree-benchmark-module \\
+    --input=model.mlir --output=model.tuning --device=local-task \\
+    -- --iree-hal-target-backends=llvm-cpu --iree-llvm-target-cpu=host
+"""
+
+import argparse
+import dataclasses
+import itertools
+import json
+import os
+import re
+import subprocess
+import sys
+import tempfile
+import typing
+
+# Root ops candidates are generated for, mapped to whether their operands have
+# a leading batch dimension.
+MATMUL_OPS = {
+    "linalg.matmul": False,
+    "linalg.batch_matmul": True,
+}
+
+TIME_UNIT_TO_NS = {"ns": 1, "us": 1e3, "ms": 1e6, "s": 1e9}
+
+
+@dataclasses.dataclass
+class MatmulShape:
+  batch: typing.Optional[int]
+  m: int
+  n: int
+  k: int
+
+
+@dataclasses.dataclass
+class Candidate:
+  tile_sizes: typing.List[typing.List[int]]
+  pipeline: str
+  workgroup_size: typing.List[int] = dataclasses.field(default_factory=list)
+  pipeline_depth: typing.Optional[int] = None
+
+  def __str__(self):
+    translation_info = self.pipeline
+    if self.pipeline_depth is not None:
+      translation_info += f" pipeline_depth = {self.pipeline_depth}"
+    workgroup_size = ", ".join(
+        f"{size} : index" for size in self.workgroup_size)
+    return ("#iree_codegen.compilation_info<"
+            f"lowering_config = <tile_sizes = {self.tile_sizes}>, "
+            f"translation_info = <{translation_info}>, "
+            f"workgroup_size = [{workgroup_size}]>")
+
+
+def run(cmd: typing.List[str], check: bool = True):
+  result = subprocess.run(cmd, stdout=subprocess.PIPE, stderr=subprocess.PIPE,
+                          text=True)
+  if check and result.returncode != 0:
+    raise RuntimeError(f"command failed: {' '.join(cmd)}\n{result.stderr}")
+  return result
+
+
+def dump_benchmarks(args, benchmarks_dir: str) -> typing.List[str]:
+  run([
+      args.iree_compile, args.input, *args.compile_flags,
+      f"--iree-hal-dump-executable-benchmarks-to={benchmarks_dir}", "-o",
+      os.devnull
+  ])
+  return sorted(
+      os.path.join(benchmarks_dir, name)
+      for name in os.listdir(benchmarks_dir)
+      if name.endswith(".mlir"))
+
+
+def get_root_keys(args, benchmark_path: str, work_dir: str) -> typing.Set[str]:
+  # An empty database is enough to make the compiler report the keys.
+  empty_database = os.path.join(work_dir, "empty.tuning")
+  open(empty_database, "w").close()
+  result = run([
+      args.iree_compile, benchmark_path, *args.compile_flags,
+      f"--iree-codegen-tuning-database={empty_database}",
+      "--iree-codegen-tuning-database-print-keys", "-o", os.devnull
+  ],
+               check=False)
+  return set(re.findall(r"tuning database key: '([^']*)'", result.stderr))
+
+
+def parse_matmul_shape(key: str) -> typing.Optional[MatmulShape]:
+  op_name = key.split(" ", 1)[0]
+  if op_name not in MATMUL_OPS:
+    return None
+  shapes = [[int(dim)
+             for dim in match[:-1].split("x")]
+            for match in re.findall(r"tensor<((?:\d+x)+)", key)]
+  if len(shapes) < 3:
+    # Dynamic shapes are not tuned.
+    return None
+  lhs, rhs = shapes[0], shapes[1]
+  if MATMUL_OPS[op_name]:
+    return MatmulShape(batch=lhs[0], m=lhs[1], k=lhs[2], n=rhs[2])
+  return MatmulShape(batch=None, m=lhs[0], k=lhs[1], n=rhs[1])
+
+
+def get_cpu_candidates(shape: MatmulShape) -> typing.List[Candidate]:
+  candidates = []
+  for tile_m, tile_n, (vec_m, vec_n), vec_k in itertools.product(
+      [16, 32, 64, 128], [16, 32, 64, 128], [(4, 16), (8, 16), (8, 32),
+                                             (16, 16)], [1, 4, 16]):
+    if tile_m % vec_m or tile_n % vec_n:
+      continue
+    if tile_m > max(shape.m, vec_m) or tile_n > max(shape.n, vec_n):
+      continue
+    tile_sizes = [[tile_m, tile_n, 0], [vec_m, vec_n, 0], [0, 0, vec_k]]
+    if shape.batch is not None:
+      tile_sizes = [[1] + level for level in tile_sizes]
+    candidates.append(Candidate(tile_sizes, "CPUDoubleTilingExpert"))
+  return candidates
+
+
+def get_cuda_candidates(shape: MatmulShape) -> typing.List[Candidate]:
+  # Same tile/workgroup size pairs as the e2e matmul SIMT tests.
+  pairs = [
+      ([32, 128, 32], [32, 8, 1]),
+      ([128, 64, 8], [16, 8, 1]),
+      ([16, 256, 32], [64, 2, 1]),
+      ([8, 32, 32], [8, 8, 1]),
+      ([8, 128, 4], [32, 1, 1]),
+      ([16, 64, 4], [16, 2, 1]),
+      ([1, 128, 8], [32, 1, 1]),
+  ]
+  candidates = []
+  for tile_sizes, workgroup_size in pairs:
+    if tile_sizes[0] > shape.m or tile_sizes[1] > shape.n:
+      continue
+    if shape.batch is not None:
+      tile_sizes = [1] + tile_sizes
+    candidates.append(
+        Candidate([tile_sizes],
+                  "LLVMGPUMatmulSimt",
+                  workgroup_size=workgroup_size,
+                  pipeline_depth=0))
+  return candidates
+
+
+CANDIDATE_GENERATORS = {
+    "llvm-cpu": get_cpu_candidates,
+    "cuda": get_cuda_candidates,
+}
+
+
+def benchmark(args, benchmark_path: str, work_dir: str,
+              candidate: typing.Optional[Candidate]) -> typing.Optional[float]:
+  """Returns the fastest real time in ns of `candidate` or None if it failed.
+
+  A `None` candidate measures the heuristic configuration.
+  """
+  module_path = os.path.join(work_dir, "candidate.vmfb")
+  compile_cmd = [
+      args.iree_compile, benchmark_path, *args.compile_flags, "-o", module_path
+  ]
+  if candidate:
+    database = os.path.join(work_dir, "candidate.tuning")
+    with open(database, "w") as f:
+      f.write(f"*\t{candidate}\n")
+    compile_cmd.append(f"--iree-codegen-tuning-database={database}")
+  if run(compile_cmd, check=False).returncode != 0:
+    return None
+
+  result = run([
+      args.iree_benchmark_module, f"--module_file={module_path}",
+      f"--device={args.device}", "--benchmark_format=json",
+      f"--benchmark_repetitions={args.repetitions}"
+  ],
+               check=False)
+  if result.returncode != 0:
+    return None
+  times = [
+      entry["real_time"] * TIME_UNIT_TO_NS[entry["time_unit"]]
+      for entry in json.loads(result.stdout)["benchmarks"]
+      if entry.get("run_type") != "aggregate"
+  ]
+  return min(times) if times else None
+
+
+def tune(args, benchmark_path: str, work_dir: str,
+         generate_candidates) -> typing.Optional[typing.Tuple[str, Candidate]]:
+  keys = get_root_keys(args, benchmark_path, work_dir)
+  if len(keys) != 1:
+    return None
+  key = keys.pop()
+  shape = parse_matmul_shape(key)
+  if not shape:
+    return None
+  candidates = generate_candidates(shape)[:args.max_candidates]
+  if not candidates:
+    return None
+
+  baseline = benchmark(args, benchmark_path, work_dir, None)
+  best_time, best_candidate = baseline, None
+  for candidate in candidates:
+    time = benchmark(args, benchmark_path, work_dir, candidate)
+    if time is not None and (best_time is None or time < best_time):
+      best_time, best_candidate = time, candidate
+  name = os.path.basename(benchmark_path)
+  if not best_candidate:
+    print(f"{name}: heuristic config is fastest", file=sys.stderr)
+    return None
+  speedup = f" ({baseline / best_time:.2f}x)" if baseline else ""
+  print(f"{name}: {best_candidate}{speedup}", file=sys.stderr)
+  return key, best_candidate
+
+
+def parse_arguments():
+  parser = argparse.ArgumentParser(
+      description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+  parser.add_argument("--iree_compile", default="iree-compile")
+  parser.add_argument("--iree_benchmark_module",
+                      default="iree-benchmark-module")
+  parser.add_argument("--input", required=True, help="Program to tune.")
+  parser.add_argument("--output",
+                      required=True,
+                      help="Tuning database to write. Existing entries for "
+                      "other keys are preserved.")
+  parser.add_argument("--device", required=True,
+                      help="Device passed to iree-benchmark-module.")
+  parser.add_argument("--backend",
+                      choices=sorted(CANDIDATE_GENERATORS.keys()),
+                      default="llvm-cpu",
+                      help="Backend to generate candidate configs for.")
+  parser.add_argument("--repetitions", type=int, default=3)
+  parser.add_argument("--max_candidates",
+                      type=int,
+                      default=64,
+                      help="Maximum number of candidates per dispatch.")
+  parser.add_argument("compile_flags",
+                      nargs="*",
+                      help="Flags passed to iree-compile after `--`.")
+  return parser.parse_args()
+
+
+def main(args):
+  entries = {}
+  if os.path.exists(args.output):
+    with open(args.output) as f:
+      for line in f:
+        line = line.strip()
+        if line and not line.startswith("#"):
+          key, value = line.split("\t", 1)
+          entries[key] = value
+
+  with tempfile.TemporaryDirectory() as work_dir:
+    benchmarks_dir = os.path.join(work_dir, "benchmarks")
+    os.makedirs(benchmarks_dir)
+    for benchmark_path in dump_benchmarks(args, benchmarks_dir):
+      result = tune(args, benchmark_path, work_dir,
+                    CANDIDATE_GENERATORS[args.backend])
+      if result:
+        entries[result[0]] = str(result[1])
+
+  with open(args.output, "w") as f:
+    f.write(f"# Generated by {os.path.basename(__file__)} for "
+            f"{os.path.basename(args.input)} on {args.device}.\n")
+    for key in sorted(entries):
+      f.write(f"{key}\t{entries[key]}\n")
+
+
+if __name__ == "__main__":
+  main(parse_arguments())
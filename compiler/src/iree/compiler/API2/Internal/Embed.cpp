@@ -18,6 +18,7 @@
 #include "iree/compiler/Tools/init_llvmir_translations.h"
 #include "iree/compiler/Tools/init_passes.h"
 #include "iree/compiler/Tools/init_targets.h"
+#include "iree/compiler/Utils/CompileTimeReport.h"
 #include "iree/compiler/Utils/TracingUtils.h"
 #include "llvm/Support/ManagedStatic.h"
 #include "llvm/Support/MemoryBuffer.h"
@@ -88,6 +89,7 @@ GlobalInit::GlobalInit(bool initializeCommandLine)
     // Register pass manager command-line options like -mlir-print-ir-*.
     mlir::registerPassManagerCLOptions();
     mlir::registerDefaultTimingManagerCLOptions();
+    registerCompileTimeReportCLOptions();
 
     // Bind session options to the command line environment.
     clBindingOptions = &BindingOptions::FromFlags::get();
@@ -328,6 +330,7 @@ Invocation::Invocation(Session &session)
   if (session.globalInit.usesCommandLine) {
     mlir::applyPassManagerCLOptions(passManager);
     mlir::applyDefaultTimingPassManagerCLOptions(passManager);
+    applyCompileTimeReportCLOptions(passManager);
   }
   passManager.addInstrumentation(std::make_unique<PassTracing>());
 }
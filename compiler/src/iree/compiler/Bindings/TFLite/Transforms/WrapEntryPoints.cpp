@@ -480,9 +480,16 @@ class WrapEntryPointsPass
     // NOTE: this is where we could change our signature to provide additional
     // values from the runtime bindings as may be required - like semaphores for
     // async behavior or cancellation.
+    //
+    // Each output has a storage buffer argument following the inputs that the
+    // result is written into. The runtime bindings allocate these once based
+    // on the queried output shapes so that steady-state invocations don't
+    // allocate.
     auto entryFuncType = entryFuncOp.getFunctionType();
     auto bufferType = moduleBuilder.getType<IREE::HAL::BufferType>();
-    SmallVector<Type> inputTypes(entryFuncType.getNumInputs(), bufferType);
+    SmallVector<Type> inputTypes(
+        entryFuncType.getNumInputs() + entryFuncType.getNumResults(),
+        bufferType);
     SmallVector<Type> outputTypes(entryFuncType.getNumResults(), bufferType);
     auto wrapperFuncType =
         moduleBuilder.getFunctionType(inputTypes, outputTypes);
@@ -495,6 +502,8 @@ class WrapEntryPointsPass
 
     SmallVector<DictionaryAttr, 4> argAttrDict;
     entryFuncOp.getAllArgAttrs(argAttrDict);
+    argAttrDict.append(entryFuncType.getNumResults(),
+                       moduleBuilder.getDictionaryAttr({}));
     wrapperFuncOp.setAllArgAttrs(argAttrDict);
     SmallVector<DictionaryAttr, 4> resultAttrDict;
     entryFuncOp.getAllResultAttrs(resultAttrDict);
@@ -514,9 +523,12 @@ class WrapEntryPointsPass
     // expect in the runtime.
     auto *entryBlock = wrapperFuncOp.addEntryBlock();
     auto entryBuilder = OpBuilder::atBlockBegin(entryBlock);
+    auto inputArgs =
+        entryBlock->getArguments().take_front(entryFuncType.getNumInputs());
+    auto outputStorageArgs =
+        entryBlock->getArguments().drop_front(entryFuncType.getNumInputs());
     SmallVector<Value> callOperands;
-    for (auto input :
-         llvm::zip_equal(entryBlock->getArguments(), inputDynamicDims)) {
+    for (auto input : llvm::zip_equal(inputArgs, inputDynamicDims)) {
       auto arg = std::get<0>(input);
       auto inputDynamicDims = std::get<1>(input);
       SmallVector<Value> dynamicDims;
@@ -532,10 +544,11 @@ class WrapEntryPointsPass
     auto callOp = entryBuilder.create<mlir::func::CallOp>(
         entryFuncOp.getLoc(), entryFuncOp, callOperands);
     SmallVector<Value> callResults;
-    for (auto output :
-         llvm::zip_equal(callOp.getResults(), outputDynamicDims)) {
+    for (auto output : llvm::zip_equal(callOp.getResults(), outputDynamicDims,
+                                       outputStorageArgs)) {
       auto result = std::get<0>(output);
       auto outputDynamicDims = std::get<1>(output);
+      auto outputStorage = std::get<2>(output);
       SmallVector<Value> dynamicDims;
       for (unsigned i = 0; i < outputDynamicDims.tensorType.getRank(); ++i) {
         if (outputDynamicDims.tensorType.isDynamicDim(i)) {
@@ -545,7 +558,7 @@ class WrapEntryPointsPass
       }
       callResults.push_back(entryBuilder.create<IREE::HAL::TensorExportOp>(
           result.getLoc(), bufferType, result, outputDynamicDims.tensorType,
-          dynamicDims, /*target_storage=*/nullptr));
+          dynamicDims, outputStorage));
       for (auto it :
            llvm::zip_equal(dynamicDims, outputDynamicDims.globalOps)) {
         auto dynamicDim = std::get<0>(it);
@@ -612,6 +625,10 @@ class WrapEntryPointsPass
                                mlir::func::FuncOp wrapperFuncOp) {
     SmallVector<NamedAttribute, 4> attrs;
     attrs.push_back(buildIONamesAttr(entryFuncOp));
+    // Indicates that output storage buffers follow the inputs.
+    attrs.push_back(NamedAttribute{
+        StringAttr::get(&getContext(), "tfl.io.output_storage"),
+        StringAttr::get(&getContext(), "1")});
     // TODO(#3972): tfl.io.quant: quantization information.
     // TODO(#3978): tfl.io.types: tensor types (complex/strings/etc).
     auto reflectionAttr = DictionaryAttr::get(&getContext(), attrs);
@@ -152,14 +152,17 @@
 
 // CHECK-LABEL: func.func @_tflite_main(
 //  CHECK-SAME:   %[[IN0_BUFFER:.+]]: !hal.buffer {iree.identifier = "input0"},
-//  CHECK-SAME:   %[[IN1_BUFFER:.+]]: !hal.buffer {iree.identifier = "input1"})
+//  CHECK-SAME:   %[[IN1_BUFFER:.+]]: !hal.buffer {iree.identifier = "input1"},
+//  CHECK-SAME:   %[[OUT0_STORAGE:.+]]: !hal.buffer,
+//  CHECK-SAME:   %[[OUT1_STORAGE:.+]]: !hal.buffer)
 //  CHECK-SAME: -> (
 //  CHECK-SAME:   !hal.buffer {iree.identifier = "output0"},
 //  CHECK-SAME:   !hal.buffer {iree.identifier = "output1"}
 //  CHECK-SAME: ) attributes {
 //  CHECK-SAME:   iree.abi.stub,
 //  CHECK-SAME:   iree.reflection = {
-//  CHECK-SAME:     tfl.io.names = "input0;input1;output0;output1"
+//  CHECK-SAME:     tfl.io.names = "input0;input1;output0;output1",
+//  CHECK-SAME:     tfl.io.output_storage = "1"
 //  CHECK-SAME:   }
 //  CHECK-SAME: } {
 
@@ -174,14 +177,14 @@
 // Call the original function with tensor arguments.
 //      CHECK:   %[[OUT:.+]]:2 = call @dynamicEntry(%[[IN0]], %[[IN1]]) : (tensor<?x8x8x3xf32>, tensor<?x8x8x3xf32>) -> (tensor<?x8x8x3xf32>, tensor<?x8x8x3xf32>)
 
-// Query output0 shape and get the HAL buffer to return.
+// Query output0 shape and write it into the provided storage to return.
 //      CHECK:   %[[OUT0_DIM0:.+]] = tensor.dim %[[OUT]]#0, %c0 : tensor<?x8x8x3xf32>
-// CHECK-NEXT:   %[[OUT0_BUFFER:.+]] = hal.tensor.export %[[OUT]]#0 : tensor<?x8x8x3xf32>{%[[OUT0_DIM0]]} -> !hal.buffer
+// CHECK-NEXT:   %[[OUT0_BUFFER:.+]] = hal.tensor.export %[[OUT]]#0 into %[[OUT0_STORAGE]] : tensor<?x8x8x3xf32>{%[[OUT0_DIM0]]} -> !hal.buffer
 // CHECK-NEXT:   util.global.store %[[OUT0_DIM0]], @_tflite_dynamicEntry_output0_shape_dim0 : index
 
-// Query output1 shape and get the HAL buffer to return.
+// Query output1 shape and write it into the provided storage to return.
 //      CHECK:   %[[OUT1_DIM0:.+]] = tensor.dim %[[OUT]]#1, %c0 : tensor<?x8x8x3xf32>
-// CHECK-NEXT:   %[[OUT1_BUFFER:.+]] = hal.tensor.export %[[OUT]]#1 : tensor<?x8x8x3xf32>{%[[OUT1_DIM0]]} -> !hal.buffer
+// CHECK-NEXT:   %[[OUT1_BUFFER:.+]] = hal.tensor.export %[[OUT]]#1 into %[[OUT1_STORAGE]] : tensor<?x8x8x3xf32>{%[[OUT1_DIM0]]} -> !hal.buffer
 // CHECK-NEXT:   util.global.store %[[OUT1_DIM0]], @_tflite_dynamicEntry_output1_shape_dim0 : index
 
 // Clear shape dirty bit as we've updated the shapes unconditionally.
@@ -212,14 +215,17 @@ func.func @dynamicEntry(
 
 // CHECK-LABEL: func.func @_tflite_main(
 //  CHECK-SAME:   %[[IN0_BUFFER:.+]]: !hal.buffer,
-//  CHECK-SAME:   %[[IN1_BUFFER:.+]]: !hal.buffer)
+//  CHECK-SAME:   %[[IN1_BUFFER:.+]]: !hal.buffer,
+//  CHECK-SAME:   %[[OUT0_STORAGE:.+]]: !hal.buffer,
+//  CHECK-SAME:   %[[OUT1_STORAGE:.+]]: !hal.buffer)
 //  CHECK-SAME: -> (
 //  CHECK-SAME:   !hal.buffer,
 //  CHECK-SAME:   !hal.buffer
 //  CHECK-SAME: ) attributes {
 //  CHECK-SAME:   iree.abi.stub,
 //  CHECK-SAME:   iree.reflection = {
-//  CHECK-SAME:     tfl.io.names = "arg0;arg1;ret0;ret1"
+//  CHECK-SAME:     tfl.io.names = "arg0;arg1;ret0;ret1",
+//  CHECK-SAME:     tfl.io.output_storage = "1"
 //  CHECK-SAME:   }
 //  CHECK-SAME: } {
 
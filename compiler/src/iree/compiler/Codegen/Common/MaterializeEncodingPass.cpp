@@ -9,6 +9,7 @@
 //===---------------------------------------------------------------------===//
 
 #include "iree-dialects/Dialect/LinalgExt/IR/LinalgExtDialect.h"
+#include "iree-dialects/Dialect/LinalgExt/IR/LinalgExtOps.h"
 #include "iree-dialects/Dialect/LinalgExt/Passes/Passes.h"
 #include "iree/compiler/Codegen/PassDetail.h"
 #include "iree/compiler/Codegen/Passes.h"
@@ -17,15 +18,28 @@
 #include "iree/compiler/Dialect/HAL/IR/HALTypes.h"
 #include "iree/compiler/Dialect/VMVX/IR/VMVXDialect.h"
 #include "iree/compiler/Dialect/VMVX/IR/VMVXOps.h"
+#include "llvm/Support/CommandLine.h"
+#include "llvm/Support/ErrorHandling.h"
 #include "mlir/Dialect/Affine/IR/AffineOps.h"
 #include "mlir/Dialect/Arith/IR/Arith.h"
 #include "mlir/Dialect/MemRef/Transforms/Passes.h"
+#include "mlir/Dialect/Tensor/IR/Tensor.h"
+#include "mlir/IR/Matchers.h"
 #include "mlir/Transforms/DialectConversion.h"
 #include "mlir/Transforms/GreedyPatternRewriteDriver.h"
 
 namespace mlir {
 namespace iree_compiler {
 
+static llvm::cl::list<std::string> clMmt4dTileSizes(
+    "iree-codegen-mmt4d-tile-sizes",
+    llvm::cl::desc(
+        "Overrides the mmt4d tile shape chosen for a matmul type, as a comma "
+        "separated list of <type>:<M0>x<N0>x<K0> entries, e.g. "
+        "f32f32f32:8x8x1,i8i8i32:8x8x4. Typically produced on the target "
+        "device by the mmt4d_autotune tool."),
+    llvm::cl::CommaSeparated);
+
 using namespace IREE::LinalgExt;
 using IREE::HAL::ExecutableTargetAttr;
 
@@ -177,11 +191,49 @@ static MatmulTileParams chooseMatmulTileParamsVMVXMicrokernels() {
   return {ShapedType::kDynamic, ShapedType::kDynamic, ShapedType::kDynamic};
 }
 
+static StringRef getMatmulTypeName(MatmulType type) {
+  switch (type) {
+    case MatmulType::F32F32F32:
+      return "f32f32f32";
+    case MatmulType::I8I8I32:
+      return "i8i8i32";
+    default:
+      assert(false);
+      return "";
+  }
+}
+
+// Returns the tile shape given for `type` by --iree-codegen-mmt4d-tile-sizes,
+// if any. The last entry for a given type wins.
+static Optional<MatmulTileParams> getMatmulTileParamsFromFlag(
+    MatmulType type) {
+  Optional<MatmulTileParams> result;
+  for (StringRef entry : clMmt4dTileSizes) {
+    auto [typeName, shape] = entry.split(':');
+    SmallVector<StringRef> sizes;
+    shape.split(sizes, 'x');
+    MatmulTileParams params;
+    if (sizes.size() != 3 || sizes[0].getAsInteger(10, params.M) ||
+        sizes[1].getAsInteger(10, params.N) ||
+        sizes[2].getAsInteger(10, params.K) || params.M <= 0 ||
+        params.N <= 0 || params.K <= 0) {
+      llvm::report_fatal_error(
+          llvm::Twine("invalid --iree-codegen-mmt4d-tile-sizes entry '") +
+          entry + "', expected <type>:<M0>x<N0>x<K0>");
+    }
+    if (typeName == getMatmulTypeName(type)) result = params;
+  }
+  return result;
+}
+
 static MatmulTileParams chooseMatmulTileParams(MatmulType type,
                                                ExecutableTargetAttr target) {
   if (isVMVXBackend(target) && hasMicrokernels(target)) {
     return chooseMatmulTileParamsVMVXMicrokernels();
   }
+  if (Optional<MatmulTileParams> params = getMatmulTileParamsFromFlag(type)) {
+    return *params;
+  }
   if (isAArch64(target)) {
     return chooseMatmulTileParamsAArch64(type, target);
   }
@@ -433,6 +485,15 @@ struct IREEMaterializeEncodingPass
   void runOnOperation() override;
 };
 
+struct IREEMaterializeConstantEncodingsPass
+    : public IREEMaterializeConstantEncodingsBase<
+          IREEMaterializeConstantEncodingsPass> {
+  void getDependentDialects(DialectRegistry &registry) const override {
+    registry.insert<arith::ArithDialect>();
+  }
+  void runOnOperation() override;
+};
+
 }  // namespace
 
 void IREEMaterializeEncodingPass::runOnOperation() {
@@ -498,6 +559,145 @@ void IREEMaterializeEncodingPass::runOnOperation() {
   }
 }
 
+/// Returns the constant of `encodedType` holding `sourceAttr`, padded with
+/// `padValueAttr` up to the shape of `encodedType`, in the packed layout
+/// described by `encodingInfo`. Encoded tensors are padded such that packing
+/// needs no padding of its own and so the packed data has as many elements as
+/// the encoded tensor: dispatches reading the constant reinterpret it in the
+/// packed shape instead of running the pack.
+static FailureOr<DenseElementsAttr> packConstant(
+    DenseElementsAttr sourceAttr, Attribute padValueAttr,
+    RankedTensorType encodedType, const MaterializeEncodingInfo &encodingInfo) {
+  Type elementType = encodedType.getElementType();
+  if (!elementType.isIntOrFloat() ||
+      elementType.getIntOrFloatBitWidth() % 8 != 0) {
+    return failure();
+  }
+  int64_t elementByteWidth = elementType.getIntOrFloatBitWidth() / 8;
+
+  ArrayRef<int64_t> shape = encodedType.getShape();
+  ArrayRef<int64_t> sourceShape = sourceAttr.getType().getShape();
+  int64_t rank = encodedType.getRank();
+  SmallVector<int64_t> tileSizeOfDim(rank, 1);
+  SmallVector<int64_t> innerTileOfDim(rank, -1);
+  for (auto [i, dim] : llvm::enumerate(encodingInfo.innerDimsPos)) {
+    int64_t tileSize = encodingInfo.innerTileSizes[i];
+    if (ShapedType::isDynamic(tileSize) || tileSize <= 0 ||
+        shape[dim] % tileSize != 0) {
+      return failure();
+    }
+    tileSizeOfDim[dim] = tileSize;
+    innerTileOfDim[dim] = i;
+  }
+  SmallVector<int64_t> outerDimsPerm(encodingInfo.outerDimsPerm);
+  if (outerDimsPerm.empty()) {
+    outerDimsPerm = llvm::to_vector(llvm::seq<int64_t>(0, rank));
+  }
+  SmallVector<int64_t> outerPosOfDim(rank);
+  SmallVector<int64_t> packedShape;
+  for (auto [pos, dim] : llvm::enumerate(outerDimsPerm)) {
+    outerPosOfDim[dim] = pos;
+    packedShape.push_back(shape[dim] / tileSizeOfDim[dim]);
+  }
+  llvm::append_range(packedShape, encodingInfo.innerTileSizes);
+
+  ArrayRef<char> sourceData = sourceAttr.getRawData();
+  ArrayRef<char> padData;
+  if (padValueAttr) {
+    padData = DenseElementsAttr::get(RankedTensorType::get({}, elementType),
+                                     padValueAttr)
+                  .getRawData();
+  }
+
+  // Walks the packed tensor in order and gathers each element from the padded
+  // source tensor.
+  std::vector<char> packedData(encodedType.getNumElements() *
+                               elementByteWidth);
+  SmallVector<int64_t> packedIndices(packedShape.size(), 0);
+  for (char *packedPtr = packedData.data(),
+            *packedEnd = packedData.data() + packedData.size();
+       packedPtr != packedEnd; packedPtr += elementByteWidth) {
+    int64_t sourceOffset = 0;
+    bool isPadding = false;
+    for (int64_t dim = 0; dim < rank; ++dim) {
+      int64_t index = packedIndices[outerPosOfDim[dim]] * tileSizeOfDim[dim];
+      if (innerTileOfDim[dim] >= 0) {
+        index += packedIndices[rank + innerTileOfDim[dim]];
+      }
+      isPadding |= index >= sourceShape[dim];
+      sourceOffset = sourceOffset * sourceShape[dim] + index;
+    }
+    if (isPadding) {
+      if (padData.empty()) return failure();
+      memcpy(packedPtr, padData.data(), elementByteWidth);
+    } else {
+      if (sourceAttr.isSplat()) sourceOffset = 0;
+      memcpy(packedPtr, sourceData.data() + sourceOffset * elementByteWidth,
+             elementByteWidth);
+    }
+    for (int64_t i = packedIndices.size() - 1; i >= 0; --i) {
+      if (++packedIndices[i] < packedShape[i]) break;
+      packedIndices[i] = 0;
+    }
+  }
+  return DenseElementsAttr::getFromRawBuffer(encodedType, packedData);
+}
+
+/// Returns the constant `encodingOp` produces when its source is a constant,
+/// optionally padded by a `tensor.pad` as formed by SetEncoding.
+static FailureOr<DenseElementsAttr> foldConstantEncoding(
+    SetEncodingOp encodingOp, ExecutableTargetAttr targetAttr) {
+  RankedTensorType encodedType = encodingOp.getResultType();
+  if (!encodedType.hasStaticShape()) return failure();
+  Value source = encodingOp.getSource();
+  Attribute padValueAttr;
+  if (auto padOp = source.getDefiningOp<tensor::PadOp>()) {
+    Value padValue = padOp.getConstantPaddingValue();
+    if (!padValue || !matchPattern(padValue, m_Constant(&padValueAttr)) ||
+        llvm::any_of(padOp.getStaticLow(),
+                     [](int64_t size) { return size != 0; })) {
+      return failure();
+    }
+    source = padOp.getSource();
+  }
+  DenseElementsAttr sourceAttr;
+  if (!matchPattern(source, m_Constant(&sourceAttr))) return failure();
+  FailureOr<MaterializeEncodingInfo> encodingInfo =
+      chooseEncodingInfo(encodedType, targetAttr);
+  if (failed(encodingInfo)) return failure();
+  return packConstant(sourceAttr, padValueAttr, encodedType, *encodingInfo);
+}
+
+void IREEMaterializeConstantEncodingsPass::runOnOperation() {
+  ModuleOp moduleOp = getOperation();
+
+  // The layout is only known on the host when all dispatches are compiled for
+  // the same target.
+  SmallVector<ExecutableTargetAttr, 4> targetAttrs =
+      IREE::HAL::DeviceTargetAttr::lookupExecutableTargets(moduleOp);
+  if (targetAttrs.empty() ||
+      llvm::any_of(targetAttrs, [&](ExecutableTargetAttr targetAttr) {
+        return targetAttr != targetAttrs.front();
+      })) {
+    return;
+  }
+
+  SmallVector<SetEncodingOp> encodingOps;
+  moduleOp.walk([&](SetEncodingOp op) { encodingOps.push_back(op); });
+  for (SetEncodingOp encodingOp : encodingOps) {
+    FailureOr<DenseElementsAttr> packedAttr =
+        foldConstantEncoding(encodingOp, targetAttrs.front());
+    if (failed(packedAttr)) continue;
+    OpBuilder builder(encodingOp);
+    Value packed =
+        builder.create<arith::ConstantOp>(encodingOp.getLoc(), *packedAttr);
+    Operation *sourceOp = encodingOp.getSource().getDefiningOp();
+    encodingOp.replaceAllUsesWith(packed);
+    encodingOp.erase();
+    if (sourceOp && isOpTriviallyDead(sourceOp)) sourceOp->erase();
+  }
+}
+
 MaterializeEncodingValueFn getMaterializeEncodingValueFn(
     IREE::HAL::ExecutableTargetAttr targetAttr) {
   if (isVMVXBackend(targetAttr) && hasMicrokernels(targetAttr)) {
@@ -511,5 +711,10 @@ createIREEMaterializeEncodingPass() {
   return std::make_unique<IREEMaterializeEncodingPass>();
 }
 
+std::unique_ptr<OperationPass<ModuleOp>>
+createIREEMaterializeConstantEncodingsPass() {
+  return std::make_unique<IREEMaterializeConstantEncodingsPass>();
+}
+
 }  // namespace iree_compiler
 }  // namespace mlir
@@ -6,6 +6,25 @@
 
 #include "iree/compiler/Codegen/Common/UserConfig.h"
 
+#include "llvm/ADT/StringMap.h"
+#include "llvm/Support/CommandLine.h"
+#include "llvm/Support/MemoryBuffer.h"
+#include "mlir/AsmParser/AsmParser.h"
+
+static llvm::cl::opt<std::string> clTuningDatabase(
+    "iree-codegen-tuning-database",
+    llvm::cl::desc(
+        "Path to a tuning database produced by tune_dispatch_configs.py. Each "
+        "line maps a root op key to an #iree_codegen.compilation_info that is "
+        "used instead of the configuration heuristics"),
+    llvm::cl::init(""));
+
+static llvm::cl::opt<bool> clTuningDatabasePrintKeys(
+    "iree-codegen-tuning-database-print-keys",
+    llvm::cl::desc("Emits a remark with the tuning database key of each root "
+                   "op that is looked up in the tuning database"),
+    llvm::cl::init(false));
+
 namespace mlir {
 namespace iree_compiler {
 
@@ -33,5 +52,86 @@ LogicalResult setUserConfig(
   return success();
 }
 
+namespace {
+
+/// Entries of the tuning database as unparsed attribute strings. Attributes
+/// are parsed on lookup as each executable may be compiled in its own context.
+struct TuningDatabase {
+  bool loaded = false;
+  std::string error;
+  llvm::StringMap<std::string> entries;
+};
+
+}  // namespace
+
+/// Loads the database at `path`. Each non-empty line not starting with `#` is
+/// `<key>\t<attribute>`. The key `*` matches every root op, which the tuning
+/// tool uses when benchmarking candidates for single-dispatch modules.
+static TuningDatabase loadTuningDatabase(StringRef path) {
+  TuningDatabase database;
+  if (path.empty()) return database;
+  auto fileOrErr = llvm::MemoryBuffer::getFile(path, /*IsText=*/true);
+  if (std::error_code error = fileOrErr.getError()) {
+    database.error = "failed to read tuning database '" + path.str() +
+                     "': " + error.message();
+    return database;
+  }
+  SmallVector<StringRef> lines;
+  fileOrErr.get()->getBuffer().split(lines, '\n', /*MaxSplit=*/-1,
+                                     /*KeepEmpty=*/false);
+  for (StringRef line : lines) {
+    line = line.trim();
+    if (line.empty() || line.startswith("#")) continue;
+    auto [key, value] = line.split('\t');
+    if (value.empty()) {
+      database.error = "malformed tuning database entry: '" + line.str() + "'";
+      return database;
+    }
+    database.entries[key.trim()] = value.trim().str();
+  }
+  database.loaded = true;
+  return database;
+}
+
+static const TuningDatabase &getTuningDatabase() {
+  static const TuningDatabase database = loadTuningDatabase(clTuningDatabase);
+  return database;
+}
+
+std::string getTuningDatabaseKey(Operation *rootOp) {
+  std::string key;
+  llvm::raw_string_ostream os(key);
+  os << rootOp->getName() << " (";
+  llvm::interleaveComma(rootOp->getOperandTypes(), os);
+  os << ") -> (";
+  llvm::interleaveComma(rootOp->getResultTypes(), os);
+  os << ")";
+  return os.str();
+}
+
+FailureOr<IREE::Codegen::CompilationInfoAttr> getTunedConfig(
+    Operation *rootOp) {
+  if (clTuningDatabase.empty()) return IREE::Codegen::CompilationInfoAttr();
+  const TuningDatabase &database = getTuningDatabase();
+  if (!database.loaded) return rootOp->emitError(database.error);
+
+  std::string key = getTuningDatabaseKey(rootOp);
+  if (clTuningDatabasePrintKeys) {
+    rootOp->emitRemark() << "tuning database key: '" << key << "'";
+  }
+  auto it = database.entries.find(key);
+  if (it == database.entries.end()) it = database.entries.find("*");
+  if (it == database.entries.end()) return IREE::Codegen::CompilationInfoAttr();
+
+  auto compilationInfo =
+      parseAttribute(it->second, rootOp->getContext())
+          .dyn_cast_or_null<IREE::Codegen::CompilationInfoAttr>();
+  if (!compilationInfo) {
+    return rootOp->emitError("invalid tuning database entry for '")
+           << it->first() << "': expected #iree_codegen.compilation_info";
+  }
+  return compilationInfo;
+}
+
 }  // namespace iree_compiler
 }  // namespace mlir
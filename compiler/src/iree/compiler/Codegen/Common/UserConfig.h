@@ -13,5 +13,15 @@ namespace iree_compiler {
 LogicalResult setUserConfig(func::FuncOp entryPointFn, Operation *computeOp,
                             IREE::Codegen::CompilationInfoAttr compilationInfo);
 
+/// Returns the key identifying `rootOp` in a tuning database: the op name
+/// followed by its operand and result types.
+std::string getTuningDatabaseKey(Operation *rootOp);
+
+/// Returns the compilation info for `rootOp` from the tuning database passed
+/// with `--iree-codegen-tuning-database`, a null attribute if there is no
+/// entry for it, or failure if the database could not be loaded.
+FailureOr<IREE::Codegen::CompilationInfoAttr> getTunedConfig(
+    Operation *rootOp);
+
 }  // namespace iree_compiler
 }  // namespace mlir
@@ -0,0 +1,99 @@
+// RUN: iree-opt --split-input-file --iree-codegen-materialize-constant-encodings --iree-codegen-mmt4d-tile-sizes=f32f32f32:2x2x2 %s | FileCheck %s
+// RUN: iree-opt --split-input-file --pass-pipeline="builtin.module(func.func(iree-flow-set-encoding{default-padding=4}),iree-codegen-materialize-constant-encodings,func.func(iree-flow-form-dispatch-regions,iree-flow-form-dispatch-workgroups))" --iree-codegen-mmt4d-tile-sizes=f32f32f32:2x2x2 %s | FileCheck %s --check-prefix=DISPATCH
+
+#executable_target_embedded_elf_x86_64_ = #hal.executable.target<"llvm-cpu", "embedded-elf-x86_64", {target_triple = "x86_64-none-elf"}>
+#device_target_cpu = #hal.device.target<"llvm-cpu", {
+  executable_targets = [#executable_target_embedded_elf_x86_64_]
+}>
+module attributes {hal.device.targets = [#device_target_cpu]} {
+  func.func @fold_rhs_f32() -> tensor<4x4xf32, #iree_linalg_ext.encoding<MATMUL_F32F32F32_RHS>> {
+    %cst = arith.constant dense<[[0.0, 1.0, 2.0, 3.0], [4.0, 5.0, 6.0, 7.0], [8.0, 9.0, 10.0, 11.0], [12.0, 13.0, 14.0, 15.0]]> : tensor<4x4xf32>
+    %0 = iree_linalg_ext.set_encoding %cst : tensor<4x4xf32> -> tensor<4x4xf32, #iree_linalg_ext.encoding<MATMUL_F32F32F32_RHS>>
+    return %0 : tensor<4x4xf32, #iree_linalg_ext.encoding<MATMUL_F32F32F32_RHS>>
+  }
+}
+// CHECK-LABEL: func.func @fold_rhs_f32()
+//       CHECK:   %[[CST:.+]] = arith.constant dense<
+//  CHECK-SAME:       [0.000000e+00, 1.000000e+00, 4.000000e+00, 5.000000e+00]
+//  CHECK-SAME:       [2.000000e+00, 3.000000e+00, 6.000000e+00, 7.000000e+00]
+//  CHECK-SAME:       [8.000000e+00, 9.000000e+00, 1.200000e+01, 1.300000e+01]
+//  CHECK-SAME:       [1.000000e+01, 1.100000e+01, 1.400000e+01, 1.500000e+01]
+//  CHECK-SAME:       tensor<4x4xf32, #iree_linalg_ext.encoding<MATMUL_F32F32F32_RHS>>
+//   CHECK-NOT:   iree_linalg_ext.set_encoding
+//       CHECK:   return %[[CST]]
+
+// -----
+
+#executable_target_embedded_elf_x86_64_ = #hal.executable.target<"llvm-cpu", "embedded-elf-x86_64", {target_triple = "x86_64-none-elf"}>
+#device_target_cpu = #hal.device.target<"llvm-cpu", {
+  executable_targets = [#executable_target_embedded_elf_x86_64_]
+}>
+module attributes {hal.device.targets = [#device_target_cpu]} {
+  func.func @fold_padded_rhs_f32() -> tensor<4x4xf32, #iree_linalg_ext.encoding<MATMUL_F32F32F32_RHS>> {
+    %zero = arith.constant 0.0 : f32
+    %cst = arith.constant dense<[[1.0, 2.0, 3.0], [4.0, 5.0, 6.0], [7.0, 8.0, 9.0]]> : tensor<3x3xf32>
+    %padded = tensor.pad %cst low[0, 0] high[1, 1] {
+    ^bb0(%arg0: index, %arg1: index):
+      tensor.yield %zero : f32
+    } : tensor<3x3xf32> to tensor<4x4xf32>
+    %0 = iree_linalg_ext.set_encoding %padded : tensor<4x4xf32> -> tensor<4x4xf32, #iree_linalg_ext.encoding<MATMUL_F32F32F32_RHS>>
+    return %0 : tensor<4x4xf32, #iree_linalg_ext.encoding<MATMUL_F32F32F32_RHS>>
+  }
+}
+// CHECK-LABEL: func.func @fold_padded_rhs_f32()
+//       CHECK:   %[[CST:.+]] = arith.constant dense<
+//  CHECK-SAME:       [1.000000e+00, 2.000000e+00, 4.000000e+00, 5.000000e+00]
+//  CHECK-SAME:       [3.000000e+00, 0.000000e+00, 6.000000e+00, 0.000000e+00]
+//  CHECK-SAME:       [7.000000e+00, 8.000000e+00, 0.000000e+00, 0.000000e+00]
+//  CHECK-SAME:       [9.000000e+00, 0.000000e+00, 0.000000e+00, 0.000000e+00]
+//  CHECK-SAME:       tensor<4x4xf32, #iree_linalg_ext.encoding<MATMUL_F32F32F32_RHS>>
+//   CHECK-NOT:   tensor.pad
+//   CHECK-NOT:   iree_linalg_ext.set_encoding
+//       CHECK:   return %[[CST]]
+
+// -----
+
+// Each target may choose a different layout so the pack is left to dispatches.
+
+#executable_target_embedded_elf_x86_64_ = #hal.executable.target<"llvm-cpu", "embedded-elf-x86_64", {target_triple = "x86_64-none-elf"}>
+#executable_target_embedded_elf_aarch64_ = #hal.executable.target<"llvm-cpu", "embedded-elf-arm_64", {target_triple = "aarch64-none-elf"}>
+#device_target_cpu = #hal.device.target<"llvm-cpu", {
+  executable_targets = [#executable_target_embedded_elf_x86_64_, #executable_target_embedded_elf_aarch64_]
+}>
+module attributes {hal.device.targets = [#device_target_cpu]} {
+  func.func @multiple_targets() -> tensor<4x4xf32, #iree_linalg_ext.encoding<MATMUL_F32F32F32_RHS>> {
+    %cst = arith.constant dense<[[0.0, 1.0, 2.0, 3.0], [4.0, 5.0, 6.0, 7.0], [8.0, 9.0, 10.0, 11.0], [12.0, 13.0, 14.0, 15.0]]> : tensor<4x4xf32>
+    %0 = iree_linalg_ext.set_encoding %cst : tensor<4x4xf32> -> tensor<4x4xf32, #iree_linalg_ext.encoding<MATMUL_F32F32F32_RHS>>
+    return %0 : tensor<4x4xf32, #iree_linalg_ext.encoding<MATMUL_F32F32F32_RHS>>
+  }
+}
+// CHECK-LABEL: func.func @multiple_targets()
+//       CHECK:   iree_linalg_ext.set_encoding
+
+// -----
+
+// The constant RHS of a data tiled matmul needs no dispatch to pack it.
+
+#executable_target_embedded_elf_x86_64_ = #hal.executable.target<"llvm-cpu", "embedded-elf-x86_64", {target_triple = "x86_64-none-elf"}>
+#device_target_cpu = #hal.device.target<"llvm-cpu", {
+  executable_targets = [#executable_target_embedded_elf_x86_64_]
+}>
+module attributes {hal.device.targets = [#device_target_cpu]} {
+  func.func @matmul_constant_rhs(%lhs: tensor<4x4xf32>) -> tensor<4x4xf32> {
+    %zero = arith.constant 0.0 : f32
+    %rhs = arith.constant dense<[[0.0, 1.0, 2.0, 3.0], [4.0, 5.0, 6.0, 7.0], [8.0, 9.0, 10.0, 11.0], [12.0, 13.0, 14.0, 15.0]]> : tensor<4x4xf32>
+    %empty = tensor.empty() : tensor<4x4xf32>
+    %fill = linalg.fill ins(%zero : f32) outs(%empty : tensor<4x4xf32>) -> tensor<4x4xf32>
+    %0 = linalg.matmul ins(%lhs, %rhs : tensor<4x4xf32>, tensor<4x4xf32>) outs(%fill : tensor<4x4xf32>) -> tensor<4x4xf32>
+    return %0 : tensor<4x4xf32>
+  }
+}
+// DISPATCH-LABEL: func.func @matmul_constant_rhs(
+//  DISPATCH-SAME:     %[[LHS:[a-zA-Z0-9]+]]: tensor<4x4xf32>
+//   DISPATCH-NOT:   set_encoding {{.+}}MATMUL_F32F32F32_RHS
+//   DISPATCH-DAG:   %[[RHS:.+]] = arith.constant dense<{{.+}}> : tensor<4x4xf32, #iree_linalg_ext.encoding<MATMUL_F32F32F32_RHS>>
+//   DISPATCH-DAG:   %[[PACKED_LHS:.+]] = flow.dispatch.workgroups{{.*}}(%[[LHS]])
+//       DISPATCH:   flow.dispatch.workgroups{{.*}}(%[[PACKED_LHS]], %[[RHS]])
+//       DISPATCH:     linalg.matmul
+//   DISPATCH-NOT:   set_encoding {{.+}}MATMUL_F32F32F32_RHS
+//       DISPATCH:   return
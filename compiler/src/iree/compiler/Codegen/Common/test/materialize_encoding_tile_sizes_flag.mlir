@@ -0,0 +1,43 @@
+// RUN: iree-opt --iree-codegen-materialize-encoding --iree-codegen-mmt4d-tile-sizes=i8i8i32:4x4x4,f32f32f32:16x16x1 --canonicalize --cse --split-input-file %s | FileCheck %s
+
+func.func @set_encoding_lhs_f32() {
+  %c0 = arith.constant 0 : index
+  %d0 = hal.interface.constant.load [0] : index
+  %d1 = hal.interface.constant.load [1] : index
+  %0 = hal.interface.binding.subspan set(0) binding(0) type(storage_buffer) offset(%c0) alignment(64)
+      : !flow.dispatch.tensor<readonly:tensor<?x?xf32>>{%d0, %d1}
+  %1 = hal.interface.binding.subspan set(0) binding(1) type(storage_buffer) offset(%c0) alignment(64)
+      : !flow.dispatch.tensor<writeonly:tensor<?x?xf32, #iree_linalg_ext.encoding<MATMUL_F32F32F32_LHS>>>{%d0, %d1}
+  %2 = flow.dispatch.tensor.load %0, offsets = [0, 0], sizes = [%d0, %d1], strides = [1, 1]
+      : !flow.dispatch.tensor<readonly:tensor<?x?xf32>>{%d0, %d1} -> tensor<?x?xf32>
+  %3 = iree_linalg_ext.set_encoding %2 : tensor<?x?xf32> -> tensor<?x?xf32, #iree_linalg_ext.encoding<MATMUL_F32F32F32_LHS>>
+  flow.dispatch.tensor.store %3, %1, offsets = [0, 0], sizes = [%d0, %d1], strides = [1, 1]
+      : tensor<?x?xf32, #iree_linalg_ext.encoding<MATMUL_F32F32F32_LHS>>
+      -> !flow.dispatch.tensor<writeonly:tensor<?x?xf32, #iree_linalg_ext.encoding<MATMUL_F32F32F32_LHS>>>{%d0, %d1}
+  return
+}
+// CHECK-LABEL: func @set_encoding_lhs_f32()
+//       CHECK:   iree_linalg_ext.pack
+//  CHECK-SAME:       inner_dims_pos = [0, 1] inner_tiles = [16, 1]
+
+// -----
+
+func.func @set_encoding_rhs_i8() {
+  %c0 = arith.constant 0 : index
+  %d0 = hal.interface.constant.load [0] : index
+  %d1 = hal.interface.constant.load [1] : index
+  %0 = hal.interface.binding.subspan set(0) binding(0) type(storage_buffer) offset(%c0) alignment(64)
+      : !flow.dispatch.tensor<readonly:tensor<?x?xi8>>{%d0, %d1}
+  %1 = hal.interface.binding.subspan set(0) binding(1) type(storage_buffer) offset(%c0) alignment(64)
+      : !flow.dispatch.tensor<writeonly:tensor<?x?xi8, #iree_linalg_ext.encoding<MATMUL_I8I8I32_RHS>>>{%d0, %d1}
+  %2 = flow.dispatch.tensor.load %0, offsets = [0, 0], sizes = [%d0, %d1], strides = [1, 1]
+      : !flow.dispatch.tensor<readonly:tensor<?x?xi8>>{%d0, %d1} -> tensor<?x?xi8>
+  %3 = iree_linalg_ext.set_encoding %2 : tensor<?x?xi8> -> tensor<?x?xi8, #iree_linalg_ext.encoding<MATMUL_I8I8I32_RHS>>
+  flow.dispatch.tensor.store %3, %1, offsets = [0, 0], sizes = [%d0, %d1], strides = [1, 1]
+      : tensor<?x?xi8, #iree_linalg_ext.encoding<MATMUL_I8I8I32_RHS>>
+      -> !flow.dispatch.tensor<writeonly:tensor<?x?xi8, #iree_linalg_ext.encoding<MATMUL_I8I8I32_RHS>>>{%d0, %d1}
+  return
+}
+// CHECK-LABEL: func @set_encoding_rhs_i8()
+//       CHECK:   iree_linalg_ext.pack
+//  CHECK-SAME:       inner_dims_pos = [0, 1] inner_tiles = [4, 4]
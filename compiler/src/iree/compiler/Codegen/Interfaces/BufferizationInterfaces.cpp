@@ -448,6 +448,8 @@ void registerBufferizationInterfaces(DialectRegistry &registry) {
         IREE::LinalgExt::WinogradOutputTransformOp::attachInterface<
             LinalgExtOpInterface<IREE::LinalgExt::WinogradOutputTransformOp>>(
             *ctx);
+        IREE::LinalgExt::AttentionOp::attachInterface<
+            LinalgExtOpInterface<IREE::LinalgExt::AttentionOp>>(*ctx);
       });
 }
 
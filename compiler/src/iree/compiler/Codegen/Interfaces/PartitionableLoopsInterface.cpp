@@ -150,6 +150,23 @@ struct FftOpPartitionableLoops
   }
 };
 
+/// External model implementation for specifying partitionable loops of
+/// AttentionOp. Only the batch and query sequence loops are distributed; the
+/// value dimension is kept whole so that the softmax of a query row is not
+/// recomputed for every tile of the output columns.
+struct AttentionOpPartitionableLoops
+    : public PartitionableLoopsInterface::ExternalModel<
+          AttentionOpPartitionableLoops, IREE::LinalgExt::AttentionOp> {
+  llvm::SmallVector<unsigned> getPartitionableLoops(
+      Operation *op, llvm::Optional<unsigned> maxNumPartitionedLoops) const {
+    if (maxNumPartitionedLoops.has_value() &&
+        maxNumPartitionedLoops.value() < 2) {
+      return {1};
+    }
+    return {0, 1};
+  }
+};
+
 /// External model implementation for making all parallel loops as
 /// partitionable.
 template <typename OpTy>
@@ -236,6 +253,8 @@ void registerPartitionableLoopsInterfaceModels(DialectRegistry &registry) {
     IREE::LinalgExt::WinogradOutputTransformOp::attachInterface<
         AllParallelAsPartitionableLoops<
             IREE::LinalgExt::WinogradOutputTransformOp>>(*ctx);
+    IREE::LinalgExt::AttentionOp::attachInterface<
+        AttentionOpPartitionableLoops>(*ctx);
   });
 }
 
@@ -230,6 +230,7 @@ class HALDispatchABI {
     /*uint32_t*/ processor_id,
     /*intptr_t*/ local_memory,
     /*uint32_t*/ local_memory_size,
+    /*uint32_t*/ workgroup_range_count,
   };
   friend WorkgroupStateField operator+(WorkgroupStateField lhs, int32_t rhs) {
     return static_cast<WorkgroupStateField>(static_cast<int32_t>(lhs) + rhs);
@@ -267,6 +268,9 @@ class HALDispatchABI {
     fieldTypes.push_back(LLVM::LLVMPointerType::get(int8PtrType));
     fieldTypes.push_back(uint32Type);
 
+    // uint32_t workgroup_range_count;
+    fieldTypes.push_back(uint32Type);
+
     LogicalResult bodySet = structType.setBody(fieldTypes, /*isPacked=*/false);
     assert(succeeded(bodySet) &&
            "could not set the body of an identified struct");
@@ -1109,6 +1109,21 @@ static LogicalResult setRootConfig(
                                                pipeline);
 }
 
+/// Sets the lowering configuration for dispatch region for the Winograd
+/// input and output transforms. Their iteration space is the batch and channel
+/// dimensions; every image tile of a channel is transformed with two 8x8
+/// matmuls that the CPUWinograd pipeline vectorizes.
+static LogicalResult setWinogradRootConfig(func::FuncOp entryPointFn,
+                                           TilingInterface op) {
+  SmallVector<int64_t> workgroupTileSizes =
+      getLinalgExtDefaultWorkgroupTileSizes(op, defaultWorkgroupTileSize);
+  // Distribute batches over workgroups so each one only reads a single image.
+  workgroupTileSizes[0] = 1;
+  TileSizesListType tileSizes = {workgroupTileSizes};
+  return setOpConfigAndEntryPointFnTranslation(
+      entryPointFn, op, tileSizes, DispatchLoweringPassPipeline::CPUWinograd);
+}
+
 static void setX86WorkgroupTileSizes(
     linalg::GenericOp genericOp, unsigned numLoops,
     ArrayRef<int64_t> flowTileSizes, ArrayRef<int64_t> minTileSizes,
@@ -1612,6 +1627,9 @@ static LogicalResult setRootConfigImpl(
               linalg::Conv2DNhwcHwcfOp, linalg::Conv2DNchwFchwOp,
               linalg::DepthwiseConv2DNhwcHwcOp>(
             [&](auto op) { return setRootConfig(entryPointFn, op); })
+        .Case<IREE::LinalgExt::WinogradInputTransformOp,
+              IREE::LinalgExt::WinogradOutputTransformOp>(
+            [&](auto op) { return setWinogradRootConfig(entryPointFn, op); })
         .Case<linalg::ContractionOpInterface>(
             [&](auto op) { return setRootConfig(entryPointFn, op); })
         .Case<linalg::LinalgOp>(
@@ -1692,6 +1710,17 @@ static LogicalResult setRootConfig(func::FuncOp entryPointFn,
   }
   Operation *rootOperation = rootOp.value();
 
+  // A configuration from the tuning database takes precedence over the
+  // heuristics, but not over one annotated in the incoming IR.
+  if (rootOperation && !getTranslationInfo(entryPointFn)) {
+    FailureOr<IREE::Codegen::CompilationInfoAttr> tunedConfig =
+        getTunedConfig(rootOperation);
+    if (failed(tunedConfig)) return failure();
+    if (*tunedConfig) {
+      return setUserConfig(entryPointFn, rootOperation, *tunedConfig);
+    }
+  }
+
   if (rootOperation) {
     auto targetAttr = IREE::HAL::ExecutableTargetAttr::lookup(entryPointFn);
     if (isVMVXBackend(targetAttr)) {
@@ -235,6 +235,9 @@ void LLVMCPULowerExecutableTargetPass::runOnOperation() {
           case IREE::Codegen::DispatchLoweringPassPipeline::CPUDataTiling:
             addCPUDataTilingPipeline(executableLoweringPipeline);
             break;
+          case IREE::Codegen::DispatchLoweringPassPipeline::CPUWinograd:
+            addCPUWinogradPassPipeline(executableLoweringPipeline);
+            break;
           case IREE::Codegen::DispatchLoweringPassPipeline::VMVXDefault:
             addVMVXDefaultPassPipeline(executableLoweringPipeline,
                                        enableMicrokernels);
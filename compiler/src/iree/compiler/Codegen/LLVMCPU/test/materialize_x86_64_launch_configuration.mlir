@@ -1425,3 +1425,44 @@ hal.executable private @multi_root {
 //  CHECK-NOT: lowering_config
 //      CHECK: linalg.generic
 // CHECK-SAME:     lowering_config = #[[CONFIG]]
+
+// -----
+
+#pipeline_layout = #hal.pipeline.layout<push_constants = 0, sets = [
+  #hal.descriptor_set.layout<0, bindings = [
+    #hal.descriptor_set.binding<0, storage_buffer>,
+    #hal.descriptor_set.binding<1, storage_buffer>
+  ]>
+]>
+hal.executable private @winograd_input_transform {
+  hal.executable.variant @llvm, target = <"llvm-cpu", "embedded-elf-x86_64", {
+    data_layout = "e-m:e-p270:32:32-p271:32:32-p272:64:64-i64:64-f80:128-n8:16:32:64-S128",
+    native_vector_size = 16 : index,
+    target_triple = "x86_64-unknown-linux-gnu"
+  }> {
+    hal.executable.export @winograd_input_transform layout(#pipeline_layout)
+    builtin.module {
+      func.func @winograd_input_transform() {
+        %c0 = arith.constant 0 : index
+        %0 = hal.interface.binding.subspan set(0) binding(0) type(storage_buffer) offset(%c0) alignment(64)
+            : !flow.dispatch.tensor<readonly:tensor<2x10x10x1280xf32>>
+        %1 = hal.interface.binding.subspan set(0) binding(1) type(storage_buffer) offset(%c0) alignment(64)
+            : !flow.dispatch.tensor<writeonly:tensor<8x8x2x2x2x1280xf32>>
+        %2 = flow.dispatch.tensor.load %0, offsets = [0, 0, 0, 0], sizes = [2, 10, 10, 1280], strides = [1, 1, 1, 1]
+            : !flow.dispatch.tensor<readonly:tensor<2x10x10x1280xf32>> -> tensor<2x10x10x1280xf32>
+        %3 = tensor.empty() : tensor<8x8x2x2x2x1280xf32>
+        %4 = iree_linalg_ext.winograd.input_transform output_tile_size(6) kernel_size(3) image_dimensions([1, 2])
+            ins(%2 : tensor<2x10x10x1280xf32>) outs(%3 : tensor<8x8x2x2x2x1280xf32>) -> tensor<8x8x2x2x2x1280xf32>
+        flow.dispatch.tensor.store %4, %1, offsets = [0, 0, 0, 0, 0, 0], sizes = [8, 8, 2, 2, 2, 1280], strides = [1, 1, 1, 1, 1, 1]
+            : tensor<8x8x2x2x2x1280xf32> -> !flow.dispatch.tensor<writeonly:tensor<8x8x2x2x2x1280xf32>>
+        return
+      }
+    }
+  }
+}
+//  CHECK-DAG: #[[CONFIG:.+]] = #iree_codegen.lowering_config<tile_sizes = {{\[}}[1, 64]{{\]}}
+//  CHECK-DAG: #[[TRANSLATION:.+]] = #iree_codegen.translation_info<CPUWinograd>
+//      CHECK: hal.executable.export public @winograd_input_transform
+// CHECK-SAME:     translation_info = #[[TRANSLATION]]
+//      CHECK: iree_linalg_ext.winograd.input_transform
+// CHECK-SAME:     lowering_config = #[[CONFIG]]
@@ -63,6 +63,8 @@ struct TargetInfo {
   // TODO: add finer grain control for other tensorcore types.
   bool hasTF32TensorCore = false;
   bool hasWarpShuffle = false;
+  // SM version of the cuda target, 0 if unknown.
+  int64_t smVersion = 0;
 };
 
 struct TileWorkgroupSizePair {
@@ -73,6 +75,9 @@ struct TileWorkgroupSizePair {
 
 // Software pipeline depths
 constexpr unsigned softwarePipelineDepthTensorCore = 4;
+// Hopper has enough shared memory to keep more stages of async copies in
+// flight.
+constexpr unsigned softwarePipelineDepthTensorCoreSm90 = 6;
 // Simt codegen does not do software pipelining.
 constexpr unsigned softwarePipelineDepthSimt = 0;
 }  // namespace
@@ -96,7 +101,17 @@ static void getMatmulConfig(SmallVectorImpl<TileWorkgroupSizePair> &tileSizes) {
 /// Return the best combination of tile size and wg size when using tensorcore
 /// operations.
 static void getTensorCoreConfig(
-    SmallVectorImpl<TileWorkgroupSizePair> &tileSizes, bool isFp16) {
+    SmallVectorImpl<TileWorkgroupSizePair> &tileSizes, bool isFp16,
+    const TargetInfo &targetInfo) {
+  // Larger tiles only pay off on Hopper where the deeper pipeline hides the
+  // latency of the bigger copies.
+  if (targetInfo.smVersion >= 90) {
+    if (isFp16) {
+      tileSizes.push_back(TileWorkgroupSizePair({{64, 64, 32}, {64, 2, 1}}));
+    } else {
+      tileSizes.push_back(TileWorkgroupSizePair({{64, 64, 16}, {64, 2, 1}}));
+    }
+  }
   // Tile sizes are skewed towards small matmul for now. Long term the plan is
   // to not rely on hardcoded configurations.
   if (isFp16) {
@@ -152,10 +167,39 @@ static TargetInfo getTargetInfo(func::FuncOp entryPoint) {
     return info;
   }
   int64_t smVersion = version.getZExtValue();
+  info.smVersion = smVersion;
   if (smVersion >= 80) info.hasTF32TensorCore = true;
   return info;
 }
 
+/// Returns the shared memory a single workgroup can use on the given SM
+/// version once the dynamic shared memory limit of the kernel is raised.
+static int64_t getMaxSharedMemoryBytes(int64_t smVersion) {
+  if (smVersion >= 90) return 227 * 1024;
+  if (smVersion == 80 || smVersion == 87) return 163 * 1024;
+  if (smVersion >= 86) return 99 * 1024;
+  if (smVersion == 75) return 64 * 1024;
+  if (smVersion >= 70) return 96 * 1024;
+  return 48 * 1024;
+}
+
+/// Returns the number of shared memory buffers the copies of a tensorcore
+/// matmul with the given workgroup tile are pipelined over. The depth is picked
+/// per SM version and capped so that all the buffers fit into half of the
+/// shared memory, leaving room for a second resident workgroup.
+static unsigned getTensorCorePipelineDepth(const TargetInfo &targetInfo,
+                                           ArrayRef<int64_t> tileSize,
+                                           int64_t elementBytes) {
+  int64_t depth = targetInfo.smVersion >= 90
+                      ? softwarePipelineDepthTensorCoreSm90
+                      : softwarePipelineDepthTensorCore;
+  int64_t stageBytes =
+      (tileSize[0] * tileSize[2] + tileSize[1] * tileSize[2]) * elementBytes;
+  int64_t maxDepth =
+      getMaxSharedMemoryBytes(targetInfo.smVersion) / 2 / stageBytes;
+  return std::max<int64_t>(1, std::min(depth, maxDepth));
+}
+
 static bool supportsTensorCore(func::FuncOp entryPoint, linalg::LinalgOp op,
                                const TargetInfo &targetInfo) {
   // Limit tensor core pipeline to matmul as not all combinations of transpose
@@ -263,13 +307,12 @@ static LogicalResult setContractConfig(func::FuncOp entryPoint,
     /// Try tensorcore config first.
     if (supportsTensorCore(entryPoint, op, targetInfo)) {
       SmallVector<TileWorkgroupSizePair> TCtileSizeConfig;
-
-      getTensorCoreConfig(TCtileSizeConfig, op.getDpsInputOperand(0)
-                                                ->get()
-                                                .getType()
-                                                .cast<RankedTensorType>()
-                                                .getElementType()
-                                                .isF16());
+      Type elementType = op.getDpsInputOperand(0)
+                             ->get()
+                             .getType()
+                             .cast<RankedTensorType>()
+                             .getElementType();
+      getTensorCoreConfig(TCtileSizeConfig, elementType.isF16(), targetInfo);
       // Pick the best configuration where the original shape is aligned on the
       // tile size.
       for (TileWorkgroupSizePair &config : TCtileSizeConfig) {
@@ -279,7 +322,11 @@ static LogicalResult setContractConfig(func::FuncOp entryPoint,
           return setMatmulConfig(
               config.tileSize[0], config.tileSize[1], config.tileSize[2],
               config.workgroupSize,
-              sizeK == config.tileSize[2] ? 1 : softwarePipelineDepthTensorCore,
+              sizeK == config.tileSize[2]
+                  ? 1
+                  : getTensorCorePipelineDepth(
+                        targetInfo, config.tileSize,
+                        elementType.getIntOrFloatBitWidth() / 8),
               IREE::Codegen::DispatchLoweringPassPipeline::
                   LLVMGPUMatmulTensorCore);
         }
@@ -393,6 +440,21 @@ static LogicalResult setSortConfig(func::FuncOp entryPoint, Operation *op) {
       workgroupSize);
 }
 
+/// Sets the configuration for attention ops. Each workgroup processes a block
+/// of query rows of one batch and each thread one row of that block, iterating
+/// over the full key sequence with the online softmax once the op is
+/// decomposed.
+static LogicalResult setAttentionConfig(func::FuncOp entryPoint,
+                                        IREE::LinalgExt::AttentionOp op) {
+  std::array<int64_t, 3> workgroupSize = {cudaWarpSize, 1, 1};
+  SmallVector<int64_t> workgroupTileSizes = {1, workgroupSize[0], 0};
+  TileSizesListType tileSizes = {workgroupTileSizes};
+  return setOpConfigAndEntryPointFnTranslation(
+      entryPoint, op, tileSizes,
+      IREE::Codegen::DispatchLoweringPassPipeline::LLVMGPUVectorize,
+      workgroupSize);
+}
+
 // Basic default properties for linalg ops that haven't been tuned.
 static LogicalResult setRootDefaultConfig(func::FuncOp entryPoint,
                                           Operation *op) {
@@ -538,6 +600,12 @@ static LogicalResult setReductionTransformDialectConfig(
   return setTranslationInfo(entryPoint, translationInfo);
 }
 
+// Largest number of rows reduced by a single workgroup when rows are short
+// enough to be reduced by a single warp. Each thread holds this many vectors.
+static constexpr int64_t kWarpReductionMaxRowsPerWorkgroup = 4;
+// Smallest number of workgroups left after packing multiple rows into each.
+static constexpr int64_t kWarpReductionMinWorkgroupCount = 64;
+
 /// Set the configuration for reductions that can be mapped to warp reductions.
 static LogicalResult setWarpReductionConfig(func::FuncOp entryPoint,
                                             linalg::LinalgOp op,
@@ -596,6 +664,23 @@ static LogicalResult setWarpReductionConfig(func::FuncOp entryPoint,
   size_t numLoops = partitionedLoops.empty() ? 0 : partitionedLoops.back() + 1;
   // Tile all the parallel dimension to 1.
   SmallVector<int64_t, 4> workgroupTileSizes(numLoops, 1);
+  if (groupSize == cudaWarpSize && !partitionedLoops.empty()) {
+    // Short rows only occupy one warp. When there are many of them reduce
+    // several rows per workgroup along the innermost parallel dimension so
+    // that their loads and shuffles are interleaved and fewer, fuller
+    // workgroups are launched.
+    SmallVector<int64_t> loopRanges = op.getStaticLoopRanges();
+    unsigned rowDim = partitionedLoops.back();
+    int64_t rowCount = 1;
+    for (unsigned loop : partitionedLoops) rowCount *= loopRanges[loop];
+    int64_t rowsPerWorkgroup = kWarpReductionMaxRowsPerWorkgroup;
+    while (rowsPerWorkgroup > 1 &&
+           (loopRanges[rowDim] % rowsPerWorkgroup != 0 ||
+            rowCount / rowsPerWorkgroup < kWarpReductionMinWorkgroupCount)) {
+      rowsPerWorkgroup /= 2;
+    }
+    workgroupTileSizes[rowDim] = rowsPerWorkgroup;
+  }
   SmallVector<int64_t, 4> reductionTileSizes(numLoops, 0);
   reductionTileSizes.push_back(groupSize * vectorSize);
   TileSizesListType tileSizes;
@@ -838,6 +923,12 @@ static LogicalResult setRootConfig(func::FuncOp entryPointFn,
     // bypass the heuristic.
     return setUserConfig(entryPointFn, computeOp, compilationInfo);
   }
+  FailureOr<IREE::Codegen::CompilationInfoAttr> tunedConfig =
+      getTunedConfig(computeOp);
+  if (failed(tunedConfig)) return failure();
+  if (*tunedConfig) {
+    return setUserConfig(entryPointFn, computeOp, *tunedConfig);
+  }
   if (auto linalgOp = dyn_cast<linalg::LinalgOp>(computeOp)) {
     if (succeeded(setReductionTransformDialectConfig(entryPointFn, linalgOp,
                                                      targetInfo))) {
@@ -875,6 +966,9 @@ static LogicalResult setRootConfig(func::FuncOp entryPointFn,
   if (auto sortOp = dyn_cast<IREE::LinalgExt::SortOp>(computeOp)) {
     return setSortConfig(entryPointFn, sortOp);
   }
+  if (auto attnOp = dyn_cast<IREE::LinalgExt::AttentionOp>(computeOp)) {
+    return setAttentionConfig(entryPointFn, attnOp);
+  }
   return setRootDefaultConfig(entryPointFn, computeOp);
 }
 
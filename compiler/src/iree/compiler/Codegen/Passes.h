@@ -207,6 +207,11 @@ IREE::LinalgExt::MaterializeEncodingValueFn getMaterializeEncodingValueFn(
 std::unique_ptr<OperationPass<func::FuncOp>>
 createIREEMaterializeEncodingPass();
 
+/// Folds the encoding of constant tensors into their data using the layout of
+/// the single executable target of the module.
+std::unique_ptr<OperationPass<ModuleOp>>
+createIREEMaterializeConstantEncodingsPass();
+
 /// Erases #hal.descriptor_type as MemRef memory space.
 LogicalResult eraseHALDescriptorTypeFromMemRef(func::FuncOp funcOp);
 std::unique_ptr<OperationPass<func::FuncOp>>
@@ -308,6 +313,11 @@ void addCPUDefaultPassPipeline(OpPassManager &passManager);
 /// Populates the passes to lower ops through data tiling transformations.
 void addCPUDataTilingPipeline(OpPassManager &passManager);
 
+/// Populates the passes to lower Winograd input/output transforms by
+/// decomposing them into small matmuls with the transform matrices and
+/// vectorizing those.
+void addCPUWinogradPassPipeline(OpPassManager &passManager);
+
 /// Populates the passes to lower to tiled/distributed/bufferized ops,
 /// suitable for library call dispatch and lowering to loops.
 void addVMVXDefaultPassPipeline(OpPassManager &passManager,
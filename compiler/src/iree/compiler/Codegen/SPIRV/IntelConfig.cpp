@@ -0,0 +1,109 @@
+// Copyright 2023 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+//===- IntelConfig.h - Intel CodeGen Configurations -----------------------===//
+//
+// This file contains CodeGen configurations for Intel GPUs.
+//
+//===----------------------------------------------------------------------===//
+
+#include "iree/compiler/Codegen/Dialect/LoweringConfig.h"
+#include "iree/compiler/Codegen/SPIRV/KernelConfig.h"
+#include "iree/compiler/Codegen/Utils/Utils.h"
+#include "llvm/Support/Debug.h"
+#include "mlir/Dialect/Linalg/IR/Linalg.h"
+#include "mlir/Dialect/SPIRV/IR/SPIRVAttributes.h"
+#include "mlir/Dialect/Tensor/IR/Tensor.h"
+#include "mlir/IR/BuiltinOps.h"
+
+#define DEBUG_TYPE "iree-spirv-intel-config"
+
+namespace mlir {
+namespace iree_compiler {
+namespace detail {
+
+constexpr unsigned IntelSimtSoftwarePipelineDepth = 2;
+constexpr unsigned IntelSimtSoftwarePipelineStoreStage = 0;
+
+constexpr unsigned IntelCoopMatrixSoftwarePipelineDepth = 1;
+constexpr unsigned IntelCoopMatrixSoftwarePipelineStoreStage = 0;
+
+constexpr unsigned IntelNumSubgroupsPerWorkgroup = 4;
+// The number of tiles along M and N dimensions per workgroup.
+constexpr unsigned IntelNumMNTilesPerSubgroup = 4;
+
+static LogicalResult setIntelMatmulConfig(linalg::LinalgOp op,
+                                          const spirv::TargetEnv &targetEnv) {
+  // XMX engines are only reachable through cooperative matrix when the target
+  // environment exposes it; otherwise fall back to SIMT below.
+  if (failed(setCooperativeMatrixConfig(
+          targetEnv, op, IntelNumSubgroupsPerWorkgroup,
+          IntelNumMNTilesPerSubgroup, IntelCoopMatrixSoftwarePipelineDepth,
+          IntelCoopMatrixSoftwarePipelineStoreStage)))
+    return failure();
+  if (getLoweringConfig(op)) return success();
+
+  spirv::ResourceLimitsAttr limits = targetEnv.getResourceLimits();
+  const int subgroupSize = limits.getSubgroupSize();
+  const std::array<int64_t, 2> workgroupXY = {subgroupSize / 2, 8};
+  std::array<int64_t, 3> threadMNK;
+  auto inputType = op.getDpsInputOperand(0)->get().getType().cast<ShapedType>();
+  if (inputType.getElementType().getIntOrFloatBitWidth() == 16) {
+    threadMNK = {8, 8, 32};
+  } else {
+    threadMNK = {4, 4, 32};
+  }
+  return setMatmulOpConfig(limits, op, workgroupXY, threadMNK,
+                           /*enablePromotion=*/true,
+                           IntelSimtSoftwarePipelineDepth,
+                           IntelSimtSoftwarePipelineStoreStage);
+}
+
+// Xe-HPG (Arc Alchemist) architecture:
+// https://www.intel.com/content/www/us/en/docs/oneapi/optimization-guide-gpu/2023-0/intel-xe-gpu-architecture.html
+//
+// Xe-core is the block for workgroups in Xe-HPG; it has 16 vector engines
+// (XVE, 8-wide SIMD) and 16 matrix engines (XMX) sharing a L1 cache/SLM.
+//
+// * 8 hardware threads per XVE, 128 GRF registers of 32 bytes each per thread
+// * 64KB SLM per workgroup
+// * Max 1024 invocations per workgroup
+// * Subgroup size 8, 16, or 32
+
+LogicalResult setIntelCodeGenConfig(const spirv::TargetEnv &targetEnv,
+                                    Operation *rootOp) {
+  spirv::ResourceLimitsAttr limits = targetEnv.getResourceLimits();
+  int subgroupSize = limits.getSubgroupSize();
+
+  if (auto linalgOp = dyn_cast<linalg::LinalgOp>(rootOp)) {
+    if (isMatmulOrBatchMatmul(linalgOp))
+      return setIntelMatmulConfig(linalgOp, targetEnv);
+  }
+
+  return TypeSwitch<Operation *, LogicalResult>(rootOp)
+      .Case<linalg::BatchMatmulOp, linalg::MatmulOp>(
+          [targetEnv](auto op) { return setIntelMatmulConfig(op, targetEnv); })
+      .Case<linalg::Conv2DNchwFchwOp, linalg::Conv2DNhwcHwcfOp>(
+          [subgroupSize](auto op) {
+            // Use smaller tiles than RDNA to keep more hardware threads
+            // resident given the smaller per-thread register file.
+            bool hasPaddedInput =
+                op.image().template getDefiningOp<tensor::PadOp>();
+            int bestTilingFactor = hasPaddedInput ? 8 : 16;
+            return setConvOpConfig(op, subgroupSize, bestTilingFactor);
+          })
+      .Case<linalg::DepthwiseConv2DNhwcHwcOp>([subgroupSize](auto op) {
+        bool hasPaddedInput =
+            op.image().template getDefiningOp<tensor::PadOp>();
+        int bestTilingFactor = hasPaddedInput ? 8 : 16;
+        return setConvOpConfig(op, subgroupSize, bestTilingFactor);
+      })
+      .Default([](Operation *) { return success(); });
+}
+
+}  // namespace detail
+}  // namespace iree_compiler
+}  // namespace mlir
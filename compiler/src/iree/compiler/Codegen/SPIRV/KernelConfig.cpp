@@ -978,6 +978,27 @@ static LogicalResult setWinogradOpConfig(spirv::ResourceLimitsAttr limits,
       workgroupSize);
 }
 
+//===----------------------------------------------------------------------===//
+// Attention Default Configuration
+//===----------------------------------------------------------------------===//
+
+static LogicalResult setAttentionOpConfig(spirv::ResourceLimitsAttr limits,
+                                          IREE::LinalgExt::AttentionOp op) {
+  LLVM_DEBUG(llvm::dbgs() << "trying to deduce config as attention...\n");
+  // Each invocation computes one query row, iterating over the whole key
+  // sequence once the op is decomposed. The value dimension is not tiled so
+  // that the softmax of a row is computed only once.
+  const int subgroupSize = limits.getSubgroupSize();
+  auto pipeline = CodeGenPipeline::SPIRVBaseVectorize;
+  std::array<int64_t, 3> workgroupSize = {subgroupSize, 1, 1};
+  SmallVector<int64_t> workgroupTileSizes = {1, subgroupSize, 0};
+  SmallVector<int64_t> threadTileSizes = {1, 1, 0};
+  TileSizesListType tileSizes = {workgroupTileSizes, threadTileSizes};
+  return setOpConfigAndEntryPointFnTranslation(
+      op->getParentOfType<func::FuncOp>(), op, tileSizes, pipeline,
+      workgroupSize);
+}
+
 //===----------------------------------------------------------------------===//
 // Reduction Default Configuration
 //===----------------------------------------------------------------------===//
@@ -1317,6 +1338,12 @@ static LogicalResult setSPIRVOpConfig(const spirv::TargetEnv &targetEnv,
     // original source by the user, then use it directly.
     return setUserConfig(entryPointFn, rootOp, compilationInfo);
   }
+  FailureOr<IREE::Codegen::CompilationInfoAttr> tunedConfig =
+      getTunedConfig(rootOp);
+  if (failed(tunedConfig)) return failure();
+  if (*tunedConfig) {
+    return setUserConfig(entryPointFn, rootOp, *tunedConfig);
+  }
 
   LogicalResult result = success();
   // First try to find a proper CodeGen configuration to tile and vectorize for
@@ -1331,6 +1358,9 @@ static LogicalResult setSPIRVOpConfig(const spirv::TargetEnv &targetEnv,
     case spirv::Vendor::ARM:
       result = detail::setMaliCodeGenConfig(targetEnv, rootOp);
       break;
+    case spirv::Vendor::Intel:
+      result = detail::setIntelCodeGenConfig(targetEnv, rootOp);
+      break;
     case spirv::Vendor::NVIDIA:
       result = detail::setNVIDIACodeGenConfig(targetEnv, rootOp);
       break;
@@ -1338,6 +1368,10 @@ static LogicalResult setSPIRVOpConfig(const spirv::TargetEnv &targetEnv,
       result = detail::setAdrenoCodeGenConfig(targetEnv, rootOp);
       break;
     default:
+      // WebGPU does not expose the vendor; fall back to portable configs.
+      if (targetEnv.getAttr().getClientAPI() == spirv::ClientAPI::WebGPU) {
+        result = detail::setWebGPUCodeGenConfig(targetEnv, rootOp);
+      }
       break;
   }
 
@@ -1403,6 +1437,10 @@ static LogicalResult setSPIRVOpConfig(const spirv::TargetEnv &targetEnv,
       .Case<IREE::LinalgExt::WinogradInputTransformOp,
             IREE::LinalgExt::WinogradOutputTransformOp>(
           [&](auto op) { return setWinogradOpConfig(limits, op); })
+      .Case<IREE::LinalgExt::AttentionOp>(
+          [limits](IREE::LinalgExt::AttentionOp op) {
+            return setAttentionOpConfig(limits, op);
+          })
       .Default([](Operation *) { return success(); });
 };
 
@@ -29,6 +29,10 @@ Optional<spirv::StorageClass> mapHALDescriptorTypeForVulkan(Attribute attr) {
       return spirv::StorageClass::Uniform;
     case IREE::HAL::DescriptorType::StorageBuffer:
       return spirv::StorageClass::StorageBuffer;
+    case IREE::HAL::DescriptorType::UniformTexelBuffer:
+      // Texel buffers are images and must be read with image fetches instead
+      // of memory loads.
+      return std::nullopt;
   }
   return std::nullopt;
 }
@@ -41,6 +45,8 @@ Optional<spirv::StorageClass> mapHALDescriptorTypeForOpenCL(Attribute attr) {
       return spirv::StorageClass::Uniform;
     case IREE::HAL::DescriptorType::StorageBuffer:
       return spirv::StorageClass::CrossWorkgroup;
+    case IREE::HAL::DescriptorType::UniformTexelBuffer:
+      return std::nullopt;
   }
   return std::nullopt;
 }
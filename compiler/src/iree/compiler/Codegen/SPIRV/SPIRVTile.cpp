@@ -25,6 +25,7 @@
 #include "mlir/Dialect/Linalg/IR/Linalg.h"
 #include "mlir/Dialect/Linalg/Transforms/Transforms.h"
 #include "mlir/Dialect/SCF/IR/SCF.h"
+#include "mlir/Dialect/SCF/Transforms/TileUsingInterface.h"
 #include "mlir/Dialect/SCF/Transforms/Transforms.h"
 #include "mlir/Dialect/SCF/Utils/Utils.h"
 #include "mlir/Dialect/Tensor/IR/Tensor.h"
@@ -128,6 +129,29 @@ static LogicalResult tileAndDistributeToThreads(linalg::LinalgOp consumerOp,
   return success();
 }
 
+/// Tiles `op`, which is not a Linalg op and so has no producers to fuse, to
+/// invocations. The tiled loops are marked for distribution like above.
+static LogicalResult tileTilingOpToThreads(TilingInterface op,
+                                           ArrayRef<int64_t> tileSizes) {
+  IRRewriter rewriter(op.getContext());
+  rewriter.setInsertionPoint(op);
+  auto options = scf::SCFTilingOptions().setTileSizes(tileSizes);
+  FailureOr<scf::SCFTilingResult> tilingResult =
+      scf::tileUsingSCFForOp(rewriter, op, options);
+  if (failed(tilingResult)) {
+    return op->emitOpError("failed tiling to invocations");
+  }
+  rewriter.replaceOp(op, tilingResult->replacements);
+
+  ArrayRef<scf::ForOp> loops = tilingResult->loops;
+  assert(loops.size() <= kNumGPUDims);
+  const char *attrName = getSPIRVDistributeAttrName();
+  for (int i = loops.size() - 1, dim = 0; i >= 0; --i) {
+    loops[i]->setAttr(attrName, rewriter.getIndexAttr(dim++));
+  }
+  return success();
+}
+
 /// Populates `patterns` with patterns that tiles convolution/matmul ops with
 /// markers.
 static void populateTilingReductionPatterns(RewritePatternSet &patterns,
@@ -290,9 +314,13 @@ class SPIRVTilePass final : public SPIRVTileBase<SPIRVTilePass> {
     // computation ops into the materialized loop nest.
     auto threadTileSizes = loweringConfig->getTileSizeVals(1);
     for (Operation *computeOp : computeOps) {
-      auto consumerOp = dyn_cast<linalg::LinalgOp>(computeOp);
-      if (failed(tileAndDistributeToThreads(consumerOp, threadTileSizes)))
-        return signalPassFailure();
+      if (auto consumerOp = dyn_cast<linalg::LinalgOp>(computeOp)) {
+        if (failed(tileAndDistributeToThreads(consumerOp, threadTileSizes)))
+          return signalPassFailure();
+      } else if (auto tilingOp = dyn_cast<TilingInterface>(computeOp)) {
+        if (failed(tileTilingOpToThreads(tilingOp, threadTileSizes)))
+          return signalPassFailure();
+      }
     }
 
     LLVM_DEBUG({
@@ -0,0 +1,70 @@
+// Copyright 2023 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+//===- WebGPUConfig.cpp - WebGPU CodeGen Configurations -------------------===//
+//
+// This file contains CodeGen configurations for WebGPU. The vendor of the
+// device is not known at compile time, so the configurations stay within the
+// limits every WebGPU adapter supports and avoid large per-thread tiles
+// that would spill on mobile GPUs after translation to WGSL.
+//
+//===----------------------------------------------------------------------===//
+
+#include <array>
+
+#include "iree/compiler/Codegen/SPIRV/KernelConfig.h"
+#include "llvm/ADT/TypeSwitch.h"
+#include "mlir/Dialect/Linalg/IR/Linalg.h"
+#include "mlir/Dialect/Tensor/IR/Tensor.h"
+#include "mlir/IR/BuiltinOps.h"
+
+namespace mlir {
+namespace iree_compiler {
+namespace detail {
+
+static LogicalResult setWebGPUMatmulConfig(linalg::LinalgOp op,
+                                           spirv::ResourceLimitsAttr limits) {
+  // 128 invocations per workgroup, half of what the spec guarantees, to keep
+  // occupancy on small GPUs.
+  const std::array<int64_t, 2> workgroupXY = {32, 4};
+  std::array<int64_t, 3> threadMNK;
+  auto inputType = op.getDpsInputOperand(0)->get().getType().cast<ShapedType>();
+  if (inputType.getElementType().getIntOrFloatBitWidth() == 16) {
+    threadMNK = {4, 8, 8};
+  } else {
+    threadMNK = {4, 4, 4};
+  }
+  return setMatmulOpConfig(limits, op, workgroupXY, threadMNK);
+}
+
+//===----------------------------------------------------------------------===//
+// Entry Point
+//===----------------------------------------------------------------------===//
+
+LogicalResult setWebGPUCodeGenConfig(const spirv::TargetEnv &targetEnv,
+                                     Operation *rootOp) {
+  spirv::ResourceLimitsAttr limits = targetEnv.getResourceLimits();
+  int subgroupSize = limits.getSubgroupSize();
+
+  if (auto linalgOp = dyn_cast<linalg::LinalgOp>(rootOp)) {
+    if (isMatmulOrBatchMatmul(linalgOp))
+      return setWebGPUMatmulConfig(linalgOp, limits);
+  }
+
+  return TypeSwitch<Operation *, LogicalResult>(rootOp)
+      .Case<linalg::Conv2DNchwFchwOp, linalg::Conv2DNhwcHwcfOp,
+            linalg::DepthwiseConv2DNhwcHwcOp>([subgroupSize](auto op) {
+        bool hasPaddedInput =
+            op.image().template getDefiningOp<tensor::PadOp>();
+        int bestTilingFactor = hasPaddedInput ? 8 : 16;
+        return setConvOpConfig(op, subgroupSize, bestTilingFactor);
+      })
+      .Default([](Operation *) { return success(); });
+}
+
+}  // namespace detail
+}  // namespace iree_compiler
+}  // namespace mlir
@@ -184,3 +184,50 @@ hal.executable private @static_3d_fft_stage3 {
 //       CHECK: func.func @static_3d_fft_stage3()
 //       CHECK:   iree_linalg_ext.fft
 //  CHECK-SAME:     lowering_config = #[[CONFIG]]
+
+// -----
+
+#pipeline_layout = #hal.pipeline.layout<push_constants = 0, sets = [
+  #hal.descriptor_set.layout<0, bindings = [
+    #hal.descriptor_set.binding<0, storage_buffer>,
+    #hal.descriptor_set.binding<1, storage_buffer>,
+    #hal.descriptor_set.binding<2, storage_buffer>,
+    #hal.descriptor_set.binding<3, storage_buffer>
+  ]>
+]>
+hal.executable private @static_attention {
+  hal.executable.variant @vulkan_spirv_fb, target = <"vulkan", "vulkan-spirvfb", {
+      spirv.target_env = #spirv.target_env<#spirv.vce<v1.4, [Shader], []>, Unknown:IntegratedGPU, #spirv.resource_limits<
+        max_compute_shared_memory_size = 32768,
+        max_compute_workgroup_invocations = 512,
+        max_compute_workgroup_size = [512, 512, 512],
+        subgroup_size = 16>>
+    }> {
+    hal.executable.export @static_attention layout(#pipeline_layout)
+    builtin.module {
+      func.func @static_attention() {
+        %c0 = arith.constant 0 : index
+        %0 = hal.interface.binding.subspan set(0) binding(0) type(storage_buffer) : !flow.dispatch.tensor<readonly:tensor<4x128x64xf32>>
+        %1 = hal.interface.binding.subspan set(0) binding(1) type(storage_buffer) : !flow.dispatch.tensor<readonly:tensor<4x256x64xf32>>
+        %2 = hal.interface.binding.subspan set(0) binding(2) type(storage_buffer) : !flow.dispatch.tensor<readonly:tensor<4x256x64xf32>>
+        %3 = hal.interface.binding.subspan set(0) binding(3) type(storage_buffer) : !flow.dispatch.tensor<writeonly:tensor<4x128x64xf32>>
+        %4 = flow.dispatch.tensor.load %0, offsets = [0, 0, 0], sizes = [4, 128, 64], strides = [1, 1, 1] : !flow.dispatch.tensor<readonly:tensor<4x128x64xf32>> -> tensor<4x128x64xf32>
+        %5 = flow.dispatch.tensor.load %1, offsets = [0, 0, 0], sizes = [4, 256, 64], strides = [1, 1, 1] : !flow.dispatch.tensor<readonly:tensor<4x256x64xf32>> -> tensor<4x256x64xf32>
+        %6 = flow.dispatch.tensor.load %2, offsets = [0, 0, 0], sizes = [4, 256, 64], strides = [1, 1, 1] : !flow.dispatch.tensor<readonly:tensor<4x256x64xf32>> -> tensor<4x256x64xf32>
+        %7 = tensor.empty() : tensor<4x128x64xf32>
+        %8 = iree_linalg_ext.attention ins(%4, %5, %6 : tensor<4x128x64xf32>, tensor<4x256x64xf32>, tensor<4x256x64xf32>) outs(%7 : tensor<4x128x64xf32>) -> tensor<4x128x64xf32>
+        flow.dispatch.tensor.store %8, %3, offsets = [0, 0, 0], sizes = [4, 128, 64], strides = [1, 1, 1] : tensor<4x128x64xf32> -> !flow.dispatch.tensor<writeonly:tensor<4x128x64xf32>>
+        return
+      }
+    }
+  }
+}
+
+//   CHECK-DAG: #[[CONFIG:.+]] = #iree_codegen.lowering_config<tile_sizes = {{\[}}[1, 16, 0], [1, 1, 0]{{\]}}>
+//   CHECK-DAG: #[[TRANSLATION:.+]] = #iree_codegen.translation_info<SPIRVBaseVectorize>
+//       CHECK: hal.executable.export public @static_attention
+//  CHECK-SAME:   translation_info = #[[TRANSLATION]]
+//  CHECK-SAME:   workgroup_size = [16 : index, 1 : index, 1 : index]
+//       CHECK: func.func @static_attention()
+//       CHECK:   iree_linalg_ext.attention
+//  CHECK-SAME:     lowering_config = #[[CONFIG]]
@@ -788,6 +788,12 @@ struct LinalgUnaryGenericConversion
               }
               return std::nullopt;
             })
+            .Case([&](math::TanhOp op) -> Optional<UnaryEmitter> {
+              if (resultType.getIntOrFloatBitWidth() == 32) {
+                return configureGenericUnary(op, "tanh");
+              }
+              return std::nullopt;
+            })
             .Default([](Operation *) { return std::nullopt; });
 
     // Determine op type to lower to.
@@ -802,6 +808,133 @@ struct LinalgUnaryGenericConversion
   }
 };
 
+/// Matches a generic which reduces one dimension of its input with an
+/// expressible binary operation, emitting as a vmvx.reduce op:
+///   %0 = someop %in, %acc
+///   yield %0
+/// The remaining dimension, if any, must be parallel. Reductions along the
+/// outer dimension are emitted with permuted input strides.
+struct LinalgReductionGenericConversion
+    : public OpRewritePattern<linalg::GenericOp> {
+  using OpRewritePattern::OpRewritePattern;
+  LogicalResult matchAndRewrite(linalg::GenericOp op,
+                                PatternRewriter &rewriter) const override {
+    if (op.getNumDpsInputs() != 1 || op.getNumDpsInits() != 1) {
+      return failure();
+    }
+    if (op.getNumReductionLoops() != 1 || op.getNumLoops() > 2) {
+      return failure();
+    }
+    auto &children = op.getBlock()->getOperations();
+    if (children.size() != 2) return failure();
+
+    // Match:
+    //   %0 = someop %arg2, %arg3
+    //   yield %0
+    // All supported ops are commutative so the order of operands is free.
+    Operation *reductionOp = &children.front();
+    Operation *yieldOp = op.getBlock()->getTerminator();
+    if (reductionOp->getNumOperands() != 2 ||
+        yieldOp->getOperand(0) != reductionOp->getResult(0)) {
+      return failure();
+    }
+    BlockArgument inArg = op.getBlock()->getArgument(0);
+    BlockArgument accArg = op.getBlock()->getArgument(1);
+    if (!((reductionOp->getOperand(0) == inArg &&
+           reductionOp->getOperand(1) == accArg) ||
+          (reductionOp->getOperand(0) == accArg &&
+           reductionOp->getOperand(1) == inArg))) {
+      return failure();
+    }
+
+    // Select the op from the iree_uk_x32r_opcode_t table.
+    Type elementType = reductionOp->getResult(0).getType();
+    if (!elementType.isF32() && !elementType.isSignlessInteger(32)) {
+      return rewriter.notifyMatchFailure(op, "unsupported element type");
+    }
+    Optional<StringRef> opcode =
+        TypeSwitch<Operation *, Optional<StringRef>>(reductionOp)
+            .Case([](arith::AddFOp) { return StringRef("add"); })
+            .Case([](arith::AddIOp) { return StringRef("add"); })
+            .Case([](arith::MaxFOp) { return StringRef("max"); })
+            .Case([](arith::MaxSIOp) { return StringRef("maxs"); })
+            .Case([](arith::MinFOp) { return StringRef("min"); })
+            .Case([](arith::MinSIOp) { return StringRef("mins"); })
+            .Default([](Operation *) { return std::nullopt; });
+    if (!opcode) {
+      return rewriter.notifyMatchFailure(op, "unrecognized reduction op");
+    }
+
+    // The input must cover every loop for its sizes to define the iteration
+    // space; the output must not depend on the reduced loop.
+    OpOperand *input = op.getDpsInputOperand(0);
+    OpOperand *output = op.getDpsInitOperand(0);
+    AffineMap inMap = op.getMatchingIndexingMap(input);
+    AffineMap outMap = op.getMatchingIndexingMap(output);
+    if (!inMap.isPermutation() || !outMap.isProjectedPermutation()) {
+      return rewriter.notifyMatchFailure(op, "unsupported indexing maps");
+    }
+    SmallVector<unsigned> reductionDims;
+    op.getReductionDims(reductionDims);
+    unsigned reductionDim = reductionDims.front();
+    if (llvm::any_of(outMap.getResults(), [&](AffineExpr expr) {
+          return expr.isFunctionOfDim(reductionDim);
+        })) {
+      return rewriter.notifyMatchFailure(op, "output indexed by reduction");
+    }
+
+    StridedBufferAnalysis inAnal(input->get());
+    StridedBufferAnalysis outAnal(output->get());
+    if (!inAnal.isValid() || !outAnal.isValid()) {
+      return rewriter.notifyMatchFailure(op,
+                                         "could not compute buffer descriptor");
+    }
+
+    // All pre-conditions pass. Mutate IR.
+    Location loc = op.getLoc();
+    StridedBufferDescriptor &inDesc = inAnal.getDesc(rewriter);
+    StridedBufferDescriptor &outDesc = outAnal.getDesc(rewriter);
+    SmallVector<Value> loopInStrides =
+        permuteStrides(loc, inMap, inDesc.strides, rewriter);
+    SmallVector<Value> loopOutStrides =
+        permuteStrides(loc, outMap, outDesc.strides, rewriter);
+    SmallVector<Value> loopSizes(op.getNumLoops());
+    for (unsigned resultPos = 0; resultPos < inMap.getNumResults();
+         ++resultPos) {
+      loopSizes[inMap.getDimPosition(resultPos)] = inDesc.sizes[resultPos];
+    }
+
+    // Order the loops as (parallel, reduction), padding a missing parallel
+    // loop with a single row.
+    SmallVector<Value> inStrides = {loopInStrides[reductionDim]};
+    SmallVector<Value> sizes = {loopSizes[reductionDim]};
+    Value outStride;
+    if (op.getNumLoops() == 2) {
+      unsigned parallelDim = 1 - reductionDim;
+      inStrides.insert(inStrides.begin(), loopInStrides[parallelDim]);
+      sizes.insert(sizes.begin(), loopSizes[parallelDim]);
+      outStride = loopOutStrides[parallelDim];
+    } else {
+      leftPadToRank(loc, inStrides, 2, 0, rewriter);
+      leftPadToRank(loc, sizes, 2, 1, rewriter);
+      outStride = rewriter.create<arith::ConstantIndexOp>(loc, 0);
+    }
+
+    rewriter.create<IREE::VMVX::ReduceOp>(
+        loc, rewriter.getStringAttr(*opcode),
+        // IN
+        inDesc.castToLinear(loc, rewriter), inDesc.offset, inStrides,
+        // OUT
+        outDesc.castToLinear(loc, rewriter), outDesc.offset, outStride,
+        // Sizes
+        sizes,
+        // Attributes
+        TypeAttr::get(elementType));
+    rewriter.eraseOp(op);
+    return success();
+  }
+};
+
 /// Matches a "trivial" generic which only yields, emitting as copy
 /// operation(s).
 struct LinalgTrivialGenericConversion
@@ -1421,6 +1554,7 @@ class VMVXLowerLinalgMicrokernelsPass
       RewritePatternSet patterns(&getContext());
       patterns
           .insert<LinalgBinaryGenericConversion, LinalgFillConversion,
+                  LinalgReductionGenericConversion,
                   LinalgTrivialGenericConversion, LinalgUnaryGenericConversion,
                   LinalgExtPackConversion, LinalgExtUnpackConversion>(
               &getContext());
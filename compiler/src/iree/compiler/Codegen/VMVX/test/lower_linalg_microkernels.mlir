@@ -560,6 +560,71 @@ func.func @rsqrt(%arg0 : memref<64x64xf32>, %arg1 : memref<64xf32>) {
   func.return
 }
 
+// CHECK-LABEL: @tanh
+// CHECK: vmvx.unary op("tanh" : f32)
+func.func @tanh(%arg0 : memref<64x64xf32>, %arg1 : memref<64xf32>) {
+  linalg.generic {indexing_maps = [affine_map<(d0, d1) -> (d1)>, affine_map<(d0, d1) -> (d0, d1)>], iterator_types = ["parallel", "parallel"]}
+    ins(%arg1 : memref<64xf32>) outs(%arg0 : memref<64x64xf32>) {
+  ^bb0(%arg2: f32, %arg3: f32):
+    %12 = math.tanh %arg2 : f32
+    linalg.yield %12 : f32
+  }
+  func.return
+}
+
+// CHECK-LABEL: @reduce_rows_addf
+//   CHECK-DAG: %[[BB0:.*]], %[[OFFSET0:.*]], %[[SIZES0:.*]]:2, %[[STRIDES0:.*]]:2 = vmvx.get_buffer_descriptor %arg0
+//   CHECK-DAG: %[[BB1:.*]], %[[OFFSET1:.*]], %[[SIZES1:.*]], %[[STRIDES1:.*]] = vmvx.get_buffer_descriptor %arg1
+//       CHECK: vmvx.reduce op("add" : f32)
+//  CHECK-SAME:   in(%[[BB0]] offset %[[OFFSET0]] strides[%[[STRIDES0]]#0, %[[STRIDES0]]#1] : !util.buffer)
+//  CHECK-SAME:   out(%[[BB1]] offset %[[OFFSET1]] stride %[[STRIDES1]] : !util.buffer)
+//  CHECK-SAME:   sizes(%[[SIZES0]]#0, %[[SIZES0]]#1)
+func.func @reduce_rows_addf(%arg0 : memref<64x32xf32>, %arg1 : memref<64xf32>) {
+  linalg.generic {indexing_maps = [affine_map<(d0, d1) -> (d0, d1)>, affine_map<(d0, d1) -> (d0)>], iterator_types = ["parallel", "reduction"]}
+    ins(%arg0 : memref<64x32xf32>) outs(%arg1 : memref<64xf32>) {
+  ^bb0(%arg2: f32, %arg3: f32):
+    %0 = arith.addf %arg2, %arg3 : f32
+    linalg.yield %0 : f32
+  }
+  func.return
+}
+
+// Reductions along the outer dimension swap the input strides.
+// CHECK-LABEL: @reduce_columns_maxf
+//   CHECK-DAG: %[[BB0:.*]], %[[OFFSET0:.*]], %[[SIZES0:.*]]:2, %[[STRIDES0:.*]]:2 = vmvx.get_buffer_descriptor %arg0
+//       CHECK: vmvx.reduce op("max" : f32)
+//  CHECK-SAME:   in(%[[BB0]] offset %[[OFFSET0]] strides[%[[STRIDES0]]#1, %[[STRIDES0]]#0] : !util.buffer)
+//  CHECK-SAME:   sizes(%[[SIZES0]]#1, %[[SIZES0]]#0)
+func.func @reduce_columns_maxf(%arg0 : memref<64x32xf32>, %arg1 : memref<32xf32>) {
+  linalg.generic {indexing_maps = [affine_map<(d0, d1) -> (d0, d1)>, affine_map<(d0, d1) -> (d1)>], iterator_types = ["reduction", "parallel"]}
+    ins(%arg0 : memref<64x32xf32>) outs(%arg1 : memref<32xf32>) {
+  ^bb0(%arg2: f32, %arg3: f32):
+    %0 = arith.maxf %arg3, %arg2 : f32
+    linalg.yield %0 : f32
+  }
+  func.return
+}
+
+// A full reduction of a 1d buffer is a single row.
+// CHECK-LABEL: @reduce_1d_maxsi
+//   CHECK-DAG: %[[C0:.*]] = arith.constant 0 : index
+//   CHECK-DAG: %[[C1:.*]] = arith.constant 1 : index
+//   CHECK-DAG: %[[BB0:.*]], %[[OFFSET0:.*]], %[[SIZES0:.*]], %[[STRIDES0:.*]] = vmvx.get_buffer_descriptor %arg0
+//   CHECK-DAG: %[[BB1:.*]], %[[OFFSET1:.*]] = vmvx.get_buffer_descriptor %arg1
+//       CHECK: vmvx.reduce op("maxs" : i32)
+//  CHECK-SAME:   in(%[[BB0]] offset %[[OFFSET0]] strides[%[[C0]], %[[STRIDES0]]] : !util.buffer)
+//  CHECK-SAME:   out(%[[BB1]] offset %[[OFFSET1]] stride %[[C0]] : !util.buffer)
+//  CHECK-SAME:   sizes(%[[C1]], %[[SIZES0]])
+func.func @reduce_1d_maxsi(%arg0 : memref<128xi32>, %arg1 : memref<i32>) {
+  linalg.generic {indexing_maps = [affine_map<(d0) -> (d0)>, affine_map<(d0) -> ()>], iterator_types = ["reduction"]}
+    ins(%arg0 : memref<128xi32>) outs(%arg1 : memref<i32>) {
+  ^bb0(%arg2: i32, %arg3: i32):
+    %0 = arith.maxsi %arg2, %arg3 : i32
+    linalg.yield %0 : i32
+  }
+  func.return
+}
+
 // CHECK-LABEL: @pack_i8i8
 //   CHECK-DAG: %[[BB0:.*]], %[[OFFSET0:.*]], %[[SIZES0:.*]]:2, %[[STRIDES0:.*]]:2 = vmvx.get_buffer_descriptor %arg0
 //   CHECK-DAG: %[[BB1:.*]], %[[OFFSET1:.*]], %[[SIZES1:.*]]:4, %[[STRIDES1:.*]]:4 = vmvx.get_buffer_descriptor %arg1
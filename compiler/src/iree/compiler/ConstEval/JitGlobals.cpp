@@ -10,23 +10,160 @@
 #include "iree/compiler/Pipelines/Pipelines.h"
 #include "iree/compiler/Utils/PassUtils.h"
 #include "llvm/ADT/DenseSet.h"
+#include "llvm/ADT/StringExtras.h"
+#include "llvm/Support/CommandLine.h"
 #include "llvm/Support/Debug.h"
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/MathExtras.h"
+#include "llvm/Support/MemoryBuffer.h"
+#include "llvm/Support/Path.h"
+#include "llvm/Support/SHA256.h"
 #include "llvm/Support/raw_ostream.h"
 #include "mlir/Dialect/Func/IR/FuncOps.h"
 #include "mlir/IR/BlockAndValueMapping.h"
 #include "mlir/IR/Builders.h"
 #include "mlir/IR/BuiltinOps.h"
 #include "mlir/IR/SymbolTable.h"
+#include "mlir/Parser/Parser.h"
 
 #define DEBUG_TYPE "iree-const-eval"
 using llvm::dbgs;
 
+static llvm::cl::opt<int64_t> clJitMaxGlobalSize(
+    "iree-consteval-jit-max-global-size",
+    llvm::cl::desc("Maximum size in bytes of a global evaluated at compile "
+                   "time. Initializers producing larger globals are left to "
+                   "run when the program is loaded. 0 disables the limit."),
+    llvm::cl::init(0));
+
+static llvm::cl::opt<std::string> clJitCacheDir(
+    "iree-consteval-jit-cache-dir",
+    llvm::cl::desc("Directory used to cache evaluated globals across "
+                   "compilations. Programs with identical initializers reuse "
+                   "the cached values instead of being compiled and run."),
+    llvm::cl::init(""));
+
 namespace mlir {
 namespace iree_compiler {
 namespace ConstEval {
 
 namespace {
 
+// Bumped whenever the evaluation pipeline changes in a way that invalidates
+// previously cached results.
+static const char kCacheVersion[] = "iree-consteval-jit-v1";
+
+// Returns the storage size in bytes of a value of |type| or std::nullopt if it
+// can't be determined statically.
+static Optional<int64_t> getStaticStorageSize(Type type) {
+  if (auto tensorType = type.dyn_cast<RankedTensorType>()) {
+    if (!tensorType.hasStaticShape()) return std::nullopt;
+    auto elementSize = getStaticStorageSize(tensorType.getElementType());
+    if (!elementSize) return std::nullopt;
+    return tensorType.getNumElements() * elementSize.value();
+  }
+  if (type.isIntOrFloat()) {
+    return llvm::divideCeil(type.getIntOrFloatBitWidth(), 8);
+  }
+  return std::nullopt;
+}
+
+// Returns true if a global of |type| exceeds the compile-time size limit.
+static bool exceedsSizeLimit(Type type) {
+  if (clJitMaxGlobalSize <= 0) return false;
+  auto storageSize = getStaticStorageSize(type);
+  return storageSize.has_value() && storageSize.value() > clJitMaxGlobalSize;
+}
+
+// Calls |callback| with the symbol of each global stored to within |op|.
+static void forEachStoredGlobal(Operation *op,
+                                function_ref<void(StringAttr)> callback) {
+  op->walk([&](IREE::Util::GlobalStoreOpInterface storeOp) {
+    callback(storeOp.getGlobalAttr().getAttr());
+  });
+}
+
+// Calls |callback| with the symbol of each global loaded within |op|.
+static void forEachLoadedGlobal(Operation *op,
+                                function_ref<void(StringAttr)> callback) {
+  op->walk([&](IREE::Util::GlobalLoadOpInterface loadOp) {
+    callback(loadOp.getGlobalAttr().getAttr());
+  });
+}
+
+// Returns the path of the cache entry holding the results of evaluating
+// |programOp| in the cache directory.
+static std::string getCachePath(ModuleOp programOp) {
+  std::string programText;
+  llvm::raw_string_ostream os(programText);
+  os << kCacheVersion << "\n";
+  programOp.print(os);
+  os.flush();
+  llvm::SHA256 hasher;
+  hasher.update(programText);
+  SmallString<256> path(clJitCacheDir.getValue());
+  llvm::sys::path::append(
+      path, llvm::toHex(hasher.final(), /*LowerCase=*/true) + ".mlir");
+  return std::string(path.str());
+}
+
+// Loads the evaluated values of |globalSymbols| from the cache entry at
+// |cachePath|. Fails if the entry doesn't exist or is missing any global.
+static LogicalResult loadCachedGlobals(
+    MLIRContext *context, StringRef cachePath,
+    ArrayRef<StringAttr> globalSymbols,
+    SmallVectorImpl<std::pair<StringAttr, Attribute>> &values) {
+  auto fileOrErr = llvm::MemoryBuffer::getFile(cachePath);
+  if (!fileOrErr) return failure();
+  auto cacheModuleRef = mlir::parseSourceString<mlir::ModuleOp>(
+      (*fileOrErr)->getBuffer(), context);
+  if (!cacheModuleRef) return failure();
+  SymbolTable cacheSymbolTable(*cacheModuleRef);
+  for (auto globalSymbol : globalSymbols) {
+    auto globalOp =
+        cacheSymbolTable.lookup<IREE::Util::GlobalOp>(globalSymbol);
+    if (!globalOp || !globalOp.getInitialValueAttr()) return failure();
+    values.emplace_back(globalSymbol, globalOp.getInitialValueAttr());
+  }
+  return success();
+}
+
+// Stores the evaluated |values| of globals to a cache entry at |cachePath|.
+// The entry is written to a temporary file first so that concurrent
+// compilations never observe a partially written entry.
+static void storeCachedGlobals(
+    Location loc, StringRef cachePath,
+    ArrayRef<std::pair<StringAttr, Attribute>> values) {
+  OpBuilder builder(loc.getContext());
+  auto cacheModuleOp = builder.create<ModuleOp>(loc);
+  builder.setInsertionPointToStart(cacheModuleOp.getBody());
+  for (auto &it : values) {
+    auto value = it.second.cast<TypedAttr>();
+    builder.create<IREE::Util::GlobalOp>(loc, it.first.getValue(),
+                                         /*isMutable=*/false, value.getType(),
+                                         value);
+  }
+
+  int fd = -1;
+  SmallString<256> tempPath;
+  if (llvm::sys::fs::create_directories(clJitCacheDir.getValue()) ||
+      llvm::sys::fs::createUniqueFile(cachePath + "-%%%%%%%%.tmp", fd,
+                                      tempPath)) {
+    LLVM_DEBUG(dbgs() << "JitGlobals: failed to create cache entry "
+                      << cachePath << "\n");
+    cacheModuleOp.erase();
+    return;
+  }
+  {
+    llvm::raw_fd_ostream os(fd, /*shouldClose=*/true);
+    cacheModuleOp.print(os);
+  }
+  cacheModuleOp.erase();
+  if (llvm::sys::fs::rename(tempPath, cachePath)) {
+    llvm::sys::fs::remove(tempPath);
+  }
+}
+
 struct ProgramExtractor {
  public:
   ProgramExtractor(Operation *sourceModuleOp, Operation *targetModuleOp)
@@ -163,8 +300,33 @@ struct JitGlobalsPass : public JitGlobalsBase<JitGlobalsPass> {
     ProgramExtractor extractor(outerModule, innerModule);
     SmallVector<Operation *> pruneOps;
 
-    // Import initializers.
+    // Import initializers. Initializers storing globals exceeding the size
+    // limit are left to run at runtime along with any initializers that
+    // depend on the globals they produce.
+    DenseSet<StringAttr> runtimeGlobals;
     for (auto childOp : outerModule.getOps<IREE::Util::InitializerOp>()) {
+      bool evalAtRuntime = false;
+      forEachStoredGlobal(childOp, [&](StringAttr globalSymbol) {
+        auto globalOp =
+            outerSymbolTable.lookup<IREE::Util::GlobalOp>(globalSymbol);
+        if (globalOp && exceedsSizeLimit(globalOp.getType())) {
+          LLVM_DEBUG(dbgs() << "JitGlobals: global " << globalSymbol
+                            << " exceeds the size limit\n");
+          evalAtRuntime = true;
+        } else if (runtimeGlobals.contains(globalSymbol)) {
+          // Must keep the original store ordering with runtime initializers.
+          evalAtRuntime = true;
+        }
+      });
+      forEachLoadedGlobal(childOp, [&](StringAttr globalSymbol) {
+        if (runtimeGlobals.contains(globalSymbol)) evalAtRuntime = true;
+      });
+      if (evalAtRuntime) {
+        forEachStoredGlobal(childOp, [&](StringAttr globalSymbol) {
+          runtimeGlobals.insert(globalSymbol);
+        });
+        continue;
+      }
       extractor.importOperation(childOp);
       pruneOps.push_back(childOp);
     }
@@ -203,38 +365,66 @@ struct JitGlobalsPass : public JitGlobalsBase<JitGlobalsPass> {
       return;
     }
 
-    // Run the IREE compiler, transforming the inner module into a vm.module.
-    LLVM_DEBUG(dbgs() << "JIT'ing " << uninitializedGlobals.size()
-                      << " uninitialized globals\n");
-    if (failed(runPipeline(compilePipeline, innerModule))) {
-      return signalPassFailure();
+    // Reuse the values from a previous evaluation of the same program if
+    // caching is enabled.
+    SmallVector<std::pair<StringAttr, Attribute>> evaluatedGlobals;
+    std::string cachePath;
+    if (!clJitCacheDir.empty()) {
+      cachePath = getCachePath(innerModule);
+      auto globalSymbols = llvm::to_vector(
+          llvm::map_range(uninitializedGlobals, [](auto it) {
+            return it.second;
+          }));
+      if (failed(loadCachedGlobals(&getContext(), cachePath, globalSymbols,
+                                   evaluatedGlobals))) {
+        evaluatedGlobals.clear();
+      } else {
+        LLVM_DEBUG(dbgs() << "JitGlobals: reusing cached values from "
+                          << cachePath << "\n");
+      }
     }
 
-    // Generate a binary.
-    InMemoryCompiledBinary binary;
-    if (failed(binary.translateFromModule(innerModule))) {
-      return signalPassFailure();
+    if (evaluatedGlobals.empty()) {
+      // Run the IREE compiler, transforming the inner module into a vm.module.
+      LLVM_DEBUG(dbgs() << "JIT'ing " << uninitializedGlobals.size()
+                        << " uninitialized globals\n");
+      if (failed(runPipeline(compilePipeline, innerModule))) {
+        return signalPassFailure();
+      }
+
+      // Generate a binary. All initializers run as part of loading the binary
+      // and the accessors only read back their results.
+      InMemoryCompiledBinary binary;
+      if (failed(binary.translateFromModule(innerModule))) {
+        return signalPassFailure();
+      }
+
+      for (auto &it : uninitializedGlobals) {
+        StringAttr funcSymbol = it.first;
+        StringAttr globalSymbol = it.second;
+        Location loc = outerSymbolTable.lookup(globalSymbol)->getLoc();
+        Attribute value =
+            binary.invokeNullaryAsAttribute(loc, funcSymbol.strref());
+        if (!value) {
+          return signalPassFailure();
+        }
+        evaluatedGlobals.emplace_back(globalSymbol, value);
+      }
+
+      if (!cachePath.empty()) {
+        storeCachedGlobals(innerModule.getLoc(), cachePath, evaluatedGlobals);
+      }
     }
 
     // Kill the temporary program we constructed.
     innerModule.erase();
 
     bool modified = false;
-    for (auto &it : uninitializedGlobals) {
-      StringAttr funcSymbol = it.first;
-      StringAttr globalSymbol = it.second;
+    for (auto &it : evaluatedGlobals) {
       auto targetGlobal = llvm::cast<IREE::Util::GlobalOp>(
-          outerSymbolTable.lookup(globalSymbol));
-      Location loc = targetGlobal->getLoc();
-
-      Attribute value =
-          binary.invokeNullaryAsAttribute(loc, funcSymbol.strref());
-      if (!value) {
-        return signalPassFailure();
-      }
-
+          outerSymbolTable.lookup(it.first));
       modified = true;
-      targetGlobal.setInitialValueAttr(value);
+      targetGlobal.setInitialValueAttr(it.second);
     }
 
     // Delete any ops noted for pruning.
@@ -174,8 +174,11 @@ bool CompiledBinary::isSupportedResultType(Type type) {
     return true;
   }
 
-  // Support tensors.
+  // Support tensors. Tensors with an encoding are laid out by the target
+  // backend and the layout produced by the JIT device may not match it; these
+  // are folded by iree-codegen-materialize-constant-encodings instead.
   if (auto tt = type.dyn_cast<RankedTensorType>()) {
+    if (tt.getEncoding()) return false;
     return isSupportedResultType(tt.getElementType());
   }
 
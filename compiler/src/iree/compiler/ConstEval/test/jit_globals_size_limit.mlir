@@ -0,0 +1,29 @@
+// RUN: iree-opt --split-input-file --iree-consteval-jit-max-global-size=16 --iree-consteval-jit-globals %s | FileCheck %s
+
+// CHECK-LABEL: @size_limit
+module @size_limit {
+  // CHECK: util.global private @small = dense<4.000000e+00> : tensor<2xf32>
+  util.global private @small : tensor<2xf32>
+  // CHECK: util.global private @large : tensor<5x6xf32>
+  util.global private @large : tensor<5x6xf32>
+  func.func @main() -> (tensor<2xf32>, tensor<5x6xf32>) {
+    %small = util.global.load @small : tensor<2xf32>
+    %large = util.global.load @large : tensor<5x6xf32>
+    return %small, %large : tensor<2xf32>, tensor<5x6xf32>
+  }
+  util.initializer {
+    %cst = arith.constant dense<2.0> : tensor<2xf32>
+    %0 = arith.addf %cst, %cst : tensor<2xf32>
+    util.global.store %0, @small : tensor<2xf32>
+    util.initializer.return
+  }
+  // Exceeds the 16 byte limit and is left for runtime initialization.
+  // CHECK: util.initializer
+  // CHECK: util.global.store %{{.*}}, @large : tensor<5x6xf32>
+  util.initializer {
+    %cst = arith.constant dense<2.0> : tensor<5x6xf32>
+    %0 = arith.addf %cst, %cst : tensor<5x6xf32>
+    util.global.store %0, @large : tensor<5x6xf32>
+    util.initializer.return
+  }
+}
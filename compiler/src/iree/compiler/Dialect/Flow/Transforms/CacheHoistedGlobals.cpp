@@ -0,0 +1,217 @@
+// Copyright 2023 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include "iree/compiler/Dialect/Flow/Transforms/PassDetail.h"
+#include "iree/compiler/Dialect/Flow/Transforms/Passes.h"
+#include "iree/compiler/Dialect/HAL/IR/HALDialect.h"
+#include "iree/compiler/Dialect/HAL/IR/HALOps.h"
+#include "iree/compiler/Dialect/HAL/IR/HALTypes.h"
+#include "iree/compiler/Dialect/Util/IR/UtilDialect.h"
+#include "iree/compiler/Dialect/Util/IR/UtilOps.h"
+#include "llvm/Support/Debug.h"
+#include "llvm/Support/Endian.h"
+#include "llvm/Support/SHA256.h"
+#include "llvm/Support/raw_ostream.h"
+#include "mlir/Dialect/Arith/IR/Arith.h"
+#include "mlir/Dialect/Func/IR/FuncOps.h"
+#include "mlir/Dialect/SCF/IR/SCF.h"
+#include "mlir/IR/Builders.h"
+#include "mlir/IR/BuiltinTypes.h"
+#include "mlir/IR/SymbolTable.h"
+#include "mlir/Interfaces/CallInterfaces.h"
+#include "mlir/Pass/Pass.h"
+
+#define DEBUG_TYPE "iree-flow-cache-hoisted-globals"
+
+namespace mlir {
+namespace iree_compiler {
+namespace IREE {
+namespace Flow {
+namespace {
+
+// Bumped whenever the way cached values are produced changes such that entries
+// written by programs from older compilers must not be reused.
+static const char kCacheVersion[] = "iree-hoisted-cache-v1";
+
+// Returns the global stored by |initializerOp| if the initializer can have its
+// result cached: a single block computing one statically-shaped tensor only
+// from constants and immutable globals and storing it to a private global.
+static IREE::Util::GlobalOp findCacheableGlobal(
+    IREE::Util::InitializerOp initializerOp, SymbolTable &symbolTable) {
+  Region &body = initializerOp.getBody();
+  if (!body.hasOneBlock()) return {};
+  Block &block = body.front();
+  if (!isa<IREE::Util::InitializerReturnOp>(block.getTerminator())) return {};
+  auto storeOp = dyn_cast_or_null<IREE::Util::GlobalStoreOp>(
+      block.getTerminator()->getPrevNode());
+  if (!storeOp) return {};
+
+  for (auto &op : block.without_terminator()) {
+    if (&op == storeOp.getOperation()) continue;
+    if (auto loadOp = dyn_cast<IREE::Util::GlobalLoadOp>(op)) {
+      auto sourceOp = symbolTable.lookup<IREE::Util::GlobalOp>(
+          loadOp.getGlobalAttr().getAttr());
+      if (!sourceOp || sourceOp.getIsMutable()) return {};
+      continue;
+    }
+    // Anything interacting with the outside world (other globals, imports,
+    // buffer views, etc) may produce different values across loads.
+    if (isa<IREE::Util::GlobalStoreOp, CallOpInterface>(op) ||
+        isa_and_nonnull<IREE::HAL::HALDialect>(op.getDialect())) {
+      return {};
+    }
+  }
+
+  auto globalOp = symbolTable.lookup<IREE::Util::GlobalOp>(
+      storeOp.getGlobalAttr().getAttr());
+  if (!globalOp || !globalOp.isPrivate()) return {};
+  auto tensorType = globalOp.getType().dyn_cast<RankedTensorType>();
+  if (!tensorType || !tensorType.hasStaticShape()) return {};
+  return globalOp;
+}
+
+// Returns a key identifying the value produced by |initializerOp|. The key
+// covers the initializer, the initial values of the globals it loads, and the
+// devices targeted by |moduleOp| so that rebuilding the program while keeping
+// the expression and targets the same reuses the cached values.
+static int64_t computeCacheKey(mlir::ModuleOp moduleOp,
+                               IREE::Util::InitializerOp initializerOp,
+                               SymbolTable &symbolTable) {
+  std::string text;
+  llvm::raw_string_ostream os(text);
+  os << kCacheVersion << "\n";
+  if (auto targetsAttr = moduleOp->getAttr("hal.device.targets")) {
+    os << targetsAttr << "\n";
+  }
+  initializerOp.walk([&](IREE::Util::GlobalLoadOp loadOp) {
+    if (auto sourceOp = symbolTable.lookup<IREE::Util::GlobalOp>(
+            loadOp.getGlobalAttr().getAttr())) {
+      sourceOp.print(os);
+      os << "\n";
+    }
+  });
+  initializerOp.print(os);
+  os.flush();
+  llvm::SHA256 hasher;
+  hasher.update(text);
+  auto hash = hasher.final();
+  return static_cast<int64_t>(
+      llvm::support::endian::read64le(hash.data()));
+}
+
+// Returns the cache import |name| with |type|, declaring it if needed.
+static func::FuncOp getOrCreateImport(mlir::ModuleOp moduleOp,
+                                      SymbolTable &symbolTable, StringRef name,
+                                      FunctionType type) {
+  if (auto funcOp = symbolTable.lookup<func::FuncOp>(name)) return funcOp;
+  auto funcOp = func::FuncOp::create(moduleOp.getLoc(), name, type);
+  funcOp.setPrivate();
+  symbolTable.insert(funcOp, moduleOp.getBody()->begin());
+  return funcOp;
+}
+
+class CacheHoistedGlobalsPass
+    : public CacheHoistedGlobalsBase<CacheHoistedGlobalsPass> {
+ public:
+  void getDependentDialects(DialectRegistry &registry) const override {
+    registry.insert<arith::ArithDialect, func::FuncDialect,
+                    IREE::HAL::HALDialect, IREE::Util::UtilDialect,
+                    scf::SCFDialect>();
+  }
+
+  void runOnOperation() override {
+    auto moduleOp = getOperation();
+    SymbolTable symbolTable(moduleOp);
+
+    SmallVector<std::pair<IREE::Util::InitializerOp, IREE::Util::GlobalOp>>
+        cacheableOps;
+    for (auto initializerOp : moduleOp.getOps<IREE::Util::InitializerOp>()) {
+      if (auto globalOp = findCacheableGlobal(initializerOp, symbolTable)) {
+        cacheableOps.push_back(std::make_pair(initializerOp, globalOp));
+      }
+    }
+    if (cacheableOps.empty()) return;
+
+    auto builder = OpBuilder::atBlockBegin(moduleOp.getBody());
+    auto deviceType = builder.getType<IREE::HAL::DeviceType>();
+    auto bufferViewType = builder.getType<IREE::HAL::BufferViewType>();
+    auto i32Type = builder.getI32Type();
+    auto i64Type = builder.getI64Type();
+    auto containsOp = getOrCreateImport(
+        moduleOp, symbolTable, "hoisted_cache.contains",
+        builder.getFunctionType({deviceType, i64Type}, {i32Type}));
+    auto loadOp = getOrCreateImport(
+        moduleOp, symbolTable, "hoisted_cache.load",
+        builder.getFunctionType({deviceType, i64Type}, {bufferViewType}));
+    auto storeOp = getOrCreateImport(
+        moduleOp, symbolTable, "hoisted_cache.store",
+        builder.getFunctionType({deviceType, i64Type, bufferViewType}, {}));
+
+    for (auto [initializerOp, globalOp] : cacheableOps) {
+      int64_t key = computeCacheKey(moduleOp, initializerOp, symbolTable);
+      LLVM_DEBUG(llvm::dbgs() << "caching @" << globalOp.getSymName()
+                              << " with key " << key << "\n");
+
+      // The ops computing the value are moved into the miss branch.
+      Block &block = initializerOp.getBody().front();
+      auto globalStoreOp =
+          cast<IREE::Util::GlobalStoreOp>(block.getTerminator()->getPrevNode());
+      SmallVector<Operation *> computeOps;
+      for (auto &op : block.without_terminator()) {
+        if (&op != globalStoreOp.getOperation()) computeOps.push_back(&op);
+      }
+      Value computedValue = globalStoreOp.getValue();
+      auto tensorType = computedValue.getType();
+      auto loc = globalStoreOp.getLoc();
+
+      builder.setInsertionPoint(globalStoreOp);
+      Value device = builder.create<IREE::HAL::ExSharedDeviceOp>(loc);
+      Value keyValue = builder.create<arith::ConstantIntOp>(loc, key, 64);
+      Value found = builder
+                        .create<func::CallOp>(loc, containsOp,
+                                              ValueRange{device, keyValue})
+                        .getResult(0);
+      Value zero = builder.create<arith::ConstantIntOp>(loc, 0, 32);
+      Value isHit = builder.create<arith::CmpIOp>(
+          loc, arith::CmpIPredicate::ne, found, zero);
+      auto ifOp = builder.create<scf::IfOp>(loc, TypeRange{tensorType}, isHit,
+                                            /*withElseRegion=*/true);
+
+      // Hit: import the cached contents.
+      auto thenBuilder = OpBuilder::atBlockEnd(ifOp.thenBlock());
+      Value cachedView = thenBuilder
+                             .create<func::CallOp>(loc, loadOp,
+                                                   ValueRange{device, keyValue})
+                             .getResult(0);
+      Value cachedValue = thenBuilder.create<IREE::HAL::TensorImportOp>(
+          loc, tensorType, cachedView);
+      thenBuilder.create<scf::YieldOp>(loc, cachedValue);
+
+      // Miss: compute the value and store it in the cache for future loads.
+      Block *elseBlock = ifOp.elseBlock();
+      for (auto *op : computeOps) op->moveBefore(elseBlock, elseBlock->end());
+      auto elseBuilder = OpBuilder::atBlockEnd(elseBlock);
+      Value computedView = elseBuilder.create<IREE::HAL::TensorExportOp>(
+          loc, bufferViewType, computedValue);
+      elseBuilder.create<func::CallOp>(
+          loc, storeOp, ValueRange{device, keyValue, computedView});
+      elseBuilder.create<scf::YieldOp>(loc, computedValue);
+
+      globalStoreOp->setOperand(0, ifOp.getResult(0));
+    }
+  }
+};
+
+}  // namespace
+
+std::unique_ptr<OperationPass<mlir::ModuleOp>> createCacheHoistedGlobalsPass() {
+  return std::make_unique<CacheHoistedGlobalsPass>();
+}
+
+}  // namespace Flow
+}  // namespace IREE
+}  // namespace iree_compiler
+}  // namespace mlir
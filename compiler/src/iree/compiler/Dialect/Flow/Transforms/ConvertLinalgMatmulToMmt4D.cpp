@@ -378,6 +378,15 @@ LinalgMatmulOpToLinalgMmt4DOpPattern::chooseTileParams(Value lhs, Value rhs,
       return chooseMatMulOrMatVec({8, 1, 8}, {8, 1, 1}, {8, 1, 2},
                                   "f32*f32->f32, aarch64");
     }
+    // Weight-only quantized matmuls. The int4 RHS is packed two values per
+    // byte, so RHS tiles need an even number of elements: K0 = 2 keeps that
+    // true for the narrow cases too.
+    if ((lhsElemType.isF32() || lhsElemType.isF16()) &&
+        rhsElemType.isSignlessInteger(4) && accElemType.isF32()) {
+      return chooseMatMulOrMatVec({8, 2, 8}, {8, 2, 1}, {8, 2, 2},
+                                  lhsElemType.isF32() ? "f32*i4->f32, aarch64"
+                                                      : "f16*i4->f32, aarch64");
+    }
   }
   // enableGenericSlow is meant for tests only. It's just a way to get some
   // test coverage for Mmt4d where we do not currently have kernels.
@@ -15,6 +15,7 @@
 #include "iree/compiler/Dialect/Flow/Transforms/Passes.h"
 #include "iree/compiler/Dialect/Flow/Transforms/RegionOpUtils.h"
 #include "llvm/ADT/STLExtras.h"
+#include "llvm/ADT/SetVector.h"
 #include "llvm/ADT/TypeSwitch.h"
 #include "llvm/Support/CommandLine.h"
 #include "llvm/Support/Debug.h"
@@ -52,6 +53,19 @@ static llvm::cl::opt<int> clInlineConstantByteLength(
                    "dispatch region"),
     llvm::cl::init(256));
 
+static llvm::cl::opt<bool> clEnableFusionCostModel(
+    "iree-flow-enable-fusion-cost-model",
+    llvm::cl::desc("Use a memory traffic cost model to decide fusion of "
+                   "elementwise producers into reductions and of roots with "
+                   "consumers that do not dominate all uses"),
+    llvm::cl::init(false));
+
+static llvm::cl::opt<int> clFusionMaxOperands(
+    "iree-flow-fusion-max-operands",
+    llvm::cl::desc("Maximum number of distinct tensor operands a fused pair "
+                   "of ops may read when the fusion cost model is enabled"),
+    llvm::cl::init(8));
+
 static const char kRootOpAttr[] = "__root_op__";
 static const char kFusionGroupsAttr[] = "__fused_op__";
 
@@ -214,6 +228,11 @@ bool isClonableIntoDispatchOp(Operation *op) {
   if (auto constantOp = dyn_cast<arith::ConstantOp>(op)) {
     auto constantValueAttr = constantOp.getValue();
     auto constantType = constantOp.getType();
+    // Encoded constants hold data already packed for the target and must be
+    // read through a binding for the dispatch to materialize their encoding.
+    if (auto tensorType = constantType.dyn_cast<RankedTensorType>()) {
+      if (tensorType.getEncoding()) return false;
+    }
     if (constantValueAttr.isa<SplatElementsAttr>()) {
       return true;
     } else if (auto denseAttr =
@@ -434,6 +453,81 @@ static bool areOpsAggresiveFusable(Operation *producer, Operation *consumer,
   });
 }
 
+//===----------------------------------------------------------------------===//
+// Fusion cost model
+//===----------------------------------------------------------------------===//
+
+/// Returns the size in bytes of `value` if it is a statically shaped tensor.
+static Optional<int64_t> getStaticByteSize(Value value) {
+  auto shapedType = value.getType().dyn_cast<RankedTensorType>();
+  if (!shapedType || !shapedType.hasStaticShape()) return std::nullopt;
+  return (shapedType.getNumElements() * shapedType.getElementTypeBitWidth()) /
+         8;
+}
+
+/// Returns the number of distinct tensor values read by `producer` and
+/// `consumer` from outside of the pair. Each of these becomes a binding of the
+/// fused dispatch and a tile of it is live while the pair executes, so this is
+/// used as a proxy for register and shared memory pressure.
+static int64_t getFusedOperandCount(Operation *producer, Operation *consumer) {
+  llvm::SmallSetVector<Value, 8> operands;
+  for (Operation *op : {producer, consumer}) {
+    for (Value operand : op->getOperands()) {
+      if (!operand.getType().isa<RankedTensorType>()) continue;
+      Operation *definingOp = operand.getDefiningOp();
+      if (definingOp == producer || definingOp == consumer) continue;
+      if (definingOp && isClonableIntoDispatchOp(definingOp)) continue;
+      operands.insert(operand);
+    }
+  }
+  return operands.size();
+}
+
+/// Returns true if fusing the producer of `fusedOperand` into the dispatch of
+/// its owner saves memory traffic without exceeding the operand budget. The
+/// intermediate no longer has to be written by the producer and read back by
+/// the consumer; if it has users outside of the pair it is still written out
+/// and only the read is saved.
+static bool isFusionProfitable(OpOperand &fusedOperand) {
+  Operation *producer = fusedOperand.get().getDefiningOp();
+  Operation *consumer = fusedOperand.getOwner();
+  int64_t operandCount = getFusedOperandCount(producer, consumer);
+  if (operandCount > clFusionMaxOperands) {
+    LLVM_DEBUG(llvm::dbgs() << "not fusing " << producer->getName() << " into "
+                            << consumer->getName() << ": " << operandCount
+                            << " operands exceeds budget\n");
+    return false;
+  }
+  Optional<int64_t> byteSize = getStaticByteSize(fusedOperand.get());
+  // Dynamically shaped intermediates are assumed to be large.
+  if (!byteSize) return true;
+  bool escapes = llvm::any_of(fusedOperand.get().getUsers(),
+                              [&](Operation *user) {
+                                return user != consumer;
+                              });
+  int64_t savedBytes = escapes ? *byteSize : 2 * *byteSize;
+  return savedBytes > 0;
+}
+
+/// Returns true if `operand` is an input of a reduction that reads the result
+/// of an elementwise producer over the whole iteration space with a
+/// permutation. Tiling the parallel loops of the reduction then computes each
+/// element of the producer exactly once inside the fused dispatch, so fusing
+/// removes the round trip of the intermediate through memory.
+static bool isFusableIntoReductionInput(OpOperand &operand) {
+  auto producer = operand.get().getDefiningOp<linalg::GenericOp>();
+  auto consumer = dyn_cast<linalg::GenericOp>(operand.getOwner());
+  if (!producer || !consumer) return false;
+  if (producer.getNumLoops() != producer.getNumParallelLoops()) return false;
+  if (consumer.getNumReductionLoops() == 0 || !consumer.isDpsInput(&operand)) {
+    return false;
+  }
+  if (producer.getNumLoops() != consumer.getNumLoops()) return false;
+  return producer.getIndexingMapMatchingResult(operand.get().cast<OpResult>())
+             .isPermutation() &&
+         consumer.getMatchingIndexingMap(&operand).isPermutation();
+}
+
 /// Returns true if this is a fusable use, while fusing a root with its
 /// consumer.
 static bool isFusableWithConsumer(OpOperand &fusedOperand,
@@ -510,8 +604,11 @@ static void fuseRootsWithConsumers(MLIRContext *context,
       appendToFusionGroup(currRoot, rootNumber);
     };
 
+    // With the cost model a root whose result escapes may still be fused
+    // with its dominating consumer when that saves the read of the result.
     Optional<OpOperand *> fusableUse = getFusableUse(
-        currRoot, dominanceInfo, /*fuseMultiUse=*/aggressiveFusion);
+        currRoot, dominanceInfo,
+        /*fuseMultiUse=*/aggressiveFusion || clEnableFusionCostModel);
     if (!fusableUse) continue;
 
     // Analyse the use to see if it is fusable.
@@ -521,7 +618,9 @@ static void fuseRootsWithConsumers(MLIRContext *context,
       continue;
     }
 
-    if (isFusableWithConsumer(*(fusableUse.value()), aggressiveFusion)) {
+    if (isFusableWithConsumer(*(fusableUse.value()), aggressiveFusion) &&
+        (!clEnableFusionCostModel ||
+         isFusionProfitable(*(fusableUse.value())))) {
       updateRootTo(consumerOp);
       workList.push_back(consumerOp);
     }
@@ -545,6 +644,10 @@ static bool isFusableWithProducer(OpOperand &operand, bool aggressiveFusion) {
     return false;
   }
 
+  if (clEnableFusionCostModel && isFusableIntoReductionInput(operand)) {
+    return true;
+  }
+
   auto consumerLinalgOp = cast<linalg::LinalgOp>(consumer);
   if (consumerLinalgOp.isDpsInput(&operand)) {
     // Only fuse on inputs if both ops are generic ops.
@@ -585,6 +688,7 @@ static void fuseRootsWithProducers(MLIRContext *context, Operation *root,
       if (!fusableUse || fusableUse.value()->getOwner() != candidate) continue;
 
       if (!isFusableWithProducer(operand, aggressiveFusion)) continue;
+      if (clEnableFusionCostModel && !isFusionProfitable(operand)) continue;
 
       appendToFusionGroup(producer, groupNum);
       worklist.push_back(producer);
@@ -0,0 +1,192 @@
+// Copyright 2023 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+//===--------------- FuseHorizontalOps.cpp --------------------------------===//
+//
+// Merges independent elementwise operations that share an iteration space into
+// a single multi-result linalg.generic so that they are formed into a single
+// dispatch instead of one small dispatch each.
+//
+//===----------------------------------------------------------------------===//
+
+#include "iree/compiler/Dialect/Flow/Transforms/PassDetail.h"
+#include "iree/compiler/Dialect/Flow/Transforms/Passes.h"
+#include "llvm/Support/Debug.h"
+#include "mlir/Dialect/Linalg/IR/Linalg.h"
+#include "mlir/IR/BlockAndValueMapping.h"
+#include "mlir/IR/Builders.h"
+#include "mlir/Interfaces/TilingInterface.h"
+
+#define DEBUG_TYPE "iree-flow-fuse-horizontal-ops"
+
+namespace mlir {
+namespace iree_compiler {
+namespace IREE {
+namespace Flow {
+
+namespace {
+
+// Upper bound on the number of ops merged into a single generic. Each member
+// brings its own operands into the dispatch so groups are kept small.
+static constexpr int64_t kMaxGroupSize = 8;
+
+/// Returns true if `genericOp` would otherwise end up in a dispatch of its own:
+/// an all-parallel elementwise op that is neither fed by nor feeding another
+/// tileable op it could be fused with during dispatch region formation.
+static bool isHorizontalFusionCandidate(linalg::GenericOp genericOp) {
+  if (!genericOp.hasTensorSemantics()) return false;
+  if (genericOp.getNumLoops() == 0 ||
+      genericOp.getNumLoops() != genericOp.getNumParallelLoops()) {
+    return false;
+  }
+  if (!genericOp.getRegion().hasOneBlock()) return false;
+  if (llvm::any_of(genericOp.getStaticLoopRanges(), ShapedType::isDynamic)) {
+    return false;
+  }
+  for (Value operand : genericOp->getOperands()) {
+    Operation *producer = operand.getDefiningOp();
+    if (producer && isa<TilingInterface>(producer) &&
+        !isa<linalg::FillOp>(producer)) {
+      return false;
+    }
+  }
+  for (Operation *user : genericOp->getUsers()) {
+    if (isa<TilingInterface>(user)) return false;
+  }
+  return true;
+}
+
+/// Returns true if `candidate` can join `group`: it must have the same
+/// iteration space and none of the results of the group may be used before
+/// `candidate`, which is where the merged op will be created. The latter also
+/// guarantees that `candidate` does not (transitively) depend on the group.
+static bool canJoinGroup(linalg::GenericOp candidate,
+                         ArrayRef<linalg::GenericOp> group) {
+  if (group.size() >= kMaxGroupSize) return false;
+  if (candidate.getStaticLoopRanges() != group.front().getStaticLoopRanges()) {
+    return false;
+  }
+  Block *block = candidate->getBlock();
+  for (linalg::GenericOp member : group) {
+    for (Operation *user : member->getUsers()) {
+      Operation *ancestor = block->findAncestorOpInBlock(*user);
+      if (!ancestor || !candidate->isBeforeInBlock(ancestor)) return false;
+    }
+  }
+  return true;
+}
+
+/// Merges all ops in `group` into a single linalg.generic placed at the last
+/// member. Inputs, outputs, indexing maps and region arguments are
+/// concatenated in group order.
+static void mergeGroup(OpBuilder &builder, ArrayRef<linalg::GenericOp> group) {
+  SmallVector<Value> inputs, outputs;
+  SmallVector<AffineMap> inputMaps, outputMaps;
+  SmallVector<Type> resultTypes;
+  for (linalg::GenericOp member : group) {
+    for (OpOperand *operand : member.getDpsInputOperands()) {
+      inputs.push_back(operand->get());
+      inputMaps.push_back(member.getMatchingIndexingMap(operand));
+    }
+    for (OpOperand *operand : member.getDpsInitOperands()) {
+      outputs.push_back(operand->get());
+      outputMaps.push_back(member.getMatchingIndexingMap(operand));
+    }
+    llvm::append_range(resultTypes, member->getResultTypes());
+  }
+  SmallVector<AffineMap> indexingMaps = inputMaps;
+  llvm::append_range(indexingMaps, outputMaps);
+  SmallVector<utils::IteratorType> iteratorTypes(
+      group.front().getNumLoops(), utils::IteratorType::parallel);
+
+  linalg::GenericOp lastMember = group.back();
+  builder.setInsertionPoint(lastMember);
+  auto fusedOp = builder.create<linalg::GenericOp>(
+      builder.getFusedLoc(llvm::to_vector(llvm::map_range(
+          group, [](linalg::GenericOp op) { return op.getLoc(); }))),
+      resultTypes, inputs, outputs, indexingMaps, iteratorTypes,
+      [&](OpBuilder &nestedBuilder, Location loc, ValueRange args) {
+        ValueRange inputArgs = args.take_front(inputs.size());
+        ValueRange outputArgs = args.drop_front(inputs.size());
+        SmallVector<Value> yieldedValues;
+        for (linalg::GenericOp member : group) {
+          Block *body = member.getBody();
+          BlockAndValueMapping mapping;
+          int64_t numInputs = member.getNumDpsInputs();
+          int64_t numOutputs = member.getNumDpsInits();
+          mapping.map(body->getArguments().take_front(numInputs),
+                      inputArgs.take_front(numInputs));
+          mapping.map(body->getArguments().drop_front(numInputs),
+                      outputArgs.take_front(numOutputs));
+          inputArgs = inputArgs.drop_front(numInputs);
+          outputArgs = outputArgs.drop_front(numOutputs);
+          for (Operation &op : body->without_terminator()) {
+            nestedBuilder.clone(op, mapping);
+          }
+          for (Value yielded : body->getTerminator()->getOperands()) {
+            yieldedValues.push_back(mapping.lookupOrDefault(yielded));
+          }
+        }
+        nestedBuilder.create<linalg::YieldOp>(loc, yieldedValues);
+      });
+
+  LLVM_DEBUG(llvm::dbgs() << "merged " << group.size()
+                          << " ops into: " << fusedOp << "\n");
+  ValueRange fusedResults = fusedOp->getResults();
+  for (linalg::GenericOp member : group) {
+    unsigned numResults = member->getNumResults();
+    member->replaceAllUsesWith(fusedResults.take_front(numResults));
+    fusedResults = fusedResults.drop_front(numResults);
+    member->erase();
+  }
+}
+
+struct FuseHorizontalOpsPass
+    : public FuseHorizontalOpsBase<FuseHorizontalOpsPass> {
+  void getDependentDialects(DialectRegistry &registry) const override {
+    registry.insert<linalg::LinalgDialect>();
+  }
+
+  void runOnOperation() override {
+    SmallVector<SmallVector<linalg::GenericOp>> groups;
+    getOperation()->walk([&](Block *block) {
+      // Groups are formed greedily in block order. A candidate joins the
+      // first open group it is compatible with.
+      SmallVector<SmallVector<linalg::GenericOp>> blockGroups;
+      for (Operation &op : *block) {
+        auto genericOp = dyn_cast<linalg::GenericOp>(op);
+        if (!genericOp || !isHorizontalFusionCandidate(genericOp)) continue;
+        auto it = llvm::find_if(blockGroups, [&](auto &group) {
+          return canJoinGroup(genericOp, group);
+        });
+        if (it != blockGroups.end()) {
+          it->push_back(genericOp);
+        } else {
+          blockGroups.push_back({genericOp});
+        }
+      }
+      for (auto &group : blockGroups) {
+        if (group.size() > 1) groups.push_back(std::move(group));
+      }
+    });
+
+    OpBuilder builder(&getContext());
+    for (auto &group : groups) {
+      mergeGroup(builder, group);
+    }
+  }
+};
+
+}  // namespace
+
+std::unique_ptr<Pass> createFuseHorizontalOpsPass() {
+  return std::make_unique<FuseHorizontalOpsPass>();
+}
+
+}  // namespace Flow
+}  // namespace IREE
+}  // namespace iree_compiler
+}  // namespace mlir
@@ -35,6 +35,15 @@ static llvm::cl::opt<bool> clTraceDispatchTensors(
         "Trace runtime input/output tensors for each dispatch function."),
     llvm::cl::init(false));
 
+static llvm::cl::list<int64_t> clSpecializeDispatchDims(
+    "iree-flow-specialize-dispatch-dims",
+    llvm::cl::desc(
+        "Comma separated list of sizes of the dynamic dimension of dispatches "
+        "to generate statically shaped variants for. Each dispatch with a "
+        "single dynamic dimension picks the matching variant at runtime and "
+        "falls back to the dynamically shaped one otherwise."),
+    llvm::cl::CommaSeparated);
+
 static llvm::cl::opt<bool> clDemoteI64ToI32(
     "iree-flow-demote-i64-to-i32",
     llvm::cl::desc("Converts all i64 ops and values into i32 counterparts "
@@ -105,6 +114,12 @@ static llvm::cl::opt<bool> clCollapseDimensions(
     "iree-flow-form-dispatch-regions-collapse",
     llvm::cl::desc("Collapse dimensions"), llvm::cl::init(true));
 
+static llvm::cl::opt<bool> clEnableHorizontalFusion(
+    "iree-flow-enable-horizontal-fusion",
+    llvm::cl::desc("Merge independent elementwise ops with the same iteration "
+                   "space into a single dispatch"),
+    llvm::cl::init(false));
+
 static llvm::cl::opt<bool> clEnableDataTiling(
     "iree-flow-enable-data-tiling", llvm::cl::desc("Enable data tiling path"),
     llvm::cl::init(false));
@@ -168,6 +183,16 @@ void buildGlobalOptimizationPassPipeline(
   pipeline.addPass(IREE::Util::createFoldGlobalsPass());
   pipeline.addPass(IREE::Util::createIPOPass());
 
+  // Post-training quantization. Probes and quantization run at the same point
+  // so that both enumerate the same matmuls. Quantizing weights before
+  // hoisting lets the weight quantization be evaluated at compile time.
+  if (transformOptions.quantizationCalibrationProbes) {
+    pipeline.addPass(createInsertCalibrationProbesPass());
+  } else if (!transformOptions.quantizationCalibrationFile.empty()) {
+    pipeline.addPass(createQuantizeMatmulsPass(
+        transformOptions.quantizationCalibrationFile));
+  }
+
   if (transformOptions.constExprHoisting) {
     pipeline.addPass(IREE::Util::createHoistIntoGlobalsPass());
   }
@@ -283,8 +308,35 @@ void buildFlowTransformPassPipeline(OpPassManager &passManager,
       // transpose.
       .addPredicatedPass(clNormalizeInputIndexingMap,
                          createInterchangeTransposeGenericOpsPass)
+      // Merge small independent elementwise ops so they share a dispatch.
+      .addPredicatedPass(clEnableHorizontalFusion, createFuseHorizontalOpsPass)
       // Enable data tiling after all linalg level transformations.
-      .addPredicatedPass(clEnableDataTiling, createSetEncodingPass)
+      .addPredicatedPass(clEnableDataTiling, createSetEncodingPass);
+
+  // Pack constant weights at compile time in the layout the target backend
+  // materializes their encoding to so that no dispatch is needed to pack them.
+  if (clEnableDataTiling &&
+      transformOptions.buildConstantEncodingPassPipeline) {
+    transformOptions.buildConstantEncodingPassPipeline(passManager);
+  }
+
+  // Encodings are only set after the global optimization pipeline has hoisted
+  // constant expressions, so without another hoisting step the set_encoding
+  // ops packing constant expressions that could not be folded above would run
+  // on every invocation. Hoisting them into initializers packs each once at
+  // load time.
+  if (clEnableDataTiling && transformOptions.constExprHoisting) {
+    passManager.addPass(IREE::Util::createHoistIntoGlobalsPass());
+  }
+
+  // Initializers left after const-eval (such as those packing weights into the
+  // target's data layout) run on every load. Caching their results lets the
+  // runtime evaluate each of them once per device.
+  if (transformOptions.cacheHoistedGlobals) {
+    passManager.addPass(createCacheHoistedGlobalsPass());
+  }
+
+  FunctionLikeNest(passManager)
       ////////////////////////////////////////////////////////////////////////
       // Dispatch region formation.
       .addPredicatedPass(!clDispatchTransformFileName.empty(),
@@ -322,6 +374,13 @@ void buildFlowTransformPassPipeline(OpPassManager &passManager,
   passManager.addNestedPass<IREE::Flow::ExecutableOp>(
       IREE::Util::createStripDebugOpsPass());
 
+  // Specialize dynamically shaped dispatches for the requested sizes. Done
+  // before deduplication so that equivalent specializations are merged.
+  if (!clSpecializeDispatchDims.empty()) {
+    passManager.addPass(IREE::Flow::createSpecializeDispatchesPass(
+        llvm::to_vector(clSpecializeDispatchDims)));
+  }
+
   // Cleanup identity ops that clutter up the IR and canonicalize.
   FunctionLikeNest(passManager).addPass(mlir::createCanonicalizerPass);
 
@@ -34,11 +34,30 @@ struct TransformOptions : public PassPipelineOptions<TransformOptions> {
   // Enables passes to perform numeric precision reduction.
   bool numericPrecisionReduction = false;
 
+  // Inserts probes that trace the activation ranges used for post-training
+  // quantization.
+  bool quantizationCalibrationProbes = false;
+
+  // Calibration data used to quantize matmuls to i8. Quantization is disabled
+  // when empty.
+  std::string quantizationCalibrationFile;
+
+  // Caches the results of initializers remaining after constant evaluation in
+  // the hoisted_cache runtime module across program loads.
+  bool cacheHoistedGlobals = false;
+
   // Hook to populate a constant evaluation pass pipeline. If nullptr, then
   // no passes are added for constant evaluation. This must be injected in
   // because constant-evaluators can depend on the whole compiler, of which
   // this is a part, and we maintain strict optionality for this component.
   std::function<void(OpPassManager &passManager)> buildConstEvalPassPipeline;
+
+  // Hook to populate passes folding the encodings set on constants when data
+  // tiling is enabled into their data. If nullptr, then constants are packed
+  // by initializers at runtime. This must be injected in because the layouts
+  // are chosen by the codegen backends.
+  std::function<void(OpPassManager &passManager)>
+      buildConstantEncodingPassPipeline;
 };
 
 // Adds a set of passes to the given pass manager that run the required flow
@@ -97,6 +116,10 @@ std::unique_ptr<Pass> createConvertLinalgMatmulToMmt4DPass(StringRef options);
 // Create a pass to detach elementwise ops from named Linalg ops.
 std::unique_ptr<Pass> createDetachElementwiseFromNamedOpsPass();
 
+// Creates a pass to merge independent elementwise ops that share an iteration
+// space into multi-result generic ops so they form a single dispatch.
+std::unique_ptr<Pass> createFuseHorizontalOpsPass();
+
 // Creates a pass to fuse Linalg operations on tensors.
 std::unique_ptr<InterfacePass<mlir::FunctionOpInterface>>
 createFusionOfTensorOpsPass(bool fuseMultiUse = false,
@@ -110,6 +133,10 @@ std::unique_ptr<Pass> createInferNumericNarrowingPass();
 // zero or uninitialized allocations.
 std::unique_ptr<Pass> createInitializeEmptyTensorsPass(bool zeroFill = false);
 
+// Creates a pass that traces the maximum absolute value of the activations of
+// each f32 matmul for use as calibration data by createQuantizeMatmulsPass.
+std::unique_ptr<OperationPass<ModuleOp>> createInsertCalibrationProbesPass();
+
 // Create a pass to interchange generic ops to force the reduction loop to be
 // the most inner loops.
 std::unique_ptr<Pass> createInterchangeGenericOpsPass();
@@ -127,6 +154,11 @@ std::unique_ptr<Pass> createConvertToFlowPass();
 // iree-flow-infer-numeric-narrowing.
 std::unique_ptr<Pass> createOptimizeNumericsPass();
 
+// Creates a pass that quantizes f32 matmuls to i8 x i8 -> i32 matmuls using
+// activation ranges from |calibrationFile| and weight ranges from constants.
+std::unique_ptr<OperationPass<ModuleOp>> createQuantizeMatmulsPass(
+    std::string calibrationFile = "");
+
 // Sets encoding for tensors to allow tiled execution of operations.
 std::unique_ptr<Pass> createSetEncodingPass();
 
@@ -181,6 +213,10 @@ createInjectDispatchTracingPass();
 // Exports all functions and dispatch executables as `() -> ()` benchmark funcs.
 std::unique_ptr<OperationPass<mlir::ModuleOp>> createExportBenchmarkFuncsPass();
 
+// Caches initializer results in the hoisted_cache runtime module so that each
+// is evaluated once per device instead of on every program load.
+std::unique_ptr<OperationPass<mlir::ModuleOp>> createCacheHoistedGlobalsPass();
+
 //===----------------------------------------------------------------------===//
 // Linalg transforms
 //===----------------------------------------------------------------------===//
@@ -201,6 +237,11 @@ createOutlineLargeConstantsPass();
 std::unique_ptr<OperationPass<mlir::ModuleOp>>
 createDeduplicateExecutablesPass();
 
+// Specializes dispatches with a single dynamic dimension for each of
+// `dimSizes`, selecting the statically shaped variant at runtime.
+std::unique_ptr<OperationPass<mlir::ModuleOp>> createSpecializeDispatchesPass(
+    ArrayRef<int64_t> dimSizes = {});
+
 // Create a pass to split reduction dimension.
 std::unique_ptr<Pass> createSplitReductionPass();
 
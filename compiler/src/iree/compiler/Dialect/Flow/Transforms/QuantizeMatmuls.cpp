@@ -0,0 +1,340 @@
+// Copyright 2023 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+// Post-training quantization of f32 matmuls to i8 x i8 -> i32.
+//
+// Quantization is a two step process:
+//  1. The model is compiled with iree-flow-insert-calibration-probes, which
+//     traces the maximum absolute value of each matmul activation, and run
+//     over a calibration dataset. The trace output (printed to stderr by the
+//     runtime) from all runs is concatenated into one calibration file.
+//  2. The model is recompiled with iree-flow-quantize-matmuls pointed at the
+//     calibration file. Activation ranges come from the file and weight ranges
+//     from the constant values themselves.
+//
+// Both passes must run at the same point in the pipeline so that they
+// enumerate the same matmuls.
+
+#include "iree/compiler/Dialect/Flow/IR/FlowDialect.h"
+#include "iree/compiler/Dialect/Flow/IR/FlowOps.h"
+#include "iree/compiler/Dialect/Flow/Transforms/PassDetail.h"
+#include "iree/compiler/Dialect/Flow/Transforms/Passes.h"
+#include "iree/compiler/Dialect/Util/IR/UtilOps.h"
+#include "llvm/ADT/StringMap.h"
+#include "llvm/Support/Debug.h"
+#include "llvm/Support/MemoryBuffer.h"
+#include "mlir/Dialect/Arith/IR/Arith.h"
+#include "mlir/Dialect/Func/IR/FuncOps.h"
+#include "mlir/Dialect/Linalg/IR/Linalg.h"
+#include "mlir/Dialect/Math/IR/Math.h"
+#include "mlir/Dialect/Tensor/IR/Tensor.h"
+#include "mlir/IR/Matchers.h"
+
+#define DEBUG_TYPE "iree-flow-quantize-matmuls"
+
+namespace mlir {
+namespace iree_compiler {
+namespace IREE {
+namespace Flow {
+
+namespace {
+
+// Prefix of the flow.tensor.trace keys emitted by the calibration probes.
+static const char kCalibrationKeyPrefix[] = "calibration:";
+
+// Largest magnitude representable in symmetric i8 quantization.
+static const int64_t kQuantizedMax = 127;
+
+// Returns the f32 linalg.matmul ops in |funcOp| in a stable order along with
+// the key prefix used to identify each in calibration data.
+static SmallVector<std::pair<linalg::MatmulOp, std::string>> getCandidates(
+    func::FuncOp funcOp) {
+  SmallVector<std::pair<linalg::MatmulOp, std::string>> candidates;
+  funcOp.walk([&](linalg::MatmulOp matmulOp) {
+    if (!matmulOp.hasTensorSemantics()) return;
+    for (Value operand : matmulOp->getOperands()) {
+      if (!getElementTypeOrSelf(operand.getType()).isF32()) return;
+    }
+    std::string key =
+        (Twine(funcOp.getName()) + "#" + Twine(candidates.size())).str();
+    candidates.emplace_back(matmulOp, std::move(key));
+  });
+  return candidates;
+}
+
+// Returns the maximum absolute value of |value| if it is a constant or a load
+// of an immutable global with a constant initial value.
+static Optional<double> getConstantAbsMax(Value value,
+                                          SymbolTable &symbolTable) {
+  DenseFPElementsAttr attr;
+  if (auto loadOp =
+          value.getDefiningOp<IREE::Util::GlobalLoadOpInterface>()) {
+    auto globalOp = symbolTable.lookup<IREE::Util::GlobalOpInterface>(
+        loadOp.getGlobalName());
+    if (globalOp && !globalOp.isGlobalMutable()) {
+      attr = globalOp.getGlobalInitialValue()
+                 .dyn_cast_or_null<DenseFPElementsAttr>();
+    }
+  } else {
+    matchPattern(value, m_Constant(&attr));
+  }
+  if (!attr) return llvm::None;
+  double absMax = 0.0;
+  for (APFloat element : attr.getValues<APFloat>()) {
+    absMax = std::max(absMax, std::abs(element.convertToDouble()));
+  }
+  return absMax;
+}
+
+// Returns a tensor.empty with the same shape as |value| and |elementType|.
+static Value createEmptyLike(OpBuilder &builder, Location loc, Value value,
+                             Type elementType) {
+  auto type = value.getType().cast<RankedTensorType>();
+  SmallVector<Value> dynamicDims;
+  for (unsigned i = 0; i < type.getRank(); ++i) {
+    if (type.isDynamicDim(i)) {
+      dynamicDims.push_back(builder.create<tensor::DimOp>(loc, value, i));
+    }
+  }
+  return builder.create<tensor::EmptyOp>(loc, type.getShape(), elementType,
+                                         dynamicDims);
+}
+
+// Quantizes |input| to i8 with symmetric per-tensor |scale|:
+//   q = clamp(round(x / scale), -127, 127)
+static Value quantize(OpBuilder &builder, Location loc, Value input,
+                      double scale) {
+  auto i8Type = builder.getI8Type();
+  Value empty = createEmptyLike(builder, loc, input, i8Type);
+  int64_t rank = input.getType().cast<RankedTensorType>().getRank();
+  SmallVector<AffineMap> maps(2, builder.getMultiDimIdentityMap(rank));
+  SmallVector<utils::IteratorType> iterators(rank,
+                                             utils::IteratorType::parallel);
+  auto genericOp = builder.create<linalg::GenericOp>(
+      loc, empty.getType(), input, empty, maps, iterators,
+      [&](OpBuilder &b, Location nestedLoc, ValueRange args) {
+        Value invScale = b.create<arith::ConstantOp>(
+            nestedLoc, b.getF32FloatAttr(1.0 / scale));
+        Value minValue = b.create<arith::ConstantOp>(
+            nestedLoc, b.getF32FloatAttr(-kQuantizedMax));
+        Value maxValue = b.create<arith::ConstantOp>(
+            nestedLoc, b.getF32FloatAttr(kQuantizedMax));
+        Value scaled = b.create<arith::MulFOp>(nestedLoc, args[0], invScale);
+        Value rounded = b.create<math::RoundOp>(nestedLoc, scaled);
+        Value clamped = b.create<arith::MinFOp>(
+            nestedLoc, b.create<arith::MaxFOp>(nestedLoc, rounded, minValue),
+            maxValue);
+        Value result = b.create<arith::FPToSIOp>(nestedLoc, i8Type, clamped);
+        b.create<linalg::YieldOp>(nestedLoc, result);
+      });
+  return genericOp.getResult(0);
+}
+
+// Rewrites |matmulOp| to an i8 x i8 -> i32 matmul followed by an elementwise
+// requantization back to f32 that accumulates into the original init:
+//   out = init + float(acc) * lhsScale * rhsScale
+// The requantization is a plain elementwise consumer of the matmul so that
+// dispatch region formation fuses it into the matmul dispatch.
+static void quantizeMatmul(linalg::MatmulOp matmulOp, double lhsAbsMax,
+                           double rhsAbsMax) {
+  OpBuilder builder(matmulOp);
+  Location loc = matmulOp.getLoc();
+  Value lhs = matmulOp.getInputs()[0];
+  Value rhs = matmulOp.getInputs()[1];
+  Value init = matmulOp.getOutputs()[0];
+  double lhsScale = lhsAbsMax / kQuantizedMax;
+  double rhsScale = rhsAbsMax / kQuantizedMax;
+
+  Value quantizedLhs = quantize(builder, loc, lhs, lhsScale);
+  Value quantizedRhs = quantize(builder, loc, rhs, rhsScale);
+
+  auto i32Type = builder.getI32Type();
+  Value accEmpty = createEmptyLike(builder, loc, init, i32Type);
+  Value zero =
+      builder.create<arith::ConstantOp>(loc, builder.getZeroAttr(i32Type));
+  Value accInit =
+      builder.create<linalg::FillOp>(loc, zero, accEmpty).getResult(0);
+  Value acc = builder
+                  .create<linalg::MatmulOp>(
+                      loc, ValueRange{quantizedLhs, quantizedRhs},
+                      ValueRange{accInit})
+                  .getResult(0);
+
+  auto resultType = init.getType().cast<RankedTensorType>();
+  Value resultEmpty =
+      createEmptyLike(builder, loc, init, resultType.getElementType());
+  SmallVector<AffineMap> maps(3, builder.getMultiDimIdentityMap(2));
+  SmallVector<utils::IteratorType> iterators(2, utils::IteratorType::parallel);
+  auto requantizeOp = builder.create<linalg::GenericOp>(
+      loc, resultType, ValueRange{acc, init}, resultEmpty, maps, iterators,
+      [&](OpBuilder &b, Location nestedLoc, ValueRange args) {
+        Value scale = b.create<arith::ConstantOp>(
+            nestedLoc, b.getF32FloatAttr(lhsScale * rhsScale));
+        Value value = b.create<arith::SIToFPOp>(nestedLoc, b.getF32Type(),
+                                                args[0]);
+        value = b.create<arith::MulFOp>(nestedLoc, value, scale);
+        value = b.create<arith::AddFOp>(nestedLoc, value, args[1]);
+        b.create<linalg::YieldOp>(nestedLoc, value);
+      });
+  matmulOp.getResult(0).replaceAllUsesWith(requantizeOp.getResult(0));
+  matmulOp.erase();
+}
+
+// Parses calibration data in the format produced by the runtime when
+// tracing the probes: a `=== calibration:<key> ===` header line followed by
+// the formatted tensor (`f32=<value>`). A key may appear any number of times
+// (once per calibration sample) and the largest value is kept.
+static LogicalResult parseCalibrationData(
+    StringRef data, llvm::StringMap<double> &ranges) {
+  StringRef pendingKey;
+  SmallVector<StringRef> lines;
+  data.split(lines, '\n', /*MaxSplit=*/-1, /*KeepEmpty=*/false);
+  for (StringRef line : lines) {
+    line = line.trim();
+    if (line.consume_front("===") && line.consume_back("===")) {
+      StringRef key = line.trim();
+      pendingKey =
+          key.consume_front(kCalibrationKeyPrefix) ? key : StringRef();
+      continue;
+    }
+    if (pendingKey.empty()) continue;
+    double value = 0.0;
+    if (line.rsplit('=').second.trim().getAsDouble(value)) return failure();
+    double &range = ranges[pendingKey];
+    range = std::max(range, std::abs(value));
+    pendingKey = {};
+  }
+  return success();
+}
+
+class QuantizeMatmulsPass : public QuantizeMatmulsBase<QuantizeMatmulsPass> {
+ public:
+  QuantizeMatmulsPass() = default;
+  QuantizeMatmulsPass(const QuantizeMatmulsPass &pass)
+      : QuantizeMatmulsPass(pass.calibrationFile) {}
+  QuantizeMatmulsPass(std::string calibrationFile) {
+    this->calibrationFile = calibrationFile;
+  }
+
+  void getDependentDialects(DialectRegistry &registry) const override {
+    registry.insert<arith::ArithDialect, linalg::LinalgDialect,
+                    math::MathDialect, tensor::TensorDialect>();
+  }
+
+  void runOnOperation() override {
+    llvm::StringMap<double> ranges;
+    if (!calibrationFile.empty()) {
+      auto fileOrErr = llvm::MemoryBuffer::getFile(calibrationFile);
+      if (!fileOrErr) {
+        getOperation().emitError()
+            << "failed to open calibration file '" << calibrationFile
+            << "': " << fileOrErr.getError().message();
+        return signalPassFailure();
+      }
+      if (failed(parseCalibrationData((*fileOrErr)->getBuffer(), ranges))) {
+        getOperation().emitError()
+            << "malformed calibration file '" << calibrationFile << "'";
+        return signalPassFailure();
+      }
+    }
+
+    SymbolTable symbolTable(getOperation());
+    auto getAbsMax = [&](Value value, StringRef key) -> Optional<double> {
+      if (auto constantAbsMax = getConstantAbsMax(value, symbolTable)) {
+        return constantAbsMax;
+      }
+      auto it = ranges.find(key);
+      if (it == ranges.end()) return llvm::None;
+      return it->second;
+    };
+
+    for (auto funcOp : getOperation().getOps<func::FuncOp>()) {
+      for (auto [matmulOp, key] : getCandidates(funcOp)) {
+        auto lhsAbsMax = getAbsMax(matmulOp.getInputs()[0], key + ":lhs");
+        auto rhsAbsMax = getAbsMax(matmulOp.getInputs()[1], key + ":rhs");
+        if (!lhsAbsMax || !rhsAbsMax || *lhsAbsMax == 0.0 ||
+            *rhsAbsMax == 0.0) {
+          LLVM_DEBUG(llvm::dbgs() << "no range for " << key << "\n");
+          continue;
+        }
+        quantizeMatmul(matmulOp, *lhsAbsMax, *rhsAbsMax);
+      }
+    }
+  }
+};
+
+// Returns a 0-d tensor holding the maximum absolute value of |input|.
+static Value buildAbsMax(OpBuilder &builder, Location loc, Value input) {
+  auto f32Type = builder.getF32Type();
+  Value empty = builder.create<tensor::EmptyOp>(loc, ArrayRef<int64_t>{},
+                                                f32Type);
+  Value zero =
+      builder.create<arith::ConstantOp>(loc, builder.getZeroAttr(f32Type));
+  Value init = builder.create<linalg::FillOp>(loc, zero, empty).getResult(0);
+  int64_t rank = input.getType().cast<RankedTensorType>().getRank();
+  SmallVector<AffineMap> maps = {
+      builder.getMultiDimIdentityMap(rank),
+      AffineMap::get(rank, 0, builder.getContext())};
+  SmallVector<utils::IteratorType> iterators(rank,
+                                             utils::IteratorType::reduction);
+  auto genericOp = builder.create<linalg::GenericOp>(
+      loc, init.getType(), input, init, maps, iterators,
+      [&](OpBuilder &b, Location nestedLoc, ValueRange args) {
+        Value absValue = b.create<math::AbsFOp>(nestedLoc, args[0]);
+        Value result = b.create<arith::MaxFOp>(nestedLoc, absValue, args[1]);
+        b.create<linalg::YieldOp>(nestedLoc, result);
+      });
+  return genericOp.getResult(0);
+}
+
+class InsertCalibrationProbesPass
+    : public InsertCalibrationProbesBase<InsertCalibrationProbesPass> {
+ public:
+  void getDependentDialects(DialectRegistry &registry) const override {
+    registry.insert<arith::ArithDialect, IREE::Flow::FlowDialect,
+                    linalg::LinalgDialect, math::MathDialect,
+                    tensor::TensorDialect>();
+  }
+
+  void runOnOperation() override {
+    SymbolTable symbolTable(getOperation());
+    for (auto funcOp : getOperation().getOps<func::FuncOp>()) {
+      for (auto &candidate : getCandidates(funcOp)) {
+        linalg::MatmulOp matmulOp = candidate.first;
+        StringRef key = candidate.second;
+        OpBuilder builder(matmulOp);
+        Location loc = matmulOp.getLoc();
+        auto probe = [&](Value value, StringRef suffix) {
+          // Weight ranges are derived from the constants at quantization time.
+          if (getConstantAbsMax(value, symbolTable)) return;
+          Value absMax = buildAbsMax(builder, loc, value);
+          auto traceKey = builder.getStringAttr(Twine(kCalibrationKeyPrefix) +
+                                                key + suffix);
+          builder.create<IREE::Flow::TensorTraceOp>(loc, traceKey,
+                                                    ValueRange{absMax});
+        };
+        probe(matmulOp.getInputs()[0], ":lhs");
+        probe(matmulOp.getInputs()[1], ":rhs");
+      }
+    }
+  }
+};
+
+}  // namespace
+
+std::unique_ptr<OperationPass<ModuleOp>> createQuantizeMatmulsPass(
+    std::string calibrationFile) {
+  return std::make_unique<QuantizeMatmulsPass>(calibrationFile);
+}
+
+std::unique_ptr<OperationPass<ModuleOp>> createInsertCalibrationProbesPass() {
+  return std::make_unique<InsertCalibrationProbesPass>();
+}
+
+}  // namespace Flow
+}  // namespace IREE
+}  // namespace iree_compiler
+}  // namespace mlir
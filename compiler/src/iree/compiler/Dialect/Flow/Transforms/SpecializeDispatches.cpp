@@ -0,0 +1,218 @@
+// Copyright 2023 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+//===--------------- SpecializeDispatches.cpp -----------------------------===//
+//
+// Specializes dispatches with a dynamic shape for a set of static sizes of
+// their dynamic dimension. Each size gets its own copy of the executable in
+// which the dimension is a constant, so that codegen sees static shapes, and
+// the dispatch site picks the variant at runtime, falling back to the original
+// dynamically shaped executable:
+//
+//   %cmp = arith.cmpi eq, %dim, %c128 : index
+//   cf.cond_br %cmp, ^bb1, ^bb2
+// ^bb1:
+//   %0 = flow.dispatch @ex_spec_128::@entry(%arg0, %dim) : ...
+//   cf.br ^bb3(%0 : tensor<?x64xf32>)
+// ^bb2:
+//   %1 = flow.dispatch @ex::@entry(%arg0, %dim) : ...
+//   cf.br ^bb3(%1 : tensor<?x64xf32>)
+// ^bb3(%2: tensor<?x64xf32>):
+//   ...
+//
+//===----------------------------------------------------------------------===//
+
+#include <map>
+
+#include "iree/compiler/Dialect/Flow/IR/FlowOps.h"
+#include "iree/compiler/Dialect/Flow/Transforms/PassDetail.h"
+#include "iree/compiler/Dialect/Flow/Transforms/Passes.h"
+#include "llvm/ADT/SetVector.h"
+#include "llvm/Support/Debug.h"
+#include "mlir/Dialect/Arith/IR/Arith.h"
+#include "mlir/Dialect/ControlFlow/IR/ControlFlowOps.h"
+#include "mlir/Dialect/Func/IR/FuncOps.h"
+#include "mlir/IR/Builders.h"
+#include "mlir/IR/Matchers.h"
+#include "mlir/IR/SymbolTable.h"
+
+#define DEBUG_TYPE "iree-flow-specialize-dispatches"
+
+namespace mlir {
+namespace iree_compiler {
+namespace IREE {
+namespace Flow {
+
+namespace {
+
+/// Returns the dynamic dimension of all the tensor operands and results of
+/// `dispatchOp` or nullptr if there is none, more than one distinct value or
+/// the value is a constant already. Specializing several dimensions at once
+/// would multiply the number of executables.
+static Value getSpecializableDim(DispatchOp dispatchOp) {
+  SmallVector<Value> dims(dispatchOp.getArgumentDims());
+  llvm::append_range(dims, dispatchOp.getResultDims());
+  Value dim;
+  for (Value value : dims) {
+    if (dim && value != dim) return nullptr;
+    dim = value;
+  }
+  if (!dim || matchPattern(dim, m_Constant())) return nullptr;
+  return dim;
+}
+
+/// Clones `executableOp` with the entry point arguments at `argIndices`
+/// replaced by the constant `size`. Returns a reference to the export of the
+/// clone.
+static SymbolRefAttr createSpecializedExecutable(
+    ExecutableOp executableOp, ExecutableExportOp exportOp,
+    ArrayRef<unsigned> argIndices, int64_t size, SymbolTable &symbolTable) {
+  auto clonedOp = cast<ExecutableOp>(executableOp->clone());
+  clonedOp.setSymName(
+      (executableOp.getName() + "_spec_" + llvm::Twine(size)).str());
+  StringAttr name = symbolTable.insert(clonedOp, Block::iterator(executableOp));
+
+  auto funcOp = clonedOp.getInnerModule().lookupSymbol<func::FuncOp>(
+      exportOp.getFunctionRef());
+  auto builder = OpBuilder::atBlockBegin(&funcOp.front());
+  Value constant =
+      builder.create<arith::ConstantIndexOp>(funcOp.getLoc(), size);
+  for (unsigned index : argIndices) {
+    funcOp.getArgument(index).replaceAllUsesWith(constant);
+  }
+  return SymbolRefAttr::get(
+      name, {FlatSymbolRefAttr::get(exportOp.getSymNameAttr())});
+}
+
+/// Replaces `dispatchOp` with a chain of comparisons of `dim` against the
+/// sizes in `variants` that branch to a dispatch of the corresponding
+/// specialized entry point, or to the original dispatch if none matches.
+static void createDispatchSelector(
+    DispatchOp dispatchOp, Value dim,
+    ArrayRef<std::pair<int64_t, SymbolRefAttr>> variants) {
+  Location loc = dispatchOp.getLoc();
+  Block *block = dispatchOp->getBlock();
+  Block *genericBlock = block->splitBlock(Block::iterator(dispatchOp));
+  Block *continuationBlock =
+      genericBlock->splitBlock(std::next(Block::iterator(dispatchOp)));
+
+  // The results are only known to have the shape of the dispatch results
+  // through the dims that are still in scope, tie them again.
+  auto builder = OpBuilder::atBlockBegin(continuationBlock);
+  for (OpResult result : dispatchOp->getResults()) {
+    Value replacement = continuationBlock->addArgument(result.getType(), loc);
+    ValueRange resultDims =
+        dispatchOp.getResultDynamicDims(result.getResultNumber());
+    if (!resultDims.empty()) {
+      replacement = builder.create<TensorTieShapeOp>(loc, result.getType(),
+                                                     replacement, resultDims);
+    }
+    result.replaceAllUsesWith(replacement);
+  }
+  builder.setInsertionPointToEnd(genericBlock);
+  builder.create<cf::BranchOp>(loc, continuationBlock,
+                               dispatchOp->getResults());
+
+  Block *checkBlock = block;
+  for (auto [index, variant] : llvm::enumerate(variants)) {
+    Block *variantBlock = builder.createBlock(genericBlock);
+    Block *nextBlock = index + 1 == variants.size()
+                           ? genericBlock
+                           : builder.createBlock(genericBlock);
+
+    builder.setInsertionPointToEnd(checkBlock);
+    Value size = builder.create<arith::ConstantIndexOp>(loc, variant.first);
+    Value isMatch = builder.create<arith::CmpIOp>(
+        loc, arith::CmpIPredicate::eq, dim, size);
+    builder.create<cf::CondBranchOp>(loc, isMatch, variantBlock, ValueRange{},
+                                     nextBlock, ValueRange{});
+
+    builder.setInsertionPointToEnd(variantBlock);
+    auto variantOp = cast<DispatchOp>(builder.clone(*dispatchOp));
+    variantOp.setEntryPointAttr(variant.second);
+    builder.create<cf::BranchOp>(loc, continuationBlock,
+                                 variantOp->getResults());
+    checkBlock = nextBlock;
+  }
+}
+
+struct SpecializeDispatchesPass
+    : public SpecializeDispatchesBase<SpecializeDispatchesPass> {
+  void getDependentDialects(DialectRegistry &registry) const override {
+    registry.insert<arith::ArithDialect, cf::ControlFlowDialect>();
+  }
+  SpecializeDispatchesPass(ArrayRef<int64_t> dimSizes) {
+    this->dimSizes = llvm::to_vector(dimSizes);
+  }
+  SpecializeDispatchesPass(const SpecializeDispatchesPass &pass)
+      : SpecializeDispatchesPass(llvm::to_vector(pass.dimSizes)) {}
+
+  void runOnOperation() override {
+    if (dimSizes.empty()) return;
+    ModuleOp moduleOp = getOperation();
+    SymbolTable symbolTable(moduleOp);
+
+    SmallVector<DispatchOp> dispatchOps;
+    moduleOp.walk([&](DispatchOp dispatchOp) {
+      // Only host code directly in a function body can be split into blocks.
+      if (isa<FunctionOpInterface>(dispatchOp->getParentOp())) {
+        dispatchOps.push_back(dispatchOp);
+      }
+    });
+
+    // Dispatch sites of the same executable share its specialized clones.
+    std::map<std::tuple<Operation *, SmallVector<unsigned>, int64_t>,
+             SymbolRefAttr>
+        specializedEntryPoints;
+    for (DispatchOp dispatchOp : dispatchOps) {
+      Value dim = getSpecializableDim(dispatchOp);
+      if (!dim) continue;
+      SmallVector<unsigned> argIndices;
+      for (auto [index, argument] :
+           llvm::enumerate(dispatchOp.getArguments())) {
+        if (argument == dim) argIndices.push_back(index);
+      }
+      // The executable cannot be specialized if it does not see the dim.
+      if (argIndices.empty()) continue;
+
+      auto exportOp = SymbolTable::lookupNearestSymbolFrom<ExecutableExportOp>(
+          dispatchOp, dispatchOp.getEntryPoint());
+      if (!exportOp) continue;
+      auto executableOp = exportOp->getParentOfType<ExecutableOp>();
+      if (!llvm::hasSingleElement(
+              executableOp.getBlock().getOps<ExecutableExportOp>())) {
+        continue;
+      }
+
+      SmallVector<std::pair<int64_t, SymbolRefAttr>> variants;
+      for (int64_t size : llvm::SetVector<int64_t>(dimSizes.begin(),
+                                                   dimSizes.end())) {
+        SymbolRefAttr &entryPoint =
+            specializedEntryPoints[{exportOp.getOperation(), argIndices, size}];
+        if (!entryPoint) {
+          entryPoint = createSpecializedExecutable(
+              executableOp, exportOp, argIndices, size, symbolTable);
+        }
+        variants.emplace_back(size, entryPoint);
+      }
+      LLVM_DEBUG(llvm::dbgs() << "specializing " << dispatchOp << " for "
+                              << variants.size() << " sizes\n");
+      createDispatchSelector(dispatchOp, dim, variants);
+    }
+  }
+};
+
+}  // namespace
+
+std::unique_ptr<OperationPass<mlir::ModuleOp>> createSpecializeDispatchesPass(
+    ArrayRef<int64_t> dimSizes) {
+  return std::make_unique<SpecializeDispatchesPass>(dimSizes);
+}
+
+}  // namespace Flow
+}  // namespace IREE
+}  // namespace iree_compiler
+}  // namespace mlir
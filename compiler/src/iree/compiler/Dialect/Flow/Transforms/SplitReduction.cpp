@@ -29,11 +29,99 @@ static llvm::cl::opt<int64_t> splitReductionRatio(
     "iree-flow-split-matmul-reduction", llvm::cl::desc("split ratio"),
     llvm::cl::init(1));
 
+static llvm::cl::opt<bool> splitSkinnyMatmulReduction(
+    "iree-flow-split-skinny-matmul-reduction",
+    llvm::cl::desc("Split the reduction of statically shaped matmuls with a "
+                   "small M or N and a large K to expose more parallelism. "
+                   "Ignored when --iree-flow-split-matmul-reduction is set"),
+    llvm::cl::init(false));
+
+static llvm::cl::opt<bool> splitRowReduction(
+    "iree-flow-split-row-reduction",
+    llvm::cl::desc("Split the innermost reduction of statically shaped "
+                   "generic ops with few rows and a long reduction (such as "
+                   "norms at batch 1) into two reductions so that each row is "
+                   "reduced by multiple workgroups"),
+    llvm::cl::init(false));
+
 static llvm::cl::list<int64_t> topkSplitReductionRatio(
     "iree-flow-topk-split-reduction",
     llvm::cl::desc("comma separated list of split ratios"),
     llvm::cl::CommaSeparated);
 
+// Matmuls with M or N at most this size are considered skinny. These only
+// produce a handful of workgroups when parallelized over M and N alone.
+static constexpr int64_t kSkinnyMatmulMaxParallelSize = 16;
+// Smallest reduction size each split of a skinny matmul accumulates over.
+static constexpr int64_t kSkinnyMatmulMinReductionChunk = 256;
+// Largest split ratio chosen for skinny matmuls. The partial results are
+// ratio times the size of the result and are reduced by a second dispatch.
+static constexpr int64_t kSkinnyMatmulMaxSplitRatio = 64;
+
+/// Returns the split ratio to use for `matmulOp` if it is a skinny matmul with
+/// a reduction large enough to be split, or 0 otherwise. The ratio is the
+/// largest power of two that divides K and leaves each split at least
+/// kSkinnyMatmulMinReductionChunk elements.
+static int64_t getSkinnyMatmulSplitRatio(linalg::MatmulOp matmulOp) {
+  auto lhsType = matmulOp.getDpsInputOperand(0)
+                     ->get()
+                     .getType()
+                     .dyn_cast<RankedTensorType>();
+  auto rhsType = matmulOp.getDpsInputOperand(1)
+                     ->get()
+                     .getType()
+                     .dyn_cast<RankedTensorType>();
+  if (!lhsType || !rhsType || !lhsType.hasStaticShape() ||
+      !rhsType.hasStaticShape()) {
+    return 0;
+  }
+  int64_t sizeM = lhsType.getDimSize(0);
+  int64_t sizeK = lhsType.getDimSize(1);
+  int64_t sizeN = rhsType.getDimSize(1);
+  if (std::min(sizeM, sizeN) > kSkinnyMatmulMaxParallelSize) return 0;
+  int64_t ratio = 1;
+  while (ratio * 2 <= kSkinnyMatmulMaxSplitRatio && sizeK % (ratio * 2) == 0 &&
+         sizeK / (ratio * 2) >= kSkinnyMatmulMinReductionChunk) {
+    ratio *= 2;
+  }
+  return ratio > 1 ? ratio : 0;
+}
+
+// Row reductions producing at most this many values only fill a handful of
+// workgroups when each row is reduced by a single workgroup.
+static constexpr int64_t kRowReductionMaxRowCount = 16;
+// Smallest number of elements each split of a row reduction accumulates over.
+static constexpr int64_t kRowReductionMinReductionChunk = 512;
+// Largest split ratio chosen for row reductions. The second reduction is then
+// over at most this many partial values per row.
+static constexpr int64_t kRowReductionMaxSplitRatio = 64;
+
+/// Returns the split ratio to use for `genericOp` if it reduces a few long rows
+/// along its innermost loop, or 0 otherwise. The ratio is the largest power of
+/// two that divides the reduction size and leaves each split at least
+/// kRowReductionMinReductionChunk elements.
+static int64_t getRowReductionSplitRatio(linalg::GenericOp genericOp) {
+  if (genericOp.hasDynamicShape() || genericOp.getNumDpsInits() != 1 ||
+      genericOp.getNumReductionLoops() != 1) {
+    return 0;
+  }
+  SmallVector<unsigned> reductionDims;
+  genericOp.getReductionDims(reductionDims);
+  unsigned numLoops = genericOp.getNumLoops();
+  if (reductionDims.front() != numLoops - 1) return 0;
+  SmallVector<int64_t> loopRanges = genericOp.getStaticLoopRanges();
+  int64_t rowCount = 1;
+  for (unsigned i = 0; i < numLoops - 1; ++i) rowCount *= loopRanges[i];
+  if (rowCount > kRowReductionMaxRowCount) return 0;
+  int64_t sizeK = loopRanges.back();
+  int64_t ratio = 1;
+  while (ratio * 2 <= kRowReductionMaxSplitRatio && sizeK % (ratio * 2) == 0 &&
+         sizeK / (ratio * 2) >= kRowReductionMinReductionChunk) {
+    ratio *= 2;
+  }
+  return ratio > 1 ? ratio : 0;
+}
+
 namespace {
 /// Pattern to wrap splitReduction transformation. This also propagates
 /// attributes to allow compilation info attribute to not be lost.
@@ -82,8 +170,8 @@ struct SplitReductionPass : public SplitReductionBase<SplitReductionPass> {
   }
 
   void runOnOperation() override {
-    if (splitReductionRatio.getValue() <= 1 &&
-        topkSplitReductionRatio.empty()) {
+    if (splitReductionRatio.getValue() <= 1 && !splitSkinnyMatmulReduction &&
+        !splitRowReduction && topkSplitReductionRatio.empty()) {
       return;
     }
 
@@ -93,10 +181,28 @@ struct SplitReductionPass : public SplitReductionBase<SplitReductionPass> {
         [&](linalg::LinalgOp op) -> linalg::SplitReductionOptions {
           // For matmul make the new parallel dimension first so that it looks
           // like a batch_matmul and can follow the same codegen.
-          if (isa<linalg::MatmulOp>(op))
-            return {int64_t(splitReductionRatio), 0, /*innerParallel=*/false};
-          // Currently disable spliting reduction for non-matmul op. This will
-          // get enabled after once tests are ready.
+          if (auto matmulOp = dyn_cast<linalg::MatmulOp>(op.getOperation())) {
+            int64_t ratio = splitReductionRatio;
+            if (ratio <= 1 && splitSkinnyMatmulReduction) {
+              ratio = getSkinnyMatmulSplitRatio(matmulOp);
+            }
+            return {ratio, 0, /*innerParallel=*/false};
+          }
+          // Row reductions keep the new parallel dimension innermost in the
+          // partial result so that the second reduction is again along the
+          // innermost dimension and each split reduces a contiguous chunk.
+          if (auto genericOp = dyn_cast<linalg::GenericOp>(op.getOperation())) {
+            if (splitRowReduction) {
+              int64_t ratio = getRowReductionSplitRatio(genericOp);
+              unsigned index = genericOp.getDpsInitOperand(0)
+                                   ->get()
+                                   .getType()
+                                   .cast<ShapedType>()
+                                   .getRank();
+              return {ratio, index, /*innerParallel=*/false};
+            }
+          }
+          // Otherwise splitting reductions of non-matmul ops is disabled.
           return {int64_t(0), 0, /*innerParallel=*/false};
         },
         LinalgExt::LinalgTransformationFilter(
@@ -0,0 +1,55 @@
+// RUN: iree-opt --split-input-file --iree-flow-cache-hoisted-globals %s | FileCheck %s
+
+// CHECK-DAG: func.func private @hoisted_cache.contains(!hal.device, i64) -> i32
+// CHECK-DAG: func.func private @hoisted_cache.load(!hal.device, i64) -> !hal.buffer_view
+// CHECK-DAG: func.func private @hoisted_cache.store(!hal.device, i64, !hal.buffer_view)
+
+util.global private @weights = dense<1.0> : tensor<4x8xf32>
+util.global private @hoisted : tensor<8x4xf32>
+
+// CHECK-LABEL: util.initializer
+util.initializer {
+  // CHECK: %[[DEVICE:.+]] = hal.ex.shared_device : !hal.device
+  // CHECK: %[[KEY:.+]] = arith.constant {{-?[0-9]+}} : i64
+  // CHECK: %[[FOUND:.+]] = func.call @hoisted_cache.contains(%[[DEVICE]], %[[KEY]])
+  // CHECK: %[[HIT:.+]] = arith.cmpi ne, %[[FOUND]], %c0_i32
+  // CHECK: %[[VALUE:.+]] = scf.if %[[HIT]] -> (tensor<8x4xf32>) {
+  // CHECK:   %[[CACHED_VIEW:.+]] = func.call @hoisted_cache.load(%[[DEVICE]], %[[KEY]])
+  // CHECK:   %[[CACHED:.+]] = hal.tensor.import %[[CACHED_VIEW]] : !hal.buffer_view -> tensor<8x4xf32>
+  // CHECK:   scf.yield %[[CACHED]]
+  // CHECK: } else {
+  // CHECK:   %[[WEIGHTS:.+]] = util.global.load @weights
+  // CHECK:   %[[TRANSPOSED:.+]] = linalg.generic
+  // CHECK:   %[[VIEW:.+]] = hal.tensor.export %[[TRANSPOSED]] : tensor<8x4xf32> -> !hal.buffer_view
+  // CHECK:   func.call @hoisted_cache.store(%[[DEVICE]], %[[KEY]], %[[VIEW]])
+  // CHECK:   scf.yield %[[TRANSPOSED]]
+  // CHECK: }
+  %0 = util.global.load @weights : tensor<4x8xf32>
+  %1 = tensor.empty() : tensor<8x4xf32>
+  %2 = linalg.generic {
+    indexing_maps = [affine_map<(d0, d1) -> (d1, d0)>, affine_map<(d0, d1) -> (d0, d1)>],
+    iterator_types = ["parallel", "parallel"]
+  } ins(%0 : tensor<4x8xf32>) outs(%1 : tensor<8x4xf32>) {
+  ^bb0(%in: f32, %out: f32):
+    linalg.yield %in : f32
+  } -> tensor<8x4xf32>
+  // CHECK: util.global.store %[[VALUE]], @hoisted
+  util.global.store %2, @hoisted : tensor<8x4xf32>
+  util.initializer.return
+}
+
+// -----
+
+// Initializers depending on mutable state or with side effects are not cached.
+
+util.global private mutable @state = dense<1.0> : tensor<4xf32>
+util.global private @from_mutable : tensor<4xf32>
+
+// CHECK-NOT: @hoisted_cache
+// CHECK-LABEL: util.initializer
+util.initializer {
+  // CHECK-NOT: scf.if
+  %0 = util.global.load @state : tensor<4xf32>
+  util.global.store %0, @from_mutable : tensor<4xf32>
+  util.initializer.return
+}
@@ -0,0 +1,58 @@
+// RUN: iree-opt --split-input-file --iree-flow-enable-fusion-cost-model --pass-pipeline="builtin.module(func.func(iree-flow-form-dispatch-regions, iree-flow-form-dispatch-workgroups), cse, canonicalize, cse)" %s | FileCheck %s
+
+#map0 = affine_map<(d0, d1) -> (d0, d1)>
+#map1 = affine_map<(d0, d1) -> (d0)>
+func.func @elementwise_into_reduction(%arg0 : tensor<16x32xf32>) -> tensor<16xf32> {
+  %cst = arith.constant 0.000000e+00 : f32
+  %0 = tensor.empty() : tensor<16x32xf32>
+  %1 = linalg.generic {indexing_maps = [#map0, #map0], iterator_types = ["parallel", "parallel"]}
+      ins(%arg0 : tensor<16x32xf32>) outs(%0 : tensor<16x32xf32>) {
+    ^bb0(%b0 : f32, %b1 : f32):
+      %2 = math.exp %b0 : f32
+      linalg.yield %2 : f32
+    } -> tensor<16x32xf32>
+  %3 = tensor.empty() : tensor<16xf32>
+  %4 = linalg.fill ins(%cst : f32) outs(%3 : tensor<16xf32>) -> tensor<16xf32>
+  %5 = linalg.generic {indexing_maps = [#map0, #map1], iterator_types = ["parallel", "reduction"]}
+      ins(%1 : tensor<16x32xf32>) outs(%4 : tensor<16xf32>) {
+    ^bb0(%b0 : f32, %b1 : f32):
+      %6 = arith.addf %b0, %b1 : f32
+      linalg.yield %6 : f32
+    } -> tensor<16xf32>
+  return %5 : tensor<16xf32>
+}
+// CHECK-LABEL: func.func @elementwise_into_reduction
+//       CHECK:   flow.dispatch.workgroups
+//       CHECK:     math.exp
+//       CHECK:     arith.addf
+//   CHECK-NOT:   flow.dispatch.workgroups
+//       CHECK:   return
+
+// -----
+
+#map0 = affine_map<(d0, d1) -> (d0, d1)>
+#map1 = affine_map<(d0, d1) -> (d0)>
+func.func @escaping_reduction_with_consumer(%arg0 : tensor<16x32xf32>)
+    -> (tensor<16xf32>, tensor<16xf32>) {
+  %cst = arith.constant 0.000000e+00 : f32
+  %0 = tensor.empty() : tensor<16xf32>
+  %1 = linalg.fill ins(%cst : f32) outs(%0 : tensor<16xf32>) -> tensor<16xf32>
+  %2 = linalg.generic {indexing_maps = [#map0, #map1], iterator_types = ["parallel", "reduction"]}
+      ins(%arg0 : tensor<16x32xf32>) outs(%1 : tensor<16xf32>) {
+    ^bb0(%b0 : f32, %b1 : f32):
+      %3 = arith.addf %b0, %b1 : f32
+      linalg.yield %3 : f32
+    } -> tensor<16xf32>
+  %4 = linalg.generic {indexing_maps = [affine_map<(d0) -> (d0)>, affine_map<(d0) -> (d0)>], iterator_types = ["parallel"]}
+      ins(%2 : tensor<16xf32>) outs(%0 : tensor<16xf32>) {
+    ^bb0(%b0 : f32, %b1 : f32):
+      %5 = math.sqrt %b0 : f32
+      linalg.yield %5 : f32
+    } -> tensor<16xf32>
+  return %2, %4 : tensor<16xf32>, tensor<16xf32>
+}
+// CHECK-LABEL: func.func @escaping_reduction_with_consumer
+//       CHECK:   %[[DISPATCH:.+]]:2 = flow.dispatch.workgroups
+//       CHECK:     arith.addf
+//       CHECK:     math.sqrt
+//       CHECK:   return %[[DISPATCH]]#{{[01]}}, %[[DISPATCH]]#{{[01]}}
@@ -0,0 +1,58 @@
+// RUN: iree-opt --split-input-file --pass-pipeline="builtin.module(func.func(iree-flow-fuse-horizontal-ops))" %s | FileCheck %s
+
+#map = affine_map<(d0, d1) -> (d0, d1)>
+func.func @independent_elementwise(%arg0 : tensor<4x8xf32>, %arg1 : tensor<4x8xf32>)
+    -> (tensor<4x8xf32>, tensor<4x8xf32>) {
+  %0 = tensor.empty() : tensor<4x8xf32>
+  %1 = linalg.generic {indexing_maps = [#map, #map], iterator_types = ["parallel", "parallel"]}
+      ins(%arg0 : tensor<4x8xf32>) outs(%0 : tensor<4x8xf32>) {
+    ^bb0(%b0 : f32, %b1 : f32):
+      %2 = math.exp %b0 : f32
+      linalg.yield %2 : f32
+    } -> tensor<4x8xf32>
+  %3 = linalg.generic {indexing_maps = [#map, #map], iterator_types = ["parallel", "parallel"]}
+      ins(%arg1 : tensor<4x8xf32>) outs(%0 : tensor<4x8xf32>) {
+    ^bb0(%b0 : f32, %b1 : f32):
+      %4 = math.sqrt %b0 : f32
+      linalg.yield %4 : f32
+    } -> tensor<4x8xf32>
+  return %1, %3 : tensor<4x8xf32>, tensor<4x8xf32>
+}
+// CHECK-LABEL: func.func @independent_elementwise
+//  CHECK-SAME:     %[[ARG0:[a-zA-Z0-9]+]]: tensor<4x8xf32>
+//  CHECK-SAME:     %[[ARG1:[a-zA-Z0-9]+]]: tensor<4x8xf32>
+//       CHECK:   %[[FUSED:.+]]:2 = linalg.generic
+//  CHECK-SAME:       ins(%[[ARG0]], %[[ARG1]] :
+//       CHECK:   ^bb0(%[[B0:.+]]: f32, %[[B1:.+]]: f32, %{{.+}}: f32, %{{.+}}: f32):
+//   CHECK-DAG:     %[[EXP:.+]] = math.exp %[[B0]]
+//   CHECK-DAG:     %[[SQRT:.+]] = math.sqrt %[[B1]]
+//       CHECK:     linalg.yield %[[EXP]], %[[SQRT]]
+//   CHECK-NOT:   linalg.generic
+//       CHECK:   return %[[FUSED]]#0, %[[FUSED]]#1
+
+// -----
+
+#map = affine_map<(d0, d1) -> (d0, d1)>
+func.func @dependent_elementwise(%arg0 : tensor<4x8xf32>) -> tensor<4x8xf32> {
+  %0 = tensor.empty() : tensor<4x8xf32>
+  %1 = linalg.generic {indexing_maps = [#map, #map], iterator_types = ["parallel", "parallel"]}
+      ins(%arg0 : tensor<4x8xf32>) outs(%0 : tensor<4x8xf32>) {
+    ^bb0(%b0 : f32, %b1 : f32):
+      %2 = math.exp %b0 : f32
+      linalg.yield %2 : f32
+    } -> tensor<4x8xf32>
+  %3 = tensor.expand_shape %1 [[0], [1, 2]] : tensor<4x8xf32> into tensor<4x2x4xf32>
+  %4 = tensor.collapse_shape %3 [[0], [1, 2]] : tensor<4x2x4xf32> into tensor<4x8xf32>
+  %5 = linalg.generic {indexing_maps = [#map, #map], iterator_types = ["parallel", "parallel"]}
+      ins(%4 : tensor<4x8xf32>) outs(%0 : tensor<4x8xf32>) {
+    ^bb0(%b0 : f32, %b1 : f32):
+      %6 = math.sqrt %b0 : f32
+      linalg.yield %6 : f32
+    } -> tensor<4x8xf32>
+  return %5 : tensor<4x8xf32>
+}
+// CHECK-LABEL: func.func @dependent_elementwise
+//       CHECK:   linalg.generic
+//       CHECK:     math.exp
+//       CHECK:   linalg.generic
+//       CHECK:     math.sqrt
@@ -0,0 +1,40 @@
+// RUN: iree-opt --split-input-file --iree-flow-insert-calibration-probes %s | FileCheck %s
+
+//  CHECK-DAG: #[[INPUT_MAP:.+]] = affine_map<(d0, d1) -> (d0, d1)>
+//  CHECK-DAG: #[[RESULT_MAP:.+]] = affine_map<(d0, d1) -> ()>
+//      CHECK: func.func @activations
+// CHECK-SAME:     %[[LHS:[a-zA-Z0-9]+]]: tensor<4x8xf32>
+// CHECK-SAME:     %[[RHS:[a-zA-Z0-9]+]]: tensor<8x16xf32>
+func.func @activations(%lhs: tensor<4x8xf32>, %rhs: tensor<8x16xf32>, %init: tensor<4x16xf32>) -> tensor<4x16xf32> {
+  //      CHECK: %[[EMPTY:.+]] = tensor.empty() : tensor<f32>
+  //      CHECK: %[[FILL:.+]] = linalg.fill ins(%{{.+}} : f32) outs(%[[EMPTY]] : tensor<f32>)
+  //      CHECK: %[[LHS_MAX:.+]] = linalg.generic
+  // CHECK-SAME:     indexing_maps = [#[[INPUT_MAP]], #[[RESULT_MAP]]]
+  // CHECK-SAME:     iterator_types = ["reduction", "reduction"]
+  // CHECK-SAME:     ins(%[[LHS]] : tensor<4x8xf32>) outs(%[[FILL]] : tensor<f32>)
+  //      CHECK:   math.absf
+  //      CHECK:   arith.maxf
+  //      CHECK: flow.tensor.trace {key = "calibration:activations#0:lhs"} %[[LHS_MAX]] : tensor<f32>
+  //      CHECK: %[[RHS_MAX:.+]] = linalg.generic
+  // CHECK-SAME:     ins(%[[RHS]] : tensor<8x16xf32>)
+  //      CHECK: flow.tensor.trace {key = "calibration:activations#0:rhs"} %[[RHS_MAX]] : tensor<f32>
+  //      CHECK: linalg.matmul
+  %0 = linalg.matmul ins(%lhs, %rhs : tensor<4x8xf32>, tensor<8x16xf32>) outs(%init : tensor<4x16xf32>) -> tensor<4x16xf32>
+  // CHECK: flow.tensor.trace {key = "calibration:activations#1:lhs"}
+  %1 = linalg.matmul ins(%lhs, %rhs : tensor<4x8xf32>, tensor<8x16xf32>) outs(%0 : tensor<4x16xf32>) -> tensor<4x16xf32>
+  return %1 : tensor<4x16xf32>
+}
+
+// -----
+
+// Constant weights are not probed.
+
+// CHECK-LABEL: func.func @weights
+func.func @weights(%lhs: tensor<4x2xf32>, %init: tensor<4x2xf32>) -> tensor<4x2xf32> {
+  %rhs = arith.constant dense<1.0> : tensor<2x2xf32>
+  //      CHECK: flow.tensor.trace {key = "calibration:weights#0:lhs"}
+  //  CHECK-NOT: flow.tensor.trace
+  //      CHECK: linalg.matmul
+  %0 = linalg.matmul ins(%lhs, %rhs : tensor<4x2xf32>, tensor<2x2xf32>) outs(%init : tensor<4x2xf32>) -> tensor<4x2xf32>
+  return %0 : tensor<4x2xf32>
+}
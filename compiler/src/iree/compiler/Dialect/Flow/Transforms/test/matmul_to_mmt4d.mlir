@@ -248,3 +248,23 @@ func.func @check_target_specific_mmt4d_i8_dynamic_vecmat(%arg0: tensor<1x?xi8>,
 // AARCH64-DOTPROD:        linalg.mmt4d
 // AARCH64-DOTPROD-SAME:     {comment = "i8*i8->i32, aarch64 +dotprod, narrow matrix * matrix, where the narrow matrix has 1 column(s)"}
 // AARCH64-DOTPROD-SAME:     ins({{.*}} : tensor<1x?x1x4xi8>, tensor<?x?x8x4xi8>) outs({{.*}} : tensor<1x?x1x8xi32>) -> tensor<1x?x1x8xi32>
+
+// -----
+func.func @check_target_specific_mmt4d_f32i4_dynamic(%arg0: tensor<?x?xf32>, %arg1: tensor<?x?xi4>, %arg2: tensor<?x?xf32>) -> tensor<?x?xf32> {
+    %0 = linalg.matmul ins(%arg0, %arg1 : tensor<?x?xf32>, tensor<?x?xi4>) outs(%arg2 : tensor<?x?xf32>) -> tensor<?x?xf32>
+    return %0 : tensor<?x?xf32>
+}
+// AARCH64-BASELINE-LABEL:  @check_target_specific_mmt4d_f32i4_dynamic(
+// AARCH64-BASELINE:        linalg.mmt4d
+// AARCH64-BASELINE-SAME:     {comment = "f32*i4->f32, aarch64"}
+// AARCH64-BASELINE-SAME:     ins({{.*}} : tensor<?x?x8x2xf32>, tensor<?x?x8x2xi4>) outs({{.*}} : tensor<?x?x8x8xf32>) -> tensor<?x?x8x8xf32>
+
+// -----
+func.func @check_target_specific_mmt4d_f16i4_dynamic_matvec(%arg0: tensor<?x?xf16>, %arg1: tensor<?x1xi4>, %arg2: tensor<?x1xf32>) -> tensor<?x1xf32> {
+    %0 = linalg.matmul ins(%arg0, %arg1 : tensor<?x?xf16>, tensor<?x1xi4>) outs(%arg2 : tensor<?x1xf32>) -> tensor<?x1xf32>
+    return %0 : tensor<?x1xf32>
+}
+// AARCH64-BASELINE-LABEL:  @check_target_specific_mmt4d_f16i4_dynamic_matvec(
+// AARCH64-BASELINE:        linalg.mmt4d
+// AARCH64-BASELINE-SAME:     {comment = "f16*i4->f32, aarch64, matrix * narrow matrix, where the narrow matrix has 1 column(s)"}
+// AARCH64-BASELINE-SAME:     ins({{.*}} : tensor<?x?x8x2xf16>, tensor<1x?x1x2xi4>) outs({{.*}} : tensor<?x1x8x1xf32>) -> tensor<?x1x8x1xf32>
@@ -0,0 +1,69 @@
+// RUN: iree-opt --split-input-file --pass-pipeline="builtin.module(iree-flow-quantize-matmuls{calibration-file=%p/quantize_matmuls_calibration.txt})" %s | FileCheck %s
+
+// Both ranges come from the calibration file; the largest sample is used.
+
+//  CHECK-DAG: #[[MAP:.+]] = affine_map<(d0, d1) -> (d0, d1)>
+//      CHECK: func.func @activations
+// CHECK-SAME:     %[[LHS:[a-zA-Z0-9]+]]: tensor<4x8xf32>
+// CHECK-SAME:     %[[RHS:[a-zA-Z0-9]+]]: tensor<8x16xf32>
+// CHECK-SAME:     %[[INIT:[a-zA-Z0-9]+]]: tensor<4x16xf32>
+func.func @activations(%lhs: tensor<4x8xf32>, %rhs: tensor<8x16xf32>, %init: tensor<4x16xf32>) -> tensor<4x16xf32> {
+  //      CHECK: %[[QLHS:.+]] = linalg.generic
+  // CHECK-SAME:     ins(%[[LHS]] : tensor<4x8xf32>) outs(%{{.+}} : tensor<4x8xi8>)
+  //      CHECK:   arith.constant 5.000000e+01 : f32
+  //      CHECK:   math.round
+  //      CHECK:   arith.fptosi %{{.+}} : f32 to i8
+  //      CHECK: %[[QRHS:.+]] = linalg.generic
+  // CHECK-SAME:     ins(%[[RHS]] : tensor<8x16xf32>) outs(%{{.+}} : tensor<8x16xi8>)
+  //      CHECK:   arith.constant 1.000000e+03 : f32
+  //      CHECK: %[[ZERO:.+]] = arith.constant 0 : i32
+  //      CHECK: %[[FILL:.+]] = linalg.fill ins(%[[ZERO]] : i32) outs(%{{.+}} : tensor<4x16xi32>)
+  //      CHECK: %[[ACC:.+]] = linalg.matmul
+  // CHECK-SAME:     ins(%[[QLHS]], %[[QRHS]] : tensor<4x8xi8>, tensor<8x16xi8>)
+  // CHECK-SAME:     outs(%[[FILL]] : tensor<4x16xi32>)
+  //      CHECK: %[[RESULT:.+]] = linalg.generic
+  // CHECK-SAME:     indexing_maps = [#[[MAP]], #[[MAP]], #[[MAP]]]
+  // CHECK-SAME:     ins(%[[ACC]], %[[INIT]] : tensor<4x16xi32>, tensor<4x16xf32>)
+  //      CHECK:   arith.constant 2.000000e-05 : f32
+  //      CHECK:   arith.sitofp %{{.+}} : i32 to f32
+  //      CHECK:   arith.mulf
+  //      CHECK:   arith.addf
+  //      CHECK: return %[[RESULT]]
+  %0 = linalg.matmul ins(%lhs, %rhs : tensor<4x8xf32>, tensor<8x16xf32>) outs(%init : tensor<4x16xf32>) -> tensor<4x16xf32>
+  return %0 : tensor<4x16xf32>
+}
+
+// -----
+
+// The weight range is taken from the constant value.
+
+//      CHECK: func.func @weights
+func.func @weights(%lhs: tensor<?x2xf32>, %init: tensor<?x2xf32>) -> tensor<?x2xf32> {
+  %rhs = arith.constant dense<[[0.5, -1.27], [1.0, 0.25]]> : tensor<2x2xf32>
+  //      CHECK: %[[LHS_EMPTY:.+]] = tensor.empty(%{{.+}}) : tensor<?x2xi8>
+  //      CHECK: linalg.generic
+  // CHECK-SAME:     outs(%[[LHS_EMPTY]] : tensor<?x2xi8>)
+  //      CHECK:   arith.constant 1.000000e+01 : f32
+  //      CHECK: linalg.generic
+  // CHECK-SAME:     outs(%{{.+}} : tensor<2x2xi8>)
+  //      CHECK:   arith.constant 1.000000e+02 : f32
+  //      CHECK: linalg.matmul
+  // CHECK-SAME:     -> tensor<?x2xi32>
+  //      CHECK: linalg.generic
+  //      CHECK:   arith.constant 1.000000e-03 : f32
+  %0 = linalg.matmul ins(%lhs, %rhs : tensor<?x2xf32>, tensor<2x2xf32>) outs(%init : tensor<?x2xf32>) -> tensor<?x2xf32>
+  return %0 : tensor<?x2xf32>
+}
+
+// -----
+
+// Matmuls without calibration data are left in f32.
+
+// CHECK-LABEL: func.func @uncalibrated
+func.func @uncalibrated(%lhs: tensor<4x8xf32>, %rhs: tensor<8x16xf32>, %init: tensor<4x16xf32>) -> tensor<4x16xf32> {
+  //      CHECK: linalg.matmul
+  // CHECK-SAME:     outs(%{{.+}} : tensor<4x16xf32>)
+  //  CHECK-NOT: linalg.generic
+  %0 = linalg.matmul ins(%lhs, %rhs : tensor<4x8xf32>, tensor<8x16xf32>) outs(%init : tensor<4x16xf32>) -> tensor<4x16xf32>
+  return %0 : tensor<4x16xf32>
+}
@@ -0,0 +1,75 @@
+// RUN: iree-opt --split-input-file --iree-flow-specialize-dispatches="dim-sizes=16,128" %s | FileCheck %s
+
+flow.executable private @ex {
+  flow.executable.export public @entry
+  builtin.module {
+    func.func @entry(%arg0: !flow.dispatch.tensor<readonly:tensor<?x64xf32>>, %arg1: index, %arg2: !flow.dispatch.tensor<writeonly:tensor<?x64xf32>>) {
+      %0 = flow.dispatch.tie_shape %arg0 : !flow.dispatch.tensor<readonly:tensor<?x64xf32>>{%arg1}
+      %1 = flow.dispatch.tie_shape %arg2 : !flow.dispatch.tensor<writeonly:tensor<?x64xf32>>{%arg1}
+      %2 = flow.dispatch.tensor.load %0, offsets = [0, 0], sizes = [%arg1, 64], strides = [1, 1] : !flow.dispatch.tensor<readonly:tensor<?x64xf32>>{%arg1} -> tensor<?x64xf32>
+      flow.dispatch.tensor.store %2, %1, offsets = [0, 0], sizes = [%arg1, 64], strides = [1, 1] : tensor<?x64xf32> -> !flow.dispatch.tensor<writeonly:tensor<?x64xf32>>{%arg1}
+      return
+    }
+  }
+}
+func.func @dynamic_batch(%arg0: tensor<?x64xf32>, %arg1: index) -> tensor<?x64xf32> {
+  %0 = flow.dispatch @ex::@entry[%arg1](%arg0, %arg1) : (tensor<?x64xf32>{%arg1}, index) -> tensor<?x64xf32>{%arg1}
+  return %0 : tensor<?x64xf32>
+}
+
+//      CHECK: flow.executable private @ex_spec_16
+//      CHECK:   func.func @entry(%[[SPEC16_ARG0:[a-z0-9]+]]: !flow.dispatch.tensor<readonly:tensor<?x64xf32>>, %{{.+}}: index, %[[SPEC16_ARG2:[a-z0-9]+]]: !flow.dispatch.tensor<writeonly:tensor<?x64xf32>>)
+//      CHECK:     %[[SPEC16_DIM:.+]] = arith.constant 16 : index
+//      CHECK:     flow.dispatch.tie_shape %[[SPEC16_ARG0]] : !flow.dispatch.tensor<readonly:tensor<?x64xf32>>{%[[SPEC16_DIM]]}
+//      CHECK:     flow.dispatch.tie_shape %[[SPEC16_ARG2]] : !flow.dispatch.tensor<writeonly:tensor<?x64xf32>>{%[[SPEC16_DIM]]}
+//      CHECK:     flow.dispatch.tensor.load {{.+}} sizes = [%[[SPEC16_DIM]], 64]
+//      CHECK: flow.executable private @ex_spec_128
+//      CHECK:   func.func @entry(
+//      CHECK:     %[[SPEC128_DIM:.+]] = arith.constant 128 : index
+//      CHECK:     flow.dispatch.tensor.load {{.+}} sizes = [%[[SPEC128_DIM]], 64]
+//      CHECK: flow.executable private @ex {
+//      CHECK:     flow.dispatch.tensor.load {{.+}} sizes = [%arg1, 64]
+
+// CHECK-LABEL: func.func @dynamic_batch
+//  CHECK-SAME: (%[[ARG0:.+]]: tensor<?x64xf32>, %[[DIM:.+]]: index)
+//       CHECK:   %[[C16:.+]] = arith.constant 16 : index
+//       CHECK:   %[[IS16:.+]] = arith.cmpi eq, %[[DIM]], %[[C16]] : index
+//       CHECK:   cf.cond_br %[[IS16]], ^[[SPEC16:bb[0-9]+]], ^[[CHECK128:bb[0-9]+]]
+//       CHECK: ^[[SPEC16]]:
+//       CHECK:   %[[RESULT16:.+]] = flow.dispatch @ex_spec_16::@entry[%[[DIM]]](%[[ARG0]], %[[DIM]])
+//       CHECK:   cf.br ^[[CONT:bb[0-9]+]](%[[RESULT16]] : tensor<?x64xf32>)
+//       CHECK: ^[[CHECK128]]:
+//       CHECK:   %[[C128:.+]] = arith.constant 128 : index
+//       CHECK:   %[[IS128:.+]] = arith.cmpi eq, %[[DIM]], %[[C128]] : index
+//       CHECK:   cf.cond_br %[[IS128]], ^[[SPEC128:bb[0-9]+]], ^[[GENERIC:bb[0-9]+]]
+//       CHECK: ^[[SPEC128]]:
+//       CHECK:   %[[RESULT128:.+]] = flow.dispatch @ex_spec_128::@entry[%[[DIM]]](%[[ARG0]], %[[DIM]])
+//       CHECK:   cf.br ^[[CONT]](%[[RESULT128]] : tensor<?x64xf32>)
+//       CHECK: ^[[GENERIC]]:
+//       CHECK:   %[[RESULT:.+]] = flow.dispatch @ex::@entry[%[[DIM]]](%[[ARG0]], %[[DIM]])
+//       CHECK:   cf.br ^[[CONT]](%[[RESULT]] : tensor<?x64xf32>)
+//       CHECK: ^[[CONT]](%[[ARG:.+]]: tensor<?x64xf32>):
+//       CHECK:   %[[TIED:.+]] = flow.tensor.tie_shape %[[ARG]] : tensor<?x64xf32>{%[[DIM]]}
+//       CHECK:   return %[[TIED]]
+
+// -----
+
+// Dispatches with more than one distinct dynamic dimension are left alone.
+
+flow.executable private @ex {
+  flow.executable.export public @entry
+  builtin.module {
+    func.func @entry(%arg0: !flow.dispatch.tensor<readonly:tensor<?x?xf32>>, %arg1: index, %arg2: index, %arg3: !flow.dispatch.tensor<writeonly:tensor<?x?xf32>>) {
+      return
+    }
+  }
+}
+func.func @two_dynamic_dims(%arg0: tensor<?x?xf32>, %arg1: index, %arg2: index) -> tensor<?x?xf32> {
+  %0 = flow.dispatch @ex::@entry[%arg1, %arg2](%arg0, %arg1, %arg2) : (tensor<?x?xf32>{%arg1, %arg2}, index, index) -> tensor<?x?xf32>{%arg1, %arg2}
+  return %0 : tensor<?x?xf32>
+}
+
+//   CHECK-NOT: @ex_spec
+// CHECK-LABEL: func.func @two_dynamic_dims
+//   CHECK-NOT:   cf.cond_br
+//       CHECK:   flow.dispatch @ex::@entry
@@ -0,0 +1,29 @@
+// RUN: iree-opt --split-input-file --iree-flow-split-skinny-matmul-reduction --pass-pipeline="builtin.module(func.func(iree-flow-split-reduction-ops))" %s | FileCheck %s
+
+func.func @skinny_matmul(%lhs : tensor<1x4096xf32>, %rhs : tensor<4096x4096xf32>,
+    %acc : tensor<1x4096xf32>) -> tensor<1x4096xf32> {
+  %0 = linalg.matmul ins(%lhs, %rhs : tensor<1x4096xf32>, tensor<4096x4096xf32>)
+      outs(%acc : tensor<1x4096xf32>) -> tensor<1x4096xf32>
+  return %0 : tensor<1x4096xf32>
+}
+// K is split 16 ways so each split still reduces over 256 elements.
+// CHECK-LABEL: func.func @skinny_matmul
+//   CHECK-DAG:   tensor.expand_shape {{.+}} into tensor<1x16x256xf32>
+//   CHECK-DAG:   tensor.expand_shape {{.+}} into tensor<16x256x4096xf32>
+//       CHECK:   %[[PARTIAL:.+]] = linalg.generic
+//  CHECK-SAME:       -> tensor<16x1x4096xf32>
+//       CHECK:   %[[RESULT:.+]] = linalg.generic
+//  CHECK-SAME:       ins(%[[PARTIAL]] : tensor<16x1x4096xf32>)
+//       CHECK:   return %[[RESULT]]
+
+// -----
+
+func.func @square_matmul(%lhs : tensor<128x4096xf32>, %rhs : tensor<4096x128xf32>,
+    %acc : tensor<128x128xf32>) -> tensor<128x128xf32> {
+  %0 = linalg.matmul ins(%lhs, %rhs : tensor<128x4096xf32>, tensor<4096x128xf32>)
+      outs(%acc : tensor<128x128xf32>) -> tensor<128x128xf32>
+  return %0 : tensor<128x128xf32>
+}
+// CHECK-LABEL: func.func @square_matmul
+//       CHECK:   linalg.matmul
+//   CHECK-NOT:   linalg.generic
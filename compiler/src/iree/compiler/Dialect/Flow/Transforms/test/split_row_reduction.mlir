@@ -0,0 +1,41 @@
+// RUN: iree-opt --split-input-file --iree-flow-split-row-reduction --pass-pipeline="builtin.module(func.func(iree-flow-split-reduction-ops))" %s | FileCheck %s
+
+func.func @row_reduction(%arg0 : tensor<1x4096xf32>, %acc : tensor<1xf32>) -> tensor<1xf32> {
+  %0 = linalg.generic {
+      indexing_maps = [affine_map<(d0, d1) -> (d0, d1)>, affine_map<(d0, d1) -> (d0)>],
+      iterator_types = ["parallel", "reduction"]}
+      ins(%arg0 : tensor<1x4096xf32>) outs(%acc : tensor<1xf32>) {
+  ^bb0(%in: f32, %out: f32):
+    %1 = arith.addf %in, %out : f32
+    linalg.yield %1 : f32
+  } -> tensor<1xf32>
+  return %0 : tensor<1xf32>
+}
+// The row is split 8 ways so each split still reduces over 512 elements and
+// the partial values of each row are innermost for the second reduction.
+// CHECK-LABEL: func.func @row_reduction
+//       CHECK:   tensor.expand_shape {{.+}} into tensor<1x8x512xf32>
+//       CHECK:   %[[PARTIAL:.+]] = linalg.generic
+//  CHECK-SAME:       iterator_types = ["parallel", "parallel", "reduction"]
+//  CHECK-SAME:       -> tensor<1x8xf32>
+//       CHECK:   %[[RESULT:.+]] = linalg.generic
+//  CHECK-SAME:       iterator_types = ["parallel", "reduction"]
+//  CHECK-SAME:       ins(%[[PARTIAL]] : tensor<1x8xf32>)
+//       CHECK:   return %[[RESULT]]
+
+// -----
+
+func.func @many_rows(%arg0 : tensor<512x4096xf32>, %acc : tensor<512xf32>) -> tensor<512xf32> {
+  %0 = linalg.generic {
+      indexing_maps = [affine_map<(d0, d1) -> (d0, d1)>, affine_map<(d0, d1) -> (d0)>],
+      iterator_types = ["parallel", "reduction"]}
+      ins(%arg0 : tensor<512x4096xf32>) outs(%acc : tensor<512xf32>) {
+  ^bb0(%in: f32, %out: f32):
+    %1 = arith.addf %in, %out : f32
+    linalg.yield %1 : f32
+  } -> tensor<512xf32>
+  return %0 : tensor<512xf32>
+}
+// CHECK-LABEL: func.func @many_rows
+//       CHECK:   linalg.generic
+//   CHECK-NOT:   linalg.generic
@@ -332,7 +332,22 @@ std::string ExecutableTargetAttr::getSymbolNameFragment() {
 }
 
 Attribute ExecutableTargetAttr::getMatchExpression() {
-  return DeviceMatchExecutableFormatAttr::get(getContext(), getFormat());
+  auto formatAttr =
+      DeviceMatchExecutableFormatAttr::get(getContext(), getFormat());
+  auto configAttr = getConfiguration();
+  auto featuresAttr =
+      configAttr ? configAttr.getAs<ArrayAttr>("required_cpu_features")
+                 : ArrayAttr{};
+  if (!featuresAttr || featuresAttr.empty()) return formatAttr;
+
+  // Specialized variants must only be selected on processors that have all of
+  // the features the code was compiled to use.
+  SmallVector<Attribute> conditions;
+  conditions.push_back(formatAttr);
+  for (auto featureAttr : featuresAttr.getAsRange<StringAttr>()) {
+    conditions.push_back(DeviceMatchCPUFeatureAttr::get(featureAttr));
+  }
+  return MatchAllAttr::get(getContext(), conditions);
 }
 
 // For now this is very simple: if there are any specified fields that are
@@ -807,6 +822,33 @@ Value DeviceMatchFeatureAttr::buildConditionExpression(
       .getValue();
 }
 
+// static
+Attribute DeviceMatchCPUFeatureAttr::parse(AsmParser &p, Type type) {
+  StringAttr patternAttr;
+  if (failed(p.parseLess()) || failed(p.parseAttribute(patternAttr)) ||
+      failed(p.parseGreater())) {
+    return {};
+  }
+  return get(p.getContext(), patternAttr);
+}
+
+void DeviceMatchCPUFeatureAttr::print(AsmPrinter &p) const {
+  auto &os = p.getStream();
+  os << "<";
+  p.printAttribute(getPattern());
+  os << ">";
+}
+
+Value DeviceMatchCPUFeatureAttr::buildConditionExpression(
+    Location loc, Value device, OpBuilder builder) const {
+  auto i1Type = builder.getI1Type();
+  return builder
+      .create<IREE::HAL::DeviceQueryOp>(
+          loc, i1Type, i1Type, device, builder.getStringAttr("hal.cpu"),
+          getPattern(), builder.getZeroAttr(i1Type))
+      .getValue();
+}
+
 // static
 Attribute DeviceMatchArchitectureAttr::parse(AsmParser &p, Type type) {
   StringAttr patternAttr;
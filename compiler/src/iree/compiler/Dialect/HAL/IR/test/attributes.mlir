@@ -5,7 +5,9 @@
   // CHECK: dslb0 = #hal.descriptor_set.binding<0, uniform_buffer>
   dslb0 = #hal.descriptor_set.binding<0, uniform_buffer>,
   // CHECK: dslb1 = #hal.descriptor_set.binding<1, storage_buffer>
-  dslb1 = #hal.descriptor_set.binding<1, storage_buffer>
+  dslb1 = #hal.descriptor_set.binding<1, storage_buffer>,
+  // CHECK: dslb2 = #hal.descriptor_set.binding<2, uniform_texel_buffer, ReadOnly>
+  dslb2 = #hal.descriptor_set.binding<2, uniform_texel_buffer, ReadOnly>
 } : () -> ()
 
 // -----
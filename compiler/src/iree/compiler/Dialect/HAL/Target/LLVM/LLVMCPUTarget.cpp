@@ -20,12 +20,14 @@
 #include "iree/compiler/Dialect/HAL/Target/LLVM/StaticLibraryGenerator.h"
 #include "iree/compiler/Dialect/HAL/Target/TargetRegistry.h"
 #include "iree/compiler/Utils/ModuleUtils.h"
+#include "llvm/ADT/FloatingPointMode.h"
 #include "llvm/Analysis/TargetTransformInfo.h"
 #include "llvm/Bitcode/BitcodeReader.h"
 #include "llvm/Bitcode/BitcodeWriter.h"
 #include "llvm/IR/LLVMContext.h"
 #include "llvm/IR/Module.h"
 #include "llvm/Linker/Linker.h"
+#include "llvm/MC/MCSubtargetInfo.h"
 #include "llvm/Support/TargetSelect.h"
 #include "mlir/Dialect/ArmNeon/ArmNeonDialect.h"
 #include "mlir/Dialect/LLVMIR/LLVMDialect.h"
@@ -113,11 +115,72 @@ static LogicalResult linkBuiltinLibrary(
   return success();
 }
 
+// Hides all symbols in |module| except |queryLibraryFunc| and the DLL entry
+// point by giving them internal linkage.
+static void internalizeSymbols(llvm::Module &module,
+                               llvm::Function *queryLibraryFunc) {
+  for (auto &func : module) {
+    if (&func == queryLibraryFunc || func.getName() == "iree_dll_main") {
+      // Leave our library query function as public/external so that it is
+      // exported from shared objects and available for linking in static
+      // objects.
+      continue;
+    } else if (func.isDeclaration()) {
+      // Declarations must have their original visibility/linkage; they most
+      // often come from declared llvm builtin ops (llvm.memcpy/etc).
+      continue;
+    }
+    func.setDSOLocal(true);
+    func.setLinkage(llvm::GlobalValue::LinkageTypes::InternalLinkage);
+  }
+  for (auto &global : module.getGlobalList()) {
+    // Intrinsic globals (llvm.global_ctors/etc) must keep their linkage.
+    if (global.getName().startswith("llvm.")) continue;
+    global.setDSOLocal(true);
+    global.setLinkage(llvm::GlobalValue::LinkageTypes::InternalLinkage);
+  }
+}
+
+// Returns the `iree/schemas/cpu_data.h` keys of the processor features that
+// code generated by |targetMachine| may use and that the runtime can query.
+static SmallVector<std::string> getRuntimeCPUFeatures(
+    llvm::TargetMachine &targetMachine) {
+  struct RuntimeCPUFeature {
+    llvm::Triple::ArchType arch;
+    const char *key;
+    // LLVM features that must all be enabled for the runtime feature to be
+    // required.
+    const char *llvmFeatures;
+  };
+  static const RuntimeCPUFeature kRuntimeCPUFeatures[] = {
+      {llvm::Triple::aarch64, "dotprod", "+dotprod"},
+      {llvm::Triple::aarch64, "i8mm", "+i8mm"},
+      {llvm::Triple::x86_64, "avx2_fma", "+avx2,+fma"},
+      {llvm::Triple::x86_64, "avx512_base",
+       "+avx512f,+avx512cd,+avx512vl,+avx512dq,+avx512bw"},
+      {llvm::Triple::x86_64, "avx512vnni", "+avx512vnni"},
+      {llvm::Triple::x86_64, "avx512bf16", "+avx512bf16"},
+      {llvm::Triple::riscv64, "v", "+v"},
+      {llvm::Triple::riscv64, "zvl256b", "+zvl256b"},
+  };
+  auto arch = targetMachine.getTargetTriple().getArch();
+  auto *subtargetInfo = targetMachine.getMCSubtargetInfo();
+  SmallVector<std::string> features;
+  for (auto &feature : kRuntimeCPUFeatures) {
+    if (feature.arch == arch &&
+        subtargetInfo->checkFeatures(feature.llvmFeatures)) {
+      features.push_back(feature.key);
+    }
+  }
+  return features;
+}
+
 class LLVMCPUTargetBackend final : public TargetBackend {
  public:
   explicit LLVMCPUTargetBackend(LLVMTargetOptions options)
       : options_(std::move(options)) {
-    initializeConfiguration(options_);
+    config_ = getConfiguration(options_.target);
+    initializeVariants();
   }
 
   std::string name() const override { return "llvm-cpu"; }
@@ -136,6 +199,36 @@ class LLVMCPUTargetBackend final : public TargetBackend {
     // clang-format on
   }
 
+  bool appendCacheKey(llvm::raw_ostream &os) const override {
+    // Static libraries and kept linker artifacts are written to disk during
+    // serialization and would be missing for cached executables.
+    if (!options_.staticLibraryOutput.empty() ||
+        options_.keepLinkerArtifacts) {
+      return false;
+    }
+    auto appendTarget = [&](const LLVMTarget &target) {
+      os << target.triple << "," << target.cpu << "," << target.cpuFeatures
+         << ";";
+    };
+    appendTarget(options_.target);
+    for (auto &target : options_.targetVariants) appendTarget(target);
+    const auto &tuning = options_.pipelineTuningOptions;
+    os << tuning.LoopInterleaving << tuning.LoopVectorization
+       << tuning.SLPVectorization << tuning.LoopUnrolling << ";"
+       << options_.optimizerOptLevel.getSpeedupLevel()
+       << options_.optimizerOptLevel.getSizeLevel() << ";"
+       << static_cast<int>(options_.codeGenOptLevel) << ";"
+       << static_cast<int>(options_.options.FloatABIType) << ";"
+       << options_.options.MCOptions.ABIName << ";" << options_.debugSymbols
+       << static_cast<int>(options_.sanitizerKind)
+       << options_.linkTimeOptimization << options_.workgroupRangeDispatch
+       << options_.linkEmbedded << options_.linkStatic << ";"
+       << options_.codegenPartitions << ";"
+       << options_.systemLinkerPath << ";" << options_.embeddedLinkerPath
+       << ";" << options_.wasmLinkerPath;
+    return true;
+  }
+
   IREE::HAL::DeviceTargetAttr getDefaultDeviceTarget(
       MLIRContext *context) const override {
     Builder b(context);
@@ -223,6 +316,27 @@ class LLVMCPUTargetBackend final : public TargetBackend {
                                       "dialect to the native llvm::Module";
     }
 
+    // Denormal handling the dispatches are compiled for. When not specified
+    // the runtime flushes denormals to zero and LLVM is not told about it.
+    std::string denormalFpMath = options_.denormalFpMath;
+    if (auto configAttr = variantOp.getTarget().getConfiguration()) {
+      if (auto denormalAttr =
+              configAttr.getAs<StringAttr>("denormal_fp_math")) {
+        denormalFpMath = denormalAttr.str();
+      }
+    }
+    llvm::DenormalMode denormalMode = llvm::DenormalMode::getPreserveSign();
+    if (!denormalFpMath.empty()) {
+      denormalMode = llvm::parseDenormalFPAttribute(denormalFpMath);
+      if (!denormalMode.isValid() ||
+          denormalMode.Output == llvm::DenormalMode::Dynamic ||
+          denormalMode.Input == llvm::DenormalMode::Dynamic) {
+        return variantOp.emitError()
+               << "unsupported denormal fp math mode '" << denormalFpMath
+               << "'";
+      }
+    }
+
     // Configure the functions in the module. This may override defaults set
     // during the MLIR->LLVM conversion.
     for (auto &func : *llvmModule) {
@@ -239,6 +353,12 @@ class LLVMCPUTargetBackend final : public TargetBackend {
       // Our dispatches are all hot - that's kind of the point.
       // This may favor more aggressive optimizations.
       func.addFnAttr("hot");
+
+      // Let LLVM know how denormals will be treated so that it can fold
+      // consistently with the runtime behavior.
+      if (!denormalFpMath.empty()) {
+        func.addFnAttr("denormal-fp-math", denormalMode.str());
+      }
     }
 
     // Build the IREE HAL executable library metadata. The runtime uses this to
@@ -313,9 +433,15 @@ class LLVMCPUTargetBackend final : public TargetBackend {
           sourceLine = loc.getLine();
         }
       }
-      libraryBuilder.addExport(
-          exportOp.getName(), sourceFile, sourceLine, /*tag=*/"",
-          LibraryBuilder::DispatchAttrs{localMemorySize}, llvmFunc);
+      LibraryBuilder::DispatchAttrs dispatchAttrs;
+      dispatchAttrs.localMemorySize = localMemorySize;
+      dispatchAttrs.workgroupRange = options_.workgroupRangeDispatch;
+      dispatchAttrs.preserveDenormalResults =
+          denormalMode.Output == llvm::DenormalMode::IEEE;
+      dispatchAttrs.preserveDenormalInputs =
+          denormalMode.Input == llvm::DenormalMode::IEEE;
+      libraryBuilder.addExport(exportOp.getName(), sourceFile, sourceLine,
+                               /*tag=*/"", dispatchAttrs, llvmFunc);
     }
 
     auto queryFunctionName = std::string(kQueryFunctionName);
@@ -386,6 +512,12 @@ class LLVMCPUTargetBackend final : public TargetBackend {
     auto *llvmIdent = llvmModule->getNamedMetadata("llvm.ident");
     if (llvmIdent) llvmIdent->clearOperands();
 
+    // Internalize everything before optimizing the whole module so that the
+    // optimizer is free to inline, merge or drop any of it.
+    if (options_.linkTimeOptimization) {
+      internalizeSymbols(*llvmModule, queryLibraryFunc);
+    }
+
     // LLVM opt passes that perform code generation optimizations/transformation
     // similar to what a frontend would do.
     if (failed(
@@ -398,47 +530,36 @@ class LLVMCPUTargetBackend final : public TargetBackend {
 
     // Fixup visibility from any symbols we may link in - we want to hide all
     // but the query entry point.
-    for (auto &func : *llvmModule) {
-      if (&func == queryLibraryFunc || func.getName() == "iree_dll_main") {
-        // Leave our library query function as public/external so that it is
-        // exported from shared objects and available for linking in static
-        // objects.
-        continue;
-      } else if (func.isDeclaration()) {
-        // Declarations must have their original visibility/linkage; they most
-        // often come from declared llvm builtin ops (llvm.memcpy/etc).
-        continue;
-      }
-      func.setDSOLocal(true);
-      func.setLinkage(llvm::GlobalValue::LinkageTypes::InternalLinkage);
-    }
-    for (auto &global : llvmModule->getGlobalList()) {
-      global.setDSOLocal(true);
-      global.setLinkage(llvm::GlobalValue::LinkageTypes::InternalLinkage);
-    }
+    internalizeSymbols(*llvmModule, queryLibraryFunc);
 
     SmallVector<Artifact> objectFiles;
 
     // Emit the base object file containing the bulk of our code.
     // This must come first such that we have the proper library linking order.
     {
-      // NOTE: today we just use a single object file, however if we wanted to
-      // scale code generation and linking we'd want to generate one per
-      // function (or something like that). A single object file is also
-      // instrumental to static library generation (which only supports one
-      // object file per library).
-      std::string objectData;
-      if (failed(runEmitObjFilePasses(targetMachine.get(), llvmModule.get(),
-                                      llvm::CGFT_ObjectFile, &objectData))) {
+      // NOTE: code generation can be split across multiple object files to
+      // scale with the number of functions in the executable but static
+      // library generation only supports one object file per library.
+      unsigned partitionCount =
+          options_.linkStatic ? 1 : options_.codegenPartitions;
+      SmallVector<std::string> objectData;
+      if (failed(runEmitObjFilePassesInParallel(target, options_,
+                                                llvmModule.get(),
+                                                partitionCount, objectData))) {
         return variantOp.emitError()
                << "failed to compile LLVM-IR module to an object file";
       }
-      auto objectFile = Artifact::createTemporary(libraryName, "o");
-      auto &os = objectFile.outputFile->os();
-      os << objectData;
-      os.flush();
-      os.close();
-      objectFiles.push_back(std::move(objectFile));
+      for (auto [index, data] : llvm::enumerate(objectData)) {
+        auto objectFile = Artifact::createTemporary(
+            index == 0 ? libraryName
+                       : libraryName + "_part" + std::to_string(index),
+            "o");
+        auto &os = objectFile.outputFile->os();
+        os << data;
+        os.flush();
+        os.close();
+        objectFiles.push_back(std::move(objectFile));
+      }
     }
 
     // If we are keeping artifacts then let's also add the bitcode and
@@ -644,15 +765,40 @@ class LLVMCPUTargetBackend final : public TargetBackend {
   }
 
  private:
+  // Additional target information besides that is contained in
+  // LLVMTargetOptions options_.
+  struct AdditionalConfigurationValues {
+    std::string dataLayoutStr;
+    int64_t vectorSize;
+  };
+
+  // A specialized version of the default target selected at runtime when the
+  // processor has all of the |requiredCPUFeatures|.
+  struct Variant {
+    LLVMTarget target;
+    AdditionalConfigurationValues config;
+    SmallVector<std::string> requiredCPUFeatures;
+  };
+
   ArrayAttr getExecutableTargets(MLIRContext *context) const {
     SmallVector<Attribute> targetAttrs;
-    // This is where we would multiversion.
-    targetAttrs.push_back(getExecutableTarget(context));
+    // Executables are multiversioned for each CPU variant. The device switch
+    // selecting the variant at runtime tests the targets in order so the
+    // unconditionally loadable default target must come last.
+    for (auto &variant : variants_) {
+      targetAttrs.push_back(getExecutableTarget(context, variant.target,
+                                                variant.config,
+                                                variant.requiredCPUFeatures));
+    }
+    targetAttrs.push_back(
+        getExecutableTarget(context, options_.target, config_, {}));
     return ArrayAttr::get(context, targetAttrs);
   }
 
   IREE::HAL::ExecutableTargetAttr getExecutableTarget(
-      MLIRContext *context) const {
+      MLIRContext *context, const LLVMTarget &target,
+      const AdditionalConfigurationValues &targetConfig,
+      ArrayRef<std::string> requiredCPUFeatures) const {
     std::string format;
     if (options_.linkStatic) {
       // Static libraries are just string references when serialized so we don't
@@ -723,31 +869,47 @@ class LLVMCPUTargetBackend final : public TargetBackend {
     };
 
     // Set target attributes.
-    addConfig("target_triple",
-              StringAttr::get(context, options_.target.triple));
-    addConfig("cpu", StringAttr::get(context, options_.target.cpu));
-    addConfig("cpu_features",
-              StringAttr::get(context, options_.target.cpuFeatures));
+    addConfig("target_triple", StringAttr::get(context, target.triple));
+    addConfig("cpu", StringAttr::get(context, target.cpu));
+    addConfig("cpu_features", StringAttr::get(context, target.cpuFeatures));
 
     // Set data layout
-    addConfig("data_layout", StringAttr::get(context, config_.dataLayoutStr));
+    addConfig("data_layout",
+              StringAttr::get(context, targetConfig.dataLayoutStr));
 
     // Set the native vector size. This creates a dummy llvm module just to
     // build the TTI the right way.
-    addConfig("native_vector_size",
-              IntegerAttr::get(IndexType::get(context), config_.vectorSize));
+    addConfig("native_vector_size", IntegerAttr::get(IndexType::get(context),
+                                                     targetConfig.vectorSize));
+
+    // Record the denormal handling the executable is compiled for.
+    if (!options_.denormalFpMath.empty()) {
+      addConfig("denormal_fp_math",
+                StringAttr::get(context, options_.denormalFpMath));
+    }
+
+    // Restrict CPU variants to the processors that can run them.
+    if (!requiredCPUFeatures.empty()) {
+      SmallVector<Attribute> featureAttrs;
+      for (auto &feature : requiredCPUFeatures) {
+        featureAttrs.push_back(StringAttr::get(context, feature));
+      }
+      addConfig("required_cpu_features", ArrayAttr::get(context, featureAttrs));
+    }
 
     return IREE::HAL::ExecutableTargetAttr::get(
         context, StringAttr::get(context, "llvm-cpu"),
         StringAttr::get(context, format), DictionaryAttr::get(context, config));
   }
 
-  void initializeConfiguration(const LLVMTargetOptions &options) {
-    auto targetMachine = createTargetMachine(options.target, options);
+  AdditionalConfigurationValues getConfiguration(
+      const LLVMTarget &target) const {
+    auto targetMachine = createTargetMachine(target, options_);
+    AdditionalConfigurationValues config;
 
     // Data layout
     llvm::DataLayout DL = targetMachine->createDataLayout();
-    config_.dataLayoutStr = DL.getStringRepresentation();
+    config.dataLayoutStr = DL.getStringRepresentation();
 
     // Set the native vector size. This creates a dummy llvm module just to
     // build the TTI the right way.
@@ -761,28 +923,53 @@ class LLVMCPUTargetBackend final : public TargetBackend {
         llvm::GlobalValue::ExternalLinkage, "dummy_func", *llvmModule);
     llvm::TargetTransformInfo tti =
         targetMachine->getTargetTransformInfo(*dummyFunc);
-    config_.vectorSize = tti.getRegisterBitWidth(
-                             llvm::TargetTransformInfo::RGK_FixedWidthVector) /
-                         8;
+    config.vectorSize = tti.getRegisterBitWidth(
+                            llvm::TargetTransformInfo::RGK_FixedWidthVector) /
+                        8;
     LLVM_DEBUG({
       llvm::dbgs() << "CPU : " << targetMachine->getTargetCPU() << "\n";
       llvm::dbgs() << "Target Triple : "
                    << targetMachine->getTargetTriple().normalize() << "\n";
       llvm::dbgs() << "Target Feature string : "
                    << targetMachine->getTargetFeatureString() << "\n";
-      llvm::dbgs() << "Data Layout : " << config_.dataLayoutStr << "\n";
-      llvm::dbgs() << "Vector Width : " << config_.vectorSize << "\n";
+      llvm::dbgs() << "Data Layout : " << config.dataLayoutStr << "\n";
+      llvm::dbgs() << "Vector Width : " << config.vectorSize << "\n";
     });
+    return config;
+  }
+
+  // Sets up the CPU variants requested in the options. A variant is only
+  // useful if it requires some runtime-queryable feature the default target
+  // does not, as otherwise it would either never be selected or be selected on
+  // processors that cannot run it.
+  void initializeVariants() {
+    auto defaultMachine = createTargetMachine(options_.target, options_);
+    if (!defaultMachine) return;
+    auto defaultFeatures = getRuntimeCPUFeatures(*defaultMachine);
+    for (auto &target : options_.targetVariants) {
+      auto targetMachine = createTargetMachine(target, options_);
+      if (!targetMachine) continue;
+      auto requiredCPUFeatures = getRuntimeCPUFeatures(*targetMachine);
+      if (requiredCPUFeatures.empty() ||
+          llvm::all_of(requiredCPUFeatures, [&](const std::string &feature) {
+            return llvm::is_contained(defaultFeatures, feature);
+          })) {
+        llvm::errs() << "WARNING: ignoring CPU variant '" << target.cpu << ":"
+                     << target.cpuFeatures
+                     << "' as it requires no runtime-detectable CPU features "
+                        "beyond those of the default target\n";
+        continue;
+      }
+      variants_.push_back(
+          {target, getConfiguration(target), std::move(requiredCPUFeatures)});
+    }
   }
 
   LLVMTargetOptions options_;
 
-  // Additional target information besides that is contained in
-  // LLVMTargetOptions options_.
-  struct AdditionalConfigurationValues {
-    std::string dataLayoutStr;
-    int64_t vectorSize;
-  } config_;
+  AdditionalConfigurationValues config_;
+
+  SmallVector<Variant> variants_;
 };
 
 void registerLLVMCPUTargetBackends(
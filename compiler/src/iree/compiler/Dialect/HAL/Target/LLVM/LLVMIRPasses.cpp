@@ -6,7 +6,9 @@
 
 #include "iree/compiler/Dialect/HAL/Target/LLVM/LLVMIRPasses.h"
 
+#include "llvm/ADT/STLExtras.h"
 #include "llvm/Analysis/AliasAnalysis.h"
+#include "llvm/CodeGen/ParallelCG.h"
 #include "llvm/IR/IRBuilder.h"
 #include "llvm/IR/LegacyPassManager.h"
 #include "llvm/IR/Module.h"
@@ -55,7 +57,12 @@ LogicalResult runLLVMIRPasses(const LLVMTargetOptions &options,
       /*DebugLogging=*/false);
   standardInstrumentations.registerCallbacks(passInstrumentationCallbacks);
 
-  llvm::PassBuilder passBuilder(machine, options.pipelineTuningOptions, {},
+  llvm::PipelineTuningOptions pipelineTuningOptions =
+      options.pipelineTuningOptions;
+  // Dispatch functions of the same executable often share identical helpers
+  // that can only be merged when looking at the whole module.
+  if (options.linkTimeOptimization) pipelineTuningOptions.MergeFunctions = true;
+  llvm::PassBuilder passBuilder(machine, pipelineTuningOptions, {},
                                 &passInstrumentationCallbacks);
   llvm::AAManager aa = passBuilder.buildDefaultAAPipeline();
   functionAnalysisManager.registerPass([&] { return std::move(aa); });
@@ -95,8 +102,18 @@ LogicalResult runLLVMIRPasses(const LLVMTargetOptions &options,
   if (options.optimizerOptLevel != llvm::OptimizationLevel::O0 ||
       options.sanitizerKind != SanitizerKind::kNone) {
     llvm::ModulePassManager modulePassManager;
-    modulePassManager =
-        passBuilder.buildPerModuleDefaultPipeline(options.optimizerOptLevel);
+    if (options.linkTimeOptimization &&
+        options.optimizerOptLevel != llvm::OptimizationLevel::O0) {
+      // The module already contains everything that ends up in the binary so
+      // run both halves of a full LTO build on it.
+      modulePassManager =
+          passBuilder.buildLTOPreLinkDefaultPipeline(options.optimizerOptLevel);
+      modulePassManager.addPass(passBuilder.buildLTODefaultPipeline(
+          options.optimizerOptLevel, /*ExportSummary=*/nullptr));
+    } else {
+      modulePassManager =
+          passBuilder.buildPerModuleDefaultPipeline(options.optimizerOptLevel);
+    }
     modulePassManager.run(*module, moduleAnalysisManager);
   }
 
@@ -128,6 +145,47 @@ LogicalResult runEmitObjFilePasses(llvm::TargetMachine *machine,
   return success();
 }
 
+LogicalResult runEmitObjFilePassesInParallel(
+    const LLVMTarget &target, const LLVMTargetOptions &options,
+    llvm::Module *module, unsigned partitionCount,
+    llvm::SmallVectorImpl<std::string> &objData) {
+  // Partitions are formed from whole functions so there's no use in having more
+  // partitions than functions.
+  unsigned functionCount =
+      llvm::count_if(*module, [](const llvm::Function &func) {
+        return !func.isDeclaration();
+      });
+  partitionCount = std::max(1u, std::min(partitionCount, functionCount));
+  if (partitionCount == 1) {
+    auto machine = createTargetMachine(target, options);
+    if (!machine) return failure();
+    objData.resize(1);
+    return runEmitObjFilePasses(machine.get(), module, llvm::CGFT_ObjectFile,
+                                &objData.front());
+  }
+
+  llvm::SmallVector<llvm::SmallVector<char, 0>> buffers(partitionCount);
+  llvm::SmallVector<std::unique_ptr<llvm::raw_svector_ostream>> streams;
+  llvm::SmallVector<llvm::raw_pwrite_stream *> streamPtrs;
+  for (auto &buffer : buffers) {
+    streams.push_back(std::make_unique<llvm::raw_svector_ostream>(buffer));
+    streamPtrs.push_back(streams.back().get());
+  }
+  // The target machine has already been created once for this target by the
+  // caller so creation is not expected to fail here.
+  llvm::splitCodeGen(
+      *module, streamPtrs, /*BCOSs=*/{},
+      [&]() { return createTargetMachine(target, options); },
+      llvm::CGFT_ObjectFile);
+  streams.clear();
+
+  objData.clear();
+  for (auto &buffer : buffers) {
+    objData.emplace_back(buffer.begin(), buffer.end());
+  }
+  return success();
+}
+
 }  // namespace HAL
 }  // namespace IREE
 }  // namespace iree_compiler
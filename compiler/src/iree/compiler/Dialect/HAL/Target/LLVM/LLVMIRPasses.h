@@ -8,8 +8,10 @@
 #define IREE_COMPILER_DIALECT_HAL_TARGET_LLVM_LLVMIRPASSES_H_
 
 #include <memory>
+#include <string>
 
 #include "iree/compiler/Dialect/HAL/Target/LLVM/LLVMTargetOptions.h"
+#include "llvm/ADT/SmallVector.h"
 #include "llvm/IR/Module.h"
 #include "llvm/Target/TargetMachine.h"
 #include "mlir/Support/LogicalResult.h"
@@ -34,6 +36,17 @@ LogicalResult runEmitObjFilePasses(llvm::TargetMachine *machine,
                                    llvm::CodeGenFileType fileType,
                                    std::string *objData);
 
+// Emits object files for |module| split into up to |partitionCount| partitions
+// that are code generated in parallel, each with its own target machine for
+// |target|. Internal symbols referenced across partitions are promoted to
+// hidden external symbols so the objects can be linked back together. A single
+// object is emitted (on the calling thread) if |partitionCount| is <= 1 or the
+// module has too few functions to split.
+LogicalResult runEmitObjFilePassesInParallel(
+    const LLVMTarget &target, const LLVMTargetOptions &options,
+    llvm::Module *module, unsigned partitionCount,
+    llvm::SmallVectorImpl<std::string> &objData);
+
 }  // namespace HAL
 }  // namespace IREE
 }  // namespace iree_compiler
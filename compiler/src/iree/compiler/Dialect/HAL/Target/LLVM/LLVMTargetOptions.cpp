@@ -100,6 +100,22 @@ LLVMTargetOptions getLLVMTargetOptionsFromFlags() {
     targetOptions.target.cpuFeatures = clTargetCPUFeatures;
   }
 
+  static llvm::cl::list<std::string> clTargetCPUVariants(
+      "iree-llvm-target-cpu-variant",
+      llvm::cl::desc("Additional LLVM target machine CPU and optional CPU "
+                     "features, as `cpu[:features]`, to compile executables "
+                     "for; the runtime picks the first one the processor "
+                     "supports and falls back to the default target"),
+      llvm::cl::ZeroOrMore);
+  for (auto &variant : clTargetCPUVariants) {
+    auto [cpu, cpuFeatures] = llvm::StringRef(variant).split(':');
+    LLVMTarget target;
+    target.triple = targetOptions.target.triple;
+    target.cpu = cpu.str();
+    target.cpuFeatures = cpuFeatures.str();
+    targetOptions.targetVariants.push_back(std::move(target));
+  }
+
   // LLVM opt options.
   targetOptions.pipelineTuningOptions.LoopInterleaving = llvmLoopInterleaving;
   targetOptions.pipelineTuningOptions.LoopVectorization = llvmLoopVectorization;
@@ -115,6 +131,41 @@ LLVMTargetOptions getLLVMTargetOptionsFromFlags() {
                                   "Thread sanitizer support")));
   targetOptions.sanitizerKind = clSanitizerKind;
 
+  static llvm::cl::opt<bool> clLinkTimeOptimization(
+      "iree-llvm-link-time-optimization",
+      llvm::cl::desc("Optimize each executable as a whole with the LLVM LTO "
+                     "pipeline after linking in builtin bitcode, allowing "
+                     "helpers to be inlined, deduplicated or dropped across "
+                     "dispatch functions"),
+      llvm::cl::init(targetOptions.linkTimeOptimization));
+  targetOptions.linkTimeOptimization = clLinkTimeOptimization;
+
+  static llvm::cl::opt<bool> clWorkgroupRangeDispatch(
+      "iree-llvm-workgroup-range-dispatch",
+      llvm::cl::desc("Exports dispatch functions that process a range of "
+                     "workgroups per call, amortizing the runtime call "
+                     "overhead across dispatches with many small workgroups"),
+      llvm::cl::init(targetOptions.workgroupRangeDispatch));
+  targetOptions.workgroupRangeDispatch = clWorkgroupRangeDispatch;
+
+  static llvm::cl::opt<std::string> clDenormalFpMath(
+      "iree-llvm-denormal-fp-math",
+      llvm::cl::desc("Denormal floating-point mode executables are compiled "
+                     "for (ieee, preserve-sign, positive-zero or an "
+                     "'<output>,<input>' pair of those). Defaults to flushing "
+                     "denormals to zero as configured by the runtime"),
+      llvm::cl::init(targetOptions.denormalFpMath));
+  targetOptions.denormalFpMath = clDenormalFpMath;
+
+  static llvm::cl::opt<unsigned> clCodegenPartitions(
+      "iree-llvm-codegen-partitions",
+      llvm::cl::desc("Splits each executable into up to this many partitions "
+                     "that are code generated in parallel; the output only "
+                     "depends on the partition count and not on the machine "
+                     "compiling it"),
+      llvm::cl::init(targetOptions.codegenPartitions));
+  targetOptions.codegenPartitions = clCodegenPartitions;
+
   static llvm::cl::opt<std::string> clTargetABI(
       "iree-llvm-target-abi",
       llvm::cl::desc("LLVM target machine ABI; specify for -mabi"),
@@ -161,6 +212,14 @@ LLVMTargetOptions getLLVMTargetOptionsFromFlags() {
       llvm::cl::init(""));
   targetOptions.wasmLinkerPath = clWasmLinkerPath;
 
+  static llvm::cl::opt<bool> clWasmSharedMemory(
+      "iree-llvm-wasm-shared-memory",
+      llvm::cl::desc("Links WebAssembly modules against imported shared memory "
+                     "for use with multithreaded runtimes. Requires "
+                     "--iree-llvm-target-cpu-features=+atomics,+bulk-memory."),
+      llvm::cl::init(targetOptions.wasmSharedMemory));
+  targetOptions.wasmSharedMemory = clWasmSharedMemory;
+
   static llvm::cl::opt<bool> clLinkEmbedded(
       "iree-llvm-link-embedded",
       llvm::cl::desc("Links binaries into a platform-agnostic ELF to be loaded "
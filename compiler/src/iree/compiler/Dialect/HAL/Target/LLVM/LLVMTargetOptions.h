@@ -7,6 +7,9 @@
 #ifndef IREE_COMPILER_DIALECT_HAL_TARGET_LLVM_LLVMTARGETOPTIONS_H_
 #define IREE_COMPILER_DIALECT_HAL_TARGET_LLVM_LLVMTARGETOPTIONS_H_
 
+#include <string>
+#include <vector>
+
 #include "llvm/Passes/PassBuilder.h"
 #include "llvm/Target/TargetOptions.h"
 
@@ -33,6 +36,13 @@ struct LLVMTargetOptions {
   // Default target machine configuration.
   LLVMTarget target;
 
+  // Additional configurations of the default target triple, usually newer CPU
+  // generations, that every executable is compiled for as well. At runtime the
+  // first variant whose CPU features are all available is used and the default
+  // target is the fallback, so variants should be listed from most to least
+  // specialized.
+  std::vector<LLVMTarget> targetVariants;
+
   llvm::PipelineTuningOptions pipelineTuningOptions;
   // Optimization level to be used by the LLVM optimizer (middle-end).
   llvm::OptimizationLevel optimizerOptLevel;
@@ -49,6 +59,31 @@ struct LLVMTargetOptions {
   // Sanitizer Kind for CPU Kernels
   SanitizerKind sanitizerKind = SanitizerKind::kNone;
 
+  // Optimize the whole executable, including the linked builtin bitcode, the
+  // way a full LTO link would instead of only per module. All symbols but the
+  // library query function are internalized before optimization so unused
+  // builtins can be dropped and identical functions merged.
+  bool linkTimeOptimization = false;
+
+  // Export dispatch functions that process a contiguous range of workgroups
+  // per call (IREE_HAL_EXECUTABLE_DISPATCH_FLAG_WORKGROUP_RANGE). Reduces the
+  // per-workgroup call overhead of dispatches with many small workgroups.
+  bool workgroupRangeDispatch = false;
+
+  // Denormal floating-point mode dispatches are compiled for, in the LLVM
+  // "denormal-fp-math" attribute syntax ("ieee", "preserve-sign",
+  // "positive-zero", optionally as an "<output>,<input>" pair). Empty keeps
+  // the default where the runtime flushes denormals to zero. Modes that
+  // preserve denormals are recorded on the dispatches so that the runtime
+  // does not flush them.
+  std::string denormalFpMath;
+
+  // Number of partitions the functions of each executable are split into for
+  // LLVM code generation. Partitions are code generated in parallel and linked
+  // together from separate object files. Ignored when producing static
+  // libraries as they may only contain a single object file.
+  unsigned codegenPartitions = 1;
+
   // Tool to use for native platform linking (like ld on Unix or link.exe on
   // Windows). Acts as a prefix to the command line and can contain additional
   // arguments.
@@ -60,6 +95,11 @@ struct LLVMTargetOptions {
   // Tool to use for linking WebAssembly modules. Must be wasm-ld or lld.
   std::string wasmLinkerPath;
 
+  // Import the memory of WebAssembly modules as shared memory so they can be
+  // loaded by multithreaded (pthreads + SharedArrayBuffer) runtimes. Requires
+  // the +atomics and +bulk-memory CPU features.
+  bool wasmSharedMemory = false;
+
   // Build for the IREE embedded platform-agnostic ELF loader.
   // Note: this is ignored for target machines that do not support the ELF
   // loader, such as WebAssembly.
@@ -124,6 +124,22 @@ static llvm::StructType *makeDispatchAttrsType(llvm::LLVMContext &context) {
   return type;
 }
 
+// Returns the iree_hal_executable_dispatch_flags_v0_t bits for |attrs|.
+static uint16_t getDispatchFlags(const LibraryBuilder::DispatchAttrs &attrs) {
+  using DispatchFlags = LibraryBuilder::DispatchFlags;
+  uint16_t flags = static_cast<uint16_t>(DispatchFlags::NONE);
+  if (attrs.workgroupRange) {
+    flags |= static_cast<uint16_t>(DispatchFlags::WORKGROUP_RANGE);
+  }
+  if (attrs.preserveDenormalResults) {
+    flags |= static_cast<uint16_t>(DispatchFlags::PRESERVE_DENORMAL_RESULTS);
+  }
+  if (attrs.preserveDenormalInputs) {
+    flags |= static_cast<uint16_t>(DispatchFlags::PRESERVE_DENORMAL_INPUTS);
+  }
+  return flags;
+}
+
 // %struct.iree_hal_executable_src_loc_v0_t = type {
 //   i32,
 //   i32,
@@ -315,6 +331,96 @@ llvm::Function *LibraryBuilder::build(StringRef queryFuncName) {
   return func;
 }
 
+llvm::Function *LibraryBuilder::buildWorkgroupRangeWrapper(
+    llvm::Function *func) {
+  auto &context = module->getContext();
+  auto *dispatchStateType = makeDispatchStateType(context);
+  auto *workgroupStateType = makeWorkgroupStateType(context);
+  auto *i16Type = llvm::IntegerType::getInt16Ty(context);
+  auto *i32Type = llvm::IntegerType::getInt32Ty(context);
+  llvm::Constant *zero = llvm::ConstantInt::get(i32Type, 0);
+  llvm::Constant *one = llvm::ConstantInt::get(i32Type, 1);
+
+  // The wrapper takes the attributes (parameter annotations and target
+  // features) of the function it wraps so that the function can be inlined.
+  auto *wrapperFunc = llvm::Function::Create(
+      func->getFunctionType(), llvm::GlobalValue::InternalLinkage,
+      func->getName() + "_range", *module);
+  wrapperFunc->setAttributes(func->getAttributes());
+  wrapperFunc->setDSOLocal(true);
+  func->addFnAttr(llvm::Attribute::AlwaysInline);
+  llvm::Value *environment = wrapperFunc->getArg(0);
+  llvm::Value *dispatchState = wrapperFunc->getArg(1);
+  llvm::Value *workgroupState = wrapperFunc->getArg(2);
+
+  auto *entryBlock = llvm::BasicBlock::Create(context, "entry", wrapperFunc);
+  auto *loopBlock = llvm::BasicBlock::Create(context, "loop", wrapperFunc);
+  auto *nextBlock = llvm::BasicBlock::Create(context, "next", wrapperFunc);
+  auto *exitBlock = llvm::BasicBlock::Create(context, "exit", wrapperFunc);
+  llvm::IRBuilder<> builder(entryBlock);
+
+  // Local copy of the workgroup state that is advanced each iteration.
+  auto *localState = builder.CreateAlloca(workgroupStateType);
+  localState->setAlignment(llvm::Align(16));
+  builder.CreateMemCpy(localState, llvm::Align(16), workgroupState,
+                       llvm::Align(16),
+                       llvm::ConstantExpr::getSizeOf(workgroupStateType));
+  // uint32_t workgroup_range_count
+  auto *rangeCount = builder.CreateLoad(
+      i32Type, builder.CreateStructGEP(workgroupStateType, workgroupState, 7));
+  // uint32_t workgroup_count_x / workgroup_count_y
+  auto *workgroupCountX = builder.CreateLoad(
+      i32Type, builder.CreateStructGEP(dispatchStateType, dispatchState, 4));
+  auto *workgroupCountY = builder.CreateLoad(
+      i32Type, builder.CreateStructGEP(dispatchStateType, dispatchState, 5));
+  // uint32_t workgroup_id_x / workgroup_id_y, uint16_t workgroup_id_z
+  auto *workgroupIdXPtr =
+      builder.CreateStructGEP(workgroupStateType, localState, 0);
+  auto *workgroupIdYPtr =
+      builder.CreateStructGEP(workgroupStateType, localState, 1);
+  auto *workgroupIdZPtr =
+      builder.CreateStructGEP(workgroupStateType, localState, 2);
+  builder.CreateBr(loopBlock);
+
+  // Call the function for the current workgroup and stop on failure.
+  builder.SetInsertPoint(loopBlock);
+  auto *index = builder.CreatePHI(i32Type, 2);
+  index->addIncoming(zero, entryBlock);
+  auto *result =
+      builder.CreateCall(func, {environment, dispatchState, localState});
+  builder.CreateCondBr(builder.CreateICmpNE(result, zero), exitBlock,
+                       nextBlock);
+
+  // Advance to the next workgroup with x varying fastest. The loop is
+  // rotated so that a range count of 0 processes a single workgroup.
+  builder.SetInsertPoint(nextBlock);
+  auto *nextX =
+      builder.CreateAdd(builder.CreateLoad(i32Type, workgroupIdXPtr), one);
+  auto *wrapX = builder.CreateICmpEQ(nextX, workgroupCountX);
+  builder.CreateStore(builder.CreateSelect(wrapX, zero, nextX),
+                      workgroupIdXPtr);
+  auto *nextY = builder.CreateAdd(builder.CreateLoad(i32Type, workgroupIdYPtr),
+                                  builder.CreateZExt(wrapX, i32Type));
+  auto *wrapY = builder.CreateICmpEQ(nextY, workgroupCountY);
+  builder.CreateStore(builder.CreateSelect(wrapY, zero, nextY),
+                      workgroupIdYPtr);
+  auto *nextZ = builder.CreateAdd(builder.CreateLoad(i16Type, workgroupIdZPtr),
+                                  builder.CreateZExt(wrapY, i16Type));
+  builder.CreateStore(nextZ, workgroupIdZPtr);
+  auto *nextIndex = builder.CreateAdd(index, one);
+  index->addIncoming(nextIndex, nextBlock);
+  builder.CreateCondBr(builder.CreateICmpULT(nextIndex, rangeCount), loopBlock,
+                       exitBlock);
+
+  builder.SetInsertPoint(exitBlock);
+  auto *exitResult = builder.CreatePHI(i32Type, 2);
+  exitResult->addIncoming(result, loopBlock);
+  exitResult->addIncoming(zero, nextBlock);
+  builder.CreateRet(exitResult);
+
+  return wrapperFunc;
+}
+
 llvm::Constant *LibraryBuilder::buildLibraryV0ImportTable(
     std::string libraryName) {
   auto &context = module->getContext();
@@ -389,7 +495,7 @@ llvm::Constant *LibraryBuilder::buildLibraryV0ExportTable(
       llvm::find_if(exports, [](const Dispatch &dispatch) {
         return !dispatch.attrs.isDefault();
       }) != exports.end();
-  if (!hasNonDefaultAttrs) {
+  if (hasNonDefaultAttrs) {
     SmallVector<llvm::Constant *, 4> exportAttrValues;
     for (auto dispatch : exports) {
       exportAttrValues.push_back(llvm::ConstantStruct::get(
@@ -400,8 +506,8 @@ llvm::Constant *LibraryBuilder::buildLibraryV0ExportTable(
                   i16Type, RoundUpToAlignment(dispatch.attrs.localMemorySize,
                                               kWorkgroupLocalMemoryPageSize) /
                                kWorkgroupLocalMemoryPageSize),
-              // reserved=
-              llvm::ConstantInt::get(i16Type, 0),
+              // flags=
+              llvm::ConstantInt::get(i16Type, getDispatchFlags(dispatch.attrs)),
           }));
     }
     auto *exportAttrsType =
@@ -78,13 +78,38 @@ class LibraryBuilder {
   // IREE_HAL_WORKGROUP_LOCAL_MEMORY_PAGE_SIZE
   static const int64_t kWorkgroupLocalMemoryPageSize = 4096;
 
+  // iree_hal_executable_dispatch_flags_v0_t
+  enum class DispatchFlags : uint16_t {
+    // IREE_HAL_EXECUTABLE_DISPATCH_FLAG_NONE
+    NONE = 0u,
+    // IREE_HAL_EXECUTABLE_DISPATCH_FLAG_WORKGROUP_RANGE
+    WORKGROUP_RANGE = 1u << 0,
+    // IREE_HAL_EXECUTABLE_DISPATCH_FLAG_PRESERVE_DENORMAL_RESULTS
+    PRESERVE_DENORMAL_RESULTS = 1u << 1,
+    // IREE_HAL_EXECUTABLE_DISPATCH_FLAG_PRESERVE_DENORMAL_INPUTS
+    PRESERVE_DENORMAL_INPUTS = 1u << 2,
+  };
+
   // iree_hal_executable_dispatch_attrs_v0_t
   struct DispatchAttrs {
     // Required workgroup local memory size, in bytes.
     int64_t localMemorySize = 0;
 
+    // True to export a wrapper that processes a range of workgroups per call.
+    // See addExport for details.
+    bool workgroupRange = false;
+
+    // True if the dispatch was compiled assuming IEEE denormal handling and
+    // the runtime must not flush denormal results/inputs to zero. By default
+    // the runtime flushes both as that is what codegen assumes.
+    bool preserveDenormalResults = false;
+    bool preserveDenormalInputs = false;
+
     // True if all values are default and the attributes may be omitted.
-    constexpr bool isDefault() const { return localMemorySize == 0; }
+    constexpr bool isDefault() const {
+      return localMemorySize == 0 && !workgroupRange &&
+             !preserveDenormalResults && !preserveDenormalInputs;
+    }
   };
 
   LibraryBuilder(llvm::Module *module, Mode mode,
@@ -114,8 +139,14 @@ class LibraryBuilder {
   // |name| will be used as the library export
   // |sourceFile| and |sourceLoc| are optional source information
   // |tag| is an optional attachment
+  //
+  // If |attrs| requests a workgroup range the export is a wrapper around
+  // |func| that calls it for each workgroup in the range provided by the
+  // runtime. |func| is marked always-inline so the per-workgroup call reduces
+  // to a loop within the wrapper.
   void addExport(StringRef name, StringRef sourceFile, uint32_t sourceLoc,
                  StringRef tag, DispatchAttrs attrs, llvm::Function *func) {
+    if (attrs.workgroupRange) func = buildWorkgroupRangeWrapper(func);
     exports.push_back(
         {name.str(), sourceFile.str(), sourceLoc, tag.str(), attrs, func});
   }
@@ -137,6 +168,11 @@ class LibraryBuilder {
   llvm::Constant *buildLibraryV0ExportTable(std::string libraryName);
   llvm::Constant *buildLibraryV0ConstantTable(std::string libraryName);
 
+  // Builds a dispatch function processing
+  // iree_hal_executable_workgroup_state_v0_t::workgroup_range_count workgroups
+  // by calling |func| once per workgroup.
+  llvm::Function *buildWorkgroupRangeWrapper(llvm::Function *func);
+
   llvm::Module *module = nullptr;
   Mode mode = Mode::INCLUDE_REFLECTION_ATTRS;
   Version version = Version::LATEST;
@@ -30,6 +30,7 @@ static void generatePrefix(llvm::raw_ostream &os,
      << "//  - At runtime: retrieve library name from host binary \n"
      << "//  - Query library from " << query_function_name << "()<< \n"
      << "//  - Feed library into static_library_loader \n"
+     << "//    (or register it lazily with the _REGISTRATION initializer)\n"
      << "//\n"
      << "// === Automatically generated file. DO NOT EDIT! === \n\n";
 
@@ -58,6 +59,18 @@ static void generateQueryFunction(llvm::raw_ostream &os,
         "iree_hal_executable_environment_v0_t* environment);\n";
 }
 
+static void generateRegistration(llvm::raw_ostream &os,
+                                 const std::string &library_name,
+                                 const std::string &query_function_name) {
+  // Initializer for iree_hal_static_library_registration_t used to register
+  // the library with iree_hal_static_library_loader_create_lazy. Only
+  // libraries referenced by a registration table are linked into the program.
+  llvm::StringRef ref(library_name);
+  os << "\n// Registration for iree_hal_static_library_loader_create_lazy.\n"
+     << "#define IREE_STATIC_LIBRARY_" << ref.upper() << "_REGISTRATION \\\n"
+     << "  {\"" << library_name << "\", " << query_function_name << "}\n";
+}
+
 static void generateSuffix(llvm::raw_ostream &os,
                            const std::string &library_name,
                            const std::string &query_function_name) {
@@ -80,6 +93,7 @@ static bool generateExecutableLibraryHeader(
 
   generatePrefix(os, library_name, query_function_name);
   generateQueryFunction(os, library_name, query_function_name);
+  generateRegistration(os, library_name, query_function_name);
   generateSuffix(os, library_name, query_function_name);
 
   os.close();
@@ -106,17 +106,21 @@ class WasmLinkerTool : public LinkerTool {
         "--experimental-pic",
         "--shared",
 
-        // Import [shared] memory from the environment.
-        // https://developer.mozilla.org/en-US/docs/Web/JavaScript/Reference/Global_Objects/WebAssembly/Memory#creating_a_shared_memory
-        // TODO(scotttodd): Add a flag controlling these - some combination is
-        //   required when using multithreading + SharedArrayBuffer, but they
-        //   must be left off when running single threaded.
-        // "--import-memory",
-        // "--shared-memory",
-
         "-o " + artifacts.libraryFile.path,
     };
 
+    // Import shared memory from the environment when the hosting runtime is
+    // multithreaded (pthreads + SharedArrayBuffer). The memory of single
+    // threaded runtimes is not shared and would fail to link against these.
+    // https://developer.mozilla.org/en-US/docs/Web/JavaScript/Reference/Global_Objects/WebAssembly/Memory#creating_a_shared_memory
+    if (targetOptions.wasmSharedMemory) {
+      flags.push_back("--import-memory");
+      flags.push_back("--shared-memory");
+      // Shared memories must declare a maximum size; the imported memory may
+      // be anything up to the full 32-bit address space.
+      flags.push_back("--max-memory=4294967296");
+    }
+
     // Strip debug information when not requested.
     if (!targetOptions.debugSymbols) {
       flags.push_back("--strip-debug");
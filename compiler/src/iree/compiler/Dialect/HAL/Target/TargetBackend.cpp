@@ -61,6 +61,22 @@ void TargetOptions::bindOptions(OptionsBinder &binder) {
       llvm::cl::desc(
           "Path to write translated and serialized executable binaries into."),
       llvm::cl::cat(halTargetOptionsCategory));
+
+  binder.opt<std::string>(
+      "iree-hal-executable-cache-dir", executableCachePath,
+      llvm::cl::desc(
+          "Path to a persistent cache of translated and serialized "
+          "executables used to skip codegen of unchanged executables across "
+          "compilations."),
+      llvm::cl::cat(halTargetOptionsCategory));
+
+  binder.opt<std::string>(
+      "iree-hal-executable-cache-key", executableCacheKey,
+      llvm::cl::desc(
+          "Opaque key mixed into all executable cache entries. Must change "
+          "whenever compiler flags not reported by target backends (such as "
+          "codegen flags) or the compiler itself change."),
+      llvm::cl::cat(halTargetOptionsCategory));
 }
 
 void dumpDataToPath(StringRef path, StringRef baseName, StringRef suffix,
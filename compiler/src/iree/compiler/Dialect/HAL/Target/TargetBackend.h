@@ -17,6 +17,7 @@
 #include "iree/compiler/Utils/OptionUtils.h"
 #include "llvm/ADT/StringMap.h"
 #include "llvm/ADT/StringRef.h"
+#include "llvm/Support/raw_ostream.h"
 #include "mlir/IR/Dialect.h"
 #include "mlir/Pass/PassManager.h"
 
@@ -52,6 +53,13 @@ struct TargetOptions {
   // A path to write translated and serialized executable binaries into.
   std::string executableBinariesPath;
 
+  // A path to a persistent cache of translated and serialized executables
+  // shared across compilations. Disabled when empty.
+  std::string executableCachePath;
+
+  // Opaque string mixed into the keys of all executable cache entries.
+  std::string executableCacheKey;
+
   void bindOptions(OptionsBinder &binder);
   using FromFlags = OptionsFromFlags<TargetOptions>;
 };
@@ -131,6 +139,13 @@ class TargetBackend {
   // Types, Attributes).
   virtual void getDependentDialects(DialectRegistry &registry) const {}
 
+  // Appends all backend options that affect the translation and serialization
+  // of executables beyond their IR to |os|. Used to key persistent executable
+  // caches such that changing an option invalidates prior results.
+  // Returns false if executables must not be cached, such as when
+  // serialization has side effects beyond producing the binary ops.
+  virtual bool appendCacheKey(llvm::raw_ostream &os) const { return true; }
+
   // Returns the default device this backend targets.
   virtual IREE::HAL::DeviceTargetAttr getDefaultDeviceTarget(
       MLIRContext *context) const = 0;
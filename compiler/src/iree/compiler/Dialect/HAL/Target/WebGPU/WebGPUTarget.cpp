@@ -35,22 +35,56 @@ WebGPUTargetOptions getWebGPUTargetOptionsFromFlags() {
       llvm::cl::desc(
           "Include debug information like variable names in outputs"),
       llvm::cl::init(true));
+  static llvm::cl::opt<bool> clEnableShaderF16(
+      "iree-webgpu-enable-shader-f16",
+      llvm::cl::desc("Allow f16 arithmetic and storage in the generated "
+                     "shaders; the device must support 'shader-f16'"),
+      llvm::cl::init(false));
+  static llvm::cl::opt<int> clSubgroupSize(
+      "iree-webgpu-subgroup-size",
+      llvm::cl::desc("Subgroup size of the device to use subgroup operations "
+                     "with; 0 disables subgroup operations"),
+      llvm::cl::init(0));
 
   WebGPUTargetOptions targetOptions;
   targetOptions.debugSymbols = clDebugSymbols;
+  targetOptions.enableShaderF16 = clEnableShaderF16;
+  targetOptions.subgroupSize = clSubgroupSize;
 
   return targetOptions;
 }
 
 // TODO(scotttodd): provide a proper target environment for WebGPU.
-static spirv::TargetEnvAttr getWebGPUTargetEnv(MLIRContext *context) {
+static spirv::TargetEnvAttr getWebGPUTargetEnv(
+    MLIRContext *context, const WebGPUTargetOptions &options) {
   // TODO(scotttodd): find list of SPIR-V extensions supported by WebGPU/WGSL
-  auto triple = spirv::VerCapExtAttr::get(
-      spirv::Version::V_1_0, {spirv::Capability::Shader},
-      {spirv::Extension::SPV_KHR_storage_buffer_storage_class}, context);
+  SmallVector<spirv::Capability, 8> capabilities = {spirv::Capability::Shader};
+  SmallVector<spirv::Extension, 2> extensions = {
+      spirv::Extension::SPV_KHR_storage_buffer_storage_class};
+  if (options.enableShaderF16) {
+    capabilities.push_back(spirv::Capability::Float16);
+    capabilities.push_back(spirv::Capability::StorageBuffer16BitAccess);
+    extensions.push_back(spirv::Extension::SPV_KHR_16bit_storage);
+  }
+  if (options.subgroupSize > 0) {
+    capabilities.push_back(spirv::Capability::GroupNonUniform);
+    capabilities.push_back(spirv::Capability::GroupNonUniformArithmetic);
+    capabilities.push_back(spirv::Capability::GroupNonUniformShuffle);
+  }
+  auto triple = spirv::VerCapExtAttr::get(spirv::Version::V_1_0, capabilities,
+                                          extensions, context);
+
+  // The default limits of the WebGPU spec every adapter must support.
+  Builder builder(context);
+  auto limits = spirv::ResourceLimitsAttr::get(
+      context, /*max_compute_shared_memory_size=*/16384,
+      /*max_compute_workgroup_invocations=*/256,
+      builder.getI64ArrayAttr({256, 256, 64}),
+      /*subgroup_size=*/options.subgroupSize > 0 ? options.subgroupSize : 32,
+      /*min_subgroup_size=*/std::nullopt, /*max_subgroup_size=*/std::nullopt,
+      /*cooperative_matrix_properties_nv=*/ArrayAttr::get(context, {}));
   return spirv::TargetEnvAttr::get(
-      triple, spirv::getDefaultResourceLimits(context),
-      spirv::ClientAPI::WebGPU, spirv::Vendor::Unknown,
+      triple, limits, spirv::ClientAPI::WebGPU, spirv::Vendor::Unknown,
       spirv::DeviceType::Unknown, spirv::TargetEnvAttr::kUnknownDeviceID);
 }
 
@@ -235,7 +269,7 @@ class WebGPUTargetBackend : public TargetBackend {
     // If we had multiple target environments we would generate one target attr
     // per environment, with each setting its own environment attribute.
     targetAttrs.push_back(
-        getExecutableTarget(context, getWebGPUTargetEnv(context)));
+        getExecutableTarget(context, getWebGPUTargetEnv(context, options_)));
     return ArrayAttr::get(context, targetAttrs);
   }
 
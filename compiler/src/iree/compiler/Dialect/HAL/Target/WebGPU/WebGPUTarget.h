@@ -19,6 +19,14 @@ namespace HAL {
 struct WebGPUTargetOptions {
   // Include debug information like variable names in outputs.
   bool debugSymbols = true;
+
+  // Allow 16-bit float arithmetic and storage. Requires the `shader-f16`
+  // feature to be enabled on the device.
+  bool enableShaderF16 = false;
+
+  // Subgroup size to target with subgroup operations. 0 means subgroup
+  // operations are not available to the generated shaders.
+  int subgroupSize = 0;
 };
 
 // Returns a WebGPUTargetOptions struct initialized with WebGPU/WGSL related
@@ -0,0 +1,136 @@
+// Copyright 2023 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include <algorithm>
+#include <memory>
+#include <utility>
+
+#include "iree/compiler/Dialect/Flow/IR/FlowOps.h"
+#include "iree/compiler/Dialect/HAL/IR/HALDialect.h"
+#include "iree/compiler/Dialect/HAL/IR/HALTypes.h"
+#include "iree/compiler/Dialect/HAL/Transforms/Passes.h"
+#include "iree/compiler/Dialect/Stream/IR/StreamTypes.h"
+#include "iree/compiler/Dialect/Util/IR/UtilTypes.h"
+#include "llvm/ADT/STLExtras.h"
+#include "mlir/Dialect/Func/IR/FuncOps.h"
+#include "mlir/IR/Attributes.h"
+#include "mlir/IR/BuiltinTypes.h"
+#include "mlir/Pass/Pass.h"
+
+namespace mlir {
+namespace iree_compiler {
+namespace IREE {
+namespace HAL {
+
+// Returns an estimate of the cost of |dispatchOp| as the number of bytes of
+// tensor operands and results it touches. Weights dominate large models and
+// are captured as operands so this roughly balances both memory and compute.
+// Dynamic dimensions are treated as 1 as their sizes are unknown.
+static int64_t estimateDispatchCost(IREE::Flow::DispatchOp dispatchOp) {
+  int64_t cost = 0;
+  auto addValue = [&](Value value) {
+    auto shapedType = value.getType().dyn_cast<ShapedType>();
+    if (!shapedType || !shapedType.hasRank()) return;
+    int64_t elementCount = 1;
+    for (int64_t dim : shapedType.getShape()) {
+      if (!ShapedType::isDynamic(dim)) elementCount *= dim;
+    }
+    cost += elementCount * IREE::Util::getRoundedElementByteWidth(
+                               shapedType.getElementType());
+  };
+  llvm::for_each(dispatchOp.getArguments(), addValue);
+  llvm::for_each(dispatchOp.getResults(), addValue);
+  return std::max<int64_t>(cost, 1);
+}
+
+class AssignPipelineStagesPass
+    : public PassWrapper<AssignPipelineStagesPass, OperationPass<ModuleOp>> {
+ public:
+  AssignPipelineStagesPass() = default;
+  AssignPipelineStagesPass(const AssignPipelineStagesPass &pass) {}
+  AssignPipelineStagesPass(int64_t stageCount) {
+    this->stageCount = stageCount;
+  }
+
+  void getDependentDialects(DialectRegistry &registry) const override {
+    registry.insert<IREE::HAL::HALDialect>();
+  }
+
+  StringRef getArgument() const override {
+    return "iree-hal-assign-pipeline-stages";
+  }
+
+  StringRef getDescription() const override {
+    return "Partitions the dispatches of each function into pipeline stages "
+           "that execute on distinct device queues.";
+  }
+
+  void runOnOperation() override {
+    if (stageCount > 64) {
+      getOperation().emitError()
+          << "at most 64 pipeline stages are supported by queue affinities";
+      return signalPassFailure();
+    }
+    if (stageCount <= 1) return;
+    for (auto funcOp : getOperation().getOps<func::FuncOp>()) {
+      assignStages(funcOp);
+    }
+  }
+
+ private:
+  // Splits the dispatches of |funcOp| in program order into contiguous stages
+  // of roughly equal cost. Each stage is assigned to its own queue so that
+  // latter stages of one invocation overlap with earlier stages of the next.
+  // Stages exchange results through timepoints that lower to fences and the
+  // queues wait on each other's semaphores.
+  void assignStages(func::FuncOp funcOp) {
+    SmallVector<std::pair<IREE::Flow::DispatchOp, int64_t>> dispatches;
+    int64_t totalCost = 0;
+    funcOp.walk([&](IREE::Flow::DispatchOp dispatchOp) {
+      // Preserve affinities specified by users or frontends.
+      if (IREE::Stream::AffinityAttr::lookup(dispatchOp)) return;
+      int64_t cost = estimateDispatchCost(dispatchOp);
+      dispatches.emplace_back(dispatchOp, cost);
+      totalCost += cost;
+    });
+    if (dispatches.empty()) return;
+
+    // Assign each dispatch to the stage containing the midpoint of its cost
+    // so that large dispatches land in the stage they mostly occupy.
+    auto affinityName =
+        StringAttr::get(funcOp.getContext(), "stream.affinity");
+    double runningCost = 0.0;
+    for (auto [dispatchOp, cost] : dispatches) {
+      double midpoint = runningCost + cost / 2.0;
+      runningCost += cost;
+      int64_t stage = std::min<int64_t>(
+          stageCount - 1, (int64_t)(midpoint * stageCount / totalCost));
+      dispatchOp->setAttr(
+          affinityName, IREE::HAL::AffinityQueueAttr::get(
+                            funcOp.getContext(), /*mask=*/1ull << stage));
+    }
+  }
+
+  Option<int64_t> stageCount{
+      *this, "stage-count",
+      llvm::cl::desc("Number of pipeline stages (and device queues) to "
+                     "partition dispatches across."),
+      llvm::cl::init(1)};
+};
+
+std::unique_ptr<OperationPass<ModuleOp>> createAssignPipelineStagesPass(
+    int64_t stageCount) {
+  return std::make_unique<AssignPipelineStagesPass>(stageCount);
+}
+
+static PassRegistration<AssignPipelineStagesPass> pass([] {
+  return std::make_unique<AssignPipelineStagesPass>();
+});
+
+}  // namespace HAL
+}  // namespace IREE
+}  // namespace iree_compiler
+}  // namespace mlir
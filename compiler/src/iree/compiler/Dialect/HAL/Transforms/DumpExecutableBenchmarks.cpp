@@ -5,6 +5,7 @@
 // SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
 
 #include <memory>
+#include <string>
 #include <utility>
 
 #include "iree/compiler/Dialect/HAL/IR/HALDialect.h"
@@ -198,12 +199,18 @@ static void appendDispatchBenchmark(IREE::HAL::ExecutableOp executableOp,
 
   // Mark the function as being a dispatch benchmark.
   // This tells iree-benchmark-module to pass in the arguments we need.
+  // The number of dispatch sites in the source program lets tools weight the
+  // measured time by how often the dispatch is (statically) issued.
   funcOp->setAttr("iree.abi.stub", moduleBuilder.getUnitAttr());
   funcOp->setAttr(
       "iree.reflection",
       moduleBuilder.getDictionaryAttr({
           moduleBuilder.getNamedAttr("iree.benchmark",
                                      moduleBuilder.getStringAttr("dispatch")),
+          moduleBuilder.getNamedAttr(
+              "iree.benchmark.dispatch_sites",
+              moduleBuilder.getStringAttr(
+                  std::to_string(dispatchParams.locs.size()))),
       }));
 
   // Build the function that runs the dispatches.
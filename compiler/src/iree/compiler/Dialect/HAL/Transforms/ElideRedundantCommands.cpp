@@ -10,12 +10,15 @@
 #include "iree/compiler/Dialect/HAL/IR/HALOps.h"
 #include "iree/compiler/Dialect/HAL/Transforms/Passes.h"
 #include "llvm/ADT/BitVector.h"
+#include "llvm/ADT/PostOrderIterator.h"
 #include "mlir/Dialect/Func/IR/FuncOps.h"
 #include "mlir/IR/Attributes.h"
 #include "mlir/IR/Builders.h"
 #include "mlir/IR/BuiltinTypes.h"
 #include "mlir/IR/Diagnostics.h"
 #include "mlir/IR/Matchers.h"
+#include "mlir/IR/RegionGraphTraits.h"
+#include "mlir/Interfaces/CallInterfaces.h"
 #include "mlir/Pass/Pass.h"
 
 namespace mlir {
@@ -28,23 +31,43 @@ struct DescriptorState {
   Value buffer;
   Value offset;
   Value length;
+
+  bool operator==(const DescriptorState &other) const {
+    return buffer == other.buffer && offset == other.offset &&
+           length == other.length;
+  }
 };
 
 struct DescriptorSetState {
   Value pipelineLayout;
+  // Indexed by binding ordinal.
   SmallVector<DescriptorState, 32> descriptors;
 
-  DescriptorState &getDescriptor(int64_t index) {
-    if (index >= descriptors.size()) {
-      descriptors.resize(index + 1);
+  DescriptorState &getDescriptor(int64_t ordinal) {
+    if (ordinal >= descriptors.size()) {
+      descriptors.resize(ordinal + 1);
     }
-    return descriptors[index];
+    return descriptors[ordinal];
   }
 
   void clear() {
     pipelineLayout = {};
     descriptors.clear();
   }
+
+  // Drops all state that differs from |other|.
+  void intersect(const DescriptorSetState &other) {
+    if (pipelineLayout != other.pipelineLayout) {
+      clear();
+      return;
+    }
+    for (int64_t i = 0; i < descriptors.size(); ++i) {
+      if (i >= other.descriptors.size() ||
+          !(descriptors[i] == other.descriptors[i])) {
+        descriptors[i] = {};
+      }
+    }
+  }
 };
 
 struct CommandBufferState {
@@ -69,6 +92,30 @@ struct CommandBufferState {
     return pushConstants[index];
   }
 
+  // Drops all state that differs from |other|. Used to merge the states of
+  // the predecessors of a block.
+  void intersect(const CommandBufferState &other) {
+    if (pushConstantLayout != other.pushConstantLayout) {
+      pushConstantLayout = {};
+      pushConstants.clear();
+    } else {
+      for (int64_t i = 0; i < pushConstants.size(); ++i) {
+        if (i >= other.pushConstants.size() ||
+            pushConstants[i] != other.pushConstants[i]) {
+          pushConstants[i] = {};
+        }
+      }
+    }
+    for (int64_t i = 0; i < descriptorSets.size(); ++i) {
+      if (i < other.descriptorSets.size()) {
+        descriptorSets[i].intersect(other.descriptorSets[i]);
+      } else {
+        descriptorSets[i].clear();
+      }
+    }
+    if (!other.previousFullBarrier) previousFullBarrier = {};
+  }
+
   DescriptorSetState *getDescriptorSet(Value set) {
     APInt setInt;
     if (!matchPattern(set, m_ConstantInt(&setInt))) {
@@ -167,13 +214,23 @@ static LogicalResult processOp(IREE::HAL::CommandBufferPushDescriptorSetOp op,
   auto *setState = state.getDescriptorSet(op.getSet());
   if (!setState) return failure();
 
+  // Descriptors pushed with a different layout may have been disturbed.
   bool isLayoutEqual = setState->pipelineLayout == op.getPipelineLayout();
-  setState->pipelineLayout = op.getPipelineLayout();
+  if (!isLayoutEqual) {
+    setState->clear();
+    setState->pipelineLayout = op.getPipelineLayout();
+  }
 
   int64_t descriptorCount = op.getBindingBuffers().size();
   llvm::BitVector redundantIndices(descriptorCount);
   for (int64_t index = 0; index < descriptorCount; ++index) {
-    auto &descriptor = setState->getDescriptor(index);
+    APInt ordinalInt;
+    if (!matchPattern(op.getBindingOrdinals()[index],
+                      m_ConstantInt(&ordinalInt))) {
+      // Dynamic binding ordinal; not analyzable with this approach.
+      return failure();
+    }
+    auto &descriptor = setState->getDescriptor(ordinalInt.getSExtValue());
     auto buffer = op.getBindingBuffers()[index];
     auto offset = op.getBindingOffsets()[index];
     auto length = op.getBindingLengths()[index];
@@ -202,6 +259,47 @@ static LogicalResult processOp(IREE::HAL::CommandBufferPushDescriptorSetOp op,
   return success();
 }
 
+// Returns true if a full barrier at the end of |commandBuffer| orders nothing.
+// This is the case when the command buffer is only ever submitted on its own:
+// the signal fences of a submission are only reached once all of its commands
+// have completed and any later work that depends on the results waits on
+// those fences, as derived from the Stream timepoints. Nested command buffers
+// and ones submitted together with others (which execute as if recorded as
+// one) keep their trailing barriers.
+static bool isTrailingBarrierRedundant(Value commandBuffer) {
+  auto createOp =
+      commandBuffer.getDefiningOp<IREE::HAL::CommandBufferCreateOp>();
+  if (!createOp || bitEnumContainsAny(
+                       createOp.getModes(),
+                       IREE::HAL::CommandBufferModeBitfield::Nested)) {
+    return false;
+  }
+  for (auto *user : commandBuffer.getUsers()) {
+    if (auto executeOp = dyn_cast<IREE::HAL::DeviceQueueExecuteOp>(user)) {
+      if (executeOp.getCommandBuffers().size() != 1) return false;
+      continue;
+    }
+    if (!isa<IREE::HAL::CommandBufferFinalizeOp,
+             IREE::HAL::CommandBufferDeviceOp,
+             IREE::HAL::CommandBufferBeginDebugGroupOp,
+             IREE::HAL::CommandBufferEndDebugGroupOp,
+             IREE::HAL::CommandBufferExecutionBarrierOp,
+             IREE::HAL::CommandBufferFillBufferOp,
+             IREE::HAL::CommandBufferCopyBufferOp,
+             IREE::HAL::CommandBufferCollectiveOp,
+             IREE::HAL::CommandBufferPushConstantsOp,
+             IREE::HAL::CommandBufferPushDescriptorSetOp,
+             IREE::HAL::CommandBufferDispatchSymbolOp,
+             IREE::HAL::CommandBufferDispatchOp,
+             IREE::HAL::CommandBufferDispatchIndirectSymbolOp,
+             IREE::HAL::CommandBufferDispatchIndirectOp>(user)) {
+      // Escapes to code we can't see (calls, globals, branches, ...).
+      return false;
+    }
+  }
+  return true;
+}
+
 class ElideRedundantCommandsPass
     : public PassWrapper<ElideRedundantCommandsPass, OperationPass<void>> {
  public:
@@ -220,69 +318,124 @@ class ElideRedundantCommandsPass
   void runOnOperation() override {
     auto parentOp = getOperation();
 
-    // TODO(benvanik): intraprocedural at least; keep track of state at block
-    // boundaries. IPO would be nice but it (today) rarely happens that we
-    // pass command buffers across calls.
+    // State is carried across blocks in reverse post-order: a block starts
+    // with the state common to all of its predecessors and with no state if
+    // any of them has not been visited yet (loop back edges). IPO would be
+    // nice but it (today) rarely happens that we pass command buffers across
+    // calls.
     for (auto &region : parentOp->getRegions()) {
-      for (auto &block : region.getBlocks()) {
-        // State tracking for each command buffer found.
-        // Discard state on ops we don't currently analyze (because this is
-        // super basic - we really need to analyze them).
-        CommandBufferStateMap stateMap;
-        auto invalidateState = [&](Value commandBuffer) {
-          stateMap[commandBuffer] = {};
-        };
-        auto resetCommandBufferBarrierBit = [&](Operation *op) {
-          assert(op->getNumOperands() > 0 && "must be a command buffer op");
-          auto commandBuffer = op->getOperand(0);
-          assert(commandBuffer.getType().isa<IREE::HAL::CommandBufferType>() &&
-                 "operand 0 must be a command buffer");
-          stateMap[commandBuffer].previousFullBarrier = {};
-        };
-        for (auto &op : llvm::make_early_inc_range(block.getOperations())) {
-          if (!op.getDialect()) continue;
-          TypeSwitch<Operation *>(&op)
-              .Case([&](IREE::HAL::CommandBufferFinalizeOp op) {
-                invalidateState(op.getCommandBuffer());
-              })
-              .Case([&](IREE::HAL::CommandBufferExecutionBarrierOp op) {
-                processOp(op, stateMap[op.getCommandBuffer()]);
-              })
-              .Case([&](IREE::HAL::CommandBufferPushConstantsOp op) {
-                resetCommandBufferBarrierBit(op);
-                if (failed(processOp(op, stateMap[op.getCommandBuffer()]))) {
-                  invalidateState(op.getCommandBuffer());
-                }
-              })
-              .Case([&](IREE::HAL::CommandBufferPushDescriptorSetOp op) {
-                resetCommandBufferBarrierBit(op);
-                if (failed(processOp(op, stateMap[op.getCommandBuffer()]))) {
-                  invalidateState(op.getCommandBuffer());
-                }
-              })
-              .Case<IREE::HAL::CommandBufferDeviceOp,
-                    IREE::HAL::CommandBufferBeginDebugGroupOp,
-                    IREE::HAL::CommandBufferEndDebugGroupOp,
-                    IREE::HAL::CommandBufferFillBufferOp,
-                    IREE::HAL::CommandBufferCopyBufferOp,
-                    IREE::HAL::CommandBufferDispatchSymbolOp,
-                    IREE::HAL::CommandBufferDispatchOp,
-                    IREE::HAL::CommandBufferDispatchIndirectSymbolOp,
-                    IREE::HAL::CommandBufferDispatchIndirectOp>(
-                  [&](Operation *op) {
-                    // Ok - don't impact state.
-                    resetCommandBufferBarrierBit(op);
-                  })
-              .Default([&](Operation *op) {
-                // Unknown op - discard state cache.
-                // This is to avoid correctness issues with region ops (like
-                // scf.if) that we don't analyze properly here. We could
-                // restrict this a bit by only discarding on use of the
-                // command buffer.
-                stateMap.clear();
-              });
+      if (region.empty()) continue;
+      DenseMap<Block *, CommandBufferStateMap> exitStateMaps;
+      for (auto *block :
+           llvm::ReversePostOrderTraversal<Block *>(&region.front())) {
+        CommandBufferStateMap stateMap = getEntryStateMap(block, exitStateMaps);
+        processBlock(*block, stateMap);
+        exitStateMaps[block] = std::move(stateMap);
+      }
+    }
+  }
+
+ private:
+  // Returns the state common to all predecessors of |block|.
+  static CommandBufferStateMap getEntryStateMap(
+      Block *block, DenseMap<Block *, CommandBufferStateMap> &exitStateMaps) {
+    CommandBufferStateMap entryStateMap;
+    bool isFirst = true;
+    for (auto *predecessor : block->getPredecessors()) {
+      auto it = exitStateMaps.find(predecessor);
+      if (it == exitStateMaps.end()) return {};
+      if (isFirst) {
+        entryStateMap = it->second;
+        isFirst = false;
+        continue;
+      }
+      SmallVector<Value> droppedCommandBuffers;
+      for (auto &entry : entryStateMap) {
+        auto otherIt = it->second.find(entry.first);
+        if (otherIt == it->second.end()) {
+          droppedCommandBuffers.push_back(entry.first);
+        } else {
+          entry.second.intersect(otherIt->second);
         }
       }
+      for (auto commandBuffer : droppedCommandBuffers) {
+        entryStateMap.erase(commandBuffer);
+      }
+    }
+    return entryStateMap;
+  }
+
+  static void processBlock(Block &block, CommandBufferStateMap &stateMap) {
+    // Discard state on ops we don't currently analyze (because this is super
+    // basic - we really need to analyze them).
+    auto invalidateState = [&](Value commandBuffer) {
+      stateMap[commandBuffer] = {};
+    };
+    auto resetCommandBufferBarrierBit = [&](Operation *op) {
+      assert(op->getNumOperands() > 0 && "must be a command buffer op");
+      auto commandBuffer = op->getOperand(0);
+      assert(commandBuffer.getType().isa<IREE::HAL::CommandBufferType>() &&
+             "operand 0 must be a command buffer");
+      stateMap[commandBuffer].previousFullBarrier = {};
+    };
+    for (auto &op : llvm::make_early_inc_range(block.getOperations())) {
+      if (!op.getDialect()) continue;
+      TypeSwitch<Operation *>(&op)
+          .Case([&](IREE::HAL::CommandBufferFinalizeOp op) {
+            auto &state = stateMap[op.getCommandBuffer()];
+            if (state.previousFullBarrier &&
+                state.previousFullBarrier->getBlock() == op->getBlock() &&
+                isTrailingBarrierRedundant(op.getCommandBuffer())) {
+              state.previousFullBarrier.erase();
+            }
+            invalidateState(op.getCommandBuffer());
+          })
+          .Case([&](IREE::HAL::CommandBufferExecutionBarrierOp op) {
+            processOp(op, stateMap[op.getCommandBuffer()]);
+          })
+          .Case([&](IREE::HAL::CommandBufferPushConstantsOp op) {
+            resetCommandBufferBarrierBit(op);
+            if (failed(processOp(op, stateMap[op.getCommandBuffer()]))) {
+              invalidateState(op.getCommandBuffer());
+            }
+          })
+          .Case([&](IREE::HAL::CommandBufferPushDescriptorSetOp op) {
+            resetCommandBufferBarrierBit(op);
+            if (failed(processOp(op, stateMap[op.getCommandBuffer()]))) {
+              invalidateState(op.getCommandBuffer());
+            }
+          })
+          .Case<IREE::HAL::CommandBufferDeviceOp,
+                IREE::HAL::CommandBufferBeginDebugGroupOp,
+                IREE::HAL::CommandBufferEndDebugGroupOp,
+                IREE::HAL::CommandBufferFillBufferOp,
+                IREE::HAL::CommandBufferCopyBufferOp,
+                IREE::HAL::CommandBufferCollectiveOp,
+                IREE::HAL::CommandBufferDispatchSymbolOp,
+                IREE::HAL::CommandBufferDispatchOp,
+                IREE::HAL::CommandBufferDispatchIndirectSymbolOp,
+                IREE::HAL::CommandBufferDispatchIndirectOp>(
+              [&](Operation *op) {
+                // Ok - don't impact state.
+                resetCommandBufferBarrierBit(op);
+              })
+          .Default([&](Operation *op) {
+            if (op->getNumRegions() > 0 || isa<CallOpInterface>(op)) {
+              // Unknown op that may record into any command buffer - discard
+              // the state cache. This is to avoid correctness issues with
+              // region ops (like scf.if) that we don't analyze properly here.
+              stateMap.clear();
+              return;
+            }
+            // Other ops can only change the state of command buffers they
+            // are given (arithmetic and buffer ops in between commands are
+            // common and must not block elision).
+            for (auto operand : op->getOperands()) {
+              if (operand.getType().isa<IREE::HAL::CommandBufferType>()) {
+                invalidateState(operand);
+              }
+            }
+          });
     }
   }
 };
@@ -0,0 +1,146 @@
+// Copyright 2023 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include "iree/compiler/Dialect/HAL/Transforms/ExecutableCache.h"
+
+#include "llvm/ADT/SmallString.h"
+#include "llvm/ADT/StringExtras.h"
+#include "llvm/Support/Debug.h"
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/MemoryBuffer.h"
+#include "llvm/Support/Path.h"
+#include "llvm/Support/SHA256.h"
+#include "llvm/Support/raw_ostream.h"
+#include "mlir/IR/Block.h"
+#include "mlir/IR/OperationSupport.h"
+#include "mlir/IR/Verifier.h"
+#include "mlir/Parser/Parser.h"
+
+#define DEBUG_TYPE "iree-hal-executable-cache"
+
+namespace mlir {
+namespace iree_compiler {
+namespace IREE {
+namespace HAL {
+
+// Bumped whenever the entry format or the contents of the key change in a way
+// that invalidates previously cached entries.
+static const char kCacheVersion[] = "iree-hal-executable-cache-v1";
+
+// Returns the flags used when printing IR into keys and entries. Locations are
+// included as they end up in debug info and SSA names are local to the op so
+// the result is independent of the surrounding module.
+static OpPrintingFlags getPrintingFlags() {
+  return OpPrintingFlags()
+      .enableDebugInfo()
+      .printGenericOpForm()
+      .useLocalScope();
+}
+
+ExecutableCache::ExecutableCache(StringRef path) : path(path.str()) {
+  if (path.empty()) return;
+  // Elided attributes (--mlir-elide-elementsattrs-if-larger) would make
+  // different executables produce the same key and entries unparsable.
+  if (getPrintingFlags().getLargeElementsAttrLimit().has_value()) {
+    LLVM_DEBUG(llvm::dbgs() << "ExecutableCache: disabled as elements "
+                               "attributes are elided when printing\n");
+    return;
+  }
+  enabled = true;
+}
+
+std::string ExecutableCache::getKey(StringRef stage,
+                                    IREE::HAL::ExecutableVariantOp variantOp,
+                                    const TargetBackend &targetBackend,
+                                    StringRef extraKey) const {
+  if (!enabled) return {};
+  std::string keyText;
+  llvm::raw_string_ostream os(keyText);
+  os << kCacheVersion << "\n" << stage << "\n" << targetBackend.name() << "\n";
+  if (!targetBackend.appendCacheKey(os)) return {};
+  os << "\n" << extraKey << "\n";
+  if (auto executableOp =
+          variantOp->getParentOfType<IREE::HAL::ExecutableOp>()) {
+    // Backends derive symbol names in the binary from the executable name.
+    os << executableOp.getName() << "\n";
+  }
+  variantOp->print(os, getPrintingFlags());
+  os.flush();
+  llvm::SHA256 hasher;
+  hasher.update(keyText);
+  return llvm::toHex(hasher.final(), /*LowerCase=*/true);
+}
+
+std::string ExecutableCache::getEntryPath(StringRef key) const {
+  SmallString<256> entryPath(path);
+  llvm::sys::path::append(entryPath, key + ".mlir");
+  return std::string(entryPath.str());
+}
+
+LogicalResult ExecutableCache::load(
+    StringRef key, OpBuilder &builder,
+    SmallVectorImpl<Operation *> &loadedOps) const {
+  if (!enabled || key.empty()) return failure();
+  auto fileOrErr = llvm::MemoryBuffer::getFile(getEntryPath(key));
+  if (!fileOrErr) return failure();
+
+  // Ops are verified once inserted as they may require a parent op.
+  Block block;
+  ParserConfig config(builder.getContext(),
+                      /*verifyAfterParse=*/false);
+  if (failed(parseSourceString((*fileOrErr)->getBuffer(), &block, config))) {
+    LLVM_DEBUG(llvm::dbgs()
+               << "ExecutableCache: failed to parse entry " << key << "\n");
+    return failure();
+  }
+  for (auto &op : llvm::make_early_inc_range(block)) {
+    op.moveBefore(builder.getInsertionBlock(), builder.getInsertionPoint());
+    loadedOps.push_back(&op);
+  }
+  for (auto *op : loadedOps) {
+    if (succeeded(mlir::verify(op))) continue;
+    LLVM_DEBUG(llvm::dbgs()
+               << "ExecutableCache: failed to verify entry " << key << "\n");
+    for (auto *loadedOp : loadedOps) loadedOp->erase();
+    loadedOps.clear();
+    return failure();
+  }
+  LLVM_DEBUG(llvm::dbgs() << "ExecutableCache: hit " << key << "\n");
+  return success();
+}
+
+void ExecutableCache::store(StringRef key, ArrayRef<Operation *> ops) const {
+  if (!enabled || key.empty()) return;
+  // Written to a temporary file first so that concurrent compilations never
+  // observe a partially written entry.
+  std::string entryPath = getEntryPath(key);
+  int fd = -1;
+  SmallString<256> tempPath;
+  if (llvm::sys::fs::create_directories(path) ||
+      llvm::sys::fs::createUniqueFile(entryPath + "-%%%%%%%%.tmp", fd,
+                                      tempPath)) {
+    LLVM_DEBUG(llvm::dbgs() << "ExecutableCache: failed to create entry "
+                            << entryPath << "\n");
+    return;
+  }
+  {
+    llvm::raw_fd_ostream os(fd, /*shouldClose=*/true);
+    for (auto *op : ops) {
+      op->print(os, getPrintingFlags());
+      os << "\n";
+    }
+  }
+  if (llvm::sys::fs::rename(tempPath, entryPath)) {
+    llvm::sys::fs::remove(tempPath);
+    return;
+  }
+  LLVM_DEBUG(llvm::dbgs() << "ExecutableCache: stored " << key << "\n");
+}
+
+}  // namespace HAL
+}  // namespace IREE
+}  // namespace iree_compiler
+}  // namespace mlir
@@ -0,0 +1,70 @@
+// Copyright 2023 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#ifndef IREE_COMPILER_DIALECT_HAL_TRANSFORMS_EXECUTABLECACHE_H_
+#define IREE_COMPILER_DIALECT_HAL_TRANSFORMS_EXECUTABLECACHE_H_
+
+#include <string>
+
+#include "iree/compiler/Dialect/HAL/IR/HALOps.h"
+#include "iree/compiler/Dialect/HAL/Target/TargetBackend.h"
+#include "llvm/ADT/ArrayRef.h"
+#include "llvm/ADT/StringRef.h"
+#include "mlir/IR/Builders.h"
+#include "mlir/IR/Operation.h"
+#include "mlir/Support/LogicalResult.h"
+
+namespace mlir {
+namespace iree_compiler {
+namespace IREE {
+namespace HAL {
+
+// Persistent content-addressed cache of executable translation and
+// serialization results shared across compiler invocations. Entries are keyed
+// by the full IR of the executable variant (including locations) along with
+// the target backend and any options it reports as affecting its output so
+// that unchanged executables can skip codegen when recompiling a model.
+//
+// The cache is best-effort: failing to read or write an entry only results in
+// the executable being compiled as if no cache was present.
+class ExecutableCache {
+ public:
+  // Opens the cache stored under |path|. An empty path disables the cache.
+  explicit ExecutableCache(StringRef path);
+
+  // Returns true if lookups and stores go to disk.
+  bool isEnabled() const { return enabled; }
+
+  // Returns the key of the result of running |stage| (such as "translate")
+  // on |variantOp| with |targetBackend|. |extraKey| is mixed into the key and
+  // should contain pass options that affect the result. Returns an empty
+  // string if the variant can't be cached.
+  std::string getKey(StringRef stage, IREE::HAL::ExecutableVariantOp variantOp,
+                     const TargetBackend &targetBackend,
+                     StringRef extraKey = {}) const;
+
+  // Parses the ops stored in the entry |key| and inserts them at the insertion
+  // point of |builder|. Fails without changing the IR if the entry doesn't
+  // exist or can't be parsed.
+  LogicalResult load(StringRef key, OpBuilder &builder,
+                     SmallVectorImpl<Operation *> &loadedOps) const;
+
+  // Stores |ops| as the entry |key| replacing any existing entry.
+  void store(StringRef key, ArrayRef<Operation *> ops) const;
+
+ private:
+  std::string getEntryPath(StringRef key) const;
+
+  std::string path;
+  bool enabled = false;
+};
+
+}  // namespace HAL
+}  // namespace IREE
+}  // namespace iree_compiler
+}  // namespace mlir
+
+#endif  // IREE_COMPILER_DIALECT_HAL_TRANSFORMS_EXECUTABLECACHE_H_
@@ -140,7 +140,8 @@ void buildHALTransformPassPipeline(OpPassManager &passManager,
   // After this point the executables are opaque blobs and we cannot change
   // their interfaces.
   passManager.addNestedPass<IREE::HAL::ExecutableOp>(
-      createTranslateExecutablesPass());
+      createTranslateExecutablesPass(targetOptions.executableCachePath,
+                                     targetOptions.executableCacheKey));
 
   //----------------------------------------------------------------------------
   // Host program conversion
@@ -223,7 +224,9 @@ void buildHALTransformPassPipeline(OpPassManager &passManager,
     passManager.addNestedPass<IREE::HAL::ExecutableOp>(
         createSerializeExecutablesPass(
             targetOptions.debugLevel, targetOptions.executableIntermediatesPath,
-            targetOptions.executableBinariesPath));
+            targetOptions.executableBinariesPath,
+            targetOptions.executableCachePath,
+            targetOptions.executableCacheKey));
 
     // NOTE: symbol DCE will destroy executable target contents, so only run it
     // if we serialized things.
@@ -68,6 +68,11 @@ createVerifyTargetEnvironmentPass();
 std::unique_ptr<OperationPass<mlir::ModuleOp>> createAssignTargetDevicesPass(
     ArrayRef<std::string> targets);
 
+// Partitions the dispatches of each function into |stageCount| pipeline stages
+// of roughly equal cost and assigns each stage to its own queue affinity.
+std::unique_ptr<OperationPass<mlir::ModuleOp>> createAssignPipelineStagesPass(
+    int64_t stageCount);
+
 // Applies fixups to the program for when using legacy HAL devices that only
 // support synchronous execution. Once all devices support async this will be
 // removed.
@@ -98,12 +103,17 @@ std::unique_ptr<OperationPass<mlir::ModuleOp>>
 createDumpExecutableBenchmarksPass(StringRef path);
 
 // Translates hal.executable.variant ops via a nested translation pipeline.
+// Translations are reused from the persistent cache at |executableCachePath|
+// when non-empty.
 std::unique_ptr<OperationPass<IREE::HAL::ExecutableOp>>
-createTranslateExecutablesPass();
+createTranslateExecutablesPass(std::string executableCachePath = "",
+                               std::string executableCacheKey = "");
 
 // Translates hal.executable.variant ops for the specified |target| backend.
 std::unique_ptr<OperationPass<IREE::HAL::ExecutableVariantOp>>
-createTranslateTargetExecutableVariantsPass(StringRef target);
+createTranslateTargetExecutableVariantsPass(
+    StringRef target, std::string executableCachePath = "",
+    std::string executableCacheKey = "");
 
 // Calls into each target backend to have it link multiple hal.executables
 // together (if that makes sense). For example, the LLVM AOT backend may combine
@@ -120,16 +130,22 @@ std::unique_ptr<OperationPass<mlir::ModuleOp>>
 createResolveExportOrdinalsPass();
 
 // Converts hal.executable.variants to one or more hal.executable.binary ops.
+// Binaries are reused from the persistent cache at |executableCachePath| when
+// non-empty.
 std::unique_ptr<OperationPass<IREE::HAL::ExecutableOp>>
 createSerializeExecutablesPass(int debugLevel = 2,
                                std::string dumpIntermediatesPath = "",
-                               std::string dumpBinariesPath = "");
+                               std::string dumpBinariesPath = "",
+                               std::string executableCachePath = "",
+                               std::string executableCacheKey = "");
 
 // Serializes executables for the specified |target| backend.
 std::unique_ptr<OperationPass<IREE::HAL::ExecutableOp>>
 createSerializeTargetExecutablesPass(StringRef target, int debugLevel = 2,
                                      std::string dumpIntermediatesPath = "",
-                                     std::string dumpBinariesPath = "");
+                                     std::string dumpBinariesPath = "",
+                                     std::string executableCachePath = "",
+                                     std::string executableCacheKey = "");
 
 //===----------------------------------------------------------------------===//
 // Resource initialization, caching, and optimization
@@ -157,6 +173,7 @@ inline void registerHALPasses() {
   registerHALTransformPassPipeline();
   registerHALConfigurationPassPipeline();
   auto targetOptions = TargetOptions::FromFlags::get();
+  createAssignPipelineStagesPass(/*stageCount=*/1);
   createAssignTargetDevicesPass({});
   createBenchmarkBatchDispatchesPass(/*repeatCount=*/1);
   createConvertToHALPass();
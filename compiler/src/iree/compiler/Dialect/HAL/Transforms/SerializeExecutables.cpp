@@ -11,6 +11,7 @@
 #include "iree/compiler/Dialect/HAL/IR/HALOps.h"
 #include "iree/compiler/Dialect/HAL/Target/TargetBackend.h"
 #include "iree/compiler/Dialect/HAL/Target/TargetRegistry.h"
+#include "iree/compiler/Dialect/HAL/Transforms/ExecutableCache.h"
 #include "llvm/ADT/StringSet.h"
 #include "llvm/Support/FileSystem.h"
 #include "mlir/IR/Attributes.h"
@@ -32,11 +33,14 @@ class SerializeTargetExecutablesPass
   SerializeTargetExecutablesPass(const SerializeTargetExecutablesPass &pass) {}
   SerializeTargetExecutablesPass(StringRef target, int debugLevel,
                                  std::string dumpIntermediatesPath,
-                                 std::string dumpBinariesPath) {
+                                 std::string dumpBinariesPath,
+                                 std::string cachePath, std::string cacheKey) {
     this->target = target.str();
     this->debugLevel = debugLevel;
     this->dumpIntermediatesPath = dumpIntermediatesPath;
     this->dumpBinariesPath = dumpBinariesPath;
+    this->cachePath = cachePath;
+    this->cacheKey = cacheKey;
   }
 
   StringRef getArgument() const override {
@@ -83,20 +87,44 @@ class SerializeTargetExecutablesPass
       llvm::sys::fs::create_directories(dumpBinariesPath);
     }
 
+    // Dumped artifacts are produced as a side effect of serialization and
+    // would be missing for cached executables.
+    ExecutableCache cache(
+        dumpIntermediatesPath.empty() && dumpBinariesPath.empty() ? cachePath
+                                                                  : "");
+    std::string extraKey = cacheKey + "\n" + std::to_string(debugLevel);
+
     auto variantOps = llvm::to_vector<4>(
         executableOp.getBlock().getOps<IREE::HAL::ExecutableVariantOp>());
     for (auto variantOp : variantOps) {
       if (variantOp.getTarget().getBackend().getValue() != target) continue;
       OpBuilder executableBuilder(variantOp);
+
+      // Reuse the binaries of an identical executable if present.
+      std::string key =
+          cache.getKey("serialize", variantOp, *targetBackend, extraKey);
+      SmallVector<Operation *> binaryOps;
+      if (succeeded(cache.load(key, executableBuilder, binaryOps))) {
+        variantOp.erase();
+        continue;
+      }
+
       // Ask the target backend to serialize the executable. Note that it
       // may create one or more hal.executable.binary ops in the case of
       // multi-architecture binaries.
+      Operation *prevOp = variantOp->getPrevNode();
       if (failed(targetBackend->serializeExecutable(
               serializationOptions, variantOp, executableBuilder))) {
         variantOp.emitError()
             << "failed to serialize executable for target backend " << target;
         return signalPassFailure();
       }
+      for (Operation *op = prevOp ? prevOp->getNextNode()
+                                  : &executableOp.getBlock().front();
+           op != variantOp.getOperation(); op = op->getNextNode()) {
+        binaryOps.push_back(op);
+      }
+      cache.store(key, binaryOps);
       variantOp.erase();
     }
   }
@@ -119,14 +147,23 @@ class SerializeTargetExecutablesPass
       *this, "dump-binaries-path",
       llvm::cl::desc("Path to write translated and serialized executable "
                      "binaries into for debugging.")};
+  Option<std::string> cachePath{
+      *this, "cache-path",
+      llvm::cl::desc("Path to a persistent cache of serialized executables.")};
+  Option<std::string> cacheKey{
+      *this, "cache-key",
+      llvm::cl::desc("Opaque key mixed into all executable cache entries.")};
 };
 
 std::unique_ptr<OperationPass<IREE::HAL::ExecutableOp>>
 createSerializeTargetExecutablesPass(StringRef target, int debugLevel,
                                      std::string dumpIntermediatesPath,
-                                     std::string dumpBinariesPath) {
+                                     std::string dumpBinariesPath,
+                                     std::string executableCachePath,
+                                     std::string executableCacheKey) {
   return std::make_unique<SerializeTargetExecutablesPass>(
-      target, debugLevel, dumpIntermediatesPath, dumpBinariesPath);
+      target, debugLevel, dumpIntermediatesPath, dumpBinariesPath,
+      executableCachePath, executableCacheKey);
 }
 
 static PassRegistration<SerializeTargetExecutablesPass> linkTargetPass([] {
@@ -139,10 +176,14 @@ class SerializeExecutablesPass
  public:
   SerializeExecutablesPass() = default;
   SerializeExecutablesPass(int debugLevel, std::string dumpIntermediatesPath,
-                           std::string dumpBinariesPath)
+                           std::string dumpBinariesPath,
+                           std::string executableCachePath,
+                           std::string executableCacheKey)
       : debugLevel(debugLevel),
         dumpIntermediatesPath(dumpIntermediatesPath),
-        dumpBinariesPath(dumpBinariesPath) {}
+        dumpBinariesPath(dumpBinariesPath),
+        executableCachePath(executableCachePath),
+        executableCacheKey(executableCacheKey) {}
 
   StringRef getArgument() const override {
     return "iree-hal-serialize-executables";
@@ -157,7 +198,8 @@ class SerializeExecutablesPass
     OpPassManager passManager(executableOp.getOperationName());
     for (const auto &targetName : gatherExecutableTargetNames(executableOp)) {
       passManager.addPass(createSerializeTargetExecutablesPass(
-          targetName, debugLevel, dumpIntermediatesPath, dumpBinariesPath));
+          targetName, debugLevel, dumpIntermediatesPath, dumpBinariesPath,
+          executableCachePath, executableCacheKey));
     }
     if (failed(runPipeline(passManager, executableOp))) {
       executableOp.emitError() << "failed to serialize executables";
@@ -169,14 +211,19 @@ class SerializeExecutablesPass
   int debugLevel;
   std::string dumpIntermediatesPath;
   std::string dumpBinariesPath;
+  std::string executableCachePath;
+  std::string executableCacheKey;
 };
 
 std::unique_ptr<OperationPass<IREE::HAL::ExecutableOp>>
 createSerializeExecutablesPass(int debugLevel,
                                std::string dumpIntermediatesPath,
-                               std::string dumpBinariesPath) {
+                               std::string dumpBinariesPath,
+                               std::string executableCachePath,
+                               std::string executableCacheKey) {
   return std::make_unique<SerializeExecutablesPass>(
-      debugLevel, dumpIntermediatesPath, dumpBinariesPath);
+      debugLevel, dumpIntermediatesPath, dumpBinariesPath, executableCachePath,
+      executableCacheKey);
 }
 
 static PassRegistration<SerializeExecutablesPass> linkPass([] {
@@ -11,6 +11,7 @@
 #include "iree/compiler/Dialect/HAL/IR/HALOps.h"
 #include "iree/compiler/Dialect/HAL/Target/TargetBackend.h"
 #include "iree/compiler/Dialect/HAL/Target/TargetRegistry.h"
+#include "iree/compiler/Dialect/HAL/Transforms/ExecutableCache.h"
 #include "llvm/ADT/StringSet.h"
 #include "mlir/Dialect/Bufferization/IR/Bufferization.h"
 #include "mlir/IR/Attributes.h"
@@ -31,8 +32,12 @@ class TranslateTargetExecutableVariantsPass
   TranslateTargetExecutableVariantsPass() = default;
   TranslateTargetExecutableVariantsPass(
       const TranslateTargetExecutableVariantsPass &pass) {}
-  TranslateTargetExecutableVariantsPass(StringRef target) {
+  TranslateTargetExecutableVariantsPass(StringRef target,
+                                        std::string cachePath,
+                                        std::string cacheKey) {
     this->target = target.str();
+    this->cachePath = cachePath;
+    this->cacheKey = cacheKey;
   }
 
   StringRef getArgument() const override {
@@ -62,6 +67,12 @@ class TranslateTargetExecutableVariantsPass
       return signalPassFailure();
     }
 
+    // Reuse a previous translation of identical source contents if present.
+    ExecutableCache cache(cachePath);
+    std::string key =
+        cache.getKey("translate", variantOp, *targetBackend, cacheKey);
+    if (succeeded(loadCachedTranslation(cache, key, variantOp))) return;
+
     OpPassManager passManager(variantOp.getOperationName());
     targetBackend->buildTranslationPassPipeline(variantOp, passManager);
     if (failed(runPipeline(passManager, variantOp))) {
@@ -70,19 +81,56 @@ class TranslateTargetExecutableVariantsPass
                             << variantOp.getTarget();
       return signalPassFailure();
     }
+
+    cache.store(key, {variantOp.getOperation()});
   }
 
  private:
+  // Replaces the contents and attributes of |variantOp| with those of the
+  // translated variant stored in the cache entry |key|. The variant itself is
+  // kept as it is the op this pass is running on and the entry is loaded into
+  // a detached executable as sibling variants may be translating concurrently.
+  LogicalResult loadCachedTranslation(
+      const ExecutableCache &cache, StringRef key,
+      IREE::HAL::ExecutableVariantOp variantOp) {
+    if (!cache.isEnabled()) return failure();
+    OpBuilder builder(variantOp.getContext());
+    auto scratchOp = builder.create<IREE::HAL::ExecutableOp>(
+        variantOp.getLoc(), "executable_cache");
+    builder.setInsertionPointToStart(&scratchOp.getBlock());
+    SmallVector<Operation *> loadedOps;
+    auto cachedOp =
+        succeeded(cache.load(key, builder, loadedOps)) && loadedOps.size() == 1
+            ? dyn_cast<IREE::HAL::ExecutableVariantOp>(loadedOps.front())
+            : IREE::HAL::ExecutableVariantOp();
+    bool hit = cachedOp && cachedOp.getSymName() == variantOp.getSymName();
+    if (hit) {
+      variantOp->setAttrs(cachedOp->getAttrDictionary());
+      variantOp.getBody().takeBody(cachedOp.getBody());
+    }
+    scratchOp.erase();
+    return success(hit);
+  }
+
   Option<std::string> target{
       *this, "target",
       llvm::cl::desc(
           "Target backend name whose executables will be translated by "
           "this pass.")};
+  Option<std::string> cachePath{
+      *this, "cache-path",
+      llvm::cl::desc("Path to a persistent cache of translated executables.")};
+  Option<std::string> cacheKey{
+      *this, "cache-key",
+      llvm::cl::desc("Opaque key mixed into all executable cache entries.")};
 };
 
 std::unique_ptr<OperationPass<IREE::HAL::ExecutableVariantOp>>
-createTranslateTargetExecutableVariantsPass(StringRef target) {
-  return std::make_unique<TranslateTargetExecutableVariantsPass>(target);
+createTranslateTargetExecutableVariantsPass(StringRef target,
+                                            std::string executableCachePath,
+                                            std::string executableCacheKey) {
+  return std::make_unique<TranslateTargetExecutableVariantsPass>(
+      target, executableCachePath, executableCacheKey);
 }
 
 static PassRegistration<TranslateTargetExecutableVariantsPass> linkTargetPass(
@@ -93,6 +141,10 @@ class TranslateExecutablesPass
                          OperationPass<IREE::HAL::ExecutableOp>> {
  public:
   TranslateExecutablesPass() = default;
+  TranslateExecutablesPass(std::string executableCachePath,
+                           std::string executableCacheKey)
+      : executableCachePath(executableCachePath),
+        executableCacheKey(executableCacheKey) {}
 
   StringRef getArgument() const override {
     return "iree-hal-translate-executables";
@@ -116,18 +168,25 @@ class TranslateExecutablesPass
     OpPassManager passManager(executableOp.getOperationName());
     for (const auto &targetName : gatherExecutableTargetNames(executableOp)) {
       passManager.addNestedPass<IREE::HAL::ExecutableVariantOp>(
-          createTranslateTargetExecutableVariantsPass(targetName));
+          createTranslateTargetExecutableVariantsPass(
+              targetName, executableCachePath, executableCacheKey));
     }
     if (failed(runPipeline(passManager, executableOp))) {
       executableOp.emitError() << "failed to serialize executables";
       return signalPassFailure();
     }
   }
+
+ private:
+  std::string executableCachePath;
+  std::string executableCacheKey;
 };
 
 std::unique_ptr<OperationPass<IREE::HAL::ExecutableOp>>
-createTranslateExecutablesPass() {
-  return std::make_unique<TranslateExecutablesPass>();
+createTranslateExecutablesPass(std::string executableCachePath,
+                               std::string executableCacheKey) {
+  return std::make_unique<TranslateExecutablesPass>(executableCachePath,
+                                                    executableCacheKey);
 }
 
 static PassRegistration<TranslateExecutablesPass> translatePass([] {
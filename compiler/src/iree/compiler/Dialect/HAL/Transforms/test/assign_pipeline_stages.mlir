@@ -0,0 +1,42 @@
+// RUN: iree-opt --split-input-file --pass-pipeline='builtin.module(iree-hal-assign-pipeline-stages{stage-count=2})' %s | FileCheck %s
+
+// Equally sized dispatches are split evenly across the stages in order.
+
+// CHECK-LABEL: @evenStages
+func.func @evenStages(%arg0: tensor<4xf32>) -> tensor<4xf32> {
+  // CHECK: flow.dispatch @ex::@entry0
+  // CHECK-SAME: stream.affinity = #hal.affinity.queue<[0]>
+  %0 = flow.dispatch @ex::@entry0(%arg0) : (tensor<4xf32>) -> tensor<4xf32>
+  // CHECK: flow.dispatch @ex::@entry1
+  // CHECK-SAME: stream.affinity = #hal.affinity.queue<[0]>
+  %1 = flow.dispatch @ex::@entry1(%0) : (tensor<4xf32>) -> tensor<4xf32>
+  // CHECK: flow.dispatch @ex::@entry2
+  // CHECK-SAME: stream.affinity = #hal.affinity.queue<[1]>
+  %2 = flow.dispatch @ex::@entry2(%1) : (tensor<4xf32>) -> tensor<4xf32>
+  // CHECK: flow.dispatch @ex::@entry3
+  // CHECK-SAME: stream.affinity = #hal.affinity.queue<[1]>
+  %3 = flow.dispatch @ex::@entry3(%2) : (tensor<4xf32>) -> tensor<4xf32>
+  return %3 : tensor<4xf32>
+}
+
+// -----
+
+// Stages are balanced by the bytes each dispatch touches and existing
+// affinities are preserved.
+
+// CHECK-LABEL: @weightedStages
+func.func @weightedStages(%arg0: tensor<4xf32>, %arg1: tensor<1024x4xf32>) -> tensor<4xf32> {
+  // CHECK: flow.dispatch @ex::@small0
+  // CHECK-SAME: stream.affinity = #hal.affinity.queue<[0]>
+  %0 = flow.dispatch @ex::@small0(%arg0) : (tensor<4xf32>) -> tensor<4xf32>
+  // CHECK: flow.dispatch @ex::@large
+  // CHECK-SAME: stream.affinity = #hal.affinity.queue<[1]>
+  %1 = flow.dispatch @ex::@large(%arg1, %0) : (tensor<1024x4xf32>, tensor<4xf32>) -> tensor<4xf32>
+  // CHECK: flow.dispatch @ex::@pinned
+  // CHECK-SAME: stream.affinity = #hal.affinity.queue<[4]>
+  %2 = flow.dispatch @ex::@pinned(%1) {stream.affinity = #hal.affinity.queue<[4]>} : (tensor<4xf32>) -> tensor<4xf32>
+  // CHECK: flow.dispatch @ex::@small1
+  // CHECK-SAME: stream.affinity = #hal.affinity.queue<[1]>
+  %3 = flow.dispatch @ex::@small1(%2) : (tensor<4xf32>) -> tensor<4xf32>
+  return %3 : tensor<4xf32>
+}
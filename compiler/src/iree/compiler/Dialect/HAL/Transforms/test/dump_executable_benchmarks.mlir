@@ -67,7 +67,7 @@ module attributes {hal.device.targets = [#device_target_cpu]}  {
   // CHECK-NEXT: util.global.store %[[BUFFER]], @ex0_embedded_elf_x86_64_dispatch0_512_buffer : !hal.buffer
 
   // CHECK: func.func @ex0_embedded_elf_x86_64_dispatch0_512(%arg0: i32)
-  // CHECK-SAME: attributes {iree.abi.stub, iree.reflection = {iree.benchmark = "dispatch"}} {
+  // CHECK-SAME: attributes {iree.abi.stub, iree.reflection = {iree.benchmark = "dispatch", iree.benchmark.dispatch_sites = "1"}} {
   // CHECK: %[[BATCH_SIZE:.+]] = arith.index_cast %arg0 : i32 to index
 
   // Create command buffer:
@@ -109,6 +109,7 @@ module attributes {hal.device.targets = [#device_target_cpu]}  {
 
   // CHECK: util.global private mutable @ex0_embedded_elf_x86_64_dispatch1_128x32_buffer : !hal.buffer
   // CHECK: func.func @ex0_embedded_elf_x86_64_dispatch1_128x32(%arg0: i32)
+  // CHECK-SAME: iree.benchmark.dispatch_sites = "2"
   // CHECK:   hal.command_buffer.dispatch.symbol<%{{.+}} : !hal.command_buffer> target(@ex0::@embedded_elf_x86_64::@dispatch1)
 
   func.func private @main() -> !stream.timepoint {
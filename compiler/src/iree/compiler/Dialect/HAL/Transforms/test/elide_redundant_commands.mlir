@@ -127,3 +127,213 @@ func.func @elidePushDescriptorSet(%cmd: !hal.command_buffer, %pipeline_layout: !
   // CHECK: return
   return
 }
+
+// -----
+
+// Tests that descriptors are tracked by binding ordinal and not by position.
+
+// CHECK-LABEL: @pushDescriptorSetOrdinals
+// CHECK-SAME: (%[[CMD:.+]]: !hal.command_buffer, %[[LAYOUT:.+]]: !hal.pipeline_layout, %[[BUFFER:.+]]: !hal.buffer)
+func.func @pushDescriptorSetOrdinals(%cmd: !hal.command_buffer, %pipeline_layout: !hal.pipeline_layout, %buffer: !hal.buffer) {
+  %c0 = arith.constant 0 : index
+  %c1 = arith.constant 1 : index
+  %size = arith.constant 100 : index
+  //      CHECK: hal.command_buffer.push_descriptor_set
+  // CHECK-NEXT:   %c0 = (%[[BUFFER]] : !hal.buffer)
+  hal.command_buffer.push_descriptor_set<%cmd : !hal.command_buffer> layout(%pipeline_layout : !hal.pipeline_layout)[%c0] bindings([
+    %c0 = (%buffer : !hal.buffer)[%c0, %size]
+  ])
+  //      CHECK: hal.command_buffer.push_descriptor_set
+  // CHECK-NEXT:   %c1 = (%[[BUFFER]] : !hal.buffer)
+  hal.command_buffer.push_descriptor_set<%cmd : !hal.command_buffer> layout(%pipeline_layout : !hal.pipeline_layout)[%c0] bindings([
+    %c1 = (%buffer : !hal.buffer)[%c0, %size]
+  ])
+  // CHECK-NOT: hal.command_buffer.push_descriptor_set
+  hal.command_buffer.push_descriptor_set<%cmd : !hal.command_buffer> layout(%pipeline_layout : !hal.pipeline_layout)[%c0] bindings([
+    %c1 = (%buffer : !hal.buffer)[%c0, %size]
+  ])
+  // CHECK: return
+  return
+}
+
+// -----
+
+// Tests that descriptors pushed with another layout are not reused.
+
+// CHECK-LABEL: @pushDescriptorSetLayoutChange
+func.func @pushDescriptorSetLayoutChange(%cmd: !hal.command_buffer, %pipeline_layout0: !hal.pipeline_layout, %pipeline_layout1: !hal.pipeline_layout, %buffer0: !hal.buffer, %buffer1: !hal.buffer) {
+  %c0 = arith.constant 0 : index
+  %c1 = arith.constant 1 : index
+  %size = arith.constant 100 : index
+  // CHECK: hal.command_buffer.push_descriptor_set
+  hal.command_buffer.push_descriptor_set<%cmd : !hal.command_buffer> layout(%pipeline_layout0 : !hal.pipeline_layout)[%c0] bindings([
+    %c0 = (%buffer0 : !hal.buffer)[%c0, %size]
+  ])
+  // CHECK: hal.command_buffer.push_descriptor_set
+  hal.command_buffer.push_descriptor_set<%cmd : !hal.command_buffer> layout(%pipeline_layout1 : !hal.pipeline_layout)[%c0] bindings([
+    %c1 = (%buffer1 : !hal.buffer)[%c0, %size]
+  ])
+  // CHECK: hal.command_buffer.push_descriptor_set
+  hal.command_buffer.push_descriptor_set<%cmd : !hal.command_buffer> layout(%pipeline_layout1 : !hal.pipeline_layout)[%c0] bindings([
+    %c0 = (%buffer0 : !hal.buffer)[%c0, %size],
+    %c1 = (%buffer1 : !hal.buffer)[%c0, %size]
+  ])
+  // CHECK: return
+  return
+}
+
+// -----
+
+// Tests that ops that can't record commands don't discard state while calls
+// do.
+
+// CHECK-LABEL: @elideAcrossUnrelatedOps
+func.func @elideAcrossUnrelatedOps(%cmd: !hal.command_buffer, %pipeline_layout: !hal.pipeline_layout, %value: i32) {
+  // CHECK: hal.command_buffer.push_constants
+  hal.command_buffer.push_constants<%cmd : !hal.command_buffer>
+      layout(%pipeline_layout : !hal.pipeline_layout)
+      offset(0)
+      values([%value]) : i32
+  // CHECK: arith.addi
+  %sum = arith.addi %value, %value : i32
+  // CHECK-NOT: hal.command_buffer.push_constants
+  hal.command_buffer.push_constants<%cmd : !hal.command_buffer>
+      layout(%pipeline_layout : !hal.pipeline_layout)
+      offset(0)
+      values([%value]) : i32
+  // CHECK: call @external
+  call @external() : () -> ()
+  // CHECK: hal.command_buffer.push_constants
+  hal.command_buffer.push_constants<%cmd : !hal.command_buffer>
+      layout(%pipeline_layout : !hal.pipeline_layout)
+      offset(0)
+      values([%value]) : i32
+  // CHECK: return
+  return
+}
+func.func private @external()
+
+// -----
+
+// Tests that state is carried into blocks with a single predecessor and
+// intersected at blocks with multiple predecessors.
+
+// CHECK-LABEL: @elideAcrossBlocks
+// CHECK-SAME: (%[[CMD:.+]]: !hal.command_buffer, %[[LAYOUT:.+]]: !hal.pipeline_layout, %[[COND:.+]]: i1, %[[VALUE0:.+]]: i32, %[[VALUE1:.+]]: i32)
+func.func @elideAcrossBlocks(%cmd: !hal.command_buffer, %pipeline_layout: !hal.pipeline_layout, %cond: i1, %value0: i32, %value1: i32) {
+  // CHECK: hal.command_buffer.push_constants{{.+}} values([%[[VALUE0]], %[[VALUE1]]])
+  hal.command_buffer.push_constants<%cmd : !hal.command_buffer>
+      layout(%pipeline_layout : !hal.pipeline_layout)
+      offset(0)
+      values([%value0, %value1]) : i32, i32
+  // CHECK: hal.command_buffer.execution_barrier
+  hal.command_buffer.execution_barrier<%cmd : !hal.command_buffer> source("Dispatch|Transfer|CommandRetire") target("CommandIssue|Dispatch|Transfer") flags("None")
+  cf.cond_br %cond, ^bb1, ^bb2
+// CHECK: ^bb1:
+^bb1:
+  // CHECK-NOT: hal.command_buffer.execution_barrier
+  hal.command_buffer.execution_barrier<%cmd : !hal.command_buffer> source("Dispatch|Transfer|CommandRetire") target("CommandIssue|Dispatch|Transfer") flags("None")
+  // CHECK-NOT: hal.command_buffer.push_constants
+  hal.command_buffer.push_constants<%cmd : !hal.command_buffer>
+      layout(%pipeline_layout : !hal.pipeline_layout)
+      offset(0)
+      values([%value0, %value1]) : i32, i32
+  cf.br ^bb3
+// CHECK: ^bb2:
+^bb2:
+  // CHECK: hal.command_buffer.push_constants{{.+}} offset(1) values([%[[VALUE0]]])
+  hal.command_buffer.push_constants<%cmd : !hal.command_buffer>
+      layout(%pipeline_layout : !hal.pipeline_layout)
+      offset(0)
+      values([%value0, %value0]) : i32, i32
+  cf.br ^bb3
+// CHECK: ^bb3:
+^bb3:
+  // Only the first constant is the same along both edges.
+  // CHECK: hal.command_buffer.push_constants{{.+}} offset(1) values([%[[VALUE1]]])
+  hal.command_buffer.push_constants<%cmd : !hal.command_buffer>
+      layout(%pipeline_layout : !hal.pipeline_layout)
+      offset(0)
+      values([%value0, %value1]) : i32, i32
+  // CHECK: return
+  return
+}
+
+// -----
+
+// Tests that state is not carried along loop back edges.
+
+// CHECK-LABEL: @noElideAcrossBackEdges
+func.func @noElideAcrossBackEdges(%cmd: !hal.command_buffer, %pipeline_layout: !hal.pipeline_layout, %cond: i1, %value0: i32, %value1: i32) {
+  // CHECK: hal.command_buffer.push_constants
+  hal.command_buffer.push_constants<%cmd : !hal.command_buffer>
+      layout(%pipeline_layout : !hal.pipeline_layout)
+      offset(0)
+      values([%value0]) : i32
+  cf.br ^bb1
+// CHECK: ^bb1:
+^bb1:
+  // CHECK: hal.command_buffer.push_constants
+  hal.command_buffer.push_constants<%cmd : !hal.command_buffer>
+      layout(%pipeline_layout : !hal.pipeline_layout)
+      offset(0)
+      values([%value0]) : i32
+  // CHECK: hal.command_buffer.push_constants
+  hal.command_buffer.push_constants<%cmd : !hal.command_buffer>
+      layout(%pipeline_layout : !hal.pipeline_layout)
+      offset(0)
+      values([%value1]) : i32
+  cf.cond_br %cond, ^bb1, ^bb2
+^bb2:
+  // CHECK: return
+  return
+}
+
+// -----
+
+// Tests that the trailing barrier of a command buffer that is submitted on
+// its own is elided.
+
+// CHECK-LABEL: @elideTrailingBarrier
+func.func @elideTrailingBarrier(%device: !hal.device, %affinity: i64, %wait_fence: !hal.fence, %signal_fence: !hal.fence, %buffer: !hal.buffer) {
+  %c0 = arith.constant 0 : index
+  %c100 = arith.constant 100 : index
+  %c0_i32 = arith.constant 0 : i32
+  %cmd = hal.command_buffer.create device(%device : !hal.device) mode(OneShot) categories("Transfer|Dispatch") : !hal.command_buffer
+  // CHECK: hal.command_buffer.fill_buffer
+  hal.command_buffer.fill_buffer<%cmd : !hal.command_buffer> target(%buffer : !hal.buffer)[%c0, %c100] pattern(%c0_i32 : i32)
+  // CHECK: hal.command_buffer.execution_barrier
+  hal.command_buffer.execution_barrier<%cmd : !hal.command_buffer> source("Dispatch|Transfer|CommandRetire") target("CommandIssue|Dispatch|Transfer") flags("None")
+  // CHECK: hal.command_buffer.fill_buffer
+  hal.command_buffer.fill_buffer<%cmd : !hal.command_buffer> target(%buffer : !hal.buffer)[%c0, %c100] pattern(%c0_i32 : i32)
+  // CHECK-NOT: hal.command_buffer.execution_barrier
+  hal.command_buffer.execution_barrier<%cmd : !hal.command_buffer> source("Dispatch|Transfer|CommandRetire") target("CommandIssue|Dispatch|Transfer") flags("None")
+  // CHECK: hal.command_buffer.finalize
+  hal.command_buffer.finalize<%cmd : !hal.command_buffer>
+  hal.device.queue.execute<%device : !hal.device> affinity(%affinity) wait(%wait_fence) signal(%signal_fence) commands([%cmd])
+  return
+}
+
+// -----
+
+// Tests that trailing barriers are kept if the command buffer is submitted
+// together with others or escapes.
+
+// CHECK-LABEL: @noElideTrailingBarrier
+func.func @noElideTrailingBarrier(%device: !hal.device, %affinity: i64, %wait_fence: !hal.fence, %signal_fence: !hal.fence, %buffer: !hal.buffer, %other_cmd: !hal.command_buffer) -> !hal.command_buffer {
+  %c0 = arith.constant 0 : index
+  %c100 = arith.constant 100 : index
+  %c0_i32 = arith.constant 0 : i32
+  %cmd0 = hal.command_buffer.create device(%device : !hal.device) mode(OneShot) categories("Transfer|Dispatch") : !hal.command_buffer
+  hal.command_buffer.fill_buffer<%cmd0 : !hal.command_buffer> target(%buffer : !hal.buffer)[%c0, %c100] pattern(%c0_i32 : i32)
+  // CHECK: hal.command_buffer.execution_barrier
+  hal.command_buffer.execution_barrier<%cmd0 : !hal.command_buffer> source("Dispatch|Transfer|CommandRetire") target("CommandIssue|Dispatch|Transfer") flags("None")
+  hal.command_buffer.finalize<%cmd0 : !hal.command_buffer>
+  hal.device.queue.execute<%device : !hal.device> affinity(%affinity) wait(%wait_fence) signal(%signal_fence) commands([%cmd0, %other_cmd])
+  %cmd1 = hal.command_buffer.create device(%device : !hal.device) mode(OneShot) categories("Transfer|Dispatch") : !hal.command_buffer
+  hal.command_buffer.fill_buffer<%cmd1 : !hal.command_buffer> target(%buffer : !hal.buffer)[%c0, %c100] pattern(%c0_i32 : i32)
+  // CHECK: hal.command_buffer.execution_barrier
+  hal.command_buffer.execution_barrier<%cmd1 : !hal.command_buffer> source("Dispatch|Transfer|CommandRetire") target("CommandIssue|Dispatch|Transfer") flags("None")
+  hal.command_buffer.finalize<%cmd1 : !hal.command_buffer>
+  return %cmd1 : !hal.command_buffer
+}
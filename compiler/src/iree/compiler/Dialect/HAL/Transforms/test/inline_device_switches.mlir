@@ -82,3 +82,24 @@ func.func @no_results(%device : !hal.device) {
   // CHECK-NEXT:  return
   return
 }
+
+// -----
+
+// CHECK-LABEL: @cpu_features
+// CHECK-SAME: %[[DEVICE:.+]]: !hal.device
+func.func @cpu_features(%device : !hal.device) -> i32 {
+  %c0 = arith.constant 0 : i32
+  %c1 = arith.constant 1 : i32
+  // CHECK: %{{.+}}, %[[HAS_DOTPROD:.+]] = hal.device.query<%[[DEVICE]] : !hal.device> key("hal.cpu" :: "dotprod") : i1, i1 = false
+  // CHECK: cf.cond_br %[[HAS_DOTPROD]], ^bb1(%{{.+}} : i32), ^bb1(%{{.+}} : i32)
+  %0 = hal.device.switch<%device : !hal.device> -> i32
+    #hal.device.match.cpu.feature<"dotprod"> {
+      hal.return %c1 : i32
+    },
+    #hal.match.always {
+      hal.return %c0 : i32
+    }
+  // CHECK: ^bb1(%[[RESULT:.+]]: i32):
+  // CHECK: return %[[RESULT]] : i32
+  return %0 : i32
+}
@@ -208,3 +208,42 @@ func.func @exeLookup(%device : !hal.device) -> !hal.executable {
 }
 
 }
+
+// -----
+
+// Variants specialized for CPU features are only loaded on processors that
+// report all of them and otherwise fall through to the next variant.
+
+#pipeline_layout = #hal.pipeline.layout<push_constants = 0, sets = [
+  #hal.descriptor_set.layout<0, bindings = [
+    #hal.descriptor_set.binding<0, storage_buffer>
+  ]>
+]>
+
+module attributes {hal.device.targets = [#hal.device.target<"llvm-cpu">]} {
+
+hal.executable @exe {
+  hal.executable.variant @avx512, target = <"llvm-cpu", "embedded-elf-x86_64", {
+    required_cpu_features = ["avx2_fma", "avx512_base"]
+  }> {
+    hal.executable.export @entry ordinal(0) layout(#pipeline_layout)
+  }
+  hal.executable.variant @generic, target = <"llvm-cpu", "embedded-elf-x86_64"> {
+    hal.executable.export @entry ordinal(0) layout(#pipeline_layout)
+  }
+}
+
+// CHECK: util.global private @_executable_exe : !hal.executable
+// CHECK-NEXT: util.initializer {
+// CHECK:   hal.device.switch
+// CHECK:   #hal.match.all<[#hal.device.match.executable.format<"embedded-elf-x86_64">, #hal.device.match.cpu.feature<"avx2_fma">, #hal.device.match.cpu.feature<"avx512_base">]> {
+// CHECK:     hal.executable.create
+// CHECK-SAME:  target(@exe::@avx512)
+// CHECK:   },
+// CHECK:   #hal.device.match.executable.format<"embedded-elf-x86_64"> {
+// CHECK:     hal.executable.create
+// CHECK-SAME:  target(@exe::@generic)
+// CHECK:   },
+// CHECK:   #hal.match.always {
+
+}
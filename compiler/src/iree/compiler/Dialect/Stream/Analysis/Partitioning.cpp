@@ -6,9 +6,13 @@
 
 #include "iree/compiler/Dialect/Stream/Analysis/Partitioning.h"
 
+#include "iree/compiler/Dialect/Stream/IR/StreamOps.h"
+#include "iree/compiler/Dialect/Util/IR/UtilTypes.h"
 #include "llvm/ADT/STLExtras.h"
 #include "llvm/Support/Debug.h"
+#include "llvm/Support/MathExtras.h"
 #include "mlir/IR/AsmState.h"
+#include "mlir/IR/Matchers.h"
 #include "mlir/IR/PatternMatch.h"
 
 #define DEBUG_TYPE "iree-stream-partitioning"
@@ -166,6 +170,51 @@ void PartitionSet::topologicalSort() {
   partitions = std::move(sortedSet);
 }
 
+// Relative cost of a dispatch with a single workgroup. Dispatches with static
+// workloads scale this by the workload and dynamic ones use a fixed scale.
+static constexpr int64_t kDispatchBaseCost = 256;
+static constexpr int64_t kDynamicDispatchWorkload = 64;
+// Number of bytes produced by a transfer op that costs about the same as a
+// single-workgroup dispatch.
+static constexpr int64_t kTransferBytesPerDispatch = 1024 * 1024;
+
+int64_t estimateStreamableOpCost(Operation *op) {
+  auto streamableOp = dyn_cast<IREE::Stream::StreamableOpInterface>(op);
+  if (!streamableOp || streamableOp.isMetadata()) return 0;
+  if (auto dispatchOp = dyn_cast<IREE::Stream::AsyncDispatchOp>(op)) {
+    int64_t workload = 1;
+    for (auto value : dispatchOp.getWorkload()) {
+      APInt staticValue;
+      if (!matchPattern(value, m_ConstantInt(&staticValue))) {
+        workload = kDynamicDispatchWorkload;
+        break;
+      }
+      int64_t dimension = std::max<int64_t>(1, staticValue.getSExtValue());
+      if (llvm::MulOverflow(workload, dimension, workload)) {
+        return INT64_MAX / 2;
+      }
+    }
+    int64_t cost = 0;
+    if (llvm::MulOverflow(kDispatchBaseCost, workload, cost)) {
+      return INT64_MAX / 2;
+    }
+    return cost;
+  }
+  if (auto sizeAwareOp = dyn_cast<IREE::Util::SizeAwareOpInterface>(op)) {
+    if (op->getNumResults() > 0) {
+      APInt staticSize;
+      if (auto resultSize = sizeAwareOp.getResultSize(0)) {
+        if (matchPattern(resultSize, m_ConstantInt(&staticSize))) {
+          return 1 + staticSize.getSExtValue() /
+                         (kTransferBytesPerDispatch / kDispatchBaseCost);
+        }
+      }
+    }
+  }
+  // Unknown work; treat like a dispatch of unknown size.
+  return kDispatchBaseCost * kDynamicDispatchWorkload;
+}
+
 PartitionSet partitionStreamableOps(IREE::Stream::PartitioningConfigAttr config,
                                     Block *block) {
   // Only one algorithm today.
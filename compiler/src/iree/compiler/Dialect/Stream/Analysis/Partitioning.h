@@ -62,6 +62,16 @@ struct PartitionSet {
   void topologicalSort();
 };
 
+//===----------------------------------------------------------------------===//
+// Cost modeling
+//===----------------------------------------------------------------------===//
+
+// Returns a coarse relative estimate of the cost of executing |op| used to
+// balance partitions. Dispatches are weighted by their workload when it is
+// static and transfers by the number of bytes they produce. Estimates are
+// only meaningful relative to each other and not as a measure of time.
+int64_t estimateStreamableOpCost(Operation *op);
+
 //===----------------------------------------------------------------------===//
 // Stream partitioning algorithms
 //===----------------------------------------------------------------------===//
@@ -283,6 +283,9 @@ PartitionSet partitionRegionConcurrencyReference(
     unsigned ordinal;
     // Ops present in the wave; ops may be present in multiple waves.
     SetVector<Operation *> ops;
+    // Estimated cost of the most expensive op in the wave. As all ops in a
+    // wave execute concurrently this is the cost of the wave as a whole.
+    int64_t cost = 0;
   };
   SmallVector<std::unique_ptr<PartitionBuilder>> builders;
 
@@ -373,16 +376,38 @@ PartitionSet partitionRegionConcurrencyReference(
     opInfo.membership.resize(builders.size(), /*t=*/false);
 
     // No consumers - if there's any candidate then we'll go into that.
-    int firstCandidateOrdinal = favor == IREE::Stream::Favor::MaxConcurrency
-                                    ? candidates.find_first()
-                                    : candidates.find_last();
-    if (firstCandidateOrdinal != -1) {
-      LLVM_DEBUG(llvm::dbgs() << "Moving to last candidate wave "
-                              << firstCandidateOrdinal << " (continue)\n");
-      builders[firstCandidateOrdinal]->ops.insert(&op);
-      opInfo.membership.set(firstCandidateOrdinal);
-      opInfo.hazards.set(0, firstCandidateOrdinal);
-      opInfo.hazards.reset(firstCandidateOrdinal);
+    //
+    // When favoring concurrency we pick the candidate wave whose cost grows
+    // the least by adding the op: the total cost of the region is the sum of
+    // the wave costs and placing an expensive op alongside other expensive
+    // ops hides its cost while placing it next to cheap ops serializes it.
+    // Ties go to the wave nearest the consumers. When favoring peak memory we
+    // keep ops as close to their original position as possible.
+    int64_t opCost = estimateStreamableOpCost(&op);
+    int candidateOrdinal = -1;
+    if (favor == IREE::Stream::Favor::MaxConcurrency) {
+      int64_t bestCostIncrease = INT64_MAX;
+      for (auto ordinal : candidates.set_bits()) {
+        int64_t costIncrease =
+            std::max<int64_t>(0, opCost - builders[ordinal]->cost);
+        if (costIncrease < bestCostIncrease) {
+          candidateOrdinal = ordinal;
+          bestCostIncrease = costIncrease;
+          if (costIncrease == 0) break;
+        }
+      }
+    } else {
+      candidateOrdinal = candidates.find_last();
+    }
+    if (candidateOrdinal != -1) {
+      LLVM_DEBUG(llvm::dbgs() << "Moving to candidate wave " << candidateOrdinal
+                              << " (continue)\n");
+      auto &candidateBuilder = builders[candidateOrdinal];
+      candidateBuilder->ops.insert(&op);
+      candidateBuilder->cost = std::max(candidateBuilder->cost, opCost);
+      opInfo.membership.set(candidateOrdinal);
+      opInfo.hazards.set(0, candidateOrdinal);
+      opInfo.hazards.reset(candidateOrdinal);
       continue;
     }
 
@@ -394,6 +419,7 @@ PartitionSet partitionRegionConcurrencyReference(
     auto builder = std::make_unique<PartitionBuilder>();
     builder->ordinal = builders.size();
     builder->ops.insert(&op);
+    builder->cost = opCost;
     LLVM_DEBUG(llvm::dbgs() << "Created wave " << builder->ordinal << "\n");
     builders.push_back(std::move(builder));
   }
@@ -1289,7 +1289,6 @@ void AsyncSplatOp::getCanonicalizationPatterns(RewritePatternSet &results,
                                                MLIRContext *context) {
   // TODO(#6972): find splat+update-from and turn into fill.
   // TODO(#6972): find splat+copy-from and turn into fill.
-  // TODO(#6972): find splat+update-into and turn into alloca+fill+update.
   // TODO(#6972): find splat+copy-into and turn into alloca+fill+copy.
   // TODO(#6972): clone instead of sinking to common dominator.
   results.insert<SinkAllocaLikeOpToConsumers<AsyncSplatOp>>(context);
@@ -1468,6 +1467,71 @@ struct CombineSplatUpdateFromToFill : public OpRewritePattern<AsyncUpdateOp> {
   }
 };
 
+// Turns an update into a splat into an alloca with only the bytes outside of
+// the updated range filled. This avoids filling the bytes the update will
+// overwrite and leaves the updated range with undefined contents such that the
+// producer of the update can be placed directly into the target (as is common
+// with padding).
+//
+// Example:
+//  %0 = stream.async.splat %c123_i32 ... {%c256}
+//  %1 = stream.async.update %src, %0[%c64 to %c192]
+// ->
+//  %0 = stream.async.alloca ... {%c256}
+//  %1 = stream.async.fill %c123_i32, %0[%c0 to %c64 for %c64]
+//  %2 = stream.async.fill %c123_i32, %1[%c192 to %c256 for %c64]
+//  %3 = stream.async.update %src, %2[%c64 to %c192]
+struct SplitSplatUpdateIntoFills : public OpRewritePattern<AsyncUpdateOp> {
+  using OpRewritePattern::OpRewritePattern;
+  LogicalResult matchAndRewrite(AsyncUpdateOp updateOp,
+                                PatternRewriter &rewriter) const override {
+    auto splatOp =
+        updateOp.getTarget().getDefiningOp<IREE::Stream::AsyncSplatOp>();
+    if (!splatOp || !splatOp.getResult().hasOneUse()) return failure();
+    if (splatOp.getAffinityAttr() != updateOp.getAffinityAttr()) {
+      return failure();
+    }
+
+    auto loc = updateOp.getLoc();
+    auto resultType = updateOp.getResult().getType();
+    auto targetSize = updateOp.getTargetSize();
+    auto targetOffset = updateOp.getTargetOffset();
+    auto targetEnd = updateOp.getTargetEnd();
+    auto affinityAttr = updateOp.getAffinityAttr();
+    Value target = rewriter.create<IREE::Stream::AsyncAllocaOp>(
+        splatOp.getLoc(), resultType, targetSize, affinityAttr);
+
+    // Fill [0, offset) if the update does not start at the beginning.
+    if (!matchPattern(targetOffset, m_Zero())) {
+      auto zero = rewriter.create<arith::ConstantIndexOp>(loc, 0);
+      target = rewriter.create<IREE::Stream::AsyncFillOp>(
+          loc, resultType, target, targetSize, zero, targetOffset, targetOffset,
+          splatOp.getValue(), affinityAttr);
+    }
+
+    // Fill [end, size) if the update does not run to the end.
+    APInt endValue, sizeValue;
+    bool isEndStatic = matchPattern(targetEnd, m_ConstantInt(&endValue)) &&
+                       matchPattern(targetSize, m_ConstantInt(&sizeValue));
+    bool updatesToEnd = targetEnd == targetSize ||
+                        (isEndStatic && endValue.getZExtValue() ==
+                                            sizeValue.getZExtValue());
+    if (!updatesToEnd) {
+      auto length = rewriter.createOrFold<arith::SubIOp>(loc, targetSize,
+                                                         targetEnd);
+      target = rewriter.create<IREE::Stream::AsyncFillOp>(
+          loc, resultType, target, targetSize, targetEnd, targetSize, length,
+          splatOp.getValue(), affinityAttr);
+    }
+
+    rewriter.replaceOpWithNewOp<IREE::Stream::AsyncUpdateOp>(
+        updateOp, resultType, target, targetSize, targetOffset, targetEnd,
+        updateOp.getUpdate(), updateOp.getUpdateSize(), affinityAttr);
+    rewriter.eraseOp(splatOp);
+    return success();
+  }
+};
+
 // Turns slice+update-from into a copy.
 // This is equivalent behavior at runtime but better to schedule as a single
 // operation.
@@ -1513,9 +1577,8 @@ void AsyncUpdateOp::getCanonicalizationPatterns(RewritePatternSet &results,
                                                 MLIRContext *context) {
   // TODO(benvanik): turn into a transfer if target_size == update_size and
   //                 affinity/lifetime differ.
-  // TODO(#6972): updates into splats could become alloca + fill exclusive
-  //              region + update into undefined contents (used in padding).
   results.insert<CombineSplatUpdateFromToFill>(context);
+  results.insert<SplitSplatUpdateIntoFills>(context);
   results.insert<CombineSliceUpdateFromToCopy>(context);
   results.insert<ElideUnusedOp<AsyncUpdateOp>>(context);
 }
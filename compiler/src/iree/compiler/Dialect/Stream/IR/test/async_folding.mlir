@@ -133,6 +133,45 @@ func.func @CombineSplatUpdateFromToFill(%arg0: !stream.resource<*>, %arg1: index
 
 // -----
 
+// CHECK-LABEL: @SplitSplatUpdateIntoFills
+// CHECK-SAME: (%[[SRC:.+]]: !stream.resource<*>)
+func.func @SplitSplatUpdateIntoFills(%arg0: !stream.resource<*>) -> !stream.resource<*> {
+  %c64 = arith.constant 64 : index
+  %c128 = arith.constant 128 : index
+  %c192 = arith.constant 192 : index
+  %c256 = arith.constant 256 : index
+  %c123_i32 = arith.constant 123 : i32
+  // CHECK-NOT: stream.async.splat
+  // CHECK: %[[ALLOCA:.+]] = stream.async.alloca : !stream.resource<*>{%c256}
+  // CHECK: %[[HEAD:.+]] = stream.async.fill %c123_i32, %[[ALLOCA]][%c0 to %c64 for %c64] : i32 -> %[[ALLOCA]] as !stream.resource<*>{%c256}
+  // CHECK: %[[TAIL:.+]] = stream.async.fill %c123_i32, %[[HEAD]][%c192 to %c256 for %c64] : i32 -> %[[HEAD]] as !stream.resource<*>{%c256}
+  %0 = stream.async.splat %c123_i32 : i32 -> !stream.resource<*>{%c256}
+  // CHECK: %[[UPDATE:.+]] = stream.async.update %[[SRC]], %[[TAIL]][%c64 to %c192] : !stream.resource<*>{%c128} -> %[[TAIL]] as !stream.resource<*>{%c256}
+  %1 = stream.async.update %arg0, %0[%c64 to %c192] : !stream.resource<*>{%c128} -> %0 as !stream.resource<*>{%c256}
+  // CHECK: return %[[UPDATE]]
+  return %1 : !stream.resource<*>
+}
+
+// -----
+
+// CHECK-LABEL: @SplitSplatUpdateIntoTrailingFill
+// CHECK-SAME: (%[[SRC:.+]]: !stream.resource<*>)
+func.func @SplitSplatUpdateIntoTrailingFill(%arg0: !stream.resource<*>) -> !stream.resource<*> {
+  %c0 = arith.constant 0 : index
+  %c128 = arith.constant 128 : index
+  %c256 = arith.constant 256 : index
+  %c123_i32 = arith.constant 123 : i32
+  // CHECK: %[[ALLOCA:.+]] = stream.async.alloca : !stream.resource<*>{%c256}
+  // CHECK-NEXT: %[[TAIL:.+]] = stream.async.fill %c123_i32, %[[ALLOCA]][%c128 to %c256 for %c128]
+  %0 = stream.async.splat %c123_i32 : i32 -> !stream.resource<*>{%c256}
+  // CHECK-NEXT: %[[UPDATE:.+]] = stream.async.update %[[SRC]], %[[TAIL]][%c0 to %c128]
+  %1 = stream.async.update %arg0, %0[%c0 to %c128] : !stream.resource<*>{%c128} -> %0 as !stream.resource<*>{%c256}
+  // CHECK: return %[[UPDATE]]
+  return %1 : !stream.resource<*>
+}
+
+// -----
+
 // CHECK-LABEL: @CombineSliceUpdateFromToCopy
 func.func @CombineSliceUpdateFromToCopy(%arg0: !stream.resource<*>, %arg1: index, %arg2: !stream.resource<*>, %arg3: index) -> !stream.resource<*> {
   %c0 = arith.constant 0 : index
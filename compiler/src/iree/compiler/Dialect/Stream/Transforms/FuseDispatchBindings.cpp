@@ -4,7 +4,9 @@
 // See https://llvm.org/LICENSE.txt for license information.
 // SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
 
+#include <algorithm>
 #include <memory>
+#include <optional>
 #include <utility>
 
 #include "iree/compiler/Dialect/Stream/IR/StreamOps.h"
@@ -20,6 +22,7 @@
 #include "mlir/IR/Builders.h"
 #include "mlir/IR/BuiltinTypes.h"
 #include "mlir/IR/Diagnostics.h"
+#include "mlir/IR/Matchers.h"
 #include "mlir/Pass/Pass.h"
 
 #define DEBUG_TYPE "iree-stream-fuse-dispatch-bindings"
@@ -68,8 +71,48 @@ struct Binding {
   // An access bitfield with a union of all range accesses.
   IREE::Stream::ResourceAccessBitfield derivedAccess =
       IREE::Stream::ResourceAccessBitfield::None;
+
+  // Offsets of each correlated range relative to the lowest range offset at
+  // the dispatch site if they are constant and identical across all sites.
+  // When present the dispatch sites pass the lowest offset as a base operand
+  // and the relative offsets as uniform constants that FoldUniformOperands
+  // can inline into the executable.
+  std::optional<SmallVector<int64_t>> relativeOffsets;
 };
 
+// Returns the offsets of the ranges of |binding| relative to the lowest range
+// offset at each dispatch site if all sites are constant and agree.
+//
+// Example:
+//   site 0: @storage0: offset 100, 200, 300
+//   site 1: @storage0: offset 1100, 1200, 1300
+// ->
+//   relative offsets: +0, +100, +200
+static std::optional<SmallVector<int64_t>> findUniformRelativeOffsets(
+    const Binding &binding, ArrayRef<IREE::Stream::CmdDispatchOp> dispatchOps) {
+  // Single range bindings have nothing to rebase against.
+  if (binding.correlationMap.count() <= 1) return std::nullopt;
+  std::optional<SmallVector<int64_t>> uniformOffsets;
+  for (auto dispatchOp : dispatchOps) {
+    SmallVector<int64_t> offsets;
+    for (auto &range : binding.sites[dispatchOp]) {
+      APInt offset;
+      if (!matchPattern(range.offset, m_ConstantInt(&offset))) {
+        return std::nullopt;
+      }
+      offsets.push_back(offset.getSExtValue());
+    }
+    int64_t baseOffset = *std::min_element(offsets.begin(), offsets.end());
+    for (auto &offset : offsets) offset -= baseOffset;
+    if (!uniformOffsets) {
+      uniformOffsets = std::move(offsets);
+    } else if (*uniformOffsets != offsets) {
+      return std::nullopt;
+    }
+  }
+  return uniformOffsets;
+}
+
 // Builds a set of fused bindings based on dispatches.
 // Each dispatch may have a unique binding set and we conservatively fuse only
 // those we can prove are the same. We could in the future introduce new entry
@@ -165,6 +208,7 @@ static SmallVector<Binding> findCorrelatedBindings(
         binding.derivedAccess = binding.derivedAccess | range.access;
       }
     }
+    binding.relativeOffsets = findUniformRelativeOffsets(binding, dispatchOps);
     bindings.push_back(binding);
   }
   return bindings;
@@ -203,9 +247,16 @@ static void updateExecutableSignature(IREE::Stream::ExecutableOp executableOp,
   }
 
   // Replace uses of the old args with the new args and update the ranges.
+  // Bindings with relative offsets take an additional base offset that is
+  // added to all of their ranges.
   unsigned offsetIdx = newBindingArgs.back().getArgNumber() + 1;
   for (auto binding : llvm::enumerate(bindings)) {
     auto newBindingArg = newBindingArgs[binding.index()];
+    BlockArgument baseOffsetArg;
+    if (binding.value().relativeOffsets) {
+      baseOffsetArg = entryBlock.insertArgument(offsetIdx++, offsetType,
+                                                newBindingArg.getLoc());
+    }
     for (unsigned oldIdx : binding.value().correlationMap.set_bits()) {
       auto oldBindingArg = oldBindingArgs[oldIdx];
       auto offsetArg = entryBlock.insertArgument(offsetIdx++, offsetType,
@@ -214,8 +265,12 @@ static void updateExecutableSignature(IREE::Stream::ExecutableOp executableOp,
         if (auto subspanOp =
                 dyn_cast<IREE::Stream::BindingSubspanOp>(use.getOwner())) {
           OpBuilder builder(subspanOp);
-          auto sum = builder.createOrFold<arith::AddIOp>(
+          Value sum = builder.createOrFold<arith::AddIOp>(
               newBindingArg.getLoc(), subspanOp.getByteOffset(), offsetArg);
+          if (baseOffsetArg) {
+            sum = builder.createOrFold<arith::AddIOp>(newBindingArg.getLoc(),
+                                                      sum, baseOffsetArg);
+          }
           subspanOp.getByteOffsetMutable().assign(sum);
         }
         use.set(newBindingArg);
@@ -233,28 +288,30 @@ static void updateExecutableSignature(IREE::Stream::ExecutableOp executableOp,
                                    entryBlock.getArgumentTypes(), {}));
 }
 
-// Memoization of constant 0 (that we insert a lot) with special handling for
-// insertion outside of the parent stream.cmd.execute region.
-struct MemoizedCmdZeros {
-  DenseMap<Operation *, Value> parentZeros;
-  Value getForOp(Operation *op) {
+// Memoization of index constants (of which we insert a lot of 0s) with special
+// handling for insertion outside of the parent stream.cmd.execute region.
+struct MemoizedCmdConstants {
+  DenseMap<std::pair<Operation *, int64_t>, Value> parentConstants;
+  Value getForOp(Operation *op, int64_t value) {
     auto parentOp = op->getParentOfType<IREE::Stream::CmdExecuteOp>();
-    auto it = parentZeros.find(parentOp);
-    if (it != parentZeros.end()) {
+    auto key = std::make_pair(parentOp.getOperation(), value);
+    auto it = parentConstants.find(key);
+    if (it != parentConstants.end()) {
       return it->second;
     }
-    auto zero =
-        OpBuilder(parentOp).create<arith::ConstantIndexOp>(op->getLoc(), 0);
-    parentZeros[parentOp] = zero;
-    return zero;
+    auto constant =
+        OpBuilder(parentOp).create<arith::ConstantIndexOp>(op->getLoc(), value);
+    parentConstants[key] = constant;
+    return constant;
   }
+  Value getZeroForOp(Operation *op) { return getForOp(op, 0); }
 };
 
 // Updates each stream.cmd.dispatch site to use the new binding scheme.
 static void updateDispatchSite(IREE::Stream::CmdDispatchOp dispatchOp,
                                ArrayRef<Binding> bindings,
-                               MemoizedCmdZeros &memoizedZeros) {
-  auto zero = memoizedZeros.getForOp(dispatchOp);
+                               MemoizedCmdConstants &memoizedConstants) {
+  auto zero = memoizedConstants.getZeroForOp(dispatchOp);
 
   // Compute the new binding set with any additional operands we may insert to
   // track offsets.
@@ -279,8 +336,21 @@ static void updateDispatchSite(IREE::Stream::CmdDispatchOp dispatchOp,
     // We could be more selective about what we add but doing it like this and
     // relying on dispatch site specialization allows us to reuse that pass to
     // better deduplicate and inline values.
-    for (auto &range : ranges) {
-      newOperands.push_back(range.offset);
+    if (binding.relativeOffsets) {
+      // Pass the lowest offset as the base and the uniform offsets of the
+      // ranges relative to it. The range with relative offset 0 is the base.
+      auto &relativeOffsets = *binding.relativeOffsets;
+      auto *baseIt = llvm::find(relativeOffsets, 0);
+      newOperands.push_back(
+          ranges[std::distance(relativeOffsets.begin(), baseIt)].offset);
+      for (int64_t relativeOffset : relativeOffsets) {
+        newOperands.push_back(
+            memoizedConstants.getForOp(dispatchOp, relativeOffset));
+      }
+    } else {
+      for (auto &range : ranges) {
+        newOperands.push_back(range.offset);
+      }
     }
 
     // New binding has full resource range. We could use min/max to get a
@@ -313,7 +383,7 @@ static void fuseDispatchBindings(
     IREE::Stream::ExecutableOp executableOp,
     IREE::Stream::ExecutableExportOp exportOp,
     ArrayRef<IREE::Stream::CmdDispatchOp> dispatchOps,
-    bool aliasMutableBindings, MemoizedCmdZeros &memoizedZeros) {
+    bool aliasMutableBindings, MemoizedCmdConstants &memoizedConstants) {
   if (dispatchOps.empty()) return;  // no-op if no dispatches
   auto anyDispatchOp = dispatchOps.front();
   unsigned bindingCount = anyDispatchOp.getResources().size();
@@ -370,23 +440,11 @@ static void fuseDispatchBindings(
     }
   });
 
-  // TODO(benvanik): some special handling for finding least-common-denominator
-  // or base values for constants passed in. We can end up with a lot of
-  // subranges into transient or constant resources that are all relatively
-  // correlated:
-  //   operand[0]: @storage0: offset 100
-  //   operand[1]: @storage0: offset 200
-  //   operand[2]: @storage0: offset 300
-  // ->
-  //   operand[0]: @storage0: offset +0
-  //   operand[1]: @storage0: offset +100
-  //   operand[2]: @storage0: offset +200
-  // Identifying these and using those relative offsets would make it cheaper to
-  // inline the values into the executables as they are not dispatch site
-  // specific. We'd do this by going per range and finding uniformly constant
-  // values. See the old MaterializeInterfaces.cpp pass for an earlier
-  // implementation that was special-cased for constant buffers only: here we
-  // can do it for everything.
+  // NOTE: correlated ranges with constant offsets that differ per dispatch
+  // site only by a uniform base are passed as relative offsets (see
+  // findUniformRelativeOffsets) so that they are no longer dispatch site
+  // specific and fold into the executable. Dynamic offsets that share a base
+  // value could be handled similarly but are left as-is today.
 
   // Update the executable function to use the new bindings.
   auto funcOp = exportOp.lookupFunctionRef();
@@ -396,7 +454,7 @@ static void fuseDispatchBindings(
   // Update each dispatch site to pass the new bindings and operands.
   // NOTE: this invalidates the bindings data structure!
   for (auto dispatchOp : dispatchOps) {
-    updateDispatchSite(dispatchOp, bindings, memoizedZeros);
+    updateDispatchSite(dispatchOp, bindings, memoizedConstants);
   }
   bindings.clear();  // invalidated above
 }
@@ -438,13 +496,13 @@ class FuseDispatchBindingsPass
 
     // Perform fusion for each executable entry point using all known dispatches
     // as source material.
-    MemoizedCmdZeros memoizedZeros;
+    MemoizedCmdConstants memoizedConstants;
     for (auto executableOp :
          getOperation().getBodyRegion().getOps<IREE::Stream::ExecutableOp>()) {
       for (auto exportOp :
            executableOp.getOps<IREE::Stream::ExecutableExportOp>()) {
         fuseDispatchBindings(executableOp, exportOp, entryDispatchMap[exportOp],
-                             aliasMutableBindings, memoizedZeros);
+                             aliasMutableBindings, memoizedConstants);
       }
     }
   }
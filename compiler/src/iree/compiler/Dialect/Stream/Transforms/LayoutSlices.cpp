@@ -5,6 +5,7 @@
 // SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
 
 #include <list>
+#include <numeric>
 
 #include "iree/compiler/Dialect/Stream/IR/StreamDialect.h"
 #include "iree/compiler/Dialect/Stream/IR/StreamOps.h"
@@ -15,7 +16,9 @@
 #include "iree/compiler/Dialect/Util/IR/UtilOps.h"
 #include "iree/compiler/Dialect/Util/IR/UtilTypes.h"
 #include "iree/compiler/Utils/IndexSet.h"
+#include "llvm/ADT/TypeSwitch.h"
 #include "llvm/Support/Debug.h"
+#include "llvm/Support/MathExtras.h"
 #include "mlir/Dialect/Arith/IR/Arith.h"
 #include "mlir/Dialect/Func/IR/FuncOps.h"
 #include "mlir/IR/AsmState.h"
@@ -63,31 +66,36 @@ static Value packSlicesWithNoAliasing(
   return builder.createOrFold<IREE::Util::AlignOp>(loc, offset, rangeAlignment);
 }
 
-// Packs a set of statically-sized slices by greedy strip packing.
+// Maximum number of static slices for which multiple packing heuristics are
+// evaluated. Each heuristic is O(n^2) in the number of slices and beyond this
+// we only run one to bound compile time.
+static constexpr size_t kMaxSlicesForHeuristicSearch = 4096;
+
+// Static offsets assigned to each slice by a packing heuristic.
+struct StaticLayout {
+  // Offset of each slice in the order slices were provided.
+  SmallVector<int64_t> offsets;
+  // Total number of bytes required by the layout (unaligned).
+  int64_t highwaterMark = 0;
+};
+
+// Packs a set of statically-sized slices by greedy strip packing visiting
+// slices in |order|.
 //
 // This is the same algorithm used in tflite here:
 // https://github.com/tensorflow/tensorflow/blob/master/tensorflow/lite/simple_memory_arena.cc
-// It's not fantastic and can end up with a significant amount of wastage.
-// They do the packing at runtime and as such care more about performance than
-// we do while doing the packing here offline. For this initial version I
-// wanted to ensure we matched apples/apples their implementation.
+// It's not fantastic and can end up with a significant amount of wastage
+// depending on the order slices are placed in. See packStaticSlices for how we
+// pick the order.
 //
-// We should use a set of heuristics and pick the smallest one. There are also
-// some really great papers that have approximations (as all of these are -
-// 2D strip packing is NP-hard) such as
+// There are also some really great papers that have approximations (as all of
+// these are - 2D strip packing is NP-hard) such as
 // https://www.sciencedirect.com/science/article/pii/S0925772113001016 that
 // someone with a brain able to parse mathy papers can try implementing.
-//
-// Slice packed offset SSA values will be updated and start at the given
-// |baseOffset|. Returns |baseOffset| + the total size of the allocation
-// aligned to the requirements of |resourceConfig|.
-static Value packStaticSlicesGreedily(
-    IREE::Stream::ResourcePackOp packOp, Value baseOffset,
-    ArrayRef<Slice> slices, IREE::Stream::ResourceConfigAttr resourceConfig,
-    IndexSet &indexSet, OpBuilder &builder) {
-  int64_t offsetAlignment = resourceConfig.getMinBufferOffsetAlignment();
-  int64_t rangeAlignment = resourceConfig.getMinBufferRangeAlignment();
-
+static StaticLayout packStaticSlicesGreedily(ArrayRef<Slice> slices,
+                                             ArrayRef<int64_t> alignedSizes,
+                                             ArrayRef<unsigned> order,
+                                             int64_t offsetAlignment) {
   struct Reservation {
     const Slice *slice = nullptr;
     int64_t staticOffset = 0;
@@ -95,14 +103,14 @@ static Value packStaticSlicesGreedily(
   };
   static constexpr int64_t UNASSIGNED = INT64_MAX;
 
+  StaticLayout layout;
+  layout.offsets.resize(slices.size(), 0);
   std::list<Reservation> reservations;
-  int64_t highwaterMark = 0;
-  for (auto &slice : slices) {
+  for (unsigned sliceIndex : order) {
+    const Slice &slice = slices[sliceIndex];
     int64_t bestOffset = UNASSIGNED;
     int64_t bestOffsetFit = UNASSIGNED;
-    int64_t staticSize =
-        cast<arith::ConstantIndexOp>(slice.dynamicSize.getDefiningOp()).value();
-    int64_t alignedSize = IREE::Util::align(staticSize, rangeAlignment);
+    int64_t alignedSize = alignedSizes[sliceIndex];
 
     // Iterate through reservations (sorted by ascending offset) and identify
     // gaps in which the slice will fit. To reduce wastage we want to find the
@@ -141,19 +149,187 @@ static Value packStaticSlicesGreedily(
       ++insertionIt;
     }
     reservations.insert(insertionIt, reservation);
-    slice.packedOffset.replaceAllUsesWith(builder.createOrFold<arith::AddIOp>(
-        packOp.getLoc(), baseOffset, indexSet.get(bestOffset)));
+    layout.offsets[sliceIndex] = bestOffset;
 
     // Update highwater mark indicating how much memory needs to be allocated
     // for the entire slab.
-    highwaterMark = std::max(highwaterMark, bestOffset + alignedSize);
+    layout.highwaterMark =
+        std::max(layout.highwaterMark, bestOffset + alignedSize);
+  }
+  return layout;
+}
+
+// Packs a set of statically-sized slices by running the greedy packer with
+// several slice orderings and keeping the layout with the smallest footprint.
+// The orderings are the usual ones for offline lifetime-interval allocation:
+//   - lifetime order (what tflite does at runtime);
+//   - decreasing size (best-fit decreasing), which avoids small early slices
+//     fragmenting the space large slices need;
+//   - decreasing lifetime length, which places long-lived slices at the
+//     bottom of the slab so short-lived ones can be stacked above them;
+//   - decreasing size * lifetime length (area in the offset/time plane).
+// Ties keep the earliest ordering so layouts are stable when searching does
+// not help.
+//
+// |staticSizes| contains the size of each slice in bytes. Slices with dynamic
+// sizes may be packed with their static upper bound.
+//
+// Slice packed offset SSA values will be updated and start at the given
+// |baseOffset|. Returns |baseOffset| + the total size of the allocation
+// aligned to the requirements of |resourceConfig|.
+static Value packStaticSlices(IREE::Stream::ResourcePackOp packOp,
+                              Value baseOffset, ArrayRef<Slice> slices,
+                              ArrayRef<int64_t> staticSizes,
+                              IREE::Stream::ResourceConfigAttr resourceConfig,
+                              IndexSet &indexSet, OpBuilder &builder) {
+  int64_t offsetAlignment = resourceConfig.getMinBufferOffsetAlignment();
+  int64_t rangeAlignment = resourceConfig.getMinBufferRangeAlignment();
+
+  SmallVector<int64_t> alignedSizes;
+  alignedSizes.reserve(slices.size());
+  for (int64_t staticSize : staticSizes) {
+    alignedSizes.push_back(IREE::Util::align(staticSize, rangeAlignment));
   }
+  auto lifetimeLength = [&](unsigned i) {
+    return slices[i].lifetimeEnd - slices[i].lifetimeStart + 1;
+  };
 
-  highwaterMark = IREE::Util::align(highwaterMark, rangeAlignment);
+  SmallVector<unsigned> lifetimeOrder(slices.size());
+  std::iota(lifetimeOrder.begin(), lifetimeOrder.end(), 0u);
+  StaticLayout bestLayout = packStaticSlicesGreedily(
+      slices, alignedSizes, lifetimeOrder, offsetAlignment);
+
+  if (slices.size() > 1 && slices.size() <= kMaxSlicesForHeuristicSearch) {
+    auto tryOrder = [&](auto comparator) {
+      SmallVector<unsigned> order = lifetimeOrder;
+      std::stable_sort(order.begin(), order.end(), comparator);
+      StaticLayout layout = packStaticSlicesGreedily(
+          slices, alignedSizes, order, offsetAlignment);
+      if (layout.highwaterMark < bestLayout.highwaterMark) {
+        bestLayout = std::move(layout);
+      }
+    };
+    tryOrder([&](unsigned lhs, unsigned rhs) {
+      return alignedSizes[lhs] > alignedSizes[rhs];
+    });
+    tryOrder([&](unsigned lhs, unsigned rhs) {
+      return std::make_pair(lifetimeLength(lhs), alignedSizes[lhs]) >
+             std::make_pair(lifetimeLength(rhs), alignedSizes[rhs]);
+    });
+    tryOrder([&](unsigned lhs, unsigned rhs) {
+      return alignedSizes[lhs] * lifetimeLength(lhs) >
+             alignedSizes[rhs] * lifetimeLength(rhs);
+    });
+  }
+  LLVM_DEBUG(llvm::dbgs() << "packed " << slices.size()
+                          << " static slices into " << bestLayout.highwaterMark
+                          << " bytes\n");
+
+  for (auto it : llvm::enumerate(slices)) {
+    it.value().packedOffset.replaceAllUsesWith(
+        builder.createOrFold<arith::AddIOp>(
+            packOp.getLoc(), baseOffset,
+            indexSet.get(bestLayout.offsets[it.index()])));
+  }
+
+  int64_t highwaterMark =
+      IREE::Util::align(bestLayout.highwaterMark, rangeAlignment);
   return builder.createOrFold<arith::AddIOp>(packOp.getLoc(), baseOffset,
                                              indexSet.get(highwaterMark));
 }
 
+// Maximum depth of the size expression walked when deriving upper bounds.
+static constexpr unsigned kMaxUpperBoundDepth = 16;
+
+// Returns a static upper bound on the non-negative index |value| derived
+// structurally from the ops producing it, if one can be found. Dynamic sizes
+// are computed from shape dimensions that are usually unbounded but programs
+// clamping their inputs (`arith.minui %dim, %c512`, selects between buckets,
+// etc) produce sizes that are bounded by constants.
+static Optional<int64_t> computeStaticUpperBound(Value value,
+                                                 unsigned depth = 0) {
+  if (depth > kMaxUpperBoundDepth) return std::nullopt;
+  APInt constantValue;
+  if (matchPattern(value, m_ConstantInt(&constantValue))) {
+    if (constantValue.isNegative()) return std::nullopt;
+    return constantValue.getSExtValue();
+  }
+  Operation *op = value.getDefiningOp();
+  if (!op) return std::nullopt;
+  auto operandBound = [&](unsigned i) {
+    return computeStaticUpperBound(op->getOperand(i), depth + 1);
+  };
+  auto allOperandBounds = [&]() -> Optional<SmallVector<int64_t>> {
+    SmallVector<int64_t> bounds;
+    for (unsigned i = 0; i < op->getNumOperands(); ++i) {
+      auto bound = operandBound(i);
+      if (!bound) return std::nullopt;
+      bounds.push_back(*bound);
+    }
+    return bounds;
+  };
+  return TypeSwitch<Operation *, Optional<int64_t>>(op)
+      .Case<arith::IndexCastOp, arith::IndexCastUIOp>(
+          [&](auto op) { return operandBound(0); })
+      .Case<arith::AddIOp>([&](auto op) -> Optional<int64_t> {
+        auto bounds = allOperandBounds();
+        int64_t result = 0;
+        if (!bounds || llvm::AddOverflow((*bounds)[0], (*bounds)[1], result)) {
+          return std::nullopt;
+        }
+        return result;
+      })
+      .Case<arith::MulIOp>([&](auto op) -> Optional<int64_t> {
+        auto bounds = allOperandBounds();
+        int64_t result = 0;
+        if (!bounds || llvm::MulOverflow((*bounds)[0], (*bounds)[1], result)) {
+          return std::nullopt;
+        }
+        return result;
+      })
+      .Case<arith::DivUIOp, arith::CeilDivUIOp>(
+          [&](auto op) -> Optional<int64_t> {
+            auto lhs = operandBound(0);
+            APInt divisor;
+            if (!lhs || !matchPattern(op.getRhs(), m_ConstantInt(&divisor)) ||
+                divisor.isZero() || divisor.isNegative()) {
+              return std::nullopt;
+            }
+            return llvm::divideCeil(*lhs, divisor.getZExtValue());
+          })
+      .Case<IREE::Util::AlignOp>([&](auto op) -> Optional<int64_t> {
+        auto bound = operandBound(0);
+        APInt alignment;
+        if (!bound ||
+            !matchPattern(op.getAlignment(), m_ConstantInt(&alignment)) ||
+            alignment.isZero() || alignment.isNegative()) {
+          return std::nullopt;
+        }
+        int64_t alignmentValue = alignment.getZExtValue();
+        if (*bound > INT64_MAX - alignmentValue) return std::nullopt;
+        return IREE::Util::align(*bound, alignmentValue);
+      })
+      .Case<arith::MinUIOp>([&](auto op) -> Optional<int64_t> {
+        // Any bounded operand bounds the result.
+        auto lhs = operandBound(0);
+        auto rhs = operandBound(1);
+        if (lhs && rhs) return std::min(*lhs, *rhs);
+        return lhs ? lhs : rhs;
+      })
+      .Case<arith::MaxUIOp>([&](auto op) -> Optional<int64_t> {
+        auto bounds = allOperandBounds();
+        if (!bounds) return std::nullopt;
+        return std::max((*bounds)[0], (*bounds)[1]);
+      })
+      .Case<arith::SelectOp>([&](auto op) -> Optional<int64_t> {
+        auto trueBound = operandBound(1);
+        auto falseBound = operandBound(2);
+        if (!trueBound || !falseBound) return std::nullopt;
+        return std::max(*trueBound, *falseBound);
+      })
+      .Default([](Operation *) { return std::nullopt; });
+}
+
 // Packs a set of dynamically-sized slices based on the structural information
 // in the IR. Only slices that have the exact same size will be allowed to
 // alias.
@@ -260,24 +436,57 @@ class LayoutSlicesPass : public LayoutSlicesBase<LayoutSlicesPass> {
       return;
     }
 
-    // NOTE: we could try several algorithms and compute which packs best. For
-    // now we just pack greedily as it's fast and what most existing ML
-    // frameworks do.
+    // NOTE: static (and statically bounded) slices are packed by trying
+    // several greedy orderings and picking the one that packs best; unbounded
+    // dynamic slices are conservatively bucketed by size.
     parentOp.walk([&](IREE::Stream::ResourcePackOp packOp) {
       // Derive resource constraints based on pack affinity.
       auto resourceConfig = IREE::Stream::ResourceConfigAttr::lookup(packOp);
 
       // Bucket into static and dynamic sizes. Static packing is a much more
-      // constrained problem.
+      // constrained problem. Dynamically-sized slices with a static upper
+      // bound are packed along with the static slices as if they were always
+      // their maximum size so that all of them share the single statically
+      // planned slab instead of each getting their own dynamic range.
       auto allSlices = packOp.getSlices();
+      SmallVector<Optional<int64_t>> staticSizeBounds;
+      staticSizeBounds.reserve(allSlices.size());
+      int64_t maxAllocationSize = resourceConfig.getMaxAllocationSize();
+      int64_t totalBoundedSize = 0;
+      for (auto &slice : allSlices) {
+        auto constantOp = dyn_cast_or_null<arith::ConstantIndexOp>(
+            slice.dynamicSize.getDefiningOp());
+        if (constantOp) {
+          staticSizeBounds.push_back(constantOp.value());
+          continue;
+        }
+        auto bound = computeStaticUpperBound(slice.dynamicSize);
+        if (bound &&
+            llvm::AddOverflow(totalBoundedSize, *bound, totalBoundedSize)) {
+          totalBoundedSize = INT64_MAX;
+        }
+        staticSizeBounds.push_back(bound);
+      }
+
+      // If the bounds are so large that the bounded slices may not fit within
+      // a single allocation (even before any aliasing) then we pack them
+      // dynamically instead.
+      bool packBoundedStatically = totalBoundedSize <= maxAllocationSize;
+
       SmallVector<Slice> staticSlices;
+      SmallVector<int64_t> staticSizes;
       SmallVector<Slice> dynamicSlices;
       staticSlices.reserve(allSlices.size());
+      staticSizes.reserve(allSlices.size());
       dynamicSlices.reserve(allSlices.size());
-      for (auto &slice : allSlices) {
-        if (isa_and_nonnull<arith::ConstantOp>(
-                slice.dynamicSize.getDefiningOp())) {
+      for (auto it : llvm::zip(allSlices, staticSizeBounds)) {
+        auto &slice = std::get<0>(it);
+        auto &bound = std::get<1>(it);
+        bool isConstant = isa_and_nonnull<arith::ConstantIndexOp>(
+            slice.dynamicSize.getDefiningOp());
+        if (bound && (isConstant || packBoundedStatically)) {
           staticSlices.push_back(slice);
+          staticSizes.push_back(*bound);
         } else {
           dynamicSlices.push_back(slice);
         }
@@ -290,8 +499,8 @@ class LayoutSlicesPass : public LayoutSlicesBase<LayoutSlicesPass> {
       // compile time.
       auto offset = packOp.getOffset() ? packOp.getOffset() : indexSet.get(0);
       if (!staticSlices.empty()) {
-        offset = packStaticSlicesGreedily(packOp, offset, staticSlices,
-                                          resourceConfig, indexSet, builder);
+        offset = packStaticSlices(packOp, offset, staticSlices, staticSizes,
+                                  resourceConfig, indexSet, builder);
 
         // TODO(benvanik): make this an option; it can be useful for debugging
         // this code.
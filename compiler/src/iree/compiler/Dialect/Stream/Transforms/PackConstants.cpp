@@ -4,6 +4,8 @@
 // See https://llvm.org/LICENSE.txt for license information.
 // SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
 
+#include <unordered_map>
+
 #include "iree/compiler/Dialect/Stream/IR/StreamDialect.h"
 #include "iree/compiler/Dialect/Stream/IR/StreamOps.h"
 #include "iree/compiler/Dialect/Stream/IR/StreamTypes.h"
@@ -13,6 +15,7 @@
 #include "iree/compiler/Dialect/Util/IR/UtilOps.h"
 #include "iree/compiler/Dialect/Util/IR/UtilTypes.h"
 #include "iree/compiler/Utils/IndexSet.h"
+#include "llvm/ADT/Hashing.h"
 #include "llvm/Support/Debug.h"
 #include "mlir/Dialect/Func/IR/FuncOps.h"
 #include "mlir/Dialect/SCF/IR/SCF.h"
@@ -79,37 +82,108 @@ struct StorageResource {
   uint64_t totalSize = 0;
   // Constant spans packed into this resource.
   SmallVector<PackedSpan, 8> spans;
+  // Constant spans with contents identical to one of |spans| that reference
+  // its data instead of storing their own copy.
+  SmallVector<PackedSpan> aliasedSpans;
   // Packed byte data that must be embedded in the final module.
   // It must be written with an alignment as required by the constraints.
   IREE::Util::CompositeAttr data;
 };
 
+// Returns true if |lhs| and |rhs| are known to have identical storage bytes.
+static bool isIdenticalConstantData(Attribute lhs, Attribute rhs) {
+  if (lhs == rhs) return true;
+  // Element types and shapes may differ while the bytes are identical (i8
+  // tables vs the same bytes as i32, etc). Splats only store a single element
+  // and are excluded as the storage size would not match the raw data.
+  auto lhsDense = lhs.dyn_cast<DenseElementsAttr>();
+  auto rhsDense = rhs.dyn_cast<DenseElementsAttr>();
+  if (!lhsDense || !rhsDense || lhsDense.isSplat() || rhsDense.isSplat()) {
+    return false;
+  }
+  return lhsDense.getRawData() == rhsDense.getRawData();
+}
+
+// Returns a hash of the storage bytes of |value| consistent with
+// isIdenticalConstantData.
+static llvm::hash_code hashConstantData(Attribute value) {
+  auto denseAttr = value.dyn_cast<DenseElementsAttr>();
+  if (!denseAttr || denseAttr.isSplat()) return llvm::hash_value(value);
+  auto rawData = denseAttr.getRawData();
+  return llvm::hash_combine_range(rawData.begin(), rawData.end());
+}
+
 // Buckets |slices| into 1+ storage resources based on |resourceConfig|.
+// Each slice is placed into the storage resource that leaves the least space
+// remaining (best-fit) and a new one is created only when none can fit it. As
+// slices are appended in order this maintains the original order (and its
+// locality) when everything fits within a single resource.
+//
+// If |allowAliasing| is true then slices with storage identical to a
+// previously packed slice reference the existing data instead of storing
+// another copy. This is only valid for immutable resources.
 static SmallVector<StorageResource, 8> bucketValuesIntoStorageResources(
     ArrayRef<ConstantSlice> slices,
-    IREE::Stream::ResourceConfigAttr resourceConfig) {
-  // TODO(benvanik): replace with a better strategy (best-fit, etc).
+    IREE::Stream::ResourceConfigAttr resourceConfig, bool allowAliasing) {
+  uint64_t offsetAlignment = resourceConfig.getMinBufferOffsetAlignment();
+  uint64_t rangeAlignment = resourceConfig.getMinBufferRangeAlignment();
+  uint64_t maxAllocationSize = resourceConfig.getMaxAllocationSize();
+
+  // Packed slices by content hash as (storage buffer, span) ordinals.
+  std::unordered_multimap<size_t, std::pair<size_t, size_t>> packedSpans;
+
   SmallVector<StorageResource, 8> storageBuffers;
-  storageBuffers.push_back({UnknownLoc::get(resourceConfig.getContext())});
-  StorageResource *currentBuffer = &storageBuffers.back();
   for (auto slice : slices) {
-    uint64_t offset = IREE::Util::align(
-        currentBuffer->totalSize, resourceConfig.getMinBufferOffsetAlignment());
     uint64_t unpaddedLength = slice.getStorageSize();
-    uint64_t paddedLength = IREE::Util::align(
-        unpaddedLength, resourceConfig.getMinBufferRangeAlignment());
-    if (offset + unpaddedLength > resourceConfig.getMaxAllocationSize()) {
+
+    // Reuse the storage of a previously packed span with the same contents.
+    size_t contentHash = 0;
+    if (allowAliasing) {
+      contentHash = hashConstantData(slice.value);
+      bool didAlias = false;
+      auto range = packedSpans.equal_range(contentHash);
+      for (auto it = range.first; it != range.second; ++it) {
+        auto &storageBuffer = storageBuffers[it->second.first];
+        auto &existingSpan = storageBuffer.spans[it->second.second];
+        if (existingSpan.length == unpaddedLength &&
+            isIdenticalConstantData(existingSpan.slice.value, slice.value)) {
+          storageBuffer.aliasedSpans.push_back(
+              {slice, existingSpan.offset, unpaddedLength});
+          didAlias = true;
+          break;
+        }
+      }
+      if (didAlias) continue;
+    }
+
+    uint64_t paddedLength = IREE::Util::align(unpaddedLength, rangeAlignment);
+    size_t targetIndex = storageBuffers.size();
+    uint64_t targetOffset = 0;
+    uint64_t targetRemaining = UINT64_MAX;
+    for (auto it : llvm::enumerate(storageBuffers)) {
+      uint64_t offset =
+          IREE::Util::align(it.value().totalSize, offsetAlignment);
+      if (offset + unpaddedLength > maxAllocationSize) continue;
+      uint64_t remaining = maxAllocationSize - (offset + unpaddedLength);
+      if (remaining < targetRemaining) {
+        targetIndex = it.index();
+        targetOffset = offset;
+        targetRemaining = remaining;
+      }
+    }
+    if (targetIndex == storageBuffers.size()) {
       // Spilling buffer; make a new one.
       storageBuffers.push_back({UnknownLoc::get(resourceConfig.getContext())});
-      currentBuffer = &storageBuffers.back();
-      offset = 0;
+      targetOffset = 0;
     }
-    currentBuffer->spans.push_back({slice, offset, unpaddedLength});
-    currentBuffer->totalSize =
-        std::max(currentBuffer->totalSize, offset + paddedLength);
-  }
-  if (storageBuffers.back().spans.empty()) {
-    storageBuffers.pop_back();
+    auto &targetBuffer = storageBuffers[targetIndex];
+    if (allowAliasing) {
+      packedSpans.insert(
+          {contentHash, {targetIndex, targetBuffer.spans.size()}});
+    }
+    targetBuffer.spans.push_back({slice, targetOffset, unpaddedLength});
+    targetBuffer.totalSize =
+        std::max(targetBuffer.totalSize, targetOffset + paddedLength);
   }
   return storageBuffers;
 }
@@ -185,9 +259,13 @@ static void packStorageResourceData(StorageResource &storageBuffer,
 // Assume that |slices| have been ordered by prior passes and that order may
 // have some performance-sensitivity (constants are grouped by
 // locality/lifetime/etc).
+//
+// If |allowAliasing| is true then slices with identical contents may share
+// storage.
 static SmallVector<StorageResource, 8> computePackingMap(
     ArrayRef<ConstantSlice> slices,
-    IREE::Stream::ResourceConfigAttr resourceConfig, MLIRContext *context) {
+    IREE::Stream::ResourceConfigAttr resourceConfig, bool allowAliasing,
+    MLIRContext *context) {
   // This is literally all my brain has brain for right now. The ideal here is
   // that we have a basic static (and ideally profile-guided) sorting pass
   // that keeps constant values that are accessed sorted together.
@@ -215,13 +293,15 @@ static SmallVector<StorageResource, 8> computePackingMap(
   // things around and waste on silly things like loading times).
   //
   // Here it's all descriptor sets and mapped pages but same thing pretty
-  // much, and passes earlier on may duplicate constants in the pool if it
-  // means they can improve locality at runtime. This pass doesn't dedupe and
-  // just sticks to packing for that reason.
+  // much, and passes earlier on may duplicate constants across pools if it
+  // means they can improve locality at runtime. Within a single pool there's
+  // no locality to be gained by storing the same bytes twice so immutable
+  // constants with identical contents (common with quantization scale and
+  // zero-point tables) share storage.
 
-  // Build a list of resources and spans (append to current or spill to new).
-  auto storageBuffers =
-      bucketValuesIntoStorageResources(slices, resourceConfig);
+  // Build a list of resources and spans (best-fit or spill to new).
+  auto storageBuffers = bucketValuesIntoStorageResources(slices, resourceConfig,
+                                                         allowAliasing);
 
   // Pack each storage resource bucket into a single data blob.
   for (auto &storageBuffer : storageBuffers) {
@@ -447,8 +527,10 @@ static Value generateUpload(IREE::Stream::ResourceConstantsOp constantsOp,
 
   // Perform the packing of dense values to compute the storage resources we
   // will need and where each value will be placed.
-  auto storageResources =
-      computePackingMap(slices, resourceConfig, constantsOp.getContext());
+  auto storageResources = computePackingMap(
+      slices, resourceConfig,
+      /*allowAliasing=*/lifetime == IREE::Stream::Lifetime::Constant,
+      constantsOp.getContext());
   if (storageResources.empty()) return nullptr;
 
   // Emit rodata storage for the constant values.
@@ -483,7 +565,8 @@ static Value generateUpload(IREE::Stream::ResourceConstantsOp constantsOp,
   for (auto it : llvm::zip_equal(storageResources, uploadResult.allocations)) {
     auto &storageResource = std::get<0>(it);
     auto &allocatedStorage = std::get<1>(it);
-    for (auto &span : storageResource.spans) {
+    for (auto &span : llvm::concat<PackedSpan>(storageResource.spans,
+                                               storageResource.aliasedSpans)) {
       auto loc = span.slice.result.getLoc();
       auto subviewOp = builder.create<IREE::Stream::ResourceSubviewOp>(
           loc, allocatedStorage.resource, allocatedStorage.resourceSize,
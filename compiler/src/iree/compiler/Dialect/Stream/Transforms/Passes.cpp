@@ -152,6 +152,12 @@ void buildStreamAsyncPassPipeline(OpPassManager &passManager,
   FunctionLikeNest(passManager)
       // Combine async work into execution regions.
       .addPass(IREE::Stream::createScheduleExecutionPass)
+      // Reorder work within regions that exceed the transient memory budget.
+      .addPredicatedPass(transformOptions.maxTransientSize > 0,
+                         [&]() {
+                           return IREE::Stream::createScheduleMemoryPass(
+                               transformOptions.maxTransientSize);
+                         })
       // Group concurrently executable work into waves.
       .addPass(IREE::Stream::createScheduleConcurrencyPass);
 
@@ -278,8 +284,10 @@ void buildStreamOptimizationPassPipeline(
   // Only want to specialize after we've added all the operands we need above.
   // TODO(benvanik): make codegen more efficient with the specialized
   // constants. The lookup tables inserted are currently extremely slow on
-  // some backends.
-  // passManager.addPass(IREE::Stream::createSpecializeDispatchesPass());
+  // some backends so this is opt-in.
+  if (transformOptions.specializeDispatches) {
+    passManager.addPass(IREE::Stream::createSpecializeDispatchesPass());
+  }
 
   // TODO(benvanik): when we spill push constants spill to staging buffers.
   // Need to know push constant limit but that could be specified as a stream
@@ -35,6 +35,25 @@ struct TransformOptions : public PassPipelineOptions<TransformOptions> {
       llvm::cl::init(true),
   };
 
+  Option<int64_t> maxTransientSize{
+      *this,
+      "max-transient-size",
+      llvm::cl::desc(
+          "Reorders work and rematerializes splats to keep the transient "
+          "memory of each execution region within this many bytes; 0 "
+          "disables memory-aware scheduling."),
+      llvm::cl::init(0),
+  };
+
+  Option<bool> specializeDispatches{
+      *this,
+      "specialize-dispatches",
+      llvm::cl::desc(
+          "Specializes executables on the constant operands passed at each "
+          "dispatch site using per-site constant tables."),
+      llvm::cl::init(false),
+  };
+
   Option<DumpOutputFormat> dumpStatisticsFormat{
       *this,
       "dump-statistics-format",
@@ -121,6 +140,8 @@ std::unique_ptr<OperationPass<mlir::ModuleOp>> createRefineUsagePass();
 
 std::unique_ptr<InterfacePass<CallableOpInterface>>
 createScheduleExecutionPass();
+std::unique_ptr<InterfacePass<CallableOpInterface>> createScheduleMemoryPass(
+    int64_t maxTransientSize = 0);
 std::unique_ptr<InterfacePass<CallableOpInterface>>
 createScheduleConcurrencyPass();
 
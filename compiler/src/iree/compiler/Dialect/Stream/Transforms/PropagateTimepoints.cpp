@@ -24,6 +24,7 @@
 #include "mlir/IR/BuiltinTypes.h"
 #include "mlir/IR/Diagnostics.h"
 #include "mlir/IR/Dominance.h"
+#include "mlir/IR/SymbolTable.h"
 #include "mlir/Pass/Pass.h"
 
 #define DEBUG_TYPE "iree-stream-propagate-timepoints"
@@ -589,6 +590,62 @@ static void expandTimepoints(Operation *op, ExpandedGlobalMap &globalMap,
   }
 }
 
+//===----------------------------------------------------------------------===//
+// Public call privatization
+//===----------------------------------------------------------------------===//
+
+// Returns true if |name| is an attribute describing the external ABI of a
+// function that must not be carried over to internal clones.
+static bool isExternalABIAttr(StringRef name) {
+  return name.startswith("iree.abi") || name.startswith("iree.reflection");
+}
+
+// Redirects calls to public functions defined within |rootOp| to private
+// clones. Public function signatures are fixed by the ABI and cannot carry
+// timepoints so every internal call into them would otherwise wait on its
+// resource arguments before the call and on its results before returning.
+// Programs composed of chained public functions (such as a decode loop calling
+// a public step function) end up with host waits on every call. The clones
+// have their signatures expanded like any other private function which lets
+// ElideTimepoints see through the call edges and chain execution across them.
+// External callers continue to use the original public function.
+//
+// Example:
+//  func.func @step(%0: !stream.resource) -> !stream.resource
+//  %1 = call @step(%0)
+//  ->
+//  func.func @step(%0: !stream.resource) -> !stream.resource
+//  func.func private @step__internal(%0: !stream.resource) -> !stream.resource
+//  %1 = call @step__internal(%0)
+static void privatizePublicCalls(mlir::ModuleOp rootOp) {
+  SmallVector<mlir::func::CallOp> callOps;
+  rootOp.walk([&](mlir::func::CallOp callOp) {
+    if (usesResources(callOp)) callOps.push_back(callOp);
+  });
+  if (callOps.empty()) return;
+
+  SymbolTable symbolTable(rootOp);
+  DenseMap<Operation *, mlir::func::FuncOp> internalClones;
+  for (auto callOp : callOps) {
+    auto calleeOp = symbolTable.lookup<mlir::func::FuncOp>(callOp.getCallee());
+    if (!calleeOp || !calleeOp.isPublic() || calleeOp.isExternal()) continue;
+    auto &cloneOp = internalClones[calleeOp];
+    if (!cloneOp) {
+      cloneOp = calleeOp.clone();
+      cloneOp.setName((calleeOp.getName() + "__internal").str());
+      cloneOp.setPrivate();
+      for (auto attr : llvm::to_vector(cloneOp->getAttrs())) {
+        if (isExternalABIAttr(attr.getName().getValue())) {
+          cloneOp->removeAttr(attr.getName());
+        }
+      }
+      // The symbol table uniques the name if it conflicts with another.
+      symbolTable.insert(cloneOp, std::next(Block::iterator(calleeOp)));
+    }
+    callOp.setCalleeAttr(FlatSymbolRefAttr::get(cloneOp));
+  }
+}
+
 //===----------------------------------------------------------------------===//
 // -iree-stream-propagate-timepoints
 //===----------------------------------------------------------------------===//
@@ -618,6 +675,10 @@ class PropagateTimepointsPass
   void runOnOperation() override {
     auto rootOp = getOperation();
 
+    // Route internal calls to public functions through private clones so that
+    // their signatures can be expanded.
+    privatizePublicCalls(rootOp);
+
     // Expand all util.global ops holding resources into (timepoint, resource).
     auto globalMap = expandResourceGlobals(rootOp);
 
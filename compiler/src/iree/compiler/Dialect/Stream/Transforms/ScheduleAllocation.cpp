@@ -14,6 +14,7 @@
 #include "iree/compiler/Dialect/Util/IR/UtilOps.h"
 #include "iree/compiler/Dialect/Util/IR/UtilTypes.h"
 #include "llvm/ADT/BitVector.h"
+#include "llvm/ADT/DenseSet.h"
 #include "llvm/Support/Debug.h"
 #include "mlir/Analysis/Liveness.h"
 #include "mlir/Dialect/Arith/IR/Arith.h"
@@ -118,6 +119,147 @@ static ValueAliasingMap computeExecutionRegionValueAliases(
   return valueAliases;
 }
 
+//===----------------------------------------------------------------------===//
+// Subrange alias analysis
+//===----------------------------------------------------------------------===//
+
+// A value whose storage is placed within a subrange of a base value.
+struct SubrangeAlias {
+  // Value stored within the base value.
+  Value value;
+  // Offset of the subrange within the base value in bytes.
+  Value offset;
+  // Length of the subrange in bytes.
+  Value length;
+};
+
+// Maps base values to the values stored within subranges of them.
+// Unlike ValueAliasingMap these aliases are not 1:1 full maps and each alias
+// is placed at its own offset within the base value storage.
+using ValueSubrangeAliasingMap =
+    llvm::MapVector<Value, SmallVector<SubrangeAlias>>;
+
+// Returns true if |lhs| and |rhs| are known to be equal.
+static bool isSameIndexValue(Value lhs, Value rhs) {
+  if (lhs == rhs) return true;
+  APInt lhsValue;
+  APInt rhsValue;
+  return matchPattern(lhs, m_ConstantInt(&lhsValue)) &&
+         matchPattern(rhs, m_ConstantInt(&rhsValue)) && lhsValue == rhsValue;
+}
+
+// Returns true if |value| is tied to any other value in |valueAliases|.
+static bool hasValueAliases(Value value, const ValueAliasingMap &valueAliases) {
+  auto it = valueAliases.find(value);
+  return it != valueAliases.end() && !it->second.empty();
+}
+
+// Returns true if any user of |value| writes to it in-place.
+static bool isWrittenInPlace(Value value) {
+  for (auto &use : value.getUses()) {
+    auto tiedOp = dyn_cast<IREE::Util::TiedOpInterface>(use.getOwner());
+    if (tiedOp &&
+        !tiedOp.getOperandTiedResults(use.getOperandNumber()).empty()) {
+      return true;
+    }
+  }
+  return false;
+}
+
+// Returns true if the result of |sliceOp| can reference the sliced range of
+// its source directly instead of being copied into its own storage. Neither
+// the source nor the result may be written while the result is live and the
+// result must not escape the region it is defined in.
+static bool canAliasSliceSource(IREE::Stream::AsyncSliceOp sliceOp,
+                                const ValueAliasingMap &valueAliases) {
+  auto result = sliceOp.getResult();
+  if (hasValueAliases(result, valueAliases)) return false;
+  for (auto *user : result.getUsers()) {
+    if (isa<IREE::Stream::YieldOp>(user)) return false;
+  }
+  return !isWrittenInPlace(sliceOp.getSource());
+}
+
+// Returns true if |value| can be produced directly into the range of |target|
+// that |consumerOp| would otherwise copy it into. |value| must be produced in
+// the same block only to be consumed by |consumerOp| and |target| must not be
+// used by anything else that could observe the range being written early.
+static bool canEmplaceIntoTarget(Value value, Value target,
+                                 Operation *consumerOp,
+                                 const ValueAliasingMap &valueAliases) {
+  if (!value.hasOneUse() || hasValueAliases(value, valueAliases)) {
+    return false;
+  }
+  auto *producerOp = value.getDefiningOp();
+  if (!producerOp || producerOp->getBlock() != consumerOp->getBlock()) {
+    return false;
+  }
+  // Constants are uploaded into their own storage and nested regions map their
+  // results through their yields.
+  if (isa<IREE::Stream::AsyncConstantOp, RegionBranchOpInterface>(producerOp)) {
+    return false;
+  }
+  if (!target.hasOneUse()) return false;
+  if (auto *targetOp = target.getDefiningOp()) {
+    return targetOp->getBlock() == producerOp->getBlock() &&
+           targetOp->isBeforeInBlock(producerOp);
+  }
+  return target.cast<BlockArgument>().getOwner() == producerOp->getBlock();
+}
+
+// Builds a map of base values to the values that can be stored within
+// subranges of them. This covers slices that can reference their source
+// directly as well as values that can be produced in-place into the target of
+// the update or in-place collective consuming them. Each value will alias at
+// most one base value.
+static ValueSubrangeAliasingMap computeExecutionRegionSubrangeAliases(
+    IREE::Stream::AsyncExecuteOp executeOp,
+    const ValueAliasingMap &valueAliases) {
+  ValueSubrangeAliasingMap subrangeAliases;
+  DenseSet<Value> aliasedValues;
+  auto addAlias = [&](Value base, Value value, Value offset, Value length) {
+    if (!aliasedValues.insert(value).second) return;
+    subrangeAliases[base].push_back(SubrangeAlias{value, offset, length});
+  };
+  executeOp.walk([&](Operation *op) {
+    if (auto sliceOp = dyn_cast<IREE::Stream::AsyncSliceOp>(op)) {
+      if (canAliasSliceSource(sliceOp, valueAliases)) {
+        addAlias(sliceOp.getSource(), sliceOp.getResult(),
+                 sliceOp.getSourceOffset(), sliceOp.getResultSize());
+      }
+    } else if (auto updateOp = dyn_cast<IREE::Stream::AsyncUpdateOp>(op)) {
+      if (canEmplaceIntoTarget(updateOp.getUpdate(), updateOp.getTarget(),
+                               updateOp, valueAliases)) {
+        addAlias(updateOp.getTarget(), updateOp.getUpdate(),
+                 updateOp.getTargetOffset(), updateOp.getUpdateSize());
+      }
+    } else if (auto collectiveOp =
+                   dyn_cast<IREE::Stream::AsyncCollectiveOp>(op)) {
+      // Only all-reduce sends and receives the same range on all participants
+      // and can have its send buffer be the recv buffer.
+      if (collectiveOp.getOp().getKind() !=
+          IREE::Stream::CollectiveKind::AllReduce) {
+        return;
+      }
+      if (!matchPattern(collectiveOp.getSourceOffset(), m_Zero()) ||
+          !isSameIndexValue(collectiveOp.getSourceLength(),
+                            collectiveOp.getSourceSize()) ||
+          !isSameIndexValue(collectiveOp.getSourceLength(),
+                            collectiveOp.getTargetLength())) {
+        return;
+      }
+      if (canEmplaceIntoTarget(collectiveOp.getSource(),
+                               collectiveOp.getTarget(), collectiveOp,
+                               valueAliases)) {
+        addAlias(collectiveOp.getTarget(), collectiveOp.getSource(),
+                 collectiveOp.getTargetOffset(),
+                 collectiveOp.getTargetLength());
+      }
+    }
+  });
+  return subrangeAliases;
+}
+
 //===----------------------------------------------------------------------===//
 // Liveness interval analysis
 //===----------------------------------------------------------------------===//
@@ -143,12 +285,14 @@ using LivenessIntervalList = SmallVector<LivenessInterval>;
 // output results).
 //
 // All values will have a range with aliased values sharing the union of their
-// constituent ranges - including block arguments. Note that not all values will
-// have buffers allocated to them - we are just tracking transitive SSA value
-// lifetime.
+// constituent ranges - including block arguments. Values with subrange aliases
+// are extended to cover the ranges of the values stored within them. Note that
+// not all values will have buffers allocated to them - we are just tracking
+// transitive SSA value lifetime.
 static LivenessIntervalList computeExecutionRegionLivenessIntervals(
     IREE::Stream::AsyncExecuteOp executeOp,
-    const ValueAliasingMap &valueAliases) {
+    const ValueAliasingMap &valueAliases,
+    const ValueSubrangeAliasingMap &subrangeAliases) {
   // Perform a liveness analysis on the execution region.
   // Fragments have a single block and as such the live-in/live-out block
   // information derived here applies to the entire stream region.
@@ -241,6 +385,36 @@ static LivenessIntervalList computeExecutionRegionLivenessIntervals(
     }
   }
 
+  // Extend base values to cover their subrange aliases. We walk in reverse so
+  // that aliases of aliases are folded into their immediate base first.
+  for (auto &it : llvm::reverse(subrangeAliases)) {
+    auto baseIt = valueIntervals.find(it.first);
+    if (baseIt == valueIntervals.end() || baseIt->second.ordinal == -1) {
+      // Base is nested; its aliases are scoped to the nested region.
+      continue;
+    }
+    int start = baseIt->second.start;
+    int end = baseIt->second.end;
+    for (auto &alias : it.second) {
+      auto aliasIt = valueIntervals.find(alias.value);
+      if (aliasIt == valueIntervals.end() || aliasIt->second.ordinal == -1) {
+        continue;
+      }
+      start = std::min(start, aliasIt->second.start);
+      end = std::max(end, aliasIt->second.end);
+    }
+    baseIt->second.start = start;
+    baseIt->second.end = end;
+    auto aliasersIt = valueAliases.find(it.first);
+    if (aliasersIt == valueAliases.end()) continue;
+    for (auto aliaser : aliasersIt->second) {
+      auto aliaserIt = valueIntervals.find(aliaser);
+      if (aliaserIt == valueIntervals.end()) continue;
+      aliaserIt->second.start = std::min(aliaserIt->second.start, start);
+      aliaserIt->second.end = std::max(aliaserIt->second.end, end);
+    }
+  }
+
   // Sort all intervals by lifetime start. This makes the intervals easier to
   // read and deterministic across runs.
   SmallVector<LivenessInterval> sortedIntervals;
@@ -302,7 +476,15 @@ static std::unique_ptr<AsmState> getRootAsmState(Operation *rootOp) {
 struct AllocationScope {
   explicit AllocationScope(IREE::Stream::AsyncExecuteOp rootAsyncOp)
       : rootOp(rootAsyncOp),
-        valueAliases(computeExecutionRegionValueAliases(rootAsyncOp)) {}
+        valueAliases(computeExecutionRegionValueAliases(rootAsyncOp)),
+        subrangeAliases(
+            computeExecutionRegionSubrangeAliases(rootAsyncOp, valueAliases)) {
+    for (auto &it : subrangeAliases) {
+      for (auto &alias : it.second) {
+        subrangeAliasValues.insert(alias.value);
+      }
+    }
+  }
 
   // Execution region being allocated.
   Operation *getRootOp() const { return rootOp; }
@@ -310,6 +492,18 @@ struct AllocationScope {
   // Aliasing map for the entire root op, indicating which values are tied.
   const ValueAliasingMap &getValueAliases() const { return valueAliases; }
 
+  // Subrange aliasing map for the entire root op, indicating which values are
+  // stored within the storage of others.
+  const ValueSubrangeAliasingMap &getSubrangeAliases() const {
+    return subrangeAliases;
+  }
+
+  // Returns true if |value| is stored within a subrange of another value and
+  // will be mapped along with it.
+  bool isSubrangeAlias(Value value) const {
+    return subrangeAliasValues.contains(value);
+  }
+
   // TODO(benvanik): rework this so that we don't do a switcheroo right in the
   // middle of processing.
   void replaceRootOp(IREE::Stream::CmdExecuteOp newOp) {
@@ -357,9 +551,10 @@ struct AllocationScope {
       llvm::dbgs() << "\n";
     });
 
-    // TODO(#5410): make alias propagation map through an indexing map for
-    // slices/updates. Right now we assume all aliases are 1:1 full maps.
-    for (auto alias : valueAliases[resource]) {
+    // Aliases in the value aliasing map are 1:1 full maps while subrange
+    // aliases are mapped through their offset into the range.
+    auto aliases = llvm::to_vector<4>(valueAliases[resource]);
+    for (auto alias : aliases) {
       resourceRangeMap.insert(std::make_pair(alias, resourceRange));
       LLVM_DEBUG({
         llvm::dbgs() << "   = alias ";
@@ -369,6 +564,30 @@ struct AllocationScope {
         llvm::dbgs() << "\n";
       });
     }
+    mapSubrangeAliases(resource, resourceRange, asmState);
+    for (auto alias : aliases) {
+      mapSubrangeAliases(alias, resourceRange, asmState);
+    }
+  }
+
+  // Maps all subrange aliases of |base| into |baseRange| at their offsets.
+  void mapSubrangeAliases(Value base, const ResourceRange &baseRange,
+                          AsmState *asmState) {
+    auto it = subrangeAliases.find(base);
+    if (it == subrangeAliases.end()) return;
+    for (auto &alias : it->second) {
+      LLVM_DEBUG({
+        llvm::dbgs() << "   = subrange alias ";
+        alias.value.printAsOperand(llvm::dbgs(), *asmState);
+        llvm::dbgs() << "\n";
+      });
+      mapResourceRange(alias.value,
+                       ResourceRange(baseRange.resource, baseRange.resourceSize,
+                                     add(alias.value.getLoc(), baseRange.offset,
+                                         alias.offset),
+                                     alias.length),
+                       asmState);
+    }
   }
 
   // Returns a storage range backing the given stream |resource|.
@@ -421,6 +640,11 @@ struct AllocationScope {
   // as equivalent: some values may be subranges of others.
   ValueAliasingMap valueAliases;
 
+  // All values that have values stored within subranges of them. Aliases are
+  // mapped at their offset within the base range when the base is mapped.
+  ValueSubrangeAliasingMap subrangeAliases;
+  DenseSet<Value> subrangeAliasValues;
+
   // Index value -> std.constant index value.
   DenseMap<int64_t, Value> indexConstantMap;
 
@@ -482,6 +706,12 @@ static LogicalResult applyAsyncCloneOp(IREE::Stream::AsyncCloneOp asyncOp,
 static LogicalResult applyAsyncSliceOp(IREE::Stream::AsyncSliceOp asyncOp,
                                        AllocationScope &scope,
                                        OpBuilder builder) {
+  // Slices aliasing their source reference the source range directly.
+  if (scope.isSubrangeAlias(asyncOp.getResult())) {
+    asyncOp.erase();
+    return success();
+  }
+
   auto sourceRange = scope.lookupResourceRange(asyncOp.getSource());
   auto sourceOffset = scope.add(asyncOp.getLoc(), sourceRange.offset,
                                 asyncOp.getSourceOffset());
@@ -510,6 +740,12 @@ static LogicalResult applyAsyncFillOp(IREE::Stream::AsyncFillOp asyncOp,
 static LogicalResult applyAsyncUpdateOp(IREE::Stream::AsyncUpdateOp asyncOp,
                                         AllocationScope &scope,
                                         OpBuilder builder) {
+  // Updates that were produced in-place into their target need no copy.
+  if (scope.isSubrangeAlias(asyncOp.getUpdate())) {
+    asyncOp.erase();
+    return success();
+  }
+
   auto sourceRange = scope.lookupResourceRange(asyncOp.getUpdate());
   auto sourceOffset = sourceRange.offset;
   auto targetRange = scope.lookupResourceRange(asyncOp.getResult());
@@ -549,8 +785,9 @@ static LogicalResult applyAsyncCollectiveOp(
   SmallVector<Value> newResourceLengths;
   SmallVector<Attribute> newResourceAccesses;
 
-  // TODO(#11249): support in-place collectives by a r/w resource? it may be
-  // fine to leave them separate as then we get unique invalidation ranges.
+  // In-place collectives have their source mapped into the target range and
+  // reference the same range twice. We keep them separate so that each retains
+  // its own access bits and invalidation range.
 
   auto sourceRange = scope.lookupResourceRange(asyncOp.getSource());
   auto sourceOffset = scope.add(asyncOp.getLoc(), sourceRange.offset,
@@ -821,7 +1058,7 @@ static llvm::Optional<TransientAllocation> allocateLocalTransients(
   SmallVector<int64_t> lifetimeIntervals;
   SmallVector<Value> dynamicSliceSizes;
   auto livenessIntervals = computeExecutionRegionLivenessIntervals(
-      executeOp, scope.getValueAliases());
+      executeOp, scope.getValueAliases(), scope.getSubrangeAliases());
   for (auto valueInterval : livenessIntervals) {
     auto value = valueInterval.value;
     assert(value && "must have value for interval");
@@ -838,6 +1075,10 @@ static llvm::Optional<TransientAllocation> allocateLocalTransients(
       continue;
     }
 
+    // Ignore values stored within other values; they'll be mapped along with
+    // the value they alias.
+    if (scope.isSubrangeAlias(value)) continue;
+
     locs.push_back(value.getLoc());
     transientValues.push_back(value);
     lifetimeIntervals.push_back(valueInterval.start);
@@ -1035,6 +1276,59 @@ static ResultAllocation reserveResultAllocation(
   return ResultAllocation{sets};
 }
 
+// Users of an escaping transient result that bound its lifetime.
+struct TransientResultUsers {
+  // Last op in the block using the result.
+  Operation *lastUserOp = nullptr;
+  // Timepoints of all execution regions using the result. The result can be
+  // deallocated once all have been reached. Empty if the result is unused.
+  SetVector<Value> timepoints;
+};
+
+// Returns the users of a transient |result| of an execution region if they
+// are all execution regions in the same block (transitively through tied uses
+// such as timepoint awaits). Returns std::nullopt if the result escapes in any
+// other way and its lifetime can't be bounded by timepoints.
+static Optional<TransientResultUsers> findTransientResultUsers(Value result) {
+  auto *definingOp = result.getDefiningOp();
+  TransientResultUsers users;
+  users.lastUserOp = definingOp;
+  SmallVector<Value> worklist;
+  worklist.push_back(result);
+  while (!worklist.empty()) {
+    auto value = worklist.pop_back_val();
+    for (auto &use : value.getUses()) {
+      auto *userOp = use.getOwner();
+      if (userOp->getBlock() != definingOp->getBlock()) return std::nullopt;
+      if (auto executeOp = dyn_cast<IREE::Stream::AsyncExecuteOp>(userOp)) {
+        users.timepoints.insert(executeOp.getResultTimepoint());
+        // Untied results passing through the captured value will be replaced
+        // with the value itself during allocation.
+        auto arg = executeOp.getBody().getArgument(
+            use.getOperandNumber() -
+            executeOp.getTiedOperandsIndexAndLength().first);
+        auto yieldOp = cast<IREE::Stream::YieldOp>(
+            executeOp.getBody().front().getTerminator());
+        for (auto it : llvm::enumerate(yieldOp.getResourceOperands())) {
+          if (IREE::Util::TiedOpInterface::findTiedBaseValue(it.value()) ==
+              arg) {
+            worklist.push_back(executeOp.getResults()[it.index()]);
+          }
+        }
+      } else if (!isa<IREE::Stream::TimepointAwaitOp>(userOp)) {
+        return std::nullopt;
+      }
+      // Values tied to the result share its storage.
+      auto tiedOp = cast<IREE::Util::TiedOpInterface>(userOp);
+      worklist.append(tiedOp.getOperandTiedResults(use.getOperandNumber()));
+      if (users.lastUserOp->isBeforeInBlock(userOp)) {
+        users.lastUserOp = userOp;
+      }
+    }
+  }
+  return users;
+}
+
 //===----------------------------------------------------------------------===//
 // Execution region allocation
 //===----------------------------------------------------------------------===//
@@ -1101,10 +1395,6 @@ static LogicalResult allocateExecutionRegion(
   llvm::append_range(newOperandSizes, executeOp.getResourceOperandSizes());
   SmallVector<Value> joinTimepoints;
 
-  // TODO(#11249): pre-scan region for collectives and handle in-place behavior
-  // where send aliases recv. We probably want to do this early in case both
-  // values are produced locally and escape the region.
-
   // First find all constants and pull them out into a dedicated constant upload
   // op. We'll then capture the result and use that to initialize variables and
   // constants within the region. Note that this removes ops from the region and
@@ -1275,12 +1565,68 @@ static LogicalResult allocateExecutionRegion(
     });
     resultReservations.push_back(resultReservation);
   }
-  auto resultAllocation = reserveResultAllocation(resultReservations);
+
+  // Transient results only used by other execution regions in the same block
+  // are allocated with queue-ordered allocas and deallocated once the last
+  // region using them completes. All other results are allocated below.
+  SmallVector<ResultReservation> allocReservations;
+  for (auto &reservation : resultReservations) {
+    Optional<TransientResultUsers> transientUsers;
+    if (reservation.resultType.getLifetime() ==
+        IREE::Stream::Lifetime::Transient) {
+      transientUsers = findTransientResultUsers(reservation.result);
+    }
+    if (!transientUsers.has_value()) {
+      allocReservations.push_back(reservation);
+      continue;
+    }
+
+    auto allocaOp = externalBuilder.create<IREE::Stream::ResourceAllocaOp>(
+        reservation.loc, reservation.resultType,
+        externalBuilder.getType<IREE::Stream::TimepointType>(),
+        reservation.resultSize, executeOp.getAwaitTimepoint(),
+        executeOp.getAffinityAttr());
+    newAwaitTimepoints.push_back(allocaOp.getResultTimepoint());
+    newOperands.push_back(allocaOp.getResult());
+    newOperandSizes.push_back(reservation.resultSize);
+    resultReplacements.push_back(
+        std::make_pair(reservation.result, allocaOp.getResult()));
+    auto arg = entryBlock.addArgument(reservation.resultType, reservation.loc);
+    LLVM_DEBUG({
+      AsmState asmState(executeOp->getParentOp());
+      llvm::dbgs() << "  + alloca for transient result ";
+      reservation.result.printAsOperand(llvm::dbgs(), asmState);
+      llvm::dbgs() << " as ";
+      arg.printAsOperand(llvm::dbgs(), asmState);
+      llvm::dbgs() << "\n";
+    });
+    scope.mapResourceRange(reservation.yieldValue,
+                           ResourceRange(arg, reservation.resultSize),
+                           asmState.get());
+
+    if (transientUsers->timepoints.empty()) {
+      // Not used outside of this region; release along with local transients.
+      pendingReleases.push_back(
+          std::make_pair(allocaOp.getResult(), reservation.resultSize));
+      continue;
+    }
+    OpBuilder deallocaBuilder(executeOp);
+    deallocaBuilder.setInsertionPointAfter(transientUsers->lastUserOp);
+    Value deallocaTimepoint = transientUsers->timepoints.front();
+    if (transientUsers->timepoints.size() > 1) {
+      deallocaTimepoint =
+          deallocaBuilder.createOrFold<IREE::Stream::TimepointJoinOp>(
+              reservation.loc, deallocaTimepoint.getType(),
+              transientUsers->timepoints.getArrayRef());
+    }
+    deallocaBuilder.create<IREE::Stream::ResourceDeallocaOp>(
+        reservation.loc, allocaOp.getResult(), reservation.resultSize,
+        deallocaTimepoint, executeOp.getAffinityAttr());
+  }
+
+  auto resultAllocation = reserveResultAllocation(allocReservations);
   for (auto &reservationSet : resultAllocation.reservationSets) {
     // Allocate and tie an operand to the result.
-    // TODO(benvanik): change this to an alloca. We may need a higher-level
-    // analysis to decide when to deallocate, or just leave it to be deallocated
-    // as part of garbage collection.
     auto allocOp = externalBuilder.create<IREE::Stream::ResourceAllocOp>(
         externalBuilder.getFusedLoc(reservationSet.reservationLocs),
         reservationSet.reservationTypes, reservationSet.reservationSizes,
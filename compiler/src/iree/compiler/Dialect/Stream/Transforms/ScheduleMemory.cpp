@@ -0,0 +1,383 @@
+// Copyright 2023 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include "iree/compiler/Dialect/Stream/IR/StreamDialect.h"
+#include "iree/compiler/Dialect/Stream/IR/StreamOps.h"
+#include "iree/compiler/Dialect/Stream/IR/StreamTypes.h"
+#include "iree/compiler/Dialect/Stream/Transforms/PassDetail.h"
+#include "iree/compiler/Dialect/Stream/Transforms/Passes.h"
+#include "iree/compiler/Dialect/Util/IR/UtilTypes.h"
+#include "llvm/ADT/DenseMap.h"
+#include "llvm/ADT/SetVector.h"
+#include "llvm/Support/Debug.h"
+#include "mlir/IR/Builders.h"
+#include "mlir/IR/Matchers.h"
+#include "mlir/Pass/Pass.h"
+
+#define DEBUG_TYPE "iree-stream-schedule-memory"
+
+namespace mlir {
+namespace iree_compiler {
+namespace IREE {
+namespace Stream {
+namespace {
+
+// Models the transient memory held live by a schedule of the ops in an
+// execution region. Each transient resource defined in the region is backed by
+// a storage root: tied results share the storage of the operand they are tied
+// to. A root is live from its definition until the last use of any value
+// sharing it. Yielded roots become result allocations and are not transients.
+//
+// Only statically sized resources are tracked; dynamically sized resources are
+// treated as free as we can't compare them.
+class TransientModel {
+ public:
+  explicit TransientModel(Block *block) {
+    for (auto &op : block->without_terminator()) {
+      for (auto result : op.getResults()) {
+        if (!result.getType().isa<IREE::Stream::ResourceType>()) continue;
+        Value root = result;
+        if (auto tiedOp = dyn_cast<IREE::Util::TiedOpInterface>(op)) {
+          if (auto tiedOperand = tiedOp.getTiedResultOperand(result)) {
+            if (roots.count(tiedOperand)) root = roots[tiedOperand];
+          }
+        }
+        roots[result] = root;
+        if (root == result) rootSizes[root] = getStaticSize(result);
+        for (auto &use : result.getUses()) {
+          if (use.getOwner()->getBlock() != block) {
+            rootSizes[root] = 0;
+          } else if (use.getOwner()->hasTrait<OpTrait::IsTerminator>()) {
+            rootSizes[root] = 0;
+          } else {
+            rootUsers[root].insert(use.getOwner());
+          }
+        }
+      }
+    }
+  }
+
+  // Returns the bytes allocated when |op| is scheduled.
+  int64_t getAllocatedSize(Operation *op) const {
+    int64_t size = 0;
+    for (auto result : op->getResults()) {
+      auto it = roots.find(result);
+      if (it != roots.end() && it->second == result) {
+        size += rootSizes.lookup(result);
+      }
+    }
+    return size;
+  }
+
+  // Returns the roots whose storage is live only until |op| given the users
+  // in |remainingUsers| that have not yet been scheduled.
+  void getReleasedRoots(
+      Operation *op,
+      const DenseMap<Value, llvm::SmallSetVector<Operation *, 4>>
+          &remainingUsers,
+      SmallVectorImpl<Value> &released) const {
+    auto addRoot = [&](Value value) {
+      auto it = roots.find(value);
+      if (it == roots.end()) return;
+      Value root = it->second;
+      if (llvm::is_contained(released, root)) return;
+      auto usersIt = remainingUsers.find(root);
+      if (usersIt == remainingUsers.end()) return;
+      if (llvm::all_of(usersIt->second,
+                       [&](Operation *user) { return user == op; })) {
+        released.push_back(root);
+      }
+    };
+    for (auto operand : op->getOperands()) addRoot(operand);
+    // Results without users are released as soon as they are produced.
+    for (auto result : op->getResults()) addRoot(result);
+  }
+
+  int64_t getRootSize(Value root) const { return rootSizes.lookup(root); }
+
+  // Removes |op| from the remaining users of the storage it references and
+  // erases the roots it releases.
+  void markScheduled(
+      Operation *op,
+      DenseMap<Value, llvm::SmallSetVector<Operation *, 4>> &remainingUsers,
+      ArrayRef<Value> released) const {
+    for (auto operand : op->getOperands()) {
+      auto it = roots.find(operand);
+      if (it == roots.end()) continue;
+      auto usersIt = remainingUsers.find(it->second);
+      if (usersIt != remainingUsers.end()) usersIt->second.remove(op);
+    }
+    for (auto root : released) remainingUsers.erase(root);
+  }
+
+  // Returns the peak live transient bytes when scheduling in |order|.
+  int64_t computePeak(ArrayRef<Operation *> order) const {
+    auto remainingUsers = rootUsers;
+    for (auto &it : rootSizes) remainingUsers[it.first];
+    int64_t live = 0;
+    int64_t peak = 0;
+    for (auto *op : order) {
+      live += getAllocatedSize(op);
+      peak = std::max(peak, live);
+      SmallVector<Value> released;
+      getReleasedRoots(op, remainingUsers, released);
+      for (auto root : released) live -= getRootSize(root);
+      markScheduled(op, remainingUsers, released);
+    }
+    return peak;
+  }
+
+  // Returns a topological order of |ops| that greedily schedules the ready op
+  // with the smallest increase in live memory. Ties are broken by original
+  // order so that regions that don't benefit are left unchanged.
+  //
+  // Splats that depend on nothing else in the region are scheduled lazily
+  // immediately before their first consumer: they are never worth producing
+  // early and would otherwise always win as the cheapest ready op.
+  SmallVector<Operation *> computeOrder(ArrayRef<Operation *> ops) const {
+    llvm::SmallDenseSet<Operation *> opSet(ops.begin(), ops.end());
+    auto isLazy = [&](Operation *op) {
+      if (!isa<IREE::Stream::AsyncSplatOp>(op)) return false;
+      return llvm::none_of(op->getOperands(), [&](Value operand) {
+        auto *producer = operand.getDefiningOp();
+        return producer && opSet.contains(producer);
+      });
+    };
+    DenseMap<Operation *, unsigned> pendingOperands;
+    DenseMap<Operation *, SmallVector<Operation *>> consumers;
+    DenseMap<Operation *, SmallVector<Operation *>> lazyProducers;
+    for (auto *op : ops) {
+      llvm::SmallSetVector<Operation *, 4> producers;
+      for (auto operand : op->getOperands()) {
+        auto *producer = operand.getDefiningOp();
+        if (producer && opSet.contains(producer)) producers.insert(producer);
+      }
+      unsigned pendingCount = 0;
+      for (auto *producer : producers) {
+        if (isLazy(producer)) {
+          lazyProducers[op].push_back(producer);
+        } else {
+          consumers[producer].push_back(op);
+          ++pendingCount;
+        }
+      }
+      pendingOperands[op] = pendingCount;
+    }
+
+    auto remainingUsers = rootUsers;
+    for (auto &it : rootSizes) remainingUsers[it.first];
+    llvm::SmallSetVector<Operation *, 16> ready;
+    for (auto *op : ops) {
+      if (!isLazy(op) && pendingOperands[op] == 0) ready.insert(op);
+    }
+    DenseMap<Operation *, unsigned> originalIndex;
+    for (auto it : llvm::enumerate(ops)) originalIndex[it.value()] = it.index();
+
+    SmallVector<Operation *> order;
+    order.reserve(ops.size());
+    llvm::SmallDenseSet<Operation *> scheduled;
+    auto schedule = [&](Operation *op) {
+      order.push_back(op);
+      scheduled.insert(op);
+      SmallVector<Value> released;
+      getReleasedRoots(op, remainingUsers, released);
+      markScheduled(op, remainingUsers, released);
+      for (auto *consumer : consumers[op]) {
+        if (--pendingOperands[consumer] == 0) ready.insert(consumer);
+      }
+    };
+    while (!ready.empty()) {
+      Operation *bestOp = nullptr;
+      int64_t bestDelta = 0;
+      for (auto *op : ready) {
+        int64_t delta = getAllocatedSize(op);
+        for (auto *producer : lazyProducers[op]) {
+          if (!scheduled.contains(producer)) {
+            delta += getAllocatedSize(producer);
+          }
+        }
+        SmallVector<Value> released;
+        getReleasedRoots(op, remainingUsers, released);
+        for (auto root : released) delta -= getRootSize(root);
+        if (!bestOp || delta < bestDelta ||
+            (delta == bestDelta && originalIndex[op] < originalIndex[bestOp])) {
+          bestOp = op;
+          bestDelta = delta;
+        }
+      }
+      ready.remove(bestOp);
+      for (auto *producer : lazyProducers[bestOp]) {
+        if (!scheduled.contains(producer)) schedule(producer);
+      }
+      schedule(bestOp);
+    }
+
+    // Splats without consumers in the region (such as those only yielded) go
+    // last. Order is still valid as they have no in-region dependencies.
+    for (auto *op : ops) {
+      if (!scheduled.contains(op)) schedule(op);
+    }
+    return order;
+  }
+
+ private:
+  static int64_t getStaticSize(Value value) {
+    auto sizeAwareOp =
+        dyn_cast<IREE::Util::SizeAwareOpInterface>(value.getDefiningOp());
+    if (!sizeAwareOp) return 0;
+    APInt size;
+    if (!matchPattern(sizeAwareOp.getResultSizeFromValue(value),
+                      m_ConstantInt(&size))) {
+      return 0;
+    }
+    return size.getSExtValue();
+  }
+
+  DenseMap<Value, Value> roots;
+  DenseMap<Value, int64_t> rootSizes;
+  DenseMap<Value, llvm::SmallSetVector<Operation *, 4>> rootUsers;
+};
+
+// Returns the non-terminator ops of |block| if they can all be freely
+// reordered within the constraints of their SSA dependencies.
+static Optional<SmallVector<Operation *>> getSchedulableOps(Block *block) {
+  SmallVector<Operation *> ops;
+  for (auto &op : block->without_terminator()) {
+    if (!isa<IREE::Stream::StreamableOpInterface>(op) ||
+        op.getNumRegions() != 0) {
+      return llvm::None;
+    }
+    ops.push_back(&op);
+  }
+  return ops;
+}
+
+// Clones splats with multiple in-region users so that each user gets its own
+// copy produced just before it instead of holding one copy live across all of
+// them. Splats are cheap to recompute and broadcasting/filling is common
+// enough in models that it's worth doing this even when the gain is small.
+// Returns the cloned ops and the ops they were cloned from.
+static SmallVector<std::pair<Operation *, Operation *>> rematerializeSplats(
+    Block *block) {
+  SmallVector<std::pair<Operation *, Operation *>> clonedOps;
+  SmallVector<IREE::Stream::AsyncSplatOp> splatOps(
+      block->getOps<IREE::Stream::AsyncSplatOp>());
+  for (auto splatOp : splatOps) {
+    SmallVector<OpOperand *> uses;
+    for (auto &use : splatOp.getResult().getUses()) {
+      if (use.getOwner()->hasTrait<OpTrait::IsTerminator>()) continue;
+      uses.push_back(&use);
+    }
+    for (auto *use : llvm::drop_begin(uses)) {
+      OpBuilder builder(use->getOwner());
+      auto *clonedOp = builder.clone(*splatOp);
+      use->set(clonedOp->getResult(0));
+      clonedOps.emplace_back(clonedOp, splatOp);
+    }
+  }
+  return clonedOps;
+}
+
+// Reverts rematerializeSplats by folding |clonedOps| back into their sources.
+static void revertRematerialization(
+    ArrayRef<std::pair<Operation *, Operation *>> clonedOps) {
+  for (auto [clonedOp, sourceOp] : clonedOps) {
+    clonedOp->replaceAllUsesWith(sourceOp);
+    clonedOp->erase();
+  }
+}
+
+class ScheduleMemoryPass : public ScheduleMemoryBase<ScheduleMemoryPass> {
+ public:
+  ScheduleMemoryPass() = default;
+  ScheduleMemoryPass(const ScheduleMemoryPass &pass)
+      : ScheduleMemoryPass(pass.maxTransientSize) {}
+  ScheduleMemoryPass(int64_t maxTransientSize) {
+    this->maxTransientSize = maxTransientSize;
+  }
+
+  void getDependentDialects(DialectRegistry &registry) const override {
+    registry.insert<IREE::Stream::StreamDialect>();
+  }
+
+  void runOnOperation() override {
+    if (maxTransientSize <= 0) return;
+    auto parentOp = getOperation();
+    if (!parentOp.getCallableRegion() ||
+        parentOp.getCallableRegion()->empty()) {
+      return;
+    }
+    parentOp.getCallableRegion()->walk(
+        [&](IREE::Stream::AsyncExecuteOp executeOp) {
+          runOnRegion(executeOp);
+        });
+  }
+
+ private:
+  void runOnRegion(IREE::Stream::AsyncExecuteOp executeOp) {
+    if (executeOp.getBody().empty()) return;
+    auto *block = &executeOp.getBody().front();
+    auto ops = getSchedulableOps(block);
+    if (!ops) return;
+
+    TransientModel model(block);
+    int64_t originalPeak = model.computePeak(*ops);
+    LLVM_DEBUG(llvm::dbgs() << "execution region at " << executeOp.getLoc()
+                            << " peak transient size " << originalPeak
+                            << "\n");
+    if (originalPeak <= maxTransientSize) return;
+
+    // Reorder independent work to shorten transient lifetimes.
+    SmallVector<Operation *> bestOrder = model.computeOrder(*ops);
+    int64_t bestPeak = model.computePeak(bestOrder);
+
+    // If still over budget try recomputing splats at each of their uses.
+    if (bestPeak > maxTransientSize) {
+      auto clonedOps = rematerializeSplats(block);
+      if (!clonedOps.empty()) {
+        auto rematOps = getSchedulableOps(block);
+        TransientModel rematModel(block);
+        auto rematOrder = rematModel.computeOrder(*rematOps);
+        int64_t rematPeak = rematModel.computePeak(rematOrder);
+        if (rematPeak < bestPeak) {
+          bestOrder = std::move(rematOrder);
+          bestPeak = rematPeak;
+        } else {
+          revertRematerialization(clonedOps);
+        }
+      }
+    }
+
+    if (bestPeak < originalPeak) {
+      auto *terminator = block->getTerminator();
+      for (auto *op : bestOrder) op->moveBefore(terminator);
+      // Concurrency scheduling must preserve the order we chose instead of
+      // hoisting work up to widen waves.
+      executeOp->setAttr(
+          "stream.partitioning",
+          IREE::Stream::PartitioningConfigAttr::get(
+              IREE::Stream::FavorAttr::get(
+                  &getContext(), IREE::Stream::Favor::MinPeakMemory)));
+    }
+    if (bestPeak > maxTransientSize) {
+      executeOp.emitWarning()
+          << "peak transient size of " << bestPeak
+          << " bytes exceeds the budget of " << maxTransientSize << " bytes";
+    }
+  }
+};
+
+}  // namespace
+
+std::unique_ptr<InterfacePass<CallableOpInterface>> createScheduleMemoryPass(
+    int64_t maxTransientSize) {
+  return std::make_unique<ScheduleMemoryPass>(maxTransientSize);
+}
+
+}  // namespace Stream
+}  // namespace IREE
+}  // namespace iree_compiler
+}  // namespace mlir
@@ -162,3 +162,76 @@ func.func @deduplicateBindings(%operand: index) {
   } => !stream.timepoint
   return
 }
+
+// -----
+
+// Tests that fused bindings with constant offsets that differ across dispatch
+// sites only by a uniform base pass the base as a single operand and the
+// offsets of each range relative to it as constants. The relative offsets are
+// uniform across all sites and --iree-stream-fold-uniform-operands will inline
+// them into the executable.
+
+// CHECK-LABEL: @relativeBindingOffsetsEx
+stream.executable private @relativeBindingOffsetsEx {
+  stream.executable.export public @dispatch
+  builtin.module  {
+    // CHECK: func.func @dispatch(%[[BINDING:.+]]: !stream.binding,
+    // CHECK-SAME:           %[[BASE:.+]]: index, %[[OFFSET_A:.+]]: index, %[[OFFSET_B:.+]]: index, %[[OPERAND:.+]]: index)
+    func.func @dispatch(%binding_a: !stream.binding, %binding_b: !stream.binding, %operand: index) {
+      %c0 = arith.constant 0 : index
+      %c20 = arith.constant 20 : index
+
+      // CHECK: %[[REL_OFFSET_A:.+]] = arith.addi %c0, %[[OFFSET_A]]
+      // CHECK-NEXT: %[[SUM_OFFSET_A:.+]] = arith.addi %[[REL_OFFSET_A]], %[[BASE]]
+      // CHECK-NEXT: %[[SUBSPAN_A:.+]] = stream.binding.subspan %[[BINDING]][%[[SUM_OFFSET_A]]]
+      %subspan_a = stream.binding.subspan %binding_a[%c0] : !stream.binding -> !flow.dispatch.tensor<readonly:tensor<20xi8>>{%c20}
+      // CHECK-NEXT: util.optimization_barrier %[[SUBSPAN_A]]
+      util.optimization_barrier %subspan_a : !flow.dispatch.tensor<readonly:tensor<20xi8>>
+
+      // CHECK: %[[REL_OFFSET_B:.+]] = arith.addi %c0, %[[OFFSET_B]]
+      // CHECK-NEXT: %[[SUM_OFFSET_B:.+]] = arith.addi %[[REL_OFFSET_B]], %[[BASE]]
+      // CHECK-NEXT: %[[SUBSPAN_B:.+]] = stream.binding.subspan %[[BINDING]][%[[SUM_OFFSET_B]]]
+      %subspan_b = stream.binding.subspan %binding_b[%c0] : !stream.binding -> !flow.dispatch.tensor<readonly:tensor<20xi8>>{%c20}
+      // CHECK-NEXT: util.optimization_barrier %[[SUBSPAN_B]]
+      util.optimization_barrier %subspan_b : !flow.dispatch.tensor<readonly:tensor<20xi8>>
+
+      // CHECK-NEXT: util.optimization_barrier %[[OPERAND]] : index
+      util.optimization_barrier %operand : index
+      return
+    }
+  }
+}
+// CHECK: func.func @relativeBindingOffsets(%[[OPERAND:.+]]: index)
+func.func @relativeBindingOffsets(%operand: index) {
+  %c1 = arith.constant 1 : index
+  %c20 = arith.constant 20 : index
+  %c40 = arith.constant 40 : index
+  %c60 = arith.constant 60 : index
+  %c100 = arith.constant 100 : index
+  %c120 = arith.constant 120 : index
+  %c200 = arith.constant 200 : index
+  // CHECK: %[[ALLOC0:.+]] = stream.resource.alloc
+  %alloc0 = stream.resource.alloc uninitialized : !stream.resource<transient>{%c200}
+  // CHECK-NEXT: %[[ZERO:.+]] = arith.constant 0 : index
+  // CHECK-NEXT: %[[REL20:.+]] = arith.constant 20 : index
+  // CHECK-NEXT: stream.cmd.execute
+  %result_timepoint = stream.cmd.execute
+      // CHECK-SAME: with(%[[ALLOC0]] as %[[CAPTURE0:.+]]: !stream.resource<transient>{%c200})
+      with(%alloc0 as %capture0: !stream.resource<transient>{%c200}) {
+    // CHECK: stream.cmd.dispatch {{.+}}(%c40, %[[ZERO]], %[[REL20]], %[[OPERAND]] : index, index, index, index)
+    stream.cmd.dispatch @relativeBindingOffsetsEx::@dispatch[%c1, %c1, %c1](%operand : index) {
+      // CHECK-NEXT: ro %[[CAPTURE0]][%[[ZERO]]
+      ro %capture0[%c40 for %c20] : !stream.resource<transient>{%c200},
+      // CHECK-NOT: ro %[[CAPTURE0]]
+      ro %capture0[%c60 for %c20] : !stream.resource<transient>{%c200}
+    }
+    // CHECK: stream.cmd.dispatch {{.+}}(%c100, %[[ZERO]], %[[REL20]], %[[OPERAND]] : index, index, index, index)
+    stream.cmd.dispatch @relativeBindingOffsetsEx::@dispatch[%c1, %c1, %c1](%operand : index) {
+      // CHECK-NEXT: ro %[[CAPTURE0]][%[[ZERO]]
+      ro %capture0[%c100 for %c20] : !stream.resource<transient>{%c200},
+      // CHECK-NOT: ro %[[CAPTURE0]]
+      ro %capture0[%c120 for %c20] : !stream.resource<transient>{%c200}
+    }
+  } => !stream.timepoint
+  return
+}
@@ -29,6 +29,38 @@ func.func @layoutStatic() -> (index, index, index, index, index, index, index)
 
 // -----
 
+#layoutStaticSearchConfig = #stream.resource_config<{
+  max_allocation_size = 1073741824,
+  min_buffer_offset_alignment = 16,
+  max_buffer_range = 1073741824,
+  min_buffer_range_alignment = 16,
+  index_bits = 32
+}>
+
+// Packing in lifetime order places the small early slices at the bottom and
+// leaves gaps the large late slices can't use (928 total bytes). Placing the
+// largest slices first packs into 720 bytes.
+
+// CHECK-LABEL: @layoutStaticSearch
+func.func @layoutStaticSearch() -> (index, index, index, index, index)
+    attributes {stream.resources = #layoutStaticSearchConfig} {
+  %c100 = arith.constant 100 : index
+  %c200 = arith.constant 200 : index
+  %c300 = arith.constant 300 : index
+  %t:5 = stream.resource.pack slices({
+    [0, 1] = %c200,  // +304 (above [1, 3])
+    [0, 2] = %c100,  // +608 (above [0, 1])
+    [1, 3] = %c300,  // +0 (placed first)
+    [2, 3] = %c300,  // +304 (above [1, 3])
+  }) : index
+  // 608 + 112 = 720 total bytes required
+  // CHECK: return %c720
+  // CHECK-SAME: %c304, %c608, %c0, %c304
+  return %t#0, %t#1, %t#2, %t#3, %t#4 : index, index, index, index, index
+}
+
+// -----
+
 #layoutDynamicConfig = #stream.resource_config<{
   max_allocation_size = 1073741824,
   min_buffer_offset_alignment = 16,
@@ -92,3 +124,41 @@ func.func @layoutMixedStaticDynamic(%size_a: index, %size_b: index) -> (index, i
   // CHECK: return %3, %c0, %c208, %1, %c0
   return %t#0, %t#1, %t#2, %t#3, %t#4 : index, index, index, index, index
 }
+
+// -----
+
+#layoutBoundedDynamicConfig = #stream.resource_config<{
+  max_allocation_size = 1073741824,
+  min_buffer_offset_alignment = 16,
+  max_buffer_range = 1073741824,
+  min_buffer_range_alignment = 16,
+  index_bits = 32
+}>
+
+// Dynamic slices with a static upper bound are packed with the static slices
+// at their maximum size. Unbounded slices are still packed dynamically.
+
+// CHECK-LABEL: @layoutBoundedDynamic
+// CHECK-SAME: (%[[SIZE_A:.+]]: index, %[[SIZE_B:.+]]: index)
+func.func @layoutBoundedDynamic(%size_a: index, %size_b: index) -> (index, index, index, index, index)
+    attributes {stream.resources = #layoutBoundedDynamicConfig} {
+  %c100 = arith.constant 100 : index
+  %c256 = arith.constant 256 : index
+  %bounded_a = arith.minui %size_a, %c256 : index
+  %t:5 = stream.resource.pack slices({
+    [0, 1] = %c100,       // +0
+    [1, 2] = %bounded_a,  // +112 (<= 256)
+    [2, 3] = %c100,       // +0 (reuse [0, 1])
+    [3, 4] = %size_b,     // +368 (after static slab)
+  }) : index
+
+  // CHECK-DAG: %c0 = arith.constant 0 : index
+  // CHECK-DAG: %c16 = arith.constant 16 : index
+  // CHECK-DAG: %c112 = arith.constant 112 : index
+  // CHECK-DAG: %c368 = arith.constant 368 : index
+  // CHECK-DAG: %[[ALIGNED_B:.+]] = util.align %[[SIZE_B]], %c16 : index
+  // CHECK-DAG: %[[TOTAL:.+]] = arith.addi %c368, %[[ALIGNED_B]] : index
+
+  // CHECK: return %[[TOTAL]], %c0, %c112, %c0, %c368
+  return %t#0, %t#1, %t#2, %t#3, %t#4 : index, index, index, index, index
+}
@@ -146,3 +146,38 @@ func.func @mixedResourceConstants() -> (!stream.resource<constant>, !stream.reso
   // CHECK: return %[[CONSTANT_VIEW]], %[[VARIABLE_VIEW]], %[[JOIN]]
   return %0#0, %0#1, %0#2 : !stream.resource<constant>, !stream.resource<variable>, !stream.timepoint
 }
+
+// -----
+
+// Tests that immutable constants with identical contents share storage, even
+// if their types differ, while variables always get their own copy.
+
+// CHECK: #composite_of_128b = #util.composite<128xi8, [
+// CHECK-NEXT:   dense<[1, 2, 3, 4]> : tensor<4xi32>,
+// CHECK-NEXT:   dense<0> : vector<48xi8>,
+// CHECK-NEXT:   dense<[5, 6]> : tensor<2xi32>,
+// CHECK-NEXT:   dense<0> : vector<56xi8>,
+// CHECK-NEXT: ]>
+
+// CHECK-LABEL: @dedupeResourceConstants
+func.func @dedupeResourceConstants() -> (!stream.resource<constant>, !stream.resource<constant>, !stream.resource<constant>, !stream.resource<constant>, !stream.timepoint) {
+  %c8 = arith.constant 8 : index
+  %c16 = arith.constant 16 : index
+
+  // CHECK: util.buffer.constant {{.+}} = #composite_of_128b
+  %0:5 = stream.resource.constants :
+    !stream.resource<constant>{%c16} = dense<[1, 2, 3, 4]> : tensor<4xi32>,
+    !stream.resource<constant>{%c8} = dense<[5, 6]> : tensor<2xi32>,
+    !stream.resource<constant>{%c16} = dense<[1, 2, 3, 4]> : tensor<4xi32>,
+    !stream.resource<constant>{%c16} = dense<[1, 0, 0, 0, 2, 0, 0, 0, 3, 0, 0, 0, 4, 0, 0, 0]> : tensor<16xi8>
+    => !stream.timepoint
+
+  // CHECK: %[[IF:.+]]:2 = scf.if
+  // CHECK: %[[RES0:.+]] = stream.resource.subview %[[IF]]#0[%c0] : !stream.resource<constant>{%c128} -> !stream.resource<constant>{%c16}
+  // CHECK: %[[RES1:.+]] = stream.resource.subview %[[IF]]#0[%c64] : !stream.resource<constant>{%c128} -> !stream.resource<constant>{%c8}
+  // CHECK: %[[RES2:.+]] = stream.resource.subview %[[IF]]#0[%c0] : !stream.resource<constant>{%c128} -> !stream.resource<constant>{%c16}
+  // CHECK: %[[RES3:.+]] = stream.resource.subview %[[IF]]#0[%c0] : !stream.resource<constant>{%c128} -> !stream.resource<constant>{%c16}
+
+  // CHECK: return %[[RES0]], %[[RES1]], %[[RES2]], %[[RES3]], %[[IF]]#1
+  return %0#0, %0#1, %0#2, %0#3, %0#4 : !stream.resource<constant>, !stream.resource<constant>, !stream.resource<constant>, !stream.resource<constant>, !stream.timepoint
+}
@@ -188,3 +188,34 @@ func.func private @asyncExecuteConsume(%arg0: !stream.resource<external>, %arg1:
   util.optimization_barrier %ready_results#1 : !stream.resource<transient>
   return
 }
+
+// -----
+
+// Tests that internal calls to public functions are redirected to private
+// clones that have their signatures expanded. The public function is preserved
+// for external callers and retains its ABI attributes.
+//
+// This chains execution across the calls instead of waiting on every call.
+
+// CHECK-LABEL: func.func @step
+// CHECK-SAME: (%{{.+}}: !stream.resource<external>) -> !stream.resource<external>
+// CHECK-SAME: attributes {iree.abi.stub}
+func.func @step(%arg0: !stream.resource<external>) -> !stream.resource<external> attributes {iree.abi.stub} {
+  return %arg0 : !stream.resource<external>
+}
+
+// CHECK: func.func private @step__internal
+// CHECK-SAME: (%[[TIMEPOINT:.+]]: !stream.timepoint, %[[UNREADY:.+]]: !stream.resource<external>) -> (!stream.timepoint, !stream.resource<external>)
+// CHECK-NOT: iree.abi.stub
+// CHECK-NEXT: return %[[TIMEPOINT]], %[[UNREADY]]
+
+// CHECK-LABEL: func.func @decode
+// CHECK-SAME: (%[[ARG0:.+]]: !stream.resource<external>)
+func.func @decode(%arg0: !stream.resource<external>) -> !stream.resource<external> {
+  // CHECK: %[[IMMEDIATE:.+]] = stream.timepoint.immediate
+  // CHECK: %[[STEP0:.+]]:2 = call @step__internal(%[[IMMEDIATE]], %[[ARG0]])
+  %0 = call @step(%arg0) : (!stream.resource<external>) -> !stream.resource<external>
+  // CHECK: %[[STEP1:.+]]:2 = call @step__internal(%[[STEP0]]#0, %[[STEP0]]#1)
+  %1 = call @step(%0) : (!stream.resource<external>) -> !stream.resource<external>
+  return %1 : !stream.resource<external>
+}
@@ -185,6 +185,39 @@ func.func @locals(%size0: index, %size1: index, %await_timepoint: !stream.timepo
 
 // -----
 
+// Tests transient results that are only consumed by other execution regions in
+// the same block. We expect them to be allocated with the async stream-ordered
+// alloca and deallocated once the last consumer completes.
+
+// CHECK-LABEL: @escapingTransients
+// CHECK-SAME: (%[[SIZE:.+]]: index)
+func.func @escapingTransients(%size: index) -> !stream.timepoint {
+  %c0 = arith.constant 0 : index
+  %c128 = arith.constant 128 : index
+  %c254_i32 = arith.constant 254 : i32
+  %c255_i32 = arith.constant 255 : i32
+  // CHECK: %[[ALLOCA:.+]], %[[ALLOCA_TIMEPOINT:.+]] = stream.resource.alloca uninitialized : !stream.resource<transient>{%[[SIZE]]} => !stream.timepoint
+  // CHECK: %[[PRODUCER_TIMEPOINT:.+]] = stream.cmd.execute await(%[[ALLOCA_TIMEPOINT]])
+  // CHECK-SAME: => with(%[[ALLOCA]] as %[[PRODUCER_CAPTURE:.+]]: !stream.resource<transient>{%[[SIZE]]})
+  %result, %result_timepoint = stream.async.execute with() -> !stream.resource<transient>{%size} {
+    // CHECK-NEXT: stream.cmd.fill %c255_i32, %[[PRODUCER_CAPTURE]]
+    %0 = stream.async.splat %c255_i32 : i32 -> !stream.resource<transient>{%size}
+    stream.yield %0 : !stream.resource<transient>{%size}
+  } => !stream.timepoint
+  // CHECK: %[[CONSUMER_TIMEPOINT:.+]] = stream.cmd.execute await(%[[PRODUCER_TIMEPOINT]])
+  // CHECK-SAME: => with(%[[ALLOCA]] as %[[CONSUMER_CAPTURE:.+]]: !stream.resource<transient>{%[[SIZE]]})
+  %consumer_timepoint = stream.async.execute await(%result_timepoint) => with(%result as %capture: !stream.resource<transient>{%size}) {
+    // CHECK-NEXT: stream.cmd.fill %c254_i32, %[[CONSUMER_CAPTURE]]
+    %1 = stream.async.fill %c254_i32, %capture[%c0 to %c128 for %c128] : i32 -> %capture as !stream.resource<transient>{%size}
+    stream.yield
+  } => !stream.timepoint
+  // CHECK: stream.resource.dealloca await(%[[CONSUMER_TIMEPOINT]]) => %[[ALLOCA]] : !stream.resource<transient>{%[[SIZE]]} => !stream.timepoint
+  // CHECK: return %[[CONSUMER_TIMEPOINT]]
+  return %consumer_timepoint : !stream.timepoint
+}
+
+// -----
+
 // Tests that concurrently executable regions don't introduce new allocations.
 // They should effectively be no-ops with respect to allocation so this looks
 // a lot like like the above tests.
@@ -284,6 +317,37 @@ func.func @applyAsyncSliceOp(%operand: !stream.resource<transient>, %size: index
 
 // -----
 
+// Tests that slices only read within the region reference their source range
+// directly instead of being copied into their own storage.
+
+// CHECK-LABEL: @applyAsyncSliceOpAliased
+// CHECK-SAME: (%[[SOURCE:.+]]: !stream.resource<transient>,
+// CHECK-SAME:  %[[TARGET:.+]]: !stream.resource<transient>,
+// CHECK-SAME:  %[[SIZE:.+]]: index)
+func.func @applyAsyncSliceOpAliased(%source: !stream.resource<transient>, %target: !stream.resource<transient>, %size: index) {
+  %c0 = arith.constant 0 : index
+  %c16 = arith.constant 16 : index
+  %c128 = arith.constant 128 : index
+  %c144 = arith.constant 144 : index
+  // CHECK-NOT: stream.resource.alloc
+  // CHECK: stream.cmd.execute
+  // CHECK-SAME: with(%[[SOURCE]] as %[[SOURCE_CAPTURE:.+]]: !stream.resource<transient>{%[[SIZE]]},
+  // CHECK-SAME:      %[[TARGET]] as %[[TARGET_CAPTURE:.+]]: !stream.resource<transient>{%[[SIZE]]})
+  %result, %result_timepoint = stream.async.execute with(%source as %captured_source: !stream.resource<transient>{%size}, %target as %captured_target: !stream.resource<transient>{%size}) -> (%target as !stream.resource<transient>{%size}) {
+    %0 = stream.async.slice %captured_source[%c16 to %c144] : !stream.resource<transient>{%size} -> !stream.resource<transient>{%c128}
+    // CHECK-NEXT: stream.cmd.copy %[[SOURCE_CAPTURE]][%c16], %[[TARGET_CAPTURE]][%c0], %c128
+    // CHECK-SAME: : !stream.resource<transient>{%[[SIZE]]} -> !stream.resource<transient>{%[[SIZE]]}
+    %1 = stream.async.copy %0[%c0 to %c128], %captured_target[%c0 to %c128], %c128 : !stream.resource<transient>{%c128} -> %captured_target as !stream.resource<transient>{%size}
+    // CHECK-NOT: stream.cmd.copy
+    stream.yield %1 : !stream.resource<transient>{%size}
+  } => !stream.timepoint
+  // CHECK: util.optimization_barrier %[[TARGET]]
+  util.optimization_barrier %result : !stream.resource<transient>
+  return
+}
+
+// -----
+
 // CHECK-LABEL: @applyAsyncFillOp
 // CHECK-SAME: (%[[OPERAND:.+]]: !stream.resource<transient>, %[[SIZE:.+]]: index)
 func.func @applyAsyncFillOp(%operand: !stream.resource<transient>, %size: index) {
@@ -331,6 +395,32 @@ func.func @applyAsyncUpdateOp(%update: !stream.resource<external>, %operand: !st
 
 // -----
 
+// Tests that values produced only to be written into a target by an update are
+// produced in-place within the target range instead of being copied.
+
+// CHECK-LABEL: @applyAsyncUpdateOpEmplaced
+// CHECK-SAME: (%[[OPERAND:.+]]: !stream.resource<transient>, %[[SIZE:.+]]: index)
+func.func @applyAsyncUpdateOpEmplaced(%operand: !stream.resource<transient>, %size: index) {
+  %c16 = arith.constant 16 : index
+  %c128 = arith.constant 128 : index
+  %c144 = arith.constant 144 : index
+  %c255_i32 = arith.constant 255 : i32
+  // CHECK-NOT: stream.resource.alloc
+  // CHECK: stream.cmd.execute with(%[[OPERAND]] as %[[CAPTURE:.+]]: !stream.resource<transient>{%[[SIZE]]})
+  %result, %result_timepoint = stream.async.execute with(%operand as %capture: !stream.resource<transient>{%size}) -> (%operand as !stream.resource<transient>{%size}) {
+    // CHECK-NEXT: stream.cmd.fill %c255_i32, %[[CAPTURE]][%c16 for %c128] : i32 -> !stream.resource<transient>{%[[SIZE]]}
+    %0 = stream.async.splat %c255_i32 : i32 -> !stream.resource<transient>{%c128}
+    // CHECK-NOT: stream.cmd.copy
+    %1 = stream.async.update %0, %capture[%c16 to %c144] : !stream.resource<transient>{%c128} -> %capture as !stream.resource<transient>{%size}
+    stream.yield %1 : !stream.resource<transient>{%size}
+  } => !stream.timepoint
+  // CHECK: util.optimization_barrier %[[OPERAND]]
+  util.optimization_barrier %result : !stream.resource<transient>
+  return
+}
+
+// -----
+
 // CHECK-LABEL: @applyAsyncCopyOp
 // CHECK-SAME: (%[[SOURCE:.+]]: !stream.resource<external>,
 // CHECK-SAME:  %[[TARGET:.+]]: !stream.resource<transient>,
@@ -391,8 +481,6 @@ func.func @applyConcurrentAsyncCopyOp(%source: !stream.resource<external>, %targ
 
 // -----
 
-// TODO(#11249): add a test for in-place collectives (send == recv).
-
 // CHECK-LABEL: @applyAsyncCollectiveOpOutOfPlace
 // CHECK-SAME: (%[[SEND:.+]]: !stream.resource<external>, %[[SEND_SIZE:[a-z0-9]+]]: index,
 // CHECK-SAME:  %[[RECV:.+]]: !stream.resource<transient>, %[[RECV_SIZE:[a-z0-9]+]]: index,
@@ -420,6 +508,38 @@ func.func @applyAsyncCollectiveOpOutOfPlace(%send: !stream.resource<external>, %
 
 // -----
 
+// Tests that all-reduce sources produced within the region are placed into the
+// recv range such that the collective is performed in-place.
+
+// CHECK-LABEL: @applyAsyncCollectiveOpInPlace
+// CHECK-SAME: (%[[RECV:.+]]: !stream.resource<transient>, %[[RECV_SIZE:[a-z0-9]+]]: index,
+// CHECK-SAME:  %[[COUNT:[a-z0-9]+]]: index)
+func.func @applyAsyncCollectiveOpInPlace(%recv: !stream.resource<transient>, %recv_size: index, %count: index) {
+  %c0 = arith.constant 0 : index
+  %c128 = arith.constant 128 : index
+  %c0_i32 = arith.constant 0 : i32
+  %channel = stream.channel.default : !stream.channel
+  // CHECK-NOT: stream.resource.alloc
+  // CHECK: stream.cmd.execute with(%[[RECV]] as %[[RECV_CAPTURE:.+]]: !stream.resource<transient>{%[[RECV_SIZE]]})
+  %result, %result_timepoint = stream.async.execute with(%recv as %captured_recv: !stream.resource<transient>{%recv_size}) -> (%recv as !stream.resource<transient>{%recv_size}) {
+    // CHECK-NEXT: stream.cmd.fill %c0_i32, %[[RECV_CAPTURE]][%c0{{[_0-9]*}} for %c128] : i32 -> !stream.resource<transient>{%[[RECV_SIZE]]}
+    %send = stream.async.splat %c0_i32 : i32 -> !stream.resource<transient>{%c128}
+    // CHECK-NEXT: stream.cmd.collective<all_reduce with sum : f32>[%[[COUNT]]]
+    %0 = stream.async.collective<all_reduce with sum : f32>[%count] channel(%channel)
+        // CHECK-NEXT: ro %[[RECV_CAPTURE]][%c0{{[_0-9]*}} for %c128] : !stream.resource<transient>{%[[RECV_SIZE]]}
+        %send[%c0 to %c128 for %c128],
+        // CHECK-NEXT: wo %[[RECV_CAPTURE]][%c0{{[_0-9]*}} for %[[RECV_SIZE]]] : !stream.resource<transient>{%[[RECV_SIZE]]}
+        %captured_recv[%c0 to %c128 for %c128] :
+        !stream.resource<transient>{%c128} -> %captured_recv as !stream.resource<transient>{%recv_size}
+    stream.yield %0 : !stream.resource<transient>{%recv_size}
+  } => !stream.timepoint
+  // CHECK: util.optimization_barrier %[[RECV]]
+  util.optimization_barrier %result : !stream.resource<transient>
+  return
+}
+
+// -----
+
 // TODO(benvanik): test affinity changes that would introduce invalidate/fill.
 
 // CHECK-LABEL: @applyAsyncTransferOp
@@ -0,0 +1,91 @@
+// RUN: iree-opt --split-input-file --pass-pipeline="builtin.module(func.func(iree-stream-schedule-memory{max-transient-size=1500}))" %s | FileCheck %s
+
+// Tests that independent chains are reordered so that only one of their large
+// intermediates is live at a time.
+
+// CHECK-LABEL: @reorderChains
+func.func @reorderChains(%arg0: !stream.resource<external>) -> !stream.resource<external> {
+  %c0 = arith.constant 0 : index
+  %c1 = arith.constant 1 : index
+  %c16 = arith.constant 16 : index
+  %c80 = arith.constant 80 : index
+  %c1024 = arith.constant 1024 : index
+  // CHECK: stream.async.execute
+  %results, %result_timepoint = stream.async.execute with(%arg0 as %arg1: !stream.resource<external>{%c80}) -> !stream.resource<external>{%c16} {
+    // CHECK: %[[A0:.+]] = stream.async.dispatch @ex::@a0
+    %a0 = stream.async.dispatch @ex::@a0[%c1, %c1, %c1](%arg1[%c0 to %c80 for %c80]) : (!stream.resource<external>{%c80}) -> !stream.resource<transient>{%c1024}
+    %b0 = stream.async.dispatch @ex::@b0[%c1, %c1, %c1](%arg1[%c0 to %c80 for %c80]) : (!stream.resource<external>{%c80}) -> !stream.resource<transient>{%c1024}
+    // CHECK-NEXT: %[[A1:.+]] = stream.async.dispatch @ex::@a1[%c1, %c1, %c1](%[[A0]]
+    %a1 = stream.async.dispatch @ex::@a1[%c1, %c1, %c1](%a0[%c0 to %c1024 for %c1024]) : (!stream.resource<transient>{%c1024}) -> !stream.resource<transient>{%c16}
+    // CHECK-NEXT: %[[B0:.+]] = stream.async.dispatch @ex::@b0
+    // CHECK-NEXT: %[[B1:.+]] = stream.async.dispatch @ex::@b1[%c1, %c1, %c1](%[[B0]]
+    %b1 = stream.async.dispatch @ex::@b1[%c1, %c1, %c1](%b0[%c0 to %c1024 for %c1024]) : (!stream.resource<transient>{%c1024}) -> !stream.resource<transient>{%c16}
+    // CHECK-NEXT: %[[C:.+]] = stream.async.dispatch @ex::@c[%c1, %c1, %c1](%[[A1]]{{.+}}, %[[B1]]
+    %c = stream.async.dispatch @ex::@c[%c1, %c1, %c1](%a1[%c0 to %c16 for %c16], %b1[%c0 to %c16 for %c16]) : (!stream.resource<transient>{%c16}, !stream.resource<transient>{%c16}) -> !stream.resource<external>{%c16}
+    // CHECK-NEXT: stream.yield %[[C]]
+    stream.yield %c : !stream.resource<external>{%c16}
+    // CHECK-NEXT: } => !stream.timepoint attributes {stream.partitioning = #stream.partitioning_config<"min-peak-memory">}
+  } => !stream.timepoint
+  %0 = stream.timepoint.await %result_timepoint => %results : !stream.resource<external>{%c16}
+  return %0 : !stream.resource<external>
+}
+
+// -----
+
+// Tests that a splat used before and after a chain of large intermediates that
+// can't be reordered is recomputed at its second use instead of being held
+// live across the chain.
+
+// CHECK-LABEL: @rematerializeSplat
+func.func @rematerializeSplat(%arg0: !stream.resource<external>) -> !stream.resource<external> {
+  %c0 = arith.constant 0 : index
+  %c1 = arith.constant 1 : index
+  %c16 = arith.constant 16 : index
+  %c80 = arith.constant 80 : index
+  %c1024 = arith.constant 1024 : index
+  %c255_i32 = arith.constant 255 : i32
+  // CHECK: stream.async.execute
+  %results, %result_timepoint = stream.async.execute with(%arg0 as %arg1: !stream.resource<external>{%c80}) -> !stream.resource<external>{%c16} {
+    // CHECK: %[[SPLAT0:.+]] = stream.async.splat %c255_i32
+    %splat = stream.async.splat %c255_i32 : i32 -> !stream.resource<transient>{%c1024}
+    // CHECK-NEXT: %[[X:.+]] = stream.async.dispatch @ex::@x[%c1, %c1, %c1](%[[SPLAT0]]
+    %x = stream.async.dispatch @ex::@x[%c1, %c1, %c1](%splat[%c0 to %c1024 for %c1024]) : (!stream.resource<transient>{%c1024}) -> !stream.resource<transient>{%c16}
+    // CHECK-NEXT: %[[BIG0:.+]] = stream.async.dispatch @ex::@big0[%c1, %c1, %c1](%[[X]]
+    %big0 = stream.async.dispatch @ex::@big0[%c1, %c1, %c1](%x[%c0 to %c16 for %c16]) : (!stream.resource<transient>{%c16}) -> !stream.resource<transient>{%c1024}
+    // CHECK-NEXT: %[[BIG1:.+]] = stream.async.dispatch @ex::@big1[%c1, %c1, %c1](%[[BIG0]]
+    %big1 = stream.async.dispatch @ex::@big1[%c1, %c1, %c1](%big0[%c0 to %c1024 for %c1024]) : (!stream.resource<transient>{%c1024}) -> !stream.resource<transient>{%c16}
+    // CHECK-NEXT: %[[SPLAT1:.+]] = stream.async.splat %c255_i32
+    // CHECK-NEXT: %[[Y:.+]] = stream.async.dispatch @ex::@y[%c1, %c1, %c1](%[[SPLAT1]]{{.+}}, %[[BIG1]]
+    %y = stream.async.dispatch @ex::@y[%c1, %c1, %c1](%splat[%c0 to %c1024 for %c1024], %big1[%c0 to %c16 for %c16]) : (!stream.resource<transient>{%c1024}, !stream.resource<transient>{%c16}) -> !stream.resource<external>{%c16}
+    // CHECK-NEXT: stream.yield %[[Y]]
+    stream.yield %y : !stream.resource<external>{%c16}
+  } => !stream.timepoint
+  %0 = stream.timepoint.await %result_timepoint => %results : !stream.resource<external>{%c16}
+  return %0 : !stream.resource<external>
+}
+
+// -----
+
+// Tests that regions within the budget are left as-is.
+
+// CHECK-LABEL: @withinBudget
+func.func @withinBudget(%arg0: !stream.resource<external>) -> !stream.resource<external> {
+  %c0 = arith.constant 0 : index
+  %c1 = arith.constant 1 : index
+  %c16 = arith.constant 16 : index
+  %c80 = arith.constant 80 : index
+  %c512 = arith.constant 512 : index
+  // CHECK: stream.async.execute
+  %results, %result_timepoint = stream.async.execute with(%arg0 as %arg1: !stream.resource<external>{%c80}) -> !stream.resource<external>{%c16} {
+    // CHECK: stream.async.dispatch @ex::@a0
+    %a0 = stream.async.dispatch @ex::@a0[%c1, %c1, %c1](%arg1[%c0 to %c80 for %c80]) : (!stream.resource<external>{%c80}) -> !stream.resource<transient>{%c512}
+    // CHECK-NEXT: stream.async.dispatch @ex::@b0
+    %b0 = stream.async.dispatch @ex::@b0[%c1, %c1, %c1](%arg1[%c0 to %c80 for %c80]) : (!stream.resource<external>{%c80}) -> !stream.resource<transient>{%c512}
+    // CHECK-NEXT: stream.async.dispatch @ex::@c
+    %c = stream.async.dispatch @ex::@c[%c1, %c1, %c1](%a0[%c0 to %c512 for %c512], %b0[%c0 to %c512 for %c512]) : (!stream.resource<transient>{%c512}, !stream.resource<transient>{%c512}) -> !stream.resource<external>{%c16}
+    stream.yield %c : !stream.resource<external>{%c16}
+    // CHECK: } => !stream.timepoint{{$}}
+  } => !stream.timepoint
+  %0 = stream.timepoint.await %result_timepoint => %results : !stream.resource<external>{%c16}
+  return %0 : !stream.resource<external>
+}
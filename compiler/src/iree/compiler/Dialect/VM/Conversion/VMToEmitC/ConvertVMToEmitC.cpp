@@ -437,7 +437,8 @@ LogicalResult retainOrMoveRefs(OpBuilder &builder, Location location,
       return failure();
     }
 
-    StringRef callee = isMove ? "iree_vm_ref_move" : "iree_vm_ref_retain";
+    StringRef callee = isMove ? "iree_vm_ref_move_inline"
+                              : "iree_vm_ref_retain_inline";
     builder.create<emitc::CallOp>(
         /*location=*/location,
         /*type=*/TypeRange{},
@@ -452,7 +453,8 @@ LogicalResult retainOrMoveRefs(OpBuilder &builder, Location location,
   for (const auto &[srcRef, destRef] : mapping.getValueMap()) {
     Value tmpRef = tmpMapping.lookup(srcRef);
 
-    StringRef callee = isMove ? "iree_vm_ref_move" : "iree_vm_ref_assign";
+    StringRef callee = isMove ? "iree_vm_ref_move_inline"
+                              : "iree_vm_ref_assign_inline";
 
     builder.create<emitc::CallOp>(
         /*location=*/location,
@@ -2179,7 +2181,7 @@ class ImportOpConverter {
         builder.create<emitc::CallOp>(
             /*location=*/loc,
             /*type=*/TypeRange{},
-            /*callee=*/StringAttr::get(ctx, "iree_vm_ref_assign"),
+            /*callee=*/StringAttr::get(ctx, "iree_vm_ref_assign_inline"),
             /*args=*/ArrayAttr{},
             /*templateArgs=*/ArrayAttr{},
             /*operands=*/ArrayRef<Value>{arg, refPtr});
@@ -2261,7 +2263,7 @@ class ImportOpConverter {
         builder.create<emitc::CallOp>(
             /*location=*/loc,
             /*type=*/TypeRange{},
-            /*callee=*/StringAttr::get(ctx, "iree_vm_ref_move"),
+            /*callee=*/StringAttr::get(ctx, "iree_vm_ref_move_inline"),
             /*args=*/ArrayAttr{},
             /*templateArgs=*/ArrayAttr{},
             /*operands=*/ArrayRef<Value>{refPtr, arg});
@@ -2644,7 +2646,7 @@ class CallOpConversion : public OpConversionPattern<CallOpTy> {
     builder.create<emitc::CallOp>(
         /*location=*/loc,
         /*type=*/TypeRange{},
-        /*callee=*/StringAttr::get(ctx, "iree_vm_ref_assign"),
+        /*callee=*/StringAttr::get(ctx, "iree_vm_ref_assign_inline"),
         /*args=*/ArrayAttr{},
         /*templateArgs=*/ArrayAttr{},
         /*operands=*/
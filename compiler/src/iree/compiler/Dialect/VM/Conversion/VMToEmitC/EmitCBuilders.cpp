@@ -168,7 +168,7 @@ void ireeVmRefRelease(OpBuilder builder, Location location, Value operand) {
   builder.create<emitc::CallOp>(
       /*location=*/location,
       /*type=*/TypeRange{},
-      /*callee=*/StringAttr::get(ctx, "iree_vm_ref_release"),
+      /*callee=*/StringAttr::get(ctx, "iree_vm_ref_release_inline"),
       /*args=*/ArrayAttr{},
       /*templateArgs=*/ArrayAttr{},
       /*operands=*/ArrayRef<Value>{operand});
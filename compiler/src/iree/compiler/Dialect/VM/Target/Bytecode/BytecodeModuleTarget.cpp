@@ -27,6 +27,8 @@
 #include "llvm/Support/CRC.h"
 #include "llvm/Support/Endian.h"
 #include "llvm/Support/ErrorHandling.h"
+#include "llvm/Support/MathExtras.h"
+#include "llvm/Support/ToolOutputFile.h"
 #include "mlir/IR/Attributes.h"
 #include "mlir/IR/BuiltinOps.h"
 #include "mlir/IR/Diagnostics.h"
@@ -34,6 +36,7 @@
 #include "mlir/IR/Visitors.h"
 #include "mlir/Pass/Pass.h"
 #include "mlir/Pass/PassManager.h"
+#include "mlir/Support/FileUtilities.h"
 #include "mlir/Tools/mlir-translate/Translation.h"
 #include "mlir/Transforms/DialectConversion.h"
 #include "mlir/Transforms/LocationSnapshot.h"
@@ -64,7 +67,8 @@ struct TypeDef {
 };
 
 // A rodata reference.
-// The archive file is empty if the data is to be embedded in the FlatBuffer.
+// The archive file and parameter offset are empty if the data is to be
+// embedded in the FlatBuffer.
 struct RodataRef {
   // Source op.
   IREE::VM::RodataOp rodataOp;
@@ -74,6 +78,8 @@ struct RodataRef {
   uint64_t totalSize = 0;
   // Optional reference to the rodata in the file.
   Optional<ArchiveWriter::File> archiveFile;
+  // Optional absolute offset of the rodata in the parameter file.
+  Optional<uint64_t> parameterOffset;
 };
 
 }  // namespace
@@ -422,7 +428,16 @@ static LogicalResult buildFlatBufferModule(
   // layout planning by preserving the order in the IR is useful.
   SmallVector<iree_vm_RodataSegmentDef_ref_t, 8> rodataSegmentRefs;
   for (auto &rodataRef : llvm::reverse(rodataRefs)) {
-    if (rodataRef.archiveFile.has_value()) {
+    if (rodataRef.parameterOffset.has_value()) {
+      // Data is in the parameter file at an absolute offset.
+      iree_vm_RodataSegmentDef_start(fbb);
+      iree_vm_RodataSegmentDef_external_data_offset_add(
+          fbb, rodataRef.parameterOffset.value());
+      iree_vm_RodataSegmentDef_external_data_length_add(fbb,
+                                                          rodataRef.totalSize);
+      iree_vm_RodataSegmentDef_external_data_in_parameters_add(fbb, true);
+      rodataSegmentRefs.push_back(iree_vm_RodataSegmentDef_end(fbb));
+    } else if (rodataRef.archiveFile.has_value()) {
       // Data is already in the file at a calculated offset.
       iree_vm_RodataSegmentDef_start(fbb);
       iree_vm_RodataSegmentDef_external_data_offset_add(
@@ -559,6 +574,42 @@ static LogicalResult buildFlatBufferModule(
   return success();
 }
 
+// Writes the rodata assigned to the parameter file into |path| at the offsets
+// recorded in |rodataRefs|. Padding between entries is zero-filled so that the
+// file contents are deterministic.
+static LogicalResult writeParameterFile(Location loc, StringRef path,
+                                        ArrayRef<RodataRef> rodataRefs) {
+  std::string error;
+  auto file = mlir::openOutputFile(path, &error);
+  if (!file) {
+    return mlir::emitError(loc)
+           << "failed to open parameter file '" << path << "': " << error;
+  }
+  auto &os = file->os();
+  uint64_t offset = 0;
+  for (auto &rodataRef : rodataRefs) {
+    if (!rodataRef.parameterOffset.has_value()) continue;
+    uint64_t parameterOffset = rodataRef.parameterOffset.value();
+    assert(parameterOffset >= offset && "rodata must be laid out in order");
+    os.write_zeros(parameterOffset - offset);
+    auto rodataValue = rodataRef.rodataOp.getValue()
+                           .cast<IREE::Util::SerializableAttrInterface>();
+    if (failed(rodataValue.serializeToStream(llvm::support::endianness::little,
+                                             os))) {
+      return rodataRef.rodataOp.emitError()
+             << "failed to serialize rodata to the parameter file";
+    }
+    offset = parameterOffset + rodataRef.totalSize;
+  }
+  os.flush();
+  if (os.has_error()) {
+    return mlir::emitError(loc)
+           << "failed to write parameter file '" << path << "'";
+  }
+  file->keep();
+  return success();
+}
+
 LogicalResult translateModuleToBytecode(IREE::VM::ModuleOp moduleOp,
                                         BytecodeTargetOptions targetOptions,
                                         llvm::raw_ostream &output) {
@@ -630,6 +681,10 @@ LogicalResult translateModuleToBytecode(IREE::VM::ModuleOp moduleOp,
   for (auto rodataOp : moduleOp.getOps<IREE::VM::RodataOp>()) {
     rodataOps[rodataOp.getOrdinal()->getLimitedValue()] = rodataOp;
   }
+  bool useParameterFile =
+      !targetOptions.parameterFile.empty() &&
+      targetOptions.outputFormat == BytecodeOutputFormat::kFlatBufferBinary;
+  uint64_t parameterFileSize = 0;
   SmallVector<RodataRef> rodataRefs;
   rodataRefs.resize(rodataOps.size());
   for (auto &rodataOp : rodataOps) {
@@ -650,7 +705,16 @@ LogicalResult translateModuleToBytecode(IREE::VM::ModuleOp moduleOp,
     rodataRef.alignment =
         rodataOp.getAlignment().value_or(kDefaultRodataAlignment);
     rodataRef.totalSize = static_cast<uint64_t>(actualSize);
-    if (storeExternal) {
+    if (useParameterFile && !rodataOp.getMimeType().has_value() &&
+        actualSize >= kMaxEmbeddedDataSize) {
+      // Large constants are laid out in the parameter file in ordinal order
+      // so that uploads read the file sequentially. Anything with a mime type
+      // (executables, etc) is tied to the compiled program and stays in the
+      // module archive.
+      parameterFileSize = llvm::alignTo(parameterFileSize, rodataRef.alignment);
+      rodataRef.parameterOffset = parameterFileSize;
+      parameterFileSize += rodataRef.totalSize;
+    } else if (storeExternal) {
       std::string fileName =
           (rodataOp.getName() +
            mimeTypeToFileExtension(rodataOp.getMimeType().value_or("")))
@@ -665,6 +729,12 @@ LogicalResult translateModuleToBytecode(IREE::VM::ModuleOp moduleOp,
     rodataRefs[rodataOp.getOrdinal()->getLimitedValue()] = rodataRef;
   }
 
+  if (useParameterFile &&
+      failed(writeParameterFile(moduleOp.getLoc(), targetOptions.parameterFile,
+                                rodataRefs))) {
+    return failure();
+  }
+
   // NOTE: we order things so that all of the metadata is close to the start of
   // the module header in memory. This ensures that when we map the file only
   // the first few pages need to be accessed to get the metadata and the rest
@@ -732,6 +802,13 @@ void BytecodeTargetOptions::bindOptions(OptionsBinder &binder) {
       llvm::cl::desc(
           "Enables output files to be viewed as zip files for debugging "
           "(only applies to binary targets)"));
+  binder.opt<std::string>(
+      "iree-vm-bytecode-module-parameter-file", parameterFile,
+      llvm::cl::cat(vmBytecodeOptionsCategory),
+      llvm::cl::desc(
+          "Writes large constants to the given parameter file instead of "
+          "embedding them in the module; the runtime must be passed the same "
+          "file (or one of the same layout) when loading the module"));
 }
 
 }  // namespace VM
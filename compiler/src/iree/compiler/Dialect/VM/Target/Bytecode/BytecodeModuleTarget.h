@@ -56,6 +56,12 @@ struct BytecodeTargetOptions {
   // should be disabled in release builds.
   bool emitPolyglotZip = true;
 
+  // Path of a parameter file to write large rodata into instead of the module.
+  // The module references the data by offset and the runtime maps the file
+  // when the module is loaded. Parameter files can be replaced with new
+  // contents of the same layout without recompiling the module.
+  std::string parameterFile;
+
   void bindOptions(OptionsBinder &binder);
   using FromFlags = OptionsFromFlags<BytecodeTargetOptions>;
 };
@@ -225,6 +225,23 @@ class QueryTileSizesOpConversion
   }
 };
 
+// Converts the vmvx.reduce op to an appropriate typed import.
+class ReduceOpConversion : public VMVXImportOpConversion<IREE::VMVX::ReduceOp> {
+ public:
+  using VMVXImportOpConversion::VMVXImportOpConversion;
+
+  std::string getImportFqName(IREE::VMVX::ReduceOp op) const override {
+    int rank = op.getInStrides().size();
+    std::string name("vmvx.reduce.");
+    name.append(op.getOpcode().begin(), op.getOpcode().end());
+    name.append(".");
+    name.append(std::to_string(rank));
+    name.append("d.");
+    name.append(getTypedTypeStr(op.getElementType()));
+    return name;
+  }
+};
+
 class UnaryOpConversion : public VMVXImportOpConversion<IREE::VMVX::UnaryOp> {
  public:
   using VMVXImportOpConversion::VMVXImportOpConversion;
@@ -250,8 +267,9 @@ void populateVMVXToVMPatterns(MLIRContext *context,
                               RewritePatternSet &patterns) {
   patterns
       .insert<BinaryOpConversion, CopyOpConversion, Fill2DOpConversion,
-              MatmulOpConversion, Mmt4dOpConversion, UnaryOpConversion,
-              PackOpConversion, UnpackOpConversion, QueryTileSizesOpConversion>(
+              MatmulOpConversion, Mmt4dOpConversion, ReduceOpConversion,
+              UnaryOpConversion, PackOpConversion, UnpackOpConversion,
+              QueryTileSizesOpConversion>(
           context, importSymbols, typeConverter);
 }
 
@@ -0,0 +1,23 @@
+// RUN: iree-opt --iree-vm-target-index-bits=64 --split-input-file \
+// RUN:   --iree-vm-conversion --canonicalize %s | FileCheck %s
+
+// CHECK-LABEL: @reduce_max_2d_f32
+func.func @reduce_max_2d_f32(
+    // IN
+    %arg0 : !util.buffer, %arg1 : index, %arg2 : index, %arg3 : index,
+    // OUT
+    %arg4 : !util.buffer, %arg5 : index, %arg6 : index,
+    // SIZE
+    %arg7 : index, %arg8 : index) {
+
+  //      CHECK: vm.call @vmvx.reduce.max.2d.f32(
+  // CHECK-SAME:   %arg0, %arg1, %arg2, %arg3,
+  // CHECK-SAME:   %arg4, %arg5, %arg6,
+  // CHECK-SAME:   %arg7, %arg8)
+  // CHECK-SAME: : (!vm.buffer, i64, i64, i64, !vm.buffer, i64, i64, i64, i64) -> ()
+  vmvx.reduce op("max" : f32)
+           in(%arg0 offset %arg1 strides[%arg2, %arg3] : !util.buffer)
+           out(%arg4 offset %arg5 stride %arg6 : !util.buffer)
+           sizes(%arg7, %arg8)
+  func.return
+}
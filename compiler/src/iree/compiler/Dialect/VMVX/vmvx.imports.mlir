@@ -355,6 +355,82 @@ vm.import @rsqrt.2d.f32(
   %sizes : tuple<i64, i64>
 )
 
+vm.import @tanh.2d.f32(
+  %in_buffer : !vm.buffer,
+  %in_offset : i64,
+  %in_strides : tuple<i64, i64>,
+  %out_buffer : !vm.buffer,
+  %out_offset : i64,
+  %out_strides : tuple<i64, i64>,
+  %sizes : tuple<i64, i64>
+)
+
+//===----------------------------------------------------------------------===//
+// VMVX Reduction Kernels
+// Each reduces the rows of a 2d input into a 1d output and is specialized by
+// opcode, rank and type width.
+//===----------------------------------------------------------------------===//
+
+vm.import @reduce.add.2d.f32(
+  %in_buffer : !vm.buffer,
+  %in_offset : i64,
+  %in_strides : tuple<i64, i64>,
+  %out_buffer : !vm.buffer,
+  %out_offset : i64,
+  %out_stride : i64,
+  %sizes : tuple<i64, i64>
+)
+
+vm.import @reduce.add.2d.i32(
+  %in_buffer : !vm.buffer,
+  %in_offset : i64,
+  %in_strides : tuple<i64, i64>,
+  %out_buffer : !vm.buffer,
+  %out_offset : i64,
+  %out_stride : i64,
+  %sizes : tuple<i64, i64>
+)
+
+vm.import @reduce.max.2d.f32(
+  %in_buffer : !vm.buffer,
+  %in_offset : i64,
+  %in_strides : tuple<i64, i64>,
+  %out_buffer : !vm.buffer,
+  %out_offset : i64,
+  %out_stride : i64,
+  %sizes : tuple<i64, i64>
+)
+
+vm.import @reduce.maxs.2d.i32(
+  %in_buffer : !vm.buffer,
+  %in_offset : i64,
+  %in_strides : tuple<i64, i64>,
+  %out_buffer : !vm.buffer,
+  %out_offset : i64,
+  %out_stride : i64,
+  %sizes : tuple<i64, i64>
+)
+
+vm.import @reduce.min.2d.f32(
+  %in_buffer : !vm.buffer,
+  %in_offset : i64,
+  %in_strides : tuple<i64, i64>,
+  %out_buffer : !vm.buffer,
+  %out_offset : i64,
+  %out_stride : i64,
+  %sizes : tuple<i64, i64>
+)
+
+vm.import @reduce.mins.2d.i32(
+  %in_buffer : !vm.buffer,
+  %in_offset : i64,
+  %in_strides : tuple<i64, i64>,
+  %out_buffer : !vm.buffer,
+  %out_offset : i64,
+  %out_stride : i64,
+  %sizes : tuple<i64, i64>
+)
+
 //==============================================================================
 // Strided copy ops
 // Variants of copy ops exist for power of two rank and datatype sizes.
@@ -44,6 +44,8 @@ spirv::Vendor getVendor(const TargetTriple &triple) {
       return spirv::Vendor::NVIDIA;
     case TargetTripleArch::QC_Adreno:
       return spirv::Vendor::Qualcomm;
+    case TargetTripleArch::Intel_Arc:
+      return spirv::Vendor::Intel;
     case TargetTripleArch::CPU:
       switch (triple.getProduct()) {
         case TargetTripleProduct::SwiftShader:
@@ -69,6 +71,7 @@ spirv::DeviceType getDeviceType(const TargetTriple &triple) {
     case TargetTripleArch::AMD_RDNAv3:
     case TargetTripleArch::NV_Turing:
     case TargetTripleArch::NV_Ampere:
+    case TargetTripleArch::Intel_Arc:
       return spirv::DeviceType::DiscreteGPU;
     case TargetTripleArch::Apple_M1:
     case TargetTripleArch::ARM_Valhall:
@@ -230,10 +233,16 @@ CapabilitiesAttr getCapabilities(const TargetTriple &triple,
     case TargetTripleArch::AMD_RDNAv3: {
       auto f16t = builder.getF16Type();
       auto scope = ScopeNVAttr::get(context, ScopeNV::Subgroup);
+      // WMMA supports both f16 and f32 accumulation for f16 inputs.
+      auto f32t = builder.getF32Type();
       coopmatCases.push_back(CooperativeMatrixPropertiesNVAttr::get(
           context,
           /*mSize=*/16, /*nSize=*/16, /*kSize=*/16, /*aType=*/f16t,
           /*bType=*/f16t, /*cType=*/f16t, /*resultType=*/f16t, scope));
+      coopmatCases.push_back(CooperativeMatrixPropertiesNVAttr::get(
+          context,
+          /*mSize=*/16, /*nSize=*/16, /*kSize=*/16, /*aType=*/f16t,
+          /*bType=*/f16t, /*cType=*/f32t, /*resultType=*/f32t, scope));
     }
       LLVM_FALLTHROUGH;
     case TargetTripleArch::AMD_RDNAv1:
@@ -365,6 +374,33 @@ CapabilitiesAttr getCapabilities(const TargetTriple &triple,
           /*mSize=*/16, /*nSize=*/16, /*kSize=*/16, /*aType=*/f16t,
           /*bType=*/f16t, /*cType=*/f32t, /*resultType=*/f32t, scope));
     } break;
+    case TargetTripleArch::Intel_Arc:
+      // Intel drivers do not expose VK_NV_cooperative_matrix so XMX engines
+      // are not reachable with the cooperative matrix lowering we have; no
+      // cooperative matrix properties are listed and matmuls use SIMT.
+      maxComputeSharedMemorySize = 65536;
+      maxComputeWorkGroupInvocations = 1024;
+      maxComputeWorkGroupSize = {1024, 1024, 1024};
+
+      subgroupSize = 32, minSubgroupSize = 8, maxSubgroupSize = 32;
+      subgroupFeatures = SubgroupFeature::Basic | SubgroupFeature::Vote |
+                         SubgroupFeature::Arithmetic | SubgroupFeature::Ballot |
+                         SubgroupFeature::Shuffle |
+                         SubgroupFeature::ShuffleRelative |
+                         SubgroupFeature::Clustered | SubgroupFeature::Quad;
+
+      // Xe-HPG has no native fp64 support.
+      shaderFloat16 = true;
+      shaderFloat64 = false;
+      shaderInt8 = shaderInt16 = shaderInt64 = true;
+
+      storageBuffer16BitAccess = storagePushConstant16 = true;
+      uniformAndStorageBuffer16BitAccess = true;
+      storageBuffer8BitAccess = true, storagePushConstant8 = true;
+      uniformAndStorageBuffer8BitAccess = true;
+
+      variablePointers = variablePointersStorageBuffer = true;
+      break;
     case TargetTripleArch::QC_Adreno:
       // Example: https://vulkan.gpuinfo.org/displayreport.php?id=10983 (11)
       // Example: https://vulkan.gpuinfo.org/displayreport.php?id=16312 (12)
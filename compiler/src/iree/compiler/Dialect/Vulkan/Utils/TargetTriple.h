@@ -31,6 +31,7 @@ namespace Vulkan {
 /// For example:
 ///   ampere-rtx3080-windows
 ///   rdna1-5700xt-linux
+///   arc-a770-windows
 ///   adreno-a650-android30
 ///   valhall-unknown-android30
 ///   cpu-swiftshader-unknown
@@ -118,6 +118,34 @@ OpFoldResult BufferStorageOp::fold(ArrayRef<Attribute> operands) {
   return {};
 }
 
+namespace {
+
+/// Replaces storage queries on buffers wrapping host storage with a subspan of
+/// the wrapped storage. This lets rodata and other wrapped buffers be accessed
+/// without round-tripping through the HAL buffer.
+struct FoldBufferStorageOfWrap : public OpRewritePattern<BufferStorageOp> {
+  using OpRewritePattern<BufferStorageOp>::OpRewritePattern;
+  LogicalResult matchAndRewrite(BufferStorageOp op,
+                                PatternRewriter &rewriter) const override {
+    auto wrapOp =
+        dyn_cast_or_null<BufferWrapOp>(op.getBuffer().getDefiningOp());
+    if (!wrapOp) return failure();
+    auto sourceSize = rewriter.createOrFold<IREE::Util::BufferSizeOp>(
+        op.getLoc(), wrapOp.getSource());
+    rewriter.replaceOpWithNewOp<IREE::Util::BufferSubspanOp>(
+        op, wrapOp.getSource(), sourceSize, wrapOp.getOffset(),
+        wrapOp.getLength());
+    return success();
+  }
+};
+
+}  // namespace
+
+void BufferStorageOp::getCanonicalizationPatterns(RewritePatternSet &results,
+                                                  MLIRContext *context) {
+  results.insert<FoldBufferStorageOfWrap>(context);
+}
+
 //===----------------------------------------------------------------------===//
 // hal_inline.buffer_view.create
 //===----------------------------------------------------------------------===//
@@ -26,6 +26,20 @@ func.func @FoldBufferStorageOp(%length: index) -> !util.buffer {
 
 // -----
 
+// CHECK-LABEL: func @FoldBufferStorageOfWrap
+// CHECK-SAME: (%[[SOURCE:.+]]: !util.buffer, %[[OFFSET:.+]]: index, %[[LENGTH:.+]]: index)
+func.func @FoldBufferStorageOfWrap(%source: !util.buffer, %offset: index, %length: index) -> !util.buffer {
+  %buffer = hal_inline.buffer.wrap source(%source : !util.buffer)[%offset, %length] : !hal.buffer
+  // CHECK-NOT: hal_inline.buffer.storage
+  // CHECK: %[[SOURCE_SIZE:.+]] = util.buffer.size %[[SOURCE]]
+  // CHECK: %[[SUBSPAN:.+]] = util.buffer.subspan %[[SOURCE]][%[[OFFSET]]] : !util.buffer{%[[SOURCE_SIZE]]} -> !util.buffer{%[[LENGTH]]}
+  %queried_storage = hal_inline.buffer.storage<%buffer : !hal.buffer> : !util.buffer
+  // CHECK: return %[[SUBSPAN]]
+  return %queried_storage : !util.buffer
+}
+
+// -----
+
 // CHECK-LABEL: @FoldBufferViewCreateSubspan
 // CHECK-SAME: (%[[BASE_BUFFER:.+]]: !hal.buffer, %[[SUBSPAN_OFFSET:.+]]: index, %[[SUBSPAN_LENGTH:.+]]: index)
 func.func @FoldBufferViewCreateSubspan(%base_buffer: !hal.buffer, %subspan_offset: index, %subspan_length: index) -> !hal.buffer_view {
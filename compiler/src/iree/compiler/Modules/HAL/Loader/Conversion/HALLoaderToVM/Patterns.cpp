@@ -12,6 +12,7 @@
 #include "iree/compiler/Dialect/VM/Conversion/ImportUtils.h"
 #include "iree/compiler/Dialect/VM/Conversion/TypeConverter.h"
 #include "iree/compiler/Dialect/VM/IR/VMOps.h"
+#include "llvm/ADT/SetVector.h"
 #include "mlir/IR/Attributes.h"
 #include "mlir/IR/Builders.h"
 #include "mlir/IR/BuiltinOps.h"
@@ -68,15 +69,23 @@ struct ExecutableLoadOpConversion
   mutable IREE::VM::ImportOp importOp;
 };
 
+// Converts dispatches to either the basic dispatch import taking a buffer per
+// binding or, when bindings share buffers, the packed dispatch import taking
+// each unique buffer once. Bindings commonly alias the same buffer at different
+// offsets and passing them once avoids redundant ref marshaling and
+// retain/release traffic per dispatch.
 struct ExecutableDispatchOpConversion
     : public OpConversionPattern<IREE::HAL::Loader::ExecutableDispatchOp> {
   ExecutableDispatchOpConversion(MLIRContext *context,
                                  SymbolTable &importSymbols,
                                  TypeConverter &typeConverter,
-                                 StringRef importName)
+                                 StringRef importName,
+                                 StringRef packedImportName)
       : OpConversionPattern(context) {
     importOp = importSymbols.lookup<IREE::VM::ImportOp>(importName);
     assert(importOp);
+    packedImportOp = importSymbols.lookup<IREE::VM::ImportOp>(packedImportName);
+    assert(packedImportOp);
   }
   LogicalResult matchAndRewrite(
       IREE::HAL::Loader::ExecutableDispatchOp dispatchOp, OpAdaptor adaptor,
@@ -100,29 +109,48 @@ struct ExecutableDispatchOpConversion
         /*workgroup_z=*/-1,
         /*push_constants=*/
         static_cast<int16_t>(pushConstants.size()),
-        /*bindings=*/
-        static_cast<int16_t>(adaptor.getBindingBuffers().size()),
     };
     callOperands.append(pushConstants.begin(), pushConstants.end());
-    for (auto it : llvm::zip_equal(adaptor.getBindingBuffers(),
-                                   adaptor.getBindingOffsets(),
+
+    auto bindingBuffers = adaptor.getBindingBuffers();
+    llvm::SetVector<Value> uniqueBuffers;
+    uniqueBuffers.insert(bindingBuffers.begin(), bindingBuffers.end());
+    bool usePacked = uniqueBuffers.size() < bindingBuffers.size();
+    if (usePacked) {
+      segmentSizes.push_back(/*binding_buffers=*/
+                             static_cast<int16_t>(uniqueBuffers.size()));
+      callOperands.append(uniqueBuffers.begin(), uniqueBuffers.end());
+    }
+    segmentSizes.push_back(/*bindings=*/
+                           static_cast<int16_t>(bindingBuffers.size()));
+    for (auto it : llvm::zip_equal(bindingBuffers, adaptor.getBindingOffsets(),
                                    adaptor.getBindingLengths())) {
-      callOperands.push_back(std::get<0>(it));
+      if (usePacked) {
+        int32_t ordinal = std::distance(
+            uniqueBuffers.begin(), llvm::find(uniqueBuffers, std::get<0>(it)));
+        callOperands.push_back(rewriter.create<IREE::VM::ConstI32Op>(
+            dispatchOp.getLoc(), ordinal));
+      } else {
+        callOperands.push_back(std::get<0>(it));
+      }
       callOperands.push_back(
           castToImportType(std::get<1>(it), rewriter.getI64Type(), rewriter));
       callOperands.push_back(
           castToImportType(std::get<2>(it), rewriter.getI64Type(), rewriter));
     }
-    auto importType = importOp.getFunctionType();
+
+    auto calleeOp = usePacked ? packedImportOp : importOp;
+    auto importType = calleeOp.getFunctionType();
     auto callOp = rewriter.replaceOpWithNewOp<IREE::VM::CallVariadicOp>(
-        dispatchOp, SymbolRefAttr::get(importOp), importType.getResults(),
+        dispatchOp, SymbolRefAttr::get(calleeOp), importType.getResults(),
         segmentSizes, importType.getInputs(), callOperands);
-    copyImportAttrs(importOp, callOp);
+    copyImportAttrs(calleeOp, callOp);
     return success();
   }
 
  private:
   mutable IREE::VM::ImportOp importOp;
+  mutable IREE::VM::ImportOp packedImportOp;
 };
 
 }  // namespace
@@ -139,7 +167,8 @@ void populateHALLoaderToVMPatterns(MLIRContext *context,
   patterns.insert<ExecutableLoadOpConversion>(
       context, importSymbols, typeConverter, "hal_loader.executable.load");
   patterns.insert<ExecutableDispatchOpConversion>(
-      context, importSymbols, typeConverter, "hal_loader.executable.dispatch");
+      context, importSymbols, typeConverter, "hal_loader.executable.dispatch",
+      "hal_loader.executable.dispatch.packed");
 }
 
 }  // namespace iree_compiler
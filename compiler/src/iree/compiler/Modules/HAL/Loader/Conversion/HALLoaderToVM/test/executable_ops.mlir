@@ -52,3 +52,37 @@ func.func @executableDispatch(%executable: !hal.executable, %buffer0: !util.buff
     ])
   return
 }
+
+// -----
+
+// CHECK-LABEL: @executableDispatchPacked
+// CHECK-SAME: (%[[EXECUTABLE:.+]]: !vm.ref<!hal.executable>,
+// CHECK-SAME:  %[[BUFFER0:.+]]: !vm.buffer, %[[BUFFER1:.+]]: !vm.buffer)
+func.func @executableDispatchPacked(%executable: !hal.executable, %buffer0: !util.buffer, %buffer1: !util.buffer) {
+  // CHECK-DAG: %[[COUNT:.+]] = vm.const.i32 1000
+  %count = arith.constant 1000 : index
+  // CHECK-DAG: %[[ORDINAL0:.+]] = vm.const.i32.zero
+  // CHECK-DAG: %[[ORDINAL1:.+]] = vm.const.i32 1
+  // CHECK-DAG: %[[OFFSET0:.+]] = vm.const.i64.zero
+  %offset0 = arith.constant 0 : index
+  // CHECK-DAG: %[[OFFSET1:.+]] = vm.const.i64 128
+  %offset1 = arith.constant 128 : index
+  // CHECK-DAG: %[[LENGTH:.+]] = vm.const.i64 64
+  %length = arith.constant 64 : index
+  // CHECK: vm.call.variadic @hal_loader.executable.dispatch.packed
+  hal_loader.executable.dispatch
+    // CHECK-SAME: %[[EXECUTABLE]], %c16
+    executable(%executable : !hal.executable)[16]
+    // CHECK-SAME: %[[COUNT]], %[[COUNT]], %[[COUNT]]
+    workgroups([%count, %count, %count])
+    // CHECK-SAME: [], [%[[BUFFER0]], %[[BUFFER1]]]
+    bindings([
+      // CHECK-SAME: (%[[ORDINAL0]], %[[OFFSET0]], %[[LENGTH]])
+      (%buffer0 : !util.buffer)[%offset0, %length],
+      // CHECK-SAME: (%[[ORDINAL1]], %[[OFFSET0]], %[[LENGTH]])
+      (%buffer1 : !util.buffer)[%offset0, %length],
+      // CHECK-SAME: (%[[ORDINAL0]], %[[OFFSET1]], %[[LENGTH]])
+      (%buffer0 : !util.buffer)[%offset1, %length]
+    ])
+  return
+}
@@ -37,4 +37,20 @@ vm.import @executable.dispatch(
   %bindings : tuple<!vm.buffer, i64, i64>...
 )
 
+// Dispatches a grid with the given densely-packed and 0-aligned push constants
+// and bindings referencing a deduplicated table of binding buffers.
+// Each unique buffer is passed once regardless of how many bindings use it.
+vm.import @executable.dispatch.packed(
+  %executable : !vm.ref<!hal.executable>,
+  %entry_point : i32,
+  %workgroup_x : i32,
+  %workgroup_y : i32,
+  %workgroup_z : i32,
+  %push_constants : i32 ...,
+  %binding_buffers : !vm.buffer ...,
+  // <binding_buffers ordinal, offset, length>
+  %bindings : tuple<i32, i64, i64>...
+)
+attributes {minimum_version = 1 : i32}
+
 }  // module
@@ -74,6 +74,26 @@ void HighLevelOptimizationOptions::bindOptions(OptionsBinder &binder) {
       llvm::cl::desc(
           "Reduces numeric precision to lower bit depths where possible."),
       llvm::cl::cat(category));
+  binder.opt<bool>(
+      "iree-opt-quantization-calibration-probes",
+      quantizationCalibrationProbes,
+      llvm::cl::desc(
+          "Traces the activation ranges of f32 matmuls at runtime. The trace "
+          "output of running the model over a calibration dataset can be "
+          "passed to --iree-opt-quantization-calibration-file."),
+      llvm::cl::cat(category));
+  binder.opt<std::string>(
+      "iree-opt-quantization-calibration-file", quantizationCalibrationFile,
+      llvm::cl::desc("Quantizes f32 matmuls to i8 using the activation ranges "
+                     "in the given calibration trace output."),
+      llvm::cl::cat(category));
+  binder.opt<bool>(
+      "iree-opt-cache-hoisted-globals", cacheHoistedGlobals,
+      llvm::cl::desc(
+          "Caches the results of global initializers not evaluated at compile "
+          "time using the hoisted_cache runtime module so they are computed "
+          "once per device instead of on every program load."),
+      llvm::cl::cat(category));
   binder.opt<bool>("iree-opt-strip-assertions", stripAssertions,
                    llvm::cl::desc("Strips debug assertions after any useful "
                                   "information has been extracted."),
@@ -123,6 +143,29 @@ void SchedulingOptions::bindOptions(OptionsBinder &binder) {
                           llvm::cl::desc("File path to write statistics to; or "
                                          "`` for stderr or `-` for stdout."),
                           llvm::cl::cat(category));
+
+  binder.opt<int>(
+      "iree-scheduling-pipeline-stages", pipelineStageCount,
+      llvm::cl::desc("Partitions the dispatches of each function into the "
+                     "given number of pipeline stages of roughly equal cost "
+                     "that execute on distinct device queues (such as one "
+                     "per --task_queue_count= queue on local-task)."),
+      llvm::cl::cat(category));
+
+  binder.opt<int64_t>(
+      "iree-scheduling-max-transient-size", maxTransientSize,
+      llvm::cl::desc("Transient memory budget in bytes per execution region. "
+                     "Regions exceeding it are reordered and splats "
+                     "rematerialized at their uses to reduce peak memory, at "
+                     "the cost of concurrency."),
+      llvm::cl::cat(category));
+
+  binder.opt<bool>(
+      "iree-scheduling-specialize-dispatches", specializeDispatches,
+      llvm::cl::desc("Moves constant operands that differ per dispatch site "
+                     "into per-executable constant tables indexed by a single "
+                     "dispatch ordinal to reduce push constant updates."),
+      llvm::cl::cat(category));
 }
 
 }  // namespace iree_compiler
@@ -68,6 +68,18 @@ struct HighLevelOptimizationOptions {
   // Optimizations to reduce numeric precision where it is safe to do so.
   bool numericPrecisionReduction = false;
 
+  // Instruments f32 matmuls to trace the activation ranges needed for
+  // post-training quantization when run over a calibration dataset.
+  bool quantizationCalibrationProbes = false;
+
+  // Trace output from a model compiled with calibration probes. When set f32
+  // matmuls are quantized to i8 using the calibrated ranges.
+  std::string quantizationCalibrationFile;
+
+  // Caches the results of initializers left after const-eval at runtime such
+  // that each is evaluated once per device instead of on every program load.
+  bool cacheHoistedGlobals = false;
+
   // Strips debug assertions after any useful information has been extracted.
   bool stripAssertions = false;
 
@@ -120,6 +132,18 @@ struct SchedulingOptions {
   // File path to write statistics to; or `` for stderr or `-` for stdout.
   std::string dumpStatisticsFile = "";
 
+  // Number of pipeline stages to partition dispatches across. Each stage is
+  // assigned to its own device queue. 1 disables pipelining.
+  int pipelineStageCount = 1;
+
+  // Transient memory budget in bytes for each execution region. Regions that
+  // exceed it are reordered to reduce peak memory. 0 disables the budget.
+  int64_t maxTransientSize = 0;
+
+  // Specializes executables on the dispatch site constant operands that remain
+  // after binding fusion and uniform operand folding.
+  bool specializeDispatches = false;
+
   // TODO(benvanik): favor size/speed/etc for partitioning.
   // TODO(benvanik): execution model to optimize for (unified/discrete memory,
   //                 single/multiple processors, etc).
@@ -8,6 +8,7 @@
 
 #include "iree/compiler/Bindings/Native/Transforms/Passes.h"
 #include "iree/compiler/Bindings/TFLite/Transforms/Passes.h"
+#include "iree/compiler/Codegen/Passes.h"
 #include "iree/compiler/Dialect/Flow/Transforms/Passes.h"
 #include "iree/compiler/Dialect/HAL/Transforms/Passes.h"
 #include "iree/compiler/Dialect/Stream/Transforms/Passes.h"
@@ -89,6 +90,12 @@ void buildIREEVMTransformPassPipeline(
       highLevelOptimizationOptions.constExprHoisting;
   flowOptions.numericPrecisionReduction =
       highLevelOptimizationOptions.numericPrecisionReduction;
+  flowOptions.quantizationCalibrationProbes =
+      highLevelOptimizationOptions.quantizationCalibrationProbes;
+  flowOptions.quantizationCalibrationFile =
+      highLevelOptimizationOptions.quantizationCalibrationFile;
+  flowOptions.cacheHoistedGlobals =
+      highLevelOptimizationOptions.cacheHoistedGlobals;
 
   // Enable const-eval via hook. For debug builds, we assert if enabled without
   // a hook. For release, we just silently skip enabling const-eval.
@@ -102,6 +109,9 @@ void buildIREEVMTransformPassPipeline(
     flowOptions.buildConstEvalPassPipeline =
         hooks.buildConstEvalPassPipelineCallback;
   }
+  flowOptions.buildConstantEncodingPassPipeline = [](OpPassManager &pm) {
+    pm.addPass(createIREEMaterializeConstantEncodingsPass());
+  };
 
   if (highLevelOptimizationOptions.stripAssertions) {
     // Strip std.assert & co after we perform optimizations; prior to this we
@@ -114,14 +124,34 @@ void buildIREEVMTransformPassPipeline(
   streamOptions.dumpStatisticsFormat =
       (IREE::Stream::DumpOutputFormat)schedulingOptions.dumpStatisticsFormat;
   streamOptions.dumpStatisticsFile = schedulingOptions.dumpStatisticsFile;
+  streamOptions.maxTransientSize = schedulingOptions.maxTransientSize;
+  streamOptions.specializeDispatches = schedulingOptions.specializeDispatches;
 
   switch (schedulingOptions.executionModel) {
     case SchedulingOptions::ExecutionModel::HostOnly:
       // No flow/stream processing (implies no tensors).
       break;
     default:
+      // Constant encodings are folded during flow using the layout of the
+      // target devices, so assign them ahead of the HAL pipeline (which keeps
+      // devices already assigned).
+      if (!executableOptions.targets.empty()) {
+        passManager.addPass(IREE::HAL::createAssignTargetDevicesPass(
+            executableOptions.targets));
+      }
       IREE::Flow::buildFlowTransformPassPipeline(passManager, flowOptions);
       if (compileTo == IREEVMPipelinePhase::Flow) return;  // early-exit
+      // Pipeline stages are expressed as queue affinities on dispatches
+      // that the stream dialect partitions and schedules around. Inline
+      // execution models have a single queue and ignore them.
+      if (schedulingOptions.pipelineStageCount > 1 &&
+          (schedulingOptions.executionModel ==
+               SchedulingOptions::ExecutionModel::AsyncInternal ||
+           schedulingOptions.executionModel ==
+               SchedulingOptions::ExecutionModel::AsyncExternal)) {
+        passManager.addPass(IREE::HAL::createAssignPipelineStagesPass(
+            schedulingOptions.pipelineStageCount));
+      }
       IREE::Stream::buildStreamTransformPassPipeline(passManager,
                                                      streamOptions);
       if (compileTo == IREEVMPipelinePhase::Stream) return;  // early-exit
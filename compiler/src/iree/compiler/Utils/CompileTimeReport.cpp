@@ -0,0 +1,168 @@
+// Copyright 2023 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include "iree/compiler/Utils/CompileTimeReport.h"
+
+#include <algorithm>
+
+#include "llvm/Support/CommandLine.h"
+#include "llvm/Support/FormatVariadic.h"
+#include "llvm/Support/ManagedStatic.h"
+#include "llvm/Support/Threading.h"
+#include "mlir/IR/SymbolTable.h"
+
+namespace mlir {
+namespace iree_compiler {
+
+// Returns a name for the top-level op (a direct child of the root op) that
+// contains |op|.
+static std::string getTopLevelSymbolName(Operation *op) {
+  if (!op->getParentOp()) return "(root)";
+  while (op->getParentOp()->getParentOp()) op = op->getParentOp();
+  if (auto symbolName = op->getAttrOfType<StringAttr>(
+          SymbolTable::getSymbolAttrName())) {
+    return ("@" + symbolName.getValue()).str();
+  }
+  return ("(" + op->getName().getStringRef() + ")").str();
+}
+
+static StringRef getPassDisplayName(Pass *pass) {
+  StringRef argument = pass->getArgument();
+  return argument.empty() ? pass->getName() : argument;
+}
+
+CompileTimeReport::CompileTimeReport(unsigned limit, llvm::raw_ostream &os)
+    : limit(limit), outputStream(os) {}
+
+CompileTimeReport::~CompileTimeReport() { print(outputStream); }
+
+void CompileTimeReport::runBeforePipeline(
+    std::optional<OperationName> name, const PipelineParentInfo &parentInfo) {
+  // The parent pass runs a nested pipeline and is only accounted for by the
+  // passes it runs.
+  std::lock_guard<std::mutex> lock(mutex);
+  auto &stack = threadStacks[parentInfo.parentThreadID];
+  for (auto &frame : llvm::reverse(stack)) {
+    if (frame.pass == parentInfo.parentPass) {
+      frame.isContainer = true;
+      break;
+    }
+  }
+}
+
+void CompileTimeReport::runBeforePass(Pass *pass, Operation *op) {
+  std::string symbol = getTopLevelSymbolName(op);
+  auto startTime = Clock::now();
+  std::lock_guard<std::mutex> lock(mutex);
+  if (!firstStartTime) firstStartTime = startTime;
+  threadStacks[llvm::get_threadid()].push_back(
+      Frame{pass, startTime, std::move(symbol)});
+}
+
+void CompileTimeReport::runAfterPass(Pass *pass, Operation *op) {
+  endPass(pass);
+}
+
+void CompileTimeReport::runAfterPassFailed(Pass *pass, Operation *op) {
+  endPass(pass);
+}
+
+void CompileTimeReport::endPass(Pass *pass) {
+  auto endTime = Clock::now();
+  std::lock_guard<std::mutex> lock(mutex);
+  lastEndTime = std::max(lastEndTime, endTime);
+  auto &stack = threadStacks[llvm::get_threadid()];
+  if (stack.empty()) return;
+  Frame frame = std::move(stack.back());
+  stack.pop_back();
+  if (frame.isContainer) return;
+  double seconds =
+      std::chrono::duration<double>(endTime - frame.startTime).count();
+  auto &passEntry = passEntries[getPassDisplayName(pass)];
+  passEntry.seconds += seconds;
+  ++passEntry.count;
+  auto &symbolEntry = symbolEntries[frame.symbol];
+  symbolEntry.seconds += seconds;
+  ++symbolEntry.count;
+}
+
+// Prints the |limit| entries of |entries| with the most time, or all if 0.
+static void printEntries(
+    llvm::raw_ostream &os, StringRef title,
+    const llvm::StringMap<CompileTimeReport::Entry> &entries,
+    double totalSeconds, unsigned limit) {
+  SmallVector<const llvm::StringMapEntry<CompileTimeReport::Entry> *> sorted;
+  for (auto &entry : entries) sorted.push_back(&entry);
+  llvm::sort(sorted, [](auto *lhs, auto *rhs) {
+    if (lhs->getValue().seconds != rhs->getValue().seconds) {
+      return lhs->getValue().seconds > rhs->getValue().seconds;
+    }
+    return lhs->getKey() < rhs->getKey();
+  });
+  if (limit && sorted.size() > limit) sorted.resize(limit);
+
+  os << "\n  ---Time (s)---  ---%---  --Count--  " << title << "\n";
+  for (auto *entry : sorted) {
+    double seconds = entry->getValue().seconds;
+    double percent = totalSeconds > 0.0 ? seconds / totalSeconds * 100.0 : 0.0;
+    os << llvm::formatv("  {0,14:f4}  {1,6:f2}%  {2,9}  {3}\n", seconds,
+                        percent, entry->getValue().count, entry->getKey());
+  }
+  if (entries.size() > sorted.size()) {
+    os << "  (" << (entries.size() - sorted.size()) << " more not shown)\n";
+  }
+}
+
+void CompileTimeReport::print(llvm::raw_ostream &os) {
+  std::lock_guard<std::mutex> lock(mutex);
+  if (!firstStartTime) return;
+  double wallSeconds =
+      std::chrono::duration<double>(lastEndTime - *firstStartTime).count();
+  double totalSeconds = 0.0;
+  for (auto &entry : passEntries) totalSeconds += entry.getValue().seconds;
+
+  os << "===" << std::string(73, '-') << "===\n";
+  os << "                          IREE compile-time report\n";
+  os << "===" << std::string(73, '-') << "===\n";
+  os << llvm::formatv("  Wall time:        {0:f4} s\n", wallSeconds);
+  os << llvm::formatv("  Total pass time:  {0:f4} s (summed across threads)\n",
+                      totalSeconds);
+  printEntries(os, "Pass", passEntries, totalSeconds, limit);
+  printEntries(os, "Top-level symbol", symbolEntries, totalSeconds, limit);
+  os.flush();
+}
+
+namespace {
+struct CompileTimeReportOptions {
+  llvm::cl::opt<bool> enabled{
+      "compile-time-report",
+      llvm::cl::desc("Prints the time spent in each pass and in each "
+                     "top-level symbol (such as each hal.executable) after "
+                     "compilation"),
+      llvm::cl::init(false)};
+  llvm::cl::opt<unsigned> limit{
+      "compile-time-report-limit",
+      llvm::cl::desc("Number of passes and symbols listed in the "
+                     "-compile-time-report, or 0 to list all"),
+      llvm::cl::init(20)};
+};
+}  // namespace
+
+static llvm::ManagedStatic<CompileTimeReportOptions> clOptions;
+
+void registerCompileTimeReportCLOptions() {
+  // Make sure the options are registered with the command line parser.
+  *clOptions;
+}
+
+void applyCompileTimeReportCLOptions(PassManager &passManager) {
+  if (!clOptions.isConstructed() || !clOptions->enabled) return;
+  passManager.addInstrumentation(
+      std::make_unique<CompileTimeReport>(clOptions->limit));
+}
+
+}  // namespace iree_compiler
+}  // namespace mlir
@@ -0,0 +1,98 @@
+// Copyright 2023 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#ifndef IREE_COMPILER_UTILS_COMPILETIMEREPORT_H_
+#define IREE_COMPILER_UTILS_COMPILETIMEREPORT_H_
+
+#include <chrono>
+#include <mutex>
+#include <optional>
+#include <string>
+
+#include "llvm/ADT/DenseMap.h"
+#include "llvm/ADT/SmallVector.h"
+#include "llvm/ADT/StringMap.h"
+#include "llvm/Support/raw_ostream.h"
+#include "mlir/Pass/Pass.h"
+#include "mlir/Pass/PassInstrumentation.h"
+#include "mlir/Pass/PassManager.h"
+
+namespace mlir {
+namespace iree_compiler {
+
+// Records the time spent in each pass and in each top-level symbol (such as a
+// hal.executable or func.func) and prints a summary when destroyed.
+//
+// Unlike -mlir-timing, which reports the nesting structure of the pipeline
+// aggregated over all ops it runs on, this attributes time to the op being
+// processed so that the most expensive dispatches stand out. Passes that only
+// run nested pipelines (pass adaptors and passes like
+// iree-hal-translate-executables that call runPipeline) are not counted
+// themselves as their time is attributed to the passes they run. Times are
+// summed across threads and may add up to more than the wall time of the
+// compilation when the pipeline runs multithreaded.
+//
+// Usage:
+//   passManager.addInstrumentation(std::make_unique<CompileTimeReport>());
+class CompileTimeReport : public PassInstrumentation {
+ public:
+  // Reports the |limit| most expensive passes and symbols or all if 0.
+  explicit CompileTimeReport(unsigned limit = 20,
+                             llvm::raw_ostream &os = llvm::errs());
+  ~CompileTimeReport() override;
+
+  void runBeforePipeline(std::optional<OperationName> name,
+                         const PipelineParentInfo &parentInfo) override;
+  void runBeforePass(Pass *pass, Operation *op) override;
+  void runAfterPass(Pass *pass, Operation *op) override;
+  void runAfterPassFailed(Pass *pass, Operation *op) override;
+
+  // Prints the report of everything recorded so far to |os|.
+  void print(llvm::raw_ostream &os);
+
+  // Accumulated time of a pass or symbol.
+  struct Entry {
+    double seconds = 0.0;
+    unsigned count = 0;
+  };
+
+ private:
+  using Clock = std::chrono::steady_clock;
+
+  struct Frame {
+    Pass *pass;
+    Clock::time_point startTime;
+    // Top-level symbol containing the op the pass runs on.
+    std::string symbol;
+    // True if the pass ran nested pipelines.
+    bool isContainer = false;
+  };
+
+  void endPass(Pass *pass);
+
+  unsigned limit;
+  llvm::raw_ostream &outputStream;
+
+  std::mutex mutex;
+  // Stack of in-flight passes per thread (keyed by llvm::get_threadid()).
+  llvm::DenseMap<uint64_t, llvm::SmallVector<Frame>> threadStacks;
+  llvm::StringMap<Entry> passEntries;
+  llvm::StringMap<Entry> symbolEntries;
+  std::optional<Clock::time_point> firstStartTime;
+  Clock::time_point lastEndTime;
+};
+
+// Registers the -compile-time-report command line options.
+void registerCompileTimeReportCLOptions();
+
+// Adds a CompileTimeReport instrumentation to |passManager| if requested with
+// the command line options.
+void applyCompileTimeReportCLOptions(PassManager &passManager);
+
+}  // namespace iree_compiler
+}  // namespace mlir
+
+#endif  // IREE_COMPILER_UTILS_COMPILETIMEREPORT_H_
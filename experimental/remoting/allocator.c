@@ -0,0 +1,266 @@
+// Copyright 2023 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include "experimental/remoting/allocator.h"
+
+#include <stddef.h>
+#include <string.h>
+
+#include "experimental/remoting/buffer.h"
+#include "experimental/remoting/transport.h"
+#include "iree/base/api.h"
+#include "iree/base/tracing.h"
+
+typedef struct iree_hal_remoting_allocator_t {
+  iree_hal_resource_t resource;
+  iree_allocator_t host_allocator;
+  iree_hal_device_t* base_device;
+  iree_hal_remoting_connection_t* connection;
+
+  IREE_STATISTICS(iree_hal_allocator_statistics_t statistics;)
+} iree_hal_remoting_allocator_t;
+
+static const iree_hal_allocator_vtable_t iree_hal_remoting_allocator_vtable;
+
+static iree_hal_remoting_allocator_t* iree_hal_remoting_allocator_cast(
+    iree_hal_allocator_t* base_value) {
+  IREE_HAL_ASSERT_TYPE(base_value, &iree_hal_remoting_allocator_vtable);
+  return (iree_hal_remoting_allocator_t*)base_value;
+}
+
+iree_status_t iree_hal_remoting_allocator_create(
+    iree_hal_device_t* base_device, iree_hal_remoting_connection_t* connection,
+    iree_allocator_t host_allocator, iree_hal_allocator_t** out_allocator) {
+  IREE_ASSERT_ARGUMENT(base_device);
+  IREE_ASSERT_ARGUMENT(connection);
+  IREE_ASSERT_ARGUMENT(out_allocator);
+  *out_allocator = NULL;
+  IREE_TRACE_ZONE_BEGIN(z0);
+
+  iree_hal_remoting_allocator_t* allocator = NULL;
+  iree_status_t status = iree_allocator_malloc(
+      host_allocator, sizeof(*allocator), (void**)&allocator);
+  if (iree_status_is_ok(status)) {
+    iree_hal_resource_initialize(&iree_hal_remoting_allocator_vtable,
+                                 &allocator->resource);
+    allocator->host_allocator = host_allocator;
+    allocator->base_device = base_device;
+    allocator->connection = connection;
+    *out_allocator = (iree_hal_allocator_t*)allocator;
+  }
+
+  IREE_TRACE_ZONE_END(z0);
+  return status;
+}
+
+static void iree_hal_remoting_allocator_destroy(
+    iree_hal_allocator_t* IREE_RESTRICT base_allocator) {
+  iree_hal_remoting_allocator_t* allocator =
+      iree_hal_remoting_allocator_cast(base_allocator);
+  iree_allocator_t host_allocator = allocator->host_allocator;
+  IREE_TRACE_ZONE_BEGIN(z0);
+
+  iree_allocator_free(host_allocator, allocator);
+
+  IREE_TRACE_ZONE_END(z0);
+}
+
+static iree_allocator_t iree_hal_remoting_allocator_host_allocator(
+    const iree_hal_allocator_t* IREE_RESTRICT base_allocator) {
+  iree_hal_remoting_allocator_t* allocator =
+      (iree_hal_remoting_allocator_t*)base_allocator;
+  return allocator->host_allocator;
+}
+
+static iree_status_t iree_hal_remoting_allocator_trim(
+    iree_hal_allocator_t* IREE_RESTRICT base_allocator) {
+  // The server allocator is trimmed along with the device.
+  return iree_ok_status();
+}
+
+static void iree_hal_remoting_allocator_query_statistics(
+    iree_hal_allocator_t* IREE_RESTRICT base_allocator,
+    iree_hal_allocator_statistics_t* IREE_RESTRICT out_statistics) {
+  IREE_STATISTICS({
+    iree_hal_remoting_allocator_t* allocator =
+        iree_hal_remoting_allocator_cast(base_allocator);
+    memcpy(out_statistics, &allocator->statistics, sizeof(*out_statistics));
+  });
+}
+
+static iree_hal_buffer_compatibility_t
+iree_hal_remoting_allocator_query_compatibility(
+    iree_hal_allocator_t* IREE_RESTRICT base_allocator,
+    const iree_hal_buffer_params_t* IREE_RESTRICT params,
+    iree_device_size_t allocation_size) {
+  // Answered locally to avoid a round trip per query: the server allocator
+  // rejects unsupported allocations when they are made.
+  iree_hal_buffer_compatibility_t compatibility =
+      IREE_HAL_BUFFER_COMPATIBILITY_ALLOCATABLE;
+  if (iree_any_bit_set(params->usage, IREE_HAL_BUFFER_USAGE_TRANSFER)) {
+    compatibility |= IREE_HAL_BUFFER_COMPATIBILITY_QUEUE_TRANSFER;
+  }
+  if (iree_any_bit_set(params->usage,
+                       IREE_HAL_BUFFER_USAGE_DISPATCH_STORAGE |
+                           IREE_HAL_BUFFER_USAGE_DISPATCH_UNIFORM_READ)) {
+    compatibility |= IREE_HAL_BUFFER_COMPATIBILITY_QUEUE_DISPATCH;
+  }
+  return compatibility;
+}
+
+// Asks the server to allocate the buffer named by |handle|, backed by the
+// shared memory |fd| if not -1.
+static iree_status_t iree_hal_remoting_allocator_allocate_remote(
+    iree_hal_remoting_allocator_t* allocator, iree_hal_remoting_handle_t handle,
+    const iree_hal_buffer_params_t* params, iree_device_size_t allocation_size,
+    int fd, iree_hal_remoting_buffer_allocate_result_t* out_result) {
+  iree_hal_remoting_buffer_allocate_t request = {
+      .buffer = handle,
+      .allocation_size = allocation_size,
+  };
+  iree_hal_remoting_buffer_params_pack(params, &request.params);
+  const iree_const_byte_span_t spans[1] = {
+      iree_make_const_byte_span(&request, sizeof(request)),
+  };
+  return iree_hal_remoting_connection_call(
+      allocator->connection, IREE_HAL_REMOTING_MESSAGE_BUFFER_ALLOCATE,
+      IREE_ARRAYSIZE(spans), spans, fd,
+      iree_make_byte_span(out_result, sizeof(*out_result)),
+      /*out_result_length=*/NULL);
+}
+
+static iree_status_t iree_hal_remoting_allocator_allocate_buffer(
+    iree_hal_allocator_t* IREE_RESTRICT base_allocator,
+    const iree_hal_buffer_params_t* IREE_RESTRICT params,
+    iree_device_size_t allocation_size, iree_const_byte_span_t initial_data,
+    iree_hal_buffer_t** IREE_RESTRICT out_buffer) {
+  iree_hal_remoting_allocator_t* allocator =
+      iree_hal_remoting_allocator_cast(base_allocator);
+  IREE_TRACE_ZONE_BEGIN(z0);
+  IREE_TRACE_ZONE_APPEND_VALUE(z0, (int64_t)allocation_size);
+
+  iree_hal_remoting_handle_t handle = IREE_HAL_REMOTING_HANDLE_NULL;
+  IREE_RETURN_AND_END_ZONE_IF_ERROR(
+      z0, iree_hal_remoting_connection_allocate_handle(allocator->connection,
+                                                       &handle));
+
+  // Host-visible buffers on local connections are placed in shared memory.
+  // The server may not be able to import host memory into its device in
+  // which case we fall back to a buffer only the server can access.
+  iree_hal_remoting_buffer_allocate_result_t result;
+  memset(&result, 0, sizeof(result));
+  void* shared_ptr = NULL;
+  iree_status_t status = iree_ok_status();
+  if (allocation_size > 0 &&
+      iree_all_bits_set(params->type, IREE_HAL_MEMORY_TYPE_HOST_VISIBLE) &&
+      iree_hal_remoting_connection_is_local(allocator->connection)) {
+    int fd = -1;
+    status = iree_hal_remoting_shared_memory_create(
+        (iree_host_size_t)allocation_size, &fd, &shared_ptr);
+    if (iree_status_is_ok(status)) {
+      status = iree_hal_remoting_allocator_allocate_remote(
+          allocator, handle, params, allocation_size, fd, &result);
+      iree_hal_remoting_close_fd(fd);
+    }
+    if (!iree_status_is_ok(status)) {
+      if (shared_ptr) {
+        iree_hal_remoting_shared_memory_unmap(
+            shared_ptr, (iree_host_size_t)allocation_size);
+        shared_ptr = NULL;
+      }
+      status = iree_status_ignore(status);
+    }
+  }
+  if (!shared_ptr) {
+    status = iree_hal_remoting_allocator_allocate_remote(
+        allocator, handle, params, allocation_size, /*fd=*/-1, &result);
+  }
+
+  iree_hal_buffer_t* buffer = NULL;
+  if (iree_status_is_ok(status)) {
+    status = iree_hal_remoting_buffer_wrap(
+        allocator->connection, base_allocator, allocator->host_allocator,
+        result.memory_type, result.allowed_access, result.allowed_usage,
+        allocation_size, handle, shared_ptr, &buffer);
+    if (!iree_status_is_ok(status)) {
+      // The server buffer exists but nothing owns the handle yet.
+      iree_hal_remoting_connection_release_handle(allocator->connection,
+                                                  handle);
+      if (shared_ptr) {
+        iree_hal_remoting_shared_memory_unmap(
+            shared_ptr, (iree_host_size_t)allocation_size);
+      }
+    }
+  }
+
+  // Copy the initial contents into the buffer. The write is ordered before any
+  // use of the buffer and does not need to be waited on.
+  if (iree_status_is_ok(status) &&
+      !iree_const_byte_span_is_empty(initial_data)) {
+    if (shared_ptr) {
+      memcpy(shared_ptr, initial_data.data, initial_data.data_length);
+    } else {
+      status = iree_hal_remoting_buffer_write(
+          allocator->connection, handle, /*offset=*/0, initial_data.data,
+          initial_data.data_length);
+    }
+  }
+
+  if (iree_status_is_ok(status)) {
+    IREE_STATISTICS(iree_hal_allocator_statistics_record_alloc(
+        &allocator->statistics, iree_hal_buffer_memory_type(buffer),
+        allocation_size));
+    *out_buffer = buffer;
+  } else {
+    iree_hal_buffer_release(buffer);
+  }
+  IREE_TRACE_ZONE_END(z0);
+  return status;
+}
+
+static void iree_hal_remoting_allocator_deallocate_buffer(
+    iree_hal_allocator_t* IREE_RESTRICT base_allocator,
+    iree_hal_buffer_t* IREE_RESTRICT base_buffer) {
+  iree_hal_remoting_allocator_t* allocator =
+      iree_hal_remoting_allocator_cast(base_allocator);
+  (void)allocator;
+  IREE_STATISTICS(iree_hal_allocator_statistics_record_free(
+      &allocator->statistics, iree_hal_buffer_memory_type(base_buffer),
+      iree_hal_buffer_allocation_size(base_buffer)));
+  iree_hal_buffer_destroy(base_buffer);
+}
+
+static iree_status_t iree_hal_remoting_allocator_import_buffer(
+    iree_hal_allocator_t* IREE_RESTRICT base_allocator,
+    const iree_hal_buffer_params_t* IREE_RESTRICT params,
+    iree_hal_external_buffer_t* IREE_RESTRICT external_buffer,
+    iree_hal_buffer_release_callback_t release_callback,
+    iree_hal_buffer_t** IREE_RESTRICT out_buffer) {
+  return iree_make_status(IREE_STATUS_UNAVAILABLE,
+                          "importing from external buffers not supported");
+}
+
+static iree_status_t iree_hal_remoting_allocator_export_buffer(
+    iree_hal_allocator_t* IREE_RESTRICT base_allocator,
+    iree_hal_buffer_t* IREE_RESTRICT buffer,
+    iree_hal_external_buffer_type_t requested_type,
+    iree_hal_external_buffer_flags_t requested_flags,
+    iree_hal_external_buffer_t* IREE_RESTRICT out_external_buffer) {
+  return iree_make_status(IREE_STATUS_UNAVAILABLE,
+                          "exporting to external buffers not supported");
+}
+
+static const iree_hal_allocator_vtable_t iree_hal_remoting_allocator_vtable = {
+    .destroy = iree_hal_remoting_allocator_destroy,
+    .host_allocator = iree_hal_remoting_allocator_host_allocator,
+    .trim = iree_hal_remoting_allocator_trim,
+    .query_statistics = iree_hal_remoting_allocator_query_statistics,
+    .query_compatibility = iree_hal_remoting_allocator_query_compatibility,
+    .allocate_buffer = iree_hal_remoting_allocator_allocate_buffer,
+    .deallocate_buffer = iree_hal_remoting_allocator_deallocate_buffer,
+    .import_buffer = iree_hal_remoting_allocator_import_buffer,
+    .export_buffer = iree_hal_remoting_allocator_export_buffer,
+};
@@ -0,0 +1,32 @@
+// Copyright 2023 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#ifndef IREE_HAL_REMOTING_ALLOCATOR_H_
+#define IREE_HAL_REMOTING_ALLOCATOR_H_
+
+#include "experimental/remoting/connection.h"
+#include "iree/base/api.h"
+#include "iree/hal/api.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif  // __cplusplus
+
+// Creates an allocator that allocates buffers from the server device
+// allocator. On local connections host-visible buffers are placed in shared
+// memory that both processes map so that no transfers are required to access
+// them (see iree_hal_remoting_buffer_wrap).
+//
+// |connection| is unretained as the device outlives the allocator.
+iree_status_t iree_hal_remoting_allocator_create(
+    iree_hal_device_t* base_device, iree_hal_remoting_connection_t* connection,
+    iree_allocator_t host_allocator, iree_hal_allocator_t** out_allocator);
+
+#ifdef __cplusplus
+}  // extern "C"
+#endif  // __cplusplus
+
+#endif  // IREE_HAL_REMOTING_ALLOCATOR_H_
@@ -0,0 +1,116 @@
+// Copyright 2023 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+// See iree/base/api.h for documentation on the API conventions used.
+
+#ifndef IREE_HAL_REMOTING_API_H_
+#define IREE_HAL_REMOTING_API_H_
+
+#include "iree/base/api.h"
+#include "iree/hal/api.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif  // __cplusplus
+
+//===----------------------------------------------------------------------===//
+// iree_hal_remoting_transport_t
+//===----------------------------------------------------------------------===//
+
+// A bidirectional stream connecting a remoting client and server.
+//
+// Endpoints are specified as strings:
+//   `tcp:HOST:PORT`: TCP socket; used across hosts.
+//   `unix:PATH`: Unix domain socket; used on the same host. Host-visible
+//                buffers are placed in shared memory passed to the server so
+//                that mapping them on the client requires no transfers.
+typedef struct iree_hal_remoting_transport_t iree_hal_remoting_transport_t;
+
+// Connects to a server listening on |endpoint|.
+IREE_API_EXPORT iree_status_t iree_hal_remoting_transport_connect(
+    iree_string_view_t endpoint, iree_allocator_t host_allocator,
+    iree_hal_remoting_transport_t** out_transport);
+
+// Creates a pair of connected local transports. Useful for running the client
+// and server in the same process.
+IREE_API_EXPORT iree_status_t iree_hal_remoting_transport_create_pair(
+    iree_allocator_t host_allocator,
+    iree_hal_remoting_transport_t** out_client_transport,
+    iree_hal_remoting_transport_t** out_server_transport);
+
+// Closes the connection and frees the transport.
+IREE_API_EXPORT void iree_hal_remoting_transport_destroy(
+    iree_hal_remoting_transport_t* transport);
+
+// A socket accepting remoting connections.
+typedef struct iree_hal_remoting_listener_t iree_hal_remoting_listener_t;
+
+// Starts listening for connections on |endpoint|.
+IREE_API_EXPORT iree_status_t iree_hal_remoting_listener_create(
+    iree_string_view_t endpoint, iree_allocator_t host_allocator,
+    iree_hal_remoting_listener_t** out_listener);
+
+// Blocks until a client connects and returns the transport connected to it.
+IREE_API_EXPORT iree_status_t iree_hal_remoting_listener_accept(
+    iree_hal_remoting_listener_t* listener,
+    iree_hal_remoting_transport_t** out_transport);
+
+// Stops listening and frees the listener.
+IREE_API_EXPORT void iree_hal_remoting_listener_destroy(
+    iree_hal_remoting_listener_t* listener);
+
+//===----------------------------------------------------------------------===//
+// Server
+//===----------------------------------------------------------------------===//
+
+// Serves the remoting client connected to |transport| using |device| until the
+// client disconnects. All resources the client created are released before
+// returning. The transport remains owned by the caller. Multiple clients may be
+// served concurrently on separate threads with the same device.
+IREE_API_EXPORT iree_status_t iree_hal_remoting_serve(
+    iree_hal_device_t* device, iree_hal_remoting_transport_t* transport,
+    iree_allocator_t host_allocator);
+
+//===----------------------------------------------------------------------===//
+// iree_hal_remoting_device_t
+//===----------------------------------------------------------------------===//
+
+// Creates a device that forwards all operations over |transport| to the
+// remoting server connected to it. Ownership of the transport is transferred
+// to the device even if creation fails.
+//
+// |out_device| must be released by the caller (see |iree_hal_device_release|).
+IREE_API_EXPORT iree_status_t iree_hal_remoting_device_create(
+    iree_string_view_t identifier, iree_hal_remoting_transport_t* transport,
+    iree_allocator_t host_allocator, iree_hal_device_t** out_device);
+
+//===----------------------------------------------------------------------===//
+// iree_hal_remoting_driver_t
+//===----------------------------------------------------------------------===//
+
+// Remoting driver creation options.
+typedef struct iree_hal_remoting_driver_options_t {
+  // Endpoint used when creating the default device.
+  iree_string_view_t default_endpoint;
+} iree_hal_remoting_driver_options_t;
+
+IREE_API_EXPORT void iree_hal_remoting_driver_options_initialize(
+    iree_hal_remoting_driver_options_t* out_options);
+
+// Creates a remoting HAL driver. Devices are created by path with the endpoint
+// of the server as the path (`remoting://tcp:host:port`).
+//
+// |out_driver| must be released by the caller (see |iree_hal_driver_release|).
+IREE_API_EXPORT iree_status_t iree_hal_remoting_driver_create(
+    iree_string_view_t identifier,
+    const iree_hal_remoting_driver_options_t* options,
+    iree_allocator_t host_allocator, iree_hal_driver_t** out_driver);
+
+#ifdef __cplusplus
+}  // extern "C"
+#endif  // __cplusplus
+
+#endif  // IREE_HAL_REMOTING_API_H_
@@ -0,0 +1,305 @@
+// Copyright 2023 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include "experimental/remoting/buffer.h"
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "experimental/remoting/transport.h"
+#include "iree/base/api.h"
+#include "iree/base/internal/synchronization.h"
+#include "iree/base/tracing.h"
+
+typedef struct iree_hal_remoting_buffer_t {
+  iree_hal_buffer_t base;
+  iree_hal_remoting_connection_t* connection;
+  iree_hal_remoting_handle_t handle;
+  // Mapping of the shared memory backing the server buffer, if any.
+  void* shared_ptr;
+  // Guards lazy allocation of |shadow_ptr|.
+  iree_slim_mutex_t shadow_mutex;
+  // Host copy of the entire allocation used to stage mappings when the buffer
+  // is not in shared memory.
+  void* shadow_ptr IREE_GUARDED_BY(shadow_mutex);
+} iree_hal_remoting_buffer_t;
+
+static const iree_hal_buffer_vtable_t iree_hal_remoting_buffer_vtable;
+
+static iree_hal_remoting_buffer_t* iree_hal_remoting_buffer_cast(
+    iree_hal_buffer_t* base_value) {
+  IREE_HAL_ASSERT_TYPE(base_value, &iree_hal_remoting_buffer_vtable);
+  return (iree_hal_remoting_buffer_t*)base_value;
+}
+
+iree_status_t iree_hal_remoting_buffer_wrap(
+    iree_hal_remoting_connection_t* connection, iree_hal_allocator_t* allocator,
+    iree_allocator_t host_allocator, iree_hal_memory_type_t memory_type,
+    iree_hal_memory_access_t allowed_access,
+    iree_hal_buffer_usage_t allowed_usage, iree_device_size_t allocation_size,
+    iree_hal_remoting_handle_t handle, void* shared_ptr,
+    iree_hal_buffer_t** out_buffer) {
+  IREE_ASSERT_ARGUMENT(connection);
+  IREE_ASSERT_ARGUMENT(out_buffer);
+  *out_buffer = NULL;
+  IREE_TRACE_ZONE_BEGIN(z0);
+
+  if (!shared_ptr) memory_type &= ~IREE_HAL_MEMORY_TYPE_HOST_COHERENT;
+
+  iree_hal_remoting_buffer_t* buffer = NULL;
+  iree_status_t status =
+      iree_allocator_malloc(host_allocator, sizeof(*buffer), (void**)&buffer);
+  if (iree_status_is_ok(status)) {
+    iree_hal_buffer_initialize(host_allocator, allocator, &buffer->base,
+                               allocation_size, /*byte_offset=*/0,
+                               /*byte_length=*/allocation_size, memory_type,
+                               allowed_access, allowed_usage,
+                               &iree_hal_remoting_buffer_vtable, &buffer->base);
+    buffer->connection = connection;
+    buffer->handle = handle;
+    buffer->shared_ptr = shared_ptr;
+    iree_slim_mutex_initialize(&buffer->shadow_mutex);
+    buffer->shadow_ptr = NULL;
+    *out_buffer = &buffer->base;
+  }
+
+  IREE_TRACE_ZONE_END(z0);
+  return status;
+}
+
+static void iree_hal_remoting_buffer_destroy(iree_hal_buffer_t* base_buffer) {
+  iree_hal_remoting_buffer_t* buffer =
+      iree_hal_remoting_buffer_cast(base_buffer);
+  iree_allocator_t host_allocator = base_buffer->host_allocator;
+  IREE_TRACE_ZONE_BEGIN(z0);
+
+  // The server keeps its own mapping of shared memory alive until the server
+  // buffer is destroyed so work in flight is unaffected by the unmap.
+  iree_hal_remoting_connection_release_handle(buffer->connection,
+                                              buffer->handle);
+  if (buffer->shared_ptr) {
+    iree_hal_remoting_shared_memory_unmap(buffer->shared_ptr,
+                                          base_buffer->allocation_size);
+  }
+  iree_allocator_free(host_allocator, buffer->shadow_ptr);
+  iree_slim_mutex_deinitialize(&buffer->shadow_mutex);
+  iree_allocator_free(host_allocator, buffer);
+
+  IREE_TRACE_ZONE_END(z0);
+}
+
+void iree_hal_remoting_buffer_params_pack(
+    const iree_hal_buffer_params_t* params,
+    iree_hal_remoting_buffer_params_t* out_params) {
+  memset(out_params, 0, sizeof(*out_params));
+  out_params->usage = params->usage;
+  out_params->access = params->access;
+  out_params->type = params->type;
+  out_params->queue_affinity = params->queue_affinity;
+  out_params->min_alignment = params->min_alignment;
+}
+
+bool iree_hal_remoting_buffer_isa(iree_hal_buffer_t* buffer) {
+  return iree_hal_resource_is(buffer, &iree_hal_remoting_buffer_vtable);
+}
+
+iree_status_t iree_hal_remoting_buffer_resolve(
+    iree_hal_buffer_t* buffer, iree_device_size_t offset,
+    iree_hal_remoting_handle_t* out_handle, iree_device_size_t* out_offset) {
+  *out_handle = IREE_HAL_REMOTING_HANDLE_NULL;
+  *out_offset = 0;
+  if (!buffer) return iree_ok_status();
+  iree_hal_buffer_t* allocated_buffer =
+      iree_hal_buffer_allocated_buffer(buffer);
+  if (!iree_hal_remoting_buffer_isa(allocated_buffer)) {
+    return iree_make_status(IREE_STATUS_INVALID_ARGUMENT,
+                            "buffer was not allocated by a remoting device");
+  }
+  *out_handle = iree_hal_remoting_buffer_cast(allocated_buffer)->handle;
+  *out_offset = iree_hal_buffer_byte_offset(buffer) + offset;
+  return iree_ok_status();
+}
+
+void* iree_hal_remoting_buffer_shared_pointer(iree_hal_buffer_t* buffer) {
+  iree_hal_buffer_t* allocated_buffer =
+      iree_hal_buffer_allocated_buffer(buffer);
+  if (!iree_hal_remoting_buffer_isa(allocated_buffer)) return NULL;
+  return iree_hal_remoting_buffer_cast(allocated_buffer)->shared_ptr;
+}
+
+iree_status_t iree_hal_remoting_buffer_read(
+    iree_hal_remoting_connection_t* connection,
+    iree_hal_remoting_handle_t handle, iree_device_size_t offset, void* target,
+    iree_device_size_t length) {
+  IREE_TRACE_ZONE_BEGIN(z0);
+  IREE_TRACE_ZONE_APPEND_VALUE(z0, (int64_t)length);
+  iree_status_t status = iree_ok_status();
+  uint8_t* target_ptr = (uint8_t*)target;
+  while (iree_status_is_ok(status) && length > 0) {
+    const iree_hal_remoting_buffer_range_t range = {
+        .buffer = handle,
+        .offset = offset,
+        .length = iree_min(length, IREE_HAL_REMOTING_MAX_TRANSFER_LENGTH),
+    };
+    const iree_const_byte_span_t spans[1] = {
+        iree_make_const_byte_span(&range, sizeof(range)),
+    };
+    iree_host_size_t result_length = 0;
+    status = iree_hal_remoting_connection_call(
+        connection, IREE_HAL_REMOTING_MESSAGE_BUFFER_READ,
+        IREE_ARRAYSIZE(spans), spans, /*fd=*/-1,
+        iree_make_byte_span(target_ptr, (iree_host_size_t)range.length),
+        &result_length);
+    if (iree_status_is_ok(status) && result_length != range.length) {
+      status = iree_make_status(IREE_STATUS_DATA_LOSS,
+                                "short buffer read from the remoting server");
+    }
+    offset += range.length;
+    target_ptr += range.length;
+    length -= range.length;
+  }
+  IREE_TRACE_ZONE_END(z0);
+  return status;
+}
+
+iree_status_t iree_hal_remoting_buffer_write(
+    iree_hal_remoting_connection_t* connection,
+    iree_hal_remoting_handle_t handle, iree_device_size_t offset,
+    const void* source, iree_device_size_t length) {
+  IREE_TRACE_ZONE_BEGIN(z0);
+  IREE_TRACE_ZONE_APPEND_VALUE(z0, (int64_t)length);
+  iree_status_t status = iree_ok_status();
+  const uint8_t* source_ptr = (const uint8_t*)source;
+  while (iree_status_is_ok(status) && length > 0) {
+    const iree_hal_remoting_buffer_range_t range = {
+        .buffer = handle,
+        .offset = offset,
+        .length = iree_min(length, IREE_HAL_REMOTING_MAX_TRANSFER_LENGTH),
+    };
+    const iree_host_size_t padding =
+        iree_hal_remoting_padding((iree_host_size_t)range.length);
+    const iree_const_byte_span_t spans[3] = {
+        iree_make_const_byte_span(&range, sizeof(range)),
+        iree_make_const_byte_span(source_ptr, (iree_host_size_t)range.length),
+        iree_hal_remoting_padding_span(padding),
+    };
+    status = iree_hal_remoting_connection_post(
+        connection, IREE_HAL_REMOTING_MESSAGE_BUFFER_WRITE,
+        IREE_ARRAYSIZE(spans), spans, /*fd=*/-1);
+    offset += range.length;
+    source_ptr += range.length;
+    length -= range.length;
+  }
+  IREE_TRACE_ZONE_END(z0);
+  return status;
+}
+
+// Returns the host shadow of |buffer|, allocating it if needed.
+static iree_status_t iree_hal_remoting_buffer_shadow(
+    iree_hal_remoting_buffer_t* buffer, uint8_t** out_shadow_ptr) {
+  iree_status_t status = iree_ok_status();
+  iree_slim_mutex_lock(&buffer->shadow_mutex);
+  if (!buffer->shadow_ptr) {
+    status = iree_allocator_malloc_uninitialized(
+        buffer->base.host_allocator,
+        (iree_host_size_t)buffer->base.allocation_size, &buffer->shadow_ptr);
+  }
+  *out_shadow_ptr = (uint8_t*)buffer->shadow_ptr;
+  iree_slim_mutex_unlock(&buffer->shadow_mutex);
+  return status;
+}
+
+static iree_status_t iree_hal_remoting_buffer_map_range(
+    iree_hal_buffer_t* base_buffer, iree_hal_mapping_mode_t mapping_mode,
+    iree_hal_memory_access_t memory_access,
+    iree_device_size_t local_byte_offset, iree_device_size_t local_byte_length,
+    iree_hal_buffer_mapping_t* mapping) {
+  iree_hal_remoting_buffer_t* buffer =
+      iree_hal_remoting_buffer_cast(base_buffer);
+
+  IREE_RETURN_IF_ERROR(
+      iree_hal_buffer_validate_usage(iree_hal_buffer_allowed_usage(base_buffer),
+                                     IREE_HAL_BUFFER_USAGE_MAPPING));
+
+  // Shared memory is coherent with the server.
+  if (buffer->shared_ptr) {
+    mapping->contents = iree_make_byte_span(
+        (uint8_t*)buffer->shared_ptr + local_byte_offset, local_byte_length);
+    return iree_ok_status();
+  }
+
+  uint8_t* shadow_ptr = NULL;
+  IREE_RETURN_IF_ERROR(iree_hal_remoting_buffer_shadow(buffer, &shadow_ptr));
+  uint8_t* data_ptr = shadow_ptr + local_byte_offset;
+  if (iree_any_bit_set(memory_access, IREE_HAL_MEMORY_ACCESS_DISCARD)) {
+    // If we mapped for discard scribble over the bytes. This is not a mandated
+    // behavior but it will make debugging issues easier.
+#ifndef NDEBUG
+    memset(data_ptr, 0xCD, local_byte_length);
+#endif  // !NDEBUG
+  } else if (iree_any_bit_set(memory_access, IREE_HAL_MEMORY_ACCESS_READ)) {
+    IREE_RETURN_IF_ERROR(iree_hal_remoting_buffer_read(
+        buffer->connection, buffer->handle, local_byte_offset, data_ptr,
+        local_byte_length));
+  }
+
+  mapping->contents = iree_make_byte_span(data_ptr, local_byte_length);
+  return iree_ok_status();
+}
+
+static iree_status_t iree_hal_remoting_buffer_unmap_range(
+    iree_hal_buffer_t* base_buffer, iree_device_size_t local_byte_offset,
+    iree_device_size_t local_byte_length, iree_hal_buffer_mapping_t* mapping) {
+  iree_hal_remoting_buffer_t* buffer =
+      iree_hal_remoting_buffer_cast(base_buffer);
+  if (buffer->shared_ptr) return iree_ok_status();
+  if (!iree_any_bit_set(mapping->impl.allowed_access,
+                        IREE_HAL_MEMORY_ACCESS_WRITE)) {
+    return iree_ok_status();
+  }
+  return iree_hal_remoting_buffer_write(buffer->connection, buffer->handle,
+                                        local_byte_offset,
+                                        mapping->contents.data,
+                                        local_byte_length);
+}
+
+static iree_status_t iree_hal_remoting_buffer_invalidate_range(
+    iree_hal_buffer_t* base_buffer, iree_device_size_t local_byte_offset,
+    iree_device_size_t local_byte_length) {
+  iree_hal_remoting_buffer_t* buffer =
+      iree_hal_remoting_buffer_cast(base_buffer);
+  if (buffer->shared_ptr) return iree_ok_status();
+  uint8_t* shadow_ptr = NULL;
+  IREE_RETURN_IF_ERROR(iree_hal_remoting_buffer_shadow(buffer, &shadow_ptr));
+  return iree_hal_remoting_buffer_read(buffer->connection, buffer->handle,
+                                       local_byte_offset,
+                                       shadow_ptr + local_byte_offset,
+                                       local_byte_length);
+}
+
+static iree_status_t iree_hal_remoting_buffer_flush_range(
+    iree_hal_buffer_t* base_buffer, iree_device_size_t local_byte_offset,
+    iree_device_size_t local_byte_length) {
+  iree_hal_remoting_buffer_t* buffer =
+      iree_hal_remoting_buffer_cast(base_buffer);
+  if (buffer->shared_ptr) return iree_ok_status();
+  uint8_t* shadow_ptr = NULL;
+  IREE_RETURN_IF_ERROR(iree_hal_remoting_buffer_shadow(buffer, &shadow_ptr));
+  return iree_hal_remoting_buffer_write(buffer->connection, buffer->handle,
+                                        local_byte_offset,
+                                        shadow_ptr + local_byte_offset,
+                                        local_byte_length);
+}
+
+static const iree_hal_buffer_vtable_t iree_hal_remoting_buffer_vtable = {
+    .recycle = iree_hal_buffer_recycle,
+    .destroy = iree_hal_remoting_buffer_destroy,
+    .map_range = iree_hal_remoting_buffer_map_range,
+    .unmap_range = iree_hal_remoting_buffer_unmap_range,
+    .invalidate_range = iree_hal_remoting_buffer_invalidate_range,
+    .flush_range = iree_hal_remoting_buffer_flush_range,
+};
@@ -0,0 +1,76 @@
+// Copyright 2023 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#ifndef IREE_HAL_REMOTING_BUFFER_H_
+#define IREE_HAL_REMOTING_BUFFER_H_
+
+#include "experimental/remoting/connection.h"
+#include "iree/base/api.h"
+#include "iree/hal/api.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif  // __cplusplus
+
+// Wraps the server buffer named by |handle| in an iree_hal_buffer_t. The
+// buffer takes ownership of the handle and releases it when destroyed.
+//
+// If |shared_ptr| is not NULL it is a mapping of the shared memory that backs
+// the server buffer and is used directly for mapping. The buffer takes
+// ownership of the mapping. Otherwise mappings are staged through a host
+// shadow allocation that is read from and written back to the server and
+// IREE_HAL_MEMORY_TYPE_HOST_COHERENT is dropped from |memory_type| so that
+// users flush and invalidate persistent mappings.
+//
+// |allocator| is optional and if given is notified when the buffer is
+// recycled. |connection| is unretained as the device outlives all buffers.
+iree_status_t iree_hal_remoting_buffer_wrap(
+    iree_hal_remoting_connection_t* connection, iree_hal_allocator_t* allocator,
+    iree_allocator_t host_allocator, iree_hal_memory_type_t memory_type,
+    iree_hal_memory_access_t allowed_access,
+    iree_hal_buffer_usage_t allowed_usage, iree_device_size_t allocation_size,
+    iree_hal_remoting_handle_t handle, void* shared_ptr,
+    iree_hal_buffer_t** out_buffer);
+
+// Packs |params| for transmission to the server.
+void iree_hal_remoting_buffer_params_pack(
+    const iree_hal_buffer_params_t* params,
+    iree_hal_remoting_buffer_params_t* out_params);
+
+// Returns true if |buffer| is a remoting buffer created by this driver.
+bool iree_hal_remoting_buffer_isa(iree_hal_buffer_t* buffer);
+
+// Returns the handle of the allocated buffer backing |buffer| and translates
+// |offset| within |buffer| to an offset within the allocation. Fails with
+// IREE_STATUS_INVALID_ARGUMENT if |buffer| is not a remoting buffer.
+iree_status_t iree_hal_remoting_buffer_resolve(
+    iree_hal_buffer_t* buffer, iree_device_size_t offset,
+    iree_hal_remoting_handle_t* out_handle, iree_device_size_t* out_offset);
+
+// Returns the shared memory mapping of the allocation backing |buffer| or NULL
+// if the buffer is not in shared memory. Like the handle the mapping spans the
+// entire allocation.
+void* iree_hal_remoting_buffer_shared_pointer(iree_hal_buffer_t* buffer);
+
+// Reads |length| bytes at |offset| of the allocation named by |handle| into
+// |target|. Large reads are split into multiple calls.
+iree_status_t iree_hal_remoting_buffer_read(
+    iree_hal_remoting_connection_t* connection,
+    iree_hal_remoting_handle_t handle, iree_device_size_t offset, void* target,
+    iree_device_size_t length);
+
+// Posts writes of |length| bytes from |source| to |offset| of the allocation
+// named by |handle|. The write is ordered before all subsequent messages.
+iree_status_t iree_hal_remoting_buffer_write(
+    iree_hal_remoting_connection_t* connection,
+    iree_hal_remoting_handle_t handle, iree_device_size_t offset,
+    const void* source, iree_device_size_t length);
+
+#ifdef __cplusplus
+}  // extern "C"
+#endif  // __cplusplus
+
+#endif  // IREE_HAL_REMOTING_BUFFER_H_
@@ -0,0 +1,587 @@
+// Copyright 2023 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include "experimental/remoting/command_buffer.h"
+
+#include <stddef.h>
+#include <string.h>
+
+#include "experimental/remoting/buffer.h"
+#include "experimental/remoting/executable.h"
+#include "experimental/remoting/pipeline_layout.h"
+#include "iree/base/api.h"
+#include "iree/base/tracing.h"
+#include "iree/hal/utils/resource_set.h"
+
+// Initial capacity of the command stream; grown by doubling.
+#define IREE_HAL_REMOTING_COMMAND_STREAM_INITIAL_CAPACITY (4 * 1024)
+
+typedef struct iree_hal_remoting_command_buffer_t {
+  iree_hal_command_buffer_t base;
+  iree_allocator_t host_allocator;
+  iree_hal_remoting_connection_t* connection;
+  iree_hal_remoting_handle_t handle;
+
+  // Retains resources referenced by recorded commands.
+  iree_hal_resource_set_t* resource_set;
+
+  // Commands recorded since begin. Released once posted to the server.
+  uint8_t* commands;
+  iree_host_size_t commands_length;
+  iree_host_size_t commands_capacity;
+
+  // First failure of a command that cannot return a status (debug groups).
+  // Returned from end.
+  iree_status_t recording_status;
+
+  // True once the commands have been posted to the server.
+  bool is_posted;
+} iree_hal_remoting_command_buffer_t;
+
+static const iree_hal_command_buffer_vtable_t
+    iree_hal_remoting_command_buffer_vtable;
+
+static iree_hal_remoting_command_buffer_t*
+iree_hal_remoting_command_buffer_cast(iree_hal_command_buffer_t* base_value) {
+  IREE_HAL_ASSERT_TYPE(base_value, &iree_hal_remoting_command_buffer_vtable);
+  return (iree_hal_remoting_command_buffer_t*)base_value;
+}
+
+iree_status_t iree_hal_remoting_command_buffer_create(
+    iree_hal_device_t* device, iree_hal_remoting_connection_t* connection,
+    iree_hal_command_buffer_mode_t mode,
+    iree_hal_command_category_t command_categories,
+    iree_hal_queue_affinity_t queue_affinity, iree_host_size_t binding_capacity,
+    iree_arena_block_pool_t* block_pool, iree_allocator_t host_allocator,
+    iree_hal_command_buffer_t** out_command_buffer) {
+  IREE_ASSERT_ARGUMENT(connection);
+  IREE_ASSERT_ARGUMENT(block_pool);
+  IREE_ASSERT_ARGUMENT(out_command_buffer);
+  *out_command_buffer = NULL;
+  if (binding_capacity > 0) {
+    return iree_make_status(IREE_STATUS_UNIMPLEMENTED,
+                            "indirect command buffers not yet implemented");
+  }
+  IREE_TRACE_ZONE_BEGIN(z0);
+
+  iree_hal_remoting_command_buffer_t* command_buffer = NULL;
+  iree_status_t status = iree_allocator_malloc(
+      host_allocator, sizeof(*command_buffer), (void**)&command_buffer);
+  if (iree_status_is_ok(status)) {
+    memset(command_buffer, 0, sizeof(*command_buffer));
+    iree_hal_command_buffer_initialize(
+        device, mode, command_categories, queue_affinity, binding_capacity,
+        &iree_hal_remoting_command_buffer_vtable, &command_buffer->base);
+    command_buffer->host_allocator = host_allocator;
+    command_buffer->connection = connection;
+    status = iree_hal_resource_set_allocate(block_pool,
+                                            &command_buffer->resource_set);
+  }
+  if (iree_status_is_ok(status)) {
+    status = iree_hal_remoting_connection_allocate_handle(
+        connection, &command_buffer->handle);
+  }
+
+  if (iree_status_is_ok(status)) {
+    *out_command_buffer = &command_buffer->base;
+  } else if (command_buffer) {
+    iree_hal_command_buffer_destroy(&command_buffer->base);
+  }
+  IREE_TRACE_ZONE_END(z0);
+  return status;
+}
+
+static void iree_hal_remoting_command_buffer_destroy(
+    iree_hal_command_buffer_t* base_command_buffer) {
+  iree_hal_remoting_command_buffer_t* command_buffer =
+      iree_hal_remoting_command_buffer_cast(base_command_buffer);
+  iree_allocator_t host_allocator = command_buffer->host_allocator;
+  IREE_TRACE_ZONE_BEGIN(z0);
+
+  // The server ignores releases of command buffers that were never posted.
+  iree_hal_remoting_connection_release_handle(command_buffer->connection,
+                                              command_buffer->handle);
+  iree_status_ignore(command_buffer->recording_status);
+  iree_allocator_free(host_allocator, command_buffer->commands);
+  if (command_buffer->resource_set) {
+    iree_hal_resource_set_free(command_buffer->resource_set);
+  }
+  iree_allocator_free(host_allocator, command_buffer);
+
+  IREE_TRACE_ZONE_END(z0);
+}
+
+bool iree_hal_remoting_command_buffer_isa(
+    iree_hal_command_buffer_t* command_buffer) {
+  return iree_hal_command_buffer_dyn_cast(
+      command_buffer, &iree_hal_remoting_command_buffer_vtable);
+}
+
+iree_hal_remoting_handle_t iree_hal_remoting_command_buffer_handle(
+    iree_hal_command_buffer_t* base_command_buffer) {
+  iree_hal_remoting_command_buffer_t* command_buffer =
+      iree_hal_remoting_command_buffer_cast(base_command_buffer);
+  return command_buffer->handle;
+}
+
+static void* iree_hal_remoting_command_buffer_dyn_cast(
+    iree_hal_command_buffer_t* command_buffer, const void* vtable) {
+  if (vtable == &iree_hal_remoting_command_buffer_vtable) {
+    IREE_HAL_ASSERT_TYPE(command_buffer, vtable);
+    return command_buffer;
+  }
+  return NULL;
+}
+
+//===----------------------------------------------------------------------===//
+// Recording utilities
+//===----------------------------------------------------------------------===//
+
+// Appends a zero-initialized command of |type| with |length| bytes (including
+// the header) to the stream and returns a pointer to it in |out_command|.
+// The pointer is valid until the next command is appended.
+static iree_status_t iree_hal_remoting_command_buffer_append(
+    iree_hal_remoting_command_buffer_t* command_buffer,
+    iree_hal_remoting_command_type_t type, iree_host_size_t length,
+    void** out_command) {
+  *out_command = NULL;
+  if (command_buffer->is_posted) {
+    return iree_make_status(IREE_STATUS_FAILED_PRECONDITION,
+                            "command buffer has already been recorded");
+  }
+  const iree_host_size_t aligned_length =
+      iree_host_align(length, IREE_HAL_REMOTING_PAYLOAD_ALIGNMENT);
+  if (aligned_length > UINT32_MAX) {
+    return iree_make_status(IREE_STATUS_OUT_OF_RANGE,
+                            "command of %" PRIhsz " bytes too large", length);
+  }
+  const iree_host_size_t required_length =
+      command_buffer->commands_length + aligned_length;
+  if (required_length > command_buffer->commands_capacity) {
+    iree_host_size_t new_capacity = iree_max(
+        IREE_HAL_REMOTING_COMMAND_STREAM_INITIAL_CAPACITY,
+        command_buffer->commands_capacity * 2);
+    new_capacity = iree_max(new_capacity, required_length);
+    IREE_RETURN_IF_ERROR(iree_allocator_realloc(
+        command_buffer->host_allocator, new_capacity,
+        (void**)&command_buffer->commands));
+    command_buffer->commands_capacity = new_capacity;
+  }
+  uint8_t* command_ptr =
+      command_buffer->commands + command_buffer->commands_length;
+  memset(command_ptr, 0, aligned_length);
+  iree_hal_remoting_command_header_t* header =
+      (iree_hal_remoting_command_header_t*)command_ptr;
+  header->type = type;
+  header->length = (uint32_t)aligned_length;
+  command_buffer->commands_length = required_length;
+  *out_command = command_ptr;
+  return iree_ok_status();
+}
+
+// Retains |buffer| and resolves it to a server handle and allocation offset.
+static iree_status_t iree_hal_remoting_command_buffer_resolve_buffer(
+    iree_hal_remoting_command_buffer_t* command_buffer,
+    iree_hal_buffer_t* buffer, iree_device_size_t offset,
+    iree_hal_remoting_handle_t* out_handle, iree_device_size_t* out_offset) {
+  IREE_RETURN_IF_ERROR(
+      iree_hal_remoting_buffer_resolve(buffer, offset, out_handle, out_offset));
+  return iree_hal_resource_set_insert(command_buffer->resource_set, 1,
+                                      &buffer);
+}
+
+//===----------------------------------------------------------------------===//
+// iree_hal_command_buffer_t implementation
+//===----------------------------------------------------------------------===//
+
+static iree_status_t iree_hal_remoting_command_buffer_begin(
+    iree_hal_command_buffer_t* base_command_buffer) {
+  iree_hal_remoting_command_buffer_t* command_buffer =
+      iree_hal_remoting_command_buffer_cast(base_command_buffer);
+  if (command_buffer->is_posted) {
+    return iree_make_status(IREE_STATUS_FAILED_PRECONDITION,
+                            "remoting command buffers can only be recorded "
+                            "once");
+  }
+  command_buffer->commands_length = 0;
+  return iree_ok_status();
+}
+
+static iree_status_t iree_hal_remoting_command_buffer_end(
+    iree_hal_command_buffer_t* base_command_buffer) {
+  iree_hal_remoting_command_buffer_t* command_buffer =
+      iree_hal_remoting_command_buffer_cast(base_command_buffer);
+  IREE_TRACE_ZONE_BEGIN(z0);
+  IREE_TRACE_ZONE_APPEND_VALUE(z0, (int64_t)command_buffer->commands_length);
+
+  iree_status_t status = command_buffer->recording_status;
+  command_buffer->recording_status = iree_ok_status();
+  if (iree_status_is_ok(status) &&
+      command_buffer->commands_length +
+              sizeof(iree_hal_remoting_command_buffer_create_t) >
+          IREE_HAL_REMOTING_MAX_PAYLOAD_LENGTH) {
+    status = iree_make_status(IREE_STATUS_RESOURCE_EXHAUSTED,
+                              "command buffer of %" PRIhsz
+                              " bytes exceeds the remoting message limit",
+                              command_buffer->commands_length);
+  }
+
+  // The whole command buffer is sent as one message. Recording failures on
+  // the server are reported when the command buffer is submitted.
+  if (iree_status_is_ok(status)) {
+    const iree_hal_remoting_command_buffer_create_t request = {
+        .command_buffer = command_buffer->handle,
+        .mode = base_command_buffer->mode,
+        .command_categories = base_command_buffer->allowed_categories,
+        .queue_affinity = base_command_buffer->queue_affinity,
+        .commands_length = command_buffer->commands_length,
+    };
+    const iree_const_byte_span_t spans[2] = {
+        iree_make_const_byte_span(&request, sizeof(request)),
+        iree_make_const_byte_span(command_buffer->commands,
+                                  command_buffer->commands_length),
+    };
+    status = iree_hal_remoting_connection_post(
+        command_buffer->connection,
+        IREE_HAL_REMOTING_MESSAGE_COMMAND_BUFFER_CREATE, IREE_ARRAYSIZE(spans),
+        spans, /*fd=*/-1);
+  }
+  if (iree_status_is_ok(status)) {
+    command_buffer->is_posted = true;
+    iree_allocator_free(command_buffer->host_allocator,
+                        command_buffer->commands);
+    command_buffer->commands = NULL;
+    command_buffer->commands_length = 0;
+    command_buffer->commands_capacity = 0;
+  }
+
+  IREE_TRACE_ZONE_END(z0);
+  return status;
+}
+
+static void iree_hal_remoting_command_buffer_begin_debug_group(
+    iree_hal_command_buffer_t* base_command_buffer, iree_string_view_t label,
+    iree_hal_label_color_t label_color,
+    const iree_hal_label_location_t* location) {
+  iree_hal_remoting_command_buffer_t* command_buffer =
+      iree_hal_remoting_command_buffer_cast(base_command_buffer);
+  if (!iree_status_is_ok(command_buffer->recording_status)) return;
+  iree_hal_remoting_begin_debug_group_cmd_t* cmd = NULL;
+  command_buffer->recording_status = iree_hal_remoting_command_buffer_append(
+      command_buffer, IREE_HAL_REMOTING_COMMAND_BEGIN_DEBUG_GROUP,
+      sizeof(*cmd) + label.size, (void**)&cmd);
+  if (!iree_status_is_ok(command_buffer->recording_status)) return;
+  cmd->label_color = ((uint32_t)label_color.r << 24) |
+                     ((uint32_t)label_color.g << 16) |
+                     ((uint32_t)label_color.b << 8) | (uint32_t)label_color.a;
+  cmd->label_length = (uint32_t)label.size;
+  memcpy((uint8_t*)cmd + sizeof(*cmd), label.data, label.size);
+}
+
+static void iree_hal_remoting_command_buffer_end_debug_group(
+    iree_hal_command_buffer_t* base_command_buffer) {
+  iree_hal_remoting_command_buffer_t* command_buffer =
+      iree_hal_remoting_command_buffer_cast(base_command_buffer);
+  if (!iree_status_is_ok(command_buffer->recording_status)) return;
+  iree_hal_remoting_end_debug_group_cmd_t* cmd = NULL;
+  command_buffer->recording_status = iree_hal_remoting_command_buffer_append(
+      command_buffer, IREE_HAL_REMOTING_COMMAND_END_DEBUG_GROUP, sizeof(*cmd),
+      (void**)&cmd);
+}
+
+static iree_status_t iree_hal_remoting_command_buffer_execution_barrier(
+    iree_hal_command_buffer_t* base_command_buffer,
+    iree_hal_execution_stage_t source_stage_mask,
+    iree_hal_execution_stage_t target_stage_mask,
+    iree_hal_execution_barrier_flags_t flags,
+    iree_host_size_t memory_barrier_count,
+    const iree_hal_memory_barrier_t* memory_barriers,
+    iree_host_size_t buffer_barrier_count,
+    const iree_hal_buffer_barrier_t* buffer_barriers) {
+  iree_hal_remoting_command_buffer_t* command_buffer =
+      iree_hal_remoting_command_buffer_cast(base_command_buffer);
+  iree_hal_remoting_execution_barrier_cmd_t* cmd = NULL;
+  IREE_RETURN_IF_ERROR(iree_hal_remoting_command_buffer_append(
+      command_buffer, IREE_HAL_REMOTING_COMMAND_EXECUTION_BARRIER,
+      sizeof(*cmd), (void**)&cmd));
+  cmd->source_stage_mask = source_stage_mask;
+  cmd->target_stage_mask = target_stage_mask;
+  cmd->flags = flags;
+  return iree_ok_status();
+}
+
+static iree_status_t iree_hal_remoting_command_buffer_signal_event(
+    iree_hal_command_buffer_t* base_command_buffer, iree_hal_event_t* event,
+    iree_hal_execution_stage_t source_stage_mask) {
+  return iree_make_status(IREE_STATUS_UNIMPLEMENTED,
+                          "events not yet implemented");
+}
+
+static iree_status_t iree_hal_remoting_command_buffer_reset_event(
+    iree_hal_command_buffer_t* base_command_buffer, iree_hal_event_t* event,
+    iree_hal_execution_stage_t source_stage_mask) {
+  return iree_make_status(IREE_STATUS_UNIMPLEMENTED,
+                          "events not yet implemented");
+}
+
+static iree_status_t iree_hal_remoting_command_buffer_wait_events(
+    iree_hal_command_buffer_t* base_command_buffer,
+    iree_host_size_t event_count, const iree_hal_event_t** events,
+    iree_hal_execution_stage_t source_stage_mask,
+    iree_hal_execution_stage_t target_stage_mask,
+    iree_host_size_t memory_barrier_count,
+    const iree_hal_memory_barrier_t* memory_barriers,
+    iree_host_size_t buffer_barrier_count,
+    const iree_hal_buffer_barrier_t* buffer_barriers) {
+  return iree_make_status(IREE_STATUS_UNIMPLEMENTED,
+                          "events not yet implemented");
+}
+
+static iree_status_t iree_hal_remoting_command_buffer_discard_buffer(
+    iree_hal_command_buffer_t* base_command_buffer, iree_hal_buffer_t* buffer) {
+  iree_hal_remoting_command_buffer_t* command_buffer =
+      iree_hal_remoting_command_buffer_cast(base_command_buffer);
+  iree_hal_remoting_handle_t handle = IREE_HAL_REMOTING_HANDLE_NULL;
+  iree_device_size_t offset = 0;
+  IREE_RETURN_IF_ERROR(iree_hal_remoting_command_buffer_resolve_buffer(
+      command_buffer, buffer, 0, &handle, &offset));
+  iree_hal_remoting_discard_buffer_cmd_t* cmd = NULL;
+  IREE_RETURN_IF_ERROR(iree_hal_remoting_command_buffer_append(
+      command_buffer, IREE_HAL_REMOTING_COMMAND_DISCARD_BUFFER, sizeof(*cmd),
+      (void**)&cmd));
+  cmd->buffer = handle;
+  return iree_ok_status();
+}
+
+static iree_status_t iree_hal_remoting_command_buffer_fill_buffer(
+    iree_hal_command_buffer_t* base_command_buffer,
+    iree_hal_buffer_t* target_buffer, iree_device_size_t target_offset,
+    iree_device_size_t length, const void* pattern,
+    iree_host_size_t pattern_length) {
+  iree_hal_remoting_command_buffer_t* command_buffer =
+      iree_hal_remoting_command_buffer_cast(base_command_buffer);
+  if (pattern_length > sizeof(uint64_t)) {
+    return iree_make_status(IREE_STATUS_INVALID_ARGUMENT,
+                            "fill patterns must be at most 8 bytes");
+  }
+  iree_hal_remoting_handle_t handle = IREE_HAL_REMOTING_HANDLE_NULL;
+  IREE_RETURN_IF_ERROR(iree_hal_remoting_command_buffer_resolve_buffer(
+      command_buffer, target_buffer, target_offset, &handle, &target_offset));
+  iree_hal_remoting_fill_buffer_cmd_t* cmd = NULL;
+  IREE_RETURN_IF_ERROR(iree_hal_remoting_command_buffer_append(
+      command_buffer, IREE_HAL_REMOTING_COMMAND_FILL_BUFFER, sizeof(*cmd),
+      (void**)&cmd));
+  cmd->target_buffer = handle;
+  cmd->pattern_length = (uint32_t)pattern_length;
+  cmd->target_offset = target_offset;
+  cmd->length = length;
+  memcpy(&cmd->pattern, pattern, pattern_length);
+  return iree_ok_status();
+}
+
+static iree_status_t iree_hal_remoting_command_buffer_update_buffer(
+    iree_hal_command_buffer_t* base_command_buffer, const void* source_buffer,
+    iree_host_size_t source_offset, iree_hal_buffer_t* target_buffer,
+    iree_device_size_t target_offset, iree_device_size_t length) {
+  iree_hal_remoting_command_buffer_t* command_buffer =
+      iree_hal_remoting_command_buffer_cast(base_command_buffer);
+  iree_hal_remoting_handle_t handle = IREE_HAL_REMOTING_HANDLE_NULL;
+  IREE_RETURN_IF_ERROR(iree_hal_remoting_command_buffer_resolve_buffer(
+      command_buffer, target_buffer, target_offset, &handle, &target_offset));
+  // The source data is captured inline in the command stream.
+  iree_hal_remoting_update_buffer_cmd_t* cmd = NULL;
+  IREE_RETURN_IF_ERROR(iree_hal_remoting_command_buffer_append(
+      command_buffer, IREE_HAL_REMOTING_COMMAND_UPDATE_BUFFER,
+      sizeof(*cmd) + (iree_host_size_t)length, (void**)&cmd));
+  cmd->target_buffer = handle;
+  cmd->target_offset = target_offset;
+  cmd->length = length;
+  memcpy((uint8_t*)cmd + sizeof(*cmd),
+         (const uint8_t*)source_buffer + source_offset,
+         (iree_host_size_t)length);
+  return iree_ok_status();
+}
+
+static iree_status_t iree_hal_remoting_command_buffer_copy_buffer(
+    iree_hal_command_buffer_t* base_command_buffer,
+    iree_hal_buffer_t* source_buffer, iree_device_size_t source_offset,
+    iree_hal_buffer_t* target_buffer, iree_device_size_t target_offset,
+    iree_device_size_t length) {
+  iree_hal_remoting_command_buffer_t* command_buffer =
+      iree_hal_remoting_command_buffer_cast(base_command_buffer);
+  iree_hal_remoting_handle_t source_handle = IREE_HAL_REMOTING_HANDLE_NULL;
+  IREE_RETURN_IF_ERROR(iree_hal_remoting_command_buffer_resolve_buffer(
+      command_buffer, source_buffer, source_offset, &source_handle,
+      &source_offset));
+  iree_hal_remoting_handle_t target_handle = IREE_HAL_REMOTING_HANDLE_NULL;
+  IREE_RETURN_IF_ERROR(iree_hal_remoting_command_buffer_resolve_buffer(
+      command_buffer, target_buffer, target_offset, &target_handle,
+      &target_offset));
+  iree_hal_remoting_copy_buffer_cmd_t* cmd = NULL;
+  IREE_RETURN_IF_ERROR(iree_hal_remoting_command_buffer_append(
+      command_buffer, IREE_HAL_REMOTING_COMMAND_COPY_BUFFER, sizeof(*cmd),
+      (void**)&cmd));
+  cmd->source_buffer = source_handle;
+  cmd->target_buffer = target_handle;
+  cmd->source_offset = source_offset;
+  cmd->target_offset = target_offset;
+  cmd->length = length;
+  return iree_ok_status();
+}
+
+static iree_status_t iree_hal_remoting_command_buffer_collective(
+    iree_hal_command_buffer_t* base_command_buffer, iree_hal_channel_t* channel,
+    iree_hal_collective_op_t op, uint32_t param,
+    iree_hal_buffer_binding_t send_binding,
+    iree_hal_buffer_binding_t recv_binding, iree_device_size_t element_count) {
+  return iree_make_status(IREE_STATUS_UNIMPLEMENTED,
+                          "collectives not yet implemented");
+}
+
+static iree_status_t iree_hal_remoting_command_buffer_push_constants(
+    iree_hal_command_buffer_t* base_command_buffer,
+    iree_hal_pipeline_layout_t* pipeline_layout, iree_host_size_t offset,
+    const void* values, iree_host_size_t values_length) {
+  iree_hal_remoting_command_buffer_t* command_buffer =
+      iree_hal_remoting_command_buffer_cast(base_command_buffer);
+  IREE_RETURN_IF_ERROR(iree_hal_resource_set_insert(
+      command_buffer->resource_set, 1, &pipeline_layout));
+  iree_hal_remoting_push_constants_cmd_t* cmd = NULL;
+  IREE_RETURN_IF_ERROR(iree_hal_remoting_command_buffer_append(
+      command_buffer, IREE_HAL_REMOTING_COMMAND_PUSH_CONSTANTS,
+      sizeof(*cmd) + values_length, (void**)&cmd));
+  cmd->pipeline_layout =
+      iree_hal_remoting_pipeline_layout_handle(pipeline_layout);
+  cmd->offset = (uint32_t)offset;
+  cmd->values_length = (uint32_t)values_length;
+  memcpy((uint8_t*)cmd + sizeof(*cmd), values, values_length);
+  return iree_ok_status();
+}
+
+static iree_status_t iree_hal_remoting_command_buffer_push_descriptor_set(
+    iree_hal_command_buffer_t* base_command_buffer,
+    iree_hal_pipeline_layout_t* pipeline_layout, uint32_t set,
+    iree_host_size_t binding_count,
+    const iree_hal_descriptor_set_binding_t* bindings) {
+  iree_hal_remoting_command_buffer_t* command_buffer =
+      iree_hal_remoting_command_buffer_cast(base_command_buffer);
+  IREE_RETURN_IF_ERROR(iree_hal_resource_set_insert(
+      command_buffer->resource_set, 1, &pipeline_layout));
+
+  // Resolve all bindings before appending so that a failure leaves no partial
+  // command in the stream.
+  iree_hal_remoting_descriptor_set_binding_t* wire_bindings =
+      (iree_hal_remoting_descriptor_set_binding_t*)iree_alloca(
+          binding_count * sizeof(*wire_bindings));
+  for (iree_host_size_t i = 0; i < binding_count; ++i) {
+    const iree_hal_descriptor_set_binding_t* binding = &bindings[i];
+    iree_hal_remoting_descriptor_set_binding_t* wire_binding =
+        &wire_bindings[i];
+    memset(wire_binding, 0, sizeof(*wire_binding));
+    wire_binding->binding = binding->binding;
+    if (!binding->buffer) continue;
+    iree_device_size_t offset = 0;
+    IREE_RETURN_IF_ERROR(iree_hal_remoting_command_buffer_resolve_buffer(
+        command_buffer, binding->buffer, binding->offset, &wire_binding->buffer,
+        &offset));
+    wire_binding->offset = offset;
+    // Whole-buffer bindings of subspans must not extend to the end of the
+    // allocation the server sees.
+    wire_binding->length =
+        binding->length == IREE_WHOLE_BUFFER
+            ? iree_hal_buffer_byte_length(binding->buffer) - binding->offset
+            : binding->length;
+  }
+
+  iree_hal_remoting_push_descriptor_set_cmd_t* cmd = NULL;
+  IREE_RETURN_IF_ERROR(iree_hal_remoting_command_buffer_append(
+      command_buffer, IREE_HAL_REMOTING_COMMAND_PUSH_DESCRIPTOR_SET,
+      sizeof(*cmd) + binding_count * sizeof(*wire_bindings), (void**)&cmd));
+  cmd->pipeline_layout =
+      iree_hal_remoting_pipeline_layout_handle(pipeline_layout);
+  cmd->set = set;
+  cmd->binding_count = (uint32_t)binding_count;
+  memcpy((uint8_t*)cmd + sizeof(*cmd), wire_bindings,
+         binding_count * sizeof(*wire_bindings));
+  return iree_ok_status();
+}
+
+static iree_status_t iree_hal_remoting_command_buffer_dispatch(
+    iree_hal_command_buffer_t* base_command_buffer,
+    iree_hal_executable_t* executable, int32_t entry_point,
+    uint32_t workgroup_x, uint32_t workgroup_y, uint32_t workgroup_z) {
+  iree_hal_remoting_command_buffer_t* command_buffer =
+      iree_hal_remoting_command_buffer_cast(base_command_buffer);
+  IREE_RETURN_IF_ERROR(iree_hal_resource_set_insert(
+      command_buffer->resource_set, 1, &executable));
+  iree_hal_remoting_dispatch_cmd_t* cmd = NULL;
+  IREE_RETURN_IF_ERROR(iree_hal_remoting_command_buffer_append(
+      command_buffer, IREE_HAL_REMOTING_COMMAND_DISPATCH, sizeof(*cmd),
+      (void**)&cmd));
+  cmd->executable = iree_hal_remoting_executable_handle(executable);
+  cmd->entry_point = entry_point;
+  cmd->workgroup_x = workgroup_x;
+  cmd->workgroup_y = workgroup_y;
+  cmd->workgroup_z = workgroup_z;
+  return iree_ok_status();
+}
+
+static iree_status_t iree_hal_remoting_command_buffer_dispatch_indirect(
+    iree_hal_command_buffer_t* base_command_buffer,
+    iree_hal_executable_t* executable, int32_t entry_point,
+    iree_hal_buffer_t* workgroups_buffer,
+    iree_device_size_t workgroups_offset) {
+  iree_hal_remoting_command_buffer_t* command_buffer =
+      iree_hal_remoting_command_buffer_cast(base_command_buffer);
+  IREE_RETURN_IF_ERROR(iree_hal_resource_set_insert(
+      command_buffer->resource_set, 1, &executable));
+  iree_hal_remoting_handle_t handle = IREE_HAL_REMOTING_HANDLE_NULL;
+  IREE_RETURN_IF_ERROR(iree_hal_remoting_command_buffer_resolve_buffer(
+      command_buffer, workgroups_buffer, workgroups_offset, &handle,
+      &workgroups_offset));
+  iree_hal_remoting_dispatch_indirect_cmd_t* cmd = NULL;
+  IREE_RETURN_IF_ERROR(iree_hal_remoting_command_buffer_append(
+      command_buffer, IREE_HAL_REMOTING_COMMAND_DISPATCH_INDIRECT, sizeof(*cmd),
+      (void**)&cmd));
+  cmd->executable = iree_hal_remoting_executable_handle(executable);
+  cmd->entry_point = entry_point;
+  cmd->workgroups_buffer = handle;
+  cmd->workgroups_offset = workgroups_offset;
+  return iree_ok_status();
+}
+
+static iree_status_t iree_hal_remoting_command_buffer_execute_commands(
+    iree_hal_command_buffer_t* base_command_buffer,
+    iree_hal_command_buffer_t* base_commands,
+    iree_hal_buffer_binding_table_t binding_table) {
+  return iree_make_status(IREE_STATUS_UNIMPLEMENTED,
+                          "indirect command buffers not yet implemented");
+}
+
+static const iree_hal_command_buffer_vtable_t
+    iree_hal_remoting_command_buffer_vtable = {
+        .destroy = iree_hal_remoting_command_buffer_destroy,
+        .dyn_cast = iree_hal_remoting_command_buffer_dyn_cast,
+        .begin = iree_hal_remoting_command_buffer_begin,
+        .end = iree_hal_remoting_command_buffer_end,
+        .begin_debug_group = iree_hal_remoting_command_buffer_begin_debug_group,
+        .end_debug_group = iree_hal_remoting_command_buffer_end_debug_group,
+        .execution_barrier = iree_hal_remoting_command_buffer_execution_barrier,
+        .signal_event = iree_hal_remoting_command_buffer_signal_event,
+        .reset_event = iree_hal_remoting_command_buffer_reset_event,
+        .wait_events = iree_hal_remoting_command_buffer_wait_events,
+        .discard_buffer = iree_hal_remoting_command_buffer_discard_buffer,
+        .fill_buffer = iree_hal_remoting_command_buffer_fill_buffer,
+        .update_buffer = iree_hal_remoting_command_buffer_update_buffer,
+        .copy_buffer = iree_hal_remoting_command_buffer_copy_buffer,
+        .collective = iree_hal_remoting_command_buffer_collective,
+        .push_constants = iree_hal_remoting_command_buffer_push_constants,
+        .push_descriptor_set =
+            iree_hal_remoting_command_buffer_push_descriptor_set,
+        .dispatch = iree_hal_remoting_command_buffer_dispatch,
+        .dispatch_indirect = iree_hal_remoting_command_buffer_dispatch_indirect,
+        .execute_commands = iree_hal_remoting_command_buffer_execute_commands,
+};
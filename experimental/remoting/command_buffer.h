@@ -0,0 +1,47 @@
+// Copyright 2023 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#ifndef IREE_HAL_REMOTING_COMMAND_BUFFER_H_
+#define IREE_HAL_REMOTING_COMMAND_BUFFER_H_
+
+#include "experimental/remoting/connection.h"
+#include "iree/base/api.h"
+#include "iree/hal/api.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif  // __cplusplus
+
+typedef struct iree_arena_block_pool_t iree_arena_block_pool_t;
+
+// Creates a command buffer that records commands into a host byte stream.
+// The entire stream is posted to the server as a single message when
+// recording ends and the server records it into a real command buffer that
+// (if reusable) may be submitted many times without being sent again.
+//
+// Resources referenced by commands are retained in a resource set allocated
+// from |block_pool| for the lifetime of the command buffer.
+iree_status_t iree_hal_remoting_command_buffer_create(
+    iree_hal_device_t* device, iree_hal_remoting_connection_t* connection,
+    iree_hal_command_buffer_mode_t mode,
+    iree_hal_command_category_t command_categories,
+    iree_hal_queue_affinity_t queue_affinity, iree_host_size_t binding_capacity,
+    iree_arena_block_pool_t* block_pool, iree_allocator_t host_allocator,
+    iree_hal_command_buffer_t** out_command_buffer);
+
+// Returns true if |command_buffer| is a remoting command buffer.
+bool iree_hal_remoting_command_buffer_isa(
+    iree_hal_command_buffer_t* command_buffer);
+
+// Returns the handle of the server command buffer backing |command_buffer|.
+iree_hal_remoting_handle_t iree_hal_remoting_command_buffer_handle(
+    iree_hal_command_buffer_t* command_buffer);
+
+#ifdef __cplusplus
+}  // extern "C"
+#endif  // __cplusplus
+
+#endif  // IREE_HAL_REMOTING_COMMAND_BUFFER_H_
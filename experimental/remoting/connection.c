@@ -0,0 +1,230 @@
+// Copyright 2023 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include "experimental/remoting/connection.h"
+
+#include <string.h>
+
+#include "experimental/remoting/transport.h"
+#include "iree/base/tracing.h"
+
+// Maximum length of a remote status message retained in local statuses.
+#define IREE_HAL_REMOTING_MAX_STATUS_MESSAGE_LENGTH 1024
+
+iree_const_byte_span_t iree_hal_remoting_padding_span(iree_host_size_t length) {
+  static const uint8_t zeros[IREE_HAL_REMOTING_PAYLOAD_ALIGNMENT] = {0};
+  IREE_ASSERT_LT(length, IREE_HAL_REMOTING_PAYLOAD_ALIGNMENT);
+  return iree_make_const_byte_span(zeros, length);
+}
+
+iree_status_t iree_hal_remoting_connection_initialize(
+    iree_hal_remoting_transport_t* transport, iree_allocator_t host_allocator,
+    iree_hal_remoting_connection_t* out_connection) {
+  IREE_ASSERT_ARGUMENT(transport);
+  IREE_ASSERT_ARGUMENT(out_connection);
+  IREE_TRACE_ZONE_BEGIN(z0);
+
+  memset(out_connection, 0, sizeof(*out_connection));
+  out_connection->host_allocator = host_allocator;
+  iree_slim_mutex_initialize(&out_connection->mutex);
+  out_connection->transport = transport;
+  out_connection->next_handle = IREE_HAL_REMOTING_HANDLE_NULL + 1;
+
+  const iree_hal_remoting_hello_t hello = {
+      .magic = IREE_HAL_REMOTING_PROTOCOL_MAGIC,
+      .version = IREE_HAL_REMOTING_PROTOCOL_VERSION,
+  };
+  const iree_const_byte_span_t spans[1] = {
+      iree_make_const_byte_span(&hello, sizeof(hello)),
+  };
+  iree_hal_remoting_hello_t server_hello;
+  memset(&server_hello, 0, sizeof(server_hello));
+  iree_status_t status = iree_hal_remoting_connection_call(
+      out_connection, IREE_HAL_REMOTING_MESSAGE_HELLO, IREE_ARRAYSIZE(spans),
+      spans, /*fd=*/-1,
+      iree_make_byte_span(&server_hello, sizeof(server_hello)),
+      /*out_result_length=*/NULL);
+  if (iree_status_is_ok(status) &&
+      (server_hello.magic != IREE_HAL_REMOTING_PROTOCOL_MAGIC ||
+       server_hello.version != IREE_HAL_REMOTING_PROTOCOL_VERSION)) {
+    status = iree_make_status(
+        IREE_STATUS_FAILED_PRECONDITION,
+        "remoting server speaks protocol %08X v%u; expected %08X v%u",
+        server_hello.magic, server_hello.version,
+        IREE_HAL_REMOTING_PROTOCOL_MAGIC, IREE_HAL_REMOTING_PROTOCOL_VERSION);
+  }
+
+  if (!iree_status_is_ok(status)) {
+    iree_hal_remoting_connection_deinitialize(out_connection);
+  }
+  IREE_TRACE_ZONE_END(z0);
+  return status;
+}
+
+void iree_hal_remoting_connection_deinitialize(
+    iree_hal_remoting_connection_t* connection) {
+  IREE_TRACE_ZONE_BEGIN(z0);
+  iree_hal_remoting_transport_destroy(connection->transport);
+  iree_allocator_free(connection->host_allocator, connection->free_handles);
+  iree_slim_mutex_deinitialize(&connection->mutex);
+  memset(connection, 0, sizeof(*connection));
+  IREE_TRACE_ZONE_END(z0);
+}
+
+bool iree_hal_remoting_connection_is_local(
+    iree_hal_remoting_connection_t* connection) {
+  // The transport type never changes so no lock is required.
+  return iree_hal_remoting_transport_is_local(connection->transport);
+}
+
+iree_status_t iree_hal_remoting_connection_allocate_handle(
+    iree_hal_remoting_connection_t* connection,
+    iree_hal_remoting_handle_t* out_handle) {
+  iree_status_t status = iree_ok_status();
+  iree_slim_mutex_lock(&connection->mutex);
+  if (connection->free_handle_count > 0) {
+    *out_handle = connection->free_handles[--connection->free_handle_count];
+  } else if (connection->next_handle != UINT32_MAX) {
+    *out_handle = connection->next_handle++;
+  } else {
+    *out_handle = IREE_HAL_REMOTING_HANDLE_NULL;
+    status = iree_make_status(IREE_STATUS_RESOURCE_EXHAUSTED,
+                              "remoting handles exhausted");
+  }
+  iree_slim_mutex_unlock(&connection->mutex);
+  return status;
+}
+
+void iree_hal_remoting_connection_release_handle(
+    iree_hal_remoting_connection_t* connection,
+    iree_hal_remoting_handle_t handle) {
+  if (handle == IREE_HAL_REMOTING_HANDLE_NULL) return;
+  const iree_hal_remoting_release_t release = {
+      .handle = handle,
+  };
+  const iree_const_byte_span_t spans[1] = {
+      iree_make_const_byte_span(&release, sizeof(release)),
+  };
+
+  // The handle can be reused as soon as the release has been sent as the
+  // server processes messages in order. If the connection has failed the
+  // server will release everything when it notices.
+  iree_slim_mutex_lock(&connection->mutex);
+  iree_status_t status = iree_hal_remoting_transport_send(
+      connection->transport, IREE_HAL_REMOTING_MESSAGE_RELEASE,
+      IREE_HAL_REMOTING_MESSAGE_FLAG_NONE, IREE_ARRAYSIZE(spans), spans,
+      /*fd=*/-1);
+  if (iree_status_is_ok(status) &&
+      connection->free_handle_count == connection->free_handle_capacity) {
+    iree_host_size_t new_capacity =
+        iree_max(64, connection->free_handle_capacity * 2);
+    status = iree_allocator_realloc(
+        connection->host_allocator,
+        new_capacity * sizeof(connection->free_handles[0]),
+        (void**)&connection->free_handles);
+    if (iree_status_is_ok(status)) {
+      connection->free_handle_capacity = new_capacity;
+    }
+  }
+  if (iree_status_is_ok(status)) {
+    connection->free_handles[connection->free_handle_count++] = handle;
+  }
+  iree_slim_mutex_unlock(&connection->mutex);
+
+  // Failing to recycle only leaks the handle number.
+  iree_status_ignore(status);
+}
+
+iree_status_t iree_hal_remoting_connection_post(
+    iree_hal_remoting_connection_t* connection,
+    iree_hal_remoting_message_type_t type, iree_host_size_t span_count,
+    const iree_const_byte_span_t* spans, int fd) {
+  iree_slim_mutex_lock(&connection->mutex);
+  iree_status_t status = iree_hal_remoting_transport_send(
+      connection->transport, type, IREE_HAL_REMOTING_MESSAGE_FLAG_NONE,
+      span_count, spans, fd);
+  iree_slim_mutex_unlock(&connection->mutex);
+  return status;
+}
+
+// Receives the reply to a call and returns the status it carries.
+static iree_status_t iree_hal_remoting_connection_recv_reply(
+    iree_hal_remoting_transport_t* transport, iree_byte_span_t result,
+    iree_host_size_t* out_result_length) {
+  iree_hal_remoting_message_header_t header;
+  int fd = -1;
+  IREE_RETURN_IF_ERROR(
+      iree_hal_remoting_transport_recv_header(transport, &header, &fd));
+  iree_hal_remoting_close_fd(fd);
+  if (header.type != IREE_HAL_REMOTING_MESSAGE_REPLY ||
+      header.payload_length < sizeof(iree_hal_remoting_reply_t)) {
+    return iree_make_status(IREE_STATUS_DATA_LOSS,
+                            "expected a reply from the remoting server but "
+                            "received message type %u",
+                            header.type);
+  }
+  iree_host_size_t remaining = header.payload_length;
+
+  iree_hal_remoting_reply_t reply;
+  IREE_RETURN_IF_ERROR(
+      iree_hal_remoting_transport_recv(transport, &reply, sizeof(reply)));
+  remaining -= sizeof(reply);
+  const iree_host_size_t message_storage_length =
+      reply.message_length + iree_hal_remoting_padding(reply.message_length);
+  if (message_storage_length > remaining) {
+    return iree_make_status(IREE_STATUS_DATA_LOSS, "malformed reply");
+  }
+
+  // Keep a bounded prefix of the message for the local status.
+  char message[IREE_HAL_REMOTING_MAX_STATUS_MESSAGE_LENGTH];
+  const iree_host_size_t message_length =
+      iree_min(reply.message_length, sizeof(message));
+  IREE_RETURN_IF_ERROR(
+      iree_hal_remoting_transport_recv(transport, message, message_length));
+  IREE_RETURN_IF_ERROR(iree_hal_remoting_transport_skip(
+      transport, message_storage_length - message_length));
+  remaining -= message_storage_length;
+
+  if (reply.status_code != IREE_STATUS_OK) {
+    IREE_RETURN_IF_ERROR(
+        iree_hal_remoting_transport_skip(transport, remaining));
+    return iree_make_status((iree_status_code_t)reply.status_code,
+                            "remote: %.*s", (int)message_length, message);
+  }
+
+  if (remaining > result.data_length) {
+    IREE_RETURN_IF_ERROR(
+        iree_hal_remoting_transport_skip(transport, remaining));
+    return iree_make_status(IREE_STATUS_OUT_OF_RANGE,
+                            "reply result of %" PRIhsz
+                            " bytes larger than expected (%" PRIhsz ")",
+                            remaining, result.data_length);
+  }
+  IREE_RETURN_IF_ERROR(
+      iree_hal_remoting_transport_recv(transport, result.data, remaining));
+  if (out_result_length) *out_result_length = remaining;
+  return iree_ok_status();
+}
+
+iree_status_t iree_hal_remoting_connection_call(
+    iree_hal_remoting_connection_t* connection,
+    iree_hal_remoting_message_type_t type, iree_host_size_t span_count,
+    const iree_const_byte_span_t* spans, int fd, iree_byte_span_t result,
+    iree_host_size_t* out_result_length) {
+  if (out_result_length) *out_result_length = 0;
+  IREE_TRACE_ZONE_BEGIN(z0);
+  iree_slim_mutex_lock(&connection->mutex);
+  iree_status_t status = iree_hal_remoting_transport_send(
+      connection->transport, type, IREE_HAL_REMOTING_MESSAGE_FLAG_REPLY,
+      span_count, spans, fd);
+  if (iree_status_is_ok(status)) {
+    status = iree_hal_remoting_connection_recv_reply(
+        connection->transport, result, out_result_length);
+  }
+  iree_slim_mutex_unlock(&connection->mutex);
+  IREE_TRACE_ZONE_END(z0);
+  return status;
+}
@@ -0,0 +1,94 @@
+// Copyright 2023 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#ifndef IREE_HAL_REMOTING_CONNECTION_H_
+#define IREE_HAL_REMOTING_CONNECTION_H_
+
+#include "experimental/remoting/api.h"
+#include "experimental/remoting/protocol.h"
+#include "iree/base/api.h"
+#include "iree/base/internal/synchronization.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif  // __cplusplus
+
+// Client side of a remoting connection shared by all resources of a device.
+// Thread-safe: messages from multiple threads are serialized and each call
+// holds the connection until its reply has been received.
+typedef struct iree_hal_remoting_connection_t {
+  iree_allocator_t host_allocator;
+
+  // Guards all fields below.
+  iree_slim_mutex_t mutex;
+
+  // Transport to the server. Owned.
+  iree_hal_remoting_transport_t* transport IREE_GUARDED_BY(mutex);
+
+  // Next handle that has never been used.
+  iree_hal_remoting_handle_t next_handle IREE_GUARDED_BY(mutex);
+  // Handles that were released and can be reused.
+  iree_host_size_t free_handle_count IREE_GUARDED_BY(mutex);
+  iree_host_size_t free_handle_capacity IREE_GUARDED_BY(mutex);
+  iree_hal_remoting_handle_t* free_handles IREE_GUARDED_BY(mutex);
+} iree_hal_remoting_connection_t;
+
+// Initializes |out_connection| by performing the protocol handshake over
+// |transport|. Ownership of the transport is transferred to the connection
+// even on failure.
+iree_status_t iree_hal_remoting_connection_initialize(
+    iree_hal_remoting_transport_t* transport, iree_allocator_t host_allocator,
+    iree_hal_remoting_connection_t* out_connection);
+
+// Closes the connection. The server releases all resources that remain.
+void iree_hal_remoting_connection_deinitialize(
+    iree_hal_remoting_connection_t* connection);
+
+// Returns true if the server is on the same host and accepts shared memory.
+bool iree_hal_remoting_connection_is_local(
+    iree_hal_remoting_connection_t* connection);
+
+// Allocates a handle to name a new server-side resource.
+iree_status_t iree_hal_remoting_connection_allocate_handle(
+    iree_hal_remoting_connection_t* connection,
+    iree_hal_remoting_handle_t* out_handle);
+
+// Releases the server-side resource named by |handle| and recycles it.
+void iree_hal_remoting_connection_release_handle(
+    iree_hal_remoting_connection_t* connection,
+    iree_hal_remoting_handle_t handle);
+
+// Posts a message without waiting for it to be processed.
+// See iree_hal_remoting_transport_send for the meaning of |spans| and |fd|.
+iree_status_t iree_hal_remoting_connection_post(
+    iree_hal_remoting_connection_t* connection,
+    iree_hal_remoting_message_type_t type, iree_host_size_t span_count,
+    const iree_const_byte_span_t* spans, int fd);
+
+// Sends a message and waits for its reply. Result data of the reply is stored
+// in |result| and its length in |out_result_length| (if not NULL). Replies with
+// more result data than |result| can hold fail with IREE_STATUS_OUT_OF_RANGE.
+iree_status_t iree_hal_remoting_connection_call(
+    iree_hal_remoting_connection_t* connection,
+    iree_hal_remoting_message_type_t type, iree_host_size_t span_count,
+    const iree_const_byte_span_t* spans, int fd, iree_byte_span_t result,
+    iree_host_size_t* out_result_length);
+
+// Returns the number of bytes needed to pad |length| to
+// IREE_HAL_REMOTING_PAYLOAD_ALIGNMENT.
+static inline iree_host_size_t iree_hal_remoting_padding(
+    iree_host_size_t length) {
+  return iree_host_align(length, IREE_HAL_REMOTING_PAYLOAD_ALIGNMENT) - length;
+}
+
+// Returns a span of zeros used to pad payloads.
+iree_const_byte_span_t iree_hal_remoting_padding_span(iree_host_size_t length);
+
+#ifdef __cplusplus
+}  // extern "C"
+#endif  // __cplusplus
+
+#endif  // IREE_HAL_REMOTING_CONNECTION_H_
@@ -0,0 +1,258 @@
+// Copyright 2023 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include "experimental/remoting/executable.h"
+
+#include <stddef.h>
+#include <string.h>
+
+#include "experimental/remoting/pipeline_layout.h"
+#include "iree/base/api.h"
+#include "iree/base/tracing.h"
+
+//===----------------------------------------------------------------------===//
+// iree_hal_remoting_executable_t
+//===----------------------------------------------------------------------===//
+
+typedef struct iree_hal_remoting_executable_t {
+  iree_hal_resource_t resource;
+  iree_allocator_t host_allocator;
+  iree_hal_remoting_connection_t* connection;
+  iree_hal_remoting_handle_t handle;
+} iree_hal_remoting_executable_t;
+
+static const iree_hal_executable_vtable_t iree_hal_remoting_executable_vtable;
+
+static iree_hal_remoting_executable_t* iree_hal_remoting_executable_cast(
+    iree_hal_executable_t* base_value) {
+  IREE_HAL_ASSERT_TYPE(base_value, &iree_hal_remoting_executable_vtable);
+  return (iree_hal_remoting_executable_t*)base_value;
+}
+
+static iree_status_t iree_hal_remoting_executable_create(
+    iree_hal_remoting_connection_t* connection,
+    const iree_hal_executable_params_t* executable_params,
+    iree_allocator_t host_allocator, iree_hal_executable_t** out_executable) {
+  IREE_ASSERT_ARGUMENT(connection);
+  IREE_ASSERT_ARGUMENT(executable_params);
+  IREE_ASSERT_ARGUMENT(out_executable);
+  *out_executable = NULL;
+  IREE_TRACE_ZONE_BEGIN(z0);
+
+  const iree_host_size_t layouts_length =
+      executable_params->pipeline_layout_count *
+      sizeof(iree_hal_remoting_handle_t);
+  const iree_host_size_t constants_length =
+      executable_params->constant_count * sizeof(uint32_t);
+  const iree_host_size_t format_length =
+      executable_params->executable_format.size;
+  const iree_host_size_t data_length =
+      executable_params->executable_data.data_length;
+  const iree_host_size_t payload_length =
+      sizeof(iree_hal_remoting_executable_create_t) + layouts_length +
+      iree_hal_remoting_padding(layouts_length) + constants_length +
+      iree_hal_remoting_padding(constants_length) + format_length +
+      iree_hal_remoting_padding(format_length) + data_length;
+  if (payload_length > IREE_HAL_REMOTING_MAX_PAYLOAD_LENGTH) {
+    IREE_TRACE_ZONE_END(z0);
+    return iree_make_status(IREE_STATUS_OUT_OF_RANGE,
+                            "executable of %" PRIhsz
+                            " bytes exceeds the remoting message limit",
+                            data_length);
+  }
+
+  iree_hal_remoting_handle_t handle = IREE_HAL_REMOTING_HANDLE_NULL;
+  IREE_RETURN_AND_END_ZONE_IF_ERROR(
+      z0, iree_hal_remoting_connection_allocate_handle(connection, &handle));
+
+  const iree_hal_remoting_executable_create_t request = {
+      .executable = handle,
+      .caching_mode = executable_params->caching_mode,
+      .pipeline_layout_count =
+          (uint32_t)executable_params->pipeline_layout_count,
+      .constant_count = (uint32_t)executable_params->constant_count,
+      .format_length = (uint32_t)format_length,
+      .data_length = data_length,
+  };
+  iree_hal_remoting_handle_t* layout_handles =
+      (iree_hal_remoting_handle_t*)iree_alloca(layouts_length);
+  for (iree_host_size_t i = 0; i < executable_params->pipeline_layout_count;
+       ++i) {
+    layout_handles[i] = iree_hal_remoting_pipeline_layout_handle(
+        executable_params->pipeline_layouts[i]);
+  }
+  const iree_const_byte_span_t spans[8] = {
+      iree_make_const_byte_span(&request, sizeof(request)),
+      iree_make_const_byte_span(layout_handles, layouts_length),
+      iree_hal_remoting_padding_span(iree_hal_remoting_padding(layouts_length)),
+      iree_make_const_byte_span(executable_params->constants,
+                                constants_length),
+      iree_hal_remoting_padding_span(
+          iree_hal_remoting_padding(constants_length)),
+      iree_make_const_byte_span(executable_params->executable_format.data,
+                                format_length),
+      iree_hal_remoting_padding_span(iree_hal_remoting_padding(format_length)),
+      executable_params->executable_data,
+  };
+  iree_status_t status = iree_hal_remoting_connection_call(
+      connection, IREE_HAL_REMOTING_MESSAGE_EXECUTABLE_CREATE,
+      IREE_ARRAYSIZE(spans), spans, /*fd=*/-1, iree_byte_span_empty(),
+      /*out_result_length=*/NULL);
+
+  iree_hal_remoting_executable_t* executable = NULL;
+  if (iree_status_is_ok(status)) {
+    status = iree_allocator_malloc(host_allocator, sizeof(*executable),
+                                   (void**)&executable);
+    if (!iree_status_is_ok(status)) {
+      iree_hal_remoting_connection_release_handle(connection, handle);
+    }
+  }
+  if (iree_status_is_ok(status)) {
+    iree_hal_resource_initialize(&iree_hal_remoting_executable_vtable,
+                                 &executable->resource);
+    executable->host_allocator = host_allocator;
+    executable->connection = connection;
+    executable->handle = handle;
+    *out_executable = (iree_hal_executable_t*)executable;
+  }
+
+  IREE_TRACE_ZONE_END(z0);
+  return status;
+}
+
+static void iree_hal_remoting_executable_destroy(
+    iree_hal_executable_t* base_executable) {
+  iree_hal_remoting_executable_t* executable =
+      iree_hal_remoting_executable_cast(base_executable);
+  iree_allocator_t host_allocator = executable->host_allocator;
+  IREE_TRACE_ZONE_BEGIN(z0);
+
+  iree_hal_remoting_connection_release_handle(executable->connection,
+                                              executable->handle);
+  iree_allocator_free(host_allocator, executable);
+
+  IREE_TRACE_ZONE_END(z0);
+}
+
+iree_hal_remoting_handle_t iree_hal_remoting_executable_handle(
+    iree_hal_executable_t* base_executable) {
+  iree_hal_remoting_executable_t* executable =
+      iree_hal_remoting_executable_cast(base_executable);
+  return executable->handle;
+}
+
+static const iree_hal_executable_vtable_t iree_hal_remoting_executable_vtable =
+    {
+        .destroy = iree_hal_remoting_executable_destroy,
+};
+
+//===----------------------------------------------------------------------===//
+// iree_hal_remoting_executable_cache_t
+//===----------------------------------------------------------------------===//
+
+typedef struct iree_hal_remoting_executable_cache_t {
+  iree_hal_resource_t resource;
+  iree_allocator_t host_allocator;
+  iree_hal_remoting_connection_t* connection;
+} iree_hal_remoting_executable_cache_t;
+
+static const iree_hal_executable_cache_vtable_t
+    iree_hal_remoting_executable_cache_vtable;
+
+static iree_hal_remoting_executable_cache_t*
+iree_hal_remoting_executable_cache_cast(
+    iree_hal_executable_cache_t* base_value) {
+  IREE_HAL_ASSERT_TYPE(base_value, &iree_hal_remoting_executable_cache_vtable);
+  return (iree_hal_remoting_executable_cache_t*)base_value;
+}
+
+iree_status_t iree_hal_remoting_executable_cache_create(
+    iree_hal_remoting_connection_t* connection, iree_string_view_t identifier,
+    iree_allocator_t host_allocator,
+    iree_hal_executable_cache_t** out_executable_cache) {
+  IREE_ASSERT_ARGUMENT(connection);
+  IREE_ASSERT_ARGUMENT(out_executable_cache);
+  *out_executable_cache = NULL;
+  IREE_TRACE_ZONE_BEGIN(z0);
+
+  iree_hal_remoting_executable_cache_t* executable_cache = NULL;
+  iree_status_t status = iree_allocator_malloc(
+      host_allocator, sizeof(*executable_cache), (void**)&executable_cache);
+  if (iree_status_is_ok(status)) {
+    iree_hal_resource_initialize(&iree_hal_remoting_executable_cache_vtable,
+                                 &executable_cache->resource);
+    executable_cache->host_allocator = host_allocator;
+    executable_cache->connection = connection;
+    *out_executable_cache = (iree_hal_executable_cache_t*)executable_cache;
+  }
+
+  IREE_TRACE_ZONE_END(z0);
+  return status;
+}
+
+static void iree_hal_remoting_executable_cache_destroy(
+    iree_hal_executable_cache_t* base_executable_cache) {
+  iree_hal_remoting_executable_cache_t* executable_cache =
+      iree_hal_remoting_executable_cache_cast(base_executable_cache);
+  iree_allocator_t host_allocator = executable_cache->host_allocator;
+  IREE_TRACE_ZONE_BEGIN(z0);
+
+  iree_allocator_free(host_allocator, executable_cache);
+
+  IREE_TRACE_ZONE_END(z0);
+}
+
+static bool iree_hal_remoting_executable_cache_can_prepare_format(
+    iree_hal_executable_cache_t* base_executable_cache,
+    iree_hal_executable_caching_mode_t caching_mode,
+    iree_string_view_t executable_format) {
+  iree_hal_remoting_executable_cache_t* executable_cache =
+      iree_hal_remoting_executable_cache_cast(base_executable_cache);
+  const iree_hal_remoting_executable_format_query_t request = {
+      .caching_mode = caching_mode,
+      .format_length = (uint32_t)executable_format.size,
+  };
+  const iree_const_byte_span_t spans[3] = {
+      iree_make_const_byte_span(&request, sizeof(request)),
+      iree_make_const_byte_span(executable_format.data,
+                                executable_format.size),
+      iree_hal_remoting_padding_span(
+          iree_hal_remoting_padding(executable_format.size)),
+  };
+  uint32_t result = 0;
+  iree_status_t status = iree_hal_remoting_connection_call(
+      executable_cache->connection,
+      IREE_HAL_REMOTING_MESSAGE_EXECUTABLE_FORMAT_QUERY, IREE_ARRAYSIZE(spans),
+      spans, /*fd=*/-1, iree_make_byte_span(&result, sizeof(result)),
+      /*out_result_length=*/NULL);
+  // There is no way to report failures; a broken connection will fail the
+  // subsequent calls in any case.
+  if (!iree_status_is_ok(status)) {
+    iree_status_ignore(status);
+    return false;
+  }
+  return result != 0;
+}
+
+static iree_status_t iree_hal_remoting_executable_cache_prepare_executable(
+    iree_hal_executable_cache_t* base_executable_cache,
+    const iree_hal_executable_params_t* executable_params,
+    iree_hal_executable_t** out_executable) {
+  iree_hal_remoting_executable_cache_t* executable_cache =
+      iree_hal_remoting_executable_cache_cast(base_executable_cache);
+  return iree_hal_remoting_executable_create(
+      executable_cache->connection, executable_params,
+      executable_cache->host_allocator, out_executable);
+}
+
+static const iree_hal_executable_cache_vtable_t
+    iree_hal_remoting_executable_cache_vtable = {
+        .destroy = iree_hal_remoting_executable_cache_destroy,
+        .can_prepare_format =
+            iree_hal_remoting_executable_cache_can_prepare_format,
+        .prepare_executable =
+            iree_hal_remoting_executable_cache_prepare_executable,
+};
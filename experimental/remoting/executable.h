@@ -0,0 +1,44 @@
+// Copyright 2023 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#ifndef IREE_HAL_REMOTING_EXECUTABLE_H_
+#define IREE_HAL_REMOTING_EXECUTABLE_H_
+
+#include "experimental/remoting/connection.h"
+#include "iree/base/api.h"
+#include "iree/hal/api.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif  // __cplusplus
+
+//===----------------------------------------------------------------------===//
+// iree_hal_remoting_executable_cache_t
+//===----------------------------------------------------------------------===//
+
+// Creates an executable cache that prepares executables with the executable
+// cache of the server device. Executable data is sent to the server once per
+// prepared executable.
+//
+// |connection| is unretained as the device outlives the cache.
+iree_status_t iree_hal_remoting_executable_cache_create(
+    iree_hal_remoting_connection_t* connection, iree_string_view_t identifier,
+    iree_allocator_t host_allocator,
+    iree_hal_executable_cache_t** out_executable_cache);
+
+//===----------------------------------------------------------------------===//
+// iree_hal_remoting_executable_t
+//===----------------------------------------------------------------------===//
+
+// Returns the handle of the server executable backing |executable|.
+iree_hal_remoting_handle_t iree_hal_remoting_executable_handle(
+    iree_hal_executable_t* executable);
+
+#ifdef __cplusplus
+}  // extern "C"
+#endif  // __cplusplus
+
+#endif  // IREE_HAL_REMOTING_EXECUTABLE_H_
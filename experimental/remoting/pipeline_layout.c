@@ -0,0 +1,234 @@
+// Copyright 2023 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include "experimental/remoting/pipeline_layout.h"
+
+#include <stddef.h>
+#include <string.h>
+
+#include "iree/base/api.h"
+#include "iree/base/tracing.h"
+
+//===----------------------------------------------------------------------===//
+// iree_hal_remoting_descriptor_set_layout_t
+//===----------------------------------------------------------------------===//
+
+typedef struct iree_hal_remoting_descriptor_set_layout_t {
+  iree_hal_resource_t resource;
+  iree_allocator_t host_allocator;
+  iree_hal_remoting_connection_t* connection;
+  iree_hal_remoting_handle_t handle;
+} iree_hal_remoting_descriptor_set_layout_t;
+
+static const iree_hal_descriptor_set_layout_vtable_t
+    iree_hal_remoting_descriptor_set_layout_vtable;
+
+static iree_hal_remoting_descriptor_set_layout_t*
+iree_hal_remoting_descriptor_set_layout_cast(
+    iree_hal_descriptor_set_layout_t* base_value) {
+  IREE_HAL_ASSERT_TYPE(base_value,
+                       &iree_hal_remoting_descriptor_set_layout_vtable);
+  return (iree_hal_remoting_descriptor_set_layout_t*)base_value;
+}
+
+iree_status_t iree_hal_remoting_descriptor_set_layout_create(
+    iree_hal_remoting_connection_t* connection,
+    iree_hal_descriptor_set_layout_flags_t flags,
+    iree_host_size_t binding_count,
+    const iree_hal_descriptor_set_layout_binding_t* bindings,
+    iree_allocator_t host_allocator,
+    iree_hal_descriptor_set_layout_t** out_descriptor_set_layout) {
+  IREE_ASSERT_ARGUMENT(connection);
+  IREE_ASSERT_ARGUMENT(!binding_count || bindings);
+  IREE_ASSERT_ARGUMENT(out_descriptor_set_layout);
+  *out_descriptor_set_layout = NULL;
+  IREE_TRACE_ZONE_BEGIN(z0);
+
+  iree_hal_remoting_handle_t handle = IREE_HAL_REMOTING_HANDLE_NULL;
+  IREE_RETURN_AND_END_ZONE_IF_ERROR(
+      z0, iree_hal_remoting_connection_allocate_handle(connection, &handle));
+
+  const iree_hal_remoting_descriptor_set_layout_create_t request = {
+      .descriptor_set_layout = handle,
+      .flags = flags,
+      .binding_count = (uint32_t)binding_count,
+  };
+  iree_hal_remoting_descriptor_set_layout_binding_t* wire_bindings =
+      (iree_hal_remoting_descriptor_set_layout_binding_t*)iree_alloca(
+          binding_count * sizeof(*wire_bindings));
+  for (iree_host_size_t i = 0; i < binding_count; ++i) {
+    wire_bindings[i].binding = bindings[i].binding;
+    wire_bindings[i].type = bindings[i].type;
+    wire_bindings[i].flags = bindings[i].flags;
+    wire_bindings[i].reserved = 0;
+  }
+  const iree_const_byte_span_t spans[2] = {
+      iree_make_const_byte_span(&request, sizeof(request)),
+      iree_make_const_byte_span(wire_bindings,
+                                binding_count * sizeof(*wire_bindings)),
+  };
+  iree_status_t status = iree_hal_remoting_connection_call(
+      connection, IREE_HAL_REMOTING_MESSAGE_DESCRIPTOR_SET_LAYOUT_CREATE,
+      IREE_ARRAYSIZE(spans), spans, /*fd=*/-1, iree_byte_span_empty(),
+      /*out_result_length=*/NULL);
+
+  iree_hal_remoting_descriptor_set_layout_t* descriptor_set_layout = NULL;
+  if (iree_status_is_ok(status)) {
+    status = iree_allocator_malloc(host_allocator,
+                                   sizeof(*descriptor_set_layout),
+                                   (void**)&descriptor_set_layout);
+    if (!iree_status_is_ok(status)) {
+      iree_hal_remoting_connection_release_handle(connection, handle);
+    }
+  }
+  if (iree_status_is_ok(status)) {
+    iree_hal_resource_initialize(
+        &iree_hal_remoting_descriptor_set_layout_vtable,
+        &descriptor_set_layout->resource);
+    descriptor_set_layout->host_allocator = host_allocator;
+    descriptor_set_layout->connection = connection;
+    descriptor_set_layout->handle = handle;
+    *out_descriptor_set_layout =
+        (iree_hal_descriptor_set_layout_t*)descriptor_set_layout;
+  }
+
+  IREE_TRACE_ZONE_END(z0);
+  return status;
+}
+
+static void iree_hal_remoting_descriptor_set_layout_destroy(
+    iree_hal_descriptor_set_layout_t* base_descriptor_set_layout) {
+  iree_hal_remoting_descriptor_set_layout_t* descriptor_set_layout =
+      iree_hal_remoting_descriptor_set_layout_cast(base_descriptor_set_layout);
+  iree_allocator_t host_allocator = descriptor_set_layout->host_allocator;
+  IREE_TRACE_ZONE_BEGIN(z0);
+
+  iree_hal_remoting_connection_release_handle(
+      descriptor_set_layout->connection, descriptor_set_layout->handle);
+  iree_allocator_free(host_allocator, descriptor_set_layout);
+
+  IREE_TRACE_ZONE_END(z0);
+}
+
+iree_hal_remoting_handle_t iree_hal_remoting_descriptor_set_layout_handle(
+    iree_hal_descriptor_set_layout_t* base_descriptor_set_layout) {
+  iree_hal_remoting_descriptor_set_layout_t* descriptor_set_layout =
+      iree_hal_remoting_descriptor_set_layout_cast(base_descriptor_set_layout);
+  return descriptor_set_layout->handle;
+}
+
+static const iree_hal_descriptor_set_layout_vtable_t
+    iree_hal_remoting_descriptor_set_layout_vtable = {
+        .destroy = iree_hal_remoting_descriptor_set_layout_destroy,
+};
+
+//===----------------------------------------------------------------------===//
+// iree_hal_remoting_pipeline_layout_t
+//===----------------------------------------------------------------------===//
+
+typedef struct iree_hal_remoting_pipeline_layout_t {
+  iree_hal_resource_t resource;
+  iree_allocator_t host_allocator;
+  iree_hal_remoting_connection_t* connection;
+  iree_hal_remoting_handle_t handle;
+} iree_hal_remoting_pipeline_layout_t;
+
+static const iree_hal_pipeline_layout_vtable_t
+    iree_hal_remoting_pipeline_layout_vtable;
+
+static iree_hal_remoting_pipeline_layout_t*
+iree_hal_remoting_pipeline_layout_cast(iree_hal_pipeline_layout_t* base_value) {
+  IREE_HAL_ASSERT_TYPE(base_value, &iree_hal_remoting_pipeline_layout_vtable);
+  return (iree_hal_remoting_pipeline_layout_t*)base_value;
+}
+
+iree_status_t iree_hal_remoting_pipeline_layout_create(
+    iree_hal_remoting_connection_t* connection,
+    iree_host_size_t push_constants, iree_host_size_t set_layout_count,
+    iree_hal_descriptor_set_layout_t* const* set_layouts,
+    iree_allocator_t host_allocator,
+    iree_hal_pipeline_layout_t** out_pipeline_layout) {
+  IREE_ASSERT_ARGUMENT(connection);
+  IREE_ASSERT_ARGUMENT(!set_layout_count || set_layouts);
+  IREE_ASSERT_ARGUMENT(out_pipeline_layout);
+  *out_pipeline_layout = NULL;
+  IREE_TRACE_ZONE_BEGIN(z0);
+
+  iree_hal_remoting_handle_t handle = IREE_HAL_REMOTING_HANDLE_NULL;
+  IREE_RETURN_AND_END_ZONE_IF_ERROR(
+      z0, iree_hal_remoting_connection_allocate_handle(connection, &handle));
+
+  const iree_hal_remoting_pipeline_layout_create_t request = {
+      .pipeline_layout = handle,
+      .push_constants = (uint32_t)push_constants,
+      .set_layout_count = (uint32_t)set_layout_count,
+  };
+  iree_hal_remoting_handle_t* set_layout_handles =
+      (iree_hal_remoting_handle_t*)iree_alloca(set_layout_count *
+                                               sizeof(*set_layout_handles));
+  for (iree_host_size_t i = 0; i < set_layout_count; ++i) {
+    set_layout_handles[i] =
+        iree_hal_remoting_descriptor_set_layout_handle(set_layouts[i]);
+  }
+  const iree_host_size_t set_layout_handles_length =
+      set_layout_count * sizeof(*set_layout_handles);
+  const iree_const_byte_span_t spans[3] = {
+      iree_make_const_byte_span(&request, sizeof(request)),
+      iree_make_const_byte_span(set_layout_handles, set_layout_handles_length),
+      iree_hal_remoting_padding_span(
+          iree_hal_remoting_padding(set_layout_handles_length)),
+  };
+  iree_status_t status = iree_hal_remoting_connection_call(
+      connection, IREE_HAL_REMOTING_MESSAGE_PIPELINE_LAYOUT_CREATE,
+      IREE_ARRAYSIZE(spans), spans, /*fd=*/-1, iree_byte_span_empty(),
+      /*out_result_length=*/NULL);
+
+  iree_hal_remoting_pipeline_layout_t* pipeline_layout = NULL;
+  if (iree_status_is_ok(status)) {
+    status = iree_allocator_malloc(host_allocator, sizeof(*pipeline_layout),
+                                   (void**)&pipeline_layout);
+    if (!iree_status_is_ok(status)) {
+      iree_hal_remoting_connection_release_handle(connection, handle);
+    }
+  }
+  if (iree_status_is_ok(status)) {
+    iree_hal_resource_initialize(&iree_hal_remoting_pipeline_layout_vtable,
+                                 &pipeline_layout->resource);
+    pipeline_layout->host_allocator = host_allocator;
+    pipeline_layout->connection = connection;
+    pipeline_layout->handle = handle;
+    *out_pipeline_layout = (iree_hal_pipeline_layout_t*)pipeline_layout;
+  }
+
+  IREE_TRACE_ZONE_END(z0);
+  return status;
+}
+
+static void iree_hal_remoting_pipeline_layout_destroy(
+    iree_hal_pipeline_layout_t* base_pipeline_layout) {
+  iree_hal_remoting_pipeline_layout_t* pipeline_layout =
+      iree_hal_remoting_pipeline_layout_cast(base_pipeline_layout);
+  iree_allocator_t host_allocator = pipeline_layout->host_allocator;
+  IREE_TRACE_ZONE_BEGIN(z0);
+
+  iree_hal_remoting_connection_release_handle(pipeline_layout->connection,
+                                              pipeline_layout->handle);
+  iree_allocator_free(host_allocator, pipeline_layout);
+
+  IREE_TRACE_ZONE_END(z0);
+}
+
+iree_hal_remoting_handle_t iree_hal_remoting_pipeline_layout_handle(
+    iree_hal_pipeline_layout_t* base_pipeline_layout) {
+  iree_hal_remoting_pipeline_layout_t* pipeline_layout =
+      iree_hal_remoting_pipeline_layout_cast(base_pipeline_layout);
+  return pipeline_layout->handle;
+}
+
+static const iree_hal_pipeline_layout_vtable_t
+    iree_hal_remoting_pipeline_layout_vtable = {
+        .destroy = iree_hal_remoting_pipeline_layout_destroy,
+};
@@ -0,0 +1,57 @@
+// Copyright 2023 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#ifndef IREE_HAL_REMOTING_PIPELINE_LAYOUT_H_
+#define IREE_HAL_REMOTING_PIPELINE_LAYOUT_H_
+
+#include "experimental/remoting/connection.h"
+#include "iree/base/api.h"
+#include "iree/hal/api.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif  // __cplusplus
+
+//===----------------------------------------------------------------------===//
+// iree_hal_remoting_descriptor_set_layout_t
+//===----------------------------------------------------------------------===//
+
+// Creates a descriptor set layout on the server.
+// |connection| is unretained as the device outlives all layouts.
+iree_status_t iree_hal_remoting_descriptor_set_layout_create(
+    iree_hal_remoting_connection_t* connection,
+    iree_hal_descriptor_set_layout_flags_t flags,
+    iree_host_size_t binding_count,
+    const iree_hal_descriptor_set_layout_binding_t* bindings,
+    iree_allocator_t host_allocator,
+    iree_hal_descriptor_set_layout_t** out_descriptor_set_layout);
+
+// Returns the handle of the server layout backing |descriptor_set_layout|.
+iree_hal_remoting_handle_t iree_hal_remoting_descriptor_set_layout_handle(
+    iree_hal_descriptor_set_layout_t* descriptor_set_layout);
+
+//===----------------------------------------------------------------------===//
+// iree_hal_remoting_pipeline_layout_t
+//===----------------------------------------------------------------------===//
+
+// Creates a pipeline layout on the server from remoting |set_layouts|.
+// |connection| is unretained as the device outlives all layouts.
+iree_status_t iree_hal_remoting_pipeline_layout_create(
+    iree_hal_remoting_connection_t* connection,
+    iree_host_size_t push_constants, iree_host_size_t set_layout_count,
+    iree_hal_descriptor_set_layout_t* const* set_layouts,
+    iree_allocator_t host_allocator,
+    iree_hal_pipeline_layout_t** out_pipeline_layout);
+
+// Returns the handle of the server layout backing |pipeline_layout|.
+iree_hal_remoting_handle_t iree_hal_remoting_pipeline_layout_handle(
+    iree_hal_pipeline_layout_t* pipeline_layout);
+
+#ifdef __cplusplus
+}  // extern "C"
+#endif  // __cplusplus
+
+#endif  // IREE_HAL_REMOTING_PIPELINE_LAYOUT_H_
@@ -0,0 +1,442 @@
+// Copyright 2023 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+// Wire protocol spoken between the remoting HAL driver (the client) and a
+// remoting server that owns the real HAL device.
+//
+// Every message is a fixed-size header followed by |payload_length| bytes of
+// payload. Payloads start with a fixed-size body struct for the message type
+// that may be followed by trailing arrays and byte data. All structs are laid
+// out with natural alignment and padded to 8 bytes so that trailing arrays can
+// be accessed in place. Values are in host byte order: both sides must share
+// endianness (checked during the handshake).
+//
+// Client-side resources are named by handles the client allocates. The server
+// maps each handle to the real HAL resource. Handles are recycled by the
+// client after it posts a RELEASE and as messages are processed in order a
+// recycled handle never aliases a live resource.
+//
+// Messages flagged with IREE_HAL_REMOTING_MESSAGE_FLAG_REPLY are calls: the
+// server responds with a REPLY message carrying a status and result data.
+// Other messages are posted and the client does not wait on them. Failures of
+// posted queue operations are propagated through their signal semaphores;
+// failures of other posted messages are deferred and returned by the next
+// call made on the connection.
+
+#ifndef IREE_HAL_REMOTING_PROTOCOL_H_
+#define IREE_HAL_REMOTING_PROTOCOL_H_
+
+#include <stdint.h>
+
+#include "iree/base/api.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif  // __cplusplus
+
+// 'IREM' in little-endian byte order.
+#define IREE_HAL_REMOTING_PROTOCOL_MAGIC 0x4D455249u
+#define IREE_HAL_REMOTING_PROTOCOL_VERSION 1u
+
+// Alignment of payload bodies, trailing arrays, and commands.
+#define IREE_HAL_REMOTING_PAYLOAD_ALIGNMENT 8
+
+// Maximum size of a message payload. Larger buffer transfers are split into
+// multiple messages of at most IREE_HAL_REMOTING_MAX_TRANSFER_LENGTH bytes.
+#define IREE_HAL_REMOTING_MAX_PAYLOAD_LENGTH (256 * 1024 * 1024)
+#define IREE_HAL_REMOTING_MAX_TRANSFER_LENGTH (16 * 1024 * 1024)
+
+// Handle naming a resource on the server. 0 is reserved for NULL.
+typedef uint32_t iree_hal_remoting_handle_t;
+#define IREE_HAL_REMOTING_HANDLE_NULL 0u
+
+typedef enum iree_hal_remoting_message_type_e {
+  // Server→client response to a message flagged with a reply.
+  // Payload: iree_hal_remoting_reply_t.
+  IREE_HAL_REMOTING_MESSAGE_REPLY = 0,
+  // Call: iree_hal_remoting_hello_t.
+  IREE_HAL_REMOTING_MESSAGE_HELLO,
+  // Posted: iree_hal_remoting_release_t.
+  IREE_HAL_REMOTING_MESSAGE_RELEASE,
+  // Call: iree_hal_remoting_device_query_i64_t -> int64_t.
+  IREE_HAL_REMOTING_MESSAGE_DEVICE_QUERY_I64,
+  // Posted: no payload.
+  IREE_HAL_REMOTING_MESSAGE_DEVICE_TRIM,
+  // Call: iree_hal_remoting_buffer_allocate_t ->
+  //       iree_hal_remoting_buffer_allocate_result_t.
+  IREE_HAL_REMOTING_MESSAGE_BUFFER_ALLOCATE,
+  // Call: iree_hal_remoting_buffer_range_t -> bytes.
+  IREE_HAL_REMOTING_MESSAGE_BUFFER_READ,
+  // Posted: iree_hal_remoting_buffer_range_t + bytes.
+  IREE_HAL_REMOTING_MESSAGE_BUFFER_WRITE,
+  // Posted: iree_hal_remoting_semaphore_create_t.
+  IREE_HAL_REMOTING_MESSAGE_SEMAPHORE_CREATE,
+  // Call: iree_hal_remoting_semaphore_query_t -> uint64_t.
+  IREE_HAL_REMOTING_MESSAGE_SEMAPHORE_QUERY,
+  // Posted: iree_hal_remoting_semaphore_signal_t.
+  IREE_HAL_REMOTING_MESSAGE_SEMAPHORE_SIGNAL,
+  // Posted: iree_hal_remoting_semaphore_fail_t + message.
+  IREE_HAL_REMOTING_MESSAGE_SEMAPHORE_FAIL,
+  // Call: iree_hal_remoting_semaphore_wait_t + semaphores.
+  IREE_HAL_REMOTING_MESSAGE_SEMAPHORE_WAIT,
+  // Call: iree_hal_remoting_descriptor_set_layout_create_t + bindings.
+  IREE_HAL_REMOTING_MESSAGE_DESCRIPTOR_SET_LAYOUT_CREATE,
+  // Call: iree_hal_remoting_pipeline_layout_create_t + set layouts.
+  IREE_HAL_REMOTING_MESSAGE_PIPELINE_LAYOUT_CREATE,
+  // Call: iree_hal_remoting_executable_format_query_t + format -> uint32_t.
+  IREE_HAL_REMOTING_MESSAGE_EXECUTABLE_FORMAT_QUERY,
+  // Call: iree_hal_remoting_executable_create_t + trailing data.
+  IREE_HAL_REMOTING_MESSAGE_EXECUTABLE_CREATE,
+  // Posted: iree_hal_remoting_command_buffer_create_t + commands.
+  IREE_HAL_REMOTING_MESSAGE_COMMAND_BUFFER_CREATE,
+  // Posted: iree_hal_remoting_queue_alloca_t + semaphores.
+  IREE_HAL_REMOTING_MESSAGE_QUEUE_ALLOCA,
+  // Posted: iree_hal_remoting_queue_dealloca_t + semaphores.
+  IREE_HAL_REMOTING_MESSAGE_QUEUE_DEALLOCA,
+  // Posted: iree_hal_remoting_queue_execute_t + semaphores + command buffers.
+  IREE_HAL_REMOTING_MESSAGE_QUEUE_EXECUTE,
+  IREE_HAL_REMOTING_MESSAGE_TYPE_COUNT,
+} iree_hal_remoting_message_type_t;
+
+enum iree_hal_remoting_message_flag_bits_t {
+  IREE_HAL_REMOTING_MESSAGE_FLAG_NONE = 0u,
+  // The sender is waiting for a REPLY message.
+  IREE_HAL_REMOTING_MESSAGE_FLAG_REPLY = 1u << 0,
+  // A file descriptor is passed along with the message (local transports).
+  IREE_HAL_REMOTING_MESSAGE_FLAG_FD = 1u << 1,
+};
+typedef uint16_t iree_hal_remoting_message_flags_t;
+
+typedef struct iree_hal_remoting_message_header_t {
+  // Length of the payload following the header in bytes.
+  uint32_t payload_length;
+  // iree_hal_remoting_message_type_t.
+  uint16_t type;
+  // iree_hal_remoting_message_flags_t.
+  uint16_t flags;
+} iree_hal_remoting_message_header_t;
+
+//===----------------------------------------------------------------------===//
+// Common structures
+//===----------------------------------------------------------------------===//
+
+// Followed by |message_length| characters of the status message padded to
+// IREE_HAL_REMOTING_PAYLOAD_ALIGNMENT and then the result data.
+typedef struct iree_hal_remoting_reply_t {
+  // iree_status_code_t of the call.
+  uint32_t status_code;
+  uint32_t message_length;
+} iree_hal_remoting_reply_t;
+
+typedef struct iree_hal_remoting_semaphore_value_t {
+  iree_hal_remoting_handle_t semaphore;
+  uint32_t reserved;
+  uint64_t value;
+} iree_hal_remoting_semaphore_value_t;
+
+typedef struct iree_hal_remoting_buffer_params_t {
+  uint32_t usage;
+  uint16_t access;
+  uint16_t reserved0;
+  uint32_t type;
+  uint32_t reserved1;
+  uint64_t queue_affinity;
+  uint64_t min_alignment;
+} iree_hal_remoting_buffer_params_t;
+
+// Common prefix of queue operations. Followed by |wait_count| and then
+// |signal_count| iree_hal_remoting_semaphore_value_t after the operation body.
+typedef struct iree_hal_remoting_queue_header_t {
+  uint64_t queue_affinity;
+  uint32_t wait_count;
+  uint32_t signal_count;
+} iree_hal_remoting_queue_header_t;
+
+//===----------------------------------------------------------------------===//
+// Messages
+//===----------------------------------------------------------------------===//
+
+typedef struct iree_hal_remoting_hello_t {
+  uint32_t magic;
+  uint32_t version;
+} iree_hal_remoting_hello_t;
+
+typedef struct iree_hal_remoting_release_t {
+  iree_hal_remoting_handle_t handle;
+  uint32_t reserved;
+} iree_hal_remoting_release_t;
+
+// Followed by the category and then key characters.
+typedef struct iree_hal_remoting_device_query_i64_t {
+  uint32_t category_length;
+  uint32_t key_length;
+} iree_hal_remoting_device_query_i64_t;
+
+// If flagged with IREE_HAL_REMOTING_MESSAGE_FLAG_FD the passed descriptor is a
+// shared memory object of |allocation_size| bytes that backs the buffer.
+typedef struct iree_hal_remoting_buffer_allocate_t {
+  iree_hal_remoting_handle_t buffer;
+  uint32_t reserved;
+  iree_hal_remoting_buffer_params_t params;
+  uint64_t allocation_size;
+} iree_hal_remoting_buffer_allocate_t;
+
+// Properties of the allocated buffer that may differ from those requested.
+typedef struct iree_hal_remoting_buffer_allocate_result_t {
+  uint32_t memory_type;
+  uint32_t allowed_usage;
+  uint16_t allowed_access;
+  uint16_t reserved0;
+  uint32_t reserved1;
+} iree_hal_remoting_buffer_allocate_result_t;
+
+// Range relative to the start of the allocation.
+typedef struct iree_hal_remoting_buffer_range_t {
+  iree_hal_remoting_handle_t buffer;
+  uint32_t reserved;
+  uint64_t offset;
+  uint64_t length;
+} iree_hal_remoting_buffer_range_t;
+
+typedef struct iree_hal_remoting_semaphore_create_t {
+  iree_hal_remoting_handle_t semaphore;
+  uint32_t reserved;
+  uint64_t initial_value;
+} iree_hal_remoting_semaphore_create_t;
+
+typedef struct iree_hal_remoting_semaphore_query_t {
+  iree_hal_remoting_handle_t semaphore;
+  uint32_t reserved;
+} iree_hal_remoting_semaphore_query_t;
+
+typedef struct iree_hal_remoting_semaphore_signal_t {
+  iree_hal_remoting_handle_t semaphore;
+  uint32_t reserved;
+  uint64_t value;
+} iree_hal_remoting_semaphore_signal_t;
+
+// Followed by |message_length| characters.
+typedef struct iree_hal_remoting_semaphore_fail_t {
+  iree_hal_remoting_handle_t semaphore;
+  uint32_t status_code;
+  uint32_t message_length;
+  uint32_t reserved;
+} iree_hal_remoting_semaphore_fail_t;
+
+// Followed by |count| iree_hal_remoting_semaphore_value_t.
+// The server waits at most |timeout_ns| and clients are expected to wait in
+// short slices so that other calls on the connection are not starved.
+typedef struct iree_hal_remoting_semaphore_wait_t {
+  uint32_t wait_mode;
+  uint32_t count;
+  int64_t timeout_ns;
+} iree_hal_remoting_semaphore_wait_t;
+
+typedef struct iree_hal_remoting_descriptor_set_layout_binding_t {
+  uint32_t binding;
+  uint32_t type;
+  uint32_t flags;
+  uint32_t reserved;
+} iree_hal_remoting_descriptor_set_layout_binding_t;
+
+// Followed by |binding_count|
+// iree_hal_remoting_descriptor_set_layout_binding_t.
+typedef struct iree_hal_remoting_descriptor_set_layout_create_t {
+  iree_hal_remoting_handle_t descriptor_set_layout;
+  uint32_t flags;
+  uint32_t binding_count;
+  uint32_t reserved;
+} iree_hal_remoting_descriptor_set_layout_create_t;
+
+// Followed by |set_layout_count| handles padded to 8 bytes.
+typedef struct iree_hal_remoting_pipeline_layout_create_t {
+  iree_hal_remoting_handle_t pipeline_layout;
+  uint32_t push_constants;
+  uint32_t set_layout_count;
+  uint32_t reserved;
+} iree_hal_remoting_pipeline_layout_create_t;
+
+// Followed by |format_length| characters.
+typedef struct iree_hal_remoting_executable_format_query_t {
+  uint32_t caching_mode;
+  uint32_t format_length;
+} iree_hal_remoting_executable_format_query_t;
+
+// Followed by the |pipeline_layout_count| handles and |constant_count|
+// constants (each list padded to 8 bytes), |format_length| characters padded to
+// 8 bytes, and then |data_length| bytes of executable data.
+typedef struct iree_hal_remoting_executable_create_t {
+  iree_hal_remoting_handle_t executable;
+  uint32_t caching_mode;
+  uint32_t pipeline_layout_count;
+  uint32_t constant_count;
+  uint32_t format_length;
+  uint32_t reserved;
+  uint64_t data_length;
+} iree_hal_remoting_executable_create_t;
+
+// Followed by |commands_length| bytes of iree_hal_remoting_command_header_t
+// prefixed commands.
+typedef struct iree_hal_remoting_command_buffer_create_t {
+  iree_hal_remoting_handle_t command_buffer;
+  uint32_t mode;
+  uint32_t command_categories;
+  uint32_t reserved;
+  uint64_t queue_affinity;
+  uint64_t commands_length;
+} iree_hal_remoting_command_buffer_create_t;
+
+typedef struct iree_hal_remoting_queue_alloca_t {
+  iree_hal_remoting_queue_header_t queue;
+  iree_hal_remoting_handle_t buffer;
+  uint32_t pool;
+  iree_hal_remoting_buffer_params_t params;
+  uint64_t allocation_size;
+} iree_hal_remoting_queue_alloca_t;
+
+typedef struct iree_hal_remoting_queue_dealloca_t {
+  iree_hal_remoting_queue_header_t queue;
+  iree_hal_remoting_handle_t buffer;
+  uint32_t reserved;
+} iree_hal_remoting_queue_dealloca_t;
+
+// Followed by the semaphores and then |command_buffer_count| handles.
+typedef struct iree_hal_remoting_queue_execute_t {
+  iree_hal_remoting_queue_header_t queue;
+  uint32_t command_buffer_count;
+  uint32_t reserved;
+} iree_hal_remoting_queue_execute_t;
+
+//===----------------------------------------------------------------------===//
+// Commands
+//===----------------------------------------------------------------------===//
+
+typedef enum iree_hal_remoting_command_type_e {
+  IREE_HAL_REMOTING_COMMAND_EXECUTION_BARRIER = 0,
+  IREE_HAL_REMOTING_COMMAND_DISCARD_BUFFER,
+  IREE_HAL_REMOTING_COMMAND_FILL_BUFFER,
+  IREE_HAL_REMOTING_COMMAND_UPDATE_BUFFER,
+  IREE_HAL_REMOTING_COMMAND_COPY_BUFFER,
+  IREE_HAL_REMOTING_COMMAND_PUSH_CONSTANTS,
+  IREE_HAL_REMOTING_COMMAND_PUSH_DESCRIPTOR_SET,
+  IREE_HAL_REMOTING_COMMAND_DISPATCH,
+  IREE_HAL_REMOTING_COMMAND_DISPATCH_INDIRECT,
+  IREE_HAL_REMOTING_COMMAND_BEGIN_DEBUG_GROUP,
+  IREE_HAL_REMOTING_COMMAND_END_DEBUG_GROUP,
+} iree_hal_remoting_command_type_t;
+
+// Prefixes every command in a command buffer.
+typedef struct iree_hal_remoting_command_header_t {
+  // iree_hal_remoting_command_type_t.
+  uint32_t type;
+  // Total length of the command including the header padded to
+  // IREE_HAL_REMOTING_PAYLOAD_ALIGNMENT.
+  uint32_t length;
+} iree_hal_remoting_command_header_t;
+
+// Memory and buffer barriers are not transmitted; the server issues a full
+// barrier between the given stages.
+typedef struct iree_hal_remoting_execution_barrier_cmd_t {
+  iree_hal_remoting_command_header_t header;
+  uint32_t source_stage_mask;
+  uint32_t target_stage_mask;
+  uint32_t flags;
+  uint32_t reserved;
+} iree_hal_remoting_execution_barrier_cmd_t;
+
+typedef struct iree_hal_remoting_discard_buffer_cmd_t {
+  iree_hal_remoting_command_header_t header;
+  iree_hal_remoting_handle_t buffer;
+  uint32_t reserved;
+} iree_hal_remoting_discard_buffer_cmd_t;
+
+typedef struct iree_hal_remoting_fill_buffer_cmd_t {
+  iree_hal_remoting_command_header_t header;
+  iree_hal_remoting_handle_t target_buffer;
+  uint32_t pattern_length;
+  uint64_t target_offset;
+  uint64_t length;
+  uint64_t pattern;
+} iree_hal_remoting_fill_buffer_cmd_t;
+
+// Followed by |length| bytes of source data.
+typedef struct iree_hal_remoting_update_buffer_cmd_t {
+  iree_hal_remoting_command_header_t header;
+  iree_hal_remoting_handle_t target_buffer;
+  uint32_t reserved;
+  uint64_t target_offset;
+  uint64_t length;
+} iree_hal_remoting_update_buffer_cmd_t;
+
+typedef struct iree_hal_remoting_copy_buffer_cmd_t {
+  iree_hal_remoting_command_header_t header;
+  iree_hal_remoting_handle_t source_buffer;
+  iree_hal_remoting_handle_t target_buffer;
+  uint64_t source_offset;
+  uint64_t target_offset;
+  uint64_t length;
+} iree_hal_remoting_copy_buffer_cmd_t;
+
+// Followed by |values_length| bytes of constant data.
+typedef struct iree_hal_remoting_push_constants_cmd_t {
+  iree_hal_remoting_command_header_t header;
+  iree_hal_remoting_handle_t pipeline_layout;
+  uint32_t offset;
+  uint32_t values_length;
+  uint32_t reserved;
+} iree_hal_remoting_push_constants_cmd_t;
+
+typedef struct iree_hal_remoting_descriptor_set_binding_t {
+  uint32_t binding;
+  iree_hal_remoting_handle_t buffer;
+  uint64_t offset;
+  uint64_t length;
+} iree_hal_remoting_descriptor_set_binding_t;
+
+// Followed by |binding_count| iree_hal_remoting_descriptor_set_binding_t.
+typedef struct iree_hal_remoting_push_descriptor_set_cmd_t {
+  iree_hal_remoting_command_header_t header;
+  iree_hal_remoting_handle_t pipeline_layout;
+  uint32_t set;
+  uint32_t binding_count;
+  uint32_t reserved;
+} iree_hal_remoting_push_descriptor_set_cmd_t;
+
+typedef struct iree_hal_remoting_dispatch_cmd_t {
+  iree_hal_remoting_command_header_t header;
+  iree_hal_remoting_handle_t executable;
+  int32_t entry_point;
+  uint32_t workgroup_x;
+  uint32_t workgroup_y;
+  uint32_t workgroup_z;
+  uint32_t reserved;
+} iree_hal_remoting_dispatch_cmd_t;
+
+typedef struct iree_hal_remoting_dispatch_indirect_cmd_t {
+  iree_hal_remoting_command_header_t header;
+  iree_hal_remoting_handle_t executable;
+  int32_t entry_point;
+  iree_hal_remoting_handle_t workgroups_buffer;
+  uint32_t reserved;
+  uint64_t workgroups_offset;
+} iree_hal_remoting_dispatch_indirect_cmd_t;
+
+// Followed by |label_length| characters.
+typedef struct iree_hal_remoting_begin_debug_group_cmd_t {
+  iree_hal_remoting_command_header_t header;
+  uint32_t label_color;
+  uint32_t label_length;
+} iree_hal_remoting_begin_debug_group_cmd_t;
+
+typedef struct iree_hal_remoting_end_debug_group_cmd_t {
+  iree_hal_remoting_command_header_t header;
+} iree_hal_remoting_end_debug_group_cmd_t;
+
+#ifdef __cplusplus
+}  // extern "C"
+#endif  // __cplusplus
+
+#endif  // IREE_HAL_REMOTING_PROTOCOL_H_
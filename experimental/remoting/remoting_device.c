@@ -0,0 +1,578 @@
+// Copyright 2023 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include "experimental/remoting/remoting_device.h"
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "experimental/remoting/allocator.h"
+#include "experimental/remoting/buffer.h"
+#include "experimental/remoting/command_buffer.h"
+#include "experimental/remoting/connection.h"
+#include "experimental/remoting/executable.h"
+#include "experimental/remoting/pipeline_layout.h"
+#include "experimental/remoting/semaphore.h"
+#include "iree/base/internal/arena.h"
+#include "iree/base/tracing.h"
+#include "iree/hal/utils/buffer_transfer.h"
+
+//===----------------------------------------------------------------------===//
+// iree_hal_remoting_device_t
+//===----------------------------------------------------------------------===//
+
+typedef struct iree_hal_remoting_device_t {
+  iree_hal_resource_t resource;
+  iree_string_view_t identifier;
+  iree_allocator_t host_allocator;
+
+  // Block pool used for command buffer resource sets.
+  iree_arena_block_pool_t block_pool;
+
+  // Optional driver that created the device. We retain it for our lifetime to
+  // ensure any shared state remains valid.
+  iree_hal_driver_t* driver;
+
+  // Connection to the server shared by all resources of the device.
+  iree_hal_remoting_connection_t connection;
+
+  iree_hal_allocator_t* device_allocator;
+} iree_hal_remoting_device_t;
+
+static const iree_hal_device_vtable_t iree_hal_remoting_device_vtable;
+
+static iree_hal_remoting_device_t* iree_hal_remoting_device_cast(
+    iree_hal_device_t* base_value) {
+  IREE_HAL_ASSERT_TYPE(base_value, &iree_hal_remoting_device_vtable);
+  return (iree_hal_remoting_device_t*)base_value;
+}
+
+static void iree_hal_remoting_device_destroy(iree_hal_device_t* base_device) {
+  iree_hal_remoting_device_t* device =
+      iree_hal_remoting_device_cast(base_device);
+  iree_allocator_t host_allocator = device->host_allocator;
+  IREE_TRACE_ZONE_BEGIN(z0);
+
+  // There should be no more buffers live that use the allocator.
+  iree_hal_allocator_release(device->device_allocator);
+
+  // Closing the connection releases everything that remains on the server.
+  if (device->connection.transport) {
+    iree_hal_remoting_connection_deinitialize(&device->connection);
+  }
+  iree_arena_block_pool_deinitialize(&device->block_pool);
+
+  // Finally, destroy the device.
+  iree_hal_driver_release(device->driver);
+
+  iree_allocator_free(host_allocator, device);
+
+  IREE_TRACE_ZONE_END(z0);
+}
+
+iree_status_t iree_hal_remoting_device_create_with_driver(
+    iree_hal_driver_t* driver, iree_string_view_t identifier,
+    iree_hal_remoting_transport_t* transport, iree_allocator_t host_allocator,
+    iree_hal_device_t** out_device) {
+  IREE_ASSERT_ARGUMENT(transport);
+  IREE_ASSERT_ARGUMENT(out_device);
+  *out_device = NULL;
+  IREE_TRACE_ZONE_BEGIN(z0);
+
+  iree_hal_remoting_device_t* device = NULL;
+  iree_host_size_t total_size = sizeof(*device) + identifier.size;
+  iree_status_t status =
+      iree_allocator_malloc(host_allocator, total_size, (void**)&device);
+  if (!iree_status_is_ok(status)) {
+    iree_hal_remoting_transport_destroy(transport);
+    IREE_TRACE_ZONE_END(z0);
+    return status;
+  }
+  memset(device, 0, total_size);
+  iree_hal_resource_initialize(&iree_hal_remoting_device_vtable,
+                               &device->resource);
+  iree_string_view_append_to_buffer(identifier, &device->identifier,
+                                    (char*)device + sizeof(*device));
+  device->host_allocator = host_allocator;
+  iree_arena_block_pool_initialize(32 * 1024, host_allocator,
+                                   &device->block_pool);
+  device->driver = driver;
+  iree_hal_driver_retain(device->driver);
+
+  status = iree_hal_remoting_connection_initialize(transport, host_allocator,
+                                                   &device->connection);
+  if (iree_status_is_ok(status)) {
+    status = iree_hal_remoting_allocator_create(
+        (iree_hal_device_t*)device, &device->connection, host_allocator,
+        &device->device_allocator);
+  }
+
+  if (iree_status_is_ok(status)) {
+    *out_device = (iree_hal_device_t*)device;
+  } else {
+    iree_hal_device_release((iree_hal_device_t*)device);
+  }
+  IREE_TRACE_ZONE_END(z0);
+  return status;
+}
+
+IREE_API_EXPORT iree_status_t iree_hal_remoting_device_create(
+    iree_string_view_t identifier, iree_hal_remoting_transport_t* transport,
+    iree_allocator_t host_allocator, iree_hal_device_t** out_device) {
+  return iree_hal_remoting_device_create_with_driver(
+      /*driver=*/NULL, identifier, transport, host_allocator, out_device);
+}
+
+static iree_string_view_t iree_hal_remoting_device_id(
+    iree_hal_device_t* base_device) {
+  iree_hal_remoting_device_t* device =
+      iree_hal_remoting_device_cast(base_device);
+  return device->identifier;
+}
+
+static iree_allocator_t iree_hal_remoting_device_host_allocator(
+    iree_hal_device_t* base_device) {
+  iree_hal_remoting_device_t* device =
+      iree_hal_remoting_device_cast(base_device);
+  return device->host_allocator;
+}
+
+static iree_hal_allocator_t* iree_hal_remoting_device_allocator(
+    iree_hal_device_t* base_device) {
+  iree_hal_remoting_device_t* device =
+      iree_hal_remoting_device_cast(base_device);
+  return device->device_allocator;
+}
+
+static iree_status_t iree_hal_remoting_device_trim(
+    iree_hal_device_t* base_device) {
+  iree_hal_remoting_device_t* device =
+      iree_hal_remoting_device_cast(base_device);
+  iree_arena_block_pool_trim(&device->block_pool);
+  IREE_RETURN_IF_ERROR(iree_hal_allocator_trim(device->device_allocator));
+  return iree_hal_remoting_connection_post(
+      &device->connection, IREE_HAL_REMOTING_MESSAGE_DEVICE_TRIM,
+      /*span_count=*/0, /*spans=*/NULL, /*fd=*/-1);
+}
+
+static iree_status_t iree_hal_remoting_device_query_i64(
+    iree_hal_device_t* base_device, iree_string_view_t category,
+    iree_string_view_t key, int64_t* out_value) {
+  iree_hal_remoting_device_t* device =
+      iree_hal_remoting_device_cast(base_device);
+  *out_value = 0;
+  // All device properties are those of the server device.
+  const iree_hal_remoting_device_query_i64_t request = {
+      .category_length = (uint32_t)category.size,
+      .key_length = (uint32_t)key.size,
+  };
+  const iree_const_byte_span_t spans[4] = {
+      iree_make_const_byte_span(&request, sizeof(request)),
+      iree_make_const_byte_span(category.data, category.size),
+      iree_make_const_byte_span(key.data, key.size),
+      iree_hal_remoting_padding_span(
+          iree_hal_remoting_padding(category.size + key.size)),
+  };
+  return iree_hal_remoting_connection_call(
+      &device->connection, IREE_HAL_REMOTING_MESSAGE_DEVICE_QUERY_I64,
+      IREE_ARRAYSIZE(spans), spans, /*fd=*/-1,
+      iree_make_byte_span(out_value, sizeof(*out_value)),
+      /*out_result_length=*/NULL);
+}
+
+static iree_status_t iree_hal_remoting_device_create_channel(
+    iree_hal_device_t* base_device, iree_hal_queue_affinity_t queue_affinity,
+    iree_hal_channel_params_t params, iree_hal_channel_t** out_channel) {
+  return iree_make_status(IREE_STATUS_UNIMPLEMENTED,
+                          "collectives not implemented");
+}
+
+static iree_status_t iree_hal_remoting_device_create_command_buffer(
+    iree_hal_device_t* base_device, iree_hal_command_buffer_mode_t mode,
+    iree_hal_command_category_t command_categories,
+    iree_hal_queue_affinity_t queue_affinity, iree_host_size_t binding_capacity,
+    iree_hal_command_buffer_t** out_command_buffer) {
+  iree_hal_remoting_device_t* device =
+      iree_hal_remoting_device_cast(base_device);
+  return iree_hal_remoting_command_buffer_create(
+      base_device, &device->connection, mode, command_categories,
+      queue_affinity, binding_capacity, &device->block_pool,
+      device->host_allocator, out_command_buffer);
+}
+
+static iree_status_t iree_hal_remoting_device_create_descriptor_set_layout(
+    iree_hal_device_t* base_device,
+    iree_hal_descriptor_set_layout_flags_t flags,
+    iree_host_size_t binding_count,
+    const iree_hal_descriptor_set_layout_binding_t* bindings,
+    iree_hal_descriptor_set_layout_t** out_descriptor_set_layout) {
+  iree_hal_remoting_device_t* device =
+      iree_hal_remoting_device_cast(base_device);
+  return iree_hal_remoting_descriptor_set_layout_create(
+      &device->connection, flags, binding_count, bindings,
+      device->host_allocator, out_descriptor_set_layout);
+}
+
+static iree_status_t iree_hal_remoting_device_create_event(
+    iree_hal_device_t* base_device, iree_hal_event_t** out_event) {
+  return iree_make_status(IREE_STATUS_UNIMPLEMENTED,
+                          "events not implemented");
+}
+
+static iree_status_t iree_hal_remoting_device_create_executable_cache(
+    iree_hal_device_t* base_device, iree_string_view_t identifier,
+    iree_loop_t loop, iree_hal_executable_cache_t** out_executable_cache) {
+  iree_hal_remoting_device_t* device =
+      iree_hal_remoting_device_cast(base_device);
+  return iree_hal_remoting_executable_cache_create(
+      &device->connection, identifier, device->host_allocator,
+      out_executable_cache);
+}
+
+static iree_status_t iree_hal_remoting_device_create_pipeline_layout(
+    iree_hal_device_t* base_device, iree_host_size_t push_constants,
+    iree_host_size_t set_layout_count,
+    iree_hal_descriptor_set_layout_t* const* set_layouts,
+    iree_hal_pipeline_layout_t** out_pipeline_layout) {
+  iree_hal_remoting_device_t* device =
+      iree_hal_remoting_device_cast(base_device);
+  return iree_hal_remoting_pipeline_layout_create(
+      &device->connection, push_constants, set_layout_count, set_layouts,
+      device->host_allocator, out_pipeline_layout);
+}
+
+static iree_status_t iree_hal_remoting_device_create_semaphore(
+    iree_hal_device_t* base_device, uint64_t initial_value,
+    iree_hal_semaphore_t** out_semaphore) {
+  iree_hal_remoting_device_t* device =
+      iree_hal_remoting_device_cast(base_device);
+  return iree_hal_remoting_semaphore_create(&device->connection, initial_value,
+                                            device->host_allocator,
+                                            out_semaphore);
+}
+
+static iree_hal_semaphore_compatibility_t
+iree_hal_remoting_device_query_semaphore_compatibility(
+    iree_hal_device_t* base_device, iree_hal_semaphore_t* semaphore) {
+  if (iree_hal_remoting_semaphore_isa(semaphore)) {
+    return IREE_HAL_SEMAPHORE_COMPATIBILITY_ALL;
+  }
+  // Other semaphores are waited on by the host before work is posted.
+  return IREE_HAL_SEMAPHORE_COMPATIBILITY_HOST_WAIT;
+}
+
+static iree_status_t iree_hal_remoting_device_transfer_range(
+    iree_hal_device_t* base_device, iree_hal_transfer_buffer_t source,
+    iree_device_size_t source_offset, iree_hal_transfer_buffer_t target,
+    iree_device_size_t target_offset, iree_device_size_t data_length,
+    iree_hal_transfer_buffer_flags_t flags, iree_timeout_t timeout) {
+  iree_hal_remoting_device_t* device =
+      iree_hal_remoting_device_cast(base_device);
+  if (data_length == 0) return iree_ok_status();
+
+  // Device-to-device transfers stay on the server.
+  if (source.device_buffer && target.device_buffer) {
+    return iree_hal_device_submit_transfer_range_and_wait(
+        base_device, source, source_offset, target, target_offset, data_length,
+        flags, timeout);
+  }
+  IREE_TRACE_ZONE_BEGIN(z0);
+
+  // Host transfers go directly to shared memory when available or to the
+  // server as buffer reads and writes.
+  iree_status_t status = iree_ok_status();
+  iree_hal_remoting_handle_t handle = IREE_HAL_REMOTING_HANDLE_NULL;
+  iree_device_size_t offset = 0;
+  if (target.device_buffer) {
+    status = iree_hal_remoting_buffer_resolve(target.device_buffer,
+                                              target_offset, &handle, &offset);
+    uint8_t* shared_ptr =
+        (uint8_t*)iree_hal_remoting_buffer_shared_pointer(target.device_buffer);
+    const uint8_t* source_ptr = source.host_buffer.data + source_offset;
+    if (iree_status_is_ok(status) && shared_ptr) {
+      memcpy(shared_ptr + offset, source_ptr, (size_t)data_length);
+    } else if (iree_status_is_ok(status)) {
+      status = iree_hal_remoting_buffer_write(&device->connection, handle,
+                                              offset, source_ptr, data_length);
+    }
+  } else {
+    status = iree_hal_remoting_buffer_resolve(source.device_buffer,
+                                              source_offset, &handle, &offset);
+    uint8_t* shared_ptr =
+        (uint8_t*)iree_hal_remoting_buffer_shared_pointer(source.device_buffer);
+    uint8_t* target_ptr = target.host_buffer.data + target_offset;
+    if (iree_status_is_ok(status) && shared_ptr) {
+      memcpy(target_ptr, shared_ptr + offset, (size_t)data_length);
+    } else if (iree_status_is_ok(status)) {
+      status = iree_hal_remoting_buffer_read(&device->connection, handle,
+                                             offset, target_ptr, data_length);
+    }
+  }
+
+  IREE_TRACE_ZONE_END(z0);
+  return status;
+}
+
+// Populates the common prefix of a queue operation and the semaphore values
+// that follow the operation body. Wait semaphores from other devices are
+// waited on by the host and omitted. |out_values| must have capacity for all
+// wait and signal semaphores.
+static iree_status_t iree_hal_remoting_device_prepare_queue_operation(
+    iree_hal_queue_affinity_t queue_affinity,
+    const iree_hal_semaphore_list_t wait_semaphore_list,
+    const iree_hal_semaphore_list_t signal_semaphore_list,
+    iree_hal_remoting_queue_header_t* out_header,
+    iree_hal_remoting_semaphore_value_t* out_values) {
+  memset(out_header, 0, sizeof(*out_header));
+  out_header->queue_affinity = queue_affinity;
+  iree_host_size_t value_count = 0;
+  for (iree_host_size_t i = 0; i < wait_semaphore_list.count; ++i) {
+    iree_hal_semaphore_t* semaphore = wait_semaphore_list.semaphores[i];
+    const uint64_t value = wait_semaphore_list.payload_values[i];
+    if (!iree_hal_remoting_semaphore_isa(semaphore)) {
+      IREE_RETURN_IF_ERROR(
+          iree_hal_semaphore_wait(semaphore, value, iree_infinite_timeout()));
+      continue;
+    }
+    iree_hal_remoting_semaphore_value_t* entry = &out_values[value_count++];
+    entry->semaphore = iree_hal_remoting_semaphore_handle(semaphore);
+    entry->reserved = 0;
+    entry->value = value;
+  }
+  out_header->wait_count = (uint32_t)value_count;
+  for (iree_host_size_t i = 0; i < signal_semaphore_list.count; ++i) {
+    iree_hal_semaphore_t* semaphore = signal_semaphore_list.semaphores[i];
+    if (!iree_hal_remoting_semaphore_isa(semaphore)) {
+      return iree_make_status(IREE_STATUS_INVALID_ARGUMENT,
+                              "remoting queues can only signal remoting "
+                              "semaphores");
+    }
+    iree_hal_remoting_semaphore_value_t* entry = &out_values[value_count++];
+    entry->semaphore = iree_hal_remoting_semaphore_handle(semaphore);
+    entry->reserved = 0;
+    entry->value = signal_semaphore_list.payload_values[i];
+  }
+  out_header->signal_count = (uint32_t)signal_semaphore_list.count;
+  return iree_ok_status();
+}
+
+static iree_status_t iree_hal_remoting_device_queue_alloca(
+    iree_hal_device_t* base_device, iree_hal_queue_affinity_t queue_affinity,
+    const iree_hal_semaphore_list_t wait_semaphore_list,
+    const iree_hal_semaphore_list_t signal_semaphore_list,
+    iree_hal_allocator_pool_t pool, iree_hal_buffer_params_t params,
+    iree_device_size_t allocation_size,
+    iree_hal_buffer_t** IREE_RESTRICT out_buffer) {
+  iree_hal_remoting_device_t* device =
+      iree_hal_remoting_device_cast(base_device);
+  *out_buffer = NULL;
+  IREE_TRACE_ZONE_BEGIN(z0);
+
+  iree_hal_remoting_queue_alloca_t request;
+  memset(&request, 0, sizeof(request));
+  iree_hal_remoting_semaphore_value_t* values =
+      (iree_hal_remoting_semaphore_value_t*)iree_alloca(
+          (wait_semaphore_list.count + signal_semaphore_list.count) *
+          sizeof(*values));
+  IREE_RETURN_AND_END_ZONE_IF_ERROR(
+      z0, iree_hal_remoting_device_prepare_queue_operation(
+              queue_affinity, wait_semaphore_list, signal_semaphore_list,
+              &request.queue, values));
+  IREE_RETURN_AND_END_ZONE_IF_ERROR(
+      z0, iree_hal_remoting_connection_allocate_handle(&device->connection,
+                                                       &request.buffer));
+  request.pool = pool;
+  iree_hal_remoting_buffer_params_pack(&params, &request.params);
+  request.allocation_size = allocation_size;
+
+  // The buffer is usable immediately as the server defines the handle when
+  // the message is processed, before any later message can reference it.
+  // Queue-ordered allocations are never placed in shared memory.
+  iree_hal_buffer_t* buffer = NULL;
+  iree_status_t status = iree_hal_remoting_buffer_wrap(
+      &device->connection, /*allocator=*/NULL, device->host_allocator,
+      params.type, params.access, params.usage, allocation_size,
+      request.buffer, /*shared_ptr=*/NULL, &buffer);
+  if (iree_status_is_ok(status)) {
+    const iree_const_byte_span_t spans[2] = {
+        iree_make_const_byte_span(&request, sizeof(request)),
+        iree_make_const_byte_span(
+            values, (request.queue.wait_count + request.queue.signal_count) *
+                        sizeof(*values)),
+    };
+    status = iree_hal_remoting_connection_post(
+        &device->connection, IREE_HAL_REMOTING_MESSAGE_QUEUE_ALLOCA,
+        IREE_ARRAYSIZE(spans), spans, /*fd=*/-1);
+  } else {
+    iree_hal_remoting_connection_release_handle(&device->connection,
+                                                request.buffer);
+  }
+
+  if (iree_status_is_ok(status)) {
+    *out_buffer = buffer;
+  } else {
+    iree_hal_buffer_release(buffer);
+  }
+  IREE_TRACE_ZONE_END(z0);
+  return status;
+}
+
+static iree_status_t iree_hal_remoting_device_queue_dealloca(
+    iree_hal_device_t* base_device, iree_hal_queue_affinity_t queue_affinity,
+    const iree_hal_semaphore_list_t wait_semaphore_list,
+    const iree_hal_semaphore_list_t signal_semaphore_list,
+    iree_hal_buffer_t* buffer) {
+  iree_hal_remoting_device_t* device =
+      iree_hal_remoting_device_cast(base_device);
+  IREE_TRACE_ZONE_BEGIN(z0);
+
+  iree_hal_remoting_queue_dealloca_t request;
+  memset(&request, 0, sizeof(request));
+  iree_device_size_t offset = 0;
+  IREE_RETURN_AND_END_ZONE_IF_ERROR(
+      z0, iree_hal_remoting_buffer_resolve(buffer, 0, &request.buffer,
+                                           &offset));
+  iree_hal_remoting_semaphore_value_t* values =
+      (iree_hal_remoting_semaphore_value_t*)iree_alloca(
+          (wait_semaphore_list.count + signal_semaphore_list.count) *
+          sizeof(*values));
+  IREE_RETURN_AND_END_ZONE_IF_ERROR(
+      z0, iree_hal_remoting_device_prepare_queue_operation(
+              queue_affinity, wait_semaphore_list, signal_semaphore_list,
+              &request.queue, values));
+  const iree_const_byte_span_t spans[2] = {
+      iree_make_const_byte_span(&request, sizeof(request)),
+      iree_make_const_byte_span(
+          values, (request.queue.wait_count + request.queue.signal_count) *
+                      sizeof(*values)),
+  };
+  iree_status_t status = iree_hal_remoting_connection_post(
+      &device->connection, IREE_HAL_REMOTING_MESSAGE_QUEUE_DEALLOCA,
+      IREE_ARRAYSIZE(spans), spans, /*fd=*/-1);
+
+  IREE_TRACE_ZONE_END(z0);
+  return status;
+}
+
+static iree_status_t iree_hal_remoting_device_queue_execute(
+    iree_hal_device_t* base_device, iree_hal_queue_affinity_t queue_affinity,
+    const iree_hal_semaphore_list_t wait_semaphore_list,
+    const iree_hal_semaphore_list_t signal_semaphore_list,
+    iree_host_size_t command_buffer_count,
+    iree_hal_command_buffer_t* const* command_buffers) {
+  iree_hal_remoting_device_t* device =
+      iree_hal_remoting_device_cast(base_device);
+  IREE_TRACE_ZONE_BEGIN(z0);
+
+  iree_hal_remoting_handle_t* command_buffer_handles =
+      (iree_hal_remoting_handle_t*)iree_alloca(
+          command_buffer_count * sizeof(*command_buffer_handles));
+  for (iree_host_size_t i = 0; i < command_buffer_count; ++i) {
+    if (!iree_hal_remoting_command_buffer_isa(command_buffers[i])) {
+      IREE_TRACE_ZONE_END(z0);
+      return iree_make_status(IREE_STATUS_INVALID_ARGUMENT,
+                              "command buffer %" PRIhsz
+                              " was not created by a remoting device",
+                              i);
+    }
+    command_buffer_handles[i] =
+        iree_hal_remoting_command_buffer_handle(command_buffers[i]);
+  }
+
+  iree_hal_remoting_queue_execute_t request;
+  memset(&request, 0, sizeof(request));
+  request.command_buffer_count = (uint32_t)command_buffer_count;
+  iree_hal_remoting_semaphore_value_t* values =
+      (iree_hal_remoting_semaphore_value_t*)iree_alloca(
+          (wait_semaphore_list.count + signal_semaphore_list.count) *
+          sizeof(*values));
+  IREE_RETURN_AND_END_ZONE_IF_ERROR(
+      z0, iree_hal_remoting_device_prepare_queue_operation(
+              queue_affinity, wait_semaphore_list, signal_semaphore_list,
+              &request.queue, values));
+
+  // The entire submission is a single message; the command buffers
+  // themselves were sent when they were recorded.
+  const iree_host_size_t handles_length =
+      command_buffer_count * sizeof(*command_buffer_handles);
+  const iree_const_byte_span_t spans[4] = {
+      iree_make_const_byte_span(&request, sizeof(request)),
+      iree_make_const_byte_span(
+          values, (request.queue.wait_count + request.queue.signal_count) *
+                      sizeof(*values)),
+      iree_make_const_byte_span(command_buffer_handles, handles_length),
+      iree_hal_remoting_padding_span(iree_hal_remoting_padding(handles_length)),
+  };
+  iree_status_t status = iree_hal_remoting_connection_post(
+      &device->connection, IREE_HAL_REMOTING_MESSAGE_QUEUE_EXECUTE,
+      IREE_ARRAYSIZE(spans), spans, /*fd=*/-1);
+
+  IREE_TRACE_ZONE_END(z0);
+  return status;
+}
+
+static iree_status_t iree_hal_remoting_device_queue_flush(
+    iree_hal_device_t* base_device, iree_hal_queue_affinity_t queue_affinity) {
+  // Currently unused; messages are sent as operations are issued.
+  return iree_ok_status();
+}
+
+static iree_status_t iree_hal_remoting_device_wait_semaphores(
+    iree_hal_device_t* base_device, iree_hal_wait_mode_t wait_mode,
+    const iree_hal_semaphore_list_t semaphore_list, iree_timeout_t timeout) {
+  iree_hal_remoting_device_t* device =
+      iree_hal_remoting_device_cast(base_device);
+  for (iree_host_size_t i = 0; i < semaphore_list.count; ++i) {
+    if (!iree_hal_remoting_semaphore_isa(semaphore_list.semaphores[i])) {
+      return iree_make_status(IREE_STATUS_INVALID_ARGUMENT,
+                              "remoting devices can only wait on remoting "
+                              "semaphores");
+    }
+  }
+  return iree_hal_remoting_semaphore_multi_wait(
+      &device->connection, wait_mode, semaphore_list, timeout);
+}
+
+static iree_status_t iree_hal_remoting_device_profiling_begin(
+    iree_hal_device_t* base_device,
+    const iree_hal_device_profiling_options_t* options) {
+  // Unimplemented (and that's ok). Profile the server instead.
+  return iree_ok_status();
+}
+
+static iree_status_t iree_hal_remoting_device_profiling_end(
+    iree_hal_device_t* base_device) {
+  // Unimplemented (and that's ok).
+  return iree_ok_status();
+}
+
+static const iree_hal_device_vtable_t iree_hal_remoting_device_vtable = {
+    .destroy = iree_hal_remoting_device_destroy,
+    .id = iree_hal_remoting_device_id,
+    .host_allocator = iree_hal_remoting_device_host_allocator,
+    .device_allocator = iree_hal_remoting_device_allocator,
+    .trim = iree_hal_remoting_device_trim,
+    .query_i64 = iree_hal_remoting_device_query_i64,
+    .create_channel = iree_hal_remoting_device_create_channel,
+    .create_command_buffer = iree_hal_remoting_device_create_command_buffer,
+    .create_descriptor_set_layout =
+        iree_hal_remoting_device_create_descriptor_set_layout,
+    .create_event = iree_hal_remoting_device_create_event,
+    .create_executable_cache = iree_hal_remoting_device_create_executable_cache,
+    .create_pipeline_layout = iree_hal_remoting_device_create_pipeline_layout,
+    .create_semaphore = iree_hal_remoting_device_create_semaphore,
+    .query_semaphore_compatibility =
+        iree_hal_remoting_device_query_semaphore_compatibility,
+    .transfer_range = iree_hal_remoting_device_transfer_range,
+    .queue_alloca = iree_hal_remoting_device_queue_alloca,
+    .queue_dealloca = iree_hal_remoting_device_queue_dealloca,
+    .queue_execute = iree_hal_remoting_device_queue_execute,
+    .queue_flush = iree_hal_remoting_device_queue_flush,
+    .wait_semaphores = iree_hal_remoting_device_wait_semaphores,
+    .profiling_begin = iree_hal_remoting_device_profiling_begin,
+    .profiling_end = iree_hal_remoting_device_profiling_end,
+};
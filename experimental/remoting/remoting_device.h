@@ -0,0 +1,30 @@
+// Copyright 2023 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#ifndef IREE_HAL_REMOTING_REMOTING_DEVICE_H_
+#define IREE_HAL_REMOTING_REMOTING_DEVICE_H_
+
+#include "experimental/remoting/api.h"
+#include "iree/base/api.h"
+#include "iree/hal/api.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif  // __cplusplus
+
+// Creates a device connected to a remoting server over |transport|.
+// Ownership of the transport is transferred to the device even on failure.
+// |driver| is optional and retained if given.
+iree_status_t iree_hal_remoting_device_create_with_driver(
+    iree_hal_driver_t* driver, iree_string_view_t identifier,
+    iree_hal_remoting_transport_t* transport, iree_allocator_t host_allocator,
+    iree_hal_device_t** out_device);
+
+#ifdef __cplusplus
+}  // extern "C"
+#endif  // __cplusplus
+
+#endif  // IREE_HAL_REMOTING_REMOTING_DEVICE_H_
@@ -0,0 +1,164 @@
+// Copyright 2023 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include <inttypes.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "experimental/remoting/api.h"
+#include "experimental/remoting/remoting_device.h"
+#include "iree/base/api.h"
+#include "iree/base/tracing.h"
+#include "iree/hal/api.h"
+
+typedef struct iree_hal_remoting_driver_t {
+  iree_hal_resource_t resource;
+  iree_allocator_t host_allocator;
+  // Identifier used for the driver in the IREE driver registry.
+  iree_string_view_t identifier;
+  // Endpoint of the default device; stored after the identifier.
+  iree_string_view_t default_endpoint;
+} iree_hal_remoting_driver_t;
+
+// The only device enumerated is the one at the default endpoint.
+#define IREE_HAL_REMOTING_DEFAULT_DEVICE_ID 1
+
+static const iree_hal_driver_vtable_t iree_hal_remoting_driver_vtable;
+
+static iree_hal_remoting_driver_t* iree_hal_remoting_driver_cast(
+    iree_hal_driver_t* base_value) {
+  IREE_HAL_ASSERT_TYPE(base_value, &iree_hal_remoting_driver_vtable);
+  return (iree_hal_remoting_driver_t*)base_value;
+}
+
+IREE_API_EXPORT void iree_hal_remoting_driver_options_initialize(
+    iree_hal_remoting_driver_options_t* out_options) {
+  memset(out_options, 0, sizeof(*out_options));
+}
+
+IREE_API_EXPORT iree_status_t iree_hal_remoting_driver_create(
+    iree_string_view_t identifier,
+    const iree_hal_remoting_driver_options_t* options,
+    iree_allocator_t host_allocator, iree_hal_driver_t** out_driver) {
+  IREE_ASSERT_ARGUMENT(options);
+  IREE_ASSERT_ARGUMENT(out_driver);
+  *out_driver = NULL;
+  IREE_TRACE_ZONE_BEGIN(z0);
+
+  iree_hal_remoting_driver_t* driver = NULL;
+  iree_host_size_t total_size =
+      sizeof(*driver) + identifier.size + options->default_endpoint.size;
+  IREE_RETURN_AND_END_ZONE_IF_ERROR(
+      z0, iree_allocator_malloc(host_allocator, total_size, (void**)&driver));
+  iree_hal_resource_initialize(&iree_hal_remoting_driver_vtable,
+                               &driver->resource);
+  driver->host_allocator = host_allocator;
+  char* string_storage = (char*)driver + sizeof(*driver);
+  string_storage += iree_string_view_append_to_buffer(
+      identifier, &driver->identifier, string_storage);
+  iree_string_view_append_to_buffer(options->default_endpoint,
+                                    &driver->default_endpoint, string_storage);
+  *out_driver = (iree_hal_driver_t*)driver;
+
+  IREE_TRACE_ZONE_END(z0);
+  return iree_ok_status();
+}
+
+static void iree_hal_remoting_driver_destroy(iree_hal_driver_t* base_driver) {
+  iree_hal_remoting_driver_t* driver =
+      iree_hal_remoting_driver_cast(base_driver);
+  iree_allocator_t host_allocator = driver->host_allocator;
+  IREE_TRACE_ZONE_BEGIN(z0);
+
+  iree_allocator_free(host_allocator, driver);
+
+  IREE_TRACE_ZONE_END(z0);
+}
+
+static iree_status_t iree_hal_remoting_driver_query_available_devices(
+    iree_hal_driver_t* base_driver, iree_allocator_t host_allocator,
+    iree_host_size_t* out_device_info_count,
+    iree_hal_device_info_t** out_device_infos) {
+  iree_hal_remoting_driver_t* driver =
+      iree_hal_remoting_driver_cast(base_driver);
+  *out_device_info_count = 0;
+  *out_device_infos = NULL;
+  // Servers cannot be discovered; only the configured one is reported.
+  if (iree_string_view_is_empty(driver->default_endpoint)) {
+    return iree_ok_status();
+  }
+  iree_hal_device_info_t* device_info = NULL;
+  iree_host_size_t total_size =
+      sizeof(*device_info) + driver->default_endpoint.size;
+  IREE_RETURN_IF_ERROR(iree_allocator_malloc(host_allocator, total_size,
+                                             (void**)&device_info));
+  memset(device_info, 0, sizeof(*device_info));
+  device_info->device_id = IREE_HAL_REMOTING_DEFAULT_DEVICE_ID;
+  iree_string_view_append_to_buffer(
+      driver->default_endpoint, &device_info->path,
+      (char*)device_info + sizeof(*device_info));
+  device_info->name = device_info->path;
+  *out_device_info_count = 1;
+  *out_device_infos = device_info;
+  return iree_ok_status();
+}
+
+static iree_status_t iree_hal_remoting_driver_dump_device_info(
+    iree_hal_driver_t* base_driver, iree_hal_device_id_t device_id,
+    iree_string_builder_t* builder) {
+  // Device properties are only known once connected.
+  return iree_ok_status();
+}
+
+static iree_status_t iree_hal_remoting_driver_create_device_by_path(
+    iree_hal_driver_t* base_driver, iree_string_view_t driver_name,
+    iree_string_view_t device_path, iree_host_size_t param_count,
+    const iree_string_pair_t* params, iree_allocator_t host_allocator,
+    iree_hal_device_t** out_device) {
+  iree_hal_remoting_driver_t* driver =
+      iree_hal_remoting_driver_cast(base_driver);
+  if (iree_string_view_is_empty(device_path)) {
+    device_path = driver->default_endpoint;
+  }
+  if (iree_string_view_is_empty(device_path)) {
+    return iree_make_status(IREE_STATUS_INVALID_ARGUMENT,
+                            "remoting devices must be created with the server "
+                            "endpoint as the path (`remoting://tcp:host:port`) "
+                            "or a default endpoint");
+  }
+  IREE_TRACE_ZONE_BEGIN(z0);
+  iree_hal_remoting_transport_t* transport = NULL;
+  IREE_RETURN_AND_END_ZONE_IF_ERROR(
+      z0, iree_hal_remoting_transport_connect(device_path, host_allocator,
+                                              &transport));
+  iree_status_t status = iree_hal_remoting_device_create_with_driver(
+      base_driver, driver->identifier, transport, host_allocator, out_device);
+  IREE_TRACE_ZONE_END(z0);
+  return status;
+}
+
+static iree_status_t iree_hal_remoting_driver_create_device_by_id(
+    iree_hal_driver_t* base_driver, iree_hal_device_id_t device_id,
+    iree_host_size_t param_count, const iree_string_pair_t* params,
+    iree_allocator_t host_allocator, iree_hal_device_t** out_device) {
+  if (device_id != IREE_HAL_DEVICE_ID_DEFAULT &&
+      device_id != IREE_HAL_REMOTING_DEFAULT_DEVICE_ID) {
+    return iree_make_status(IREE_STATUS_NOT_FOUND,
+                            "remoting device %" PRIu64 " not found",
+                            (uint64_t)device_id);
+  }
+  return iree_hal_remoting_driver_create_device_by_path(
+      base_driver, iree_string_view_empty(), iree_string_view_empty(),
+      param_count, params, host_allocator, out_device);
+}
+
+static const iree_hal_driver_vtable_t iree_hal_remoting_driver_vtable = {
+    .destroy = iree_hal_remoting_driver_destroy,
+    .query_available_devices = iree_hal_remoting_driver_query_available_devices,
+    .dump_device_info = iree_hal_remoting_driver_dump_device_info,
+    .create_device_by_id = iree_hal_remoting_driver_create_device_by_id,
+    .create_device_by_path = iree_hal_remoting_driver_create_device_by_path,
+};
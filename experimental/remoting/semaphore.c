@@ -0,0 +1,237 @@
+// Copyright 2023 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include "experimental/remoting/semaphore.h"
+
+#include <stddef.h>
+#include <string.h>
+
+#include "iree/base/api.h"
+#include "iree/base/tracing.h"
+#include "iree/hal/utils/semaphore_base.h"
+
+// Longest time the server is asked to block in a single wait call. Bounds how
+// long other threads using the connection are stalled by a waiter.
+#define IREE_HAL_REMOTING_SEMAPHORE_WAIT_SLICE_NS (10 * 1000000ll)
+
+typedef struct iree_hal_remoting_semaphore_t {
+  iree_hal_semaphore_t base;
+  iree_allocator_t host_allocator;
+  iree_hal_remoting_connection_t* connection;
+  iree_hal_remoting_handle_t handle;
+} iree_hal_remoting_semaphore_t;
+
+static const iree_hal_semaphore_vtable_t iree_hal_remoting_semaphore_vtable;
+
+static iree_hal_remoting_semaphore_t* iree_hal_remoting_semaphore_cast(
+    iree_hal_semaphore_t* base_value) {
+  IREE_HAL_ASSERT_TYPE(base_value, &iree_hal_remoting_semaphore_vtable);
+  return (iree_hal_remoting_semaphore_t*)base_value;
+}
+
+iree_status_t iree_hal_remoting_semaphore_create(
+    iree_hal_remoting_connection_t* connection, uint64_t initial_value,
+    iree_allocator_t host_allocator, iree_hal_semaphore_t** out_semaphore) {
+  IREE_ASSERT_ARGUMENT(connection);
+  IREE_ASSERT_ARGUMENT(out_semaphore);
+  *out_semaphore = NULL;
+  IREE_TRACE_ZONE_BEGIN(z0);
+
+  iree_hal_remoting_handle_t handle = IREE_HAL_REMOTING_HANDLE_NULL;
+  IREE_RETURN_AND_END_ZONE_IF_ERROR(
+      z0, iree_hal_remoting_connection_allocate_handle(connection, &handle));
+  const iree_hal_remoting_semaphore_create_t request = {
+      .semaphore = handle,
+      .initial_value = initial_value,
+  };
+  const iree_const_byte_span_t spans[1] = {
+      iree_make_const_byte_span(&request, sizeof(request)),
+  };
+  iree_status_t status = iree_hal_remoting_connection_post(
+      connection, IREE_HAL_REMOTING_MESSAGE_SEMAPHORE_CREATE,
+      IREE_ARRAYSIZE(spans), spans, /*fd=*/-1);
+
+  iree_hal_remoting_semaphore_t* semaphore = NULL;
+  if (iree_status_is_ok(status)) {
+    status = iree_allocator_malloc(host_allocator, sizeof(*semaphore),
+                                   (void**)&semaphore);
+  }
+  if (iree_status_is_ok(status)) {
+    iree_hal_semaphore_initialize(&iree_hal_remoting_semaphore_vtable,
+                                  &semaphore->base);
+    semaphore->host_allocator = host_allocator;
+    semaphore->connection = connection;
+    semaphore->handle = handle;
+    *out_semaphore = &semaphore->base;
+  } else {
+    iree_hal_remoting_connection_release_handle(connection, handle);
+  }
+
+  IREE_TRACE_ZONE_END(z0);
+  return status;
+}
+
+static void iree_hal_remoting_semaphore_destroy(
+    iree_hal_semaphore_t* base_semaphore) {
+  iree_hal_remoting_semaphore_t* semaphore =
+      iree_hal_remoting_semaphore_cast(base_semaphore);
+  iree_allocator_t host_allocator = semaphore->host_allocator;
+  IREE_TRACE_ZONE_BEGIN(z0);
+
+  iree_hal_remoting_connection_release_handle(semaphore->connection,
+                                              semaphore->handle);
+  iree_hal_semaphore_deinitialize(&semaphore->base);
+  iree_allocator_free(host_allocator, semaphore);
+
+  IREE_TRACE_ZONE_END(z0);
+}
+
+bool iree_hal_remoting_semaphore_isa(iree_hal_semaphore_t* semaphore) {
+  return iree_hal_resource_is(semaphore, &iree_hal_remoting_semaphore_vtable);
+}
+
+iree_hal_remoting_handle_t iree_hal_remoting_semaphore_handle(
+    iree_hal_semaphore_t* base_semaphore) {
+  iree_hal_remoting_semaphore_t* semaphore =
+      iree_hal_remoting_semaphore_cast(base_semaphore);
+  return semaphore->handle;
+}
+
+static iree_status_t iree_hal_remoting_semaphore_query(
+    iree_hal_semaphore_t* base_semaphore, uint64_t* out_value) {
+  iree_hal_remoting_semaphore_t* semaphore =
+      iree_hal_remoting_semaphore_cast(base_semaphore);
+  *out_value = 0;
+  const iree_hal_remoting_semaphore_query_t request = {
+      .semaphore = semaphore->handle,
+  };
+  const iree_const_byte_span_t spans[1] = {
+      iree_make_const_byte_span(&request, sizeof(request)),
+  };
+  // Failed semaphores reply with their failure status.
+  return iree_hal_remoting_connection_call(
+      semaphore->connection, IREE_HAL_REMOTING_MESSAGE_SEMAPHORE_QUERY,
+      IREE_ARRAYSIZE(spans), spans, /*fd=*/-1,
+      iree_make_byte_span(out_value, sizeof(*out_value)),
+      /*out_result_length=*/NULL);
+}
+
+static iree_status_t iree_hal_remoting_semaphore_signal(
+    iree_hal_semaphore_t* base_semaphore, uint64_t new_value) {
+  iree_hal_remoting_semaphore_t* semaphore =
+      iree_hal_remoting_semaphore_cast(base_semaphore);
+  const iree_hal_remoting_semaphore_signal_t request = {
+      .semaphore = semaphore->handle,
+      .value = new_value,
+  };
+  const iree_const_byte_span_t spans[1] = {
+      iree_make_const_byte_span(&request, sizeof(request)),
+  };
+  return iree_hal_remoting_connection_post(
+      semaphore->connection, IREE_HAL_REMOTING_MESSAGE_SEMAPHORE_SIGNAL,
+      IREE_ARRAYSIZE(spans), spans, /*fd=*/-1);
+}
+
+static void iree_hal_remoting_semaphore_fail(
+    iree_hal_semaphore_t* base_semaphore, iree_status_t status) {
+  iree_hal_remoting_semaphore_t* semaphore =
+      iree_hal_remoting_semaphore_cast(base_semaphore);
+
+  // Only the message is transmitted; payloads like stack traces stay local.
+  char* message = NULL;
+  iree_host_size_t message_length = 0;
+  if (!iree_status_to_string(status, &semaphore->host_allocator, &message,
+                             &message_length)) {
+    message = NULL;
+    message_length = 0;
+  }
+  const iree_hal_remoting_semaphore_fail_t request = {
+      .semaphore = semaphore->handle,
+      .status_code = iree_status_code(status),
+      .message_length = (uint32_t)message_length,
+  };
+  const iree_const_byte_span_t spans[3] = {
+      iree_make_const_byte_span(&request, sizeof(request)),
+      iree_make_const_byte_span(message, message_length),
+      iree_hal_remoting_padding_span(iree_hal_remoting_padding(message_length)),
+  };
+  iree_status_ignore(iree_hal_remoting_connection_post(
+      semaphore->connection, IREE_HAL_REMOTING_MESSAGE_SEMAPHORE_FAIL,
+      IREE_ARRAYSIZE(spans), spans, /*fd=*/-1));
+  iree_allocator_free(semaphore->host_allocator, message);
+  iree_status_ignore(status);
+}
+
+iree_status_t iree_hal_remoting_semaphore_multi_wait(
+    iree_hal_remoting_connection_t* connection, iree_hal_wait_mode_t wait_mode,
+    const iree_hal_semaphore_list_t semaphore_list, iree_timeout_t timeout) {
+  if (semaphore_list.count == 0) return iree_ok_status();
+  IREE_TRACE_ZONE_BEGIN(z0);
+
+  iree_hal_remoting_semaphore_value_t* values =
+      (iree_hal_remoting_semaphore_value_t*)iree_alloca(
+          semaphore_list.count * sizeof(*values));
+  for (iree_host_size_t i = 0; i < semaphore_list.count; ++i) {
+    values[i].semaphore =
+        iree_hal_remoting_semaphore_handle(semaphore_list.semaphores[i]);
+    values[i].reserved = 0;
+    values[i].value = semaphore_list.payload_values[i];
+  }
+  iree_hal_remoting_semaphore_wait_t request = {
+      .wait_mode = wait_mode,
+      .count = (uint32_t)semaphore_list.count,
+  };
+  const iree_const_byte_span_t spans[2] = {
+      iree_make_const_byte_span(&request, sizeof(request)),
+      iree_make_const_byte_span(values, semaphore_list.count * sizeof(*values)),
+  };
+
+  const iree_time_t deadline_ns = iree_timeout_as_deadline_ns(timeout);
+  iree_status_t status = iree_ok_status();
+  do {
+    const iree_time_t now_ns = iree_time_now();
+    request.timeout_ns =
+        deadline_ns == IREE_TIME_INFINITE_FUTURE
+            ? IREE_HAL_REMOTING_SEMAPHORE_WAIT_SLICE_NS
+            : iree_min(iree_max(deadline_ns - now_ns, 0),
+                       IREE_HAL_REMOTING_SEMAPHORE_WAIT_SLICE_NS);
+    status = iree_hal_remoting_connection_call(
+        connection, IREE_HAL_REMOTING_MESSAGE_SEMAPHORE_WAIT,
+        IREE_ARRAYSIZE(spans), spans, /*fd=*/-1, iree_byte_span_empty(),
+        /*out_result_length=*/NULL);
+    if (!iree_status_is_deadline_exceeded(status)) break;
+    if (deadline_ns != IREE_TIME_INFINITE_FUTURE &&
+        iree_time_now() >= deadline_ns) {
+      break;
+    }
+    status = iree_status_ignore(status);
+  } while (true);
+
+  IREE_TRACE_ZONE_END(z0);
+  return status;
+}
+
+static iree_status_t iree_hal_remoting_semaphore_wait(
+    iree_hal_semaphore_t* base_semaphore, uint64_t value,
+    iree_timeout_t timeout) {
+  iree_hal_remoting_semaphore_t* semaphore =
+      iree_hal_remoting_semaphore_cast(base_semaphore);
+  iree_hal_semaphore_list_t semaphore_list = {
+      .count = 1,
+      .semaphores = &base_semaphore,
+      .payload_values = &value,
+  };
+  return iree_hal_remoting_semaphore_multi_wait(
+      semaphore->connection, IREE_HAL_WAIT_MODE_ALL, semaphore_list, timeout);
+}
+
+static const iree_hal_semaphore_vtable_t iree_hal_remoting_semaphore_vtable = {
+    .destroy = iree_hal_remoting_semaphore_destroy,
+    .query = iree_hal_remoting_semaphore_query,
+    .signal = iree_hal_remoting_semaphore_signal,
+    .fail = iree_hal_remoting_semaphore_fail,
+    .wait = iree_hal_remoting_semaphore_wait,
+};
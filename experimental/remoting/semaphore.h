@@ -0,0 +1,47 @@
+// Copyright 2023 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#ifndef IREE_HAL_REMOTING_SEMAPHORE_H_
+#define IREE_HAL_REMOTING_SEMAPHORE_H_
+
+#include "experimental/remoting/connection.h"
+#include "iree/base/api.h"
+#include "iree/hal/api.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif  // __cplusplus
+
+// Creates a semaphore proxying a timeline semaphore on the server.
+//
+// Signals and failures are posted and take effect in order with other
+// messages on the connection. Queries and waits are calls; waits are performed
+// in short slices so that other threads using the connection can make
+// progress (and signal the semaphore being waited on).
+//
+// |connection| is unretained as the device outlives all semaphores.
+iree_status_t iree_hal_remoting_semaphore_create(
+    iree_hal_remoting_connection_t* connection, uint64_t initial_value,
+    iree_allocator_t host_allocator, iree_hal_semaphore_t** out_semaphore);
+
+// Returns true if |semaphore| is a remoting semaphore created by this driver.
+bool iree_hal_remoting_semaphore_isa(iree_hal_semaphore_t* semaphore);
+
+// Returns the handle of the server semaphore backing |semaphore|.
+iree_hal_remoting_handle_t iree_hal_remoting_semaphore_handle(
+    iree_hal_semaphore_t* semaphore);
+
+// Waits for one or more semaphores in |semaphore_list| to be reached.
+// All semaphores must be remoting semaphores created on |connection|.
+iree_status_t iree_hal_remoting_semaphore_multi_wait(
+    iree_hal_remoting_connection_t* connection, iree_hal_wait_mode_t wait_mode,
+    const iree_hal_semaphore_list_t semaphore_list, iree_timeout_t timeout);
+
+#ifdef __cplusplus
+}  // extern "C"
+#endif  // __cplusplus
+
+#endif  // IREE_HAL_REMOTING_SEMAPHORE_H_
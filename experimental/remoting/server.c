@@ -0,0 +1,1283 @@
+// Copyright 2023 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "experimental/remoting/api.h"
+#include "experimental/remoting/connection.h"
+#include "experimental/remoting/protocol.h"
+#include "experimental/remoting/transport.h"
+#include "iree/base/api.h"
+#include "iree/base/tracing.h"
+#include "iree/hal/api.h"
+
+//===----------------------------------------------------------------------===//
+// Handle table
+//===----------------------------------------------------------------------===//
+
+typedef enum iree_hal_remoting_server_resource_type_e {
+  IREE_HAL_REMOTING_SERVER_RESOURCE_NONE = 0,
+  IREE_HAL_REMOTING_SERVER_RESOURCE_BUFFER,
+  IREE_HAL_REMOTING_SERVER_RESOURCE_SEMAPHORE,
+  IREE_HAL_REMOTING_SERVER_RESOURCE_DESCRIPTOR_SET_LAYOUT,
+  IREE_HAL_REMOTING_SERVER_RESOURCE_PIPELINE_LAYOUT,
+  IREE_HAL_REMOTING_SERVER_RESOURCE_EXECUTABLE,
+  IREE_HAL_REMOTING_SERVER_RESOURCE_COMMAND_BUFFER,
+} iree_hal_remoting_server_resource_type_t;
+
+typedef struct iree_hal_remoting_server_entry_t {
+  iree_hal_remoting_server_resource_type_t type;
+  // Retained HAL resource. NULL if creation failed.
+  iree_hal_resource_t* resource;
+  // Failure of a posted creation reported when the resource is used.
+  iree_status_t status;
+} iree_hal_remoting_server_entry_t;
+
+typedef struct iree_hal_remoting_server_t {
+  iree_allocator_t host_allocator;
+  iree_hal_device_t* device;
+  iree_hal_remoting_transport_t* transport;
+
+  // Lazily created on the first executable request.
+  iree_hal_executable_cache_t* executable_cache;
+
+  // Indexed by handle as the client allocates handles densely.
+  iree_host_size_t entry_capacity;
+  iree_hal_remoting_server_entry_t* entries;
+
+  // First failure of a posted message that has not yet been reported. The
+  // next call made by the client receives it instead of being executed.
+  iree_status_t deferred_status;
+
+  // Storage for the payload of the current message.
+  iree_host_size_t payload_capacity;
+  uint8_t* payload;
+
+  // Storage for results larger than |inline_result|.
+  iree_host_size_t result_capacity;
+  uint8_t* result_storage;
+  // Storage for small fixed-size results.
+  uint64_t inline_result[4];
+  // Result data of the current call.
+  iree_const_byte_span_t result;
+} iree_hal_remoting_server_t;
+
+static void iree_hal_remoting_server_entry_reset(
+    iree_hal_remoting_server_entry_t* entry) {
+  if (entry->resource) iree_hal_resource_release(entry->resource);
+  iree_status_ignore(entry->status);
+  memset(entry, 0, sizeof(*entry));
+}
+
+// Defines |handle| as naming |resource| (retained). |resource| may be NULL
+// with a failing |status| to record the failure of a posted creation.
+static iree_status_t iree_hal_remoting_server_define(
+    iree_hal_remoting_server_t* server, iree_hal_remoting_handle_t handle,
+    iree_hal_remoting_server_resource_type_t type, void* resource,
+    iree_status_t status) {
+  if (handle == IREE_HAL_REMOTING_HANDLE_NULL) {
+    iree_status_ignore(status);
+    return iree_make_status(IREE_STATUS_INVALID_ARGUMENT,
+                            "cannot define the NULL handle");
+  }
+  if (handle >= server->entry_capacity) {
+    iree_host_size_t new_capacity =
+        iree_max(iree_max(64, server->entry_capacity * 2),
+                 (iree_host_size_t)handle + 1);
+    iree_status_t realloc_status = iree_allocator_realloc(
+        server->host_allocator, new_capacity * sizeof(server->entries[0]),
+        (void**)&server->entries);
+    if (!iree_status_is_ok(realloc_status)) {
+      iree_status_ignore(status);
+      return realloc_status;
+    }
+    memset(server->entries + server->entry_capacity, 0,
+           (new_capacity - server->entry_capacity) *
+               sizeof(server->entries[0]));
+    server->entry_capacity = new_capacity;
+  }
+  // Clients release handles before reusing them but a misbehaving client must
+  // not leak resources.
+  iree_hal_remoting_server_entry_t* entry = &server->entries[handle];
+  iree_hal_remoting_server_entry_reset(entry);
+  entry->type = type;
+  entry->resource = (iree_hal_resource_t*)resource;
+  if (entry->resource) iree_hal_resource_retain(entry->resource);
+  entry->status = status;
+  return iree_ok_status();
+}
+
+// Resolves |handle| to a resource of |type|. The NULL handle resolves to NULL.
+static iree_status_t iree_hal_remoting_server_lookup(
+    iree_hal_remoting_server_t* server, iree_hal_remoting_handle_t handle,
+    iree_hal_remoting_server_resource_type_t type, void** out_resource) {
+  *out_resource = NULL;
+  if (handle == IREE_HAL_REMOTING_HANDLE_NULL) return iree_ok_status();
+  iree_hal_remoting_server_entry_t* entry =
+      handle < server->entry_capacity ? &server->entries[handle] : NULL;
+  if (!entry || entry->type != type) {
+    return iree_make_status(IREE_STATUS_NOT_FOUND,
+                            "handle %u does not name a resource of type %d",
+                            handle, (int)type);
+  }
+  if (!entry->resource) return iree_status_clone(entry->status);
+  *out_resource = entry->resource;
+  return iree_ok_status();
+}
+
+// Resolves |handle| to a resource of |type| that must not be NULL.
+static iree_status_t iree_hal_remoting_server_lookup_required(
+    iree_hal_remoting_server_t* server, iree_hal_remoting_handle_t handle,
+    iree_hal_remoting_server_resource_type_t type, void** out_resource) {
+  IREE_RETURN_IF_ERROR(
+      iree_hal_remoting_server_lookup(server, handle, type, out_resource));
+  if (!*out_resource) {
+    return iree_make_status(IREE_STATUS_INVALID_ARGUMENT,
+                            "required resource handle is NULL");
+  }
+  return iree_ok_status();
+}
+
+//===----------------------------------------------------------------------===//
+// Payload parsing
+//===----------------------------------------------------------------------===//
+
+// Bounds-checked cursor over a message payload.
+typedef struct iree_hal_remoting_reader_t {
+  const uint8_t* data;
+  iree_host_size_t remaining;
+} iree_hal_remoting_reader_t;
+
+// Returns the next |length| bytes of the payload in |out_data| and skips any
+// padding following them.
+static iree_status_t iree_hal_remoting_reader_read(
+    iree_hal_remoting_reader_t* reader, iree_host_size_t length,
+    const void** out_data) {
+  *out_data = NULL;
+  if (length > reader->remaining) {
+    return iree_make_status(IREE_STATUS_DATA_LOSS,
+                            "message truncated; needed %" PRIhsz
+                            " bytes but only %" PRIhsz " remain",
+                            length, reader->remaining);
+  }
+  *out_data = reader->data;
+  const iree_host_size_t consumed = iree_min(
+      reader->remaining, length + iree_hal_remoting_padding(length));
+  reader->data += consumed;
+  reader->remaining -= consumed;
+  return iree_ok_status();
+}
+
+// Returns |count| elements of |element_size| bytes. Guards against overflow.
+static iree_status_t iree_hal_remoting_reader_read_array(
+    iree_hal_remoting_reader_t* reader, iree_host_size_t count,
+    iree_host_size_t element_size, const void** out_data) {
+  if (count > reader->remaining / element_size) {
+    *out_data = NULL;
+    return iree_make_status(IREE_STATUS_DATA_LOSS,
+                            "message truncated; array of %" PRIhsz
+                            " elements does not fit",
+                            count);
+  }
+  return iree_hal_remoting_reader_read(reader, count * element_size, out_data);
+}
+
+static void iree_hal_remoting_server_unpack_params(
+    const iree_hal_remoting_buffer_params_t* wire_params,
+    iree_hal_buffer_params_t* out_params) {
+  memset(out_params, 0, sizeof(*out_params));
+  out_params->usage = wire_params->usage;
+  out_params->access = wire_params->access;
+  out_params->type = wire_params->type;
+  out_params->queue_affinity = wire_params->queue_affinity;
+  out_params->min_alignment = wire_params->min_alignment;
+}
+
+// Ensures |server| has result storage for |length| bytes and returns it.
+static iree_status_t iree_hal_remoting_server_reserve_result(
+    iree_hal_remoting_server_t* server, iree_host_size_t length,
+    void** out_ptr) {
+  if (length <= sizeof(server->inline_result)) {
+    *out_ptr = server->inline_result;
+  } else {
+    if (length > server->result_capacity) {
+      IREE_RETURN_IF_ERROR(iree_allocator_realloc(
+          server->host_allocator, length, (void**)&server->result_storage));
+      server->result_capacity = length;
+    }
+    *out_ptr = server->result_storage;
+  }
+  server->result = iree_make_const_byte_span(*out_ptr, length);
+  return iree_ok_status();
+}
+
+//===----------------------------------------------------------------------===//
+// Queue operations
+//===----------------------------------------------------------------------===//
+
+// Parsed semaphore lists of a queue operation. Capacity of the lists is
+// bounded by the message size.
+typedef struct iree_hal_remoting_server_queue_t {
+  iree_hal_queue_affinity_t queue_affinity;
+  iree_hal_semaphore_list_t wait_semaphore_list;
+  iree_hal_semaphore_list_t signal_semaphore_list;
+} iree_hal_remoting_server_queue_t;
+
+// Resolves the semaphores following a queue operation body into lists backed
+// by |semaphores| and |payload_values| with capacity for all of them.
+static iree_status_t iree_hal_remoting_server_resolve_semaphores(
+    iree_hal_remoting_server_t* server,
+    const iree_hal_remoting_queue_header_t* header,
+    const iree_hal_remoting_semaphore_value_t* values,
+    iree_hal_semaphore_t** semaphores, uint64_t* payload_values,
+    iree_hal_remoting_server_queue_t* out_queue) {
+  const iree_host_size_t total_count =
+      (iree_host_size_t)header->wait_count + header->signal_count;
+  for (iree_host_size_t i = 0; i < total_count; ++i) {
+    IREE_RETURN_IF_ERROR(iree_hal_remoting_server_lookup_required(
+        server, values[i].semaphore,
+        IREE_HAL_REMOTING_SERVER_RESOURCE_SEMAPHORE, (void**)&semaphores[i]));
+    payload_values[i] = values[i].value;
+  }
+  out_queue->queue_affinity = header->queue_affinity;
+  out_queue->wait_semaphore_list.count = header->wait_count;
+  out_queue->wait_semaphore_list.semaphores = semaphores;
+  out_queue->wait_semaphore_list.payload_values = payload_values;
+  out_queue->signal_semaphore_list.count = header->signal_count;
+  out_queue->signal_semaphore_list.semaphores = semaphores + header->wait_count;
+  out_queue->signal_semaphore_list.payload_values =
+      payload_values + header->wait_count;
+  return iree_ok_status();
+}
+
+// Parses the semaphores of a queue operation and allocates storage for them
+// from |server| payload storage that remains valid for the message.
+static iree_status_t iree_hal_remoting_server_read_queue(
+    iree_hal_remoting_server_t* server, iree_hal_remoting_reader_t* reader,
+    const iree_hal_remoting_queue_header_t* header,
+    iree_hal_semaphore_t*** out_semaphores, uint64_t** out_payload_values,
+    const iree_hal_remoting_semaphore_value_t** out_values) {
+  const iree_host_size_t total_count =
+      (iree_host_size_t)header->wait_count + header->signal_count;
+  IREE_RETURN_IF_ERROR(iree_hal_remoting_reader_read_array(
+      reader, total_count, sizeof(iree_hal_remoting_semaphore_value_t),
+      (const void**)out_values));
+  *out_semaphores = NULL;
+  *out_payload_values = NULL;
+  if (total_count == 0) return iree_ok_status();
+  IREE_RETURN_IF_ERROR(iree_allocator_malloc(
+      server->host_allocator, total_count * sizeof(**out_semaphores),
+      (void**)out_semaphores));
+  iree_status_t status = iree_allocator_malloc(
+      server->host_allocator, total_count * sizeof(**out_payload_values),
+      (void**)out_payload_values);
+  if (!iree_status_is_ok(status)) {
+    iree_allocator_free(server->host_allocator, *out_semaphores);
+    *out_semaphores = NULL;
+  }
+  return status;
+}
+
+// Fails all signal semaphores of a queue operation that could not be issued so
+// that the client observes the failure when waiting.
+static void iree_hal_remoting_server_fail_queue(
+    iree_hal_remoting_server_t* server,
+    const iree_hal_remoting_queue_header_t* header,
+    const iree_hal_remoting_semaphore_value_t* values, iree_status_t status) {
+  const iree_hal_remoting_semaphore_value_t* signal_values =
+      values + header->wait_count;
+  for (uint32_t i = 0; i < header->signal_count; ++i) {
+    iree_hal_semaphore_t* semaphore = NULL;
+    iree_status_ignore(iree_hal_remoting_server_lookup(
+        server, signal_values[i].semaphore,
+        IREE_HAL_REMOTING_SERVER_RESOURCE_SEMAPHORE, (void**)&semaphore));
+    if (semaphore) {
+      iree_hal_semaphore_fail(semaphore, iree_status_clone(status));
+    }
+  }
+  iree_status_ignore(status);
+}
+
+//===----------------------------------------------------------------------===//
+// Command buffer replay
+//===----------------------------------------------------------------------===//
+
+static iree_status_t iree_hal_remoting_server_replay_command(
+    iree_hal_remoting_server_t* server,
+    iree_hal_command_buffer_t* command_buffer,
+    const iree_hal_remoting_command_header_t* header) {
+  const uint8_t* command_ptr = (const uint8_t*)header;
+  // Trailing data of the command following the command struct.
+  iree_hal_remoting_reader_t reader = {
+      .data = command_ptr,
+      .remaining = header->length,
+  };
+  const void* body = NULL;
+  switch (header->type) {
+    case IREE_HAL_REMOTING_COMMAND_EXECUTION_BARRIER: {
+      IREE_RETURN_IF_ERROR(iree_hal_remoting_reader_read(
+          &reader, sizeof(iree_hal_remoting_execution_barrier_cmd_t), &body));
+      const iree_hal_remoting_execution_barrier_cmd_t* cmd = body;
+      return iree_hal_command_buffer_execution_barrier(
+          command_buffer, cmd->source_stage_mask, cmd->target_stage_mask,
+          cmd->flags, 0, NULL, 0, NULL);
+    }
+    case IREE_HAL_REMOTING_COMMAND_DISCARD_BUFFER: {
+      IREE_RETURN_IF_ERROR(iree_hal_remoting_reader_read(
+          &reader, sizeof(iree_hal_remoting_discard_buffer_cmd_t), &body));
+      const iree_hal_remoting_discard_buffer_cmd_t* cmd = body;
+      iree_hal_buffer_t* buffer = NULL;
+      IREE_RETURN_IF_ERROR(iree_hal_remoting_server_lookup_required(
+          server, cmd->buffer, IREE_HAL_REMOTING_SERVER_RESOURCE_BUFFER,
+          (void**)&buffer));
+      return iree_hal_command_buffer_discard_buffer(command_buffer, buffer);
+    }
+    case IREE_HAL_REMOTING_COMMAND_FILL_BUFFER: {
+      IREE_RETURN_IF_ERROR(iree_hal_remoting_reader_read(
+          &reader, sizeof(iree_hal_remoting_fill_buffer_cmd_t), &body));
+      const iree_hal_remoting_fill_buffer_cmd_t* cmd = body;
+      iree_hal_buffer_t* buffer = NULL;
+      IREE_RETURN_IF_ERROR(iree_hal_remoting_server_lookup_required(
+          server, cmd->target_buffer, IREE_HAL_REMOTING_SERVER_RESOURCE_BUFFER,
+          (void**)&buffer));
+      if (cmd->pattern_length > sizeof(cmd->pattern)) {
+        return iree_make_status(IREE_STATUS_INVALID_ARGUMENT,
+                                "fill pattern length %u invalid",
+                                cmd->pattern_length);
+      }
+      return iree_hal_command_buffer_fill_buffer(
+          command_buffer, buffer, cmd->target_offset, cmd->length,
+          &cmd->pattern, cmd->pattern_length);
+    }
+    case IREE_HAL_REMOTING_COMMAND_UPDATE_BUFFER: {
+      IREE_RETURN_IF_ERROR(iree_hal_remoting_reader_read(
+          &reader, sizeof(iree_hal_remoting_update_buffer_cmd_t), &body));
+      const iree_hal_remoting_update_buffer_cmd_t* cmd = body;
+      iree_hal_buffer_t* buffer = NULL;
+      IREE_RETURN_IF_ERROR(iree_hal_remoting_server_lookup_required(
+          server, cmd->target_buffer, IREE_HAL_REMOTING_SERVER_RESOURCE_BUFFER,
+          (void**)&buffer));
+      const void* source = NULL;
+      IREE_RETURN_IF_ERROR(iree_hal_remoting_reader_read(
+          &reader, (iree_host_size_t)cmd->length, &source));
+      return iree_hal_command_buffer_update_buffer(
+          command_buffer, source, 0, buffer, cmd->target_offset, cmd->length);
+    }
+    case IREE_HAL_REMOTING_COMMAND_COPY_BUFFER: {
+      IREE_RETURN_IF_ERROR(iree_hal_remoting_reader_read(
+          &reader, sizeof(iree_hal_remoting_copy_buffer_cmd_t), &body));
+      const iree_hal_remoting_copy_buffer_cmd_t* cmd = body;
+      iree_hal_buffer_t* source_buffer = NULL;
+      IREE_RETURN_IF_ERROR(iree_hal_remoting_server_lookup_required(
+          server, cmd->source_buffer, IREE_HAL_REMOTING_SERVER_RESOURCE_BUFFER,
+          (void**)&source_buffer));
+      iree_hal_buffer_t* target_buffer = NULL;
+      IREE_RETURN_IF_ERROR(iree_hal_remoting_server_lookup_required(
+          server, cmd->target_buffer, IREE_HAL_REMOTING_SERVER_RESOURCE_BUFFER,
+          (void**)&target_buffer));
+      return iree_hal_command_buffer_copy_buffer(
+          command_buffer, source_buffer, cmd->source_offset, target_buffer,
+          cmd->target_offset, cmd->length);
+    }
+    case IREE_HAL_REMOTING_COMMAND_PUSH_CONSTANTS: {
+      IREE_RETURN_IF_ERROR(iree_hal_remoting_reader_read(
+          &reader, sizeof(iree_hal_remoting_push_constants_cmd_t), &body));
+      const iree_hal_remoting_push_constants_cmd_t* cmd = body;
+      iree_hal_pipeline_layout_t* pipeline_layout = NULL;
+      IREE_RETURN_IF_ERROR(iree_hal_remoting_server_lookup_required(
+          server, cmd->pipeline_layout,
+          IREE_HAL_REMOTING_SERVER_RESOURCE_PIPELINE_LAYOUT,
+          (void**)&pipeline_layout));
+      const void* values = NULL;
+      IREE_RETURN_IF_ERROR(
+          iree_hal_remoting_reader_read(&reader, cmd->values_length, &values));
+      return iree_hal_command_buffer_push_constants(
+          command_buffer, pipeline_layout, cmd->offset, values,
+          cmd->values_length);
+    }
+    case IREE_HAL_REMOTING_COMMAND_PUSH_DESCRIPTOR_SET: {
+      IREE_RETURN_IF_ERROR(iree_hal_remoting_reader_read(
+          &reader, sizeof(iree_hal_remoting_push_descriptor_set_cmd_t),
+          &body));
+      const iree_hal_remoting_push_descriptor_set_cmd_t* cmd = body;
+      iree_hal_pipeline_layout_t* pipeline_layout = NULL;
+      IREE_RETURN_IF_ERROR(iree_hal_remoting_server_lookup_required(
+          server, cmd->pipeline_layout,
+          IREE_HAL_REMOTING_SERVER_RESOURCE_PIPELINE_LAYOUT,
+          (void**)&pipeline_layout));
+      const iree_hal_remoting_descriptor_set_binding_t* wire_bindings = NULL;
+      IREE_RETURN_IF_ERROR(iree_hal_remoting_reader_read_array(
+          &reader, cmd->binding_count, sizeof(*wire_bindings),
+          (const void**)&wire_bindings));
+      // Bounded by the command length so the stack usage is limited by the
+      // message size.
+      iree_hal_descriptor_set_binding_t* bindings =
+          (iree_hal_descriptor_set_binding_t*)iree_alloca(
+              cmd->binding_count * sizeof(*bindings));
+      for (uint32_t i = 0; i < cmd->binding_count; ++i) {
+        memset(&bindings[i], 0, sizeof(bindings[i]));
+        bindings[i].binding = wire_bindings[i].binding;
+        IREE_RETURN_IF_ERROR(iree_hal_remoting_server_lookup(
+            server, wire_bindings[i].buffer,
+            IREE_HAL_REMOTING_SERVER_RESOURCE_BUFFER,
+            (void**)&bindings[i].buffer));
+        bindings[i].offset = wire_bindings[i].offset;
+        bindings[i].length = wire_bindings[i].length;
+      }
+      return iree_hal_command_buffer_push_descriptor_set(
+          command_buffer, pipeline_layout, cmd->set, cmd->binding_count,
+          bindings);
+    }
+    case IREE_HAL_REMOTING_COMMAND_DISPATCH: {
+      IREE_RETURN_IF_ERROR(iree_hal_remoting_reader_read(
+          &reader, sizeof(iree_hal_remoting_dispatch_cmd_t), &body));
+      const iree_hal_remoting_dispatch_cmd_t* cmd = body;
+      iree_hal_executable_t* executable = NULL;
+      IREE_RETURN_IF_ERROR(iree_hal_remoting_server_lookup_required(
+          server, cmd->executable, IREE_HAL_REMOTING_SERVER_RESOURCE_EXECUTABLE,
+          (void**)&executable));
+      return iree_hal_command_buffer_dispatch(
+          command_buffer, executable, cmd->entry_point, cmd->workgroup_x,
+          cmd->workgroup_y, cmd->workgroup_z);
+    }
+    case IREE_HAL_REMOTING_COMMAND_DISPATCH_INDIRECT: {
+      IREE_RETURN_IF_ERROR(iree_hal_remoting_reader_read(
+          &reader, sizeof(iree_hal_remoting_dispatch_indirect_cmd_t), &body));
+      const iree_hal_remoting_dispatch_indirect_cmd_t* cmd = body;
+      iree_hal_executable_t* executable = NULL;
+      IREE_RETURN_IF_ERROR(iree_hal_remoting_server_lookup_required(
+          server, cmd->executable, IREE_HAL_REMOTING_SERVER_RESOURCE_EXECUTABLE,
+          (void**)&executable));
+      iree_hal_buffer_t* workgroups_buffer = NULL;
+      IREE_RETURN_IF_ERROR(iree_hal_remoting_server_lookup_required(
+          server, cmd->workgroups_buffer,
+          IREE_HAL_REMOTING_SERVER_RESOURCE_BUFFER,
+          (void**)&workgroups_buffer));
+      return iree_hal_command_buffer_dispatch_indirect(
+          command_buffer, executable, cmd->entry_point, workgroups_buffer,
+          cmd->workgroups_offset);
+    }
+    case IREE_HAL_REMOTING_COMMAND_BEGIN_DEBUG_GROUP: {
+      IREE_RETURN_IF_ERROR(iree_hal_remoting_reader_read(
+          &reader, sizeof(iree_hal_remoting_begin_debug_group_cmd_t), &body));
+      const iree_hal_remoting_begin_debug_group_cmd_t* cmd = body;
+      const void* label = NULL;
+      IREE_RETURN_IF_ERROR(
+          iree_hal_remoting_reader_read(&reader, cmd->label_length, &label));
+      const iree_hal_label_color_t label_color = {
+          .r = (uint8_t)(cmd->label_color >> 24),
+          .g = (uint8_t)(cmd->label_color >> 16),
+          .b = (uint8_t)(cmd->label_color >> 8),
+          .a = (uint8_t)cmd->label_color,
+      };
+      iree_hal_command_buffer_begin_debug_group(
+          command_buffer,
+          iree_make_string_view((const char*)label, cmd->label_length),
+          label_color, /*location=*/NULL);
+      return iree_ok_status();
+    }
+    case IREE_HAL_REMOTING_COMMAND_END_DEBUG_GROUP: {
+      iree_hal_command_buffer_end_debug_group(command_buffer);
+      return iree_ok_status();
+    }
+    default:
+      return iree_make_status(IREE_STATUS_UNIMPLEMENTED,
+                              "unknown remoting command type %u",
+                              header->type);
+  }
+}
+
+// Records |commands| into |command_buffer| between begin and end.
+static iree_status_t iree_hal_remoting_server_replay_commands(
+    iree_hal_remoting_server_t* server,
+    iree_hal_command_buffer_t* command_buffer, const uint8_t* commands,
+    iree_host_size_t commands_length) {
+  IREE_TRACE_ZONE_BEGIN(z0);
+  IREE_RETURN_AND_END_ZONE_IF_ERROR(
+      z0, iree_hal_command_buffer_begin(command_buffer));
+  iree_status_t status = iree_ok_status();
+  iree_host_size_t offset = 0;
+  while (iree_status_is_ok(status) && offset < commands_length) {
+    const iree_hal_remoting_command_header_t* header =
+        (const iree_hal_remoting_command_header_t*)(commands + offset);
+    if (commands_length - offset < sizeof(*header) ||
+        header->length < sizeof(*header) ||
+        header->length > commands_length - offset ||
+        header->length % IREE_HAL_REMOTING_PAYLOAD_ALIGNMENT != 0) {
+      status = iree_make_status(IREE_STATUS_DATA_LOSS,
+                                "malformed command at offset %" PRIhsz,
+                                offset);
+      break;
+    }
+    status =
+        iree_hal_remoting_server_replay_command(server, command_buffer, header);
+    offset += header->length;
+  }
+  if (iree_status_is_ok(status)) {
+    status = iree_hal_command_buffer_end(command_buffer);
+  }
+  IREE_TRACE_ZONE_END(z0);
+  return status;
+}
+
+//===----------------------------------------------------------------------===//
+// Message handlers
+//===----------------------------------------------------------------------===//
+
+// Mapping of a shared memory object received from a client. Unmapped when the
+// buffer importing it is released.
+typedef struct iree_hal_remoting_server_mapping_t {
+  iree_allocator_t host_allocator;
+  void* ptr;
+  iree_host_size_t size;
+} iree_hal_remoting_server_mapping_t;
+
+static void iree_hal_remoting_server_mapping_release(
+    void* user_data, iree_hal_buffer_t* buffer) {
+  iree_hal_remoting_server_mapping_t* mapping =
+      (iree_hal_remoting_server_mapping_t*)user_data;
+  iree_hal_remoting_shared_memory_unmap(mapping->ptr, mapping->size);
+  iree_allocator_free(mapping->host_allocator, mapping);
+}
+
+// Imports the shared memory object |fd| as a buffer.
+static iree_status_t iree_hal_remoting_server_import_shared_memory(
+    iree_hal_remoting_server_t* server, int fd,
+    iree_hal_buffer_params_t params, iree_device_size_t allocation_size,
+    iree_hal_buffer_t** out_buffer) {
+  iree_hal_remoting_server_mapping_t* mapping = NULL;
+  IREE_RETURN_IF_ERROR(iree_allocator_malloc(
+      server->host_allocator, sizeof(*mapping), (void**)&mapping));
+  mapping->host_allocator = server->host_allocator;
+  mapping->size = (iree_host_size_t)allocation_size;
+  iree_status_t status =
+      iree_hal_remoting_shared_memory_map(fd, mapping->size, &mapping->ptr);
+  if (!iree_status_is_ok(status)) {
+    iree_allocator_free(server->host_allocator, mapping);
+    return status;
+  }
+
+  iree_hal_external_buffer_t external_buffer = {
+      .type = IREE_HAL_EXTERNAL_BUFFER_TYPE_HOST_ALLOCATION,
+      .flags = IREE_HAL_EXTERNAL_BUFFER_FLAG_NONE,
+      .size = allocation_size,
+      .handle.host_allocation.ptr = mapping->ptr,
+  };
+  const iree_hal_buffer_release_callback_t release_callback = {
+      .fn = iree_hal_remoting_server_mapping_release,
+      .user_data = mapping,
+  };
+  status = iree_hal_allocator_import_buffer(
+      iree_hal_device_allocator(server->device), params, &external_buffer,
+      release_callback, out_buffer);
+  if (!iree_status_is_ok(status)) {
+    iree_hal_remoting_server_mapping_release(mapping, NULL);
+  }
+  return status;
+}
+
+static iree_status_t iree_hal_remoting_server_handle_buffer_allocate(
+    iree_hal_remoting_server_t* server, iree_hal_remoting_reader_t* reader,
+    int* fd) {
+  const iree_hal_remoting_buffer_allocate_t* request = NULL;
+  IREE_RETURN_IF_ERROR(iree_hal_remoting_reader_read(reader, sizeof(*request),
+                                                     (const void**)&request));
+  iree_hal_buffer_params_t params;
+  iree_hal_remoting_server_unpack_params(&request->params, &params);
+
+  iree_hal_buffer_t* buffer = NULL;
+  if (*fd != -1) {
+    IREE_RETURN_IF_ERROR(iree_hal_remoting_server_import_shared_memory(
+        server, *fd, params, request->allocation_size, &buffer));
+  } else {
+    IREE_RETURN_IF_ERROR(iree_hal_allocator_allocate_buffer(
+        iree_hal_device_allocator(server->device), params,
+        request->allocation_size, iree_const_byte_span_empty(), &buffer));
+  }
+  iree_status_t status = iree_hal_remoting_server_define(
+      server, request->buffer, IREE_HAL_REMOTING_SERVER_RESOURCE_BUFFER, buffer,
+      iree_ok_status());
+
+  iree_hal_remoting_buffer_allocate_result_t* result = NULL;
+  if (iree_status_is_ok(status)) {
+    status = iree_hal_remoting_server_reserve_result(server, sizeof(*result),
+                                                     (void**)&result);
+  }
+  if (iree_status_is_ok(status)) {
+    memset(result, 0, sizeof(*result));
+    result->memory_type = iree_hal_buffer_memory_type(buffer);
+    result->allowed_usage = iree_hal_buffer_allowed_usage(buffer);
+    result->allowed_access = iree_hal_buffer_allowed_access(buffer);
+  }
+  iree_hal_buffer_release(buffer);
+  return status;
+}
+
+static iree_status_t iree_hal_remoting_server_handle_buffer_read(
+    iree_hal_remoting_server_t* server, iree_hal_remoting_reader_t* reader) {
+  const iree_hal_remoting_buffer_range_t* request = NULL;
+  IREE_RETURN_IF_ERROR(iree_hal_remoting_reader_read(reader, sizeof(*request),
+                                                     (const void**)&request));
+  if (request->length > IREE_HAL_REMOTING_MAX_TRANSFER_LENGTH) {
+    return iree_make_status(IREE_STATUS_OUT_OF_RANGE,
+                            "read of %" PRIu64
+                            " bytes exceeds the remoting transfer limit",
+                            request->length);
+  }
+  iree_hal_buffer_t* buffer = NULL;
+  IREE_RETURN_IF_ERROR(iree_hal_remoting_server_lookup_required(
+      server, request->buffer, IREE_HAL_REMOTING_SERVER_RESOURCE_BUFFER,
+      (void**)&buffer));
+  void* target = NULL;
+  IREE_RETURN_IF_ERROR(iree_hal_remoting_server_reserve_result(
+      server, (iree_host_size_t)request->length, &target));
+  return iree_hal_device_transfer_d2h(
+      server->device, buffer, request->offset, target, request->length,
+      IREE_HAL_TRANSFER_BUFFER_FLAG_DEFAULT, iree_infinite_timeout());
+}
+
+static iree_status_t iree_hal_remoting_server_handle_buffer_write(
+    iree_hal_remoting_server_t* server, iree_hal_remoting_reader_t* reader) {
+  const iree_hal_remoting_buffer_range_t* request = NULL;
+  IREE_RETURN_IF_ERROR(iree_hal_remoting_reader_read(reader, sizeof(*request),
+                                                     (const void**)&request));
+  iree_hal_buffer_t* buffer = NULL;
+  IREE_RETURN_IF_ERROR(iree_hal_remoting_server_lookup_required(
+      server, request->buffer, IREE_HAL_REMOTING_SERVER_RESOURCE_BUFFER,
+      (void**)&buffer));
+  const void* source = NULL;
+  IREE_RETURN_IF_ERROR(iree_hal_remoting_reader_read(
+      reader, (iree_host_size_t)request->length, &source));
+  return iree_hal_device_transfer_h2d(
+      server->device, source, buffer, request->offset, request->length,
+      IREE_HAL_TRANSFER_BUFFER_FLAG_DEFAULT, iree_infinite_timeout());
+}
+
+static iree_status_t iree_hal_remoting_server_handle_semaphore_create(
+    iree_hal_remoting_server_t* server, iree_hal_remoting_reader_t* reader) {
+  const iree_hal_remoting_semaphore_create_t* request = NULL;
+  IREE_RETURN_IF_ERROR(iree_hal_remoting_reader_read(reader, sizeof(*request),
+                                                     (const void**)&request));
+  iree_hal_semaphore_t* semaphore = NULL;
+  iree_status_t status = iree_hal_semaphore_create(
+      server->device, request->initial_value, &semaphore);
+  // Creation is posted so failures are reported on first use.
+  status = iree_hal_remoting_server_define(
+      server, request->semaphore, IREE_HAL_REMOTING_SERVER_RESOURCE_SEMAPHORE,
+      semaphore, status);
+  iree_hal_semaphore_release(semaphore);
+  return status;
+}
+
+static iree_status_t iree_hal_remoting_server_handle_semaphore_query(
+    iree_hal_remoting_server_t* server, iree_hal_remoting_reader_t* reader) {
+  const iree_hal_remoting_semaphore_query_t* request = NULL;
+  IREE_RETURN_IF_ERROR(iree_hal_remoting_reader_read(reader, sizeof(*request),
+                                                     (const void**)&request));
+  iree_hal_semaphore_t* semaphore = NULL;
+  IREE_RETURN_IF_ERROR(iree_hal_remoting_server_lookup_required(
+      server, request->semaphore, IREE_HAL_REMOTING_SERVER_RESOURCE_SEMAPHORE,
+      (void**)&semaphore));
+  uint64_t* value = NULL;
+  IREE_RETURN_IF_ERROR(iree_hal_remoting_server_reserve_result(
+      server, sizeof(*value), (void**)&value));
+  return iree_hal_semaphore_query(semaphore, value);
+}
+
+static iree_status_t iree_hal_remoting_server_handle_semaphore_signal(
+    iree_hal_remoting_server_t* server, iree_hal_remoting_reader_t* reader) {
+  const iree_hal_remoting_semaphore_signal_t* request = NULL;
+  IREE_RETURN_IF_ERROR(iree_hal_remoting_reader_read(reader, sizeof(*request),
+                                                     (const void**)&request));
+  iree_hal_semaphore_t* semaphore = NULL;
+  IREE_RETURN_IF_ERROR(iree_hal_remoting_server_lookup_required(
+      server, request->semaphore, IREE_HAL_REMOTING_SERVER_RESOURCE_SEMAPHORE,
+      (void**)&semaphore));
+  return iree_hal_semaphore_signal(semaphore, request->value);
+}
+
+static iree_status_t iree_hal_remoting_server_handle_semaphore_fail(
+    iree_hal_remoting_server_t* server, iree_hal_remoting_reader_t* reader) {
+  const iree_hal_remoting_semaphore_fail_t* request = NULL;
+  IREE_RETURN_IF_ERROR(iree_hal_remoting_reader_read(reader, sizeof(*request),
+                                                     (const void**)&request));
+  const void* message = NULL;
+  IREE_RETURN_IF_ERROR(
+      iree_hal_remoting_reader_read(reader, request->message_length, &message));
+  iree_hal_semaphore_t* semaphore = NULL;
+  IREE_RETURN_IF_ERROR(iree_hal_remoting_server_lookup_required(
+      server, request->semaphore, IREE_HAL_REMOTING_SERVER_RESOURCE_SEMAPHORE,
+      (void**)&semaphore));
+  const iree_status_code_t code =
+      request->status_code != IREE_STATUS_OK
+          ? (iree_status_code_t)request->status_code
+          : IREE_STATUS_UNKNOWN;
+  iree_hal_semaphore_fail(
+      semaphore, iree_make_status(code, "%.*s", (int)request->message_length,
+                                  (const char*)message));
+  return iree_ok_status();
+}
+
+static iree_status_t iree_hal_remoting_server_handle_semaphore_wait(
+    iree_hal_remoting_server_t* server, iree_hal_remoting_reader_t* reader) {
+  const iree_hal_remoting_semaphore_wait_t* request = NULL;
+  IREE_RETURN_IF_ERROR(iree_hal_remoting_reader_read(reader, sizeof(*request),
+                                                     (const void**)&request));
+  const iree_hal_remoting_semaphore_value_t* values = NULL;
+  IREE_RETURN_IF_ERROR(iree_hal_remoting_reader_read_array(
+      reader, request->count, sizeof(*values), (const void**)&values));
+  iree_hal_semaphore_t** semaphores = NULL;
+  IREE_RETURN_IF_ERROR(iree_allocator_malloc(
+      server->host_allocator,
+      request->count * (sizeof(*semaphores) + sizeof(uint64_t)),
+      (void**)&semaphores));
+  uint64_t* payload_values = (uint64_t*)(semaphores + request->count);
+  iree_status_t status = iree_ok_status();
+  for (uint32_t i = 0; i < request->count && iree_status_is_ok(status); ++i) {
+    status = iree_hal_remoting_server_lookup_required(
+        server, values[i].semaphore,
+        IREE_HAL_REMOTING_SERVER_RESOURCE_SEMAPHORE, (void**)&semaphores[i]);
+    payload_values[i] = values[i].value;
+  }
+  if (iree_status_is_ok(status)) {
+    const iree_hal_semaphore_list_t semaphore_list = {
+        .count = request->count,
+        .semaphores = semaphores,
+        .payload_values = payload_values,
+    };
+    // The client bounds the timeout so that the connection is not held.
+    status = iree_hal_device_wait_semaphores(
+        server->device, (iree_hal_wait_mode_t)request->wait_mode,
+        semaphore_list, iree_make_timeout_ns(request->timeout_ns));
+  }
+  iree_allocator_free(server->host_allocator, semaphores);
+  return status;
+}
+
+static iree_status_t iree_hal_remoting_server_handle_descriptor_set_layout(
+    iree_hal_remoting_server_t* server, iree_hal_remoting_reader_t* reader) {
+  const iree_hal_remoting_descriptor_set_layout_create_t* request = NULL;
+  IREE_RETURN_IF_ERROR(iree_hal_remoting_reader_read(reader, sizeof(*request),
+                                                     (const void**)&request));
+  const iree_hal_remoting_descriptor_set_layout_binding_t* wire_bindings =
+      NULL;
+  IREE_RETURN_IF_ERROR(iree_hal_remoting_reader_read_array(
+      reader, request->binding_count, sizeof(*wire_bindings),
+      (const void**)&wire_bindings));
+  iree_hal_descriptor_set_layout_binding_t* bindings =
+      (iree_hal_descriptor_set_layout_binding_t*)iree_alloca(
+          request->binding_count * sizeof(*bindings));
+  for (uint32_t i = 0; i < request->binding_count; ++i) {
+    bindings[i].binding = wire_bindings[i].binding;
+    bindings[i].type = (iree_hal_descriptor_type_t)wire_bindings[i].type;
+    bindings[i].flags = (iree_hal_descriptor_flags_t)wire_bindings[i].flags;
+  }
+  iree_hal_descriptor_set_layout_t* descriptor_set_layout = NULL;
+  IREE_RETURN_IF_ERROR(iree_hal_descriptor_set_layout_create(
+      server->device, request->flags, request->binding_count, bindings,
+      &descriptor_set_layout));
+  iree_status_t status = iree_hal_remoting_server_define(
+      server, request->descriptor_set_layout,
+      IREE_HAL_REMOTING_SERVER_RESOURCE_DESCRIPTOR_SET_LAYOUT,
+      descriptor_set_layout, iree_ok_status());
+  iree_hal_descriptor_set_layout_release(descriptor_set_layout);
+  return status;
+}
+
+static iree_status_t iree_hal_remoting_server_handle_pipeline_layout(
+    iree_hal_remoting_server_t* server, iree_hal_remoting_reader_t* reader) {
+  const iree_hal_remoting_pipeline_layout_create_t* request = NULL;
+  IREE_RETURN_IF_ERROR(iree_hal_remoting_reader_read(reader, sizeof(*request),
+                                                     (const void**)&request));
+  const iree_hal_remoting_handle_t* set_layout_handles = NULL;
+  IREE_RETURN_IF_ERROR(iree_hal_remoting_reader_read_array(
+      reader, request->set_layout_count, sizeof(*set_layout_handles),
+      (const void**)&set_layout_handles));
+  iree_hal_descriptor_set_layout_t** set_layouts =
+      (iree_hal_descriptor_set_layout_t**)iree_alloca(
+          request->set_layout_count * sizeof(*set_layouts));
+  for (uint32_t i = 0; i < request->set_layout_count; ++i) {
+    IREE_RETURN_IF_ERROR(iree_hal_remoting_server_lookup_required(
+        server, set_layout_handles[i],
+        IREE_HAL_REMOTING_SERVER_RESOURCE_DESCRIPTOR_SET_LAYOUT,
+        (void**)&set_layouts[i]));
+  }
+  iree_hal_pipeline_layout_t* pipeline_layout = NULL;
+  IREE_RETURN_IF_ERROR(iree_hal_pipeline_layout_create(
+      server->device, request->push_constants, request->set_layout_count,
+      set_layouts, &pipeline_layout));
+  iree_status_t status = iree_hal_remoting_server_define(
+      server, request->pipeline_layout,
+      IREE_HAL_REMOTING_SERVER_RESOURCE_PIPELINE_LAYOUT, pipeline_layout,
+      iree_ok_status());
+  iree_hal_pipeline_layout_release(pipeline_layout);
+  return status;
+}
+
+static iree_status_t iree_hal_remoting_server_executable_cache(
+    iree_hal_remoting_server_t* server,
+    iree_hal_executable_cache_t** out_executable_cache) {
+  if (!server->executable_cache) {
+    IREE_RETURN_IF_ERROR(iree_hal_executable_cache_create(
+        server->device, iree_make_cstring_view("remoting"),
+        iree_loop_inline(NULL), &server->executable_cache));
+  }
+  *out_executable_cache = server->executable_cache;
+  return iree_ok_status();
+}
+
+static iree_status_t iree_hal_remoting_server_handle_format_query(
+    iree_hal_remoting_server_t* server, iree_hal_remoting_reader_t* reader) {
+  const iree_hal_remoting_executable_format_query_t* request = NULL;
+  IREE_RETURN_IF_ERROR(iree_hal_remoting_reader_read(reader, sizeof(*request),
+                                                     (const void**)&request));
+  const void* format = NULL;
+  IREE_RETURN_IF_ERROR(
+      iree_hal_remoting_reader_read(reader, request->format_length, &format));
+  iree_hal_executable_cache_t* executable_cache = NULL;
+  IREE_RETURN_IF_ERROR(
+      iree_hal_remoting_server_executable_cache(server, &executable_cache));
+  uint32_t* result = NULL;
+  IREE_RETURN_IF_ERROR(iree_hal_remoting_server_reserve_result(
+      server, sizeof(*result), (void**)&result));
+  *result = iree_hal_executable_cache_can_prepare_format(
+                executable_cache, request->caching_mode,
+                iree_make_string_view((const char*)format,
+                                      request->format_length))
+                ? 1u
+                : 0u;
+  return iree_ok_status();
+}
+
+static iree_status_t iree_hal_remoting_server_handle_executable_create(
+    iree_hal_remoting_server_t* server, iree_hal_remoting_reader_t* reader) {
+  const iree_hal_remoting_executable_create_t* request = NULL;
+  IREE_RETURN_IF_ERROR(iree_hal_remoting_reader_read(reader, sizeof(*request),
+                                                     (const void**)&request));
+  const iree_hal_remoting_handle_t* layout_handles = NULL;
+  IREE_RETURN_IF_ERROR(iree_hal_remoting_reader_read_array(
+      reader, request->pipeline_layout_count, sizeof(*layout_handles),
+      (const void**)&layout_handles));
+  const uint32_t* constants = NULL;
+  IREE_RETURN_IF_ERROR(iree_hal_remoting_reader_read_array(
+      reader, request->constant_count, sizeof(*constants),
+      (const void**)&constants));
+  const void* format = NULL;
+  IREE_RETURN_IF_ERROR(
+      iree_hal_remoting_reader_read(reader, request->format_length, &format));
+  const void* data = NULL;
+  IREE_RETURN_IF_ERROR(iree_hal_remoting_reader_read(
+      reader, (iree_host_size_t)request->data_length, &data));
+
+  iree_hal_pipeline_layout_t** pipeline_layouts =
+      (iree_hal_pipeline_layout_t**)iree_alloca(
+          request->pipeline_layout_count * sizeof(*pipeline_layouts));
+  for (uint32_t i = 0; i < request->pipeline_layout_count; ++i) {
+    IREE_RETURN_IF_ERROR(iree_hal_remoting_server_lookup_required(
+        server, layout_handles[i],
+        IREE_HAL_REMOTING_SERVER_RESOURCE_PIPELINE_LAYOUT,
+        (void**)&pipeline_layouts[i]));
+  }
+
+  iree_hal_executable_params_t executable_params;
+  iree_hal_executable_params_initialize(&executable_params);
+  // The data lives in the message payload that is reused for the next
+  // message so the executable must not alias it.
+  executable_params.caching_mode =
+      request->caching_mode &
+      ~IREE_HAL_EXECUTABLE_CACHING_MODE_ALIAS_PROVIDED_DATA;
+  executable_params.executable_format =
+      iree_make_string_view((const char*)format, request->format_length);
+  executable_params.executable_data =
+      iree_make_const_byte_span(data, (iree_host_size_t)request->data_length);
+  executable_params.pipeline_layout_count = request->pipeline_layout_count;
+  executable_params.pipeline_layouts = pipeline_layouts;
+  executable_params.constant_count = request->constant_count;
+  executable_params.constants = constants;
+
+  iree_hal_executable_cache_t* executable_cache = NULL;
+  IREE_RETURN_IF_ERROR(
+      iree_hal_remoting_server_executable_cache(server, &executable_cache));
+  iree_hal_executable_t* executable = NULL;
+  IREE_RETURN_IF_ERROR(iree_hal_executable_cache_prepare_executable(
+      executable_cache, &executable_params, &executable));
+  iree_status_t status = iree_hal_remoting_server_define(
+      server, request->executable, IREE_HAL_REMOTING_SERVER_RESOURCE_EXECUTABLE,
+      executable, iree_ok_status());
+  iree_hal_executable_release(executable);
+  return status;
+}
+
+static iree_status_t iree_hal_remoting_server_handle_command_buffer_create(
+    iree_hal_remoting_server_t* server, iree_hal_remoting_reader_t* reader) {
+  const iree_hal_remoting_command_buffer_create_t* request = NULL;
+  IREE_RETURN_IF_ERROR(iree_hal_remoting_reader_read(reader, sizeof(*request),
+                                                     (const void**)&request));
+  const void* commands = NULL;
+  IREE_RETURN_IF_ERROR(iree_hal_remoting_reader_read(
+      reader, (iree_host_size_t)request->commands_length, &commands));
+
+  iree_hal_command_buffer_t* command_buffer = NULL;
+  iree_status_t status = iree_hal_command_buffer_create(
+      server->device, (iree_hal_command_buffer_mode_t)request->mode,
+      (iree_hal_command_category_t)request->command_categories,
+      request->queue_affinity, /*binding_capacity=*/0, &command_buffer);
+  if (iree_status_is_ok(status)) {
+    status = iree_hal_remoting_server_replay_commands(
+        server, command_buffer, (const uint8_t*)commands,
+        (iree_host_size_t)request->commands_length);
+  }
+  if (!iree_status_is_ok(status)) {
+    // Recording failures are reported when the command buffer is submitted.
+    iree_hal_command_buffer_release(command_buffer);
+    command_buffer = NULL;
+  }
+  status = iree_hal_remoting_server_define(
+      server, request->command_buffer,
+      IREE_HAL_REMOTING_SERVER_RESOURCE_COMMAND_BUFFER, command_buffer, status);
+  iree_hal_command_buffer_release(command_buffer);
+  return status;
+}
+
+// Issues a queue operation after resolving its semaphores. Failures to issue
+// the operation are propagated to its signal semaphores.
+typedef iree_status_t (*iree_hal_remoting_server_queue_fn_t)(
+    iree_hal_remoting_server_t* server, const void* request,
+    iree_hal_remoting_reader_t* reader,
+    const iree_hal_remoting_server_queue_t* queue);
+
+static iree_status_t iree_hal_remoting_server_handle_queue_operation(
+    iree_hal_remoting_server_t* server, iree_hal_remoting_reader_t* reader,
+    iree_host_size_t request_size, iree_hal_remoting_server_queue_fn_t fn) {
+  const void* request = NULL;
+  IREE_RETURN_IF_ERROR(
+      iree_hal_remoting_reader_read(reader, request_size, &request));
+  // All queue operations start with the common header.
+  const iree_hal_remoting_queue_header_t* header =
+      (const iree_hal_remoting_queue_header_t*)request;
+  const iree_hal_remoting_semaphore_value_t* values = NULL;
+  iree_hal_semaphore_t** semaphores = NULL;
+  uint64_t* payload_values = NULL;
+  IREE_RETURN_IF_ERROR(iree_hal_remoting_server_read_queue(
+      server, reader, header, &semaphores, &payload_values, &values));
+
+  iree_hal_remoting_server_queue_t queue;
+  iree_status_t status = iree_hal_remoting_server_resolve_semaphores(
+      server, header, values, semaphores, payload_values, &queue);
+  if (iree_status_is_ok(status)) {
+    status = fn(server, request, reader, &queue);
+  }
+  if (!iree_status_is_ok(status)) {
+    iree_hal_remoting_server_fail_queue(server, header, values, status);
+  }
+  iree_allocator_free(server->host_allocator, payload_values);
+  iree_allocator_free(server->host_allocator, semaphores);
+  return iree_ok_status();
+}
+
+static iree_status_t iree_hal_remoting_server_queue_alloca(
+    iree_hal_remoting_server_t* server, const void* base_request,
+    iree_hal_remoting_reader_t* reader,
+    const iree_hal_remoting_server_queue_t* queue) {
+  const iree_hal_remoting_queue_alloca_t* request =
+      (const iree_hal_remoting_queue_alloca_t*)base_request;
+  iree_hal_buffer_params_t params;
+  iree_hal_remoting_server_unpack_params(&request->params, &params);
+  iree_hal_buffer_t* buffer = NULL;
+  iree_status_t status = iree_hal_device_queue_alloca(
+      server->device, queue->queue_affinity, queue->wait_semaphore_list,
+      queue->signal_semaphore_list, (iree_hal_allocator_pool_t)request->pool,
+      params, request->allocation_size, &buffer);
+  // The client uses the buffer immediately; failures are reported on use.
+  iree_status_t define_status = iree_hal_remoting_server_define(
+      server, request->buffer, IREE_HAL_REMOTING_SERVER_RESOURCE_BUFFER,
+      buffer, iree_status_clone(status));
+  iree_hal_buffer_release(buffer);
+  if (!iree_status_is_ok(define_status)) {
+    iree_status_ignore(status);
+    return define_status;
+  }
+  return status;
+}
+
+static iree_status_t iree_hal_remoting_server_queue_dealloca(
+    iree_hal_remoting_server_t* server, const void* base_request,
+    iree_hal_remoting_reader_t* reader,
+    const iree_hal_remoting_server_queue_t* queue) {
+  const iree_hal_remoting_queue_dealloca_t* request =
+      (const iree_hal_remoting_queue_dealloca_t*)base_request;
+  iree_hal_buffer_t* buffer = NULL;
+  IREE_RETURN_IF_ERROR(iree_hal_remoting_server_lookup_required(
+      server, request->buffer, IREE_HAL_REMOTING_SERVER_RESOURCE_BUFFER,
+      (void**)&buffer));
+  return iree_hal_device_queue_dealloca(
+      server->device, queue->queue_affinity, queue->wait_semaphore_list,
+      queue->signal_semaphore_list, buffer);
+}
+
+static iree_status_t iree_hal_remoting_server_queue_execute(
+    iree_hal_remoting_server_t* server, const void* base_request,
+    iree_hal_remoting_reader_t* reader,
+    const iree_hal_remoting_server_queue_t* queue) {
+  const iree_hal_remoting_queue_execute_t* request =
+      (const iree_hal_remoting_queue_execute_t*)base_request;
+  const iree_hal_remoting_handle_t* command_buffer_handles = NULL;
+  IREE_RETURN_IF_ERROR(iree_hal_remoting_reader_read_array(
+      reader, request->command_buffer_count, sizeof(*command_buffer_handles),
+      (const void**)&command_buffer_handles));
+  iree_hal_command_buffer_t** command_buffers =
+      (iree_hal_command_buffer_t**)iree_alloca(
+          request->command_buffer_count * sizeof(*command_buffers));
+  for (uint32_t i = 0; i < request->command_buffer_count; ++i) {
+    IREE_RETURN_IF_ERROR(iree_hal_remoting_server_lookup_required(
+        server, command_buffer_handles[i],
+        IREE_HAL_REMOTING_SERVER_RESOURCE_COMMAND_BUFFER,
+        (void**)&command_buffers[i]));
+  }
+  return iree_hal_device_queue_execute(
+      server->device, queue->queue_affinity, queue->wait_semaphore_list,
+      queue->signal_semaphore_list, request->command_buffer_count,
+      command_buffers);
+}
+
+static iree_status_t iree_hal_remoting_server_handle_message(
+    iree_hal_remoting_server_t* server, iree_hal_remoting_message_type_t type,
+    iree_hal_remoting_reader_t* reader, int* fd) {
+  switch (type) {
+    case IREE_HAL_REMOTING_MESSAGE_HELLO: {
+      const iree_hal_remoting_hello_t* request = NULL;
+      IREE_RETURN_IF_ERROR(iree_hal_remoting_reader_read(
+          reader, sizeof(*request), (const void**)&request));
+      // The client checks compatibility as it knows what it can speak.
+      iree_hal_remoting_hello_t* result = NULL;
+      IREE_RETURN_IF_ERROR(iree_hal_remoting_server_reserve_result(
+          server, sizeof(*result), (void**)&result));
+      result->magic = IREE_HAL_REMOTING_PROTOCOL_MAGIC;
+      result->version = IREE_HAL_REMOTING_PROTOCOL_VERSION;
+      return iree_ok_status();
+    }
+    case IREE_HAL_REMOTING_MESSAGE_RELEASE: {
+      const iree_hal_remoting_release_t* request = NULL;
+      IREE_RETURN_IF_ERROR(iree_hal_remoting_reader_read(
+          reader, sizeof(*request), (const void**)&request));
+      // Handles of failed or never-posted resources may be released.
+      if (request->handle < server->entry_capacity) {
+        iree_hal_remoting_server_entry_reset(&server->entries[request->handle]);
+      }
+      return iree_ok_status();
+    }
+    case IREE_HAL_REMOTING_MESSAGE_DEVICE_QUERY_I64: {
+      const iree_hal_remoting_device_query_i64_t* request = NULL;
+      IREE_RETURN_IF_ERROR(iree_hal_remoting_reader_read(
+          reader, sizeof(*request), (const void**)&request));
+      const char* strings = NULL;
+      IREE_RETURN_IF_ERROR(iree_hal_remoting_reader_read(
+          reader,
+          (iree_host_size_t)request->category_length + request->key_length,
+          (const void**)&strings));
+      int64_t* value = NULL;
+      IREE_RETURN_IF_ERROR(iree_hal_remoting_server_reserve_result(
+          server, sizeof(*value), (void**)&value));
+      return iree_hal_device_query_i64(
+          server->device,
+          iree_make_string_view(strings, request->category_length),
+          iree_make_string_view(strings + request->category_length,
+                                request->key_length),
+          value);
+    }
+    case IREE_HAL_REMOTING_MESSAGE_DEVICE_TRIM:
+      return iree_hal_device_trim(server->device);
+    case IREE_HAL_REMOTING_MESSAGE_BUFFER_ALLOCATE:
+      return iree_hal_remoting_server_handle_buffer_allocate(server, reader,
+                                                             fd);
+    case IREE_HAL_REMOTING_MESSAGE_BUFFER_READ:
+      return iree_hal_remoting_server_handle_buffer_read(server, reader);
+    case IREE_HAL_REMOTING_MESSAGE_BUFFER_WRITE:
+      return iree_hal_remoting_server_handle_buffer_write(server, reader);
+    case IREE_HAL_REMOTING_MESSAGE_SEMAPHORE_CREATE:
+      return iree_hal_remoting_server_handle_semaphore_create(server, reader);
+    case IREE_HAL_REMOTING_MESSAGE_SEMAPHORE_QUERY:
+      return iree_hal_remoting_server_handle_semaphore_query(server, reader);
+    case IREE_HAL_REMOTING_MESSAGE_SEMAPHORE_SIGNAL:
+      return iree_hal_remoting_server_handle_semaphore_signal(server, reader);
+    case IREE_HAL_REMOTING_MESSAGE_SEMAPHORE_FAIL:
+      return iree_hal_remoting_server_handle_semaphore_fail(server, reader);
+    case IREE_HAL_REMOTING_MESSAGE_SEMAPHORE_WAIT:
+      return iree_hal_remoting_server_handle_semaphore_wait(server, reader);
+    case IREE_HAL_REMOTING_MESSAGE_DESCRIPTOR_SET_LAYOUT_CREATE:
+      return iree_hal_remoting_server_handle_descriptor_set_layout(server,
+                                                                   reader);
+    case IREE_HAL_REMOTING_MESSAGE_PIPELINE_LAYOUT_CREATE:
+      return iree_hal_remoting_server_handle_pipeline_layout(server, reader);
+    case IREE_HAL_REMOTING_MESSAGE_EXECUTABLE_FORMAT_QUERY:
+      return iree_hal_remoting_server_handle_format_query(server, reader);
+    case IREE_HAL_REMOTING_MESSAGE_EXECUTABLE_CREATE:
+      return iree_hal_remoting_server_handle_executable_create(server, reader);
+    case IREE_HAL_REMOTING_MESSAGE_COMMAND_BUFFER_CREATE:
+      return iree_hal_remoting_server_handle_command_buffer_create(server,
+                                                                   reader);
+    case IREE_HAL_REMOTING_MESSAGE_QUEUE_ALLOCA:
+      return iree_hal_remoting_server_handle_queue_operation(
+          server, reader, sizeof(iree_hal_remoting_queue_alloca_t),
+          iree_hal_remoting_server_queue_alloca);
+    case IREE_HAL_REMOTING_MESSAGE_QUEUE_DEALLOCA:
+      return iree_hal_remoting_server_handle_queue_operation(
+          server, reader, sizeof(iree_hal_remoting_queue_dealloca_t),
+          iree_hal_remoting_server_queue_dealloca);
+    case IREE_HAL_REMOTING_MESSAGE_QUEUE_EXECUTE:
+      return iree_hal_remoting_server_handle_queue_operation(
+          server, reader, sizeof(iree_hal_remoting_queue_execute_t),
+          iree_hal_remoting_server_queue_execute);
+    default:
+      return iree_make_status(IREE_STATUS_UNIMPLEMENTED,
+                              "unknown remoting message type %u", type);
+  }
+}
+
+//===----------------------------------------------------------------------===//
+// Connection loop
+//===----------------------------------------------------------------------===//
+
+// Sends the reply to a call carrying |status| (consumed) and the current
+// result data if the call succeeded.
+static iree_status_t iree_hal_remoting_server_reply(
+    iree_hal_remoting_server_t* server, iree_status_t status) {
+  char* message = NULL;
+  iree_host_size_t message_length = 0;
+  iree_hal_remoting_reply_t reply = {
+      .status_code = iree_status_code(status),
+  };
+  if (!iree_status_is_ok(status)) {
+    if (!iree_status_to_string(status, &server->host_allocator, &message,
+                               &message_length)) {
+      message = NULL;
+      message_length = 0;
+    }
+    server->result = iree_const_byte_span_empty();
+  }
+  iree_status_ignore(status);
+  reply.message_length = (uint32_t)message_length;
+  const iree_const_byte_span_t spans[4] = {
+      iree_make_const_byte_span(&reply, sizeof(reply)),
+      iree_make_const_byte_span(message, message_length),
+      iree_hal_remoting_padding_span(iree_hal_remoting_padding(message_length)),
+      server->result,
+  };
+  iree_status_t send_status = iree_hal_remoting_transport_send(
+      server->transport, IREE_HAL_REMOTING_MESSAGE_REPLY,
+      IREE_HAL_REMOTING_MESSAGE_FLAG_NONE, IREE_ARRAYSIZE(spans), spans,
+      /*fd=*/-1);
+  iree_allocator_free(server->host_allocator, message);
+  return send_status;
+}
+
+// Receives and processes a single message.
+static iree_status_t iree_hal_remoting_server_process(
+    iree_hal_remoting_server_t* server) {
+  iree_hal_remoting_message_header_t header;
+  int fd = -1;
+  IREE_RETURN_IF_ERROR(
+      iree_hal_remoting_transport_recv_header(server->transport, &header, &fd));
+  if (header.payload_length > IREE_HAL_REMOTING_MAX_PAYLOAD_LENGTH) {
+    iree_hal_remoting_close_fd(fd);
+    return iree_make_status(IREE_STATUS_DATA_LOSS,
+                            "message payload of %u bytes exceeds the limit",
+                            header.payload_length);
+  }
+  IREE_TRACE_ZONE_BEGIN(z0);
+  IREE_TRACE_ZONE_APPEND_VALUE(z0, (int64_t)header.type);
+
+  iree_status_t status = iree_ok_status();
+  if (header.payload_length > server->payload_capacity) {
+    status = iree_allocator_realloc(server->host_allocator,
+                                    header.payload_length,
+                                    (void**)&server->payload);
+    if (iree_status_is_ok(status)) {
+      server->payload_capacity = header.payload_length;
+    }
+  }
+  if (iree_status_is_ok(status)) {
+    status = iree_hal_remoting_transport_recv(
+        server->transport, server->payload, header.payload_length);
+  }
+  if (!iree_status_is_ok(status)) {
+    // The stream cannot be resynchronized.
+    iree_hal_remoting_close_fd(fd);
+    IREE_TRACE_ZONE_END(z0);
+    return status;
+  }
+
+  const bool is_call = iree_all_bits_set(header.flags,
+                                         IREE_HAL_REMOTING_MESSAGE_FLAG_REPLY);
+  iree_hal_remoting_reader_t reader = {
+      .data = server->payload,
+      .remaining = header.payload_length,
+  };
+  server->result = iree_const_byte_span_empty();
+  iree_status_t message_status = iree_ok_status();
+  if (is_call && !iree_status_is_ok(server->deferred_status)) {
+    // Report the failure of an earlier posted message instead of executing.
+    message_status = server->deferred_status;
+    server->deferred_status = iree_ok_status();
+  } else {
+    message_status = iree_hal_remoting_server_handle_message(
+        server, (iree_hal_remoting_message_type_t)header.type, &reader, &fd);
+  }
+  iree_hal_remoting_close_fd(fd);
+
+  if (is_call) {
+    status = iree_hal_remoting_server_reply(server, message_status);
+  } else if (!iree_status_is_ok(message_status)) {
+    if (iree_status_is_ok(server->deferred_status)) {
+      server->deferred_status = message_status;
+    } else {
+      iree_status_ignore(message_status);
+    }
+  }
+
+  IREE_TRACE_ZONE_END(z0);
+  return status;
+}
+
+IREE_API_EXPORT iree_status_t iree_hal_remoting_serve(
+    iree_hal_device_t* device, iree_hal_remoting_transport_t* transport,
+    iree_allocator_t host_allocator) {
+  IREE_ASSERT_ARGUMENT(device);
+  IREE_ASSERT_ARGUMENT(transport);
+  IREE_TRACE_ZONE_BEGIN(z0);
+
+  iree_hal_remoting_server_t server;
+  memset(&server, 0, sizeof(server));
+  server.host_allocator = host_allocator;
+  server.device = device;
+  server.transport = transport;
+
+  iree_status_t status = iree_ok_status();
+  do {
+    status = iree_hal_remoting_server_process(&server);
+  } while (iree_status_is_ok(status));
+  if (iree_status_is_unavailable(status)) {
+    // Clean disconnect between messages.
+    iree_status_ignore(status);
+    status = iree_ok_status();
+  }
+
+  // Release everything the client left behind. Work still in flight retains
+  // the resources it uses.
+  iree_status_ignore(server.deferred_status);
+  for (iree_host_size_t i = 0; i < server.entry_capacity; ++i) {
+    iree_hal_remoting_server_entry_reset(&server.entries[i]);
+  }
+  iree_allocator_free(host_allocator, server.entries);
+  iree_hal_executable_cache_release(server.executable_cache);
+  iree_allocator_free(host_allocator, server.result_storage);
+  iree_allocator_free(host_allocator, server.payload);
+
+  IREE_TRACE_ZONE_END(z0);
+  return status;
+}
@@ -0,0 +1,141 @@
+// Copyright 2023 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+// Serves a local HAL device to remoting clients.
+//
+// Example:
+//   iree-remoting-server --device=local-task --listen=tcp:0.0.0.0:7777
+//   iree-run-module --device=remoting://tcp:server:7777 ...
+//
+// Each client is served on its own thread and all clients share the device.
+
+#include <stdio.h>
+#include <string.h>
+
+#include "experimental/remoting/api.h"
+#include "iree/base/api.h"
+#include "iree/base/internal/atomics.h"
+#include "iree/base/internal/flags.h"
+#include "iree/base/internal/threading.h"
+#include "iree/hal/api.h"
+#include "iree/tooling/device_util.h"
+
+IREE_FLAG(string, listen, "tcp:127.0.0.1:7777",
+          "Endpoint to accept remoting clients on (`tcp:host:port` or\n"
+          "`unix:path`).");
+
+typedef struct iree_remoting_session_t {
+  iree_hal_device_t* device;
+  iree_hal_remoting_transport_t* transport;
+  iree_thread_t* thread;
+  // Set by the session thread when the client has disconnected.
+  iree_atomic_int32_t is_done;
+  struct iree_remoting_session_t* next;
+} iree_remoting_session_t;
+
+static int iree_remoting_session_main(void* entry_arg) {
+  iree_remoting_session_t* session = (iree_remoting_session_t*)entry_arg;
+  iree_status_t status = iree_hal_remoting_serve(
+      session->device, session->transport, iree_allocator_system());
+  if (!iree_status_is_ok(status)) {
+    iree_status_fprint(stderr, status);
+    iree_status_free(status);
+  }
+  iree_hal_remoting_transport_destroy(session->transport);
+  session->transport = NULL;
+  iree_atomic_store_int32(&session->is_done, 1, iree_memory_order_release);
+  return 0;
+}
+
+// Joins and frees sessions whose client has disconnected. All sessions are
+// joined when |wait_all| is set.
+static iree_remoting_session_t* iree_remoting_reap_sessions(
+    iree_remoting_session_t* sessions, bool wait_all) {
+  iree_remoting_session_t** link = &sessions;
+  while (*link) {
+    iree_remoting_session_t* session = *link;
+    if (wait_all || iree_atomic_load_int32(&session->is_done,
+                                           iree_memory_order_acquire)) {
+      *link = session->next;
+      iree_thread_release(session->thread);
+      iree_allocator_free(iree_allocator_system(), session);
+    } else {
+      link = &session->next;
+    }
+  }
+  return sessions;
+}
+
+static iree_status_t iree_remoting_serve_clients(
+    iree_hal_device_t* device, iree_hal_remoting_listener_t* listener) {
+  iree_allocator_t host_allocator = iree_allocator_system();
+  iree_remoting_session_t* sessions = NULL;
+  iree_status_t status = iree_ok_status();
+  while (iree_status_is_ok(status)) {
+    iree_hal_remoting_transport_t* transport = NULL;
+    status = iree_hal_remoting_listener_accept(listener, &transport);
+    if (!iree_status_is_ok(status)) break;
+    sessions = iree_remoting_reap_sessions(sessions, /*wait_all=*/false);
+
+    iree_remoting_session_t* session = NULL;
+    status = iree_allocator_malloc(host_allocator, sizeof(*session),
+                                   (void**)&session);
+    if (!iree_status_is_ok(status)) {
+      iree_hal_remoting_transport_destroy(transport);
+      break;
+    }
+    memset(session, 0, sizeof(*session));
+    session->device = device;
+    session->transport = transport;
+    iree_thread_create_params_t thread_params;
+    memset(&thread_params, 0, sizeof(thread_params));
+    thread_params.name = iree_make_cstring_view("iree-remoting-session");
+    status = iree_thread_create(iree_remoting_session_main, session,
+                                thread_params, host_allocator,
+                                &session->thread);
+    if (!iree_status_is_ok(status)) {
+      iree_hal_remoting_transport_destroy(transport);
+      iree_allocator_free(host_allocator, session);
+      break;
+    }
+    session->next = sessions;
+    sessions = session;
+  }
+  iree_remoting_reap_sessions(sessions, /*wait_all=*/true);
+  return status;
+}
+
+int main(int argc, char** argv) {
+  iree_flags_set_usage(
+      "iree-remoting-server",
+      "Serves the device selected with --device= to remoting clients.\n");
+  iree_flags_parse_checked(IREE_FLAGS_PARSE_MODE_DEFAULT, &argc, &argv);
+  iree_allocator_t host_allocator = iree_allocator_system();
+
+  iree_hal_device_t* device = NULL;
+  iree_status_t status = iree_hal_create_device_from_flags(
+      iree_hal_default_device_uri(), host_allocator, &device);
+  iree_hal_remoting_listener_t* listener = NULL;
+  if (iree_status_is_ok(status)) {
+    status = iree_hal_remoting_listener_create(
+        iree_make_cstring_view(FLAG_listen), host_allocator, &listener);
+  }
+  if (iree_status_is_ok(status)) {
+    fprintf(stdout, "serving %.*s on %s\n",
+            (int)iree_hal_device_id(device).size,
+            iree_hal_device_id(device).data, FLAG_listen);
+    fflush(stdout);
+    status = iree_remoting_serve_clients(device, listener);
+  }
+  iree_hal_remoting_listener_destroy(listener);
+  iree_hal_device_release(device);
+  if (!iree_status_is_ok(status)) {
+    iree_status_fprint(stderr, status);
+    iree_status_free(status);
+    return 1;
+  }
+  return 0;
+}
@@ -0,0 +1,751 @@
+// Copyright 2023 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include "experimental/remoting/transport.h"
+
+#include <stdio.h>
+#include <string.h>
+
+#include "iree/base/target_platform.h"
+#include "iree/base/tracing.h"
+
+#if defined(IREE_PLATFORM_ANDROID) || defined(IREE_PLATFORM_APPLE) || \
+    defined(IREE_PLATFORM_LINUX)
+#define IREE_HAL_REMOTING_HAVE_SOCKETS 1
+#endif  // IREE_PLATFORM_ANDROID || IREE_PLATFORM_APPLE || IREE_PLATFORM_LINUX
+
+#if defined(IREE_HAL_REMOTING_HAVE_SOCKETS)
+
+#include <errno.h>
+#include <fcntl.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/types.h>
+#include <sys/uio.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#if defined(IREE_PLATFORM_ANDROID) || defined(IREE_PLATFORM_LINUX)
+#include <sys/syscall.h>
+#if defined(SYS_memfd_create)
+// memfd_create is called via syscall as libc wrappers are only available in
+// newer glibc (2.27) and bionic (API 30) versions.
+#define IREE_HAL_REMOTING_HAVE_MEMFD 1
+#define IREE_HAL_REMOTING_MFD_CLOEXEC 0x0001U
+#endif  // SYS_memfd_create
+#endif  // IREE_PLATFORM_ANDROID || IREE_PLATFORM_LINUX
+
+#if !defined(MSG_NOSIGNAL)
+// Apple platforms use SO_NOSIGPIPE on the socket instead.
+#define MSG_NOSIGNAL 0
+#endif  // !MSG_NOSIGNAL
+
+struct iree_hal_remoting_transport_t {
+  iree_allocator_t host_allocator;
+  int fd;
+  // True if |fd| is a Unix domain socket and can pass file descriptors.
+  bool is_local;
+};
+
+struct iree_hal_remoting_listener_t {
+  iree_allocator_t host_allocator;
+  int fd;
+  bool is_local;
+  // Socket path unlinked when the listener is destroyed (unix: only).
+  char path[sizeof(((struct sockaddr_un*)0)->sun_path)];
+};
+
+//===----------------------------------------------------------------------===//
+// Endpoint parsing
+//===----------------------------------------------------------------------===//
+
+typedef enum iree_hal_remoting_endpoint_type_e {
+  IREE_HAL_REMOTING_ENDPOINT_TCP = 0,
+  IREE_HAL_REMOTING_ENDPOINT_UNIX,
+} iree_hal_remoting_endpoint_type_t;
+
+typedef struct iree_hal_remoting_endpoint_t {
+  iree_hal_remoting_endpoint_type_t type;
+  // NUL-terminated host (tcp:) or socket path (unix:).
+  char address[sizeof(((struct sockaddr_un*)0)->sun_path)];
+  // NUL-terminated port (tcp: only).
+  char port[8];
+} iree_hal_remoting_endpoint_t;
+
+static iree_status_t iree_hal_remoting_copy_cstring(iree_string_view_t value,
+                                                    char* buffer,
+                                                    iree_host_size_t capacity,
+                                                    const char* what) {
+  if (value.size == 0 || value.size >= capacity) {
+    return iree_make_status(IREE_STATUS_INVALID_ARGUMENT,
+                            "invalid endpoint %s '%.*s'", what,
+                            (int)value.size, value.data);
+  }
+  memcpy(buffer, value.data, value.size);
+  buffer[value.size] = 0;
+  return iree_ok_status();
+}
+
+static iree_status_t iree_hal_remoting_parse_endpoint(
+    iree_string_view_t endpoint, iree_hal_remoting_endpoint_t* out_endpoint) {
+  memset(out_endpoint, 0, sizeof(*out_endpoint));
+  iree_string_view_t scheme = iree_string_view_empty();
+  iree_string_view_t address = iree_string_view_empty();
+  if (iree_string_view_split(endpoint, ':', &scheme, &address) == -1) {
+    return iree_make_status(IREE_STATUS_INVALID_ARGUMENT,
+                            "endpoint '%.*s' must be `tcp:HOST:PORT` or "
+                            "`unix:PATH`",
+                            (int)endpoint.size, endpoint.data);
+  }
+  if (iree_string_view_equal(scheme, IREE_SV("unix"))) {
+    out_endpoint->type = IREE_HAL_REMOTING_ENDPOINT_UNIX;
+    return iree_hal_remoting_copy_cstring(address, out_endpoint->address,
+                                          sizeof(out_endpoint->address),
+                                          "path");
+  } else if (iree_string_view_equal(scheme, IREE_SV("tcp"))) {
+    out_endpoint->type = IREE_HAL_REMOTING_ENDPOINT_TCP;
+    iree_string_view_t host = iree_string_view_empty();
+    iree_string_view_t port = iree_string_view_empty();
+    if (iree_string_view_split(address, ':', &host, &port) == -1) {
+      // NOTE: IPv6 addresses must be given by host name as the address is
+      // split on the first ':'.
+      return iree_make_status(IREE_STATUS_INVALID_ARGUMENT,
+                              "tcp endpoint '%.*s' is missing a port",
+                              (int)endpoint.size, endpoint.data);
+    }
+    IREE_RETURN_IF_ERROR(iree_hal_remoting_copy_cstring(
+        host, out_endpoint->address, sizeof(out_endpoint->address), "host"));
+    return iree_hal_remoting_copy_cstring(port, out_endpoint->port,
+                                          sizeof(out_endpoint->port), "port");
+  }
+  return iree_make_status(IREE_STATUS_INVALID_ARGUMENT,
+                          "unsupported endpoint scheme '%.*s'",
+                          (int)scheme.size, scheme.data);
+}
+
+//===----------------------------------------------------------------------===//
+// iree_hal_remoting_transport_t
+//===----------------------------------------------------------------------===//
+
+static iree_status_t iree_hal_remoting_transport_wrap(
+    int fd, bool is_local, iree_allocator_t host_allocator,
+    iree_hal_remoting_transport_t** out_transport) {
+  if (!is_local) {
+    // Messages are small and latency sensitive; don't let Nagle hold them.
+    int value = 1;
+    setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &value, sizeof(value));
+  }
+#if defined(SO_NOSIGPIPE)
+  int nosigpipe = 1;
+  setsockopt(fd, SOL_SOCKET, SO_NOSIGPIPE, &nosigpipe, sizeof(nosigpipe));
+#endif  // SO_NOSIGPIPE
+
+  iree_hal_remoting_transport_t* transport = NULL;
+  iree_status_t status = iree_allocator_malloc(
+      host_allocator, sizeof(*transport), (void**)&transport);
+  if (iree_status_is_ok(status)) {
+    transport->host_allocator = host_allocator;
+    transport->fd = fd;
+    transport->is_local = is_local;
+    *out_transport = transport;
+  } else {
+    close(fd);
+  }
+  return status;
+}
+
+static iree_status_t iree_hal_remoting_connect_unix(const char* path,
+                                                    int* out_fd) {
+  int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+  if (fd < 0) {
+    return iree_make_status(iree_status_code_from_errno(errno),
+                            "failed to create socket");
+  }
+  struct sockaddr_un addr;
+  memset(&addr, 0, sizeof(addr));
+  addr.sun_family = AF_UNIX;
+  strncpy(addr.sun_path, path, sizeof(addr.sun_path) - 1);
+  if (connect(fd, (struct sockaddr*)&addr, sizeof(addr)) != 0) {
+    int error = errno;
+    close(fd);
+    return iree_make_status(iree_status_code_from_errno(error),
+                            "failed to connect to '%s'", path);
+  }
+  *out_fd = fd;
+  return iree_ok_status();
+}
+
+static iree_status_t iree_hal_remoting_connect_tcp(const char* host,
+                                                   const char* port,
+                                                   int* out_fd) {
+  struct addrinfo hints;
+  memset(&hints, 0, sizeof(hints));
+  hints.ai_family = AF_UNSPEC;
+  hints.ai_socktype = SOCK_STREAM;
+  struct addrinfo* results = NULL;
+  int error = getaddrinfo(host, port, &hints, &results);
+  if (error != 0) {
+    return iree_make_status(IREE_STATUS_NOT_FOUND,
+                            "failed to resolve '%s:%s': %s", host, port,
+                            gai_strerror(error));
+  }
+  int fd = -1;
+  int connect_errno = 0;
+  for (struct addrinfo* info = results; info; info = info->ai_next) {
+    fd = socket(info->ai_family, info->ai_socktype, info->ai_protocol);
+    if (fd < 0) {
+      connect_errno = errno;
+      continue;
+    }
+    if (connect(fd, info->ai_addr, info->ai_addrlen) == 0) break;
+    connect_errno = errno;
+    close(fd);
+    fd = -1;
+  }
+  freeaddrinfo(results);
+  if (fd < 0) {
+    return iree_make_status(iree_status_code_from_errno(connect_errno),
+                            "failed to connect to '%s:%s'", host, port);
+  }
+  *out_fd = fd;
+  return iree_ok_status();
+}
+
+IREE_API_EXPORT iree_status_t iree_hal_remoting_transport_connect(
+    iree_string_view_t endpoint, iree_allocator_t host_allocator,
+    iree_hal_remoting_transport_t** out_transport) {
+  IREE_ASSERT_ARGUMENT(out_transport);
+  *out_transport = NULL;
+  IREE_TRACE_ZONE_BEGIN(z0);
+  IREE_TRACE_ZONE_APPEND_TEXT(z0, endpoint.data, endpoint.size);
+
+  iree_hal_remoting_endpoint_t parsed;
+  IREE_RETURN_AND_END_ZONE_IF_ERROR(
+      z0, iree_hal_remoting_parse_endpoint(endpoint, &parsed));
+
+  int fd = -1;
+  const bool is_local = parsed.type == IREE_HAL_REMOTING_ENDPOINT_UNIX;
+  iree_status_t status =
+      is_local ? iree_hal_remoting_connect_unix(parsed.address, &fd)
+               : iree_hal_remoting_connect_tcp(parsed.address, parsed.port,
+                                               &fd);
+  if (iree_status_is_ok(status)) {
+    status = iree_hal_remoting_transport_wrap(fd, is_local, host_allocator,
+                                              out_transport);
+  }
+
+  IREE_TRACE_ZONE_END(z0);
+  return status;
+}
+
+IREE_API_EXPORT iree_status_t iree_hal_remoting_transport_create_pair(
+    iree_allocator_t host_allocator,
+    iree_hal_remoting_transport_t** out_client_transport,
+    iree_hal_remoting_transport_t** out_server_transport) {
+  IREE_ASSERT_ARGUMENT(out_client_transport);
+  IREE_ASSERT_ARGUMENT(out_server_transport);
+  *out_client_transport = NULL;
+  *out_server_transport = NULL;
+  IREE_TRACE_ZONE_BEGIN(z0);
+
+  int fds[2] = {-1, -1};
+  if (socketpair(AF_UNIX, SOCK_STREAM, 0, fds) != 0) {
+    IREE_TRACE_ZONE_END(z0);
+    return iree_make_status(iree_status_code_from_errno(errno),
+                            "failed to create socket pair");
+  }
+  iree_status_t status = iree_hal_remoting_transport_wrap(
+      fds[0], /*is_local=*/true, host_allocator, out_client_transport);
+  if (iree_status_is_ok(status)) {
+    status = iree_hal_remoting_transport_wrap(
+        fds[1], /*is_local=*/true, host_allocator, out_server_transport);
+    if (!iree_status_is_ok(status)) {
+      iree_hal_remoting_transport_destroy(*out_client_transport);
+      *out_client_transport = NULL;
+    }
+  } else {
+    close(fds[1]);
+  }
+
+  IREE_TRACE_ZONE_END(z0);
+  return status;
+}
+
+IREE_API_EXPORT void iree_hal_remoting_transport_destroy(
+    iree_hal_remoting_transport_t* transport) {
+  if (!transport) return;
+  IREE_TRACE_ZONE_BEGIN(z0);
+  close(transport->fd);
+  iree_allocator_free(transport->host_allocator, transport);
+  IREE_TRACE_ZONE_END(z0);
+}
+
+bool iree_hal_remoting_transport_is_local(
+    const iree_hal_remoting_transport_t* transport) {
+  return transport->is_local;
+}
+
+iree_status_t iree_hal_remoting_transport_send(
+    iree_hal_remoting_transport_t* transport,
+    iree_hal_remoting_message_type_t type,
+    iree_hal_remoting_message_flags_t flags, iree_host_size_t span_count,
+    const iree_const_byte_span_t* spans, int fd) {
+  if (span_count > IREE_HAL_REMOTING_MAX_PAYLOAD_SPANS) {
+    return iree_make_status(IREE_STATUS_OUT_OF_RANGE,
+                            "too many payload spans (%" PRIhsz ")", span_count);
+  }
+  if (fd != -1 && !transport->is_local) {
+    return iree_make_status(IREE_STATUS_FAILED_PRECONDITION,
+                            "file descriptors can only be passed over local "
+                            "transports");
+  }
+
+  iree_hal_remoting_message_header_t header;
+  memset(&header, 0, sizeof(header));
+  header.type = (uint16_t)type;
+  header.flags = flags | (fd != -1 ? IREE_HAL_REMOTING_MESSAGE_FLAG_FD : 0);
+
+  struct iovec iovs[1 + IREE_HAL_REMOTING_MAX_PAYLOAD_SPANS];
+  int iov_count = 0;
+  iovs[iov_count].iov_base = &header;
+  iovs[iov_count].iov_len = sizeof(header);
+  ++iov_count;
+  iree_host_size_t payload_length = 0;
+  for (iree_host_size_t i = 0; i < span_count; ++i) {
+    if (!spans[i].data_length) continue;
+    iovs[iov_count].iov_base = (void*)spans[i].data;
+    iovs[iov_count].iov_len = spans[i].data_length;
+    ++iov_count;
+    payload_length += spans[i].data_length;
+  }
+  if (payload_length > IREE_HAL_REMOTING_MAX_PAYLOAD_LENGTH) {
+    return iree_make_status(IREE_STATUS_OUT_OF_RANGE,
+                            "message payload of %" PRIhsz
+                            " bytes exceeds the maximum",
+                            payload_length);
+  }
+  header.payload_length = (uint32_t)payload_length;
+
+  // The descriptor is attached to the first chunk written; the peer receives
+  // it along with the header.
+  union {
+    struct cmsghdr align;
+    char data[CMSG_SPACE(sizeof(int))];
+  } control;
+  struct msghdr msg;
+  memset(&msg, 0, sizeof(msg));
+  msg.msg_iov = iovs;
+  msg.msg_iovlen = iov_count;
+  if (fd != -1) {
+    memset(&control, 0, sizeof(control));
+    msg.msg_control = control.data;
+    msg.msg_controllen = sizeof(control.data);
+    struct cmsghdr* cmsg = CMSG_FIRSTHDR(&msg);
+    cmsg->cmsg_level = SOL_SOCKET;
+    cmsg->cmsg_type = SCM_RIGHTS;
+    cmsg->cmsg_len = CMSG_LEN(sizeof(int));
+    memcpy(CMSG_DATA(cmsg), &fd, sizeof(int));
+  }
+
+  while (msg.msg_iovlen > 0) {
+    ssize_t sent = sendmsg(transport->fd, &msg, MSG_NOSIGNAL);
+    if (sent < 0) {
+      if (errno == EINTR) continue;
+      return iree_make_status(iree_status_code_from_errno(errno),
+                              "failed to send message");
+    }
+    msg.msg_control = NULL;
+    msg.msg_controllen = 0;
+    // Advance past the iovecs that were fully written.
+    size_t remaining = (size_t)sent;
+    while (msg.msg_iovlen > 0 && remaining >= msg.msg_iov[0].iov_len) {
+      remaining -= msg.msg_iov[0].iov_len;
+      ++msg.msg_iov;
+      --msg.msg_iovlen;
+    }
+    if (msg.msg_iovlen > 0) {
+      msg.msg_iov[0].iov_base = (uint8_t*)msg.msg_iov[0].iov_base + remaining;
+      msg.msg_iov[0].iov_len -= remaining;
+    }
+  }
+  return iree_ok_status();
+}
+
+iree_status_t iree_hal_remoting_transport_recv_header(
+    iree_hal_remoting_transport_t* transport,
+    iree_hal_remoting_message_header_t* out_header, int* out_fd) {
+  *out_fd = -1;
+  uint8_t* data = (uint8_t*)out_header;
+  size_t received = 0;
+  while (received < sizeof(*out_header)) {
+    struct iovec iov = {
+        .iov_base = data + received,
+        .iov_len = sizeof(*out_header) - received,
+    };
+    union {
+      struct cmsghdr align;
+      char data[CMSG_SPACE(sizeof(int))];
+    } control;
+    struct msghdr msg;
+    memset(&msg, 0, sizeof(msg));
+    msg.msg_iov = &iov;
+    msg.msg_iovlen = 1;
+    if (transport->is_local) {
+      msg.msg_control = control.data;
+      msg.msg_controllen = sizeof(control.data);
+    }
+    ssize_t result = recvmsg(transport->fd, &msg, 0);
+    if (result < 0) {
+      if (errno == EINTR) continue;
+      if (*out_fd != -1) close(*out_fd);
+      return iree_make_status(iree_status_code_from_errno(errno),
+                              "failed to receive message");
+    } else if (result == 0) {
+      if (*out_fd != -1) close(*out_fd);
+      return received == 0
+                 ? iree_status_from_code(IREE_STATUS_UNAVAILABLE)
+                 : iree_make_status(IREE_STATUS_DATA_LOSS,
+                                    "connection closed mid-message");
+    }
+    for (struct cmsghdr* cmsg = CMSG_FIRSTHDR(&msg); cmsg;
+         cmsg = CMSG_NXTHDR(&msg, cmsg)) {
+      if (cmsg->cmsg_level == SOL_SOCKET && cmsg->cmsg_type == SCM_RIGHTS &&
+          *out_fd == -1) {
+        memcpy(out_fd, CMSG_DATA(cmsg), sizeof(int));
+      }
+    }
+    received += (size_t)result;
+  }
+  return iree_ok_status();
+}
+
+iree_status_t iree_hal_remoting_transport_recv(
+    iree_hal_remoting_transport_t* transport, void* buffer,
+    iree_host_size_t length) {
+  uint8_t* data = (uint8_t*)buffer;
+  iree_host_size_t received = 0;
+  while (received < length) {
+    ssize_t result = recv(transport->fd, data + received, length - received, 0);
+    if (result < 0) {
+      if (errno == EINTR) continue;
+      return iree_make_status(iree_status_code_from_errno(errno),
+                              "failed to receive message payload");
+    } else if (result == 0) {
+      return iree_make_status(IREE_STATUS_DATA_LOSS,
+                              "connection closed mid-message");
+    }
+    received += (iree_host_size_t)result;
+  }
+  return iree_ok_status();
+}
+
+iree_status_t iree_hal_remoting_transport_skip(
+    iree_hal_remoting_transport_t* transport, iree_host_size_t length) {
+  uint8_t scratch[4096];
+  while (length > 0) {
+    iree_host_size_t chunk = iree_min(length, sizeof(scratch));
+    IREE_RETURN_IF_ERROR(
+        iree_hal_remoting_transport_recv(transport, scratch, chunk));
+    length -= chunk;
+  }
+  return iree_ok_status();
+}
+
+//===----------------------------------------------------------------------===//
+// iree_hal_remoting_listener_t
+//===----------------------------------------------------------------------===//
+
+static iree_status_t iree_hal_remoting_listen_unix(const char* path,
+                                                   int* out_fd) {
+  int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+  if (fd < 0) {
+    return iree_make_status(iree_status_code_from_errno(errno),
+                            "failed to create socket");
+  }
+  struct sockaddr_un addr;
+  memset(&addr, 0, sizeof(addr));
+  addr.sun_family = AF_UNIX;
+  strncpy(addr.sun_path, path, sizeof(addr.sun_path) - 1);
+  // Remove a stale socket left behind by a previous server.
+  unlink(path);
+  if (bind(fd, (struct sockaddr*)&addr, sizeof(addr)) != 0 ||
+      listen(fd, SOMAXCONN) != 0) {
+    int error = errno;
+    close(fd);
+    return iree_make_status(iree_status_code_from_errno(error),
+                            "failed to listen on '%s'", path);
+  }
+  *out_fd = fd;
+  return iree_ok_status();
+}
+
+static iree_status_t iree_hal_remoting_listen_tcp(const char* host,
+                                                  const char* port,
+                                                  int* out_fd) {
+  struct addrinfo hints;
+  memset(&hints, 0, sizeof(hints));
+  hints.ai_family = AF_UNSPEC;
+  hints.ai_socktype = SOCK_STREAM;
+  hints.ai_flags = AI_PASSIVE;
+  struct addrinfo* results = NULL;
+  int error = getaddrinfo(host, port, &hints, &results);
+  if (error != 0) {
+    return iree_make_status(IREE_STATUS_NOT_FOUND,
+                            "failed to resolve '%s:%s': %s", host, port,
+                            gai_strerror(error));
+  }
+  int fd = -1;
+  int listen_errno = 0;
+  for (struct addrinfo* info = results; info; info = info->ai_next) {
+    fd = socket(info->ai_family, info->ai_socktype, info->ai_protocol);
+    if (fd < 0) {
+      listen_errno = errno;
+      continue;
+    }
+    int reuse = 1;
+    setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+    if (bind(fd, info->ai_addr, info->ai_addrlen) == 0 &&
+        listen(fd, SOMAXCONN) == 0) {
+      break;
+    }
+    listen_errno = errno;
+    close(fd);
+    fd = -1;
+  }
+  freeaddrinfo(results);
+  if (fd < 0) {
+    return iree_make_status(iree_status_code_from_errno(listen_errno),
+                            "failed to listen on '%s:%s'", host, port);
+  }
+  *out_fd = fd;
+  return iree_ok_status();
+}
+
+IREE_API_EXPORT iree_status_t iree_hal_remoting_listener_create(
+    iree_string_view_t endpoint, iree_allocator_t host_allocator,
+    iree_hal_remoting_listener_t** out_listener) {
+  IREE_ASSERT_ARGUMENT(out_listener);
+  *out_listener = NULL;
+  IREE_TRACE_ZONE_BEGIN(z0);
+  IREE_TRACE_ZONE_APPEND_TEXT(z0, endpoint.data, endpoint.size);
+
+  iree_hal_remoting_endpoint_t parsed;
+  IREE_RETURN_AND_END_ZONE_IF_ERROR(
+      z0, iree_hal_remoting_parse_endpoint(endpoint, &parsed));
+
+  int fd = -1;
+  const bool is_local = parsed.type == IREE_HAL_REMOTING_ENDPOINT_UNIX;
+  iree_status_t status =
+      is_local ? iree_hal_remoting_listen_unix(parsed.address, &fd)
+               : iree_hal_remoting_listen_tcp(parsed.address, parsed.port, &fd);
+
+  iree_hal_remoting_listener_t* listener = NULL;
+  if (iree_status_is_ok(status)) {
+    status = iree_allocator_malloc(host_allocator, sizeof(*listener),
+                                   (void**)&listener);
+  }
+  if (iree_status_is_ok(status)) {
+    memset(listener, 0, sizeof(*listener));
+    listener->host_allocator = host_allocator;
+    listener->fd = fd;
+    listener->is_local = is_local;
+    if (is_local) {
+      memcpy(listener->path, parsed.address, sizeof(listener->path));
+    }
+    *out_listener = listener;
+  } else if (fd != -1) {
+    close(fd);
+  }
+
+  IREE_TRACE_ZONE_END(z0);
+  return status;
+}
+
+IREE_API_EXPORT iree_status_t iree_hal_remoting_listener_accept(
+    iree_hal_remoting_listener_t* listener,
+    iree_hal_remoting_transport_t** out_transport) {
+  IREE_ASSERT_ARGUMENT(listener);
+  IREE_ASSERT_ARGUMENT(out_transport);
+  *out_transport = NULL;
+  int fd = -1;
+  do {
+    fd = accept(listener->fd, NULL, NULL);
+  } while (fd < 0 && errno == EINTR);
+  if (fd < 0) {
+    return iree_make_status(iree_status_code_from_errno(errno),
+                            "failed to accept connection");
+  }
+  return iree_hal_remoting_transport_wrap(fd, listener->is_local,
+                                          listener->host_allocator,
+                                          out_transport);
+}
+
+IREE_API_EXPORT void iree_hal_remoting_listener_destroy(
+    iree_hal_remoting_listener_t* listener) {
+  if (!listener) return;
+  IREE_TRACE_ZONE_BEGIN(z0);
+  close(listener->fd);
+  if (listener->is_local) unlink(listener->path);
+  iree_allocator_free(listener->host_allocator, listener);
+  IREE_TRACE_ZONE_END(z0);
+}
+
+//===----------------------------------------------------------------------===//
+// Shared memory
+//===----------------------------------------------------------------------===//
+
+iree_status_t iree_hal_remoting_shared_memory_create(iree_host_size_t size,
+                                                     int* out_fd,
+                                                     void** out_ptr) {
+  *out_fd = -1;
+  *out_ptr = NULL;
+#if defined(IREE_HAL_REMOTING_HAVE_MEMFD)
+  int fd = (int)syscall(SYS_memfd_create, "iree_hal_remoting",
+                        IREE_HAL_REMOTING_MFD_CLOEXEC);
+  if (fd < 0) {
+    return iree_make_status(IREE_STATUS_UNAVAILABLE,
+                            "memfd_create unavailable (%d)", errno);
+  }
+  if (ftruncate(fd, (off_t)size) != 0) {
+    int error = errno;
+    close(fd);
+    return iree_make_status(iree_status_code_from_errno(error),
+                            "failed to size shared memory");
+  }
+  iree_status_t status = iree_hal_remoting_shared_memory_map(fd, size, out_ptr);
+  if (iree_status_is_ok(status)) {
+    *out_fd = fd;
+  } else {
+    close(fd);
+  }
+  return status;
+#else
+  return iree_make_status(IREE_STATUS_UNAVAILABLE,
+                          "shared memory not available on this platform");
+#endif  // IREE_HAL_REMOTING_HAVE_MEMFD
+}
+
+iree_status_t iree_hal_remoting_shared_memory_map(int fd, iree_host_size_t size,
+                                                  void** out_ptr) {
+  void* ptr = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  if (ptr == MAP_FAILED) {
+    *out_ptr = NULL;
+    return iree_make_status(iree_status_code_from_errno(errno),
+                            "failed to map %" PRIhsz " bytes of shared memory",
+                            size);
+  }
+  *out_ptr = ptr;
+  return iree_ok_status();
+}
+
+void iree_hal_remoting_shared_memory_unmap(void* ptr, iree_host_size_t size) {
+  if (ptr) munmap(ptr, size);
+}
+
+void iree_hal_remoting_close_fd(int fd) {
+  if (fd != -1) close(fd);
+}
+
+#else
+
+struct iree_hal_remoting_transport_t {
+  int reserved;
+};
+
+IREE_API_EXPORT iree_status_t iree_hal_remoting_transport_connect(
+    iree_string_view_t endpoint, iree_allocator_t host_allocator,
+    iree_hal_remoting_transport_t** out_transport) {
+  *out_transport = NULL;
+  return iree_make_status(IREE_STATUS_UNIMPLEMENTED,
+                          "remoting transports not available on this platform");
+}
+
+IREE_API_EXPORT iree_status_t iree_hal_remoting_transport_create_pair(
+    iree_allocator_t host_allocator,
+    iree_hal_remoting_transport_t** out_client_transport,
+    iree_hal_remoting_transport_t** out_server_transport) {
+  *out_client_transport = NULL;
+  *out_server_transport = NULL;
+  return iree_make_status(IREE_STATUS_UNIMPLEMENTED,
+                          "remoting transports not available on this platform");
+}
+
+IREE_API_EXPORT void iree_hal_remoting_transport_destroy(
+    iree_hal_remoting_transport_t* transport) {}
+
+bool iree_hal_remoting_transport_is_local(
+    const iree_hal_remoting_transport_t* transport) {
+  return false;
+}
+
+iree_status_t iree_hal_remoting_transport_send(
+    iree_hal_remoting_transport_t* transport,
+    iree_hal_remoting_message_type_t type,
+    iree_hal_remoting_message_flags_t flags, iree_host_size_t span_count,
+    const iree_const_byte_span_t* spans, int fd) {
+  return iree_make_status(IREE_STATUS_UNIMPLEMENTED);
+}
+
+iree_status_t iree_hal_remoting_transport_recv_header(
+    iree_hal_remoting_transport_t* transport,
+    iree_hal_remoting_message_header_t* out_header, int* out_fd) {
+  *out_fd = -1;
+  return iree_make_status(IREE_STATUS_UNIMPLEMENTED);
+}
+
+iree_status_t iree_hal_remoting_transport_recv(
+    iree_hal_remoting_transport_t* transport, void* buffer,
+    iree_host_size_t length) {
+  return iree_make_status(IREE_STATUS_UNIMPLEMENTED);
+}
+
+iree_status_t iree_hal_remoting_transport_skip(
+    iree_hal_remoting_transport_t* transport, iree_host_size_t length) {
+  return iree_make_status(IREE_STATUS_UNIMPLEMENTED);
+}
+
+IREE_API_EXPORT iree_status_t iree_hal_remoting_listener_create(
+    iree_string_view_t endpoint, iree_allocator_t host_allocator,
+    iree_hal_remoting_listener_t** out_listener) {
+  *out_listener = NULL;
+  return iree_make_status(IREE_STATUS_UNIMPLEMENTED,
+                          "remoting transports not available on this platform");
+}
+
+IREE_API_EXPORT iree_status_t iree_hal_remoting_listener_accept(
+    iree_hal_remoting_listener_t* listener,
+    iree_hal_remoting_transport_t** out_transport) {
+  *out_transport = NULL;
+  return iree_make_status(IREE_STATUS_UNIMPLEMENTED);
+}
+
+IREE_API_EXPORT void iree_hal_remoting_listener_destroy(
+    iree_hal_remoting_listener_t* listener) {}
+
+iree_status_t iree_hal_remoting_shared_memory_create(iree_host_size_t size,
+                                                     int* out_fd,
+                                                     void** out_ptr) {
+  *out_fd = -1;
+  *out_ptr = NULL;
+  return iree_make_status(IREE_STATUS_UNAVAILABLE,
+                          "shared memory not available on this platform");
+}
+
+iree_status_t iree_hal_remoting_shared_memory_map(int fd, iree_host_size_t size,
+                                                  void** out_ptr) {
+  *out_ptr = NULL;
+  return iree_make_status(IREE_STATUS_UNAVAILABLE,
+                          "shared memory not available on this platform");
+}
+
+void iree_hal_remoting_shared_memory_unmap(void* ptr, iree_host_size_t size) {}
+
+void iree_hal_remoting_close_fd(int fd) {}
+
+#endif  // IREE_HAL_REMOTING_HAVE_SOCKETS
@@ -0,0 +1,81 @@
+// Copyright 2023 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#ifndef IREE_HAL_REMOTING_TRANSPORT_H_
+#define IREE_HAL_REMOTING_TRANSPORT_H_
+
+#include "experimental/remoting/api.h"
+#include "experimental/remoting/protocol.h"
+#include "iree/base/api.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif  // __cplusplus
+
+// Maximum number of payload spans that can be sent in a single message.
+#define IREE_HAL_REMOTING_MAX_PAYLOAD_SPANS 8
+
+// Returns true if |transport| connects processes on the same host and can pass
+// file descriptors (and with them shared memory) along with messages.
+bool iree_hal_remoting_transport_is_local(
+    const iree_hal_remoting_transport_t* transport);
+
+// Sends a message of |type| with a payload formed by concatenating |spans|.
+// If |fd| is not -1 it is passed to the peer (local transports only) and
+// IREE_HAL_REMOTING_MESSAGE_FLAG_FD is added to |flags|. The descriptor remains
+// owned by the caller.
+//
+// Not thread-safe: callers must serialize sends on the transport.
+iree_status_t iree_hal_remoting_transport_send(
+    iree_hal_remoting_transport_t* transport,
+    iree_hal_remoting_message_type_t type,
+    iree_hal_remoting_message_flags_t flags, iree_host_size_t span_count,
+    const iree_const_byte_span_t* spans, int fd);
+
+// Receives the header of the next message. If the message carries a file
+// descriptor it is returned in |out_fd| (otherwise -1) and ownership passes to
+// the caller. Returns IREE_STATUS_UNAVAILABLE if the peer closed the
+// connection cleanly between messages.
+//
+// Not thread-safe: callers must serialize receives on the transport.
+iree_status_t iree_hal_remoting_transport_recv_header(
+    iree_hal_remoting_transport_t* transport,
+    iree_hal_remoting_message_header_t* out_header, int* out_fd);
+
+// Receives exactly |length| bytes of the current message payload.
+iree_status_t iree_hal_remoting_transport_recv(
+    iree_hal_remoting_transport_t* transport, void* buffer,
+    iree_host_size_t length);
+
+// Receives and drops |length| bytes of the current message payload.
+iree_status_t iree_hal_remoting_transport_skip(
+    iree_hal_remoting_transport_t* transport, iree_host_size_t length);
+
+//===----------------------------------------------------------------------===//
+// Shared memory
+//===----------------------------------------------------------------------===//
+
+// Creates an anonymous shared memory object of |size| bytes and maps it.
+// Returns IREE_STATUS_UNAVAILABLE if shared memory is not supported.
+iree_status_t iree_hal_remoting_shared_memory_create(iree_host_size_t size,
+                                                     int* out_fd,
+                                                     void** out_ptr);
+
+// Maps |size| bytes of the shared memory object |fd| received from a peer.
+iree_status_t iree_hal_remoting_shared_memory_map(int fd, iree_host_size_t size,
+                                                  void** out_ptr);
+
+// Unmaps memory returned by iree_hal_remoting_shared_memory_create/map.
+void iree_hal_remoting_shared_memory_unmap(void* ptr, iree_host_size_t size);
+
+// Closes a file descriptor received from or to be sent to a peer.
+void iree_hal_remoting_close_fd(int fd);
+
+#ifdef __cplusplus
+}  // extern "C"
+#endif  // __cplusplus
+
+#endif  // IREE_HAL_REMOTING_TRANSPORT_H_
@@ -18,15 +18,21 @@
 #include "iree/base/api.h"
 #include "iree/base/tracing.h"
 
-// Command buffer implementation that directly maps to rocm direct.
+// Command buffer implementation that directly issues commands to a HIP stream.
 // This records the commands on the calling thread without additional threading
 // indirection.
+//
+// Work issued to the stream executes in order and as such execution barriers
+// and events require no additional synchronization.
 
 typedef struct {
   iree_hal_command_buffer_t base;
   iree_hal_rocm_context_wrapper_t* context;
   iree_arena_block_pool_t* block_pool;
 
+  // Stream all commands are issued to. Not owned.
+  hipStream_t stream;
+
   // Keep track of the current set of kernel arguments.
   int32_t push_constant[IREE_HAL_ROCM_MAX_PUSH_CONSTANT_COUNT];
   void* current_descriptor[];
@@ -51,7 +57,7 @@ iree_status_t iree_hal_rocm_direct_command_buffer_create(
     iree_hal_command_buffer_mode_t mode,
     iree_hal_command_category_t command_categories,
     iree_hal_queue_affinity_t queue_affinity, iree_host_size_t binding_capacity,
-    iree_arena_block_pool_t* block_pool,
+    iree_arena_block_pool_t* block_pool, hipStream_t stream,
     iree_hal_command_buffer_t** out_command_buffer) {
   IREE_ASSERT_ARGUMENT(context);
   IREE_ASSERT_ARGUMENT(block_pool);
@@ -77,6 +83,7 @@ iree_status_t iree_hal_rocm_direct_command_buffer_create(
         &iree_hal_rocm_direct_command_buffer_vtable, &command_buffer->base);
     command_buffer->context = context;
     command_buffer->block_pool = block_pool;
+    command_buffer->stream = stream;
     hipDeviceptr_t* device_ptrs =
         (hipDeviceptr_t*)(command_buffer->current_descriptor +
                           IREE_HAL_ROCM_MAX_KERNEL_ARG);
@@ -148,21 +155,21 @@ static iree_status_t iree_hal_rocm_direct_command_buffer_execution_barrier(
     const iree_hal_memory_barrier_t* memory_barriers,
     iree_host_size_t buffer_barrier_count,
     const iree_hal_buffer_barrier_t* buffer_barriers) {
-  // TODO: Implement barrier
+  // Nothing to do: all work on the stream executes in order.
   return iree_ok_status();
 }
 
 static iree_status_t iree_hal_rocm_direct_command_buffer_signal_event(
     iree_hal_command_buffer_t* base_command_buffer, iree_hal_event_t* event,
     iree_hal_execution_stage_t source_stage_mask) {
-  // TODO: Implement barrier
+  // Nothing to do: all work on the stream executes in order.
   return iree_ok_status();
 }
 
 static iree_status_t iree_hal_rocm_direct_command_buffer_reset_event(
     iree_hal_command_buffer_t* base_command_buffer, iree_hal_event_t* event,
     iree_hal_execution_stage_t source_stage_mask) {
-  // TODO: Implement barrier
+  // Nothing to do: all work on the stream executes in order.
   return iree_ok_status();
 }
 
@@ -175,7 +182,7 @@ static iree_status_t iree_hal_rocm_direct_command_buffer_wait_events(
     const iree_hal_memory_barrier_t* memory_barriers,
     iree_host_size_t buffer_barrier_count,
     const iree_hal_buffer_barrier_t* buffer_barriers) {
-  // TODO: Implement barrier
+  // Nothing to do: all work on the stream executes in order.
   return iree_ok_status();
 }
 
@@ -198,27 +205,28 @@ static iree_status_t iree_hal_rocm_direct_command_buffer_fill_buffer(
   target_offset += iree_hal_buffer_byte_offset(target_buffer);
   hipDeviceptr_t dst = target_device_buffer + target_offset;
   size_t num_elements = length / pattern_length;
-  // TODO(raikonenfnu): Currently using NULL stream, need to figure out way to
-  // access proper stream from command buffer
   switch (pattern_length) {
     case 4: {
       ROCM_RETURN_IF_ERROR(
           command_buffer->context->syms,
-          hipMemsetD32Async(dst, *(const uint32_t*)(pattern), num_elements, 0),
+          hipMemsetD32Async(dst, *(const uint32_t*)(pattern), num_elements,
+                            command_buffer->stream),
           "hipMemsetD32Async");
       break;
     }
     case 2: {
       ROCM_RETURN_IF_ERROR(
           command_buffer->context->syms,
-          hipMemsetD16Async(dst, *(const uint16_t*)(pattern), num_elements, 0),
+          hipMemsetD16Async(dst, *(const uint16_t*)(pattern), num_elements,
+                            command_buffer->stream),
           "hipMemsetD16Async");
       break;
     }
     case 1: {
       ROCM_RETURN_IF_ERROR(
           command_buffer->context->syms,
-          hipMemsetD8Async(dst, *(const uint8_t*)(pattern), num_elements, 0),
+          hipMemsetD8Async(dst, *(const uint8_t*)(pattern), num_elements,
+                           command_buffer->stream),
           "hipMemsetD*Async");
       break;
     }
@@ -233,8 +241,24 @@ static iree_status_t iree_hal_rocm_direct_command_buffer_update_buffer(
     iree_hal_command_buffer_t* base_command_buffer, const void* source_buffer,
     iree_host_size_t source_offset, iree_hal_buffer_t* target_buffer,
     iree_device_size_t target_offset, iree_device_size_t length) {
-  return iree_make_status(IREE_STATUS_UNIMPLEMENTED,
-                          "need rocm implementation");
+  iree_hal_rocm_direct_command_buffer_t* command_buffer =
+      iree_hal_rocm_direct_command_buffer_cast(base_command_buffer);
+
+  // NOTE: the copy is asynchronous and the source memory must remain valid
+  // until the stream has executed it. Deferred command buffers replayed onto
+  // this command buffer own their update data and are kept live until their
+  // submission completes.
+  hipDeviceptr_t target_device_buffer = iree_hal_rocm_buffer_device_pointer(
+      iree_hal_buffer_allocated_buffer(target_buffer));
+  target_offset += iree_hal_buffer_byte_offset(target_buffer);
+  hipDeviceptr_t dst = (uint8_t*)target_device_buffer + target_offset;
+  const uint8_t* src = (const uint8_t*)source_buffer + source_offset;
+  ROCM_RETURN_IF_ERROR(
+      command_buffer->context->syms,
+      hipMemcpyAsync(dst, src, length, hipMemcpyHostToDevice,
+                     command_buffer->stream),
+      "hipMemcpyAsync");
+  return iree_ok_status();
 }
 
 static iree_status_t iree_hal_rocm_direct_command_buffer_copy_buffer(
@@ -253,11 +277,10 @@ static iree_status_t iree_hal_rocm_direct_command_buffer_copy_buffer(
   source_offset += iree_hal_buffer_byte_offset(source_buffer);
   hipDeviceptr_t dst = target_device_buffer + target_offset;
   hipDeviceptr_t src = source_device_buffer + source_offset;
-  // TODO(raikonenfnu): Currently using NULL stream, need to figure out way to
-  // access proper stream from command buffer
   ROCM_RETURN_IF_ERROR(
       command_buffer->context->syms,
-      hipMemcpyAsync(dst, src, length, hipMemcpyDeviceToDevice, 0),
+      hipMemcpyAsync(dst, src, length, hipMemcpyDeviceToDevice,
+                     command_buffer->stream),
       "hipMemcpyAsync");
   return iree_ok_status();
 }
@@ -361,12 +384,11 @@ static iree_status_t iree_hal_rocm_direct_command_buffer_dispatch(
       executable, entry_point, &block_size_x, &block_size_y, &block_size_z));
   hipFunction_t func =
       iree_hal_rocm_native_executable_for_entry_point(executable, entry_point);
-  // TODO(raikonenfnu): Currently using NULL stream, need to figure out way to
-  // access proper stream from command buffer
   ROCM_RETURN_IF_ERROR(
       command_buffer->context->syms,
       hipModuleLaunchKernel(func, workgroup_x, workgroup_y, workgroup_z,
-                            block_size_x, block_size_y, block_size_z, 0, 0,
+                            block_size_x, block_size_y, block_size_z, 0,
+                            command_buffer->stream,
                             command_buffer->current_descriptor, NULL),
       "hipModuleLaunchKernel");
   return iree_ok_status();
@@ -31,13 +31,15 @@ typedef struct {
   void** kernelParams;
 } hip_launch_params;
 
-// Creates a rocm direct command buffer.
+// Creates a rocm direct command buffer that issues all commands to |stream| as
+// they are recorded. The |stream| must remain valid for the lifetime of the
+// command buffer.
 iree_status_t iree_hal_rocm_direct_command_buffer_create(
     iree_hal_device_t* device, iree_hal_rocm_context_wrapper_t* context,
     iree_hal_command_buffer_mode_t mode,
     iree_hal_command_category_t command_categories,
     iree_hal_queue_affinity_t queue_affinity, iree_host_size_t binding_capacity,
-    iree_arena_block_pool_t* block_pool,
+    iree_arena_block_pool_t* block_pool, hipStream_t stream,
     iree_hal_command_buffer_t** out_command_buffer);
 
 // Returns true if |command_buffer| is a ROCM command buffer.
@@ -6,16 +6,54 @@
 
 #include "experimental/rocm/event_semaphore.h"
 
+#include <inttypes.h>
 #include <stddef.h>
+#include <string.h>
 
 #include "iree/base/api.h"
 #include "iree/base/tracing.h"
 #include "iree/hal/utils/semaphore_base.h"
 
+// Sentinel used the semaphore has failed and an error status is set.
+#define IREE_HAL_ROCM_SEMAPHORE_FAILURE_VALUE UINT64_MAX
+
+// A device signal recorded on a stream that will reach |value| once |event|
+// completes. Kept in a singly-linked list ordered by increasing value.
+typedef struct iree_hal_rocm_semaphore_event_t {
+  struct iree_hal_rocm_semaphore_event_t* next;
+  uint64_t value;
+  hipEvent_t event;
+} iree_hal_rocm_semaphore_event_t;
+
 typedef struct iree_hal_rocm_semaphore_t {
   iree_hal_semaphore_t base;
   iree_hal_rocm_context_wrapper_t* context;
-  iree_atomic_int64_t value;
+
+  // Shared across all semaphores created by the device; posted whenever the
+  // value of any of them changes.
+  iree_notification_t* notification;
+
+  // Guards all mutable fields. We expect low contention on semaphores and since
+  // iree_slim_mutex_t is (effectively) just a CAS this keeps things simpler
+  // than trying to make the entire structure lock-free.
+  iree_slim_mutex_t mutex;
+
+  // Current signaled value. May be IREE_HAL_ROCM_SEMAPHORE_FAILURE_VALUE to
+  // indicate that the semaphore has been signaled for failure and
+  // |failure_status| contains the error.
+  uint64_t current_value;
+
+  // OK or the status passed to iree_hal_semaphore_fail. Owned by the semaphore.
+  iree_status_t failure_status;
+
+  // Device signals that have been recorded on streams in increasing value
+  // order. Entries at or below |current_value| are retired lazily as HIP APIs
+  // cannot be called from the stream host callbacks that advance the value.
+  iree_hal_rocm_semaphore_event_t* pending_head;
+  iree_hal_rocm_semaphore_event_t* pending_tail;
+
+  // Retired entries with their HIP events kept for reuse.
+  iree_hal_rocm_semaphore_event_t* free_head;
 } iree_hal_rocm_semaphore_t;
 
 static const iree_hal_semaphore_vtable_t iree_hal_rocm_semaphore_vtable;
@@ -26,11 +64,17 @@ static iree_hal_rocm_semaphore_t* iree_hal_rocm_semaphore_cast(
   return (iree_hal_rocm_semaphore_t*)base_value;
 }
 
+bool iree_hal_rocm_semaphore_isa(iree_hal_semaphore_t* semaphore) {
+  return iree_hal_resource_is(semaphore, &iree_hal_rocm_semaphore_vtable);
+}
+
 iree_status_t iree_hal_rocm_semaphore_create(
-    iree_hal_rocm_context_wrapper_t* context, uint64_t initial_value,
-    iree_hal_semaphore_t** out_semaphore) {
+    iree_hal_rocm_context_wrapper_t* context, iree_notification_t* notification,
+    uint64_t initial_value, iree_hal_semaphore_t** out_semaphore) {
   IREE_ASSERT_ARGUMENT(context);
+  IREE_ASSERT_ARGUMENT(notification);
   IREE_ASSERT_ARGUMENT(out_semaphore);
+  *out_semaphore = NULL;
   IREE_TRACE_ZONE_BEGIN(z0);
 
   iree_hal_rocm_semaphore_t* semaphore = NULL;
@@ -40,6 +84,13 @@ iree_status_t iree_hal_rocm_semaphore_create(
     iree_hal_semaphore_initialize(&iree_hal_rocm_semaphore_vtable,
                                   &semaphore->base);
     semaphore->context = context;
+    semaphore->notification = notification;
+    iree_slim_mutex_initialize(&semaphore->mutex);
+    semaphore->current_value = initial_value;
+    semaphore->failure_status = iree_ok_status();
+    semaphore->pending_head = NULL;
+    semaphore->pending_tail = NULL;
+    semaphore->free_head = NULL;
     *out_semaphore = &semaphore->base;
   }
 
@@ -47,6 +98,21 @@ iree_status_t iree_hal_rocm_semaphore_create(
   return status;
 }
 
+static void iree_hal_rocm_semaphore_free_event_list(
+    iree_hal_rocm_semaphore_t* semaphore,
+    iree_hal_rocm_semaphore_event_t* list_head) {
+  iree_allocator_t host_allocator = semaphore->context->host_allocator;
+  while (list_head) {
+    iree_hal_rocm_semaphore_event_t* next = list_head->next;
+    // NOTE: destroying an event with outstanding work is allowed; resources
+    // are released once the work completes.
+    ROCM_IGNORE_ERROR(semaphore->context->syms,
+                      hipEventDestroy(list_head->event));
+    iree_allocator_free(host_allocator, list_head);
+    list_head = next;
+  }
+}
+
 static void iree_hal_rocm_semaphore_destroy(
     iree_hal_semaphore_t* base_semaphore) {
   iree_hal_rocm_semaphore_t* semaphore =
@@ -54,6 +120,12 @@ static void iree_hal_rocm_semaphore_destroy(
   iree_allocator_t host_allocator = semaphore->context->host_allocator;
   IREE_TRACE_ZONE_BEGIN(z0);
 
+  iree_hal_rocm_semaphore_free_event_list(semaphore, semaphore->pending_head);
+  iree_hal_rocm_semaphore_free_event_list(semaphore, semaphore->free_head);
+
+  iree_slim_mutex_deinitialize(&semaphore->mutex);
+  iree_status_ignore(semaphore->failure_status);
+
   iree_hal_semaphore_deinitialize(&semaphore->base);
   iree_allocator_free(host_allocator, semaphore);
 
@@ -64,19 +136,50 @@ static iree_status_t iree_hal_rocm_semaphore_query(
     iree_hal_semaphore_t* base_semaphore, uint64_t* out_value) {
   iree_hal_rocm_semaphore_t* semaphore =
       iree_hal_rocm_semaphore_cast(base_semaphore);
-  // TODO: Support semaphores completely.
-  *out_value =
-      iree_atomic_load_int64(&semaphore->value, iree_memory_order_acquire);
-  return iree_ok_status();
+
+  iree_slim_mutex_lock(&semaphore->mutex);
+
+  *out_value = semaphore->current_value;
+
+  iree_status_t status = iree_ok_status();
+  if (*out_value >= IREE_HAL_ROCM_SEMAPHORE_FAILURE_VALUE) {
+    status = iree_status_clone(semaphore->failure_status);
+  }
+
+  iree_slim_mutex_unlock(&semaphore->mutex);
+
+  return status;
 }
 
+// NOTE: this may be called from HIP stream host callbacks and must not make
+// any HIP API calls.
 static iree_status_t iree_hal_rocm_semaphore_signal(
     iree_hal_semaphore_t* base_semaphore, uint64_t new_value) {
   iree_hal_rocm_semaphore_t* semaphore =
       iree_hal_rocm_semaphore_cast(base_semaphore);
-  // TODO: Support semaphores completely. Return OK currently as everything is
-  // synchronized for each submit to allow things to run.
-  iree_hal_semaphore_poll(&semaphore->base);
+
+  iree_slim_mutex_lock(&semaphore->mutex);
+
+  if (new_value <= semaphore->current_value) {
+    uint64_t current_value IREE_ATTRIBUTE_UNUSED = semaphore->current_value;
+    iree_slim_mutex_unlock(&semaphore->mutex);
+    return iree_make_status(IREE_STATUS_OUT_OF_RANGE,
+                            "semaphore values must be monotonically "
+                            "increasing; current_value=%" PRIu64
+                            ", new_value=%" PRIu64,
+                            current_value, new_value);
+  }
+
+  semaphore->current_value = new_value;
+
+  iree_slim_mutex_unlock(&semaphore->mutex);
+
+  // Notify timepoints of the new value.
+  iree_hal_semaphore_notify(&semaphore->base, new_value, IREE_STATUS_OK);
+
+  // Post a notification so that any waiter will wake.
+  iree_notification_post(semaphore->notification, IREE_ALL_WAITERS);
+
   return iree_ok_status();
 }
 
@@ -84,9 +187,45 @@ static void iree_hal_rocm_semaphore_fail(iree_hal_semaphore_t* base_semaphore,
                                          iree_status_t status) {
   iree_hal_rocm_semaphore_t* semaphore =
       iree_hal_rocm_semaphore_cast(base_semaphore);
-  // TODO: save status and mark timepoint as failed.
-  iree_status_ignore(status);
-  iree_hal_semaphore_poll(&semaphore->base);
+  const iree_status_code_t status_code = iree_status_code(status);
+
+  iree_slim_mutex_lock(&semaphore->mutex);
+
+  // Try to set our local status - we only preserve the first failure so only
+  // do this if we are going from a valid semaphore to a failed one.
+  if (!iree_status_is_ok(semaphore->failure_status)) {
+    // Previous status was not OK; drop our new status.
+    IREE_IGNORE_ERROR(status);
+    iree_slim_mutex_unlock(&semaphore->mutex);
+    return;
+  }
+
+  // Signal to our failure sentinel value.
+  semaphore->current_value = IREE_HAL_ROCM_SEMAPHORE_FAILURE_VALUE;
+  semaphore->failure_status = status;
+
+  iree_slim_mutex_unlock(&semaphore->mutex);
+
+  // Notify timepoints of the failure.
+  iree_hal_semaphore_notify(&semaphore->base,
+                            IREE_HAL_ROCM_SEMAPHORE_FAILURE_VALUE, status_code);
+
+  iree_notification_post(semaphore->notification, IREE_ALL_WAITERS);
+}
+
+typedef struct iree_hal_rocm_semaphore_notify_state_t {
+  iree_hal_rocm_semaphore_t* semaphore;
+  uint64_t value;
+} iree_hal_rocm_semaphore_notify_state_t;
+
+static bool iree_hal_rocm_semaphore_is_signaled(
+    iree_hal_rocm_semaphore_notify_state_t* state) {
+  iree_hal_rocm_semaphore_t* semaphore = state->semaphore;
+  iree_slim_mutex_lock(&semaphore->mutex);
+  bool is_signaled = semaphore->current_value >= state->value ||
+                     !iree_status_is_ok(semaphore->failure_status);
+  iree_slim_mutex_unlock(&semaphore->mutex);
+  return is_signaled;
 }
 
 static iree_status_t iree_hal_rocm_semaphore_wait(
@@ -94,10 +233,283 @@ static iree_status_t iree_hal_rocm_semaphore_wait(
     iree_timeout_t timeout) {
   iree_hal_rocm_semaphore_t* semaphore =
       iree_hal_rocm_semaphore_cast(base_semaphore);
-  // TODO: Support semaphores completely. Return OK currently as everything is
-  // synchronized for each submit to allow things to run.
-  iree_hal_semaphore_poll(&semaphore->base);
-  return iree_ok_status();
+
+  // Try to see if we can return immediately.
+  iree_slim_mutex_lock(&semaphore->mutex);
+  if (!iree_status_is_ok(semaphore->failure_status)) {
+    // Fastest path: failed; return an error to tell callers to query for it.
+    iree_slim_mutex_unlock(&semaphore->mutex);
+    return iree_status_from_code(IREE_STATUS_ABORTED);
+  } else if (semaphore->current_value >= value) {
+    // Fast path: already satisfied.
+    iree_slim_mutex_unlock(&semaphore->mutex);
+    return iree_ok_status();
+  } else if (iree_timeout_is_immediate(timeout)) {
+    // Not satisfied but a poll, so can avoid the expensive wait handle work.
+    iree_slim_mutex_unlock(&semaphore->mutex);
+    return iree_status_from_code(IREE_STATUS_DEADLINE_EXCEEDED);
+  }
+  iree_slim_mutex_unlock(&semaphore->mutex);
+
+  // Device signals advance the value from stream host callbacks so waiting on
+  // the notification covers both host and device signals.
+  IREE_TRACE_ZONE_BEGIN(z0);
+  iree_hal_rocm_semaphore_notify_state_t notify_state = {
+      .semaphore = semaphore,
+      .value = value,
+  };
+  iree_notification_await(
+      semaphore->notification,
+      (iree_condition_fn_t)iree_hal_rocm_semaphore_is_signaled,
+      (void*)&notify_state, timeout);
+
+  iree_status_t status = iree_ok_status();
+  iree_slim_mutex_lock(&semaphore->mutex);
+  if (!iree_status_is_ok(semaphore->failure_status)) {
+    // Semaphore has failed.
+    status = iree_status_from_code(IREE_STATUS_ABORTED);
+  } else if (semaphore->current_value < value) {
+    // Deadline expired before the semaphore was signaled.
+    status = iree_status_from_code(IREE_STATUS_DEADLINE_EXCEEDED);
+  }
+  iree_slim_mutex_unlock(&semaphore->mutex);
+  IREE_TRACE_ZONE_END(z0);
+  return status;
+}
+
+// Moves all pending events that have been reached by the host value to the
+// free list so their HIP events can be reused. The semaphore mutex must be
+// held.
+static void iree_hal_rocm_semaphore_retire_events_unsafe(
+    iree_hal_rocm_semaphore_t* semaphore) {
+  while (semaphore->pending_head &&
+         semaphore->pending_head->value <= semaphore->current_value) {
+    iree_hal_rocm_semaphore_event_t* entry = semaphore->pending_head;
+    semaphore->pending_head = entry->next;
+    entry->next = semaphore->free_head;
+    semaphore->free_head = entry;
+  }
+  if (!semaphore->pending_head) semaphore->pending_tail = NULL;
+}
+
+iree_status_t iree_hal_rocm_semaphore_enqueue_wait(
+    iree_hal_semaphore_t* base_semaphore, uint64_t value, hipStream_t stream,
+    bool* out_enqueued) {
+  iree_hal_rocm_semaphore_t* semaphore =
+      iree_hal_rocm_semaphore_cast(base_semaphore);
+  *out_enqueued = false;
+
+  iree_slim_mutex_lock(&semaphore->mutex);
+
+  if (!iree_status_is_ok(semaphore->failure_status)) {
+    iree_slim_mutex_unlock(&semaphore->mutex);
+    return iree_status_from_code(IREE_STATUS_ABORTED);
+  } else if (semaphore->current_value >= value) {
+    // Already reached; nothing to wait for.
+    iree_slim_mutex_unlock(&semaphore->mutex);
+    *out_enqueued = true;
+    return iree_ok_status();
+  }
+
+  // Find the first device signal that satisfies the wait. Signals are recorded
+  // in increasing value order so it's the earliest point the wait can resolve.
+  iree_hal_rocm_semaphore_event_t* entry = semaphore->pending_head;
+  while (entry && entry->value < value) entry = entry->next;
+
+  // NOTE: the wait is enqueued while holding the lock so that the event cannot
+  // be reused by a concurrent signal until it has been captured by the stream.
+  iree_status_t status = iree_ok_status();
+  if (entry) {
+    status = ROCM_RESULT_TO_STATUS(
+        semaphore->context->syms,
+        hipStreamWaitEvent(stream, entry->event, /*flags=*/0),
+        "hipStreamWaitEvent");
+    *out_enqueued = iree_status_is_ok(status);
+  }
+
+  iree_slim_mutex_unlock(&semaphore->mutex);
+  return status;
+}
+
+iree_status_t iree_hal_rocm_semaphore_enqueue_signal(
+    iree_hal_semaphore_t* base_semaphore, uint64_t value, hipStream_t stream) {
+  iree_hal_rocm_semaphore_t* semaphore =
+      iree_hal_rocm_semaphore_cast(base_semaphore);
+
+  iree_slim_mutex_lock(&semaphore->mutex);
+
+  if (semaphore->pending_tail && value <= semaphore->pending_tail->value) {
+    uint64_t pending_value IREE_ATTRIBUTE_UNUSED =
+        semaphore->pending_tail->value;
+    iree_slim_mutex_unlock(&semaphore->mutex);
+    return iree_make_status(IREE_STATUS_OUT_OF_RANGE,
+                            "semaphore values must be monotonically "
+                            "increasing; pending_value=%" PRIu64
+                            ", new_value=%" PRIu64,
+                            pending_value, value);
+  }
+
+  // Reuse a retired entry (and its hipEvent_t) if possible.
+  iree_hal_rocm_semaphore_retire_events_unsafe(semaphore);
+  iree_status_t status = iree_ok_status();
+  iree_hal_rocm_semaphore_event_t* entry = semaphore->free_head;
+  if (entry) {
+    semaphore->free_head = entry->next;
+  } else {
+    status = iree_allocator_malloc(semaphore->context->host_allocator,
+                                   sizeof(*entry), (void**)&entry);
+    if (iree_status_is_ok(status)) {
+      status = ROCM_RESULT_TO_STATUS(
+          semaphore->context->syms,
+          hipEventCreateWithFlags(&entry->event, hipEventDisableTiming),
+          "hipEventCreateWithFlags");
+      if (!iree_status_is_ok(status)) {
+        iree_allocator_free(semaphore->context->host_allocator, entry);
+        entry = NULL;
+      }
+    }
+  }
+
+  if (iree_status_is_ok(status)) {
+    status = ROCM_RESULT_TO_STATUS(semaphore->context->syms,
+                                 hipEventRecord(entry->event, stream),
+                                 "hipEventRecord");
+  }
+
+  if (iree_status_is_ok(status)) {
+    entry->next = NULL;
+    entry->value = value;
+    if (semaphore->pending_tail) {
+      semaphore->pending_tail->next = entry;
+    } else {
+      semaphore->pending_head = entry;
+    }
+    semaphore->pending_tail = entry;
+  } else if (entry) {
+    entry->next = semaphore->free_head;
+    semaphore->free_head = entry;
+  }
+
+  iree_slim_mutex_unlock(&semaphore->mutex);
+  return status;
+}
+
+// Returns true if any semaphore in the list has signaled (or failed).
+// Used with with iree_condition_fn_t and must match that signature.
+static bool iree_hal_rocm_semaphore_any_signaled(
+    const iree_hal_semaphore_list_t* semaphore_list) {
+  for (iree_host_size_t i = 0; i < semaphore_list->count; ++i) {
+    iree_hal_rocm_semaphore_notify_state_t state = {
+        .semaphore =
+            iree_hal_rocm_semaphore_cast(semaphore_list->semaphores[i]),
+        .value = semaphore_list->payload_values[i],
+    };
+    if (iree_hal_rocm_semaphore_is_signaled(&state)) return true;
+  }
+  return false;
+}
+
+// Returns true if all semaphores in the list has signaled (or any failed).
+// Used with with iree_condition_fn_t and must match that signature.
+static bool iree_hal_rocm_semaphore_all_signaled(
+    const iree_hal_semaphore_list_t* semaphore_list) {
+  for (iree_host_size_t i = 0; i < semaphore_list->count; ++i) {
+    iree_hal_rocm_semaphore_notify_state_t state = {
+        .semaphore =
+            iree_hal_rocm_semaphore_cast(semaphore_list->semaphores[i]),
+        .value = semaphore_list->payload_values[i],
+    };
+    if (!iree_hal_rocm_semaphore_is_signaled(&state)) return false;
+  }
+  return true;
+}
+
+// Returns a status derived from the |semaphore_list| at the current time:
+// - IREE_STATUS_OK: any or all semaphores signaled (based on |wait_mode|).
+// - IREE_STATUS_ABORTED: one or more semaphores failed.
+// - IREE_STATUS_DEADLINE_EXCEEDED: any or all semaphores unsignaled.
+static iree_status_t iree_hal_rocm_semaphore_result_from_state(
+    iree_hal_wait_mode_t wait_mode,
+    const iree_hal_semaphore_list_t semaphore_list) {
+  bool any_signaled = false;
+  bool all_signaled = true;
+  bool any_failed = false;
+  for (iree_host_size_t i = 0; i < semaphore_list.count; ++i) {
+    iree_hal_rocm_semaphore_t* semaphore =
+        iree_hal_rocm_semaphore_cast(semaphore_list.semaphores[i]);
+    iree_slim_mutex_lock(&semaphore->mutex);
+    if (!iree_status_is_ok(semaphore->failure_status)) {
+      any_failed = true;
+    } else if (semaphore->current_value < semaphore_list.payload_values[i]) {
+      all_signaled = false;
+    } else {
+      any_signaled = true;
+    }
+    iree_slim_mutex_unlock(&semaphore->mutex);
+  }
+  if (any_failed) {
+    // Always prioritize failure state.
+    return iree_status_from_code(IREE_STATUS_ABORTED);
+  }
+  switch (wait_mode) {
+    default:
+    case IREE_HAL_WAIT_MODE_ALL:
+      return all_signaled
+                 ? iree_ok_status()
+                 : iree_status_from_code(IREE_STATUS_DEADLINE_EXCEEDED);
+    case IREE_HAL_WAIT_MODE_ANY:
+      return any_signaled
+                 ? iree_ok_status()
+                 : iree_status_from_code(IREE_STATUS_DEADLINE_EXCEEDED);
+  }
+}
+
+iree_status_t iree_hal_rocm_semaphore_multi_wait(
+    iree_notification_t* notification, iree_hal_wait_mode_t wait_mode,
+    const iree_hal_semaphore_list_t semaphore_list, iree_timeout_t timeout) {
+  if (semaphore_list.count == 0) {
+    return iree_ok_status();
+  } else if (semaphore_list.count == 1) {
+    // Fast-path for a single semaphore.
+    return iree_hal_semaphore_wait(semaphore_list.semaphores[0],
+                                   semaphore_list.payload_values[0], timeout);
+  }
+
+  IREE_TRACE_ZONE_BEGIN(z0);
+
+  // Fast-path for polling; we'll never wait and can just do a quick query.
+  if (iree_timeout_is_immediate(timeout)) {
+    iree_status_t status =
+        iree_hal_rocm_semaphore_result_from_state(wait_mode, semaphore_list);
+    IREE_TRACE_ZONE_END(z0);
+    return status;
+  }
+
+  // Perform wait on the shared notification.
+  iree_notification_await(
+      notification,
+      wait_mode == IREE_HAL_WAIT_MODE_ALL
+          ? (iree_condition_fn_t)iree_hal_rocm_semaphore_all_signaled
+          : (iree_condition_fn_t)iree_hal_rocm_semaphore_any_signaled,
+      (void*)&semaphore_list, timeout);
+
+  // We may have been successful - or may have a partial failure.
+  iree_status_t status =
+      iree_hal_rocm_semaphore_result_from_state(wait_mode, semaphore_list);
+
+  IREE_TRACE_ZONE_END(z0);
+  return status;
+}
+
+static iree_status_t iree_hal_rocm_semaphore_export_timepoint(
+    iree_hal_semaphore_t* base_semaphore, uint64_t value,
+    iree_wait_primitive_type_t target_type,
+    iree_wait_primitive_t* out_wait_primitive) {
+  iree_hal_rocm_semaphore_t* semaphore =
+      iree_hal_rocm_semaphore_cast(base_semaphore);
+  return iree_hal_semaphore_export_timepoint_event(
+      base_semaphore, value, target_type, semaphore->context->host_allocator,
+      out_wait_primitive);
 }
 
 static const iree_hal_semaphore_vtable_t iree_hal_rocm_semaphore_vtable = {
@@ -106,4 +518,5 @@ static const iree_hal_semaphore_vtable_t iree_hal_rocm_semaphore_vtable = {
     .signal = iree_hal_rocm_semaphore_signal,
     .fail = iree_hal_rocm_semaphore_fail,
     .wait = iree_hal_rocm_semaphore_wait,
+    .export_timepoint = iree_hal_rocm_semaphore_export_timepoint,
 };
@@ -0,0 +1,88 @@
+// Copyright 2023 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#ifndef IREE_HAL_ROCM_MEMORY_POOLS_H_
+#define IREE_HAL_ROCM_MEMORY_POOLS_H_
+
+#include "experimental/rocm/context_wrapper.h"
+#include "experimental/rocm/rocm_headers.h"
+#include "iree/base/api.h"
+#include "iree/base/internal/atomics.h"
+#include "iree/hal/api.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif  // __cplusplus
+
+// WARNING: this API is currently only used for queue-ordered allocations
+// (iree_hal_device_queue_alloca/queue_dealloca) and must not be used for
+// synchronous allocations made through iree_hal_allocator_allocate_buffer.
+
+// Memory pools used for various allocation types.
+typedef struct iree_hal_rocm_memory_pools_t {
+  // ROCM context the pools are attached to.
+  iree_hal_rocm_context_wrapper_t* context;
+  // Used exclusively for DEVICE_LOCAL allocations. This is the default pool of
+  // the device that hipMallocAsync allocates from and is not owned by us. NULL
+  // if the device does not support memory pools
+  // (hipDeviceAttributeMemoryPoolsSupported).
+  hipMemPool_t device_local;
+
+  IREE_STATISTICS(struct {
+    iree_atomic_int64_t device_bytes_allocated;
+    iree_atomic_int64_t device_bytes_freed;
+  } statistics;)
+} iree_hal_rocm_memory_pools_t;
+
+// Initializes |out_pools| by configuring the default memory pool of
+// |rocm_device|. If the device does not support memory pools the pools will be
+// left empty and iree_hal_rocm_memory_pools_can_allocate will return false.
+iree_status_t iree_hal_rocm_memory_pools_initialize(
+    iree_hal_rocm_context_wrapper_t* context, hipDevice_t rocm_device,
+    iree_hal_rocm_memory_pools_t* IREE_RESTRICT out_pools);
+
+// Deinitializes the |pools|.
+void iree_hal_rocm_memory_pools_deinitialize(
+    iree_hal_rocm_memory_pools_t* pools);
+
+// Returns true if queue-ordered allocations with the given |params| can be
+// serviced by |pools|.
+bool iree_hal_rocm_memory_pools_can_allocate(
+    const iree_hal_rocm_memory_pools_t* pools, iree_hal_allocator_pool_t pool,
+    const iree_hal_buffer_params_t* params);
+
+// Merges statistics information from |pools| into |statistics|.
+void iree_hal_rocm_memory_pools_merge_statistics(
+    iree_hal_rocm_memory_pools_t* pools,
+    iree_hal_allocator_statistics_t* statistics);
+
+// Trims all memory pools by releasing unused memory back to the system.
+iree_status_t iree_hal_rocm_memory_pools_trim(
+    iree_hal_rocm_memory_pools_t* pools);
+
+// Asynchronously allocates a buffer from an appropriate pool.
+// The allocation will be stream-ordered on |stream| and any work enqueued after
+// it on the same stream may use the buffer.
+//
+// If the returned buffer is released without first being deallocated with
+// iree_hal_rocm_memory_pools_dealloca its memory is freed synchronously.
+iree_status_t iree_hal_rocm_memory_pools_alloca(
+    iree_hal_rocm_memory_pools_t* pools, hipStream_t stream,
+    iree_hal_allocator_pool_t pool, iree_hal_buffer_params_t params,
+    iree_device_size_t allocation_size,
+    iree_hal_buffer_t** IREE_RESTRICT out_buffer);
+
+// Asynchronously deallocates |buffer| on |stream|. The memory will be returned
+// to its pool once all work previously enqueued on |stream| has completed.
+iree_status_t iree_hal_rocm_memory_pools_dealloca(
+    iree_hal_rocm_memory_pools_t* pools, hipStream_t stream,
+    iree_hal_buffer_t* buffer);
+
+#ifdef __cplusplus
+}  // extern "C"
+#endif  // __cplusplus
+
+#endif  // IREE_HAL_ROCM_MEMORY_POOLS_H_
@@ -44,6 +44,71 @@ static iree_hal_rocm_native_executable_t* iree_hal_rocm_native_executable_cast(
   return (iree_hal_rocm_native_executable_t*)base_value;
 }
 
+// Verifies the structure of the FlatBuffer so that we can avoid doing so during
+// runtime. There are still some conditions we must be aware of (such as omitted
+// names on functions with internal linkage), however we shouldn't need to
+// bounds check anything within the FlatBuffer after this succeeds.
+static iree_status_t iree_hal_rocm_native_executable_flatbuffer_verify(
+    iree_const_byte_span_t flatbuffer_data,
+    iree_host_size_t expected_entry_point_count) {
+  if (!flatbuffer_data.data || flatbuffer_data.data_length < 16) {
+    return iree_make_status(
+        IREE_STATUS_INVALID_ARGUMENT,
+        "FlatBuffer data is not present or less than 16 bytes (%zu total)",
+        flatbuffer_data.data_length);
+  }
+
+  // Run flatcc generated verification. This ensures all pointers are in-bounds
+  // and that we can safely walk the file, but not that the actual contents of
+  // the FlatBuffer meet our expectations.
+  int verify_ret = iree_ROCMExecutableDef_verify_as_root(
+      flatbuffer_data.data, flatbuffer_data.data_length);
+  if (verify_ret != flatcc_verify_ok) {
+    return iree_make_status(IREE_STATUS_INVALID_ARGUMENT,
+                            "FlatBuffer verification failed: %s",
+                            flatcc_verify_error_string(verify_ret));
+  }
+
+  iree_ROCMExecutableDef_table_t executable_def =
+      iree_ROCMExecutableDef_as_root(flatbuffer_data.data);
+
+  flatbuffers_string_vec_t entry_points_vec =
+      iree_ROCMExecutableDef_entry_points_get(executable_def);
+  size_t entry_point_count = flatbuffers_string_vec_len(entry_points_vec);
+  if (entry_point_count != expected_entry_point_count) {
+    return iree_make_status(IREE_STATUS_FAILED_PRECONDITION,
+                            "executable provides %zu entry points but caller "
+                            "provided %zu; must match",
+                            entry_point_count, expected_entry_point_count);
+  }
+
+  for (size_t i = 0; i < entry_point_count; ++i) {
+    if (!flatbuffers_string_len(
+            flatbuffers_string_vec_at(entry_points_vec, i))) {
+      return iree_make_status(IREE_STATUS_INVALID_ARGUMENT,
+                              "executable entry point %zu has no name", i);
+    }
+  }
+
+  iree_ROCMBlockSizeDef_vec_t block_sizes_vec =
+      iree_ROCMExecutableDef_block_sizes_get(executable_def);
+  size_t block_size_count = iree_ROCMBlockSizeDef_vec_len(block_sizes_vec);
+  if (block_size_count != entry_point_count) {
+    return iree_make_status(
+        IREE_STATUS_INVALID_ARGUMENT,
+        "executable has %zu entry points but %zu block sizes are defined",
+        entry_point_count, block_size_count);
+  }
+
+  if (!flatbuffers_string_len(
+          iree_ROCMExecutableDef_hsaco_image_get(executable_def))) {
+    return iree_make_status(IREE_STATUS_INVALID_ARGUMENT,
+                            "executable HSACO image is missing/empty");
+  }
+
+  return iree_ok_status();
+}
+
 iree_status_t iree_hal_rocm_native_executable_create(
     iree_hal_rocm_context_wrapper_t* context,
     const iree_hal_executable_params_t* executable_params,
@@ -56,7 +121,11 @@ iree_status_t iree_hal_rocm_native_executable_create(
 
   iree_hal_rocm_native_executable_t* executable = NULL;
 
-  // TODO: Verify the flat buffer.
+  IREE_RETURN_AND_END_ZONE_IF_ERROR(
+      z0, iree_hal_rocm_native_executable_flatbuffer_verify(
+              executable_params->executable_data,
+              executable_params->pipeline_layout_count));
+
   iree_ROCMExecutableDef_table_t executable_def =
       iree_ROCMExecutableDef_as_root(executable_params->executable_data.data);
 
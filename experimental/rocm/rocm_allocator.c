@@ -18,6 +18,7 @@ typedef struct iree_hal_rocm_allocator_t {
   iree_hal_resource_t resource;
   iree_hal_device_t* base_device;
   iree_hal_rocm_context_wrapper_t* context;
+  iree_hal_rocm_memory_pools_t* pools;
 
   IREE_STATISTICS(iree_hal_allocator_statistics_t statistics;)
 } iree_hal_rocm_allocator_t;
@@ -32,9 +33,10 @@ static iree_hal_rocm_allocator_t* iree_hal_rocm_allocator_cast(
 
 iree_status_t iree_hal_rocm_allocator_create(
     iree_hal_device_t* base_device, iree_hal_rocm_context_wrapper_t* context,
-    iree_hal_allocator_t** out_allocator) {
+    iree_hal_rocm_memory_pools_t* pools, iree_hal_allocator_t** out_allocator) {
   IREE_ASSERT_ARGUMENT(base_device);
   IREE_ASSERT_ARGUMENT(context);
+  IREE_ASSERT_ARGUMENT(pools);
   IREE_TRACE_ZONE_BEGIN(z0);
   iree_hal_rocm_allocator_t* allocator = NULL;
   iree_status_t status = iree_allocator_malloc(
@@ -44,6 +46,7 @@ iree_status_t iree_hal_rocm_allocator_create(
                                  &allocator->resource);
     allocator->context = context;
     allocator->base_device = base_device;
+    allocator->pools = pools;
     *out_allocator = (iree_hal_allocator_t*)allocator;
   }
 
@@ -82,6 +85,8 @@ static void iree_hal_rocm_allocator_query_statistics(
     iree_hal_rocm_allocator_t* allocator =
         iree_hal_rocm_allocator_cast(base_allocator);
     memcpy(out_statistics, &allocator->statistics, sizeof(*out_statistics));
+    iree_hal_rocm_memory_pools_merge_statistics(allocator->pools,
+                                                out_statistics);
   });
 }
 
@@ -170,7 +175,12 @@ static iree_status_t iree_hal_rocm_allocator_allocate_buffer(
         (iree_hal_allocator_t*)allocator, params->type, params->access,
         params->usage, allocation_size,
         /*byte_offset=*/0,
-        /*byte_length=*/allocation_size, device_ptr, host_ptr, &buffer);
+        /*byte_length=*/allocation_size,
+        iree_all_bits_set(params->type, IREE_HAL_MEMORY_TYPE_DEVICE_LOCAL)
+            ? IREE_HAL_ROCM_BUFFER_TYPE_DEVICE
+            : IREE_HAL_ROCM_BUFFER_TYPE_HOST,
+        device_ptr, host_ptr, iree_hal_buffer_release_callback_null(),
+        allocator->context->host_allocator, &buffer);
   }
 
   // Copy the initial contents into the buffer. This may require staging.
@@ -8,6 +8,7 @@
 #define IREE_HAL_ROCM_ALLOCATOR_H_
 
 #include "experimental/rocm/context_wrapper.h"
+#include "experimental/rocm/memory_pools.h"
 #include "experimental/rocm/status_util.h"
 #include "iree/base/api.h"
 #include "iree/hal/api.h"
@@ -17,9 +18,11 @@ extern "C" {
 #endif  // __cplusplus
 
 // Create a ROCM allocator.
+// |pools| are the queue-ordered allocation pools of the device and are only
+// used to include their utilization in allocator statistics.
 iree_status_t iree_hal_rocm_allocator_create(
     iree_hal_device_t* base_device, iree_hal_rocm_context_wrapper_t* context,
-    iree_hal_allocator_t** out_allocator);
+    iree_hal_rocm_memory_pools_t* pools, iree_hal_allocator_t** out_allocator);
 
 #ifdef __cplusplus
 }  // extern "C"
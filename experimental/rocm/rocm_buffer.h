@@ -15,13 +15,39 @@
 extern "C" {
 #endif  // __cplusplus
 
+typedef enum iree_hal_rocm_buffer_type_e {
+  // Device local buffer; allocated with hipMalloc.
+  IREE_HAL_ROCM_BUFFER_TYPE_DEVICE = 0,
+  // Host local buffer; allocated with hipHostMalloc.
+  IREE_HAL_ROCM_BUFFER_TYPE_HOST,
+  // Device local buffer allocated from a memory pool in stream order; allocated
+  // with hipMallocAsync.
+  IREE_HAL_ROCM_BUFFER_TYPE_ASYNC,
+} iree_hal_rocm_buffer_type_t;
+
 // Wraps a ROCm allocation in an iree_hal_buffer_t.
+// |release_callback| is issued when the buffer is destroyed and may be used to
+// free allocations not owned by |allocator|.
 iree_status_t iree_hal_rocm_buffer_wrap(
     iree_hal_allocator_t* allocator, iree_hal_memory_type_t memory_type,
     iree_hal_memory_access_t allowed_access,
     iree_hal_buffer_usage_t allowed_usage, iree_device_size_t allocation_size,
     iree_device_size_t byte_offset, iree_device_size_t byte_length,
-    hipDeviceptr_t device_ptr, void* host_ptr, iree_hal_buffer_t** out_buffer);
+    iree_hal_rocm_buffer_type_t buffer_type, hipDeviceptr_t device_ptr,
+    void* host_ptr, iree_hal_buffer_release_callback_t release_callback,
+    iree_allocator_t host_allocator, iree_hal_buffer_t** out_buffer);
+
+// Returns true if |buffer| is a ROCm buffer.
+bool iree_hal_rocm_buffer_isa(iree_hal_buffer_t* buffer);
+
+// Returns the type of allocation backing the ROCm |buffer|.
+iree_hal_rocm_buffer_type_t iree_hal_rocm_buffer_type(
+    const iree_hal_buffer_t* buffer);
+
+// Drops the release callback so that when the buffer is destroyed no callback
+// will be made. This is needed when the memory has been freed by other means
+// (such as a queue-ordered deallocation).
+void iree_hal_rocm_buffer_drop_release_callback(iree_hal_buffer_t* buffer);
 
 // Returns the ROCm base pointer for the given |buffer|.
 // This is the entire allocated_buffer and must be offset by the buffer
@@ -14,14 +14,45 @@
 #include "experimental/rocm/direct_command_buffer.h"
 #include "experimental/rocm/dynamic_symbols.h"
 #include "experimental/rocm/event_semaphore.h"
+#include "experimental/rocm/graph_command_buffer.h"
+#include "experimental/rocm/memory_pools.h"
 #include "experimental/rocm/nop_executable_cache.h"
 #include "experimental/rocm/pipeline_layout.h"
 #include "experimental/rocm/rocm_allocator.h"
 #include "experimental/rocm/rocm_event.h"
 #include "experimental/rocm/status_util.h"
 #include "iree/base/internal/arena.h"
+#include "iree/base/internal/atomics.h"
+#include "iree/base/internal/synchronization.h"
 #include "iree/base/tracing.h"
 #include "iree/hal/utils/buffer_transfer.h"
+#include "iree/hal/utils/deferred_command_buffer.h"
+
+// Size of the blocks in the command buffer block pool. Command buffers can
+// contain inlined data uploads and graph command buffers keep them live until
+// they are destroyed.
+#define IREE_HAL_ROCM_ARENA_BLOCK_SIZE (32 * 1024)
+
+//===----------------------------------------------------------------------===//
+// iree_hal_rocm_submission_t
+//===----------------------------------------------------------------------===//
+
+// An in-flight queue operation on the device stream.
+// Retains the resources that must remain live until the stream has executed
+// the operation and the semaphores that are signaled on the host once it has.
+typedef struct iree_hal_rocm_submission_t {
+  // Next submission in the device list in stream order.
+  struct iree_hal_rocm_submission_t* next;
+  // Set from the stream host callback once the stream has passed the
+  // submission. Completed submissions are reclaimed by the device on user
+  // threads as no resources may be released from the callback.
+  iree_atomic_int32_t is_complete;
+  // Semaphores signaled when the submission completes. Retained.
+  iree_hal_semaphore_list_t signal_semaphore_list;
+  // Resources used by the submission. Retained.
+  iree_host_size_t resource_count;
+  iree_hal_resource_t** resources;
+} iree_hal_rocm_submission_t;
 
 //===----------------------------------------------------------------------===//
 // iree_hal_rocm_device_t
@@ -41,11 +72,31 @@ typedef struct iree_hal_rocm_device_t {
 
   hipDevice_t device;
 
+  // Dedicated non-blocking stream all queue operations are issued to.
   // TODO: support multiple streams.
   hipStream_t stream;
+
+  // Direct command buffer issuing to |stream| that deferred command buffers
+  // are replayed into when executed.
+  iree_hal_command_buffer_t* stream_command_buffer;
+
   iree_hal_rocm_context_wrapper_t context_wrapper;
   iree_hal_allocator_t* device_allocator;
 
+  // Device memory pools used for queue-ordered allocations.
+  // Empty if unsupported by the device.
+  iree_hal_rocm_memory_pools_t memory_pools;
+
+  // Posted whenever the value of any semaphore created by the device changes.
+  iree_notification_t semaphore_notification;
+
+  // Guards the submission list.
+  iree_slim_mutex_t submission_mutex;
+  // In-flight submissions in stream order.
+  iree_hal_rocm_submission_t* submission_head
+      IREE_GUARDED_BY(submission_mutex);
+  iree_hal_rocm_submission_t* submission_tail
+      IREE_GUARDED_BY(submission_mutex);
 } iree_hal_rocm_device_t;
 
 static const iree_hal_device_vtable_t iree_hal_rocm_device_vtable;
@@ -56,15 +107,37 @@ static iree_hal_rocm_device_t* iree_hal_rocm_device_cast(
   return (iree_hal_rocm_device_t*)base_value;
 }
 
+static void iree_hal_rocm_device_reclaim_submissions(
+    iree_hal_rocm_device_t* device, bool force);
+
 static void iree_hal_rocm_device_destroy(iree_hal_device_t* base_device) {
   iree_hal_rocm_device_t* device = iree_hal_rocm_device_cast(base_device);
   iree_allocator_t host_allocator = iree_hal_device_host_allocator(base_device);
   IREE_TRACE_ZONE_BEGIN(z0);
 
+  // Wait for all in-flight work to complete (including the host callbacks that
+  // signal semaphores) and release the resources it retained.
+  if (device->stream) {
+    ROCM_IGNORE_ERROR(device->context_wrapper.syms,
+                      hipStreamSynchronize(device->stream));
+  }
+  iree_hal_rocm_device_reclaim_submissions(device, /*force=*/true);
+  iree_hal_command_buffer_release(device->stream_command_buffer);
+
   // There should be no more buffers live that use the allocator.
   iree_hal_allocator_release(device->device_allocator);
-  ROCM_IGNORE_ERROR(device->context_wrapper.syms,
-                    hipStreamDestroy(device->stream));
+
+  // Release memory reserved by the pools.
+  iree_hal_rocm_memory_pools_deinitialize(&device->memory_pools);
+
+  if (device->stream) {
+    ROCM_IGNORE_ERROR(device->context_wrapper.syms,
+                      hipStreamDestroy(device->stream));
+  }
+
+  iree_slim_mutex_deinitialize(&device->submission_mutex);
+  iree_notification_deinitialize(&device->semaphore_notification);
+  iree_arena_block_pool_deinitialize(&device->block_pool);
 
   // Finally, destroy the device.
   iree_hal_driver_release(device->driver);
@@ -76,7 +149,7 @@ static void iree_hal_rocm_device_destroy(iree_hal_device_t* base_device) {
 
 static iree_status_t iree_hal_rocm_device_create_internal(
     iree_hal_driver_t* driver, iree_string_view_t identifier,
-    hipDevice_t rocm_device, hipStream_t stream, hipCtx_t context,
+    hipDevice_t rocm_device, hipCtx_t context,
     iree_hal_rocm_dynamic_symbols_t* syms, iree_allocator_t host_allocator,
     iree_hal_device_t** out_device) {
   iree_hal_rocm_device_t* device = NULL;
@@ -91,13 +164,39 @@ static iree_status_t iree_hal_rocm_device_create_internal(
   buffer_ptr += iree_string_view_append_to_buffer(
       identifier, &device->identifier, (char*)buffer_ptr);
   device->device = rocm_device;
-  device->stream = stream;
   device->context_wrapper.rocm_context = context;
   device->context_wrapper.host_allocator = host_allocator;
   device->context_wrapper.syms = syms;
-  iree_status_t status = iree_hal_rocm_allocator_create(
-      (iree_hal_device_t*)device, &device->context_wrapper,
-      &device->device_allocator);
+  iree_arena_block_pool_initialize(IREE_HAL_ROCM_ARENA_BLOCK_SIZE,
+                                   host_allocator, &device->block_pool);
+  iree_notification_initialize(&device->semaphore_notification);
+  iree_slim_mutex_initialize(&device->submission_mutex);
+
+  iree_status_t status = ROCM_RESULT_TO_STATUS(
+      syms, hipStreamCreateWithFlags(&device->stream, hipStreamNonBlocking),
+      "hipStreamCreateWithFlags");
+
+  // Create memory pools first so that the allocator can reference them.
+  if (iree_status_is_ok(status)) {
+    status = iree_hal_rocm_memory_pools_initialize(
+        &device->context_wrapper, rocm_device, &device->memory_pools);
+  }
+
+  if (iree_status_is_ok(status)) {
+    status = iree_hal_rocm_allocator_create(
+        (iree_hal_device_t*)device, &device->context_wrapper,
+        &device->memory_pools, &device->device_allocator);
+  }
+
+  if (iree_status_is_ok(status)) {
+    status = iree_hal_rocm_direct_command_buffer_create(
+        (iree_hal_device_t*)device, &device->context_wrapper,
+        IREE_HAL_COMMAND_BUFFER_MODE_ALLOW_INLINE_EXECUTION,
+        IREE_HAL_COMMAND_CATEGORY_ANY, IREE_HAL_QUEUE_AFFINITY_ANY,
+        /*binding_capacity=*/0, &device->block_pool, device->stream,
+        &device->stream_command_buffer);
+  }
+
   if (iree_status_is_ok(status)) {
     *out_device = (iree_hal_device_t*)device;
   } else {
@@ -116,19 +215,12 @@ iree_status_t iree_hal_rocm_device_create(iree_hal_driver_t* driver,
   hipCtx_t context;
   IREE_RETURN_AND_END_ZONE_IF_ERROR(
       z0, ROCM_RESULT_TO_STATUS(syms, hipCtxCreate(&context, 0, device)));
-  hipStream_t stream;
-  iree_status_t status = ROCM_RESULT_TO_STATUS(
-      syms, hipStreamCreateWithFlags(&stream, hipStreamNonBlocking));
 
-  if (iree_status_is_ok(status)) {
-    status = iree_hal_rocm_device_create_internal(driver, identifier, device,
-                                                  stream, context, syms,
-                                                  host_allocator, out_device);
-  }
+  // NOTE: on failure the partially constructed device is destroyed and will
+  // release the stream it created.
+  iree_status_t status = iree_hal_rocm_device_create_internal(
+      driver, identifier, device, context, syms, host_allocator, out_device);
   if (!iree_status_is_ok(status)) {
-    if (stream) {
-      syms->hipStreamDestroy(stream);
-    }
     syms->hipCtxDestroy(context);
   }
   IREE_TRACE_ZONE_END(z0);
@@ -177,7 +269,8 @@ static iree_status_t iree_hal_rocm_device_query_i64(
 static iree_status_t iree_hal_rocm_device_trim(iree_hal_device_t* base_device) {
   iree_hal_rocm_device_t* device = iree_hal_rocm_device_cast(base_device);
   iree_arena_block_pool_trim(&device->block_pool);
-  return iree_hal_allocator_trim(device->device_allocator);
+  IREE_RETURN_IF_ERROR(iree_hal_allocator_trim(device->device_allocator));
+  return iree_hal_rocm_memory_pools_trim(&device->memory_pools);
 }
 
 static iree_status_t iree_hal_rocm_device_create_channel(
@@ -193,7 +286,17 @@ static iree_status_t iree_hal_rocm_device_create_command_buffer(
     iree_hal_queue_affinity_t queue_affinity, iree_host_size_t binding_capacity,
     iree_hal_command_buffer_t** out_command_buffer) {
   iree_hal_rocm_device_t* device = iree_hal_rocm_device_cast(base_device);
-  return iree_hal_rocm_direct_command_buffer_create(
+  if (iree_all_bits_set(mode, IREE_HAL_COMMAND_BUFFER_MODE_NESTED) ||
+      binding_capacity > 0) {
+    // Nested and indirect command buffers are recorded into a compact command
+    // list and replayed into the command buffer that executes them, resolving
+    // any indirect bindings against the binding table provided at that time.
+    return iree_hal_deferred_command_buffer_create(
+        base_device, mode, command_categories, binding_capacity,
+        &device->block_pool, iree_hal_device_host_allocator(base_device),
+        out_command_buffer);
+  }
+  return iree_hal_rocm_graph_command_buffer_create(
       base_device, &device->context_wrapper, mode, command_categories,
       queue_affinity, binding_capacity, &device->block_pool,
       out_command_buffer);
@@ -240,17 +343,206 @@ static iree_status_t iree_hal_rocm_device_create_semaphore(
     iree_hal_device_t* base_device, uint64_t initial_value,
     iree_hal_semaphore_t** out_semaphore) {
   iree_hal_rocm_device_t* device = iree_hal_rocm_device_cast(base_device);
-  return iree_hal_rocm_semaphore_create(&device->context_wrapper, initial_value,
-                                        out_semaphore);
+  return iree_hal_rocm_semaphore_create(&device->context_wrapper,
+                                        &device->semaphore_notification,
+                                        initial_value, out_semaphore);
 }
 
 static iree_hal_semaphore_compatibility_t
 iree_hal_rocm_device_query_semaphore_compatibility(
     iree_hal_device_t* base_device, iree_hal_semaphore_t* semaphore) {
-  // TODO: implement ROCM semaphores.
+  if (iree_hal_rocm_semaphore_isa(semaphore)) {
+    // ROCM semaphores can be waited on and signaled by the device queue.
+    // TODO: verify the semaphore was created by a device sharing our context.
+    return IREE_HAL_SEMAPHORE_COMPATIBILITY_ALL;
+  }
   return IREE_HAL_SEMAPHORE_COMPATIBILITY_HOST_ONLY;
 }
 
+// Releases all resources retained by |submission| and frees it.
+static void iree_hal_rocm_submission_free(
+    iree_allocator_t host_allocator, iree_hal_rocm_submission_t* submission) {
+  for (iree_host_size_t i = 0; i < submission->signal_semaphore_list.count;
+       ++i) {
+    iree_hal_semaphore_release(
+        submission->signal_semaphore_list.semaphores[i]);
+  }
+  for (iree_host_size_t i = 0; i < submission->resource_count; ++i) {
+    iree_hal_resource_release(submission->resources[i]);
+  }
+  iree_allocator_free(host_allocator, submission);
+}
+
+// Stream host callback issued once the stream has reached the end of a
+// submission. HIP APIs must not be called from here (including any that may
+// be reached by destroying resources) so we only signal and let the device
+// reclaim the submission later.
+static void iree_hal_rocm_submission_complete(void* user_data) {
+  iree_hal_rocm_submission_t* submission =
+      (iree_hal_rocm_submission_t*)user_data;
+  IREE_TRACE_ZONE_BEGIN(z0);
+  for (iree_host_size_t i = 0; i < submission->signal_semaphore_list.count;
+       ++i) {
+    iree_hal_semaphore_t* semaphore =
+        submission->signal_semaphore_list.semaphores[i];
+    iree_status_t status = iree_hal_semaphore_signal(
+        semaphore, submission->signal_semaphore_list.payload_values[i]);
+    if (!iree_status_is_ok(status)) {
+      iree_hal_semaphore_fail(semaphore, status);
+    }
+  }
+  iree_atomic_store_int32(&submission->is_complete, 1,
+                          iree_memory_order_release);
+  IREE_TRACE_ZONE_END(z0);
+}
+
+// Reclaims all submissions that have completed on the device stream.
+// If |force| is set all submissions are reclaimed regardless of their state;
+// this must only be used once the stream has been synchronized.
+static void iree_hal_rocm_device_reclaim_submissions(
+    iree_hal_rocm_device_t* device, bool force) {
+  // Submissions complete in stream order so we only need to walk the head of
+  // the list until we find one that is still pending.
+  iree_slim_mutex_lock(&device->submission_mutex);
+  iree_hal_rocm_submission_t* reclaim_head = device->submission_head;
+  iree_hal_rocm_submission_t* reclaim_tail = NULL;
+  iree_hal_rocm_submission_t* submission = device->submission_head;
+  while (submission &&
+         (force || iree_atomic_load_int32(&submission->is_complete,
+                                          iree_memory_order_acquire))) {
+    reclaim_tail = submission;
+    submission = submission->next;
+  }
+  if (reclaim_tail) {
+    reclaim_tail->next = NULL;
+    device->submission_head = submission;
+    if (!submission) device->submission_tail = NULL;
+  } else {
+    reclaim_head = NULL;
+  }
+  iree_slim_mutex_unlock(&device->submission_mutex);
+
+  // Release resources outside of the lock as they may call back into us.
+  iree_allocator_t host_allocator = device->context_wrapper.host_allocator;
+  while (reclaim_head) {
+    iree_hal_rocm_submission_t* next = reclaim_head->next;
+    iree_hal_rocm_submission_free(host_allocator, reclaim_head);
+    reclaim_head = next;
+  }
+}
+
+// Makes the device stream wait for all semaphores in |wait_semaphore_list|.
+// Semaphores that have a device signal pending are waited on by the stream
+// without involving the host. Anything else (foreign semaphores or values that
+// will only be reached by a host signal) is waited on the host.
+static iree_status_t iree_hal_rocm_device_stream_wait(
+    iree_hal_rocm_device_t* device,
+    const iree_hal_semaphore_list_t wait_semaphore_list) {
+  for (iree_host_size_t i = 0; i < wait_semaphore_list.count; ++i) {
+    iree_hal_semaphore_t* semaphore = wait_semaphore_list.semaphores[i];
+    const uint64_t value = wait_semaphore_list.payload_values[i];
+    bool enqueued = false;
+    if (iree_hal_rocm_semaphore_isa(semaphore)) {
+      IREE_RETURN_IF_ERROR(iree_hal_rocm_semaphore_enqueue_wait(
+          semaphore, value, device->stream, &enqueued));
+    }
+    if (!enqueued) {
+      // TODO: defer the submission to a host thread instead of blocking the
+      // caller when waiting on host signals that have not yet happened.
+      IREE_RETURN_IF_ERROR(
+          iree_hal_semaphore_wait(semaphore, value, iree_infinite_timeout()));
+    }
+  }
+  return iree_ok_status();
+}
+
+// Records device signals for all semaphores in |signal_semaphore_list| at the
+// current position of the device stream and enqueues a host callback that
+// signals them on the host and releases |resources| once the stream reaches it.
+static iree_status_t iree_hal_rocm_device_stream_signal(
+    iree_hal_rocm_device_t* device,
+    const iree_hal_semaphore_list_t signal_semaphore_list,
+    iree_host_size_t resource_count, iree_hal_resource_t* const* resources) {
+  if (signal_semaphore_list.count == 0 && resource_count == 0) {
+    return iree_ok_status();
+  }
+  IREE_TRACE_ZONE_BEGIN(z0);
+
+  // Record events so that other device waits can chain on the device.
+  for (iree_host_size_t i = 0; i < signal_semaphore_list.count; ++i) {
+    iree_hal_semaphore_t* semaphore = signal_semaphore_list.semaphores[i];
+    if (!iree_hal_rocm_semaphore_isa(semaphore)) continue;
+    IREE_RETURN_AND_END_ZONE_IF_ERROR(
+        z0, iree_hal_rocm_semaphore_enqueue_signal(
+                semaphore, signal_semaphore_list.payload_values[i],
+                device->stream));
+  }
+
+  // Allocate the submission along with its lists in a single allocation.
+  iree_hal_rocm_submission_t* submission = NULL;
+  const iree_host_size_t total_size =
+      sizeof(*submission) +
+      signal_semaphore_list.count * sizeof(*signal_semaphore_list.semaphores) +
+      signal_semaphore_list.count *
+          sizeof(*signal_semaphore_list.payload_values) +
+      resource_count * sizeof(*resources);
+  IREE_RETURN_AND_END_ZONE_IF_ERROR(
+      z0, iree_allocator_malloc(device->context_wrapper.host_allocator,
+                                total_size, (void**)&submission));
+  uint8_t* ptr = (uint8_t*)submission + sizeof(*submission);
+  submission->next = NULL;
+  iree_atomic_store_int32(&submission->is_complete, 0,
+                          iree_memory_order_relaxed);
+  submission->signal_semaphore_list.count = signal_semaphore_list.count;
+  submission->signal_semaphore_list.semaphores = (iree_hal_semaphore_t**)ptr;
+  ptr +=
+      signal_semaphore_list.count * sizeof(*signal_semaphore_list.semaphores);
+  submission->signal_semaphore_list.payload_values = (uint64_t*)ptr;
+  ptr += signal_semaphore_list.count *
+         sizeof(*signal_semaphore_list.payload_values);
+  submission->resource_count = resource_count;
+  submission->resources = (iree_hal_resource_t**)ptr;
+  for (iree_host_size_t i = 0; i < signal_semaphore_list.count; ++i) {
+    submission->signal_semaphore_list.semaphores[i] =
+        signal_semaphore_list.semaphores[i];
+    iree_hal_semaphore_retain(signal_semaphore_list.semaphores[i]);
+    submission->signal_semaphore_list.payload_values[i] =
+        signal_semaphore_list.payload_values[i];
+  }
+  for (iree_host_size_t i = 0; i < resource_count; ++i) {
+    submission->resources[i] = resources[i];
+    iree_hal_resource_retain(resources[i]);
+  }
+
+  // Append to the in-flight list before launching as the callback may run
+  // immediately.
+  iree_slim_mutex_lock(&device->submission_mutex);
+  if (device->submission_tail) {
+    device->submission_tail->next = submission;
+  } else {
+    device->submission_head = submission;
+  }
+  device->submission_tail = submission;
+  iree_slim_mutex_unlock(&device->submission_mutex);
+
+  iree_status_t status = ROCM_RESULT_TO_STATUS(
+      device->context_wrapper.syms,
+      hipLaunchHostFunc(device->stream, iree_hal_rocm_submission_complete,
+                        submission),
+      "hipLaunchHostFunc");
+  if (!iree_status_is_ok(status)) {
+    // The callback will never run: fail the semaphores so that waiters wake
+    // and let the submission be reclaimed.
+    iree_hal_semaphore_list_fail(signal_semaphore_list,
+                                 iree_status_clone(status));
+    iree_atomic_store_int32(&submission->is_complete, 1,
+                            iree_memory_order_release);
+  }
+
+  IREE_TRACE_ZONE_END(z0);
+  return status;
+}
+
 static iree_status_t iree_hal_rocm_device_queue_alloca(
     iree_hal_device_t* base_device, iree_hal_queue_affinity_t queue_affinity,
     const iree_hal_semaphore_list_t wait_semaphore_list,
@@ -258,14 +550,32 @@ static iree_status_t iree_hal_rocm_device_queue_alloca(
     iree_hal_allocator_pool_t pool, iree_hal_buffer_params_t params,
     iree_device_size_t allocation_size,
     iree_hal_buffer_t** IREE_RESTRICT out_buffer) {
-  // TODO: queue-ordered allocations.
-  IREE_RETURN_IF_ERROR(iree_hal_semaphore_list_wait(wait_semaphore_list,
-                                                    iree_infinite_timeout()));
-  IREE_RETURN_IF_ERROR(iree_hal_allocator_allocate_buffer(
-      iree_hal_device_allocator(base_device), params, allocation_size,
-      iree_const_byte_span_empty(), out_buffer));
-  IREE_RETURN_IF_ERROR(iree_hal_semaphore_list_signal(signal_semaphore_list));
-  return iree_ok_status();
+  iree_hal_rocm_device_t* device = iree_hal_rocm_device_cast(base_device);
+  iree_hal_rocm_device_reclaim_submissions(device, /*force=*/false);
+
+  // Order the allocation after the waits on the device stream.
+  IREE_RETURN_IF_ERROR(
+      iree_hal_rocm_device_stream_wait(device, wait_semaphore_list));
+
+  // Allocate from the stream-ordered pools if possible; otherwise fall back to
+  // a synchronous allocation that is immediately available.
+  iree_status_t status = iree_ok_status();
+  if (iree_hal_rocm_memory_pools_can_allocate(&device->memory_pools, pool,
+                                              &params)) {
+    status = iree_hal_rocm_memory_pools_alloca(&device->memory_pools,
+                                               device->stream, pool, params,
+                                               allocation_size, out_buffer);
+  } else {
+    status = iree_hal_allocator_allocate_buffer(
+        iree_hal_device_allocator(base_device), params, allocation_size,
+        iree_const_byte_span_empty(), out_buffer);
+  }
+
+  if (iree_status_is_ok(status)) {
+    status = iree_hal_rocm_device_stream_signal(device, signal_semaphore_list,
+                                                /*resource_count=*/0, NULL);
+  }
+  return status;
 }
 
 static iree_status_t iree_hal_rocm_device_queue_dealloca(
@@ -273,10 +583,20 @@ static iree_status_t iree_hal_rocm_device_queue_dealloca(
     const iree_hal_semaphore_list_t wait_semaphore_list,
     const iree_hal_semaphore_list_t signal_semaphore_list,
     iree_hal_buffer_t* buffer) {
-  // TODO: queue-ordered allocations.
-  IREE_RETURN_IF_ERROR(iree_hal_device_queue_barrier(
-      base_device, queue_affinity, wait_semaphore_list, signal_semaphore_list));
-  return iree_ok_status();
+  iree_hal_rocm_device_t* device = iree_hal_rocm_device_cast(base_device);
+  iree_hal_rocm_device_reclaim_submissions(device, /*force=*/false);
+
+  // Order the deallocation after the waits on the device stream.
+  IREE_RETURN_IF_ERROR(
+      iree_hal_rocm_device_stream_wait(device, wait_semaphore_list));
+
+  // Buffers allocated from the pools are returned to them in stream order;
+  // anything else is freed when its last reference is released.
+  IREE_RETURN_IF_ERROR(iree_hal_rocm_memory_pools_dealloca(
+      &device->memory_pools, device->stream, buffer));
+
+  return iree_hal_rocm_device_stream_signal(device, signal_semaphore_list,
+                                            /*resource_count=*/0, NULL);
 }
 
 static iree_status_t iree_hal_rocm_device_queue_execute(
@@ -286,14 +606,32 @@ static iree_status_t iree_hal_rocm_device_queue_execute(
     iree_host_size_t command_buffer_count,
     iree_hal_command_buffer_t* const* command_buffers) {
   iree_hal_rocm_device_t* device = iree_hal_rocm_device_cast(base_device);
-  // TODO(raikonenfnu): Once semaphore is implemented wait for semaphores
-  // TODO(thomasraoux): implement semaphores - for now this conservatively
-  // synchronizes after every submit.
-  // TODO(raikonenfnu): currently run on default/null stream, when cmd buffer
-  // stream work with device->stream, we'll change
-  ROCM_RETURN_IF_ERROR(device->context_wrapper.syms, hipStreamSynchronize(0),
-                       "hipStreamSynchronize");
-  return iree_ok_status();
+  iree_hal_rocm_device_reclaim_submissions(device, /*force=*/false);
+
+  // Order the execution after the waits on the device stream.
+  IREE_RETURN_IF_ERROR(
+      iree_hal_rocm_device_stream_wait(device, wait_semaphore_list));
+
+  for (iree_host_size_t i = 0; i < command_buffer_count; i++) {
+    iree_hal_command_buffer_t* command_buffer = command_buffers[i];
+    if (iree_hal_rocm_graph_command_buffer_isa(command_buffer)) {
+      hipGraphExec_t exec =
+          iree_hal_rocm_graph_command_buffer_handle(command_buffer);
+      ROCM_RETURN_IF_ERROR(device->context_wrapper.syms,
+                           hipGraphLaunch(exec, device->stream),
+                           "hipGraphLaunch");
+    } else {
+      IREE_RETURN_IF_ERROR(iree_hal_deferred_command_buffer_apply(
+          command_buffer, device->stream_command_buffer,
+          iree_hal_buffer_binding_table_empty()));
+    }
+  }
+
+  // Signal once the stream completes the command buffers and keep them live
+  // until then.
+  return iree_hal_rocm_device_stream_signal(
+      device, signal_semaphore_list, command_buffer_count,
+      (iree_hal_resource_t* const*)command_buffers);
 }
 
 static iree_status_t iree_hal_rocm_device_queue_flush(
@@ -305,8 +643,18 @@ static iree_status_t iree_hal_rocm_device_queue_flush(
 static iree_status_t iree_hal_rocm_device_wait_semaphores(
     iree_hal_device_t* base_device, iree_hal_wait_mode_t wait_mode,
     const iree_hal_semaphore_list_t semaphore_list, iree_timeout_t timeout) {
-  return iree_make_status(IREE_STATUS_UNIMPLEMENTED,
-                          "semaphore not implemented");
+  iree_hal_rocm_device_t* device = iree_hal_rocm_device_cast(base_device);
+  for (iree_host_size_t i = 0; i < semaphore_list.count; ++i) {
+    if (!iree_hal_rocm_semaphore_isa(semaphore_list.semaphores[i])) {
+      return iree_make_status(
+          IREE_STATUS_INVALID_ARGUMENT,
+          "only ROCM semaphores can be waited on by the ROCM device");
+    }
+  }
+  iree_status_t status = iree_hal_rocm_semaphore_multi_wait(
+      &device->semaphore_notification, wait_mode, semaphore_list, timeout);
+  iree_hal_rocm_device_reclaim_submissions(device, /*force=*/false);
+  return status;
 }
 
 static iree_status_t iree_hal_rocm_device_profiling_begin(
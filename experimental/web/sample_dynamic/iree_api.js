@@ -55,15 +55,29 @@ function _callIntoWorker(baseMessage) {
 
 // Initializes IREE's web worker asynchronously.
 //
+// When |multithreaded| is true the runtime dispatches work across one Web
+// Worker per logical core. This requires SharedArrayBuffer, which is only
+// available on cross-origin isolated pages, and programs compiled with
+// `--iree-llvm-wasm-shared-memory`.
+//
 // Resolves with no return value when the worker is fully initialized.
-function ireeInitializeWorker() {
+function ireeInitializeWorker(multithreaded = false) {
   return new Promise((resolve, reject) => {
+    if (multithreaded && !self.crossOriginIsolated) {
+      reject(
+          'Multithreading requires a cross-origin isolated page ' +
+          '(Cross-Origin-Opener-Policy and Cross-Origin-Embedder-Policy)');
+      return;
+    }
+
     pendingPromises['initialize'] = {
       'resolve': resolve,
       'reject': reject,
     };
 
-    ireeWorker = new Worker('iree_worker.js', {name: 'IREE-main'});
+    const workerUrl =
+        multithreaded ? 'iree_worker.js?multithreaded' : 'iree_worker.js';
+    ireeWorker = new Worker(workerUrl, {name: 'IREE-main'});
     ireeWorker.onmessage = _handleMessageFromWorker;
   });
 }
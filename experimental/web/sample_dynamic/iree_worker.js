@@ -4,9 +4,12 @@
 // See https://llvm.org/LICENSE.txt for license information.
 // SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
 
-// TODO(scotttodd): configure this through the build system / scripts?
-// const MAIN_SCRIPT_URL = 'web-sample-dynamic-multithreaded.js';
-const MAIN_SCRIPT_URL = 'web-sample-dynamic-sync.js';
+// The multithreaded runtime is selected by iree_api.js with a query parameter
+// on this script's URL.
+const MAIN_SCRIPT_URL =
+    new URLSearchParams(self.location.search).has('multithreaded') ?
+    'web-sample-dynamic-multithreaded.js' :
+    'web-sample-dynamic-sync.js';
 
 let wasmSetupSampleFn;
 let wasmCleanupSampleFn;
@@ -0,0 +1,74 @@
+// Copyright 2023 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+// See iree/base/api.h for documentation on the API conventions used.
+
+#ifndef IREE_HAL_WEBGPU_API_H_
+#define IREE_HAL_WEBGPU_API_H_
+
+#include "experimental/webgpu/webgpu_headers.h"
+#include "iree/base/api.h"
+#include "iree/hal/api.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif  // __cplusplus
+
+//===----------------------------------------------------------------------===//
+// iree_hal_webgpu_device_t
+//===----------------------------------------------------------------------===//
+
+// WebGPU device creation options.
+typedef struct iree_hal_webgpu_device_options_t {
+  // Size of the blocks used to stage push constants and inline buffer updates
+  // recorded into command buffers. Each dispatch consumes
+  // IREE_HAL_WEBGPU_PARAMS_BINDING_SIZE bytes for its push constants.
+  iree_host_size_t staging_block_size;
+} iree_hal_webgpu_device_options_t;
+
+IREE_API_EXPORT void iree_hal_webgpu_device_options_initialize(
+    iree_hal_webgpu_device_options_t* out_options);
+
+// Wraps an existing WGPUDevice created by the application in a HAL device.
+// The device is referenced for the lifetime of the HAL device.
+//
+// |out_device| must be released by the caller (see |iree_hal_device_release|).
+IREE_API_EXPORT iree_status_t iree_hal_webgpu_wrap_device(
+    iree_string_view_t identifier,
+    const iree_hal_webgpu_device_options_t* options, WGPUDevice handle,
+    iree_allocator_t host_allocator, iree_hal_device_t** out_device);
+
+//===----------------------------------------------------------------------===//
+// iree_hal_webgpu_driver_t
+//===----------------------------------------------------------------------===//
+
+// WebGPU driver creation options.
+typedef struct iree_hal_webgpu_driver_options_t {
+  // Options used for all devices created by the driver.
+  iree_hal_webgpu_device_options_t device_options;
+} iree_hal_webgpu_driver_options_t;
+
+IREE_API_EXPORT void iree_hal_webgpu_driver_options_initialize(
+    iree_hal_webgpu_driver_options_t* out_options);
+
+// Creates a WebGPU HAL driver.
+//
+// When targeting the web the driver exposes the device preinitialized by the
+// hosting page (`Module.preinitializedWebGPUDevice`). Native applications
+// must create their own device and use iree_hal_webgpu_wrap_device as WebGPU
+// device creation is asynchronous.
+//
+// |out_driver| must be released by the caller (see |iree_hal_driver_release|).
+IREE_API_EXPORT iree_status_t iree_hal_webgpu_driver_create(
+    iree_string_view_t identifier,
+    const iree_hal_webgpu_driver_options_t* options,
+    iree_allocator_t host_allocator, iree_hal_driver_t** out_driver);
+
+#ifdef __cplusplus
+}  // extern "C"
+#endif  // __cplusplus
+
+#endif  // IREE_HAL_WEBGPU_API_H_
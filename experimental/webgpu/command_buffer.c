@@ -0,0 +1,989 @@
+// Copyright 2023 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include "experimental/webgpu/command_buffer.h"
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "experimental/webgpu/executable.h"
+#include "experimental/webgpu/pipeline_layout.h"
+#include "experimental/webgpu/webgpu_buffer.h"
+#include "experimental/webgpu/webgpu_transfer.h"
+#include "iree/base/api.h"
+#include "iree/base/tracing.h"
+#include "iree/hal/utils/resource_set.h"
+
+// Command buffer implementation that records directly into a
+// WGPUCommandEncoder. Data that must come from the host (push constants and
+// inline updates) is appended to staging blocks that are uploaded in bulk when
+// the command buffer is submitted.
+
+// All WebGPU copy offsets and sizes must be multiples of 4 bytes.
+#define IREE_HAL_WEBGPU_COPY_ALIGNMENT 4
+
+// Dynamic uniform buffer offsets must be aligned to
+// minUniformBufferOffsetAlignment, which is at most 256 bytes.
+#define IREE_HAL_WEBGPU_PARAMS_ALIGNMENT 256
+
+// A block of host memory mirrored by a device buffer. Commands reference the
+// device buffer and the host contents are uploaded prior to submission.
+typedef struct iree_hal_webgpu_staging_block_t {
+  struct iree_hal_webgpu_staging_block_t* next;
+  WGPUBuffer handle;
+  // Bind group referencing |handle| as the push constant binding; created on
+  // first use by a dispatch.
+  WGPUBindGroup params_bind_group;
+  iree_host_size_t used;
+  iree_host_size_t capacity;
+  uint8_t data[];
+} iree_hal_webgpu_staging_block_t;
+
+// A host-visible buffer referenced by the command buffer. The host allocation
+// is the source of truth outside of submissions and is synchronized with the
+// device buffer around them.
+typedef struct iree_hal_webgpu_host_buffer_ref_t {
+  iree_hal_buffer_t* buffer;
+  bool is_written;
+  // Offset of the buffer contents in the readback buffer when written.
+  iree_device_size_t readback_offset;
+} iree_hal_webgpu_host_buffer_ref_t;
+
+typedef struct iree_hal_webgpu_command_buffer_t {
+  iree_hal_command_buffer_t base;
+  iree_hal_webgpu_context_wrapper_t* context;
+  iree_host_size_t staging_block_size;
+
+  // Retains all HAL resources referenced by the command buffer.
+  iree_hal_resource_set_t* resource_set;
+
+  // Encoder used while recording; NULL after end.
+  WGPUCommandEncoder encoder;
+  // Compute pass currently open on |encoder|, if any.
+  WGPUComputePassEncoder compute_pass;
+  // Finished command buffer; NULL until end and again after submission.
+  WGPUCommandBuffer handle;
+
+  // Staging blocks in order of allocation; |staging_tail| is being filled.
+  iree_hal_webgpu_staging_block_t* staging_head;
+  iree_hal_webgpu_staging_block_t* staging_tail;
+
+  // Unique host-visible buffers referenced by commands.
+  iree_host_size_t host_buffer_count;
+  iree_host_size_t host_buffer_capacity;
+  iree_hal_webgpu_host_buffer_ref_t* host_buffers;
+
+  // Buffer all written host-visible buffers are copied into at the end of the
+  // command buffer so that they can be read back with a single map.
+  WGPUBuffer readback_buffer;
+  iree_device_size_t readback_size;
+
+  // Bind groups created for push_descriptor_set; released on destroy.
+  iree_host_size_t bind_group_count;
+  iree_host_size_t bind_group_capacity;
+  WGPUBindGroup* bind_groups;
+
+  // Bind groups bound to each set by push_descriptor_set.
+  WGPUBindGroup current_bind_groups[IREE_HAL_WEBGPU_MAX_BIND_GROUP_COUNT];
+
+  // Push constants bound by push_constants.
+  uint32_t push_constants[IREE_HAL_WEBGPU_MAX_PUSH_CONSTANT_COUNT];
+} iree_hal_webgpu_command_buffer_t;
+
+static const iree_hal_command_buffer_vtable_t
+    iree_hal_webgpu_command_buffer_vtable;
+
+static iree_hal_webgpu_command_buffer_t* iree_hal_webgpu_command_buffer_cast(
+    iree_hal_command_buffer_t* base_value) {
+  IREE_HAL_ASSERT_TYPE(base_value, &iree_hal_webgpu_command_buffer_vtable);
+  return (iree_hal_webgpu_command_buffer_t*)base_value;
+}
+
+iree_status_t iree_hal_webgpu_command_buffer_create(
+    iree_hal_device_t* device, iree_hal_webgpu_context_wrapper_t* context,
+    iree_hal_command_buffer_mode_t mode,
+    iree_hal_command_category_t command_categories,
+    iree_hal_queue_affinity_t queue_affinity, iree_host_size_t binding_capacity,
+    iree_arena_block_pool_t* block_pool, iree_host_size_t staging_block_size,
+    iree_hal_command_buffer_t** out_command_buffer) {
+  IREE_ASSERT_ARGUMENT(context);
+  IREE_ASSERT_ARGUMENT(block_pool);
+  IREE_ASSERT_ARGUMENT(out_command_buffer);
+  *out_command_buffer = NULL;
+
+  if (!iree_all_bits_set(mode, IREE_HAL_COMMAND_BUFFER_MODE_ONE_SHOT)) {
+    return iree_make_status(
+        IREE_STATUS_UNIMPLEMENTED,
+        "WebGPU command buffers can only be submitted once and must be "
+        "recorded with IREE_HAL_COMMAND_BUFFER_MODE_ONE_SHOT");
+  }
+  if (binding_capacity > 0) {
+    return iree_make_status(IREE_STATUS_UNIMPLEMENTED,
+                            "indirect command buffers not yet implemented");
+  }
+
+  IREE_TRACE_ZONE_BEGIN(z0);
+
+  iree_hal_webgpu_command_buffer_t* command_buffer = NULL;
+  iree_status_t status =
+      iree_allocator_malloc(context->host_allocator, sizeof(*command_buffer),
+                            (void**)&command_buffer);
+  if (iree_status_is_ok(status)) {
+    memset(command_buffer, 0, sizeof(*command_buffer));
+    iree_hal_command_buffer_initialize(
+        device, mode, command_categories, queue_affinity, binding_capacity,
+        &iree_hal_webgpu_command_buffer_vtable, &command_buffer->base);
+    command_buffer->context = context;
+    command_buffer->staging_block_size = iree_host_align(
+        staging_block_size, IREE_HAL_WEBGPU_PARAMS_ALIGNMENT);
+    status = iree_hal_resource_set_allocate(block_pool,
+                                            &command_buffer->resource_set);
+  }
+
+  if (iree_status_is_ok(status)) {
+    *out_command_buffer = &command_buffer->base;
+  } else if (command_buffer) {
+    iree_hal_command_buffer_destroy(&command_buffer->base);
+  }
+  IREE_TRACE_ZONE_END(z0);
+  return status;
+}
+
+static void iree_hal_webgpu_command_buffer_destroy(
+    iree_hal_command_buffer_t* base_command_buffer) {
+  iree_hal_webgpu_command_buffer_t* command_buffer =
+      iree_hal_webgpu_command_buffer_cast(base_command_buffer);
+  iree_allocator_t host_allocator = command_buffer->context->host_allocator;
+  IREE_TRACE_ZONE_BEGIN(z0);
+
+  if (command_buffer->compute_pass) {
+    wgpuComputePassEncoderRelease(command_buffer->compute_pass);
+  }
+  if (command_buffer->encoder) {
+    wgpuCommandEncoderRelease(command_buffer->encoder);
+  }
+  if (command_buffer->handle) {
+    wgpuCommandBufferRelease(command_buffer->handle);
+  }
+  for (iree_host_size_t i = 0; i < command_buffer->bind_group_count; ++i) {
+    wgpuBindGroupRelease(command_buffer->bind_groups[i]);
+  }
+  iree_allocator_free(host_allocator, command_buffer->bind_groups);
+
+  iree_hal_webgpu_staging_block_t* block = command_buffer->staging_head;
+  while (block) {
+    iree_hal_webgpu_staging_block_t* next = block->next;
+    if (block->params_bind_group) {
+      wgpuBindGroupRelease(block->params_bind_group);
+    }
+    wgpuBufferDestroy(block->handle);
+    wgpuBufferRelease(block->handle);
+    iree_allocator_free(host_allocator, block);
+    block = next;
+  }
+
+  if (command_buffer->readback_buffer) {
+    wgpuBufferDestroy(command_buffer->readback_buffer);
+    wgpuBufferRelease(command_buffer->readback_buffer);
+  }
+  iree_allocator_free(host_allocator, command_buffer->host_buffers);
+  if (command_buffer->resource_set) {
+    iree_hal_resource_set_free(command_buffer->resource_set);
+  }
+  iree_allocator_free(host_allocator, command_buffer);
+
+  IREE_TRACE_ZONE_END(z0);
+}
+
+bool iree_hal_webgpu_command_buffer_isa(
+    iree_hal_command_buffer_t* command_buffer) {
+  return iree_hal_command_buffer_dyn_cast(
+      command_buffer, &iree_hal_webgpu_command_buffer_vtable);
+}
+
+static void* iree_hal_webgpu_command_buffer_dyn_cast(
+    iree_hal_command_buffer_t* command_buffer, const void* vtable) {
+  if (vtable == &iree_hal_webgpu_command_buffer_vtable) {
+    IREE_HAL_ASSERT_TYPE(command_buffer, vtable);
+    return command_buffer;
+  }
+  return NULL;
+}
+
+//===----------------------------------------------------------------------===//
+// Recording utilities
+//===----------------------------------------------------------------------===//
+
+// Allocates |length| bytes aligned to |alignment| from the staging blocks.
+// |out_ptr| receives the host memory to populate and |out_handle| and
+// |out_offset| the location of the data on the device.
+static iree_status_t iree_hal_webgpu_command_buffer_stage(
+    iree_hal_webgpu_command_buffer_t* command_buffer, iree_host_size_t length,
+    iree_host_size_t alignment, iree_hal_webgpu_staging_block_t** out_block,
+    iree_host_size_t* out_offset, uint8_t** out_ptr) {
+  iree_hal_webgpu_staging_block_t* block = command_buffer->staging_tail;
+  iree_host_size_t offset = block ? iree_host_align(block->used, alignment) : 0;
+  if (!block || offset + length > block->capacity) {
+    // Oversized requests get a block of their own.
+    iree_host_size_t capacity = iree_max(
+        command_buffer->staging_block_size,
+        iree_host_align(length, IREE_HAL_WEBGPU_PARAMS_ALIGNMENT));
+    iree_allocator_t host_allocator = command_buffer->context->host_allocator;
+    IREE_RETURN_IF_ERROR(iree_allocator_malloc(
+        host_allocator, sizeof(*block) + capacity, (void**)&block));
+    const WGPUBufferDescriptor descriptor = {
+        .nextInChain = NULL,
+        .label = NULL,
+        .usage = WGPUBufferUsage_Uniform | WGPUBufferUsage_CopySrc |
+                 WGPUBufferUsage_CopyDst,
+        .size = capacity,
+        .mappedAtCreation = false,
+    };
+    block->handle =
+        wgpuDeviceCreateBuffer(command_buffer->context->device, &descriptor);
+    if (!block->handle) {
+      iree_allocator_free(host_allocator, block);
+      return iree_make_status(IREE_STATUS_RESOURCE_EXHAUSTED,
+                              "unable to allocate staging buffer of %zu bytes",
+                              capacity);
+    }
+    block->next = NULL;
+    block->params_bind_group = NULL;
+    block->used = 0;
+    block->capacity = capacity;
+    if (command_buffer->staging_tail) {
+      command_buffer->staging_tail->next = block;
+    } else {
+      command_buffer->staging_head = block;
+    }
+    command_buffer->staging_tail = block;
+    offset = 0;
+  }
+  block->used = offset + length;
+  *out_block = block;
+  *out_offset = offset;
+  *out_ptr = block->data + offset;
+  return iree_ok_status();
+}
+
+// Retains |buffer| and, if it is host-visible, records that its host contents
+// must be synchronized with the device around the submission.
+static iree_status_t iree_hal_webgpu_command_buffer_track_buffer(
+    iree_hal_webgpu_command_buffer_t* command_buffer, iree_hal_buffer_t* buffer,
+    bool is_written) {
+  IREE_RETURN_IF_ERROR(
+      iree_hal_resource_set_insert(command_buffer->resource_set, 1, &buffer));
+  iree_hal_buffer_t* allocated_buffer =
+      iree_hal_buffer_allocated_buffer(buffer);
+  if (!iree_hal_webgpu_buffer_host_pointer(allocated_buffer)) {
+    return iree_ok_status();
+  }
+  for (iree_host_size_t i = 0; i < command_buffer->host_buffer_count; ++i) {
+    if (command_buffer->host_buffers[i].buffer == allocated_buffer) {
+      command_buffer->host_buffers[i].is_written |= is_written;
+      return iree_ok_status();
+    }
+  }
+  if (command_buffer->host_buffer_count ==
+      command_buffer->host_buffer_capacity) {
+    iree_host_size_t new_capacity =
+        iree_max(8, command_buffer->host_buffer_capacity * 2);
+    IREE_RETURN_IF_ERROR(iree_allocator_realloc(
+        command_buffer->context->host_allocator,
+        new_capacity * sizeof(*command_buffer->host_buffers),
+        (void**)&command_buffer->host_buffers));
+    command_buffer->host_buffer_capacity = new_capacity;
+  }
+  iree_hal_webgpu_host_buffer_ref_t* ref =
+      &command_buffer->host_buffers[command_buffer->host_buffer_count++];
+  ref->buffer = allocated_buffer;
+  ref->is_written = is_written;
+  ref->readback_offset = 0;
+  return iree_ok_status();
+}
+
+// Ends the current compute pass, if any, so that transfer commands can be
+// recorded on the encoder.
+static void iree_hal_webgpu_command_buffer_end_pass(
+    iree_hal_webgpu_command_buffer_t* command_buffer) {
+  if (!command_buffer->compute_pass) return;
+  wgpuComputePassEncoderEnd(command_buffer->compute_pass);
+  wgpuComputePassEncoderRelease(command_buffer->compute_pass);
+  command_buffer->compute_pass = NULL;
+}
+
+static WGPUComputePassEncoder iree_hal_webgpu_command_buffer_begin_pass(
+    iree_hal_webgpu_command_buffer_t* command_buffer) {
+  if (!command_buffer->compute_pass) {
+    const WGPUComputePassDescriptor descriptor = {
+        .nextInChain = NULL,
+        .label = NULL,
+    };
+    command_buffer->compute_pass = wgpuCommandEncoderBeginComputePass(
+        command_buffer->encoder, &descriptor);
+  }
+  return command_buffer->compute_pass;
+}
+
+static iree_status_t iree_hal_webgpu_verify_copy_alignment(
+    iree_device_size_t offset, iree_device_size_t length) {
+  if (!iree_device_size_has_alignment(offset,
+                                      IREE_HAL_WEBGPU_COPY_ALIGNMENT) ||
+      !iree_device_size_has_alignment(length, IREE_HAL_WEBGPU_COPY_ALIGNMENT)) {
+    return iree_make_status(
+        IREE_STATUS_UNIMPLEMENTED,
+        "WebGPU transfer commands require 4 byte aligned offsets and lengths");
+  }
+  return iree_ok_status();
+}
+
+//===----------------------------------------------------------------------===//
+// iree_hal_command_buffer_t implementation
+//===----------------------------------------------------------------------===//
+
+static iree_status_t iree_hal_webgpu_command_buffer_begin(
+    iree_hal_command_buffer_t* base_command_buffer) {
+  iree_hal_webgpu_command_buffer_t* command_buffer =
+      iree_hal_webgpu_command_buffer_cast(base_command_buffer);
+  if (command_buffer->encoder || command_buffer->handle) {
+    return iree_make_status(IREE_STATUS_FAILED_PRECONDITION,
+                            "WebGPU command buffers can only be recorded once");
+  }
+  const WGPUCommandEncoderDescriptor descriptor = {
+      .nextInChain = NULL,
+      .label = NULL,
+  };
+  command_buffer->encoder = wgpuDeviceCreateCommandEncoder(
+      command_buffer->context->device, &descriptor);
+  if (!command_buffer->encoder) {
+    return iree_make_status(IREE_STATUS_INTERNAL,
+                            "wgpuDeviceCreateCommandEncoder failed");
+  }
+  return iree_ok_status();
+}
+
+static iree_status_t iree_hal_webgpu_command_buffer_end(
+    iree_hal_command_buffer_t* base_command_buffer) {
+  iree_hal_webgpu_command_buffer_t* command_buffer =
+      iree_hal_webgpu_command_buffer_cast(base_command_buffer);
+  IREE_TRACE_ZONE_BEGIN(z0);
+  iree_hal_webgpu_command_buffer_end_pass(command_buffer);
+
+  // Copy all written host-visible buffers into one readback buffer so that
+  // they can be retrieved with a single map after submission.
+  iree_device_size_t readback_size = 0;
+  for (iree_host_size_t i = 0; i < command_buffer->host_buffer_count; ++i) {
+    iree_hal_webgpu_host_buffer_ref_t* ref = &command_buffer->host_buffers[i];
+    if (!ref->is_written) continue;
+    ref->readback_offset = readback_size;
+    readback_size += iree_device_align(
+        iree_hal_buffer_allocation_size(ref->buffer),
+        IREE_HAL_WEBGPU_COPY_ALIGNMENT);
+  }
+  if (readback_size > 0) {
+    const WGPUBufferDescriptor descriptor = {
+        .nextInChain = NULL,
+        .label = NULL,
+        .usage = WGPUBufferUsage_MapRead | WGPUBufferUsage_CopyDst,
+        .size = readback_size,
+        .mappedAtCreation = false,
+    };
+    command_buffer->readback_buffer =
+        wgpuDeviceCreateBuffer(command_buffer->context->device, &descriptor);
+    if (!command_buffer->readback_buffer) {
+      IREE_TRACE_ZONE_END(z0);
+      return iree_make_status(IREE_STATUS_RESOURCE_EXHAUSTED,
+                              "unable to allocate readback buffer");
+    }
+    command_buffer->readback_size = readback_size;
+    for (iree_host_size_t i = 0; i < command_buffer->host_buffer_count; ++i) {
+      iree_hal_webgpu_host_buffer_ref_t* ref = &command_buffer->host_buffers[i];
+      if (!ref->is_written) continue;
+      iree_device_size_t length = iree_device_align(
+          iree_hal_buffer_allocation_size(ref->buffer),
+          IREE_HAL_WEBGPU_COPY_ALIGNMENT);
+      if (!length) continue;
+      wgpuCommandEncoderCopyBufferToBuffer(
+          command_buffer->encoder, iree_hal_webgpu_buffer_handle(ref->buffer),
+          0, command_buffer->readback_buffer, ref->readback_offset, length);
+    }
+  }
+
+  const WGPUCommandBufferDescriptor descriptor = {
+      .nextInChain = NULL,
+      .label = NULL,
+  };
+  command_buffer->handle =
+      wgpuCommandEncoderFinish(command_buffer->encoder, &descriptor);
+  wgpuCommandEncoderRelease(command_buffer->encoder);
+  command_buffer->encoder = NULL;
+
+  iree_status_t status = iree_ok_status();
+  if (!command_buffer->handle) {
+    status = iree_make_status(IREE_STATUS_INTERNAL,
+                              "wgpuCommandEncoderFinish failed");
+  }
+  IREE_TRACE_ZONE_END(z0);
+  return status;
+}
+
+static void iree_hal_webgpu_command_buffer_begin_debug_group(
+    iree_hal_command_buffer_t* base_command_buffer, iree_string_view_t label,
+    iree_hal_label_color_t label_color,
+    const iree_hal_label_location_t* location) {
+  // TODO(benvanik): wgpuCommandEncoderPushDebugGroup (needs a NUL-terminated
+  // copy of the label).
+}
+
+static void iree_hal_webgpu_command_buffer_end_debug_group(
+    iree_hal_command_buffer_t* base_command_buffer) {}
+
+static iree_status_t iree_hal_webgpu_command_buffer_execution_barrier(
+    iree_hal_command_buffer_t* base_command_buffer,
+    iree_hal_execution_stage_t source_stage_mask,
+    iree_hal_execution_stage_t target_stage_mask,
+    iree_hal_execution_barrier_flags_t flags,
+    iree_host_size_t memory_barrier_count,
+    const iree_hal_memory_barrier_t* memory_barriers,
+    iree_host_size_t buffer_barrier_count,
+    const iree_hal_buffer_barrier_t* buffer_barriers) {
+  // WebGPU tracks usage and inserts all required barriers itself.
+  return iree_ok_status();
+}
+
+static iree_status_t iree_hal_webgpu_command_buffer_signal_event(
+    iree_hal_command_buffer_t* base_command_buffer, iree_hal_event_t* event,
+    iree_hal_execution_stage_t source_stage_mask) {
+  // Commands execute in order; events are no-ops.
+  return iree_ok_status();
+}
+
+static iree_status_t iree_hal_webgpu_command_buffer_reset_event(
+    iree_hal_command_buffer_t* base_command_buffer, iree_hal_event_t* event,
+    iree_hal_execution_stage_t source_stage_mask) {
+  // Commands execute in order; events are no-ops.
+  return iree_ok_status();
+}
+
+static iree_status_t iree_hal_webgpu_command_buffer_wait_events(
+    iree_hal_command_buffer_t* base_command_buffer,
+    iree_host_size_t event_count, const iree_hal_event_t** events,
+    iree_hal_execution_stage_t source_stage_mask,
+    iree_hal_execution_stage_t target_stage_mask,
+    iree_host_size_t memory_barrier_count,
+    const iree_hal_memory_barrier_t* memory_barriers,
+    iree_host_size_t buffer_barrier_count,
+    const iree_hal_buffer_barrier_t* buffer_barriers) {
+  // Commands execute in order; events are no-ops.
+  return iree_ok_status();
+}
+
+static iree_status_t iree_hal_webgpu_command_buffer_discard_buffer(
+    iree_hal_command_buffer_t* base_command_buffer, iree_hal_buffer_t* buffer) {
+  // nothing to do.
+  return iree_ok_status();
+}
+
+static iree_status_t iree_hal_webgpu_command_buffer_fill_buffer(
+    iree_hal_command_buffer_t* base_command_buffer,
+    iree_hal_buffer_t* target_buffer, iree_device_size_t target_offset,
+    iree_device_size_t length, const void* pattern,
+    iree_host_size_t pattern_length) {
+  iree_hal_webgpu_command_buffer_t* command_buffer =
+      iree_hal_webgpu_command_buffer_cast(base_command_buffer);
+  if (length == 0) return iree_ok_status();
+  target_offset += iree_hal_buffer_byte_offset(target_buffer);
+  IREE_RETURN_IF_ERROR(
+      iree_hal_webgpu_verify_copy_alignment(target_offset, length));
+  IREE_RETURN_IF_ERROR(iree_hal_webgpu_command_buffer_track_buffer(
+      command_buffer, target_buffer, /*is_written=*/true));
+  WGPUBuffer target_handle = iree_hal_webgpu_buffer_handle(
+      iree_hal_buffer_allocated_buffer(target_buffer));
+  iree_hal_webgpu_command_buffer_end_pass(command_buffer);
+
+  // Zero fills are natively supported; all others are staged and copied.
+  bool is_zero = true;
+  for (iree_host_size_t i = 0; i < pattern_length; ++i) {
+    if (((const uint8_t*)pattern)[i] != 0) {
+      is_zero = false;
+      break;
+    }
+  }
+  if (is_zero) {
+    wgpuCommandEncoderClearBuffer(command_buffer->encoder, target_handle,
+                                  target_offset, length);
+    return iree_ok_status();
+  }
+
+  iree_hal_webgpu_staging_block_t* block = NULL;
+  iree_host_size_t staging_offset = 0;
+  uint8_t* staging_ptr = NULL;
+  IREE_RETURN_IF_ERROR(iree_hal_webgpu_command_buffer_stage(
+      command_buffer, (iree_host_size_t)length, IREE_HAL_WEBGPU_COPY_ALIGNMENT,
+      &block, &staging_offset, &staging_ptr));
+  switch (pattern_length) {
+    case 1:
+      memset(staging_ptr, *(const uint8_t*)pattern, (size_t)length);
+      break;
+    case 2:
+      for (iree_host_size_t i = 0; i < length / 2; ++i) {
+        ((uint16_t*)staging_ptr)[i] = *(const uint16_t*)pattern;
+      }
+      break;
+    case 4:
+      for (iree_host_size_t i = 0; i < length / 4; ++i) {
+        ((uint32_t*)staging_ptr)[i] = *(const uint32_t*)pattern;
+      }
+      break;
+    default:
+      return iree_make_status(IREE_STATUS_INVALID_ARGUMENT,
+                              "unsupported fill pattern length");
+  }
+  wgpuCommandEncoderCopyBufferToBuffer(command_buffer->encoder, block->handle,
+                                       staging_offset, target_handle,
+                                       target_offset, length);
+  return iree_ok_status();
+}
+
+static iree_status_t iree_hal_webgpu_command_buffer_update_buffer(
+    iree_hal_command_buffer_t* base_command_buffer, const void* source_buffer,
+    iree_host_size_t source_offset, iree_hal_buffer_t* target_buffer,
+    iree_device_size_t target_offset, iree_device_size_t length) {
+  iree_hal_webgpu_command_buffer_t* command_buffer =
+      iree_hal_webgpu_command_buffer_cast(base_command_buffer);
+  if (length == 0) return iree_ok_status();
+  target_offset += iree_hal_buffer_byte_offset(target_buffer);
+  IREE_RETURN_IF_ERROR(
+      iree_hal_webgpu_verify_copy_alignment(target_offset, length));
+  IREE_RETURN_IF_ERROR(iree_hal_webgpu_command_buffer_track_buffer(
+      command_buffer, target_buffer, /*is_written=*/true));
+  iree_hal_webgpu_command_buffer_end_pass(command_buffer);
+
+  // The source is only valid during this call so capture it in staging.
+  iree_hal_webgpu_staging_block_t* block = NULL;
+  iree_host_size_t staging_offset = 0;
+  uint8_t* staging_ptr = NULL;
+  IREE_RETURN_IF_ERROR(iree_hal_webgpu_command_buffer_stage(
+      command_buffer, (iree_host_size_t)length, IREE_HAL_WEBGPU_COPY_ALIGNMENT,
+      &block, &staging_offset, &staging_ptr));
+  memcpy(staging_ptr, (const uint8_t*)source_buffer + source_offset,
+         (size_t)length);
+  wgpuCommandEncoderCopyBufferToBuffer(
+      command_buffer->encoder, block->handle, staging_offset,
+      iree_hal_webgpu_buffer_handle(
+          iree_hal_buffer_allocated_buffer(target_buffer)),
+      target_offset, length);
+  return iree_ok_status();
+}
+
+static iree_status_t iree_hal_webgpu_command_buffer_copy_buffer(
+    iree_hal_command_buffer_t* base_command_buffer,
+    iree_hal_buffer_t* source_buffer, iree_device_size_t source_offset,
+    iree_hal_buffer_t* target_buffer, iree_device_size_t target_offset,
+    iree_device_size_t length) {
+  iree_hal_webgpu_command_buffer_t* command_buffer =
+      iree_hal_webgpu_command_buffer_cast(base_command_buffer);
+  if (length == 0) return iree_ok_status();
+  source_offset += iree_hal_buffer_byte_offset(source_buffer);
+  target_offset += iree_hal_buffer_byte_offset(target_buffer);
+  IREE_RETURN_IF_ERROR(
+      iree_hal_webgpu_verify_copy_alignment(source_offset, length));
+  IREE_RETURN_IF_ERROR(
+      iree_hal_webgpu_verify_copy_alignment(target_offset, length));
+  IREE_RETURN_IF_ERROR(iree_hal_webgpu_command_buffer_track_buffer(
+      command_buffer, source_buffer, /*is_written=*/false));
+  IREE_RETURN_IF_ERROR(iree_hal_webgpu_command_buffer_track_buffer(
+      command_buffer, target_buffer, /*is_written=*/true));
+  iree_hal_webgpu_command_buffer_end_pass(command_buffer);
+  wgpuCommandEncoderCopyBufferToBuffer(
+      command_buffer->encoder,
+      iree_hal_webgpu_buffer_handle(
+          iree_hal_buffer_allocated_buffer(source_buffer)),
+      source_offset,
+      iree_hal_webgpu_buffer_handle(
+          iree_hal_buffer_allocated_buffer(target_buffer)),
+      target_offset, length);
+  return iree_ok_status();
+}
+
+static iree_status_t iree_hal_webgpu_command_buffer_collective(
+    iree_hal_command_buffer_t* base_command_buffer, iree_hal_channel_t* channel,
+    iree_hal_collective_op_t op, uint32_t param,
+    iree_hal_buffer_binding_t send_binding,
+    iree_hal_buffer_binding_t recv_binding, iree_device_size_t element_count) {
+  return iree_make_status(IREE_STATUS_UNIMPLEMENTED,
+                          "collectives not supported by WebGPU");
+}
+
+static iree_status_t iree_hal_webgpu_command_buffer_push_constants(
+    iree_hal_command_buffer_t* base_command_buffer,
+    iree_hal_pipeline_layout_t* pipeline_layout, iree_host_size_t offset,
+    const void* values, iree_host_size_t values_length) {
+  iree_hal_webgpu_command_buffer_t* command_buffer =
+      iree_hal_webgpu_command_buffer_cast(base_command_buffer);
+  if (IREE_UNLIKELY(offset + values_length >
+                    sizeof(command_buffer->push_constants))) {
+    return iree_make_status(IREE_STATUS_INVALID_ARGUMENT,
+                            "push constant range %zu (length=%zu) out of range",
+                            offset, values_length);
+  }
+  memcpy((uint8_t*)command_buffer->push_constants + offset, values,
+         values_length);
+  return iree_ok_status();
+}
+
+static iree_status_t iree_hal_webgpu_command_buffer_push_descriptor_set(
+    iree_hal_command_buffer_t* base_command_buffer,
+    iree_hal_pipeline_layout_t* pipeline_layout, uint32_t set,
+    iree_host_size_t binding_count,
+    const iree_hal_descriptor_set_binding_t* bindings) {
+  iree_hal_webgpu_command_buffer_t* command_buffer =
+      iree_hal_webgpu_command_buffer_cast(base_command_buffer);
+  iree_hal_descriptor_set_layout_t* set_layout =
+      iree_hal_webgpu_pipeline_layout_set_layout(pipeline_layout, set);
+  if (!set_layout) {
+    return iree_make_status(IREE_STATUS_OUT_OF_RANGE,
+                            "set %u not present in the pipeline layout", set);
+  }
+  IREE_TRACE_ZONE_BEGIN(z0);
+  iree_allocator_t host_allocator = command_buffer->context->host_allocator;
+
+  // Make room to track the bind group before creating it.
+  if (command_buffer->bind_group_count == command_buffer->bind_group_capacity) {
+    iree_host_size_t new_capacity =
+        iree_max(16, command_buffer->bind_group_capacity * 2);
+    IREE_RETURN_AND_END_ZONE_IF_ERROR(
+        z0, iree_allocator_realloc(
+                host_allocator,
+                new_capacity * sizeof(*command_buffer->bind_groups),
+                (void**)&command_buffer->bind_groups));
+    command_buffer->bind_group_capacity = new_capacity;
+  }
+
+  WGPUBindGroupEntry* entries = NULL;
+  IREE_RETURN_AND_END_ZONE_IF_ERROR(
+      z0, iree_allocator_malloc(host_allocator,
+                                binding_count * sizeof(*entries),
+                                (void**)&entries));
+  iree_status_t status = iree_ok_status();
+  for (iree_host_size_t i = 0; i < binding_count; ++i) {
+    const iree_hal_descriptor_set_binding_t* binding = &bindings[i];
+    if (!binding->buffer) {
+      status = iree_make_status(IREE_STATUS_INVALID_ARGUMENT,
+                                "binding %u has no buffer", binding->binding);
+      break;
+    }
+    // Bindings may be written by the dispatch unless proven otherwise.
+    status = iree_hal_webgpu_command_buffer_track_buffer(
+        command_buffer, binding->buffer, /*is_written=*/true);
+    if (!iree_status_is_ok(status)) break;
+    iree_device_size_t length =
+        binding->length == IREE_WHOLE_BUFFER
+            ? iree_hal_buffer_byte_length(binding->buffer) - binding->offset
+            : binding->length;
+    memset(&entries[i], 0, sizeof(entries[i]));
+    entries[i].binding = binding->binding;
+    entries[i].buffer = iree_hal_webgpu_buffer_handle(
+        iree_hal_buffer_allocated_buffer(binding->buffer));
+    entries[i].offset =
+        iree_hal_buffer_byte_offset(binding->buffer) + binding->offset;
+    // Storage bindings must be sized in multiples of 4 bytes; allocations are
+    // padded so that this never extends past the end of the buffer.
+    entries[i].size =
+        iree_device_align(length, IREE_HAL_WEBGPU_COPY_ALIGNMENT);
+  }
+
+  if (iree_status_is_ok(status)) {
+    const WGPUBindGroupDescriptor descriptor = {
+        .nextInChain = NULL,
+        .label = NULL,
+        .layout = iree_hal_webgpu_descriptor_set_layout_handle(set_layout),
+        .entryCount = (uint32_t)binding_count,
+        .entries = entries,
+    };
+    WGPUBindGroup bind_group = wgpuDeviceCreateBindGroup(
+        command_buffer->context->device, &descriptor);
+    if (bind_group) {
+      command_buffer->bind_groups[command_buffer->bind_group_count++] =
+          bind_group;
+      command_buffer->current_bind_groups[set] = bind_group;
+    } else {
+      status = iree_make_status(IREE_STATUS_INTERNAL,
+                                "wgpuDeviceCreateBindGroup failed");
+    }
+  }
+  iree_allocator_free(host_allocator, entries);
+
+  IREE_TRACE_ZONE_END(z0);
+  return status;
+}
+
+// Binds the pipeline, descriptor sets, and push constants for a dispatch of
+// |entry_point| and returns the compute pass to dispatch on.
+static iree_status_t iree_hal_webgpu_command_buffer_prepare_dispatch(
+    iree_hal_webgpu_command_buffer_t* command_buffer,
+    iree_hal_executable_t* executable, int32_t entry_point,
+    WGPUComputePassEncoder* out_compute_pass) {
+  IREE_RETURN_IF_ERROR(iree_hal_resource_set_insert(
+      command_buffer->resource_set, 1, &executable));
+  iree_hal_pipeline_layout_t* layout =
+      iree_hal_webgpu_executable_layout(executable, entry_point);
+
+  // Stage push constants in the uniform buffer bound to the params set.
+  iree_hal_webgpu_staging_block_t* params_block = NULL;
+  iree_host_size_t params_offset = 0;
+  iree_host_size_t push_constant_count =
+      iree_hal_webgpu_pipeline_layout_push_constant_count(layout);
+  if (push_constant_count > 0) {
+    uint8_t* params_ptr = NULL;
+    IREE_RETURN_IF_ERROR(iree_hal_webgpu_command_buffer_stage(
+        command_buffer, IREE_HAL_WEBGPU_PARAMS_BINDING_SIZE,
+        IREE_HAL_WEBGPU_PARAMS_ALIGNMENT, &params_block, &params_offset,
+        &params_ptr));
+    memset(params_ptr, 0, IREE_HAL_WEBGPU_PARAMS_BINDING_SIZE);
+    memcpy(params_ptr, command_buffer->push_constants,
+           push_constant_count * sizeof(uint32_t));
+    if (!params_block->params_bind_group) {
+      const WGPUBindGroupEntry entry = {
+          .nextInChain = NULL,
+          .binding = IREE_HAL_WEBGPU_PARAMS_BINDING_INDEX,
+          .buffer = params_block->handle,
+          .offset = 0,
+          .size = IREE_HAL_WEBGPU_PARAMS_BINDING_SIZE,
+          .sampler = NULL,
+          .textureView = NULL,
+      };
+      const WGPUBindGroupDescriptor descriptor = {
+          .nextInChain = NULL,
+          .label = NULL,
+          .layout = command_buffer->context->params_bind_group_layout,
+          .entryCount = 1,
+          .entries = &entry,
+      };
+      params_block->params_bind_group = wgpuDeviceCreateBindGroup(
+          command_buffer->context->device, &descriptor);
+      if (!params_block->params_bind_group) {
+        return iree_make_status(IREE_STATUS_INTERNAL,
+                                "wgpuDeviceCreateBindGroup failed");
+      }
+    }
+  }
+
+  WGPUComputePassEncoder compute_pass =
+      iree_hal_webgpu_command_buffer_begin_pass(command_buffer);
+  wgpuComputePassEncoderSetPipeline(
+      compute_pass,
+      iree_hal_webgpu_executable_pipeline(executable, entry_point));
+
+  // All bind groups up to the last one used by the layout must be set; those
+  // not used by the executable are filled with the empty bind group.
+  iree_host_size_t set_count =
+      iree_hal_webgpu_pipeline_layout_set_count(layout);
+  iree_host_size_t bind_group_count =
+      push_constant_count > 0 ? IREE_HAL_WEBGPU_PARAMS_BIND_GROUP_INDEX
+                              : set_count;
+  for (iree_host_size_t i = 0; i < bind_group_count; ++i) {
+    WGPUBindGroup bind_group = i < set_count
+                                   ? command_buffer->current_bind_groups[i]
+                                   : command_buffer->context->empty_bind_group;
+    if (!bind_group) {
+      return iree_make_status(IREE_STATUS_FAILED_PRECONDITION,
+                              "descriptor set %zu not pushed prior to dispatch",
+                              i);
+    }
+    wgpuComputePassEncoderSetBindGroup(compute_pass, (uint32_t)i, bind_group, 0,
+                                       NULL);
+  }
+  if (params_block) {
+    uint32_t dynamic_offset = (uint32_t)params_offset;
+    wgpuComputePassEncoderSetBindGroup(
+        compute_pass, IREE_HAL_WEBGPU_PARAMS_BIND_GROUP_INDEX,
+        params_block->params_bind_group, 1, &dynamic_offset);
+  }
+
+  *out_compute_pass = compute_pass;
+  return iree_ok_status();
+}
+
+static iree_status_t iree_hal_webgpu_command_buffer_dispatch(
+    iree_hal_command_buffer_t* base_command_buffer,
+    iree_hal_executable_t* executable, int32_t entry_point,
+    uint32_t workgroup_x, uint32_t workgroup_y, uint32_t workgroup_z) {
+  iree_hal_webgpu_command_buffer_t* command_buffer =
+      iree_hal_webgpu_command_buffer_cast(base_command_buffer);
+  WGPUComputePassEncoder compute_pass = NULL;
+  IREE_RETURN_IF_ERROR(iree_hal_webgpu_command_buffer_prepare_dispatch(
+      command_buffer, executable, entry_point, &compute_pass));
+  wgpuComputePassEncoderDispatchWorkgroups(compute_pass, workgroup_x,
+                                           workgroup_y, workgroup_z);
+  return iree_ok_status();
+}
+
+static iree_status_t iree_hal_webgpu_command_buffer_dispatch_indirect(
+    iree_hal_command_buffer_t* base_command_buffer,
+    iree_hal_executable_t* executable, int32_t entry_point,
+    iree_hal_buffer_t* workgroups_buffer,
+    iree_device_size_t workgroups_offset) {
+  iree_hal_webgpu_command_buffer_t* command_buffer =
+      iree_hal_webgpu_command_buffer_cast(base_command_buffer);
+  IREE_RETURN_IF_ERROR(iree_hal_webgpu_command_buffer_track_buffer(
+      command_buffer, workgroups_buffer, /*is_written=*/false));
+  WGPUComputePassEncoder compute_pass = NULL;
+  IREE_RETURN_IF_ERROR(iree_hal_webgpu_command_buffer_prepare_dispatch(
+      command_buffer, executable, entry_point, &compute_pass));
+  wgpuComputePassEncoderDispatchWorkgroupsIndirect(
+      compute_pass,
+      iree_hal_webgpu_buffer_handle(
+          iree_hal_buffer_allocated_buffer(workgroups_buffer)),
+      iree_hal_buffer_byte_offset(workgroups_buffer) + workgroups_offset);
+  return iree_ok_status();
+}
+
+static iree_status_t iree_hal_webgpu_command_buffer_execute_commands(
+    iree_hal_command_buffer_t* base_command_buffer,
+    iree_hal_command_buffer_t* base_commands,
+    iree_hal_buffer_binding_table_t binding_table) {
+  return iree_make_status(IREE_STATUS_UNIMPLEMENTED,
+                          "indirect command buffers not yet implemented");
+}
+
+//===----------------------------------------------------------------------===//
+// Submission
+//===----------------------------------------------------------------------===//
+
+// Issues the queue writes required before |command_buffer| executes.
+static void iree_hal_webgpu_command_buffer_upload(
+    iree_hal_webgpu_command_buffer_t* command_buffer) {
+  WGPUQueue queue = command_buffer->context->queue;
+  for (iree_hal_webgpu_staging_block_t* block = command_buffer->staging_head;
+       block; block = block->next) {
+    iree_host_size_t length =
+        iree_host_align(block->used, IREE_HAL_WEBGPU_COPY_ALIGNMENT);
+    if (!length) continue;
+    wgpuQueueWriteBuffer(queue, block->handle, 0, block->data, length);
+  }
+  for (iree_host_size_t i = 0; i < command_buffer->host_buffer_count; ++i) {
+    iree_hal_buffer_t* buffer = command_buffer->host_buffers[i].buffer;
+    iree_device_size_t length =
+        iree_device_align(iree_hal_buffer_allocation_size(buffer),
+                          IREE_HAL_WEBGPU_COPY_ALIGNMENT);
+    if (!length) continue;
+    wgpuQueueWriteBuffer(queue, iree_hal_webgpu_buffer_handle(buffer), 0,
+                         iree_hal_webgpu_buffer_host_pointer(buffer),
+                         (size_t)length);
+  }
+}
+
+// Copies the contents of host-visible buffers written by |command_buffer| back
+// to their host allocations. Must be called after submission.
+static iree_status_t iree_hal_webgpu_command_buffer_readback(
+    iree_hal_webgpu_command_buffer_t* command_buffer) {
+  if (!command_buffer->readback_buffer) return iree_ok_status();
+  IREE_RETURN_IF_ERROR(iree_hal_webgpu_map_buffer_and_wait(
+      command_buffer->context, command_buffer->readback_buffer,
+      WGPUMapMode_Read, 0, command_buffer->readback_size));
+  const uint8_t* mapped_ptr = (const uint8_t*)wgpuBufferGetConstMappedRange(
+      command_buffer->readback_buffer, 0,
+      (size_t)command_buffer->readback_size);
+  for (iree_host_size_t i = 0; i < command_buffer->host_buffer_count; ++i) {
+    iree_hal_webgpu_host_buffer_ref_t* ref = &command_buffer->host_buffers[i];
+    if (!ref->is_written) continue;
+    memcpy(iree_hal_webgpu_buffer_host_pointer(ref->buffer),
+           mapped_ptr + ref->readback_offset,
+           (size_t)iree_hal_buffer_allocation_size(ref->buffer));
+  }
+  wgpuBufferUnmap(command_buffer->readback_buffer);
+  return iree_ok_status();
+}
+
+iree_status_t iree_hal_webgpu_command_buffer_submit_batch(
+    iree_hal_webgpu_context_wrapper_t* context,
+    iree_host_size_t command_buffer_count,
+    iree_hal_command_buffer_t* const* command_buffers) {
+  if (command_buffer_count == 0) return iree_ok_status();
+  IREE_TRACE_ZONE_BEGIN(z0);
+
+  WGPUCommandBuffer* handles = NULL;
+  IREE_RETURN_AND_END_ZONE_IF_ERROR(
+      z0, iree_allocator_malloc(context->host_allocator,
+                                command_buffer_count * sizeof(*handles),
+                                (void**)&handles));
+
+  // Queue writes are ordered before the submission that follows them so all
+  // uploads for the batch can be issued first.
+  iree_status_t status = iree_ok_status();
+  for (iree_host_size_t i = 0; i < command_buffer_count; ++i) {
+    if (!iree_hal_webgpu_command_buffer_isa(command_buffers[i])) {
+      status = iree_make_status(IREE_STATUS_INVALID_ARGUMENT,
+                                "command buffer %zu is not a WebGPU command "
+                                "buffer",
+                                i);
+      break;
+    }
+    iree_hal_webgpu_command_buffer_t* command_buffer =
+        iree_hal_webgpu_command_buffer_cast(command_buffers[i]);
+    if (!command_buffer->handle) {
+      status = iree_make_status(IREE_STATUS_FAILED_PRECONDITION,
+                                "command buffer %zu has not been ended or was "
+                                "already submitted",
+                                i);
+      break;
+    }
+    handles[i] = command_buffer->handle;
+  }
+  if (iree_status_is_ok(status)) {
+    for (iree_host_size_t i = 0; i < command_buffer_count; ++i) {
+      iree_hal_webgpu_command_buffer_upload(
+          iree_hal_webgpu_command_buffer_cast(command_buffers[i]));
+    }
+    wgpuQueueSubmit(context->queue, (uint32_t)command_buffer_count, handles);
+    for (iree_host_size_t i = 0; i < command_buffer_count; ++i) {
+      iree_hal_webgpu_command_buffer_t* command_buffer =
+          iree_hal_webgpu_command_buffer_cast(command_buffers[i]);
+      wgpuCommandBufferRelease(command_buffer->handle);
+      command_buffer->handle = NULL;
+    }
+  }
+
+  // Readbacks are applied in submission order so that a buffer written by
+  // multiple command buffers ends up with the contents of the last one.
+  for (iree_host_size_t i = 0;
+       iree_status_is_ok(status) && i < command_buffer_count; ++i) {
+    status = iree_hal_webgpu_command_buffer_readback(
+        iree_hal_webgpu_command_buffer_cast(command_buffers[i]));
+  }
+
+  iree_allocator_free(context->host_allocator, handles);
+  IREE_TRACE_ZONE_END(z0);
+  return status;
+}
+
+static const iree_hal_command_buffer_vtable_t
+    iree_hal_webgpu_command_buffer_vtable = {
+        .destroy = iree_hal_webgpu_command_buffer_destroy,
+        .dyn_cast = iree_hal_webgpu_command_buffer_dyn_cast,
+        .begin = iree_hal_webgpu_command_buffer_begin,
+        .end = iree_hal_webgpu_command_buffer_end,
+        .begin_debug_group = iree_hal_webgpu_command_buffer_begin_debug_group,
+        .end_debug_group = iree_hal_webgpu_command_buffer_end_debug_group,
+        .execution_barrier = iree_hal_webgpu_command_buffer_execution_barrier,
+        .signal_event = iree_hal_webgpu_command_buffer_signal_event,
+        .reset_event = iree_hal_webgpu_command_buffer_reset_event,
+        .wait_events = iree_hal_webgpu_command_buffer_wait_events,
+        .discard_buffer = iree_hal_webgpu_command_buffer_discard_buffer,
+        .fill_buffer = iree_hal_webgpu_command_buffer_fill_buffer,
+        .update_buffer = iree_hal_webgpu_command_buffer_update_buffer,
+        .copy_buffer = iree_hal_webgpu_command_buffer_copy_buffer,
+        .collective = iree_hal_webgpu_command_buffer_collective,
+        .push_constants = iree_hal_webgpu_command_buffer_push_constants,
+        .push_descriptor_set =
+            iree_hal_webgpu_command_buffer_push_descriptor_set,
+        .dispatch = iree_hal_webgpu_command_buffer_dispatch,
+        .dispatch_indirect = iree_hal_webgpu_command_buffer_dispatch_indirect,
+        .execute_commands = iree_hal_webgpu_command_buffer_execute_commands,
+};
@@ -0,0 +1,57 @@
+// Copyright 2023 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#ifndef IREE_HAL_WEBGPU_COMMAND_BUFFER_H_
+#define IREE_HAL_WEBGPU_COMMAND_BUFFER_H_
+
+#include "experimental/webgpu/context_wrapper.h"
+#include "experimental/webgpu/webgpu_headers.h"
+#include "iree/base/api.h"
+#include "iree/hal/api.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif  // __cplusplus
+
+typedef struct iree_arena_block_pool_t iree_arena_block_pool_t;
+
+// Creates a command buffer that records into a WGPUCommandEncoder.
+//
+// WGPUCommandBuffers can only be submitted once and as such only
+// IREE_HAL_COMMAND_BUFFER_MODE_ONE_SHOT command buffers are supported.
+//
+// Push constants and inline buffer updates are staged in host memory blocks of
+// |staging_block_size| bytes that are uploaded with a single queue write each
+// when the command buffer is submitted. Host-visible buffers referenced by the
+// command buffer have their host contents uploaded before and (if written by
+// the command buffer) read back after the submission.
+iree_status_t iree_hal_webgpu_command_buffer_create(
+    iree_hal_device_t* device, iree_hal_webgpu_context_wrapper_t* context,
+    iree_hal_command_buffer_mode_t mode,
+    iree_hal_command_category_t command_categories,
+    iree_hal_queue_affinity_t queue_affinity, iree_host_size_t binding_capacity,
+    iree_arena_block_pool_t* block_pool, iree_host_size_t staging_block_size,
+    iree_hal_command_buffer_t** out_command_buffer);
+
+// Returns true if |command_buffer| is a WebGPU command buffer.
+bool iree_hal_webgpu_command_buffer_isa(
+    iree_hal_command_buffer_t* command_buffer);
+
+// Submits |command_buffers| to the queue of |context| with a single
+// wgpuQueueSubmit and waits for any host-visible buffers they wrote to be read
+// back. All staging uploads for the batch are issued before the submission and
+// all readbacks are mapped after it so that the device is only synchronized
+// with once per batch.
+iree_status_t iree_hal_webgpu_command_buffer_submit_batch(
+    iree_hal_webgpu_context_wrapper_t* context,
+    iree_host_size_t command_buffer_count,
+    iree_hal_command_buffer_t* const* command_buffers);
+
+#ifdef __cplusplus
+}  // extern "C"
+#endif  // __cplusplus
+
+#endif  // IREE_HAL_WEBGPU_COMMAND_BUFFER_H_
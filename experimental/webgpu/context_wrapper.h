@@ -0,0 +1,51 @@
+// Copyright 2023 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#ifndef IREE_HAL_WEBGPU_CONTEXT_WRAPPER_H_
+#define IREE_HAL_WEBGPU_CONTEXT_WRAPPER_H_
+
+#include "experimental/webgpu/webgpu_headers.h"
+#include "iree/hal/api.h"
+
+// Bind group index used for the uniform buffer holding push constants.
+// Must match IREE_HAL_WEBGPU_PARAMS_BIND_GROUP_INDEX in the compiler
+// (WGSLReplacePushConstants.cpp).
+#define IREE_HAL_WEBGPU_PARAMS_BIND_GROUP_INDEX 3
+// Binding index of the push constant uniform buffer within its bind group.
+#define IREE_HAL_WEBGPU_PARAMS_BINDING_INDEX 0
+
+// Total number of bind groups available to executables (including the one
+// reserved for push constants). This is the WebGPU spec default limit.
+#define IREE_HAL_WEBGPU_MAX_BIND_GROUP_COUNT 4
+
+// Maximum number of 32-bit push constants per dispatch. The compiler packs
+// them into vec4<i32> elements of a uniform buffer.
+#define IREE_HAL_WEBGPU_MAX_PUSH_CONSTANT_COUNT 64
+
+// Size in bytes of the push constant range bound for each dispatch. This is
+// also the minUniformBufferOffsetAlignment spec default so each dispatch can
+// use a dynamic offset into a shared uniform buffer.
+#define IREE_HAL_WEBGPU_PARAMS_BINDING_SIZE 256
+
+// Note: this class is not thread safe; WebGPU objects must be used from the
+// thread that created them (the browser main thread or a worker).
+typedef struct iree_hal_webgpu_context_wrapper_t {
+  WGPUDevice device;
+  WGPUQueue queue;
+  iree_allocator_t host_allocator;
+
+  // Layout of the bind group used to pass push constants to executables:
+  // a single uniform buffer with a dynamic offset.
+  WGPUBindGroupLayout params_bind_group_layout;
+
+  // Layout and bind group used to fill the gaps between the bind groups
+  // declared by a pipeline layout and the push constant bind group as WebGPU
+  // requires that all bind groups up to the highest one are specified.
+  WGPUBindGroupLayout empty_bind_group_layout;
+  WGPUBindGroup empty_bind_group;
+} iree_hal_webgpu_context_wrapper_t;
+
+#endif  // IREE_HAL_WEBGPU_CONTEXT_WRAPPER_H_
@@ -0,0 +1,37 @@
+// Copyright 2023 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#ifndef IREE_HAL_WEBGPU_EXECUTABLE_H_
+#define IREE_HAL_WEBGPU_EXECUTABLE_H_
+
+#include "experimental/webgpu/context_wrapper.h"
+#include "iree/base/api.h"
+#include "iree/hal/api.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif  // __cplusplus
+
+// Creates an executable from a `webgpu-wgsl-fb` flatbuffer with one compute
+// pipeline per entry point.
+iree_status_t iree_hal_webgpu_executable_create(
+    iree_hal_webgpu_context_wrapper_t* context,
+    const iree_hal_executable_params_t* executable_params,
+    iree_hal_executable_t** out_executable);
+
+// Returns the compute pipeline for the given |entry_point|.
+WGPUComputePipeline iree_hal_webgpu_executable_pipeline(
+    iree_hal_executable_t* executable, int32_t entry_point);
+
+// Returns the pipeline layout the given |entry_point| was created with.
+iree_hal_pipeline_layout_t* iree_hal_webgpu_executable_layout(
+    iree_hal_executable_t* executable, int32_t entry_point);
+
+#ifdef __cplusplus
+}  // extern "C"
+#endif  // __cplusplus
+
+#endif  // IREE_HAL_WEBGPU_EXECUTABLE_H_
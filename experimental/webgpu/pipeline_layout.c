@@ -0,0 +1,303 @@
+// Copyright 2023 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include "experimental/webgpu/pipeline_layout.h"
+
+#include <stddef.h>
+#include <string.h>
+
+#include "iree/base/api.h"
+#include "iree/base/tracing.h"
+
+//===----------------------------------------------------------------------===//
+// iree_hal_webgpu_descriptor_set_layout_t
+//===----------------------------------------------------------------------===//
+
+typedef struct iree_hal_webgpu_descriptor_set_layout_t {
+  iree_hal_resource_t resource;
+  iree_hal_webgpu_context_wrapper_t* context;
+  WGPUBindGroupLayout handle;
+} iree_hal_webgpu_descriptor_set_layout_t;
+
+static const iree_hal_descriptor_set_layout_vtable_t
+    iree_hal_webgpu_descriptor_set_layout_vtable;
+
+static iree_hal_webgpu_descriptor_set_layout_t*
+iree_hal_webgpu_descriptor_set_layout_cast(
+    iree_hal_descriptor_set_layout_t* base_value) {
+  IREE_HAL_ASSERT_TYPE(base_value,
+                       &iree_hal_webgpu_descriptor_set_layout_vtable);
+  return (iree_hal_webgpu_descriptor_set_layout_t*)base_value;
+}
+
+static iree_status_t iree_hal_webgpu_populate_bind_group_layout_entry(
+    const iree_hal_descriptor_set_layout_binding_t* binding,
+    WGPUBindGroupLayoutEntry* out_entry) {
+  memset(out_entry, 0, sizeof(*out_entry));
+  out_entry->binding = binding->binding;
+  out_entry->visibility = WGPUShaderStage_Compute;
+  switch (binding->type) {
+    case IREE_HAL_DESCRIPTOR_TYPE_UNIFORM_BUFFER:
+      out_entry->buffer.type = WGPUBufferBindingType_Uniform;
+      break;
+    case IREE_HAL_DESCRIPTOR_TYPE_STORAGE_BUFFER:
+      out_entry->buffer.type =
+          iree_all_bits_set(binding->flags, IREE_HAL_DESCRIPTOR_FLAG_READ_ONLY)
+              ? WGPUBufferBindingType_ReadOnlyStorage
+              : WGPUBufferBindingType_Storage;
+      break;
+    default:
+      return iree_make_status(IREE_STATUS_UNIMPLEMENTED,
+                              "unsupported descriptor type %d",
+                              (int)binding->type);
+  }
+  out_entry->buffer.hasDynamicOffset = false;
+  out_entry->buffer.minBindingSize = 0;
+  return iree_ok_status();
+}
+
+iree_status_t iree_hal_webgpu_descriptor_set_layout_create(
+    iree_hal_webgpu_context_wrapper_t* context,
+    iree_hal_descriptor_set_layout_flags_t flags,
+    iree_host_size_t binding_count,
+    const iree_hal_descriptor_set_layout_binding_t* bindings,
+    iree_hal_descriptor_set_layout_t** out_descriptor_set_layout) {
+  IREE_ASSERT_ARGUMENT(context);
+  IREE_ASSERT_ARGUMENT(!binding_count || bindings);
+  IREE_ASSERT_ARGUMENT(out_descriptor_set_layout);
+  *out_descriptor_set_layout = NULL;
+  IREE_TRACE_ZONE_BEGIN(z0);
+
+  WGPUBindGroupLayoutEntry* entries = NULL;
+  iree_status_t status =
+      iree_allocator_malloc(context->host_allocator,
+                            binding_count * sizeof(*entries), (void**)&entries);
+  for (iree_host_size_t i = 0; i < binding_count; ++i) {
+    if (!iree_status_is_ok(status)) break;
+    status = iree_hal_webgpu_populate_bind_group_layout_entry(&bindings[i],
+                                                              &entries[i]);
+  }
+
+  WGPUBindGroupLayout handle = NULL;
+  if (iree_status_is_ok(status)) {
+    const WGPUBindGroupLayoutDescriptor descriptor = {
+        .nextInChain = NULL,
+        .label = NULL,
+        .entryCount = (uint32_t)binding_count,
+        .entries = entries,
+    };
+    handle = wgpuDeviceCreateBindGroupLayout(context->device, &descriptor);
+    if (!handle) {
+      status = iree_make_status(IREE_STATUS_INTERNAL,
+                                "wgpuDeviceCreateBindGroupLayout failed");
+    }
+  }
+  iree_allocator_free(context->host_allocator, entries);
+
+  iree_hal_webgpu_descriptor_set_layout_t* descriptor_set_layout = NULL;
+  if (iree_status_is_ok(status)) {
+    status = iree_allocator_malloc(context->host_allocator,
+                                   sizeof(*descriptor_set_layout),
+                                   (void**)&descriptor_set_layout);
+  }
+  if (iree_status_is_ok(status)) {
+    iree_hal_resource_initialize(&iree_hal_webgpu_descriptor_set_layout_vtable,
+                                 &descriptor_set_layout->resource);
+    descriptor_set_layout->context = context;
+    descriptor_set_layout->handle = handle;
+    *out_descriptor_set_layout =
+        (iree_hal_descriptor_set_layout_t*)descriptor_set_layout;
+  } else if (handle) {
+    wgpuBindGroupLayoutRelease(handle);
+  }
+
+  IREE_TRACE_ZONE_END(z0);
+  return status;
+}
+
+WGPUBindGroupLayout iree_hal_webgpu_descriptor_set_layout_handle(
+    iree_hal_descriptor_set_layout_t* base_descriptor_set_layout) {
+  iree_hal_webgpu_descriptor_set_layout_t* descriptor_set_layout =
+      iree_hal_webgpu_descriptor_set_layout_cast(base_descriptor_set_layout);
+  return descriptor_set_layout->handle;
+}
+
+static void iree_hal_webgpu_descriptor_set_layout_destroy(
+    iree_hal_descriptor_set_layout_t* base_descriptor_set_layout) {
+  iree_hal_webgpu_descriptor_set_layout_t* descriptor_set_layout =
+      iree_hal_webgpu_descriptor_set_layout_cast(base_descriptor_set_layout);
+  iree_allocator_t host_allocator =
+      descriptor_set_layout->context->host_allocator;
+  IREE_TRACE_ZONE_BEGIN(z0);
+
+  wgpuBindGroupLayoutRelease(descriptor_set_layout->handle);
+  iree_allocator_free(host_allocator, descriptor_set_layout);
+
+  IREE_TRACE_ZONE_END(z0);
+}
+
+static const iree_hal_descriptor_set_layout_vtable_t
+    iree_hal_webgpu_descriptor_set_layout_vtable = {
+        .destroy = iree_hal_webgpu_descriptor_set_layout_destroy,
+};
+
+//===----------------------------------------------------------------------===//
+// iree_hal_webgpu_pipeline_layout_t
+//===----------------------------------------------------------------------===//
+
+typedef struct iree_hal_webgpu_pipeline_layout_t {
+  iree_hal_resource_t resource;
+  iree_hal_webgpu_context_wrapper_t* context;
+  WGPUPipelineLayout handle;
+  iree_host_size_t push_constant_count;
+  iree_host_size_t set_layout_count;
+  iree_hal_descriptor_set_layout_t* set_layouts[];
+} iree_hal_webgpu_pipeline_layout_t;
+
+static const iree_hal_pipeline_layout_vtable_t
+    iree_hal_webgpu_pipeline_layout_vtable;
+
+static iree_hal_webgpu_pipeline_layout_t* iree_hal_webgpu_pipeline_layout_cast(
+    iree_hal_pipeline_layout_t* base_value) {
+  IREE_HAL_ASSERT_TYPE(base_value, &iree_hal_webgpu_pipeline_layout_vtable);
+  return (iree_hal_webgpu_pipeline_layout_t*)base_value;
+}
+
+iree_status_t iree_hal_webgpu_pipeline_layout_create(
+    iree_hal_webgpu_context_wrapper_t* context,
+    iree_host_size_t set_layout_count,
+    iree_hal_descriptor_set_layout_t* const* set_layouts,
+    iree_host_size_t push_constant_count,
+    iree_hal_pipeline_layout_t** out_pipeline_layout) {
+  IREE_ASSERT_ARGUMENT(context);
+  IREE_ASSERT_ARGUMENT(!set_layout_count || set_layouts);
+  IREE_ASSERT_ARGUMENT(out_pipeline_layout);
+  *out_pipeline_layout = NULL;
+
+  if (push_constant_count > IREE_HAL_WEBGPU_MAX_PUSH_CONSTANT_COUNT) {
+    return iree_make_status(IREE_STATUS_INVALID_ARGUMENT,
+                            "push constant count %zu over the limit of %d",
+                            push_constant_count,
+                            IREE_HAL_WEBGPU_MAX_PUSH_CONSTANT_COUNT);
+  }
+  const iree_host_size_t max_set_count =
+      push_constant_count > 0 ? IREE_HAL_WEBGPU_PARAMS_BIND_GROUP_INDEX
+                              : IREE_HAL_WEBGPU_MAX_BIND_GROUP_COUNT;
+  if (set_layout_count > max_set_count) {
+    return iree_make_status(IREE_STATUS_INVALID_ARGUMENT,
+                            "descriptor set count %zu over the limit of %zu",
+                            set_layout_count, max_set_count);
+  }
+
+  IREE_TRACE_ZONE_BEGIN(z0);
+
+  // Bind groups between the last descriptor set and the push constants are
+  // filled with an empty layout.
+  WGPUBindGroupLayout bind_group_layouts[IREE_HAL_WEBGPU_MAX_BIND_GROUP_COUNT];
+  iree_host_size_t bind_group_layout_count = set_layout_count;
+  for (iree_host_size_t i = 0; i < set_layout_count; ++i) {
+    bind_group_layouts[i] =
+        iree_hal_webgpu_descriptor_set_layout_handle(set_layouts[i]);
+  }
+  if (push_constant_count > 0) {
+    for (iree_host_size_t i = set_layout_count;
+         i < IREE_HAL_WEBGPU_PARAMS_BIND_GROUP_INDEX; ++i) {
+      bind_group_layouts[i] = context->empty_bind_group_layout;
+    }
+    bind_group_layouts[IREE_HAL_WEBGPU_PARAMS_BIND_GROUP_INDEX] =
+        context->params_bind_group_layout;
+    bind_group_layout_count = IREE_HAL_WEBGPU_PARAMS_BIND_GROUP_INDEX + 1;
+  }
+  const WGPUPipelineLayoutDescriptor descriptor = {
+      .nextInChain = NULL,
+      .label = NULL,
+      .bindGroupLayoutCount = (uint32_t)bind_group_layout_count,
+      .bindGroupLayouts = bind_group_layouts,
+  };
+  WGPUPipelineLayout handle =
+      wgpuDeviceCreatePipelineLayout(context->device, &descriptor);
+  if (!handle) {
+    IREE_TRACE_ZONE_END(z0);
+    return iree_make_status(IREE_STATUS_INTERNAL,
+                            "wgpuDeviceCreatePipelineLayout failed");
+  }
+
+  iree_hal_webgpu_pipeline_layout_t* pipeline_layout = NULL;
+  iree_host_size_t total_size =
+      sizeof(*pipeline_layout) +
+      set_layout_count * sizeof(*pipeline_layout->set_layouts);
+  iree_status_t status = iree_allocator_malloc(
+      context->host_allocator, total_size, (void**)&pipeline_layout);
+  if (iree_status_is_ok(status)) {
+    iree_hal_resource_initialize(&iree_hal_webgpu_pipeline_layout_vtable,
+                                 &pipeline_layout->resource);
+    pipeline_layout->context = context;
+    pipeline_layout->handle = handle;
+    pipeline_layout->push_constant_count = push_constant_count;
+    pipeline_layout->set_layout_count = set_layout_count;
+    for (iree_host_size_t i = 0; i < set_layout_count; ++i) {
+      pipeline_layout->set_layouts[i] = set_layouts[i];
+      iree_hal_descriptor_set_layout_retain(set_layouts[i]);
+    }
+    *out_pipeline_layout = (iree_hal_pipeline_layout_t*)pipeline_layout;
+  } else {
+    wgpuPipelineLayoutRelease(handle);
+  }
+
+  IREE_TRACE_ZONE_END(z0);
+  return status;
+}
+
+static void iree_hal_webgpu_pipeline_layout_destroy(
+    iree_hal_pipeline_layout_t* base_pipeline_layout) {
+  iree_hal_webgpu_pipeline_layout_t* pipeline_layout =
+      iree_hal_webgpu_pipeline_layout_cast(base_pipeline_layout);
+  iree_allocator_t host_allocator = pipeline_layout->context->host_allocator;
+  IREE_TRACE_ZONE_BEGIN(z0);
+
+  wgpuPipelineLayoutRelease(pipeline_layout->handle);
+  for (iree_host_size_t i = 0; i < pipeline_layout->set_layout_count; ++i) {
+    iree_hal_descriptor_set_layout_release(pipeline_layout->set_layouts[i]);
+  }
+  iree_allocator_free(host_allocator, pipeline_layout);
+
+  IREE_TRACE_ZONE_END(z0);
+}
+
+WGPUPipelineLayout iree_hal_webgpu_pipeline_layout_handle(
+    iree_hal_pipeline_layout_t* base_pipeline_layout) {
+  iree_hal_webgpu_pipeline_layout_t* pipeline_layout =
+      iree_hal_webgpu_pipeline_layout_cast(base_pipeline_layout);
+  return pipeline_layout->handle;
+}
+
+iree_host_size_t iree_hal_webgpu_pipeline_layout_set_count(
+    iree_hal_pipeline_layout_t* base_pipeline_layout) {
+  iree_hal_webgpu_pipeline_layout_t* pipeline_layout =
+      iree_hal_webgpu_pipeline_layout_cast(base_pipeline_layout);
+  return pipeline_layout->set_layout_count;
+}
+
+iree_hal_descriptor_set_layout_t* iree_hal_webgpu_pipeline_layout_set_layout(
+    iree_hal_pipeline_layout_t* base_pipeline_layout, uint32_t set) {
+  iree_hal_webgpu_pipeline_layout_t* pipeline_layout =
+      iree_hal_webgpu_pipeline_layout_cast(base_pipeline_layout);
+  return set < pipeline_layout->set_layout_count
+             ? pipeline_layout->set_layouts[set]
+             : NULL;
+}
+
+iree_host_size_t iree_hal_webgpu_pipeline_layout_push_constant_count(
+    iree_hal_pipeline_layout_t* base_pipeline_layout) {
+  iree_hal_webgpu_pipeline_layout_t* pipeline_layout =
+      iree_hal_webgpu_pipeline_layout_cast(base_pipeline_layout);
+  return pipeline_layout->push_constant_count;
+}
+
+static const iree_hal_pipeline_layout_vtable_t
+    iree_hal_webgpu_pipeline_layout_vtable = {
+        .destroy = iree_hal_webgpu_pipeline_layout_destroy,
+};
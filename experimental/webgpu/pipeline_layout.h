@@ -0,0 +1,69 @@
+// Copyright 2023 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#ifndef IREE_HAL_WEBGPU_PIPELINE_LAYOUT_H_
+#define IREE_HAL_WEBGPU_PIPELINE_LAYOUT_H_
+
+#include "experimental/webgpu/context_wrapper.h"
+#include "iree/base/api.h"
+#include "iree/hal/api.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif  // __cplusplus
+
+//===----------------------------------------------------------------------===//
+// iree_hal_webgpu_descriptor_set_layout_t
+//===----------------------------------------------------------------------===//
+
+// Creates a descriptor set layout backed by a WGPUBindGroupLayout.
+// HAL descriptor set N is bound as WebGPU bind group N.
+iree_status_t iree_hal_webgpu_descriptor_set_layout_create(
+    iree_hal_webgpu_context_wrapper_t* context,
+    iree_hal_descriptor_set_layout_flags_t flags,
+    iree_host_size_t binding_count,
+    const iree_hal_descriptor_set_layout_binding_t* bindings,
+    iree_hal_descriptor_set_layout_t** out_descriptor_set_layout);
+
+// Returns the WebGPU bind group layout of |descriptor_set_layout|.
+WGPUBindGroupLayout iree_hal_webgpu_descriptor_set_layout_handle(
+    iree_hal_descriptor_set_layout_t* descriptor_set_layout);
+
+//===----------------------------------------------------------------------===//
+// iree_hal_webgpu_pipeline_layout_t
+//===----------------------------------------------------------------------===//
+
+// Creates a pipeline layout backed by a WGPUPipelineLayout. When
+// |push_constant_count| is non-zero the push constants are passed as a
+// uniform buffer in bind group IREE_HAL_WEBGPU_PARAMS_BIND_GROUP_INDEX.
+iree_status_t iree_hal_webgpu_pipeline_layout_create(
+    iree_hal_webgpu_context_wrapper_t* context,
+    iree_host_size_t set_layout_count,
+    iree_hal_descriptor_set_layout_t* const* set_layouts,
+    iree_host_size_t push_constant_count,
+    iree_hal_pipeline_layout_t** out_pipeline_layout);
+
+// Returns the WebGPU pipeline layout of |pipeline_layout|.
+WGPUPipelineLayout iree_hal_webgpu_pipeline_layout_handle(
+    iree_hal_pipeline_layout_t* pipeline_layout);
+
+// Returns the number of descriptor sets in |pipeline_layout|.
+iree_host_size_t iree_hal_webgpu_pipeline_layout_set_count(
+    iree_hal_pipeline_layout_t* pipeline_layout);
+
+// Returns the layout of descriptor set |set| in |pipeline_layout|.
+iree_hal_descriptor_set_layout_t* iree_hal_webgpu_pipeline_layout_set_layout(
+    iree_hal_pipeline_layout_t* pipeline_layout, uint32_t set);
+
+// Returns the number of 32-bit push constants used by |pipeline_layout|.
+iree_host_size_t iree_hal_webgpu_pipeline_layout_push_constant_count(
+    iree_hal_pipeline_layout_t* pipeline_layout);
+
+#ifdef __cplusplus
+}  // extern "C"
+#endif  // __cplusplus
+
+#endif  // IREE_HAL_WEBGPU_PIPELINE_LAYOUT_H_
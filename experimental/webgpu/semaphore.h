@@ -0,0 +1,44 @@
+// Copyright 2023 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#ifndef IREE_HAL_WEBGPU_SEMAPHORE_H_
+#define IREE_HAL_WEBGPU_SEMAPHORE_H_
+
+#include "iree/base/api.h"
+#include "iree/base/internal/synchronization.h"
+#include "iree/hal/api.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif  // __cplusplus
+
+// Creates a host-side timeline semaphore.
+//
+// WebGPU has no timeline primitive that can be observed from the host without
+// yielding to the event loop. All queue operations wait for their semaphores
+// on the host before being issued and the WebGPU queue executes work in
+// submission order, so semaphores are signaled as soon as the work they guard
+// has been submitted. Host reads of device memory (mapping or transfers) wait
+// for the device to finish the prior work before returning.
+//
+// |notification| is shared by all semaphores of a device and posted whenever
+// any of them changes so that multi-waits can be performed. It must remain
+// valid for the lifetime of the semaphore.
+iree_status_t iree_hal_webgpu_semaphore_create(
+    iree_notification_t* notification, uint64_t initial_value,
+    iree_allocator_t host_allocator, iree_hal_semaphore_t** out_semaphore);
+
+// Waits for one or more semaphores in |semaphore_list| to be reached.
+// All semaphores must share |notification|.
+iree_status_t iree_hal_webgpu_semaphore_multi_wait(
+    iree_notification_t* notification, iree_hal_wait_mode_t wait_mode,
+    const iree_hal_semaphore_list_t semaphore_list, iree_timeout_t timeout);
+
+#ifdef __cplusplus
+}  // extern "C"
+#endif  // __cplusplus
+
+#endif  // IREE_HAL_WEBGPU_SEMAPHORE_H_
@@ -0,0 +1,245 @@
+// Copyright 2023 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include "experimental/webgpu/webgpu_allocator.h"
+
+#include <inttypes.h>
+#include <stddef.h>
+#include <string.h>
+
+#include "experimental/webgpu/webgpu_buffer.h"
+#include "iree/base/api.h"
+#include "iree/base/tracing.h"
+
+typedef struct iree_hal_webgpu_allocator_t {
+  iree_hal_resource_t resource;
+  iree_hal_device_t* base_device;
+  iree_hal_webgpu_context_wrapper_t* context;
+
+  IREE_STATISTICS(iree_hal_allocator_statistics_t statistics;)
+} iree_hal_webgpu_allocator_t;
+
+static const iree_hal_allocator_vtable_t iree_hal_webgpu_allocator_vtable;
+
+static iree_hal_webgpu_allocator_t* iree_hal_webgpu_allocator_cast(
+    iree_hal_allocator_t* base_value) {
+  IREE_HAL_ASSERT_TYPE(base_value, &iree_hal_webgpu_allocator_vtable);
+  return (iree_hal_webgpu_allocator_t*)base_value;
+}
+
+iree_status_t iree_hal_webgpu_allocator_create(
+    iree_hal_device_t* base_device, iree_hal_webgpu_context_wrapper_t* context,
+    iree_hal_allocator_t** out_allocator) {
+  IREE_ASSERT_ARGUMENT(base_device);
+  IREE_ASSERT_ARGUMENT(context);
+  IREE_ASSERT_ARGUMENT(out_allocator);
+  *out_allocator = NULL;
+  IREE_TRACE_ZONE_BEGIN(z0);
+
+  iree_hal_webgpu_allocator_t* allocator = NULL;
+  iree_status_t status = iree_allocator_malloc(
+      context->host_allocator, sizeof(*allocator), (void**)&allocator);
+  if (iree_status_is_ok(status)) {
+    iree_hal_resource_initialize(&iree_hal_webgpu_allocator_vtable,
+                                 &allocator->resource);
+    allocator->base_device = base_device;
+    allocator->context = context;
+    *out_allocator = (iree_hal_allocator_t*)allocator;
+  }
+
+  IREE_TRACE_ZONE_END(z0);
+  return status;
+}
+
+static void iree_hal_webgpu_allocator_destroy(
+    iree_hal_allocator_t* IREE_RESTRICT base_allocator) {
+  iree_hal_webgpu_allocator_t* allocator =
+      iree_hal_webgpu_allocator_cast(base_allocator);
+  iree_allocator_t host_allocator = allocator->context->host_allocator;
+  IREE_TRACE_ZONE_BEGIN(z0);
+
+  iree_allocator_free(host_allocator, allocator);
+
+  IREE_TRACE_ZONE_END(z0);
+}
+
+static iree_allocator_t iree_hal_webgpu_allocator_host_allocator(
+    const iree_hal_allocator_t* IREE_RESTRICT base_allocator) {
+  iree_hal_webgpu_allocator_t* allocator =
+      (iree_hal_webgpu_allocator_t*)base_allocator;
+  return allocator->context->host_allocator;
+}
+
+static iree_status_t iree_hal_webgpu_allocator_trim(
+    iree_hal_allocator_t* IREE_RESTRICT base_allocator) {
+  return iree_ok_status();
+}
+
+static void iree_hal_webgpu_allocator_query_statistics(
+    iree_hal_allocator_t* IREE_RESTRICT base_allocator,
+    iree_hal_allocator_statistics_t* IREE_RESTRICT out_statistics) {
+  IREE_STATISTICS({
+    iree_hal_webgpu_allocator_t* allocator =
+        iree_hal_webgpu_allocator_cast(base_allocator);
+    memcpy(out_statistics, &allocator->statistics, sizeof(*out_statistics));
+  });
+}
+
+static iree_hal_buffer_compatibility_t
+iree_hal_webgpu_allocator_query_compatibility(
+    iree_hal_allocator_t* IREE_RESTRICT base_allocator,
+    const iree_hal_buffer_params_t* IREE_RESTRICT params,
+    iree_device_size_t allocation_size) {
+  // All buffers are WebGPU storage buffers and can be used on the queue;
+  // host-visible ones are synchronized with their host shadow around each
+  // submission.
+  iree_hal_buffer_compatibility_t compatibility =
+      IREE_HAL_BUFFER_COMPATIBILITY_ALLOCATABLE;
+  if (iree_any_bit_set(params->usage, IREE_HAL_BUFFER_USAGE_TRANSFER)) {
+    compatibility |= IREE_HAL_BUFFER_COMPATIBILITY_QUEUE_TRANSFER;
+  }
+  if (iree_any_bit_set(params->usage,
+                       IREE_HAL_BUFFER_USAGE_DISPATCH_STORAGE |
+                           IREE_HAL_BUFFER_USAGE_DISPATCH_UNIFORM_READ)) {
+    compatibility |= IREE_HAL_BUFFER_COMPATIBILITY_QUEUE_DISPATCH;
+  }
+  // WebGPU buffers can only be persistently mapped by staging them in host
+  // memory.
+  if (iree_all_bits_set(params->usage,
+                        IREE_HAL_BUFFER_USAGE_MAPPING_PERSISTENT) &&
+      !iree_all_bits_set(params->type, IREE_HAL_MEMORY_TYPE_HOST_VISIBLE)) {
+    compatibility = IREE_HAL_BUFFER_COMPATIBILITY_NONE;
+  }
+  return compatibility;
+}
+
+static iree_status_t iree_hal_webgpu_allocator_allocate_buffer(
+    iree_hal_allocator_t* IREE_RESTRICT base_allocator,
+    const iree_hal_buffer_params_t* IREE_RESTRICT params,
+    iree_device_size_t allocation_size, iree_const_byte_span_t initial_data,
+    iree_hal_buffer_t** IREE_RESTRICT out_buffer) {
+  iree_hal_webgpu_allocator_t* allocator =
+      iree_hal_webgpu_allocator_cast(base_allocator);
+  iree_allocator_t host_allocator = allocator->context->host_allocator;
+
+  // WebGPU requires buffer sizes (and all copy offsets and lengths) to be
+  // multiples of 4 bytes. Rounding up the allocation lets transfers touching
+  // the tail of the buffer be widened to that alignment.
+  iree_device_size_t device_size = iree_device_align(
+      allocation_size ? allocation_size : 4, sizeof(uint32_t));
+
+  WGPUBufferUsageFlags usage = WGPUBufferUsage_Storage |
+                               WGPUBufferUsage_CopySrc |
+                               WGPUBufferUsage_CopyDst;
+  if (iree_any_bit_set(params->usage,
+                       IREE_HAL_BUFFER_USAGE_DISPATCH_UNIFORM_READ)) {
+    usage |= WGPUBufferUsage_Uniform;
+  }
+  if (iree_any_bit_set(params->usage,
+                       IREE_HAL_BUFFER_USAGE_DISPATCH_INDIRECT_PARAMS)) {
+    usage |= WGPUBufferUsage_Indirect;
+  }
+  const WGPUBufferDescriptor descriptor = {
+      .nextInChain = NULL,
+      .label = NULL,
+      .usage = usage,
+      .size = device_size,
+      .mappedAtCreation = false,
+  };
+  WGPUBuffer handle =
+      wgpuDeviceCreateBuffer(allocator->context->device, &descriptor);
+  if (!handle) {
+    return iree_make_status(IREE_STATUS_RESOURCE_EXHAUSTED,
+                            "unable to allocate buffer of size %" PRIu64,
+                            (uint64_t)device_size);
+  }
+
+  // Host-visible buffers get a host allocation that can be mapped directly.
+  iree_status_t status = iree_ok_status();
+  void* host_ptr = NULL;
+  if (iree_all_bits_set(params->type, IREE_HAL_MEMORY_TYPE_HOST_VISIBLE)) {
+    status = iree_allocator_malloc(host_allocator,
+                                   (iree_host_size_t)device_size, &host_ptr);
+  }
+
+  iree_hal_buffer_t* buffer = NULL;
+  if (iree_status_is_ok(status)) {
+    status = iree_hal_webgpu_buffer_wrap(
+        allocator->base_device, base_allocator, params->type, params->access,
+        params->usage, allocation_size, handle, host_ptr, &buffer);
+  }
+
+  // Copy the initial contents into the buffer. This may require staging.
+  if (iree_status_is_ok(status) &&
+      !iree_const_byte_span_is_empty(initial_data)) {
+    status = iree_hal_device_transfer_range(
+        allocator->base_device,
+        iree_hal_make_host_transfer_buffer_span((void*)initial_data.data,
+                                                initial_data.data_length),
+        0, iree_hal_make_device_transfer_buffer(buffer), 0,
+        initial_data.data_length, IREE_HAL_TRANSFER_BUFFER_FLAG_DEFAULT,
+        iree_infinite_timeout());
+  }
+
+  if (iree_status_is_ok(status)) {
+    IREE_STATISTICS(iree_hal_allocator_statistics_record_alloc(
+        &allocator->statistics, params->type, allocation_size));
+    *out_buffer = buffer;
+  } else {
+    if (!buffer) {
+      wgpuBufferDestroy(handle);
+      wgpuBufferRelease(handle);
+      iree_allocator_free(host_allocator, host_ptr);
+    } else {
+      iree_hal_buffer_release(buffer);
+    }
+  }
+  return status;
+}
+
+static void iree_hal_webgpu_allocator_deallocate_buffer(
+    iree_hal_allocator_t* IREE_RESTRICT base_allocator,
+    iree_hal_buffer_t* IREE_RESTRICT base_buffer) {
+  iree_hal_webgpu_allocator_t* allocator =
+      iree_hal_webgpu_allocator_cast(base_allocator);
+  (void)allocator;
+  IREE_STATISTICS(iree_hal_allocator_statistics_record_free(
+      &allocator->statistics, iree_hal_buffer_memory_type(base_buffer),
+      iree_hal_buffer_allocation_size(base_buffer)));
+  iree_hal_buffer_destroy(base_buffer);
+}
+
+static iree_status_t iree_hal_webgpu_allocator_import_buffer(
+    iree_hal_allocator_t* IREE_RESTRICT base_allocator,
+    const iree_hal_buffer_params_t* IREE_RESTRICT params,
+    iree_hal_external_buffer_t* IREE_RESTRICT external_buffer,
+    iree_hal_buffer_release_callback_t release_callback,
+    iree_hal_buffer_t** IREE_RESTRICT out_buffer) {
+  return iree_make_status(IREE_STATUS_UNAVAILABLE,
+                          "importing from external buffers not supported");
+}
+
+static iree_status_t iree_hal_webgpu_allocator_export_buffer(
+    iree_hal_allocator_t* IREE_RESTRICT base_allocator,
+    iree_hal_buffer_t* IREE_RESTRICT buffer,
+    iree_hal_external_buffer_type_t requested_type,
+    iree_hal_external_buffer_flags_t requested_flags,
+    iree_hal_external_buffer_t* IREE_RESTRICT out_external_buffer) {
+  return iree_make_status(IREE_STATUS_UNAVAILABLE,
+                          "exporting to external buffers not supported");
+}
+
+static const iree_hal_allocator_vtable_t iree_hal_webgpu_allocator_vtable = {
+    .destroy = iree_hal_webgpu_allocator_destroy,
+    .host_allocator = iree_hal_webgpu_allocator_host_allocator,
+    .trim = iree_hal_webgpu_allocator_trim,
+    .query_statistics = iree_hal_webgpu_allocator_query_statistics,
+    .query_compatibility = iree_hal_webgpu_allocator_query_compatibility,
+    .allocate_buffer = iree_hal_webgpu_allocator_allocate_buffer,
+    .deallocate_buffer = iree_hal_webgpu_allocator_deallocate_buffer,
+    .import_buffer = iree_hal_webgpu_allocator_import_buffer,
+    .export_buffer = iree_hal_webgpu_allocator_export_buffer,
+};
@@ -0,0 +1,32 @@
+// Copyright 2023 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#ifndef IREE_HAL_WEBGPU_ALLOCATOR_H_
+#define IREE_HAL_WEBGPU_ALLOCATOR_H_
+
+#include "experimental/webgpu/context_wrapper.h"
+#include "iree/base/api.h"
+#include "iree/hal/api.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif  // __cplusplus
+
+// Creates a WebGPU allocator.
+//
+// All buffers are backed by WebGPU storage buffers. Host-visible buffers are
+// additionally shadowed in host memory that can be mapped directly; the
+// contents are synchronized with the WebGPU buffer as part of each queue
+// operation referencing the buffer (see iree_hal_webgpu_buffer_wrap).
+iree_status_t iree_hal_webgpu_allocator_create(
+    iree_hal_device_t* base_device, iree_hal_webgpu_context_wrapper_t* context,
+    iree_hal_allocator_t** out_allocator);
+
+#ifdef __cplusplus
+}  // extern "C"
+#endif  // __cplusplus
+
+#endif  // IREE_HAL_WEBGPU_ALLOCATOR_H_
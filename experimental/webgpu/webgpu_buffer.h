@@ -0,0 +1,48 @@
+// Copyright 2023 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#ifndef IREE_HAL_WEBGPU_BUFFER_H_
+#define IREE_HAL_WEBGPU_BUFFER_H_
+
+#include "experimental/webgpu/webgpu_headers.h"
+#include "iree/base/api.h"
+#include "iree/hal/api.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif  // __cplusplus
+
+// Wraps a WebGPU buffer in an iree_hal_buffer_t and takes ownership of it.
+//
+// WebGPU storage buffers cannot be mapped by the host. Host-visible buffers
+// pair the |handle| with |host_ptr|, an allocation from the host allocator that
+// is used for mapping and is uploaded to or downloaded from |handle| around
+// each queue submission using the buffer. |host_ptr| is owned by the buffer.
+// Other buffers have no |host_ptr| and scoped mappings of them are staged
+// through |device|.
+iree_status_t iree_hal_webgpu_buffer_wrap(
+    iree_hal_device_t* device, iree_hal_allocator_t* allocator,
+    iree_hal_memory_type_t memory_type, iree_hal_memory_access_t allowed_access,
+    iree_hal_buffer_usage_t allowed_usage, iree_device_size_t allocation_size,
+    WGPUBuffer handle, void* host_ptr, iree_hal_buffer_t** out_buffer);
+
+// Returns true if |buffer| is a WebGPU buffer created by this driver.
+bool iree_hal_webgpu_buffer_isa(iree_hal_buffer_t* buffer);
+
+// Returns the WebGPU handle for the given |buffer|.
+// This is the entire allocated_buffer and must be offset by the buffer
+// byte_offset and byte_length when used.
+WGPUBuffer iree_hal_webgpu_buffer_handle(iree_hal_buffer_t* buffer);
+
+// Returns the host shadow allocation for the given |buffer|, if it is
+// host-visible. Like the handle this spans the entire allocated_buffer.
+void* iree_hal_webgpu_buffer_host_pointer(iree_hal_buffer_t* buffer);
+
+#ifdef __cplusplus
+}  // extern "C"
+#endif  // __cplusplus
+
+#endif  // IREE_HAL_WEBGPU_BUFFER_H_
@@ -0,0 +1,512 @@
+// Copyright 2023 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include "experimental/webgpu/webgpu_device.h"
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "experimental/webgpu/command_buffer.h"
+#include "experimental/webgpu/context_wrapper.h"
+#include "experimental/webgpu/nop_executable_cache.h"
+#include "experimental/webgpu/pipeline_layout.h"
+#include "experimental/webgpu/semaphore.h"
+#include "experimental/webgpu/webgpu_allocator.h"
+#include "experimental/webgpu/webgpu_buffer.h"
+#include "experimental/webgpu/webgpu_transfer.h"
+#include "iree/base/internal/arena.h"
+#include "iree/base/internal/synchronization.h"
+#include "iree/base/tracing.h"
+
+//===----------------------------------------------------------------------===//
+// iree_hal_webgpu_device_t
+//===----------------------------------------------------------------------===//
+
+typedef struct iree_hal_webgpu_device_t {
+  iree_hal_resource_t resource;
+  iree_string_view_t identifier;
+
+  // Block pool used for command buffer resource sets.
+  iree_arena_block_pool_t block_pool;
+
+  // Optional driver that created the device. We retain it for our lifetime to
+  // ensure any shared state remains valid.
+  iree_hal_driver_t* driver;
+
+  iree_hal_webgpu_device_options_t options;
+  iree_hal_webgpu_context_wrapper_t context_wrapper;
+  iree_hal_allocator_t* device_allocator;
+
+  // Posted whenever any semaphore of the device changes value.
+  iree_notification_t semaphore_notification;
+} iree_hal_webgpu_device_t;
+
+static const iree_hal_device_vtable_t iree_hal_webgpu_device_vtable;
+
+static iree_hal_webgpu_device_t* iree_hal_webgpu_device_cast(
+    iree_hal_device_t* base_value) {
+  IREE_HAL_ASSERT_TYPE(base_value, &iree_hal_webgpu_device_vtable);
+  return (iree_hal_webgpu_device_t*)base_value;
+}
+
+IREE_API_EXPORT void iree_hal_webgpu_device_options_initialize(
+    iree_hal_webgpu_device_options_t* out_options) {
+  memset(out_options, 0, sizeof(*out_options));
+  out_options->staging_block_size = 64 * 1024;
+}
+
+static void iree_hal_webgpu_context_wrapper_deinitialize(
+    iree_hal_webgpu_context_wrapper_t* context) {
+  if (context->empty_bind_group) {
+    wgpuBindGroupRelease(context->empty_bind_group);
+  }
+  if (context->empty_bind_group_layout) {
+    wgpuBindGroupLayoutRelease(context->empty_bind_group_layout);
+  }
+  if (context->params_bind_group_layout) {
+    wgpuBindGroupLayoutRelease(context->params_bind_group_layout);
+  }
+  if (context->queue) wgpuQueueRelease(context->queue);
+  if (context->device) wgpuDeviceRelease(context->device);
+  memset(context, 0, sizeof(*context));
+}
+
+// Retains |handle| and creates the objects shared by all resources of the
+// device.
+static iree_status_t iree_hal_webgpu_context_wrapper_initialize(
+    WGPUDevice handle, iree_allocator_t host_allocator,
+    iree_hal_webgpu_context_wrapper_t* out_context) {
+  memset(out_context, 0, sizeof(*out_context));
+  wgpuDeviceReference(handle);
+  out_context->device = handle;
+  out_context->queue = wgpuDeviceGetQueue(handle);
+  out_context->host_allocator = host_allocator;
+
+  // Push constants are read from a uniform buffer with a dynamic offset so
+  // that one bind group can serve all dispatches staged in the same block.
+  const WGPUBindGroupLayoutEntry params_entry = {
+      .nextInChain = NULL,
+      .binding = IREE_HAL_WEBGPU_PARAMS_BINDING_INDEX,
+      .visibility = WGPUShaderStage_Compute,
+      .buffer =
+          {
+              .nextInChain = NULL,
+              .type = WGPUBufferBindingType_Uniform,
+              .hasDynamicOffset = true,
+              .minBindingSize = IREE_HAL_WEBGPU_PARAMS_BINDING_SIZE,
+          },
+  };
+  const WGPUBindGroupLayoutDescriptor params_descriptor = {
+      .nextInChain = NULL,
+      .label = NULL,
+      .entryCount = 1,
+      .entries = &params_entry,
+  };
+  out_context->params_bind_group_layout =
+      wgpuDeviceCreateBindGroupLayout(handle, &params_descriptor);
+
+  const WGPUBindGroupLayoutDescriptor empty_layout_descriptor = {
+      .nextInChain = NULL,
+      .label = NULL,
+      .entryCount = 0,
+      .entries = NULL,
+  };
+  out_context->empty_bind_group_layout =
+      wgpuDeviceCreateBindGroupLayout(handle, &empty_layout_descriptor);
+  if (out_context->empty_bind_group_layout) {
+    const WGPUBindGroupDescriptor empty_descriptor = {
+        .nextInChain = NULL,
+        .label = NULL,
+        .layout = out_context->empty_bind_group_layout,
+        .entryCount = 0,
+        .entries = NULL,
+    };
+    out_context->empty_bind_group =
+        wgpuDeviceCreateBindGroup(handle, &empty_descriptor);
+  }
+
+  if (!out_context->queue || !out_context->params_bind_group_layout ||
+      !out_context->empty_bind_group) {
+    iree_hal_webgpu_context_wrapper_deinitialize(out_context);
+    return iree_make_status(IREE_STATUS_INTERNAL,
+                            "failed to initialize WebGPU device state");
+  }
+  return iree_ok_status();
+}
+
+static void iree_hal_webgpu_device_destroy(iree_hal_device_t* base_device) {
+  iree_hal_webgpu_device_t* device = iree_hal_webgpu_device_cast(base_device);
+  iree_allocator_t host_allocator = iree_hal_device_host_allocator(base_device);
+  IREE_TRACE_ZONE_BEGIN(z0);
+
+  // There should be no more buffers live that use the allocator.
+  iree_hal_allocator_release(device->device_allocator);
+  iree_hal_webgpu_context_wrapper_deinitialize(&device->context_wrapper);
+  iree_notification_deinitialize(&device->semaphore_notification);
+  iree_arena_block_pool_deinitialize(&device->block_pool);
+
+  // Finally, destroy the device.
+  iree_hal_driver_release(device->driver);
+
+  iree_allocator_free(host_allocator, device);
+
+  IREE_TRACE_ZONE_END(z0);
+}
+
+iree_status_t iree_hal_webgpu_device_create(
+    iree_hal_driver_t* driver, iree_string_view_t identifier,
+    const iree_hal_webgpu_device_options_t* options, WGPUDevice handle,
+    iree_allocator_t host_allocator, iree_hal_device_t** out_device) {
+  IREE_ASSERT_ARGUMENT(options);
+  IREE_ASSERT_ARGUMENT(handle);
+  IREE_ASSERT_ARGUMENT(out_device);
+  *out_device = NULL;
+  IREE_TRACE_ZONE_BEGIN(z0);
+
+  iree_hal_webgpu_device_t* device = NULL;
+  iree_host_size_t total_size = sizeof(*device) + identifier.size;
+  IREE_RETURN_AND_END_ZONE_IF_ERROR(
+      z0, iree_allocator_malloc(host_allocator, total_size, (void**)&device));
+  memset(device, 0, total_size);
+  iree_hal_resource_initialize(&iree_hal_webgpu_device_vtable,
+                               &device->resource);
+  iree_string_view_append_to_buffer(identifier, &device->identifier,
+                                    (char*)device + sizeof(*device));
+  iree_arena_block_pool_initialize(32 * 1024, host_allocator,
+                                   &device->block_pool);
+  iree_notification_initialize(&device->semaphore_notification);
+  device->driver = driver;
+  iree_hal_driver_retain(device->driver);
+  device->options = *options;
+
+  iree_status_t status = iree_hal_webgpu_context_wrapper_initialize(
+      handle, host_allocator, &device->context_wrapper);
+  if (iree_status_is_ok(status)) {
+    status = iree_hal_webgpu_allocator_create((iree_hal_device_t*)device,
+                                              &device->context_wrapper,
+                                              &device->device_allocator);
+  }
+
+  if (iree_status_is_ok(status)) {
+    *out_device = (iree_hal_device_t*)device;
+  } else {
+    iree_hal_device_release((iree_hal_device_t*)device);
+  }
+  IREE_TRACE_ZONE_END(z0);
+  return status;
+}
+
+IREE_API_EXPORT iree_status_t iree_hal_webgpu_wrap_device(
+    iree_string_view_t identifier,
+    const iree_hal_webgpu_device_options_t* options, WGPUDevice handle,
+    iree_allocator_t host_allocator, iree_hal_device_t** out_device) {
+  return iree_hal_webgpu_device_create(/*driver=*/NULL, identifier, options,
+                                       handle, host_allocator, out_device);
+}
+
+static iree_string_view_t iree_hal_webgpu_device_id(
+    iree_hal_device_t* base_device) {
+  iree_hal_webgpu_device_t* device = iree_hal_webgpu_device_cast(base_device);
+  return device->identifier;
+}
+
+static iree_allocator_t iree_hal_webgpu_device_host_allocator(
+    iree_hal_device_t* base_device) {
+  iree_hal_webgpu_device_t* device = iree_hal_webgpu_device_cast(base_device);
+  return device->context_wrapper.host_allocator;
+}
+
+static iree_hal_allocator_t* iree_hal_webgpu_device_allocator(
+    iree_hal_device_t* base_device) {
+  iree_hal_webgpu_device_t* device = iree_hal_webgpu_device_cast(base_device);
+  return device->device_allocator;
+}
+
+static iree_status_t iree_hal_webgpu_device_query_i64(
+    iree_hal_device_t* base_device, iree_string_view_t category,
+    iree_string_view_t key, int64_t* out_value) {
+  *out_value = 0;
+
+  if (iree_string_view_equal(category,
+                             iree_make_cstring_view("hal.executable.format"))) {
+    *out_value =
+        iree_string_view_equal(key, iree_make_cstring_view("webgpu-wgsl-fb"))
+            ? 1
+            : 0;
+    return iree_ok_status();
+  }
+
+  return iree_make_status(
+      IREE_STATUS_NOT_FOUND,
+      "unknown device configuration key value '%.*s :: %.*s'",
+      (int)category.size, category.data, (int)key.size, key.data);
+}
+
+static iree_status_t iree_hal_webgpu_device_trim(
+    iree_hal_device_t* base_device) {
+  iree_hal_webgpu_device_t* device = iree_hal_webgpu_device_cast(base_device);
+  iree_arena_block_pool_trim(&device->block_pool);
+  return iree_hal_allocator_trim(device->device_allocator);
+}
+
+static iree_status_t iree_hal_webgpu_device_create_channel(
+    iree_hal_device_t* base_device, iree_hal_queue_affinity_t queue_affinity,
+    iree_hal_channel_params_t params, iree_hal_channel_t** out_channel) {
+  return iree_make_status(IREE_STATUS_UNIMPLEMENTED,
+                          "collectives not implemented");
+}
+
+static iree_status_t iree_hal_webgpu_device_create_command_buffer(
+    iree_hal_device_t* base_device, iree_hal_command_buffer_mode_t mode,
+    iree_hal_command_category_t command_categories,
+    iree_hal_queue_affinity_t queue_affinity, iree_host_size_t binding_capacity,
+    iree_hal_command_buffer_t** out_command_buffer) {
+  iree_hal_webgpu_device_t* device = iree_hal_webgpu_device_cast(base_device);
+  return iree_hal_webgpu_command_buffer_create(
+      base_device, &device->context_wrapper, mode, command_categories,
+      queue_affinity, binding_capacity, &device->block_pool,
+      device->options.staging_block_size, out_command_buffer);
+}
+
+static iree_status_t iree_hal_webgpu_device_create_descriptor_set_layout(
+    iree_hal_device_t* base_device,
+    iree_hal_descriptor_set_layout_flags_t flags,
+    iree_host_size_t binding_count,
+    const iree_hal_descriptor_set_layout_binding_t* bindings,
+    iree_hal_descriptor_set_layout_t** out_descriptor_set_layout) {
+  iree_hal_webgpu_device_t* device = iree_hal_webgpu_device_cast(base_device);
+  return iree_hal_webgpu_descriptor_set_layout_create(
+      &device->context_wrapper, flags, binding_count, bindings,
+      out_descriptor_set_layout);
+}
+
+static iree_status_t iree_hal_webgpu_device_create_event(
+    iree_hal_device_t* base_device, iree_hal_event_t** out_event) {
+  return iree_make_status(IREE_STATUS_UNIMPLEMENTED,
+                          "events not implemented");
+}
+
+static iree_status_t iree_hal_webgpu_device_create_executable_cache(
+    iree_hal_device_t* base_device, iree_string_view_t identifier,
+    iree_loop_t loop, iree_hal_executable_cache_t** out_executable_cache) {
+  iree_hal_webgpu_device_t* device = iree_hal_webgpu_device_cast(base_device);
+  return iree_hal_webgpu_nop_executable_cache_create(
+      &device->context_wrapper, identifier, out_executable_cache);
+}
+
+static iree_status_t iree_hal_webgpu_device_create_pipeline_layout(
+    iree_hal_device_t* base_device, iree_host_size_t push_constants,
+    iree_host_size_t set_layout_count,
+    iree_hal_descriptor_set_layout_t* const* set_layouts,
+    iree_hal_pipeline_layout_t** out_pipeline_layout) {
+  iree_hal_webgpu_device_t* device = iree_hal_webgpu_device_cast(base_device);
+  return iree_hal_webgpu_pipeline_layout_create(
+      &device->context_wrapper, set_layout_count, set_layouts, push_constants,
+      out_pipeline_layout);
+}
+
+static iree_status_t iree_hal_webgpu_device_create_semaphore(
+    iree_hal_device_t* base_device, uint64_t initial_value,
+    iree_hal_semaphore_t** out_semaphore) {
+  iree_hal_webgpu_device_t* device = iree_hal_webgpu_device_cast(base_device);
+  return iree_hal_webgpu_semaphore_create(
+      &device->semaphore_notification, initial_value,
+      device->context_wrapper.host_allocator, out_semaphore);
+}
+
+static iree_hal_semaphore_compatibility_t
+iree_hal_webgpu_device_query_semaphore_compatibility(
+    iree_hal_device_t* base_device, iree_hal_semaphore_t* semaphore) {
+  // Semaphores are waited on by the host before work is submitted.
+  return IREE_HAL_SEMAPHORE_COMPATIBILITY_HOST_ONLY;
+}
+
+// A resolved side of a transfer: either host memory (including the host
+// allocation of host-visible buffers) or a WebGPU buffer.
+typedef struct iree_hal_webgpu_transfer_endpoint_t {
+  uint8_t* host_ptr;
+  WGPUBuffer handle;
+  iree_device_size_t offset;
+  iree_device_size_t size;
+} iree_hal_webgpu_transfer_endpoint_t;
+
+static iree_hal_webgpu_transfer_endpoint_t
+iree_hal_webgpu_resolve_transfer_buffer(iree_hal_transfer_buffer_t buffer,
+                                        iree_device_size_t offset) {
+  iree_hal_webgpu_transfer_endpoint_t endpoint = {0};
+  if (!buffer.device_buffer) {
+    endpoint.host_ptr = buffer.host_buffer.data + offset;
+    return endpoint;
+  }
+  iree_hal_buffer_t* allocated_buffer =
+      iree_hal_buffer_allocated_buffer(buffer.device_buffer);
+  offset += iree_hal_buffer_byte_offset(buffer.device_buffer);
+  uint8_t* host_ptr =
+      (uint8_t*)iree_hal_webgpu_buffer_host_pointer(allocated_buffer);
+  if (host_ptr) {
+    endpoint.host_ptr = host_ptr + offset;
+  } else {
+    endpoint.handle = iree_hal_webgpu_buffer_handle(allocated_buffer);
+    endpoint.offset = offset;
+    endpoint.size = iree_device_align(
+        iree_hal_buffer_allocation_size(allocated_buffer), sizeof(uint32_t));
+  }
+  return endpoint;
+}
+
+static iree_status_t iree_hal_webgpu_device_transfer_range(
+    iree_hal_device_t* base_device, iree_hal_transfer_buffer_t source,
+    iree_device_size_t source_offset, iree_hal_transfer_buffer_t target,
+    iree_device_size_t target_offset, iree_device_size_t data_length,
+    iree_hal_transfer_buffer_flags_t flags, iree_timeout_t timeout) {
+  iree_hal_webgpu_device_t* device = iree_hal_webgpu_device_cast(base_device);
+  if (data_length == 0) return iree_ok_status();
+  IREE_TRACE_ZONE_BEGIN(z0);
+
+  // Host-visible buffers are backed by host memory between submissions and
+  // can be accessed directly; only device-local buffers go through the queue.
+  iree_hal_webgpu_transfer_endpoint_t src =
+      iree_hal_webgpu_resolve_transfer_buffer(source, source_offset);
+  iree_hal_webgpu_transfer_endpoint_t dst =
+      iree_hal_webgpu_resolve_transfer_buffer(target, target_offset);
+  iree_status_t status = iree_ok_status();
+  if (src.host_ptr && dst.host_ptr) {
+    memmove(dst.host_ptr, src.host_ptr, (size_t)data_length);
+  } else if (src.host_ptr) {
+    status = iree_hal_webgpu_queue_write_buffer(
+        &device->context_wrapper, src.host_ptr, dst.handle, dst.offset,
+        dst.size, data_length);
+  } else if (dst.host_ptr) {
+    status = iree_hal_webgpu_queue_read_buffer(&device->context_wrapper,
+                                               src.handle, src.offset, src.size,
+                                               dst.host_ptr, data_length);
+  } else {
+    status = iree_hal_webgpu_queue_copy_buffer(&device->context_wrapper,
+                                               src.handle, src.offset,
+                                               dst.handle, dst.offset,
+                                               data_length);
+  }
+
+  IREE_TRACE_ZONE_END(z0);
+  return status;
+}
+
+static iree_status_t iree_hal_webgpu_device_queue_alloca(
+    iree_hal_device_t* base_device, iree_hal_queue_affinity_t queue_affinity,
+    const iree_hal_semaphore_list_t wait_semaphore_list,
+    const iree_hal_semaphore_list_t signal_semaphore_list,
+    iree_hal_allocator_pool_t pool, iree_hal_buffer_params_t params,
+    iree_device_size_t allocation_size,
+    iree_hal_buffer_t** IREE_RESTRICT out_buffer) {
+  // TODO: queue-ordered allocations.
+  IREE_RETURN_IF_ERROR(iree_hal_semaphore_list_wait(wait_semaphore_list,
+                                                    iree_infinite_timeout()));
+  IREE_RETURN_IF_ERROR(iree_hal_allocator_allocate_buffer(
+      iree_hal_device_allocator(base_device), params, allocation_size,
+      iree_const_byte_span_empty(), out_buffer));
+  IREE_RETURN_IF_ERROR(iree_hal_semaphore_list_signal(signal_semaphore_list));
+  return iree_ok_status();
+}
+
+static iree_status_t iree_hal_webgpu_device_queue_dealloca(
+    iree_hal_device_t* base_device, iree_hal_queue_affinity_t queue_affinity,
+    const iree_hal_semaphore_list_t wait_semaphore_list,
+    const iree_hal_semaphore_list_t signal_semaphore_list,
+    iree_hal_buffer_t* buffer) {
+  // TODO: queue-ordered allocations.
+  IREE_RETURN_IF_ERROR(iree_hal_device_queue_barrier(
+      base_device, queue_affinity, wait_semaphore_list, signal_semaphore_list));
+  return iree_ok_status();
+}
+
+static iree_status_t iree_hal_webgpu_device_queue_execute(
+    iree_hal_device_t* base_device, iree_hal_queue_affinity_t queue_affinity,
+    const iree_hal_semaphore_list_t wait_semaphore_list,
+    const iree_hal_semaphore_list_t signal_semaphore_list,
+    iree_host_size_t command_buffer_count,
+    iree_hal_command_buffer_t* const* command_buffers) {
+  iree_hal_webgpu_device_t* device = iree_hal_webgpu_device_cast(base_device);
+  IREE_TRACE_ZONE_BEGIN(z0);
+
+  // Waits happen on the host as WebGPU has no cross-submission
+  // synchronization primitives.
+  IREE_RETURN_AND_END_ZONE_IF_ERROR(
+      z0, iree_hal_webgpu_semaphore_multi_wait(
+              &device->semaphore_notification, IREE_HAL_WAIT_MODE_ALL,
+              wait_semaphore_list, iree_infinite_timeout()));
+
+  // All command buffers go out in one submission with their staging uploads
+  // and host readbacks batched around it.
+  iree_status_t status = iree_hal_webgpu_command_buffer_submit_batch(
+      &device->context_wrapper, command_buffer_count, command_buffers);
+
+  // The queue executes in order and any host access to the results waits for
+  // the device so the signal can happen as soon as the work is submitted.
+  if (iree_status_is_ok(status)) {
+    status = iree_hal_semaphore_list_signal(signal_semaphore_list);
+  } else {
+    iree_hal_semaphore_list_fail(signal_semaphore_list,
+                                 iree_status_clone(status));
+  }
+
+  IREE_TRACE_ZONE_END(z0);
+  return status;
+}
+
+static iree_status_t iree_hal_webgpu_device_queue_flush(
+    iree_hal_device_t* base_device, iree_hal_queue_affinity_t queue_affinity) {
+  // Currently unused; we flush as submissions are made.
+  return iree_ok_status();
+}
+
+static iree_status_t iree_hal_webgpu_device_wait_semaphores(
+    iree_hal_device_t* base_device, iree_hal_wait_mode_t wait_mode,
+    const iree_hal_semaphore_list_t semaphore_list, iree_timeout_t timeout) {
+  iree_hal_webgpu_device_t* device = iree_hal_webgpu_device_cast(base_device);
+  return iree_hal_webgpu_semaphore_multi_wait(
+      &device->semaphore_notification, wait_mode, semaphore_list, timeout);
+}
+
+static iree_status_t iree_hal_webgpu_device_profiling_begin(
+    iree_hal_device_t* base_device,
+    const iree_hal_device_profiling_options_t* options) {
+  // Unimplemented (and that's ok).
+  return iree_ok_status();
+}
+
+static iree_status_t iree_hal_webgpu_device_profiling_end(
+    iree_hal_device_t* base_device) {
+  // Unimplemented (and that's ok).
+  return iree_ok_status();
+}
+
+static const iree_hal_device_vtable_t iree_hal_webgpu_device_vtable = {
+    .destroy = iree_hal_webgpu_device_destroy,
+    .id = iree_hal_webgpu_device_id,
+    .host_allocator = iree_hal_webgpu_device_host_allocator,
+    .device_allocator = iree_hal_webgpu_device_allocator,
+    .trim = iree_hal_webgpu_device_trim,
+    .query_i64 = iree_hal_webgpu_device_query_i64,
+    .create_channel = iree_hal_webgpu_device_create_channel,
+    .create_command_buffer = iree_hal_webgpu_device_create_command_buffer,
+    .create_descriptor_set_layout =
+        iree_hal_webgpu_device_create_descriptor_set_layout,
+    .create_event = iree_hal_webgpu_device_create_event,
+    .create_executable_cache = iree_hal_webgpu_device_create_executable_cache,
+    .create_pipeline_layout = iree_hal_webgpu_device_create_pipeline_layout,
+    .create_semaphore = iree_hal_webgpu_device_create_semaphore,
+    .query_semaphore_compatibility =
+        iree_hal_webgpu_device_query_semaphore_compatibility,
+    .transfer_range = iree_hal_webgpu_device_transfer_range,
+    .queue_alloca = iree_hal_webgpu_device_queue_alloca,
+    .queue_dealloca = iree_hal_webgpu_device_queue_dealloca,
+    .queue_execute = iree_hal_webgpu_device_queue_execute,
+    .queue_flush = iree_hal_webgpu_device_queue_flush,
+    .wait_semaphores = iree_hal_webgpu_device_wait_semaphores,
+    .profiling_begin = iree_hal_webgpu_device_profiling_begin,
+    .profiling_end = iree_hal_webgpu_device_profiling_end,
+};
@@ -0,0 +1,21 @@
+// Copyright 2023 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#ifndef IREE_HAL_WEBGPU_WEBGPU_HEADERS_H_
+#define IREE_HAL_WEBGPU_WEBGPU_HEADERS_H_
+
+// The WebGPU C API (webgpu.h) is provided by Emscripten when targeting the web
+// (with `-sUSE_WEBGPU=1`) and by Dawn when building natively.
+#include <webgpu/webgpu.h>  // IWYU pragma: export
+
+#include "iree/base/api.h"
+
+#if defined(IREE_PLATFORM_EMSCRIPTEN)
+#include <emscripten.h>
+#include <emscripten/html5_webgpu.h>
+#endif  // IREE_PLATFORM_EMSCRIPTEN
+
+#endif  // IREE_HAL_WEBGPU_WEBGPU_HEADERS_H_
@@ -0,0 +1,195 @@
+// Copyright 2023 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include "experimental/webgpu/webgpu_transfer.h"
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <string.h>
+
+#include "iree/base/api.h"
+#include "iree/base/tracing.h"
+
+// All WebGPU copy offsets and sizes must be multiples of 4 bytes.
+#define IREE_HAL_WEBGPU_COPY_ALIGNMENT 4
+
+typedef struct iree_hal_webgpu_map_state_t {
+  bool is_complete;
+  WGPUBufferMapAsyncStatus status;
+} iree_hal_webgpu_map_state_t;
+
+static void iree_hal_webgpu_map_callback(WGPUBufferMapAsyncStatus status,
+                                         void* user_data) {
+  iree_hal_webgpu_map_state_t* state = (iree_hal_webgpu_map_state_t*)user_data;
+  state->status = status;
+  state->is_complete = true;
+}
+
+iree_status_t iree_hal_webgpu_map_buffer_and_wait(
+    iree_hal_webgpu_context_wrapper_t* context, WGPUBuffer buffer,
+    WGPUMapModeFlags mode, iree_device_size_t offset, iree_device_size_t size) {
+  IREE_TRACE_ZONE_BEGIN(z0);
+
+  iree_hal_webgpu_map_state_t state = {
+      .is_complete = false,
+      .status = WGPUBufferMapAsyncStatus_Success,
+  };
+  wgpuBufferMapAsync(buffer, mode, (size_t)offset, (size_t)size,
+                     iree_hal_webgpu_map_callback, &state);
+  while (!state.is_complete) {
+#if defined(IREE_PLATFORM_EMSCRIPTEN)
+    emscripten_sleep(0);
+#else
+    wgpuDeviceTick(context->device);
+#endif  // IREE_PLATFORM_EMSCRIPTEN
+  }
+
+  iree_status_t status = iree_ok_status();
+  if (state.status != WGPUBufferMapAsyncStatus_Success) {
+    status = iree_make_status(IREE_STATUS_INTERNAL,
+                              "wgpuBufferMapAsync failed with status %d",
+                              (int)state.status);
+  }
+  IREE_TRACE_ZONE_END(z0);
+  return status;
+}
+
+// Returns the range [*out_offset, *out_offset + *out_length) containing the
+// given range widened to the copy alignment.
+static void iree_hal_webgpu_align_range(iree_device_size_t offset,
+                                        iree_device_size_t length,
+                                        iree_device_size_t* out_offset,
+                                        iree_device_size_t* out_length) {
+  iree_device_size_t aligned_offset =
+      offset & ~(iree_device_size_t)(IREE_HAL_WEBGPU_COPY_ALIGNMENT - 1);
+  iree_device_size_t aligned_end =
+      iree_device_align(offset + length, IREE_HAL_WEBGPU_COPY_ALIGNMENT);
+  *out_offset = aligned_offset;
+  *out_length = aligned_end - aligned_offset;
+}
+
+iree_status_t iree_hal_webgpu_queue_write_buffer(
+    iree_hal_webgpu_context_wrapper_t* context, const void* source,
+    WGPUBuffer target, iree_device_size_t target_offset,
+    iree_device_size_t target_size, iree_device_size_t length) {
+  if (length == 0) return iree_ok_status();
+
+  iree_device_size_t aligned_offset = 0;
+  iree_device_size_t aligned_length = 0;
+  iree_hal_webgpu_align_range(target_offset, length, &aligned_offset,
+                              &aligned_length);
+  if (aligned_offset == target_offset && aligned_length == length) {
+    // Fast path: the queue takes a copy of the data.
+    wgpuQueueWriteBuffer(context->queue, target, target_offset, source,
+                         (size_t)length);
+    return iree_ok_status();
+  }
+
+  // Read-modify-write the words containing the range.
+  IREE_TRACE_ZONE_BEGIN(z0);
+  uint8_t* scratch = NULL;
+  IREE_RETURN_AND_END_ZONE_IF_ERROR(
+      z0, iree_allocator_malloc(context->host_allocator,
+                                (iree_host_size_t)aligned_length,
+                                (void**)&scratch));
+  iree_status_t status =
+      iree_hal_webgpu_queue_read_buffer(context, target, aligned_offset,
+                                        target_size, scratch, aligned_length);
+  if (iree_status_is_ok(status)) {
+    memcpy(scratch + (target_offset - aligned_offset), source, length);
+    wgpuQueueWriteBuffer(context->queue, target, aligned_offset, scratch,
+                         (size_t)aligned_length);
+  }
+  iree_allocator_free(context->host_allocator, scratch);
+  IREE_TRACE_ZONE_END(z0);
+  return status;
+}
+
+iree_status_t iree_hal_webgpu_queue_read_buffer(
+    iree_hal_webgpu_context_wrapper_t* context, WGPUBuffer source,
+    iree_device_size_t source_offset, iree_device_size_t source_size,
+    void* target, iree_device_size_t length) {
+  if (length == 0) return iree_ok_status();
+  IREE_TRACE_ZONE_BEGIN(z0);
+
+  iree_device_size_t aligned_offset = 0;
+  iree_device_size_t aligned_length = 0;
+  iree_hal_webgpu_align_range(source_offset, length, &aligned_offset,
+                              &aligned_length);
+  if (aligned_offset + aligned_length > source_size) {
+    IREE_TRACE_ZONE_END(z0);
+    return iree_make_status(IREE_STATUS_OUT_OF_RANGE,
+                            "aligned read range exceeds the buffer size");
+  }
+
+  // Storage buffers cannot be mapped so copy into a readback buffer first.
+  const WGPUBufferDescriptor staging_descriptor = {
+      .nextInChain = NULL,
+      .label = NULL,
+      .usage = WGPUBufferUsage_MapRead | WGPUBufferUsage_CopyDst,
+      .size = aligned_length,
+      .mappedAtCreation = false,
+  };
+  WGPUBuffer staging_buffer =
+      wgpuDeviceCreateBuffer(context->device, &staging_descriptor);
+  if (!staging_buffer) {
+    IREE_TRACE_ZONE_END(z0);
+    return iree_make_status(IREE_STATUS_RESOURCE_EXHAUSTED,
+                            "unable to allocate readback staging buffer");
+  }
+
+  iree_status_t status = iree_hal_webgpu_queue_copy_buffer(
+      context, source, aligned_offset, staging_buffer, 0, aligned_length);
+  if (iree_status_is_ok(status)) {
+    status = iree_hal_webgpu_map_buffer_and_wait(
+        context, staging_buffer, WGPUMapMode_Read, 0, aligned_length);
+  }
+  if (iree_status_is_ok(status)) {
+    const uint8_t* mapped_ptr = (const uint8_t*)wgpuBufferGetConstMappedRange(
+        staging_buffer, 0, (size_t)aligned_length);
+    memcpy(target, mapped_ptr + (source_offset - aligned_offset), length);
+    wgpuBufferUnmap(staging_buffer);
+  }
+
+  wgpuBufferDestroy(staging_buffer);
+  wgpuBufferRelease(staging_buffer);
+  IREE_TRACE_ZONE_END(z0);
+  return status;
+}
+
+iree_status_t iree_hal_webgpu_queue_copy_buffer(
+    iree_hal_webgpu_context_wrapper_t* context, WGPUBuffer source,
+    iree_device_size_t source_offset, WGPUBuffer target,
+    iree_device_size_t target_offset, iree_device_size_t length) {
+  if (length == 0) return iree_ok_status();
+  if (!iree_device_size_has_alignment(source_offset,
+                                      IREE_HAL_WEBGPU_COPY_ALIGNMENT) ||
+      !iree_device_size_has_alignment(target_offset,
+                                      IREE_HAL_WEBGPU_COPY_ALIGNMENT) ||
+      !iree_device_size_has_alignment(length, IREE_HAL_WEBGPU_COPY_ALIGNMENT)) {
+    return iree_make_status(IREE_STATUS_UNIMPLEMENTED,
+                            "device-to-device copies must be 4 byte aligned");
+  }
+
+  const WGPUCommandEncoderDescriptor encoder_descriptor = {
+      .nextInChain = NULL,
+      .label = NULL,
+  };
+  WGPUCommandEncoder encoder =
+      wgpuDeviceCreateCommandEncoder(context->device, &encoder_descriptor);
+  wgpuCommandEncoderCopyBufferToBuffer(encoder, source, source_offset, target,
+                                       target_offset, length);
+  const WGPUCommandBufferDescriptor command_buffer_descriptor = {
+      .nextInChain = NULL,
+      .label = NULL,
+  };
+  WGPUCommandBuffer command_buffer =
+      wgpuCommandEncoderFinish(encoder, &command_buffer_descriptor);
+  wgpuQueueSubmit(context->queue, 1, &command_buffer);
+  wgpuCommandBufferRelease(command_buffer);
+  wgpuCommandEncoderRelease(encoder);
+  return iree_ok_status();
+}
@@ -0,0 +1,53 @@
+// Copyright 2023 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#ifndef IREE_HAL_WEBGPU_TRANSFER_H_
+#define IREE_HAL_WEBGPU_TRANSFER_H_
+
+#include "experimental/webgpu/context_wrapper.h"
+#include "iree/base/api.h"
+#include "iree/hal/api.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif  // __cplusplus
+
+// Maps |size| bytes of |buffer| at |offset| with |mode| and blocks until the
+// mapping completes (and with it all prior work on the queue).
+//
+// WebGPU only completes mappings when control returns to the event loop. When
+// targeting the web this yields with emscripten_sleep and requires the module
+// to be built with -sASYNCIFY. Natively the device is ticked until done.
+iree_status_t iree_hal_webgpu_map_buffer_and_wait(
+    iree_hal_webgpu_context_wrapper_t* context, WGPUBuffer buffer,
+    WGPUMapModeFlags mode, iree_device_size_t offset, iree_device_size_t size);
+
+// Writes |length| bytes of |source| into |target| at |target_offset| in queue
+// order. Unaligned writes read back the surrounding words first.
+iree_status_t iree_hal_webgpu_queue_write_buffer(
+    iree_hal_webgpu_context_wrapper_t* context, const void* source,
+    WGPUBuffer target, iree_device_size_t target_offset,
+    iree_device_size_t target_size, iree_device_size_t length);
+
+// Reads |length| bytes of |source| at |source_offset| into |target| after all
+// prior work on the queue has completed. |source_size| is the total size of
+// the WebGPU buffer and bounds how far unaligned ranges can be widened.
+iree_status_t iree_hal_webgpu_queue_read_buffer(
+    iree_hal_webgpu_context_wrapper_t* context, WGPUBuffer source,
+    iree_device_size_t source_offset, iree_device_size_t source_size,
+    void* target, iree_device_size_t length);
+
+// Copies |length| bytes from |source| to |target| in queue order.
+iree_status_t iree_hal_webgpu_queue_copy_buffer(
+    iree_hal_webgpu_context_wrapper_t* context, WGPUBuffer source,
+    iree_device_size_t source_offset, WGPUBuffer target,
+    iree_device_size_t target_offset, iree_device_size_t length);
+
+#ifdef __cplusplus
+}  // extern "C"
+#endif  // __cplusplus
+
+#endif  // IREE_HAL_WEBGPU_TRANSFER_H_
@@ -167,6 +167,11 @@ std::unique_ptr<OperationPass<func::FuncOp>> createLinalgExtVectorizationPass();
 std::unique_ptr<OperationPass<func::FuncOp>>
 createTileAndDecomposeWinogradTransformPass();
 
+/// Tile and decompose the attention ops into a loop over the key sequence
+/// computing the softmax online.
+std::unique_ptr<OperationPass<func::FuncOp>>
+createTileAndDecomposeAttentionPass();
+
 // Creates a pass to convert linalg convolution ops into a sequence of
 // linalg_ext.winograd.* ops and linalg.batch_matmul ops using the winograd
 // tranformation.
@@ -2756,6 +2756,147 @@ LogicalResult WinogradOutputTransformOp::reifyResultShapes(
       .reifyResultShapes(b, reifiedReturnShapes);
 }
 
+//===----------------------------------------------------------------------===//
+// AttentionOp
+//===----------------------------------------------------------------------===//
+
+LogicalResult AttentionOp::verify() {
+  Operation *op = getOperation();
+  if (getNumInputs() != 3) {
+    return op->emitOpError("expected three input operands");
+  }
+  if (getNumOutputs() != 1) {
+    return op->emitOpError("expected one output operand");
+  }
+  ShapedType queryType = getQueryType();
+  ShapedType keyType = getKeyType();
+  ShapedType valueType = getValueType();
+  ShapedType outputType = getOutputType();
+  if (queryType.getRank() != 3 || keyType.getRank() != 3 ||
+      valueType.getRank() != 3 || outputType.getRank() != 3) {
+    return op->emitOpError("expected all operands to have rank 3");
+  }
+  Type elementType = outputType.getElementType();
+  if (queryType.getElementType() != elementType ||
+      keyType.getElementType() != elementType ||
+      valueType.getElementType() != elementType) {
+    return op->emitOpError("expected all operand element types to be "
+                           "identical");
+  }
+  if (!elementType.isa<FloatType>()) {
+    return op->emitOpError("expected floating point element type");
+  }
+  ArrayRef<int64_t> queryShape = queryType.getShape();
+  ArrayRef<int64_t> keyShape = keyType.getShape();
+  ArrayRef<int64_t> valueShape = valueType.getShape();
+  ArrayRef<int64_t> outputShape = outputType.getShape();
+  if (!isShapedTypeDimCompatible(queryShape[0], keyShape[0]) ||
+      !isShapedTypeDimCompatible(queryShape[0], valueShape[0]) ||
+      !isShapedTypeDimCompatible(queryShape[0], outputShape[0])) {
+    return op->emitOpError("incompatible batch dimensions");
+  }
+  if (!isShapedTypeDimCompatible(queryShape[2], keyShape[2])) {
+    return op->emitOpError("query and key head dimensions do not match");
+  }
+  if (!isShapedTypeDimCompatible(keyShape[1], valueShape[1])) {
+    return op->emitOpError("key and value sequence lengths do not match");
+  }
+  if (!isShapedTypeDimCompatible(queryShape[1], outputShape[1]) ||
+      !isShapedTypeDimCompatible(valueShape[2], outputShape[2])) {
+    return op->emitOpError("incompatible output shape");
+  }
+  return success();
+}
+
+SmallVector<Range> AttentionOp::getIterationDomain(OpBuilder &builder) {
+  Location loc = getLoc();
+  Value zero = builder.create<arith::ConstantIndexOp>(loc, 0);
+  Value one = builder.create<arith::ConstantIndexOp>(loc, 1);
+  SmallVector<Range> loopBounds(getIterationDomainRank());
+  for (auto dim : llvm::seq<int64_t>(0, getIterationDomainRank())) {
+    loopBounds[dim].offset = zero;
+    loopBounds[dim].size = getDimValue(builder, loc, getOutput(), dim);
+    loopBounds[dim].stride = one;
+  }
+  return loopBounds;
+}
+
+SmallVector<utils::IteratorType> AttentionOp::getLoopIteratorTypes() {
+  SmallVector<utils::IteratorType> iteratorTypes(getIterationDomainRank(),
+                                                 utils::IteratorType::parallel);
+  return iteratorTypes;
+}
+
+SmallVector<Operation *>
+AttentionOp::getTiledImplementation(OpBuilder &builder,
+                                    ArrayRef<OpFoldResult> offsets,
+                                    ArrayRef<OpFoldResult> sizes) {
+  assert(offsets.size() == getIterationDomainRank());
+  assert(sizes.size() == getIterationDomainRank());
+
+  // The iteration domain is the (batch, query sequence, value) space of the
+  // output. The query and key are always needed along their full head
+  // dimension and the key/value along their full sequence.
+  Location loc = getLoc();
+  auto one = builder.getIndexAttr(1);
+  auto zero = builder.getIndexAttr(0);
+  SmallVector<OpFoldResult> strides(getIterationDomainRank(), one);
+
+  SmallVector<OpFoldResult> queryOffsets = {offsets[0], offsets[1], zero};
+  SmallVector<OpFoldResult> querySizes = {
+      sizes[0], sizes[1], getDim(builder, loc, getQuery(), 2)};
+  SmallVector<OpFoldResult> keyOffsets = {offsets[0], zero, zero};
+  SmallVector<OpFoldResult> keySizes = {sizes[0],
+                                        getDim(builder, loc, getKey(), 1),
+                                        getDim(builder, loc, getKey(), 2)};
+  SmallVector<OpFoldResult> valueOffsets = {offsets[0], zero, offsets[2]};
+  SmallVector<OpFoldResult> valueSizes = {
+      sizes[0], getDim(builder, loc, getValue(), 1), sizes[2]};
+
+  SmallVector<Value> tiledOperands;
+  tiledOperands.emplace_back(
+      getSlice(builder, loc, getQuery(), queryOffsets, querySizes, strides));
+  tiledOperands.emplace_back(
+      getSlice(builder, loc, getKey(), keyOffsets, keySizes, strides));
+  tiledOperands.emplace_back(
+      getSlice(builder, loc, getValue(), valueOffsets, valueSizes, strides));
+  tiledOperands.emplace_back(
+      getSlice(builder, loc, getOutput(), offsets, sizes, strides));
+
+  SmallVector<Type, 4> resultTypes;
+  if (hasTensorSemantics()) {
+    resultTypes.push_back(tiledOperands[3].getType());
+  }
+
+  Operation *tiledOp =
+      mlir::clone(builder, getOperation(), resultTypes, tiledOperands);
+
+  return {tiledOp};
+}
+
+LogicalResult AttentionOp::getResultTilePosition(
+    OpBuilder &builder, unsigned resultNumber, ArrayRef<OpFoldResult> offsets,
+    ArrayRef<OpFoldResult> sizes, SmallVector<OpFoldResult> &resultOffsets,
+    SmallVector<OpFoldResult> &resultSizes) {
+  if (resultNumber == 0) {
+    resultOffsets.assign(offsets.begin(), offsets.end());
+    resultSizes.assign(sizes.begin(), sizes.end());
+    return success();
+  }
+  return failure();
+}
+
+LogicalResult AttentionOp::fold(ArrayRef<Attribute>,
+                                SmallVectorImpl<OpFoldResult> &) {
+  return memref::foldMemRefCast(*this);
+}
+
+LogicalResult AttentionOp::reifyResultShapes(
+    OpBuilder &b, ReifiedRankedShapedTypeDims &reifiedReturnShapes) {
+  return cast<LinalgExtOp>(getOperation())
+      .reifyResultShapes(b, reifiedReturnShapes);
+}
+
 #define DEFINE_OP_GET_EFFECTS(OP_NAME)                                         \
   void OP_NAME::getEffects(                                                    \
       SmallVectorImpl<SideEffects::EffectInstance<MemoryEffects::Effect>>      \
@@ -2776,6 +2917,7 @@ DEFINE_OP_GET_EFFECTS(PackOp)
 DEFINE_OP_GET_EFFECTS(UnPackOp)
 DEFINE_OP_GET_EFFECTS(WinogradInputTransformOp)
 DEFINE_OP_GET_EFFECTS(WinogradOutputTransformOp)
+DEFINE_OP_GET_EFFECTS(AttentionOp)
 
 //===----------------------------------------------------------------------===//
 // iree_linalg_ext.set_encoding
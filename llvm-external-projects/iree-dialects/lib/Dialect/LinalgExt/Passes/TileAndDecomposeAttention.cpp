@@ -0,0 +1,304 @@
+// Copyright 2023 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include "iree-dialects/Dialect/LinalgExt/IR/LinalgExtDialect.h"
+#include "iree-dialects/Dialect/LinalgExt/IR/LinalgExtOps.h"
+#include "iree-dialects/Dialect/LinalgExt/Passes/PassDetail.h"
+#include "iree-dialects/Dialect/LinalgExt/Passes/Passes.h"
+#include "iree-dialects/Dialect/LinalgExt/Utils/Utils.h"
+#include "mlir/Dialect/Affine/IR/AffineOps.h"
+#include "mlir/Dialect/Arith/IR/Arith.h"
+#include "mlir/Dialect/Arith/Utils/Utils.h"
+#include "mlir/Dialect/Linalg/IR/Linalg.h"
+#include "mlir/Dialect/Math/IR/Math.h"
+#include "mlir/Dialect/SCF/IR/SCF.h"
+#include "mlir/Dialect/Tensor/IR/Tensor.h"
+#include "mlir/Dialect/Utils/StaticValueUtils.h"
+#include "mlir/Pass/Pass.h"
+#include "mlir/Transforms/GreedyPatternRewriteDriver.h"
+
+namespace mlir {
+namespace iree_compiler {
+namespace IREE {
+namespace LinalgExt {
+
+namespace {
+
+using BodyBuilderFn =
+    function_ref<Value(OpBuilder &builder, Location loc, ValueRange args)>;
+
+/// Creates a single result linalg.generic op computing `bodyBuilder` over
+/// `inputs` into `output`.
+static Value createGenericOp(OpBuilder &builder, Location loc,
+                             ValueRange inputs, Value output,
+                             ArrayRef<AffineMap> indexingMaps,
+                             ArrayRef<utils::IteratorType> iteratorTypes,
+                             BodyBuilderFn bodyBuilder) {
+  auto genericOp = builder.create<linalg::GenericOp>(
+      loc, output.getType(), inputs, output, indexingMaps, iteratorTypes,
+      [&](OpBuilder &nestedBuilder, Location nestedLoc, ValueRange args) {
+        Value result = bodyBuilder(nestedBuilder, nestedLoc, args);
+        nestedBuilder.create<linalg::YieldOp>(nestedLoc, result);
+      });
+  return genericOp.getResult(0);
+}
+
+/// Returns the number of keys processed by the iteration of the sequence loop
+/// starting at `iv`. This is only a constant if the tile size evenly divides
+/// the (static) sequence length.
+static OpFoldResult getSequenceTileSize(OpBuilder &builder, Location loc,
+                                        Value iv, OpFoldResult sequenceLength,
+                                        int64_t tileSize) {
+  if (Optional<int64_t> staticLength = getConstantIntValue(sequenceLength)) {
+    if (*staticLength % tileSize == 0) return builder.getIndexAttr(tileSize);
+  }
+  AffineExpr d0, s0;
+  bindDims(builder.getContext(), d0);
+  bindSymbols(builder.getContext(), s0);
+  AffineMap minMap =
+      AffineMap::get(1, 1, {builder.getAffineConstantExpr(tileSize), s0 - d0},
+                     builder.getContext());
+  return builder.createOrFold<AffineMinOp>(
+      loc, minMap,
+      ValueRange{iv, getValueOrCreateConstantIndexOp(builder, loc,
+                                                     sequenceLength)});
+}
+
+class ReifyAttention final : public OpRewritePattern<AttentionOp> {
+public:
+  ReifyAttention(MLIRContext *context, int64_t tileSize)
+      : OpRewritePattern<AttentionOp>(context), tileSize(tileSize) {}
+
+  /// The query is (B, N, d), the key (B, S, d), the value (B, S, e) and the
+  /// output (B, N, e). The loop created over S carries the output
+  /// accumulator (B, N, e) together with the running maximum (B, N) and
+  /// running sum (B, N) of the scores seen so far. At the end the accumulator
+  /// is divided by the sum to normalize the softmax.
+  LogicalResult matchAndRewrite(AttentionOp attnOp,
+                                PatternRewriter &rewriter) const override {
+    if (!attnOp.hasTensorSemantics()) {
+      return rewriter.notifyMatchFailure(
+          attnOp, "only attention ops on tensors are decomposed");
+    }
+    Location loc = attnOp.getLoc();
+    MLIRContext *context = rewriter.getContext();
+    Value query = attnOp.getQuery();
+    Value key = attnOp.getKey();
+    Value value = attnOp.getValue();
+    Value output = attnOp.getOutput();
+    auto elementType =
+        attnOp.getOutputType().getElementType().cast<FloatType>();
+
+    SmallVector<OpFoldResult> outputDims = getDims(rewriter, loc, output);
+    OpFoldResult sequenceLength = getDim(rewriter, loc, key, 1);
+    OpFoldResult headDim = getDim(rewriter, loc, key, 2);
+    int64_t effectiveTileSize = tileSize;
+    if (Optional<int64_t> staticLength = getConstantIntValue(sequenceLength)) {
+      effectiveTileSize = std::min(effectiveTileSize, *staticLength);
+    }
+    if (effectiveTileSize <= 0) {
+      return rewriter.notifyMatchFailure(attnOp, "empty key sequence");
+    }
+
+    // Loop invariant initial values. The largest negative value is used
+    // instead of -inf to start the running maximum so that the correction
+    // factor of the first iteration stays well defined under fast-math.
+    Value zero = rewriter.create<arith::ConstantOp>(
+        loc, rewriter.getZeroAttr(elementType));
+    Value negativeLargest = rewriter.create<arith::ConstantOp>(
+        loc, rewriter.getFloatAttr(
+                 elementType,
+                 APFloat::getLargest(elementType.getFloatSemantics(),
+                                     /*Negative=*/true)));
+    SmallVector<OpFoldResult> rowDims = {outputDims[0], outputDims[1]};
+    Value rowEmpty =
+        rewriter.create<tensor::EmptyOp>(loc, rowDims, elementType);
+    Value maxInit =
+        rewriter.create<linalg::FillOp>(loc, negativeLargest, rowEmpty)
+            .result();
+    Value sumInit =
+        rewriter.create<linalg::FillOp>(loc, zero, rowEmpty).result();
+    Value accInit = rewriter.create<linalg::FillOp>(loc, zero, output).result();
+
+    AffineExpr b, n, t, k;
+    bindDims(context, b, n, t, k);
+    auto getMap = [&](unsigned numDims, ArrayRef<AffineExpr> exprs) {
+      return AffineMap::get(numDims, 0, exprs, context);
+    };
+    auto parallel = utils::IteratorType::parallel;
+    auto reduction = utils::IteratorType::reduction;
+
+    Value lb = rewriter.create<arith::ConstantIndexOp>(loc, 0);
+    Value ub = getValueOrCreateConstantIndexOp(rewriter, loc, sequenceLength);
+    Value step =
+        rewriter.create<arith::ConstantIndexOp>(loc, effectiveTileSize);
+    auto loop = rewriter.create<scf::ForOp>(
+        loc, lb, ub, step, ValueRange{accInit, maxInit, sumInit},
+        [&](OpBuilder &builder, Location loc, Value iv, ValueRange iterArgs) {
+          Value acc = iterArgs[0];
+          Value oldMax = iterArgs[1];
+          Value oldSum = iterArgs[2];
+
+          // Extract the key and value tiles of this iteration.
+          OpFoldResult sliceSize = getSequenceTileSize(
+              builder, loc, iv, sequenceLength, effectiveTileSize);
+          auto one = builder.getIndexAttr(1);
+          auto zeroIndex = builder.getIndexAttr(0);
+          SmallVector<OpFoldResult> strides(3, one);
+          Value keySlice = builder.create<tensor::ExtractSliceOp>(
+              loc, key, ArrayRef<OpFoldResult>{zeroIndex, iv, zeroIndex},
+              ArrayRef<OpFoldResult>{outputDims[0], sliceSize, headDim},
+              strides);
+          Value valueSlice = builder.create<tensor::ExtractSliceOp>(
+              loc, value, ArrayRef<OpFoldResult>{zeroIndex, iv, zeroIndex},
+              ArrayRef<OpFoldResult>{outputDims[0], sliceSize, outputDims[2]},
+              strides);
+
+          // scores = query @ transpose(keySlice) : (B, N, T)
+          SmallVector<OpFoldResult> scoreDims = {outputDims[0], outputDims[1],
+                                                 sliceSize};
+          Value scoreEmpty =
+              builder.create<tensor::EmptyOp>(loc, scoreDims, elementType);
+          Value scoreInit =
+              builder.create<linalg::FillOp>(loc, zero, scoreEmpty).result();
+          Value scores = createGenericOp(
+              builder, loc, ValueRange{query, keySlice}, scoreInit,
+              {getMap(4, {b, n, k}), getMap(4, {b, t, k}),
+               getMap(4, {b, n, t})},
+              {parallel, parallel, parallel, reduction},
+              [](OpBuilder &builder, Location loc, ValueRange args) {
+                Value mul =
+                    builder.create<arith::MulFOp>(loc, args[0], args[1]);
+                return builder.create<arith::AddFOp>(loc, mul, args[2])
+                    .getResult();
+              });
+
+          // newMax = max(oldMax, rowmax(scores)) : (B, N)
+          AffineMap scoreMap = getMap(3, {b, n, t});
+          AffineMap rowMap = getMap(3, {b, n});
+          Value newMax = createGenericOp(
+              builder, loc, ValueRange{scores}, oldMax, {scoreMap, rowMap},
+              {parallel, parallel, reduction},
+              [](OpBuilder &builder, Location loc, ValueRange args) {
+                return builder.create<arith::MaxFOp>(loc, args[0], args[1])
+                    .getResult();
+              });
+
+          // probabilities = exp(scores - newMax) : (B, N, T)
+          Value probabilities = createGenericOp(
+              builder, loc, ValueRange{newMax}, scores, {rowMap, scoreMap},
+              {parallel, parallel, parallel},
+              [](OpBuilder &builder, Location loc, ValueRange args) {
+                Value sub =
+                    builder.create<arith::SubFOp>(loc, args[1], args[0]);
+                return builder.create<math::ExpOp>(loc, sub).getResult();
+              });
+
+          // correction = exp(oldMax - newMax) : (B, N)
+          AffineMap identity2D = getMap(2, {b, n});
+          Value correctionEmpty =
+              builder.create<tensor::EmptyOp>(loc, rowDims, elementType);
+          Value correction = createGenericOp(
+              builder, loc, ValueRange{oldMax, newMax}, correctionEmpty,
+              {identity2D, identity2D, identity2D}, {parallel, parallel},
+              [](OpBuilder &builder, Location loc, ValueRange args) {
+                Value sub =
+                    builder.create<arith::SubFOp>(loc, args[0], args[1]);
+                return builder.create<math::ExpOp>(loc, sub).getResult();
+              });
+
+          // newSum = oldSum * correction + rowsum(probabilities) : (B, N)
+          Value scaledSum = createGenericOp(
+              builder, loc, ValueRange{correction}, oldSum,
+              {identity2D, identity2D}, {parallel, parallel},
+              [](OpBuilder &builder, Location loc, ValueRange args) {
+                return builder.create<arith::MulFOp>(loc, args[0], args[1])
+                    .getResult();
+              });
+          Value newSum = createGenericOp(
+              builder, loc, ValueRange{probabilities}, scaledSum,
+              {scoreMap, rowMap}, {parallel, parallel, reduction},
+              [](OpBuilder &builder, Location loc, ValueRange args) {
+                return builder.create<arith::AddFOp>(loc, args[0], args[1])
+                    .getResult();
+              });
+
+          // newAcc = acc * correction + probabilities @ valueSlice : (B, N, E)
+          Value scaledAcc = createGenericOp(
+              builder, loc, ValueRange{correction}, acc, {rowMap, scoreMap},
+              {parallel, parallel, parallel},
+              [](OpBuilder &builder, Location loc, ValueRange args) {
+                return builder.create<arith::MulFOp>(loc, args[0], args[1])
+                    .getResult();
+              });
+          // Loop dimensions are (b, n, e, t) here.
+          Value newAcc = createGenericOp(
+              builder, loc, ValueRange{probabilities, valueSlice}, scaledAcc,
+              {getMap(4, {b, n, k}), getMap(4, {b, k, t}),
+               getMap(4, {b, n, t})},
+              {parallel, parallel, parallel, reduction},
+              [](OpBuilder &builder, Location loc, ValueRange args) {
+                Value mul =
+                    builder.create<arith::MulFOp>(loc, args[0], args[1]);
+                return builder.create<arith::AddFOp>(loc, mul, args[2])
+                    .getResult();
+              });
+
+          builder.create<scf::YieldOp>(loc,
+                                       ValueRange{newAcc, newMax, newSum});
+        });
+
+    // result = acc / sum : (B, N, E)
+    AffineMap accMap = getMap(3, {b, n, t});
+    Value result = createGenericOp(
+        rewriter, loc, ValueRange{loop.getResult(2)}, loop.getResult(0),
+        {getMap(3, {b, n}), accMap}, {parallel, parallel, parallel},
+        [](OpBuilder &builder, Location loc, ValueRange args) {
+          return builder.create<arith::DivFOp>(loc, args[1], args[0])
+              .getResult();
+        });
+    rewriter.replaceOp(attnOp, result);
+    return success();
+  }
+
+private:
+  int64_t tileSize;
+};
+
+} // namespace
+
+namespace {
+struct TileAndDecomposeAttentionPass
+    : public TileAndDecomposeAttentionBase<TileAndDecomposeAttentionPass> {
+  void getDependentDialects(DialectRegistry &registry) const override {
+    registry.insert<AffineDialect, IREE::LinalgExt::IREELinalgExtDialect,
+                    linalg::LinalgDialect, math::MathDialect, scf::SCFDialect,
+                    tensor::TensorDialect>();
+  }
+
+  void runOnOperation() override;
+};
+} // namespace
+
+void TileAndDecomposeAttentionPass::runOnOperation() {
+  MLIRContext *context = &getContext();
+  RewritePatternSet patterns(&getContext());
+  patterns.insert<ReifyAttention>(context, tileSize);
+  if (failed(
+          applyPatternsAndFoldGreedily(getOperation(), std::move(patterns)))) {
+    return signalPassFailure();
+  }
+}
+
+std::unique_ptr<OperationPass<func::FuncOp>>
+createTileAndDecomposeAttentionPass() {
+  return std::make_unique<TileAndDecomposeAttentionPass>();
+}
+
+} // namespace LinalgExt
+} // namespace IREE
+} // namespace iree_compiler
+} // namespace mlir
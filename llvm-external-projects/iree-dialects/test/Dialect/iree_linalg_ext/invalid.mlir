@@ -722,3 +722,43 @@ func.func @illegal_winograd_output_image_dimensions(%arg0: tensor<8x8x1x2x2x32xf
 }
 
 // -----
+
+func.func @illegal_attention_inputs(%query: tensor<2x128x64xf32>, %key: tensor<2x256x64xf32>) -> tensor<2x128x64xf32> {
+  %0 = tensor.empty() : tensor<2x128x64xf32>
+  // expected-error @+1 {{expected three input operands}}
+  %1 = iree_linalg_ext.attention ins(%query, %key : tensor<2x128x64xf32>, tensor<2x256x64xf32>)
+    outs(%0 : tensor<2x128x64xf32>) -> tensor<2x128x64xf32>
+  return %1 : tensor<2x128x64xf32>
+}
+
+// -----
+
+func.func @illegal_attention_head_dims(%query: tensor<2x128x64xf32>, %key: tensor<2x256x32xf32>, %value: tensor<2x256x32xf32>) -> tensor<2x128x32xf32> {
+  %0 = tensor.empty() : tensor<2x128x32xf32>
+  // expected-error @+1 {{query and key head dimensions do not match}}
+  %1 = iree_linalg_ext.attention ins(%query, %key, %value : tensor<2x128x64xf32>, tensor<2x256x32xf32>, tensor<2x256x32xf32>)
+    outs(%0 : tensor<2x128x32xf32>) -> tensor<2x128x32xf32>
+  return %1 : tensor<2x128x32xf32>
+}
+
+// -----
+
+func.func @illegal_attention_sequence_lengths(%query: tensor<2x128x64xf32>, %key: tensor<2x256x64xf32>, %value: tensor<2x128x32xf32>) -> tensor<2x128x32xf32> {
+  %0 = tensor.empty() : tensor<2x128x32xf32>
+  // expected-error @+1 {{key and value sequence lengths do not match}}
+  %1 = iree_linalg_ext.attention ins(%query, %key, %value : tensor<2x128x64xf32>, tensor<2x256x64xf32>, tensor<2x128x32xf32>)
+    outs(%0 : tensor<2x128x32xf32>) -> tensor<2x128x32xf32>
+  return %1 : tensor<2x128x32xf32>
+}
+
+// -----
+
+func.func @illegal_attention_element_type(%query: tensor<2x128x64xi32>, %key: tensor<2x256x64xi32>, %value: tensor<2x256x32xi32>) -> tensor<2x128x32xi32> {
+  %0 = tensor.empty() : tensor<2x128x32xi32>
+  // expected-error @+1 {{expected floating point element type}}
+  %1 = iree_linalg_ext.attention ins(%query, %key, %value : tensor<2x128x64xi32>, tensor<2x256x64xi32>, tensor<2x256x32xi32>)
+    outs(%0 : tensor<2x128x32xi32>) -> tensor<2x128x32xi32>
+  return %1 : tensor<2x128x32xi32>
+}
+
+// -----
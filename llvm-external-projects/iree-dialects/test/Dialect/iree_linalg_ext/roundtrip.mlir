@@ -1034,3 +1034,44 @@ func.func @winograd_output_transform_nchw(%arg0: tensor<8x8x1x2x2x1280xf32>) ->
 // CHECK:    }
 
 // -----
+
+func.func @attention(%query: tensor<2x128x64xf32>, %key: tensor<2x256x64xf32>, %value: tensor<2x256x32xf32>) -> tensor<2x128x32xf32> {
+  %0 = tensor.empty() : tensor<2x128x32xf32>
+  %1 = iree_linalg_ext.attention ins(%query, %key, %value : tensor<2x128x64xf32>, tensor<2x256x64xf32>, tensor<2x256x32xf32>)
+    outs(%0 : tensor<2x128x32xf32>) -> tensor<2x128x32xf32>
+  return %1 : tensor<2x128x32xf32>
+}
+// CHECK:      func.func @attention(%[[QUERY:[a-zA-Z0-9_]+]]: tensor<2x128x64xf32>,
+// CHECK-SAME:   %[[KEY:[a-zA-Z0-9_]+]]: tensor<2x256x64xf32>, %[[VALUE:[a-zA-Z0-9_]+]]: tensor<2x256x32xf32>)
+// CHECK:        %[[D0:.+]] = tensor.empty() : tensor<2x128x32xf32>
+// CHECK:        %[[D1:.+]] = iree_linalg_ext.attention ins(%[[QUERY]], %[[KEY]], %[[VALUE]] :
+// CHECK-SAME:     tensor<2x128x64xf32>, tensor<2x256x64xf32>, tensor<2x256x32xf32>) outs(%[[D0]] :
+// CHECK-SAME:     tensor<2x128x32xf32>) -> tensor<2x128x32xf32>
+// CHECK:        return %[[D1]] : tensor<2x128x32xf32>
+
+// -----
+
+func.func @attention_dynamic(%query: tensor<?x?x?xf32>, %key: tensor<?x?x?xf32>, %value: tensor<?x?x?xf32>, %output: tensor<?x?x?xf32>) -> tensor<?x?x?xf32> {
+  %0 = iree_linalg_ext.attention ins(%query, %key, %value : tensor<?x?x?xf32>, tensor<?x?x?xf32>, tensor<?x?x?xf32>)
+    outs(%output : tensor<?x?x?xf32>) -> tensor<?x?x?xf32>
+  return %0 : tensor<?x?x?xf32>
+}
+// CHECK:      func.func @attention_dynamic(
+// CHECK:        iree_linalg_ext.attention
+// CHECK-SAME:     -> tensor<?x?x?xf32>
+
+// -----
+
+func.func @attention_memref(%query: memref<2x128x64xf32>, %key: memref<2x256x64xf32>, %value: memref<2x256x32xf32>, %output: memref<2x128x32xf32>) {
+  iree_linalg_ext.attention ins(%query, %key, %value : memref<2x128x64xf32>, memref<2x256x64xf32>, memref<2x256x32xf32>)
+    outs(%output : memref<2x128x32xf32>)
+  return
+}
+// CHECK:      func.func @attention_memref(%[[QUERY:[a-zA-Z0-9_]+]]: memref<2x128x64xf32>,
+// CHECK-SAME:   %[[KEY:[a-zA-Z0-9_]+]]: memref<2x256x64xf32>, %[[VALUE:[a-zA-Z0-9_]+]]: memref<2x256x32xf32>,
+// CHECK-SAME:   %[[OUTPUT:[a-zA-Z0-9_]+]]: memref<2x128x32xf32>)
+// CHECK:        iree_linalg_ext.attention ins(%[[QUERY]], %[[KEY]], %[[VALUE]] :
+// CHECK-SAME:     memref<2x128x64xf32>, memref<2x256x64xf32>, memref<2x256x32xf32>) outs(%[[OUTPUT]] :
+// CHECK-SAME:     memref<2x128x32xf32>)
+
+// -----
@@ -0,0 +1,84 @@
+// RUN: iree-dialects-opt --iree-linalg-ext-tile-and-decompose-attention --split-input-file %s | FileCheck %s
+// RUN: iree-dialects-opt --iree-linalg-ext-tile-and-decompose-attention=tile-size=48 --split-input-file %s | FileCheck %s --check-prefix=PARTIAL
+
+func.func @attention(%query: tensor<1x64x16xf32>, %key: tensor<1x128x16xf32>, %value: tensor<1x128x32xf32>) -> tensor<1x64x32xf32> {
+  %0 = tensor.empty() : tensor<1x64x32xf32>
+  %1 = iree_linalg_ext.attention ins(%query, %key, %value : tensor<1x64x16xf32>, tensor<1x128x16xf32>, tensor<1x128x32xf32>)
+    outs(%0 : tensor<1x64x32xf32>) -> tensor<1x64x32xf32>
+  return %1 : tensor<1x64x32xf32>
+}
+// CHECK-DAG:  #[[MAP_Q:.+]] = affine_map<(d0, d1, d2, d3) -> (d0, d1, d3)>
+// CHECK-DAG:  #[[MAP_K:.+]] = affine_map<(d0, d1, d2, d3) -> (d0, d2, d3)>
+// CHECK-DAG:  #[[MAP_S:.+]] = affine_map<(d0, d1, d2, d3) -> (d0, d1, d2)>
+// CHECK-DAG:  #[[MAP_V:.+]] = affine_map<(d0, d1, d2, d3) -> (d0, d3, d2)>
+// CHECK-DAG:  #[[MAP_3D:.+]] = affine_map<(d0, d1, d2) -> (d0, d1, d2)>
+// CHECK-DAG:  #[[MAP_ROW:.+]] = affine_map<(d0, d1, d2) -> (d0, d1)>
+// CHECK:      func.func @attention(%[[QUERY:[a-zA-Z0-9_]+]]: tensor<1x64x16xf32>,
+// CHECK-SAME:   %[[KEY:[a-zA-Z0-9_]+]]: tensor<1x128x16xf32>, %[[VALUE:[a-zA-Z0-9_]+]]: tensor<1x128x32xf32>)
+// CHECK-DAG:    %[[ZERO:.+]] = arith.constant 0.000000e+00 : f32
+// CHECK-DAG:    %[[LOWEST:.+]] = arith.constant -3.40282347E+38 : f32
+// CHECK-DAG:    %[[C0:.+]] = arith.constant 0 : index
+// CHECK-DAG:    %[[C32:.+]] = arith.constant 32 : index
+// CHECK-DAG:    %[[C128:.+]] = arith.constant 128 : index
+// CHECK:        %[[OUTPUT:.+]] = tensor.empty() : tensor<1x64x32xf32>
+// CHECK:        %[[ROW:.+]] = tensor.empty() : tensor<1x64xf32>
+// CHECK:        %[[MAX_INIT:.+]] = linalg.fill ins(%[[LOWEST]] : f32) outs(%[[ROW]] : tensor<1x64xf32>)
+// CHECK:        %[[SUM_INIT:.+]] = linalg.fill ins(%[[ZERO]] : f32) outs(%[[ROW]] : tensor<1x64xf32>)
+// CHECK:        %[[ACC_INIT:.+]] = linalg.fill ins(%[[ZERO]] : f32) outs(%[[OUTPUT]] : tensor<1x64x32xf32>)
+// CHECK:        %[[LOOP:.+]]:3 = scf.for %[[IV:[a-zA-Z0-9_]+]] = %[[C0]] to %[[C128]] step %[[C32]]
+// CHECK-SAME:     iter_args(%[[ACC:[a-zA-Z0-9_]+]] = %[[ACC_INIT]], %[[MAX:[a-zA-Z0-9_]+]] = %[[MAX_INIT]],
+// CHECK-SAME:     %[[SUM:[a-zA-Z0-9_]+]] = %[[SUM_INIT]])
+// CHECK-SAME:     -> (tensor<1x64x32xf32>, tensor<1x64xf32>, tensor<1x64xf32>) {
+// CHECK:          %[[KEY_SLICE:.+]] = tensor.extract_slice %[[KEY]][0, %[[IV]], 0] [1, 32, 16] [1, 1, 1]
+// CHECK-SAME:       : tensor<1x128x16xf32> to tensor<1x32x16xf32>
+// CHECK:          %[[VALUE_SLICE:.+]] = tensor.extract_slice %[[VALUE]][0, %[[IV]], 0] [1, 32, 32] [1, 1, 1]
+// CHECK-SAME:       : tensor<1x128x32xf32> to tensor<1x32x32xf32>
+// CHECK:          %[[SCORE_EMPTY:.+]] = tensor.empty() : tensor<1x64x32xf32>
+// CHECK:          %[[SCORE_INIT:.+]] = linalg.fill ins(%[[ZERO]] : f32) outs(%[[SCORE_EMPTY]] : tensor<1x64x32xf32>)
+// CHECK:          %[[SCORES:.+]] = linalg.generic {indexing_maps = [#[[MAP_Q]], #[[MAP_K]], #[[MAP_S]]]
+// CHECK-SAME:       ins(%[[QUERY]], %[[KEY_SLICE]] : tensor<1x64x16xf32>, tensor<1x32x16xf32>)
+// CHECK-SAME:       outs(%[[SCORE_INIT]] : tensor<1x64x32xf32>)
+// CHECK:            arith.mulf
+// CHECK:            arith.addf
+// CHECK:          %[[NEW_MAX:.+]] = linalg.generic {indexing_maps = [#[[MAP_3D]], #[[MAP_ROW]]]
+// CHECK-SAME:       ins(%[[SCORES]] : tensor<1x64x32xf32>) outs(%[[MAX]] : tensor<1x64xf32>)
+// CHECK:            arith.maxf
+// CHECK:          %[[PROB:.+]] = linalg.generic {indexing_maps = [#[[MAP_ROW]], #[[MAP_3D]]]
+// CHECK-SAME:       ins(%[[NEW_MAX]] : tensor<1x64xf32>) outs(%[[SCORES]] : tensor<1x64x32xf32>)
+// CHECK:            arith.subf
+// CHECK:            math.exp
+// CHECK:          %[[CORRECTION_EMPTY:.+]] = tensor.empty() : tensor<1x64xf32>
+// CHECK:          %[[CORRECTION:.+]] = linalg.generic
+// CHECK-SAME:       ins(%[[MAX]], %[[NEW_MAX]] : tensor<1x64xf32>, tensor<1x64xf32>)
+// CHECK-SAME:       outs(%[[CORRECTION_EMPTY]] : tensor<1x64xf32>)
+// CHECK:            arith.subf
+// CHECK:            math.exp
+// CHECK:          %[[SCALED_SUM:.+]] = linalg.generic
+// CHECK-SAME:       ins(%[[CORRECTION]] : tensor<1x64xf32>) outs(%[[SUM]] : tensor<1x64xf32>)
+// CHECK:            arith.mulf
+// CHECK:          %[[NEW_SUM:.+]] = linalg.generic {indexing_maps = [#[[MAP_3D]], #[[MAP_ROW]]]
+// CHECK-SAME:       ins(%[[PROB]] : tensor<1x64x32xf32>) outs(%[[SCALED_SUM]] : tensor<1x64xf32>)
+// CHECK:            arith.addf
+// CHECK:          %[[SCALED_ACC:.+]] = linalg.generic {indexing_maps = [#[[MAP_ROW]], #[[MAP_3D]]]
+// CHECK-SAME:       ins(%[[CORRECTION]] : tensor<1x64xf32>) outs(%[[ACC]] : tensor<1x64x32xf32>)
+// CHECK:            arith.mulf
+// CHECK:          %[[NEW_ACC:.+]] = linalg.generic {indexing_maps = [#[[MAP_Q]], #[[MAP_V]], #[[MAP_S]]]
+// CHECK-SAME:       ins(%[[PROB]], %[[VALUE_SLICE]] : tensor<1x64x32xf32>, tensor<1x32x32xf32>)
+// CHECK-SAME:       outs(%[[SCALED_ACC]] : tensor<1x64x32xf32>)
+// CHECK:            arith.mulf
+// CHECK:            arith.addf
+// CHECK:          scf.yield %[[NEW_ACC]], %[[NEW_MAX]], %[[NEW_SUM]]
+// CHECK:        }
+// CHECK:        %[[RESULT:.+]] = linalg.generic {indexing_maps = [#[[MAP_ROW]], #[[MAP_3D]]]
+// CHECK-SAME:     ins(%[[LOOP]]#2 : tensor<1x64xf32>) outs(%[[LOOP]]#0 : tensor<1x64x32xf32>)
+// CHECK:          arith.divf
+// CHECK:        return %[[RESULT]] : tensor<1x64x32xf32>
+
+// PARTIAL-DAG:  #[[MAP_MIN:.+]] = affine_map<(d0)[s0] -> (48, -d0 + s0)>
+// PARTIAL:      func.func @attention
+// PARTIAL-DAG:    %[[C48:.+]] = arith.constant 48 : index
+// PARTIAL-DAG:    %[[C128:.+]] = arith.constant 128 : index
+// PARTIAL:        scf.for %[[IV:[a-zA-Z0-9_]+]] = %{{.+}} to %[[C128]] step %[[C48]]
+// PARTIAL:          %[[SIZE:.+]] = affine.min #[[MAP_MIN]](%[[IV]])[%[[C128]]]
+// PARTIAL:          tensor.extract_slice %{{.+}}[0, %[[IV]], 0] [1, %[[SIZE]], 16] [1, 1, 1]
+// PARTIAL-SAME:       : tensor<1x128x16xf32> to tensor<1x?x16xf32>
@@ -1505,3 +1505,38 @@ func.func @winograd_output_transform_nchw(%arg0: tensor<8x8x1x2x2x32xf32>) -> te
 // CHECK:    }
 
 // -----
+
+func.func @attention(%query: tensor<2x128x64xf32>, %key: tensor<2x256x64xf32>, %value: tensor<2x256x32xf32>) -> tensor<2x128x32xf32> {
+  %0 = tensor.empty() : tensor<2x128x32xf32>
+  %1 = iree_linalg_ext.attention {__internal_linalg_transform__ = "tiling_attention"}
+    ins(%query, %key, %value : tensor<2x128x64xf32>, tensor<2x256x64xf32>, tensor<2x256x32xf32>)
+    outs(%0 : tensor<2x128x32xf32>) -> tensor<2x128x32xf32>
+  return %1 : tensor<2x128x32xf32>
+}
+// CHECK:      func.func @attention(%[[QUERY:[a-zA-Z0-9_]+]]: tensor<2x128x64xf32>,
+// CHECK-SAME:   %[[KEY:[a-zA-Z0-9_]+]]: tensor<2x256x64xf32>, %[[VALUE:[a-zA-Z0-9_]+]]: tensor<2x256x32xf32>)
+// CHECK-DAG:    %[[C0:.+]] = arith.constant 0 : index
+// CHECK-DAG:    %[[C1:.+]] = arith.constant 1 : index
+// CHECK-DAG:    %[[C2:.+]] = arith.constant 2 : index
+// CHECK-DAG:    %[[C32:.+]] = arith.constant 32 : index
+// CHECK-DAG:    %[[C128:.+]] = arith.constant 128 : index
+// CHECK:        %[[D0:.+]] = tensor.empty() : tensor<2x128x32xf32>
+// CHECK:        %[[D1:.+]] = scf.for %[[ARG1:[a-zA-Z0-9_]+]] = %[[C0]] to %[[C2]] step %[[C1]]
+// CHECK-SAME:     iter_args(%[[ARG2:[a-zA-Z0-9_]+]] = %[[D0]]) -> (tensor<2x128x32xf32>) {
+// CHECK:          %[[D2:.+]] = scf.for %[[ARG3:[a-zA-Z0-9_]+]] = %[[C0]] to %[[C128]] step %[[C32]]
+// CHECK-SAME:       iter_args(%[[ARG4:[a-zA-Z0-9_]+]] = %[[ARG2]]) -> (tensor<2x128x32xf32>) {
+// CHECK:            %[[QUERY_SLICE:.+]] = tensor.extract_slice %[[QUERY]][%[[ARG1]], %[[ARG3]], 0]
+// CHECK:            %[[KEY_SLICE:.+]] = tensor.extract_slice %[[KEY]][%[[ARG1]], 0, 0]
+// CHECK:            %[[VALUE_SLICE:.+]] = tensor.extract_slice %[[VALUE]][%[[ARG1]], 0, 0]
+// CHECK:            %[[OUTPUT_SLICE:.+]] = tensor.extract_slice %[[D0]][%[[ARG1]], %[[ARG3]], 0]
+// CHECK:            %[[D3:.+]] = iree_linalg_ext.attention
+// CHECK-SAME:         ins(%[[QUERY_SLICE]], %[[KEY_SLICE]], %[[VALUE_SLICE]] :
+// CHECK-SAME:         outs(%[[OUTPUT_SLICE]] :
+// CHECK:            %[[INSERTED_SLICE:.+]] = tensor.insert_slice %[[D3]] into %[[ARG4]][%[[ARG1]], %[[ARG3]], 0]
+// CHECK:            scf.yield %[[INSERTED_SLICE]] : tensor<2x128x32xf32>
+// CHECK:          }
+// CHECK:          scf.yield %[[D2]] : tensor<2x128x32xf32>
+// CHECK:        }
+// CHECK:        return %[[D1]] : tensor<2x128x32xf32>
+
+// -----
@@ -6,6 +6,10 @@
 
 #include "./hal.h"
 
+#include <memory>
+#include <mutex>
+#include <utility>
+
 #include "./vm.h"
 #include "iree/base/internal/path.h"
 #include "iree/base/tracing.h"
@@ -43,6 +47,280 @@ static std::string ToHexString(uint32_t value) {
   return ToHexString((const uint8_t*)&value, sizeof(value));
 }
 
+// Takes ownership of |buffer| and returns it as a Python object, wrapped in a
+// buffer view of the given |shape| if |element_type| is specified.
+template <typename DimT>
+py::object WrapBuffer(iree_hal_allocator_t* allocator,
+                      iree_hal_buffer_t* buffer, int rank, const DimT* shape,
+                      std::optional<iree_hal_element_types_t> element_type) {
+  if (!element_type) {
+    return py::cast(HalBuffer::StealFromRawPtr(buffer),
+                    py::return_value_policy::move);
+  }
+
+  // Create the buffer_view. (note that numpy shape is ssize_t, so we need to
+  // copy).
+  iree_hal_encoding_type_t encoding_type =
+      IREE_HAL_ENCODING_TYPE_DENSE_ROW_MAJOR;
+  std::vector<iree_hal_dim_t> dims(shape, shape + rank);
+  iree_hal_buffer_view_t* hal_buffer_view;
+  iree_status_t status = iree_hal_buffer_view_create(
+      buffer, dims.size(), dims.data(), *element_type, encoding_type,
+      iree_hal_allocator_host_allocator(allocator), &hal_buffer_view);
+  iree_hal_buffer_release(buffer);
+  CheckApiStatus(status, "Error allocating buffer_view");
+
+  return py::cast(HalBufferView::StealFromRawPtr(hal_buffer_view),
+                  py::return_value_policy::move);
+}
+
+//------------------------------------------------------------------------------
+// Deferred release of imported memory
+//------------------------------------------------------------------------------
+// Imported Python memory is released when the last reference to its HAL buffer
+// is dropped, which may happen on any thread (such as a task worker retiring a
+// submission). Blocking on the GIL there could deadlock with a Python thread
+// holding it while waiting on that work so releases from threads not holding
+// the GIL are queued and run by the interpreter as a pending call (or by the
+// next import if the pending call queue was full).
+
+struct DeferredReleaseQueue {
+  std::mutex mutex;
+  std::vector<std::pair<void (*)(void*), void*>> releases;
+  bool drain_scheduled = false;
+};
+
+DeferredReleaseQueue& GetDeferredReleaseQueue() {
+  static DeferredReleaseQueue* queue = new DeferredReleaseQueue();
+  return *queue;
+}
+
+// Runs all queued releases. Must be called with the GIL held.
+int DrainDeferredReleases(void* unused) {
+  auto& queue = GetDeferredReleaseQueue();
+  std::vector<std::pair<void (*)(void*), void*>> releases;
+  {
+    std::lock_guard<std::mutex> lock(queue.mutex);
+    releases.swap(queue.releases);
+    queue.drain_scheduled = false;
+  }
+  for (auto& release : releases) release.first(release.second);
+  return 0;
+}
+
+// Calls |fn| with |user_data| while holding the GIL, either immediately if the
+// calling thread already holds it or later from the interpreter.
+void ReleaseWithGil(void (*fn)(void*), void* user_data) {
+  // Leaked if the interpreter has already been torn down.
+  if (!Py_IsInitialized()) return;
+  if (PyGILState_Check()) {
+    fn(user_data);
+    return;
+  }
+  auto& queue = GetDeferredReleaseQueue();
+  bool schedule = false;
+  {
+    std::lock_guard<std::mutex> lock(queue.mutex);
+    queue.releases.emplace_back(fn, user_data);
+    schedule = !queue.drain_scheduled;
+    queue.drain_scheduled = true;
+  }
+  if (schedule && Py_AddPendingCall(DrainDeferredReleases, nullptr) != 0) {
+    std::lock_guard<std::mutex> lock(queue.mutex);
+    queue.drain_scheduled = false;
+  }
+}
+
+void ReleasePyBuffer(void* user_data) {
+  Py_buffer* py_view = static_cast<Py_buffer*>(user_data);
+  PyBuffer_Release(py_view);
+  delete py_view;
+}
+
+void ReleaseImportedPyBuffer(void* user_data, iree_hal_buffer_t* buffer) {
+  ReleaseWithGil(ReleasePyBuffer, user_data);
+}
+
+// Imports |length| bytes of host memory at |data| into a HAL buffer without
+// copying. |release_callback| is only issued if the import succeeds.
+iree_status_t ImportHostMemory(
+    iree_hal_allocator_t* allocator, int allowed_usage, void* data,
+    iree_device_size_t length,
+    iree_hal_buffer_release_callback_t release_callback,
+    iree_hal_buffer_t** out_buffer) {
+  // The memory is host local no matter where the caller wanted it placed.
+  iree_hal_buffer_params_t params = {0};
+  params.type =
+      IREE_HAL_MEMORY_TYPE_HOST_LOCAL | IREE_HAL_MEMORY_TYPE_DEVICE_VISIBLE;
+  params.usage = allowed_usage;
+  if (!iree_all_bits_set(
+          iree_hal_allocator_query_compatibility(allocator, params, length),
+          IREE_HAL_BUFFER_COMPATIBILITY_IMPORTABLE)) {
+    return iree_make_status(IREE_STATUS_UNAVAILABLE,
+                            "allocator cannot import host memory");
+  }
+  iree_hal_external_buffer_t external_buffer;
+  memset(&external_buffer, 0, sizeof(external_buffer));
+  external_buffer.type = IREE_HAL_EXTERNAL_BUFFER_TYPE_HOST_ALLOCATION;
+  external_buffer.size = length;
+  external_buffer.handle.host_allocation.ptr = data;
+  return iree_hal_allocator_import_buffer(allocator, params, &external_buffer,
+                                          release_callback, out_buffer);
+}
+
+//------------------------------------------------------------------------------
+// DLPack
+//------------------------------------------------------------------------------
+// ABI-compatible subset of dlpack.h (https://github.com/dmlc/dlpack) v0.8.
+
+constexpr const char* kDLPackCapsuleName = "dltensor";
+constexpr const char* kDLPackUsedCapsuleName = "used_dltensor";
+
+constexpr int32_t kDLCPU = 1;
+
+enum DLDataTypeCode : uint8_t {
+  kDLInt = 0,
+  kDLUInt = 1,
+  kDLFloat = 2,
+  kDLBfloat = 4,
+  kDLComplex = 5,
+  kDLBool = 6,
+};
+
+struct DLDevice {
+  int32_t device_type;
+  int32_t device_id;
+};
+
+struct DLDataType {
+  uint8_t code;
+  uint8_t bits;
+  uint16_t lanes;
+};
+
+struct DLTensor {
+  void* data;
+  DLDevice device;
+  int32_t ndim;
+  DLDataType dtype;
+  int64_t* shape;
+  int64_t* strides;
+  uint64_t byte_offset;
+};
+
+struct DLManagedTensor {
+  DLTensor dl_tensor;
+  void* manager_ctx;
+  void (*deleter)(DLManagedTensor* self);
+};
+
+bool MapElementTypeToDLDataType(iree_hal_element_type_t element_type,
+                                DLDataType* out_dtype) {
+  if (!iree_hal_element_is_byte_aligned(element_type)) return false;
+  switch (iree_hal_element_numerical_type(element_type)) {
+    case IREE_HAL_NUMERICAL_TYPE_INTEGER:
+    case IREE_HAL_NUMERICAL_TYPE_INTEGER_SIGNED:
+      out_dtype->code = kDLInt;
+      break;
+    case IREE_HAL_NUMERICAL_TYPE_INTEGER_UNSIGNED:
+      out_dtype->code = kDLUInt;
+      break;
+    case IREE_HAL_NUMERICAL_TYPE_BOOLEAN:
+      out_dtype->code = kDLBool;
+      break;
+    case IREE_HAL_NUMERICAL_TYPE_FLOAT_IEEE:
+      out_dtype->code = kDLFloat;
+      break;
+    case IREE_HAL_NUMERICAL_TYPE_FLOAT_BRAIN:
+      out_dtype->code = kDLBfloat;
+      break;
+    case IREE_HAL_NUMERICAL_TYPE_FLOAT_COMPLEX:
+      out_dtype->code = kDLComplex;
+      break;
+    default:
+      return false;
+  }
+  out_dtype->bits = iree_hal_element_bit_count(element_type);
+  out_dtype->lanes = 1;
+  return true;
+}
+
+bool MapDLDataTypeToElementType(DLDataType dtype,
+                                iree_hal_element_type_t* out_element_type) {
+  if (dtype.lanes != 1 || dtype.bits % 8 != 0) return false;
+  iree_hal_numerical_type_t numerical_type;
+  switch (dtype.code) {
+    case kDLInt:
+      numerical_type = IREE_HAL_NUMERICAL_TYPE_INTEGER_SIGNED;
+      break;
+    case kDLUInt:
+      numerical_type = IREE_HAL_NUMERICAL_TYPE_INTEGER_UNSIGNED;
+      break;
+    case kDLBool:
+      numerical_type = IREE_HAL_NUMERICAL_TYPE_BOOLEAN;
+      break;
+    case kDLFloat:
+      numerical_type = IREE_HAL_NUMERICAL_TYPE_FLOAT_IEEE;
+      break;
+    case kDLBfloat:
+      numerical_type = IREE_HAL_NUMERICAL_TYPE_FLOAT_BRAIN;
+      break;
+    case kDLComplex:
+      numerical_type = IREE_HAL_NUMERICAL_TYPE_FLOAT_COMPLEX;
+      break;
+    default:
+      return false;
+  }
+  *out_element_type = iree_hal_make_element_type(numerical_type, dtype.bits);
+  return true;
+}
+
+// Owns the resources aliased by an exported tensor.
+struct DLPackExportContext {
+  DLManagedTensor tensor;
+  iree_hal_buffer_view_t* buffer_view;
+  iree_hal_buffer_mapping_t mapping;
+  std::vector<int64_t> shape;
+};
+
+void DeleteDLPackExport(DLManagedTensor* self) {
+  auto* context = static_cast<DLPackExportContext*>(self->manager_ctx);
+  iree_hal_buffer_unmap_range(&context->mapping);
+  iree_hal_buffer_view_release(context->buffer_view);
+  delete context;
+}
+
+// Deletes the tensor of a capsule that was never consumed. Consumers rename
+// the capsule when taking ownership.
+void DeleteUnconsumedDLPackCapsule(PyObject* capsule) {
+  if (!PyCapsule_IsValid(capsule, kDLPackCapsuleName)) return;
+  auto* tensor = static_cast<DLManagedTensor*>(
+      PyCapsule_GetPointer(capsule, kDLPackCapsuleName));
+  if (tensor && tensor->deleter) tensor->deleter(tensor);
+}
+
+void DeleteDLPackImport(void* user_data) {
+  auto* tensor = static_cast<DLManagedTensor*>(user_data);
+  if (tensor->deleter) tensor->deleter(tensor);
+}
+
+void ReleaseImportedDLPackTensor(void* user_data, iree_hal_buffer_t* buffer) {
+  ReleaseWithGil(DeleteDLPackImport, user_data);
+}
+
+// Returns true if |tensor| has a compact row-major layout.
+bool IsDLTensorRowMajor(const DLTensor& tensor) {
+  if (!tensor.strides) return true;
+  int64_t expected_stride = 1;
+  for (int32_t i = tensor.ndim - 1; i >= 0; --i) {
+    if (tensor.shape[i] != 1 && tensor.strides[i] != expected_stride) {
+      return false;
+    }
+    expected_stride *= tensor.shape[i];
+  }
+  return true;
+}
+
 }  // namespace
 
 //------------------------------------------------------------------------------
@@ -115,27 +393,106 @@ py::object HalAllocator::AllocateBufferCopy(
   }
   CheckApiStatus(status, "Failed to allocate device visible buffer");
 
-  if (!element_type) {
-    return py::cast(HalBuffer::StealFromRawPtr(hal_buffer),
-                    py::return_value_policy::move);
+  return WrapBuffer(raw_ptr(), hal_buffer, py_view.ndim, py_view.shape,
+                    element_type);
+}
+
+py::object HalAllocator::ImportBuffer(
+    int memory_type, int allowed_usage, py::object buffer,
+    std::optional<iree_hal_element_types_t> element_type, bool allow_copy) {
+  IREE_TRACE_SCOPE0("HalAllocator::ImportBuffer");
+  DrainDeferredReleases(nullptr);
+
+  // Owned by the imported buffer once the import succeeds. Only C-contiguous
+  // ND-arrays can be imported as with AllocateBufferCopy.
+  auto py_view = std::make_unique<Py_buffer>();
+  if (PyObject_GetBuffer(buffer.ptr(), py_view.get(),
+                         PyBUF_FORMAT | PyBUF_ND) != 0) {
+    throw py::error_already_set();
   }
 
-  // Create the buffer_view. (note that numpy shape is ssize_t, so we need to
-  // copy).
-  iree_hal_encoding_type_t encoding_type =
-      IREE_HAL_ENCODING_TYPE_DENSE_ROW_MAJOR;
-  std::vector<iree_hal_dim_t> dims(py_view.ndim);
-  std::copy(py_view.shape, py_view.shape + py_view.ndim, dims.begin());
-  iree_hal_buffer_view_t* hal_buffer_view;
-  CheckApiStatus(
-      iree_hal_buffer_view_create(
-          hal_buffer, dims.size(), dims.data(), *element_type, encoding_type,
-          iree_hal_allocator_host_allocator(raw_ptr()), &hal_buffer_view),
-      "Error allocating buffer_view");
-  iree_hal_buffer_release(hal_buffer);
+  // Read-only memory is never imported as programs may write to their
+  // argument buffers.
+  iree_hal_buffer_t* hal_buffer = nullptr;
+  iree_status_t status =
+      py_view->readonly
+          ? iree_make_status(IREE_STATUS_PERMISSION_DENIED,
+                             "read-only buffers cannot be imported")
+          : ImportHostMemory(raw_ptr(), allowed_usage, py_view->buf,
+                             py_view->len,
+                             {ReleaseImportedPyBuffer, py_view.get()},
+                             &hal_buffer);
+  if (!iree_status_is_ok(status)) {
+    PyBuffer_Release(py_view.get());
+    if (!allow_copy) CheckApiStatus(status, "Failed to import buffer");
+    iree_status_ignore(status);
+    return AllocateBufferCopy(memory_type, allowed_usage, std::move(buffer),
+                              element_type);
+  }
 
-  return py::cast(HalBufferView::StealFromRawPtr(hal_buffer_view),
-                  py::return_value_policy::move);
+  Py_buffer* imported_view = py_view.release();
+  return WrapBuffer(raw_ptr(), hal_buffer, imported_view->ndim,
+                    imported_view->shape, element_type);
+}
+
+py::object HalAllocator::ImportDLPack(int memory_type, int allowed_usage,
+                                      py::object tensor, bool allow_copy) {
+  IREE_TRACE_SCOPE0("HalAllocator::ImportDLPack");
+  DrainDeferredReleases(nullptr);
+
+  py::object capsule = tensor;
+  if (!PyCapsule_CheckExact(tensor.ptr())) {
+    capsule = tensor.attr("__dlpack__")();
+  }
+  auto* managed_tensor = static_cast<DLManagedTensor*>(
+      PyCapsule_GetPointer(capsule.ptr(), kDLPackCapsuleName));
+  if (!managed_tensor) throw py::error_already_set();
+  const DLTensor& dl_tensor = managed_tensor->dl_tensor;
+
+  if (dl_tensor.device.device_type != kDLCPU) {
+    throw RaiseValueError("Only DLPack tensors on the CPU can be imported");
+  }
+  if (!IsDLTensorRowMajor(dl_tensor)) {
+    throw RaiseValueError("Only row-major DLPack tensors can be imported");
+  }
+  iree_hal_element_type_t element_type = IREE_HAL_ELEMENT_TYPE_NONE;
+  if (!MapDLDataTypeToElementType(dl_tensor.dtype, &element_type)) {
+    throw RaiseValueError("Unsupported DLPack dtype");
+  }
+  // The shape is copied as the tensor may be deleted before wrapping below.
+  std::vector<int64_t> shape(dl_tensor.shape, dl_tensor.shape + dl_tensor.ndim);
+  iree_device_size_t length = iree_hal_element_dense_byte_count(element_type);
+  for (int64_t dim : shape) length *= dim;
+  void* data = static_cast<uint8_t*>(dl_tensor.data) + dl_tensor.byte_offset;
+
+  // Take ownership of the tensor from the capsule.
+  if (PyCapsule_SetName(capsule.ptr(), kDLPackUsedCapsuleName) != 0) {
+    throw py::error_already_set();
+  }
+
+  iree_hal_buffer_t* hal_buffer = nullptr;
+  iree_status_t status = ImportHostMemory(
+      raw_ptr(), allowed_usage, data, length,
+      {ReleaseImportedDLPackTensor, managed_tensor}, &hal_buffer);
+  if (!iree_status_is_ok(status) && allow_copy) {
+    iree_status_ignore(status);
+    iree_hal_buffer_params_t params = {0};
+    params.type = memory_type | IREE_HAL_MEMORY_TYPE_HOST_VISIBLE;
+    params.usage = allowed_usage;
+    {
+      py::gil_scoped_release release;
+      status = iree_hal_allocator_allocate_buffer(
+          raw_ptr(), params, length, iree_make_const_byte_span(data, length),
+          &hal_buffer);
+    }
+    DeleteDLPackImport(managed_tensor);
+  } else if (!iree_status_is_ok(status)) {
+    DeleteDLPackImport(managed_tensor);
+  }
+  CheckApiStatus(status, "Failed to import DLPack tensor");
+
+  return WrapBuffer(raw_ptr(), hal_buffer, shape.size(), shape.data(),
+                    static_cast<iree_hal_element_types_t>(element_type));
 }
 
 //------------------------------------------------------------------------------
@@ -208,6 +565,55 @@ py::str HalBufferView::Repr() {
   return py::str(repr);
 }
 
+py::capsule HalBufferView::ExportDLPack() {
+  IREE_TRACE_SCOPE0("HalBufferView::ExportDLPack");
+  auto context = std::make_unique<DLPackExportContext>();
+  DLTensor& dl_tensor = context->tensor.dl_tensor;
+  if (!MapElementTypeToDLDataType(iree_hal_buffer_view_element_type(raw_ptr()),
+                                  &dl_tensor.dtype)) {
+    throw RaiseValueError("Buffer view element type has no DLPack dtype");
+  }
+  iree_hal_buffer_t* buffer = iree_hal_buffer_view_buffer(raw_ptr());
+  CheckApiStatus(
+      iree_hal_buffer_map_range(buffer, IREE_HAL_MAPPING_MODE_SCOPED,
+                                iree_hal_buffer_allowed_access(buffer), 0,
+                                IREE_WHOLE_BUFFER, &context->mapping),
+      "Could not map memory for DLPack export");
+  context->buffer_view = raw_ptr();
+  iree_hal_buffer_view_retain(context->buffer_view);
+
+  iree_host_size_t rank = iree_hal_buffer_view_shape_rank(raw_ptr());
+  const iree_hal_dim_t* dims = iree_hal_buffer_view_shape_dims(raw_ptr());
+  context->shape.assign(dims, dims + rank);
+  dl_tensor.data = context->mapping.contents.data;
+  dl_tensor.device = {kDLCPU, 0};
+  dl_tensor.ndim = static_cast<int32_t>(rank);
+  dl_tensor.shape = context->shape.data();
+  dl_tensor.strides = nullptr;  // row-major
+  dl_tensor.byte_offset = 0;
+  context->tensor.manager_ctx = context.get();
+  context->tensor.deleter = DeleteDLPackExport;
+
+  PyObject* capsule = PyCapsule_New(&context->tensor, kDLPackCapsuleName,
+                                    DeleteUnconsumedDLPackCapsule);
+  if (!capsule) {
+    DeleteDLPackExport(&context.release()->tensor);
+    throw py::error_already_set();
+  }
+  context.release();
+  return py::reinterpret_steal<py::capsule>(capsule);
+}
+
+py::tuple HalBufferView::DLPackDevice() {
+  // Exports alias host mappings of the buffer so are always on the CPU.
+  iree_hal_buffer_t* buffer = iree_hal_buffer_view_buffer(raw_ptr());
+  if (!iree_all_bits_set(iree_hal_buffer_memory_type(buffer),
+                         IREE_HAL_MEMORY_TYPE_HOST_VISIBLE)) {
+    throw RaiseValueError("Buffer is not host visible and cannot be exported");
+  }
+  return py::make_tuple(kDLCPU, 0);
+}
+
 //------------------------------------------------------------------------------
 // HalDevice
 //------------------------------------------------------------------------------
@@ -244,6 +650,126 @@ void HalDevice::EndProfiling() {
                  "ending device profiling");
 }
 
+HalSemaphore HalDevice::CreateSemaphore(uint64_t initial_value) {
+  iree_hal_semaphore_t* semaphore = nullptr;
+  CheckApiStatus(
+      iree_hal_semaphore_create(raw_ptr(), initial_value, &semaphore),
+      "creating semaphore");
+  return HalSemaphore::StealFromRawPtr(semaphore);
+}
+
+//------------------------------------------------------------------------------
+// HalSemaphore / HalFence
+//------------------------------------------------------------------------------
+
+uint64_t HalSemaphore::Query() {
+  uint64_t value = 0;
+  CheckApiStatus(iree_hal_semaphore_query(raw_ptr(), &value),
+                 "semaphore failed");
+  return value;
+}
+
+void HalSemaphore::Signal(uint64_t new_value) {
+  CheckApiStatus(iree_hal_semaphore_signal(raw_ptr(), new_value),
+                 "signaling semaphore");
+}
+
+HalFence HalFence::CreateAt(HalSemaphore& semaphore, uint64_t value) {
+  iree_hal_fence_t* fence = nullptr;
+  CheckApiStatus(iree_hal_fence_create_at(semaphore.raw_ptr(), value,
+                                          iree_allocator_system(), &fence),
+                 "creating fence");
+  return HalFence::StealFromRawPtr(fence);
+}
+
+bool HalFence::Query() {
+  iree_status_t status = iree_hal_fence_query(raw_ptr());
+  if (iree_status_is_deferred(status)) {
+    iree_status_ignore(status);
+    return false;
+  }
+  CheckApiStatus(status, "fence failed");
+  return true;
+}
+
+void HalFence::Signal() {
+  CheckApiStatus(iree_hal_fence_signal(raw_ptr()), "signaling fence");
+}
+
+bool HalFence::Wait(std::optional<double> timeout) {
+  iree_timeout_t wait_timeout =
+      timeout ? iree_make_timeout_ns((iree_duration_t)(*timeout * 1e9))
+              : iree_infinite_timeout();
+  iree_status_t status;
+  {
+    py::gil_scoped_release release;
+    status = iree_hal_fence_wait(raw_ptr(), wait_timeout);
+  }
+  if (iree_status_is_deadline_exceeded(status)) {
+    iree_status_ignore(status);
+    return false;
+  }
+  CheckApiStatus(status, "fence failed");
+  return true;
+}
+
+namespace {
+
+// Returns the file descriptor that becomes readable when |primitive| is
+// signaled or -1 if it is not backed by one.
+int GetWaitPrimitiveReadFd(const iree_wait_primitive_t& primitive) {
+  switch (primitive.type) {
+#if defined(IREE_HAVE_WAIT_TYPE_EVENTFD)
+    case IREE_WAIT_PRIMITIVE_TYPE_EVENT_FD:
+      return primitive.value.event.fd;
+#endif  // IREE_HAVE_WAIT_TYPE_EVENTFD
+#if defined(IREE_HAVE_WAIT_TYPE_SYNC_FILE)
+    case IREE_WAIT_PRIMITIVE_TYPE_SYNC_FILE:
+      return primitive.value.sync_file.fd;
+#endif  // IREE_HAVE_WAIT_TYPE_SYNC_FILE
+#if defined(IREE_HAVE_WAIT_TYPE_PIPE)
+    case IREE_WAIT_PRIMITIVE_TYPE_PIPE:
+      return primitive.value.pipe.read_fd;
+#endif  // IREE_HAVE_WAIT_TYPE_PIPE
+    default:
+      return -1;
+  }
+}
+
+}  // namespace
+
+py::list HalFence::ExportWaitHandles() {
+  py::list fds;
+  iree_hal_semaphore_list_t semaphore_list =
+      iree_hal_fence_semaphore_list(raw_ptr());
+  for (iree_host_size_t i = 0; i < semaphore_list.count; ++i) {
+    // Only file descriptor primitives can be registered with Python event
+    // loops so other types are rejected by the implementation.
+    iree_wait_primitive_t primitive;
+    iree_status_t status = iree_hal_semaphore_export_timepoint(
+        semaphore_list.semaphores[i], semaphore_list.payload_values[i],
+        IREE_WAIT_PRIMITIVE_TYPE_ANY, &primitive);
+    if (iree_status_is_ok(status) &&
+        !iree_wait_primitive_is_immediate(primitive) &&
+        GetWaitPrimitiveReadFd(primitive) < 0) {
+      status = iree_make_status(
+          IREE_STATUS_UNAVAILABLE,
+          "semaphore exported wait primitive type %d which is not a file "
+          "descriptor",
+          (int)primitive.type);
+    }
+    if (!iree_status_is_ok(status)) {
+      // Close the handles exported so far as the caller won't receive them.
+      py::module os_module = py::module::import("os");
+      for (py::handle fd : fds) os_module.attr("close")(fd);
+      CheckApiStatus(status, "exporting fence wait handles");
+    }
+    if (iree_wait_primitive_is_immediate(primitive)) continue;
+    fds.append(GetWaitPrimitiveReadFd(primitive));
+  }
+  return fds;
+}
+
 //------------------------------------------------------------------------------
 // HalDriver
 //------------------------------------------------------------------------------
@@ -575,7 +1101,29 @@ void SetupHalBindings(pybind11::module m) {
           },
           py::keep_alive<0, 1>())
       .def("begin_profiling", &HalDevice::BeginProfiling)
-      .def("end_profiling", &HalDevice::EndProfiling);
+      .def("end_profiling", &HalDevice::EndProfiling)
+      .def("create_semaphore", &HalDevice::CreateSemaphore,
+           py::arg("initial_value"), py::keep_alive<0, 1>());
+
+  py::class_<HalSemaphore>(m, "HalSemaphore")
+      .def("query", &HalSemaphore::Query)
+      .def("signal", &HalSemaphore::Signal, py::arg("new_value"));
+
+  auto hal_fence = py::class_<HalFence>(m, "HalFence");
+  VmRef::BindRefProtocol(hal_fence, iree_hal_fence_type_id,
+                         iree_hal_fence_retain_ref, iree_hal_fence_deref,
+                         iree_hal_fence_isa);
+  hal_fence
+      .def_static("create_at", &HalFence::CreateAt, py::arg("semaphore"),
+                  py::arg("value"), py::keep_alive<0, 1>())
+      .def("query", &HalFence::Query)
+      .def("signal", &HalFence::Signal)
+      .def("wait", &HalFence::Wait, py::arg("timeout") = py::none())
+      .def("export_wait_handles", &HalFence::ExportWaitHandles,
+           "Exports a file descriptor for each timepoint of the fence that "
+           "has not yet been reached. Each becomes readable once its "
+           "timepoint is reached or fails (check with query()) and must be "
+           "closed with os.close by the caller.");
 
   py::class_<HalDriver>(m, "HalDriver")
       .def_static("query", &HalDriver::Query)
@@ -653,7 +1201,25 @@ void SetupHalBindings(pybind11::module m) {
            "object. If an element type is specified, wraps in a BufferView "
            "matching the characteristics of the Python buffer. The format is "
            "requested as ND/C-Contiguous, which may incur copies if not "
-           "already in that format.");
+           "already in that format.")
+      .def("import_buffer", &HalAllocator::ImportBuffer,
+           py::arg("memory_type"), py::arg("allowed_usage"), py::arg("buffer"),
+           py::arg("element_type") = py::none(), py::arg("allow_copy") = true,
+           py::keep_alive<0, 1>(),
+           "Wraps the memory of a writable C-contiguous Python buffer object "
+           "in a new buffer without copying. The Python object is kept alive "
+           "until the buffer is released and must not be resized. If the "
+           "allocator cannot import the memory (due to device support or "
+           "alignment) the contents are copied as with allocate_buffer_copy "
+           "when allow_copy is true and an error is raised otherwise. The "
+           "memory_type is only used when copying.")
+      .def("import_dlpack", &HalAllocator::ImportDLPack,
+           py::arg("memory_type"), py::arg("allowed_usage"), py::arg("tensor"),
+           py::arg("allow_copy") = true, py::keep_alive<0, 1>(),
+           "Imports a DLPack capsule or an object implementing __dlpack__ "
+           "(such as a numpy array or torch tensor on the CPU) as a buffer "
+           "view aliasing its memory, with the same fallback behavior as "
+           "import_buffer.");
 
   py::class_<HalBuffer>(m, "HalBuffer")
       .def("fill_zero", &HalBuffer::FillZero, py::arg("byte_offset"),
@@ -684,6 +1250,14 @@ void SetupHalBindings(pybind11::module m) {
           [](HalBufferView& self) {
             return iree_hal_buffer_view_element_type(self.raw_ptr());
           })
+      .def(
+          "__dlpack__",
+          [](HalBufferView& self, py::object stream) {
+            // Host memory needs no stream synchronization.
+            return self.ExportDLPack();
+          },
+          py::arg("stream") = py::none())
+      .def("__dlpack_device__", &HalBufferView::DLPackDevice)
       .def("__repr__", &HalBufferView::Repr);
 
   py::class_<HalMappedMemory>(m, "MappedMemory", py::buffer_protocol())
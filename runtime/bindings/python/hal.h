@@ -76,10 +76,26 @@ struct ApiPtrAdapter<iree_hal_buffer_view_t> {
   }
 };
 
+template <>
+struct ApiPtrAdapter<iree_hal_semaphore_t> {
+  static void Retain(iree_hal_semaphore_t* s) { iree_hal_semaphore_retain(s); }
+  static void Release(iree_hal_semaphore_t* s) {
+    iree_hal_semaphore_release(s);
+  }
+};
+
+template <>
+struct ApiPtrAdapter<iree_hal_fence_t> {
+  static void Retain(iree_hal_fence_t* f) { iree_hal_fence_retain(f); }
+  static void Release(iree_hal_fence_t* f) { iree_hal_fence_release(f); }
+};
+
 //------------------------------------------------------------------------------
 // ApiRefCounted types
 //------------------------------------------------------------------------------
 
+class HalSemaphore;
+
 class HalDevice : public ApiRefCounted<HalDevice, iree_hal_device_t> {
  public:
   iree_hal_allocator_t* allocator() {
@@ -88,6 +104,35 @@ class HalDevice : public ApiRefCounted<HalDevice, iree_hal_device_t> {
 
   void BeginProfiling(const py::kwargs& kwargs);
   void EndProfiling();
+
+  HalSemaphore CreateSemaphore(uint64_t initial_value);
+};
+
+class HalSemaphore : public ApiRefCounted<HalSemaphore, iree_hal_semaphore_t> {
+ public:
+  // Returns the current payload value, raising if the semaphore has failed.
+  uint64_t Query();
+  void Signal(uint64_t new_value);
+};
+
+class HalFence : public ApiRefCounted<HalFence, iree_hal_fence_t> {
+ public:
+  static HalFence CreateAt(HalSemaphore& semaphore, uint64_t value);
+
+  // Returns true if all timepoints have been reached and false if any have not
+  // yet been reached. Raises if any semaphore has failed.
+  bool Query();
+  void Signal();
+
+  // Blocks with the GIL released until the fence is reached or |timeout|
+  // seconds elapse. Returns false if the timeout elapsed and raises if any
+  // semaphore has failed.
+  bool Wait(std::optional<double> timeout);
+
+  // Exports a file descriptor for each timepoint of the fence that has not yet
+  // been reached. Each becomes readable once its timepoint is reached or fails
+  // and is owned by the caller who must close it.
+  py::list ExportWaitHandles();
 };
 
 class HalDriver : public ApiRefCounted<HalDriver, iree_hal_driver_t> {
@@ -110,6 +155,19 @@ class HalAllocator : public ApiRefCounted<HalAllocator, iree_hal_allocator_t> {
   py::object AllocateBufferCopy(
       int memory_type, int allowed_usage, py::object buffer,
       std::optional<iree_hal_element_types_t> element_type);
+
+  // Wraps the memory of a Python buffer object in a HAL buffer without copying
+  // when the allocator is able to import it. Otherwise falls back to
+  // AllocateBufferCopy if |allow_copy| and raises if not.
+  py::object ImportBuffer(int memory_type, int allowed_usage,
+                          py::object buffer,
+                          std::optional<iree_hal_element_types_t> element_type,
+                          bool allow_copy);
+
+  // Imports a DLPack capsule or an object implementing `__dlpack__` as a
+  // buffer view with the same semantics as ImportBuffer.
+  py::object ImportDLPack(int memory_type, int allowed_usage,
+                          py::object tensor, bool allow_copy);
 };
 
 struct HalShape {
@@ -127,6 +185,12 @@ class HalBufferView
     : public ApiRefCounted<HalBufferView, iree_hal_buffer_view_t> {
  public:
   py::str Repr();
+
+  // Exports the buffer view as a DLPack capsule aliasing its memory. Only
+  // buffers that can be mapped by the host are supported.
+  py::capsule ExportDLPack();
+  // Returns the DLPack (device_type, device_id) of ExportDLPack results.
+  py::tuple DLPackDevice();
 };
 
 class HalBuffer : public ApiRefCounted<HalBuffer, iree_hal_buffer_t> {
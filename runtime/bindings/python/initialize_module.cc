@@ -11,6 +11,8 @@
 #include "./status_utils.h"
 #include "./vm.h"
 #include "iree/base/internal/flags.h"
+#include "iree/base/internal/metrics.h"
+#include "iree/base/internal/sampling_tracer.h"
 #include "iree/hal/drivers/init.h"
 
 namespace iree {
@@ -45,6 +47,46 @@ PYBIND11_MODULE(_runtime, m) {
                                     &argc, &argv),
                    "Error parsing flags");
   });
+
+  m.def(
+      "get_metrics_prometheus",
+      []() {
+        iree_string_builder_t builder;
+        iree_string_builder_initialize(iree_allocator_system(), &builder);
+        iree_status_t status = iree_metrics_append_prometheus(&builder);
+        std::string text(iree_string_builder_buffer(&builder),
+                         iree_string_builder_size(&builder));
+        iree_string_builder_deinitialize(&builder);
+        CheckApiStatus(status, "Error formatting metrics");
+        return text;
+      },
+      "Returns all runtime metrics recorded so far in the Prometheus text "
+      "exposition format.");
+
+  m.def(
+      "set_trace_sample_rate",
+      [](uint32_t one_in_n) { iree_sampling_tracer_set_rate(one_in_n); },
+      py::arg("one_in_n"),
+      "Traces one in every `one_in_n` invocations on each thread; 0 disables "
+      "sampled tracing.");
+  m.def(
+      "reset_sampled_trace", []() { iree_sampling_tracer_reset(); },
+      "Discards all sampled trace events.");
+  m.def(
+      "get_sampled_trace_json",
+      []() {
+        iree_string_builder_t builder;
+        iree_string_builder_initialize(iree_allocator_system(), &builder);
+        iree_status_t status =
+            iree_sampling_tracer_append_chrome_json(&builder);
+        std::string json(iree_string_builder_buffer(&builder),
+                         iree_string_builder_size(&builder));
+        iree_string_builder_deinitialize(&builder);
+        CheckApiStatus(status, "Error formatting sampled trace");
+        return json;
+      },
+      "Returns the most recent sampled trace events as Chrome trace event "
+      "JSON (loadable in chrome://tracing and Perfetto).");
 }
 
 }  // namespace python
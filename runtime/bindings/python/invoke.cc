@@ -30,13 +30,120 @@ class InvokeContext {
     return HalAllocator::BorrowFromRawPtr(device().allocator());
   }
 
+  // Returns the device as a Python object, created on first use and shared
+  // by all results of the invocation.
+  py::object &py_device() {
+    if (!py_device_) {
+      py_device_ = py::cast(HalDevice::BorrowFromRawPtr(device().raw_ptr()),
+                            py::return_value_policy::move);
+    }
+    return *py_device_;
+  }
+
+  // Records the ready fence of an argument (or None) that must be reached
+  // before the invocation may access its contents.
+  void AddWaitFence(py::handle fence) {
+    if (fence.is_none()) return;
+    wait_fences_.push_back(
+        HalFence::BorrowFromRawPtr(py::cast<HalFence *>(fence)->raw_ptr()));
+  }
+  std::vector<HalFence> &wait_fences() { return wait_fences_; }
+
+  // Fence that is reached once the contents of results are available, or None
+  // if they are available immediately.
+  py::object &ready_fence() { return ready_fence_; }
+  void set_ready_fence(py::object fence) { ready_fence_ = std::move(fence); }
+
  private:
   HalDevice device_;
+  std::optional<py::object> py_device_;
+  std::vector<HalFence> wait_fences_;
+  py::object ready_fence_ = py::none();
 };
 
 using PackCallback =
     std::function<void(InvokeContext &, iree_vm_list_t *, py::handle)>;
 
+// Converts the element at an index of a list to a Python value.
+using UnpackCallback = std::function<py::object(InvokeContext &,
+                                                iree_vm_list_t *,
+                                                iree_host_size_t)>;
+
+// Converts the entire contents of a list to a Python value.
+using UnpackListCallback =
+    std::function<py::object(InvokeContext &, iree_vm_list_t *)>;
+
+// Returns the list stored at |index| of |list| without retaining it.
+iree_vm_list_t *GetListElementAsList(iree_vm_list_t *list,
+                                     iree_host_size_t index) {
+  iree_vm_ref_t ref = {0};
+  CheckApiStatus(iree_vm_list_get_ref_assign(list, index, &ref),
+                 "could not access list element");
+  iree_vm_list_t *sub_list = nullptr;
+  CheckApiStatus(iree_vm_list_check_deref(ref, &sub_list),
+                 "could not deref list (wrong type?)");
+  return sub_list;
+}
+
+// Returns the buffer view stored at |index| of |list| without retaining it.
+iree_hal_buffer_view_t *GetListElementAsBufferView(iree_vm_list_t *list,
+                                                   iree_host_size_t index) {
+  iree_vm_ref_t ref = {0};
+  CheckApiStatus(iree_vm_list_get_ref_assign(list, index, &ref),
+                 "could not access list element");
+  iree_hal_buffer_view_t *buffer_view = nullptr;
+  CheckApiStatus(iree_hal_buffer_view_check_deref(ref, &buffer_view),
+                 "could not deref buffer view (wrong type?)");
+  return buffer_view;
+}
+
+// Returns the primitive value stored at |index| of |list| as a Python int or
+// float depending on |is_float|.
+py::object GetListElementAsScalar(iree_vm_list_t *list, iree_host_size_t index,
+                                  bool is_float) {
+  iree_vm_variant_t v = iree_vm_variant_empty();
+  CheckApiStatus(iree_vm_list_get_variant(list, index, &v),
+                 "could not access list element");
+  if (iree_vm_type_def_is_value(&v.type)) {
+    switch (v.type.value_type) {
+      case IREE_VM_VALUE_TYPE_I8:
+        if (!is_float) return py::int_(v.i8);
+        break;
+      case IREE_VM_VALUE_TYPE_I16:
+        if (!is_float) return py::int_(v.i16);
+        break;
+      case IREE_VM_VALUE_TYPE_I32:
+        if (!is_float) return py::int_(v.i32);
+        break;
+      case IREE_VM_VALUE_TYPE_I64:
+        if (!is_float) return py::int_(v.i64);
+        break;
+      case IREE_VM_VALUE_TYPE_F32:
+        if (is_float) return py::float_(v.f32);
+        break;
+      case IREE_VM_VALUE_TYPE_F64:
+        if (is_float) return py::float_(v.f64);
+        break;
+      default:
+        break;
+    }
+  }
+  throw std::invalid_argument(is_float ? "expected a float value"
+                                       : "expected an int value");
+}
+
+// Throws if |list| does not have exactly |expected_size| elements.
+void CheckListArity(iree_vm_list_t *list, size_t expected_size) {
+  iree_host_size_t size = iree_vm_list_size(list);
+  if (size != expected_size) {
+    std::string msg("mismatched return arity: ");
+    msg.append(std::to_string(size));
+    msg.append(" vs ");
+    msg.append(std::to_string(expected_size));
+    throw std::invalid_argument(std::move(msg));
+  }
+}
+
 class InvokeStatics {
  public:
   ~InvokeStatics() {
@@ -49,6 +156,7 @@ class InvokeStatics {
   py::str kSlistTag = py::str("slist");
   py::str kStupleTag = py::str("stuple");
   py::str kSdictTag = py::str("sdict");
+  py::str kPyHomogeneousListTag = py::str("py_homogeneous_list");
 
   py::int_ kZero = py::int_(0);
   py::int_ kOne = py::int_(1);
@@ -60,6 +168,8 @@ class InvokeStatics {
   py::str kDtypeAttr = py::str("dtype");
 
   // Primitive type names.
+  py::str kBF16 = py::str("bf16");
+  py::str kF16 = py::str("f16");
   py::str kF32 = py::str("f32");
   py::str kF64 = py::str("f64");
   py::str kI1 = py::str("i1");
@@ -73,6 +183,8 @@ class InvokeStatics {
 
   // Attribute names.
   py::str kAttrBufferView = py::str("_buffer_view");
+  py::str kAttrInvoke = py::str("invoke");
+  py::str kAttrReadyFence = py::str("_ready_fence");
 
   // Module 'numpy'.
   py::module &numpy_module() { return numpy_module_; }
@@ -112,14 +224,21 @@ class InvokeStatics {
   }
 
   enum iree_hal_element_types_t MapDtypeToElementType(py::object dtype) {
-    // TODO: Consider porting this from a py func to C++ as it can be on
-    // the critical path.
+    // Mappings are cached as this is on the critical path of packing host
+    // arrays and only the first lookup of each dtype goes through Python.
+    PyObject *cached_element_type =
+        PyDict_GetItem(dtype_to_element_type_.ptr(), dtype.ptr());
+    if (cached_element_type) {
+      return py::cast<enum iree_hal_element_types_t>(
+          py::handle(cached_element_type));
+    }
     try {
       py::object element_type =
           array_interop_module().attr(kMapDtypeToElementTypeAttr)(dtype);
       if (element_type.is_none()) {
         throw std::invalid_argument("mapping not found");
       }
+      dtype_to_element_type_[dtype] = element_type;
       return py::cast<enum iree_hal_element_types_t>(element_type);
     } catch (std::exception &e) {
       std::string msg("could not map dtype ");
@@ -171,6 +290,7 @@ class InvokeStatics {
             // correct.
             IREE_TRACE_SCOPE0("PackDeviceArray");
             bv = py::cast<HalBufferView *>(py_value.attr(kAttrBufferView));
+            c.AddWaitFence(py_value.attr(kAttrReadyFence));
           } else if (py::isinstance(py_value, hal_buffer_view_type())) {
             // Short-circuit: If a HalBufferView is provided directly.
             IREE_TRACE_SCOPE0("PackBufferView");
@@ -193,10 +313,11 @@ class InvokeStatics {
               throw std::invalid_argument(std::move(msg));
             }
 
-            retained_bv = c.allocator().AllocateBufferCopy(
+            // Aliases the host array memory when the device can use it.
+            retained_bv = c.allocator().ImportBuffer(
                 IREE_HAL_MEMORY_TYPE_DEVICE_LOCAL,
                 IREE_HAL_BUFFER_USAGE_DEFAULT | IREE_HAL_BUFFER_USAGE_MAPPING,
-                host_array, hal_element_type);
+                host_array, hal_element_type, /*allow_copy=*/true);
             bv = py::cast<HalBufferView *>(retained_bv);
           }
 
@@ -377,6 +498,160 @@ class InvokeStatics {
     return found_it->second;
   }
 
+  // Wraps |buffer_view| in a DeviceArray that transfers to the host on access
+  // once the ready fence of |c| is reached. If |dtype| is not None the host
+  // array is converted to it.
+  py::object CreateDeviceArray(InvokeContext &c,
+                               iree_hal_buffer_view_t *buffer_view,
+                               py::handle dtype) {
+    py::object py_buffer_view =
+        py::cast(HalBufferView::BorrowFromRawPtr(buffer_view),
+                 py::return_value_policy::move);
+    return device_array_type()(c.py_device(), py_buffer_view,
+                               py::arg("implicit_host_transfer") = true,
+                               py::arg("override_dtype") = dtype,
+                               py::arg("ready_fence") = c.ready_fence());
+  }
+
+  // Given an ABI desc of a sequence type (slist, stuple, sdict or
+  // py_homogeneous_list), return a callback that converts an entire VM list
+  // to the corresponding Python value. Returns an empty callback for other
+  // types.
+  UnpackListCallback AbiTypeToUnpackListCallback(py::handle desc) {
+    if (!py::isinstance<py::list>(desc)) return {};
+    py::object compound_type = desc[kZero];
+    if (compound_type.equal(kSlistTag) || compound_type.equal(kStupleTag)) {
+      // The descriptor for an slist or stuple is like:
+      //   ['slist', item1, ...]
+      bool is_tuple = compound_type.equal(kStupleTag);
+      std::vector<UnpackCallback> sub_unpackers(py::len(desc) - 1);
+      for (size_t i = 0; i < sub_unpackers.size(); ++i) {
+        sub_unpackers[i] = AbiTypeToUnpackCallback(desc[py::int_(i + 1)]);
+      }
+      return [is_tuple, sub_unpackers = std::move(sub_unpackers)](
+                 InvokeContext &c, iree_vm_list_t *list) -> py::object {
+        CheckListArity(list, sub_unpackers.size());
+        if (is_tuple) {
+          py::tuple items(sub_unpackers.size());
+          for (size_t i = 0; i < sub_unpackers.size(); ++i) {
+            items[i] = sub_unpackers[i](c, list, i);
+          }
+          return std::move(items);
+        }
+        py::list items(sub_unpackers.size());
+        for (size_t i = 0; i < sub_unpackers.size(); ++i) {
+          items[i] = sub_unpackers[i](c, list, i);
+        }
+        return std::move(items);
+      };
+    } else if (compound_type.equal(kSdictTag)) {
+      // The descriptor for an sdict is like:
+      //   ['sdict', ['key1', value1], ...]
+      std::vector<std::pair<py::object, UnpackCallback>> sub_unpackers(
+          py::len(desc) - 1);
+      for (size_t i = 0; i < sub_unpackers.size(); ++i) {
+        py::object sub_desc = desc[py::int_(i + 1)];
+        sub_unpackers[i] = std::make_pair(
+            sub_desc[kZero], AbiTypeToUnpackCallback(sub_desc[kOne]));
+      }
+      return [sub_unpackers = std::move(sub_unpackers)](
+                 InvokeContext &c, iree_vm_list_t *list) -> py::object {
+        CheckListArity(list, sub_unpackers.size());
+        py::dict items;
+        for (size_t i = 0; i < sub_unpackers.size(); ++i) {
+          items[sub_unpackers[i].first] = sub_unpackers[i].second(c, list, i);
+        }
+        return std::move(items);
+      };
+    } else if (compound_type.equal(kPyHomogeneousListTag)) {
+      // The descriptor for a py_homogeneous_list is like:
+      //   ['py_homogeneous_list', element_type]
+      UnpackCallback element_unpacker = AbiTypeToUnpackCallback(desc[kOne]);
+      return [element_unpacker = std::move(element_unpacker)](
+                 InvokeContext &c, iree_vm_list_t *list) -> py::object {
+        iree_host_size_t size = iree_vm_list_size(list);
+        py::list items(size);
+        for (iree_host_size_t i = 0; i < size; ++i) {
+          items[i] = element_unpacker(c, list, i);
+        }
+        return std::move(items);
+      };
+    }
+    return {};
+  }
+
+  // Given an ABI desc, return a callback that converts a corresponding list
+  // element to a Python value. Descriptors that cannot be mapped produce a
+  // callback that fails when invoked so that functions with unsupported
+  // results can still be called for their side effects.
+  UnpackCallback AbiTypeToUnpackCallback(py::handle desc) {
+    if (UnpackListCallback list_unpacker = AbiTypeToUnpackListCallback(desc)) {
+      return [list_unpacker = std::move(list_unpacker)](
+                 InvokeContext &c, iree_vm_list_t *list,
+                 iree_host_size_t index) {
+        return list_unpacker(c, GetListElementAsList(list, index));
+      };
+    }
+
+    std::string error;
+    if (py::isinstance<py::list>(desc)) {
+      py::object compound_type = desc[kZero];
+      if (compound_type.equal(kNdarray)) {
+        // The descriptor for an ndarray is like:
+        //   ["ndarray", "f32", rank, dim0, ...]
+        py::object abi_type = desc[kOne];
+        try {
+          py::object target_dtype = MapElementAbiTypeToDtype(abi_type);
+          return [this, target_dtype = std::move(target_dtype)](
+                     InvokeContext &c, iree_vm_list_t *list,
+                     iree_host_size_t index) {
+            IREE_TRACE_SCOPE0("ResultUnpacker::ReflectionNdarray");
+            return CreateDeviceArray(
+                c, GetListElementAsBufferView(list, index), target_dtype);
+          };
+        } catch (std::exception &e) {
+          error = e.what();
+        }
+      } else {
+        error = "cannot map VM type to Python: ";
+        error.append(py::cast<std::string>(py::str(compound_type)));
+      }
+    } else {
+      py::str prim_type = py::cast<py::str>(desc);
+      bool is_int = prim_type.equal(kI8) || prim_type.equal(kI16) ||
+                    prim_type.equal(kI32) || prim_type.equal(kI64);
+      bool is_float = prim_type.equal(kF16) || prim_type.equal(kF32) ||
+                      prim_type.equal(kF64) || prim_type.equal(kBF16);
+      if (is_int || is_float) {
+        return [is_float](InvokeContext &c, iree_vm_list_t *list,
+                          iree_host_size_t index) {
+          return GetListElementAsScalar(list, index, is_float);
+        };
+      }
+      error = "cannot map VM type to Python: ";
+      error.append(py::cast<std::string>(prim_type));
+    }
+    return [error = std::move(error)](InvokeContext &c, iree_vm_list_t *list,
+                                      iree_host_size_t index) -> py::object {
+      throw std::invalid_argument(error);
+    };
+  }
+
+  // Converts the element at |index| of |list| to a Python value without
+  // reflection metadata. Buffer views are upgraded to DeviceArrays and other
+  // values are returned as by VmVariantList.get_variant().
+  py::object UnpackDynamic(InvokeContext &c, iree_vm_list_t *list,
+                           iree_host_size_t index) {
+    iree_vm_variant_t v = iree_vm_variant_empty();
+    CheckApiStatus(iree_vm_list_get_variant(list, index, &v),
+                   "could not access list element");
+    if (iree_vm_variant_is_ref(v) && iree_hal_buffer_view_isa(v.ref)) {
+      return CreateDeviceArray(c, iree_hal_buffer_view_deref(v.ref),
+                               py::none());
+    }
+    return VmVariantList::BorrowFromRawPtr(list).GetVariant(index);
+  }
+
  private:
   PackCallback GetGenericPackCallbackForNdarray() {
     return [this](InvokeContext &c, iree_vm_list_t *list, py::handle py_value) {
@@ -397,11 +672,11 @@ class InvokeStatics {
       auto hal_element_type =
           MapDtypeToElementType(host_array.attr(kDtypeAttr));
 
-      // Put it on the device.
-      py::object retained_bv = c.allocator().AllocateBufferCopy(
+      // Put it on the device, aliasing the host array memory when possible.
+      py::object retained_bv = c.allocator().ImportBuffer(
           IREE_HAL_MEMORY_TYPE_DEVICE_LOCAL,
           IREE_HAL_BUFFER_USAGE_DEFAULT | IREE_HAL_BUFFER_USAGE_MAPPING,
-          host_array, hal_element_type);
+          host_array, hal_element_type, /*allow_copy=*/true);
       HalBufferView *bv = py::cast<HalBufferView *>(retained_bv);
 
       // TODO: If adding further manipulation here, please make this common
@@ -503,6 +778,7 @@ class InvokeStatics {
         [this](InvokeContext &c, iree_vm_list_t *list, py::handle py_value) {
           HalBufferView *bv =
               py::cast<HalBufferView *>(py_value.attr(kAttrBufferView));
+          c.AddWaitFence(py_value.attr(kAttrReadyFence));
           iree_vm_ref_t buffer_view_ref =
               iree_hal_buffer_view_retain_ref(bv->raw_ptr());
           CheckApiStatus(iree_vm_list_push_ref_move(list, &buffer_view_ref),
@@ -542,6 +818,9 @@ class InvokeStatics {
 
   // Dict of str (ABI dtype like 'f32') to numpy dtype.
   py::dict abi_type_to_dtype_ = BuildAbiTypeToDtype();
+
+  // Dict of numpy dtype to HalElementType populated on first use of each.
+  py::dict dtype_to_element_type_;
 };
 
 /// Object that can pack Python arguments into a VM List for a specific
@@ -692,6 +971,297 @@ class ArgumentPacker {
   bool dynamic_dispatch_ = false;
 };
 
+/// Object that can unpack the VM results of a specific function into Python
+/// values.
+class ResultUnpacker {
+ public:
+  ResultUnpacker(InvokeStatics &statics, std::optional<py::list> ret_descs)
+      : statics_(statics) {
+    IREE_TRACE_SCOPE0("ResultUnpacker::Init");
+    if (!ret_descs) {
+      dynamic_dispatch_ = true;
+      return;
+    }
+    ret_descs_ = *ret_descs;
+
+    // Results that are a single slist/stuple/sdict are inlined into the
+    // function's results and the entire result list is the value.
+    if (py::len(ret_descs_) == 1) {
+      py::object desc = ret_descs_[0];
+      if (py::isinstance<py::list>(desc)) {
+        py::object compound_type = desc[statics.kZero];
+        if (compound_type.equal(statics.kSlistTag) ||
+            compound_type.equal(statics.kStupleTag) ||
+            compound_type.equal(statics.kSdictTag)) {
+          inlined_unpacker_ = statics.AbiTypeToUnpackListCallback(desc);
+          return;
+        }
+      }
+    }
+
+    for (py::handle desc : ret_descs_) {
+      flat_ret_unpackers_.push_back(statics.AbiTypeToUnpackCallback(desc));
+    }
+  }
+
+  /// Returns the initial capacity of result lists.
+  iree_host_size_t capacity() const {
+    return dynamic_dispatch_ ? 1 : py::len(ret_descs_);
+  }
+
+  /// Unpacks |ret_list| and returns None, a single value or a tuple of values
+  /// depending on the number of results.
+  py::object Unpack(InvokeContext &invoke_context, VmVariantList &ret_list) {
+    IREE_TRACE_SCOPE0("ResultUnpacker::Unpack");
+    iree_vm_list_t *list = ret_list.raw_ptr();
+    if (inlined_unpacker_) {
+      try {
+        return inlined_unpacker_(invoke_context, list);
+      } catch (std::exception &e) {
+        throw MakeReturnError(e, ret_list, 0);
+      }
+    }
+
+    iree_host_size_t arity = ret_list.size();
+    if (!dynamic_dispatch_ && arity != flat_ret_unpackers_.size()) {
+      try {
+        CheckListArity(list, flat_ret_unpackers_.size());
+      } catch (std::exception &e) {
+        throw MakeReturnError(e, ret_list, 0);
+      }
+    }
+    if (arity == 0) return py::none();
+    if (arity == 1) return UnpackResult(invoke_context, ret_list, 0);
+    py::tuple results(arity);
+    for (iree_host_size_t i = 0; i < arity; ++i) {
+      results[i] = UnpackResult(invoke_context, ret_list, i);
+    }
+    return std::move(results);
+  }
+
+ private:
+  py::object UnpackResult(InvokeContext &invoke_context,
+                          VmVariantList &ret_list, iree_host_size_t index) {
+    try {
+      if (dynamic_dispatch_) {
+        return statics_.UnpackDynamic(invoke_context, ret_list.raw_ptr(),
+                                      index);
+      }
+      return flat_ret_unpackers_[index](invoke_context, ret_list.raw_ptr(),
+                                        index);
+    } catch (std::exception &e) {
+      throw MakeReturnError(e, ret_list, index);
+    }
+  }
+
+  // Returns an error describing the failure |e| to unpack the result |index|.
+  std::invalid_argument MakeReturnError(std::exception &e,
+                                        VmVariantList &ret_list,
+                                        iree_host_size_t index) {
+    std::string msg("Error processing function return: ");
+    msg.append(e.what());
+    msg.append(" (while decoding return ");
+    msg.append(std::to_string(index));
+    msg.append("@");
+    msg.append(ret_list.DebugString());
+    if (!dynamic_dispatch_) {
+      msg.append(" with description ");
+      py::object desc = ret_descs_[inlined_unpacker_ ? 0 : index];
+      msg.append(py::cast<std::string>(py::repr(desc)));
+    }
+    msg.append(")");
+    return std::invalid_argument(std::move(msg));
+  }
+
+  InvokeStatics &statics_;
+
+  py::list ret_descs_;
+
+  // Set if the results are a single sequence inlined into the result list.
+  UnpackListCallback inlined_unpacker_;
+
+  std::vector<UnpackCallback> flat_ret_unpackers_;
+
+  // If true, then there is no dispatch metadata and we process fully
+  // dynamically.
+  bool dynamic_dispatch_ = false;
+};
+
+/// Invokes a specific function with Python arguments and results. The
+/// reflection metadata of the function is compiled into an ArgumentPacker and
+/// ResultUnpacker once such that calls only marshal values.
+///
+/// Functions using the coarse-fences ABI take a (wait, signal) fence pair
+/// after their arguments. The wait fence is joined from the ready fences of
+/// DeviceArray arguments and a new signal fence is created for each call that
+/// either is waited on before returning (Call) or is attached to the results
+/// (Submit) such that work from multiple invocations can overlap.
+class FunctionInvoker {
+ public:
+  FunctionInvoker(InvokeStatics &statics, HalDevice &device,
+                  py::object vm_context, py::object vm_function,
+                  std::optional<py::list> arg_descs,
+                  std::optional<py::list> ret_descs, bool coarse_fences)
+      : statics_(statics),
+        device_(device),
+        arg_packer_(statics, std::move(arg_descs)),
+        result_unpacker_(statics, std::move(ret_descs)),
+        py_vm_context_(std::move(vm_context)),
+        py_vm_function_(std::move(vm_function)),
+        coarse_fences_(coarse_fences) {
+    // Contexts and functions from the bindings are invoked directly. Anything
+    // else (such as a mock) is invoked through its Python `invoke` method.
+    if (py::isinstance<VmContext>(py_vm_context_) &&
+        py::isinstance<iree_vm_function_t>(py_vm_function_)) {
+      vm_context_ = py::cast<VmContext *>(py_vm_context_);
+      vm_function_ = py::cast<iree_vm_function_t>(py_vm_function_);
+    }
+  }
+
+  /// Packs |pos_args| and |kw_args|, invokes the function and returns its
+  /// unpacked results once they are ready.
+  py::object Call(py::sequence pos_args, py::dict kw_args) {
+    IREE_TRACE_SCOPE0("FunctionInvoker::Call");
+    InvokeContext invoke_context(device_);
+    VmVariantList arg_list = arg_packer_.Pack(
+        invoke_context, std::move(pos_args), std::move(kw_args));
+    VmVariantList ret_list = InvokeAndWait(invoke_context, arg_list);
+    return result_unpacker_.Unpack(invoke_context, ret_list);
+  }
+
+  /// Packs |pos_args| and |kw_args| and invokes the function without waiting
+  /// for asynchronous work to complete. Returns a tuple of the unpacked
+  /// results, whose DeviceArrays wait for the work on access, and the fence
+  /// reached when it completes (or None for synchronous functions).
+  py::tuple Submit(py::sequence pos_args, py::dict kw_args) {
+    IREE_TRACE_SCOPE0("FunctionInvoker::Submit");
+    InvokeContext invoke_context(device_);
+    VmVariantList arg_list = arg_packer_.Pack(
+        invoke_context, std::move(pos_args), std::move(kw_args));
+    if (!coarse_fences_) {
+      VmVariantList ret_list = InvokeAndWait(invoke_context, arg_list);
+      return py::make_tuple(
+          result_unpacker_.Unpack(invoke_context, ret_list), py::none());
+    }
+    py::object signal_fence = py::cast(
+        AppendFences(invoke_context, arg_list), py::return_value_policy::move);
+    VmVariantList ret_list = Invoke(arg_list);
+    invoke_context.set_ready_fence(signal_fence);
+    return py::make_tuple(result_unpacker_.Unpack(invoke_context, ret_list),
+                          signal_fence);
+  }
+
+  /// Packs |pos_args| and |kw_args| into an argument list for InvokeList.
+  /// As the argument list is used by a separate invocation the ready fences
+  /// of DeviceArray arguments are waited on before returning.
+  VmVariantList Pack(py::sequence pos_args, py::dict kw_args) {
+    InvokeContext invoke_context(device_);
+    VmVariantList arg_list = arg_packer_.Pack(
+        invoke_context, std::move(pos_args), std::move(kw_args));
+    for (HalFence &fence : invoke_context.wait_fences()) {
+      fence.Wait(std::nullopt);
+    }
+    return arg_list;
+  }
+
+  /// Invokes the function with the user arguments in |arg_list| as returned by
+  /// Pack and returns the result list once the results are ready.
+  VmVariantList InvokeList(VmVariantList &arg_list) {
+    InvokeContext invoke_context(device_);
+    return InvokeAndWait(invoke_context, arg_list);
+  }
+
+  /// Unpacks the result list |ret_list| as returned by InvokeList.
+  py::object Unpack(VmVariantList &ret_list) {
+    InvokeContext invoke_context(device_);
+    return result_unpacker_.Unpack(invoke_context, ret_list);
+  }
+
+ private:
+  // Appends the coarse-fences ABI (wait, signal) fences to |arg_list| and
+  // returns the signal fence.
+  HalFence AppendFences(InvokeContext &invoke_context,
+                        VmVariantList &arg_list) {
+    std::vector<HalFence> &wait_fences = invoke_context.wait_fences();
+    if (wait_fences.empty()) {
+      arg_list.AppendNullRef();
+    } else {
+      std::vector<iree_hal_fence_t *> raw_wait_fences(wait_fences.size());
+      for (size_t i = 0; i < wait_fences.size(); ++i) {
+        raw_wait_fences[i] = wait_fences[i].raw_ptr();
+      }
+      iree_hal_fence_t *wait_fence = nullptr;
+      CheckApiStatus(iree_hal_fence_join(raw_wait_fences.size(),
+                                         raw_wait_fences.data(),
+                                         iree_allocator_system(), &wait_fence),
+                     "could not join argument fences");
+      iree_vm_ref_t wait_fence_ref = iree_hal_fence_move_ref(wait_fence);
+      CheckApiStatus(iree_vm_list_push_ref_move(arg_list.raw_ptr(),
+                                                &wait_fence_ref),
+                     "could not push wait fence to list");
+    }
+
+    HalSemaphore semaphore = device_.CreateSemaphore(0ull);
+    HalFence signal_fence = HalFence::CreateAt(semaphore, 1ull);
+    iree_vm_ref_t signal_fence_ref =
+        iree_hal_fence_retain_ref(signal_fence.raw_ptr());
+    CheckApiStatus(
+        iree_vm_list_push_ref_move(arg_list.raw_ptr(), &signal_fence_ref),
+        "could not push signal fence to list");
+    return signal_fence;
+  }
+
+  // Invokes the function and waits for asynchronous work to complete.
+  VmVariantList InvokeAndWait(InvokeContext &invoke_context,
+                              VmVariantList &arg_list) {
+    if (!coarse_fences_) {
+      // Synchronous functions access their arguments immediately.
+      for (HalFence &fence : invoke_context.wait_fences()) {
+        fence.Wait(std::nullopt);
+      }
+      return Invoke(arg_list);
+    }
+    HalFence signal_fence = AppendFences(invoke_context, arg_list);
+    VmVariantList ret_list = Invoke(arg_list);
+    signal_fence.Wait(std::nullopt);
+    return ret_list;
+  }
+
+  // Invokes the function with |arg_list| and returns the result list. The GIL
+  // is released for the duration of native invocations.
+  VmVariantList Invoke(VmVariantList &arg_list) {
+    VmVariantList ret_list =
+        VmVariantList::Create(result_unpacker_.capacity());
+    if (vm_context_) {
+      vm_context_->Invoke(vm_function_, arg_list, ret_list);
+    } else {
+      py_vm_context_.attr(statics_.kAttrInvoke)(
+          py_vm_function_,
+          py::cast(VmVariantList::BorrowFromRawPtr(arg_list.raw_ptr()),
+                   py::return_value_policy::move),
+          py::cast(VmVariantList::BorrowFromRawPtr(ret_list.raw_ptr()),
+                   py::return_value_policy::move));
+    }
+    return ret_list;
+  }
+
+  InvokeStatics &statics_;
+  HalDevice device_;
+  ArgumentPacker arg_packer_;
+  ResultUnpacker result_unpacker_;
+
+  // Retained Python objects the function was created with.
+  py::object py_vm_context_;
+  py::object py_vm_function_;
+
+  // Set when the context is a VmContext that can be invoked natively.
+  VmContext *vm_context_ = nullptr;
+  iree_vm_function_t vm_function_ = {};
+
+  // Whether the function uses the coarse-fences ABI.
+  bool coarse_fences_;
+};
+
 }  // namespace
 
 void SetupInvokeBindings(pybind11::module &m) {
@@ -700,6 +1270,14 @@ void SetupInvokeBindings(pybind11::module &m) {
   py::class_<ArgumentPacker>(m, "ArgumentPacker")
       .def(py::init<InvokeStatics &, std::optional<py::list>>())
       .def("pack", &ArgumentPacker::Pack);
+  py::class_<FunctionInvoker>(m, "_FunctionInvoker")
+      .def(py::init<InvokeStatics &, HalDevice &, py::object, py::object,
+                    std::optional<py::list>, std::optional<py::list>, bool>())
+      .def("__call__", &FunctionInvoker::Call)
+      .def("submit", &FunctionInvoker::Submit)
+      .def("pack", &FunctionInvoker::Pack)
+      .def("invoke", &FunctionInvoker::InvokeList)
+      .def("unpack", &FunctionInvoker::Unpack);
 
   m.attr("_invoke_statics") = py::cast(InvokeStatics());
 }
@@ -23,6 +23,8 @@ from ._binding import (
     HalDevice,
     HalDriver,
     HalElementType,
+    HalFence,
+    HalSemaphore,
     MemoryAccess,
     MemoryType,
     PyModuleInterface,
@@ -41,6 +43,7 @@ from ._binding import (
     VmModule,
 )
 
+from .aio import *
 from .array_interop import *
 from .benchmark import *
 from .system_api import *
@@ -51,6 +54,7 @@ from .system_setup import (
     query_available_drivers,
 )
 from .function import *
+from .metrics import *
 from .tracing import *
 
 from . import flags
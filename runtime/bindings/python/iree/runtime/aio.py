@@ -0,0 +1,64 @@
+# Copyright 2023 The IREE Authors
+#
+# Licensed under the Apache License v2.0 with LLVM Exceptions.
+# See https://llvm.org/LICENSE.txt for license information.
+# SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+"""asyncio integration for HAL fences."""
+
+import asyncio
+import functools
+import os
+
+from ._binding import HalFence
+
+__all__ = [
+    "await_fence",
+]
+
+
+async def await_fence(fence: HalFence):
+  """Waits for `fence` to be reached without blocking the running event loop.
+
+  The fence timepoints are exported as file descriptors and registered with
+  the event loop so no threads are involved. Event loops that cannot wait on
+  file descriptors and devices that cannot export timepoints fall back to
+  waiting in the default executor.
+
+  Raises if any semaphore of the fence failed.
+  """
+  if fence.query():
+    return
+  loop = asyncio.get_running_loop()
+  try:
+    fds = fence.export_wait_handles()
+  except RuntimeError:
+    await loop.run_in_executor(None, fence.wait)
+    return
+
+  try:
+    futures = []
+    for fd in fds:
+      future = loop.create_future()
+      loop.add_reader(fd, functools.partial(_on_readable, loop, fd, future))
+      futures.append(future)
+    await asyncio.gather(*futures)
+  except NotImplementedError:
+    # Loops such as the Windows proactor do not support add_reader.
+    await loop.run_in_executor(None, fence.wait)
+  finally:
+    for fd in fds:
+      try:
+        loop.remove_reader(fd)
+      except NotImplementedError:
+        pass
+      os.close(fd)
+
+  # Raises if the fence was reached due to a failure.
+  fence.query()
+
+
+def _on_readable(loop, fd, future):
+  # Exported handles remain readable once signaled so stop watching them.
+  loop.remove_reader(fd)
+  if not future.done():
+    future.set_result(None)
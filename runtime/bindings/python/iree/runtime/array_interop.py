@@ -15,15 +15,23 @@ from ._binding import (
     HalBufferView,
     HalDevice,
     HalElementType,
+    HalFence,
     MappedMemory,
     MemoryType,
 )
+from . import aio
 
 __all__ = [
     "asdevicearray",
     "DeviceArray",
+    "empty_aligned",
+    "from_dlpack",
 ]
 
+# Alignment of host memory required for it to be imported without a copy by
+# local (CPU) devices. Matches IREE_HAL_HEAP_BUFFER_ALIGNMENT.
+_HOST_IMPORT_ALIGNMENT = 64
+
 _DEVICE_HANDLED_FUNCTIONS = {}
 
 
@@ -64,11 +72,15 @@ class DeviceArray(numpy.lib.mixins.NDArrayOperatorsMixin):
                device: HalDevice,
                buffer_view: HalBufferView,
                implicit_host_transfer: bool = False,
-               override_dtype=None):
+               override_dtype=None,
+               ready_fence: Optional[HalFence] = None):
     self._device = device
     self._buffer_view = buffer_view
     self._implicit_host_transfer = implicit_host_transfer
     self._override_dtype = override_dtype
+    # Fence reached once the contents of the array are available or None if
+    # they already are.
+    self._ready_fence = ready_fence
 
     # If the array is host accessible, these will be non-None.
     self._mapped_memory: Optional[MappedMemory] = None
@@ -93,6 +105,45 @@ class DeviceArray(numpy.lib.mixins.NDArrayOperatorsMixin):
   def __repr__(self):
     return f"<IREE DeviceArray: shape={np.shape(self)}, dtype={self.dtype}>"
 
+  def __await__(self):
+    """Waits without blocking the event loop until the contents are ready."""
+    return self._await_ready().__await__()
+
+  async def _await_ready(self):
+    if self._ready_fence is not None:
+      await aio.await_fence(self._ready_fence)
+      self._ready_fence = None
+    return self
+
+  @property
+  def is_ready(self) -> bool:
+    """Whether the contents of the array have been produced."""
+    if self._ready_fence is not None and self._ready_fence.query():
+      self._ready_fence = None
+    return self._ready_fence is None
+
+  def wait_ready(self):
+    """Blocks until the contents of the array have been produced."""
+    if self._ready_fence is not None:
+      self._ready_fence.wait()
+      self._ready_fence = None
+
+  def __dlpack__(self, stream=None):
+    """Exports the array as a DLPack capsule aliasing its memory.
+
+    Only arrays backed by host visible memory can be exported.
+    """
+    self.wait_ready()
+    if self._override_dtype is not None and (self._override_dtype
+                                             != self._get_raw_dtype()):
+      # The stored representation differs from the reported dtype so export
+      # the converted host array.
+      return self.to_host().__dlpack__(stream=stream)
+    return self._buffer_view.__dlpack__(stream=stream)
+
+  def __dlpack_device__(self):
+    return self._buffer_view.__dlpack_device__()
+
   @property
   def is_host_accessible(self):
     """Whether this array is currently host accessible."""
@@ -112,7 +163,7 @@ class DeviceArray(numpy.lib.mixins.NDArrayOperatorsMixin):
     self._mapped_memory, self._host_array = self._map_to_host()
 
   def _map_to_host(self) -> Tuple[MappedMemory, np.ndarray]:
-    # TODO: When synchronization is enabled, need to block here.
+    self.wait_ready()
     raw_dtype = self._get_raw_dtype()
     mapped_memory = self._buffer_view.map()
     host_array = mapped_memory.asarray(self._buffer_view.shape, raw_dtype)
@@ -224,6 +275,46 @@ def asdevicearray(device: HalDevice,
                      override_dtype=a.dtype)
 
 
+def from_dlpack(device: HalDevice,
+                x,
+                *,
+                implicit_host_transfer: bool = False,
+                memory_type=MemoryType.DEVICE_LOCAL,
+                allowed_usage=(BufferUsage.DEFAULT | BufferUsage.MAPPING),
+                allow_copy: bool = True) -> DeviceArray:
+  """Creates a DeviceArray aliasing the memory of a DLPack tensor.
+
+  `x` may be any object implementing `__dlpack__` (such as a numpy array or a
+  CPU torch tensor) or a DLPack capsule. The memory is used in place when the
+  device can import it: writes through either array are visible in the other
+  and the producer is kept alive for as long as the device array is in use.
+  Otherwise the contents are copied if `allow_copy` and an error is raised if
+  not. Host memory must be aligned (see `empty_aligned`) to be imported by
+  local devices. `memory_type` is only used when copying.
+  """
+  buffer_view = device.allocator.import_dlpack(memory_type=memory_type,
+                                               allowed_usage=allowed_usage,
+                                               tensor=x,
+                                               allow_copy=allow_copy)
+  return DeviceArray(device,
+                     buffer_view,
+                     implicit_host_transfer=implicit_host_transfer)
+
+
+def empty_aligned(shape, dtype=np.float32) -> np.ndarray:
+  """Returns an uninitialized array that local devices can import zero-copy.
+
+  Arrays allocated by numpy are generally only 16 byte aligned and must be
+  copied when passed to IREE. Preprocessing that writes its results into
+  arrays allocated with this function avoids the copy.
+  """
+  dtype = np.dtype(dtype)
+  byte_length = int(np.prod(shape, dtype=np.int64)) * dtype.itemsize
+  storage = np.empty(byte_length + _HOST_IMPORT_ALIGNMENT, dtype=np.uint8)
+  offset = -storage.ctypes.data % _HOST_IMPORT_ALIGNMENT
+  return storage[offset:offset + byte_length].view(dtype).reshape(shape)
+
+
 # NOTE: Numpy dtypes are not hashable and exist in a hierarchy that should
 # be queried via isinstance checks. This should be done as a fallback but
 # this is a linear list for quick access to the most common. There may also
@@ -0,0 +1,20 @@
+# Copyright 2023 The IREE Authors
+#
+# Licensed under the Apache License v2.0 with LLVM Exceptions.
+# See https://llvm.org/LICENSE.txt for license information.
+# SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+"""Access to the process-wide runtime metrics and sampled traces."""
+
+from ._binding import (
+    get_metrics_prometheus,
+    get_sampled_trace_json,
+    reset_sampled_trace,
+    set_trace_sample_rate,
+)
+
+__all__ = [
+    "get_metrics_prometheus",
+    "get_sampled_trace_json",
+    "reset_sampled_trace",
+    "set_trace_sample_rate",
+]
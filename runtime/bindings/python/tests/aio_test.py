@@ -0,0 +1,171 @@
+# Copyright 2023 The IREE Authors
+#
+# Licensed under the Apache License v2.0 with LLVM Exceptions.
+# See https://llvm.org/LICENSE.txt for license information.
+# SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+import asyncio
+import json
+import numpy as np
+import unittest
+
+from iree import runtime as rt
+from iree.runtime.function import (
+    FunctionInvoker,
+    IMPLICIT_BUFFER_ARG_MEMORY_TYPE,
+    IMPLICIT_BUFFER_ARG_USAGE,
+)
+
+
+class MockVmContext:
+
+  def __init__(self, invoke_callback):
+    self._invoke_callback = invoke_callback
+
+  def invoke(self, vm_function, arg_list, ret_list):
+    self._invoke_callback(arg_list, ret_list)
+
+
+class MockVmFunction:
+
+  def __init__(self, reflection):
+    self.reflection = reflection
+
+
+class FenceTest(unittest.TestCase):
+
+  def setUp(self):
+    super().setUp()
+    self.device = rt.get_device("local-task")
+
+  def testQueryAndSignal(self):
+    semaphore = self.device.create_semaphore(initial_value=0)
+    fence = rt.HalFence.create_at(semaphore, 2)
+    self.assertFalse(fence.query())
+    semaphore.signal(1)
+    self.assertFalse(fence.query())
+    fence.signal()
+    self.assertEqual(2, semaphore.query())
+    self.assertTrue(fence.query())
+
+  def testWaitTimeout(self):
+    semaphore = self.device.create_semaphore(initial_value=0)
+    fence = rt.HalFence.create_at(semaphore, 1)
+    self.assertFalse(fence.wait(timeout=0.01))
+    semaphore.signal(1)
+    self.assertTrue(fence.wait())
+
+  def testAwaitFence(self):
+    semaphore = self.device.create_semaphore(initial_value=0)
+    fence = rt.HalFence.create_at(semaphore, 1)
+
+    async def main():
+      asyncio.get_running_loop().call_later(0.01, semaphore.signal, 1)
+      await rt.await_fence(fence)
+
+    asyncio.run(main())
+    self.assertTrue(fence.query())
+
+  def testAwaitReachedFence(self):
+    semaphore = self.device.create_semaphore(initial_value=1)
+    fence = rt.HalFence.create_at(semaphore, 1)
+    asyncio.run(rt.await_fence(fence))
+
+
+class AsyncInvokeTest(unittest.TestCase):
+
+  def setUp(self):
+    super().setUp()
+    self.device = rt.get_device("local-task")
+
+  def _create_coarse_fences_invoker(self, invoke):
+    vm_function = MockVmFunction(
+        reflection={
+            "iree.abi":
+                json.dumps({
+                    "a": [["ndarray", "i32", 1, 2]],
+                    "r": [["ndarray", "i32", 1, 2]],
+                }),
+            "iree.abi.model":
+                "coarse-fences",
+        })
+    return FunctionInvoker(MockVmContext(invoke),
+                           self.device,
+                           vm_function,
+                           tracer=None)
+
+  def _allocate_result(self):
+    return self.device.allocator.allocate_buffer_copy(
+        memory_type=IMPLICIT_BUFFER_ARG_MEMORY_TYPE,
+        allowed_usage=IMPLICIT_BUFFER_ARG_USAGE,
+        buffer=np.asarray([4, 2], dtype=np.int32),
+        element_type=rt.HalElementType.SINT_32)
+
+  def testCallWaitsForSignalFence(self):
+    signal_fences = []
+
+    def invoke(arg_list, ret_list):
+      # (arg, wait_fence, signal_fence)
+      self.assertEqual(3, len(arg_list))
+      signal_fence = arg_list.get_as_object(2, rt.HalFence)
+      signal_fence.signal()
+      signal_fences.append(signal_fence)
+      ret_list.push_ref(self._allocate_result())
+
+    invoker = self._create_coarse_fences_invoker(invoke)
+    result = invoker(np.asarray([1, 2], dtype=np.int32))
+    self.assertTrue(signal_fences[0].query())
+    self.assertTrue(result.is_ready)
+    np.testing.assert_array_equal([4, 2], result)
+
+  def testInvokeAsync(self):
+    signal_fences = []
+
+    def invoke(arg_list, ret_list):
+      signal_fences.append(arg_list.get_as_object(2, rt.HalFence))
+      ret_list.push_ref(self._allocate_result())
+
+    invoker = self._create_coarse_fences_invoker(invoke)
+
+    async def main():
+      pending = invoker.invoke_async(np.asarray([1, 2], dtype=np.int32))
+      asyncio.get_running_loop().call_later(
+          0.01, lambda: signal_fences[0].signal())
+      return await pending
+
+    result = asyncio.run(main())
+    self.assertTrue(result.is_ready)
+    np.testing.assert_array_equal([4, 2], result)
+
+  def testSubmitChainsThroughWaitFence(self):
+    wait_fences = []
+    signal_fences = []
+
+    def invoke(arg_list, ret_list):
+      wait_fences.append(arg_list.get_variant(1))
+      signal_fences.append(arg_list.get_as_object(2, rt.HalFence))
+      ret_list.push_ref(self._allocate_result())
+
+    invoker = self._create_coarse_fences_invoker(invoke)
+    first = invoker.submit(np.asarray([1, 2], dtype=np.int32))
+    self.assertFalse(first.is_ready)
+    second = invoker.submit(first)
+    self.assertFalse(second.is_ready)
+
+    # The first invocation waits on nothing and the second on the first.
+    self.assertIsNone(wait_fences[0])
+    self.assertTrue(wait_fences[1].isinstance(rt.HalFence))
+
+    async def main():
+      loop = asyncio.get_running_loop()
+      loop.call_later(0.01, lambda: signal_fences[0].signal())
+      loop.call_later(0.02, lambda: signal_fences[1].signal())
+      await second
+      self.assertTrue(first.is_ready)
+
+    asyncio.run(main())
+    np.testing.assert_array_equal([4, 2], second)
+
+
+if __name__ == "__main__":
+  unittest.main()
@@ -73,6 +73,32 @@ class DeviceHalTest(unittest.TestCase):
     np.testing.assert_array_equal(cp, init_ary.astype(np.float32))
     self.assertTrue(ary.is_host_accessible)
 
+  def testFromDLPackAliasesMemory(self):
+    init_ary = iree.runtime.empty_aligned([3, 4], dtype=np.float32)
+    init_ary[...] = 2
+    ary = iree.runtime.from_dlpack(self.device, init_ary, allow_copy=False)
+    self.assertEqual([3, 4], ary.shape)
+    self.assertEqual(np.float32, ary.dtype)
+    init_ary[0, 0] = 5
+    self.assertEqual(ary.to_host()[0, 0], 5)
+
+  def testFromDLPackCopiesUnaligned(self):
+    init_ary = iree.runtime.empty_aligned([5], dtype=np.int32)[1:]
+    init_ary[...] = 2
+    ary = iree.runtime.from_dlpack(self.device, init_ary)
+    init_ary[0] = 5
+    np.testing.assert_array_equal(ary.to_host(), [2, 2, 2, 2])
+
+  def testToDLPack(self):
+    init_ary = np.zeros([3, 4], dtype=np.int32) + 2
+    ary = iree.runtime.asdevicearray(self.device, init_ary)
+    self.assertEqual(ary.__dlpack_device__(), (1, 0))
+    host_ary = np.from_dlpack(ary)
+    np.testing.assert_array_equal(host_ary, init_ary)
+    # The exported array aliases the device array memory.
+    host_ary[1, 1] = 7
+    self.assertEqual(ary.to_host()[1, 1], 7)
+
   def testIllegalImplicitHostTransfer(self):
     init_ary = np.zeros([3, 4], dtype=np.int32) + 2
     ary = iree.runtime.asdevicearray(self.device, init_ary)
@@ -589,6 +589,56 @@ class FunctionTest(unittest.TestCase):
     result = invoker()
     self.assertEqual("[1, 2]", repr(result))
 
+  def testReturnArityMismatch(self):
+
+    def invoke(arg_list, ret_list):
+      ret_list.push_int(1)
+      ret_list.push_int(2)
+
+    vm_context = MockVmContext(invoke)
+    vm_function = MockVmFunction(reflection={
+        "iree.abi": json.dumps({
+            "a": [],
+            "r": ["i32"],
+        })
+    })
+    invoker = FunctionInvoker(vm_context, self.device, vm_function, tracer=None)
+    with self.assertRaisesRegex(ValueError, "mismatched return arity: 2 vs 1"):
+      _ = invoker()
+
+  def testReturnTypeMismatch(self):
+
+    def invoke(arg_list, ret_list):
+      ret_list.push_int(1)
+
+    vm_context = MockVmContext(invoke)
+    vm_function = MockVmFunction(reflection={
+        "iree.abi": json.dumps({
+            "a": [],
+            "r": ["f32"],
+        })
+    })
+    invoker = FunctionInvoker(vm_context, self.device, vm_function, tracer=None)
+    with self.assertRaisesRegex(
+        ValueError, "Error processing function return: expected a float value"):
+      _ = invoker()
+
+  def testUnsupportedReturnTypeOnlyFailsOnCall(self):
+
+    def invoke(arg_list, ret_list):
+      ret_list.push_int(1)
+
+    vm_context = MockVmContext(invoke)
+    vm_function = MockVmFunction(reflection={
+        "iree.abi": json.dumps({
+            "a": [],
+            "r": [["ndarray", "f16", 0]],
+        })
+    })
+    invoker = FunctionInvoker(vm_context, self.device, vm_function, tracer=None)
+    with self.assertRaisesRegex(ValueError, "could not map abi type"):
+      _ = invoker()
+
 
 if __name__ == "__main__":
   unittest.main()
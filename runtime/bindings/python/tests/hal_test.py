@@ -142,6 +142,51 @@ class DeviceHalTest(unittest.TestCase):
         "<HalBufferView (3, 4), element_type=0x20000011, 48 bytes (at offset 0 into 48), memory_type=DEVICE_LOCAL|HOST_VISIBLE, allowed_access=ALL, allowed_usage=TRANSFER|DISPATCH_STORAGE|MAPPING>"
     )
 
+  def testImportBuffer(self):
+    ary = iree.runtime.empty_aligned([3, 4], dtype=np.int32)
+    ary[...] = 2
+    buffer_view = self.allocator.import_buffer(
+        memory_type=iree.runtime.MemoryType.DEVICE_LOCAL,
+        allowed_usage=iree.runtime.BufferUsage.DEFAULT,
+        buffer=ary,
+        element_type=iree.runtime.HalElementType.SINT_32,
+        allow_copy=False)
+    self.assertEqual(buffer_view.shape, [3, 4])
+    # The buffer aliases the array memory.
+    ary[1, 2] = 7
+    mapped = buffer_view.map().asarray([3, 4], np.int32)
+    self.assertEqual(mapped[1, 2], 7)
+
+  def testImportBufferCopiesUnaligned(self):
+    storage = iree.runtime.empty_aligned([13], dtype=np.int32)
+    ary = storage[1:]
+    with self.assertRaises(IndexError):
+      self.allocator.import_buffer(
+          memory_type=iree.runtime.MemoryType.DEVICE_LOCAL,
+          allowed_usage=iree.runtime.BufferUsage.DEFAULT,
+          buffer=ary,
+          allow_copy=False)
+    ary[...] = 2
+    buffer_view = self.allocator.import_buffer(
+        memory_type=iree.runtime.MemoryType.DEVICE_LOCAL,
+        allowed_usage=iree.runtime.BufferUsage.DEFAULT,
+        buffer=ary,
+        element_type=iree.runtime.HalElementType.SINT_32)
+    ary[0] = 7
+    mapped = buffer_view.map().asarray([12], np.int32)
+    self.assertEqual(mapped[0], 2)
+
+  def testImportBufferCopiesReadOnly(self):
+    ary = iree.runtime.empty_aligned([4], dtype=np.int32)
+    ary[...] = 2
+    ary.flags.writeable = False
+    with self.assertRaises(RuntimeError):
+      self.allocator.import_buffer(
+          memory_type=iree.runtime.MemoryType.DEVICE_LOCAL,
+          allowed_usage=iree.runtime.BufferUsage.DEFAULT,
+          buffer=ary,
+          allow_copy=False)
+
 
 if __name__ == "__main__":
   unittest.main()
@@ -0,0 +1,39 @@
+# Copyright 2023 The IREE Authors
+#
+# Licensed under the Apache License v2.0 with LLVM Exceptions.
+# See https://llvm.org/LICENSE.txt for license information.
+# SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+import iree.runtime
+
+import json
+import unittest
+
+
+class MetricsTest(unittest.TestCase):
+
+  def testAllocationsRecorded(self):
+    allocator = iree.runtime.get_device("local-task").allocator
+    allocator.allocate_buffer(
+        memory_type=iree.runtime.MemoryType.DEVICE_LOCAL,
+        allowed_usage=iree.runtime.BufferUsage.DEFAULT,
+        allocation_size=13)
+    text = iree.runtime.get_metrics_prometheus()
+    self.assertIsInstance(text, str)
+    # Metrics are compiled out of builds without statistics.
+    if allocator.has_statistics:
+      self.assertIn("# TYPE iree_hal_allocator_allocations_total counter\n",
+                    text)
+
+  def testSampledTrace(self):
+    iree.runtime.set_trace_sample_rate(1)
+    try:
+      iree.runtime.reset_sampled_trace()
+      trace = json.loads(iree.runtime.get_sampled_trace_json())
+      self.assertIn("traceEvents", trace)
+    finally:
+      iree.runtime.set_trace_sample_rate(0)
+
+
+if __name__ == "__main__":
+  unittest.main()
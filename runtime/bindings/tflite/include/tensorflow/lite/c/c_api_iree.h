@@ -0,0 +1,36 @@
+// Copyright 2023 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+// IREE-specific extensions to the tflite C API.
+// These are not part of tflite and only available when using the IREE shim.
+
+#ifndef TENSORFLOW_LITE_C_C_API_IREE_H_
+#define TENSORFLOW_LITE_C_C_API_IREE_H_
+
+#include "c_api.h"
+#include "iree/hal/api.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif  // __cplusplus
+
+/// Sets the HAL device interpreters created with `options` will execute on.
+/// The device is retained by the options and by each interpreter created from
+/// them. Passing NULL restores the default behavior.
+///
+/// By default all interpreters in the process share a single device (and with
+/// it the thread pool and memory pools of its driver) that is created on first
+/// use and released when the last interpreter using it is deleted. Providing a
+/// device allows applications to share it with their own IREE usage or select
+/// a specific driver.
+TFL_CAPI_EXPORT extern void TfLiteInterpreterOptionsSetIREEDevice(
+    TfLiteInterpreterOptions* options, iree_hal_device_t* device);
+
+#ifdef __cplusplus
+}  // extern "C"
+#endif  // __cplusplus
+
+#endif  // TENSORFLOW_LITE_C_C_API_IREE_H_
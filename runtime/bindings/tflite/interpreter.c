@@ -7,6 +7,7 @@
 #include "runtime/bindings/tflite/interpreter.h"
 
 #include "iree/base/internal/call_once.h"
+#include "iree/base/internal/synchronization.h"
 #include "iree/base/tracing.h"
 #include "iree/hal/drivers/init.h"
 #include "iree/modules/hal/module.h"
@@ -20,46 +21,80 @@
 
 static iree_once_flag _TfLiteInterpreterRegisterDriverFlag =
     IREE_ONCE_FLAG_INIT;
+
+// Device shared by all interpreters that were not provided one in their
+// options. Created on first use and released when the last interpreter using
+// it is deleted so that all models in the process share the same thread pool
+// and memory pools instead of each competing for the same cores.
+static iree_slim_mutex_t _TfLiteInterpreterSharedDeviceMutex;
+static iree_hal_device_t* _TfLiteInterpreterSharedDevice = NULL;
+static iree_host_size_t _TfLiteInterpreterSharedDeviceUseCount = 0;
+
 static void _TfLiteInterpreterRegisterDrivers(void) {
   IREE_IGNORE_ERROR(iree_hal_register_all_available_drivers(
       iree_hal_driver_registry_default()));
+  iree_slim_mutex_initialize(&_TfLiteInterpreterSharedDeviceMutex);
 }
 
-// TODO(#3977): if already provided a HAL device in the options use that.
-static iree_status_t _TfLiteInterpreterPrepareHAL(
-    TfLiteInterpreter* interpreter) {
-  iree_call_once(&_TfLiteInterpreterRegisterDriverFlag,
-                 _TfLiteInterpreterRegisterDrivers);
-
-  iree_hal_driver_registry_t* driver_registry =
-      iree_hal_driver_registry_default();
-
-  iree_host_size_t driver_info_count = 0;
-  iree_hal_driver_info_t* driver_infos = NULL;
-  IREE_RETURN_IF_ERROR(iree_hal_driver_registry_enumerate(
-      driver_registry, interpreter->allocator, &driver_info_count,
-      &driver_infos));
-
+static iree_status_t _TfLiteInterpreterCreateDefaultDevice(
+    iree_allocator_t host_allocator, iree_hal_device_t** out_device) {
   // TODO(benvanik): figure out how we want to emulate device selection; may
   // just say "whatever is first" on a query.
-  // iree_string_view_t driver_name = driver_infos[0].driver_name;
   // NOTE: currently the sample file is compiled only with vmvx.
-  iree_string_view_t driver_name = iree_make_cstring_view("local-task");
+  iree_string_view_t device_uri = iree_make_cstring_view("local-task");
+  IREE_RETURN_IF_ERROR(
+      iree_hal_create_device(iree_hal_driver_registry_default(), device_uri,
+                             host_allocator, out_device),
+      "failed creating the default device '%.*s'", (int)device_uri.size,
+      device_uri.data);
+  return iree_ok_status();
+}
 
-  // TODO(benvanik): switch to iree_hal_driver_registry_try_create when
-  // implemented.
-  iree_status_t status = iree_hal_driver_registry_try_create(
-      driver_registry, driver_name, interpreter->allocator,
-      &interpreter->driver);
-  iree_allocator_free(interpreter->allocator, driver_infos);
-  IREE_RETURN_IF_ERROR(status, "failed to create driver '%.*s'",
-                       (int)driver_name.size, driver_name.data);
+// Returns a reference to the shared default device, creating it if needed.
+// Must be balanced with a call to _TfLiteInterpreterReleaseSharedDevice.
+static iree_status_t _TfLiteInterpreterAcquireSharedDevice(
+    iree_hal_device_t** out_device) {
+  iree_status_t status = iree_ok_status();
+  iree_slim_mutex_lock(&_TfLiteInterpreterSharedDeviceMutex);
+  if (!_TfLiteInterpreterSharedDevice) {
+    status = _TfLiteInterpreterCreateDefaultDevice(
+        iree_allocator_system(), &_TfLiteInterpreterSharedDevice);
+  }
+  if (iree_status_is_ok(status)) {
+    ++_TfLiteInterpreterSharedDeviceUseCount;
+    *out_device = _TfLiteInterpreterSharedDevice;
+    iree_hal_device_retain(*out_device);
+  }
+  iree_slim_mutex_unlock(&_TfLiteInterpreterSharedDeviceMutex);
+  return status;
+}
 
-  IREE_RETURN_IF_ERROR(
-      iree_hal_driver_create_default_device(
-          interpreter->driver, interpreter->allocator, &interpreter->device),
-      "failed creating the default device for driver '%.*s'",
-      (int)driver_name.size, driver_name.data);
+static void _TfLiteInterpreterReleaseSharedDevice(iree_hal_device_t* device) {
+  iree_slim_mutex_lock(&_TfLiteInterpreterSharedDeviceMutex);
+  iree_hal_device_release(device);
+  if (--_TfLiteInterpreterSharedDeviceUseCount == 0) {
+    iree_hal_device_release(_TfLiteInterpreterSharedDevice);
+    _TfLiteInterpreterSharedDevice = NULL;
+  }
+  iree_slim_mutex_unlock(&_TfLiteInterpreterSharedDeviceMutex);
+}
+
+static iree_status_t _TfLiteInterpreterPrepareHAL(
+    TfLiteInterpreter* interpreter) {
+  iree_call_once(&_TfLiteInterpreterRegisterDriverFlag,
+                 _TfLiteInterpreterRegisterDrivers);
+
+  // Use the device the application provided, if any. The options were copied
+  // into the interpreter and we take over their reference.
+  if (interpreter->options.device) {
+    interpreter->device = interpreter->options.device;
+    iree_hal_device_retain(interpreter->device);
+    interpreter->options.device = NULL;
+  } else {
+    IREE_RETURN_IF_ERROR(
+        _TfLiteInterpreterAcquireSharedDevice(&interpreter->device));
+    interpreter->uses_shared_device = true;
+  }
 
   IREE_RETURN_IF_ERROR(iree_hal_module_create(
       interpreter->instance, interpreter->device, IREE_HAL_MODULE_FLAG_NONE,
@@ -226,6 +261,13 @@ static iree_status_t _TfLiteInterpreterRefreshIOShapes(
 // Creation and static initialization
 //===----------------------------------------------------------------------===//
 
+// Returns the number of arguments passed to the model entry point: inputs and,
+// if the model supports it, the storage for its outputs.
+static iree_host_size_t _TfLiteInterpreterInputListCapacity(
+    const TfLiteModel* model) {
+  return model->input_count + (model->output_storage ? model->output_count : 0);
+}
+
 // Computes the storage requirement for the TfLiteInterpreter struct.
 static iree_host_size_t _TfLiteInterpreterCalculateSize(
     const TfLiteModel* model) {
@@ -234,8 +276,8 @@ static iree_host_size_t _TfLiteInterpreterCalculateSize(
 
   iree_vm_type_def_t buffer_view_type_def =
       iree_vm_type_def_make_ref_type(iree_hal_buffer_type_id());
-  total_size +=
-      iree_vm_list_storage_size(&buffer_view_type_def, model->input_count);
+  total_size += iree_vm_list_storage_size(
+      &buffer_view_type_def, _TfLiteInterpreterInputListCapacity(model));
   total_size +=
       iree_vm_list_storage_size(&buffer_view_type_def, model->output_count);
   total_size += sizeof(TfLiteTensor) * model->input_count;
@@ -266,11 +308,13 @@ static iree_status_t _TfLiteInterpreterAllocate(
   iree_vm_type_def_t buffer_view_type_def =
       iree_vm_type_def_make_ref_type(iree_hal_buffer_type_id());
 
+  iree_host_size_t input_list_capacity =
+      _TfLiteInterpreterInputListCapacity(model);
   iree_byte_span_t input_list_storage = iree_make_byte_span(
-      p, iree_vm_list_storage_size(&buffer_view_type_def, model->input_count));
+      p, iree_vm_list_storage_size(&buffer_view_type_def, input_list_capacity));
   IREE_RETURN_IF_ERROR(
       iree_vm_list_initialize(input_list_storage, &buffer_view_type_def,
-                              model->input_count, &interpreter->input_list));
+                              input_list_capacity, &interpreter->input_list));
   p += input_list_storage.data_length;
 
   iree_byte_span_t output_list_storage = iree_make_byte_span(
@@ -333,8 +377,9 @@ static iree_status_t _TfLiteInterpreterPopulateIO(
   // Prepare the IO lists we use when calling into the model.
   // The actual contents of these cannot be set until
   // TfLiteInterpreterAllocateTensors has been called.
-  IREE_RETURN_IF_ERROR(iree_vm_list_reserve(interpreter->input_list,
-                                            interpreter->model->input_count));
+  IREE_RETURN_IF_ERROR(iree_vm_list_reserve(
+      interpreter->input_list,
+      _TfLiteInterpreterInputListCapacity(interpreter->model)));
   IREE_RETURN_IF_ERROR(iree_vm_list_reserve(interpreter->output_list,
                                             interpreter->model->output_count));
 
@@ -427,7 +472,11 @@ TFL_CAPI_EXPORT extern void TfLiteInterpreterDelete(
   iree_vm_context_release(interpreter->context);
   iree_vm_module_release(interpreter->hal_module);
   iree_vm_module_release(interpreter->user_module);
-  iree_hal_driver_release(interpreter->driver);
+  if (interpreter->uses_shared_device) {
+    _TfLiteInterpreterReleaseSharedDevice(interpreter->device);
+  } else {
+    iree_hal_device_release(interpreter->device);
+  }
   iree_vm_instance_release(interpreter->instance);
 
   _TfLiteModelRelease(interpreter->model);
@@ -542,11 +591,27 @@ static iree_status_t _TfLiteInterpreterAllocateTensors(
         iree_vm_list_push_ref_move(interpreter->input_list, &buffer_ref));
   }
 
-  // TODO(benvanik): preallocate outputs when we support using them.
-  // We could stash the buffer views in interpreter->output_list.
-  // For now we just drop them all.
+  // Older modules allocate their outputs during invocation and we bind to
+  // whatever they return so drop any buffers we have.
+  if (!interpreter->model->output_storage) {
+    for (iree_host_size_t i = 0; i < interpreter->model->output_count; ++i) {
+      _TfLiteTensorDiscardBuffer(&interpreter->output_tensors[i]);
+    }
+    return iree_ok_status();
+  }
+
+  // Reallocate output tensors (if needed) based on the shapes computed from
+  // the current input shapes and pass them as storage following the inputs.
+  // The module writes results directly into them so invocations don't
+  // allocate or remap outputs unless the shapes change.
   for (iree_host_size_t i = 0; i < interpreter->model->output_count; ++i) {
-    _TfLiteTensorDiscardBuffer(&interpreter->output_tensors[i]);
+    TfLiteTensor* tensor = &interpreter->output_tensors[i];
+    IREE_RETURN_IF_ERROR(_TfLiteTensorReallocateIfNeeded(
+        tensor, iree_hal_device_allocator(interpreter->device),
+        interpreter->allocator));
+    iree_vm_ref_t buffer_ref = iree_hal_buffer_retain_ref(tensor->buffer);
+    IREE_RETURN_IF_ERROR(
+        iree_vm_list_push_ref_move(interpreter->input_list, &buffer_ref));
   }
 
   return iree_ok_status();
@@ -580,11 +645,20 @@ static iree_status_t _TfLiteInterpreterInvoke(TfLiteInterpreter* interpreter) {
                      /*policy=*/NULL, interpreter->input_list,
                      interpreter->output_list, interpreter->allocator));
 
-  // Refresh output shapes.
-  // TODO(#3975): just use buffer view results or at least just refresh outputs.
-  IREE_RETURN_IF_ERROR(_TfLiteInterpreterRefreshIOShapes(interpreter));
+  // Refresh output shapes. When the model writes into our output storage the
+  // shapes were already computed from the current input shapes on
+  // TfLiteInterpreterAllocateTensors.
+  if (!interpreter->model->output_storage) {
+    _TfLiteInterpreterShapeFrame frame;
+    IREE_RETURN_IF_ERROR(_TfLiteInterpreterShapeFrameInitialize(&frame));
+    iree_status_t status =
+        _TfLiteInterpreterRefreshOutputShapes(interpreter, &frame);
+    _TfLiteInterpreterShapeFrameDeinitialize(&frame);
+    IREE_RETURN_IF_ERROR(status);
+  }
 
-  // Map the output buffers.
+  // Map the output buffers. Output storage is returned as the results and is
+  // already bound and mapped.
   // NOTE: we could defer the mapping unless requested and ensure state buffers
   // remain where they currently are for the next invocation.
   for (iree_host_size_t i = 0; i < interpreter->model->output_count; ++i) {
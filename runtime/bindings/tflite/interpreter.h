@@ -25,8 +25,9 @@ struct TfLiteInterpreter {
   TfLiteInterpreterOptions options;
 
   iree_vm_instance_t* instance;
-  iree_hal_driver_t* driver;
   iree_hal_device_t* device;
+  // True if |device| is the process-wide shared device.
+  bool uses_shared_device;
 
   union {
     // NOTE: order matters; later modules in the list resolve symbols using the
@@ -9,6 +9,7 @@
 #include <stdio.h>
 #include <string.h>
 
+#include "iree/base/internal/file_io.h"
 #include "iree/base/tracing.h"
 #include "iree/modules/hal/module.h"
 #include "iree/vm/bytecode_module.h"
@@ -63,6 +64,15 @@ static iree_status_t _TfLiteModelInitializeModule(const void* flatbuffer_data,
   IREE_RETURN_IF_ERROR(_TfLiteModelCalculateFunctionIOCounts(
       &main_signature, &model->input_count, &model->output_count));
 
+  // Modules compiled with output storage support take one storage buffer per
+  // output following the inputs. Older modules allocate their results.
+  iree_string_view_t output_storage_attr = iree_vm_function_lookup_attr_by_name(
+      &model->exports._main, iree_make_cstring_view("tfl.io.output_storage"));
+  if (!iree_string_view_is_empty(output_storage_attr)) {
+    model->output_storage = true;
+    model->input_count -= model->output_count;
+  }
+
   // NOTE: the input shape query is not required as it's possible (though
   // silly) for a model to have no inputs. In testing this can happen a lot
   // but in the wild it's rare ... says someone who previously filed bugs
@@ -134,41 +144,37 @@ TFL_CAPI_EXPORT extern TfLiteModel* TfLiteModelCreateFromFile(
   iree_allocator_t allocator = iree_allocator_system();
   IREE_TRACE_ZONE_BEGIN(z0);
 
-  // TODO(#3909): use file mapping C API.
-  FILE* file = fopen(model_path, "r");
-  if (!file) {
-    IREE_TRACE_MESSAGE(ERROR, "failed to open model file");
-    IREE_TRACE_MESSAGE_DYNAMIC(ERROR, model_path, strlen(model_path));
-    IREE_TRACE_ZONE_END(z0);
-    return NULL;
-  }
-  fseek(file, 0, SEEK_END);
-  size_t file_size = ftell(file);
-  fseek(file, 0, SEEK_SET);
   TfLiteModel* model = NULL;
-  iree_status_t status = iree_allocator_malloc(
-      allocator, sizeof(TfLiteModel) + file_size, (void**)&model);
+  iree_status_t status =
+      iree_allocator_malloc(allocator, sizeof(*model), (void**)&model);
   if (!iree_status_is_ok(iree_status_consume_code(status))) {
-    IREE_TRACE_MESSAGE(ERROR, "failed model+data allocation");
+    IREE_TRACE_MESSAGE(ERROR, "failed model allocation");
     IREE_TRACE_ZONE_END(z0);
     return NULL;
   }
   memset(model, 0, sizeof(*model));
   iree_atomic_ref_count_init(&model->ref_count);
   model->allocator = allocator;
-  model->owned_model_data = (uint8_t*)model + file_size;
-  int ret = fread(model->owned_model_data, 1, file_size, file);
-  fclose(file);
-  if (ret != file_size) {
+
+  // The module references the mapped file in-place (including its rodata) so
+  // the contents are only paged in as used and never copied to the heap.
+  status = iree_file_map_contents(model_path, allocator, &model->file_contents);
+  if (!iree_status_is_ok(status)) {
+    IREE_TRACE_MESSAGE(ERROR, "failed to map model file");
+    IREE_TRACE_MESSAGE_DYNAMIC(ERROR, model_path, strlen(model_path));
+    iree_status_fprint(stderr, status);
+    iree_status_free(status);
     TfLiteModelDelete(model);
-    IREE_TRACE_MESSAGE(ERROR, "failed model+data read");
     IREE_TRACE_ZONE_END(z0);
     return NULL;
   }
 
-  status = _TfLiteModelInitializeModule(model->owned_model_data, file_size,
-                                        allocator, model);
-  if (!iree_status_is_ok(iree_status_consume_code(status))) {
+  status = _TfLiteModelInitializeModule(
+      model->file_contents->const_buffer.data,
+      model->file_contents->const_buffer.data_length, allocator, model);
+  if (!iree_status_is_ok(status)) {
+    iree_status_fprint(stderr, status);
+    iree_status_free(status);
     TfLiteModelDelete(model);
     IREE_TRACE_ZONE_END(z0);
     return NULL;
@@ -189,6 +195,8 @@ void _TfLiteModelRelease(TfLiteModel* model) {
     IREE_TRACE_ZONE_BEGIN(z0);
     iree_vm_module_release(model->module);
     iree_vm_instance_release(model->instance);
+    // Released after the module as it references the file contents.
+    if (model->file_contents) iree_file_contents_free(model->file_contents);
     iree_allocator_free(model->allocator, model);
     IREE_TRACE_ZONE_END(z0);
   }
@@ -9,6 +9,7 @@
 
 #include "iree/base/api.h"
 #include "iree/base/internal/atomics.h"
+#include "iree/base/internal/file_io.h"
 #include "iree/vm/api.h"
 
 // NOTE: we pull in our own copy here in case the tflite API changes upstream.
@@ -27,7 +28,9 @@ typedef struct _TfLiteModelExports {
 struct TfLiteModel {
   iree_atomic_ref_count_t ref_count;
   iree_allocator_t allocator;
-  void* owned_model_data;
+  // File contents backing the module when created from a file; mapped when
+  // the platform supports it. NULL when the caller owns the model data.
+  iree_file_contents_t* file_contents;
 
   // HACK: no public API that allows us to share this without spooky action
   // at a distance. Today it's ok for these to be unique as we don't check that
@@ -37,6 +40,8 @@ struct TfLiteModel {
   _TfLiteModelExports exports;
   int32_t input_count;
   int32_t output_count;
+  // True if _main takes output storage buffers following the inputs.
+  bool output_storage;
 };
 
 void _TfLiteModelRetain(TfLiteModel* model);
@@ -37,6 +37,7 @@ TfLiteInterpreterOptionsCreate() {
 TFL_CAPI_EXPORT extern void TfLiteInterpreterOptionsDelete(
     TfLiteInterpreterOptions* options) {
   IREE_TRACE_ZONE_BEGIN(z0);
+  iree_hal_device_release(options->device);
   iree_allocator_free(options->allocator, options);
   IREE_TRACE_ZONE_END(z0);
 }
@@ -87,3 +88,12 @@ TFL_CAPI_EXPORT extern void TfLiteInterpreterOptionsSetUseNNAPI(
 
   IREE_TRACE_ZONE_END(z0);
 }
+
+TFL_CAPI_EXPORT extern void TfLiteInterpreterOptionsSetIREEDevice(
+    TfLiteInterpreterOptions* options, iree_hal_device_t* device) {
+  IREE_TRACE_ZONE_BEGIN(z0);
+  iree_hal_device_retain(device);
+  iree_hal_device_release(options->device);
+  options->device = device;
+  IREE_TRACE_ZONE_END(z0);
+}
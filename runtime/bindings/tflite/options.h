@@ -8,11 +8,13 @@
 #define IREE_BINDINGS_TFLITE_OPTIONS_H_
 
 #include "iree/base/api.h"
+#include "iree/hal/api.h"
 
 // NOTE: we pull in our own copy here in case the tflite API changes upstream.
 #define TFL_COMPILE_LIBRARY 1
 #include "runtime/bindings/tflite/include/tensorflow/lite/c/c_api.h"
 #include "runtime/bindings/tflite/include/tensorflow/lite/c/c_api_experimental.h"
+#include "runtime/bindings/tflite/include/tensorflow/lite/c/c_api_iree.h"
 
 struct TfLiteInterpreterOptions {
   iree_allocator_t allocator;
@@ -20,7 +22,9 @@ struct TfLiteInterpreterOptions {
   void (*reporter)(void* user_data, const char* format, va_list args);
   void* reporter_user_data;
 
-  // TODO(#3977): an existing iree_hal_device_t to use for the HAL.
+  // An existing device to use for the HAL; retained. When NULL interpreters
+  // share a process-wide default device.
+  iree_hal_device_t* device;
 };
 
 void _TfLiteInterpreterOptionsSetDefaults(TfLiteInterpreterOptions* options);
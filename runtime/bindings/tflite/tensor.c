@@ -134,6 +134,9 @@ iree_status_t _TfLiteTensorReallocateIfNeeded(
     return iree_ok_status();
   }
 
+  // Drop the old buffer (if any) before allocating the new one.
+  _TfLiteTensorDiscardBuffer(tensor);
+
   // Allocate the underlying buffer for the tensor.
   IREE_RETURN_AND_END_ZONE_IF_ERROR(
       z0, iree_hal_allocator_allocate_buffer(
@@ -164,6 +167,10 @@ iree_status_t _TfLiteTensorReallocateIfNeeded(
 
 iree_status_t _TfLiteTensorBind(TfLiteTensor* tensor,
                                 iree_hal_buffer_t* buffer) {
+  // Rebinding the same buffer (such as output storage that was returned as a
+  // result) keeps the existing mapping.
+  if (buffer && buffer == tensor->buffer) return iree_ok_status();
+
   IREE_TRACE_ZONE_BEGIN(z0);
   _TfLiteTensorDiscardBuffer(tensor);
   if (!buffer) {
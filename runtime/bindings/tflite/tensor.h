@@ -62,6 +62,7 @@ iree_status_t _TfLiteTensorReallocateIfNeeded(
 
 // Binds the given |buffer| to the tensor and maps it.
 // The tensor shape will be overwritten with the buffer view shape.
+// No-op if |buffer| is already bound to the tensor.
 iree_status_t _TfLiteTensorBind(TfLiteTensor* tensor,
                                 iree_hal_buffer_t* buffer);
 
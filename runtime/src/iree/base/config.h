@@ -248,6 +248,42 @@ typedef IREE_DEVICE_SIZE_T iree_device_size_t;
 #define IREE_VM_BYTECODE_DISPATCH_COMPUTED_GOTO_ENABLE 0
 #endif  // IREE_VM_BYTECODE_DISPATCH_COMPUTED_GOTO_ENABLE
 
+#if !defined(IREE_VM_BYTECODE_VERIFICATION_ENABLE)
+// Verifies all bytecode function bodies when a module is loaded. Verified
+// modules are known to only reference in-range registers, types, functions,
+// globals, and rodata and the dispatch loop omits the per-instruction ordinal
+// masking and range checks it otherwise performs. Disabling this moves the cost
+// back to execution time and is only useful when load time is critical.
+#define IREE_VM_BYTECODE_VERIFICATION_ENABLE 1
+#endif  // !IREE_VM_BYTECODE_VERIFICATION_ENABLE
+
+#if !defined(IREE_VM_BYTECODE_VERIFICATION_CACHE_ENABLE)
+// Caches the hashes of bytecode modules that passed verification so that
+// loading the same bytecode again skips bytecode verification. The hash is not
+// cryptographic and a module crafted to collide with an already verified one
+// would bypass verification: only enable this when all modules are trusted.
+#define IREE_VM_BYTECODE_VERIFICATION_CACHE_ENABLE 0
+#endif  // !IREE_VM_BYTECODE_VERIFICATION_CACHE_ENABLE
+
+#if !defined(IREE_VM_BYTECODE_VERIFICATION_LAZY_ENABLE)
+// Defers verification of each function body until the function is first
+// called. Module loading then only verifies the FlatBuffer structure and the
+// module tables, whose cost depends on the number of functions and segments
+// and not on the size of the bytecode or rodata. Functions that fail
+// verification fail when called instead of when the module is loaded.
+// Has no effect unless IREE_VM_BYTECODE_VERIFICATION_ENABLE is set.
+#define IREE_VM_BYTECODE_VERIFICATION_LAZY_ENABLE 0
+#endif  // !IREE_VM_BYTECODE_VERIFICATION_LAZY_ENABLE
+
+#if !defined(IREE_VM_BYTECODE_NATIVE_TIER_ENABLE)
+// Enables counting invocations of internal bytecode functions and handing hot
+// functions to a native tier registered with
+// iree_vm_bytecode_module_set_native_tier. Functions the tier does not
+// translate continue to run in the interpreter. Adds an atomic increment to
+// each bytecode function entry until the function crosses the threshold.
+#define IREE_VM_BYTECODE_NATIVE_TIER_ENABLE 0
+#endif  // !IREE_VM_BYTECODE_NATIVE_TIER_ENABLE
+
 #if !defined(IREE_VM_EXT_F32_ENABLE)
 // Enables the 32-bit floating-point instruction extension.
 // Targeted from the compiler with `-iree-vm-target-extension-f32`.
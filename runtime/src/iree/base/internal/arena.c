@@ -15,6 +15,102 @@
 // iree_arena_block_pool_t
 //===----------------------------------------------------------------------===//
 
+// Pops a block from |slist|. Blocks must not be freed while a lock-free pop may
+// still be reading them (see iree_atomic_slist_t) and each pop holds
+// |pop_mutex| so that trimming can wait for in-flight pops to complete with
+// iree_arena_block_pool_wait_for_pops.
+static iree_arena_block_t* iree_arena_block_pool_pop(
+    iree_slim_mutex_t* pop_mutex, iree_atomic_arena_block_slist_t* slist) {
+#if IREE_ATOMIC_SLIST_LOCK_FREE
+  iree_slim_mutex_lock(pop_mutex);
+  iree_arena_block_t* block = iree_atomic_arena_block_slist_pop(slist);
+  iree_slim_mutex_unlock(pop_mutex);
+  return block;
+#else
+  // The list pops under its own mutex and never reads unowned blocks.
+  return iree_atomic_arena_block_slist_pop(slist);
+#endif  // IREE_ATOMIC_SLIST_LOCK_FREE
+}
+
+// Waits for any pops from |block_pool| lists that began before blocks were
+// flushed from them to complete.
+static void iree_arena_block_pool_wait_for_pops(
+    iree_arena_block_pool_t* block_pool) {
+#if IREE_ATOMIC_SLIST_LOCK_FREE
+  // Blocks move between the caches and the shared list so a pop from any list
+  // may be reading a block flushed from another.
+#if IREE_ARENA_BLOCK_POOL_CACHE_COUNT > 0
+  for (iree_host_size_t i = 0; i < IREE_ARENA_BLOCK_POOL_CACHE_COUNT; ++i) {
+    iree_slim_mutex_lock(&block_pool->caches[i].pop_mutex);
+    iree_slim_mutex_unlock(&block_pool->caches[i].pop_mutex);
+  }
+#endif  // IREE_ARENA_BLOCK_POOL_CACHE_COUNT > 0
+  iree_slim_mutex_lock(&block_pool->available_pop_mutex);
+  iree_slim_mutex_unlock(&block_pool->available_pop_mutex);
+#endif  // IREE_ATOMIC_SLIST_LOCK_FREE
+}
+
+#if IREE_ARENA_BLOCK_POOL_CACHE_COUNT > 0
+
+#if defined(IREE_COMPILER_MSVC)
+#define IREE_ARENA_THREAD_LOCAL __declspec(thread)
+#else
+#define IREE_ARENA_THREAD_LOCAL _Thread_local
+#endif  // IREE_COMPILER_MSVC
+
+// Cache index of the calling thread plus one (0 indicates unassigned).
+// Threads are assigned caches round-robin as they first use any pool and use
+// the same index across all pools.
+static IREE_ARENA_THREAD_LOCAL uint32_t iree_arena_thread_cache_index = 0;
+static iree_atomic_int32_t iree_arena_next_cache_index =
+    IREE_ATOMIC_VAR_INIT(0);
+
+static iree_arena_block_cache_t* iree_arena_block_pool_thread_cache(
+    iree_arena_block_pool_t* block_pool) {
+  uint32_t index = iree_arena_thread_cache_index;
+  if (IREE_UNLIKELY(index == 0)) {
+    index = (uint32_t)iree_atomic_fetch_add_int32(&iree_arena_next_cache_index,
+                                                  1, iree_memory_order_relaxed);
+    index = (index % IREE_ARENA_BLOCK_POOL_CACHE_COUNT) + 1;
+    iree_arena_thread_cache_index = index;
+  }
+  return &block_pool->caches[index - 1];
+}
+
+// Takes up to |max_count| blocks from the shared list with a single flush and
+// returns the remainder. Returns the number of blocks taken.
+static int32_t iree_arena_block_pool_take_batch(
+    iree_arena_block_pool_t* block_pool, int32_t max_count,
+    iree_arena_block_t** out_head, iree_arena_block_t** out_tail) {
+  *out_head = NULL;
+  *out_tail = NULL;
+  iree_arena_block_t* head = NULL;
+  if (!iree_atomic_arena_block_slist_flush(
+          &block_pool->available_slist,
+          IREE_ATOMIC_SLIST_FLUSH_ORDER_APPROXIMATE_LIFO, &head, NULL)) {
+    return 0;
+  }
+  int32_t count = 1;
+  iree_arena_block_t* tail = head;
+  while (count < max_count && tail->next) {
+    tail = tail->next;
+    ++count;
+  }
+  iree_arena_block_t* remainder = tail->next;
+  tail->next = NULL;
+  if (remainder) {
+    iree_arena_block_t* remainder_tail = remainder;
+    while (remainder_tail->next) remainder_tail = remainder_tail->next;
+    iree_atomic_arena_block_slist_concat(&block_pool->available_slist,
+                                         remainder, remainder_tail);
+  }
+  *out_head = head;
+  *out_tail = tail;
+  return count;
+}
+
+#endif  // IREE_ARENA_BLOCK_POOL_CACHE_COUNT > 0
+
 void iree_arena_block_pool_initialize(iree_host_size_t total_block_size,
                                       iree_allocator_t block_allocator,
                                       iree_arena_block_pool_t* out_block_pool) {
@@ -26,6 +122,13 @@ void iree_arena_block_pool_initialize(iree_host_size_t total_block_size,
       total_block_size - sizeof(iree_arena_block_t);
   out_block_pool->block_allocator = block_allocator;
   iree_atomic_arena_block_slist_initialize(&out_block_pool->available_slist);
+  iree_slim_mutex_initialize(&out_block_pool->available_pop_mutex);
+#if IREE_ARENA_BLOCK_POOL_CACHE_COUNT > 0
+  for (iree_host_size_t i = 0; i < IREE_ARENA_BLOCK_POOL_CACHE_COUNT; ++i) {
+    iree_atomic_arena_block_slist_initialize(&out_block_pool->caches[i].slist);
+    iree_slim_mutex_initialize(&out_block_pool->caches[i].pop_mutex);
+  }
+#endif  // IREE_ARENA_BLOCK_POOL_CACHE_COUNT > 0
 
   IREE_TRACE_ZONE_END(z0);
 }
@@ -36,23 +139,56 @@ void iree_arena_block_pool_deinitialize(iree_arena_block_pool_t* block_pool) {
   // Since all blocks must have been released we can just reuse trim (today) as
   // it doesn't retain any blocks.
   iree_arena_block_pool_trim(block_pool);
+#if IREE_ARENA_BLOCK_POOL_CACHE_COUNT > 0
+  for (iree_host_size_t i = 0; i < IREE_ARENA_BLOCK_POOL_CACHE_COUNT; ++i) {
+    iree_atomic_arena_block_slist_deinitialize(&block_pool->caches[i].slist);
+    iree_slim_mutex_deinitialize(&block_pool->caches[i].pop_mutex);
+  }
+#endif  // IREE_ARENA_BLOCK_POOL_CACHE_COUNT > 0
   iree_atomic_arena_block_slist_deinitialize(&block_pool->available_slist);
+  iree_slim_mutex_deinitialize(&block_pool->available_pop_mutex);
 
   IREE_TRACE_ZONE_END(z0);
 }
 
+static void iree_arena_block_pool_free_list(iree_arena_block_pool_t* block_pool,
+                                            iree_arena_block_t* head) {
+  while (head) {
+    void* ptr = (uint8_t*)head - block_pool->usable_block_size;
+    head = head->next;
+    iree_allocator_free(block_pool->block_allocator, ptr);
+  }
+}
+
 void iree_arena_block_pool_trim(iree_arena_block_pool_t* block_pool) {
   IREE_TRACE_ZONE_BEGIN(z0);
 
+  // Take every list first and only free once pops that may have observed any
+  // of the blocks have completed.
+  // NOTE: flushing an empty list leaves the output head unmodified.
   iree_arena_block_t* head = NULL;
   iree_atomic_arena_block_slist_flush(
       &block_pool->available_slist,
       IREE_ATOMIC_SLIST_FLUSH_ORDER_APPROXIMATE_LIFO, &head, NULL);
-  while (head) {
-    void* ptr = (uint8_t*)head - block_pool->usable_block_size;
-    head = head->next;
-    iree_allocator_free(block_pool->block_allocator, ptr);
+#if IREE_ARENA_BLOCK_POOL_CACHE_COUNT > 0
+  for (iree_host_size_t i = 0; i < IREE_ARENA_BLOCK_POOL_CACHE_COUNT; ++i) {
+    iree_arena_block_cache_t* cache = &block_pool->caches[i];
+    iree_arena_block_t* cache_head = NULL;
+    iree_arena_block_t* cache_tail = NULL;
+    if (iree_atomic_arena_block_slist_flush(
+            &cache->slist, IREE_ATOMIC_SLIST_FLUSH_ORDER_APPROXIMATE_LIFO,
+            &cache_head, &cache_tail)) {
+      cache_tail->next = head;
+      head = cache_head;
+    }
+    iree_atomic_store_int32(&cache->count, 0, iree_memory_order_relaxed);
   }
+#endif  // IREE_ARENA_BLOCK_POOL_CACHE_COUNT > 0
+
+  // Flushed blocks can no longer be reached by new pops but pops that began
+  // before the flush may still be reading them.
+  iree_arena_block_pool_wait_for_pops(block_pool);
+  iree_arena_block_pool_free_list(block_pool, head);
 
   IREE_TRACE_ZONE_END(z0);
 }
@@ -61,8 +197,36 @@ iree_status_t iree_arena_block_pool_acquire(iree_arena_block_pool_t* block_pool,
                                             iree_arena_block_t** out_block) {
   IREE_TRACE_ZONE_BEGIN(z0);
 
+#if IREE_ARENA_BLOCK_POOL_CACHE_COUNT > 0
+  // Fast path: reuse a block recently released by this thread (or one sharing
+  // its cache). When empty we refill the cache with a batch from the shared
+  // list so that the next few acquisitions stay local.
+  iree_arena_block_cache_t* cache =
+      iree_arena_block_pool_thread_cache(block_pool);
   iree_arena_block_t* block =
-      iree_atomic_arena_block_slist_pop(&block_pool->available_slist);
+      iree_arena_block_pool_pop(&cache->pop_mutex, &cache->slist);
+  if (block) {
+    iree_atomic_fetch_sub_int32(&cache->count, 1, iree_memory_order_relaxed);
+  } else {
+    iree_arena_block_t* batch_head = NULL;
+    iree_arena_block_t* batch_tail = NULL;
+    int32_t batch_count = iree_arena_block_pool_take_batch(
+        block_pool, IREE_ARENA_BLOCK_POOL_CACHE_BATCH_SIZE, &batch_head,
+        &batch_tail);
+    if (batch_count > 0) {
+      block = batch_head;
+      if (batch_count > 1) {
+        iree_atomic_arena_block_slist_concat(&cache->slist, block->next,
+                                             batch_tail);
+        iree_atomic_fetch_add_int32(&cache->count, batch_count - 1,
+                                    iree_memory_order_relaxed);
+      }
+    }
+  }
+#else
+  iree_arena_block_t* block = iree_arena_block_pool_pop(
+      &block_pool->available_pop_mutex, &block_pool->available_slist);
+#endif  // IREE_ARENA_BLOCK_POOL_CACHE_COUNT > 0
 
   if (!block) {
     // No blocks available; allocate one now.
@@ -90,6 +254,44 @@ void iree_arena_block_pool_release(iree_arena_block_pool_t* block_pool,
                                    iree_arena_block_t* block_head,
                                    iree_arena_block_t* block_tail) {
   IREE_TRACE_ZONE_BEGIN(z0);
+
+#if IREE_ARENA_BLOCK_POOL_CACHE_COUNT > 0
+  // Count the chain up to the cache capacity; long chains (such as large
+  // arenas being reset) go directly to the shared list in one operation.
+  const int32_t cache_capacity = 2 * IREE_ARENA_BLOCK_POOL_CACHE_BATCH_SIZE;
+  int32_t chain_count = 1;
+  for (iree_arena_block_t* block = block_head;
+       block != block_tail && chain_count <= cache_capacity;
+       block = block->next) {
+    ++chain_count;
+  }
+  iree_arena_block_cache_t* cache =
+      iree_arena_block_pool_thread_cache(block_pool);
+  int32_t cache_count =
+      iree_atomic_load_int32(&cache->count, iree_memory_order_relaxed);
+  if (cache_count + chain_count <= cache_capacity) {
+    iree_atomic_arena_block_slist_concat(&cache->slist, block_head,
+                                         block_tail);
+    iree_atomic_fetch_add_int32(&cache->count, chain_count,
+                                iree_memory_order_relaxed);
+    IREE_TRACE_ZONE_END(z0);
+    return;
+  } else if (chain_count <= cache_capacity) {
+    // The cache is full: return the cached blocks to the shared list along
+    // with the released chain so that other threads can use them.
+    iree_arena_block_t* cache_head = NULL;
+    iree_arena_block_t* cache_tail = NULL;
+    if (iree_atomic_arena_block_slist_flush(
+            &cache->slist, IREE_ATOMIC_SLIST_FLUSH_ORDER_APPROXIMATE_LIFO,
+            &cache_head, &cache_tail)) {
+      iree_atomic_fetch_sub_int32(&cache->count, cache_count,
+                                  iree_memory_order_relaxed);
+      cache_tail->next = block_head;
+      block_head = cache_head;
+    }
+  }
+#endif  // IREE_ARENA_BLOCK_POOL_CACHE_COUNT > 0
+
   iree_atomic_arena_block_slist_concat(&block_pool->available_slist, block_head,
                                        block_tail);
   IREE_TRACE_ZONE_END(z0);
@@ -11,6 +11,7 @@
 
 #include "iree/base/api.h"
 #include "iree/base/internal/atomic_slist.h"
+#include "iree/base/internal/atomics.h"
 
 #ifdef __cplusplus
 extern "C" {
@@ -34,6 +35,33 @@ typedef struct iree_arena_block_t {
 IREE_TYPED_ATOMIC_SLIST_WRAPPER(iree_atomic_arena_block, iree_arena_block_t,
                                 offsetof(iree_arena_block_t, next));
 
+// Number of block caches each pool has. Threads are assigned a cache on first
+// use and threads beyond the cache count share caches. A value of 0 disables
+// the caches and all threads use the shared list directly.
+#if !defined(IREE_ARENA_BLOCK_POOL_CACHE_COUNT)
+#define IREE_ARENA_BLOCK_POOL_CACHE_COUNT 8
+#endif  // !IREE_ARENA_BLOCK_POOL_CACHE_COUNT
+
+// Number of blocks moved between a cache and the shared list at a time.
+// Caches hold at most twice this number of blocks.
+#if !defined(IREE_ARENA_BLOCK_POOL_CACHE_BATCH_SIZE)
+#define IREE_ARENA_BLOCK_POOL_CACHE_BATCH_SIZE 8
+#endif  // !IREE_ARENA_BLOCK_POOL_CACHE_BATCH_SIZE
+
+// A small list of free blocks used by a subset of threads.
+// Padded to avoid false sharing between caches used by different threads.
+typedef union iree_arena_block_cache_t {
+  struct {
+    // Linked list of free blocks (LIFO).
+    iree_atomic_arena_block_slist_t slist;
+    // Approximate number of blocks in the slist.
+    iree_atomic_int32_t count;
+    // Held while popping from |slist|; see available_pop_mutex.
+    iree_slim_mutex_t pop_mutex;
+  };
+  uint8_t reserved[iree_hardware_destructive_interference_size];
+} iree_arena_block_cache_t;
+
 // A simple atomic fixed-size block pool.
 // Blocks are allocated from the system as required and kept in the pool to
 // satisfy future requests. Blocks are all of a uniform size specified when the
@@ -41,6 +69,10 @@ IREE_TYPED_ATOMIC_SLIST_WRAPPER(iree_atomic_arena_block, iree_arena_block_t,
 // blocks so that the underlying allocator is more likely to bucket them
 // appropriately.
 //
+// Each thread acquires and releases blocks through a cache that is refilled
+// from and returned to the shared list in batches. This keeps the common case
+// of a thread reusing its own blocks off the contended shared list head.
+//
 // Thread-safe; multiple threads may acquire and release blocks from the pool.
 // The underlying allocator must also be thread-safe.
 typedef struct iree_arena_block_pool_t {
@@ -51,8 +83,15 @@ typedef struct iree_arena_block_pool_t {
   iree_host_size_t usable_block_size;
   // Allocator used for allocating/freeing each allocation block.
   iree_allocator_t block_allocator;
-  // Linked list of free blocks (LIFO).
+  // Linked list of free blocks (LIFO) shared by all threads.
   iree_atomic_arena_block_slist_t available_slist;
+  // Held while popping from |available_slist| so that trimming can wait for
+  // pops that may still be reading blocks it is about to free.
+  iree_slim_mutex_t available_pop_mutex;
+#if IREE_ARENA_BLOCK_POOL_CACHE_COUNT > 0
+  // Caches of free blocks selected by the calling thread.
+  iree_arena_block_cache_t caches[IREE_ARENA_BLOCK_POOL_CACHE_COUNT];
+#endif  // IREE_ARENA_BLOCK_POOL_CACHE_COUNT > 0
 } iree_arena_block_pool_t;
 
 // Initializes a new block pool in |out_block_pool|.
@@ -69,7 +108,10 @@ void iree_arena_block_pool_initialize(iree_host_size_t total_block_size,
 void iree_arena_block_pool_deinitialize(iree_arena_block_pool_t* block_pool);
 
 // Trims the pool by freeing unused blocks back to the allocator.
+// Blocks held in thread caches are freed as well.
 // Acquired blocks are not freed and remain valid.
+//
+// Thread-safe; other threads may acquire and release blocks concurrently.
 void iree_arena_block_pool_trim(iree_arena_block_pool_t* block_pool);
 
 // Acquires a single block from the pool and returns it in |out_block|.
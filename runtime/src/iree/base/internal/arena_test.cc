@@ -0,0 +1,298 @@
+// Copyright 2023 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include "iree/base/internal/arena.h"
+
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <mutex>
+#include <set>
+#include <thread>
+#include <vector>
+
+#include "iree/testing/gtest.h"
+#include "iree/testing/status_matchers.h"
+
+namespace {
+
+// An allocator that tracks live allocations so that tests can verify that the
+// pool frees each block exactly once.
+class TrackingAllocator {
+ public:
+  iree_allocator_t allocator() { return {this, TrackingAllocator::Ctl}; }
+
+  size_t live_count() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return live_.size();
+  }
+  size_t total_count() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return total_count_;
+  }
+  size_t invalid_free_count() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return invalid_free_count_;
+  }
+
+ private:
+  static iree_status_t Ctl(void* self, iree_allocator_command_t command,
+                           const void* params, void** inout_ptr) {
+    auto* tracker = reinterpret_cast<TrackingAllocator*>(self);
+    std::lock_guard<std::mutex> lock(tracker->mutex_);
+    switch (command) {
+      case IREE_ALLOCATOR_COMMAND_MALLOC:
+      case IREE_ALLOCATOR_COMMAND_CALLOC: {
+        iree_host_size_t byte_length =
+            reinterpret_cast<const iree_allocator_alloc_params_t*>(params)
+                ->byte_length;
+        void* ptr = command == IREE_ALLOCATOR_COMMAND_CALLOC
+                        ? calloc(1, byte_length)
+                        : malloc(byte_length);
+        if (!ptr) return iree_make_status(IREE_STATUS_RESOURCE_EXHAUSTED);
+        tracker->live_.insert(ptr);
+        ++tracker->total_count_;
+        *inout_ptr = ptr;
+        return iree_ok_status();
+      }
+      case IREE_ALLOCATOR_COMMAND_FREE: {
+        // Unknown pointers are counted instead of freed so that double frees
+        // fail the test instead of corrupting the heap.
+        if (tracker->live_.erase(*inout_ptr) == 0) {
+          ++tracker->invalid_free_count_;
+          return iree_ok_status();
+        }
+        free(*inout_ptr);
+        return iree_ok_status();
+      }
+      default:
+        return iree_make_status(IREE_STATUS_UNIMPLEMENTED);
+    }
+  }
+
+  std::mutex mutex_;
+  std::set<void*> live_;
+  size_t total_count_ = 0;
+  size_t invalid_free_count_ = 0;
+};
+
+class ArenaBlockPoolTest : public ::testing::Test {
+ protected:
+  static constexpr iree_host_size_t kBlockSize = 256;
+
+  void SetUp() override {
+    iree_arena_block_pool_initialize(kBlockSize, tracker_.allocator(), &pool_);
+  }
+
+  // Deinitializes the pool and verifies all blocks were freed exactly once.
+  void Deinitialize() {
+    iree_arena_block_pool_deinitialize(&pool_);
+    EXPECT_EQ(tracker_.live_count(), 0u);
+    EXPECT_EQ(tracker_.invalid_free_count(), 0u);
+  }
+
+  // Acquires |count| blocks, stamps each with |value|, verifies no other user
+  // overwrote them, and releases them to the pool as a single chain.
+  void AcquireAndRelease(int count, uint32_t value) {
+    std::vector<iree_arena_block_t*> blocks(count);
+    for (int i = 0; i < count; ++i) {
+      IREE_ASSERT_OK(iree_arena_block_pool_acquire(&pool_, &blocks[i]));
+      memset(BlockData(blocks[i]), (int)(value & 0xFF),
+             pool_.usable_block_size);
+    }
+    for (int i = 0; i < count; ++i) {
+      const uint8_t* data = BlockData(blocks[i]);
+      for (iree_host_size_t j = 0; j < pool_.usable_block_size; ++j) {
+        ASSERT_EQ(data[j], (uint8_t)(value & 0xFF));
+      }
+      blocks[i]->next = i + 1 < count ? blocks[i + 1] : NULL;
+    }
+    iree_arena_block_pool_release(&pool_, blocks.front(), blocks.back());
+  }
+
+  uint8_t* BlockData(iree_arena_block_t* block) {
+    return (uint8_t*)block - pool_.usable_block_size;
+  }
+
+#if IREE_ARENA_BLOCK_POOL_CACHE_COUNT > 0
+  int CachesWithBlocks() {
+    int count = 0;
+    for (int i = 0; i < IREE_ARENA_BLOCK_POOL_CACHE_COUNT; ++i) {
+      if (iree_atomic_load_int32(&pool_.caches[i].count,
+                                 iree_memory_order_relaxed) > 0) {
+        ++count;
+      }
+    }
+    return count;
+  }
+#endif  // IREE_ARENA_BLOCK_POOL_CACHE_COUNT > 0
+
+  TrackingAllocator tracker_;
+  iree_arena_block_pool_t pool_;
+};
+
+TEST_F(ArenaBlockPoolTest, Lifetime) { Deinitialize(); }
+
+TEST_F(ArenaBlockPoolTest, ReusesReleasedBlocks) {
+  iree_arena_block_t* block = NULL;
+  IREE_ASSERT_OK(iree_arena_block_pool_acquire(&pool_, &block));
+  iree_arena_block_pool_release(&pool_, block, block);
+  iree_arena_block_t* reused_block = NULL;
+  IREE_ASSERT_OK(iree_arena_block_pool_acquire(&pool_, &reused_block));
+  EXPECT_EQ(reused_block, block);
+  EXPECT_EQ(tracker_.total_count(), 1u);
+  iree_arena_block_pool_release(&pool_, reused_block, reused_block);
+  Deinitialize();
+}
+
+TEST_F(ArenaBlockPoolTest, TrimEmptyPool) {
+  iree_arena_block_pool_trim(&pool_);
+  EXPECT_EQ(tracker_.invalid_free_count(), 0u);
+  Deinitialize();
+}
+
+TEST_F(ArenaBlockPoolTest, TrimFreesReleasedBlocks) {
+  AcquireAndRelease(4, 1);
+  EXPECT_EQ(tracker_.live_count(), 4u);
+  iree_arena_block_pool_trim(&pool_);
+  EXPECT_EQ(tracker_.live_count(), 0u);
+  EXPECT_EQ(tracker_.invalid_free_count(), 0u);
+
+  // The pool remains usable after trimming.
+  AcquireAndRelease(2, 2);
+  EXPECT_EQ(tracker_.live_count(), 2u);
+  Deinitialize();
+}
+
+TEST_F(ArenaBlockPoolTest, TrimKeepsAcquiredBlocks) {
+  iree_arena_block_t* block = NULL;
+  IREE_ASSERT_OK(iree_arena_block_pool_acquire(&pool_, &block));
+  AcquireAndRelease(3, 1);
+  iree_arena_block_pool_trim(&pool_);
+  EXPECT_EQ(tracker_.live_count(), 1u);
+  iree_arena_block_pool_release(&pool_, block, block);
+  Deinitialize();
+}
+
+// Fills the caches of a few threads and the shared list while leaving the other
+// caches empty. Trimming must free each block once regardless of which lists
+// are empty.
+TEST_F(ArenaBlockPoolTest, TrimPartiallyFilledCaches) {
+  std::vector<std::thread> threads;
+  for (int i = 0; i < 3; ++i) {
+    threads.emplace_back([this, i]() { AcquireAndRelease(2, i); });
+  }
+  for (auto& thread : threads) thread.join();
+  // A chain longer than a cache holds goes directly to the shared list.
+  AcquireAndRelease(4 * IREE_ARENA_BLOCK_POOL_CACHE_BATCH_SIZE, 3);
+#if IREE_ARENA_BLOCK_POOL_CACHE_COUNT > 3
+  EXPECT_GT(CachesWithBlocks(), 0);
+  EXPECT_LT(CachesWithBlocks(), IREE_ARENA_BLOCK_POOL_CACHE_COUNT);
+#endif  // IREE_ARENA_BLOCK_POOL_CACHE_COUNT > 3
+
+  iree_arena_block_pool_trim(&pool_);
+  EXPECT_EQ(tracker_.live_count(), 0u);
+  EXPECT_EQ(tracker_.invalid_free_count(), 0u);
+#if IREE_ARENA_BLOCK_POOL_CACHE_COUNT > 0
+  EXPECT_EQ(CachesWithBlocks(), 0);
+#endif  // IREE_ARENA_BLOCK_POOL_CACHE_COUNT > 0
+
+  // Trimming again with every list empty must not free anything.
+  iree_arena_block_pool_trim(&pool_);
+  EXPECT_EQ(tracker_.invalid_free_count(), 0u);
+  Deinitialize();
+}
+
+TEST_F(ArenaBlockPoolTest, DeinitializePartiallyFilledCaches) {
+  std::vector<std::thread> threads;
+  for (int i = 0; i < 2; ++i) {
+    threads.emplace_back([this, i]() { AcquireAndRelease(3, i); });
+  }
+  for (auto& thread : threads) thread.join();
+  Deinitialize();
+}
+
+// Acquires and releases blocks from more threads than there are caches so that
+// caches are shared, refilled from the shared list, and flushed back to it.
+TEST_F(ArenaBlockPoolTest, ConcurrentAcquireRelease) {
+  const int thread_count = 2 * IREE_ARENA_BLOCK_POOL_CACHE_COUNT + 3;
+  std::vector<std::thread> threads;
+  for (int i = 0; i < thread_count; ++i) {
+    threads.emplace_back([this, i]() {
+      for (int j = 0; j < 200; ++j) {
+        // Mix short chains that stay in the caches with long ones that
+        // overflow them to the shared list.
+        int count = j % 10 == 0 ? 3 * IREE_ARENA_BLOCK_POOL_CACHE_BATCH_SIZE
+                                : 1 + (i + j) % 5;
+        AcquireAndRelease(count, (uint32_t)i);
+        if (::testing::Test::HasFatalFailure()) return;
+      }
+    });
+  }
+  for (auto& thread : threads) thread.join();
+  EXPECT_EQ(tracker_.invalid_free_count(), 0u);
+  Deinitialize();
+}
+
+// Trims the pool repeatedly while other threads acquire and release blocks.
+// Blocks moving between the caches and the shared list are freed out from under
+// in-flight pops unless trimming waits for them.
+TEST_F(ArenaBlockPoolTest, TrimDuringAcquireRelease) {
+  const int thread_count = IREE_ARENA_BLOCK_POOL_CACHE_COUNT + 3;
+  std::atomic<bool> done{false};
+  std::thread trimmer([this, &done]() {
+    while (!done.load()) iree_arena_block_pool_trim(&pool_);
+  });
+  std::vector<std::thread> threads;
+  for (int i = 0; i < thread_count; ++i) {
+    threads.emplace_back([this, i]() {
+      for (int j = 0; j < 2000; ++j) {
+        int count = j % 7 == 0 ? 3 * IREE_ARENA_BLOCK_POOL_CACHE_BATCH_SIZE
+                               : 1 + (i + j) % 3;
+        AcquireAndRelease(count, (uint32_t)i);
+        if (::testing::Test::HasFatalFailure()) return;
+      }
+    });
+  }
+  for (auto& thread : threads) thread.join();
+  done.store(true);
+  trimmer.join();
+  EXPECT_EQ(tracker_.invalid_free_count(), 0u);
+  Deinitialize();
+}
+
+TEST(ArenaTest, ConcurrentArenasShareBlockPool) {
+  TrackingAllocator tracker;
+  iree_arena_block_pool_t pool;
+  iree_arena_block_pool_initialize(1024, tracker.allocator(), &pool);
+  std::vector<std::thread> threads;
+  for (int i = 0; i < 6; ++i) {
+    threads.emplace_back([&pool, i]() {
+      iree_arena_allocator_t arena;
+      iree_arena_initialize(&pool, &arena);
+      for (int j = 0; j < 50; ++j) {
+        std::vector<uint8_t*> ptrs;
+        for (int k = 0; k < 20; ++k) {
+          void* ptr = NULL;
+          IREE_ASSERT_OK(iree_arena_allocate(&arena, 100, &ptr));
+          memset(ptr, i, 100);
+          ptrs.push_back((uint8_t*)ptr);
+        }
+        for (uint8_t* ptr : ptrs) {
+          for (int k = 0; k < 100; ++k) ASSERT_EQ(ptr[k], (uint8_t)i);
+        }
+        iree_arena_reset(&arena);
+      }
+      iree_arena_deinitialize(&arena);
+    });
+  }
+  for (auto& thread : threads) thread.join();
+  iree_arena_block_pool_deinitialize(&pool);
+  EXPECT_EQ(tracker.live_count(), 0u);
+  EXPECT_EQ(tracker.invalid_free_count(), 0u);
+}
+
+}  // namespace
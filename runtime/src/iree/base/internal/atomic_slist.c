@@ -10,10 +10,155 @@
 
 #include "iree/base/attributes.h"
 
-// TODO(benvanik): add TSAN annotations when switched to atomics:
+#if IREE_ATOMIC_SLIST_LOCK_FREE && defined(IREE_COMPILER_MSVC)
+#include <intrin.h>
+#endif  // IREE_ATOMIC_SLIST_LOCK_FREE && IREE_COMPILER_MSVC
+
+// TODO(benvanik): add TSAN annotations:
 // https://github.com/gcc-mirror/gcc/blob/master/libsanitizer/include/sanitizer/tsan_interface_atomic.h
 // https://reviews.llvm.org/D18500
 
+#if IREE_ATOMIC_SLIST_LOCK_FREE
+
+//===----------------------------------------------------------------------===//
+// Lock-free implementation using double-width compare-and-swap
+//===----------------------------------------------------------------------===//
+
+typedef struct iree_atomic_slist_top_t {
+  iree_atomic_slist_entry_t* head;
+  uintptr_t tag;
+} iree_atomic_slist_top_t;
+
+// Loads the top of the list. The two words are loaded individually and may be
+// torn; a torn value will never match the list in a subsequent compare-and-swap
+// and is only used to compute a candidate new value.
+static inline iree_atomic_slist_top_t iree_atomic_slist_load_top(
+    iree_atomic_slist_t* list) {
+  iree_atomic_slist_top_t top;
+#if defined(IREE_COMPILER_MSVC)
+  top.tag = *(volatile uintptr_t*)&list->top.tag;
+  top.head = *(iree_atomic_slist_entry_t* volatile*)&list->top.head;
+#else
+  top.tag = __atomic_load_n(&list->top.tag, __ATOMIC_ACQUIRE);
+  top.head = __atomic_load_n(&list->top.head, __ATOMIC_ACQUIRE);
+#endif  // IREE_COMPILER_MSVC
+  return top;
+}
+
+// Replaces the top of the list with |desired| if it matches |*expected|.
+// Returns false and updates |*expected| with the current value on failure.
+// Acts as a full memory barrier.
+static inline bool iree_atomic_slist_compare_exchange_top(
+    iree_atomic_slist_t* list, iree_atomic_slist_top_t* expected,
+    iree_atomic_slist_top_t desired) {
+#if defined(IREE_COMPILER_MSVC)
+  return _InterlockedCompareExchange128((volatile __int64*)&list->top,
+                                        (__int64)desired.tag,
+                                        (__int64)desired.head,
+                                        (__int64*)expected) != 0;
+#elif defined(IREE_ARCH_X86_64)
+  bool exchanged;
+  __asm__ __volatile__(
+      "lock cmpxchg16b %1\n\t"
+      "sete %0"
+      : "=q"(exchanged), "+m"(list->top), "+a"(expected->head),
+        "+d"(expected->tag)
+      : "b"(desired.head), "c"(desired.tag)
+      : "memory", "cc");
+  return exchanged;
+#else
+#if UINTPTR_MAX == UINT64_MAX
+  typedef unsigned __int128 iree_atomic_slist_top_bits_t;
+#else
+  typedef uint64_t iree_atomic_slist_top_bits_t;
+#endif  // UINTPTR_MAX
+  iree_atomic_slist_top_bits_t expected_bits;
+  iree_atomic_slist_top_bits_t desired_bits;
+  memcpy(&expected_bits, expected, sizeof(expected_bits));
+  memcpy(&desired_bits, &desired, sizeof(desired_bits));
+  // NOTE: the legacy __sync builtins are inlined to the native instruction
+  // when it is available while __atomic builtins of this width call into
+  // libatomic on some toolchains.
+  iree_atomic_slist_top_bits_t actual_bits = __sync_val_compare_and_swap(
+      (iree_atomic_slist_top_bits_t*)&list->top, expected_bits, desired_bits);
+  if (actual_bits == expected_bits) return true;
+  memcpy(expected, &actual_bits, sizeof(actual_bits));
+  return false;
+#endif  // IREE_COMPILER_MSVC
+}
+
+void iree_atomic_slist_initialize(iree_atomic_slist_t* out_list) {
+  memset(out_list, 0, sizeof(*out_list));
+}
+
+void iree_atomic_slist_deinitialize(iree_atomic_slist_t* list) {
+  // TODO(benvanik): assert empty.
+  memset(list, 0, sizeof(*list));
+}
+
+void iree_atomic_slist_concat(iree_atomic_slist_t* list,
+                              iree_atomic_slist_entry_t* head,
+                              iree_atomic_slist_entry_t* tail) {
+  if (IREE_UNLIKELY(!head)) return;
+  iree_atomic_slist_top_t top = iree_atomic_slist_load_top(list);
+  iree_atomic_slist_top_t new_top;
+  do {
+    tail->next = top.head;
+    new_top.head = head;
+    new_top.tag = top.tag + 1;
+  } while (!iree_atomic_slist_compare_exchange_top(list, &top, new_top));
+}
+
+void iree_atomic_slist_push(iree_atomic_slist_t* list,
+                            iree_atomic_slist_entry_t* entry) {
+  iree_atomic_slist_concat(list, entry, entry);
+}
+
+void iree_atomic_slist_push_unsafe(iree_atomic_slist_t* list,
+                                   iree_atomic_slist_entry_t* entry) {
+  // NOTE: no atomic operation is used as no other thread may be accessing the
+  // list and the tag need not change.
+  entry->next = list->top.head;
+  list->top.head = entry;
+}
+
+iree_atomic_slist_entry_t* iree_atomic_slist_pop(iree_atomic_slist_t* list) {
+  iree_atomic_slist_top_t top = iree_atomic_slist_load_top(list);
+  iree_atomic_slist_top_t new_top;
+  do {
+    if (!top.head) return NULL;
+    // NOTE: |top.head| may have been popped by another thread since we loaded
+    // it in which case |next| is garbage. The tag will have changed and the
+    // exchange will fail. The entry itself must still be readable: callers
+    // must not free popped entries while pops may be in progress.
+    new_top.head = *(iree_atomic_slist_entry_t* volatile*)&top.head->next;
+    new_top.tag = top.tag + 1;
+  } while (!iree_atomic_slist_compare_exchange_top(list, &top, new_top));
+  iree_atomic_slist_entry_t* entry = top.head;
+  entry->next = NULL;
+  return entry;
+}
+
+// Exchanges the list head with NULL to steal the entire list. The list will be
+// in the native LIFO order of the slist.
+static iree_atomic_slist_entry_t* iree_atomic_slist_take_all(
+    iree_atomic_slist_t* list) {
+  iree_atomic_slist_top_t top = iree_atomic_slist_load_top(list);
+  iree_atomic_slist_top_t new_top;
+  do {
+    if (!top.head) return NULL;
+    new_top.head = NULL;
+    new_top.tag = top.tag + 1;
+  } while (!iree_atomic_slist_compare_exchange_top(list, &top, new_top));
+  return top.head;
+}
+
+#else
+
+//===----------------------------------------------------------------------===//
+// Mutex-based fallback implementation
+//===----------------------------------------------------------------------===//
+
 void iree_atomic_slist_initialize(iree_atomic_slist_t* out_list) {
   memset(out_list, 0, sizeof(*out_list));
   iree_slim_mutex_initialize(&out_list->mutex);
@@ -44,8 +189,7 @@ void iree_atomic_slist_push(iree_atomic_slist_t* list,
 
 void iree_atomic_slist_push_unsafe(iree_atomic_slist_t* list,
                                    iree_atomic_slist_entry_t* entry) {
-  // NOTE: no lock is held here and no atomic operation will be used when this
-  // is actually made atomic.
+  // NOTE: no lock is held here.
   entry->next = list->head;
   list->head = entry;
 }
@@ -61,16 +205,24 @@ iree_atomic_slist_entry_t* iree_atomic_slist_pop(iree_atomic_slist_t* list) {
   return entry;
 }
 
-bool iree_atomic_slist_flush(iree_atomic_slist_t* list,
-                             iree_atomic_slist_flush_order_t flush_order,
-                             iree_atomic_slist_entry_t** out_head,
-                             iree_atomic_slist_entry_t** out_tail) {
-  // Exchange list head with NULL to steal the entire list. The list will be in
-  // the native LIFO order of the slist.
+// Swaps the list head with NULL to steal the entire list. The list will be in
+// the native LIFO order of the slist.
+static iree_atomic_slist_entry_t* iree_atomic_slist_take_all(
+    iree_atomic_slist_t* list) {
   iree_slim_mutex_lock(&list->mutex);
   iree_atomic_slist_entry_t* head = list->head;
   list->head = NULL;
   iree_slim_mutex_unlock(&list->mutex);
+  return head;
+}
+
+#endif  // IREE_ATOMIC_SLIST_LOCK_FREE
+
+bool iree_atomic_slist_flush(iree_atomic_slist_t* list,
+                             iree_atomic_slist_flush_order_t flush_order,
+                             iree_atomic_slist_entry_t** out_head,
+                             iree_atomic_slist_entry_t** out_tail) {
+  iree_atomic_slist_entry_t* head = iree_atomic_slist_take_all(list);
   if (!head) return false;
 
   switch (flush_order) {
@@ -72,15 +72,58 @@ typedef struct iree_atomic_slist_entry_t {
 //
 // WARNING: this is an extremely sharp pufferfish-esque API. Don't use it. 🐡
 //
+// When the target supports a compare-and-swap of twice the pointer width the
+// list head is a <pointer, tag> pair updated without locks; the tag is bumped
+// on each update to avoid ABA issues when entries are popped and pushed again
+// concurrently. Other targets fall back to a mutex.
+//
+// A thread popping from a lock-free list reads the next pointer of the entry at
+// the head, which another thread may pop at the same time. Entries popped from
+// a list must therefore not be freed while any other thread may still be
+// popping from a list that contained them (the same requirement as Windows
+// SLists). Lists with a single consumer are always safe. Pools that free
+// entries, such as when trimming, must exclude concurrent pops themselves, as
+// iree_arena_block_pool_t does.
+//
 // TODO(benvanik): verify behavior (and worthwhileness) of supporting platform
 // primitives. The benefit of something like OSAtomicEnqueue/Dequeue is that it
 // may have better tooling (TSAN), special intrinsic handling in the compiler,
 // etc. That said, the Windows Interlocked* variants don't seem to. Having a
 // single heavily tested implementation seems more worthwhile than several.
+#if !defined(IREE_ATOMIC_SLIST_LOCK_FREE)
+#if IREE_SYNCHRONIZATION_DISABLE_UNSAFE
+// The mutex is a no-op when synchronization is disabled.
+#define IREE_ATOMIC_SLIST_LOCK_FREE 0
+#elif defined(IREE_COMPILER_MSVC) && \
+    (defined(IREE_ARCH_X86_64) || defined(IREE_ARCH_ARM_64))
+#define IREE_ATOMIC_SLIST_LOCK_FREE 1
+#elif defined(IREE_COMPILER_GCC_COMPAT) && defined(IREE_ARCH_X86_64)
+// cmpxchg16b is used directly as compilers only expose it with -mcx16.
+#define IREE_ATOMIC_SLIST_LOCK_FREE 1
+#elif defined(IREE_COMPILER_GCC_COMPAT) && UINTPTR_MAX == UINT64_MAX && \
+    defined(__GCC_HAVE_SYNC_COMPARE_AND_SWAP_16)
+#define IREE_ATOMIC_SLIST_LOCK_FREE 1
+#elif defined(IREE_COMPILER_GCC_COMPAT) && UINTPTR_MAX == UINT32_MAX && \
+    defined(__GCC_HAVE_SYNC_COMPARE_AND_SWAP_8)
+#define IREE_ATOMIC_SLIST_LOCK_FREE 1
+#else
+#define IREE_ATOMIC_SLIST_LOCK_FREE 0
+#endif  // IREE_COMPILER_*
+#endif  // !IREE_ATOMIC_SLIST_LOCK_FREE
+
 typedef iree_alignas(iree_max_align_t) struct {
-  // TODO(benvanik): spend some time golfing this. Unblocking myself for now :)
+#if IREE_ATOMIC_SLIST_LOCK_FREE
+  // Head of the list and a tag incremented on every atomic update. Both words
+  // are updated together with a double-width compare-and-swap and must be the
+  // first member so that they have the (sufficient) alignment of the list.
+  struct {
+    iree_atomic_slist_entry_t* head;
+    uintptr_t tag;
+  } top;
+#else
   iree_slim_mutex_t mutex;
   iree_atomic_slist_entry_t* head;
+#endif  // IREE_ATOMIC_SLIST_LOCK_FREE
 } iree_atomic_slist_t;
 
 // Initializes an slist handle to an empty list.
@@ -124,6 +167,7 @@ void iree_atomic_slist_push_unsafe(iree_atomic_slist_t* list,
 
 // Pops the most recently pushed entry from the list and returns it.
 // Returns NULL if the list was empty at the time it was queried.
+// See iree_atomic_slist_t for when popped entries may be freed.
 //
 //   existing slist: C B A
 //  resulting slist: B A
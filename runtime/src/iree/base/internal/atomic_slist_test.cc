@@ -6,6 +6,7 @@
 
 #include "iree/base/internal/atomic_slist.h"
 
+#include <thread>
 #include <vector>
 
 #include "iree/testing/gtest.h"
@@ -182,4 +183,49 @@ TEST(AtomicSList, FlushFIFO) {
   dummy_slist_deinitialize(&list);
 }
 
+// Many threads concurrently popping and pushing back the same entries. This
+// exercises the ABA protection: entries are recycled constantly and every
+// entry must be in the list exactly once when all threads have finished.
+TEST(AtomicSList, ConcurrentPopPush) {
+  dummy_slist_t list;
+  dummy_slist_initialize(&list);
+
+  auto item_storage = MakeDummySListItems(0, 64);
+  for (size_t i = 0; i < item_storage.size(); ++i) {
+    dummy_slist_push(&list, &item_storage[i]);
+  }
+
+  static constexpr int kThreadCount = 8;
+  static constexpr int kIterationCount = 20000;
+  std::vector<std::thread> threads;
+  for (int i = 0; i < kThreadCount; ++i) {
+    threads.emplace_back([&list]() {
+      for (int j = 0; j < kIterationCount; ++j) {
+        dummy_entry_t* entries[2] = {
+            dummy_slist_pop(&list),
+            dummy_slist_pop(&list),
+        };
+        for (dummy_entry_t* entry : entries) {
+          if (entry) dummy_slist_push(&list, entry);
+        }
+      }
+    });
+  }
+  for (auto& thread : threads) thread.join();
+
+  std::vector<int> seen(item_storage.size(), 0);
+  dummy_entry_t* head = NULL;
+  ASSERT_TRUE(dummy_slist_flush(
+      &list, IREE_ATOMIC_SLIST_FLUSH_ORDER_APPROXIMATE_LIFO, &head, NULL));
+  for (dummy_entry_t* p = head; p != NULL; p = dummy_slist_get_next(p)) {
+    ASSERT_LT(p->value, seen.size());
+    ++seen[p->value];
+  }
+  for (size_t i = 0; i < seen.size(); ++i) {
+    EXPECT_EQ(1, seen[i]) << "entry " << i;
+  }
+
+  dummy_slist_deinitialize(&list);
+}
+
 }  // namespace
@@ -12,14 +12,206 @@
 #include "iree/base/target_platform.h"
 #include "iree/base/tracing.h"
 
+//===----------------------------------------------------------------------===//
+// Cache size encoding
+//===----------------------------------------------------------------------===//
+
+// Stores the share of a cache of |size_bytes| available to each of the
+// |sharing_count| logical processors sharing it into the field 1 bits selected
+// by |shift| and |mask|, saturating to the field width.
+static void iree_cpu_set_cache_kib(uint64_t size_bytes, uint64_t sharing_count,
+                                   int shift, uint64_t mask,
+                                   uint64_t* out_fields) {
+  if (!size_bytes) return;
+  if (!sharing_count) sharing_count = 1;
+  uint64_t kib = size_bytes / sharing_count / 1024;
+  const uint64_t max_kib = mask >> shift;
+  if (kib > max_kib) kib = max_kib;
+  out_fields[1] = (out_fields[1] & ~mask) | (kib << shift);
+}
+
+// Stores the cache of |level| if it is one that field 1 describes.
+static void iree_cpu_set_cache_kib_for_level(int level, uint64_t size_bytes,
+                                             uint64_t sharing_count,
+                                             uint64_t* out_fields) {
+  if (level == 1) {
+    iree_cpu_set_cache_kib(size_bytes, sharing_count,
+                           IREE_CPU_DATA_FIELD_1_L1D_CACHE_KIB_SHIFT,
+                           IREE_CPU_DATA_FIELD_1_L1D_CACHE_KIB_MASK,
+                           out_fields);
+  } else if (level == 2) {
+    iree_cpu_set_cache_kib(size_bytes, sharing_count,
+                           IREE_CPU_DATA_FIELD_1_L2_CACHE_KIB_SHIFT,
+                           IREE_CPU_DATA_FIELD_1_L2_CACHE_KIB_MASK, out_fields);
+  }
+}
+
 //===----------------------------------------------------------------------===//
 // Platform-specific processor data queries
 //===----------------------------------------------------------------------===//
 
-#if defined(IREE_PLATFORM_ANDROID) || defined(IREE_PLATFORM_LINUX)
+#if defined(IREE_ARCH_X86_64)
+
+// x86-64 exposes all of the features we need through CPUID and XGETBV, both of
+// which are available in user mode on every platform we target.
+#if defined(IREE_COMPILER_MSVC)
+#include <immintrin.h>
+#include <intrin.h>
+#else
+#include <cpuid.h>
+#endif  // IREE_COMPILER_MSVC
+
+static void iree_cpu_cpuid(uint32_t leaf, uint32_t subleaf,
+                           uint32_t* out_regs) {
+#if defined(IREE_COMPILER_MSVC)
+  int regs[4];
+  __cpuidex(regs, (int)leaf, (int)subleaf);
+  for (int i = 0; i < 4; ++i) out_regs[i] = (uint32_t)regs[i];
+#else
+  __cpuid_count(leaf, subleaf, out_regs[0], out_regs[1], out_regs[2],
+                out_regs[3]);
+#endif  // IREE_COMPILER_MSVC
+}
+
+// Returns the XCR0 register indicating which register state the OS saves.
+// Must only be called if CPUID reports OSXSAVE.
+static uint64_t iree_cpu_xgetbv0(void) {
+#if defined(IREE_COMPILER_MSVC)
+  return _xgetbv(0);
+#else
+  uint32_t eax = 0, edx = 0;
+  __asm__ volatile("xgetbv" : "=a"(eax), "=d"(edx) : "c"(0));
+  return ((uint64_t)edx << 32) | eax;
+#endif  // IREE_COMPILER_MSVC
+}
+
+// OR's |field_bit| into |field_value| if all |reg_bits| are set in |reg_value|.
+#define IREE_SET_IF_CPUID(reg_value, reg_bits, field_value, field_bit) \
+  if (iree_all_bits_set(reg_value, reg_bits)) (field_value) |= (field_bit)
+
+// CPUID.01H:ECX
+#define IREE_CPUID_1_ECX_FMA (1u << 12)
+#define IREE_CPUID_1_ECX_OSXSAVE (1u << 27)
+#define IREE_CPUID_1_ECX_AVX (1u << 28)
+// CPUID.(EAX=07H,ECX=0):EBX
+#define IREE_CPUID_7_EBX_AVX2 (1u << 5)
+#define IREE_CPUID_7_EBX_AVX512F (1u << 16)
+#define IREE_CPUID_7_EBX_AVX512DQ (1u << 17)
+#define IREE_CPUID_7_EBX_AVX512CD (1u << 28)
+#define IREE_CPUID_7_EBX_AVX512BW (1u << 30)
+#define IREE_CPUID_7_EBX_AVX512VL (1u << 31)
+// CPUID.(EAX=07H,ECX=0):ECX
+#define IREE_CPUID_7_ECX_AVX512VNNI (1u << 11)
+// CPUID.(EAX=07H,ECX=1):EAX
+#define IREE_CPUID_7_1_EAX_AVX512BF16 (1u << 5)
+// XCR0: SSE|AVX state and opmask|ZMM_Hi256|Hi16_ZMM state.
+#define IREE_XCR0_AVX_STATE 0x6ull
+#define IREE_XCR0_AVX512_STATE 0xE6ull
+
+static void iree_cpu_initialize_isa_from_cpuid(uint64_t* out_fields) {
+  uint32_t leaf0[4] = {0};
+  iree_cpu_cpuid(0, 0, leaf0);
+  const uint32_t max_leaf = leaf0[0];
+  if (max_leaf < 7) return;
+
+  uint32_t leaf1[4] = {0};
+  iree_cpu_cpuid(1, 0, leaf1);
+  const uint32_t leaf1_ecx = leaf1[2];
+  // Without OS support for saving the extended register state none of the
+  // AVX features can be used even if the processor supports them.
+  if (!iree_all_bits_set(leaf1_ecx,
+                         IREE_CPUID_1_ECX_OSXSAVE | IREE_CPUID_1_ECX_AVX)) {
+    return;
+  }
+  const uint64_t xcr0 = iree_cpu_xgetbv0();
+  if (!iree_all_bits_set(xcr0, IREE_XCR0_AVX_STATE)) return;
+
+  uint32_t leaf7[4] = {0};
+  iree_cpu_cpuid(7, 0, leaf7);
+  const uint32_t leaf7_max_subleaf = leaf7[0];
+  const uint32_t leaf7_ebx = leaf7[1];
+  const uint32_t leaf7_ecx = leaf7[2];
+
+  if (!iree_all_bits_set(leaf1_ecx, IREE_CPUID_1_ECX_FMA)) return;
+  IREE_SET_IF_CPUID(leaf7_ebx, IREE_CPUID_7_EBX_AVX2, out_fields[0],
+                    IREE_CPU_DATA_FIELD_0_X86_64_HAVE_AVX2_FMA);
+  if (!(out_fields[0] & IREE_CPU_DATA_FIELD_0_X86_64_HAVE_AVX2_FMA)) return;
+
+  if (!iree_all_bits_set(xcr0, IREE_XCR0_AVX512_STATE)) return;
+  IREE_SET_IF_CPUID(leaf7_ebx,
+                    IREE_CPUID_7_EBX_AVX512F | IREE_CPUID_7_EBX_AVX512DQ |
+                        IREE_CPUID_7_EBX_AVX512CD | IREE_CPUID_7_EBX_AVX512BW |
+                        IREE_CPUID_7_EBX_AVX512VL,
+                    out_fields[0],
+                    IREE_CPU_DATA_FIELD_0_X86_64_HAVE_AVX512_BASE);
+  if (!(out_fields[0] & IREE_CPU_DATA_FIELD_0_X86_64_HAVE_AVX512_BASE)) {
+    return;
+  }
+  IREE_SET_IF_CPUID(leaf7_ecx, IREE_CPUID_7_ECX_AVX512VNNI, out_fields[0],
+                    IREE_CPU_DATA_FIELD_0_X86_64_HAVE_AVX512VNNI);
+  if (leaf7_max_subleaf >= 1) {
+    uint32_t leaf7_1[4] = {0};
+    iree_cpu_cpuid(7, 1, leaf7_1);
+    IREE_SET_IF_CPUID(leaf7_1[0], IREE_CPUID_7_1_EAX_AVX512BF16, out_fields[0],
+                      IREE_CPU_DATA_FIELD_0_X86_64_HAVE_AVX512BF16);
+  }
+}
+
+#undef IREE_SET_IF_CPUID
+
+// Walks the deterministic cache parameters in CPUID |leaf|, which is 04H on
+// Intel and 8000001DH on AMD; both use the same register layout. Returns false
+// if the leaf does not enumerate any cache.
+static bool iree_cpu_initialize_cache_sizes_from_cpuid_leaf(
+    uint32_t leaf, uint64_t* out_fields) {
+  bool found_any = false;
+  for (uint32_t subleaf = 0; subleaf < 16; ++subleaf) {
+    uint32_t regs[4] = {0};
+    iree_cpu_cpuid(leaf, subleaf, regs);
+    const uint32_t cache_type = regs[0] & 0x1F;
+    if (cache_type == 0) break;  // No more caches.
+    found_any = true;
+    // 1 = data cache, 3 = unified cache. Skip instruction caches.
+    if (cache_type != 1 && cache_type != 3) continue;
+    const int level = (regs[0] >> 5) & 0x7;
+    const uint64_t sharing_count = ((regs[0] >> 14) & 0xFFF) + 1;
+    const uint64_t ways = ((regs[1] >> 22) & 0x3FF) + 1;
+    const uint64_t partitions = ((regs[1] >> 12) & 0x3FF) + 1;
+    const uint64_t line_size = (regs[1] & 0xFFF) + 1;
+    const uint64_t sets = (uint64_t)regs[2] + 1;
+    iree_cpu_set_cache_kib_for_level(level,
+                                     ways * partitions * line_size * sets,
+                                     sharing_count, out_fields);
+  }
+  return found_any;
+}
+
+static void iree_cpu_initialize_cache_sizes_from_cpuid(uint64_t* out_fields) {
+  uint32_t leaf0[4] = {0};
+  iree_cpu_cpuid(0, 0, leaf0);
+  if (leaf0[0] >= 4 &&
+      iree_cpu_initialize_cache_sizes_from_cpuid_leaf(4, out_fields)) {
+    return;
+  }
+  uint32_t leaf_ext0[4] = {0};
+  iree_cpu_cpuid(0x80000000u, 0, leaf_ext0);
+  if (leaf_ext0[0] >= 0x8000001Du) {
+    iree_cpu_initialize_cache_sizes_from_cpuid_leaf(0x8000001Du, out_fields);
+  }
+}
+
+static void iree_cpu_initialize_from_platform(iree_allocator_t temp_allocator,
+                                              uint64_t* out_fields) {
+  iree_cpu_initialize_isa_from_cpuid(out_fields);
+  iree_cpu_initialize_cache_sizes_from_cpuid(out_fields);
+}
+
+#elif defined(IREE_PLATFORM_ANDROID) || defined(IREE_PLATFORM_LINUX)
 
 // NOTE: not all kernel versions have all of the cap bits we need defined so as
 // a practice we always define the feature bits we need locally.
+#include <stdio.h>
+#include <stdlib.h>
 #include <sys/auxv.h>
 
 // OR's |field_bit| into |field_value| if |hwcap_bit| is set in |hwcap_value|.
@@ -44,6 +236,29 @@ static void iree_cpu_query_data_arch_hwcaps(uint32_t hwcap, uint32_t hwcap2,
                     IREE_CPU_DATA_FIELD_0_AARCH64_HAVE_I8MM);
 }
 
+#elif defined(IREE_ARCH_RISCV_64)
+
+// https://docs.kernel.org/riscv/uabi.html: one bit per single-letter extension.
+#define IREE_HWCAP_RISCV_V (1 << ('V' - 'A'))
+
+// Returns the vector register length in bytes. Must only be called when the V
+// extension is available, as reading the CSR traps otherwise. The CSR is
+// referenced by number so that this builds without V enabled in -march.
+static uint64_t iree_cpu_read_riscv_vlenb(void) {
+  uint64_t vlenb = 0;
+  __asm__ volatile("csrr %0, 0xc22" : "=r"(vlenb));
+  return vlenb;
+}
+
+static void iree_cpu_query_data_arch_hwcaps(uint32_t hwcap, uint32_t hwcap2,
+                                            uint64_t* out_fields) {
+  if (!iree_all_bits_set(hwcap, IREE_HWCAP_RISCV_V)) return;
+  out_fields[0] |= IREE_CPU_DATA_FIELD_0_RISCV_64_HAVE_V;
+  if (iree_cpu_read_riscv_vlenb() >= 32) {
+    out_fields[0] |= IREE_CPU_DATA_FIELD_0_RISCV_64_HAVE_ZVL256B;
+  }
+}
+
 #else
 static void iree_cpu_query_data_arch_hwcaps(uint32_t hwcap, uint32_t hwcap2,
                                             uint64_t* out_fields) {
@@ -53,11 +268,70 @@ static void iree_cpu_query_data_arch_hwcaps(uint32_t hwcap, uint32_t hwcap2,
 
 #undef IREE_SET_IF_HWCAP
 
+// Reads the first line of the sysfs cache attribute |name| of cache |index| of
+// cpu0 into |buffer|. Returns false if the attribute is not available.
+static bool iree_cpu_read_sysfs_cache_attribute(int index, const char* name,
+                                                char* buffer, int capacity) {
+  char path[96];
+  snprintf(path, sizeof(path), "/sys/devices/system/cpu/cpu0/cache/index%d/%s",
+           index, name);
+  FILE* file = fopen(path, "r");
+  if (!file) return false;
+  bool ok = fgets(buffer, capacity, file) != NULL;
+  fclose(file);
+  return ok;
+}
+
+// Queries cache sizes from sysfs. This describes the caches of cpu0, which on
+// heterogeneous systems may be one of the smaller cores; that errs on the side
+// of blocking for too small a cache rather than too large a one.
+static void iree_cpu_initialize_cache_sizes_from_sysfs(uint64_t* out_fields) {
+  char buffer[128];
+  for (int index = 0; index < 8; ++index) {
+    if (!iree_cpu_read_sysfs_cache_attribute(index, "type", buffer,
+                                             sizeof(buffer))) {
+      break;
+    }
+    if (strncmp(buffer, "Data", 4) != 0 && strncmp(buffer, "Unified", 7) != 0) {
+      continue;
+    }
+    if (!iree_cpu_read_sysfs_cache_attribute(index, "level", buffer,
+                                             sizeof(buffer))) {
+      continue;
+    }
+    const int level = atoi(buffer);
+    if (!iree_cpu_read_sysfs_cache_attribute(index, "size", buffer,
+                                             sizeof(buffer))) {
+      continue;
+    }
+    // Sizes are formatted like "64K" or "2M".
+    char* suffix = NULL;
+    uint64_t size_bytes = strtoull(buffer, &suffix, 10);
+    if (*suffix == 'K') size_bytes <<= 10;
+    if (*suffix == 'M') size_bytes <<= 20;
+    // The sharing mask is a comma-separated hex bitmap like "0000,000000ff".
+    uint64_t sharing_count = 1;
+    if (iree_cpu_read_sysfs_cache_attribute(index, "shared_cpu_map", buffer,
+                                            sizeof(buffer))) {
+      sharing_count = 0;
+      for (const char* c = buffer; *c; ++c) {
+        int nibble = 0;
+        if (*c >= '0' && *c <= '9') nibble = *c - '0';
+        if (*c >= 'a' && *c <= 'f') nibble = *c - 'a' + 10;
+        for (; nibble; nibble >>= 1) sharing_count += nibble & 1;
+      }
+    }
+    iree_cpu_set_cache_kib_for_level(level, size_bytes, sharing_count,
+                                     out_fields);
+  }
+}
+
 static void iree_cpu_initialize_from_platform(iree_allocator_t temp_allocator,
                                               uint64_t* out_fields) {
   uint32_t hwcap = getauxval(AT_HWCAP);
   uint32_t hwcap2 = getauxval(AT_HWCAP2);
   iree_cpu_query_data_arch_hwcaps(hwcap, hwcap2, out_fields);
+  iree_cpu_initialize_cache_sizes_from_sysfs(out_fields);
 }
 
 #elif defined(IREE_PLATFORM_MACOS) || defined(IREE_PLATFORM_IOS)
@@ -74,6 +348,26 @@ static void iree_cpu_initialize_from_platform(iree_allocator_t temp_allocator,
     }                                                             \
   } while (0)
 
+// Returns the integer value of sysctl |key| or 0 if it is not available.
+static int64_t iree_cpu_query_sysctl_int64(const char* key) {
+  int64_t result = 0;
+  size_t result_size = sizeof result;
+  if (0 != sysctlbyname(key, &result, &result_size, NULL, 0)) return 0;
+  return result;
+}
+
+static void iree_cpu_initialize_cache_sizes_from_sysctl(uint64_t* out_fields) {
+  // Prefer the performance cores' view on heterogeneous systems: that is where
+  // compute-heavy work gets scheduled. The L2 is shared by a whole cluster.
+  int64_t l1d_size = iree_cpu_query_sysctl_int64("hw.perflevel0.l1dcachesize");
+  if (!l1d_size) l1d_size = iree_cpu_query_sysctl_int64("hw.l1dcachesize");
+  int64_t l2_size = iree_cpu_query_sysctl_int64("hw.perflevel0.l2cachesize");
+  int64_t l2_sharing = iree_cpu_query_sysctl_int64("hw.perflevel0.cpusperl2");
+  if (!l2_size) l2_size = iree_cpu_query_sysctl_int64("hw.l2cachesize");
+  iree_cpu_set_cache_kib_for_level(1, l1d_size, 1, out_fields);
+  iree_cpu_set_cache_kib_for_level(2, l2_size, l2_sharing, out_fields);
+}
+
 static void iree_cpu_initialize_from_platform(iree_allocator_t temp_allocator,
                                               uint64_t* out_fields) {
 #if defined(IREE_ARCH_ARM_64)
@@ -82,6 +376,7 @@ static void iree_cpu_initialize_from_platform(iree_allocator_t temp_allocator,
   IREE_QUERY_SYSCTL("hw.optional.arm.FEAT_I8MM", out_fields[0],
                     IREE_CPU_DATA_FIELD_0_AARCH64_HAVE_I8MM);
 #endif
+  iree_cpu_initialize_cache_sizes_from_sysctl(out_fields);
 }
 
 #else
@@ -103,6 +398,27 @@ static void iree_cpu_initialize_from_platform(iree_allocator_t temp_allocator,
     return true;                                                        \
   }
 
+#define IREE_TEST_FIELD_VALUE(field_key, field_value, shift, mask) \
+  if (iree_string_view_equal(key, IREE_SV(field_key))) {          \
+    *out_value = (int64_t)(((field_value) & (mask)) >> (shift));  \
+    return true;                                                  \
+  }
+
+// Keys shared by all architectures.
+static bool iree_cpu_lookup_data_by_key_common(
+    const uint64_t* fields, iree_string_view_t key,
+    int64_t* IREE_RESTRICT out_value) {
+  IREE_TEST_FIELD_VALUE("l1d_cache_kib", fields[1],
+                        IREE_CPU_DATA_FIELD_1_L1D_CACHE_KIB_SHIFT,
+                        IREE_CPU_DATA_FIELD_1_L1D_CACHE_KIB_MASK);
+  IREE_TEST_FIELD_VALUE("l2_cache_kib", fields[1],
+                        IREE_CPU_DATA_FIELD_1_L2_CACHE_KIB_SHIFT,
+                        IREE_CPU_DATA_FIELD_1_L2_CACHE_KIB_MASK);
+  return false;
+}
+
+#undef IREE_TEST_FIELD_VALUE
+
 #if defined(IREE_ARCH_ARM_64)
 
 static bool iree_cpu_lookup_data_by_key_for_arch(
@@ -115,6 +431,33 @@ static bool iree_cpu_lookup_data_by_key_for_arch(
   return false;
 }
 
+#elif defined(IREE_ARCH_X86_64)
+
+static bool iree_cpu_lookup_data_by_key_for_arch(
+    const uint64_t* fields, iree_string_view_t key,
+    int64_t* IREE_RESTRICT out_value) {
+  IREE_TEST_FIELD_BIT("avx2_fma", fields[0],
+                      IREE_CPU_DATA_FIELD_0_X86_64_HAVE_AVX2_FMA);
+  IREE_TEST_FIELD_BIT("avx512_base", fields[0],
+                      IREE_CPU_DATA_FIELD_0_X86_64_HAVE_AVX512_BASE);
+  IREE_TEST_FIELD_BIT("avx512vnni", fields[0],
+                      IREE_CPU_DATA_FIELD_0_X86_64_HAVE_AVX512VNNI);
+  IREE_TEST_FIELD_BIT("avx512bf16", fields[0],
+                      IREE_CPU_DATA_FIELD_0_X86_64_HAVE_AVX512BF16);
+  return false;
+}
+
+#elif defined(IREE_ARCH_RISCV_64)
+
+static bool iree_cpu_lookup_data_by_key_for_arch(
+    const uint64_t* fields, iree_string_view_t key,
+    int64_t* IREE_RESTRICT out_value) {
+  IREE_TEST_FIELD_BIT("v", fields[0], IREE_CPU_DATA_FIELD_0_RISCV_64_HAVE_V);
+  IREE_TEST_FIELD_BIT("zvl256b", fields[0],
+                      IREE_CPU_DATA_FIELD_0_RISCV_64_HAVE_ZVL256B);
+  return false;
+}
+
 #else
 
 static bool iree_cpu_lookup_data_by_key_for_arch(
@@ -166,7 +509,9 @@ void iree_cpu_read_data(iree_host_size_t field_count, uint64_t* out_fields) {
 
 iree_status_t iree_cpu_lookup_data_by_key(iree_string_view_t key,
                                           int64_t* IREE_RESTRICT out_value) {
-  if (!iree_cpu_lookup_data_by_key_for_arch(iree_cpu_data_cache_, key,
+  if (!iree_cpu_lookup_data_by_key_common(iree_cpu_data_cache_, key,
+                                          out_value) &&
+      !iree_cpu_lookup_data_by_key_for_arch(iree_cpu_data_cache_, key,
                                             out_value)) {
     return iree_make_status(IREE_STATUS_NOT_FOUND,
                             "CPU data key '%.*s' not found", (int)key.size,
@@ -4,6 +4,7 @@
 // See https://llvm.org/LICENSE.txt for license information.
 // SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
 
+#include <inttypes.h>
 #include <stdint.h>
 #include <stdio.h>
 #include <string.h>
@@ -24,12 +25,27 @@
 #include <sys/types.h>
 #include <unistd.h>
 
+#if defined(IREE_PLATFORM_ANDROID) || defined(IREE_PLATFORM_LINUX)
+#include <sys/syscall.h>
+#if defined(SYS_memfd_create)
+// memfd_create is called via syscall as libc wrappers are only available in
+// newer glibc (2.27) and bionic (API 30) versions.
+#define IREE_DYNAMIC_LIBRARY_HAVE_MEMFD 1
+#define IREE_DYNAMIC_LIBRARY_MFD_CLOEXEC 0x0001U
+#endif  // SYS_memfd_create
+#endif  // IREE_PLATFORM_ANDROID || IREE_PLATFORM_LINUX
+
 struct iree_dynamic_library_t {
   iree_atomic_ref_count_t ref_count;
   iree_allocator_t allocator;
 
   // dlopen shared object handle.
   void* handle;
+
+  // Anonymous file the library was loaded from, if loaded from memory with
+  // memfd_create, or -1. Kept open so that the /proc/self/fd/ path the loader
+  // reports for the library remains valid for tools such as profilers.
+  int memfd;
 };
 
 // Allocate a new string from |allocator| returned in |out_file_path| containing
@@ -128,6 +144,7 @@ static iree_status_t iree_dynamic_library_create(
   iree_atomic_ref_count_init(&library->ref_count);
   library->allocator = allocator;
   library->handle = handle;
+  library->memfd = -1;
 
   *out_library = library;
   return iree_ok_status();
@@ -179,6 +196,7 @@ static iree_once_flag iree_dynamic_library_temp_dir_init_once_flag_ =
 static const char* iree_dynamic_library_temp_dir_path_;
 static bool iree_dynamic_library_temp_dir_valid_;
 static bool iree_dynamic_library_temp_dir_preserve_;
+static const char* iree_dynamic_library_cache_dir_path_;
 
 static bool iree_dynamic_library_path_is_null_or_empty(const char* path) {
   return path == NULL || path[0] == 0;
@@ -219,12 +237,170 @@ static void iree_dynamic_library_init_temp_dir(void) {
   struct stat s;
   iree_dynamic_library_temp_dir_valid_ =
       stat(path, &s) == 0 && (s.st_mode & S_IFMT) == S_IFDIR;
+
+  // Semantics of IREE_DYLIB_CACHE_DIR:
+  // * If the environment variable is not set, libraries loaded from memory are
+  //   written out each time they are loaded.
+  // * If the environment variable is set to the path of a directory then
+  //   libraries loaded from memory are written there once, named by the hash
+  //   of their contents, and loaded directly from the cached file on
+  //   subsequent loads including those in later processes. Example:
+  //     $ IREE_DYLIB_CACHE_DIR=/var/cache/iree iree-run-module ...
+  //   Files in the directory will be loaded and executed so it must only be
+  //   writable by trusted users.
+  const char* cache_path = getenv("IREE_DYLIB_CACHE_DIR");
+  if (!iree_dynamic_library_path_is_null_or_empty(cache_path) &&
+      stat(cache_path, &s) == 0 && (s.st_mode & S_IFMT) == S_IFDIR) {
+    iree_dynamic_library_cache_dir_path_ = cache_path;
+  }
+}
+
+// 64-bit FNV-1a hash of |buffer| used to key cached library files.
+static uint64_t iree_dynamic_library_hash_contents(
+    iree_const_byte_span_t buffer) {
+  uint64_t hash = 0xCBF29CE484222325ull;
+  for (iree_host_size_t i = 0; i < buffer.data_length; ++i) {
+    hash = (hash ^ buffer.data[i]) * 0x100000001B3ull;
+  }
+  return hash;
+}
+
+// Writes all of |buffer| to |fd|, retrying on partial writes.
+static iree_status_t iree_dynamic_library_write_fd(
+    int fd, iree_const_byte_span_t buffer) {
+  const uint8_t* data = buffer.data;
+  iree_host_size_t remaining = buffer.data_length;
+  while (remaining > 0) {
+    ssize_t written = write(fd, data, remaining);
+    if (written < 0) {
+      if (errno == EINTR) continue;
+      return iree_make_status(iree_status_code_from_errno(errno),
+                              "unable to write %zu bytes",
+                              buffer.data_length);
+    }
+    data += written;
+    remaining -= (iree_host_size_t)written;
+  }
+  return iree_ok_status();
+}
+
+// Loads |buffer| from a file in the persistent dylib cache directory, writing
+// the file first if no prior load has. The file is named by the contents hash
+// and length and published with an atomic rename so that concurrent processes
+// populating the cache never observe partially written files. Returns
+// IREE_STATUS_UNAVAILABLE if the cache could not be used so that callers can
+// fall back to the uncached paths.
+static iree_status_t iree_dynamic_library_load_from_cache(
+    iree_const_byte_span_t buffer, iree_dynamic_library_flags_t flags,
+    iree_allocator_t allocator, iree_dynamic_library_t** out_library) {
+  IREE_TRACE_ZONE_BEGIN(z0);
+
+  char file_path[512];
+  if (snprintf(file_path, sizeof(file_path), "%s/iree_dylib_%016" PRIx64
+               "_%zu.so", iree_dynamic_library_cache_dir_path_,
+               iree_dynamic_library_hash_contents(buffer),
+               buffer.data_length) >= sizeof(file_path)) {
+    IREE_TRACE_ZONE_END(z0);
+    return iree_make_status(IREE_STATUS_UNAVAILABLE,
+                            "dylib cache path too long (>%zu chars)",
+                            sizeof(file_path));
+  }
+  iree_file_path_canonicalize(file_path, strlen(file_path));
+
+  // Reuse the cached file if a prior load already wrote it. The length is part
+  // of the name but is checked again to skip files truncated by a full disk.
+  struct stat s;
+  if (stat(file_path, &s) != 0 || (uint64_t)s.st_size != buffer.data_length) {
+    char temp_path[sizeof(file_path) + 8];
+    snprintf(temp_path, sizeof(temp_path), "%s.XXXXXX", file_path);
+    int fd = mkstemp(temp_path);
+    if (fd < 0) {
+      IREE_TRACE_ZONE_END(z0);
+      return iree_make_status(IREE_STATUS_UNAVAILABLE,
+                              "unable to create dylib cache file (%d)", errno);
+    }
+    iree_status_t status = iree_dynamic_library_write_fd(fd, buffer);
+    if (close(fd) != 0 && iree_status_is_ok(status)) {
+      status = iree_make_status(iree_status_code_from_errno(errno),
+                                "unable to close dylib cache file");
+    }
+    if (iree_status_is_ok(status) && rename(temp_path, file_path) != 0) {
+      status = iree_make_status(iree_status_code_from_errno(errno),
+                                "unable to publish dylib cache file");
+    }
+    if (!iree_status_is_ok(status)) {
+      remove(temp_path);
+      iree_status_ignore(status);
+      IREE_TRACE_ZONE_END(z0);
+      return iree_make_status(IREE_STATUS_UNAVAILABLE,
+                              "unable to populate dylib cache '%s'",
+                              file_path);
+    }
+  }
+
+  iree_status_t status = iree_dynamic_library_load_from_file(
+      file_path, flags, allocator, out_library);
+  IREE_TRACE_ZONE_END(z0);
+  return status;
+}
+
+#if defined(IREE_DYNAMIC_LIBRARY_HAVE_MEMFD)
+
+// Writes |buffer| into an anonymous in-memory file and loads the library from
+// it via its /proc/self/fd/ path. This avoids touching the filesystem and
+// leaves nothing behind if the process dies. Returns IREE_STATUS_UNAVAILABLE
+// if the kernel doesn't support memfd_create or the loader refuses the file
+// (such as when memfd execution is disabled by policy) so that callers can
+// fall back to temp files.
+static iree_status_t iree_dynamic_library_load_from_memfd(
+    iree_string_view_t identifier, iree_const_byte_span_t buffer,
+    iree_dynamic_library_flags_t flags, iree_allocator_t allocator,
+    iree_dynamic_library_t** out_library) {
+  IREE_TRACE_ZONE_BEGIN(z0);
+
+  // The name is only used for debugging (it shows up in /proc/self/maps).
+  char name[64];
+  snprintf(name, sizeof(name), "iree_dylib_%.*s", (int)identifier.size,
+           identifier.data);
+  int fd = (int)syscall(SYS_memfd_create, name,
+                        IREE_DYNAMIC_LIBRARY_MFD_CLOEXEC);
+  if (fd < 0) {
+    IREE_TRACE_ZONE_END(z0);
+    return iree_make_status(IREE_STATUS_UNAVAILABLE,
+                            "memfd_create unavailable (%d)", errno);
+  }
+
+  iree_status_t status = iree_dynamic_library_write_fd(fd, buffer);
+
+  void* handle = NULL;
+  if (iree_status_is_ok(status)) {
+    char fd_path[32];
+    snprintf(fd_path, sizeof(fd_path), "/proc/self/fd/%d", fd);
+    handle = dlopen(fd_path, RTLD_LAZY | RTLD_LOCAL);
+    if (!handle) {
+      status = iree_make_status(IREE_STATUS_UNAVAILABLE,
+                                "dlopen of memfd failed: %s", dlerror());
+    }
+  }
+
+  iree_dynamic_library_t* library = NULL;
+  if (iree_status_is_ok(status)) {
+    status = iree_dynamic_library_create(handle, allocator, &library);
+    if (!iree_status_is_ok(status)) dlclose(handle);
+  }
+
+  if (iree_status_is_ok(status)) {
+    library->memfd = fd;
+    *out_library = library;
+  } else {
+    close(fd);
+  }
+  IREE_TRACE_ZONE_END(z0);
+  return status;
 }
 
-// TODO(#3845): use dlopen on an fd with either dlopen(/proc/self/fd/NN),
-// fdlopen, or android_dlopen_ext to avoid needing to write the file to disk.
-// Can fallback to memfd_create + dlopen where available, and fallback from
-// that to disk (maybe just windows/mac).
+#endif  // IREE_DYNAMIC_LIBRARY_HAVE_MEMFD
+
 iree_status_t iree_dynamic_library_load_from_memory(
     iree_string_view_t identifier, iree_const_byte_span_t buffer,
     iree_dynamic_library_flags_t flags, iree_allocator_t allocator,
@@ -236,7 +412,34 @@ iree_status_t iree_dynamic_library_load_from_memory(
   iree_call_once(&iree_dynamic_library_temp_dir_init_once_flag_,
                  iree_dynamic_library_init_temp_dir);
 
+  // Use the persistent cache when configured so that the library is only
+  // written out once across process lifetimes.
+  if (iree_dynamic_library_cache_dir_path_) {
+    iree_status_t status = iree_dynamic_library_load_from_cache(
+        buffer, flags, allocator, out_library);
+    if (!iree_status_is_unavailable(status)) {
+      IREE_TRACE_ZONE_END(z0);
+      return status;
+    }
+    iree_status_ignore(status);
+  }
+
+#if defined(IREE_DYNAMIC_LIBRARY_HAVE_MEMFD)
+  // Prefer loading directly from memory unless the user has asked for the
+  // temp files to be preserved for tooling to access.
+  if (!iree_dynamic_library_temp_dir_preserve_) {
+    iree_status_t status = iree_dynamic_library_load_from_memfd(
+        identifier, buffer, flags, allocator, out_library);
+    if (!iree_status_is_unavailable(status)) {
+      IREE_TRACE_ZONE_END(z0);
+      return status;
+    }
+    iree_status_ignore(status);
+  }
+#endif  // IREE_DYNAMIC_LIBRARY_HAVE_MEMFD
+
   if (!iree_dynamic_library_temp_dir_valid_) {
+    IREE_TRACE_ZONE_END(z0);
     return iree_make_status(
         IREE_STATUS_INVALID_ARGUMENT,
         "path of dylib temp files (%s) is not the path of a directory",
@@ -283,6 +486,9 @@ static void iree_dynamic_library_delete(iree_dynamic_library_t* library) {
   if (library->handle != NULL) {
     dlclose(library->handle);
   }
+  if (library->memfd != -1) {
+    close(library->memfd);
+  }
 #endif  // IREE_TRACING_FEATURES & IREE_TRACING_FEATURE_INSTRUMENTATION
 
   iree_allocator_free(allocator, library);
@@ -21,14 +21,15 @@ struct iree_event_pool_t {
   // relatively low contention: callers are rate limited by how fast they can
   // signal and wait on the events they get.
   iree_slim_mutex_t mutex;
-  // Maximum number of events that will be maintained in the pool. More events
-  // may be allocated at any time but when they are no longer needed they will
-  // be disposed directly.
+  // Number of events that can be stored in |available_list|. The list grows
+  // as events are released while it is full such that the pool retains the
+  // high-water mark of events in use and steady-state usage never needs to
+  // create or destroy events.
   iree_host_size_t available_capacity;
   // Total number of available
   iree_host_size_t available_count;
   // Dense left-aligned list of available_count events.
-  iree_event_t available_list[];
+  iree_event_t* available_list;
 };
 
 iree_status_t iree_event_pool_allocate(iree_host_size_t available_capacity,
@@ -39,22 +40,26 @@ iree_status_t iree_event_pool_allocate(iree_host_size_t available_capacity,
   IREE_TRACE_ZONE_BEGIN(z0);
 
   iree_event_pool_t* event_pool = NULL;
-  iree_host_size_t total_size =
-      sizeof(*event_pool) +
-      available_capacity * sizeof(event_pool->available_list[0]);
   IREE_RETURN_AND_END_ZONE_IF_ERROR(
-      z0,
-      iree_allocator_malloc(host_allocator, total_size, (void**)&event_pool));
+      z0, iree_allocator_malloc(host_allocator, sizeof(*event_pool),
+                                (void**)&event_pool));
   event_pool->host_allocator = host_allocator;
+  iree_slim_mutex_initialize(&event_pool->mutex);
   event_pool->available_capacity = available_capacity;
   event_pool->available_count = 0;
 
   iree_status_t status = iree_ok_status();
-  for (iree_host_size_t i = 0; i < available_capacity; ++i) {
+  if (available_capacity > 0) {
+    status = iree_allocator_malloc(
+        host_allocator, available_capacity * sizeof(iree_event_t),
+        (void**)&event_pool->available_list);
+  }
+  for (iree_host_size_t i = 0;
+       i < available_capacity && iree_status_is_ok(status); ++i) {
     status = iree_event_initialize(
         /*initial_state=*/false,
-        &event_pool->available_list[event_pool->available_count++]);
-    if (!iree_status_is_ok(status)) break;
+        &event_pool->available_list[event_pool->available_count]);
+    if (iree_status_is_ok(status)) ++event_pool->available_count;
   }
 
   if (iree_status_is_ok(status)) {
@@ -73,12 +78,35 @@ void iree_event_pool_free(iree_event_pool_t* event_pool) {
   for (iree_host_size_t i = 0; i < event_pool->available_count; ++i) {
     iree_event_deinitialize(&event_pool->available_list[i]);
   }
+  iree_allocator_free(host_allocator, event_pool->available_list);
   iree_slim_mutex_deinitialize(&event_pool->mutex);
   iree_allocator_free(host_allocator, event_pool);
 
   IREE_TRACE_ZONE_END(z0);
 }
 
+// Grows the available list to hold at least |minimum_capacity| events.
+// Growth is geometric so that the pool quickly reaches the high-water mark of
+// events in use. If growth fails the list is left as-is and callers will
+// dispose of any events that don't fit.
+static void iree_event_pool_reserve_locked(iree_event_pool_t* event_pool,
+                                           iree_host_size_t minimum_capacity) {
+  if (minimum_capacity <= event_pool->available_capacity) return;
+  IREE_TRACE_ZONE_BEGIN(z0);
+  iree_host_size_t new_capacity =
+      iree_max(minimum_capacity, event_pool->available_capacity * 2);
+  IREE_TRACE_ZONE_APPEND_VALUE(z0, new_capacity);
+  iree_status_t status = iree_allocator_realloc(
+      event_pool->host_allocator, new_capacity * sizeof(iree_event_t),
+      (void**)&event_pool->available_list);
+  if (iree_status_is_ok(status)) {
+    event_pool->available_capacity = new_capacity;
+  } else {
+    iree_status_ignore(status);
+  }
+  IREE_TRACE_ZONE_END(z0);
+}
+
 iree_status_t iree_event_pool_acquire(iree_event_pool_t* event_pool,
                                       iree_host_size_t event_count,
                                       iree_event_t* out_events) {
@@ -139,6 +167,8 @@ void iree_event_pool_release(iree_event_pool_t* event_pool,
   // Note that we reset the events we add back to the pool so that they are
   // ready to be acquired again.
   iree_slim_mutex_lock(&event_pool->mutex);
+  iree_event_pool_reserve_locked(event_pool,
+                                 event_pool->available_count + event_count);
   iree_host_size_t to_pool_count =
       iree_min(event_pool->available_capacity - event_pool->available_count,
                event_count);
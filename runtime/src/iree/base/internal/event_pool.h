@@ -16,10 +16,15 @@ extern "C" {
 
 // A simple pool of iree_event_ts to recycle.
 //
+// The pool grows to retain every event released back to it so that it holds
+// the high-water mark of events in use. Once warmed up acquiring and releasing
+// events never creates or destroys operating system objects.
+//
 // Thread-safe; multiple threads may acquire and release events from the pool.
 typedef struct iree_event_pool_t iree_event_pool_t;
 
-// Allocates a new event pool with up to |available_capacity| events.
+// Allocates a new event pool with |available_capacity| events ready for use.
+// The pool grows beyond the initial capacity as required.
 iree_status_t iree_event_pool_allocate(iree_host_size_t available_capacity,
                                        iree_allocator_t host_allocator,
                                        iree_event_pool_t** out_event_pool);
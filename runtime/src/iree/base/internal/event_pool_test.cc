@@ -0,0 +1,70 @@
+// Copyright 2023 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include "iree/base/internal/event_pool.h"
+
+#include <vector>
+
+#include "iree/testing/gtest.h"
+#include "iree/testing/status_matchers.h"
+
+namespace {
+
+TEST(EventPoolTest, AcquireRelease) {
+  iree_event_pool_t* event_pool = NULL;
+  IREE_ASSERT_OK(iree_event_pool_allocate(/*available_capacity=*/2,
+                                          iree_allocator_system(), &event_pool));
+
+  iree_event_t events[2];
+  IREE_ASSERT_OK(iree_event_pool_acquire(event_pool, IREE_ARRAYSIZE(events),
+                                         events));
+  iree_event_set(&events[0]);
+  iree_event_pool_release(event_pool, IREE_ARRAYSIZE(events), events);
+
+  // Events are reset when returned to the pool.
+  IREE_ASSERT_OK(iree_event_pool_acquire(event_pool, IREE_ARRAYSIZE(events),
+                                         events));
+  for (auto& event : events) {
+    IREE_EXPECT_STATUS_IS(IREE_STATUS_DEADLINE_EXCEEDED,
+                          iree_wait_one(&event, IREE_TIME_INFINITE_PAST));
+  }
+  iree_event_pool_release(event_pool, IREE_ARRAYSIZE(events), events);
+
+  iree_event_pool_free(event_pool);
+}
+
+// Tests that acquiring more events than the initial capacity grows the pool
+// such that all events are retained and reused after they are released.
+TEST(EventPoolTest, GrowToHighWaterMark) {
+  iree_event_pool_t* event_pool = NULL;
+  IREE_ASSERT_OK(iree_event_pool_allocate(/*available_capacity=*/1,
+                                          iree_allocator_system(), &event_pool));
+
+  std::vector<iree_event_t> events(33);
+  for (int round = 0; round < 3; ++round) {
+    for (auto& event : events) {
+      IREE_ASSERT_OK(iree_event_pool_acquire(event_pool, 1, &event));
+    }
+    iree_event_set(&events.back());
+    for (auto& event : events) {
+      iree_event_pool_release(event_pool, 1, &event);
+    }
+  }
+
+  // A bulk acquire of the high-water mark is serviced from the pool and the
+  // events all come back reset.
+  IREE_ASSERT_OK(
+      iree_event_pool_acquire(event_pool, events.size(), events.data()));
+  for (auto& event : events) {
+    IREE_EXPECT_STATUS_IS(IREE_STATUS_DEADLINE_EXCEEDED,
+                          iree_wait_one(&event, IREE_TIME_INFINITE_PAST));
+  }
+  iree_event_pool_release(event_pool, events.size(), events.data());
+
+  iree_event_pool_free(event_pool);
+}
+
+}  // namespace
@@ -26,6 +26,16 @@
 #define IREE_SET_BINARY_MODE(handle) ((void)0)
 #endif  // IREE_PLATFORM_WINDOWS
 
+#if defined(IREE_PLATFORM_WINDOWS)
+#define IREE_FILE_IO_HAVE_MAPPING 1
+#elif defined(IREE_PLATFORM_ANDROID) || defined(IREE_PLATFORM_APPLE) || \
+    defined(IREE_PLATFORM_LINUX)
+#define IREE_FILE_IO_HAVE_MAPPING 1
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#endif  // IREE_PLATFORM_*
+
 // We could take alignment as an arg, but roughly page aligned should be
 // acceptable for all uses - if someone cares about memory usage they won't
 // be using this method.
@@ -99,8 +109,7 @@ iree_status_t iree_file_contents_allocator_ctl(void* self,
     return iree_make_status(IREE_STATUS_INVALID_ARGUMENT,
                             "only the file contents buffer is valid");
   }
-  iree_allocator_t allocator = contents->allocator;
-  iree_allocator_free(allocator, contents);
+  iree_file_contents_free(contents);
   return iree_ok_status();
 }
 
@@ -113,9 +122,12 @@ iree_allocator_t iree_file_contents_deallocator(
   return allocator;
 }
 
+static void iree_file_contents_unmap(iree_file_contents_t* contents);
+
 void iree_file_contents_free(iree_file_contents_t* contents) {
   if (!contents) return;
   IREE_TRACE_ZONE_BEGIN(z0);
+  if (contents->mapped) iree_file_contents_unmap(contents);
   iree_allocator_free(contents->allocator, contents);
   IREE_TRACE_ZONE_END(z0);
 }
@@ -149,7 +161,7 @@ static iree_status_t iree_file_read_contents_impl(
   contents->buffer.data_length = file_size;
 
   // Attempt to read the file into memory.
-  if (fread(contents->buffer.data, file_size, 1, file) != 1) {
+  if (file_size > 0 && fread(contents->buffer.data, file_size, 1, file) != 1) {
     iree_allocator_free(allocator, contents);
     return iree_make_status(iree_status_code_from_errno(errno),
                             "unable to read entire %zu file bytes", file_size);
@@ -189,6 +201,159 @@ iree_status_t iree_file_read_contents(const char* path,
   return status;
 }
 
+#if defined(IREE_PLATFORM_WINDOWS)
+
+static iree_status_t iree_file_map_contents_impl(
+    const char* path, iree_allocator_t allocator,
+    iree_file_contents_t** out_contents) {
+  HANDLE file = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, NULL,
+                            OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+  if (file == INVALID_HANDLE_VALUE) {
+    return iree_make_status(iree_status_code_from_win32_error(GetLastError()),
+                            "failed to open file '%s'", path);
+  }
+
+  LARGE_INTEGER file_length;
+  if (!GetFileSizeEx(file, &file_length)) {
+    iree_status_t status = iree_make_status(
+        iree_status_code_from_win32_error(GetLastError()), "size query");
+    CloseHandle(file);
+    return status;
+  }
+  if ((uint64_t)file_length.QuadPart > IREE_HOST_SIZE_MAX) {
+    CloseHandle(file);
+    return iree_make_status(IREE_STATUS_RESOURCE_EXHAUSTED,
+                            "file length exceeds host address range");
+  }
+  if (file_length.QuadPart == 0) {
+    // Empty files cannot be mapped.
+    CloseHandle(file);
+    return iree_file_read_contents(path, allocator, out_contents);
+  }
+
+  // The mapping object keeps the file referenced after we close our handle.
+  HANDLE mapping = CreateFileMappingA(file, NULL, PAGE_READONLY, 0, 0, NULL);
+  CloseHandle(file);
+  if (!mapping) {
+    return iree_make_status(iree_status_code_from_win32_error(GetLastError()),
+                            "failed to create file mapping");
+  }
+  void* base_ptr = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+  if (!base_ptr) {
+    iree_status_t status =
+        iree_make_status(iree_status_code_from_win32_error(GetLastError()),
+                         "failed to map file view");
+    CloseHandle(mapping);
+    return status;
+  }
+
+  iree_file_contents_t* contents = NULL;
+  iree_status_t status =
+      iree_allocator_malloc(allocator, sizeof(*contents), (void**)&contents);
+  if (!iree_status_is_ok(status)) {
+    UnmapViewOfFile(base_ptr);
+    CloseHandle(mapping);
+    return status;
+  }
+  contents->allocator = allocator;
+  contents->buffer.data = (uint8_t*)base_ptr;
+  contents->buffer.data_length = (iree_host_size_t)file_length.QuadPart;
+  contents->mapped = true;
+  contents->mapping_handle = mapping;
+  *out_contents = contents;
+  return iree_ok_status();
+}
+
+static void iree_file_contents_unmap(iree_file_contents_t* contents) {
+  UnmapViewOfFile(contents->buffer.data);
+  CloseHandle((HANDLE)contents->mapping_handle);
+}
+
+#elif defined(IREE_FILE_IO_HAVE_MAPPING)
+
+static iree_status_t iree_file_map_contents_impl(
+    const char* path, iree_allocator_t allocator,
+    iree_file_contents_t** out_contents) {
+  int fd = open(path, O_RDONLY | O_CLOEXEC);
+  if (fd == -1) {
+    return iree_make_status(iree_status_code_from_errno(errno),
+                            "failed to open file '%s'", path);
+  }
+
+  struct stat stat_buf;
+  if (fstat(fd, &stat_buf) == -1) {
+    iree_status_t status =
+        iree_make_status(iree_status_code_from_errno(errno), "size query");
+    close(fd);
+    return status;
+  }
+  if ((uint64_t)stat_buf.st_size > IREE_HOST_SIZE_MAX) {
+    close(fd);
+    return iree_make_status(IREE_STATUS_RESOURCE_EXHAUSTED,
+                            "file length exceeds host address range");
+  }
+  iree_host_size_t file_size = (iree_host_size_t)stat_buf.st_size;
+  if (file_size == 0) {
+    // Empty files cannot be mapped.
+    close(fd);
+    return iree_file_read_contents(path, allocator, out_contents);
+  }
+
+  // The mapping keeps the file referenced after we close the descriptor.
+  void* base_ptr = mmap(NULL, file_size, PROT_READ, MAP_SHARED, fd, 0);
+  close(fd);
+  if (base_ptr == MAP_FAILED) {
+    return iree_make_status(iree_status_code_from_errno(errno),
+                            "failed to map %zu file bytes", file_size);
+  }
+
+  iree_file_contents_t* contents = NULL;
+  iree_status_t status =
+      iree_allocator_malloc(allocator, sizeof(*contents), (void**)&contents);
+  if (!iree_status_is_ok(status)) {
+    munmap(base_ptr, file_size);
+    return status;
+  }
+  contents->allocator = allocator;
+  contents->buffer.data = (uint8_t*)base_ptr;
+  contents->buffer.data_length = file_size;
+  contents->mapped = true;
+  *out_contents = contents;
+  return iree_ok_status();
+}
+
+static void iree_file_contents_unmap(iree_file_contents_t* contents) {
+  munmap(contents->buffer.data, contents->buffer.data_length);
+}
+
+#else
+
+static iree_status_t iree_file_map_contents_impl(
+    const char* path, iree_allocator_t allocator,
+    iree_file_contents_t** out_contents) {
+  return iree_file_read_contents(path, allocator, out_contents);
+}
+
+static void iree_file_contents_unmap(iree_file_contents_t* contents) {}
+
+#endif  // IREE_PLATFORM_WINDOWS
+
+iree_status_t iree_file_map_contents(const char* path,
+                                     iree_allocator_t allocator,
+                                     iree_file_contents_t** out_contents) {
+  IREE_TRACE_ZONE_BEGIN(z0);
+  IREE_ASSERT_ARGUMENT(path);
+  IREE_ASSERT_ARGUMENT(out_contents);
+  *out_contents = NULL;
+  iree_status_t status =
+      iree_file_map_contents_impl(path, allocator, out_contents);
+  if (!iree_status_is_ok(status)) {
+    status = iree_status_annotate_f(status, "mapping file '%s'", path);
+  }
+  IREE_TRACE_ZONE_END(z0);
+  return status;
+}
+
 iree_status_t iree_file_write_contents(const char* path,
                                        iree_const_byte_span_t content) {
   IREE_TRACE_ZONE_BEGIN(z0);
@@ -300,6 +465,12 @@ iree_status_t iree_file_read_contents(const char* path,
   return iree_make_status(IREE_STATUS_UNAVAILABLE, "File I/O is disabled");
 }
 
+iree_status_t iree_file_map_contents(const char* path,
+                                     iree_allocator_t allocator,
+                                     iree_file_contents_t** out_contents) {
+  return iree_make_status(IREE_STATUS_UNAVAILABLE, "File I/O is disabled");
+}
+
 iree_status_t iree_file_write_contents(const char* path,
                                        iree_const_byte_span_t content) {
   return iree_make_status(IREE_STATUS_UNAVAILABLE, "File I/O is disabled");
@@ -36,6 +36,12 @@ typedef struct iree_file_contents_t {
     iree_byte_span_t buffer;
     iree_const_byte_span_t const_buffer;
   };
+  // True if |buffer| is a read-only mapping of the file created by
+  // iree_file_map_contents. Writing to mapped contents will fault.
+  bool mapped;
+  // Platform handle of the file mapping object, if one is required to keep
+  // the mapping alive.
+  void* mapping_handle;
 } iree_file_contents_t;
 
 // Returns an allocator that deallocates the |contents|.
@@ -54,6 +60,24 @@ iree_status_t iree_file_read_contents(const char* path,
                                       iree_allocator_t allocator,
                                       iree_file_contents_t** out_contents);
 
+// Maps a file's contents into memory read-only.
+//
+// Returns the contents of the file in |out_contents| as a view of the
+// operating system page cache: no copy is made and pages are only made
+// resident as they are accessed. This is preferred over iree_file_read_contents
+// for large files such as modules with embedded constants that are referenced
+// in-place. The contents are page aligned and are not NUL terminated.
+//
+// Platforms that do not support file mapping (and empty files, which cannot be
+// mapped) fall back to iree_file_read_contents.
+//
+// |allocator| is used to allocate the contents wrapper and the caller must use
+// iree_file_contents_free to unmap the file. The file must not be truncated
+// while mapped.
+iree_status_t iree_file_map_contents(const char* path,
+                                     iree_allocator_t allocator,
+                                     iree_file_contents_t** out_contents);
+
 // Synchronously writes a byte buffer into a file.
 // Existing contents are overwritten.
 iree_status_t iree_file_write_contents(const char* path,
@@ -24,22 +24,36 @@
 // https://github.com/petewarden/tensorflow_makefile/blob/master/tensorflow/core/platform/denormal.cc
 // https://chromium.googlesource.com/chromium/blink/+/master/Source/platform/audio/DenormalDisabler.h
 
-static uint64_t iree_fpu_state_set_dtz(uint64_t state, bool denormals_to_zero);
+static uint64_t iree_fpu_state_set_dtz(uint64_t state,
+                                       iree_fpu_state_flags_t flags);
 
 #if defined(IREE_ARCH_ARM_32)
-static uint64_t iree_fpu_state_set_dtz(uint64_t state, bool denormals_to_zero) {
-  return (state & ~0x1000000) | (denormals_to_zero ? 0x1000000 : 0);
+static uint64_t iree_fpu_state_set_dtz(uint64_t state,
+                                       iree_fpu_state_flags_t flags) {
+  // FZ covers both inputs and results.
+  return (state & ~0x1000000) |
+         ((flags & IREE_FPU_STATE_FLAG_FLUSH_DENORMALS_TO_ZERO) ? 0x1000000
+                                                                 : 0);
 }
 #elif defined(IREE_ARCH_ARM_64)
-static uint64_t iree_fpu_state_set_dtz(uint64_t state, bool denormals_to_zero) {
-  return (state & ~0x1080000) | (denormals_to_zero ? 0x1080000 : 0);
+static uint64_t iree_fpu_state_set_dtz(uint64_t state,
+                                       iree_fpu_state_flags_t flags) {
+  // FZ (and FZ16 for half-precision) cover both inputs and results.
+  return (state & ~0x1080000) |
+         ((flags & IREE_FPU_STATE_FLAG_FLUSH_DENORMALS_TO_ZERO) ? 0x1080000
+                                                                 : 0);
 }
 #elif defined(IREE_ARCH_X86_32) || defined(IREE_ARCH_X86_64)
-static uint64_t iree_fpu_state_set_dtz(uint64_t state, bool denormals_to_zero) {
-  return (state & ~0x8040) | (denormals_to_zero ? 0x8040 : 0);
+static uint64_t iree_fpu_state_set_dtz(uint64_t state,
+                                       iree_fpu_state_flags_t flags) {
+  // MXCSR FTZ (bit 15) and DAZ (bit 6).
+  return (state & ~0x8040) |
+         ((flags & IREE_FPU_STATE_FLAG_FLUSH_TO_ZERO) ? 0x8000 : 0) |
+         ((flags & IREE_FPU_STATE_FLAG_DENORMALS_ARE_ZERO) ? 0x0040 : 0);
 }
 #else
-static uint64_t iree_fpu_state_set_dtz(uint64_t state, bool denormals_to_zero) {
+static uint64_t iree_fpu_state_set_dtz(uint64_t state,
+                                       iree_fpu_state_flags_t flags) {
   return state;
 }
 #endif  // IREE_ARCH_*
@@ -92,15 +106,22 @@ static void iree_fpu_store_state(uint64_t state) {}
 iree_fpu_state_t iree_fpu_state_push(iree_fpu_state_flags_t flags) {
   iree_fpu_state_t state;
   state.current_value = state.previous_value = iree_fpu_load_state();
-  state.current_value = iree_fpu_state_set_dtz(
-      state.current_value,
-      (flags & IREE_FPU_STATE_FLAG_FLUSH_DENORMALS_TO_ZERO) ? true : false);
+  state.current_value = iree_fpu_state_set_dtz(state.current_value, flags);
   if (state.previous_value != state.current_value) {
     iree_fpu_store_state(state.current_value);
   }
   return state;
 }
 
+void iree_fpu_state_update(iree_fpu_state_t* state,
+                           iree_fpu_state_flags_t flags) {
+  uint64_t new_value = iree_fpu_state_set_dtz(state->current_value, flags);
+  if (new_value != state->current_value) {
+    iree_fpu_store_state(new_value);
+    state->current_value = new_value;
+  }
+}
+
 void iree_fpu_state_pop(iree_fpu_state_t state) {
   if (state.previous_value != state.current_value) {
     iree_fpu_store_state(state.previous_value);
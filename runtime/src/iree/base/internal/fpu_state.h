@@ -26,6 +26,15 @@ enum iree_fpu_state_flag_bits_t {
   // Platform default.
   IREE_FPU_STATE_DEFAULT = 0,
 
+  // Flushes denormal results of floating-point operations to zero
+  // (flush-to-zero/FTZ).
+  IREE_FPU_STATE_FLAG_FLUSH_TO_ZERO = 1 << 0,
+
+  // Treats denormal inputs to floating-point operations as zero
+  // (denormals-are-zero/DAZ). Architectures that control both inputs and
+  // results with a single bit (such as ARM) set it if either flag is set.
+  IREE_FPU_STATE_FLAG_DENORMALS_ARE_ZERO = 1 << 1,
+
   // Denormals can cause some serious slowdowns in certain ISAs where they may
   // be implemented in microcode. Flushing them to zero instead of letting them
   // propagate ensures that the slow paths aren't hit. This is a fast-math style
@@ -34,7 +43,9 @@ enum iree_fpu_state_flag_bits_t {
   // https://en.wikipedia.org/wiki/Denormal_number
   // https://carlh.net/plugins/denormals.php
   // https://www.xspdf.com/resolution/50507310.html
-  IREE_FPU_STATE_FLAG_FLUSH_DENORMALS_TO_ZERO = 1 << 0,
+  IREE_FPU_STATE_FLAG_FLUSH_DENORMALS_TO_ZERO =
+      IREE_FPU_STATE_FLAG_FLUSH_TO_ZERO |
+      IREE_FPU_STATE_FLAG_DENORMALS_ARE_ZERO,
 };
 typedef uint32_t iree_fpu_state_flags_t;
 
@@ -48,6 +59,14 @@ typedef struct iree_fpu_state_t {
 // May lead to a pipeline flush; avoid if possible.
 iree_fpu_state_t iree_fpu_state_push(iree_fpu_state_flags_t flags);
 
+// Changes the FPU state of the thread established by a prior
+// iree_fpu_state_push of |state| to |flags|. The control register is only
+// written if the value differs from the current one so this is cheap to call
+// per unit of work when the flags rarely change. A later iree_fpu_state_pop
+// still restores the state from before the push.
+void iree_fpu_state_update(iree_fpu_state_t* state,
+                           iree_fpu_state_flags_t flags);
+
 // Restores the FPU state of the thread to its original value.
 // May lead to a pipeline flush; avoid if possible.
 void iree_fpu_state_pop(iree_fpu_state_t state);
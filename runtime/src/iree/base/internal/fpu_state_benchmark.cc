@@ -121,4 +121,30 @@ void BM_VectorizedDenormalsNotFlushedToZero(benchmark::State& state) {
 }
 BENCHMARK(BM_VectorizedDenormalsNotFlushedToZero);
 
+// Cost of switching the FPU state around each unit of work.
+void BM_PushPopPerIteration(benchmark::State& state) {
+  iree_fpu_state_t outer_state = iree_fpu_state_push(IREE_FPU_STATE_DEFAULT);
+  for (auto _ : state) {
+    iree_fpu_state_t fpu_state =
+        iree_fpu_state_push(IREE_FPU_STATE_FLAG_FLUSH_DENORMALS_TO_ZERO);
+    benchmark::DoNotOptimize(fpu_state);
+    iree_fpu_state_pop(fpu_state);
+  }
+  iree_fpu_state_pop(outer_state);
+}
+BENCHMARK(BM_PushPopPerIteration);
+
+// Cost of requesting an unchanged FPU state for each unit of work.
+void BM_UpdateUnchangedPerIteration(benchmark::State& state) {
+  iree_fpu_state_t fpu_state =
+      iree_fpu_state_push(IREE_FPU_STATE_FLAG_FLUSH_DENORMALS_TO_ZERO);
+  for (auto _ : state) {
+    iree_fpu_state_update(&fpu_state,
+                          IREE_FPU_STATE_FLAG_FLUSH_DENORMALS_TO_ZERO);
+    benchmark::DoNotOptimize(fpu_state);
+  }
+  iree_fpu_state_pop(fpu_state);
+}
+BENCHMARK(BM_UpdateUnchangedPerIteration);
+
 }  // namespace
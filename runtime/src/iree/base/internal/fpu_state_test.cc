@@ -25,4 +25,29 @@ TEST(FPUStateTest, FlushDenormalsToZero) {
   iree_fpu_state_pop(fpu_state);
 }
 
+// Tests that updating a pushed state changes the mode and that popping
+// restores the state from before the push regardless of updates.
+TEST(FPUStateTest, Update) {
+  iree_fpu_state_t outer_state = iree_fpu_state_push(IREE_FPU_STATE_DEFAULT);
+  float f = 1.0f;
+  volatile float* fp = &f;
+
+  iree_fpu_state_t fpu_state =
+      iree_fpu_state_push(IREE_FPU_STATE_FLAG_FLUSH_DENORMALS_TO_ZERO);
+  iree_fpu_state_update(&fpu_state, IREE_FPU_STATE_DEFAULT);
+  iree_fpu_state_update(&fpu_state,
+                        IREE_FPU_STATE_FLAG_FLUSH_DENORMALS_TO_ZERO);
+  *fp = 1.0f;
+  *fp = *fp * 1e-39f;
+  EXPECT_EQ(0.0f, f);
+  iree_fpu_state_pop(fpu_state);
+
+  // The state must match what it was before the push.
+  iree_fpu_state_t restored_state = iree_fpu_state_push(IREE_FPU_STATE_DEFAULT);
+  EXPECT_EQ(restored_state.previous_value, outer_state.current_value);
+  iree_fpu_state_pop(restored_state);
+
+  iree_fpu_state_pop(outer_state);
+}
+
 }  // namespace
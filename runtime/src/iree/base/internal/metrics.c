@@ -0,0 +1,118 @@
+// Copyright 2023 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include "iree/base/internal/metrics.h"
+
+#include <inttypes.h>
+#include <string.h>
+
+#include "iree/base/internal/math.h"
+
+// Head of the intrusive list of registered metrics. Metrics are only ever
+// pushed on the front so readers can walk the list without locking.
+static iree_atomic_intptr_t iree_metrics_head = IREE_ATOMIC_VAR_INIT(0);
+
+void iree_metric_register(iree_metric_t* metric) {
+  int32_t expected = 0;
+  if (!iree_atomic_compare_exchange_strong_int32(
+          &metric->registered, &expected, 1, iree_memory_order_acq_rel,
+          iree_memory_order_relaxed /* expected is unused */)) {
+    return;  // registered by another thread
+  }
+  intptr_t head = iree_atomic_load_intptr(&iree_metrics_head,
+                                          iree_memory_order_acquire);
+  do {
+    metric->next = (iree_metric_t*)head;
+  } while (!iree_atomic_compare_exchange_weak_intptr(
+      &iree_metrics_head, &head, (intptr_t)metric, iree_memory_order_release,
+      iree_memory_order_acquire));
+}
+
+iree_host_size_t iree_metric_histogram_bucket(int64_t value) {
+  if (value <= 1) return 0;
+  // Smallest i with value <= 2^i.
+  iree_host_size_t bucket =
+      64 - iree_math_count_leading_zeros_u64((uint64_t)value - 1);
+  return iree_min(bucket, IREE_METRIC_HISTOGRAM_BUCKET_COUNT - 1);
+}
+
+static void iree_metric_snapshot(iree_metric_t* metric,
+                                 iree_metric_snapshot_t* out_snapshot) {
+  memset(out_snapshot, 0, sizeof(*out_snapshot));
+  out_snapshot->name = metric->name;
+  out_snapshot->help = metric->help;
+  out_snapshot->type = metric->type;
+  out_snapshot->value =
+      iree_atomic_load_int64(&metric->value, iree_memory_order_relaxed);
+  if (metric->type != IREE_METRIC_TYPE_HISTOGRAM) return;
+  for (iree_host_size_t i = 0; i < IREE_METRIC_HISTOGRAM_BUCKET_COUNT; ++i) {
+    out_snapshot->count +=
+        iree_atomic_load_int64(&metric->buckets[i], iree_memory_order_relaxed);
+    out_snapshot->cumulative_buckets[i] = out_snapshot->count;
+  }
+}
+
+void iree_metrics_enumerate(iree_metric_enumerate_fn_t fn, void* user_data) {
+  iree_metric_t* metric = (iree_metric_t*)iree_atomic_load_intptr(
+      &iree_metrics_head, iree_memory_order_acquire);
+  for (; metric != NULL; metric = metric->next) {
+    iree_metric_snapshot_t snapshot;
+    iree_metric_snapshot(metric, &snapshot);
+    fn(user_data, &snapshot);
+  }
+}
+
+typedef struct iree_metrics_prometheus_state_t {
+  iree_string_builder_t* builder;
+  iree_status_t status;
+} iree_metrics_prometheus_state_t;
+
+static iree_status_t iree_metrics_append_prometheus_metric(
+    iree_string_builder_t* builder, const iree_metric_snapshot_t* snapshot) {
+  static const char* type_names[] = {
+      [IREE_METRIC_TYPE_COUNTER] = "counter",
+      [IREE_METRIC_TYPE_GAUGE] = "gauge",
+      [IREE_METRIC_TYPE_HISTOGRAM] = "histogram",
+  };
+  IREE_RETURN_IF_ERROR(iree_string_builder_append_format(
+      builder, "# HELP %s %s\n# TYPE %s %s\n", snapshot->name, snapshot->help,
+      snapshot->name, type_names[snapshot->type]));
+  if (snapshot->type != IREE_METRIC_TYPE_HISTOGRAM) {
+    return iree_string_builder_append_format(
+        builder, "%s %" PRIi64 "\n", snapshot->name, snapshot->value);
+  }
+  for (iree_host_size_t i = 0; i < IREE_METRIC_HISTOGRAM_BUCKET_COUNT - 1;
+       ++i) {
+    IREE_RETURN_IF_ERROR(iree_string_builder_append_format(
+        builder, "%s_bucket{le=\"%" PRIu64 "\"} %" PRIi64 "\n", snapshot->name,
+        (uint64_t)1 << i, snapshot->cumulative_buckets[i]));
+  }
+  return iree_string_builder_append_format(
+      builder,
+      "%s_bucket{le=\"+Inf\"} %" PRIi64 "\n%s_sum %" PRIi64
+      "\n%s_count %" PRIi64 "\n",
+      snapshot->name, snapshot->count, snapshot->name, snapshot->value,
+      snapshot->name, snapshot->count);
+}
+
+static void iree_metrics_append_prometheus_callback(
+    void* user_data, const iree_metric_snapshot_t* snapshot) {
+  iree_metrics_prometheus_state_t* state =
+      (iree_metrics_prometheus_state_t*)user_data;
+  if (!iree_status_is_ok(state->status)) return;
+  state->status =
+      iree_metrics_append_prometheus_metric(state->builder, snapshot);
+}
+
+iree_status_t iree_metrics_append_prometheus(iree_string_builder_t* builder) {
+  IREE_ASSERT_ARGUMENT(builder);
+  iree_metrics_prometheus_state_t state = {
+      .builder = builder,
+      .status = iree_ok_status(),
+  };
+  iree_metrics_enumerate(iree_metrics_append_prometheus_callback, &state);
+  return state.status;
+}
@@ -0,0 +1,152 @@
+// Copyright 2023 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#ifndef IREE_BASE_INTERNAL_METRICS_H_
+#define IREE_BASE_INTERNAL_METRICS_H_
+
+#include <stdint.h>
+
+#include "iree/base/api.h"
+#include "iree/base/internal/atomics.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif  // __cplusplus
+
+//===----------------------------------------------------------------------===//
+// Process-wide runtime metrics
+//===----------------------------------------------------------------------===//
+// Lightweight always-on counters, gauges and histograms that can be pulled
+// from production deployments (unlike tracing which requires an instrumented
+// build and a connected tool). Each metric is a statically allocated global in
+// the file that records it and updating one is a single relaxed atomic add.
+//
+// Metrics are registered with the process-wide registry the first time they
+// are recorded and from then on are included in iree_metrics_enumerate and
+// iree_metrics_append_prometheus. Values are never reset.
+//
+// Usage:
+//   IREE_METRIC_DEFINE(my_calls, COUNTER, "iree_my_calls_total",
+//                      "Number of calls made.");
+//   void my_call() { IREE_METRIC_ADD(my_calls, 1); }
+//
+// Metrics can be compiled out by defining IREE_METRICS_ENABLE=0, in which case
+// all of the IREE_METRIC_* macros and IREE_METRICS(...) expand to nothing.
+
+#if !defined(IREE_METRICS_ENABLE)
+#define IREE_METRICS_ENABLE IREE_STATISTICS_ENABLE
+#endif  // !IREE_METRICS_ENABLE
+
+typedef enum iree_metric_type_e {
+  // Monotonically increasing value such as a number of events or bytes.
+  IREE_METRIC_TYPE_COUNTER = 0,
+  // Value that can go up and down such as a number of in-flight operations.
+  IREE_METRIC_TYPE_GAUGE,
+  // Distribution of observed values such as durations.
+  IREE_METRIC_TYPE_HISTOGRAM,
+} iree_metric_type_t;
+
+// Number of buckets in each histogram. Bucket i counts observations in
+// (2^(i-1), 2^i] with the first bucket counting everything <= 1 and the last
+// bucket counting everything larger than the previous bucket bound.
+#define IREE_METRIC_HISTOGRAM_BUCKET_COUNT 32
+
+typedef struct iree_metric_t {
+  // Prometheus-compatible name such as `iree_hal_dispatches_total`.
+  const char* name;
+  // Single line description of the metric.
+  const char* help;
+  iree_metric_type_t type;
+  // Next registered metric; only valid once registered.
+  struct iree_metric_t* next;
+  // Set to 1 by the first thread to register the metric.
+  iree_atomic_int32_t registered;
+  // Counter or gauge value or the sum of all histogram observations.
+  iree_atomic_int64_t value;
+  // Histogram observation counts per bucket; unused for other types.
+  iree_atomic_int64_t buckets[IREE_METRIC_HISTOGRAM_BUCKET_COUNT];
+} iree_metric_t;
+
+// Registers |metric| with the process-wide registry. Called automatically the
+// first time the metric is recorded.
+void iree_metric_register(iree_metric_t* metric);
+
+static inline void iree_metric_ensure_registered(iree_metric_t* metric) {
+  if (IREE_UNLIKELY(!iree_atomic_load_int32(&metric->registered,
+                                            iree_memory_order_relaxed))) {
+    iree_metric_register(metric);
+  }
+}
+
+// Adds |delta| to a counter or gauge.
+static inline void iree_metric_add(iree_metric_t* metric, int64_t delta) {
+  iree_metric_ensure_registered(metric);
+  iree_atomic_fetch_add_int64(&metric->value, delta, iree_memory_order_relaxed);
+}
+
+// Returns the bucket of a histogram holding |value|.
+iree_host_size_t iree_metric_histogram_bucket(int64_t value);
+
+// Records |value| in a histogram.
+static inline void iree_metric_observe(iree_metric_t* metric, int64_t value) {
+  iree_metric_ensure_registered(metric);
+  iree_atomic_fetch_add_int64(&metric->buckets[iree_metric_histogram_bucket(
+                                  value)],
+                              1, iree_memory_order_relaxed);
+  iree_atomic_fetch_add_int64(&metric->value, value, iree_memory_order_relaxed);
+}
+
+// Values of a metric read at a point in time. Histogram bucket counts are
+// cumulative (bucket i counts all observations <= 2^i and the last bucket
+// counts all observations) and |value| is the sum of all observations. As
+// each field is read independently concurrent updates may cause a tear.
+typedef struct iree_metric_snapshot_t {
+  const char* name;
+  const char* help;
+  iree_metric_type_t type;
+  int64_t value;
+  // Total number of histogram observations; 0 for other types.
+  int64_t count;
+  int64_t cumulative_buckets[IREE_METRIC_HISTOGRAM_BUCKET_COUNT];
+} iree_metric_snapshot_t;
+
+typedef void(IREE_API_PTR* iree_metric_enumerate_fn_t)(
+    void* user_data, const iree_metric_snapshot_t* snapshot);
+
+// Calls |fn| with a snapshot of every registered metric.
+void iree_metrics_enumerate(iree_metric_enumerate_fn_t fn, void* user_data);
+
+// Appends all registered metrics to |builder| in the Prometheus text
+// exposition format.
+iree_status_t iree_metrics_append_prometheus(iree_string_builder_t* builder);
+
+#if IREE_METRICS_ENABLE
+
+#define IREE_METRICS(expr) expr
+
+// Defines a file-local metric |var| of the given |type| (COUNTER, GAUGE or
+// HISTOGRAM) named |name|.
+#define IREE_METRIC_DEFINE(var, type, name, help) \
+  static iree_metric_t var = {(name), (help), IREE_METRIC_TYPE_##type}
+
+#define IREE_METRIC_ADD(var, delta) iree_metric_add(&(var), (delta))
+
+#define IREE_METRIC_OBSERVE(var, value) iree_metric_observe(&(var), (value))
+
+#else
+
+#define IREE_METRICS(expr)
+#define IREE_METRIC_DEFINE(var, type, name, help)
+#define IREE_METRIC_ADD(var, delta)
+#define IREE_METRIC_OBSERVE(var, value)
+
+#endif  // IREE_METRICS_ENABLE
+
+#ifdef __cplusplus
+}  // extern "C"
+#endif  // __cplusplus
+
+#endif  // IREE_BASE_INTERNAL_METRICS_H_
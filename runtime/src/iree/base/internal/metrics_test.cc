@@ -0,0 +1,98 @@
+// Copyright 2023 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include "iree/base/internal/metrics.h"
+
+#include <cstring>
+#include <string>
+
+#include "iree/testing/gtest.h"
+#include "iree/testing/status_matchers.h"
+
+#if IREE_METRICS_ENABLE
+
+namespace {
+
+IREE_METRIC_DEFINE(test_counter, COUNTER, "iree_test_counter_total",
+                   "Counter used by metrics_test.");
+IREE_METRIC_DEFINE(test_histogram, HISTOGRAM, "iree_test_histogram",
+                   "Histogram used by metrics_test.");
+IREE_METRIC_DEFINE(test_unused, GAUGE, "iree_test_unused",
+                   "Gauge that is never recorded.");
+
+// Returns a snapshot of the registered metric |name| or a snapshot with a NULL
+// name if it is not registered.
+static iree_metric_snapshot_t FindMetric(const char* name) {
+  struct State {
+    const char* name;
+    iree_metric_snapshot_t snapshot;
+  } state;
+  memset(&state, 0, sizeof(state));
+  state.name = name;
+  iree_metrics_enumerate(
+      [](void* user_data, const iree_metric_snapshot_t* snapshot) {
+        auto* state = reinterpret_cast<State*>(user_data);
+        if (strcmp(snapshot->name, state->name) == 0) {
+          state->snapshot = *snapshot;
+        }
+      },
+      &state);
+  return state.snapshot;
+}
+
+TEST(MetricsTest, HistogramBuckets) {
+  EXPECT_EQ(iree_metric_histogram_bucket(-5), 0);
+  EXPECT_EQ(iree_metric_histogram_bucket(0), 0);
+  EXPECT_EQ(iree_metric_histogram_bucket(1), 0);
+  EXPECT_EQ(iree_metric_histogram_bucket(2), 1);
+  EXPECT_EQ(iree_metric_histogram_bucket(3), 2);
+  EXPECT_EQ(iree_metric_histogram_bucket(4), 2);
+  EXPECT_EQ(iree_metric_histogram_bucket(5), 3);
+  EXPECT_EQ(iree_metric_histogram_bucket(INT64_MAX),
+            IREE_METRIC_HISTOGRAM_BUCKET_COUNT - 1);
+}
+
+TEST(MetricsTest, RegistersOnFirstUse) {
+  IREE_METRIC_ADD(test_counter, 2);
+  IREE_METRIC_ADD(test_counter, 3);
+  iree_metric_snapshot_t snapshot = FindMetric("iree_test_counter_total");
+  ASSERT_NE(snapshot.name, nullptr);
+  EXPECT_EQ(snapshot.type, IREE_METRIC_TYPE_COUNTER);
+  EXPECT_EQ(snapshot.value, 5);
+  EXPECT_EQ(FindMetric("iree_test_unused").name, nullptr);
+  (void)test_unused;
+}
+
+TEST(MetricsTest, Prometheus) {
+  IREE_METRIC_OBSERVE(test_histogram, 1);
+  IREE_METRIC_OBSERVE(test_histogram, 3);
+  IREE_METRIC_OBSERVE(test_histogram, 4);
+
+  iree_string_builder_t builder;
+  iree_string_builder_initialize(iree_allocator_system(), &builder);
+  IREE_ASSERT_OK(iree_metrics_append_prometheus(&builder));
+  std::string text(iree_string_builder_buffer(&builder),
+                   iree_string_builder_size(&builder));
+  iree_string_builder_deinitialize(&builder);
+
+  EXPECT_NE(text.find("# TYPE iree_test_histogram histogram\n"),
+            std::string::npos);
+  EXPECT_NE(text.find("iree_test_histogram_bucket{le=\"1\"} 1\n"),
+            std::string::npos);
+  EXPECT_NE(text.find("iree_test_histogram_bucket{le=\"2\"} 1\n"),
+            std::string::npos);
+  EXPECT_NE(text.find("iree_test_histogram_bucket{le=\"4\"} 3\n"),
+            std::string::npos);
+  EXPECT_NE(text.find("iree_test_histogram_bucket{le=\"+Inf\"} 3\n"),
+            std::string::npos);
+  EXPECT_NE(text.find("iree_test_histogram_sum 8\n"), std::string::npos);
+  EXPECT_NE(text.find("iree_test_histogram_count 3\n"), std::string::npos);
+  EXPECT_EQ(text.find("iree_test_unused"), std::string::npos);
+}
+
+}  // namespace
+
+#endif  // IREE_METRICS_ENABLE
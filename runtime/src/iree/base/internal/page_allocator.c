@@ -0,0 +1,363 @@
+// Copyright 2023 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include "iree/base/internal/page_allocator.h"
+
+#include <stddef.h>
+#include <string.h>
+
+#include "iree/base/target_platform.h"
+#include "iree/base/tracing.h"
+
+#if defined(IREE_PLATFORM_ANDROID) || defined(IREE_PLATFORM_LINUX)
+#define IREE_PAGE_ALLOCATOR_MMAP 1
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#elif defined(IREE_PLATFORM_WINDOWS)
+#define IREE_PAGE_ALLOCATOR_WIN32 1
+#endif  // IREE_PLATFORM_*
+
+#if defined(IREE_PAGE_ALLOCATOR_MMAP) || defined(IREE_PAGE_ALLOCATOR_WIN32)
+
+//===----------------------------------------------------------------------===//
+// Allocation header
+//===----------------------------------------------------------------------===//
+
+// Identifies how the storage of an allocation was obtained.
+typedef enum iree_page_allocation_kind_e {
+  // Allocated from iree_allocator_system.
+  IREE_PAGE_ALLOCATION_KIND_HEAP = 0,
+  // Mapped directly from the system.
+  IREE_PAGE_ALLOCATION_KIND_PAGES = 1,
+} iree_page_allocation_kind_t;
+
+// Prefix of every allocation made by the allocator. FREE and REALLOC only
+// receive the user pointer so we need to be able to tell how to release it.
+typedef struct iree_page_allocation_header_t {
+  // Base of the underlying heap allocation or mapping.
+  void* base;
+  // Total bytes of pages mapped at |base|; unused for heap allocations.
+  iree_host_size_t mapping_size;
+  // Bytes requested by the user.
+  iree_host_size_t byte_length;
+  iree_page_allocation_kind_t kind;
+} iree_page_allocation_header_t;
+
+// Header size padded out to keep user pointers cache line aligned when the
+// underlying storage is.
+#define IREE_PAGE_ALLOCATION_HEADER_SIZE 64
+static_assert(sizeof(iree_page_allocation_header_t) <=
+                  IREE_PAGE_ALLOCATION_HEADER_SIZE,
+              "header must fit in the reserved prefix");
+
+static iree_page_allocation_header_t* iree_page_allocation_header(void* ptr) {
+  return (iree_page_allocation_header_t*)((uint8_t*)ptr -
+                                          IREE_PAGE_ALLOCATION_HEADER_SIZE);
+}
+
+// Allocator state packed into the |self| pointer so that the allocator needs
+// no lifetime management.
+static uintptr_t iree_page_allocator_pack(iree_page_allocator_flags_t flags,
+                                          uint32_t node_id) {
+  return ((uintptr_t)(node_id + 1) << 8) | (flags & 0xFF);
+}
+static iree_page_allocator_flags_t iree_page_allocator_unpack_flags(
+    void* self) {
+  return (iree_page_allocator_flags_t)((uintptr_t)self & 0xFF);
+}
+static uint32_t iree_page_allocator_unpack_node_id(void* self) {
+  return (uint32_t)((uintptr_t)self >> 8) - 1;
+}
+
+//===----------------------------------------------------------------------===//
+// Platform page mapping
+//===----------------------------------------------------------------------===//
+
+#if defined(IREE_PAGE_ALLOCATOR_MMAP)
+
+#if !defined(MAP_HUGE_SHIFT)
+#define MAP_HUGE_SHIFT 26
+#endif  // !MAP_HUGE_SHIFT
+#if !defined(MAP_HUGE_1GB)
+#define MAP_HUGE_1GB (30 << MAP_HUGE_SHIFT)
+#endif  // !MAP_HUGE_1GB
+
+// From linux/mempolicy.h; redeclared to avoid requiring the kernel headers.
+#define IREE_MPOL_PREFERRED 1
+
+// Prefers pages for [base, base+size) on |node_id|. Best-effort: systems
+// without NUMA support or sandboxes that block mbind keep the default policy.
+static void iree_page_allocator_bind_node(void* base, iree_host_size_t size,
+                                          uint32_t node_id) {
+#if defined(SYS_mbind)
+  unsigned long node_mask = 0;
+  if (node_id >= sizeof(node_mask) * 8) return;
+  node_mask = 1ul << node_id;
+  // The kernel ignores the last bit of maxnode, hence the +1.
+  syscall(SYS_mbind, base, (unsigned long)size, IREE_MPOL_PREFERRED,
+          &node_mask, (unsigned long)(sizeof(node_mask) * 8 + 1), 0u);
+#endif  // SYS_mbind
+}
+
+// Maps |size| bytes using the reserved huge page pool. Returns NULL if no pages
+// are available.
+static void* iree_page_allocator_map_explicit(
+    iree_page_allocator_flags_t flags, iree_host_size_t size,
+    iree_host_size_t* out_mapping_size) {
+#if defined(MAP_HUGETLB)
+  int mmap_flags = MAP_PRIVATE | MAP_ANON | MAP_HUGETLB;
+  iree_host_size_t page_size = IREE_PAGE_ALLOCATOR_HUGE_PAGE_SIZE;
+  if (iree_all_bits_set(flags, IREE_PAGE_ALLOCATOR_FLAG_GIGANTIC_PAGES) &&
+      size >= 1024 * 1024 * 1024) {
+    mmap_flags |= MAP_HUGE_1GB;
+    page_size = 1024 * 1024 * 1024;
+  }
+  iree_host_size_t mapping_size = iree_host_align(size, page_size);
+  void* base =
+      mmap(NULL, mapping_size, PROT_READ | PROT_WRITE, mmap_flags, -1, 0);
+  if (base == MAP_FAILED) return NULL;
+  *out_mapping_size = mapping_size;
+  return base;
+#else
+  return NULL;
+#endif  // MAP_HUGETLB
+}
+
+// Maps |size| bytes of normal pages aligned to the huge page size so that the
+// whole range can be promoted to transparent huge pages.
+static void* iree_page_allocator_map_normal(iree_page_allocator_flags_t flags,
+                                            iree_host_size_t size,
+                                            iree_host_size_t* out_mapping_size) {
+  const iree_host_size_t alignment = IREE_PAGE_ALLOCATOR_HUGE_PAGE_SIZE;
+  const iree_host_size_t mapping_size = iree_host_align(size, alignment);
+
+  // Over-reserve and trim the unaligned head and tail.
+  const iree_host_size_t reserve_size = mapping_size + alignment;
+  uint8_t* reserve_base =
+      (uint8_t*)mmap(NULL, reserve_size, PROT_READ | PROT_WRITE,
+                     MAP_PRIVATE | MAP_ANON, -1, 0);
+  if ((void*)reserve_base == MAP_FAILED) return NULL;
+  uint8_t* base = (uint8_t*)iree_host_align((uintptr_t)reserve_base, alignment);
+  const iree_host_size_t head_size = base - reserve_base;
+  const iree_host_size_t tail_size = reserve_size - head_size - mapping_size;
+  if (head_size) munmap(reserve_base, head_size);
+  if (tail_size) munmap(base + mapping_size, tail_size);
+
+#if defined(MADV_HUGEPAGE)
+  if (iree_all_bits_set(flags,
+                        IREE_PAGE_ALLOCATOR_FLAG_TRANSPARENT_HUGE_PAGES)) {
+    madvise(base, mapping_size, MADV_HUGEPAGE);
+  }
+#endif  // MADV_HUGEPAGE
+
+  *out_mapping_size = mapping_size;
+  return base;
+}
+
+static iree_status_t iree_page_allocator_map(void* self, iree_host_size_t size,
+                                             void** out_base,
+                                             iree_host_size_t* out_size) {
+  const iree_page_allocator_flags_t flags =
+      iree_page_allocator_unpack_flags(self);
+  void* base = NULL;
+  if (iree_all_bits_set(flags, IREE_PAGE_ALLOCATOR_FLAG_EXPLICIT_HUGE_PAGES)) {
+    base = iree_page_allocator_map_explicit(flags, size, out_size);
+  }
+  if (!base) base = iree_page_allocator_map_normal(flags, size, out_size);
+  if (!base) {
+    return iree_make_status(IREE_STATUS_RESOURCE_EXHAUSTED,
+                            "failed to map %" PRIhsz " bytes", size);
+  }
+
+  // Must happen before the pages are first touched (by writing the header).
+  const uint32_t node_id = iree_page_allocator_unpack_node_id(self);
+  if (node_id != IREE_PAGE_ALLOCATOR_NODE_ID_ANY) {
+    iree_page_allocator_bind_node(base, *out_size, node_id);
+  }
+
+  *out_base = base;
+  return iree_ok_status();
+}
+
+static void iree_page_allocator_unmap(void* base, iree_host_size_t size) {
+  munmap(base, size);
+}
+
+#elif defined(IREE_PAGE_ALLOCATOR_WIN32)
+
+static iree_status_t iree_page_allocator_map(void* self, iree_host_size_t size,
+                                             void** out_base,
+                                             iree_host_size_t* out_size) {
+  const iree_page_allocator_flags_t flags =
+      iree_page_allocator_unpack_flags(self);
+  const uint32_t node_id = iree_page_allocator_unpack_node_id(self);
+  const DWORD preferred_node =
+      node_id == IREE_PAGE_ALLOCATOR_NODE_ID_ANY ? NUMA_NO_PREFERRED_NODE
+                                                 : (DWORD)node_id;
+  void* base = NULL;
+
+  // Large pages require SeLockMemoryPrivilege; without it the allocation fails
+  // and we fall back to normal pages.
+  const SIZE_T large_page_size = GetLargePageMinimum();
+  if (iree_all_bits_set(flags, IREE_PAGE_ALLOCATOR_FLAG_EXPLICIT_HUGE_PAGES) &&
+      large_page_size > 0) {
+    const iree_host_size_t mapping_size =
+        iree_host_align(size, large_page_size);
+    base = VirtualAllocExNuma(GetCurrentProcess(), NULL, mapping_size,
+                              MEM_RESERVE | MEM_COMMIT | MEM_LARGE_PAGES,
+                              PAGE_READWRITE, preferred_node);
+    if (base) *out_size = mapping_size;
+  }
+  if (!base) {
+    const iree_host_size_t mapping_size =
+        iree_host_align(size, IREE_PAGE_ALLOCATOR_HUGE_PAGE_SIZE);
+    base = VirtualAllocExNuma(GetCurrentProcess(), NULL, mapping_size,
+                              MEM_RESERVE | MEM_COMMIT, PAGE_READWRITE,
+                              preferred_node);
+    if (base) *out_size = mapping_size;
+  }
+  if (!base) {
+    return iree_make_status(iree_status_code_from_win32_error(GetLastError()),
+                            "failed to map %" PRIhsz " bytes", size);
+  }
+
+  *out_base = base;
+  return iree_ok_status();
+}
+
+static void iree_page_allocator_unmap(void* base, iree_host_size_t size) {
+  VirtualFree(base, 0, MEM_RELEASE);
+}
+
+#endif  // IREE_PAGE_ALLOCATOR_*
+
+//===----------------------------------------------------------------------===//
+// iree_allocator_t implementation
+//===----------------------------------------------------------------------===//
+
+static iree_status_t iree_page_allocator_alloc(void* self,
+                                               iree_allocator_command_t command,
+                                               iree_host_size_t byte_length,
+                                               void** out_ptr) {
+  const iree_host_size_t total_size =
+      IREE_PAGE_ALLOCATION_HEADER_SIZE + byte_length;
+  iree_page_allocation_header_t header = {
+      .base = NULL,
+      .mapping_size = 0,
+      .byte_length = byte_length,
+      .kind = IREE_PAGE_ALLOCATION_KIND_HEAP,
+  };
+  if (byte_length >= IREE_PAGE_ALLOCATOR_HUGE_PAGE_SIZE) {
+    // Mapped pages are always zeroed so CALLOC is free.
+    IREE_TRACE_ZONE_BEGIN(z0);
+    IREE_TRACE_ZONE_APPEND_VALUE(z0, (int64_t)byte_length);
+    iree_status_t status = iree_page_allocator_map(self, total_size,
+                                                   &header.base,
+                                                   &header.mapping_size);
+    IREE_TRACE_ZONE_END(z0);
+    IREE_RETURN_IF_ERROR(status);
+    header.kind = IREE_PAGE_ALLOCATION_KIND_PAGES;
+    IREE_TRACE_ALLOC_NAMED("iree_page_allocator", header.base,
+                           header.mapping_size);
+  } else if (command == IREE_ALLOCATOR_COMMAND_CALLOC) {
+    IREE_RETURN_IF_ERROR(iree_allocator_malloc(iree_allocator_system(),
+                                               total_size, &header.base));
+  } else {
+    IREE_RETURN_IF_ERROR(iree_allocator_malloc_uninitialized(
+        iree_allocator_system(), total_size, &header.base));
+  }
+  memcpy(header.base, &header, sizeof(header));
+  *out_ptr = (uint8_t*)header.base + IREE_PAGE_ALLOCATION_HEADER_SIZE;
+  return iree_ok_status();
+}
+
+static void iree_page_allocator_free(void* ptr) {
+  iree_page_allocation_header_t* header = iree_page_allocation_header(ptr);
+  switch (header->kind) {
+    case IREE_PAGE_ALLOCATION_KIND_PAGES: {
+      IREE_TRACE_FREE_NAMED("iree_page_allocator", header->base);
+      iree_page_allocator_unmap(header->base, header->mapping_size);
+      break;
+    }
+    default:
+    case IREE_PAGE_ALLOCATION_KIND_HEAP: {
+      iree_allocator_free(iree_allocator_system(), header->base);
+      break;
+    }
+  }
+}
+
+static iree_status_t iree_page_allocator_realloc(void* self,
+                                                 iree_host_size_t byte_length,
+                                                 void** inout_ptr) {
+  if (!*inout_ptr) {
+    return iree_page_allocator_alloc(self, IREE_ALLOCATOR_COMMAND_MALLOC,
+                                     byte_length, inout_ptr);
+  }
+  iree_page_allocation_header_t* header =
+      iree_page_allocation_header(*inout_ptr);
+
+  // Mappings can grow in-place up to the pages they already cover.
+  if (header->kind == IREE_PAGE_ALLOCATION_KIND_PAGES &&
+      byte_length + IREE_PAGE_ALLOCATION_HEADER_SIZE <= header->mapping_size &&
+      byte_length >= IREE_PAGE_ALLOCATOR_HUGE_PAGE_SIZE) {
+    header->byte_length = byte_length;
+    return iree_ok_status();
+  }
+
+  void* new_ptr = NULL;
+  IREE_RETURN_IF_ERROR(iree_page_allocator_alloc(
+      self, IREE_ALLOCATOR_COMMAND_MALLOC, byte_length, &new_ptr));
+  memcpy(new_ptr, *inout_ptr, iree_min(header->byte_length, byte_length));
+  iree_page_allocator_free(*inout_ptr);
+  *inout_ptr = new_ptr;
+  return iree_ok_status();
+}
+
+static iree_status_t iree_page_allocator_ctl(void* self,
+                                             iree_allocator_command_t command,
+                                             const void* params,
+                                             void** inout_ptr) {
+  switch (command) {
+    case IREE_ALLOCATOR_COMMAND_MALLOC:
+    case IREE_ALLOCATOR_COMMAND_CALLOC: {
+      const iree_host_size_t byte_length =
+          ((const iree_allocator_alloc_params_t*)params)->byte_length;
+      return iree_page_allocator_alloc(self, command, byte_length, inout_ptr);
+    }
+    case IREE_ALLOCATOR_COMMAND_REALLOC: {
+      const iree_host_size_t byte_length =
+          ((const iree_allocator_alloc_params_t*)params)->byte_length;
+      return iree_page_allocator_realloc(self, byte_length, inout_ptr);
+    }
+    case IREE_ALLOCATOR_COMMAND_FREE: {
+      iree_page_allocator_free(*inout_ptr);
+      return iree_ok_status();
+    }
+    default:
+      return iree_make_status(IREE_STATUS_UNIMPLEMENTED,
+                              "unsupported page allocator command");
+  }
+}
+
+iree_allocator_t iree_page_allocator(iree_page_allocator_flags_t flags,
+                                     uint32_t node_id) {
+  iree_allocator_t allocator = {
+      .self = (void*)iree_page_allocator_pack(flags, node_id),
+      .ctl = iree_page_allocator_ctl,
+  };
+  return allocator;
+}
+
+#else
+
+iree_allocator_t iree_page_allocator(iree_page_allocator_flags_t flags,
+                                     uint32_t node_id) {
+  return iree_allocator_system();
+}
+
+#endif  // IREE_PAGE_ALLOCATOR_MMAP || IREE_PAGE_ALLOCATOR_WIN32
@@ -0,0 +1,64 @@
+// Copyright 2023 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#ifndef IREE_BASE_INTERNAL_PAGE_ALLOCATOR_H_
+#define IREE_BASE_INTERNAL_PAGE_ALLOCATOR_H_
+
+#include <stdint.h>
+
+#include "iree/base/api.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Controls how iree_page_allocator_t backs large allocations.
+enum iree_page_allocator_flag_bits_t {
+  IREE_PAGE_ALLOCATOR_FLAG_NONE = 0u,
+  // Advises the system to back allocations with transparent huge pages
+  // (Linux MADV_HUGEPAGE). Allocations are aligned to the huge page size so
+  // that the entire range is eligible.
+  IREE_PAGE_ALLOCATOR_FLAG_TRANSPARENT_HUGE_PAGES = 1u << 0,
+  // Requests explicit huge pages from the system reserved pool (Linux
+  // MAP_HUGETLB, Windows MEM_LARGE_PAGES). Falls back to normal pages when the
+  // pool is exhausted or the process lacks the required privileges.
+  IREE_PAGE_ALLOCATOR_FLAG_EXPLICIT_HUGE_PAGES = 1u << 1,
+  // Uses 1GB pages instead of the 2MB default for explicit huge page
+  // allocations of at least 1GB. Requires
+  // IREE_PAGE_ALLOCATOR_FLAG_EXPLICIT_HUGE_PAGES.
+  IREE_PAGE_ALLOCATOR_FLAG_GIGANTIC_PAGES = 1u << 2,
+};
+typedef uint32_t iree_page_allocator_flags_t;
+
+// Selects no particular NUMA node for iree_page_allocator.
+#define IREE_PAGE_ALLOCATOR_NODE_ID_ANY ((uint32_t)-1)
+
+// Size of the huge pages used by the page allocator unless
+// IREE_PAGE_ALLOCATOR_FLAG_GIGANTIC_PAGES applies. Allocations smaller than
+// this are passed to the system allocator.
+#define IREE_PAGE_ALLOCATOR_HUGE_PAGE_SIZE (2 * 1024 * 1024)
+
+// Returns an allocator that maps large allocations directly from the system as
+// controlled by |flags| and prefers pages on NUMA node |node_id|. The node is
+// only a preference and pages may come from other nodes when it is full;
+// IREE_PAGE_ALLOCATOR_NODE_ID_ANY uses the default system policy.
+//
+// Allocations smaller than IREE_PAGE_ALLOCATOR_HUGE_PAGE_SIZE are serviced by
+// iree_allocator_system. The allocator carries no state and never needs to be
+// destroyed. On platforms without page mapping support this returns
+// iree_allocator_system.
+//
+// Intended for long-lived multi-megabyte allocations such as weights and
+// transient activation pools where TLB misses on normal pages are measurable;
+// mapping pages is significantly more expensive than a heap allocation.
+iree_allocator_t iree_page_allocator(iree_page_allocator_flags_t flags,
+                                     uint32_t node_id);
+
+#ifdef __cplusplus
+}  // extern "C"
+#endif
+
+#endif  // IREE_BASE_INTERNAL_PAGE_ALLOCATOR_H_
@@ -0,0 +1,77 @@
+// Copyright 2023 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include "iree/base/internal/page_allocator.h"
+
+#include <cstdint>
+#include <cstring>
+
+#include "iree/base/api.h"
+#include "iree/testing/gtest.h"
+#include "iree/testing/status_matchers.h"
+
+namespace {
+
+static bool IsZero(const uint8_t* data, iree_host_size_t length) {
+  for (iree_host_size_t i = 0; i < length; ++i) {
+    if (data[i] != 0) return false;
+  }
+  return true;
+}
+
+class PageAllocatorTest
+    : public ::testing::TestWithParam<iree_page_allocator_flags_t> {};
+
+// Small allocations are routed to the system allocator.
+TEST_P(PageAllocatorTest, SmallAllocation) {
+  iree_allocator_t allocator =
+      iree_page_allocator(GetParam(), IREE_PAGE_ALLOCATOR_NODE_ID_ANY);
+  uint8_t* ptr = NULL;
+  IREE_ASSERT_OK(iree_allocator_malloc(allocator, 100, (void**)&ptr));
+  EXPECT_TRUE(IsZero(ptr, 100));
+  memset(ptr, 0xCD, 100);
+  iree_allocator_free(allocator, ptr);
+}
+
+// Large allocations are mapped, zeroed, and can be grown and shrunk.
+TEST_P(PageAllocatorTest, LargeAllocation) {
+  iree_allocator_t allocator = iree_page_allocator(GetParam(), 0);
+  const iree_host_size_t length = 3 * IREE_PAGE_ALLOCATOR_HUGE_PAGE_SIZE;
+  uint8_t* ptr = NULL;
+  IREE_ASSERT_OK(iree_allocator_malloc(allocator, length, (void**)&ptr));
+  EXPECT_TRUE(IsZero(ptr, length));
+  ptr[0] = 1;
+  ptr[length - 1] = 2;
+
+  IREE_ASSERT_OK(iree_allocator_realloc(allocator, 2 * length, (void**)&ptr));
+  EXPECT_EQ(ptr[0], 1);
+  EXPECT_EQ(ptr[length - 1], 2);
+  ptr[2 * length - 1] = 3;
+
+  IREE_ASSERT_OK(iree_allocator_realloc(allocator, 16, (void**)&ptr));
+  EXPECT_EQ(ptr[0], 1);
+  iree_allocator_free(allocator, ptr);
+}
+
+// Aligned allocations preserve their alignment.
+TEST_P(PageAllocatorTest, AlignedAllocation) {
+  iree_allocator_t allocator =
+      iree_page_allocator(GetParam(), IREE_PAGE_ALLOCATOR_NODE_ID_ANY);
+  void* ptr = NULL;
+  IREE_ASSERT_OK(iree_allocator_malloc_aligned(
+      allocator, IREE_PAGE_ALLOCATOR_HUGE_PAGE_SIZE, 64, 0, &ptr));
+  EXPECT_TRUE(iree_host_size_has_alignment((uintptr_t)ptr, 64));
+  iree_allocator_free_aligned(allocator, ptr);
+}
+
+INSTANTIATE_TEST_SUITE_P(
+    AllFlags, PageAllocatorTest,
+    ::testing::Values(IREE_PAGE_ALLOCATOR_FLAG_NONE,
+                      IREE_PAGE_ALLOCATOR_FLAG_TRANSPARENT_HUGE_PAGES,
+                      IREE_PAGE_ALLOCATOR_FLAG_EXPLICIT_HUGE_PAGES |
+                          IREE_PAGE_ALLOCATOR_FLAG_GIGANTIC_PAGES));
+
+}  // namespace
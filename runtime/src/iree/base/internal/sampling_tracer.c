@@ -0,0 +1,206 @@
+// Copyright 2023 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include "iree/base/internal/sampling_tracer.h"
+
+#include <inttypes.h>
+#include <string.h>
+
+#if defined(IREE_COMPILER_MSVC)
+#define IREE_SAMPLING_THREAD_LOCAL __declspec(thread)
+#else
+#define IREE_SAMPLING_THREAD_LOCAL _Thread_local
+#endif  // IREE_COMPILER_MSVC
+
+iree_atomic_int32_t iree_sampling_tracer_rate_storage = IREE_ATOMIC_VAR_INIT(0);
+
+typedef struct iree_sampling_event_t {
+  const char* name;
+  iree_time_t start_ns;
+  iree_time_t duration_ns;
+} iree_sampling_event_t;
+
+// Per-thread recording state. Everything but |write_index| and |events| is
+// only accessed by the owning thread.
+typedef struct iree_sampling_thread_t {
+  // Next thread in the registry list.
+  struct iree_sampling_thread_t* next;
+  // Index of the thread in registration order used as the trace thread ID.
+  int32_t thread_index;
+  // Number of tracked zones open on the thread.
+  int32_t depth;
+  // Whether the currently open root zone (and all nested zones) is sampled.
+  bool sampling;
+  // Root zones remaining until the next sampled one.
+  uint32_t countdown;
+  // Total number of events ever written. Event i is stored in slot
+  // i % IREE_SAMPLING_TRACER_RING_CAPACITY and is published by storing i + 1.
+  iree_atomic_int64_t write_index;
+  // Events with write_index values below |reset_index| have been discarded.
+  iree_atomic_int64_t reset_index;
+  iree_sampling_event_t events[IREE_SAMPLING_TRACER_RING_CAPACITY];
+} iree_sampling_thread_t;
+
+// Head of the intrusive list of threads that have recorded zones. Threads are
+// only ever pushed on the front so readers can walk the list without locking.
+static iree_atomic_intptr_t iree_sampling_threads_head =
+    IREE_ATOMIC_VAR_INIT(0);
+static iree_atomic_int32_t iree_sampling_thread_count = IREE_ATOMIC_VAR_INIT(0);
+
+// Per-thread state; NULL until the thread first begins a zone while enabled.
+// Set to a sentinel if allocation failed so we don't retry on every zone.
+static IREE_SAMPLING_THREAD_LOCAL iree_sampling_thread_t*
+    iree_sampling_thread_state = NULL;
+#define IREE_SAMPLING_THREAD_UNAVAILABLE ((iree_sampling_thread_t*)1)
+
+void iree_sampling_tracer_set_rate(uint32_t one_in_n) {
+  iree_atomic_store_int32(&iree_sampling_tracer_rate_storage,
+                          (int32_t)one_in_n, iree_memory_order_relaxed);
+}
+
+void iree_sampling_tracer_reset(void) {
+  iree_sampling_thread_t* thread =
+      (iree_sampling_thread_t*)iree_atomic_load_intptr(
+          &iree_sampling_threads_head, iree_memory_order_acquire);
+  for (; thread != NULL; thread = thread->next) {
+    iree_atomic_store_int64(
+        &thread->reset_index,
+        iree_atomic_load_int64(&thread->write_index, iree_memory_order_acquire),
+        iree_memory_order_relaxed);
+  }
+}
+
+static iree_sampling_thread_t* iree_sampling_thread_acquire(void) {
+  iree_sampling_thread_t* thread = iree_sampling_thread_state;
+  if (IREE_LIKELY(thread)) {
+    return thread == IREE_SAMPLING_THREAD_UNAVAILABLE ? NULL : thread;
+  }
+
+  // The ring is large and retained for the lifetime of the process so we use
+  // the system allocator directly instead of threading one through every
+  // instrumented API.
+  iree_status_t status = iree_allocator_malloc(
+      iree_allocator_system(), sizeof(*thread), (void**)&thread);
+  if (!iree_status_is_ok(status)) {
+    iree_status_ignore(status);
+    iree_sampling_thread_state = IREE_SAMPLING_THREAD_UNAVAILABLE;
+    return NULL;
+  }
+  memset(thread, 0, offsetof(iree_sampling_thread_t, events));
+  thread->thread_index = iree_atomic_fetch_add_int32(
+      &iree_sampling_thread_count, 1, iree_memory_order_relaxed);
+
+  intptr_t head = iree_atomic_load_intptr(&iree_sampling_threads_head,
+                                          iree_memory_order_acquire);
+  do {
+    thread->next = (iree_sampling_thread_t*)head;
+  } while (!iree_atomic_compare_exchange_weak_intptr(
+      &iree_sampling_threads_head, &head, (intptr_t)thread,
+      iree_memory_order_release, iree_memory_order_acquire));
+
+  iree_sampling_thread_state = thread;
+  return thread;
+}
+
+iree_sampling_zone_t iree_sampling_zone_begin_slow(const char* name) {
+  iree_sampling_zone_t zone = {NULL, 0, false};
+  iree_sampling_thread_t* thread = iree_sampling_thread_acquire();
+  if (!thread) return zone;
+
+  if (thread->depth == 0) {
+    // Root zone: decide whether it and everything nested within it is sampled.
+    // The rate may have changed since the last root zone so the countdown is
+    // clamped to it.
+    uint32_t rate = iree_sampling_tracer_rate();
+    if (thread->countdown == 0 || thread->countdown > rate) {
+      thread->countdown = rate;
+    }
+    thread->sampling = rate != 0 && --thread->countdown == 0;
+  }
+  ++thread->depth;
+
+  zone.name = name;
+  zone.sampled = thread->sampling;
+  if (zone.sampled) zone.start_ns = iree_time_now();
+  return zone;
+}
+
+void iree_sampling_zone_end_slow(iree_sampling_zone_t zone) {
+  iree_sampling_thread_t* thread = iree_sampling_thread_state;
+  --thread->depth;
+  if (!zone.sampled) return;
+
+  int64_t index =
+      iree_atomic_load_int64(&thread->write_index, iree_memory_order_relaxed);
+  iree_sampling_event_t* event =
+      &thread->events[index % IREE_SAMPLING_TRACER_RING_CAPACITY];
+  event->name = zone.name;
+  event->start_ns = zone.start_ns;
+  event->duration_ns = iree_time_now() - zone.start_ns;
+  iree_atomic_store_int64(&thread->write_index, index + 1,
+                          iree_memory_order_release);
+}
+
+static iree_status_t iree_sampling_tracer_append_thread_json(
+    iree_sampling_thread_t* thread, iree_sampling_event_t* scratch,
+    bool* needs_separator, iree_string_builder_t* builder) {
+  // Copy the events out of the ring and then discard any that the owning thread
+  // may have overwritten while we were copying: once the writer has published
+  // index |end_after| it may be writing event |end_after| over the slot of
+  // event |end_after - capacity|.
+  const int64_t capacity = IREE_SAMPLING_TRACER_RING_CAPACITY;
+  int64_t end_before =
+      iree_atomic_load_int64(&thread->write_index, iree_memory_order_acquire);
+  int64_t begin = iree_max(0, end_before - capacity);
+  begin = iree_max(begin, iree_atomic_load_int64(&thread->reset_index,
+                                                 iree_memory_order_relaxed));
+  for (int64_t i = begin; i < end_before; ++i) {
+    scratch[i % capacity] = thread->events[i % capacity];
+  }
+  int64_t end_after =
+      iree_atomic_load_int64(&thread->write_index, iree_memory_order_acquire);
+  begin = iree_max(begin, end_after - capacity + 1);
+
+  for (int64_t i = begin; i < end_before; ++i) {
+    const iree_sampling_event_t* event = &scratch[i % capacity];
+    IREE_RETURN_IF_ERROR(iree_string_builder_append_format(
+        builder,
+        "%s\n{\"name\":\"%s\",\"ph\":\"X\",\"pid\":0,\"tid\":%d,"
+        "\"ts\":%" PRIi64 ".%03d,\"dur\":%" PRIi64 ".%03d}",
+        *needs_separator ? "," : "", event->name, thread->thread_index,
+        event->start_ns / 1000, (int)(event->start_ns % 1000),
+        event->duration_ns / 1000, (int)(event->duration_ns % 1000)));
+    *needs_separator = true;
+  }
+  return iree_ok_status();
+}
+
+iree_status_t iree_sampling_tracer_append_chrome_json(
+    iree_string_builder_t* builder) {
+  IREE_ASSERT_ARGUMENT(builder);
+  iree_sampling_event_t* scratch = NULL;
+  IREE_RETURN_IF_ERROR(iree_allocator_malloc(
+      iree_allocator_system(),
+      IREE_SAMPLING_TRACER_RING_CAPACITY * sizeof(*scratch), (void**)&scratch));
+
+  iree_status_t status =
+      iree_string_builder_append_cstring(builder, "{\"traceEvents\":[");
+  bool needs_separator = false;
+  iree_sampling_thread_t* thread =
+      (iree_sampling_thread_t*)iree_atomic_load_intptr(
+          &iree_sampling_threads_head, iree_memory_order_acquire);
+  for (; thread != NULL && iree_status_is_ok(status); thread = thread->next) {
+    status = iree_sampling_tracer_append_thread_json(thread, scratch,
+                                                     &needs_separator, builder);
+  }
+  if (iree_status_is_ok(status)) {
+    status = iree_string_builder_append_cstring(
+        builder, "\n],\"displayTimeUnit\":\"ns\"}\n");
+  }
+
+  iree_allocator_free(iree_allocator_system(), scratch);
+  return status;
+}
@@ -0,0 +1,132 @@
+// Copyright 2023 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#ifndef IREE_BASE_INTERNAL_SAMPLING_TRACER_H_
+#define IREE_BASE_INTERNAL_SAMPLING_TRACER_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "iree/base/api.h"
+#include "iree/base/internal/atomics.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif  // __cplusplus
+
+//===----------------------------------------------------------------------===//
+// Sampling tracer
+//===----------------------------------------------------------------------===//
+// A low-overhead tracer that can be switched on at runtime in production
+// deployments (unlike Tracy instrumentation, which is selected at build time
+// via IREE_TRACING_FEATURES). When enabled one in every N root zones on each
+// thread is sampled and it and all zones nested within it on that thread are
+// recorded into a fixed-size per-thread ring buffer. The most recent events in
+// all rings can be dumped at any time in the Chrome trace event JSON format
+// that chrome://tracing and Perfetto (ui.perfetto.dev) load.
+//
+// A root zone is one that begins when no other sampled zone is open on the
+// thread: a synchronous VM invocation on the thread calling into IREE or a task
+// executed by a task system worker. Threads sample independently of each
+// other, so a task executed as part of a sampled invocation is only recorded
+// if the worker running it happens to also sample it.
+//
+// When disabled (the default) beginning a zone is a single relaxed atomic load.
+// Recording a sampled zone touches only the thread's own ring. The rings are
+// allocated the first time a thread records a zone and are retained for the
+// lifetime of the process so that events from threads that have exited can
+// still be dumped.
+//
+// Usage:
+//   IREE_SAMPLED_ZONE_BEGIN(z0, "my_function");
+//   ...
+//   IREE_SAMPLED_ZONE_END(z0);
+//
+// The sampling tracer can be compiled out by defining
+// IREE_SAMPLING_TRACER_ENABLE=0, in which case the IREE_SAMPLED_ZONE_* macros
+// expand to nothing and enabling sampling has no effect.
+
+#if !defined(IREE_SAMPLING_TRACER_ENABLE)
+#define IREE_SAMPLING_TRACER_ENABLE 1
+#endif  // !IREE_SAMPLING_TRACER_ENABLE
+
+// Number of events retained per thread. Older events are overwritten.
+#if !defined(IREE_SAMPLING_TRACER_RING_CAPACITY)
+#define IREE_SAMPLING_TRACER_RING_CAPACITY 4096
+#endif  // !IREE_SAMPLING_TRACER_RING_CAPACITY
+
+// Sets the sampling rate such that one in every |one_in_n| root zones on each
+// thread is recorded. 0 disables sampling and 1 records every zone.
+// Previously recorded events are retained.
+void iree_sampling_tracer_set_rate(uint32_t one_in_n);
+
+// Storage for the sampling rate; use iree_sampling_tracer_rate to query.
+extern iree_atomic_int32_t iree_sampling_tracer_rate_storage;
+
+// Returns the current sampling rate or 0 if sampling is disabled.
+static inline uint32_t iree_sampling_tracer_rate(void) {
+  return (uint32_t)iree_atomic_load_int32(&iree_sampling_tracer_rate_storage,
+                                          iree_memory_order_relaxed);
+}
+
+// Discards all recorded events.
+void iree_sampling_tracer_reset(void);
+
+// Appends all retained events to |builder| as a Chrome trace event JSON
+// object. Events still being recorded by other threads are omitted.
+iree_status_t iree_sampling_tracer_append_chrome_json(
+    iree_string_builder_t* builder);
+
+// Zone token returned by iree_sampling_zone_begin.
+typedef struct iree_sampling_zone_t {
+  // Static name of the zone or NULL if the zone is not tracked.
+  const char* name;
+  // Start time of the zone if it is sampled.
+  iree_time_t start_ns;
+  // True if the zone will be recorded when it ends.
+  bool sampled;
+} iree_sampling_zone_t;
+
+// Begins a zone named |name|, which must be a string literal (it is retained
+// and emitted unescaped). Must be balanced with iree_sampling_zone_end on the
+// same thread.
+iree_sampling_zone_t iree_sampling_zone_begin_slow(const char* name);
+
+static inline iree_sampling_zone_t iree_sampling_zone_begin(const char* name) {
+  if (IREE_LIKELY(iree_sampling_tracer_rate() == 0)) {
+    iree_sampling_zone_t zone = {NULL, 0, false};
+    return zone;
+  }
+  return iree_sampling_zone_begin_slow(name);
+}
+
+// Ends a zone begun with iree_sampling_zone_begin.
+void iree_sampling_zone_end_slow(iree_sampling_zone_t zone);
+
+static inline void iree_sampling_zone_end(iree_sampling_zone_t zone) {
+  if (IREE_LIKELY(!zone.name)) return;
+  iree_sampling_zone_end_slow(zone);
+}
+
+#if IREE_SAMPLING_TRACER_ENABLE
+
+#define IREE_SAMPLED_ZONE_BEGIN(zone_id, name_literal) \
+  iree_sampling_zone_t zone_id = iree_sampling_zone_begin(name_literal)
+
+#define IREE_SAMPLED_ZONE_END(zone_id) iree_sampling_zone_end(zone_id)
+
+#else
+
+#define IREE_SAMPLED_ZONE_BEGIN(zone_id, name_literal)
+#define IREE_SAMPLED_ZONE_END(zone_id)
+
+#endif  // IREE_SAMPLING_TRACER_ENABLE
+
+#ifdef __cplusplus
+}  // extern "C"
+#endif  // __cplusplus
+
+#endif  // IREE_BASE_INTERNAL_SAMPLING_TRACER_H_
@@ -0,0 +1,92 @@
+// Copyright 2023 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include "iree/base/internal/sampling_tracer.h"
+
+#include <string>
+
+#include "iree/testing/gtest.h"
+#include "iree/testing/status_matchers.h"
+
+#if IREE_SAMPLING_TRACER_ENABLE
+
+namespace {
+
+static std::string DumpChromeJson() {
+  iree_string_builder_t builder;
+  iree_string_builder_initialize(iree_allocator_system(), &builder);
+  IREE_CHECK_OK(iree_sampling_tracer_append_chrome_json(&builder));
+  std::string json(iree_string_builder_buffer(&builder),
+                   iree_string_builder_size(&builder));
+  iree_string_builder_deinitialize(&builder);
+  return json;
+}
+
+static int CountOccurrences(const std::string& haystack,
+                            const std::string& needle) {
+  int count = 0;
+  for (size_t i = haystack.find(needle); i != std::string::npos;
+       i = haystack.find(needle, i + needle.size())) {
+    ++count;
+  }
+  return count;
+}
+
+static void RecordRootWithChild() {
+  IREE_SAMPLED_ZONE_BEGIN(z0, "root");
+  IREE_SAMPLED_ZONE_BEGIN(z1, "child");
+  IREE_SAMPLED_ZONE_END(z1);
+  IREE_SAMPLED_ZONE_END(z0);
+}
+
+class SamplingTracerTest : public ::testing::Test {
+ protected:
+  void SetUp() override { iree_sampling_tracer_reset(); }
+  void TearDown() override {
+    iree_sampling_tracer_set_rate(0);
+    iree_sampling_tracer_reset();
+  }
+};
+
+TEST_F(SamplingTracerTest, DisabledRecordsNothing) {
+  for (int i = 0; i < 8; ++i) RecordRootWithChild();
+  std::string json = DumpChromeJson();
+  EXPECT_EQ(CountOccurrences(json, "\"ph\":\"X\""), 0);
+}
+
+TEST_F(SamplingTracerTest, SamplesOneInN) {
+  iree_sampling_tracer_set_rate(4);
+  for (int i = 0; i < 12; ++i) RecordRootWithChild();
+  std::string json = DumpChromeJson();
+  EXPECT_EQ(CountOccurrences(json, "\"name\":\"root\""), 3);
+  // Nested zones are recorded along with their sampled root.
+  EXPECT_EQ(CountOccurrences(json, "\"name\":\"child\""), 3);
+}
+
+TEST_F(SamplingTracerTest, Reset) {
+  iree_sampling_tracer_set_rate(1);
+  RecordRootWithChild();
+  iree_sampling_tracer_reset();
+  RecordRootWithChild();
+  std::string json = DumpChromeJson();
+  EXPECT_EQ(CountOccurrences(json, "\"name\":\"root\""), 1);
+}
+
+TEST_F(SamplingTracerTest, RingRetainsMostRecent) {
+  iree_sampling_tracer_set_rate(1);
+  for (int i = 0; i < IREE_SAMPLING_TRACER_RING_CAPACITY; ++i) {
+    RecordRootWithChild();
+  }
+  std::string json = DumpChromeJson();
+  int event_count = CountOccurrences(json, "\"ph\":\"X\"");
+  EXPECT_GT(event_count, 0);
+  EXPECT_LE(event_count, IREE_SAMPLING_TRACER_RING_CAPACITY);
+  EXPECT_EQ(json.rfind("{\"traceEvents\":[", 0), 0u);
+}
+
+}  // namespace
+
+#endif  // IREE_SAMPLING_TRACER_ENABLE
@@ -81,6 +81,11 @@ extern "C" {
 #define IREE_ALL_WAITERS INT32_MAX
 #define IREE_INFINITE_TIMEOUT_MS UINT32_MAX
 
+// Hints to the processor that the caller is in a spin-wait loop (pause/yield).
+// This lets a sibling SMT thread make progress and reduces the power used while
+// spinning. A no-op on architectures without such an instruction.
+void iree_processor_yield(void);
+
 //==============================================================================
 // iree_mutex_t
 //==============================================================================
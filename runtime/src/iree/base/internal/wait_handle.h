@@ -72,6 +72,15 @@ void iree_wait_handle_deinitialize(iree_wait_handle_t* handle);
 // Closes a wait handle and resets |handle|.
 void iree_wait_handle_close(iree_wait_handle_t* handle);
 
+// Clones |handle| into |out_handle| such that both reference the same wait
+// primitive. The clone can be waited on and must be closed independently with
+// iree_wait_handle_close; it remains valid even after |handle| is closed.
+// Only the waitable side of primitives with separate signal and wait handles
+// (such as pipes) is cloned and the clone cannot be used to signal.
+// Returns IREE_STATUS_UNAVAILABLE if the primitive type cannot be cloned.
+iree_status_t iree_wait_handle_clone(const iree_wait_handle_t* handle,
+                                     iree_wait_handle_t* out_handle);
+
 // iree_wait_source_t control function.
 iree_status_t iree_wait_handle_ctl(iree_wait_source_t wait_source,
                                    iree_wait_source_command_t command,
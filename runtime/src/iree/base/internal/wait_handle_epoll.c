@@ -9,58 +9,446 @@
 
 #if IREE_WAIT_API == IREE_WAIT_API_EPOLL
 
+#include <errno.h>
+#include <poll.h>
+#include <sys/epoll.h>
+#include <time.h>
+#include <unistd.h>
+
 #include "iree/base/internal/wait_handle_posix.h"
 #include "iree/base/tracing.h"
 
+//===----------------------------------------------------------------------===//
+// Platform utilities
+//===----------------------------------------------------------------------===//
+
+// Events we register for each fd. EPOLLERR and EPOLLHUP are always reported.
+//
+// Registrations are level-triggered: an fd that remains signaled will continue
+// to be reported on each wait until it is reset or removed from the set. This
+// matches the poll behavior the rest of the runtime expects.
+#define IREE_WAIT_SET_EPOLL_EVENTS (EPOLLIN | EPOLLPRI)
+
+// epoll_wait may spuriously wake with an EINTR. As with poll we don't do
+// anything with that opportunity but retry the wait with an updated timeout
+// based on the deadline.
+//
+// Documentation: https://man7.org/linux/man-pages/man2/epoll_wait.2.html
+static iree_status_t iree_syscall_epoll_wait(int epoll_fd,
+                                             struct epoll_event* events,
+                                             int max_events,
+                                             iree_time_t deadline_ns,
+                                             int* out_signaled_count) {
+  *out_signaled_count = 0;
+  int rv = -1;
+  do {
+    // NOTE: UINT32_MAX (infinite) maps to -1 which epoll_wait treats as block
+    // forever.
+    uint32_t timeout_ms = iree_absolute_deadline_to_timeout_ms(deadline_ns);
+    rv = epoll_wait(epoll_fd, events, max_events, (int)timeout_ms);
+  } while (rv < 0 && errno == EINTR);
+  if (rv > 0) {
+    // One or more events set.
+    *out_signaled_count = rv;
+    return iree_ok_status();
+  } else if (IREE_UNLIKELY(rv < 0)) {
+    return iree_make_status(iree_status_code_from_errno(errno),
+                            "epoll_wait failure %d", errno);
+  }
+  // rv == 0
+  // Timeout; no events set.
+  return iree_status_from_code(IREE_STATUS_DEADLINE_EXCEEDED);
+}
+
+// Updates the registration of |fd| in |epoll_fd| with the given |op|.
+// |index| is stored as the user data and returned when the fd is signaled.
+static iree_status_t iree_syscall_epoll_ctl(int epoll_fd, int op, int fd,
+                                            uint32_t events, uint32_t index) {
+  struct epoll_event event;
+  memset(&event, 0, sizeof(event));
+  event.events = events;
+  event.data.u32 = index;
+  if (IREE_UNLIKELY(epoll_ctl(epoll_fd, op, fd, &event) < 0)) {
+    return iree_make_status(iree_status_code_from_errno(errno),
+                            "epoll_ctl(%d) failure on fd %d: %d", op, fd,
+                            errno);
+  }
+  return iree_ok_status();
+}
+
 //===----------------------------------------------------------------------===//
 // iree_wait_set_t
 //===----------------------------------------------------------------------===//
 
-// TODO(benvanik): iree_wait_set_s using an epoll fd.
-// epoll lets us route the wait set operations right to kernel and not need our
-// own duplicate data structure. epoll is great, just not available on mac/ios
-// so we still need poll for that. linux/android/bsd all have epoll, though.
+// epoll lets us route the wait set operations right to the kernel: the set of
+// interesting fds lives in the epoll instance and is only modified on
+// insert/erase instead of being passed in its entirety on each wait. Waits are
+// then O(signaled) instead of O(total) as the kernel only reports the fds that
+// are ready.
+//
+// epoll does not allow an fd to be registered more than once so we de-dupe
+// user handles the same way the win32 implementation does and only register
+// each unique fd once.
 struct iree_wait_set_t {
-  // NOTE: we could in theory use the epoll handle directly (iree_wait_set_s
-  // then is just a pointer). Then allocate/free just go straight to the system.
-  int reserved;
+  iree_allocator_t allocator;
+
+  // epoll instance holding one registration per unique fd in user_handles.
+  int epoll_fd;
+
+  // Total capacity of handles in the set (including duplicates).
+  // This defines the capacity of user_handles and events and to ensure that we
+  // don't get insanely hard to debug behavioral differences when some handles
+  // happen to be duplicates we track the total count against this total
+  // capacity including duplicates.
+  iree_host_size_t handle_capacity;
+
+  // Total number of handles in the set (including duplicates).
+  iree_host_size_t total_handle_count;
+
+  // Number of handles in the set (excluding duplicates), defining the valid
+  // size of user_handles.
+  iree_host_size_t handle_count;
+
+  // De-duped user-provided handles. iree_wait_handle_t::set_internal.dupe_count
+  // is used to indicate how many additional duplicates there are of a
+  // particular handle. The index of each handle in this list is stored in the
+  // epoll registration of its fd so that we can map events back to handles.
+  iree_wait_handle_t* user_handles;
+
+  // Storage for the events returned from epoll_wait.
+  struct epoll_event* events;
 };
 
 iree_status_t iree_wait_set_allocate(iree_host_size_t capacity,
                                      iree_allocator_t allocator,
                                      iree_wait_set_t** out_set) {
-  // TODO(benvanik): epoll_create()
+  IREE_ASSERT_ARGUMENT(out_set);
+
+  // Be reasonable; 64K objects is too high. Handle indices are also stored in
+  // the 16-bit iree_wait_handle_t::set_internal.index.
+  if (capacity >= UINT16_MAX) {
+    return iree_make_status(IREE_STATUS_INVALID_ARGUMENT,
+                            "wait set capacity of %zu is unreasonably large",
+                            capacity);
+  }
+
+  IREE_TRACE_ZONE_BEGIN(z0);
+
+  iree_host_size_t user_handle_list_size =
+      capacity * iree_sizeof_struct(iree_wait_handle_t);
+  iree_host_size_t event_list_size = capacity * sizeof(struct epoll_event);
+  iree_host_size_t total_size = iree_sizeof_struct(iree_wait_set_t) +
+                                user_handle_list_size + event_list_size;
+
+  iree_wait_set_t* set = NULL;
+  IREE_RETURN_AND_END_ZONE_IF_ERROR(
+      z0, iree_allocator_malloc(allocator, total_size, (void**)&set));
+  set->allocator = allocator;
+  set->handle_capacity = capacity;
+  set->total_handle_count = 0;
+  set->handle_count = 0;
+
+  set->user_handles =
+      (iree_wait_handle_t*)((uint8_t*)set +
+                            iree_sizeof_struct(iree_wait_set_t));
+  set->events = (struct epoll_event*)((uint8_t*)set->user_handles +
+                                      user_handle_list_size);
+
+  set->epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+  if (IREE_UNLIKELY(set->epoll_fd < 0)) {
+    iree_status_t status = iree_make_status(
+        iree_status_code_from_errno(errno), "epoll_create1 failure %d", errno);
+    iree_allocator_free(allocator, set);
+    IREE_TRACE_ZONE_END(z0);
+    return status;
+  }
+
+  *out_set = set;
+  IREE_TRACE_ZONE_END(z0);
+  return iree_ok_status();
 }
 
 void iree_wait_set_free(iree_wait_set_t* set) {
-  // TODO(benvanik): close()
+  if (!set) return;
+  IREE_TRACE_ZONE_BEGIN(z0);
+  close(set->epoll_fd);
+  iree_allocator_free(set->allocator, set);
+  IREE_TRACE_ZONE_END(z0);
+}
+
+bool iree_wait_set_is_empty(const iree_wait_set_t* set) {
+  return set->handle_count != 0;
 }
 
 iree_status_t iree_wait_set_insert(iree_wait_set_t* set,
                                    iree_wait_handle_t handle) {
-  // TODO(benvanik): epoll_ctl(EPOLL_CTL_ADD)
+  if (set->total_handle_count + 1 > set->handle_capacity) {
+    return iree_make_status(IREE_STATUS_RESOURCE_EXHAUSTED,
+                            "wait set capacity %" PRIhsz
+                            " reached; no more wait handles available",
+                            set->handle_capacity);
+  }
+
+  // First check to see if we already have the handle in the set; epoll rejects
+  // duplicate registrations of the same fd.
+  for (iree_host_size_t i = 0; i < set->handle_count; ++i) {
+    iree_wait_handle_t* existing_handle = &set->user_handles[i];
+    if (iree_wait_primitive_compare_identical(existing_handle, &handle)) {
+      // Handle already exists in the set; just increment the reference count.
+      ++existing_handle->set_internal.dupe_count;
+      ++set->total_handle_count;
+      return iree_ok_status();
+    }
+  }
+
+  iree_host_size_t index = set->handle_count;
+
+  // NOTE: handles without an fd (like immediate handles) are tracked but never
+  // registered, matching the poll behavior of ignoring negative fds.
+  int fd = iree_wait_primitive_get_read_fd(&handle);
+  if (fd >= 0) {
+    IREE_RETURN_IF_ERROR(iree_syscall_epoll_ctl(set->epoll_fd, EPOLL_CTL_ADD,
+                                                fd, IREE_WAIT_SET_EPOLL_EVENTS,
+                                                (uint32_t)index));
+  }
+
+  ++set->total_handle_count;
+  ++set->handle_count;
+  iree_wait_handle_t* user_handle = &set->user_handles[index];
+  iree_wait_handle_wrap_primitive(handle.type, handle.value, user_handle);
+  user_handle->set_internal.dupe_count = 0;  // just us so far
+
+  return iree_ok_status();
 }
 
 void iree_wait_set_erase(iree_wait_set_t* set, iree_wait_handle_t handle) {
-  // TODO(benvanik): epoll_ctl(EPOLL_CTL_DEL)
+  // Find the user handle in the set. This either requires a linear scan to
+  // find the matching user handle or - if valid - we can use the native index
+  // set after an iree_wait_any wake to do a quick lookup.
+  iree_host_size_t index = handle.set_internal.index;
+  if (IREE_UNLIKELY(index >= set->handle_count) ||
+      IREE_UNLIKELY(!iree_wait_primitive_compare_identical(
+          &set->user_handles[index], &handle))) {
+    // Fallback to a linear scan of (hopefully) a small list.
+    index = set->handle_count;
+    for (iree_host_size_t i = 0; i < set->handle_count; ++i) {
+      if (iree_wait_primitive_compare_identical(&set->user_handles[i],
+                                                &handle)) {
+        index = i;
+        break;
+      }
+    }
+    if (IREE_UNLIKELY(index == set->handle_count)) return;  // not found
+  }
+
+  // Decrement reference count.
+  iree_wait_handle_t* existing_handle = &set->user_handles[index];
+  if (existing_handle->set_internal.dupe_count > 0) {
+    // Still one or more remaining in the set; leave it registered.
+    --existing_handle->set_internal.dupe_count;
+    --set->total_handle_count;
+    return;
+  }
+
+  // No more references remaining; drop the registration. Errors are ignored as
+  // the only failure is that the fd has already been closed (which implicitly
+  // removes it from the epoll instance).
+  int fd = iree_wait_primitive_get_read_fd(existing_handle);
+  if (fd >= 0) {
+    epoll_ctl(set->epoll_fd, EPOLL_CTL_DEL, fd, NULL);
+  }
+
+  // Since we make no guarantees about the order of the list we can just swap
+  // with the last value. The moved handle has its registration updated to
+  // point at its new index.
+  iree_host_size_t tail_index = set->handle_count - 1;
+  if (tail_index > index) {
+    memcpy(&set->user_handles[index], &set->user_handles[tail_index],
+           sizeof(*set->user_handles));
+    int tail_fd = iree_wait_primitive_get_read_fd(&set->user_handles[index]);
+    if (tail_fd >= 0) {
+      iree_status_ignore(iree_syscall_epoll_ctl(set->epoll_fd, EPOLL_CTL_MOD,
+                                                tail_fd,
+                                                IREE_WAIT_SET_EPOLL_EVENTS,
+                                                (uint32_t)index));
+    }
+  }
+  --set->total_handle_count;
+  --set->handle_count;
 }
 
 void iree_wait_set_clear(iree_wait_set_t* set) {
-  // TODO(benvanik): close and reopen?
+  for (iree_host_size_t i = 0; i < set->handle_count; ++i) {
+    int fd = iree_wait_primitive_get_read_fd(&set->user_handles[i]);
+    if (fd >= 0) {
+      epoll_ctl(set->epoll_fd, EPOLL_CTL_DEL, fd, NULL);
+    }
+  }
+  set->total_handle_count = 0;
+  set->handle_count = 0;
+}
+
+// Maps an epoll event bitfield result to a status (on failure) and an indicator
+// of whether the event was signaled.
+static iree_status_t iree_wait_set_resolve_epoll_events(uint32_t events,
+                                                        bool* out_signaled) {
+  if (events & EPOLLERR) {
+    return iree_make_status(IREE_STATUS_INTERNAL, "EPOLLERR on fd");
+  } else if (events & EPOLLHUP) {
+    return iree_make_status(IREE_STATUS_CANCELLED, "EPOLLHUP on fd");
+  }
+  *out_signaled = (events & (EPOLLIN | EPOLLPRI)) != 0;
+  return iree_ok_status();
 }
 
 iree_status_t iree_wait_all(iree_wait_set_t* set, iree_time_t deadline_ns) {
-  // TODO(benvanik): epoll_wait
+  // Make the syscall only when we have at least one valid fd.
+  // Don't use this as a sleep.
+  if (set->handle_count <= 0) {
+    return iree_ok_status();
+  }
+
+  IREE_TRACE_ZONE_BEGIN(z0);
+
+  // TODO(benvanik): see if we can use tracy's mutex tracking to make waits
+  // nicer (at least showing signal->wait relations).
+
+  // Only fds that are registered can be signaled; unregistered handles are
+  // ignored as with poll.
+  int unsignaled_count = 0;
+  for (iree_host_size_t i = 0; i < set->handle_count; ++i) {
+    if (iree_wait_primitive_get_read_fd(&set->user_handles[i]) >= 0) {
+      ++unsignaled_count;
+    }
+  }
+
+  // Wait-all requires that we repeatedly wait until all handles have been
+  // signaled. In the common case everything is already signaled and a single
+  // epoll_wait returns all of them. Otherwise we disarm the registrations of
+  // any fds that have signaled so that the kernel stops reporting them and
+  // keep waiting on the remainder. Disarmed fds are rearmed before returning
+  // so that the set is ready for the next wait.
+  iree_status_t status = iree_ok_status();
+  bool any_disarmed = false;
+  while (unsignaled_count > 0) {
+    int signaled_count = 0;
+    status = iree_syscall_epoll_wait(set->epoll_fd, set->events,
+                                     (int)set->handle_count, deadline_ns,
+                                     &signaled_count);
+    if (!iree_status_is_ok(status)) break;
+    for (int i = 0; i < signaled_count; ++i) {
+      bool signaled = false;
+      status = iree_wait_set_resolve_epoll_events(set->events[i].events,
+                                                  &signaled);
+      if (!iree_status_is_ok(status)) break;
+      if (!signaled) continue;
+      --unsignaled_count;
+      if (unsignaled_count == 0) break;
+      iree_host_size_t index = set->events[i].data.u32;
+      int fd = iree_wait_primitive_get_read_fd(&set->user_handles[index]);
+      status = iree_syscall_epoll_ctl(set->epoll_fd, EPOLL_CTL_MOD, fd,
+                                      /*events=*/0, (uint32_t)index);
+      if (!iree_status_is_ok(status)) break;
+      any_disarmed = true;
+    }
+    if (!iree_status_is_ok(status)) break;
+  }
+
+  // Rearm any fds we disarmed during the wait. This is O(handle_count) but
+  // only happens when the wait actually had to block on some subset.
+  if (any_disarmed) {
+    for (iree_host_size_t i = 0; i < set->handle_count; ++i) {
+      int fd = iree_wait_primitive_get_read_fd(&set->user_handles[i]);
+      if (fd < 0) continue;
+      status = iree_status_join(
+          status, iree_syscall_epoll_ctl(set->epoll_fd, EPOLL_CTL_MOD, fd,
+                                         IREE_WAIT_SET_EPOLL_EVENTS,
+                                         (uint32_t)i));
+    }
+  }
+
+  IREE_TRACE_ZONE_END(z0);
+  return status;
 }
 
 iree_status_t iree_wait_any(iree_wait_set_t* set, iree_time_t deadline_ns,
                             iree_wait_handle_t* out_wake_handle) {
-  // TODO(benvanik): epoll_wait
+  // Make the syscall only when we have at least one valid fd.
+  // Don't use this as a sleep.
+  if (set->handle_count <= 0) {
+    memset(out_wake_handle, 0, sizeof(*out_wake_handle));
+    return iree_ok_status();
+  }
+
+  IREE_TRACE_ZONE_BEGIN(z0);
+
+  // TODO(benvanik): see if we can use tracy's mutex tracking to make waits
+  // nicer (at least showing signal->wait relations).
+
+  // We only need one handle so only ask for one event; the kernel will hand
+  // back whichever ready fd is first in its ready list.
+  int signaled_count = 0;
+  IREE_RETURN_AND_END_ZONE_IF_ERROR(
+      z0, iree_syscall_epoll_wait(set->epoll_fd, set->events, /*max_events=*/1,
+                                  deadline_ns, &signaled_count));
+
+  memset(out_wake_handle, 0, sizeof(*out_wake_handle));
+  if (signaled_count > 0) {
+    bool signaled = false;
+    IREE_RETURN_AND_END_ZONE_IF_ERROR(
+        z0, iree_wait_set_resolve_epoll_events(set->events[0].events,
+                                               &signaled));
+    if (signaled) {
+      iree_host_size_t index = set->events[0].data.u32;
+      memcpy(out_wake_handle, &set->user_handles[index],
+             sizeof(*out_wake_handle));
+      out_wake_handle->set_internal.index = index;
+    }
+  }
+
+  IREE_TRACE_ZONE_END(z0);
+  return iree_ok_status();
 }
 
 iree_status_t iree_wait_one(iree_wait_handle_t* handle,
                             iree_time_t deadline_ns) {
-  // TODO(benvanik): just use poll?
+  // Creating an epoll instance for a single fd would cost more syscalls than
+  // the wait itself so we use ppoll directly.
+  struct pollfd poll_fds;
+  poll_fds.fd = iree_wait_primitive_get_read_fd(handle);
+  if (poll_fds.fd == -1) return false;
+  poll_fds.events = POLLIN;
+  poll_fds.revents = 0;
+
+  IREE_TRACE_ZONE_BEGIN(z0);
+
+  int rv = -1;
+  do {
+    // Convert the deadline into a tmo_p struct for ppoll; this must be done
+    // each iteration as an interrupted ppoll may have taken some of the time.
+    struct timespec timeout_ts;
+    struct timespec* tmo_p = &timeout_ts;
+    memset(&timeout_ts, 0, sizeof(timeout_ts));
+    if (deadline_ns == IREE_TIME_INFINITE_FUTURE) {
+      tmo_p = NULL;
+    } else if (deadline_ns != IREE_TIME_INFINITE_PAST) {
+      iree_duration_t timeout_ns = deadline_ns - iree_time_now();
+      if (timeout_ns > 0) {
+        timeout_ts.tv_sec = (time_t)(timeout_ns / 1000000000ull);
+        timeout_ts.tv_nsec = (long)(timeout_ns % 1000000000ull);
+      }
+    }
+    rv = ppoll(&poll_fds, 1, tmo_p, NULL);
+  } while (rv < 0 && errno == EINTR);
+  if (IREE_UNLIKELY(rv < 0)) {
+    IREE_TRACE_ZONE_END(z0);
+    return iree_make_status(iree_status_code_from_errno(errno),
+                            "ppoll failure %d", errno);
+  }
+
+  IREE_TRACE_ZONE_END(z0);
+  return rv > 0 ? iree_ok_status()
+                : iree_status_from_code(IREE_STATUS_DEADLINE_EXCEEDED);
 }
 
 #endif  // IREE_WAIT_API == IREE_WAIT_API_EPOLL
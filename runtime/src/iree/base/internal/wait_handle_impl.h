@@ -41,6 +41,9 @@
 #define IREE_WAIT_API_PPOLL 4
 #define IREE_WAIT_API_EPOLL 5
 #define IREE_WAIT_API_KQUEUE 6
+// Linux io_uring (5.5+). Never selected by default as many sandboxes and older
+// kernels block or lack it; opt in with -DIREE_WAIT_API=7.
+#define IREE_WAIT_API_IO_URING 7
 
 // We allow overriding the wait API via command line flags. If unspecified we
 // try to guess based on the target platform.
@@ -54,12 +57,13 @@
 #elif defined(IREE_PLATFORM_WINDOWS)
 #define IREE_WAIT_API IREE_WAIT_API_WIN32  // WFMO used in wait_handle_win32.c
 #else
-// TODO(benvanik): EPOLL on android/linux/bsd/etc.
-// TODO(benvanik): KQUEUE on mac/ios.
-// KQUEUE is not implemented yet. Use POLL for mac/ios
-// Android ppoll requires API version >= 21
-#if !defined(IREE_PLATFORM_APPLE) && \
+// Android epoll_create1 and ppoll require API version >= 21
+#if defined(IREE_PLATFORM_APPLE)
+#define IREE_WAIT_API IREE_WAIT_API_KQUEUE
+#elif defined(IREE_PLATFORM_LINUX) && \
     (!defined(__ANDROID_API__) || __ANDROID_API__ >= 21)
+#define IREE_WAIT_API IREE_WAIT_API_EPOLL
+#elif !defined(__ANDROID_API__) || __ANDROID_API__ >= 21
 #define IREE_WAIT_API IREE_WAIT_API_PPOLL
 #else
 #define IREE_WAIT_API IREE_WAIT_API_POLL
@@ -70,10 +74,11 @@
 
 // Many implementations share the same posix-like nature (file descriptors/etc)
 // and can share most of their code.
-#if (IREE_WAIT_API == IREE_WAIT_API_POLL) ||  \
-    (IREE_WAIT_API == IREE_WAIT_API_PPOLL) || \
-    (IREE_WAIT_API == IREE_WAIT_API_EPOLL) || \
-    (IREE_WAIT_API == IREE_WAIT_API_KQUEUE)
+#if (IREE_WAIT_API == IREE_WAIT_API_POLL) ||   \
+    (IREE_WAIT_API == IREE_WAIT_API_PPOLL) ||  \
+    (IREE_WAIT_API == IREE_WAIT_API_EPOLL) ||  \
+    (IREE_WAIT_API == IREE_WAIT_API_KQUEUE) || \
+    (IREE_WAIT_API == IREE_WAIT_API_IO_URING)
 #define IREE_WAIT_API_POSIX_LIKE 1
 #endif  // IREE_WAIT_API = posix-like
 
@@ -66,6 +66,14 @@ void iree_wait_handle_close(iree_wait_handle_t* handle) {
   iree_wait_handle_deinitialize(handle);
 }
 
+iree_status_t iree_wait_handle_clone(const iree_wait_handle_t* handle,
+                                     iree_wait_handle_t* out_handle) {
+  // Futexes are owned by their handle and have no reference count to share.
+  return iree_make_status(IREE_STATUS_UNAVAILABLE,
+                          "wait primitive type %d cannot be cloned",
+                          (int)handle->type);
+}
+
 //===----------------------------------------------------------------------===//
 // Multi-wait emulation
 //===----------------------------------------------------------------------===//
@@ -0,0 +1,710 @@
+// Copyright 2023 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+// NOTE: must be first to ensure that we can define settings for all includes.
+#include "iree/base/internal/wait_handle_impl.h"
+
+#if IREE_WAIT_API == IREE_WAIT_API_IO_URING
+
+#include <errno.h>
+#include <linux/io_uring.h>
+#include <poll.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "iree/base/internal/wait_handle_posix.h"
+#include "iree/base/tracing.h"
+
+//===----------------------------------------------------------------------===//
+// Platform utilities
+//===----------------------------------------------------------------------===//
+
+// Events we poll for on each fd. POLLERR and POLLHUP are always reported.
+#define IREE_WAIT_SET_IO_URING_EVENTS (POLLIN | POLLPRI)
+
+// Kinds of operations encoded in the upper bits of the completion user data.
+// Operations we don't care about the completion of (like removals) use IGNORE.
+#define IREE_WAIT_SET_IO_URING_KIND_IGNORE 0ull
+#define IREE_WAIT_SET_IO_URING_KIND_POLL 1ull
+#define IREE_WAIT_SET_IO_URING_KIND_TIMEOUT 2ull
+
+// Encodes |kind| with a |generation| and |slot| index into the user data
+// carried through an operation to its completion.
+static inline uint64_t iree_wait_set_io_uring_user_data(uint64_t kind,
+                                                        uint32_t generation,
+                                                        uint16_t slot) {
+  return (kind << 56) | ((uint64_t)generation << 16) | slot;
+}
+
+// A mapped io_uring instance. We talk to the kernel directly instead of taking
+// a dependency on liburing as we only need a handful of operations.
+//
+// Documentation: https://kernel.dk/io_uring.pdf
+typedef struct iree_io_uring_t {
+  int fd;
+
+  // Submission queue ring and entries.
+  void* sq_ring_ptr;
+  size_t sq_ring_size;
+  unsigned* sq_head;
+  unsigned* sq_tail;
+  unsigned sq_mask;
+  unsigned sq_entries;
+  unsigned* sq_array;
+  struct io_uring_sqe* sqes;
+  size_t sqes_size;
+
+  // Completion queue ring. Shares the mapping of the submission queue ring.
+  unsigned* cq_head;
+  unsigned* cq_tail;
+  unsigned cq_mask;
+  struct io_uring_cqe* cqes;
+
+  // Number of entries made visible to the kernel but not yet submitted.
+  unsigned pending_count;
+} iree_io_uring_t;
+
+// Documentation: https://man7.org/linux/man-pages/man2/io_uring_setup.2.html
+static iree_status_t iree_io_uring_initialize(unsigned entries,
+                                              iree_io_uring_t* out_ring) {
+  memset(out_ring, 0, sizeof(*out_ring));
+  out_ring->fd = -1;
+
+  struct io_uring_params params;
+  memset(&params, 0, sizeof(params));
+  int fd = (int)syscall(__NR_io_uring_setup, entries, &params);
+  if (IREE_UNLIKELY(fd < 0)) {
+    return iree_make_status(iree_status_code_from_errno(errno),
+                            "io_uring_setup failure %d", errno);
+  }
+  out_ring->fd = fd;
+
+  // We rely on completions never being dropped when the completion queue is
+  // full (5.5+) and on the rings sharing a single mapping (5.4+).
+  const unsigned required_features =
+      IORING_FEAT_SINGLE_MMAP | IORING_FEAT_NODROP;
+  if ((params.features & required_features) != required_features) {
+    close(fd);
+    out_ring->fd = -1;
+    return iree_make_status(IREE_STATUS_UNAVAILABLE,
+                            "io_uring lacks required features (have %08X)",
+                            params.features);
+  }
+
+  size_t sq_ring_size =
+      params.sq_off.array + params.sq_entries * sizeof(unsigned);
+  size_t cq_ring_size =
+      params.cq_off.cqes + params.cq_entries * sizeof(struct io_uring_cqe);
+  out_ring->sq_ring_size = iree_max(sq_ring_size, cq_ring_size);
+  out_ring->sq_ring_ptr =
+      mmap(NULL, out_ring->sq_ring_size, PROT_READ | PROT_WRITE,
+           MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_SQ_RING);
+  if (out_ring->sq_ring_ptr == MAP_FAILED) {
+    iree_status_t status =
+        iree_make_status(iree_status_code_from_errno(errno),
+                         "io_uring ring mmap failure %d", errno);
+    close(fd);
+    memset(out_ring, 0, sizeof(*out_ring));
+    out_ring->fd = -1;
+    return status;
+  }
+  out_ring->sqes_size = params.sq_entries * sizeof(struct io_uring_sqe);
+  out_ring->sqes =
+      (struct io_uring_sqe*)mmap(NULL, out_ring->sqes_size,
+                                 PROT_READ | PROT_WRITE,
+                                 MAP_SHARED | MAP_POPULATE, fd,
+                                 IORING_OFF_SQES);
+  if (out_ring->sqes == MAP_FAILED) {
+    iree_status_t status =
+        iree_make_status(iree_status_code_from_errno(errno),
+                         "io_uring sqe mmap failure %d", errno);
+    munmap(out_ring->sq_ring_ptr, out_ring->sq_ring_size);
+    close(fd);
+    memset(out_ring, 0, sizeof(*out_ring));
+    out_ring->fd = -1;
+    return status;
+  }
+
+  uint8_t* ring_ptr = (uint8_t*)out_ring->sq_ring_ptr;
+  out_ring->sq_head = (unsigned*)(ring_ptr + params.sq_off.head);
+  out_ring->sq_tail = (unsigned*)(ring_ptr + params.sq_off.tail);
+  out_ring->sq_mask = *(unsigned*)(ring_ptr + params.sq_off.ring_mask);
+  out_ring->sq_entries = *(unsigned*)(ring_ptr + params.sq_off.ring_entries);
+  out_ring->sq_array = (unsigned*)(ring_ptr + params.sq_off.array);
+  out_ring->cq_head = (unsigned*)(ring_ptr + params.cq_off.head);
+  out_ring->cq_tail = (unsigned*)(ring_ptr + params.cq_off.tail);
+  out_ring->cq_mask = *(unsigned*)(ring_ptr + params.cq_off.ring_mask);
+  out_ring->cqes = (struct io_uring_cqe*)(ring_ptr + params.cq_off.cqes);
+  return iree_ok_status();
+}
+
+static void iree_io_uring_deinitialize(iree_io_uring_t* ring) {
+  if (ring->fd < 0) return;
+  munmap(ring->sqes, ring->sqes_size);
+  munmap(ring->sq_ring_ptr, ring->sq_ring_size);
+  close(ring->fd);
+  memset(ring, 0, sizeof(*ring));
+  ring->fd = -1;
+}
+
+// Submits all pending entries and optionally waits for |min_complete|
+// completions to be available. io_uring_enter may be interrupted with an EINTR
+// in which case we retry: any submissions made prior to the interruption have
+// been consumed by the kernel and are not resubmitted.
+//
+// Documentation: https://man7.org/linux/man-pages/man2/io_uring_enter.2.html
+static iree_status_t iree_io_uring_enter(iree_io_uring_t* ring,
+                                         unsigned min_complete) {
+  unsigned flags = min_complete > 0 ? IORING_ENTER_GETEVENTS : 0;
+  do {
+    int rv = (int)syscall(__NR_io_uring_enter, ring->fd, ring->pending_count,
+                          min_complete, flags, NULL, 0);
+    if (rv >= 0) {
+      ring->pending_count -= iree_min((unsigned)rv, ring->pending_count);
+      if (ring->pending_count == 0 || min_complete == 0) break;
+    } else if (errno == EINTR) {
+      continue;
+    } else if (errno == EBUSY || errno == EAGAIN) {
+      // Completion queue backlogged; the caller must reap before submitting
+      // more. Waits will reap on the next iteration.
+      break;
+    } else {
+      return iree_make_status(iree_status_code_from_errno(errno),
+                              "io_uring_enter failure %d", errno);
+    }
+  } while (true);
+  return iree_ok_status();
+}
+
+// Returns a zeroed submission queue entry, submitting pending entries to make
+// space if the submission queue is full.
+static iree_status_t iree_io_uring_get_sqe(iree_io_uring_t* ring,
+                                           struct io_uring_sqe** out_sqe) {
+  unsigned tail = *ring->sq_tail;
+  if (tail - __atomic_load_n(ring->sq_head, __ATOMIC_ACQUIRE) >=
+      ring->sq_entries) {
+    IREE_RETURN_IF_ERROR(iree_io_uring_enter(ring, /*min_complete=*/0));
+    if (tail - __atomic_load_n(ring->sq_head, __ATOMIC_ACQUIRE) >=
+        ring->sq_entries) {
+      return iree_make_status(IREE_STATUS_RESOURCE_EXHAUSTED,
+                              "io_uring submission queue full");
+    }
+  }
+  unsigned index = tail & ring->sq_mask;
+  struct io_uring_sqe* sqe = &ring->sqes[index];
+  memset(sqe, 0, sizeof(*sqe));
+  ring->sq_array[index] = index;
+  *out_sqe = sqe;
+  return iree_ok_status();
+}
+
+// Makes the entry most recently returned by iree_io_uring_get_sqe visible to
+// the kernel. It will be submitted on the next iree_io_uring_enter.
+static void iree_io_uring_commit_sqe(iree_io_uring_t* ring) {
+  __atomic_store_n(ring->sq_tail, *ring->sq_tail + 1, __ATOMIC_RELEASE);
+  ++ring->pending_count;
+}
+
+//===----------------------------------------------------------------------===//
+// iree_wait_set_t
+//===----------------------------------------------------------------------===//
+
+enum iree_wait_set_slot_flag_bits_t {
+  // Slot holds a handle in the set.
+  IREE_WAIT_SET_SLOT_FLAG_IN_USE = 1u << 0,
+  // A poll is in-flight for the handle fd.
+  IREE_WAIT_SET_SLOT_FLAG_ARMED = 1u << 1,
+  // The poll completed and the result has not yet been consumed by a wait.
+  IREE_WAIT_SET_SLOT_FLAG_SIGNALED = 1u << 2,
+};
+
+typedef struct iree_wait_set_slot_t {
+  // User handle. set_internal.dupe_count indicates how many additional
+  // duplicates there are of the handle.
+  iree_wait_handle_t handle;
+  // Bumped each time the slot is reused so that completions of polls issued
+  // for prior occupants can be identified and dropped.
+  uint32_t generation;
+  // Bitfield of IREE_WAIT_SET_SLOT_FLAG_*.
+  uint32_t flags;
+  // Result of the last completed poll as either revents or -errno.
+  int32_t result;
+} iree_wait_set_slot_t;
+
+// io_uring lets waits persist across calls: a poll is issued for each fd once
+// and stays in-flight until it completes or the handle is erased, so repeated
+// waits on a mostly unchanged set only issue polls for the fds that signaled
+// since the last wait. All new polls, removals of erased handles, and the
+// timeout for a wait are submitted with a single io_uring_enter that also
+// waits for completions.
+//
+// Polls are one-shot: a completion indicates the fd was signaled at some point
+// after the poll was issued and the slot is not rearmed until the signal has
+// been consumed by a wait. Handles are stored in fixed slots (instead of being
+// compacted as in the other implementations) so that the slot index carried in
+// each in-flight poll remains valid when other handles are erased.
+struct iree_wait_set_t {
+  iree_allocator_t allocator;
+
+  iree_io_uring_t ring;
+
+  // Total capacity of handles in the set (including duplicates).
+  iree_host_size_t handle_capacity;
+
+  // Total number of handles in the set (including duplicates).
+  iree_host_size_t total_handle_count;
+
+  // Number of handles in the set (excluding duplicates).
+  iree_host_size_t handle_count;
+
+  // Generation of the timeout of the current wait; completions of timeouts
+  // from prior waits are ignored.
+  uint32_t timeout_generation;
+
+  // Storage for the timeout of the current wait. The kernel reads this during
+  // submission.
+  struct __kernel_timespec timeout_ts;
+
+  // Fixed slots for each unique handle in the set.
+  iree_wait_set_slot_t slots[];
+};
+
+iree_status_t iree_wait_set_allocate(iree_host_size_t capacity,
+                                     iree_allocator_t allocator,
+                                     iree_wait_set_t** out_set) {
+  IREE_ASSERT_ARGUMENT(out_set);
+
+  // Be reasonable; 64K objects is too high. Handle indices are also stored in
+  // the 16-bit iree_wait_handle_t::set_internal.index.
+  if (capacity >= UINT16_MAX) {
+    return iree_make_status(IREE_STATUS_INVALID_ARGUMENT,
+                            "wait set capacity of %zu is unreasonably large",
+                            capacity);
+  }
+
+  IREE_TRACE_ZONE_BEGIN(z0);
+
+  iree_host_size_t total_size =
+      sizeof(iree_wait_set_t) + capacity * sizeof(iree_wait_set_slot_t);
+  iree_wait_set_t* set = NULL;
+  IREE_RETURN_AND_END_ZONE_IF_ERROR(
+      z0, iree_allocator_malloc(allocator, total_size, (void**)&set));
+  memset(set, 0, total_size);
+  set->allocator = allocator;
+  set->handle_capacity = capacity;
+
+  // Each handle has at most one poll in-flight and erasing it adds a removal.
+  // The kernel rounds up to a power of two and sizes the completion queue at
+  // twice the submission queue.
+  iree_status_t status =
+      iree_io_uring_initialize((unsigned)(capacity * 2 + 2), &set->ring);
+  if (!iree_status_is_ok(status)) {
+    iree_allocator_free(allocator, set);
+    IREE_TRACE_ZONE_END(z0);
+    return status;
+  }
+
+  *out_set = set;
+  IREE_TRACE_ZONE_END(z0);
+  return iree_ok_status();
+}
+
+void iree_wait_set_free(iree_wait_set_t* set) {
+  if (!set) return;
+  IREE_TRACE_ZONE_BEGIN(z0);
+  // Closing the ring cancels all in-flight operations.
+  iree_io_uring_deinitialize(&set->ring);
+  iree_allocator_free(set->allocator, set);
+  IREE_TRACE_ZONE_END(z0);
+}
+
+bool iree_wait_set_is_empty(const iree_wait_set_t* set) {
+  return set->handle_count != 0;
+}
+
+// Reaps all available completions and updates the slots they reference.
+// Sets |out_timed_out| if the timeout of the current wait expired and
+// |out_timeout_completed| if it completed for any reason.
+static void iree_wait_set_reap(iree_wait_set_t* set, bool* out_timed_out,
+                               bool* out_timeout_completed) {
+  iree_io_uring_t* ring = &set->ring;
+  unsigned head = *ring->cq_head;
+  unsigned tail = __atomic_load_n(ring->cq_tail, __ATOMIC_ACQUIRE);
+  for (; head != tail; ++head) {
+    const struct io_uring_cqe* cqe = &ring->cqes[head & ring->cq_mask];
+    uint64_t kind = cqe->user_data >> 56;
+    uint32_t generation = (uint32_t)(cqe->user_data >> 16);
+    uint16_t slot_index = (uint16_t)cqe->user_data;
+    if (kind == IREE_WAIT_SET_IO_URING_KIND_POLL) {
+      iree_wait_set_slot_t* slot = &set->slots[slot_index];
+      if (slot->generation != generation ||
+          !(slot->flags & IREE_WAIT_SET_SLOT_FLAG_ARMED)) {
+        continue;  // stale
+      }
+      slot->flags &= ~IREE_WAIT_SET_SLOT_FLAG_ARMED;
+      slot->flags |= IREE_WAIT_SET_SLOT_FLAG_SIGNALED;
+      slot->result = cqe->res;
+    } else if (kind == IREE_WAIT_SET_IO_URING_KIND_TIMEOUT) {
+      if (generation != set->timeout_generation) continue;  // stale
+      if (out_timeout_completed) *out_timeout_completed = true;
+      if (cqe->res == -ETIME && out_timed_out) *out_timed_out = true;
+    }
+  }
+  __atomic_store_n(ring->cq_head, head, __ATOMIC_RELEASE);
+}
+
+// Queues a removal of the in-flight poll of |slot|, if any. The removal is
+// submitted with the next io_uring_enter.
+static iree_status_t iree_wait_set_disarm_slot(iree_wait_set_t* set,
+                                               uint16_t slot_index) {
+  iree_wait_set_slot_t* slot = &set->slots[slot_index];
+  if (!(slot->flags & IREE_WAIT_SET_SLOT_FLAG_ARMED)) return iree_ok_status();
+  struct io_uring_sqe* sqe = NULL;
+  IREE_RETURN_IF_ERROR(iree_io_uring_get_sqe(&set->ring, &sqe));
+  sqe->opcode = IORING_OP_POLL_REMOVE;
+  sqe->fd = -1;
+  sqe->addr = iree_wait_set_io_uring_user_data(
+      IREE_WAIT_SET_IO_URING_KIND_POLL, slot->generation, slot_index);
+  sqe->user_data = iree_wait_set_io_uring_user_data(
+      IREE_WAIT_SET_IO_URING_KIND_IGNORE, 0, 0);
+  iree_io_uring_commit_sqe(&set->ring);
+  slot->flags &= ~IREE_WAIT_SET_SLOT_FLAG_ARMED;
+  return iree_ok_status();
+}
+
+iree_status_t iree_wait_set_insert(iree_wait_set_t* set,
+                                   iree_wait_handle_t handle) {
+  if (set->total_handle_count + 1 > set->handle_capacity) {
+    return iree_make_status(IREE_STATUS_RESOURCE_EXHAUSTED,
+                            "wait set capacity %" PRIhsz
+                            " reached; no more wait handles available",
+                            set->handle_capacity);
+  }
+
+  // First check to see if we already have the handle in the set. Polling the
+  // same fd multiple times is allowed but there's no benefit.
+  iree_host_size_t free_index = set->handle_capacity;
+  for (iree_host_size_t i = 0; i < set->handle_capacity; ++i) {
+    iree_wait_set_slot_t* slot = &set->slots[i];
+    if (!(slot->flags & IREE_WAIT_SET_SLOT_FLAG_IN_USE)) {
+      if (free_index == set->handle_capacity) free_index = i;
+      continue;
+    }
+    if (iree_wait_primitive_compare_identical(&slot->handle, &handle)) {
+      // Handle already exists in the set; just increment the reference count.
+      ++slot->handle.set_internal.dupe_count;
+      ++set->total_handle_count;
+      return iree_ok_status();
+    }
+  }
+
+  // Polls are issued lazily by the next wait so that they can be batched.
+  iree_wait_set_slot_t* slot = &set->slots[free_index];
+  ++slot->generation;
+  slot->flags = IREE_WAIT_SET_SLOT_FLAG_IN_USE;
+  slot->result = 0;
+  iree_wait_handle_wrap_primitive(handle.type, handle.value, &slot->handle);
+  slot->handle.set_internal.dupe_count = 0;  // just us so far
+  ++set->total_handle_count;
+  ++set->handle_count;
+  return iree_ok_status();
+}
+
+// Returns the slot index of |handle| or the capacity if not found.
+static iree_host_size_t iree_wait_set_find_slot(
+    iree_wait_set_t* set, const iree_wait_handle_t* handle) {
+  // Use the native index set after an iree_wait_any wake if valid and
+  // otherwise fallback to a linear scan.
+  iree_host_size_t index = handle->set_internal.index;
+  if (index < set->handle_capacity &&
+      (set->slots[index].flags & IREE_WAIT_SET_SLOT_FLAG_IN_USE) &&
+      iree_wait_primitive_compare_identical(&set->slots[index].handle,
+                                            handle)) {
+    return index;
+  }
+  for (iree_host_size_t i = 0; i < set->handle_capacity; ++i) {
+    if ((set->slots[i].flags & IREE_WAIT_SET_SLOT_FLAG_IN_USE) &&
+        iree_wait_primitive_compare_identical(&set->slots[i].handle, handle)) {
+      return i;
+    }
+  }
+  return set->handle_capacity;
+}
+
+void iree_wait_set_erase(iree_wait_set_t* set, iree_wait_handle_t handle) {
+  iree_host_size_t index = iree_wait_set_find_slot(set, &handle);
+  if (IREE_UNLIKELY(index == set->handle_capacity)) return;  // not found
+
+  // Decrement reference count.
+  iree_wait_set_slot_t* slot = &set->slots[index];
+  if (slot->handle.set_internal.dupe_count > 0) {
+    // Still one or more remaining in the set; leave it registered.
+    --slot->handle.set_internal.dupe_count;
+    --set->total_handle_count;
+    return;
+  }
+
+  // No more references remaining; cancel the in-flight poll. Failure to queue
+  // the removal is ignored as the stale completion will be dropped when reaped
+  // by way of the generation bump on reuse.
+  iree_status_ignore(iree_wait_set_disarm_slot(set, (uint16_t)index));
+  slot->flags = 0;
+  --set->total_handle_count;
+  --set->handle_count;
+}
+
+void iree_wait_set_clear(iree_wait_set_t* set) {
+  for (iree_host_size_t i = 0; i < set->handle_capacity; ++i) {
+    iree_wait_set_slot_t* slot = &set->slots[i];
+    if (!(slot->flags & IREE_WAIT_SET_SLOT_FLAG_IN_USE)) continue;
+    iree_status_ignore(iree_wait_set_disarm_slot(set, (uint16_t)i));
+    slot->flags = 0;
+  }
+  set->total_handle_count = 0;
+  set->handle_count = 0;
+}
+
+// Maps a poll result to a status (on failure) and an indicator of whether the
+// fd was signaled.
+static iree_status_t iree_wait_set_resolve_poll_result(int32_t result,
+                                                       bool* out_signaled) {
+  *out_signaled = false;
+  if (result < 0) {
+    return iree_make_status(iree_status_code_from_errno(-result),
+                            "io_uring poll failure %d", -result);
+  } else if (result & POLLERR) {
+    return iree_make_status(IREE_STATUS_INTERNAL, "POLLERR on fd");
+  } else if (result & (POLLHUP | POLLNVAL)) {
+    return iree_make_status(IREE_STATUS_CANCELLED, "POLLHUP on fd");
+  }
+  *out_signaled = (result & IREE_WAIT_SET_IO_URING_EVENTS) != 0;
+  return iree_ok_status();
+}
+
+// Queues polls for all handles in the set that are neither in-flight nor have
+// an unconsumed signal.
+static iree_status_t iree_wait_set_arm(iree_wait_set_t* set) {
+  for (iree_host_size_t i = 0; i < set->handle_capacity; ++i) {
+    iree_wait_set_slot_t* slot = &set->slots[i];
+    if (slot->flags != IREE_WAIT_SET_SLOT_FLAG_IN_USE) continue;
+    int fd = iree_wait_primitive_get_read_fd(&slot->handle);
+    if (fd < 0) continue;  // not waitable (like immediate handles)
+    struct io_uring_sqe* sqe = NULL;
+    IREE_RETURN_IF_ERROR(iree_io_uring_get_sqe(&set->ring, &sqe));
+    sqe->opcode = IORING_OP_POLL_ADD;
+    sqe->fd = fd;
+    sqe->poll32_events = IREE_WAIT_SET_IO_URING_EVENTS;
+    sqe->user_data = iree_wait_set_io_uring_user_data(
+        IREE_WAIT_SET_IO_URING_KIND_POLL, slot->generation, (uint16_t)i);
+    iree_io_uring_commit_sqe(&set->ring);
+    slot->flags |= IREE_WAIT_SET_SLOT_FLAG_ARMED;
+  }
+  return iree_ok_status();
+}
+
+// Queues a timeout that completes when |deadline_ns| elapses or any other
+// completion is posted, whichever comes first.
+static iree_status_t iree_wait_set_arm_timeout(iree_wait_set_t* set,
+                                               iree_time_t deadline_ns) {
+  iree_duration_t timeout_ns = deadline_ns - iree_time_now();
+  if (timeout_ns < 0) timeout_ns = 0;
+  set->timeout_ts.tv_sec = (int64_t)(timeout_ns / 1000000000ull);
+  set->timeout_ts.tv_nsec = (long long)(timeout_ns % 1000000000ull);
+  struct io_uring_sqe* sqe = NULL;
+  IREE_RETURN_IF_ERROR(iree_io_uring_get_sqe(&set->ring, &sqe));
+  sqe->opcode = IORING_OP_TIMEOUT;
+  sqe->fd = -1;
+  sqe->addr = (uint64_t)(uintptr_t)&set->timeout_ts;
+  sqe->len = 1;
+  sqe->off = 1;  // complete early on any other completion
+  sqe->user_data = iree_wait_set_io_uring_user_data(
+      IREE_WAIT_SET_IO_URING_KIND_TIMEOUT, set->timeout_generation, 0);
+  iree_io_uring_commit_sqe(&set->ring);
+  return iree_ok_status();
+}
+
+// Returns true if the condition of the wait is satisfied and sets
+// |out_wake_index| to the first signaled slot (if any).
+static iree_status_t iree_wait_set_check(iree_wait_set_t* set, bool wait_all,
+                                         bool* out_satisfied,
+                                         iree_host_size_t* out_wake_index) {
+  *out_satisfied = wait_all;
+  *out_wake_index = set->handle_capacity;
+  for (iree_host_size_t i = 0; i < set->handle_capacity; ++i) {
+    iree_wait_set_slot_t* slot = &set->slots[i];
+    if (!(slot->flags & IREE_WAIT_SET_SLOT_FLAG_IN_USE)) continue;
+    if (iree_wait_primitive_get_read_fd(&slot->handle) < 0) continue;
+    bool signaled = false;
+    if (slot->flags & IREE_WAIT_SET_SLOT_FLAG_SIGNALED) {
+      IREE_RETURN_IF_ERROR(
+          iree_wait_set_resolve_poll_result(slot->result, &signaled));
+      if (!signaled) {
+        // Completed without a signal we care about; rearm.
+        slot->flags &= ~IREE_WAIT_SET_SLOT_FLAG_SIGNALED;
+      }
+    }
+    if (signaled && !wait_all) {
+      *out_satisfied = true;
+      *out_wake_index = i;
+      return iree_ok_status();
+    } else if (!signaled && wait_all) {
+      *out_satisfied = false;
+      return iree_ok_status();
+    }
+  }
+  return iree_ok_status();
+}
+
+// Waits until either any or all (|wait_all|) handles are signaled.
+static iree_status_t iree_wait_set_wait(iree_wait_set_t* set, bool wait_all,
+                                        iree_time_t deadline_ns,
+                                        iree_host_size_t* out_wake_index) {
+  // New timeout generation so that any stale timeouts are ignored.
+  ++set->timeout_generation;
+  bool timeout_armed = false;
+  while (true) {
+    // Reap anything that has completed since the last wait.
+    bool timed_out = false;
+    bool timeout_completed = false;
+    iree_wait_set_reap(set, &timed_out, &timeout_completed);
+    if (timeout_completed) timeout_armed = false;
+
+    bool satisfied = false;
+    IREE_RETURN_IF_ERROR(
+        iree_wait_set_check(set, wait_all, &satisfied, out_wake_index));
+    if (satisfied) break;
+    if (timed_out) {
+      return iree_status_from_code(IREE_STATUS_DEADLINE_EXCEEDED);
+    }
+
+    // Issue polls for anything not yet in-flight. Polls of fds that are
+    // already signaled complete during submission.
+    IREE_RETURN_IF_ERROR(iree_wait_set_arm(set));
+    if (deadline_ns == IREE_TIME_INFINITE_PAST ||
+        (deadline_ns != IREE_TIME_INFINITE_FUTURE &&
+         deadline_ns <= iree_time_now())) {
+      // Poll-only: submit and check what completed inline.
+      IREE_RETURN_IF_ERROR(iree_io_uring_enter(&set->ring, 0));
+      iree_wait_set_reap(set, NULL, NULL);
+      IREE_RETURN_IF_ERROR(
+          iree_wait_set_check(set, wait_all, &satisfied, out_wake_index));
+      if (satisfied) break;
+      return iree_status_from_code(IREE_STATUS_DEADLINE_EXCEEDED);
+    }
+    if (deadline_ns != IREE_TIME_INFINITE_FUTURE && !timeout_armed) {
+      IREE_RETURN_IF_ERROR(iree_wait_set_arm_timeout(set, deadline_ns));
+      timeout_armed = true;
+    }
+
+    // Submit everything and block until at least one completion.
+    IREE_RETURN_IF_ERROR(iree_io_uring_enter(&set->ring, 1));
+  }
+
+  // Consume the signals reported to the caller; their polls will be rearmed by
+  // the next wait.
+  if (wait_all) {
+    for (iree_host_size_t i = 0; i < set->handle_capacity; ++i) {
+      set->slots[i].flags &= ~IREE_WAIT_SET_SLOT_FLAG_SIGNALED;
+    }
+  } else if (*out_wake_index < set->handle_capacity) {
+    set->slots[*out_wake_index].flags &= ~IREE_WAIT_SET_SLOT_FLAG_SIGNALED;
+  }
+  return iree_ok_status();
+}
+
+iree_status_t iree_wait_all(iree_wait_set_t* set, iree_time_t deadline_ns) {
+  // Make the syscall only when we have at least one valid fd.
+  // Don't use this as a sleep.
+  if (set->handle_count <= 0) {
+    return iree_ok_status();
+  }
+
+  IREE_TRACE_ZONE_BEGIN(z0);
+
+  // TODO(benvanik): see if we can use tracy's mutex tracking to make waits
+  // nicer (at least showing signal->wait relations).
+
+  iree_host_size_t wake_index = 0;
+  iree_status_t status =
+      iree_wait_set_wait(set, /*wait_all=*/true, deadline_ns, &wake_index);
+
+  IREE_TRACE_ZONE_END(z0);
+  return status;
+}
+
+iree_status_t iree_wait_any(iree_wait_set_t* set, iree_time_t deadline_ns,
+                            iree_wait_handle_t* out_wake_handle) {
+  // Make the syscall only when we have at least one valid fd.
+  // Don't use this as a sleep.
+  if (set->handle_count <= 0) {
+    memset(out_wake_handle, 0, sizeof(*out_wake_handle));
+    return iree_ok_status();
+  }
+
+  IREE_TRACE_ZONE_BEGIN(z0);
+
+  // TODO(benvanik): see if we can use tracy's mutex tracking to make waits
+  // nicer (at least showing signal->wait relations).
+
+  memset(out_wake_handle, 0, sizeof(*out_wake_handle));
+  iree_host_size_t wake_index = set->handle_capacity;
+  IREE_RETURN_AND_END_ZONE_IF_ERROR(
+      z0, iree_wait_set_wait(set, /*wait_all=*/false, deadline_ns,
+                             &wake_index));
+  if (wake_index < set->handle_capacity) {
+    memcpy(out_wake_handle, &set->slots[wake_index].handle,
+           sizeof(*out_wake_handle));
+    out_wake_handle->set_internal.index = wake_index;
+  }
+
+  IREE_TRACE_ZONE_END(z0);
+  return iree_ok_status();
+}
+
+iree_status_t iree_wait_one(iree_wait_handle_t* handle,
+                            iree_time_t deadline_ns) {
+  // Creating a ring for a single fd would cost more syscalls than the wait
+  // itself so we use ppoll directly.
+  struct pollfd poll_fds;
+  poll_fds.fd = iree_wait_primitive_get_read_fd(handle);
+  if (poll_fds.fd == -1) return false;
+  poll_fds.events = POLLIN;
+  poll_fds.revents = 0;
+
+  IREE_TRACE_ZONE_BEGIN(z0);
+
+  int rv = -1;
+  do {
+    // Convert the deadline into a tmo_p struct for ppoll; this must be done
+    // each iteration as an interrupted ppoll may have taken some of the time.
+    struct timespec timeout_ts;
+    struct timespec* tmo_p = &timeout_ts;
+    memset(&timeout_ts, 0, sizeof(timeout_ts));
+    if (deadline_ns == IREE_TIME_INFINITE_FUTURE) {
+      tmo_p = NULL;
+    } else if (deadline_ns != IREE_TIME_INFINITE_PAST) {
+      iree_duration_t timeout_ns = deadline_ns - iree_time_now();
+      if (timeout_ns > 0) {
+        timeout_ts.tv_sec = (time_t)(timeout_ns / 1000000000ull);
+        timeout_ts.tv_nsec = (long)(timeout_ns % 1000000000ull);
+      }
+    }
+    rv = ppoll(&poll_fds, 1, tmo_p, NULL);
+  } while (rv < 0 && errno == EINTR);
+  if (IREE_UNLIKELY(rv < 0)) {
+    IREE_TRACE_ZONE_END(z0);
+    return iree_make_status(iree_status_code_from_errno(errno),
+                            "ppoll failure %d", errno);
+  }
+
+  IREE_TRACE_ZONE_END(z0);
+  return rv > 0 ? iree_ok_status()
+                : iree_status_from_code(IREE_STATUS_DEADLINE_EXCEEDED);
+}
+
+#endif  // IREE_WAIT_API == IREE_WAIT_API_IO_URING
@@ -9,55 +9,458 @@
 
 #if IREE_WAIT_API == IREE_WAIT_API_KQUEUE
 
+#include <errno.h>
+#include <poll.h>
+#include <sys/event.h>
+#include <sys/types.h>
+#include <time.h>
+#include <unistd.h>
+
 #include "iree/base/internal/wait_handle_posix.h"
 #include "iree/base/tracing.h"
 
 //===----------------------------------------------------------------------===//
-// iree_wait_set_t
+// Platform utilities
 //===----------------------------------------------------------------------===//
 
-// TODO(benvanik): iree_wait_set_s using a kqueue.
-// Could just cast the kqueue() fd to iree_wait_set_s* to avoid allocs.
+// kevent may spuriously wake with an EINTR. As with poll we don't do anything
+// with that opportunity but retry the wait with an updated timeout based on
+// the deadline.
+//
+// Documentation:
 // https://developer.apple.com/library/archive/documentation/System/Conceptual/ManPages_iPhoneOS/man2/kqueue.2.html
+static iree_status_t iree_syscall_kevent_wait(int kqueue_fd,
+                                              struct kevent* events,
+                                              int max_events,
+                                              iree_time_t deadline_ns,
+                                              int* out_signaled_count) {
+  *out_signaled_count = 0;
+  int rv = -1;
+  do {
+    // Convert the deadline into a timespec that controls whether the call is
+    // blocking or non-blocking. Note that we must do this every iteration of
+    // the loop as a previous kevent may have taken some of the time.
+    struct timespec timeout_ts;
+    struct timespec* timeout_p = &timeout_ts;
+    memset(&timeout_ts, 0, sizeof(timeout_ts));
+    if (deadline_ns == IREE_TIME_INFINITE_FUTURE) {
+      // Block forever (NULL timeout to kevent).
+      timeout_p = NULL;
+    } else if (deadline_ns != IREE_TIME_INFINITE_PAST) {
+      // Wait only for as much time as we have before the deadline is exceeded.
+      // If we've already passed the deadline we still perform the wait as a
+      // poll.
+      iree_duration_t timeout_ns = deadline_ns - iree_time_now();
+      if (timeout_ns > 0) {
+        timeout_ts.tv_sec = (time_t)(timeout_ns / 1000000000ull);
+        timeout_ts.tv_nsec = (long)(timeout_ns % 1000000000ull);
+      }
+    }
+    rv = kevent(kqueue_fd, /*changelist=*/NULL, /*nchanges=*/0, events,
+                max_events, timeout_p);
+  } while (rv < 0 && errno == EINTR);
+  if (rv > 0) {
+    // One or more events set.
+    *out_signaled_count = rv;
+    return iree_ok_status();
+  } else if (IREE_UNLIKELY(rv < 0)) {
+    return iree_make_status(iree_status_code_from_errno(errno),
+                            "kevent failure %d", errno);
+  }
+  // rv == 0
+  // Timeout; no events set.
+  return iree_status_from_code(IREE_STATUS_DEADLINE_EXCEEDED);
+}
+
+// Applies |flags| to the EVFILT_READ filter on |fd| in |kqueue_fd|.
+// |index| is stored as the user data and returned when the fd is signaled.
+static iree_status_t iree_syscall_kevent_change(int kqueue_fd, int fd,
+                                                uint16_t flags,
+                                                iree_host_size_t index) {
+  // EV_RECEIPT makes kevent return the result of the change in the eventlist
+  // instead of draining any pending events into it.
+  struct kevent change;
+  EV_SET(&change, fd, EVFILT_READ, flags | EV_RECEIPT, 0, 0,
+         (void*)(uintptr_t)index);
+  struct kevent result;
+  int rv = kevent(kqueue_fd, &change, 1, &result, 1, /*timeout=*/NULL);
+  if (IREE_UNLIKELY(rv < 0)) {
+    return iree_make_status(iree_status_code_from_errno(errno),
+                            "kevent change failure on fd %d: %d", fd, errno);
+  } else if (rv > 0 && (result.flags & EV_ERROR) && result.data != 0) {
+    return iree_make_status(iree_status_code_from_errno((int)result.data),
+                            "kevent change failure on fd %d: %d", fd,
+                            (int)result.data);
+  }
+  return iree_ok_status();
+}
+
+//===----------------------------------------------------------------------===//
+// iree_wait_set_t
+//===----------------------------------------------------------------------===//
+
+// kqueue lets us route the wait set operations right to the kernel: the set of
+// interesting fds lives in the kqueue and is only modified on insert/erase
+// instead of being passed in its entirety on each wait. Waits are then
+// O(signaled) instead of O(total) as the kernel only reports the fds that are
+// ready.
+//
+// NOTE: EVFILT_USER would avoid the pipe syscalls on signal but user events
+// only exist within a single kqueue while iree_event_t must be waitable from
+// any number of wait sets (and other processes/APIs as an fd). We instead
+// register the read end of the event fds with EVFILT_READ.
+//
+// kqueue identifies filters by (ident, filter) so like epoll we de-dupe user
+// handles the same way the win32 implementation does and only register each
+// unique fd once.
 struct iree_wait_set_t {
-  int reserved;
+  iree_allocator_t allocator;
+
+  // kqueue holding one EVFILT_READ registration per unique fd in user_handles.
+  int kqueue_fd;
+
+  // Total capacity of handles in the set (including duplicates).
+  // This defines the capacity of user_handles and events and to ensure that we
+  // don't get insanely hard to debug behavioral differences when some handles
+  // happen to be duplicates we track the total count against this total
+  // capacity including duplicates.
+  iree_host_size_t handle_capacity;
+
+  // Total number of handles in the set (including duplicates).
+  iree_host_size_t total_handle_count;
+
+  // Number of handles in the set (excluding duplicates), defining the valid
+  // size of user_handles.
+  iree_host_size_t handle_count;
+
+  // De-duped user-provided handles. iree_wait_handle_t::set_internal.dupe_count
+  // is used to indicate how many additional duplicates there are of a
+  // particular handle. The index of each handle in this list is stored as the
+  // udata of its kqueue registration so that we can map events back to
+  // handles.
+  iree_wait_handle_t* user_handles;
+
+  // Storage for the events returned from kevent.
+  struct kevent* events;
 };
 
 iree_status_t iree_wait_set_allocate(iree_host_size_t capacity,
                                      iree_allocator_t allocator,
                                      iree_wait_set_t** out_set) {
-  // TODO(benvanik): kqueue support
+  IREE_ASSERT_ARGUMENT(out_set);
+
+  // Be reasonable; 64K objects is too high. Handle indices are also stored in
+  // the 16-bit iree_wait_handle_t::set_internal.index.
+  if (capacity >= UINT16_MAX) {
+    return iree_make_status(IREE_STATUS_INVALID_ARGUMENT,
+                            "wait set capacity of %zu is unreasonably large",
+                            capacity);
+  }
+
+  IREE_TRACE_ZONE_BEGIN(z0);
+
+  iree_host_size_t user_handle_list_size =
+      capacity * iree_sizeof_struct(iree_wait_handle_t);
+  iree_host_size_t event_list_size = capacity * sizeof(struct kevent);
+  iree_host_size_t total_size = iree_sizeof_struct(iree_wait_set_t) +
+                                user_handle_list_size + event_list_size;
+
+  iree_wait_set_t* set = NULL;
+  IREE_RETURN_AND_END_ZONE_IF_ERROR(
+      z0, iree_allocator_malloc(allocator, total_size, (void**)&set));
+  set->allocator = allocator;
+  set->handle_capacity = capacity;
+  set->total_handle_count = 0;
+  set->handle_count = 0;
+
+  set->user_handles =
+      (iree_wait_handle_t*)((uint8_t*)set +
+                            iree_sizeof_struct(iree_wait_set_t));
+  set->events =
+      (struct kevent*)((uint8_t*)set->user_handles + user_handle_list_size);
+
+  // NOTE: kqueues are not inherited by forked children so there's no need for
+  // CLOEXEC-style handling.
+  set->kqueue_fd = kqueue();
+  if (IREE_UNLIKELY(set->kqueue_fd < 0)) {
+    iree_status_t status = iree_make_status(iree_status_code_from_errno(errno),
+                                            "kqueue failure %d", errno);
+    iree_allocator_free(allocator, set);
+    IREE_TRACE_ZONE_END(z0);
+    return status;
+  }
+
+  *out_set = set;
+  IREE_TRACE_ZONE_END(z0);
+  return iree_ok_status();
 }
 
 void iree_wait_set_free(iree_wait_set_t* set) {
-  // TODO(benvanik): close()
+  if (!set) return;
+  IREE_TRACE_ZONE_BEGIN(z0);
+  close(set->kqueue_fd);
+  iree_allocator_free(set->allocator, set);
+  IREE_TRACE_ZONE_END(z0);
+}
+
+bool iree_wait_set_is_empty(const iree_wait_set_t* set) {
+  return set->handle_count != 0;
 }
 
 iree_status_t iree_wait_set_insert(iree_wait_set_t* set,
                                    iree_wait_handle_t handle) {
-  // TODO(benvanik): kqueue support
+  if (set->total_handle_count + 1 > set->handle_capacity) {
+    return iree_make_status(IREE_STATUS_RESOURCE_EXHAUSTED,
+                            "wait set capacity %" PRIhsz
+                            " reached; no more wait handles available",
+                            set->handle_capacity);
+  }
+
+  // First check to see if we already have the handle in the set; re-adding the
+  // same fd would just modify the existing registration.
+  for (iree_host_size_t i = 0; i < set->handle_count; ++i) {
+    iree_wait_handle_t* existing_handle = &set->user_handles[i];
+    if (iree_wait_primitive_compare_identical(existing_handle, &handle)) {
+      // Handle already exists in the set; just increment the reference count.
+      ++existing_handle->set_internal.dupe_count;
+      ++set->total_handle_count;
+      return iree_ok_status();
+    }
+  }
+
+  iree_host_size_t index = set->handle_count;
+
+  // NOTE: handles without an fd (like immediate handles) are tracked but never
+  // registered, matching the poll behavior of ignoring negative fds.
+  int fd = iree_wait_primitive_get_read_fd(&handle);
+  if (fd >= 0) {
+    IREE_RETURN_IF_ERROR(
+        iree_syscall_kevent_change(set->kqueue_fd, fd, EV_ADD, index));
+  }
+
+  ++set->total_handle_count;
+  ++set->handle_count;
+  iree_wait_handle_t* user_handle = &set->user_handles[index];
+  iree_wait_handle_wrap_primitive(handle.type, handle.value, user_handle);
+  user_handle->set_internal.dupe_count = 0;  // just us so far
+
+  return iree_ok_status();
 }
 
 void iree_wait_set_erase(iree_wait_set_t* set, iree_wait_handle_t handle) {
-  // TODO(benvanik): kqueue support
+  // Find the user handle in the set. This either requires a linear scan to
+  // find the matching user handle or - if valid - we can use the native index
+  // set after an iree_wait_any wake to do a quick lookup.
+  iree_host_size_t index = handle.set_internal.index;
+  if (IREE_UNLIKELY(index >= set->handle_count) ||
+      IREE_UNLIKELY(!iree_wait_primitive_compare_identical(
+          &set->user_handles[index], &handle))) {
+    // Fallback to a linear scan of (hopefully) a small list.
+    index = set->handle_count;
+    for (iree_host_size_t i = 0; i < set->handle_count; ++i) {
+      if (iree_wait_primitive_compare_identical(&set->user_handles[i],
+                                                &handle)) {
+        index = i;
+        break;
+      }
+    }
+    if (IREE_UNLIKELY(index == set->handle_count)) return;  // not found
+  }
+
+  // Decrement reference count.
+  iree_wait_handle_t* existing_handle = &set->user_handles[index];
+  if (existing_handle->set_internal.dupe_count > 0) {
+    // Still one or more remaining in the set; leave it registered.
+    --existing_handle->set_internal.dupe_count;
+    --set->total_handle_count;
+    return;
+  }
+
+  // No more references remaining; drop the registration. Errors are ignored as
+  // the only failure is that the fd has already been closed (which implicitly
+  // removes it from the kqueue).
+  int fd = iree_wait_primitive_get_read_fd(existing_handle);
+  if (fd >= 0) {
+    iree_status_ignore(
+        iree_syscall_kevent_change(set->kqueue_fd, fd, EV_DELETE, 0));
+  }
+
+  // Since we make no guarantees about the order of the list we can just swap
+  // with the last value. The moved handle has its registration updated to
+  // point at its new index (EV_ADD on an existing registration modifies it).
+  iree_host_size_t tail_index = set->handle_count - 1;
+  if (tail_index > index) {
+    memcpy(&set->user_handles[index], &set->user_handles[tail_index],
+           sizeof(*set->user_handles));
+    int tail_fd = iree_wait_primitive_get_read_fd(&set->user_handles[index]);
+    if (tail_fd >= 0) {
+      iree_status_ignore(
+          iree_syscall_kevent_change(set->kqueue_fd, tail_fd, EV_ADD, index));
+    }
+  }
+  --set->total_handle_count;
+  --set->handle_count;
 }
 
 void iree_wait_set_clear(iree_wait_set_t* set) {
-  // TODO(benvanik): kqueue support
+  for (iree_host_size_t i = 0; i < set->handle_count; ++i) {
+    int fd = iree_wait_primitive_get_read_fd(&set->user_handles[i]);
+    if (fd >= 0) {
+      iree_status_ignore(
+          iree_syscall_kevent_change(set->kqueue_fd, fd, EV_DELETE, 0));
+    }
+  }
+  set->total_handle_count = 0;
+  set->handle_count = 0;
+}
+
+// Maps a kevent result to a status (on failure) and an indicator of whether
+// the event was signaled.
+static iree_status_t iree_wait_set_resolve_kevent(const struct kevent* event,
+                                                  bool* out_signaled) {
+  if (event->flags & EV_ERROR) {
+    return iree_make_status(iree_status_code_from_errno((int)event->data),
+                            "EV_ERROR on fd %d: %d", (int)event->ident,
+                            (int)event->data);
+  } else if ((event->flags & EV_EOF) && event->data == 0) {
+    // Write end closed with nothing left to read; equivalent to POLLHUP.
+    return iree_make_status(IREE_STATUS_CANCELLED, "EV_EOF on fd %d",
+                            (int)event->ident);
+  }
+  *out_signaled = true;
+  return iree_ok_status();
 }
 
 iree_status_t iree_wait_all(iree_wait_set_t* set, iree_time_t deadline_ns) {
-  // TODO(benvanik): kqueue support
+  // Make the syscall only when we have at least one valid fd.
+  // Don't use this as a sleep.
+  if (set->handle_count <= 0) {
+    return iree_ok_status();
+  }
+
+  IREE_TRACE_ZONE_BEGIN(z0);
+
+  // TODO(benvanik): see if we can use tracy's mutex tracking to make waits
+  // nicer (at least showing signal->wait relations).
+
+  // Only fds that are registered can be signaled; unregistered handles are
+  // ignored as with poll.
+  int unsignaled_count = 0;
+  for (iree_host_size_t i = 0; i < set->handle_count; ++i) {
+    if (iree_wait_primitive_get_read_fd(&set->user_handles[i]) >= 0) {
+      ++unsignaled_count;
+    }
+  }
+
+  // Wait-all requires that we repeatedly wait until all handles have been
+  // signaled. In the common case everything is already signaled and a single
+  // kevent returns all of them. Otherwise we disable the registrations of any
+  // fds that have signaled so that the kernel stops reporting them and keep
+  // waiting on the remainder. Disabled fds are re-enabled before returning so
+  // that the set is ready for the next wait.
+  iree_status_t status = iree_ok_status();
+  bool any_disabled = false;
+  while (unsignaled_count > 0) {
+    int signaled_count = 0;
+    status = iree_syscall_kevent_wait(set->kqueue_fd, set->events,
+                                      (int)set->handle_count, deadline_ns,
+                                      &signaled_count);
+    if (!iree_status_is_ok(status)) break;
+    for (int i = 0; i < signaled_count; ++i) {
+      bool signaled = false;
+      status = iree_wait_set_resolve_kevent(&set->events[i], &signaled);
+      if (!iree_status_is_ok(status)) break;
+      if (!signaled) continue;
+      --unsignaled_count;
+      if (unsignaled_count == 0) break;
+      iree_host_size_t index = (iree_host_size_t)set->events[i].udata;
+      status = iree_syscall_kevent_change(
+          set->kqueue_fd, (int)set->events[i].ident, EV_DISABLE, index);
+      if (!iree_status_is_ok(status)) break;
+      any_disabled = true;
+    }
+    if (!iree_status_is_ok(status)) break;
+  }
+
+  // Re-enable any fds we disabled during the wait. This is O(handle_count) but
+  // only happens when the wait actually had to block on some subset.
+  if (any_disabled) {
+    for (iree_host_size_t i = 0; i < set->handle_count; ++i) {
+      int fd = iree_wait_primitive_get_read_fd(&set->user_handles[i]);
+      if (fd < 0) continue;
+      status = iree_status_join(
+          status, iree_syscall_kevent_change(set->kqueue_fd, fd, EV_ENABLE, i));
+    }
+  }
+
+  IREE_TRACE_ZONE_END(z0);
+  return status;
 }
 
 iree_status_t iree_wait_any(iree_wait_set_t* set, iree_time_t deadline_ns,
                             iree_wait_handle_t* out_wake_handle) {
-  // TODO(benvanik): kqueue support
+  // Make the syscall only when we have at least one valid fd.
+  // Don't use this as a sleep.
+  if (set->handle_count <= 0) {
+    memset(out_wake_handle, 0, sizeof(*out_wake_handle));
+    return iree_ok_status();
+  }
+
+  IREE_TRACE_ZONE_BEGIN(z0);
+
+  // TODO(benvanik): see if we can use tracy's mutex tracking to make waits
+  // nicer (at least showing signal->wait relations).
+
+  // We only need one handle so only ask for one event.
+  int signaled_count = 0;
+  IREE_RETURN_AND_END_ZONE_IF_ERROR(
+      z0, iree_syscall_kevent_wait(set->kqueue_fd, set->events,
+                                   /*max_events=*/1, deadline_ns,
+                                   &signaled_count));
+
+  memset(out_wake_handle, 0, sizeof(*out_wake_handle));
+  if (signaled_count > 0) {
+    bool signaled = false;
+    IREE_RETURN_AND_END_ZONE_IF_ERROR(
+        z0, iree_wait_set_resolve_kevent(&set->events[0], &signaled));
+    if (signaled) {
+      iree_host_size_t index = (iree_host_size_t)set->events[0].udata;
+      memcpy(out_wake_handle, &set->user_handles[index],
+             sizeof(*out_wake_handle));
+      out_wake_handle->set_internal.index = index;
+    }
+  }
+
+  IREE_TRACE_ZONE_END(z0);
+  return iree_ok_status();
 }
 
 iree_status_t iree_wait_one(iree_wait_handle_t* handle,
                             iree_time_t deadline_ns) {
-  // TODO(benvanik): kqueue support
+  // Creating a kqueue for a single fd would cost more syscalls than the wait
+  // itself so we use poll directly.
+  struct pollfd poll_fds;
+  poll_fds.fd = iree_wait_primitive_get_read_fd(handle);
+  if (poll_fds.fd == -1) return false;
+  poll_fds.events = POLLIN;
+  poll_fds.revents = 0;
+
+  IREE_TRACE_ZONE_BEGIN(z0);
+
+  int rv = -1;
+  do {
+    uint32_t timeout_ms = iree_absolute_deadline_to_timeout_ms(deadline_ns);
+    rv = poll(&poll_fds, 1, (int)timeout_ms);
+  } while (rv < 0 && errno == EINTR);
+  if (IREE_UNLIKELY(rv < 0)) {
+    IREE_TRACE_ZONE_END(z0);
+    return iree_make_status(iree_status_code_from_errno(errno),
+                            "poll failure %d", errno);
+  }
+
+  IREE_TRACE_ZONE_END(z0);
+  return rv > 0 ? iree_ok_status()
+                : iree_status_from_code(IREE_STATUS_DEADLINE_EXCEEDED);
 }
 
 #endif  // IREE_WAIT_API == IREE_WAIT_API_KQUEUE
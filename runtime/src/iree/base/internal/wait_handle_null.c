@@ -27,6 +27,12 @@ void iree_wait_handle_close(iree_wait_handle_t* handle) {
   iree_wait_handle_deinitialize(handle);
 }
 
+iree_status_t iree_wait_handle_clone(const iree_wait_handle_t* handle,
+                                     iree_wait_handle_t* out_handle) {
+  return iree_make_status(IREE_STATUS_UNAVAILABLE,
+                          "wait primitives are unavailable");
+}
+
 //===----------------------------------------------------------------------===//
 // iree_wait_set_t
 //===----------------------------------------------------------------------===//
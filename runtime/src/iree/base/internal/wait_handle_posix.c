@@ -159,6 +159,46 @@ int iree_wait_primitive_get_read_fd(const iree_wait_handle_t* handle) {
   }
 }
 
+iree_status_t iree_wait_handle_clone(const iree_wait_handle_t* handle,
+                                     iree_wait_handle_t* out_handle) {
+  int fd = iree_wait_primitive_get_read_fd(handle);
+  if (fd < 0) {
+    return iree_make_status(IREE_STATUS_UNAVAILABLE,
+                            "wait primitive type %d cannot be cloned",
+                            (int)handle->type);
+  }
+  int new_fd = -1;
+  IREE_SYSCALL(new_fd, fcntl(fd, F_DUPFD_CLOEXEC, 0));
+  if (IREE_UNLIKELY(new_fd < 0)) {
+    return iree_make_status(iree_status_code_from_errno(errno),
+                            "failed to duplicate fd %d (%d)", fd, errno);
+  }
+  iree_wait_primitive_value_t value;
+  memset(&value, 0, sizeof(value));
+  switch (handle->type) {
+#if defined(IREE_HAVE_WAIT_TYPE_EVENTFD)
+    case IREE_WAIT_PRIMITIVE_TYPE_EVENT_FD:
+      value.event.fd = new_fd;
+      break;
+#endif  // IREE_HAVE_WAIT_TYPE_EVENTFD
+#if defined(IREE_HAVE_WAIT_TYPE_SYNC_FILE)
+    case IREE_WAIT_PRIMITIVE_TYPE_SYNC_FILE:
+      value.sync_file.fd = new_fd;
+      break;
+#endif  // IREE_HAVE_WAIT_TYPE_SYNC_FILE
+#if defined(IREE_HAVE_WAIT_TYPE_PIPE)
+    case IREE_WAIT_PRIMITIVE_TYPE_PIPE:
+      value.pipe.read_fd = new_fd;
+      value.pipe.write_fd = -1;
+      break;
+#endif  // IREE_HAVE_WAIT_TYPE_PIPE
+    default:
+      break;
+  }
+  iree_wait_handle_wrap_primitive(handle->type, value, out_handle);
+  return iree_ok_status();
+}
+
 iree_status_t iree_wait_primitive_read(iree_wait_handle_t* handle,
                                        iree_time_t deadline_ns) {
   // Until we need it this does not support anything but polling.
@@ -68,6 +68,16 @@ void iree_wait_handle_close(iree_wait_handle_t* handle) {
   iree_wait_handle_deinitialize(handle);
 }
 
+iree_status_t iree_wait_handle_clone(const iree_wait_handle_t* handle,
+                                     iree_wait_handle_t* out_handle) {
+  if (handle->type != IREE_WAIT_PRIMITIVE_TYPE_WIN32_HANDLE) {
+    return iree_make_status(IREE_STATUS_UNAVAILABLE,
+                            "wait primitive type %d cannot be cloned",
+                            (int)handle->type);
+  }
+  return iree_wait_primitive_clone((iree_wait_handle_t*)handle, out_handle);
+}
+
 // Returns true if the two handles share the same underlying primitive object.
 static bool iree_wait_primitive_compare(const iree_wait_handle_t* lhs,
                                         const iree_wait_handle_t* rhs) {
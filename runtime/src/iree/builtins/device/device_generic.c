@@ -108,6 +108,163 @@ IREE_DEVICE_EXPORT short iree_f2h_ieee(float param) {
   return res;
 }
 
+//===----------------------------------------------------------------------===//
+// Vectorizable math functions
+//===----------------------------------------------------------------------===//
+// Implementations only use arithmetic, bit manipulation, and selects so that
+// they can be inlined into vectorized loops and turned into SIMD code. Range
+// reduction and coefficients follow the Cephes single-precision library.
+
+typedef union {
+  float f;
+  uint32_t u;
+} iree_math_f32_bits_t;
+
+static inline float iree_math_f32_from_bits(uint32_t u) {
+  iree_math_f32_bits_t bits;
+  bits.u = u;
+  return bits.f;
+}
+
+static inline uint32_t iree_math_f32_to_bits(float f) {
+  iree_math_f32_bits_t bits;
+  bits.f = f;
+  return bits.u;
+}
+
+static inline float iree_math_fabsf(float x) {
+  return iree_math_f32_from_bits(iree_math_f32_to_bits(x) & 0x7FFFFFFFu);
+}
+
+static inline float iree_math_copysignf(float x, float sign) {
+  return iree_math_f32_from_bits((iree_math_f32_to_bits(x) & 0x7FFFFFFFu) |
+                                 (iree_math_f32_to_bits(sign) & 0x80000000u));
+}
+
+static inline float iree_math_floorf(float x) {
+  // Values with magnitude >= 2^23 are already integral (or inf/nan).
+  if (!(iree_math_fabsf(x) < 8388608.0f)) return x;
+  float t = (float)(int32_t)x;
+  return t > x ? t - 1.0f : t;
+}
+
+IREE_DEVICE_EXPORT float iree_math_expf(float x) {
+  if (x != x) return x;
+  if (x > 88.72283935546875f) return iree_math_f32_from_bits(0x7F800000u);
+  if (x < -103.972084045410f) return 0.0f;
+
+  // Reduce to x = n * ln(2) + r with |r| <= ln(2) / 2. ln(2) is split into a
+  // part exactly representable with few bits and a correction so the product
+  // with n does not lose precision.
+  float n = iree_math_floorf(x * 1.44269504088896341f + 0.5f);
+  float r = x - n * 0.693359375f;
+  r = r - n * -2.12194440e-4f;
+
+  float p = 1.9875691500e-4f;
+  p = p * r + 1.3981999507e-3f;
+  p = p * r + 8.3334519073e-3f;
+  p = p * r + 4.1665795894e-2f;
+  p = p * r + 1.6666665459e-1f;
+  p = p * r + 5.0000001201e-1f;
+  p = p * r * r + r + 1.0f;
+
+  // Scale by 2^n in two steps so results in the subnormal range (n < -126)
+  // are produced without forming an out-of-range exponent.
+  int32_t ni = (int32_t)n;
+  int32_t n0 = ni / 2;
+  int32_t n1 = ni - n0;
+  p *= iree_math_f32_from_bits((uint32_t)(n0 + 127) << 23);
+  p *= iree_math_f32_from_bits((uint32_t)(n1 + 127) << 23);
+  return p;
+}
+
+IREE_DEVICE_EXPORT float iree_math_logf(float x) {
+  uint32_t bits = iree_math_f32_to_bits(x);
+  if (x != x) return x;
+  if (x < 0.0f) return iree_math_f32_from_bits(0x7FC00000u);
+  if (x == 0.0f) return iree_math_f32_from_bits(0xFF800000u);
+  if (bits == 0x7F800000u) return x;
+
+  // Normalize subnormals so the exponent can be extracted from the bits.
+  int32_t e = 0;
+  if (bits < 0x00800000u) {
+    x *= 8388608.0f;  // 2^23
+    bits = iree_math_f32_to_bits(x);
+    e = -23;
+  }
+
+  // Decompose into x = m * 2^e with m in [sqrt(1/2), sqrt(2)).
+  e += (int32_t)(bits >> 23) - 126;
+  float m = iree_math_f32_from_bits((bits & 0x007FFFFFu) | 0x3F000000u);
+  if (m < 0.707106781186547524f) {
+    e -= 1;
+    m = m + m - 1.0f;
+  } else {
+    m = m - 1.0f;
+  }
+  float fe = (float)e;
+
+  float z = m * m;
+  float p = 7.0376836292e-2f;
+  p = p * m - 1.1514610310e-1f;
+  p = p * m + 1.1676998740e-1f;
+  p = p * m - 1.2420140846e-1f;
+  p = p * m + 1.4249322787e-1f;
+  p = p * m - 1.6668057665e-1f;
+  p = p * m + 2.0000714765e-1f;
+  p = p * m - 2.4999993993e-1f;
+  p = p * m + 3.3333331174e-1f;
+  float y = p * m * z;
+  y += fe * -2.12194440e-4f;
+  y += -0.5f * z;
+  return m + y + fe * 0.693359375f;
+}
+
+IREE_DEVICE_EXPORT float iree_math_tanhf(float x) {
+  if (x != x) return x;
+  float ax = iree_math_fabsf(x);
+  if (ax < 0.625f) {
+    float z = x * x;
+    float p = -5.70498872745e-3f;
+    p = p * z + 2.06390887954e-2f;
+    p = p * z - 5.37397155531e-2f;
+    p = p * z + 1.33314422036e-1f;
+    p = p * z - 3.33332819422e-1f;
+    return p * z * x + x;
+  }
+  // tanh(x) rounds to +/-1 beyond this.
+  if (ax > 9.01f) return iree_math_copysignf(1.0f, x);
+  float y = 1.0f - 2.0f / (iree_math_expf(ax + ax) + 1.0f);
+  return iree_math_copysignf(y, x);
+}
+
+IREE_DEVICE_EXPORT float iree_math_erff(float x) {
+  if (x != x) return x;
+  float ax = iree_math_fabsf(x);
+  if (ax < 1.0f) {
+    float z = x * x;
+    float p = 7.853861353153693e-5f;
+    p = p * z - 8.010193625184903e-4f;
+    p = p * z + 5.188327685732524e-3f;
+    p = p * z - 2.685381193529856e-2f;
+    p = p * z + 1.128358514861418e-1f;
+    p = p * z - 3.761262582423300e-1f;
+    p = p * z + 1.128379165726710e+0f;
+    return x * p;
+  }
+  // erf(x) rounds to +/-1 beyond this.
+  if (ax > 3.92f) return iree_math_copysignf(1.0f, x);
+  // Abramowitz and Stegun 7.1.26.
+  float t = 1.0f / (1.0f + 0.3275911f * ax);
+  float p = 1.061405429f;
+  p = p * t - 1.453152027f;
+  p = p * t + 1.421413741f;
+  p = p * t - 0.284496736f;
+  p = p * t + 0.254829592f;
+  float y = 1.0f - p * t * iree_math_expf(-ax * ax);
+  return iree_math_copysignf(y, x);
+}
+
 #if defined(IREE_DEVICE_STANDALONE)
 
 IREE_DEVICE_EXPORT float __gnu_h2f_ieee(short param) {
@@ -4,7 +4,10 @@
 // See https://llvm.org/LICENSE.txt for license information.
 // SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
 
+#include <cmath>
+#include <cstdint>
 #include <cstring>
+#include <limits>
 
 #include "iree/base/api.h"
 #include "iree/builtins/device/device.h"
@@ -20,3 +23,68 @@ TEST(LibDeviceTest, iree_f2h_ieee) {
   // Just ensuring that the code links.
   EXPECT_EQ(0x3400, iree_f2h_ieee(0.25f));
 }
+
+// Returns the error of |value| relative to the |reference| in units of the last
+// place of the reference rounded to float.
+static double UlpError(float value, double reference) {
+  float rounded_reference = (float)reference;
+  if (std::isnan(rounded_reference)) return std::isnan(value) ? 0.0 : INFINITY;
+  if (std::isinf(rounded_reference)) {
+    return value == rounded_reference ? 0.0 : INFINITY;
+  }
+  float magnitude = std::fabs(rounded_reference);
+  float ulp = std::isnormal(magnitude)
+                  ? std::nextafter(magnitude, INFINITY) - magnitude
+                  : std::numeric_limits<float>::denorm_min();
+  return std::fabs((double)value - reference) / ulp;
+}
+
+// Returns the maximum error of |fn| against |reference_fn| across a sampling of
+// all float bit patterns (including subnormals, infinities, and NaNs).
+template <typename Fn, typename ReferenceFn>
+static double MaxUlpError(Fn fn, ReferenceFn reference_fn) {
+  double max_error = 0.0;
+  for (uint64_t bits = 0; bits <= UINT32_MAX; bits += 4093) {
+    uint32_t value_bits = (uint32_t)bits;
+    float value = 0.0f;
+    memcpy(&value, &value_bits, sizeof(value));
+    max_error = std::fmax(
+        max_error, UlpError(fn(value), reference_fn((double)value)));
+  }
+  return max_error;
+}
+
+TEST(LibDeviceTest, iree_math_expf) {
+  EXPECT_EQ(1.0f, iree_math_expf(0.0f));
+  EXPECT_EQ(INFINITY, iree_math_expf(INFINITY));
+  EXPECT_EQ(0.0f, iree_math_expf(-INFINITY));
+  EXPECT_TRUE(std::isnan(iree_math_expf(NAN)));
+  EXPECT_LE(MaxUlpError(iree_math_expf, [](double x) { return std::exp(x); }),
+            1.0);
+}
+
+TEST(LibDeviceTest, iree_math_logf) {
+  EXPECT_EQ(0.0f, iree_math_logf(1.0f));
+  EXPECT_EQ(-INFINITY, iree_math_logf(0.0f));
+  EXPECT_EQ(INFINITY, iree_math_logf(INFINITY));
+  EXPECT_TRUE(std::isnan(iree_math_logf(-1.0f)));
+  EXPECT_LE(MaxUlpError(iree_math_logf, [](double x) { return std::log(x); }),
+            1.0);
+}
+
+TEST(LibDeviceTest, iree_math_tanhf) {
+  EXPECT_EQ(0.0f, iree_math_tanhf(0.0f));
+  EXPECT_EQ(1.0f, iree_math_tanhf(INFINITY));
+  EXPECT_EQ(-1.0f, iree_math_tanhf(-INFINITY));
+  EXPECT_LE(
+      MaxUlpError(iree_math_tanhf, [](double x) { return std::tanh(x); }),
+      2.0);
+}
+
+TEST(LibDeviceTest, iree_math_erff) {
+  EXPECT_EQ(0.0f, iree_math_erff(0.0f));
+  EXPECT_EQ(1.0f, iree_math_erff(INFINITY));
+  EXPECT_EQ(-1.0f, iree_math_erff(-INFINITY));
+  EXPECT_LE(MaxUlpError(iree_math_erff, [](double x) { return std::erf(x); }),
+            4.0);
+}
@@ -0,0 +1,94 @@
+// Copyright 2023 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#ifndef IREE_BUILTINS_UKERNEL_ARCH_ARM_64_COMMON_ARM_64_H_
+#define IREE_BUILTINS_UKERNEL_ARCH_ARM_64_COMMON_ARM_64_H_
+
+#include <arm_neon.h>
+
+#include "iree/builtins/ukernel/common.h"
+
+// NEON data-movement helpers shared by the pack and unpack tile functions.
+
+static inline int8x16x4_t
+iree_uk_neon_load_8x8xi8_rowmajor_strided_permute_rows(
+    const iree_uk_int8_t* src, iree_uk_ssize_t stride, int p0, int p1, int p2,
+    int p3, int p4, int p5, int p6, int p7) {
+  int8x8_t row0 = vld1_s8(src + p0 * stride);
+  int8x8_t row1 = vld1_s8(src + p1 * stride);
+  int8x8_t row2 = vld1_s8(src + p2 * stride);
+  int8x8_t row3 = vld1_s8(src + p3 * stride);
+  int8x8_t row4 = vld1_s8(src + p4 * stride);
+  int8x8_t row5 = vld1_s8(src + p5 * stride);
+  int8x8_t row6 = vld1_s8(src + p6 * stride);
+  int8x8_t row7 = vld1_s8(src + p7 * stride);
+  int8x16x4_t v;
+  v.val[0] = vcombine_s8(row0, row1);
+  v.val[1] = vcombine_s8(row2, row3);
+  v.val[2] = vcombine_s8(row4, row5);
+  v.val[3] = vcombine_s8(row6, row7);
+  return v;
+}
+
+static inline int16x8x2_t iree_uk_neon_zip_16xi8_as_8xi16(int8x16_t a,
+                                                          int8x16_t b) {
+  int8x16x2_t z = vzipq_s8(a, b);
+  int16x8x2_t r;
+  r.val[0] = vreinterpretq_s16_s8(z.val[0]);
+  r.val[1] = vreinterpretq_s16_s8(z.val[1]);
+  return r;
+}
+
+static inline int32x4x2_t iree_uk_neon_zip_8xi16_as_4xi32(int16x8_t a,
+                                                          int16x8_t b) {
+  int16x8x2_t z = vzipq_s16(a, b);
+  int32x4x2_t r;
+  r.val[0] = vreinterpretq_s32_s16(z.val[0]);
+  r.val[1] = vreinterpretq_s32_s16(z.val[1]);
+  return r;
+}
+
+static inline int64x2x2_t iree_uk_neon_zip_4xi32_as_2xi64(int32x4_t a,
+                                                          int32x4_t b) {
+  int32x4x2_t z = vzipq_s32(a, b);
+  int64x2x2_t r;
+  r.val[0] = vreinterpretq_s64_s32(z.val[0]);
+  r.val[1] = vreinterpretq_s64_s32(z.val[1]);
+  return r;
+}
+
+static inline void iree_uk_neon_copy_8x8xi8_rowmajor_to_colmajor(
+    iree_uk_int8_t* IREE_UK_RESTRICT out_ptr,
+    const iree_uk_int8_t* IREE_UK_RESTRICT in_ptr,
+    iree_uk_ssize_t out_stride, iree_uk_ssize_t in_stride) {
+  int8x16x4_t in = iree_uk_neon_load_8x8xi8_rowmajor_strided_permute_rows(
+      in_ptr, in_stride, 0, 4, 1, 5, 2, 6, 3, 7);
+  int16x8x2_t zip_i16_0 = iree_uk_neon_zip_16xi8_as_8xi16(in.val[0], in.val[1]);
+  int16x8x2_t zip_i16_1 = iree_uk_neon_zip_16xi8_as_8xi16(in.val[2], in.val[3]);
+  int32x4x2_t zip_i32_0 =
+      iree_uk_neon_zip_8xi16_as_4xi32(zip_i16_0.val[0], zip_i16_1.val[0]);
+  int32x4x2_t zip_i32_1 =
+      iree_uk_neon_zip_8xi16_as_4xi32(zip_i16_0.val[1], zip_i16_1.val[1]);
+  int64x2x2_t zip_i64_0 =
+      iree_uk_neon_zip_4xi32_as_2xi64(zip_i32_0.val[0], zip_i32_1.val[0]);
+  int64x2x2_t zip_i64_1 =
+      iree_uk_neon_zip_4xi32_as_2xi64(zip_i32_0.val[1], zip_i32_1.val[1]);
+  int8x16x4_t out;
+  out.val[0] = vreinterpretq_s8_s64(zip_i64_0.val[0]);
+  out.val[1] = vreinterpretq_s8_s64(zip_i64_0.val[1]);
+  out.val[2] = vreinterpretq_s8_s64(zip_i64_1.val[0]);
+  out.val[3] = vreinterpretq_s8_s64(zip_i64_1.val[1]);
+  vst1_s8(out_ptr + 0 * out_stride, vget_low_s8(out.val[0]));
+  vst1_s8(out_ptr + 1 * out_stride, vget_high_s8(out.val[0]));
+  vst1_s8(out_ptr + 2 * out_stride, vget_low_s8(out.val[1]));
+  vst1_s8(out_ptr + 3 * out_stride, vget_high_s8(out.val[1]));
+  vst1_s8(out_ptr + 4 * out_stride, vget_low_s8(out.val[2]));
+  vst1_s8(out_ptr + 5 * out_stride, vget_high_s8(out.val[2]));
+  vst1_s8(out_ptr + 6 * out_stride, vget_low_s8(out.val[3]));
+  vst1_s8(out_ptr + 7 * out_stride, vget_high_s8(out.val[3]));
+}
+
+#endif  // IREE_BUILTINS_UKERNEL_ARCH_ARM_64_COMMON_ARM_64_H_
@@ -0,0 +1,25 @@
+// Copyright 2023 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include "iree/builtins/ukernel/arch/arm_64/unpack_arm_64.h"
+
+#include "iree/builtins/ukernel/arch/arm_64/unpack_tile_arm_64.h"
+
+iree_uk_unpack_tile_func_t iree_uk_unpack_select_tile_func_arm_64(
+    const iree_uk_unpack_params_t* params) {
+  // As in pack, no arithmetic is being done, so only the element type size
+  // matters, not the type itself.
+  int esize = iree_uk_type_size(iree_uk_unpack_out_type(params->type));
+  bool transpose = params->flags & IREE_UK_FLAG_UNPACK_TRANSPOSE_INNER;
+  if (esize == 4 && params->in_size2 == 8 && params->in_size3 == 8) {
+    return transpose ? iree_uk_unpack_tile_8x8_x32_arm_64_transpose
+                     : iree_uk_unpack_tile_8x8_x32_arm_64_direct;
+  } else if (esize == 1 && params->in_size2 == 8 && params->in_size3 == 8) {
+    return transpose ? iree_uk_unpack_tile_8x8_x8_arm_64_transpose
+                     : iree_uk_unpack_tile_8x8_x8_arm_64_direct;
+  }
+  return 0;
+}
@@ -0,0 +1,118 @@
+// Copyright 2023 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include "iree/builtins/ukernel/arch/arm_64/unpack_tile_arm_64.h"
+
+#include <arm_neon.h>
+
+#include "iree/builtins/ukernel/arch/arm_64/common_arm_64.h"
+
+// Copies a 4x4 block of 32-bit elements, transposing it: row i of the output
+// is column i of the input.
+static inline void iree_uk_neon_copy_4x4xi32_transpose(
+    iree_uk_int32_t* IREE_UK_RESTRICT out_ptr,
+    const iree_uk_int32_t* IREE_UK_RESTRICT in_ptr, iree_uk_ssize_t out_stride,
+    iree_uk_ssize_t in_stride) {
+  int32x4_t r0 = vld1q_s32(in_ptr + 0 * in_stride);
+  int32x4_t r1 = vld1q_s32(in_ptr + 1 * in_stride);
+  int32x4_t r2 = vld1q_s32(in_ptr + 2 * in_stride);
+  int32x4_t r3 = vld1q_s32(in_ptr + 3 * in_stride);
+  int32x4x2_t t01 = vtrnq_s32(r0, r1);
+  int32x4x2_t t23 = vtrnq_s32(r2, r3);
+  vst1q_s32(out_ptr + 0 * out_stride,
+            vcombine_s32(vget_low_s32(t01.val[0]), vget_low_s32(t23.val[0])));
+  vst1q_s32(out_ptr + 1 * out_stride,
+            vcombine_s32(vget_low_s32(t01.val[1]), vget_low_s32(t23.val[1])));
+  vst1q_s32(out_ptr + 2 * out_stride,
+            vcombine_s32(vget_high_s32(t01.val[0]), vget_high_s32(t23.val[0])));
+  vst1q_s32(out_ptr + 3 * out_stride,
+            vcombine_s32(vget_high_s32(t01.val[1]), vget_high_s32(t23.val[1])));
+}
+
+void iree_uk_unpack_tile_8x8_x32_arm_64_direct(
+    void* IREE_UK_RESTRICT out_tile_ptr,
+    const void* IREE_UK_RESTRICT in_tile_ptr, iree_uk_ssize_t outer_size1,
+    iree_uk_ssize_t out_stride0, iree_uk_ssize_t in_stride1,
+    iree_uk_ssize_t elem_size_unused, iree_uk_ssize_t tile_size0_unused,
+    iree_uk_ssize_t tile_size1_unused) {
+  const iree_uk_int32_t* IREE_UK_RESTRICT in_ptr = in_tile_ptr;
+  iree_uk_int32_t* IREE_UK_RESTRICT out_ptr = out_tile_ptr;
+  for (iree_uk_ssize_t outer_i1 = 0; outer_i1 < outer_size1; ++outer_i1) {
+    for (int tile_i0 = 0; tile_i0 < 8; ++tile_i0) {
+      const iree_uk_int32_t* in_row_ptr = in_ptr + 8 * tile_i0;
+      iree_uk_int32_t* out_row_ptr = out_ptr + tile_i0 * out_stride0;
+      vst1q_s32(out_row_ptr + 0, vld1q_s32(in_row_ptr + 0));
+      vst1q_s32(out_row_ptr + 4, vld1q_s32(in_row_ptr + 4));
+    }
+    out_ptr += 8;
+    in_ptr += in_stride1;
+  }
+}
+
+void iree_uk_unpack_tile_8x8_x32_arm_64_transpose(
+    void* IREE_UK_RESTRICT out_tile_ptr,
+    const void* IREE_UK_RESTRICT in_tile_ptr, iree_uk_ssize_t outer_size1,
+    iree_uk_ssize_t out_stride0, iree_uk_ssize_t in_stride1,
+    iree_uk_ssize_t elem_size_unused, iree_uk_ssize_t tile_size0_unused,
+    iree_uk_ssize_t tile_size1_unused) {
+  const iree_uk_int32_t* IREE_UK_RESTRICT in_ptr = in_tile_ptr;
+  iree_uk_int32_t* IREE_UK_RESTRICT out_ptr = out_tile_ptr;
+  for (iree_uk_ssize_t outer_i1 = 0; outer_i1 < outer_size1; ++outer_i1) {
+    // The input tile is column-major with respect to the output. Transpose it
+    // as four 4x4 blocks, block (i, j) of the input going to block (j, i).
+    for (int i = 0; i < 8; i += 4) {
+      for (int j = 0; j < 8; j += 4) {
+        iree_uk_neon_copy_4x4xi32_transpose(out_ptr + j * out_stride0 + i,
+                                            in_ptr + i * 8 + j, out_stride0, 8);
+      }
+    }
+    out_ptr += 8;
+    in_ptr += in_stride1;
+  }
+}
+
+void iree_uk_unpack_tile_8x8_x8_arm_64_direct(
+    void* IREE_UK_RESTRICT out_tile_ptr,
+    const void* IREE_UK_RESTRICT in_tile_ptr, iree_uk_ssize_t outer_size1,
+    iree_uk_ssize_t out_stride0, iree_uk_ssize_t in_stride1,
+    iree_uk_ssize_t elem_size_unused, iree_uk_ssize_t tile_size0_unused,
+    iree_uk_ssize_t tile_size1_unused) {
+  const iree_uk_int8_t* IREE_UK_RESTRICT in_ptr = in_tile_ptr;
+  iree_uk_int8_t* IREE_UK_RESTRICT out_ptr = out_tile_ptr;
+  for (iree_uk_ssize_t outer_i1 = 0; outer_i1 < outer_size1; ++outer_i1) {
+    int8x16x4_t in;
+    in.val[0] = vld1q_s8(in_ptr + 0);
+    in.val[1] = vld1q_s8(in_ptr + 16);
+    in.val[2] = vld1q_s8(in_ptr + 32);
+    in.val[3] = vld1q_s8(in_ptr + 48);
+    vst1_s8(out_ptr + 0 * out_stride0, vget_low_s8(in.val[0]));
+    vst1_s8(out_ptr + 1 * out_stride0, vget_high_s8(in.val[0]));
+    vst1_s8(out_ptr + 2 * out_stride0, vget_low_s8(in.val[1]));
+    vst1_s8(out_ptr + 3 * out_stride0, vget_high_s8(in.val[1]));
+    vst1_s8(out_ptr + 4 * out_stride0, vget_low_s8(in.val[2]));
+    vst1_s8(out_ptr + 5 * out_stride0, vget_high_s8(in.val[2]));
+    vst1_s8(out_ptr + 6 * out_stride0, vget_low_s8(in.val[3]));
+    vst1_s8(out_ptr + 7 * out_stride0, vget_high_s8(in.val[3]));
+    out_ptr += 8;
+    in_ptr += in_stride1;
+  }
+}
+
+void iree_uk_unpack_tile_8x8_x8_arm_64_transpose(
+    void* IREE_UK_RESTRICT out_tile_ptr,
+    const void* IREE_UK_RESTRICT in_tile_ptr, iree_uk_ssize_t outer_size1,
+    iree_uk_ssize_t out_stride0, iree_uk_ssize_t in_stride1,
+    iree_uk_ssize_t elem_size_unused, iree_uk_ssize_t tile_size0_unused,
+    iree_uk_ssize_t tile_size1_unused) {
+  const iree_uk_int8_t* IREE_UK_RESTRICT in_ptr = in_tile_ptr;
+  iree_uk_int8_t* IREE_UK_RESTRICT out_ptr = out_tile_ptr;
+  for (iree_uk_ssize_t outer_i1 = 0; outer_i1 < outer_size1; ++outer_i1) {
+    iree_uk_neon_copy_8x8xi8_rowmajor_to_colmajor(out_ptr, in_ptr, out_stride0,
+                                                  8);
+    out_ptr += 8;
+    in_ptr += in_stride1;
+  }
+}
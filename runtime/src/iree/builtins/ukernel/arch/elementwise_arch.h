@@ -0,0 +1,24 @@
+// Copyright 2023 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#ifndef IREE_BUILTINS_UKERNEL_ARCH_ELEMENTWISE_ARCH_H_
+#define IREE_BUILTINS_UKERNEL_ARCH_ELEMENTWISE_ARCH_H_
+
+#include "iree/builtins/ukernel/elementwise_types.h"
+
+// Returns the architecture-specific row function to use for the x32b |opcode|
+// on a CPU described by |cpu_data|, or NULL if no suitable
+// architecture-specific row function exists, in which case the caller may fall
+// back to a generic implementation.
+iree_uk_x32b_row_func_t iree_uk_x32b_select_row_func_arch(
+    iree_uk_x32b_opcode_t opcode, const iree_uk_uint64_t* cpu_data);
+
+// Returns the architecture-specific row function to use for the x32u |opcode|.
+// See iree_uk_x32b_select_row_func_arch.
+iree_uk_x32u_row_func_t iree_uk_x32u_select_row_func_arch(
+    iree_uk_x32u_opcode_t opcode, const iree_uk_uint64_t* cpu_data);
+
+#endif  // IREE_BUILTINS_UKERNEL_ARCH_ELEMENTWISE_ARCH_H_
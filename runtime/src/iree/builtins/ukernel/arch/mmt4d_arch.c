@@ -8,12 +8,24 @@
 
 #if defined(IREE_UK_ARCH_ARM_64)
 #include "iree/builtins/ukernel/arch/arm_64/mmt4d_arm_64.h"
+#elif defined(IREE_UK_ARCH_X86_64)
+#include "iree/builtins/ukernel/arch/x86_64/mmt4d_x86_64.h"
+#elif defined(IREE_UK_ARCH_RISCV_64)
+#include "iree/builtins/ukernel/arch/riscv_64/mmt4d_riscv_64.h"
+#elif defined(IREE_UK_ARCH_WASM_32)
+#include "iree/builtins/ukernel/arch/wasm_32/mmt4d_wasm_32.h"
 #endif
 
 iree_uk_mmt4d_tile_func_t iree_uk_mmt4d_select_tile_func_arch(
     const iree_uk_mmt4d_params_t* params) {
 #if defined(IREE_UK_ARCH_ARM_64)
   return iree_uk_mmt4d_select_tile_func_arm_64(params);
+#elif defined(IREE_UK_ARCH_X86_64)
+  return iree_uk_mmt4d_select_tile_func_x86_64(params);
+#elif defined(IREE_UK_ARCH_RISCV_64)
+  return iree_uk_mmt4d_select_tile_func_riscv_64(params);
+#elif defined(IREE_UK_ARCH_WASM_32)
+  return iree_uk_mmt4d_select_tile_func_wasm_32(params);
 #endif
   return 0;
 }
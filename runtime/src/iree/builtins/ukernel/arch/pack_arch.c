@@ -8,12 +8,16 @@
 
 #if defined(IREE_UK_ARCH_ARM_64)
 #include "iree/builtins/ukernel/arch/arm_64/pack_arm_64.h"
+#elif defined(IREE_UK_ARCH_RISCV_64)
+#include "iree/builtins/ukernel/arch/riscv_64/pack_riscv_64.h"
 #endif
 
 iree_uk_pack_tile_func_t iree_uk_pack_select_tile_func_arch(
     const iree_uk_pack_params_t* params) {
 #if defined(IREE_UK_ARCH_ARM_64)
   return iree_uk_pack_select_tile_func_arm_64(params);
+#elif defined(IREE_UK_ARCH_RISCV_64)
+  return iree_uk_pack_select_tile_func_riscv_64(params);
 #endif
   return 0;
 }
@@ -0,0 +1,61 @@
+// Copyright 2023 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include "iree/builtins/ukernel/arch/riscv_64/mmt4d_riscv_64.h"
+
+#include "iree/builtins/ukernel/arch/riscv_64/config.h"
+#include "iree/builtins/ukernel/arch/riscv_64/mmt4d_tile_riscv_64.h"
+#include "iree/schemas/cpu_data.h"
+
+static iree_uk_mmt4d_tile_func_t
+iree_uk_mmt4d_select_tile_func_riscv_64_f32f32f32(
+    const iree_uk_mmt4d_params_t* params) {
+#ifdef IREE_UK_BUILD_RISCV_64_V
+  if (params->M0 != 8 || params->K0 != 1) return 0;
+  if (params->N0 == 8 &&
+      (params->cpu_data[0] & IREE_CPU_DATA_FIELD_0_RISCV_64_HAVE_V)) {
+    return iree_uk_mmt4d_tile_f32f32f32_8x8x1_riscv_64_v;
+  }
+  if (params->N0 == 16 &&
+      (params->cpu_data[0] & IREE_CPU_DATA_FIELD_0_RISCV_64_HAVE_ZVL256B)) {
+    return iree_uk_mmt4d_tile_f32f32f32_8x16x1_riscv_64_v;
+  }
+#else
+  (void)params;
+#endif
+  return 0;
+}
+
+static iree_uk_mmt4d_tile_func_t
+iree_uk_mmt4d_select_tile_func_riscv_64_i8i8i32(
+    const iree_uk_mmt4d_params_t* params) {
+#ifdef IREE_UK_BUILD_RISCV_64_V
+  if (params->M0 != 8 || params->K0 != 1) return 0;
+  if (params->N0 == 8 &&
+      (params->cpu_data[0] & IREE_CPU_DATA_FIELD_0_RISCV_64_HAVE_V)) {
+    return iree_uk_mmt4d_tile_i8i8i32_8x8x1_riscv_64_v;
+  }
+  if (params->N0 == 16 &&
+      (params->cpu_data[0] & IREE_CPU_DATA_FIELD_0_RISCV_64_HAVE_ZVL256B)) {
+    return iree_uk_mmt4d_tile_i8i8i32_8x16x1_riscv_64_v;
+  }
+#else
+  (void)params;
+#endif
+  return 0;
+}
+
+iree_uk_mmt4d_tile_func_t iree_uk_mmt4d_select_tile_func_riscv_64(
+    const iree_uk_mmt4d_params_t* params) {
+  switch (params->type) {
+    case iree_uk_mmt4d_type_f32f32f32:
+      return iree_uk_mmt4d_select_tile_func_riscv_64_f32f32f32(params);
+    case iree_uk_mmt4d_type_i8i8i32:
+      return iree_uk_mmt4d_select_tile_func_riscv_64_i8i8i32(params);
+    default:
+      return 0;
+  }
+}
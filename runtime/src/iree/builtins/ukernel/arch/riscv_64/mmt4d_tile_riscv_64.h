@@ -0,0 +1,17 @@
+// Copyright 2023 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#ifndef IREE_BUILTINS_UKERNEL_ARCH_RISCV_64_MMT4D_TILE_RISCV_64_H_
+#define IREE_BUILTINS_UKERNEL_ARCH_RISCV_64_MMT4D_TILE_RISCV_64_H_
+
+#include "iree/builtins/ukernel/mmt4d_types.h"
+
+IREE_UK_MMT4D_TILE_FUNC_DECL(iree_uk_mmt4d_tile_f32f32f32_8x8x1_riscv_64_v)
+IREE_UK_MMT4D_TILE_FUNC_DECL(iree_uk_mmt4d_tile_f32f32f32_8x16x1_riscv_64_v)
+IREE_UK_MMT4D_TILE_FUNC_DECL(iree_uk_mmt4d_tile_i8i8i32_8x8x1_riscv_64_v)
+IREE_UK_MMT4D_TILE_FUNC_DECL(iree_uk_mmt4d_tile_i8i8i32_8x16x1_riscv_64_v)
+
+#endif  // IREE_BUILTINS_UKERNEL_ARCH_RISCV_64_MMT4D_TILE_RISCV_64_H_
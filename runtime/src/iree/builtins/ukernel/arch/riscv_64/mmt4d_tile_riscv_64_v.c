@@ -0,0 +1,133 @@
+// Copyright 2023 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include <riscv_vector.h>
+
+#include "iree/builtins/ukernel/arch/riscv_64/mmt4d_tile_riscv_64.h"
+
+// All tiles have M0 == 8 and hold one row of the output tile per accumulator
+// register group, at LMUL=2. RVV types are sizeless and cannot be array
+// elements, hence the per-row macros. With LMUL=2, N0=8 fits in any V
+// implementation (VLEN >= 128) and N0=16 requires VLEN >= 256. The tile
+// functions are otherwise VLEN-agnostic: vl is always exactly N0, so larger
+// VLEN leaves upper lanes idle rather than changing the data layout, which is
+// fixed at compile time by the packing.
+
+#define IREE_UK_RVV_FOR_EACH_ROW(X) X(0) X(1) X(2) X(3) X(4) X(5) X(6) X(7)
+
+// f32*f32->f32 8xN0x1 tile: each step of the K loop multiplies one LHS
+// element per row, as a scalar operand, by the N0 RHS elements of the current
+// column panel slice.
+static inline void iree_uk_mmt4d_tile_f32f32f32_8xNx1_riscv_64_v(
+    void* out_tile_untyped, const void* lhs_panel_untyped,
+    const void* rhs_panel_untyped, iree_uk_int32_t K, iree_uk_uint32_t flags,
+    int N0) {
+  float* IREE_UK_RESTRICT out_tile = out_tile_untyped;
+  const float* IREE_UK_RESTRICT lhs_panel = lhs_panel_untyped;
+  const float* IREE_UK_RESTRICT rhs_panel = rhs_panel_untyped;
+  size_t vl = __riscv_vsetvl_e32m2(N0);
+#define IREE_UK_RVV_DECLARE_ACC(i) vfloat32m2_t acc##i;
+  IREE_UK_RVV_FOR_EACH_ROW(IREE_UK_RVV_DECLARE_ACC)
+#undef IREE_UK_RVV_DECLARE_ACC
+  if (flags & IREE_UK_FLAG_ACCUMULATE) {
+#define IREE_UK_RVV_LOAD_ACC(i) \
+  acc##i = __riscv_vle32_v_f32m2(out_tile + i * N0, vl);
+    IREE_UK_RVV_FOR_EACH_ROW(IREE_UK_RVV_LOAD_ACC)
+#undef IREE_UK_RVV_LOAD_ACC
+  } else {
+#define IREE_UK_RVV_ZERO_ACC(i) acc##i = __riscv_vfmv_v_f_f32m2(0.f, vl);
+    IREE_UK_RVV_FOR_EACH_ROW(IREE_UK_RVV_ZERO_ACC)
+#undef IREE_UK_RVV_ZERO_ACC
+  }
+  for (iree_uk_int32_t k = 0; k < K; ++k) {
+    vfloat32m2_t rhs = __riscv_vle32_v_f32m2(rhs_panel, vl);
+    rhs_panel += N0;
+#define IREE_UK_RVV_FMA(i) \
+  acc##i = __riscv_vfmacc_vf_f32m2(acc##i, lhs_panel[i], rhs, vl);
+    IREE_UK_RVV_FOR_EACH_ROW(IREE_UK_RVV_FMA)
+#undef IREE_UK_RVV_FMA
+    lhs_panel += 8;
+  }
+#define IREE_UK_RVV_STORE_ACC(i) \
+  __riscv_vse32_v_f32m2(out_tile + i * N0, acc##i, vl);
+  IREE_UK_RVV_FOR_EACH_ROW(IREE_UK_RVV_STORE_ACC)
+#undef IREE_UK_RVV_STORE_ACC
+}
+
+// i8*i8->i32 8xN0x1 tile: the RHS int8 values are sign-extended to int16 and
+// multiplied by one sign-extended LHS value per row with a widening
+// multiply-accumulate into int32 lanes. The e8mf2, e16m1 and e32m2 register
+// groups have the same number of lanes, so a single vl serves all of them.
+static inline void iree_uk_mmt4d_tile_i8i8i32_8xNx1_riscv_64_v(
+    void* out_tile_untyped, const void* lhs_panel_untyped,
+    const void* rhs_panel_untyped, iree_uk_int32_t K, iree_uk_uint32_t flags,
+    int N0) {
+  iree_uk_int32_t* IREE_UK_RESTRICT out_tile = out_tile_untyped;
+  const iree_uk_int8_t* IREE_UK_RESTRICT lhs_panel = lhs_panel_untyped;
+  const iree_uk_int8_t* IREE_UK_RESTRICT rhs_panel = rhs_panel_untyped;
+  size_t vl = __riscv_vsetvl_e32m2(N0);
+#define IREE_UK_RVV_DECLARE_ACC(i) vint32m2_t acc##i;
+  IREE_UK_RVV_FOR_EACH_ROW(IREE_UK_RVV_DECLARE_ACC)
+#undef IREE_UK_RVV_DECLARE_ACC
+  if (flags & IREE_UK_FLAG_ACCUMULATE) {
+#define IREE_UK_RVV_LOAD_ACC(i) \
+  acc##i = __riscv_vle32_v_i32m2(out_tile + i * N0, vl);
+    IREE_UK_RVV_FOR_EACH_ROW(IREE_UK_RVV_LOAD_ACC)
+#undef IREE_UK_RVV_LOAD_ACC
+  } else {
+#define IREE_UK_RVV_ZERO_ACC(i) acc##i = __riscv_vmv_v_x_i32m2(0, vl);
+    IREE_UK_RVV_FOR_EACH_ROW(IREE_UK_RVV_ZERO_ACC)
+#undef IREE_UK_RVV_ZERO_ACC
+  }
+  for (iree_uk_int32_t k = 0; k < K; ++k) {
+    vint16m1_t rhs =
+        __riscv_vsext_vf2_i16m1(__riscv_vle8_v_i8mf2(rhs_panel, vl), vl);
+    rhs_panel += N0;
+#define IREE_UK_RVV_MAC(i) \
+  acc##i = __riscv_vwmacc_vx_i32m2(acc##i, lhs_panel[i], rhs, vl);
+    IREE_UK_RVV_FOR_EACH_ROW(IREE_UK_RVV_MAC)
+#undef IREE_UK_RVV_MAC
+    lhs_panel += 8;
+  }
+#define IREE_UK_RVV_STORE_ACC(i) \
+  __riscv_vse32_v_i32m2(out_tile + i * N0, acc##i, vl);
+  IREE_UK_RVV_FOR_EACH_ROW(IREE_UK_RVV_STORE_ACC)
+#undef IREE_UK_RVV_STORE_ACC
+}
+
+#undef IREE_UK_RVV_FOR_EACH_ROW
+
+void iree_uk_mmt4d_tile_f32f32f32_8x8x1_riscv_64_v(
+    void* out_tile, const void* lhs_panel, const void* rhs_panel,
+    iree_uk_int32_t K, iree_uk_uint32_t flags,
+    const iree_uk_mmt4d_params_t* params) {
+  iree_uk_mmt4d_tile_f32f32f32_8xNx1_riscv_64_v(out_tile, lhs_panel, rhs_panel,
+                                                K, flags, 8);
+}
+
+void iree_uk_mmt4d_tile_f32f32f32_8x16x1_riscv_64_v(
+    void* out_tile, const void* lhs_panel, const void* rhs_panel,
+    iree_uk_int32_t K, iree_uk_uint32_t flags,
+    const iree_uk_mmt4d_params_t* params) {
+  iree_uk_mmt4d_tile_f32f32f32_8xNx1_riscv_64_v(out_tile, lhs_panel, rhs_panel,
+                                                K, flags, 16);
+}
+
+void iree_uk_mmt4d_tile_i8i8i32_8x8x1_riscv_64_v(
+    void* out_tile, const void* lhs_panel, const void* rhs_panel,
+    iree_uk_int32_t K, iree_uk_uint32_t flags,
+    const iree_uk_mmt4d_params_t* params) {
+  iree_uk_mmt4d_tile_i8i8i32_8xNx1_riscv_64_v(out_tile, lhs_panel, rhs_panel, K,
+                                              flags, 8);
+}
+
+void iree_uk_mmt4d_tile_i8i8i32_8x16x1_riscv_64_v(
+    void* out_tile, const void* lhs_panel, const void* rhs_panel,
+    iree_uk_int32_t K, iree_uk_uint32_t flags,
+    const iree_uk_mmt4d_params_t* params) {
+  iree_uk_mmt4d_tile_i8i8i32_8xNx1_riscv_64_v(out_tile, lhs_panel, rhs_panel, K,
+                                              flags, 16);
+}
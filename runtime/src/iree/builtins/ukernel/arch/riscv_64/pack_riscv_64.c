@@ -0,0 +1,39 @@
+// Copyright 2023 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include "iree/builtins/ukernel/arch/riscv_64/pack_riscv_64.h"
+
+#include "iree/builtins/ukernel/arch/riscv_64/config.h"
+#include "iree/builtins/ukernel/arch/riscv_64/pack_tile_riscv_64.h"
+#include "iree/schemas/cpu_data.h"
+
+iree_uk_pack_tile_func_t iree_uk_pack_select_tile_func_riscv_64(
+    const iree_uk_pack_params_t* params) {
+#ifdef IREE_UK_BUILD_RISCV_64_V
+  if (!(params->cpu_data[0] & IREE_CPU_DATA_FIELD_0_RISCV_64_HAVE_V)) return 0;
+  // The gather tile functions handle any transposed tile, but only direct
+  // tiles with one column, as wider direct tiles are plain row copies that the
+  // generic tile function already does with memcpy.
+  if (!(params->flags & IREE_UK_FLAG_PACK_TRANSPOSE_INNER) &&
+      params->out_size3 != 1) {
+    return 0;
+  }
+  // As in the arm64 pack, only the element type size matters.
+  switch (iree_uk_type_size(iree_uk_pack_out_type(params->type))) {
+    case 1:
+      return iree_uk_pack_tile_x8_riscv_64_v_gather;
+    case 2:
+      return iree_uk_pack_tile_x16_riscv_64_v_gather;
+    case 4:
+      return iree_uk_pack_tile_x32_riscv_64_v_gather;
+    default:
+      return 0;
+  }
+#else
+  (void)params;
+  return 0;
+#endif
+}
@@ -0,0 +1,16 @@
+// Copyright 2023 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#ifndef IREE_BUILTINS_UKERNEL_ARCH_RISCV_64_PACK_TILE_RISCV_64_H_
+#define IREE_BUILTINS_UKERNEL_ARCH_RISCV_64_PACK_TILE_RISCV_64_H_
+
+#include "iree/builtins/ukernel/pack_types.h"
+
+IREE_UK_PACK_TILE_FUNC_DECL(iree_uk_pack_tile_x8_riscv_64_v_gather)
+IREE_UK_PACK_TILE_FUNC_DECL(iree_uk_pack_tile_x16_riscv_64_v_gather)
+IREE_UK_PACK_TILE_FUNC_DECL(iree_uk_pack_tile_x32_riscv_64_v_gather)
+
+#endif  // IREE_BUILTINS_UKERNEL_ARCH_RISCV_64_PACK_TILE_RISCV_64_H_
@@ -0,0 +1,54 @@
+// Copyright 2023 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include <riscv_vector.h>
+
+#include "iree/builtins/ukernel/arch/riscv_64/pack_tile_riscv_64.h"
+
+// Pack tile functions built on strided vector loads. Each output tile row is a
+// column of the input tile, gathered with one strided load per vl elements and
+// written with a unit-stride store. This is the transposed case for any tile
+// shape, and also the direct case when tile_size1 == 1. The loop over
+// tile_size0 is strip-mined with vsetvl at LMUL=8, so it is VLEN-agnostic and
+// any tile size is supported.
+#define IREE_UK_PACK_TILE_RISCV_64_V_GATHER(BITS)                              \
+  void* iree_uk_pack_tile_x##BITS##_riscv_64_v_gather(                         \
+      void* IREE_UK_RESTRICT out_tile_ptr,                                     \
+      const void* IREE_UK_RESTRICT in_tile_ptr, iree_uk_ssize_t outer_size1,   \
+      iree_uk_ssize_t out_stride_l1, iree_uk_ssize_t in_stride0,               \
+      iree_uk_ssize_t elem_size_unused, iree_uk_ssize_t tile_size0,            \
+      iree_uk_ssize_t tile_size1) {                                            \
+    const iree_uk_int##BITS##_t* IREE_UK_RESTRICT in_ptr_l1 = in_tile_ptr;     \
+    iree_uk_int##BITS##_t* IREE_UK_RESTRICT out_ptr_l1 = out_tile_ptr;         \
+    const iree_uk_ssize_t in_stride_bytes = in_stride0 * (BITS / 8);           \
+    for (iree_uk_ssize_t outer_i1 = 0; outer_i1 < outer_size1; ++outer_i1) {   \
+      iree_uk_int##BITS##_t* IREE_UK_RESTRICT out_ptr = out_ptr_l1;            \
+      for (iree_uk_ssize_t tile_i1 = 0; tile_i1 < tile_size1; ++tile_i1) {     \
+        const iree_uk_int##BITS##_t* IREE_UK_RESTRICT in_ptr =                 \
+            in_ptr_l1 + tile_i1;                                               \
+        size_t vl;                                                             \
+        for (iree_uk_ssize_t tile_i0 = 0; tile_i0 < tile_size0;                \
+             tile_i0 += vl) {                                                  \
+          vl = __riscv_vsetvl_e##BITS##m8(tile_size0 - tile_i0);               \
+          __riscv_vse##BITS##_v_i##BITS##m8(                                   \
+              out_ptr + tile_i0,                                               \
+              __riscv_vlse##BITS##_v_i##BITS##m8(                              \
+                  in_ptr + tile_i0 * in_stride0, in_stride_bytes, vl),         \
+              vl);                                                             \
+        }                                                                      \
+        out_ptr += tile_size0;                                                 \
+      }                                                                        \
+      out_ptr_l1 += out_stride_l1;                                             \
+      in_ptr_l1 += tile_size1;                                                 \
+    }                                                                          \
+    return out_ptr_l1;                                                         \
+  }
+
+IREE_UK_PACK_TILE_RISCV_64_V_GATHER(8)
+IREE_UK_PACK_TILE_RISCV_64_V_GATHER(16)
+IREE_UK_PACK_TILE_RISCV_64_V_GATHER(32)
+
+#undef IREE_UK_PACK_TILE_RISCV_64_V_GATHER
@@ -0,0 +1,15 @@
+// Copyright 2023 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#ifndef IREE_BUILTINS_UKERNEL_ARCH_WASM_32_MMT4D_TILE_WASM_32_H_
+#define IREE_BUILTINS_UKERNEL_ARCH_WASM_32_MMT4D_TILE_WASM_32_H_
+
+#include "iree/builtins/ukernel/mmt4d_types.h"
+
+IREE_UK_MMT4D_TILE_FUNC_DECL(iree_uk_mmt4d_tile_f32f32f32_8x8x1_wasm_32_simd128)
+IREE_UK_MMT4D_TILE_FUNC_DECL(iree_uk_mmt4d_tile_i8i8i32_8x8x1_wasm_32_simd128)
+
+#endif  // IREE_BUILTINS_UKERNEL_ARCH_WASM_32_MMT4D_TILE_WASM_32_H_
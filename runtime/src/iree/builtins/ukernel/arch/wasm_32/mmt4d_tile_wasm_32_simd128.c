@@ -0,0 +1,75 @@
+// Copyright 2023 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include <wasm_simd128.h>
+
+#include "iree/builtins/ukernel/arch/wasm_32/mmt4d_tile_wasm_32.h"
+
+// Both tiles are 8x8x1 and hold each row of the output tile in two 128-bit
+// accumulators. SIMD128 has no fused multiply-add outside of relaxed-simd, so
+// the f32 tile uses separate multiplies and adds.
+
+void iree_uk_mmt4d_tile_f32f32f32_8x8x1_wasm_32_simd128(
+    void* IREE_UK_RESTRICT out_tile_untyped,
+    const void* IREE_UK_RESTRICT lhs_panel_untyped,
+    const void* IREE_UK_RESTRICT rhs_panel_untyped, iree_uk_int32_t K,
+    iree_uk_uint32_t flags, const iree_uk_mmt4d_params_t* params) {
+  float* IREE_UK_RESTRICT out_ptr = out_tile_untyped;
+  const float* IREE_UK_RESTRICT lhs_ptr = lhs_panel_untyped;
+  const float* IREE_UK_RESTRICT rhs_ptr = rhs_panel_untyped;
+  v128_t acc[16];
+  if (flags & IREE_UK_FLAG_ACCUMULATE) {
+    for (int i = 0; i < 16; ++i) acc[i] = wasm_v128_load(out_ptr + 4 * i);
+  } else {
+    for (int i = 0; i < 16; ++i) acc[i] = wasm_f32x4_splat(0.f);
+  }
+  for (iree_uk_int32_t k = 0; k < K; ++k) {
+    v128_t rhs0 = wasm_v128_load(rhs_ptr);
+    v128_t rhs1 = wasm_v128_load(rhs_ptr + 4);
+    rhs_ptr += 8;
+    for (int i = 0; i < 8; ++i) {
+      v128_t lhs = wasm_f32x4_splat(lhs_ptr[i]);
+      acc[2 * i + 0] =
+          wasm_f32x4_add(acc[2 * i + 0], wasm_f32x4_mul(lhs, rhs0));
+      acc[2 * i + 1] =
+          wasm_f32x4_add(acc[2 * i + 1], wasm_f32x4_mul(lhs, rhs1));
+    }
+    lhs_ptr += 8;
+  }
+  for (int i = 0; i < 16; ++i) wasm_v128_store(out_ptr + 4 * i, acc[i]);
+}
+
+// The RHS int8 values are sign-extended to int16 on load and multiplied by one
+// LHS value per row with widening multiplies into int32 lanes. Products of
+// two int8 values always fit in int16.
+void iree_uk_mmt4d_tile_i8i8i32_8x8x1_wasm_32_simd128(
+    void* IREE_UK_RESTRICT out_tile_untyped,
+    const void* IREE_UK_RESTRICT lhs_panel_untyped,
+    const void* IREE_UK_RESTRICT rhs_panel_untyped, iree_uk_int32_t K,
+    iree_uk_uint32_t flags, const iree_uk_mmt4d_params_t* params) {
+  iree_uk_int32_t* IREE_UK_RESTRICT out_ptr = out_tile_untyped;
+  const iree_uk_int8_t* IREE_UK_RESTRICT lhs_ptr = lhs_panel_untyped;
+  const iree_uk_int8_t* IREE_UK_RESTRICT rhs_ptr = rhs_panel_untyped;
+  v128_t acc[16];
+  if (flags & IREE_UK_FLAG_ACCUMULATE) {
+    for (int i = 0; i < 16; ++i) acc[i] = wasm_v128_load(out_ptr + 4 * i);
+  } else {
+    for (int i = 0; i < 16; ++i) acc[i] = wasm_i32x4_splat(0);
+  }
+  for (iree_uk_int32_t k = 0; k < K; ++k) {
+    v128_t rhs = wasm_i16x8_load8x8(rhs_ptr);
+    rhs_ptr += 8;
+    for (int i = 0; i < 8; ++i) {
+      v128_t lhs = wasm_i16x8_splat(lhs_ptr[i]);
+      acc[2 * i + 0] = wasm_i32x4_add(acc[2 * i + 0],
+                                      wasm_i32x4_extmul_low_i16x8(lhs, rhs));
+      acc[2 * i + 1] = wasm_i32x4_add(acc[2 * i + 1],
+                                      wasm_i32x4_extmul_high_i16x8(lhs, rhs));
+    }
+    lhs_ptr += 8;
+  }
+  for (int i = 0; i < 16; ++i) wasm_v128_store(out_ptr + 4 * i, acc[i]);
+}
@@ -0,0 +1,52 @@
+// Copyright 2023 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include "iree/builtins/ukernel/arch/wasm_32/mmt4d_wasm_32.h"
+
+#include "iree/builtins/ukernel/arch/wasm_32/config.h"
+#include "iree/builtins/ukernel/arch/wasm_32/mmt4d_tile_wasm_32.h"
+
+// WebAssembly has no runtime CPU feature detection: a module using SIMD128
+// fails validation as a whole on engines without it. The SIMD128 tile
+// functions are therefore selected whenever they are built.
+
+static iree_uk_mmt4d_tile_func_t
+iree_uk_mmt4d_select_tile_func_wasm_32_f32f32f32(
+    const iree_uk_mmt4d_params_t* params) {
+#ifdef IREE_UK_BUILD_WASM_32_SIMD128
+  if (params->M0 == 8 && params->N0 == 8 && params->K0 == 1) {
+    return iree_uk_mmt4d_tile_f32f32f32_8x8x1_wasm_32_simd128;
+  }
+#else
+  (void)params;
+#endif
+  return 0;
+}
+
+static iree_uk_mmt4d_tile_func_t
+iree_uk_mmt4d_select_tile_func_wasm_32_i8i8i32(
+    const iree_uk_mmt4d_params_t* params) {
+#ifdef IREE_UK_BUILD_WASM_32_SIMD128
+  if (params->M0 == 8 && params->N0 == 8 && params->K0 == 1) {
+    return iree_uk_mmt4d_tile_i8i8i32_8x8x1_wasm_32_simd128;
+  }
+#else
+  (void)params;
+#endif
+  return 0;
+}
+
+iree_uk_mmt4d_tile_func_t iree_uk_mmt4d_select_tile_func_wasm_32(
+    const iree_uk_mmt4d_params_t* params) {
+  switch (params->type) {
+    case iree_uk_mmt4d_type_f32f32f32:
+      return iree_uk_mmt4d_select_tile_func_wasm_32_f32f32f32(params);
+    case iree_uk_mmt4d_type_i8i8i32:
+      return iree_uk_mmt4d_select_tile_func_wasm_32_i8i8i32(params);
+    default:
+      return 0;
+  }
+}
@@ -0,0 +1,66 @@
+// Copyright 2023 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#ifndef IREE_BUILTINS_UKERNEL_ARCH_X86_64_ELEMENTWISE_ROW_X86_64_H_
+#define IREE_BUILTINS_UKERNEL_ARCH_X86_64_ELEMENTWISE_ROW_X86_64_H_
+
+#include "iree/builtins/ukernel/elementwise_types.h"
+
+// Declares a row function of type iree_uk_x32b_row_func_t.
+#define IREE_UK_X32B_ROW_FUNC_DECL(NAME)                              \
+  void NAME(const iree_uk_uint32_t* lhs, const iree_uk_uint32_t* rhs, \
+            iree_uk_uint32_t* IREE_UK_RESTRICT out, iree_uk_ssize_t size);
+
+// Declares a row function of type iree_uk_x32u_row_func_t.
+#define IREE_UK_X32U_ROW_FUNC_DECL(NAME) \
+  void NAME(const iree_uk_uint32_t* in,  \
+            iree_uk_uint32_t* IREE_UK_RESTRICT out, iree_uk_ssize_t size);
+
+IREE_UK_X32B_ROW_FUNC_DECL(iree_uk_x32b_row_addf_x86_64_avx2_fma)
+IREE_UK_X32B_ROW_FUNC_DECL(iree_uk_x32b_row_addi_x86_64_avx2_fma)
+IREE_UK_X32B_ROW_FUNC_DECL(iree_uk_x32b_row_andi_x86_64_avx2_fma)
+IREE_UK_X32B_ROW_FUNC_DECL(iree_uk_x32b_row_divf_x86_64_avx2_fma)
+IREE_UK_X32B_ROW_FUNC_DECL(iree_uk_x32b_row_mulf_x86_64_avx2_fma)
+IREE_UK_X32B_ROW_FUNC_DECL(iree_uk_x32b_row_muli_x86_64_avx2_fma)
+IREE_UK_X32B_ROW_FUNC_DECL(iree_uk_x32b_row_ori_x86_64_avx2_fma)
+IREE_UK_X32B_ROW_FUNC_DECL(iree_uk_x32b_row_shli_x86_64_avx2_fma)
+IREE_UK_X32B_ROW_FUNC_DECL(iree_uk_x32b_row_shrsi_x86_64_avx2_fma)
+IREE_UK_X32B_ROW_FUNC_DECL(iree_uk_x32b_row_shrui_x86_64_avx2_fma)
+IREE_UK_X32B_ROW_FUNC_DECL(iree_uk_x32b_row_subf_x86_64_avx2_fma)
+IREE_UK_X32B_ROW_FUNC_DECL(iree_uk_x32b_row_subi_x86_64_avx2_fma)
+IREE_UK_X32B_ROW_FUNC_DECL(iree_uk_x32b_row_xori_x86_64_avx2_fma)
+IREE_UK_X32U_ROW_FUNC_DECL(iree_uk_x32u_row_absf_x86_64_avx2_fma)
+IREE_UK_X32U_ROW_FUNC_DECL(iree_uk_x32u_row_ceilf_x86_64_avx2_fma)
+IREE_UK_X32U_ROW_FUNC_DECL(iree_uk_x32u_row_expf_x86_64_avx2_fma)
+IREE_UK_X32U_ROW_FUNC_DECL(iree_uk_x32u_row_floorf_x86_64_avx2_fma)
+IREE_UK_X32U_ROW_FUNC_DECL(iree_uk_x32u_row_logf_x86_64_avx2_fma)
+IREE_UK_X32U_ROW_FUNC_DECL(iree_uk_x32u_row_negf_x86_64_avx2_fma)
+IREE_UK_X32U_ROW_FUNC_DECL(iree_uk_x32u_row_rsqrtf_x86_64_avx2_fma)
+IREE_UK_X32U_ROW_FUNC_DECL(iree_uk_x32u_row_tanhf_x86_64_avx2_fma)
+IREE_UK_X32B_ROW_FUNC_DECL(iree_uk_x32b_row_addf_x86_64_avx512_base)
+IREE_UK_X32B_ROW_FUNC_DECL(iree_uk_x32b_row_addi_x86_64_avx512_base)
+IREE_UK_X32B_ROW_FUNC_DECL(iree_uk_x32b_row_andi_x86_64_avx512_base)
+IREE_UK_X32B_ROW_FUNC_DECL(iree_uk_x32b_row_divf_x86_64_avx512_base)
+IREE_UK_X32B_ROW_FUNC_DECL(iree_uk_x32b_row_mulf_x86_64_avx512_base)
+IREE_UK_X32B_ROW_FUNC_DECL(iree_uk_x32b_row_muli_x86_64_avx512_base)
+IREE_UK_X32B_ROW_FUNC_DECL(iree_uk_x32b_row_ori_x86_64_avx512_base)
+IREE_UK_X32B_ROW_FUNC_DECL(iree_uk_x32b_row_shli_x86_64_avx512_base)
+IREE_UK_X32B_ROW_FUNC_DECL(iree_uk_x32b_row_shrsi_x86_64_avx512_base)
+IREE_UK_X32B_ROW_FUNC_DECL(iree_uk_x32b_row_shrui_x86_64_avx512_base)
+IREE_UK_X32B_ROW_FUNC_DECL(iree_uk_x32b_row_subf_x86_64_avx512_base)
+IREE_UK_X32B_ROW_FUNC_DECL(iree_uk_x32b_row_subi_x86_64_avx512_base)
+IREE_UK_X32B_ROW_FUNC_DECL(iree_uk_x32b_row_xori_x86_64_avx512_base)
+IREE_UK_X32U_ROW_FUNC_DECL(iree_uk_x32u_row_absf_x86_64_avx512_base)
+IREE_UK_X32U_ROW_FUNC_DECL(iree_uk_x32u_row_ceilf_x86_64_avx512_base)
+IREE_UK_X32U_ROW_FUNC_DECL(iree_uk_x32u_row_ctlz_x86_64_avx512_base)
+IREE_UK_X32U_ROW_FUNC_DECL(iree_uk_x32u_row_expf_x86_64_avx512_base)
+IREE_UK_X32U_ROW_FUNC_DECL(iree_uk_x32u_row_floorf_x86_64_avx512_base)
+IREE_UK_X32U_ROW_FUNC_DECL(iree_uk_x32u_row_logf_x86_64_avx512_base)
+IREE_UK_X32U_ROW_FUNC_DECL(iree_uk_x32u_row_negf_x86_64_avx512_base)
+IREE_UK_X32U_ROW_FUNC_DECL(iree_uk_x32u_row_rsqrtf_x86_64_avx512_base)
+IREE_UK_X32U_ROW_FUNC_DECL(iree_uk_x32u_row_tanhf_x86_64_avx512_base)
+
+#endif  // IREE_BUILTINS_UKERNEL_ARCH_X86_64_ELEMENTWISE_ROW_X86_64_H_
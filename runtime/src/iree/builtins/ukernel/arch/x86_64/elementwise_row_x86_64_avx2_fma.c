@@ -0,0 +1,250 @@
+// Copyright 2023 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include <immintrin.h>
+
+#include "iree/builtins/ukernel/arch/x86_64/elementwise_row_x86_64.h"
+
+//===----------------------------------------------------------------------===//
+// Vector math helpers.
+//===----------------------------------------------------------------------===//
+
+// exp(x) as 2^n * exp(r) with n = round(x / ln2) and |r| <= ln2 / 2, where
+// exp(r) is approximated by the Cephes expf polynomial (max error ~1 ulp).
+// The scaling by 2^n is done in two steps so that results in the denormal
+// range and up to FLT_MAX don't overflow the exponent field of the scale.
+static inline __m256 iree_uk_exp_ps_avx2_fma(__m256 x) {
+  __m256 is_nan = _mm256_cmp_ps(x, x, _CMP_UNORD_Q);
+  __m256 y = _mm256_min_ps(x, _mm256_set1_ps(89.0f));
+  y = _mm256_max_ps(y, _mm256_set1_ps(-104.0f));
+  __m256 n = _mm256_round_ps(_mm256_mul_ps(y, _mm256_set1_ps(1.44269504f)),
+                             _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC);
+  // ln2 is split in a high part with few mantissa bits so that n * ln2_hi is
+  // exact, and a low part for the remainder.
+  __m256 r = _mm256_fnmadd_ps(n, _mm256_set1_ps(0.693359375f), y);
+  r = _mm256_fnmadd_ps(n, _mm256_set1_ps(-2.12194440e-4f), r);
+  __m256 p = _mm256_set1_ps(1.9875691500e-4f);
+  p = _mm256_fmadd_ps(p, r, _mm256_set1_ps(1.3981999507e-3f));
+  p = _mm256_fmadd_ps(p, r, _mm256_set1_ps(8.3334519073e-3f));
+  p = _mm256_fmadd_ps(p, r, _mm256_set1_ps(4.1665795894e-2f));
+  p = _mm256_fmadd_ps(p, r, _mm256_set1_ps(1.6666665459e-1f));
+  p = _mm256_fmadd_ps(p, r, _mm256_set1_ps(5.0000001201e-1f));
+  p = _mm256_fmadd_ps(p, _mm256_mul_ps(r, r),
+                      _mm256_add_ps(r, _mm256_set1_ps(1.0f)));
+  __m256i ni = _mm256_cvtps_epi32(n);
+  __m256i n_lo = _mm256_srai_epi32(ni, 1);
+  __m256i n_hi = _mm256_sub_epi32(ni, n_lo);
+  __m256i bias = _mm256_set1_epi32(127);
+  __m256 scale_lo =
+      _mm256_castsi256_ps(_mm256_slli_epi32(_mm256_add_epi32(n_lo, bias), 23));
+  __m256 scale_hi =
+      _mm256_castsi256_ps(_mm256_slli_epi32(_mm256_add_epi32(n_hi, bias), 23));
+  p = _mm256_mul_ps(_mm256_mul_ps(p, scale_lo), scale_hi);
+  return _mm256_blendv_ps(p, x, is_nan);
+}
+
+// log(x) as e * ln2 + log(m) with m in [sqrt(1/2), sqrt(2)), where log(m) is
+// approximated by the Cephes logf polynomial (max error ~1 ulp). Denormal
+// inputs are scaled into the normal range first and the special cases
+// (x < 0, NaN, 0 and +inf) are patched in at the end.
+static inline __m256 iree_uk_log_ps_avx2_fma(__m256 x) {
+  __m256 zero = _mm256_setzero_ps();
+  __m256 inf = _mm256_castsi256_ps(_mm256_set1_epi32(0x7F800000));
+  __m256 is_invalid = _mm256_cmp_ps(x, zero, _CMP_NGE_UQ);
+  __m256 is_zero = _mm256_cmp_ps(x, zero, _CMP_EQ_OQ);
+  __m256 is_inf = _mm256_cmp_ps(x, inf, _CMP_EQ_OQ);
+  __m256 is_denormal = _mm256_cmp_ps(x, _mm256_set1_ps(1.17549435e-38f),
+                                     _CMP_LT_OQ);
+  __m256 y = _mm256_blendv_ps(x, _mm256_mul_ps(x, _mm256_set1_ps(8388608.0f)),
+                              is_denormal);
+  __m256i bits = _mm256_castps_si256(y);
+  __m256i ei = _mm256_sub_epi32(_mm256_srli_epi32(bits, 23),
+                                _mm256_set1_epi32(126));
+  ei = _mm256_sub_epi32(ei, _mm256_and_si256(_mm256_castps_si256(is_denormal),
+                                             _mm256_set1_epi32(23)));
+  __m256 m = _mm256_castsi256_ps(
+      _mm256_or_si256(_mm256_and_si256(bits, _mm256_set1_epi32(0x007FFFFF)),
+                      _mm256_set1_epi32(0x3F000000)));
+  // m is in [1/2, 1) here; values below sqrt(1/2) are doubled.
+  __m256 is_small = _mm256_cmp_ps(m, _mm256_set1_ps(0.707106781f), _CMP_LT_OQ);
+  __m256 e = _mm256_sub_ps(_mm256_cvtepi32_ps(ei),
+                           _mm256_and_ps(is_small, _mm256_set1_ps(1.0f)));
+  m = _mm256_add_ps(_mm256_sub_ps(m, _mm256_set1_ps(1.0f)),
+                    _mm256_and_ps(is_small, m));
+  __m256 z = _mm256_mul_ps(m, m);
+  __m256 p = _mm256_set1_ps(7.0376836292e-2f);
+  p = _mm256_fmadd_ps(p, m, _mm256_set1_ps(-1.1514610310e-1f));
+  p = _mm256_fmadd_ps(p, m, _mm256_set1_ps(1.1676998740e-1f));
+  p = _mm256_fmadd_ps(p, m, _mm256_set1_ps(-1.2420140846e-1f));
+  p = _mm256_fmadd_ps(p, m, _mm256_set1_ps(1.4249322787e-1f));
+  p = _mm256_fmadd_ps(p, m, _mm256_set1_ps(-1.6668057665e-1f));
+  p = _mm256_fmadd_ps(p, m, _mm256_set1_ps(2.0000714765e-1f));
+  p = _mm256_fmadd_ps(p, m, _mm256_set1_ps(-2.4999993993e-1f));
+  p = _mm256_fmadd_ps(p, m, _mm256_set1_ps(3.3333331174e-1f));
+  p = _mm256_mul_ps(_mm256_mul_ps(p, m), z);
+  p = _mm256_fmadd_ps(e, _mm256_set1_ps(-2.12194440e-4f), p);
+  p = _mm256_fnmadd_ps(z, _mm256_set1_ps(0.5f), p);
+  __m256 result = _mm256_add_ps(m, p);
+  result = _mm256_fmadd_ps(e, _mm256_set1_ps(0.693359375f), result);
+  result = _mm256_blendv_ps(result, inf, is_inf);
+  result = _mm256_blendv_ps(result, _mm256_sub_ps(zero, inf), is_zero);
+  __m256 nan = _mm256_castsi256_ps(_mm256_set1_epi32(0x7FC00000));
+  return _mm256_blendv_ps(result, nan, is_invalid);
+}
+
+// tanh(x) as the Cephes tanhf odd polynomial for |x| < 0.625 and as
+// sign(x) * (1 - 2 / (exp(2|x|) + 1)) otherwise.
+static inline __m256 iree_uk_tanh_ps_avx2_fma(__m256 x) {
+  __m256 sign_mask = _mm256_set1_ps(-0.0f);
+  __m256 abs_x = _mm256_andnot_ps(sign_mask, x);
+  __m256 z = _mm256_mul_ps(x, x);
+  __m256 p = _mm256_set1_ps(-5.70498872745e-3f);
+  p = _mm256_fmadd_ps(p, z, _mm256_set1_ps(2.06390887954e-2f));
+  p = _mm256_fmadd_ps(p, z, _mm256_set1_ps(-5.37397155531e-2f));
+  p = _mm256_fmadd_ps(p, z, _mm256_set1_ps(1.33314422036e-1f));
+  p = _mm256_fmadd_ps(p, z, _mm256_set1_ps(-3.33332819422e-1f));
+  __m256 small = _mm256_fmadd_ps(_mm256_mul_ps(p, z), x, x);
+  __m256 one = _mm256_set1_ps(1.0f);
+  __m256 e = iree_uk_exp_ps_avx2_fma(_mm256_add_ps(abs_x, abs_x));
+  __m256 large = _mm256_sub_ps(
+      one, _mm256_div_ps(_mm256_set1_ps(2.0f), _mm256_add_ps(e, one)));
+  large = _mm256_or_ps(large, _mm256_and_ps(sign_mask, x));
+  return _mm256_blendv_ps(
+      large, small, _mm256_cmp_ps(abs_x, _mm256_set1_ps(0.625f), _CMP_LT_OQ));
+}
+
+//===----------------------------------------------------------------------===//
+// Per-opcode vector ops, on 8 lanes of 32 bits.
+//===----------------------------------------------------------------------===//
+
+#define IREE_UK_AVX2_FLOAT_BINARY_OP(NAME, INTRINSIC)               \
+  static inline __m256i iree_uk_avx2_##NAME(__m256i a, __m256i b) { \
+    return _mm256_castps_si256(                                     \
+        INTRINSIC(_mm256_castsi256_ps(a), _mm256_castsi256_ps(b))); \
+  }
+#define IREE_UK_AVX2_FLOAT_UNARY_OP(NAME, EXPR)          \
+  static inline __m256i iree_uk_avx2_##NAME(__m256i a) { \
+    __m256 x = _mm256_castsi256_ps(a);                   \
+    return _mm256_castps_si256(EXPR);                    \
+  }
+
+IREE_UK_AVX2_FLOAT_BINARY_OP(addf, _mm256_add_ps)
+IREE_UK_AVX2_FLOAT_BINARY_OP(divf, _mm256_div_ps)
+IREE_UK_AVX2_FLOAT_BINARY_OP(mulf, _mm256_mul_ps)
+IREE_UK_AVX2_FLOAT_BINARY_OP(subf, _mm256_sub_ps)
+
+static inline __m256i iree_uk_avx2_addi(__m256i a, __m256i b) {
+  return _mm256_add_epi32(a, b);
+}
+static inline __m256i iree_uk_avx2_andi(__m256i a, __m256i b) {
+  return _mm256_and_si256(a, b);
+}
+static inline __m256i iree_uk_avx2_muli(__m256i a, __m256i b) {
+  return _mm256_mullo_epi32(a, b);
+}
+static inline __m256i iree_uk_avx2_ori(__m256i a, __m256i b) {
+  return _mm256_or_si256(a, b);
+}
+static inline __m256i iree_uk_avx2_shli(__m256i a, __m256i b) {
+  return _mm256_sllv_epi32(a, b);
+}
+static inline __m256i iree_uk_avx2_shrsi(__m256i a, __m256i b) {
+  return _mm256_srav_epi32(a, b);
+}
+static inline __m256i iree_uk_avx2_shrui(__m256i a, __m256i b) {
+  return _mm256_srlv_epi32(a, b);
+}
+static inline __m256i iree_uk_avx2_subi(__m256i a, __m256i b) {
+  return _mm256_sub_epi32(a, b);
+}
+static inline __m256i iree_uk_avx2_xori(__m256i a, __m256i b) {
+  return _mm256_xor_si256(a, b);
+}
+
+IREE_UK_AVX2_FLOAT_UNARY_OP(absf,
+                            _mm256_andnot_ps(_mm256_set1_ps(-0.0f), x))
+IREE_UK_AVX2_FLOAT_UNARY_OP(ceilf,
+                            _mm256_round_ps(x, _MM_FROUND_TO_POS_INF |
+                                                   _MM_FROUND_NO_EXC))
+IREE_UK_AVX2_FLOAT_UNARY_OP(expf, iree_uk_exp_ps_avx2_fma(x))
+IREE_UK_AVX2_FLOAT_UNARY_OP(floorf,
+                            _mm256_round_ps(x, _MM_FROUND_TO_NEG_INF |
+                                                   _MM_FROUND_NO_EXC))
+IREE_UK_AVX2_FLOAT_UNARY_OP(logf, iree_uk_log_ps_avx2_fma(x))
+IREE_UK_AVX2_FLOAT_UNARY_OP(negf, _mm256_xor_ps(_mm256_set1_ps(-0.0f), x))
+// Not using VRSQRTPS: its ~12-bit approximation is far from 1.0f / sqrtf.
+IREE_UK_AVX2_FLOAT_UNARY_OP(rsqrtf, _mm256_div_ps(_mm256_set1_ps(1.0f),
+                                                  _mm256_sqrt_ps(x)))
+IREE_UK_AVX2_FLOAT_UNARY_OP(tanhf, iree_uk_tanh_ps_avx2_fma(x))
+
+//===----------------------------------------------------------------------===//
+// Row functions.
+//===----------------------------------------------------------------------===//
+
+// Returns a mask enabling the first |count| (< 8) lanes, for tail handling
+// with masked loads and stores.
+static inline __m256i iree_uk_avx2_tail_mask(iree_uk_ssize_t count) {
+  return _mm256_cmpgt_epi32(_mm256_set1_epi32((int)count),
+                            _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7));
+}
+
+#define IREE_UK_X32B_ROW_FUNC_AVX2_FMA(NAME)                               \
+  void iree_uk_x32b_row_##NAME##_x86_64_avx2_fma(                          \
+      const iree_uk_uint32_t* lhs, const iree_uk_uint32_t* rhs,            \
+      iree_uk_uint32_t* IREE_UK_RESTRICT out, iree_uk_ssize_t size) {      \
+    iree_uk_ssize_t i = 0;                                                 \
+    for (; i + 8 <= size; i += 8) {                                        \
+      __m256i a = _mm256_loadu_si256((const __m256i*)(lhs + i));           \
+      __m256i b = _mm256_loadu_si256((const __m256i*)(rhs + i));           \
+      _mm256_storeu_si256((__m256i*)(out + i), iree_uk_avx2_##NAME(a, b)); \
+    }                                                                      \
+    if (i < size) {                                                        \
+      __m256i mask = iree_uk_avx2_tail_mask(size - i);                     \
+      __m256i a = _mm256_maskload_epi32((const int*)(lhs + i), mask);      \
+      __m256i b = _mm256_maskload_epi32((const int*)(rhs + i), mask);      \
+      _mm256_maskstore_epi32((int*)(out + i), mask,                        \
+                             iree_uk_avx2_##NAME(a, b));                   \
+    }                                                                      \
+  }
+
+#define IREE_UK_X32U_ROW_FUNC_AVX2_FMA(NAME)                                 \
+  void iree_uk_x32u_row_##NAME##_x86_64_avx2_fma(                            \
+      const iree_uk_uint32_t* in, iree_uk_uint32_t* IREE_UK_RESTRICT out,    \
+      iree_uk_ssize_t size) {                                                \
+    iree_uk_ssize_t i = 0;                                                   \
+    for (; i + 8 <= size; i += 8) {                                          \
+      __m256i a = _mm256_loadu_si256((const __m256i*)(in + i));              \
+      _mm256_storeu_si256((__m256i*)(out + i), iree_uk_avx2_##NAME(a));      \
+    }                                                                        \
+    if (i < size) {                                                          \
+      __m256i mask = iree_uk_avx2_tail_mask(size - i);                       \
+      __m256i a = _mm256_maskload_epi32((const int*)(in + i), mask);         \
+      _mm256_maskstore_epi32((int*)(out + i), mask, iree_uk_avx2_##NAME(a)); \
+    }                                                                        \
+  }
+
+IREE_UK_X32B_ROW_FUNC_AVX2_FMA(addf)
+IREE_UK_X32B_ROW_FUNC_AVX2_FMA(addi)
+IREE_UK_X32B_ROW_FUNC_AVX2_FMA(andi)
+IREE_UK_X32B_ROW_FUNC_AVX2_FMA(divf)
+IREE_UK_X32B_ROW_FUNC_AVX2_FMA(mulf)
+IREE_UK_X32B_ROW_FUNC_AVX2_FMA(muli)
+IREE_UK_X32B_ROW_FUNC_AVX2_FMA(ori)
+IREE_UK_X32B_ROW_FUNC_AVX2_FMA(shli)
+IREE_UK_X32B_ROW_FUNC_AVX2_FMA(shrsi)
+IREE_UK_X32B_ROW_FUNC_AVX2_FMA(shrui)
+IREE_UK_X32B_ROW_FUNC_AVX2_FMA(subf)
+IREE_UK_X32B_ROW_FUNC_AVX2_FMA(subi)
+IREE_UK_X32B_ROW_FUNC_AVX2_FMA(xori)
+
+IREE_UK_X32U_ROW_FUNC_AVX2_FMA(absf)
+IREE_UK_X32U_ROW_FUNC_AVX2_FMA(ceilf)
+IREE_UK_X32U_ROW_FUNC_AVX2_FMA(expf)
+IREE_UK_X32U_ROW_FUNC_AVX2_FMA(floorf)
+IREE_UK_X32U_ROW_FUNC_AVX2_FMA(logf)
+IREE_UK_X32U_ROW_FUNC_AVX2_FMA(negf)
+IREE_UK_X32U_ROW_FUNC_AVX2_FMA(rsqrtf)
+IREE_UK_X32U_ROW_FUNC_AVX2_FMA(tanhf)
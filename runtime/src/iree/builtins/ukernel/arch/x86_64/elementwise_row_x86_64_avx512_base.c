@@ -0,0 +1,236 @@
+// Copyright 2023 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include <immintrin.h>
+
+#include "iree/builtins/ukernel/arch/x86_64/elementwise_row_x86_64.h"
+
+//===----------------------------------------------------------------------===//
+// Vector math helpers.
+// These use the same approximations as elementwise_row_x86_64_avx2_fma.c,
+// using mask registers for special cases and VSCALEFPS for the 2^n scaling.
+//===----------------------------------------------------------------------===//
+
+static inline __m512 iree_uk_exp_ps_avx512_base(__m512 x) {
+  __m512 y = _mm512_min_ps(x, _mm512_set1_ps(89.0f));
+  y = _mm512_max_ps(y, _mm512_set1_ps(-104.0f));
+  __m512 n = _mm512_roundscale_ps(
+      _mm512_mul_ps(y, _mm512_set1_ps(1.44269504f)),
+      _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC);
+  __m512 r = _mm512_fnmadd_ps(n, _mm512_set1_ps(0.693359375f), y);
+  r = _mm512_fnmadd_ps(n, _mm512_set1_ps(-2.12194440e-4f), r);
+  __m512 p = _mm512_set1_ps(1.9875691500e-4f);
+  p = _mm512_fmadd_ps(p, r, _mm512_set1_ps(1.3981999507e-3f));
+  p = _mm512_fmadd_ps(p, r, _mm512_set1_ps(8.3334519073e-3f));
+  p = _mm512_fmadd_ps(p, r, _mm512_set1_ps(4.1665795894e-2f));
+  p = _mm512_fmadd_ps(p, r, _mm512_set1_ps(1.6666665459e-1f));
+  p = _mm512_fmadd_ps(p, r, _mm512_set1_ps(5.0000001201e-1f));
+  p = _mm512_fmadd_ps(p, _mm512_mul_ps(r, r),
+                      _mm512_add_ps(r, _mm512_set1_ps(1.0f)));
+  p = _mm512_scalef_ps(p, n);
+  __mmask16 is_nan = _mm512_cmp_ps_mask(x, x, _CMP_UNORD_Q);
+  return _mm512_mask_mov_ps(p, is_nan, x);
+}
+
+static inline __m512 iree_uk_log_ps_avx512_base(__m512 x) {
+  __m512 zero = _mm512_setzero_ps();
+  __m512 inf = _mm512_castsi512_ps(_mm512_set1_epi32(0x7F800000));
+  __mmask16 is_invalid = _mm512_cmp_ps_mask(x, zero, _CMP_NGE_UQ);
+  __mmask16 is_zero = _mm512_cmp_ps_mask(x, zero, _CMP_EQ_OQ);
+  __mmask16 is_inf = _mm512_cmp_ps_mask(x, inf, _CMP_EQ_OQ);
+  __mmask16 is_denormal =
+      _mm512_cmp_ps_mask(x, _mm512_set1_ps(1.17549435e-38f), _CMP_LT_OQ);
+  __m512 y = _mm512_mask_mul_ps(x, is_denormal, x,
+                                _mm512_set1_ps(8388608.0f));
+  __m512i bits = _mm512_castps_si512(y);
+  __m512i ei = _mm512_sub_epi32(_mm512_srli_epi32(bits, 23),
+                                _mm512_set1_epi32(126));
+  ei = _mm512_mask_sub_epi32(ei, is_denormal, ei, _mm512_set1_epi32(23));
+  __m512 m = _mm512_castsi512_ps(_mm512_or_si512(
+      _mm512_and_si512(bits, _mm512_set1_epi32(0x007FFFFF)),
+      _mm512_set1_epi32(0x3F000000)));
+  __m512 one = _mm512_set1_ps(1.0f);
+  __mmask16 is_small =
+      _mm512_cmp_ps_mask(m, _mm512_set1_ps(0.707106781f), _CMP_LT_OQ);
+  __m512 e = _mm512_cvtepi32_ps(ei);
+  e = _mm512_mask_sub_ps(e, is_small, e, one);
+  m = _mm512_mask_add_ps(m, is_small, m, m);
+  m = _mm512_sub_ps(m, one);
+  __m512 z = _mm512_mul_ps(m, m);
+  __m512 p = _mm512_set1_ps(7.0376836292e-2f);
+  p = _mm512_fmadd_ps(p, m, _mm512_set1_ps(-1.1514610310e-1f));
+  p = _mm512_fmadd_ps(p, m, _mm512_set1_ps(1.1676998740e-1f));
+  p = _mm512_fmadd_ps(p, m, _mm512_set1_ps(-1.2420140846e-1f));
+  p = _mm512_fmadd_ps(p, m, _mm512_set1_ps(1.4249322787e-1f));
+  p = _mm512_fmadd_ps(p, m, _mm512_set1_ps(-1.6668057665e-1f));
+  p = _mm512_fmadd_ps(p, m, _mm512_set1_ps(2.0000714765e-1f));
+  p = _mm512_fmadd_ps(p, m, _mm512_set1_ps(-2.4999993993e-1f));
+  p = _mm512_fmadd_ps(p, m, _mm512_set1_ps(3.3333331174e-1f));
+  p = _mm512_mul_ps(_mm512_mul_ps(p, m), z);
+  p = _mm512_fmadd_ps(e, _mm512_set1_ps(-2.12194440e-4f), p);
+  p = _mm512_fnmadd_ps(z, _mm512_set1_ps(0.5f), p);
+  __m512 result = _mm512_add_ps(m, p);
+  result = _mm512_fmadd_ps(e, _mm512_set1_ps(0.693359375f), result);
+  result = _mm512_mask_mov_ps(result, is_inf, inf);
+  result = _mm512_mask_mov_ps(result, is_zero, _mm512_sub_ps(zero, inf));
+  __m512 nan = _mm512_castsi512_ps(_mm512_set1_epi32(0x7FC00000));
+  return _mm512_mask_mov_ps(result, is_invalid, nan);
+}
+
+static inline __m512 iree_uk_tanh_ps_avx512_base(__m512 x) {
+  __m512i sign_mask = _mm512_set1_epi32(0x80000000);
+  __m512 abs_x = _mm512_castsi512_ps(
+      _mm512_andnot_si512(sign_mask, _mm512_castps_si512(x)));
+  __m512 z = _mm512_mul_ps(x, x);
+  __m512 p = _mm512_set1_ps(-5.70498872745e-3f);
+  p = _mm512_fmadd_ps(p, z, _mm512_set1_ps(2.06390887954e-2f));
+  p = _mm512_fmadd_ps(p, z, _mm512_set1_ps(-5.37397155531e-2f));
+  p = _mm512_fmadd_ps(p, z, _mm512_set1_ps(1.33314422036e-1f));
+  p = _mm512_fmadd_ps(p, z, _mm512_set1_ps(-3.33332819422e-1f));
+  __m512 small = _mm512_fmadd_ps(_mm512_mul_ps(p, z), x, x);
+  __m512 one = _mm512_set1_ps(1.0f);
+  __m512 e = iree_uk_exp_ps_avx512_base(_mm512_add_ps(abs_x, abs_x));
+  __m512 large = _mm512_sub_ps(
+      one, _mm512_div_ps(_mm512_set1_ps(2.0f), _mm512_add_ps(e, one)));
+  large = _mm512_castsi512_ps(_mm512_or_si512(
+      _mm512_castps_si512(large),
+      _mm512_and_si512(sign_mask, _mm512_castps_si512(x))));
+  __mmask16 is_small =
+      _mm512_cmp_ps_mask(abs_x, _mm512_set1_ps(0.625f), _CMP_LT_OQ);
+  return _mm512_mask_mov_ps(large, is_small, small);
+}
+
+//===----------------------------------------------------------------------===//
+// Per-opcode vector ops, on 16 lanes of 32 bits.
+//===----------------------------------------------------------------------===//
+
+#define IREE_UK_AVX512_FLOAT_BINARY_OP(NAME, INTRINSIC)               \
+  static inline __m512i iree_uk_avx512_##NAME(__m512i a, __m512i b) { \
+    return _mm512_castps_si512(                                       \
+        INTRINSIC(_mm512_castsi512_ps(a), _mm512_castsi512_ps(b)));   \
+  }
+#define IREE_UK_AVX512_FLOAT_UNARY_OP(NAME, EXPR)          \
+  static inline __m512i iree_uk_avx512_##NAME(__m512i a) { \
+    __m512 x = _mm512_castsi512_ps(a);                     \
+    return _mm512_castps_si512(EXPR);                      \
+  }
+
+IREE_UK_AVX512_FLOAT_BINARY_OP(addf, _mm512_add_ps)
+IREE_UK_AVX512_FLOAT_BINARY_OP(divf, _mm512_div_ps)
+IREE_UK_AVX512_FLOAT_BINARY_OP(mulf, _mm512_mul_ps)
+IREE_UK_AVX512_FLOAT_BINARY_OP(subf, _mm512_sub_ps)
+
+static inline __m512i iree_uk_avx512_addi(__m512i a, __m512i b) {
+  return _mm512_add_epi32(a, b);
+}
+static inline __m512i iree_uk_avx512_andi(__m512i a, __m512i b) {
+  return _mm512_and_si512(a, b);
+}
+static inline __m512i iree_uk_avx512_muli(__m512i a, __m512i b) {
+  return _mm512_mullo_epi32(a, b);
+}
+static inline __m512i iree_uk_avx512_ori(__m512i a, __m512i b) {
+  return _mm512_or_si512(a, b);
+}
+static inline __m512i iree_uk_avx512_shli(__m512i a, __m512i b) {
+  return _mm512_sllv_epi32(a, b);
+}
+static inline __m512i iree_uk_avx512_shrsi(__m512i a, __m512i b) {
+  return _mm512_srav_epi32(a, b);
+}
+static inline __m512i iree_uk_avx512_shrui(__m512i a, __m512i b) {
+  return _mm512_srlv_epi32(a, b);
+}
+static inline __m512i iree_uk_avx512_subi(__m512i a, __m512i b) {
+  return _mm512_sub_epi32(a, b);
+}
+static inline __m512i iree_uk_avx512_xori(__m512i a, __m512i b) {
+  return _mm512_xor_si512(a, b);
+}
+
+static inline __m512i iree_uk_avx512_absf(__m512i a) {
+  return _mm512_and_si512(a, _mm512_set1_epi32(0x7FFFFFFF));
+}
+IREE_UK_AVX512_FLOAT_UNARY_OP(ceilf,
+                              _mm512_roundscale_ps(x, _MM_FROUND_TO_POS_INF |
+                                                          _MM_FROUND_NO_EXC))
+// VPLZCNTD is part of AVX-512CD, which is included in the base feature set.
+static inline __m512i iree_uk_avx512_ctlz(__m512i a) {
+  return _mm512_lzcnt_epi32(a);
+}
+IREE_UK_AVX512_FLOAT_UNARY_OP(expf, iree_uk_exp_ps_avx512_base(x))
+IREE_UK_AVX512_FLOAT_UNARY_OP(floorf,
+                              _mm512_roundscale_ps(x, _MM_FROUND_TO_NEG_INF |
+                                                          _MM_FROUND_NO_EXC))
+IREE_UK_AVX512_FLOAT_UNARY_OP(logf, iree_uk_log_ps_avx512_base(x))
+static inline __m512i iree_uk_avx512_negf(__m512i a) {
+  return _mm512_xor_si512(a, _mm512_set1_epi32(0x80000000));
+}
+IREE_UK_AVX512_FLOAT_UNARY_OP(rsqrtf, _mm512_div_ps(_mm512_set1_ps(1.0f),
+                                                    _mm512_sqrt_ps(x)))
+IREE_UK_AVX512_FLOAT_UNARY_OP(tanhf, iree_uk_tanh_ps_avx512_base(x))
+
+//===----------------------------------------------------------------------===//
+// Row functions.
+//===----------------------------------------------------------------------===//
+
+#define IREE_UK_X32B_ROW_FUNC_AVX512_BASE(NAME)                             \
+  void iree_uk_x32b_row_##NAME##_x86_64_avx512_base(                        \
+      const iree_uk_uint32_t* lhs, const iree_uk_uint32_t* rhs,             \
+      iree_uk_uint32_t* IREE_UK_RESTRICT out, iree_uk_ssize_t size) {       \
+    iree_uk_ssize_t i = 0;                                                  \
+    for (; i + 16 <= size; i += 16) {                                       \
+      __m512i a = _mm512_loadu_si512(lhs + i);                              \
+      __m512i b = _mm512_loadu_si512(rhs + i);                              \
+      _mm512_storeu_si512(out + i, iree_uk_avx512_##NAME(a, b));            \
+    }                                                                       \
+    if (i < size) {                                                         \
+      __mmask16 mask = (__mmask16)((1u << (size - i)) - 1);                 \
+      __m512i a = _mm512_maskz_loadu_epi32(mask, lhs + i);                  \
+      __m512i b = _mm512_maskz_loadu_epi32(mask, rhs + i);                  \
+      _mm512_mask_storeu_epi32(out + i, mask, iree_uk_avx512_##NAME(a, b)); \
+    }                                                                       \
+  }
+
+#define IREE_UK_X32U_ROW_FUNC_AVX512_BASE(NAME)                           \
+  void iree_uk_x32u_row_##NAME##_x86_64_avx512_base(                      \
+      const iree_uk_uint32_t* in, iree_uk_uint32_t* IREE_UK_RESTRICT out, \
+      iree_uk_ssize_t size) {                                             \
+    iree_uk_ssize_t i = 0;                                                \
+    for (; i + 16 <= size; i += 16) {                                     \
+      __m512i a = _mm512_loadu_si512(in + i);                             \
+      _mm512_storeu_si512(out + i, iree_uk_avx512_##NAME(a));             \
+    }                                                                     \
+    if (i < size) {                                                       \
+      __mmask16 mask = (__mmask16)((1u << (size - i)) - 1);               \
+      __m512i a = _mm512_maskz_loadu_epi32(mask, in + i);                 \
+      _mm512_mask_storeu_epi32(out + i, mask, iree_uk_avx512_##NAME(a));  \
+    }                                                                     \
+  }
+
+IREE_UK_X32B_ROW_FUNC_AVX512_BASE(addf)
+IREE_UK_X32B_ROW_FUNC_AVX512_BASE(addi)
+IREE_UK_X32B_ROW_FUNC_AVX512_BASE(andi)
+IREE_UK_X32B_ROW_FUNC_AVX512_BASE(divf)
+IREE_UK_X32B_ROW_FUNC_AVX512_BASE(mulf)
+IREE_UK_X32B_ROW_FUNC_AVX512_BASE(muli)
+IREE_UK_X32B_ROW_FUNC_AVX512_BASE(ori)
+IREE_UK_X32B_ROW_FUNC_AVX512_BASE(shli)
+IREE_UK_X32B_ROW_FUNC_AVX512_BASE(shrsi)
+IREE_UK_X32B_ROW_FUNC_AVX512_BASE(shrui)
+IREE_UK_X32B_ROW_FUNC_AVX512_BASE(subf)
+IREE_UK_X32B_ROW_FUNC_AVX512_BASE(subi)
+IREE_UK_X32B_ROW_FUNC_AVX512_BASE(xori)
+
+IREE_UK_X32U_ROW_FUNC_AVX512_BASE(absf)
+IREE_UK_X32U_ROW_FUNC_AVX512_BASE(ceilf)
+IREE_UK_X32U_ROW_FUNC_AVX512_BASE(ctlz)
+IREE_UK_X32U_ROW_FUNC_AVX512_BASE(expf)
+IREE_UK_X32U_ROW_FUNC_AVX512_BASE(floorf)
+IREE_UK_X32U_ROW_FUNC_AVX512_BASE(logf)
+IREE_UK_X32U_ROW_FUNC_AVX512_BASE(negf)
+IREE_UK_X32U_ROW_FUNC_AVX512_BASE(rsqrtf)
+IREE_UK_X32U_ROW_FUNC_AVX512_BASE(tanhf)
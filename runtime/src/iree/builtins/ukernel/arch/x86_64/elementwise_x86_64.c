@@ -0,0 +1,175 @@
+// Copyright 2023 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include "iree/builtins/ukernel/arch/x86_64/elementwise_x86_64.h"
+
+#include "iree/builtins/ukernel/arch/x86_64/config.h"
+#include "iree/builtins/ukernel/arch/x86_64/elementwise_row_x86_64.h"
+#include "iree/schemas/cpu_data.h"
+
+#ifdef IREE_UK_BUILD_X86_64_AVX512_BASE
+static iree_uk_x32b_row_func_t iree_uk_x32b_select_row_func_x86_64_avx512_base(
+    iree_uk_x32b_opcode_t opcode) {
+  switch (opcode) {
+    case IREE_UK_X32B_ADDF:
+      return iree_uk_x32b_row_addf_x86_64_avx512_base;
+    case IREE_UK_X32B_ADDI:
+      return iree_uk_x32b_row_addi_x86_64_avx512_base;
+    case IREE_UK_X32B_ANDI:
+      return iree_uk_x32b_row_andi_x86_64_avx512_base;
+    case IREE_UK_X32B_DIVF:
+      return iree_uk_x32b_row_divf_x86_64_avx512_base;
+    case IREE_UK_X32B_MULF:
+      return iree_uk_x32b_row_mulf_x86_64_avx512_base;
+    case IREE_UK_X32B_MULI:
+      return iree_uk_x32b_row_muli_x86_64_avx512_base;
+    case IREE_UK_X32B_ORI:
+      return iree_uk_x32b_row_ori_x86_64_avx512_base;
+    case IREE_UK_X32B_SHLI:
+      return iree_uk_x32b_row_shli_x86_64_avx512_base;
+    case IREE_UK_X32B_SHRSI:
+      return iree_uk_x32b_row_shrsi_x86_64_avx512_base;
+    case IREE_UK_X32B_SHRUI:
+      return iree_uk_x32b_row_shrui_x86_64_avx512_base;
+    case IREE_UK_X32B_SUBF:
+      return iree_uk_x32b_row_subf_x86_64_avx512_base;
+    case IREE_UK_X32B_SUBI:
+      return iree_uk_x32b_row_subi_x86_64_avx512_base;
+    case IREE_UKENREL_X32B_XORI:
+      return iree_uk_x32b_row_xori_x86_64_avx512_base;
+    default:
+      return 0;
+  }
+}
+#endif  // IREE_UK_BUILD_X86_64_AVX512_BASE
+
+#ifdef IREE_UK_BUILD_X86_64_AVX2_FMA
+static iree_uk_x32b_row_func_t iree_uk_x32b_select_row_func_x86_64_avx2_fma(
+    iree_uk_x32b_opcode_t opcode) {
+  switch (opcode) {
+    case IREE_UK_X32B_ADDF:
+      return iree_uk_x32b_row_addf_x86_64_avx2_fma;
+    case IREE_UK_X32B_ADDI:
+      return iree_uk_x32b_row_addi_x86_64_avx2_fma;
+    case IREE_UK_X32B_ANDI:
+      return iree_uk_x32b_row_andi_x86_64_avx2_fma;
+    case IREE_UK_X32B_DIVF:
+      return iree_uk_x32b_row_divf_x86_64_avx2_fma;
+    case IREE_UK_X32B_MULF:
+      return iree_uk_x32b_row_mulf_x86_64_avx2_fma;
+    case IREE_UK_X32B_MULI:
+      return iree_uk_x32b_row_muli_x86_64_avx2_fma;
+    case IREE_UK_X32B_ORI:
+      return iree_uk_x32b_row_ori_x86_64_avx2_fma;
+    case IREE_UK_X32B_SHLI:
+      return iree_uk_x32b_row_shli_x86_64_avx2_fma;
+    case IREE_UK_X32B_SHRSI:
+      return iree_uk_x32b_row_shrsi_x86_64_avx2_fma;
+    case IREE_UK_X32B_SHRUI:
+      return iree_uk_x32b_row_shrui_x86_64_avx2_fma;
+    case IREE_UK_X32B_SUBF:
+      return iree_uk_x32b_row_subf_x86_64_avx2_fma;
+    case IREE_UK_X32B_SUBI:
+      return iree_uk_x32b_row_subi_x86_64_avx2_fma;
+    case IREE_UKENREL_X32B_XORI:
+      return iree_uk_x32b_row_xori_x86_64_avx2_fma;
+    default:
+      return 0;
+  }
+}
+#endif  // IREE_UK_BUILD_X86_64_AVX2_FMA
+
+iree_uk_x32b_row_func_t iree_uk_x32b_select_row_func_x86_64(
+    iree_uk_x32b_opcode_t opcode, const iree_uk_uint64_t* cpu_data) {
+  iree_uk_x32b_row_func_t row_func = 0;
+#ifdef IREE_UK_BUILD_X86_64_AVX512_BASE
+  if (cpu_data[0] & IREE_CPU_DATA_FIELD_0_X86_64_HAVE_AVX512_BASE) {
+    row_func = iree_uk_x32b_select_row_func_x86_64_avx512_base(opcode);
+    if (row_func) return row_func;
+  }
+#endif
+#ifdef IREE_UK_BUILD_X86_64_AVX2_FMA
+  if (cpu_data[0] & IREE_CPU_DATA_FIELD_0_X86_64_HAVE_AVX2_FMA) {
+    row_func = iree_uk_x32b_select_row_func_x86_64_avx2_fma(opcode);
+  }
+#endif
+  (void)opcode;
+  (void)cpu_data;
+  return row_func;
+}
+
+#ifdef IREE_UK_BUILD_X86_64_AVX512_BASE
+static iree_uk_x32u_row_func_t iree_uk_x32u_select_row_func_x86_64_avx512_base(
+    iree_uk_x32u_opcode_t opcode) {
+  switch (opcode) {
+    case IREE_UK_X32U_ABSF:
+      return iree_uk_x32u_row_absf_x86_64_avx512_base;
+    case IREE_UK_X32U_CEILF:
+      return iree_uk_x32u_row_ceilf_x86_64_avx512_base;
+    case IREE_UK_X32U_CTLZ:
+      return iree_uk_x32u_row_ctlz_x86_64_avx512_base;
+    case IREE_UK_X32U_EXPF:
+      return iree_uk_x32u_row_expf_x86_64_avx512_base;
+    case IREE_UK_X32U_FLOORF:
+      return iree_uk_x32u_row_floorf_x86_64_avx512_base;
+    case IREE_UK_X32U_LOGF:
+      return iree_uk_x32u_row_logf_x86_64_avx512_base;
+    case IREE_UK_X32U_NEGF:
+      return iree_uk_x32u_row_negf_x86_64_avx512_base;
+    case IREE_UK_X32U_RSQRTF:
+      return iree_uk_x32u_row_rsqrtf_x86_64_avx512_base;
+    case IREE_UK_X32U_TANHF:
+      return iree_uk_x32u_row_tanhf_x86_64_avx512_base;
+    default:
+      return 0;
+  }
+}
+#endif  // IREE_UK_BUILD_X86_64_AVX512_BASE
+
+#ifdef IREE_UK_BUILD_X86_64_AVX2_FMA
+static iree_uk_x32u_row_func_t iree_uk_x32u_select_row_func_x86_64_avx2_fma(
+    iree_uk_x32u_opcode_t opcode) {
+  switch (opcode) {
+    case IREE_UK_X32U_ABSF:
+      return iree_uk_x32u_row_absf_x86_64_avx2_fma;
+    case IREE_UK_X32U_CEILF:
+      return iree_uk_x32u_row_ceilf_x86_64_avx2_fma;
+    case IREE_UK_X32U_EXPF:
+      return iree_uk_x32u_row_expf_x86_64_avx2_fma;
+    case IREE_UK_X32U_FLOORF:
+      return iree_uk_x32u_row_floorf_x86_64_avx2_fma;
+    case IREE_UK_X32U_LOGF:
+      return iree_uk_x32u_row_logf_x86_64_avx2_fma;
+    case IREE_UK_X32U_NEGF:
+      return iree_uk_x32u_row_negf_x86_64_avx2_fma;
+    case IREE_UK_X32U_RSQRTF:
+      return iree_uk_x32u_row_rsqrtf_x86_64_avx2_fma;
+    case IREE_UK_X32U_TANHF:
+      return iree_uk_x32u_row_tanhf_x86_64_avx2_fma;
+    default:
+      return 0;
+  }
+}
+#endif  // IREE_UK_BUILD_X86_64_AVX2_FMA
+
+iree_uk_x32u_row_func_t iree_uk_x32u_select_row_func_x86_64(
+    iree_uk_x32u_opcode_t opcode, const iree_uk_uint64_t* cpu_data) {
+  iree_uk_x32u_row_func_t row_func = 0;
+#ifdef IREE_UK_BUILD_X86_64_AVX512_BASE
+  if (cpu_data[0] & IREE_CPU_DATA_FIELD_0_X86_64_HAVE_AVX512_BASE) {
+    row_func = iree_uk_x32u_select_row_func_x86_64_avx512_base(opcode);
+    if (row_func) return row_func;
+  }
+#endif
+#ifdef IREE_UK_BUILD_X86_64_AVX2_FMA
+  if (cpu_data[0] & IREE_CPU_DATA_FIELD_0_X86_64_HAVE_AVX2_FMA) {
+    row_func = iree_uk_x32u_select_row_func_x86_64_avx2_fma(opcode);
+  }
+#endif
+  (void)opcode;
+  (void)cpu_data;
+  return row_func;
+}
@@ -0,0 +1,120 @@
+// Copyright 2023 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include <immintrin.h>
+
+#include "iree/builtins/ukernel/arch/x86_64/mmt4d_tile_x86_64.h"
+
+// f32*f32->f32 8x8x1 tile: each accumulator register holds one row of the
+// output tile and each step of the K loop broadcasts one LHS element per row
+// against the 8 RHS elements of the current column panel slice.
+void iree_uk_mmt4d_tile_f32f32f32_8x8x1_x86_64_avx2_fma(
+    void* out_tile_untyped, const void* lhs_panel_untyped,
+    const void* rhs_panel_untyped, iree_uk_int32_t K, iree_uk_uint32_t flags,
+    const iree_uk_mmt4d_params_t* params) {
+  float* IREE_UK_RESTRICT out_tile = out_tile_untyped;
+  const float* IREE_UK_RESTRICT lhs_panel = lhs_panel_untyped;
+  const float* IREE_UK_RESTRICT rhs_panel = rhs_panel_untyped;
+  __m256 acc[8];
+  if (flags & IREE_UK_FLAG_ACCUMULATE) {
+    for (int i = 0; i < 8; ++i) acc[i] = _mm256_loadu_ps(out_tile + i * 8);
+  } else {
+    for (int i = 0; i < 8; ++i) acc[i] = _mm256_setzero_ps();
+  }
+  for (iree_uk_int32_t k = 0; k < K; ++k) {
+    __m256 rhs = _mm256_loadu_ps(rhs_panel);
+    rhs_panel += 8;
+    for (int i = 0; i < 8; ++i) {
+      acc[i] = _mm256_fmadd_ps(_mm256_broadcast_ss(lhs_panel + i), rhs, acc[i]);
+    }
+    lhs_panel += 8;
+  }
+  for (int i = 0; i < 8; ++i) _mm256_storeu_ps(out_tile + i * 8, acc[i]);
+}
+
+// i8*i8->i32 8x8x2 tile: the int8 values are sign-extended to int16 and each
+// pair of K0 values is multiplied and summed into int32 lanes with VPMADDWD.
+// The int16 products of int8 values cannot overflow int32 when summed in pairs.
+void iree_uk_mmt4d_tile_i8i8i32_8x8x2_x86_64_avx2_fma(
+    void* out_tile_untyped, const void* lhs_panel_untyped,
+    const void* rhs_panel_untyped, iree_uk_int32_t K, iree_uk_uint32_t flags,
+    const iree_uk_mmt4d_params_t* params) {
+  iree_uk_int32_t* IREE_UK_RESTRICT out_tile = out_tile_untyped;
+  const iree_uk_int8_t* IREE_UK_RESTRICT lhs_panel = lhs_panel_untyped;
+  const iree_uk_int8_t* IREE_UK_RESTRICT rhs_panel = rhs_panel_untyped;
+  __m256i acc[8];
+  if (flags & IREE_UK_FLAG_ACCUMULATE) {
+    for (int i = 0; i < 8; ++i) {
+      acc[i] = _mm256_loadu_si256((const __m256i*)(out_tile + i * 8));
+    }
+  } else {
+    for (int i = 0; i < 8; ++i) acc[i] = _mm256_setzero_si256();
+  }
+  for (iree_uk_int32_t k = 0; k < K; ++k) {
+    // 8 columns x 2 values as 16 int16 lanes: [c0k0 c0k1 c1k0 c1k1 ...].
+    __m256i rhs = _mm256_cvtepi8_epi16(
+        _mm_loadu_si128((const __m128i*)rhs_panel));
+    rhs_panel += 16;
+    // 8 rows x 2 values; each row's pair of int16 values is one int32 lane
+    // that gets broadcast to all lanes. Rows 0-3 come from the low 128 bits
+    // and rows 4-7 from the high 128 bits.
+    __m256i lhs = _mm256_cvtepi8_epi16(
+        _mm_loadu_si128((const __m128i*)lhs_panel));
+    lhs_panel += 16;
+    __m256i lhs_lo = _mm256_permute2x128_si256(lhs, lhs, 0x00);
+    __m256i lhs_hi = _mm256_permute2x128_si256(lhs, lhs, 0x11);
+#define IREE_UK_MMT4D_ACCUMULATE_ROW(i, src, imm)                     \
+  acc[i] = _mm256_add_epi32(                                          \
+      acc[i], _mm256_madd_epi16(_mm256_shuffle_epi32(src, imm), rhs))
+    IREE_UK_MMT4D_ACCUMULATE_ROW(0, lhs_lo, 0x00);
+    IREE_UK_MMT4D_ACCUMULATE_ROW(1, lhs_lo, 0x55);
+    IREE_UK_MMT4D_ACCUMULATE_ROW(2, lhs_lo, 0xAA);
+    IREE_UK_MMT4D_ACCUMULATE_ROW(3, lhs_lo, 0xFF);
+    IREE_UK_MMT4D_ACCUMULATE_ROW(4, lhs_hi, 0x00);
+    IREE_UK_MMT4D_ACCUMULATE_ROW(5, lhs_hi, 0x55);
+    IREE_UK_MMT4D_ACCUMULATE_ROW(6, lhs_hi, 0xAA);
+    IREE_UK_MMT4D_ACCUMULATE_ROW(7, lhs_hi, 0xFF);
+#undef IREE_UK_MMT4D_ACCUMULATE_ROW
+  }
+  for (int i = 0; i < 8; ++i) {
+    _mm256_storeu_si256((__m256i*)(out_tile + i * 8), acc[i]);
+  }
+}
+
+// f32*i4->f32 8x8x1 tile, computing the unscaled product: the caller applies
+// the per-group scales. The 8 int4 RHS values of each step of the K loop are
+// one 32-bit word, broadcast to all lanes and shifted so that lane n holds
+// nibble n in its top bits, from where an arithmetic shift sign-extends it.
+// Reading 4 bytes per step instead of 32 is the point of this type when
+// memory bandwidth bound.
+void iree_uk_mmt4d_tile_f32i4f32_8x8x1_x86_64_avx2_fma(
+    void* out_tile_untyped, const void* lhs_panel_untyped,
+    const void* rhs_panel_untyped, iree_uk_int32_t K, iree_uk_uint32_t flags,
+    const iree_uk_mmt4d_params_t* params) {
+  float* IREE_UK_RESTRICT out_tile = out_tile_untyped;
+  const float* IREE_UK_RESTRICT lhs_panel = lhs_panel_untyped;
+  const iree_uk_uint8_t* IREE_UK_RESTRICT rhs_panel = rhs_panel_untyped;
+  __m256 acc[8];
+  if (flags & IREE_UK_FLAG_ACCUMULATE) {
+    for (int i = 0; i < 8; ++i) acc[i] = _mm256_loadu_ps(out_tile + i * 8);
+  } else {
+    for (int i = 0; i < 8; ++i) acc[i] = _mm256_setzero_ps();
+  }
+  const __m256i shifts = _mm256_setr_epi32(28, 24, 20, 16, 12, 8, 4, 0);
+  for (iree_uk_int32_t k = 0; k < K; ++k) {
+    iree_uk_int32_t rhs_word;
+    iree_uk_memcpy(&rhs_word, rhs_panel, sizeof rhs_word);
+    rhs_panel += 4;
+    __m256i rhs_i32 = _mm256_srai_epi32(
+        _mm256_sllv_epi32(_mm256_set1_epi32(rhs_word), shifts), 28);
+    __m256 rhs = _mm256_cvtepi32_ps(rhs_i32);
+    for (int i = 0; i < 8; ++i) {
+      acc[i] = _mm256_fmadd_ps(_mm256_broadcast_ss(lhs_panel + i), rhs, acc[i]);
+    }
+    lhs_panel += 8;
+  }
+  for (int i = 0; i < 8; ++i) _mm256_storeu_ps(out_tile + i * 8, acc[i]);
+}
@@ -0,0 +1,162 @@
+// Copyright 2023 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include <immintrin.h>
+
+#include "iree/builtins/ukernel/arch/x86_64/mmt4d_tile_x86_64.h"
+
+// f32*f32->f32 16x16x1 tile: same structure as the AVX2 8x8x1 tile with one
+// 512-bit accumulator per row, using 16 of the 32 ZMM registers.
+void iree_uk_mmt4d_tile_f32f32f32_16x16x1_x86_64_avx512_base(
+    void* out_tile_untyped, const void* lhs_panel_untyped,
+    const void* rhs_panel_untyped, iree_uk_int32_t K, iree_uk_uint32_t flags,
+    const iree_uk_mmt4d_params_t* params) {
+  float* IREE_UK_RESTRICT out_tile = out_tile_untyped;
+  const float* IREE_UK_RESTRICT lhs_panel = lhs_panel_untyped;
+  const float* IREE_UK_RESTRICT rhs_panel = rhs_panel_untyped;
+  __m512 acc[16];
+  if (flags & IREE_UK_FLAG_ACCUMULATE) {
+    for (int i = 0; i < 16; ++i) acc[i] = _mm512_loadu_ps(out_tile + i * 16);
+  } else {
+    for (int i = 0; i < 16; ++i) acc[i] = _mm512_setzero_ps();
+  }
+  for (iree_uk_int32_t k = 0; k < K; ++k) {
+    __m512 rhs = _mm512_loadu_ps(rhs_panel);
+    rhs_panel += 16;
+    for (int i = 0; i < 16; ++i) {
+      acc[i] = _mm512_fmadd_ps(_mm512_set1_ps(lhs_panel[i]), rhs, acc[i]);
+    }
+    lhs_panel += 16;
+  }
+  for (int i = 0; i < 16; ++i) _mm512_storeu_ps(out_tile + i * 16, acc[i]);
+}
+
+// i8*i8->i32 16x16x2 tile for AVX-512 parts without VNNI: sign-extends to
+// int16 and uses VPMADDWD + VPADDD. See the VNNI variant for the fused form.
+void iree_uk_mmt4d_tile_i8i8i32_16x16x2_x86_64_avx512_base(
+    void* out_tile_untyped, const void* lhs_panel_untyped,
+    const void* rhs_panel_untyped, iree_uk_int32_t K, iree_uk_uint32_t flags,
+    const iree_uk_mmt4d_params_t* params) {
+  iree_uk_int32_t* IREE_UK_RESTRICT out_tile = out_tile_untyped;
+  const iree_uk_int8_t* IREE_UK_RESTRICT lhs_panel = lhs_panel_untyped;
+  const iree_uk_int8_t* IREE_UK_RESTRICT rhs_panel = rhs_panel_untyped;
+  __m512i acc[16];
+  if (flags & IREE_UK_FLAG_ACCUMULATE) {
+    for (int i = 0; i < 16; ++i) {
+      acc[i] = _mm512_loadu_si512(out_tile + i * 16);
+    }
+  } else {
+    for (int i = 0; i < 16; ++i) acc[i] = _mm512_setzero_si512();
+  }
+  for (iree_uk_int32_t k = 0; k < K; ++k) {
+    // 16 columns x 2 values as 32 int16 lanes.
+    __m512i rhs = _mm512_cvtepi8_epi16(
+        _mm256_loadu_si256((const __m256i*)rhs_panel));
+    rhs_panel += 32;
+    // 16 rows x 2 values; int32 lane i holds the int16 pair of row i.
+    __m512i lhs = _mm512_cvtepi8_epi16(
+        _mm256_loadu_si256((const __m256i*)lhs_panel));
+    lhs_panel += 32;
+    for (int i = 0; i < 16; ++i) {
+      __m512i lhs_row = _mm512_permutexvar_epi32(_mm512_set1_epi32(i), lhs);
+      acc[i] = _mm512_add_epi32(acc[i], _mm512_madd_epi16(lhs_row, rhs));
+    }
+  }
+  for (int i = 0; i < 16; ++i) _mm512_storeu_si512(out_tile + i * 16, acc[i]);
+}
+
+// Shared implementation of the 16x16x1 tiles taking f16 inputs. Inputs are
+// widened with VCVTPH2PS and accumulated in f32. An f16 output tile is widened
+// on load and rounded to nearest-even once on store.
+static inline void iree_uk_mmt4d_tile_f16f16fXX_16x16x1_x86_64_avx512_base(
+    void* IREE_UK_RESTRICT out_tile, const void* IREE_UK_RESTRICT lhs_panel,
+    const void* IREE_UK_RESTRICT rhs_panel, iree_uk_int32_t K,
+    iree_uk_uint32_t flags, bool out_f16) {
+  float* out_f32_ptr = out_tile;
+  iree_uk_uint16_t* out_f16_ptr = out_tile;
+  const iree_uk_uint16_t* IREE_UK_RESTRICT lhs_ptr = lhs_panel;
+  const iree_uk_uint16_t* IREE_UK_RESTRICT rhs_ptr = rhs_panel;
+  __m512 acc[16];
+  if (flags & IREE_UK_FLAG_ACCUMULATE) {
+    for (int i = 0; i < 16; ++i) {
+      acc[i] = out_f16 ? _mm512_cvtph_ps(_mm256_loadu_si256(
+                             (const __m256i*)(out_f16_ptr + i * 16)))
+                       : _mm512_loadu_ps(out_f32_ptr + i * 16);
+    }
+  } else {
+    for (int i = 0; i < 16; ++i) acc[i] = _mm512_setzero_ps();
+  }
+  for (iree_uk_int32_t k = 0; k < K; ++k) {
+    __m512 rhs = _mm512_cvtph_ps(_mm256_loadu_si256((const __m256i*)rhs_ptr));
+    rhs_ptr += 16;
+    __m512 lhs = _mm512_cvtph_ps(_mm256_loadu_si256((const __m256i*)lhs_ptr));
+    lhs_ptr += 16;
+    for (int i = 0; i < 16; ++i) {
+      __m512 lhs_row = _mm512_permutexvar_ps(_mm512_set1_epi32(i), lhs);
+      acc[i] = _mm512_fmadd_ps(lhs_row, rhs, acc[i]);
+    }
+  }
+  for (int i = 0; i < 16; ++i) {
+    if (out_f16) {
+      __m256i acc_f16 = _mm512_cvtps_ph(
+          acc[i], _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC);
+      _mm256_storeu_si256((__m256i*)(out_f16_ptr + i * 16), acc_f16);
+    } else {
+      _mm512_storeu_ps(out_f32_ptr + i * 16, acc[i]);
+    }
+  }
+}
+
+void iree_uk_mmt4d_tile_f16f16f32_16x16x1_x86_64_avx512_base(
+    void* out_tile, const void* lhs_panel, const void* rhs_panel,
+    iree_uk_int32_t K, iree_uk_uint32_t flags,
+    const iree_uk_mmt4d_params_t* params) {
+  iree_uk_mmt4d_tile_f16f16fXX_16x16x1_x86_64_avx512_base(
+      out_tile, lhs_panel, rhs_panel, K, flags, /*out_f16=*/false);
+}
+
+void iree_uk_mmt4d_tile_f16f16f16_16x16x1_x86_64_avx512_base(
+    void* out_tile, const void* lhs_panel, const void* rhs_panel,
+    iree_uk_int32_t K, iree_uk_uint32_t flags,
+    const iree_uk_mmt4d_params_t* params) {
+  iree_uk_mmt4d_tile_f16f16fXX_16x16x1_x86_64_avx512_base(
+      out_tile, lhs_panel, rhs_panel, K, flags, /*out_f16=*/true);
+}
+
+// bf16*bf16->f32 16x16x2 tile for AVX-512 parts without AVX512-BF16. Each
+// int32 lane holds a (k0, k1) pair of bf16 values; shifting or masking the
+// lane yields the f32 value of either half exactly.
+void iree_uk_mmt4d_tile_bf16bf16f32_16x16x2_x86_64_avx512_base(
+    void* out_tile_untyped, const void* lhs_panel_untyped,
+    const void* rhs_panel_untyped, iree_uk_int32_t K, iree_uk_uint32_t flags,
+    const iree_uk_mmt4d_params_t* params) {
+  float* IREE_UK_RESTRICT out_tile = out_tile_untyped;
+  const iree_uk_uint16_t* IREE_UK_RESTRICT lhs_panel = lhs_panel_untyped;
+  const iree_uk_uint16_t* IREE_UK_RESTRICT rhs_panel = rhs_panel_untyped;
+  __m512 acc[16];
+  if (flags & IREE_UK_FLAG_ACCUMULATE) {
+    for (int i = 0; i < 16; ++i) acc[i] = _mm512_loadu_ps(out_tile + i * 16);
+  } else {
+    for (int i = 0; i < 16; ++i) acc[i] = _mm512_setzero_ps();
+  }
+  const __m512i high_mask = _mm512_set1_epi32(0xFFFF0000u);
+  for (iree_uk_int32_t k = 0; k < K; ++k) {
+    __m512i rhs = _mm512_loadu_si512(rhs_panel);
+    rhs_panel += 32;
+    __m512 rhs_k0 = _mm512_castsi512_ps(_mm512_slli_epi32(rhs, 16));
+    __m512 rhs_k1 = _mm512_castsi512_ps(_mm512_and_si512(rhs, high_mask));
+    __m512i lhs = _mm512_loadu_si512(lhs_panel);
+    lhs_panel += 32;
+    for (int i = 0; i < 16; ++i) {
+      __m512i lhs_row = _mm512_permutexvar_epi32(_mm512_set1_epi32(i), lhs);
+      __m512 lhs_k0 = _mm512_castsi512_ps(_mm512_slli_epi32(lhs_row, 16));
+      __m512 lhs_k1 = _mm512_castsi512_ps(_mm512_and_si512(lhs_row, high_mask));
+      acc[i] = _mm512_fmadd_ps(lhs_k0, rhs_k0, acc[i]);
+      acc[i] = _mm512_fmadd_ps(lhs_k1, rhs_k1, acc[i]);
+    }
+  }
+  for (int i = 0; i < 16; ++i) _mm512_storeu_ps(out_tile + i * 16, acc[i]);
+}
@@ -0,0 +1,39 @@
+// Copyright 2023 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include <immintrin.h>
+
+#include "iree/builtins/ukernel/arch/x86_64/mmt4d_tile_x86_64.h"
+
+// bf16*bf16->f32 16x16x2 tile using VDPBF16PS, which multiplies the (k0, k1)
+// bf16 pairs in each int32 lane and adds both products into the f32
+// accumulator lane.
+void iree_uk_mmt4d_tile_bf16bf16f32_16x16x2_x86_64_avx512_bf16(
+    void* out_tile_untyped, const void* lhs_panel_untyped,
+    const void* rhs_panel_untyped, iree_uk_int32_t K, iree_uk_uint32_t flags,
+    const iree_uk_mmt4d_params_t* params) {
+  float* IREE_UK_RESTRICT out_tile = out_tile_untyped;
+  const iree_uk_uint16_t* IREE_UK_RESTRICT lhs_panel = lhs_panel_untyped;
+  const iree_uk_uint16_t* IREE_UK_RESTRICT rhs_panel = rhs_panel_untyped;
+  __m512 acc[16];
+  if (flags & IREE_UK_FLAG_ACCUMULATE) {
+    for (int i = 0; i < 16; ++i) acc[i] = _mm512_loadu_ps(out_tile + i * 16);
+  } else {
+    for (int i = 0; i < 16; ++i) acc[i] = _mm512_setzero_ps();
+  }
+  for (iree_uk_int32_t k = 0; k < K; ++k) {
+    __m512bh rhs = (__m512bh)_mm512_loadu_si512(rhs_panel);
+    rhs_panel += 32;
+    __m512i lhs = _mm512_loadu_si512(lhs_panel);
+    lhs_panel += 32;
+    for (int i = 0; i < 16; ++i) {
+      __m512bh lhs_row =
+          (__m512bh)_mm512_permutexvar_epi32(_mm512_set1_epi32(i), lhs);
+      acc[i] = _mm512_dpbf16_ps(acc[i], lhs_row, rhs);
+    }
+  }
+  for (int i = 0; i < 16; ++i) _mm512_storeu_ps(out_tile + i * 16, acc[i]);
+}
@@ -0,0 +1,43 @@
+// Copyright 2023 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include <immintrin.h>
+
+#include "iree/builtins/ukernel/arch/x86_64/mmt4d_tile_x86_64.h"
+
+// i8*i8->i32 16x16x2 tile using VPDPWSSD, which fuses the int16 pairwise
+// multiply-add with the int32 accumulation. VPDPBUSD would process 4 values
+// per lane but requires one unsigned operand, which our signed i8 inputs
+// don't satisfy without an extra correction term.
+void iree_uk_mmt4d_tile_i8i8i32_16x16x2_x86_64_avx512_vnni(
+    void* out_tile_untyped, const void* lhs_panel_untyped,
+    const void* rhs_panel_untyped, iree_uk_int32_t K, iree_uk_uint32_t flags,
+    const iree_uk_mmt4d_params_t* params) {
+  iree_uk_int32_t* IREE_UK_RESTRICT out_tile = out_tile_untyped;
+  const iree_uk_int8_t* IREE_UK_RESTRICT lhs_panel = lhs_panel_untyped;
+  const iree_uk_int8_t* IREE_UK_RESTRICT rhs_panel = rhs_panel_untyped;
+  __m512i acc[16];
+  if (flags & IREE_UK_FLAG_ACCUMULATE) {
+    for (int i = 0; i < 16; ++i) {
+      acc[i] = _mm512_loadu_si512(out_tile + i * 16);
+    }
+  } else {
+    for (int i = 0; i < 16; ++i) acc[i] = _mm512_setzero_si512();
+  }
+  for (iree_uk_int32_t k = 0; k < K; ++k) {
+    __m512i rhs = _mm512_cvtepi8_epi16(
+        _mm256_loadu_si256((const __m256i*)rhs_panel));
+    rhs_panel += 32;
+    __m512i lhs = _mm512_cvtepi8_epi16(
+        _mm256_loadu_si256((const __m256i*)lhs_panel));
+    lhs_panel += 32;
+    for (int i = 0; i < 16; ++i) {
+      __m512i lhs_row = _mm512_permutexvar_epi32(_mm512_set1_epi32(i), lhs);
+      acc[i] = _mm512_dpwssd_epi32(acc[i], lhs_row, rhs);
+    }
+  }
+  for (int i = 0; i < 16; ++i) _mm512_storeu_si512(out_tile + i * 16, acc[i]);
+}
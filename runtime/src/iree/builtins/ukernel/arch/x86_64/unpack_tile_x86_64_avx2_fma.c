@@ -0,0 +1,64 @@
+// Copyright 2023 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include <immintrin.h>
+
+#include "iree/builtins/ukernel/arch/x86_64/unpack_tile_x86_64.h"
+
+void iree_uk_unpack_tile_8x8_x32_x86_64_avx2_fma_direct(
+    void* IREE_UK_RESTRICT out_tile_ptr,
+    const void* IREE_UK_RESTRICT in_tile_ptr, iree_uk_ssize_t outer_size1,
+    iree_uk_ssize_t out_stride0, iree_uk_ssize_t in_stride1,
+    iree_uk_ssize_t elem_size_unused, iree_uk_ssize_t tile_size0_unused,
+    iree_uk_ssize_t tile_size1_unused) {
+  const iree_uk_int32_t* IREE_UK_RESTRICT in_ptr = in_tile_ptr;
+  iree_uk_int32_t* IREE_UK_RESTRICT out_ptr = out_tile_ptr;
+  for (iree_uk_ssize_t outer_i1 = 0; outer_i1 < outer_size1; ++outer_i1) {
+    for (int i = 0; i < 8; ++i) {
+      _mm256_storeu_si256((__m256i*)(out_ptr + i * out_stride0),
+                          _mm256_loadu_si256((const __m256i*)(in_ptr + 8 * i)));
+    }
+    out_ptr += 8;
+    in_ptr += in_stride1;
+  }
+}
+
+// The input tile is column-major with respect to the output: each of its 8
+// rows becomes a column of the output. This is the usual unpack/shuffle/
+// permute 8x8 transpose, done on ps registers since only bits are moved.
+void iree_uk_unpack_tile_8x8_x32_x86_64_avx2_fma_transpose(
+    void* IREE_UK_RESTRICT out_tile_ptr,
+    const void* IREE_UK_RESTRICT in_tile_ptr, iree_uk_ssize_t outer_size1,
+    iree_uk_ssize_t out_stride0, iree_uk_ssize_t in_stride1,
+    iree_uk_ssize_t elem_size_unused, iree_uk_ssize_t tile_size0_unused,
+    iree_uk_ssize_t tile_size1_unused) {
+  const float* IREE_UK_RESTRICT in_ptr = in_tile_ptr;
+  float* IREE_UK_RESTRICT out_ptr = out_tile_ptr;
+  for (iree_uk_ssize_t outer_i1 = 0; outer_i1 < outer_size1; ++outer_i1) {
+    __m256 r[8], t[8], s[8];
+    for (int i = 0; i < 8; ++i) {
+      r[i] = _mm256_loadu_ps(in_ptr + 8 * i);
+    }
+    for (int i = 0; i < 8; i += 2) {
+      t[i + 0] = _mm256_unpacklo_ps(r[i], r[i + 1]);
+      t[i + 1] = _mm256_unpackhi_ps(r[i], r[i + 1]);
+    }
+    for (int i = 0; i < 8; i += 4) {
+      s[i + 0] = _mm256_shuffle_ps(t[i + 0], t[i + 2], 0x44);
+      s[i + 1] = _mm256_shuffle_ps(t[i + 0], t[i + 2], 0xEE);
+      s[i + 2] = _mm256_shuffle_ps(t[i + 1], t[i + 3], 0x44);
+      s[i + 3] = _mm256_shuffle_ps(t[i + 1], t[i + 3], 0xEE);
+    }
+    for (int i = 0; i < 4; ++i) {
+      _mm256_storeu_ps(out_ptr + i * out_stride0,
+                       _mm256_permute2f128_ps(s[i], s[i + 4], 0x20));
+      _mm256_storeu_ps(out_ptr + (i + 4) * out_stride0,
+                       _mm256_permute2f128_ps(s[i], s[i + 4], 0x31));
+    }
+    out_ptr += 8;
+    in_ptr += in_stride1;
+  }
+}
@@ -0,0 +1,76 @@
+// Copyright 2023 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include <immintrin.h>
+
+#include "iree/builtins/ukernel/arch/x86_64/unpack_tile_x86_64.h"
+
+void iree_uk_unpack_tile_16x16_x32_x86_64_avx512_base_direct(
+    void* IREE_UK_RESTRICT out_tile_ptr,
+    const void* IREE_UK_RESTRICT in_tile_ptr, iree_uk_ssize_t outer_size1,
+    iree_uk_ssize_t out_stride0, iree_uk_ssize_t in_stride1,
+    iree_uk_ssize_t elem_size_unused, iree_uk_ssize_t tile_size0_unused,
+    iree_uk_ssize_t tile_size1_unused) {
+  const iree_uk_int32_t* IREE_UK_RESTRICT in_ptr = in_tile_ptr;
+  iree_uk_int32_t* IREE_UK_RESTRICT out_ptr = out_tile_ptr;
+  for (iree_uk_ssize_t outer_i1 = 0; outer_i1 < outer_size1; ++outer_i1) {
+    for (int i = 0; i < 16; ++i) {
+      _mm512_storeu_si512(out_ptr + i * out_stride0,
+                          _mm512_loadu_si512(in_ptr + 16 * i));
+    }
+    out_ptr += 16;
+    in_ptr += in_stride1;
+  }
+}
+
+// The input tile is column-major with respect to the output: each of its 16
+// rows becomes a column of the output. 16x16 transpose in three stages:
+// interleaving 32-bit then 64-bit elements transposes each 4x4 block within
+// 128-bit lanes, then two rounds of 128-bit lane shuffles put the 4x4 blocks
+// in place.
+void iree_uk_unpack_tile_16x16_x32_x86_64_avx512_base_transpose(
+    void* IREE_UK_RESTRICT out_tile_ptr,
+    const void* IREE_UK_RESTRICT in_tile_ptr, iree_uk_ssize_t outer_size1,
+    iree_uk_ssize_t out_stride0, iree_uk_ssize_t in_stride1,
+    iree_uk_ssize_t elem_size_unused, iree_uk_ssize_t tile_size0_unused,
+    iree_uk_ssize_t tile_size1_unused) {
+  const iree_uk_int32_t* IREE_UK_RESTRICT in_ptr = in_tile_ptr;
+  iree_uk_int32_t* IREE_UK_RESTRICT out_ptr = out_tile_ptr;
+  for (iree_uk_ssize_t outer_i1 = 0; outer_i1 < outer_size1; ++outer_i1) {
+    __m512i r[16], t[16], u[16];
+    for (int i = 0; i < 16; ++i) {
+      r[i] = _mm512_loadu_si512(in_ptr + 16 * i);
+    }
+    for (int i = 0; i < 16; i += 2) {
+      t[i + 0] = _mm512_unpacklo_epi32(r[i], r[i + 1]);
+      t[i + 1] = _mm512_unpackhi_epi32(r[i], r[i + 1]);
+    }
+    // Lane k of u[4 * j + c] now holds column 4 * k + c of rows 4 * j to
+    // 4 * j + 3.
+    for (int i = 0; i < 16; i += 4) {
+      u[i + 0] = _mm512_unpacklo_epi64(t[i + 0], t[i + 2]);
+      u[i + 1] = _mm512_unpackhi_epi64(t[i + 0], t[i + 2]);
+      u[i + 2] = _mm512_unpacklo_epi64(t[i + 1], t[i + 3]);
+      u[i + 3] = _mm512_unpackhi_epi64(t[i + 1], t[i + 3]);
+    }
+    for (int c = 0; c < 4; ++c) {
+      __m512i ab_lo = _mm512_shuffle_i32x4(u[c], u[4 + c], 0x44);
+      __m512i ab_hi = _mm512_shuffle_i32x4(u[c], u[4 + c], 0xEE);
+      __m512i cd_lo = _mm512_shuffle_i32x4(u[8 + c], u[12 + c], 0x44);
+      __m512i cd_hi = _mm512_shuffle_i32x4(u[8 + c], u[12 + c], 0xEE);
+      _mm512_storeu_si512(out_ptr + (0 + c) * out_stride0,
+                          _mm512_shuffle_i32x4(ab_lo, cd_lo, 0x88));
+      _mm512_storeu_si512(out_ptr + (4 + c) * out_stride0,
+                          _mm512_shuffle_i32x4(ab_lo, cd_lo, 0xDD));
+      _mm512_storeu_si512(out_ptr + (8 + c) * out_stride0,
+                          _mm512_shuffle_i32x4(ab_hi, cd_hi, 0x88));
+      _mm512_storeu_si512(out_ptr + (12 + c) * out_stride0,
+                          _mm512_shuffle_i32x4(ab_hi, cd_hi, 0xDD));
+    }
+    out_ptr += 16;
+    in_ptr += in_stride1;
+  }
+}
@@ -0,0 +1,57 @@
+// Copyright 2023 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include "iree/builtins/ukernel/arch/x86_64/unpack_x86_64.h"
+
+#include "iree/builtins/ukernel/arch/x86_64/config.h"
+#include "iree/builtins/ukernel/arch/x86_64/unpack_tile_x86_64.h"
+#include "iree/schemas/cpu_data.h"
+
+static iree_uk_unpack_tile_func_t
+iree_uk_unpack_select_tile_func_x86_64_8x8_x32(
+    const iree_uk_unpack_params_t* params, bool transpose) {
+#ifdef IREE_UK_BUILD_X86_64_AVX2_FMA
+  if (params->cpu_data[0] & IREE_CPU_DATA_FIELD_0_X86_64_HAVE_AVX2_FMA) {
+    return transpose ? iree_uk_unpack_tile_8x8_x32_x86_64_avx2_fma_transpose
+                     : iree_uk_unpack_tile_8x8_x32_x86_64_avx2_fma_direct;
+  }
+#else
+  (void)params;
+  (void)transpose;
+#endif
+  return 0;
+}
+
+static iree_uk_unpack_tile_func_t
+iree_uk_unpack_select_tile_func_x86_64_16x16_x32(
+    const iree_uk_unpack_params_t* params, bool transpose) {
+#ifdef IREE_UK_BUILD_X86_64_AVX512_BASE
+  if (params->cpu_data[0] & IREE_CPU_DATA_FIELD_0_X86_64_HAVE_AVX512_BASE) {
+    return transpose
+               ? iree_uk_unpack_tile_16x16_x32_x86_64_avx512_base_transpose
+               : iree_uk_unpack_tile_16x16_x32_x86_64_avx512_base_direct;
+  }
+#else
+  (void)params;
+  (void)transpose;
+#endif
+  return 0;
+}
+
+iree_uk_unpack_tile_func_t iree_uk_unpack_select_tile_func_x86_64(
+    const iree_uk_unpack_params_t* params) {
+  // As in pack, no arithmetic is being done, so only the element type size
+  // matters, not the type itself.
+  int esize = iree_uk_type_size(iree_uk_unpack_out_type(params->type));
+  bool transpose = params->flags & IREE_UK_FLAG_UNPACK_TRANSPOSE_INNER;
+  if (esize == 4 && params->in_size2 == 8 && params->in_size3 == 8) {
+    return iree_uk_unpack_select_tile_func_x86_64_8x8_x32(params, transpose);
+  }
+  if (esize == 4 && params->in_size2 == 16 && params->in_size3 == 16) {
+    return iree_uk_unpack_select_tile_func_x86_64_16x16_x32(params, transpose);
+  }
+  return 0;
+}
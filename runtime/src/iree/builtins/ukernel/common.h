@@ -195,6 +195,17 @@ extern "C" {
 #define IREE_UK_ATTRIBUTE_NOINLINE
 #endif  // IREE_UK_HAVE_ATTRIBUTE(noinline)
 
+// Software prefetch hint for data that is about to be read. |locality| follows
+// the __builtin_prefetch convention, from 0 (no temporal locality) to 3 (keep
+// in all cache levels). Prefetch instructions never fault, but callers should
+// still stay within their buffers as some targets may lower this to a load.
+#if IREE_UK_HAVE_BUILTIN(__builtin_prefetch) || defined(__GNUC__)
+#define IREE_UK_PREFETCH_RO(PTR, LOCALITY) \
+  __builtin_prefetch((PTR), /*rw=*/0, (LOCALITY))
+#else
+#define IREE_UK_PREFETCH_RO(PTR, LOCALITY)
+#endif
+
 //===----------------------------------------------------------------------===//
 // Local replacements for stdint.h types and constants
 // Refer to the comment at the top of this file for why we can't include
@@ -424,6 +435,7 @@ enum {
   IREE_UK_TYPE_INT_16 = IREE_UK_TYPE_CATEGORY_INTEGER | 4,
   IREE_UK_TYPE_INT_32 = IREE_UK_TYPE_CATEGORY_INTEGER | 5,
   IREE_UK_TYPE_INT_64 = IREE_UK_TYPE_CATEGORY_INTEGER | 6,
+  IREE_UK_TYPE_SINT_4 = IREE_UK_TYPE_CATEGORY_INTEGER_SIGNED | 2,
   IREE_UK_TYPE_SINT_8 = IREE_UK_TYPE_CATEGORY_INTEGER_SIGNED | 3,
   IREE_UK_TYPE_SINT_16 = IREE_UK_TYPE_CATEGORY_INTEGER_SIGNED | 4,
   IREE_UK_TYPE_SINT_32 = IREE_UK_TYPE_CATEGORY_INTEGER_SIGNED | 5,
@@ -467,6 +479,15 @@ static inline int iree_uk_type_size(iree_uk_type_t t) {
   return 1 << iree_uk_type_size_log2(t);
 }
 
+// Returns the number of bytes spanned by |count| consecutive elements of type
+// |t|. Unlike iree_uk_type_size, this is also defined for sub-byte types, whose
+// elements are packed with no padding bits. For those, |count| must be a
+// multiple of the number of elements per byte.
+static inline iree_uk_ssize_t iree_uk_type_bytes(iree_uk_type_t t,
+                                                 iree_uk_ssize_t count) {
+  return (count << iree_uk_type_bit_count_log2(t)) >> 3;
+}
+
 //===----------------------------------------------------------------------===//
 // Tuples of types, packed ("tied") into a word.
 //===----------------------------------------------------------------------===//
@@ -492,6 +513,115 @@ static inline iree_uk_type_t iree_uk_untie_type(int pos,
   return IREE_UK_UNTIE_TYPE(pos, word);
 }
 
+//===----------------------------------------------------------------------===//
+// 16-bit floating-point conversions
+//===----------------------------------------------------------------------===//
+
+// Generic code paths store f16 and bf16 values as their raw iree_uk_uint16_t
+// bit patterns and do arithmetic in f32. Optimized tile functions convert with
+// hardware instructions and must round the same way, i.e. to nearest-even.
+
+static inline iree_uk_uint32_t iree_uk_bits_from_f32(float value) {
+  union {
+    float f;
+    iree_uk_uint32_t u;
+  } bits = {value};
+  return bits.u;
+}
+
+static inline float iree_uk_f32_from_bits(iree_uk_uint32_t value) {
+  union {
+    iree_uk_uint32_t u;
+    float f;
+  } bits = {value};
+  return bits.f;
+}
+
+// Converts an IEEE half-precision value to f32. Exact, including subnormals.
+static inline float iree_uk_f16_to_f32(iree_uk_uint16_t h) {
+  iree_uk_uint32_t sign = (iree_uk_uint32_t)(h & 0x8000u) << 16;
+  iree_uk_uint32_t exp = (h >> 10) & 0x1Fu;
+  iree_uk_uint32_t mantissa = h & 0x3FFu;
+  if (exp == 0x1Fu) {
+    // Inf or NaN, preserving the NaN payload.
+    return iree_uk_f32_from_bits(sign | 0x7F800000u | (mantissa << 13));
+  }
+  if (exp == 0) {
+    if (mantissa == 0) return iree_uk_f32_from_bits(sign);
+    // Subnormal: renormalize into the wider f32 exponent range.
+    iree_uk_uint32_t f32_exp = 127 - 15 + 1;
+    while (!(mantissa & 0x400u)) {
+      mantissa <<= 1;
+      --f32_exp;
+    }
+    return iree_uk_f32_from_bits(sign | (f32_exp << 23) |
+                                 ((mantissa & 0x3FFu) << 13));
+  }
+  return iree_uk_f32_from_bits(sign | ((exp + 127 - 15) << 23) |
+                               (mantissa << 13));
+}
+
+// Converts an f32 value to IEEE half-precision, rounding to nearest-even.
+// Values too large for f16 become infinities and NaNs stay NaNs.
+static inline iree_uk_uint16_t iree_uk_f32_to_f16(float value) {
+  iree_uk_uint32_t u = iree_uk_bits_from_f32(value);
+  iree_uk_uint32_t sign = (u >> 16) & 0x8000u;
+  iree_uk_uint32_t abs = u & 0x7FFFFFFFu;
+  if (abs >= 0x7F800000u) {
+    // Inf or NaN. NaNs are quieted so the payload truncation can't make an Inf.
+    iree_uk_uint32_t nan_bits = abs > 0x7F800000u ? 0x200u : 0;
+    return sign | 0x7C00u | nan_bits | ((abs >> 13) & 0x3FFu);
+  }
+  if (abs >= 0x477FF000u) {
+    // Rounds to a magnitude of at least 65520, beyond the largest finite f16.
+    return sign | 0x7C00u;
+  }
+  if (abs < 0x38800000u) {
+    // Below the smallest normal f16 (2^-14): the result is subnormal or zero.
+    // Values at most 2^-25 (half the smallest subnormal) round to zero.
+    if (abs <= 0x33000000u) return sign;
+    iree_uk_uint32_t exp = abs >> 23;
+    iree_uk_uint32_t mantissa = (abs & 0x7FFFFFu) | 0x800000u;
+    int shift = 126 - exp;
+    iree_uk_uint32_t result = mantissa >> shift;
+    iree_uk_uint32_t remainder = mantissa & ((1u << shift) - 1);
+    iree_uk_uint32_t half = 1u << (shift - 1);
+    if (remainder > half || (remainder == half && (result & 1))) ++result;
+    return sign | result;
+  }
+  // Normal: rebias the exponent and round the 13 dropped mantissa bits. A carry
+  // out of the mantissa correctly increments the exponent.
+  iree_uk_uint32_t result = (abs - ((127u - 15u) << 23)) >> 13;
+  iree_uk_uint32_t remainder = abs & 0x1FFFu;
+  if (remainder > 0x1000u || (remainder == 0x1000u && (result & 1))) ++result;
+  return sign | result;
+}
+
+// Returns element |i| of a buffer of IREE_UK_TYPE_SINT_4 values. Those are
+// packed two per byte, the even-indexed element in the low nibble.
+static inline iree_uk_int32_t iree_uk_sint4_load(const void* buffer,
+                                                 iree_uk_ssize_t i) {
+  iree_uk_int32_t byte = ((const iree_uk_uint8_t*)buffer)[i >> 1];
+  iree_uk_int32_t nibble = (byte >> ((i & 1) << 2)) & 0xF;
+  return (nibble ^ 8) - 8;
+}
+
+// Converts a bfloat16 value to f32. Exact.
+static inline float iree_uk_bf16_to_f32(iree_uk_uint16_t b) {
+  return iree_uk_f32_from_bits((iree_uk_uint32_t)b << 16);
+}
+
+// Converts an f32 value to bfloat16, rounding to nearest-even.
+static inline iree_uk_uint16_t iree_uk_f32_to_bf16(float value) {
+  iree_uk_uint32_t u = iree_uk_bits_from_f32(value);
+  if ((u & 0x7FFFFFFFu) > 0x7F800000u) {
+    // Quiet NaN; rounding could otherwise carry the payload into an Inf.
+    return (u >> 16) | 0x40u;
+  }
+  iree_uk_uint32_t rounding_bias = 0x7FFFu + ((u >> 16) & 1);
+  return (u + rounding_bias) >> 16;
+}
+
 //===----------------------------------------------------------------------===//
 // Local replacement for <string.h>
 //===----------------------------------------------------------------------===//
@@ -0,0 +1,212 @@
+// Copyright 2023 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include "iree/builtins/ukernel/conv2d_nchwc.h"
+
+#include "iree/builtins/ukernel/arch/mmt4d_arch.h"
+#include "iree/builtins/ukernel/mmt4d_generic.h"
+
+static iree_uk_status_t iree_uk_conv2d_nchwc_validate(
+    const iree_uk_conv2d_nchwc_params_t* params) {
+#ifdef IREE_UK_ENABLE_VALIDATION
+  if (params->flags & ~IREE_UK_FLAG_ACCUMULATE) {
+    return iree_uk_status_bad_flags;
+  }
+  switch (params->type) {
+    case iree_uk_mmt4d_type_f32f32f32:
+    case iree_uk_mmt4d_type_i8i8i32:
+    case iree_uk_mmt4d_type_f16f16f32:
+    case iree_uk_mmt4d_type_bf16bf16f32:
+      break;
+    // f16f16f16 tile functions round the output once per call, and there is
+    // one call per filter tap and input channel tile.
+    default:
+      return iree_uk_status_bad_type;
+  }
+  if (!(IREE_UK_VALUE_IN_UNSIGNED_INT_RANGE(params->N, 31) &&
+        IREE_UK_VALUE_IN_UNSIGNED_INT_RANGE(params->C1, 31) &&
+        IREE_UK_VALUE_IN_UNSIGNED_INT_RANGE(params->H, 31) &&
+        IREE_UK_VALUE_IN_UNSIGNED_INT_RANGE(params->W, 31) &&
+        IREE_UK_VALUE_IN_UNSIGNED_INT_RANGE(params->OC1, 31) &&
+        IREE_UK_VALUE_IN_UNSIGNED_INT_RANGE(params->OH, 31) &&
+        IREE_UK_VALUE_IN_UNSIGNED_INT_RANGE(params->OW, 31) &&
+        IREE_UK_VALUE_IN_UNSIGNED_INT_RANGE(params->KH, 15) &&
+        IREE_UK_VALUE_IN_UNSIGNED_INT_RANGE(params->KW, 15) &&
+        IREE_UK_VALUE_IN_UNSIGNED_INT_RANGE(params->pad_h, 15) &&
+        IREE_UK_VALUE_IN_UNSIGNED_INT_RANGE(params->pad_w, 15) &&
+        IREE_UK_VALUE_IN_UNSIGNED_INT_RANGE(params->M0, 15) &&
+        IREE_UK_VALUE_IN_UNSIGNED_INT_RANGE(params->N0, 15) &&
+        IREE_UK_VALUE_IN_UNSIGNED_INT_RANGE(params->K0, 15))) {
+    return iree_uk_status_unsupported_huge_or_negative_dimension;
+  }
+  if (params->stride_h < 1 || params->stride_w < 1 ||
+      params->dilation_h < 1 || params->dilation_w < 1) {
+    return iree_uk_status_unsupported_huge_or_negative_dimension;
+  }
+  // Partial and gathered tiles go through scratch tiles on the stack.
+  iree_uk_type_t lhs_type = iree_uk_mmt4d_lhs_type(params->type);
+  iree_uk_type_t out_type = iree_uk_mmt4d_out_type(params->type);
+  if ((params->M0 * params->K0) << iree_uk_type_size_log2(lhs_type) >
+          iree_uk_mmt4d_tile_generic_max_bytes ||
+      (params->M0 * params->N0) << iree_uk_type_size_log2(out_type) >
+          iree_uk_mmt4d_tile_generic_max_bytes) {
+    return iree_uk_status_unsupported_generic_tile_size;
+  }
+#endif  // IREE_UK_ENABLE_VALIDATION
+  return iree_uk_status_ok;
+}
+
+// Returns the mmt4d params that tile functions see. Tile functions only read
+// the type and tile sizes from params.
+static iree_uk_mmt4d_params_t iree_uk_conv2d_nchwc_tile_params(
+    const iree_uk_conv2d_nchwc_params_t* params) {
+  iree_uk_mmt4d_params_t tile_params = {
+      .type = params->type,
+      .flags = params->flags,
+      .M = 1,
+      .N = 1,
+      .K = 1,
+      .M0 = params->M0,
+      .N0 = params->N0,
+      .K0 = params->K0,
+      .cpu_data = params->cpu_data,
+  };
+  return tile_params;
+}
+
+// Computes the output tile of pixels [ow0, ow0 + rows) of row |oh| of one
+// output channel tile. |in_image| is the input image and |filter_panel| the
+// filter panel of the output channel tile.
+static void iree_uk_conv2d_nchwc_tile(
+    const iree_uk_conv2d_nchwc_params_t* params,
+    const iree_uk_mmt4d_params_t* tile_params,
+    iree_uk_mmt4d_tile_func_t tile_func, const char* in_image,
+    const char* filter_panel, iree_uk_int32_t oh, iree_uk_int32_t ow0,
+    iree_uk_int32_t rows, char* out_ptr) {
+  const iree_uk_int32_t H = params->H;
+  const iree_uk_int32_t W = params->W;
+  const iree_uk_int32_t KW = params->KW;
+  const iree_uk_int16_t M0 = params->M0;
+  const iree_uk_int16_t N0 = params->N0;
+  const iree_uk_int16_t K0 = params->K0;
+  const iree_uk_type_t lhs_type = iree_uk_mmt4d_lhs_type(params->type);
+  const iree_uk_type_t rhs_type = iree_uk_mmt4d_rhs_type(params->type);
+  const iree_uk_type_t out_type = iree_uk_mmt4d_out_type(params->type);
+  const iree_uk_ssize_t in_pixel_size = K0 << iree_uk_type_size_log2(lhs_type);
+  const iree_uk_ssize_t in_row_size = W * in_pixel_size;
+  const iree_uk_ssize_t out_pixel_size = N0
+                                         << iree_uk_type_size_log2(out_type);
+  const iree_uk_ssize_t rhs_tile_size = (N0 * K0)
+                                        << iree_uk_type_size_log2(rhs_type);
+
+  // Scratch tiles for gathered LHS tiles and partial output tiles.
+  iree_uk_int32_t lhs_scratch[iree_uk_mmt4d_tile_generic_max_bytes /
+                              sizeof(iree_uk_int32_t)];
+  iree_uk_int32_t out_scratch[iree_uk_mmt4d_tile_generic_max_bytes /
+                              sizeof(iree_uk_int32_t)];
+
+  char* out_tile = rows == M0 ? out_ptr : (char*)out_scratch;
+  iree_uk_uint32_t flags = params->flags;
+  if (out_tile != out_ptr && (flags & IREE_UK_FLAG_ACCUMULATE)) {
+    iree_uk_memcpy(out_tile, out_ptr, rows * out_pixel_size);
+  }
+  const char* in_plane = in_image;
+  const char* rhs_tile = filter_panel;
+  for (iree_uk_int32_t c1 = 0; c1 < params->C1; ++c1) {
+    for (iree_uk_int32_t kh = 0; kh < params->KH; ++kh) {
+      const iree_uk_int32_t ih = oh * params->stride_h - params->pad_h +
+                                 kh * params->dilation_h;
+      if (ih < 0 || ih >= H) {
+        rhs_tile += KW * rhs_tile_size;
+        continue;
+      }
+      const char* in_row = in_plane + ih * in_row_size;
+      for (iree_uk_int32_t kw = 0; kw < KW; ++kw) {
+        const iree_uk_int32_t iw0 = ow0 * params->stride_w - params->pad_w +
+                                    kw * params->dilation_w;
+        const char* lhs_tile = (const char*)lhs_scratch;
+        if (params->stride_w == 1 && iw0 >= 0 && iw0 + M0 <= W) {
+          // M0 consecutive input pixels form the M0xK0 LHS tile in place.
+          lhs_tile = in_row + iw0 * in_pixel_size;
+        } else {
+          for (iree_uk_int32_t i = 0; i < M0; ++i) {
+            const iree_uk_int32_t iw = iw0 + i * params->stride_w;
+            char* dst = (char*)lhs_scratch + i * in_pixel_size;
+            if (i < rows && iw >= 0 && iw < W) {
+              iree_uk_memcpy(dst, in_row + iw * in_pixel_size, in_pixel_size);
+            } else {
+              iree_uk_memset(dst, 0, in_pixel_size);
+            }
+          }
+        }
+        tile_func(out_tile, lhs_tile, rhs_tile, 1, flags, tile_params);
+        flags |= IREE_UK_FLAG_ACCUMULATE;
+        rhs_tile += rhs_tile_size;
+      }
+    }
+    in_plane += H * in_row_size;
+  }
+  if (!(flags & IREE_UK_FLAG_ACCUMULATE)) {
+    // Only padding was under the filter.
+    iree_uk_memset(out_tile, 0, rows * out_pixel_size);
+  }
+  if (out_tile != out_ptr) {
+    iree_uk_memcpy(out_ptr, out_tile, rows * out_pixel_size);
+  }
+}
+
+IREE_UK_EXPORT iree_uk_status_t
+iree_uk_conv2d_nchwc(const iree_uk_conv2d_nchwc_params_t* params) {
+  IREE_UK_RETURN_IF_ERROR(iree_uk_conv2d_nchwc_validate(params));
+  if (params->N == 0 || params->OC1 == 0 || params->OH == 0 ||
+      params->OW == 0) {
+    return iree_uk_status_ok;
+  }
+
+  // Use the same tile functions as mmt4d, one call per filter tap and input
+  // channel tile.
+  iree_uk_mmt4d_params_t tile_params = iree_uk_conv2d_nchwc_tile_params(params);
+  iree_uk_mmt4d_tile_func_t tile_func =
+      iree_uk_mmt4d_select_tile_func_arch(&tile_params);
+  if (!tile_func) {
+    tile_func = iree_uk_mmt4d_select_tile_func_generic(&tile_params);
+  }
+
+  const iree_uk_int32_t OH = params->OH;
+  const iree_uk_int32_t OW = params->OW;
+  const iree_uk_int16_t M0 = params->M0;
+  const iree_uk_type_t lhs_type = iree_uk_mmt4d_lhs_type(params->type);
+  const iree_uk_type_t rhs_type = iree_uk_mmt4d_rhs_type(params->type);
+  const iree_uk_type_t out_type = iree_uk_mmt4d_out_type(params->type);
+  const iree_uk_ssize_t in_image_size =
+      (params->C1 * params->H * params->W * params->K0)
+      << iree_uk_type_size_log2(lhs_type);
+  const iree_uk_ssize_t filter_panel_size =
+      (params->C1 * params->KH * params->KW * params->N0 * params->K0)
+      << iree_uk_type_size_log2(rhs_type);
+  const iree_uk_ssize_t out_pixel_size =
+      params->N0 << iree_uk_type_size_log2(out_type);
+  const char* in_image = params->in_buffer;
+  char* out_plane = params->out_buffer;
+  for (iree_uk_int32_t n = 0; n < params->N; ++n) {
+    const char* filter_panel = params->filter_buffer;
+    for (iree_uk_int32_t oc1 = 0; oc1 < params->OC1; ++oc1) {
+      char* out_ptr = out_plane;
+      for (iree_uk_int32_t oh = 0; oh < OH; ++oh) {
+        for (iree_uk_int32_t ow0 = 0; ow0 < OW; ow0 += M0) {
+          const iree_uk_int32_t rows = OW - ow0 < M0 ? OW - ow0 : M0;
+          iree_uk_conv2d_nchwc_tile(params, &tile_params, tile_func, in_image,
+                                    filter_panel, oh, ow0, rows, out_ptr);
+          out_ptr += rows * out_pixel_size;
+        }
+      }
+      filter_panel += filter_panel_size;
+      out_plane = out_ptr;
+    }
+    in_image += in_image_size;
+  }
+  return iree_uk_status_ok;
+}
@@ -0,0 +1,24 @@
+// Copyright 2023 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#ifndef IREE_BUILTINS_UKERNEL_CONV2D_NCHWC_H_
+#define IREE_BUILTINS_UKERNEL_CONV2D_NCHWC_H_
+
+#include "iree/builtins/ukernel/conv2d_nchwc_types.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif  // __cplusplus
+
+// Main entry point: data-tiled direct 2D convolution.
+IREE_UK_EXPORT iree_uk_status_t
+iree_uk_conv2d_nchwc(const iree_uk_conv2d_nchwc_params_t* params);
+
+#ifdef __cplusplus
+}  // extern "C"
+#endif  // __cplusplus
+
+#endif  // IREE_BUILTINS_UKERNEL_CONV2D_NCHWC_H_
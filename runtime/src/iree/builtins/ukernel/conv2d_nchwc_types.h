@@ -0,0 +1,57 @@
+// Copyright 2023 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#ifndef IREE_BUILTINS_UKERNEL_CONV2D_NCHWC_TYPES_H_
+#define IREE_BUILTINS_UKERNEL_CONV2D_NCHWC_TYPES_H_
+
+#include "iree/builtins/ukernel/mmt4d_types.h"
+
+// Data-tiled direct 2D convolution.
+//
+// Channels are tiled like the K and N dimensions of mmt4d so that the mmt4d
+// tile functions compute the convolution without an im2col buffer:
+// - in:     [N][C1][H][W][K0], channel c at (c / K0, c % K0).
+// - filter: [OC1][C1][KH][KW][N0][K0], each (oc1, c1, kh, kw) being one
+//           N0xK0 RHS tile of mmt4d.
+// - out:    [N][OC1][OH][OW][N0].
+// Each tile function call multiplies M0 consecutive output pixels of a row by
+// one filter tap, so with stride_w == 1 the LHS tile is read in place from
+// the input. Other strides, padding and partial tiles gather the M0 input
+// pixels into a temporary tile first.
+//
+// The input is implicitly zero-padded by pad_h rows above and pad_w columns
+// left of it, and by however many rows and columns OH and OW need below and
+// right of it.
+//
+// The element types are those of mmt4d, as are the supported tile shapes.
+typedef struct iree_uk_conv2d_nchwc_params_t {
+  iree_uk_mmt4d_type_t type;
+  iree_uk_uint32_t flags;
+  iree_uk_ssize_t N;
+  iree_uk_ssize_t C1;
+  iree_uk_ssize_t H;
+  iree_uk_ssize_t W;
+  iree_uk_ssize_t OC1;
+  iree_uk_ssize_t OH;
+  iree_uk_ssize_t OW;
+  iree_uk_int32_t KH;
+  iree_uk_int32_t KW;
+  iree_uk_int32_t stride_h;
+  iree_uk_int32_t stride_w;
+  iree_uk_int32_t dilation_h;
+  iree_uk_int32_t dilation_w;
+  iree_uk_int32_t pad_h;
+  iree_uk_int32_t pad_w;
+  iree_uk_int32_t M0;
+  iree_uk_int32_t N0;
+  iree_uk_int32_t K0;
+  const void* in_buffer;
+  const void* filter_buffer;
+  void* out_buffer;
+  const iree_uk_uint64_t* cpu_data;
+} iree_uk_conv2d_nchwc_params_t;
+
+#endif  // IREE_BUILTINS_UKERNEL_CONV2D_NCHWC_TYPES_H_
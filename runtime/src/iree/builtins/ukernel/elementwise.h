@@ -19,7 +19,8 @@ extern "C" {
 
 // Binary ukernel func 2d, x32.
 // It takes lhs, rhs, out buffers and size, returning 0 on success and !0 on
-// error.
+// error. |cpu_data| is used to select architecture-specific code paths, like
+// iree_uk_mmt4d_params_t::cpu_data.
 typedef int (*iree_uk_x32b_2d_func_t)(
     const iree_uk_uint32_t* lhs, iree_uk_ssize_t lhs_offset,
     iree_uk_ssize_t lhs_stride0, iree_uk_ssize_t lhs_stride1,
@@ -27,7 +28,8 @@ typedef int (*iree_uk_x32b_2d_func_t)(
     iree_uk_ssize_t rhs_stride0, iree_uk_ssize_t rhs_stride1,
     iree_uk_uint32_t* out, iree_uk_ssize_t out_offset,
     iree_uk_ssize_t out_stride0, iree_uk_ssize_t out_stride1,
-    iree_uk_ssize_t size0, iree_uk_ssize_t size1);
+    iree_uk_ssize_t size0, iree_uk_ssize_t size1,
+    const iree_uk_uint64_t* cpu_data);
 
 // Declares a binary 2d microkernel with the following signature:
 //   int iree_uk_{category}_{opcode}_2d(...)
@@ -40,7 +42,8 @@ typedef int (*iree_uk_x32b_2d_func_t)(
       iree_uk_ssize_t rhs_stride0, iree_uk_ssize_t rhs_stride1, \
       dtype* IREE_UK_RESTRICT out, iree_uk_ssize_t out_offset,  \
       iree_uk_ssize_t out_stride0, iree_uk_ssize_t out_stride1, \
-      iree_uk_ssize_t size0, iree_uk_ssize_t size1)
+      iree_uk_ssize_t size0, iree_uk_ssize_t size1,             \
+      const iree_uk_uint64_t* cpu_data)
 
 DECLARE_UKERNEL_BINARY_2D(addf, iree_uk_uint32_t, x32b);
 DECLARE_UKERNEL_BINARY_2D(addi, iree_uk_uint32_t, x32b);
@@ -64,13 +67,14 @@ DECLARE_UKERNEL_BINARY_2D(xori, iree_uk_uint32_t, x32b);
 
 // Unary ukernel func 2d, x32.
 // It takes in, out buffers and size, returning 0 on success and !0 on
-// error.
+// error. |cpu_data| is as in iree_uk_x32b_2d_func_t.
 typedef int (*iree_uk_x32u_2d_func_t)(
     const iree_uk_uint32_t* in, iree_uk_ssize_t in_offset,
     iree_uk_ssize_t in_stride0, iree_uk_ssize_t in_stride1,
     iree_uk_uint32_t* out, iree_uk_ssize_t out_offset,
     iree_uk_ssize_t out_stride0, iree_uk_ssize_t out_stride1,
-    iree_uk_ssize_t size0, iree_uk_ssize_t size1);
+    iree_uk_ssize_t size0, iree_uk_ssize_t size1,
+    const iree_uk_uint64_t* cpu_data);
 
 // Declares a binary 2d microkernel with the following signature:
 //   int iree_uk_{category}_{opcode}_2d(...)
@@ -82,7 +86,7 @@ typedef int (*iree_uk_x32u_2d_func_t)(
       iree_uk_ssize_t in_stride1, dtype* IREE_UK_RESTRICT out,                \
       iree_uk_ssize_t out_offset, iree_uk_ssize_t out_stride0,                \
       iree_uk_ssize_t out_stride1, iree_uk_ssize_t size0,                     \
-      iree_uk_ssize_t size1)
+      iree_uk_ssize_t size1, const iree_uk_uint64_t* cpu_data)
 
 DECLARE_UKERNEL_UNARY_2D(absf, iree_uk_uint32_t, x32u);
 DECLARE_UKERNEL_UNARY_2D(ceilf, iree_uk_uint32_t, x32u);
@@ -92,6 +96,42 @@ DECLARE_UKERNEL_UNARY_2D(floorf, iree_uk_uint32_t, x32u);
 DECLARE_UKERNEL_UNARY_2D(logf, iree_uk_uint32_t, x32u);
 DECLARE_UKERNEL_UNARY_2D(negf, iree_uk_uint32_t, x32u);
 DECLARE_UKERNEL_UNARY_2D(rsqrtf, iree_uk_uint32_t, x32u);
+DECLARE_UKERNEL_UNARY_2D(tanhf, iree_uk_uint32_t, x32u);
+
+//===----------------------------------------------------------------------===//
+// Public API - Reduction kernels.
+//===----------------------------------------------------------------------===//
+
+// Reduction ukernel func 2d, x32.
+// Reduces each of the |size0| rows of |in| along its |size1| elements into the
+// corresponding element of |out|, accumulating into the existing value:
+//   out[i] = OP(out[i], in[i, 0], ..., in[i, size1 - 1])
+// Returns 0 on success and !0 on error. |cpu_data| is as in
+// iree_uk_x32b_2d_func_t.
+typedef int (*iree_uk_x32r_2d_func_t)(
+    const iree_uk_uint32_t* in, iree_uk_ssize_t in_offset,
+    iree_uk_ssize_t in_stride0, iree_uk_ssize_t in_stride1,
+    iree_uk_uint32_t* out, iree_uk_ssize_t out_offset,
+    iree_uk_ssize_t out_stride0, iree_uk_ssize_t size0, iree_uk_ssize_t size1,
+    const iree_uk_uint64_t* cpu_data);
+
+// Declares a reduction 2d microkernel with the following signature:
+//   int iree_uk_{category}_{opcode}_2d(...)
+// of function type iree_uk_{category}_2d_func_t.
+#define DECLARE_UKERNEL_REDUCTION_2D(opcode, dtype, category)                 \
+  IREE_UK_EXPORT int iree_uk_##category##_##opcode##_2d(                      \
+      const dtype* in, iree_uk_ssize_t in_offset, iree_uk_ssize_t in_stride0, \
+      iree_uk_ssize_t in_stride1, dtype* IREE_UK_RESTRICT out,                \
+      iree_uk_ssize_t out_offset, iree_uk_ssize_t out_stride0,                \
+      iree_uk_ssize_t size0, iree_uk_ssize_t size1,                           \
+      const iree_uk_uint64_t* cpu_data)
+
+DECLARE_UKERNEL_REDUCTION_2D(addf, iree_uk_uint32_t, x32r);
+DECLARE_UKERNEL_REDUCTION_2D(addi, iree_uk_uint32_t, x32r);
+DECLARE_UKERNEL_REDUCTION_2D(maxf, iree_uk_uint32_t, x32r);
+DECLARE_UKERNEL_REDUCTION_2D(maxsi, iree_uk_uint32_t, x32r);
+DECLARE_UKERNEL_REDUCTION_2D(minf, iree_uk_uint32_t, x32r);
+DECLARE_UKERNEL_REDUCTION_2D(minsi, iree_uk_uint32_t, x32r);
 
 #ifdef __cplusplus
 }  // extern "C"
@@ -34,3 +34,13 @@ DISPATCH_UKERNEL_UNARY_2D(floorf, IREE_UK_X32U_FLOORF, iree_uk_uint32_t, x32u);
 DISPATCH_UKERNEL_UNARY_2D(logf, IREE_UK_X32U_LOGF, iree_uk_uint32_t, x32u);
 DISPATCH_UKERNEL_UNARY_2D(negf, IREE_UK_X32U_NEGF, iree_uk_uint32_t, x32u);
 DISPATCH_UKERNEL_UNARY_2D(rsqrtf, IREE_UK_X32U_RSQRTF, iree_uk_uint32_t, x32u);
+DISPATCH_UKERNEL_UNARY_2D(tanhf, IREE_UK_X32U_TANHF, iree_uk_uint32_t, x32u);
+
+DISPATCH_UKERNEL_REDUCTION_2D(addf, IREE_UK_X32R_ADDF, iree_uk_uint32_t, x32r);
+DISPATCH_UKERNEL_REDUCTION_2D(addi, IREE_UK_X32R_ADDI, iree_uk_uint32_t, x32r);
+DISPATCH_UKERNEL_REDUCTION_2D(maxf, IREE_UK_X32R_MAXF, iree_uk_uint32_t, x32r);
+DISPATCH_UKERNEL_REDUCTION_2D(maxsi, IREE_UK_X32R_MAXSI, iree_uk_uint32_t,
+                              x32r);
+DISPATCH_UKERNEL_REDUCTION_2D(minf, IREE_UK_X32R_MINF, iree_uk_uint32_t, x32r);
+DISPATCH_UKERNEL_REDUCTION_2D(minsi, IREE_UK_X32R_MINSI, iree_uk_uint32_t,
+                              x32r);
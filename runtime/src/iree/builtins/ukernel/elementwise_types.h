@@ -0,0 +1,76 @@
+// Copyright 2023 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#ifndef IREE_BUILTINS_UKERNEL_ELEMENTWISE_TYPES_H_
+#define IREE_BUILTINS_UKERNEL_ELEMENTWISE_TYPES_H_
+
+#include "iree/builtins/ukernel/common.h"
+
+// Opcodes for generic functions operating on 32-bit operands and result.
+// Since the outer dispatcher only differentiates based on width, all other
+// type specificity is carried by the opcode.
+// Binary opcodes are named "X32B", unary opcodes "X32U" and reduction opcodes
+// "X32R".
+// The initial list was sorted, and it is encouraged to sort extensions, but
+// each opcode must be numerically stable, so the list is not expected to
+// be sorted over time.
+typedef enum {
+  IREE_UK_X32B_ADDF = 0,
+  IREE_UK_X32B_ADDI = 1,
+  IREE_UK_X32B_ANDI = 2,
+  IREE_UK_X32B_DIVF = 3,
+  IREE_UK_X32B_DIVSI = 4,
+  IREE_UK_X32B_DIVUI = 5,
+  IREE_UK_X32B_MULF = 6,
+  IREE_UK_X32B_MULI = 7,
+  IREE_UK_X32B_ORI = 8,
+  IREE_UK_X32B_SHLI = 9,
+  IREE_UK_X32B_SHRSI = 10,
+  IREE_UK_X32B_SHRUI = 11,
+  IREE_UK_X32B_SUBF = 12,
+  IREE_UK_X32B_SUBI = 13,
+  IREE_UKENREL_X32B_XORI = 14,
+} iree_uk_x32b_opcode_t;
+
+typedef enum {
+  IREE_UK_X32U_ABSF = 0,
+  IREE_UK_X32U_CEILF = 1,
+  IREE_UK_X32U_CTLZ = 2,
+  IREE_UK_X32U_EXPF = 3,
+  IREE_UK_X32U_FLOORF = 4,
+  IREE_UK_X32U_LOGF = 5,
+  IREE_UK_X32U_NEGF = 6,
+  IREE_UK_X32U_RSQRTF = 7,
+  IREE_UK_X32U_TANHF = 8,
+} iree_uk_x32u_opcode_t;
+
+// Reduction opcodes, combining all elements of each row into one element.
+typedef enum {
+  IREE_UK_X32R_ADDF = 0,
+  IREE_UK_X32R_ADDI = 1,
+  IREE_UK_X32R_MAXF = 2,
+  IREE_UK_X32R_MAXSI = 3,
+  IREE_UK_X32R_MINF = 4,
+  IREE_UK_X32R_MINSI = 5,
+} iree_uk_x32r_opcode_t;
+
+// Function pointer type for x32b row functions, computing |size| contiguous
+// elements of out = op(lhs, rhs). Row functions are the unit of
+// architecture-specific specialization of elementwise ukernels: the 2d entry
+// points iterate over rows and defer to a row function when all operands are
+// contiguous along the inner dimension.
+typedef void (*iree_uk_x32b_row_func_t)(const iree_uk_uint32_t* lhs,
+                                        const iree_uk_uint32_t* rhs,
+                                        iree_uk_uint32_t* IREE_UK_RESTRICT out,
+                                        iree_uk_ssize_t size);
+
+// Function pointer type for x32u row functions, computing |size| contiguous
+// elements of out = op(in). See iree_uk_x32b_row_func_t.
+typedef void (*iree_uk_x32u_row_func_t)(const iree_uk_uint32_t* in,
+                                        iree_uk_uint32_t* IREE_UK_RESTRICT out,
+                                        iree_uk_ssize_t size);
+
+#endif  // IREE_BUILTINS_UKERNEL_ELEMENTWISE_TYPES_H_
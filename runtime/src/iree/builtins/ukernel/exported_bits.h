@@ -50,11 +50,24 @@
 #define IREE_UK_FLAG_UNPACK_TRANSPOSE_OUTER 0x20000u
 #define IREE_UK_FLAG_UNPACK_TRANSPOSE_OUTER_BIT_POS 17
 
+// `mmt4d` ukernel-specific bits (bits 16..31)
+// Fused epilogue applied to each output tile after accumulation, in this
+// order: bias add, then requantization (i8i8i32 only), then clamp.
+#define IREE_UK_FLAG_MMT4D_EPILOGUE_BIAS 0x10000u
+#define IREE_UK_FLAG_MMT4D_EPILOGUE_BIAS_BIT_POS 16
+#define IREE_UK_FLAG_MMT4D_EPILOGUE_CLAMP 0x20000u
+#define IREE_UK_FLAG_MMT4D_EPILOGUE_CLAMP_BIT_POS 17
+#define IREE_UK_FLAG_MMT4D_EPILOGUE_REQUANTIZE 0x40000u
+#define IREE_UK_FLAG_MMT4D_EPILOGUE_REQUANTIZE_BIT_POS 18
+
 // Static assertions ensuring consistency of the above flag values.
 #define IREE_UK_ENSURE_CONSISTENT_FLAG(F) \
   IREE_UK_STATIC_ASSERT((F) == (1u << (F##_BIT_POS)))
 IREE_UK_ENSURE_CONSISTENT_FLAG(IREE_UK_FLAG_ACCUMULATE);
 IREE_UK_ENSURE_CONSISTENT_FLAG(IREE_UK_FLAG_PACK_TRANSPOSE_INNER);
 IREE_UK_ENSURE_CONSISTENT_FLAG(IREE_UK_FLAG_PACK_TRANSPOSE_OUTER);
+IREE_UK_ENSURE_CONSISTENT_FLAG(IREE_UK_FLAG_MMT4D_EPILOGUE_BIAS);
+IREE_UK_ENSURE_CONSISTENT_FLAG(IREE_UK_FLAG_MMT4D_EPILOGUE_CLAMP);
+IREE_UK_ENSURE_CONSISTENT_FLAG(IREE_UK_FLAG_MMT4D_EPILOGUE_REQUANTIZE);
 
 #endif  // IREE_BUILTINS_UKERNEL_EXPORTED_BITS_H_
@@ -8,22 +8,63 @@
 
 #include "iree/builtins/ukernel/arch/mmt4d_arch.h"
 #include "iree/builtins/ukernel/mmt4d_generic.h"
+#include "iree/schemas/cpu_data.h"
 
 #define OUTSIDE_UINT_RANGE(value, bits) (((value) < 0) || ((value) >> (bits)))
 
+#define IREE_UK_MMT4D_EPILOGUE_FLAGS                                     \
+  (IREE_UK_FLAG_MMT4D_EPILOGUE_BIAS | IREE_UK_FLAG_MMT4D_EPILOGUE_CLAMP | \
+   IREE_UK_FLAG_MMT4D_EPILOGUE_REQUANTIZE)
+
 static iree_uk_status_t iree_uk_mmt4d_validate(
     const iree_uk_mmt4d_params_t* params) {
 #ifdef IREE_UK_ENABLE_VALIDATION
-  if (params->flags & ~IREE_UK_FLAG_ACCUMULATE) {
+  const iree_uk_uint32_t allowed_flags =
+      IREE_UK_FLAG_ACCUMULATE | IREE_UK_MMT4D_EPILOGUE_FLAGS;
+  if (params->flags & ~allowed_flags) {
     return iree_uk_status_bad_flags;
   }
+  if (params->flags & IREE_UK_MMT4D_EPILOGUE_FLAGS) {
+    // The epilogue operates on 32-bit accumulators in the output buffer, which
+    // f16f16f16 does not have.
+    if (params->type == iree_uk_mmt4d_type_f16f16f16) {
+      return iree_uk_status_bad_flags;
+    }
+  }
+  if (params->flags & IREE_UK_FLAG_MMT4D_EPILOGUE_REQUANTIZE) {
+    // Requantization narrows the output buffer to i8, so there is no i32
+    // accumulator to read back from it.
+    if (params->type != iree_uk_mmt4d_type_i8i8i32 ||
+        (params->flags & IREE_UK_FLAG_ACCUMULATE)) {
+      return iree_uk_status_bad_flags;
+    }
+    if (!IREE_UK_VALUE_IN_UNSIGNED_INT_RANGE(params->epilogue.requant_shift,
+                                             5) ||
+        params->epilogue.requant_shift == 31) {
+      return iree_uk_status_bad_flags;
+    }
+  }
   switch (params->type) {
     case iree_uk_mmt4d_type_f32f32f32:
     case iree_uk_mmt4d_type_i8i8i32:
+    case iree_uk_mmt4d_type_f16f16f32:
+    case iree_uk_mmt4d_type_f16f16f16:
+    case iree_uk_mmt4d_type_bf16bf16f32:
+    case iree_uk_mmt4d_type_f32i4f32:
+    case iree_uk_mmt4d_type_f16i4f32:
       break;
     default:
       return iree_uk_status_bad_type;
   }
+  if (iree_uk_mmt4d_rhs_type(params->type) == IREE_UK_TYPE_SINT_4) {
+    // Every RHS tile and panel has to start on a byte boundary.
+    if (((params->N0 * params->K0) & 1) || (params->rhs_stride & 1)) {
+      return iree_uk_status_shapes_mismatch;
+    }
+    if (params->rhs_quant.group_size < 1) {
+      return iree_uk_status_unsupported_huge_or_negative_dimension;
+    }
+  }
   // Some implementations may wish to avoid supporting absurdly wide types. For
   // instance, K is the innermost (i.e. hottest) loop bound, so some 32bit
   // targets may benefit from K being int32, not int64. We still let K be of
@@ -40,7 +81,10 @@ static iree_uk_status_t iree_uk_mmt4d_validate(
 
   int tile_elems = params->M0 * params->N0;
   iree_uk_type_t out_type = iree_uk_mmt4d_out_type(params->type);
-  int tile_bytes = tile_elems << iree_uk_type_size_log2(out_type);
+  // Generic tile functions accumulate 16-bit float outputs in f32.
+  int acc_elem_size_log2 = iree_uk_type_size_log2(out_type);
+  if (acc_elem_size_log2 < 2) acc_elem_size_log2 = 2;
+  int tile_bytes = tile_elems << acc_elem_size_log2;
   if (tile_bytes > iree_uk_mmt4d_tile_generic_max_bytes) {
     return iree_uk_status_unsupported_generic_tile_size;
   }
@@ -60,6 +104,171 @@ static iree_uk_mmt4d_tile_func_t iree_uk_mmt4d_select_tile_func(
   return iree_uk_mmt4d_select_tile_func_generic(params);
 }
 
+// Computes one output tile for the types with a quantized RHS. Scales change
+// along K, so the tile_func computes the unscaled product of one group of K
+// tiles at a time into |group_tile|, which then gets scaled per column and
+// added to |acc_tile|.
+static void iree_uk_mmt4d_tile_rhs_quant(const iree_uk_mmt4d_params_t* params,
+                                         iree_uk_mmt4d_tile_func_t tile_func,
+                                         float* acc_tile, const char* lhs_panel,
+                                         const char* rhs_panel,
+                                         iree_uk_int32_t tile_col_index,
+                                         float* group_tile) {
+  const iree_uk_int32_t K = params->K;
+  const iree_uk_int16_t M0 = params->M0;
+  const iree_uk_int16_t N0 = params->N0;
+  const iree_uk_int32_t group_size = params->rhs_quant.group_size;
+  const iree_uk_ssize_t lhs_group_stride = iree_uk_type_bytes(
+      iree_uk_mmt4d_lhs_type(params->type), group_size * M0 * params->K0);
+  const iree_uk_ssize_t rhs_group_stride = iree_uk_type_bytes(
+      iree_uk_mmt4d_rhs_type(params->type), group_size * N0 * params->K0);
+  const float* scales =
+      params->rhs_quant.scales_buffer +
+      (iree_uk_ssize_t)tile_col_index * params->rhs_quant.scales_stride;
+  if (!(params->flags & IREE_UK_FLAG_ACCUMULATE)) {
+    for (int i = 0; i < M0 * N0; ++i) acc_tile[i] = 0;
+  }
+  for (iree_uk_int32_t k = 0; k < K; k += group_size) {
+    iree_uk_int32_t group_K = K - k < group_size ? K - k : group_size;
+    tile_func(group_tile, lhs_panel, rhs_panel, group_K, 0, params);
+    for (int i0 = 0; i0 < M0; ++i0) {
+      for (int j0 = 0; j0 < N0; ++j0) {
+        acc_tile[i0 * N0 + j0] += scales[j0] * group_tile[i0 * N0 + j0];
+      }
+    }
+    lhs_panel += lhs_group_stride;
+    rhs_panel += rhs_group_stride;
+    scales += N0;
+  }
+}
+
+// Equivalent to gemmlowp's SaturatingRoundingDoublingHighMul: returns the high
+// 32 bits of 2*a*b, rounded to nearest.
+static inline iree_uk_int32_t iree_uk_mmt4d_rounding_doubling_high_mul(
+    iree_uk_int32_t a, iree_uk_int32_t b) {
+  const iree_uk_int32_t int32_min = -2147483647 - 1;
+  if (a == int32_min && b == int32_min) {
+    return 2147483647;
+  }
+  iree_uk_int64_t ab = (iree_uk_int64_t)a * (iree_uk_int64_t)b;
+  iree_uk_int64_t nudge = ab >= 0 ? (1 << 30) : (1 - (1 << 30));
+  return (iree_uk_int32_t)((ab + nudge) / (1ll << 31));
+}
+
+// Equivalent to gemmlowp's RoundingDivideByPOT: x / 2^shift rounded to
+// nearest, ties away from zero.
+static inline iree_uk_int32_t iree_uk_mmt4d_rounding_divide_by_pot(
+    iree_uk_int32_t x, iree_uk_int32_t shift) {
+  iree_uk_int32_t mask = (iree_uk_int32_t)((1u << shift) - 1);
+  iree_uk_int32_t remainder = x & mask;
+  iree_uk_int32_t threshold = (mask >> 1) + (x < 0 ? 1 : 0);
+  return (x >> shift) + (remainder > threshold ? 1 : 0);
+}
+
+static void iree_uk_mmt4d_epilogue_tile_f32(
+    const iree_uk_mmt4d_params_t* params, float* tile,
+    iree_uk_int32_t tile_col_index) {
+  const iree_uk_int16_t M0 = params->M0;
+  const iree_uk_int16_t N0 = params->N0;
+  const iree_uk_mmt4d_epilogue_params_t* epilogue = &params->epilogue;
+  if (params->flags & IREE_UK_FLAG_MMT4D_EPILOGUE_BIAS) {
+    const float* bias = (const float*)epilogue->bias_buffer;
+    bias += (iree_uk_ssize_t)tile_col_index * N0;
+    for (int i = 0; i < M0; ++i) {
+      for (int j = 0; j < N0; ++j) tile[i * N0 + j] += bias[j];
+    }
+  }
+  if (params->flags & IREE_UK_FLAG_MMT4D_EPILOGUE_CLAMP) {
+    const float lo = epilogue->clamp_min_f32;
+    const float hi = epilogue->clamp_max_f32;
+    for (int i = 0; i < M0 * N0; ++i) {
+      float v = tile[i];
+      tile[i] = v < lo ? lo : v > hi ? hi : v;
+    }
+  }
+}
+
+// |acc_tile| and |out_tile| alias unless requantizing, in which case
+// |out_tile| has i8 elements.
+static void iree_uk_mmt4d_epilogue_tile_i32(
+    const iree_uk_mmt4d_params_t* params, iree_uk_int32_t* acc_tile,
+    void* out_tile, iree_uk_int32_t tile_col_index) {
+  const iree_uk_int16_t M0 = params->M0;
+  const iree_uk_int16_t N0 = params->N0;
+  const iree_uk_mmt4d_epilogue_params_t* epilogue = &params->epilogue;
+  if (params->flags & IREE_UK_FLAG_MMT4D_EPILOGUE_BIAS) {
+    const iree_uk_int32_t* bias = (const iree_uk_int32_t*)epilogue->bias_buffer;
+    bias += (iree_uk_ssize_t)tile_col_index * N0;
+    for (int i = 0; i < M0; ++i) {
+      for (int j = 0; j < N0; ++j) acc_tile[i * N0 + j] += bias[j];
+    }
+  }
+  const bool clamp = params->flags & IREE_UK_FLAG_MMT4D_EPILOGUE_CLAMP;
+  const iree_uk_int32_t lo = epilogue->clamp_min_i32;
+  const iree_uk_int32_t hi = epilogue->clamp_max_i32;
+  if (params->flags & IREE_UK_FLAG_MMT4D_EPILOGUE_REQUANTIZE) {
+    iree_uk_int8_t* out = out_tile;
+    for (int i = 0; i < M0 * N0; ++i) {
+      iree_uk_int32_t v = iree_uk_mmt4d_rounding_doubling_high_mul(
+          acc_tile[i], epilogue->requant_multiplier);
+      v = iree_uk_mmt4d_rounding_divide_by_pot(v, epilogue->requant_shift);
+      v += epilogue->requant_zero_point;
+      if (clamp) v = v < lo ? lo : v > hi ? hi : v;
+      out[i] = v < -128 ? -128 : v > 127 ? 127 : v;
+    }
+  } else if (clamp) {
+    for (int i = 0; i < M0 * N0; ++i) {
+      iree_uk_int32_t v = acc_tile[i];
+      acc_tile[i] = v < lo ? lo : v > hi ? hi : v;
+    }
+  }
+}
+
+// Applies the epilogue requested by params->flags to one tile. This runs right
+// after the tile_func, while the tile is still hot in L1, so that the output
+// does not need a separate elementwise pass over memory.
+static void iree_uk_mmt4d_epilogue_tile(const iree_uk_mmt4d_params_t* params,
+                                        void* acc_tile, void* out_tile,
+                                        iree_uk_int32_t tile_col_index) {
+  iree_uk_type_t out_type = iree_uk_mmt4d_out_type(params->type);
+  if (iree_uk_type_category(out_type) == IREE_UK_TYPE_CATEGORY_FLOAT_IEEE) {
+    iree_uk_mmt4d_epilogue_tile_f32(params, acc_tile, tile_col_index);
+  } else {
+    iree_uk_mmt4d_epilogue_tile_i32(params, acc_tile, out_tile,
+                                    tile_col_index);
+  }
+}
+
+// L2 cache share assumed when cpu_data does not report one. This is on the
+// small side of current cores, erring towards blocks that are too small, which
+// only costs some LHS panel re-reads, rather than too large, which would evict
+// RHS panels before they are reused.
+enum { iree_uk_mmt4d_default_l2_cache_bytes = 256 * 1024 };
+
+// Returns the number of RHS panels to process as one block of the N dimension.
+// The block is traversed for all M rows before moving on to the next block, so
+// it is sized to fit half of the L2 cache share of this thread, leaving the
+// other half for the LHS panel, the output tiles and whatever else is running.
+// The cache size in cpu_data is already divided among the logical processors
+// sharing the cache, so this holds when every thread of a pool is running
+// mmt4d concurrently. Each RHS panel is then read from memory once per call
+// instead of once per row of tiles, which is what keeps large N*K problems
+// from being bound by DRAM bandwidth.
+static iree_uk_int32_t iree_uk_mmt4d_select_N_block(
+    const iree_uk_mmt4d_params_t* params, iree_uk_ssize_t rhs_panel_stride) {
+  iree_uk_ssize_t l2_cache_bytes =
+      ((params->cpu_data[1] & IREE_CPU_DATA_FIELD_1_L2_CACHE_KIB_MASK) >>
+       IREE_CPU_DATA_FIELD_1_L2_CACHE_KIB_SHIFT)
+      << 10;
+  if (!l2_cache_bytes) l2_cache_bytes = iree_uk_mmt4d_default_l2_cache_bytes;
+  // A single row of tiles never re-reads RHS panels, so blocking is moot.
+  if (params->M == 1 || !rhs_panel_stride) return params->N;
+  iree_uk_ssize_t N_block = (l2_cache_bytes / 2) / rhs_panel_stride;
+  if (N_block < 1) return 1;
+  if (N_block > params->N) return params->N;
+  return N_block;
+}
+
 // General mmt4d implementation, shared among all cases. The idea is that the
 // only really performance-critical part is the inner-most loop, and that's
 // handled by the tile_func passed as argument here. Sharing the outer loops
@@ -76,24 +285,66 @@ static void iree_uk_mmt4d_using_tile_func(const iree_uk_mmt4d_params_t* params,
   const iree_uk_type_t rhs_type = iree_uk_mmt4d_rhs_type(params->type);
   const iree_uk_type_t out_type = iree_uk_mmt4d_out_type(params->type);
   const iree_uk_int16_t lhs_elem_size_log2 = iree_uk_type_size_log2(lhs_type);
-  const iree_uk_int16_t rhs_elem_size_log2 = iree_uk_type_size_log2(rhs_type);
-  const iree_uk_int16_t out_elem_size_log2 = iree_uk_type_size_log2(out_type);
-  char* out_tile_row = params->out_buffer;
-  const char* lhs_panel = params->lhs_buffer;
+  const iree_uk_int16_t acc_elem_size_log2 = iree_uk_type_size_log2(out_type);
+  const iree_uk_int16_t out_elem_size_log2 =
+      iree_uk_type_size_log2(iree_uk_mmt4d_out_buffer_type(params));
+  const iree_uk_uint32_t epilogue_flags =
+      params->flags & IREE_UK_MMT4D_EPILOGUE_FLAGS;
+  const bool requantize =
+      params->flags & IREE_UK_FLAG_MMT4D_EPILOGUE_REQUANTIZE;
+  const bool rhs_quant = rhs_type == IREE_UK_TYPE_SINT_4;
+  // When requantizing, the tile_func accumulates into this scratch tile and
+  // the epilogue writes the narrowed values to the output buffer. With a
+  // quantized RHS, it holds the unscaled product of one group instead.
+  iree_uk_int32_t acc_tile_scratch[iree_uk_mmt4d_tile_generic_max_bytes /
+                                   sizeof(iree_uk_int32_t)];
+  iree_uk_int32_t acc_tile_size = (M0 * N0) << acc_elem_size_log2;
   iree_uk_int32_t out_tile_size = (M0 * N0) << out_elem_size_log2;
   iree_uk_ssize_t lhs_panel_stride = params->lhs_stride << lhs_elem_size_log2;
-  iree_uk_ssize_t rhs_panel_stride = params->rhs_stride << rhs_elem_size_log2;
+  iree_uk_ssize_t rhs_panel_stride =
+      iree_uk_type_bytes(rhs_type, params->rhs_stride);
   iree_uk_ssize_t out_stride = params->out_stride << out_elem_size_log2;
-  for (iree_uk_int32_t i = 0; i < M; ++i) {
-    char* out_tile = out_tile_row;
-    const char* rhs_panel = params->rhs_buffer;
-    for (iree_uk_int32_t j = 0; j < N; ++j) {
-      tile_func(out_tile, lhs_panel, rhs_panel, K, params->flags, params);
-      out_tile += out_tile_size;
-      rhs_panel += rhs_panel_stride;
+  const iree_uk_int32_t N_block =
+      iree_uk_mmt4d_select_N_block(params, rhs_panel_stride);
+  for (iree_uk_int32_t j_block = 0; j_block < N; j_block += N_block) {
+    const iree_uk_int32_t j_end =
+        N - j_block < N_block ? N : j_block + N_block;
+    char* out_tile_row = (char*)params->out_buffer +
+                         (iree_uk_ssize_t)j_block * out_tile_size;
+    const char* lhs_panel = params->lhs_buffer;
+    const char* rhs_block = (const char*)params->rhs_buffer +
+                            (iree_uk_ssize_t)j_block * rhs_panel_stride;
+    for (iree_uk_int32_t i = 0; i < M; ++i) {
+      char* out_tile = out_tile_row;
+      const char* rhs_panel = rhs_block;
+      for (iree_uk_int32_t j = j_block; j < j_end; ++j) {
+        // Prefetch the start of the panel that the next tile_func call will
+        // read first, so that it does not begin with a cache miss. Past that,
+        // hardware prefetchers keep up with the linear panel traversal.
+        if (j + 1 < j_end) {
+          IREE_UK_PREFETCH_RO(rhs_panel + rhs_panel_stride, 3);
+        } else if (i + 1 < M) {
+          IREE_UK_PREFETCH_RO(lhs_panel + lhs_panel_stride, 3);
+        }
+        void* acc_tile = requantize ? (void*)acc_tile_scratch : out_tile;
+        if (K > 0 && rhs_quant) {
+          iree_uk_mmt4d_tile_rhs_quant(params, tile_func, acc_tile, lhs_panel,
+                                       rhs_panel, j, (float*)acc_tile_scratch);
+        } else if (K > 0) {
+          tile_func(acc_tile, lhs_panel, rhs_panel, K, params->flags, params);
+        } else if (!(params->flags & IREE_UK_FLAG_ACCUMULATE)) {
+          // Only reached with an epilogue, see iree_uk_mmt4d_early.
+          iree_uk_memset(acc_tile, 0, acc_tile_size);
+        }
+        if (epilogue_flags) {
+          iree_uk_mmt4d_epilogue_tile(params, acc_tile, out_tile, j);
+        }
+        out_tile += out_tile_size;
+        rhs_panel += rhs_panel_stride;
+      }
+      out_tile_row += out_stride;
+      lhs_panel += lhs_panel_stride;
     }
-    out_tile_row += out_stride;
-    lhs_panel += lhs_panel_stride;
   }
 }
 
@@ -121,7 +372,9 @@ static bool iree_uk_mmt4d_early(const iree_uk_mmt4d_params_t* params) {
   if (params->M == 0 || params->N == 0) {
     return true;
   }
-  if (params->K == 0) {
+  // With K==0 an epilogue still has to run, so that case goes through the
+  // general path.
+  if (params->K == 0 && !(params->flags & IREE_UK_MMT4D_EPILOGUE_FLAGS)) {
     if (params->flags & IREE_UK_FLAG_ACCUMULATE) {
       // Nothing to do!
     } else {
@@ -151,3 +404,44 @@ iree_uk_mmt4d(const iree_uk_mmt4d_params_t* params) {
   iree_uk_mmt4d_using_tile_func(params, tile_func);
   return iree_uk_status_ok;
 }
+
+// Candidate tile shapes, from most to least preferred. The first one for which
+// the architecture provides a tile function on the current CPU is picked.
+typedef struct iree_uk_mmt4d_tile_shape_t {
+  iree_uk_int32_t M0;
+  iree_uk_int32_t N0;
+  iree_uk_int32_t K0;
+} iree_uk_mmt4d_tile_shape_t;
+
+static const iree_uk_mmt4d_tile_shape_t iree_uk_mmt4d_tile_shape_candidates[] =
+    {
+        {16, 16, 2}, {16, 16, 1}, {8, 16, 1}, {8, 8, 8},
+        {8, 8, 4},   {8, 8, 2},   {8, 8, 1},
+};
+
+IREE_UK_EXPORT iree_uk_status_t
+iree_uk_mmt4d_query_tile_sizes(iree_uk_mmt4d_params_t* params) {
+  const int candidate_count = sizeof(iree_uk_mmt4d_tile_shape_candidates) /
+                              sizeof(iree_uk_mmt4d_tile_shape_candidates[0]);
+  iree_uk_mmt4d_params_t probe_params = *params;
+  for (int i = 0; i < candidate_count; ++i) {
+    const iree_uk_mmt4d_tile_shape_t* shape =
+        &iree_uk_mmt4d_tile_shape_candidates[i];
+    probe_params.M0 = shape->M0;
+    probe_params.N0 = shape->N0;
+    probe_params.K0 = shape->K0;
+    if (iree_uk_mmt4d_select_tile_func_arch(&probe_params)) {
+      params->M0 = shape->M0;
+      params->N0 = shape->N0;
+      params->K0 = shape->K0;
+      return iree_uk_status_ok;
+    }
+  }
+  // No architecture-specific tile function: any shape works with the generic
+  // one. This matches what the compiler picks for targets it knows nothing
+  // about.
+  params->M0 = 8;
+  params->N0 = 8;
+  params->K0 = 4;
+  return iree_uk_status_ok;
+}
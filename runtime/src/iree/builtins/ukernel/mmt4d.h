@@ -17,6 +17,14 @@ extern "C" {
 IREE_UK_EXPORT iree_uk_status_t
 iree_uk_mmt4d(const iree_uk_mmt4d_params_t* params);
 
+// Sets the M0, N0 and K0 fields of |params| to the tile shape that a mmt4d of
+// type params->type should use on the CPU described by params->cpu_data, i.e.
+// the preferred shape that has an architecture-specific tile function there.
+// Lets the packed layout be chosen when a program is loaded instead of when it
+// is compiled. Other fields are ignored.
+IREE_UK_EXPORT iree_uk_status_t
+iree_uk_mmt4d_query_tile_sizes(iree_uk_mmt4d_params_t* params);
+
 #ifdef __cplusplus
 }  // extern "C"
 #endif  // __cplusplus
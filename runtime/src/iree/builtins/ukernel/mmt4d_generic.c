@@ -78,6 +78,144 @@ static void iree_uk_mmt4d_tile_f32f32f32_generic(
   for (int i = 0; i < M0 * N0; ++i) out_tile[i] = acc[i];
 }
 
+// Generic implementation of matmul tile, shared by the 16-bit floating-point
+// input cases. Inputs are widened to f32 and accumulation happens in f32;
+// 16-bit float outputs are widened on load and rounded once on store.
+static void iree_uk_mmt4d_tile_float16_generic(
+    void* out_tile_untyped, const void* lhs_panel_untyped,
+    const void* rhs_panel_untyped, iree_uk_int32_t K, iree_uk_uint32_t flags,
+    const iree_uk_mmt4d_params_t* params,
+    float (*to_f32)(iree_uk_uint16_t), bool out_f16) {
+  const iree_uk_uint16_t* lhs_panel = lhs_panel_untyped;
+  const iree_uk_uint16_t* rhs_panel = rhs_panel_untyped;
+  iree_uk_int16_t M0 = params->M0;
+  iree_uk_int16_t N0 = params->N0;
+  iree_uk_int16_t K0 = params->K0;
+  // Initialize the local accumulator tile.
+  float acc[iree_uk_mmt4d_tile_generic_max_bytes / sizeof(float)];
+  if (flags & IREE_UK_FLAG_ACCUMULATE) {
+    if (out_f16) {
+      const iree_uk_uint16_t* out_tile = out_tile_untyped;
+      for (int i = 0; i < M0 * N0; ++i) {
+        acc[i] = iree_uk_f16_to_f32(out_tile[i]);
+      }
+    } else {
+      const float* out_tile = out_tile_untyped;
+      for (int i = 0; i < M0 * N0; ++i) acc[i] = out_tile[i];
+    }
+  } else {
+    for (int i = 0; i < M0 * N0; ++i) acc[i] = 0;
+  }
+  // Accumulation loop.
+  for (iree_uk_ssize_t k = 0; k < K; ++k) {
+    for (iree_uk_ssize_t i0 = 0; i0 < M0; ++i0) {
+      for (iree_uk_ssize_t j0 = 0; j0 < N0; ++j0) {
+        for (iree_uk_ssize_t k0 = 0; k0 < K0; ++k0) {
+          float lhs_val = to_f32(lhs_panel[i0 * K0 + k0]);
+          float rhs_val = to_f32(rhs_panel[j0 * K0 + k0]);
+          acc[i0 * N0 + j0] += lhs_val * rhs_val;
+        }
+      }
+    }
+    lhs_panel += M0 * K0;
+    rhs_panel += N0 * K0;
+  }
+  // Store the local accumulator tile to the destination.
+  if (out_f16) {
+    iree_uk_uint16_t* out_tile = out_tile_untyped;
+    for (int i = 0; i < M0 * N0; ++i) out_tile[i] = iree_uk_f32_to_f16(acc[i]);
+  } else {
+    float* out_tile = out_tile_untyped;
+    for (int i = 0; i < M0 * N0; ++i) out_tile[i] = acc[i];
+  }
+}
+
+// Generic implementation of matmul tile, f16*f16->f32 case.
+static void iree_uk_mmt4d_tile_f16f16f32_generic(
+    void* out_tile, const void* lhs_panel, const void* rhs_panel,
+    iree_uk_int32_t K, iree_uk_uint32_t flags,
+    const iree_uk_mmt4d_params_t* params) {
+  iree_uk_mmt4d_tile_float16_generic(out_tile, lhs_panel, rhs_panel, K, flags,
+                                     params, iree_uk_f16_to_f32, false);
+}
+
+// Generic implementation of matmul tile, f16*f16->f16 case.
+static void iree_uk_mmt4d_tile_f16f16f16_generic(
+    void* out_tile, const void* lhs_panel, const void* rhs_panel,
+    iree_uk_int32_t K, iree_uk_uint32_t flags,
+    const iree_uk_mmt4d_params_t* params) {
+  iree_uk_mmt4d_tile_float16_generic(out_tile, lhs_panel, rhs_panel, K, flags,
+                                     params, iree_uk_f16_to_f32, true);
+}
+
+// Generic implementation of matmul tile, bf16*bf16->f32 case.
+static void iree_uk_mmt4d_tile_bf16bf16f32_generic(
+    void* out_tile, const void* lhs_panel, const void* rhs_panel,
+    iree_uk_int32_t K, iree_uk_uint32_t flags,
+    const iree_uk_mmt4d_params_t* params) {
+  iree_uk_mmt4d_tile_float16_generic(out_tile, lhs_panel, rhs_panel, K, flags,
+                                     params, iree_uk_bf16_to_f32, false);
+}
+
+// Generic implementation of matmul tile, shared by the cases with an int4 RHS.
+// Computes the unscaled product: scales are applied by the caller.
+static void iree_uk_mmt4d_tile_xi4f32_generic(
+    void* out_tile_untyped, const void* lhs_panel_untyped,
+    const void* rhs_panel, iree_uk_int32_t K, iree_uk_uint32_t flags,
+    const iree_uk_mmt4d_params_t* params, bool lhs_f16) {
+  float* out_tile = out_tile_untyped;
+  iree_uk_int16_t M0 = params->M0;
+  iree_uk_int16_t N0 = params->N0;
+  iree_uk_int16_t K0 = params->K0;
+  // Initialize the local accumulator tile.
+  float acc[iree_uk_mmt4d_tile_generic_max_bytes / sizeof(*out_tile)];
+  if (flags & IREE_UK_FLAG_ACCUMULATE) {
+    for (int i = 0; i < M0 * N0; ++i) acc[i] = out_tile[i];
+  } else {
+    for (int i = 0; i < M0 * N0; ++i) acc[i] = 0;
+  }
+  // Accumulation loop. The RHS is indexed in elements, not bytes.
+  iree_uk_ssize_t rhs_offset = 0;
+  for (iree_uk_ssize_t k = 0; k < K; ++k) {
+    for (iree_uk_ssize_t i0 = 0; i0 < M0; ++i0) {
+      for (iree_uk_ssize_t j0 = 0; j0 < N0; ++j0) {
+        for (iree_uk_ssize_t k0 = 0; k0 < K0; ++k0) {
+          iree_uk_ssize_t lhs_index = (k * M0 + i0) * K0 + k0;
+          float lhs_val =
+              lhs_f16
+                  ? iree_uk_f16_to_f32(
+                        ((const iree_uk_uint16_t*)lhs_panel_untyped)[lhs_index])
+                  : ((const float*)lhs_panel_untyped)[lhs_index];
+          float rhs_val =
+              iree_uk_sint4_load(rhs_panel, rhs_offset + j0 * K0 + k0);
+          acc[i0 * N0 + j0] += lhs_val * rhs_val;
+        }
+      }
+    }
+    rhs_offset += N0 * K0;
+  }
+  // Store the local accumulator tile to the destination.
+  for (int i = 0; i < M0 * N0; ++i) out_tile[i] = acc[i];
+}
+
+// Generic implementation of matmul tile, f32*i4->f32 case.
+static void iree_uk_mmt4d_tile_f32i4f32_generic(
+    void* out_tile, const void* lhs_panel, const void* rhs_panel,
+    iree_uk_int32_t K, iree_uk_uint32_t flags,
+    const iree_uk_mmt4d_params_t* params) {
+  iree_uk_mmt4d_tile_xi4f32_generic(out_tile, lhs_panel, rhs_panel, K, flags,
+                                    params, false);
+}
+
+// Generic implementation of matmul tile, f16*i4->f32 case.
+static void iree_uk_mmt4d_tile_f16i4f32_generic(
+    void* out_tile, const void* lhs_panel, const void* rhs_panel,
+    iree_uk_int32_t K, iree_uk_uint32_t flags,
+    const iree_uk_mmt4d_params_t* params) {
+  iree_uk_mmt4d_tile_xi4f32_generic(out_tile, lhs_panel, rhs_panel, K, flags,
+                                    params, true);
+}
+
 // Generic implementation of matmul tile
 iree_uk_mmt4d_tile_func_t iree_uk_mmt4d_select_tile_func_generic(
     const iree_uk_mmt4d_params_t* params) {
@@ -86,6 +224,16 @@ iree_uk_mmt4d_tile_func_t iree_uk_mmt4d_select_tile_func_generic(
       return iree_uk_mmt4d_tile_f32f32f32_generic;
     case iree_uk_mmt4d_type_i8i8i32:
       return iree_uk_mmt4d_tile_i8i8i32_generic;
+    case iree_uk_mmt4d_type_f16f16f32:
+      return iree_uk_mmt4d_tile_f16f16f32_generic;
+    case iree_uk_mmt4d_type_f16f16f16:
+      return iree_uk_mmt4d_tile_f16f16f16_generic;
+    case iree_uk_mmt4d_type_bf16bf16f32:
+      return iree_uk_mmt4d_tile_bf16bf16f32_generic;
+    case iree_uk_mmt4d_type_f32i4f32:
+      return iree_uk_mmt4d_tile_f32i4f32_generic;
+    case iree_uk_mmt4d_type_f16i4f32:
+      return iree_uk_mmt4d_tile_f16i4f32_generic;
     default:
       // shouldn't happen, validated earlier.
       IREE_UK_ASSUME_UNREACHABLE;
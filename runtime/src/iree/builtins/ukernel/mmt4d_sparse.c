@@ -0,0 +1,199 @@
+// Copyright 2023 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include "iree/builtins/ukernel/mmt4d_sparse.h"
+
+#include "iree/builtins/ukernel/arch/mmt4d_arch.h"
+#include "iree/builtins/ukernel/mmt4d_generic.h"
+
+static iree_uk_status_t iree_uk_mmt4d_sparse_validate_type_and_tile(
+    iree_uk_mmt4d_type_t type, iree_uk_int32_t M0, iree_uk_int32_t N0,
+    iree_uk_int32_t K0) {
+#ifdef IREE_UK_ENABLE_VALIDATION
+  switch (type) {
+    case iree_uk_mmt4d_type_f32f32f32:
+    case iree_uk_mmt4d_type_i8i8i32:
+    case iree_uk_mmt4d_type_f16f16f32:
+    case iree_uk_mmt4d_type_bf16bf16f32:
+      break;
+    // f16f16f16 tile functions round the output once per call, and a sparse
+    // panel takes one call per run of consecutive stored tiles, so results
+    // would depend on the sparsity pattern.
+    default:
+      return iree_uk_status_bad_type;
+  }
+  if (!(IREE_UK_VALUE_IN_UNSIGNED_INT_RANGE(M0, 15) &&
+        IREE_UK_VALUE_IN_UNSIGNED_INT_RANGE(N0, 15) &&
+        IREE_UK_VALUE_IN_UNSIGNED_INT_RANGE(K0, 15))) {
+    return iree_uk_status_unsupported_huge_or_negative_dimension;
+  }
+  iree_uk_type_t out_type = iree_uk_mmt4d_out_type(type);
+  if ((M0 * N0) << iree_uk_type_size_log2(out_type) >
+      iree_uk_mmt4d_tile_generic_max_bytes) {
+    return iree_uk_status_unsupported_generic_tile_size;
+  }
+#endif  // IREE_UK_ENABLE_VALIDATION
+  return iree_uk_status_ok;
+}
+
+static iree_uk_status_t iree_uk_mmt4d_sparse_validate(
+    const iree_uk_mmt4d_sparse_params_t* params) {
+#ifdef IREE_UK_ENABLE_VALIDATION
+  if (params->flags & ~IREE_UK_FLAG_ACCUMULATE) {
+    return iree_uk_status_bad_flags;
+  }
+  if (!(IREE_UK_VALUE_IN_UNSIGNED_INT_RANGE(params->M, 31) &&
+        IREE_UK_VALUE_IN_UNSIGNED_INT_RANGE(params->N, 31) &&
+        IREE_UK_VALUE_IN_UNSIGNED_INT_RANGE(params->K, 31))) {
+    return iree_uk_status_unsupported_huge_or_negative_dimension;
+  }
+#endif  // IREE_UK_ENABLE_VALIDATION
+  return iree_uk_mmt4d_sparse_validate_type_and_tile(
+      params->type, params->M0, params->N0, params->K0);
+}
+
+// Returns the dense mmt4d params that tile functions see. Tile functions only
+// read the type and tile sizes from params, and are called on one contiguous
+// run of RHS tiles at a time, so the RHS stride is never used.
+static iree_uk_mmt4d_params_t iree_uk_mmt4d_sparse_dense_params(
+    const iree_uk_mmt4d_sparse_params_t* params) {
+  iree_uk_mmt4d_params_t dense_params = {
+      .type = params->type,
+      .flags = params->flags,
+      .lhs_stride = params->lhs_stride,
+      .out_stride = params->out_stride,
+      .M = params->M,
+      .N = params->N,
+      .K = params->K,
+      .M0 = params->M0,
+      .N0 = params->N0,
+      .K0 = params->K0,
+      .lhs_buffer = params->lhs_buffer,
+      .out_buffer = params->out_buffer,
+      .cpu_data = params->cpu_data,
+  };
+  return dense_params;
+}
+
+IREE_UK_EXPORT iree_uk_status_t
+iree_uk_mmt4d_sparse(const iree_uk_mmt4d_sparse_params_t* params) {
+  IREE_UK_RETURN_IF_ERROR(iree_uk_mmt4d_sparse_validate(params));
+  if (params->M == 0 || params->N == 0) return iree_uk_status_ok;
+
+  // Use the same tile functions as dense mmt4d. Each call processes a run of
+  // consecutive stored tiles of one RHS panel against the matching contiguous
+  // LHS tiles, accumulating into the output tile after the first run.
+  iree_uk_mmt4d_params_t dense_params =
+      iree_uk_mmt4d_sparse_dense_params(params);
+  iree_uk_mmt4d_tile_func_t tile_func =
+      iree_uk_mmt4d_select_tile_func_arch(&dense_params);
+  if (!tile_func) {
+    tile_func = iree_uk_mmt4d_select_tile_func_generic(&dense_params);
+  }
+
+  const iree_uk_int32_t M = params->M;
+  const iree_uk_int32_t N = params->N;
+  const iree_uk_int16_t M0 = params->M0;
+  const iree_uk_int16_t N0 = params->N0;
+  const iree_uk_int16_t K0 = params->K0;
+  const iree_uk_type_t lhs_type = iree_uk_mmt4d_lhs_type(params->type);
+  const iree_uk_type_t rhs_type = iree_uk_mmt4d_rhs_type(params->type);
+  const iree_uk_type_t out_type = iree_uk_mmt4d_out_type(params->type);
+  const iree_uk_int16_t lhs_elem_size_log2 = iree_uk_type_size_log2(lhs_type);
+  const iree_uk_int16_t rhs_elem_size_log2 = iree_uk_type_size_log2(rhs_type);
+  const iree_uk_int16_t out_elem_size_log2 = iree_uk_type_size_log2(out_type);
+  const iree_uk_ssize_t lhs_tile_size = (M0 * K0) << lhs_elem_size_log2;
+  const iree_uk_ssize_t rhs_tile_size = (N0 * K0) << rhs_elem_size_log2;
+  const iree_uk_int32_t out_tile_size = (M0 * N0) << out_elem_size_log2;
+  const iree_uk_ssize_t lhs_panel_stride = params->lhs_stride
+                                           << lhs_elem_size_log2;
+  const iree_uk_ssize_t out_stride = params->out_stride << out_elem_size_log2;
+  const iree_uk_int32_t* row_offsets = params->rhs_row_offsets;
+  const iree_uk_int32_t* col_indices = params->rhs_col_indices;
+  char* out_tile_row = params->out_buffer;
+  const char* lhs_panel = params->lhs_buffer;
+  for (iree_uk_int32_t i = 0; i < M; ++i) {
+    char* out_tile = out_tile_row;
+    for (iree_uk_int32_t j = 0; j < N; ++j) {
+      iree_uk_uint32_t flags = params->flags;
+      iree_uk_int32_t t = row_offsets[j];
+      const iree_uk_int32_t t_end = row_offsets[j + 1];
+      if (t == t_end && !(flags & IREE_UK_FLAG_ACCUMULATE)) {
+        iree_uk_memset(out_tile, 0, out_tile_size);
+      }
+      while (t < t_end) {
+        // Extend the run while the stored tiles are consecutive along K.
+        const iree_uk_int32_t k = col_indices[t];
+        iree_uk_int32_t run = 1;
+        while (t + run < t_end && col_indices[t + run] == k + run) ++run;
+        tile_func(out_tile, lhs_panel + k * lhs_tile_size,
+                  (const char*)params->rhs_values + t * rhs_tile_size, run,
+                  flags, &dense_params);
+        flags |= IREE_UK_FLAG_ACCUMULATE;
+        t += run;
+      }
+      out_tile += out_tile_size;
+    }
+    out_tile_row += out_stride;
+    lhs_panel += lhs_panel_stride;
+  }
+  return iree_uk_status_ok;
+}
+
+static iree_uk_status_t iree_uk_mmt4d_sparse_pack_rhs_validate(
+    const iree_uk_mmt4d_sparse_pack_rhs_params_t* params) {
+#ifdef IREE_UK_ENABLE_VALIDATION
+  if (params->flags) {
+    return iree_uk_status_bad_flags;
+  }
+  if (!(IREE_UK_VALUE_IN_UNSIGNED_INT_RANGE(params->N, 31) &&
+        IREE_UK_VALUE_IN_UNSIGNED_INT_RANGE(params->K, 31) &&
+        IREE_UK_VALUE_IN_UNSIGNED_INT_RANGE(params->N * params->K, 31))) {
+    return iree_uk_status_unsupported_huge_or_negative_dimension;
+  }
+#endif  // IREE_UK_ENABLE_VALIDATION
+  return iree_uk_mmt4d_sparse_validate_type_and_tile(params->type, 1,
+                                                     params->N0, params->K0);
+}
+
+static bool iree_uk_mmt4d_sparse_is_zero_tile(const char* tile,
+                                              iree_uk_ssize_t size) {
+  for (iree_uk_ssize_t i = 0; i < size; ++i) {
+    if (tile[i]) return false;
+  }
+  return true;
+}
+
+IREE_UK_EXPORT iree_uk_status_t iree_uk_mmt4d_sparse_pack_rhs(
+    const iree_uk_mmt4d_sparse_pack_rhs_params_t* params) {
+  IREE_UK_RETURN_IF_ERROR(iree_uk_mmt4d_sparse_pack_rhs_validate(params));
+  const iree_uk_type_t rhs_type = iree_uk_mmt4d_rhs_type(params->type);
+  const iree_uk_int16_t rhs_elem_size_log2 = iree_uk_type_size_log2(rhs_type);
+  const iree_uk_ssize_t tile_size = (params->N0 * params->K0)
+                                    << rhs_elem_size_log2;
+  const iree_uk_ssize_t in_stride = params->in_stride << rhs_elem_size_log2;
+  const char* in_panel = params->in_buffer;
+  char* out_values = params->out_values;
+  iree_uk_int32_t count = 0;
+  for (iree_uk_int32_t j = 0; j < params->N; ++j) {
+    params->out_row_offsets[j] = count;
+    const char* in_tile = in_panel;
+    for (iree_uk_int32_t k = 0; k < params->K; ++k) {
+      // Tiles are compared bitwise, so e.g. a tile of -0.0f is kept. That is
+      // only a missed skip, never a wrong result.
+      if (!iree_uk_mmt4d_sparse_is_zero_tile(in_tile, tile_size)) {
+        params->out_col_indices[count] = k;
+        iree_uk_memcpy(out_values, in_tile, tile_size);
+        out_values += tile_size;
+        ++count;
+      }
+      in_tile += tile_size;
+    }
+    in_panel += in_stride;
+  }
+  params->out_row_offsets[params->N] = count;
+  return iree_uk_status_ok;
+}
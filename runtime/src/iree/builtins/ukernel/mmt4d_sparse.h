@@ -0,0 +1,28 @@
+// Copyright 2023 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#ifndef IREE_BUILTINS_UKERNEL_MMT4D_SPARSE_H_
+#define IREE_BUILTINS_UKERNEL_MMT4D_SPARSE_H_
+
+#include "iree/builtins/ukernel/mmt4d_sparse_types.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif  // __cplusplus
+
+// Main entry point: mmt4d with a block-sparse RHS.
+IREE_UK_EXPORT iree_uk_status_t
+iree_uk_mmt4d_sparse(const iree_uk_mmt4d_sparse_params_t* params);
+
+// Converts a dense packed RHS to the block-sparse RHS format.
+IREE_UK_EXPORT iree_uk_status_t iree_uk_mmt4d_sparse_pack_rhs(
+    const iree_uk_mmt4d_sparse_pack_rhs_params_t* params);
+
+#ifdef __cplusplus
+}  // extern "C"
+#endif  // __cplusplus
+
+#endif  // IREE_BUILTINS_UKERNEL_MMT4D_SPARSE_H_
@@ -0,0 +1,69 @@
+// Copyright 2023 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#ifndef IREE_BUILTINS_UKERNEL_MMT4D_SPARSE_TYPES_H_
+#define IREE_BUILTINS_UKERNEL_MMT4D_SPARSE_TYPES_H_
+
+#include "iree/builtins/ukernel/mmt4d_types.h"
+
+// Block-sparse RHS format.
+//
+// The sparsity granularity is the N0xK0 tile of the dense mmt4d RHS layout:
+// each tile is either stored or known to be zero. This is a block compressed
+// sparse row (BSR) layout where the "rows" are the N panels of the RHS:
+// - row_offsets has N+1 entries. Panel j stores the tiles at positions
+//   [row_offsets[j], row_offsets[j+1]) of col_indices and values, and
+//   row_offsets[N] is the total count of stored tiles.
+// - col_indices gives the K index of each stored tile, strictly increasing
+//   within a panel.
+// - values holds the stored tiles back to back, each laid out exactly like a
+//   tile of the dense RHS (N0 rows of K0 contiguous elements).
+// Picking the tile size to match the pruning block size (e.g. 4x4 blocks with
+// N0=4, K0=4, or 8x1 blocks with the f32 tile) makes every pruned block a
+// skipped tile.
+
+// Parameters for a block-sparse mmt4d operation: same as
+// iree_uk_mmt4d_params_t, except that the RHS is in the block-sparse format
+// above.
+typedef struct iree_uk_mmt4d_sparse_params_t {
+  iree_uk_mmt4d_type_t type;
+  iree_uk_uint32_t flags;
+  iree_uk_ssize_t lhs_stride;
+  iree_uk_ssize_t out_stride;
+  iree_uk_ssize_t M;
+  iree_uk_ssize_t N;
+  iree_uk_ssize_t K;
+  iree_uk_int32_t M0;
+  iree_uk_int32_t N0;
+  iree_uk_int32_t K0;
+  const void* lhs_buffer;
+  const iree_uk_int32_t* rhs_row_offsets;
+  const iree_uk_int32_t* rhs_col_indices;
+  const void* rhs_values;
+  void* out_buffer;
+  const iree_uk_uint64_t* cpu_data;
+} iree_uk_mmt4d_sparse_params_t;
+
+// Parameters for converting a dense RHS, as produced by pack for the RHS of
+// mmt4d, to the block-sparse format above, dropping all-zero tiles. The output
+// buffers must be sized for the dense case: N+1 row offsets, N*K column
+// indices and N*K tiles of values. The actual count of stored tiles is
+// written to out_row_offsets[N].
+typedef struct iree_uk_mmt4d_sparse_pack_rhs_params_t {
+  iree_uk_mmt4d_type_t type;
+  iree_uk_uint32_t flags;
+  iree_uk_ssize_t in_stride;
+  iree_uk_ssize_t N;
+  iree_uk_ssize_t K;
+  iree_uk_int32_t N0;
+  iree_uk_int32_t K0;
+  const void* in_buffer;
+  iree_uk_int32_t* out_row_offsets;
+  iree_uk_int32_t* out_col_indices;
+  void* out_values;
+} iree_uk_mmt4d_sparse_pack_rhs_params_t;
+
+#endif  // IREE_BUILTINS_UKERNEL_MMT4D_SPARSE_TYPES_H_
@@ -14,6 +14,23 @@ typedef enum iree_uk_mmt4d_type_t {
       IREE_UK_TIE_3_TYPES_LITERAL(FLOAT_32, FLOAT_32, FLOAT_32),
   iree_uk_mmt4d_type_i8i8i32 =
       IREE_UK_TIE_3_TYPES_LITERAL(INT_8, INT_8, INT_32),
+  iree_uk_mmt4d_type_f16f16f32 =
+      IREE_UK_TIE_3_TYPES_LITERAL(FLOAT_16, FLOAT_16, FLOAT_32),
+  // Accumulation happens in f32 within each tile function call, i.e. the
+  // output tile is rounded to f16 once per call rather than once per step.
+  iree_uk_mmt4d_type_f16f16f16 =
+      IREE_UK_TIE_3_TYPES_LITERAL(FLOAT_16, FLOAT_16, FLOAT_16),
+  iree_uk_mmt4d_type_bf16bf16f32 =
+      IREE_UK_TIE_3_TYPES_LITERAL(BFLOAT_16, BFLOAT_16, FLOAT_32),
+  // Weight-only quantized types: the RHS holds signed 4-bit values, packed two
+  // per byte, that are dequantized by per-group scales. See
+  // iree_uk_mmt4d_rhs_quant_params_t. Tile functions for these types compute
+  // the unscaled product with the int4 values: the caller applies the scales
+  // one group of K tiles at a time.
+  iree_uk_mmt4d_type_f32i4f32 =
+      IREE_UK_TIE_3_TYPES_LITERAL(FLOAT_32, SINT_4, FLOAT_32),
+  iree_uk_mmt4d_type_f16i4f32 =
+      IREE_UK_TIE_3_TYPES_LITERAL(FLOAT_16, SINT_4, FLOAT_32),
 } iree_uk_mmt4d_type_t;
 
 static inline iree_uk_type_t iree_uk_mmt4d_lhs_type(iree_uk_mmt4d_type_t type) {
@@ -28,6 +45,49 @@ static inline iree_uk_type_t iree_uk_mmt4d_out_type(iree_uk_mmt4d_type_t type) {
   return iree_uk_untie_type(2, type);
 }
 
+// Parameters for the fused epilogue of a mmt4d operation. Each field is only
+// read when the corresponding IREE_UK_FLAG_MMT4D_EPILOGUE_* bit is set in
+// iree_uk_mmt4d_params_t::flags, so zero-initializing the struct is enough
+// when no epilogue is requested.
+typedef struct iree_uk_mmt4d_epilogue_params_t {
+  // IREE_UK_FLAG_MMT4D_EPILOGUE_BIAS: N*N0 values of the accumulator type
+  // (f32 or i32), one per output column, added to every row of the output.
+  const void* bias_buffer;
+  // IREE_UK_FLAG_MMT4D_EPILOGUE_REQUANTIZE: the i32 accumulator is scaled by
+  // requant_multiplier * 2^(-31 - requant_shift) with round-to-nearest, offset
+  // by requant_zero_point and saturated to i8, so that the output buffer has
+  // i8 elements. requant_shift must be in [0, 31).
+  iree_uk_int32_t requant_multiplier;
+  iree_uk_int32_t requant_shift;
+  iree_uk_int32_t requant_zero_point;
+  // IREE_UK_FLAG_MMT4D_EPILOGUE_CLAMP: bounds applied last, in the output
+  // element type domain (f32 for float outputs, i32 for integer outputs, and
+  // the i8 values before saturation when requantizing).
+  float clamp_min_f32;
+  float clamp_max_f32;
+  iree_uk_int32_t clamp_min_i32;
+  iree_uk_int32_t clamp_max_i32;
+} iree_uk_mmt4d_epilogue_params_t;
+
+// Parameters for the mmt4d types with a quantized RHS, such as f32i4f32.
+// Ignored for other types.
+//
+// Each RHS tile is N0xK0 row-major like for other types, with the int4 values
+// packed two per byte, the even-indexed one in the low nibble. N0*K0 and
+// rhs_stride must be even so that every tile starts on a byte boundary. The
+// values are symmetrically quantized: RHS element (k, n) of the unpacked
+// matrix dequantizes to its int4 value times the f32 scale for column n and
+// group k / (group_size * K0).
+typedef struct iree_uk_mmt4d_rhs_quant_params_t {
+  // Scales for RHS panel j, group g, column n0 of the panel are at
+  // scales_buffer[j * scales_stride + g * N0 + n0].
+  const float* scales_buffer;
+  iree_uk_ssize_t scales_stride;
+  // Number of consecutive K tiles sharing scales. The last group of a panel
+  // may be shorter.
+  iree_uk_int32_t group_size;
+} iree_uk_mmt4d_rhs_quant_params_t;
+
 // Parameters for a mmt4d operation.
 typedef struct iree_uk_mmt4d_params_t {
   iree_uk_mmt4d_type_t type;
@@ -45,8 +105,19 @@ typedef struct iree_uk_mmt4d_params_t {
   const void* rhs_buffer;
   void* out_buffer;
   const iree_uk_uint64_t* cpu_data;
+  iree_uk_mmt4d_epilogue_params_t epilogue;
+  iree_uk_mmt4d_rhs_quant_params_t rhs_quant;
 } iree_uk_mmt4d_params_t;
 
+// Returns the element type of the output buffer, which is the accumulator
+// type except when requantizing.
+static inline iree_uk_type_t iree_uk_mmt4d_out_buffer_type(
+    const iree_uk_mmt4d_params_t* params) {
+  return (params->flags & IREE_UK_FLAG_MMT4D_EPILOGUE_REQUANTIZE)
+             ? IREE_UK_TYPE_INT_8
+             : iree_uk_mmt4d_out_type(params->type);
+}
+
 // Function pointer type for tile functions, i.e. typically architecture
 // specific functions computing one M0xN0 tile of the output matrix, i.e.
 // the inner-most loop of the matmul, i.e. the thing that we should actually
@@ -21,6 +21,9 @@ static iree_uk_status_t iree_uk_pack_validate(
     case iree_uk_pack_type_f32f32:
     case iree_uk_pack_type_i8i8:
     case iree_uk_pack_type_i32i32:
+    case iree_uk_pack_type_f16f16:
+    case iree_uk_pack_type_bf16bf16:
+    case iree_uk_pack_type_i4i4:
       break;
     default:
       return iree_uk_status_bad_type;
@@ -132,11 +135,69 @@ static void iree_uk_pack_using_tile_func(const iree_uk_pack_params_t* params,
   }
 }
 
+// Stores |value| as element |i| of a buffer of 4-bit values.
+static void iree_uk_pack_store_4bit(void* buffer, iree_uk_ssize_t i,
+                                    iree_uk_int32_t value) {
+  iree_uk_uint8_t* byte = (iree_uk_uint8_t*)buffer + (i >> 1);
+  int shift = (i & 1) << 2;
+  *byte = (*byte & ~(0xF << shift)) | ((value & 0xF) << shift);
+}
+
+// Tile functions address whole bytes, so sub-byte element types are packed
+// here one element at a time instead. That is fine for the weights that these
+// types are used for, which get packed once ahead of time.
+static void iree_uk_pack_4bit(const iree_uk_pack_params_t* params) {
+  iree_uk_ssize_t outer_size0 = params->out_size0;
+  iree_uk_ssize_t outer_size1 = params->out_size1;
+  iree_uk_ssize_t tile_size0 = params->out_size2;
+  iree_uk_ssize_t tile_size1 = params->out_size3;
+  iree_uk_ssize_t out_stride_l0 = params->out_stride0;
+  iree_uk_ssize_t out_stride_l1 = params->out_size3 * params->out_size2;
+  iree_uk_ssize_t out_stride_l2 = params->out_size3;
+  iree_uk_ssize_t out_stride_l3 = 1;
+  if (params->flags & IREE_UK_FLAG_PACK_TRANSPOSE_OUTER) {
+    iree_uk_ssize_swap(&outer_size0, &outer_size1);
+    iree_uk_ssize_swap(&out_stride_l0, &out_stride_l1);
+  }
+  if (params->flags & IREE_UK_FLAG_PACK_TRANSPOSE_INNER) {
+    iree_uk_ssize_swap(&tile_size0, &tile_size1);
+    iree_uk_ssize_swap(&out_stride_l2, &out_stride_l3);
+  }
+  const iree_uk_int32_t padding =
+      *(const iree_uk_uint8_t*)params->padding_value;
+  for (iree_uk_ssize_t outer_i0 = 0; outer_i0 < outer_size0; ++outer_i0) {
+    for (iree_uk_ssize_t outer_i1 = 0; outer_i1 < outer_size1; ++outer_i1) {
+      iree_uk_ssize_t out_tile_offset =
+          outer_i0 * out_stride_l0 + outer_i1 * out_stride_l1;
+      for (iree_uk_ssize_t tile_i0 = 0; tile_i0 < tile_size0; ++tile_i0) {
+        for (iree_uk_ssize_t tile_i1 = 0; tile_i1 < tile_size1; ++tile_i1) {
+          iree_uk_ssize_t i0 = outer_i0 * tile_size0 + tile_i0;
+          iree_uk_ssize_t i1 = outer_i1 * tile_size1 + tile_i1;
+          iree_uk_int32_t value =
+              (i0 >= params->in_size0 || i1 >= params->in_size1)
+                  ? padding
+                  : iree_uk_sint4_load(params->in_buffer,
+                                       i1 + i0 * params->in_stride0);
+          iree_uk_pack_store_4bit(params->out_buffer,
+                                  out_tile_offset + tile_i0 * out_stride_l2 +
+                                      tile_i1 * out_stride_l3,
+                                  value);
+        }
+      }
+    }
+  }
+}
+
 iree_uk_status_t iree_uk_pack(const iree_uk_pack_params_t* params) {
   IREE_UK_RETURN_IF_ERROR(iree_uk_pack_validate(params));
 
   if (iree_uk_pack_early(params)) return iree_uk_status_ok;
 
+  if (iree_uk_type_bit_count(iree_uk_pack_in_type(params->type)) < 8) {
+    iree_uk_pack_4bit(params);
+    return iree_uk_status_ok;
+  }
+
   // Select a target-specific tile_func (inner loop on K, computing one M0xN0
   // tile) and use that with generic outer loops.
   iree_uk_pack_tile_func_t row_func = iree_uk_pack_select_tile_func(params);
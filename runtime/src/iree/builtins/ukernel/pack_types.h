@@ -15,6 +15,14 @@ typedef enum iree_uk_pack_type_t {
   iree_uk_pack_type_f32f32 = IREE_UK_TIE_2_TYPES_LITERAL(FLOAT_32, FLOAT_32),
   iree_uk_pack_type_i8i8 = IREE_UK_TIE_2_TYPES_LITERAL(INT_8, INT_8),
   iree_uk_pack_type_i32i32 = IREE_UK_TIE_2_TYPES_LITERAL(INT_32, INT_32),
+  iree_uk_pack_type_f16f16 = IREE_UK_TIE_2_TYPES_LITERAL(FLOAT_16, FLOAT_16),
+  iree_uk_pack_type_bf16bf16 =
+      IREE_UK_TIE_2_TYPES_LITERAL(BFLOAT_16, BFLOAT_16),
+  // Signed 4-bit values, packed two per byte with the even-indexed one in the
+  // low nibble, in the input and output buffers alike. Strides and sizes are
+  // in elements. The padding value is the low nibble of the byte pointed to by
+  // padding_value.
+  iree_uk_pack_type_i4i4 = IREE_UK_TIE_2_TYPES_LITERAL(SINT_4, SINT_4),
 } iree_uk_pack_type_t;
 
 static inline iree_uk_type_t iree_uk_pack_in_type(iree_uk_pack_type_t type) {
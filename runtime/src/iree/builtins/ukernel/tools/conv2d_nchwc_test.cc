@@ -0,0 +1,256 @@
+// Copyright 2023 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+// Tests the data-tiled direct convolution against a scalar reference
+// convolution on the same tiled layouts.
+
+#include "iree/builtins/ukernel/conv2d_nchwc.h"
+
+#include <vector>
+
+#include "iree/base/api.h"
+#include "iree/base/internal/cpu.h"
+#include "iree/builtins/ukernel/tools/ukernel_test_utils.h"
+#include "iree/testing/gtest.h"
+#include "iree/testing/status_matchers.h"
+
+static void check_ok(iree_uk_status_t status, const char* what) {
+  if (status != iree_uk_status_ok) {
+    fprintf(stderr, "FATAL: %s failed: %s\n", what,
+            iree_uk_status_message(status));
+    iree_abort();
+  }
+}
+
+// Returns element |index| of |buffer| of type |type| as a double. Test values
+// are small integers, so all supported types convert exactly.
+static double read_element(iree_uk_type_t type, const void* buffer,
+                           iree_uk_ssize_t index) {
+  switch (type) {
+    case IREE_UK_TYPE_FLOAT_32:
+      return ((const float*)buffer)[index];
+    case IREE_UK_TYPE_INT_32:
+      return ((const iree_uk_int32_t*)buffer)[index];
+    case IREE_UK_TYPE_INT_8:
+      return ((const iree_uk_int8_t*)buffer)[index];
+    case IREE_UK_TYPE_FLOAT_16:
+      return iree_uk_f16_to_f32(((const iree_uk_uint16_t*)buffer)[index]);
+    case IREE_UK_TYPE_BFLOAT_16:
+      return iree_uk_bf16_to_f32(((const iree_uk_uint16_t*)buffer)[index]);
+    default:
+      iree_abort();
+      return 0;
+  }
+}
+
+struct conv_shape_t {
+  int n, c1, h, w, oc1, kh, kw;
+  int stride_h, stride_w, dilation_h, dilation_w, pad_h, pad_w;
+};
+
+static int output_size(int in, int k, int stride, int dilation, int pad) {
+  int padded = in + 2 * pad - dilation * (k - 1) - 1;
+  return padded < 0 ? 0 : padded / stride + 1;
+}
+
+static void test_one_conv(iree_uk_mmt4d_type_t type, int M0, int N0, int K0,
+                          const conv_shape_t& s, iree_uk_uint32_t flags,
+                          const iree_uk_uint64_t* cpu_data,
+                          iree_uk_test_random_engine_t* engine) {
+  iree_uk_type_t in_type = iree_uk_mmt4d_lhs_type(type);
+  iree_uk_type_t filter_type = iree_uk_mmt4d_rhs_type(type);
+  iree_uk_type_t out_type = iree_uk_mmt4d_out_type(type);
+  int oh_size = output_size(s.h, s.kh, s.stride_h, s.dilation_h, s.pad_h);
+  int ow_size = output_size(s.w, s.kw, s.stride_w, s.dilation_w, s.pad_w);
+  iree_uk_ssize_t in_count = (iree_uk_ssize_t)s.n * s.c1 * s.h * s.w * K0;
+  iree_uk_ssize_t filter_count =
+      (iree_uk_ssize_t)s.oc1 * s.c1 * s.kh * s.kw * N0 * K0;
+  iree_uk_ssize_t out_count =
+      (iree_uk_ssize_t)s.n * s.oc1 * oh_size * ow_size * N0;
+  std::vector<char> in(iree_uk_test_2d_buffer_length(in_type, 1, in_count));
+  std::vector<char> filter(
+      iree_uk_test_2d_buffer_length(filter_type, 1, filter_count));
+  std::vector<char> out(iree_uk_test_2d_buffer_length(out_type, 1, out_count));
+  iree_uk_test_write_random_buffer(in.data(), in.size(), in_type, engine);
+  iree_uk_test_write_random_buffer(filter.data(), filter.size(), filter_type,
+                                   engine);
+  iree_uk_test_write_random_buffer(out.data(), out.size(), out_type, engine);
+
+  // Reference results, starting from the initial output when accumulating.
+  std::vector<double> expected(out_count);
+  for (iree_uk_ssize_t i = 0; i < out_count; ++i) {
+    expected[i] = (flags & IREE_UK_FLAG_ACCUMULATE)
+                      ? read_element(out_type, out.data(), i)
+                      : 0.0;
+  }
+  for (int n = 0; n < s.n; ++n) {
+    for (int oc1 = 0; oc1 < s.oc1; ++oc1) {
+      for (int oh = 0; oh < oh_size; ++oh) {
+        for (int ow = 0; ow < ow_size; ++ow) {
+          for (int oc0 = 0; oc0 < N0; ++oc0) {
+            double acc = 0.0;
+            for (int c1 = 0; c1 < s.c1; ++c1) {
+              for (int kh = 0; kh < s.kh; ++kh) {
+                int ih = oh * s.stride_h - s.pad_h + kh * s.dilation_h;
+                if (ih < 0 || ih >= s.h) continue;
+                for (int kw = 0; kw < s.kw; ++kw) {
+                  int iw = ow * s.stride_w - s.pad_w + kw * s.dilation_w;
+                  if (iw < 0 || iw >= s.w) continue;
+                  for (int c0 = 0; c0 < K0; ++c0) {
+                    iree_uk_ssize_t in_index =
+                        (((iree_uk_ssize_t)(n * s.c1 + c1) * s.h + ih) * s.w +
+                         iw) *
+                            K0 +
+                        c0;
+                    iree_uk_ssize_t filter_index =
+                        ((((iree_uk_ssize_t)(oc1 * s.c1 + c1) * s.kh + kh) *
+                              s.kw +
+                          kw) *
+                             N0 +
+                         oc0) *
+                            K0 +
+                        c0;
+                    acc += read_element(in_type, in.data(), in_index) *
+                           read_element(filter_type, filter.data(),
+                                        filter_index);
+                  }
+                }
+              }
+            }
+            iree_uk_ssize_t out_index =
+                (((iree_uk_ssize_t)(n * s.oc1 + oc1) * oh_size + oh) *
+                     ow_size +
+                 ow) *
+                    N0 +
+                oc0;
+            expected[out_index] += acc;
+          }
+        }
+      }
+    }
+  }
+
+  iree_uk_conv2d_nchwc_params_t params;
+  memset(&params, 0, sizeof params);
+  params.type = type;
+  params.flags = flags;
+  params.N = s.n;
+  params.C1 = s.c1;
+  params.H = s.h;
+  params.W = s.w;
+  params.OC1 = s.oc1;
+  params.OH = oh_size;
+  params.OW = ow_size;
+  params.KH = s.kh;
+  params.KW = s.kw;
+  params.stride_h = s.stride_h;
+  params.stride_w = s.stride_w;
+  params.dilation_h = s.dilation_h;
+  params.dilation_w = s.dilation_w;
+  params.pad_h = s.pad_h;
+  params.pad_w = s.pad_w;
+  params.M0 = M0;
+  params.N0 = N0;
+  params.K0 = K0;
+  params.in_buffer = in.data();
+  params.filter_buffer = filter.data();
+  params.out_buffer = out.data();
+  params.cpu_data = cpu_data;
+  check_ok(iree_uk_conv2d_nchwc(&params), "iree_uk_conv2d_nchwc");
+
+  for (iree_uk_ssize_t i = 0; i < out_count; ++i) {
+    if (read_element(out_type, out.data(), i) != expected[i]) {
+      char types_str[32];
+      iree_uk_test_type_triple_str(types_str, sizeof types_str, type);
+      fprintf(stderr,
+              "conv2d_nchwc test failure: types %s, M0=%d N0=%d K0=%d, "
+              "N=%d C1=%d H=%d W=%d OC1=%d KH=%d KW=%d stride=%dx%d "
+              "dilation=%dx%d pad=%dx%d, accumulate=%d, at index %d\n",
+              types_str, M0, N0, K0, s.n, s.c1, s.h, s.w, s.oc1, s.kh, s.kw,
+              s.stride_h, s.stride_w, s.dilation_h, s.dilation_w, s.pad_h,
+              s.pad_w, (bool)(flags & IREE_UK_FLAG_ACCUMULATE), (int)i);
+      iree_abort();
+    }
+  }
+}
+
+static void test_convs(iree_uk_mmt4d_type_t type, int M0, int N0, int K0,
+                       const iree_uk_uint64_t* cpu_data,
+                       iree_uk_test_random_engine_t* engine) {
+  std::vector<conv_shape_t> shapes{
+      // n, c1, h, w, oc1, kh, kw, strides, dilations, padding.
+      {0, 1, 3, 3, 1, 1, 1, 1, 1, 1, 1, 0, 0},
+      {1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 0, 0},
+      {1, 2, 5, 19, 3, 1, 1, 1, 1, 1, 1, 0, 0},
+      {2, 2, 7, 17, 2, 3, 3, 1, 1, 1, 1, 1, 1},
+      {1, 3, 9, 21, 2, 3, 3, 2, 2, 1, 1, 1, 1},
+      {1, 1, 11, 23, 1, 5, 5, 1, 1, 1, 1, 2, 2},
+      {1, 2, 9, 9, 1, 3, 3, 1, 1, 2, 2, 2, 2},
+      {1, 1, 6, 40, 2, 3, 5, 1, 2, 1, 1, 0, 3},
+      // Filter taps that only ever see padding.
+      {1, 1, 2, 2, 1, 3, 3, 1, 1, 1, 1, 2, 2},
+  };
+  for (const conv_shape_t& shape : shapes) {
+    for (bool accumulate : {false, true}) {
+      test_one_conv(type, M0, N0, K0, shape,
+                    accumulate ? IREE_UK_FLAG_ACCUMULATE : 0, cpu_data,
+                    engine);
+    }
+  }
+}
+
+// See mmt4d_test in mmt4d_test.cc.
+static void conv2d_nchwc_test(iree_uk_mmt4d_type_t type, int M0, int N0,
+                              int K0, iree_uk_uint64_t cpu_data_field_0_bit) {
+  iree_uk_test_random_engine_t* engine = iree_uk_test_random_engine_create();
+  const iree_uk_uint64_t local_cpu_data_default[IREE_CPU_DATA_FIELD_COUNT] = {
+      0};
+  test_convs(type, M0, N0, K0, local_cpu_data_default, engine);
+  if (cpu_data_field_0_bit) {
+    const iree_uk_uint64_t local_cpu_data_with_bit[IREE_CPU_DATA_FIELD_COUNT] =
+        {cpu_data_field_0_bit};
+    char cpu_feat_str[32];
+    iree_uk_test_cpu_features_str(cpu_feat_str, sizeof cpu_feat_str,
+                                  local_cpu_data_with_bit, 1);
+    if (iree_cpu_data_field(0) & cpu_data_field_0_bit) {
+      printf("Device supports CPU feature: %s\n", cpu_feat_str);
+      test_convs(type, M0, N0, K0, local_cpu_data_with_bit, engine);
+    } else {
+      printf("Skipped: device does not support CPU feature: %s\n",
+             cpu_feat_str);
+    }
+  }
+  iree_uk_test_random_engine_destroy(engine);
+}
+
+#define CONV2D_NCHWC_TEST(type, M0, N0, K0, test_suffix, feature_bit)     \
+  TEST(Conv2DNchwcTest, type##_tile_##M0##x##N0##x##K0##_##test_suffix) { \
+    conv2d_nchwc_test(iree_uk_mmt4d_type_##type, M0, N0, K0, feature_bit); \
+  }
+
+CONV2D_NCHWC_TEST(f32f32f32, 4, 4, 4, generic, 0)
+CONV2D_NCHWC_TEST(i8i8i32, 3, 5, 7, generic, 0)
+CONV2D_NCHWC_TEST(f16f16f32, 4, 4, 2, generic, 0)
+CONV2D_NCHWC_TEST(bf16bf16f32, 4, 4, 2, generic, 0)
+
+#if defined(IREE_UK_ARCH_ARM_64)
+CONV2D_NCHWC_TEST(f32f32f32, 8, 8, 1, arm_64, 0)
+CONV2D_NCHWC_TEST(i8i8i32, 8, 8, 4, arm_64_DOTPROD,
+                  IREE_CPU_DATA_FIELD_0_AARCH64_HAVE_DOTPROD)
+#endif  // defined(IREE_UK_ARCH_ARM_64)
+
+#if defined(IREE_UK_ARCH_X86_64)
+CONV2D_NCHWC_TEST(f32f32f32, 8, 8, 1, x86_64_AVX2_FMA,
+                  IREE_CPU_DATA_FIELD_0_X86_64_HAVE_AVX2_FMA)
+CONV2D_NCHWC_TEST(i8i8i32, 8, 8, 2, x86_64_AVX2_FMA,
+                  IREE_CPU_DATA_FIELD_0_X86_64_HAVE_AVX2_FMA)
+#endif  // defined(IREE_UK_ARCH_X86_64)
+
+int main(int argc, char** argv) {
+  ::testing::InitGoogleTest(&argc, argv);
+  iree_cpu_initialize(iree_allocator_system());
+  return RUN_ALL_TESTS();
+}
@@ -0,0 +1,412 @@
+// Copyright 2023 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include "iree/builtins/ukernel/elementwise.h"
+
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+#include "iree/base/api.h"
+#include "iree/base/internal/cpu.h"
+#include "iree/builtins/ukernel/tools/ukernel_test_utils.h"
+#include "iree/testing/gtest.h"
+
+namespace {
+
+float AsFloat(uint32_t bits) {
+  float value;
+  memcpy(&value, &bits, sizeof value);
+  return value;
+}
+
+uint32_t AsBits(float value) {
+  uint32_t bits;
+  memcpy(&bits, &value, sizeof bits);
+  return bits;
+}
+
+// Maps float bit patterns to integers that are ordered like the floats, so
+// that the difference of two such integers is the distance in ulps.
+int64_t OrderedBits(float value) {
+  int32_t bits = (int32_t)AsBits(value);
+  return bits < 0 ? (int64_t)INT32_MIN - bits : bits;
+}
+
+// Classes of random inputs, chosen to stay within the defined domain of each
+// op and to cover its interesting range.
+enum class Inputs {
+  kAnyBits,       // Arbitrary 32-bit values.
+  kShiftAmounts,  // Integers in [0, 31].
+  kNonzeroInts,   // Nonzero integers, excluding -1 for signed division.
+  kFloats,        // Floats in [-1000, 1000].
+  kExpFloats,     // Floats in [-110, 110].
+  kTanhFloats,    // Floats in [-10, 10].
+  kFloatBits,     // Arbitrary float bit patterns, including NaN and inf.
+};
+
+uint32_t RandomInput(Inputs inputs, iree_uk_test_random_engine_t* engine) {
+  uint32_t bits = (uint32_t)iree_uk_test_random_engine_get_0_65535(engine) |
+                  ((uint32_t)iree_uk_test_random_engine_get_0_65535(engine)
+                   << 16);
+  float unit = (float)(bits >> 8) / (float)(1 << 24);  // [0, 1)
+  switch (inputs) {
+    case Inputs::kAnyBits:
+    case Inputs::kFloatBits:
+      return bits;
+    case Inputs::kShiftAmounts:
+      return bits & 31;
+    case Inputs::kNonzeroInts:
+      return (bits == 0 || bits == 0xFFFFFFFFu) ? 1 : bits;
+    case Inputs::kFloats:
+      return AsBits(2000.0f * unit - 1000.0f);
+    case Inputs::kExpFloats:
+      return AsBits(220.0f * unit - 110.0f);
+    case Inputs::kTanhFloats:
+      return AsBits(20.0f * unit - 10.0f);
+  }
+  return 0;
+}
+
+// Special float values appended to float inputs.
+const float kSpecialFloats[] = {
+    0.0f,     -0.0f,  1.0f,    -1.0f,   0.5f,     1e-40f,  -1e-40f,  1e-30f,
+    88.7f,    88.8f,  -87.3f,  -103.9f, -150.0f,  3.4e38f, 0.625f,   -0.625f,
+    0.62499f, 1e-8f,  INFINITY, -INFINITY, NAN,
+};
+
+struct BinaryOp {
+  const char* name;
+  iree_uk_x32b_2d_func_t func;
+  uint32_t (*reference)(uint32_t lhs, uint32_t rhs);
+  Inputs lhs_inputs;
+  Inputs rhs_inputs;
+};
+
+struct UnaryOp {
+  const char* name;
+  iree_uk_x32u_2d_func_t func;
+  uint32_t (*reference)(uint32_t in);
+  Inputs inputs;
+  // Maximum allowed distance in ulps from the reference for float results.
+  int max_ulps;
+};
+
+struct ReductionOp {
+  const char* name;
+  iree_uk_x32r_2d_func_t func;
+  // Combines the accumulator with one input element, as binary references do.
+  uint32_t (*reference)(uint32_t acc, uint32_t in);
+  Inputs inputs;
+};
+
+#define FLOAT_BINARY_REF(expr)               \
+  [](uint32_t lhs_bits, uint32_t rhs_bits) { \
+    float lhs = AsFloat(lhs_bits);           \
+    float rhs = AsFloat(rhs_bits);           \
+    return AsBits(expr);                     \
+  }
+#define INT_BINARY_REF(expr) \
+  [](uint32_t lhs, uint32_t rhs) -> uint32_t { return (expr); }
+#define FLOAT_UNARY_REF(expr)    \
+  [](uint32_t in_bits) {         \
+    float in = AsFloat(in_bits); \
+    return AsBits(expr);         \
+  }
+
+const BinaryOp kBinaryOps[] = {
+    {"addf", iree_uk_x32b_addf_2d, FLOAT_BINARY_REF(lhs + rhs),
+     Inputs::kFloats, Inputs::kFloats},
+    {"addi", iree_uk_x32b_addi_2d, INT_BINARY_REF(lhs + rhs),
+     Inputs::kAnyBits, Inputs::kAnyBits},
+    {"andi", iree_uk_x32b_andi_2d, INT_BINARY_REF(lhs & rhs),
+     Inputs::kAnyBits, Inputs::kAnyBits},
+    {"divf", iree_uk_x32b_divf_2d, FLOAT_BINARY_REF(lhs / rhs),
+     Inputs::kFloats, Inputs::kFloats},
+    {"divsi", iree_uk_x32b_divsi_2d,
+     INT_BINARY_REF((uint32_t)((int32_t)lhs / (int32_t)rhs)),
+     Inputs::kAnyBits, Inputs::kNonzeroInts},
+    {"divui", iree_uk_x32b_divui_2d, INT_BINARY_REF(lhs / rhs),
+     Inputs::kAnyBits, Inputs::kNonzeroInts},
+    {"mulf", iree_uk_x32b_mulf_2d, FLOAT_BINARY_REF(lhs * rhs),
+     Inputs::kFloats, Inputs::kFloats},
+    {"muli", iree_uk_x32b_muli_2d, INT_BINARY_REF(lhs * rhs),
+     Inputs::kAnyBits, Inputs::kAnyBits},
+    {"ori", iree_uk_x32b_ori_2d, INT_BINARY_REF(lhs | rhs), Inputs::kAnyBits,
+     Inputs::kAnyBits},
+    {"shli", iree_uk_x32b_shli_2d, INT_BINARY_REF(lhs << rhs),
+     Inputs::kAnyBits, Inputs::kShiftAmounts},
+    {"shrsi", iree_uk_x32b_shrsi_2d,
+     INT_BINARY_REF((uint32_t)((int32_t)lhs >> rhs)), Inputs::kAnyBits,
+     Inputs::kShiftAmounts},
+    {"shrui", iree_uk_x32b_shrui_2d, INT_BINARY_REF(lhs >> rhs),
+     Inputs::kAnyBits, Inputs::kShiftAmounts},
+    {"subf", iree_uk_x32b_subf_2d, FLOAT_BINARY_REF(lhs - rhs),
+     Inputs::kFloats, Inputs::kFloats},
+    {"subi", iree_uk_x32b_subi_2d, INT_BINARY_REF(lhs - rhs),
+     Inputs::kAnyBits, Inputs::kAnyBits},
+    {"xori", iree_uk_x32b_xori_2d, INT_BINARY_REF(lhs ^ rhs),
+     Inputs::kAnyBits, Inputs::kAnyBits},
+};
+
+uint32_t CountLeadingZeros(uint32_t in) {
+  uint32_t count = 0;
+  for (uint32_t bit = 1u << 31; bit && !(in & bit); bit >>= 1) ++count;
+  return count;
+}
+
+// Transcendental functions are compared against double precision results
+// rounded to float, and may be approximated by architecture-specific code.
+const UnaryOp kUnaryOps[] = {
+    {"absf", iree_uk_x32u_absf_2d, FLOAT_UNARY_REF(std::fabs(in)),
+     Inputs::kFloatBits, 0},
+    {"ceilf", iree_uk_x32u_ceilf_2d, FLOAT_UNARY_REF(std::ceil(in)),
+     Inputs::kFloats, 0},
+    {"ctlz", iree_uk_x32u_ctlz_2d, CountLeadingZeros, Inputs::kAnyBits, 0},
+    {"expf", iree_uk_x32u_expf_2d,
+     FLOAT_UNARY_REF((float)std::exp((double)in)), Inputs::kExpFloats, 2},
+    {"floorf", iree_uk_x32u_floorf_2d, FLOAT_UNARY_REF(std::floor(in)),
+     Inputs::kFloats, 0},
+    {"logf", iree_uk_x32u_logf_2d,
+     FLOAT_UNARY_REF((float)std::log((double)in)), Inputs::kFloatBits, 2},
+    {"negf", iree_uk_x32u_negf_2d, FLOAT_UNARY_REF(-in), Inputs::kFloatBits,
+     0},
+    {"rsqrtf", iree_uk_x32u_rsqrtf_2d, FLOAT_UNARY_REF(1.0f / std::sqrt(in)),
+     Inputs::kFloatBits, 0},
+    {"tanhf", iree_uk_x32u_tanhf_2d,
+     FLOAT_UNARY_REF((float)std::tanh((double)in)), Inputs::kTanhFloats, 2},
+};
+
+// NaN inputs exercise the NaN propagation of min/max; accumulation order is
+// fixed, so float sums are compared exactly.
+const ReductionOp kReductionOps[] = {
+    {"addf", iree_uk_x32r_addf_2d, FLOAT_BINARY_REF(lhs + rhs),
+     Inputs::kFloats},
+    {"addi", iree_uk_x32r_addi_2d, INT_BINARY_REF(lhs + rhs),
+     Inputs::kAnyBits},
+    {"maxf", iree_uk_x32r_maxf_2d,
+     FLOAT_BINARY_REF((std::isnan(lhs) || std::isnan(rhs))
+                          ? NAN
+                          : std::fmax(lhs, rhs)),
+     Inputs::kFloats},
+    {"maxsi", iree_uk_x32r_maxsi_2d,
+     INT_BINARY_REF((int32_t)lhs > (int32_t)rhs ? lhs : rhs),
+     Inputs::kAnyBits},
+    {"minf", iree_uk_x32r_minf_2d,
+     FLOAT_BINARY_REF((std::isnan(lhs) || std::isnan(rhs))
+                          ? NAN
+                          : std::fmin(lhs, rhs)),
+     Inputs::kFloats},
+    {"minsi", iree_uk_x32r_minsi_2d,
+     INT_BINARY_REF((int32_t)lhs < (int32_t)rhs ? lhs : rhs),
+     Inputs::kAnyBits},
+};
+
+bool IsFloatOp(const char* name) { return strcmp(name, "ctlz") != 0; }
+
+// Checks |actual| against |expected| within |max_ulps|, treating any two NaNs
+// as equal.
+bool FloatBitsMatch(uint32_t expected, uint32_t actual, int max_ulps) {
+  float e = AsFloat(expected);
+  float a = AsFloat(actual);
+  if (std::isnan(e) || std::isnan(a)) return std::isnan(e) && std::isnan(a);
+  if (std::isinf(e) || std::isinf(a)) return e == a;
+  int64_t distance = OrderedBits(e) - OrderedBits(a);
+  return (distance < 0 ? -distance : distance) <= max_ulps;
+}
+
+// Shapes tried for each op: the inner size covers vector tails and the inner
+// stride covers the non-contiguous path.
+struct Shape {
+  iree_uk_ssize_t size0;
+  iree_uk_ssize_t size1;
+  iree_uk_ssize_t stride1;
+};
+const Shape kShapes[] = {
+    {1, 1, 1}, {3, 7, 1}, {2, 8, 1}, {3, 17, 1}, {4, 33, 1},
+    {2, 100, 1}, {3, 5, 2}, {1, 40, 3},
+};
+
+// Strided 2d buffer with out-of-bounds guard values around each row.
+struct Buffer {
+  Buffer(const Shape& shape)
+      : stride0(shape.size1 * shape.stride1 + 3),
+        data(shape.size0 * stride0 + 1, 0xDEADBEEFu) {}
+  uint32_t& at(const Shape& shape, iree_uk_ssize_t i, iree_uk_ssize_t j) {
+    return data[i * stride0 + j * shape.stride1];
+  }
+  iree_uk_ssize_t stride0;
+  std::vector<uint32_t> data;
+};
+
+void FillInputs(const Shape& shape, Inputs inputs, Buffer* buffer,
+                iree_uk_test_random_engine_t* engine) {
+  size_t special_index = 0;
+  size_t special_count =
+      inputs == Inputs::kAnyBits || inputs == Inputs::kShiftAmounts ||
+              inputs == Inputs::kNonzeroInts
+          ? 0
+          : IREE_ARRAYSIZE(kSpecialFloats);
+  for (iree_uk_ssize_t i = 0; i < shape.size0; ++i) {
+    for (iree_uk_ssize_t j = 0; j < shape.size1; ++j) {
+      buffer->at(shape, i, j) =
+          special_index < special_count
+              ? AsBits(kSpecialFloats[special_index++])
+              : RandomInput(inputs, engine);
+    }
+  }
+}
+
+// Checks that elements outside of the logical 2d output were untouched.
+void CheckGuards(const Shape& shape, Buffer* out, const char* name) {
+  std::vector<bool> in_bounds(out->data.size());
+  for (iree_uk_ssize_t i = 0; i < shape.size0; ++i) {
+    for (iree_uk_ssize_t j = 0; j < shape.size1; ++j) {
+      in_bounds[&out->at(shape, i, j) - out->data.data()] = true;
+    }
+  }
+  for (size_t k = 0; k < out->data.size(); ++k) {
+    if (!in_bounds[k]) {
+      ASSERT_EQ(out->data[k], 0xDEADBEEFu) << name << ": wrote out of bounds";
+    }
+  }
+}
+
+void TestBinaryOp(const BinaryOp& op, const iree_uk_uint64_t* cpu_data,
+                  iree_uk_test_random_engine_t* engine) {
+  for (const Shape& shape : kShapes) {
+    Buffer lhs(shape), rhs(shape), out(shape);
+    FillInputs(shape, op.lhs_inputs, &lhs, engine);
+    FillInputs(shape, op.rhs_inputs, &rhs, engine);
+    ASSERT_EQ(0, op.func(lhs.data.data(), 0, lhs.stride0, shape.stride1,
+                         rhs.data.data(), 0, rhs.stride0, shape.stride1,
+                         out.data.data(), 0, out.stride0, shape.stride1,
+                         shape.size0, shape.size1, cpu_data));
+    for (iree_uk_ssize_t i = 0; i < shape.size0; ++i) {
+      for (iree_uk_ssize_t j = 0; j < shape.size1; ++j) {
+        uint32_t l = lhs.at(shape, i, j), r = rhs.at(shape, i, j);
+        uint32_t expected = op.reference(l, r);
+        uint32_t actual = out.at(shape, i, j);
+        bool match = op.lhs_inputs == Inputs::kFloats
+                         ? FloatBitsMatch(expected, actual, 0)
+                         : expected == actual;
+        ASSERT_TRUE(match) << op.name << "(0x" << std::hex << l << ", 0x" << r
+                           << "): expected 0x" << expected << ", got 0x"
+                           << actual;
+      }
+    }
+    CheckGuards(shape, &out, op.name);
+  }
+}
+
+void TestUnaryOp(const UnaryOp& op, const iree_uk_uint64_t* cpu_data,
+                 iree_uk_test_random_engine_t* engine) {
+  for (const Shape& shape : kShapes) {
+    Buffer in(shape), out(shape);
+    FillInputs(shape, op.inputs, &in, engine);
+    ASSERT_EQ(0, op.func(in.data.data(), 0, in.stride0, shape.stride1,
+                         out.data.data(), 0, out.stride0, shape.stride1,
+                         shape.size0, shape.size1, cpu_data));
+    for (iree_uk_ssize_t i = 0; i < shape.size0; ++i) {
+      for (iree_uk_ssize_t j = 0; j < shape.size1; ++j) {
+        uint32_t value = in.at(shape, i, j);
+        uint32_t expected = op.reference(value);
+        uint32_t actual = out.at(shape, i, j);
+        bool match = IsFloatOp(op.name)
+                         ? FloatBitsMatch(expected, actual, op.max_ulps)
+                         : expected == actual;
+        ASSERT_TRUE(match) << op.name << "(" << AsFloat(value) << " = 0x"
+                           << std::hex << value << "): expected "
+                           << AsFloat(expected) << ", got " << AsFloat(actual);
+      }
+    }
+    CheckGuards(shape, &out, op.name);
+  }
+}
+
+void TestReductionOp(const ReductionOp& op, const iree_uk_uint64_t* cpu_data,
+                     iree_uk_test_random_engine_t* engine) {
+  for (const Shape& shape : kShapes) {
+    Buffer in(shape);
+    FillInputs(shape, op.inputs, &in, engine);
+    // Each output element is strided by 2 to check that the gaps are kept.
+    std::vector<uint32_t> out(2 * shape.size0, 0xDEADBEEFu);
+    std::vector<uint32_t> init(shape.size0);
+    for (iree_uk_ssize_t i = 0; i < shape.size0; ++i) {
+      init[i] = RandomInput(op.inputs, engine);
+      out[2 * i] = init[i];
+    }
+    ASSERT_EQ(0, op.func(in.data.data(), 0, in.stride0, shape.stride1,
+                         out.data(), 0, 2, shape.size0, shape.size1,
+                         cpu_data));
+    for (iree_uk_ssize_t i = 0; i < shape.size0; ++i) {
+      uint32_t expected = init[i];
+      for (iree_uk_ssize_t j = 0; j < shape.size1; ++j) {
+        expected = op.reference(expected, in.at(shape, i, j));
+      }
+      uint32_t actual = out[2 * i];
+      bool match = op.inputs == Inputs::kFloats
+                       ? FloatBitsMatch(expected, actual, 0)
+                       : expected == actual;
+      ASSERT_TRUE(match) << op.name << " of row " << i << ": expected 0x"
+                         << std::hex << expected << ", got 0x" << actual;
+      ASSERT_EQ(out[2 * i + 1], 0xDEADBEEFu)
+          << op.name << ": wrote out of bounds";
+    }
+  }
+}
+
+// Tests all ops without optional CPU features, then again with the optional
+// CPU feature |cpu_data_field_0_bit| if nonzero and supported.
+void TestAllOps(iree_uk_uint64_t cpu_data_field_0_bit) {
+  const iree_uk_uint64_t local_cpu_data_default[IREE_CPU_DATA_FIELD_COUNT] = {
+      0};
+  const iree_uk_uint64_t local_cpu_data_with_bit[IREE_CPU_DATA_FIELD_COUNT] = {
+      cpu_data_field_0_bit};
+  const iree_uk_uint64_t* cpu_data = local_cpu_data_default;
+  if (cpu_data_field_0_bit) {
+    char cpu_feat_str[32];
+    iree_uk_test_cpu_features_str(cpu_feat_str, sizeof cpu_feat_str,
+                                  local_cpu_data_with_bit, 1);
+    if (!(iree_cpu_data_field(0) & cpu_data_field_0_bit)) {
+      printf("Skipped: device does not support CPU feature: %s\n",
+             cpu_feat_str);
+      return;
+    }
+    printf("Device supports CPU feature: %s\n", cpu_feat_str);
+    cpu_data = local_cpu_data_with_bit;
+  }
+  iree_uk_test_random_engine_t* engine = iree_uk_test_random_engine_create();
+  for (const BinaryOp& op : kBinaryOps) TestBinaryOp(op, cpu_data, engine);
+  for (const UnaryOp& op : kUnaryOps) TestUnaryOp(op, cpu_data, engine);
+  for (const ReductionOp& op : kReductionOps) {
+    TestReductionOp(op, cpu_data, engine);
+  }
+  iree_uk_test_random_engine_destroy(engine);
+}
+
+TEST(ElementwiseTest, generic) { TestAllOps(0); }
+
+#if defined(IREE_UK_ARCH_X86_64)
+
+TEST(ElementwiseTest, x86_64_avx2_fma) {
+  TestAllOps(IREE_CPU_DATA_FIELD_0_X86_64_HAVE_AVX2_FMA);
+}
+
+TEST(ElementwiseTest, x86_64_avx512_base) {
+  TestAllOps(IREE_CPU_DATA_FIELD_0_X86_64_HAVE_AVX512_BASE);
+}
+
+#endif  // defined(IREE_UK_ARCH_X86_64)
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  ::testing::InitGoogleTest(&argc, argv);
+  iree_cpu_initialize(iree_allocator_system());
+  return RUN_ALL_TESTS();
+}
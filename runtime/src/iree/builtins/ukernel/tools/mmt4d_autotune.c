@@ -0,0 +1,319 @@
+// Copyright 2023 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+// Measures the mmt4d tile shapes that the compiler may pick for each element
+// type on the CPU running this tool, and reports the fastest ones as a
+// compiler flag:
+//
+//   --iree-codegen-mmt4d-tile-sizes=f32f32f32:8x8x1,i8i8i32:8x8x4
+//
+// The data layout of packed operands bakes in the tile shape, so there is no
+// choosing it at runtime: the choice has to be made at compile time for the
+// CPU model that will run the program. Cores differ enough that this is worth
+// measuring rather than guessing: for instance, an in-order little core may
+// prefer a different i8 kernel than the big core of the same SoC. Pin this
+// tool to the core of interest (e.g. with taskset) when that matters.
+//
+// With --output_file, results are persisted as one line per CPU model,
+// "<cpu model> <compiler flag>", replacing any earlier line for the same model.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "iree/base/api.h"
+#include "iree/base/internal/cpu.h"
+#include "iree/base/internal/flags.h"
+#include "iree/builtins/ukernel/mmt4d.h"
+#include "iree/builtins/ukernel/tools/ukernel_test_utils.h"
+
+#if defined(IREE_ARCH_X86_64) && !defined(IREE_COMPILER_MSVC)
+#include <cpuid.h>
+#endif
+
+IREE_FLAG(int32_t, rows, 256,
+          "Rows of the LHS and output matrices, before padding to tiles.");
+IREE_FLAG(int32_t, cols, 256,
+          "Columns of the RHS and output matrices, before padding to tiles.");
+IREE_FLAG(int32_t, depth, 256,
+          "Reduction dimension size, before padding to tiles.");
+IREE_FLAG(int32_t, min_duration_ms, 200,
+          "Minimum time spent measuring each candidate.");
+IREE_FLAG(string, output_file, "",
+          "File in which to persist the winning tile sizes of this CPU model, "
+          "one line per model.");
+
+typedef struct iree_mmt4d_autotune_candidate_t {
+  iree_uk_mmt4d_type_t type;
+  const char* type_str;
+  int M0;
+  int N0;
+  int K0;
+  iree_uk_uint64_t cpu_data_field_0;
+  const char* label;
+} iree_mmt4d_autotune_candidate_t;
+
+// Tile shapes with architecture-specific tile functions. Keep in sync with the
+// tile function selection in arch/*/mmt4d_*.c.
+static const iree_mmt4d_autotune_candidate_t iree_mmt4d_autotune_candidates[] =
+    {
+#if defined(IREE_UK_ARCH_ARM_64)
+        {iree_uk_mmt4d_type_f32f32f32, "f32f32f32", 8, 8, 1, 0, "neon"},
+        {iree_uk_mmt4d_type_i8i8i32, "i8i8i32", 8, 8, 1, 0, "neon"},
+        {iree_uk_mmt4d_type_i8i8i32, "i8i8i32", 8, 8, 4,
+         IREE_CPU_DATA_FIELD_0_AARCH64_HAVE_DOTPROD, "dotprod"},
+        {iree_uk_mmt4d_type_i8i8i32, "i8i8i32", 8, 8, 8,
+         IREE_CPU_DATA_FIELD_0_AARCH64_HAVE_I8MM, "i8mm"},
+#endif  // defined(IREE_UK_ARCH_ARM_64)
+#if defined(IREE_UK_ARCH_X86_64)
+        {iree_uk_mmt4d_type_f32f32f32, "f32f32f32", 8, 8, 1,
+         IREE_CPU_DATA_FIELD_0_X86_64_HAVE_AVX2_FMA, "avx2_fma"},
+        {iree_uk_mmt4d_type_f32f32f32, "f32f32f32", 16, 16, 1,
+         IREE_CPU_DATA_FIELD_0_X86_64_HAVE_AVX512_BASE, "avx512_base"},
+        {iree_uk_mmt4d_type_i8i8i32, "i8i8i32", 8, 8, 2,
+         IREE_CPU_DATA_FIELD_0_X86_64_HAVE_AVX2_FMA, "avx2_fma"},
+        {iree_uk_mmt4d_type_i8i8i32, "i8i8i32", 16, 16, 2,
+         IREE_CPU_DATA_FIELD_0_X86_64_HAVE_AVX512_BASE |
+             IREE_CPU_DATA_FIELD_0_X86_64_HAVE_AVX512VNNI,
+         "avx512vnni"},
+        {iree_uk_mmt4d_type_i8i8i32, "i8i8i32", 16, 16, 2,
+         IREE_CPU_DATA_FIELD_0_X86_64_HAVE_AVX512_BASE, "avx512_base"},
+#endif  // defined(IREE_UK_ARCH_X86_64)
+#if defined(IREE_UK_ARCH_RISCV_64)
+        {iree_uk_mmt4d_type_f32f32f32, "f32f32f32", 8, 8, 1,
+         IREE_CPU_DATA_FIELD_0_RISCV_64_HAVE_V, "v"},
+        {iree_uk_mmt4d_type_f32f32f32, "f32f32f32", 8, 16, 1,
+         IREE_CPU_DATA_FIELD_0_RISCV_64_HAVE_ZVL256B, "zvl256b"},
+        {iree_uk_mmt4d_type_i8i8i32, "i8i8i32", 8, 8, 1,
+         IREE_CPU_DATA_FIELD_0_RISCV_64_HAVE_V, "v"},
+        {iree_uk_mmt4d_type_i8i8i32, "i8i8i32", 8, 16, 1,
+         IREE_CPU_DATA_FIELD_0_RISCV_64_HAVE_ZVL256B, "zvl256b"},
+#endif  // defined(IREE_UK_ARCH_RISCV_64)
+#if defined(IREE_UK_ARCH_WASM_32)
+        {iree_uk_mmt4d_type_f32f32f32, "f32f32f32", 8, 8, 1, 0, "simd128"},
+        {iree_uk_mmt4d_type_i8i8i32, "i8i8i32", 8, 8, 1, 0, "simd128"},
+#endif  // defined(IREE_UK_ARCH_WASM_32)
+#if !defined(IREE_UK_ARCH_ARM_64)
+        // Generic fallback, so that every type has at least one candidate.
+        {iree_uk_mmt4d_type_f32f32f32, "f32f32f32", 8, 8, 1, 0, "generic"},
+        {iree_uk_mmt4d_type_i8i8i32, "i8i8i32", 8, 8, 1, 0, "generic"},
+#endif  // !defined(IREE_UK_ARCH_ARM_64)
+};
+
+// Writes a string identifying the CPU model of the current processor.
+static void iree_mmt4d_autotune_cpu_model(char* buffer, size_t capacity) {
+  snprintf(buffer, capacity, "unknown");
+#if defined(IREE_ARCH_X86_64) && !defined(IREE_COMPILER_MSVC)
+  unsigned int eax = 0, ebx = 0, ecx = 0, edx = 0;
+  __cpuid(0, eax, ebx, ecx, edx);
+  char vendor[13] = {0};
+  memcpy(vendor + 0, &ebx, 4);
+  memcpy(vendor + 4, &edx, 4);
+  memcpy(vendor + 8, &ecx, 4);
+  __cpuid(1, eax, ebx, ecx, edx);
+  unsigned int family = (eax >> 8) & 0xF;
+  unsigned int model = (eax >> 4) & 0xF;
+  if (family == 0xF) family += (eax >> 20) & 0xFF;
+  if (family >= 0x6) model |= ((eax >> 16) & 0xF) << 4;
+  snprintf(buffer, capacity, "x86_64:%s:family=0x%x:model=0x%x", vendor,
+           family, model);
+#elif defined(IREE_ARCH_ARM_64) && \
+    (defined(IREE_PLATFORM_LINUX) || defined(IREE_PLATFORM_ANDROID))
+  // Find the "CPU implementer" and "CPU part" lines of the processor that we
+  // are running on.
+  FILE* file = fopen("/proc/cpuinfo", "r");
+  if (!file) return;
+  int current_processor = (int)iree_cpu_query_processor_id();
+  int processor = -1;
+  unsigned int implementer = 0, part = 0;
+  char line[256];
+  while (fgets(line, sizeof(line), file)) {
+    sscanf(line, "processor : %d", &processor);
+    if (processor != current_processor) continue;
+    sscanf(line, "CPU implementer : %x", &implementer);
+    sscanf(line, "CPU part : %x", &part);
+  }
+  fclose(file);
+  snprintf(buffer, capacity, "aarch64:implementer=0x%x:part=0x%x",
+           implementer, part);
+#endif  // IREE_ARCH_*
+}
+
+// Returns the throughput of the candidate in useful (i.e. excluding padding)
+// operations per second.
+static double iree_mmt4d_autotune_measure(
+    const iree_mmt4d_autotune_candidate_t* candidate) {
+  iree_uk_uint64_t cpu_data[IREE_CPU_DATA_FIELD_COUNT] = {0};
+  cpu_data[0] = candidate->cpu_data_field_0;
+  cpu_data[1] = iree_cpu_data_field(1);
+  iree_uk_mmt4d_params_t params;
+  memset(&params, 0, sizeof params);
+  params.type = candidate->type;
+  params.M0 = candidate->M0;
+  params.N0 = candidate->N0;
+  params.K0 = candidate->K0;
+  params.M = (FLAG_rows + params.M0 - 1) / params.M0;
+  params.N = (FLAG_cols + params.N0 - 1) / params.N0;
+  params.K = (FLAG_depth + params.K0 - 1) / params.K0;
+  params.cpu_data = cpu_data;
+  params.lhs_stride = params.K * params.M0 * params.K0;
+  params.rhs_stride = params.K * params.N0 * params.K0;
+  params.out_stride = params.N * params.M0 * params.N0;
+  iree_uk_type_t lhs_type = iree_uk_mmt4d_lhs_type(params.type);
+  iree_uk_type_t rhs_type = iree_uk_mmt4d_rhs_type(params.type);
+  iree_uk_type_t out_type = iree_uk_mmt4d_out_type(params.type);
+  iree_uk_ssize_t lhs_buffer_size =
+      iree_uk_test_2d_buffer_length(lhs_type, params.M, params.lhs_stride);
+  iree_uk_ssize_t rhs_buffer_size =
+      iree_uk_test_2d_buffer_length(rhs_type, params.N, params.rhs_stride);
+  iree_uk_ssize_t out_buffer_size =
+      iree_uk_test_2d_buffer_length(out_type, params.M, params.out_stride);
+  void* lhs_buffer = malloc(lhs_buffer_size);
+  void* rhs_buffer = malloc(rhs_buffer_size);
+  void* out_buffer = malloc(out_buffer_size);
+  iree_uk_test_random_engine_t* engine = iree_uk_test_random_engine_create();
+  iree_uk_test_write_random_buffer(lhs_buffer, lhs_buffer_size, lhs_type,
+                                   engine);
+  iree_uk_test_write_random_buffer(rhs_buffer, rhs_buffer_size, rhs_type,
+                                   engine);
+  iree_uk_test_random_engine_destroy(engine);
+  params.lhs_buffer = lhs_buffer;
+  params.rhs_buffer = rhs_buffer;
+  params.out_buffer = out_buffer;
+
+  // One untimed run to warm up caches and page in the buffers.
+  iree_uk_status_t status = iree_uk_mmt4d(&params);
+  iree_time_t start_ns = iree_time_now();
+  iree_time_t end_ns = start_ns;
+  iree_time_t min_duration_ns = (iree_time_t)FLAG_min_duration_ms * 1000000;
+  int64_t iterations = 0;
+  while (status == iree_uk_status_ok && end_ns - start_ns < min_duration_ns) {
+    status = iree_uk_mmt4d(&params);
+    ++iterations;
+    end_ns = iree_time_now();
+  }
+  free(lhs_buffer);
+  free(rhs_buffer);
+  free(out_buffer);
+  if (status != iree_uk_status_ok) {
+    fprintf(stderr, "iree_uk_mmt4d failed: %s\n",
+            iree_uk_status_message(status));
+    return 0.0;
+  }
+  double seconds = (end_ns - start_ns) * 1e-9;
+  return 2.0 * FLAG_rows * FLAG_cols * FLAG_depth * iterations / seconds;
+}
+
+// Rewrites |path| with the line for |cpu_model| replaced by the new result.
+static iree_status_t iree_mmt4d_autotune_persist(const char* path,
+                                                 const char* cpu_model,
+                                                 const char* compiler_flag) {
+  // Keep the lines of other CPU models.
+  char* kept = NULL;
+  size_t kept_size = 0;
+  FILE* file = fopen(path, "r");
+  if (file) {
+    size_t model_length = strlen(cpu_model);
+    char line[1024];
+    while (fgets(line, sizeof(line), file)) {
+      if (strncmp(line, cpu_model, model_length) == 0 &&
+          line[model_length] == ' ') {
+        continue;
+      }
+      size_t line_length = strlen(line);
+      char* grown = realloc(kept, kept_size + line_length);
+      if (!grown) {
+        free(kept);
+        fclose(file);
+        return iree_make_status(IREE_STATUS_RESOURCE_EXHAUSTED);
+      }
+      kept = grown;
+      memcpy(kept + kept_size, line, line_length);
+      kept_size += line_length;
+    }
+    fclose(file);
+  }
+  file = fopen(path, "w");
+  if (!file) {
+    free(kept);
+    return iree_make_status(IREE_STATUS_PERMISSION_DENIED,
+                            "failed to open '%s' for writing", path);
+  }
+  if (kept_size) fwrite(kept, 1, kept_size, file);
+  fprintf(file, "%s %s\n", cpu_model, compiler_flag);
+  fclose(file);
+  free(kept);
+  return iree_ok_status();
+}
+
+int main(int argc, char** argv) {
+  iree_flags_set_usage(
+      "mmt4d_autotune",
+      "Measures mmt4d tile shapes on this CPU and prints the fastest as a\n"
+      "compiler flag.\n"
+      "\n");
+  iree_flags_parse_checked(IREE_FLAGS_PARSE_MODE_DEFAULT, &argc, &argv);
+  iree_cpu_initialize(iree_allocator_system());
+
+  char cpu_model[128];
+  iree_mmt4d_autotune_cpu_model(cpu_model, sizeof cpu_model);
+  fprintf(stdout, "CPU model: %s\n", cpu_model);
+  fprintf(stdout, "Problem size: %dx%dx%d\n", FLAG_rows, FLAG_cols,
+          FLAG_depth);
+
+  char compiler_flag[256] = "--iree-codegen-mmt4d-tile-sizes=";
+  const size_t candidate_count = IREE_ARRAYSIZE(iree_mmt4d_autotune_candidates);
+  bool first_type = true;
+  for (size_t i = 0; i < candidate_count; ++i) {
+    const iree_mmt4d_autotune_candidate_t* type_candidate =
+        &iree_mmt4d_autotune_candidates[i];
+    // Handle each type once, at its first candidate.
+    bool seen = false;
+    for (size_t j = 0; j < i; ++j) {
+      seen |= iree_mmt4d_autotune_candidates[j].type == type_candidate->type;
+    }
+    if (seen) continue;
+    const iree_mmt4d_autotune_candidate_t* best = NULL;
+    double best_ops_per_second = 0.0;
+    for (size_t j = i; j < candidate_count; ++j) {
+      const iree_mmt4d_autotune_candidate_t* candidate =
+          &iree_mmt4d_autotune_candidates[j];
+      if (candidate->type != type_candidate->type) continue;
+      // Skip candidates that would crash on this CPU.
+      if ((iree_cpu_data_field(0) & candidate->cpu_data_field_0) !=
+          candidate->cpu_data_field_0) {
+        continue;
+      }
+      double ops_per_second = iree_mmt4d_autotune_measure(candidate);
+      fprintf(stdout, "  %-10s %2dx%2dx%-2d %-12s %8.2f Gop/s\n",
+              candidate->type_str, candidate->M0, candidate->N0, candidate->K0,
+              candidate->label, ops_per_second * 1e-9);
+      // Ties resolve to the earlier candidate, i.e. the arch-specific one.
+      if (ops_per_second > best_ops_per_second) {
+        best = candidate;
+        best_ops_per_second = ops_per_second;
+      }
+    }
+    if (!best) continue;
+    size_t length = strlen(compiler_flag);
+    snprintf(compiler_flag + length, sizeof(compiler_flag) - length,
+             "%s%s:%dx%dx%d", first_type ? "" : ",", best->type_str, best->M0,
+             best->N0, best->K0);
+    first_type = false;
+  }
+  fprintf(stdout, "%s\n", compiler_flag);
+
+  if (strlen(FLAG_output_file)) {
+    iree_status_t status = iree_mmt4d_autotune_persist(
+        FLAG_output_file, cpu_model, compiler_flag);
+    if (!iree_status_is_ok(status)) {
+      iree_status_fprint(stderr, status);
+      iree_status_free(status);
+      return 1;
+    }
+  }
+  return 0;
+}
@@ -28,6 +28,9 @@ IREE_FLAG(
 IREE_FLAG(bool, accumulate, false,
           "Whether the kernel should accumulate into the existing accumulator "
           "tile values, or zero the accumulator tile.");
+IREE_FLAG(int32_t, rhs_quant_group_size, 32,
+          "For types with a quantized RHS, the number of K tiles sharing "
+          "scales.");
 
 struct iree_mmt4d_benchmark_user_data_t {
   iree_uk_mmt4d_type_t type;
@@ -54,7 +57,11 @@ static iree_status_t iree_mmt4d_benchmark(
   params.M0 = user_data->M0;
   params.N0 = user_data->N0;
   params.K0 = user_data->K0;
-  params.cpu_data = user_data->cpu_data;
+  // Let the ukernel block for the caches of the machine running the benchmark.
+  iree_uk_uint64_t cpu_data[IREE_CPU_DATA_FIELD_COUNT];
+  memcpy(cpu_data, user_data->cpu_data, sizeof cpu_data);
+  cpu_data[1] = iree_cpu_data_field(1);
+  params.cpu_data = cpu_data;
   params.lhs_stride = params.K * params.M0 * params.K0;
   params.rhs_stride = params.K * params.N0 * params.K0;
   params.out_stride = params.N * params.M0 * params.N0;
@@ -85,6 +92,20 @@ static iree_status_t iree_mmt4d_benchmark(
   params.lhs_buffer = lhs_buffer;
   params.rhs_buffer = rhs_buffer;
   params.out_buffer = out_buffer;
+  float* scales_buffer = NULL;
+  if (rhs_type == IREE_UK_TYPE_SINT_4) {
+    params.rhs_quant.group_size = FLAG_rhs_quant_group_size;
+    params.rhs_quant.scales_stride =
+        (params.K + params.rhs_quant.group_size - 1) /
+        params.rhs_quant.group_size * params.N0;
+    scales_buffer =
+        malloc(params.N * params.rhs_quant.scales_stride * sizeof(float));
+    for (iree_uk_ssize_t i = 0; i < params.N * params.rhs_quant.scales_stride;
+         ++i) {
+      scales_buffer[i] = 1.0f;
+    }
+    params.rhs_quant.scales_buffer = scales_buffer;
+  }
   iree_uk_int64_t total_iterations = 0;
   while (iree_benchmark_keep_running(benchmark_state,
                                      /*batch_count=*/FLAG_batch_count)) {
@@ -104,6 +125,7 @@ static iree_status_t iree_mmt4d_benchmark(
   free(lhs_buffer);
   free(rhs_buffer);
   free(out_buffer);
+  free(scales_buffer);
   return iree_ok_status();
 }
 
@@ -159,6 +181,21 @@ static void iree_mmt4d_benchmark_register(
                            IREE_CPU_DATA_FIELD_0_AARCH64_HAVE_##_cpu_feature,  \
                            arm_64_##_cpu_feature)
 
+#define MMT4D_BENCHMARK_REGISTER_X86_64_WITH_CPU_FEATURE(_type, _m0, _n0, _k0, \
+                                                         _cpu_feature)         \
+  MMT4D_BENCHMARK_REGISTER(_type, _m0, _n0, _k0,                               \
+                           IREE_CPU_DATA_FIELD_0_X86_64_HAVE_##_cpu_feature,   \
+                           x86_64_##_cpu_feature)
+
+#define MMT4D_BENCHMARK_REGISTER_RISCV_64_WITH_CPU_FEATURE(_type, _m0, _n0,    \
+                                                           _k0, _cpu_feature) \
+  MMT4D_BENCHMARK_REGISTER(_type, _m0, _n0, _k0,                               \
+                           IREE_CPU_DATA_FIELD_0_RISCV_64_HAVE_##_cpu_feature, \
+                           riscv_64_##_cpu_feature)
+
+#define MMT4D_BENCHMARK_REGISTER_WASM_32(_type, _m0, _n0, _k0) \
+  MMT4D_BENCHMARK_REGISTER(_type, _m0, _n0, _k0, 0, wasm_32)
+
 int main(int argc, char** argv) {
   iree_flags_set_usage("mmt4d_benchmark",
                        "Benchmarks the mmt4d microkernel.\n"
@@ -173,6 +210,9 @@ int main(int argc, char** argv) {
   // compare generic float vs int arithmetic.
   MMT4D_BENCHMARK_REGISTER_GENERIC(f32f32f32, 4, 4, 1);
   MMT4D_BENCHMARK_REGISTER_GENERIC(i8i8i32, 4, 4, 1);
+  MMT4D_BENCHMARK_REGISTER_GENERIC(f16f16f32, 4, 4, 1);
+  MMT4D_BENCHMARK_REGISTER_GENERIC(bf16bf16f32, 4, 4, 2);
+  MMT4D_BENCHMARK_REGISTER_GENERIC(f32i4f32, 4, 4, 2);
 
 // ARM_64 benchmarks.
 #if defined(IREE_UK_ARCH_ARM_64)
@@ -184,6 +224,51 @@ int main(int argc, char** argv) {
 
 #endif  // defined(IREE_UK_ARCH_ARM_64)
 
+// X86_64 benchmarks.
+#if defined(IREE_UK_ARCH_X86_64)
+
+  MMT4D_BENCHMARK_REGISTER_X86_64_WITH_CPU_FEATURE(f32f32f32, 8, 8, 1,
+                                                   AVX2_FMA);
+  MMT4D_BENCHMARK_REGISTER_X86_64_WITH_CPU_FEATURE(i8i8i32, 8, 8, 2, AVX2_FMA);
+  MMT4D_BENCHMARK_REGISTER_X86_64_WITH_CPU_FEATURE(f32i4f32, 8, 8, 1,
+                                                   AVX2_FMA);
+  MMT4D_BENCHMARK_REGISTER_X86_64_WITH_CPU_FEATURE(f32f32f32, 16, 16, 1,
+                                                   AVX512_BASE);
+  MMT4D_BENCHMARK_REGISTER_X86_64_WITH_CPU_FEATURE(i8i8i32, 16, 16, 2,
+                                                   AVX512_BASE);
+  MMT4D_BENCHMARK_REGISTER_X86_64_WITH_CPU_FEATURE(i8i8i32, 16, 16, 2,
+                                                   AVX512VNNI);
+  MMT4D_BENCHMARK_REGISTER_X86_64_WITH_CPU_FEATURE(f16f16f32, 16, 16, 1,
+                                                   AVX512_BASE);
+  MMT4D_BENCHMARK_REGISTER_X86_64_WITH_CPU_FEATURE(f16f16f16, 16, 16, 1,
+                                                   AVX512_BASE);
+  MMT4D_BENCHMARK_REGISTER_X86_64_WITH_CPU_FEATURE(bf16bf16f32, 16, 16, 2,
+                                                   AVX512_BASE);
+  MMT4D_BENCHMARK_REGISTER_X86_64_WITH_CPU_FEATURE(bf16bf16f32, 16, 16, 2,
+                                                   AVX512BF16);
+
+#endif  // defined(IREE_UK_ARCH_X86_64)
+
+// RISCV_64 benchmarks.
+#if defined(IREE_UK_ARCH_RISCV_64)
+
+  MMT4D_BENCHMARK_REGISTER_RISCV_64_WITH_CPU_FEATURE(f32f32f32, 8, 8, 1, V);
+  MMT4D_BENCHMARK_REGISTER_RISCV_64_WITH_CPU_FEATURE(i8i8i32, 8, 8, 1, V);
+  MMT4D_BENCHMARK_REGISTER_RISCV_64_WITH_CPU_FEATURE(f32f32f32, 8, 16, 1,
+                                                     ZVL256B);
+  MMT4D_BENCHMARK_REGISTER_RISCV_64_WITH_CPU_FEATURE(i8i8i32, 8, 16, 1,
+                                                     ZVL256B);
+
+#endif  // defined(IREE_UK_ARCH_RISCV_64)
+
+// WASM_32 benchmarks.
+#if defined(IREE_UK_ARCH_WASM_32)
+
+  MMT4D_BENCHMARK_REGISTER_WASM_32(f32f32f32, 8, 8, 1);
+  MMT4D_BENCHMARK_REGISTER_WASM_32(i8i8i32, 8, 8, 1);
+
+#endif  // defined(IREE_UK_ARCH_WASM_32)
+
   iree_benchmark_run_specified();
   return 0;
 }
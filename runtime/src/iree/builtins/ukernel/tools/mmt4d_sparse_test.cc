@@ -0,0 +1,223 @@
+// Copyright 2023 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+// Tests the block-sparse mmt4d against dense mmt4d, which has its own test
+// against a reference implementation: a dense RHS with randomly zeroed tiles
+// is converted to the block-sparse format, and both ukernels must then produce
+// bit-identical results.
+
+#include "iree/builtins/ukernel/mmt4d_sparse.h"
+
+#include <vector>
+
+#include "iree/base/api.h"
+#include "iree/base/internal/cpu.h"
+#include "iree/builtins/ukernel/mmt4d.h"
+#include "iree/builtins/ukernel/tools/ukernel_test_utils.h"
+#include "iree/testing/gtest.h"
+#include "iree/testing/status_matchers.h"
+
+static void check_ok(iree_uk_status_t status, const char* what) {
+  if (status != iree_uk_status_ok) {
+    fprintf(stderr, "FATAL: %s failed: %s\n", what,
+            iree_uk_status_message(status));
+    iree_abort();
+  }
+}
+
+// Runs one sparse mmt4d with given shape, fraction of zero RHS tiles (in
+// 1/65536 units) and flags, and compares against dense mmt4d.
+static void test_one_sparse_matmul(iree_uk_mmt4d_type_t type, int M0, int N0,
+                                   int K0, int M, int N, int K,
+                                   int zero_tile_threshold,
+                                   iree_uk_uint32_t flags,
+                                   const iree_uk_uint64_t* cpu_data,
+                                   iree_uk_test_random_engine_t* engine) {
+  iree_uk_type_t lhs_type = iree_uk_mmt4d_lhs_type(type);
+  iree_uk_type_t rhs_type = iree_uk_mmt4d_rhs_type(type);
+  iree_uk_type_t out_type = iree_uk_mmt4d_out_type(type);
+  iree_uk_ssize_t lhs_stride = K * M0 * K0;
+  iree_uk_ssize_t rhs_stride = K * N0 * K0;
+  iree_uk_ssize_t out_stride = N * M0 * N0;
+  iree_uk_ssize_t lhs_buffer_size =
+      iree_uk_test_2d_buffer_length(lhs_type, M, lhs_stride);
+  iree_uk_ssize_t rhs_buffer_size =
+      iree_uk_test_2d_buffer_length(rhs_type, N, rhs_stride);
+  iree_uk_ssize_t out_buffer_size =
+      iree_uk_test_2d_buffer_length(out_type, M, out_stride);
+  iree_uk_ssize_t rhs_tile_size =
+      iree_uk_test_2d_buffer_length(rhs_type, N0, K0);
+  std::vector<char> lhs(lhs_buffer_size);
+  std::vector<char> rhs(rhs_buffer_size);
+  iree_uk_test_write_random_buffer(lhs.data(), lhs_buffer_size, lhs_type,
+                                   engine);
+  iree_uk_test_write_random_buffer(rhs.data(), rhs_buffer_size, rhs_type,
+                                   engine);
+  for (iree_uk_ssize_t t = 0; t < N * K; ++t) {
+    if (iree_uk_test_random_engine_get_0_65535(engine) < zero_tile_threshold) {
+      memset(rhs.data() + t * rhs_tile_size, 0, rhs_tile_size);
+    }
+  }
+
+  std::vector<char> dense_out(out_buffer_size);
+  iree_uk_test_write_random_buffer(dense_out.data(), out_buffer_size, out_type,
+                                   engine);
+  std::vector<char> sparse_out = dense_out;
+
+  iree_uk_mmt4d_params_t dense_params;
+  memset(&dense_params, 0, sizeof dense_params);
+  dense_params.type = type;
+  dense_params.flags = flags;
+  dense_params.lhs_stride = lhs_stride;
+  dense_params.rhs_stride = rhs_stride;
+  dense_params.out_stride = out_stride;
+  dense_params.M = M;
+  dense_params.N = N;
+  dense_params.K = K;
+  dense_params.M0 = M0;
+  dense_params.N0 = N0;
+  dense_params.K0 = K0;
+  dense_params.lhs_buffer = lhs.data();
+  dense_params.rhs_buffer = rhs.data();
+  dense_params.out_buffer = dense_out.data();
+  dense_params.cpu_data = cpu_data;
+  check_ok(iree_uk_mmt4d(&dense_params), "iree_uk_mmt4d");
+
+  std::vector<iree_uk_int32_t> row_offsets(N + 1);
+  std::vector<iree_uk_int32_t> col_indices(N * K);
+  std::vector<char> values(rhs_buffer_size);
+  iree_uk_mmt4d_sparse_pack_rhs_params_t pack_params;
+  memset(&pack_params, 0, sizeof pack_params);
+  pack_params.type = type;
+  pack_params.in_stride = rhs_stride;
+  pack_params.N = N;
+  pack_params.K = K;
+  pack_params.N0 = N0;
+  pack_params.K0 = K0;
+  pack_params.in_buffer = rhs.data();
+  pack_params.out_row_offsets = row_offsets.data();
+  pack_params.out_col_indices = col_indices.data();
+  pack_params.out_values = values.data();
+  check_ok(iree_uk_mmt4d_sparse_pack_rhs(&pack_params),
+           "iree_uk_mmt4d_sparse_pack_rhs");
+  if (zero_tile_threshold == 0) {
+    // Random tiles are all-zero with negligible probability.
+    EXPECT_EQ(row_offsets[N], N * K);
+  } else if (zero_tile_threshold == 65536) {
+    EXPECT_EQ(row_offsets[N], 0);
+  }
+
+  iree_uk_mmt4d_sparse_params_t sparse_params;
+  memset(&sparse_params, 0, sizeof sparse_params);
+  sparse_params.type = type;
+  sparse_params.flags = flags;
+  sparse_params.lhs_stride = lhs_stride;
+  sparse_params.out_stride = out_stride;
+  sparse_params.M = M;
+  sparse_params.N = N;
+  sparse_params.K = K;
+  sparse_params.M0 = M0;
+  sparse_params.N0 = N0;
+  sparse_params.K0 = K0;
+  sparse_params.lhs_buffer = lhs.data();
+  sparse_params.rhs_row_offsets = row_offsets.data();
+  sparse_params.rhs_col_indices = col_indices.data();
+  sparse_params.rhs_values = values.data();
+  sparse_params.out_buffer = sparse_out.data();
+  sparse_params.cpu_data = cpu_data;
+  check_ok(iree_uk_mmt4d_sparse(&sparse_params), "iree_uk_mmt4d_sparse");
+
+  // Exact comparison: see the comment in mmt4d_test.cc on picking test values
+  // so that float accumulation order does not matter.
+  if (memcmp(dense_out.data(), sparse_out.data(), out_buffer_size)) {
+    char types_str[32];
+    iree_uk_test_type_triple_str(types_str, sizeof types_str, type);
+    fprintf(stderr,
+            "mmt4d_sparse test failure: types %s, M0=%d N0=%d K0=%d, M=%d "
+            "N=%d K=%d, zero_tile_threshold=%d, accumulate=%d\n",
+            types_str, M0, N0, K0, M, N, K, zero_tile_threshold,
+            (bool)(flags & IREE_UK_FLAG_ACCUMULATE));
+    iree_abort();
+  }
+}
+
+static void test_sparse_matmuls(iree_uk_mmt4d_type_t type, int M0, int N0,
+                                int K0, const iree_uk_uint64_t* cpu_data,
+                                iree_uk_test_random_engine_t* engine) {
+  struct shape_mnk_t {
+    int m, n, k;
+  };
+  std::vector<shape_mnk_t> shapes{
+      {0, 3, 3}, {3, 0, 3}, {3, 3, 0}, {1, 1, 1},
+      {2, 3, 5}, {5, 7, 13}, {1, 4, 64},
+  };
+  for (shape_mnk_t shape : shapes) {
+    for (int zero_tile_threshold : {0, 20000, 50000, 65536}) {
+      for (bool accumulate : {false, true}) {
+        test_one_sparse_matmul(type, M0, N0, K0, shape.m, shape.n, shape.k,
+                               zero_tile_threshold,
+                               accumulate ? IREE_UK_FLAG_ACCUMULATE : 0,
+                               cpu_data, engine);
+      }
+    }
+  }
+}
+
+// See mmt4d_test in mmt4d_test.cc.
+static void mmt4d_sparse_test(iree_uk_mmt4d_type_t type, int M0, int N0,
+                              int K0, iree_uk_uint64_t cpu_data_field_0_bit) {
+  iree_uk_test_random_engine_t* engine = iree_uk_test_random_engine_create();
+  const iree_uk_uint64_t local_cpu_data_default[IREE_CPU_DATA_FIELD_COUNT] = {
+      0};
+  test_sparse_matmuls(type, M0, N0, K0, local_cpu_data_default, engine);
+  if (cpu_data_field_0_bit) {
+    const iree_uk_uint64_t local_cpu_data_with_bit[IREE_CPU_DATA_FIELD_COUNT] =
+        {cpu_data_field_0_bit};
+    char cpu_feat_str[32];
+    iree_uk_test_cpu_features_str(cpu_feat_str, sizeof cpu_feat_str,
+                                  local_cpu_data_with_bit, 1);
+    if (iree_cpu_data_field(0) & cpu_data_field_0_bit) {
+      printf("Device supports CPU feature: %s\n", cpu_feat_str);
+      test_sparse_matmuls(type, M0, N0, K0, local_cpu_data_with_bit, engine);
+    } else {
+      printf("Skipped: device does not support CPU feature: %s\n",
+             cpu_feat_str);
+    }
+  }
+  iree_uk_test_random_engine_destroy(engine);
+}
+
+#define MMT4D_SPARSE_TEST(type, M0, N0, K0, test_suffix, feature_bit)     \
+  TEST(Mmt4dSparseTest, type##_tile_##M0##x##N0##x##K0##_##test_suffix) { \
+    mmt4d_sparse_test(iree_uk_mmt4d_type_##type, M0, N0, K0, feature_bit); \
+  }
+
+MMT4D_SPARSE_TEST(f32f32f32, 4, 4, 4, generic, 0)
+MMT4D_SPARSE_TEST(i8i8i32, 3, 5, 7, generic, 0)
+MMT4D_SPARSE_TEST(f16f16f32, 4, 4, 2, generic, 0)
+MMT4D_SPARSE_TEST(bf16bf16f32, 4, 4, 2, generic, 0)
+
+#if defined(IREE_UK_ARCH_ARM_64)
+MMT4D_SPARSE_TEST(f32f32f32, 8, 8, 1, arm_64, 0)
+MMT4D_SPARSE_TEST(i8i8i32, 8, 8, 1, arm_64, 0)
+MMT4D_SPARSE_TEST(i8i8i32, 8, 8, 4, arm_64_DOTPROD,
+                  IREE_CPU_DATA_FIELD_0_AARCH64_HAVE_DOTPROD)
+MMT4D_SPARSE_TEST(i8i8i32, 8, 8, 8, arm_64_I8MM,
+                  IREE_CPU_DATA_FIELD_0_AARCH64_HAVE_I8MM)
+#endif  // defined(IREE_UK_ARCH_ARM_64)
+
+#if defined(IREE_UK_ARCH_X86_64)
+MMT4D_SPARSE_TEST(f32f32f32, 8, 8, 1, x86_64_AVX2_FMA,
+                  IREE_CPU_DATA_FIELD_0_X86_64_HAVE_AVX2_FMA)
+MMT4D_SPARSE_TEST(i8i8i32, 16, 16, 2, x86_64_AVX512_BASE,
+                  IREE_CPU_DATA_FIELD_0_X86_64_HAVE_AVX512_BASE)
+#endif  // defined(IREE_UK_ARCH_X86_64)
+
+int main(int argc, char** argv) {
+  ::testing::InitGoogleTest(&argc, argv);
+  iree_cpu_initialize(iree_allocator_system());
+  return RUN_ALL_TESTS();
+}
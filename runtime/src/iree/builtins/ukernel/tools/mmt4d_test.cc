@@ -45,6 +45,8 @@
 
 #include "iree/builtins/ukernel/mmt4d.h"
 
+#include <algorithm>
+#include <cstdint>
 #include <vector>
 
 #include "iree/base/api.h"
@@ -89,6 +91,110 @@ static void iree_mmt4d_reference(const iree_uk_mmt4d_params_t& params) {
   }
 }
 
+// Reference for the 16-bit floating-point input types. Like the ukernel this
+// accumulates in f32 and, for f16 outputs, rounds once on store.
+static void iree_mmt4d_reference_float16(const iree_uk_mmt4d_params_t& params,
+                                         float (*in_to_f32)(iree_uk_uint16_t),
+                                         bool out_f16) {
+  bool accumulate = params.flags & IREE_UK_FLAG_ACCUMULATE;
+  iree_uk_ssize_t lhs_tile_size = params.M0 * params.K0;
+  iree_uk_ssize_t rhs_tile_size = params.N0 * params.K0;
+  iree_uk_ssize_t out_tile_size = params.M0 * params.N0;
+  for (iree_uk_ssize_t i = 0; i < params.M; ++i) {
+    for (iree_uk_ssize_t j = 0; j < params.N; ++j) {
+      iree_uk_ssize_t out_tile_offset =
+          i * params.out_stride + j * out_tile_size;
+      const iree_uk_uint16_t* lhs_panel_ptr =
+          ((const iree_uk_uint16_t*)params.lhs_buffer) + i * params.lhs_stride;
+      const iree_uk_uint16_t* rhs_panel_ptr =
+          ((const iree_uk_uint16_t*)params.rhs_buffer) + j * params.rhs_stride;
+      for (iree_uk_ssize_t i0 = 0; i0 < params.M0; ++i0) {
+        for (iree_uk_ssize_t j0 = 0; j0 < params.N0; ++j0) {
+          const iree_uk_uint16_t* lhs_tile_ptr = lhs_panel_ptr;
+          const iree_uk_uint16_t* rhs_tile_ptr = rhs_panel_ptr;
+          iree_uk_ssize_t out_offset = out_tile_offset + i0 * params.N0 + j0;
+          iree_uk_uint16_t* out_f16_ptr =
+              (iree_uk_uint16_t*)params.out_buffer + out_offset;
+          float* out_f32_ptr = (float*)params.out_buffer + out_offset;
+          float acc = 0.f;
+          if (accumulate) {
+            acc = out_f16 ? iree_uk_f16_to_f32(*out_f16_ptr) : *out_f32_ptr;
+          }
+          for (iree_uk_ssize_t k = 0; k < params.K; ++k) {
+            for (iree_uk_ssize_t k0 = 0; k0 < params.K0; ++k0) {
+              float lhs_val = in_to_f32(lhs_tile_ptr[i0 * params.K0 + k0]);
+              float rhs_val = in_to_f32(rhs_tile_ptr[j0 * params.K0 + k0]);
+              acc += lhs_val * rhs_val;
+            }
+            lhs_tile_ptr += lhs_tile_size;
+            rhs_tile_ptr += rhs_tile_size;
+          }
+          if (out_f16) {
+            *out_f16_ptr = iree_uk_f32_to_f16(acc);
+          } else {
+            *out_f32_ptr = acc;
+          }
+        }
+      }
+    }
+  }
+}
+
+// Reference for the types with an int4 RHS. Like the ukernel this sums the
+// unscaled products over each group of K tiles before scaling, so that the
+// results match exactly for small integer inputs and scales.
+static void iree_mmt4d_reference_rhs_i4(const iree_uk_mmt4d_params_t& params,
+                                        bool lhs_f16) {
+  bool accumulate = params.flags & IREE_UK_FLAG_ACCUMULATE;
+  const auto& quant = params.rhs_quant;
+  iree_uk_ssize_t lhs_tile_size = params.M0 * params.K0;
+  iree_uk_ssize_t rhs_tile_size = params.N0 * params.K0;
+  iree_uk_ssize_t out_tile_size = params.M0 * params.N0;
+  for (iree_uk_ssize_t i = 0; i < params.M; ++i) {
+    for (iree_uk_ssize_t j = 0; j < params.N; ++j) {
+      for (iree_uk_ssize_t i0 = 0; i0 < params.M0; ++i0) {
+        for (iree_uk_ssize_t j0 = 0; j0 < params.N0; ++j0) {
+          float* out_ptr = (float*)params.out_buffer + i * params.out_stride +
+                           j * out_tile_size + i0 * params.N0 + j0;
+          float acc = accumulate ? *out_ptr : 0.f;
+          for (iree_uk_ssize_t k_group = 0; k_group < params.K;
+               k_group += quant.group_size) {
+            float group_acc = 0.f;
+            iree_uk_ssize_t k_end =
+                std::min<iree_uk_ssize_t>(params.K, k_group + quant.group_size);
+            for (iree_uk_ssize_t k = k_group; k < k_end; ++k) {
+              for (iree_uk_ssize_t k0 = 0; k0 < params.K0; ++k0) {
+                iree_uk_ssize_t lhs_index = i * params.lhs_stride +
+                                            k * lhs_tile_size +
+                                            i0 * params.K0 + k0;
+                const void* lhs = params.lhs_buffer;
+                float lhs_val =
+                    lhs_f16 ? iree_uk_f16_to_f32(
+                                  ((const iree_uk_uint16_t*)lhs)[lhs_index])
+                            : ((const float*)lhs)[lhs_index];
+                iree_uk_ssize_t rhs_index = j * params.rhs_stride +
+                                            k * rhs_tile_size +
+                                            j0 * params.K0 + k0;
+                iree_uk_uint8_t rhs_byte =
+                    ((const iree_uk_uint8_t*)params.rhs_buffer)[rhs_index / 2];
+                int rhs_nibble = (rhs_byte >> (4 * (rhs_index % 2))) & 0xF;
+                int rhs_val = rhs_nibble >= 8 ? rhs_nibble - 16 : rhs_nibble;
+                group_acc += lhs_val * rhs_val;
+              }
+            }
+            float scale = quant.scales_buffer[j * quant.scales_stride +
+                                              (k_group / quant.group_size) *
+                                                  params.N0 +
+                                              j0];
+            acc += scale * group_acc;
+          }
+          *out_ptr = acc;
+        }
+      }
+    }
+  }
+}
+
 static void iree_mmt4d_reference(const iree_uk_mmt4d_params_t& params) {
   switch (params.type) {
     case iree_uk_mmt4d_type_f32f32f32:
@@ -98,11 +204,109 @@ static void iree_mmt4d_reference(const iree_uk_mmt4d_params_t& params) {
       iree_mmt4d_reference<iree_uk_int8_t, iree_uk_int8_t, iree_uk_int32_t>(
           params);
       break;
+    case iree_uk_mmt4d_type_f16f16f32:
+      iree_mmt4d_reference_float16(params, iree_uk_f16_to_f32, false);
+      break;
+    case iree_uk_mmt4d_type_f16f16f16:
+      iree_mmt4d_reference_float16(params, iree_uk_f16_to_f32, true);
+      break;
+    case iree_uk_mmt4d_type_bf16bf16f32:
+      iree_mmt4d_reference_float16(params, iree_uk_bf16_to_f32, false);
+      break;
+    case iree_uk_mmt4d_type_f32i4f32:
+      iree_mmt4d_reference_rhs_i4(params, false);
+      break;
+    case iree_uk_mmt4d_type_f16i4f32:
+      iree_mmt4d_reference_rhs_i4(params, true);
+      break;
     default:
       assert(false && "unknown type");
   }
 }
 
+#define IREE_UK_MMT4D_TEST_EPILOGUE_FLAGS                                \
+  (IREE_UK_FLAG_MMT4D_EPILOGUE_BIAS | IREE_UK_FLAG_MMT4D_EPILOGUE_CLAMP | \
+   IREE_UK_FLAG_MMT4D_EPILOGUE_REQUANTIZE)
+
+template <typename T>
+static T iree_mmt4d_clamp(T val, T lo, T hi) {
+  return val < lo ? lo : val > hi ? hi : val;
+}
+
+// Requantization as specified by gemmlowp: a rounding doubling high multiply
+// followed by a rounding right shift, each rounding to nearest.
+static iree_uk_int32_t iree_mmt4d_requantize_reference(
+    iree_uk_int32_t acc, const iree_uk_mmt4d_epilogue_params_t& epilogue) {
+  iree_uk_int64_t a = acc;
+  iree_uk_int64_t b = epilogue.requant_multiplier;
+  iree_uk_int32_t high;
+  if (a == INT32_MIN && b == INT32_MIN) {
+    high = INT32_MAX;
+  } else {
+    iree_uk_int64_t ab = a * b;
+    iree_uk_int64_t nudge = ab >= 0 ? (1 << 30) : (1 - (1 << 30));
+    high = static_cast<iree_uk_int32_t>((ab + nudge) / (1ll << 31));
+  }
+  int shift = epilogue.requant_shift;
+  iree_uk_int32_t mask = static_cast<iree_uk_int32_t>((1ull << shift) - 1);
+  iree_uk_int32_t remainder = high & mask;
+  iree_uk_int32_t threshold = (mask >> 1) + (high < 0 ? 1 : 0);
+  return (high >> shift) + (remainder > threshold ? 1 : 0);
+}
+
+// Reference for the fused epilogue, reading accumulators from |acc_buffer| and
+// writing results to params.out_buffer. The two alias unless requantizing.
+template <typename acc_t>
+static void iree_mmt4d_epilogue_reference(const iree_uk_mmt4d_params_t& params,
+                                          const acc_t* acc_buffer, acc_t lo,
+                                          acc_t hi) {
+  const auto& epilogue = params.epilogue;
+  bool bias = params.flags & IREE_UK_FLAG_MMT4D_EPILOGUE_BIAS;
+  bool clamp = params.flags & IREE_UK_FLAG_MMT4D_EPILOGUE_CLAMP;
+  bool requantize = params.flags & IREE_UK_FLAG_MMT4D_EPILOGUE_REQUANTIZE;
+  iree_uk_ssize_t out_tile_size = params.M0 * params.N0;
+  for (iree_uk_ssize_t i = 0; i < params.M; ++i) {
+    for (iree_uk_ssize_t j = 0; j < params.N; ++j) {
+      for (iree_uk_ssize_t i0 = 0; i0 < params.M0; ++i0) {
+        for (iree_uk_ssize_t j0 = 0; j0 < params.N0; ++j0) {
+          iree_uk_ssize_t offset = i * params.out_stride + j * out_tile_size +
+                                   i0 * params.N0 + j0;
+          acc_t val = acc_buffer[offset];
+          if (bias) {
+            val += ((const acc_t*)epilogue.bias_buffer)[j * params.N0 + j0];
+          }
+          if (requantize) {
+            iree_uk_int32_t q = iree_mmt4d_requantize_reference(
+                static_cast<iree_uk_int32_t>(val), epilogue);
+            q += epilogue.requant_zero_point;
+            if (clamp) q = iree_mmt4d_clamp<iree_uk_int32_t>(q, lo, hi);
+            q = iree_mmt4d_clamp<iree_uk_int32_t>(q, -128, 127);
+            ((iree_uk_int8_t*)params.out_buffer)[offset] = q;
+          } else {
+            if (clamp) val = iree_mmt4d_clamp(val, lo, hi);
+            ((acc_t*)params.out_buffer)[offset] = val;
+          }
+        }
+      }
+    }
+  }
+}
+
+static void iree_mmt4d_epilogue_reference(const iree_uk_mmt4d_params_t& params,
+                                          const void* acc_buffer) {
+  const auto& epilogue = params.epilogue;
+  iree_uk_type_t out_type = iree_uk_mmt4d_out_type(params.type);
+  if (out_type == IREE_UK_TYPE_FLOAT_32) {
+    iree_mmt4d_epilogue_reference<float>(params, (const float*)acc_buffer,
+                                         epilogue.clamp_min_f32,
+                                         epilogue.clamp_max_f32);
+  } else {
+    iree_mmt4d_epilogue_reference<iree_uk_int32_t>(
+        params, (const iree_uk_int32_t*)acc_buffer, epilogue.clamp_min_i32,
+        epilogue.clamp_max_i32);
+  }
+}
+
 static void test_one_matmul_using_given_lhs_rhs(
     const iree_uk_mmt4d_params_t& shared_params,
     iree_uk_test_random_engine_t* engine) {
@@ -110,7 +314,7 @@ static void test_one_matmul_using_given_lhs_rhs(
 
   iree_uk_mmt4d_params_t reference_params;
   memcpy(&reference_params, &shared_params, sizeof shared_params);
-  iree_uk_type_t out_type = iree_uk_mmt4d_out_type(shared_params.type);
+  iree_uk_type_t out_type = iree_uk_mmt4d_out_buffer_type(&shared_params);
   iree_uk_ssize_t out_buffer_size = iree_uk_test_2d_buffer_length(
       out_type, shared_params.M, shared_params.out_stride);
   reference_params.out_buffer = malloc(out_buffer_size);
@@ -123,7 +327,25 @@ static void test_one_matmul_using_given_lhs_rhs(
   memcpy(actual_params.out_buffer, reference_params.out_buffer,
          out_buffer_size);
 
-  iree_mmt4d_reference(reference_params);
+  if (shared_params.flags & IREE_UK_MMT4D_TEST_EPILOGUE_FLAGS) {
+    // Compute the plain matmul into an accumulator buffer, then apply the
+    // epilogue separately from it.
+    iree_uk_mmt4d_params_t acc_params;
+    memcpy(&acc_params, &reference_params, sizeof reference_params);
+    acc_params.flags &= ~IREE_UK_MMT4D_TEST_EPILOGUE_FLAGS;
+    bool requantize =
+        shared_params.flags & IREE_UK_FLAG_MMT4D_EPILOGUE_REQUANTIZE;
+    if (requantize) {
+      iree_uk_type_t acc_type = iree_uk_mmt4d_out_type(shared_params.type);
+      acc_params.out_buffer = malloc(iree_uk_test_2d_buffer_length(
+          acc_type, shared_params.M, shared_params.out_stride));
+    }
+    iree_mmt4d_reference(acc_params);
+    iree_mmt4d_epilogue_reference(reference_params, acc_params.out_buffer);
+    if (requantize) free(acc_params.out_buffer);
+  } else {
+    iree_mmt4d_reference(reference_params);
+  }
   iree_uk_status_t status = iree_uk_mmt4d(&actual_params);
   if (status != iree_uk_status_ok) {
     fprintf(stderr, "FATAL: iree_uk_mmt4d failed: %s\n",
@@ -134,9 +356,10 @@ static void test_one_matmul_using_given_lhs_rhs(
   // For now we use exact comparisons, even for float, even though the reference
   // code accumulates in a different order compared to the actual code. This
   // relies on picking input test matrix elements so that all intermediate
-  // values are exactly representable - i.e. small integer numerators. This
-  // become problematic when we do float16. See the comment at the top of this
-  // file explaining how we refrain from letting this grow into a 1000-line-long
+  // values are exactly representable - i.e. small integer numerators. For
+  // 16-bit float types this holds because accumulation happens in f32 and f16
+  // outputs are rounded only once. See the comment at the top of this file
+  // explaining how we refrain from letting this grow into a 1000-line-long
   // fully-featured test.
   if (memcmp(actual_params.out_buffer, reference_params.out_buffer,
              out_buffer_size)) {
@@ -145,8 +368,13 @@ static void test_one_matmul_using_given_lhs_rhs(
     char types_str[32];
     iree_uk_test_type_triple_str(types_str, sizeof types_str, p.type);
     fprintf(stderr, "  types: %s\n", types_str);
-    fprintf(stderr, "  flags: accumulate=%d\n",
-            (bool)(p.flags & IREE_UK_FLAG_ACCUMULATE));
+    fprintf(stderr,
+            "  flags: accumulate=%d, epilogue_bias=%d, epilogue_clamp=%d, "
+            "epilogue_requantize=%d\n",
+            (bool)(p.flags & IREE_UK_FLAG_ACCUMULATE),
+            (bool)(p.flags & IREE_UK_FLAG_MMT4D_EPILOGUE_BIAS),
+            (bool)(p.flags & IREE_UK_FLAG_MMT4D_EPILOGUE_CLAMP),
+            (bool)(p.flags & IREE_UK_FLAG_MMT4D_EPILOGUE_REQUANTIZE));
     fprintf(stderr, "  M=%d, N=%d, K=%d\n", (int)p.M, (int)p.N, (int)p.K);
     fprintf(stderr, "  M0=%d, N0=%d, K0=%d\n", (int)p.M0, (int)p.N0, (int)p.K0);
     fprintf(stderr, "  lhs_stride=%zu, rhs_stride=%zu, out_stride=%zu\n",
@@ -187,12 +415,15 @@ static void test_one_matmul_creating_lhs_rhs_for_given_shape(
   // Randomly make strides either tight or not to exercise all cases.
   params.lhs_stride = params.K * params.M0 * params.K0 +
                       iree_uk_test_random_engine_get_0_1(engine);
+  iree_uk_type_t rhs_type = iree_uk_mmt4d_rhs_type(params.type);
+  bool rhs_i4 = rhs_type == IREE_UK_TYPE_SINT_4;
+  // Panels of int4 values must start on a byte boundary.
   params.rhs_stride = params.K * params.N0 * params.K0 +
-                      iree_uk_test_random_engine_get_0_1(engine);
+                      iree_uk_test_random_engine_get_0_1(engine) *
+                          (rhs_i4 ? 2 : 1);
   params.out_stride = params.N * params.M0 * params.N0 +
                       iree_uk_test_random_engine_get_0_1(engine);
   iree_uk_type_t lhs_type = iree_uk_mmt4d_lhs_type(params.type);
-  iree_uk_type_t rhs_type = iree_uk_mmt4d_rhs_type(params.type);
   iree_uk_ssize_t lhs_buffer_size =
       iree_uk_test_2d_buffer_length(lhs_type, params.M, params.lhs_stride);
   iree_uk_ssize_t rhs_buffer_size =
@@ -205,9 +436,39 @@ static void test_one_matmul_creating_lhs_rhs_for_given_shape(
                                    engine);
   params.lhs_buffer = lhs_buffer;
   params.rhs_buffer = rhs_buffer;
+  void* bias_buffer = nullptr;
+  if (params.flags & IREE_UK_FLAG_MMT4D_EPILOGUE_BIAS) {
+    iree_uk_type_t acc_type = iree_uk_mmt4d_out_type(params.type);
+    iree_uk_ssize_t bias_buffer_size =
+        iree_uk_test_2d_buffer_length(acc_type, 1, params.N * params.N0);
+    bias_buffer = malloc(bias_buffer_size);
+    iree_uk_test_write_random_buffer(bias_buffer, bias_buffer_size, acc_type,
+                                     engine);
+    params.epilogue.bias_buffer = bias_buffer;
+  }
+  float* scales_buffer = nullptr;
+  if (rhs_i4) {
+    // Small integer scales, like the other test values, keep results exact.
+    // Group sizes are picked to exercise a shorter last group.
+    params.rhs_quant.group_size =
+        1 + iree_uk_test_random_engine_get_0_65535(engine) % 4;
+    iree_uk_ssize_t num_groups =
+        (params.K + params.rhs_quant.group_size - 1) /
+        params.rhs_quant.group_size;
+    params.rhs_quant.scales_stride = num_groups * params.N0 +
+                                     iree_uk_test_random_engine_get_0_1(engine);
+    iree_uk_ssize_t scales_buffer_size = iree_uk_test_2d_buffer_length(
+        IREE_UK_TYPE_FLOAT_32, params.N, params.rhs_quant.scales_stride);
+    scales_buffer = (float*)malloc(scales_buffer_size);
+    iree_uk_test_write_random_buffer(scales_buffer, scales_buffer_size,
+                                     IREE_UK_TYPE_FLOAT_32, engine);
+    params.rhs_quant.scales_buffer = scales_buffer;
+  }
   test_one_matmul_using_given_lhs_rhs(params, engine);
   free(lhs_buffer);
   free(rhs_buffer);
+  free(bias_buffer);
+  free(scales_buffer);
 }
 
 static void test_matmuls_for_various_MNK_shapes_and_flags(
@@ -243,13 +504,44 @@ static void test_matmuls_for_various_MNK_shapes_and_flags(
       {2, 2, 2},
       {5, 7, 13},
   };
+  // Epilogue flag combinations to test on top of each shape.
+  const iree_uk_uint32_t epilogue_flags_list[] = {
+      0,
+      IREE_UK_FLAG_MMT4D_EPILOGUE_BIAS,
+      IREE_UK_FLAG_MMT4D_EPILOGUE_BIAS | IREE_UK_FLAG_MMT4D_EPILOGUE_CLAMP,
+      IREE_UK_FLAG_MMT4D_EPILOGUE_REQUANTIZE,
+      IREE_UK_FLAG_MMT4D_EPILOGUE_BIAS | IREE_UK_FLAG_MMT4D_EPILOGUE_CLAMP |
+          IREE_UK_FLAG_MMT4D_EPILOGUE_REQUANTIZE,
+  };
+  bool is_i32_acc = params.type == iree_uk_mmt4d_type_i8i8i32;
   for (shape_mnk_t shape : shapes) {
     params.M = shape.m;
     params.N = shape.n;
     params.K = shape.k;
     for (bool accumulate : {false, true}) {
-      params.flags = accumulate ? IREE_UK_FLAG_ACCUMULATE : 0;
-      test_one_matmul_creating_lhs_rhs_for_given_shape(params, engine);
+      for (iree_uk_uint32_t epilogue_flags : epilogue_flags_list) {
+        bool requantize =
+            epilogue_flags & IREE_UK_FLAG_MMT4D_EPILOGUE_REQUANTIZE;
+        if (epilogue_flags && params.type == iree_uk_mmt4d_type_f16f16f16) {
+          continue;
+        }
+        if (requantize && (accumulate || !is_i32_acc)) continue;
+        params.flags =
+            (accumulate ? IREE_UK_FLAG_ACCUMULATE : 0) | epilogue_flags;
+        // Clamp bounds and requantization parameters are picked so that
+        // each of them actually changes some output values.
+        params.epilogue.clamp_min_f32 = -50.f;
+        params.epilogue.clamp_max_f32 = 100.f;
+        params.epilogue.clamp_min_i32 = requantize ? -100 : -500;
+        params.epilogue.clamp_max_i32 = requantize ? 110 : 1000;
+        params.epilogue.requant_multiplier =
+            (1 << 30) + (iree_uk_test_random_engine_get_0_65535(engine) << 14);
+        params.epilogue.requant_shift =
+            iree_uk_test_random_engine_get_0_65535(engine) % 8;
+        params.epilogue.requant_zero_point =
+            iree_uk_test_random_engine_get_minus16_plus15(engine);
+        test_one_matmul_creating_lhs_rhs_for_given_shape(params, engine);
+      }
     }
   }
 }
@@ -279,6 +571,12 @@ static void mmt4d_test(iree_uk_mmt4d_type_t type, int M0, int N0, int K0,
   // feature is supported by the CPU because we want to test the fallback to
   // architecture-default or generic code.
   test_matmuls_for_various_MNK_shapes_and_flags(params, engine);
+  // Again with a tiny L2 cache size, so that the N dimension gets split into
+  // several cache blocks even on the small shapes tested here.
+  const iree_uk_uint64_t local_cpu_data_tiny_l2[IREE_CPU_DATA_FIELD_COUNT] = {
+      0, 1ull << IREE_CPU_DATA_FIELD_1_L2_CACHE_KIB_SHIFT};
+  params.cpu_data = local_cpu_data_tiny_l2;
+  test_matmuls_for_various_MNK_shapes_and_flags(params, engine);
   // If this is nonzero, we are asked to test again with this CPU feature.
   if (cpu_data_field_0_bit) {
     const iree_uk_uint64_t local_cpu_data_with_bit[IREE_CPU_DATA_FIELD_COUNT] =
@@ -311,6 +609,11 @@ static void mmt4d_test(iree_uk_mmt4d_type_t type, int M0, int N0, int K0,
 // power-of-two assumption
 MMT4D_TEST(f32f32f32, 3, 5, 7, generic, 0)
 MMT4D_TEST(i8i8i32, 9, 6, 3, generic, 0)
+MMT4D_TEST(f16f16f32, 3, 5, 2, generic, 0)
+MMT4D_TEST(f16f16f16, 5, 3, 1, generic, 0)
+MMT4D_TEST(bf16bf16f32, 4, 7, 2, generic, 0)
+MMT4D_TEST(f32i4f32, 3, 5, 2, generic, 0)
+MMT4D_TEST(f16i4f32, 5, 2, 3, generic, 0)
 
 // ARM_64 tests.
 #if defined(IREE_UK_ARCH_ARM_64)
@@ -328,6 +631,72 @@ MMT4D_ARM_64_TEST_WITH_CPU_FEATURE(i8i8i32, 8, 8, 4, DOTPROD)
 MMT4D_ARM_64_TEST_WITH_CPU_FEATURE(i8i8i32, 8, 8, 8, I8MM)
 #endif  // defined(IREE_UK_ARCH_ARM_64)
 
+// X86_64 tests. All x86-64 tiles require at least one optional CPU feature.
+#if defined(IREE_UK_ARCH_X86_64)
+
+#define MMT4D_X86_64_TEST_WITH_CPU_FEATURE(type, M0, N0, K0, FEATURE) \
+  MMT4D_TEST(type, M0, N0, K0, x86_64_##FEATURE,                      \
+             IREE_CPU_DATA_FIELD_0_X86_64_HAVE_##FEATURE)
+
+MMT4D_X86_64_TEST_WITH_CPU_FEATURE(f32f32f32, 8, 8, 1, AVX2_FMA)
+MMT4D_X86_64_TEST_WITH_CPU_FEATURE(i8i8i32, 8, 8, 2, AVX2_FMA)
+MMT4D_X86_64_TEST_WITH_CPU_FEATURE(f32i4f32, 8, 8, 1, AVX2_FMA)
+MMT4D_X86_64_TEST_WITH_CPU_FEATURE(f32f32f32, 16, 16, 1, AVX512_BASE)
+MMT4D_X86_64_TEST_WITH_CPU_FEATURE(i8i8i32, 16, 16, 2, AVX512_BASE)
+MMT4D_X86_64_TEST_WITH_CPU_FEATURE(i8i8i32, 16, 16, 2, AVX512VNNI)
+MMT4D_X86_64_TEST_WITH_CPU_FEATURE(f16f16f32, 16, 16, 1, AVX512_BASE)
+MMT4D_X86_64_TEST_WITH_CPU_FEATURE(f16f16f16, 16, 16, 1, AVX512_BASE)
+MMT4D_X86_64_TEST_WITH_CPU_FEATURE(bf16bf16f32, 16, 16, 2, AVX512_BASE)
+MMT4D_X86_64_TEST_WITH_CPU_FEATURE(bf16bf16f32, 16, 16, 2, AVX512BF16)
+#endif  // defined(IREE_UK_ARCH_X86_64)
+
+// RISCV_64 tests. All riscv64 tiles require the V extension.
+#if defined(IREE_UK_ARCH_RISCV_64)
+
+#define MMT4D_RISCV_64_TEST_WITH_CPU_FEATURE(type, M0, N0, K0, FEATURE) \
+  MMT4D_TEST(type, M0, N0, K0, riscv_64_##FEATURE,                      \
+             IREE_CPU_DATA_FIELD_0_RISCV_64_HAVE_##FEATURE)
+
+MMT4D_RISCV_64_TEST_WITH_CPU_FEATURE(f32f32f32, 8, 8, 1, V)
+MMT4D_RISCV_64_TEST_WITH_CPU_FEATURE(i8i8i32, 8, 8, 1, V)
+MMT4D_RISCV_64_TEST_WITH_CPU_FEATURE(f32f32f32, 8, 16, 1, ZVL256B)
+MMT4D_RISCV_64_TEST_WITH_CPU_FEATURE(i8i8i32, 8, 16, 1, ZVL256B)
+#endif  // defined(IREE_UK_ARCH_RISCV_64)
+
+// WASM_32 tests. SIMD128 has no runtime feature detection.
+#if defined(IREE_UK_ARCH_WASM_32)
+
+#define MMT4D_WASM_32_TEST(type, M0, N0, K0) \
+  MMT4D_TEST(type, M0, N0, K0, wasm_32, 0)
+
+MMT4D_WASM_32_TEST(f32f32f32, 8, 8, 1)
+MMT4D_WASM_32_TEST(i8i8i32, 8, 8, 1)
+#endif  // defined(IREE_UK_ARCH_WASM_32)
+
+// Checks that the tile shape picked for the host CPU at load time is one
+// that mmt4d computes correctly with.
+static void mmt4d_query_tile_sizes_test(iree_uk_mmt4d_type_t type) {
+  iree_uk_test_random_engine_t* engine = iree_uk_test_random_engine_create();
+  iree_uk_mmt4d_params_t params;
+  memset(&params, 0, sizeof params);
+  params.type = type;
+  params.cpu_data = (const iree_uk_uint64_t*)iree_cpu_data_fields();
+  ASSERT_EQ(iree_uk_mmt4d_query_tile_sizes(&params), iree_uk_status_ok);
+  EXPECT_GT(params.M0, 0);
+  EXPECT_GT(params.N0, 0);
+  EXPECT_GT(params.K0, 0);
+  test_matmuls_for_various_MNK_shapes_and_flags(params, engine);
+  iree_uk_test_random_engine_destroy(engine);
+}
+
+TEST(Mmt4dTest, query_tile_sizes_f32f32f32) {
+  mmt4d_query_tile_sizes_test(iree_uk_mmt4d_type_f32f32f32);
+}
+
+TEST(Mmt4dTest, query_tile_sizes_i8i8i32) {
+  mmt4d_query_tile_sizes_test(iree_uk_mmt4d_type_i8i8i32);
+}
+
 int main(int argc, char** argv) {
   ::testing::InitGoogleTest(&argc, argv);
   iree_cpu_initialize(iree_allocator_system());
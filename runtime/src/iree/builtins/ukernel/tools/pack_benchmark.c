@@ -222,6 +222,12 @@ static void iree_pack_benchmark_register(
                           IREE_CPU_DATA_FIELD_0_AARCH64_HAVE_##_cpu_feature,   \
                           arm_64_##_cpu_feature)
 
+#define PACK_BENCHMARK_REGISTER_RISCV_64_WITH_CPU_FEATURE(                    \
+    _type, _size2, _size3, _cpu_feature)                                      \
+  PACK_BENCHMARK_REGISTER(_type, _size2, _size3,                              \
+                          IREE_CPU_DATA_FIELD_0_RISCV_64_HAVE_##_cpu_feature, \
+                          riscv_64_##_cpu_feature)
+
 int main(int argc, char** argv) {
   iree_flags_set_usage("pack_benchmark",
                        "Benchmarks the pack microkernel.\n"
@@ -255,6 +261,14 @@ int main(int argc, char** argv) {
 
 #endif  // defined(IREE_UK_ARCH_ARM_64)
 
+// RISCV_64 benchmarks.
+#if defined(IREE_UK_ARCH_RISCV_64)
+
+  PACK_BENCHMARK_REGISTER_RISCV_64_WITH_CPU_FEATURE(f32f32, 8, 1, V);
+  PACK_BENCHMARK_REGISTER_RISCV_64_WITH_CPU_FEATURE(i8i8, 8, 1, V);
+
+#endif  // defined(IREE_UK_ARCH_RISCV_64)
+
   iree_benchmark_run_specified();
   return 0;
 }
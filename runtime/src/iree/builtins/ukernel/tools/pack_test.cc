@@ -16,10 +16,29 @@
 #include "iree/testing/gtest.h"
 #include "iree/testing/status_matchers.h"
 
+// Copies element |in_offset| of |in_buffer| to element |out_offset| of
+// |out_buffer|, both buffers of 4-bit values.
+static void iree_pack_reference_copy_4bit(void* out_buffer,
+                                          iree_uk_ssize_t out_offset,
+                                          const void* in_buffer,
+                                          iree_uk_ssize_t in_offset) {
+  iree_uk_uint8_t nibble =
+      (((const iree_uk_uint8_t*)in_buffer)[in_offset / 2] >>
+       (4 * (in_offset % 2))) &
+      0xF;
+  iree_uk_uint8_t* out_ptr = (iree_uk_uint8_t*)out_buffer + out_offset / 2;
+  if (out_offset % 2) {
+    *out_ptr = (*out_ptr & 0x0F) | (nibble << 4);
+  } else {
+    *out_ptr = (*out_ptr & 0xF0) | nibble;
+  }
+}
+
 static void iree_pack_reference(const iree_uk_pack_params_t& params) {
   // For now, the input and output element types are always the same.
   iree_uk_type_t elem_type = iree_uk_pack_in_type(params.type);
-  iree_uk_ssize_t elem_size = iree_uk_type_size(elem_type);
+  bool is_4bit = iree_uk_type_bit_count(elem_type) == 4;
+  iree_uk_ssize_t elem_size = is_4bit ? 0 : iree_uk_type_size(elem_type);
   iree_uk_ssize_t outer_size0 = params.out_size0;
   iree_uk_ssize_t outer_size1 = params.out_size1;
   iree_uk_ssize_t tile_size0 = params.out_size2;
@@ -49,6 +68,14 @@ static void iree_pack_reference(const iree_uk_pack_params_t& params) {
               outer_i1 * out_stride_l1 + tile_i1 * out_stride_l3;
           iree_uk_ssize_t i0 = outer_i0 * tile_size0 + tile_i0;
           iree_uk_ssize_t i1 = outer_i1 * tile_size1 + tile_i1;
+          if (is_4bit) {
+            bool pad = i0 >= params.in_size0 || i1 >= params.in_size1;
+            iree_pack_reference_copy_4bit(
+                params.out_buffer, out_offset,
+                pad ? params.padding_value : params.in_buffer,
+                pad ? 0 : i1 + i0 * params.in_stride0);
+            continue;
+          }
           char* out_ptr = ((char*)params.out_buffer) + out_offset * elem_size;
           if (i0 >= params.in_size0 || i1 >= params.in_size1) {
             memcpy(out_ptr, params.padding_value, elem_size);
@@ -205,10 +232,11 @@ static void pack_test_for_various_tile_shapes_and_flags(
         params.in_size1 =
             std::max<iree_uk_ssize_t>(0, out_size1 * out_size3 - pad_size1);
         iree_uk_type_t out_type = iree_uk_pack_out_type(type);
-        int out_elem_size = iree_uk_type_size(out_type);
-        void* padding_value_buffer = malloc(out_elem_size);
-        iree_uk_test_write_random_buffer(padding_value_buffer, out_elem_size,
-                                         out_type, engine);
+        iree_uk_ssize_t padding_value_size =
+            iree_uk_test_2d_buffer_length(out_type, 1, 1);
+        void* padding_value_buffer = malloc(padding_value_size);
+        iree_uk_test_write_random_buffer(padding_value_buffer,
+                                         padding_value_size, out_type, engine);
         params.padding_value = padding_value_buffer;
         test_one_pack_creating_input_for_given_shape(params, engine);
         free(padding_value_buffer);
@@ -261,6 +289,12 @@ static void pack_test(iree_uk_pack_type_t type, int tile_size0, int tile_size1,
 PACK_TEST(f32f32, 3, 5, generic, 0)
 PACK_TEST(i8i8, 4, 2, generic, 0)
 PACK_TEST(i32i32, 3, 4, generic, 0)
+PACK_TEST(f16f16, 5, 3, generic, 0)
+PACK_TEST(bf16bf16, 2, 7, generic, 0)
+// Tiles of 4-bit values must have an even number of elements, but the input
+// rows may start in the middle of a byte.
+PACK_TEST(i4i4, 3, 2, generic, 0)
+PACK_TEST(i4i4, 8, 1, generic, 0)
 
 // ARM_64 tests.
 #if defined(IREE_UK_ARCH_ARM_64)
@@ -280,6 +314,22 @@ PACK_ARM_64_TEST_WITH_CPU_FEATURE(i8i8, 8, 8, I8MM)
 
 #endif  // defined(IREE_UK_ARCH_ARM_64)
 
+// RISCV_64 tests.
+#if defined(IREE_UK_ARCH_RISCV_64)
+
+#define PACK_RISCV_64_TEST_WITH_CPU_FEATURE(type, tile_size0, tile_size1, \
+                                            FEATURE)                      \
+  PACK_TEST(type, tile_size0, tile_size1, riscv_64_##FEATURE,             \
+            IREE_CPU_DATA_FIELD_0_RISCV_64_HAVE_##FEATURE)
+
+PACK_RISCV_64_TEST_WITH_CPU_FEATURE(f32f32, 8, 1, V)
+PACK_RISCV_64_TEST_WITH_CPU_FEATURE(i8i8, 8, 1, V)
+PACK_RISCV_64_TEST_WITH_CPU_FEATURE(i8i8, 8, 4, V)
+PACK_RISCV_64_TEST_WITH_CPU_FEATURE(f32f32, 16, 1, V)
+PACK_RISCV_64_TEST_WITH_CPU_FEATURE(f16f16, 8, 1, V)
+
+#endif  // defined(IREE_UK_ARCH_RISCV_64)
+
 int main(int argc, char** argv) {
   ::testing::InitGoogleTest(&argc, argv);
   iree_cpu_initialize(iree_allocator_system());
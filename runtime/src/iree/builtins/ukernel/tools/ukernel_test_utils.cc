@@ -15,8 +15,9 @@
 iree_uk_ssize_t iree_uk_test_2d_buffer_length(iree_uk_type_t type,
                                               iree_uk_ssize_t size0,
                                               iree_uk_ssize_t stride0) {
-  // Just for testing purposes, so it's OK to overestimate size.
-  return size0 * stride0 << iree_uk_type_size_log2(type);
+  // Just for testing purposes, so it's OK to overestimate size. Sub-byte types
+  // are rounded up to whole bytes.
+  return ((size0 * stride0 << iree_uk_type_bit_count_log2(type)) + 7) / 8;
 }
 
 struct iree_uk_test_random_engine_t {
@@ -64,6 +65,18 @@ static void iree_uk_test_write_random_buffer(
   }
 }
 
+// 16-bit floating-point values are stored as their bit patterns. The small
+// integer values are exactly representable in both f16 and bf16.
+static void iree_uk_test_write_random_buffer_16bit_float(
+    iree_uk_uint16_t* buffer, iree_uk_ssize_t size_in_bytes,
+    iree_uk_uint16_t (*from_f32)(float), iree_uk_test_random_engine_t* engine) {
+  iree_uk_ssize_t size_in_elems = size_in_bytes / sizeof(*buffer);
+  assert(size_in_elems * sizeof(*buffer) == size_in_bytes && "bad size");
+  for (iree_uk_ssize_t i = 0; i < size_in_elems; ++i) {
+    buffer[i] = from_f32(iree_uk_test_random_engine_get_minus16_plus15(engine));
+  }
+}
+
 void iree_uk_test_write_random_buffer(void* buffer,
                                       iree_uk_ssize_t size_in_bytes,
                                       iree_uk_type_t type,
@@ -81,6 +94,23 @@ void iree_uk_test_write_random_buffer(void* buffer,
       iree_uk_test_write_random_buffer(static_cast<iree_uk_int8_t*>(buffer),
                                        size_in_bytes, engine);
       return;
+    case IREE_UK_TYPE_FLOAT_16:
+      iree_uk_test_write_random_buffer_16bit_float(
+          static_cast<iree_uk_uint16_t*>(buffer), size_in_bytes,
+          iree_uk_f32_to_f16, engine);
+      return;
+    case IREE_UK_TYPE_BFLOAT_16:
+      iree_uk_test_write_random_buffer_16bit_float(
+          static_cast<iree_uk_uint16_t*>(buffer), size_in_bytes,
+          iree_uk_f32_to_bf16, engine);
+      return;
+    case IREE_UK_TYPE_SINT_4:
+      // Any bit pattern is a pair of valid int4 values in [-8, 7].
+      for (iree_uk_ssize_t i = 0; i < size_in_bytes; ++i) {
+        static_cast<iree_uk_uint8_t*>(buffer)[i] =
+            iree_uk_test_random_engine_get_0_65535(engine) & 0xFF;
+      }
+      return;
     default:
       assert(false && "unknown type");
   }
@@ -161,6 +191,28 @@ int iree_uk_test_cpu_features_str(char* buf, int buf_length,
     return snprintf(buf, buf_length, "dotprod");
   }
 #endif  // defined(IREE_UK_ARCH_ARM_64)
+#if defined(IREE_UK_ARCH_X86_64)
+  if (cpu_data[0] & IREE_CPU_DATA_FIELD_0_X86_64_HAVE_AVX2_FMA) {
+    return snprintf(buf, buf_length, "avx2_fma");
+  }
+  if (cpu_data[0] & IREE_CPU_DATA_FIELD_0_X86_64_HAVE_AVX512_BASE) {
+    return snprintf(buf, buf_length, "avx512_base");
+  }
+  if (cpu_data[0] & IREE_CPU_DATA_FIELD_0_X86_64_HAVE_AVX512VNNI) {
+    return snprintf(buf, buf_length, "avx512vnni");
+  }
+  if (cpu_data[0] & IREE_CPU_DATA_FIELD_0_X86_64_HAVE_AVX512BF16) {
+    return snprintf(buf, buf_length, "avx512bf16");
+  }
+#endif  // defined(IREE_UK_ARCH_X86_64)
+#if defined(IREE_UK_ARCH_RISCV_64)
+  if (cpu_data[0] & IREE_CPU_DATA_FIELD_0_RISCV_64_HAVE_V) {
+    return snprintf(buf, buf_length, "v");
+  }
+  if (cpu_data[0] & IREE_CPU_DATA_FIELD_0_RISCV_64_HAVE_ZVL256B) {
+    return snprintf(buf, buf_length, "zvl256b");
+  }
+#endif  // defined(IREE_UK_ARCH_RISCV_64)
   assert(false && "unknown CPU feature");
   return snprintf(buf, buf_length, "(unknown CPU feature)");
 }
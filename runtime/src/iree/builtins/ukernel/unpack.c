@@ -6,6 +6,9 @@
 
 #include "iree/builtins/ukernel/unpack.h"
 
+#include "iree/builtins/ukernel/arch/unpack_arch.h"
+#include "iree/builtins/ukernel/unpack_generic.h"
+
 static iree_uk_status_t iree_uk_unpack_validate(
     const iree_uk_unpack_params_t* params) {
 #ifdef IREE_UK_ENABLE_VALIDATION
@@ -18,6 +21,8 @@ static iree_uk_status_t iree_uk_unpack_validate(
     case iree_uk_unpack_type_f32f32:
     case iree_uk_unpack_type_i8i8:
     case iree_uk_unpack_type_i32i32:
+    case iree_uk_unpack_type_f16f16:
+    case iree_uk_unpack_type_bf16bf16:
       break;
     default:
       return iree_uk_status_bad_type;
@@ -53,7 +58,19 @@ static bool iree_uk_unpack_early(const iree_uk_unpack_params_t* params) {
   return (params->out_size0 == 0 || params->out_size1 == 0);
 }
 
-static void iree_unpack_reference(const iree_uk_unpack_params_t* params) {
+static iree_uk_unpack_tile_func_t iree_uk_unpack_select_tile_func(
+    const iree_uk_unpack_params_t* params) {
+  iree_uk_unpack_tile_func_t arch_tile_func =
+      iree_uk_unpack_select_tile_func_arch(params);
+  if (arch_tile_func) {
+    return arch_tile_func;
+  }
+  return iree_uk_unpack_select_tile_func_generic(params);
+}
+
+static void iree_uk_unpack_using_tile_func(
+    const iree_uk_unpack_params_t* params,
+    iree_uk_unpack_tile_func_t tile_func) {
   // For now, the input and output element types are always the same.
   iree_uk_type_t elem_type = iree_uk_unpack_in_type(params->type);
   iree_uk_ssize_t elem_size = iree_uk_type_size(elem_type);
@@ -73,30 +90,45 @@ static void iree_unpack_reference(const iree_uk_unpack_params_t* params) {
     iree_uk_ssize_swap(&tile_size0, &tile_size1);
     iree_uk_ssize_swap(&in_stride_l2, &in_stride_l3);
   }
-  assert(outer_size0 * tile_size0 >= params->out_size0);
-  assert(outer_size1 * tile_size1 >= params->out_size1);
-  assert((outer_size0 - 1) * tile_size0 < params->out_size0);
-  assert((outer_size1 - 1) * tile_size1 < params->out_size1);
+  const char* in_row_ptr = params->in_buffer;
+  char* out_row_ptr = params->out_buffer;
+  bool l0_has_padding = outer_size0 * tile_size0 != params->out_size0;
+  bool l1_has_padding = outer_size1 * tile_size1 != params->out_size1;
+  iree_uk_ssize_t l0_full_tile_end = outer_size0 - (l0_has_padding ? 1 : 0);
+  iree_uk_ssize_t l1_full_tile_end = outer_size1 - (l1_has_padding ? 1 : 0);
   for (iree_uk_ssize_t outer_i0 = 0; outer_i0 < outer_size0; ++outer_i0) {
-    for (iree_uk_ssize_t outer_i1 = 0; outer_i1 < outer_size1; ++outer_i1) {
+    // If we're on the final iteration of outer loop 0 and there is padding,
+    // set l1_full_tile_end to 0, so henceforth it is sufficient to check
+    // against l1_full_tile_end to tell if we are dropping padding.
+    if (outer_i0 == l0_full_tile_end) {
+      l1_full_tile_end = 0;
+    }
+    // Handle full tiles, using the (fast) tile_func.
+    tile_func(out_row_ptr, in_row_ptr, l1_full_tile_end, params->out_stride0,
+              in_stride_l1, elem_size, tile_size0, tile_size1);
+    // Handle incomplete tiles, dropping padding, using slow code here.
+    for (iree_uk_ssize_t outer_i1 = l1_full_tile_end; outer_i1 < outer_size1;
+         ++outer_i1) {
+      const char* in_tile_ptr =
+          in_row_ptr + outer_i1 * in_stride_l1 * elem_size;
       for (iree_uk_ssize_t tile_i0 = 0; tile_i0 < tile_size0; ++tile_i0) {
         for (iree_uk_ssize_t tile_i1 = 0; tile_i1 < tile_size1; ++tile_i1) {
-          iree_uk_ssize_t in_offset =
-              outer_i0 * in_stride_l0 + tile_i0 * in_stride_l2 +
-              outer_i1 * in_stride_l1 + tile_i1 * in_stride_l3;
           iree_uk_ssize_t i0 = outer_i0 * tile_size0 + tile_i0;
           iree_uk_ssize_t i1 = outer_i1 * tile_size1 + tile_i1;
-          if (!(i0 >= params->out_size0 || i1 >= params->out_size1)) {
-            iree_uk_ssize_t out_offset = i1 + i0 * params->out_stride0;
-            const char* in_ptr =
-                ((char*)params->in_buffer) + in_offset * elem_size;
-            char* out_ptr =
-                ((char*)params->out_buffer) + out_offset * elem_size;
-            iree_uk_memcpy(out_ptr, in_ptr, elem_size);
+          if (i0 >= params->out_size0 || i1 >= params->out_size1) {
+            continue;
           }
+          const char* in_ptr =
+              in_tile_ptr +
+              (tile_i0 * in_stride_l2 + tile_i1 * in_stride_l3) * elem_size;
+          iree_uk_ssize_t out_offset = i1 + i0 * params->out_stride0;
+          char* out_ptr = ((char*)params->out_buffer) + out_offset * elem_size;
+          iree_uk_memcpy(out_ptr, in_ptr, elem_size);
         }
       }
     }
+    out_row_ptr += tile_size0 * params->out_stride0 * elem_size;
+    in_row_ptr += in_stride_l0 * elem_size;
   }
 }
 
@@ -105,6 +137,10 @@ iree_uk_status_t iree_uk_unpack(const iree_uk_unpack_params_t* params) {
 
   if (iree_uk_unpack_early(params)) return iree_uk_status_ok;
 
-  iree_unpack_reference(params);
+  // Select a target-specific tile_func (unpacking a row of full tiles) and use
+  // that with generic outer loops handling the padded edge tiles.
+  iree_uk_unpack_tile_func_t tile_func =
+      iree_uk_unpack_select_tile_func(params);
+  iree_uk_unpack_using_tile_func(params, tile_func);
   return iree_uk_status_ok;
-}
\ No newline at end of file
+}
@@ -15,6 +15,9 @@ typedef enum iree_uk_unpack_type_t {
   iree_uk_unpack_type_f32f32 = IREE_UK_TIE_2_TYPES_LITERAL(FLOAT_32, FLOAT_32),
   iree_uk_unpack_type_i8i8 = IREE_UK_TIE_2_TYPES_LITERAL(INT_8, INT_8),
   iree_uk_unpack_type_i32i32 = IREE_UK_TIE_2_TYPES_LITERAL(INT_32, INT_32),
+  iree_uk_unpack_type_f16f16 = IREE_UK_TIE_2_TYPES_LITERAL(FLOAT_16, FLOAT_16),
+  iree_uk_unpack_type_bf16bf16 =
+      IREE_UK_TIE_2_TYPES_LITERAL(BFLOAT_16, BFLOAT_16),
 } iree_uk_unpack_type_t;
 
 static inline iree_uk_type_t iree_uk_unpack_in_type(
@@ -44,19 +47,24 @@ typedef struct iree_uk_unpack_params_t {
   const iree_uk_uint64_t* cpu_data;
 } iree_uk_unpack_params_t;
 
-typedef void* (*iree_uk_unpack_tile_func_t)(
+// Function pointer type for unpack tile functions. A tile function unpacks
+// |outer_size1| consecutive full tiles along dimension 1: it reads tiles
+// |in_stride1| elements apart starting at |in_tile_ptr| and writes them
+// side by side into the row-major output starting at |out_tile_ptr|, whose
+// rows are |out_stride0| elements apart.
+typedef void (*iree_uk_unpack_tile_func_t)(
     void* IREE_UK_RESTRICT /*out_tile_ptr*/,
     const void* IREE_UK_RESTRICT /*in_tile_ptr*/,
-    iree_uk_ssize_t /*outer_size1*/, iree_uk_ssize_t /*out_stride_l1*/,
-    iree_uk_ssize_t /*in_stride0*/, iree_uk_ssize_t /*elem_size*/,
+    iree_uk_ssize_t /*outer_size1*/, iree_uk_ssize_t /*out_stride0*/,
+    iree_uk_ssize_t /*in_stride1*/, iree_uk_ssize_t /*elem_size*/,
     iree_uk_ssize_t /*tile_size0*/, iree_uk_ssize_t /*tile_size1*/);
 
 // Tile kernel declarations. Prototype matches iree_uk_unpack_tile_func_t.
-#define IREE_UK_UNPACK_TILE_FUNC_DECL(NAME)                              \
-  void* NAME(void* IREE_UK_RESTRICT out_tile_ptr,                        \
-             const void* IREE_UK_RESTRICT in_tile_ptr,                   \
-             iree_uk_ssize_t outer_size1, iree_uk_ssize_t out_stride_l1, \
-             iree_uk_ssize_t in_stride0, iree_uk_ssize_t elem_size,      \
-             iree_uk_ssize_t tile_size0, iree_uk_ssize_t tile_size1);
+#define IREE_UK_UNPACK_TILE_FUNC_DECL(NAME)                           \
+  void NAME(void* IREE_UK_RESTRICT out_tile_ptr,                      \
+            const void* IREE_UK_RESTRICT in_tile_ptr,                 \
+            iree_uk_ssize_t outer_size1, iree_uk_ssize_t out_stride0, \
+            iree_uk_ssize_t in_stride1, iree_uk_ssize_t elem_size,    \
+            iree_uk_ssize_t tile_size0, iree_uk_ssize_t tile_size1);
 
 #endif  // IREE_BUILTINS_UKERNEL_UNPACK_TYPES_H_
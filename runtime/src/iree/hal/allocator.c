@@ -9,6 +9,7 @@
 #include <stddef.h>
 #include <stdio.h>
 
+#include "iree/base/internal/metrics.h"
 #include "iree/base/tracing.h"
 #include "iree/hal/detail.h"
 #include "iree/hal/resource.h"
@@ -36,6 +37,12 @@ IREE_API_EXPORT iree_status_t iree_hal_allocator_statistics_format(
       statistics->device_bytes_freed,
       (statistics->device_bytes_allocated - statistics->device_bytes_freed)));
 
+  if (statistics->cache_hits || statistics->cache_misses) {
+    IREE_RETURN_IF_ERROR(iree_string_builder_append_format(
+        builder, "       CACHE: %12" PRIu64 " hits / %12" PRIu64 " misses\n",
+        statistics->cache_hits, statistics->cache_misses));
+  }
+
 #else
   // No-op when disabled.
 #endif  // IREE_STATISTICS_ENABLE
@@ -115,6 +122,20 @@ iree_hal_allocator_query_compatibility(
                                                           allocation_size);
 }
 
+// Allocations are counted at every allocator they pass through such that a
+// caching allocator miss counts both at the cache and the underlying allocator.
+IREE_METRIC_DEFINE(iree_hal_allocator_allocations_metric, COUNTER,
+                   "iree_hal_allocator_allocations_total",
+                   "Number of buffers allocated from HAL allocators.");
+IREE_METRIC_DEFINE(
+    iree_hal_allocator_host_bytes_metric, COUNTER,
+    "iree_hal_allocator_host_bytes_allocated_total",
+    "Bytes of host-local memory allocated from HAL allocators.");
+IREE_METRIC_DEFINE(
+    iree_hal_allocator_device_bytes_metric, COUNTER,
+    "iree_hal_allocator_device_bytes_allocated_total",
+    "Bytes of device-local memory allocated from HAL allocators.");
+
 IREE_API_EXPORT iree_status_t iree_hal_allocator_allocate_buffer(
     iree_hal_allocator_t* IREE_RESTRICT allocator,
     iree_hal_buffer_params_t params, iree_device_size_t allocation_size,
@@ -128,6 +149,17 @@ IREE_API_EXPORT iree_status_t iree_hal_allocator_allocate_buffer(
   iree_hal_buffer_params_canonicalize(&params);
   iree_status_t status = _VTABLE_DISPATCH(allocator, allocate_buffer)(
       allocator, &params, allocation_size, initial_data, out_buffer);
+#if IREE_METRICS_ENABLE
+  if (iree_status_is_ok(status)) {
+    IREE_METRIC_ADD(iree_hal_allocator_allocations_metric, 1);
+    if (iree_all_bits_set(iree_hal_buffer_memory_type(*out_buffer),
+                          IREE_HAL_MEMORY_TYPE_HOST_LOCAL)) {
+      IREE_METRIC_ADD(iree_hal_allocator_host_bytes_metric, allocation_size);
+    } else {
+      IREE_METRIC_ADD(iree_hal_allocator_device_bytes_metric, allocation_size);
+    }
+  }
+#endif  // IREE_METRICS_ENABLE
   IREE_TRACE_ZONE_END(z0);
   return status;
 }
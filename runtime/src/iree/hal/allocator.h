@@ -227,6 +227,18 @@ typedef enum iree_hal_external_buffer_type_e {
   //  Uses VK_EXTERNAL_MEMORY_HANDLE_TYPE_OPAQUE_WIN32_BIT.
   IREE_HAL_EXTERNAL_BUFFER_TYPE_OPAQUE_WIN32 = 3,
 
+  // A device pointer allocated by another device of the same driver that
+  // shares a unified address space with the importing device. Used for
+  // peer-to-peer access between devices without staging through the host.
+  // An imported/exported buffer does not own a reference to the memory and the
+  // caller is responsible for ensuring the exporting buffer remains live for as
+  // long as the iree_hal_buffer_t referencing it.
+  //
+  // CUDA:
+  //  Requires peer access between the devices (P2P over PCIe or NVLink).
+  //  Uses cuDeviceCanAccessPeer / cuCtxEnablePeerAccess.
+  IREE_HAL_EXTERNAL_BUFFER_TYPE_DEVICE_ALLOCATION = 4,
+
   // TODO(benvanik): additional memory types:
   //  shared memory fd (shmem)/mapped file
   //  VK_EXTERNAL_MEMORY_HANDLE_TYPE_DMA_BUF_BIT_EXT
@@ -265,6 +277,11 @@ typedef struct iree_hal_external_buffer_t {
     struct {
       void* handle;
     } opaque_win32;
+    // IREE_HAL_EXTERNAL_BUFFER_TYPE_DEVICE_ALLOCATION
+    struct {
+      // Device pointer in the unified address space of the driver.
+      uint64_t ptr;
+    } device_allocation;
   } handle;
 } iree_hal_external_buffer_t;
 
@@ -300,6 +317,10 @@ typedef struct iree_hal_allocator_statistics_t {
   iree_device_size_t device_bytes_peak;
   iree_device_size_t device_bytes_allocated;
   iree_device_size_t device_bytes_freed;
+  // Allocations served from (or missing) a cache of released buffers, if the
+  // allocator has one.
+  uint64_t cache_hits;
+  uint64_t cache_misses;
   // TODO(benvanik): mapping information (discarded, mapping ranges,
   //                 flushed/invalidated, etc).
 #else
@@ -447,7 +468,9 @@ IREE_API_EXPORT iree_status_t iree_hal_allocator_export_buffer(
 //
 // The buffers created from the allocator will use |host_allocator| for their
 // metadata and |data_allocator| for their device storage allocations. If the
-// two are the same the buffers will be allocated in a single flat slab.
+// two are the same the buffers will be allocated in a single flat slab. Local
+// devices can pass an iree_page_allocator as |data_allocator| to back large
+// buffers with huge pages placed on a particular NUMA node.
 IREE_API_EXPORT iree_status_t iree_hal_allocator_create_heap(
     iree_string_view_t identifier, iree_allocator_t data_allocator,
     iree_allocator_t host_allocator, iree_hal_allocator_t** out_allocator);
@@ -188,11 +188,19 @@ static iree_status_t iree_hal_heap_allocator_import_buffer(
     return iree_make_status(IREE_STATUS_UNAVAILABLE,
                             "external buffer type not supported");
   }
+  if (!external_buffer->handle.host_allocation.ptr && external_buffer->size) {
+    return iree_make_status(IREE_STATUS_INVALID_ARGUMENT,
+                            "host allocation pointer must be non-NULL");
+  }
 
   // Coerce options into those required for use by heap-based devices.
   iree_hal_buffer_params_t compat_params =
       iree_hal_heap_allocator_make_compatible(params);
 
+  // The host memory is used in-place by local devices: no copy is made and the
+  // |release_callback| is issued when the buffer is destroyed. Memory must be
+  // aligned to IREE_HAL_HEAP_BUFFER_ALIGNMENT or the import fails with
+  // IREE_STATUS_OUT_OF_RANGE and callers must copy into an allocated buffer.
   return iree_hal_heap_buffer_wrap(
       base_allocator, compat_params.type, compat_params.access,
       compat_params.usage, external_buffer->size,
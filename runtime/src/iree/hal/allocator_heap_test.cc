@@ -0,0 +1,97 @@
+// Copyright 2023 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include <cstddef>
+#include <cstdint>
+
+#include "iree/base/api.h"
+#include "iree/hal/api.h"
+#include "iree/testing/gtest.h"
+#include "iree/testing/status_matchers.h"
+
+namespace iree {
+namespace hal {
+namespace {
+
+class HeapAllocatorTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    IREE_ASSERT_OK(iree_hal_allocator_create_heap(
+        iree_make_cstring_view("heap"), iree_allocator_system(),
+        iree_allocator_system(), &allocator_));
+  }
+
+  void TearDown() override { iree_hal_allocator_release(allocator_); }
+
+  static iree_hal_buffer_params_t DefaultParams() {
+    iree_hal_buffer_params_t params = {0};
+    params.type =
+        IREE_HAL_MEMORY_TYPE_HOST_LOCAL | IREE_HAL_MEMORY_TYPE_DEVICE_VISIBLE;
+    params.usage = IREE_HAL_BUFFER_USAGE_DEFAULT;
+    return params;
+  }
+
+  static iree_hal_external_buffer_t MakeHostAllocation(void* ptr,
+                                                       size_t size) {
+    iree_hal_external_buffer_t external_buffer;
+    external_buffer.type = IREE_HAL_EXTERNAL_BUFFER_TYPE_HOST_ALLOCATION;
+    external_buffer.flags = IREE_HAL_EXTERNAL_BUFFER_FLAG_NONE;
+    external_buffer.size = size;
+    external_buffer.handle.host_allocation.ptr = ptr;
+    return external_buffer;
+  }
+
+  iree_hal_allocator_t* allocator_ = NULL;
+};
+
+// Imported host memory is used in-place and released through the callback.
+TEST_F(HeapAllocatorTest, ImportHostAllocationIsZeroCopy) {
+  alignas(IREE_HAL_HEAP_BUFFER_ALIGNMENT) uint8_t data[256] = {0};
+  int release_count = 0;
+  iree_hal_buffer_release_callback_t release_callback = {
+      [](void* user_data, iree_hal_buffer_t* buffer) {
+        ++*static_cast<int*>(user_data);
+      },
+      &release_count,
+  };
+  iree_hal_external_buffer_t external_buffer =
+      MakeHostAllocation(data, sizeof(data));
+  iree_hal_buffer_t* buffer = NULL;
+  IREE_ASSERT_OK(iree_hal_allocator_import_buffer(
+      allocator_, DefaultParams(), &external_buffer, release_callback,
+      &buffer));
+
+  iree_hal_buffer_mapping_t mapping;
+  IREE_ASSERT_OK(iree_hal_buffer_map_range(
+      buffer, IREE_HAL_MAPPING_MODE_SCOPED, IREE_HAL_MEMORY_ACCESS_WRITE, 0,
+      IREE_WHOLE_BUFFER, &mapping));
+  EXPECT_EQ(mapping.contents.data, data);
+  EXPECT_EQ(mapping.contents.data_length, sizeof(data));
+  mapping.contents.data[3] = 0x42;
+  IREE_ASSERT_OK(iree_hal_buffer_unmap_range(&mapping));
+  EXPECT_EQ(data[3], 0x42);
+
+  EXPECT_EQ(release_count, 0);
+  iree_hal_buffer_release(buffer);
+  EXPECT_EQ(release_count, 1);
+}
+
+// Host memory that is not sufficiently aligned cannot be used in-place.
+TEST_F(HeapAllocatorTest, ImportUnalignedHostAllocationFails) {
+  alignas(IREE_HAL_HEAP_BUFFER_ALIGNMENT) uint8_t data[256] = {0};
+  iree_hal_external_buffer_t external_buffer =
+      MakeHostAllocation(data + 4, sizeof(data) - 4);
+  iree_hal_buffer_t* buffer = NULL;
+  IREE_EXPECT_STATUS_IS(IREE_STATUS_OUT_OF_RANGE,
+                        Status(iree_hal_allocator_import_buffer(
+                            allocator_, DefaultParams(), &external_buffer,
+                            iree_hal_buffer_release_callback_null(), &buffer)));
+  EXPECT_EQ(buffer, nullptr);
+}
+
+}  // namespace
+}  // namespace hal
+}  // namespace iree
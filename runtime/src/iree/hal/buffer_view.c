@@ -19,10 +19,34 @@ struct iree_hal_buffer_view_t {
   iree_hal_element_type_t element_type;
   iree_hal_encoding_type_t encoding_type;
   iree_device_size_t byte_length;
+  // True if the view is stored in the same host allocation as |buffer| and
+  // the storage is freed when the buffer is destroyed.
+  bool stored_in_buffer;
   iree_host_size_t shape_rank;
   iree_hal_dim_t shape[];
 };
 
+static void iree_hal_buffer_view_initialize(
+    iree_hal_buffer_t* buffer, iree_host_size_t shape_rank,
+    const iree_hal_dim_t* shape, iree_hal_element_type_t element_type,
+    iree_hal_encoding_type_t encoding_type, iree_allocator_t host_allocator,
+    iree_hal_buffer_view_t* buffer_view) {
+  iree_atomic_ref_count_init(&buffer_view->ref_count);
+  buffer_view->host_allocator = host_allocator;
+  buffer_view->buffer = buffer;
+  iree_hal_buffer_retain(buffer_view->buffer);
+  buffer_view->element_type = element_type;
+  buffer_view->encoding_type = encoding_type;
+  buffer_view->byte_length =
+      iree_hal_element_dense_byte_count(buffer_view->element_type);
+  buffer_view->stored_in_buffer = false;
+  buffer_view->shape_rank = shape_rank;
+  for (iree_host_size_t i = 0; i < shape_rank; ++i) {
+    buffer_view->shape[i] = shape[i];
+    buffer_view->byte_length *= shape[i];
+  }
+}
+
 IREE_API_EXPORT iree_status_t iree_hal_buffer_view_create(
     iree_hal_buffer_t* buffer, iree_host_size_t shape_rank,
     const iree_hal_dim_t* shape, iree_hal_element_type_t element_type,
@@ -47,19 +71,77 @@ IREE_API_EXPORT iree_status_t iree_hal_buffer_view_create(
       sizeof(*buffer_view) + sizeof(iree_hal_dim_t) * shape_rank,
       (void**)&buffer_view);
   if (iree_status_is_ok(status)) {
-    iree_atomic_ref_count_init(&buffer_view->ref_count);
-    buffer_view->host_allocator = host_allocator;
-    buffer_view->buffer = buffer;
-    iree_hal_buffer_retain(buffer_view->buffer);
-    buffer_view->element_type = element_type;
-    buffer_view->encoding_type = encoding_type;
-    buffer_view->byte_length =
-        iree_hal_element_dense_byte_count(buffer_view->element_type);
-    buffer_view->shape_rank = shape_rank;
-    for (iree_host_size_t i = 0; i < shape_rank; ++i) {
-      buffer_view->shape[i] = shape[i];
-      buffer_view->byte_length *= shape[i];
-    }
+    iree_hal_buffer_view_initialize(buffer, shape_rank, shape, element_type,
+                                    encoding_type, host_allocator, buffer_view);
+    *out_buffer_view = buffer_view;
+  }
+
+  IREE_TRACE_ZONE_END(z0);
+  return status;
+}
+
+IREE_API_EXPORT iree_status_t iree_hal_buffer_view_create_subspan(
+    iree_hal_buffer_t* buffer, iree_device_size_t byte_offset,
+    iree_device_size_t byte_length, iree_host_size_t shape_rank,
+    const iree_hal_dim_t* shape, iree_hal_element_type_t element_type,
+    iree_hal_encoding_type_t encoding_type, iree_allocator_t host_allocator,
+    iree_hal_buffer_view_t** out_buffer_view) {
+  IREE_ASSERT_ARGUMENT(buffer);
+  IREE_ASSERT_ARGUMENT(out_buffer_view);
+
+  *out_buffer_view = NULL;
+  if (IREE_UNLIKELY(shape_rank > 0 && !shape)) {
+    return iree_make_status(IREE_STATUS_INVALID_ARGUMENT,
+                            "no shape dimensions specified");
+  }
+
+  const iree_device_size_t buffer_length = iree_hal_buffer_byte_length(buffer);
+  if (byte_length == IREE_WHOLE_BUFFER && byte_offset <= buffer_length) {
+    byte_length = buffer_length - byte_offset;
+  }
+  IREE_RETURN_IF_ERROR(
+      iree_hal_buffer_validate_range(buffer, byte_offset, byte_length),
+      "invalid subspan of an existing buffer (source_offset=%" PRIdsz
+      ", length=%" PRIdsz ")",
+      byte_offset, byte_length);
+
+  // Fast path for views of the entire buffer that need no subspan.
+  if (byte_offset == 0 && byte_length == buffer_length) {
+    return iree_hal_buffer_view_create(buffer, shape_rank, shape, element_type,
+                                       encoding_type, host_allocator,
+                                       out_buffer_view);
+  }
+
+  IREE_TRACE_ZONE_BEGIN(z0);
+
+  // The subspan buffer is placed at the head of the allocation so that when it
+  // is destroyed the subspan implementation frees the entire allocation with
+  // |host_allocator|. The view holds a reference to the subspan like any other
+  // buffer and the storage lives until both have been released, allowing users
+  // to retain the buffer beyond the lifetime of the view.
+  const iree_host_size_t buffer_size = iree_sizeof_struct(iree_hal_buffer_t);
+  uint8_t* storage = NULL;
+  iree_status_t status = iree_allocator_malloc(
+      host_allocator,
+      buffer_size + sizeof(iree_hal_buffer_view_t) +
+          sizeof(iree_hal_dim_t) * shape_rank,
+      (void**)&storage);
+  if (iree_status_is_ok(status)) {
+    // Reference the root allocation to avoid nested subspans, as with
+    // iree_hal_buffer_subspan.
+    iree_hal_buffer_t* subspan_buffer = (iree_hal_buffer_t*)storage;
+    iree_hal_subspan_buffer_initialize(
+        iree_hal_buffer_allocated_buffer(buffer),
+        iree_hal_buffer_byte_offset(buffer) + byte_offset, byte_length,
+        /*device_allocator=*/NULL, host_allocator, subspan_buffer);
+    iree_hal_buffer_view_t* buffer_view =
+        (iree_hal_buffer_view_t*)(storage + buffer_size);
+    iree_hal_buffer_view_initialize(subspan_buffer, shape_rank, shape,
+                                    element_type, encoding_type,
+                                    host_allocator, buffer_view);
+    buffer_view->stored_in_buffer = true;
+    // Drop the initial subspan reference so that the view holds the only one.
+    iree_hal_buffer_release(subspan_buffer);
     *out_buffer_view = buffer_view;
   }
 
@@ -97,8 +179,13 @@ IREE_API_EXPORT void iree_hal_buffer_view_destroy(
     iree_hal_buffer_view_t* buffer_view) {
   iree_allocator_t host_allocator = buffer_view->host_allocator;
   IREE_TRACE_ZONE_BEGIN(z0);
+  // If the view is stored in the buffer allocation then releasing the buffer
+  // may free the view storage and the view must not be accessed after.
+  const bool stored_in_buffer = buffer_view->stored_in_buffer;
   iree_hal_buffer_release(buffer_view->buffer);
-  iree_allocator_free(host_allocator, buffer_view);
+  if (!stored_in_buffer) {
+    iree_allocator_free(host_allocator, buffer_view);
+  }
   IREE_TRACE_ZONE_END(z0);
 }
 
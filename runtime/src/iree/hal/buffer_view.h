@@ -193,6 +193,20 @@ IREE_API_EXPORT iree_status_t iree_hal_buffer_view_create(
     iree_hal_encoding_type_t encoding_type, iree_allocator_t host_allocator,
     iree_hal_buffer_view_t** out_buffer_view);
 
+// Creates a buffer view of the |byte_offset| and |byte_length| (which may be
+// IREE_WHOLE_BUFFER) subspan of |buffer|. Equivalent to iree_hal_buffer_subspan
+// followed by iree_hal_buffer_view_create but the subspan buffer is stored in
+// the same host allocation as the buffer view. Slicing and reshaping existing
+// buffers then costs a single allocation or none for the subspan when the range
+// covers the entire |buffer|.
+// |out_buffer_view| must be released by the caller.
+IREE_API_EXPORT iree_status_t iree_hal_buffer_view_create_subspan(
+    iree_hal_buffer_t* buffer, iree_device_size_t byte_offset,
+    iree_device_size_t byte_length, iree_host_size_t shape_rank,
+    const iree_hal_dim_t* shape, iree_hal_element_type_t element_type,
+    iree_hal_encoding_type_t encoding_type, iree_allocator_t host_allocator,
+    iree_hal_buffer_view_t** out_buffer_view);
+
 // Creates a buffer view with the given |buffer| and metadata from |like_view|.
 // |out_buffer_view| must be released by the caller.
 IREE_API_EXPORT iree_status_t iree_hal_buffer_view_create_like(
@@ -0,0 +1,109 @@
+// Copyright 2023 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include "iree/hal/buffer_view.h"
+
+#include <cstddef>
+#include <cstdint>
+
+#include "iree/base/api.h"
+#include "iree/hal/api.h"
+#include "iree/testing/gtest.h"
+#include "iree/testing/status_matchers.h"
+
+namespace iree {
+namespace hal {
+namespace {
+
+using ::iree::testing::status::StatusIs;
+
+class BufferViewTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    IREE_ASSERT_OK(iree_hal_allocator_create_heap(
+        iree_make_cstring_view("heap"), iree_allocator_system(),
+        iree_allocator_system(), &allocator_));
+    iree_hal_buffer_params_t params = {0};
+    params.type =
+        IREE_HAL_MEMORY_TYPE_HOST_LOCAL | IREE_HAL_MEMORY_TYPE_DEVICE_VISIBLE;
+    params.usage = IREE_HAL_BUFFER_USAGE_DEFAULT;
+    IREE_ASSERT_OK(iree_hal_allocator_allocate_buffer(
+        allocator_, params, 256, iree_const_byte_span_empty(), &buffer_));
+  }
+
+  void TearDown() override {
+    iree_hal_buffer_release(buffer_);
+    iree_hal_allocator_release(allocator_);
+  }
+
+  iree_hal_allocator_t* allocator_ = NULL;
+  iree_hal_buffer_t* buffer_ = NULL;
+};
+
+// Views of the whole buffer reference it directly.
+TEST_F(BufferViewTest, CreateSubspanWholeBuffer) {
+  const iree_hal_dim_t shape[] = {4, 16};
+  iree_hal_buffer_view_t* buffer_view = NULL;
+  IREE_ASSERT_OK(iree_hal_buffer_view_create_subspan(
+      buffer_, 0, IREE_WHOLE_BUFFER, IREE_ARRAYSIZE(shape), shape,
+      IREE_HAL_ELEMENT_TYPE_FLOAT_32, IREE_HAL_ENCODING_TYPE_DENSE_ROW_MAJOR,
+      iree_allocator_system(), &buffer_view));
+  EXPECT_EQ(iree_hal_buffer_view_buffer(buffer_view), buffer_);
+  EXPECT_EQ(iree_hal_buffer_view_byte_length(buffer_view), 256);
+  iree_hal_buffer_view_release(buffer_view);
+}
+
+// Subspan buffers may outlive the view they were created with.
+TEST_F(BufferViewTest, CreateSubspanOutlivesView) {
+  const iree_hal_dim_t shape[] = {8};
+  iree_hal_buffer_view_t* buffer_view = NULL;
+  IREE_ASSERT_OK(iree_hal_buffer_view_create_subspan(
+      buffer_, 64, 32, IREE_ARRAYSIZE(shape), shape,
+      IREE_HAL_ELEMENT_TYPE_FLOAT_32, IREE_HAL_ENCODING_TYPE_DENSE_ROW_MAJOR,
+      iree_allocator_system(), &buffer_view));
+  iree_hal_buffer_t* subspan_buffer = iree_hal_buffer_view_buffer(buffer_view);
+  EXPECT_NE(subspan_buffer, buffer_);
+  EXPECT_EQ(iree_hal_buffer_allocated_buffer(subspan_buffer), buffer_);
+  EXPECT_EQ(iree_hal_buffer_byte_offset(subspan_buffer), 64);
+  EXPECT_EQ(iree_hal_buffer_byte_length(subspan_buffer), 32);
+  EXPECT_EQ(iree_hal_buffer_view_shape_dim(buffer_view, 0), 8);
+
+  iree_hal_buffer_retain(subspan_buffer);
+  iree_hal_buffer_view_release(buffer_view);
+  EXPECT_EQ(iree_hal_buffer_byte_length(subspan_buffer), 32);
+  iree_hal_buffer_release(subspan_buffer);
+}
+
+// Subspans of subspans reference the allocated buffer directly.
+TEST_F(BufferViewTest, CreateSubspanOfSubspan) {
+  iree_hal_buffer_t* subspan_buffer = NULL;
+  IREE_ASSERT_OK(iree_hal_buffer_subspan(buffer_, 16, 128, &subspan_buffer));
+  iree_hal_buffer_view_t* buffer_view = NULL;
+  IREE_ASSERT_OK(iree_hal_buffer_view_create_subspan(
+      subspan_buffer, 32, IREE_WHOLE_BUFFER, 0, NULL,
+      IREE_HAL_ELEMENT_TYPE_UINT_8, IREE_HAL_ENCODING_TYPE_DENSE_ROW_MAJOR,
+      iree_allocator_system(), &buffer_view));
+  iree_hal_buffer_t* view_buffer = iree_hal_buffer_view_buffer(buffer_view);
+  EXPECT_EQ(iree_hal_buffer_allocated_buffer(view_buffer), buffer_);
+  EXPECT_EQ(iree_hal_buffer_byte_offset(view_buffer), 48);
+  EXPECT_EQ(iree_hal_buffer_byte_length(view_buffer), 96);
+  iree_hal_buffer_view_release(buffer_view);
+  iree_hal_buffer_release(subspan_buffer);
+}
+
+TEST_F(BufferViewTest, CreateSubspanOutOfRange) {
+  iree_hal_buffer_view_t* buffer_view = NULL;
+  EXPECT_THAT(Status(iree_hal_buffer_view_create_subspan(
+                  buffer_, 128, 256, 0, NULL, IREE_HAL_ELEMENT_TYPE_UINT_8,
+                  IREE_HAL_ENCODING_TYPE_DENSE_ROW_MAJOR,
+                  iree_allocator_system(), &buffer_view)),
+              StatusIs(StatusCode::kOutOfRange));
+  EXPECT_EQ(buffer_view, nullptr);
+}
+
+}  // namespace
+}  // namespace hal
+}  // namespace iree
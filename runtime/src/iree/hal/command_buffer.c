@@ -9,6 +9,7 @@
 #include <stddef.h>
 
 #include "iree/base/api.h"
+#include "iree/base/internal/metrics.h"
 #include "iree/base/tracing.h"
 #include "iree/hal/command_buffer_validation.h"
 #include "iree/hal/detail.h"
@@ -430,6 +431,10 @@ IREE_API_EXPORT iree_status_t iree_hal_command_buffer_push_descriptor_set(
   return status;
 }
 
+IREE_METRIC_DEFINE(iree_hal_command_buffer_dispatches_metric, COUNTER,
+                   "iree_hal_command_buffer_dispatches_total",
+                   "Number of dispatches recorded into command buffers.");
+
 IREE_API_EXPORT iree_status_t iree_hal_command_buffer_dispatch(
     iree_hal_command_buffer_t* command_buffer,
     iree_hal_executable_t* executable, int32_t entry_point,
@@ -446,6 +451,7 @@ IREE_API_EXPORT iree_status_t iree_hal_command_buffer_dispatch(
   iree_status_t status = _VTABLE_DISPATCH(command_buffer, dispatch)(
       command_buffer, executable, entry_point, workgroup_x, workgroup_y,
       workgroup_z);
+  IREE_METRIC_ADD(iree_hal_command_buffer_dispatches_metric, 1);
   IREE_TRACE_ZONE_END(z0);
   return status;
 }
@@ -468,6 +474,7 @@ IREE_API_EXPORT iree_status_t iree_hal_command_buffer_dispatch_indirect(
   iree_status_t status = _VTABLE_DISPATCH(command_buffer, dispatch_indirect)(
       command_buffer, executable, entry_point, workgroups_buffer,
       workgroups_offset);
+  IREE_METRIC_ADD(iree_hal_command_buffer_dispatches_metric, 1);
   IREE_TRACE_ZONE_END(z0);
   return status;
 }
@@ -7,6 +7,7 @@
 #ifndef IREE_HAL_CTS_CTS_TEST_BASE_H_
 #define IREE_HAL_CTS_CTS_TEST_BASE_H_
 
+#include <cstdio>
 #include <set>
 #include <string>
 
@@ -125,6 +126,17 @@ class CtsTestBase : public ::testing::TestWithParam<std::string> {
     return status;
   }
 
+  // Reports a performance metric of the current test. Metrics are printed and
+  // recorded as test properties so that they are included in the report
+  // written with --gtest_output=json:<path> and can be compared across
+  // drivers and runs. |name| should include the unit (e.g. `submit_ns`).
+  static void RecordPerfMetric(const char* name, double value) {
+    char value_str[32];
+    snprintf(value_str, sizeof(value_str), "%.3f", value);
+    fprintf(stdout, "[   PERF   ] %s: %s\n", name, value_str);
+    RecordProperty(name, value_str);
+  }
+
   iree_hal_driver_t* driver_ = NULL;
   iree_hal_device_t* device_ = NULL;
   iree_hal_allocator_t* device_allocator_ = NULL;
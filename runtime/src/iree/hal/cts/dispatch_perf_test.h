@@ -0,0 +1,206 @@
+// Copyright 2023 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#ifndef IREE_HAL_CTS_DISPATCH_PERF_TEST_H_
+#define IREE_HAL_CTS_DISPATCH_PERF_TEST_H_
+
+#include <cstdint>
+
+#include "iree/base/api.h"
+#include "iree/base/string_view.h"
+#include "iree/hal/api.h"
+#include "iree/hal/cts/cts_test_base.h"
+#include "iree/testing/gtest.h"
+#include "iree/testing/status_matchers.h"
+
+namespace iree {
+namespace hal {
+namespace cts {
+
+// Measures the per-dispatch overheads of a driver using the trivial `abs`
+// executable from command_buffer_dispatch_test so that the cost is dominated
+// by the driver and not by the dispatched work.
+//
+// As with perf_test the measurements are reported with RecordPerfMetric and
+// do not fail the test.
+class dispatch_perf_test : public CtsTestBase {
+ protected:
+  void SetUp() override {
+    CtsTestBase::SetUp();
+    if (!device_) return;
+
+    IREE_ASSERT_OK(iree_hal_executable_cache_create(
+        device_, iree_make_cstring_view("default"),
+        iree_loop_inline(&loop_status_), &executable_cache_));
+
+    iree_hal_descriptor_set_layout_binding_t descriptor_set_layout_bindings[] =
+        {
+            {
+                0,
+                IREE_HAL_DESCRIPTOR_TYPE_STORAGE_BUFFER,
+                IREE_HAL_DESCRIPTOR_FLAG_NONE,
+            },
+            {
+                1,
+                IREE_HAL_DESCRIPTOR_TYPE_STORAGE_BUFFER,
+                IREE_HAL_DESCRIPTOR_FLAG_NONE,
+            },
+        };
+    IREE_ASSERT_OK(iree_hal_descriptor_set_layout_create(
+        device_, IREE_HAL_DESCRIPTOR_SET_LAYOUT_FLAG_NONE,
+        IREE_ARRAYSIZE(descriptor_set_layout_bindings),
+        descriptor_set_layout_bindings, &descriptor_set_layout_));
+    IREE_ASSERT_OK(iree_hal_pipeline_layout_create(
+        device_, /*push_constants=*/0, /*set_layout_count=*/1,
+        &descriptor_set_layout_, &pipeline_layout_));
+
+    iree_hal_executable_params_t executable_params;
+    iree_hal_executable_params_initialize(&executable_params);
+    executable_params.caching_mode =
+        IREE_HAL_EXECUTABLE_CACHING_MODE_ALIAS_PROVIDED_DATA;
+    executable_params.executable_format =
+        iree_make_cstring_view(get_test_executable_format());
+    executable_params.executable_data = get_test_executable_data(
+        iree_make_cstring_view("command_buffer_dispatch_test.bin"));
+    executable_params.pipeline_layout_count = 1;
+    executable_params.pipeline_layouts = &pipeline_layout_;
+    IREE_ASSERT_OK(iree_hal_executable_cache_prepare_executable(
+        executable_cache_, &executable_params, &executable_));
+
+    // Buffers are allocated and the input initialized up front so that the
+    // timed command buffers only contain dispatches and barriers.
+    iree_hal_buffer_params_t buffer_params = {0};
+    buffer_params.type = IREE_HAL_MEMORY_TYPE_DEVICE_LOCAL;
+    buffer_params.usage =
+        IREE_HAL_BUFFER_USAGE_DISPATCH_STORAGE | IREE_HAL_BUFFER_USAGE_TRANSFER;
+    IREE_ASSERT_OK(iree_hal_allocator_allocate_buffer(
+        device_allocator_, buffer_params, sizeof(float),
+        iree_const_byte_span_empty(), &input_buffer_));
+    IREE_ASSERT_OK(iree_hal_allocator_allocate_buffer(
+        device_allocator_, buffer_params, sizeof(float),
+        iree_const_byte_span_empty(), &output_buffer_));
+    float zero = 0.0f;
+    IREE_ASSERT_OK(iree_hal_device_transfer_h2d(
+        device_, &zero, input_buffer_, /*target_offset=*/0, sizeof(zero),
+        IREE_HAL_TRANSFER_BUFFER_FLAG_DEFAULT, iree_infinite_timeout()));
+  }
+
+  void TearDown() override {
+    iree_hal_buffer_release(output_buffer_);
+    iree_hal_buffer_release(input_buffer_);
+    iree_hal_executable_release(executable_);
+    iree_hal_pipeline_layout_release(pipeline_layout_);
+    iree_hal_descriptor_set_layout_release(descriptor_set_layout_);
+    iree_hal_executable_cache_release(executable_cache_);
+    IREE_EXPECT_OK(loop_status_);
+    CtsTestBase::TearDown();
+  }
+
+  // Records |dispatch_count| dispatches of the executable into
+  // |command_buffer|, each with its own descriptor set push and followed by an
+  // execution barrier as the compiler emits for dependent dispatches.
+  void RecordDispatches(iree_hal_command_buffer_t* command_buffer,
+                        int dispatch_count) {
+    iree_hal_descriptor_set_binding_t descriptor_set_bindings[] = {
+        {
+            /*binding=*/0,
+            /*buffer_slot=*/0,
+            input_buffer_,
+            /*offset=*/0,
+            sizeof(float),
+        },
+        {
+            /*binding=*/1,
+            /*buffer_slot=*/0,
+            output_buffer_,
+            /*offset=*/0,
+            sizeof(float),
+        },
+    };
+    IREE_ASSERT_OK(iree_hal_command_buffer_begin(command_buffer));
+    for (int i = 0; i < dispatch_count; ++i) {
+      IREE_ASSERT_OK(iree_hal_command_buffer_push_descriptor_set(
+          command_buffer, pipeline_layout_, /*set=*/0,
+          IREE_ARRAYSIZE(descriptor_set_bindings), descriptor_set_bindings));
+      IREE_ASSERT_OK(iree_hal_command_buffer_dispatch(
+          command_buffer, executable_, /*entry_point=*/0,
+          /*workgroup_x=*/1, /*workgroup_y=*/1, /*workgroup_z=*/1));
+      IREE_ASSERT_OK(iree_hal_command_buffer_execution_barrier(
+          command_buffer,
+          /*source_stage_mask=*/IREE_HAL_EXECUTION_STAGE_DISPATCH |
+              IREE_HAL_EXECUTION_STAGE_COMMAND_RETIRE,
+          /*target_stage_mask=*/IREE_HAL_EXECUTION_STAGE_COMMAND_ISSUE |
+              IREE_HAL_EXECUTION_STAGE_DISPATCH,
+          IREE_HAL_EXECUTION_BARRIER_FLAG_NONE, /*memory_barrier_count=*/0,
+          /*memory_barriers=*/NULL,
+          /*buffer_barrier_count=*/0, /*buffer_barriers=*/NULL));
+    }
+    IREE_ASSERT_OK(iree_hal_command_buffer_end(command_buffer));
+  }
+
+  iree_status_t loop_status_ = iree_ok_status();
+  iree_hal_executable_cache_t* executable_cache_ = NULL;
+  iree_hal_descriptor_set_layout_t* descriptor_set_layout_ = NULL;
+  iree_hal_pipeline_layout_t* pipeline_layout_ = NULL;
+  iree_hal_executable_t* executable_ = NULL;
+  iree_hal_buffer_t* input_buffer_ = NULL;
+  iree_hal_buffer_t* output_buffer_ = NULL;
+};
+
+// Measures the host cost of recording a dispatch (with its descriptor set push
+// and barrier) into a command buffer that is deferred for later submission and
+// the cost of executing it once submitted.
+TEST_P(dispatch_perf_test, DispatchRecordAndExecute) {
+  const int kDispatchCount = 1000;
+  iree_hal_command_buffer_t* command_buffer = NULL;
+  IREE_ASSERT_OK(iree_hal_command_buffer_create(
+      device_, IREE_HAL_COMMAND_BUFFER_MODE_ONE_SHOT,
+      IREE_HAL_COMMAND_CATEGORY_DISPATCH, IREE_HAL_QUEUE_AFFINITY_ANY,
+      /*binding_capacity=*/0, &command_buffer));
+
+  iree_time_t start_ns = iree_time_now();
+  RecordDispatches(command_buffer, kDispatchCount);
+  iree_time_t end_ns = iree_time_now();
+  RecordPerfMetric("record_dispatch_ns_per_dispatch",
+                   (double)(end_ns - start_ns) / kDispatchCount);
+
+  start_ns = iree_time_now();
+  IREE_ASSERT_OK(SubmitCommandBufferAndWait(command_buffer));
+  end_ns = iree_time_now();
+  RecordPerfMetric("execute_dispatch_ns_per_dispatch",
+                   (double)(end_ns - start_ns) / kDispatchCount);
+
+  iree_hal_command_buffer_release(command_buffer);
+}
+
+// Measures the end-to-end cost of recording, submitting, and waiting on a
+// command buffer with a single dispatch as issued by synchronous invocations.
+TEST_P(dispatch_perf_test, SingleDispatchRoundTrip) {
+  const int kIterationCount = 100;
+  iree_time_t total_ns = 0;
+  for (int i = 0; i < kIterationCount; ++i) {
+    iree_time_t start_ns = iree_time_now();
+    iree_hal_command_buffer_t* command_buffer = NULL;
+    IREE_ASSERT_OK(iree_hal_command_buffer_create(
+        device_,
+        IREE_HAL_COMMAND_BUFFER_MODE_ONE_SHOT |
+            IREE_HAL_COMMAND_BUFFER_MODE_ALLOW_INLINE_EXECUTION,
+        IREE_HAL_COMMAND_CATEGORY_DISPATCH, IREE_HAL_QUEUE_AFFINITY_ANY,
+        /*binding_capacity=*/0, &command_buffer));
+    RecordDispatches(command_buffer, /*dispatch_count=*/1);
+    IREE_ASSERT_OK(SubmitCommandBufferAndWait(command_buffer));
+    iree_hal_command_buffer_release(command_buffer);
+    total_ns += iree_time_now() - start_ns;
+  }
+  RecordPerfMetric("single_dispatch_round_trip_ns",
+                   (double)total_ns / kIterationCount);
+}
+
+}  // namespace cts
+}  // namespace hal
+}  // namespace iree
+
+#endif  // IREE_HAL_CTS_DISPATCH_PERF_TEST_H_
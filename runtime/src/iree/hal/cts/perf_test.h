@@ -0,0 +1,244 @@
+// Copyright 2023 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#ifndef IREE_HAL_CTS_PERF_TEST_H_
+#define IREE_HAL_CTS_PERF_TEST_H_
+
+#include <chrono>
+#include <cstdint>
+#include <thread>
+#include <vector>
+
+#include "iree/base/api.h"
+#include "iree/hal/api.h"
+#include "iree/hal/cts/cts_test_base.h"
+#include "iree/testing/gtest.h"
+#include "iree/testing/status_matchers.h"
+
+namespace iree {
+namespace hal {
+namespace cts {
+
+// Measures driver overheads that are independent of any executable.
+//
+// These tests only check that the operations succeed; the measurements are
+// reported with RecordPerfMetric and do not fail the test. Iteration counts are
+// kept low so that the suite can run with the rest of the CTS and results
+// should be compared as trends rather than as precise benchmarks.
+class perf_test : public CtsTestBase {
+ protected:
+  void CreateDeviceBuffer(iree_device_size_t buffer_size,
+                          iree_hal_buffer_t** out_buffer) {
+    iree_hal_buffer_params_t params = {0};
+    params.type = IREE_HAL_MEMORY_TYPE_DEVICE_LOCAL;
+    params.usage = IREE_HAL_BUFFER_USAGE_TRANSFER;
+    IREE_ASSERT_OK(iree_hal_allocator_allocate_buffer(
+        device_allocator_, params, buffer_size, iree_const_byte_span_empty(),
+        out_buffer));
+  }
+};
+
+// Measures the host cost of recording a transfer command into a command
+// buffer that is deferred for later submission.
+TEST_P(perf_test, CommandBufferRecordFill) {
+  const int kCommandCount = 1000;
+  iree_hal_buffer_t* device_buffer = NULL;
+  CreateDeviceBuffer(kCommandCount * sizeof(uint32_t), &device_buffer);
+
+  iree_hal_command_buffer_t* command_buffer = NULL;
+  IREE_ASSERT_OK(iree_hal_command_buffer_create(
+      device_, IREE_HAL_COMMAND_BUFFER_MODE_ONE_SHOT,
+      IREE_HAL_COMMAND_CATEGORY_TRANSFER, IREE_HAL_QUEUE_AFFINITY_ANY,
+      /*binding_capacity=*/0, &command_buffer));
+
+  uint32_t pattern = 0xCAFEF00Du;
+  iree_time_t start_ns = iree_time_now();
+  IREE_ASSERT_OK(iree_hal_command_buffer_begin(command_buffer));
+  for (int i = 0; i < kCommandCount; ++i) {
+    IREE_ASSERT_OK(iree_hal_command_buffer_fill_buffer(
+        command_buffer, device_buffer, /*target_offset=*/i * sizeof(pattern),
+        /*length=*/sizeof(pattern), &pattern, sizeof(pattern)));
+  }
+  IREE_ASSERT_OK(iree_hal_command_buffer_end(command_buffer));
+  iree_time_t end_ns = iree_time_now();
+  RecordPerfMetric("record_fill_ns_per_command",
+                   (double)(end_ns - start_ns) / kCommandCount);
+
+  IREE_ASSERT_OK(SubmitCommandBufferAndWait(command_buffer));
+
+  iree_hal_command_buffer_release(command_buffer);
+  iree_hal_buffer_release(device_buffer);
+}
+
+// Measures the round trip of submitting work to the queue and waiting for its
+// signal: once with a barrier and once with an empty command buffer.
+TEST_P(perf_test, QueueSubmitLatency) {
+  const int kIterationCount = 100;
+  iree_hal_semaphore_t* semaphore = NULL;
+  IREE_ASSERT_OK(iree_hal_semaphore_create(device_, 0ull, &semaphore));
+  uint64_t payload_value = 0ull;
+  iree_hal_semaphore_list_t signal_semaphores = {
+      /*count=*/1,
+      /*semaphores=*/&semaphore,
+      /*payload_values=*/&payload_value,
+  };
+
+  iree_time_t barrier_ns = 0;
+  for (int i = 0; i < kIterationCount; ++i) {
+    ++payload_value;
+    iree_time_t start_ns = iree_time_now();
+    IREE_ASSERT_OK(iree_hal_device_queue_barrier(
+        device_, IREE_HAL_QUEUE_AFFINITY_ANY, iree_hal_semaphore_list_empty(),
+        signal_semaphores));
+    IREE_ASSERT_OK(iree_hal_semaphore_wait(semaphore, payload_value,
+                                           iree_infinite_timeout()));
+    barrier_ns += iree_time_now() - start_ns;
+  }
+  RecordPerfMetric("queue_barrier_ns", (double)barrier_ns / kIterationCount);
+
+  // Command buffers are recorded outside of the timed region.
+  iree_time_t execute_ns = 0;
+  for (int i = 0; i < kIterationCount; ++i) {
+    iree_hal_command_buffer_t* command_buffer = NULL;
+    IREE_ASSERT_OK(iree_hal_command_buffer_create(
+        device_, IREE_HAL_COMMAND_BUFFER_MODE_ONE_SHOT,
+        IREE_HAL_COMMAND_CATEGORY_ANY, IREE_HAL_QUEUE_AFFINITY_ANY,
+        /*binding_capacity=*/0, &command_buffer));
+    IREE_ASSERT_OK(iree_hal_command_buffer_begin(command_buffer));
+    IREE_ASSERT_OK(iree_hal_command_buffer_end(command_buffer));
+
+    ++payload_value;
+    iree_time_t start_ns = iree_time_now();
+    IREE_ASSERT_OK(iree_hal_device_queue_execute(
+        device_, IREE_HAL_QUEUE_AFFINITY_ANY, iree_hal_semaphore_list_empty(),
+        signal_semaphores, 1, &command_buffer));
+    IREE_ASSERT_OK(iree_hal_semaphore_wait(semaphore, payload_value,
+                                           iree_infinite_timeout()));
+    execute_ns += iree_time_now() - start_ns;
+
+    iree_hal_command_buffer_release(command_buffer);
+  }
+  RecordPerfMetric("queue_execute_ns", (double)execute_ns / kIterationCount);
+
+  iree_hal_semaphore_release(semaphore);
+}
+
+// Measures the time from a host signal of a semaphore until a thread blocked
+// waiting on it resumes.
+TEST_P(perf_test, SemaphoreSignalToWakeLatency) {
+  const int kIterationCount = 100;
+  iree_hal_semaphore_t* semaphore = NULL;
+  IREE_ASSERT_OK(iree_hal_semaphore_create(device_, 0ull, &semaphore));
+  // Signaled by the waiter once it has recorded its wake time so that each
+  // signal happens while the waiter is blocked.
+  iree_hal_semaphore_t* ack_semaphore = NULL;
+  IREE_ASSERT_OK(iree_hal_semaphore_create(device_, 0ull, &ack_semaphore));
+
+  std::vector<iree_time_t> wake_times(kIterationCount);
+  std::thread waiter([&]() {
+    for (int i = 0; i < kIterationCount; ++i) {
+      IREE_CHECK_OK(iree_hal_semaphore_wait(semaphore, i + 1ull,
+                                            iree_infinite_timeout()));
+      wake_times[i] = iree_time_now();
+      IREE_CHECK_OK(iree_hal_semaphore_signal(ack_semaphore, i + 1ull));
+    }
+  });
+
+  iree_time_t total_ns = 0;
+  for (int i = 0; i < kIterationCount; ++i) {
+    // Give the waiter time to block; otherwise this would only measure the
+    // fast path of waiting on an already signaled semaphore.
+    std::this_thread::sleep_for(std::chrono::microseconds(100));
+    iree_time_t signal_ns = iree_time_now();
+    IREE_ASSERT_OK(iree_hal_semaphore_signal(semaphore, i + 1ull));
+    IREE_ASSERT_OK(iree_hal_semaphore_wait(ack_semaphore, i + 1ull,
+                                           iree_infinite_timeout()));
+    total_ns += wake_times[i] - signal_ns;
+  }
+  waiter.join();
+  RecordPerfMetric("semaphore_signal_to_wake_ns",
+                   (double)total_ns / kIterationCount);
+
+  iree_hal_semaphore_release(ack_semaphore);
+  iree_hal_semaphore_release(semaphore);
+}
+
+// Measures the cost of allocating and freeing device-local buffers of a few
+// sizes.
+TEST_P(perf_test, AllocatorAllocateFree) {
+  const int kIterationCount = 100;
+  const struct {
+    const char* metric_name;
+    iree_device_size_t buffer_size;
+  } kCases[] = {
+      {"allocate_free_4kb_ns", 4 * 1024},
+      {"allocate_free_1mb_ns", 1024 * 1024},
+  };
+  for (const auto& test_case : kCases) {
+    iree_time_t start_ns = iree_time_now();
+    for (int i = 0; i < kIterationCount; ++i) {
+      iree_hal_buffer_t* buffer = NULL;
+      CreateDeviceBuffer(test_case.buffer_size, &buffer);
+      iree_hal_buffer_release(buffer);
+    }
+    iree_time_t end_ns = iree_time_now();
+    RecordPerfMetric(test_case.metric_name,
+                     (double)(end_ns - start_ns) / kIterationCount);
+  }
+}
+
+// Measures the bandwidth of synchronous host-to-device and device-to-host
+// transfers.
+TEST_P(perf_test, TransferBandwidth) {
+  const int kIterationCount = 4;
+  const iree_device_size_t kBufferSize = 16 * 1024 * 1024;
+  iree_hal_buffer_t* device_buffer = NULL;
+  CreateDeviceBuffer(kBufferSize, &device_buffer);
+  std::vector<uint8_t> host_data(kBufferSize, 0xCD);
+
+  // One untimed transfer in each direction warms up staging resources.
+  IREE_ASSERT_OK(iree_hal_device_transfer_h2d(
+      device_, host_data.data(), device_buffer, /*target_offset=*/0,
+      kBufferSize, IREE_HAL_TRANSFER_BUFFER_FLAG_DEFAULT,
+      iree_infinite_timeout()));
+  IREE_ASSERT_OK(iree_hal_device_transfer_d2h(
+      device_, device_buffer, /*source_offset=*/0, host_data.data(),
+      kBufferSize, IREE_HAL_TRANSFER_BUFFER_FLAG_DEFAULT,
+      iree_infinite_timeout()));
+
+  // Bytes per nanosecond is the same as gigabytes per second.
+  iree_time_t start_ns = iree_time_now();
+  for (int i = 0; i < kIterationCount; ++i) {
+    IREE_ASSERT_OK(iree_hal_device_transfer_h2d(
+        device_, host_data.data(), device_buffer, /*target_offset=*/0,
+        kBufferSize, IREE_HAL_TRANSFER_BUFFER_FLAG_DEFAULT,
+        iree_infinite_timeout()));
+  }
+  iree_time_t end_ns = iree_time_now();
+  RecordPerfMetric("transfer_h2d_gb_per_s",
+                   (double)(kIterationCount * kBufferSize) /
+                       (double)(end_ns - start_ns));
+
+  start_ns = iree_time_now();
+  for (int i = 0; i < kIterationCount; ++i) {
+    IREE_ASSERT_OK(iree_hal_device_transfer_d2h(
+        device_, device_buffer, /*source_offset=*/0, host_data.data(),
+        kBufferSize, IREE_HAL_TRANSFER_BUFFER_FLAG_DEFAULT,
+        iree_infinite_timeout()));
+  }
+  end_ns = iree_time_now();
+  RecordPerfMetric("transfer_d2h_gb_per_s",
+                   (double)(kIterationCount * kBufferSize) /
+                       (double)(end_ns - start_ns));
+
+  iree_hal_buffer_release(device_buffer);
+}
+
+}  // namespace cts
+}  // namespace hal
+}  // namespace iree
+
+#endif  // IREE_HAL_CTS_PERF_TEST_H_
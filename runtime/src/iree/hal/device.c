@@ -6,6 +6,8 @@
 
 #include "iree/hal/device.h"
 
+#include "iree/base/internal/metrics.h"
+#include "iree/base/internal/sampling_tracer.h"
 #include "iree/base/tracing.h"
 #include "iree/hal/allocator.h"
 #include "iree/hal/buffer.h"
@@ -234,9 +236,11 @@ IREE_API_EXPORT iree_status_t iree_hal_device_queue_execute(
     }
   }
 
+  IREE_SAMPLED_ZONE_BEGIN(z_sample, "iree_hal_device_queue_execute");
   iree_status_t status = _VTABLE_DISPATCH(device, queue_execute)(
       device, queue_affinity, wait_semaphore_list, signal_semaphore_list,
       command_buffer_count, command_buffers);
+  IREE_SAMPLED_ZONE_END(z_sample);
 
   IREE_TRACE_ZONE_END(z0);
   return status;
@@ -265,14 +269,21 @@ IREE_API_EXPORT iree_status_t iree_hal_device_queue_flush(
   return status;
 }
 
+IREE_METRIC_DEFINE(iree_hal_device_wait_semaphores_duration_metric, HISTOGRAM,
+                   "iree_hal_device_wait_semaphores_duration_microseconds",
+                   "Time spent blocked waiting on semaphore lists (fences).");
+
 IREE_API_EXPORT iree_status_t iree_hal_device_wait_semaphores(
     iree_hal_device_t* device, iree_hal_wait_mode_t wait_mode,
     const iree_hal_semaphore_list_t semaphore_list, iree_timeout_t timeout) {
   IREE_ASSERT_ARGUMENT(device);
   if (semaphore_list.count == 0) return iree_ok_status();
   IREE_TRACE_ZONE_BEGIN(z0);
+  IREE_METRICS(const iree_time_t start_ns = iree_time_now());
   iree_status_t status = _VTABLE_DISPATCH(device, wait_semaphores)(
       device, wait_mode, semaphore_list, timeout);
+  IREE_METRIC_OBSERVE(iree_hal_device_wait_semaphores_duration_metric,
+                      (iree_time_now() - start_ns) / 1000);
   IREE_TRACE_ZONE_END(z0);
   return status;
 }
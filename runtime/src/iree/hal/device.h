@@ -95,6 +95,15 @@ enum iree_hal_device_profiling_mode_bits_t {
   // locations. This can have a significant performance impact and should only
   // be used when investigating the performance of an individual dispatch.
   IREE_HAL_DEVICE_PROFILING_MODE_EXECUTABLE_COUNTERS = 1u << 2,
+
+  // Capture the start and end timestamps of every dispatch along with its
+  // executable, entry point, and workgroup count. This is implemented by the
+  // HAL drivers themselves and needs no external tooling or tracing build.
+  // When profiling ends the records are written as CSV to the |file_path|
+  // specified in the profiling options. Timestamps are in the device timebase
+  // and only differences between timestamps from the same capture are
+  // meaningful.
+  IREE_HAL_DEVICE_PROFILING_MODE_DISPATCH_TIMESTAMPS = 1u << 3,
 };
 typedef uint32_t iree_hal_device_profiling_mode_t;
 
@@ -213,14 +222,6 @@ typedef struct iree_hal_submission_batch_t {
   iree_hal_semaphore_list_t signal_semaphores;
 } iree_hal_submission_batch_t;
 
-// Defines how a multi-wait operation treats the results of multiple semaphores.
-typedef enum iree_hal_wait_mode_e {
-  // Waits for all semaphores to reach or exceed their specified values.
-  IREE_HAL_WAIT_MODE_ALL = 0,
-  // Waits for one or more semaphores to reach or exceed their specified values.
-  IREE_HAL_WAIT_MODE_ANY = 1,
-} iree_hal_wait_mode_t;
-
 //===----------------------------------------------------------------------===//
 // iree_hal_device_t
 //===----------------------------------------------------------------------===//
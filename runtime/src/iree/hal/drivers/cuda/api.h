@@ -29,12 +29,32 @@ typedef struct {
   char data[128];
 } iree_hal_cuda_nccl_id_t;
 
+// Parameters defining a CUmemoryPool.
+typedef struct iree_hal_cuda_memory_pool_params_t {
+  // Minimum number of bytes to keep in the pool when trimming with
+  // iree_hal_device_trim.
+  uint64_t minimum_capacity;
+  // Soft maximum number of bytes to keep in the pool.
+  // When more than this is allocated the extra will be freed at the next
+  // device synchronization in order to remain under the threshold.
+  uint64_t release_threshold;
+} iree_hal_cuda_memory_pool_params_t;
+
+// Parameters for each CUmemoryPool used for queue-ordered allocations.
+typedef struct iree_hal_cuda_memory_pooling_params_t {
+  // Used exclusively for DEVICE_LOCAL allocations.
+  iree_hal_cuda_memory_pool_params_t device_local;
+} iree_hal_cuda_memory_pooling_params_t;
+
 // Parameters configuring an iree_hal_cuda_device_t.
 // Must be initialized with iree_hal_cuda_device_params_initialize prior to use.
 typedef struct iree_hal_cuda_device_params_t {
   // Number of queues exposed on the device.
-  // Each queue acts as a separate synchronization scope where all work executes
-  // concurrently unless prohibited by semaphores.
+  // Each queue is backed by its own CUDA stream and acts as a separate
+  // synchronization scope: work on different queues executes concurrently
+  // unless prohibited by semaphores. The lowest set bit of a queue affinity
+  // selects the queue, wrapping around the queue count. At most 64 queues are
+  // supported.
   iree_host_size_t queue_count;
 
   // Total size of each block in the device shared block pool.
@@ -45,11 +65,39 @@ typedef struct iree_hal_cuda_device_params_t {
   // Specifies how command buffers are recorded and executed.
   iree_hal_cuda_command_buffer_mode_t command_buffer_mode;
 
+  // Maximum number of idle CUgraphExecs retained from released graph command
+  // buffers. Command buffers recorded with the same structure update a cached
+  // exec in-place instead of instantiating a new graph. 0 disables caching.
+  iree_host_size_t graph_exec_cache_capacity;
+
+  // Size in bytes of each chunk of pinned host staging memory used to transfer
+  // to and from device buffers that cannot be mapped into host memory with
+  // iree_hal_device_transfer_range. Two chunks are allocated so that the host
+  // copy of one overlaps with the DMA of the other. 0 disables staging and
+  // uses the generic transfer path.
+  iree_device_size_t staging_chunk_size;
+
   // Allow executing command buffers against CUDA streams as they are recorded.
   // Only command buffers produced by the compiler that have the
   // IREE_HAL_COMMAND_BUFFER_MODE_ALLOW_INLINE_EXECUTION bit set will use this.
   bool allow_inline_execution;
 
+  // Enables queue-ordered allocations using CUDA memory pools
+  // (cuMemAllocFromPoolAsync/cuMemFreeAsync) for iree_hal_device_queue_alloca
+  // and iree_hal_device_queue_dealloca. When disabled or unsupported by the
+  // device allocations are made synchronously with the device allocator.
+  bool async_allocations;
+
+  // Parameters for each CUmemoryPool used for queue-ordered allocations.
+  iree_hal_cuda_memory_pooling_params_t memory_pools;
+
+  // Defers JIT compilation of executable PTX and resolution of their kernels
+  // until each executable is first dispatched. Reduces the time to prepare
+  // executables with many kernels when only some are used at the cost of
+  // latency on the first dispatch. Compiled kernels are cached on disk by the
+  // CUDA driver independently of this setting (see CUDA_CACHE_PATH).
+  bool lazy_executable_loading;
+
   // Opaque NCCL ID used during channel creation when empty IDs are provided.
   // Today this is used for all communicators created but in the future this may
   // just be used as a default when not otherwise specified on channel creation.
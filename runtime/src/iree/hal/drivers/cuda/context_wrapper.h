@@ -17,6 +17,8 @@ typedef struct iree_hal_cuda_context_wrapper_t {
   CUcontext cu_context;
   iree_allocator_t host_allocator;
   iree_hal_cuda_dynamic_symbols_t* syms;
+  // NCCL symbols; NULL until loaded on first collective channel creation.
+  iree_hal_cuda_nccl_dynamic_symbols_t* nccl_syms;
 } iree_hal_cuda_context_wrapper_t;
 
 #endif  // IREE_HAL_DRIVERS_CUDA_CONTEXT_WRAPPER_H_
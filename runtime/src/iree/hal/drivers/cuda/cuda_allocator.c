@@ -24,6 +24,7 @@ typedef struct iree_hal_cuda_allocator_t {
   iree_hal_cuda_context_wrapper_t* context;
   CUdevice device;
   CUstream stream;
+  iree_hal_cuda_memory_pools_t* pools;
   bool supports_concurrent_managed_access;
 
   IREE_STATISTICS(iree_hal_allocator_statistics_t statistics;)
@@ -39,9 +40,11 @@ static iree_hal_cuda_allocator_t* iree_hal_cuda_allocator_cast(
 
 iree_status_t iree_hal_cuda_allocator_create(
     iree_hal_device_t* base_device, iree_hal_cuda_context_wrapper_t* context,
-    CUdevice device, CUstream stream, iree_hal_allocator_t** out_allocator) {
+    CUdevice device, CUstream stream, iree_hal_cuda_memory_pools_t* pools,
+    iree_hal_allocator_t** out_allocator) {
   IREE_ASSERT_ARGUMENT(base_device);
   IREE_ASSERT_ARGUMENT(context);
+  IREE_ASSERT_ARGUMENT(pools);
   IREE_TRACE_ZONE_BEGIN(z0);
 
   // To support device-local + host-visible memory we need concurrent managed
@@ -75,6 +78,7 @@ iree_status_t iree_hal_cuda_allocator_create(
     allocator->context = context;
     allocator->device = device;
     allocator->stream = stream;
+    allocator->pools = pools;
     allocator->supports_concurrent_managed_access =
         supports_concurrent_managed_access != 0;
     *out_allocator = (iree_hal_allocator_t*)allocator;
@@ -115,6 +119,8 @@ static void iree_hal_cuda_allocator_query_statistics(
     iree_hal_cuda_allocator_t* allocator =
         iree_hal_cuda_allocator_cast(base_allocator);
     memcpy(out_statistics, &allocator->statistics, sizeof(*out_statistics));
+    iree_hal_cuda_memory_pools_merge_statistics(allocator->pools,
+                                                out_statistics);
   });
 }
 
@@ -155,15 +161,28 @@ iree_hal_cuda_allocator_query_compatibility(
 }
 
 static void iree_hal_cuda_buffer_free(iree_hal_cuda_context_wrapper_t* context,
-                                      iree_hal_memory_type_t memory_type,
+                                      iree_hal_cuda_buffer_type_t buffer_type,
                                       CUdeviceptr device_ptr, void* host_ptr) {
   IREE_TRACE_ZONE_BEGIN(z0);
-  if (iree_all_bits_set(memory_type, IREE_HAL_MEMORY_TYPE_DEVICE_LOCAL)) {
-    // Device local.
-    CUDA_IGNORE_ERROR(context->syms, cuMemFree(device_ptr));
-  } else {
-    // Host local.
-    CUDA_IGNORE_ERROR(context->syms, cuMemFreeHost(host_ptr));
+  switch (buffer_type) {
+    case IREE_HAL_CUDA_BUFFER_TYPE_DEVICE: {
+      IREE_TRACE_ZONE_APPEND_TEXT(z0, "cuMemFree");
+      CUDA_IGNORE_ERROR(context->syms, cuMemFree(device_ptr));
+      break;
+    }
+    case IREE_HAL_CUDA_BUFFER_TYPE_HOST: {
+      IREE_TRACE_ZONE_APPEND_TEXT(z0, "cuMemFreeHost");
+      CUDA_IGNORE_ERROR(context->syms, cuMemFreeHost(host_ptr));
+      break;
+    }
+    case IREE_HAL_CUDA_BUFFER_TYPE_ASYNC: {
+      // Async buffers are owned by the memory pools and released by them.
+      break;
+    }
+    case IREE_HAL_CUDA_BUFFER_TYPE_EXTERNAL: {
+      // External buffers are released by their release callback.
+      break;
+    }
   }
   IREE_TRACE_ZONE_END(z0);
 }
@@ -196,6 +215,7 @@ static iree_status_t iree_hal_cuda_allocator_allocate_buffer(
   }
 
   iree_status_t status = iree_ok_status();
+  iree_hal_cuda_buffer_type_t buffer_type = IREE_HAL_CUDA_BUFFER_TYPE_DEVICE;
   void* host_ptr = NULL;
   CUdeviceptr device_ptr = 0;
   IREE_TRACE_ZONE_BEGIN_NAMED(z0, "iree_hal_cuda_buffer_allocate");
@@ -222,6 +242,7 @@ static iree_status_t iree_hal_cuda_allocator_allocate_buffer(
                                    cuMemAlloc(&device_ptr, allocation_size));
     }
   } else {
+    buffer_type = IREE_HAL_CUDA_BUFFER_TYPE_HOST;
     unsigned int flags = CU_MEMHOSTALLOC_DEVICEMAP;
     if (!iree_all_bits_set(memory_type, IREE_HAL_MEMORY_TYPE_HOST_CACHED)) {
       flags |= CU_MEMHOSTALLOC_WRITECOMBINED;
@@ -243,7 +264,9 @@ static iree_status_t iree_hal_cuda_allocator_allocate_buffer(
         base_allocator, memory_type, params->access, params->usage,
         allocation_size,
         /*byte_offset=*/0,
-        /*byte_length=*/allocation_size, device_ptr, host_ptr, &buffer);
+        /*byte_length=*/allocation_size, buffer_type, device_ptr, host_ptr,
+        iree_hal_buffer_release_callback_null(),
+        iree_hal_allocator_host_allocator(base_allocator), &buffer);
   }
 
   // Copy the initial contents into the buffer. This may require staging.
@@ -267,7 +290,7 @@ static iree_status_t iree_hal_cuda_allocator_allocate_buffer(
     *out_buffer = buffer;
   } else {
     if (!buffer) {
-      iree_hal_cuda_buffer_free(allocator->context, memory_type, device_ptr,
+      iree_hal_cuda_buffer_free(allocator->context, buffer_type, device_ptr,
                                 host_ptr);
     } else {
       iree_hal_buffer_release(buffer);
@@ -282,7 +305,14 @@ static void iree_hal_cuda_allocator_deallocate_buffer(
   iree_hal_cuda_allocator_t* allocator =
       iree_hal_cuda_allocator_cast(base_allocator);
   iree_hal_memory_type_t memory_type = iree_hal_buffer_memory_type(base_buffer);
-  iree_hal_cuda_buffer_free(allocator->context, memory_type,
+  iree_hal_cuda_buffer_type_t buffer_type =
+      iree_hal_cuda_buffer_type(base_buffer);
+  if (buffer_type == IREE_HAL_CUDA_BUFFER_TYPE_EXTERNAL) {
+    // Imported buffers were not allocated by us and are not tracked.
+    iree_hal_buffer_destroy(base_buffer);
+    return;
+  }
+  iree_hal_cuda_buffer_free(allocator->context, buffer_type,
                             iree_hal_cuda_buffer_device_pointer(base_buffer),
                             iree_hal_cuda_buffer_host_pointer(base_buffer));
 
@@ -296,14 +326,98 @@ static void iree_hal_cuda_allocator_deallocate_buffer(
   iree_hal_buffer_destroy(base_buffer);
 }
 
+// Enables access from the allocator context to memory owned by |peer_context|.
+// Peer access is enabled per context pair and remains enabled for the lifetime
+// of the context so this only has a cost the first time it is called. Once
+// enabled copies issued on either queue as part of command buffers are routed
+// directly over PCIe or NVLink.
+static iree_status_t iree_hal_cuda_allocator_enable_peer_access(
+    iree_hal_cuda_allocator_t* allocator, CUcontext peer_context) {
+  iree_hal_cuda_dynamic_symbols_t* syms = allocator->context->syms;
+  IREE_RETURN_IF_ERROR(CU_RESULT_TO_STATUS(
+      syms, cuCtxSetCurrent(allocator->context->cu_context),
+      "cuCtxSetCurrent"));
+  CUresult result = syms->cuCtxEnablePeerAccess(peer_context, /*Flags=*/0);
+  if (result == CUDA_ERROR_PEER_ACCESS_ALREADY_ENABLED) {
+    return iree_ok_status();
+  }
+  return iree_hal_cuda_result_to_status(syms, result, __FILE__, __LINE__);
+}
+
+// Imports a device allocation made by this or another CUDA device. Allocations
+// from other devices require that the devices support peer access.
+static iree_status_t iree_hal_cuda_allocator_import_device_allocation(
+    iree_hal_cuda_allocator_t* IREE_RESTRICT allocator,
+    const iree_hal_buffer_params_t* IREE_RESTRICT params,
+    iree_hal_external_buffer_t* IREE_RESTRICT external_buffer,
+    iree_hal_buffer_release_callback_t release_callback,
+    iree_hal_buffer_t** IREE_RESTRICT out_buffer) {
+  iree_hal_cuda_dynamic_symbols_t* syms = allocator->context->syms;
+  if (iree_any_bit_set(params->type, IREE_HAL_MEMORY_TYPE_HOST_VISIBLE)) {
+    return iree_make_status(IREE_STATUS_UNAVAILABLE,
+                            "device allocations cannot be imported as "
+                            "host-visible memory");
+  }
+  CUdeviceptr device_ptr =
+      (CUdeviceptr)external_buffer->handle.device_allocation.ptr;
+
+  // Memory owned by our own context can be used as-is while memory owned by
+  // another device needs peer access.
+  CUcontext owner_context = NULL;
+  IREE_RETURN_IF_ERROR(CU_RESULT_TO_STATUS(
+      syms,
+      cuPointerGetAttribute(&owner_context, CU_POINTER_ATTRIBUTE_CONTEXT,
+                            device_ptr),
+      "cuPointerGetAttribute"));
+  if (owner_context != allocator->context->cu_context) {
+    int owner_ordinal = 0;
+    IREE_RETURN_IF_ERROR(CU_RESULT_TO_STATUS(
+        syms,
+        cuPointerGetAttribute(&owner_ordinal,
+                              CU_POINTER_ATTRIBUTE_DEVICE_ORDINAL, device_ptr),
+        "cuPointerGetAttribute"));
+    CUdevice owner_device = 0;
+    IREE_RETURN_IF_ERROR(CU_RESULT_TO_STATUS(
+        syms, cuDeviceGet(&owner_device, owner_ordinal), "cuDeviceGet"));
+    int can_access_peer = 0;
+    IREE_RETURN_IF_ERROR(CU_RESULT_TO_STATUS(
+        syms,
+        cuDeviceCanAccessPeer(&can_access_peer, allocator->device,
+                              owner_device),
+        "cuDeviceCanAccessPeer"));
+    if (!can_access_peer) {
+      return iree_make_status(IREE_STATUS_UNAVAILABLE,
+                              "device cannot access memory of peer device %d",
+                              owner_ordinal);
+    }
+    IREE_RETURN_IF_ERROR(
+        iree_hal_cuda_allocator_enable_peer_access(allocator, owner_context));
+  }
+
+  return iree_hal_cuda_buffer_wrap(
+      (iree_hal_allocator_t*)allocator, params->type, params->access,
+      params->usage, external_buffer->size, /*byte_offset=*/0,
+      /*byte_length=*/external_buffer->size,
+      IREE_HAL_CUDA_BUFFER_TYPE_EXTERNAL, device_ptr, /*host_ptr=*/NULL,
+      release_callback, allocator->context->host_allocator, out_buffer);
+}
+
 static iree_status_t iree_hal_cuda_allocator_import_buffer(
     iree_hal_allocator_t* IREE_RESTRICT base_allocator,
     const iree_hal_buffer_params_t* IREE_RESTRICT params,
     iree_hal_external_buffer_t* IREE_RESTRICT external_buffer,
     iree_hal_buffer_release_callback_t release_callback,
     iree_hal_buffer_t** IREE_RESTRICT out_buffer) {
-  return iree_make_status(IREE_STATUS_UNAVAILABLE,
-                          "importing from external buffers not supported");
+  iree_hal_cuda_allocator_t* allocator =
+      iree_hal_cuda_allocator_cast(base_allocator);
+  switch (external_buffer->type) {
+    case IREE_HAL_EXTERNAL_BUFFER_TYPE_DEVICE_ALLOCATION:
+      return iree_hal_cuda_allocator_import_device_allocation(
+          allocator, params, external_buffer, release_callback, out_buffer);
+    default:
+      return iree_make_status(IREE_STATUS_UNAVAILABLE,
+                              "external buffer type not supported");
+  }
 }
 
 static iree_status_t iree_hal_cuda_allocator_export_buffer(
@@ -312,8 +426,20 @@ static iree_status_t iree_hal_cuda_allocator_export_buffer(
     iree_hal_external_buffer_type_t requested_type,
     iree_hal_external_buffer_flags_t requested_flags,
     iree_hal_external_buffer_t* IREE_RESTRICT out_external_buffer) {
-  return iree_make_status(IREE_STATUS_UNAVAILABLE,
-                          "exporting to external buffers not supported");
+  if (requested_type != IREE_HAL_EXTERNAL_BUFFER_TYPE_DEVICE_ALLOCATION ||
+      !iree_all_bits_set(iree_hal_buffer_memory_type(buffer),
+                         IREE_HAL_MEMORY_TYPE_DEVICE_LOCAL)) {
+    return iree_make_status(IREE_STATUS_UNAVAILABLE,
+                            "exporting to external buffer type not supported");
+  }
+  CUdeviceptr device_ptr = iree_hal_cuda_buffer_device_pointer(
+      iree_hal_buffer_allocated_buffer(buffer));
+  out_external_buffer->type = requested_type;
+  out_external_buffer->flags = requested_flags;
+  out_external_buffer->size = iree_hal_buffer_byte_length(buffer);
+  out_external_buffer->handle.device_allocation.ptr =
+      (uint64_t)(device_ptr + iree_hal_buffer_byte_offset(buffer));
+  return iree_ok_status();
 }
 
 static const iree_hal_allocator_vtable_t iree_hal_cuda_allocator_vtable = {
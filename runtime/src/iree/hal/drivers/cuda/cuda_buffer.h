@@ -15,13 +15,42 @@
 extern "C" {
 #endif  // __cplusplus
 
+// Describes how the backing memory of a CUDA buffer was allocated.
+typedef enum iree_hal_cuda_buffer_type_e {
+  // cuMemAlloc/cuMemAllocManaged + cuMemFree
+  IREE_HAL_CUDA_BUFFER_TYPE_DEVICE = 0,
+  // cuMemHostAlloc + cuMemFreeHost
+  IREE_HAL_CUDA_BUFFER_TYPE_HOST,
+  // cuMemAllocFromPoolAsync + cuMemFreeAsync
+  IREE_HAL_CUDA_BUFFER_TYPE_ASYNC,
+  // Imported memory owned by another allocation (such as a peer device).
+  // Only the release callback is issued when the buffer is destroyed.
+  IREE_HAL_CUDA_BUFFER_TYPE_EXTERNAL,
+} iree_hal_cuda_buffer_type_t;
+
 // Wraps a CUDA allocation in an iree_hal_buffer_t.
+// The optional |release_callback| will be issued when the buffer is destroyed
+// and can be used to free the backing memory when |allocator| is NULL.
 iree_status_t iree_hal_cuda_buffer_wrap(
     iree_hal_allocator_t* allocator, iree_hal_memory_type_t memory_type,
     iree_hal_memory_access_t allowed_access,
     iree_hal_buffer_usage_t allowed_usage, iree_device_size_t allocation_size,
     iree_device_size_t byte_offset, iree_device_size_t byte_length,
-    CUdeviceptr device_ptr, void* host_ptr, iree_hal_buffer_t** out_buffer);
+    iree_hal_cuda_buffer_type_t buffer_type, CUdeviceptr device_ptr,
+    void* host_ptr, iree_hal_buffer_release_callback_t release_callback,
+    iree_allocator_t host_allocator, iree_hal_buffer_t** out_buffer);
+
+// Returns true if |buffer| is an iree_hal_cuda_buffer_t.
+bool iree_hal_cuda_buffer_isa(iree_hal_buffer_t* buffer);
+
+// Returns the type of allocation backing the given |buffer|.
+iree_hal_cuda_buffer_type_t iree_hal_cuda_buffer_type(
+    const iree_hal_buffer_t* buffer);
+
+// Drops the release callback of |buffer| so that it is not issued when the
+// buffer is destroyed. Used when the backing memory has been released by other
+// means such as a queue-ordered cuMemFreeAsync.
+void iree_hal_cuda_buffer_drop_release_callback(iree_hal_buffer_t* buffer);
 
 // Returns the CUDA base pointer for the given |buffer|.
 // This is the entire allocated_buffer and must be offset by the buffer
@@ -11,22 +11,74 @@
 #include <string.h>
 
 #include "iree/base/internal/arena.h"
+#include "iree/base/internal/atomics.h"
 #include "iree/base/internal/math.h"
+#include "iree/base/internal/synchronization.h"
 #include "iree/base/tracing.h"
 #include "iree/hal/drivers/cuda/context_wrapper.h"
 #include "iree/hal/drivers/cuda/cuda_allocator.h"
+#include "iree/hal/drivers/cuda/cuda_buffer.h"
 #include "iree/hal/drivers/cuda/cuda_event.h"
 #include "iree/hal/drivers/cuda/dynamic_symbols.h"
 #include "iree/hal/drivers/cuda/event_semaphore.h"
 #include "iree/hal/drivers/cuda/graph_command_buffer.h"
+#include "iree/hal/drivers/cuda/graph_exec_cache.h"
+#include "iree/hal/drivers/cuda/memory_pools.h"
 #include "iree/hal/drivers/cuda/nccl_channel.h"
 #include "iree/hal/drivers/cuda/nop_executable_cache.h"
 #include "iree/hal/drivers/cuda/pipeline_layout.h"
+#include "iree/hal/drivers/cuda/staging_buffer.h"
 #include "iree/hal/drivers/cuda/status_util.h"
 #include "iree/hal/drivers/cuda/stream_command_buffer.h"
 #include "iree/hal/utils/buffer_transfer.h"
 #include "iree/hal/utils/deferred_command_buffer.h"
 
+//===----------------------------------------------------------------------===//
+// iree_hal_cuda_submission_t
+//===----------------------------------------------------------------------===//
+
+// An in-flight queue operation on the device stream.
+// Retains the resources that must remain live until the stream has executed
+// the operation and the semaphores that are signaled on the host once it has.
+typedef struct iree_hal_cuda_submission_t {
+  // Next submission in the device list in stream order.
+  struct iree_hal_cuda_submission_t* next;
+  // Set from the stream host callback once the stream has passed the
+  // submission. Completed submissions are reclaimed by the device on user
+  // threads as no resources may be released from the callback.
+  iree_atomic_int32_t is_complete;
+  // Semaphores signaled when the submission completes. Retained.
+  iree_hal_semaphore_list_t signal_semaphore_list;
+  // Resources used by the submission. Retained.
+  iree_host_size_t resource_count;
+  iree_hal_resource_t** resources;
+} iree_hal_cuda_submission_t;
+
+//===----------------------------------------------------------------------===//
+// iree_hal_cuda_queue_t
+//===----------------------------------------------------------------------===//
+
+// Maximum number of queues (and streams) per device; one per affinity bit.
+#define IREE_HAL_CUDA_MAX_QUEUE_COUNT 64
+
+// A logical device queue backed by a single CUDA stream.
+// Work submitted to a queue executes in order while work on different queues
+// may execute concurrently unless ordered by semaphores.
+typedef struct iree_hal_cuda_queue_t {
+  CUstream stream;
+
+  // Cache of the direct stream command buffer initialized when in stream mode.
+  iree_hal_command_buffer_t* stream_command_buffer;
+
+  // Guards the submission list.
+  iree_slim_mutex_t submission_mutex;
+  // In-flight submissions in stream order.
+  iree_hal_cuda_submission_t* submission_head
+      IREE_GUARDED_BY(submission_mutex);
+  iree_hal_cuda_submission_t* submission_tail
+      IREE_GUARDED_BY(submission_mutex);
+} iree_hal_cuda_queue_t;
+
 //===----------------------------------------------------------------------===//
 // iree_hal_cuda_device_t
 //===----------------------------------------------------------------------===//
@@ -48,14 +100,32 @@ typedef struct iree_hal_cuda_device_t {
 
   CUdevice device;
 
-  // TODO: support multiple streams.
-  CUstream stream;
   iree_hal_cuda_context_wrapper_t context_wrapper;
   iree_hal_allocator_t* device_allocator;
 
-  // Cache of the direct stream command buffer initialized when in stream mode.
-  // TODO: have one cached per stream once there are multiple streams.
-  iree_hal_command_buffer_t* stream_command_buffer;
+  // Device memory pools used for queue-ordered allocations.
+  // Empty if async allocations are disabled or unsupported by the device.
+  iree_hal_cuda_memory_pools_t memory_pools;
+
+  // Pinned staging memory for host transfers of non-mappable device buffers.
+  iree_hal_cuda_staging_buffer_t staging_buffer;
+
+  // Guards lazy loading of |nccl_syms| on first channel creation.
+  iree_slim_mutex_t nccl_mutex;
+  // NCCL symbols used by collective channels. Loaded on demand as NCCL is
+  // optional; |context_wrapper.nccl_syms| points here once loaded.
+  iree_hal_cuda_nccl_dynamic_symbols_t nccl_syms IREE_GUARDED_BY(nccl_mutex);
+
+  // Idle graph execs reused by graph command buffers of the same structure.
+  iree_hal_cuda_graph_exec_cache_t graph_exec_cache;
+
+  // Posted whenever the value of any semaphore created by the device changes.
+  iree_notification_t semaphore_notification;
+
+  // Queues exposed by the device, each with its own CUDA stream.
+  // Queue affinity bits map onto queues modulo the queue count.
+  iree_host_size_t queue_count;
+  iree_hal_cuda_queue_t queues[];
 } iree_hal_cuda_device_t;
 
 static const iree_hal_device_vtable_t iree_hal_cuda_device_vtable;
@@ -66,13 +136,31 @@ static iree_hal_cuda_device_t* iree_hal_cuda_device_cast(
   return (iree_hal_cuda_device_t*)base_value;
 }
 
+// Returns the queue that work with the given |queue_affinity| executes on.
+// The lowest set affinity bit selects the queue; bits beyond the queue count
+// wrap around so that any affinity is valid.
+static iree_hal_cuda_queue_t* iree_hal_cuda_device_select_queue(
+    iree_hal_cuda_device_t* device, iree_hal_queue_affinity_t queue_affinity) {
+  if (queue_affinity == IREE_HAL_QUEUE_AFFINITY_ANY || queue_affinity == 0) {
+    return &device->queues[0];
+  }
+  const int queue_ordinal = iree_math_count_trailing_zeros_u64(queue_affinity);
+  return &device->queues[queue_ordinal % device->queue_count];
+}
+
 void iree_hal_cuda_device_params_initialize(
     iree_hal_cuda_device_params_t* out_params) {
   memset(out_params, 0, sizeof(*out_params));
   out_params->arena_block_size = 32 * 1024;
   out_params->queue_count = 1;
   out_params->command_buffer_mode = IREE_HAL_CUDA_COMMAND_BUFFER_MODE_GRAPH;
+  out_params->graph_exec_cache_capacity = 16;
+  out_params->staging_chunk_size = 4 * 1024 * 1024;
   out_params->allow_inline_execution = false;
+  out_params->async_allocations = true;
+  out_params->lazy_executable_loading = false;
+  out_params->memory_pools.device_local.minimum_capacity = 0;
+  out_params->memory_pools.device_local.release_threshold = UINT64_MAX;
 }
 
 static iree_status_t iree_hal_cuda_device_check_params(
@@ -85,45 +173,97 @@ static iree_status_t iree_hal_cuda_device_check_params(
     return iree_make_status(IREE_STATUS_INVALID_ARGUMENT,
                             "at least one queue is required");
   }
+  if (params->queue_count > IREE_HAL_CUDA_MAX_QUEUE_COUNT) {
+    return iree_make_status(IREE_STATUS_INVALID_ARGUMENT,
+                            "at most %d queues are supported (%" PRIhsz
+                            " requested)",
+                            IREE_HAL_CUDA_MAX_QUEUE_COUNT, params->queue_count);
+  }
   return iree_ok_status();
 }
 
 static iree_status_t iree_hal_cuda_device_create_internal(
     iree_hal_driver_t* driver, iree_string_view_t identifier,
     const iree_hal_cuda_device_params_t* params, CUdevice cu_device,
-    CUstream stream, CUcontext context, iree_hal_cuda_dynamic_symbols_t* syms,
+    CUcontext context, iree_hal_cuda_dynamic_symbols_t* syms,
     iree_allocator_t host_allocator, iree_hal_device_t** out_device) {
   iree_hal_cuda_device_t* device = NULL;
-  iree_host_size_t total_size = iree_sizeof_struct(*device) + identifier.size;
-  IREE_RETURN_IF_ERROR(
-      iree_allocator_malloc(host_allocator, total_size, (void**)&device));
+  const iree_host_size_t queue_count = params->queue_count;
+  const iree_host_size_t queues_size = queue_count * sizeof(device->queues[0]);
+  iree_host_size_t total_size =
+      iree_sizeof_struct(*device) + queues_size + identifier.size;
+  iree_status_t status =
+      iree_allocator_malloc(host_allocator, total_size, (void**)&device);
+  if (!iree_status_is_ok(status)) {
+    syms->cuDevicePrimaryCtxRelease(cu_device);
+    return status;
+  }
   memset(device, 0, total_size);
   iree_hal_resource_initialize(&iree_hal_cuda_device_vtable, &device->resource);
   device->driver = driver;
   iree_hal_driver_retain(device->driver);
   iree_string_view_append_to_buffer(
       identifier, &device->identifier,
-      (char*)device + iree_sizeof_struct(*device));
+      (char*)device + iree_sizeof_struct(*device) + queues_size);
   device->params = *params;
   device->device = cu_device;
-  device->stream = stream;
   device->context_wrapper.cu_context = context;
   device->context_wrapper.host_allocator = host_allocator;
   iree_arena_block_pool_initialize(params->arena_block_size, host_allocator,
                                    &device->block_pool);
   device->context_wrapper.syms = syms;
+  iree_slim_mutex_initialize(&device->nccl_mutex);
+  iree_notification_initialize(&device->semaphore_notification);
+
+  // Create one stream per queue. Streams that fail to create are left NULL and
+  // skipped during destruction.
+  device->queue_count = queue_count;
+  for (iree_host_size_t i = 0; i < queue_count; ++i) {
+    iree_hal_cuda_queue_t* queue = &device->queues[i];
+    iree_slim_mutex_initialize(&queue->submission_mutex);
+    if (iree_status_is_ok(status)) {
+      status = CU_RESULT_TO_STATUS(
+          syms, cuStreamCreate(&queue->stream, CU_STREAM_NON_BLOCKING),
+          "cuStreamCreate");
+    }
+  }
 
-  iree_status_t status = iree_hal_cuda_allocator_create(
-      (iree_hal_device_t*)device, &device->context_wrapper, cu_device, stream,
-      &device->device_allocator);
+  // Create memory pools first so that the allocator can reference them.
+  if (iree_status_is_ok(status) && params->async_allocations) {
+    status = iree_hal_cuda_memory_pools_initialize(
+        &device->context_wrapper, cu_device, &params->memory_pools,
+        &device->memory_pools);
+  }
 
-  if (iree_status_is_ok(status) &&
-      params->command_buffer_mode == IREE_HAL_CUDA_COMMAND_BUFFER_MODE_STREAM) {
-    status = iree_hal_cuda_stream_command_buffer_create(
-        (iree_hal_device_t*)device, &device->context_wrapper,
-        IREE_HAL_COMMAND_BUFFER_MODE_ALLOW_INLINE_EXECUTION,
-        IREE_HAL_COMMAND_CATEGORY_ANY, /*binding_capacity=*/0, device->stream,
-        &device->block_pool, &device->stream_command_buffer);
+  if (iree_status_is_ok(status)) {
+    status = iree_hal_cuda_staging_buffer_initialize(
+        &device->context_wrapper, params->staging_chunk_size,
+        &device->staging_buffer);
+  }
+
+  if (iree_status_is_ok(status)) {
+    status = iree_hal_cuda_graph_exec_cache_initialize(
+        &device->context_wrapper, params->graph_exec_cache_capacity,
+        &device->graph_exec_cache);
+  }
+
+  if (iree_status_is_ok(status)) {
+    status = iree_hal_cuda_allocator_create(
+        (iree_hal_device_t*)device, &device->context_wrapper, cu_device,
+        device->queues[0].stream, &device->memory_pools,
+        &device->device_allocator);
+  }
+
+  if (params->command_buffer_mode == IREE_HAL_CUDA_COMMAND_BUFFER_MODE_STREAM) {
+    for (iree_host_size_t i = 0; i < queue_count && iree_status_is_ok(status);
+         ++i) {
+      iree_hal_cuda_queue_t* queue = &device->queues[i];
+      status = iree_hal_cuda_stream_command_buffer_create(
+          (iree_hal_device_t*)device, &device->context_wrapper,
+          IREE_HAL_COMMAND_BUFFER_MODE_ALLOW_INLINE_EXECUTION,
+          IREE_HAL_COMMAND_CATEGORY_ANY, /*binding_capacity=*/0, queue->stream,
+          &device->block_pool, &queue->stream_command_buffer);
+    }
   }
 
   if (iree_status_is_ok(status)) {
@@ -148,39 +288,68 @@ iree_status_t iree_hal_cuda_device_create(
       z0,
       CU_RESULT_TO_STATUS(syms, cuDevicePrimaryCtxRetain(&context, device)));
   iree_status_t status = CU_RESULT_TO_STATUS(syms, cuCtxSetCurrent(context));
-  CUstream stream;
-  if (iree_status_is_ok(status)) {
-    status = CU_RESULT_TO_STATUS(
-        syms, cuStreamCreate(&stream, CU_STREAM_NON_BLOCKING));
-  }
   if (iree_status_is_ok(status)) {
+    // NOTE: on failure the partially constructed device is destroyed and will
+    // release the primary context itself.
     status = iree_hal_cuda_device_create_internal(driver, identifier, params,
-                                                  device, stream, context, syms,
+                                                  device, context, syms,
                                                   host_allocator, out_device);
-  }
-  if (!iree_status_is_ok(status)) {
-    if (stream) {
-      syms->cuStreamDestroy(stream);
-    }
+  } else {
     syms->cuDevicePrimaryCtxRelease(device);
   }
   IREE_TRACE_ZONE_END(z0);
   return status;
 }
 
+static void iree_hal_cuda_queue_reclaim_submissions(
+    iree_hal_cuda_device_t* device, iree_hal_cuda_queue_t* queue, bool force);
+
 static void iree_hal_cuda_device_destroy(iree_hal_device_t* base_device) {
   iree_hal_cuda_device_t* device = iree_hal_cuda_device_cast(base_device);
   iree_allocator_t host_allocator = iree_hal_device_host_allocator(base_device);
   IREE_TRACE_ZONE_BEGIN(z0);
 
+  // Wait for all in-flight work to complete (including the host callbacks that
+  // signal semaphores) and release the resources it retained.
+  for (iree_host_size_t i = 0; i < device->queue_count; ++i) {
+    iree_hal_cuda_queue_t* queue = &device->queues[i];
+    if (!queue->stream) continue;
+    CUDA_IGNORE_ERROR(device->context_wrapper.syms,
+                      cuStreamSynchronize(queue->stream));
+    iree_hal_cuda_queue_reclaim_submissions(device, queue, /*force=*/true);
+    iree_hal_command_buffer_release(queue->stream_command_buffer);
+  }
+
   // There should be no more buffers live that use the allocator.
-  iree_hal_command_buffer_release(device->stream_command_buffer);
   iree_hal_allocator_release(device->device_allocator);
-  CUDA_IGNORE_ERROR(device->context_wrapper.syms,
-                    cuStreamDestroy(device->stream));
+
+  // All graph command buffers have been released and returned their execs.
+  iree_hal_cuda_graph_exec_cache_deinitialize(&device->graph_exec_cache);
+
+  iree_hal_cuda_staging_buffer_deinitialize(&device->staging_buffer);
+
+  // Destroy memory pools that hold on to reserved memory.
+  iree_hal_cuda_memory_pools_deinitialize(&device->memory_pools);
+
+  for (iree_host_size_t i = 0; i < device->queue_count; ++i) {
+    iree_hal_cuda_queue_t* queue = &device->queues[i];
+    if (queue->stream) {
+      CUDA_IGNORE_ERROR(device->context_wrapper.syms,
+                        cuStreamDestroy(queue->stream));
+    }
+    iree_slim_mutex_deinitialize(&queue->submission_mutex);
+  }
 
   iree_arena_block_pool_deinitialize(&device->block_pool);
 
+  iree_notification_deinitialize(&device->semaphore_notification);
+
+  // All channels have been released and no longer need NCCL.
+  if (device->context_wrapper.nccl_syms) {
+    iree_hal_cuda_nccl_dynamic_symbols_deinitialize(&device->nccl_syms);
+  }
+  iree_slim_mutex_deinitialize(&device->nccl_mutex);
+
   CUDA_IGNORE_ERROR(device->context_wrapper.syms,
                     cuDevicePrimaryCtxRelease(device->device));
 
@@ -213,7 +382,8 @@ static iree_hal_allocator_t* iree_hal_cuda_device_allocator(
 static iree_status_t iree_hal_cuda_device_trim(iree_hal_device_t* base_device) {
   iree_hal_cuda_device_t* device = iree_hal_cuda_device_cast(base_device);
   iree_arena_block_pool_trim(&device->block_pool);
-  return iree_hal_allocator_trim(device->device_allocator);
+  IREE_RETURN_IF_ERROR(iree_hal_allocator_trim(device->device_allocator));
+  return iree_hal_cuda_memory_pools_trim(&device->memory_pools);
 }
 
 static iree_status_t iree_hal_cuda_device_query_i64(
@@ -245,20 +415,32 @@ static bool iree_hal_cuda_nccl_id_is_empty(const iree_hal_cuda_nccl_id_t* id) {
   return true;
 }
 
+// Loads NCCL on first use. Fails with IREE_STATUS_UNAVAILABLE if NCCL cannot be
+// found, in which case the load will be retried on the next call.
+static iree_status_t iree_hal_cuda_device_ensure_nccl(
+    iree_hal_cuda_device_t* device) {
+  iree_status_t status = iree_ok_status();
+  iree_slim_mutex_lock(&device->nccl_mutex);
+  if (!device->context_wrapper.nccl_syms) {
+    status = iree_hal_cuda_nccl_dynamic_symbols_initialize(
+        device->context_wrapper.host_allocator, &device->nccl_syms);
+    if (iree_status_is_ok(status)) {
+      device->context_wrapper.nccl_syms = &device->nccl_syms;
+    }
+  }
+  iree_slim_mutex_unlock(&device->nccl_mutex);
+  return status;
+}
+
 static iree_status_t iree_hal_cuda_device_create_channel(
     iree_hal_device_t* base_device, iree_hal_queue_affinity_t queue_affinity,
     iree_hal_channel_params_t params, iree_hal_channel_t** out_channel) {
   iree_hal_cuda_device_t* device = iree_hal_cuda_device_cast(base_device);
 
-  // TODO(#9580): check if nccl symbols are available - if not then we fail
-  // here and have the error propagated up to users. If we wanted to delay load
-  // NCCL we'd want to take a lock here, load it, and merge the symbols into the
-  // dynamic symbol table.
-  if (true) {
-    return iree_make_status(
-        IREE_STATUS_UNIMPLEMENTED,
-        "NCCL unavailable and collective operations cannot be performed");
-  }
+  // NCCL is optional and loaded on demand; if unavailable the error propagates
+  // up to users and collective operations cannot be performed.
+  IREE_RETURN_IF_ERROR(iree_hal_cuda_device_ensure_nccl(device),
+                       "loading NCCL for collective channel creation");
 
   // Try to use the ID specified in the parameters and fall back to the default.
   iree_hal_cuda_nccl_id_t id;
@@ -317,6 +499,15 @@ static iree_status_t iree_hal_cuda_device_create_command_buffer(
     iree_hal_queue_affinity_t queue_affinity, iree_host_size_t binding_capacity,
     iree_hal_command_buffer_t** out_command_buffer) {
   iree_hal_cuda_device_t* device = iree_hal_cuda_device_cast(base_device);
+  if (iree_all_bits_set(mode, IREE_HAL_COMMAND_BUFFER_MODE_NESTED)) {
+    // Nested command buffers are recorded into a compact command list and
+    // replayed into the primary command buffer that executes them, resolving
+    // any indirect bindings against the binding table provided at that time.
+    return iree_hal_deferred_command_buffer_create(
+        base_device, mode, command_categories, binding_capacity,
+        &device->block_pool, iree_hal_device_host_allocator(base_device),
+        out_command_buffer);
+  }
   if (device->params.allow_inline_execution &&
       iree_all_bits_set(mode,
                         IREE_HAL_COMMAND_BUFFER_MODE_ALLOW_INLINE_EXECUTION)) {
@@ -324,9 +515,11 @@ static iree_status_t iree_hal_cuda_device_create_command_buffer(
     // recorded, implying that the command buffer cannot be reused and doesn't
     // need to be persisted. This lets us lower the execution delay as we can
     // directly route commands to a CUDA stream and let it eagerly flush.
+    iree_hal_cuda_queue_t* queue =
+        iree_hal_cuda_device_select_queue(device, queue_affinity);
     return iree_hal_cuda_stream_command_buffer_create(
         base_device, &device->context_wrapper, mode, command_categories,
-        binding_capacity, device->stream, &device->block_pool,
+        binding_capacity, queue->stream, &device->block_pool,
         out_command_buffer);
   }
   switch (device->params.command_buffer_mode) {
@@ -334,7 +527,7 @@ static iree_status_t iree_hal_cuda_device_create_command_buffer(
       return iree_hal_cuda_graph_command_buffer_create(
           base_device, &device->context_wrapper, mode, command_categories,
           queue_affinity, binding_capacity, &device->block_pool,
-          out_command_buffer);
+          &device->graph_exec_cache, out_command_buffer);
     case IREE_HAL_CUDA_COMMAND_BUFFER_MODE_STREAM:
       return iree_hal_deferred_command_buffer_create(
           base_device, mode, command_categories, binding_capacity,
@@ -368,8 +561,14 @@ static iree_status_t iree_hal_cuda_device_create_executable_cache(
     iree_hal_device_t* base_device, iree_string_view_t identifier,
     iree_loop_t loop, iree_hal_executable_cache_t** out_executable_cache) {
   iree_hal_cuda_device_t* device = iree_hal_cuda_device_cast(base_device);
+  iree_hal_cuda_native_executable_flags_t executable_flags =
+      IREE_HAL_CUDA_NATIVE_EXECUTABLE_FLAG_NONE;
+  if (device->params.lazy_executable_loading) {
+    executable_flags |= IREE_HAL_CUDA_NATIVE_EXECUTABLE_FLAG_LAZY_LOAD;
+  }
   return iree_hal_cuda_nop_executable_cache_create(
-      &device->context_wrapper, identifier, out_executable_cache);
+      &device->context_wrapper, identifier, executable_flags,
+      out_executable_cache);
 }
 
 static iree_status_t iree_hal_cuda_device_create_pipeline_layout(
@@ -387,17 +586,216 @@ static iree_status_t iree_hal_cuda_device_create_semaphore(
     iree_hal_device_t* base_device, uint64_t initial_value,
     iree_hal_semaphore_t** out_semaphore) {
   iree_hal_cuda_device_t* device = iree_hal_cuda_device_cast(base_device);
-  return iree_hal_cuda_semaphore_create(&device->context_wrapper, initial_value,
-                                        out_semaphore);
+  return iree_hal_cuda_semaphore_create(&device->context_wrapper,
+                                        &device->semaphore_notification,
+                                        initial_value, out_semaphore);
 }
 
 static iree_hal_semaphore_compatibility_t
 iree_hal_cuda_device_query_semaphore_compatibility(
     iree_hal_device_t* base_device, iree_hal_semaphore_t* semaphore) {
-  // TODO: implement CUDA semaphores.
+  if (iree_hal_cuda_semaphore_isa(semaphore)) {
+    // CUDA semaphores can be waited on and signaled by the device queue.
+    // TODO: verify the semaphore was created by a device sharing our context.
+    return IREE_HAL_SEMAPHORE_COMPATIBILITY_ALL;
+  }
   return IREE_HAL_SEMAPHORE_COMPATIBILITY_HOST_ONLY;
 }
 
+// Releases all resources retained by |submission| and frees it.
+static void iree_hal_cuda_submission_free(
+    iree_allocator_t host_allocator, iree_hal_cuda_submission_t* submission) {
+  for (iree_host_size_t i = 0; i < submission->signal_semaphore_list.count;
+       ++i) {
+    iree_hal_semaphore_release(
+        submission->signal_semaphore_list.semaphores[i]);
+  }
+  for (iree_host_size_t i = 0; i < submission->resource_count; ++i) {
+    iree_hal_resource_release(submission->resources[i]);
+  }
+  iree_allocator_free(host_allocator, submission);
+}
+
+// Stream host callback issued once the stream has reached the end of a
+// submission. CUDA APIs must not be called from here (including any that may
+// be reached by destroying resources) so we only signal and let the device
+// reclaim the submission later.
+static void CUDA_CB iree_hal_cuda_submission_complete(void* user_data) {
+  iree_hal_cuda_submission_t* submission =
+      (iree_hal_cuda_submission_t*)user_data;
+  IREE_TRACE_ZONE_BEGIN(z0);
+  for (iree_host_size_t i = 0; i < submission->signal_semaphore_list.count;
+       ++i) {
+    iree_hal_semaphore_t* semaphore =
+        submission->signal_semaphore_list.semaphores[i];
+    iree_status_t status = iree_hal_semaphore_signal(
+        semaphore, submission->signal_semaphore_list.payload_values[i]);
+    if (!iree_status_is_ok(status)) {
+      iree_hal_semaphore_fail(semaphore, status);
+    }
+  }
+  iree_atomic_store_int32(&submission->is_complete, 1,
+                          iree_memory_order_release);
+  IREE_TRACE_ZONE_END(z0);
+}
+
+// Reclaims all submissions that have completed on the |queue| stream.
+// If |force| is set all submissions are reclaimed regardless of their state;
+// this must only be used once the stream has been synchronized.
+static void iree_hal_cuda_queue_reclaim_submissions(
+    iree_hal_cuda_device_t* device, iree_hal_cuda_queue_t* queue, bool force) {
+  // Submissions complete in stream order so we only need to walk the head of
+  // the list until we find one that is still pending.
+  iree_slim_mutex_lock(&queue->submission_mutex);
+  iree_hal_cuda_submission_t* reclaim_head = queue->submission_head;
+  iree_hal_cuda_submission_t* reclaim_tail = NULL;
+  iree_hal_cuda_submission_t* submission = queue->submission_head;
+  while (submission &&
+         (force || iree_atomic_load_int32(&submission->is_complete,
+                                          iree_memory_order_acquire))) {
+    reclaim_tail = submission;
+    submission = submission->next;
+  }
+  if (reclaim_tail) {
+    reclaim_tail->next = NULL;
+    queue->submission_head = submission;
+    if (!submission) queue->submission_tail = NULL;
+  } else {
+    reclaim_head = NULL;
+  }
+  iree_slim_mutex_unlock(&queue->submission_mutex);
+
+  // Release resources outside of the lock as they may call back into us.
+  iree_allocator_t host_allocator = device->context_wrapper.host_allocator;
+  while (reclaim_head) {
+    iree_hal_cuda_submission_t* next = reclaim_head->next;
+    iree_hal_cuda_submission_free(host_allocator, reclaim_head);
+    reclaim_head = next;
+  }
+}
+
+// Reclaims completed submissions on all queues.
+static void iree_hal_cuda_device_reclaim_submissions(
+    iree_hal_cuda_device_t* device) {
+  for (iree_host_size_t i = 0; i < device->queue_count; ++i) {
+    iree_hal_cuda_queue_reclaim_submissions(device, &device->queues[i],
+                                            /*force=*/false);
+  }
+}
+
+// Makes the |queue| stream wait for all semaphores in |wait_semaphore_list|.
+// Semaphores that have a device signal pending (on any queue) are waited on by
+// the stream without involving the host. Anything else (foreign semaphores or
+// values that will only be reached by a host signal) is waited on the host.
+static iree_status_t iree_hal_cuda_queue_stream_wait(
+    iree_hal_cuda_queue_t* queue,
+    const iree_hal_semaphore_list_t wait_semaphore_list) {
+  for (iree_host_size_t i = 0; i < wait_semaphore_list.count; ++i) {
+    iree_hal_semaphore_t* semaphore = wait_semaphore_list.semaphores[i];
+    const uint64_t value = wait_semaphore_list.payload_values[i];
+    bool enqueued = false;
+    if (iree_hal_cuda_semaphore_isa(semaphore)) {
+      IREE_RETURN_IF_ERROR(iree_hal_cuda_semaphore_enqueue_wait(
+          semaphore, value, queue->stream, &enqueued));
+    }
+    if (!enqueued) {
+      // TODO: defer the submission to a host thread instead of blocking the
+      // caller when waiting on host signals that have not yet happened.
+      IREE_RETURN_IF_ERROR(
+          iree_hal_semaphore_wait(semaphore, value, iree_infinite_timeout()));
+    }
+  }
+  return iree_ok_status();
+}
+
+// Records device signals for all semaphores in |signal_semaphore_list| at the
+// current position of the |queue| stream and enqueues a host callback that
+// signals them on the host and releases |resources| once the stream reaches it.
+static iree_status_t iree_hal_cuda_queue_stream_signal(
+    iree_hal_cuda_device_t* device, iree_hal_cuda_queue_t* queue,
+    const iree_hal_semaphore_list_t signal_semaphore_list,
+    iree_host_size_t resource_count, iree_hal_resource_t* const* resources) {
+  if (signal_semaphore_list.count == 0 && resource_count == 0) {
+    return iree_ok_status();
+  }
+  IREE_TRACE_ZONE_BEGIN(z0);
+
+  // Record events so that other device waits can chain on the device.
+  for (iree_host_size_t i = 0; i < signal_semaphore_list.count; ++i) {
+    iree_hal_semaphore_t* semaphore = signal_semaphore_list.semaphores[i];
+    if (!iree_hal_cuda_semaphore_isa(semaphore)) continue;
+    IREE_RETURN_AND_END_ZONE_IF_ERROR(
+        z0, iree_hal_cuda_semaphore_enqueue_signal(
+                semaphore, signal_semaphore_list.payload_values[i],
+                queue->stream));
+  }
+
+  // Allocate the submission along with its lists in a single allocation.
+  iree_hal_cuda_submission_t* submission = NULL;
+  const iree_host_size_t total_size =
+      sizeof(*submission) +
+      signal_semaphore_list.count * sizeof(*signal_semaphore_list.semaphores) +
+      signal_semaphore_list.count *
+          sizeof(*signal_semaphore_list.payload_values) +
+      resource_count * sizeof(*resources);
+  IREE_RETURN_AND_END_ZONE_IF_ERROR(
+      z0, iree_allocator_malloc(device->context_wrapper.host_allocator,
+                                total_size, (void**)&submission));
+  uint8_t* ptr = (uint8_t*)submission + sizeof(*submission);
+  submission->next = NULL;
+  iree_atomic_store_int32(&submission->is_complete, 0,
+                          iree_memory_order_relaxed);
+  submission->signal_semaphore_list.count = signal_semaphore_list.count;
+  submission->signal_semaphore_list.semaphores = (iree_hal_semaphore_t**)ptr;
+  ptr +=
+      signal_semaphore_list.count * sizeof(*signal_semaphore_list.semaphores);
+  submission->signal_semaphore_list.payload_values = (uint64_t*)ptr;
+  ptr += signal_semaphore_list.count *
+         sizeof(*signal_semaphore_list.payload_values);
+  submission->resource_count = resource_count;
+  submission->resources = (iree_hal_resource_t**)ptr;
+  for (iree_host_size_t i = 0; i < signal_semaphore_list.count; ++i) {
+    submission->signal_semaphore_list.semaphores[i] =
+        signal_semaphore_list.semaphores[i];
+    iree_hal_semaphore_retain(signal_semaphore_list.semaphores[i]);
+    submission->signal_semaphore_list.payload_values[i] =
+        signal_semaphore_list.payload_values[i];
+  }
+  for (iree_host_size_t i = 0; i < resource_count; ++i) {
+    submission->resources[i] = resources[i];
+    iree_hal_resource_retain(resources[i]);
+  }
+
+  // Append to the in-flight list before launching as the callback may run
+  // immediately.
+  iree_slim_mutex_lock(&queue->submission_mutex);
+  if (queue->submission_tail) {
+    queue->submission_tail->next = submission;
+  } else {
+    queue->submission_head = submission;
+  }
+  queue->submission_tail = submission;
+  iree_slim_mutex_unlock(&queue->submission_mutex);
+
+  iree_status_t status =
+      CU_RESULT_TO_STATUS(device->context_wrapper.syms,
+                          cuLaunchHostFunc(queue->stream,
+                                           iree_hal_cuda_submission_complete,
+                                           submission),
+                          "cuLaunchHostFunc");
+  if (!iree_status_is_ok(status)) {
+    // The callback will never run: fail the semaphores so that waiters wake
+    // and let the submission be reclaimed.
+    iree_hal_semaphore_list_fail(signal_semaphore_list,
+                                 iree_status_clone(status));
+    iree_atomic_store_int32(&submission->is_complete, 1,
+                            iree_memory_order_release);
+  }
+
+  IREE_TRACE_ZONE_END(z0);
+  return status;
+}
+
 static iree_status_t iree_hal_cuda_device_queue_alloca(
     iree_hal_device_t* base_device, iree_hal_queue_affinity_t queue_affinity,
     const iree_hal_semaphore_list_t wait_semaphore_list,
@@ -405,14 +803,34 @@ static iree_status_t iree_hal_cuda_device_queue_alloca(
     iree_hal_allocator_pool_t pool, iree_hal_buffer_params_t params,
     iree_device_size_t allocation_size,
     iree_hal_buffer_t** IREE_RESTRICT out_buffer) {
-  // TODO(benvanik): queue-ordered allocations.
-  IREE_RETURN_IF_ERROR(iree_hal_semaphore_list_wait(wait_semaphore_list,
-                                                    iree_infinite_timeout()));
-  IREE_RETURN_IF_ERROR(iree_hal_allocator_allocate_buffer(
-      iree_hal_device_allocator(base_device), params, allocation_size,
-      iree_const_byte_span_empty(), out_buffer));
-  IREE_RETURN_IF_ERROR(iree_hal_semaphore_list_signal(signal_semaphore_list));
-  return iree_ok_status();
+  iree_hal_cuda_device_t* device = iree_hal_cuda_device_cast(base_device);
+  iree_hal_cuda_queue_t* queue =
+      iree_hal_cuda_device_select_queue(device, queue_affinity);
+  iree_hal_cuda_device_reclaim_submissions(device);
+
+  // Order the allocation after the waits on the device stream.
+  IREE_RETURN_IF_ERROR(
+      iree_hal_cuda_queue_stream_wait(queue, wait_semaphore_list));
+
+  // Allocate from the stream-ordered pools if possible; otherwise fall back to
+  // a synchronous allocation that is immediately available.
+  iree_status_t status = iree_ok_status();
+  if (iree_hal_cuda_memory_pools_can_allocate(&device->memory_pools, pool,
+                                              &params)) {
+    status = iree_hal_cuda_memory_pools_alloca(&device->memory_pools,
+                                               queue->stream, pool, params,
+                                               allocation_size, out_buffer);
+  } else {
+    status = iree_hal_allocator_allocate_buffer(
+        iree_hal_device_allocator(base_device), params, allocation_size,
+        iree_const_byte_span_empty(), out_buffer);
+  }
+
+  if (iree_status_is_ok(status)) {
+    status = iree_hal_cuda_queue_stream_signal(
+        device, queue, signal_semaphore_list, /*resource_count=*/0, NULL);
+  }
+  return status;
 }
 
 static iree_status_t iree_hal_cuda_device_queue_dealloca(
@@ -420,10 +838,22 @@ static iree_status_t iree_hal_cuda_device_queue_dealloca(
     const iree_hal_semaphore_list_t wait_semaphore_list,
     const iree_hal_semaphore_list_t signal_semaphore_list,
     iree_hal_buffer_t* buffer) {
-  // TODO(benvanik): queue-ordered allocations.
-  IREE_RETURN_IF_ERROR(iree_hal_device_queue_barrier(
-      base_device, queue_affinity, wait_semaphore_list, signal_semaphore_list));
-  return iree_ok_status();
+  iree_hal_cuda_device_t* device = iree_hal_cuda_device_cast(base_device);
+  iree_hal_cuda_queue_t* queue =
+      iree_hal_cuda_device_select_queue(device, queue_affinity);
+  iree_hal_cuda_device_reclaim_submissions(device);
+
+  // Order the deallocation after the waits on the device stream.
+  IREE_RETURN_IF_ERROR(
+      iree_hal_cuda_queue_stream_wait(queue, wait_semaphore_list));
+
+  // Buffers allocated from the pools are returned to them in stream order;
+  // anything else is freed when its last reference is released.
+  IREE_RETURN_IF_ERROR(iree_hal_cuda_memory_pools_dealloca(
+      &device->memory_pools, queue->stream, buffer));
+
+  return iree_hal_cuda_queue_stream_signal(
+      device, queue, signal_semaphore_list, /*resource_count=*/0, NULL);
 }
 
 static iree_status_t iree_hal_cuda_device_queue_execute(
@@ -433,31 +863,38 @@ static iree_status_t iree_hal_cuda_device_queue_execute(
     iree_host_size_t command_buffer_count,
     iree_hal_command_buffer_t* const* command_buffers) {
   iree_hal_cuda_device_t* device = iree_hal_cuda_device_cast(base_device);
+  iree_hal_cuda_queue_t* queue =
+      iree_hal_cuda_device_select_queue(device, queue_affinity);
+  iree_hal_cuda_device_reclaim_submissions(device);
+
+  // Order the execution after the waits on the device stream.
+  IREE_RETURN_IF_ERROR(
+      iree_hal_cuda_queue_stream_wait(queue, wait_semaphore_list));
+
   for (iree_host_size_t i = 0; i < command_buffer_count; i++) {
     iree_hal_command_buffer_t* command_buffer = command_buffers[i];
     if (iree_hal_cuda_stream_command_buffer_isa(command_buffer)) {
       // Nothing to do for an inline command buffer; all the work has already
-      // been submitted. When we support semaphores we'll still need to signal
-      // their completion but do not have to worry about any waits: if there
-      // were waits we wouldn't have been able to execute inline!
+      // been submitted. We still signal their completion below but do not have
+      // to worry about any waits: if there were waits we wouldn't have been
+      // able to execute inline!
     } else if (iree_hal_cuda_graph_command_buffer_isa(command_buffer)) {
       CUgraphExec exec =
           iree_hal_cuda_graph_command_buffer_handle(command_buffers[i]);
       CUDA_RETURN_IF_ERROR(device->context_wrapper.syms,
-                           cuGraphLaunch(exec, device->stream),
+                           cuGraphLaunch(exec, queue->stream),
                            "cuGraphLaunch");
     } else {
       IREE_RETURN_IF_ERROR(iree_hal_deferred_command_buffer_apply(
-          command_buffers[i], device->stream_command_buffer,
+          command_buffers[i], queue->stream_command_buffer,
           iree_hal_buffer_binding_table_empty()));
     }
   }
-  // TODO(thomasraoux): implement semaphores - for now this conservatively
-  // synchronizes after every submit.
-  CUDA_RETURN_IF_ERROR(device->context_wrapper.syms,
-                       cuStreamSynchronize(device->stream),
-                       "cuStreamSynchronize");
-  return iree_ok_status();
+  // Signal once the stream completes the command buffers and keep them live
+  // until then.
+  return iree_hal_cuda_queue_stream_signal(
+      device, queue, signal_semaphore_list, command_buffer_count,
+      (iree_hal_resource_t* const*)command_buffers);
 }
 
 static iree_status_t iree_hal_cuda_device_queue_flush(
@@ -469,8 +906,73 @@ static iree_status_t iree_hal_cuda_device_queue_flush(
 static iree_status_t iree_hal_cuda_device_wait_semaphores(
     iree_hal_device_t* base_device, iree_hal_wait_mode_t wait_mode,
     const iree_hal_semaphore_list_t semaphore_list, iree_timeout_t timeout) {
-  return iree_make_status(IREE_STATUS_UNIMPLEMENTED,
-                          "semaphore not implemented");
+  iree_hal_cuda_device_t* device = iree_hal_cuda_device_cast(base_device);
+  for (iree_host_size_t i = 0; i < semaphore_list.count; ++i) {
+    if (!iree_hal_cuda_semaphore_isa(semaphore_list.semaphores[i])) {
+      return iree_make_status(
+          IREE_STATUS_INVALID_ARGUMENT,
+          "only CUDA semaphores can be waited on by the CUDA device");
+    }
+  }
+  iree_status_t status = iree_hal_cuda_semaphore_multi_wait(
+      &device->semaphore_notification, wait_mode, semaphore_list, timeout);
+  iree_hal_cuda_device_reclaim_submissions(device);
+  return status;
+}
+
+// Returns a device pointer to |offset| in |buffer| if it is a CUDA buffer that
+// cannot be mapped into host memory and must be transferred through staging.
+// Returns 0 if the buffer should use the generic transfer path.
+static CUdeviceptr iree_hal_cuda_device_staged_transfer_pointer(
+    iree_hal_buffer_t* buffer, iree_device_size_t offset) {
+  if (iree_all_bits_set(iree_hal_buffer_memory_type(buffer),
+                        IREE_HAL_MEMORY_TYPE_HOST_VISIBLE) &&
+      iree_all_bits_set(iree_hal_buffer_allowed_usage(buffer),
+                        IREE_HAL_BUFFER_USAGE_MAPPING)) {
+    return 0;  // mappable
+  }
+  iree_hal_buffer_t* allocated_buffer =
+      iree_hal_buffer_allocated_buffer(buffer);
+  if (!iree_hal_cuda_buffer_isa(allocated_buffer)) return 0;
+  return iree_hal_cuda_buffer_device_pointer(allocated_buffer) +
+         iree_hal_buffer_byte_offset(buffer) + offset;
+}
+
+static iree_status_t iree_hal_cuda_device_transfer_range(
+    iree_hal_device_t* base_device, iree_hal_transfer_buffer_t source,
+    iree_device_size_t source_offset, iree_hal_transfer_buffer_t target,
+    iree_device_size_t target_offset, iree_device_size_t data_length,
+    iree_hal_transfer_buffer_flags_t flags, iree_timeout_t timeout) {
+  iree_hal_cuda_device_t* device = iree_hal_cuda_device_cast(base_device);
+
+  // Host<->device transfers of device buffers that cannot be mapped go through
+  // pinned staging memory in pipelined chunks. Everything else (mappable
+  // buffers and device<->device copies) uses the generic path.
+  if (data_length > 0 &&
+      iree_hal_cuda_staging_buffer_is_available(&device->staging_buffer)) {
+    if (!source.device_buffer && target.device_buffer) {
+      CUdeviceptr target_ptr = iree_hal_cuda_device_staged_transfer_pointer(
+          target.device_buffer, target_offset);
+      if (target_ptr) {
+        return iree_hal_cuda_staging_buffer_upload(
+            &device->staging_buffer,
+            (const uint8_t*)source.host_buffer.data + source_offset,
+            target_ptr, data_length);
+      }
+    } else if (source.device_buffer && !target.device_buffer) {
+      CUdeviceptr source_ptr = iree_hal_cuda_device_staged_transfer_pointer(
+          source.device_buffer, source_offset);
+      if (source_ptr) {
+        return iree_hal_cuda_staging_buffer_download(
+            &device->staging_buffer, source_ptr,
+            (uint8_t*)target.host_buffer.data + target_offset, data_length);
+      }
+    }
+  }
+
+  return iree_hal_device_submit_transfer_range_and_wait(
+      base_device, source, source_offset, target, target_offset, data_length,
+      flags, timeout);
 }
 
 static iree_status_t iree_hal_cuda_device_profiling_begin(
@@ -504,7 +1006,7 @@ static const iree_hal_device_vtable_t iree_hal_cuda_device_vtable = {
     .create_semaphore = iree_hal_cuda_device_create_semaphore,
     .query_semaphore_compatibility =
         iree_hal_cuda_device_query_semaphore_compatibility,
-    .transfer_range = iree_hal_device_submit_transfer_range_and_wait,
+    .transfer_range = iree_hal_cuda_device_transfer_range,
     .queue_alloca = iree_hal_cuda_device_queue_alloca,
     .queue_dealloca = iree_hal_cuda_device_queue_dealloca,
     .queue_execute = iree_hal_cuda_device_queue_execute,
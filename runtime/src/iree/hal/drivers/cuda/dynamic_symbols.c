@@ -35,7 +35,15 @@ static iree_status_t iree_hal_cuda_dynamic_symbols_resolve_all(
     iree_dynamic_library_lookup_symbol(syms->loader_library, kNameV2, &funV2); \
     if (funV2) syms->cudaSymbolName = funV2;                                   \
   }
+// Symbols whose _v2 variants have incompatible signatures are loaded as-is.
+#define CU_PFN_DECL_EXACT(cudaSymbolName, ...)                        \
+  {                                                                   \
+    static const char* kName = #cudaSymbolName;                       \
+    IREE_RETURN_IF_ERROR(iree_dynamic_library_lookup_symbol(          \
+        syms->loader_library, kName, (void**)&syms->cudaSymbolName)); \
+  }
 #include "iree/hal/drivers/cuda/dynamic_symbol_tables.h"  // IWYU pragma: keep
+#undef CU_PFN_DECL_EXACT
 #undef CU_PFN_DECL
   return iree_ok_status();
 }
@@ -72,3 +80,79 @@ void iree_hal_cuda_dynamic_symbols_deinitialize(
   memset(syms, 0, sizeof(*syms));
   IREE_TRACE_ZONE_END(z0);
 }
+
+//===----------------------------------------------------------------------===//
+// NCCL
+//===----------------------------------------------------------------------===//
+
+static const char* kNCCLLoaderSearchNames[] = {
+#if defined(IREE_PLATFORM_WINDOWS)
+    "nccl.dll",
+#else
+    "libnccl.so.2",
+    "libnccl.so",
+#endif
+};
+
+// Minimum NCCL version required: 2.10 adds ncclAvg and graph capture support.
+#define IREE_HAL_CUDA_NCCL_MINIMUM_VERSION (2 * 10000 + 10 * 100)
+
+static iree_status_t iree_hal_cuda_nccl_dynamic_symbols_resolve_all(
+    iree_hal_cuda_nccl_dynamic_symbols_t* syms) {
+#define NCCL_PFN_DECL(ncclSymbolName, ...)                            \
+  {                                                                   \
+    static const char* kName = #ncclSymbolName;                       \
+    IREE_RETURN_IF_ERROR(iree_dynamic_library_lookup_symbol(          \
+        syms->loader_library, kName, (void**)&syms->ncclSymbolName)); \
+  }
+#define NCCL_PFN_DECL_STR_RETURN(ncclSymbolName, ...) \
+  NCCL_PFN_DECL(ncclSymbolName, __VA_ARGS__)
+#include "iree/hal/drivers/cuda/nccl_dynamic_symbol_tables.h"  // IWYU pragma: keep
+#undef NCCL_PFN_DECL_STR_RETURN
+#undef NCCL_PFN_DECL
+  return iree_ok_status();
+}
+
+iree_status_t iree_hal_cuda_nccl_dynamic_symbols_initialize(
+    iree_allocator_t host_allocator,
+    iree_hal_cuda_nccl_dynamic_symbols_t* out_syms) {
+  IREE_TRACE_ZONE_BEGIN(z0);
+  memset(out_syms, 0, sizeof(*out_syms));
+  iree_status_t status = iree_dynamic_library_load_from_files(
+      IREE_ARRAYSIZE(kNCCLLoaderSearchNames), kNCCLLoaderSearchNames,
+      IREE_DYNAMIC_LIBRARY_FLAG_NONE, host_allocator,
+      &out_syms->loader_library);
+  if (iree_status_is_not_found(status)) {
+    iree_status_ignore(status);
+    IREE_TRACE_ZONE_END(z0);
+    return iree_make_status(
+        IREE_STATUS_UNAVAILABLE,
+        "NCCL runtime library not available; ensure installed and on path");
+  }
+  if (iree_status_is_ok(status)) {
+    status = iree_hal_cuda_nccl_dynamic_symbols_resolve_all(out_syms);
+  }
+  if (iree_status_is_ok(status)) {
+    int version = 0;
+    if (out_syms->ncclGetVersion(&version) != ncclSuccess ||
+        version < IREE_HAL_CUDA_NCCL_MINIMUM_VERSION) {
+      status = iree_make_status(IREE_STATUS_UNAVAILABLE,
+                                "NCCL version %d is too old; at least %d is "
+                                "required",
+                                version, IREE_HAL_CUDA_NCCL_MINIMUM_VERSION);
+    }
+  }
+  if (!iree_status_is_ok(status)) {
+    iree_hal_cuda_nccl_dynamic_symbols_deinitialize(out_syms);
+  }
+  IREE_TRACE_ZONE_END(z0);
+  return status;
+}
+
+void iree_hal_cuda_nccl_dynamic_symbols_deinitialize(
+    iree_hal_cuda_nccl_dynamic_symbols_t* syms) {
+  IREE_TRACE_ZONE_BEGIN(z0);
+  iree_dynamic_library_release(syms->loader_library);
+  memset(syms, 0, sizeof(*syms));
+  IREE_TRACE_ZONE_END(z0);
+}
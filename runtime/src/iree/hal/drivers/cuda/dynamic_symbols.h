@@ -10,6 +10,7 @@
 #include "iree/base/api.h"
 #include "iree/base/internal/dynamic_library.h"
 #include "iree/hal/drivers/cuda/cuda_headers.h"
+#include "iree/hal/drivers/cuda/nccl_headers.h"
 
 #ifdef __cplusplus
 extern "C" {
@@ -24,7 +25,10 @@ typedef struct iree_hal_cuda_dynamic_symbols_t {
 
 #define CU_PFN_DECL(cudaSymbolName, ...) \
   CUresult (*cudaSymbolName)(__VA_ARGS__);
+#define CU_PFN_DECL_EXACT(cudaSymbolName, ...) \
+  CU_PFN_DECL(cudaSymbolName, __VA_ARGS__)
 #include "iree/hal/drivers/cuda/dynamic_symbol_tables.h"  // IWYU pragma: export
+#undef CU_PFN_DECL_EXACT
 #undef CU_PFN_DECL
 } iree_hal_cuda_dynamic_symbols_t;
 
@@ -40,6 +44,33 @@ iree_status_t iree_hal_cuda_dynamic_symbols_initialize(
 void iree_hal_cuda_dynamic_symbols_deinitialize(
     iree_hal_cuda_dynamic_symbols_t* syms);
 
+// Dynamically loaded subset of the NCCL API used for collective operations.
+// NCCL is optional and only loaded when collective channels are created. All
+// functions declared in `nccl_dynamic_symbol_tables.h` must be available.
+typedef struct iree_hal_cuda_nccl_dynamic_symbols_t {
+  iree_dynamic_library_t* loader_library;
+
+#define NCCL_PFN_DECL(ncclSymbolName, ...) \
+  ncclResult_t (*ncclSymbolName)(__VA_ARGS__);
+#define NCCL_PFN_DECL_STR_RETURN(ncclSymbolName, ...) \
+  const char* (*ncclSymbolName)(__VA_ARGS__);
+#include "iree/hal/drivers/cuda/nccl_dynamic_symbol_tables.h"  // IWYU pragma: export
+#undef NCCL_PFN_DECL_STR_RETURN
+#undef NCCL_PFN_DECL
+} iree_hal_cuda_nccl_dynamic_symbols_t;
+
+// Initializes |out_syms| in-place with dynamically loaded NCCL symbols.
+// Returns IREE_STATUS_UNAVAILABLE if NCCL is not installed or too old.
+// iree_hal_cuda_nccl_dynamic_symbols_deinitialize must be used to release the
+// library resources.
+iree_status_t iree_hal_cuda_nccl_dynamic_symbols_initialize(
+    iree_allocator_t host_allocator,
+    iree_hal_cuda_nccl_dynamic_symbols_t* out_syms);
+
+// Deinitializes |syms| by unloading the backing library.
+void iree_hal_cuda_nccl_dynamic_symbols_deinitialize(
+    iree_hal_cuda_nccl_dynamic_symbols_t* syms);
+
 #ifdef __cplusplus
 }  // extern "C"
 #endif  // __cplusplus
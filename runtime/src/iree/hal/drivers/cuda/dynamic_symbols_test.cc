@@ -44,6 +44,24 @@ TEST(DynamicSymbolsTest, CreateFromSystemLoader) {
   iree_hal_cuda_dynamic_symbols_deinitialize(&symbols);
 }
 
+TEST(DynamicSymbolsTest, CreateNCCLFromSystemLoader) {
+  iree_hal_cuda_nccl_dynamic_symbols_t symbols;
+  iree_status_t status = iree_hal_cuda_nccl_dynamic_symbols_initialize(
+      iree_allocator_system(), &symbols);
+  if (!iree_status_is_ok(status)) {
+    iree_status_fprint(stderr, status);
+    iree_status_ignore(status);
+    std::cerr << "NCCL symbols cannot be loaded, skipping test.";
+    GTEST_SKIP();
+  }
+
+  int version = 0;
+  ASSERT_EQ(ncclSuccess, symbols.ncclGetVersion(&version));
+  EXPECT_GT(version, 0);
+
+  iree_hal_cuda_nccl_dynamic_symbols_deinitialize(&symbols);
+}
+
 }  // namespace
 }  // namespace cuda
 }  // namespace hal
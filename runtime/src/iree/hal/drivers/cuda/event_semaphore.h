@@ -10,6 +10,7 @@
 #include <stdint.h>
 
 #include "iree/base/api.h"
+#include "iree/base/internal/synchronization.h"
 #include "iree/hal/api.h"
 #include "iree/hal/drivers/cuda/context_wrapper.h"
 #include "iree/hal/drivers/cuda/status_util.h"
@@ -18,10 +19,43 @@
 extern "C" {
 #endif  // __cplusplus
 
-// Create a cuda allocator.
+// Creates a timeline semaphore that can be signaled and waited on both from the
+// host and from CUDA streams.
+//
+// Host signals and waits go through the semaphore payload value and the
+// device-owned |notification| that is posted whenever any semaphore created
+// with it changes. Device signals are represented by CUevents recorded on the
+// signaling stream that other streams can wait on with cuStreamWaitEvent; the
+// host payload value is advanced once the stream reaches the signal.
 iree_status_t iree_hal_cuda_semaphore_create(
-    iree_hal_cuda_context_wrapper_t* context, uint64_t initial_value,
-    iree_hal_semaphore_t** out_semaphore);
+    iree_hal_cuda_context_wrapper_t* context, iree_notification_t* notification,
+    uint64_t initial_value, iree_hal_semaphore_t** out_semaphore);
+
+// Returns true if |semaphore| is a CUDA semaphore.
+bool iree_hal_cuda_semaphore_isa(iree_hal_semaphore_t* semaphore);
+
+// Enqueues a wait on |stream| for |semaphore| to reach |value|.
+// If the value has already been reached nothing is enqueued. If a device signal
+// that will reach the value has been recorded then the stream will wait on its
+// event. Otherwise |out_enqueued| is set to false and the caller must wait on
+// the host as the value can only be reached by a future host signal.
+iree_status_t iree_hal_cuda_semaphore_enqueue_wait(
+    iree_hal_semaphore_t* semaphore, uint64_t value, CUstream stream,
+    bool* out_enqueued);
+
+// Records a device signal of |semaphore| to |value| at the current position in
+// |stream|. Subsequent iree_hal_cuda_semaphore_enqueue_wait calls will wait
+// for it on the device. The host payload value is not changed; the caller must
+// arrange to signal the semaphore on the host once |stream| reaches this point.
+iree_status_t iree_hal_cuda_semaphore_enqueue_signal(
+    iree_hal_semaphore_t* semaphore, uint64_t value, CUstream stream);
+
+// Performs a multi-wait on one or more CUDA semaphores sharing |notification|.
+// Returns IREE_STATUS_DEADLINE_EXCEEDED if the wait does not complete before
+// |timeout| elapses and IREE_STATUS_ABORTED if any semaphore failed.
+iree_status_t iree_hal_cuda_semaphore_multi_wait(
+    iree_notification_t* notification, iree_hal_wait_mode_t wait_mode,
+    const iree_hal_semaphore_list_t semaphore_list, iree_timeout_t timeout);
 
 #ifdef __cplusplus
 }  // extern "C"
@@ -19,15 +19,24 @@
 #include "iree/hal/drivers/cuda/pipeline_layout.h"
 #include "iree/hal/drivers/cuda/status_util.h"
 #include "iree/hal/utils/collective_batch.h"
+#include "iree/hal/utils/deferred_command_buffer.h"
 #include "iree/hal/utils/resource_set.h"
 
 #define IREE_HAL_CUDA_MAX_BINDING_COUNT 64
 // Kernel arguments contains binding and push constants.
 #define IREE_HAL_CUDA_MAX_KERNEL_ARG 128
+// Maximum number of nodes that may be recorded between two barriers. When
+// exceeded a barrier is implicitly inserted; this only adds false dependencies
+// and never drops required ones.
+#define IREE_HAL_CUDA_MAX_CONCURRENT_GRAPH_NODE_COUNT 32
 
 // Command buffer implementation that directly maps to cuda graph.
 // This records the commands on the calling thread without additional threading
 // indirection.
+//
+// Nodes recorded between two barriers have no edges between them and may
+// execute concurrently. Each barrier joins all nodes recorded since the prior
+// barrier and all subsequent nodes depend on that join.
 typedef struct iree_hal_cuda_graph_command_buffer_t {
   iree_hal_command_buffer_t base;
   iree_hal_cuda_context_wrapper_t* context;
@@ -41,16 +50,36 @@ typedef struct iree_hal_cuda_graph_command_buffer_t {
   // asynchronous operations.
   iree_arena_allocator_t arena;
 
+  // Cache the exec is acquired from when recording ends and returned to when
+  // the command buffer is destroyed.
+  iree_hal_cuda_graph_exec_cache_t* exec_cache;
+
   CUgraph graph;
   CUgraphExec exec;
 
-  // Keep track of the last node added to the command buffer as we are currently
-  // serializing all the nodes (each node depends on the previous one).
-  CUgraphNode last_node;
+  // Structural key of the recorded graph used to find compatible execs in the
+  // |exec_cache|. Only covers properties that cuGraphExecUpdate cannot change
+  // (topology, node types, kernel functions, etc); parameters such as buffer
+  // pointers and push constants are excluded so that they can be patched.
+  uint64_t graph_key;
+
+  // Node that all nodes recorded after the most recent barrier depend on.
+  // This is either the single node recorded prior to the barrier or an empty
+  // node joining all of them. NULL until the first barrier with prior nodes.
+  CUgraphNode barrier_node;
+
+  // Nodes recorded since the most recent barrier. These have no dependencies
+  // on each other and may execute concurrently.
+  CUgraphNode graph_nodes[IREE_HAL_CUDA_MAX_CONCURRENT_GRAPH_NODE_COUNT];
+  iree_host_size_t graph_node_count;
 
   // Iteratively constructed batch of collective operations.
   iree_hal_collective_batch_t collective_batch;
 
+  // Scratch stream used to capture collective operations into child graphs as
+  // NCCL only exposes stream-based APIs. Created on first use.
+  CUstream capture_stream;
+
   int32_t push_constant[IREE_HAL_CUDA_MAX_PUSH_CONSTANT_COUNT];
 
   // Keep track of the current set of kernel arguments.
@@ -72,16 +101,20 @@ iree_status_t iree_hal_cuda_graph_command_buffer_create(
     iree_hal_command_category_t command_categories,
     iree_hal_queue_affinity_t queue_affinity, iree_host_size_t binding_capacity,
     iree_arena_block_pool_t* block_pool,
+    iree_hal_cuda_graph_exec_cache_t* exec_cache,
     iree_hal_command_buffer_t** out_command_buffer) {
   IREE_ASSERT_ARGUMENT(context);
   IREE_ASSERT_ARGUMENT(block_pool);
+  IREE_ASSERT_ARGUMENT(exec_cache);
   IREE_ASSERT_ARGUMENT(out_command_buffer);
   *out_command_buffer = NULL;
 
   if (binding_capacity > 0) {
-    // TODO(#10144): support indirect command buffers with binding tables.
+    // Indirect command buffers are recorded as deferred command buffers by the
+    // device and replayed with resolved bindings when executed.
     return iree_make_status(IREE_STATUS_UNIMPLEMENTED,
-                            "indirect command buffers not yet implemented");
+                            "indirect graph command buffers are not supported; "
+                            "record as a deferred command buffer");
   }
 
   IREE_TRACE_ZONE_BEGIN(z0);
@@ -98,9 +131,13 @@ iree_status_t iree_hal_cuda_graph_command_buffer_create(
         &iree_hal_cuda_graph_command_buffer_vtable, &command_buffer->base);
     command_buffer->context = context;
     iree_arena_initialize(block_pool, &command_buffer->arena);
+    command_buffer->exec_cache = exec_cache;
     command_buffer->graph = NULL;
     command_buffer->exec = NULL;
-    command_buffer->last_node = NULL;
+    command_buffer->graph_key = 0;
+    command_buffer->barrier_node = NULL;
+    command_buffer->graph_node_count = 0;
+    command_buffer->capture_stream = NULL;
 
     CUdeviceptr* device_ptrs =
         (CUdeviceptr*)(command_buffer->current_descriptor +
@@ -142,11 +179,20 @@ static void iree_hal_cuda_graph_command_buffer_destroy(
     command_buffer->graph = NULL;
   }
   if (command_buffer->exec != NULL) {
-    CUDA_IGNORE_ERROR(command_buffer->context->syms,
-                      cuGraphExecDestroy(command_buffer->exec));
+    // Execution has completed as submissions retain the command buffer; the
+    // exec can be reused by future command buffers with the same structure.
+    iree_hal_cuda_graph_exec_cache_release(command_buffer->exec_cache,
+                                           command_buffer->graph_key,
+                                           command_buffer->exec);
     command_buffer->exec = NULL;
   }
-  command_buffer->last_node = NULL;
+  command_buffer->barrier_node = NULL;
+  command_buffer->graph_node_count = 0;
+  if (command_buffer->capture_stream != NULL) {
+    CUDA_IGNORE_ERROR(command_buffer->context->syms,
+                      cuStreamDestroy(command_buffer->capture_stream));
+    command_buffer->capture_stream = NULL;
+  }
 
   iree_hal_collective_batch_deinitialize(&command_buffer->collective_batch);
   iree_hal_resource_set_free(command_buffer->resource_set);
@@ -180,6 +226,95 @@ static void* iree_hal_cuda_graph_command_buffer_dyn_cast(
   return NULL;
 }
 
+// Mixes |value| into the structural key of the graph being recorded (FNV-1a).
+static void iree_hal_cuda_graph_command_buffer_mix_key(
+    iree_hal_cuda_graph_command_buffer_t* command_buffer, const void* value,
+    iree_host_size_t value_length) {
+  uint64_t key = command_buffer->graph_key;
+  for (iree_host_size_t i = 0; i < value_length; ++i) {
+    key ^= ((const uint8_t*)value)[i];
+    key *= 0x100000001B3ull;
+  }
+  command_buffer->graph_key = key;
+}
+
+// Identifies the type of a recorded node in the graph structural key.
+typedef enum iree_hal_cuda_graph_node_kind_e {
+  IREE_HAL_CUDA_GRAPH_NODE_KIND_BARRIER = 0,
+  IREE_HAL_CUDA_GRAPH_NODE_KIND_MEMSET,
+  IREE_HAL_CUDA_GRAPH_NODE_KIND_MEMCPY,
+  IREE_HAL_CUDA_GRAPH_NODE_KIND_KERNEL,
+  IREE_HAL_CUDA_GRAPH_NODE_KIND_COLLECTIVE,
+} iree_hal_cuda_graph_node_kind_t;
+
+// Mixes a node of |kind| with the given structural |params| into the key.
+static void iree_hal_cuda_graph_command_buffer_mix_node(
+    iree_hal_cuda_graph_command_buffer_t* command_buffer,
+    iree_hal_cuda_graph_node_kind_t kind, const void* params,
+    iree_host_size_t params_length) {
+  const uint32_t header[2] = {
+      (uint32_t)kind,
+      (uint32_t)command_buffer->graph_node_count,
+  };
+  iree_hal_cuda_graph_command_buffer_mix_key(command_buffer, header,
+                                             sizeof(header));
+  iree_hal_cuda_graph_command_buffer_mix_key(command_buffer, params,
+                                             params_length);
+}
+
+// Inserts a barrier such that all nodes recorded afterward depend on all nodes
+// recorded since the previous barrier.
+static iree_status_t iree_hal_cuda_graph_command_buffer_insert_barrier(
+    iree_hal_cuda_graph_command_buffer_t* command_buffer) {
+  // No nodes since the last barrier means the prior barrier (if any) still
+  // orders everything that follows.
+  if (command_buffer->graph_node_count == 0) return iree_ok_status();
+
+  iree_hal_cuda_graph_command_buffer_mix_node(
+      command_buffer, IREE_HAL_CUDA_GRAPH_NODE_KIND_BARRIER, NULL, 0);
+
+  // A single node can act as the barrier itself and avoid an empty node.
+  if (command_buffer->graph_node_count == 1) {
+    command_buffer->barrier_node = command_buffer->graph_nodes[0];
+    command_buffer->graph_node_count = 0;
+    return iree_ok_status();
+  }
+
+  CUDA_RETURN_IF_ERROR(
+      command_buffer->context->syms,
+      cuGraphAddEmptyNode(&command_buffer->barrier_node, command_buffer->graph,
+                          command_buffer->graph_nodes,
+                          command_buffer->graph_node_count),
+      "cuGraphAddEmptyNode");
+  command_buffer->graph_node_count = 0;
+  return iree_ok_status();
+}
+
+// Prepares for recording a new node and returns its dependencies.
+// The caller must add the node at the returned |out_node| slot and then call
+// iree_hal_cuda_graph_command_buffer_commit_node once it has been added.
+static iree_status_t iree_hal_cuda_graph_command_buffer_prepare_node(
+    iree_hal_cuda_graph_command_buffer_t* command_buffer,
+    CUgraphNode** out_node, const CUgraphNode** out_dependencies,
+    size_t* out_dependency_count) {
+  if (command_buffer->graph_node_count >=
+      IREE_HAL_CUDA_MAX_CONCURRENT_GRAPH_NODE_COUNT) {
+    IREE_RETURN_IF_ERROR(
+        iree_hal_cuda_graph_command_buffer_insert_barrier(command_buffer));
+  }
+  *out_node = &command_buffer->graph_nodes[command_buffer->graph_node_count];
+  *out_dependencies = &command_buffer->barrier_node;
+  *out_dependency_count = command_buffer->barrier_node ? 1 : 0;
+  return iree_ok_status();
+}
+
+// Commits the node added to the slot returned by
+// iree_hal_cuda_graph_command_buffer_prepare_node.
+static void iree_hal_cuda_graph_command_buffer_commit_node(
+    iree_hal_cuda_graph_command_buffer_t* command_buffer) {
+  ++command_buffer->graph_node_count;
+}
+
 // Flushes any pending batched collective operations.
 // Must be called before any other non-collective nodes are added to the graph
 // or a barrier is encountered.
@@ -193,28 +328,70 @@ static iree_status_t iree_hal_cuda_graph_command_buffer_flush_collectives(
     return iree_ok_status();
   }
   IREE_TRACE_ZONE_BEGIN(z0);
+  iree_hal_cuda_dynamic_symbols_t* syms = command_buffer->context->syms;
 
-  // TODO(#9580): use CUDA graph capture so that the NCCL calls end up in the
-  // graph:
+  // Capture the NCCL calls into a child graph as described in
   // https://docs.nvidia.com/deeplearning/nccl/user-guide/docs/usage/cudagraph.html
-  //
-  // Something like:
-  //  syms->cuStreamBeginCapture(nccl_stream);
-  //  iree_hal_cuda_nccl_submit_batch(command_buffer->context,
-  //                                  &command_buffer->collective_batch,
-  //                                  nccl_stream);
-  //  syms->cuStreamEndCapture(nccl_stream, &child_graph);
-  //  syms->cuGraphAddChildGraphNode(..., child_graph);
-  //  syms->cuGraphDestroy(child_graph);  // probably, I think it gets cloned
-  //
-  // Note that we'll want to create a scratch stream that we use to perform the
-  // capture - we could memoize that on the command buffer or on the device
-  // (though that introduces potential threading issues). There may be a special
-  // stream mode for these capture-only streams that is lighter weight than a
-  // normal stream.
-  iree_status_t status = iree_make_status(
-      IREE_STATUS_UNIMPLEMENTED,
-      "CUDA graph capture of collective operations not yet implemented");
+  // The capture stream never executes any work and is only used for recording.
+  iree_status_t status = iree_ok_status();
+  if (!command_buffer->capture_stream) {
+    status = CU_RESULT_TO_STATUS(
+        syms,
+        cuStreamCreate(&command_buffer->capture_stream, CU_STREAM_NON_BLOCKING),
+        "cuStreamCreate");
+  }
+  if (iree_status_is_ok(status)) {
+    status = CU_RESULT_TO_STATUS(
+        syms,
+        cuStreamBeginCapture(command_buffer->capture_stream,
+                             CU_STREAM_CAPTURE_MODE_THREAD_LOCAL),
+        "cuStreamBeginCapture");
+  }
+  CUgraph child_graph = NULL;
+  if (iree_status_is_ok(status)) {
+    status = iree_hal_cuda_nccl_submit_batch(command_buffer->context,
+                                             &command_buffer->collective_batch,
+                                             command_buffer->capture_stream);
+    // Capture must always be ended to return the stream to a usable state.
+    status = iree_status_join(
+        status, CU_RESULT_TO_STATUS(syms,
+                                    cuStreamEndCapture(
+                                        command_buffer->capture_stream,
+                                        &child_graph),
+                                    "cuStreamEndCapture"));
+  }
+
+  // Insert the captured graph as a node. The child graph is cloned into the
+  // parent and can be dropped immediately after.
+  if (iree_status_is_ok(status)) {
+    for (iree_host_size_t i = 0; i < command_buffer->collective_batch.count;
+         ++i) {
+      const iree_hal_collective_batch_entry_t* entry =
+          &command_buffer->collective_batch.entries[i];
+      const uint32_t collective_key[2] = {entry->op.packed, entry->param};
+      iree_hal_cuda_graph_command_buffer_mix_node(
+          command_buffer, IREE_HAL_CUDA_GRAPH_NODE_KIND_COLLECTIVE,
+          collective_key, sizeof(collective_key));
+    }
+    CUgraphNode* node = NULL;
+    const CUgraphNode* dependencies = NULL;
+    size_t dependency_count = 0;
+    status = iree_hal_cuda_graph_command_buffer_prepare_node(
+        command_buffer, &node, &dependencies, &dependency_count);
+    if (iree_status_is_ok(status)) {
+      status = CU_RESULT_TO_STATUS(
+          syms,
+          cuGraphAddChildGraphNode(node, command_buffer->graph, dependencies,
+                                   dependency_count, child_graph),
+          "cuGraphAddChildGraphNode");
+    }
+    if (iree_status_is_ok(status)) {
+      iree_hal_cuda_graph_command_buffer_commit_node(command_buffer);
+    }
+  }
+  if (child_graph) {
+    CUDA_IGNORE_ERROR(syms, cuGraphDestroy(child_graph));
+  }
 
   iree_hal_collective_batch_reset(&command_buffer->collective_batch);
   IREE_TRACE_ZONE_END(z0);
@@ -233,6 +410,7 @@ static iree_status_t iree_hal_cuda_graph_command_buffer_begin(
   }
 
   // Create a new empty graph to record into.
+  command_buffer->graph_key = 0xCBF29CE484222325ull;  // FNV-1a offset basis
   CUDA_RETURN_IF_ERROR(command_buffer->context->syms,
                        cuGraphCreate(&command_buffer->graph, /*flags=*/0),
                        "cuGraphCreate");
@@ -250,16 +428,13 @@ static iree_status_t iree_hal_cuda_graph_command_buffer_end(
       iree_hal_cuda_graph_command_buffer_flush_collectives(command_buffer));
 
   // Reset state used during recording.
-  command_buffer->last_node = NULL;
-
-  // Compile the graph.
-  CUgraphNode error_node = NULL;
-  iree_status_t status =
-      CU_RESULT_TO_STATUS(command_buffer->context->syms,
-                          cuGraphInstantiate(&command_buffer->exec,
-                                             command_buffer->graph, &error_node,
-                                             /*logBuffer=*/NULL,
-                                             /*bufferSize=*/0));
+  command_buffer->barrier_node = NULL;
+  command_buffer->graph_node_count = 0;
+
+  // Compile the graph or update an idle exec of the same structure.
+  iree_status_t status = iree_hal_cuda_graph_exec_cache_acquire(
+      command_buffer->exec_cache, command_buffer->graph_key,
+      command_buffer->graph, &command_buffer->exec);
   if (iree_status_is_ok(status)) {
     // No longer need the source graph used for construction.
     CUDA_IGNORE_ERROR(command_buffer->context->syms,
@@ -267,7 +442,7 @@ static iree_status_t iree_hal_cuda_graph_command_buffer_end(
     command_buffer->graph = NULL;
   }
 
-  return iree_ok_status();
+  return status;
 }
 
 static void iree_hal_cuda_graph_command_buffer_begin_debug_group(
@@ -296,10 +471,7 @@ static iree_status_t iree_hal_cuda_graph_command_buffer_execution_barrier(
   IREE_RETURN_IF_ERROR(
       iree_hal_cuda_graph_command_buffer_flush_collectives(command_buffer));
 
-  // TODO: Implement barrier with Graph edges. Right now all the nodes are
-  // serialized so this is a no-op.
-
-  return iree_ok_status();
+  return iree_hal_cuda_graph_command_buffer_insert_barrier(command_buffer);
 }
 
 static iree_status_t iree_hal_cuda_graph_command_buffer_signal_event(
@@ -310,8 +482,8 @@ static iree_status_t iree_hal_cuda_graph_command_buffer_signal_event(
   IREE_RETURN_IF_ERROR(
       iree_hal_cuda_graph_command_buffer_flush_collectives(command_buffer));
 
-  // TODO: Implement barrier with Graph edges. Right now all the nodes are
-  // serialized so this is a no-op.
+  // Events are only used to order work within the command buffer and graph
+  // edges already provide that: the matching wait_events inserts the barrier.
 
   return iree_ok_status();
 }
@@ -324,8 +496,8 @@ static iree_status_t iree_hal_cuda_graph_command_buffer_reset_event(
   IREE_RETURN_IF_ERROR(
       iree_hal_cuda_graph_command_buffer_flush_collectives(command_buffer));
 
-  // TODO: Implement barrier with Graph edges. Right now all the nodes are
-  // serialized so this is a no-op.
+  // Events are only used to order work within the command buffer and graph
+  // edges already provide that: the matching wait_events inserts the barrier.
 
   return iree_ok_status();
 }
@@ -344,10 +516,9 @@ static iree_status_t iree_hal_cuda_graph_command_buffer_wait_events(
   IREE_RETURN_IF_ERROR(
       iree_hal_cuda_graph_command_buffer_flush_collectives(command_buffer));
 
-  // TODO: Implement barrier with Graph edges. Right now all the nodes are
-  // serialized so this is a no-op.
-
-  return iree_ok_status();
+  // Conservatively treat the wait as a full barrier against all nodes recorded
+  // since the previous barrier. This is a superset of the event signal scopes.
+  return iree_hal_cuda_graph_command_buffer_insert_barrier(command_buffer);
 }
 
 static iree_status_t iree_hal_cuda_graph_command_buffer_discard_buffer(
@@ -405,15 +576,22 @@ static iree_status_t iree_hal_cuda_graph_command_buffer_fill_buffer(
       .height = 1,
       .value = dword_pattern,
   };
-  // Serialize all the nodes for now.
-  CUgraphNode dep[] = {command_buffer->last_node};
-  size_t numNode = command_buffer->last_node ? 1 : 0;
+  const uint32_t memset_key[1] = {(uint32_t)pattern_length};
+  iree_hal_cuda_graph_command_buffer_mix_node(
+      command_buffer, IREE_HAL_CUDA_GRAPH_NODE_KIND_MEMSET, memset_key,
+      sizeof(memset_key));
+  CUgraphNode* node = NULL;
+  const CUgraphNode* dependencies = NULL;
+  size_t dependency_count = 0;
+  IREE_RETURN_IF_ERROR(iree_hal_cuda_graph_command_buffer_prepare_node(
+      command_buffer, &node, &dependencies, &dependency_count));
   CUDA_RETURN_IF_ERROR(
       command_buffer->context->syms,
-      cuGraphAddMemsetNode(&command_buffer->last_node, command_buffer->graph,
-                           dep, numNode, &params,
+      cuGraphAddMemsetNode(node, command_buffer->graph, dependencies,
+                           dependency_count, &params,
                            command_buffer->context->cu_context),
       "cuGraphAddMemsetNode");
+  iree_hal_cuda_graph_command_buffer_commit_node(command_buffer);
 
   return iree_ok_status();
 }
@@ -453,17 +631,23 @@ static iree_status_t iree_hal_cuda_graph_command_buffer_update_buffer(
       .Height = 1,
       .Depth = 1,
   };
-
-  // Serialize all the nodes for now.
-  CUgraphNode dep[] = {command_buffer->last_node};
-  size_t numNode = command_buffer->last_node ? 1 : 0;
-
+  const uint32_t memcpy_key[2] = {params.srcMemoryType, params.dstMemoryType};
+  iree_hal_cuda_graph_command_buffer_mix_node(
+      command_buffer, IREE_HAL_CUDA_GRAPH_NODE_KIND_MEMCPY, memcpy_key,
+      sizeof(memcpy_key));
+
+  CUgraphNode* node = NULL;
+  const CUgraphNode* dependencies = NULL;
+  size_t dependency_count = 0;
+  IREE_RETURN_IF_ERROR(iree_hal_cuda_graph_command_buffer_prepare_node(
+      command_buffer, &node, &dependencies, &dependency_count));
   CUDA_RETURN_IF_ERROR(
       command_buffer->context->syms,
-      cuGraphAddMemcpyNode(&command_buffer->last_node, command_buffer->graph,
-                           dep, numNode, &params,
+      cuGraphAddMemcpyNode(node, command_buffer->graph, dependencies,
+                           dependency_count, &params,
                            command_buffer->context->cu_context),
       "cuGraphAddMemcpyNode");
+  iree_hal_cuda_graph_command_buffer_commit_node(command_buffer);
 
   return iree_ok_status();
 }
@@ -500,17 +684,23 @@ static iree_status_t iree_hal_cuda_graph_command_buffer_copy_buffer(
       .Height = 1,
       .Depth = 1,
   };
-
-  // Serialize all the nodes for now.
-  CUgraphNode dep[] = {command_buffer->last_node};
-  size_t numNode = command_buffer->last_node ? 1 : 0;
-
+  const uint32_t memcpy_key[2] = {params.srcMemoryType, params.dstMemoryType};
+  iree_hal_cuda_graph_command_buffer_mix_node(
+      command_buffer, IREE_HAL_CUDA_GRAPH_NODE_KIND_MEMCPY, memcpy_key,
+      sizeof(memcpy_key));
+
+  CUgraphNode* node = NULL;
+  const CUgraphNode* dependencies = NULL;
+  size_t dependency_count = 0;
+  IREE_RETURN_IF_ERROR(iree_hal_cuda_graph_command_buffer_prepare_node(
+      command_buffer, &node, &dependencies, &dependency_count));
   CUDA_RETURN_IF_ERROR(
       command_buffer->context->syms,
-      cuGraphAddMemcpyNode(&command_buffer->last_node, command_buffer->graph,
-                           dep, numNode, &params,
+      cuGraphAddMemcpyNode(node, command_buffer->graph, dependencies,
+                           dependency_count, &params,
                            command_buffer->context->cu_context),
       "cuGraphAddMemcpyNode");
+  iree_hal_cuda_graph_command_buffer_commit_node(command_buffer);
 
   return iree_ok_status();
 }
@@ -634,10 +824,12 @@ static iree_status_t iree_hal_cuda_graph_command_buffer_dispatch(
       executable, entry_point, &block_size_x, &block_size_y, &block_size_z));
   IREE_RETURN_IF_ERROR(iree_hal_cuda_native_executable_shared_memory_size(
       executable, entry_point, &shared_memory_size));
+  CUfunction func = NULL;
+  IREE_RETURN_IF_ERROR(iree_hal_cuda_native_executable_lookup_function(
+      executable, entry_point, &func));
 
   CUDA_KERNEL_NODE_PARAMS params = {
-      .func = iree_hal_cuda_native_executable_for_entry_point(executable,
-                                                              entry_point),
+      .func = func,
       .blockDimX = block_size_x,
       .blockDimY = block_size_y,
       .blockDimZ = block_size_z,
@@ -647,16 +839,22 @@ static iree_status_t iree_hal_cuda_graph_command_buffer_dispatch(
       .kernelParams = command_buffer->current_descriptor,
       .sharedMemBytes = shared_memory_size,
   };
-
-  // Serialize all the nodes for now.
-  CUgraphNode dep[] = {command_buffer->last_node};
-  size_t numNodes = command_buffer->last_node ? 1 : 0;
-
+  const void* kernel_key[1] = {params.func};
+  iree_hal_cuda_graph_command_buffer_mix_node(
+      command_buffer, IREE_HAL_CUDA_GRAPH_NODE_KIND_KERNEL, kernel_key,
+      sizeof(kernel_key));
+
+  CUgraphNode* node = NULL;
+  const CUgraphNode* dependencies = NULL;
+  size_t dependency_count = 0;
+  IREE_RETURN_IF_ERROR(iree_hal_cuda_graph_command_buffer_prepare_node(
+      command_buffer, &node, &dependencies, &dependency_count));
   CUDA_RETURN_IF_ERROR(
       command_buffer->context->syms,
-      cuGraphAddKernelNode(&command_buffer->last_node, command_buffer->graph,
-                           dep, numNodes, &params),
+      cuGraphAddKernelNode(node, command_buffer->graph, dependencies,
+                           dependency_count, &params),
       "cuGraphAddKernelNode");
+  iree_hal_cuda_graph_command_buffer_commit_node(command_buffer);
 
   return iree_ok_status();
 }
@@ -674,13 +872,36 @@ static iree_status_t iree_hal_cuda_graph_command_buffer_execute_commands(
     iree_hal_command_buffer_t* base_command_buffer,
     iree_hal_command_buffer_t* base_commands,
     iree_hal_buffer_binding_table_t binding_table) {
-  // TODO(#10144): support indirect command buffers by adding subgraph nodes and
-  // tracking the binding table for future cuGraphExecKernelNodeSetParams usage.
-  // Need to look into how to update the params of the subgraph nodes - is the
-  // graph exec the outer one and if so will it allow node handles from the
-  // subgraphs?
-  return iree_make_status(IREE_STATUS_UNIMPLEMENTED,
-                          "indirect command buffers not yet implemented");
+  iree_hal_cuda_graph_command_buffer_t* command_buffer =
+      iree_hal_cuda_graph_command_buffer_cast(base_command_buffer);
+  // Nested command buffers are recorded as deferred command buffers and
+  // replayed inline as nodes in this graph with their indirect bindings
+  // resolved against the provided binding table.
+  // TODO(#10144): add subgraph nodes and track the binding table for future
+  // cuGraphExecKernelNodeSetParams usage so that reissuing with a new table
+  // doesn't require replaying the commands.
+  if (!iree_hal_deferred_command_buffer_isa(base_commands)) {
+    return iree_make_status(IREE_STATUS_UNIMPLEMENTED,
+                            "only deferred nested command buffers are "
+                            "supported");
+  }
+
+  IREE_TRACE_ZONE_BEGIN(z0);
+  iree_status_t status = iree_hal_resource_set_insert(
+      command_buffer->resource_set, 1, &base_commands);
+  for (iree_host_size_t i = 0;
+       iree_status_is_ok(status) && i < binding_table.count; ++i) {
+    if (binding_table.bindings[i].buffer) {
+      status = iree_hal_resource_set_insert(
+          command_buffer->resource_set, 1, &binding_table.bindings[i].buffer);
+    }
+  }
+  if (iree_status_is_ok(status)) {
+    status = iree_hal_deferred_command_buffer_apply_commands(
+        base_commands, base_command_buffer, binding_table);
+  }
+  IREE_TRACE_ZONE_END(z0);
+  return status;
 }
 
 static const iree_hal_command_buffer_vtable_t
@@ -0,0 +1,82 @@
+// Copyright 2023 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#ifndef IREE_HAL_DRIVERS_CUDA_GRAPH_EXEC_CACHE_H_
+#define IREE_HAL_DRIVERS_CUDA_GRAPH_EXEC_CACHE_H_
+
+#include "iree/base/api.h"
+#include "iree/base/internal/synchronization.h"
+#include "iree/hal/drivers/cuda/context_wrapper.h"
+#include "iree/hal/drivers/cuda/cuda_headers.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif  // __cplusplus
+
+// An idle graph exec and the structural key of the graph it was instantiated
+// from.
+typedef struct iree_hal_cuda_graph_exec_cache_entry_t {
+  uint64_t key;
+  CUgraphExec exec;
+} iree_hal_cuda_graph_exec_cache_entry_t;
+
+// A cache of idle CUgraphExec instances from released graph command buffers.
+//
+// Instantiating a CUDA graph is expensive and in steady-state execution the
+// same command buffer structure is recorded over and over with only the kernel
+// parameters and buffer pointers differing. Instead of destroying the exec
+// when a command buffer is released it is returned to the cache and the next
+// command buffer with a matching structural key updates it in-place with
+// cuGraphExecUpdate. If the update is rejected by CUDA (the topology or node
+// types differ) the exec is dropped and a new one is instantiated.
+//
+// Execs in the cache are never in-flight: command buffers are retained by
+// their submissions and only release their exec once all execution completes.
+//
+// Thread-safe.
+typedef struct iree_hal_cuda_graph_exec_cache_t {
+  // CUDA context the execs are instantiated in.
+  iree_hal_cuda_context_wrapper_t* context;
+  // Maximum number of idle execs retained. 0 disables caching.
+  iree_host_size_t capacity;
+
+  iree_slim_mutex_t mutex;
+  // Number of valid entries in |entries|.
+  iree_host_size_t count IREE_GUARDED_BY(mutex);
+  // Idle execs ordered from least to most recently released.
+  iree_hal_cuda_graph_exec_cache_entry_t* entries IREE_GUARDED_BY(mutex);
+} iree_hal_cuda_graph_exec_cache_t;
+
+// Initializes |out_cache| to retain up to |capacity| idle graph execs.
+// A |capacity| of 0 disables caching and all acquisitions instantiate.
+iree_status_t iree_hal_cuda_graph_exec_cache_initialize(
+    iree_hal_cuda_context_wrapper_t* context, iree_host_size_t capacity,
+    iree_hal_cuda_graph_exec_cache_t* out_cache);
+
+// Deinitializes |cache| and destroys all idle execs.
+void iree_hal_cuda_graph_exec_cache_deinitialize(
+    iree_hal_cuda_graph_exec_cache_t* cache);
+
+// Acquires an executable instance of |graph|.
+// An idle exec with a matching structural |key| is updated in-place when
+// possible and otherwise a new exec is instantiated. The caller owns the
+// returned exec and must release it with iree_hal_cuda_graph_exec_cache_release
+// under the same |key|.
+iree_status_t iree_hal_cuda_graph_exec_cache_acquire(
+    iree_hal_cuda_graph_exec_cache_t* cache, uint64_t key, CUgraph graph,
+    CUgraphExec* out_exec);
+
+// Returns an idle |exec| that was instantiated from a graph with the given
+// structural |key| to the cache. The least recently released exec is destroyed
+// if the cache is full.
+void iree_hal_cuda_graph_exec_cache_release(
+    iree_hal_cuda_graph_exec_cache_t* cache, uint64_t key, CUgraphExec exec);
+
+#ifdef __cplusplus
+}  // extern "C"
+#endif  // __cplusplus
+
+#endif  // IREE_HAL_DRIVERS_CUDA_GRAPH_EXEC_CACHE_H_
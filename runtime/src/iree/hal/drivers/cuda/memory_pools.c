@@ -0,0 +1,280 @@
+// Copyright 2023 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include "iree/hal/drivers/cuda/memory_pools.h"
+
+#include "iree/base/tracing.h"
+#include "iree/hal/drivers/cuda/cuda_buffer.h"
+#include "iree/hal/drivers/cuda/dynamic_symbols.h"
+#include "iree/hal/drivers/cuda/status_util.h"
+
+#if IREE_TRACING_FEATURES & IREE_TRACING_FEATURE_ALLOCATION_TRACKING
+static const char* IREE_HAL_CUDA_DEVICE_LOCAL_POOL_RESERVED_ID =
+    "CUDA pool: device-local reserved";
+#endif  // IREE_TRACING_FEATURE_ALLOCATION_TRACKING
+
+static iree_status_t iree_hal_cuda_create_memory_pool(
+    iree_hal_cuda_context_wrapper_t* context, CUdevice cu_device,
+    iree_hal_cuda_memory_pool_params_t params,
+    CUmemoryPool* IREE_RESTRICT out_pool) {
+  *out_pool = NULL;
+
+  CUmemPoolProps pool_props = {
+      .allocType = CU_MEM_ALLOCATION_TYPE_PINNED,
+      // TODO: allow sharing of certain pool memory types by fd/HANDLE.
+      .handleTypes = CU_MEM_HANDLE_TYPE_NONE,
+      .location =
+          {
+              .type = CU_MEM_LOCATION_TYPE_DEVICE,
+              .id = cu_device,
+          },
+      .win32SecurityAttributes = NULL,
+      .reserved = {0},
+  };
+
+  CUmemoryPool pool = NULL;
+  CUDA_RETURN_IF_ERROR(context->syms, cuMemPoolCreate(&pool, &pool_props),
+                       "cuMemPoolCreate");
+
+  iree_status_t status = CU_RESULT_TO_STATUS(
+      context->syms,
+      cuMemPoolSetAttribute(pool, CU_MEMPOOL_ATTR_RELEASE_THRESHOLD,
+                            &params.release_threshold),
+      "cuMemPoolSetAttribute");
+
+  if (iree_status_is_ok(status)) {
+    *out_pool = pool;
+  } else {
+    CUDA_IGNORE_ERROR(context->syms, cuMemPoolDestroy(pool));
+  }
+  return status;
+}
+
+iree_status_t iree_hal_cuda_memory_pools_initialize(
+    iree_hal_cuda_context_wrapper_t* context, CUdevice cu_device,
+    const iree_hal_cuda_memory_pooling_params_t* pooling_params,
+    iree_hal_cuda_memory_pools_t* IREE_RESTRICT out_pools) {
+  IREE_ASSERT_ARGUMENT(context);
+  IREE_ASSERT_ARGUMENT(pooling_params);
+  IREE_ASSERT_ARGUMENT(out_pools);
+  IREE_TRACE_ZONE_BEGIN(z0);
+
+  memset(out_pools, 0, sizeof(*out_pools));
+  out_pools->context = context;
+  out_pools->device_local_minimum_capacity =
+      pooling_params->device_local.minimum_capacity;
+
+  // Memory pools are optional (CUDA 11.2+ and not all devices support them).
+  // If unsupported we leave the pools empty and callers fall back to
+  // synchronous allocation.
+  int supports_memory_pools = 0;
+  IREE_RETURN_AND_END_ZONE_IF_ERROR(
+      z0, CU_RESULT_TO_STATUS(
+              context->syms,
+              cuDeviceGetAttribute(&supports_memory_pools,
+                                   CU_DEVICE_ATTRIBUTE_MEMORY_POOLS_SUPPORTED,
+                                   cu_device),
+              "cuDeviceGetAttribute"));
+  if (!supports_memory_pools) {
+    IREE_TRACE_ZONE_APPEND_TEXT(z0, "no MEMORY_POOLS_SUPPORTED");
+    IREE_TRACE_ZONE_END(z0);
+    return iree_ok_status();
+  }
+
+  iree_status_t status = iree_hal_cuda_create_memory_pool(
+      context, cu_device, pooling_params->device_local,
+      &out_pools->device_local);
+
+  IREE_TRACE_ZONE_END(z0);
+  return status;
+}
+
+void iree_hal_cuda_memory_pools_deinitialize(
+    iree_hal_cuda_memory_pools_t* pools) {
+  IREE_TRACE_ZONE_BEGIN(z0);
+
+  if (pools->device_local) {
+    CUDA_IGNORE_ERROR(pools->context->syms,
+                      cuMemPoolDestroy(pools->device_local));
+    pools->device_local = NULL;
+  }
+
+  IREE_TRACE_ZONE_END(z0);
+}
+
+bool iree_hal_cuda_memory_pools_can_allocate(
+    const iree_hal_cuda_memory_pools_t* pools, iree_hal_allocator_pool_t pool,
+    const iree_hal_buffer_params_t* params) {
+  // TODO: route non-default |pool| values to additional CUmemoryPools. Today
+  // all pools alias the default device-local pool.
+  if (!pools->device_local) return false;
+  // Only device-local memory that the host never maps can come from the pools;
+  // everything else requires managed or host memory that the synchronous
+  // allocator handles.
+  return iree_all_bits_set(params->type, IREE_HAL_MEMORY_TYPE_DEVICE_LOCAL) &&
+         !iree_any_bit_set(params->type, IREE_HAL_MEMORY_TYPE_HOST_VISIBLE) &&
+         !iree_any_bit_set(params->usage, IREE_HAL_BUFFER_USAGE_MAPPING);
+}
+
+static void iree_hal_cuda_memory_pool_track_alloc(
+    iree_hal_cuda_memory_pools_t* pools, iree_hal_buffer_t* buffer) {
+  IREE_TRACE_ALLOC_NAMED(IREE_HAL_CUDA_DEVICE_LOCAL_POOL_RESERVED_ID,
+                         (void*)iree_hal_cuda_buffer_device_pointer(buffer),
+                         iree_hal_buffer_allocation_size(buffer));
+  IREE_STATISTICS({
+    iree_atomic_fetch_add_int64(&pools->statistics.device_bytes_allocated,
+                                iree_hal_buffer_allocation_size(buffer),
+                                iree_memory_order_relaxed);
+  });
+}
+
+static void iree_hal_cuda_memory_pool_track_free(
+    iree_hal_cuda_memory_pools_t* pools, iree_hal_buffer_t* buffer) {
+  IREE_TRACE_FREE_NAMED(IREE_HAL_CUDA_DEVICE_LOCAL_POOL_RESERVED_ID,
+                        (void*)iree_hal_cuda_buffer_device_pointer(buffer));
+  IREE_STATISTICS({
+    iree_atomic_fetch_add_int64(&pools->statistics.device_bytes_freed,
+                                iree_hal_buffer_allocation_size(buffer),
+                                iree_memory_order_relaxed);
+  });
+}
+
+void iree_hal_cuda_memory_pools_merge_statistics(
+    iree_hal_cuda_memory_pools_t* pools,
+    iree_hal_allocator_statistics_t* statistics) {
+  IREE_STATISTICS({
+    const iree_device_size_t device_bytes_allocated =
+        (iree_device_size_t)iree_atomic_load_int64(
+            &pools->statistics.device_bytes_allocated,
+            iree_memory_order_relaxed);
+    const iree_device_size_t device_bytes_freed =
+        (iree_device_size_t)iree_atomic_load_int64(
+            &pools->statistics.device_bytes_freed, iree_memory_order_relaxed);
+    statistics->device_bytes_allocated += device_bytes_allocated;
+    statistics->device_bytes_freed += device_bytes_freed;
+    statistics->device_bytes_peak = iree_max(
+        statistics->device_bytes_peak,
+        statistics->device_bytes_allocated - statistics->device_bytes_freed);
+  });
+}
+
+iree_status_t iree_hal_cuda_memory_pools_trim(
+    iree_hal_cuda_memory_pools_t* pools) {
+  if (!pools->device_local) return iree_ok_status();
+  CUDA_RETURN_IF_ERROR(pools->context->syms,
+                       cuMemPoolTrimTo(pools->device_local,
+                                       pools->device_local_minimum_capacity),
+                       "cuMemPoolTrimTo");
+  return iree_ok_status();
+}
+
+// NOTE: this is only called if the buffer was not already deallocated with
+// iree_hal_cuda_memory_pools_dealloca.
+static void iree_hal_cuda_async_buffer_release_callback(
+    void* user_data, iree_hal_buffer_t* buffer) {
+  iree_hal_cuda_memory_pools_t* pools =
+      (iree_hal_cuda_memory_pools_t*)user_data;
+  IREE_TRACE_ZONE_BEGIN(z0);
+
+  // The buffer does not know which stream work using it was enqueued on so we
+  // do a synchronous free; cuMemFree waits for any outstanding work.
+  CUdeviceptr device_ptr = iree_hal_cuda_buffer_device_pointer(buffer);
+  CUDA_IGNORE_ERROR(pools->context->syms, cuMemFree(device_ptr));
+  iree_hal_cuda_memory_pool_track_free(pools, buffer);
+
+  IREE_TRACE_ZONE_END(z0);
+}
+
+iree_status_t iree_hal_cuda_memory_pools_alloca(
+    iree_hal_cuda_memory_pools_t* pools, CUstream stream,
+    iree_hal_allocator_pool_t pool, iree_hal_buffer_params_t params,
+    iree_device_size_t allocation_size,
+    iree_hal_buffer_t** IREE_RESTRICT out_buffer) {
+  IREE_TRACE_ZONE_BEGIN(z0);
+  IREE_TRACE_ZONE_APPEND_VALUE(z0, (int64_t)allocation_size);
+
+  iree_hal_buffer_params_canonicalize(&params);
+
+  // Guard against the corner case where the requested buffer size is 0; the
+  // synchronous allocator does the same.
+  if (allocation_size == 0) allocation_size = 4;
+
+  // TODO: more pools and better selection; this is coarsely deciding between
+  // only device local (variables, constants, transients) and the synchronous
+  // allocator for anything else.
+  CUmemoryPool memory_pool = pools->device_local;
+
+  CUdeviceptr device_ptr = 0;
+  iree_status_t status = CU_RESULT_TO_STATUS(
+      pools->context->syms,
+      cuMemAllocFromPoolAsync(&device_ptr, (size_t)allocation_size,
+                              memory_pool, stream),
+      "cuMemAllocFromPoolAsync");
+
+  // Wrap the allocated CUDA buffer in a HAL buffer.
+  // NOTE: we don't provide a device allocator because we didn't allocate from
+  // one and instead use a release callback to perform the free if the user
+  // doesn't dealloca the buffer through the queue.
+  iree_hal_buffer_t* buffer = NULL;
+  if (iree_status_is_ok(status)) {
+    iree_hal_buffer_release_callback_t release_callback = {
+        .fn = iree_hal_cuda_async_buffer_release_callback,
+        .user_data = pools,
+    };
+    status = iree_hal_cuda_buffer_wrap(
+        /*allocator=*/NULL, params.type, params.access, params.usage,
+        allocation_size, /*byte_offset=*/0,
+        /*byte_length=*/allocation_size, IREE_HAL_CUDA_BUFFER_TYPE_ASYNC,
+        device_ptr, /*host_ptr=*/NULL, release_callback,
+        pools->context->host_allocator, &buffer);
+  }
+
+  if (iree_status_is_ok(status)) {
+    iree_hal_cuda_memory_pool_track_alloc(pools, buffer);
+    *out_buffer = buffer;
+  } else {
+    if (!buffer && device_ptr) {
+      CUDA_IGNORE_ERROR(pools->context->syms,
+                        cuMemFreeAsync(device_ptr, stream));
+    }
+    iree_hal_buffer_release(buffer);
+  }
+
+  IREE_TRACE_ZONE_END(z0);
+  return status;
+}
+
+iree_status_t iree_hal_cuda_memory_pools_dealloca(
+    iree_hal_cuda_memory_pools_t* pools, CUstream stream,
+    iree_hal_buffer_t* buffer) {
+  IREE_TRACE_ZONE_BEGIN(z0);
+  IREE_TRACE_ZONE_APPEND_VALUE(
+      z0, (int64_t)iree_hal_buffer_allocation_size(buffer));
+
+  // Only process the request if the buffer came from the pools. Other buffers
+  // are released via their normal lifetime management.
+  iree_hal_buffer_t* allocated_buffer =
+      iree_hal_buffer_allocated_buffer(buffer);
+  iree_status_t status = iree_ok_status();
+  if (iree_hal_cuda_buffer_isa(allocated_buffer) &&
+      iree_hal_cuda_buffer_type(allocated_buffer) ==
+          IREE_HAL_CUDA_BUFFER_TYPE_ASYNC) {
+    CUdeviceptr device_ptr =
+        iree_hal_cuda_buffer_device_pointer(allocated_buffer);
+    status = CU_RESULT_TO_STATUS(pools->context->syms,
+                                 cuMemFreeAsync(device_ptr, stream),
+                                 "cuMemFreeAsync");
+    if (iree_status_is_ok(status)) {
+      // The memory now belongs to the stream; drop the callback so that the
+      // buffer being released later doesn't double-free it.
+      iree_hal_cuda_buffer_drop_release_callback(allocated_buffer);
+      iree_hal_cuda_memory_pool_track_free(pools, allocated_buffer);
+    }
+  }
+
+  IREE_TRACE_ZONE_END(z0);
+  return status;
+}
@@ -0,0 +1,91 @@
+// Copyright 2023 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#ifndef IREE_HAL_DRIVERS_CUDA_MEMORY_POOLS_H_
+#define IREE_HAL_DRIVERS_CUDA_MEMORY_POOLS_H_
+
+#include "iree/base/api.h"
+#include "iree/base/internal/atomics.h"
+#include "iree/hal/api.h"
+#include "iree/hal/drivers/cuda/api.h"
+#include "iree/hal/drivers/cuda/context_wrapper.h"
+#include "iree/hal/drivers/cuda/cuda_headers.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif  // __cplusplus
+
+// WARNING: this API is currently only used for queue-ordered allocations
+// (iree_hal_device_queue_alloca/queue_dealloca) and must not be used for
+// synchronous allocations made through iree_hal_allocator_allocate_buffer.
+
+// Retained CUDA memory pools for various allocation types.
+typedef struct iree_hal_cuda_memory_pools_t {
+  // CUDA context the pools are attached to.
+  iree_hal_cuda_context_wrapper_t* context;
+  // Used exclusively for DEVICE_LOCAL allocations. NULL if the device does not
+  // support memory pools (CU_DEVICE_ATTRIBUTE_MEMORY_POOLS_SUPPORTED).
+  CUmemoryPool device_local;
+  // Minimum capacity retained in the device_local pool when trimming.
+  uint64_t device_local_minimum_capacity;
+
+  IREE_STATISTICS(struct {
+    iree_atomic_int64_t device_bytes_allocated;
+    iree_atomic_int64_t device_bytes_freed;
+  } statistics;)
+} iree_hal_cuda_memory_pools_t;
+
+// Initializes |out_pools| by configuring new CUDA memory pools on |cu_device|.
+// If the device does not support memory pools the pools will be left empty and
+// iree_hal_cuda_memory_pools_is_supported will return false.
+iree_status_t iree_hal_cuda_memory_pools_initialize(
+    iree_hal_cuda_context_wrapper_t* context, CUdevice cu_device,
+    const iree_hal_cuda_memory_pooling_params_t* pooling_params,
+    iree_hal_cuda_memory_pools_t* IREE_RESTRICT out_pools);
+
+// Deinitializes the |pools| and releases the underlying CUDA resources.
+void iree_hal_cuda_memory_pools_deinitialize(
+    iree_hal_cuda_memory_pools_t* pools);
+
+// Returns true if queue-ordered allocations with the given |params| can be
+// serviced by |pools|.
+bool iree_hal_cuda_memory_pools_can_allocate(
+    const iree_hal_cuda_memory_pools_t* pools, iree_hal_allocator_pool_t pool,
+    const iree_hal_buffer_params_t* params);
+
+// Merges statistics information from |pools| into |statistics|.
+void iree_hal_cuda_memory_pools_merge_statistics(
+    iree_hal_cuda_memory_pools_t* pools,
+    iree_hal_allocator_statistics_t* statistics);
+
+// Trims all memory pools by releasing resources back to the system down to
+// the configured minimum capacity.
+iree_status_t iree_hal_cuda_memory_pools_trim(
+    iree_hal_cuda_memory_pools_t* pools);
+
+// Asynchronously allocates a buffer from an appropriate pool.
+// The allocation will be stream-ordered on |stream| and any work enqueued after
+// it on the same stream may use the buffer.
+//
+// If the returned buffer is released without first being deallocated with
+// iree_hal_cuda_memory_pools_dealloca its memory is freed synchronously.
+iree_status_t iree_hal_cuda_memory_pools_alloca(
+    iree_hal_cuda_memory_pools_t* pools, CUstream stream,
+    iree_hal_allocator_pool_t pool, iree_hal_buffer_params_t params,
+    iree_device_size_t allocation_size,
+    iree_hal_buffer_t** IREE_RESTRICT out_buffer);
+
+// Asynchronously deallocates |buffer| on |stream|. The memory will be returned
+// to its pool once all work previously enqueued on |stream| has completed.
+iree_status_t iree_hal_cuda_memory_pools_dealloca(
+    iree_hal_cuda_memory_pools_t* pools, CUstream stream,
+    iree_hal_buffer_t* buffer);
+
+#ifdef __cplusplus
+}  // extern "C"
+#endif  // __cplusplus
+
+#endif  // IREE_HAL_DRIVERS_CUDA_MEMORY_POOLS_H_
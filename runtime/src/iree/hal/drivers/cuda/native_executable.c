@@ -7,8 +7,11 @@
 #include "iree/hal/drivers/cuda/native_executable.h"
 
 #include <stddef.h>
+#include <string.h>
 
 #include "iree/base/api.h"
+#include "iree/base/internal/atomics.h"
+#include "iree/base/internal/synchronization.h"
 #include "iree/base/tracing.h"
 #include "iree/hal/drivers/cuda/dynamic_symbols.h"
 #include "iree/hal/drivers/cuda/pipeline_layout.h"
@@ -20,7 +23,11 @@
 #include "iree/schemas/cuda_executable_def_verifier.h"
 
 typedef struct iree_hal_cuda_native_executable_function_t {
-  CUfunction cu_function;
+  // CUfunction of the entry point or 0 if it has not yet been resolved.
+  iree_atomic_intptr_t cu_function;
+  // NUL-terminated entry point name used to resolve the function lazily.
+  // Stored in the executable allocation and empty when loaded eagerly.
+  iree_string_view_t name;
   uint32_t block_size_x;
   uint32_t block_size_y;
   uint32_t block_size_z;
@@ -32,6 +39,12 @@ typedef struct iree_hal_cuda_native_executable_t {
   iree_hal_cuda_context_wrapper_t* context;
   iree_hal_pipeline_layout_t** pipeline_layouts;
   iree_host_size_t entry_count;
+  // Guards loading of |module| and resolution of entry functions when the
+  // executable is loaded lazily.
+  iree_slim_mutex_t mutex;
+  // NUL-terminated PTX image retained until |module| is loaded lazily.
+  // Stored in the executable allocation and empty when loaded eagerly.
+  iree_string_view_t ptx_image;
   CUmodule module;
   iree_hal_cuda_native_executable_function_t entry_functions[];
 } iree_hal_cuda_native_executable_t;
@@ -45,8 +58,130 @@ static iree_hal_cuda_native_executable_t* iree_hal_cuda_native_executable_cast(
   return (iree_hal_cuda_native_executable_t*)base_value;
 }
 
+// Verifies the structure of the FlatBuffer so that we can avoid doing so during
+// runtime. There are still some conditions we must be aware of (such as omitted
+// names on functions with internal linkage), however we shouldn't need to
+// bounds check anything within the FlatBuffer after this succeeds.
+static iree_status_t iree_hal_cuda_native_executable_flatbuffer_verify(
+    iree_const_byte_span_t flatbuffer_data,
+    iree_host_size_t expected_entry_point_count) {
+  if (!flatbuffer_data.data || flatbuffer_data.data_length < 16) {
+    return iree_make_status(
+        IREE_STATUS_INVALID_ARGUMENT,
+        "FlatBuffer data is not present or less than 16 bytes (%zu total)",
+        flatbuffer_data.data_length);
+  }
+
+  // Run flatcc generated verification. This ensures all pointers are in-bounds
+  // and that we can safely walk the file, but not that the actual contents of
+  // the FlatBuffer meet our expectations.
+  int verify_ret = iree_CUDAExecutableDef_verify_as_root(
+      flatbuffer_data.data, flatbuffer_data.data_length);
+  if (verify_ret != flatcc_verify_ok) {
+    return iree_make_status(IREE_STATUS_INVALID_ARGUMENT,
+                            "FlatBuffer verification failed: %s",
+                            flatcc_verify_error_string(verify_ret));
+  }
+
+  iree_CUDAExecutableDef_table_t executable_def =
+      iree_CUDAExecutableDef_as_root(flatbuffer_data.data);
+
+  flatbuffers_string_vec_t entry_points_vec =
+      iree_CUDAExecutableDef_entry_points_get(executable_def);
+  size_t entry_point_count = flatbuffers_string_vec_len(entry_points_vec);
+  if (entry_point_count != expected_entry_point_count) {
+    return iree_make_status(IREE_STATUS_FAILED_PRECONDITION,
+                            "executable provides %zu entry points but caller "
+                            "provided %zu; must match",
+                            entry_point_count, expected_entry_point_count);
+  }
+
+  for (size_t i = 0; i < entry_point_count; ++i) {
+    if (!flatbuffers_string_len(
+            flatbuffers_string_vec_at(entry_points_vec, i))) {
+      return iree_make_status(IREE_STATUS_INVALID_ARGUMENT,
+                              "executable entry point %zu has no name", i);
+    }
+  }
+
+  iree_CUDABlockSizeDef_vec_t block_sizes_vec =
+      iree_CUDAExecutableDef_block_sizes_get(executable_def);
+  size_t block_size_count = iree_CUDABlockSizeDef_vec_len(block_sizes_vec);
+  if (block_size_count != entry_point_count) {
+    return iree_make_status(
+        IREE_STATUS_INVALID_ARGUMENT,
+        "executable has %zu entry points but %zu block sizes are defined",
+        entry_point_count, block_size_count);
+  }
+
+  flatbuffers_uint32_vec_t shared_memory_sizes_vec =
+      iree_CUDAExecutableDef_shared_memory_size_get(executable_def);
+  size_t shared_memory_size_count =
+      flatbuffers_uint32_vec_len(shared_memory_sizes_vec);
+  if (shared_memory_size_count != entry_point_count) {
+    return iree_make_status(
+        IREE_STATUS_INVALID_ARGUMENT,
+        "executable has %zu entry points but %zu shared memory sizes are "
+        "defined",
+        entry_point_count, shared_memory_size_count);
+  }
+
+  if (!flatbuffers_string_len(
+          iree_CUDAExecutableDef_ptx_image_get(executable_def))) {
+    return iree_make_status(IREE_STATUS_INVALID_ARGUMENT,
+                            "executable PTX image is missing/empty");
+  }
+
+  return iree_ok_status();
+}
+
+// Loads the PTX |ptx_image| as the module of |executable|.
+// The driver JITs the PTX for the current device and caches the compiled
+// binary in its compute cache (see CUDA_CACHE_PATH/CUDA_CACHE_MAXSIZE) so
+// subsequent loads of the same PTX in any process skip compilation.
+static iree_status_t iree_hal_cuda_native_executable_load_module(
+    iree_hal_cuda_native_executable_t* executable, const char* ptx_image) {
+  IREE_TRACE_ZONE_BEGIN(z0);
+  iree_status_t status = CU_RESULT_TO_STATUS(
+      executable->context->syms,
+      cuModuleLoadDataEx(&executable->module, ptx_image, 0, NULL, NULL),
+      "cuModuleLoadDataEx");
+  IREE_TRACE_ZONE_END(z0);
+  return status;
+}
+
+// Resolves the CUfunction of |entry_point| named |entry_name| from the loaded
+// module of |executable| and configures its launch attributes.
+static iree_status_t iree_hal_cuda_native_executable_resolve_function(
+    iree_hal_cuda_native_executable_t* executable, iree_host_size_t entry_point,
+    const char* entry_name, CUfunction* out_function) {
+  iree_hal_cuda_native_executable_function_t* entry_function =
+      &executable->entry_functions[entry_point];
+  CUfunction function = NULL;
+  IREE_RETURN_IF_ERROR(CU_RESULT_TO_STATUS(
+      executable->context->syms,
+      cuModuleGetFunction(&function, executable->module, entry_name),
+      "cuModuleGetFunction"));
+  if (!function) {
+    return iree_make_status(IREE_STATUS_NOT_FOUND,
+                            "exported module function %s not found",
+                            entry_name);
+  }
+  IREE_RETURN_IF_ERROR(CU_RESULT_TO_STATUS(
+      executable->context->syms,
+      cuFuncSetAttribute(function,
+                         CU_FUNC_ATTRIBUTE_MAX_DYNAMIC_SHARED_SIZE_BYTES,
+                         entry_function->shared_memory_size),
+      "cuFuncSetAttribute"));
+  iree_atomic_store_intptr(&entry_function->cu_function, (intptr_t)function,
+                           iree_memory_order_release);
+  *out_function = function;
+  return iree_ok_status();
+}
+
 iree_status_t iree_hal_cuda_native_executable_create(
     iree_hal_cuda_context_wrapper_t* context,
+    iree_hal_cuda_native_executable_flags_t flags,
     const iree_hal_executable_params_t* executable_params,
     iree_hal_executable_t** out_executable) {
   IREE_ASSERT_ARGUMENT(context);
@@ -57,11 +192,14 @@ iree_status_t iree_hal_cuda_native_executable_create(
 
   iree_hal_cuda_native_executable_t* executable = NULL;
 
-  // TODO: Verify the flat buffer.
+  IREE_RETURN_AND_END_ZONE_IF_ERROR(
+      z0, iree_hal_cuda_native_executable_flatbuffer_verify(
+              executable_params->executable_data,
+              executable_params->pipeline_layout_count));
+
   iree_CUDAExecutableDef_table_t executable_def =
       iree_CUDAExecutableDef_as_root(executable_params->executable_data.data);
 
-  // Create the kernel module.
   flatbuffers_string_t ptx_image =
       iree_CUDAExecutableDef_ptx_image_get(executable_def);
   flatbuffers_uint32_vec_t shared_memory_sizes =
@@ -71,64 +209,89 @@ iree_status_t iree_hal_cuda_native_executable_create(
   iree_CUDABlockSizeDef_vec_t block_sizes_vec =
       iree_CUDAExecutableDef_block_sizes_get(executable_def);
   iree_host_size_t entry_count = flatbuffers_string_vec_len(entry_points_vec);
+
+  // The executable data is only valid for the duration of this call so when
+  // loading lazily the PTX image and entry point names are copied into the
+  // executable allocation for use on first dispatch.
+  const bool lazy_loading =
+      iree_all_bits_set(flags, IREE_HAL_CUDA_NATIVE_EXECUTABLE_FLAG_LAZY_LOAD);
+  iree_host_size_t string_storage_size = 0;
+  if (lazy_loading) {
+    string_storage_size += flatbuffers_string_len(ptx_image) + 1;
+    for (iree_host_size_t i = 0; i < entry_count; i++) {
+      flatbuffers_string_t entry_name =
+          flatbuffers_string_vec_at(entry_points_vec, i);
+      string_storage_size += flatbuffers_string_len(entry_name) + 1;
+    }
+  }
   iree_host_size_t total_size =
       sizeof(*executable) +
       entry_count * sizeof(iree_hal_cuda_native_executable_function_t) +
-      entry_count * sizeof(iree_hal_pipeline_layout_t*);
+      entry_count * sizeof(iree_hal_pipeline_layout_t*) + string_storage_size;
   iree_status_t status = iree_allocator_malloc(context->host_allocator,
                                                total_size, (void**)&executable);
-  CUmodule module = NULL;
   if (iree_status_is_ok(status)) {
     iree_hal_resource_initialize(&iree_hal_cuda_native_executable_vtable,
                                  &executable->resource);
-    executable->module = module;
     executable->context = context;
+    iree_slim_mutex_initialize(&executable->mutex);
+    executable->ptx_image = iree_string_view_empty();
+    executable->module = NULL;
 
     executable->pipeline_layouts =
         (void*)((char*)executable + sizeof(*executable) +
                 entry_count *
                     sizeof(iree_hal_cuda_native_executable_function_t));
-    status = CU_RESULT_TO_STATUS(
-        context->syms, cuModuleLoadDataEx(&module, ptx_image, 0, NULL, NULL),
-        "cuModuleLoadDataEx");
-  }
+    char* string_storage =
+        (char*)executable->pipeline_layouts +
+        entry_count * sizeof(iree_hal_pipeline_layout_t*);
 
-  if (iree_status_is_ok(status)) {
     executable->entry_count = entry_count;
     for (iree_host_size_t i = 0; i < entry_count; i++) {
-      CUfunction function = NULL;
-      const char* entry_name = flatbuffers_string_vec_at(entry_points_vec, i);
-      status = CU_RESULT_TO_STATUS(
-          context->syms, cuModuleGetFunction(&function, module, entry_name),
-          "cuModuleGetFunction");
-      if (!iree_status_is_ok(status)) break;
-      if (!function) {
-        status = iree_make_status(IREE_STATUS_NOT_FOUND,
-                                  "exported module function %s not found",
-                                  entry_name);
-        break;
-      }
-      status = CU_RESULT_TO_STATUS(
-          context->syms,
-          cuFuncSetAttribute(function,
-                             CU_FUNC_ATTRIBUTE_MAX_DYNAMIC_SHARED_SIZE_BYTES,
-                             shared_memory_sizes[i]),
-          "cuFuncSetAttribute");
-      if (!iree_status_is_ok(status)) break;
-      executable->entry_functions[i].cu_function = function;
-      executable->entry_functions[i].block_size_x = block_sizes_vec[i].x;
-      executable->entry_functions[i].block_size_y = block_sizes_vec[i].y;
-      executable->entry_functions[i].block_size_z = block_sizes_vec[i].z;
-      executable->entry_functions[i].shared_memory_size =
-          shared_memory_sizes[i];
+      iree_hal_cuda_native_executable_function_t* entry_function =
+          &executable->entry_functions[i];
+      iree_atomic_store_intptr(&entry_function->cu_function, 0,
+                               iree_memory_order_relaxed);
+      entry_function->name = iree_string_view_empty();
+      entry_function->block_size_x = block_sizes_vec[i].x;
+      entry_function->block_size_y = block_sizes_vec[i].y;
+      entry_function->block_size_z = block_sizes_vec[i].z;
+      entry_function->shared_memory_size = shared_memory_sizes[i];
       executable->pipeline_layouts[i] = executable_params->pipeline_layouts[i];
       iree_hal_pipeline_layout_retain(executable_params->pipeline_layouts[i]);
     }
+
+    if (lazy_loading) {
+      iree_host_size_t ptx_image_length = flatbuffers_string_len(ptx_image);
+      memcpy(string_storage, ptx_image, ptx_image_length + 1);
+      executable->ptx_image =
+          iree_make_string_view(string_storage, ptx_image_length);
+      string_storage += ptx_image_length + 1;
+      for (iree_host_size_t i = 0; i < entry_count; i++) {
+        flatbuffers_string_t entry_name =
+            flatbuffers_string_vec_at(entry_points_vec, i);
+        iree_host_size_t entry_name_length = flatbuffers_string_len(entry_name);
+        memcpy(string_storage, entry_name, entry_name_length + 1);
+        executable->entry_functions[i].name =
+            iree_make_string_view(string_storage, entry_name_length);
+        string_storage += entry_name_length + 1;
+      }
+    } else {
+      status =
+          iree_hal_cuda_native_executable_load_module(executable, ptx_image);
+      for (iree_host_size_t i = 0; i < entry_count; i++) {
+        if (!iree_status_is_ok(status)) break;
+        CUfunction function = NULL;
+        status = iree_hal_cuda_native_executable_resolve_function(
+            executable, i, flatbuffers_string_vec_at(entry_points_vec, i),
+            &function);
+      }
+    }
   }
 
   if (iree_status_is_ok(status)) {
     *out_executable = (iree_hal_executable_t*)executable;
-  } else {
+  } else if (executable) {
     iree_hal_executable_destroy((iree_hal_executable_t*)executable);
   }
 
@@ -143,19 +306,51 @@ static void iree_hal_cuda_native_executable_destroy(
   iree_allocator_t host_allocator = executable->context->host_allocator;
   IREE_TRACE_ZONE_BEGIN(z0);
 
+  if (executable->module) {
+    CUDA_IGNORE_ERROR(executable->context->syms,
+                      cuModuleUnload(executable->module));
+  }
   for (iree_host_size_t i = 0; i < executable->entry_count; ++i) {
     iree_hal_pipeline_layout_release(executable->pipeline_layouts[i]);
   }
+  iree_slim_mutex_deinitialize(&executable->mutex);
   iree_allocator_free(host_allocator, executable);
 
   IREE_TRACE_ZONE_END(z0);
 }
 
-CUfunction iree_hal_cuda_native_executable_for_entry_point(
-    iree_hal_executable_t* base_executable, int32_t entry_point) {
+iree_status_t iree_hal_cuda_native_executable_lookup_function(
+    iree_hal_executable_t* base_executable, int32_t entry_point,
+    CUfunction* out_function) {
   iree_hal_cuda_native_executable_t* executable =
       iree_hal_cuda_native_executable_cast(base_executable);
-  return executable->entry_functions[entry_point].cu_function;
+  iree_hal_cuda_native_executable_function_t* entry_function =
+      &executable->entry_functions[entry_point];
+  *out_function = (CUfunction)iree_atomic_load_intptr(
+      &entry_function->cu_function, iree_memory_order_acquire);
+  if (IREE_LIKELY(*out_function)) return iree_ok_status();
+
+  // First use of a lazily loaded entry point: the module is loaded on the
+  // first use of any of its entry points. Concurrent callers wait for the
+  // first to finish and then observe its result.
+  IREE_TRACE_ZONE_BEGIN(z0);
+  iree_slim_mutex_lock(&executable->mutex);
+  iree_status_t status = iree_ok_status();
+  *out_function = (CUfunction)iree_atomic_load_intptr(
+      &entry_function->cu_function, iree_memory_order_acquire);
+  if (!*out_function) {
+    if (!executable->module) {
+      status = iree_hal_cuda_native_executable_load_module(
+          executable, executable->ptx_image.data);
+    }
+    if (iree_status_is_ok(status)) {
+      status = iree_hal_cuda_native_executable_resolve_function(
+          executable, entry_point, entry_function->name.data, out_function);
+    }
+  }
+  iree_slim_mutex_unlock(&executable->mutex);
+  IREE_TRACE_ZONE_END(z0);
+  return status;
 }
 
 iree_status_t iree_hal_cuda_native_executable_block_size(
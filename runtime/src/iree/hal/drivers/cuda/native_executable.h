@@ -18,15 +18,29 @@
 extern "C" {
 #endif  // __cplusplus
 
+enum iree_hal_cuda_native_executable_flag_bits_t {
+  IREE_HAL_CUDA_NATIVE_EXECUTABLE_FLAG_NONE = 0u,
+  // Defers loading the PTX module and resolving entry point functions until
+  // an entry point is first dispatched. Avoids JIT compiling executables that
+  // are never used at the cost of latency (and errors) on first dispatch.
+  IREE_HAL_CUDA_NATIVE_EXECUTABLE_FLAG_LAZY_LOAD = 1u << 0,
+};
+typedef uint32_t iree_hal_cuda_native_executable_flags_t;
+
 // Creates an executable from a PTX module. The module may contain several
 // kernels that can be extracted along with the associated block size.
 iree_status_t iree_hal_cuda_native_executable_create(
     iree_hal_cuda_context_wrapper_t* context,
+    iree_hal_cuda_native_executable_flags_t flags,
     const iree_hal_executable_params_t* executable_params,
     iree_hal_executable_t** out_executable);
 
-CUfunction iree_hal_cuda_native_executable_for_entry_point(
-    iree_hal_executable_t* executable, int32_t entry_point);
+// Returns the CUfunction of the given |entry_point| within the executable.
+// Lazily loaded executables load their module and resolve the function on the
+// first lookup of an entry point; this is thread-safe.
+iree_status_t iree_hal_cuda_native_executable_lookup_function(
+    iree_hal_executable_t* executable, int32_t entry_point,
+    CUfunction* out_function);
 
 // Return the block size of the given |entry_point| within the executable.
 iree_status_t iree_hal_cuda_native_executable_block_size(
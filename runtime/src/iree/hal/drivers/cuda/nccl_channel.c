@@ -7,9 +7,12 @@
 #include "iree/hal/drivers/cuda/nccl_channel.h"
 
 #include <stddef.h>
+#include <string.h>
 
 #include "iree/base/api.h"
 #include "iree/base/tracing.h"
+#include "iree/hal/drivers/cuda/cuda_buffer.h"
+#include "iree/hal/drivers/cuda/status_util.h"
 
 // Returns the same value as NCCL's init.cc hashUniqueId.
 // These magic constants were chosen by their implementation and unlikely to
@@ -67,21 +70,32 @@ iree_status_t iree_hal_cuda_nccl_channel_create(
   IREE_TRACE_ZONE_APPEND_VALUE(z0, rank);
   IREE_TRACE_ZONE_APPEND_VALUE(z0, count);
 
-  // TODO(#9580): actually use nccl to create a communicator.
-  // Something like:
-  //  ncclConfig_t config = NCCL_CONFIG_INITIALIZER;
-  //  config.blocking = 0;
-  //  syms->ncclCommInitRankConfig(&comm, count, *id, rank, &config);
-  // NOTE: CHECK ERRORS! we can safely return here as we haven't allocated the
-  // channel wrapper yet.
-  ncclComm_t comm = NULL;
-  if (!comm) {
+  iree_hal_cuda_nccl_dynamic_symbols_t* nccl_syms = context_wrapper->nccl_syms;
+  if (!nccl_syms) {
     IREE_TRACE_ZONE_END(z0);
-    return iree_make_status(
-        IREE_STATUS_INTERNAL,
-        "failed to create NCCL communicator for rank=%d count=%d", rank, count);
+    return iree_make_status(IREE_STATUS_FAILED_PRECONDITION,
+                            "NCCL symbols not loaded");
   }
 
+  // NCCL uses the current CUDA context to select the device the communicator
+  // is bound to.
+  IREE_RETURN_AND_END_ZONE_IF_ERROR(
+      z0, CU_RESULT_TO_STATUS(context_wrapper->syms,
+                              cuCtxSetCurrent(context_wrapper->cu_context),
+                              "cuCtxSetCurrent"));
+
+  // NOTE: this blocks until all ranks have joined the communicator.
+  // We can safely return on failure as we haven't allocated the channel yet.
+  ncclUniqueId nccl_id;
+  static_assert(sizeof(nccl_id) == sizeof(*id), "NCCL ID size mismatch");
+  memcpy(&nccl_id, id->data, sizeof(nccl_id));
+  ncclComm_t comm = NULL;
+  IREE_RETURN_AND_END_ZONE_IF_ERROR(
+      z0, NCCL_RESULT_TO_STATUS(nccl_syms,
+                                ncclCommInitRank(&comm, count, nccl_id, rank),
+                                "ncclCommInitRank"),
+      "failed to create NCCL communicator for rank=%d count=%d", rank, count);
+
   iree_hal_cuda_nccl_channel_t* channel = NULL;
   iree_status_t status = iree_allocator_malloc(
       context_wrapper->host_allocator, sizeof(*channel), (void**)&channel);
@@ -94,6 +108,8 @@ iree_status_t iree_hal_cuda_nccl_channel_create(
     channel->count = count;
     channel->comm = comm;
     *out_channel = (iree_hal_channel_t*)channel;
+  } else {
+    NCCL_IGNORE_ERROR(nccl_syms, ncclCommDestroy(comm));
   }
 
   IREE_TRACE_ZONE_END(z0);
@@ -110,18 +126,12 @@ static void iree_hal_cuda_nccl_channel_destroy(
   IREE_TRACE_ZONE_APPEND_VALUE(z0, channel->rank);
   IREE_TRACE_ZONE_APPEND_VALUE(z0, channel->count);
 
-  // TODO(#9580): tear down nccl - blocking if needed.
-  // We could be smarter about starting finalization of all channels async and
-  // then waiting for them to complete but we aren't currently optimizing for
-  // lifetime performance. To do that we'd probably want to track each open
-  // channel on the device that created them and manage teardown there.
-  //
-  // Recommended:
-  //  syms->ncclCommFinalize(channel->comm);  // non-blocking!
-  //  while (ncclCommGetAsyncError == ncclInProgress) sleep(1);
-  //  syms->ncclCommDestroy(channel->comm)
-  // Should work the same (as we are doing a blocking teardown):
-  //  syms->ncclCommDestroy(channel->comm)
+  // NOTE: this is a blocking teardown that waits for any outstanding
+  // operations on the communicator to complete. We could be smarter about
+  // finalizing all channels asynchronously but we aren't currently optimizing
+  // for lifetime performance.
+  NCCL_IGNORE_ERROR(channel->context_wrapper->nccl_syms,
+                    ncclCommDestroy(channel->comm));
 
   iree_allocator_free(host_allocator, channel);
 
@@ -147,26 +157,183 @@ ncclComm_t iree_hal_cuda_nccl_channel_comm(iree_hal_channel_t* base_channel) {
   return channel->comm;
 }
 
+static iree_status_t iree_hal_cuda_nccl_get_data_type(
+    iree_hal_collective_element_type_t in, ncclDataType_t* out) {
+  switch (in) {
+    case IREE_HAL_COLLECTIVE_ELEMENT_TYPE_SINT_8:
+      *out = ncclInt8;
+      break;
+    case IREE_HAL_COLLECTIVE_ELEMENT_TYPE_UINT_8:
+      *out = ncclUint8;
+      break;
+    case IREE_HAL_COLLECTIVE_ELEMENT_TYPE_SINT_32:
+      *out = ncclInt32;
+      break;
+    case IREE_HAL_COLLECTIVE_ELEMENT_TYPE_UINT_32:
+      *out = ncclUint32;
+      break;
+    case IREE_HAL_COLLECTIVE_ELEMENT_TYPE_SINT_64:
+      *out = ncclInt64;
+      break;
+    case IREE_HAL_COLLECTIVE_ELEMENT_TYPE_UINT_64:
+      *out = ncclUint64;
+      break;
+    case IREE_HAL_COLLECTIVE_ELEMENT_TYPE_FLOAT_16:
+      *out = ncclFloat16;
+      break;
+    case IREE_HAL_COLLECTIVE_ELEMENT_TYPE_FLOAT_32:
+      *out = ncclFloat32;
+      break;
+    case IREE_HAL_COLLECTIVE_ELEMENT_TYPE_FLOAT_64:
+      *out = ncclFloat64;
+      break;
+    case IREE_HAL_COLLECTIVE_ELEMENT_TYPE_BFLOAT_16:
+      *out = ncclBfloat16;
+      break;
+    default:
+      return iree_make_status(IREE_STATUS_UNIMPLEMENTED,
+                              "unhandled element type for NCCL: %u", in);
+  }
+  return iree_ok_status();
+}
+
+static iree_status_t iree_hal_cuda_nccl_get_red_type(
+    iree_hal_collective_reduction_t in, ncclRedOp_t* out) {
+  switch (in) {
+    case IREE_HAL_COLLECTIVE_REDUCTION_SUM:
+      *out = ncclSum;
+      break;
+    case IREE_HAL_COLLECTIVE_REDUCTION_PRODUCT:
+      *out = ncclProd;
+      break;
+    case IREE_HAL_COLLECTIVE_REDUCTION_MINIMUM:
+      *out = ncclMin;
+      break;
+    case IREE_HAL_COLLECTIVE_REDUCTION_MAXIMUM:
+      *out = ncclMax;
+      break;
+    case IREE_HAL_COLLECTIVE_REDUCTION_AVERAGE:
+      *out = ncclAvg;
+      break;
+    default:
+      return iree_make_status(IREE_STATUS_UNIMPLEMENTED,
+                              "unhandled reduction type for NCCL: %u", in);
+  }
+  return iree_ok_status();
+}
+
+// Returns the device pointer of |binding| or 0 if the binding is unused.
+static CUdeviceptr iree_hal_cuda_nccl_binding_device_pointer(
+    iree_hal_buffer_binding_t binding) {
+  if (!binding.buffer) return 0;
+  return iree_hal_cuda_buffer_device_pointer(
+             iree_hal_buffer_allocated_buffer(binding.buffer)) +
+         iree_hal_buffer_byte_offset(binding.buffer) + binding.offset;
+}
+
+// Issues a single collective |entry| to |stream|.
+// Must be called between ncclGroupStart and ncclGroupEnd.
+static iree_status_t iree_hal_cuda_nccl_submit_entry(
+    iree_hal_cuda_nccl_dynamic_symbols_t* syms,
+    const iree_hal_collective_batch_entry_t* entry, CUstream stream) {
+  ncclComm_t comm = iree_hal_cuda_nccl_channel_comm(entry->channel);
+  ncclDataType_t data_type;
+  IREE_RETURN_IF_ERROR(
+      iree_hal_cuda_nccl_get_data_type(entry->op.element_type, &data_type));
+  const void* send_ptr =
+      (const void*)iree_hal_cuda_nccl_binding_device_pointer(
+          entry->send_binding);
+  void* recv_ptr =
+      (void*)iree_hal_cuda_nccl_binding_device_pointer(entry->recv_binding);
+  const size_t count = (size_t)entry->element_count;
+  switch (entry->op.kind) {
+    case IREE_HAL_COLLECTIVE_KIND_ALL_GATHER:
+      return NCCL_RESULT_TO_STATUS(
+          syms,
+          ncclAllGather(send_ptr, recv_ptr, count, data_type, comm, stream),
+          "ncclAllGather");
+    case IREE_HAL_COLLECTIVE_KIND_ALL_REDUCE: {
+      ncclRedOp_t red_op;
+      IREE_RETURN_IF_ERROR(
+          iree_hal_cuda_nccl_get_red_type(entry->op.reduction, &red_op));
+      return NCCL_RESULT_TO_STATUS(syms,
+                                   ncclAllReduce(send_ptr, recv_ptr, count,
+                                                 data_type, red_op, comm,
+                                                 stream),
+                                   "ncclAllReduce");
+    }
+    case IREE_HAL_COLLECTIVE_KIND_BROADCAST:
+      return NCCL_RESULT_TO_STATUS(
+          syms,
+          ncclBroadcast(send_ptr, recv_ptr, count, data_type,
+                        (int)entry->param, comm, stream),
+          "ncclBroadcast");
+    case IREE_HAL_COLLECTIVE_KIND_REDUCE: {
+      ncclRedOp_t red_op;
+      IREE_RETURN_IF_ERROR(
+          iree_hal_cuda_nccl_get_red_type(entry->op.reduction, &red_op));
+      return NCCL_RESULT_TO_STATUS(
+          syms,
+          ncclReduce(send_ptr, recv_ptr, count, data_type, red_op,
+                     (int)entry->param, comm, stream),
+          "ncclReduce");
+    }
+    case IREE_HAL_COLLECTIVE_KIND_REDUCE_SCATTER: {
+      ncclRedOp_t red_op;
+      IREE_RETURN_IF_ERROR(
+          iree_hal_cuda_nccl_get_red_type(entry->op.reduction, &red_op));
+      return NCCL_RESULT_TO_STATUS(syms,
+                                   ncclReduceScatter(send_ptr, recv_ptr, count,
+                                                     data_type, red_op, comm,
+                                                     stream),
+                                   "ncclReduceScatter");
+    }
+    case IREE_HAL_COLLECTIVE_KIND_SEND:
+      return NCCL_RESULT_TO_STATUS(
+          syms,
+          ncclSend(send_ptr, count, data_type, (int)entry->param, comm, stream),
+          "ncclSend");
+    case IREE_HAL_COLLECTIVE_KIND_RECV:
+      return NCCL_RESULT_TO_STATUS(
+          syms,
+          ncclRecv(recv_ptr, count, data_type, (int)entry->param, comm, stream),
+          "ncclRecv");
+    default:
+      return iree_make_status(IREE_STATUS_UNIMPLEMENTED,
+                              "unhandled collective kind %u", entry->op.kind);
+  }
+}
+
 iree_status_t iree_hal_cuda_nccl_submit_batch(
     iree_hal_cuda_context_wrapper_t* context,
     const iree_hal_collective_batch_t* batch, CUstream stream) {
   IREE_ASSERT_ARGUMENT(context);
   IREE_ASSERT_ARGUMENT(batch);
   IREE_ASSERT_ARGUMENT(stream);
+  if (!context->nccl_syms) {
+    return iree_make_status(IREE_STATUS_FAILED_PRECONDITION,
+                            "NCCL symbols not loaded");
+  }
+  IREE_TRACE_ZONE_BEGIN(z0);
+  IREE_TRACE_ZONE_APPEND_VALUE(z0, batch->count);
+  iree_hal_cuda_nccl_dynamic_symbols_t* syms = context->nccl_syms;
+
+  // All operations in the batch are grouped so that NCCL can fuse them and so
+  // that point-to-point sends/recvs between ranks don't deadlock. Note that
+  // the channel may change between ops.
+  IREE_RETURN_AND_END_ZONE_IF_ERROR(
+      z0, NCCL_RESULT_TO_STATUS(syms, ncclGroupStart(), "ncclGroupStart"));
+  iree_status_t status = iree_ok_status();
+  for (iree_host_size_t i = 0; i < batch->count && iree_status_is_ok(status);
+       ++i) {
+    status = iree_hal_cuda_nccl_submit_entry(syms, &batch->entries[i], stream);
+  }
+  // The group must always be ended even if an operation failed to enqueue.
+  status = iree_status_join(
+      status, NCCL_RESULT_TO_STATUS(syms, ncclGroupEnd(), "ncclGroupEnd"));
 
-  // TODO(#9580): issue the operations in the batch. Note that the channel may
-  // change between ops and the communicator should be retrieved from each.
-  //
-  // Something like:
-  //  make context->cu_context active (for when using multiple devices)
-  //  syms->ncclGroupStart();
-  //  for each entry in batch:
-  //    ncclComm_t comm = iree_hal_cuda_nccl_channel_comm(entry->channel);
-  //    syms->nccl*(comm, ...);
-  //  syms->ncclGroupEnd();
-
-  return iree_make_status(IREE_STATUS_UNIMPLEMENTED,
-                          "NCCL submission not yet implemented");
+  IREE_TRACE_ZONE_END(z0);
+  return status;
 }
 
 static const iree_hal_channel_vtable_t iree_hal_cuda_nccl_channel_vtable = {
@@ -12,6 +12,7 @@
 #include "iree/hal/drivers/cuda/api.h"
 #include "iree/hal/drivers/cuda/context_wrapper.h"
 #include "iree/hal/drivers/cuda/cuda_headers.h"
+#include "iree/hal/drivers/cuda/nccl_headers.h"
 #include "iree/hal/utils/collective_batch.h"
 
 #ifdef __cplusplus
@@ -19,8 +20,8 @@ extern "C" {
 #endif  // __cplusplus
 
 // Creates a new NCCL communicator channel.
-typedef struct ncclComm* ncclComm_t;
-
+// |context_wrapper| must have NCCL symbols loaded. This is a blocking
+// operation that returns once all |count| participants have joined.
 iree_status_t iree_hal_cuda_nccl_channel_create(
     iree_hal_cuda_context_wrapper_t* context_wrapper,
     const iree_hal_cuda_nccl_id_t* id, int rank, int count,
@@ -0,0 +1,28 @@
+// Copyright 2023 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+NCCL_PFN_DECL(ncclGetVersion, int*)
+NCCL_PFN_DECL(ncclGetUniqueId, ncclUniqueId*)
+NCCL_PFN_DECL(ncclCommInitRank, ncclComm_t*, int, ncclUniqueId, int)
+NCCL_PFN_DECL(ncclCommDestroy, ncclComm_t)
+NCCL_PFN_DECL(ncclCommGetAsyncError, ncclComm_t, ncclResult_t*)
+NCCL_PFN_DECL_STR_RETURN(ncclGetErrorString, ncclResult_t)
+NCCL_PFN_DECL(ncclGroupStart, void)
+NCCL_PFN_DECL(ncclGroupEnd, void)
+NCCL_PFN_DECL(ncclAllGather, const void*, void*, size_t, ncclDataType_t,
+              ncclComm_t, CUstream)
+NCCL_PFN_DECL(ncclAllReduce, const void*, void*, size_t, ncclDataType_t,
+              ncclRedOp_t, ncclComm_t, CUstream)
+NCCL_PFN_DECL(ncclBroadcast, const void*, void*, size_t, ncclDataType_t, int,
+              ncclComm_t, CUstream)
+NCCL_PFN_DECL(ncclReduce, const void*, void*, size_t, ncclDataType_t,
+              ncclRedOp_t, int, ncclComm_t, CUstream)
+NCCL_PFN_DECL(ncclReduceScatter, const void*, void*, size_t, ncclDataType_t,
+              ncclRedOp_t, ncclComm_t, CUstream)
+NCCL_PFN_DECL(ncclSend, const void*, size_t, ncclDataType_t, int, ncclComm_t,
+              CUstream)
+NCCL_PFN_DECL(ncclRecv, void*, size_t, ncclDataType_t, int, ncclComm_t,
+              CUstream)
@@ -16,6 +16,7 @@
 typedef struct iree_hal_cuda_nop_executable_cache_t {
   iree_hal_resource_t resource;
   iree_hal_cuda_context_wrapper_t* context;
+  iree_hal_cuda_native_executable_flags_t executable_flags;
 } iree_hal_cuda_nop_executable_cache_t;
 
 static const iree_hal_executable_cache_vtable_t
@@ -30,6 +31,7 @@ iree_hal_cuda_nop_executable_cache_cast(
 
 iree_status_t iree_hal_cuda_nop_executable_cache_create(
     iree_hal_cuda_context_wrapper_t* context, iree_string_view_t identifier,
+    iree_hal_cuda_native_executable_flags_t executable_flags,
     iree_hal_executable_cache_t** out_executable_cache) {
   IREE_ASSERT_ARGUMENT(out_executable_cache);
   *out_executable_cache = NULL;
@@ -43,6 +45,7 @@ iree_status_t iree_hal_cuda_nop_executable_cache_create(
     iree_hal_resource_initialize(&iree_hal_cuda_nop_executable_cache_vtable,
                                  &executable_cache->resource);
     executable_cache->context = context;
+    executable_cache->executable_flags = executable_flags;
 
     *out_executable_cache = (iree_hal_executable_cache_t*)executable_cache;
   }
@@ -77,7 +80,8 @@ static iree_status_t iree_hal_cuda_nop_executable_cache_prepare_executable(
   iree_hal_cuda_nop_executable_cache_t* executable_cache =
       iree_hal_cuda_nop_executable_cache_cast(base_executable_cache);
   return iree_hal_cuda_native_executable_create(
-      executable_cache->context, executable_params, out_executable);
+      executable_cache->context, executable_cache->executable_flags,
+      executable_params, out_executable);
 }
 
 static const iree_hal_executable_cache_vtable_t
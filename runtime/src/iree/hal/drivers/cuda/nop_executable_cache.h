@@ -10,6 +10,7 @@
 #include "iree/base/api.h"
 #include "iree/hal/api.h"
 #include "iree/hal/drivers/cuda/context_wrapper.h"
+#include "iree/hal/drivers/cuda/native_executable.h"
 
 #ifdef __cplusplus
 extern "C" {
@@ -18,8 +19,10 @@ extern "C" {
 // Creates a no-op executable cache that does not cache at all.
 // This is useful to isolate pipeline caching behavior and verify compilation
 // behavior.
+// |executable_flags| are used when creating each executable.
 iree_status_t iree_hal_cuda_nop_executable_cache_create(
     iree_hal_cuda_context_wrapper_t* context, iree_string_view_t identifier,
+    iree_hal_cuda_native_executable_flags_t executable_flags,
     iree_hal_executable_cache_t** out_executable_cache);
 
 #ifdef __cplusplus
@@ -20,10 +20,26 @@ IREE_FLAG(
     bool, cuda_use_streams, true,
     "Use CUDA streams for executing command buffers (instead of graphs).");
 
+IREE_FLAG(int32_t, cuda_graph_exec_cache_capacity, 16,
+          "Maximum number of idle CUDA graph execs retained for reuse by "
+          "graph command buffers with the same structure (0 to disable).");
+
 IREE_FLAG(bool, cuda_allow_inline_execution, false,
           "Allow command buffers to execute inline against CUDA streams when "
           "possible.");
 
+IREE_FLAG(bool, cuda_async_allocations, true,
+          "Enables CUDA asynchronous stream-ordered allocations when "
+          "supported.");
+
+IREE_FLAG(bool, cuda_lazy_executable_loading, false,
+          "Defers loading executable PTX modules and resolving their kernels "
+          "until they are first dispatched.");
+
+IREE_FLAG(int32_t, cuda_queue_count, 1,
+          "Number of queues (each backed by a CUDA stream) exposed per "
+          "device. Queue affinity bits select the queue to execute on.");
+
 IREE_FLAG(int32_t, cuda_default_index, 0, "Index of the default CUDA device.");
 
 static iree_status_t iree_hal_cuda_driver_factory_enumerate(
@@ -57,7 +73,13 @@ static iree_status_t iree_hal_cuda_driver_factory_try_create(
     default_params.command_buffer_mode =
         IREE_HAL_CUDA_COMMAND_BUFFER_MODE_STREAM;
   }
+  default_params.graph_exec_cache_capacity =
+      (iree_host_size_t)iree_max(0, FLAG_cuda_graph_exec_cache_capacity);
   default_params.allow_inline_execution = FLAG_cuda_allow_inline_execution;
+  default_params.async_allocations = FLAG_cuda_async_allocations;
+  default_params.lazy_executable_loading = FLAG_cuda_lazy_executable_loading;
+  default_params.queue_count =
+      (iree_host_size_t)iree_max(1, FLAG_cuda_queue_count);
 
   iree_hal_cuda_driver_options_t driver_options;
   iree_hal_cuda_driver_options_initialize(&driver_options);
@@ -0,0 +1,208 @@
+// Copyright 2023 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include "iree/hal/drivers/cuda/staging_buffer.h"
+
+#include <string.h>
+
+#include "iree/base/tracing.h"
+#include "iree/hal/drivers/cuda/dynamic_symbols.h"
+#include "iree/hal/drivers/cuda/status_util.h"
+
+iree_status_t iree_hal_cuda_staging_buffer_initialize(
+    iree_hal_cuda_context_wrapper_t* context, iree_device_size_t chunk_size,
+    iree_hal_cuda_staging_buffer_t* out_staging_buffer) {
+  IREE_ASSERT_ARGUMENT(context);
+  IREE_ASSERT_ARGUMENT(out_staging_buffer);
+  IREE_TRACE_ZONE_BEGIN(z0);
+  IREE_TRACE_ZONE_APPEND_VALUE(z0, chunk_size);
+  memset(out_staging_buffer, 0, sizeof(*out_staging_buffer));
+  out_staging_buffer->context = context;
+  out_staging_buffer->chunk_size = chunk_size;
+  iree_slim_mutex_initialize(&out_staging_buffer->mutex);
+  if (chunk_size == 0) {
+    IREE_TRACE_ZONE_END(z0);
+    return iree_ok_status();
+  }
+
+  iree_status_t status = CU_RESULT_TO_STATUS(
+      context->syms,
+      cuStreamCreate(&out_staging_buffer->stream, CU_STREAM_NON_BLOCKING),
+      "cuStreamCreate");
+  if (iree_status_is_ok(status)) {
+    status = CU_RESULT_TO_STATUS(
+        context->syms,
+        cuMemHostAlloc((void**)&out_staging_buffer->host_ptr,
+                       IREE_HAL_CUDA_STAGING_CHUNK_COUNT * chunk_size,
+                       /*flags=*/0),
+        "cuMemHostAlloc");
+  }
+  for (iree_host_size_t i = 0;
+       i < IREE_HAL_CUDA_STAGING_CHUNK_COUNT && iree_status_is_ok(status);
+       ++i) {
+    status = CU_RESULT_TO_STATUS(
+        context->syms,
+        cuEventCreate(&out_staging_buffer->chunk_events[i],
+                      CU_EVENT_DISABLE_TIMING),
+        "cuEventCreate");
+  }
+
+  if (!iree_status_is_ok(status)) {
+    iree_hal_cuda_staging_buffer_deinitialize(out_staging_buffer);
+  }
+  IREE_TRACE_ZONE_END(z0);
+  return status;
+}
+
+void iree_hal_cuda_staging_buffer_deinitialize(
+    iree_hal_cuda_staging_buffer_t* staging_buffer) {
+  iree_hal_cuda_context_wrapper_t* context = staging_buffer->context;
+  if (!context) return;
+  IREE_TRACE_ZONE_BEGIN(z0);
+  if (staging_buffer->stream) {
+    CUDA_IGNORE_ERROR(context->syms,
+                      cuStreamSynchronize(staging_buffer->stream));
+  }
+  for (iree_host_size_t i = 0; i < IREE_HAL_CUDA_STAGING_CHUNK_COUNT; ++i) {
+    if (staging_buffer->chunk_events[i]) {
+      CUDA_IGNORE_ERROR(context->syms,
+                        cuEventDestroy(staging_buffer->chunk_events[i]));
+    }
+  }
+  if (staging_buffer->host_ptr) {
+    CUDA_IGNORE_ERROR(context->syms, cuMemFreeHost(staging_buffer->host_ptr));
+  }
+  if (staging_buffer->stream) {
+    CUDA_IGNORE_ERROR(context->syms, cuStreamDestroy(staging_buffer->stream));
+  }
+  iree_slim_mutex_deinitialize(&staging_buffer->mutex);
+  memset(staging_buffer, 0, sizeof(*staging_buffer));
+  IREE_TRACE_ZONE_END(z0);
+}
+
+bool iree_hal_cuda_staging_buffer_is_available(
+    const iree_hal_cuda_staging_buffer_t* staging_buffer) {
+  return staging_buffer->host_ptr != NULL;
+}
+
+static iree_status_t iree_hal_cuda_staging_buffer_upload_locked(
+    iree_hal_cuda_staging_buffer_t* staging_buffer, const uint8_t* source,
+    CUdeviceptr target, iree_device_size_t length) {
+  iree_hal_cuda_dynamic_symbols_t* syms = staging_buffer->context->syms;
+  const iree_device_size_t chunk_size = staging_buffer->chunk_size;
+  for (iree_device_size_t offset = 0, i = 0; offset < length;
+       offset += chunk_size, ++i) {
+    const iree_host_size_t slot = i % IREE_HAL_CUDA_STAGING_CHUNK_COUNT;
+    const iree_device_size_t chunk_length =
+        iree_min(chunk_size, length - offset);
+    uint8_t* chunk_ptr = staging_buffer->host_ptr + slot * chunk_size;
+
+    // Wait for the previous DMA out of this slot before overwriting it. The
+    // DMA of the other slot continues while we copy.
+    if (i >= IREE_HAL_CUDA_STAGING_CHUNK_COUNT) {
+      CUDA_RETURN_IF_ERROR(
+          syms, cuEventSynchronize(staging_buffer->chunk_events[slot]),
+          "cuEventSynchronize");
+    }
+    memcpy(chunk_ptr, source + offset, chunk_length);
+    CUDA_RETURN_IF_ERROR(
+        syms,
+        cuMemcpyHtoDAsync_v2(target + offset, chunk_ptr, chunk_length,
+                             staging_buffer->stream),
+        "cuMemcpyHtoDAsync_v2");
+    CUDA_RETURN_IF_ERROR(syms,
+                         cuEventRecord(staging_buffer->chunk_events[slot],
+                                       staging_buffer->stream),
+                         "cuEventRecord");
+  }
+  return iree_ok_status();
+}
+
+iree_status_t iree_hal_cuda_staging_buffer_upload(
+    iree_hal_cuda_staging_buffer_t* staging_buffer, const void* source,
+    CUdeviceptr target, iree_device_size_t length) {
+  IREE_ASSERT_ARGUMENT(staging_buffer);
+  IREE_ASSERT_ARGUMENT(iree_hal_cuda_staging_buffer_is_available(
+      staging_buffer));
+  IREE_TRACE_ZONE_BEGIN(z0);
+  IREE_TRACE_ZONE_APPEND_VALUE(z0, length);
+  iree_slim_mutex_lock(&staging_buffer->mutex);
+  iree_status_t status = iree_hal_cuda_staging_buffer_upload_locked(
+      staging_buffer, (const uint8_t*)source, target, length);
+  // Always drain the stream so that the staging memory is idle for the next
+  // transfer even if this one failed part way.
+  status = iree_status_join(
+      status, CU_RESULT_TO_STATUS(staging_buffer->context->syms,
+                                  cuStreamSynchronize(staging_buffer->stream),
+                                  "cuStreamSynchronize"));
+  iree_slim_mutex_unlock(&staging_buffer->mutex);
+  IREE_TRACE_ZONE_END(z0);
+  return status;
+}
+
+static iree_status_t iree_hal_cuda_staging_buffer_download_locked(
+    iree_hal_cuda_staging_buffer_t* staging_buffer, CUdeviceptr source,
+    uint8_t* target, iree_device_size_t length) {
+  iree_hal_cuda_dynamic_symbols_t* syms = staging_buffer->context->syms;
+  const iree_device_size_t chunk_size = staging_buffer->chunk_size;
+  const iree_device_size_t chunk_count = (length + chunk_size - 1) / chunk_size;
+
+  // Keep up to IREE_HAL_CUDA_STAGING_CHUNK_COUNT DMAs in flight and copy each
+  // chunk out on the host once its DMA completes. Chunk i is issued only after
+  // chunk i - IREE_HAL_CUDA_STAGING_CHUNK_COUNT has been copied out of its
+  // slot.
+  for (iree_device_size_t i = 0; i < chunk_count + 1; ++i) {
+    if (i < chunk_count) {
+      const iree_host_size_t slot = i % IREE_HAL_CUDA_STAGING_CHUNK_COUNT;
+      const iree_device_size_t offset = i * chunk_size;
+      const iree_device_size_t chunk_length =
+          iree_min(chunk_size, length - offset);
+      uint8_t* chunk_ptr = staging_buffer->host_ptr + slot * chunk_size;
+      CUDA_RETURN_IF_ERROR(
+          syms,
+          cuMemcpyDtoHAsync_v2(chunk_ptr, source + offset, chunk_length,
+                               staging_buffer->stream),
+          "cuMemcpyDtoHAsync_v2");
+      CUDA_RETURN_IF_ERROR(syms,
+                           cuEventRecord(staging_buffer->chunk_events[slot],
+                                         staging_buffer->stream),
+                           "cuEventRecord");
+    }
+    if (i > 0) {
+      const iree_device_size_t ready = i - 1;
+      const iree_host_size_t slot = ready % IREE_HAL_CUDA_STAGING_CHUNK_COUNT;
+      const iree_device_size_t offset = ready * chunk_size;
+      const iree_device_size_t chunk_length =
+          iree_min(chunk_size, length - offset);
+      CUDA_RETURN_IF_ERROR(
+          syms, cuEventSynchronize(staging_buffer->chunk_events[slot]),
+          "cuEventSynchronize");
+      memcpy(target + offset, staging_buffer->host_ptr + slot * chunk_size,
+             chunk_length);
+    }
+  }
+  return iree_ok_status();
+}
+
+iree_status_t iree_hal_cuda_staging_buffer_download(
+    iree_hal_cuda_staging_buffer_t* staging_buffer, CUdeviceptr source,
+    void* target, iree_device_size_t length) {
+  IREE_ASSERT_ARGUMENT(staging_buffer);
+  IREE_ASSERT_ARGUMENT(iree_hal_cuda_staging_buffer_is_available(
+      staging_buffer));
+  IREE_TRACE_ZONE_BEGIN(z0);
+  IREE_TRACE_ZONE_APPEND_VALUE(z0, length);
+  iree_slim_mutex_lock(&staging_buffer->mutex);
+  iree_status_t status = iree_hal_cuda_staging_buffer_download_locked(
+      staging_buffer, source, (uint8_t*)target, length);
+  status = iree_status_join(
+      status, CU_RESULT_TO_STATUS(staging_buffer->context->syms,
+                                  cuStreamSynchronize(staging_buffer->stream),
+                                  "cuStreamSynchronize"));
+  iree_slim_mutex_unlock(&staging_buffer->mutex);
+  IREE_TRACE_ZONE_END(z0);
+  return status;
+}
@@ -0,0 +1,80 @@
+// Copyright 2023 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#ifndef IREE_HAL_DRIVERS_CUDA_STAGING_BUFFER_H_
+#define IREE_HAL_DRIVERS_CUDA_STAGING_BUFFER_H_
+
+#include "iree/base/api.h"
+#include "iree/base/internal/synchronization.h"
+#include "iree/hal/api.h"
+#include "iree/hal/drivers/cuda/context_wrapper.h"
+#include "iree/hal/drivers/cuda/cuda_headers.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif  // __cplusplus
+
+// Number of staging chunks used to pipeline transfers. Two allows the host
+// copy into/out of one chunk to overlap with the DMA of the other.
+#define IREE_HAL_CUDA_STAGING_CHUNK_COUNT 2
+
+// Pinned host staging memory used for synchronous host<->device transfers of
+// buffers that cannot be mapped into host memory.
+//
+// Transfers are split into chunks that cycle through a small ring of pinned
+// memory. Host copies of one chunk overlap with the device copy of the previous
+// one and pinned memory lets the DMA engines run at full bandwidth without the
+// driver staging pageable memory itself. Transfers are issued on a dedicated
+// stream so that they can overlap with compute work on the device queues.
+//
+// Thread-safe; concurrent transfers are serialized.
+typedef struct iree_hal_cuda_staging_buffer_t {
+  // CUDA context the staging memory is registered with.
+  iree_hal_cuda_context_wrapper_t* context;
+  // Size in bytes of each chunk of staging memory.
+  iree_device_size_t chunk_size;
+
+  // Guards the staging memory and stream.
+  iree_slim_mutex_t mutex;
+  // Stream used for all staged transfers.
+  CUstream stream IREE_GUARDED_BY(mutex);
+  // Pinned host memory of IREE_HAL_CUDA_STAGING_CHUNK_COUNT * chunk_size.
+  uint8_t* host_ptr IREE_GUARDED_BY(mutex);
+  // Recorded on |stream| after the device copy of each chunk is issued.
+  CUevent chunk_events[IREE_HAL_CUDA_STAGING_CHUNK_COUNT] IREE_GUARDED_BY(
+      mutex);
+} iree_hal_cuda_staging_buffer_t;
+
+// Initializes |out_staging_buffer| with |chunk_size| bytes per staging chunk.
+// A |chunk_size| of 0 disables staging and
+// iree_hal_cuda_staging_buffer_is_available will return false.
+iree_status_t iree_hal_cuda_staging_buffer_initialize(
+    iree_hal_cuda_context_wrapper_t* context, iree_device_size_t chunk_size,
+    iree_hal_cuda_staging_buffer_t* out_staging_buffer);
+
+// Deinitializes |staging_buffer| and releases the pinned memory.
+void iree_hal_cuda_staging_buffer_deinitialize(
+    iree_hal_cuda_staging_buffer_t* staging_buffer);
+
+// Returns true if |staging_buffer| can service transfers.
+bool iree_hal_cuda_staging_buffer_is_available(
+    const iree_hal_cuda_staging_buffer_t* staging_buffer);
+
+// Synchronously copies |length| bytes from host |source| to device |target|.
+iree_status_t iree_hal_cuda_staging_buffer_upload(
+    iree_hal_cuda_staging_buffer_t* staging_buffer, const void* source,
+    CUdeviceptr target, iree_device_size_t length);
+
+// Synchronously copies |length| bytes from device |source| to host |target|.
+iree_status_t iree_hal_cuda_staging_buffer_download(
+    iree_hal_cuda_staging_buffer_t* staging_buffer, CUdeviceptr source,
+    void* target, iree_device_size_t length);
+
+#ifdef __cplusplus
+}  // extern "C"
+#endif  // __cplusplus
+
+#endif  // IREE_HAL_DRIVERS_CUDA_STAGING_BUFFER_H_
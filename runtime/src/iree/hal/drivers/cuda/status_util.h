@@ -47,6 +47,38 @@ iree_status_t iree_hal_cuda_result_to_status(
     iree_hal_cuda_dynamic_symbols_t* syms, CUresult result, const char* file,
     uint32_t line);
 
+// Converts a ncclResult_t to an iree_status_t.
+//
+// Usage:
+//   iree_status_t status = NCCL_RESULT_TO_STATUS(nccl_syms, ncclDoThing(...));
+#define NCCL_RESULT_TO_STATUS(syms, expr, ...)                    \
+  iree_hal_cuda_nccl_result_to_status((syms), ((syms)->expr), __FILE__, \
+                                      __LINE__)
+
+// IREE_RETURN_IF_ERROR but implicitly converts the ncclResult_t return value to
+// a Status.
+//
+// Usage:
+//   NCCL_RETURN_IF_ERROR(nccl_syms, ncclDoThing(...), "message");
+#define NCCL_RETURN_IF_ERROR(syms, expr, ...)                           \
+  IREE_RETURN_IF_ERROR(iree_hal_cuda_nccl_result_to_status(             \
+                           (syms), ((syms)->expr), __FILE__, __LINE__), \
+                       __VA_ARGS__)
+
+// IREE_IGNORE_ERROR but implicitly converts the ncclResult_t return value to a
+// Status.
+//
+// Usage:
+//   NCCL_IGNORE_ERROR(nccl_syms, ncclDoThing(...));
+#define NCCL_IGNORE_ERROR(syms, expr)                       \
+  IREE_IGNORE_ERROR(iree_hal_cuda_nccl_result_to_status(    \
+      (syms), ((syms)->expr), __FILE__, __LINE__))
+
+// Converts a ncclResult_t to a Status object.
+iree_status_t iree_hal_cuda_nccl_result_to_status(
+    iree_hal_cuda_nccl_dynamic_symbols_t* syms, ncclResult_t result,
+    const char* file, uint32_t line);
+
 #ifdef __cplusplus
 }  // extern "C"
 #endif  // __cplusplus
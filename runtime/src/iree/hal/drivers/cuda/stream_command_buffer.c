@@ -14,6 +14,7 @@
 #include "iree/hal/drivers/cuda/pipeline_layout.h"
 #include "iree/hal/drivers/cuda/status_util.h"
 #include "iree/hal/utils/collective_batch.h"
+#include "iree/hal/utils/deferred_command_buffer.h"
 #include "iree/hal/utils/resource_set.h"
 
 #define IREE_HAL_CUDA_MAX_BINDING_COUNT 64
@@ -67,9 +68,11 @@ iree_status_t iree_hal_cuda_stream_command_buffer_create(
   *out_command_buffer = NULL;
 
   if (binding_capacity > 0) {
-    // TODO(#10144): support indirect command buffers with binding tables.
+    // Indirect command buffers are recorded as deferred command buffers by the
+    // device and replayed with resolved bindings when executed.
     return iree_make_status(IREE_STATUS_UNIMPLEMENTED,
-                            "indirect command buffers not yet implemented");
+                            "indirect stream command buffers are not supported; "
+                            "record as a deferred command buffer");
   }
 
   IREE_TRACE_ZONE_BEGIN(z0);
@@ -458,8 +461,9 @@ static iree_status_t iree_hal_cuda_stream_command_buffer_dispatch(
       executable, entry_point, &block_size_x, &block_size_y, &block_size_z));
   IREE_RETURN_IF_ERROR(iree_hal_cuda_native_executable_shared_memory_size(
       executable, entry_point, &shared_memory_size));
-  CUfunction func =
-      iree_hal_cuda_native_executable_for_entry_point(executable, entry_point);
+  CUfunction func = NULL;
+  IREE_RETURN_IF_ERROR(iree_hal_cuda_native_executable_lookup_function(
+      executable, entry_point, &func));
   CUDA_RETURN_IF_ERROR(
       command_buffer->context->syms,
       cuLaunchKernel(func, workgroup_x, workgroup_y, workgroup_z, block_size_x,
@@ -484,10 +488,33 @@ static iree_status_t iree_hal_cuda_stream_command_buffer_execute_commands(
     iree_hal_command_buffer_t* base_command_buffer,
     iree_hal_command_buffer_t* base_commands,
     iree_hal_buffer_binding_table_t binding_table) {
-  // TODO(#10144): support indirect command buffers with deferred command
-  // buffers or graphs. We likely just want to switch to graphs.
-  return iree_make_status(IREE_STATUS_UNIMPLEMENTED,
-                          "indirect command buffers not yet implemented");
+  iree_hal_cuda_stream_command_buffer_t* command_buffer =
+      iree_hal_cuda_stream_command_buffer_cast(base_command_buffer);
+  // Nested command buffers are recorded as deferred command buffers and
+  // replayed inline into the stream with their indirect bindings resolved
+  // against the provided binding table.
+  if (!iree_hal_deferred_command_buffer_isa(base_commands)) {
+    return iree_make_status(IREE_STATUS_UNIMPLEMENTED,
+                            "only deferred nested command buffers are "
+                            "supported");
+  }
+
+  IREE_TRACE_ZONE_BEGIN(z0);
+  iree_status_t status = iree_hal_resource_set_insert(
+      command_buffer->resource_set, 1, &base_commands);
+  for (iree_host_size_t i = 0;
+       iree_status_is_ok(status) && i < binding_table.count; ++i) {
+    if (binding_table.bindings[i].buffer) {
+      status = iree_hal_resource_set_insert(
+          command_buffer->resource_set, 1, &binding_table.bindings[i].buffer);
+    }
+  }
+  if (iree_status_is_ok(status)) {
+    status = iree_hal_deferred_command_buffer_apply_commands(
+        base_commands, base_command_buffer, binding_table);
+  }
+  IREE_TRACE_ZONE_END(z0);
+  return status;
 }
 
 static const iree_hal_command_buffer_vtable_t
@@ -10,9 +10,16 @@
 #include <stddef.h>
 
 #include "iree/base/api.h"
+#include "iree/base/internal/flags.h"
 #include "iree/hal/drivers/local_sync/sync_driver.h"
 #include "iree/hal/local/loaders/registration/init.h"
 
+IREE_FLAG(int32_t, sync_worker_count, 1,
+          "Number of threads the workgroups of each local-sync dispatch are "
+          "distributed across, including the thread issuing the work. "
+          "Execution stays synchronous and in-order; values greater than 1 "
+          "create a small pool of helper threads per device.");
+
 static iree_status_t iree_hal_local_sync_driver_factory_enumerate(
     void* self, iree_host_size_t* out_driver_info_count,
     const iree_hal_driver_info_t** out_driver_infos) {
@@ -37,6 +44,12 @@ static iree_status_t iree_hal_local_sync_driver_factory_try_create(
 
   iree_hal_sync_device_params_t default_params;
   iree_hal_sync_device_params_initialize(&default_params);
+  if (FLAG_sync_worker_count < 1) {
+    return iree_make_status(IREE_STATUS_INVALID_ARGUMENT,
+                            "--sync_worker_count must be at least 1 (got %d)",
+                            FLAG_sync_worker_count);
+  }
+  default_params.worker_count = (iree_host_size_t)FLAG_sync_worker_count;
 
   iree_hal_executable_loader_t* loaders[8] = {NULL};
   iree_host_size_t loader_count = 0;
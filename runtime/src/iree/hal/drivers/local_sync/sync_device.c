@@ -16,6 +16,7 @@
 #include "iree/hal/drivers/local_sync/sync_event.h"
 #include "iree/hal/drivers/local_sync/sync_semaphore.h"
 #include "iree/hal/local/executable_environment.h"
+#include "iree/hal/local/fork_join_pool.h"
 #include "iree/hal/local/inline_command_buffer.h"
 #include "iree/hal/local/local_executable_cache.h"
 #include "iree/hal/local/local_pipeline_layout.h"
@@ -38,6 +39,11 @@ typedef struct iree_hal_sync_device_t {
   // synchronization ourselves.
   iree_hal_sync_semaphore_state_t semaphore_state;
 
+  // Total number of workers dispatches may run on, including the caller.
+  iree_host_size_t worker_count;
+  // Pool of helper threads used when |worker_count| > 1; otherwise NULL.
+  iree_hal_fork_join_pool_t* fork_join_pool;
+
   iree_host_size_t loader_count;
   iree_hal_executable_loader_t* loaders[];
 } iree_hal_sync_device_t;
@@ -54,6 +60,7 @@ void iree_hal_sync_device_params_initialize(
     iree_hal_sync_device_params_t* out_params) {
   memset(out_params, 0, sizeof(*out_params));
   out_params->arena_block_size = 32 * 1024;
+  out_params->worker_count = 1;
 }
 
 static iree_status_t iree_hal_sync_device_check_params(
@@ -62,6 +69,13 @@ static iree_status_t iree_hal_sync_device_check_params(
     return iree_make_status(IREE_STATUS_INVALID_ARGUMENT,
                             "arena block size too small (< 4096 bytes)");
   }
+  if (params->worker_count < 1 ||
+      params->worker_count > IREE_HAL_FORK_JOIN_POOL_MAX_WORKER_COUNT) {
+    return iree_make_status(IREE_STATUS_INVALID_ARGUMENT,
+                            "worker count %" PRIhsz " out of range [1, %d]",
+                            params->worker_count,
+                            IREE_HAL_FORK_JOIN_POOL_MAX_WORKER_COUNT);
+  }
   return iree_ok_status();
 }
 
@@ -105,6 +119,12 @@ iree_status_t iree_hal_sync_device_create(
     }
 
     iree_hal_sync_semaphore_state_initialize(&device->semaphore_state);
+
+    device->worker_count = params->worker_count;
+    if (device->worker_count > 1) {
+      status = iree_hal_fork_join_pool_create(
+          device->worker_count, host_allocator, &device->fork_join_pool);
+    }
   }
 
   if (iree_status_is_ok(status)) {
@@ -122,6 +142,7 @@ static void iree_hal_sync_device_destroy(iree_hal_device_t* base_device) {
   IREE_TRACE_ZONE_BEGIN(z0);
 
   iree_hal_sync_semaphore_state_deinitialize(&device->semaphore_state);
+  iree_hal_fork_join_pool_release(device->fork_join_pool);
 
   for (iree_host_size_t i = 0; i < device->loader_count; ++i) {
     iree_hal_executable_loader_release(device->loaders[i]);
@@ -176,7 +197,7 @@ static iree_status_t iree_hal_sync_device_query_i64(
     }
   } else if (iree_string_view_equal(category, IREE_SV("hal.dispatch"))) {
     if (iree_string_view_equal(key, IREE_SV("concurrency"))) {
-      *out_value = 1;
+      *out_value = (int64_t)device->worker_count;
       return iree_ok_status();
     }
   } else if (iree_string_view_equal(category, IREE_SV("hal.cpu"))) {
@@ -201,13 +222,14 @@ static iree_status_t iree_hal_sync_device_create_command_buffer(
     iree_hal_command_category_t command_categories,
     iree_hal_queue_affinity_t queue_affinity, iree_host_size_t binding_capacity,
     iree_hal_command_buffer_t** out_command_buffer) {
+  iree_hal_sync_device_t* device = iree_hal_sync_device_cast(base_device);
   if (iree_all_bits_set(mode,
                         IREE_HAL_COMMAND_BUFFER_MODE_ALLOW_INLINE_EXECUTION)) {
     return iree_hal_inline_command_buffer_create(
         base_device, mode, command_categories, queue_affinity, binding_capacity,
-        iree_hal_device_host_allocator(base_device), out_command_buffer);
+        device->fork_join_pool, iree_hal_device_host_allocator(base_device),
+        out_command_buffer);
   } else {
-    iree_hal_sync_device_t* device = iree_hal_sync_device_cast(base_device);
     return iree_hal_deferred_command_buffer_create(
         base_device, mode, command_categories, binding_capacity,
         &device->large_block_pool, device->host_allocator, out_command_buffer);
@@ -236,7 +258,7 @@ static iree_status_t iree_hal_sync_device_create_executable_cache(
     iree_loop_t loop, iree_hal_executable_cache_t** out_executable_cache) {
   iree_hal_sync_device_t* device = iree_hal_sync_device_cast(base_device);
   return iree_hal_local_executable_cache_create(
-      identifier, /*worker_capacity=*/1, device->loader_count, device->loaders,
+      identifier, device->worker_count, device->loader_count, device->loaders,
       iree_hal_device_host_allocator(base_device), out_executable_cache);
 }
 
@@ -323,8 +345,8 @@ static iree_status_t iree_hal_sync_device_apply_deferred_command_buffers(
           iree_hal_command_buffer_mode(command_buffer) |
               IREE_HAL_COMMAND_BUFFER_MODE_ALLOW_INLINE_EXECUTION,
           IREE_HAL_COMMAND_CATEGORY_ANY, IREE_HAL_QUEUE_AFFINITY_ANY,
-          /*binding_capacity=*/0, device->host_allocator, storage,
-          &inline_command_buffer));
+          /*binding_capacity=*/0, device->fork_join_pool,
+          device->host_allocator, storage, &inline_command_buffer));
       iree_status_t status = iree_hal_deferred_command_buffer_apply(
           command_buffer, inline_command_buffer,
           iree_hal_buffer_binding_table_empty());
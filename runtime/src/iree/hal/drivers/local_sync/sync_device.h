@@ -22,6 +22,13 @@ typedef struct iree_hal_sync_device_params_t {
   // Larger sizes will lower overhead and ensure the heap isn't hit for
   // transient allocations while also increasing memory consumption.
   iree_host_size_t arena_block_size;
+
+  // Total number of workers dispatches are distributed across, including the
+  // thread issuing the work. With 1 (the default) all work runs on the issuing
+  // thread and no threads are created. Larger values keep the synchronous
+  // in-order queue semantics but fan the workgroups of each dispatch out over
+  // a fork-join pool of |worker_count| - 1 helper threads owned by the device.
+  iree_host_size_t worker_count;
 } iree_hal_sync_device_params_t;
 
 // Initializes |out_params| to default values.
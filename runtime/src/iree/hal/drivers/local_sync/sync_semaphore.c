@@ -434,10 +434,22 @@ iree_status_t iree_hal_sync_semaphore_multi_wait(
   return status;
 }
 
+static iree_status_t iree_hal_sync_semaphore_export_timepoint(
+    iree_hal_semaphore_t* base_semaphore, uint64_t value,
+    iree_wait_primitive_type_t target_type,
+    iree_wait_primitive_t* out_wait_primitive) {
+  iree_hal_sync_semaphore_t* semaphore =
+      iree_hal_sync_semaphore_cast(base_semaphore);
+  return iree_hal_semaphore_export_timepoint_event(
+      base_semaphore, value, target_type, semaphore->host_allocator,
+      out_wait_primitive);
+}
+
 static const iree_hal_semaphore_vtable_t iree_hal_sync_semaphore_vtable = {
     .destroy = iree_hal_sync_semaphore_destroy,
     .query = iree_hal_sync_semaphore_query,
     .signal = iree_hal_sync_semaphore_signal,
     .fail = iree_hal_sync_semaphore_fail,
     .wait = iree_hal_sync_semaphore_wait,
+    .export_timepoint = iree_hal_sync_semaphore_export_timepoint,
 };
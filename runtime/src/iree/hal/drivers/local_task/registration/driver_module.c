@@ -8,12 +8,93 @@
 
 #include <inttypes.h>
 #include <stddef.h>
+#include <string.h>
 
 #include "iree/base/api.h"
+#include "iree/base/internal/flags.h"
+#include "iree/base/internal/page_allocator.h"
 #include "iree/hal/drivers/local_task/task_driver.h"
 #include "iree/hal/local/loaders/registration/init.h"
 #include "iree/task/api.h"
 
+IREE_FLAG(bool, task_share_executor, false,
+          "Shares one process-wide task executor between all local-task "
+          "drivers instead of creating one executor per driver. Devices keep "
+          "their own queues but draw from the same pool of workers to avoid "
+          "oversubscribing cores when running multiple devices in a process.");
+
+IREE_FLAG(string, task_heap_pages, "default",
+          "Selects the pages backing large device buffers:\n"
+          "  'default': the host allocator.\n"
+          "  'transparent': transparent huge pages (Linux THP).\n"
+          "  'explicit': 2MB pages from the reserved huge page pool.\n"
+          "  'explicit_1gb': 1GB pages from the reserved pool for buffers of\n"
+          "                  at least 1GB.\n"
+          "Explicit pages fall back to normal pages if the pool is exhausted.");
+
+IREE_FLAG(bool, task_heap_numa_bind, false,
+          "Prefers placing large device buffers on the NUMA node the task "
+          "executor workers run on when they are all on the same node (such "
+          "as with --task_topology_node_id=).");
+
+IREE_FLAG(int32_t, task_queue_count, 1,
+          "Number of queues exposed by each local-task device. Programs "
+          "compiled with --iree-scheduling-pipeline-stages=N run stage i on "
+          "queue i so that stages of consecutive invocations overlap. All "
+          "queues of a device share its executor.");
+
+IREE_FLAG(bool, task_donate_caller, false,
+          "Lets threads waiting on local-task device semaphores execute tasks "
+          "from the executor until their wait resolves instead of sleeping. "
+          "Saves a wake-up and adds the waiting thread to the workers.");
+
+IREE_FLAG(string, task_channel_id, "",
+          "Default ID of collective channels created by programs. Devices on "
+          "the same host using the same ID join the same channel. Must be "
+          "set when running multiple participants.");
+IREE_FLAG(int32_t, task_channel_rank, 0,
+          "Default rank of the device in collective channels.");
+IREE_FLAG(int32_t, task_channel_count, 1,
+          "Default number of participants in collective channels.");
+IREE_FLAG(int64_t, task_channel_timeout_ms, 5 * 60 * 1000,
+          "Maximum time in milliseconds a collective channel participant waits "
+          "on the others before the channel is aborted or 0 to wait forever.");
+
+// Selects the allocator used for device buffer storage based on flags.
+static iree_status_t iree_hal_local_task_select_data_allocator(
+    iree_task_executor_t* executor, iree_allocator_t host_allocator,
+    iree_allocator_t* out_data_allocator) {
+  *out_data_allocator = host_allocator;
+  iree_page_allocator_flags_t flags = IREE_PAGE_ALLOCATOR_FLAG_NONE;
+  if (strcmp(FLAG_task_heap_pages, "default") == 0) {
+    flags = IREE_PAGE_ALLOCATOR_FLAG_NONE;
+  } else if (strcmp(FLAG_task_heap_pages, "transparent") == 0) {
+    flags = IREE_PAGE_ALLOCATOR_FLAG_TRANSPARENT_HUGE_PAGES;
+  } else if (strcmp(FLAG_task_heap_pages, "explicit") == 0) {
+    flags = IREE_PAGE_ALLOCATOR_FLAG_EXPLICIT_HUGE_PAGES;
+  } else if (strcmp(FLAG_task_heap_pages, "explicit_1gb") == 0) {
+    flags = IREE_PAGE_ALLOCATOR_FLAG_EXPLICIT_HUGE_PAGES |
+            IREE_PAGE_ALLOCATOR_FLAG_GIGANTIC_PAGES;
+  } else {
+    return iree_make_status(IREE_STATUS_INVALID_ARGUMENT,
+                            "unsupported --task_heap_pages=%s",
+                            FLAG_task_heap_pages);
+  }
+  uint32_t node_id = IREE_PAGE_ALLOCATOR_NODE_ID_ANY;
+  if (FLAG_task_heap_numa_bind) {
+    iree_task_topology_node_id_t executor_node_id =
+        iree_task_executor_node_id(executor);
+    if (executor_node_id != IREE_TASK_TOPOLOGY_NODE_ID_ANY) {
+      node_id = (uint32_t)executor_node_id;
+    }
+  }
+  if (flags != IREE_PAGE_ALLOCATOR_FLAG_NONE ||
+      node_id != IREE_PAGE_ALLOCATOR_NODE_ID_ANY) {
+    *out_data_allocator = iree_page_allocator(flags, node_id);
+  }
+  return iree_ok_status();
+}
+
 static iree_status_t iree_hal_local_task_driver_factory_enumerate(
     void* self, iree_host_size_t* out_driver_info_count,
     const iree_hal_driver_info_t** out_driver_infos) {
@@ -40,6 +121,15 @@ static iree_status_t iree_hal_local_task_driver_factory_try_create(
 
   iree_hal_task_device_params_t default_params;
   iree_hal_task_device_params_initialize(&default_params);
+  default_params.channel_default_id =
+      iree_make_cstring_view(FLAG_task_channel_id);
+  default_params.channel_default_rank = FLAG_task_channel_rank;
+  default_params.channel_default_count = FLAG_task_channel_count;
+  default_params.channel_timeout =
+      FLAG_task_channel_timeout_ms > 0
+          ? FLAG_task_channel_timeout_ms * 1000000ll
+          : IREE_DURATION_INFINITE;
+  default_params.donate_caller = FLAG_task_donate_caller;
 
   iree_hal_executable_loader_t* loaders[8] = {NULL};
   iree_host_size_t loader_count = 0;
@@ -49,20 +139,44 @@ static iree_status_t iree_hal_local_task_driver_factory_try_create(
 
   iree_task_executor_t* executor = NULL;
   if (iree_status_is_ok(status)) {
-    status = iree_task_executor_create_from_flags(host_allocator, &executor);
+    status = FLAG_task_share_executor
+                 ? iree_task_executor_acquire_shared_from_flags(host_allocator,
+                                                                &executor)
+                 : iree_task_executor_create_from_flags(host_allocator,
+                                                        &executor);
+  }
+
+  iree_allocator_t data_allocator = host_allocator;
+  if (iree_status_is_ok(status)) {
+    status = iree_hal_local_task_select_data_allocator(executor, host_allocator,
+                                                       &data_allocator);
   }
 
   iree_hal_allocator_t* device_allocator = NULL;
   if (iree_status_is_ok(status)) {
     status = iree_hal_allocator_create_heap(iree_make_cstring_view("local"),
-                                            host_allocator, host_allocator,
+                                            data_allocator, host_allocator,
                                             &device_allocator);
   }
 
+  iree_task_executor_t* queue_executors[64] = {NULL};
+  if (iree_status_is_ok(status) &&
+      (FLAG_task_queue_count < 1 ||
+       FLAG_task_queue_count > IREE_ARRAYSIZE(queue_executors))) {
+    status = iree_make_status(IREE_STATUS_INVALID_ARGUMENT,
+                              "--task_queue_count=%d out of range [1, %d]",
+                              FLAG_task_queue_count,
+                              (int)IREE_ARRAYSIZE(queue_executors));
+  }
+
   if (iree_status_is_ok(status)) {
+    for (int32_t i = 0; i < FLAG_task_queue_count; ++i) {
+      queue_executors[i] = executor;
+    }
     status = iree_hal_task_driver_create(
-        driver_name, &default_params, /*queue_count=*/1, &executor,
-        loader_count, loaders, device_allocator, host_allocator, out_driver);
+        driver_name, &default_params, (iree_host_size_t)FLAG_task_queue_count,
+        queue_executors, loader_count, loaders, device_allocator,
+        host_allocator, out_driver);
   }
 
   iree_hal_allocator_release(device_allocator);
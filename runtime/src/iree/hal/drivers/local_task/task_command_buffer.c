@@ -12,11 +12,15 @@
 #include <string.h>
 
 #include "iree/base/api.h"
+#include "iree/base/internal/atomics.h"
 #include "iree/base/tracing.h"
 #include "iree/hal/local/executable_environment.h"
 #include "iree/hal/local/executable_library.h"
+#include "iree/hal/local/local_channel.h"
 #include "iree/hal/local/local_executable.h"
 #include "iree/hal/local/local_pipeline_layout.h"
+#include "iree/hal/utils/deferred_command_buffer.h"
+#include "iree/hal/utils/dispatch_profile.h"
 #include "iree/hal/utils/resource_set.h"
 #include "iree/task/affinity_set.h"
 #include "iree/task/list.h"
@@ -27,6 +31,40 @@
 // iree_hal_task_command_buffer_t
 //===----------------------------------------------------------------------===//
 
+// State tracked within the command buffer during recording only.
+typedef struct iree_hal_task_command_buffer_state_t {
+  // The last global barrier that was inserted, if any.
+  // The barrier is allocated and inserted into the DAG when requested but the
+  // actual barrier dependency list is only allocated and set on flushes.
+  // This lets us allocate the appropriately sized barrier task list from the
+  // arena even though when the barrier is recorded we don't yet know what
+  // other tasks we'll be emitting as we walk the command stream.
+  iree_task_barrier_t* open_barrier;
+
+  // The number of tasks in the open barrier (|open_tasks|), used to quickly
+  // allocate storage for the task list without needing to walk the list.
+  iree_host_size_t open_task_count;
+
+  // All execution tasks emitted that must execute after |open_barrier|.
+  iree_task_list_t open_tasks;
+
+  // A flattened list of all available descriptor set bindings.
+  // As descriptor sets are pushed/bound the bindings will be updated to
+  // represent the fully-translated binding data pointer.
+  // TODO(benvanik): support proper mapping semantics and track the
+  // iree_hal_buffer_mapping_t and map/unmap where appropriate.
+  void* bindings[IREE_HAL_LOCAL_MAX_DESCRIPTOR_SET_COUNT *
+                 IREE_HAL_LOCAL_MAX_DESCRIPTOR_BINDING_COUNT];
+  iree_device_size_t
+      binding_lengths[IREE_HAL_LOCAL_MAX_DESCRIPTOR_SET_COUNT *
+                      IREE_HAL_LOCAL_MAX_DESCRIPTOR_BINDING_COUNT];
+
+  // All available push constants updated each time push_constants is called.
+  // Reset only with the command buffer and otherwise will maintain its values
+  // during recording to allow for partial push_constants updates.
+  uint32_t push_constants[IREE_HAL_LOCAL_MAX_PUSH_CONSTANT_COUNT];
+} iree_hal_task_command_buffer_state_t;
+
 // iree/task/-based command buffer.
 // We track a minimal amount of state here and incrementally build out the task
 // DAG that we can submit to the task system directly. There's no intermediate
@@ -41,6 +79,10 @@ typedef struct iree_hal_task_command_buffer_t {
 
   iree_task_scope_t* scope;
 
+  // Optional profile that dispatch execution records are appended to as
+  // dispatches retire. NULL when the device is not profiling.
+  iree_hal_dispatch_profile_t* dispatch_profile;
+
   // Arena used for all allocations; references the shared device block pool.
   iree_arena_allocator_t arena;
 
@@ -60,41 +102,10 @@ typedef struct iree_hal_task_command_buffer_t {
   // An empty list indicates that root_tasks are also the leaves.
   iree_task_list_t leaf_tasks;
 
-  // TODO(benvanik): move this out of the struct and allocate from the arena -
-  // we only need this during recording and it's ~4KB of waste otherwise.
   // State tracked within the command buffer during recording only.
-  struct {
-    // The last global barrier that was inserted, if any.
-    // The barrier is allocated and inserted into the DAG when requested but the
-    // actual barrier dependency list is only allocated and set on flushes.
-    // This lets us allocate the appropriately sized barrier task list from the
-    // arena even though when the barrier is recorded we don't yet know what
-    // other tasks we'll be emitting as we walk the command stream.
-    iree_task_barrier_t* open_barrier;
-
-    // The number of tasks in the open barrier (|open_tasks|), used to quickly
-    // allocate storage for the task list without needing to walk the list.
-    iree_host_size_t open_task_count;
-
-    // All execution tasks emitted that must execute after |open_barrier|.
-    iree_task_list_t open_tasks;
-
-    // A flattened list of all available descriptor set bindings.
-    // As descriptor sets are pushed/bound the bindings will be updated to
-    // represent the fully-translated binding data pointer.
-    // TODO(benvanik): support proper mapping semantics and track the
-    // iree_hal_buffer_mapping_t and map/unmap where appropriate.
-    void* bindings[IREE_HAL_LOCAL_MAX_DESCRIPTOR_SET_COUNT *
-                   IREE_HAL_LOCAL_MAX_DESCRIPTOR_BINDING_COUNT];
-    iree_device_size_t
-        binding_lengths[IREE_HAL_LOCAL_MAX_DESCRIPTOR_SET_COUNT *
-                        IREE_HAL_LOCAL_MAX_DESCRIPTOR_BINDING_COUNT];
-
-    // All available push constants updated each time push_constants is called.
-    // Reset only with the command buffer and otherwise will maintain its values
-    // during recording to allow for partial push_constants updates.
-    uint32_t push_constants[IREE_HAL_LOCAL_MAX_PUSH_CONSTANT_COUNT];
-  } state;
+  // Allocated from the arena on begin and cleared on end so that the ~4KB of
+  // binding tables don't live in the command buffer for its whole lifetime.
+  iree_hal_task_command_buffer_state_t* state;
 } iree_hal_task_command_buffer_t;
 
 static const iree_hal_command_buffer_vtable_t
@@ -111,28 +122,30 @@ iree_status_t iree_hal_task_command_buffer_create(
     iree_hal_command_buffer_mode_t mode,
     iree_hal_command_category_t command_categories,
     iree_hal_queue_affinity_t queue_affinity, iree_host_size_t binding_capacity,
-    iree_arena_block_pool_t* block_pool, iree_allocator_t host_allocator,
+    iree_arena_block_pool_t* block_pool,
+    iree_hal_dispatch_profile_t* dispatch_profile,
+    iree_allocator_t host_allocator,
     iree_hal_command_buffer_t** out_command_buffer) {
   IREE_ASSERT_ARGUMENT(out_command_buffer);
   *out_command_buffer = NULL;
 
   if (!iree_all_bits_set(mode, IREE_HAL_COMMAND_BUFFER_MODE_ONE_SHOT)) {
-    // If we want reuse we'd need to support duplicating the task DAG after
-    // recording or have some kind of copy-on-submit behavior that does so if
-    // a command buffer is submitted for execution twice. Allowing for the same
-    // command buffer to be enqueued multiple times would be fine so long as
-    // execution doesn't overlap (`cmdbuf|cmdbuf` vs
-    // `cmdbuf -> semaphore -> cmdbuf`) though we'd still need to be careful
-    // that we did the enqueuing and reset of the task structures at the right
-    // times. Definitely something that'll be useful in the future... but not
-    // today :)
+    // Task DAGs are consumed by execution and can't be re-issued. Reusable
+    // command buffers are recorded as deferred command buffers by the device
+    // and replayed into a one-shot task command buffer on each submission.
+    // Retaining and resetting the DAG in place would avoid the replay but
+    // requires care that execution never overlaps (`cmdbuf|cmdbuf` vs
+    // `cmdbuf -> semaphore -> cmdbuf`) and that the task structures are reset
+    // at the right times.
     return iree_make_status(IREE_STATUS_UNIMPLEMENTED,
                             "only one-shot command buffer usage is supported");
   }
   if (binding_capacity > 0) {
-    // TODO(#10144): support indirect command buffers with binding tables.
+    // Indirect command buffers are recorded as deferred command buffers by the
+    // device and replayed into task command buffers with resolved bindings.
     return iree_make_status(IREE_STATUS_UNIMPLEMENTED,
-                            "indirect command buffers not yet implemented");
+                            "indirect task command buffers are not supported; "
+                            "record as a deferred command buffer");
   }
 
   IREE_TRACE_ZONE_BEGIN(z0);
@@ -146,10 +159,10 @@ iree_status_t iree_hal_task_command_buffer_create(
         &iree_hal_task_command_buffer_vtable, &command_buffer->base);
     command_buffer->host_allocator = host_allocator;
     command_buffer->scope = scope;
+    command_buffer->dispatch_profile = dispatch_profile;
     iree_arena_initialize(block_pool, &command_buffer->arena);
     iree_task_list_initialize(&command_buffer->root_tasks);
     iree_task_list_initialize(&command_buffer->leaf_tasks);
-    memset(&command_buffer->state, 0, sizeof(command_buffer->state));
     status = iree_hal_resource_set_allocate(block_pool,
                                             &command_buffer->resource_set);
   }
@@ -170,7 +183,7 @@ static void iree_hal_task_command_buffer_destroy(
   iree_allocator_t host_allocator = command_buffer->host_allocator;
   IREE_TRACE_ZONE_BEGIN(z0);
 
-  memset(&command_buffer->state, 0, sizeof(command_buffer->state));
+  command_buffer->state = NULL;
   iree_task_list_discard(&command_buffer->leaf_tasks);
   iree_task_list_discard(&command_buffer->root_tasks);
   iree_arena_deinitialize(&command_buffer->arena);
@@ -210,6 +223,10 @@ static iree_status_t iree_hal_task_command_buffer_begin(
     return iree_make_status(IREE_STATUS_FAILED_PRECONDITION,
                             "command buffer cannot be re-recorded");
   }
+  IREE_RETURN_IF_ERROR(iree_arena_allocate(&command_buffer->arena,
+                                           sizeof(*command_buffer->state),
+                                           (void**)&command_buffer->state));
+  memset(command_buffer->state, 0, sizeof(*command_buffer->state));
   return iree_ok_status();
 }
 
@@ -230,6 +247,10 @@ static iree_status_t iree_hal_task_command_buffer_end(
                         &command_buffer->root_tasks);
   }
 
+  // Recording state is no longer needed; the storage remains in the arena
+  // until the command buffer is destroyed.
+  command_buffer->state = NULL;
+
   return iree_ok_status();
 }
 
@@ -240,14 +261,14 @@ static iree_status_t iree_hal_task_command_buffer_end(
 // tasks that will be recorded after (if any).
 static iree_status_t iree_hal_task_command_buffer_flush_tasks(
     iree_hal_task_command_buffer_t* command_buffer) {
-  iree_task_barrier_t* open_barrier = command_buffer->state.open_barrier;
+  iree_task_barrier_t* open_barrier = command_buffer->state->open_barrier;
   if (open_barrier != NULL) {
     // There is an open barrier we need to fixup the fork out to all of the open
     // tasks that were recorded after it.
     iree_task_t* task_head =
-        iree_task_list_front(&command_buffer->state.open_tasks);
+        iree_task_list_front(&command_buffer->state->open_tasks);
     iree_host_size_t dependent_task_count =
-        command_buffer->state.open_task_count;
+        command_buffer->state->open_task_count;
     if (dependent_task_count == 1) {
       // Special-case: only one open task so we can avoid the additional barrier
       // overhead by reusing the completion task.
@@ -269,14 +290,14 @@ static iree_status_t iree_hal_task_command_buffer_flush_tasks(
                                             dependent_tasks);
     }
   }
-  command_buffer->state.open_barrier = NULL;
+  command_buffer->state->open_barrier = NULL;
 
   // Move the open tasks to the tail as they represent the first half of the
   // *next* barrier that will be inserted.
-  if (command_buffer->state.open_task_count > 0) {
-    iree_task_list_move(&command_buffer->state.open_tasks,
+  if (command_buffer->state->open_task_count > 0) {
+    iree_task_list_move(&command_buffer->state->open_tasks,
                         &command_buffer->leaf_tasks);
-    command_buffer->state.open_task_count = 0;
+    command_buffer->state->open_task_count = 0;
   }
 
   return iree_ok_status();
@@ -326,8 +347,8 @@ static iree_status_t iree_hal_task_command_buffer_emit_global_barrier(
   iree_task_list_push_back(&command_buffer->leaf_tasks, &barrier->header);
 
   // NOTE: all new tasks emitted will be executed after this barrier.
-  command_buffer->state.open_barrier = barrier;
-  command_buffer->state.open_task_count = 0;
+  command_buffer->state->open_barrier = barrier;
+  command_buffer->state->open_task_count = 0;
 
   return iree_ok_status();
 }
@@ -336,14 +357,14 @@ static iree_status_t iree_hal_task_command_buffer_emit_global_barrier(
 // scope (after state.open_barrier and before the next barrier).
 static iree_status_t iree_hal_task_command_buffer_emit_execution_task(
     iree_hal_task_command_buffer_t* command_buffer, iree_task_t* task) {
-  if (command_buffer->state.open_barrier == NULL) {
+  if (command_buffer->state->open_barrier == NULL) {
     // If there is no open barrier then we are at the head and going right into
     // the task DAG.
     iree_task_list_push_back(&command_buffer->leaf_tasks, task);
   } else {
     // Append to the open task list that will be flushed to the open barrier.
-    iree_task_list_push_back(&command_buffer->state.open_tasks, task);
-    ++command_buffer->state.open_task_count;
+    iree_task_list_push_back(&command_buffer->state->open_tasks, task);
+    ++command_buffer->state->open_task_count;
   }
   return iree_ok_status();
 }
@@ -708,31 +729,77 @@ static iree_status_t iree_hal_task_command_buffer_copy_buffer(
 // iree_hal_command_buffer_collective
 //===----------------------------------------------------------------------===//
 
+// NOTE: collectives block the worker executing them until all participants
+// have contributed. Each is issued as a call isolated by global barriers so
+// that collectives on the same channel execute in recording order as required
+// to match up with the other participants.
+
+typedef struct iree_hal_cmd_collective_t {
+  iree_task_call_t task;
+  iree_hal_channel_t* channel;
+  iree_hal_collective_op_t op;
+  uint32_t param;
+  iree_hal_buffer_binding_t send_binding;
+  iree_hal_buffer_binding_t recv_binding;
+  iree_device_size_t element_count;
+} iree_hal_cmd_collective_t;
+
+static iree_status_t iree_hal_cmd_collective(
+    void* user_context, iree_task_t* task,
+    iree_task_submission_t* pending_submission) {
+  const iree_hal_cmd_collective_t* cmd =
+      (const iree_hal_cmd_collective_t*)user_context;
+  IREE_TRACE_ZONE_BEGIN(z0);
+  iree_status_t status = iree_hal_local_channel_execute(
+      cmd->channel, cmd->op, cmd->param, cmd->send_binding, cmd->recv_binding,
+      cmd->element_count);
+  IREE_TRACE_ZONE_END(z0);
+  return status;
+}
+
 static iree_status_t iree_hal_task_command_buffer_collective(
     iree_hal_command_buffer_t* base_command_buffer, iree_hal_channel_t* channel,
     iree_hal_collective_op_t op, uint32_t param,
     iree_hal_buffer_binding_t send_binding,
     iree_hal_buffer_binding_t recv_binding, iree_device_size_t element_count) {
-  // The channel can be used as a vtable if we want to inject collective APIs -
-  // the device creation function would set up the channel once and we'll
-  // receive it here each time. When interacting with the task system we want to
-  // get wait handles we can model with iree_task_wait_t.
-  //
-  // An example basic flow:
-  //   insert iree_task_call_t:
-  //     chains with prior commands and makes the collective API call
-  //   insert iree_task_wait_t with API wait handle or our event:
-  //     chains with call
-  //
-  // What we probably want to do, though, is group the commands based on
-  // execution barriers. When a new collective command comes in we should
-  // reserve an event from the event pool, create the call to issue the
-  // collective operation, and then track the event in the command buffer state.
-  // When another collective call comes in we'll do the same and append the
-  // event. At the next execution barrier (or non-collective command) we'd
-  // flush to a multi-wait on all of the pending events.
-  return iree_make_status(IREE_STATUS_UNIMPLEMENTED,
-                          "collectives not yet implemented on the task system");
+  iree_hal_task_command_buffer_t* command_buffer =
+      iree_hal_task_command_buffer_cast(base_command_buffer);
+  if (!iree_hal_local_channel_isa(channel)) {
+    return iree_make_status(IREE_STATUS_INVALID_ARGUMENT,
+                            "collectives require a channel created by a local "
+                            "device");
+  }
+
+  IREE_RETURN_IF_ERROR(iree_hal_resource_set_insert(
+      command_buffer->resource_set, 1, &channel));
+  if (send_binding.buffer) {
+    IREE_RETURN_IF_ERROR(iree_hal_resource_set_insert(
+        command_buffer->resource_set, 1, &send_binding.buffer));
+  }
+  if (recv_binding.buffer) {
+    IREE_RETURN_IF_ERROR(iree_hal_resource_set_insert(
+        command_buffer->resource_set, 1, &recv_binding.buffer));
+  }
+
+  iree_hal_cmd_collective_t* cmd = NULL;
+  IREE_RETURN_IF_ERROR(
+      iree_arena_allocate(&command_buffer->arena, sizeof(*cmd), (void**)&cmd));
+  iree_task_call_initialize(
+      command_buffer->scope,
+      iree_task_make_call_closure(iree_hal_cmd_collective, (void*)cmd),
+      &cmd->task);
+  cmd->channel = channel;
+  cmd->op = op;
+  cmd->param = param;
+  cmd->send_binding = send_binding;
+  cmd->recv_binding = recv_binding;
+  cmd->element_count = element_count;
+
+  IREE_RETURN_IF_ERROR(
+      iree_hal_task_command_buffer_emit_global_barrier(command_buffer));
+  IREE_RETURN_IF_ERROR(iree_hal_task_command_buffer_emit_execution_task(
+      command_buffer, &cmd->task.header));
+  return iree_hal_task_command_buffer_emit_global_barrier(command_buffer);
 }
 
 //===----------------------------------------------------------------------===//
@@ -748,13 +815,13 @@ static iree_status_t iree_hal_task_command_buffer_push_constants(
       iree_hal_task_command_buffer_cast(base_command_buffer);
 
   if (IREE_UNLIKELY(offset + values_length >=
-                    sizeof(command_buffer->state.push_constants))) {
+                    sizeof(command_buffer->state->push_constants))) {
     return iree_make_status(IREE_STATUS_INVALID_ARGUMENT,
                             "push constant range %zu (length=%zu) out of range",
                             offset, values_length);
   }
 
-  memcpy((uint8_t*)&command_buffer->state.push_constants + offset, values,
+  memcpy((uint8_t*)&command_buffer->state->push_constants + offset, values,
          values_length);
 
   return iree_ok_status();
@@ -799,9 +866,9 @@ static iree_status_t iree_hal_task_command_buffer_push_descriptor_set(
           bindings[i].buffer, IREE_HAL_MAPPING_MODE_PERSISTENT,
           IREE_HAL_MEMORY_ACCESS_ANY, bindings[i].offset, bindings[i].length,
           &buffer_mapping));
-      command_buffer->state.bindings[binding_ordinal] =
+      command_buffer->state->bindings[binding_ordinal] =
           buffer_mapping.contents.data;
-      command_buffer->state.binding_lengths[binding_ordinal] =
+      command_buffer->state->binding_lengths[binding_ordinal] =
           buffer_mapping.contents.data_length;
     } else {
       // TODO(#10144): stash indirect binding reference in the state table.
@@ -830,6 +897,13 @@ typedef struct iree_hal_cmd_dispatch_t {
   // used (known at compile-time).
   uint16_t binding_count;
 
+  // Profile the dispatch is recorded into when it retires, if profiling.
+  // |start_ns| and |end_ns| are the earliest tile start and latest tile end
+  // across all workers executing the dispatch.
+  iree_hal_dispatch_profile_t* profile;
+  iree_atomic_int64_t start_ns;
+  iree_atomic_int64_t end_ns;
+
   // Following this structure in memory there are 3 tables:
   // - const uint32_t push_constants[push_constant_count];
   // - void* binding_ptrs[binding_count];
@@ -877,15 +951,63 @@ static iree_status_t iree_hal_cmd_dispatch_tile(
           .processor_id = tile_context->processor_id,
           .local_memory = tile_context->local_memory.data,
           .local_memory_size = (size_t)tile_context->local_memory.data_length,
+          .workgroup_range_count = tile_context->tile_count,
       };
-  iree_status_t status = iree_hal_local_executable_issue_call(
+  iree_hal_cmd_dispatch_t* profiled_cmd =
+      cmd->profile ? (iree_hal_cmd_dispatch_t*)cmd : NULL;
+  if (profiled_cmd) {
+    int64_t expected_ns = 0;
+    iree_atomic_compare_exchange_strong_int64(
+        &profiled_cmd->start_ns, &expected_ns, (int64_t)iree_time_now(),
+        iree_memory_order_relaxed, iree_memory_order_relaxed);
+  }
+
+  iree_status_t status = iree_hal_local_executable_issue_call_range(
       cmd->executable, cmd->ordinal, &dispatch_state, &workgroup_state,
-      tile_context->worker_id);
+      tile_context->tile_count, tile_context->worker_id);
+
+  if (profiled_cmd) {
+    int64_t end_ns = (int64_t)iree_time_now();
+    int64_t current_ns = iree_atomic_load_int64(&profiled_cmd->end_ns,
+                                                iree_memory_order_relaxed);
+    while (current_ns < end_ns &&
+           !iree_atomic_compare_exchange_weak_int64(
+               &profiled_cmd->end_ns, &current_ns, end_ns,
+               iree_memory_order_relaxed, iree_memory_order_relaxed)) {
+    }
+  }
 
   IREE_TRACE_ZONE_END(z0);
   return status;
 }
 
+// Appends the execution record of a profiled dispatch as it retires.
+// Called exactly once after all tiles have completed (or the dispatch was
+// discarded, in which case nothing is recorded).
+static void iree_hal_cmd_dispatch_profile_cleanup(
+    iree_task_t* task, iree_status_code_t status_code) {
+  iree_hal_cmd_dispatch_t* cmd = (iree_hal_cmd_dispatch_t*)task;
+  if (status_code != IREE_STATUS_OK) return;
+  iree_hal_dispatch_profile_record_t record = {
+      .executable_id = (uint64_t)(uintptr_t)cmd->executable,
+      .entry_point = cmd->ordinal,
+      .start_ns =
+          iree_atomic_load_int64(&cmd->start_ns, iree_memory_order_relaxed),
+      .end_ns = iree_atomic_load_int64(&cmd->end_ns, iree_memory_order_relaxed),
+  };
+  const uint32_t* workgroup_count =
+      iree_any_bit_set(cmd->task.header.flags, IREE_TASK_FLAG_DISPATCH_INDIRECT)
+          ? cmd->task.workgroup_count.ptr
+          : cmd->task.workgroup_count.value;
+  memcpy(record.workgroup_count, workgroup_count,
+         sizeof(record.workgroup_count));
+  if (record.start_ns == 0) {
+    // Dispatches with no workgroups retire without executing any tiles.
+    record.start_ns = record.end_ns = (int64_t)iree_time_now();
+  }
+  iree_status_ignore(iree_hal_dispatch_profile_append(cmd->profile, &record));
+}
+
 static iree_status_t iree_hal_task_command_buffer_build_dispatch(
     iree_hal_command_buffer_t* base_command_buffer,
     iree_hal_executable_t* executable, int32_t entry_point,
@@ -929,6 +1051,9 @@ static iree_status_t iree_hal_task_command_buffer_build_dispatch(
   cmd->ordinal = entry_point;
   cmd->push_constant_count = push_constant_count;
   cmd->binding_count = used_binding_count;
+  cmd->profile = command_buffer->dispatch_profile;
+  iree_atomic_store_int64(&cmd->start_ns, 0, iree_memory_order_relaxed);
+  iree_atomic_store_int64(&cmd->end_ns, 0, iree_memory_order_relaxed);
 
   const uint32_t workgroup_count[3] = {workgroup_x, workgroup_y, workgroup_z};
   // TODO(benvanik): expose on API or keep fixed on executable.
@@ -937,6 +1062,13 @@ static iree_status_t iree_hal_task_command_buffer_build_dispatch(
       command_buffer->scope,
       iree_task_make_dispatch_closure(iree_hal_cmd_dispatch_tile, (void*)cmd),
       workgroup_size, workgroup_count, &cmd->task);
+  // Each reservation of workgroups is issued as a single range; executables
+  // supporting ranges process it in one call and the rest are looped over.
+  cmd->task.header.flags |= IREE_TASK_FLAG_DISPATCH_TILE_RANGES;
+  if (cmd->profile) {
+    iree_task_set_cleanup_fn(&cmd->task.header,
+                             iree_hal_cmd_dispatch_profile_cleanup);
+  }
 
   // Tell the task system how much workgroup local memory is required for the
   // dispatch; each invocation of the entry point will have at least as much
@@ -947,10 +1079,15 @@ static iree_status_t iree_hal_task_command_buffer_build_dispatch(
                 IREE_HAL_WORKGROUP_LOCAL_MEMORY_PAGE_SIZE
           : 0;
 
+  // Executables may declare that they need denormals preserved. Workers only
+  // change their FPU state when consecutive dispatches disagree.
+  cmd->task.fpu_state_flags =
+      iree_hal_local_executable_fpu_state_flags(local_executable, entry_point);
+
   // Copy only the push constant range used by the executable.
   uint8_t* cmd_ptr = (uint8_t*)cmd + sizeof(*cmd);
   uint32_t* push_constants = (uint32_t*)cmd_ptr;
-  memcpy(push_constants, command_buffer->state.push_constants,
+  memcpy(push_constants, command_buffer->state->push_constants,
          push_constant_count * sizeof(*push_constants));
   cmd_ptr += push_constant_count * sizeof(*push_constants);
 
@@ -972,8 +1109,9 @@ static iree_status_t iree_hal_task_command_buffer_build_dispatch(
     int binding_ordinal = binding_base + mask_offset;
     binding_base += mask_offset + 1;
     used_binding_mask = iree_shr(used_binding_mask, mask_offset + 1);
-    binding_ptrs[i] = command_buffer->state.bindings[binding_ordinal];
-    binding_lengths[i] = command_buffer->state.binding_lengths[binding_ordinal];
+    binding_ptrs[i] = command_buffer->state->bindings[binding_ordinal];
+    binding_lengths[i] =
+        command_buffer->state->binding_lengths[binding_ordinal];
     if (!binding_ptrs[i]) {
       return iree_make_status(IREE_STATUS_FAILED_PRECONDITION,
                               "(flat) binding %d is NULL", binding_ordinal);
@@ -1034,16 +1172,38 @@ static iree_status_t iree_hal_task_command_buffer_execute_commands(
     iree_hal_command_buffer_t* base_command_buffer,
     iree_hal_command_buffer_t* base_commands,
     iree_hal_buffer_binding_table_t binding_table) {
-  // TODO(#10144): support indirect command buffers by using deferred command
-  // buffers or caching the task topology (probably not worth the tracking).
-  // If we could separate the topology that referenced the binding table we'd
-  // be able to reissue but not concurrently (as each task can only be in flight
-  // as a singleton) - which may be enough in many cases but adds complexity to
-  // tracking as we'd need to either enforce serialization of subsequent
-  // submissions or copy-on-write-style clone the topology for each additional
-  // concurrent submission.
-  return iree_make_status(IREE_STATUS_UNIMPLEMENTED,
-                          "indirect command buffers not yet implemented");
+  iree_hal_task_command_buffer_t* command_buffer =
+      iree_hal_task_command_buffer_cast(base_command_buffer);
+
+  // Task DAGs are consumed by execution of the primary command buffer and
+  // cannot be shared across multiple executions. Nested command buffers are
+  // instead recorded as deferred command buffers and replayed inline here with
+  // their indirect bindings resolved against the provided binding table.
+  // Caching the task topology would avoid the replay but each task can only be
+  // in flight as a singleton and we'd need to either enforce serialization of
+  // subsequent submissions or clone the topology per concurrent submission.
+  if (!iree_hal_deferred_command_buffer_isa(base_commands)) {
+    return iree_make_status(IREE_STATUS_UNIMPLEMENTED,
+                            "only deferred nested command buffers are "
+                            "supported");
+  }
+
+  IREE_TRACE_ZONE_BEGIN(z0);
+  iree_status_t status = iree_hal_resource_set_insert(
+      command_buffer->resource_set, 1, &base_commands);
+  for (iree_host_size_t i = 0;
+       iree_status_is_ok(status) && i < binding_table.count; ++i) {
+    if (binding_table.bindings[i].buffer) {
+      status = iree_hal_resource_set_insert(
+          command_buffer->resource_set, 1, &binding_table.bindings[i].buffer);
+    }
+  }
+  if (iree_status_is_ok(status)) {
+    status = iree_hal_deferred_command_buffer_apply_commands(
+        base_commands, base_command_buffer, binding_table);
+  }
+  IREE_TRACE_ZONE_END(z0);
+  return status;
 }
 
 //===----------------------------------------------------------------------===//
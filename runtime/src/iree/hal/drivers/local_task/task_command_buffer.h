@@ -11,6 +11,7 @@
 #include "iree/base/internal/arena.h"
 #include "iree/hal/api.h"
 #include "iree/hal/drivers/local_task/task_queue_state.h"
+#include "iree/hal/utils/dispatch_profile.h"
 #include "iree/task/scope.h"
 #include "iree/task/task.h"
 
@@ -18,12 +19,17 @@
 extern "C" {
 #endif  // __cplusplus
 
+// Creates a one-shot command buffer that builds a task DAG for submission to
+// |scope|. If |dispatch_profile| is provided the execution of each dispatch
+// will be recorded into it as the dispatch retires.
 iree_status_t iree_hal_task_command_buffer_create(
     iree_hal_device_t* device, iree_task_scope_t* scope,
     iree_hal_command_buffer_mode_t mode,
     iree_hal_command_category_t command_categories,
     iree_hal_queue_affinity_t queue_affinity, iree_host_size_t binding_capacity,
-    iree_arena_block_pool_t* block_pool, iree_allocator_t host_allocator,
+    iree_arena_block_pool_t* block_pool,
+    iree_hal_dispatch_profile_t* dispatch_profile,
+    iree_allocator_t host_allocator,
     iree_hal_command_buffer_t** out_command_buffer);
 
 // Returns true if |command_buffer| is a task system command buffer.
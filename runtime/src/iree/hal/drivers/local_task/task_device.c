@@ -12,15 +12,19 @@
 
 #include "iree/base/internal/arena.h"
 #include "iree/base/internal/cpu.h"
+#include "iree/base/internal/math.h"
 #include "iree/base/tracing.h"
 #include "iree/hal/drivers/local_task/task_command_buffer.h"
 #include "iree/hal/drivers/local_task/task_event.h"
 #include "iree/hal/drivers/local_task/task_queue.h"
 #include "iree/hal/drivers/local_task/task_semaphore.h"
 #include "iree/hal/local/executable_environment.h"
+#include "iree/hal/local/local_channel.h"
 #include "iree/hal/local/local_executable_cache.h"
 #include "iree/hal/local/local_pipeline_layout.h"
 #include "iree/hal/utils/buffer_transfer.h"
+#include "iree/hal/utils/deferred_command_buffer.h"
+#include "iree/hal/utils/dispatch_profile.h"
 
 typedef struct iree_hal_task_device_t {
   iree_hal_resource_t resource;
@@ -39,6 +43,24 @@ typedef struct iree_hal_task_device_t {
   iree_allocator_t host_allocator;
   iree_hal_allocator_t* device_allocator;
 
+  // Defaults for collective channels created without explicit parameters.
+  // The ID is stored in the trailing storage of the device.
+  iree_string_view_t channel_default_id;
+  int32_t channel_default_rank;
+  int32_t channel_default_count;
+  iree_duration_t channel_timeout;
+
+  // Whether threads waiting on device semaphores are donated to the executor.
+  bool donate_caller;
+
+  // Dispatch records captured while profiling with
+  // IREE_HAL_DEVICE_PROFILING_MODE_DISPATCH_TIMESTAMPS. Only command buffers
+  // issued while |dispatch_profiling| is set record into the profile.
+  bool dispatch_profiling;
+  iree_hal_dispatch_profile_t dispatch_profile;
+  // Path the dispatch profile is written to when profiling ends, if any.
+  char* dispatch_profile_path;
+
   iree_host_size_t queue_count;
   iree_hal_task_queue_t queues[];
 } iree_hal_task_device_t;
@@ -54,6 +76,13 @@ static iree_hal_task_device_t* iree_hal_task_device_cast(
 void iree_hal_task_device_params_initialize(
     iree_hal_task_device_params_t* out_params) {
   out_params->arena_block_size = 32 * 1024;
+  out_params->high_priority_queue_mask = 0;
+  out_params->low_priority_queue_mask = 0;
+  out_params->channel_default_id = iree_string_view_empty();
+  out_params->channel_default_rank = 0;
+  out_params->channel_default_count = 1;
+  out_params->channel_timeout = IREE_HAL_LOCAL_CHANNEL_DEFAULT_TIMEOUT;
+  out_params->donate_caller = false;
 }
 
 static iree_status_t iree_hal_task_device_check_params(
@@ -66,9 +95,28 @@ static iree_status_t iree_hal_task_device_check_params(
     return iree_make_status(IREE_STATUS_INVALID_ARGUMENT,
                             "must have at least one queue");
   }
+  if (params->high_priority_queue_mask & params->low_priority_queue_mask) {
+    return iree_make_status(IREE_STATUS_INVALID_ARGUMENT,
+                            "queues cannot be both high and low priority");
+  }
+  if (params->channel_default_count < 1 || params->channel_default_rank < 0 ||
+      params->channel_default_rank >= params->channel_default_count) {
+    return iree_make_status(IREE_STATUS_INVALID_ARGUMENT,
+                            "default channel rank %d out of range for %d "
+                            "participants",
+                            params->channel_default_rank,
+                            params->channel_default_count);
+  }
   return iree_ok_status();
 }
 
+// Returns the profile dispatches should be recorded into or NULL if the device
+// is not currently profiling dispatches.
+static iree_hal_dispatch_profile_t*
+iree_hal_task_device_active_dispatch_profile(iree_hal_task_device_t* device) {
+  return device->dispatch_profiling ? &device->dispatch_profile : NULL;
+}
+
 // Returns an event pool used for device-wide system event handles.
 // Each queue executor will have its own (potentially shared) pool and prefer
 // that but generic resource requests (creating semaphores, etc) will use this.
@@ -98,7 +146,8 @@ iree_status_t iree_hal_task_device_create(
   iree_host_size_t struct_size = sizeof(*device) +
                                  queue_count * sizeof(*device->queues) +
                                  loader_count * sizeof(*device->loaders);
-  iree_host_size_t total_size = struct_size + identifier.size;
+  iree_host_size_t total_size =
+      struct_size + identifier.size + params->channel_default_id.size;
   iree_status_t status =
       iree_allocator_malloc(host_allocator, total_size, (void**)&device);
   if (iree_status_is_ok(status)) {
@@ -107,9 +156,18 @@ iree_status_t iree_hal_task_device_create(
                                  &device->resource);
     iree_string_view_append_to_buffer(identifier, &device->identifier,
                                       (char*)device + struct_size);
+    iree_string_view_append_to_buffer(
+        params->channel_default_id, &device->channel_default_id,
+        (char*)device + struct_size + identifier.size);
+    device->channel_default_rank = params->channel_default_rank;
+    device->channel_default_count = params->channel_default_count;
+    device->channel_timeout = params->channel_timeout;
+    device->donate_caller = params->donate_caller;
     device->host_allocator = host_allocator;
     device->device_allocator = device_allocator;
     iree_hal_allocator_retain(device_allocator);
+    iree_hal_dispatch_profile_initialize(host_allocator,
+                                         &device->dispatch_profile);
 
     iree_arena_block_pool_initialize(4096, host_allocator,
                                      &device->small_block_pool);
@@ -128,7 +186,14 @@ iree_status_t iree_hal_task_device_create(
     device->queue_count = queue_count;
     for (iree_host_size_t i = 0; i < device->queue_count; ++i) {
       // TODO(benvanik): add a number to each queue ID.
-      iree_hal_task_queue_initialize(device->identifier, queue_executors[i],
+      iree_task_priority_t priority = IREE_TASK_PRIORITY_NORMAL;
+      if (i < 64 && (params->high_priority_queue_mask & (1ull << i))) {
+        priority = IREE_TASK_PRIORITY_HIGH;
+      } else if (i < 64 && (params->low_priority_queue_mask & (1ull << i))) {
+        priority = IREE_TASK_PRIORITY_LOW;
+      }
+      iree_hal_task_queue_initialize(device->identifier, priority,
+                                     queue_executors[i],
                                      &device->small_block_pool,
                                      &device->queues[i]);
     }
@@ -155,6 +220,8 @@ static void iree_hal_task_device_destroy(iree_hal_device_t* base_device) {
     iree_hal_executable_loader_release(device->loaders[i]);
   }
   iree_hal_allocator_release(device->device_allocator);
+  iree_hal_dispatch_profile_deinitialize(&device->dispatch_profile);
+  iree_allocator_free(host_allocator, device->dispatch_profile_path);
   iree_arena_block_pool_deinitialize(&device->large_block_pool);
   iree_arena_block_pool_deinitialize(&device->small_block_pool);
   iree_allocator_free(host_allocator, device);
@@ -243,14 +310,53 @@ static iree_host_size_t iree_hal_task_device_select_queue(
   // TODO(benvanik): evaluate if we want to obscure this mapping a bit so that
   // affinity really means "equivalent affinities map to equivalent queues" and
   // not a specific queue index.
-  return queue_affinity % device->queue_count;
+  //
+  // Affinities are masks of allowed queues (such as those the compiler assigns
+  // to pipeline stages) and we pick the lowest allowed queue. Masks referencing
+  // more queues than the device has wrap around.
+  if (queue_affinity == 0) return 0;
+  return iree_math_count_trailing_zeros_u64(queue_affinity) %
+         device->queue_count;
 }
 
 static iree_status_t iree_hal_task_device_create_channel(
     iree_hal_device_t* base_device, iree_hal_queue_affinity_t queue_affinity,
     iree_hal_channel_params_t params, iree_hal_channel_t** out_channel) {
-  return iree_make_status(IREE_STATUS_UNIMPLEMENTED,
-                          "collectives not implemented");
+  iree_hal_task_device_t* device = iree_hal_task_device_cast(base_device);
+
+  // Try to use the ID specified in the parameters and fall back to the default.
+  // Unlike NCCL IDs these are arbitrary bytes only used to find the other
+  // participants on the host.
+  iree_const_byte_span_t id = params.id;
+  if (iree_const_byte_span_is_empty(id)) {
+    id = iree_make_const_byte_span(device->channel_default_id.data,
+                                   device->channel_default_id.size);
+  }
+
+  // Users can either specify a specific rank or allow this device
+  // implementation to decide. This allows us to run the same programs acting as
+  // different ranks by setting flags/environment variables/API options/etc.
+  int32_t rank = params.rank;
+  if (rank == IREE_HAL_CHANNEL_RANK_DEFAULT) {
+    rank = device->channel_default_rank;
+  }
+  int32_t count = params.count;
+  if (count == IREE_HAL_CHANNEL_COUNT_DEFAULT) {
+    count = device->channel_default_count;
+  }
+
+  if (count > 1 && iree_const_byte_span_is_empty(id)) {
+    return iree_make_status(IREE_STATUS_INVALID_ARGUMENT,
+                            "no default channel ID specified for a channel "
+                            "with %d participants",
+                            count);
+  }
+
+  // NOTE: channels are host memory shared by all queues so |queue_affinity|
+  // does not need to select a single queue as with device collectives.
+  return iree_hal_local_channel_create(id, rank, count,
+                                       device->channel_timeout,
+                                       device->host_allocator, out_channel);
 }
 
 static iree_status_t iree_hal_task_device_create_command_buffer(
@@ -259,11 +365,27 @@ static iree_status_t iree_hal_task_device_create_command_buffer(
     iree_hal_queue_affinity_t queue_affinity, iree_host_size_t binding_capacity,
     iree_hal_command_buffer_t** out_command_buffer) {
   iree_hal_task_device_t* device = iree_hal_task_device_cast(base_device);
+  if (!iree_all_bits_set(mode, IREE_HAL_COMMAND_BUFFER_MODE_ONE_SHOT) ||
+      iree_all_bits_set(mode, IREE_HAL_COMMAND_BUFFER_MODE_NESTED) ||
+      binding_capacity > 0) {
+    // Task DAGs are consumed by execution so reusable command buffers are
+    // recorded once into a compact command list and replayed into a one-shot
+    // task command buffer on each submission. This skips recording from the
+    // program (and all of its validation) on every invocation.
+    //
+    // Nested command buffers and those using binding tables are recorded the
+    // same way and replayed into the primary task command buffer when it
+    // executes them, resolving indirect bindings at that time.
+    return iree_hal_deferred_command_buffer_create(
+        base_device, mode, command_categories, binding_capacity,
+        &device->large_block_pool, device->host_allocator, out_command_buffer);
+  }
   iree_host_size_t queue_index = iree_hal_task_device_select_queue(
       device, command_categories, queue_affinity);
   return iree_hal_task_command_buffer_create(
       base_device, &device->queues[queue_index].scope, mode, command_categories,
       queue_affinity, binding_capacity, &device->large_block_pool,
+      iree_hal_task_device_active_dispatch_profile(device),
       device->host_allocator, out_command_buffer);
 }
 
@@ -290,12 +412,14 @@ static iree_status_t iree_hal_task_device_create_executable_cache(
   iree_hal_task_device_t* device = iree_hal_task_device_cast(base_device);
 
   // Sum up the total worker count across all queues so that the loaders can
-  // preallocate worker-specific storage.
+  // preallocate worker-specific storage. A donated caller executes as one
+  // additional worker of its executor.
   iree_host_size_t total_worker_count = 0;
   for (iree_host_size_t i = 0; i < device->queue_count; ++i) {
     total_worker_count +=
         iree_task_executor_worker_count(device->queues[i].executor);
   }
+  if (device->donate_caller) ++total_worker_count;
 
   return iree_hal_local_executable_cache_create(
       identifier, total_worker_count, device->loader_count, device->loaders,
@@ -316,9 +440,13 @@ static iree_status_t iree_hal_task_device_create_semaphore(
     iree_hal_device_t* base_device, uint64_t initial_value,
     iree_hal_semaphore_t** out_semaphore) {
   iree_hal_task_device_t* device = iree_hal_task_device_cast(base_device);
+  iree_task_executor_t* donation_executor =
+      device->donate_caller && device->queue_count > 0
+          ? device->queues[0].executor
+          : NULL;
   return iree_hal_task_semaphore_create(
-      iree_hal_task_device_shared_event_pool(device), initial_value,
-      device->host_allocator, out_semaphore);
+      iree_hal_task_device_shared_event_pool(device), donation_executor,
+      initial_value, device->host_allocator, out_semaphore);
 }
 
 static iree_hal_semaphore_compatibility_t
@@ -374,13 +502,70 @@ static iree_status_t iree_hal_task_device_queue_execute(
   // NOTE: today we are not discriminating queues based on command type.
   iree_host_size_t queue_index = iree_hal_task_device_select_queue(
       device, IREE_HAL_COMMAND_CATEGORY_ANY, queue_affinity);
-  iree_hal_submission_batch_t batch = {
-      .wait_semaphores = wait_semaphore_list,
-      .signal_semaphores = signal_semaphore_list,
-      .command_buffer_count = command_buffer_count,
-      .command_buffers = command_buffers,
-  };
-  return iree_hal_task_queue_submit(&device->queues[queue_index], 1, &batch);
+  iree_hal_task_queue_t* queue = &device->queues[queue_index];
+
+  // Fast path for when all command buffers are one-shot task command buffers.
+  bool any_deferred = false;
+  for (iree_host_size_t i = 0; i < command_buffer_count && !any_deferred; ++i) {
+    any_deferred = iree_hal_deferred_command_buffer_isa(command_buffers[i]);
+  }
+  if (!any_deferred) {
+    iree_hal_submission_batch_t batch = {
+        .wait_semaphores = wait_semaphore_list,
+        .signal_semaphores = signal_semaphore_list,
+        .command_buffer_count = command_buffer_count,
+        .command_buffers = command_buffers,
+    };
+    return iree_hal_task_queue_submit(queue, 1, &batch);
+  }
+
+  // Replay each reusable command buffer into a transient task command buffer
+  // that is retained by the submission until it retires.
+  IREE_TRACE_ZONE_BEGIN(z0);
+  iree_hal_command_buffer_t** issued_command_buffers = NULL;
+  IREE_RETURN_AND_END_ZONE_IF_ERROR(
+      z0, iree_allocator_malloc(
+              device->host_allocator,
+              command_buffer_count * sizeof(*issued_command_buffers),
+              (void**)&issued_command_buffers));
+  iree_status_t status = iree_ok_status();
+  for (iree_host_size_t i = 0; i < command_buffer_count; ++i) {
+    iree_hal_command_buffer_t* command_buffer = command_buffers[i];
+    if (!iree_hal_deferred_command_buffer_isa(command_buffer)) {
+      issued_command_buffers[i] = command_buffer;
+      iree_hal_command_buffer_retain(command_buffer);
+      continue;
+    }
+    status = iree_hal_task_command_buffer_create(
+        base_device, &queue->scope,
+        iree_hal_command_buffer_mode(command_buffer) |
+            IREE_HAL_COMMAND_BUFFER_MODE_ONE_SHOT,
+        iree_hal_command_buffer_allowed_categories(command_buffer),
+        queue_affinity, /*binding_capacity=*/0, &device->large_block_pool,
+        iree_hal_task_device_active_dispatch_profile(device),
+        device->host_allocator, &issued_command_buffers[i]);
+    if (iree_status_is_ok(status)) {
+      status = iree_hal_deferred_command_buffer_apply(
+          command_buffer, issued_command_buffers[i],
+          iree_hal_buffer_binding_table_empty());
+    }
+    if (!iree_status_is_ok(status)) break;
+  }
+  if (iree_status_is_ok(status)) {
+    iree_hal_submission_batch_t batch = {
+        .wait_semaphores = wait_semaphore_list,
+        .signal_semaphores = signal_semaphore_list,
+        .command_buffer_count = command_buffer_count,
+        .command_buffers = issued_command_buffers,
+    };
+    status = iree_hal_task_queue_submit(queue, 1, &batch);
+  }
+  for (iree_host_size_t i = 0; i < command_buffer_count; ++i) {
+    iree_hal_command_buffer_release(issued_command_buffers[i]);
+  }
+  iree_allocator_free(device->host_allocator, issued_command_buffers);
+  IREE_TRACE_ZONE_END(z0);
+  return status;
 }
 
 static iree_status_t iree_hal_task_device_queue_flush(
@@ -393,6 +578,18 @@ static iree_status_t iree_hal_task_device_wait_semaphores(
     iree_hal_device_t* base_device, iree_hal_wait_mode_t wait_mode,
     const iree_hal_semaphore_list_t semaphore_list, iree_timeout_t timeout) {
   iree_hal_task_device_t* device = iree_hal_task_device_cast(base_device);
+  if (device->donate_caller && wait_mode == IREE_HAL_WAIT_MODE_ALL &&
+      semaphore_list.count > 1) {
+    // Waiting on each semaphore in turn lets every wait donate the caller;
+    // a multi-wait on the wait set would just block.
+    iree_time_t deadline_ns = iree_timeout_as_deadline_ns(timeout);
+    for (iree_host_size_t i = 0; i < semaphore_list.count; ++i) {
+      IREE_RETURN_IF_ERROR(iree_hal_semaphore_wait(
+          semaphore_list.semaphores[i], semaphore_list.payload_values[i],
+          iree_make_deadline(deadline_ns)));
+    }
+    return iree_ok_status();
+  }
   return iree_hal_task_semaphore_multi_wait(
       wait_mode, semaphore_list, timeout,
       iree_hal_task_device_shared_event_pool(device),
@@ -400,9 +597,26 @@ static iree_status_t iree_hal_task_device_wait_semaphores(
 }
 
 static iree_status_t iree_hal_task_device_profiling_begin(
-    iree_hal_device_t* device,
+    iree_hal_device_t* base_device,
     const iree_hal_device_profiling_options_t* options) {
-  // Unimplemented (and that's ok).
+  iree_hal_task_device_t* device = iree_hal_task_device_cast(base_device);
+  if (iree_all_bits_set(options->mode,
+                        IREE_HAL_DEVICE_PROFILING_MODE_DISPATCH_TIMESTAMPS)) {
+    iree_allocator_free(device->host_allocator, device->dispatch_profile_path);
+    device->dispatch_profile_path = NULL;
+    if (options->file_path) {
+      iree_host_size_t path_length = strlen(options->file_path);
+      IREE_RETURN_IF_ERROR(iree_allocator_malloc(
+          device->host_allocator, path_length + 1,
+          (void**)&device->dispatch_profile_path));
+      memcpy(device->dispatch_profile_path, options->file_path,
+             path_length + 1);
+    }
+    iree_hal_dispatch_profile_reset(&device->dispatch_profile);
+    device->dispatch_profiling = true;
+  }
+
+  // Other modes are unimplemented (and that's ok).
   // We could hook in to vendor APIs (Intel/ARM/etc) or generic perf infra:
   // https://man7.org/linux/man-pages/man2/perf_event_open.2.html
   // Capturing things like:
@@ -414,9 +628,22 @@ static iree_status_t iree_hal_task_device_profiling_begin(
 }
 
 static iree_status_t iree_hal_task_device_profiling_end(
-    iree_hal_device_t* device) {
-  // Unimplemented (and that's ok).
-  return iree_ok_status();
+    iree_hal_device_t* base_device) {
+  iree_hal_task_device_t* device = iree_hal_task_device_cast(base_device);
+  if (!device->dispatch_profiling) return iree_ok_status();
+
+  // Dispatches record themselves as they retire so all work issued while
+  // profiling must have completed for the capture to be complete.
+  device->dispatch_profiling = false;
+  iree_status_t status = iree_ok_status();
+  if (device->dispatch_profile_path) {
+    status = iree_hal_dispatch_profile_write_file(
+        &device->dispatch_profile, device->dispatch_profile_path);
+    iree_allocator_free(device->host_allocator, device->dispatch_profile_path);
+    device->dispatch_profile_path = NULL;
+  }
+  iree_hal_dispatch_profile_reset(&device->dispatch_profile);
+  return status;
 }
 
 static const iree_hal_device_vtable_t iree_hal_task_device_vtable = {
@@ -23,6 +23,34 @@ typedef struct iree_hal_task_device_params_t {
   // Larger sizes will lower overhead and ensure the heap isn't hit for
   // transient allocations while also increasing memory consumption.
   iree_host_size_t arena_block_size;
+
+  // Bitmasks of queue indices whose submissions run at high or low priority.
+  // Bit i corresponds to the queue at index i as selected by the queue
+  // affinity of submissions such as iree_hal_device_queue_execute. Queues not
+  // in either mask run at normal priority. Workers prefer ready tasks from
+  // higher priority queues and the executor may preempt lower priority
+  // dispatches in favor of them (see
+  // IREE_TASK_SCHEDULING_MODE_PRIORITIZE_LATENCY).
+  uint64_t high_priority_queue_mask;
+  uint64_t low_priority_queue_mask;
+
+  // Default ID used for collective channels when none is provided by the
+  // program. Participants using the same ID on the same host join the same
+  // channel. Copied during device creation.
+  iree_string_view_t channel_default_id;
+  // Default rank of this device in collective channels.
+  int32_t channel_default_rank;
+  // Default number of participants in collective channels.
+  int32_t channel_default_count;
+  // Maximum duration a channel participant waits on the others when joining
+  // and in each round of a collective before the channel is aborted.
+  iree_duration_t channel_timeout;
+
+  // Donates threads blocked waiting on device semaphores to the executor of
+  // the first queue so that they execute tasks until their wait resolves
+  // instead of sleeping. Lowers latency by skipping a worker wake and lets a
+  // submission use the waiting thread in addition to the workers.
+  bool donate_caller;
 } iree_hal_task_device_params_t;
 
 // Initializes |out_params| to default values.
@@ -56,6 +56,7 @@ iree_status_t iree_hal_task_driver_create(
   //   + loaders[] VLA
   // - queue_executors[]
   // - identifier string
+  // - default channel ID string
   iree_hal_task_driver_t* driver = NULL;
   iree_host_size_t struct_size =
       sizeof(*driver) + loader_count * sizeof(*driver->loaders);
@@ -63,6 +64,8 @@ iree_status_t iree_hal_task_driver_create(
   struct_size += queue_count * sizeof(driver->queue_executors[0]);
   iree_host_size_t identifier_offset = struct_size;
   struct_size += identifier.size;
+  iree_host_size_t channel_default_id_offset = struct_size;
+  struct_size += default_params->channel_default_id.size;
   iree_status_t status =
       iree_allocator_malloc(host_allocator, struct_size, (void**)&driver);
   if (iree_status_is_ok(status)) {
@@ -76,6 +79,10 @@ iree_status_t iree_hal_task_driver_create(
                                       (char*)driver + identifier_offset);
     memcpy(&driver->default_params, default_params,
            sizeof(driver->default_params));
+    iree_string_view_append_to_buffer(
+        default_params->channel_default_id,
+        &driver->default_params.channel_default_id,
+        (char*)driver + channel_default_id_offset);
 
     driver->queue_count = queue_count;
     driver->queue_executors =
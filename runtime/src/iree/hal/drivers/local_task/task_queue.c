@@ -9,6 +9,7 @@
 #include <stddef.h>
 #include <string.h>
 
+#include "iree/base/internal/metrics.h"
 #include "iree/base/tracing.h"
 #include "iree/hal/drivers/local_task/task_command_buffer.h"
 #include "iree/hal/drivers/local_task/task_semaphore.h"
@@ -323,6 +324,10 @@ static iree_status_t iree_hal_task_queue_retire_cmd(
   return status;
 }
 
+IREE_METRIC_DEFINE(iree_hal_task_queue_in_flight_metric, GAUGE,
+                   "iree_hal_task_queue_submissions_in_flight",
+                   "Number of local-task queue submissions not yet retired.");
+
 // Cleanup for iree_hal_task_queue_retire_cmd_t that ensures that the arena
 // holding the submission is properly disposed and that semaphores are signaled
 // (or signaled to failure if the command failed).
@@ -330,6 +335,7 @@ static void iree_hal_task_queue_retire_cmd_cleanup(
     iree_task_t* task, iree_status_code_t status_code) {
   iree_hal_task_queue_retire_cmd_t* cmd =
       (iree_hal_task_queue_retire_cmd_t*)task;
+  IREE_METRIC_ADD(iree_hal_task_queue_in_flight_metric, -1);
 
   // Release command buffers now that all are known to have retired.
   // In success cases we try to do this eagerly to allow for more potential
@@ -414,11 +420,13 @@ static iree_status_t iree_hal_task_queue_retire_cmd_allocate(
 //===----------------------------------------------------------------------===//
 
 void iree_hal_task_queue_initialize(iree_string_view_t identifier,
+                                    iree_task_priority_t priority,
                                     iree_task_executor_t* executor,
                                     iree_arena_block_pool_t* block_pool,
                                     iree_hal_task_queue_t* out_queue) {
   IREE_TRACE_ZONE_BEGIN(z0);
   IREE_TRACE_ZONE_APPEND_TEXT(z0, identifier.data, identifier.size);
+  IREE_TRACE_ZONE_APPEND_VALUE(z0, priority);
 
   memset(out_queue, 0, sizeof(*out_queue));
 
@@ -427,6 +435,7 @@ void iree_hal_task_queue_initialize(iree_string_view_t identifier,
   out_queue->block_pool = block_pool;
 
   iree_task_scope_initialize(identifier, &out_queue->scope);
+  iree_task_scope_set_priority(&out_queue->scope, priority);
 
   iree_hal_task_queue_state_initialize(&out_queue->state);
 
@@ -513,6 +522,9 @@ static iree_status_t iree_hal_task_queue_submit_batch(
 
   // Submit the tasks immediately. The executor may queue them up until we
   // force the flush after all batches have been processed.
+  // The in-flight count is bumped before submitting as the retire command may
+  // run on a worker before the submit returns.
+  IREE_METRIC_ADD(iree_hal_task_queue_in_flight_metric, 1);
   iree_task_executor_submit(queue->executor, &submission);
   return iree_ok_status();
 }
@@ -55,6 +55,9 @@ typedef struct iree_hal_task_semaphore_t {
   iree_allocator_t host_allocator;
   iree_event_pool_t* event_pool;
 
+  // Optional executor that waiting threads are donated to.
+  iree_task_executor_t* donation_executor;
+
   // Guards all mutable fields. We expect low contention on semaphores and since
   // iree_slim_mutex_t is (effectively) just a CAS this keeps things simpler
   // than trying to make the entire structure lock-free.
@@ -78,8 +81,9 @@ static iree_hal_task_semaphore_t* iree_hal_task_semaphore_cast(
 }
 
 iree_status_t iree_hal_task_semaphore_create(
-    iree_event_pool_t* event_pool, uint64_t initial_value,
-    iree_allocator_t host_allocator, iree_hal_semaphore_t** out_semaphore) {
+    iree_event_pool_t* event_pool, iree_task_executor_t* donation_executor,
+    uint64_t initial_value, iree_allocator_t host_allocator,
+    iree_hal_semaphore_t** out_semaphore) {
   IREE_ASSERT_ARGUMENT(event_pool);
   IREE_ASSERT_ARGUMENT(out_semaphore);
   *out_semaphore = NULL;
@@ -93,6 +97,8 @@ iree_status_t iree_hal_task_semaphore_create(
                                   &semaphore->base);
     semaphore->host_allocator = host_allocator;
     semaphore->event_pool = event_pool;
+    semaphore->donation_executor = donation_executor;
+    if (donation_executor) iree_task_executor_retain(donation_executor);
 
     iree_slim_mutex_initialize(&semaphore->mutex);
     semaphore->current_value = initial_value;
@@ -114,6 +120,9 @@ static void iree_hal_task_semaphore_destroy(
 
   iree_slim_mutex_deinitialize(&semaphore->mutex);
   iree_status_ignore(semaphore->failure_status);
+  if (semaphore->donation_executor) {
+    iree_task_executor_release(semaphore->donation_executor);
+  }
 
   iree_hal_semaphore_deinitialize(&semaphore->base);
   iree_allocator_free(host_allocator, semaphore);
@@ -313,10 +322,17 @@ static iree_status_t iree_hal_task_semaphore_wait(
   iree_slim_mutex_unlock(&semaphore->mutex);
   if (IREE_UNLIKELY(!iree_status_is_ok(status))) return status;
 
-  // Wait until the timepoint resolves.
+  // Wait until the timepoint resolves, working on behalf of the executor in
+  // the meantime if requested.
   // If satisfied the timepoint is automatically cleaned up and we are done. If
   // the deadline is reached before satisfied then we have to clean it up.
-  status = iree_wait_one(&timepoint.event, deadline_ns);
+  if (semaphore->donation_executor) {
+    status = iree_task_executor_donate_caller(
+        semaphore->donation_executor, iree_event_await(&timepoint.event),
+        iree_make_deadline(deadline_ns));
+  } else {
+    status = iree_wait_one(&timepoint.event, deadline_ns);
+  }
   if (!iree_status_is_ok(status)) {
     iree_hal_semaphore_cancel_timepoint(&semaphore->base, &timepoint.base);
   }
@@ -405,10 +421,22 @@ iree_status_t iree_hal_task_semaphore_multi_wait(
   return status;
 }
 
+static iree_status_t iree_hal_task_semaphore_export_timepoint(
+    iree_hal_semaphore_t* base_semaphore, uint64_t value,
+    iree_wait_primitive_type_t target_type,
+    iree_wait_primitive_t* out_wait_primitive) {
+  iree_hal_task_semaphore_t* semaphore =
+      iree_hal_task_semaphore_cast(base_semaphore);
+  return iree_hal_semaphore_export_timepoint_event(
+      base_semaphore, value, target_type, semaphore->host_allocator,
+      out_wait_primitive);
+}
+
 static const iree_hal_semaphore_vtable_t iree_hal_task_semaphore_vtable = {
     .destroy = iree_hal_task_semaphore_destroy,
     .query = iree_hal_task_semaphore_query,
     .signal = iree_hal_task_semaphore_signal,
     .fail = iree_hal_task_semaphore_fail,
     .wait = iree_hal_task_semaphore_wait,
+    .export_timepoint = iree_hal_task_semaphore_export_timepoint,
 };
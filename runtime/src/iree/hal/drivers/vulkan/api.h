@@ -160,6 +160,22 @@ enum iree_hal_vulkan_device_flag_bits_t {
   // IREE execution to run asynchronously with the graphics workloads.
   // See: https://gpuopen.com/learn/concurrent-execution-asynchronous-queues/
   IREE_HAL_VULKAN_DEVICE_FLAG_DEDICATED_COMPUTE_QUEUE = 1u << 0,
+
+  // Creates pipelines without a VkPipelineCache, forcing the implementation to
+  // compile every pipeline from scratch. This is useful to isolate pipeline
+  // caching behavior and verify compilation behavior.
+  IREE_HAL_VULKAN_DEVICE_FLAG_DISABLE_PIPELINE_CACHE = 1u << 1,
+
+  // Submits command buffers containing only transfer commands to dedicated
+  // transfer queues (such as those backed by DMA engines on discrete GPUs)
+  // when available instead of the dispatch queues. This allows uploads and
+  // downloads to overlap with dispatch work on other queues, ordered by the
+  // timeline semaphores used in submission.
+  //
+  // Transfer queues cannot execute dispatches and transfer command buffers
+  // recorded for them cannot use the unaligned fill polyfill: fills must have
+  // 4-byte aligned offsets and lengths.
+  IREE_HAL_VULKAN_DEVICE_FLAG_DEDICATED_TRANSFER_QUEUES = 1u << 2,
 };
 typedef uint32_t iree_hal_vulkan_device_flags_t;
 
@@ -173,11 +189,37 @@ typedef struct iree_hal_vulkan_device_options_t {
   // much.
   // NOTE: this is temporary and likely to get removed in the future.
   iree_device_size_t large_heap_block_size;
+
+  // Optional path of a file used to persist the device VkPipelineCache across
+  // process runs. If the file exists when the device is created its contents
+  // seed the cache, and the cache is written back to it when the device is
+  // destroyed. The file is not read if |pipeline_cache_data| is provided.
+  iree_string_view_t pipeline_cache_path;
+
+  // Optional serialized VkPipelineCache data used to seed the device pipeline
+  // cache, as returned by iree_hal_vulkan_device_serialize_pipeline_cache.
+  // Only referenced during device creation.
+  //
+  // Data for either option produced by a different physical device or driver
+  // version (as identified by the pipeline cache header) is ignored.
+  iree_const_byte_span_t pipeline_cache_data;
 } iree_hal_vulkan_device_options_t;
 
 IREE_API_EXPORT void iree_hal_vulkan_device_options_initialize(
     iree_hal_vulkan_device_options_t* out_options);
 
+// Serializes the pipeline cache of a Vulkan HAL |device| into a buffer
+// allocated from |host_allocator| that the caller must free. The data can be
+// passed as |pipeline_cache_data| when creating a device in a later run to
+// avoid recompiling the pipelines created so far.
+//
+// Applications that may be terminated without destroying the device (such as
+// on Android) should call this after loading their programs and persist the
+// result themselves instead of relying on |pipeline_cache_path|.
+IREE_API_EXPORT iree_status_t iree_hal_vulkan_device_serialize_pipeline_cache(
+    iree_hal_device_t* device, iree_allocator_t host_allocator,
+    iree_byte_span_t* out_data);
+
 // Creates a Vulkan HAL device that wraps an existing VkDevice.
 //
 // HAL devices created in this way may share Vulkan resources and synchronize
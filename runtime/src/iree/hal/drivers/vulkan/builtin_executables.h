@@ -44,13 +44,20 @@ class BuiltinExecutables {
   // This only implements the unaligned edges of fills, vkCmdFillBuffer should
   // be used for the aligned interior (if any).
   //
-  // |push_constants_to_restore| will be pushed using vkCmdPushConstants over
-  // the bytes used by this call.
+  // This overwrites the first IREE_HAL_VULKAN_BUILTIN_PUSH_CONSTANT_COUNT bytes
+  // of push constants; callers must use RestorePushConstants before any
+  // dispatch that depends on them.
   iree_status_t FillBufferUnaligned(
       VkCommandBuffer command_buffer, DescriptorSetArena* descriptor_set_arena,
       iree_hal_buffer_t* target_buffer, iree_device_size_t target_offset,
       iree_device_size_t length, const void* pattern,
-      iree_host_size_t pattern_length, const void* push_constants_to_restore);
+      iree_host_size_t pattern_length);
+
+  // Pushes the first |length| bytes of |values| over the push constants used
+  // by builtin executables. |length| must be a multiple of 4 and no larger than
+  // IREE_HAL_VULKAN_BUILTIN_PUSH_CONSTANT_COUNT.
+  void RestorePushConstants(VkCommandBuffer command_buffer, const void* values,
+                            iree_host_size_t length);
 
  private:
   VkDeviceHandle* logical_device_ = NULL;
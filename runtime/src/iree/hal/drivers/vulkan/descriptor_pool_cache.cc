@@ -8,6 +8,7 @@
 
 #include <array>
 #include <cstdint>
+#include <iterator>
 #include <ostream>
 
 #include "iree/base/tracing.h"
@@ -19,14 +20,14 @@ namespace vulkan {
 
 namespace {
 
-// TODO(benvanik): be more conservative with descriptor set count or allow
-// chaining in the command buffer when pools run out.
-static constexpr int kMaxDescriptorSets = 4096;
+// Number of descriptor sets in each pool. Command buffers needing more chain
+// additional pools so this only needs to cover typical command buffers.
+static constexpr int kMaxDescriptorSets = 256;
 
 }  // namespace
 
 DescriptorSetGroup::~DescriptorSetGroup() {
-  IREE_ASSERT_TRUE(descriptor_pools_.empty(),
+  IREE_ASSERT_TRUE(descriptor_pools_.empty() && buffer_views_.empty(),
                    "DescriptorSetGroup must be reset explicitly");
 }
 
@@ -34,37 +35,70 @@ iree_status_t DescriptorSetGroup::Reset() {
   IREE_TRACE_SCOPE0("DescriptorSetGroup::Reset");
 
   if (descriptor_pool_cache_ != nullptr) {
+    VkDeviceHandle* logical_device = descriptor_pool_cache_->logical_device();
+    for (VkBufferView buffer_view : buffer_views_) {
+      logical_device->syms()->vkDestroyBufferView(
+          *logical_device, buffer_view, logical_device->allocator());
+    }
     IREE_RETURN_IF_ERROR(
         descriptor_pool_cache_->ReleaseDescriptorPools(descriptor_pools_));
   }
   descriptor_pools_.clear();
+  buffer_views_.clear();
 
   return iree_ok_status();
 }
 
 DescriptorPoolCache::DescriptorPoolCache(VkDeviceHandle* logical_device)
-    : logical_device_(logical_device) {}
+    : logical_device_(logical_device) {
+  iree_slim_mutex_initialize(&mutex_);
+}
+
+DescriptorPoolCache::~DescriptorPoolCache() {
+  Trim();
+  iree_slim_mutex_deinitialize(&mutex_);
+}
 
 iree_status_t DescriptorPoolCache::AcquireDescriptorPool(
     VkDescriptorType descriptor_type, int max_descriptor_count,
     DescriptorPool* out_descriptor_pool) {
   IREE_TRACE_SCOPE0("DescriptorPoolCache::AcquireDescriptorPool");
 
-  // TODO(benvanik): lookup in cache.
+  // Reuse the most recently released matching pool, if any. Released pools
+  // have already been reset.
+  iree_slim_mutex_lock(&mutex_);
+  for (auto it = free_descriptor_pools_.rbegin();
+       it != free_descriptor_pools_.rend(); ++it) {
+    if (it->descriptor_type == descriptor_type &&
+        it->max_descriptor_count == max_descriptor_count) {
+      *out_descriptor_pool = *it;
+      free_descriptor_pools_.erase(std::next(it).base());
+      iree_slim_mutex_unlock(&mutex_);
+      return iree_ok_status();
+    }
+  }
+  iree_slim_mutex_unlock(&mutex_);
 
   VkDescriptorPoolCreateInfo create_info;
   create_info.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
   create_info.pNext = nullptr;
   create_info.flags = 0;
   create_info.maxSets = kMaxDescriptorSets;
-  std::array<VkDescriptorPoolSize, 1> pool_sizes;
+  std::array<VkDescriptorPoolSize, 2> pool_sizes;
   pool_sizes[0].type = descriptor_type;
   pool_sizes[0].descriptorCount = max_descriptor_count * create_info.maxSets;
-  create_info.poolSizeCount = static_cast<uint32_t>(pool_sizes.size());
+  create_info.poolSizeCount = 1;
+  if (descriptor_type == VK_DESCRIPTOR_TYPE_UNIFORM_TEXEL_BUFFER) {
+    // Sets reading texel buffers write their results to storage buffers.
+    pool_sizes[1].type = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+    pool_sizes[1].descriptorCount = pool_sizes[0].descriptorCount;
+    create_info.poolSizeCount = 2;
+  }
   create_info.pPoolSizes = pool_sizes.data();
 
   DescriptorPool descriptor_pool;
   descriptor_pool.descriptor_type = descriptor_type;
+  descriptor_pool.max_descriptor_count = max_descriptor_count;
   descriptor_pool.handle = VK_NULL_HANDLE;
 
   VK_RETURN_IF_ERROR(syms().vkCreateDescriptorPool(
@@ -87,13 +121,29 @@ iree_status_t DescriptorPoolCache::ReleaseDescriptorPools(
     VK_RETURN_IF_ERROR(syms().vkResetDescriptorPool(*logical_device_,
                                                     descriptor_pool.handle, 0),
                        "vkResetDescriptorPool");
+  }
 
-    // TODO(benvanik): release to cache.
+  iree_slim_mutex_lock(&mutex_);
+  free_descriptor_pools_.insert(free_descriptor_pools_.end(),
+                                descriptor_pools.begin(),
+                                descriptor_pools.end());
+  iree_slim_mutex_unlock(&mutex_);
+
+  return iree_ok_status();
+}
+
+void DescriptorPoolCache::Trim() {
+  IREE_TRACE_SCOPE0("DescriptorPoolCache::Trim");
+
+  std::vector<DescriptorPool> descriptor_pools;
+  iree_slim_mutex_lock(&mutex_);
+  descriptor_pools.swap(free_descriptor_pools_);
+  iree_slim_mutex_unlock(&mutex_);
+
+  for (const auto& descriptor_pool : descriptor_pools) {
     syms().vkDestroyDescriptorPool(*logical_device_, descriptor_pool.handle,
                                    logical_device_->allocator());
   }
-
-  return iree_ok_status();
 }
 
 }  // namespace vulkan
@@ -12,6 +12,7 @@
 #include <vector>
 
 #include "iree/base/api.h"
+#include "iree/base/internal/synchronization.h"
 #include "iree/hal/drivers/vulkan/dynamic_symbols.h"
 #include "iree/hal/drivers/vulkan/handle_util.h"
 #include "iree/hal/drivers/vulkan/util/ref_ptr.h"
@@ -24,10 +25,14 @@ class DescriptorPoolCache;
 
 // A descriptor pool with a single descriptor type of some number.
 // We only support a single descriptor type for now as we only generate SPIR-V
-// that uses a single type.
+// that uses a single type. Texel buffer pools are the exception and also hold
+// storage buffer descriptors as sets reading texel buffers still need storage
+// buffers for their results.
 struct DescriptorPool {
   // Type of the descriptor in the set.
   VkDescriptorType descriptor_type = VK_DESCRIPTOR_TYPE_MAX_ENUM;
+  // Maximum number of descriptors in each set allocated from the pool.
+  int max_descriptor_count = 0;
   // Pool handle.
   VkDescriptorPool handle = VK_NULL_HANDLE;
 };
@@ -38,17 +43,21 @@ class DescriptorSetGroup final {
  public:
   DescriptorSetGroup() = default;
   DescriptorSetGroup(DescriptorPoolCache* descriptor_pool_cache,
-                     std::vector<DescriptorPool> descriptor_pools)
+                     std::vector<DescriptorPool> descriptor_pools,
+                     std::vector<VkBufferView> buffer_views)
       : descriptor_pool_cache_(descriptor_pool_cache),
-        descriptor_pools_(std::move(descriptor_pools)) {}
+        descriptor_pools_(std::move(descriptor_pools)),
+        buffer_views_(std::move(buffer_views)) {}
   DescriptorSetGroup(const DescriptorSetGroup&) = delete;
   DescriptorSetGroup& operator=(const DescriptorSetGroup&) = delete;
   DescriptorSetGroup(DescriptorSetGroup&& other) noexcept
       : descriptor_pool_cache_(std::move(other.descriptor_pool_cache_)),
-        descriptor_pools_(std::move(other.descriptor_pools_)) {}
+        descriptor_pools_(std::move(other.descriptor_pools_)),
+        buffer_views_(std::move(other.buffer_views_)) {}
   DescriptorSetGroup& operator=(DescriptorSetGroup&& other) {
     std::swap(descriptor_pool_cache_, other.descriptor_pool_cache_);
     std::swap(descriptor_pools_, other.descriptor_pools_);
+    std::swap(buffer_views_, other.buffer_views_);
     return *this;
   }
   ~DescriptorSetGroup();
@@ -56,8 +65,10 @@ class DescriptorSetGroup final {
   iree_status_t Reset();
 
  private:
-  DescriptorPoolCache* descriptor_pool_cache_;
+  DescriptorPoolCache* descriptor_pool_cache_ = nullptr;
   std::vector<DescriptorPool> descriptor_pools_;
+  // Texel buffer views referenced by the descriptor sets. Destroyed on reset.
+  std::vector<VkBufferView> buffer_views_;
 };
 
 // A "cache" (or really, pool) of descriptor pools. These pools are allocated
@@ -66,9 +77,17 @@ class DescriptorSetGroup final {
 // resources. After the descriptors in the pool are no longer used (all
 // command buffers using descriptor sets allocated from the pool have retired)
 // the pool is returned here to be reused in the future.
+//
+// Pools are sized for a modest number of sets; command buffers that exhaust a
+// pool chain another one from the cache. Pool creation is expensive on many
+// drivers (especially mobile ones) so pools are only destroyed when the cache
+// is trimmed or destroyed.
+//
+// Thread-safe: command buffers may be recorded and retired concurrently.
 class DescriptorPoolCache final {
  public:
   explicit DescriptorPoolCache(VkDeviceHandle* logical_device);
+  ~DescriptorPoolCache();
 
   VkDeviceHandle* logical_device() const { return logical_device_; }
   const DynamicSymbols& syms() const { return *logical_device_->syms(); }
@@ -86,8 +105,16 @@ class DescriptorPoolCache final {
   iree_status_t ReleaseDescriptorPools(
       const std::vector<DescriptorPool>& descriptor_pools);
 
+  // Destroys all descriptor pools that are not currently acquired.
+  void Trim();
+
  private:
   VkDeviceHandle* logical_device_;
+
+  iree_slim_mutex_t mutex_;
+  // Reset pools available for reuse, in release order. Pools of all types and
+  // sizes are kept in a single list as there are only a handful of each.
+  std::vector<DescriptorPool> free_descriptor_pools_ IREE_GUARDED_BY(mutex_);
 };
 
 }  // namespace vulkan
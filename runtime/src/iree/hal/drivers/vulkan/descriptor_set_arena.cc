@@ -23,53 +23,148 @@ namespace vulkan {
 
 namespace {
 
-static void PopulateDescriptorSetWriteInfos(
+static void PopulateDescriptorBufferInfo(
+    const iree_hal_descriptor_set_binding_t& binding,
+    VkDescriptorBufferInfo* out_buffer_info) {
+  out_buffer_info->buffer =
+      binding.buffer ? iree_hal_vulkan_vma_buffer_handle(
+                           iree_hal_buffer_allocated_buffer(binding.buffer))
+                     : VK_NULL_HANDLE;
+  out_buffer_info->offset =
+      iree_hal_buffer_byte_offset(binding.buffer) + binding.offset;
+  if (binding.length == IREE_WHOLE_BUFFER) {
+    out_buffer_info->range = VK_WHOLE_SIZE;
+  } else {
+    // Round up to a multiple of 32-bit. 32-bit is the most native bitwidth on
+    // GPUs; it has the best support compared to other bitwidths. We use VMA
+    // to manage GPU memory for us and VMA should already handled proper
+    // alignment when performing allocations; here we just need to provide the
+    // proper "view" to Vulkan drivers over the allocated memory.
+    //
+    // Note this is needed because we can see unusal buffers like
+    // tensor<3xi8>. Depending on GPU capabilities, this might not always be
+    // directly supported by the hardware. Under such circumstances, we need
+    // to emulate i8 support with i32. Shader CodeGen takes care of that: the
+    // shader will read the buffer as tensor<i32> and perform bit shifts to
+    // extract each byte and conduct computations. The extra additional byte
+    // is read but not really used by the shader. Here in application we need
+    // to match the ABI and provide the buffer as 32-bit aligned, otherwise
+    // the whole read by the shader is considered as out of bounds per the
+    // Vulkan spec. See
+    // https://github.com/iree-org/iree/issues/2022#issuecomment-640617234 for
+    // more details.
+    out_buffer_info->range = iree_device_align(
+        std::min(binding.length, iree_hal_buffer_byte_length(binding.buffer) -
+                                     binding.offset),
+        4);
+  }
+}
+
+// Format of texel buffer views. 128-bit texels match the widest loads codegen
+// emits and the format is required to support uniform texel buffers.
+static constexpr VkFormat kTexelBufferFormat = VK_FORMAT_R32G32B32A32_UINT;
+static constexpr VkDeviceSize kTexelBufferTexelSize = 16;
+
+// Returns the descriptor type |set_layout| declares for |binding_ordinal|.
+// Bindings not in the layout are treated as storage buffers and left for the
+// validation layers to report.
+static VkDescriptorType LookupDescriptorType(
+    iree_hal_descriptor_set_layout_t* set_layout, uint32_t binding_ordinal) {
+  iree_host_size_t layout_binding_count =
+      iree_hal_vulkan_native_descriptor_set_layout_binding_count(set_layout);
+  const iree_hal_descriptor_set_layout_binding_t* layout_bindings =
+      iree_hal_vulkan_native_descriptor_set_layout_bindings(set_layout);
+  for (iree_host_size_t i = 0; i < layout_binding_count; ++i) {
+    if (layout_bindings[i].binding == binding_ordinal &&
+        layout_bindings[i].type ==
+            IREE_HAL_DESCRIPTOR_TYPE_UNIFORM_TEXEL_BUFFER) {
+      return VK_DESCRIPTOR_TYPE_UNIFORM_TEXEL_BUFFER;
+    }
+  }
+  return VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+}
+
+// Returns true if |set_layout| has any texel buffer bindings.
+static bool HasTexelBufferBindings(
+    iree_hal_descriptor_set_layout_t* set_layout) {
+  iree_host_size_t layout_binding_count =
+      iree_hal_vulkan_native_descriptor_set_layout_binding_count(set_layout);
+  const iree_hal_descriptor_set_layout_binding_t* layout_bindings =
+      iree_hal_vulkan_native_descriptor_set_layout_bindings(set_layout);
+  for (iree_host_size_t i = 0; i < layout_binding_count; ++i) {
+    if (layout_bindings[i].type ==
+        IREE_HAL_DESCRIPTOR_TYPE_UNIFORM_TEXEL_BUFFER) {
+      return true;
+    }
+  }
+  return false;
+}
+
+// Creates a texel buffer view over the range of |binding|. The view must be
+// kept alive until all command buffers using it have completed.
+static iree_status_t CreateTexelBufferView(
+    VkDeviceHandle* logical_device,
+    const iree_hal_descriptor_set_binding_t& binding,
+    VkBufferView* out_buffer_view) {
+  *out_buffer_view = VK_NULL_HANDLE;
+  if (!binding.buffer) return iree_ok_status();
+
+  VkDescriptorBufferInfo buffer_info;
+  PopulateDescriptorBufferInfo(binding, &buffer_info);
+
+  // Views cover whole texels. Like the 32-bit rounding of storage buffers the
+  // tail of the last texel may extend past the binding but must remain within
+  // the allocation.
+  VkDeviceSize range = buffer_info.range;
+  if (range != VK_WHOLE_SIZE) {
+    range = iree_device_align(range, kTexelBufferTexelSize);
+    iree_hal_buffer_t* allocated_buffer =
+        iree_hal_buffer_allocated_buffer(binding.buffer);
+    if (buffer_info.offset + range >
+        iree_hal_buffer_allocation_size(allocated_buffer)) {
+      return iree_make_status(
+          IREE_STATUS_INVALID_ARGUMENT,
+          "texel buffer binding %u range %" PRIu64 " at offset %" PRIu64
+          " does not cover whole %" PRIu64 "-byte texels of its allocation",
+          binding.binding, (uint64_t)buffer_info.range,
+          (uint64_t)buffer_info.offset, (uint64_t)kTexelBufferTexelSize);
+    }
+  }
+
+  VkBufferViewCreateInfo create_info;
+  create_info.sType = VK_STRUCTURE_TYPE_BUFFER_VIEW_CREATE_INFO;
+  create_info.pNext = nullptr;
+  create_info.flags = 0;
+  create_info.buffer = buffer_info.buffer;
+  create_info.format = kTexelBufferFormat;
+  create_info.offset = buffer_info.offset;
+  create_info.range = range;
+  return VK_RESULT_TO_STATUS(
+      logical_device->syms()->vkCreateBufferView(*logical_device, &create_info,
+                                                 logical_device->allocator(),
+                                                 out_buffer_view),
+      "vkCreateBufferView");
+}
+
+// Populates a VkWriteDescriptorSet for each of |bindings| with the descriptor
+// types declared by |set_layout|. Texel buffer views created for the writes
+// are appended to |buffer_views|.
+static iree_status_t PopulateDescriptorSetWriteInfos(
+    VkDeviceHandle* logical_device,
+    iree_hal_descriptor_set_layout_t* set_layout,
     iree_host_size_t binding_count,
     const iree_hal_descriptor_set_binding_t* bindings, VkDescriptorSet dst_set,
-    Arena* arena, iree_host_size_t* out_info_count,
-    VkWriteDescriptorSet** out_infos) {
+    Arena* arena, std::vector<VkBufferView>* buffer_views,
+    iree_host_size_t* out_info_count, VkWriteDescriptorSet** out_infos) {
   arena->Reset();
   auto buffer_infos =
       arena->AllocateSpan<VkDescriptorBufferInfo>(binding_count);
+  auto texel_buffer_views = arena->AllocateSpan<VkBufferView>(binding_count);
   auto write_infos = arena->AllocateSpan<VkWriteDescriptorSet>(binding_count);
 
   for (int i = 0; i < binding_count; ++i) {
     const auto& binding = bindings[i];
 
-    auto& buffer_info = buffer_infos[i];
-    buffer_info.buffer =
-        binding.buffer ? iree_hal_vulkan_vma_buffer_handle(
-                             iree_hal_buffer_allocated_buffer(binding.buffer))
-                       : VK_NULL_HANDLE;
-    buffer_info.offset =
-        iree_hal_buffer_byte_offset(binding.buffer) + binding.offset;
-    if (binding.length == IREE_WHOLE_BUFFER) {
-      buffer_info.range = VK_WHOLE_SIZE;
-    } else {
-      // Round up to a multiple of 32-bit. 32-bit is the most native bitwidth on
-      // GPUs; it has the best support compared to other bitwidths. We use VMA
-      // to manage GPU memory for us and VMA should already handled proper
-      // alignment when performing allocations; here we just need to provide the
-      // proper "view" to Vulkan drivers over the allocated memory.
-      //
-      // Note this is needed because we can see unusal buffers like
-      // tensor<3xi8>. Depending on GPU capabilities, this might not always be
-      // directly supported by the hardware. Under such circumstances, we need
-      // to emulate i8 support with i32. Shader CodeGen takes care of that: the
-      // shader will read the buffer as tensor<i32> and perform bit shifts to
-      // extract each byte and conduct computations. The extra additional byte
-      // is read but not really used by the shader. Here in application we need
-      // to match the ABI and provide the buffer as 32-bit aligned, otherwise
-      // the whole read by the shader is considered as out of bounds per the
-      // Vulkan spec. See
-      // https://github.com/iree-org/iree/issues/2022#issuecomment-640617234 for
-      // more details.
-      buffer_info.range = iree_device_align(
-          std::min(binding.length, iree_hal_buffer_byte_length(binding.buffer) -
-                                       binding.offset),
-          4);
-    }
-
     auto& write_info = write_infos[i];
     write_info.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
     write_info.pNext = nullptr;
@@ -77,14 +172,64 @@ static void PopulateDescriptorSetWriteInfos(
     write_info.dstBinding = binding.binding;
     write_info.dstArrayElement = 0;
     write_info.descriptorCount = 1;
-    write_info.descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+    write_info.descriptorType =
+        LookupDescriptorType(set_layout, binding.binding);
     write_info.pImageInfo = nullptr;
-    write_info.pBufferInfo = &buffer_info;
+    write_info.pBufferInfo = nullptr;
     write_info.pTexelBufferView = nullptr;
+
+    if (write_info.descriptorType == VK_DESCRIPTOR_TYPE_UNIFORM_TEXEL_BUFFER) {
+      auto& texel_buffer_view = texel_buffer_views[i];
+      IREE_RETURN_IF_ERROR(
+          CreateTexelBufferView(logical_device, binding, &texel_buffer_view));
+      if (texel_buffer_view != VK_NULL_HANDLE) {
+        buffer_views->push_back(texel_buffer_view);
+      }
+      write_info.pTexelBufferView = &texel_buffer_view;
+    } else {
+      auto& buffer_info = buffer_infos[i];
+      PopulateDescriptorBufferInfo(binding, &buffer_info);
+      write_info.pBufferInfo = &buffer_info;
+    }
   }
 
   *out_info_count = write_infos.size();
   *out_infos = write_infos.data();
+  return iree_ok_status();
+}
+
+// Populates the data consumed by the descriptor update template of
+// |set_layout|: one VkDescriptorBufferInfo per layout binding, in layout order.
+// Returns false if |bindings| do not cover the layout bindings exactly, in
+// which case the set must be updated without the template.
+static bool PopulateDescriptorSetTemplateData(
+    iree_hal_descriptor_set_layout_t* set_layout,
+    iree_host_size_t binding_count,
+    const iree_hal_descriptor_set_binding_t* bindings, Arena* arena,
+    const VkDescriptorBufferInfo** out_data) {
+  iree_host_size_t layout_binding_count =
+      iree_hal_vulkan_native_descriptor_set_layout_binding_count(set_layout);
+  if (binding_count != layout_binding_count) return false;
+  const iree_hal_descriptor_set_layout_binding_t* layout_bindings =
+      iree_hal_vulkan_native_descriptor_set_layout_bindings(set_layout);
+
+  arena->Reset();
+  auto buffer_infos =
+      arena->AllocateSpan<VkDescriptorBufferInfo>(binding_count);
+  for (iree_host_size_t i = 0; i < binding_count; ++i) {
+    // Bindings are almost always provided in layout order.
+    iree_host_size_t slot = i;
+    if (layout_bindings[slot].binding != bindings[i].binding) {
+      for (slot = 0; slot < layout_binding_count; ++slot) {
+        if (layout_bindings[slot].binding == bindings[i].binding) break;
+      }
+      if (slot == layout_binding_count) return false;
+    }
+    PopulateDescriptorBufferInfo(bindings[i], &buffer_infos[slot]);
+  }
+
+  *out_data = buffer_infos.data();
+  return true;
 }
 
 static VkDescriptorSetAllocateInfo PopulateDescriptorSetsAllocateInfo(
@@ -111,6 +256,11 @@ DescriptorSetArena::DescriptorSetArena(
       descriptor_pool_cache_(descriptor_pool_cache) {}
 
 DescriptorSetArena::~DescriptorSetArena() {
+  for (VkBufferView buffer_view : buffer_views_) {
+    syms().vkDestroyBufferView(*logical_device_, buffer_view,
+                               logical_device_->allocator());
+  }
+  buffer_views_.clear();
   if (!used_descriptor_pools_.empty()) {
     iree_status_ignore(
         descriptor_pool_cache_->ReleaseDescriptorPools(used_descriptor_pools_));
@@ -125,9 +275,8 @@ iree_status_t DescriptorSetArena::BindDescriptorSet(
   // Always prefer using push descriptors when available as we can avoid the
   // additional API overhead of updating/resetting pools.
   if (logical_device_->enabled_extensions().push_descriptors) {
-    PushDescriptorSet(command_buffer, pipeline_layout, set, binding_count,
-                      bindings);
-    return iree_ok_status();
+    return PushDescriptorSet(command_buffer, pipeline_layout, set,
+                             binding_count, bindings);
   }
 
   IREE_TRACE_SCOPE0("DescriptorSetArena::BindDescriptorSet");
@@ -148,14 +297,23 @@ iree_status_t DescriptorSetArena::BindDescriptorSet(
                             required_descriptor_count,
                             (1 << (descriptor_pool_buckets_.size() + 3)));
   }
-  if (descriptor_pool_buckets_[bucket].handle == VK_NULL_HANDLE) {
+
+  // Sets with texel buffers come from pools that also hold storage buffers.
+  bool has_texel_buffers = HasTexelBufferBindings(set_layout);
+  VkDescriptorType pool_descriptor_type =
+      has_texel_buffers ? VK_DESCRIPTOR_TYPE_UNIFORM_TEXEL_BUFFER
+                        : VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+  auto& descriptor_pool_buckets = has_texel_buffers
+                                      ? texel_descriptor_pool_buckets_
+                                      : descriptor_pool_buckets_;
+  if (descriptor_pool_buckets[bucket].handle == VK_NULL_HANDLE) {
     // Acquire a pool for this max_descriptor_count bucket.
     IREE_RETURN_IF_ERROR(descriptor_pool_cache_->AcquireDescriptorPool(
-        VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, max_descriptor_count,
-        &descriptor_pool_buckets_[bucket]));
-    used_descriptor_pools_.push_back(descriptor_pool_buckets_[bucket]);
+        pool_descriptor_type, max_descriptor_count,
+        &descriptor_pool_buckets[bucket]));
+    used_descriptor_pools_.push_back(descriptor_pool_buckets[bucket]);
   }
-  auto& descriptor_pool = descriptor_pool_buckets_[bucket];
+  auto& descriptor_pool = descriptor_pool_buckets[bucket];
 
   VkDescriptorSetAllocateInfo allocate_info;
   allocate_info.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
@@ -170,19 +328,20 @@ iree_status_t DescriptorSetArena::BindDescriptorSet(
   VkResult result = syms().vkAllocateDescriptorSets(
       *logical_device_, &allocate_info, &descriptor_set);
 
-  if (result == VK_ERROR_OUT_OF_POOL_MEMORY) {
+  if (result == VK_ERROR_OUT_OF_POOL_MEMORY ||
+      result == VK_ERROR_FRAGMENTED_POOL) {
     // Allocation failed because the pool is either out of descriptors or too
-    // fragmented. We'll just allocate another pool.
+    // fragmented. We'll chain another pool from the cache.
     IREE_RETURN_IF_ERROR(descriptor_pool_cache_->AcquireDescriptorPool(
-        VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, max_descriptor_count,
-        &descriptor_pool_buckets_[bucket]));
-    used_descriptor_pools_.push_back(descriptor_pool_buckets_[bucket]);
+        pool_descriptor_type, max_descriptor_count,
+        &descriptor_pool_buckets[bucket]));
+    used_descriptor_pools_.push_back(descriptor_pool_buckets[bucket]);
 
     // Allocate descriptor sets.
     VkDescriptorSetAllocateInfo allocate_info;
     allocate_info.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
     allocate_info.pNext = nullptr;
-    allocate_info.descriptorPool = descriptor_pool_buckets_[bucket].handle;
+    allocate_info.descriptorPool = descriptor_pool_buckets[bucket].handle;
     allocate_info.descriptorSetCount = 1;
     allocate_info.pSetLayouts = &set_layout_handle;
     descriptor_set = VK_NULL_HANDLE;
@@ -191,21 +350,35 @@ iree_status_t DescriptorSetArena::BindDescriptorSet(
                        "vkAllocateDescriptorSets");
   }
 
-  // Get a list of VkWriteDescriptorSet structs with all bound buffers.
-  iree_host_size_t write_info_count = 0;
-  VkWriteDescriptorSet* write_infos = NULL;
-  PopulateDescriptorSetWriteInfos(binding_count, bindings, descriptor_set,
-                                  &scratch_arena_, &write_info_count,
-                                  &write_infos);
-
-  // This is the reason why push descriptor sets are good.
-  // We can't batch these effectively as we don't know prior to recording what
-  // descriptor sets we will need and what buffers they will point to (without
-  // doing just as much work as actually recording the buffer to try to find
-  // out).
-  syms().vkUpdateDescriptorSets(*logical_device_,
-                                static_cast<uint32_t>(write_info_count),
-                                write_infos, 0, nullptr);
+  // Update the descriptor set with the layout template when we can as the
+  // driver then reads a flat array of buffer infos instead of decoding a list
+  // of VkWriteDescriptorSet structs.
+  VkDescriptorUpdateTemplate update_template =
+      iree_hal_vulkan_native_pipeline_layout_update_template(pipeline_layout,
+                                                             set);
+  const VkDescriptorBufferInfo* template_data = NULL;
+  if (update_template != VK_NULL_HANDLE &&
+      PopulateDescriptorSetTemplateData(set_layout, binding_count, bindings,
+                                        &scratch_arena_, &template_data)) {
+    syms().vkUpdateDescriptorSetWithTemplate(*logical_device_, descriptor_set,
+                                             update_template, template_data);
+  } else {
+    // Get a list of VkWriteDescriptorSet structs with all bound buffers.
+    iree_host_size_t write_info_count = 0;
+    VkWriteDescriptorSet* write_infos = NULL;
+    IREE_RETURN_IF_ERROR(PopulateDescriptorSetWriteInfos(
+        logical_device_, set_layout, binding_count, bindings, descriptor_set,
+        &scratch_arena_, &buffer_views_, &write_info_count, &write_infos));
+
+    // This is the reason why push descriptor sets are good.
+    // We can't batch these effectively as we don't know prior to recording
+    // what descriptor sets we will need and what buffers they will point to
+    // (without doing just as much work as actually recording the buffer to try
+    // to find out).
+    syms().vkUpdateDescriptorSets(*logical_device_,
+                                  static_cast<uint32_t>(write_info_count),
+                                  write_infos, 0, nullptr);
+  }
 
   // Bind the descriptor set.
   syms().vkCmdBindDescriptorSets(
@@ -216,32 +389,49 @@ iree_status_t DescriptorSetArena::BindDescriptorSet(
   return iree_ok_status();
 }
 
-void DescriptorSetArena::PushDescriptorSet(
+iree_status_t DescriptorSetArena::PushDescriptorSet(
     VkCommandBuffer command_buffer, iree_hal_pipeline_layout_t* pipeline_layout,
     uint32_t set, iree_host_size_t binding_count,
     const iree_hal_descriptor_set_binding_t* bindings) {
   IREE_TRACE_SCOPE0("DescriptorSetArena::PushDescriptorSet");
   VkPipelineLayout device_pipeline_layout =
       iree_hal_vulkan_native_pipeline_layout_handle(pipeline_layout);
+  auto* set_layout =
+      iree_hal_vulkan_native_pipeline_layout_set(pipeline_layout, set);
+
+  // Templates avoid building VkWriteDescriptorSet lists entirely.
+  VkDescriptorUpdateTemplate update_template =
+      iree_hal_vulkan_native_pipeline_layout_update_template(pipeline_layout,
+                                                             set);
+  const VkDescriptorBufferInfo* template_data = NULL;
+  if (update_template != VK_NULL_HANDLE &&
+      PopulateDescriptorSetTemplateData(set_layout, binding_count, bindings,
+                                        &scratch_arena_, &template_data)) {
+    syms().vkCmdPushDescriptorSetWithTemplateKHR(
+        command_buffer, update_template, device_pipeline_layout, set,
+        template_data);
+    return iree_ok_status();
+  }
 
   // Get a list of VkWriteDescriptorSet structs with all bound buffers.
   iree_host_size_t write_info_count = 0;
   VkWriteDescriptorSet* write_infos = NULL;
-  PopulateDescriptorSetWriteInfos(binding_count, bindings, VK_NULL_HANDLE,
-                                  &scratch_arena_, &write_info_count,
-                                  &write_infos);
+  IREE_RETURN_IF_ERROR(PopulateDescriptorSetWriteInfos(
+      logical_device_, set_layout, binding_count, bindings, VK_NULL_HANDLE,
+      &scratch_arena_, &buffer_views_, &write_info_count, &write_infos));
 
   // Fast path using push descriptors. These are pooled internally by the
   // command buffer and prevent the need for our own pooling mechanisms.
   syms().vkCmdPushDescriptorSetKHR(
       command_buffer, VK_PIPELINE_BIND_POINT_COMPUTE, device_pipeline_layout,
       set, static_cast<uint32_t>(write_info_count), write_infos);
+  return iree_ok_status();
 }
 
 DescriptorSetGroup DescriptorSetArena::Flush() {
   IREE_TRACE_SCOPE0("DescriptorSetArena::Flush");
 
-  if (used_descriptor_pools_.empty()) {
+  if (used_descriptor_pools_.empty() && buffer_views_.empty()) {
     // No resources to free.
     return DescriptorSetGroup{};
   }
@@ -249,8 +439,12 @@ DescriptorSetGroup DescriptorSetArena::Flush() {
   for (auto& bucket : descriptor_pool_buckets_) {
     bucket = {};
   }
+  for (auto& bucket : texel_descriptor_pool_buckets_) {
+    bucket = {};
+  }
   return DescriptorSetGroup(descriptor_pool_cache_,
-                            std::move(used_descriptor_pools_));
+                            std::move(used_descriptor_pools_),
+                            std::move(buffer_views_));
 }
 
 }  // namespace vulkan
@@ -49,10 +49,11 @@ class DescriptorSetArena final {
   const DynamicSymbols& syms() const { return *logical_device_->syms(); }
 
   // Pushes the descriptor set to the command buffer, if supported.
-  void PushDescriptorSet(VkCommandBuffer command_buffer,
-                         iree_hal_pipeline_layout_t* pipeline_layout,
-                         uint32_t set, iree_host_size_t binding_count,
-                         const iree_hal_descriptor_set_binding_t* bindings);
+  iree_status_t PushDescriptorSet(
+      VkCommandBuffer command_buffer,
+      iree_hal_pipeline_layout_t* pipeline_layout, uint32_t set,
+      iree_host_size_t binding_count,
+      const iree_hal_descriptor_set_binding_t* bindings);
 
   VkDeviceHandle* logical_device_;
   DescriptorPoolCache* descriptor_pool_cache_;
@@ -63,9 +64,14 @@ class DescriptorSetArena final {
   // A list of pools acquired on demand as different descriptor counts are
   // needed. Allocation granularity is max_descriptor_count=[8, 16, 32, 64].
   std::array<DescriptorPool, 4> descriptor_pool_buckets_;
+  // Buckets like |descriptor_pool_buckets_| for sets with texel buffers.
+  std::array<DescriptorPool, 4> texel_descriptor_pool_buckets_;
 
   // All pools that have been used during allocation.
   std::vector<DescriptorPool> used_descriptor_pools_;
+
+  // Texel buffer views created for descriptor sets since the last flush.
+  std::vector<VkBufferView> buffer_views_;
 };
 
 }  // namespace vulkan
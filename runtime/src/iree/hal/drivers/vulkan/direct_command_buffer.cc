@@ -21,6 +21,7 @@
 #include "iree/hal/drivers/vulkan/status_util.h"
 #include "iree/hal/drivers/vulkan/util/ref_ptr.h"
 #include "iree/hal/drivers/vulkan/vma_buffer.h"
+#include "iree/hal/utils/deferred_command_buffer.h"
 #include "iree/hal/utils/resource_set.h"
 
 using namespace iree::hal::vulkan;
@@ -31,6 +32,10 @@ using namespace iree::hal::vulkan;
 typedef struct iree_hal_vulkan_direct_command_buffer_t {
   iree_hal_command_buffer_t base;
   VkDeviceHandle* logical_device;
+  // Cache the command buffer returns to when released, if any.
+  iree_hal_vulkan_direct_command_buffer_cache_t* cache;
+  // Next command buffer in the cache while released.
+  iree_hal_vulkan_direct_command_buffer_t* next;
   iree_hal_vulkan_tracing_context_t* tracing_context;
   iree_arena_block_pool_t* block_pool;
 
@@ -40,10 +45,12 @@ typedef struct iree_hal_vulkan_direct_command_buffer_t {
   DynamicSymbols* syms;
 
   // Maintains a reference to all resources used within the command buffer.
-  // Reset on each begin.
+  // Freed when the command buffer is released so that resources are not kept
+  // live while it sits in the cache.
   iree_hal_resource_set_t* resource_set;
 
-  // TODO(benvanik): may grow large - should try to reclaim or reuse.
+  // Retained along with its scratch memory when the command buffer is reused;
+  // the descriptor pools themselves are returned to the pool cache on release.
   DescriptorSetArena descriptor_set_arena;
 
   // The current descriptor set group in use by the command buffer, if any.
@@ -59,6 +66,14 @@ typedef struct iree_hal_vulkan_direct_command_buffer_t {
   // TODO(scotttodd): use [maxPushConstantsSize - 16, maxPushConstantsSize]
   //                  instead of [0, 16] to reduce frequency of updates
   uint8_t push_constants_storage[IREE_HAL_VULKAN_BUILTIN_PUSH_CONSTANT_COUNT];
+  // Length of the prefix of |push_constants_storage| written by push_constants,
+  // rounded up to 4 bytes as required by vkCmdPushConstants. Bytes beyond it
+  // were never pushed and need not be restored.
+  iree_host_size_t push_constants_length;
+  // Set when builtin executables overwrite push constants that have been
+  // pushed. They are restored before the next dispatch that may read them
+  // instead of after each builtin use.
+  bool push_constants_clobbered;
 } iree_hal_vulkan_direct_command_buffer_t;
 
 namespace {
@@ -74,6 +89,93 @@ iree_hal_vulkan_direct_command_buffer_cast(
   return (iree_hal_vulkan_direct_command_buffer_t*)base_value;
 }
 
+//===----------------------------------------------------------------------===//
+// iree_hal_vulkan_direct_command_buffer_cache_t
+//===----------------------------------------------------------------------===//
+
+// Frees |command_buffer| and its VkCommandBuffer. The command buffer must have
+// been released and must not be in a cache.
+static void iree_hal_vulkan_direct_command_buffer_free(
+    iree_hal_vulkan_direct_command_buffer_t* command_buffer) {
+  iree_allocator_t host_allocator =
+      command_buffer->logical_device->host_allocator();
+  command_buffer->command_pool->Free(command_buffer->handle);
+  command_buffer->descriptor_set_group.~DescriptorSetGroup();
+  command_buffer->descriptor_set_arena.~DescriptorSetArena();
+  iree_allocator_free(host_allocator, command_buffer);
+}
+
+void iree_hal_vulkan_direct_command_buffer_cache_initialize(
+    iree_hal_vulkan_direct_command_buffer_cache_t* out_cache) {
+  IREE_ASSERT_ARGUMENT(out_cache);
+  memset(out_cache, 0, sizeof(*out_cache));
+  iree_slim_mutex_initialize(&out_cache->mutex);
+}
+
+void iree_hal_vulkan_direct_command_buffer_cache_deinitialize(
+    iree_hal_vulkan_direct_command_buffer_cache_t* cache) {
+  iree_hal_vulkan_direct_command_buffer_cache_trim(cache);
+  iree_slim_mutex_deinitialize(&cache->mutex);
+}
+
+void iree_hal_vulkan_direct_command_buffer_cache_trim(
+    iree_hal_vulkan_direct_command_buffer_cache_t* cache) {
+  IREE_TRACE_ZONE_BEGIN(z0);
+  iree_slim_mutex_lock(&cache->mutex);
+  iree_hal_vulkan_direct_command_buffer_t* head = cache->head;
+  cache->head = NULL;
+  cache->count = 0;
+  iree_slim_mutex_unlock(&cache->mutex);
+  while (head) {
+    iree_hal_vulkan_direct_command_buffer_t* next = head->next;
+    iree_hal_vulkan_direct_command_buffer_free(head);
+    head = next;
+  }
+  IREE_TRACE_ZONE_END(z0);
+}
+
+// Removes and returns a cached command buffer allocated from |command_pool|,
+// or NULL if there are none.
+static iree_hal_vulkan_direct_command_buffer_t*
+iree_hal_vulkan_direct_command_buffer_cache_acquire(
+    iree_hal_vulkan_direct_command_buffer_cache_t* cache,
+    VkCommandPoolHandle* command_pool) {
+  iree_slim_mutex_lock(&cache->mutex);
+  iree_hal_vulkan_direct_command_buffer_t** link = &cache->head;
+  while (*link && (*link)->command_pool != command_pool) {
+    link = &(*link)->next;
+  }
+  iree_hal_vulkan_direct_command_buffer_t* command_buffer = *link;
+  if (command_buffer) {
+    *link = command_buffer->next;
+    command_buffer->next = NULL;
+    --cache->count;
+  }
+  iree_slim_mutex_unlock(&cache->mutex);
+  return command_buffer;
+}
+
+// Returns |command_buffer| to |cache| and returns true, or returns false if
+// the cache is full and the command buffer must be freed instead.
+static bool iree_hal_vulkan_direct_command_buffer_cache_release(
+    iree_hal_vulkan_direct_command_buffer_cache_t* cache,
+    iree_hal_vulkan_direct_command_buffer_t* command_buffer) {
+  iree_slim_mutex_lock(&cache->mutex);
+  bool cached =
+      cache->count < IREE_HAL_VULKAN_DIRECT_COMMAND_BUFFER_CACHE_CAPACITY;
+  if (cached) {
+    command_buffer->next = cache->head;
+    cache->head = command_buffer;
+    ++cache->count;
+  }
+  iree_slim_mutex_unlock(&cache->mutex);
+  return cached;
+}
+
+//===----------------------------------------------------------------------===//
+// iree_hal_vulkan_direct_command_buffer_t
+//===----------------------------------------------------------------------===//
+
 iree_status_t iree_hal_vulkan_direct_command_buffer_allocate(
     iree_hal_device_t* device,
     iree::hal::vulkan::VkDeviceHandle* logical_device,
@@ -85,6 +187,7 @@ iree_status_t iree_hal_vulkan_direct_command_buffer_allocate(
     iree::hal::vulkan::DescriptorPoolCache* descriptor_pool_cache,
     iree::hal::vulkan::BuiltinExecutables* builtin_executables,
     iree_arena_block_pool_t* block_pool,
+    iree_hal_vulkan_direct_command_buffer_cache_t* cache,
     iree_hal_command_buffer_t** out_command_buffer) {
   IREE_ASSERT_ARGUMENT(logical_device);
   IREE_ASSERT_ARGUMENT(command_pool);
@@ -94,52 +197,72 @@ iree_status_t iree_hal_vulkan_direct_command_buffer_allocate(
   *out_command_buffer = NULL;
 
   if (binding_capacity > 0) {
-    // TODO(#10144): support indirect command buffers with binding tables.
+    // Indirect command buffers are recorded as deferred command buffers by the
+    // device and replayed with resolved bindings when executed.
     return iree_make_status(IREE_STATUS_UNIMPLEMENTED,
-                            "indirect command buffers not yet implemented");
+                            "indirect direct command buffers are not "
+                            "supported; record as a deferred command buffer");
   }
 
   IREE_TRACE_ZONE_BEGIN(z0);
 
-  VkCommandBufferAllocateInfo allocate_info;
-  allocate_info.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
-  allocate_info.pNext = NULL;
-  allocate_info.commandPool = *command_pool;
-  allocate_info.commandBufferCount = 1;
-  allocate_info.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
-
-  VkCommandBuffer handle = VK_NULL_HANDLE;
-  IREE_RETURN_AND_END_ZONE_IF_ERROR(
-      z0, command_pool->Allocate(&allocate_info, &handle));
-
-  iree_hal_vulkan_direct_command_buffer_t* command_buffer = NULL;
-  iree_status_t status =
-      iree_allocator_malloc(logical_device->host_allocator(),
-                            sizeof(*command_buffer), (void**)&command_buffer);
+  // Reuse a released command buffer if possible. Its VkCommandBuffer is reset
+  // when recording begins.
+  iree_hal_vulkan_direct_command_buffer_t* command_buffer =
+      cache ? iree_hal_vulkan_direct_command_buffer_cache_acquire(cache,
+                                                                  command_pool)
+            : NULL;
+  iree_status_t status = iree_ok_status();
+  if (!command_buffer) {
+    VkCommandBufferAllocateInfo allocate_info;
+    allocate_info.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+    allocate_info.pNext = NULL;
+    allocate_info.commandPool = *command_pool;
+    allocate_info.commandBufferCount = 1;
+    allocate_info.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+
+    VkCommandBuffer handle = VK_NULL_HANDLE;
+    IREE_RETURN_AND_END_ZONE_IF_ERROR(
+        z0, command_pool->Allocate(&allocate_info, &handle));
+
+    status = iree_allocator_malloc(logical_device->host_allocator(),
+                                   sizeof(*command_buffer),
+                                   (void**)&command_buffer);
+    if (iree_status_is_ok(status)) {
+      command_buffer->logical_device = logical_device;
+      command_buffer->command_pool = command_pool;
+      command_buffer->handle = handle;
+      command_buffer->syms = logical_device->syms().get();
+      new (&command_buffer->descriptor_set_arena)
+          DescriptorSetArena(descriptor_pool_cache);
+      new (&command_buffer->descriptor_set_group) DescriptorSetGroup();
+    } else {
+      command_pool->Free(handle);
+    }
+  } else {
+    IREE_TRACE_ZONE_APPEND_TEXT(z0, "reused");
+  }
+
   if (iree_status_is_ok(status)) {
+    memset(&command_buffer->base, 0, sizeof(command_buffer->base));
     iree_hal_command_buffer_initialize(
         device, mode, command_categories, queue_affinity, binding_capacity,
         &iree_hal_vulkan_direct_command_buffer_vtable, &command_buffer->base);
-    command_buffer->logical_device = logical_device;
+    command_buffer->cache = cache;
     command_buffer->tracing_context = tracing_context;
     command_buffer->block_pool = block_pool;
-    command_buffer->command_pool = command_pool;
-    command_buffer->handle = handle;
-    command_buffer->syms = logical_device->syms().get();
-
-    new (&command_buffer->descriptor_set_arena)
-        DescriptorSetArena(descriptor_pool_cache);
-    new (&command_buffer->descriptor_set_group) DescriptorSetGroup();
-
     command_buffer->builtin_executables = builtin_executables;
+    memset(command_buffer->push_constants_storage, 0,
+           sizeof(command_buffer->push_constants_storage));
+    command_buffer->push_constants_length = 0;
+    command_buffer->push_constants_clobbered = false;
     status = iree_hal_resource_set_allocate(block_pool,
                                             &command_buffer->resource_set);
-  }
-
-  if (iree_status_is_ok(status)) {
-    *out_command_buffer = &command_buffer->base;
-  } else {
-    command_pool->Free(handle);
+    if (iree_status_is_ok(status)) {
+      *out_command_buffer = &command_buffer->base;
+    } else {
+      iree_hal_vulkan_direct_command_buffer_free(command_buffer);
+    }
   }
 
   IREE_TRACE_ZONE_END(z0);
@@ -165,18 +288,19 @@ static void iree_hal_vulkan_direct_command_buffer_destroy(
     iree_hal_command_buffer_t* base_command_buffer) {
   iree_hal_vulkan_direct_command_buffer_t* command_buffer =
       iree_hal_vulkan_direct_command_buffer_cast(base_command_buffer);
-  iree_allocator_t host_allocator =
-      command_buffer->logical_device->host_allocator();
   IREE_TRACE_ZONE_BEGIN(z0);
 
-  command_buffer->command_pool->Free(command_buffer->handle);
-
+  // Release everything the recording referenced; only the VkCommandBuffer and
+  // the descriptor set arena are kept if the command buffer is cached.
   IREE_IGNORE_ERROR(command_buffer->descriptor_set_group.Reset());
-  command_buffer->descriptor_set_group.~DescriptorSetGroup();
-  command_buffer->descriptor_set_arena.~DescriptorSetArena();
-
   iree_hal_resource_set_free(command_buffer->resource_set);
-  iree_allocator_free(host_allocator, command_buffer);
+  command_buffer->resource_set = NULL;
+
+  if (!command_buffer->cache ||
+      !iree_hal_vulkan_direct_command_buffer_cache_release(
+          command_buffer->cache, command_buffer)) {
+    iree_hal_vulkan_direct_command_buffer_free(command_buffer);
+  }
 
   IREE_TRACE_ZONE_END(z0);
 }
@@ -553,14 +677,23 @@ static iree_status_t iree_hal_vulkan_direct_command_buffer_fill_buffer(
   // fill operations, if needed.
 
   if (target_offset % 4 != 0 || length % 4 != 0) {
-    // TODO(scotttodd): only restore push constants that have been modified?
-    //                  (this can pass uninitialized memory right now, which
-    //                   *should* be safe but is wasteful)
+    if (!iree_all_bits_set(
+            iree_hal_command_buffer_allowed_categories(base_command_buffer),
+            IREE_HAL_COMMAND_CATEGORY_DISPATCH)) {
+      return iree_make_status(
+          IREE_STATUS_FAILED_PRECONDITION,
+          "unaligned fills require dispatches and cannot be recorded into "
+          "transfer-only command buffers executing on transfer queues "
+          "(target_offset=%" PRIdsz ", length=%" PRIdsz ")",
+          target_offset, length);
+    }
     IREE_RETURN_IF_ERROR(
         command_buffer->builtin_executables->FillBufferUnaligned(
             command_buffer->handle, &(command_buffer->descriptor_set_arena),
-            target_buffer, target_offset, length, pattern, pattern_length,
-            command_buffer->push_constants_storage));
+            target_buffer, target_offset, length, pattern, pattern_length));
+    if (command_buffer->push_constants_length > 0) {
+      command_buffer->push_constants_clobbered = true;
+    }
 
     // Continue using vkCmdFillBuffer below, but only for the inner aligned
     // portion of the fill operation.
@@ -670,11 +803,21 @@ static iree_status_t iree_hal_vulkan_direct_command_buffer_push_constants(
   iree_hal_vulkan_direct_command_buffer_t* command_buffer =
       iree_hal_vulkan_direct_command_buffer_cast(base_command_buffer);
 
+  // Shadow the range builtin executables may overwrite. Pushing the whole
+  // written prefix makes restoring it unnecessary.
   iree_host_size_t storage_size =
       IREE_ARRAYSIZE(command_buffer->push_constants_storage);
   if (offset < storage_size) {
+    iree_host_size_t shadow_length =
+        std::min(values_length, storage_size - offset);
     memcpy(command_buffer->push_constants_storage + offset, values,
-           std::min(values_length, storage_size) - offset);
+           shadow_length);
+    if (offset == 0 && shadow_length >= command_buffer->push_constants_length) {
+      command_buffer->push_constants_clobbered = false;
+    }
+    command_buffer->push_constants_length =
+        std::max(command_buffer->push_constants_length,
+                 iree_host_align(offset + shadow_length, 4));
   }
 
   command_buffer->syms->vkCmdPushConstants(
@@ -708,6 +851,16 @@ static iree_status_t iree_hal_vulkan_direct_command_buffer_push_descriptor_set(
       command_buffer->handle, pipeline_layout, set, binding_count, bindings);
 }
 
+// Restores push constants overwritten by builtin executables, if any.
+static void iree_hal_vulkan_direct_command_buffer_restore_push_constants(
+    iree_hal_vulkan_direct_command_buffer_t* command_buffer) {
+  if (!command_buffer->push_constants_clobbered) return;
+  command_buffer->builtin_executables->RestorePushConstants(
+      command_buffer->handle, command_buffer->push_constants_storage,
+      command_buffer->push_constants_length);
+  command_buffer->push_constants_clobbered = false;
+}
+
 static iree_status_t iree_hal_vulkan_direct_command_buffer_dispatch(
     iree_hal_command_buffer_t* base_command_buffer,
     iree_hal_executable_t* executable, int32_t entry_point,
@@ -738,6 +891,7 @@ static iree_status_t iree_hal_vulkan_direct_command_buffer_dispatch(
   command_buffer->syms->vkCmdBindPipeline(
       command_buffer->handle, VK_PIPELINE_BIND_POINT_COMPUTE, pipeline_handle);
 
+  iree_hal_vulkan_direct_command_buffer_restore_push_constants(command_buffer);
   command_buffer->syms->vkCmdDispatch(command_buffer->handle, workgroup_x,
                                       workgroup_y, workgroup_z);
 
@@ -780,6 +934,7 @@ static iree_status_t iree_hal_vulkan_direct_command_buffer_dispatch_indirect(
   VkBuffer workgroups_device_buffer = iree_hal_vulkan_vma_buffer_handle(
       iree_hal_buffer_allocated_buffer(workgroups_buffer));
   workgroups_offset += iree_hal_buffer_byte_offset(workgroups_buffer);
+  iree_hal_vulkan_direct_command_buffer_restore_push_constants(command_buffer);
   command_buffer->syms->vkCmdDispatchIndirect(
       command_buffer->handle, workgroups_device_buffer, workgroups_offset);
 
@@ -796,17 +951,28 @@ static iree_status_t iree_hal_vulkan_direct_command_buffer_execute_commands(
   iree_hal_vulkan_direct_command_buffer_t* command_buffer =
       iree_hal_vulkan_direct_command_buffer_cast(base_command_buffer);
 
+  // Since Vulkan doesn't natively support binding tables nested command buffers
+  // using them are captured as deferred command buffers and replayed here with
+  // the binding table resolved. If we wanted to actually reuse the command
+  // buffers we'd need to use update-after-bind (where supported), device
+  // pointers (where supported), or descriptor indexing and a big ringbuffer
+  // (make a 1024 element descriptor array and cycle through it with each
+  // submission).
+  if (iree_hal_deferred_command_buffer_isa(base_commands)) {
+    IREE_RETURN_IF_ERROR(iree_hal_resource_set_insert(
+        command_buffer->resource_set, 1, &base_commands));
+    for (iree_host_size_t i = 0; i < binding_table.count; ++i) {
+      if (!binding_table.bindings[i].buffer) continue;
+      IREE_RETURN_IF_ERROR(iree_hal_resource_set_insert(
+          command_buffer->resource_set, 1, &binding_table.bindings[i].buffer));
+    }
+    return iree_hal_deferred_command_buffer_apply_commands(
+        base_commands, base_command_buffer, binding_table);
+  }
   if (binding_table.count > 0) {
-    // TODO(#10144): support indirect command buffers with binding tables.
-    // Since Vulkan doesn't natively support this we'd need to emulate things
-    // with an iree_hal_vulkan_indirect_command_buffer_t type that captured the
-    // command buffer using deferred command buffer and allowed replay with a
-    // binding table. If we wanted to actually reuse the command buffers we'd
-    // need to use update-after-bind (where supported), device pointers (where
-    // supported), or descriptor indexing and a big ringbuffer (make a 1024
-    // element descriptor array and cycle through it with each submission).
-    return iree_make_status(IREE_STATUS_UNIMPLEMENTED,
-                            "indirect command buffers not yet implemented");
+    return iree_make_status(IREE_STATUS_INVALID_ARGUMENT,
+                            "binding tables can only be used with nested "
+                            "command buffers created with a binding capacity");
   }
 
   IREE_RETURN_IF_ERROR(iree_hal_resource_set_insert(
@@ -8,6 +8,7 @@
 #define IREE_HAL_DRIVERS_VULKAN_DIRECT_COMMAND_BUFFER_H_
 
 #include "iree/base/api.h"
+#include "iree/base/internal/synchronization.h"
 #include "iree/hal/api.h"
 #include "iree/hal/drivers/vulkan/builtin_executables.h"
 #include "iree/hal/drivers/vulkan/descriptor_pool_cache.h"
@@ -19,11 +20,60 @@ extern "C" {
 #endif  // __cplusplus
 
 typedef struct iree_arena_block_pool_t iree_arena_block_pool_t;
+typedef struct iree_hal_vulkan_direct_command_buffer_t
+    iree_hal_vulkan_direct_command_buffer_t;
+
+//===----------------------------------------------------------------------===//
+// iree_hal_vulkan_direct_command_buffer_cache_t
+//===----------------------------------------------------------------------===//
+
+// Maximum number of released command buffers retained by a cache.
+#define IREE_HAL_VULKAN_DIRECT_COMMAND_BUFFER_CACHE_CAPACITY 32
+
+// A cache of released direct command buffers available for reuse.
+//
+// Command buffers allocated with a cache return to it when their last
+// reference is released instead of being destroyed. They keep their
+// VkCommandBuffer (and the command pool memory backing its last recording)
+// along with their descriptor set arena so that a later allocation from the
+// same command pool skips vkAllocateCommandBuffers and the host allocations.
+// Command pools must be created with
+// VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT as reused command buffers are
+// implicitly reset by vkBeginCommandBuffer.
+typedef struct iree_hal_vulkan_direct_command_buffer_cache_t {
+  iree_slim_mutex_t mutex;
+  // Most recently released command buffer; LIFO so that reuse gets the
+  // allocations most likely to still be warm.
+  iree_hal_vulkan_direct_command_buffer_t* head IREE_GUARDED_BY(mutex);
+  iree_host_size_t count IREE_GUARDED_BY(mutex);
+} iree_hal_vulkan_direct_command_buffer_cache_t;
+
+// Initializes an empty |out_cache|.
+void iree_hal_vulkan_direct_command_buffer_cache_initialize(
+    iree_hal_vulkan_direct_command_buffer_cache_t* out_cache);
+
+// Destroys all cached command buffers and deinitializes |cache|.
+// No command buffers allocated with the cache may still be live and the
+// command pools they were allocated from must still be valid.
+void iree_hal_vulkan_direct_command_buffer_cache_deinitialize(
+    iree_hal_vulkan_direct_command_buffer_cache_t* cache);
+
+// Destroys all cached command buffers. Live command buffers are unaffected and
+// will return to the cache when released.
+void iree_hal_vulkan_direct_command_buffer_cache_trim(
+    iree_hal_vulkan_direct_command_buffer_cache_t* cache);
+
+//===----------------------------------------------------------------------===//
+// iree_hal_vulkan_direct_command_buffer_t
+//===----------------------------------------------------------------------===//
 
 // Creates a command buffer that directly records into a VkCommandBuffer.
+// If |cache| is provided a previously released command buffer allocated from
+// |command_pool| is reused when available and the command buffer returns to
+// the cache when released.
 //
-// NOTE: the |block_pool| must remain live for the lifetime of the command
-// buffers that use it.
+// NOTE: the |block_pool| and |cache| must remain live for the lifetime of the
+// command buffers that use them.
 iree_status_t iree_hal_vulkan_direct_command_buffer_allocate(
     iree_hal_device_t* device,
     iree::hal::vulkan::VkDeviceHandle* logical_device,
@@ -35,6 +85,7 @@ iree_status_t iree_hal_vulkan_direct_command_buffer_allocate(
     iree::hal::vulkan::DescriptorPoolCache* descriptor_pool_cache,
     iree::hal::vulkan::BuiltinExecutables* builtin_executables,
     iree_arena_block_pool_t* block_pool,
+    iree_hal_vulkan_direct_command_buffer_cache_t* cache,
     iree_hal_command_buffer_t** out_command_buffer);
 
 // Returns the native Vulkan VkCommandBuffer handle.
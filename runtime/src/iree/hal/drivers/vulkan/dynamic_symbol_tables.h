@@ -102,7 +102,7 @@ namespace vulkan {
   DEV_PFN(EXCLUDED, vkCmdProcessCommandsNVX)                            \
   DEV_PFN(REQUIRED, vkCmdPushConstants)                                 \
   DEV_PFN(OPTIONAL, vkCmdPushDescriptorSetKHR)                          \
-  DEV_PFN(EXCLUDED, vkCmdPushDescriptorSetWithTemplateKHR)              \
+  DEV_PFN(OPTIONAL, vkCmdPushDescriptorSetWithTemplateKHR)              \
   DEV_PFN(EXCLUDED, vkCmdReserveSpaceForCommandsNVX)                    \
   DEV_PFN(REQUIRED, vkCmdResetEvent)                                    \
   DEV_PFN(REQUIRED, vkCmdResetQueryPool)                                \
@@ -154,7 +154,7 @@ namespace vulkan {
   DEV_PFN(REQUIRED, vkCreateComputePipelines)                           \
   DEV_PFN(REQUIRED, vkCreateDescriptorPool)                             \
   DEV_PFN(REQUIRED, vkCreateDescriptorSetLayout)                        \
-  DEV_PFN(EXCLUDED, vkCreateDescriptorUpdateTemplate)                   \
+  DEV_PFN(OPTIONAL, vkCreateDescriptorUpdateTemplate)                   \
   DEV_PFN(EXCLUDED, vkCreateDescriptorUpdateTemplateKHR)                \
   DEV_PFN(REQUIRED, vkCreateEvent)                                      \
   DEV_PFN(REQUIRED, vkCreateFence)                                      \
@@ -186,7 +186,7 @@ namespace vulkan {
   DEV_PFN(REQUIRED, vkDestroyCommandPool)                               \
   DEV_PFN(REQUIRED, vkDestroyDescriptorPool)                            \
   DEV_PFN(REQUIRED, vkDestroyDescriptorSetLayout)                       \
-  DEV_PFN(EXCLUDED, vkDestroyDescriptorUpdateTemplate)                  \
+  DEV_PFN(OPTIONAL, vkDestroyDescriptorUpdateTemplate)                  \
   DEV_PFN(EXCLUDED, vkDestroyDescriptorUpdateTemplateKHR)               \
   DEV_PFN(REQUIRED, vkDestroyDevice)                                    \
   DEV_PFN(REQUIRED, vkDestroyEvent)                                     \
@@ -244,7 +244,7 @@ namespace vulkan {
   DEV_PFN(EXCLUDED, vkGetImageViewHandleNVX)                            \
   DEV_PFN(EXCLUDED, vkGetMemoryFdKHR)                                   \
   DEV_PFN(EXCLUDED, vkGetMemoryFdPropertiesKHR)                         \
-  DEV_PFN(EXCLUDED, vkGetMemoryHostPointerPropertiesEXT)                \
+  DEV_PFN(OPTIONAL, vkGetMemoryHostPointerPropertiesEXT)                \
   DEV_PFN(EXCLUDED, vkGetPastPresentationTimingGOOGLE)                  \
   DEV_PFN(REQUIRED, vkGetPipelineCacheData)                             \
   DEV_PFN(REQUIRED, vkGetQueryPoolResults)                              \
@@ -281,7 +281,7 @@ namespace vulkan {
   DEV_PFN(EXCLUDED, vkTrimCommandPoolKHR)                               \
   DEV_PFN(REQUIRED, vkUnmapMemory)                                      \
   DEV_PFN(EXCLUDED, vkUnregisterObjectsNVX)                             \
-  DEV_PFN(EXCLUDED, vkUpdateDescriptorSetWithTemplate)                  \
+  DEV_PFN(OPTIONAL, vkUpdateDescriptorSetWithTemplate)                  \
   DEV_PFN(EXCLUDED, vkUpdateDescriptorSetWithTemplateKHR)               \
   DEV_PFN(REQUIRED, vkUpdateDescriptorSets)                             \
   DEV_PFN(REQUIRED, vkWaitForFences)                                    \
@@ -0,0 +1,207 @@
+// Copyright 2023 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include "iree/hal/drivers/vulkan/native_executable_cache.h"
+
+#include <cstddef>
+#include <cstring>
+
+#include "iree/base/api.h"
+#include "iree/base/tracing.h"
+#include "iree/hal/drivers/vulkan/dynamic_symbol_tables.h"
+#include "iree/hal/drivers/vulkan/native_executable.h"
+#include "iree/hal/drivers/vulkan/status_util.h"
+
+using namespace iree::hal::vulkan;
+
+//===----------------------------------------------------------------------===//
+// VkPipelineCache utilities
+//===----------------------------------------------------------------------===//
+
+bool iree_hal_vulkan_pipeline_cache_data_is_compatible(
+    const VkPhysicalDeviceProperties* properties, iree_const_byte_span_t data) {
+  // The data may not be aligned (it could come from anywhere) so copy the
+  // header out instead of casting.
+  VkPipelineCacheHeaderVersionOne header;
+  if (data.data_length < sizeof(header)) return false;
+  memcpy(&header, data.data, sizeof(header));
+  return header.headerSize >= sizeof(header) &&
+         header.headerSize <= data.data_length &&
+         header.headerVersion == VK_PIPELINE_CACHE_HEADER_VERSION_ONE &&
+         header.vendorID == properties->vendorID &&
+         header.deviceID == properties->deviceID &&
+         memcmp(header.pipelineCacheUUID, properties->pipelineCacheUUID,
+                VK_UUID_SIZE) == 0;
+}
+
+iree_status_t iree_hal_vulkan_pipeline_cache_create(
+    VkDeviceHandle* logical_device, VkPhysicalDevice physical_device,
+    iree_const_byte_span_t initial_data, VkPipelineCache* out_pipeline_cache) {
+  IREE_ASSERT_ARGUMENT(logical_device);
+  IREE_ASSERT_ARGUMENT(out_pipeline_cache);
+  *out_pipeline_cache = VK_NULL_HANDLE;
+  IREE_TRACE_ZONE_BEGIN(z0);
+  IREE_TRACE_ZONE_APPEND_VALUE(z0, (int64_t)initial_data.data_length);
+
+  // Data from another device or driver version is dropped: the cache is then
+  // repopulated as pipelines are created and serialized again for next time.
+  if (initial_data.data_length > 0) {
+    VkPhysicalDeviceProperties properties;
+    logical_device->syms()->vkGetPhysicalDeviceProperties(physical_device,
+                                                          &properties);
+    if (!iree_hal_vulkan_pipeline_cache_data_is_compatible(&properties,
+                                                           initial_data)) {
+      initial_data = iree_const_byte_span_empty();
+    }
+  }
+
+  VkPipelineCacheCreateInfo create_info;
+  create_info.sType = VK_STRUCTURE_TYPE_PIPELINE_CACHE_CREATE_INFO;
+  create_info.pNext = NULL;
+  create_info.flags = 0;
+  create_info.initialDataSize = initial_data.data_length;
+  create_info.pInitialData = initial_data.data;
+  iree_status_t status = VK_RESULT_TO_STATUS(
+      logical_device->syms()->vkCreatePipelineCache(
+          *logical_device, &create_info, logical_device->allocator(),
+          out_pipeline_cache),
+      "vkCreatePipelineCache");
+
+  IREE_TRACE_ZONE_END(z0);
+  return status;
+}
+
+iree_status_t iree_hal_vulkan_pipeline_cache_serialize(
+    VkDeviceHandle* logical_device, VkPipelineCache pipeline_cache,
+    iree_allocator_t host_allocator, iree_byte_span_t* out_data) {
+  IREE_ASSERT_ARGUMENT(logical_device);
+  IREE_ASSERT_ARGUMENT(out_data);
+  *out_data = iree_byte_span_empty();
+  IREE_TRACE_ZONE_BEGIN(z0);
+
+  size_t data_size = 0;
+  IREE_RETURN_AND_END_ZONE_IF_ERROR(
+      z0, VK_RESULT_TO_STATUS(logical_device->syms()->vkGetPipelineCacheData(
+                                  *logical_device, pipeline_cache, &data_size,
+                                  /*pData=*/NULL),
+                              "vkGetPipelineCacheData"));
+  IREE_TRACE_ZONE_APPEND_VALUE(z0, (int64_t)data_size);
+
+  uint8_t* data = NULL;
+  IREE_RETURN_AND_END_ZONE_IF_ERROR(
+      z0, iree_allocator_malloc(host_allocator, data_size, (void**)&data));
+
+  // Pipelines created concurrently may grow the cache after the size query.
+  // The implementation then writes as much as fits and returns VK_INCOMPLETE;
+  // whatever was written is still valid initial data so we keep it.
+  VkResult result = logical_device->syms()->vkGetPipelineCacheData(
+      *logical_device, pipeline_cache, &data_size, data);
+  iree_status_t status = iree_ok_status();
+  if (result != VK_INCOMPLETE) {
+    status = VK_RESULT_TO_STATUS(result, "vkGetPipelineCacheData");
+  }
+
+  if (iree_status_is_ok(status)) {
+    *out_data = iree_make_byte_span(data, data_size);
+  } else {
+    iree_allocator_free(host_allocator, data);
+  }
+  IREE_TRACE_ZONE_END(z0);
+  return status;
+}
+
+//===----------------------------------------------------------------------===//
+// iree_hal_vulkan_native_executable_cache_t
+//===----------------------------------------------------------------------===//
+
+typedef struct iree_hal_vulkan_native_executable_cache_t {
+  iree_hal_resource_t resource;
+  VkDeviceHandle* logical_device;
+  // Unowned; shared with all other executable caches created on the device.
+  VkPipelineCache pipeline_cache;
+} iree_hal_vulkan_native_executable_cache_t;
+
+namespace {
+extern const iree_hal_executable_cache_vtable_t
+    iree_hal_vulkan_native_executable_cache_vtable;
+}  // namespace
+
+static iree_hal_vulkan_native_executable_cache_t*
+iree_hal_vulkan_native_executable_cache_cast(
+    iree_hal_executable_cache_t* base_value) {
+  IREE_HAL_ASSERT_TYPE(base_value,
+                       &iree_hal_vulkan_native_executable_cache_vtable);
+  return (iree_hal_vulkan_native_executable_cache_t*)base_value;
+}
+
+iree_status_t iree_hal_vulkan_native_executable_cache_create(
+    VkDeviceHandle* logical_device, iree_string_view_t identifier,
+    VkPipelineCache pipeline_cache,
+    iree_hal_executable_cache_t** out_executable_cache) {
+  IREE_ASSERT_ARGUMENT(out_executable_cache);
+  *out_executable_cache = NULL;
+  IREE_TRACE_ZONE_BEGIN(z0);
+
+  iree_hal_vulkan_native_executable_cache_t* executable_cache = NULL;
+  iree_status_t status = iree_allocator_malloc(logical_device->host_allocator(),
+                                               sizeof(*executable_cache),
+                                               (void**)&executable_cache);
+  if (iree_status_is_ok(status)) {
+    iree_hal_resource_initialize(
+        &iree_hal_vulkan_native_executable_cache_vtable,
+        &executable_cache->resource);
+    executable_cache->logical_device = logical_device;
+    executable_cache->pipeline_cache = pipeline_cache;
+
+    *out_executable_cache = (iree_hal_executable_cache_t*)executable_cache;
+  }
+
+  IREE_TRACE_ZONE_END(z0);
+  return status;
+}
+
+static void iree_hal_vulkan_native_executable_cache_destroy(
+    iree_hal_executable_cache_t* base_executable_cache) {
+  iree_hal_vulkan_native_executable_cache_t* executable_cache =
+      iree_hal_vulkan_native_executable_cache_cast(base_executable_cache);
+  iree_allocator_t host_allocator =
+      executable_cache->logical_device->host_allocator();
+  IREE_TRACE_ZONE_BEGIN(z0);
+
+  iree_allocator_free(host_allocator, executable_cache);
+
+  IREE_TRACE_ZONE_END(z0);
+}
+
+static bool iree_hal_vulkan_native_executable_cache_can_prepare_format(
+    iree_hal_executable_cache_t* base_executable_cache,
+    iree_hal_executable_caching_mode_t caching_mode,
+    iree_string_view_t executable_format) {
+  return iree_string_view_equal(executable_format,
+                                iree_make_cstring_view("SPVE"));
+}
+
+static iree_status_t iree_hal_vulkan_native_executable_cache_prepare_executable(
+    iree_hal_executable_cache_t* base_executable_cache,
+    const iree_hal_executable_params_t* executable_params,
+    iree_hal_executable_t** out_executable) {
+  iree_hal_vulkan_native_executable_cache_t* executable_cache =
+      iree_hal_vulkan_native_executable_cache_cast(base_executable_cache);
+  return iree_hal_vulkan_native_executable_create(
+      executable_cache->logical_device, executable_cache->pipeline_cache,
+      executable_params, out_executable);
+}
+
+namespace {
+const iree_hal_executable_cache_vtable_t
+    iree_hal_vulkan_native_executable_cache_vtable = {
+        /*.destroy=*/iree_hal_vulkan_native_executable_cache_destroy,
+        /*.can_prepare_format=*/
+        iree_hal_vulkan_native_executable_cache_can_prepare_format,
+        /*.prepare_executable=*/
+        iree_hal_vulkan_native_executable_cache_prepare_executable,
+};
+}  // namespace
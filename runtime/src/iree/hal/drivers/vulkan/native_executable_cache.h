@@ -0,0 +1,66 @@
+// Copyright 2023 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#ifndef IREE_HAL_DRIVERS_VULKAN_NATIVE_EXECUTABLE_CACHE_H_
+#define IREE_HAL_DRIVERS_VULKAN_NATIVE_EXECUTABLE_CACHE_H_
+
+#include "iree/base/api.h"
+#include "iree/hal/api.h"
+#include "iree/hal/drivers/vulkan/handle_util.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif  // __cplusplus
+
+//===----------------------------------------------------------------------===//
+// VkPipelineCache utilities
+//===----------------------------------------------------------------------===//
+
+// Returns true if |data| is serialized VkPipelineCache data produced by the
+// same implementation as the physical device described by |properties|.
+//
+// The Vulkan spec requires implementations to ignore incompatible initial data
+// but some drivers crash or silently produce bad pipelines when handed data
+// from another driver version, so we check the header ourselves before passing
+// anything through.
+bool iree_hal_vulkan_pipeline_cache_data_is_compatible(
+    const VkPhysicalDeviceProperties* properties, iree_const_byte_span_t data);
+
+// Creates a VkPipelineCache seeded with |initial_data|, if any. Initial data
+// that is not compatible with |physical_device| is discarded and an empty
+// cache is created instead.
+iree_status_t iree_hal_vulkan_pipeline_cache_create(
+    iree::hal::vulkan::VkDeviceHandle* logical_device,
+    VkPhysicalDevice physical_device, iree_const_byte_span_t initial_data,
+    VkPipelineCache* out_pipeline_cache);
+
+// Serializes the contents of |pipeline_cache| into a buffer allocated from
+// |host_allocator|. The returned data can be passed back as initial data when
+// creating a pipeline cache on a compatible device, including in a later run
+// of the process. The caller must free |out_data| with |host_allocator|.
+iree_status_t iree_hal_vulkan_pipeline_cache_serialize(
+    iree::hal::vulkan::VkDeviceHandle* logical_device,
+    VkPipelineCache pipeline_cache, iree_allocator_t host_allocator,
+    iree_byte_span_t* out_data);
+
+//===----------------------------------------------------------------------===//
+// iree_hal_vulkan_native_executable_cache_t
+//===----------------------------------------------------------------------===//
+
+// Creates an executable cache that creates all pipelines through
+// |pipeline_cache|, allowing the implementation to skip shader compilation for
+// pipelines it has seen before. |pipeline_cache| must remain valid for the
+// lifetime of the executable cache.
+iree_status_t iree_hal_vulkan_native_executable_cache_create(
+    iree::hal::vulkan::VkDeviceHandle* logical_device,
+    iree_string_view_t identifier, VkPipelineCache pipeline_cache,
+    iree_hal_executable_cache_t** out_executable_cache);
+
+#ifdef __cplusplus
+}  // extern "C"
+#endif  // __cplusplus
+
+#endif  // IREE_HAL_DRIVERS_VULKAN_NATIVE_EXECUTABLE_CACHE_H_
@@ -8,6 +8,7 @@
 
 #include <cstddef>
 #include <cstdint>
+#include <cstring>
 
 #include "iree/base/api.h"
 #include "iree/base/tracing.h"
@@ -27,6 +28,10 @@ typedef struct iree_hal_vulkan_native_descriptor_set_layout_t {
   iree_hal_resource_t resource;
   VkDeviceHandle* logical_device;
   VkDescriptorSetLayout handle;
+  // Layout bindings, retained for building descriptor update templates and
+  // mapping bindings to template data slots.
+  iree_host_size_t binding_count;
+  iree_hal_descriptor_set_layout_binding_t bindings[];
 } iree_hal_vulkan_native_descriptor_set_layout_t;
 
 namespace {
@@ -119,15 +124,23 @@ iree_status_t iree_hal_vulkan_native_descriptor_set_layout_create(
               logical_device, flags, binding_count, bindings, &handle));
 
   iree_hal_vulkan_native_descriptor_set_layout_t* descriptor_set_layout = NULL;
-  iree_status_t status = iree_allocator_malloc(logical_device->host_allocator(),
-                                               sizeof(*descriptor_set_layout),
-                                               (void**)&descriptor_set_layout);
+  iree_host_size_t total_size =
+      sizeof(*descriptor_set_layout) +
+      binding_count * sizeof(*descriptor_set_layout->bindings);
+  iree_status_t status =
+      iree_allocator_malloc(logical_device->host_allocator(), total_size,
+                            (void**)&descriptor_set_layout);
   if (iree_status_is_ok(status)) {
     iree_hal_resource_initialize(
         &iree_hal_vulkan_native_descriptor_set_layout_vtable,
         &descriptor_set_layout->resource);
     descriptor_set_layout->logical_device = logical_device;
     descriptor_set_layout->handle = handle;
+    descriptor_set_layout->binding_count = binding_count;
+    if (binding_count > 0) {
+      memcpy(descriptor_set_layout->bindings, bindings,
+             binding_count * sizeof(*descriptor_set_layout->bindings));
+    }
     *out_descriptor_set_layout =
         (iree_hal_descriptor_set_layout_t*)descriptor_set_layout;
   } else {
@@ -162,6 +175,23 @@ VkDescriptorSetLayout iree_hal_vulkan_native_descriptor_set_layout_handle(
   return descriptor_set_layout->handle;
 }
 
+iree_host_size_t iree_hal_vulkan_native_descriptor_set_layout_binding_count(
+    iree_hal_descriptor_set_layout_t* base_descriptor_set_layout) {
+  iree_hal_vulkan_native_descriptor_set_layout_t* descriptor_set_layout =
+      iree_hal_vulkan_native_descriptor_set_layout_cast(
+          base_descriptor_set_layout);
+  return descriptor_set_layout->binding_count;
+}
+
+const iree_hal_descriptor_set_layout_binding_t*
+iree_hal_vulkan_native_descriptor_set_layout_bindings(
+    iree_hal_descriptor_set_layout_t* base_descriptor_set_layout) {
+  iree_hal_vulkan_native_descriptor_set_layout_t* descriptor_set_layout =
+      iree_hal_vulkan_native_descriptor_set_layout_cast(
+          base_descriptor_set_layout);
+  return descriptor_set_layout->bindings;
+}
+
 namespace {
 const iree_hal_descriptor_set_layout_vtable_t
     iree_hal_vulkan_native_descriptor_set_layout_vtable = {
@@ -177,6 +207,9 @@ typedef struct iree_hal_vulkan_native_pipeline_layout_t {
   iree_hal_resource_t resource;
   VkDeviceHandle* logical_device;
   VkPipelineLayout handle;
+  // One descriptor update template per set layout, or VK_NULL_HANDLE for sets
+  // that must be updated with VkWriteDescriptorSet lists.
+  VkDescriptorUpdateTemplate* update_templates;
   iree_host_size_t set_layout_count;
   iree_hal_descriptor_set_layout_t* set_layouts[];
 } iree_hal_vulkan_native_pipeline_layout_t;
@@ -228,6 +261,88 @@ static iree_status_t iree_hal_vulkan_create_pipeline_layout(
                              "vkCreatePipelineLayout");
 }
 
+// Creates a descriptor update template for |set| that writes one
+// VkDescriptorBufferInfo per layout binding, in layout binding order.
+// Templates are pushed directly into command buffers when push descriptors are
+// available and are otherwise used to update pooled descriptor sets. Leaves
+// |out_handle| as VK_NULL_HANDLE if the device lacks template support (Vulkan
+// 1.0 without VK_KHR_descriptor_update_template).
+static iree_status_t iree_hal_vulkan_create_descriptor_update_template(
+    VkDeviceHandle* logical_device, VkPipelineLayout pipeline_layout,
+    uint32_t set, iree_hal_descriptor_set_layout_t* set_layout,
+    VkDescriptorUpdateTemplate* out_handle) {
+  *out_handle = VK_NULL_HANDLE;
+  const auto& syms = logical_device->syms();
+  if (!syms->vkCreateDescriptorUpdateTemplate ||
+      !syms->vkDestroyDescriptorUpdateTemplate) {
+    return iree_ok_status();
+  }
+  VkDescriptorUpdateTemplateType template_type;
+  if (logical_device->enabled_extensions().push_descriptors) {
+    if (!syms->vkCmdPushDescriptorSetWithTemplateKHR) return iree_ok_status();
+    template_type = VK_DESCRIPTOR_UPDATE_TEMPLATE_TYPE_PUSH_DESCRIPTORS_KHR;
+  } else {
+    if (!syms->vkUpdateDescriptorSetWithTemplate) return iree_ok_status();
+    template_type = VK_DESCRIPTOR_UPDATE_TEMPLATE_TYPE_DESCRIPTOR_SET;
+  }
+
+  iree_host_size_t binding_count =
+      iree_hal_vulkan_native_descriptor_set_layout_binding_count(set_layout);
+  const iree_hal_descriptor_set_layout_binding_t* bindings =
+      iree_hal_vulkan_native_descriptor_set_layout_bindings(set_layout);
+  if (binding_count == 0) return iree_ok_status();
+
+  // Template data is a flat array of buffer infos; sets with texel buffer
+  // views are always updated with VkWriteDescriptorSet lists instead.
+  for (iree_host_size_t i = 0; i < binding_count; ++i) {
+    if (bindings[i].type == IREE_HAL_DESCRIPTOR_TYPE_UNIFORM_TEXEL_BUFFER) {
+      return iree_ok_status();
+    }
+  }
+
+  VkDescriptorUpdateTemplateEntry* entries = NULL;
+  IREE_RETURN_IF_ERROR(iree_allocator_malloc(
+      logical_device->host_allocator(), binding_count * sizeof(*entries),
+      (void**)&entries));
+  for (iree_host_size_t i = 0; i < binding_count; ++i) {
+    VkDescriptorUpdateTemplateEntry* entry = &entries[i];
+    entry->dstBinding = bindings[i].binding;
+    entry->dstArrayElement = 0;
+    entry->descriptorCount = 1;
+    entry->descriptorType = static_cast<VkDescriptorType>(bindings[i].type);
+    entry->offset = i * sizeof(VkDescriptorBufferInfo);
+    entry->stride = sizeof(VkDescriptorBufferInfo);
+  }
+
+  VkDescriptorUpdateTemplateCreateInfo create_info;
+  create_info.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_UPDATE_TEMPLATE_CREATE_INFO;
+  create_info.pNext = NULL;
+  create_info.flags = 0;
+  create_info.descriptorUpdateEntryCount = (uint32_t)binding_count;
+  create_info.pDescriptorUpdateEntries = entries;
+  create_info.templateType = template_type;
+  create_info.descriptorSetLayout =
+      iree_hal_vulkan_native_descriptor_set_layout_handle(set_layout);
+  create_info.pipelineBindPoint = VK_PIPELINE_BIND_POINT_COMPUTE;
+  create_info.pipelineLayout = pipeline_layout;
+  create_info.set = set;
+  iree_status_t status = VK_RESULT_TO_STATUS(
+      syms->vkCreateDescriptorUpdateTemplate(*logical_device, &create_info,
+                                             logical_device->allocator(),
+                                             out_handle),
+      "vkCreateDescriptorUpdateTemplate");
+
+  iree_allocator_free(logical_device->host_allocator(), entries);
+  return status;
+}
+
+static void iree_hal_vulkan_destroy_descriptor_update_template(
+    VkDeviceHandle* logical_device, VkDescriptorUpdateTemplate handle) {
+  if (handle == VK_NULL_HANDLE) return;
+  logical_device->syms()->vkDestroyDescriptorUpdateTemplate(
+      *logical_device, handle, logical_device->allocator());
+}
+
 static void iree_hal_vulkan_destroy_pipeline_layout(
     VkDeviceHandle* logical_device, VkPipelineLayout handle) {
   if (handle == VK_NULL_HANDLE) return;
@@ -255,7 +370,8 @@ iree_status_t iree_hal_vulkan_native_pipeline_layout_create(
   iree_hal_vulkan_native_pipeline_layout_t* pipeline_layout = NULL;
   iree_host_size_t total_size =
       sizeof(*pipeline_layout) +
-      set_layout_count * sizeof(*pipeline_layout->set_layouts);
+      set_layout_count * sizeof(*pipeline_layout->set_layouts) +
+      set_layout_count * sizeof(*pipeline_layout->update_templates);
   iree_status_t status = iree_allocator_malloc(
       logical_device->host_allocator(), total_size, (void**)&pipeline_layout);
   if (iree_status_is_ok(status)) {
@@ -263,16 +379,33 @@ iree_status_t iree_hal_vulkan_native_pipeline_layout_create(
                                  &pipeline_layout->resource);
     pipeline_layout->logical_device = logical_device;
     pipeline_layout->handle = handle;
+    pipeline_layout->update_templates =
+        (VkDescriptorUpdateTemplate*)(pipeline_layout->set_layouts +
+                                      set_layout_count);
     pipeline_layout->set_layout_count = set_layout_count;
     for (iree_host_size_t i = 0; i < set_layout_count; ++i) {
       pipeline_layout->set_layouts[i] = set_layouts[i];
       iree_hal_descriptor_set_layout_retain(set_layouts[i]);
+      pipeline_layout->update_templates[i] = VK_NULL_HANDLE;
     }
     *out_pipeline_layout = (iree_hal_pipeline_layout_t*)pipeline_layout;
   } else {
     iree_hal_vulkan_destroy_pipeline_layout(logical_device, handle);
   }
 
+  // Each set gets a template so dispatches can update descriptors without
+  // building VkWriteDescriptorSet lists.
+  for (iree_host_size_t i = 0; i < set_layout_count; ++i) {
+    if (!iree_status_is_ok(status)) break;
+    status = iree_hal_vulkan_create_descriptor_update_template(
+        logical_device, handle, (uint32_t)i, set_layouts[i],
+        &pipeline_layout->update_templates[i]);
+  }
+  if (!iree_status_is_ok(status) && *out_pipeline_layout) {
+    iree_hal_pipeline_layout_release(*out_pipeline_layout);
+    *out_pipeline_layout = NULL;
+  }
+
   IREE_TRACE_ZONE_END(z0);
   return status;
 }
@@ -285,6 +418,10 @@ static void iree_hal_vulkan_native_pipeline_layout_destroy(
       pipeline_layout->logical_device->host_allocator();
   IREE_TRACE_ZONE_BEGIN(z0);
 
+  for (iree_host_size_t i = 0; i < pipeline_layout->set_layout_count; ++i) {
+    iree_hal_vulkan_destroy_descriptor_update_template(
+        pipeline_layout->logical_device, pipeline_layout->update_templates[i]);
+  }
   iree_hal_vulkan_destroy_pipeline_layout(pipeline_layout->logical_device,
                                           pipeline_layout->handle);
   for (iree_host_size_t i = 0; i < pipeline_layout->set_layout_count; ++i) {
@@ -320,6 +457,18 @@ iree_hal_descriptor_set_layout_t* iree_hal_vulkan_native_pipeline_layout_set(
   return pipeline_layout->set_layouts[set_index];
 }
 
+VkDescriptorUpdateTemplate
+iree_hal_vulkan_native_pipeline_layout_update_template(
+    iree_hal_pipeline_layout_t* base_pipeline_layout,
+    iree_host_size_t set_index) {
+  iree_hal_vulkan_native_pipeline_layout_t* pipeline_layout =
+      iree_hal_vulkan_native_pipeline_layout_cast(base_pipeline_layout);
+  if (IREE_UNLIKELY(set_index >= pipeline_layout->set_layout_count)) {
+    return VK_NULL_HANDLE;
+  }
+  return pipeline_layout->update_templates[set_index];
+}
+
 namespace {
 const iree_hal_pipeline_layout_vtable_t
     iree_hal_vulkan_native_pipeline_layout_vtable = {
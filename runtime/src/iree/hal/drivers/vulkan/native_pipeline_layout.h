@@ -35,6 +35,15 @@ iree_status_t iree_hal_vulkan_native_descriptor_set_layout_create(
 VkDescriptorSetLayout iree_hal_vulkan_native_descriptor_set_layout_handle(
     iree_hal_descriptor_set_layout_t* base_descriptor_set_layout);
 
+// Returns the number of bindings in the descriptor set layout.
+iree_host_size_t iree_hal_vulkan_native_descriptor_set_layout_binding_count(
+    iree_hal_descriptor_set_layout_t* base_descriptor_set_layout);
+
+// Returns the bindings of the descriptor set layout in declaration order.
+const iree_hal_descriptor_set_layout_binding_t*
+iree_hal_vulkan_native_descriptor_set_layout_bindings(
+    iree_hal_descriptor_set_layout_t* base_descriptor_set_layout);
+
 //===----------------------------------------------------------------------===//
 // iree_hal_vulkan_native_pipeline_layout_t
 //===----------------------------------------------------------------------===//
@@ -59,6 +68,17 @@ iree_host_size_t iree_hal_vulkan_native_pipeline_layout_set_count(
 iree_hal_descriptor_set_layout_t* iree_hal_vulkan_native_pipeline_layout_set(
     iree_hal_pipeline_layout_t* pipeline_layout, iree_host_size_t set_index);
 
+// Returns the descriptor update template for the set with the given
+// |set_index| or VK_NULL_HANDLE if the set must be updated without one.
+// The template consumes one VkDescriptorBufferInfo per binding of the set
+// layout, in the order returned by
+// iree_hal_vulkan_native_descriptor_set_layout_bindings. Its type matches how
+// descriptor sets are bound on the device: push descriptor templates when
+// VK_KHR_push_descriptor is enabled and descriptor set templates otherwise.
+VkDescriptorUpdateTemplate
+iree_hal_vulkan_native_pipeline_layout_update_template(
+    iree_hal_pipeline_layout_t* pipeline_layout, iree_host_size_t set_index);
+
 #ifdef __cplusplus
 }  // extern "C"
 #endif  // __cplusplus
@@ -34,10 +34,19 @@ IREE_FLAG(bool, vulkan_tracing, true,
 IREE_FLAG(
     bool, vulkan_dedicated_compute_queue, false,
     "Use a dedicated queue with VK_QUEUE_COMPUTE_BIT for dispatch workloads.");
+IREE_FLAG(bool, vulkan_dedicated_transfer_queues, false,
+          "Submits transfer-only command buffers to dedicated queues with "
+          "VK_QUEUE_TRANSFER_BIT, if available.");
 IREE_FLAG(
     int64_t, vulkan_large_heap_block_size, 0,
     "Preferred allocator block size for large allocations in bytes. Sets the "
     "minimum bound on memory consumption.");
+IREE_FLAG(
+    string, vulkan_pipeline_cache_path, "",
+    "Path of a file used to persist the VkPipelineCache across runs. Pipelines "
+    "compiled by a previous run on the same device and driver are reused.");
+IREE_FLAG(bool, vulkan_disable_pipeline_cache, false,
+          "Compiles all pipelines without a VkPipelineCache.");
 
 static iree_status_t iree_hal_vulkan_create_driver_with_flags(
     iree_string_view_t identifier, iree_allocator_t host_allocator,
@@ -76,10 +85,20 @@ static iree_status_t iree_hal_vulkan_create_driver_with_flags(
     driver_options.device_options.flags |=
         IREE_HAL_VULKAN_DEVICE_FLAG_DEDICATED_COMPUTE_QUEUE;
   }
+  if (FLAG_vulkan_dedicated_transfer_queues) {
+    driver_options.device_options.flags |=
+        IREE_HAL_VULKAN_DEVICE_FLAG_DEDICATED_TRANSFER_QUEUES;
+  }
   if (FLAG_vulkan_large_heap_block_size) {
     driver_options.device_options.large_heap_block_size =
         FLAG_vulkan_large_heap_block_size;
   }
+  driver_options.device_options.pipeline_cache_path =
+      iree_make_cstring_view(FLAG_vulkan_pipeline_cache_path);
+  if (FLAG_vulkan_disable_pipeline_cache) {
+    driver_options.device_options.flags |=
+        IREE_HAL_VULKAN_DEVICE_FLAG_DISABLE_PIPELINE_CACHE;
+  }
 
   // Load the Vulkan library. This will fail if the library cannot be found or
   // does not have the expected functions.
@@ -0,0 +1,248 @@
+// Copyright 2023 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include "iree/hal/drivers/vulkan/staging_ring.h"
+
+#include <cstring>
+
+#include "iree/base/api.h"
+#include "iree/base/tracing.h"
+
+void iree_hal_vulkan_staging_ring_initialize(
+    iree_hal_device_t* device, iree_hal_vulkan_staging_ring_t* out_ring) {
+  IREE_ASSERT_ARGUMENT(device);
+  IREE_ASSERT_ARGUMENT(out_ring);
+  memset(out_ring, 0, sizeof(*out_ring));
+  out_ring->device = device;
+  iree_slim_mutex_initialize(&out_ring->mutex);
+}
+
+// Releases all staging buffers and the semaphore. The device must not be using
+// any of the chunks.
+static void iree_hal_vulkan_staging_ring_release_resources(
+    iree_hal_vulkan_staging_ring_t* ring) IREE_REQUIRES_LOCK(ring->mutex) {
+  for (iree_host_size_t i = 0; i < IREE_ARRAYSIZE(ring->chunks); ++i) {
+    iree_hal_vulkan_staging_chunk_t* chunk = &ring->chunks[i];
+    if (chunk->buffer) {
+      iree_status_ignore(iree_hal_buffer_unmap_range(&chunk->mapping));
+      iree_hal_buffer_release(chunk->buffer);
+    }
+    memset(chunk, 0, sizeof(*chunk));
+  }
+  iree_hal_semaphore_release(ring->semaphore);
+  ring->semaphore = NULL;
+  ring->next_value = 0;
+}
+
+void iree_hal_vulkan_staging_ring_deinitialize(
+    iree_hal_vulkan_staging_ring_t* ring) {
+  iree_slim_mutex_lock(&ring->mutex);
+  iree_hal_vulkan_staging_ring_release_resources(ring);
+  iree_slim_mutex_unlock(&ring->mutex);
+  iree_slim_mutex_deinitialize(&ring->mutex);
+}
+
+// Allocates the staging buffers and semaphore if they have not been yet.
+static iree_status_t iree_hal_vulkan_staging_ring_ensure_allocated(
+    iree_hal_vulkan_staging_ring_t* ring) IREE_REQUIRES_LOCK(ring->mutex) {
+  if (ring->semaphore) return iree_ok_status();
+  IREE_TRACE_ZONE_BEGIN(z0);
+
+  iree_status_t status =
+      iree_hal_semaphore_create(ring->device, 0ull, &ring->semaphore);
+  ring->next_value = 1;
+
+  // Staging buffers are only written or read by the host and copied by the
+  // device. Host-local memory is coherent so the persistent mappings need no
+  // flushes or invalidations.
+  iree_hal_buffer_params_t params;
+  memset(&params, 0, sizeof(params));
+  params.type =
+      IREE_HAL_MEMORY_TYPE_HOST_LOCAL | IREE_HAL_MEMORY_TYPE_DEVICE_VISIBLE;
+  params.usage = IREE_HAL_BUFFER_USAGE_TRANSFER | IREE_HAL_BUFFER_USAGE_MAPPING;
+  for (iree_host_size_t i = 0;
+       i < IREE_ARRAYSIZE(ring->chunks) && iree_status_is_ok(status); ++i) {
+    iree_hal_vulkan_staging_chunk_t* chunk = &ring->chunks[i];
+    status = iree_hal_allocator_allocate_buffer(
+        iree_hal_device_allocator(ring->device), params,
+        IREE_HAL_VULKAN_STAGING_RING_CHUNK_SIZE, iree_const_byte_span_empty(),
+        &chunk->buffer);
+    if (iree_status_is_ok(status)) {
+      status = iree_hal_buffer_map_range(
+          chunk->buffer, IREE_HAL_MAPPING_MODE_PERSISTENT,
+          IREE_HAL_MEMORY_ACCESS_READ | IREE_HAL_MEMORY_ACCESS_WRITE, 0,
+          IREE_WHOLE_BUFFER, &chunk->mapping);
+      if (!iree_status_is_ok(status)) {
+        iree_hal_buffer_release(chunk->buffer);
+        chunk->buffer = NULL;
+      }
+    }
+  }
+
+  if (!iree_status_is_ok(status)) {
+    iree_hal_vulkan_staging_ring_release_resources(ring);
+  }
+  IREE_TRACE_ZONE_END(z0);
+  return status;
+}
+
+// Waits until the device is no longer using |chunk|.
+static iree_status_t iree_hal_vulkan_staging_ring_wait_chunk(
+    iree_hal_vulkan_staging_ring_t* ring,
+    iree_hal_vulkan_staging_chunk_t* chunk, iree_time_t deadline_ns)
+    IREE_REQUIRES_LOCK(ring->mutex) {
+  if (!chunk->pending_value) return iree_ok_status();
+  IREE_RETURN_IF_ERROR(iree_hal_semaphore_wait(
+      ring->semaphore, chunk->pending_value, iree_make_deadline(deadline_ns)));
+  chunk->pending_value = 0;
+  return iree_ok_status();
+}
+
+iree_status_t iree_hal_vulkan_staging_ring_trim(
+    iree_hal_vulkan_staging_ring_t* ring) {
+  iree_slim_mutex_lock(&ring->mutex);
+  iree_status_t status = iree_ok_status();
+  for (iree_host_size_t i = 0;
+       i < IREE_ARRAYSIZE(ring->chunks) && iree_status_is_ok(status); ++i) {
+    status = iree_hal_vulkan_staging_ring_wait_chunk(ring, &ring->chunks[i],
+                                                     IREE_TIME_INFINITE_FUTURE);
+  }
+  if (iree_status_is_ok(status)) {
+    iree_hal_vulkan_staging_ring_release_resources(ring);
+  }
+  iree_slim_mutex_unlock(&ring->mutex);
+  return status;
+}
+
+bool iree_hal_vulkan_staging_ring_should_stage(
+    iree_hal_transfer_buffer_t source, iree_hal_transfer_buffer_t target) {
+  iree_hal_buffer_t* device_buffer = NULL;
+  if (!source.device_buffer && target.device_buffer) {
+    device_buffer = target.device_buffer;
+  } else if (source.device_buffer && !target.device_buffer) {
+    device_buffer = source.device_buffer;
+  } else {
+    return false;
+  }
+  return !iree_all_bits_set(iree_hal_buffer_memory_type(device_buffer),
+                            IREE_HAL_MEMORY_TYPE_HOST_VISIBLE) ||
+         !iree_all_bits_set(iree_hal_buffer_allowed_usage(device_buffer),
+                            IREE_HAL_BUFFER_USAGE_MAPPING);
+}
+
+// Submits a copy using |chunk| and marks the chunk as pending until it
+// completes.
+static iree_status_t iree_hal_vulkan_staging_ring_submit_copy(
+    iree_hal_vulkan_staging_ring_t* ring,
+    iree_hal_vulkan_staging_chunk_t* chunk,
+    const iree_hal_transfer_command_t* transfer_command)
+    IREE_REQUIRES_LOCK(ring->mutex) {
+  iree_hal_command_buffer_t* command_buffer = NULL;
+  IREE_RETURN_IF_ERROR(iree_hal_create_transfer_command_buffer(
+      ring->device,
+      IREE_HAL_COMMAND_BUFFER_MODE_ONE_SHOT |
+          IREE_HAL_COMMAND_BUFFER_MODE_ALLOW_INLINE_EXECUTION,
+      IREE_HAL_QUEUE_AFFINITY_ANY, 1, transfer_command, &command_buffer));
+  uint64_t signal_value = ring->next_value++;
+  iree_hal_semaphore_list_t signal_semaphores = {
+      /*.count=*/1,
+      /*.semaphores=*/&ring->semaphore,
+      /*.payload_values=*/&signal_value,
+  };
+  iree_status_t status = iree_hal_device_queue_execute(
+      ring->device, IREE_HAL_QUEUE_AFFINITY_ANY,
+      iree_hal_semaphore_list_empty(), signal_semaphores, 1, &command_buffer);
+  if (iree_status_is_ok(status)) {
+    chunk->pending_value = signal_value;
+  }
+  iree_hal_command_buffer_release(command_buffer);
+  return status;
+}
+
+iree_status_t iree_hal_vulkan_staging_ring_transfer_range(
+    iree_hal_vulkan_staging_ring_t* ring, iree_hal_transfer_buffer_t source,
+    iree_device_size_t source_offset, iree_hal_transfer_buffer_t target,
+    iree_device_size_t target_offset, iree_device_size_t data_length,
+    iree_timeout_t timeout) {
+  IREE_ASSERT_ARGUMENT(ring);
+  IREE_ASSERT(iree_hal_vulkan_staging_ring_should_stage(source, target));
+  IREE_TRACE_ZONE_BEGIN(z0);
+  IREE_TRACE_ZONE_APPEND_VALUE(z0, (int64_t)data_length);
+  const bool is_upload = source.device_buffer == NULL;
+  const iree_time_t deadline_ns = iree_timeout_as_deadline_ns(timeout);
+
+  iree_slim_mutex_lock(&ring->mutex);
+  iree_status_t status = iree_hal_vulkan_staging_ring_ensure_allocated(ring);
+
+  // Host ranges of downloaded chunks that must be read back from the chunk
+  // before it's reused, indexed by chunk.
+  iree_device_size_t readback_offsets[IREE_ARRAYSIZE(ring->chunks)] = {0};
+  iree_device_size_t readback_lengths[IREE_ARRAYSIZE(ring->chunks)] = {0};
+
+  // Round-robin over the chunks; each iteration only waits for the copy that
+  // used the chunk |chunk_count| iterations ago so the host copies overlap
+  // with the device copies of the other chunks.
+  iree_host_size_t chunk_ordinal = 0;
+  iree_device_size_t offset = 0;
+  while (iree_status_is_ok(status) && offset < data_length) {
+    iree_host_size_t chunk_index =
+        chunk_ordinal++ % IREE_ARRAYSIZE(ring->chunks);
+    iree_hal_vulkan_staging_chunk_t* chunk = &ring->chunks[chunk_index];
+    iree_device_size_t chunk_length =
+        iree_min(data_length - offset,
+                 (iree_device_size_t)IREE_HAL_VULKAN_STAGING_RING_CHUNK_SIZE);
+    status = iree_hal_vulkan_staging_ring_wait_chunk(ring, chunk, deadline_ns);
+    if (!iree_status_is_ok(status)) break;
+
+    iree_hal_transfer_command_t transfer_command;
+    memset(&transfer_command, 0, sizeof(transfer_command));
+    transfer_command.type = IREE_HAL_TRANSFER_COMMAND_TYPE_COPY;
+    transfer_command.copy.length = chunk_length;
+    if (is_upload) {
+      memcpy(chunk->mapping.contents.data,
+             (const uint8_t*)source.host_buffer.data + source_offset + offset,
+             chunk_length);
+      transfer_command.copy.source_buffer = chunk->buffer;
+      transfer_command.copy.source_offset = 0;
+      transfer_command.copy.target_buffer = target.device_buffer;
+      transfer_command.copy.target_offset = target_offset + offset;
+    } else {
+      if (readback_lengths[chunk_index]) {
+        memcpy((uint8_t*)target.host_buffer.data + target_offset +
+                   readback_offsets[chunk_index],
+               chunk->mapping.contents.data, readback_lengths[chunk_index]);
+      }
+      readback_offsets[chunk_index] = offset;
+      readback_lengths[chunk_index] = chunk_length;
+      transfer_command.copy.source_buffer = source.device_buffer;
+      transfer_command.copy.source_offset = source_offset + offset;
+      transfer_command.copy.target_buffer = chunk->buffer;
+      transfer_command.copy.target_offset = 0;
+    }
+    status = iree_hal_vulkan_staging_ring_submit_copy(ring, chunk,
+                                                      &transfer_command);
+    offset += chunk_length;
+  }
+
+  // Wait for the remaining copies and read back the downloaded chunks. Even on
+  // failure we try to wait so that the chunks are not reused while in flight.
+  for (iree_host_size_t i = 0; i < IREE_ARRAYSIZE(ring->chunks); ++i) {
+    iree_hal_vulkan_staging_chunk_t* chunk = &ring->chunks[i];
+    iree_status_t wait_status =
+        iree_hal_vulkan_staging_ring_wait_chunk(ring, chunk, deadline_ns);
+    if (iree_status_is_ok(wait_status) && iree_status_is_ok(status) &&
+        readback_lengths[i]) {
+      memcpy((uint8_t*)target.host_buffer.data + target_offset +
+                 readback_offsets[i],
+             chunk->mapping.contents.data, readback_lengths[i]);
+    }
+    status = iree_status_join(status, wait_status);
+  }
+  iree_slim_mutex_unlock(&ring->mutex);
+
+  IREE_TRACE_ZONE_END(z0);
+  return status;
+}
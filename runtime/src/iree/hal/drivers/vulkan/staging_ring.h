@@ -0,0 +1,92 @@
+// Copyright 2023 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#ifndef IREE_HAL_DRIVERS_VULKAN_STAGING_RING_H_
+#define IREE_HAL_DRIVERS_VULKAN_STAGING_RING_H_
+
+#include "iree/base/api.h"
+#include "iree/base/internal/synchronization.h"
+#include "iree/hal/api.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif  // __cplusplus
+
+// Size of each staging buffer in the ring. Transfers are split into chunks of
+// this size.
+#define IREE_HAL_VULKAN_STAGING_RING_CHUNK_SIZE (4 * 1024 * 1024)
+
+// Number of staging buffers in the ring. This is the number of chunk copies
+// that can be in flight on the device while the host fills or drains others.
+#define IREE_HAL_VULKAN_STAGING_RING_CHUNK_COUNT 4
+
+typedef struct iree_hal_vulkan_staging_chunk_t {
+  // Host-local device-visible buffer persistently mapped into |mapping|.
+  iree_hal_buffer_t* buffer;
+  iree_hal_buffer_mapping_t mapping;
+  // Value of the ring semaphore signaled when the last copy using the chunk
+  // completes or 0 if the chunk is not in use by the device.
+  uint64_t pending_value;
+} iree_hal_vulkan_staging_chunk_t;
+
+// A ring of persistent staging buffers used for synchronous transfers between
+// host memory and device buffers that cannot be mapped.
+//
+// Transfers are split into chunks that are copied into (or out of) the staging
+// buffers on the host while previously submitted chunks are copied by the
+// device, so large uploads such as parameters neither allocate staging memory
+// the size of the data nor serialize the host and device copies.
+//
+// Staging buffers and the semaphore are allocated on first use and can be
+// released with iree_hal_vulkan_staging_ring_trim. Transfers are serialized
+// by the ring and it's safe to use from multiple threads.
+typedef struct iree_hal_vulkan_staging_ring_t {
+  // Unretained as the device owns the ring.
+  iree_hal_device_t* device;
+
+  iree_slim_mutex_t mutex;
+
+  // Signaled with monotonically increasing values as chunk copies complete.
+  iree_hal_semaphore_t* semaphore IREE_GUARDED_BY(mutex);
+  uint64_t next_value IREE_GUARDED_BY(mutex);
+
+  iree_hal_vulkan_staging_chunk_t chunks
+      [IREE_HAL_VULKAN_STAGING_RING_CHUNK_COUNT] IREE_GUARDED_BY(mutex);
+} iree_hal_vulkan_staging_ring_t;
+
+// Initializes |out_ring| for transfers on |device|. No device resources are
+// allocated until the first transfer.
+void iree_hal_vulkan_staging_ring_initialize(
+    iree_hal_device_t* device, iree_hal_vulkan_staging_ring_t* out_ring);
+
+// Deinitializes |ring| and releases its resources. No transfers may be in
+// flight on the device.
+void iree_hal_vulkan_staging_ring_deinitialize(
+    iree_hal_vulkan_staging_ring_t* ring);
+
+// Releases the staging buffers after waiting for any in-flight copies.
+iree_status_t iree_hal_vulkan_staging_ring_trim(
+    iree_hal_vulkan_staging_ring_t* ring);
+
+// Returns true if a transfer between |source| and |target| should be staged
+// through the ring: exactly one side is host memory and the device buffer
+// cannot be mapped for the host to access directly.
+bool iree_hal_vulkan_staging_ring_should_stage(
+    iree_hal_transfer_buffer_t source, iree_hal_transfer_buffer_t target);
+
+// Synchronously transfers |data_length| bytes between host memory and a device
+// buffer through the staging ring. Matches iree_hal_device_transfer_range.
+iree_status_t iree_hal_vulkan_staging_ring_transfer_range(
+    iree_hal_vulkan_staging_ring_t* ring, iree_hal_transfer_buffer_t source,
+    iree_device_size_t source_offset, iree_hal_transfer_buffer_t target,
+    iree_device_size_t target_offset, iree_device_size_t data_length,
+    iree_timeout_t timeout);
+
+#ifdef __cplusplus
+}  // extern "C"
+#endif  // __cplusplus
+
+#endif  // IREE_HAL_DRIVERS_VULKAN_STAGING_RING_H_
@@ -27,6 +27,11 @@
 // The more we do the better confidence we have in a lower-bound.
 #define IREE_HAL_VULKAN_TRACING_MAX_DEVIATION_PROBE_COUNT 32
 
+// Minimum interval between periodic calibrations performed during collection.
+// Host and device clocks drift on the order of microseconds per second and
+// calibrating more frequently than this only adds overhead to collections.
+#define IREE_HAL_VULKAN_TRACING_CALIBRATION_INTERVAL_NS (100 * 1000000ll)
+
 typedef struct iree_hal_vulkan_timestamp_query_t {
   uint64_t timestamp;
   uint64_t availability;  // non-zero if available
@@ -58,10 +63,13 @@ struct iree_hal_vulkan_tracing_context_t {
   // discarded.
   uint64_t max_expected_deviation;
 
-  // Vulkan-reported CPU timestamp of the last calibration.
+  // Vulkan-reported CPU timestamp of the last calibration in nanoseconds.
   // Used to detect when drift occurs and we need to notify tracy.
   uint64_t previous_cpu_time;
 
+  // Host time of the last calibration used to rate limit periodic calibration.
+  iree_time_t previous_calibration_time;
+
   // Pool of query instances that we treat as a backing store for a ringbuffer.
   VkQueryPool query_pool;
 
@@ -174,16 +182,32 @@ static void iree_hal_vulkan_tracing_query_calibration_timestamps(
   timestamp_infos[1].sType = VK_STRUCTURE_TYPE_CALIBRATED_TIMESTAMP_INFO_EXT;
   timestamp_infos[1].pNext = NULL;
   timestamp_infos[1].timeDomain = context->time_domain;
-  uint64_t timestamps[2] = {0, 0};
-  uint64_t max_deviation = 0;
-  do {
-    context->logical_device->syms()->vkGetCalibratedTimestampsEXT(
-        *context->logical_device, IREE_ARRAYSIZE(timestamps), timestamp_infos,
-        timestamps, &max_deviation);
-  } while (max_deviation > context->max_expected_deviation);
+  // Retry until the deviation is within our expectations. Preemption or power
+  // events can make every attempt exceed it for a while so we bound the number
+  // of attempts and use the best sample we got instead of spinning.
+  uint64_t best_timestamps[2] = {0, 0};
+  uint64_t best_deviation = UINT64_MAX;
+  for (iree_host_size_t i = 0;
+       i < IREE_HAL_VULKAN_TRACING_MAX_DEVIATION_PROBE_COUNT; ++i) {
+    uint64_t timestamps[2] = {0, 0};
+    uint64_t max_deviation = 0;
+    if (context->logical_device->syms()->vkGetCalibratedTimestampsEXT(
+            *context->logical_device, IREE_ARRAYSIZE(timestamps),
+            timestamp_infos, timestamps, &max_deviation) != VK_SUCCESS) {
+      continue;
+    }
+    if (max_deviation < best_deviation) {
+      best_deviation = max_deviation;
+      best_timestamps[0] = timestamps[0];
+      best_timestamps[1] = timestamps[1];
+    }
+    if (max_deviation <= context->max_expected_deviation) break;
+  }
+  IREE_TRACE_ZONE_APPEND_VALUE(z0, best_deviation);
 
-  *out_gpu_time = timestamps[0];
-  *out_cpu_time = timestamps[1];
+  // Convert the CPU timestamp to nanoseconds as tracy expects.
+  *out_gpu_time = best_timestamps[0];
+  *out_cpu_time = best_timestamps[1];
   switch (context->time_domain) {
 #if defined(IREE_PLATFORM_WINDOWS)
     case VK_TIME_DOMAIN_QUERY_PERFORMANCE_COUNTER_EXT:
@@ -192,7 +216,7 @@ static void iree_hal_vulkan_tracing_query_calibration_timestamps(
 #else
     case VK_TIME_DOMAIN_CLOCK_MONOTONIC_EXT:
     case VK_TIME_DOMAIN_CLOCK_MONOTONIC_RAW_EXT:
-      // TODO(benvanik): posix calibrated timestamps - ignored for now.
+      // POSIX clock_gettime values are already in nanoseconds.
       break;
 #endif  // IREE_PLATFORM_WINDOWS
     default:
@@ -202,6 +226,23 @@ static void iree_hal_vulkan_tracing_query_calibration_timestamps(
   IREE_TRACE_ZONE_END(z0);
 }
 
+// Returns a human-readable name for |time_domain| for use in traces.
+static const char* iree_hal_vulkan_tracing_time_domain_name(
+    VkTimeDomainEXT time_domain) {
+  switch (time_domain) {
+    case VK_TIME_DOMAIN_DEVICE_EXT:
+      return "VK_TIME_DOMAIN_DEVICE_EXT";
+    case VK_TIME_DOMAIN_CLOCK_MONOTONIC_EXT:
+      return "VK_TIME_DOMAIN_CLOCK_MONOTONIC_EXT";
+    case VK_TIME_DOMAIN_CLOCK_MONOTONIC_RAW_EXT:
+      return "VK_TIME_DOMAIN_CLOCK_MONOTONIC_RAW_EXT";
+    case VK_TIME_DOMAIN_QUERY_PERFORMANCE_COUNTER_EXT:
+      return "VK_TIME_DOMAIN_QUERY_PERFORMANCE_COUNTER_EXT";
+    default:
+      return "VK_TIME_DOMAIN_UNKNOWN";
+  }
+}
+
 // Populates |out_cpu_time| and |out_gpu_time| with calibrated timestamps.
 // Depending on whether VK_EXT_calibrated_timestamps is available this may be
 // a guess done by ourselves (with lots of slop) or done by the driver (with
@@ -214,10 +255,8 @@ static void iree_hal_vulkan_tracing_perform_initial_calibration(
   *out_gpu_time = 0;
 
   IREE_TRACE_ZONE_BEGIN(z0);
-  IREE_TRACE_ZONE_APPEND_TEXT(z0,
-                              context->time_domain == VK_TIME_DOMAIN_DEVICE_EXT
-                                  ? "VK_TIME_DOMAIN_DEVICE_EXT"
-                                  : "VK_TIME_DOMAIN_CLOCK_MONOTONIC_EXT");
+  IREE_TRACE_ZONE_APPEND_TEXT(
+      z0, iree_hal_vulkan_tracing_time_domain_name(context->time_domain));
 
   // Attempt to get a timestamp from both the device and the host at roughly the
   // same time. There's a gap between when we get control returned to use after
@@ -285,6 +324,7 @@ static void iree_hal_vulkan_tracing_perform_initial_calibration(
   iree_hal_vulkan_tracing_query_calibration_timestamps(
       context, &context->previous_cpu_time, out_gpu_time);
   *out_cpu_time = tracy::Profiler::GetTime();
+  context->previous_calibration_time = iree_time_now();
 
   IREE_TRACE_ZONE_END(z0);
 }
@@ -296,6 +336,12 @@ static void iree_hal_vulkan_tracing_perform_initial_calibration(
 void iree_hal_vulkan_tracing_perform_calibration(
     iree_hal_vulkan_tracing_context_t* context) {
   if (context->time_domain == VK_TIME_DOMAIN_DEVICE_EXT) return;
+  iree_time_t now = iree_time_now();
+  if (now - context->previous_calibration_time <
+      IREE_HAL_VULKAN_TRACING_CALIBRATION_INTERVAL_NS) {
+    return;
+  }
+  context->previous_calibration_time = now;
   IREE_TRACE_ZONE_BEGIN(z0);
 
   uint64_t cpu_time = 0;
@@ -440,22 +486,27 @@ static VkTimeDomainEXT iree_hal_vulkan_tracing_query_time_domain(
     return VK_TIME_DOMAIN_DEVICE_EXT;
   }
 
+  // On POSIX platforms CLOCK_MONOTONIC_RAW is preferred as it is not subject
+  // to NTP frequency adjustments that would show up as drift against the
+  // device clock between calibrations.
+  VkTimeDomainEXT best_time_domain = VK_TIME_DOMAIN_DEVICE_EXT;
   for (uint32_t i = 0; i < time_domain_count; i++) {
     switch (time_domains[i]) {
 #if defined(IREE_PLATFORM_WINDOWS)
       case VK_TIME_DOMAIN_QUERY_PERFORMANCE_COUNTER_EXT:
         return time_domains[i];
 #else
-      case VK_TIME_DOMAIN_CLOCK_MONOTONIC_EXT:
       case VK_TIME_DOMAIN_CLOCK_MONOTONIC_RAW_EXT:
-        // TODO(benvanik): support posix clock domains with some kind of math.
-        // return time_domains[i];  -- ignored
+        return time_domains[i];
+      case VK_TIME_DOMAIN_CLOCK_MONOTONIC_EXT:
+        best_time_domain = time_domains[i];
+        continue;
 #endif  // IREE_PLATFORM_WINDOWS
       default:
         continue;
     }
   }
-  return VK_TIME_DOMAIN_DEVICE_EXT;
+  return best_time_domain;
 }
 
 iree_status_t iree_hal_vulkan_tracing_context_allocate(
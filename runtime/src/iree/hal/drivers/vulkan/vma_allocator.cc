@@ -10,6 +10,8 @@
 #include <cstring>
 
 #include "iree/base/api.h"
+#include "iree/base/internal/math.h"
+#include "iree/base/internal/synchronization.h"
 #include "iree/base/tracing.h"
 #include "iree/hal/drivers/vulkan/dynamic_symbols.h"
 #include "iree/hal/drivers/vulkan/status_util.h"
@@ -18,12 +20,45 @@
 
 using namespace iree::hal::vulkan;
 
+// Maximum number of distinct VkBufferUsageFlags combinations that get their
+// own transient pool. HAL buffer usage maps to only a handful of combinations.
+#define IREE_HAL_VULKAN_VMA_MAX_TRANSIENT_POOLS 8
+
+// A custom VMA pool dedicated to queue-ordered transient allocations.
+typedef struct iree_hal_vulkan_vma_transient_pool_t {
+  // Buffer usage the pool memory type was selected for.
+  VkBufferUsageFlags usage;
+  VmaPool pool;
+} iree_hal_vulkan_vma_transient_pool_t;
+
 typedef struct iree_hal_vulkan_vma_allocator_t {
   iree_hal_resource_t resource;
   iree_hal_device_t* device;  // unretained to avoid cycles
   iree_allocator_t host_allocator;
+  VkDeviceHandle* logical_device;
   VmaAllocator vma;
 
+  // Required alignment of host pointers and sizes imported with
+  // VK_EXT_external_memory_host or 0 if the extension is not enabled.
+  VkDeviceSize min_imported_host_pointer_alignment;
+
+  // True if the device is an integrated GPU sharing memory with the host and
+  // device-local memory can be mapped.
+  bool unified_memory;
+
+  // Size of each block of device memory in the transient pools.
+  VkDeviceSize transient_block_size;
+  // Lazily created pools for transient allocations. Transient buffers are
+  // suballocated from blocks retained by the pools so that allocating them does
+  // not usually need a vkAllocateMemory, and large transients do not get
+  // dedicated allocations as they would from the default VMA pools.
+  iree_slim_mutex_t transient_pool_mutex;
+  iree_host_size_t transient_pool_count
+      IREE_GUARDED_BY(transient_pool_mutex);
+  iree_hal_vulkan_vma_transient_pool_t
+      transient_pools[IREE_HAL_VULKAN_VMA_MAX_TRANSIENT_POOLS] IREE_GUARDED_BY(
+          transient_pool_mutex);
+
   IREE_STATISTICS(VkPhysicalDeviceMemoryProperties memory_props;)
   IREE_STATISTICS(iree_hal_allocator_statistics_t statistics;)
 } iree_hal_vulkan_vma_allocator_t;
@@ -81,6 +116,28 @@ static void VKAPI_PTR iree_hal_vulkan_vma_free_callback(
 
 #endif  // IREE_STATISTICS_ENABLE
 
+// Returns true if the device shares its memory with the host such that device
+// local memory can be written from the host as cheaply as staging memory.
+// Discrete GPUs may expose a mappable device-local heap (resizable BAR) but
+// host writes to it cross the bus and staging remains preferable.
+static bool iree_hal_vulkan_vma_is_unified_memory(
+    const VkPhysicalDeviceProperties* physical_device_props,
+    const VkPhysicalDeviceMemoryProperties* memory_props) {
+  if (physical_device_props->deviceType !=
+          VK_PHYSICAL_DEVICE_TYPE_INTEGRATED_GPU &&
+      physical_device_props->deviceType != VK_PHYSICAL_DEVICE_TYPE_CPU) {
+    return false;
+  }
+  for (uint32_t i = 0; i < memory_props->memoryTypeCount; ++i) {
+    if (iree_all_bits_set(memory_props->memoryTypes[i].propertyFlags,
+                          VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT |
+                              VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT)) {
+      return true;
+    }
+  }
+  return false;
+}
+
 iree_status_t iree_hal_vulkan_vma_allocator_create(
     const iree_hal_vulkan_device_options_t* options, VkInstance instance,
     VkPhysicalDevice physical_device, VkDeviceHandle* logical_device,
@@ -101,8 +158,30 @@ iree_status_t iree_hal_vulkan_vma_allocator_create(
                                &allocator->resource);
   allocator->host_allocator = host_allocator;
   allocator->device = device;
+  allocator->logical_device = logical_device;
+  allocator->transient_block_size = options->large_heap_block_size
+                                        ? options->large_heap_block_size
+                                        : 64 * 1024 * 1024;
+  iree_slim_mutex_initialize(&allocator->transient_pool_mutex);
+  allocator->transient_pool_count = 0;
 
   const auto& syms = logical_device->syms();
+  if (logical_device->enabled_extensions().external_memory_host) {
+    VkPhysicalDeviceExternalMemoryHostPropertiesEXT host_memory_props;
+    memset(&host_memory_props, 0, sizeof(host_memory_props));
+    host_memory_props.sType =
+        VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_EXTERNAL_MEMORY_HOST_PROPERTIES_EXT;
+    VkPhysicalDeviceProperties2 physical_device_props;
+    memset(&physical_device_props, 0, sizeof(physical_device_props));
+    physical_device_props.sType =
+        VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PROPERTIES_2;
+    physical_device_props.pNext = &host_memory_props;
+    syms->vkGetPhysicalDeviceProperties2(physical_device,
+                                         &physical_device_props);
+    allocator->min_imported_host_pointer_alignment =
+        host_memory_props.minImportedHostPointerAlignment;
+  }
+
   VmaVulkanFunctions vulkan_fns;
   memset(&vulkan_fns, 0, sizeof(vulkan_fns));
   vulkan_fns.vkGetPhysicalDeviceProperties =
@@ -153,9 +232,15 @@ iree_status_t iree_hal_vulkan_vma_allocator_create(
   if (iree_status_is_ok(status)) {
     allocator->vma = vma;
 
+    VkPhysicalDeviceProperties physical_device_props;
+    syms->vkGetPhysicalDeviceProperties(physical_device,
+                                        &physical_device_props);
+    const VkPhysicalDeviceMemoryProperties* memory_props = NULL;
+    vmaGetMemoryProperties(allocator->vma, &memory_props);
+    allocator->unified_memory = iree_hal_vulkan_vma_is_unified_memory(
+        &physical_device_props, memory_props);
+
     IREE_STATISTICS({
-      const VkPhysicalDeviceMemoryProperties* memory_props = NULL;
-      vmaGetMemoryProperties(allocator->vma, &memory_props);
       memcpy(&allocator->memory_props, memory_props,
              sizeof(allocator->memory_props));
     });
@@ -163,6 +248,8 @@ iree_status_t iree_hal_vulkan_vma_allocator_create(
     *out_allocator = (iree_hal_allocator_t*)allocator;
   } else {
     vmaDestroyAllocator(vma);
+    iree_slim_mutex_deinitialize(&allocator->transient_pool_mutex);
+    iree_allocator_free(host_allocator, allocator);
   }
 
   IREE_TRACE_ZONE_END(z0);
@@ -176,6 +263,10 @@ static void iree_hal_vulkan_vma_allocator_destroy(
   iree_allocator_t host_allocator = allocator->host_allocator;
   IREE_TRACE_ZONE_BEGIN(z0);
 
+  for (iree_host_size_t i = 0; i < allocator->transient_pool_count; ++i) {
+    vmaDestroyPool(allocator->vma, allocator->transient_pools[i].pool);
+  }
+  iree_slim_mutex_deinitialize(&allocator->transient_pool_mutex);
   vmaDestroyAllocator(allocator->vma);
   iree_allocator_free(host_allocator, allocator);
 
@@ -230,106 +321,190 @@ iree_hal_vulkan_vma_allocator_query_compatibility(
   return compatibility;
 }
 
-static iree_status_t iree_hal_vulkan_vma_allocator_allocate_internal(
-    iree_hal_vulkan_vma_allocator_t* IREE_RESTRICT allocator,
-    const iree_hal_buffer_params_t* IREE_RESTRICT params,
-    iree_device_size_t allocation_size, iree_const_byte_span_t initial_data,
-    VmaAllocationCreateFlags flags,
-    iree_hal_buffer_t** IREE_RESTRICT out_buffer) {
+// Returns the size actually allocated for a buffer of |allocation_size|.
+static iree_device_size_t iree_hal_vulkan_vma_align_allocation_size(
+    iree_device_size_t allocation_size) {
   // Guard against the corner case where the requested buffer size is 0. The
   // application is unlikely to do anything when requesting a 0-byte buffer; but
   // it can happen in real world use cases. So we should at least not crash.
   if (allocation_size == 0) allocation_size = 4;
   // Align allocation sizes to 4 bytes so shaders operating on 32 bit types can
   // act safely even on buffer ranges that are not naturally aligned.
-  allocation_size = iree_host_align(allocation_size, 4);
+  return iree_host_align(allocation_size, 4);
+}
 
-  VkBufferCreateInfo buffer_create_info;
-  buffer_create_info.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
-  buffer_create_info.pNext = NULL;
-  buffer_create_info.flags = 0;
-  buffer_create_info.size = allocation_size;
-  buffer_create_info.usage = 0;
+// Populates the Vulkan buffer and VMA allocation create infos for a buffer with
+// the given |params|. |allocation_size| must already have been aligned.
+static void iree_hal_vulkan_vma_populate_create_infos(
+    const iree_hal_buffer_params_t* IREE_RESTRICT params,
+    iree_device_size_t allocation_size, VmaAllocationCreateFlags flags,
+    VkBufferCreateInfo* out_buffer_create_info,
+    VmaAllocationCreateInfo* out_allocation_create_info) {
+  out_buffer_create_info->sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
+  out_buffer_create_info->pNext = NULL;
+  out_buffer_create_info->flags = 0;
+  out_buffer_create_info->size = allocation_size;
+  out_buffer_create_info->usage = 0;
   if (iree_all_bits_set(params->usage, IREE_HAL_BUFFER_USAGE_TRANSFER)) {
-    buffer_create_info.usage |= VK_BUFFER_USAGE_TRANSFER_SRC_BIT;
-    buffer_create_info.usage |= VK_BUFFER_USAGE_TRANSFER_DST_BIT;
+    out_buffer_create_info->usage |= VK_BUFFER_USAGE_TRANSFER_SRC_BIT;
+    out_buffer_create_info->usage |= VK_BUFFER_USAGE_TRANSFER_DST_BIT;
   }
   if (iree_all_bits_set(params->usage,
                         IREE_HAL_BUFFER_USAGE_DISPATCH_STORAGE)) {
-    buffer_create_info.usage |= VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT;
-    buffer_create_info.usage |= VK_BUFFER_USAGE_STORAGE_BUFFER_BIT;
-    buffer_create_info.usage |= VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT;
+    out_buffer_create_info->usage |= VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT;
+    out_buffer_create_info->usage |= VK_BUFFER_USAGE_STORAGE_BUFFER_BIT;
+    out_buffer_create_info->usage |= VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT;
   }
-  buffer_create_info.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
-  buffer_create_info.queueFamilyIndexCount = 0;
-  buffer_create_info.pQueueFamilyIndices = NULL;
-
-  VmaAllocationCreateInfo allocation_create_info;
-  allocation_create_info.flags = flags;
-  allocation_create_info.usage = VMA_MEMORY_USAGE_UNKNOWN;
-  allocation_create_info.requiredFlags = 0;
-  allocation_create_info.preferredFlags = 0;
-  allocation_create_info.memoryTypeBits = 0;  // Automatic selection.
-  allocation_create_info.pool = VK_NULL_HANDLE;
-  allocation_create_info.pUserData = NULL;
+  out_buffer_create_info->sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+  out_buffer_create_info->queueFamilyIndexCount = 0;
+  out_buffer_create_info->pQueueFamilyIndices = NULL;
+
+  out_allocation_create_info->flags = flags;
+  out_allocation_create_info->usage = VMA_MEMORY_USAGE_UNKNOWN;
+  out_allocation_create_info->requiredFlags = 0;
+  out_allocation_create_info->preferredFlags = 0;
+  out_allocation_create_info->memoryTypeBits = 0;  // Automatic selection.
+  out_allocation_create_info->pool = VK_NULL_HANDLE;
+  out_allocation_create_info->pUserData = NULL;
   if (iree_all_bits_set(params->type, IREE_HAL_MEMORY_TYPE_DEVICE_LOCAL)) {
     if (iree_all_bits_set(params->type, IREE_HAL_MEMORY_TYPE_HOST_VISIBLE)) {
       // Device-local, host-visible.
-      allocation_create_info.usage = VMA_MEMORY_USAGE_CPU_TO_GPU;
-      allocation_create_info.preferredFlags |=
+      out_allocation_create_info->usage = VMA_MEMORY_USAGE_CPU_TO_GPU;
+      out_allocation_create_info->preferredFlags |=
           VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT;
     } else {
       // Device-local only.
-      allocation_create_info.usage = VMA_MEMORY_USAGE_GPU_ONLY;
-      allocation_create_info.requiredFlags |=
+      out_allocation_create_info->usage = VMA_MEMORY_USAGE_GPU_ONLY;
+      out_allocation_create_info->requiredFlags |=
           VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT;
     }
   } else {
     if (iree_all_bits_set(params->type, IREE_HAL_MEMORY_TYPE_DEVICE_VISIBLE)) {
       // Host-local, device-visible.
-      allocation_create_info.usage = VMA_MEMORY_USAGE_GPU_TO_CPU;
+      out_allocation_create_info->usage = VMA_MEMORY_USAGE_GPU_TO_CPU;
     } else {
       // Host-local only.
-      allocation_create_info.usage = VMA_MEMORY_USAGE_CPU_ONLY;
+      out_allocation_create_info->usage = VMA_MEMORY_USAGE_CPU_ONLY;
     }
   }
   if (iree_all_bits_set(params->type, IREE_HAL_MEMORY_TYPE_HOST_CACHED)) {
-    allocation_create_info.requiredFlags |= VK_MEMORY_PROPERTY_HOST_CACHED_BIT;
+    out_allocation_create_info->requiredFlags |=
+        VK_MEMORY_PROPERTY_HOST_CACHED_BIT;
   }
   if (iree_all_bits_set(params->type, IREE_HAL_MEMORY_TYPE_HOST_COHERENT)) {
-    allocation_create_info.requiredFlags |=
+    out_allocation_create_info->requiredFlags |=
         VK_MEMORY_PROPERTY_HOST_COHERENT_BIT;
   }
   if (iree_all_bits_set(params->usage, IREE_HAL_BUFFER_USAGE_MAPPING)) {
-    allocation_create_info.requiredFlags |= VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT;
+    out_allocation_create_info->requiredFlags |=
+        VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT;
   }
+}
 
-  // TODO(benvanik): if on a unified memory system and initial data is present
-  // we could set the mapping bit and ensure a much more efficient upload.
+// Writes |data| to the start of the host-visible |allocation|.
+static iree_status_t iree_hal_vulkan_vma_allocator_write_mapped(
+    iree_hal_vulkan_vma_allocator_t* IREE_RESTRICT allocator,
+    VmaAllocation allocation, iree_const_byte_span_t data) {
+  void* mapped_ptr = NULL;
+  VK_RETURN_IF_ERROR(vmaMapMemory(allocator->vma, allocation, &mapped_ptr),
+                     "vmaMapMemory");
+  memcpy(mapped_ptr, data.data, data.data_length);
+  iree_status_t status = VK_RESULT_TO_STATUS(
+      vmaFlushAllocation(allocator->vma, allocation, 0, data.data_length),
+      "vmaFlushAllocation");
+  vmaUnmapMemory(allocator->vma, allocation);
+  return status;
+}
 
+// Creates a buffer and its backing allocation and wraps them in a HAL buffer.
+// If |initial_data| is provided and the allocation is host-visible the data is
+// written directly and |out_initialized| is set to true; otherwise the caller
+// is responsible for uploading it.
+static iree_status_t iree_hal_vulkan_vma_allocator_create_buffer(
+    iree_hal_vulkan_vma_allocator_t* IREE_RESTRICT allocator,
+    const iree_hal_buffer_params_t* IREE_RESTRICT params,
+    iree_device_size_t allocation_size,
+    const VkBufferCreateInfo* buffer_create_info,
+    const VmaAllocationCreateInfo* allocation_create_info,
+    iree_const_byte_span_t initial_data, bool* out_initialized,
+    iree_hal_buffer_t** IREE_RESTRICT out_buffer) {
+  if (out_initialized) *out_initialized = false;
   VkBuffer handle = VK_NULL_HANDLE;
   VmaAllocation allocation = VK_NULL_HANDLE;
   VmaAllocationInfo allocation_info;
-  VK_RETURN_IF_ERROR(vmaCreateBuffer(allocator->vma, &buffer_create_info,
-                                     &allocation_create_info, &handle,
+  VK_RETURN_IF_ERROR(vmaCreateBuffer(allocator->vma, buffer_create_info,
+                                     allocation_create_info, &handle,
                                      &allocation, &allocation_info),
                      "vmaCreateBuffer");
 
-  iree_hal_buffer_t* buffer = NULL;
-  iree_status_t status = iree_hal_vulkan_vma_buffer_wrap(
+  iree_status_t status = iree_ok_status();
+  if (out_initialized && !iree_const_byte_span_is_empty(initial_data)) {
+    VkMemoryPropertyFlags property_flags = 0;
+    vmaGetMemoryTypeProperties(allocator->vma, allocation_info.memoryType,
+                               &property_flags);
+    if (iree_all_bits_set(property_flags,
+                          VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT)) {
+      status = iree_hal_vulkan_vma_allocator_write_mapped(
+          allocator, allocation, initial_data);
+      *out_initialized = iree_status_is_ok(status);
+    }
+  }
+  if (!iree_status_is_ok(status)) {
+    vmaDestroyBuffer(allocator->vma, handle, allocation);
+    return status;
+  }
+
+  // The buffer is destroyed by the wrap call if it fails.
+  return iree_hal_vulkan_vma_buffer_wrap(
       (iree_hal_allocator_t*)allocator, params->type, params->access,
       params->usage, allocation_size,
       /*byte_offset=*/0,
       /*byte_length=*/allocation_size, allocator->vma, handle, allocation,
-      allocation_info, &buffer);
-  if (!iree_status_is_ok(status)) {
-    vmaDestroyBuffer(allocator->vma, handle, allocation);
-    return status;
+      allocation_info, out_buffer);
+}
+
+static iree_status_t iree_hal_vulkan_vma_allocator_allocate_internal(
+    iree_hal_vulkan_vma_allocator_t* IREE_RESTRICT allocator,
+    const iree_hal_buffer_params_t* IREE_RESTRICT params,
+    iree_device_size_t allocation_size, iree_const_byte_span_t initial_data,
+    VmaAllocationCreateFlags flags,
+    iree_hal_buffer_t** IREE_RESTRICT out_buffer) {
+  allocation_size = iree_hal_vulkan_vma_align_allocation_size(allocation_size);
+
+  VkBufferCreateInfo buffer_create_info;
+  VmaAllocationCreateInfo allocation_create_info;
+  iree_hal_vulkan_vma_populate_create_infos(params, allocation_size, flags,
+                                            &buffer_create_info,
+                                            &allocation_create_info);
+
+  // On unified memory systems device-local memory is usually also host-visible
+  // and initial data (constants, parameters) can be copied directly into the
+  // allocation. This avoids a staging buffer the size of the data and the
+  // transfer submission. If no such memory is available we fall back to the
+  // normal allocation and upload below.
+  iree_hal_buffer_t* buffer = NULL;
+  bool initialized = false;
+  if (allocator->unified_memory &&
+      !iree_const_byte_span_is_empty(initial_data)) {
+    VmaAllocationCreateInfo mappable_create_info = allocation_create_info;
+    mappable_create_info.requiredFlags |= VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT;
+    iree_status_t status = iree_hal_vulkan_vma_allocator_create_buffer(
+        allocator, params, allocation_size, &buffer_create_info,
+        &mappable_create_info, initial_data, &initialized, &buffer);
+    if (!iree_status_is_ok(status)) {
+      iree_status_ignore(status);
+      buffer = NULL;
+    }
+  }
+  if (!buffer) {
+    IREE_RETURN_IF_ERROR(iree_hal_vulkan_vma_allocator_create_buffer(
+        allocator, params, allocation_size, &buffer_create_info,
+        &allocation_create_info, initial_data, &initialized, &buffer));
   }
 
   // Copy the initial contents into the buffer. This may require staging.
-  if (iree_status_is_ok(status) &&
-      !iree_const_byte_span_is_empty(initial_data)) {
+  iree_status_t status = iree_ok_status();
+  if (!initialized && !iree_const_byte_span_is_empty(initial_data)) {
     status = iree_hal_device_transfer_range(
         allocator->device,
         iree_hal_make_host_transfer_buffer_span((void*)initial_data.data,
@@ -366,15 +541,197 @@ static void iree_hal_vulkan_vma_allocator_deallocate_buffer(
   iree_hal_buffer_destroy(base_buffer);
 }
 
+// Selects the memory type used for importing host memory from the types in
+// |memory_type_bits|. Only host-coherent types are usable as mappings of the
+// imported buffers go directly through the host pointer; device-local types
+// are preferred if requested so that integrated GPUs get their fastest memory.
+static iree_status_t iree_hal_vulkan_vma_allocator_select_import_memory_type(
+    iree_hal_vulkan_vma_allocator_t* allocator,
+    const iree_hal_buffer_params_t* params, uint32_t memory_type_bits,
+    uint32_t* out_memory_type_index,
+    VkMemoryPropertyFlags* out_property_flags) {
+  const VkPhysicalDeviceMemoryProperties* memory_props = NULL;
+  vmaGetMemoryProperties(allocator->vma, &memory_props);
+  const VkMemoryPropertyFlags required_flags =
+      VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT |
+      VK_MEMORY_PROPERTY_HOST_COHERENT_BIT;
+  VkMemoryPropertyFlags preferred_flags = 0;
+  if (iree_all_bits_set(params->type, IREE_HAL_MEMORY_TYPE_DEVICE_LOCAL)) {
+    preferred_flags |= VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT;
+  }
+  if (iree_all_bits_set(params->type, IREE_HAL_MEMORY_TYPE_HOST_CACHED)) {
+    preferred_flags |= VK_MEMORY_PROPERTY_HOST_CACHED_BIT;
+  }
+  int best_index = -1;
+  int best_score = -1;
+  for (uint32_t i = 0; i < memory_props->memoryTypeCount; ++i) {
+    if (!(memory_type_bits & (1u << i))) continue;
+    VkMemoryPropertyFlags flags = memory_props->memoryTypes[i].propertyFlags;
+    if (!iree_all_bits_set(flags, required_flags)) continue;
+    int score = iree_math_count_ones_u32(flags & preferred_flags);
+    if (score > best_score) {
+      best_index = (int)i;
+      best_score = score;
+    }
+  }
+  if (best_index < 0) {
+    return iree_make_status(
+        IREE_STATUS_UNAVAILABLE,
+        "no host-coherent memory type can import the host allocation "
+        "(memoryTypeBits=0x%08X)",
+        memory_type_bits);
+  }
+  *out_memory_type_index = (uint32_t)best_index;
+  *out_property_flags = memory_props->memoryTypes[best_index].propertyFlags;
+  return iree_ok_status();
+}
+
+// Imports a host allocation with VK_EXT_external_memory_host. The device
+// accesses the host memory in-place and no copies are made.
+static iree_status_t iree_hal_vulkan_vma_allocator_import_host_allocation(
+    iree_hal_vulkan_vma_allocator_t* IREE_RESTRICT allocator,
+    const iree_hal_buffer_params_t* IREE_RESTRICT params,
+    iree_hal_external_buffer_t* IREE_RESTRICT external_buffer,
+    iree_hal_buffer_release_callback_t release_callback,
+    iree_hal_buffer_t** IREE_RESTRICT out_buffer) {
+  const VkDeviceSize alignment = allocator->min_imported_host_pointer_alignment;
+  if (!alignment) {
+    return iree_make_status(
+        IREE_STATUS_UNAVAILABLE,
+        "importing host allocations requires VK_EXT_external_memory_host");
+  }
+  void* host_ptr = external_buffer->handle.host_allocation.ptr;
+  if (!iree_host_size_has_alignment((uintptr_t)host_ptr, alignment) ||
+      !iree_device_size_has_alignment(external_buffer->size, alignment)) {
+    return iree_make_status(
+        IREE_STATUS_OUT_OF_RANGE,
+        "imported host allocations must have their pointer and size aligned "
+        "to minImportedHostPointerAlignment=%" PRIdsz "; got %p (%" PRIdsz
+        " bytes)",
+        (iree_device_size_t)alignment, host_ptr, external_buffer->size);
+  }
+  IREE_TRACE_ZONE_BEGIN(z0);
+  IREE_TRACE_ZONE_APPEND_VALUE(z0, (int64_t)external_buffer->size);
+  VkDeviceHandle* logical_device = allocator->logical_device;
+  const auto& syms = logical_device->syms();
+
+  iree_hal_buffer_params_t compat_params = *params;
+  iree_hal_buffer_params_canonicalize(&compat_params);
+  VkBufferCreateInfo buffer_create_info;
+  VmaAllocationCreateInfo allocation_create_info;
+  iree_hal_vulkan_vma_populate_create_infos(
+      &compat_params, external_buffer->size, /*flags=*/0, &buffer_create_info,
+      &allocation_create_info);
+  VkExternalMemoryBufferCreateInfo external_create_info;
+  external_create_info.sType =
+      VK_STRUCTURE_TYPE_EXTERNAL_MEMORY_BUFFER_CREATE_INFO;
+  external_create_info.pNext = NULL;
+  external_create_info.handleTypes =
+      VK_EXTERNAL_MEMORY_HANDLE_TYPE_HOST_ALLOCATION_BIT_EXT;
+  buffer_create_info.pNext = &external_create_info;
+
+  VkBuffer handle = VK_NULL_HANDLE;
+  IREE_RETURN_AND_END_ZONE_IF_ERROR(
+      z0, VK_RESULT_TO_STATUS(
+              syms->vkCreateBuffer(*logical_device, &buffer_create_info,
+                                   logical_device->allocator(), &handle),
+              "vkCreateBuffer"));
+
+  // The memory type must be supported by both the host pointer and the buffer.
+  VkMemoryHostPointerPropertiesEXT host_pointer_props;
+  memset(&host_pointer_props, 0, sizeof(host_pointer_props));
+  host_pointer_props.sType =
+      VK_STRUCTURE_TYPE_MEMORY_HOST_POINTER_PROPERTIES_EXT;
+  iree_status_t status = VK_RESULT_TO_STATUS(
+      syms->vkGetMemoryHostPointerPropertiesEXT(
+          *logical_device,
+          VK_EXTERNAL_MEMORY_HANDLE_TYPE_HOST_ALLOCATION_BIT_EXT, host_ptr,
+          &host_pointer_props),
+      "vkGetMemoryHostPointerPropertiesEXT");
+  uint32_t memory_type_index = 0;
+  VkMemoryPropertyFlags property_flags = 0;
+  if (iree_status_is_ok(status)) {
+    VkMemoryRequirements requirements;
+    syms->vkGetBufferMemoryRequirements(*logical_device, handle,
+                                        &requirements);
+    status = iree_hal_vulkan_vma_allocator_select_import_memory_type(
+        allocator, &compat_params,
+        requirements.memoryTypeBits & host_pointer_props.memoryTypeBits,
+        &memory_type_index, &property_flags);
+  }
+
+  VkDeviceMemory device_memory = VK_NULL_HANDLE;
+  if (iree_status_is_ok(status)) {
+    VkImportMemoryHostPointerInfoEXT import_info;
+    import_info.sType = VK_STRUCTURE_TYPE_IMPORT_MEMORY_HOST_POINTER_INFO_EXT;
+    import_info.pNext = NULL;
+    import_info.handleType =
+        VK_EXTERNAL_MEMORY_HANDLE_TYPE_HOST_ALLOCATION_BIT_EXT;
+    import_info.pHostPointer = host_ptr;
+    VkMemoryAllocateInfo allocate_info;
+    allocate_info.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
+    allocate_info.pNext = &import_info;
+    allocate_info.allocationSize = external_buffer->size;
+    allocate_info.memoryTypeIndex = memory_type_index;
+    status = VK_RESULT_TO_STATUS(
+        syms->vkAllocateMemory(*logical_device, &allocate_info,
+                               logical_device->allocator(), &device_memory),
+        "vkAllocateMemory");
+  }
+  if (iree_status_is_ok(status)) {
+    status = VK_RESULT_TO_STATUS(
+        syms->vkBindBufferMemory(*logical_device, handle, device_memory,
+                                 /*memoryOffset=*/0),
+        "vkBindBufferMemory");
+  }
+
+  if (iree_status_is_ok(status)) {
+    iree_hal_memory_type_t memory_type = IREE_HAL_MEMORY_TYPE_HOST_VISIBLE |
+                                         IREE_HAL_MEMORY_TYPE_HOST_COHERENT |
+                                         IREE_HAL_MEMORY_TYPE_DEVICE_VISIBLE;
+    if (iree_all_bits_set(property_flags,
+                          VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT)) {
+      memory_type |= IREE_HAL_MEMORY_TYPE_DEVICE_LOCAL;
+    }
+    if (iree_all_bits_set(property_flags,
+                          VK_MEMORY_PROPERTY_HOST_CACHED_BIT)) {
+      memory_type |= IREE_HAL_MEMORY_TYPE_HOST_CACHED;
+    }
+    status = iree_hal_vulkan_vma_buffer_wrap_imported(
+        (iree_hal_allocator_t*)allocator, memory_type, compat_params.access,
+        compat_params.usage | IREE_HAL_BUFFER_USAGE_MAPPING,
+        external_buffer->size, logical_device, handle, device_memory, host_ptr,
+        release_callback, out_buffer);
+  }
+
+  if (!iree_status_is_ok(status)) {
+    if (device_memory != VK_NULL_HANDLE) {
+      syms->vkFreeMemory(*logical_device, device_memory,
+                         logical_device->allocator());
+    }
+    syms->vkDestroyBuffer(*logical_device, handle,
+                          logical_device->allocator());
+  }
+  IREE_TRACE_ZONE_END(z0);
+  return status;
+}
+
 static iree_status_t iree_hal_vulkan_vma_allocator_import_buffer(
     iree_hal_allocator_t* IREE_RESTRICT base_allocator,
     const iree_hal_buffer_params_t* IREE_RESTRICT params,
     iree_hal_external_buffer_t* IREE_RESTRICT external_buffer,
     iree_hal_buffer_release_callback_t release_callback,
     iree_hal_buffer_t** IREE_RESTRICT out_buffer) {
-  // TODO(#7242): use VK_EXT_external_memory_host to import memory.
-  return iree_make_status(IREE_STATUS_UNAVAILABLE,
-                          "importing from external buffers not supported");
+  iree_hal_vulkan_vma_allocator_t* allocator =
+      iree_hal_vulkan_vma_allocator_cast(base_allocator);
+  switch (external_buffer->type) {
+    case IREE_HAL_EXTERNAL_BUFFER_TYPE_HOST_ALLOCATION:
+      return iree_hal_vulkan_vma_allocator_import_host_allocation(
+          allocator, params, external_buffer, release_callback, out_buffer);
+    default:
+      return iree_make_status(IREE_STATUS_UNAVAILABLE,
+                              "external buffer type not supported");
+  }
 }
 
 static iree_status_t iree_hal_vulkan_vma_allocator_export_buffer(
@@ -401,3 +758,101 @@ const iree_hal_allocator_vtable_t iree_hal_vulkan_vma_allocator_vtable = {
     /*.export_buffer=*/iree_hal_vulkan_vma_allocator_export_buffer,
 };
 }  // namespace
+
+// Returns the transient pool for buffers created with |buffer_create_info| and
+// |allocation_create_info|, creating it if needed. Returns VK_NULL_HANDLE if
+// no pool can be used and the allocation should go to the default pools.
+static VmaPool iree_hal_vulkan_vma_allocator_acquire_transient_pool(
+    iree_hal_vulkan_vma_allocator_t* allocator,
+    const VkBufferCreateInfo* buffer_create_info,
+    const VmaAllocationCreateInfo* allocation_create_info) {
+  VmaPool pool = VK_NULL_HANDLE;
+  iree_slim_mutex_lock(&allocator->transient_pool_mutex);
+  for (iree_host_size_t i = 0; i < allocator->transient_pool_count; ++i) {
+    if (allocator->transient_pools[i].usage == buffer_create_info->usage) {
+      pool = allocator->transient_pools[i].pool;
+      break;
+    }
+  }
+  if (pool == VK_NULL_HANDLE &&
+      allocator->transient_pool_count <
+          IREE_ARRAYSIZE(allocator->transient_pools)) {
+    VmaPoolCreateInfo pool_create_info;
+    memset(&pool_create_info, 0, sizeof(pool_create_info));
+    // Blocks are allocated on demand. VMA keeps one empty block alive after
+    // all of its allocations are freed so steady-state alloca/dealloca
+    // sequences do not go back to vkAllocateMemory every invocation.
+    pool_create_info.blockSize = allocator->transient_block_size;
+    VkResult result = vmaFindMemoryTypeIndexForBufferInfo(
+        allocator->vma, buffer_create_info, allocation_create_info,
+        &pool_create_info.memoryTypeIndex);
+    if (result == VK_SUCCESS) {
+      result = vmaCreatePool(allocator->vma, &pool_create_info, &pool);
+    }
+    if (result == VK_SUCCESS) {
+      iree_hal_vulkan_vma_transient_pool_t* transient_pool =
+          &allocator->transient_pools[allocator->transient_pool_count++];
+      transient_pool->usage = buffer_create_info->usage;
+      transient_pool->pool = pool;
+    } else {
+      pool = VK_NULL_HANDLE;
+    }
+  }
+  iree_slim_mutex_unlock(&allocator->transient_pool_mutex);
+  return pool;
+}
+
+iree_status_t iree_hal_vulkan_vma_allocator_allocate_transient(
+    iree_hal_allocator_t* IREE_RESTRICT base_allocator,
+    const iree_hal_buffer_params_t* IREE_RESTRICT params,
+    iree_device_size_t allocation_size,
+    iree_hal_buffer_t** IREE_RESTRICT out_buffer) {
+  IREE_ASSERT_ARGUMENT(base_allocator);
+  IREE_ASSERT_ARGUMENT(params);
+  IREE_ASSERT_ARGUMENT(out_buffer);
+  *out_buffer = NULL;
+  iree_hal_vulkan_vma_allocator_t* allocator =
+      iree_hal_vulkan_vma_allocator_cast(base_allocator);
+  IREE_TRACE_ZONE_BEGIN(z0);
+  IREE_TRACE_ZONE_APPEND_VALUE(z0, (int64_t)allocation_size);
+
+  iree_hal_buffer_params_t compat_params = *params;
+  iree_hal_buffer_params_canonicalize(&compat_params);
+  allocation_size = iree_hal_vulkan_vma_align_allocation_size(allocation_size);
+
+  VkBufferCreateInfo buffer_create_info;
+  VmaAllocationCreateInfo allocation_create_info;
+  iree_hal_vulkan_vma_populate_create_infos(&compat_params, allocation_size,
+                                            /*flags=*/0, &buffer_create_info,
+                                            &allocation_create_info);
+
+  // Only device-local memory is pooled: host-visible transients are rare and
+  // are better served by the default pools that handle mapping.
+  if (!iree_any_bit_set(compat_params.type,
+                        IREE_HAL_MEMORY_TYPE_HOST_VISIBLE) &&
+      !iree_any_bit_set(compat_params.usage, IREE_HAL_BUFFER_USAGE_MAPPING) &&
+      allocation_size <= allocator->transient_block_size) {
+    allocation_create_info.pool =
+        iree_hal_vulkan_vma_allocator_acquire_transient_pool(
+            allocator, &buffer_create_info, &allocation_create_info);
+  }
+
+  iree_status_t status = iree_hal_vulkan_vma_allocator_create_buffer(
+      allocator, &compat_params, allocation_size, &buffer_create_info,
+      &allocation_create_info, iree_const_byte_span_empty(),
+      /*out_initialized=*/NULL, out_buffer);
+  if (!iree_status_is_ok(status) &&
+      allocation_create_info.pool != VK_NULL_HANDLE) {
+    // The pool may be out of space in its memory type; fall back to the
+    // default pools, which may pick another memory type or heap.
+    iree_status_ignore(status);
+    allocation_create_info.pool = VK_NULL_HANDLE;
+    status = iree_hal_vulkan_vma_allocator_create_buffer(
+        allocator, &compat_params, allocation_size, &buffer_create_info,
+        &allocation_create_info, iree_const_byte_span_empty(),
+        /*out_initialized=*/NULL, out_buffer);
+  }
+
+  IREE_TRACE_ZONE_END(z0);
+  return status;
+}
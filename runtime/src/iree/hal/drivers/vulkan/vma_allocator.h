@@ -39,6 +39,18 @@ iree_status_t iree_hal_vulkan_vma_allocator_create(
     iree::hal::vulkan::VkDeviceHandle* logical_device,
     iree_hal_device_t* device, iree_hal_allocator_t** out_allocator);
 
+// Allocates a buffer for queue-ordered use (queue_alloca) from a VMA allocator
+// created with iree_hal_vulkan_vma_allocator_create.
+//
+// Device-local buffers are suballocated from custom pools dedicated to
+// transients that retain their device memory blocks across allocations. The
+// memory is returned to the pool when the last reference to the buffer is
+// released, which for buffers used by submitted work happens once that work
+// has retired. Allocations that cannot be pooled use the default VMA pools.
+iree_status_t iree_hal_vulkan_vma_allocator_allocate_transient(
+    iree_hal_allocator_t* allocator, const iree_hal_buffer_params_t* params,
+    iree_device_size_t allocation_size, iree_hal_buffer_t** out_buffer);
+
 #ifdef __cplusplus
 }  // extern "C"
 #endif  // __cplusplus
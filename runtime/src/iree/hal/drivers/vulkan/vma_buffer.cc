@@ -14,6 +14,8 @@
 #include "iree/base/tracing.h"
 #include "iree/hal/drivers/vulkan/status_util.h"
 
+using namespace iree::hal::vulkan;
+
 #if IREE_TRACING_FEATURES & IREE_TRACING_FEATURE_ALLOCATION_TRACKING
 static const char* IREE_HAL_VULKAN_VMA_ALLOCATOR_ID = "Vulkan/VMA";
 #endif  // IREE_TRACING_FEATURE_ALLOCATION_TRACKING
@@ -23,8 +25,17 @@ typedef struct iree_hal_vulkan_vma_buffer_t {
 
   VmaAllocator vma;
   VkBuffer handle;
+  // VK_NULL_HANDLE if the buffer wraps imported memory.
   VmaAllocation allocation;
   VmaAllocationInfo allocation_info;
+
+  // Only used by buffers wrapping imported host memory.
+  struct {
+    VkDeviceHandle* logical_device;
+    VkDeviceMemory device_memory;
+    void* host_ptr;
+    iree_hal_buffer_release_callback_t release_callback;
+  } imported;
 } iree_hal_vulkan_vma_buffer_t;
 
 namespace {
@@ -80,7 +91,46 @@ iree_status_t iree_hal_vulkan_vma_buffer_wrap(
   }
 
   IREE_TRACE_ZONE_END(z0);
-  return iree_ok_status();
+  return status;
+}
+
+iree_status_t iree_hal_vulkan_vma_buffer_wrap_imported(
+    iree_hal_allocator_t* allocator, iree_hal_memory_type_t memory_type,
+    iree_hal_memory_access_t allowed_access,
+    iree_hal_buffer_usage_t allowed_usage, iree_device_size_t allocation_size,
+    VkDeviceHandle* logical_device, VkBuffer handle,
+    VkDeviceMemory device_memory, void* host_ptr,
+    iree_hal_buffer_release_callback_t release_callback,
+    iree_hal_buffer_t** out_buffer) {
+  IREE_ASSERT_ARGUMENT(allocator);
+  IREE_ASSERT_ARGUMENT(logical_device);
+  IREE_ASSERT_ARGUMENT(handle);
+  IREE_ASSERT_ARGUMENT(device_memory);
+  IREE_ASSERT_ARGUMENT(out_buffer);
+  IREE_TRACE_ZONE_BEGIN(z0);
+  IREE_TRACE_ZONE_APPEND_VALUE(z0, (int64_t)allocation_size);
+
+  iree_allocator_t host_allocator =
+      iree_hal_allocator_host_allocator(allocator);
+  iree_hal_vulkan_vma_buffer_t* buffer = NULL;
+  iree_status_t status =
+      iree_allocator_malloc(host_allocator, sizeof(*buffer), (void**)&buffer);
+  if (iree_status_is_ok(status)) {
+    iree_hal_buffer_initialize(
+        host_allocator, allocator, &buffer->base, allocation_size,
+        /*byte_offset=*/0, /*byte_length=*/allocation_size, memory_type,
+        allowed_access, allowed_usage, &iree_hal_vulkan_vma_buffer_vtable,
+        &buffer->base);
+    buffer->handle = handle;
+    buffer->imported.logical_device = logical_device;
+    buffer->imported.device_memory = device_memory;
+    buffer->imported.host_ptr = host_ptr;
+    buffer->imported.release_callback = release_callback;
+    *out_buffer = &buffer->base;
+  }
+
+  IREE_TRACE_ZONE_END(z0);
+  return status;
 }
 
 static void iree_hal_vulkan_vma_buffer_destroy(iree_hal_buffer_t* base_buffer) {
@@ -91,10 +141,24 @@ static void iree_hal_vulkan_vma_buffer_destroy(iree_hal_buffer_t* base_buffer) {
   IREE_TRACE_ZONE_APPEND_VALUE(
       z0, (int64_t)iree_hal_buffer_allocation_size(base_buffer));
 
-  IREE_TRACE_FREE_NAMED(IREE_HAL_VULKAN_VMA_ALLOCATOR_ID,
-                        (void*)buffer->handle);
-
-  vmaDestroyBuffer(buffer->vma, buffer->handle, buffer->allocation);
+  if (buffer->imported.device_memory != VK_NULL_HANDLE) {
+    // The device is done with the host memory once it has been freed so the
+    // owner can be notified that it may reuse it.
+    VkDeviceHandle* logical_device = buffer->imported.logical_device;
+    logical_device->syms()->vkDestroyBuffer(*logical_device, buffer->handle,
+                                            logical_device->allocator());
+    logical_device->syms()->vkFreeMemory(*logical_device,
+                                         buffer->imported.device_memory,
+                                         logical_device->allocator());
+    if (buffer->imported.release_callback.fn) {
+      buffer->imported.release_callback.fn(
+          buffer->imported.release_callback.user_data, base_buffer);
+    }
+  } else {
+    IREE_TRACE_FREE_NAMED(IREE_HAL_VULKAN_VMA_ALLOCATOR_ID,
+                          (void*)buffer->handle);
+    vmaDestroyBuffer(buffer->vma, buffer->handle, buffer->allocation);
+  }
   iree_allocator_free(host_allocator, buffer);
 
   IREE_TRACE_ZONE_END(z0);
@@ -123,9 +187,14 @@ static iree_status_t iree_hal_vulkan_vma_buffer_map_range(
                                      IREE_HAL_BUFFER_USAGE_MAPPING));
 
   uint8_t* data_ptr = nullptr;
-  VK_RETURN_IF_ERROR(
-      vmaMapMemory(buffer->vma, buffer->allocation, (void**)&data_ptr),
-      "vmaMapMemory");
+  if (buffer->imported.device_memory != VK_NULL_HANDLE) {
+    // Imported host memory is always accessible through its host pointer.
+    data_ptr = (uint8_t*)buffer->imported.host_ptr;
+  } else {
+    VK_RETURN_IF_ERROR(
+        vmaMapMemory(buffer->vma, buffer->allocation, (void**)&data_ptr),
+        "vmaMapMemory");
+  }
   mapping->contents =
       iree_make_byte_span(data_ptr + local_byte_offset, local_byte_length);
 
@@ -147,6 +216,9 @@ static iree_status_t iree_hal_vulkan_vma_buffer_unmap_range(
     iree_device_size_t local_byte_length, iree_hal_buffer_mapping_t* mapping) {
   iree_hal_vulkan_vma_buffer_t* buffer =
       iree_hal_vulkan_vma_buffer_cast(base_buffer);
+  if (buffer->imported.device_memory != VK_NULL_HANDLE) {
+    return iree_ok_status();
+  }
   vmaUnmapMemory(buffer->vma, buffer->allocation);
   return iree_ok_status();
 }
@@ -156,6 +228,10 @@ static iree_status_t iree_hal_vulkan_vma_buffer_invalidate_range(
     iree_device_size_t local_byte_length) {
   iree_hal_vulkan_vma_buffer_t* buffer =
       iree_hal_vulkan_vma_buffer_cast(base_buffer);
+  // Imported memory is host-coherent.
+  if (buffer->imported.device_memory != VK_NULL_HANDLE) {
+    return iree_ok_status();
+  }
   VK_RETURN_IF_ERROR(
       vmaInvalidateAllocation(buffer->vma, buffer->allocation,
                               local_byte_offset, local_byte_length),
@@ -168,6 +244,10 @@ static iree_status_t iree_hal_vulkan_vma_buffer_flush_range(
     iree_device_size_t local_byte_length) {
   iree_hal_vulkan_vma_buffer_t* buffer =
       iree_hal_vulkan_vma_buffer_cast(base_buffer);
+  // Imported memory is host-coherent.
+  if (buffer->imported.device_memory != VK_NULL_HANDLE) {
+    return iree_ok_status();
+  }
   VK_RETURN_IF_ERROR(vmaFlushAllocation(buffer->vma, buffer->allocation,
                                         local_byte_offset, local_byte_length),
                      "vmaFlushAllocation");
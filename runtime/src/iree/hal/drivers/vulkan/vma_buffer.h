@@ -9,6 +9,7 @@
 
 #include "iree/base/api.h"
 #include "iree/hal/api.h"
+#include "iree/hal/drivers/vulkan/handle_util.h"
 #include "iree/hal/drivers/vulkan/internal_vk_mem_alloc.h"
 
 #ifdef __cplusplus
@@ -25,6 +26,23 @@ iree_status_t iree_hal_vulkan_vma_buffer_wrap(
     VmaAllocator vma, VkBuffer handle, VmaAllocation allocation,
     VmaAllocationInfo allocation_info, iree_hal_buffer_t** out_buffer);
 
+// Wraps host memory at |host_ptr| imported as |device_memory| and bound to
+// |handle| in an iree_hal_buffer_t. The memory is not owned by VMA but the
+// buffer can be used anywhere VMA buffers are. On release the buffer and
+// device memory are destroyed and |release_callback| is issued to indicate
+// that the host memory is no longer in use by the device.
+//
+// The imported memory must be host-coherent as the host pointer is used
+// directly for mappings without flushes or invalidations.
+iree_status_t iree_hal_vulkan_vma_buffer_wrap_imported(
+    iree_hal_allocator_t* allocator, iree_hal_memory_type_t memory_type,
+    iree_hal_memory_access_t allowed_access,
+    iree_hal_buffer_usage_t allowed_usage, iree_device_size_t allocation_size,
+    iree::hal::vulkan::VkDeviceHandle* logical_device, VkBuffer handle,
+    VkDeviceMemory device_memory, void* host_ptr,
+    iree_hal_buffer_release_callback_t release_callback,
+    iree_hal_buffer_t** out_buffer);
+
 // Returns the Vulkan handle backing the given |buffer|.
 // This is the entire allocated_buffer and must be offset by the buffer
 // byte_offset and byte_length when used.
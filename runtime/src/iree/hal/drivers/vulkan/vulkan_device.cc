@@ -12,6 +12,7 @@
 #include <vector>
 
 #include "iree/base/internal/arena.h"
+#include "iree/base/internal/file_io.h"
 #include "iree/base/internal/math.h"
 #include "iree/base/tracing.h"
 #include "iree/hal/drivers/vulkan/api.h"
@@ -24,15 +25,18 @@
 #include "iree/hal/drivers/vulkan/extensibility_util.h"
 #include "iree/hal/drivers/vulkan/handle_util.h"
 #include "iree/hal/drivers/vulkan/native_event.h"
+#include "iree/hal/drivers/vulkan/native_executable_cache.h"
 #include "iree/hal/drivers/vulkan/native_pipeline_layout.h"
 #include "iree/hal/drivers/vulkan/native_semaphore.h"
 #include "iree/hal/drivers/vulkan/nop_executable_cache.h"
+#include "iree/hal/drivers/vulkan/staging_ring.h"
 #include "iree/hal/drivers/vulkan/status_util.h"
 #include "iree/hal/drivers/vulkan/tracing.h"
 #include "iree/hal/drivers/vulkan/util/arena.h"
 #include "iree/hal/drivers/vulkan/util/ref_ptr.h"
 #include "iree/hal/drivers/vulkan/vma_allocator.h"
 #include "iree/hal/utils/buffer_transfer.h"
+#include "iree/hal/utils/deferred_command_buffer.h"
 
 using namespace iree::hal::vulkan;
 
@@ -220,6 +224,16 @@ IREE_API_EXPORT iree_status_t iree_hal_vulkan_query_extensibility_set(
   ADD_EXT(IREE_HAL_VULKAN_EXTENSIBILITY_DEVICE_EXTENSIONS_OPTIONAL,
           VK_EXT_SUBGROUP_SIZE_CONTROL_EXTENSION_NAME);
 
+  //===--------------------------------------------------------------------===//
+  // Optional memory features
+  //===--------------------------------------------------------------------===//
+  // VK_EXT_external_memory_host:
+  // Allows host allocations to be imported as device memory without copies.
+  // This is most useful on integrated GPUs where the device can access host
+  // memory at full speed, but also avoids staging copies on discrete GPUs.
+  ADD_EXT(IREE_HAL_VULKAN_EXTENSIBILITY_DEVICE_EXTENSIONS_OPTIONAL,
+          VK_EXT_EXTERNAL_MEMORY_HOST_EXTENSION_NAME);
+
   //===--------------------------------------------------------------------===//
   // Optional debugging features
   //===--------------------------------------------------------------------===//
@@ -430,10 +444,10 @@ static iree_status_t iree_hal_vulkan_build_queue_sets(
 
   memset(out_transfer_queue_set, 0, sizeof(*out_transfer_queue_set));
   out_transfer_queue_set->queue_family_index = queue_family_info.transfer_index;
-  uint32_t base_queue_index = 0;
+  iree_host_size_t base_queue_index = 0;
   if (queue_family_info.dispatch_index == queue_family_info.transfer_index) {
     // Sharing a family, so transfer queues follow compute queues.
-    base_queue_index = queue_family_info.dispatch_index;
+    base_queue_index = queue_family_info.dispatch_queue_count;
   }
   for (iree_host_size_t i = 0; i < queue_family_info.transfer_queue_count;
        ++i) {
@@ -487,12 +501,27 @@ typedef struct iree_hal_vulkan_device_t {
   VkCommandPoolHandle* dispatch_command_pool;
   VkCommandPoolHandle* transfer_command_pool;
 
+  // Released direct command buffers reused by later allocations from the
+  // command pools above.
+  iree_hal_vulkan_direct_command_buffer_cache_t command_buffer_cache;
+
   // Block pool used for command buffers with a larger block size (as command
   // buffers can contain inlined data uploads).
   iree_arena_block_pool_t block_pool;
 
   BuiltinExecutables* builtin_executables;
 
+  // Pipeline cache shared by all executable caches created on the device.
+  // VK_NULL_HANDLE if pipeline caching is disabled by the device flags.
+  VkPipelineCache pipeline_cache;
+  // NUL-terminated path the pipeline cache is loaded from and written back to,
+  // if it is persisted.
+  iree_string_view_t pipeline_cache_path;
+
+  // Persistent staging buffers used by transfer_range for device buffers the
+  // host cannot map.
+  iree_hal_vulkan_staging_ring_t staging_ring;
+
 #if defined(IREE_HAL_VULKAN_HAVE_RENDERDOC)
   RENDERDOC_API_LATEST* renderdoc_api;
 #endif  // IREE_HAL_VULKAN_HAVE_RENDERDOC
@@ -569,11 +598,12 @@ static iree_status_t iree_hal_vulkan_device_initialize_command_queues(
   // the tracing subsystem for query and cleanup tasks.
   VkQueue maintenance_dispatch_queue = VK_NULL_HANDLE;
 
-  uint64_t compute_queue_count =
-      iree_math_count_ones_u64(compute_queue_set->queue_indices);
+  // Queue indices are bit positions within the queue family and need not be
+  // contiguous or start at zero (transfer queues sharing a family with the
+  // compute queues follow them).
   uint64_t transfer_queue_count =
       iree_math_count_ones_u64(transfer_queue_set->queue_indices);
-  for (iree_host_size_t i = 0; i < compute_queue_count; ++i) {
+  for (iree_host_size_t i = 0; i < 64; ++i) {
     if (!(compute_queue_set->queue_indices & (1ull << i))) continue;
 
     char queue_name_buffer[32];
@@ -611,7 +641,7 @@ static iree_status_t iree_hal_vulkan_device_initialize_command_queues(
       queue->set_tracing_context(device->queue_tracing_contexts[queue_index]);
     }
   }
-  for (iree_host_size_t i = 0; i < transfer_queue_count; ++i) {
+  for (iree_host_size_t i = 0; i < 64; ++i) {
     if (!(transfer_queue_set->queue_indices & (1ull << i))) continue;
 
     char queue_name_buffer[32];
@@ -643,6 +673,56 @@ static iree_status_t iree_hal_vulkan_device_initialize_command_queues(
   return iree_ok_status();
 }
 
+// Creates the device pipeline cache, seeded from serialized data provided by
+// the application or persisted by a previous run.
+static iree_status_t iree_hal_vulkan_device_create_pipeline_cache(
+    iree_hal_vulkan_device_t* device,
+    const iree_hal_vulkan_device_options_t* options) {
+  IREE_TRACE_ZONE_BEGIN(z0);
+
+  iree_const_byte_span_t initial_data = options->pipeline_cache_data;
+  iree_file_contents_t* file_contents = NULL;
+  if (initial_data.data_length == 0 &&
+      !iree_string_view_is_empty(device->pipeline_cache_path)) {
+    // A missing or unreadable file is expected on the first run and only means
+    // that pipelines get compiled from scratch.
+    iree_status_t read_status =
+        iree_file_read_contents(device->pipeline_cache_path.data,
+                                device->host_allocator, &file_contents);
+    if (iree_status_is_ok(read_status)) {
+      initial_data = file_contents->const_buffer;
+    } else {
+      iree_status_ignore(read_status);
+    }
+  }
+
+  iree_status_t status = iree_hal_vulkan_pipeline_cache_create(
+      device->logical_device, device->physical_device, initial_data,
+      &device->pipeline_cache);
+
+  iree_file_contents_free(file_contents);
+  IREE_TRACE_ZONE_END(z0);
+  return status;
+}
+
+// Writes the device pipeline cache to |pipeline_cache_path|.
+static iree_status_t iree_hal_vulkan_device_persist_pipeline_cache(
+    iree_hal_vulkan_device_t* device) {
+  IREE_TRACE_ZONE_BEGIN(z0);
+  iree_byte_span_t data = iree_byte_span_empty();
+  iree_status_t status = iree_hal_vulkan_pipeline_cache_serialize(
+      device->logical_device, device->pipeline_cache, device->host_allocator,
+      &data);
+  if (iree_status_is_ok(status)) {
+    status = iree_file_write_contents(
+        device->pipeline_cache_path.data,
+        iree_make_const_byte_span(data.data, data.data_length));
+  }
+  iree_allocator_free(device->host_allocator, data.data);
+  IREE_TRACE_ZONE_END(z0);
+  return status;
+}
+
 static iree_status_t iree_hal_vulkan_device_create_internal(
     iree_hal_driver_t* driver, iree_string_view_t identifier,
     iree_hal_vulkan_features_t enabled_features,
@@ -662,6 +742,7 @@ static iree_status_t iree_hal_vulkan_device_create_internal(
   iree_hal_vulkan_device_t* device = NULL;
   iree_host_size_t total_size =
       sizeof(*device) + identifier.size +
+      options->pipeline_cache_path.size + /*NUL=*/1 +
       total_queue_count * sizeof(device->queues[0]) +
       total_queue_count * sizeof(device->dispatch_queues[0]) +
       total_queue_count * sizeof(device->transfer_queues[0]) +
@@ -677,6 +758,10 @@ static iree_status_t iree_hal_vulkan_device_create_internal(
   uint8_t* buffer_ptr = (uint8_t*)device + sizeof(*device);
   buffer_ptr += iree_string_view_append_to_buffer(
       identifier, &device->identifier, (char*)buffer_ptr);
+  buffer_ptr += iree_string_view_append_to_buffer(options->pipeline_cache_path,
+                                                  &device->pipeline_cache_path,
+                                                  (char*)buffer_ptr);
+  *buffer_ptr++ = 0;  // NUL terminator for the file APIs.
   device->flags = options->flags;
 
   device->device_extensions = *device_extensions;
@@ -691,6 +776,10 @@ static iree_status_t iree_hal_vulkan_device_create_internal(
 
   iree_arena_block_pool_initialize(32 * 1024, host_allocator,
                                    &device->block_pool);
+  iree_hal_vulkan_staging_ring_initialize((iree_hal_device_t*)device,
+                                          &device->staging_ring);
+  iree_hal_vulkan_direct_command_buffer_cache_initialize(
+      &device->command_buffer_cache);
 
   // Point the queue storage into the new device allocation. The queues
   // themselves are populated
@@ -738,6 +827,12 @@ static iree_status_t iree_hal_vulkan_device_create_internal(
         transfer_queue_set);
   }
 
+  if (iree_status_is_ok(status) &&
+      !iree_all_bits_set(device->flags,
+                         IREE_HAL_VULKAN_DEVICE_FLAG_DISABLE_PIPELINE_CACHE)) {
+    status = iree_hal_vulkan_device_create_pipeline_cache(device, options);
+  }
+
   if (iree_status_is_ok(status)) {
     device->builtin_executables =
         new BuiltinExecutables(device->logical_device);
@@ -763,8 +858,13 @@ static void iree_hal_vulkan_device_destroy(iree_hal_device_t* base_device) {
     iree_hal_vulkan_tracing_context_free(device->queue_tracing_contexts[i]);
   }
 
+  // Staging transfers are synchronous so the chunks are no longer in use.
+  iree_hal_vulkan_staging_ring_deinitialize(&device->staging_ring);
+
   // Drop command pools now that we know there are no more outstanding command
-  // buffers.
+  // buffers. Cached command buffers are freed back to the pools first.
+  iree_hal_vulkan_direct_command_buffer_cache_deinitialize(
+      &device->command_buffer_cache);
   delete device->dispatch_command_pool;
   delete device->transfer_command_pool;
 
@@ -773,6 +873,18 @@ static void iree_hal_vulkan_device_destroy(iree_hal_device_t* base_device) {
   delete device->builtin_executables;
   delete device->descriptor_pool_cache;
 
+  // All pipelines have been destroyed and the pipeline cache now holds
+  // everything compiled during the lifetime of the device. Failing to persist
+  // it only costs compilation time on the next run so it is not an error.
+  if (device->pipeline_cache != VK_NULL_HANDLE) {
+    if (!iree_string_view_is_empty(device->pipeline_cache_path)) {
+      iree_status_ignore(iree_hal_vulkan_device_persist_pipeline_cache(device));
+    }
+    device->logical_device->syms()->vkDestroyPipelineCache(
+        *device->logical_device, device->pipeline_cache,
+        device->logical_device->allocator());
+  }
+
   // There should be no more buffers live that use the allocator.
   iree_hal_allocator_release(device->device_allocator);
 
@@ -1021,6 +1133,22 @@ IREE_API_EXPORT iree_status_t iree_hal_vulkan_wrap_device(
   return status;
 }
 
+IREE_API_EXPORT iree_status_t iree_hal_vulkan_device_serialize_pipeline_cache(
+    iree_hal_device_t* base_device, iree_allocator_t host_allocator,
+    iree_byte_span_t* out_data) {
+  IREE_ASSERT_ARGUMENT(base_device);
+  IREE_ASSERT_ARGUMENT(out_data);
+  *out_data = iree_byte_span_empty();
+  iree_hal_vulkan_device_t* device = iree_hal_vulkan_device_cast(base_device);
+  if (device->pipeline_cache == VK_NULL_HANDLE) {
+    return iree_make_status(IREE_STATUS_FAILED_PRECONDITION,
+                            "pipeline caching is disabled on the device");
+  }
+  return iree_hal_vulkan_pipeline_cache_serialize(
+      device->logical_device, device->pipeline_cache, host_allocator,
+      out_data);
+}
+
 static iree_string_view_t iree_hal_vulkan_device_id(
     iree_hal_device_t* base_device) {
   iree_hal_vulkan_device_t* device = iree_hal_vulkan_device_cast(base_device);
@@ -1042,7 +1170,12 @@ static iree_hal_allocator_t* iree_hal_vulkan_device_allocator(
 static iree_status_t iree_hal_vulkan_device_trim(
     iree_hal_device_t* base_device) {
   iree_hal_vulkan_device_t* device = iree_hal_vulkan_device_cast(base_device);
+  iree_hal_vulkan_direct_command_buffer_cache_trim(
+      &device->command_buffer_cache);
   iree_arena_block_pool_trim(&device->block_pool);
+  device->descriptor_pool_cache->Trim();
+  IREE_RETURN_IF_ERROR(
+      iree_hal_vulkan_staging_ring_trim(&device->staging_ring));
   return iree_hal_allocator_trim(device->device_allocator);
 }
 
@@ -1069,26 +1202,49 @@ static iree_status_t iree_hal_vulkan_device_query_i64(
 }
 
 // Returns the queue to submit work to based on the |queue_affinity|.
+// Returns true if command buffers with only transfer commands are recorded for
+// and submitted to the transfer queues instead of the dispatch queues.
+static bool iree_hal_vulkan_device_uses_transfer_queues(
+    iree_hal_vulkan_device_t* device) {
+  // Tracing records its queries using the dispatch queues so we keep all work
+  // there to have a consistent timeline.
+  return device->transfer_command_pool &&
+         iree_all_bits_set(
+             device->flags,
+             IREE_HAL_VULKAN_DEVICE_FLAG_DEDICATED_TRANSFER_QUEUES) &&
+         !device->dispatch_queues[0]->tracing_context();
+}
+
+// Selects the queue from |queues| servicing |queue_affinity|.
+// Each bit in the affinity is a logical queue and logical queues wrap around
+// the available queues. When multiple bits are set the lowest is used so that
+// an affinity always maps to the same queue and the submissions made with it
+// execute in order; the caller must use semaphores to order work across
+// different affinities.
+static CommandQueue* iree_hal_vulkan_device_select_queue_for_affinity(
+    iree_host_size_t queue_count, CommandQueue** queues,
+    iree_hal_queue_affinity_t queue_affinity) {
+  if (queue_affinity == 0) queue_affinity = IREE_HAL_QUEUE_AFFINITY_ANY;
+  return queues[iree_math_count_trailing_zeros_u64(queue_affinity) %
+                queue_count];
+}
+
 static CommandQueue* iree_hal_vulkan_device_select_queue(
     iree_hal_vulkan_device_t* device,
     iree_hal_command_category_t command_categories,
     iree_hal_queue_affinity_t queue_affinity) {
-  // TODO(scotttodd): revisit queue selection logic and remove this
-  //   * the unaligned buffer fill polyfill and tracing timestamp queries may
-  //     both insert dispatches into command buffers that at compile time are
-  //     expected to only contain transfer commands
-  //   * we could set a bit at recording time if emulation or tracing is used
-  //     and submit to the right queue based on that
-  command_categories |= IREE_HAL_COMMAND_CATEGORY_DISPATCH;
-
-  // TODO(benvanik): meaningful heuristics for affinity. We don't generate
-  // anything from the compiler that uses multiple queues and until we do it's
-  // best not to do anything too clever here.
+  // The unaligned buffer fill polyfill inserts dispatches into command buffers
+  // that are otherwise expected to only contain transfer commands so unless
+  // requested we run everything on the dispatch queues.
+  if (!iree_hal_vulkan_device_uses_transfer_queues(device)) {
+    command_categories |= IREE_HAL_COMMAND_CATEGORY_DISPATCH;
+  }
   if (command_categories == IREE_HAL_COMMAND_CATEGORY_TRANSFER) {
-    return device
-        ->transfer_queues[queue_affinity % device->transfer_queue_count];
+    return iree_hal_vulkan_device_select_queue_for_affinity(
+        device->transfer_queue_count, device->transfer_queues, queue_affinity);
   }
-  return device->dispatch_queues[queue_affinity % device->dispatch_queue_count];
+  return iree_hal_vulkan_device_select_queue_for_affinity(
+      device->dispatch_queue_count, device->dispatch_queues, queue_affinity);
 }
 
 static iree_status_t iree_hal_vulkan_device_create_channel(
@@ -1105,20 +1261,31 @@ static iree_status_t iree_hal_vulkan_device_create_command_buffer(
     iree_hal_command_buffer_t** out_command_buffer) {
   iree_hal_vulkan_device_t* device = iree_hal_vulkan_device_cast(base_device);
 
-  // TODO(scotttodd): revisit queue selection logic and remove this
-  //   * the unaligned buffer fill polyfill and tracing timestamp queries may
-  //     both insert dispatches into command buffers that at compile time are
-  //     expected to only contain transfer commands
-  //   * we could set a bit at recording time if emulation or tracing is used
-  //     and submit to the right queue based on that
-  command_categories |= IREE_HAL_COMMAND_CATEGORY_DISPATCH;
+  // Vulkan has no native binding tables so nested command buffers that use
+  // them are recorded into a compact command list and replayed into the
+  // primary command buffer that executes them with the bindings resolved.
+  // Nested command buffers without binding tables map to secondary command
+  // buffers and can be reused directly.
+  if (iree_all_bits_set(mode, IREE_HAL_COMMAND_BUFFER_MODE_NESTED) &&
+      binding_capacity > 0) {
+    return iree_hal_deferred_command_buffer_create(
+        base_device, mode, command_categories, binding_capacity,
+        &device->block_pool, device->host_allocator, out_command_buffer);
+  }
+
+  // The unaligned buffer fill polyfill and tracing timestamp queries may insert
+  // dispatches into command buffers that are expected to only contain transfer
+  // commands. Unless the transfer queues were requested we record everything
+  // for the dispatch queues.
+  if (!iree_hal_vulkan_device_uses_transfer_queues(device)) {
+    command_categories |= IREE_HAL_COMMAND_CATEGORY_DISPATCH;
+  }
 
   // Select the command pool to used based on the types of commands used.
   // Note that we may not have a dedicated transfer command pool if there are
   // no dedicated transfer queues.
   VkCommandPoolHandle* command_pool = NULL;
-  if (device->transfer_command_pool &&
-      !iree_all_bits_set(command_categories,
+  if (!iree_all_bits_set(command_categories,
                          IREE_HAL_COMMAND_CATEGORY_DISPATCH)) {
     command_pool = device->transfer_command_pool;
   } else {
@@ -1137,7 +1304,8 @@ static iree_status_t iree_hal_vulkan_device_create_command_buffer(
       base_device, device->logical_device, command_pool, mode,
       command_categories, queue_affinity, binding_capacity,
       queue->tracing_context(), device->descriptor_pool_cache,
-      device->builtin_executables, &device->block_pool, out_command_buffer);
+      device->builtin_executables, &device->block_pool,
+      &device->command_buffer_cache, out_command_buffer);
 }
 
 static iree_status_t iree_hal_vulkan_device_create_descriptor_set_layout(
@@ -1162,8 +1330,13 @@ static iree_status_t iree_hal_vulkan_device_create_executable_cache(
     iree_hal_device_t* base_device, iree_string_view_t identifier,
     iree_loop_t loop, iree_hal_executable_cache_t** out_executable_cache) {
   iree_hal_vulkan_device_t* device = iree_hal_vulkan_device_cast(base_device);
-  return iree_hal_vulkan_nop_executable_cache_create(
-      device->logical_device, identifier, out_executable_cache);
+  if (device->pipeline_cache == VK_NULL_HANDLE) {
+    return iree_hal_vulkan_nop_executable_cache_create(
+        device->logical_device, identifier, out_executable_cache);
+  }
+  return iree_hal_vulkan_native_executable_cache_create(
+      device->logical_device, identifier, device->pipeline_cache,
+      out_executable_cache);
 }
 
 static iree_status_t iree_hal_vulkan_device_create_pipeline_layout(
@@ -1199,6 +1372,26 @@ iree_hal_vulkan_device_query_semaphore_compatibility(
   return IREE_HAL_SEMAPHORE_COMPATIBILITY_HOST_ONLY;
 }
 
+static iree_status_t iree_hal_vulkan_device_transfer_range(
+    iree_hal_device_t* base_device, iree_hal_transfer_buffer_t source,
+    iree_device_size_t source_offset, iree_hal_transfer_buffer_t target,
+    iree_device_size_t target_offset, iree_device_size_t data_length,
+    iree_hal_transfer_buffer_flags_t flags, iree_timeout_t timeout) {
+  iree_hal_vulkan_device_t* device = iree_hal_vulkan_device_cast(base_device);
+  // Small transfers are embedded directly in the command buffer as updates and
+  // don't need staging. Large transfers to or from buffers the host can't map
+  // would otherwise allocate a staging buffer the size of the whole range.
+  if (data_length > IREE_HAL_COMMAND_BUFFER_MAX_UPDATE_SIZE &&
+      iree_hal_vulkan_staging_ring_should_stage(source, target)) {
+    return iree_hal_vulkan_staging_ring_transfer_range(
+        &device->staging_ring, source, source_offset, target, target_offset,
+        data_length, timeout);
+  }
+  return iree_hal_device_submit_transfer_range_and_wait(
+      base_device, source, source_offset, target, target_offset, data_length,
+      flags, timeout);
+}
+
 static iree_status_t iree_hal_vulkan_device_queue_alloca(
     iree_hal_device_t* base_device, iree_hal_queue_affinity_t queue_affinity,
     const iree_hal_semaphore_list_t wait_semaphore_list,
@@ -1206,14 +1399,25 @@ static iree_status_t iree_hal_vulkan_device_queue_alloca(
     iree_hal_allocator_pool_t pool, iree_hal_buffer_params_t params,
     iree_device_size_t allocation_size,
     iree_hal_buffer_t** IREE_RESTRICT out_buffer) {
-  // TODO(benvanik): queue-ordered allocations.
-  IREE_RETURN_IF_ERROR(iree_hal_semaphore_list_wait(wait_semaphore_list,
-                                                    iree_infinite_timeout()));
-  IREE_RETURN_IF_ERROR(iree_hal_allocator_allocate_buffer(
-      iree_hal_device_allocator(base_device), params, allocation_size,
-      iree_const_byte_span_empty(), out_buffer));
-  IREE_RETURN_IF_ERROR(iree_hal_semaphore_list_signal(signal_semaphore_list));
-  return iree_ok_status();
+  iree_hal_vulkan_device_t* device = iree_hal_vulkan_device_cast(base_device);
+
+  // The buffer is allocated immediately instead of once the waits are
+  // satisfied: transient memory is suballocated from pools that retain their
+  // device memory so this is cheap and avoids blocking the host. Only the
+  // signals need to be ordered on the queue; any work using the buffer waits on
+  // them. The memory returns to its pool when the last reference is released,
+  // which for command buffers happens when they retire.
+  iree_hal_buffer_t* buffer = NULL;
+  IREE_RETURN_IF_ERROR(iree_hal_vulkan_vma_allocator_allocate_transient(
+      device->device_allocator, &params, allocation_size, &buffer));
+  iree_status_t status = iree_hal_device_queue_barrier(
+      base_device, queue_affinity, wait_semaphore_list, signal_semaphore_list);
+  if (iree_status_is_ok(status)) {
+    *out_buffer = buffer;
+  } else {
+    iree_hal_buffer_release(buffer);
+  }
+  return status;
 }
 
 static iree_status_t iree_hal_vulkan_device_queue_dealloca(
@@ -1221,7 +1425,9 @@ static iree_status_t iree_hal_vulkan_device_queue_dealloca(
     const iree_hal_semaphore_list_t wait_semaphore_list,
     const iree_hal_semaphore_list_t signal_semaphore_list,
     iree_hal_buffer_t* buffer) {
-  // TODO(benvanik): queue-ordered allocations.
+  // The memory is returned to its pool when the caller releases its reference
+  // after any in-flight work using it has retired (see queue_alloca) so we only
+  // need to preserve the queue ordering of the signals.
   IREE_RETURN_IF_ERROR(iree_hal_device_queue_barrier(
       base_device, queue_affinity, wait_semaphore_list, signal_semaphore_list));
   return iree_ok_status();
@@ -1234,9 +1440,36 @@ static iree_status_t iree_hal_vulkan_device_queue_execute(
     iree_host_size_t command_buffer_count,
     iree_hal_command_buffer_t* const* command_buffers) {
   iree_hal_vulkan_device_t* device = iree_hal_vulkan_device_cast(base_device);
-  // NOTE: today we are not discriminating queues based on command type.
+
+  // Batches of only transfer command buffers go to the transfer queues. The
+  // command buffers were recorded from the command pool of the queue family
+  // they must execute on so batches cannot mix them with dispatch command
+  // buffers.
+  iree_hal_command_category_t command_categories =
+      command_buffer_count > 0 ? IREE_HAL_COMMAND_CATEGORY_TRANSFER
+                               : IREE_HAL_COMMAND_CATEGORY_DISPATCH;
+  for (iree_host_size_t i = 0; i < command_buffer_count; ++i) {
+    command_categories |=
+        iree_hal_command_buffer_allowed_categories(command_buffers[i]);
+  }
+  if (iree_hal_vulkan_device_uses_transfer_queues(device) &&
+      iree_any_bit_set(command_categories,
+                       IREE_HAL_COMMAND_CATEGORY_DISPATCH)) {
+    for (iree_host_size_t i = 0; i < command_buffer_count; ++i) {
+      if (!iree_any_bit_set(
+              iree_hal_command_buffer_allowed_categories(command_buffers[i]),
+              IREE_HAL_COMMAND_CATEGORY_DISPATCH)) {
+        return iree_make_status(
+            IREE_STATUS_INVALID_ARGUMENT,
+            "transfer-only command buffers execute on the transfer queues and "
+            "cannot be submitted in the same batch as command buffers with "
+            "dispatches; submit them separately and order them with "
+            "semaphores");
+      }
+    }
+  }
   CommandQueue* queue = iree_hal_vulkan_device_select_queue(
-      device, IREE_HAL_COMMAND_CATEGORY_DISPATCH, queue_affinity);
+      device, command_categories, queue_affinity);
   iree_hal_submission_batch_t batch = {
       /*.wait_semaphores=*/wait_semaphore_list,
       /*.command_buffer_count=*/command_buffer_count,
@@ -1346,7 +1579,7 @@ const iree_hal_device_vtable_t iree_hal_vulkan_device_vtable = {
     /*.create_semaphore=*/iree_hal_vulkan_device_create_semaphore,
     /*.query_semaphore_compatibility=*/
     iree_hal_vulkan_device_query_semaphore_compatibility,
-    /*.transfer_range=*/iree_hal_device_submit_transfer_range_and_wait,
+    /*.transfer_range=*/iree_hal_vulkan_device_transfer_range,
     /*.queue_alloca=*/iree_hal_vulkan_device_queue_alloca,
     /*.queue_dealloca=*/iree_hal_vulkan_device_queue_dealloca,
     /*.queue_execute=*/iree_hal_vulkan_device_queue_execute,
@@ -66,10 +66,48 @@ IREE_API_EXPORT iree_status_t iree_hal_fence_create_at(
   return status;
 }
 
-// TODO(benvanik): actually join efficiently. Today we just create a fence that
-// can hold the worst-case sum of all fence timepoints and then insert but it
-// could be made much better. In most cases the joined fences have a near
-// perfect overlap of semaphores and we are wasting memory.
+// Returns true if |list| contains a timepoint on |semaphore| at or after
+// |value|.
+static bool iree_hal_semaphore_list_covers(iree_hal_semaphore_list_t list,
+                                           iree_hal_semaphore_t* semaphore,
+                                           uint64_t value) {
+  for (iree_host_size_t i = 0; i < list.count; ++i) {
+    if (list.semaphores[i] == semaphore) {
+      return list.payload_values[i] >= value;
+    }
+  }
+  return false;
+}
+
+// Returns true if |list| contains a timepoint on |semaphore| at any value.
+static bool iree_hal_semaphore_list_contains(iree_hal_semaphore_list_t list,
+                                             iree_hal_semaphore_t* semaphore) {
+  for (iree_host_size_t i = 0; i < list.count; ++i) {
+    if (list.semaphores[i] == semaphore) return true;
+  }
+  return false;
+}
+
+// Returns true if reaching |fence| implies all |fences| have been reached.
+static bool iree_hal_fence_dominates(iree_hal_fence_t* fence,
+                                     iree_host_size_t fence_count,
+                                     iree_hal_fence_t** fences) {
+  iree_hal_semaphore_list_t list = iree_hal_fence_semaphore_list(fence);
+  for (iree_host_size_t i = 0; i < fence_count; ++i) {
+    if (!fences[i] || fences[i] == fence) continue;
+    iree_hal_semaphore_list_t other_list =
+        iree_hal_fence_semaphore_list(fences[i]);
+    if (other_list.count > list.count) return false;
+    for (iree_host_size_t j = 0; j < other_list.count; ++j) {
+      if (!iree_hal_semaphore_list_covers(list, other_list.semaphores[j],
+                                          other_list.payload_values[j])) {
+        return false;
+      }
+    }
+  }
+  return true;
+}
+
 IREE_API_EXPORT iree_status_t iree_hal_fence_join(
     iree_host_size_t fence_count, iree_hal_fence_t** fences,
     iree_allocator_t host_allocator, iree_hal_fence_t** out_fence) {
@@ -77,24 +115,52 @@ IREE_API_EXPORT iree_status_t iree_hal_fence_join(
   *out_fence = NULL;
   IREE_TRACE_ZONE_BEGIN(z0);
 
-  // Find the maximum required timepoint capacity.
-  iree_host_size_t total_count = 0;
+  // Programs join fences that usually overlap almost entirely (or are the
+  // same fence or empty) so first try to find one that covers all others and
+  // return it without allocating.
+  iree_host_size_t nonempty_count = 0;
   for (iree_host_size_t i = 0; i < fence_count; ++i) {
-    if (fences[i]) total_count += fences[i]->count;
+    if (iree_hal_fence_timepoint_count(fences[i]) > 0) ++nonempty_count;
   }
 
   // Empty list -> NULL.
-  if (!total_count) {
+  if (!nonempty_count) {
     IREE_TRACE_ZONE_END(z0);
-    return NULL;
+    return iree_ok_status();
+  }
+
+  for (iree_host_size_t i = 0; i < fence_count; ++i) {
+    if (!iree_hal_fence_timepoint_count(fences[i])) continue;
+    if (iree_hal_fence_dominates(fences[i], fence_count, fences)) {
+      iree_hal_fence_retain(fences[i]);
+      *out_fence = fences[i];
+      IREE_TRACE_ZONE_END(z0);
+      return iree_ok_status();
+    }
+  }
+
+  // Count the unique semaphores so the joined fence is sized exactly. Each
+  // fence only contains a semaphore once so a timepoint is unique if no prior
+  // fence contains its semaphore.
+  iree_host_size_t unique_count = 0;
+  for (iree_host_size_t i = 0; i < fence_count; ++i) {
+    iree_hal_semaphore_list_t list = iree_hal_fence_semaphore_list(fences[i]);
+    for (iree_host_size_t j = 0; j < list.count; ++j) {
+      bool is_unique = true;
+      for (iree_host_size_t k = 0; k < i && is_unique; ++k) {
+        is_unique = !iree_hal_semaphore_list_contains(
+            iree_hal_fence_semaphore_list(fences[k]), list.semaphores[j]);
+      }
+      if (is_unique) ++unique_count;
+    }
   }
+  IREE_TRACE_ZONE_APPEND_VALUE(z0, (int64_t)unique_count);
 
-  // Create the fence with the maximum capacity.
   iree_hal_fence_t* fence = NULL;
   IREE_RETURN_AND_END_ZONE_IF_ERROR(
-      z0, iree_hal_fence_create(total_count, host_allocator, &fence));
+      z0, iree_hal_fence_create(unique_count, host_allocator, &fence));
 
-  // Insert all timepoints from all fences.
+  // Insert all timepoints from all fences; duplicates take the max value.
   iree_status_t status = iree_ok_status();
   for (iree_host_size_t i = 0; i < fence_count; ++i) {
     iree_hal_semaphore_list_t source_list =
@@ -268,7 +334,10 @@ iree_status_t iree_hal_fence_wait_source_ctl(iree_wait_source_t wait_source,
     case IREE_WAIT_SOURCE_COMMAND_EXPORT: {
       const iree_wait_primitive_type_t target_type =
           ((const iree_wait_source_export_params_t*)params)->target_type;
-      // TODO(benvanik): support exporting fences to real wait handles.
+      // Fences may contain any number of timepoints and a single system
+      // handle cannot represent a wait-all without a thread to join them.
+      // Callers can export each timepoint with
+      // iree_hal_semaphore_export_timepoint and wait on all of them instead.
       iree_wait_primitive_t* out_wait_primitive =
           (iree_wait_primitive_t*)inout_ptr;
       memset(out_wait_primitive, 0, sizeof(*out_wait_primitive));
@@ -56,7 +56,12 @@ IREE_API_EXPORT iree_status_t iree_hal_fence_create_at(
     iree_hal_semaphore_t* semaphore, uint64_t value,
     iree_allocator_t host_allocator, iree_hal_fence_t** out_fence);
 
-// Creates a new fence joining all |fences| as a wait-all operation.
+// Joins all |fences| as a wait-all operation and returns the result in
+// |out_fence|. Each semaphore is included once at the maximum value of all its
+// timepoints. If one of |fences| already covers all others it is retained and
+// returned instead of creating a new fence: callers must not insert into the
+// result if they don't want to modify the inputs. NULL fences are ignored and
+// |out_fence| is NULL if there are no timepoints.
 IREE_API_EXPORT iree_status_t iree_hal_fence_join(
     iree_host_size_t fence_count, iree_hal_fence_t** fences,
     iree_allocator_t host_allocator, iree_hal_fence_t** out_fence);
@@ -0,0 +1,144 @@
+// Copyright 2023 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include "iree/hal/fence.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <initializer_list>
+#include <utility>
+
+#include "iree/base/api.h"
+#include "iree/hal/api.h"
+#include "iree/testing/gtest.h"
+#include "iree/testing/status_matchers.h"
+
+namespace iree {
+namespace hal {
+namespace {
+
+// Semaphore that only tracks its lifetime; fence joins never touch payloads.
+typedef struct iree_hal_test_semaphore_t {
+  iree_hal_resource_t resource;
+  int* live_count;
+} iree_hal_test_semaphore_t;
+
+static void iree_hal_test_semaphore_destroy(iree_hal_semaphore_t* semaphore) {
+  iree_hal_test_semaphore_t* test_semaphore =
+      (iree_hal_test_semaphore_t*)semaphore;
+  --*test_semaphore->live_count;
+  iree_allocator_free(iree_allocator_system(), test_semaphore);
+}
+
+static iree_hal_semaphore_vtable_t iree_hal_test_semaphore_vtable() {
+  iree_hal_semaphore_vtable_t vtable = {};
+  vtable.destroy = iree_hal_test_semaphore_destroy;
+  return vtable;
+}
+
+class FenceJoinTest : public ::testing::Test {
+ protected:
+  void SetUp() override { vtable_ = iree_hal_test_semaphore_vtable(); }
+
+  void TearDown() override { EXPECT_EQ(live_count_, 0); }
+
+  iree_hal_semaphore_t* CreateSemaphore() {
+    iree_hal_test_semaphore_t* semaphore = NULL;
+    IREE_CHECK_OK(iree_allocator_malloc(
+        iree_allocator_system(), sizeof(*semaphore), (void**)&semaphore));
+    iree_hal_resource_initialize(&vtable_, &semaphore->resource);
+    semaphore->live_count = &live_count_;
+    ++live_count_;
+    return (iree_hal_semaphore_t*)semaphore;
+  }
+
+  iree_hal_fence_t* CreateFence(
+      std::initializer_list<std::pair<iree_hal_semaphore_t*, uint64_t>>
+          timepoints) {
+    iree_hal_fence_t* fence = NULL;
+    IREE_CHECK_OK(iree_hal_fence_create(timepoints.size(),
+                                        iree_allocator_system(), &fence));
+    for (auto& timepoint : timepoints) {
+      IREE_CHECK_OK(
+          iree_hal_fence_insert(fence, timepoint.first, timepoint.second));
+    }
+    return fence;
+  }
+
+  static uint64_t ValueOf(iree_hal_fence_t* fence,
+                          iree_hal_semaphore_t* semaphore) {
+    iree_hal_semaphore_list_t list = iree_hal_fence_semaphore_list(fence);
+    for (iree_host_size_t i = 0; i < list.count; ++i) {
+      if (list.semaphores[i] == semaphore) return list.payload_values[i];
+    }
+    return 0;
+  }
+
+  iree_hal_semaphore_vtable_t vtable_;
+  int live_count_ = 0;
+};
+
+TEST_F(FenceJoinTest, EmptyJoinIsNull) {
+  iree_hal_fence_t* empty = CreateFence({});
+  iree_hal_fence_t* fences[] = {NULL, empty};
+  iree_hal_fence_t* joined = NULL;
+  IREE_ASSERT_OK(iree_hal_fence_join(IREE_ARRAYSIZE(fences), fences,
+                                     iree_allocator_system(), &joined));
+  EXPECT_EQ(joined, nullptr);
+  iree_hal_fence_release(empty);
+}
+
+// A fence covering all others is returned as-is.
+TEST_F(FenceJoinTest, ReturnsDominatingFence) {
+  iree_hal_semaphore_t* a = CreateSemaphore();
+  iree_hal_semaphore_t* b = CreateSemaphore();
+  iree_hal_fence_t* fence0 = CreateFence({{a, 1}});
+  iree_hal_fence_t* fence1 = CreateFence({{a, 2}, {b, 3}});
+  iree_hal_fence_t* fences[] = {fence0, NULL, fence1, fence0};
+  iree_hal_fence_t* joined = NULL;
+  IREE_ASSERT_OK(iree_hal_fence_join(IREE_ARRAYSIZE(fences), fences,
+                                     iree_allocator_system(), &joined));
+  EXPECT_EQ(joined, fence1);
+  iree_hal_fence_release(joined);
+  iree_hal_fence_release(fence0);
+  iree_hal_fence_release(fence1);
+  iree_hal_semaphore_release(a);
+  iree_hal_semaphore_release(b);
+}
+
+// Overlapping fences are merged with one timepoint per semaphore at the max
+// of all values.
+TEST_F(FenceJoinTest, MergesOverlappingFences) {
+  iree_hal_semaphore_t* a = CreateSemaphore();
+  iree_hal_semaphore_t* b = CreateSemaphore();
+  iree_hal_semaphore_t* c = CreateSemaphore();
+  iree_hal_fence_t* fence0 = CreateFence({{a, 4}, {b, 1}});
+  iree_hal_fence_t* fence1 = CreateFence({{a, 2}, {b, 5}});
+  iree_hal_fence_t* fence2 = CreateFence({{c, 7}, {a, 3}});
+  iree_hal_fence_t* fences[] = {fence0, fence1, fence2};
+  iree_hal_fence_t* joined = NULL;
+  IREE_ASSERT_OK(iree_hal_fence_join(IREE_ARRAYSIZE(fences), fences,
+                                     iree_allocator_system(), &joined));
+  ASSERT_NE(joined, nullptr);
+  EXPECT_NE(joined, fence0);
+  EXPECT_NE(joined, fence1);
+  EXPECT_NE(joined, fence2);
+  EXPECT_EQ(iree_hal_fence_timepoint_count(joined), 3);
+  EXPECT_EQ(ValueOf(joined, a), 4);
+  EXPECT_EQ(ValueOf(joined, b), 5);
+  EXPECT_EQ(ValueOf(joined, c), 7);
+  iree_hal_fence_release(joined);
+  iree_hal_fence_release(fence0);
+  iree_hal_fence_release(fence1);
+  iree_hal_fence_release(fence2);
+  iree_hal_semaphore_release(a);
+  iree_hal_semaphore_release(b);
+  iree_hal_semaphore_release(c);
+}
+
+}  // namespace
+}  // namespace hal
+}  // namespace iree
@@ -31,8 +31,33 @@ typedef struct iree_elf_relocation_state_t {
   // PT_DYNAMIC table.
   iree_host_size_t dyn_table_count;
   const iree_elf_dyn_t* dyn_table;
+
+  // Resolved addresses of each entry in the .dynsym table used by
+  // symbol-relative relocations. Symbols defined in the module resolve to their
+  // loaded address and imported symbols to the host-provided address.
+  iree_host_size_t symbol_count;
+  const iree_elf_addr_t* symbol_addrs;
 } iree_elf_relocation_state_t;
 
+// Returns the resolved address of the .dynsym entry |symbol_index| referenced
+// by a relocation. Index 0 is STN_UNDEF and resolves to 0.
+static inline iree_status_t iree_elf_relocation_state_lookup_symbol(
+    const iree_elf_relocation_state_t* state, iree_host_size_t symbol_index,
+    iree_elf_addr_t* out_addr) {
+  if (symbol_index == 0) {
+    *out_addr = 0;
+    return iree_ok_status();
+  }
+  if (IREE_UNLIKELY(symbol_index >= state->symbol_count)) {
+    return iree_make_status(IREE_STATUS_OUT_OF_RANGE,
+                            "relocation references symbol %zu but the module "
+                            "only has %zu symbols",
+                            symbol_index, state->symbol_count);
+  }
+  *out_addr = state->symbol_addrs[symbol_index];
+  return iree_ok_status();
+}
+
 // Applies architecture-specific relocations.
 iree_status_t iree_elf_arch_apply_relocations(
     iree_elf_relocation_state_t* state);
@@ -48,12 +48,9 @@ static iree_status_t iree_elf_arch_riscv_apply_rela(
     uint32_t type = IREE_ELF_R_TYPE(rela->r_info);
     if (type == 0) continue;
 
-    // TODO(benvanik): support imports by resolving from the import table.
     iree_elf_addr_t sym_addr = 0;
-    if (IREE_ELF_R_SYM(rela->r_info) != 0) {
-      return iree_make_status(IREE_STATUS_UNIMPLEMENTED,
-                              "symbol-relative relocations not implemented");
-    }
+    IREE_RETURN_IF_ERROR(iree_elf_relocation_state_lookup_symbol(
+        state, IREE_ELF_R_SYM(rela->r_info), &sym_addr));
 
     iree_elf_addr_t instr_ptr =
         (iree_elf_addr_t)state->vaddr_bias + rela->r_offset;
@@ -86,12 +83,9 @@ static iree_status_t iree_elf_arch_riscv_apply_rela(
     uint32_t type = IREE_ELF_R_TYPE(rela->r_info);
     if (type == 0) continue;
 
-    // TODO(benvanik): support imports by resolving from the import table.
     iree_elf_addr_t sym_addr = 0;
-    if (IREE_ELF_R_SYM(rela->r_info) != 0) {
-      return iree_make_status(IREE_STATUS_UNIMPLEMENTED,
-                              "symbol-relative relocations not implemented");
-    }
+    IREE_RETURN_IF_ERROR(iree_elf_relocation_state_lookup_symbol(
+        state, IREE_ELF_R_SYM(rela->r_info), &sym_addr));
 
     iree_elf_addr_t instr_ptr =
         (iree_elf_addr_t)state->vaddr_bias + rela->r_offset;
@@ -31,6 +31,9 @@ typedef struct iree_elf_module_load_state_t {
   iree_elf_addr_t init;               // DT_INIT
   const iree_elf_addr_t* init_array;  // DT_INIT_ARRAY
   iree_host_size_t init_array_count;  // DT_INIT_ARRAYSZ
+
+  // Resolved address of each .dynsym entry; dynsym_count entries.
+  iree_elf_addr_t* symbol_addrs;
 } iree_elf_module_load_state_t;
 
 // Verifies the ELF file header and machine class.
@@ -466,22 +469,63 @@ static iree_status_t iree_elf_module_parse_dynamic_tables(
   return iree_ok_status();
 }
 
-// Verifies that there are no dynamic imports in the module as we don't support
-// them yet.
-static iree_status_t iree_elf_module_verify_no_imports(
-    iree_elf_module_load_state_t* load_state, iree_elf_module_t* module) {
+// Returns the host address of |symbol_name| in |import_table| or NULL if the
+// table does not provide it.
+static void* iree_elf_import_table_lookup(
+    const iree_elf_import_table_t* import_table, const char* symbol_name) {
+  if (!import_table) return NULL;
+  for (iree_host_size_t i = 0; i < import_table->import_count; ++i) {
+    if (strcmp(import_table->imports[i].sym_name, symbol_name) == 0) {
+      return import_table->imports[i].thunk_ptr;
+    }
+  }
+  return NULL;
+}
+
+// Resolves the address of every .dynsym entry for use by symbol-relative
+// relocations. Symbols defined in the module resolve to their loaded address
+// and undefined symbols are imported from |import_table|. Strong imports that
+// are not present in the table fail loading while weak ones resolve to 0.
+static iree_status_t iree_elf_module_resolve_symbols(
+    iree_elf_module_load_state_t* load_state,
+    const iree_elf_import_table_t* import_table, iree_elf_module_t* module) {
+  IREE_RETURN_IF_ERROR(iree_allocator_malloc(
+      module->host_allocator,
+      module->dynsym_count * sizeof(*load_state->symbol_addrs),
+      (void**)&load_state->symbol_addrs));
+
   // NOTE: slot 0 is always the 0 placeholder.
+  load_state->symbol_addrs[0] = 0;
   for (iree_host_size_t i = 1; i < module->dynsym_count; ++i) {
     const iree_elf_sym_t* sym = &module->dynsym[i];
-    if (sym->st_shndx == IREE_ELF_SHN_UNDEF) {
-      const char* symname IREE_ATTRIBUTE_UNUSED =
-          sym->st_name ? module->dynstr + sym->st_name : NULL;
+    if (sym->st_shndx == IREE_ELF_SHN_ABS) {
+      load_state->symbol_addrs[i] = sym->st_value;
+      continue;
+    } else if (sym->st_shndx != IREE_ELF_SHN_UNDEF) {
+      load_state->symbol_addrs[i] =
+          (iree_elf_addr_t)(module->vaddr_bias + sym->st_value);
+      continue;
+    }
+
+    const char* symname = sym->st_name ? module->dynstr + sym->st_name : "";
+    void* import_ptr = iree_elf_import_table_lookup(import_table, symname);
+#if defined(IREE_PLATFORM_WINDOWS) && defined(IREE_ARCH_X86_64)
+    // The ELF uses the SysV calling convention and host functions use the
+    // Windows one; calls would need per-import thunks to marshal arguments.
+    if (import_ptr) {
+      return iree_make_status(IREE_STATUS_UNIMPLEMENTED,
+                              "ELF imports symbol '%s' but direct imports are "
+                              "not supported with the Windows x64 ABI",
+                              symname);
+    }
+#endif  // IREE_PLATFORM_WINDOWS && IREE_ARCH_X86_64
+    if (!import_ptr && IREE_ELF_ST_BIND(sym->st_info) != IREE_ELF_STB_WEAK) {
       return iree_make_status(IREE_STATUS_UNAVAILABLE,
-                              "ELF imports one or more symbols (trying "
-                              "'%s'); imports are not supported in the "
-                              "platform-agnostic loader",
+                              "ELF imports symbol '%s' that is not present in "
+                              "the host import table",
                               symname);
     }
+    load_state->symbol_addrs[i] = (iree_elf_addr_t)import_ptr;
   }
   return iree_ok_status();
 }
@@ -499,6 +543,8 @@ static iree_status_t iree_elf_module_apply_relocations(
   reloc_state.vaddr_bias = module->vaddr_bias;
   reloc_state.dyn_table = load_state->dyn_table;
   reloc_state.dyn_table_count = load_state->dyn_table_count;
+  reloc_state.symbol_count = module->dynsym_count;
+  reloc_state.symbol_addrs = load_state->symbol_addrs;
   return iree_elf_arch_apply_relocations(&reloc_state);
 }
 
@@ -598,16 +644,18 @@ iree_status_t iree_elf_module_initialize_from_memory(
     status = iree_elf_module_parse_dynamic_tables(&load_state, out_module);
   }
 
-  // TODO(benvanik): imports would happen here. For now we just ensure there are
-  // no imports as otherwise things will fail with obscure messages later on.
+  // Resolve exported and imported symbols referenced by relocations.
   if (iree_status_is_ok(status)) {
-    status = iree_elf_module_verify_no_imports(&load_state, out_module);
+    status =
+        iree_elf_module_resolve_symbols(&load_state, import_table, out_module);
   }
 
   // Apply relocations to the loaded pages.
   if (iree_status_is_ok(status)) {
     status = iree_elf_module_apply_relocations(&load_state, out_module);
   }
+  iree_allocator_free(host_allocator, load_state.symbol_addrs);
+  load_state.symbol_addrs = NULL;
 
   // Apply final protections to the loaded pages now that relocations have been
   // performed.
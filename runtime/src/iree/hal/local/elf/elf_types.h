@@ -159,6 +159,8 @@ typedef struct {
 
 // An undefined, missing, irrelevant, or otherwise meaningless section ref.
 #define IREE_ELF_SHN_UNDEF 0
+// Symbol has an absolute value that is not affected by relocation.
+#define IREE_ELF_SHN_ABS 0xFFF1
 
 enum {
   IREE_ELF_SHT_NULL = 0,
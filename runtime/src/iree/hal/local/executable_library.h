@@ -348,7 +348,14 @@ typedef struct iree_hal_executable_workgroup_state_v0_t {
   // the requested amount.
   uint32_t local_memory_size;
 
-  // +4 trailing bytes of free space
+  // Number of consecutive workgroups to process starting at the workgroup ID
+  // above when the entry point declares
+  // IREE_HAL_EXECUTABLE_DISPATCH_FLAG_WORKGROUP_RANGE. Workgroups are ordered
+  // with x varying fastest and wrap at the workgroup counts provided in the
+  // dispatch state: a range starting at (count_x - 1, 0, 0) continues at
+  // (0, 1, 0). Ranges never extend beyond the end of the dispatch grid.
+  // Values of 0 are treated as 1. Ignored by all other entry points.
+  uint32_t workgroup_range_count;
 } iree_hal_executable_workgroup_state_v0_t;
 static_assert(
     sizeof(iree_hal_executable_workgroup_state_v0_t) <= 64,
@@ -358,6 +365,9 @@ static_assert(
 // The same |environment| is passed to all dispatches.
 // The same |dispatch_state| is passed to all workgroups within a dispatch.
 // A unique |workgroup_state| is passed to every workgroup within a dispatch.
+// Entry points declaring IREE_HAL_EXECUTABLE_DISPATCH_FLAG_WORKGROUP_RANGE
+// are instead passed a |workgroup_state| covering a contiguous range of
+// workgroups and process all of them in a single call.
 //
 // Returns 0 on success and non-zero on failure. Failures will cause device loss
 // and should only be used to communicate serious issues that should abort all
@@ -374,6 +384,28 @@ typedef int (*iree_hal_executable_dispatch_v0_t)(
 // This is chosen to match the common page size of devices.
 #define IREE_HAL_WORKGROUP_LOCAL_MEMORY_PAGE_SIZE 4096
 
+// Bitfield of flags controlling how a dispatch function is executed.
+enum iree_hal_executable_dispatch_flag_bits_v0_t {
+  IREE_HAL_EXECUTABLE_DISPATCH_FLAG_NONE = 0u,
+  // The dispatch function processes the
+  // iree_hal_executable_workgroup_state_v0_t::workgroup_range_count workgroups
+  // starting at the provided workgroup ID in a single call. Runtimes may use
+  // this to amortize the per-call overhead of dispatches with many small
+  // workgroups. Runtimes unaware of the flag call once per workgroup and leave
+  // the range count 0, which is processed as a single workgroup.
+  IREE_HAL_EXECUTABLE_DISPATCH_FLAG_WORKGROUP_RANGE = 1u << 0,
+  // The dispatch function requires denormal results of floating-point
+  // operations to be produced as-is. By default runtimes flush denormal
+  // results to zero (FTZ) to avoid the slow paths some ISAs take for them.
+  IREE_HAL_EXECUTABLE_DISPATCH_FLAG_PRESERVE_DENORMAL_RESULTS = 1u << 1,
+  // The dispatch function requires denormal inputs of floating-point
+  // operations to be used as-is. By default runtimes treat denormal inputs as
+  // zero (DAZ). Architectures controlling both with one mode preserve both if
+  // either flag is set.
+  IREE_HAL_EXECUTABLE_DISPATCH_FLAG_PRESERVE_DENORMAL_INPUTS = 1u << 2,
+};
+typedef uint16_t iree_hal_executable_dispatch_flags_v0_t;
+
 // Attributes for exported dispatch functions defining how they are to be
 // executed. 0 defaults are well-specified and the entire attributes table may
 // be omitted if no dispatch functions require these fields.
@@ -382,9 +414,9 @@ typedef struct iree_hal_executable_dispatch_attrs_v0_t {
   // indicating how much workgroup local memory is required for the dispatch.
   // This is the size of the buffer referenced by the `local_memory` argument.
   uint16_t local_memory_pages;
-  // Must be 0. May be used in the future for flags controlling the dispatch
-  // behavior/synchronization requirements.
-  uint16_t reserved;
+  // Bitfield of IREE_HAL_EXECUTABLE_DISPATCH_FLAG_* controlling the dispatch
+  // behavior. Unknown bits must be 0.
+  iree_hal_executable_dispatch_flags_v0_t flags;
 } iree_hal_executable_dispatch_attrs_v0_t;
 static_assert(sizeof(iree_hal_executable_dispatch_attrs_v0_t) == 4, "uint32_t");
 
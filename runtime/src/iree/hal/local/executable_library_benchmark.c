@@ -21,6 +21,14 @@
 #include "iree/hal/local/local_pipeline_layout.h"
 #include "iree/testing/benchmark.h"
 
+#if defined(IREE_PLATFORM_LINUX) || defined(IREE_PLATFORM_ANDROID)
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#define IREE_HAL_EXECUTABLE_LIBRARY_BENCHMARK_HAVE_PERF_EVENT 1
+#endif  // IREE_PLATFORM_LINUX || IREE_PLATFORM_ANDROID
+
 IREE_FLAG(string, executable_format, "",
           "Format of the executable file being loaded.");
 IREE_FLAG(string, executable_file, "",
@@ -49,6 +57,25 @@ IREE_FLAG(int32_t, workgroup_size_z, 1,
 IREE_FLAG(int32_t, max_concurrency, 1,
           "Maximum available concurrency exposed to the dispatch.");
 
+IREE_FLAG(bool, perf_counters, false,
+          "Samples hardware performance counters (cycles, instructions,\n"
+          "cache and branch misses) around the dispatches and reports them\n"
+          "per dispatch. Requires Linux perf_event support and a permissive\n"
+          "/proc/sys/kernel/perf_event_paranoid.");
+IREE_FLAG(int64_t, flops_per_dispatch, 0,
+          "Floating-point operations performed by one dispatch of the entry\n"
+          "point (such as 2*M*N*K for a matmul). Used to report GFLOP/s and\n"
+          "arithmetic intensity; not reported when 0.");
+IREE_FLAG(int64_t, bytes_per_dispatch, 0,
+          "Bytes of memory traffic of one dispatch used to compute arithmetic\n"
+          "intensity. Defaults to the total size of all bindings when 0.");
+IREE_FLAG(double, peak_gflops, 0.0,
+          "Peak GFLOP/s of the machine used to report the fraction of the\n"
+          "roofline achieved; requires --flops_per_dispatch.");
+IREE_FLAG(double, peak_memory_bandwidth, 0.0,
+          "Peak memory bandwidth of the machine in GB/s used with\n"
+          "--peak_gflops to compute the roofline.");
+
 // Total number of bindings we (currently) allow any executable to have.
 #define IREE_HAL_LOCAL_MAX_TOTAL_BINDING_COUNT \
   (IREE_HAL_LOCAL_MAX_DESCRIPTOR_SET_COUNT *   \
@@ -130,6 +157,229 @@ IREE_FLAG_CALLBACK(
     "  # 2 4-byte floating-point values with contents [[1.4], [2.1]]:\n"
     "  --binding=2x1xf32=1.4,2.1");
 
+//===----------------------------------------------------------------------===//
+// Hardware performance counters
+//===----------------------------------------------------------------------===//
+
+typedef enum iree_perf_counter_e {
+  IREE_PERF_COUNTER_CYCLES = 0,
+  IREE_PERF_COUNTER_INSTRUCTIONS,
+  IREE_PERF_COUNTER_L1D_READ_MISSES,
+  IREE_PERF_COUNTER_LLC_READ_MISSES,
+  IREE_PERF_COUNTER_BRANCH_MISSES,
+  IREE_PERF_COUNTER_COUNT,
+} iree_perf_counter_t;
+
+static const char* iree_perf_counter_names[IREE_PERF_COUNTER_COUNT] = {
+    [IREE_PERF_COUNTER_CYCLES] = "cycles",
+    [IREE_PERF_COUNTER_INSTRUCTIONS] = "instructions",
+    [IREE_PERF_COUNTER_L1D_READ_MISSES] = "l1d_misses",
+    [IREE_PERF_COUNTER_LLC_READ_MISSES] = "llc_misses",
+    [IREE_PERF_COUNTER_BRANCH_MISSES] = "branch_misses",
+};
+
+// A set of counters measuring the calling thread.
+// Counters not supported by the CPU or kernel are left closed and skipped.
+typedef struct iree_perf_counters_t {
+  int fds[IREE_PERF_COUNTER_COUNT];
+} iree_perf_counters_t;
+
+#if defined(IREE_HAL_EXECUTABLE_LIBRARY_BENCHMARK_HAVE_PERF_EVENT)
+
+static const struct {
+  uint32_t type;
+  uint64_t config;
+} iree_perf_counter_events[IREE_PERF_COUNTER_COUNT] = {
+    [IREE_PERF_COUNTER_CYCLES] = {PERF_TYPE_HARDWARE,
+                                  PERF_COUNT_HW_CPU_CYCLES},
+    [IREE_PERF_COUNTER_INSTRUCTIONS] = {PERF_TYPE_HARDWARE,
+                                        PERF_COUNT_HW_INSTRUCTIONS},
+    [IREE_PERF_COUNTER_L1D_READ_MISSES] =
+        {PERF_TYPE_HW_CACHE, PERF_COUNT_HW_CACHE_L1D |
+                                 (PERF_COUNT_HW_CACHE_OP_READ << 8) |
+                                 (PERF_COUNT_HW_CACHE_RESULT_MISS << 16)},
+    [IREE_PERF_COUNTER_LLC_READ_MISSES] =
+        {PERF_TYPE_HW_CACHE, PERF_COUNT_HW_CACHE_LL |
+                                 (PERF_COUNT_HW_CACHE_OP_READ << 8) |
+                                 (PERF_COUNT_HW_CACHE_RESULT_MISS << 16)},
+    [IREE_PERF_COUNTER_BRANCH_MISSES] = {PERF_TYPE_HARDWARE,
+                                         PERF_COUNT_HW_BRANCH_MISSES},
+};
+
+static iree_status_t iree_perf_counters_open(iree_perf_counters_t* counters) {
+  bool any_opened = false;
+  for (int i = 0; i < IREE_PERF_COUNTER_COUNT; ++i) {
+    struct perf_event_attr attr;
+    memset(&attr, 0, sizeof(attr));
+    attr.size = sizeof(attr);
+    attr.type = iree_perf_counter_events[i].type;
+    attr.config = iree_perf_counter_events[i].config;
+    attr.disabled = 1;
+    // User-space only so that the default perf_event_paranoid level works;
+    // dispatches do not enter the kernel anyway.
+    attr.exclude_kernel = 1;
+    attr.exclude_hv = 1;
+    // Counters are multiplexed when there are more than the PMU has available
+    // and the times are used to scale the counts.
+    attr.read_format =
+        PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+    counters->fds[i] = (int)syscall(SYS_perf_event_open, &attr, /*pid=*/0,
+                                    /*cpu=*/-1, /*group_fd=*/-1, /*flags=*/0);
+    any_opened |= counters->fds[i] >= 0;
+  }
+  if (!any_opened) {
+    return iree_make_status(IREE_STATUS_UNAVAILABLE,
+                            "no hardware performance counters could be opened; "
+                            "check /proc/sys/kernel/perf_event_paranoid");
+  }
+  return iree_ok_status();
+}
+
+static void iree_perf_counters_close(iree_perf_counters_t* counters) {
+  for (int i = 0; i < IREE_PERF_COUNTER_COUNT; ++i) {
+    if (counters->fds[i] >= 0) close(counters->fds[i]);
+    counters->fds[i] = -1;
+  }
+}
+
+static void iree_perf_counters_enable(iree_perf_counters_t* counters) {
+  for (int i = 0; i < IREE_PERF_COUNTER_COUNT; ++i) {
+    if (counters->fds[i] < 0) continue;
+    ioctl(counters->fds[i], PERF_EVENT_IOC_RESET, 0);
+    ioctl(counters->fds[i], PERF_EVENT_IOC_ENABLE, 0);
+  }
+}
+
+static void iree_perf_counters_disable(iree_perf_counters_t* counters) {
+  for (int i = 0; i < IREE_PERF_COUNTER_COUNT; ++i) {
+    if (counters->fds[i] < 0) continue;
+    ioctl(counters->fds[i], PERF_EVENT_IOC_DISABLE, 0);
+  }
+}
+
+// Reads the scaled value of |counter| or returns false if it is unavailable.
+static bool iree_perf_counters_read(iree_perf_counters_t* counters,
+                                    iree_perf_counter_t counter,
+                                    double* out_value) {
+  *out_value = 0.0;
+  if (counters->fds[counter] < 0) return false;
+  uint64_t values[3] = {0, 0, 0};  // value, time_enabled, time_running
+  if (read(counters->fds[counter], values, sizeof(values)) != sizeof(values)) {
+    return false;
+  }
+  if (values[2] == 0) return false;  // never scheduled on the PMU
+  *out_value = (double)values[0] * ((double)values[1] / (double)values[2]);
+  return true;
+}
+
+#else
+
+static iree_status_t iree_perf_counters_open(iree_perf_counters_t* counters) {
+  for (int i = 0; i < IREE_PERF_COUNTER_COUNT; ++i) counters->fds[i] = -1;
+  return iree_make_status(IREE_STATUS_UNAVAILABLE,
+                          "hardware performance counters are only supported "
+                          "on Linux and Android");
+}
+
+static void iree_perf_counters_close(iree_perf_counters_t* counters) {}
+
+static void iree_perf_counters_enable(iree_perf_counters_t* counters) {}
+
+static void iree_perf_counters_disable(iree_perf_counters_t* counters) {}
+
+static bool iree_perf_counters_read(iree_perf_counters_t* counters,
+                                    iree_perf_counter_t counter,
+                                    double* out_value) {
+  *out_value = 0.0;
+  return false;
+}
+
+#endif  // IREE_HAL_EXECUTABLE_LIBRARY_BENCHMARK_HAVE_PERF_EVENT
+
+// Reports the counters in |counters| accumulated over |dispatch_count|
+// dispatches as per-dispatch values along with derived ratios.
+static void iree_perf_counters_report(iree_perf_counters_t* counters,
+                                      int64_t dispatch_count,
+                                      iree_benchmark_state_t* benchmark_state) {
+  if (dispatch_count <= 0) return;
+  double values[IREE_PERF_COUNTER_COUNT];
+  bool available[IREE_PERF_COUNTER_COUNT];
+  for (int i = 0; i < IREE_PERF_COUNTER_COUNT; ++i) {
+    available[i] =
+        iree_perf_counters_read(counters, (iree_perf_counter_t)i, &values[i]);
+    if (available[i]) {
+      iree_benchmark_set_counter(benchmark_state, iree_perf_counter_names[i],
+                                 values[i] / dispatch_count,
+                                 IREE_BENCHMARK_COUNTER_FLAG_NONE);
+    }
+  }
+  if (available[IREE_PERF_COUNTER_CYCLES] &&
+      available[IREE_PERF_COUNTER_INSTRUCTIONS] &&
+      values[IREE_PERF_COUNTER_CYCLES] > 0) {
+    iree_benchmark_set_counter(benchmark_state, "ipc",
+                               values[IREE_PERF_COUNTER_INSTRUCTIONS] /
+                                   values[IREE_PERF_COUNTER_CYCLES],
+                               IREE_BENCHMARK_COUNTER_FLAG_NONE);
+  }
+  // Misses per thousand instructions make cache behavior comparable across
+  // kernels of different sizes.
+  if (available[IREE_PERF_COUNTER_INSTRUCTIONS] &&
+      values[IREE_PERF_COUNTER_INSTRUCTIONS] > 0) {
+    static const struct {
+      iree_perf_counter_t counter;
+      const char* name;
+    } mpki_counters[] = {
+        {IREE_PERF_COUNTER_L1D_READ_MISSES, "l1d_mpki"},
+        {IREE_PERF_COUNTER_LLC_READ_MISSES, "llc_mpki"},
+        {IREE_PERF_COUNTER_BRANCH_MISSES, "branch_mpki"},
+    };
+    for (iree_host_size_t i = 0; i < IREE_ARRAYSIZE(mpki_counters); ++i) {
+      if (!available[mpki_counters[i].counter]) continue;
+      iree_benchmark_set_counter(
+          benchmark_state, mpki_counters[i].name,
+          values[mpki_counters[i].counter] * 1000.0 /
+              values[IREE_PERF_COUNTER_INSTRUCTIONS],
+          IREE_BENCHMARK_COUNTER_FLAG_NONE);
+    }
+  }
+}
+
+// Reports the achieved GFLOP/s, arithmetic intensity, and fraction of the
+// roofline achieved when the user has provided the required flags.
+static void iree_hal_executable_library_report_roofline(
+    int64_t dispatch_count, iree_time_t duration_ns,
+    iree_host_size_t total_binding_length,
+    iree_benchmark_state_t* benchmark_state) {
+  if (FLAG_flops_per_dispatch <= 0 || dispatch_count <= 0 || duration_ns <= 0) {
+    return;
+  }
+  double total_flops = (double)FLAG_flops_per_dispatch * dispatch_count;
+  double gflops = total_flops / (double)duration_ns;
+  iree_benchmark_set_counter(benchmark_state, "gflops", gflops,
+                             IREE_BENCHMARK_COUNTER_FLAG_NONE);
+
+  double bytes_per_dispatch = FLAG_bytes_per_dispatch > 0
+                                  ? (double)FLAG_bytes_per_dispatch
+                                  : (double)total_binding_length;
+  if (bytes_per_dispatch <= 0) return;
+  double arithmetic_intensity =
+      (double)FLAG_flops_per_dispatch / bytes_per_dispatch;
+  iree_benchmark_set_counter(benchmark_state, "flops_per_byte",
+                             arithmetic_intensity,
+                             IREE_BENCHMARK_COUNTER_FLAG_NONE);
+
+  if (FLAG_peak_gflops <= 0.0) return;
+  double attainable_gflops = FLAG_peak_gflops;
+  if (FLAG_peak_memory_bandwidth > 0.0) {
+    attainable_gflops =
+        iree_min(attainable_gflops,
+                 arithmetic_intensity * FLAG_peak_memory_bandwidth);
+  }
+  iree_benchmark_set_counter(benchmark_state, "roofline_fraction",
+                             gflops / attainable_gflops,
+                             IREE_BENCHMARK_COUNTER_FLAG_NONE);
+}
+
 // NOTE: error handling is here just for better diagnostics: it is not tracking
 // allocations correctly and will leak. Don't use this as an example for how to
 // write robust code.
@@ -202,6 +452,7 @@ static iree_status_t iree_hal_executable_library_run(
   iree_hal_buffer_view_t* buffer_views[IREE_HAL_LOCAL_MAX_TOTAL_BINDING_COUNT];
   void* binding_ptrs[IREE_HAL_LOCAL_MAX_TOTAL_BINDING_COUNT];
   size_t binding_lengths[IREE_HAL_LOCAL_MAX_TOTAL_BINDING_COUNT];
+  iree_host_size_t total_binding_length = 0;
   for (iree_host_size_t i = 0; i < dispatch_params.binding_count; ++i) {
     IREE_RETURN_IF_ERROR(iree_hal_buffer_view_parse(
         dispatch_params.bindings[i], heap_allocator, &buffer_views[i]));
@@ -215,6 +466,7 @@ static iree_status_t iree_hal_executable_library_run(
         buffer_length, &buffer_mapping));
     binding_ptrs[i] = buffer_mapping.contents.data;
     binding_lengths[i] = (size_t)buffer_mapping.contents.data_length;
+    total_binding_length += binding_lengths[i];
   }
 
   // Setup dispatch state.
@@ -238,12 +490,29 @@ static iree_status_t iree_hal_executable_library_run(
   // we are testing the memory access patterns: if we just ran the same single
   // tile processing the same exact region of memory over and over we are not
   // testing cache effects.
+  //
+  // Counters measure only the calling thread as that is the only one
+  // dispatches are issued on.
+  iree_perf_counters_t perf_counters;
+  if (FLAG_perf_counters) {
+    IREE_RETURN_IF_ERROR(iree_perf_counters_open(&perf_counters));
+    iree_perf_counters_enable(&perf_counters);
+  }
   int64_t dispatch_count = 0;
+  iree_time_t start_time_ns = iree_time_now();
   while (iree_benchmark_keep_running(benchmark_state, /*batch_count=*/1)) {
     IREE_RETURN_IF_ERROR(iree_hal_local_executable_issue_dispatch_inline(
         local_executable, FLAG_entry_point, &dispatch_state, 0, local_memory));
     ++dispatch_count;
   }
+  iree_time_t duration_ns = iree_time_now() - start_time_ns;
+  if (FLAG_perf_counters) {
+    iree_perf_counters_disable(&perf_counters);
+    iree_perf_counters_report(&perf_counters, dispatch_count, benchmark_state);
+    iree_perf_counters_close(&perf_counters);
+  }
+  iree_hal_executable_library_report_roofline(
+      dispatch_count, duration_ns, total_binding_length, benchmark_state);
 
   // To get a total time per invocation we set the item count to the total
   // invocations dispatched. That gives us both total dispatch and single
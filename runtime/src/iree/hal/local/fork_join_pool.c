@@ -0,0 +1,265 @@
+// Copyright 2023 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include "iree/hal/local/fork_join_pool.h"
+
+#include <stddef.h>
+#include <string.h>
+
+#include "iree/base/internal/atomics.h"
+#include "iree/base/internal/synchronization.h"
+#include "iree/base/internal/threading.h"
+#include "iree/base/tracing.h"
+
+// Duration helper threads and the joining caller spin before sleeping.
+// Dispatches issued back-to-back from the same queue usually arrive within
+// this window and avoid a full sleep/wake round trip through the OS.
+#define IREE_HAL_FORK_JOIN_POOL_SPIN_NS (50 * 1000)
+
+typedef struct iree_hal_fork_join_pool_worker_t {
+  iree_hal_fork_join_pool_t* pool;
+  uint32_t worker_id;
+  // Epoch of the last job the worker observed; only touched by the worker.
+  int32_t observed_epoch;
+  // Result of the last job run by the worker. Read by the caller after join.
+  iree_status_t status;
+  iree_thread_t* thread;
+} iree_hal_fork_join_pool_worker_t;
+
+struct iree_hal_fork_join_pool_t {
+  iree_atomic_ref_count_t ref_count;
+  iree_allocator_t host_allocator;
+  iree_host_size_t worker_count;
+
+  // Serializes runs issued from multiple threads.
+  iree_slim_mutex_t run_mutex;
+
+  // The current job. Written under |run_mutex| before |epoch| is advanced
+  // with release semantics and read by helpers after observing the advance.
+  iree_hal_fork_join_fn_t fn;
+  void* user_data;
+
+  // Advanced once per job (and once more on exit) to wake helpers.
+  iree_atomic_int32_t epoch;
+  // Set when helpers should exit instead of running a job.
+  iree_atomic_int32_t exit_requested;
+  // Number of helpers that have not yet finished the current job.
+  iree_atomic_int32_t pending_count;
+
+  // Posted when |epoch| advances.
+  iree_notification_t fork_notification;
+  // Posted when |pending_count| reaches zero.
+  iree_notification_t join_notification;
+
+  // Helper workers 1 to worker_count - 1; index 0 is unused.
+  iree_hal_fork_join_pool_worker_t workers[];
+};
+
+// Waits on |notification| until |condition_fn| returns true, spinning briefly
+// before each sleep.
+static void iree_hal_fork_join_pool_await(iree_notification_t* notification,
+                                          iree_condition_fn_t condition_fn,
+                                          void* condition_arg) {
+  while (!condition_fn(condition_arg)) {
+    iree_wait_token_t wait_token = iree_notification_prepare_wait(notification);
+    if (condition_fn(condition_arg)) {
+      iree_notification_cancel_wait(notification);
+      break;
+    }
+    iree_notification_commit_wait(notification, wait_token,
+                                  IREE_HAL_FORK_JOIN_POOL_SPIN_NS,
+                                  IREE_TIME_INFINITE_FUTURE);
+  }
+}
+
+#if defined(IREE_PLATFORM_GENERIC) || IREE_SYNCHRONIZATION_DISABLE_UNSAFE
+
+static iree_status_t iree_hal_fork_join_pool_create_helpers(
+    iree_hal_fork_join_pool_t* pool) {
+  return iree_make_status(IREE_STATUS_UNAVAILABLE,
+                          "threads are not available on this platform; only "
+                          "a single worker is supported");
+}
+
+static void iree_hal_fork_join_pool_join_helpers(
+    iree_hal_fork_join_pool_t* pool) {}
+
+#else
+
+static bool iree_hal_fork_join_pool_has_new_epoch(void* arg) {
+  iree_hal_fork_join_pool_worker_t* worker =
+      (iree_hal_fork_join_pool_worker_t*)arg;
+  return iree_atomic_load_int32(&worker->pool->epoch,
+                                iree_memory_order_acquire) !=
+         worker->observed_epoch;
+}
+
+static int iree_hal_fork_join_pool_worker_main(void* entry_arg) {
+  iree_hal_fork_join_pool_worker_t* worker =
+      (iree_hal_fork_join_pool_worker_t*)entry_arg;
+  iree_hal_fork_join_pool_t* pool = worker->pool;
+  for (;;) {
+    iree_hal_fork_join_pool_await(&pool->fork_notification,
+                                  iree_hal_fork_join_pool_has_new_epoch,
+                                  worker);
+    worker->observed_epoch =
+        iree_atomic_load_int32(&pool->epoch, iree_memory_order_acquire);
+    if (iree_atomic_load_int32(&pool->exit_requested,
+                               iree_memory_order_acquire)) {
+      break;
+    }
+
+    worker->status = pool->fn(pool->user_data, worker->worker_id);
+
+    if (iree_atomic_fetch_sub_int32(&pool->pending_count, 1,
+                                    iree_memory_order_acq_rel) == 1) {
+      iree_notification_post(&pool->join_notification, IREE_ALL_WAITERS);
+    }
+  }
+  return 0;
+}
+
+static iree_status_t iree_hal_fork_join_pool_create_helpers(
+    iree_hal_fork_join_pool_t* pool) {
+  iree_thread_create_params_t params;
+  memset(&params, 0, sizeof(params));
+  params.name = IREE_SV("iree-fork-join");
+  for (iree_host_size_t i = 1; i < pool->worker_count; ++i) {
+    iree_hal_fork_join_pool_worker_t* worker = &pool->workers[i];
+    worker->pool = pool;
+    worker->worker_id = (uint32_t)i;
+    IREE_RETURN_IF_ERROR(iree_thread_create(
+        iree_hal_fork_join_pool_worker_main, worker, params,
+        pool->host_allocator, &worker->thread));
+  }
+  return iree_ok_status();
+}
+
+static void iree_hal_fork_join_pool_join_helpers(
+    iree_hal_fork_join_pool_t* pool) {
+  iree_atomic_store_int32(&pool->exit_requested, 1, iree_memory_order_release);
+  iree_atomic_fetch_add_int32(&pool->epoch, 1, iree_memory_order_acq_rel);
+  iree_notification_post(&pool->fork_notification, IREE_ALL_WAITERS);
+  for (iree_host_size_t i = 1; i < pool->worker_count; ++i) {
+    // Releasing the last reference joins the thread.
+    iree_thread_release(pool->workers[i].thread);
+    pool->workers[i].thread = NULL;
+  }
+}
+
+#endif  // IREE_PLATFORM_GENERIC || IREE_SYNCHRONIZATION_DISABLE_UNSAFE
+
+static void iree_hal_fork_join_pool_destroy(iree_hal_fork_join_pool_t* pool) {
+  IREE_TRACE_ZONE_BEGIN(z0);
+  iree_hal_fork_join_pool_join_helpers(pool);
+  iree_notification_deinitialize(&pool->join_notification);
+  iree_notification_deinitialize(&pool->fork_notification);
+  iree_slim_mutex_deinitialize(&pool->run_mutex);
+  iree_allocator_free(pool->host_allocator, pool);
+  IREE_TRACE_ZONE_END(z0);
+}
+
+iree_status_t iree_hal_fork_join_pool_create(
+    iree_host_size_t worker_count, iree_allocator_t host_allocator,
+    iree_hal_fork_join_pool_t** out_pool) {
+  IREE_ASSERT_ARGUMENT(out_pool);
+  *out_pool = NULL;
+  if (worker_count < 1 ||
+      worker_count > IREE_HAL_FORK_JOIN_POOL_MAX_WORKER_COUNT) {
+    return iree_make_status(IREE_STATUS_INVALID_ARGUMENT,
+                            "worker count %" PRIhsz " out of range [1, %d]",
+                            worker_count,
+                            IREE_HAL_FORK_JOIN_POOL_MAX_WORKER_COUNT);
+  }
+  IREE_TRACE_ZONE_BEGIN(z0);
+  IREE_TRACE_ZONE_APPEND_VALUE(z0, (int64_t)worker_count);
+
+  iree_hal_fork_join_pool_t* pool = NULL;
+  iree_host_size_t total_size =
+      sizeof(*pool) + worker_count * sizeof(pool->workers[0]);
+  IREE_RETURN_AND_END_ZONE_IF_ERROR(
+      z0, iree_allocator_malloc(host_allocator, total_size, (void**)&pool));
+  memset(pool, 0, total_size);
+  iree_atomic_ref_count_init(&pool->ref_count);
+  pool->host_allocator = host_allocator;
+  pool->worker_count = 1;
+  iree_slim_mutex_initialize(&pool->run_mutex);
+  iree_notification_initialize(&pool->fork_notification);
+  iree_notification_initialize(&pool->join_notification);
+
+  iree_status_t status = iree_ok_status();
+  if (worker_count > 1) {
+    // Only helpers that were created get joined if creation fails midway.
+    pool->worker_count = worker_count;
+    status = iree_hal_fork_join_pool_create_helpers(pool);
+  }
+
+  if (iree_status_is_ok(status)) {
+    *out_pool = pool;
+  } else {
+    iree_hal_fork_join_pool_release(pool);
+  }
+  IREE_TRACE_ZONE_END(z0);
+  return status;
+}
+
+void iree_hal_fork_join_pool_retain(iree_hal_fork_join_pool_t* pool) {
+  if (IREE_LIKELY(pool)) {
+    iree_atomic_ref_count_inc(&pool->ref_count);
+  }
+}
+
+void iree_hal_fork_join_pool_release(iree_hal_fork_join_pool_t* pool) {
+  if (IREE_LIKELY(pool) && iree_atomic_ref_count_dec(&pool->ref_count) == 1) {
+    iree_hal_fork_join_pool_destroy(pool);
+  }
+}
+
+iree_host_size_t iree_hal_fork_join_pool_worker_count(
+    iree_hal_fork_join_pool_t* pool) {
+  return pool->worker_count;
+}
+
+static bool iree_hal_fork_join_pool_is_joined(void* arg) {
+  iree_hal_fork_join_pool_t* pool = (iree_hal_fork_join_pool_t*)arg;
+  return iree_atomic_load_int32(&pool->pending_count,
+                                iree_memory_order_acquire) == 0;
+}
+
+iree_status_t iree_hal_fork_join_pool_run(iree_hal_fork_join_pool_t* pool,
+                                          iree_hal_fork_join_fn_t fn,
+                                          void* user_data) {
+  IREE_ASSERT_ARGUMENT(pool);
+  IREE_ASSERT_ARGUMENT(fn);
+  if (pool->worker_count == 1) return fn(user_data, /*worker_id=*/0);
+  IREE_TRACE_ZONE_BEGIN(z0);
+
+  iree_slim_mutex_lock(&pool->run_mutex);
+
+  // Fork: publish the job and wake all helpers.
+  pool->fn = fn;
+  pool->user_data = user_data;
+  iree_atomic_store_int32(&pool->pending_count, (int32_t)pool->worker_count - 1,
+                          iree_memory_order_relaxed);
+  iree_atomic_fetch_add_int32(&pool->epoch, 1, iree_memory_order_acq_rel);
+  iree_notification_post(&pool->fork_notification, IREE_ALL_WAITERS);
+
+  // The caller participates as worker 0.
+  iree_status_t status = fn(user_data, /*worker_id=*/0);
+
+  // Join: wait for all helpers and gather their results.
+  iree_hal_fork_join_pool_await(&pool->join_notification,
+                                iree_hal_fork_join_pool_is_joined, pool);
+  for (iree_host_size_t i = 1; i < pool->worker_count; ++i) {
+    status = iree_status_join(status, pool->workers[i].status);
+    pool->workers[i].status = iree_ok_status();
+  }
+
+  iree_slim_mutex_unlock(&pool->run_mutex);
+
+  IREE_TRACE_ZONE_END(z0);
+  return status;
+}
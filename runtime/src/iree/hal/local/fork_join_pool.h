@@ -0,0 +1,67 @@
+// Copyright 2023 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#ifndef IREE_HAL_LOCAL_FORK_JOIN_POOL_H_
+#define IREE_HAL_LOCAL_FORK_JOIN_POOL_H_
+
+#include "iree/base/api.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif  // __cplusplus
+
+// Maximum number of workers (including the calling thread) in a pool.
+#define IREE_HAL_FORK_JOIN_POOL_MAX_WORKER_COUNT 64
+
+// Function run by every worker of a pool. |worker_id| is in
+// [0, worker_count) and 0 is always the thread that called
+// iree_hal_fork_join_pool_run.
+typedef iree_status_t (*iree_hal_fork_join_fn_t)(void* user_data,
+                                                 uint32_t worker_id);
+
+// A minimal fork-join pool for running one data-parallel job at a time.
+//
+// Unlike the task system there is no queueing, dependency tracking, or work
+// stealing: a run wakes all helper threads, executes the job on every worker
+// (including the caller), and returns once all have finished. Jobs are
+// expected to distribute their own work across workers (usually by claiming
+// chunks from a shared atomic counter). This keeps the overhead of a fork and
+// join to a wake-up and a counter decrement so that it can be used for each
+// dispatch of an otherwise synchronous and in-order queue.
+//
+// Thread-safe. Concurrent runs from multiple threads are serialized.
+typedef struct iree_hal_fork_join_pool_t iree_hal_fork_join_pool_t;
+
+// Creates a pool with |worker_count| workers. The calling thread of each run
+// is worker 0 and |worker_count| - 1 helper threads are created.
+// Returns IREE_STATUS_UNAVAILABLE if threads are not supported on the platform
+// and |worker_count| is greater than 1.
+iree_status_t iree_hal_fork_join_pool_create(
+    iree_host_size_t worker_count, iree_allocator_t host_allocator,
+    iree_hal_fork_join_pool_t** out_pool);
+
+// Retains the given |pool| for the caller.
+void iree_hal_fork_join_pool_retain(iree_hal_fork_join_pool_t* pool);
+
+// Releases the given |pool| from the caller. Helper threads are joined when
+// the last reference is released.
+void iree_hal_fork_join_pool_release(iree_hal_fork_join_pool_t* pool);
+
+// Returns the total number of workers including the calling thread.
+iree_host_size_t iree_hal_fork_join_pool_worker_count(
+    iree_hal_fork_join_pool_t* pool);
+
+// Runs |fn| on all workers of |pool| and blocks until they have all returned.
+// Returns the joined failures of all workers, if any.
+iree_status_t iree_hal_fork_join_pool_run(iree_hal_fork_join_pool_t* pool,
+                                          iree_hal_fork_join_fn_t fn,
+                                          void* user_data);
+
+#ifdef __cplusplus
+}  // extern "C"
+#endif  // __cplusplus
+
+#endif  // IREE_HAL_LOCAL_FORK_JOIN_POOL_H_
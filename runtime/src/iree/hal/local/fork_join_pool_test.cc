@@ -0,0 +1,96 @@
+// Copyright 2023 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include "iree/hal/local/fork_join_pool.h"
+
+#include <atomic>
+#include <cstdint>
+#include <vector>
+
+#include "iree/testing/gtest.h"
+#include "iree/testing/status_matchers.h"
+
+namespace {
+
+using iree::Status;
+using iree::StatusCode;
+using iree::testing::status::StatusIs;
+
+// Tests that pools can be created and destroyed repeatedly without running
+// any jobs.
+TEST(ForkJoinPoolTest, Lifetime) {
+  for (iree_host_size_t worker_count : {1, 2, 4}) {
+    iree_hal_fork_join_pool_t* pool = NULL;
+    IREE_ASSERT_OK(iree_hal_fork_join_pool_create(
+        worker_count, iree_allocator_system(), &pool));
+    EXPECT_EQ(iree_hal_fork_join_pool_worker_count(pool), worker_count);
+    iree_hal_fork_join_pool_release(pool);
+  }
+}
+
+TEST(ForkJoinPoolTest, InvalidWorkerCount) {
+  iree_hal_fork_join_pool_t* pool = NULL;
+  EXPECT_THAT(Status(iree_hal_fork_join_pool_create(
+                  0, iree_allocator_system(), &pool)),
+              StatusIs(StatusCode::kInvalidArgument));
+  EXPECT_EQ(pool, nullptr);
+}
+
+// Tests that every worker runs each job exactly once with a unique ID and that
+// all have finished by the time the run returns.
+TEST(ForkJoinPoolTest, RunsAllWorkers) {
+  static constexpr iree_host_size_t kWorkerCount = 4;
+  iree_hal_fork_join_pool_t* pool = NULL;
+  IREE_ASSERT_OK(iree_hal_fork_join_pool_create(
+      kWorkerCount, iree_allocator_system(), &pool));
+
+  std::vector<std::atomic<int>> counts(kWorkerCount);
+  for (int run = 1; run <= 100; ++run) {
+    IREE_ASSERT_OK(iree_hal_fork_join_pool_run(
+        pool,
+        +[](void* user_data, uint32_t worker_id) -> iree_status_t {
+          auto* counts =
+              reinterpret_cast<std::vector<std::atomic<int>>*>(user_data);
+          ++(*counts)[worker_id];
+          return iree_ok_status();
+        },
+        &counts));
+    for (iree_host_size_t i = 0; i < kWorkerCount; ++i) {
+      EXPECT_EQ(counts[i].load(), run);
+    }
+  }
+
+  iree_hal_fork_join_pool_release(pool);
+}
+
+// Tests that failures from helper workers are returned from the run and that
+// the pool remains usable afterward.
+TEST(ForkJoinPoolTest, PropagatesWorkerFailures) {
+  iree_hal_fork_join_pool_t* pool = NULL;
+  IREE_ASSERT_OK(
+      iree_hal_fork_join_pool_create(3, iree_allocator_system(), &pool));
+
+  auto fail_on_last_worker = +[](void* user_data,
+                                 uint32_t worker_id) -> iree_status_t {
+    if (worker_id == 2) {
+      return iree_make_status(IREE_STATUS_DATA_LOSS, "worker failure");
+    }
+    return iree_ok_status();
+  };
+  EXPECT_THAT(
+      Status(iree_hal_fork_join_pool_run(pool, fail_on_last_worker, NULL)),
+      StatusIs(StatusCode::kDataLoss));
+  IREE_EXPECT_OK(iree_hal_fork_join_pool_run(
+      pool,
+      +[](void* user_data, uint32_t worker_id) -> iree_status_t {
+        return iree_ok_status();
+      },
+      NULL));
+
+  iree_hal_fork_join_pool_release(pool);
+}
+
+}  // namespace
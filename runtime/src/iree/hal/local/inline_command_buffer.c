@@ -11,6 +11,7 @@
 #include <string.h>
 
 #include "iree/base/api.h"
+#include "iree/base/internal/atomics.h"
 #include "iree/base/internal/cpu.h"
 #include "iree/base/internal/fpu_state.h"
 #include "iree/base/internal/math.h"
@@ -23,11 +24,31 @@
 // iree_hal_inline_command_buffer_t
 //===----------------------------------------------------------------------===//
 
+// Number of chunks of workgroups each worker claims on average when a dispatch
+// is distributed across a fork-join pool. More chunks balance uneven
+// workgroups better at the cost of more atomic claims and range calls.
+#define IREE_HAL_INLINE_DISPATCH_CHUNKS_PER_WORKER 4
+
+// Buffer range a descriptor set binding was mapped from.
+typedef struct iree_hal_inline_binding_source_t {
+  iree_hal_buffer_t* buffer;
+  iree_device_size_t offset;
+  iree_device_size_t length;
+} iree_hal_inline_binding_source_t;
+
 // Inline synchronous one-shot command "buffer".
 typedef struct iree_hal_inline_command_buffer_t {
   iree_hal_command_buffer_t base;
   iree_allocator_t host_allocator;
 
+  // Optional pool dispatches are distributed across; retained.
+  iree_hal_fork_join_pool_t* fork_join_pool;
+
+  // Workgroup local memory reused across dispatches and grown to the largest
+  // size requested during recording. Released when recording ends. When
+  // dispatching across a fork-join pool each worker has its own slice.
+  iree_byte_span_t local_memory;
+
   struct {
     // A flattened list of all available descriptor set bindings.
     // As descriptor sets are pushed/bound the bindings will be updated to
@@ -40,6 +61,14 @@ typedef struct iree_hal_inline_command_buffer_t {
     size_t full_binding_lengths[IREE_HAL_LOCAL_MAX_DESCRIPTOR_SET_COUNT *
                                 IREE_HAL_LOCAL_MAX_DESCRIPTOR_BINDING_COUNT];
 
+    // The buffer range each full binding was mapped from. Pushing the same
+    // range again reuses the mapped pointer instead of remapping the buffer.
+    // Buffers are retained so that their identity can't be reused by a new
+    // allocation while cached and are released on replacement or reset.
+    iree_hal_inline_binding_source_t
+        full_binding_sources[IREE_HAL_LOCAL_MAX_DESCRIPTOR_SET_COUNT *
+                             IREE_HAL_LOCAL_MAX_DESCRIPTOR_BINDING_COUNT];
+
     // Packed bindings scratch space used during dispatch. Executable bindings
     // are packed into a dense list with unused bindings removed.
     void* packed_bindings[IREE_HAL_LOCAL_MAX_DESCRIPTOR_SET_COUNT *
@@ -75,6 +104,11 @@ static iree_hal_inline_command_buffer_t* iree_hal_inline_command_buffer_cast(
 
 static void iree_hal_inline_command_buffer_reset(
     iree_hal_inline_command_buffer_t* command_buffer) {
+  for (iree_host_size_t i = 0;
+       i < IREE_ARRAYSIZE(command_buffer->state.full_binding_sources); ++i) {
+    iree_hal_buffer_release(
+        command_buffer->state.full_binding_sources[i].buffer);
+  }
   memset(&command_buffer->state, 0, sizeof(command_buffer->state));
 
   // Setup the cached dispatch state pointers that don't change.
@@ -94,8 +128,8 @@ iree_status_t iree_hal_inline_command_buffer_initialize(
     iree_hal_device_t* device, iree_hal_command_buffer_mode_t mode,
     iree_hal_command_category_t command_categories,
     iree_hal_queue_affinity_t queue_affinity, iree_host_size_t binding_capacity,
-    iree_allocator_t host_allocator, iree_byte_span_t storage,
-    iree_hal_command_buffer_t** out_command_buffer) {
+    iree_hal_fork_join_pool_t* fork_join_pool, iree_allocator_t host_allocator,
+    iree_byte_span_t storage, iree_hal_command_buffer_t** out_command_buffer) {
   IREE_ASSERT_ARGUMENT(out_command_buffer);
   *out_command_buffer = NULL;
 
@@ -131,6 +165,8 @@ iree_status_t iree_hal_inline_command_buffer_initialize(
       device, mode, command_categories, queue_affinity, binding_capacity,
       &iree_hal_inline_command_buffer_vtable, &command_buffer->base);
   command_buffer->host_allocator = host_allocator;
+  command_buffer->fork_join_pool = fork_join_pool;
+  iree_hal_fork_join_pool_retain(fork_join_pool);
   iree_hal_inline_command_buffer_reset(command_buffer);
 
   *out_command_buffer = &command_buffer->base;
@@ -139,18 +175,29 @@ iree_status_t iree_hal_inline_command_buffer_initialize(
   return iree_ok_status();
 }
 
+// Releases the workgroup local memory scratch reservation, if any.
+static void iree_hal_inline_command_buffer_release_local_memory(
+    iree_hal_inline_command_buffer_t* command_buffer) {
+  iree_allocator_free(command_buffer->host_allocator,
+                      command_buffer->local_memory.data);
+  command_buffer->local_memory = iree_make_byte_span(NULL, 0);
+}
+
 void iree_hal_inline_command_buffer_deinitialize(
     iree_hal_command_buffer_t* base_command_buffer) {
   iree_hal_inline_command_buffer_t* command_buffer =
       iree_hal_inline_command_buffer_cast(base_command_buffer);
   iree_hal_inline_command_buffer_reset(command_buffer);
+  iree_hal_inline_command_buffer_release_local_memory(command_buffer);
+  iree_hal_fork_join_pool_release(command_buffer->fork_join_pool);
+  command_buffer->fork_join_pool = NULL;
 }
 
 iree_status_t iree_hal_inline_command_buffer_create(
     iree_hal_device_t* device, iree_hal_command_buffer_mode_t mode,
     iree_hal_command_category_t command_categories,
     iree_hal_queue_affinity_t queue_affinity, iree_host_size_t binding_capacity,
-    iree_allocator_t host_allocator,
+    iree_hal_fork_join_pool_t* fork_join_pool, iree_allocator_t host_allocator,
     iree_hal_command_buffer_t** out_command_buffer) {
   IREE_ASSERT_ARGUMENT(out_command_buffer);
   *out_command_buffer = NULL;
@@ -163,7 +210,7 @@ iree_status_t iree_hal_inline_command_buffer_create(
   if (iree_status_is_ok(status)) {
     status = iree_hal_inline_command_buffer_initialize(
         device, mode, command_categories, queue_affinity, binding_capacity,
-        host_allocator,
+        fork_join_pool, host_allocator,
         iree_make_byte_span(storage, iree_hal_inline_command_buffer_size()),
         &command_buffer);
   }
@@ -233,6 +280,7 @@ static iree_status_t iree_hal_inline_command_buffer_end(
   iree_hal_inline_command_buffer_t* command_buffer =
       iree_hal_inline_command_buffer_cast(base_command_buffer);
   iree_hal_inline_command_buffer_reset(command_buffer);
+  iree_hal_inline_command_buffer_release_local_memory(command_buffer);
   return iree_ok_status();
 }
 
@@ -424,6 +472,16 @@ static iree_status_t iree_hal_inline_command_buffer_push_descriptor_set(
     }
     iree_host_size_t binding_ordinal = binding_base + bindings[i].binding;
 
+    // Skip remapping if the binding is unchanged since it was last pushed as
+    // is common when the same set is pushed for a sequence of dispatches.
+    iree_hal_inline_binding_source_t* source =
+        &command_buffer->state.full_binding_sources[binding_ordinal];
+    if (bindings[i].buffer && bindings[i].buffer == source->buffer &&
+        bindings[i].offset == source->offset &&
+        bindings[i].length == source->length) {
+      continue;
+    }
+
     // TODO(benvanik): track mapping so we can properly map/unmap/flush/etc.
     iree_hal_buffer_mapping_t buffer_mapping = {{0}};
     if (bindings[i].buffer) {
@@ -436,6 +494,12 @@ static iree_status_t iree_hal_inline_command_buffer_push_descriptor_set(
         buffer_mapping.contents.data;
     command_buffer->state.full_binding_lengths[binding_ordinal] =
         buffer_mapping.contents.data_length;
+
+    iree_hal_buffer_retain(bindings[i].buffer);
+    iree_hal_buffer_release(source->buffer);
+    source->buffer = bindings[i].buffer;
+    source->offset = bindings[i].offset;
+    source->length = bindings[i].length;
   }
 
   return iree_ok_status();
@@ -445,6 +509,76 @@ static iree_status_t iree_hal_inline_command_buffer_push_descriptor_set(
 // iree_hal_command_buffer_dispatch
 //===----------------------------------------------------------------------===//
 
+// A dispatch distributed across the workers of a fork-join pool.
+// Workers claim chunks of consecutive workgroups (x varying fastest) until the
+// grid is exhausted.
+typedef struct iree_hal_inline_parallel_dispatch_t {
+  iree_hal_local_executable_t* executable;
+  iree_host_size_t ordinal;
+  const iree_hal_executable_dispatch_state_v0_t* dispatch_state;
+  // Processor the calling thread (worker 0) is running on.
+  uint32_t caller_processor_id;
+  // FPU state the executable requires.
+  iree_fpu_state_flags_t fpu_state_flags;
+  // Local memory of worker N starts at |local_memory_base| + N * stride.
+  // NULL if the dispatch requires no local memory.
+  uint8_t* local_memory_base;
+  iree_host_size_t local_memory_stride;
+  iree_host_size_t local_memory_size;
+  // Total workgroups in the grid and the number claimed at a time.
+  uint32_t workgroup_count;
+  uint32_t chunk_size;
+  // Flattened index of the next unclaimed workgroup.
+  iree_atomic_int64_t next_workgroup;
+} iree_hal_inline_parallel_dispatch_t;
+
+static iree_status_t iree_hal_inline_parallel_dispatch_worker(
+    void* user_data, uint32_t worker_id) {
+  iree_hal_inline_parallel_dispatch_t* dispatch =
+      (iree_hal_inline_parallel_dispatch_t*)user_data;
+  const iree_hal_executable_dispatch_state_v0_t* dispatch_state =
+      dispatch->dispatch_state;
+
+  iree_alignas(64) iree_hal_executable_workgroup_state_v0_t workgroup_state = {
+      .processor_id = worker_id == 0 ? dispatch->caller_processor_id
+                                     : iree_cpu_query_processor_id(),
+      .local_memory = dispatch->local_memory_base
+                          ? dispatch->local_memory_base +
+                                worker_id * dispatch->local_memory_stride
+                          : NULL,
+      .local_memory_size = (size_t)dispatch->local_memory_size,
+  };
+
+  // Helper threads know nothing about the floating point state either.
+  iree_fpu_state_t fpu_state = iree_fpu_state_push(dispatch->fpu_state_flags);
+  iree_status_t status = iree_ok_status();
+  for (;;) {
+    int64_t begin = iree_atomic_fetch_add_int64(&dispatch->next_workgroup,
+                                                dispatch->chunk_size,
+                                                iree_memory_order_relaxed);
+    if (begin >= dispatch->workgroup_count) break;
+    uint32_t first = (uint32_t)begin;
+    uint32_t count =
+        iree_min(dispatch->chunk_size, dispatch->workgroup_count - first);
+    uint32_t yz = first / dispatch_state->workgroup_count_x;
+    workgroup_state.workgroup_id_x = first % dispatch_state->workgroup_count_x;
+    workgroup_state.workgroup_id_y = yz % dispatch_state->workgroup_count_y;
+    workgroup_state.workgroup_id_z = yz / dispatch_state->workgroup_count_y;
+    status = iree_hal_local_executable_issue_call_range(
+        dispatch->executable, dispatch->ordinal, dispatch_state,
+        &workgroup_state, count, worker_id);
+    if (!iree_status_is_ok(status)) {
+      // Stop other workers from claiming any more of the grid.
+      iree_atomic_store_int64(&dispatch->next_workgroup,
+                              dispatch->workgroup_count,
+                              iree_memory_order_relaxed);
+      break;
+    }
+  }
+  iree_fpu_state_pop(fpu_state);
+  return status;
+}
+
 static iree_status_t iree_hal_inline_command_buffer_dispatch(
     iree_hal_command_buffer_t* base_command_buffer,
     iree_hal_executable_t* executable, int32_t entry_point,
@@ -487,8 +621,20 @@ static iree_status_t iree_hal_inline_command_buffer_dispatch(
   dispatch_state->workgroup_count_y = workgroup_y;
   dispatch_state->workgroup_count_z = workgroup_z;
 
-  // Single-threaded.
-  dispatch_state->max_concurrency = 1;
+  // Workers are identified within [0, max_concurrency) regardless of whether
+  // this particular dispatch is distributed.
+  const iree_host_size_t worker_count =
+      command_buffer->fork_join_pool
+          ? iree_hal_fork_join_pool_worker_count(command_buffer->fork_join_pool)
+          : 1;
+  dispatch_state->max_concurrency = (uint32_t)worker_count;
+
+  // Only distribute grids with more than one workgroup; the flattened index
+  // must also fit in the range count passed to the executable.
+  const uint64_t total_workgroup_count =
+      (uint64_t)workgroup_x * workgroup_y * workgroup_z;
+  const bool is_parallel = worker_count > 1 && total_workgroup_count > 1 &&
+                           total_workgroup_count <= UINT32_MAX;
 
   // Push constants are pulled directly from the command buffer state, but we
   // only allow the dispatch to read what we know is initialized based on the
@@ -524,32 +670,62 @@ static iree_status_t iree_hal_inline_command_buffer_dispatch(
         command_buffer->state.full_binding_lengths[binding_ordinal];
   }
 
-  // TODO(benvanik): plumb through an arena or fixed-size reservation to use.
-  // For now when deploying to devices where you want something like the
-  // inline command buffer you probably don't want 256KB of transient memory
-  // getting allocated and retained implicitly - this should be a compiler
-  // option. For now we just malloc here to make things work and strongly
-  // encourage the kind of user who wants synchronous inline execution to not
-  // also want tons of scratch memory.
-  iree_byte_span_t local_memory = iree_make_byte_span(NULL, local_memory_size);
-  if (local_memory_size > 0) {
-    IREE_RETURN_IF_ERROR(iree_allocator_malloc(command_buffer->host_allocator,
-                                               local_memory_size,
-                                               (void**)&local_memory.data));
+  // NOTE: when deploying to devices where you want something like the inline
+  // command buffer you probably don't want 256KB of transient memory getting
+  // allocated and retained implicitly - this should be a compiler option. For
+  // now we keep a single reservation grown to the largest dispatch requirement
+  // so that sequences of dispatches don't malloc/free each time and release it
+  // when recording ends. Distributed dispatches need one slice per worker.
+  // Sizes are whole pages so slices stay page aligned relative to the base.
+  const iree_host_size_t required_local_memory_size =
+      is_parallel ? local_memory_size * worker_count : local_memory_size;
+  if (required_local_memory_size > command_buffer->local_memory.data_length) {
+    // Contents need not be preserved so avoid the realloc copy.
+    iree_hal_inline_command_buffer_release_local_memory(command_buffer);
+    IREE_RETURN_IF_ERROR(iree_allocator_malloc_uninitialized(
+        command_buffer->host_allocator, required_local_memory_size,
+        (void**)&command_buffer->local_memory.data));
+    command_buffer->local_memory.data_length = required_local_memory_size;
+  }
+
+  // Executables may declare that they need denormals preserved.
+  const iree_fpu_state_flags_t fpu_state_flags =
+      iree_hal_local_executable_fpu_state_flags(local_executable, entry_point);
+
+  if (is_parallel) {
+    iree_hal_inline_parallel_dispatch_t dispatch = {
+        .executable = local_executable,
+        .ordinal = entry_point,
+        .dispatch_state = dispatch_state,
+        .caller_processor_id = command_buffer->state.processor_id,
+        .fpu_state_flags = fpu_state_flags,
+        .local_memory_base =
+            local_memory_size ? command_buffer->local_memory.data : NULL,
+        .local_memory_stride = local_memory_size,
+        .local_memory_size = local_memory_size,
+        .workgroup_count = (uint32_t)total_workgroup_count,
+        .chunk_size = (uint32_t)iree_max(
+            1, total_workgroup_count /
+                   (worker_count * IREE_HAL_INLINE_DISPATCH_CHUNKS_PER_WORKER)),
+    };
+    iree_atomic_store_int64(&dispatch.next_workgroup, 0,
+                            iree_memory_order_relaxed);
+    return iree_hal_fork_join_pool_run(command_buffer->fork_join_pool,
+                                       iree_hal_inline_parallel_dispatch_worker,
+                                       &dispatch);
   }
 
+  iree_byte_span_t local_memory =
+      iree_make_byte_span(command_buffer->local_memory.data, local_memory_size);
+
   // Since we are running on a borrowed thread, we know nothing about the
   // floating point state. Reset it.
-  iree_fpu_state_t fpu_state =
-      iree_fpu_state_push(IREE_FPU_STATE_FLAG_FLUSH_DENORMALS_TO_ZERO);
+  iree_fpu_state_t fpu_state = iree_fpu_state_push(fpu_state_flags);
   iree_status_t status = iree_hal_local_executable_issue_dispatch_inline(
       local_executable, entry_point, dispatch_state,
       command_buffer->state.processor_id, local_memory);
   iree_fpu_state_pop(fpu_state);
 
-  if (local_memory.data) {
-    iree_allocator_free(command_buffer->host_allocator, local_memory.data);
-  }
   return status;
 }
 
@@ -9,6 +9,7 @@
 
 #include "iree/base/api.h"
 #include "iree/hal/api.h"
+#include "iree/hal/local/fork_join_pool.h"
 
 #ifdef __cplusplus
 extern "C" {
@@ -19,7 +20,7 @@ extern "C" {
 // iree_hal_inline_command_buffer_initialize/iree_hal_inline_command_buffer_deinitialize.
 iree_host_size_t iree_hal_inline_command_buffer_size(void);
 
-// Initializes an inline synchronous one-shot single-threaded command "buffer".
+// Initializes an inline synchronous one-shot command "buffer".
 // This is equivalent to iree_hal_inline_command_buffer_create but uses
 // caller-allocated |storage| (must be at least the capacity specified by
 // iree_hal_inline_command_buffer_size).
@@ -31,7 +32,8 @@ iree_status_t iree_hal_inline_command_buffer_initialize(
     iree_hal_device_t* device, iree_hal_command_buffer_mode_t mode,
     iree_hal_command_category_t command_categories,
     iree_hal_queue_affinity_t queue_affinity, iree_host_size_t binding_capacity,
-    iree_allocator_t host_allocator, iree_byte_span_t storage,
+    iree_hal_fork_join_pool_t* fork_join_pool, iree_allocator_t host_allocator,
+    iree_byte_span_t storage,
     iree_hal_command_buffer_t** out_command_buffer);
 
 // Deinitializes an inline command buffer previously initialized with
@@ -39,20 +41,24 @@ iree_status_t iree_hal_inline_command_buffer_initialize(
 void iree_hal_inline_command_buffer_deinitialize(
     iree_hal_command_buffer_t* command_buffer);
 
-// Creates an inline synchronous one-shot single-threaded command "buffer".
+// Creates an inline synchronous one-shot command "buffer".
 // This is designed for ultra-low latency situations where we know the command
 // buffer is going to be submitted with no wait semaphores indicating that it
 // can begin execution immediately. No inter-command-buffer scheduling will be
 // performed and all barriers and events are ignored.
 //
-// Executes all work on the calling thread synchronously (today).
+// Executes all work synchronously before each command returns. If the optional
+// |fork_join_pool| is provided the workgroups of each dispatch are distributed
+// across its workers (with the calling thread as worker 0) and otherwise all
+// work runs on the calling thread. The pool is retained for the lifetime of
+// the command buffer.
 //
 // Must have IREE_HAL_COMMAND_BUFFER_MODE_ALLOW_INLINE_EXECUTION set.
 iree_status_t iree_hal_inline_command_buffer_create(
     iree_hal_device_t* device, iree_hal_command_buffer_mode_t mode,
     iree_hal_command_category_t command_categories,
     iree_hal_queue_affinity_t queue_affinity, iree_host_size_t binding_capacity,
-    iree_allocator_t host_allocator,
+    iree_hal_fork_join_pool_t* fork_join_pool, iree_allocator_t host_allocator,
     iree_hal_command_buffer_t** out_command_buffer);
 
 // Returns true if |command_buffer| is an inline command buffer.
@@ -100,20 +100,23 @@ static iree_status_t iree_hal_elf_executable_resolve_imports(
   executable->base.environment.import_thunk =
       (iree_hal_executable_import_thunk_v0_t)iree_elf_thunk_i_ppp;
 
-  // Allocate storage for the imports.
-  // TODO(benvanik): allocate both as one block.
+  // Allocate storage for the imports as a single block with the contexts
+  // following the function pointers. Ownership of the block is tracked by
+  // import_funcs.
+  const iree_host_size_t import_funcs_size =
+      import_table->count * sizeof(*executable->base.environment.import_funcs);
+  const iree_host_size_t import_contexts_size =
+      import_table->count *
+      sizeof(*executable->base.environment.import_contexts);
+  uint8_t* import_storage = NULL;
   IREE_RETURN_AND_END_ZONE_IF_ERROR(
-      z0, iree_allocator_malloc(
-              executable->base.host_allocator,
-              import_table->count *
-                  sizeof(*executable->base.environment.import_funcs),
-              (void**)&executable->base.environment.import_funcs));
-  IREE_RETURN_AND_END_ZONE_IF_ERROR(
-      z0, iree_allocator_malloc(
-              executable->base.host_allocator,
-              import_table->count *
-                  sizeof(*executable->base.environment.import_contexts),
-              (void**)&executable->base.environment.import_contexts));
+      z0, iree_allocator_malloc(executable->base.host_allocator,
+                                import_funcs_size + import_contexts_size,
+                                (void**)&import_storage));
+  executable->base.environment.import_funcs =
+      (const iree_hal_executable_import_v0_t*)import_storage;
+  executable->base.environment.import_contexts =
+      (const void**)(import_storage + import_funcs_size);
 
   // Try to resolve each import.
   // NOTE: imports are sorted alphabetically and if we cared we could use this
@@ -135,6 +138,7 @@ static iree_status_t iree_hal_elf_executable_resolve_imports(
 static iree_status_t iree_hal_elf_executable_create(
     const iree_hal_executable_params_t* executable_params,
     const iree_hal_executable_import_provider_t import_provider,
+    const iree_elf_import_table_t* elf_import_table,
     iree_allocator_t host_allocator, iree_hal_executable_t** out_executable) {
   IREE_ASSERT_ARGUMENT(executable_params);
   IREE_ASSERT_ARGUMENT(executable_params->executable_data.data &&
@@ -179,8 +183,8 @@ static iree_status_t iree_hal_elf_executable_create(
   if (iree_status_is_ok(status)) {
     // Attempt to load the ELF module.
     status = iree_elf_module_initialize_from_memory(
-        executable_params->executable_data, /*import_table=*/NULL,
-        host_allocator, &executable->module);
+        executable_params->executable_data, elf_import_table, host_allocator,
+        &executable->module);
   }
   if (iree_status_is_ok(status)) {
     // Query metadata and get the entry point function pointers.
@@ -239,14 +243,11 @@ static void iree_hal_elf_executable_destroy(
 
   iree_elf_module_deinitialize(&executable->module);
 
+  // NOTE: import_contexts shares the import_funcs allocation.
   if (executable->base.environment.import_funcs != NULL) {
     iree_allocator_free(host_allocator,
                         (void*)executable->base.environment.import_funcs);
   }
-  if (executable->base.environment.import_contexts != NULL) {
-    iree_allocator_free(host_allocator,
-                        (void*)executable->base.environment.import_contexts);
-  }
 
   iree_hal_local_executable_deinitialize(
       (iree_hal_local_executable_t*)base_executable);
@@ -331,6 +332,9 @@ static const iree_hal_local_executable_vtable_t iree_hal_elf_executable_vtable =
 typedef struct iree_hal_embedded_elf_loader_t {
   iree_hal_executable_loader_t base;
   iree_allocator_t host_allocator;
+  // Symbols the ELF linker can resolve undefined symbols against. Zeroed when
+  // no table is provided.
+  iree_elf_import_table_t elf_import_table;
 } iree_hal_embedded_elf_loader_t;
 
 static const iree_hal_executable_loader_vtable_t
@@ -340,6 +344,16 @@ iree_status_t iree_hal_embedded_elf_loader_create(
     iree_hal_executable_import_provider_t import_provider,
     iree_allocator_t host_allocator,
     iree_hal_executable_loader_t** out_executable_loader) {
+  return iree_hal_embedded_elf_loader_create_with_imports(
+      import_provider, /*elf_import_table=*/NULL, host_allocator,
+      out_executable_loader);
+}
+
+iree_status_t iree_hal_embedded_elf_loader_create_with_imports(
+    iree_hal_executable_import_provider_t import_provider,
+    const iree_elf_import_table_t* elf_import_table,
+    iree_allocator_t host_allocator,
+    iree_hal_executable_loader_t** out_executable_loader) {
   IREE_ASSERT_ARGUMENT(out_executable_loader);
   *out_executable_loader = NULL;
   IREE_TRACE_ZONE_BEGIN(z0);
@@ -352,6 +366,9 @@ iree_status_t iree_hal_embedded_elf_loader_create(
                                           import_provider,
                                           &executable_loader->base);
     executable_loader->host_allocator = host_allocator;
+    if (elf_import_table) {
+      executable_loader->elf_import_table = *elf_import_table;
+    }
     *out_executable_loader = (iree_hal_executable_loader_t*)executable_loader;
   }
 
@@ -390,7 +407,22 @@ static iree_status_t iree_hal_embedded_elf_loader_try_load(
   // Perform the load of the ELF and wrap it in an executable handle.
   iree_status_t status = iree_hal_elf_executable_create(
       executable_params, base_executable_loader->import_provider,
-      executable_loader->host_allocator, out_executable);
+      &executable_loader->elf_import_table, executable_loader->host_allocator,
+      out_executable);
+
+  // Per-export statistics are only allocated if enabled when loading.
+  if (iree_status_is_ok(status)) {
+    iree_hal_elf_executable_t* executable =
+        (iree_hal_elf_executable_t*)*out_executable;
+    status = iree_hal_local_executable_initialize_statistics(
+        &executable->base, executable->identifier,
+        executable->library.v0->exports.count,
+        executable->library.v0->exports.names, worker_capacity);
+    if (!iree_status_is_ok(status)) {
+      iree_hal_executable_release(*out_executable);
+      *out_executable = NULL;
+    }
+  }
 
   IREE_TRACE_ZONE_END(z0);
   return status;
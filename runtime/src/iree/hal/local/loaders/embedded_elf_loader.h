@@ -11,6 +11,7 @@
 #include <stdint.h>
 
 #include "iree/base/api.h"
+#include "iree/hal/local/elf/elf_module.h"
 #include "iree/hal/local/executable_loader.h"
 
 #ifdef __cplusplus
@@ -26,6 +27,21 @@ iree_status_t iree_hal_embedded_elf_loader_create(
     iree_allocator_t host_allocator,
     iree_hal_executable_loader_t** out_executable_loader);
 
+// Creates an embedded ELF executable loader as with
+// iree_hal_embedded_elf_loader_create that additionally resolves undefined
+// symbols in loaded ELFs against |elf_import_table|. This lets executables
+// link against host-provided routines such as ukernels specialized for the
+// running CPU instead of carrying their own copies. Symbols are called with the
+// ELF calling convention and must be ABI compatible with it.
+//
+// |elf_import_table| and the symbol names it references must remain valid for
+// the lifetime of the loader.
+iree_status_t iree_hal_embedded_elf_loader_create_with_imports(
+    iree_hal_executable_import_provider_t import_provider,
+    const iree_elf_import_table_t* elf_import_table,
+    iree_allocator_t host_allocator,
+    iree_hal_executable_loader_t** out_executable_loader);
+
 #ifdef __cplusplus
 }  // extern "C"
 #endif  // __cplusplus
@@ -186,16 +186,80 @@ static const iree_hal_local_executable_vtable_t
 // iree_hal_static_library_loader_t
 //===----------------------------------------------------------------------===//
 
+typedef struct iree_hal_static_library_loader_entry_t {
+  // Name of the library as used by executables referencing it.
+  iree_string_view_t name;
+  // Query function used to resolve libraries registered lazily.
+  iree_hal_executable_library_query_fn_t query_fn;
+  // Library header resolved on loader creation or NULL if registered lazily.
+  const iree_hal_executable_library_header_t** header;
+} iree_hal_static_library_loader_entry_t;
+
 typedef struct iree_hal_static_library_loader_t {
   iree_hal_executable_loader_t base;
   iree_allocator_t host_allocator;
   iree_host_size_t library_count;
-  const iree_hal_executable_library_header_t** const libraries[];
+  iree_hal_static_library_loader_entry_t libraries[];
 } iree_hal_static_library_loader_t;
 
 static const iree_hal_executable_loader_vtable_t
     iree_hal_static_library_loader_vtable;
 
+// Queries the library header from |query_fn| and verifies that it matches our
+// expected version. It's rare it won't, however static libraries generated
+// with a newer version of the IREE compiler that are then linked with an older
+// version of the runtime are difficult to spot otherwise.
+static iree_status_t iree_hal_static_library_query(
+    iree_hal_executable_library_query_fn_t query_fn,
+    iree_allocator_t host_allocator,
+    const iree_hal_executable_library_header_t*** out_header) {
+  *out_header = NULL;
+
+  // Default environment to enable initialization.
+  iree_hal_executable_environment_v0_t environment;
+  iree_hal_executable_environment_initialize(host_allocator, &environment);
+
+  const iree_hal_executable_library_header_t** header_ptr =
+      (const iree_hal_executable_library_header_t**)query_fn(
+          IREE_HAL_EXECUTABLE_LIBRARY_VERSION_LATEST, &environment);
+  if (!header_ptr) {
+    return iree_make_status(
+        IREE_STATUS_UNAVAILABLE,
+        "failed to query library header for runtime version %d",
+        IREE_HAL_EXECUTABLE_LIBRARY_VERSION_LATEST);
+  }
+  const iree_hal_executable_library_header_t* header = *header_ptr;
+  if (header->version > IREE_HAL_EXECUTABLE_LIBRARY_VERSION_LATEST) {
+    return iree_make_status(
+        IREE_STATUS_FAILED_PRECONDITION,
+        "executable does not support this version of the "
+        "runtime (executable: %d, runtime: %d)",
+        header->version, IREE_HAL_EXECUTABLE_LIBRARY_VERSION_LATEST);
+  }
+  *out_header = header_ptr;
+  return iree_ok_status();
+}
+
+static iree_status_t iree_hal_static_library_loader_allocate(
+    iree_host_size_t library_count,
+    iree_hal_executable_import_provider_t import_provider,
+    iree_allocator_t host_allocator,
+    iree_hal_static_library_loader_t** out_executable_loader) {
+  iree_hal_static_library_loader_t* executable_loader = NULL;
+  iree_host_size_t total_size =
+      sizeof(*executable_loader) +
+      sizeof(executable_loader->libraries[0]) * library_count;
+  IREE_RETURN_IF_ERROR(iree_allocator_malloc(host_allocator, total_size,
+                                             (void**)&executable_loader));
+  iree_hal_executable_loader_initialize(&iree_hal_static_library_loader_vtable,
+                                        import_provider,
+                                        &executable_loader->base);
+  executable_loader->host_allocator = host_allocator;
+  executable_loader->library_count = library_count;
+  *out_executable_loader = executable_loader;
+  return iree_ok_status();
+}
+
 iree_status_t iree_hal_static_library_loader_create(
     iree_host_size_t library_count,
     const iree_hal_executable_library_query_fn_t* library_query_fns,
@@ -208,49 +272,20 @@ iree_status_t iree_hal_static_library_loader_create(
   IREE_TRACE_ZONE_BEGIN(z0);
 
   iree_hal_static_library_loader_t* executable_loader = NULL;
-  iree_host_size_t total_size =
-      sizeof(*executable_loader) +
-      sizeof(executable_loader->libraries[0]) * library_count;
-  iree_status_t status = iree_allocator_malloc(host_allocator, total_size,
-                                               (void**)&executable_loader);
+  iree_status_t status = iree_hal_static_library_loader_allocate(
+      library_count, import_provider, host_allocator, &executable_loader);
+
+  // Query and verify all libraries upfront.
   if (iree_status_is_ok(status)) {
-    iree_hal_executable_loader_initialize(
-        &iree_hal_static_library_loader_vtable, import_provider,
-        &executable_loader->base);
-    executable_loader->host_allocator = host_allocator;
-    executable_loader->library_count = library_count;
-
-    // Default environment to enable initialization.
-    iree_hal_executable_environment_v0_t environment;
-    iree_hal_executable_environment_initialize(host_allocator, &environment);
-
-    // Query and verify the libraries provided all match our expected version.
-    // It's rare they won't, however static libraries generated with a newer
-    // version of the IREE compiler that are then linked with an older version
-    // of the runtime are difficult to spot otherwise.
     for (iree_host_size_t i = 0; i < library_count; ++i) {
-      const iree_hal_executable_library_header_t* const* header_ptr =
-          library_query_fns[i](IREE_HAL_EXECUTABLE_LIBRARY_VERSION_LATEST,
-                               &environment);
-      if (!header_ptr) {
-        status = iree_make_status(
-            IREE_STATUS_UNAVAILABLE,
-            "failed to query library header for runtime version %d",
-            IREE_HAL_EXECUTABLE_LIBRARY_VERSION_LATEST);
-        break;
-      }
-      const iree_hal_executable_library_header_t* header = *header_ptr;
-      IREE_TRACE_ZONE_APPEND_TEXT(z0, header->name);
-      if (header->version > IREE_HAL_EXECUTABLE_LIBRARY_VERSION_LATEST) {
-        status = iree_make_status(
-            IREE_STATUS_FAILED_PRECONDITION,
-            "executable does not support this version of the "
-            "runtime (executable: %d, runtime: %d)",
-            header->version, IREE_HAL_EXECUTABLE_LIBRARY_VERSION_LATEST);
-        break;
-      }
-      memcpy((void*)&executable_loader->libraries[i], &header_ptr,
-             sizeof(header_ptr));
+      iree_hal_static_library_loader_entry_t* entry =
+          &executable_loader->libraries[i];
+      status = iree_hal_static_library_query(library_query_fns[i],
+                                             host_allocator, &entry->header);
+      if (!iree_status_is_ok(status)) break;
+      IREE_TRACE_ZONE_APPEND_TEXT(z0, (*entry->header)->name);
+      entry->name = iree_make_cstring_view((*entry->header)->name);
+      entry->query_fn = library_query_fns[i];
     }
   }
 
@@ -264,6 +299,38 @@ iree_status_t iree_hal_static_library_loader_create(
   return status;
 }
 
+iree_status_t iree_hal_static_library_loader_create_lazy(
+    iree_host_size_t registration_count,
+    const iree_hal_static_library_registration_t* registrations,
+    iree_hal_executable_import_provider_t import_provider,
+    iree_allocator_t host_allocator,
+    iree_hal_executable_loader_t** out_executable_loader) {
+  IREE_ASSERT_ARGUMENT(!registration_count || registrations);
+  IREE_ASSERT_ARGUMENT(out_executable_loader);
+  *out_executable_loader = NULL;
+  IREE_TRACE_ZONE_BEGIN(z0);
+
+  iree_hal_static_library_loader_t* executable_loader = NULL;
+  IREE_RETURN_AND_END_ZONE_IF_ERROR(
+      z0, iree_hal_static_library_loader_allocate(registration_count,
+                                                  import_provider,
+                                                  host_allocator,
+                                                  &executable_loader));
+
+  // Libraries are only queried when first loaded.
+  for (iree_host_size_t i = 0; i < registration_count; ++i) {
+    iree_hal_static_library_loader_entry_t* entry =
+        &executable_loader->libraries[i];
+    entry->name = iree_make_cstring_view(registrations[i].name);
+    entry->query_fn = registrations[i].query_fn;
+    entry->header = NULL;
+  }
+
+  *out_executable_loader = (iree_hal_executable_loader_t*)executable_loader;
+  IREE_TRACE_ZONE_END(z0);
+  return iree_ok_status();
+}
+
 static void iree_hal_static_library_loader_destroy(
     iree_hal_executable_loader_t* base_executable_loader) {
   iree_hal_static_library_loader_t* executable_loader =
@@ -302,15 +369,43 @@ static iree_status_t iree_hal_static_library_loader_try_load(
   // creation to perform a binary-search fairly easily, though, at the cost of
   // the additional code size.
   for (iree_host_size_t i = 0; i < executable_loader->library_count; ++i) {
-    const iree_hal_executable_library_header_t* header =
-        *executable_loader->libraries[i];
-    if (iree_string_view_equal(library_name,
-                               iree_make_cstring_view(header->name))) {
-      return iree_hal_static_executable_create(
-          executable_params, executable_loader->libraries[i],
-          base_executable_loader->import_provider,
-          executable_loader->host_allocator, out_executable);
+    const iree_hal_static_library_loader_entry_t* entry =
+        &executable_loader->libraries[i];
+    if (!iree_string_view_equal(library_name, entry->name)) continue;
+
+    // Lazily registered libraries are queried on each load. Query functions
+    // return static storage and are cheap compared to executable creation,
+    // and not caching the result keeps the loader immutable and thread-safe.
+    const iree_hal_executable_library_header_t** header = entry->header;
+    if (!header) {
+      IREE_RETURN_IF_ERROR(iree_hal_static_library_query(
+          entry->query_fn, executable_loader->host_allocator, &header));
+      if (!iree_string_view_equal(entry->name,
+                                  iree_make_cstring_view((*header)->name))) {
+        return iree_make_status(
+            IREE_STATUS_FAILED_PRECONDITION,
+            "static library registered as '%.*s' reports name '%s'",
+            (int)entry->name.size, entry->name.data, (*header)->name);
+      }
+    }
+    iree_status_t status = iree_hal_static_executable_create(
+        executable_params, header, base_executable_loader->import_provider,
+        executable_loader->host_allocator, out_executable);
+
+    // Per-export statistics are only allocated if enabled when loading.
+    if (iree_status_is_ok(status)) {
+      iree_hal_static_executable_t* executable =
+          (iree_hal_static_executable_t*)*out_executable;
+      status = iree_hal_local_executable_initialize_statistics(
+          &executable->base, executable->identifier,
+          executable->library.v0->exports.count,
+          executable->library.v0->exports.names, worker_capacity);
+      if (!iree_status_is_ok(status)) {
+        iree_hal_executable_release(*out_executable);
+        *out_executable = NULL;
+      }
     }
+    return status;
   }
   return iree_make_status(IREE_STATUS_NOT_FOUND,
                           "no static library with the name '%.*s' registered",
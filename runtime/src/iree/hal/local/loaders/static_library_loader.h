@@ -40,6 +40,36 @@ iree_status_t iree_hal_static_library_loader_create(
     iree_allocator_t host_allocator,
     iree_hal_executable_loader_t** out_executable_loader);
 
+// A static library available for lazy loading.
+// The IREE compiler emits an initializer for this struct in the header it
+// generates for each static library, such as:
+//   static const iree_hal_static_library_registration_t registrations[] = {
+//       IREE_STATIC_LIBRARY_SIMPLE_MUL_DISPATCH_0_REGISTRATION,
+//   };
+typedef struct iree_hal_static_library_registration_t {
+  // Name of the library as used during compilation.
+  const char* name;
+  // Function used to query the library header when it is first loaded.
+  iree_hal_executable_library_query_fn_t query_fn;
+} iree_hal_static_library_registration_t;
+
+// Creates a library loader that exposes the provided libraries to the HAL for
+// use as executables and only queries them when they are first loaded.
+//
+// Unlike iree_hal_static_library_loader_create no library is queried or
+// verified during creation and errors are reported when an executable
+// referencing a library is prepared. This avoids the startup cost of
+// initializing libraries that are never used and allows the registration table
+// to be constant data. The registrations are copied but the names they
+// reference must remain valid for the lifetime of the loader and must match
+// the names used during compilation exactly.
+iree_status_t iree_hal_static_library_loader_create_lazy(
+    iree_host_size_t registration_count,
+    const iree_hal_static_library_registration_t* registrations,
+    iree_hal_executable_import_provider_t import_provider,
+    iree_allocator_t host_allocator,
+    iree_hal_executable_loader_t** out_executable_loader);
+
 #ifdef __cplusplus
 }  // extern "C"
 #endif  // __cplusplus
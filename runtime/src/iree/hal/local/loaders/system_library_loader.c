@@ -225,20 +225,23 @@ static iree_status_t iree_hal_system_executable_resolve_imports(
   executable->base.environment.import_thunk =
       iree_hal_system_executable_import_thunk_v0;
 
-  // Allocate storage for the imports.
-  // TODO(benvanik): allocate both as one block.
+  // Allocate storage for the imports as a single block with the contexts
+  // following the function pointers. Ownership of the block is tracked by
+  // import_funcs.
+  const iree_host_size_t import_funcs_size =
+      import_table->count * sizeof(*executable->base.environment.import_funcs);
+  const iree_host_size_t import_contexts_size =
+      import_table->count *
+      sizeof(*executable->base.environment.import_contexts);
+  uint8_t* import_storage = NULL;
   IREE_RETURN_AND_END_ZONE_IF_ERROR(
-      z0, iree_allocator_malloc(
-              executable->base.host_allocator,
-              import_table->count *
-                  sizeof(*executable->base.environment.import_funcs),
-              (void**)&executable->base.environment.import_funcs));
-  IREE_RETURN_AND_END_ZONE_IF_ERROR(
-      z0, iree_allocator_malloc(
-              executable->base.host_allocator,
-              import_table->count *
-                  sizeof(*executable->base.environment.import_contexts),
-              (void**)&executable->base.environment.import_contexts));
+      z0, iree_allocator_malloc(executable->base.host_allocator,
+                                import_funcs_size + import_contexts_size,
+                                (void**)&import_storage));
+  executable->base.environment.import_funcs =
+      (const iree_hal_executable_import_v0_t*)import_storage;
+  executable->base.environment.import_contexts =
+      (const void**)(import_storage + import_funcs_size);
 
   // Try to resolve each import.
   // NOTE: imports are sorted alphabetically and if we cared we could use this
@@ -360,14 +363,11 @@ static void iree_hal_system_executable_destroy(
 
   iree_dynamic_library_release(executable->handle);
 
+  // NOTE: import_contexts shares the import_funcs allocation.
   if (executable->base.environment.import_funcs != NULL) {
     iree_allocator_free(host_allocator,
                         (void*)executable->base.environment.import_funcs);
   }
-  if (executable->base.environment.import_contexts != NULL) {
-    iree_allocator_free(host_allocator,
-                        (void*)executable->base.environment.import_contexts);
-  }
 
   iree_hal_local_executable_deinitialize(
       (iree_hal_local_executable_t*)base_executable);
@@ -519,13 +519,26 @@ static iree_status_t iree_hal_system_library_loader_try_load(
   IREE_TRACE_ZONE_BEGIN(z0);
 
   // Perform the load (and requisite disgusting hackery).
-  IREE_RETURN_AND_END_ZONE_IF_ERROR(
-      z0, iree_hal_system_executable_create(
-              executable_params, base_executable_loader->import_provider,
-              executable_loader->host_allocator, out_executable));
+  iree_status_t status = iree_hal_system_executable_create(
+      executable_params, base_executable_loader->import_provider,
+      executable_loader->host_allocator, out_executable);
+
+  // Per-export statistics are only allocated if enabled when loading.
+  if (iree_status_is_ok(status)) {
+    iree_hal_system_executable_t* executable =
+        (iree_hal_system_executable_t*)*out_executable;
+    status = iree_hal_local_executable_initialize_statistics(
+        &executable->base, executable->identifier,
+        executable->library.v0->exports.count,
+        executable->library.v0->exports.names, worker_capacity);
+    if (!iree_status_is_ok(status)) {
+      iree_hal_executable_release(*out_executable);
+      *out_executable = NULL;
+    }
+  }
 
   IREE_TRACE_ZONE_END(z0);
-  return iree_ok_status();
+  return status;
 }
 
 static const iree_hal_executable_loader_vtable_t
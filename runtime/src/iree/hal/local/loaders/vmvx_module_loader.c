@@ -120,6 +120,20 @@ typedef struct iree_hal_vmvx_worker_state_t {
   // Pointer into the VMVX module state for the worker context.
   // This is used to update module state directly.
   iree_vm_module_state_t* vmvx_module_state;
+
+  // VM stack reused by all calls made on the worker. Frames are popped after
+  // each call and any growth storage is retained for subsequent calls.
+  iree_vm_stack_t* stack;
+
+  // Binding list and the VM buffers wrapping each binding for the last
+  // dispatch processed by the worker. All workgroups of a dispatch share the
+  // same bindings and reusing the list avoids rewrapping and retaining every
+  // binding per workgroup. Rebuilt when the bindings change.
+  iree_allocator_t host_allocator;
+  iree_host_size_t binding_capacity;
+  void* binding_storage;
+  iree_vm_list_t* binding_list;
+  iree_vm_buffer_t* binding_buffers;
 } iree_hal_vmvx_worker_state_t;
 
 static iree_status_t iree_hal_vmvx_worker_state_initialize(
@@ -152,9 +166,19 @@ static iree_status_t iree_hal_vmvx_worker_state_initialize(
         executable_params->constants, host_allocator);
   }
 
+  // Allocate the stack used for all calls on this worker.
+  iree_vm_stack_t* stack = NULL;
+  if (iree_status_is_ok(status)) {
+    status = iree_vm_stack_allocate(
+        IREE_VM_INVOCATION_FLAG_TRACE_INLINE,
+        iree_vm_context_state_resolver(context), host_allocator, &stack);
+  }
+
   if (iree_status_is_ok(status)) {
     out_state->context = context;
     out_state->vmvx_module_state = vmvx_module_state;
+    out_state->stack = stack;
+    out_state->host_allocator = host_allocator;
   } else {
     iree_vm_context_release(context);
   }
@@ -162,10 +186,128 @@ static iree_status_t iree_hal_vmvx_worker_state_initialize(
   return status;
 }
 
+// Drops the cached binding list and the buffers it references.
+static void iree_hal_vmvx_worker_state_reset_bindings(
+    iree_hal_vmvx_worker_state_t* state) {
+  if (!state->binding_list) return;
+  const iree_host_size_t binding_count =
+      iree_vm_list_size(state->binding_list);
+  iree_vm_list_clear(state->binding_list);
+  for (iree_host_size_t i = 0; i < binding_count; ++i) {
+    iree_vm_buffer_deinitialize(&state->binding_buffers[i]);
+  }
+}
+
+// Returns a binding list wrapping the bindings in |dispatch_state|.
+// The list is cached on the worker and only rebuilt if the bindings differ
+// from the previous call.
+static iree_status_t iree_hal_vmvx_worker_state_prepare_bindings(
+    iree_hal_vmvx_worker_state_t* state,
+    const iree_hal_executable_dispatch_state_v0_t* dispatch_state,
+    iree_vm_list_t** out_binding_list) {
+  *out_binding_list = NULL;
+  const iree_host_size_t binding_count = dispatch_state->binding_count;
+
+  // Reuse the list if it still references the same binding ranges.
+  if (state->binding_list &&
+      iree_vm_list_size(state->binding_list) == binding_count) {
+    bool matches = true;
+    for (iree_host_size_t i = 0; i < binding_count; ++i) {
+      const iree_byte_span_t data = state->binding_buffers[i].data;
+      if (data.data != dispatch_state->binding_ptrs[i] ||
+          data.data_length != dispatch_state->binding_lengths[i]) {
+        matches = false;
+        break;
+      }
+    }
+    if (matches) {
+      *out_binding_list = state->binding_list;
+      return iree_ok_status();
+    }
+  }
+  iree_hal_vmvx_worker_state_reset_bindings(state);
+
+  // Grow the storage if there are more bindings than it can hold.
+  iree_vm_type_def_t buffer_type =
+      iree_vm_type_def_make_ref_type(iree_vm_buffer_type_id());
+  if (!state->binding_list || binding_count > state->binding_capacity) {
+    if (state->binding_list) {
+      iree_vm_list_deinitialize(state->binding_list);
+      state->binding_list = NULL;
+    }
+    iree_allocator_free(state->host_allocator, state->binding_storage);
+    state->binding_storage = NULL;
+    state->binding_capacity = 0;
+
+    const iree_host_size_t buffers_size =
+        iree_host_align(binding_count * sizeof(iree_vm_buffer_t), 16);
+    const iree_host_size_t list_size =
+        iree_vm_list_storage_size(&buffer_type, binding_count);
+    IREE_RETURN_IF_ERROR(iree_allocator_malloc(state->host_allocator,
+                                               buffers_size + list_size,
+                                               &state->binding_storage));
+    state->binding_buffers = (iree_vm_buffer_t*)state->binding_storage;
+    iree_status_t status = iree_vm_list_initialize(
+        iree_make_byte_span((uint8_t*)state->binding_storage + buffers_size,
+                            list_size),
+        &buffer_type, binding_count, &state->binding_list);
+    if (!iree_status_is_ok(status)) {
+      iree_allocator_free(state->host_allocator, state->binding_storage);
+      state->binding_storage = NULL;
+      return status;
+    }
+    state->binding_capacity = binding_count;
+  }
+
+  // Map bindings into worker-owned VMVX buffers.
+  iree_status_t status = iree_ok_status();
+  for (iree_host_size_t i = 0; i < binding_count; ++i) {
+    iree_vm_buffer_t* binding_buffer = &state->binding_buffers[i];
+    // TODO(benvanik): pipeline layout contains the required access
+    // information. We will likely want to encode a bitmap of mutable bindings
+    // such that we can quickly set the access bit, though.
+    iree_vm_buffer_access_t access =
+        IREE_VM_BUFFER_ACCESS_MUTABLE | IREE_VM_BUFFER_ACCESS_ORIGIN_HOST;
+    iree_vm_buffer_initialize(
+        access,
+        iree_make_byte_span(dispatch_state->binding_ptrs[i],
+                            dispatch_state->binding_lengths[i]),
+        iree_allocator_null(), binding_buffer);
+    iree_vm_ref_t ref = {0};
+    status =
+        iree_vm_ref_wrap_assign(binding_buffer, iree_vm_buffer_type_id(), &ref);
+    if (iree_status_is_ok(status)) {
+      status = iree_vm_list_push_ref_retain(state->binding_list, &ref);
+    }
+    if (!iree_status_is_ok(status)) {
+      // Only buffers already in the list are deinitialized by the reset.
+      iree_vm_buffer_deinitialize(binding_buffer);
+      break;
+    }
+  }
+  if (!iree_status_is_ok(status)) {
+    iree_hal_vmvx_worker_state_reset_bindings(state);
+    return status;
+  }
+  *out_binding_list = state->binding_list;
+  return iree_ok_status();
+}
+
 static void iree_hal_vmvx_worker_state_deinitialize(
     iree_hal_vmvx_worker_state_t* state) {
   IREE_ASSERT_ARGUMENT(state);
   IREE_TRACE_ZONE_BEGIN(z0);
+  iree_hal_vmvx_worker_state_reset_bindings(state);
+  if (state->binding_list) {
+    iree_vm_list_deinitialize(state->binding_list);
+    state->binding_list = NULL;
+  }
+  iree_allocator_free(state->host_allocator, state->binding_storage);
+  state->binding_storage = NULL;
+  if (state->stack) {
+    iree_vm_stack_free(state->stack);
+    state->stack = NULL;
+  }
   if (state->context) {
     iree_vm_context_release(state->context);
     state->context = NULL;
@@ -325,6 +467,14 @@ static iree_status_t iree_hal_vmvx_executable_create(
     }
   }
 
+  // Per-export statistics are only allocated if enabled when loading.
+  // Export names are looked up from the module on demand and not retained.
+  if (iree_status_is_ok(status)) {
+    status = iree_hal_local_executable_initialize_statistics(
+        &executable->base, iree_vm_module_name(bytecode_module),
+        executable->entry_fn_count, /*export_names=*/NULL, worker_capacity);
+  }
+
   if (iree_status_is_ok(status)) {
     *out_executable = (iree_hal_executable_t*)executable;
   } else {
@@ -381,49 +531,11 @@ static iree_status_t iree_hal_vmvx_executable_issue_call(
   iree_vmvx_module_state_update_workgroup_state(worker_state->vmvx_module_state,
                                                 workgroup_state->processor_id);
 
-  // On-stack interface local to this invocation.
-  // Note that we _could_ share this across all invocations in a dispatch, but
-  // it's tricky to find a good place when threading is happening and it's
-  // intentionally fairly cheap to construct by matching the dispatch_state.
-  // The list would only need to be constructed once and we could avoid the
-  // extraneous retain/releases and mappings.
-  iree_vm_type_def_t buffer_type =
-      iree_vm_type_def_make_ref_type(iree_vm_buffer_type_id());
-  iree_host_size_t binding_list_size =
-      iree_vm_list_storage_size(&buffer_type, dispatch_state->binding_count);
-  void* binding_list_storage = iree_alloca(binding_list_size);
+  // Bindings are shared by all workgroups of a dispatch and cached on the
+  // worker so that they are only wrapped once per dispatch per worker.
   iree_vm_list_t* binding_list = NULL;
-  IREE_RETURN_IF_ERROR(iree_vm_list_initialize(
-      iree_make_byte_span(binding_list_storage, binding_list_size),
-      &buffer_type, dispatch_state->binding_count, &binding_list));
-
-  // Map bindings into on-stack VMVX buffers.
-  iree_status_t status = iree_ok_status();
-  iree_vm_buffer_t* binding_buffers = (iree_vm_buffer_t*)iree_alloca(
-      dispatch_state->binding_count * sizeof(iree_vm_buffer_t));
-  for (iree_host_size_t i = 0; i < dispatch_state->binding_count; ++i) {
-    iree_vm_buffer_t* binding_buffer = &binding_buffers[i];
-    // TODO(benvanik): pipeline layout contains the required access
-    // information. We will likely want to encode a bitmap of mutable bindings
-    // such that we can quickly set the access bit, though.
-    iree_vm_buffer_access_t access =
-        IREE_VM_BUFFER_ACCESS_MUTABLE | IREE_VM_BUFFER_ACCESS_ORIGIN_HOST;
-    iree_vm_buffer_initialize(
-        access,
-        iree_make_byte_span(dispatch_state->binding_ptrs[i],
-                            dispatch_state->binding_lengths[i]),
-        iree_allocator_null(), binding_buffer);
-    iree_vm_ref_t ref = {0};
-    status =
-        iree_vm_ref_wrap_assign(binding_buffer, iree_vm_buffer_type_id(), &ref);
-    if (!iree_status_is_ok(status)) break;
-    status = iree_vm_list_push_ref_retain(binding_list, &ref);
-    if (!iree_status_is_ok(status)) break;
-  }
-  if (!iree_status_is_ok(status)) {
-    iree_vm_list_deinitialize(binding_list);
-    return status;
-  }
+  IREE_RETURN_IF_ERROR(iree_hal_vmvx_worker_state_prepare_bindings(
+      worker_state, dispatch_state, &binding_list));
 
   // Acquire workgroup local memory for the dispatch.
   iree_vm_buffer_t local_memory_buffer;
@@ -510,15 +622,6 @@ static iree_status_t iree_hal_vmvx_executable_issue_call(
   iree_vm_buffer_retain(&local_memory_buffer);  // for call
   iree_vm_buffer_retain(&constants_buffer);     // for call
 
-  // VM stack stored on native stack. We really do abuse the stack too much
-  // here but it's 8KB and that should be reasonable given that there isn't too
-  // much above us in the stack.
-  // TODO(benvanik): pass in an iree_arena_t that can be used for this.
-  IREE_VM_INLINE_STACK_INITIALIZE(
-      stack, IREE_VM_INVOCATION_FLAG_TRACE_INLINE,
-      iree_vm_context_state_resolver(worker_state->context),
-      executable->base.host_allocator);
-
   // Direct call interface.
   // This only works because we know the exact signature and that these will
   // never block (if they do it'll be handled as if it's an error).
@@ -527,17 +630,15 @@ static iree_status_t iree_hal_vmvx_executable_issue_call(
   call.function = entry_fn;
   call.arguments = iree_make_byte_span(&call_args, sizeof(call_args));
   call.results = iree_make_byte_span(NULL, 0);
-  status = entry_fn.module->begin_call(entry_fn.module->self, stack, call);
+  iree_status_t status = entry_fn.module->begin_call(
+      entry_fn.module->self, worker_state->stack, call);
 
-  // Clean up the stack if needed, such as when the call fails.
-  iree_vm_stack_deinitialize(stack);
+  // Clean up the stack if needed, such as when the call fails, so that it can
+  // be reused by the next call on this worker.
+  iree_vm_stack_reset(worker_state->stack);
 
   iree_vm_buffer_deinitialize(&local_memory_buffer);
   iree_vm_buffer_deinitialize(&constants_buffer);
-  iree_vm_list_deinitialize(binding_list);
-  for (iree_host_size_t i = 0; i < dispatch_state->binding_count; ++i) {
-    iree_vm_buffer_deinitialize(&binding_buffers[i]);
-  }
 
   return status;
 }
@@ -0,0 +1,944 @@
+// Copyright 2023 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include "iree/hal/local/local_channel.h"
+
+#include <inttypes.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "iree/base/internal/atomics.h"
+#include "iree/base/internal/math.h"
+#include "iree/base/internal/synchronization.h"
+#include "iree/base/internal/threading.h"
+#include "iree/base/tracing.h"
+
+#if (defined(IREE_PLATFORM_LINUX) && !defined(IREE_PLATFORM_ANDROID)) || \
+    defined(IREE_PLATFORM_APPLE)
+#define IREE_HAL_LOCAL_CHANNEL_HAVE_SHM 1
+#include <errno.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif  // IREE_PLATFORM_LINUX || IREE_PLATFORM_APPLE
+
+//===----------------------------------------------------------------------===//
+// Shared segment layout
+//===----------------------------------------------------------------------===//
+// The segment is either private memory (single participant) or a named shared
+// memory object mapped by all participants. It starts with a header followed
+// by the synchronization counters of each rank (each on its own cache line to
+// avoid false sharing while spinning) and then the staging slots.
+//
+// Collectives proceed in rounds identified by a sequence number that all
+// participants advance in lockstep:
+//   1. wait until all ranks have departed the prior round (slots are free)
+//   2. write this rank's contribution to its slot
+//   3. publish |arrive| = sequence and wait for all ranks to arrive
+//   4. read the slots of all ranks to produce this rank's results
+//   5. publish |depart| = sequence
+//
+// A participant that fails a collective (or times out waiting on the others)
+// publishes an abort state in the header. All waits observe it and fail with
+// IREE_STATUS_ABORTED so that a failure on one participant does not leave the
+// others blocked in a round that will never complete. The rounds of the
+// participants can no longer be matched up after a failure so the abort is
+// permanent and all future collectives on the channel fail.
+
+#define IREE_HAL_LOCAL_CHANNEL_CACHE_LINE_SIZE 64
+
+// Segment header states.
+#define IREE_HAL_LOCAL_CHANNEL_STATE_UNINITIALIZED 0
+#define IREE_HAL_LOCAL_CHANNEL_STATE_INITIALIZING 1
+#define IREE_HAL_LOCAL_CHANNEL_STATE_READY 2
+
+typedef struct iree_hal_local_channel_header_t {
+  // One of IREE_HAL_LOCAL_CHANNEL_STATE_*. The first participant to map the
+  // zero-filled segment initializes the header and others wait for READY.
+  iree_atomic_int32_t state;
+  // Participant count the segment was created for.
+  int32_t count;
+  // Size of each slot in bytes.
+  int64_t slot_size;
+  // Bitmask of ranks that have joined the channel.
+  iree_atomic_int64_t joined_mask;
+  // 0 if the channel is usable and otherwise the rank that aborted the channel
+  // in the upper 32 bits and the iree_status_code_t of its failure in the
+  // lower 32 bits. Only the first abort is recorded.
+  iree_atomic_int64_t abort_state;
+} iree_hal_local_channel_header_t;
+
+typedef struct iree_hal_local_channel_rank_t {
+  // Sequence number of the last round this rank has written its slot for.
+  iree_atomic_int64_t arrive;
+  uint8_t reserved0[IREE_HAL_LOCAL_CHANNEL_CACHE_LINE_SIZE -
+                    sizeof(iree_atomic_int64_t)];
+  // Sequence number of the last round this rank has finished reading for.
+  iree_atomic_int64_t depart;
+  uint8_t reserved1[IREE_HAL_LOCAL_CHANNEL_CACHE_LINE_SIZE -
+                    sizeof(iree_atomic_int64_t)];
+} iree_hal_local_channel_rank_t;
+
+static iree_host_size_t iree_hal_local_channel_ranks_offset(void) {
+  return iree_host_align(sizeof(iree_hal_local_channel_header_t),
+                         IREE_HAL_LOCAL_CHANNEL_CACHE_LINE_SIZE);
+}
+
+static iree_host_size_t iree_hal_local_channel_slots_offset(int32_t count) {
+  return iree_hal_local_channel_ranks_offset() +
+         count * sizeof(iree_hal_local_channel_rank_t);
+}
+
+static iree_host_size_t iree_hal_local_channel_segment_size(int32_t count) {
+  return iree_hal_local_channel_slots_offset(count) +
+         count * (iree_host_size_t)IREE_HAL_LOCAL_CHANNEL_SLOT_SIZE;
+}
+
+// Returns a stable hash of |id| used to name the shared segment.
+static uint64_t iree_hal_local_channel_hash_id(iree_const_byte_span_t id) {
+  // FNV-1a.
+  uint64_t hash = 0xCBF29CE484222325ull;
+  for (iree_host_size_t i = 0; i < id.data_length; ++i) {
+    hash ^= id.data[i];
+    hash *= 0x100000001B3ull;
+  }
+  return hash;
+}
+
+//===----------------------------------------------------------------------===//
+// iree_hal_local_channel_t
+//===----------------------------------------------------------------------===//
+
+typedef struct iree_hal_local_channel_t {
+  iree_hal_resource_t resource;
+  iree_allocator_t host_allocator;
+
+  // Hash of the ID used to create the channel. Only used for naming the
+  // segment and for tracing.
+  uint64_t id_hash;
+
+  // This participant's rank in the channel.
+  int32_t rank;
+  // Total number of participants in the channel.
+  int32_t count;
+
+  // Maximum duration of each wait on other participants.
+  iree_duration_t timeout;
+
+  // Shared segment and its size. Private memory when |is_shared| is false.
+  bool is_shared;
+  uint8_t* segment;
+  iree_host_size_t segment_size;
+
+  // Serializes collectives issued from multiple threads.
+  iree_slim_mutex_t mutex;
+  // Sequence number of the last round this participant started.
+  int64_t sequence IREE_GUARDED_BY(mutex);
+} iree_hal_local_channel_t;
+
+static const iree_hal_channel_vtable_t iree_hal_local_channel_vtable;
+
+static iree_hal_local_channel_t* iree_hal_local_channel_cast(
+    iree_hal_channel_t* base_value) {
+  IREE_HAL_ASSERT_TYPE(base_value, &iree_hal_local_channel_vtable);
+  return (iree_hal_local_channel_t*)base_value;
+}
+
+bool iree_hal_local_channel_isa(iree_hal_channel_t* channel) {
+  return iree_hal_resource_is(channel, &iree_hal_local_channel_vtable);
+}
+
+static iree_hal_local_channel_header_t* iree_hal_local_channel_header(
+    iree_hal_local_channel_t* channel) {
+  return (iree_hal_local_channel_header_t*)channel->segment;
+}
+
+static iree_hal_local_channel_rank_t* iree_hal_local_channel_rank(
+    iree_hal_local_channel_t* channel, int32_t rank) {
+  uint8_t* ranks = channel->segment + iree_hal_local_channel_ranks_offset();
+  return (iree_hal_local_channel_rank_t*)ranks + rank;
+}
+
+static uint8_t* iree_hal_local_channel_slot(iree_hal_local_channel_t* channel,
+                                            int32_t rank) {
+  return channel->segment +
+         iree_hal_local_channel_slots_offset(channel->count) +
+         rank * (iree_host_size_t)IREE_HAL_LOCAL_CHANNEL_SLOT_SIZE;
+}
+
+// Backs off while waiting on other participants. Spins briefly as rounds are
+// usually short when all participants are active and then falls back to
+// yielding and sleeping so that waiting on a slow participant doesn't burn a
+// core.
+static void iree_hal_local_channel_backoff(uint32_t* spin_count) {
+  if (*spin_count < 1024) {
+    iree_processor_yield();
+  } else if (*spin_count < 1024 + 64) {
+    iree_thread_yield();
+  } else {
+    iree_wait_until(iree_time_now() + 50000);
+  }
+  ++*spin_count;
+}
+
+// Publishes that this participant has failed with |code| so that all other
+// participants stop waiting on it. Only the first abort is recorded.
+static void iree_hal_local_channel_abort(iree_hal_local_channel_t* channel,
+                                         iree_status_code_t code) {
+  iree_hal_local_channel_header_t* header =
+      iree_hal_local_channel_header(channel);
+  int64_t expected = 0;
+  const int64_t state = ((int64_t)channel->rank << 32) | (uint32_t)code;
+  iree_atomic_compare_exchange_strong_int64(&header->abort_state, &expected,
+                                            state, iree_memory_order_acq_rel,
+                                            iree_memory_order_acquire);
+}
+
+// Returns IREE_STATUS_ABORTED if any participant has aborted the channel.
+static iree_status_t iree_hal_local_channel_query_abort(
+    iree_hal_local_channel_t* channel) {
+  const int64_t state = iree_atomic_load_int64(
+      &iree_hal_local_channel_header(channel)->abort_state,
+      iree_memory_order_acquire);
+  if (IREE_LIKELY(!state)) return iree_ok_status();
+  return iree_make_status(
+      IREE_STATUS_ABORTED,
+      "channel aborted after rank %d failed with %s; all collectives on the "
+      "channel fail after any participant fails",
+      (int32_t)(state >> 32),
+      iree_status_code_string((iree_status_code_t)(uint32_t)state));
+}
+
+// Backs off while waiting on other participants and returns an error if the
+// channel was aborted or |deadline_ns| elapsed. The deadline is only checked
+// once spinning has given way to yielding to keep the fast path cheap.
+static iree_status_t iree_hal_local_channel_backoff_until(
+    iree_hal_local_channel_t* channel, iree_time_t deadline_ns,
+    uint32_t* spin_count) {
+  IREE_RETURN_IF_ERROR(iree_hal_local_channel_query_abort(channel));
+  if (*spin_count >= 1024 && iree_time_now() >= deadline_ns) {
+    return iree_make_status(IREE_STATUS_DEADLINE_EXCEEDED,
+                            "timed out waiting on other participants of the "
+                            "channel");
+  }
+  iree_hal_local_channel_backoff(spin_count);
+  return iree_ok_status();
+}
+
+// Waits until all participants have published |sequence| or later to their
+// arrive (|depart| false) or depart (|depart| true) counter.
+static iree_status_t iree_hal_local_channel_wait_all(
+    iree_hal_local_channel_t* channel, bool depart, int64_t sequence) {
+  const iree_time_t deadline_ns =
+      iree_relative_timeout_to_deadline_ns(channel->timeout);
+  for (int32_t i = 0; i < channel->count; ++i) {
+    iree_hal_local_channel_rank_t* rank =
+        iree_hal_local_channel_rank(channel, i);
+    iree_atomic_int64_t* counter = depart ? &rank->depart : &rank->arrive;
+    uint32_t spin_count = 0;
+    while (iree_atomic_load_int64(counter, iree_memory_order_acquire) <
+           sequence) {
+      IREE_RETURN_IF_ERROR(iree_hal_local_channel_backoff_until(
+          channel, deadline_ns, &spin_count));
+    }
+  }
+  return iree_ok_status();
+}
+
+// Maps the segment for a channel with more than one participant and joins it.
+// Blocks until all participants have joined or the channel timeout elapses.
+static iree_status_t iree_hal_local_channel_join_shared(
+    iree_hal_local_channel_t* channel) {
+  const iree_time_t deadline_ns =
+      iree_relative_timeout_to_deadline_ns(channel->timeout);
+
+#if defined(IREE_HAL_LOCAL_CHANNEL_HAVE_SHM)
+  char name[64];
+  snprintf(name, sizeof(name), "/iree-channel-%016" PRIx64, channel->id_hash);
+
+  int fd = shm_open(name, O_RDWR | O_CREAT, 0600);
+  if (fd == -1) {
+    return iree_make_status(iree_status_code_from_errno(errno),
+                            "shm_open of channel segment '%s' failed", name);
+  }
+
+  // Every participant sizes the segment as they may race to create it. Some
+  // platforms only allow the size of a shared memory object to be set once so
+  // we only grow it and tolerate failures if another participant won.
+  iree_status_t status = iree_ok_status();
+  struct stat fd_stat;
+  if (fstat(fd, &fd_stat) == -1) {
+    status = iree_make_status(iree_status_code_from_errno(errno),
+                              "fstat of channel segment '%s' failed", name);
+  } else if ((iree_host_size_t)fd_stat.st_size < channel->segment_size &&
+             ftruncate(fd, (off_t)channel->segment_size) == -1 &&
+             (fstat(fd, &fd_stat) == -1 ||
+              (iree_host_size_t)fd_stat.st_size < channel->segment_size)) {
+    status = iree_make_status(iree_status_code_from_errno(errno),
+                              "failed to size channel segment '%s' to %" PRIhsz
+                              " bytes",
+                              name, channel->segment_size);
+  }
+  if (iree_status_is_ok(status)) {
+    void* ptr = mmap(NULL, channel->segment_size, PROT_READ | PROT_WRITE,
+                     MAP_SHARED, fd, 0);
+    if (ptr == MAP_FAILED) {
+      status = iree_make_status(iree_status_code_from_errno(errno),
+                                "mmap of channel segment '%s' failed", name);
+    } else {
+      channel->segment = (uint8_t*)ptr;
+      channel->is_shared = true;
+    }
+  }
+  close(fd);
+  IREE_RETURN_IF_ERROR(status);
+
+  // The first participant to arrive initializes the header.
+  iree_hal_local_channel_header_t* header =
+      iree_hal_local_channel_header(channel);
+  int32_t state = IREE_HAL_LOCAL_CHANNEL_STATE_UNINITIALIZED;
+  if (iree_atomic_compare_exchange_strong_int32(
+          &header->state, &state, IREE_HAL_LOCAL_CHANNEL_STATE_INITIALIZING,
+          iree_memory_order_acq_rel, iree_memory_order_acquire)) {
+    header->count = channel->count;
+    header->slot_size = IREE_HAL_LOCAL_CHANNEL_SLOT_SIZE;
+    iree_atomic_store_int32(&header->state, IREE_HAL_LOCAL_CHANNEL_STATE_READY,
+                            iree_memory_order_release);
+  } else {
+    uint32_t spin_count = 0;
+    while (iree_atomic_load_int32(&header->state, iree_memory_order_acquire) !=
+           IREE_HAL_LOCAL_CHANNEL_STATE_READY) {
+      if (spin_count >= 1024 && iree_time_now() >= deadline_ns) {
+        return iree_make_status(IREE_STATUS_DEADLINE_EXCEEDED,
+                                "timed out waiting for channel segment '%s' "
+                                "to be initialized",
+                                name);
+      }
+      iree_hal_local_channel_backoff(&spin_count);
+    }
+  }
+  if (header->count != channel->count ||
+      header->slot_size != IREE_HAL_LOCAL_CHANNEL_SLOT_SIZE) {
+    return iree_make_status(
+        IREE_STATUS_FAILED_PRECONDITION,
+        "channel segment '%s' was created for %d participants with %" PRId64
+        " byte slots but this participant expects %d with %d byte slots",
+        name, header->count, header->slot_size, channel->count,
+        IREE_HAL_LOCAL_CHANNEL_SLOT_SIZE);
+  }
+
+  // Join. A rank that is already present means either a duplicate rank or a
+  // segment left behind by a run that aborted before all participants joined.
+  const int64_t rank_bit = 1ll << channel->rank;
+  const int64_t full_mask = channel->count == 64
+                                ? (int64_t)~0ull
+                                : (int64_t)((1ull << channel->count) - 1);
+  const int64_t prior_mask = iree_atomic_fetch_or_int64(
+      &header->joined_mask, rank_bit, iree_memory_order_acq_rel);
+  if (prior_mask & rank_bit) {
+    return iree_make_status(
+        IREE_STATUS_FAILED_PRECONDITION,
+        "rank %d already joined channel segment '%s'; ranks must be unique and "
+        "a segment may remain from an aborted run (remove /dev/shm%s)",
+        channel->rank, name, name);
+  }
+
+  // The last participant to join removes the name so that the segment is
+  // freed once all participants unmap it and the ID can be reused.
+  if ((prior_mask | rank_bit) == full_mask) {
+    shm_unlink(name);
+  }
+
+  // NOTE: this blocks until all ranks have joined the channel.
+  uint32_t spin_count = 0;
+  while (iree_atomic_load_int64(&header->joined_mask,
+                                iree_memory_order_acquire) != full_mask) {
+    iree_status_t status =
+        iree_hal_local_channel_backoff_until(channel, deadline_ns, &spin_count);
+    if (!iree_status_is_ok(status)) {
+      // Fail the participants that have joined and remove the name so that
+      // late participants don't join a segment that will never be ready.
+      iree_hal_local_channel_abort(channel, iree_status_code(status));
+      shm_unlink(name);
+      return iree_status_annotate_f(status, "joining channel segment '%s'",
+                                    name);
+    }
+  }
+  return iree_ok_status();
+#else
+  return iree_make_status(IREE_STATUS_UNAVAILABLE,
+                          "shared memory channels are not available on this "
+                          "platform; only single participant channels are "
+                          "supported");
+#endif  // IREE_HAL_LOCAL_CHANNEL_HAVE_SHM
+}
+
+iree_status_t iree_hal_local_channel_create(iree_const_byte_span_t id,
+                                            int32_t rank, int32_t count,
+                                            iree_duration_t timeout,
+                                            iree_allocator_t host_allocator,
+                                            iree_hal_channel_t** out_channel) {
+  IREE_ASSERT_ARGUMENT(out_channel);
+  *out_channel = NULL;
+  IREE_TRACE_ZONE_BEGIN(z0);
+  const uint64_t id_hash = iree_hal_local_channel_hash_id(id);
+  IREE_TRACE_ZONE_APPEND_VALUE(z0, id_hash);
+  IREE_TRACE_ZONE_APPEND_VALUE(z0, rank);
+  IREE_TRACE_ZONE_APPEND_VALUE(z0, count);
+
+  if (count < 1 || count > IREE_HAL_LOCAL_CHANNEL_MAX_COUNT) {
+    IREE_TRACE_ZONE_END(z0);
+    return iree_make_status(IREE_STATUS_INVALID_ARGUMENT,
+                            "channel participant count %d out of range [1, %d]",
+                            count, IREE_HAL_LOCAL_CHANNEL_MAX_COUNT);
+  }
+  if (rank < 0 || rank >= count) {
+    IREE_TRACE_ZONE_END(z0);
+    return iree_make_status(IREE_STATUS_INVALID_ARGUMENT,
+                            "channel rank %d out of range [0, %d)", rank,
+                            count);
+  }
+
+  iree_hal_local_channel_t* channel = NULL;
+  IREE_RETURN_AND_END_ZONE_IF_ERROR(
+      z0, iree_allocator_malloc(host_allocator, sizeof(*channel),
+                                (void**)&channel));
+  memset(channel, 0, sizeof(*channel));
+  iree_hal_resource_initialize(&iree_hal_local_channel_vtable,
+                               &channel->resource);
+  channel->host_allocator = host_allocator;
+  channel->id_hash = id_hash;
+  channel->rank = rank;
+  channel->count = count;
+  channel->timeout = timeout;
+  channel->segment_size = iree_hal_local_channel_segment_size(count);
+  iree_slim_mutex_initialize(&channel->mutex);
+
+  iree_status_t status = iree_ok_status();
+  if (count == 1) {
+    // Nothing to share with; the segment only stages our own contribution.
+    status = iree_allocator_malloc(host_allocator, channel->segment_size,
+                                   (void**)&channel->segment);
+    if (iree_status_is_ok(status)) {
+      memset(channel->segment, 0, iree_hal_local_channel_slots_offset(count));
+      iree_hal_local_channel_header_t* header =
+          iree_hal_local_channel_header(channel);
+      header->state = IREE_HAL_LOCAL_CHANNEL_STATE_READY;
+      header->count = count;
+      header->slot_size = IREE_HAL_LOCAL_CHANNEL_SLOT_SIZE;
+      header->joined_mask = 1;
+    }
+  } else {
+    status = iree_hal_local_channel_join_shared(channel);
+  }
+
+  if (iree_status_is_ok(status)) {
+    *out_channel = (iree_hal_channel_t*)channel;
+  } else {
+    iree_hal_channel_release((iree_hal_channel_t*)channel);
+  }
+  IREE_TRACE_ZONE_END(z0);
+  return status;
+}
+
+static void iree_hal_local_channel_destroy(iree_hal_channel_t* base_channel) {
+  iree_hal_local_channel_t* channel =
+      iree_hal_local_channel_cast(base_channel);
+  iree_allocator_t host_allocator = channel->host_allocator;
+  IREE_TRACE_ZONE_BEGIN(z0);
+  IREE_TRACE_ZONE_APPEND_VALUE(z0, channel->id_hash);
+  IREE_TRACE_ZONE_APPEND_VALUE(z0, channel->rank);
+  IREE_TRACE_ZONE_APPEND_VALUE(z0, channel->count);
+
+  // Other participants may still be reading our slot from the last round but
+  // they hold their own mapping of the segment so it remains valid for them.
+  if (channel->is_shared) {
+#if defined(IREE_HAL_LOCAL_CHANNEL_HAVE_SHM)
+    munmap(channel->segment, channel->segment_size);
+#endif  // IREE_HAL_LOCAL_CHANNEL_HAVE_SHM
+  } else {
+    iree_allocator_free(host_allocator, channel->segment);
+  }
+  iree_slim_mutex_deinitialize(&channel->mutex);
+  iree_allocator_free(host_allocator, channel);
+
+  IREE_TRACE_ZONE_END(z0);
+}
+
+static void iree_hal_local_channel_query_rank_and_count(
+    const iree_hal_channel_t* base_channel, int32_t* out_rank,
+    int32_t* out_count) {
+  IREE_ASSERT_ARGUMENT(base_channel);
+  iree_hal_local_channel_t* channel =
+      iree_hal_local_channel_cast((iree_hal_channel_t*)base_channel);
+  *out_rank = channel->rank;
+  *out_count = channel->count;
+}
+
+//===----------------------------------------------------------------------===//
+// Reductions
+//===----------------------------------------------------------------------===//
+
+// Returns the size in bytes of |element_type| or 0 if unsupported.
+static iree_host_size_t iree_hal_local_channel_element_size(
+    iree_hal_collective_element_type_t element_type) {
+  switch (element_type) {
+    case IREE_HAL_COLLECTIVE_ELEMENT_TYPE_SINT_8:
+    case IREE_HAL_COLLECTIVE_ELEMENT_TYPE_UINT_8:
+      return 1;
+    case IREE_HAL_COLLECTIVE_ELEMENT_TYPE_SINT_16:
+    case IREE_HAL_COLLECTIVE_ELEMENT_TYPE_UINT_16:
+    case IREE_HAL_COLLECTIVE_ELEMENT_TYPE_FLOAT_16:
+    case IREE_HAL_COLLECTIVE_ELEMENT_TYPE_BFLOAT_16:
+      return 2;
+    case IREE_HAL_COLLECTIVE_ELEMENT_TYPE_SINT_32:
+    case IREE_HAL_COLLECTIVE_ELEMENT_TYPE_UINT_32:
+    case IREE_HAL_COLLECTIVE_ELEMENT_TYPE_FLOAT_32:
+      return 4;
+    case IREE_HAL_COLLECTIVE_ELEMENT_TYPE_SINT_64:
+    case IREE_HAL_COLLECTIVE_ELEMENT_TYPE_UINT_64:
+    case IREE_HAL_COLLECTIVE_ELEMENT_TYPE_FLOAT_64:
+      return 8;
+    default:
+      return 0;
+  }
+}
+
+static float iree_hal_local_channel_bf16_to_f32(uint16_t value) {
+  const uint32_t bits = (uint32_t)value << 16;
+  float result;
+  memcpy(&result, &bits, sizeof(result));
+  return result;
+}
+
+static uint16_t iree_hal_local_channel_f32_to_bf16(float value) {
+  uint32_t bits;
+  memcpy(&bits, &value, sizeof(bits));
+  if ((bits & 0x7FFFFFFFu) > 0x7F800000u) {
+    // Keep NaNs quiet instead of rounding them to infinity.
+    return (uint16_t)((bits >> 16) | 0x0040u);
+  }
+  // Round to nearest even.
+  bits += 0x7FFFu + ((bits >> 16) & 1u);
+  return (uint16_t)(bits >> 16);
+}
+
+// Defines accumulate and average functions for the C type |T|. Sums and
+// products are computed with |U| so that signed integer overflow wraps.
+#define IREE_HAL_LOCAL_CHANNEL_DEFINE_REDUCTION(name, T, U)                 \
+  static void iree_hal_local_channel_accumulate_##name(                     \
+      iree_hal_collective_reduction_t reduction, const void* source,        \
+      void* target, iree_host_size_t n) {                                   \
+    const T* s = (const T*)source;                                          \
+    T* t = (T*)target;                                                      \
+    switch (reduction) {                                                    \
+      case IREE_HAL_COLLECTIVE_REDUCTION_SUM:                               \
+      case IREE_HAL_COLLECTIVE_REDUCTION_AVERAGE:                           \
+        for (iree_host_size_t i = 0; i < n; ++i) t[i] = (T)((U)t[i] + s[i]); \
+        break;                                                              \
+      case IREE_HAL_COLLECTIVE_REDUCTION_PRODUCT:                           \
+        for (iree_host_size_t i = 0; i < n; ++i) t[i] = (T)((U)t[i] * s[i]); \
+        break;                                                              \
+      case IREE_HAL_COLLECTIVE_REDUCTION_MINIMUM:                           \
+        for (iree_host_size_t i = 0; i < n; ++i) {                          \
+          if (s[i] < t[i]) t[i] = s[i];                                     \
+        }                                                                   \
+        break;                                                              \
+      case IREE_HAL_COLLECTIVE_REDUCTION_MAXIMUM:                           \
+        for (iree_host_size_t i = 0; i < n; ++i) {                          \
+          if (s[i] > t[i]) t[i] = s[i];                                     \
+        }                                                                   \
+        break;                                                              \
+      default:                                                              \
+        break;                                                              \
+    }                                                                       \
+  }                                                                         \
+  static void iree_hal_local_channel_average_##name(                        \
+      void* target, iree_host_size_t n, int32_t count) {                    \
+    T* t = (T*)target;                                                      \
+    for (iree_host_size_t i = 0; i < n; ++i) t[i] = (T)(t[i] / (T)count);   \
+  }
+
+IREE_HAL_LOCAL_CHANNEL_DEFINE_REDUCTION(i8, int8_t, uint32_t)
+IREE_HAL_LOCAL_CHANNEL_DEFINE_REDUCTION(u8, uint8_t, uint32_t)
+IREE_HAL_LOCAL_CHANNEL_DEFINE_REDUCTION(i16, int16_t, uint32_t)
+IREE_HAL_LOCAL_CHANNEL_DEFINE_REDUCTION(u16, uint16_t, uint32_t)
+IREE_HAL_LOCAL_CHANNEL_DEFINE_REDUCTION(i32, int32_t, uint32_t)
+IREE_HAL_LOCAL_CHANNEL_DEFINE_REDUCTION(u32, uint32_t, uint32_t)
+IREE_HAL_LOCAL_CHANNEL_DEFINE_REDUCTION(i64, int64_t, uint64_t)
+IREE_HAL_LOCAL_CHANNEL_DEFINE_REDUCTION(u64, uint64_t, uint64_t)
+IREE_HAL_LOCAL_CHANNEL_DEFINE_REDUCTION(f32, float, float)
+IREE_HAL_LOCAL_CHANNEL_DEFINE_REDUCTION(f64, double, double)
+
+// Defines accumulate and average functions for a 16-bit float type stored as
+// uint16_t. Each step is computed in f32 and rounded back.
+#define IREE_HAL_LOCAL_CHANNEL_DEFINE_HALF_REDUCTION(name, to_f32, from_f32) \
+  static void iree_hal_local_channel_accumulate_##name(                      \
+      iree_hal_collective_reduction_t reduction, const void* source,         \
+      void* target, iree_host_size_t n) {                                    \
+    const uint16_t* s = (const uint16_t*)source;                             \
+    uint16_t* t = (uint16_t*)target;                                         \
+    for (iree_host_size_t i = 0; i < n; ++i) {                               \
+      const float a = to_f32(t[i]);                                          \
+      const float b = to_f32(s[i]);                                          \
+      float r = a;                                                           \
+      switch (reduction) {                                                   \
+        case IREE_HAL_COLLECTIVE_REDUCTION_SUM:                              \
+        case IREE_HAL_COLLECTIVE_REDUCTION_AVERAGE:                          \
+          r = a + b;                                                         \
+          break;                                                             \
+        case IREE_HAL_COLLECTIVE_REDUCTION_PRODUCT:                          \
+          r = a * b;                                                         \
+          break;                                                             \
+        case IREE_HAL_COLLECTIVE_REDUCTION_MINIMUM:                          \
+          r = b < a ? b : a;                                                 \
+          break;                                                             \
+        case IREE_HAL_COLLECTIVE_REDUCTION_MAXIMUM:                          \
+          r = b > a ? b : a;                                                 \
+          break;                                                             \
+        default:                                                             \
+          break;                                                             \
+      }                                                                      \
+      t[i] = from_f32(r);                                                    \
+    }                                                                        \
+  }                                                                          \
+  static void iree_hal_local_channel_average_##name(                         \
+      void* target, iree_host_size_t n, int32_t count) {                     \
+    uint16_t* t = (uint16_t*)target;                                         \
+    for (iree_host_size_t i = 0; i < n; ++i) {                               \
+      t[i] = from_f32(to_f32(t[i]) / (float)count);                          \
+    }                                                                        \
+  }
+
+IREE_HAL_LOCAL_CHANNEL_DEFINE_HALF_REDUCTION(f16, iree_math_f16_to_f32,
+                                             iree_math_f32_to_f16)
+IREE_HAL_LOCAL_CHANNEL_DEFINE_HALF_REDUCTION(
+    bf16, iree_hal_local_channel_bf16_to_f32,
+    iree_hal_local_channel_f32_to_bf16)
+
+typedef void (*iree_hal_local_channel_accumulate_fn_t)(
+    iree_hal_collective_reduction_t reduction, const void* source,
+    void* target, iree_host_size_t n);
+typedef void (*iree_hal_local_channel_average_fn_t)(void* target,
+                                                    iree_host_size_t n,
+                                                    int32_t count);
+
+typedef struct iree_hal_local_channel_reducer_t {
+  iree_hal_collective_reduction_t reduction;
+  iree_hal_local_channel_accumulate_fn_t accumulate;
+  iree_hal_local_channel_average_fn_t average;
+} iree_hal_local_channel_reducer_t;
+
+// Selects the reduction functions for |op|.
+static iree_status_t iree_hal_local_channel_select_reducer(
+    iree_hal_collective_op_t op,
+    iree_hal_local_channel_reducer_t* out_reducer) {
+  switch (op.reduction) {
+    case IREE_HAL_COLLECTIVE_REDUCTION_SUM:
+    case IREE_HAL_COLLECTIVE_REDUCTION_PRODUCT:
+    case IREE_HAL_COLLECTIVE_REDUCTION_MINIMUM:
+    case IREE_HAL_COLLECTIVE_REDUCTION_MAXIMUM:
+    case IREE_HAL_COLLECTIVE_REDUCTION_AVERAGE:
+      break;
+    default:
+      return iree_make_status(IREE_STATUS_UNIMPLEMENTED,
+                              "unhandled reduction type %u", op.reduction);
+  }
+  out_reducer->reduction = op.reduction;
+#define IREE_HAL_LOCAL_CHANNEL_SELECT(type, name)                       \
+  case IREE_HAL_COLLECTIVE_ELEMENT_TYPE_##type:                         \
+    out_reducer->accumulate = iree_hal_local_channel_accumulate_##name; \
+    out_reducer->average = iree_hal_local_channel_average_##name;       \
+    return iree_ok_status();
+  switch (op.element_type) {
+    IREE_HAL_LOCAL_CHANNEL_SELECT(SINT_8, i8)
+    IREE_HAL_LOCAL_CHANNEL_SELECT(UINT_8, u8)
+    IREE_HAL_LOCAL_CHANNEL_SELECT(SINT_16, i16)
+    IREE_HAL_LOCAL_CHANNEL_SELECT(UINT_16, u16)
+    IREE_HAL_LOCAL_CHANNEL_SELECT(SINT_32, i32)
+    IREE_HAL_LOCAL_CHANNEL_SELECT(UINT_32, u32)
+    IREE_HAL_LOCAL_CHANNEL_SELECT(SINT_64, i64)
+    IREE_HAL_LOCAL_CHANNEL_SELECT(UINT_64, u64)
+    IREE_HAL_LOCAL_CHANNEL_SELECT(FLOAT_16, f16)
+    IREE_HAL_LOCAL_CHANNEL_SELECT(FLOAT_32, f32)
+    IREE_HAL_LOCAL_CHANNEL_SELECT(FLOAT_64, f64)
+    IREE_HAL_LOCAL_CHANNEL_SELECT(BFLOAT_16, bf16)
+    default:
+      return iree_make_status(IREE_STATUS_UNIMPLEMENTED,
+                              "unhandled element type %u", op.element_type);
+  }
+#undef IREE_HAL_LOCAL_CHANNEL_SELECT
+}
+
+// Reduces |length| bytes at |offset| in the slots of all ranks into |target|.
+static void iree_hal_local_channel_reduce_slots(
+    iree_hal_local_channel_t* channel,
+    const iree_hal_local_channel_reducer_t* reducer, iree_host_size_t offset,
+    iree_host_size_t length, iree_host_size_t element_count, uint8_t* target) {
+  memcpy(target, iree_hal_local_channel_slot(channel, 0) + offset, length);
+  for (int32_t i = 1; i < channel->count; ++i) {
+    reducer->accumulate(reducer->reduction,
+                        iree_hal_local_channel_slot(channel, i) + offset,
+                        target, element_count);
+  }
+  if (reducer->reduction == IREE_HAL_COLLECTIVE_REDUCTION_AVERAGE) {
+    reducer->average(target, element_count, channel->count);
+  }
+}
+
+//===----------------------------------------------------------------------===//
+// Collectives
+//===----------------------------------------------------------------------===//
+
+// Begins a new round and returns this participant's slot once all
+// participants have finished reading the slots of the prior round.
+static iree_status_t iree_hal_local_channel_begin_round(
+    iree_hal_local_channel_t* channel, uint8_t** out_slot) {
+  ++channel->sequence;
+  IREE_RETURN_IF_ERROR(iree_hal_local_channel_wait_all(
+      channel, /*depart=*/true, channel->sequence - 1));
+  *out_slot = iree_hal_local_channel_slot(channel, channel->rank);
+  return iree_ok_status();
+}
+
+// Publishes this participant's slot and waits for all others to publish theirs.
+static iree_status_t iree_hal_local_channel_exchange(
+    iree_hal_local_channel_t* channel) {
+  iree_atomic_store_int64(
+      &iree_hal_local_channel_rank(channel, channel->rank)->arrive,
+      channel->sequence, iree_memory_order_release);
+  return iree_hal_local_channel_wait_all(channel, /*depart=*/false,
+                                         channel->sequence);
+}
+
+// Ends the current round after this participant is done reading all slots.
+static void iree_hal_local_channel_end_round(
+    iree_hal_local_channel_t* channel) {
+  iree_atomic_store_int64(
+      &iree_hal_local_channel_rank(channel, channel->rank)->depart,
+      channel->sequence, iree_memory_order_release);
+}
+
+static iree_status_t iree_hal_local_channel_execute_rounds(
+    iree_hal_local_channel_t* channel, iree_hal_collective_op_t op,
+    int32_t root, iree_host_size_t element_size, uint8_t* send_ptr,
+    uint8_t* recv_ptr, iree_host_size_t element_count) {
+  iree_hal_local_channel_reducer_t reducer = {0};
+  if (op.kind == IREE_HAL_COLLECTIVE_KIND_ALL_REDUCE ||
+      op.kind == IREE_HAL_COLLECTIVE_KIND_REDUCE ||
+      op.kind == IREE_HAL_COLLECTIVE_KIND_REDUCE_SCATTER) {
+    IREE_RETURN_IF_ERROR(iree_hal_local_channel_select_reducer(op, &reducer));
+  }
+
+  // Reduce-scatter stages one block per participant in each slot.
+  const iree_host_size_t blocks_per_slot =
+      op.kind == IREE_HAL_COLLECTIVE_KIND_REDUCE_SCATTER ? channel->count : 1;
+  const iree_host_size_t round_capacity =
+      IREE_HAL_LOCAL_CHANNEL_SLOT_SIZE / (element_size * blocks_per_slot);
+  if (round_capacity == 0) {
+    return iree_make_status(IREE_STATUS_RESOURCE_EXHAUSTED,
+                            "channel slots too small for %d participants",
+                            channel->count);
+  }
+
+  for (iree_host_size_t offset = 0; offset < element_count;
+       offset += round_capacity) {
+    const iree_host_size_t n = iree_min(round_capacity, element_count - offset);
+    const iree_host_size_t length = n * element_size;
+    const iree_host_size_t byte_offset = offset * element_size;
+    uint8_t* slot = NULL;
+    IREE_RETURN_IF_ERROR(iree_hal_local_channel_begin_round(channel, &slot));
+    switch (op.kind) {
+      case IREE_HAL_COLLECTIVE_KIND_ALL_GATHER: {
+        memcpy(slot, send_ptr + byte_offset, length);
+        IREE_RETURN_IF_ERROR(iree_hal_local_channel_exchange(channel));
+        for (int32_t i = 0; i < channel->count; ++i) {
+          memcpy(recv_ptr + (i * element_count + offset) * element_size,
+                 iree_hal_local_channel_slot(channel, i), length);
+        }
+        break;
+      }
+      case IREE_HAL_COLLECTIVE_KIND_ALL_REDUCE: {
+        memcpy(slot, send_ptr + byte_offset, length);
+        IREE_RETURN_IF_ERROR(iree_hal_local_channel_exchange(channel));
+        iree_hal_local_channel_reduce_slots(channel, &reducer, /*offset=*/0,
+                                            length, n, recv_ptr + byte_offset);
+        break;
+      }
+      case IREE_HAL_COLLECTIVE_KIND_BROADCAST: {
+        if (channel->rank == root) {
+          memcpy(slot, send_ptr + byte_offset, length);
+        }
+        IREE_RETURN_IF_ERROR(iree_hal_local_channel_exchange(channel));
+        if (recv_ptr) {
+          memcpy(recv_ptr + byte_offset,
+                 iree_hal_local_channel_slot(channel, root), length);
+        }
+        break;
+      }
+      case IREE_HAL_COLLECTIVE_KIND_REDUCE: {
+        memcpy(slot, send_ptr + byte_offset, length);
+        IREE_RETURN_IF_ERROR(iree_hal_local_channel_exchange(channel));
+        if (channel->rank == root) {
+          iree_hal_local_channel_reduce_slots(channel, &reducer, /*offset=*/0,
+                                              length, n,
+                                              recv_ptr + byte_offset);
+        }
+        break;
+      }
+      case IREE_HAL_COLLECTIVE_KIND_REDUCE_SCATTER: {
+        for (int32_t i = 0; i < channel->count; ++i) {
+          memcpy(slot + i * length,
+                 send_ptr + (i * element_count + offset) * element_size,
+                 length);
+        }
+        IREE_RETURN_IF_ERROR(iree_hal_local_channel_exchange(channel));
+        iree_hal_local_channel_reduce_slots(channel, &reducer,
+                                            channel->rank * length, length, n,
+                                            recv_ptr + byte_offset);
+        break;
+      }
+      default:
+        break;
+    }
+    iree_hal_local_channel_end_round(channel);
+  }
+  return iree_ok_status();
+}
+
+static iree_status_t iree_hal_local_channel_execute_impl(
+    iree_hal_local_channel_t* channel, iree_hal_collective_op_t op,
+    uint32_t param, iree_hal_buffer_binding_t send_binding,
+    iree_hal_buffer_binding_t recv_binding, iree_device_size_t element_count) {
+  const iree_host_size_t element_size =
+      iree_hal_local_channel_element_size(op.element_type);
+  if (element_size == 0) {
+    return iree_make_status(IREE_STATUS_UNIMPLEMENTED,
+                            "unhandled element type %u", op.element_type);
+  }
+
+  // Determine which bindings this participant uses and how much of them.
+  const int32_t root = (int32_t)param;
+  const iree_device_size_t length = element_count * element_size;
+  iree_device_size_t send_length = 0;
+  iree_device_size_t recv_length = 0;
+  switch (op.kind) {
+    case IREE_HAL_COLLECTIVE_KIND_ALL_GATHER:
+      send_length = length;
+      recv_length = length * channel->count;
+      break;
+    case IREE_HAL_COLLECTIVE_KIND_ALL_REDUCE:
+      send_length = length;
+      recv_length = length;
+      break;
+    case IREE_HAL_COLLECTIVE_KIND_BROADCAST:
+    case IREE_HAL_COLLECTIVE_KIND_REDUCE:
+      if (root < 0 || root >= channel->count) {
+        return iree_make_status(IREE_STATUS_INVALID_ARGUMENT,
+                                "root rank %d out of range [0, %d)", root,
+                                channel->count);
+      }
+      if (op.kind == IREE_HAL_COLLECTIVE_KIND_REDUCE ||
+          channel->rank == root) {
+        send_length = length;
+      }
+      if (op.kind == IREE_HAL_COLLECTIVE_KIND_BROADCAST ||
+          channel->rank == root) {
+        recv_length = length;
+      }
+      break;
+    case IREE_HAL_COLLECTIVE_KIND_REDUCE_SCATTER:
+      send_length = length * channel->count;
+      recv_length = length;
+      break;
+    case IREE_HAL_COLLECTIVE_KIND_SEND:
+    case IREE_HAL_COLLECTIVE_KIND_RECV:
+      return iree_make_status(
+          IREE_STATUS_UNIMPLEMENTED,
+          "point-to-point collectives are not supported on local channels");
+    default:
+      return iree_make_status(IREE_STATUS_UNIMPLEMENTED,
+                              "unhandled collective kind %u", op.kind);
+  }
+  if (element_count == 0) return iree_ok_status();
+  if ((send_length && !send_binding.buffer) ||
+      (recv_length && !recv_binding.buffer &&
+       op.kind != IREE_HAL_COLLECTIVE_KIND_BROADCAST)) {
+    return iree_make_status(IREE_STATUS_INVALID_ARGUMENT,
+                            "collective kind %u requires send and receive "
+                            "buffers on rank %d",
+                            op.kind, channel->rank);
+  }
+
+  IREE_TRACE_ZONE_BEGIN(z0);
+  IREE_TRACE_ZONE_APPEND_VALUE(z0, op.kind);
+  IREE_TRACE_ZONE_APPEND_VALUE(z0, element_count);
+
+  iree_hal_buffer_mapping_t send_mapping;
+  iree_hal_buffer_mapping_t recv_mapping;
+  memset(&send_mapping, 0, sizeof(send_mapping));
+  memset(&recv_mapping, 0, sizeof(recv_mapping));
+  bool send_mapped = false;
+  bool recv_mapped = false;
+  iree_status_t status = iree_ok_status();
+  if (send_length) {
+    status = iree_hal_buffer_map_range(
+        send_binding.buffer, IREE_HAL_MAPPING_MODE_SCOPED,
+        IREE_HAL_MEMORY_ACCESS_READ, send_binding.offset, send_length,
+        &send_mapping);
+    send_mapped = iree_status_is_ok(status);
+  }
+  if (iree_status_is_ok(status) && recv_length && recv_binding.buffer) {
+    status = iree_hal_buffer_map_range(
+        recv_binding.buffer, IREE_HAL_MAPPING_MODE_SCOPED,
+        IREE_HAL_MEMORY_ACCESS_WRITE, recv_binding.offset, recv_length,
+        &recv_mapping);
+    recv_mapped = iree_status_is_ok(status);
+  }
+
+  if (iree_status_is_ok(status)) {
+    iree_slim_mutex_lock(&channel->mutex);
+    status = iree_hal_local_channel_execute_rounds(
+        channel, op, root, element_size, send_mapping.contents.data,
+        recv_mapping.contents.data, (iree_host_size_t)element_count);
+    iree_slim_mutex_unlock(&channel->mutex);
+  }
+
+  if (recv_mapped) {
+    status =
+        iree_status_join(status, iree_hal_buffer_unmap_range(&recv_mapping));
+  }
+  if (send_mapped) {
+    status =
+        iree_status_join(status, iree_hal_buffer_unmap_range(&send_mapping));
+  }
+  IREE_TRACE_ZONE_END(z0);
+  return status;
+}
+
+iree_status_t iree_hal_local_channel_execute(
+    iree_hal_channel_t* base_channel, iree_hal_collective_op_t op,
+    uint32_t param, iree_hal_buffer_binding_t send_binding,
+    iree_hal_buffer_binding_t recv_binding, iree_device_size_t element_count) {
+  iree_hal_local_channel_t* channel =
+      iree_hal_local_channel_cast(base_channel);
+  IREE_RETURN_IF_ERROR(iree_hal_local_channel_query_abort(channel));
+  iree_status_t status = iree_hal_local_channel_execute_impl(
+      channel, op, param, send_binding, recv_binding, element_count);
+  if (!iree_status_is_ok(status)) {
+    // The other participants may be waiting on this one in a round it will
+    // never take part in (or have already failed themselves).
+    iree_hal_local_channel_abort(channel, iree_status_code(status));
+  }
+  return status;
+}
+
+static const iree_hal_channel_vtable_t iree_hal_local_channel_vtable = {
+    .destroy = iree_hal_local_channel_destroy,
+    .query_rank_and_count = iree_hal_local_channel_query_rank_and_count,
+};
@@ -0,0 +1,69 @@
+// Copyright 2023 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#ifndef IREE_HAL_LOCAL_LOCAL_CHANNEL_H_
+#define IREE_HAL_LOCAL_LOCAL_CHANNEL_H_
+
+#include "iree/base/api.h"
+#include "iree/hal/api.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif  // __cplusplus
+
+// Maximum number of participants in a local channel.
+#define IREE_HAL_LOCAL_CHANNEL_MAX_COUNT 64
+
+// Size in bytes of the staging slot each participant owns in the shared
+// segment. Collectives larger than a slot are performed in multiple rounds.
+#define IREE_HAL_LOCAL_CHANNEL_SLOT_SIZE (1 * 1024 * 1024)
+
+// Default maximum duration a participant waits on the others when joining a
+// channel and in each round of a collective.
+#define IREE_HAL_LOCAL_CHANNEL_DEFAULT_TIMEOUT (5 * 60 * 1000000000ll)
+
+// Creates a collective channel between |count| participants on the same host.
+// Participants may be devices in the same process or in different processes:
+// all that join with the same |id| and |count| and a unique |rank| in
+// [0, count) exchange data through a named shared memory segment.
+//
+// This is a blocking operation that returns once all |count| participants
+// have joined. Returns IREE_STATUS_UNAVAILABLE if the platform has no shared
+// memory support and |count| is greater than 1.
+//
+// |timeout| bounds each wait on the other participants, both while joining
+// and while waiting for them to reach the same round of a collective, and may
+// be IREE_DURATION_INFINITE. Timing out returns IREE_STATUS_DEADLINE_EXCEEDED
+// and aborts the channel.
+iree_status_t iree_hal_local_channel_create(iree_const_byte_span_t id,
+                                            int32_t rank, int32_t count,
+                                            iree_duration_t timeout,
+                                            iree_allocator_t host_allocator,
+                                            iree_hal_channel_t** out_channel);
+
+// Returns true if |channel| is a local channel.
+bool iree_hal_local_channel_isa(iree_hal_channel_t* channel);
+
+// Performs the collective |op| on |channel| and blocks until this participant
+// has its results. Arguments match iree_hal_command_buffer_collective.
+//
+// All participants must issue the same sequence of collectives on the channel.
+// Operations from multiple threads on the same channel are serialized.
+// Point-to-point SEND/RECV operations are not supported.
+//
+// If the collective fails on any participant the channel is aborted: other
+// participants waiting on it return IREE_STATUS_ABORTED instead of blocking
+// and all further collectives on the channel fail.
+iree_status_t iree_hal_local_channel_execute(
+    iree_hal_channel_t* channel, iree_hal_collective_op_t op, uint32_t param,
+    iree_hal_buffer_binding_t send_binding,
+    iree_hal_buffer_binding_t recv_binding, iree_device_size_t element_count);
+
+#ifdef __cplusplus
+}  // extern "C"
+#endif  // __cplusplus
+
+#endif  // IREE_HAL_LOCAL_LOCAL_CHANNEL_H_
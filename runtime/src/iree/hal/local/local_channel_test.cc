@@ -0,0 +1,361 @@
+// Copyright 2023 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include "iree/hal/local/local_channel.h"
+
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "iree/base/api.h"
+#include "iree/hal/api.h"
+#include "iree/testing/gtest.h"
+#include "iree/testing/status_matchers.h"
+
+namespace {
+
+using iree::Status;
+using iree::StatusCode;
+using iree::testing::status::StatusIs;
+
+class LocalChannelTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    IREE_ASSERT_OK(iree_hal_allocator_create_heap(
+        iree_make_cstring_view("heap"), iree_allocator_system(),
+        iree_allocator_system(), &device_allocator_));
+  }
+
+  void TearDown() override { iree_hal_allocator_release(device_allocator_); }
+
+  // Returns a channel ID unique to the current test and run so that segments
+  // left behind by a crashed run can't interfere.
+  static std::string MakeChannelId() {
+    const ::testing::TestInfo* test_info =
+        ::testing::UnitTest::GetInstance()->current_test_info();
+    return std::string("local_channel_test.") + test_info->name() + "." +
+           std::to_string(iree_time_now());
+  }
+
+  // Runs |fn| on |count| threads that each join a channel as one rank and
+  // returns the status of each rank.
+  std::vector<Status> RunParticipants(
+      int32_t count, iree_duration_t timeout,
+      std::function<iree_status_t(int32_t rank, iree_hal_channel_t* channel)>
+          fn) {
+    const std::string id = MakeChannelId();
+    std::vector<Status> statuses(count);
+    std::vector<std::thread> threads;
+    for (int32_t rank = 0; rank < count; ++rank) {
+      threads.emplace_back([&, rank]() {
+        iree_hal_channel_t* channel = NULL;
+        iree_status_t status = iree_hal_local_channel_create(
+            iree_make_const_byte_span(id.data(), id.size()), rank, count,
+            timeout, iree_allocator_system(), &channel);
+        if (iree_status_is_ok(status)) {
+          status = fn(rank, channel);
+          iree_hal_channel_release(channel);
+        }
+        statuses[rank] = Status(std::move(status));
+      });
+    }
+    for (auto& thread : threads) thread.join();
+    return statuses;
+  }
+
+  // Allocates a buffer initialized with |contents|.
+  iree_hal_buffer_t* AllocateBuffer(const std::vector<float>& contents) {
+    iree_hal_buffer_params_t params = {0};
+    params.type =
+        IREE_HAL_MEMORY_TYPE_HOST_LOCAL | IREE_HAL_MEMORY_TYPE_DEVICE_VISIBLE;
+    params.usage = IREE_HAL_BUFFER_USAGE_DEFAULT;
+    iree_hal_buffer_t* buffer = NULL;
+    IREE_CHECK_OK(iree_hal_allocator_allocate_buffer(
+        device_allocator_, params, contents.size() * sizeof(float),
+        iree_make_const_byte_span(contents.data(),
+                                  contents.size() * sizeof(float)),
+        &buffer));
+    return buffer;
+  }
+
+  static std::vector<float> ReadBuffer(iree_hal_buffer_t* buffer) {
+    std::vector<float> contents(iree_hal_buffer_byte_length(buffer) /
+                                sizeof(float));
+    IREE_CHECK_OK(iree_hal_buffer_map_read(buffer, 0, contents.data(),
+                                           contents.size() * sizeof(float)));
+    return contents;
+  }
+
+  static iree_hal_buffer_binding_t MakeBinding(iree_hal_buffer_t* buffer) {
+    iree_hal_buffer_binding_t binding = {0};
+    binding.buffer = buffer;
+    binding.offset = 0;
+    binding.length = IREE_WHOLE_BUFFER;
+    return binding;
+  }
+
+  static iree_hal_collective_op_t MakeOp(
+      iree_hal_collective_kind_t kind,
+      iree_hal_collective_reduction_t reduction =
+          IREE_HAL_COLLECTIVE_REDUCTION_SUM) {
+    iree_hal_collective_op_t op = {0};
+    op.kind = kind;
+    op.reduction = reduction;
+    op.element_type = IREE_HAL_COLLECTIVE_ELEMENT_TYPE_FLOAT_32;
+    return op;
+  }
+
+  // Skips the test if the first rank failed because multiple participants are
+  // unsupported on the platform.
+  static bool IsUnavailable(const std::vector<Status>& statuses) {
+    return statuses[0].code() == StatusCode::kUnavailable;
+  }
+
+  iree_hal_allocator_t* device_allocator_ = NULL;
+};
+
+#define SKIP_IF_UNAVAILABLE(statuses)                                      \
+  if (IsUnavailable(statuses)) {                                           \
+    GTEST_SKIP() << "shared memory channels unavailable on this platform"; \
+  }
+
+// A single participant needs no shared memory and reduces its own data.
+TEST_F(LocalChannelTest, SingleParticipant) {
+  iree_hal_channel_t* channel = NULL;
+  IREE_ASSERT_OK(iree_hal_local_channel_create(
+      iree_const_byte_span_empty(), /*rank=*/0, /*count=*/1,
+      IREE_DURATION_INFINITE, iree_allocator_system(), &channel));
+  iree_hal_buffer_t* send = AllocateBuffer({1.0f, 2.0f, 3.0f});
+  iree_hal_buffer_t* recv = AllocateBuffer({0.0f, 0.0f, 0.0f});
+  IREE_ASSERT_OK(iree_hal_local_channel_execute(
+      channel,
+      MakeOp(IREE_HAL_COLLECTIVE_KIND_ALL_REDUCE,
+             IREE_HAL_COLLECTIVE_REDUCTION_SUM),
+      /*param=*/0, MakeBinding(send), MakeBinding(recv), 3));
+  EXPECT_EQ(ReadBuffer(recv), (std::vector<float>{1.0f, 2.0f, 3.0f}));
+  iree_hal_buffer_release(recv);
+  iree_hal_buffer_release(send);
+  iree_hal_channel_release(channel);
+}
+
+TEST_F(LocalChannelTest, AllReduce) {
+  static constexpr int32_t kCount = 4;
+  std::vector<std::vector<float>> results(kCount);
+  auto statuses = RunParticipants(
+      kCount, IREE_DURATION_INFINITE,
+      [&](int32_t rank, iree_hal_channel_t* channel) {
+        iree_hal_buffer_t* send =
+            AllocateBuffer({(float)rank, 10.0f * rank, 1.0f});
+        iree_hal_buffer_t* recv = AllocateBuffer({0.0f, 0.0f, 0.0f});
+        iree_status_t status = iree_hal_local_channel_execute(
+            channel,
+            MakeOp(IREE_HAL_COLLECTIVE_KIND_ALL_REDUCE,
+                   IREE_HAL_COLLECTIVE_REDUCTION_SUM),
+            /*param=*/0, MakeBinding(send), MakeBinding(recv), 3);
+        results[rank] = ReadBuffer(recv);
+        iree_hal_buffer_release(recv);
+        iree_hal_buffer_release(send);
+        return status;
+      });
+  SKIP_IF_UNAVAILABLE(statuses);
+  for (int32_t rank = 0; rank < kCount; ++rank) {
+    IREE_EXPECT_OK(statuses[rank]);
+    EXPECT_EQ(results[rank], (std::vector<float>{6.0f, 60.0f, 4.0f}));
+  }
+}
+
+TEST_F(LocalChannelTest, AllGather) {
+  static constexpr int32_t kCount = 3;
+  std::vector<std::vector<float>> results(kCount);
+  auto statuses = RunParticipants(
+      kCount, IREE_DURATION_INFINITE,
+      [&](int32_t rank, iree_hal_channel_t* channel) {
+        iree_hal_buffer_t* send =
+            AllocateBuffer({(float)rank, (float)rank + 0.5f});
+        iree_hal_buffer_t* recv =
+            AllocateBuffer(std::vector<float>(2 * kCount, 0.0f));
+        iree_status_t status = iree_hal_local_channel_execute(
+            channel, MakeOp(IREE_HAL_COLLECTIVE_KIND_ALL_GATHER),
+            /*param=*/0, MakeBinding(send), MakeBinding(recv), 2);
+        results[rank] = ReadBuffer(recv);
+        iree_hal_buffer_release(recv);
+        iree_hal_buffer_release(send);
+        return status;
+      });
+  SKIP_IF_UNAVAILABLE(statuses);
+  for (int32_t rank = 0; rank < kCount; ++rank) {
+    IREE_EXPECT_OK(statuses[rank]);
+    EXPECT_EQ(results[rank],
+              (std::vector<float>{0.0f, 0.5f, 1.0f, 1.5f, 2.0f, 2.5f}));
+  }
+}
+
+TEST_F(LocalChannelTest, ReduceScatter) {
+  static constexpr int32_t kCount = 2;
+  std::vector<std::vector<float>> results(kCount);
+  auto statuses = RunParticipants(
+      kCount, IREE_DURATION_INFINITE,
+      [&](int32_t rank, iree_hal_channel_t* channel) {
+        // Rank r sends [r+1, r+2, r+3, r+4] and rank i receives the sum of
+        // block i of every rank.
+        const float base = (float)rank;
+        iree_hal_buffer_t* send = AllocateBuffer(
+            {base + 1.0f, base + 2.0f, base + 3.0f, base + 4.0f});
+        iree_hal_buffer_t* recv = AllocateBuffer({0.0f, 0.0f});
+        iree_status_t status = iree_hal_local_channel_execute(
+            channel,
+            MakeOp(IREE_HAL_COLLECTIVE_KIND_REDUCE_SCATTER,
+                   IREE_HAL_COLLECTIVE_REDUCTION_SUM),
+            /*param=*/0, MakeBinding(send), MakeBinding(recv), 2);
+        results[rank] = ReadBuffer(recv);
+        iree_hal_buffer_release(recv);
+        iree_hal_buffer_release(send);
+        return status;
+      });
+  SKIP_IF_UNAVAILABLE(statuses);
+  IREE_EXPECT_OK(statuses[0]);
+  IREE_EXPECT_OK(statuses[1]);
+  EXPECT_EQ(results[0], (std::vector<float>{3.0f, 5.0f}));
+  EXPECT_EQ(results[1], (std::vector<float>{7.0f, 9.0f}));
+}
+
+TEST_F(LocalChannelTest, Broadcast) {
+  static constexpr int32_t kCount = 3;
+  static constexpr int32_t kRoot = 1;
+  std::vector<std::vector<float>> results(kCount);
+  auto statuses = RunParticipants(
+      kCount, IREE_DURATION_INFINITE,
+      [&](int32_t rank, iree_hal_channel_t* channel) {
+        iree_hal_buffer_t* send = AllocateBuffer({7.0f, 8.0f});
+        iree_hal_buffer_t* recv = AllocateBuffer({0.0f, 0.0f});
+        iree_status_t status = iree_hal_local_channel_execute(
+            channel, MakeOp(IREE_HAL_COLLECTIVE_KIND_BROADCAST), kRoot,
+            rank == kRoot ? MakeBinding(send) : iree_hal_buffer_binding_t{},
+            MakeBinding(recv), 2);
+        results[rank] = ReadBuffer(recv);
+        iree_hal_buffer_release(recv);
+        iree_hal_buffer_release(send);
+        return status;
+      });
+  SKIP_IF_UNAVAILABLE(statuses);
+  for (int32_t rank = 0; rank < kCount; ++rank) {
+    IREE_EXPECT_OK(statuses[rank]);
+    EXPECT_EQ(results[rank], (std::vector<float>{7.0f, 8.0f}));
+  }
+}
+
+// Payloads larger than a slot are exchanged over multiple rounds.
+TEST_F(LocalChannelTest, AllReduceLargerThanSlot) {
+  static constexpr int32_t kCount = 2;
+  static constexpr iree_host_size_t kElementCount =
+      (IREE_HAL_LOCAL_CHANNEL_SLOT_SIZE / sizeof(float)) * 2 + 123;
+  std::vector<bool> matches(kCount, false);
+  auto statuses = RunParticipants(
+      kCount, IREE_DURATION_INFINITE,
+      [&](int32_t rank, iree_hal_channel_t* channel) {
+        std::vector<float> contents(kElementCount);
+        for (iree_host_size_t i = 0; i < kElementCount; ++i) {
+          contents[i] = (float)((i % 1000) * (rank + 1));
+        }
+        iree_hal_buffer_t* send = AllocateBuffer(contents);
+        iree_hal_buffer_t* recv =
+            AllocateBuffer(std::vector<float>(kElementCount, 0.0f));
+        iree_status_t status = iree_hal_local_channel_execute(
+            channel,
+            MakeOp(IREE_HAL_COLLECTIVE_KIND_ALL_REDUCE,
+                   IREE_HAL_COLLECTIVE_REDUCTION_SUM),
+            /*param=*/0, MakeBinding(send), MakeBinding(recv), kElementCount);
+        std::vector<float> result = ReadBuffer(recv);
+        bool match = true;
+        for (iree_host_size_t i = 0; i < kElementCount; ++i) {
+          match &= result[i] == (float)((i % 1000) * 3);
+        }
+        matches[rank] = match;
+        iree_hal_buffer_release(recv);
+        iree_hal_buffer_release(send);
+        return status;
+      });
+  SKIP_IF_UNAVAILABLE(statuses);
+  for (int32_t rank = 0; rank < kCount; ++rank) {
+    IREE_EXPECT_OK(statuses[rank]);
+    EXPECT_TRUE(matches[rank]);
+  }
+}
+
+// A rank that fails locally aborts the channel instead of leaving the other
+// ranks waiting for it forever and all later collectives fail.
+TEST_F(LocalChannelTest, FailingRankAbortsChannel) {
+  static constexpr int32_t kCount = 2;
+  std::vector<Status> retry_statuses(kCount);
+  auto statuses = RunParticipants(
+      kCount, IREE_DURATION_INFINITE,
+      [&](int32_t rank, iree_hal_channel_t* channel) {
+        iree_hal_buffer_t* send = AllocateBuffer({1.0f, 2.0f});
+        // Rank 1 provides a receive buffer too small for the results.
+        iree_hal_buffer_t* recv =
+            AllocateBuffer(rank == 1 ? std::vector<float>{0.0f}
+                                     : std::vector<float>{0.0f, 0.0f});
+        const iree_hal_collective_op_t op =
+            MakeOp(IREE_HAL_COLLECTIVE_KIND_ALL_REDUCE,
+                   IREE_HAL_COLLECTIVE_REDUCTION_SUM);
+        iree_status_t status = iree_hal_local_channel_execute(
+            channel, op, /*param=*/0, MakeBinding(send), MakeBinding(recv), 2);
+        retry_statuses[rank] = Status(iree_hal_local_channel_execute(
+            channel, op, /*param=*/0, MakeBinding(send), MakeBinding(send),
+            2));
+        iree_hal_buffer_release(recv);
+        iree_hal_buffer_release(send);
+        return status;
+      });
+  SKIP_IF_UNAVAILABLE(statuses);
+  EXPECT_THAT(statuses[0], StatusIs(StatusCode::kAborted));
+  EXPECT_THAT(statuses[1], StatusIs(StatusCode::kOutOfRange));
+  EXPECT_THAT(retry_statuses[0], StatusIs(StatusCode::kAborted));
+  EXPECT_THAT(retry_statuses[1], StatusIs(StatusCode::kAborted));
+}
+
+// Joining fails once the timeout elapses if not all participants join.
+TEST_F(LocalChannelTest, JoinTimeout) {
+  const std::string id = MakeChannelId();
+  iree_hal_channel_t* channel = NULL;
+  Status status = iree_hal_local_channel_create(
+      iree_make_const_byte_span(id.data(), id.size()), /*rank=*/0,
+      /*count=*/2, /*timeout=*/50 * 1000000ll, iree_allocator_system(),
+      &channel);
+  if (status.code() == StatusCode::kUnavailable) {
+    GTEST_SKIP() << "shared memory channels unavailable on this platform";
+  }
+  EXPECT_THAT(status, StatusIs(StatusCode::kDeadlineExceeded));
+  EXPECT_EQ(channel, nullptr);
+}
+
+// A collective fails once the timeout elapses if another participant never
+// issues it.
+TEST_F(LocalChannelTest, RoundTimeout) {
+  static constexpr int32_t kCount = 2;
+  auto statuses = RunParticipants(
+      kCount, /*timeout=*/50 * 1000000ll,
+      [&](int32_t rank, iree_hal_channel_t* channel) {
+        if (rank != 0) return iree_ok_status();
+        iree_hal_buffer_t* send = AllocateBuffer({1.0f});
+        iree_hal_buffer_t* recv = AllocateBuffer({0.0f});
+        iree_status_t status = iree_hal_local_channel_execute(
+            channel,
+            MakeOp(IREE_HAL_COLLECTIVE_KIND_ALL_REDUCE,
+                   IREE_HAL_COLLECTIVE_REDUCTION_SUM),
+            /*param=*/0, MakeBinding(send), MakeBinding(recv), 1);
+        iree_hal_buffer_release(recv);
+        iree_hal_buffer_release(send);
+        return status;
+      });
+  SKIP_IF_UNAVAILABLE(statuses);
+  EXPECT_THAT(statuses[0], StatusIs(StatusCode::kDeadlineExceeded));
+  IREE_EXPECT_OK(statuses[1]);
+}
+
+}  // namespace
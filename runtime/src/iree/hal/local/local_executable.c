@@ -6,9 +6,372 @@
 
 #include "iree/hal/local/local_executable.h"
 
+#include "iree/base/internal/atomics.h"
+#include "iree/base/internal/call_once.h"
+#include "iree/base/internal/synchronization.h"
 #include "iree/base/tracing.h"
 #include "iree/hal/local/executable_environment.h"
 
+//===----------------------------------------------------------------------===//
+// Per-export statistics
+//===----------------------------------------------------------------------===//
+
+#if IREE_HAL_LOCAL_EXECUTABLE_STATISTICS_ENABLE
+
+// Counters for one export as recorded by one worker.
+typedef struct iree_hal_local_executable_counters_t {
+  iree_atomic_int64_t invocation_count;
+  iree_atomic_int64_t workgroup_count;
+  iree_atomic_int64_t total_duration_ns;
+  iree_atomic_int64_t max_duration_ns;
+} iree_hal_local_executable_counters_t;
+
+struct iree_hal_local_executable_statistics_t {
+  // Registry list links guarded by the registry mutex.
+  iree_hal_local_executable_statistics_t* prev;
+  iree_hal_local_executable_statistics_t* next;
+
+  iree_allocator_t host_allocator;
+  iree_string_view_t identifier;
+  iree_host_size_t export_count;
+  const char* const* export_names;
+
+  // Counters are stored worker-major with each worker's block of export
+  // counters starting on its own cache line so that workers never contend.
+  iree_host_size_t worker_capacity;
+  iree_host_size_t worker_stride;
+  iree_hal_local_executable_counters_t* counters;
+};
+
+// Whether executables loaded from now on record statistics.
+static iree_atomic_int32_t iree_hal_local_executable_statistics_enabled_ =
+    IREE_ATOMIC_VAR_INIT(0);
+
+// Process-wide list of all live executables with statistics.
+static struct {
+  iree_slim_mutex_t mutex;
+  iree_hal_local_executable_statistics_t* head IREE_GUARDED_BY(mutex);
+  iree_hal_local_executable_statistics_t* tail IREE_GUARDED_BY(mutex);
+} iree_hal_local_executable_registry_;
+static iree_once_flag iree_hal_local_executable_registry_flag_ =
+    IREE_ONCE_FLAG_INIT;
+static void iree_hal_local_executable_registry_initialize(void) {
+  memset(&iree_hal_local_executable_registry_, 0,
+         sizeof(iree_hal_local_executable_registry_));
+  iree_slim_mutex_initialize(&iree_hal_local_executable_registry_.mutex);
+}
+static iree_slim_mutex_t* iree_hal_local_executable_registry_mutex(void) {
+  iree_call_once(&iree_hal_local_executable_registry_flag_,
+                 iree_hal_local_executable_registry_initialize);
+  return &iree_hal_local_executable_registry_.mutex;
+}
+
+void iree_hal_local_executable_set_statistics_enabled(bool enabled) {
+  iree_atomic_store_int32(&iree_hal_local_executable_statistics_enabled_,
+                          enabled ? 1 : 0, iree_memory_order_relaxed);
+}
+
+static iree_status_t iree_hal_local_executable_statistics_allocate(
+    iree_string_view_t identifier, iree_host_size_t export_count,
+    const char* const* export_names, iree_host_size_t worker_capacity,
+    iree_allocator_t host_allocator,
+    iree_hal_local_executable_statistics_t** out_statistics) {
+  *out_statistics = NULL;
+  worker_capacity = iree_max(1, worker_capacity);
+  const iree_host_size_t counter_size =
+      sizeof(iree_hal_local_executable_counters_t);
+  const iree_host_size_t worker_stride =
+      iree_host_align(export_count * counter_size,
+                      iree_hardware_destructive_interference_size) /
+      counter_size;
+  const iree_host_size_t counters_offset =
+      iree_host_align(sizeof(iree_hal_local_executable_statistics_t),
+                      iree_hardware_destructive_interference_size);
+  iree_hal_local_executable_statistics_t* statistics = NULL;
+  IREE_RETURN_IF_ERROR(iree_allocator_malloc_aligned(
+      host_allocator,
+      counters_offset + worker_capacity * worker_stride * counter_size,
+      iree_hardware_destructive_interference_size, counters_offset,
+      (void**)&statistics));
+  statistics->host_allocator = host_allocator;
+  statistics->identifier = identifier;
+  statistics->export_count = export_count;
+  statistics->export_names = export_names;
+  statistics->worker_capacity = worker_capacity;
+  statistics->worker_stride = worker_stride;
+  statistics->counters =
+      (iree_hal_local_executable_counters_t*)((uint8_t*)statistics +
+                                              counters_offset);
+
+  iree_slim_mutex_t* mutex = iree_hal_local_executable_registry_mutex();
+  iree_slim_mutex_lock(mutex);
+  statistics->prev = iree_hal_local_executable_registry_.tail;
+  if (statistics->prev) {
+    statistics->prev->next = statistics;
+  } else {
+    iree_hal_local_executable_registry_.head = statistics;
+  }
+  iree_hal_local_executable_registry_.tail = statistics;
+  iree_slim_mutex_unlock(mutex);
+
+  *out_statistics = statistics;
+  return iree_ok_status();
+}
+
+static void iree_hal_local_executable_statistics_free(
+    iree_hal_local_executable_statistics_t* statistics) {
+  if (!statistics) return;
+  iree_slim_mutex_t* mutex = iree_hal_local_executable_registry_mutex();
+  iree_slim_mutex_lock(mutex);
+  if (statistics->prev) {
+    statistics->prev->next = statistics->next;
+  } else {
+    iree_hal_local_executable_registry_.head = statistics->next;
+  }
+  if (statistics->next) {
+    statistics->next->prev = statistics->prev;
+  } else {
+    iree_hal_local_executable_registry_.tail = statistics->prev;
+  }
+  iree_slim_mutex_unlock(mutex);
+  iree_allocator_free_aligned(statistics->host_allocator, statistics);
+}
+
+static void iree_hal_local_executable_statistics_record(
+    iree_hal_local_executable_statistics_t* statistics,
+    iree_host_size_t ordinal, uint32_t worker_id, uint32_t workgroup_count,
+    iree_duration_t duration_ns) {
+  if (IREE_UNLIKELY(ordinal >= statistics->export_count)) return;
+  iree_hal_local_executable_counters_t* counters =
+      &statistics->counters[(worker_id % statistics->worker_capacity) *
+                                statistics->worker_stride +
+                            ordinal];
+  // Workers only contend when inline execution shares worker IDs so relaxed
+  // atomics are sufficient and almost always uncontended.
+  iree_atomic_fetch_add_int64(&counters->invocation_count, 1,
+                              iree_memory_order_relaxed);
+  iree_atomic_fetch_add_int64(&counters->workgroup_count,
+                              iree_max(1, workgroup_count),
+                              iree_memory_order_relaxed);
+  iree_atomic_fetch_add_int64(&counters->total_duration_ns, duration_ns,
+                              iree_memory_order_relaxed);
+  int64_t max_duration_ns = iree_atomic_load_int64(&counters->max_duration_ns,
+                                                   iree_memory_order_relaxed);
+  while (duration_ns > max_duration_ns &&
+         !iree_atomic_compare_exchange_weak_int64(
+             &counters->max_duration_ns, &max_duration_ns, duration_ns,
+             iree_memory_order_relaxed, iree_memory_order_relaxed)) {
+  }
+}
+
+static void iree_hal_local_executable_statistics_aggregate(
+    iree_hal_local_executable_statistics_t* statistics,
+    iree_host_size_t ordinal,
+    iree_hal_local_executable_export_statistics_t* out_statistics) {
+  memset(out_statistics, 0, sizeof(*out_statistics));
+  for (iree_host_size_t i = 0; i < statistics->worker_capacity; ++i) {
+    iree_hal_local_executable_counters_t* counters =
+        &statistics->counters[i * statistics->worker_stride + ordinal];
+    out_statistics->invocation_count += (uint64_t)iree_atomic_load_int64(
+        &counters->invocation_count, iree_memory_order_relaxed);
+    out_statistics->workgroup_count += (uint64_t)iree_atomic_load_int64(
+        &counters->workgroup_count, iree_memory_order_relaxed);
+    out_statistics->total_duration_ns += iree_atomic_load_int64(
+        &counters->total_duration_ns, iree_memory_order_relaxed);
+    out_statistics->max_duration_ns = iree_max(
+        out_statistics->max_duration_ns,
+        iree_atomic_load_int64(&counters->max_duration_ns,
+                               iree_memory_order_relaxed));
+  }
+}
+
+iree_status_t iree_hal_local_executable_query_export_statistics(
+    iree_hal_local_executable_t* executable, iree_host_size_t ordinal,
+    iree_hal_local_executable_export_statistics_t* out_statistics) {
+  IREE_ASSERT_ARGUMENT(executable);
+  IREE_ASSERT_ARGUMENT(out_statistics);
+  memset(out_statistics, 0, sizeof(*out_statistics));
+  if (!executable->statistics) {
+    return iree_make_status(IREE_STATUS_UNAVAILABLE,
+                            "executable loaded without statistics enabled");
+  } else if (ordinal >= executable->statistics->export_count) {
+    return iree_make_status(IREE_STATUS_OUT_OF_RANGE,
+                            "export ordinal %zu out of range (%zu exports)",
+                            ordinal, executable->statistics->export_count);
+  }
+  iree_hal_local_executable_statistics_aggregate(executable->statistics,
+                                                 ordinal, out_statistics);
+  return iree_ok_status();
+}
+
+iree_status_t iree_hal_local_executable_statistics_enumerate(
+    iree_hal_local_executable_statistics_fn_t fn, void* user_data) {
+  IREE_ASSERT_ARGUMENT(fn);
+  iree_status_t status = iree_ok_status();
+  iree_slim_mutex_t* mutex = iree_hal_local_executable_registry_mutex();
+  iree_slim_mutex_lock(mutex);
+  for (iree_hal_local_executable_statistics_t* statistics =
+           iree_hal_local_executable_registry_.head;
+       statistics && iree_status_is_ok(status); statistics = statistics->next) {
+    for (iree_host_size_t i = 0; i < statistics->export_count; ++i) {
+      iree_hal_local_executable_export_statistics_t export_statistics;
+      iree_hal_local_executable_statistics_aggregate(statistics, i,
+                                                     &export_statistics);
+      if (!export_statistics.invocation_count) continue;
+      iree_string_view_t export_name =
+          statistics->export_names && statistics->export_names[i]
+              ? iree_make_cstring_view(statistics->export_names[i])
+              : iree_string_view_empty();
+      status = fn(user_data, statistics->identifier, i, export_name,
+                  &export_statistics);
+      if (!iree_status_is_ok(status)) break;
+    }
+  }
+  iree_slim_mutex_unlock(mutex);
+  return status;
+}
+
+#else
+
+void iree_hal_local_executable_set_statistics_enabled(bool enabled) {}
+
+iree_status_t iree_hal_local_executable_query_export_statistics(
+    iree_hal_local_executable_t* executable, iree_host_size_t ordinal,
+    iree_hal_local_executable_export_statistics_t* out_statistics) {
+  memset(out_statistics, 0, sizeof(*out_statistics));
+  return iree_make_status(IREE_STATUS_UNAVAILABLE,
+                          "executable statistics not compiled in");
+}
+
+iree_status_t iree_hal_local_executable_statistics_enumerate(
+    iree_hal_local_executable_statistics_fn_t fn, void* user_data) {
+  return iree_ok_status();
+}
+
+#endif  // IREE_HAL_LOCAL_EXECUTABLE_STATISTICS_ENABLE
+
+// Emits one Prometheus series per export into the builder in |user_data|.
+typedef struct iree_hal_local_executable_prometheus_state_t {
+  iree_string_builder_t* builder;
+  // Name of the metric family being emitted.
+  const char* name;
+  // Selects which statistic of the family is emitted.
+  int field;
+} iree_hal_local_executable_prometheus_state_t;
+
+static iree_status_t iree_hal_local_executable_append_prometheus_series(
+    void* user_data, iree_string_view_t executable_identifier,
+    iree_host_size_t ordinal, iree_string_view_t export_name,
+    const iree_hal_local_executable_export_statistics_t* statistics) {
+  iree_hal_local_executable_prometheus_state_t* state =
+      (iree_hal_local_executable_prometheus_state_t*)user_data;
+  int64_t value = 0;
+  switch (state->field) {
+    case 0:
+      value = (int64_t)statistics->invocation_count;
+      break;
+    case 1:
+      value = (int64_t)statistics->workgroup_count;
+      break;
+    case 2:
+      value = statistics->total_duration_ns;
+      break;
+    default:
+      value = statistics->max_duration_ns;
+      break;
+  }
+  if (iree_string_view_is_empty(export_name)) {
+    return iree_string_builder_append_format(
+        state->builder, "%s{executable=\"%.*s\",export=\"%zu\"} %" PRId64 "\n",
+        state->name, (int)executable_identifier.size,
+        executable_identifier.data, ordinal, value);
+  }
+  return iree_string_builder_append_format(
+      state->builder, "%s{executable=\"%.*s\",export=\"%.*s\"} %" PRId64 "\n",
+      state->name, (int)executable_identifier.size, executable_identifier.data,
+      (int)export_name.size, export_name.data, value);
+}
+
+iree_status_t iree_hal_local_executable_statistics_append_prometheus(
+    iree_string_builder_t* builder) {
+  IREE_ASSERT_ARGUMENT(builder);
+  static const struct {
+    const char* name;
+    const char* help;
+    const char* type;
+  } families[] = {
+      {"iree_hal_executable_export_invocations_total",
+       "Calls made into an executable export.", "counter"},
+      {"iree_hal_executable_export_workgroups_total",
+       "Workgroups processed by an executable export.", "counter"},
+      {"iree_hal_executable_export_duration_ns_total",
+       "Cumulative time spent in an executable export.", "counter"},
+      {"iree_hal_executable_export_duration_ns_max",
+       "Longest single call into an executable export.", "gauge"},
+  };
+  for (int i = 0; i < (int)IREE_ARRAYSIZE(families); ++i) {
+    // Only emit the family header if there are any series as Prometheus
+    // consumers reject families without samples.
+    iree_host_size_t header_offset = iree_string_builder_size(builder);
+    IREE_RETURN_IF_ERROR(iree_string_builder_append_format(
+        builder, "# HELP %s %s\n# TYPE %s %s\n", families[i].name,
+        families[i].help, families[i].name, families[i].type));
+    iree_host_size_t series_offset = iree_string_builder_size(builder);
+    iree_hal_local_executable_prometheus_state_t state = {
+        .builder = builder,
+        .name = families[i].name,
+        .field = i,
+    };
+    IREE_RETURN_IF_ERROR(iree_hal_local_executable_statistics_enumerate(
+        iree_hal_local_executable_append_prometheus_series, &state));
+    if (iree_string_builder_size(builder) == series_offset) {
+      builder->size = header_offset;
+    }
+  }
+  return iree_ok_status();
+}
+
+static iree_status_t iree_hal_local_executable_fprint_export(
+    void* user_data, iree_string_view_t executable_identifier,
+    iree_host_size_t ordinal, iree_string_view_t export_name,
+    const iree_hal_local_executable_export_statistics_t* statistics) {
+  FILE* file = (FILE*)user_data;
+  char ordinal_str[24];
+  if (iree_string_view_is_empty(export_name)) {
+    int length = snprintf(ordinal_str, sizeof(ordinal_str), "#%zu", ordinal);
+    export_name = iree_make_string_view(ordinal_str, (iree_host_size_t)length);
+  }
+  fprintf(file,
+          "%-48.*s %12" PRIu64 " %12" PRIu64 " %12.3f %12.3f %10.3f  %.*s\n",
+          (int)export_name.size, export_name.data,
+          statistics->invocation_count, statistics->workgroup_count,
+          statistics->total_duration_ns / 1000000.0,
+          statistics->total_duration_ns /
+              (1000.0 * iree_max(1, statistics->invocation_count)),
+          statistics->max_duration_ns / 1000.0,
+          (int)executable_identifier.size, executable_identifier.data);
+  return iree_ok_status();
+}
+
+iree_status_t iree_hal_local_executable_statistics_fprint(FILE* file) {
+  IREE_ASSERT_ARGUMENT(file);
+#if IREE_HAL_LOCAL_EXECUTABLE_STATISTICS_ENABLE
+  fprintf(file,
+          "[[ iree_hal_local_executable statistics ]]\n"
+          "%-48s %12s %12s %12s %12s %10s  %s\n",
+          "EXPORT", "CALLS", "WORKGROUPS", "TOTAL (ms)", "AVG (us)",
+          "MAX (us)", "EXECUTABLE");
+  return iree_hal_local_executable_statistics_enumerate(
+      iree_hal_local_executable_fprint_export, file);
+#else
+  return iree_ok_status();
+#endif  // IREE_HAL_LOCAL_EXECUTABLE_STATISTICS_ENABLE
+}
+
+//===----------------------------------------------------------------------===//
+// iree_hal_local_executable_t
+//===----------------------------------------------------------------------===//
+
 void iree_hal_local_executable_initialize(
     const iree_hal_local_executable_vtable_t* vtable,
     iree_host_size_t pipeline_layout_count,
@@ -32,16 +395,42 @@ void iree_hal_local_executable_initialize(
   // Default environment with no imports assigned.
   iree_hal_executable_environment_initialize(host_allocator,
                                              &out_base_executable->environment);
+
+  // Statistics are optional and allocated by the parent type.
+  out_base_executable->statistics = NULL;
 }
 
 void iree_hal_local_executable_deinitialize(
     iree_hal_local_executable_t* base_executable) {
+#if IREE_HAL_LOCAL_EXECUTABLE_STATISTICS_ENABLE
+  iree_hal_local_executable_statistics_free(base_executable->statistics);
+  base_executable->statistics = NULL;
+#endif  // IREE_HAL_LOCAL_EXECUTABLE_STATISTICS_ENABLE
   for (iree_host_size_t i = 0; i < base_executable->pipeline_layout_count;
        ++i) {
     iree_hal_pipeline_layout_release(base_executable->pipeline_layouts[i]);
   }
 }
 
+iree_status_t iree_hal_local_executable_initialize_statistics(
+    iree_hal_local_executable_t* base_executable,
+    iree_string_view_t identifier, iree_host_size_t export_count,
+    const char* const* export_names, iree_host_size_t worker_capacity) {
+  IREE_ASSERT_ARGUMENT(base_executable);
+#if IREE_HAL_LOCAL_EXECUTABLE_STATISTICS_ENABLE
+  if (base_executable->statistics || export_count == 0 ||
+      !iree_atomic_load_int32(&iree_hal_local_executable_statistics_enabled_,
+                              iree_memory_order_relaxed)) {
+    return iree_ok_status();
+  }
+  return iree_hal_local_executable_statistics_allocate(
+      identifier, export_count, export_names, worker_capacity,
+      base_executable->host_allocator, &base_executable->statistics);
+#else
+  return iree_ok_status();
+#endif  // IREE_HAL_LOCAL_EXECUTABLE_STATISTICS_ENABLE
+}
+
 iree_hal_local_executable_t* iree_hal_local_executable_cast(
     iree_hal_executable_t* base_value) {
   return (iree_hal_local_executable_t*)base_value;
@@ -55,10 +444,72 @@ iree_status_t iree_hal_local_executable_issue_call(
   IREE_ASSERT_ARGUMENT(executable);
   IREE_ASSERT_ARGUMENT(dispatch_state);
   IREE_ASSERT_ARGUMENT(workgroup_state);
-  return ((const iree_hal_local_executable_vtable_t*)
-              executable->resource.vtable)
-      ->issue_call(executable, ordinal, dispatch_state, workgroup_state,
-                   worker_id);
+  const iree_hal_local_executable_vtable_t* vtable =
+      (const iree_hal_local_executable_vtable_t*)executable->resource.vtable;
+#if IREE_HAL_LOCAL_EXECUTABLE_STATISTICS_ENABLE
+  if (executable->statistics) {
+    const iree_time_t start_ns = iree_time_now();
+    iree_status_t status = vtable->issue_call(
+        executable, ordinal, dispatch_state, workgroup_state, worker_id);
+    iree_hal_local_executable_statistics_record(
+        executable->statistics, ordinal, worker_id,
+        workgroup_state->workgroup_range_count, iree_time_now() - start_ns);
+    return status;
+  }
+#endif  // IREE_HAL_LOCAL_EXECUTABLE_STATISTICS_ENABLE
+  return vtable->issue_call(executable, ordinal, dispatch_state,
+                            workgroup_state, worker_id);
+}
+
+iree_status_t iree_hal_local_executable_issue_call_range(
+    iree_hal_local_executable_t* executable, iree_host_size_t ordinal,
+    const iree_hal_executable_dispatch_state_v0_t* dispatch_state,
+    const iree_hal_executable_workgroup_state_v0_t* workgroup_state,
+    uint32_t workgroup_count, uint32_t worker_id) {
+  iree_alignas(64) iree_hal_executable_workgroup_state_v0_t range_state;
+  memcpy(&range_state, workgroup_state, sizeof(range_state));
+
+  // Entry points that handle ranges themselves get the whole range in a
+  // single call.
+  if (executable->dispatch_attrs &&
+      iree_all_bits_set(executable->dispatch_attrs[ordinal].flags,
+                        IREE_HAL_EXECUTABLE_DISPATCH_FLAG_WORKGROUP_RANGE)) {
+    range_state.workgroup_range_count = workgroup_count;
+    return iree_hal_local_executable_issue_call(
+        executable, ordinal, dispatch_state, &range_state, worker_id);
+  }
+
+  // Call once per workgroup, stepping through the grid in x-major order.
+  range_state.workgroup_range_count = 1;
+  for (uint32_t i = 0; i < workgroup_count; ++i) {
+    IREE_RETURN_IF_ERROR(iree_hal_local_executable_issue_call(
+        executable, ordinal, dispatch_state, &range_state, worker_id));
+    if (++range_state.workgroup_id_x == dispatch_state->workgroup_count_x) {
+      range_state.workgroup_id_x = 0;
+      if (++range_state.workgroup_id_y == dispatch_state->workgroup_count_y) {
+        range_state.workgroup_id_y = 0;
+        ++range_state.workgroup_id_z;
+      }
+    }
+  }
+  return iree_ok_status();
+}
+
+iree_fpu_state_flags_t iree_hal_local_executable_fpu_state_flags(
+    iree_hal_local_executable_t* executable, iree_host_size_t ordinal) {
+  iree_fpu_state_flags_t flags = IREE_FPU_STATE_FLAG_FLUSH_DENORMALS_TO_ZERO;
+  if (!executable->dispatch_attrs) return flags;
+  const iree_hal_executable_dispatch_flags_v0_t dispatch_flags =
+      executable->dispatch_attrs[ordinal].flags;
+  if (dispatch_flags &
+      IREE_HAL_EXECUTABLE_DISPATCH_FLAG_PRESERVE_DENORMAL_RESULTS) {
+    flags &= ~IREE_FPU_STATE_FLAG_FLUSH_TO_ZERO;
+  }
+  if (dispatch_flags &
+      IREE_HAL_EXECUTABLE_DISPATCH_FLAG_PRESERVE_DENORMAL_INPUTS) {
+    flags &= ~IREE_FPU_STATE_FLAG_DENORMALS_ARE_ZERO;
+  }
+  return flags;
 }
 
 iree_status_t iree_hal_local_executable_issue_dispatch_inline(
@@ -89,7 +540,28 @@ iree_status_t iree_hal_local_executable_issue_dispatch_inline(
       .processor_id = processor_id,
       .local_memory = local_memory.data,
       .local_memory_size = (size_t)local_memory.data_length,
+      .workgroup_range_count = 1,
   };
+
+  // Entry points that handle ranges process each z slice in a single call.
+  // Slices are used instead of the entire grid so that the range count cannot
+  // overflow.
+  if (executable->dispatch_attrs &&
+      iree_all_bits_set(executable->dispatch_attrs[ordinal].flags,
+                        IREE_HAL_EXECUTABLE_DISPATCH_FLAG_WORKGROUP_RANGE) &&
+      (uint64_t)workgroup_count_x * workgroup_count_y <= UINT32_MAX) {
+    const uint32_t slice_count = workgroup_count_x * workgroup_count_y;
+    for (uint32_t z = 0; z < workgroup_count_z && slice_count > 0; ++z) {
+      workgroup_state.workgroup_id_z = z;
+      status = iree_hal_local_executable_issue_call_range(
+          executable, ordinal, dispatch_state, &workgroup_state, slice_count,
+          /*worker_id=*/0);
+      if (!iree_status_is_ok(status)) break;
+    }
+    IREE_TRACE_ZONE_END(z0);
+    return status;
+  }
+
   for (uint32_t z = 0; z < workgroup_count_z; ++z) {
     workgroup_state.workgroup_id_z = z;
     for (uint32_t y = 0; y < workgroup_count_y; ++y) {
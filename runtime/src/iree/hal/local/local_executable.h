@@ -7,7 +7,10 @@
 #ifndef IREE_HAL_LOCAL_LOCAL_EXECUTABLE_H_
 #define IREE_HAL_LOCAL_LOCAL_EXECUTABLE_H_
 
+#include <stdio.h>
+
 #include "iree/base/api.h"
+#include "iree/base/internal/fpu_state.h"
 #include "iree/hal/api.h"
 #include "iree/hal/local/executable_library.h"
 
@@ -15,6 +18,16 @@
 extern "C" {
 #endif  // __cplusplus
 
+// Per-export execution statistics are compiled in by default when statistics
+// are enabled. They are still only recorded on executables loaded after
+// iree_hal_local_executable_set_statistics_enabled(true).
+#if !defined(IREE_HAL_LOCAL_EXECUTABLE_STATISTICS_ENABLE)
+#define IREE_HAL_LOCAL_EXECUTABLE_STATISTICS_ENABLE IREE_STATISTICS_ENABLE
+#endif  // !IREE_HAL_LOCAL_EXECUTABLE_STATISTICS_ENABLE
+
+typedef struct iree_hal_local_executable_statistics_t
+    iree_hal_local_executable_statistics_t;
+
 typedef struct iree_hal_local_executable_t {
   iree_hal_resource_t resource;
   iree_allocator_t host_allocator;
@@ -37,6 +50,10 @@ typedef struct iree_hal_local_executable_t {
 
   // Execution environment.
   iree_hal_executable_environment_v0_t environment;
+
+  // Optional per-export execution statistics. NULL if not enabled when the
+  // executable was loaded.
+  iree_hal_local_executable_statistics_t* statistics;
 } iree_hal_local_executable_t;
 
 typedef struct iree_hal_local_executable_vtable_t {
@@ -64,6 +81,16 @@ void iree_hal_local_executable_initialize(
 void iree_hal_local_executable_deinitialize(
     iree_hal_local_executable_t* base_executable);
 
+// Allocates per-export statistics for |base_executable| if statistics are
+// enabled and otherwise no-ops. Called by loaders once the exports are known.
+// |identifier| and the optional |export_names| table must remain valid for the
+// lifetime of the executable. Counters are kept per worker in
+// [0, |worker_capacity|) to avoid contention.
+iree_status_t iree_hal_local_executable_initialize_statistics(
+    iree_hal_local_executable_t* base_executable,
+    iree_string_view_t identifier, iree_host_size_t export_count,
+    const char* const* export_names, iree_host_size_t worker_capacity);
+
 iree_hal_local_executable_t* iree_hal_local_executable_cast(
     iree_hal_executable_t* base_value);
 
@@ -73,11 +100,81 @@ iree_status_t iree_hal_local_executable_issue_call(
     const iree_hal_executable_workgroup_state_v0_t* workgroup_state,
     uint32_t worker_id);
 
+// Issues calls to |ordinal| for |workgroup_count| consecutive workgroups
+// starting at the workgroup ID in |workgroup_state| (ordered with x varying
+// fastest). Entry points declaring
+// IREE_HAL_EXECUTABLE_DISPATCH_FLAG_WORKGROUP_RANGE are called once for the
+// entire range and all others are called once per workgroup.
+iree_status_t iree_hal_local_executable_issue_call_range(
+    iree_hal_local_executable_t* executable, iree_host_size_t ordinal,
+    const iree_hal_executable_dispatch_state_v0_t* dispatch_state,
+    const iree_hal_executable_workgroup_state_v0_t* workgroup_state,
+    uint32_t workgroup_count, uint32_t worker_id);
+
 iree_status_t iree_hal_local_executable_issue_dispatch_inline(
     iree_hal_local_executable_t* executable, iree_host_size_t ordinal,
     const iree_hal_executable_dispatch_state_v0_t* dispatch_state,
     uint32_t processor_id, iree_byte_span_t local_memory);
 
+// Returns the FPU state export |ordinal| of |executable| must run with.
+// Denormals are flushed unless the export declares it needs them preserved
+// with IREE_HAL_EXECUTABLE_DISPATCH_FLAG_PRESERVE_DENORMAL_*.
+iree_fpu_state_flags_t iree_hal_local_executable_fpu_state_flags(
+    iree_hal_local_executable_t* executable, iree_host_size_t ordinal);
+
+//===----------------------------------------------------------------------===//
+// Per-export statistics
+//===----------------------------------------------------------------------===//
+
+// Aggregate execution statistics of a single executable export.
+typedef struct iree_hal_local_executable_export_statistics_t {
+  // Number of calls made into the export. Exports supporting workgroup ranges
+  // may process many workgroups per call.
+  uint64_t invocation_count;
+  // Total number of workgroups processed by all calls.
+  uint64_t workgroup_count;
+  // Cumulative time spent in calls across all workers.
+  iree_duration_t total_duration_ns;
+  // Longest single call.
+  iree_duration_t max_duration_ns;
+} iree_hal_local_executable_export_statistics_t;
+
+// Enables or disables statistics on executables loaded from now on.
+// Executables that are already loaded are unaffected. Disabled by default as
+// timing each call adds a small amount of overhead.
+void iree_hal_local_executable_set_statistics_enabled(bool enabled);
+
+// Queries the statistics of export |ordinal| aggregated across all workers.
+// Returns IREE_STATUS_UNAVAILABLE if the executable was loaded without
+// statistics enabled.
+iree_status_t iree_hal_local_executable_query_export_statistics(
+    iree_hal_local_executable_t* executable, iree_host_size_t ordinal,
+    iree_hal_local_executable_export_statistics_t* out_statistics);
+
+// Callback issued for each export by
+// iree_hal_local_executable_statistics_enumerate. |export_name| is empty if the
+// executable has no reflection information.
+typedef iree_status_t (*iree_hal_local_executable_statistics_fn_t)(
+    void* user_data, iree_string_view_t executable_identifier,
+    iree_host_size_t ordinal, iree_string_view_t export_name,
+    const iree_hal_local_executable_export_statistics_t* statistics);
+
+// Enumerates the statistics of every export of every live executable that has
+// statistics. Exports that have never been called are skipped. Statistics are
+// released with their executable and must be queried before unloading.
+// Thread-safe; loading and unloading executables blocks while enumerating.
+iree_status_t iree_hal_local_executable_statistics_enumerate(
+    iree_hal_local_executable_statistics_fn_t fn, void* user_data);
+
+// Appends the statistics of all live executables to |builder| in the
+// Prometheus text exposition format with `executable` and `export` labels.
+iree_status_t iree_hal_local_executable_statistics_append_prometheus(
+    iree_string_builder_t* builder);
+
+// Prints a table of the statistics of all live executables to |file| in the
+// order they were loaded. No-op if statistics are not compiled in.
+iree_status_t iree_hal_local_executable_statistics_fprint(FILE* file);
+
 #ifdef __cplusplus
 }  // extern "C"
 #endif  // __cplusplus
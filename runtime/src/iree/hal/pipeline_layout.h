@@ -32,6 +32,11 @@ typedef uint32_t iree_hal_descriptor_set_layout_flags_t;
 
 // Specifies the type of a descriptor in a descriptor set.
 typedef enum iree_hal_descriptor_type_e {
+  // A read-only buffer accessed through the texture/image cache of devices
+  // that have one. The buffer is viewed as 128-bit texels of four 32-bit
+  // unsigned integers and the bound range must cover whole texels.
+  // Implementations without a dedicated path treat it as a storage buffer.
+  IREE_HAL_DESCRIPTOR_TYPE_UNIFORM_TEXEL_BUFFER = 4,
   IREE_HAL_DESCRIPTOR_TYPE_UNIFORM_BUFFER = 6,
   IREE_HAL_DESCRIPTOR_TYPE_STORAGE_BUFFER = 7,
 } iree_hal_descriptor_type_t;
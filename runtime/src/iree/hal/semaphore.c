@@ -7,7 +7,10 @@
 #include "iree/hal/semaphore.h"
 
 #include <stddef.h>
+#include <string.h>
 
+#include "iree/base/internal/metrics.h"
+#include "iree/base/internal/wait_handle.h"
 #include "iree/base/tracing.h"
 #include "iree/hal/detail.h"
 #include "iree/hal/device.h"
@@ -70,13 +73,20 @@ IREE_API_EXPORT void iree_hal_semaphore_fail(iree_hal_semaphore_t* semaphore,
   IREE_TRACE_ZONE_END(z0);
 }
 
+IREE_METRIC_DEFINE(iree_hal_semaphore_wait_duration_metric, HISTOGRAM,
+                   "iree_hal_semaphore_wait_duration_microseconds",
+                   "Time spent blocked waiting on individual semaphores.");
+
 IREE_API_EXPORT iree_status_t iree_hal_semaphore_wait(
     iree_hal_semaphore_t* semaphore, uint64_t value, iree_timeout_t timeout) {
   IREE_ASSERT_ARGUMENT(semaphore);
   IREE_TRACE_ZONE_BEGIN(z0);
   IREE_TRACE_ZONE_APPEND_VALUE(z0, value);
+  IREE_METRICS(const iree_time_t start_ns = iree_time_now());
   iree_status_t status =
       _VTABLE_DISPATCH(semaphore, wait)(semaphore, value, timeout);
+  IREE_METRIC_OBSERVE(iree_hal_semaphore_wait_duration_metric,
+                      (iree_time_now() - start_ns) / 1000);
   IREE_TRACE_ZONE_END(z0);
   return status;
 }
@@ -110,7 +120,10 @@ iree_status_t iree_hal_semaphore_wait_source_ctl(
     case IREE_WAIT_SOURCE_COMMAND_EXPORT: {
       const iree_wait_primitive_type_t target_type =
           ((const iree_wait_source_export_params_t*)params)->target_type;
-      // TODO(benvanik): support exporting semaphores to real wait handles.
+      // Wait sources must own their exported handles and a semaphore wait
+      // source is only a (semaphore, value) pair with nowhere to keep one.
+      // Callers needing a system handle can use
+      // iree_hal_semaphore_export_timepoint and own the result themselves.
       iree_wait_primitive_t* out_wait_primitive =
           (iree_wait_primitive_t*)inout_ptr;
       memset(out_wait_primitive, 0, sizeof(*out_wait_primitive));
@@ -125,6 +138,26 @@ iree_status_t iree_hal_semaphore_wait_source_ctl(
   }
 }
 
+IREE_API_EXPORT iree_status_t iree_hal_semaphore_export_timepoint(
+    iree_hal_semaphore_t* semaphore, uint64_t value,
+    iree_wait_primitive_type_t target_type,
+    iree_wait_primitive_t* out_wait_primitive) {
+  IREE_ASSERT_ARGUMENT(semaphore);
+  IREE_ASSERT_ARGUMENT(out_wait_primitive);
+  memset(out_wait_primitive, 0, sizeof(*out_wait_primitive));
+  if (!_VTABLE_DISPATCH(semaphore, export_timepoint)) {
+    return iree_make_status(
+        IREE_STATUS_UNAVAILABLE,
+        "semaphore implementation does not support exporting timepoints");
+  }
+  IREE_TRACE_ZONE_BEGIN(z0);
+  IREE_TRACE_ZONE_APPEND_VALUE(z0, value);
+  iree_status_t status = _VTABLE_DISPATCH(semaphore, export_timepoint)(
+      semaphore, value, target_type, out_wait_primitive);
+  IREE_TRACE_ZONE_END(z0);
+  return status;
+}
+
 IREE_API_EXPORT iree_wait_source_t
 iree_hal_semaphore_await(iree_hal_semaphore_t* semaphore, uint64_t value) {
   IREE_ASSERT_ARGUMENT(semaphore);
@@ -184,25 +217,209 @@ IREE_API_EXPORT void iree_hal_semaphore_list_fail(
 
 IREE_API_EXPORT iree_status_t iree_hal_semaphore_list_wait(
     iree_hal_semaphore_list_t semaphore_list, iree_timeout_t timeout) {
+  return iree_hal_semaphore_list_multi_wait(IREE_HAL_WAIT_MODE_ALL,
+                                            semaphore_list, timeout);
+}
+
+// Interval between polls when waiting for any of several semaphores that
+// cannot be multiplexed with a system multi-wait.
+#define IREE_HAL_SEMAPHORE_LIST_POLL_INTERVAL_NS (100 * 1000)
+
+// Queries each timepoint in |semaphore_list|, compacting the ones not yet
+// reached to the front of the list in-place and returning their count in
+// |out_pending_count|. With IREE_HAL_WAIT_MODE_ANY the query stops as soon as
+// a reached timepoint is found and returns a pending count of 0.
+static iree_status_t iree_hal_semaphore_list_filter_pending(
+    iree_hal_wait_mode_t wait_mode, iree_hal_semaphore_list_t* semaphore_list,
+    iree_host_size_t* out_pending_count) {
+  *out_pending_count = 0;
+  iree_host_size_t pending_count = 0;
+  for (iree_host_size_t i = 0; i < semaphore_list->count; ++i) {
+    uint64_t current_value = 0;
+    IREE_RETURN_IF_ERROR(iree_hal_semaphore_query(
+        semaphore_list->semaphores[i], &current_value));
+    if (current_value >= semaphore_list->payload_values[i]) {
+      if (wait_mode == IREE_HAL_WAIT_MODE_ANY) return iree_ok_status();
+      continue;
+    }
+    semaphore_list->semaphores[pending_count] = semaphore_list->semaphores[i];
+    semaphore_list->payload_values[pending_count] =
+        semaphore_list->payload_values[i];
+    ++pending_count;
+  }
+  *out_pending_count = pending_count;
+  return iree_ok_status();
+}
+
+// Waits on |semaphore_list| by exporting each timepoint as a system wait
+// primitive and performing a single system multi-wait on all of them.
+// Sets |out_exported| to false if any semaphore is unable to export its
+// timepoint in which case no wait is performed.
+static iree_status_t iree_hal_semaphore_list_multi_wait_exported(
+    iree_hal_wait_mode_t wait_mode, iree_hal_semaphore_list_t semaphore_list,
+    iree_timeout_t timeout, bool* out_exported) {
+  *out_exported = false;
+  iree_allocator_t host_allocator = iree_allocator_system();
+
+  iree_wait_handle_t* handles = NULL;
+  IREE_RETURN_IF_ERROR(iree_allocator_malloc(
+      host_allocator, semaphore_list.count * sizeof(*handles),
+      (void**)&handles));
+  iree_host_size_t handle_count = 0;
+
+  // Export all timepoints; any semaphore reached in the meantime is immediate
+  // and needs no handle.
+  bool any_reached = false;
+  bool all_exported = true;
+  iree_status_t status = iree_ok_status();
+  for (iree_host_size_t i = 0; i < semaphore_list.count; ++i) {
+    iree_wait_primitive_t wait_primitive = iree_wait_primitive_immediate();
+    status = iree_hal_semaphore_export_timepoint(
+        semaphore_list.semaphores[i], semaphore_list.payload_values[i],
+        IREE_WAIT_PRIMITIVE_TYPE_ANY, &wait_primitive);
+    if (iree_status_is_unavailable(status)) {
+      status = iree_status_ignore(status);
+      all_exported = false;
+      break;
+    } else if (!iree_status_is_ok(status)) {
+      break;
+    }
+    if (iree_wait_primitive_is_immediate(wait_primitive)) {
+      any_reached = true;
+      if (wait_mode == IREE_HAL_WAIT_MODE_ANY) break;
+      continue;
+    }
+    iree_wait_handle_wrap_primitive(wait_primitive.type, wait_primitive.value,
+                                    &handles[handle_count++]);
+  }
+
+  if (iree_status_is_ok(status) && all_exported) {
+    *out_exported = true;
+    if (handle_count > 0 &&
+        !(any_reached && wait_mode == IREE_HAL_WAIT_MODE_ANY)) {
+      iree_wait_set_t* wait_set = NULL;
+      status = iree_wait_set_allocate(handle_count, host_allocator, &wait_set);
+      for (iree_host_size_t i = 0;
+           i < handle_count && iree_status_is_ok(status); ++i) {
+        status = iree_wait_set_insert(wait_set, handles[i]);
+      }
+      if (iree_status_is_ok(status)) {
+        iree_time_t deadline_ns = iree_timeout_as_deadline_ns(timeout);
+        if (wait_mode == IREE_HAL_WAIT_MODE_ANY) {
+          iree_wait_handle_t wake_handle;
+          status = iree_wait_any(wait_set, deadline_ns, &wake_handle);
+        } else {
+          status = iree_wait_all(wait_set, deadline_ns);
+        }
+      }
+      iree_wait_set_free(wait_set);
+    }
+  }
+
+  for (iree_host_size_t i = 0; i < handle_count; ++i) {
+    iree_wait_handle_close(&handles[i]);
+  }
+  iree_allocator_free(host_allocator, handles);
+  return status;
+}
+
+IREE_API_EXPORT iree_status_t iree_hal_semaphore_list_multi_wait(
+    iree_hal_wait_mode_t wait_mode, iree_hal_semaphore_list_t semaphore_list,
+    iree_timeout_t timeout) {
   if (!semaphore_list.count) return iree_ok_status();
+  if (semaphore_list.count == 1) {
+    return iree_hal_semaphore_wait(semaphore_list.semaphores[0],
+                                   semaphore_list.payload_values[0], timeout);
+  }
   IREE_TRACE_ZONE_BEGIN(z0);
+  IREE_TRACE_ZONE_APPEND_VALUE(z0, (int64_t)semaphore_list.count);
 
   // Ensure an absolute timeout so that as we loop through we don't drift from
   // the user-intended relative timeout.
   iree_convert_timeout_to_absolute(&timeout);
 
-  // Wait on all until done or we timeout.
-  // This is not the most efficient way to wait on semaphores as it performs
-  // no device-side batching. We should probably expose this as a device method
-  // instead or have a way to batch by semaphore implementation for heterogenous
-  // fences.
-  //
-  // TODO(benvanik): use iree_hal_device_wait_semaphores for each unique device.
-  iree_status_t status = iree_ok_status();
-  for (iree_host_size_t i = 0; i < semaphore_list.count; ++i) {
-    status = iree_hal_semaphore_wait(semaphore_list.semaphores[i],
-                                     semaphore_list.payload_values[i], timeout);
-    if (!iree_status_is_ok(status)) break;
+  // Filter the list down to the timepoints not yet reached in a scratch copy so
+  // that the caller list is unmodified. This also propagates any failures
+  // without needing to wait.
+  iree_hal_semaphore_t** semaphores = (iree_hal_semaphore_t**)iree_alloca(
+      semaphore_list.count * sizeof(*semaphores));
+  uint64_t* payload_values =
+      (uint64_t*)iree_alloca(semaphore_list.count * sizeof(*payload_values));
+  memcpy(semaphores, semaphore_list.semaphores,
+         semaphore_list.count * sizeof(*semaphores));
+  memcpy(payload_values, semaphore_list.payload_values,
+         semaphore_list.count * sizeof(*payload_values));
+  iree_hal_semaphore_list_t pending_list = {
+      .count = semaphore_list.count,
+      .semaphores = semaphores,
+      .payload_values = payload_values,
+  };
+  iree_host_size_t pending_count = 0;
+  IREE_RETURN_AND_END_ZONE_IF_ERROR(
+      z0, iree_hal_semaphore_list_filter_pending(wait_mode, &pending_list,
+                                                 &pending_count));
+  pending_list.count = pending_count;
+  if (pending_list.count == 0) {
+    IREE_TRACE_ZONE_END(z0);
+    return iree_ok_status();
+  } else if (pending_list.count == 1) {
+    iree_status_t status = iree_hal_semaphore_wait(
+        pending_list.semaphores[0], pending_list.payload_values[0], timeout);
+    IREE_TRACE_ZONE_END(z0);
+    return status;
+  }
+
+  // Semaphores do not reference the device that created them and there is no
+  // way to route the list to iree_hal_device_wait_semaphores. Instead we
+  // multiplex the timepoints with the system multi-wait when every semaphore
+  // can export them; this works across devices and implementations.
+  bool exported = false;
+  iree_status_t status = iree_hal_semaphore_list_multi_wait_exported(
+      wait_mode, pending_list, timeout, &exported);
+
+  if (iree_status_is_ok(status) && !exported) {
+    if (wait_mode == IREE_HAL_WAIT_MODE_ALL) {
+      // Serial waits only pay the latency of the slowest semaphore as by the
+      // time it is reached the others are usually already satisfied.
+      for (iree_host_size_t i = 0; i < pending_list.count; ++i) {
+        status = iree_hal_semaphore_wait(pending_list.semaphores[i],
+                                         pending_list.payload_values[i],
+                                         timeout);
+        if (!iree_status_is_ok(status)) break;
+      }
+    } else {
+      // Round-robin short waits across the semaphores so that whichever is
+      // reached first is observed within about one poll interval.
+      const iree_time_t deadline_ns = iree_timeout_as_deadline_ns(timeout);
+      const iree_duration_t slice_ns =
+          IREE_HAL_SEMAPHORE_LIST_POLL_INTERVAL_NS / pending_list.count;
+      bool any_reached = false;
+      while (!any_reached && iree_status_is_ok(status)) {
+        for (iree_host_size_t i = 0; i < pending_list.count; ++i) {
+          status = iree_hal_semaphore_wait(
+              pending_list.semaphores[i], pending_list.payload_values[i],
+              iree_make_deadline(
+                  iree_min(deadline_ns, iree_time_now() + slice_ns)));
+          if (iree_status_is_ok(status)) {
+            any_reached = true;
+            break;
+          } else if (!iree_status_is_deadline_exceeded(status)) {
+            break;
+          }
+          status = iree_status_ignore(status);
+        }
+        if (iree_status_is_ok(status) && !any_reached &&
+            iree_time_now() >= deadline_ns) {
+          status = iree_status_from_code(IREE_STATUS_DEADLINE_EXCEEDED);
+        }
+      }
+    }
+  } else if (iree_status_is_ok(status)) {
+    // Exported primitives are signaled on failure as well as on success so
+    // query again to propagate failures.
+    iree_host_size_t remaining_count = 0;
+    status = iree_hal_semaphore_list_filter_pending(wait_mode, &pending_list,
+                                                    &remaining_count);
   }
 
   IREE_TRACE_ZONE_END(z0);
@@ -114,6 +114,32 @@ IREE_API_EXPORT iree_status_t iree_hal_semaphore_wait(
 IREE_API_EXPORT iree_wait_source_t
 iree_hal_semaphore_await(iree_hal_semaphore_t* semaphore, uint64_t value);
 
+// Exports a system wait primitive in |out_wait_primitive| that is signaled when
+// |semaphore| reaches or exceeds the specified payload |value| or fails. This
+// allows semaphores to be multiplexed with other system handles in external
+// event loops (epoll, io_uring, WaitForMultipleObjects, etc) without
+// dedicating a thread to waiting on them. Once signaled callers should use
+// iree_hal_semaphore_query to check whether the semaphore failed.
+//
+// The exported primitive is owned by the caller and must be closed (close() for
+// file descriptors or CloseHandle for HANDLEs) when no longer required. It may
+// be closed before it has been signaled. The semaphore may be kept alive by the
+// implementation until it reaches |value| or fails.
+//
+// If the semaphore has already reached |value| then the wait primitive will be
+// set to immediate and callers can check it with
+// iree_wait_primitive_is_immediate. If the semaphore has failed the failure
+// status is returned.
+//
+// Passing IREE_WAIT_PRIMITIVE_TYPE_ANY allows the implementation to export any
+// primitive type it can. Returns IREE_STATUS_UNAVAILABLE if the requested
+// |target_type| is unavailable on the current platform or from the semaphore
+// implementation.
+IREE_API_EXPORT iree_status_t iree_hal_semaphore_export_timepoint(
+    iree_hal_semaphore_t* semaphore, uint64_t value,
+    iree_wait_primitive_type_t target_type,
+    iree_wait_primitive_t* out_wait_primitive);
+
 //===----------------------------------------------------------------------===//
 // iree_hal_semaphore_list_t
 //===----------------------------------------------------------------------===//
@@ -128,6 +154,14 @@ typedef struct iree_hal_semaphore_list_t {
   uint64_t* payload_values;
 } iree_hal_semaphore_list_t;
 
+// Defines how a multi-wait operation treats the results of multiple semaphores.
+typedef enum iree_hal_wait_mode_e {
+  // Waits for all semaphores to reach or exceed their specified values.
+  IREE_HAL_WAIT_MODE_ALL = 0,
+  // Waits for one or more semaphores to reach or exceed their specified values.
+  IREE_HAL_WAIT_MODE_ANY = 1,
+} iree_hal_wait_mode_t;
+
 // Returns an empty semaphore list.
 static inline iree_hal_semaphore_list_t iree_hal_semaphore_list_empty(void) {
   iree_hal_semaphore_list_t list = {0};
@@ -164,6 +198,28 @@ IREE_API_EXPORT void iree_hal_semaphore_list_fail(
 IREE_API_EXPORT iree_status_t iree_hal_semaphore_list_wait(
     iree_hal_semaphore_list_t semaphore_list, iree_timeout_t timeout);
 
+// Blocks the caller until semaphore timepoints are reached as defined by
+// |wait_mode| or the |timeout| elapses. Unlike iree_hal_device_wait_semaphores
+// the semaphores may come from any number of devices and implementations.
+//
+// Timepoints already reached are filtered out with a query before blocking.
+// When the remaining semaphores are able to export their timepoints as system
+// wait primitives (see iree_hal_semaphore_export_timepoint) they are waited on
+// together with a single multi-wait; otherwise IREE_HAL_WAIT_MODE_ALL waits on
+// each in turn and IREE_HAL_WAIT_MODE_ANY round-robins short waits across them.
+// Each exported timepoint keeps its semaphore alive until the timepoint is
+// reached even if this wait returns earlier.
+//
+// Returns IREE_STATUS_DEADLINE_EXCEEDED if the |timeout| elapses without the
+// |wait_mode| being satisfied. Note that even on success only a subset of the
+// semaphores may have been signaled and each can be queried to see which ones.
+//
+// Returns IREE_STATUS_ABORTED if one or more semaphores has failed. Callers can
+// use iree_hal_semaphore_query to get the status from each.
+IREE_API_EXPORT iree_status_t iree_hal_semaphore_list_multi_wait(
+    iree_hal_wait_mode_t wait_mode, iree_hal_semaphore_list_t semaphore_list,
+    iree_timeout_t timeout);
+
 //===----------------------------------------------------------------------===//
 // iree_hal_semaphore_t implementation details
 //===----------------------------------------------------------------------===//
@@ -180,6 +236,12 @@ typedef struct iree_hal_semaphore_vtable_t {
 
   iree_status_t(IREE_API_PTR* wait)(iree_hal_semaphore_t* semaphore,
                                     uint64_t value, iree_timeout_t timeout);
+
+  // Optional; iree_hal_semaphore_export_timepoint is unavailable if NULL.
+  iree_status_t(IREE_API_PTR* export_timepoint)(
+      iree_hal_semaphore_t* semaphore, uint64_t value,
+      iree_wait_primitive_type_t target_type,
+      iree_wait_primitive_t* out_wait_primitive);
 } iree_hal_semaphore_vtable_t;
 IREE_HAL_ASSERT_VTABLE_LAYOUT(iree_hal_semaphore_vtable_t);
 
@@ -97,7 +97,102 @@ static iree_status_t iree_hal_device_transfer_and_wait(
 // iree_hal_device_transfer_range implementations
 //===----------------------------------------------------------------------===//
 
-IREE_API_EXPORT iree_status_t iree_hal_device_submit_transfer_range_and_wait(
+// Attempts to import |data_length| bytes of |host_buffer| at |offset| into a
+// device buffer that aliases the host memory. Returns NULL in |out_buffer| if
+// the allocator is unable to import the memory (unsupported, unaligned, etc)
+// and the caller must fall back to staging through an allocated buffer.
+static void iree_hal_device_try_import_host_range(
+    iree_hal_device_t* device, iree_byte_span_t host_buffer,
+    iree_device_size_t offset, iree_device_size_t data_length,
+    iree_hal_memory_access_t access, iree_hal_buffer_t** out_buffer) {
+  *out_buffer = NULL;
+  iree_hal_allocator_t* device_allocator = iree_hal_device_allocator(device);
+  const iree_hal_buffer_params_t params = {
+      .type = IREE_HAL_MEMORY_TYPE_HOST_LOCAL |
+              IREE_HAL_MEMORY_TYPE_DEVICE_VISIBLE,
+      .access = access,
+      .usage = IREE_HAL_BUFFER_USAGE_TRANSFER,
+  };
+  iree_hal_buffer_compatibility_t compatibility =
+      iree_hal_allocator_query_compatibility(device_allocator, params,
+                                             data_length);
+  if (!iree_all_bits_set(compatibility,
+                         IREE_HAL_BUFFER_COMPATIBILITY_IMPORTABLE |
+                             IREE_HAL_BUFFER_COMPATIBILITY_QUEUE_TRANSFER)) {
+    return;
+  }
+  iree_hal_external_buffer_t external_buffer = {
+      .type = IREE_HAL_EXTERNAL_BUFFER_TYPE_HOST_ALLOCATION,
+      .flags = IREE_HAL_EXTERNAL_BUFFER_FLAG_NONE,
+      .size = data_length,
+      .handle.host_allocation.ptr = host_buffer.data + offset,
+  };
+  iree_status_t status = iree_hal_allocator_import_buffer(
+      device_allocator, params, &external_buffer,
+      iree_hal_buffer_release_callback_null(), out_buffer);
+  if (!iree_status_is_ok(status)) {
+    iree_status_ignore(status);
+    *out_buffer = NULL;
+  }
+}
+
+static void iree_hal_device_release_peer_buffer(void* user_data,
+                                                iree_hal_buffer_t* buffer) {
+  iree_hal_buffer_release((iree_hal_buffer_t*)user_data);
+}
+
+// Attempts to import the allocation backing |buffer| from the device that
+// allocated it into |device| so that transfers can be performed by |device|
+// directly (such as CUDA P2P over PCIe or NVLink). Returns NULL in
+// |out_buffer| if |buffer| was allocated by |device| or the devices are unable
+// to share the memory and the caller must fall back to the normal paths.
+// The imported buffer covers the entire allocation and retains |buffer|.
+static void iree_hal_device_try_import_peer_buffer(
+    iree_hal_device_t* device, iree_hal_buffer_t* buffer,
+    iree_hal_buffer_t** out_buffer) {
+  *out_buffer = NULL;
+  iree_hal_allocator_t* device_allocator = iree_hal_device_allocator(device);
+  iree_hal_buffer_t* allocated_buffer =
+      iree_hal_buffer_allocated_buffer(buffer);
+  iree_hal_allocator_t* peer_allocator = allocated_buffer->device_allocator;
+  if (!peer_allocator || peer_allocator == device_allocator) return;
+
+  // Only device-local memory benefits from peer access: host-local memory is
+  // either mappable or importable as a host allocation already.
+  const iree_hal_memory_type_t memory_type =
+      iree_hal_buffer_memory_type(allocated_buffer);
+  if (!iree_all_bits_set(memory_type, IREE_HAL_MEMORY_TYPE_DEVICE_LOCAL)) {
+    return;
+  }
+
+  iree_hal_external_buffer_t external_buffer;
+  iree_status_t status = iree_hal_allocator_export_buffer(
+      peer_allocator, allocated_buffer,
+      IREE_HAL_EXTERNAL_BUFFER_TYPE_DEVICE_ALLOCATION,
+      IREE_HAL_EXTERNAL_BUFFER_FLAG_NONE, &external_buffer);
+  if (iree_status_is_ok(status)) {
+    const iree_hal_buffer_params_t params = {
+        .type = IREE_HAL_MEMORY_TYPE_DEVICE_LOCAL,
+        .access = iree_hal_buffer_allowed_access(allocated_buffer),
+        .usage = IREE_HAL_BUFFER_USAGE_TRANSFER,
+    };
+    const iree_hal_buffer_release_callback_t release_callback = {
+        .fn = iree_hal_device_release_peer_buffer,
+        .user_data = allocated_buffer,
+    };
+    iree_hal_buffer_retain(allocated_buffer);
+    status = iree_hal_allocator_import_buffer(
+        device_allocator, params, &external_buffer, release_callback,
+        out_buffer);
+    if (!iree_status_is_ok(status)) iree_hal_buffer_release(allocated_buffer);
+  }
+  if (!iree_status_is_ok(status)) {
+    iree_status_ignore(status);
+    *out_buffer = NULL;
+  }
+}
+
+static iree_status_t iree_hal_device_submit_transfer_range_and_wait_impl(
     iree_hal_device_t* device, iree_hal_transfer_buffer_t source,
     iree_device_size_t source_offset, iree_hal_transfer_buffer_t target,
     iree_device_size_t target_offset, iree_device_size_t data_length,
@@ -150,12 +245,19 @@ IREE_API_EXPORT iree_status_t iree_hal_device_submit_transfer_range_and_wait(
 
   iree_status_t status = iree_ok_status();
 
-  // Allocate the staging buffer for upload to the device.
+  // Import or allocate the staging buffer for upload to the device.
   iree_hal_buffer_t* source_buffer = source.device_buffer;
+  if (!source_buffer) {
+    // Importing the host memory avoids both the allocation and the copy.
+    iree_hal_device_try_import_host_range(device, source.host_buffer,
+                                          source_offset, data_length,
+                                          IREE_HAL_MEMORY_ACCESS_READ,
+                                          &source_buffer);
+    if (source_buffer) source_offset = 0;
+  }
   if (!source_buffer) {
     // Allocate staging memory with a copy of the host data. We only initialize
     // the portion being transferred.
-    // TODO(benvanik): use import if supported to avoid the allocation/copy.
     // TODO(benvanik): make this device-local + host-visible? can be better for
     // uploads as we know we are never going to read it back.
     const iree_hal_buffer_params_t source_params = {
@@ -171,12 +273,25 @@ IREE_API_EXPORT iree_status_t iree_hal_device_submit_transfer_range_and_wait(
     source_offset = 0;
   }
 
-  // Allocate the staging buffer for download from the device.
+  // Import or allocate the staging buffer for download from the device.
   iree_hal_buffer_t* target_buffer = target.device_buffer;
+  const iree_device_size_t host_target_offset = target_offset;
+  bool is_target_imported = false;
+  if (!target_buffer && iree_status_is_ok(status)) {
+    // Importing the host memory lets the device write into it directly and
+    // avoids the readback copy.
+    iree_hal_device_try_import_host_range(device, target.host_buffer,
+                                          target_offset, data_length,
+                                          IREE_HAL_MEMORY_ACCESS_ALL,
+                                          &target_buffer);
+    if (target_buffer) {
+      is_target_imported = true;
+      target_offset = 0;
+    }
+  }
   if (!target_buffer) {
     // Allocate uninitialized staging memory for the transfer target.
     // We only allocate enough for the portion we are transfering.
-    // TODO(benvanik): use import if supported to avoid the allocation/copy.
     const iree_hal_buffer_params_t target_params = {
         .type = IREE_HAL_MEMORY_TYPE_HOST_LOCAL |
                 IREE_HAL_MEMORY_TYPE_DEVICE_VISIBLE,
@@ -207,9 +322,11 @@ IREE_API_EXPORT iree_status_t iree_hal_device_submit_transfer_range_and_wait(
   }
 
   // Read back the staging buffer into memory, if needed.
-  if (iree_status_is_ok(status) && !target.device_buffer) {
-    status = iree_hal_buffer_map_read(target_buffer, 0, target.host_buffer.data,
-                                      data_length);
+  if (iree_status_is_ok(status) && !target.device_buffer &&
+      !is_target_imported) {
+    status = iree_hal_buffer_map_read(
+        target_buffer, 0, target.host_buffer.data + host_target_offset,
+        data_length);
   }
 
   // Discard staging buffers, if they were required.
@@ -219,6 +336,62 @@ IREE_API_EXPORT iree_status_t iree_hal_device_submit_transfer_range_and_wait(
   return status;
 }
 
+IREE_API_EXPORT iree_status_t iree_hal_device_submit_transfer_range_and_wait(
+    iree_hal_device_t* device, iree_hal_transfer_buffer_t source,
+    iree_device_size_t source_offset, iree_hal_transfer_buffer_t target,
+    iree_device_size_t target_offset, iree_device_size_t data_length,
+    iree_hal_transfer_buffer_flags_t flags, iree_timeout_t timeout) {
+  IREE_TRACE_ZONE_BEGIN(z0);
+
+  // Buffers allocated by other devices can't be used by |device| directly.
+  // When the devices can share memory we import the peer allocations and let
+  // |device| perform a single device-to-device copy instead of bouncing the
+  // data through host staging buffers.
+  iree_hal_buffer_t* source_peer_buffer = NULL;
+  iree_hal_buffer_t* target_peer_buffer = NULL;
+  if (source.device_buffer) {
+    iree_hal_device_try_import_peer_buffer(device, source.device_buffer,
+                                           &source_peer_buffer);
+  }
+  if (target.device_buffer) {
+    iree_hal_device_try_import_peer_buffer(device, target.device_buffer,
+                                           &target_peer_buffer);
+  }
+  if (source_peer_buffer || target_peer_buffer) {
+    // The imported buffers cover the entire allocations so resolve the length
+    // against the original buffers before rebasing the offsets.
+    if (data_length == IREE_WHOLE_BUFFER) {
+      if (source.device_buffer) {
+        data_length = iree_hal_buffer_byte_length(source.device_buffer) -
+                      source_offset;
+      }
+      if (target.device_buffer) {
+        data_length = iree_min(
+            data_length,
+            iree_hal_buffer_byte_length(target.device_buffer) - target_offset);
+      }
+    }
+    IREE_TRACE_ZONE_APPEND_TEXT(z0, "peer");
+  }
+  if (source_peer_buffer) {
+    source_offset += iree_hal_buffer_byte_offset(source.device_buffer);
+    source.device_buffer = source_peer_buffer;
+  }
+  if (target_peer_buffer) {
+    target_offset += iree_hal_buffer_byte_offset(target.device_buffer);
+    target.device_buffer = target_peer_buffer;
+  }
+
+  iree_status_t status = iree_hal_device_submit_transfer_range_and_wait_impl(
+      device, source, source_offset, target, target_offset, data_length, flags,
+      timeout);
+
+  iree_hal_buffer_release(source_peer_buffer);
+  iree_hal_buffer_release(target_peer_buffer);
+  IREE_TRACE_ZONE_END(z0);
+  return status;
+}
+
 IREE_API_EXPORT iree_status_t iree_hal_device_transfer_mappable_range(
     iree_hal_device_t* device, iree_hal_transfer_buffer_t source,
     iree_device_size_t source_offset, iree_hal_transfer_buffer_t target,
@@ -268,8 +441,11 @@ IREE_API_EXPORT iree_status_t iree_hal_device_transfer_mappable_range(
       adjusted_data_length = target_mapping.contents.data_length;
     }
 
-    // Perform the copy, assuming there's anything to do.
-    if (adjusted_data_length != 0) {
+    // Perform the copy, assuming there's anything to do. Buffers sharing the
+    // host address space (such as heap buffers wrapping imported host memory)
+    // may alias the source and target and need no copy at all.
+    if (adjusted_data_length != 0 &&
+        target_mapping.contents.data != source_mapping.contents.data) {
       memcpy(target_mapping.contents.data, source_mapping.contents.data,
              adjusted_data_length);
     }
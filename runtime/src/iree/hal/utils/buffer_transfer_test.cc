@@ -0,0 +1,415 @@
+// Copyright 2023 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include "iree/hal/utils/buffer_transfer.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+#include "iree/base/api.h"
+#include "iree/hal/api.h"
+#include "iree/hal/drivers/local_sync/sync_device.h"
+#include "iree/testing/gtest.h"
+#include "iree/testing/status_matchers.h"
+
+namespace iree {
+namespace hal {
+namespace {
+
+//===----------------------------------------------------------------------===//
+// Peer allocator
+//===----------------------------------------------------------------------===//
+
+// A host memory allocator that models devices sharing a unified address space
+// by exporting and importing IREE_HAL_EXTERNAL_BUFFER_TYPE_DEVICE_ALLOCATION
+// handles as raw host pointers. Counts the imports and exports so that tests
+// can verify which transfer path was taken.
+typedef struct peer_allocator_t {
+  iree_hal_resource_t resource;
+  iree_allocator_t host_allocator;
+  // When false export/import of device allocations is unavailable as with
+  // devices that cannot access each other's memory.
+  bool supports_peer_access;
+  int export_count;
+  int import_count;
+  // Number of buffers created by the allocator that have not been destroyed.
+  int live_buffer_count;
+} peer_allocator_t;
+
+typedef struct peer_buffer_t {
+  iree_hal_buffer_t base;
+  uint8_t* data;
+  // Set for imported buffers that do not own |data|.
+  iree_hal_buffer_release_callback_t release_callback;
+  bool owns_data;
+} peer_buffer_t;
+
+static void peer_buffer_destroy(iree_hal_buffer_t* base_buffer) {
+  peer_buffer_t* buffer = (peer_buffer_t*)base_buffer;
+  iree_allocator_t host_allocator = base_buffer->host_allocator;
+  --((peer_allocator_t*)base_buffer->device_allocator)->live_buffer_count;
+  if (buffer->release_callback.fn) {
+    buffer->release_callback.fn(buffer->release_callback.user_data,
+                                base_buffer);
+  }
+  if (buffer->owns_data) iree_allocator_free(host_allocator, buffer->data);
+  iree_allocator_free(host_allocator, buffer);
+}
+
+static iree_status_t peer_buffer_map_range(
+    iree_hal_buffer_t* base_buffer, iree_hal_mapping_mode_t mapping_mode,
+    iree_hal_memory_access_t memory_access,
+    iree_device_size_t local_byte_offset, iree_device_size_t local_byte_length,
+    iree_hal_buffer_mapping_t* mapping) {
+  peer_buffer_t* buffer = (peer_buffer_t*)base_buffer;
+  mapping->contents = iree_make_byte_span(buffer->data + local_byte_offset,
+                                          local_byte_length);
+  return iree_ok_status();
+}
+
+static iree_status_t peer_buffer_unmap_range(
+    iree_hal_buffer_t* base_buffer, iree_device_size_t local_byte_offset,
+    iree_device_size_t local_byte_length, iree_hal_buffer_mapping_t* mapping) {
+  return iree_ok_status();
+}
+
+static iree_status_t peer_buffer_invalidate_range(
+    iree_hal_buffer_t* base_buffer, iree_device_size_t local_byte_offset,
+    iree_device_size_t local_byte_length) {
+  return iree_ok_status();
+}
+
+static iree_status_t peer_buffer_flush_range(
+    iree_hal_buffer_t* base_buffer, iree_device_size_t local_byte_offset,
+    iree_device_size_t local_byte_length) {
+  return iree_ok_status();
+}
+
+static const iree_hal_buffer_vtable_t peer_buffer_vtable = {
+    /*.recycle=*/iree_hal_buffer_recycle,
+    /*.destroy=*/peer_buffer_destroy,
+    /*.map_range=*/peer_buffer_map_range,
+    /*.unmap_range=*/peer_buffer_unmap_range,
+    /*.invalidate_range=*/peer_buffer_invalidate_range,
+    /*.flush_range=*/peer_buffer_flush_range,
+};
+
+static iree_status_t peer_buffer_create(
+    peer_allocator_t* allocator, const iree_hal_buffer_params_t* params,
+    iree_device_size_t allocation_size, uint8_t* data, bool owns_data,
+    iree_hal_buffer_release_callback_t release_callback,
+    iree_hal_buffer_t** out_buffer) {
+  peer_buffer_t* buffer = NULL;
+  IREE_RETURN_IF_ERROR(iree_allocator_malloc(
+      allocator->host_allocator, sizeof(*buffer), (void**)&buffer));
+  iree_hal_buffer_initialize(
+      allocator->host_allocator, (iree_hal_allocator_t*)allocator,
+      &buffer->base, allocation_size, /*byte_offset=*/0, allocation_size,
+      params->type | IREE_HAL_MEMORY_TYPE_HOST_VISIBLE, params->access,
+      params->usage | IREE_HAL_BUFFER_USAGE_MAPPING, &peer_buffer_vtable,
+      &buffer->base);
+  buffer->data = data;
+  buffer->owns_data = owns_data;
+  buffer->release_callback = release_callback;
+  ++allocator->live_buffer_count;
+  *out_buffer = &buffer->base;
+  return iree_ok_status();
+}
+
+static void peer_allocator_destroy(
+    iree_hal_allocator_t* IREE_RESTRICT base_allocator) {
+  peer_allocator_t* allocator = (peer_allocator_t*)base_allocator;
+  iree_allocator_free(allocator->host_allocator, allocator);
+}
+
+static iree_allocator_t peer_allocator_host_allocator(
+    const iree_hal_allocator_t* IREE_RESTRICT base_allocator) {
+  return ((const peer_allocator_t*)base_allocator)->host_allocator;
+}
+
+static iree_status_t peer_allocator_trim(
+    iree_hal_allocator_t* IREE_RESTRICT base_allocator) {
+  return iree_ok_status();
+}
+
+static void peer_allocator_query_statistics(
+    iree_hal_allocator_t* IREE_RESTRICT base_allocator,
+    iree_hal_allocator_statistics_t* IREE_RESTRICT out_statistics) {
+  memset(out_statistics, 0, sizeof(*out_statistics));
+}
+
+static iree_hal_buffer_compatibility_t peer_allocator_query_compatibility(
+    iree_hal_allocator_t* IREE_RESTRICT base_allocator,
+    const iree_hal_buffer_params_t* IREE_RESTRICT params,
+    iree_device_size_t allocation_size) {
+  return IREE_HAL_BUFFER_COMPATIBILITY_ALLOCATABLE |
+         IREE_HAL_BUFFER_COMPATIBILITY_QUEUE_TRANSFER;
+}
+
+static iree_status_t peer_allocator_allocate_buffer(
+    iree_hal_allocator_t* IREE_RESTRICT base_allocator,
+    const iree_hal_buffer_params_t* IREE_RESTRICT params,
+    iree_device_size_t allocation_size, iree_const_byte_span_t initial_data,
+    iree_hal_buffer_t** IREE_RESTRICT out_buffer) {
+  peer_allocator_t* allocator = (peer_allocator_t*)base_allocator;
+  uint8_t* data = NULL;
+  IREE_RETURN_IF_ERROR(iree_allocator_malloc(
+      allocator->host_allocator, allocation_size, (void**)&data));
+  if (!iree_const_byte_span_is_empty(initial_data)) {
+    memcpy(data, initial_data.data, initial_data.data_length);
+  }
+  iree_status_t status = peer_buffer_create(
+      allocator, params, allocation_size, data, /*owns_data=*/true,
+      iree_hal_buffer_release_callback_null(), out_buffer);
+  if (!iree_status_is_ok(status)) {
+    iree_allocator_free(allocator->host_allocator, data);
+  }
+  return status;
+}
+
+static void peer_allocator_deallocate_buffer(
+    iree_hal_allocator_t* IREE_RESTRICT base_allocator,
+    iree_hal_buffer_t* IREE_RESTRICT base_buffer) {
+  iree_hal_buffer_destroy(base_buffer);
+}
+
+static iree_status_t peer_allocator_import_buffer(
+    iree_hal_allocator_t* IREE_RESTRICT base_allocator,
+    const iree_hal_buffer_params_t* IREE_RESTRICT params,
+    iree_hal_external_buffer_t* IREE_RESTRICT external_buffer,
+    iree_hal_buffer_release_callback_t release_callback,
+    iree_hal_buffer_t** IREE_RESTRICT out_buffer) {
+  peer_allocator_t* allocator = (peer_allocator_t*)base_allocator;
+  if (!allocator->supports_peer_access ||
+      external_buffer->type !=
+          IREE_HAL_EXTERNAL_BUFFER_TYPE_DEVICE_ALLOCATION) {
+    return iree_make_status(IREE_STATUS_UNAVAILABLE,
+                            "external buffer type not supported");
+  }
+  ++allocator->import_count;
+  return peer_buffer_create(
+      allocator, params, external_buffer->size,
+      (uint8_t*)(uintptr_t)external_buffer->handle.device_allocation.ptr,
+      /*owns_data=*/false, release_callback, out_buffer);
+}
+
+static iree_status_t peer_allocator_export_buffer(
+    iree_hal_allocator_t* IREE_RESTRICT base_allocator,
+    iree_hal_buffer_t* IREE_RESTRICT buffer,
+    iree_hal_external_buffer_type_t requested_type,
+    iree_hal_external_buffer_flags_t requested_flags,
+    iree_hal_external_buffer_t* IREE_RESTRICT out_external_buffer) {
+  peer_allocator_t* allocator = (peer_allocator_t*)base_allocator;
+  if (!allocator->supports_peer_access ||
+      requested_type != IREE_HAL_EXTERNAL_BUFFER_TYPE_DEVICE_ALLOCATION) {
+    return iree_make_status(IREE_STATUS_UNAVAILABLE,
+                            "exporting to external buffer type not supported");
+  }
+  ++allocator->export_count;
+  peer_buffer_t* allocated_buffer =
+      (peer_buffer_t*)iree_hal_buffer_allocated_buffer(buffer);
+  out_external_buffer->type = requested_type;
+  out_external_buffer->flags = requested_flags;
+  out_external_buffer->size = iree_hal_buffer_byte_length(buffer);
+  out_external_buffer->handle.device_allocation.ptr =
+      (uint64_t)(uintptr_t)(allocated_buffer->data +
+                            iree_hal_buffer_byte_offset(buffer));
+  return iree_ok_status();
+}
+
+static const iree_hal_allocator_vtable_t peer_allocator_vtable = {
+    /*.destroy=*/peer_allocator_destroy,
+    /*.host_allocator=*/peer_allocator_host_allocator,
+    /*.trim=*/peer_allocator_trim,
+    /*.query_statistics=*/peer_allocator_query_statistics,
+    /*.query_compatibility=*/peer_allocator_query_compatibility,
+    /*.allocate_buffer=*/peer_allocator_allocate_buffer,
+    /*.deallocate_buffer=*/peer_allocator_deallocate_buffer,
+    /*.import_buffer=*/peer_allocator_import_buffer,
+    /*.export_buffer=*/peer_allocator_export_buffer,
+};
+
+static iree_status_t peer_allocator_create(
+    bool supports_peer_access, iree_hal_allocator_t** out_allocator) {
+  iree_allocator_t host_allocator = iree_allocator_system();
+  peer_allocator_t* allocator = NULL;
+  IREE_RETURN_IF_ERROR(iree_allocator_malloc(
+      host_allocator, sizeof(*allocator), (void**)&allocator));
+  iree_hal_resource_initialize(&peer_allocator_vtable, &allocator->resource);
+  allocator->host_allocator = host_allocator;
+  allocator->supports_peer_access = supports_peer_access;
+  allocator->export_count = 0;
+  allocator->import_count = 0;
+  allocator->live_buffer_count = 0;
+  *out_allocator = (iree_hal_allocator_t*)allocator;
+  return iree_ok_status();
+}
+
+//===----------------------------------------------------------------------===//
+// Tests
+//===----------------------------------------------------------------------===//
+
+class BufferTransferTest : public ::testing::Test {
+ protected:
+  void CreateDevices(bool supports_peer_access) {
+    IREE_ASSERT_OK(
+        peer_allocator_create(supports_peer_access, &device_allocator_));
+    IREE_ASSERT_OK(
+        peer_allocator_create(supports_peer_access, &peer_device_allocator_));
+    iree_hal_sync_device_params_t params;
+    iree_hal_sync_device_params_initialize(&params);
+    IREE_ASSERT_OK(iree_hal_sync_device_create(
+        iree_make_cstring_view("sync"), &params, /*loader_count=*/0,
+        /*loaders=*/NULL, device_allocator_, iree_allocator_system(),
+        &device_));
+  }
+
+  void TearDown() override {
+    iree_hal_device_release(device_);
+    iree_hal_allocator_release(peer_device_allocator_);
+    iree_hal_allocator_release(device_allocator_);
+  }
+
+  static iree_hal_buffer_t* AllocateBuffer(iree_hal_allocator_t* allocator,
+                                           std::vector<uint8_t> contents) {
+    iree_hal_buffer_params_t params = {0};
+    params.type = IREE_HAL_MEMORY_TYPE_DEVICE_LOCAL;
+    params.access = IREE_HAL_MEMORY_ACCESS_ALL;
+    params.usage = IREE_HAL_BUFFER_USAGE_TRANSFER;
+    iree_hal_buffer_t* buffer = NULL;
+    IREE_CHECK_OK(iree_hal_allocator_allocate_buffer(
+        allocator, params, contents.size(),
+        iree_make_const_byte_span(contents.data(), contents.size()), &buffer));
+    return buffer;
+  }
+
+  static std::vector<uint8_t> ReadBuffer(iree_hal_buffer_t* buffer) {
+    std::vector<uint8_t> contents(iree_hal_buffer_byte_length(buffer));
+    IREE_CHECK_OK(iree_hal_buffer_map_read(buffer, 0, contents.data(),
+                                           contents.size()));
+    return contents;
+  }
+
+  static peer_allocator_t* Peer(iree_hal_allocator_t* allocator) {
+    return (peer_allocator_t*)allocator;
+  }
+
+  iree_hal_allocator_t* device_allocator_ = NULL;
+  iree_hal_allocator_t* peer_device_allocator_ = NULL;
+  iree_hal_device_t* device_ = NULL;
+};
+
+// Buffers owned by the transferring device are used as-is.
+TEST_F(BufferTransferTest, LocalBuffersAreNotImported) {
+  CreateDevices(/*supports_peer_access=*/true);
+  iree_hal_buffer_t* source = AllocateBuffer(device_allocator_, {1, 2, 3, 4});
+  iree_hal_buffer_t* target = AllocateBuffer(device_allocator_, {0, 0, 0, 0});
+
+  IREE_ASSERT_OK(iree_hal_device_submit_transfer_range_and_wait(
+      device_, iree_hal_make_device_transfer_buffer(source), 0,
+      iree_hal_make_device_transfer_buffer(target), 0, IREE_WHOLE_BUFFER,
+      IREE_HAL_TRANSFER_BUFFER_FLAG_DEFAULT, iree_infinite_timeout()));
+  EXPECT_EQ(ReadBuffer(target), (std::vector<uint8_t>{1, 2, 3, 4}));
+  EXPECT_EQ(Peer(device_allocator_)->import_count, 0);
+  EXPECT_EQ(Peer(device_allocator_)->export_count, 0);
+
+  iree_hal_buffer_release(target);
+  iree_hal_buffer_release(source);
+}
+
+// Buffers allocated by a peer device are exported by the peer and imported
+// into the transferring device for both the source and the target.
+TEST_F(BufferTransferTest, ImportsPeerBuffers) {
+  CreateDevices(/*supports_peer_access=*/true);
+  iree_hal_buffer_t* source =
+      AllocateBuffer(peer_device_allocator_, {1, 2, 3, 4});
+  iree_hal_buffer_t* target =
+      AllocateBuffer(peer_device_allocator_, {0, 0, 0, 0});
+
+  IREE_ASSERT_OK(iree_hal_device_submit_transfer_range_and_wait(
+      device_, iree_hal_make_device_transfer_buffer(source), 0,
+      iree_hal_make_device_transfer_buffer(target), 0, IREE_WHOLE_BUFFER,
+      IREE_HAL_TRANSFER_BUFFER_FLAG_DEFAULT, iree_infinite_timeout()));
+  EXPECT_EQ(ReadBuffer(target), (std::vector<uint8_t>{1, 2, 3, 4}));
+  EXPECT_EQ(Peer(peer_device_allocator_)->export_count, 2);
+  EXPECT_EQ(Peer(device_allocator_)->import_count, 2);
+
+  iree_hal_buffer_release(target);
+  iree_hal_buffer_release(source);
+}
+
+// Imported buffers cover the entire peer allocation so offsets of subspans
+// must be rebased onto them and whole-buffer lengths resolved against the
+// original subspans.
+TEST_F(BufferTransferTest, ImportsPeerSubspans) {
+  CreateDevices(/*supports_peer_access=*/true);
+  iree_hal_buffer_t* source_allocation =
+      AllocateBuffer(peer_device_allocator_, {1, 2, 3, 4, 5, 6, 7, 8});
+  iree_hal_buffer_t* source = NULL;
+  IREE_ASSERT_OK(iree_hal_buffer_subspan(source_allocation, /*byte_offset=*/2,
+                                         /*byte_length=*/4, &source));
+  iree_hal_buffer_t* target =
+      AllocateBuffer(peer_device_allocator_, {0, 0, 0, 0, 0, 0, 0, 0});
+
+  IREE_ASSERT_OK(iree_hal_device_submit_transfer_range_and_wait(
+      device_, iree_hal_make_device_transfer_buffer(source),
+      /*source_offset=*/1, iree_hal_make_device_transfer_buffer(target),
+      /*target_offset=*/4, IREE_WHOLE_BUFFER,
+      IREE_HAL_TRANSFER_BUFFER_FLAG_DEFAULT, iree_infinite_timeout()));
+  EXPECT_EQ(ReadBuffer(target), (std::vector<uint8_t>{0, 0, 0, 0, 4, 5, 6, 0}));
+  EXPECT_EQ(Peer(device_allocator_)->import_count, 2);
+
+  iree_hal_buffer_release(target);
+  iree_hal_buffer_release(source);
+  iree_hal_buffer_release(source_allocation);
+}
+
+// The imported buffers retain the peer allocations until the transfer
+// completes and are released before it returns.
+TEST_F(BufferTransferTest, ReleasesImportedBuffers) {
+  CreateDevices(/*supports_peer_access=*/true);
+  iree_hal_buffer_t* source =
+      AllocateBuffer(peer_device_allocator_, {1, 2, 3, 4});
+  iree_hal_buffer_t* target =
+      AllocateBuffer(peer_device_allocator_, {0, 0, 0, 0});
+
+  IREE_ASSERT_OK(iree_hal_device_submit_transfer_range_and_wait(
+      device_, iree_hal_make_device_transfer_buffer(source), 0,
+      iree_hal_make_device_transfer_buffer(target), 0, IREE_WHOLE_BUFFER,
+      IREE_HAL_TRANSFER_BUFFER_FLAG_DEFAULT, iree_infinite_timeout()));
+  EXPECT_EQ(Peer(device_allocator_)->import_count, 2);
+  EXPECT_EQ(Peer(device_allocator_)->live_buffer_count, 0);
+  EXPECT_EQ(Peer(peer_device_allocator_)->live_buffer_count, 2);
+
+  iree_hal_buffer_release(target);
+  iree_hal_buffer_release(source);
+  EXPECT_EQ(Peer(peer_device_allocator_)->live_buffer_count, 0);
+}
+
+// Devices that are unable to share memory fall back to the existing paths.
+TEST_F(BufferTransferTest, FallsBackWithoutPeerAccess) {
+  CreateDevices(/*supports_peer_access=*/false);
+  iree_hal_buffer_t* source =
+      AllocateBuffer(peer_device_allocator_, {1, 2, 3, 4});
+  iree_hal_buffer_t* target =
+      AllocateBuffer(peer_device_allocator_, {0, 0, 0, 0});
+
+  IREE_ASSERT_OK(iree_hal_device_submit_transfer_range_and_wait(
+      device_, iree_hal_make_device_transfer_buffer(source), 0,
+      iree_hal_make_device_transfer_buffer(target), 0, IREE_WHOLE_BUFFER,
+      IREE_HAL_TRANSFER_BUFFER_FLAG_DEFAULT, iree_infinite_timeout()));
+  EXPECT_EQ(ReadBuffer(target), (std::vector<uint8_t>{1, 2, 3, 4}));
+  EXPECT_EQ(Peer(device_allocator_)->import_count, 0);
+
+  iree_hal_buffer_release(target);
+  iree_hal_buffer_release(source);
+}
+
+}  // namespace
+}  // namespace hal
+}  // namespace iree
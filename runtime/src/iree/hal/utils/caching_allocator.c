@@ -0,0 +1,493 @@
+// Copyright 2023 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include "iree/hal/utils/caching_allocator.h"
+
+#include <stddef.h>
+#include <string.h>
+
+#include "iree/base/internal/math.h"
+#include "iree/base/internal/synchronization.h"
+#include "iree/base/tracing.h"
+
+// Maximum number of distinct buffer parameter signatures tracked. Programs
+// generally use a handful; requests with new signatures beyond this are passed
+// through to the device allocator.
+#define IREE_HAL_CACHING_ALLOCATOR_MAX_SIGNATURES 16
+
+// One bucket per size class from the minimum class size up to 2^63.
+#define IREE_HAL_CACHING_ALLOCATOR_BUCKET_COUNT \
+  ((64 - 12) * IREE_HAL_CACHING_ALLOCATOR_CLASSES_PER_POWER_OF_TWO)
+
+//===----------------------------------------------------------------------===//
+// Size classes
+//===----------------------------------------------------------------------===//
+
+static int iree_hal_caching_allocator_min_class_log2(void) {
+  return iree_math_count_trailing_zeros_u64(
+      IREE_HAL_CACHING_ALLOCATOR_MIN_CLASS_SIZE);
+}
+
+// Returns the index of the smallest size class that fits |size| and stores the
+// size of the class in |out_class_size|.
+static iree_host_size_t iree_hal_caching_allocator_class_ceil(
+    iree_device_size_t size, iree_device_size_t* out_class_size) {
+  if (size <= IREE_HAL_CACHING_ALLOCATOR_MIN_CLASS_SIZE) {
+    *out_class_size = IREE_HAL_CACHING_ALLOCATOR_MIN_CLASS_SIZE;
+    return 0;
+  }
+  int k = 63 - iree_math_count_leading_zeros_u64(size);
+  iree_device_size_t base = 1ull << k;
+  iree_device_size_t step =
+      base / IREE_HAL_CACHING_ALLOCATOR_CLASSES_PER_POWER_OF_TWO;
+  iree_device_size_t class_size = iree_device_align(size, step);
+  iree_host_size_t j = (iree_host_size_t)((class_size - base) / step);
+  if (j == IREE_HAL_CACHING_ALLOCATOR_CLASSES_PER_POWER_OF_TWO) {
+    // Rounded up to the next power of two.
+    ++k;
+    j = 0;
+  }
+  *out_class_size = class_size;
+  return (k - iree_hal_caching_allocator_min_class_log2()) *
+             IREE_HAL_CACHING_ALLOCATOR_CLASSES_PER_POWER_OF_TWO +
+         j;
+}
+
+// Returns the index of the largest size class that fits within |size|.
+// Device allocators may round allocations up and flooring ensures a buffer is
+// only ever reused for requests it can satisfy. |size| must be at least the
+// minimum class size.
+static iree_host_size_t iree_hal_caching_allocator_class_floor(
+    iree_device_size_t size) {
+  int k = 63 - iree_math_count_leading_zeros_u64(size);
+  iree_device_size_t base = 1ull << k;
+  iree_device_size_t step =
+      base / IREE_HAL_CACHING_ALLOCATOR_CLASSES_PER_POWER_OF_TWO;
+  iree_host_size_t j = (iree_host_size_t)((size - base) / step);
+  return (k - iree_hal_caching_allocator_min_class_log2()) *
+             IREE_HAL_CACHING_ALLOCATOR_CLASSES_PER_POWER_OF_TWO +
+         j;
+}
+
+//===----------------------------------------------------------------------===//
+// iree_hal_caching_allocator_t
+//===----------------------------------------------------------------------===//
+
+// Maps requested buffer parameters to the properties of the buffers the device
+// allocator produces for them. Cached buffers are identified by their
+// properties when released and reused for any signature producing the same.
+typedef struct iree_hal_caching_allocator_signature_t {
+  iree_hal_buffer_params_t params;
+  iree_hal_memory_type_t memory_type;
+  iree_hal_buffer_usage_t allowed_usage;
+  iree_hal_memory_access_t allowed_access;
+} iree_hal_caching_allocator_signature_t;
+
+typedef struct iree_hal_caching_allocator_entry_t {
+  struct iree_hal_caching_allocator_entry_t* next;
+  iree_hal_buffer_t* buffer;
+} iree_hal_caching_allocator_entry_t;
+
+typedef struct iree_hal_caching_allocator_t {
+  iree_hal_resource_t resource;
+  iree_allocator_t host_allocator;
+  iree_hal_allocator_t* device_allocator;
+  iree_hal_caching_allocator_options_t options;
+
+  iree_slim_mutex_t mutex;
+
+  iree_host_size_t signature_count IREE_GUARDED_BY(mutex);
+  iree_hal_caching_allocator_signature_t
+      signatures[IREE_HAL_CACHING_ALLOCATOR_MAX_SIGNATURES] IREE_GUARDED_BY(
+          mutex);
+
+  // Total allocation size of all buffers in the buckets.
+  iree_device_size_t cached_size IREE_GUARDED_BY(mutex);
+  // Released buffers by size class.
+  iree_hal_caching_allocator_entry_t*
+      buckets[IREE_HAL_CACHING_ALLOCATOR_BUCKET_COUNT] IREE_GUARDED_BY(mutex);
+  // Unused entries available for reuse.
+  iree_hal_caching_allocator_entry_t* entry_pool IREE_GUARDED_BY(mutex);
+
+  IREE_STATISTICS(uint64_t cache_hits IREE_GUARDED_BY(mutex);)
+  IREE_STATISTICS(uint64_t cache_misses IREE_GUARDED_BY(mutex);)
+} iree_hal_caching_allocator_t;
+
+static const iree_hal_allocator_vtable_t iree_hal_caching_allocator_vtable;
+
+static iree_hal_caching_allocator_t* iree_hal_caching_allocator_cast(
+    iree_hal_allocator_t* IREE_RESTRICT base_value) {
+  IREE_HAL_ASSERT_TYPE(base_value, &iree_hal_caching_allocator_vtable);
+  return (iree_hal_caching_allocator_t*)base_value;
+}
+
+IREE_API_EXPORT void iree_hal_caching_allocator_options_initialize(
+    iree_hal_caching_allocator_options_t* out_options) {
+  memset(out_options, 0, sizeof(*out_options));
+  out_options->max_cached_size = 256 * 1024 * 1024;
+  out_options->max_allocation_size = 0;
+}
+
+IREE_API_EXPORT iree_status_t iree_hal_caching_allocator_create(
+    iree_hal_allocator_t* device_allocator,
+    const iree_hal_caching_allocator_options_t* options,
+    iree_allocator_t host_allocator, iree_hal_allocator_t** out_allocator) {
+  IREE_ASSERT_ARGUMENT(device_allocator);
+  IREE_ASSERT_ARGUMENT(options);
+  IREE_ASSERT_ARGUMENT(out_allocator);
+  IREE_TRACE_ZONE_BEGIN(z0);
+  *out_allocator = NULL;
+
+  iree_hal_caching_allocator_t* allocator = NULL;
+  iree_status_t status = iree_allocator_malloc(
+      host_allocator, sizeof(*allocator), (void**)&allocator);
+  if (iree_status_is_ok(status)) {
+    memset(allocator, 0, sizeof(*allocator));
+    iree_hal_resource_initialize(&iree_hal_caching_allocator_vtable,
+                                 &allocator->resource);
+    allocator->host_allocator = host_allocator;
+    allocator->device_allocator = device_allocator;
+    iree_hal_allocator_retain(device_allocator);
+    allocator->options = *options;
+    if (!allocator->options.max_allocation_size) {
+      allocator->options.max_allocation_size = options->max_cached_size;
+    }
+    iree_slim_mutex_initialize(&allocator->mutex);
+    *out_allocator = (iree_hal_allocator_t*)allocator;
+  }
+
+  IREE_TRACE_ZONE_END(z0);
+  return status;
+}
+
+// Returns |buffer| to the device allocator it was allocated from.
+static void iree_hal_caching_allocator_free_buffer(
+    iree_hal_caching_allocator_t* allocator, iree_hal_buffer_t* buffer) {
+  buffer->device_allocator = allocator->device_allocator;
+  iree_hal_allocator_deallocate_buffer(allocator->device_allocator, buffer);
+}
+
+// Frees all cached buffers and unused entries.
+static void iree_hal_caching_allocator_flush(
+    iree_hal_caching_allocator_t* allocator) {
+  iree_hal_caching_allocator_entry_t* entries = NULL;
+  iree_slim_mutex_lock(&allocator->mutex);
+  for (iree_host_size_t i = 0; i < IREE_ARRAYSIZE(allocator->buckets); ++i) {
+    while (allocator->buckets[i]) {
+      iree_hal_caching_allocator_entry_t* entry = allocator->buckets[i];
+      allocator->buckets[i] = entry->next;
+      entry->next = entries;
+      entries = entry;
+    }
+  }
+  while (allocator->entry_pool) {
+    iree_hal_caching_allocator_entry_t* entry = allocator->entry_pool;
+    allocator->entry_pool = entry->next;
+    entry->buffer = NULL;
+    entry->next = entries;
+    entries = entry;
+  }
+  allocator->cached_size = 0;
+  iree_slim_mutex_unlock(&allocator->mutex);
+
+  // Return the buffers outside of the lock as device allocators may be slow.
+  while (entries) {
+    iree_hal_caching_allocator_entry_t* entry = entries;
+    entries = entry->next;
+    if (entry->buffer) {
+      iree_hal_caching_allocator_free_buffer(allocator, entry->buffer);
+    }
+    iree_allocator_free(allocator->host_allocator, entry);
+  }
+}
+
+static void iree_hal_caching_allocator_destroy(
+    iree_hal_allocator_t* IREE_RESTRICT base_allocator) {
+  iree_hal_caching_allocator_t* allocator =
+      iree_hal_caching_allocator_cast(base_allocator);
+  iree_allocator_t host_allocator = allocator->host_allocator;
+  IREE_TRACE_ZONE_BEGIN(z0);
+
+  iree_hal_caching_allocator_flush(allocator);
+  iree_slim_mutex_deinitialize(&allocator->mutex);
+  iree_hal_allocator_release(allocator->device_allocator);
+  iree_allocator_free(host_allocator, allocator);
+
+  IREE_TRACE_ZONE_END(z0);
+}
+
+static iree_allocator_t iree_hal_caching_allocator_host_allocator(
+    const iree_hal_allocator_t* IREE_RESTRICT base_allocator) {
+  iree_hal_caching_allocator_t* allocator =
+      (iree_hal_caching_allocator_t*)base_allocator;
+  return allocator->host_allocator;
+}
+
+static iree_status_t iree_hal_caching_allocator_trim(
+    iree_hal_allocator_t* IREE_RESTRICT base_allocator) {
+  iree_hal_caching_allocator_t* allocator =
+      iree_hal_caching_allocator_cast(base_allocator);
+  IREE_TRACE_ZONE_BEGIN(z0);
+  iree_hal_caching_allocator_flush(allocator);
+  iree_status_t status = iree_hal_allocator_trim(allocator->device_allocator);
+  IREE_TRACE_ZONE_END(z0);
+  return status;
+}
+
+static void iree_hal_caching_allocator_query_statistics(
+    iree_hal_allocator_t* IREE_RESTRICT base_allocator,
+    iree_hal_allocator_statistics_t* IREE_RESTRICT out_statistics) {
+  iree_hal_caching_allocator_t* allocator =
+      iree_hal_caching_allocator_cast(base_allocator);
+  iree_hal_allocator_query_statistics(allocator->device_allocator,
+                                      out_statistics);
+  IREE_STATISTICS({
+    iree_slim_mutex_lock(&allocator->mutex);
+    out_statistics->cache_hits += allocator->cache_hits;
+    out_statistics->cache_misses += allocator->cache_misses;
+    iree_slim_mutex_unlock(&allocator->mutex);
+  });
+}
+
+static iree_hal_buffer_compatibility_t
+iree_hal_caching_allocator_query_compatibility(
+    iree_hal_allocator_t* IREE_RESTRICT base_allocator,
+    const iree_hal_buffer_params_t* IREE_RESTRICT params,
+    iree_device_size_t allocation_size) {
+  iree_hal_caching_allocator_t* allocator =
+      iree_hal_caching_allocator_cast(base_allocator);
+  return iree_hal_allocator_query_compatibility(
+      allocator->device_allocator, *params, allocation_size);
+}
+
+static bool iree_hal_caching_allocator_params_equal(
+    const iree_hal_buffer_params_t* lhs, const iree_hal_buffer_params_t* rhs) {
+  return lhs->usage == rhs->usage && lhs->access == rhs->access &&
+         lhs->type == rhs->type && lhs->queue_affinity == rhs->queue_affinity &&
+         lhs->min_alignment == rhs->min_alignment;
+}
+
+static bool iree_hal_caching_allocator_signature_matches_buffer(
+    const iree_hal_caching_allocator_signature_t* signature,
+    const iree_hal_buffer_t* buffer) {
+  return signature->memory_type == buffer->memory_type &&
+         signature->allowed_usage == buffer->allowed_usage &&
+         signature->allowed_access == buffer->allowed_access;
+}
+
+static iree_hal_caching_allocator_signature_t*
+iree_hal_caching_allocator_find_signature(
+    iree_hal_caching_allocator_t* allocator,
+    const iree_hal_buffer_params_t* params) {
+  for (iree_host_size_t i = 0; i < allocator->signature_count; ++i) {
+    if (iree_hal_caching_allocator_params_equal(
+            &allocator->signatures[i].params, params)) {
+      return &allocator->signatures[i];
+    }
+  }
+  return NULL;
+}
+
+// Records the properties of |buffer| allocated for |params| so that it and
+// later buffers allocated with the same |params| can be cached. Returns false
+// if buffers for |params| cannot be cached: a buffer is identified only by its
+// properties when released so two signatures may only share properties if
+// their placement and alignment requirements also match.
+static bool iree_hal_caching_allocator_register_signature(
+    iree_hal_caching_allocator_t* allocator,
+    const iree_hal_buffer_params_t* params, const iree_hal_buffer_t* buffer) {
+  if (iree_hal_caching_allocator_find_signature(allocator, params)) {
+    return true;
+  }
+  for (iree_host_size_t i = 0; i < allocator->signature_count; ++i) {
+    const iree_hal_caching_allocator_signature_t* signature =
+        &allocator->signatures[i];
+    if (iree_hal_caching_allocator_signature_matches_buffer(signature,
+                                                            buffer) &&
+        (signature->params.queue_affinity != params->queue_affinity ||
+         signature->params.min_alignment != params->min_alignment)) {
+      return false;
+    }
+  }
+  if (allocator->signature_count >= IREE_ARRAYSIZE(allocator->signatures)) {
+    return false;
+  }
+  iree_hal_caching_allocator_signature_t* signature =
+      &allocator->signatures[allocator->signature_count++];
+  signature->params = *params;
+  signature->memory_type = buffer->memory_type;
+  signature->allowed_usage = buffer->allowed_usage;
+  signature->allowed_access = buffer->allowed_access;
+  return true;
+}
+
+// Removes and returns a cached buffer from bucket |class_index| allocated with
+// the properties of |signature|, if any.
+static iree_hal_buffer_t* iree_hal_caching_allocator_pop_buffer(
+    iree_hal_caching_allocator_t* allocator,
+    const iree_hal_caching_allocator_signature_t* signature,
+    iree_host_size_t class_index) {
+  iree_hal_caching_allocator_entry_t** entry_ptr =
+      &allocator->buckets[class_index];
+  while (*entry_ptr) {
+    iree_hal_caching_allocator_entry_t* entry = *entry_ptr;
+    if (iree_hal_caching_allocator_signature_matches_buffer(signature,
+                                                            entry->buffer)) {
+      iree_hal_buffer_t* buffer = entry->buffer;
+      *entry_ptr = entry->next;
+      entry->buffer = NULL;
+      entry->next = allocator->entry_pool;
+      allocator->entry_pool = entry;
+      allocator->cached_size -= buffer->allocation_size;
+      return buffer;
+    }
+    entry_ptr = &entry->next;
+  }
+  return NULL;
+}
+
+static iree_status_t iree_hal_caching_allocator_allocate_buffer(
+    iree_hal_allocator_t* IREE_RESTRICT base_allocator,
+    const iree_hal_buffer_params_t* IREE_RESTRICT params,
+    iree_device_size_t allocation_size, iree_const_byte_span_t initial_data,
+    iree_hal_buffer_t** IREE_RESTRICT out_buffer) {
+  iree_hal_caching_allocator_t* allocator =
+      iree_hal_caching_allocator_cast(base_allocator);
+
+  // Buffers with initial data would need to be written after reuse and large
+  // buffers would quickly exhaust the budget so neither are cached.
+  if (!iree_const_byte_span_is_empty(initial_data) ||
+      allocation_size > allocator->options.max_allocation_size) {
+    return iree_hal_allocator_allocate_buffer(
+        allocator->device_allocator, *params, allocation_size, initial_data,
+        out_buffer);
+  }
+
+  iree_device_size_t class_size = 0;
+  iree_host_size_t class_index =
+      iree_hal_caching_allocator_class_ceil(allocation_size, &class_size);
+
+  // Try to reuse a cached buffer of the size class.
+  iree_hal_buffer_t* buffer = NULL;
+  iree_slim_mutex_lock(&allocator->mutex);
+  const iree_hal_caching_allocator_signature_t* signature =
+      iree_hal_caching_allocator_find_signature(allocator, params);
+  if (signature) {
+    buffer = iree_hal_caching_allocator_pop_buffer(allocator, signature,
+                                                   class_index);
+  }
+  IREE_STATISTICS({
+    if (buffer) {
+      ++allocator->cache_hits;
+    } else {
+      ++allocator->cache_misses;
+    }
+  });
+  iree_slim_mutex_unlock(&allocator->mutex);
+  if (buffer) {
+    // Revive the released buffer; no one else has a reference to it.
+    iree_atomic_ref_count_init(&buffer->resource.ref_count);
+    buffer->byte_length = allocation_size;
+    *out_buffer = buffer;
+    return iree_ok_status();
+  }
+
+  // Allocate a new buffer rounded up to the size class so that it can be
+  // reused by any allocation in the class once released.
+  IREE_TRACE_ZONE_BEGIN(z0);
+  IREE_TRACE_ZONE_APPEND_VALUE(z0, (int64_t)class_size);
+  IREE_RETURN_AND_END_ZONE_IF_ERROR(
+      z0, iree_hal_allocator_allocate_buffer(allocator->device_allocator,
+                                             *params, class_size,
+                                             iree_const_byte_span_empty(),
+                                             &buffer));
+  iree_slim_mutex_lock(&allocator->mutex);
+  bool cacheable =
+      iree_hal_caching_allocator_register_signature(allocator, params, buffer);
+  iree_slim_mutex_unlock(&allocator->mutex);
+  if (cacheable) {
+    // Route the release of the buffer back to us.
+    buffer->device_allocator = base_allocator;
+  }
+  buffer->byte_length = allocation_size;
+  *out_buffer = buffer;
+  IREE_TRACE_ZONE_END(z0);
+  return iree_ok_status();
+}
+
+static void iree_hal_caching_allocator_deallocate_buffer(
+    iree_hal_allocator_t* IREE_RESTRICT base_allocator,
+    iree_hal_buffer_t* IREE_RESTRICT base_buffer) {
+  iree_hal_caching_allocator_t* allocator =
+      iree_hal_caching_allocator_cast(base_allocator);
+
+  iree_slim_mutex_lock(&allocator->mutex);
+  bool cached = false;
+  if (allocator->cached_size + base_buffer->allocation_size <=
+      allocator->options.max_cached_size) {
+    iree_hal_caching_allocator_entry_t* entry = allocator->entry_pool;
+    if (entry) {
+      allocator->entry_pool = entry->next;
+    } else if (!iree_status_is_ok(iree_allocator_malloc(
+                   allocator->host_allocator, sizeof(*entry),
+                   (void**)&entry))) {
+      // Not fatal; the buffer is just freed instead.
+      entry = NULL;
+    }
+    if (entry) {
+      iree_host_size_t class_index =
+          iree_hal_caching_allocator_class_floor(base_buffer->allocation_size);
+      entry->buffer = base_buffer;
+      entry->next = allocator->buckets[class_index];
+      allocator->buckets[class_index] = entry;
+      allocator->cached_size += base_buffer->allocation_size;
+      cached = true;
+    }
+  }
+  iree_slim_mutex_unlock(&allocator->mutex);
+
+  if (!cached) {
+    iree_hal_caching_allocator_free_buffer(allocator, base_buffer);
+  }
+}
+
+static iree_status_t iree_hal_caching_allocator_import_buffer(
+    iree_hal_allocator_t* IREE_RESTRICT base_allocator,
+    const iree_hal_buffer_params_t* IREE_RESTRICT params,
+    iree_hal_external_buffer_t* IREE_RESTRICT external_buffer,
+    iree_hal_buffer_release_callback_t release_callback,
+    iree_hal_buffer_t** IREE_RESTRICT out_buffer) {
+  iree_hal_caching_allocator_t* allocator =
+      iree_hal_caching_allocator_cast(base_allocator);
+  return iree_hal_allocator_import_buffer(allocator->device_allocator, *params,
+                                          external_buffer, release_callback,
+                                          out_buffer);
+}
+
+static iree_status_t iree_hal_caching_allocator_export_buffer(
+    iree_hal_allocator_t* IREE_RESTRICT base_allocator,
+    iree_hal_buffer_t* IREE_RESTRICT buffer,
+    iree_hal_external_buffer_type_t requested_type,
+    iree_hal_external_buffer_flags_t requested_flags,
+    iree_hal_external_buffer_t* IREE_RESTRICT out_external_buffer) {
+  iree_hal_caching_allocator_t* allocator =
+      iree_hal_caching_allocator_cast(base_allocator);
+  return iree_hal_allocator_export_buffer(allocator->device_allocator, buffer,
+                                          requested_type, requested_flags,
+                                          out_external_buffer);
+}
+
+static const iree_hal_allocator_vtable_t iree_hal_caching_allocator_vtable = {
+    .destroy = iree_hal_caching_allocator_destroy,
+    .host_allocator = iree_hal_caching_allocator_host_allocator,
+    .trim = iree_hal_caching_allocator_trim,
+    .query_statistics = iree_hal_caching_allocator_query_statistics,
+    .query_compatibility = iree_hal_caching_allocator_query_compatibility,
+    .allocate_buffer = iree_hal_caching_allocator_allocate_buffer,
+    .deallocate_buffer = iree_hal_caching_allocator_deallocate_buffer,
+    .import_buffer = iree_hal_caching_allocator_import_buffer,
+    .export_buffer = iree_hal_caching_allocator_export_buffer,
+};
@@ -0,0 +1,69 @@
+// Copyright 2023 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#ifndef IREE_HAL_UTILS_CACHING_ALLOCATOR_H_
+#define IREE_HAL_UTILS_CACHING_ALLOCATOR_H_
+
+#include "iree/base/api.h"
+#include "iree/hal/api.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif  // __cplusplus
+
+// Smallest size class; smaller allocations are rounded up to this.
+#define IREE_HAL_CACHING_ALLOCATOR_MIN_CLASS_SIZE ((iree_device_size_t)4096)
+
+// Number of size classes each power of two is split into. Allocations are
+// rounded up to the next class, wasting at most 1/N of the allocation.
+#define IREE_HAL_CACHING_ALLOCATOR_CLASSES_PER_POWER_OF_TWO 4
+
+typedef struct iree_hal_caching_allocator_options_t {
+  // Maximum total size of released buffers retained for reuse. Buffers
+  // released while the cache is full are returned to the device allocator.
+  // If 0 then caching is disabled and all calls pass through.
+  iree_device_size_t max_cached_size;
+
+  // Largest allocation that will be cached. Larger allocations are passed
+  // through to the device allocator unmodified.
+  // If 0 then max_cached_size is used.
+  iree_device_size_t max_allocation_size;
+} iree_hal_caching_allocator_options_t;
+
+// Initializes |out_options| to their defaults.
+IREE_API_EXPORT void iree_hal_caching_allocator_options_initialize(
+    iree_hal_caching_allocator_options_t* out_options);
+
+// Creates an allocator that caches buffers released by its users and reuses
+// them for later allocations with the same parameters and size class.
+//
+// Buffers are allocated from |device_allocator| with their size rounded up to
+// a size class and returned with the requested byte length. When released they
+// are retained in a bucket for their size class instead of being freed so that
+// programs issuing the same transient allocations repeatedly (as is common in
+// per-invocation scratch memory) no longer pay for device allocation and
+// deallocation each time. A cached buffer is only reused for requests with the
+// exact same buffer parameters so memory types, usage, access, and affinity
+// are always respected.
+//
+// Allocations with initial data, imports, and exports are passed through.
+// Cached buffers are returned to |device_allocator| by
+// iree_hal_allocator_trim and when the caching allocator is destroyed. Hits
+// and misses are reported through iree_hal_allocator_query_statistics along
+// with the statistics of |device_allocator|.
+//
+// |device_allocator| is retained for the lifetime of the caching allocator and
+// the caching allocator must outlive all of the buffers allocated from it.
+IREE_API_EXPORT iree_status_t iree_hal_caching_allocator_create(
+    iree_hal_allocator_t* device_allocator,
+    const iree_hal_caching_allocator_options_t* options,
+    iree_allocator_t host_allocator, iree_hal_allocator_t** out_allocator);
+
+#ifdef __cplusplus
+}  // extern "C"
+#endif  // __cplusplus
+
+#endif  // IREE_HAL_UTILS_CACHING_ALLOCATOR_H_
@@ -0,0 +1,185 @@
+// Copyright 2023 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include "iree/hal/utils/caching_allocator.h"
+
+#include <cstddef>
+#include <cstdint>
+
+#include "iree/base/api.h"
+#include "iree/hal/api.h"
+#include "iree/testing/gtest.h"
+#include "iree/testing/status_matchers.h"
+
+namespace iree {
+namespace hal {
+namespace {
+
+class CachingAllocatorTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    IREE_ASSERT_OK(iree_hal_allocator_create_heap(
+        iree_make_cstring_view("heap"), iree_allocator_system(),
+        iree_allocator_system(), &device_allocator_));
+  }
+
+  void TearDown() override { iree_hal_allocator_release(device_allocator_); }
+
+  iree_hal_allocator_t* CreateCachingAllocator(
+      iree_device_size_t max_cached_size) {
+    iree_hal_caching_allocator_options_t options;
+    iree_hal_caching_allocator_options_initialize(&options);
+    options.max_cached_size = max_cached_size;
+    iree_hal_allocator_t* allocator = NULL;
+    IREE_CHECK_OK(iree_hal_caching_allocator_create(
+        device_allocator_, &options, iree_allocator_system(), &allocator));
+    return allocator;
+  }
+
+  static iree_hal_buffer_params_t DefaultParams() {
+    iree_hal_buffer_params_t params = {0};
+    params.type =
+        IREE_HAL_MEMORY_TYPE_DEVICE_LOCAL | IREE_HAL_MEMORY_TYPE_HOST_VISIBLE;
+    params.usage = IREE_HAL_BUFFER_USAGE_DEFAULT;
+    return params;
+  }
+
+  iree_hal_allocator_t* device_allocator_ = NULL;
+};
+
+// Releasing a buffer and allocating another of the same size class returns the
+// same buffer with the new length.
+TEST_F(CachingAllocatorTest, ReusesReleasedBuffer) {
+  iree_hal_allocator_t* allocator = CreateCachingAllocator(1024 * 1024);
+
+  iree_hal_buffer_t* buffer0 = NULL;
+  IREE_ASSERT_OK(iree_hal_allocator_allocate_buffer(
+      allocator, DefaultParams(), 5000, iree_const_byte_span_empty(),
+      &buffer0));
+  EXPECT_EQ(iree_hal_buffer_byte_length(buffer0), 5000);
+  EXPECT_GE(iree_hal_buffer_allocation_size(buffer0), 5000);
+  iree_hal_buffer_release(buffer0);
+
+  iree_hal_buffer_t* buffer1 = NULL;
+  IREE_ASSERT_OK(iree_hal_allocator_allocate_buffer(
+      allocator, DefaultParams(), 5100, iree_const_byte_span_empty(),
+      &buffer1));
+  EXPECT_EQ(buffer1, buffer0);
+  EXPECT_EQ(iree_hal_buffer_byte_length(buffer1), 5100);
+
+  // The buffer must be fully usable after reuse.
+  uint32_t pattern = 0xCAFEF00Du;
+  IREE_ASSERT_OK(iree_hal_buffer_map_fill(buffer1, 0, IREE_WHOLE_BUFFER,
+                                          &pattern, sizeof(pattern)));
+  iree_hal_buffer_release(buffer1);
+
+#if IREE_STATISTICS_ENABLE
+  iree_hal_allocator_statistics_t statistics;
+  iree_hal_allocator_query_statistics(allocator, &statistics);
+  EXPECT_EQ(statistics.cache_hits, 1);
+  EXPECT_EQ(statistics.cache_misses, 1);
+#endif  // IREE_STATISTICS_ENABLE
+
+  iree_hal_allocator_release(allocator);
+}
+
+// Buffers are only reused for allocations with the same parameters and size
+// class.
+TEST_F(CachingAllocatorTest, DoesNotReuseMismatchedBuffers) {
+  iree_hal_allocator_t* allocator = CreateCachingAllocator(1024 * 1024);
+
+  iree_hal_buffer_t* buffer0 = NULL;
+  IREE_ASSERT_OK(iree_hal_allocator_allocate_buffer(
+      allocator, DefaultParams(), 8192, iree_const_byte_span_empty(),
+      &buffer0));
+
+  // Different size class, same parameters.
+  iree_hal_buffer_t* buffer1 = NULL;
+  IREE_ASSERT_OK(iree_hal_allocator_allocate_buffer(
+      allocator, DefaultParams(), 32 * 1024, iree_const_byte_span_empty(),
+      &buffer1));
+
+  // Same size class, different parameters.
+  iree_hal_buffer_params_t params = DefaultParams();
+  params.access = IREE_HAL_MEMORY_ACCESS_READ;
+  iree_hal_buffer_release(buffer0);
+  iree_hal_buffer_t* buffer2 = NULL;
+  IREE_ASSERT_OK(iree_hal_allocator_allocate_buffer(
+      allocator, params, 8192, iree_const_byte_span_empty(), &buffer2));
+  EXPECT_NE(buffer2, buffer0);
+  EXPECT_EQ(iree_hal_buffer_allowed_access(buffer2),
+            IREE_HAL_MEMORY_ACCESS_READ);
+
+  iree_hal_buffer_release(buffer1);
+  iree_hal_buffer_release(buffer2);
+
+#if IREE_STATISTICS_ENABLE
+  iree_hal_allocator_statistics_t statistics;
+  iree_hal_allocator_query_statistics(allocator, &statistics);
+  EXPECT_EQ(statistics.cache_hits, 0);
+  EXPECT_EQ(statistics.cache_misses, 3);
+#endif  // IREE_STATISTICS_ENABLE
+
+  iree_hal_allocator_release(allocator);
+}
+
+// Buffers released when the cache is full are returned to the device
+// allocator and trimming returns all cached buffers.
+TEST_F(CachingAllocatorTest, RespectsBudgetAndTrim) {
+  iree_hal_allocator_t* allocator = CreateCachingAllocator(16 * 1024);
+
+  iree_hal_buffer_t* buffers[3] = {NULL};
+  for (size_t i = 0; i < IREE_ARRAYSIZE(buffers); ++i) {
+    IREE_ASSERT_OK(iree_hal_allocator_allocate_buffer(
+        allocator, DefaultParams(), 8192, iree_const_byte_span_empty(),
+        &buffers[i]));
+  }
+  for (size_t i = 0; i < IREE_ARRAYSIZE(buffers); ++i) {
+    iree_hal_buffer_release(buffers[i]);
+  }
+
+#if IREE_STATISTICS_ENABLE
+  // Only two of the buffers fit in the cache.
+  iree_hal_allocator_statistics_t statistics;
+  iree_hal_allocator_query_statistics(device_allocator_, &statistics);
+  EXPECT_EQ(statistics.device_bytes_allocated - statistics.device_bytes_freed,
+            2 * 8192);
+#endif  // IREE_STATISTICS_ENABLE
+
+  IREE_ASSERT_OK(iree_hal_allocator_trim(allocator));
+
+#if IREE_STATISTICS_ENABLE
+  iree_hal_allocator_query_statistics(device_allocator_, &statistics);
+  EXPECT_EQ(statistics.device_bytes_allocated, statistics.device_bytes_freed);
+#endif  // IREE_STATISTICS_ENABLE
+
+  iree_hal_allocator_release(allocator);
+}
+
+// Allocations with initial data are passed through and never cached.
+TEST_F(CachingAllocatorTest, InitialDataIsNotCached) {
+  iree_hal_allocator_t* allocator = CreateCachingAllocator(1024 * 1024);
+
+  uint8_t data[8192] = {0x42};
+  iree_hal_buffer_t* buffer = NULL;
+  IREE_ASSERT_OK(iree_hal_allocator_allocate_buffer(
+      allocator, DefaultParams(), sizeof(data),
+      iree_make_const_byte_span(data, sizeof(data)), &buffer));
+  iree_hal_buffer_release(buffer);
+
+#if IREE_STATISTICS_ENABLE
+  iree_hal_allocator_statistics_t statistics;
+  iree_hal_allocator_query_statistics(allocator, &statistics);
+  EXPECT_EQ(statistics.device_bytes_allocated, statistics.device_bytes_freed);
+  EXPECT_EQ(statistics.cache_misses, 0);
+#endif  // IREE_STATISTICS_ENABLE
+
+  iree_hal_allocator_release(allocator);
+}
+
+}  // namespace
+}  // namespace hal
+}  // namespace iree
@@ -40,6 +40,14 @@ typedef enum iree_hal_command_type_e {
 // intent is that each command captures the exact information passed during the
 // call such that the target command buffer cannot tell they were deferred.
 //
+// The exceptions are a few transformations that are always legal under the HAL
+// execution model: commands between barriers have no ordering guarantees
+// relative to each other so contiguous fills and copies within the same
+// barrier region are merged, back-to-back barriers are merged, and transfers
+// are replayed ahead of dispatches in their region. Targets that pay a
+// per-command cost or batch transfers separately from dispatches benefit from
+// the reduced and grouped command stream.
+//
 // As each command is variable sized we store pointers to the following command
 // to allow us to walk the list during replay. Storing just a size would be
 // insufficient as commands may be spread across many arena blocks from the
@@ -70,6 +78,12 @@ typedef struct iree_hal_cmd_list_t {
   iree_hal_cmd_header_t* head;
   // Tail of the command list (may be head).
   iree_hal_cmd_header_t* tail;
+
+  // Most recent fill/copy command recorded in the current barrier region or
+  // NULL if none has been recorded since the last region boundary. Subsequent
+  // transfers that extend them are merged in place.
+  iree_hal_cmd_header_t* region_fill;
+  iree_hal_cmd_header_t* region_copy;
 } iree_hal_cmd_list_t;
 
 // Initializes a new command list that allocates from the given |block_pool|.
@@ -79,6 +93,8 @@ static void iree_hal_cmd_list_initialize(iree_arena_block_pool_t* block_pool,
   iree_arena_initialize(block_pool, &out_cmd_list->arena);
   out_cmd_list->head = NULL;
   out_cmd_list->tail = NULL;
+  out_cmd_list->region_fill = NULL;
+  out_cmd_list->region_copy = NULL;
 }
 
 // Returns true if the |cmd_list| is empty.
@@ -95,6 +111,8 @@ static void iree_hal_cmd_list_reset(iree_hal_cmd_list_t* cmd_list) {
   iree_arena_reset(&cmd_list->arena);
   cmd_list->head = NULL;
   cmd_list->tail = NULL;
+  cmd_list->region_fill = NULL;
+  cmd_list->region_copy = NULL;
 }
 
 // Deinitializes the command list, preparing for destruction.
@@ -102,6 +120,38 @@ static void iree_hal_cmd_list_deinitialize(iree_hal_cmd_list_t* cmd_list) {
   iree_hal_cmd_list_reset(cmd_list);
 }
 
+// Returns true if commands of |type| order the commands before and after them
+// and end the current barrier region. Commands within a region may execute in
+// any order relative to each other. Collectives and nested command buffers are
+// conservatively treated as boundaries as their contents are opaque.
+static bool iree_hal_cmd_type_is_region_boundary(iree_hal_cmd_type_t type) {
+  switch (type) {
+    case IREE_HAL_CMD_EXECUTION_BARRIER:
+    case IREE_HAL_CMD_SIGNAL_EVENT:
+    case IREE_HAL_CMD_RESET_EVENT:
+    case IREE_HAL_CMD_WAIT_EVENTS:
+    case IREE_HAL_CMD_COLLECTIVE:
+    case IREE_HAL_CMD_EXECUTE_COMMANDS:
+      return true;
+    default:
+      return false;
+  }
+}
+
+// Returns true if commands of |type| are transfers that do not interact with
+// any pipeline state and can be issued anywhere within their barrier region.
+static bool iree_hal_cmd_type_is_transfer(iree_hal_cmd_type_t type) {
+  switch (type) {
+    case IREE_HAL_CMD_DISCARD_BUFFER:
+    case IREE_HAL_CMD_FILL_BUFFER:
+    case IREE_HAL_CMD_UPDATE_BUFFER:
+    case IREE_HAL_CMD_COPY_BUFFER:
+      return true;
+    default:
+      return false;
+  }
+}
+
 // Appends a new command to the command list and returns the base pointer to its
 // storage. Callers must cast to the appropriate type and populate all fields.
 static iree_status_t iree_hal_cmd_list_append_command(
@@ -118,6 +168,10 @@ static iree_status_t iree_hal_cmd_list_append_command(
     cmd_list->tail->next = header;
   }
   cmd_list->tail = header;
+  if (iree_hal_cmd_type_is_region_boundary(command_type)) {
+    cmd_list->region_fill = NULL;
+    cmd_list->region_copy = NULL;
+  }
   *out_cmd = header;
   return iree_ok_status();
 }
@@ -266,6 +320,39 @@ static iree_status_t iree_hal_deferred_command_buffer_execution_barrier(
     const iree_hal_buffer_barrier_t* buffer_barriers) {
   iree_hal_cmd_list_t* cmd_list =
       &iree_hal_deferred_command_buffer_cast(base_command_buffer)->cmd_list;
+
+  // Back-to-back barriers with nothing between them are merged into the prior
+  // barrier by widening its scope. The barrier lists are only taken if the
+  // prior barrier had none as we can't extend them in-place.
+  if (cmd_list->tail &&
+      cmd_list->tail->type == IREE_HAL_CMD_EXECUTION_BARRIER) {
+    iree_hal_cmd_execution_barrier_t* prior_cmd =
+        (iree_hal_cmd_execution_barrier_t*)cmd_list->tail;
+    const bool has_barriers =
+        memory_barrier_count > 0 || buffer_barrier_count > 0;
+    const bool prior_has_barriers = prior_cmd->memory_barrier_count > 0 ||
+                                    prior_cmd->buffer_barrier_count > 0;
+    if (prior_cmd->flags == flags && (!has_barriers || !prior_has_barriers)) {
+      if (memory_barrier_count > 0) {
+        IREE_RETURN_IF_ERROR(iree_hal_cmd_list_clone_data(
+            cmd_list, memory_barriers,
+            sizeof(memory_barriers[0]) * memory_barrier_count,
+            (void**)&prior_cmd->memory_barriers));
+        prior_cmd->memory_barrier_count = memory_barrier_count;
+      }
+      if (buffer_barrier_count > 0) {
+        IREE_RETURN_IF_ERROR(iree_hal_cmd_list_clone_data(
+            cmd_list, buffer_barriers,
+            sizeof(buffer_barriers[0]) * buffer_barrier_count,
+            (void**)&prior_cmd->buffer_barriers));
+        prior_cmd->buffer_barrier_count = buffer_barrier_count;
+      }
+      prior_cmd->source_stage_mask |= source_stage_mask;
+      prior_cmd->target_stage_mask |= target_stage_mask;
+      return iree_ok_status();
+    }
+  }
+
   iree_hal_cmd_execution_barrier_t* cmd = NULL;
   IREE_RETURN_IF_ERROR(iree_hal_cmd_list_append_command(
       cmd_list, IREE_HAL_CMD_EXECUTION_BARRIER, sizeof(*cmd), (void**)&cmd));
@@ -494,6 +581,21 @@ static iree_status_t iree_hal_deferred_command_buffer_fill_buffer(
     return iree_make_status(IREE_STATUS_INVALID_ARGUMENT,
                             "fill patterns must be < 8 bytes");
   }
+  uint64_t pattern_value = 0;
+  memcpy(&pattern_value, pattern, pattern_length);
+
+  // Merge with the last fill in the region if this one extends it.
+  iree_hal_cmd_fill_buffer_t* prior_cmd =
+      (iree_hal_cmd_fill_buffer_t*)cmd_list->region_fill;
+  if (prior_cmd && prior_cmd->target_buffer == target_buffer &&
+      prior_cmd->pattern == pattern_value &&
+      prior_cmd->pattern_length == pattern_length &&
+      prior_cmd->length != IREE_WHOLE_BUFFER && length != IREE_WHOLE_BUFFER &&
+      prior_cmd->target_offset + prior_cmd->length == target_offset) {
+    prior_cmd->length += length;
+    return iree_ok_status();
+  }
+
   IREE_RETURN_IF_ERROR(iree_hal_resource_set_insert(
       command_buffer->resource_set, 1, &target_buffer));
   IREE_RETURN_IF_ERROR(iree_hal_cmd_list_append_command(
@@ -501,8 +603,9 @@ static iree_status_t iree_hal_deferred_command_buffer_fill_buffer(
   cmd->target_buffer = target_buffer;
   cmd->target_offset = target_offset;
   cmd->length = length;
-  memcpy(&cmd->pattern, pattern, pattern_length);
+  cmd->pattern = pattern_value;
   cmd->pattern_length = pattern_length;
+  cmd_list->region_fill = &cmd->header;
   return iree_ok_status();
 }
 
@@ -578,6 +681,19 @@ static iree_status_t iree_hal_deferred_command_buffer_copy_buffer(
   iree_hal_deferred_command_buffer_t* command_buffer =
       iree_hal_deferred_command_buffer_cast(base_command_buffer);
   iree_hal_cmd_list_t* cmd_list = &command_buffer->cmd_list;
+
+  // Merge with the last copy in the region if this one extends it.
+  iree_hal_cmd_copy_buffer_t* prior_cmd =
+      (iree_hal_cmd_copy_buffer_t*)cmd_list->region_copy;
+  if (prior_cmd && prior_cmd->source_buffer == source_buffer &&
+      prior_cmd->target_buffer == target_buffer &&
+      prior_cmd->length != IREE_WHOLE_BUFFER && length != IREE_WHOLE_BUFFER &&
+      prior_cmd->source_offset + prior_cmd->length == source_offset &&
+      prior_cmd->target_offset + prior_cmd->length == target_offset) {
+    prior_cmd->length += length;
+    return iree_ok_status();
+  }
+
   const void* buffers[2] = {source_buffer, target_buffer};
   IREE_RETURN_IF_ERROR(
       iree_hal_resource_set_insert(command_buffer->resource_set, 2, buffers));
@@ -589,6 +705,7 @@ static iree_status_t iree_hal_deferred_command_buffer_copy_buffer(
   cmd->target_buffer = target_buffer;
   cmd->target_offset = target_offset;
   cmd->length = length;
+  cmd_list->region_copy = &cmd->header;
   return iree_ok_status();
 }
 
@@ -736,9 +853,49 @@ static iree_status_t iree_hal_deferred_command_buffer_apply_push_descriptor_set(
     iree_hal_command_buffer_t* target_command_buffer,
     iree_hal_buffer_binding_table_t binding_table,
     const iree_hal_cmd_push_descriptor_set_t* cmd) {
+  // Fast path for when all bindings were direct at recording time; the
+  // recorded bindings can be passed through unmodified.
+  bool any_indirect = false;
+  for (iree_host_size_t i = 0; i < cmd->binding_count; ++i) {
+    if (!cmd->bindings[i].buffer) {
+      any_indirect = true;
+      break;
+    }
+  }
+  if (!any_indirect) {
+    return iree_hal_command_buffer_push_descriptor_set(
+        target_command_buffer, cmd->pipeline_layout, cmd->set,
+        cmd->binding_count, cmd->bindings);
+  }
+
+  // Resolve indirect bindings against the binding table provided at replay
+  // time. The slot offset is added to the base offset of the table entry.
+  iree_hal_descriptor_set_binding_t* bindings =
+      (iree_hal_descriptor_set_binding_t*)iree_alloca(
+          cmd->binding_count * sizeof(iree_hal_descriptor_set_binding_t));
+  for (iree_host_size_t i = 0; i < cmd->binding_count; ++i) {
+    iree_hal_descriptor_set_binding_t binding = cmd->bindings[i];
+    if (!binding.buffer) {
+      if (IREE_UNLIKELY(binding.buffer_slot >= binding_table.count)) {
+        return iree_make_status(
+            IREE_STATUS_OUT_OF_RANGE,
+            "bindings[%" PRIhsz "] references binding table slot %u but only "
+            "%" PRIhsz " bindings were provided",
+            i, binding.buffer_slot, binding_table.count);
+      }
+      const iree_hal_buffer_binding_t* table_binding =
+          &binding_table.bindings[binding.buffer_slot];
+      binding.buffer = table_binding->buffer;
+      binding.offset += table_binding->offset;
+      if (binding.length == IREE_WHOLE_BUFFER) {
+        binding.length = table_binding->length;
+      }
+    }
+    bindings[i] = binding;
+  }
   return iree_hal_command_buffer_push_descriptor_set(
-      target_command_buffer, cmd->pipeline_layout, cmd->set, cmd->binding_count,
-      cmd->bindings);
+      target_command_buffer, cmd->pipeline_layout, cmd->set,
+      cmd->binding_count, bindings);
 }
 
 //===----------------------------------------------------------------------===//
@@ -910,6 +1067,55 @@ static const iree_hal_cmd_apply_fn_t iree_hal_cmd_apply_table[] = {
         iree_hal_deferred_command_buffer_apply_execute_commands,
 };
 
+static iree_status_t iree_hal_deferred_command_buffer_apply_cmd_list(
+    const iree_hal_cmd_list_t* cmd_list,
+    iree_hal_command_buffer_t* target_command_buffer,
+    iree_hal_buffer_binding_table_t binding_table) {
+  iree_hal_cmd_header_t* cmd = cmd_list->head;
+  while (cmd) {
+    if (iree_hal_cmd_type_is_region_boundary(cmd->type)) {
+      IREE_RETURN_IF_ERROR(iree_hal_cmd_apply_table[cmd->type](
+          target_command_buffer, binding_table, cmd));
+      cmd = cmd->next;
+      continue;
+    }
+
+    // Find the end of the barrier region starting at |cmd|.
+    iree_hal_cmd_header_t* region_end = cmd;
+    bool any_transfers = false;
+    bool any_non_transfers = false;
+    do {
+      if (iree_hal_cmd_type_is_transfer(region_end->type)) {
+        any_transfers = true;
+      } else {
+        any_non_transfers = true;
+      }
+      region_end = region_end->next;
+    } while (region_end &&
+             !iree_hal_cmd_type_is_region_boundary(region_end->type));
+
+    // Issue all transfers in the region ahead of the dispatches and their
+    // state. Only regions with a mix of both need two passes.
+    const bool split = any_transfers && any_non_transfers;
+    if (split) {
+      for (iree_hal_cmd_header_t* region_cmd = cmd; region_cmd != region_end;
+           region_cmd = region_cmd->next) {
+        if (!iree_hal_cmd_type_is_transfer(region_cmd->type)) continue;
+        IREE_RETURN_IF_ERROR(iree_hal_cmd_apply_table[region_cmd->type](
+            target_command_buffer, binding_table, region_cmd));
+      }
+    }
+    for (iree_hal_cmd_header_t* region_cmd = cmd; region_cmd != region_end;
+         region_cmd = region_cmd->next) {
+      if (split && iree_hal_cmd_type_is_transfer(region_cmd->type)) continue;
+      IREE_RETURN_IF_ERROR(iree_hal_cmd_apply_table[region_cmd->type](
+          target_command_buffer, binding_table, region_cmd));
+    }
+    cmd = region_end;
+  }
+  return iree_ok_status();
+}
+
 IREE_API_EXPORT iree_status_t iree_hal_deferred_command_buffer_apply(
     iree_hal_command_buffer_t* base_command_buffer,
     iree_hal_command_buffer_t* target_command_buffer,
@@ -923,12 +1129,8 @@ IREE_API_EXPORT iree_status_t iree_hal_deferred_command_buffer_apply(
 
   iree_status_t status = iree_hal_command_buffer_begin(target_command_buffer);
   if (iree_status_is_ok(status)) {
-    for (iree_hal_cmd_header_t* cmd = cmd_list->head; cmd != NULL;
-         cmd = cmd->next) {
-      status = iree_hal_cmd_apply_table[cmd->type](target_command_buffer,
-                                                   binding_table, cmd);
-      if (!iree_status_is_ok(status)) break;
-    }
+    status = iree_hal_deferred_command_buffer_apply_cmd_list(
+        cmd_list, target_command_buffer, binding_table);
   }
   if (iree_status_is_ok(status)) {
     status = iree_hal_command_buffer_end(target_command_buffer);
@@ -948,6 +1150,23 @@ IREE_API_EXPORT iree_status_t iree_hal_deferred_command_buffer_apply(
   return status;
 }
 
+IREE_API_EXPORT iree_status_t iree_hal_deferred_command_buffer_apply_commands(
+    iree_hal_command_buffer_t* base_command_buffer,
+    iree_hal_command_buffer_t* target_command_buffer,
+    iree_hal_buffer_binding_table_t binding_table) {
+  IREE_TRACE_ZONE_BEGIN(z0);
+  iree_hal_deferred_command_buffer_t* command_buffer =
+      (iree_hal_deferred_command_buffer_t*)iree_hal_command_buffer_dyn_cast(
+          base_command_buffer, &iree_hal_deferred_command_buffer_vtable);
+  // NOTE: nested command buffers may be executed any number of times within
+  // the same or multiple primary command buffers and are never reset here even
+  // if recorded as one-shot; their storage lives until they are released.
+  iree_status_t status = iree_hal_deferred_command_buffer_apply_cmd_list(
+      &command_buffer->cmd_list, target_command_buffer, binding_table);
+  IREE_TRACE_ZONE_END(z0);
+  return status;
+}
+
 static const iree_hal_command_buffer_vtable_t
     iree_hal_deferred_command_buffer_vtable = {
         .destroy = iree_hal_deferred_command_buffer_destroy,
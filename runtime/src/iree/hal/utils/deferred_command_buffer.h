@@ -62,6 +62,16 @@ IREE_API_EXPORT iree_status_t iree_hal_deferred_command_buffer_apply(
     iree_hal_command_buffer_t* target_command_buffer,
     iree_hal_buffer_binding_table_t binding_table);
 
+// Replays the commands recorded in |command_buffer| into an already-begun
+// |target_command_buffer| without beginning or ending it. This is used to
+// implement iree_hal_command_buffer_execute_commands on targets that have no
+// native support for nested command buffers. Indirect bindings are resolved
+// against |binding_table|.
+IREE_API_EXPORT iree_status_t iree_hal_deferred_command_buffer_apply_commands(
+    iree_hal_command_buffer_t* command_buffer,
+    iree_hal_command_buffer_t* target_command_buffer,
+    iree_hal_buffer_binding_table_t binding_table);
+
 #ifdef __cplusplus
 }  // extern "C"
 #endif  // __cplusplus
@@ -0,0 +1,262 @@
+// Copyright 2023 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include "iree/hal/utils/deferred_command_buffer.h"
+
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "iree/base/api.h"
+#include "iree/base/internal/arena.h"
+#include "iree/hal/api.h"
+#include "iree/testing/gtest.h"
+#include "iree/testing/status_matchers.h"
+
+namespace iree {
+namespace hal {
+namespace {
+
+using ::testing::ElementsAre;
+
+// Resource standing in for buffers and executables; the deferred command
+// buffer only retains them and never inspects their contents.
+typedef struct iree_hal_test_resource_t {
+  iree_hal_resource_t resource;
+} iree_hal_test_resource_t;
+
+static void iree_hal_test_resource_destroy(iree_hal_resource_t* resource) {
+  iree_allocator_free(iree_allocator_system(), resource);
+}
+
+typedef struct iree_hal_test_resource_vtable_t {
+  void(IREE_API_PTR* destroy)(iree_hal_resource_t* resource);
+} iree_hal_test_resource_vtable_t;
+
+static const iree_hal_test_resource_vtable_t iree_hal_test_resource_vtable = {
+    /*.destroy=*/iree_hal_test_resource_destroy,
+};
+
+// Command buffer that logs each command it receives.
+typedef struct iree_hal_recording_command_buffer_t {
+  iree_hal_command_buffer_t base;
+  std::vector<std::string>* log;
+} iree_hal_recording_command_buffer_t;
+
+static std::vector<std::string>* Log(iree_hal_command_buffer_t* base) {
+  return ((iree_hal_recording_command_buffer_t*)base)->log;
+}
+
+static void iree_hal_recording_command_buffer_destroy(
+    iree_hal_command_buffer_t* base) {
+  delete (iree_hal_recording_command_buffer_t*)base;
+}
+
+static iree_status_t iree_hal_recording_command_buffer_begin(
+    iree_hal_command_buffer_t* base) {
+  return iree_ok_status();
+}
+
+static iree_status_t iree_hal_recording_command_buffer_end(
+    iree_hal_command_buffer_t* base) {
+  return iree_ok_status();
+}
+
+static iree_status_t iree_hal_recording_command_buffer_execution_barrier(
+    iree_hal_command_buffer_t* base, iree_hal_execution_stage_t source_mask,
+    iree_hal_execution_stage_t target_mask,
+    iree_hal_execution_barrier_flags_t flags,
+    iree_host_size_t memory_barrier_count,
+    const iree_hal_memory_barrier_t* memory_barriers,
+    iree_host_size_t buffer_barrier_count,
+    const iree_hal_buffer_barrier_t* buffer_barriers) {
+  Log(base)->push_back("barrier " + std::to_string(source_mask) + "->" +
+                       std::to_string(target_mask) + " " +
+                       std::to_string(memory_barrier_count));
+  return iree_ok_status();
+}
+
+static iree_status_t iree_hal_recording_command_buffer_fill_buffer(
+    iree_hal_command_buffer_t* base, iree_hal_buffer_t* target_buffer,
+    iree_device_size_t target_offset, iree_device_size_t length,
+    const void* pattern, iree_host_size_t pattern_length) {
+  uint32_t pattern_value = 0;
+  memcpy(&pattern_value, pattern, pattern_length);
+  Log(base)->push_back("fill " + std::to_string(target_offset) + " " +
+                       std::to_string(length) + " " +
+                       std::to_string(pattern_value));
+  return iree_ok_status();
+}
+
+static iree_status_t iree_hal_recording_command_buffer_copy_buffer(
+    iree_hal_command_buffer_t* base, iree_hal_buffer_t* source_buffer,
+    iree_device_size_t source_offset, iree_hal_buffer_t* target_buffer,
+    iree_device_size_t target_offset, iree_device_size_t length) {
+  Log(base)->push_back("copy " + std::to_string(source_offset) + " " +
+                       std::to_string(target_offset) + " " +
+                       std::to_string(length));
+  return iree_ok_status();
+}
+
+static iree_status_t iree_hal_recording_command_buffer_dispatch(
+    iree_hal_command_buffer_t* base, iree_hal_executable_t* executable,
+    int32_t entry_point, uint32_t workgroup_x, uint32_t workgroup_y,
+    uint32_t workgroup_z) {
+  Log(base)->push_back("dispatch " + std::to_string(entry_point));
+  return iree_ok_status();
+}
+
+static iree_hal_command_buffer_vtable_t
+iree_hal_recording_command_buffer_vtable() {
+  iree_hal_command_buffer_vtable_t vtable = {};
+  vtable.destroy = iree_hal_recording_command_buffer_destroy;
+  vtable.begin = iree_hal_recording_command_buffer_begin;
+  vtable.end = iree_hal_recording_command_buffer_end;
+  vtable.execution_barrier =
+      iree_hal_recording_command_buffer_execution_barrier;
+  vtable.fill_buffer = iree_hal_recording_command_buffer_fill_buffer;
+  vtable.copy_buffer = iree_hal_recording_command_buffer_copy_buffer;
+  vtable.dispatch = iree_hal_recording_command_buffer_dispatch;
+  return vtable;
+}
+
+class DeferredCommandBufferTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    iree_arena_block_pool_initialize(4096, iree_allocator_system(),
+                                     &block_pool_);
+    IREE_ASSERT_OK(iree_hal_deferred_command_buffer_create(
+        /*device=*/NULL, IREE_HAL_COMMAND_BUFFER_MODE_UNVALIDATED,
+        IREE_HAL_COMMAND_CATEGORY_ANY, /*binding_capacity=*/0, &block_pool_,
+        iree_allocator_system(), &command_buffer_));
+    buffer_a_ = (iree_hal_buffer_t*)CreateResource();
+    buffer_b_ = (iree_hal_buffer_t*)CreateResource();
+    executable_ = (iree_hal_executable_t*)CreateResource();
+  }
+
+  void TearDown() override {
+    iree_hal_command_buffer_release(command_buffer_);
+    iree_hal_resource_release(buffer_a_);
+    iree_hal_resource_release(buffer_b_);
+    iree_hal_resource_release(executable_);
+    iree_arena_block_pool_deinitialize(&block_pool_);
+  }
+
+  static iree_hal_resource_t* CreateResource() {
+    iree_hal_test_resource_t* resource = NULL;
+    IREE_CHECK_OK(iree_allocator_malloc(iree_allocator_system(),
+                                        sizeof(*resource), (void**)&resource));
+    iree_hal_resource_initialize(&iree_hal_test_resource_vtable,
+                                 &resource->resource);
+    return &resource->resource;
+  }
+
+  iree_status_t Fill(iree_hal_buffer_t* buffer, iree_device_size_t offset,
+                     iree_device_size_t length, uint32_t pattern) {
+    return iree_hal_command_buffer_fill_buffer(command_buffer_, buffer, offset,
+                                               length, &pattern,
+                                               sizeof(pattern));
+  }
+
+  iree_status_t Barrier(iree_hal_execution_stage_t source_mask,
+                        iree_hal_execution_stage_t target_mask) {
+    return iree_hal_command_buffer_execution_barrier(
+        command_buffer_, source_mask, target_mask,
+        IREE_HAL_EXECUTION_BARRIER_FLAG_NONE, 0, NULL, 0, NULL);
+  }
+
+  // Replays the recorded command buffer and returns the commands received.
+  std::vector<std::string> Replay() {
+    std::vector<std::string> log;
+    vtable_ = iree_hal_recording_command_buffer_vtable();
+    iree_hal_recording_command_buffer_t* target =
+        new iree_hal_recording_command_buffer_t();
+    iree_hal_command_buffer_initialize(
+        /*device=*/NULL, IREE_HAL_COMMAND_BUFFER_MODE_UNVALIDATED,
+        IREE_HAL_COMMAND_CATEGORY_ANY, IREE_HAL_QUEUE_AFFINITY_ANY,
+        /*binding_capacity=*/0, &vtable_, &target->base);
+    target->log = &log;
+    IREE_CHECK_OK(iree_hal_deferred_command_buffer_apply(
+        command_buffer_, &target->base, iree_hal_buffer_binding_table_empty()));
+    iree_hal_command_buffer_release(&target->base);
+    return log;
+  }
+
+  iree_arena_block_pool_t block_pool_;
+  iree_hal_command_buffer_vtable_t vtable_;
+  iree_hal_command_buffer_t* command_buffer_ = NULL;
+  iree_hal_buffer_t* buffer_a_ = NULL;
+  iree_hal_buffer_t* buffer_b_ = NULL;
+  iree_hal_executable_t* executable_ = NULL;
+};
+
+// Contiguous fills with the same pattern are merged; others are kept as-is.
+TEST_F(DeferredCommandBufferTest, MergesContiguousFills) {
+  IREE_ASSERT_OK(Fill(buffer_a_, 0, 16, 0xCD));
+  IREE_ASSERT_OK(Fill(buffer_a_, 16, 16, 0xCD));
+  IREE_ASSERT_OK(Fill(buffer_a_, 32, 16, 0xCD));
+  IREE_ASSERT_OK(Fill(buffer_a_, 48, 16, 0xAB));
+  IREE_ASSERT_OK(Fill(buffer_b_, 64, 16, 0xAB));
+  IREE_ASSERT_OK(Fill(buffer_a_, 128, 16, 0xAB));
+  EXPECT_THAT(Replay(),
+              ElementsAre("fill 0 48 205", "fill 48 16 171", "fill 64 16 171",
+                          "fill 128 16 171"));
+}
+
+// Contiguous copies are merged but never across a barrier.
+TEST_F(DeferredCommandBufferTest, MergesContiguousCopiesInRegion) {
+  IREE_ASSERT_OK(iree_hal_command_buffer_copy_buffer(
+      command_buffer_, buffer_a_, 0, buffer_b_, 100, 8));
+  IREE_ASSERT_OK(iree_hal_command_buffer_copy_buffer(
+      command_buffer_, buffer_a_, 8, buffer_b_, 108, 8));
+  IREE_ASSERT_OK(Barrier(IREE_HAL_EXECUTION_STAGE_TRANSFER,
+                         IREE_HAL_EXECUTION_STAGE_TRANSFER));
+  IREE_ASSERT_OK(iree_hal_command_buffer_copy_buffer(
+      command_buffer_, buffer_a_, 16, buffer_b_, 116, 8));
+  EXPECT_THAT(Replay(), ElementsAre("copy 0 100 16", "barrier 8->8 0",
+                                    "copy 16 116 8"));
+}
+
+// Back-to-back barriers are merged into one with the union of their scopes.
+TEST_F(DeferredCommandBufferTest, MergesBackToBackBarriers) {
+  IREE_ASSERT_OK(Barrier(IREE_HAL_EXECUTION_STAGE_DISPATCH,
+                         IREE_HAL_EXECUTION_STAGE_TRANSFER));
+  IREE_ASSERT_OK(Barrier(IREE_HAL_EXECUTION_STAGE_TRANSFER,
+                         IREE_HAL_EXECUTION_STAGE_DISPATCH));
+  IREE_ASSERT_OK(iree_hal_command_buffer_dispatch(command_buffer_, executable_,
+                                                  0, 1, 1, 1));
+  IREE_ASSERT_OK(Barrier(IREE_HAL_EXECUTION_STAGE_DISPATCH,
+                         IREE_HAL_EXECUTION_STAGE_DISPATCH));
+  const std::string merged_mask =
+      std::to_string(IREE_HAL_EXECUTION_STAGE_DISPATCH |
+                     IREE_HAL_EXECUTION_STAGE_TRANSFER);
+  EXPECT_THAT(Replay(), ElementsAre("barrier " + merged_mask + "->" +
+                                        merged_mask + " 0",
+                                    "dispatch 0", "barrier 4->4 0"));
+}
+
+// Transfers are replayed ahead of dispatches in the same barrier region only.
+TEST_F(DeferredCommandBufferTest, ReordersTransfersInRegion) {
+  IREE_ASSERT_OK(iree_hal_command_buffer_dispatch(command_buffer_, executable_,
+                                                  0, 1, 1, 1));
+  IREE_ASSERT_OK(Fill(buffer_a_, 0, 16, 1));
+  IREE_ASSERT_OK(iree_hal_command_buffer_dispatch(command_buffer_, executable_,
+                                                  1, 1, 1, 1));
+  IREE_ASSERT_OK(Fill(buffer_a_, 16, 16, 1));
+  IREE_ASSERT_OK(Barrier(IREE_HAL_EXECUTION_STAGE_DISPATCH,
+                         IREE_HAL_EXECUTION_STAGE_DISPATCH));
+  IREE_ASSERT_OK(iree_hal_command_buffer_dispatch(command_buffer_, executable_,
+                                                  2, 1, 1, 1));
+  IREE_ASSERT_OK(Fill(buffer_a_, 32, 16, 1));
+  EXPECT_THAT(Replay(),
+              ElementsAre("fill 0 32 1", "dispatch 0", "dispatch 1",
+                          "barrier 4->4 0", "fill 32 16 1", "dispatch 2"));
+}
+
+}  // namespace
+}  // namespace hal
+}  // namespace iree
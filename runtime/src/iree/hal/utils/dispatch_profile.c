@@ -0,0 +1,124 @@
+// Copyright 2023 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include "iree/hal/utils/dispatch_profile.h"
+
+#include <inttypes.h>
+
+#include "iree/base/internal/file_io.h"
+#include "iree/base/tracing.h"
+
+// Initial number of records allocated on first append. Profiling captures of
+// interest usually contain thousands of dispatches so we start large to avoid
+// reallocations during the capture.
+#define IREE_HAL_DISPATCH_PROFILE_INITIAL_CAPACITY 1024
+
+void iree_hal_dispatch_profile_initialize(
+    iree_allocator_t host_allocator, iree_hal_dispatch_profile_t* out_profile) {
+  IREE_ASSERT_ARGUMENT(out_profile);
+  memset(out_profile, 0, sizeof(*out_profile));
+  out_profile->host_allocator = host_allocator;
+  iree_slim_mutex_initialize(&out_profile->mutex);
+}
+
+void iree_hal_dispatch_profile_deinitialize(
+    iree_hal_dispatch_profile_t* profile) {
+  IREE_ASSERT_ARGUMENT(profile);
+  iree_allocator_free(profile->host_allocator, profile->records);
+  iree_slim_mutex_deinitialize(&profile->mutex);
+  memset(profile, 0, sizeof(*profile));
+}
+
+void iree_hal_dispatch_profile_reset(iree_hal_dispatch_profile_t* profile) {
+  IREE_ASSERT_ARGUMENT(profile);
+  iree_slim_mutex_lock(&profile->mutex);
+  profile->record_count = 0;
+  iree_slim_mutex_unlock(&profile->mutex);
+}
+
+iree_status_t iree_hal_dispatch_profile_append(
+    iree_hal_dispatch_profile_t* profile,
+    const iree_hal_dispatch_profile_record_t* record) {
+  IREE_ASSERT_ARGUMENT(profile);
+  IREE_ASSERT_ARGUMENT(record);
+  iree_status_t status = iree_ok_status();
+  iree_slim_mutex_lock(&profile->mutex);
+  if (profile->record_count == profile->record_capacity) {
+    iree_host_size_t new_capacity =
+        iree_max(IREE_HAL_DISPATCH_PROFILE_INITIAL_CAPACITY,
+                 profile->record_capacity * 2);
+    status = iree_allocator_realloc(profile->host_allocator,
+                                    new_capacity * sizeof(profile->records[0]),
+                                    (void**)&profile->records);
+    if (iree_status_is_ok(status)) {
+      profile->record_capacity = new_capacity;
+    }
+  }
+  if (iree_status_is_ok(status)) {
+    profile->records[profile->record_count++] = *record;
+  }
+  iree_slim_mutex_unlock(&profile->mutex);
+  return status;
+}
+
+iree_host_size_t iree_hal_dispatch_profile_count(
+    iree_hal_dispatch_profile_t* profile) {
+  IREE_ASSERT_ARGUMENT(profile);
+  iree_slim_mutex_lock(&profile->mutex);
+  iree_host_size_t record_count = profile->record_count;
+  iree_slim_mutex_unlock(&profile->mutex);
+  return record_count;
+}
+
+iree_host_size_t iree_hal_dispatch_profile_copy_records(
+    iree_hal_dispatch_profile_t* profile, iree_host_size_t capacity,
+    iree_hal_dispatch_profile_record_t* out_records) {
+  IREE_ASSERT_ARGUMENT(profile);
+  iree_slim_mutex_lock(&profile->mutex);
+  iree_host_size_t count = iree_min(capacity, profile->record_count);
+  if (count > 0) {
+    memcpy(out_records, profile->records, count * sizeof(out_records[0]));
+  }
+  iree_slim_mutex_unlock(&profile->mutex);
+  return count;
+}
+
+iree_status_t iree_hal_dispatch_profile_write_file(
+    iree_hal_dispatch_profile_t* profile, const char* path) {
+  IREE_ASSERT_ARGUMENT(profile);
+  IREE_ASSERT_ARGUMENT(path);
+  IREE_TRACE_ZONE_BEGIN(z0);
+
+  iree_string_builder_t builder;
+  iree_string_builder_initialize(profile->host_allocator, &builder);
+  iree_status_t status = iree_string_builder_append_cstring(
+      &builder,
+      "executable,entry_point,workgroup_count_x,workgroup_count_y,"
+      "workgroup_count_z,start_ns,end_ns,duration_ns\n");
+
+  iree_slim_mutex_lock(&profile->mutex);
+  for (iree_host_size_t i = 0;
+       i < profile->record_count && iree_status_is_ok(status); ++i) {
+    const iree_hal_dispatch_profile_record_t* record = &profile->records[i];
+    status = iree_string_builder_append_format(
+        &builder,
+        "0x%016" PRIx64 ",%d,%u,%u,%u,%" PRId64 ",%" PRId64 ",%" PRId64 "\n",
+        record->executable_id, record->entry_point, record->workgroup_count[0],
+        record->workgroup_count[1], record->workgroup_count[2],
+        record->start_ns, record->end_ns, record->end_ns - record->start_ns);
+  }
+  iree_slim_mutex_unlock(&profile->mutex);
+
+  if (iree_status_is_ok(status)) {
+    status = iree_file_write_contents(
+        path, iree_make_const_byte_span(iree_string_builder_buffer(&builder),
+                                        iree_string_builder_size(&builder)));
+  }
+  iree_string_builder_deinitialize(&builder);
+
+  IREE_TRACE_ZONE_END(z0);
+  return status;
+}
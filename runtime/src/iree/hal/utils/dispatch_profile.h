@@ -0,0 +1,89 @@
+// Copyright 2023 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#ifndef IREE_HAL_UTILS_DISPATCH_PROFILE_H_
+#define IREE_HAL_UTILS_DISPATCH_PROFILE_H_
+
+#include "iree/base/api.h"
+#include "iree/base/internal/synchronization.h"
+#include "iree/hal/api.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif  // __cplusplus
+
+//===----------------------------------------------------------------------===//
+// iree_hal_dispatch_profile_t
+//===----------------------------------------------------------------------===//
+
+// Execution record of a single dispatch captured while profiling with
+// IREE_HAL_DEVICE_PROFILING_MODE_DISPATCH_TIMESTAMPS.
+typedef struct iree_hal_dispatch_profile_record_t {
+  // Opaque identifier of the executable the dispatch was issued against.
+  // The executable may have been released by the time the record is consumed
+  // and this must only be used to correlate records with each other.
+  uint64_t executable_id;
+  // Entry point ordinal within the executable.
+  int32_t entry_point;
+  // Workgroup count the dispatch was issued with. Indirect dispatches on
+  // devices that cannot observe the resolved count report 0.
+  uint32_t workgroup_count[3];
+  // Timestamps at which the dispatch started and ended execution in
+  // nanoseconds. Timestamps are in the device timebase and only differences
+  // between records from the same device are meaningful.
+  int64_t start_ns;
+  int64_t end_ns;
+} iree_hal_dispatch_profile_record_t;
+
+// Thread-safe append-only list of dispatch records used by device
+// implementations to back IREE_HAL_DEVICE_PROFILING_MODE_DISPATCH_TIMESTAMPS.
+// Devices append records as dispatches complete (or when profiling ends for
+// devices that resolve timestamps asynchronously) and write them out with
+// iree_hal_dispatch_profile_write_file when profiling ends.
+typedef struct iree_hal_dispatch_profile_t {
+  iree_allocator_t host_allocator;
+  iree_slim_mutex_t mutex;
+  iree_host_size_t record_capacity IREE_GUARDED_BY(mutex);
+  iree_host_size_t record_count IREE_GUARDED_BY(mutex);
+  iree_hal_dispatch_profile_record_t* records IREE_GUARDED_BY(mutex);
+} iree_hal_dispatch_profile_t;
+
+// Initializes an empty |out_profile| that allocates from |host_allocator|.
+void iree_hal_dispatch_profile_initialize(
+    iree_allocator_t host_allocator, iree_hal_dispatch_profile_t* out_profile);
+
+// Deinitializes |profile| and releases all record storage.
+void iree_hal_dispatch_profile_deinitialize(
+    iree_hal_dispatch_profile_t* profile);
+
+// Discards all records in |profile| while retaining storage for reuse.
+void iree_hal_dispatch_profile_reset(iree_hal_dispatch_profile_t* profile);
+
+// Appends |record| to |profile|. Safe to call from any thread.
+iree_status_t iree_hal_dispatch_profile_append(
+    iree_hal_dispatch_profile_t* profile,
+    const iree_hal_dispatch_profile_record_t* record);
+
+// Returns the number of records captured in |profile|.
+iree_host_size_t iree_hal_dispatch_profile_count(
+    iree_hal_dispatch_profile_t* profile);
+
+// Copies up to |capacity| records from |profile| into |out_records| in the
+// order they were appended and returns the number copied.
+iree_host_size_t iree_hal_dispatch_profile_copy_records(
+    iree_hal_dispatch_profile_t* profile, iree_host_size_t capacity,
+    iree_hal_dispatch_profile_record_t* out_records);
+
+// Writes all records in |profile| to the file at |path| as CSV with one row
+// per dispatch. Existing file contents are overwritten.
+iree_status_t iree_hal_dispatch_profile_write_file(
+    iree_hal_dispatch_profile_t* profile, const char* path);
+
+#ifdef __cplusplus
+}  // extern "C"
+#endif  // __cplusplus
+
+#endif  // IREE_HAL_UTILS_DISPATCH_PROFILE_H_
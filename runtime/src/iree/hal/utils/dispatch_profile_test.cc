@@ -0,0 +1,109 @@
+// Copyright 2023 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include "iree/hal/utils/dispatch_profile.h"
+
+#include <cstdint>
+#include <cstdlib>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "iree/base/api.h"
+#include "iree/base/internal/file_io.h"
+#include "iree/testing/gtest.h"
+#include "iree/testing/status_matchers.h"
+
+namespace iree {
+namespace hal {
+namespace {
+
+class DispatchProfileTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    iree_hal_dispatch_profile_initialize(iree_allocator_system(), &profile_);
+  }
+
+  void TearDown() override {
+    iree_hal_dispatch_profile_deinitialize(&profile_);
+  }
+
+  static iree_hal_dispatch_profile_record_t MakeRecord(int32_t entry_point,
+                                                       int64_t start_ns) {
+    iree_hal_dispatch_profile_record_t record = {};
+    record.executable_id = 0xABCD;
+    record.entry_point = entry_point;
+    record.workgroup_count[0] = 4;
+    record.workgroup_count[1] = 2;
+    record.workgroup_count[2] = 1;
+    record.start_ns = start_ns;
+    record.end_ns = start_ns + 100;
+    return record;
+  }
+
+  iree_hal_dispatch_profile_t profile_;
+};
+
+TEST_F(DispatchProfileTest, AppendAndCopy) {
+  EXPECT_EQ(iree_hal_dispatch_profile_count(&profile_), 0);
+  for (int32_t i = 0; i < 2000; ++i) {
+    iree_hal_dispatch_profile_record_t record = MakeRecord(i, i * 1000);
+    IREE_ASSERT_OK(iree_hal_dispatch_profile_append(&profile_, &record));
+  }
+  ASSERT_EQ(iree_hal_dispatch_profile_count(&profile_), 2000);
+
+  std::vector<iree_hal_dispatch_profile_record_t> records(2000);
+  ASSERT_EQ(iree_hal_dispatch_profile_copy_records(&profile_, records.size(),
+                                                   records.data()),
+            2000);
+  for (int32_t i = 0; i < 2000; ++i) {
+    EXPECT_EQ(records[i].entry_point, i);
+    EXPECT_EQ(records[i].start_ns, i * 1000);
+  }
+
+  iree_hal_dispatch_profile_reset(&profile_);
+  EXPECT_EQ(iree_hal_dispatch_profile_count(&profile_), 0);
+}
+
+TEST_F(DispatchProfileTest, ConcurrentAppend) {
+  std::vector<std::thread> threads;
+  for (int t = 0; t < 4; ++t) {
+    threads.emplace_back([this, t]() {
+      for (int32_t i = 0; i < 500; ++i) {
+        iree_hal_dispatch_profile_record_t record = MakeRecord(t, i);
+        IREE_CHECK_OK(iree_hal_dispatch_profile_append(&profile_, &record));
+      }
+    });
+  }
+  for (auto& thread : threads) thread.join();
+  EXPECT_EQ(iree_hal_dispatch_profile_count(&profile_), 2000);
+}
+
+TEST_F(DispatchProfileTest, WriteFile) {
+  const char* tmpdir = getenv("TEST_TMPDIR");
+  if (!tmpdir) tmpdir = getenv("TMPDIR");
+  if (!tmpdir) tmpdir = "/tmp";
+  std::string path = std::string(tmpdir) + "/iree_dispatch_profile_test.csv";
+
+  iree_hal_dispatch_profile_record_t record = MakeRecord(3, 500);
+  IREE_ASSERT_OK(iree_hal_dispatch_profile_append(&profile_, &record));
+  IREE_ASSERT_OK(iree_hal_dispatch_profile_write_file(&profile_, path.c_str()));
+
+  iree_file_contents_t* contents = NULL;
+  IREE_ASSERT_OK(iree_file_read_contents(path.c_str(), iree_allocator_system(),
+                                         &contents));
+  std::string text((const char*)contents->const_buffer.data,
+                   contents->const_buffer.data_length);
+  iree_file_contents_free(contents);
+  EXPECT_EQ(text,
+            "executable,entry_point,workgroup_count_x,workgroup_count_y,"
+            "workgroup_count_z,start_ns,end_ns,duration_ns\n"
+            "0x000000000000abcd,3,4,2,1,500,600,100\n");
+}
+
+}  // namespace
+}  // namespace hal
+}  // namespace iree
@@ -17,7 +17,7 @@ static void iree_hal_resource_set_setup_inline_chunk(
   iree_hal_resource_set_chunk_t* inlined_chunk =
       (iree_hal_resource_set_chunk_t*)block_ptr;
   inlined_chunk->flags = IREE_HAL_RESOURCE_SET_CHUNK_FLAG_INLINE;
-  inlined_chunk->capacity = (set->block_pool->total_block_size - sizeof(*set) -
+  inlined_chunk->capacity = (set->block_pool->usable_block_size - sizeof(*set) -
                              sizeof(*inlined_chunk)) /
                             sizeof(iree_hal_resource_t*);
   inlined_chunk->capacity = iree_min(inlined_chunk->capacity,
@@ -59,6 +59,13 @@ static void iree_hal_resource_set_release_blocks(iree_hal_resource_set_t* set,
   // that isn't worth the complexity.
   iree_arena_block_t* block_head = NULL;
   iree_arena_block_t* block_tail = NULL;
+  if (set->table) {
+    block_head = (iree_arena_block_t*)((uint8_t*)set->table +
+                                       set->block_pool->usable_block_size);
+    block_head->next = NULL;
+    block_tail = block_head;
+    set->table = NULL;
+  }
   iree_hal_resource_set_chunk_t* chunk = set->chunk_head;
   while (chunk) {
     // Release all resources in the chunk.
@@ -122,7 +129,7 @@ static iree_status_t iree_hal_resource_set_insert_retain(
                                          set->block_pool->usable_block_size);
     chunk->next_chunk = set->chunk_head;
     set->chunk_head = chunk;
-    chunk->capacity = (set->block_pool->total_block_size - sizeof(*chunk)) /
+    chunk->capacity = (set->block_pool->usable_block_size - sizeof(*chunk)) /
                       sizeof(iree_hal_resource_t*);
     chunk->capacity =
         iree_min(chunk->capacity, IREE_HAL_RESOURCE_SET_CHUNK_MAX_CAPACITY);
@@ -135,6 +142,103 @@ static iree_status_t iree_hal_resource_set_insert_retain(
   return iree_ok_status();
 }
 
+//===----------------------------------------------------------------------===//
+// Hash table
+//===----------------------------------------------------------------------===//
+
+// Maximum number of entries per generation as a fraction of the capacity.
+// Keeping the table sparse bounds the probe length.
+#define IREE_HAL_RESOURCE_SET_TABLE_MAX_LOAD(capacity) ((capacity) / 4 * 3)
+
+// Returns the home slot of |resource| in a table of |capacity| entries.
+// Pointers have their low bits clear and poor entropy in the high bits so we
+// mix with a multiplicative hash and map into the capacity (which need not be
+// a power of two) with a multiply-shift.
+static inline uint32_t iree_hal_resource_set_table_slot(
+    const iree_hal_resource_t* resource, uint32_t capacity) {
+  const uint64_t hash =
+      (uint64_t)(uintptr_t)resource * UINT64_C(0x9E3779B97F4A7C15);
+  return (uint32_t)(((hash >> 32) * (uint64_t)capacity) >> 32);
+}
+
+// Returns true if |resource| is present in the current generation of |table|.
+static bool iree_hal_resource_set_table_contains(
+    const iree_hal_resource_set_table_t* table,
+    const iree_hal_resource_t* resource) {
+  uint32_t i = iree_hal_resource_set_table_slot(resource, table->capacity);
+  for (;;) {
+    const iree_hal_resource_set_entry_t* entry = &table->entries[i];
+    if (entry->generation != table->generation) return false;
+    if (entry->resource == resource) return true;
+    if (++i == table->capacity) i = 0;
+  }
+}
+
+// Inserts |resource| into |table|; it must not already be present.
+// If the table is at its maximum load the generation is advanced to empty it.
+static void iree_hal_resource_set_table_insert(
+    iree_hal_resource_set_table_t* table, iree_hal_resource_t* resource) {
+  if (IREE_UNLIKELY(table->count >=
+                    IREE_HAL_RESOURCE_SET_TABLE_MAX_LOAD(table->capacity))) {
+    table->count = 0;
+    if (IREE_UNLIKELY(++table->generation == 0)) {
+      // Wrapped: old entries could alias new generations so clear them all.
+      memset(table->entries, 0, table->capacity * sizeof(table->entries[0]));
+      table->generation = 1;
+    }
+  }
+  uint32_t i = iree_hal_resource_set_table_slot(resource, table->capacity);
+  while (table->entries[i].generation == table->generation) {
+    if (++i == table->capacity) i = 0;
+  }
+  table->entries[i].resource = resource;
+  table->entries[i].generation = table->generation;
+  ++table->count;
+}
+
+// Allocates the hash table for |set| from its block pool and populates it with
+// all resources retained so far. Sets with blocks too small to hold a useful
+// table never allocate one.
+static iree_status_t iree_hal_resource_set_allocate_table(
+    iree_hal_resource_set_t* set) {
+  const iree_host_size_t capacity =
+      (set->block_pool->usable_block_size -
+       sizeof(iree_hal_resource_set_table_t)) /
+      sizeof(iree_hal_resource_set_entry_t);
+  if (capacity < 2 * IREE_HAL_RESOURCE_SET_TABLE_MISS_THRESHOLD) {
+    return iree_ok_status();
+  }
+
+  iree_arena_block_t* block = NULL;
+  IREE_RETURN_IF_ERROR(iree_arena_block_pool_acquire(set->block_pool, &block));
+  iree_hal_resource_set_table_t* table =
+      (iree_hal_resource_set_table_t*)((uint8_t*)block -
+                                       set->block_pool->usable_block_size);
+  // Blocks are recycled from the pool with arbitrary contents so the entries
+  // must start out zeroed (generation 0 is never current).
+  memset(table->entries, 0, capacity * sizeof(table->entries[0]));
+  table->generation = 1;
+  table->count = 0;
+  table->capacity = (uint32_t)iree_min(capacity, UINT32_MAX);
+  set->table = table;
+
+  for (iree_hal_resource_set_chunk_t* chunk = set->chunk_head; chunk;
+       chunk = iree_hal_resource_set_chunk_is_stored_inline(chunk)
+                   ? NULL
+                   : chunk->next_chunk) {
+    for (iree_host_size_t i = 0; i < chunk->count; ++i) {
+      if (!iree_hal_resource_set_table_contains(table, chunk->resources[i])) {
+        iree_hal_resource_set_table_insert(table, chunk->resources[i]);
+      }
+    }
+  }
+  return iree_ok_status();
+}
+
+//===----------------------------------------------------------------------===//
+// Insertion
+//===----------------------------------------------------------------------===//
+
 // Scans the lookaside for the resource pointer and updates the order if found.
 // If the resource was not found then it will be inserted into the main list as
 // well as the MRU.
@@ -232,10 +336,23 @@ static iree_status_t iree_hal_resource_set_insert_1(
     return iree_ok_status();
   }
 
-  // Miss - insert into the main list (slow path).
+  // Miss - check the table, if we have one, before falling back to a full
+  // insertion into the main list (slow path).
   // Note that we do this before updating the MRU in case allocation fails - we
   // don't want to keep the pointer around unless we've really retained it.
-  IREE_RETURN_IF_ERROR(iree_hal_resource_set_insert_retain(set, resource));
+  iree_hal_resource_set_table_t* table = set->table;
+  if (table) {
+    if (!iree_hal_resource_set_table_contains(table, resource)) {
+      IREE_RETURN_IF_ERROR(iree_hal_resource_set_insert_retain(set, resource));
+      iree_hal_resource_set_table_insert(table, resource);
+    }
+  } else {
+    IREE_RETURN_IF_ERROR(iree_hal_resource_set_insert_retain(set, resource));
+    if (IREE_UNLIKELY(++set->miss_count ==
+                      IREE_HAL_RESOURCE_SET_TABLE_MISS_THRESHOLD)) {
+      IREE_RETURN_IF_ERROR(iree_hal_resource_set_allocate_table(set));
+    }
+  }
 
   // Shift the MRU down and insert the new item at the head.
   memmove(&set->mru[1], &set->mru[0],
@@ -66,6 +66,34 @@ typedef struct iree_hal_resource_set_chunk_t {
 #define IREE_HAL_RESOURCE_SET_MRU_SIZE \
   (iree_hardware_constructive_interference_size / sizeof(uintptr_t))
 
+// Number of MRU misses after which a set allocates its hash table.
+// Sets with a working set that fits in the MRU never pay for the table.
+#define IREE_HAL_RESOURCE_SET_TABLE_MISS_THRESHOLD \
+  (2 * IREE_HAL_RESOURCE_SET_MRU_SIZE)
+
+// An entry in the resource set hash table.
+typedef struct iree_hal_resource_set_entry_t {
+  iree_hal_resource_t* resource;
+  // Table generation the entry was inserted in. Entries from any other
+  // generation are treated as empty.
+  uint32_t generation;
+} iree_hal_resource_set_entry_t;
+
+// Open-addressing (linear probing) hash table of retained resource pointers.
+// Stored in a single block acquired from the set's block pool. Instead of
+// growing when it fills the table advances its generation, which empties it
+// in O(1); resources retained in a prior generation may then be retained again
+// which is allowed by the set semantics.
+typedef struct iree_hal_resource_set_table_t {
+  // Current generation; never 0 so that zeroed entries are always empty.
+  uint32_t generation;
+  // Number of entries inserted in the current generation.
+  uint32_t count;
+  // Total number of entries in the table.
+  uint32_t capacity;
+  iree_hal_resource_set_entry_t entries[];
+} iree_hal_resource_set_table_t;
+
 // "Efficient" append-only set for retaining a set of resources.
 // This is a non-deterministic data structure that tries to reduce the amount of
 // overhead involved in tracking a reasonably-sized set of resources (~dozens to
@@ -86,6 +114,11 @@ typedef struct iree_hal_resource_set_chunk_t {
 // whatever user code may need to do to maintain proper lifetime - or as small
 // in terms of code-size.
 //
+// Misses in the MRU are checked against a hash table once the set has seen
+// enough unique resources. Long command buffers cycling through hundreds of
+// resources across thousands of commands then stay O(1) per insertion instead
+// of retaining (and storing) the resource again on every MRU miss.
+//
 // **WARNING**: thread-unsafe insertion: it's assumed that sets are constructed
 // by a single thread, sealed, and then released at once at a future time point.
 // Multiple threads needing to insert into a set should have their own sets and
@@ -111,6 +144,13 @@ typedef struct iree_hal_resource_set_t {
 
   // Linked list of storage chunks.
   iree_hal_resource_set_chunk_t* chunk_head;
+
+  // Lazily-allocated hash table used to deduplicate MRU misses or NULL if not
+  // yet allocated (or unavailable with the block pool block size).
+  iree_hal_resource_set_table_t* table;
+
+  // Number of insertions that missed the MRU prior to the table allocation.
+  iree_host_size_t miss_count;
 } iree_hal_resource_set_t;
 
 // TODO(benvanik): add an allocation method that allows for placement; in many
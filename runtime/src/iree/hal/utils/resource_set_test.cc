@@ -252,6 +252,53 @@ TEST_F(ResourceSetTest, RedundantInsertion) {
   EXPECT_EQ(live_bitmap, 0u);
 }
 
+// Tests that resources cycling through the set in a pattern that always misses
+// the MRU are only retained once when the hash table is in use.
+TEST_F(ResourceSetTest, RedundantInsertionTable) {
+  // The default block size is too small for a table so use a realistic one.
+  iree_arena_block_pool_t table_block_pool;
+  iree_arena_block_pool_initialize(4096, host_allocator, &table_block_pool);
+  auto resource_set = make_resource_set(&table_block_pool);
+
+  iree_hal_resource_t* resources[32] = {NULL};
+  static_assert(IREE_ARRAYSIZE(resources) >
+                    IREE_HAL_RESOURCE_SET_TABLE_MISS_THRESHOLD,
+                "need to pick a value that lets us allocate the table");
+  uint32_t live_bitmap = 0u;
+  for (iree_host_size_t i = 0; i < IREE_ARRAYSIZE(resources); ++i) {
+    IREE_ASSERT_OK(iree_hal_test_resource_create(
+        i, &live_bitmap, host_allocator, &resources[i]));
+  }
+  EXPECT_EQ(live_bitmap, 0xFFFFFFFFu);
+
+  // Insert all resources in order many times; each insertion misses the MRU.
+  for (int round = 0; round < 16; ++round) {
+    IREE_ASSERT_OK(iree_hal_resource_set_insert(
+        resource_set.get(), IREE_ARRAYSIZE(resources), resources));
+  }
+  EXPECT_NE(resource_set->table, nullptr);
+
+  // Each resource should have been stored only once.
+  iree_host_size_t stored_count = 0;
+  for (iree_hal_resource_set_chunk_t* chunk = resource_set->chunk_head; chunk;
+       chunk = chunk->next_chunk) {
+    stored_count += chunk->count;
+    if (iree_hal_resource_set_chunk_is_stored_inline(chunk)) break;
+  }
+  EXPECT_EQ(stored_count, IREE_ARRAYSIZE(resources));
+
+  // Release all of the resources - they should still be owned by the set.
+  for (iree_host_size_t i = 0; i < IREE_ARRAYSIZE(resources); ++i) {
+    iree_hal_resource_release(resources[i]);
+  }
+  EXPECT_EQ(live_bitmap, 0xFFFFFFFFu);
+
+  // Ensure the set releases the resources and all blocks.
+  resource_set.reset();
+  EXPECT_EQ(live_bitmap, 0u);
+  iree_arena_block_pool_deinitialize(&table_block_pool);
+}
+
 }  // namespace
 }  // namespace hal
 }  // namespace iree
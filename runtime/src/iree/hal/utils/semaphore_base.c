@@ -8,6 +8,7 @@
 
 #include <stddef.h>
 
+#include "iree/base/internal/wait_handle.h"
 #include "iree/base/tracing.h"
 
 //===----------------------------------------------------------------------===//
@@ -305,3 +306,97 @@ IREE_API_EXPORT void iree_hal_semaphore_poll(iree_hal_semaphore_t* semaphore) {
 
   IREE_TRACE_ZONE_END(z0);
 }
+
+//===----------------------------------------------------------------------===//
+// Exported timepoints
+//===----------------------------------------------------------------------===//
+
+// A timepoint that signals an event the caller holds a clone of.
+// The timepoint owns its copy of the event so that the caller can close theirs
+// at any time and frees itself when issued.
+typedef struct iree_hal_semaphore_exported_timepoint_t {
+  iree_hal_semaphore_timepoint_t base;
+  iree_allocator_t host_allocator;
+  iree_event_t event;
+} iree_hal_semaphore_exported_timepoint_t;
+
+static iree_status_t iree_hal_semaphore_exported_timepoint_callback(
+    void* user_data, iree_hal_semaphore_t* semaphore, uint64_t value,
+    iree_status_code_t status_code) {
+  iree_hal_semaphore_exported_timepoint_t* timepoint =
+      (iree_hal_semaphore_exported_timepoint_t*)user_data;
+  // Failures also signal the event; waiters query the semaphore for the status.
+  iree_event_set(&timepoint->event);
+  iree_event_deinitialize(&timepoint->event);
+  iree_allocator_free(timepoint->host_allocator, timepoint);
+  return iree_ok_status();
+}
+
+IREE_API_EXPORT iree_status_t iree_hal_semaphore_export_timepoint_event(
+    iree_hal_semaphore_t* semaphore, uint64_t value,
+    iree_wait_primitive_type_t target_type, iree_allocator_t host_allocator,
+    iree_wait_primitive_t* out_wait_primitive) {
+  IREE_ASSERT_ARGUMENT(semaphore);
+  IREE_ASSERT_ARGUMENT(out_wait_primitive);
+  *out_wait_primitive = iree_wait_primitive_immediate();
+  IREE_TRACE_ZONE_BEGIN(z0);
+
+  // Fast path for already reached (or failed) semaphores.
+  uint64_t current_value = 0;
+  IREE_RETURN_AND_END_ZONE_IF_ERROR(
+      z0, iree_hal_semaphore_query(semaphore, &current_value));
+  if (current_value >= value) {
+    IREE_TRACE_ZONE_END(z0);
+    return iree_ok_status();
+  }
+
+  iree_hal_semaphore_exported_timepoint_t* timepoint = NULL;
+  IREE_RETURN_AND_END_ZONE_IF_ERROR(
+      z0, iree_allocator_malloc(host_allocator, sizeof(*timepoint),
+                                (void**)&timepoint));
+  timepoint->host_allocator = host_allocator;
+  iree_status_t status =
+      iree_event_initialize(/*initial_state=*/false, &timepoint->event);
+  if (!iree_status_is_ok(status)) {
+    iree_allocator_free(host_allocator, timepoint);
+    IREE_TRACE_ZONE_END(z0);
+    return status;
+  }
+
+  // Events use the best primitive available on the platform and it must match
+  // what was requested.
+  iree_wait_handle_t exported_handle = iree_wait_handle_immediate();
+  if (target_type != IREE_WAIT_PRIMITIVE_TYPE_ANY &&
+      target_type != timepoint->event.type) {
+    status = iree_make_status(IREE_STATUS_UNAVAILABLE,
+                              "requested wait primitive type %d is "
+                              "unavailable; semaphores export type %d",
+                              (int)target_type, (int)timepoint->event.type);
+  } else {
+    status = iree_wait_handle_clone(&timepoint->event, &exported_handle);
+  }
+  if (!iree_status_is_ok(status)) {
+    iree_event_deinitialize(&timepoint->event);
+    iree_allocator_free(host_allocator, timepoint);
+    IREE_TRACE_ZONE_END(z0);
+    return status;
+  }
+
+  // After this the timepoint may be issued and freed at any time.
+  iree_hal_semaphore_acquire_timepoint(
+      semaphore, value, iree_infinite_timeout(),
+      (iree_hal_semaphore_callback_t){
+          .fn = iree_hal_semaphore_exported_timepoint_callback,
+          .user_data = timepoint,
+      },
+      &timepoint->base);
+
+  // The semaphore may have been signaled between the query and the timepoint
+  // being acquired without the timepoint being notified.
+  iree_hal_semaphore_poll(semaphore);
+
+  *out_wait_primitive =
+      iree_make_wait_primitive(exported_handle.type, exported_handle.value);
+  IREE_TRACE_ZONE_END(z0);
+  return iree_ok_status();
+}
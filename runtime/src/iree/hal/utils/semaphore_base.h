@@ -173,6 +173,19 @@ IREE_API_EXPORT void iree_hal_semaphore_notify(
 // Must not be called from a timepoint callback.
 IREE_API_EXPORT void iree_hal_semaphore_poll(iree_hal_semaphore_t* semaphore);
 
+// Exports a timepoint at |value| as a system event signaled from a timepoint
+// callback. Implementations that notify timepoints can use this to implement
+// iree_hal_semaphore_export_timepoint; see that for the semantics. The event
+// and its timepoint are allocated from |host_allocator| and released when the
+// timepoint is reached or fails regardless of whether the caller has closed
+// the exported primitive.
+//
+// Must not be called from a timepoint callback.
+IREE_API_EXPORT iree_status_t iree_hal_semaphore_export_timepoint_event(
+    iree_hal_semaphore_t* semaphore, uint64_t value,
+    iree_wait_primitive_type_t target_type, iree_allocator_t host_allocator,
+    iree_wait_primitive_t* out_wait_primitive);
+
 #ifdef __cplusplus
 }  // extern "C"
 #endif  // __cplusplus
@@ -103,7 +103,7 @@ struct TestSemaphore {
       TestSemaphore* semaphore;
       uint64_t value;
     } notify_state = {semaphore, value};
-    iree_notification_await(
+    bool did_wait = iree_notification_await(
         &semaphore->notification,
         [](void* user_data) -> bool {
           auto* state = reinterpret_cast<notify_state_t*>(user_data);
@@ -115,7 +115,21 @@ struct TestSemaphore {
           return is_signaled;
         },
         (void*)&notify_state, timeout);
-    return iree_ok_status();
+    if (!did_wait) return iree_status_from_code(IREE_STATUS_DEADLINE_EXCEEDED);
+    iree_slim_mutex_lock(&semaphore->mutex);
+    iree_status_t status = iree_status_clone(semaphore->failure_status);
+    iree_slim_mutex_unlock(&semaphore->mutex);
+    return status;
+  }
+
+  static iree_status_t ExportTimepoint(
+      iree_hal_semaphore_t* base_semaphore, uint64_t value,
+      iree_wait_primitive_type_t target_type,
+      iree_wait_primitive_t* out_wait_primitive) {
+    auto* semaphore = Cast(base_semaphore);
+    return iree_hal_semaphore_export_timepoint_event(
+        base_semaphore, value, target_type, semaphore->host_allocator,
+        out_wait_primitive);
   }
 
   constexpr operator iree_hal_semaphore_t*() noexcept { return &base; }
@@ -128,6 +142,7 @@ const iree_hal_semaphore_vtable_t test_semaphore_vtable = {
     /*.signal=*/TestSemaphore::Signal,
     /*.fail=*/TestSemaphore::Fail,
     /*.wait=*/TestSemaphore::Wait,
+    /*.export_timepoint=*/TestSemaphore::ExportTimepoint,
 };
 }  // namespace
 
@@ -374,6 +389,142 @@ TEST_F(TrackingSemaphoreTest, CancelResolvedTimepoint) {
   iree_hal_semaphore_release(*semaphore);
 }
 
+// Tests exporting a timepoint that has already been reached.
+TEST_F(TrackingSemaphoreTest, ExportReachedTimepoint) {
+  auto* semaphore = TestSemaphore::Create(0ull, host_allocator);
+  IREE_ASSERT_OK(iree_hal_semaphore_signal(*semaphore, 2ull));
+
+  iree_wait_primitive_t wait_primitive;
+  IREE_ASSERT_OK(iree_hal_semaphore_export_timepoint(
+      *semaphore, 1ull, IREE_WAIT_PRIMITIVE_TYPE_ANY, &wait_primitive));
+  EXPECT_TRUE(iree_wait_primitive_is_immediate(wait_primitive));
+
+  iree_hal_semaphore_release(*semaphore);
+}
+
+// Tests that an exported timepoint is signaled when the semaphore reaches it.
+TEST_F(TrackingSemaphoreTest, ExportTimepoint) {
+  auto* semaphore = TestSemaphore::Create(0ull, host_allocator);
+
+  iree_wait_primitive_t wait_primitive;
+  iree_status_t status = iree_hal_semaphore_export_timepoint(
+      *semaphore, 1ull, IREE_WAIT_PRIMITIVE_TYPE_ANY, &wait_primitive);
+  if (iree_status_is_unavailable(status)) {
+    // No system wait primitives on this platform.
+    iree_status_ignore(status);
+    iree_hal_semaphore_release(*semaphore);
+    GTEST_SKIP();
+  }
+  IREE_ASSERT_OK(status);
+  ASSERT_FALSE(iree_wait_primitive_is_immediate(wait_primitive));
+  iree_wait_handle_t wait_handle;
+  iree_wait_handle_wrap_primitive(wait_primitive.type, wait_primitive.value,
+                                  &wait_handle);
+
+  // Not yet reached.
+  IREE_EXPECT_STATUS_IS(IREE_STATUS_DEADLINE_EXCEEDED,
+                        iree_wait_one(&wait_handle, IREE_TIME_INFINITE_PAST));
+
+  // Signaling beyond the timepoint signals the exported handle.
+  IREE_ASSERT_OK(iree_hal_semaphore_signal(*semaphore, 2ull));
+  IREE_EXPECT_OK(iree_wait_one(&wait_handle, IREE_TIME_INFINITE_PAST));
+
+  iree_wait_handle_close(&wait_handle);
+  iree_hal_semaphore_release(*semaphore);
+}
+
+// Tests closing an exported timepoint before it is reached.
+TEST_F(TrackingSemaphoreTest, ExportTimepointCloseEarly) {
+  auto* semaphore = TestSemaphore::Create(0ull, host_allocator);
+
+  iree_wait_primitive_t wait_primitive;
+  iree_status_t status = iree_hal_semaphore_export_timepoint(
+      *semaphore, 1ull, IREE_WAIT_PRIMITIVE_TYPE_ANY, &wait_primitive);
+  if (iree_status_is_unavailable(status)) {
+    iree_status_ignore(status);
+    iree_hal_semaphore_release(*semaphore);
+    GTEST_SKIP();
+  }
+  IREE_ASSERT_OK(status);
+  iree_wait_handle_t wait_handle;
+  iree_wait_handle_wrap_primitive(wait_primitive.type, wait_primitive.value,
+                                  &wait_handle);
+  iree_wait_handle_close(&wait_handle);
+
+  // The timepoint still owns its own event and releases it here.
+  IREE_ASSERT_OK(iree_hal_semaphore_signal(*semaphore, 1ull));
+
+  iree_hal_semaphore_release(*semaphore);
+}
+
+// Tests waiting for any of several semaphores with exported timepoints.
+TEST_F(TrackingSemaphoreTest, ListMultiWaitAny) {
+  auto* semaphore0 = TestSemaphore::Create(0ull, host_allocator);
+  auto* semaphore1 = TestSemaphore::Create(0ull, host_allocator);
+  iree_hal_semaphore_t* semaphores[] = {*semaphore0, *semaphore1};
+  uint64_t payload_values[] = {1ull, 1ull};
+  iree_hal_semaphore_list_t semaphore_list = {
+      IREE_ARRAYSIZE(semaphores),
+      semaphores,
+      payload_values,
+  };
+
+  IREE_EXPECT_STATUS_IS(
+      IREE_STATUS_DEADLINE_EXCEEDED,
+      iree_hal_semaphore_list_multi_wait(IREE_HAL_WAIT_MODE_ANY,
+                                         semaphore_list,
+                                         iree_make_timeout_ms(10)));
+
+  std::thread thread(
+      [&]() { IREE_ASSERT_OK(iree_hal_semaphore_signal(*semaphore1, 1ull)); });
+  IREE_EXPECT_OK(iree_hal_semaphore_list_multi_wait(
+      IREE_HAL_WAIT_MODE_ANY, semaphore_list, iree_infinite_timeout()));
+  thread.join();
+
+  // Waiting for both must still time out.
+  IREE_EXPECT_STATUS_IS(
+      IREE_STATUS_DEADLINE_EXCEEDED,
+      iree_hal_semaphore_list_multi_wait(IREE_HAL_WAIT_MODE_ALL,
+                                         semaphore_list,
+                                         iree_make_timeout_ms(10)));
+
+  // Signal the other semaphore to retire its outstanding timepoints.
+  IREE_ASSERT_OK(iree_hal_semaphore_signal(*semaphore0, 1ull));
+  IREE_EXPECT_OK(iree_hal_semaphore_list_multi_wait(
+      IREE_HAL_WAIT_MODE_ALL, semaphore_list, iree_immediate_timeout()));
+
+  iree_hal_semaphore_release(*semaphore0);
+  iree_hal_semaphore_release(*semaphore1);
+}
+
+// Tests that failures are propagated from a multi-wait.
+TEST_F(TrackingSemaphoreTest, ListMultiWaitFailure) {
+  auto* semaphore0 = TestSemaphore::Create(0ull, host_allocator);
+  auto* semaphore1 = TestSemaphore::Create(0ull, host_allocator);
+  iree_hal_semaphore_t* semaphores[] = {*semaphore0, *semaphore1};
+  uint64_t payload_values[] = {1ull, 1ull};
+  iree_hal_semaphore_list_t semaphore_list = {
+      IREE_ARRAYSIZE(semaphores),
+      semaphores,
+      payload_values,
+  };
+
+  IREE_ASSERT_OK(iree_hal_semaphore_signal(*semaphore0, 1ull));
+  std::thread thread([&]() {
+    iree_hal_semaphore_fail(*semaphore1,
+                            iree_status_from_code(IREE_STATUS_DATA_LOSS));
+  });
+  IREE_EXPECT_STATUS_IS(
+      IREE_STATUS_DATA_LOSS,
+      iree_hal_semaphore_list_multi_wait(IREE_HAL_WAIT_MODE_ALL,
+                                         semaphore_list,
+                                         iree_infinite_timeout()));
+  thread.join();
+
+  iree_hal_semaphore_release(*semaphore0);
+  iree_hal_semaphore_release(*semaphore1);
+}
+
 }  // namespace
 }  // namespace hal
 }  // namespace iree
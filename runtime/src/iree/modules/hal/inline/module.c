@@ -89,6 +89,10 @@ static iree_status_t iree_hal_inline_storage_buffer_create(
       z0, iree_allocator_malloc(host_allocator, sizeof(*storage),
                                 (void**)&storage));
 
+  storage->host_allocator = host_allocator;
+  storage->hal_buffer = hal_buffer;
+  iree_hal_buffer_retain(hal_buffer);
+
   // Map the HAL buffer into host-accessible memory. It almost always is but
   // it's possible the buffer we were passed was allocated on a real device that
   // requires mapping.
@@ -105,9 +109,14 @@ static iree_status_t iree_hal_inline_storage_buffer_create(
         .self = storage,
         .ctl = iree_hal_inline_storage_buffer_ctl,
     };
-    iree_vm_buffer_initialize(
-        IREE_VM_BUFFER_ACCESS_ORIGIN_HOST | IREE_VM_BUFFER_ACCESS_MUTABLE,
-        storage->mapping.contents, self_allocator, &storage->vm_buffer);
+    // Read-only buffers (such as wrapped rodata) must stay read-only.
+    iree_vm_buffer_access_t access = IREE_VM_BUFFER_ACCESS_ORIGIN_HOST;
+    if (iree_all_bits_set(iree_hal_buffer_allowed_access(hal_buffer),
+                          IREE_HAL_MEMORY_ACCESS_WRITE)) {
+      access |= IREE_VM_BUFFER_ACCESS_MUTABLE;
+    }
+    iree_vm_buffer_initialize(access, storage->mapping.contents,
+                              self_allocator, &storage->vm_buffer);
   }
 
   if (iree_status_is_ok(status)) {
@@ -312,6 +321,85 @@ IREE_VM_ABI_EXPORT(iree_hal_inline_module_buffer_allocate_initialized,  //
   return iree_make_status(IREE_STATUS_UNIMPLEMENTED);
 }
 
+static void iree_hal_inline_module_release_wrapped_storage(
+    void* user_data, iree_hal_buffer_t* buffer) {
+  iree_vm_buffer_release((iree_vm_buffer_t*)user_data);
+}
+
+// Wraps |source_length| bytes of |source_buffer| at |source_offset| in a HAL
+// buffer that references the VM buffer memory directly. The VM buffer is
+// retained for the lifetime of the HAL buffer. This lets constants (rodata)
+// and user-provided VM buffers flow through the program without copies.
+//
+// If the allocator is unable to import the memory (such as when it isn't
+// sufficiently aligned) read-only contents are copied as there is no way to
+// observe the difference. Mutable contents must alias and fail instead.
+static iree_status_t iree_hal_inline_module_buffer_wrap_storage(
+    iree_hal_allocator_t* device_allocator, iree_vm_buffer_t* source_buffer,
+    iree_device_size_t source_offset, iree_device_size_t source_length,
+    iree_hal_buffer_t** out_buffer) {
+  IREE_TRACE_ZONE_BEGIN(z0);
+  IREE_TRACE_ZONE_APPEND_VALUE(z0, (uint64_t)source_length);
+  *out_buffer = NULL;
+
+  const bool is_mutable =
+      iree_all_bits_set(source_buffer->access, IREE_VM_BUFFER_ACCESS_MUTABLE);
+  iree_byte_span_t source_span = iree_byte_span_empty();
+  iree_const_byte_span_t source_ro_span = iree_const_byte_span_empty();
+  if (is_mutable) {
+    IREE_RETURN_AND_END_ZONE_IF_ERROR(
+        z0, iree_vm_buffer_map_rw(source_buffer,
+                                  iree_hal_cast_host_size(source_offset),
+                                  iree_hal_cast_host_size(source_length), 1,
+                                  &source_span));
+  } else {
+    IREE_RETURN_AND_END_ZONE_IF_ERROR(
+        z0, iree_vm_buffer_map_ro(source_buffer,
+                                  iree_hal_cast_host_size(source_offset),
+                                  iree_hal_cast_host_size(source_length), 1,
+                                  &source_ro_span));
+    source_span = iree_make_byte_span((void*)source_ro_span.data,
+                                      source_ro_span.data_length);
+  }
+
+  const iree_hal_buffer_params_t params = {
+      .usage = IREE_HAL_BUFFER_USAGE_TRANSFER |
+               IREE_HAL_BUFFER_USAGE_DISPATCH_STORAGE |
+               IREE_HAL_BUFFER_USAGE_MAPPING,
+      .access = is_mutable ? IREE_HAL_MEMORY_ACCESS_ALL
+                           : IREE_HAL_MEMORY_ACCESS_READ,
+      .type = IREE_HAL_MEMORY_TYPE_OPTIMAL_FOR_HOST,
+  };
+  iree_hal_external_buffer_t external_buffer = {
+      .type = IREE_HAL_EXTERNAL_BUFFER_TYPE_HOST_ALLOCATION,
+      .flags = IREE_HAL_EXTERNAL_BUFFER_FLAG_NONE,
+      .size = source_span.data_length,
+      .handle.host_allocation.ptr = source_span.data,
+  };
+  const iree_hal_buffer_release_callback_t release_callback = {
+      .fn = iree_hal_inline_module_release_wrapped_storage,
+      .user_data = source_buffer,
+  };
+  iree_vm_buffer_retain(source_buffer);
+  iree_status_t status =
+      iree_hal_allocator_import_buffer(device_allocator, params,
+                                       &external_buffer, release_callback,
+                                       out_buffer);
+  if (!iree_status_is_ok(status)) {
+    iree_vm_buffer_release(source_buffer);
+    if (!is_mutable) {
+      IREE_TRACE_ZONE_APPEND_TEXT(z0, "copy");
+      iree_status_ignore(status);
+      status = iree_hal_allocator_allocate_buffer(
+          device_allocator, params, source_ro_span.data_length,
+          source_ro_span, out_buffer);
+    }
+  }
+
+  IREE_TRACE_ZONE_END(z0);
+  return status;
+}
+
 IREE_VM_ABI_EXPORT(iree_hal_inline_module_buffer_wrap,  //
                    iree_hal_inline_module_state_t,      //
                    rII, r) {
@@ -320,23 +408,12 @@ IREE_VM_ABI_EXPORT(iree_hal_inline_module_buffer_wrap,  //
   iree_device_size_t source_offset = iree_hal_cast_device_size(args->i1);
   iree_device_size_t source_length = iree_hal_cast_device_size(args->i2);
 
-  // TODO(benvanik): implement buffer wrapping.
-  // We don't emit this on the compiler today but could if we wanted to return
-  // constants/variables from the program without copies.
-  //
-  // We could do this by having a custom iree_hal_buffer_t type that retains
-  // the vm buffer, like `iree_hal_external_vm_buffer_t`.
-  // We may then want to expose this wrap method on the public module API so
-  // that users can pass in buffers like this.
-  //
-  // hal_inline.buffer.storage would need to switch based on type and return
-  // the underlying wrapped vm.buffer.
-  (void)source_buffer;
-  (void)source_offset;
-  (void)source_length;
-
-  return iree_make_status(IREE_STATUS_UNIMPLEMENTED,
-                          "vm->hal buffer wrapping not yet implemented");
+  iree_hal_buffer_t* buffer = NULL;
+  IREE_RETURN_IF_ERROR(iree_hal_inline_module_buffer_wrap_storage(
+      state->device_allocator, source_buffer, source_offset, source_length,
+      &buffer));
+  rets->r0 = iree_hal_buffer_move_ref(buffer);
+  return iree_ok_status();
 }
 
 IREE_VM_ABI_EXPORT(iree_hal_inline_module_buffer_subspan,  //
@@ -25,6 +25,7 @@
 // clang-format off
 
 EXPORT_FN("executable.dispatch", iree_hal_loader_module_executable_dispatch, dispatch, riiiiCiDCrIID, v)
+EXPORT_FN("executable.dispatch.packed", iree_hal_loader_module_executable_dispatch_packed, dispatch_packed, riiiiCiDCrDCiIID, v)
 EXPORT_FN("executable.load", iree_hal_loader_module_executable_load, rrr, rrr, r)
 EXPORT_FN("executable.query_support", iree_hal_loader_module_executable_query_support, r, r, i)
 
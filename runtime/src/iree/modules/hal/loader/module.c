@@ -13,7 +13,8 @@
 #include "iree/vm/api.h"
 
 #define IREE_HAL_LOADER_MODULE_VERSION_0_0 0x00000000u
-#define IREE_HAL_LOADER_MODULE_VERSION_LATEST IREE_HAL_LOADER_MODULE_VERSION_0_0
+#define IREE_HAL_LOADER_MODULE_VERSION_0_1 0x00000001u
+#define IREE_HAL_LOADER_MODULE_VERSION_LATEST IREE_HAL_LOADER_MODULE_VERSION_0_1
 
 //===----------------------------------------------------------------------===//
 // Module type definitions
@@ -221,17 +222,95 @@ IREE_HAL_ABI_EXPORT(iree_hal_loader_module_executable_load,  //
   return status;
 }
 
-typedef struct {
-  union {
-    struct {
-      iree_vm_ref_t executable;
-      int32_t entry_point;
-      int32_t workgroup_x;
-      int32_t workgroup_y;
-      int32_t workgroup_z;
-    };
-    iree_vm_abi_riiii_t params;
+// Cursor over the packed argument storage of a variadic call.
+// Each variadic segment is stored inline as an iree_vm_size_t count followed by
+// count densely-packed elements. Reads past the end of the storage fail.
+typedef struct iree_hal_loader_args_cursor_t {
+  const uint8_t* ptr;
+  const uint8_t* end;
+} iree_hal_loader_args_cursor_t;
+
+// Reads a fixed-size |length| value from |cursor|.
+static bool iree_hal_loader_args_read_fixed(
+    iree_hal_loader_args_cursor_t* cursor, iree_host_size_t length,
+    const void** out_ptr) {
+  if ((iree_host_size_t)(cursor->end - cursor->ptr) < length) return false;
+  *out_ptr = cursor->ptr;
+  cursor->ptr += length;
+  return true;
+}
+
+// Reads a variadic segment of |element_size| elements from |cursor|.
+static bool iree_hal_loader_args_read_segment(
+    iree_hal_loader_args_cursor_t* cursor, iree_host_size_t element_size,
+    iree_vm_size_t* out_count, const void** out_elements) {
+  const void* count_ptr = NULL;
+  if (!iree_hal_loader_args_read_fixed(cursor, sizeof(iree_vm_size_t),
+                                       &count_ptr)) {
+    return false;
+  }
+  iree_vm_size_t count = *(const iree_vm_size_t*)count_ptr;
+  if (count < 0) return false;
+  *out_count = count;
+  return iree_hal_loader_args_read_fixed(cursor, count * element_size,
+                                         out_elements);
+}
+
+// Issues a dispatch of the executable entry point in |params| with the binding
+// pointers resolved.
+static iree_status_t iree_hal_loader_module_issue_dispatch(
+    const iree_vm_abi_riiii_t* IREE_RESTRICT params,
+    iree_vm_size_t push_constant_count,
+    const uint32_t* IREE_RESTRICT push_constants, iree_vm_size_t binding_count,
+    void** IREE_RESTRICT binding_ptrs,
+    const size_t* IREE_RESTRICT binding_lengths) {
+  iree_hal_executable_t* executable = NULL;
+  IREE_RETURN_IF_ERROR(
+      iree_hal_executable_check_deref(params->r0, &executable));
+
+  const iree_hal_executable_dispatch_state_v0_t dispatch_state = {
+      .workgroup_size_x = 1,
+      .workgroup_size_y = 1,
+      .workgroup_size_z = 1,
+      .push_constant_count = push_constant_count,
+      .workgroup_count_x = params->i2,
+      .workgroup_count_y = params->i3,
+      .workgroup_count_z = params->i4,
+      .max_concurrency = 1,
+      .binding_count = binding_count,
+      .push_constants = push_constants,
+      .binding_ptrs = binding_ptrs,
+      .binding_lengths = binding_lengths,
   };
+
+  // TODO(benvanik): environmental information.
+  uint32_t processor_id = 0;
+  iree_byte_span_t local_memory = iree_byte_span_empty();
+
+  return iree_hal_local_executable_issue_dispatch_inline(
+      (iree_hal_local_executable_t*)executable, params->i1, &dispatch_state,
+      processor_id, local_memory);
+}
+
+// Maps |length| bytes at |offset| of |buffer| for use as a binding.
+static iree_status_t iree_hal_loader_module_map_binding(
+    iree_vm_buffer_t* buffer, int64_t offset, int64_t length,
+    void** out_binding_ptr, size_t* out_binding_length) {
+  // TODO(benvanik): this is a hack around not having the access permissions
+  // currently modeled. This is only used for verification and early errors
+  // and not intended to be a last-line defense against writes (you need an
+  // MMU for that) so it's just subpar reporting.
+  iree_const_byte_span_t span;
+  IREE_RETURN_IF_ERROR(iree_vm_buffer_map_ro(
+      buffer, iree_hal_cast_host_size(offset), iree_hal_cast_host_size(length),
+      /*alignment=*/1, &span));
+  *out_binding_ptr = (void*)span.data;
+  *out_binding_length = span.data_length;
+  return iree_ok_status();
+}
+
+typedef struct {
+  const iree_vm_abi_riiii_t* params;
   iree_vm_size_t push_constant_count;
   const uint32_t* push_constants;
   iree_vm_size_t binding_count;
@@ -242,10 +321,6 @@ static iree_status_t iree_hal_loader_module_executable_dispatch(
     iree_vm_stack_t* IREE_RESTRICT stack, void* IREE_RESTRICT module,
     iree_hal_loader_module_state_t* IREE_RESTRICT state,
     const iree_hal_loader_dispatch_args_t* IREE_RESTRICT args) {
-  iree_hal_executable_t* executable = NULL;
-  IREE_RETURN_IF_ERROR(
-      iree_hal_executable_check_deref(args->executable, &executable));
-
   if (args->binding_count > 32) {
     return iree_make_status(IREE_STATUS_RESOURCE_EXHAUSTED,
                             "too many bindings");
@@ -258,40 +333,13 @@ static iree_status_t iree_hal_loader_module_executable_dispatch(
     iree_vm_buffer_t* buffer = NULL;
     IREE_RETURN_IF_ERROR(
         iree_vm_buffer_check_deref(args->bindings[i].r0, &buffer));
-    // TODO(benvanik): this is a hack around not having the access permissions
-    // currently modeled. This is only used for verification and early errors
-    // and not intended to be a last-line defense against writes (you need an
-    // MMU for that) so it's just subpar reporting.
-    iree_const_byte_span_t span;
-    IREE_RETURN_IF_ERROR(iree_vm_buffer_map_ro(
-        buffer, iree_hal_cast_host_size(args->bindings[i].i1),
-        iree_hal_cast_host_size(args->bindings[i].i2), /*alignment=*/1, &span));
-    binding_ptrs[i] = (void*)span.data;
-    binding_lengths[i] = span.data_length;
+    IREE_RETURN_IF_ERROR(iree_hal_loader_module_map_binding(
+        buffer, args->bindings[i].i1, args->bindings[i].i2, &binding_ptrs[i],
+        &binding_lengths[i]));
   }
-
-  const iree_hal_executable_dispatch_state_v0_t dispatch_state = {
-      .workgroup_size_x = 1,
-      .workgroup_size_y = 1,
-      .workgroup_size_z = 1,
-      .push_constant_count = args->push_constant_count,
-      .workgroup_count_x = args->workgroup_x,
-      .workgroup_count_y = args->workgroup_y,
-      .workgroup_count_z = args->workgroup_z,
-      .max_concurrency = 1,
-      .binding_count = args->binding_count,
-      .push_constants = args->push_constants,
-      .binding_ptrs = binding_ptrs,
-      .binding_lengths = binding_lengths,
-  };
-
-  // TODO(benvanik): environmental information.
-  uint32_t processor_id = 0;
-  iree_byte_span_t local_memory = iree_byte_span_empty();
-
-  return iree_hal_local_executable_issue_dispatch_inline(
-      (iree_hal_local_executable_t*)executable, args->entry_point,
-      &dispatch_state, processor_id, local_memory);
+  return iree_hal_loader_module_issue_dispatch(
+      args->params, args->push_constant_count, args->push_constants,
+      args->binding_count, binding_ptrs, binding_lengths);
 }
 
 static iree_status_t iree_vm_shim_dispatch_v(
@@ -299,34 +347,20 @@ static iree_status_t iree_vm_shim_dispatch_v(
     iree_byte_span_t args_storage, iree_byte_span_t rets_storage,
     iree_vm_native_function_target2_t target_fn, void* IREE_RESTRICT module,
     void* IREE_RESTRICT module_state) {
-  // TODO(benvanik): support multiple variadic segments in one call.
-  // For now we inline what it would do in a very painful way.
-  bool args_ok = true;
-  if (args_storage.data_length <
-      (sizeof(iree_vm_abi_riiii_t) + sizeof(iree_vm_size_t) +
-       sizeof(iree_vm_size_t))) {
-    // Can't fit even with zero lengths.
-    args_ok = false;
-  }
-  iree_hal_loader_dispatch_args_t args = {
-      .params = *(const iree_vm_abi_riiii_t*)args_storage.data,
+  iree_hal_loader_args_cursor_t cursor = {
+      .ptr = args_storage.data,
+      .end = args_storage.data + args_storage.data_length,
   };
-  if (args_ok) {
-    const uint8_t* push_constants_ptr = args_storage.data + sizeof(args.params);
-    args.push_constant_count = *(const iree_vm_size_t*)push_constants_ptr;
-    args.push_constants =
-        (const uint32_t*)(push_constants_ptr + sizeof(iree_vm_size_t));
-    const uint8_t* bindings_ptr =
-        push_constants_ptr + sizeof(iree_vm_size_t) +
-        args.push_constant_count * sizeof(args.push_constants[0]);
-    args.binding_count = *(const iree_vm_size_t*)bindings_ptr;
-    args.bindings =
-        (const iree_vm_abi_rII_t*)(bindings_ptr + sizeof(iree_vm_size_t));
-    const uint8_t* max_ptr = (const uint8_t*)args.bindings +
-                             args.binding_count * sizeof(args.bindings[0]);
-    const uint8_t* end_ptr = args_storage.data + args_storage.data_length;
-    if (max_ptr > end_ptr) args_ok = false;
-  }
+  iree_hal_loader_dispatch_args_t args;
+  bool args_ok =
+      iree_hal_loader_args_read_fixed(&cursor, sizeof(*args.params),
+                                      (const void**)&args.params) &&
+      iree_hal_loader_args_read_segment(
+          &cursor, sizeof(args.push_constants[0]), &args.push_constant_count,
+          (const void**)&args.push_constants) &&
+      iree_hal_loader_args_read_segment(&cursor, sizeof(args.bindings[0]),
+                                        &args.binding_count,
+                                        (const void**)&args.bindings);
   if (IREE_UNLIKELY(!args_ok || rets_storage.data_length > 0)) {
     return iree_make_status(IREE_STATUS_INVALID_ARGUMENT,
                             "argument/result signature mismatch");
@@ -335,6 +369,88 @@ static iree_status_t iree_vm_shim_dispatch_v(
                                                     &args);
 }
 
+typedef struct {
+  const iree_vm_abi_riiii_t* params;
+  iree_vm_size_t push_constant_count;
+  const uint32_t* push_constants;
+  iree_vm_size_t buffer_count;
+  const iree_vm_abi_r_t* buffers;
+  iree_vm_size_t binding_count;
+  const iree_vm_abi_iII_t* bindings;
+} iree_hal_loader_dispatch_packed_args_t;
+
+// Dispatches with bindings referencing a deduplicated buffer table.
+// Each unique buffer is passed (and retained by the VM) once regardless of how
+// many bindings reference it and bindings are <buffer ordinal, offset, length>
+// tuples in a single contiguous segment.
+static iree_status_t iree_hal_loader_module_executable_dispatch_packed(
+    iree_vm_stack_t* IREE_RESTRICT stack, void* IREE_RESTRICT module,
+    iree_hal_loader_module_state_t* IREE_RESTRICT state,
+    const iree_hal_loader_dispatch_packed_args_t* IREE_RESTRICT args) {
+  if (args->binding_count > 32) {
+    return iree_make_status(IREE_STATUS_RESOURCE_EXHAUSTED,
+                            "too many bindings");
+  } else if (args->buffer_count > args->binding_count) {
+    return iree_make_status(IREE_STATUS_INVALID_ARGUMENT,
+                            "more buffers (%d) than bindings (%d)",
+                            args->buffer_count, args->binding_count);
+  }
+  iree_vm_buffer_t** buffers =
+      (iree_vm_buffer_t**)iree_alloca(args->buffer_count * sizeof(void*));
+  for (iree_vm_size_t i = 0; i < args->buffer_count; ++i) {
+    IREE_RETURN_IF_ERROR(
+        iree_vm_buffer_check_deref(args->buffers[i].r0, &buffers[i]));
+  }
+  void** binding_ptrs =
+      (void**)iree_alloca(args->binding_count * sizeof(void*));
+  size_t* binding_lengths =
+      (size_t*)iree_alloca(args->binding_count * sizeof(size_t));
+  for (iree_vm_size_t i = 0; i < args->binding_count; ++i) {
+    const int32_t ordinal = args->bindings[i].i0;
+    if (IREE_UNLIKELY(ordinal < 0 || ordinal >= args->buffer_count)) {
+      return iree_make_status(IREE_STATUS_OUT_OF_RANGE,
+                              "binding %d references buffer %d of %d",
+                              i, ordinal, args->buffer_count);
+    }
+    IREE_RETURN_IF_ERROR(iree_hal_loader_module_map_binding(
+        buffers[ordinal], args->bindings[i].i1, args->bindings[i].i2,
+        &binding_ptrs[i], &binding_lengths[i]));
+  }
+  return iree_hal_loader_module_issue_dispatch(
+      args->params, args->push_constant_count, args->push_constants,
+      args->binding_count, binding_ptrs, binding_lengths);
+}
+
+static iree_status_t iree_vm_shim_dispatch_packed_v(
+    iree_vm_stack_t* IREE_RESTRICT stack, iree_vm_native_function_flags_t flags,
+    iree_byte_span_t args_storage, iree_byte_span_t rets_storage,
+    iree_vm_native_function_target2_t target_fn, void* IREE_RESTRICT module,
+    void* IREE_RESTRICT module_state) {
+  iree_hal_loader_args_cursor_t cursor = {
+      .ptr = args_storage.data,
+      .end = args_storage.data + args_storage.data_length,
+  };
+  iree_hal_loader_dispatch_packed_args_t args;
+  bool args_ok =
+      iree_hal_loader_args_read_fixed(&cursor, sizeof(*args.params),
+                                      (const void**)&args.params) &&
+      iree_hal_loader_args_read_segment(
+          &cursor, sizeof(args.push_constants[0]), &args.push_constant_count,
+          (const void**)&args.push_constants) &&
+      iree_hal_loader_args_read_segment(&cursor, sizeof(args.buffers[0]),
+                                        &args.buffer_count,
+                                        (const void**)&args.buffers) &&
+      iree_hal_loader_args_read_segment(&cursor, sizeof(args.bindings[0]),
+                                        &args.binding_count,
+                                        (const void**)&args.bindings);
+  if (IREE_UNLIKELY(!args_ok || rets_storage.data_length > 0)) {
+    return iree_make_status(IREE_STATUS_INVALID_ARGUMENT,
+                            "argument/result signature mismatch");
+  }
+  return iree_hal_loader_module_executable_dispatch_packed(
+      stack, module, module_state, &args);
+}
+
 //===----------------------------------------------------------------------===//
 // VM module interface implementation
 //===----------------------------------------------------------------------===//
@@ -40,6 +40,9 @@ typedef struct iree_hal_module_t {
   iree_allocator_t host_allocator;
   iree_hal_module_flags_t flags;
   iree_hal_device_t* shared_device;
+  // Loop host-side work such as executable preparation is scheduled on or
+  // iree_loop_null() to perform the work inline in each context.
+  iree_loop_t loop;
   // TODO(benvanik): types.
 } iree_hal_module_t;
 
@@ -59,9 +62,8 @@ typedef struct iree_hal_module_state_t {
   // instead of storing anything in module state here.
   iree_hal_device_t* shared_device;
 
-  // TODO(benvanik): add iree_loop_t to module constructor.
-  // Status of the nested loop we run for executable creation today. We should
-  // instead be taking a loop upon creation and scheduling work against that.
+  // Status of the nested inline loop used for executable creation when the
+  // hosting application did not provide a loop to the module constructor.
   iree_status_t loop_status;
 
   // Shared executable cache for all executables created in the context.
@@ -92,11 +94,21 @@ iree_hal_module_alloc_state(void* self, iree_allocator_t host_allocator,
   state->shared_device = module->shared_device;
   iree_hal_device_retain(state->shared_device);
 
+  // Executable preparation is scheduled on the loop provided by the hosting
+  // application, if any, so that it may be performed concurrently with other
+  // work. Otherwise it is performed inline as executables are created.
   state->loop_status = iree_ok_status();
-  IREE_RETURN_AND_END_ZONE_IF_ERROR(
-      z0, iree_hal_executable_cache_create(
-              state->shared_device, iree_string_view_empty(),
-              iree_loop_inline(&state->loop_status), &state->executable_cache));
+  iree_loop_t loop = module->loop.ctl ? module->loop
+                                      : iree_loop_inline(&state->loop_status);
+  iree_status_t status = iree_hal_executable_cache_create(
+      state->shared_device, iree_string_view_empty(), loop,
+      &state->executable_cache);
+  if (!iree_status_is_ok(status)) {
+    iree_hal_device_release(state->shared_device);
+    iree_allocator_free(host_allocator, state);
+    IREE_TRACE_ZONE_END(z0);
+    return status;
+  }
 
   *out_module_state = (iree_vm_module_state_t*)state;
   IREE_TRACE_ZONE_END(z0);
@@ -220,6 +232,17 @@ IREE_VM_ABI_EXPORT(iree_hal_module_allocator_allocate_initialized,  //
           &buffer),
       "failed to allocate buffer of length %" PRIdsz, length);
 
+  // The contents have been copied into the new buffer and read-only module
+  // rodata won't be needed again unless re-uploaded.
+  if (iree_all_bits_set(state->flags,
+                        IREE_HAL_MODULE_FLAG_RELEASE_UPLOADED_RODATA) &&
+      iree_all_bits_set(source->access, IREE_VM_BUFFER_ACCESS_ORIGIN_MODULE) &&
+      !iree_any_bit_set(source->access, IREE_VM_BUFFER_ACCESS_MUTABLE)) {
+    iree_vm_buffer_advise(source, (iree_host_size_t)offset,
+                          (iree_host_size_t)length,
+                          IREE_VM_BUFFER_ADVICE_DONT_NEED);
+  }
+
   rets->r0 = iree_hal_buffer_move_ref(buffer);
   return iree_ok_status();
 }
@@ -433,24 +456,13 @@ IREE_VM_ABI_EXPORT(iree_hal_module_buffer_view_create,  //
   IREE_VM_ABI_VLA_STACK_CAST(args, a5_count, a5, iree_hal_dim_t, 128,
                              &shape_rank, &shape_dims);
 
-  iree_hal_buffer_t* subspan_buffer = NULL;
-  if (source_offset != 0 ||
-      source_length != iree_hal_buffer_byte_length(source_buffer)) {
-    IREE_RETURN_IF_ERROR(
-        iree_hal_buffer_subspan(source_buffer, source_offset, source_length,
-                                &subspan_buffer),
-        "invalid subspan of an existing buffer (source_offset=%" PRIdsz
-        ", length=%" PRIdsz ")",
-        source_offset, source_length);
-  }
-
+  // The subspan (if any) is stored inline with the view to avoid an additional
+  // allocation per view in programs with many transient views.
   iree_hal_buffer_view_t* buffer_view = NULL;
-  IREE_RETURN_IF_ERROR(iree_hal_buffer_view_create(
-      subspan_buffer ? subspan_buffer : source_buffer, shape_rank, shape_dims,
+  IREE_RETURN_IF_ERROR(iree_hal_buffer_view_create_subspan(
+      source_buffer, source_offset, source_length, shape_rank, shape_dims,
       element_type, encoding_type, state->host_allocator, &buffer_view));
 
-  iree_hal_buffer_release(subspan_buffer);
-
   rets->r0 = iree_hal_buffer_view_move_ref(buffer_view);
   return iree_ok_status();
 }
@@ -1432,6 +1444,15 @@ IREE_API_EXPORT iree_status_t iree_hal_module_create(
     iree_vm_instance_t* instance, iree_hal_device_t* device,
     iree_hal_module_flags_t flags, iree_allocator_t host_allocator,
     iree_vm_module_t** out_module) {
+  return iree_hal_module_create_with_loop(instance, device, flags,
+                                          iree_loop_null(), host_allocator,
+                                          out_module);
+}
+
+IREE_API_EXPORT iree_status_t iree_hal_module_create_with_loop(
+    iree_vm_instance_t* instance, iree_hal_device_t* device,
+    iree_hal_module_flags_t flags, iree_loop_t loop,
+    iree_allocator_t host_allocator, iree_vm_module_t** out_module) {
   IREE_ASSERT_ARGUMENT(instance);
   IREE_ASSERT_ARGUMENT(device);
   IREE_ASSERT_ARGUMENT(out_module);
@@ -1467,6 +1488,7 @@ IREE_API_EXPORT iree_status_t iree_hal_module_create(
   module->flags = flags | IREE_HAL_MODULE_FLAG_SYNCHRONOUS;
   module->shared_device = device;
   iree_hal_device_retain(module->shared_device);
+  module->loop = loop;
 
   *out_module = base_module;
   return iree_ok_status();
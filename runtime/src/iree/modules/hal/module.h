@@ -23,6 +23,12 @@ enum iree_hal_module_flag_bits_t {
 
   // Forces HAL methods to block instead of yielding as a coroutine.
   IREE_HAL_MODULE_FLAG_SYNCHRONOUS = 1u << 0,
+
+  // Advises that pages of read-only module rodata are no longer needed once
+  // they have been copied into newly allocated buffers. This lets the system
+  // reclaim the host memory of large memory-mapped constants after upload at
+  // the cost of paging them back in if they are used again.
+  IREE_HAL_MODULE_FLAG_RELEASE_UPLOADED_RODATA = 1u << 1,
 };
 typedef uint32_t iree_hal_module_flags_t;
 
@@ -34,6 +40,18 @@ IREE_API_EXPORT iree_status_t iree_hal_module_create(
     iree_hal_module_flags_t flags, iree_allocator_t host_allocator,
     iree_vm_module_t** out_module);
 
+// Creates the HAL module initialized to use a specific |device| and schedule
+// host-side work such as executable preparation on |loop|.
+// This allows drivers to prepare executables (JIT compilation, pipeline
+// creation, relocation, etc) using the scheduler of the hosting application
+// instead of inline during context initialization. The loop must remain valid
+// for the lifetime of the module and all contexts using it. Passing
+// iree_loop_null() is equivalent to iree_hal_module_create.
+IREE_API_EXPORT iree_status_t iree_hal_module_create_with_loop(
+    iree_vm_instance_t* instance, iree_hal_device_t* device,
+    iree_hal_module_flags_t flags, iree_loop_t loop,
+    iree_allocator_t host_allocator, iree_vm_module_t** out_module);
+
 // Returns the device currently in use by the HAL module.
 // Returns NULL if no device has been initialized yet.
 IREE_API_EXPORT iree_hal_device_t* iree_hal_module_state_device(
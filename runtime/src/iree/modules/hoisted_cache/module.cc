@@ -0,0 +1,252 @@
+// Copyright 2023 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include "iree/modules/hoisted_cache/module.h"
+
+#include <cinttypes>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "iree/base/api.h"
+#include "iree/base/internal/file_io.h"
+#include "iree/hal/api.h"
+#include "iree/modules/hal/types.h"
+#include "iree/vm/api.h"
+#include "iree/vm/native_module_cc.h"
+
+//===----------------------------------------------------------------------===//
+// VM module interface implementation
+//===----------------------------------------------------------------------===//
+
+namespace iree {
+namespace {
+
+// Identifies cache entry files and the version of their format ('IHC1').
+static constexpr uint32_t kEntryMagic = 0x31434849u;
+
+// Header at the start of each cache entry file. It is followed by |rank|
+// uint64_t dimensions and then |byte_length| bytes of buffer contents.
+struct EntryHeader {
+  uint32_t magic;
+  uint32_t element_type;
+  uint32_t encoding_type;
+  uint32_t rank;
+  uint64_t byte_length;
+};
+static_assert(sizeof(EntryHeader) == 24, "header is stored as-is");
+
+// Per-context module state.
+//
+// Thread-compatible; the runtime will not issue multiple calls at the same
+// time using the same state.
+class HoistedCacheModuleState final {
+ public:
+  HoistedCacheModuleState(std::string cache_dir,
+                          iree_allocator_t host_allocator)
+      : cache_dir_(std::move(cache_dir)), host_allocator_(host_allocator) {}
+  ~HoistedCacheModuleState() = default;
+
+  // Returns 1 if a value for |key| has been cached for |device|.
+  StatusOr<int32_t> Contains(const vm::ref<iree_hal_device_t> device,
+                             int64_t key) {
+    if (cache_dir_.empty()) return 0;
+    std::string path = MakeEntryPath(device.get(), key);
+    iree_status_t status = iree_file_exists(path.c_str());
+    if (!iree_status_is_ok(status)) {
+      // Missing or inaccessible entries are misses and get recomputed.
+      iree_status_ignore(status);
+      return 0;
+    }
+    return 1;
+  }
+
+  // Loads the value cached for |key| into a new buffer allocated from
+  // |device|.
+  StatusOr<vm::ref<iree_hal_buffer_view_t>> Load(
+      const vm::ref<iree_hal_device_t> device, int64_t key) {
+    if (cache_dir_.empty()) {
+      return iree_make_status(IREE_STATUS_FAILED_PRECONDITION,
+                              "no cache directory configured");
+    }
+    std::string path = MakeEntryPath(device.get(), key);
+    iree_file_contents_t* contents = NULL;
+    IREE_RETURN_IF_ERROR(
+        iree_file_map_contents(path.c_str(), host_allocator_, &contents));
+    vm::ref<iree_hal_buffer_view_t> buffer_view;
+    iree_status_t status =
+        ParseEntry(device.get(), contents->const_buffer, &buffer_view);
+    iree_file_contents_free(contents);
+    IREE_RETURN_IF_ERROR(status, "loading hoisted cache entry '%s'",
+                         path.c_str());
+    return std::move(buffer_view);
+  }
+
+  // Stores the contents of |buffer_view| as the value of |key| for |device|.
+  Status Store(const vm::ref<iree_hal_device_t> device, int64_t key,
+               const vm::ref<iree_hal_buffer_view_t> buffer_view) {
+    if (cache_dir_.empty()) return OkStatus();
+    iree_hal_buffer_t* buffer = iree_hal_buffer_view_buffer(buffer_view.get());
+    iree_host_size_t rank = iree_hal_buffer_view_shape_rank(buffer_view.get());
+    EntryHeader header;
+    header.magic = kEntryMagic;
+    header.element_type = iree_hal_buffer_view_element_type(buffer_view.get());
+    header.encoding_type =
+        iree_hal_buffer_view_encoding_type(buffer_view.get());
+    header.rank = (uint32_t)rank;
+    header.byte_length = iree_hal_buffer_byte_length(buffer);
+
+    // Stage the entry in host memory so it can be written with one call.
+    size_t data_offset = sizeof(header) + rank * sizeof(uint64_t);
+    std::vector<uint8_t> entry(data_offset + header.byte_length);
+    memcpy(entry.data(), &header, sizeof(header));
+    uint64_t* dims = reinterpret_cast<uint64_t*>(entry.data() + sizeof(header));
+    for (iree_host_size_t i = 0; i < rank; ++i) {
+      dims[i] = iree_hal_buffer_view_shape_dim(buffer_view.get(), i);
+    }
+    IREE_RETURN_IF_ERROR(iree_hal_device_transfer_d2h(
+        device.get(), buffer, 0, entry.data() + data_offset,
+        header.byte_length, IREE_HAL_TRANSFER_BUFFER_FLAG_DEFAULT,
+        iree_infinite_timeout()));
+
+    // Write to a temporary file and then rename it into place so that other
+    // processes never observe partially written entries.
+    std::string path = MakeEntryPath(device.get(), key);
+    std::string temp_path = path + ".tmp";
+    IREE_RETURN_IF_ERROR(iree_file_write_contents(
+        temp_path.c_str(),
+        iree_make_const_byte_span(entry.data(), entry.size())));
+    if (std::rename(temp_path.c_str(), path.c_str()) != 0) {
+      std::remove(temp_path.c_str());
+      return iree_make_status(IREE_STATUS_UNAVAILABLE,
+                              "failed to commit hoisted cache entry '%s'",
+                              path.c_str());
+    }
+    return OkStatus();
+  }
+
+ private:
+  // Returns the path of the entry for |key| on |device|. Characters of the
+  // device identifier that may not be valid in file names are replaced.
+  std::string MakeEntryPath(iree_hal_device_t* device, int64_t key) {
+    iree_string_view_t device_id = iree_hal_device_id(device);
+    std::string path = cache_dir_;
+    path.push_back('/');
+    for (iree_host_size_t i = 0; i < device_id.size; ++i) {
+      char c = device_id.data[i];
+      bool is_safe = (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') ||
+                     (c >= '0' && c <= '9') || c == '-' || c == '_' ||
+                     c == '.';
+      path.push_back(is_safe ? c : '_');
+    }
+    char key_str[24];
+    snprintf(key_str, sizeof(key_str), "-%016" PRIx64 ".bin", (uint64_t)key);
+    path.append(key_str);
+    return path;
+  }
+
+  // Parses a cache entry from |contents| and uploads it to |device|.
+  iree_status_t ParseEntry(iree_hal_device_t* device,
+                           iree_const_byte_span_t contents,
+                           iree_hal_buffer_view_t** out_buffer_view) {
+    EntryHeader header;
+    if (contents.data_length < sizeof(header)) {
+      return iree_make_status(IREE_STATUS_DATA_LOSS, "truncated header");
+    }
+    memcpy(&header, contents.data, sizeof(header));
+    if (header.magic != kEntryMagic) {
+      return iree_make_status(IREE_STATUS_DATA_LOSS,
+                              "unrecognized entry format");
+    }
+    uint64_t data_offset =
+        sizeof(header) + (uint64_t)header.rank * sizeof(uint64_t);
+    if (contents.data_length < data_offset ||
+        contents.data_length - data_offset != header.byte_length) {
+      return iree_make_status(IREE_STATUS_DATA_LOSS, "truncated contents");
+    }
+    std::vector<iree_hal_dim_t> shape(header.rank);
+    for (uint32_t i = 0; i < header.rank; ++i) {
+      uint64_t dim = 0;
+      memcpy(&dim, contents.data + sizeof(header) + i * sizeof(uint64_t),
+             sizeof(dim));
+      shape[i] = (iree_hal_dim_t)dim;
+    }
+
+    iree_hal_buffer_params_t params = {0};
+    params.type = IREE_HAL_MEMORY_TYPE_DEVICE_LOCAL;
+    params.usage = IREE_HAL_BUFFER_USAGE_DEFAULT;
+    iree_hal_buffer_t* buffer = NULL;
+    IREE_RETURN_IF_ERROR(iree_hal_allocator_allocate_buffer(
+        iree_hal_device_allocator(device), params, header.byte_length,
+        iree_make_const_byte_span(contents.data + data_offset,
+                                  header.byte_length),
+        &buffer));
+    iree_status_t status = iree_hal_buffer_view_create(
+        buffer, shape.size(), shape.data(), header.element_type,
+        header.encoding_type, host_allocator_, out_buffer_view);
+    iree_hal_buffer_release(buffer);
+    return status;
+  }
+
+  std::string cache_dir_;
+  iree_allocator_t host_allocator_;
+};
+
+// Function table mapping imported function names to their implementation.
+// The signatures match the imports declared by the compiler's
+// iree-flow-cache-hoisted-globals pass.
+static const vm::NativeFunction<HoistedCacheModuleState>
+    kHoistedCacheModuleFunctions[] = {
+        vm::MakeNativeFunction("contains", &HoistedCacheModuleState::Contains),
+        vm::MakeNativeFunction("load", &HoistedCacheModuleState::Load),
+        vm::MakeNativeFunction("store", &HoistedCacheModuleState::Store),
+};
+
+// The module instance that will be allocated and reused across contexts.
+// The cache directory is immutable after creation.
+class HoistedCacheModule final
+    : public vm::NativeModule<HoistedCacheModuleState> {
+ public:
+  HoistedCacheModule(std::string cache_dir, iree_vm_instance_t* instance,
+                     iree_allocator_t host_allocator)
+      : vm::NativeModule<HoistedCacheModuleState>(
+            "hoisted_cache", /*version=*/0, instance, host_allocator,
+            iree::span<const vm::NativeFunction<HoistedCacheModuleState>>(
+                kHoistedCacheModuleFunctions)),
+        cache_dir_(std::move(cache_dir)) {}
+
+  // Creates per-context state when the module is added to a new context.
+  // May be called from any thread.
+  StatusOr<std::unique_ptr<HoistedCacheModuleState>> CreateState(
+      iree_allocator_t host_allocator) override {
+    return std::make_unique<HoistedCacheModuleState>(cache_dir_,
+                                                     host_allocator);
+  }
+
+ private:
+  const std::string cache_dir_;
+};
+
+}  // namespace
+
+// Note that while we are using C++ bindings internally we still expose the
+// module as a C instance. This hides the details of our implementation.
+extern "C" iree_status_t iree_hoisted_cache_module_create(
+    iree_vm_instance_t* instance, iree_string_view_t cache_dir,
+    iree_allocator_t host_allocator, iree_vm_module_t** out_module) {
+  IREE_ASSERT_ARGUMENT(out_module);
+  *out_module = NULL;
+  auto module = std::make_unique<HoistedCacheModule>(
+      std::string(cache_dir.data, cache_dir.size), instance, host_allocator);
+  *out_module = module.release()->interface();
+  return iree_ok_status();
+}
+
+}  // namespace iree
@@ -0,0 +1,40 @@
+// Copyright 2023 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#ifndef IREE_MODULES_HOISTED_CACHE_MODULE_H_
+#define IREE_MODULES_HOISTED_CACHE_MODULE_H_
+
+#include <stdint.h>
+
+#include "iree/base/api.h"
+#include "iree/vm/api.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif  // __cplusplus
+
+// Creates the `hoisted_cache` module used by programs compiled with
+// `--iree-opt-cache-hoisted-globals` to persist the results of global
+// initializers across program loads.
+//
+// Cached values are stored as one file per value in |cache_dir| named by the
+// device identifier and the key the compiler derived from the initializer. The
+// first load of a program evaluates its initializers and stores the results;
+// subsequent loads on the same kind of device read them back instead. If
+// |cache_dir| is empty nothing is cached and every load evaluates the
+// initializers.
+//
+// Entries are written by renaming completed files into place so concurrent
+// processes sharing a cache directory never observe partial entries.
+iree_status_t iree_hoisted_cache_module_create(
+    iree_vm_instance_t* instance, iree_string_view_t cache_dir,
+    iree_allocator_t host_allocator, iree_vm_module_t** out_module);
+
+#ifdef __cplusplus
+}  // extern "C"
+#endif  // __cplusplus
+
+#endif  // IREE_MODULES_HOISTED_CACHE_MODULE_H_
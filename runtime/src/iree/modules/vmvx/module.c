@@ -7,6 +7,7 @@
 #define _GNU_SOURCE
 #include "iree/modules/vmvx/module.h"
 
+#include <inttypes.h>
 #include <stdbool.h>
 #include <stddef.h>
 #include <stdint.h>
@@ -269,7 +270,9 @@ static iree_status_t iree_vm_shim_ukernel_x32b_2d_v(
       // OUT
       out, out_offset, out_stride0, out_stride1,
       // SIZE
-      out_size0, out_size1);
+      out_size0, out_size1,
+      // CPU DATA
+      (const iree_uk_uint64_t*)iree_cpu_data_fields());
 
   IREE_TRACE_ZONE_END(z0);
   return ret == 0
@@ -329,7 +332,9 @@ static iree_status_t iree_vm_shim_ukernel_x32u_2d_v(
       // OUT
       out, out_offset, out_stride0, out_stride1,
       // SIZE
-      out_size0, out_size1);
+      out_size0, out_size1,
+      // CPU DATA
+      (const iree_uk_uint64_t*)iree_cpu_data_fields());
 
   IREE_TRACE_ZONE_END(z0);
   return ret == 0
@@ -338,6 +343,68 @@ static iree_status_t iree_vm_shim_ukernel_x32u_2d_v(
                                 "illegal x32u ukernel return code (%d)", ret);
 }
 
+IREE_VMVX_ABI_FIXED_STRUCT(ukernel_x32r_2d, rIIIrIIII, {
+  iree_vm_ref_t in_ref;
+  int64_t in_offset;
+  int64_t in_stride0;
+  int64_t in_stride1;
+  iree_vm_ref_t out_ref;
+  int64_t out_offset;
+  int64_t out_stride0;
+  int64_t size0;
+  int64_t size1;
+});
+
+static iree_status_t iree_vm_shim_ukernel_x32r_2d_v(
+    iree_vm_stack_t* IREE_RESTRICT stack, iree_vm_native_function_flags_t flags,
+    iree_byte_span_t args_storage, iree_byte_span_t rets_storage,
+    iree_vm_native_function_target2_t target_fn, void* IREE_RESTRICT module,
+    void* IREE_RESTRICT module_state) {
+  // TODO: Figure out how to identify this with the actual target fn.
+  IREE_TRACE_ZONE_BEGIN(z0);
+  const iree_vm_abi_ukernel_x32r_2d_t* args =
+      iree_vm_abi_ukernel_x32r_2d_checked_deref(args_storage);
+  if (IREE_UNLIKELY(!((flags & IREE_VM_NATIVE_FUNCTION_CALL_RESUME) || args))) {
+    IREE_TRACE_ZONE_END(z0);
+    return iree_make_status(IREE_STATUS_INVALID_ARGUMENT,
+                            "argument/result signature mismatch");
+  }
+
+  MAP_BUFFER_2D_RO(in, uint32_t,
+                   /*buffer_ref=*/args->in_ref,
+                   /*offset=*/args->in_offset,
+                   /*stride0=*/args->in_stride0,
+                   /*stride1=*/args->in_stride1,
+                   /*size0=*/args->size0,
+                   /*size1=*/args->size1);
+  // The output holds one element per row of the input.
+  MAP_BUFFER_2D_RW(out, uint32_t,
+                   /*buffer_ref=*/args->out_ref,
+                   /*offset=*/args->out_offset,
+                   /*stride0=*/args->out_stride0,
+                   /*stride1=*/0,
+                   /*size0=*/args->size0,
+                   /*size1=*/1);
+
+  iree_uk_x32r_2d_func_t ukernel_func = (iree_uk_x32r_2d_func_t)target_fn;
+
+  int ret = ukernel_func(
+      // IN
+      in, in_offset, in_stride0, in_stride1,
+      // OUT
+      out, out_offset, out_stride0,
+      // SIZE
+      in_size0, in_size1,
+      // CPU DATA
+      (const iree_uk_uint64_t*)iree_cpu_data_fields());
+
+  IREE_TRACE_ZONE_END(z0);
+  return ret == 0
+             ? iree_ok_status()
+             : iree_make_status(IREE_STATUS_INVALID_ARGUMENT,
+                                "illegal x32r ukernel return code (%d)", ret);
+}
+
 //===----------------------------------------------------------------------===//
 // Exported copy function definitions
 //===----------------------------------------------------------------------===//
@@ -943,9 +1010,75 @@ IREE_VMVX_ABI_FIXED_STRUCT(query_tile_sizes_2d, III, {
 });
 IREE_VMVX_ABI_DEFINE_SHIM(query_tile_sizes_2d, II);
 
+// Values of the compiler's TensorEncoding enum passed as |encoding|. Each
+// group of four is (LHS, RHS, RHS_TRANSPOSE, RESULT) for one matmul type.
+enum {
+  IREE_VMVX_ENCODING_MATMUL_F32F32F32_LHS = 0,
+  IREE_VMVX_ENCODING_MATMUL_I8I8I32_LHS = 4,
+  IREE_VMVX_ENCODING_MATMUL_I8I8I32_RESULT = 7,
+};
+
+typedef enum iree_vmvx_matmul_operand_role_e {
+  IREE_VMVX_MATMUL_OPERAND_ROLE_LHS = 0,
+  IREE_VMVX_MATMUL_OPERAND_ROLE_RHS = 1,
+  IREE_VMVX_MATMUL_OPERAND_ROLE_RHS_TRANSPOSE = 2,
+  IREE_VMVX_MATMUL_OPERAND_ROLE_RESULT = 3,
+} iree_vmvx_matmul_operand_role_t;
+
+// Shrinks |tile_size| for small static |size|s the same way the compiler does
+// for statically materialized encodings. Negative sizes are dynamic.
+static int64_t iree_vmvx_narrow_tile_size(int64_t tile_size, int64_t size) {
+  if (size < 0) return tile_size;
+  for (int64_t n = 1; n <= 4; n *= 2) {
+    if (size <= n && tile_size >= n) return n;
+  }
+  return tile_size;
+}
+
 IREE_VMVX_ABI_EXPORT(iree_vmvx_query_tile_sizes_2d, query_tile_sizes_2d, II) {
-  rets->i0 = 1;
-  rets->i1 = 1;
+  if (args->encoding < IREE_VMVX_ENCODING_MATMUL_F32F32F32_LHS ||
+      args->encoding > IREE_VMVX_ENCODING_MATMUL_I8I8I32_RESULT) {
+    return iree_make_status(IREE_STATUS_UNIMPLEMENTED,
+                            "unsupported tensor encoding %" PRId64,
+                            args->encoding);
+  }
+  iree_uk_mmt4d_params_t ukernel_params = {
+      .type = args->encoding >= IREE_VMVX_ENCODING_MATMUL_I8I8I32_LHS
+                  ? iree_uk_mmt4d_type_i8i8i32
+                  : iree_uk_mmt4d_type_f32f32f32,
+      .cpu_data = (const iree_uk_uint64_t*)iree_cpu_data_fields(),
+  };
+  iree_uk_status_t status = iree_uk_mmt4d_query_tile_sizes(&ukernel_params);
+  if (status != iree_uk_status_ok) {
+    return iree_make_status(IREE_STATUS_INTERNAL, "%s",
+                            iree_uk_status_message(status));
+  }
+  int64_t M0 = ukernel_params.M0;
+  int64_t N0 = ukernel_params.N0;
+  int64_t K0 = ukernel_params.K0;
+  // The tile sizes are returned in the order of the packed inner dimensions.
+  // For RHS_TRANSPOSE those are (N, K) tiling dimensions (1, 0) of the KxN
+  // tensor.
+  int64_t size0 = args->size0;
+  int64_t size1 = args->size1;
+  switch ((iree_vmvx_matmul_operand_role_t)(args->encoding % 4)) {
+    case IREE_VMVX_MATMUL_OPERAND_ROLE_LHS:
+      rets->i0 = iree_vmvx_narrow_tile_size(M0, size0);
+      rets->i1 = iree_vmvx_narrow_tile_size(K0, size1);
+      break;
+    case IREE_VMVX_MATMUL_OPERAND_ROLE_RHS:
+      rets->i0 = iree_vmvx_narrow_tile_size(K0, size0);
+      rets->i1 = iree_vmvx_narrow_tile_size(N0, size1);
+      break;
+    case IREE_VMVX_MATMUL_OPERAND_ROLE_RHS_TRANSPOSE:
+      rets->i0 = iree_vmvx_narrow_tile_size(N0, size1);
+      rets->i1 = iree_vmvx_narrow_tile_size(K0, size0);
+      break;
+    case IREE_VMVX_MATMUL_OPERAND_ROLE_RESULT:
+      rets->i0 = iree_vmvx_narrow_tile_size(M0, size0);
+      rets->i1 = iree_vmvx_narrow_tile_size(N0, size1);
+      break;
+  }
   return iree_ok_status();
 }
 
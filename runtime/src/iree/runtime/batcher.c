@@ -0,0 +1,500 @@
+// Copyright 2023 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include "iree/runtime/batcher.h"
+
+#include <stddef.h>
+#include <string.h>
+
+#include "iree/base/internal/atomics.h"
+#include "iree/base/internal/synchronization.h"
+#include "iree/base/tracing.h"
+#include "iree/modules/hal/types.h"
+#include "iree/runtime/session.h"
+
+//===----------------------------------------------------------------------===//
+// iree_runtime_batcher_options_t
+//===----------------------------------------------------------------------===//
+
+IREE_API_EXPORT void iree_runtime_batcher_options_initialize(
+    iree_runtime_batcher_options_t* out_options) {
+  memset(out_options, 0, sizeof(*out_options));
+  out_options->flags = IREE_RUNTIME_BATCHER_FLAG_NONE;
+  out_options->max_batch_size = 8;
+  out_options->max_delay = 1000000;  // 1ms
+}
+
+//===----------------------------------------------------------------------===//
+// iree_runtime_batcher_t
+//===----------------------------------------------------------------------===//
+
+// A single call waiting on a batch. Stored on the stack of the caller.
+typedef struct iree_runtime_batch_request_t {
+  struct iree_runtime_batch_request_t* next;
+  iree_vm_list_t* inputs;
+  iree_vm_list_t* outputs;
+  // Outermost dimension shared by all inputs.
+  iree_host_size_t batch_size;
+  // Result of the call; only valid once |done| is set.
+  iree_status_t status;
+  iree_atomic_int32_t done;
+} iree_runtime_batch_request_t;
+
+// A set of requests issued together. Stored on the stack of the first request
+// (the leader) which issues the batch on behalf of all of them. Once closed no
+// requests are added and only the leader accesses the batch.
+typedef struct iree_runtime_batch_t {
+  iree_runtime_batch_request_t* head;
+  iree_runtime_batch_request_t* tail;
+  // Total rows of all requests.
+  iree_host_size_t batch_size;
+  iree_atomic_int32_t closed;
+} iree_runtime_batch_t;
+
+struct iree_runtime_batcher_t {
+  iree_atomic_ref_count_t ref_count;
+  iree_allocator_t host_allocator;
+  iree_runtime_session_t* session;
+  iree_vm_function_t function;
+  iree_runtime_batcher_options_t options;
+  iree_host_size_t input_count;
+  iree_host_size_t output_count;
+
+  iree_slim_mutex_t mutex;
+  // The batch accepting new requests, if any.
+  iree_runtime_batch_t* open_batch IREE_GUARDED_BY(mutex);
+
+  // Posted whenever a batch is closed or completes.
+  iree_notification_t notification;
+
+  // Serializes invocations on the (thread-compatible) session. While a batch
+  // is executing the next batch remains open and accumulates requests.
+  iree_slim_mutex_t invoke_mutex;
+};
+
+// Returns true if all characters of a calling convention fragment are refs.
+static bool iree_runtime_batcher_cconv_is_all_refs(
+    iree_string_view_t fragment) {
+  for (iree_host_size_t i = 0; i < fragment.size; ++i) {
+    if (fragment.data[i] != 'r') return false;
+  }
+  return true;
+}
+
+IREE_API_EXPORT iree_status_t iree_runtime_batcher_create(
+    iree_runtime_session_t* session, iree_vm_function_t function,
+    const iree_runtime_batcher_options_t* options,
+    iree_allocator_t host_allocator, iree_runtime_batcher_t** out_batcher) {
+  IREE_ASSERT_ARGUMENT(session);
+  IREE_ASSERT_ARGUMENT(options);
+  IREE_ASSERT_ARGUMENT(out_batcher);
+  *out_batcher = NULL;
+
+  if (options->max_batch_size == 0) {
+    return iree_make_status(IREE_STATUS_INVALID_ARGUMENT,
+                            "max_batch_size must be at least 1");
+  }
+
+  // Batching is only defined for functions taking and returning tensors.
+  iree_vm_function_signature_t signature =
+      iree_vm_function_signature(&function);
+  iree_string_view_t arguments;
+  iree_string_view_t results;
+  IREE_RETURN_IF_ERROR(iree_vm_function_call_get_cconv_fragments(
+      &signature, &arguments, &results));
+  if (iree_string_view_is_empty(arguments) ||
+      !iree_runtime_batcher_cconv_is_all_refs(arguments) ||
+      !iree_runtime_batcher_cconv_is_all_refs(results)) {
+    iree_string_view_t name = iree_vm_function_name(&function);
+    return iree_make_status(
+        IREE_STATUS_INVALID_ARGUMENT,
+        "function '%.*s' cannot be batched; it must take at least one argument "
+        "and only take and return tensors",
+        (int)name.size, name.data);
+  }
+
+  IREE_TRACE_ZONE_BEGIN(z0);
+  iree_runtime_batcher_t* batcher = NULL;
+  IREE_RETURN_AND_END_ZONE_IF_ERROR(
+      z0, iree_allocator_malloc(host_allocator, sizeof(*batcher),
+                                (void**)&batcher));
+  memset(batcher, 0, sizeof(*batcher));
+  iree_atomic_ref_count_init(&batcher->ref_count);
+  batcher->host_allocator = host_allocator;
+  batcher->session = session;
+  iree_runtime_session_retain(session);
+  batcher->function = function;
+  batcher->options = *options;
+  batcher->input_count = arguments.size;
+  batcher->output_count = results.size;
+  iree_slim_mutex_initialize(&batcher->mutex);
+  iree_notification_initialize(&batcher->notification);
+  iree_slim_mutex_initialize(&batcher->invoke_mutex);
+
+  *out_batcher = batcher;
+  IREE_TRACE_ZONE_END(z0);
+  return iree_ok_status();
+}
+
+static void iree_runtime_batcher_destroy(iree_runtime_batcher_t* batcher) {
+  IREE_TRACE_ZONE_BEGIN(z0);
+  iree_slim_mutex_deinitialize(&batcher->invoke_mutex);
+  iree_notification_deinitialize(&batcher->notification);
+  iree_slim_mutex_deinitialize(&batcher->mutex);
+  iree_runtime_session_release(batcher->session);
+  iree_allocator_free(batcher->host_allocator, batcher);
+  IREE_TRACE_ZONE_END(z0);
+}
+
+IREE_API_EXPORT void iree_runtime_batcher_retain(
+    iree_runtime_batcher_t* batcher) {
+  if (batcher) {
+    iree_atomic_ref_count_inc(&batcher->ref_count);
+  }
+}
+
+IREE_API_EXPORT void iree_runtime_batcher_release(
+    iree_runtime_batcher_t* batcher) {
+  if (batcher && iree_atomic_ref_count_dec(&batcher->ref_count) == 1) {
+    iree_runtime_batcher_destroy(batcher);
+  }
+}
+
+static iree_hal_buffer_view_t* iree_runtime_batcher_list_get_buffer_view(
+    iree_vm_list_t* list, iree_host_size_t i) {
+  return (iree_hal_buffer_view_t*)iree_vm_list_get_ref_deref(
+      list, i, iree_hal_buffer_view_get_descriptor());
+}
+
+// Verifies the |inputs| of a call and returns their shared batch dimension.
+static iree_status_t iree_runtime_batcher_query_batch_size(
+    iree_runtime_batcher_t* batcher, iree_vm_list_t* inputs,
+    iree_host_size_t* out_batch_size) {
+  *out_batch_size = 0;
+  iree_host_size_t input_count = iree_vm_list_size(inputs);
+  if (input_count != batcher->input_count) {
+    return iree_make_status(IREE_STATUS_INVALID_ARGUMENT,
+                            "expected %" PRIhsz " inputs but got %" PRIhsz,
+                            batcher->input_count, input_count);
+  }
+  iree_host_size_t batch_size = 0;
+  for (iree_host_size_t i = 0; i < input_count; ++i) {
+    iree_hal_buffer_view_t* buffer_view =
+        iree_runtime_batcher_list_get_buffer_view(inputs, i);
+    if (!buffer_view || iree_hal_buffer_view_shape_rank(buffer_view) == 0) {
+      return iree_make_status(IREE_STATUS_INVALID_ARGUMENT,
+                              "input %" PRIhsz
+                              " must be a buffer view with a batch dimension",
+                              i);
+    }
+    iree_host_size_t dim = iree_hal_buffer_view_shape_dim(buffer_view, 0);
+    if (i > 0 && dim != batch_size) {
+      return iree_make_status(IREE_STATUS_INVALID_ARGUMENT,
+                              "input %" PRIhsz " has a batch size of %" PRIhsz
+                              " but prior inputs have %" PRIhsz,
+                              i, dim, batch_size);
+    }
+    batch_size = dim;
+  }
+  if (batch_size == 0 || batch_size > batcher->options.max_batch_size) {
+    return iree_make_status(IREE_STATUS_OUT_OF_RANGE,
+                            "batch size %" PRIhsz
+                            " must be between 1 and the maximum of %" PRIhsz,
+                            batch_size, batcher->options.max_batch_size);
+  }
+  *out_batch_size = batch_size;
+  return iree_ok_status();
+}
+
+// Returns true if the inputs of |lhs| and |rhs| can be concatenated: all but
+// their batch dimension must match.
+static bool iree_runtime_batcher_requests_are_compatible(
+    iree_runtime_batcher_t* batcher, const iree_runtime_batch_request_t* lhs,
+    const iree_runtime_batch_request_t* rhs) {
+  for (iree_host_size_t i = 0; i < batcher->input_count; ++i) {
+    iree_hal_buffer_view_t* lhs_view =
+        iree_runtime_batcher_list_get_buffer_view(lhs->inputs, i);
+    iree_hal_buffer_view_t* rhs_view =
+        iree_runtime_batcher_list_get_buffer_view(rhs->inputs, i);
+    iree_host_size_t rank = iree_hal_buffer_view_shape_rank(lhs_view);
+    if (iree_hal_buffer_view_element_type(lhs_view) !=
+            iree_hal_buffer_view_element_type(rhs_view) ||
+        iree_hal_buffer_view_encoding_type(lhs_view) !=
+            iree_hal_buffer_view_encoding_type(rhs_view) ||
+        iree_hal_buffer_view_shape_rank(rhs_view) != rank) {
+      return false;
+    }
+    const iree_hal_dim_t* lhs_dims = iree_hal_buffer_view_shape_dims(lhs_view);
+    const iree_hal_dim_t* rhs_dims = iree_hal_buffer_view_shape_dims(rhs_view);
+    for (iree_host_size_t j = 1; j < rank; ++j) {
+      if (lhs_dims[j] != rhs_dims[j]) return false;
+    }
+  }
+  return true;
+}
+
+// Concatenates input |input_index| of all requests in |batch| along the batch
+// dimension (padded to |batch_size| rows) and appends it to |list|.
+static iree_status_t iree_runtime_batcher_concatenate_input(
+    iree_runtime_batcher_t* batcher, const iree_runtime_batch_t* batch,
+    iree_host_size_t input_index, iree_host_size_t batch_size,
+    iree_vm_list_t* list) {
+  iree_hal_device_t* device = iree_runtime_session_device(batcher->session);
+  iree_hal_buffer_view_t* like_view = iree_runtime_batcher_list_get_buffer_view(
+      batch->head->inputs, input_index);
+  iree_device_size_t row_length =
+      iree_hal_buffer_view_byte_length(like_view) / batch->head->batch_size;
+
+  iree_hal_buffer_params_t params = {
+      .type = IREE_HAL_MEMORY_TYPE_DEVICE_LOCAL,
+      .usage = IREE_HAL_BUFFER_USAGE_DEFAULT,
+  };
+  iree_hal_buffer_t* buffer = NULL;
+  IREE_RETURN_IF_ERROR(iree_hal_allocator_allocate_buffer(
+      iree_runtime_session_device_allocator(batcher->session), params,
+      row_length * batch_size, iree_const_byte_span_empty(), &buffer));
+
+  iree_status_t status = iree_ok_status();
+  iree_device_size_t offset = 0;
+  for (iree_runtime_batch_request_t* request = batch->head;
+       request && iree_status_is_ok(status); request = request->next) {
+    iree_hal_buffer_view_t* buffer_view =
+        iree_runtime_batcher_list_get_buffer_view(request->inputs, input_index);
+    iree_device_size_t length = iree_hal_buffer_view_byte_length(buffer_view);
+    status = iree_hal_device_transfer_d2d(
+        device, iree_hal_buffer_view_buffer(buffer_view), 0, buffer, offset,
+        length, IREE_HAL_TRANSFER_BUFFER_FLAG_DEFAULT, iree_infinite_timeout());
+    offset += length;
+  }
+
+  iree_hal_buffer_view_t* batched_view = NULL;
+  if (iree_status_is_ok(status)) {
+    iree_host_size_t rank = iree_hal_buffer_view_shape_rank(like_view);
+    iree_hal_dim_t* shape =
+        (iree_hal_dim_t*)iree_alloca(rank * sizeof(iree_hal_dim_t));
+    memcpy(shape, iree_hal_buffer_view_shape_dims(like_view),
+           rank * sizeof(iree_hal_dim_t));
+    shape[0] = (iree_hal_dim_t)batch_size;
+    status = iree_hal_buffer_view_create(
+        buffer, rank, shape, iree_hal_buffer_view_element_type(like_view),
+        iree_hal_buffer_view_encoding_type(like_view), batcher->host_allocator,
+        &batched_view);
+  }
+  if (iree_status_is_ok(status)) {
+    iree_vm_ref_t batched_view_ref =
+        iree_hal_buffer_view_move_ref(batched_view);
+    status = iree_vm_list_push_ref_move(list, &batched_view_ref);
+  }
+  iree_hal_buffer_release(buffer);
+  return status;
+}
+
+// Splits result |output_index| in |list| along the batch dimension and appends
+// a view of each request's rows to its outputs.
+static iree_status_t iree_runtime_batcher_scatter_output(
+    iree_runtime_batcher_t* batcher, const iree_runtime_batch_t* batch,
+    iree_host_size_t output_index, iree_host_size_t batch_size,
+    iree_vm_list_t* list) {
+  iree_hal_buffer_view_t* batched_view =
+      iree_runtime_batcher_list_get_buffer_view(list, output_index);
+  if (!batched_view || iree_hal_buffer_view_shape_rank(batched_view) == 0 ||
+      iree_hal_buffer_view_shape_dim(batched_view, 0) != batch_size) {
+    return iree_make_status(IREE_STATUS_FAILED_PRECONDITION,
+                            "result %" PRIhsz
+                            " is not a buffer view with a batch dimension of "
+                            "%" PRIhsz,
+                            output_index, batch_size);
+  }
+  iree_device_size_t row_length =
+      iree_hal_buffer_view_byte_length(batched_view) / batch_size;
+  iree_host_size_t rank = iree_hal_buffer_view_shape_rank(batched_view);
+  iree_hal_dim_t* shape =
+      (iree_hal_dim_t*)iree_alloca(rank * sizeof(iree_hal_dim_t));
+  memcpy(shape, iree_hal_buffer_view_shape_dims(batched_view),
+         rank * sizeof(iree_hal_dim_t));
+
+  iree_device_size_t offset = 0;
+  for (iree_runtime_batch_request_t* request = batch->head; request;
+       request = request->next) {
+    shape[0] = (iree_hal_dim_t)request->batch_size;
+    iree_device_size_t length = request->batch_size * row_length;
+    iree_hal_buffer_view_t* buffer_view = NULL;
+    IREE_RETURN_IF_ERROR(iree_hal_buffer_view_create_subspan(
+        iree_hal_buffer_view_buffer(batched_view), offset, length, rank, shape,
+        iree_hal_buffer_view_element_type(batched_view),
+        iree_hal_buffer_view_encoding_type(batched_view),
+        batcher->host_allocator, &buffer_view));
+    iree_vm_ref_t buffer_view_ref = iree_hal_buffer_view_move_ref(buffer_view);
+    IREE_RETURN_IF_ERROR(
+        iree_vm_list_push_ref_move(request->outputs, &buffer_view_ref));
+    offset += length;
+  }
+  return iree_ok_status();
+}
+
+// Issues a closed |batch| and populates the outputs of all of its requests.
+static iree_status_t iree_runtime_batcher_issue(iree_runtime_batcher_t* batcher,
+                                                iree_runtime_batch_t* batch) {
+  IREE_TRACE_ZONE_BEGIN(z0);
+  IREE_TRACE_ZONE_APPEND_VALUE(z0, (int64_t)batch->batch_size);
+
+  iree_host_size_t batch_size = batch->batch_size;
+  if (iree_all_bits_set(batcher->options.flags,
+                        IREE_RUNTIME_BATCHER_FLAG_PAD_TO_MAX_BATCH_SIZE)) {
+    batch_size = batcher->options.max_batch_size;
+  }
+
+  // A lone request that needs no padding is passed through as-is.
+  if (batch->head == batch->tail && batch_size == batch->batch_size) {
+    iree_status_t status =
+        iree_runtime_session_call(batcher->session, &batcher->function,
+                                  batch->head->inputs, batch->head->outputs);
+    IREE_TRACE_ZONE_END(z0);
+    return status;
+  }
+
+  iree_vm_list_t* inputs = NULL;
+  iree_vm_list_t* outputs = NULL;
+  iree_status_t status =
+      iree_vm_list_create(/*element_type=*/NULL, batcher->input_count,
+                          batcher->host_allocator, &inputs);
+  if (iree_status_is_ok(status)) {
+    status = iree_vm_list_create(/*element_type=*/NULL, batcher->output_count,
+                                 batcher->host_allocator, &outputs);
+  }
+  for (iree_host_size_t i = 0;
+       i < batcher->input_count && iree_status_is_ok(status); ++i) {
+    status = iree_runtime_batcher_concatenate_input(batcher, batch, i,
+                                                    batch_size, inputs);
+  }
+
+  if (iree_status_is_ok(status)) {
+    status = iree_runtime_session_call(batcher->session, &batcher->function,
+                                       inputs, outputs);
+  }
+
+  for (iree_runtime_batch_request_t* request = batch->head;
+       request && iree_status_is_ok(status); request = request->next) {
+    status = iree_vm_list_resize(request->outputs, 0);
+  }
+  for (iree_host_size_t i = 0;
+       i < batcher->output_count && iree_status_is_ok(status); ++i) {
+    status = iree_runtime_batcher_scatter_output(batcher, batch, i, batch_size,
+                                                 outputs);
+  }
+
+  iree_vm_list_release(outputs);
+  iree_vm_list_release(inputs);
+  IREE_TRACE_ZONE_END(z0);
+  return status;
+}
+
+// Closes |batch| so that no more requests are added.
+// Must be called with the batcher mutex held.
+static void iree_runtime_batcher_close_batch(iree_runtime_batcher_t* batcher,
+                                             iree_runtime_batch_t* batch) {
+  if (batcher->open_batch == batch) batcher->open_batch = NULL;
+  iree_atomic_store_int32(&batch->closed, 1, iree_memory_order_release);
+}
+
+static bool iree_runtime_batcher_is_batch_closed(void* arg) {
+  iree_runtime_batch_t* batch = (iree_runtime_batch_t*)arg;
+  return iree_atomic_load_int32(&batch->closed, iree_memory_order_acquire) == 1;
+}
+
+static bool iree_runtime_batcher_is_request_done(void* arg) {
+  iree_runtime_batch_request_t* request = (iree_runtime_batch_request_t*)arg;
+  return iree_atomic_load_int32(&request->done, iree_memory_order_acquire) ==
+         1;
+}
+
+IREE_API_EXPORT iree_status_t iree_runtime_batcher_call(
+    iree_runtime_batcher_t* batcher, iree_vm_list_t* inputs,
+    iree_vm_list_t* outputs) {
+  IREE_ASSERT_ARGUMENT(batcher);
+  IREE_ASSERT_ARGUMENT(inputs);
+  IREE_ASSERT_ARGUMENT(outputs);
+
+  iree_runtime_batch_request_t request;
+  memset(&request, 0, sizeof(request));
+  request.inputs = inputs;
+  request.outputs = outputs;
+  IREE_RETURN_IF_ERROR(iree_runtime_batcher_query_batch_size(
+      batcher, inputs, &request.batch_size));
+
+  IREE_TRACE_ZONE_BEGIN(z0);
+  const iree_host_size_t max_batch_size = batcher->options.max_batch_size;
+
+  // Join the open batch if the request fits or start a new one.
+  iree_runtime_batch_t batch;
+  memset(&batch, 0, sizeof(batch));
+  bool is_leader = false;
+  iree_slim_mutex_lock(&batcher->mutex);
+  iree_runtime_batch_t* open_batch = batcher->open_batch;
+  if (open_batch &&
+      (open_batch->batch_size + request.batch_size > max_batch_size ||
+       !iree_runtime_batcher_requests_are_compatible(batcher, open_batch->head,
+                                                     &request))) {
+    iree_runtime_batcher_close_batch(batcher, open_batch);
+    open_batch = NULL;
+  }
+  if (open_batch) {
+    open_batch->tail->next = &request;
+    open_batch->tail = &request;
+    open_batch->batch_size += request.batch_size;
+    if (open_batch->batch_size == max_batch_size) {
+      iree_runtime_batcher_close_batch(batcher, open_batch);
+    }
+  } else {
+    is_leader = true;
+    batch.head = batch.tail = &request;
+    batch.batch_size = request.batch_size;
+    if (batch.batch_size < max_batch_size) {
+      batcher->open_batch = &batch;
+    } else {
+      iree_runtime_batcher_close_batch(batcher, &batch);
+    }
+  }
+  iree_slim_mutex_unlock(&batcher->mutex);
+  iree_notification_post(&batcher->notification, IREE_ALL_WAITERS);
+
+  // Followers wait for the leader to issue the batch.
+  if (!is_leader) {
+    iree_notification_await(&batcher->notification,
+                            iree_runtime_batcher_is_request_done, &request,
+                            iree_infinite_timeout());
+    IREE_TRACE_ZONE_END(z0);
+    return request.status;
+  }
+
+  // Wait for the batch to fill or the delay to elapse and then for any prior
+  // batch to complete: the batch keeps accepting requests until then.
+  iree_notification_await(&batcher->notification,
+                          iree_runtime_batcher_is_batch_closed, &batch,
+                          iree_make_timeout_ns(batcher->options.max_delay));
+  iree_slim_mutex_lock(&batcher->invoke_mutex);
+  iree_slim_mutex_lock(&batcher->mutex);
+  iree_runtime_batcher_close_batch(batcher, &batch);
+  iree_slim_mutex_unlock(&batcher->mutex);
+
+  iree_status_t status = iree_runtime_batcher_issue(batcher, &batch);
+  iree_slim_mutex_unlock(&batcher->invoke_mutex);
+
+  // Complete all followers. They may return as soon as they observe |done| and
+  // their requests must not be accessed afterward.
+  iree_runtime_batch_request_t* follower = request.next;
+  while (follower) {
+    iree_runtime_batch_request_t* next = follower->next;
+    follower->status = iree_status_is_ok(status) ? iree_ok_status()
+                                                 : iree_status_clone(status);
+    iree_atomic_store_int32(&follower->done, 1, iree_memory_order_release);
+    follower = next;
+  }
+  iree_notification_post(&batcher->notification, IREE_ALL_WAITERS);
+
+  IREE_TRACE_ZONE_END(z0);
+  return status;
+}
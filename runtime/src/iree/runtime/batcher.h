@@ -0,0 +1,108 @@
+// Copyright 2023 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#ifndef IREE_RUNTIME_BATCHER_H_
+#define IREE_RUNTIME_BATCHER_H_
+
+#include <stdint.h>
+
+#include "iree/base/api.h"
+#include "iree/hal/api.h"
+#include "iree/vm/api.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif  // __cplusplus
+
+typedef struct iree_runtime_session_t iree_runtime_session_t;
+
+//===----------------------------------------------------------------------===//
+// iree_runtime_batcher_options_t
+//===----------------------------------------------------------------------===//
+
+enum iree_runtime_batcher_flag_bits_t {
+  IREE_RUNTIME_BATCHER_FLAG_NONE = 0u,
+  // Pads every batch to |max_batch_size| rows for functions compiled with a
+  // static batch dimension. The contents of the padding rows are undefined and
+  // their results are discarded.
+  IREE_RUNTIME_BATCHER_FLAG_PAD_TO_MAX_BATCH_SIZE = 1u << 0,
+};
+typedef uint32_t iree_runtime_batcher_flags_t;
+
+// Options used to configure batcher creation.
+typedef struct iree_runtime_batcher_options_t {
+  // Flags controlling batch formation.
+  iree_runtime_batcher_flags_t flags;
+
+  // Maximum number of rows (the sum of the batch dimension of all requests)
+  // in a single invocation. Batches are issued as soon as they are full.
+  iree_host_size_t max_batch_size;
+
+  // Maximum amount of time the first request of a batch waits for others to
+  // join before the batch is issued regardless of its size. Trades latency of
+  // individual requests for throughput; IREE_DURATION_ZERO only batches
+  // requests that arrive while a prior batch is executing.
+  iree_duration_t max_delay;
+} iree_runtime_batcher_options_t;
+
+// Initializes |out_options| to its default values.
+IREE_API_EXPORT void iree_runtime_batcher_options_initialize(
+    iree_runtime_batcher_options_t* out_options);
+
+//===----------------------------------------------------------------------===//
+// iree_runtime_batcher_t
+//===----------------------------------------------------------------------===//
+
+// Collects concurrent calls to a function with a dynamic batch dimension and
+// issues them as a single invocation.
+//
+// The function must take and return only tensors (!hal.buffer_view) with the
+// batch as their outermost dimension. Each call provides its own inputs with
+// any batch size up to the maximum and the inputs of all calls in a batch are
+// concatenated along the batch dimension. The results are split back into
+// per-call buffer views that reference subspans of the batched results
+// without copies; the batched result storage remains live until all calls
+// have released their outputs.
+//
+// Calls block until their batch has completed. There are no threads owned by
+// the batcher: the first call of a batch waits up to the configured delay for
+// others to join and then issues the batch on behalf of all of them.
+// Invocations are serialized on the session so the session must not be used
+// concurrently by others while the batcher is in use.
+//
+// Thread-safe.
+typedef struct iree_runtime_batcher_t iree_runtime_batcher_t;
+
+// Creates a batcher issuing calls to |function| within |session|.
+// |out_batcher| must be released by the caller.
+IREE_API_EXPORT iree_status_t iree_runtime_batcher_create(
+    iree_runtime_session_t* session, iree_vm_function_t function,
+    const iree_runtime_batcher_options_t* options,
+    iree_allocator_t host_allocator, iree_runtime_batcher_t** out_batcher);
+
+// Retains the given |batcher| for the caller.
+IREE_API_EXPORT void iree_runtime_batcher_retain(
+    iree_runtime_batcher_t* batcher);
+
+// Releases the given |batcher| from the caller.
+// All calls must have completed.
+IREE_API_EXPORT void iree_runtime_batcher_release(
+    iree_runtime_batcher_t* batcher);
+
+// Calls the function with |inputs| as part of a batch and appends the results
+// to |outputs| once the batch has completed. All inputs must be buffer views
+// sharing the same outermost (batch) dimension. Calls whose inputs differ in
+// any other dimension or element type from those of the pending batch are
+// issued in a separate batch.
+IREE_API_EXPORT iree_status_t iree_runtime_batcher_call(
+    iree_runtime_batcher_t* batcher, iree_vm_list_t* inputs,
+    iree_vm_list_t* outputs);
+
+#ifdef __cplusplus
+}  // extern "C"
+#endif  // __cplusplus
+
+#endif  // IREE_RUNTIME_BATCHER_H_
@@ -0,0 +1,340 @@
+// Copyright 2023 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include "iree/runtime/batcher.h"
+
+#include <cstdint>
+#include <cstring>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "iree/base/api.h"
+#include "iree/hal/api.h"
+#include "iree/hal/drivers/local_sync/sync_device.h"
+#include "iree/modules/hal/types.h"
+#include "iree/runtime/api.h"
+#include "iree/testing/gtest.h"
+#include "iree/testing/status_matchers.h"
+#include "iree/vm/api.h"
+
+namespace iree {
+namespace runtime {
+namespace {
+
+using ::iree::testing::status::StatusIs;
+using ::testing::ElementsAre;
+using ::testing::UnorderedElementsAre;
+
+//===----------------------------------------------------------------------===//
+// batch_module
+//===----------------------------------------------------------------------===//
+// A native module exporting `batch.identity(%input) -> %input` that records the
+// shape of every invocation so that tests can observe how calls were batched.
+
+struct InvocationLog {
+  std::mutex mutex;
+  std::vector<std::vector<iree_hal_dim_t>> shapes;
+  // When set the function fails instead of returning its input.
+  bool fail = false;
+};
+static InvocationLog* invocation_log = NULL;
+
+static iree_status_t batch_module_identity(
+    iree_vm_stack_t* stack, iree_vm_native_function_flags_t flags,
+    iree_byte_span_t args_storage, iree_byte_span_t rets_storage,
+    iree_vm_native_function_target_t target_fn, void* module,
+    void* module_state) {
+  // Takes ownership of the argument so that it is released whether or not the
+  // call succeeds.
+  iree_vm_ref_t input = iree_vm_ref_null();
+  iree_vm_ref_move((iree_vm_ref_t*)args_storage.data, &input);
+  iree_hal_buffer_view_t* buffer_view = NULL;
+  iree_status_t status = iree_hal_buffer_view_check_deref(input, &buffer_view);
+  if (iree_status_is_ok(status)) {
+    std::lock_guard<std::mutex> lock(invocation_log->mutex);
+    const iree_hal_dim_t* dims = iree_hal_buffer_view_shape_dims(buffer_view);
+    invocation_log->shapes.emplace_back(
+        dims, dims + iree_hal_buffer_view_shape_rank(buffer_view));
+    if (invocation_log->fail) {
+      status = iree_make_status(IREE_STATUS_DATA_LOSS, "injected failure");
+    }
+  }
+  if (iree_status_is_ok(status)) {
+    iree_vm_ref_move(&input, (iree_vm_ref_t*)rets_storage.data);
+  } else {
+    iree_vm_ref_release(&input);
+  }
+  return status;
+}
+
+static const iree_vm_native_export_descriptor_t batch_module_exports_[] = {
+    {iree_make_cstring_view("identity"), iree_make_cstring_view("0r_r"), 0,
+     NULL},
+};
+static const iree_vm_native_function_ptr_t batch_module_funcs_[] = {
+    {(iree_vm_native_function_shim_t)batch_module_identity, NULL},
+};
+static_assert(IREE_ARRAYSIZE(batch_module_funcs_) ==
+                  IREE_ARRAYSIZE(batch_module_exports_),
+              "function pointer table must be 1:1 with exports");
+static const iree_vm_native_module_descriptor_t batch_module_descriptor_ = {
+    /*name=*/iree_make_cstring_view("batch"),
+    /*version=*/0,
+    /*attr_count=*/0,
+    /*attrs=*/NULL,
+    /*dependency_count=*/0,
+    /*dependencies=*/NULL,
+    /*import_count=*/0,
+    /*imports=*/NULL,
+    /*export_count=*/IREE_ARRAYSIZE(batch_module_exports_),
+    /*exports=*/batch_module_exports_,
+    /*function_count=*/IREE_ARRAYSIZE(batch_module_funcs_),
+    /*functions=*/batch_module_funcs_,
+};
+
+static iree_status_t batch_module_create(iree_vm_instance_t* instance,
+                                         iree_allocator_t allocator,
+                                         iree_vm_module_t** out_module) {
+  iree_vm_module_t interface;
+  IREE_RETURN_IF_ERROR(iree_vm_module_initialize(&interface, NULL));
+  return iree_vm_native_module_create(&interface, &batch_module_descriptor_,
+                                      instance, allocator, out_module);
+}
+
+//===----------------------------------------------------------------------===//
+// Tests
+//===----------------------------------------------------------------------===//
+
+// Result of a single iree_runtime_batcher_call.
+struct CallResult {
+  Status status;
+  std::vector<iree_hal_dim_t> shape;
+  std::vector<float> contents;
+};
+
+class BatcherTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    invocation_log = &log_;
+
+    iree_runtime_instance_options_t instance_options;
+    iree_runtime_instance_options_initialize(&instance_options);
+    IREE_ASSERT_OK(iree_runtime_instance_create(
+        &instance_options, iree_allocator_system(), &instance_));
+
+    iree_hal_allocator_t* device_allocator = NULL;
+    IREE_ASSERT_OK(iree_hal_allocator_create_heap(
+        iree_make_cstring_view("heap"), iree_allocator_system(),
+        iree_allocator_system(), &device_allocator));
+    iree_hal_sync_device_params_t device_params;
+    iree_hal_sync_device_params_initialize(&device_params);
+    iree_hal_device_t* device = NULL;
+    iree_status_t status = iree_hal_sync_device_create(
+        iree_make_cstring_view("sync"), &device_params, /*loader_count=*/0,
+        /*loaders=*/NULL, device_allocator, iree_allocator_system(), &device);
+    iree_hal_allocator_release(device_allocator);
+    IREE_ASSERT_OK(status);
+
+    iree_runtime_session_options_t session_options;
+    iree_runtime_session_options_initialize(&session_options);
+    status = iree_runtime_session_create_with_device(
+        instance_, &session_options, device, iree_allocator_system(),
+        &session_);
+    iree_hal_device_release(device);
+    IREE_ASSERT_OK(status);
+
+    iree_vm_module_t* module = NULL;
+    IREE_ASSERT_OK(batch_module_create(
+        iree_runtime_instance_vm_instance(instance_), iree_allocator_system(),
+        &module));
+    status = iree_runtime_session_append_module(session_, module);
+    iree_vm_module_release(module);
+    IREE_ASSERT_OK(status);
+    IREE_ASSERT_OK(iree_runtime_session_lookup_function(
+        session_, iree_make_cstring_view("batch.identity"), &function_));
+  }
+
+  void TearDown() override {
+    iree_runtime_batcher_release(batcher_);
+    iree_runtime_session_release(session_);
+    iree_runtime_instance_release(instance_);
+    invocation_log = NULL;
+  }
+
+  void CreateBatcher(iree_runtime_batcher_flags_t flags,
+                     iree_host_size_t max_batch_size,
+                     iree_duration_t max_delay) {
+    iree_runtime_batcher_options_t options;
+    iree_runtime_batcher_options_initialize(&options);
+    options.flags = flags;
+    options.max_batch_size = max_batch_size;
+    options.max_delay = max_delay;
+    IREE_ASSERT_OK(iree_runtime_batcher_create(
+        session_, function_, &options, iree_allocator_system(), &batcher_));
+  }
+
+  // Calls the batcher with a [rows, columns] input filled with |value|.
+  CallResult Call(iree_hal_dim_t rows, iree_hal_dim_t columns, float value) {
+    CallResult result;
+    std::vector<float> contents(rows * columns, value);
+    iree_hal_dim_t shape[2] = {rows, columns};
+    iree_hal_buffer_params_t params = {0};
+    params.type = IREE_HAL_MEMORY_TYPE_DEVICE_LOCAL;
+    params.usage = IREE_HAL_BUFFER_USAGE_DEFAULT;
+    iree_hal_buffer_view_t* input = NULL;
+    IREE_CHECK_OK(iree_hal_buffer_view_allocate_buffer(
+        iree_runtime_session_device_allocator(session_), IREE_ARRAYSIZE(shape),
+        shape, IREE_HAL_ELEMENT_TYPE_FLOAT_32,
+        IREE_HAL_ENCODING_TYPE_DENSE_ROW_MAJOR, params,
+        iree_make_const_byte_span(contents.data(),
+                                  contents.size() * sizeof(float)),
+        &input));
+
+    iree_vm_list_t* inputs = NULL;
+    IREE_CHECK_OK(iree_vm_list_create(/*element_type=*/NULL, 1,
+                                      iree_allocator_system(), &inputs));
+    iree_vm_ref_t input_ref = iree_hal_buffer_view_move_ref(input);
+    IREE_CHECK_OK(iree_vm_list_push_ref_move(inputs, &input_ref));
+    iree_vm_list_t* outputs = NULL;
+    IREE_CHECK_OK(iree_vm_list_create(/*element_type=*/NULL, 1,
+                                      iree_allocator_system(), &outputs));
+
+    result.status = iree_runtime_batcher_call(batcher_, inputs, outputs);
+    if (result.status.ok()) {
+      iree_hal_buffer_view_t* output =
+          (iree_hal_buffer_view_t*)iree_vm_list_get_ref_deref(
+              outputs, 0, iree_hal_buffer_view_get_descriptor());
+      const iree_hal_dim_t* dims = iree_hal_buffer_view_shape_dims(output);
+      result.shape.assign(dims,
+                          dims + iree_hal_buffer_view_shape_rank(output));
+      result.contents.resize(iree_hal_buffer_view_element_count(output));
+      IREE_CHECK_OK(iree_hal_buffer_map_read(
+          iree_hal_buffer_view_buffer(output), 0, result.contents.data(),
+          result.contents.size() * sizeof(float)));
+    }
+
+    iree_vm_list_release(outputs);
+    iree_vm_list_release(inputs);
+    return result;
+  }
+
+  // Issues |count| concurrent calls with [1, 2] inputs filled with their index.
+  std::vector<CallResult> CallConcurrently(int count) {
+    std::vector<CallResult> results(count);
+    std::vector<std::thread> threads;
+    for (int i = 0; i < count; ++i) {
+      threads.emplace_back([this, &results, i]() {
+        results[i] = Call(/*rows=*/1, /*columns=*/2, (float)i);
+      });
+    }
+    for (auto& thread : threads) thread.join();
+    return results;
+  }
+
+  std::vector<std::vector<iree_hal_dim_t>> InvocationShapes() {
+    std::lock_guard<std::mutex> lock(log_.mutex);
+    return log_.shapes;
+  }
+
+  InvocationLog log_;
+  iree_runtime_instance_t* instance_ = NULL;
+  iree_runtime_session_t* session_ = NULL;
+  iree_vm_function_t function_;
+  iree_runtime_batcher_t* batcher_ = NULL;
+};
+
+// Long enough that batches in tests only close once they fill.
+static const iree_duration_t kLongDelay = 10 * 1000000000ll;
+
+TEST_F(BatcherTest, ConcurrentCallsFormOneBatch) {
+  CreateBatcher(IREE_RUNTIME_BATCHER_FLAG_NONE, /*max_batch_size=*/4,
+                kLongDelay);
+  std::vector<CallResult> results = CallConcurrently(4);
+  for (int i = 0; i < 4; ++i) {
+    IREE_ASSERT_OK(results[i].status);
+    EXPECT_THAT(results[i].shape, ElementsAre(1, 2));
+    EXPECT_THAT(results[i].contents, ElementsAre((float)i, (float)i));
+  }
+  EXPECT_THAT(InvocationShapes(), ElementsAre(ElementsAre(4, 2)));
+}
+
+TEST_F(BatcherTest, FullBatchesAreIssuedImmediately) {
+  CreateBatcher(IREE_RUNTIME_BATCHER_FLAG_NONE, /*max_batch_size=*/2,
+                kLongDelay);
+  iree_time_t start_ns = iree_time_now();
+  CallResult result = Call(/*rows=*/2, /*columns=*/2, 3.0f);
+  IREE_ASSERT_OK(result.status);
+  EXPECT_LT(iree_time_now() - start_ns, kLongDelay);
+  EXPECT_THAT(result.shape, ElementsAre(2, 2));
+  EXPECT_THAT(result.contents, ElementsAre(3.0f, 3.0f, 3.0f, 3.0f));
+}
+
+TEST_F(BatcherTest, PartialBatchIssuedAfterMaxDelay) {
+  const iree_duration_t max_delay = 20 * 1000000ll;  // 20ms
+  CreateBatcher(IREE_RUNTIME_BATCHER_FLAG_NONE, /*max_batch_size=*/8,
+                max_delay);
+  iree_time_t start_ns = iree_time_now();
+  CallResult result = Call(/*rows=*/2, /*columns=*/2, 1.0f);
+  IREE_ASSERT_OK(result.status);
+  EXPECT_GE(iree_time_now() - start_ns, max_delay);
+  EXPECT_THAT(result.shape, ElementsAre(2, 2));
+  EXPECT_THAT(InvocationShapes(), ElementsAre(ElementsAre(2, 2)));
+}
+
+TEST_F(BatcherTest, IncompatibleShapesSplitBatches) {
+  CreateBatcher(IREE_RUNTIME_BATCHER_FLAG_NONE, /*max_batch_size=*/4,
+                /*max_delay=*/50 * 1000000ll);
+  CallResult narrow_result;
+  CallResult wide_result;
+  std::thread narrow_thread(
+      [&]() { narrow_result = Call(/*rows=*/1, /*columns=*/2, 1.0f); });
+  std::thread wide_thread(
+      [&]() { wide_result = Call(/*rows=*/1, /*columns=*/3, 2.0f); });
+  narrow_thread.join();
+  wide_thread.join();
+  IREE_ASSERT_OK(narrow_result.status);
+  IREE_ASSERT_OK(wide_result.status);
+  EXPECT_THAT(narrow_result.shape, ElementsAre(1, 2));
+  EXPECT_THAT(narrow_result.contents, ElementsAre(1.0f, 1.0f));
+  EXPECT_THAT(wide_result.shape, ElementsAre(1, 3));
+  EXPECT_THAT(wide_result.contents, ElementsAre(2.0f, 2.0f, 2.0f));
+  EXPECT_THAT(InvocationShapes(),
+              UnorderedElementsAre(ElementsAre(1, 2), ElementsAre(1, 3)));
+}
+
+TEST_F(BatcherTest, PadToMaxBatchSize) {
+  CreateBatcher(IREE_RUNTIME_BATCHER_FLAG_PAD_TO_MAX_BATCH_SIZE,
+                /*max_batch_size=*/4, IREE_DURATION_ZERO);
+  CallResult result = Call(/*rows=*/1, /*columns=*/2, 5.0f);
+  IREE_ASSERT_OK(result.status);
+  EXPECT_THAT(result.shape, ElementsAre(1, 2));
+  EXPECT_THAT(result.contents, ElementsAre(5.0f, 5.0f));
+  EXPECT_THAT(InvocationShapes(), ElementsAre(ElementsAre(4, 2)));
+}
+
+TEST_F(BatcherTest, ErrorsPropagateToFollowers) {
+  log_.fail = true;
+  CreateBatcher(IREE_RUNTIME_BATCHER_FLAG_NONE, /*max_batch_size=*/4,
+                kLongDelay);
+  std::vector<CallResult> results = CallConcurrently(4);
+  for (auto& result : results) {
+    EXPECT_THAT(result.status, StatusIs(StatusCode::kDataLoss));
+  }
+  EXPECT_THAT(InvocationShapes(), ElementsAre(ElementsAre(4, 2)));
+}
+
+TEST_F(BatcherTest, RejectsOversizedCalls) {
+  CreateBatcher(IREE_RUNTIME_BATCHER_FLAG_NONE, /*max_batch_size=*/2,
+                kLongDelay);
+  CallResult result = Call(/*rows=*/3, /*columns=*/2, 1.0f);
+  EXPECT_THAT(result.status, StatusIs(StatusCode::kOutOfRange));
+  EXPECT_TRUE(InvocationShapes().empty());
+}
+
+}  // namespace
+}  // namespace runtime
+}  // namespace iree
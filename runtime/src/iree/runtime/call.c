@@ -10,6 +10,7 @@
 #include <string.h>
 
 #include "iree/base/api.h"
+#include "iree/base/tracing.h"
 #include "iree/modules/hal/module.h"
 #include "iree/runtime/session.h"
 
@@ -97,6 +98,42 @@ IREE_API_EXPORT iree_status_t iree_runtime_call_invoke(
                                    call->outputs);
 }
 
+IREE_API_EXPORT iree_status_t iree_runtime_call_invoke_async(
+    iree_runtime_call_t* call, iree_hal_fence_t* wait_fence,
+    iree_runtime_call_flags_t flags, iree_hal_fence_t** out_signal_fence) {
+  return iree_runtime_session_call_async(call->session, &call->function,
+                                         call->inputs, wait_fence,
+                                         call->outputs, out_signal_fence);
+}
+
+IREE_API_EXPORT iree_status_t iree_runtime_call_invoke_chain_async(
+    iree_host_size_t call_count, iree_runtime_call_t* calls,
+    iree_hal_fence_t* wait_fence, iree_runtime_call_flags_t flags,
+    iree_hal_fence_t** out_signal_fences) {
+  IREE_ASSERT_ARGUMENT(!call_count || calls);
+  IREE_ASSERT_ARGUMENT(!call_count || out_signal_fences);
+  IREE_TRACE_ZONE_BEGIN(z0);
+  IREE_TRACE_ZONE_APPEND_VALUE(z0, (int64_t)call_count);
+  memset(out_signal_fences, 0, call_count * sizeof(*out_signal_fences));
+
+  iree_status_t status = iree_ok_status();
+  for (iree_host_size_t i = 0; i < call_count; ++i) {
+    status = iree_runtime_call_invoke_async(
+        &calls[i], i == 0 ? wait_fence : out_signal_fences[i - 1], flags,
+        &out_signal_fences[i]);
+    if (!iree_status_is_ok(status)) break;
+  }
+
+  if (!iree_status_is_ok(status)) {
+    for (iree_host_size_t i = 0; i < call_count; ++i) {
+      iree_hal_fence_release(out_signal_fences[i]);
+      out_signal_fences[i] = NULL;
+    }
+  }
+  IREE_TRACE_ZONE_END(z0);
+  return status;
+}
+
 //===----------------------------------------------------------------------===//
 // Helpers for defining call I/O
 //===----------------------------------------------------------------------===//
@@ -92,6 +92,31 @@ IREE_API_EXPORT iree_vm_list_t* iree_runtime_call_outputs(
 IREE_API_EXPORT iree_status_t iree_runtime_call_invoke(
     iree_runtime_call_t* call, iree_runtime_call_flags_t flags);
 
+// Asynchronously invokes a call to a function compiled with the coarse-fences
+// invocation model and returns a fence in |out_signal_fence| that is signaled
+// when the outputs are ready. The call waits on |wait_fence| (if not NULL)
+// before consuming its inputs. The outputs list is populated upon return but
+// the contents of the outputs must not be accessed until the signal fence is
+// reached. See iree_runtime_session_call_async for more information.
+IREE_API_EXPORT iree_status_t iree_runtime_call_invoke_async(
+    iree_runtime_call_t* call, iree_hal_fence_t* wait_fence,
+    iree_runtime_call_flags_t flags, iree_hal_fence_t** out_signal_fence);
+
+// Asynchronously invokes |call_count| |calls| in order such that each waits on
+// the signal fence of the one before it; the first waits on |wait_fence| (if
+// not NULL). The host work of each call overlaps with the device execution of
+// the prior calls, which allows for pipelining a sequence of calls without
+// blocking the host between them.
+//
+// |out_signal_fences| must have storage for |call_count| fences and receives
+// the fence signaled when the outputs of each call are ready. Ownership of the
+// fences transfers to the caller. On failure no fences are returned though
+// calls issued before the failing one may still be executing.
+IREE_API_EXPORT iree_status_t iree_runtime_call_invoke_chain_async(
+    iree_host_size_t call_count, iree_runtime_call_t* calls,
+    iree_hal_fence_t* wait_fence, iree_runtime_call_flags_t flags,
+    iree_hal_fence_t** out_signal_fences);
+
 //===----------------------------------------------------------------------===//
 // Helpers for defining call I/O
 //===----------------------------------------------------------------------===//
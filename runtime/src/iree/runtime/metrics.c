@@ -0,0 +1,23 @@
+// Copyright 2023 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include "iree/runtime/metrics.h"
+
+#include "iree/base/internal/metrics.h"
+#include "iree/base/tracing.h"
+#include "iree/hal/local/local_executable.h"
+
+IREE_API_EXPORT iree_status_t
+iree_runtime_metrics_append_prometheus(iree_string_builder_t* builder) {
+  IREE_ASSERT_ARGUMENT(builder);
+  IREE_TRACE_ZONE_BEGIN(z0);
+  iree_status_t status = iree_metrics_append_prometheus(builder);
+  if (iree_status_is_ok(status)) {
+    status = iree_hal_local_executable_statistics_append_prometheus(builder);
+  }
+  IREE_TRACE_ZONE_END(z0);
+  return status;
+}
@@ -0,0 +1,43 @@
+// Copyright 2023 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#ifndef IREE_RUNTIME_METRICS_H_
+#define IREE_RUNTIME_METRICS_H_
+
+#include "iree/base/api.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif  // __cplusplus
+
+//===----------------------------------------------------------------------===//
+// Runtime metrics
+//===----------------------------------------------------------------------===//
+// Process-wide counters and histograms recorded by the VM, HAL and task system
+// such as the number of invocations, invocation latency, dispatches issued,
+// bytes allocated per memory pool and task worker steals/idle waits.
+//
+// Metrics are cheap enough to leave enabled in production and are intended to
+// be pulled periodically by a hosting application and forwarded to whatever
+// monitoring system it uses. They are compiled out when IREE_METRICS_ENABLE
+// (which defaults to IREE_STATISTICS_ENABLE) is 0 in which case no metrics are
+// reported.
+//
+// Per-export timings of CPU executables are included when enabled with
+// iree_hal_local_executable_set_statistics_enabled prior to loading them.
+//
+// Thread-safe.
+
+// Appends all metrics recorded so far to |builder| in the Prometheus text
+// exposition format. Metrics that have never been recorded are omitted.
+IREE_API_EXPORT iree_status_t
+iree_runtime_metrics_append_prometheus(iree_string_builder_t* builder);
+
+#ifdef __cplusplus
+}  // extern "C"
+#endif  // __cplusplus
+
+#endif  // IREE_RUNTIME_METRICS_H_
@@ -228,13 +228,13 @@ iree_runtime_session_append_bytecode_module_from_file(
   IREE_TRACE_ZONE_BEGIN(z0);
   IREE_TRACE_ZONE_APPEND_TEXT(z0, file_path);
 
-  // TODO(#3909): actually map the memory here. For now we just load the
-  // contents.
+  // Map the file so that the module and its embedded rodata reference the
+  // page cache directly instead of a heap copy of the contents.
   iree_file_contents_t* flatbuffer_contents = NULL;
   IREE_RETURN_AND_END_ZONE_IF_ERROR(
-      z0, iree_file_read_contents(file_path,
-                                  iree_runtime_session_host_allocator(session),
-                                  &flatbuffer_contents));
+      z0, iree_file_map_contents(file_path,
+                                 iree_runtime_session_host_allocator(session),
+                                 &flatbuffer_contents));
 
   iree_status_t status =
       iree_runtime_session_append_bytecode_module_from_memory(
@@ -302,6 +302,84 @@ IREE_API_EXPORT iree_status_t iree_runtime_session_call(
   return status;
 }
 
+IREE_API_EXPORT iree_status_t iree_runtime_session_call_async(
+    iree_runtime_session_t* session, const iree_vm_function_t* function,
+    iree_vm_list_t* input_list, iree_hal_fence_t* wait_fence,
+    iree_vm_list_t* output_list, iree_hal_fence_t** out_signal_fence) {
+  IREE_ASSERT_ARGUMENT(session);
+  IREE_ASSERT_ARGUMENT(function);
+  IREE_ASSERT_ARGUMENT(out_signal_fence);
+  *out_signal_fence = NULL;
+
+  // Without fences in the signature the trailing arguments would be
+  // misinterpreted as user inputs.
+  iree_string_view_t model = iree_vm_function_lookup_attr_by_name(
+      function, IREE_SV("iree.abi.model"));
+  if (!iree_string_view_equal(model, IREE_SV("coarse-fences"))) {
+    iree_string_view_t name = iree_vm_function_name(function);
+    return iree_make_status(
+        IREE_STATUS_FAILED_PRECONDITION,
+        "function '%.*s' does not use the coarse-fences invocation model; "
+        "compile with --iree-execution-model=async-external",
+        (int)name.size, name.data);
+  }
+
+  IREE_TRACE_ZONE_BEGIN(z0);
+  iree_allocator_t host_allocator =
+      iree_runtime_session_host_allocator(session);
+
+  // Signal fence covering all outputs of the call.
+  iree_hal_semaphore_t* semaphore = NULL;
+  IREE_RETURN_AND_END_ZONE_IF_ERROR(
+      z0, iree_hal_semaphore_create(iree_runtime_session_device(session), 0ull,
+                                    &semaphore));
+  iree_hal_fence_t* signal_fence = NULL;
+  iree_status_t status =
+      iree_hal_fence_create_at(semaphore, 1ull, host_allocator, &signal_fence);
+  iree_hal_semaphore_release(semaphore);
+
+  // (inputs..., wait_fence, signal_fence)
+  iree_host_size_t input_count = input_list ? iree_vm_list_size(input_list) : 0;
+  iree_vm_list_t* arg_list = NULL;
+  if (iree_status_is_ok(status)) {
+    status = iree_vm_list_create(/*element_type=*/NULL, input_count + 2,
+                                 host_allocator, &arg_list);
+  }
+  for (iree_host_size_t i = 0; i < input_count && iree_status_is_ok(status);
+       ++i) {
+    iree_vm_variant_t value = iree_vm_variant_empty();
+    status = iree_vm_list_get_variant(input_list, i, &value);
+    if (iree_status_is_ok(status)) {
+      status = iree_vm_list_push_variant(arg_list, &value);
+    }
+  }
+  if (iree_status_is_ok(status)) {
+    iree_vm_ref_t wait_fence_ref =
+        wait_fence ? iree_hal_fence_retain_ref(wait_fence) : iree_vm_ref_null();
+    status = iree_vm_list_push_ref_move(arg_list, &wait_fence_ref);
+  }
+  if (iree_status_is_ok(status)) {
+    iree_vm_ref_t signal_fence_ref = iree_hal_fence_retain_ref(signal_fence);
+    status = iree_vm_list_push_ref_move(arg_list, &signal_fence_ref);
+  }
+
+  if (iree_status_is_ok(status)) {
+    status = iree_vm_invoke(iree_runtime_session_context(session), *function,
+                            IREE_VM_INVOCATION_FLAG_NONE,
+                            /*policy=*/NULL, arg_list, output_list,
+                            host_allocator);
+  }
+
+  iree_vm_list_release(arg_list);
+  if (iree_status_is_ok(status)) {
+    *out_signal_fence = signal_fence;
+  } else {
+    iree_hal_fence_release(signal_fence);
+  }
+  IREE_TRACE_ZONE_END(z0);
+  return status;
+}
+
 IREE_API_EXPORT iree_status_t iree_runtime_session_call_by_name(
     iree_runtime_session_t* session, iree_string_view_t full_name,
     iree_vm_list_t* input_list, iree_vm_list_t* output_list) {
@@ -216,6 +216,26 @@ IREE_API_EXPORT iree_status_t iree_runtime_session_call_by_name(
     iree_runtime_session_t* session, iree_string_view_t full_name,
     iree_vm_list_t* input_list, iree_vm_list_t* output_list);
 
+// Asynchronously issues a function call compiled with the coarse-fences
+// invocation model (`--iree-execution-model=async-external`).
+//
+// The function will wait on |wait_fence| before consuming any of its inputs
+// and a new fence that is signaled when all outputs are ready is returned in
+// |out_signal_fence|. NULL may be passed for |wait_fence| if the inputs are
+// immediately available. The call returns as soon as the host work (argument
+// marshaling, command buffer recording, and submission) is complete and the
+// outputs in |output_list| must not be accessed until the signal fence is
+// reached. Passing the signal fence of one call as the wait fence of another
+// allows the host work of the latter to overlap with device execution of the
+// former.
+//
+// |input_list| is not modified; the fences are appended to a copy as required
+// by the function ABI. Ownership of the returned fence transfers to the caller.
+IREE_API_EXPORT iree_status_t iree_runtime_session_call_async(
+    iree_runtime_session_t* session, const iree_vm_function_t* function,
+    iree_vm_list_t* input_list, iree_hal_fence_t* wait_fence,
+    iree_vm_list_t* output_list, iree_hal_fence_t** out_signal_fence);
+
 // Synchronously issues a direct function call.
 // This bypasses signature verification and directly calls through the VM ABI.
 // Though still safe(ish) the errors reported on a signature mismatch will be
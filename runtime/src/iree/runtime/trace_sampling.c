@@ -0,0 +1,27 @@
+// Copyright 2023 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include "iree/runtime/trace_sampling.h"
+
+#include "iree/base/internal/sampling_tracer.h"
+#include "iree/base/tracing.h"
+
+IREE_API_EXPORT void iree_runtime_trace_sampling_set_rate(uint32_t one_in_n) {
+  iree_sampling_tracer_set_rate(one_in_n);
+}
+
+IREE_API_EXPORT void iree_runtime_trace_sampling_reset(void) {
+  iree_sampling_tracer_reset();
+}
+
+IREE_API_EXPORT iree_status_t
+iree_runtime_trace_sampling_append_chrome_json(iree_string_builder_t* builder) {
+  IREE_ASSERT_ARGUMENT(builder);
+  IREE_TRACE_ZONE_BEGIN(z0);
+  iree_status_t status = iree_sampling_tracer_append_chrome_json(builder);
+  IREE_TRACE_ZONE_END(z0);
+  return status;
+}
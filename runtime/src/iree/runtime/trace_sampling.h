@@ -0,0 +1,49 @@
+// Copyright 2023 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#ifndef IREE_RUNTIME_TRACE_SAMPLING_H_
+#define IREE_RUNTIME_TRACE_SAMPLING_H_
+
+#include <stdint.h>
+
+#include "iree/base/api.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif  // __cplusplus
+
+//===----------------------------------------------------------------------===//
+// Sampled tracing
+//===----------------------------------------------------------------------===//
+// A low-overhead tracer that can be enabled in production builds without
+// rebuilding with Tracy. When enabled one in every N synchronous VM
+// invocations, HAL queue submissions and task executions on each thread are
+// recorded (along with any of those nested within them) into per-thread ring
+// buffers holding the most recent events. The rings can be dumped at any time
+// as Chrome trace event JSON loadable in chrome://tracing or Perfetto.
+//
+// Sampling is disabled by default and costs a single atomic load per
+// instrumented call while disabled.
+//
+// Thread-safe.
+
+// Sets the sampling rate such that one in every |one_in_n| invocations on each
+// thread is traced. 0 disables sampling and 1 traces everything.
+IREE_API_EXPORT void iree_runtime_trace_sampling_set_rate(uint32_t one_in_n);
+
+// Discards all recorded trace events.
+IREE_API_EXPORT void iree_runtime_trace_sampling_reset(void);
+
+// Appends the most recently recorded trace events to |builder| as a Chrome
+// trace event JSON object.
+IREE_API_EXPORT iree_status_t
+iree_runtime_trace_sampling_append_chrome_json(iree_string_builder_t* builder);
+
+#ifdef __cplusplus
+}  // extern "C"
+#endif  // __cplusplus
+
+#endif  // IREE_RUNTIME_TRACE_SAMPLING_H_
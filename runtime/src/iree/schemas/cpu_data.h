@@ -73,6 +73,91 @@ enum iree_cpu_data_field_0_e {
   // Canonical key: "i8mm"
   IREE_CPU_DATA_FIELD_0_AARCH64_HAVE_I8MM = 1ull << 1,
 
+  //===--------------------------------------------------------------------===//
+  // IREE_ARCH_X86_64 / x86-64
+  //===--------------------------------------------------------------------===//
+
+  // Indicates support for AVX2 and FMA3 instructions with OS support for
+  // saving the YMM register state.
+  //
+  // Source: CPUID.(EAX=07H,ECX=0):EBX.AVX2[bit 5] && CPUID.01H:ECX.FMA[bit 12]
+  //         && XCR0[2:1] == 0b11
+  // Canonical key: "avx2_fma"
+  IREE_CPU_DATA_FIELD_0_X86_64_HAVE_AVX2_FMA = 1ull << 0,
+
+  // Indicates support for the AVX-512 feature set common to all server parts
+  // (Skylake-SP and later, Zen 4 and later): AVX512F, AVX512BW, AVX512DQ,
+  // AVX512VL and AVX512CD with OS support for saving the ZMM register state.
+  // Implies IREE_CPU_DATA_FIELD_0_X86_64_HAVE_AVX2_FMA.
+  //
+  // Source: CPUID.(EAX=07H,ECX=0):EBX[bits 16,17,28,30,31]
+  //         && XCR0[7:5] == 0b111 && XCR0[2:1] == 0b11
+  // Canonical key: "avx512_base"
+  IREE_CPU_DATA_FIELD_0_X86_64_HAVE_AVX512_BASE = 1ull << 1,
+
+  // Indicates support for AVX-512 Vector Neural Network Instructions.
+  // Only set when IREE_CPU_DATA_FIELD_0_X86_64_HAVE_AVX512_BASE is also set.
+  //
+  // VPDPBUSD, VPDPBUSDS, VPDPWSSD and VPDPWSSDS instructions are implemented.
+  //
+  // Source: CPUID.(EAX=07H,ECX=0):ECX.AVX512_VNNI[bit 11]
+  // Canonical key: "avx512vnni"
+  IREE_CPU_DATA_FIELD_0_X86_64_HAVE_AVX512VNNI = 1ull << 2,
+
+  // Indicates support for AVX-512 BFloat16 instructions.
+  // Only set when IREE_CPU_DATA_FIELD_0_X86_64_HAVE_AVX512_BASE is also set.
+  //
+  // VCVTNE2PS2BF16, VCVTNEPS2BF16 and VDPBF16PS instructions are implemented.
+  //
+  // Source: CPUID.(EAX=07H,ECX=1):EAX.AVX512_BF16[bit 5]
+  // Canonical key: "avx512bf16"
+  IREE_CPU_DATA_FIELD_0_X86_64_HAVE_AVX512BF16 = 1ull << 3,
+
+  //===--------------------------------------------------------------------===//
+  // IREE_ARCH_RISCV_64 / riscv64
+  //===--------------------------------------------------------------------===//
+
+  // Indicates support for the RISC-V Vector extension version 1.0, which
+  // guarantees VLEN >= 128.
+  //
+  // Source: AT_HWCAP bit ('V' - 'A')
+  // Canonical key: "v"
+  IREE_CPU_DATA_FIELD_0_RISCV_64_HAVE_V = 1ull << 0,
+
+  // Indicates a vector register length VLEN >= 256 bits (the Zvl256b
+  // extension). Only set when IREE_CPU_DATA_FIELD_0_RISCV_64_HAVE_V is also
+  // set.
+  //
+  // Source: CSR vlenb >= 32
+  // Canonical key: "zvl256b"
+  IREE_CPU_DATA_FIELD_0_RISCV_64_HAVE_ZVL256B = 1ull << 1,
+
+};
+
+// Bit-packed values for processor data field 1: data cache sizes, on all
+// architectures.
+//
+// Sizes are in KiB and describe the share of a cache level available to one
+// logical processor, i.e. the size of one cache instance divided by the number
+// of logical processors sharing it. That is what a kernel running on every
+// thread of a pool can count on having to itself. Zero means unknown and
+// values that do not fit are saturated.
+enum iree_cpu_data_field_1_e {
+  // Per-logical-processor share of the level 1 data cache, in KiB.
+  //
+  // Source: CPUID.04H / CPUID.8000001DH on x86-64, sysfs cache/index* on
+  //         Linux and Android, hw.l1dcachesize on macOS and iOS
+  // Canonical key: "l1d_cache_kib"
+  IREE_CPU_DATA_FIELD_1_L1D_CACHE_KIB_SHIFT = 0,
+  IREE_CPU_DATA_FIELD_1_L1D_CACHE_KIB_MASK = 0xFFFFull << 0,
+
+  // Per-logical-processor share of the level 2 cache, in KiB.
+  //
+  // Source: as for the L1 data cache, with hw.perflevel0.l2cachesize and
+  //         hw.perflevel0.cpusperl2 on macOS and iOS
+  // Canonical key: "l2_cache_kib"
+  IREE_CPU_DATA_FIELD_1_L2_CACHE_KIB_SHIFT = 16,
+  IREE_CPU_DATA_FIELD_1_L2_CACHE_KIB_MASK = 0xFFFFull << 16,
 };
 
 #endif  // IREE_SCHEMAS_CPU_DATA_H_
@@ -25,9 +25,18 @@ extern "C" {
 // iree_task_affinity_set_t
 //===----------------------------------------------------------------------===//
 
+// A bitmask of workers within a single worker cluster.
+// Bit N corresponds to the cluster-local worker index N; the executor-local
+// worker index is (cluster_index * IREE_TASK_EXECUTOR_MAX_WORKERS_PER_CLUSTER +
+// N).
+// When used as a task affinity the same set applies to all clusters.
 typedef uint64_t iree_task_affinity_set_t;
+static_assert(sizeof(iree_task_affinity_set_t) * 8 ==
+                  IREE_TASK_EXECUTOR_MAX_WORKERS_PER_CLUSTER,
+              "affinity sets must be able to represent all workers in a "
+              "cluster");
 
-// Allows for only a specific worker to be selected.
+// Allows for only a specific cluster-local worker to be selected.
 static inline iree_task_affinity_set_t iree_task_affinity_for_worker(
     uint8_t worker_index) {
   return 1ull << worker_index;
@@ -35,6 +35,30 @@ IREE_FLAG(
     "only use a specific maximum amount of local memory and the runtime must\n"
     "be configured to make at least that amount of local memory available.");
 
+IREE_FLAG(
+    int32_t, task_worker_local_memory_limit, 0,
+    "Specifies the maximum bytes of per-worker local memory that workers may\n"
+    "grow to when dispatched tiles require more than\n"
+    "--task_worker_local_memory. Workers allocate the memory the first time\n"
+    "it is required and retain it for future dispatches. 0 disables growth.");
+
+IREE_FLAG(
+    bool, task_worker_remote_node_theft, false,
+    "Allows workers to steal tasks from workers on other NUMA nodes. By\n"
+    "default work stealing is kept within each node.");
+
+IREE_FLAG(
+    bool, task_worker_spin_adaptive, false,
+    "Tunes the duration each worker spins waiting for additional work based\n"
+    "on the observed time between tasks arriving. --task_worker_spin_us\n"
+    "bounds the spin duration when specified.");
+
+IREE_FLAG(
+    bool, task_scheduling_prioritize_latency, false,
+    "Prioritizes the latency of high priority tasks over total throughput by\n"
+    "allowing lower priority dispatches to be preempted between tile\n"
+    "reservations when higher priority work arrives.");
+
 iree_status_t iree_task_executor_options_initialize_from_flags(
     iree_task_executor_options_t* out_options) {
   IREE_ASSERT_ARGUMENT(out_options);
@@ -45,6 +69,21 @@ iree_status_t iree_task_executor_options_initialize_from_flags(
 
   out_options->worker_local_memory_size =
       (iree_host_size_t)FLAG_task_worker_local_memory;
+  out_options->worker_local_memory_limit =
+      (iree_host_size_t)FLAG_task_worker_local_memory_limit;
+
+  if (FLAG_task_worker_remote_node_theft) {
+    out_options->scheduling_mode |=
+        IREE_TASK_SCHEDULING_MODE_ALLOW_REMOTE_NODE_THEFT;
+  }
+  if (FLAG_task_worker_spin_adaptive) {
+    out_options->scheduling_mode |=
+        IREE_TASK_SCHEDULING_MODE_ADAPTIVE_WORKER_SPIN;
+  }
+  if (FLAG_task_scheduling_prioritize_latency) {
+    out_options->scheduling_mode |=
+        IREE_TASK_SCHEDULING_MODE_PRIORITIZE_LATENCY;
+  }
 
   return iree_ok_status();
 }
@@ -75,6 +114,18 @@ IREE_FLAG(
     "detected and used when --task_topology_group_count=0 and is ignored\n"
     "otherwise.\n");
 
+IREE_FLAG(
+    int32_t, task_topology_node_id, -1,
+    "Selects only cores on the specified NUMA node when using the\n"
+    "'physical_cores' mode. -1 selects cores from all nodes.");
+
+IREE_FLAG(
+    int32_t, task_topology_max_core_class, -1,
+    "Selects only cores of the specified performance class or faster when\n"
+    "using the 'physical_cores' mode on heterogeneous systems. Class 0 are\n"
+    "the fastest cores (big/P-cores) such that 0 excludes little/E-cores.\n"
+    "-1 selects cores of all classes.");
+
 // TODO(benvanik): add --task_topology_dump to dump out the current machine
 // configuration as seen by the topology utilities.
 
@@ -87,7 +138,15 @@ iree_status_t iree_task_topology_initialize_from_flags(
     iree_task_topology_initialize_from_group_count(
         FLAG_task_topology_group_count, out_topology);
   } else if (strcmp(FLAG_task_topology_mode, "physical_cores") == 0) {
-    iree_task_topology_initialize_from_physical_cores(
+    iree_task_topology_initialize_from_physical_cores_of_class(
+        FLAG_task_topology_node_id < 0
+            ? IREE_TASK_TOPOLOGY_NODE_ID_ANY
+            : (iree_task_topology_node_id_t)FLAG_task_topology_node_id,
+        FLAG_task_topology_max_core_class < 0
+            ? IREE_TASK_TOPOLOGY_CORE_CLASS_ANY
+            : (iree_task_topology_core_class_t)iree_min(
+                  FLAG_task_topology_max_core_class,
+                  IREE_TASK_TOPOLOGY_CORE_CLASS_ANY),
         FLAG_task_topology_max_group_count, out_topology);
   } else {
     return iree_make_status(
@@ -126,3 +185,26 @@ iree_status_t iree_task_executor_create_from_flags(
   IREE_TRACE_ZONE_END(z0);
   return status;
 }
+
+iree_status_t iree_task_executor_acquire_shared_from_flags(
+    iree_allocator_t host_allocator, iree_task_executor_t** out_executor) {
+  IREE_ASSERT_ARGUMENT(out_executor);
+  *out_executor = NULL;
+  IREE_TRACE_ZONE_BEGIN(z0);
+
+  iree_task_executor_options_t options;
+  IREE_RETURN_AND_END_ZONE_IF_ERROR(
+      z0, iree_task_executor_options_initialize_from_flags(&options));
+
+  iree_task_topology_t topology;
+  IREE_RETURN_AND_END_ZONE_IF_ERROR(
+      z0, iree_task_topology_initialize_from_flags(&topology));
+
+  iree_status_t status = iree_task_executor_acquire_shared(
+      options, &topology, host_allocator, out_executor);
+
+  iree_task_topology_deinitialize(&topology);
+
+  IREE_TRACE_ZONE_END(z0);
+  return status;
+}
@@ -45,6 +45,13 @@ iree_status_t iree_task_topology_initialize_from_flags(
 iree_status_t iree_task_executor_create_from_flags(
     iree_allocator_t host_allocator, iree_task_executor_t** out_executor);
 
+// Returns the process-wide shared task system executor, creating it from the
+// current command line flags if no shared executor is alive.
+// See iree_task_executor_acquire_shared for details.
+// |out_executor| must be released by the caller.
+iree_status_t iree_task_executor_acquire_shared_from_flags(
+    iree_allocator_t host_allocator, iree_task_executor_t** out_executor);
+
 //===----------------------------------------------------------------------===//
 // Task system simple invocation utilities
 //===----------------------------------------------------------------------===//
@@ -10,7 +10,11 @@
 #include <stddef.h>
 #include <string.h>
 
+#include "iree/base/internal/call_once.h"
+#include "iree/base/internal/cpu.h"
+#include "iree/base/internal/fpu_state.h"
 #include "iree/base/internal/math.h"
+#include "iree/base/internal/synchronization.h"
 #include "iree/base/tracing.h"
 #include "iree/task/affinity_set.h"
 #include "iree/task/executor_impl.h"
@@ -53,22 +57,30 @@ iree_status_t iree_task_executor_create(iree_task_executor_options_t options,
   IREE_ASSERT_ARGUMENT(out_executor);
   *out_executor = NULL;
 
-  // The executor is followed in memory by worker[] + worker_local_memory[].
+  // The executor is followed in memory by worker_clusters[] + workers[].
   // The whole point is that we don't want destructive sharing between workers
   // so ensure we are aligned to at least the destructive interference size.
+  // Worker local memory is allocated separately and aligned to pages so that
+  // each worker's pages can be placed on its own NUMA node.
   options.worker_local_memory_size =
       iree_host_align(options.worker_local_memory_size,
-                      iree_hardware_destructive_interference_size);
+                      IREE_TASK_EXECUTOR_WORKER_LOCAL_MEMORY_ALIGNMENT);
   IREE_TRACE_ZONE_APPEND_VALUE(z0, (int64_t)options.worker_local_memory_size);
+  IREE_TRACE_ZONE_APPEND_VALUE(z0, (int64_t)options.worker_local_memory_limit);
   iree_host_size_t executor_base_size =
       iree_host_align(sizeof(iree_task_executor_t),
                       iree_hardware_destructive_interference_size);
+  iree_host_size_t worker_cluster_count =
+      (worker_count + IREE_TASK_EXECUTOR_MAX_WORKERS_PER_CLUSTER - 1) /
+      IREE_TASK_EXECUTOR_MAX_WORKERS_PER_CLUSTER;
+  iree_host_size_t worker_cluster_list_size =
+      iree_host_align(worker_cluster_count * sizeof(iree_task_worker_cluster_t),
+                      iree_hardware_destructive_interference_size);
   iree_host_size_t worker_list_size =
       iree_host_align(worker_count * sizeof(iree_task_worker_t),
                       iree_hardware_destructive_interference_size);
   iree_host_size_t executor_size =
-      executor_base_size + worker_list_size +
-      worker_count * options.worker_local_memory_size;
+      executor_base_size + worker_cluster_list_size + worker_list_size;
 
   iree_task_executor_t* executor = NULL;
   IREE_RETURN_AND_END_ZONE_IF_ERROR(
@@ -78,8 +90,12 @@ iree_status_t iree_task_executor_create(iree_task_executor_options_t options,
   executor->allocator = allocator;
   executor->scheduling_mode = options.scheduling_mode;
   executor->worker_spin_ns = options.worker_spin_ns;
+  if (iree_all_bits_set(executor->scheduling_mode,
+                        IREE_TASK_SCHEDULING_MODE_ADAPTIVE_WORKER_SPIN) &&
+      executor->worker_spin_ns <= 0) {
+    executor->worker_spin_ns = IREE_TASK_WORKER_DEFAULT_MAX_ADAPTIVE_SPIN_NS;
+  }
   iree_atomic_task_slist_initialize(&executor->incoming_ready_slist);
-  iree_slim_mutex_initialize(&executor->coordinator_mutex);
 
   // Simple PRNG used to generate seeds for the per-worker PRNGs used to
   // distribute work. This isn't strong (and doesn't need to be); it's just
@@ -95,6 +111,15 @@ iree_status_t iree_task_executor_create(iree_task_executor_options_t options,
 
   iree_status_t status = iree_ok_status();
 
+  // Worker local memory is left untouched here (beyond what the allocator may
+  // do) and each worker touches its own range first from its own thread.
+  if (iree_status_is_ok(status) && options.worker_local_memory_size > 0) {
+    status = iree_allocator_malloc_aligned(
+        allocator, worker_count * options.worker_local_memory_size,
+        IREE_TASK_EXECUTOR_WORKER_LOCAL_MEMORY_ALIGNMENT, /*offset=*/0,
+        &executor->worker_local_memory);
+  }
+
   // Pool used for system events; exposed to users of the task system to ensure
   // we minimize the number of live events and reduce overheads in
   // high-frequency transient parking operations.
@@ -129,35 +154,56 @@ iree_status_t iree_task_executor_create(iree_task_executor_options_t options,
   // (if the platform supports it) awaiting the first tasks getting scheduled.
   if (iree_status_is_ok(status)) {
     executor->worker_base_index = options.worker_base_index;
+    executor->worker_local_memory_limit = options.worker_local_memory_limit;
+    executor->donor_local_memory_limit =
+        iree_max(options.worker_local_memory_size,
+                 options.worker_local_memory_limit);
     executor->worker_count = worker_count;
+    executor->node_id = iree_task_topology_get_group(topology, 0)->node_id;
+    for (iree_host_size_t i = 1; i < worker_count; ++i) {
+      if (iree_task_topology_get_group(topology, i)->node_id !=
+          executor->node_id) {
+        executor->node_id = IREE_TASK_TOPOLOGY_NODE_ID_ANY;
+        break;
+      }
+    }
+    executor->worker_cluster_count = worker_cluster_count;
+    executor->worker_clusters =
+        (iree_task_worker_cluster_t*)((uint8_t*)executor + executor_base_size);
     executor->workers =
-        (iree_task_worker_t*)((uint8_t*)executor + executor_base_size);
-    uint8_t* worker_local_memory =
-        (uint8_t*)executor->workers + worker_list_size;
+        (iree_task_worker_t*)((uint8_t*)executor->worker_clusters +
+                              worker_cluster_list_size);
+    uint8_t* worker_local_memory = (uint8_t*)executor->worker_local_memory;
 
-    iree_task_affinity_set_t worker_idle_mask = 0;
-    iree_task_affinity_set_t worker_live_mask = 0;
+    iree_task_affinity_set_t
+        worker_masks[IREE_TASK_EXECUTOR_MAX_CLUSTER_COUNT] = {0};
     for (iree_host_size_t i = 0; i < worker_count; ++i) {
-      iree_task_affinity_set_t worker_bit = iree_task_affinity_for_worker(i);
-      worker_idle_mask |= worker_bit;
-      worker_live_mask |= worker_bit;
+      worker_masks[i / IREE_TASK_EXECUTOR_MAX_WORKERS_PER_CLUSTER] |=
+          iree_task_affinity_for_worker(
+              i % IREE_TASK_EXECUTOR_MAX_WORKERS_PER_CLUSTER);
 
       iree_task_worker_t* worker = &executor->workers[i];
       status = iree_task_worker_initialize(
-          executor, i, iree_task_topology_get_group(topology, i),
+          executor, i, topology,
           iree_make_byte_span(worker_local_memory,
                               options.worker_local_memory_size),
           &seed_prng, worker);
-      worker_local_memory += options.worker_local_memory_size;
+      if (worker_local_memory) {
+        worker_local_memory += options.worker_local_memory_size;
+      }
       if (!iree_status_is_ok(status)) break;
     }
-    // The masks are accessed with 'relaxed' order because they are just hints.
-    iree_atomic_task_affinity_set_store(&executor->worker_idle_mask,
-                                        worker_idle_mask,
-                                        iree_memory_order_relaxed);
-    iree_atomic_task_affinity_set_store(&executor->worker_live_mask,
-                                        worker_live_mask,
-                                        iree_memory_order_relaxed);
+    for (iree_host_size_t i = 0; i < worker_cluster_count; ++i) {
+      // The masks are accessed with 'relaxed' order because they are just
+      // hints.
+      iree_task_worker_cluster_t* cluster = &executor->worker_clusters[i];
+      iree_atomic_task_affinity_set_store(&cluster->worker_idle_mask,
+                                          worker_masks[i],
+                                          iree_memory_order_relaxed);
+      iree_atomic_task_affinity_set_store(&cluster->worker_live_mask,
+                                          worker_masks[i],
+                                          iree_memory_order_relaxed);
+    }
   }
 
   if (!iree_status_is_ok(status)) {
@@ -207,14 +253,92 @@ static void iree_task_executor_destroy(iree_task_executor_t* executor) {
   iree_task_poller_deinitialize(&executor->poller);
 
   iree_event_pool_free(executor->event_pool);
-  iree_slim_mutex_deinitialize(&executor->coordinator_mutex);
   iree_atomic_task_slist_deinitialize(&executor->incoming_ready_slist);
   iree_task_pool_deinitialize(&executor->transient_task_pool);
+  if (executor->worker_local_memory) {
+    iree_allocator_free_aligned(executor->allocator,
+                                executor->worker_local_memory);
+  }
+  if (executor->donor_local_memory) {
+    iree_allocator_free_aligned(executor->allocator,
+                                executor->donor_local_memory);
+  }
   iree_allocator_free(executor->allocator, executor);
 
   IREE_TRACE_ZONE_END(z0);
 }
 
+//===----------------------------------------------------------------------===//
+// Process-wide shared executor
+//===----------------------------------------------------------------------===//
+
+// Weak reference to the process-wide shared executor, if any is alive.
+// The executor clears the slot when its last reference is released.
+typedef struct iree_task_executor_shared_slot_t {
+  iree_slim_mutex_t mutex;
+  iree_task_executor_t* executor IREE_GUARDED_BY(mutex);
+} iree_task_executor_shared_slot_t;
+
+static iree_task_executor_shared_slot_t iree_task_executor_shared_slot_;
+static iree_once_flag iree_task_executor_shared_slot_flag_ =
+    IREE_ONCE_FLAG_INIT;
+static void iree_task_executor_shared_slot_initialize(void) {
+  memset(&iree_task_executor_shared_slot_, 0,
+         sizeof(iree_task_executor_shared_slot_));
+  iree_slim_mutex_initialize(&iree_task_executor_shared_slot_.mutex);
+}
+
+static iree_task_executor_shared_slot_t* iree_task_executor_shared_slot(void) {
+  iree_call_once(&iree_task_executor_shared_slot_flag_,
+                 iree_task_executor_shared_slot_initialize);
+  return &iree_task_executor_shared_slot_;
+}
+
+// Retains |executor| unless its last reference has already been released and
+// it is on its way to being destroyed.
+static bool iree_task_executor_try_retain(iree_task_executor_t* executor) {
+  int32_t ref_count = iree_atomic_ref_count_load(&executor->ref_count);
+  while (ref_count > 0) {
+    if (iree_atomic_compare_exchange_weak_int32(
+            &executor->ref_count, &ref_count, ref_count + 1,
+            iree_memory_order_acquire, iree_memory_order_acquire)) {
+      return true;
+    }
+  }
+  return false;
+}
+
+iree_status_t iree_task_executor_acquire_shared(
+    iree_task_executor_options_t options, const iree_task_topology_t* topology,
+    iree_allocator_t allocator, iree_task_executor_t** out_executor) {
+  IREE_ASSERT_ARGUMENT(topology);
+  IREE_ASSERT_ARGUMENT(out_executor);
+  *out_executor = NULL;
+  IREE_TRACE_ZONE_BEGIN(z0);
+
+  // The executor is created under the lock so that concurrent callers don't
+  // race to create their own. This only happens once per shared lifetime.
+  iree_task_executor_shared_slot_t* slot = iree_task_executor_shared_slot();
+  iree_slim_mutex_lock(&slot->mutex);
+  iree_status_t status = iree_ok_status();
+  if (slot->executor && iree_task_executor_try_retain(slot->executor)) {
+    *out_executor = slot->executor;
+  } else {
+    // Any executor still in the slot is being destroyed and will not clear
+    // the slot once it sees it has been replaced.
+    status =
+        iree_task_executor_create(options, topology, allocator, out_executor);
+    if (iree_status_is_ok(status)) {
+      (*out_executor)->is_shared = true;
+      slot->executor = *out_executor;
+    }
+  }
+  iree_slim_mutex_unlock(&slot->mutex);
+
+  IREE_TRACE_ZONE_END(z0);
+  return status;
+}
+
 void iree_task_executor_retain(iree_task_executor_t* executor) {
   if (executor) {
     iree_atomic_ref_count_inc(&executor->ref_count);
@@ -223,6 +347,14 @@ void iree_task_executor_retain(iree_task_executor_t* executor) {
 
 void iree_task_executor_release(iree_task_executor_t* executor) {
   if (executor && iree_atomic_ref_count_dec(&executor->ref_count) == 1) {
+    if (executor->is_shared) {
+      // Drop the weak reference before destroying so that new users create a
+      // fresh executor. The lock ensures no acquirer is still inspecting us.
+      iree_task_executor_shared_slot_t* slot = iree_task_executor_shared_slot();
+      iree_slim_mutex_lock(&slot->mutex);
+      if (slot->executor == executor) slot->executor = NULL;
+      iree_slim_mutex_unlock(&slot->mutex);
+    }
     iree_task_executor_destroy(executor);
   }
 }
@@ -241,6 +373,11 @@ iree_host_size_t iree_task_executor_worker_count(
   return executor->worker_count;
 }
 
+iree_task_topology_node_id_t iree_task_executor_node_id(
+    iree_task_executor_t* executor) {
+  return executor->node_id;
+}
+
 iree_event_pool_t* iree_task_executor_event_pool(
     iree_task_executor_t* executor) {
   return executor->event_pool;
@@ -265,7 +402,7 @@ iree_status_t iree_task_executor_acquire_fence(iree_task_executor_t* executor,
 // The task will be posted to the worker mailbox and available for the worker to
 // begin processing as soon as the |post_batch| is submitted.
 //
-// Only called during coordination and expects the coordinator lock to be held.
+// Only called during coordination by the thread owning |post_batch|.
 static void iree_task_executor_relay_to_worker(
     iree_task_executor_t* executor, iree_task_post_batch_t* post_batch,
     iree_task_t* task) {
@@ -284,7 +421,7 @@ static void iree_task_executor_relay_to_worker(
 // least recently added tasks from the submission (nice in-order traversal) we
 // are pushing them as what will become the least recent tasks in the batch.
 //
-// Only called during coordination and expects the coordinator lock to be held.
+// Only called during coordination by the thread owning |post_batch|.
 void iree_task_executor_schedule_ready_tasks(
     iree_task_executor_t* executor, iree_task_submission_t* pending_submission,
     iree_task_post_batch_t* post_batch) {
@@ -416,16 +553,19 @@ void iree_task_executor_coordinate(iree_task_executor_t* executor,
   bool schedule_dirty = true;
   do {
     IREE_TRACE_ZONE_BEGIN_NAMED(z1, "iree_task_executor_coordinate_try");
-    // TODO(#10212): remove this lock or do something more clever to avoid
-    // contention when many workers try to coordinate at the same time. This can
-    // create very long serialized lock chains that slow down worker wakes.
-    iree_slim_mutex_lock(&executor->coordinator_mutex);
 
     // Check for incoming submissions and move their posted tasks into our
     // local lists. Any of the tasks here are ready to execute immediately and
     // ones we should be able to distribute to workers without delay. The
     // waiting tasks are to the best of the caller's knowledge not ready yet.
     //
+    // The flush atomically transfers ownership of all incoming tasks to this
+    // thread. Any number of threads may be coordinating at the same time and
+    // each will schedule its own disjoint set of tasks: there's no lock held
+    // across scheduling and idle workers never wait on each other here. If
+    // another coordinator already took the tasks we'll find the list empty and
+    // it will wake any workers it posts to.
+    //
     // Note that we only do this once per coordination; that's so we don't
     // starve if submissions come in faster than we can schedule them.
     // Coordination will run again when workers become idle and will pick up
@@ -441,7 +581,6 @@ void iree_task_executor_coordinate(iree_task_executor_t* executor,
     iree_task_submission_initialize_from_lifo_slist(
         &executor->incoming_ready_slist, &pending_submission);
     if (iree_task_list_is_empty(&pending_submission.ready_list)) {
-      iree_slim_mutex_unlock(&executor->coordinator_mutex);
       IREE_TRACE_ZONE_END(z1);
       break;
     }
@@ -465,8 +604,6 @@ void iree_task_executor_coordinate(iree_task_executor_t* executor,
     // Route waiting tasks to the poller.
     iree_task_poller_enqueue(&executor->poller,
                              &pending_submission.waiting_list);
-
-    iree_slim_mutex_unlock(&executor->coordinator_mutex);
     IREE_TRACE_ZONE_END(z1);
 
     // Post all new work to workers; they may wake and begin executing
@@ -478,17 +615,19 @@ void iree_task_executor_coordinate(iree_task_executor_t* executor,
 }
 
 static iree_task_t* iree_task_executor_try_steal_task_from_affinity_set(
-    iree_task_executor_t* executor, iree_task_affinity_set_t victim_mask,
-    uint32_t max_theft_attempts, int rotation_offset,
+    iree_task_executor_t* executor, iree_host_size_t cluster_index,
+    iree_task_affinity_set_t victim_mask, uint32_t max_theft_attempts,
+    iree_host_size_t max_theft_task_count, int rotation_offset,
     iree_task_queue_t* local_task_queue) {
   if (!victim_mask) return NULL;
   max_theft_attempts = iree_min(max_theft_attempts,
                                 iree_task_affinity_set_count_ones(victim_mask));
-  victim_mask = iree_task_affinity_set_rotr(victim_mask, rotation_offset);
 
+  const int cluster_base_index =
+      (int)(cluster_index * IREE_TASK_EXECUTOR_MAX_WORKERS_PER_CLUSTER);
   int worker_index = rotation_offset;
   iree_task_affinity_set_t mask =
-      iree_task_affinity_set_rotr(victim_mask, worker_index);
+      iree_task_affinity_set_rotr(victim_mask, rotation_offset);
   for (uint32_t i = 0; i < max_theft_attempts; ++i) {
     // Find the last set bit and skip to it. This avoids the need for doing
     // a full O(n) scan and instead gets us at O(popcnt) * O(ctz).
@@ -502,7 +641,9 @@ static iree_task_t* iree_task_executor_try_steal_task_from_affinity_set(
     //            mask >>= 1 = 0b01010101
     //            victim_index = 4 % 64 = 4
     int offset = iree_task_affinity_set_count_trailing_zeros(mask);
-    int victim_index = (worker_index + offset) % executor->worker_count;
+    int victim_index =
+        cluster_base_index + (worker_index + offset) %
+                                 IREE_TASK_EXECUTOR_MAX_WORKERS_PER_CLUSTER;
     worker_index += offset + 1;
     mask = iree_shr(mask, offset + 1);
     iree_task_worker_t* victim_worker = &executor->workers[victim_index];
@@ -517,10 +658,11 @@ static iree_task_t* iree_task_executor_try_steal_task_from_affinity_set(
     // and move the them into our local task queue. Not all tasks will be stolen
     // and the assumption is that over a large-enough random distribution of
     // thievery taking ~half of the tasks each time (across all queues) will
-    // lead to a relatively even distribution.
+    // lead to a relatively even distribution. The chunk size scales with the
+    // depth of the victim queue and is capped based on how far away the
+    // victim is.
     iree_task_t* task = iree_task_worker_try_steal_task(
-        victim_worker, local_task_queue,
-        /*max_tasks=*/IREE_TASK_EXECUTOR_MAX_THEFT_TASK_COUNT);
+        victim_worker, local_task_queue, max_theft_task_count);
     if (task) return task;
   }
 
@@ -528,6 +670,35 @@ static iree_task_t* iree_task_executor_try_steal_task_from_affinity_set(
   return NULL;
 }
 
+// Returns a mask of the workers in |cluster_index| that may have work that can
+// be stolen: the ones that are currently live and not idle.
+static iree_task_affinity_set_t iree_task_executor_query_victim_mask(
+    iree_task_executor_t* executor, iree_host_size_t cluster_index) {
+  // The masks are accessed with 'relaxed' order because they are just hints.
+  iree_task_worker_cluster_t* cluster =
+      &executor->worker_clusters[cluster_index];
+  iree_task_affinity_set_t worker_live_mask =
+      iree_atomic_task_affinity_set_load(&cluster->worker_live_mask,
+                                         iree_memory_order_relaxed);
+  iree_task_affinity_set_t worker_idle_mask =
+      iree_atomic_task_affinity_set_load(&cluster->worker_idle_mask,
+                                         iree_memory_order_relaxed);
+  return worker_live_mask & ~worker_idle_mask;
+}
+
+// Returns the maximum number of tasks to steal at a time from a victim
+// |distance| levels away in the cache hierarchy (0 = constructive sharing) by
+// a thief running at |speed_factor|.
+static iree_host_size_t iree_task_executor_max_theft_task_count(
+    int distance, uint32_t speed_factor) {
+  iree_host_size_t max_task_count =
+      IREE_TASK_EXECUTOR_MAX_THEFT_TASK_COUNT >>
+      (distance * IREE_TASK_EXECUTOR_THEFT_TASK_COUNT_DISTANCE_SHIFT);
+  max_task_count =
+      max_task_count * speed_factor / IREE_TASK_TOPOLOGY_SPEED_FACTOR_ONE;
+  return iree_max(1, max_task_count);
+}
+
 // Tries to steal an entire task from a sibling worker (based on topology).
 // Returns a task that is available (has not yet begun processing at all).
 // May steal multiple tasks and add them to the |local_task_queue|.
@@ -535,30 +706,35 @@ static iree_task_t* iree_task_executor_try_steal_task_from_affinity_set(
 // We do a scan through ideal victims indicated by the
 // |constructive_sharing_mask|; these are the workers most likely to have some
 // cache benefits to taking their work as they share some level of the cache
-// hierarchy and should be better to steal from than any random worker.
+// hierarchy and should be better to steal from than any random worker. After
+// that we widen to the |outer_sharing_mask| workers that share only an outer
+// cache level (L3) and then to everyone else.
 //
 // To prevent biasing any particular victim we use a fast prng function to
 // select where in the set of potential victims defined by the topology
 // group we steal. We (probably) don't need anything super complex here so
 // instead of bouncing around at random we just select the starting point in
 // our search and then go in-order.
+//
+// Only if nothing could be stolen from the thief's own cluster do we walk the
+// other clusters; those are likely to be further away in the cache hierarchy
+// (or on another socket entirely) and are the most expensive to steal from.
 iree_task_t* iree_task_executor_try_steal_task(
-    iree_task_executor_t* executor,
+    iree_task_executor_t* executor, iree_host_size_t cluster_index,
     iree_task_affinity_set_t constructive_sharing_mask,
-    uint32_t max_theft_attempts, iree_prng_minilcg128_state_t* theft_prng,
+    iree_task_affinity_set_t outer_sharing_mask,
+    const iree_task_affinity_set_t* theft_victim_masks,
+    uint32_t max_theft_attempts, uint32_t speed_factor,
+    iree_prng_minilcg128_state_t* theft_prng,
     iree_task_queue_t* local_task_queue) {
   IREE_TRACE_ZONE_BEGIN(z0);
 
-  // The masks are accessed with 'relaxed' order because they are just hints.
-  iree_task_affinity_set_t worker_live_mask =
-      iree_atomic_task_affinity_set_load(&executor->worker_live_mask,
-                                         iree_memory_order_relaxed);
-  iree_task_affinity_set_t worker_idle_mask =
-      iree_atomic_task_affinity_set_load(&executor->worker_idle_mask,
-                                         iree_memory_order_relaxed);
   // Limit the workers we will steal from to the ones that are currently live
-  // and not idle.
-  iree_task_affinity_set_t victim_mask = worker_live_mask & ~worker_idle_mask;
+  // and not idle and that we're allowed to steal from (usually those on the
+  // same NUMA node).
+  iree_task_affinity_set_t victim_mask =
+      iree_task_executor_query_victim_mask(executor, cluster_index) &
+      theft_victim_masks[cluster_index];
 
   // TODO(benvanik): it may be possible to rework this such that we better
   // use the prng; for example, instead of all this rotating stuff we could just
@@ -573,23 +749,200 @@ iree_task_t* iree_task_executor_try_steal_task(
   // that we won't need to go back to main memory (or higher cache tiers) in the
   // event that the thief and victim are running close to each other in time.
   iree_task_t* task = iree_task_executor_try_steal_task_from_affinity_set(
-      executor, victim_mask & constructive_sharing_mask, max_theft_attempts,
+      executor, cluster_index, victim_mask & constructive_sharing_mask,
+      max_theft_attempts,
+      iree_task_executor_max_theft_task_count(0, speed_factor),
       rotation_offset, local_task_queue);
   if (task) {
     IREE_TRACE_ZONE_APPEND_TEXT(z0, "local");
   } else {
+    // Widen to workers that share an outer cache level with us; the tasks may
+    // miss in our inner caches but will likely hit in the shared one.
+    victim_mask &= ~constructive_sharing_mask;
+    task = iree_task_executor_try_steal_task_from_affinity_set(
+        executor, cluster_index, victim_mask & outer_sharing_mask,
+        max_theft_attempts,
+        iree_task_executor_max_theft_task_count(1, speed_factor),
+        rotation_offset, local_task_queue);
+    if (task) {
+      IREE_TRACE_ZONE_APPEND_TEXT(z0, "outer");
+    }
+  }
+  if (!task) {
     task = iree_task_executor_try_steal_task_from_affinity_set(
-        executor, victim_mask & ~constructive_sharing_mask, max_theft_attempts,
+        executor, cluster_index, victim_mask & ~outer_sharing_mask,
+        max_theft_attempts,
+        iree_task_executor_max_theft_task_count(2, speed_factor),
         rotation_offset, local_task_queue);
     if (task) {
       IREE_TRACE_ZONE_APPEND_TEXT(z0, "non-local");
     }
   }
 
+  // Fall back to the other clusters, starting with the next one so that thieves
+  // in different clusters spread out.
+  for (iree_host_size_t i = 1; !task && i < executor->worker_cluster_count;
+       ++i) {
+    iree_host_size_t victim_cluster_index =
+        (cluster_index + i) % executor->worker_cluster_count;
+    task = iree_task_executor_try_steal_task_from_affinity_set(
+        executor, victim_cluster_index,
+        iree_task_executor_query_victim_mask(executor, victim_cluster_index) &
+            theft_victim_masks[victim_cluster_index],
+        max_theft_attempts,
+        iree_task_executor_max_theft_task_count(3, speed_factor),
+        rotation_offset, local_task_queue);
+    if (task) {
+      IREE_TRACE_ZONE_APPEND_TEXT(z0, "remote");
+    }
+  }
+
   IREE_TRACE_ZONE_END(z0);
   return task;
 }
 
+// Grows the local memory of the donated thread such that at least
+// |minimum_size| bytes are available. Mirrors the on-demand growth of worker
+// local memory; on failure the dispatch requiring it reports the exhaustion.
+static void iree_task_executor_grow_donor_local_memory(
+    iree_task_executor_t* executor, iree_host_size_t minimum_size) {
+  if (IREE_LIKELY(minimum_size <=
+                  executor->donor_local_memory_span.data_length)) {
+    return;
+  }
+  if (minimum_size > executor->donor_local_memory_limit) return;
+  iree_host_size_t new_size = iree_min(
+      (iree_host_size_t)iree_math_round_up_to_pow2_u64(minimum_size),
+      executor->donor_local_memory_limit);
+  new_size = iree_host_align(new_size,
+                             IREE_TASK_EXECUTOR_WORKER_LOCAL_MEMORY_ALIGNMENT);
+  void* new_local_memory = NULL;
+  iree_status_t status = iree_allocator_malloc_aligned(
+      executor->allocator, new_size,
+      IREE_TASK_EXECUTOR_WORKER_LOCAL_MEMORY_ALIGNMENT, /*offset=*/0,
+      &new_local_memory);
+  if (iree_status_is_ok(status)) {
+    if (executor->donor_local_memory) {
+      iree_allocator_free_aligned(executor->allocator,
+                                  executor->donor_local_memory);
+    }
+    executor->donor_local_memory = new_local_memory;
+    executor->donor_local_memory_span =
+        iree_make_byte_span(new_local_memory, new_size);
+  } else {
+    iree_status_ignore(status);
+  }
+}
+
+// Steals a single ready task from any running worker, nearest clusters first.
+// Unlike worker theft idle workers are included: tasks posted to a worker that
+// has not yet woken are exactly the ones the donated thread can start on.
+static iree_task_t* iree_task_executor_try_steal_task_for_donor(
+    iree_task_executor_t* executor, iree_task_queue_t* donor_task_queue) {
+  int rotation_offset =
+      iree_prng_minilcg128_next_uint8(&executor->donation_theft_prng);
+  for (iree_host_size_t i = 0; i < executor->worker_count; ++i) {
+    iree_task_worker_t* victim_worker =
+        &executor->workers[(rotation_offset + i) % executor->worker_count];
+    if (iree_atomic_load_int32(&victim_worker->state,
+                               iree_memory_order_acquire) !=
+        IREE_TASK_WORKER_STATE_RUNNING) {
+      continue;
+    }
+    iree_task_t* task = iree_task_worker_try_steal_task(
+        victim_worker, donor_task_queue, /*max_tasks=*/1);
+    if (task) return task;
+  }
+  return NULL;
+}
+
+// Executes |task| stolen by the donated thread.
+static void iree_task_executor_donor_execute(
+    iree_task_executor_t* executor, iree_task_t* task,
+    iree_fpu_state_t* fpu_state, iree_task_submission_t* pending_submission) {
+  switch (task->type) {
+    case IREE_TASK_TYPE_CALL: {
+      iree_task_call_execute((iree_task_call_t*)task, pending_submission);
+      break;
+    }
+    case IREE_TASK_TYPE_DISPATCH_SHARD: {
+      iree_task_executor_grow_donor_local_memory(
+          executor, iree_task_dispatch_shard_local_memory_size(
+                        (iree_task_dispatch_shard_t*)task));
+      // The donor never yields (there is no mailbox to yield to) so the shard
+      // always retires.
+      iree_task_dispatch_shard_execute(
+          (iree_task_dispatch_shard_t*)task, iree_cpu_query_processor_id(),
+          (uint32_t)(executor->worker_base_index + executor->worker_count),
+          IREE_TASK_TOPOLOGY_SPEED_FACTOR_ONE,
+          executor->donor_local_memory_span, fpu_state,
+          /*yield_priority_mask=*/NULL, pending_submission);
+      break;
+    }
+    default:
+      IREE_ASSERT_UNREACHABLE("incorrect task type for donor execution");
+      break;
+  }
+}
+
+// Executes tasks stolen from workers until |wait_source| resolves or
+// |deadline_ns| elapses.
+static iree_status_t iree_task_executor_donate_until(
+    iree_task_executor_t* executor, iree_wait_source_t wait_source,
+    iree_time_t deadline_ns) {
+  iree_task_queue_t donor_task_queue;
+  iree_task_queue_initialize(&donor_task_queue);
+  // Run stolen tasks with the same FPU state workers start with and restore
+  // the caller's state once done donating.
+  iree_fpu_state_t fpu_state =
+      iree_fpu_state_push(IREE_FPU_STATE_FLAG_FLUSH_DENORMALS_TO_ZERO);
+  iree_status_t status = iree_ok_status();
+  while (true) {
+    iree_status_code_t wait_status_code = IREE_STATUS_OK;
+    status = iree_wait_source_query(wait_source, &wait_status_code);
+    if (!iree_status_is_ok(status)) break;
+    if (wait_status_code != IREE_STATUS_DEFERRED) {
+      status = iree_status_from_code(wait_status_code);
+      break;
+    }
+
+    iree_task_t* task = iree_task_executor_try_steal_task_for_donor(
+        executor, &donor_task_queue);
+    if (task) {
+      iree_task_submission_t pending_submission;
+      iree_task_submission_initialize(&pending_submission);
+      iree_task_executor_donor_execute(executor, task, &fpu_state,
+                                       &pending_submission);
+      if (!iree_task_submission_is_empty(&pending_submission)) {
+        iree_task_executor_merge_submission(executor, &pending_submission);
+        iree_task_executor_flush(executor);
+      }
+      continue;
+    }
+
+    // Nothing to steal: block for a bit and then look again as completing
+    // tasks may have readied more.
+    if (iree_time_now() >= deadline_ns) {
+      status = iree_status_from_code(IREE_STATUS_DEADLINE_EXCEEDED);
+      break;
+    }
+    iree_time_t slice_deadline_ns =
+        iree_min(deadline_ns,
+                 iree_time_now() + IREE_TASK_EXECUTOR_DONATION_WAIT_SLICE_NS);
+    status = iree_wait_source_wait_one(wait_source,
+                                       iree_make_deadline(slice_deadline_ns));
+    if (iree_status_is_deadline_exceeded(status)) {
+      iree_status_ignore(status);
+      status = iree_ok_status();
+      continue;
+    }
+    break;
+  }
+  iree_fpu_state_pop(fpu_state);
+  iree_task_queue_deinitialize(&donor_task_queue);
+  return status;
+}
+
 iree_status_t iree_task_executor_donate_caller(iree_task_executor_t* executor,
                                                iree_wait_source_t wait_source,
                                                iree_timeout_t timeout) {
@@ -598,12 +951,21 @@ iree_status_t iree_task_executor_donate_caller(iree_task_executor_t* executor,
   // Perform an immediate flush/coordination (in case the caller queued).
   iree_task_executor_flush(executor);
 
-  // Wait until completed.
-  // TODO(benvanik): make this steal tasks until wait_handle resolves?
-  // Somewhat dangerous as we don't know what kind of thread we are running on;
-  // it may have a smaller stack than we are expecting or have some weird thread
-  // local state (FPU rounding modes/etc).
-  iree_status_t status = iree_wait_source_wait_one(wait_source, timeout);
+  // Only one caller may execute tasks at a time; any others wait as usual.
+  iree_time_t deadline_ns = iree_timeout_as_deadline_ns(timeout);
+  int32_t expected = 0;
+  iree_status_t status = iree_ok_status();
+  if (iree_atomic_compare_exchange_strong_int32(
+          &executor->donor_active, &expected, 1, iree_memory_order_acquire,
+          iree_memory_order_relaxed)) {
+    status =
+        iree_task_executor_donate_until(executor, wait_source, deadline_ns);
+    iree_atomic_store_int32(&executor->donor_active, 0,
+                            iree_memory_order_release);
+  } else {
+    status = iree_wait_source_wait_one(wait_source,
+                                       iree_make_deadline(deadline_ns));
+  }
 
   IREE_TRACE_ZONE_END(z0);
   return status;
@@ -120,7 +120,9 @@ extern "C" {
 //
 //   a. Tasks are flushed from the incoming_ready_slist into a coordinator-local
 //      FIFO task queue. This centralizes enqueuing from all threads into a
-//      single ordered list.
+//      single ordered list. The flush atomically hands ownership of all
+//      flushed tasks to the coordinator and any number of threads may be
+//      coordinating at the same time, each with its own disjoint set of tasks.
 //
 //   b. iree_task_executor_schedule_ready_tasks: walks the FIFO task queue and
 //      builds a iree_task_post_batch_t containing the per-worker tasks
@@ -151,8 +153,9 @@ extern "C" {
 //       the coordinator hat with iree_task_executor_coordinate. If new work
 //       becomes available after coordination step 5 repeats.
 //
-//    e. If another worker (or iree_task_executor_flush) is already wearing the
-//       coordinator hat then the worker will go to sleep.
+//    e. If another worker (or iree_task_executor_flush) has already taken all
+//       of the incoming tasks then the worker will go to sleep and be woken
+//       when that coordinator posts work to it.
 //
 //==============================================================================
 // Scaling Down
@@ -220,9 +223,11 @@ extern "C" {
 // Scaling Up
 //==============================================================================
 //
-// The task system has an implicit limit of 64 workers. This intentional
-// limitation simplifies several parts of the code while also preventing misuse:
-// it rarely (if ever) makes sense to have more than 64 compute-dominated
+// The task system tracks workers in clusters of 64 and supports up to
+// IREE_TASK_EXECUTOR_MAX_WORKER_COUNT workers. Workers prefer to exchange work
+// with others in their own cluster and only steal from workers on the same NUMA
+// node unless IREE_TASK_SCHEDULING_MODE_ALLOW_REMOTE_NODE_THEFT is set. Even
+// so it rarely (if ever) makes sense to have more than 64 compute-dominated
 // threads working on a single problem. Achieving high performance in such
 // situations requires extremely careful control over the OS scheduler, memory
 // bandwidth consumption, and synchronization. It's always possible to make the
@@ -265,6 +270,32 @@ enum iree_task_scheduling_mode_bits_t {
   // reach peak utilization or artificially limiting which tasks we allow
   // through to keep certain CPU cores asleep unless absolutely required.
   IREE_TASK_SCHEDULING_MODE_RESERVED = 0u,
+
+  // Allows workers to steal tasks from workers on other NUMA nodes.
+  // By default workers only steal from others on the same node as remote
+  // thefts will often access memory attached to another socket for the
+  // remainder of the task and may be slower than waiting for local work.
+  IREE_TASK_SCHEDULING_MODE_ALLOW_REMOTE_NODE_THEFT = 1u << 0,
+
+  // Prioritizes latency of higher priority tasks over total throughput.
+  // Workers always pick the highest priority ready task available to them but
+  // by default (throughput mode) a dispatch shard that has begun processing
+  // runs until the dispatch has no tiles remaining. With this mode set a shard
+  // will yield back to its worker between tile reservations when tasks of a
+  // higher priority are posted to the worker and resume once they complete.
+  // This bounds the latency of high priority work to roughly the duration of
+  // one reservation of tiles at the cost of additional scheduling overhead and
+  // reduced cache locality in the preempted dispatches.
+  IREE_TASK_SCHEDULING_MODE_PRIORITIZE_LATENCY = 1u << 1,
+
+  // Workers adapt how long they spin waiting for new work before parking in
+  // the kernel based on the observed time between running out of work and
+  // receiving more. Workers that are usually fed again quickly (such as when
+  // executing back-to-back small dispatches) spin for a bit longer than the
+  // typical gap with an exponential backoff while workers that usually idle
+  // for longer than the spin window park immediately. The worker_spin_ns
+  // option bounds the spin window and if zero a default bound is used.
+  IREE_TASK_SCHEDULING_MODE_ADAPTIVE_WORKER_SPIN = 1u << 2,
 };
 typedef uint32_t iree_task_scheduling_mode_t;
 
@@ -286,14 +317,27 @@ typedef struct iree_task_executor_options_t {
   // spinning is often extremely harmful to system health. Only set to non-zero
   // values when latency is the #1 priority (over thermals, system-wide
   // scheduling, and the environment).
+  //
+  // With IREE_TASK_SCHEDULING_MODE_ADAPTIVE_WORKER_SPIN this is instead the
+  // upper bound of the spin window each worker tunes for itself.
   iree_duration_t worker_spin_ns;
 
   // Defines the bytes to be allocated and reserved by each worker to use for
   // local memory operations. Will be rounded up to the next power of two.
   // Dispatches performed will be able to request up to this amount of memory
-  // for their invocations and no more. May be 0 if no worker local memory is
-  // required.
+  // for their invocations (or up to worker_local_memory_limit if specified).
+  // May be 0 if no worker local memory is required. Where supported the memory
+  // for each worker is allocated from the NUMA node the worker runs on.
   iree_host_size_t worker_local_memory_size;
+
+  // Maximum bytes of local memory each worker may grow to when a dispatch
+  // requests more than worker_local_memory_size. Workers allocate the larger
+  // memory on demand the first time a dispatch needs it and retain it at its
+  // high-water size for all future dispatches so that kernels with large
+  // temporary buffers don't need to allocate them per dispatch. May be 0 to
+  // disallow growth such that dispatches requesting more than
+  // worker_local_memory_size fail.
+  iree_host_size_t worker_local_memory_limit;
 } iree_task_executor_options_t;
 
 // Initializes |out_options| to default values.
@@ -313,6 +357,24 @@ iree_status_t iree_task_executor_create(iree_task_executor_options_t options,
                                         iree_allocator_t allocator,
                                         iree_task_executor_t** out_executor);
 
+// Returns the process-wide shared task executor in |out_executor|, creating it
+// with |options| and |topology| if no shared executor is currently alive.
+// When an executor is already shared the |options| and |topology| are ignored
+// and the existing executor is retained for the caller.
+//
+// Sharing one executor between all users in a process (such as multiple HAL
+// devices each running their own models) avoids oversubscribing the cores
+// with one set of workers per user. Each user should still submit through its
+// own iree_task_scope_t so that failures and idle waits remain isolated and
+// scope priorities can be used to weight users against each other.
+//
+// The shared executor is destroyed when the last user releases it and a new
+// one will be created by the next call.
+// |out_executor| must be released by the caller.
+iree_status_t iree_task_executor_acquire_shared(
+    iree_task_executor_options_t options, const iree_task_topology_t* topology,
+    iree_allocator_t allocator, iree_task_executor_t** out_executor);
+
 // Retains the given |executor| for the caller.
 void iree_task_executor_retain(iree_task_executor_t* executor);
 
@@ -327,6 +389,12 @@ void iree_task_executor_trim(iree_task_executor_t* executor);
 iree_host_size_t iree_task_executor_worker_count(
     iree_task_executor_t* executor);
 
+// Returns the NUMA node all workers of the executor run on or
+// IREE_TASK_TOPOLOGY_NODE_ID_ANY if they span multiple nodes. Memory primarily
+// accessed by the executor can be placed on this node.
+iree_task_topology_node_id_t iree_task_executor_node_id(
+    iree_task_executor_t* executor);
+
 // Returns an iree_event_t pool managed by the executor.
 // Users of the task system should acquire their transient events from this.
 // Long-lived events should be allocated on their own in order to avoid
@@ -393,6 +461,12 @@ void iree_task_executor_flush(iree_task_executor_t* executor);
 // Especially in large applications it's almost certainly better to do something
 // useful with the calling thread (even if that's go to sleep).
 //
+// Only one thread is donated at a time and it executes dispatch tiles as
+// worker index `worker_base_index + iree_task_executor_worker_count`, so any
+// per-worker storage indexed by the tile context worker_id needs one more slot
+// than there are workers. Concurrent callers wait on |wait_source| without
+// executing tasks.
+//
 // Safe to call from any thread (though bad to reentrantly call from workers).
 iree_status_t iree_task_executor_donate_caller(iree_task_executor_t* executor,
                                                iree_wait_source_t wait_source,
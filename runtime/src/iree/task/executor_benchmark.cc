@@ -0,0 +1,333 @@
+// Copyright 2023 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+// Benchmarks of the task system scheduler: the latency from submitting work to
+// it executing, the throughput of dispatch tiles, the time to wake parked
+// workers and how work spreads and scales across workers.
+//
+// Most benchmarks take the worker count as their first argument and run from
+// one worker up to the number of hardware threads. Comparing the results
+// across worker counts shows the scaling of the executor.
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <thread>
+#include <vector>
+
+#include "benchmark/benchmark.h"
+#include "iree/base/api.h"
+#include "iree/base/internal/prng.h"
+#include "iree/task/executor.h"
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+//==============================================================================
+// Utilities
+//==============================================================================
+
+// Emulates |iterations| steps of compute-bound work.
+static uint64_t SimulateWork(uint64_t seed, int iterations) {
+  iree_prng_splitmix64_state_t state;
+  iree_prng_splitmix64_initialize(seed, &state);
+  uint64_t value = 0;
+  for (int i = 0; i < iterations; ++i) {
+    value ^= iree_prng_splitmix64_next(&state);
+  }
+  return value;
+}
+
+// Registers the benchmark for worker counts from 1 up to the hardware thread
+// count in powers of two, each paired with every value in |other_args|.
+static void ApplyWorkerCounts(benchmark::internal::Benchmark* benchmark,
+                              const std::vector<int64_t>& other_args = {}) {
+  int max_worker_count = std::min<int>(
+      std::max(1u, std::thread::hardware_concurrency()),
+      IREE_TASK_EXECUTOR_MAX_WORKER_COUNT);
+  std::vector<int> worker_counts;
+  for (int worker_count = 1; worker_count < max_worker_count;
+       worker_count *= 2) {
+    worker_counts.push_back(worker_count);
+  }
+  worker_counts.push_back(max_worker_count);
+  for (int worker_count : worker_counts) {
+    if (other_args.empty()) {
+      benchmark->Args({worker_count});
+    }
+    for (int64_t other_arg : other_args) {
+      benchmark->Args({worker_count, other_arg});
+    }
+  }
+}
+
+// An executor with a fixed number of workers and a scope to submit work into.
+class BenchmarkExecutor {
+ public:
+  explicit BenchmarkExecutor(int worker_count,
+                             iree_duration_t worker_spin_ns = 0) {
+    iree_task_executor_options_t options;
+    iree_task_executor_options_initialize(&options);
+    options.worker_spin_ns = worker_spin_ns;
+    iree_task_topology_t topology;
+    iree_task_topology_initialize_from_group_count(worker_count, &topology);
+    IREE_CHECK_OK(iree_task_executor_create(
+        options, &topology, iree_allocator_system(), &executor_));
+    iree_task_topology_deinitialize(&topology);
+    iree_task_scope_initialize(iree_make_cstring_view("benchmark"), &scope_);
+  }
+
+  ~BenchmarkExecutor() {
+    iree_task_scope_deinitialize(&scope_);
+    iree_task_executor_release(executor_);
+  }
+
+  iree_task_scope_t* scope() { return &scope_; }
+
+  // Submits |submission| with a fence after |tail_task| and waits for the
+  // scope to go idle.
+  void SubmitAndWaitIdle(iree_task_submission_t* submission,
+                         iree_task_t* tail_task) {
+    iree_task_fence_t* fence = NULL;
+    IREE_CHECK_OK(iree_task_executor_acquire_fence(executor_, &scope_, &fence));
+    iree_task_set_completion_task(tail_task, &fence->header);
+    iree_task_executor_submit(executor_, submission);
+    iree_task_executor_flush(executor_);
+    IREE_CHECK_OK(
+        iree_task_scope_wait_idle(&scope_, IREE_TIME_INFINITE_FUTURE));
+  }
+
+  // Submits the single task |task| and waits for it to complete.
+  void SubmitAndWaitIdle(iree_task_t* task) {
+    iree_task_submission_t submission;
+    iree_task_submission_initialize(&submission);
+    iree_task_submission_enqueue(&submission, task);
+    SubmitAndWaitIdle(&submission, task);
+  }
+
+ private:
+  iree_task_executor_t* executor_ = NULL;
+  iree_task_scope_t scope_;
+};
+
+// Records the time the call task it is passed to starts executing.
+static iree_status_t RecordStartTime(
+    void* user_context, iree_task_t* task,
+    iree_task_submission_t* pending_submission) {
+  *reinterpret_cast<Clock::time_point*>(user_context) = Clock::now();
+  return iree_ok_status();
+}
+
+//==============================================================================
+// Submit->execute latency
+//==============================================================================
+
+// Round trip of a single empty call task through a warm executor: submission,
+// execution, retirement and the caller being woken.
+// Args: worker count.
+void BM_SubmitLatency(benchmark::State& state) {
+  BenchmarkExecutor executor(state.range(0));
+  Clock::time_point start_time;
+  double submit_to_execute_ns = 0.0;
+  for (auto _ : state) {
+    iree_task_call_t call;
+    iree_task_call_initialize(
+        executor.scope(),
+        iree_task_make_call_closure(RecordStartTime, &start_time), &call);
+    Clock::time_point submit_time = Clock::now();
+    executor.SubmitAndWaitIdle(&call.header);
+    submit_to_execute_ns +=
+        std::chrono::duration<double, std::nano>(start_time - submit_time)
+            .count();
+  }
+  state.counters["submit_to_execute_ns"] = benchmark::Counter(
+      submit_to_execute_ns, benchmark::Counter::kAvgIterations);
+}
+BENCHMARK(BM_SubmitLatency)
+    ->Apply([](benchmark::internal::Benchmark* b) { ApplyWorkerCounts(b); })
+    ->UseRealTime();
+
+//==============================================================================
+// Wake-up latency
+//==============================================================================
+
+// Time from submitting a call task to an idle executor until it starts
+// executing. The executor is left idle long enough between iterations for the
+// workers to park (or to exhaust their spin window) so this measures waking
+// them up.
+// Args: worker count, worker spin in microseconds.
+void BM_WakeLatency(benchmark::State& state) {
+  BenchmarkExecutor executor(state.range(0), state.range(1) * 1000);
+  Clock::time_point start_time;
+  for (auto _ : state) {
+    std::this_thread::sleep_for(std::chrono::microseconds(state.range(1)) +
+                                std::chrono::milliseconds(2));
+    iree_task_call_t call;
+    iree_task_call_initialize(
+        executor.scope(),
+        iree_task_make_call_closure(RecordStartTime, &start_time), &call);
+    Clock::time_point submit_time = Clock::now();
+    executor.SubmitAndWaitIdle(&call.header);
+    state.SetIterationTime(
+        std::chrono::duration<double>(start_time - submit_time).count());
+  }
+}
+BENCHMARK(BM_WakeLatency)
+    ->Apply([](benchmark::internal::Benchmark* b) {
+      ApplyWorkerCounts(b, {0, 100});
+    })
+    ->UseManualTime()
+    ->Iterations(100);
+
+//==============================================================================
+// Dispatch throughput
+//==============================================================================
+
+// Dispatches empty tiles to measure the per-tile and per-shard overheads of
+// the dispatch machinery as the tile count grows.
+// Args: worker count, tile count.
+void BM_DispatchThroughput(benchmark::State& state) {
+  BenchmarkExecutor executor(state.range(0));
+  const uint32_t workgroup_size[3] = {1, 1, 1};
+  const uint32_t workgroup_count[3] = {static_cast<uint32_t>(state.range(1)),
+                                       1, 1};
+  for (auto _ : state) {
+    iree_task_dispatch_t dispatch;
+    iree_task_dispatch_initialize(
+        executor.scope(),
+        iree_task_make_dispatch_closure(
+            [](void* user_context, const iree_task_tile_context_t* tile_context,
+               iree_task_submission_t* pending_submission) {
+              benchmark::DoNotOptimize(tile_context->workgroup_xyz[0]);
+              return iree_ok_status();
+            },
+            NULL),
+        workgroup_size, workgroup_count, &dispatch);
+    executor.SubmitAndWaitIdle(&dispatch.header);
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(1));
+}
+BENCHMARK(BM_DispatchThroughput)
+    ->Apply([](benchmark::internal::Benchmark* b) {
+      ApplyWorkerCounts(b, {1, 16, 256, 4096, 65536});
+    })
+    ->UseRealTime();
+
+//==============================================================================
+// Worker scaling
+//==============================================================================
+
+// A dispatch with a fixed amount of compute-bound work split into tiles. With
+// perfect scaling the time halves each time the worker count doubles.
+// Args: worker count.
+void BM_DispatchScaling(benchmark::State& state) {
+  BenchmarkExecutor executor(state.range(0));
+  const uint32_t workgroup_size[3] = {1, 1, 1};
+  const uint32_t workgroup_count[3] = {1024, 1, 1};
+  for (auto _ : state) {
+    iree_task_dispatch_t dispatch;
+    iree_task_dispatch_initialize(
+        executor.scope(),
+        iree_task_make_dispatch_closure(
+            [](void* user_context, const iree_task_tile_context_t* tile_context,
+               iree_task_submission_t* pending_submission) {
+              benchmark::DoNotOptimize(
+                  SimulateWork(tile_context->workgroup_xyz[0], 16 * 1024));
+              return iree_ok_status();
+            },
+            NULL),
+        workgroup_size, workgroup_count, &dispatch);
+    executor.SubmitAndWaitIdle(&dispatch.header);
+  }
+  state.SetItemsProcessed(state.iterations() * workgroup_count[0]);
+}
+BENCHMARK(BM_DispatchScaling)
+    ->Apply([](benchmark::internal::Benchmark* b) { ApplyWorkerCounts(b); })
+    ->UseRealTime()
+    ->Unit(benchmark::kMicrosecond);
+
+//==============================================================================
+// Work distribution
+//==============================================================================
+
+struct FanoutTask {
+  iree_task_call_t call;
+  std::thread::id thread_id;
+};
+
+// Submits many independent call tasks at once and reports how they were
+// spread across the workers. Tasks are posted to workers by the coordinator
+// and rebalanced by stealing so `workers_used` and `max_worker_share` (the
+// fraction of tasks run by the busiest worker, from the final iteration) show
+// how well the load spreads.
+// Args: worker count.
+void BM_CallFanout(benchmark::State& state) {
+  BenchmarkExecutor executor(state.range(0));
+  std::vector<FanoutTask> tasks(256);
+  for (auto _ : state) {
+    iree_task_barrier_t barrier;
+    std::vector<iree_task_t*> barrier_tasks(tasks.size());
+    for (size_t i = 0; i < tasks.size(); ++i) {
+      iree_task_call_initialize(
+          executor.scope(),
+          iree_task_make_call_closure(
+              [](void* user_context, iree_task_t* task,
+                 iree_task_submission_t* pending_submission) {
+                auto* fanout_task = reinterpret_cast<FanoutTask*>(user_context);
+                fanout_task->thread_id = std::this_thread::get_id();
+                benchmark::DoNotOptimize(SimulateWork(0, 4 * 1024));
+                return iree_ok_status();
+              },
+              &tasks[i]),
+          &tasks[i].call);
+      barrier_tasks[i] = &tasks[i].call.header;
+    }
+    iree_task_barrier_initialize(executor.scope(), barrier_tasks.size(),
+                                 barrier_tasks.data(), &barrier);
+    iree_task_call_t tail;
+    iree_task_call_initialize(
+        executor.scope(),
+        iree_task_make_call_closure(
+            [](void* user_context, iree_task_t* task,
+               iree_task_submission_t* pending_submission) {
+              return iree_ok_status();
+            },
+            NULL),
+        &tail);
+    for (FanoutTask& task : tasks) {
+      iree_task_set_completion_task(&task.call.header, &tail.header);
+    }
+    iree_task_submission_t submission;
+    iree_task_submission_initialize(&submission);
+    iree_task_submission_enqueue(&submission, &barrier.header);
+    executor.SubmitAndWaitIdle(&submission, &tail.header);
+  }
+  state.SetItemsProcessed(state.iterations() * tasks.size());
+
+  std::vector<std::thread::id> thread_ids;
+  for (const FanoutTask& task : tasks) thread_ids.push_back(task.thread_id);
+  std::sort(thread_ids.begin(), thread_ids.end());
+  size_t workers_used = 0;
+  size_t max_tasks_per_worker = 0;
+  for (auto it = thread_ids.begin(); it != thread_ids.end();) {
+    auto next = std::upper_bound(it, thread_ids.end(), *it);
+    ++workers_used;
+    max_tasks_per_worker =
+        std::max<size_t>(max_tasks_per_worker, std::distance(it, next));
+    it = next;
+  }
+  state.counters["workers_used"] = workers_used;
+  state.counters["max_worker_share"] =
+      static_cast<double>(max_tasks_per_worker) / tasks.size();
+}
+BENCHMARK(BM_CallFanout)
+    ->Apply([](benchmark::internal::Benchmark* b) { ApplyWorkerCounts(b); })
+    ->UseRealTime()
+    ->Unit(benchmark::kMicrosecond);
+
+}  // namespace
@@ -26,6 +26,33 @@
 extern "C" {
 #endif  // __cplusplus
 
+// State shared by a cluster of consecutive workers within an executor.
+// Each cluster tracks its workers in affinity sets where bit N corresponds to
+// worker (cluster_index * IREE_TASK_EXECUTOR_MAX_WORKERS_PER_CLUSTER + N).
+typedef struct iree_task_worker_cluster_t {
+  // A bitset indicating which workers are likely to be live and usable; all
+  // attempts to push work onto a particular worker should check first with this
+  // mask. This may change over time either automatically or by user request
+  // ("don't use these cores for awhile I'm going to be using them" etc).
+  //
+  // This mask is just a hint, accessed with memory_order_relaxed. Readers must
+  // be OK with getting slightly out-of-date information. The only way to get
+  // an authoritative answer to the question "is this worker live" is to
+  // atomically query worker->state. This mask is for usage patterns where one
+  // needs a cheap (single relaxed atomic op) approximation of all N workers'
+  // live state without having to perform N expensive atomic ops.
+  iree_atomic_task_affinity_set_t worker_live_mask;
+
+  // A bitset indicating which workers are currently idle. Used to bias incoming
+  // tasks to workers that aren't doing much else. This is a balance of latency
+  // to wake the idle workers vs. latency to wait for existing work to complete
+  // on already woken workers.
+  //
+  // This mask is just a hint, accessed with memory_order_relaxed. See the
+  // comment on worker_live_mask.
+  iree_atomic_task_affinity_set_t worker_idle_mask;
+} iree_task_worker_cluster_t;
+
 struct iree_task_executor_t {
   iree_atomic_ref_count_t ref_count;
   iree_allocator_t allocator;
@@ -46,6 +73,18 @@ struct iree_task_executor_t {
   // extra layer of PRNG anyway ;)
   iree_prng_minilcg128_state_t donation_theft_prng;
 
+  // Set while a thread is donated to the executor. Only one caller donates at
+  // a time as it executes tasks with the reserved worker index
+  // worker_base_index + worker_count; other callers just wait.
+  iree_atomic_int32_t donor_active;
+
+  // Local memory used by dispatch shards executed on the donated thread.
+  // Allocated on first use up to |donor_local_memory_limit| bytes and only
+  // accessed by the active donor.
+  void* donor_local_memory;
+  iree_byte_span_t donor_local_memory_span;
+  iree_host_size_t donor_local_memory_limit;
+
   // Pools of transient dispatch tasks shared across all workers.
   // Depending on configuration the task pool may allocate after creation using
   // the allocator provided upon executor creation.
@@ -79,10 +118,6 @@ struct iree_task_executor_t {
   // them.
   iree_event_pool_t* event_pool;
 
-  // Guards coordination logic; only one thread at a time may be acting as the
-  // coordinator.
-  iree_slim_mutex_t coordinator_mutex;
-
   // Wait task polling and wait thread manager.
   // This handles all system waits so that we can keep the syscalls off the
   // worker threads and lower wake latencies (the wait thread can enqueue
@@ -90,27 +125,11 @@ struct iree_task_executor_t {
   // existing computation on the workers to finish).
   iree_task_poller_t poller;
 
-  // A bitset indicating which workers are likely to be live and usable; all
-  // attempts to push work onto a particular worker should check first with this
-  // mask. This may change over time either automatically or by user request
-  // ("don't use these cores for awhile I'm going to be using them" etc).
-  //
-  // This mask is just a hint, accessed with memory_order_relaxed. Readers must
-  // be OK with getting slightly out-of-date information. The only way to get
-  // an authoritative answer to the question "is this worker live" is to
-  // atomically query worker->state. This mask is for usage patterns where one
-  // needs a cheap (single relaxed atomic op) approximation of all N workers'
-  // live state without having to perform N expensive atomic ops.
-  iree_atomic_task_affinity_set_t worker_live_mask;
-
-  // A bitset indicating which workers are currently idle. Used to bias incoming
-  // tasks to workers that aren't doing much else. This is a balance of latency
-  // to wake the idle workers vs. latency to wait for existing work to complete
-  // on already woken workers.
-  //
-  // This mask is just a hint, accessed with memory_order_relaxed. See the
-  // comment on worker_live_mask.
-  iree_atomic_task_affinity_set_t worker_idle_mask;
+  // Clusters of up to IREE_TASK_EXECUTOR_MAX_WORKERS_PER_CLUSTER workers.
+  // Worker i belongs to cluster i / IREE_TASK_EXECUTOR_MAX_WORKERS_PER_CLUSTER.
+  // Most executors have a single cluster.
+  iree_host_size_t worker_cluster_count;
+  iree_task_worker_cluster_t* worker_clusters;  // [worker_cluster_count]
 
   // Base value added to each executor-local worker index.
   // This allows workers to uniquely identify themselves in multi-executor
@@ -122,6 +141,22 @@ struct iree_task_executor_t {
   // live join/leave behavior we could change this to a registration mechanism.
   iree_host_size_t worker_count;
   iree_task_worker_t* workers;  // [worker_count]
+
+  // NUMA node all workers are placed on or IREE_TASK_TOPOLOGY_NODE_ID_ANY if
+  // the workers span multiple nodes.
+  iree_task_topology_node_id_t node_id;
+
+  // Storage for the local memory of all workers. Allocated separately from the
+  // executor and not touched until each worker starts so that pages are placed
+  // on the NUMA node of the worker that uses them.
+  void* worker_local_memory;
+  // Maximum size in bytes each worker's local memory may grow to on demand.
+  iree_host_size_t worker_local_memory_limit;
+
+  // True if this executor is the process-wide shared executor returned from
+  // iree_task_executor_acquire_shared. The shared slot only holds a weak
+  // reference and is cleared when the last user releases the executor.
+  bool is_shared;
 };
 
 // Merges a submission into the primary FIFO queues.
@@ -133,7 +168,7 @@ void iree_task_executor_merge_submission(iree_task_executor_t* executor,
                                          iree_task_submission_t* submission);
 
 // Schedules all ready tasks in the |pending_submission| list.
-// Only called during coordination and expects the coordinator lock to be held.
+// Only called during coordination by the thread owning |pending_submission|.
 void iree_task_executor_schedule_ready_tasks(
     iree_task_executor_t* executor, iree_task_submission_t* pending_submission,
     iree_task_post_batch_t* post_batch);
@@ -153,10 +188,24 @@ void iree_task_executor_coordinate(iree_task_executor_t* executor,
 // Tries to steal an entire task from a sibling worker (based on topology).
 // Returns a task that is available (has not yet begun processing at all).
 // May steal multiple tasks and add them to the |local_task_queue|.
+//
+// Victims are tried from nearest to furthest in the cache hierarchy: those in
+// the thief's cluster-local |constructive_sharing_mask|, then those in its
+// |outer_sharing_mask|, then the rest of the thief's |cluster_index| and
+// finally other clusters. Fewer tasks are stolen at a time from more distant
+// victims. Only workers set in the per-cluster |theft_victim_masks| are
+// considered.
+//
+// |speed_factor| is the relative speed of the thief (in units of
+// IREE_TASK_TOPOLOGY_SPEED_FACTOR_ONE); slower thieves steal fewer tasks at a
+// time so that they don't take more work than they can finish promptly.
 iree_task_t* iree_task_executor_try_steal_task(
-    iree_task_executor_t* executor,
+    iree_task_executor_t* executor, iree_host_size_t cluster_index,
     iree_task_affinity_set_t constructive_sharing_mask,
-    uint32_t max_theft_attempts, iree_prng_minilcg128_state_t* theft_prng,
+    iree_task_affinity_set_t outer_sharing_mask,
+    const iree_task_affinity_set_t* theft_victim_masks,
+    uint32_t max_theft_attempts, uint32_t speed_factor,
+    iree_prng_minilcg128_state_t* theft_prng,
     iree_task_queue_t* local_task_queue);
 
 #ifdef __cplusplus
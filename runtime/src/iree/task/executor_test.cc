@@ -6,13 +6,23 @@
 
 #include "iree/task/executor.h"
 
+#include <atomic>
+#include <chrono>
 #include <cstddef>
+#include <cstring>
+#include <thread>
+#include <vector>
 
+#include "iree/base/internal/wait_handle.h"
 #include "iree/testing/gtest.h"
 #include "iree/testing/status_matchers.h"
 
 namespace {
 
+using iree::Status;
+using iree::StatusCode;
+using iree::testing::status::StatusIs;
+
 // Tests that an executor can be created and destroyed repeatedly without
 // running out of system resources. Since all systems are different there's no
 // guarantee this will fail but it does give ASAN/TSAN some nice stuff to chew
@@ -35,6 +45,55 @@ TEST(ExecutorTest, Lifetime) {
   iree_task_topology_deinitialize(&topology);
 }
 
+// Tests that the shared executor is reused while any user holds it and is
+// recreated once the last user releases it, including when users race.
+TEST(ExecutorTest, SharedExecutor) {
+  iree_task_executor_options_t options;
+  iree_task_executor_options_initialize(&options);
+  iree_task_topology_t topology;
+  iree_task_topology_initialize_from_group_count(/*group_count=*/2, &topology);
+
+  iree_task_executor_t* executor_a = NULL;
+  IREE_ASSERT_OK(iree_task_executor_acquire_shared(
+      options, &topology, iree_allocator_system(), &executor_a));
+  EXPECT_EQ(iree_task_executor_worker_count(executor_a), 2);
+
+  // The second user gets the same executor even with a different topology.
+  iree_task_topology_t other_topology;
+  iree_task_topology_initialize_from_group_count(/*group_count=*/3,
+                                                 &other_topology);
+  iree_task_executor_t* executor_b = NULL;
+  IREE_ASSERT_OK(iree_task_executor_acquire_shared(
+      options, &other_topology, iree_allocator_system(), &executor_b));
+  EXPECT_EQ(executor_a, executor_b);
+  iree_task_executor_release(executor_a);
+  iree_task_executor_release(executor_b);
+
+  // With all users gone the next acquire creates a new executor.
+  iree_task_executor_t* executor_c = NULL;
+  IREE_ASSERT_OK(iree_task_executor_acquire_shared(
+      options, &other_topology, iree_allocator_system(), &executor_c));
+  EXPECT_EQ(iree_task_executor_worker_count(executor_c), 3);
+  iree_task_executor_release(executor_c);
+
+  // Race acquires against the final release of the shared executor.
+  std::vector<std::thread> threads;
+  for (int i = 0; i < 4; ++i) {
+    threads.emplace_back([&]() {
+      for (int j = 0; j < 20; ++j) {
+        iree_task_executor_t* executor = NULL;
+        IREE_ASSERT_OK(iree_task_executor_acquire_shared(
+            options, &topology, iree_allocator_system(), &executor));
+        iree_task_executor_release(executor);
+      }
+    });
+  }
+  for (auto& thread : threads) thread.join();
+
+  iree_task_topology_deinitialize(&other_topology);
+  iree_task_topology_deinitialize(&topology);
+}
+
 // Tests lifetime when issuing submissions before exiting.
 // This tries to catch races in shutdown with pending work.
 TEST(ExecutorTest, LifetimeStress) {
@@ -133,4 +192,454 @@ TEST(ExecutorTest, SubmissionStress) {
   iree_task_topology_deinitialize(&topology);
 }
 
+// Tests many threads submitting and flushing at the same time. Each flush
+// coordinates inline and races with the other flushing threads and any idle
+// workers coordinating on their own.
+TEST(ExecutorTest, ConcurrentCoordination) {
+  iree_task_executor_options_t options;
+  iree_task_executor_options_initialize(&options);
+  iree_task_topology_t topology;
+  iree_task_topology_initialize_from_group_count(/*group_count=*/8, &topology);
+  iree_task_executor_t* executor = NULL;
+  IREE_ASSERT_OK(iree_task_executor_create(options, &topology,
+                                           iree_allocator_system(), &executor));
+
+  static std::atomic<int> call_count = {0};
+  call_count = 0;
+  static const int kThreadCount = 8;
+  static const int kSubmissionCount = 200;
+  std::vector<std::thread> threads;
+  for (int i = 0; i < kThreadCount; ++i) {
+    threads.emplace_back([executor]() {
+      iree_task_scope_t scope;
+      iree_task_scope_initialize(iree_make_cstring_view("scope"), &scope);
+      for (int j = 0; j < kSubmissionCount; ++j) {
+        iree_task_call_t call;
+        iree_task_call_initialize(
+            &scope,
+            iree_task_make_call_closure(
+                [](void* user_context, iree_task_t* task,
+                   iree_task_submission_t* pending_submission) {
+                  ++call_count;
+                  return iree_ok_status();
+                },
+                NULL),
+            &call);
+        iree_task_fence_t* fence = NULL;
+        IREE_ASSERT_OK(
+            iree_task_executor_acquire_fence(executor, &scope, &fence));
+        iree_task_set_completion_task(&call.header, &fence->header);
+        iree_task_submission_t submission;
+        iree_task_submission_initialize(&submission);
+        iree_task_submission_enqueue(&submission, &call.header);
+        iree_task_executor_submit(executor, &submission);
+        iree_task_executor_flush(executor);
+        IREE_ASSERT_OK(
+            iree_task_scope_wait_idle(&scope, IREE_TIME_INFINITE_FUTURE));
+      }
+      iree_task_scope_deinitialize(&scope);
+    });
+  }
+  for (auto& thread : threads) thread.join();
+  EXPECT_EQ(call_count, kThreadCount * kSubmissionCount);
+
+  iree_task_executor_release(executor);
+  iree_task_topology_deinitialize(&topology);
+}
+
+// Tests that executors spanning multiple worker clusters can be created and
+// execute work. Tasks may land on and be stolen by workers in any cluster.
+TEST(ExecutorTest, MultipleClusters) {
+  const iree_host_size_t group_count =
+      IREE_TASK_EXECUTOR_MAX_WORKERS_PER_CLUSTER + 8;
+  if (group_count > IREE_TASK_EXECUTOR_MAX_WORKER_COUNT) {
+    GTEST_SKIP() << "executor configured with a single cluster";
+  }
+  iree_task_executor_options_t options;
+  iree_task_executor_options_initialize(&options);
+  iree_task_topology_t topology;
+  iree_task_topology_initialize_from_group_count(group_count, &topology);
+  iree_task_executor_t* executor = NULL;
+  IREE_ASSERT_OK(iree_task_executor_create(options, &topology,
+                                           iree_allocator_system(), &executor));
+  iree_task_scope_t scope;
+  iree_task_scope_initialize(iree_make_cstring_view("scope"), &scope);
+
+  static std::atomic<int> call_count = {0};
+  call_count = 0;
+  static const int kCallCount = 256;
+  iree_task_call_t calls[kCallCount];
+  iree_task_fence_t* fence = NULL;
+  IREE_ASSERT_OK(iree_task_executor_acquire_fence(executor, &scope, &fence));
+  iree_task_submission_t submission;
+  iree_task_submission_initialize(&submission);
+  for (int i = 0; i < kCallCount; ++i) {
+    iree_task_call_initialize(
+        &scope,
+        iree_task_make_call_closure(
+            [](void* user_context, iree_task_t* task,
+               iree_task_submission_t* pending_submission) {
+              ++call_count;
+              return iree_ok_status();
+            },
+            NULL),
+        &calls[i]);
+    iree_task_set_completion_task(&calls[i].header, &fence->header);
+    iree_task_submission_enqueue(&submission, &calls[i].header);
+  }
+  iree_task_executor_submit(executor, &submission);
+  iree_task_executor_flush(executor);
+  IREE_ASSERT_OK(iree_task_scope_wait_idle(&scope, IREE_TIME_INFINITE_FUTURE));
+  EXPECT_EQ(call_count, kCallCount);
+
+  iree_task_scope_deinitialize(&scope);
+  iree_task_executor_release(executor);
+  iree_task_topology_deinitialize(&topology);
+}
+
+// Tests executors with workers spread across multiple NUMA nodes. Workers only
+// steal from others on their own node unless remote theft is allowed but all
+// work must still complete.
+TEST(ExecutorTest, MultipleNodes) {
+  iree_task_topology_t topology;
+  iree_task_topology_initialize(&topology);
+  for (iree_host_size_t i = 0; i < 8; ++i) {
+    iree_task_topology_group_t group;
+    iree_task_topology_group_initialize((uint8_t)i, &group);
+    group.node_id = (iree_task_topology_node_id_t)(i / 4);
+    IREE_ASSERT_OK(iree_task_topology_push_group(&topology, &group));
+  }
+
+  for (bool allow_remote_node_theft : {false, true}) {
+    iree_task_executor_options_t options;
+    iree_task_executor_options_initialize(&options);
+    options.worker_local_memory_size = 64 * 1024;
+    if (allow_remote_node_theft) {
+      options.scheduling_mode |=
+          IREE_TASK_SCHEDULING_MODE_ALLOW_REMOTE_NODE_THEFT;
+    }
+    iree_task_executor_t* executor = NULL;
+    IREE_ASSERT_OK(iree_task_executor_create(
+        options, &topology, iree_allocator_system(), &executor));
+    iree_task_scope_t scope;
+    iree_task_scope_initialize(iree_make_cstring_view("scope"), &scope);
+
+    static std::atomic<int> call_count = {0};
+    call_count = 0;
+    static const int kCallCount = 64;
+    iree_task_call_t calls[kCallCount];
+    iree_task_fence_t* fence = NULL;
+    IREE_ASSERT_OK(iree_task_executor_acquire_fence(executor, &scope, &fence));
+    iree_task_submission_t submission;
+    iree_task_submission_initialize(&submission);
+    for (int i = 0; i < kCallCount; ++i) {
+      iree_task_call_initialize(
+          &scope,
+          iree_task_make_call_closure(
+              [](void* user_context, iree_task_t* task,
+                 iree_task_submission_t* pending_submission) {
+                ++call_count;
+                return iree_ok_status();
+              },
+              NULL),
+          &calls[i]);
+      iree_task_set_completion_task(&calls[i].header, &fence->header);
+      iree_task_submission_enqueue(&submission, &calls[i].header);
+    }
+    iree_task_executor_submit(executor, &submission);
+    iree_task_executor_flush(executor);
+    IREE_ASSERT_OK(
+        iree_task_scope_wait_idle(&scope, IREE_TIME_INFINITE_FUTURE));
+    EXPECT_EQ(call_count, kCallCount);
+
+    iree_task_scope_deinitialize(&scope);
+    iree_task_executor_release(executor);
+  }
+
+  iree_task_topology_deinitialize(&topology);
+}
+
+// Tests back-to-back small submissions with adaptive worker spinning. Workers
+// tune their spin window as they go and every submission must still complete
+// regardless of whether the worker caught it while spinning or parked.
+TEST(ExecutorTest, AdaptiveWorkerSpin) {
+  iree_task_topology_t topology;
+  iree_task_topology_initialize_from_group_count(/*group_count=*/2, &topology);
+
+  iree_task_executor_options_t options;
+  iree_task_executor_options_initialize(&options);
+  options.scheduling_mode |= IREE_TASK_SCHEDULING_MODE_ADAPTIVE_WORKER_SPIN;
+  options.worker_spin_ns = 20 * 1000;
+  iree_task_executor_t* executor = NULL;
+  IREE_ASSERT_OK(iree_task_executor_create(options, &topology,
+                                           iree_allocator_system(), &executor));
+  iree_task_scope_t scope;
+  iree_task_scope_initialize(iree_make_cstring_view("scope"), &scope);
+
+  static std::atomic<int> call_count = {0};
+  call_count = 0;
+  static const int kSubmissionCount = 200;
+  for (int i = 0; i < kSubmissionCount; ++i) {
+    iree_task_call_t call;
+    iree_task_call_initialize(
+        &scope,
+        iree_task_make_call_closure(
+            [](void* user_context, iree_task_t* task,
+               iree_task_submission_t* pending_submission) {
+              ++call_count;
+              return iree_ok_status();
+            },
+            NULL),
+        &call);
+    iree_task_fence_t* fence = NULL;
+    IREE_ASSERT_OK(iree_task_executor_acquire_fence(executor, &scope, &fence));
+    iree_task_set_completion_task(&call.header, &fence->header);
+    iree_task_submission_t submission;
+    iree_task_submission_initialize(&submission);
+    iree_task_submission_enqueue(&submission, &call.header);
+    iree_task_executor_submit(executor, &submission);
+    iree_task_executor_flush(executor);
+    IREE_ASSERT_OK(
+        iree_task_scope_wait_idle(&scope, IREE_TIME_INFINITE_FUTURE));
+
+    // Periodically leave the workers idle for longer than their spin window so
+    // that they have to park and shrink their windows.
+    if (i % 50 == 49) {
+      std::this_thread::sleep_for(std::chrono::milliseconds(2));
+    }
+  }
+  EXPECT_EQ(call_count, kSubmissionCount);
+
+  iree_task_scope_deinitialize(&scope);
+  iree_task_executor_release(executor);
+  iree_task_topology_deinitialize(&topology);
+}
+
+// Tests that high priority tasks preempt lower priority dispatches at
+// reservation boundaries when prioritizing latency and otherwise wait for the
+// dispatch to complete. With a single worker the high priority call can only
+// run at the point the dispatch shard stops processing tiles.
+TEST(ExecutorTest, PrioritizeLatency) {
+  iree_task_topology_t topology;
+  iree_task_topology_initialize_from_group_count(/*group_count=*/1, &topology);
+
+  for (bool prioritize_latency : {false, true}) {
+    iree_task_executor_options_t options;
+    iree_task_executor_options_initialize(&options);
+    if (prioritize_latency) {
+      options.scheduling_mode |= IREE_TASK_SCHEDULING_MODE_PRIORITIZE_LATENCY;
+    }
+    iree_task_executor_t* executor = NULL;
+    IREE_ASSERT_OK(iree_task_executor_create(
+        options, &topology, iree_allocator_system(), &executor));
+    iree_task_scope_t batch_scope;
+    iree_task_scope_initialize(iree_make_cstring_view("batch"), &batch_scope);
+    iree_task_scope_t interactive_scope;
+    iree_task_scope_initialize(iree_make_cstring_view("interactive"),
+                               &interactive_scope);
+    iree_task_scope_set_priority(&interactive_scope, IREE_TASK_PRIORITY_HIGH);
+
+    // Normal priority dispatch that blocks on its first tile until the high
+    // priority call has been submitted.
+    static std::atomic<bool> dispatch_started = {false};
+    static std::atomic<bool> call_submitted = {false};
+    static std::atomic<uint32_t> tiles_completed = {0};
+    dispatch_started = false;
+    call_submitted = false;
+    tiles_completed = 0;
+    static const uint32_t kTileCount = 1024;
+    const uint32_t workgroup_size[3] = {1, 1, 1};
+    const uint32_t workgroup_count[3] = {kTileCount, 1, 1};
+    iree_task_dispatch_t dispatch;
+    iree_task_dispatch_initialize(
+        &batch_scope,
+        iree_task_make_dispatch_closure(
+            [](void* user_context, const iree_task_tile_context_t* tile_context,
+               iree_task_submission_t* pending_submission) {
+              if (tile_context->workgroup_xyz[0] == 0) {
+                dispatch_started = true;
+                while (!call_submitted) std::this_thread::yield();
+              }
+              ++tiles_completed;
+              return iree_ok_status();
+            },
+            NULL),
+        workgroup_size, workgroup_count, &dispatch);
+    iree_task_fence_t* batch_fence = NULL;
+    IREE_ASSERT_OK(
+        iree_task_executor_acquire_fence(executor, &batch_scope, &batch_fence));
+    iree_task_set_completion_task(&dispatch.header, &batch_fence->header);
+    iree_task_submission_t batch_submission;
+    iree_task_submission_initialize(&batch_submission);
+    iree_task_submission_enqueue(&batch_submission, &dispatch.header);
+    iree_task_executor_submit(executor, &batch_submission);
+    iree_task_executor_flush(executor);
+    while (!dispatch_started) std::this_thread::yield();
+
+    // High priority call that records how far along the dispatch was.
+    static std::atomic<uint32_t> tiles_completed_before_call = {0};
+    tiles_completed_before_call = 0;
+    iree_task_call_t call;
+    iree_task_call_initialize(
+        &interactive_scope,
+        iree_task_make_call_closure(
+            [](void* user_context, iree_task_t* task,
+               iree_task_submission_t* pending_submission) {
+              tiles_completed_before_call = tiles_completed.load();
+              return iree_ok_status();
+            },
+            NULL),
+        &call);
+    iree_task_fence_t* interactive_fence = NULL;
+    IREE_ASSERT_OK(iree_task_executor_acquire_fence(
+        executor, &interactive_scope, &interactive_fence));
+    iree_task_set_completion_task(&call.header, &interactive_fence->header);
+    iree_task_submission_t interactive_submission;
+    iree_task_submission_initialize(&interactive_submission);
+    iree_task_submission_enqueue(&interactive_submission, &call.header);
+    iree_task_executor_submit(executor, &interactive_submission);
+    iree_task_executor_flush(executor);
+    call_submitted = true;
+
+    IREE_ASSERT_OK(iree_task_scope_wait_idle(&interactive_scope,
+                                             IREE_TIME_INFINITE_FUTURE));
+    IREE_ASSERT_OK(
+        iree_task_scope_wait_idle(&batch_scope, IREE_TIME_INFINITE_FUTURE));
+    EXPECT_EQ(tiles_completed, kTileCount);
+    if (prioritize_latency) {
+      EXPECT_GT(tiles_completed_before_call, 0u);
+      EXPECT_LT(tiles_completed_before_call, kTileCount);
+    } else {
+      EXPECT_EQ(tiles_completed_before_call, kTileCount);
+    }
+
+    iree_task_scope_deinitialize(&interactive_scope);
+    iree_task_scope_deinitialize(&batch_scope);
+    iree_task_executor_release(executor);
+  }
+
+  iree_task_topology_deinitialize(&topology);
+}
+
+// Tests that workers grow their local memory on demand for dispatches that need
+// more than the executor reserved up front and that requests beyond the limit
+// fail.
+TEST(ExecutorTest, GrowWorkerLocalMemory) {
+  iree_task_topology_t topology;
+  iree_task_topology_initialize_from_group_count(/*group_count=*/2, &topology);
+  iree_task_executor_options_t options;
+  iree_task_executor_options_initialize(&options);
+  options.worker_local_memory_size = 4 * 1024;
+  options.worker_local_memory_limit = 1024 * 1024;
+  iree_task_executor_t* executor = NULL;
+  IREE_ASSERT_OK(iree_task_executor_create(options, &topology,
+                                           iree_allocator_system(), &executor));
+  iree_task_scope_t scope;
+  iree_task_scope_initialize(iree_make_cstring_view("scope"), &scope);
+
+  auto submit_dispatch = [&](uint32_t local_memory_size) {
+    const uint32_t workgroup_size[3] = {1, 1, 1};
+    const uint32_t workgroup_count[3] = {64, 1, 1};
+    iree_task_dispatch_t dispatch;
+    iree_task_dispatch_initialize(
+        &scope,
+        iree_task_make_dispatch_closure(
+            [](void* user_context, const iree_task_tile_context_t* tile_context,
+               iree_task_submission_t* pending_submission) {
+              // Touch every byte to make sure it's all usable.
+              memset(tile_context->local_memory.data, 0xCD,
+                     tile_context->local_memory.data_length);
+              return iree_ok_status();
+            },
+            NULL),
+        workgroup_size, workgroup_count, &dispatch);
+    dispatch.local_memory_size = local_memory_size;
+    iree_task_fence_t* fence = NULL;
+    IREE_ASSERT_OK(iree_task_executor_acquire_fence(executor, &scope, &fence));
+    iree_task_set_completion_task(&dispatch.header, &fence->header);
+    iree_task_submission_t submission;
+    iree_task_submission_initialize(&submission);
+    iree_task_submission_enqueue(&submission, &dispatch.header);
+    iree_task_executor_submit(executor, &submission);
+    iree_task_executor_flush(executor);
+    IREE_ASSERT_OK(
+        iree_task_scope_wait_idle(&scope, IREE_TIME_INFINITE_FUTURE));
+  };
+
+  // Within the reserved memory, then larger (requiring growth), then smaller
+  // again (reusing the grown memory).
+  for (uint32_t local_memory_size : {4 * 1024, 300 * 1024, 16 * 1024}) {
+    submit_dispatch(local_memory_size);
+    IREE_EXPECT_OK(iree_task_scope_consume_status(&scope));
+  }
+
+  // Beyond the limit.
+  submit_dispatch(2 * 1024 * 1024);
+  EXPECT_THAT(Status(iree_task_scope_consume_status(&scope)),
+              StatusIs(StatusCode::kResourceExhausted));
+
+  iree_task_scope_deinitialize(&scope);
+  iree_task_executor_release(executor);
+  iree_task_topology_deinitialize(&topology);
+}
+
+// Tests that a donated caller executes tasks while it waits. With a single
+// worker blocked in a call waiting on a second call the program can only make
+// progress if the donating thread runs the second call.
+TEST(ExecutorTest, DonateCaller) {
+  iree_task_topology_t topology;
+  iree_task_topology_initialize_from_group_count(/*group_count=*/1, &topology);
+  iree_task_executor_options_t options;
+  iree_task_executor_options_initialize(&options);
+  iree_task_executor_t* executor = NULL;
+  IREE_ASSERT_OK(iree_task_executor_create(options, &topology,
+                                           iree_allocator_system(), &executor));
+  iree_task_scope_t scope;
+  iree_task_scope_initialize(iree_make_cstring_view("scope"), &scope);
+
+  struct State {
+    std::atomic<int> started_count = {0};
+    std::atomic<bool> released = {false};
+    iree_event_t done_event;
+  } state;
+  IREE_ASSERT_OK(iree_event_initialize(/*initial_state=*/false,
+                                       &state.done_event));
+
+  // Whichever call starts first blocks until the other one has started. The
+  // second to start releases the first and the first to finish signals.
+  auto call_fn = [](void* user_context, iree_task_t* task,
+                    iree_task_submission_t* pending_submission) {
+    State* state = (State*)user_context;
+    if (state->started_count.fetch_add(1) == 0) {
+      while (!state->released) std::this_thread::yield();
+      iree_event_set(&state->done_event);
+    } else {
+      state->released = true;
+    }
+    return iree_ok_status();
+  };
+  iree_task_call_t call0;
+  iree_task_call_initialize(
+      &scope, iree_task_make_call_closure(call_fn, &state), &call0);
+  iree_task_call_t call1;
+  iree_task_call_initialize(
+      &scope, iree_task_make_call_closure(call_fn, &state), &call1);
+
+  iree_task_submission_t submission;
+  iree_task_submission_initialize(&submission);
+  iree_task_submission_enqueue(&submission, &call0.header);
+  iree_task_submission_enqueue(&submission, &call1.header);
+  iree_task_executor_submit(executor, &submission);
+  IREE_ASSERT_OK(iree_task_executor_donate_caller(
+      executor, iree_event_await(&state.done_event),
+      iree_make_timeout_ms(10000)));
+  IREE_ASSERT_OK(iree_task_scope_wait_idle(&scope, IREE_TIME_INFINITE_FUTURE));
+  EXPECT_EQ(state.started_count, 2);
+
+  iree_event_deinitialize(&state.done_event);
+  iree_task_scope_deinitialize(&scope);
+  iree_task_executor_release(executor);
+  iree_task_topology_deinitialize(&topology);
+}
+
 }  // namespace
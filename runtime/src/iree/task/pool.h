@@ -97,9 +97,8 @@ iree_status_t iree_task_pool_acquire(iree_task_pool_t* pool,
 // intialized by the caller.
 //
 // WARNING: this may cause growth during races if multiple threads are trying to
-// acquire at the same time. Our usage patterns here are such that this is never
-// the case, though, as all acquisition from the internal executor pools happens
-// with the coordination lock held.
+// acquire at the same time. This can happen when multiple threads coordinate
+// concurrently but is rare and only results in additional (reusable) memory.
 iree_status_t iree_task_pool_acquire_many(iree_task_pool_t* pool,
                                           iree_host_size_t count,
                                           iree_task_list_t* out_list);
@@ -22,7 +22,7 @@ void iree_task_post_batch_initialize(iree_task_executor_t* executor,
                                      iree_task_post_batch_t* out_post_batch) {
   out_post_batch->executor = executor;
   out_post_batch->current_worker = current_worker;
-  out_post_batch->worker_pending_mask = 0;
+  out_post_batch->cluster_pending_mask = 0;
   memset(&out_post_batch->worker_pending_lifos, 0,
          executor->worker_count * sizeof(iree_task_list_t));
 }
@@ -32,34 +32,57 @@ iree_host_size_t iree_task_post_batch_worker_count(
   return post_batch->executor->worker_count;
 }
 
+// Returns the pending mask of |cluster_index| within the batch.
+static inline iree_task_affinity_set_t iree_task_post_batch_pending_mask(
+    const iree_task_post_batch_t* post_batch, iree_host_size_t cluster_index) {
+  return (post_batch->cluster_pending_mask & (1u << cluster_index))
+             ? post_batch->worker_pending_masks[cluster_index]
+             : 0;
+}
+
+// Returns the cluster that should be tried first when selecting workers.
+static inline iree_host_size_t iree_task_post_batch_home_cluster(
+    const iree_task_post_batch_t* post_batch) {
+  return post_batch->current_worker ? post_batch->current_worker->cluster_index
+                                    : 0;
+}
+
 static iree_host_size_t iree_task_post_batch_select_random_worker(
-    iree_task_post_batch_t* post_batch, iree_task_affinity_set_t affinity_set) {
+    iree_task_post_batch_t* post_batch, iree_host_size_t cluster_index,
+    iree_task_affinity_set_t affinity_set) {
   // The masks are accessed with 'relaxed' order because they are just hints.
+  iree_task_worker_cluster_t* cluster =
+      &post_batch->executor->worker_clusters[cluster_index];
   iree_task_affinity_set_t worker_live_mask =
-      iree_atomic_task_affinity_set_load(
-          &post_batch->executor->worker_live_mask, iree_memory_order_relaxed);
+      iree_atomic_task_affinity_set_load(&cluster->worker_live_mask,
+                                         iree_memory_order_relaxed);
   iree_task_affinity_set_t valid_worker_mask = affinity_set & worker_live_mask;
   if (!valid_worker_mask) {
-    // No valid workers as desired; for now just bail to worker 0.
-    return 0;
+    // No valid workers as desired; for now just bail to the first worker.
+    return cluster_index * IREE_TASK_EXECUTOR_MAX_WORKERS_PER_CLUSTER;
   }
 
   // TODO(benvanik): rotate through workers here. Instead, if the affinity set
   // has the current_worker allowed we just use that to avoid needing a
   // cross-thread hop.
-  return iree_task_affinity_set_count_trailing_zeros(valid_worker_mask);
+  return cluster_index * IREE_TASK_EXECUTOR_MAX_WORKERS_PER_CLUSTER +
+         iree_task_affinity_set_count_trailing_zeros(valid_worker_mask);
 }
 
 iree_host_size_t iree_task_post_batch_select_worker(
     iree_task_post_batch_t* post_batch, iree_task_affinity_set_t affinity_set) {
-  if (post_batch->current_worker) {
+  iree_task_worker_t* current_worker = post_batch->current_worker;
+  if (current_worker) {
     // Posting from a worker - prefer sending right back to this worker if we
     // haven't already scheduled for it.
-    if ((affinity_set & post_batch->current_worker->worker_bit) &&
-        !(post_batch->worker_pending_mask &
-          post_batch->current_worker->worker_bit)) {
-      return iree_task_affinity_set_count_trailing_zeros(
-          post_batch->current_worker->worker_bit);
+    if ((affinity_set & current_worker->worker_bit) &&
+        !(iree_task_post_batch_pending_mask(post_batch,
+                                            current_worker->cluster_index) &
+          current_worker->worker_bit)) {
+      return current_worker->cluster_index *
+                 IREE_TASK_EXECUTOR_MAX_WORKERS_PER_CLUSTER +
+             iree_task_affinity_set_count_trailing_zeros(
+                 current_worker->worker_bit);
     }
   }
 
@@ -69,20 +92,34 @@ iree_host_size_t iree_task_post_batch_select_worker(
   // worker's queue to finish. Note that we only consider workers idle if we
   // ourselves in this batch haven't already queued work for them (as then they
   // aren't going to be idle).
+  //
+  // Idle workers in the cluster of the current worker are preferred as they
+  // are most likely to share caches with the work being posted.
   // The masks are accessed with 'relaxed' order because they are just hints.
-  iree_task_affinity_set_t worker_idle_mask =
-      iree_atomic_task_affinity_set_load(
-          &post_batch->executor->worker_idle_mask, iree_memory_order_relaxed);
-  worker_idle_mask &= ~post_batch->worker_pending_mask;
-  iree_task_affinity_set_t idle_affinity_set = affinity_set & worker_idle_mask;
-  if (idle_affinity_set) {
-    return iree_task_post_batch_select_random_worker(post_batch,
-                                                     idle_affinity_set);
+  iree_task_executor_t* executor = post_batch->executor;
+  iree_host_size_t home_cluster_index =
+      iree_task_post_batch_home_cluster(post_batch);
+  for (iree_host_size_t i = 0; i < executor->worker_cluster_count; ++i) {
+    iree_host_size_t cluster_index =
+        (home_cluster_index + i) % executor->worker_cluster_count;
+    iree_task_affinity_set_t worker_idle_mask =
+        iree_atomic_task_affinity_set_load(
+            &executor->worker_clusters[cluster_index].worker_idle_mask,
+            iree_memory_order_relaxed);
+    worker_idle_mask &=
+        ~iree_task_post_batch_pending_mask(post_batch, cluster_index);
+    iree_task_affinity_set_t idle_affinity_set =
+        affinity_set & worker_idle_mask;
+    if (idle_affinity_set) {
+      return iree_task_post_batch_select_random_worker(
+          post_batch, cluster_index, idle_affinity_set);
+    }
   }
 
   // No more workers are idle; farm out at random. In the worst case work
   // stealing will help balance things out on the backend.
-  return iree_task_post_batch_select_random_worker(post_batch, affinity_set);
+  return iree_task_post_batch_select_random_worker(
+      post_batch, home_cluster_index, affinity_set);
 }
 
 void iree_task_post_batch_enqueue(iree_task_post_batch_t* post_batch,
@@ -90,13 +127,22 @@ void iree_task_post_batch_enqueue(iree_task_post_batch_t* post_batch,
                                   iree_task_t* task) {
   iree_task_list_push_front(&post_batch->worker_pending_lifos[worker_index],
                             task);
-  post_batch->worker_pending_mask |=
-      iree_task_affinity_for_worker(worker_index);
+  iree_host_size_t cluster_index =
+      worker_index / IREE_TASK_EXECUTOR_MAX_WORKERS_PER_CLUSTER;
+  iree_task_affinity_set_t worker_bit = iree_task_affinity_for_worker(
+      worker_index % IREE_TASK_EXECUTOR_MAX_WORKERS_PER_CLUSTER);
+  if (post_batch->cluster_pending_mask & (1u << cluster_index)) {
+    post_batch->worker_pending_masks[cluster_index] |= worker_bit;
+  } else {
+    post_batch->cluster_pending_mask |= 1u << cluster_index;
+    post_batch->worker_pending_masks[cluster_index] = worker_bit;
+  }
 }
 
-// Wakes each worker indicated in the |wake_mask|, if needed.
+// Wakes each worker in |cluster_index| indicated in the |wake_mask|, if needed.
 static void iree_task_post_batch_wake_workers(
-    iree_task_post_batch_t* post_batch, iree_task_affinity_set_t wake_mask) {
+    iree_task_post_batch_t* post_batch, iree_host_size_t cluster_index,
+    iree_task_affinity_set_t wake_mask) {
   IREE_TRACE_ZONE_BEGIN(z0);
   IREE_TRACE_ZONE_APPEND_VALUE(z0, iree_math_count_ones_u64(wake_mask));
 
@@ -110,7 +156,8 @@ static void iree_task_post_batch_wake_workers(
   // migrations prior to beginning execution.
   iree_task_executor_t* executor = post_batch->executor;
   int wake_count = iree_task_affinity_set_count_ones(wake_mask);
-  int worker_index = 0;
+  int worker_index =
+      (int)(cluster_index * IREE_TASK_EXECUTOR_MAX_WORKERS_PER_CLUSTER);
   for (int i = 0; i < wake_count; ++i) {
     int offset = iree_task_affinity_set_count_trailing_zeros(wake_mask);
     int wake_index = worker_index + offset;
@@ -128,16 +175,15 @@ static void iree_task_post_batch_wake_workers(
   IREE_TRACE_ZONE_END(z0);
 }
 
-bool iree_task_post_batch_submit(iree_task_post_batch_t* post_batch) {
-  if (!post_batch->worker_pending_mask) return false;
-
-  IREE_TRACE_ZONE_BEGIN(z0);
-
+// Posts the pending tasks of all workers in |cluster_index| with bits set in
+// |worker_mask|. Returns the number of workers posted to.
+static int iree_task_post_batch_submit_cluster(
+    iree_task_post_batch_t* post_batch, iree_host_size_t cluster_index,
+    iree_task_affinity_set_t worker_mask) {
   // Run through each worker that has a bit set in the pending mask and post
   // the pending tasks.
-  iree_task_affinity_set_t worker_mask = post_batch->worker_pending_mask;
-  post_batch->worker_pending_mask = 0;
-  int worker_index = 0;
+  int worker_index =
+      (int)(cluster_index * IREE_TASK_EXECUTOR_MAX_WORKERS_PER_CLUSTER);
   int post_count = iree_task_affinity_set_count_ones(worker_mask);
   iree_task_affinity_set_t worker_wake_mask = 0;
   for (int i = 0; i < post_count; ++i) {
@@ -158,14 +204,35 @@ bool iree_task_post_batch_submit(iree_task_post_batch_t* post_batch) {
                                                    target_pending_lifo);
     } else {
       iree_task_worker_post_tasks(worker, target_pending_lifo);
-      worker_wake_mask |= iree_task_affinity_for_worker(target_index);
+      worker_wake_mask |= worker->worker_bit;
     }
   }
 
   // Wake all workers that now have pending work. If a worker is not already
   // waiting this will be cheap (no syscall).
   if (worker_wake_mask != 0) {
-    iree_task_post_batch_wake_workers(post_batch, worker_wake_mask);
+    iree_task_post_batch_wake_workers(post_batch, cluster_index,
+                                      worker_wake_mask);
+  }
+
+  return post_count;
+}
+
+bool iree_task_post_batch_submit(iree_task_post_batch_t* post_batch) {
+  if (!post_batch->cluster_pending_mask) return false;
+
+  IREE_TRACE_ZONE_BEGIN(z0);
+
+  // Run through each cluster that has pending work and post to its workers.
+  uint32_t cluster_mask = post_batch->cluster_pending_mask;
+  post_batch->cluster_pending_mask = 0;
+  int post_count = 0;
+  while (cluster_mask) {
+    int cluster_index = iree_math_count_trailing_zeros_u32(cluster_mask);
+    cluster_mask &= cluster_mask - 1;
+    post_count += iree_task_post_batch_submit_cluster(
+        post_batch, cluster_index,
+        post_batch->worker_pending_masks[cluster_index]);
   }
 
   IREE_TRACE_ZONE_END(z0);
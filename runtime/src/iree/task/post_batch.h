@@ -35,13 +35,21 @@ typedef struct iree_task_post_batch_t {
   // May be NULL if not being posted from a worker (such as a submission).
   iree_task_worker_t* current_worker;
 
-  // A bitmask of workers indicating which have pending tasks in their lists.
-  // Used to quickly scan the lists and perform the posts only when required.
-  iree_task_affinity_set_t worker_pending_mask;
+  // A bitmask of worker clusters indicating which have pending tasks in any of
+  // their worker lists.
+  uint32_t cluster_pending_mask;
+
+  // A per-cluster bitmask of workers indicating which have pending tasks in
+  // their lists. Used to quickly scan the lists and perform the posts only when
+  // required. Only the masks of clusters in cluster_pending_mask are valid.
+  iree_task_affinity_set_t
+      worker_pending_masks[IREE_TASK_EXECUTOR_MAX_CLUSTER_COUNT];
 
   // A per-worker LIFO task list waiting to be posted.
   iree_task_list_t worker_pending_lifos[0];
 } iree_task_post_batch_t;
+static_assert(IREE_TASK_EXECUTOR_MAX_CLUSTER_COUNT <= 32,
+              "cluster_pending_mask must be able to represent all clusters");
 
 void iree_task_post_batch_initialize(iree_task_executor_t* executor,
                                      iree_task_worker_t* current_worker,
@@ -52,6 +60,8 @@ iree_host_size_t iree_task_post_batch_worker_count(
     const iree_task_post_batch_t* post_batch);
 
 // Selects a random worker from the given affinity set.
+// The |affinity_set| applies to the cluster-local worker indices within each
+// cluster and workers in the same cluster as the current worker are preferred.
 iree_host_size_t iree_task_post_batch_select_worker(
     iree_task_post_batch_t* post_batch, iree_task_affinity_set_t affinity_set);
 
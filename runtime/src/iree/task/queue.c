@@ -12,50 +12,98 @@
 void iree_task_queue_initialize(iree_task_queue_t* out_queue) {
   memset(out_queue, 0, sizeof(*out_queue));
   iree_slim_mutex_initialize(&out_queue->mutex);
-  iree_task_list_initialize(&out_queue->list);
+  for (iree_host_size_t i = 0; i < IREE_TASK_PRIORITY_COUNT; ++i) {
+    iree_task_list_initialize(&out_queue->lists[i]);
+  }
 }
 
 void iree_task_queue_deinitialize(iree_task_queue_t* queue) {
-  iree_task_list_discard(&queue->list);
+  for (iree_host_size_t i = 0; i < IREE_TASK_PRIORITY_COUNT; ++i) {
+    iree_task_list_discard(&queue->lists[i]);
+  }
   iree_slim_mutex_deinitialize(&queue->mutex);
 }
 
+// Returns the highest priority list in |queue| that has tasks or NULL if all
+// lists are empty. Queue mutex must be held.
+static iree_task_list_t* iree_task_queue_front_list_locked(
+    iree_task_queue_t* queue) {
+  for (iree_host_size_t i = 0; i < IREE_TASK_PRIORITY_COUNT; ++i) {
+    if (!iree_task_list_is_empty(&queue->lists[i])) return &queue->lists[i];
+  }
+  return NULL;
+}
+
+// Pops the highest priority task from |queue|. Queue mutex must be held.
+static iree_task_t* iree_task_queue_pop_front_locked(iree_task_queue_t* queue) {
+  iree_task_list_t* list = iree_task_queue_front_list_locked(queue);
+  return list ? iree_task_list_pop_front(list) : NULL;
+}
+
+// Partitions the FIFO |list| into |out_lists| by task priority while preserving
+// the relative order of the tasks. Does not require the queue mutex.
+static void iree_task_queue_partition_by_priority(
+    iree_task_list_t* list,
+    iree_task_list_t out_lists[IREE_TASK_PRIORITY_COUNT]) {
+  for (iree_host_size_t i = 0; i < IREE_TASK_PRIORITY_COUNT; ++i) {
+    iree_task_list_initialize(&out_lists[i]);
+  }
+  iree_task_t* task = NULL;
+  while ((task = iree_task_list_pop_front(list))) {
+    iree_task_list_push_back(&out_lists[task->priority], task);
+  }
+}
+
+// Appends each of |lists| to the corresponding priority list in |queue|.
+// Queue mutex must be held.
+static void iree_task_queue_append_lists_locked(
+    iree_task_queue_t* queue,
+    iree_task_list_t lists[IREE_TASK_PRIORITY_COUNT]) {
+  for (iree_host_size_t i = 0; i < IREE_TASK_PRIORITY_COUNT; ++i) {
+    iree_task_list_append(&queue->lists[i], &lists[i]);
+  }
+}
+
 bool iree_task_queue_is_empty(iree_task_queue_t* queue) {
   iree_slim_mutex_lock(&queue->mutex);
-  bool is_empty = iree_task_list_is_empty(&queue->list);
+  bool is_empty = iree_task_queue_front_list_locked(queue) == NULL;
   iree_slim_mutex_unlock(&queue->mutex);
   return is_empty;
 }
 
 void iree_task_queue_push_front(iree_task_queue_t* queue, iree_task_t* task) {
   iree_slim_mutex_lock(&queue->mutex);
-  iree_task_list_push_front(&queue->list, task);
+  iree_task_list_push_front(&queue->lists[task->priority], task);
   iree_slim_mutex_unlock(&queue->mutex);
 }
 
 void iree_task_queue_append_from_lifo_list_unsafe(iree_task_queue_t* queue,
                                                   iree_task_list_t* list) {
-  // NOTE: reversing the list outside of the lock.
+  // NOTE: reversing and partitioning the list outside of the lock.
   iree_task_list_reverse(list);
+  iree_task_list_t priority_lists[IREE_TASK_PRIORITY_COUNT];
+  iree_task_queue_partition_by_priority(list, priority_lists);
   iree_slim_mutex_lock(&queue->mutex);
-  iree_task_list_append(&queue->list, list);
+  iree_task_queue_append_lists_locked(queue, priority_lists);
   iree_slim_mutex_unlock(&queue->mutex);
 }
 
 iree_task_t* iree_task_queue_flush_from_lifo_slist(
     iree_task_queue_t* queue, iree_atomic_task_slist_t* source_slist) {
-  // Perform the flush and swap outside of the lock; acquiring the list is
+  // Perform the flush and partition outside of the lock; acquiring the list is
   // atomic and then we own it exclusively.
   iree_task_list_t suffix;
   iree_task_list_initialize(&suffix);
   const bool did_flush = iree_atomic_task_slist_flush(
       source_slist, IREE_ATOMIC_SLIST_FLUSH_ORDER_APPROXIMATE_FIFO,
       &suffix.head, &suffix.tail);
+  iree_task_list_t priority_lists[IREE_TASK_PRIORITY_COUNT];
+  iree_task_queue_partition_by_priority(&suffix, priority_lists);
 
   // Append the tasks and pop off the front for return.
   iree_slim_mutex_lock(&queue->mutex);
-  if (did_flush) iree_task_list_append(&queue->list, &suffix);
-  iree_task_t* next_task = iree_task_list_pop_front(&queue->list);
+  if (did_flush) iree_task_queue_append_lists_locked(queue, priority_lists);
+  iree_task_t* next_task = iree_task_queue_pop_front_locked(queue);
   iree_slim_mutex_unlock(&queue->mutex);
 
   return next_task;
@@ -63,7 +111,7 @@ iree_task_t* iree_task_queue_flush_from_lifo_slist(
 
 iree_task_t* iree_task_queue_pop_front(iree_task_queue_t* queue) {
   iree_slim_mutex_lock(&queue->mutex);
-  iree_task_t* next_task = iree_task_list_pop_front(&queue->list);
+  iree_task_t* next_task = iree_task_queue_pop_front_locked(queue);
   iree_slim_mutex_unlock(&queue->mutex);
   return next_task;
 }
@@ -71,20 +119,27 @@ iree_task_t* iree_task_queue_pop_front(iree_task_queue_t* queue) {
 iree_task_t* iree_task_queue_try_steal(iree_task_queue_t* source_queue,
                                        iree_task_queue_t* target_queue,
                                        iree_host_size_t max_tasks) {
-  // First attempt to steal up to max_tasks from the source queue.
+  // First attempt to steal up to max_tasks of the highest priority available
+  // from the source queue.
   iree_task_list_t stolen_tasks;
   iree_task_list_initialize(&stolen_tasks);
   if (iree_slim_mutex_try_lock(&source_queue->mutex)) {
-    iree_task_list_split(&source_queue->list, max_tasks, &stolen_tasks);
+    iree_task_list_t* source_list =
+        iree_task_queue_front_list_locked(source_queue);
+    if (source_list) {
+      iree_task_list_split(source_list, max_tasks, &stolen_tasks);
+    }
     iree_slim_mutex_unlock(&source_queue->mutex);
   }
 
   // Add any stolen tasks to the target queue and pop off the head for return.
   iree_task_t* next_task = NULL;
   if (!iree_task_list_is_empty(&stolen_tasks)) {
+    const iree_task_priority_t priority =
+        iree_task_list_front(&stolen_tasks)->priority;
     iree_slim_mutex_lock(&target_queue->mutex);
-    iree_task_list_append(&target_queue->list, &stolen_tasks);
-    next_task = iree_task_list_pop_front(&target_queue->list);
+    iree_task_list_append(&target_queue->lists[priority], &stolen_tasks);
+    next_task = iree_task_queue_pop_front_locked(target_queue);
     iree_slim_mutex_unlock(&target_queue->mutex);
   }
   return next_task;
@@ -102,12 +102,17 @@ extern "C" {
 // list we can't easily just walk backward and we don't want to be introducing
 // cache line contention as thieves start touching the same tasks as the worker
 // is while processing.
+//
+// Tasks are kept in one FIFO list per priority class (iree_task_priority_t).
+// Pops and thefts always take from the highest priority list with tasks such
+// that latency-sensitive work overtakes any lower priority work that was
+// already queued. Order within a priority class is preserved.
 typedef struct iree_task_queue_t {
   // Must be held when manipulating the queue. >90% accesses are by the owner.
   iree_slim_mutex_t mutex;
 
-  // FIFO task list.
-  iree_task_list_t list IREE_GUARDED_BY(mutex);
+  // FIFO task lists indexed by task priority.
+  iree_task_list_t lists[IREE_TASK_PRIORITY_COUNT] IREE_GUARDED_BY(mutex);
 } iree_task_queue_t;
 
 // Initializes a work-stealing task queue in-place.
@@ -136,22 +141,24 @@ void iree_task_queue_append_from_lifo_list_unsafe(iree_task_queue_t* queue,
                                                   iree_task_list_t* list);
 
 // Flushes the |source_slist| LIFO mailbox into the task queue in FIFO order.
-// Returns the first task in the queue upon success; the task may be
+// Returns the highest priority task in the queue upon success; the task may be
 // pre-existing or from the newly flushed tasks.
 //
 // Must only be called from the owning worker's thread.
 iree_task_t* iree_task_queue_flush_from_lifo_slist(
     iree_task_queue_t* queue, iree_atomic_task_slist_t* source_slist);
 
-// Pops a task from the front of the queue if any are available.
+// Pops the highest priority task from the front of the queue if any are
+// available.
 //
 // Must only be called from the owning worker's thread.
 iree_task_t* iree_task_queue_pop_front(iree_task_queue_t* queue);
 
 // Tries to steal up to |max_tasks| from the back of the queue.
 // Returns NULL if no tasks are available and otherwise up to |max_tasks| tasks
-// that were at the tail of the |source_queue| will be moved to the
-// |target_queue| and the first of the stolen tasks is returned.
+// of the highest priority available that were at the tail of the
+// |source_queue| will be moved to the |target_queue| and the first of the
+// stolen tasks is returned.
 //
 // It's expected this is not called from the queue's owning worker, though it's
 // valid to do so.
@@ -109,6 +109,43 @@ TEST(QueueTest, AppendListOrdered) {
   iree_task_queue_deinitialize(&queue);
 }
 
+TEST(QueueTest, AppendListPriorityOrdered) {
+  iree_task_queue_t queue;
+  iree_task_queue_initialize(&queue);
+
+  // Make a lifo list: d<-c<-b<-a with mixed priorities.
+  iree_task_t task_a = {0};
+  task_a.priority = IREE_TASK_PRIORITY_LOW;
+  iree_task_t task_b = {0};
+  task_b.priority = IREE_TASK_PRIORITY_NORMAL;
+  iree_task_t task_c = {0};
+  task_c.priority = IREE_TASK_PRIORITY_HIGH;
+  iree_task_t task_d = {0};
+  task_d.priority = IREE_TASK_PRIORITY_NORMAL;
+  iree_task_list_t list = {0};
+  iree_task_list_push_front(&list, &task_a);
+  iree_task_list_push_front(&list, &task_b);
+  iree_task_list_push_front(&list, &task_c);
+  iree_task_list_push_front(&list, &task_d);
+  iree_task_queue_append_from_lifo_list_unsafe(&queue, &list);
+  EXPECT_TRUE(iree_task_list_is_empty(&list));
+
+  // Pop and ensure priority order with FIFO order within a priority: c->b->d.
+  EXPECT_EQ(&task_c, iree_task_queue_pop_front(&queue));
+  EXPECT_EQ(&task_b, iree_task_queue_pop_front(&queue));
+
+  // Pushing a higher priority task jumps ahead of the remaining tasks.
+  iree_task_t task_e = {0};
+  task_e.priority = IREE_TASK_PRIORITY_HIGH;
+  iree_task_queue_push_front(&queue, &task_e);
+  EXPECT_EQ(&task_e, iree_task_queue_pop_front(&queue));
+  EXPECT_EQ(&task_d, iree_task_queue_pop_front(&queue));
+  EXPECT_EQ(&task_a, iree_task_queue_pop_front(&queue));
+  EXPECT_TRUE(iree_task_queue_is_empty(&queue));
+
+  iree_task_queue_deinitialize(&queue);
+}
+
 TEST(QueueTest, FlushSlistEmpty) {
   iree_task_queue_t queue;
   iree_task_queue_initialize(&queue);
@@ -319,4 +356,29 @@ TEST(QueueTest, TryStealAll) {
   iree_task_queue_deinitialize(&target_queue);
 }
 
+TEST(QueueTest, TryStealHighestPriority) {
+  iree_task_queue_t source_queue;
+  iree_task_queue_initialize(&source_queue);
+  iree_task_queue_t target_queue;
+  iree_task_queue_initialize(&target_queue);
+
+  iree_task_t task_a = {0};
+  task_a.priority = IREE_TASK_PRIORITY_LOW;
+  iree_task_t task_b = {0};
+  task_b.priority = IREE_TASK_PRIORITY_HIGH;
+  iree_task_queue_push_front(&source_queue, &task_a);
+  iree_task_queue_push_front(&source_queue, &task_b);
+
+  // The high priority task is stolen first even though it was queued last.
+  EXPECT_EQ(&task_b,
+            iree_task_queue_try_steal(&source_queue, &target_queue, 1000));
+  EXPECT_TRUE(iree_task_queue_is_empty(&target_queue));
+  EXPECT_EQ(&task_a,
+            iree_task_queue_try_steal(&source_queue, &target_queue, 1000));
+  EXPECT_TRUE(iree_task_queue_is_empty(&source_queue));
+
+  iree_task_queue_deinitialize(&source_queue);
+  iree_task_queue_deinitialize(&target_queue);
+}
+
 }  // namespace
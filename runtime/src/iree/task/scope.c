@@ -27,6 +27,8 @@ void iree_task_scope_initialize(iree_string_view_t name,
   // TODO(benvanik): pick trace colors based on name hash.
   IREE_TRACE(out_scope->task_trace_color = 0xFFFF0000u);
 
+  out_scope->priority = IREE_TASK_PRIORITY_NORMAL;
+
   iree_notification_initialize(&out_scope->idle_notification);
 
   IREE_TRACE_ZONE_END(z0);
@@ -59,6 +61,12 @@ void iree_task_scope_deinitialize(iree_task_scope_t* scope) {
   IREE_TRACE_ZONE_END(z0);
 }
 
+void iree_task_scope_set_priority(iree_task_scope_t* scope,
+                                  iree_task_priority_t priority) {
+  IREE_ASSERT_LT(priority, IREE_TASK_PRIORITY_COUNT);
+  scope->priority = priority;
+}
+
 iree_string_view_t iree_task_scope_name(iree_task_scope_t* scope) {
   return iree_make_cstring_view(scope->name);
 }
@@ -126,20 +134,25 @@ void iree_task_scope_fail(iree_task_scope_t* scope, iree_status_t status) {
 
 void iree_task_scope_begin(iree_task_scope_t* scope) {
   iree_atomic_ref_count_inc(&scope->pending_submissions);
-  // relaxed because this 'begin' call will be paired with a 'end' call that
-  // will perform the release-store, and this value is only read by
-  // 'deinitialize'.
-  iree_atomic_store_int32(&scope->pending_idle_notification_posts, 1,
-                          iree_memory_order_relaxed);
 }
 
 void iree_task_scope_end(iree_task_scope_t* scope) {
+  // Waiters may observe the scope as idle as soon as the submission count
+  // reaches zero and deinitialize it while we are still posting the
+  // notification. Counting ourselves as in-flight before the decrement keeps
+  // deinitialization waiting until we are done touching the scope. A flag set
+  // by each 'begin' is not enough: a late clear from a prior 'end' can race
+  // with the 'begin' of the next submission.
+  // relaxed because the decrement below performs the release and this value
+  // is only read by 'deinitialize' after it has observed the decrement.
+  iree_atomic_fetch_add_int32(&scope->pending_idle_notification_posts, 1,
+                              iree_memory_order_relaxed);
   if (iree_atomic_ref_count_dec(&scope->pending_submissions) == 1) {
     // All submissions have completed in this scope - notify any waiters.
     iree_notification_post(&scope->idle_notification, IREE_ALL_WAITERS);
-    iree_atomic_store_int32(&scope->pending_idle_notification_posts, 0,
-                            iree_memory_order_release);
   }
+  iree_atomic_fetch_sub_int32(&scope->pending_idle_notification_posts, 1,
+                              iree_memory_order_release);
 }
 
 bool iree_task_scope_is_idle(iree_task_scope_t* scope) {
@@ -53,6 +53,10 @@ typedef struct iree_task_scope_t {
   // The color will be modulated based on task type.
   IREE_TRACE(uint32_t task_trace_color;)
 
+  // Priority class assigned to tasks initialized within the scope.
+  // Defaults to IREE_TASK_PRIORITY_NORMAL.
+  iree_task_priority_t priority;
+
   // A permanent status code set when a task within the scope fails. All pending
   // tasks will be aborted, though any in-flight tasks may continue executing
   // to completion.
@@ -72,6 +76,9 @@ typedef struct iree_task_scope_t {
   // A notification signaled when the scope transitions to having no pending
   // tasks or completes all pending tasks after a failure.
   iree_notification_t idle_notification;
+  // Number of iree_task_scope_end calls in progress that may still touch the
+  // scope (such as by posting idle_notification). Deinitialization waits for
+  // this to reach 0.
   iree_atomic_int32_t pending_idle_notification_posts;
 } iree_task_scope_t;
 
@@ -85,6 +92,11 @@ void iree_task_scope_initialize(iree_string_view_t name,
 // No tasks may be pending and the scope must be idle.
 void iree_task_scope_deinitialize(iree_task_scope_t* scope);
 
+// Sets the priority class assigned to all tasks subsequently initialized within
+// the scope. Tasks that have already been initialized retain their priority.
+void iree_task_scope_set_priority(iree_task_scope_t* scope,
+                                  iree_task_priority_t priority);
+
 // Returns the name of the scope. Informational only and may be the empty
 // string.
 iree_string_view_t iree_task_scope_name(iree_task_scope_t* scope);
@@ -16,6 +16,7 @@
 #include "iree/task/scope.h"
 #include "iree/task/submission.h"
 #include "iree/task/task_impl.h"
+#include "iree/task/topology.h"
 #include "iree/task/tuning.h"
 
 //==============================================================================
@@ -29,6 +30,7 @@ void iree_task_initialize(iree_task_type_t type, iree_task_scope_t* scope,
   out_task->scope = scope;
   out_task->affinity_set = iree_task_affinity_for_any_worker();
   out_task->type = type;
+  out_task->priority = scope ? scope->priority : IREE_TASK_PRIORITY_NORMAL;
 }
 
 void iree_task_set_cleanup_fn(iree_task_t* task,
@@ -36,6 +38,11 @@ void iree_task_set_cleanup_fn(iree_task_t* task,
   task->cleanup_fn = cleanup_fn;
 }
 
+void iree_task_set_priority(iree_task_t* task, iree_task_priority_t priority) {
+  IREE_ASSERT_LT(priority, IREE_TASK_PRIORITY_COUNT);
+  task->priority = priority;
+}
+
 void iree_task_set_completion_task(iree_task_t* task,
                                    iree_task_t* completion_task) {
   IREE_ASSERT(!task->completion_task);
@@ -531,6 +538,7 @@ static void iree_task_dispatch_initialize_base(
   memcpy(out_task->workgroup_size, workgroup_size,
          sizeof(out_task->workgroup_size));
   out_task->local_memory_size = 0;
+  out_task->fpu_state_flags = IREE_FPU_STATE_FLAG_FLUSH_DENORMALS_TO_ZERO;
   iree_atomic_store_intptr(&out_task->status, 0, iree_memory_order_release);
   memset(&out_task->statistics, 0, sizeof(out_task->statistics));
 
@@ -606,17 +614,14 @@ void iree_task_dispatch_issue(iree_task_dispatch_t* dispatch_task,
   iree_host_size_t shard_count =
       iree_min(dispatch_task->tile_count, worker_count);
 
-  // Compute how many tiles we want each shard to reserve at a time from the
+  // Bound how many tiles we want each shard to reserve at a time from the
   // larger grid. A higher number reduces overhead and improves locality while
   // a lower number reduces maximum worst-case latency (coarser work stealing).
-  if (dispatch_task->tile_count <
-      worker_count * IREE_TASK_DISPATCH_MAX_TILES_PER_SHARD_RESERVATION) {
-    // Grid is small - allow it to be eagerly sliced up.
-    dispatch_task->tiles_per_reservation = 1;
-  } else {
-    dispatch_task->tiles_per_reservation =
-        IREE_TASK_DISPATCH_MAX_TILES_PER_SHARD_RESERVATION;
-  }
+  // Shards will pick the size of each reservation within this bound; small
+  // grids end up eagerly sliced up as the remaining tile count is low.
+  dispatch_task->tiles_per_reservation =
+      IREE_TASK_DISPATCH_MAX_TILES_PER_SHARD_RESERVATION;
+  dispatch_task->shard_count = (uint32_t)shard_count;
 
   // Randomize starting worker.
   iree_host_size_t worker_offset = iree_task_post_batch_select_worker(
@@ -690,6 +695,7 @@ void iree_task_dispatch_shard_initialize(iree_task_dispatch_t* dispatch_task,
                                          iree_task_dispatch_shard_t* out_task) {
   iree_task_initialize(IREE_TASK_TYPE_DISPATCH_SHARD,
                        dispatch_task->header.scope, &out_task->header);
+  out_task->header.priority = dispatch_task->header.priority;
   iree_task_set_completion_task(&out_task->header, &dispatch_task->header);
 }
 
@@ -707,9 +713,68 @@ iree_task_dispatch_shard_t* iree_task_dispatch_shard_allocate(
   return shard_task;
 }
 
-void iree_task_dispatch_shard_execute(
+iree_host_size_t iree_task_dispatch_shard_local_memory_size(
+    const iree_task_dispatch_shard_t* task) {
+  return ((const iree_task_dispatch_t*)task->header.completion_task)
+      ->local_memory_size;
+}
+
+// Returns the number of tiles a shard should reserve next when there are
+// |remaining_tile_count| tiles left in the dispatch and the shard has measured
+// that reserving at least |min_tile_count| tiles amortizes the reservation.
+//
+// This is "guided" scheduling: reservations start large and shrink towards the
+// end of the dispatch so that all shards finish around the same time. Shards
+// running on slower cores (|speed_factor| below
+// IREE_TASK_TOPOLOGY_SPEED_FACTOR_ONE) take a proportionally smaller share of
+// the remaining tiles as they take longer to get through them.
+static uint32_t iree_task_dispatch_select_reservation_size(
+    const iree_task_dispatch_t* dispatch_task, uint32_t remaining_tile_count,
+    uint32_t min_tile_count, uint32_t speed_factor) {
+  uint32_t tile_count =
+      remaining_tile_count / (dispatch_task->shard_count *
+                              IREE_TASK_DISPATCH_GUIDED_RESERVATION_DIVISOR);
+  tile_count = (uint32_t)((uint64_t)tile_count * speed_factor /
+                          IREE_TASK_TOPOLOGY_SPEED_FACTOR_ONE);
+  tile_count = iree_max(tile_count, min_tile_count);
+  tile_count = iree_min(tile_count, dispatch_task->tiles_per_reservation);
+  return iree_max(tile_count, 1u);
+}
+
+// Returns the minimum number of tiles to reserve at a time such that each
+// reservation takes at least IREE_TASK_DISPATCH_MIN_RESERVATION_DURATION_NS
+// given that |tile_count| tiles took |duration_ns| to execute.
+static uint32_t iree_task_dispatch_min_reservation_size(
+    uint32_t tile_count, iree_time_t duration_ns) {
+  if (IREE_TASK_DISPATCH_MIN_RESERVATION_DURATION_NS == 0) return 1;
+  if (duration_ns <= 0) {
+    // Too fast to measure; tiles are about as cheap as they come.
+    return IREE_TASK_DISPATCH_MAX_TILES_PER_SHARD_RESERVATION;
+  }
+  const iree_time_t tile_duration_ns = iree_max(1, duration_ns / tile_count);
+  const iree_time_t min_tile_count =
+      IREE_TASK_DISPATCH_MIN_RESERVATION_DURATION_NS / tile_duration_ns;
+  return (uint32_t)iree_min(
+      iree_max(min_tile_count, 1),
+      (iree_time_t)IREE_TASK_DISPATCH_MAX_TILES_PER_SHARD_RESERVATION);
+}
+
+// Returns true if |yield_priority_mask| indicates that there is work pending of
+// a higher priority than |priority|.
+static bool iree_task_dispatch_shard_should_yield(
+    iree_task_priority_t priority, iree_atomic_int32_t* yield_priority_mask) {
+  if (!yield_priority_mask || priority == IREE_TASK_PRIORITY_HIGH) return false;
+  // The mask is accessed with 'relaxed' order because it is just a hint.
+  const uint32_t pending_mask = (uint32_t)iree_atomic_load_int32(
+      yield_priority_mask, iree_memory_order_relaxed);
+  return (pending_mask & ((1u << priority) - 1)) != 0;
+}
+
+bool iree_task_dispatch_shard_execute(
     iree_task_dispatch_shard_t* task, iree_cpu_processor_id_t processor_id,
-    uint32_t worker_id, iree_byte_span_t worker_local_memory,
+    uint32_t worker_id, uint32_t speed_factor,
+    iree_byte_span_t worker_local_memory, iree_fpu_state_t* fpu_state,
+    iree_atomic_int32_t* yield_priority_mask,
     iree_task_submission_t* pending_submission) {
   IREE_TRACE_ZONE_BEGIN(z0);
 
@@ -732,11 +797,15 @@ void iree_task_dispatch_shard_execute(
                          worker_local_memory.data_length));
     iree_task_retire(&task->header, pending_submission, iree_ok_status());
     IREE_TRACE_ZONE_END(z0);
-    return;
+    return true;
   }
   iree_byte_span_t local_memory = iree_make_byte_span(
       worker_local_memory.data, dispatch_task->local_memory_size);
 
+  // Switch the FPU state once for all tiles in the shard; this is a no-op if
+  // the previous shard executed by the worker required the same state.
+  iree_fpu_state_update(fpu_state, dispatch_task->fpu_state_flags);
+
   // Prepare context shared for all tiles in the shard.
   iree_task_tile_context_t tile_context;
   memcpy(&tile_context.workgroup_size, dispatch_task->workgroup_size,
@@ -745,8 +814,11 @@ void iree_task_dispatch_shard_execute(
          sizeof(tile_context.workgroup_count));
   uint32_t workgroup_count_x = tile_context.workgroup_count[0];
   uint32_t workgroup_count_y = tile_context.workgroup_count[1];
+  tile_context.tile_count = 1;
   tile_context.worker_id = worker_id;
   tile_context.local_memory = local_memory;
+  const bool tile_ranges = iree_any_bit_set(
+      dispatch_task->header.flags, IREE_TASK_FLAG_DISPATCH_TILE_RANGES);
 
   // We perform all our shard statistics work locally here and only push back to
   // the dispatch at the end; this avoids contention from each shard trying to
@@ -759,8 +831,13 @@ void iree_task_dispatch_shard_execute(
   tile_context.processor_id = processor_id;
 
   // Loop over all tiles until they are all processed.
+  // Each reservation is sized based on how many tiles remain and how long the
+  // tiles this shard has executed so far took: large dispatches of cheap tiles
+  // reserve many tiles at a time to amortize the atomic while the tail of a
+  // dispatch is split finely across all shards.
   const uint32_t tile_count = dispatch_task->tile_count;
-  const uint32_t tiles_per_reservation = dispatch_task->tiles_per_reservation;
+  uint32_t tiles_per_reservation = iree_task_dispatch_select_reservation_size(
+      dispatch_task, tile_count, /*min_tile_count=*/1, speed_factor);
   // relaxed order because we only care about atomic increments, not about
   // ordering of tile_index accesses w.r.t. other memory accesses.
   uint32_t tile_base = iree_atomic_fetch_add_int32(&dispatch_task->tile_index,
@@ -769,8 +846,11 @@ void iree_task_dispatch_shard_execute(
   while (tile_base < tile_count) {
     const uint32_t tile_range =
         iree_min(tile_base + tiles_per_reservation, tile_count);
+    const iree_time_t reservation_start_ns = iree_time_now();
+    // Closures accepting ranges are invoked once for the whole reservation.
+    if (tile_ranges) tile_context.tile_count = tile_range - tile_base;
     for (uint32_t tile_index = tile_base; tile_index < tile_range;
-         ++tile_index) {
+         tile_index += tile_context.tile_count) {
       // TODO(benvanik): faster math here, especially knowing we pull off N
       // sequential indices per reservation.
       uint32_t tile_i = tile_index;
@@ -810,6 +890,30 @@ void iree_task_dispatch_shard_execute(
       }
     }
 
+    // Size the next reservation from the remaining tiles and the cost of the
+    // ones we just executed.
+    const uint32_t min_tile_count = iree_task_dispatch_min_reservation_size(
+        tile_range - tile_base, iree_time_now() - reservation_start_ns);
+    const uint32_t next_tile_index = (uint32_t)iree_atomic_load_int32(
+        &dispatch_task->tile_index, iree_memory_order_relaxed);
+    const uint32_t remaining_tile_count =
+        next_tile_index < tile_count ? tile_count - next_tile_index : 0;
+    tiles_per_reservation = iree_task_dispatch_select_reservation_size(
+        dispatch_task, remaining_tile_count, min_tile_count, speed_factor);
+
+    // Yield to higher priority work at the reservation boundary if there is
+    // any; there's no state to save as the shard picks up whatever tiles remain
+    // when it is resumed (if any).
+    if (remaining_tile_count > 0 &&
+        iree_task_dispatch_shard_should_yield(task->header.priority,
+                                              yield_priority_mask)) {
+      IREE_TRACE_ZONE_APPEND_TEXT(z0, "yield");
+      iree_task_dispatch_statistics_merge(&shard_statistics,
+                                          &dispatch_task->statistics);
+      IREE_TRACE_ZONE_END(z0);
+      return false;
+    }
+
     // Try to grab the next slice of tiles.
     tile_base = iree_atomic_fetch_add_int32(&dispatch_task->tile_index,
                                             tiles_per_reservation,
@@ -827,4 +931,5 @@ abort_shard:
   // propagated to the dispatch and it'll clean up after all shards are joined.
   iree_task_retire(&task->header, pending_submission, iree_ok_status());
   IREE_TRACE_ZONE_END(z0);
+  return true;
 }
@@ -15,6 +15,7 @@
 #include "iree/base/internal/atomic_slist.h"
 #include "iree/base/internal/atomics.h"
 #include "iree/base/internal/cpu.h"
+#include "iree/base/internal/fpu_state.h"
 #include "iree/base/internal/synchronization.h"
 #include "iree/task/affinity_set.h"
 
@@ -117,9 +118,33 @@ enum iree_task_flag_bits_t {
   // happens and may be available for querying before all tasks have been
   // cleaned up.
   IREE_TASK_FLAG_ABORTED = 1u << 5,
+
+  // The dispatch closure accepts ranges of tiles: each invocation processes
+  // iree_task_tile_context_t::tile_count consecutive tiles instead of a single
+  // one. Shards pass each reservation of tiles as a single range, amortizing
+  // the per-tile call overhead across dispatches with many small tiles.
+  IREE_TASK_FLAG_DISPATCH_TILE_RANGES = 1u << 6,
 };
 typedef uint16_t iree_task_flags_t;
 
+// Specifies the priority class of a task.
+// Workers always prefer ready tasks of a higher priority class over those of a
+// lower one. Lower values indicate higher priority so that the classes can be
+// used to index per-priority structures in order of precedence.
+enum iree_task_priority_bits_t {
+  // Latency-sensitive work such as interactive requests.
+  IREE_TASK_PRIORITY_HIGH = 0u,
+  // Default priority of all tasks.
+  IREE_TASK_PRIORITY_NORMAL = 1u,
+  // Throughput-oriented work such as batch jobs that should only run when
+  // there is no higher priority work available.
+  IREE_TASK_PRIORITY_LOW = 2u,
+};
+typedef uint8_t iree_task_priority_t;
+
+// Total number of task priority classes.
+#define IREE_TASK_PRIORITY_COUNT 3
+
 typedef struct iree_task_t iree_task_t;
 
 // A function called to cleanup tasks.
@@ -178,6 +203,11 @@ struct iree_alignas(iree_max_align_t) iree_task_t {
   // Specifies the type of the task and how the executor handles it.
   iree_task_type_t type;
 
+  // Priority class of the task (iree_task_priority_t).
+  // Inherited from the scope when the task is initialized; forked tasks such as
+  // dispatch shards inherit the priority of their parent task.
+  iree_task_priority_t priority;
+
   // Task-specific flag bits.
   iree_task_flags_t flags;
 };
@@ -202,6 +232,10 @@ void iree_task_initialize(iree_task_type_t type, iree_task_scope_t* scope,
 void iree_task_set_cleanup_fn(iree_task_t* task,
                               iree_task_cleanup_fn_t cleanup_fn);
 
+// Overrides the priority class of |task| that was inherited from its scope.
+// Must be called prior to submitting the task.
+void iree_task_set_priority(iree_task_t* task, iree_task_priority_t priority);
+
 // Sets up a dependency edge from |task| to |completion_task| such that when
 // |task| completes |completion_task| will be notified and have its
 // pending_dependency_count decremented.
@@ -529,6 +563,10 @@ typedef iree_alignas(iree_max_align_t) struct {
   // Total workgroup count for the task. Can be used in conjunction with the
   // per-invocation workgroup_xyz and workgroup_size to compute offsets/indices.
   uint32_t workgroup_count[3];
+  // Number of consecutive tiles starting at workgroup_xyz to process, ordered
+  // with x varying fastest and wrapping at workgroup_count. Always 1 unless the
+  // dispatch has IREE_TASK_FLAG_DISPATCH_TILE_RANGES set.
+  uint32_t tile_count;
   // TODO(benvanik): workgroup index to amortize calculating linear offsets.
   // (like gl_GlobalInvocationID)
 
@@ -625,9 +663,17 @@ typedef iree_alignas(iree_max_align_t) struct iree_task_dispatch_t {
 
   // Optional transient shared memory size in bytes to allocate and pass into
   // the iree_task_tile_context_t::local_memory of each invocation of the
-  // dispatch closure.
+  // dispatch closure. Workers grow their local memory to satisfy sizes larger
+  // than the executor worker_local_memory_size up to the
+  // worker_local_memory_limit and the dispatch fails if it is larger than both.
   uint32_t local_memory_size;
 
+  // FPU state the closure requires. Defaults to flushing denormals to zero.
+  // Workers keep their FPU state across tasks and only change it when a shard
+  // of a dispatch with different flags runs, so dispatches with matching
+  // flags incur no FPU control register writes.
+  iree_fpu_state_flags_t fpu_state_flags;
+
   // Resulting status from the dispatch available once all workgroups have
   // completed (or would have completed). If multiple shards processing the
   // workgroups hit an error the first will be taken and the result ignored. A
@@ -642,10 +688,14 @@ typedef iree_alignas(iree_max_align_t) struct iree_task_dispatch_t {
   uint32_t tile_count;
 
   // Maximum number of tiles to fetch per tile reservation from the grid.
-  // Bounded by IREE_TASK_DISPATCH_MAX_TILES_PER_SHARD_RESERVATION and a
-  // reasonable number chosen based on the tile and shard counts.
+  // Bounded by IREE_TASK_DISPATCH_MAX_TILES_PER_SHARD_RESERVATION. Shards pick
+  // the actual size of each reservation based on the remaining tile count and
+  // the measured cost of the tiles they have executed.
   uint32_t tiles_per_reservation;
 
+  // Total number of shards issued for the dispatch.
+  uint32_t shard_count;
+
   // The tail tile index; the next reservation will start from here.
   // This is used by shards to slice off the work to perform in their inner
   // loop. Ideally we'd have no destructive interference with other shared data
@@ -46,7 +46,7 @@ void iree_task_call_execute(iree_task_call_t* task,
 // Retires a barrier task by notifying all dependent tasks.
 // May add zero or more tasks to the |pending_submission| if they are ready.
 //
-// Only called during coordination and expects the coordinator lock to be held.
+// Only called during coordination by the thread that owns the task.
 void iree_task_barrier_retire(iree_task_barrier_t* task,
                               iree_task_submission_t* pending_submission);
 
@@ -56,7 +56,7 @@ void iree_task_barrier_retire(iree_task_barrier_t* task,
 
 // Retires a fence task by updating the scope state.
 //
-// Only called during coordination and expects the coordinator lock to be held.
+// Only called during coordination by the thread that owns the task.
 void iree_task_fence_retire(iree_task_fence_t* task,
                             iree_task_submission_t* pending_submission);
 
@@ -66,12 +66,12 @@ void iree_task_fence_retire(iree_task_fence_t* task,
 
 // Returns true if the user-specified condition on the task is true.
 //
-// Only called during coordination and expects the coordinator lock to be held.
+// Only called during coordination by the thread that owns the task.
 bool iree_task_wait_check_condition(iree_task_wait_t* task);
 
 // Retires a wait when it has completed waiting (successfully or not).
 //
-// Only called during coordination and expects the coordinator lock to be held.
+// Only called during coordination by the thread that owns the task.
 void iree_task_wait_retire(iree_task_wait_t* task,
                            iree_task_submission_t* pending_submission,
                            iree_status_t status);
@@ -86,7 +86,7 @@ void iree_task_wait_retire(iree_task_wait_t* task,
 // execution prior to the shards and end execution after the last shard
 // finishes.
 //
-// Only called during coordination and expects the coordinator lock to be held.
+// Only called during coordination by the thread that owns the task.
 void iree_task_dispatch_issue(iree_task_dispatch_t* dispatch_task,
                               iree_task_pool_t* shard_task_pool,
                               iree_task_submission_t* pending_submission,
@@ -94,7 +94,7 @@ void iree_task_dispatch_issue(iree_task_dispatch_t* dispatch_task,
 
 // Retires a dispatch when all issued shards have completed executing.
 //
-// Only called during coordination and expects the coordinator lock to be held.
+// Only called during coordination by the thread that owns the task.
 void iree_task_dispatch_retire(iree_task_dispatch_t* dispatch_task,
                                iree_task_submission_t* pending_submission);
 
@@ -107,6 +107,10 @@ void iree_task_dispatch_retire(iree_task_dispatch_t* dispatch_task,
 iree_task_dispatch_shard_t* iree_task_dispatch_shard_allocate(
     iree_task_dispatch_t* dispatch_task, iree_task_pool_t* shard_task_pool);
 
+// Returns the bytes of worker local memory required to execute |task|.
+iree_host_size_t iree_task_dispatch_shard_local_memory_size(
+    const iree_task_dispatch_shard_t* task);
+
 // Executes and retires a dispatch shard task.
 // May block the caller for an indeterminate amount of time and should only be
 // called from threads owned by or donated to the executor.
@@ -118,11 +122,28 @@ iree_task_dispatch_shard_t* iree_task_dispatch_shard_allocate(
 // |worker_local_memory| is a block of memory exclusively available to the shard
 // during execution. Contents are undefined both before and after execution.
 //
+// |yield_priority_mask| is an optional bitmask of task priority classes
+// (1 << iree_task_priority_t) that have work pending for the executing worker.
+// When provided the shard checks it between tile reservations and yields if
+// there is work of a higher priority than the shard pending.
+//
+// |fpu_state| is the FPU state of the executing thread and is updated to the
+// state required by the dispatch if it differs.
+//
+// |speed_factor| is the relative speed of the executing worker in units of
+// IREE_TASK_TOPOLOGY_SPEED_FACTOR_ONE and scales the share of the remaining
+// tiles the shard reserves at a time.
+//
 // Errors are propagated to the parent scope and the dispatch will fail once
 // all shards have completed.
-void iree_task_dispatch_shard_execute(
+//
+// Returns true if the shard retired and false if it yielded; yielded shards
+// must be requeued by the caller and executed again to resume processing.
+bool iree_task_dispatch_shard_execute(
     iree_task_dispatch_shard_t* task, iree_cpu_processor_id_t processor_id,
-    uint32_t worker_id, iree_byte_span_t worker_local_memory,
+    uint32_t worker_id, uint32_t speed_factor,
+    iree_byte_span_t worker_local_memory, iree_fpu_state_t* fpu_state,
+    iree_atomic_int32_t* yield_priority_mask,
     iree_task_submission_t* pending_submission);
 
 #ifdef __cplusplus
@@ -19,6 +19,7 @@ void iree_task_topology_group_initialize(
   out_group->group_index = group_index;
   snprintf(out_group->name, IREE_ARRAYSIZE(out_group->name), "iree-worker-%u",
            group_index);
+  out_group->speed_factor = IREE_TASK_TOPOLOGY_SPEED_FACTOR_ONE;
   iree_thread_affinity_set_any(&out_group->ideal_thread_affinity);
   out_group->constructive_sharing_mask = IREE_TASK_TOPOLOGY_GROUP_MASK_ALL;
 }
@@ -21,12 +21,42 @@ extern "C" {
 
 // A bitmask indicating which other groups from 0 to N may constructively share
 // caches. For example, a value of 0b1100 indicates that group 2 and 3 share.
+//
+// Topologies with more than IREE_TASK_EXECUTOR_MAX_WORKERS_PER_CLUSTER groups
+// are split into clusters of that many consecutive groups and the mask is
+// relative to the cluster containing the group: bit N indicates group
+// (cluster_index * IREE_TASK_EXECUTOR_MAX_WORKERS_PER_CLUSTER + N).
 typedef uint64_t iree_task_topology_group_mask_t;
 
 #define IREE_TASK_TOPOLOGY_GROUP_MASK_ALL UINT64_MAX
 #define IREE_TASK_TOPOLOGY_GROUP_BIT_COUNT \
   (sizeof(iree_task_topology_group_mask_t) * 8)
 
+// Identifies a NUMA node in the system.
+// Systems without NUMA (or where it cannot be queried) have a single node 0.
+typedef uint32_t iree_task_topology_node_id_t;
+
+// Indicates that any node may be used when filtering by node.
+#define IREE_TASK_TOPOLOGY_NODE_ID_ANY ((iree_task_topology_node_id_t)-1)
+
+// Identifies a class of cores with similar performance on heterogeneous
+// systems (big.LITTLE, P-core/E-core, etc). Class 0 contains the fastest cores
+// in the system and each subsequent class is slower than the one before it.
+// Homogeneous systems (or those where it cannot be queried) only have class 0.
+typedef uint8_t iree_task_topology_core_class_t;
+
+// Indicates that cores of any class may be used when filtering by class.
+#define IREE_TASK_TOPOLOGY_CORE_CLASS_ANY ((iree_task_topology_core_class_t)-1)
+
+// Maximum number of distinct core classes detected. Slower cores beyond this
+// are placed into the last class.
+#define IREE_TASK_TOPOLOGY_MAX_CORE_CLASS_COUNT 4
+
+// Fixed-point speed factor value of a core that is as fast as the fastest core
+// in the system. A core running at half the speed would have a factor of
+// IREE_TASK_TOPOLOGY_SPEED_FACTOR_ONE / 2.
+#define IREE_TASK_TOPOLOGY_SPEED_FACTOR_ONE 256
+
 // Information about a particular group within the topology.
 // Groups may be of varying levels of granularity even within the same topology
 // based on how the topology is defined.
@@ -41,6 +71,21 @@ typedef struct iree_task_topology_group_t {
   // Processor index in the cpuinfo set.
   uint32_t processor_index;
 
+  // NUMA node the processor is attached to. Workers prefer to only steal work
+  // from other workers on the same node and allocate their local memory from
+  // it.
+  iree_task_topology_node_id_t node_id;
+
+  // Performance class of the core the group is mapped to.
+  iree_task_topology_core_class_t core_class;
+
+  // Relative speed of the core the group is mapped to compared to the fastest
+  // core in the system in units of IREE_TASK_TOPOLOGY_SPEED_FACTOR_ONE. Slower
+  // workers reserve fewer dispatch tiles and steal fewer tasks at a time so
+  // that they don't hold up the completion of work that faster workers could
+  // have finished sooner.
+  uint32_t speed_factor;
+
   // Ideal thread affinity for threads within this group.
   // All threads within the group share the same affinity and this is what
   // allows us to model Simultaneous Multi-Threading (SMT) (aka hyperthreading).
@@ -52,6 +97,12 @@ typedef struct iree_task_topology_group_t {
   // workers in a group all share an L2 cache then the groups indicated here may
   // all share the same L3 cache.
   iree_task_topology_group_mask_t constructive_sharing_mask;
+
+  // A bitmask of other group indices that only share an outer level of the
+  // cache hierarchy (such as the L3/last-level cache) with this group. Disjoint
+  // from constructive_sharing_mask. Workers prefer to take work from these
+  // groups over ones that share no caches at all.
+  iree_task_topology_group_mask_t outer_sharing_mask;
 } iree_task_topology_group_t;
 
 // Initializes |out_group| with a |group_index| derived name.
@@ -79,6 +130,9 @@ typedef struct iree_task_topology_t {
   iree_host_size_t group_count;
   iree_task_topology_group_t groups[IREE_TASK_EXECUTOR_MAX_WORKER_COUNT];
 } iree_task_topology_t;
+static_assert(IREE_TASK_EXECUTOR_MAX_WORKER_COUNT <= UINT8_MAX + 1,
+              "iree_task_topology_group_t::group_index must be able to "
+              "represent all groups");
 
 // Initializes an empty task topology.
 void iree_task_topology_initialize(iree_task_topology_t* out_topology);
@@ -123,9 +177,31 @@ void iree_task_topology_initialize_from_group_count(
     iree_host_size_t group_count, iree_task_topology_t* out_topology);
 
 // Initializes a topology with one group for each physical core in the machine.
+// Groups are ordered by NUMA node such that all groups on the same node are
+// consecutive. If there are more cores than |max_core_count| the cores of the
+// fastest classes are selected first.
 void iree_task_topology_initialize_from_physical_cores(
     iree_host_size_t max_core_count, iree_task_topology_t* out_topology);
 
+// Initializes a topology with one group for each physical core in NUMA node
+// |node_id|. IREE_TASK_TOPOLOGY_NODE_ID_ANY will select cores from all nodes as
+// with iree_task_topology_initialize_from_physical_cores. If the node has no
+// cores (or does not exist) the topology will fall back to a single group.
+void iree_task_topology_initialize_from_physical_cores_on_node(
+    iree_task_topology_node_id_t node_id, iree_host_size_t max_core_count,
+    iree_task_topology_t* out_topology);
+
+// Initializes a topology with one group for each physical core in NUMA node
+// |node_id| with a core class of |max_core_class| or faster. For example, a
+// |max_core_class| of 0 will only select the big/performance cores on a
+// heterogeneous system and exclude the little/efficiency ones.
+// IREE_TASK_TOPOLOGY_CORE_CLASS_ANY behaves as
+// iree_task_topology_initialize_from_physical_cores_on_node.
+void iree_task_topology_initialize_from_physical_cores_of_class(
+    iree_task_topology_node_id_t node_id,
+    iree_task_topology_core_class_t max_core_class,
+    iree_host_size_t max_core_count, iree_task_topology_t* out_topology);
+
 #ifdef __cplusplus
 }  // extern "C"
 #endif  // __cplusplus
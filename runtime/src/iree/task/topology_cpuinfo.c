@@ -7,7 +7,6 @@
 #include <stdio.h>
 
 #include "iree/base/api.h"
-#include "iree/base/internal/math.h"
 #include "iree/base/target_platform.h"
 #include "iree/base/tracing.h"
 #include "iree/task/topology.h"
@@ -34,10 +33,27 @@ void iree_task_topology_initialize_from_physical_cores(
   iree_task_topology_initialize_fallback(max_core_count, out_topology);
 }
 
+void iree_task_topology_initialize_from_physical_cores_on_node(
+    iree_task_topology_node_id_t node_id, iree_host_size_t max_core_count,
+    iree_task_topology_t* out_topology) {
+  iree_task_topology_initialize_fallback(max_core_count, out_topology);
+}
+
+void iree_task_topology_initialize_from_physical_cores_of_class(
+    iree_task_topology_node_id_t node_id,
+    iree_task_topology_core_class_t max_core_class,
+    iree_host_size_t max_core_count, iree_task_topology_t* out_topology) {
+  iree_task_topology_initialize_fallback(max_core_count, out_topology);
+}
+
 #else
 
 #include <cpuinfo.h>
 
+#if defined(__linux__)
+#include <dirent.h>
+#endif  // __linux__
+
 static bool iree_task_topology_is_cpuinfo_available() {
   return cpuinfo_initialize() && cpuinfo_get_cores_count() > 0;
 }
@@ -109,33 +125,160 @@ static void iree_task_topology_set_affinity_from_processor(
 #endif  // cpuinfo-like platform field
 }
 
-// Returns a bitset with all *processors* that share the same |cache|.
-static uint64_t iree_task_topology_calculate_cache_bits(
-    const struct cpuinfo_cache* cache) {
-  if (!cache) return 0;
-  uint64_t mask = 0;
-  for (uint32_t processor_i = 0; processor_i < cache->processor_count;
-       ++processor_i) {
-    uint32_t i = cache->processor_start + processor_i;
-    if (i < IREE_TASK_TOPOLOGY_GROUP_BIT_COUNT) {
-      mask |= 1ull << i;
+// Returns the NUMA node |processor| is attached to or 0 if unknown.
+// cpuinfo doesn't expose NUMA information so we query the OS directly.
+static iree_task_topology_node_id_t iree_task_topology_query_processor_node_id(
+    const struct cpuinfo_processor* processor) {
+  iree_task_topology_node_id_t node_id = 0;
+#if defined(__linux__)
+  // sysfs places a nodeN link in the directory of each CPU for the node it is
+  // attached to. Kernels built without NUMA support have no links and we treat
+  // everything as being on node 0.
+  char cpu_path[64];
+  snprintf(cpu_path, IREE_ARRAYSIZE(cpu_path), "/sys/devices/system/cpu/cpu%u",
+           processor->linux_id);
+  DIR* dir = opendir(cpu_path);
+  if (dir) {
+    struct dirent* entry = NULL;
+    while ((entry = readdir(dir)) != NULL) {
+      unsigned int value = 0;
+      if (sscanf(entry->d_name, "node%u", &value) == 1) {
+        node_id = value;
+        break;
+      }
     }
+    closedir(dir);
+  }
+#elif defined(_WIN32) || defined(__CYGWIN__)
+  PROCESSOR_NUMBER processor_number;
+  memset(&processor_number, 0, sizeof(processor_number));
+  processor_number.Group = processor->windows_group_id;
+  processor_number.Number = processor->windows_processor_id;
+  USHORT value = 0;
+  if (GetNumaProcessorNodeEx(&processor_number, &value)) {
+    node_id = value;
   }
-  return mask;
+#endif  // cpuinfo-like platform field
+  return node_id;
 }
 
-// Constructs a constructive sharing mask for all *processors* that share the
-// same cache as the specified |processor|.
-static uint64_t iree_task_topology_calculate_constructive_sharing_mask(
-    const struct cpuinfo_processor* processor) {
-  uint64_t mask = 0;
-  mask |= iree_task_topology_calculate_cache_bits(processor->cache.l1i);
-  mask |= iree_task_topology_calculate_cache_bits(processor->cache.l1d);
-  mask |= iree_task_topology_calculate_cache_bits(processor->cache.l2);
-  // TODO(benvanik): include L3 here too (for systems that have it)? Or use L3
-  // info purely for distribution and focus the group mask on lower-latency
-  // caches?
-  return mask;
+// Cores with a capacity within this percentage of the fastest core in a class
+// are considered part of the same class. This keeps cores that differ only
+// slightly (such as the favored cores of a CPU that can boost a few cores a bit
+// higher than others) from being split into their own classes.
+#define IREE_TASK_TOPOLOGY_CORE_CLASS_CAPACITY_TOLERANCE_PERCENT 15
+
+// Returns a relative measure of the performance of |core| that is comparable
+// with that of other cores in the system or 0 if unknown.
+static uint64_t iree_task_topology_query_core_capacity(
+    const struct cpuinfo_core* core) {
+#if defined(__linux__)
+  // Kernels supporting energy-aware scheduling on heterogeneous systems (most
+  // big.LITTLE configurations) expose a normalized capacity for each CPU that
+  // accounts for both frequency and microarchitecture. If not available we use
+  // the maximum frequency of the CPU which is enough to tell P-cores from
+  // E-cores on hybrid x86 parts.
+  static const char* const capacity_path_formats[] = {
+      "/sys/devices/system/cpu/cpu%u/cpu_capacity",
+      "/sys/devices/system/cpu/cpu%u/cpufreq/cpuinfo_max_freq",
+  };
+  const struct cpuinfo_processor* processor =
+      cpuinfo_get_processor(core->processor_start);
+  for (iree_host_size_t i = 0; i < IREE_ARRAYSIZE(capacity_path_formats);
+       ++i) {
+    char capacity_path[80];
+    snprintf(capacity_path, IREE_ARRAYSIZE(capacity_path),
+             capacity_path_formats[i], processor->linux_id);
+    FILE* file = fopen(capacity_path, "r");
+    if (!file) continue;
+    unsigned long long value = 0;
+    bool did_read = fscanf(file, "%llu", &value) == 1;
+    fclose(file);
+    if (did_read && value > 0) return value;
+  }
+#endif  // __linux__
+  // TODO(benvanik): use the EfficiencyClass from
+  // GetLogicalProcessorInformationEx on Windows.
+  return core->frequency;
+}
+
+// Performance classes of the cores in the system.
+typedef struct iree_task_topology_core_classes_t {
+  // Number of distinct classes; at least 1.
+  iree_host_size_t count;
+  // Capacity of the fastest core in the system or 0 if unknown.
+  uint64_t max_capacity;
+  // Minimum core capacity of each class. Classes are ordered fastest first and
+  // the last class always has a minimum of 0.
+  uint64_t min_capacities[IREE_TASK_TOPOLOGY_MAX_CORE_CLASS_COUNT];
+} iree_task_topology_core_classes_t;
+
+// Returns the lower bound of capacities that are considered part of the same
+// class as a core of |capacity|.
+static uint64_t iree_task_topology_core_class_min_capacity(uint64_t capacity) {
+  return capacity *
+         (100 - IREE_TASK_TOPOLOGY_CORE_CLASS_CAPACITY_TOLERANCE_PERCENT) / 100;
+}
+
+// Partitions all cores in the system into performance classes.
+static void iree_task_topology_query_core_classes(
+    iree_task_topology_core_classes_t* out_classes) {
+  memset(out_classes, 0, sizeof(*out_classes));
+  // Each pass finds the fastest core slower than all prior classes and forms a
+  // new class from it. O(classes * cores) but there are only a few classes.
+  uint64_t upper_capacity = UINT64_MAX;
+  while (out_classes->count < IREE_TASK_TOPOLOGY_MAX_CORE_CLASS_COUNT) {
+    uint64_t leader_capacity = 0;
+    for (uint32_t i = 0; i < cpuinfo_get_cores_count(); ++i) {
+      uint64_t capacity =
+          iree_task_topology_query_core_capacity(cpuinfo_get_core(i));
+      if (capacity < upper_capacity) {
+        leader_capacity = iree_max(leader_capacity, capacity);
+      }
+    }
+    if (leader_capacity == 0) break;  // no slower cores (or unknown)
+    if (out_classes->count == 0) out_classes->max_capacity = leader_capacity;
+    upper_capacity = iree_task_topology_core_class_min_capacity(leader_capacity);
+    out_classes->min_capacities[out_classes->count++] = upper_capacity;
+  }
+  // The last class catches all remaining cores (including those with unknown
+  // capacity).
+  out_classes->count = iree_max(out_classes->count, 1);
+  out_classes->min_capacities[out_classes->count - 1] = 0;
+}
+
+// Returns the class of a core with the given |capacity|.
+static iree_task_topology_core_class_t iree_task_topology_classify_core(
+    const iree_task_topology_core_classes_t* classes, uint64_t capacity) {
+  iree_host_size_t i = 0;
+  while (capacity < classes->min_capacities[i]) ++i;
+  return (iree_task_topology_core_class_t)i;
+}
+
+// Returns the speed factor of a core with the given |capacity|.
+static uint32_t iree_task_topology_core_speed_factor(
+    const iree_task_topology_core_classes_t* classes, uint64_t capacity) {
+  if (classes->max_capacity == 0) return IREE_TASK_TOPOLOGY_SPEED_FACTOR_ONE;
+  uint64_t speed_factor =
+      capacity * IREE_TASK_TOPOLOGY_SPEED_FACTOR_ONE / classes->max_capacity;
+  return (uint32_t)iree_min(iree_max(speed_factor, 1),
+                            IREE_TASK_TOPOLOGY_SPEED_FACTOR_ONE);
+}
+
+// Returns true if |a| and |b| share any of the caches we consider for
+// constructive sharing.
+static bool iree_task_topology_processors_share_cache(
+    const struct cpuinfo_processor* a, const struct cpuinfo_processor* b) {
+  return (a->cache.l1i && a->cache.l1i == b->cache.l1i) ||
+         (a->cache.l1d && a->cache.l1d == b->cache.l1d) ||
+         (a->cache.l2 && a->cache.l2 == b->cache.l2);
+}
+
+// Returns true if |a| and |b| share an outer cache level (the L3).
+// Usually this is the last-level cache shared by a CCX/CCD or entire package.
+static bool iree_task_topology_processors_share_outer_cache(
+    const struct cpuinfo_processor* a, const struct cpuinfo_processor* b) {
+  return a->cache.l3 && a->cache.l3 == b->cache.l3;
 }
 
 // Populates |our_group| with the information from |core|.
@@ -154,35 +297,72 @@ static void iree_task_topology_group_initialize_from_core(
       cpuinfo_get_processor(processor_i);
   iree_task_topology_set_affinity_from_processor(
       processor, &out_group->ideal_thread_affinity);
+  out_group->node_id = iree_task_topology_query_processor_node_id(processor);
+}
+
+// Stably sorts the groups in |topology| by NUMA node so that all groups on the
+// same node are consecutive. This keeps node-local workers within the same
+// worker clusters and makes stealing within a node cheaper.
+static void iree_task_topology_sort_groups_by_node(
+    iree_task_topology_t* topology) {
+  // Insertion sort; n is small and groups are usually already sorted.
+  for (iree_host_size_t i = 1; i < topology->group_count; ++i) {
+    iree_task_topology_group_t group = topology->groups[i];
+    iree_host_size_t j = i;
+    for (; j > 0 && topology->groups[j - 1].node_id > group.node_id; --j) {
+      topology->groups[j] = topology->groups[j - 1];
+    }
+    topology->groups[j] = group;
+  }
+
+  // Reassign group indices (and the names derived from them) to match the new
+  // order.
+  for (iree_host_size_t i = 0; i < topology->group_count; ++i) {
+    iree_task_topology_group_t* group = &topology->groups[i];
+    group->group_index = (uint8_t)i;
+    snprintf(group->name, IREE_ARRAYSIZE(group->name), "iree-worker-%u",
+             (uint32_t)i);
+  }
 }
 
 // Fixes constructive_sharing_mask values such that they represent other chosen
 // topology groups instead of processor indices. We do this so that code using
 // the topology groups doesn't need to know anything about which physical
 // processor IDs a particular group is mapped to.
+//
+// Masks are relative to the cluster of groups each group is in and groups in
+// other clusters are never included.
 static void iree_task_topology_fixup_constructive_sharing_masks(
     iree_task_topology_t* topology) {
-  // O(n^2), but n is always <= 64 (and often <= 8).
+  // O(n^2), but n is always <= IREE_TASK_EXECUTOR_MAX_WORKERS_PER_CLUSTER per
+  // cluster (and often <= 8).
   for (iree_host_size_t i = 0; i < topology->group_count; ++i) {
     iree_task_topology_group_t* group = &topology->groups[i];
-
-    // Compute the processors that we can constructively share with.
-    uint64_t constructive_sharing_mask =
-        iree_task_topology_calculate_constructive_sharing_mask(
-            cpuinfo_get_processor(group->processor_index));
-
+    const struct cpuinfo_processor* processor =
+        cpuinfo_get_processor(group->processor_index);
+
+    iree_host_size_t cluster_base =
+        i - i % IREE_TASK_EXECUTOR_MAX_WORKERS_PER_CLUSTER;
+    iree_host_size_t cluster_end =
+        iree_min(cluster_base + IREE_TASK_EXECUTOR_MAX_WORKERS_PER_CLUSTER,
+                 topology->group_count);
     iree_task_topology_group_mask_t group_mask = 0;
-    for (iree_host_size_t j = 0; j < topology->group_count; ++j) {
+    iree_task_topology_group_mask_t outer_mask = 0;
+    for (iree_host_size_t j = cluster_base; j < cluster_end; ++j) {
       if (i == j) continue;
-      const iree_task_topology_group_t* other_group = &topology->groups[j];
-      uint64_t group_processor_bits =
-          iree_math_rotl_u64(1ull, other_group->processor_index);
-      if (constructive_sharing_mask & group_processor_bits) {
-        group_mask |= iree_math_rotl_u64(1ull, other_group->group_index);
+      const struct cpuinfo_processor* other_processor =
+          cpuinfo_get_processor(topology->groups[j].processor_index);
+      if (iree_task_topology_processors_share_cache(processor,
+                                                    other_processor)) {
+        group_mask |= 1ull << (j - cluster_base);
+      } else if (iree_task_topology_processors_share_outer_cache(
+                     processor, other_processor)) {
+        outer_mask |= 1ull << (j - cluster_base);
       }
     }
 
     group->constructive_sharing_mask = group_mask;
+    group->outer_sharing_mask = outer_mask;
   }
 }
 
@@ -192,19 +372,31 @@ static bool iree_task_topology_core_filter_all(const struct cpuinfo_core* core,
   return true;
 }
 
+// Matches cores on the NUMA node specified by |user_data|.
+static bool iree_task_topology_core_filter_node(const struct cpuinfo_core* core,
+                                                uintptr_t user_data) {
+  return iree_task_topology_query_processor_node_id(
+             cpuinfo_get_processor(core->processor_start)) ==
+         (iree_task_topology_node_id_t)user_data;
+}
+
 // Returns true if the given |core| passes the filter and should be included.
 // |user_data| is the value passed alongside the filter function.
 typedef bool (*iree_task_topology_core_filter_t)(
     const struct cpuinfo_core* core, uintptr_t user_data);
 
-// Initializes a topology with one group for each core that matches |filter_fn|.
+// Initializes a topology with one group for each core that matches |filter_fn|
+// and has a class of |max_core_class| or faster. If there are more matching
+// cores than |max_core_count| the ones of faster classes are selected first.
 //
 // If cpuinfo is not available this falls back to the same behavior as
 // iree_task_topology_initialize_from_physical_cores.
 static void iree_task_topology_initialize_from_physical_cores_with_filter(
     iree_task_topology_core_filter_t filter_fn, uintptr_t filter_fn_data,
+    iree_task_topology_core_class_t max_core_class,
     iree_host_size_t max_core_count, iree_task_topology_t* out_topology) {
-  max_core_count = iree_min(max_core_count, IREE_TASK_TOPOLOGY_GROUP_BIT_COUNT);
+  max_core_count =
+      iree_min(max_core_count, IREE_TASK_EXECUTOR_MAX_WORKER_COUNT);
   if (!iree_task_topology_is_cpuinfo_available()) {
     iree_task_topology_initialize_fallback(max_core_count, out_topology);
     return;
@@ -213,13 +405,36 @@ static void iree_task_topology_initialize_from_physical_cores_with_filter(
   IREE_TRACE_ZONE_BEGIN(z0);
   IREE_TRACE_ZONE_APPEND_VALUE(z0, max_core_count);
 
-  // Count cores that match the filter.
-  iree_host_size_t core_count = 0;
+  iree_task_topology_core_classes_t core_classes;
+  iree_task_topology_query_core_classes(&core_classes);
+  IREE_TRACE_ZONE_APPEND_VALUE(z0, core_classes.count);
+
+  // Count cores of each class that match the filter.
+  iree_host_size_t class_core_counts[IREE_TASK_TOPOLOGY_MAX_CORE_CLASS_COUNT];
+  memset(class_core_counts, 0, sizeof(class_core_counts));
   for (uint32_t i = 0; i < cpuinfo_get_cores_count(); i++) {
     const struct cpuinfo_core* core = cpuinfo_get_core(i);
-    if (filter_fn(core, filter_fn_data)) ++core_count;
+    if (!filter_fn(core, filter_fn_data)) continue;
+    iree_task_topology_core_class_t core_class =
+        iree_task_topology_classify_core(
+            &core_classes, iree_task_topology_query_core_capacity(core));
+    if (core_class <= max_core_class) ++class_core_counts[core_class];
+  }
+
+  // Take cores from the fastest classes first; the per-class counts become the
+  // number of cores of each class we still want to select.
+  iree_host_size_t core_count = 0;
+  for (iree_host_size_t i = 0; i < core_classes.count; ++i) {
+    class_core_counts[i] =
+        iree_min(class_core_counts[i], max_core_count - core_count);
+    core_count += class_core_counts[i];
+  }
+  if (core_count == 0) {
+    // No cores matched the filter (such as when the node has no processors).
+    iree_task_topology_initialize_fallback(max_core_count, out_topology);
+    IREE_TRACE_ZONE_END(z0);
+    return;
   }
-  core_count = iree_min(core_count, max_core_count);
 
   iree_task_topology_initialize(out_topology);
 
@@ -236,21 +451,54 @@ static void iree_task_topology_initialize_from_physical_cores_with_filter(
     // want to have our workers stealing their time.
     const struct cpuinfo_core* core =
         cpuinfo_get_core(iree_task_topology_rotate_from_base_core(core_i));
-    if (filter_fn(core, filter_fn_data)) {
-      iree_task_topology_group_initialize_from_core(
-          group_i, core, &out_topology->groups[group_i]);
-      ++group_i;
+    if (!filter_fn(core, filter_fn_data)) continue;
+    uint64_t capacity = iree_task_topology_query_core_capacity(core);
+    iree_task_topology_core_class_t core_class =
+        iree_task_topology_classify_core(&core_classes, capacity);
+    if (core_class > max_core_class || class_core_counts[core_class] == 0) {
+      continue;
     }
+    --class_core_counts[core_class];
+    iree_task_topology_group_t* group = &out_topology->groups[group_i];
+    iree_task_topology_group_initialize_from_core(group_i, core, group);
+    group->core_class = core_class;
+    group->speed_factor =
+        iree_task_topology_core_speed_factor(&core_classes, capacity);
+    ++group_i;
   }
 
+  iree_task_topology_sort_groups_by_node(out_topology);
   iree_task_topology_fixup_constructive_sharing_masks(out_topology);
   IREE_TRACE_ZONE_END(z0);
 }
 
 void iree_task_topology_initialize_from_physical_cores(
     iree_host_size_t max_core_count, iree_task_topology_t* out_topology) {
-  iree_task_topology_initialize_from_physical_cores_with_filter(
-      iree_task_topology_core_filter_all, 0, max_core_count, out_topology);
+  iree_task_topology_initialize_from_physical_cores_of_class(
+      IREE_TASK_TOPOLOGY_NODE_ID_ANY, IREE_TASK_TOPOLOGY_CORE_CLASS_ANY,
+      max_core_count, out_topology);
+}
+
+void iree_task_topology_initialize_from_physical_cores_on_node(
+    iree_task_topology_node_id_t node_id, iree_host_size_t max_core_count,
+    iree_task_topology_t* out_topology) {
+  iree_task_topology_initialize_from_physical_cores_of_class(
+      node_id, IREE_TASK_TOPOLOGY_CORE_CLASS_ANY, max_core_count, out_topology);
+}
+
+void iree_task_topology_initialize_from_physical_cores_of_class(
+    iree_task_topology_node_id_t node_id,
+    iree_task_topology_core_class_t max_core_class,
+    iree_host_size_t max_core_count, iree_task_topology_t* out_topology) {
+  if (node_id == IREE_TASK_TOPOLOGY_NODE_ID_ANY) {
+    iree_task_topology_initialize_from_physical_cores_with_filter(
+        iree_task_topology_core_filter_all, 0, max_core_class, max_core_count,
+        out_topology);
+  } else {
+    iree_task_topology_initialize_from_physical_cores_with_filter(
+        iree_task_topology_core_filter_node, (uintptr_t)node_id,
+        max_core_class, max_core_count, out_topology);
+  }
 }
 
 #endif  // IREE_TASK_CPUINFO_DISABLED
@@ -112,6 +112,8 @@ TEST(TopologyTest, FromGroupCount) {
     const iree_task_topology_group_t* group =
         iree_task_topology_get_group(&topology, i);
     EXPECT_EQ(i, group->group_index);
+    EXPECT_EQ(0, group->core_class);
+    EXPECT_EQ(IREE_TASK_TOPOLOGY_SPEED_FACTOR_ONE, group->speed_factor);
   }
 
   iree_task_topology_deinitialize(&topology);
@@ -131,6 +133,15 @@ static void EnsureTopologyValid(iree_host_size_t max_group_count,
     const iree_task_topology_group_t* group =
         iree_task_topology_get_group(topology, i);
     EXPECT_EQ(i, group->group_index);
+    EXPECT_EQ(0, group->constructive_sharing_mask & group->outer_sharing_mask);
+    EXPECT_LT(group->core_class, IREE_TASK_TOPOLOGY_MAX_CORE_CLASS_COUNT);
+    EXPECT_GT(group->speed_factor, 0);
+    EXPECT_LE(group->speed_factor, IREE_TASK_TOPOLOGY_SPEED_FACTOR_ONE);
+    if (i > 0) {
+      // Groups on the same node must be consecutive.
+      EXPECT_LE(iree_task_topology_get_group(topology, i - 1)->node_id,
+                group->node_id);
+    }
   }
 }
 
@@ -143,4 +154,42 @@ TEST(TopologyTest, FromPhysicalCores) {
   iree_task_topology_deinitialize(&topology);
 }
 
+TEST(TopologyTest, FromPhysicalCoresOnNode) {
+  static constexpr iree_host_size_t kMaxGroupCount = 4;
+  iree_task_topology_t topology;
+  iree_task_topology_initialize(&topology);
+  iree_task_topology_initialize_from_physical_cores_on_node(
+      /*node_id=*/0, kMaxGroupCount, &topology);
+  EnsureTopologyValid(kMaxGroupCount, &topology);
+  iree_task_topology_deinitialize(&topology);
+}
+
+// Nodes that don't exist should still produce a usable topology.
+TEST(TopologyTest, FromPhysicalCoresOnInvalidNode) {
+  static constexpr iree_host_size_t kMaxGroupCount = 4;
+  iree_task_topology_t topology;
+  iree_task_topology_initialize(&topology);
+  iree_task_topology_initialize_from_physical_cores_on_node(
+      /*node_id=*/1000, kMaxGroupCount, &topology);
+  EnsureTopologyValid(kMaxGroupCount, &topology);
+  iree_task_topology_deinitialize(&topology);
+}
+
+// Only the fastest class of cores should be selected. There's always at least
+// one core in class 0 so this should never fall back.
+TEST(TopologyTest, FromPhysicalCoresOfFastestClass) {
+  static constexpr iree_host_size_t kMaxGroupCount = 4;
+  iree_task_topology_t topology;
+  iree_task_topology_initialize(&topology);
+  iree_task_topology_initialize_from_physical_cores_of_class(
+      IREE_TASK_TOPOLOGY_NODE_ID_ANY, /*max_core_class=*/0, kMaxGroupCount,
+      &topology);
+  EnsureTopologyValid(kMaxGroupCount, &topology);
+  for (iree_host_size_t i = 0; i < iree_task_topology_group_count(&topology);
+       ++i) {
+    EXPECT_EQ(0, iree_task_topology_get_group(&topology, i)->core_class);
+  }
+  iree_task_topology_deinitialize(&topology);
+}
+
 }  // namespace
@@ -11,11 +11,30 @@
 extern "C" {
 #endif  // __cplusplus
 
+// Maximum number of workers within a single worker cluster.
+// Workers are partitioned into clusters of consecutive workers (which with the
+// default topologies share some level of the cache hierarchy) and the state of
+// all workers within a cluster is tracked with a single uint64_t bitmask. This
+// keeps the common single-cluster case at one atomic op per query while
+// allowing executors to scale past 64 workers.
+#define IREE_TASK_EXECUTOR_MAX_WORKERS_PER_CLUSTER (64)
+
+// Maximum number of worker clusters that an executor can manage.
+// Executors with <= IREE_TASK_EXECUTOR_MAX_WORKERS_PER_CLUSTER workers only
+// ever use a single cluster and pay no additional cost for the others.
+#if !defined(IREE_TASK_EXECUTOR_MAX_CLUSTER_COUNT)
+#define IREE_TASK_EXECUTOR_MAX_CLUSTER_COUNT (4)
+#endif  // !IREE_TASK_EXECUTOR_MAX_CLUSTER_COUNT
+
 // Maximum number of workers that an executor can manage.
-// A 64 worker hard limit is based on us using uint64_t as a bitmask to select
-// workers. It's easy to go smaller (just use fewer bits) if it's known that
-// only <64 will ever be used (such as for devices with 2 cores).
-#define IREE_TASK_EXECUTOR_MAX_WORKER_COUNT (64)
+#define IREE_TASK_EXECUTOR_MAX_WORKER_COUNT      \
+  (IREE_TASK_EXECUTOR_MAX_WORKERS_PER_CLUSTER * \
+   IREE_TASK_EXECUTOR_MAX_CLUSTER_COUNT)
+
+// Alignment of each worker's local memory. Matches the common page size so
+// that no page of local memory is shared between workers and each can be
+// placed on the NUMA node of the worker using it.
+#define IREE_TASK_EXECUTOR_WORKER_LOCAL_MEMORY_ALIGNMENT (4096)
 
 // Initial number of shard tasks that are allocated in the executor pool.
 // Increasing this number will decrease initial allocation storms in cases of
@@ -23,7 +42,8 @@ extern "C" {
 // at the cost of a higher minimum memory consumption.
 #define IREE_TASK_EXECUTOR_INITIAL_SHARD_RESERVATION_PER_WORKER (4)
 
-// Maximum number of events retained by the executor event pool.
+// Initial number of events allocated in the executor event pool. The pool
+// grows to retain the high-water mark of events in use.
 #define IREE_TASK_EXECUTOR_EVENT_POOL_CAPACITY 64
 
 // Maximum number of simultaneous waits an executor may perform as part of a
@@ -44,7 +64,12 @@ extern "C" {
 // NOTE: we reserve 1 wait handle for our own internal use. This allows us to
 // wake the coordination worker when new work is submitted from external
 // sources.
+//
+// Backends without a fixed limit on waitable handles (epoll/io_uring) may raise
+// this to allow more concurrent waits.
+#if !defined(IREE_TASK_EXECUTOR_MAX_OUTSTANDING_WAITS)
 #define IREE_TASK_EXECUTOR_MAX_OUTSTANDING_WAITS (64 - 1)
+#endif  // !IREE_TASK_EXECUTOR_MAX_OUTSTANDING_WAITS
 
 // Amount of time that can remain in a delay task while still retiring.
 // This prevents additional system sleeps when the remaining time before the
@@ -78,11 +103,18 @@ extern "C" {
 // lower variance in execution) while in batch mode systems too many tasks is
 // better (as latencies don't matter so long as throughput is maximized).
 #define IREE_TASK_EXECUTOR_MAX_THEFT_TASK_COUNT \
-  IREE_TASK_EXECUTOR_MAX_WORKER_COUNT
+  IREE_TASK_EXECUTOR_MAX_WORKERS_PER_CLUSTER
+
+// Right shift applied to IREE_TASK_EXECUTOR_MAX_THEFT_TASK_COUNT for each level
+// further away in the cache hierarchy a theft victim is. Tasks stolen from
+// distant workers run with cold caches and taking fewer of them at a time
+// leaves more of the work close to where its data already is.
+// Setting this to 0 will steal the same number of tasks from all victims.
+#define IREE_TASK_EXECUTOR_THEFT_TASK_COUNT_DISTANCE_SHIFT (1)
 
-// Number of tiles that will be batched into a single reservation from the grid.
-// This is a maximum; if there are fewer tiles that would otherwise allow for
-// maximum parallelism then this may be ignored.
+// Maximum number of tiles that will be batched into a single reservation from
+// the grid. Shards size each reservation adaptively (see below) and this only
+// bounds how large they may grow.
 //
 // The more tiles reserved at a time the higher the chance for latency to
 // increase as many reserved tiles are held up on one worker while another may
@@ -92,7 +124,43 @@ extern "C" {
 // destroying behavior where multiple workers all stomp on the same cache lines
 // (as say worker 0 and worker 1 both fight over sequential tiles adjacent in
 // memory).
-#define IREE_TASK_DISPATCH_MAX_TILES_PER_SHARD_RESERVATION (8)
+#define IREE_TASK_DISPATCH_MAX_TILES_PER_SHARD_RESERVATION (64)
+
+// Divisor of the remaining tiles used to size reservations ("guided"
+// scheduling). Each reservation takes at most
+// remaining_tiles / (shard_count * divisor) tiles such that reservations are
+// large at the start of a dispatch and shrink towards the end, balancing the
+// tail across all shards.
+#define IREE_TASK_DISPATCH_GUIDED_RESERVATION_DIVISOR (2)
+
+// Minimum duration in nanoseconds each reservation should take based on the
+// measured cost of the tiles a shard has already executed. Prevents cheap tiles
+// from paying for a contended atomic reservation each. 0 disables the cost
+// model and only guided sizing is used.
+#define IREE_TASK_DISPATCH_MIN_RESERVATION_DURATION_NS (10 * 1000)
+
+// Upper bound in nanoseconds of the adaptive spin window workers use with
+// IREE_TASK_SCHEDULING_MODE_ADAPTIVE_WORKER_SPIN when no explicit
+// worker_spin_ns is provided. Roughly a few futex wake latencies: spinning
+// longer than that costs more than the park it avoids.
+#define IREE_TASK_WORKER_DEFAULT_MAX_ADAPTIVE_SPIN_NS (50 * 1000)
+
+// Right shift used as the weight of each new sample when updating the average
+// idle duration of a worker (an exponentially weighted moving average with
+// alpha = 1 / (1 << shift)). Lower values adapt faster to changes in load.
+#define IREE_TASK_WORKER_IDLE_DURATION_EWMA_SHIFT (2)
+
+// Maximum number of processor yields a spinning worker performs between checks
+// for new work. The count starts at 1 and doubles after each check such that
+// short waits are detected quickly while long spins don't hammer the cache
+// lines posters are trying to write.
+#define IREE_TASK_WORKER_MAX_SPIN_BACKOFF_YIELDS (64)
+
+// Maximum duration in nanoseconds a thread donated with
+// iree_task_executor_donate_caller blocks on its wait source after finding no
+// work before it looks for more to steal. Work becomes available while the
+// caller waits as earlier tasks complete and ready their dependents.
+#define IREE_TASK_EXECUTOR_DONATION_WAIT_SLICE_NS (100 * 1000)
 
 // Whether to enable per-tile colors for each tile tracing zone based on the
 // tile grid xyz. Not cheap and can be disabled to reduce tracing overhead.
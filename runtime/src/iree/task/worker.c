@@ -11,6 +11,8 @@
 
 #include "iree/base/internal/fpu_state.h"
 #include "iree/base/internal/math.h"
+#include "iree/base/internal/metrics.h"
+#include "iree/base/internal/sampling_tracer.h"
 #include "iree/base/tracing.h"
 #include "iree/task/executor_impl.h"
 #include "iree/task/post_batch.h"
@@ -20,23 +22,61 @@
 
 static int iree_task_worker_main(iree_task_worker_t* worker);
 
+// Populates |out_masks| with the workers in each cluster that the worker at
+// |worker_index| may steal from.
+static void iree_task_worker_compute_theft_victim_masks(
+    iree_task_executor_t* executor, iree_host_size_t worker_index,
+    const iree_task_topology_t* topology, iree_task_affinity_set_t* out_masks) {
+  memset(out_masks, 0,
+         IREE_TASK_EXECUTOR_MAX_CLUSTER_COUNT * sizeof(*out_masks));
+  const bool allow_remote_node_theft =
+      iree_all_bits_set(executor->scheduling_mode,
+                        IREE_TASK_SCHEDULING_MODE_ALLOW_REMOTE_NODE_THEFT);
+  const iree_task_topology_node_id_t node_id =
+      iree_task_topology_get_group(topology, worker_index)->node_id;
+  for (iree_host_size_t i = 0; i < executor->worker_count; ++i) {
+    if (i == worker_index) continue;
+    if (!allow_remote_node_theft &&
+        iree_task_topology_get_group(topology, i)->node_id != node_id) {
+      continue;
+    }
+    out_masks[i / IREE_TASK_EXECUTOR_MAX_WORKERS_PER_CLUSTER] |=
+        iree_task_affinity_for_worker(
+            i % IREE_TASK_EXECUTOR_MAX_WORKERS_PER_CLUSTER);
+  }
+}
+
 iree_status_t iree_task_worker_initialize(
     iree_task_executor_t* executor, iree_host_size_t worker_index,
-    const iree_task_topology_group_t* topology_group,
-    iree_byte_span_t local_memory, iree_prng_splitmix64_state_t* seed_prng,
-    iree_task_worker_t* out_worker) {
+    const iree_task_topology_t* topology, iree_byte_span_t local_memory,
+    iree_prng_splitmix64_state_t* seed_prng, iree_task_worker_t* out_worker) {
   IREE_TRACE_ZONE_BEGIN(z0);
+  const iree_task_topology_group_t* topology_group =
+      iree_task_topology_get_group(topology, worker_index);
 
   out_worker->executor = executor;
   out_worker->worker_index = executor->worker_base_index + worker_index;
-  out_worker->worker_bit = iree_task_affinity_for_worker(worker_index);
+  out_worker->cluster_index =
+      worker_index / IREE_TASK_EXECUTOR_MAX_WORKERS_PER_CLUSTER;
+  out_worker->worker_bit = iree_task_affinity_for_worker(
+      worker_index % IREE_TASK_EXECUTOR_MAX_WORKERS_PER_CLUSTER);
   out_worker->ideal_thread_affinity = topology_group->ideal_thread_affinity;
   out_worker->constructive_sharing_mask =
       topology_group->constructive_sharing_mask;
+  out_worker->outer_sharing_mask = topology_group->outer_sharing_mask &
+                                   ~topology_group->constructive_sharing_mask;
+  iree_task_worker_compute_theft_victim_masks(executor, worker_index, topology,
+                                              out_worker->theft_victim_masks);
   out_worker->max_theft_attempts =
       executor->worker_count / IREE_TASK_EXECUTOR_MAX_THEFT_ATTEMPTS_DIVISOR;
+  out_worker->speed_factor =
+      iree_max(1u, iree_min(topology_group->speed_factor,
+                            IREE_TASK_TOPOLOGY_SPEED_FACTOR_ONE));
   iree_prng_minilcg128_initialize(iree_prng_splitmix64_next(seed_prng),
                                   &out_worker->theft_prng);
+  // Start out assuming work arrives quickly so that the spin window is
+  // initially at its widest; it shrinks quickly if that isn't the case.
+  out_worker->idle_duration_ns = executor->worker_spin_ns / 2;
   out_worker->local_memory = local_memory;
   out_worker->processor_id = 0;
   out_worker->processor_tag = 0;
@@ -44,6 +84,8 @@ iree_status_t iree_task_worker_initialize(
   iree_notification_initialize(&out_worker->wake_notification);
   iree_notification_initialize(&out_worker->state_notification);
   iree_atomic_task_slist_initialize(&out_worker->mailbox_slist);
+  iree_atomic_store_int32(&out_worker->mailbox_priority_mask, 0,
+                          iree_memory_order_relaxed);
   iree_task_queue_initialize(&out_worker->local_task_queue);
 
   iree_task_worker_state_t initial_state = IREE_TASK_WORKER_STATE_RUNNING;
@@ -127,22 +169,50 @@ void iree_task_worker_deinitialize(iree_task_worker_t* worker) {
   // get anything more posted to it) and then discarding everything we still
   // have a reference to.
   iree_atomic_task_slist_discard(&worker->mailbox_slist);
-  iree_task_list_discard(&worker->local_task_queue.list);
+  iree_task_queue_deinitialize(&worker->local_task_queue);
 
   iree_notification_deinitialize(&worker->wake_notification);
   iree_notification_deinitialize(&worker->state_notification);
   iree_atomic_task_slist_deinitialize(&worker->mailbox_slist);
-  iree_task_queue_deinitialize(&worker->local_task_queue);
+
+  if (worker->grown_local_memory) {
+    iree_allocator_free_aligned(worker->executor->allocator,
+                                worker->grown_local_memory);
+    worker->grown_local_memory = NULL;
+  }
+  worker->local_memory = iree_make_byte_span(NULL, 0);
 
   IREE_TRACE_ZONE_END(z0);
 }
 
 void iree_task_worker_post_tasks(iree_task_worker_t* worker,
                                  iree_task_list_t* list) {
+  uint32_t priority_mask = 0;
+  for (iree_task_t* task = list->head; task != NULL; task = task->next_task) {
+    priority_mask |= 1u << task->priority;
+  }
+
   // Move the list into the mailbox. Note that the mailbox is LIFO and this list
   // is concatenated with its current order preserved (which should be LIFO).
   iree_atomic_task_slist_concat(&worker->mailbox_slist, list->head, list->tail);
   memset(list, 0, sizeof(*list));
+
+  // Let the worker know what is waiting for it. This happens after the concat
+  // so that a worker that observes the mask will find the tasks when it
+  // flushes; at worst the worker has already taken them and sees a spurious
+  // mask on its next check.
+  iree_atomic_fetch_or_int32(&worker->mailbox_priority_mask,
+                             (int32_t)priority_mask,
+                             iree_memory_order_release);
+}
+
+// Flushes the worker mailbox into its local task queue and returns the highest
+// priority task now available to the worker, if any.
+static iree_task_t* iree_task_worker_flush_mailbox(iree_task_worker_t* worker) {
+  iree_atomic_exchange_int32(&worker->mailbox_priority_mask, 0,
+                             iree_memory_order_acquire);
+  return iree_task_queue_flush_from_lifo_slist(&worker->local_task_queue,
+                                               &worker->mailbox_slist);
 }
 
 iree_task_t* iree_task_worker_try_steal_task(iree_task_worker_t* worker,
@@ -161,6 +231,50 @@ iree_task_t* iree_task_worker_try_steal_task(iree_task_worker_t* worker,
   return NULL;
 }
 
+// Grows the worker local memory such that at least |minimum_size| bytes are
+// available. The new size is rounded up to a power of two to avoid repeated
+// growth by dispatches of slightly differing sizes and is bounded by the
+// executor worker_local_memory_limit. The prior contents are not preserved.
+//
+// Must only be called from the worker thread. On failure (including when the
+// limit would be exceeded) the local memory is left unchanged and the dispatch
+// requiring it will fail when it finds there is not enough.
+static void iree_task_worker_grow_local_memory(iree_task_worker_t* worker,
+                                               iree_host_size_t minimum_size) {
+  if (IREE_LIKELY(minimum_size <= worker->local_memory.data_length)) return;
+  iree_task_executor_t* executor = worker->executor;
+  if (minimum_size > executor->worker_local_memory_limit) return;
+  IREE_TRACE_ZONE_BEGIN(z0);
+
+  iree_host_size_t new_size = iree_min(
+      (iree_host_size_t)iree_math_round_up_to_pow2_u64(minimum_size),
+      executor->worker_local_memory_limit);
+  new_size = iree_host_align(new_size,
+                             IREE_TASK_EXECUTOR_WORKER_LOCAL_MEMORY_ALIGNMENT);
+  IREE_TRACE_ZONE_APPEND_VALUE(z0, (int64_t)new_size);
+
+  // The allocation is made (and will be first touched) from the worker thread
+  // so on systems with first-touch page placement it is local to the worker.
+  void* new_local_memory = NULL;
+  iree_status_t status = iree_allocator_malloc_aligned(
+      executor->allocator, new_size,
+      IREE_TASK_EXECUTOR_WORKER_LOCAL_MEMORY_ALIGNMENT, /*offset=*/0,
+      &new_local_memory);
+  if (iree_status_is_ok(status)) {
+    if (worker->grown_local_memory) {
+      iree_allocator_free_aligned(executor->allocator,
+                                  worker->grown_local_memory);
+    }
+    worker->grown_local_memory = new_local_memory;
+    worker->local_memory = iree_make_byte_span(new_local_memory, new_size);
+  } else {
+    // The dispatch will report the exhaustion when it is executed.
+    iree_status_ignore(status);
+  }
+
+  IREE_TRACE_ZONE_END(z0);
+}
+
 // Executes a task on a worker.
 // Only task types that are scheduled to workers are handled; all others must be
 // handled by the coordinator during scheduling.
@@ -175,26 +289,54 @@ static void iree_task_worker_execute(
   // BFS behavior at the cost of the additional merge overhead - it's probably
   // worth it?
   // TODO(benvanik): handle partial tasks and re-queuing.
+  IREE_SAMPLED_ZONE_BEGIN(z_sample, "iree_task_worker_execute");
   switch (task->type) {
     case IREE_TASK_TYPE_CALL: {
       iree_task_call_execute((iree_task_call_t*)task, pending_submission);
       break;
     }
     case IREE_TASK_TYPE_DISPATCH_SHARD: {
-      iree_task_dispatch_shard_execute(
-          (iree_task_dispatch_shard_t*)task, worker->processor_id,
-          worker->worker_index, worker->local_memory, pending_submission);
+      // When prioritizing latency shards yield between tile reservations if
+      // higher priority tasks have been posted to us.
+      iree_atomic_int32_t* yield_priority_mask =
+          iree_all_bits_set(worker->executor->scheduling_mode,
+                            IREE_TASK_SCHEDULING_MODE_PRIORITIZE_LATENCY)
+              ? &worker->mailbox_priority_mask
+              : NULL;
+      // Dispatches may need more local memory than the executor reserved for
+      // us; grow on demand (once, ideally) so that the shard can run.
+      iree_task_worker_grow_local_memory(
+          worker, iree_task_dispatch_shard_local_memory_size(
+                      (iree_task_dispatch_shard_t*)task));
+      if (!iree_task_dispatch_shard_execute(
+              (iree_task_dispatch_shard_t*)task, worker->processor_id,
+              worker->worker_index, worker->speed_factor,
+              worker->local_memory, &worker->fpu_state, yield_priority_mask,
+              pending_submission)) {
+        // The shard yielded; requeue it so that it resumes after the higher
+        // priority tasks it yielded to are flushed from the mailbox ahead of
+        // it. Other workers may steal it in the meantime.
+        iree_task_queue_push_front(&worker->local_task_queue, task);
+      }
       break;
     }
     default:
       IREE_ASSERT_UNREACHABLE("incorrect task type for worker execution");
       break;
   }
+  IREE_SAMPLED_ZONE_END(z_sample);
 
   // NOTE: task is invalidated above and must not be used!
   task = NULL;
 }
 
+IREE_METRIC_DEFINE(iree_task_worker_steals_metric, COUNTER,
+                   "iree_task_worker_steals_total",
+                   "Number of times a worker stole tasks from another worker.");
+IREE_METRIC_DEFINE(iree_task_worker_idle_waits_metric, COUNTER,
+                   "iree_task_worker_idle_waits_total",
+                   "Number of times a worker ran out of work and waited.");
+
 // Pumps the worker thread once, processing a single task.
 // Returns true if pumping should continue as there are more tasks remaining or
 // false if the caller should wait for more tasks to be posted.
@@ -204,8 +346,16 @@ static bool iree_task_worker_pump_once(
 
   // Check the local work queue for any work we know we should start
   // processing immediately. Other workers may try to steal some of this work
-  // if we take too long.
-  iree_task_t* task = iree_task_queue_pop_front(&worker->local_task_queue);
+  // if we take too long. If tasks have been posted since we last looked we
+  // pull them in first so that any of a higher priority than what we have
+  // queued run next.
+  iree_task_t* task = NULL;
+  if (iree_atomic_load_int32(&worker->mailbox_priority_mask,
+                             iree_memory_order_relaxed)) {
+    task = iree_task_worker_flush_mailbox(worker);
+  } else {
+    task = iree_task_queue_pop_front(&worker->local_task_queue);
+  }
 
   // Check the mailbox to see if we have incoming work that has been posted.
   // We try to greedily move it to our local work list so that we can work
@@ -217,8 +367,7 @@ static bool iree_task_worker_pump_once(
     // first place (large uneven workloads for various workers, bad distribution
     // in the face of heterogenous multi-core architectures where some workers
     // complete tasks faster than others, etc).
-    task = iree_task_queue_flush_from_lifo_slist(&worker->local_task_queue,
-                                                 &worker->mailbox_slist);
+    task = iree_task_worker_flush_mailbox(worker);
   }
 
 #if IREE_TASK_EXECUTOR_MAX_THEFT_ATTEMPTS_DIVISOR > 0
@@ -228,9 +377,13 @@ static bool iree_task_worker_pump_once(
   // the first task in the queue is popped off and returned.
   if (!task) {
     task = iree_task_executor_try_steal_task(
-        worker->executor, worker->constructive_sharing_mask,
-        worker->max_theft_attempts, &worker->theft_prng,
-        &worker->local_task_queue);
+        worker->executor, worker->cluster_index,
+        worker->constructive_sharing_mask, worker->outer_sharing_mask,
+        worker->theft_victim_masks, worker->max_theft_attempts,
+        worker->speed_factor, &worker->theft_prng, &worker->local_task_queue);
+    if (task) {
+      IREE_METRIC_ADD(iree_task_worker_steals_metric, 1);
+    }
   }
 #endif  // IREE_TASK_EXECUTOR_MAX_THEFT_ATTEMPTS_DIVISOR > 0
 
@@ -253,6 +406,98 @@ static void iree_task_worker_update_processor_id(iree_task_worker_t* worker) {
   iree_cpu_requery_processor_id(&worker->processor_tag, &worker->processor_id);
 }
 
+// Returns true if something has happened that would wake the worker if it were
+// parked: tasks were posted to its mailbox or it was asked to exit.
+static bool iree_task_worker_has_pending_wake(iree_task_worker_t* worker) {
+  // Accessed with 'relaxed' order as the worker resolves the wake through the
+  // notification or by pumping and this is just a hint.
+  return iree_atomic_load_int32(&worker->mailbox_priority_mask,
+                                iree_memory_order_relaxed) != 0 ||
+         iree_atomic_load_int32(&worker->state, iree_memory_order_relaxed) ==
+             IREE_TASK_WORKER_STATE_EXITING;
+}
+
+// Spins for up to |spin_ns| waiting for a wake with an exponential backoff
+// between checks. Returns true if the worker should wake.
+static bool iree_task_worker_spin_for_wake(iree_task_worker_t* worker,
+                                           iree_duration_t spin_ns) {
+  if (spin_ns <= 0) return false;
+  IREE_TRACE_ZONE_BEGIN(z0);
+  IREE_TRACE_ZONE_APPEND_VALUE(z0, spin_ns);
+  const iree_time_t spin_deadline_ns = iree_time_now() + spin_ns;
+  uint32_t yield_count = 1;
+  bool should_wake = false;
+  do {
+    for (uint32_t i = 0; i < yield_count; ++i) {
+      // Try to be nice to the processor when using SMT.
+      iree_processor_yield();
+    }
+    should_wake = iree_task_worker_has_pending_wake(worker);
+    yield_count =
+        iree_min(yield_count * 2, IREE_TASK_WORKER_MAX_SPIN_BACKOFF_YIELDS);
+  } while (!should_wake && iree_time_now() < spin_deadline_ns);
+  IREE_TRACE_ZONE_END(z0);
+  return should_wake;
+}
+
+// Returns how long the worker should spin before parking based on how long it
+// has recently been idle for. Spinning only pays off if work usually arrives
+// within the spin window; if it usually doesn't we park immediately.
+static iree_duration_t iree_task_worker_adaptive_spin_ns(
+    iree_task_worker_t* worker) {
+  const iree_duration_t max_spin_ns = worker->executor->worker_spin_ns;
+  if (worker->idle_duration_ns > max_spin_ns) return 0;
+  // Spin for a bit longer than the average so that most arrivals are caught.
+  return iree_min(max_spin_ns, worker->idle_duration_ns * 2);
+}
+
+// Updates the idle duration average of the worker with a new |sample_ns|.
+static void iree_task_worker_record_idle_duration(iree_task_worker_t* worker,
+                                                  iree_duration_t sample_ns) {
+  // Clamp samples so that a single long idle period (such as between
+  // unrelated requests) only temporarily disables spinning.
+  sample_ns = iree_min(sample_ns, worker->executor->worker_spin_ns * 2);
+  worker->idle_duration_ns =
+      worker->idle_duration_ns -
+      (worker->idle_duration_ns >> IREE_TASK_WORKER_IDLE_DURATION_EWMA_SHIFT) +
+      (sample_ns >> IREE_TASK_WORKER_IDLE_DURATION_EWMA_SHIFT);
+}
+
+// Waits until the worker is woken by a post to the |wait_token| of its wake
+// notification. With adaptive spinning enabled the worker first spins for a
+// window tuned from its recent idle durations and only parks in the kernel if
+// nothing arrives in that time.
+static void iree_task_worker_wait_for_wake(iree_task_worker_t* worker,
+                                           iree_wait_token_t wait_token) {
+  IREE_METRIC_ADD(iree_task_worker_idle_waits_metric, 1);
+  iree_task_executor_t* executor = worker->executor;
+  if (!iree_all_bits_set(executor->scheduling_mode,
+                         IREE_TASK_SCHEDULING_MODE_ADAPTIVE_WORKER_SPIN)) {
+    // Spin/wait in the kernel. We don't care if the condition fails as we're
+    // just using it as a pulse.
+    IREE_TRACE_ZONE_BEGIN_NAMED(z_wait, "iree_task_worker_main_pump_wake_wait");
+    iree_notification_commit_wait(&worker->wake_notification, wait_token,
+                                  /*spin_ns=*/executor->worker_spin_ns,
+                                  /*deadline_ns=*/IREE_TIME_INFINITE_FUTURE);
+    IREE_TRACE_ZONE_END(z_wait);
+    return;
+  }
+
+  const iree_time_t idle_start_ns = iree_time_now();
+  if (iree_task_worker_spin_for_wake(
+          worker, iree_task_worker_adaptive_spin_ns(worker))) {
+    iree_notification_cancel_wait(&worker->wake_notification);
+  } else {
+    IREE_TRACE_ZONE_BEGIN_NAMED(z_wait, "iree_task_worker_main_pump_wake_wait");
+    iree_notification_commit_wait(&worker->wake_notification, wait_token,
+                                  /*spin_ns=*/IREE_DURATION_ZERO,
+                                  /*deadline_ns=*/IREE_TIME_INFINITE_FUTURE);
+    IREE_TRACE_ZONE_END(z_wait);
+  }
+  iree_task_worker_record_idle_duration(worker,
+                                        iree_time_now() - idle_start_ns);
+}
+
 // Alternates between pumping ready tasks in the worker queue and waiting
 // for more tasks to arrive. Only returns when the worker has been asked by
 // the executor to exit.
@@ -272,9 +517,10 @@ static void iree_task_worker_pump_until_exit(iree_task_worker_t* worker) {
     iree_wait_token_t wait_token =
         iree_notification_prepare_wait(&worker->wake_notification);
     // The masks are accessed with 'relaxed' order because they are just hints.
-    iree_atomic_task_affinity_set_fetch_and(&worker->executor->worker_idle_mask,
-                                            ~worker->worker_bit,
-                                            iree_memory_order_relaxed);
+    iree_atomic_task_affinity_set_fetch_and(
+        &worker->executor->worker_clusters[worker->cluster_index]
+             .worker_idle_mask,
+        ~worker->worker_bit, iree_memory_order_relaxed);
 
     // Check state to see if we've been asked to exit.
     if (iree_atomic_load_int32(&worker->state, iree_memory_order_acquire) ==
@@ -305,18 +551,19 @@ static void iree_task_worker_pump_until_exit(iree_task_worker_t* worker) {
     // We've finished all the work we have scheduled so set our idle flag.
     // This ensures that if any other thread comes in and wants to give us
     // work we will properly coordinate/wake below.
-    iree_atomic_task_affinity_set_fetch_or(&worker->executor->worker_idle_mask,
-                                           worker->worker_bit,
-                                           iree_memory_order_relaxed);
+    iree_atomic_task_affinity_set_fetch_or(
+        &worker->executor->worker_clusters[worker->cluster_index]
+             .worker_idle_mask,
+        worker->worker_bit, iree_memory_order_relaxed);
 
     // When we encounter a complete lack of work we can self-nominate to check
-    // the global work queue and distribute work to other threads. Only one
-    // coordinator can be running at a time so we also ensure that if another
-    // is doing its work we gracefully wait for it. It's fine to block in here
-    // as the next thing we'd have done is go idle anyway.
+    // the global work queue and distribute work to other threads. Multiple
+    // workers may be coordinating at the same time and each takes whatever
+    // tasks are pending when it looks; if another coordinator posts work to us
+    // while we're in here the wake notification will keep us from sleeping.
 
-    // First self-nominate; this *may* do something or just be ignored (if
-    // another worker is already coordinating).
+    // First self-nominate; this *may* do something or just find nothing (if
+    // another worker already took all pending tasks).
     iree_task_executor_coordinate(worker->executor, worker);
 
     // If nothing has been enqueued since we started this loop (so even
@@ -327,15 +574,7 @@ static void iree_task_worker_pump_until_exit(iree_task_worker_t* worker) {
       // Have more work to do; loop around to try another pump.
       iree_notification_cancel_wait(&worker->wake_notification);
     } else {
-      // Spin/wait in the kernel. We don't care if the condition fails as we're
-      // just using it as a pulse.
-      IREE_TRACE_ZONE_BEGIN_NAMED(z_wait,
-                                  "iree_task_worker_main_pump_wake_wait");
-      iree_notification_commit_wait(
-          &worker->wake_notification, wait_token,
-          /*spin_ns=*/worker->executor->worker_spin_ns,
-          /*deadline_ns=*/IREE_TIME_INFINITE_FUTURE);
-      IREE_TRACE_ZONE_END(z_wait);
+      iree_task_worker_wait_for_wake(worker, wait_token);
 
       // Woke from a wait - query the processor ID in case we migrated during
       // the sleep.
@@ -354,12 +593,22 @@ static int iree_task_worker_main(iree_task_worker_t* worker) {
 
   // We cannot rely on the global process settings for FPU state.
   // Be explicit here on what we need.
-  iree_fpu_state_push(IREE_FPU_STATE_FLAG_FLUSH_DENORMALS_TO_ZERO);
+  worker->fpu_state =
+      iree_fpu_state_push(IREE_FPU_STATE_FLAG_FLUSH_DENORMALS_TO_ZERO);
 
   // Reset affinity (as it can change over time).
   // TODO(benvanik): call this after waking in case CPU hotplugging happens.
   iree_thread_request_affinity(worker->thread, worker->ideal_thread_affinity);
 
+  // Touch the worker local memory from the worker thread now that it is
+  // (hopefully) running on its ideal processor. The executor does not touch the
+  // memory itself so operating systems with first-touch page placement (the
+  // default on Linux and Windows) will back it with memory from the NUMA node
+  // of the worker.
+  if (worker->local_memory.data_length) {
+    memset(worker->local_memory.data, 0, worker->local_memory.data_length);
+  }
+
   // Enter the running state immediately. Note that we could have been requested
   // to exit while suspended/still starting up, so check that here before we
   // mess with any data structures.
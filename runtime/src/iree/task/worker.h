@@ -11,6 +11,7 @@
 #include <stdint.h>
 
 #include "iree/base/api.h"
+#include "iree/base/internal/fpu_state.h"
 #include "iree/base/internal/prng.h"
 #include "iree/base/internal/synchronization.h"
 #include "iree/base/internal/threading.h"
@@ -64,6 +65,13 @@ typedef struct iree_task_worker_t {
   // LAYOUT: must be 64b away from local_task_queue.
   iree_atomic_task_slist_t mailbox_slist;
 
+  // A bitmask of task priority classes (1 << iree_task_priority_t) that have
+  // been posted to the mailbox since the worker last flushed it. Used as a hint
+  // that the worker should look at its mailbox before continuing with lower
+  // priority work.
+  // LAYOUT: next to mailbox_slist as posters always touch both.
+  iree_atomic_int32_t mailbox_priority_mask;
+
   // Current state of the worker (iree_task_worker_state_t).
   // LAYOUT: frequent access; next to wake_notification as they are always
   //         accessed together.
@@ -85,29 +93,54 @@ typedef struct iree_task_worker_t {
   // Globally unique worker index (worker_base_index + local worker_index).
   iree_host_size_t worker_index;
 
+  // Index of the worker cluster within the owning executor.
+  iree_host_size_t cluster_index;
+
   // Bit the worker represents in the various worker bitsets.
-  // Local to the executor owning the worker.
+  // Local to the worker cluster owning the worker.
   iree_task_affinity_set_t worker_bit;
 
   // Ideal thread affinity for the worker thread.
   iree_thread_affinity_t ideal_thread_affinity;
 
-  // A bitmask of other group indices that share some level of the cache
-  // hierarchy. Workers of this group are more likely to constructively share
-  // some cache levels higher up with these other groups. For example, if the
-  // workers in a group all share an L2 cache then the groups indicated here may
-  // all share the same L3 cache.
+  // A bitmask of other workers within the same cluster that share some level
+  // of the cache hierarchy. Workers of this group are more likely to
+  // constructively share some cache levels higher up with these other groups.
+  // For example, if the workers in a group all share an L2 cache then the
+  // groups indicated here may all share the same L3 cache.
   iree_task_affinity_set_t constructive_sharing_mask;
 
+  // A bitmask of other workers within the same cluster that only share an
+  // outer cache level (such as the L3) with this worker.
+  iree_task_affinity_set_t outer_sharing_mask;
+
+  // Per-cluster masks of the workers that this worker may steal from.
+  // Unless IREE_TASK_SCHEDULING_MODE_ALLOW_REMOTE_NODE_THEFT is set these only
+  // include workers on the same NUMA node as this worker.
+  iree_task_affinity_set_t
+      theft_victim_masks[IREE_TASK_EXECUTOR_MAX_CLUSTER_COUNT];
+
   // Maximum number of attempts to make when trying to steal tasks from other
   // workers. This could be 64 (try stealing from all workers) or just a handful
   // (try stealing from these 3 other cores that share your L3 cache).
   uint32_t max_theft_attempts;
 
+  // Relative speed of the core the worker runs on in units of
+  // IREE_TASK_TOPOLOGY_SPEED_FACTOR_ONE. Scales the number of dispatch tiles
+  // the worker reserves and tasks it steals at a time so that slower cores on
+  // heterogeneous systems don't end up holding work faster ones could finish.
+  uint32_t speed_factor;
+
   // Rotation counter for work stealing (ensures we don't favor one victim).
   // Only ever touched by the worker thread as it steals work.
   iree_prng_minilcg128_state_t theft_prng;
 
+  // Moving average of how long the worker idles between running out of work
+  // and being given more. Used to size the spin window when the executor has
+  // IREE_TASK_SCHEDULING_MODE_ADAPTIVE_WORKER_SPIN set.
+  // Only ever touched by the worker thread as it waits for work.
+  iree_duration_t idle_duration_ns;
+
   // Thread handle of the worker. If the thread has exited the handle will
   // remain valid so that the executor can query its state.
   iree_thread_t* thread;
@@ -121,6 +154,11 @@ typedef struct iree_task_worker_t {
   // An opaque tag used to reduce the cost of processor ID queries.
   iree_cpu_processor_tag_t processor_tag;
 
+  // FPU state of the worker thread established when it starts and updated by
+  // dispatch shards that require a different one.
+  // Only ever touched by the worker thread.
+  iree_fpu_state_t fpu_state;
+
   // Destructive interference padding between the mailbox and local task queue
   // to ensure that the worker - who is pounding on local_task_queue - doesn't
   // contend with submissions or coordinators dropping new tasks in the mailbox.
@@ -135,9 +173,17 @@ typedef struct iree_task_worker_t {
 
   // Pointer to local memory available for use exclusively by the worker.
   // The base address should be aligned to avoid false sharing with other
-  // workers.
+  // workers. The memory is first touched by the worker thread so that on
+  // systems with first-touch page placement it is allocated from the NUMA node
+  // the worker is running on.
   iree_byte_span_t local_memory;
 
+  // Local memory allocated by the worker when a dispatch required more than the
+  // executor-provided local memory or NULL if it has not needed to grow. When
+  // allocated |local_memory| references it and it is retained at its
+  // high-water size until the worker is deinitialized.
+  void* grown_local_memory;
+
   // Worker-local FIFO queue containing the tasks that will be processed by the
   // worker. This queue supports work-stealing by other workers if they run out
   // of work of their own.
@@ -157,11 +203,13 @@ static_assert(offsetof(iree_task_worker_t, local_task_queue) >=
 // tasks. Where supported the worker will be created in a suspended state so
 // that we aren't creating a thundering herd on startup:
 // https://en.wikipedia.org/wiki/Thundering_herd_problem
+//
+// |topology| is the topology used to create the executor and the worker will
+// use the group at |worker_index| for its configuration.
 iree_status_t iree_task_worker_initialize(
     iree_task_executor_t* executor, iree_host_size_t worker_index,
-    const iree_task_topology_group_t* topology_group,
-    iree_byte_span_t local_memory, iree_prng_splitmix64_state_t* seed_prng,
-    iree_task_worker_t* out_worker);
+    const iree_task_topology_t* topology, iree_byte_span_t local_memory,
+    iree_prng_splitmix64_state_t* seed_prng, iree_task_worker_t* out_worker);
 
 // Requests that the worker begin exiting (if it hasn't already).
 // If the worker is actively processing tasks it will wait until it has
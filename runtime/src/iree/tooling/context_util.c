@@ -17,6 +17,7 @@
 #include "iree/modules/hal/inline/module.h"
 #include "iree/modules/hal/loader/module.h"
 #include "iree/modules/hal/module.h"
+#include "iree/modules/hoisted_cache/module.h"
 #include "iree/tooling/device_util.h"
 #include "iree/vm/bytecode_module.h"
 
@@ -35,6 +36,20 @@
 IREE_FLAG(string, module_file, "-",
           "File containing the module to load. Defaults to stdin (`-`).");
 
+IREE_FLAG(string, module_parameters_file, "",
+          "File containing the rodata of a module compiled with\n"
+          "`--iree-vm-bytecode-module-parameter-file=`. The file is mapped\n"
+          "and constants are paged in as they are uploaded to devices.");
+
+IREE_FLAG(bool, module_prefetch_rodata, false,
+          "Hints that module rodata should be paged in ahead of first use.\n"
+          "Useful with large memory-mapped modules to overlap page faults on\n"
+          "constants with startup work.");
+
+IREE_FLAG(bool, module_release_uploaded_rodata, false,
+          "Hints that module rodata pages can be reclaimed once the constants\n"
+          "have been uploaded into device buffers.");
+
 iree_status_t iree_tooling_load_module_from_flags(
     iree_vm_instance_t* instance, iree_allocator_t host_allocator,
     iree_vm_module_t** out_module) {
@@ -44,9 +59,8 @@ iree_status_t iree_tooling_load_module_from_flags(
   IREE_TRACE_ZONE_BEGIN(z0);
   IREE_TRACE_ZONE_APPEND_TEXT(z0, FLAG_module_file);
 
-  // Fetch the file contents into memory.
-  // We could map the memory here if we wanted to and were coming from a file
-  // on disk.
+  // Fetch the file contents into memory. Files on disk are mapped so that
+  // large embedded constants are referenced in-place without a copy.
   iree_file_contents_t* file_contents = NULL;
   if (strcmp(FLAG_module_file, "-") == 0) {
     // Reading from stdin. We print it out here because people often get
@@ -56,21 +70,41 @@ iree_status_t iree_tooling_load_module_from_flags(
         z0, iree_stdin_read_contents(host_allocator, &file_contents));
   } else {
     IREE_RETURN_AND_END_ZONE_IF_ERROR(
-        z0, iree_file_read_contents(FLAG_module_file, host_allocator,
-                                    &file_contents));
+        z0, iree_file_map_contents(FLAG_module_file, host_allocator,
+                                   &file_contents));
+  }
+
+  // Map the parameter file, if any, holding externalized module rodata.
+  iree_file_contents_t* parameter_contents = NULL;
+  iree_status_t status = iree_ok_status();
+  if (strlen(FLAG_module_parameters_file) > 0) {
+    status = iree_file_map_contents(FLAG_module_parameters_file,
+                                    host_allocator, &parameter_contents);
   }
 
   // Try to load the module as bytecode (all we have today that we can use).
   // We could sniff the file ID and switch off to other module types.
   // The module takes ownership of the file contents (when successful).
   iree_vm_module_t* module = NULL;
-  iree_status_t status = iree_vm_bytecode_module_create(
-      instance, file_contents->const_buffer,
-      iree_file_contents_deallocator(file_contents), host_allocator, &module);
+  if (iree_status_is_ok(status)) {
+    status = iree_vm_bytecode_module_create_with_parameters(
+        instance, file_contents->const_buffer,
+        iree_file_contents_deallocator(file_contents),
+        parameter_contents ? parameter_contents->const_buffer
+                           : iree_const_byte_span_empty(),
+        parameter_contents ? iree_file_contents_deallocator(parameter_contents)
+                           : iree_allocator_null(),
+        host_allocator, &module);
+  }
 
   if (iree_status_is_ok(status)) {
+    if (FLAG_module_prefetch_rodata) {
+      iree_status_ignore(iree_vm_bytecode_module_advise_rodata(
+          module, IREE_VM_BUFFER_ADVICE_WILL_NEED));
+    }
     *out_module = module;
   } else {
+    iree_file_contents_free(parameter_contents);
     iree_file_contents_free(file_contents);
   }
   IREE_TRACE_ZONE_END(z0);
@@ -120,6 +154,9 @@ static iree_status_t iree_tooling_load_hal_async_module(
 
   // Create HAL module wrapping the device created above.
   iree_hal_module_flags_t flags = IREE_HAL_MODULE_FLAG_NONE;
+  if (FLAG_module_release_uploaded_rodata) {
+    flags |= IREE_HAL_MODULE_FLAG_RELEASE_UPLOADED_RODATA;
+  }
   iree_vm_module_t* module = NULL;
   iree_status_t status =
       iree_hal_module_create(instance, device, flags, host_allocator, &module);
@@ -239,6 +276,11 @@ static iree_status_t iree_tooling_load_hal_loader_module(
 // Module management
 //===----------------------------------------------------------------------===//
 
+IREE_FLAG(string, hoisted_cache_dir, "",
+          "Directory used by programs compiled with\n"
+          "--iree-opt-cache-hoisted-globals to cache the results of their\n"
+          "global initializers across loads. Empty disables caching.");
+
 void iree_tooling_module_list_initialize(iree_tooling_module_list_t* out_list) {
   out_list->capacity = IREE_ARRAYSIZE(out_list->values);
   out_list->count = 0;
@@ -325,6 +367,11 @@ static iree_status_t iree_tooling_resolve_module_dependency(
   } else if (iree_string_view_equal(dependency->name, IREE_SV("vmvx"))) {
     IREE_RETURN_IF_ERROR(iree_vmvx_module_create(
         state->instance, state->host_allocator, &module));
+  } else if (iree_string_view_equal(dependency->name,
+                                    IREE_SV("hoisted_cache"))) {
+    IREE_RETURN_IF_ERROR(iree_hoisted_cache_module_create(
+        state->instance, iree_make_cstring_view(FLAG_hoisted_cache_dir),
+        state->host_allocator, &module));
   } else if (iree_all_bits_set(dependency->flags,
                                IREE_VM_MODULE_DEPENDENCY_FLAG_REQUIRED)) {
     // Required but not found; fail.
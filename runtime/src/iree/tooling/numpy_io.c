@@ -295,6 +295,62 @@ static iree_status_t iree_numpy_parse_shape_dims(iree_string_view_t shape,
   return iree_ok_status();
 }
 
+// Maximum supported rank of an ndarray.
+#define IREE_NUMPY_NPY_MAX_SHAPE_RANK 128
+
+// Array metadata parsed from the npy header dict.
+typedef struct iree_numpy_npy_header_t {
+  iree_hal_element_type_t element_type;
+  iree_hal_encoding_type_t encoding_type;
+  iree_host_size_t shape_rank;
+  iree_hal_dim_t shape[IREE_NUMPY_NPY_MAX_SHAPE_RANK];
+} iree_numpy_npy_header_t;
+
+// Parses the npy |header| dict string into |out_header|.
+static iree_status_t iree_numpy_npy_parse_header_dict(
+    iree_string_view_t header, iree_numpy_npy_header_t* out_header) {
+  out_header->element_type = IREE_HAL_ELEMENT_TYPE_NONE;
+  out_header->encoding_type = IREE_HAL_ENCODING_TYPE_OPAQUE;
+  out_header->shape_rank = 0;
+
+  // It look something like this:
+  //   {'descr': '|i1', 'fortran_order': False, 'shape': (2, 2, 1), }
+  // The spec says that although the keys should be sorted alphabetically that's
+  // not a requirement (yuck) and we have to handle out-of-order keys. There may
+  // also be keys we don't understand such as when what's saved is a pickled
+  // object. We implement a basic scanning parser here and try to deal with it.
+  header = iree_string_view_trim(header);
+  iree_string_view_consume_prefix(&header, IREE_SV("{"));
+  iree_string_view_consume_suffix(&header, IREE_SV("}"));
+  while (!iree_string_view_is_empty(header)) {
+    // header => 'key': value{, header}
+    iree_string_view_t key, value;
+    IREE_RETURN_IF_ERROR(
+        iree_numpy_consume_dict_key_value(&header, &key, &value));
+    if (iree_string_view_equal(key, IREE_SV("descr"))) {
+      IREE_RETURN_IF_ERROR(
+          iree_numpy_descr_to_element_type(value, &out_header->element_type));
+    } else if (iree_string_view_equal(key, IREE_SV("fortran_order"))) {
+      if (!iree_string_view_equal(value, IREE_SV("False"))) {
+        return iree_make_status(IREE_STATUS_UNIMPLEMENTED,
+                                "fortran order arrays not supported");
+      }
+      out_header->encoding_type = IREE_HAL_ENCODING_TYPE_DENSE_ROW_MAJOR;
+    } else if (iree_string_view_equal(key, IREE_SV("shape"))) {
+      out_header->shape_rank = iree_numpy_parse_shape_rank(value);
+      if (out_header->shape_rank > IREE_NUMPY_NPY_MAX_SHAPE_RANK) {
+        return iree_make_status(IREE_STATUS_INVALID_ARGUMENT,
+                                "shape rank %" PRIhsz
+                                " too large; be reasonable please",
+                                out_header->shape_rank);
+      }
+      IREE_RETURN_IF_ERROR(iree_numpy_parse_shape_dims(
+          value, out_header->shape_rank, out_header->shape));
+    }
+  }
+  return iree_ok_status();
+}
+
 IREE_API_EXPORT iree_status_t
 iree_numpy_npy_load_ndarray(FILE* stream, iree_numpy_npy_load_options_t options,
                             iree_hal_buffer_params_t buffer_params,
@@ -328,47 +384,9 @@ iree_numpy_npy_load_ndarray(FILE* stream, iree_numpy_npy_load_options_t options,
       iree_make_string_view(header_buffer, header_length));
 
   // Parse the header.
-  // It look something like this:
-  //   {'descr': '|i1', 'fortran_order': False, 'shape': (2, 2, 1), }
-  // The spec says that although the keys should be sorted alphabetically that's
-  // not a requirement (yuck) and we have to handle out-of-order keys. There may
-  // also be keys we don't understand such as when what's saved is a pickled
-  // object. We implement a basic scanning parser here and try to deal with it.
-  iree_status_t status = iree_ok_status();
-  iree_host_size_t shape_rank = 0;
-  iree_hal_dim_t* shape = NULL;
-  iree_hal_element_type_t element_type = IREE_HAL_ELEMENT_TYPE_NONE;
-  iree_hal_encoding_type_t encoding_type = IREE_HAL_ENCODING_TYPE_OPAQUE;
-  iree_string_view_consume_prefix(&header, IREE_SV("{"));
-  iree_string_view_consume_suffix(&header, IREE_SV("}"));
-  while (!iree_string_view_is_empty(header)) {
-    // header => 'key': value{, header}
-    iree_string_view_t key, value;
-    status = iree_numpy_consume_dict_key_value(&header, &key, &value);
-    if (!iree_status_is_ok(status)) break;
-
-    if (iree_string_view_equal(key, IREE_SV("descr"))) {
-      status = iree_numpy_descr_to_element_type(value, &element_type);
-    } else if (iree_string_view_equal(key, IREE_SV("fortran_order"))) {
-      if (iree_string_view_equal(value, IREE_SV("False"))) {
-        encoding_type = IREE_HAL_ENCODING_TYPE_DENSE_ROW_MAJOR;
-      } else {
-        status = iree_make_status(IREE_STATUS_UNIMPLEMENTED,
-                                  "fortran order arrays not supported");
-      }
-    } else if (iree_string_view_equal(key, IREE_SV("shape"))) {
-      shape_rank = iree_numpy_parse_shape_rank(value);
-      if (shape_rank > 128) {
-        status = iree_make_status(IREE_STATUS_INVALID_ARGUMENT,
-                                  "shape rank %" PRIhsz
-                                  " too large; be reasonable please");
-      } else {
-        shape = iree_alloca(shape_rank * sizeof(*shape));
-        status = iree_numpy_parse_shape_dims(value, shape_rank, shape);
-      }
-    }
-    if (!iree_status_is_ok(status)) break;
-  }
+  iree_numpy_npy_header_t parsed_header;
+  iree_status_t status =
+      iree_numpy_npy_parse_header_dict(header, &parsed_header);
 
   // Allocate the buffer view and directly read into the allocated memory.
   // On targets where we can perform host mapping this will be zero-copy; on
@@ -379,9 +397,9 @@ iree_numpy_npy_load_ndarray(FILE* stream, iree_numpy_npy_load_options_t options,
     };
     buffer_params.access |= IREE_HAL_MEMORY_ACCESS_DISCARD_WRITE;
     status = iree_hal_buffer_view_generate_buffer(
-        device_allocator, shape_rank, shape, element_type, encoding_type,
-        buffer_params, iree_numpy_npy_read_into_mapping, &read_params,
-        out_buffer_view);
+        device_allocator, parsed_header.shape_rank, parsed_header.shape,
+        parsed_header.element_type, parsed_header.encoding_type, buffer_params,
+        iree_numpy_npy_read_into_mapping, &read_params, out_buffer_view);
   }
 
   iree_allocator_free(host_allocator, header_buffer);
@@ -389,6 +407,188 @@ iree_numpy_npy_load_ndarray(FILE* stream, iree_numpy_npy_load_options_t options,
   return status;
 }
 
+// Consumes the npy header from the front of |contents| and returns a view of
+// the header dict string in |out_header|. Upon successful return |contents|
+// begins with the array payload.
+static iree_status_t iree_numpy_npy_consume_header_span(
+    iree_const_byte_span_t* contents, iree_string_view_t* out_header) {
+  if (contents->data_length < 10) {
+    return iree_make_status(IREE_STATUS_RESOURCE_EXHAUSTED,
+                            "unable to read entire header prefix");
+  }
+  static const uint8_t kMagicBytes[6] = {0x93, 'N', 'U', 'M', 'P', 'Y'};
+  if (memcmp(contents->data, kMagicBytes, sizeof(kMagicBytes)) != 0) {
+    return iree_make_status(IREE_STATUS_INVALID_ARGUMENT,
+                            "npy header magic mismatch");
+  }
+  uint8_t version_major = contents->data[6];
+  uint8_t version_minor = contents->data[7];
+  if (version_major <= 0 || version_major > 3) {
+    return iree_make_status(IREE_STATUS_UNIMPLEMENTED,
+                            "npy version %d.%d not supported", version_major,
+                            version_minor);
+  }
+
+  // Little-endian 2- or 4-byte header length; see iree_numpy_npy_read_header.
+  iree_host_size_t prefix_length = 0;
+  iree_host_size_t header_length = 0;
+  if (version_major == 1) {
+    prefix_length = 10;
+    header_length = (iree_host_size_t)contents->data[8] |
+                    ((iree_host_size_t)contents->data[9] << 8);
+  } else {
+    prefix_length = 12;
+    if (contents->data_length < prefix_length) {
+      return iree_make_status(
+          IREE_STATUS_RESOURCE_EXHAUSTED,
+          "failed to read version %d.%d 4-byte header length", version_major,
+          version_minor);
+    }
+    header_length = (iree_host_size_t)contents->data[8] |
+                    ((iree_host_size_t)contents->data[9] << 8) |
+                    ((iree_host_size_t)contents->data[10] << 16) |
+                    ((iree_host_size_t)contents->data[11] << 24);
+  }
+  if (contents->data_length - prefix_length < header_length) {
+    return iree_make_status(
+        IREE_STATUS_RESOURCE_EXHAUSTED,
+        "failed to read header string of %" PRIhsz " bytes", header_length);
+  }
+
+  *out_header = iree_make_string_view(
+      (const char*)contents->data + prefix_length, header_length);
+  contents->data += prefix_length + header_length;
+  contents->data_length -= prefix_length + header_length;
+  return iree_ok_status();
+}
+
+// Tries to import |payload| as a buffer view without copying.
+// Returns IREE_STATUS_UNAVAILABLE if |device_allocator| cannot use the host
+// memory directly, such as when it is not aligned or is not host-accessible by
+// the device. |out_imported| is set if a buffer was created, in which case the
+// |release_callback| is owned by it even if creating the view failed.
+static iree_status_t iree_numpy_npy_import_payload(
+    iree_const_byte_span_t payload, const iree_numpy_npy_header_t* header,
+    iree_hal_buffer_params_t buffer_params,
+    iree_hal_allocator_t* device_allocator,
+    iree_hal_buffer_release_callback_t release_callback, bool* out_imported,
+    iree_hal_buffer_view_t** out_buffer_view) {
+  *out_imported = false;
+
+  // The payload is usually a read-only file mapping and any write would fault.
+  if (iree_any_bit_set(buffer_params.access, IREE_HAL_MEMORY_ACCESS_WRITE)) {
+    return iree_make_status(IREE_STATUS_UNAVAILABLE,
+                            "mapped npy contents are read-only");
+  }
+
+  iree_hal_external_buffer_t external_buffer;
+  memset(&external_buffer, 0, sizeof(external_buffer));
+  external_buffer.type = IREE_HAL_EXTERNAL_BUFFER_TYPE_HOST_ALLOCATION;
+  external_buffer.flags = IREE_HAL_EXTERNAL_BUFFER_FLAG_NONE;
+  external_buffer.size = payload.data_length;
+  external_buffer.handle.host_allocation.ptr = (void*)payload.data;
+  iree_hal_buffer_t* buffer = NULL;
+  iree_status_t status = iree_hal_allocator_import_buffer(
+      device_allocator, buffer_params, &external_buffer, release_callback,
+      &buffer);
+  if (!iree_status_is_ok(status)) {
+    // Any failure to import is treated as the allocator not supporting it so
+    // that the caller falls back to copying.
+    return iree_status_join(
+        iree_make_status(IREE_STATUS_UNAVAILABLE, "npy import unavailable"),
+        status);
+  }
+  *out_imported = true;
+
+  status = iree_hal_buffer_view_create(
+      buffer, header->shape_rank, header->shape, header->element_type,
+      header->encoding_type,
+      iree_hal_allocator_host_allocator(device_allocator), out_buffer_view);
+  iree_hal_buffer_release(buffer);
+  return status;
+}
+
+IREE_API_EXPORT iree_status_t iree_numpy_npy_load_ndarray_from_memory(
+    iree_const_byte_span_t* contents, iree_numpy_npy_load_options_t options,
+    iree_hal_buffer_params_t buffer_params,
+    iree_hal_allocator_t* device_allocator,
+    iree_hal_buffer_release_callback_t release_callback,
+    iree_hal_buffer_view_t** out_buffer_view) {
+  IREE_ASSERT_ARGUMENT(contents);
+  IREE_ASSERT_ARGUMENT(device_allocator);
+  IREE_ASSERT_ARGUMENT(out_buffer_view);
+  *out_buffer_view = NULL;
+  IREE_TRACE_ZONE_BEGIN(z0);
+
+  if (contents->data_length == 0) {
+    if (release_callback.fn) {
+      release_callback.fn(release_callback.user_data, NULL);
+    }
+    IREE_TRACE_ZONE_END(z0);
+    return iree_make_status(IREE_STATUS_OUT_OF_RANGE, "end-of-file");
+  }
+
+  // Parse the header and slice off the payload.
+  iree_const_byte_span_t remaining = *contents;
+  iree_string_view_t header_dict = iree_string_view_empty();
+  iree_numpy_npy_header_t header;
+  iree_device_size_t payload_length = 0;
+  iree_status_t status =
+      iree_numpy_npy_consume_header_span(&remaining, &header_dict);
+  if (iree_status_is_ok(status)) {
+    status = iree_numpy_npy_parse_header_dict(header_dict, &header);
+  }
+  if (iree_status_is_ok(status)) {
+    status = iree_hal_buffer_compute_view_size(
+        header.shape_rank, header.shape, header.element_type,
+        header.encoding_type, &payload_length);
+  }
+  if (iree_status_is_ok(status) && remaining.data_length < payload_length) {
+    status = iree_make_status(IREE_STATUS_RESOURCE_EXHAUSTED,
+                              "failed to read npy contents of %" PRIdsz
+                              " bytes",
+                              payload_length);
+  }
+  iree_const_byte_span_t payload =
+      iree_make_const_byte_span(remaining.data, (iree_host_size_t)0);
+  if (iree_status_is_ok(status)) {
+    payload.data_length = (iree_host_size_t)payload_length;
+  }
+
+  // Reference the payload in-place if requested and possible.
+  bool imported = false;
+  if (iree_status_is_ok(status) &&
+      iree_all_bits_set(options, IREE_NUMPY_NPY_LOAD_OPTION_MAP_FILE)) {
+    iree_status_t import_status = iree_numpy_npy_import_payload(
+        payload, &header, buffer_params, device_allocator, release_callback,
+        &imported, out_buffer_view);
+    if (iree_status_is_unavailable(import_status)) {
+      iree_status_ignore(import_status);
+    } else {
+      status = import_status;
+    }
+  }
+
+  // Otherwise copy into a new allocation.
+  if (iree_status_is_ok(status) && !imported) {
+    status = iree_hal_buffer_view_allocate_buffer(
+        device_allocator, header.shape_rank, header.shape,
+        header.element_type, header.encoding_type, buffer_params, payload,
+        out_buffer_view);
+  }
+
+  if (iree_status_is_ok(status)) {
+    contents->data = payload.data + payload.data_length;
+    contents->data_length = remaining.data_length - payload.data_length;
+  }
+  // The contents are no longer referenced unless they were imported.
+  if (!imported && release_callback.fn) {
+    release_callback.fn(release_callback.user_data, NULL);
+  }
+  IREE_TRACE_ZONE_END(z0);
+  return status;
+}
+
 // Builds a dtype string from |buffer_view|.
 static iree_status_t iree_numpy_npy_build_dtype(
     iree_hal_buffer_view_t* buffer_view, iree_string_builder_t* builder) {
@@ -625,3 +825,278 @@ IREE_API_EXPORT iree_status_t iree_numpy_npy_save_ndarray(
   IREE_TRACE_ZONE_END(z0);
   return status;
 }
+
+//===----------------------------------------------------------------------===//
+// .npz (zip archive of .npy files)
+//===----------------------------------------------------------------------===//
+
+// File format spec:
+// https://pkware.cachefly.net/webdocs/casestudies/APPNOTE.TXT
+//
+// numpy.savez writes a zip archive with one `<name>.npy` member per array.
+// Only the central directory at the end of the archive is parsed up front and
+// member contents are not touched until they are loaded. numpy always writes
+// ZIP64 records (`force_zip64=True`) so those are handled as well.
+
+#define IREE_NUMPY_ZIP_LOCAL_HEADER_SIGNATURE 0x04034B50u
+#define IREE_NUMPY_ZIP_CENTRAL_HEADER_SIGNATURE 0x02014B50u
+#define IREE_NUMPY_ZIP_END_SIGNATURE 0x06054B50u
+#define IREE_NUMPY_ZIP64_END_SIGNATURE 0x06064B50u
+#define IREE_NUMPY_ZIP64_END_LOCATOR_SIGNATURE 0x07064B50u
+#define IREE_NUMPY_ZIP64_EXTRA_FIELD_ID 0x0001u
+#define IREE_NUMPY_ZIP_METHOD_STORED 0
+
+static uint16_t iree_numpy_zip_read_u16(const uint8_t* ptr) {
+  return (uint16_t)(ptr[0] | (ptr[1] << 8));
+}
+
+static uint32_t iree_numpy_zip_read_u32(const uint8_t* ptr) {
+  return (uint32_t)ptr[0] | ((uint32_t)ptr[1] << 8) |
+         ((uint32_t)ptr[2] << 16) | ((uint32_t)ptr[3] << 24);
+}
+
+static uint64_t iree_numpy_zip_read_u64(const uint8_t* ptr) {
+  return (uint64_t)iree_numpy_zip_read_u32(ptr) |
+         ((uint64_t)iree_numpy_zip_read_u32(ptr + 4) << 32);
+}
+
+// Returns true if the |length| bytes at |offset| are within |contents|.
+static bool iree_numpy_zip_range_is_valid(iree_const_byte_span_t contents,
+                                          uint64_t offset, uint64_t length) {
+  return offset <= contents.data_length &&
+         length <= contents.data_length - offset;
+}
+
+// Locates the central directory of the archive in |contents|.
+static iree_status_t iree_numpy_zip_find_central_directory(
+    iree_const_byte_span_t contents, uint64_t* out_entry_count,
+    uint64_t* out_offset) {
+  // The end of central directory record is 22 bytes followed by a comment of
+  // up to 64KB; scan backwards for its signature.
+  const iree_host_size_t kEndRecordLength = 22;
+  if (contents.data_length < kEndRecordLength) {
+    return iree_make_status(IREE_STATUS_INVALID_ARGUMENT,
+                            "npz archive too small");
+  }
+  iree_host_size_t end_offset = contents.data_length - kEndRecordLength;
+  iree_host_size_t min_offset =
+      end_offset > 0xFFFF ? end_offset - 0xFFFF : 0;
+  while (iree_numpy_zip_read_u32(contents.data + end_offset) !=
+         IREE_NUMPY_ZIP_END_SIGNATURE) {
+    if (end_offset == min_offset) {
+      return iree_make_status(IREE_STATUS_INVALID_ARGUMENT,
+                              "npz end of central directory not found");
+    }
+    --end_offset;
+  }
+  const uint8_t* end_record = contents.data + end_offset;
+  *out_entry_count = iree_numpy_zip_read_u16(end_record + 10);
+  *out_offset = iree_numpy_zip_read_u32(end_record + 16);
+  if (*out_entry_count != 0xFFFF && *out_offset != 0xFFFFFFFFu) {
+    return iree_ok_status();
+  }
+
+  // ZIP64: the locator immediately precedes the end record and points at the
+  // ZIP64 end of central directory record holding the full values.
+  const iree_host_size_t kZip64LocatorLength = 20;
+  if (end_offset < kZip64LocatorLength ||
+      iree_numpy_zip_read_u32(end_record - kZip64LocatorLength) !=
+          IREE_NUMPY_ZIP64_END_LOCATOR_SIGNATURE) {
+    return iree_make_status(IREE_STATUS_INVALID_ARGUMENT,
+                            "npz ZIP64 end of central directory missing");
+  }
+  uint64_t zip64_end_offset =
+      iree_numpy_zip_read_u64(end_record - kZip64LocatorLength + 8);
+  if (!iree_numpy_zip_range_is_valid(contents, zip64_end_offset, 56) ||
+      iree_numpy_zip_read_u32(contents.data + zip64_end_offset) !=
+          IREE_NUMPY_ZIP64_END_SIGNATURE) {
+    return iree_make_status(IREE_STATUS_INVALID_ARGUMENT,
+                            "npz ZIP64 end of central directory invalid");
+  }
+  const uint8_t* zip64_end_record = contents.data + zip64_end_offset;
+  *out_entry_count = iree_numpy_zip_read_u64(zip64_end_record + 32);
+  *out_offset = iree_numpy_zip_read_u64(zip64_end_record + 48);
+  return iree_ok_status();
+}
+
+// Parses the central directory file header at |*offset| into |out_entry| and
+// advances |offset| to the next header.
+static iree_status_t iree_numpy_zip_parse_central_header(
+    iree_const_byte_span_t contents, uint64_t* offset,
+    iree_numpy_npz_entry_t* out_entry) {
+  const uint64_t kHeaderLength = 46;
+  if (!iree_numpy_zip_range_is_valid(contents, *offset, kHeaderLength) ||
+      iree_numpy_zip_read_u32(contents.data + *offset) !=
+          IREE_NUMPY_ZIP_CENTRAL_HEADER_SIGNATURE) {
+    return iree_make_status(IREE_STATUS_INVALID_ARGUMENT,
+                            "npz central directory header invalid");
+  }
+  const uint8_t* header = contents.data + *offset;
+  uint16_t method = iree_numpy_zip_read_u16(header + 10);
+  uint64_t compressed_size = iree_numpy_zip_read_u32(header + 20);
+  uint64_t uncompressed_size = iree_numpy_zip_read_u32(header + 24);
+  uint16_t name_length = iree_numpy_zip_read_u16(header + 28);
+  uint16_t extra_length = iree_numpy_zip_read_u16(header + 30);
+  uint16_t comment_length = iree_numpy_zip_read_u16(header + 32);
+  uint64_t local_header_offset = iree_numpy_zip_read_u32(header + 42);
+  if (!iree_numpy_zip_range_is_valid(
+          contents, *offset + kHeaderLength,
+          (uint64_t)name_length + extra_length + comment_length)) {
+    return iree_make_status(IREE_STATUS_INVALID_ARGUMENT,
+                            "npz central directory header truncated");
+  }
+
+  // Values that did not fit are stored in order in the ZIP64 extra field.
+  const uint8_t* extra = header + kHeaderLength + name_length;
+  const uint8_t* extra_end = extra + extra_length;
+  while (extra + 4 <= extra_end) {
+    uint16_t field_id = iree_numpy_zip_read_u16(extra);
+    uint16_t field_length = iree_numpy_zip_read_u16(extra + 2);
+    const uint8_t* field = extra + 4;
+    const uint8_t* field_end = field + field_length;
+    if (field_end > extra_end) break;
+    if (field_id == IREE_NUMPY_ZIP64_EXTRA_FIELD_ID) {
+      if (uncompressed_size == 0xFFFFFFFFu && field + 8 <= field_end) {
+        uncompressed_size = iree_numpy_zip_read_u64(field);
+        field += 8;
+      }
+      if (compressed_size == 0xFFFFFFFFu && field + 8 <= field_end) {
+        compressed_size = iree_numpy_zip_read_u64(field);
+        field += 8;
+      }
+      if (local_header_offset == 0xFFFFFFFFu && field + 8 <= field_end) {
+        local_header_offset = iree_numpy_zip_read_u64(field);
+        field += 8;
+      }
+    }
+    extra = field_end;
+  }
+
+  // The member data follows the local header, whose variable length fields
+  // may differ from those in the central directory.
+  const uint64_t kLocalHeaderLength = 30;
+  if (!iree_numpy_zip_range_is_valid(contents, local_header_offset,
+                                     kLocalHeaderLength) ||
+      iree_numpy_zip_read_u32(contents.data + local_header_offset) !=
+          IREE_NUMPY_ZIP_LOCAL_HEADER_SIGNATURE) {
+    return iree_make_status(IREE_STATUS_INVALID_ARGUMENT,
+                            "npz local file header invalid");
+  }
+  const uint8_t* local_header = contents.data + local_header_offset;
+  uint64_t data_offset = local_header_offset + kLocalHeaderLength +
+                         iree_numpy_zip_read_u16(local_header + 26) +
+                         iree_numpy_zip_read_u16(local_header + 28);
+  if (!iree_numpy_zip_range_is_valid(contents, data_offset, compressed_size)) {
+    return iree_make_status(IREE_STATUS_INVALID_ARGUMENT,
+                            "npz member data truncated");
+  }
+
+  // Arrays are named by their member name without the .npy extension.
+  out_entry->name =
+      iree_make_string_view((const char*)header + kHeaderLength, name_length);
+  iree_string_view_consume_suffix(&out_entry->name, IREE_SV(".npy"));
+  out_entry->compressed = method != IREE_NUMPY_ZIP_METHOD_STORED ||
+                          compressed_size != uncompressed_size;
+  out_entry->contents = iree_make_const_byte_span(
+      contents.data + data_offset, (iree_host_size_t)compressed_size);
+  *offset += kHeaderLength + name_length + extra_length + comment_length;
+  return iree_ok_status();
+}
+
+IREE_API_EXPORT iree_status_t iree_numpy_npz_archive_initialize(
+    iree_const_byte_span_t contents, iree_allocator_t host_allocator,
+    iree_numpy_npz_archive_t* out_archive) {
+  IREE_ASSERT_ARGUMENT(out_archive);
+  IREE_TRACE_ZONE_BEGIN(z0);
+  memset(out_archive, 0, sizeof(*out_archive));
+  out_archive->host_allocator = host_allocator;
+  out_archive->contents = contents;
+
+  uint64_t entry_count = 0;
+  uint64_t directory_offset = 0;
+  iree_status_t status = iree_numpy_zip_find_central_directory(
+      contents, &entry_count, &directory_offset);
+  // Each central directory header is at least 46 bytes; reject counts that
+  // could not possibly fit before allocating storage for them.
+  if (iree_status_is_ok(status) && entry_count > contents.data_length / 46) {
+    status = iree_make_status(IREE_STATUS_INVALID_ARGUMENT,
+                              "npz entry count %" PRIu64 " invalid",
+                              entry_count);
+  }
+  if (iree_status_is_ok(status) && entry_count > 0) {
+    status = iree_allocator_malloc(
+        host_allocator,
+        (iree_host_size_t)entry_count * sizeof(*out_archive->entries),
+        (void**)&out_archive->entries);
+  }
+  for (uint64_t i = 0; i < entry_count && iree_status_is_ok(status); ++i) {
+    status = iree_numpy_zip_parse_central_header(contents, &directory_offset,
+                                                 &out_archive->entries[i]);
+    if (iree_status_is_ok(status)) ++out_archive->entry_count;
+  }
+
+  if (!iree_status_is_ok(status)) {
+    iree_numpy_npz_archive_deinitialize(out_archive);
+  }
+  IREE_TRACE_ZONE_END(z0);
+  return status;
+}
+
+IREE_API_EXPORT void iree_numpy_npz_archive_deinitialize(
+    iree_numpy_npz_archive_t* archive) {
+  IREE_ASSERT_ARGUMENT(archive);
+  iree_allocator_free(archive->host_allocator, archive->entries);
+  memset(archive, 0, sizeof(*archive));
+}
+
+IREE_API_EXPORT iree_status_t iree_numpy_npz_archive_find_entry(
+    const iree_numpy_npz_archive_t* archive, iree_string_view_t name,
+    iree_host_size_t* out_index) {
+  IREE_ASSERT_ARGUMENT(archive);
+  IREE_ASSERT_ARGUMENT(out_index);
+  for (iree_host_size_t i = 0; i < archive->entry_count; ++i) {
+    if (iree_string_view_equal(archive->entries[i].name, name)) {
+      *out_index = i;
+      return iree_ok_status();
+    }
+  }
+  return iree_make_status(IREE_STATUS_NOT_FOUND,
+                          "npz archive has no array named '%.*s'",
+                          (int)name.size, name.data);
+}
+
+IREE_API_EXPORT iree_status_t iree_numpy_npz_archive_load_entry(
+    const iree_numpy_npz_archive_t* archive, iree_host_size_t index,
+    iree_numpy_npy_load_options_t options,
+    iree_hal_buffer_params_t buffer_params,
+    iree_hal_allocator_t* device_allocator,
+    iree_hal_buffer_release_callback_t release_callback,
+    iree_hal_buffer_view_t** out_buffer_view) {
+  IREE_ASSERT_ARGUMENT(archive);
+  IREE_ASSERT_ARGUMENT(out_buffer_view);
+  *out_buffer_view = NULL;
+  iree_status_t status = iree_ok_status();
+  if (index >= archive->entry_count) {
+    status = iree_make_status(IREE_STATUS_OUT_OF_RANGE,
+                              "npz entry %" PRIhsz " out of range (%" PRIhsz
+                              " entries)",
+                              index, archive->entry_count);
+  } else if (archive->entries[index].compressed) {
+    const iree_numpy_npz_entry_t* entry = &archive->entries[index];
+    status = iree_make_status(IREE_STATUS_UNIMPLEMENTED,
+                              "npz array '%.*s' is compressed; only "
+                              "uncompressed archives (numpy.savez) are "
+                              "supported",
+                              (int)entry->name.size, entry->name.data);
+  }
+  if (!iree_status_is_ok(status)) {
+    if (release_callback.fn) {
+      release_callback.fn(release_callback.user_data, NULL);
+    }
+    return status;
+  }
+  iree_const_byte_span_t contents = archive->entries[index].contents;
+  return iree_numpy_npy_load_ndarray_from_memory(
+      &contents, options, buffer_params, device_allocator, release_callback,
+      out_buffer_view);
+}
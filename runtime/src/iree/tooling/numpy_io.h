@@ -16,18 +16,23 @@
 // Pickled objects are not supported (similar to using `allow_pickle=False`) and
 // not all dtypes are supported.
 //
-// .npy and uncompressed .npz files can be mapped into host memory with
-// IREE_NUMPY_NPY_LOAD_OPTION_MAP_FILE if the HAL device allocator
-// supports using such memory. On devices with discrete memory the contents will
-// be loaded into host memory and copied to the device.
+// .npy and uncompressed .npz files that are already in memory (usually mapped
+// with iree_file_map_contents) can be imported in-place with
+// IREE_NUMPY_NPY_LOAD_OPTION_MAP_FILE if the HAL device allocator supports
+// using such memory. This makes loading multi-GB inputs effectively free on
+// local devices as pages are only read as they are accessed. On devices with
+// discrete memory (or when the array payload is not suitably aligned) the
+// contents will be copied to the device instead.
+//
+// .npz archives are loaded lazily: only the zip central directory is parsed
+// when the archive is opened and each array is loaded when requested.
 //
 // This current implementation is very basic; in the future it'd be nice to
 // support an iree_io_stream_t to allow for externalizing the file access.
 //
-// NOTE: this implementation is optimized for code size and is not intended to
-// be used in performance-sensitive situations. If you are wanting to run
-// through thousands of arrays and GB of data then you're going to want
-// something more sophisticated (delay loading with async IO, etc).
+// NOTE: the FILE-based routines are optimized for code size and are not
+// intended to be used in performance-sensitive situations. Prefer the
+// in-memory variants with a mapped file for large inputs.
 //
 // TODO(benvanik): conditionally enable compression when zlib is present. For
 // now to reduce dependencies we don't support loading compressed npz files or
@@ -53,11 +58,12 @@ extern "C" {
 enum iree_numpy_npy_load_options_bits_t {
   IREE_NUMPY_NPY_LOAD_OPTION_DEFAULT = 0u,
 
-  // Tries to map the file into memory and use the contents directly from the
-  // file system. Only available if the HAL device supports accessing mapped
-  // data.
-  // Like providing `mmap_mode` to `numpy.load`.
-  // May be ignored if the implementation does not support mapping.
+  // Tries to use the contents directly from (usually mapped) memory instead of
+  // copying them into a new allocation. Only available if the HAL device
+  // supports importing host memory and the requested buffer access is
+  // read-only.
+  // Like providing `mmap_mode='r'` to `numpy.load`.
+  // Ignored by the FILE-based routines, which always read into an allocation.
   IREE_NUMPY_NPY_LOAD_OPTION_MAP_FILE = 1u << 0,
 };
 typedef uint32_t iree_numpy_npy_load_options_t;
@@ -72,9 +78,8 @@ typedef uint32_t iree_numpy_npy_save_options_t;
 // On success |out_buffer_view| will have a buffer view matching the parameters
 // in the npy file allocated from the given |device_allocator|.
 //
-// If IREE_NUMPY_NPY_LOAD_OPTION_MAP_FILE is set and the
-// |device_allocator| supports mapping then the file will be mapped into the
-// host process. Otherwise the file will be loaded into a new allocation.
+// The contents are always read into a new allocation; use
+// iree_numpy_npy_load_ndarray_from_memory with a mapped file to avoid the copy.
 //
 // Upon return the |stream| will be positioned immediately following the
 // ndarray contents, which may be end-of-stream.
@@ -89,6 +94,27 @@ iree_numpy_npy_load_ndarray(FILE* stream, iree_numpy_npy_load_options_t options,
                             iree_hal_allocator_t* device_allocator,
                             iree_hal_buffer_view_t** out_buffer_view);
 
+// Loads a single value from the .npy data at the front of |contents| into a
+// buffer view allocated from (or imported into) |device_allocator|.
+//
+// If IREE_NUMPY_NPY_LOAD_OPTION_MAP_FILE is set and |device_allocator| can
+// import the host memory the buffer view references |contents| directly and
+// |release_callback| is issued once the buffer is destroyed. Otherwise the
+// payload is copied into a new allocation and |release_callback| is issued
+// before returning. Either way the callback is issued exactly once (with a
+// NULL buffer if nothing was imported, including on failure) and callers can
+// use it to release what keeps |contents| alive.
+//
+// Upon successful return |contents| is advanced past the ndarray so that
+// concatenated arrays can be loaded in a loop until it is empty.
+// Returns IREE_STATUS_OUT_OF_RANGE if |contents| is empty.
+IREE_API_EXPORT iree_status_t iree_numpy_npy_load_ndarray_from_memory(
+    iree_const_byte_span_t* contents, iree_numpy_npy_load_options_t options,
+    iree_hal_buffer_params_t buffer_params,
+    iree_hal_allocator_t* device_allocator,
+    iree_hal_buffer_release_callback_t release_callback,
+    iree_hal_buffer_view_t** out_buffer_view);
+
 // Saves |buffer_view| to a .npy |stream|.
 // The ndarray will be appended to the stream to produce a concatenated file.
 //
@@ -98,6 +124,64 @@ IREE_API_EXPORT iree_status_t iree_numpy_npy_save_ndarray(
     FILE* stream, iree_numpy_npy_save_options_t options,
     iree_hal_buffer_view_t* buffer_view, iree_allocator_t host_allocator);
 
+//===----------------------------------------------------------------------===//
+// .npz (zip archive of named .npy files)
+//===----------------------------------------------------------------------===//
+
+// An array stored in an .npz archive.
+typedef struct iree_numpy_npz_entry_t {
+  // Array name as passed to `numpy.savez` (the member name without `.npy`).
+  // References the archive contents.
+  iree_string_view_t name;
+  // True if the member is compressed (`numpy.savez_compressed`), which is not
+  // supported for loading.
+  bool compressed;
+  // Member contents holding a single .npy file if not compressed.
+  iree_const_byte_span_t contents;
+} iree_numpy_npz_entry_t;
+
+// The table of contents of an .npz archive in memory.
+typedef struct iree_numpy_npz_archive_t {
+  iree_allocator_t host_allocator;
+  // Archive contents; unowned and must remain valid for the lifetime of the
+  // archive and all arrays imported from it.
+  iree_const_byte_span_t contents;
+  iree_host_size_t entry_count;
+  iree_numpy_npz_entry_t* entries;
+} iree_numpy_npz_archive_t;
+
+// Initializes |out_archive| by parsing the zip central directory of the .npz
+// archive in |contents|. No array contents are accessed until loaded with
+// iree_numpy_npz_archive_load_entry.
+//
+// See `numpy.savez`:
+// https://numpy.org/doc/stable/reference/generated/numpy.savez.html
+IREE_API_EXPORT iree_status_t iree_numpy_npz_archive_initialize(
+    iree_const_byte_span_t contents, iree_allocator_t host_allocator,
+    iree_numpy_npz_archive_t* out_archive);
+
+// Deinitializes |archive|. Arrays imported from it remain valid as long as the
+// archive contents do.
+IREE_API_EXPORT void iree_numpy_npz_archive_deinitialize(
+    iree_numpy_npz_archive_t* archive);
+
+// Returns the |out_index| of the array named |name| in |archive| or
+// IREE_STATUS_NOT_FOUND.
+IREE_API_EXPORT iree_status_t iree_numpy_npz_archive_find_entry(
+    const iree_numpy_npz_archive_t* archive, iree_string_view_t name,
+    iree_host_size_t* out_index);
+
+// Loads the array at |index| in |archive| into a buffer view.
+// Behaves as iree_numpy_npy_load_ndarray_from_memory on the entry contents,
+// including the handling of |release_callback|.
+IREE_API_EXPORT iree_status_t iree_numpy_npz_archive_load_entry(
+    const iree_numpy_npz_archive_t* archive, iree_host_size_t index,
+    iree_numpy_npy_load_options_t options,
+    iree_hal_buffer_params_t buffer_params,
+    iree_hal_allocator_t* device_allocator,
+    iree_hal_buffer_release_callback_t release_callback,
+    iree_hal_buffer_view_t** out_buffer_view);
+
 #ifdef __cplusplus
 }  // extern "C"
 #endif  // __cplusplus
@@ -71,6 +71,15 @@ class NumpyIOTest : public ::testing::Test {
     return NULL;
   }
 
+  static iree_const_byte_span_t GetInputContents(const char* name) {
+    const struct iree_file_toc_t* file_toc = iree_numpy_npy_files_create();
+    for (size_t i = 0; i < iree_numpy_npy_files_size(); ++i) {
+      if (strcmp(file_toc[i].name, name) != 0) continue;
+      return iree_make_const_byte_span(file_toc[i].data, file_toc[i].size);
+    }
+    return iree_const_byte_span_empty();
+  }
+
   FILE* OpenOutputFile(const char* name) {
     auto file_path = GetTempFilename(name);
     return fopen(file_path.c_str(), "w+b");
@@ -133,6 +142,19 @@ static void LoadArrayAndAssertContents(FILE* stream,
   iree_hal_buffer_view_release(buffer_view);
 }
 
+// Counts the release callbacks issued for in-memory loads.
+static void CountRelease(void* user_data, iree_hal_buffer_t* buffer) {
+  ++*reinterpret_cast<int*>(user_data);
+}
+
+static iree_hal_buffer_params_t GetReadOnlyBufferParams() {
+  iree_hal_buffer_params_t buffer_params = {};
+  buffer_params.usage = IREE_HAL_BUFFER_USAGE_TRANSFER;
+  buffer_params.access = IREE_HAL_MEMORY_ACCESS_READ;
+  buffer_params.type = IREE_HAL_MEMORY_TYPE_HOST_LOCAL;
+  return buffer_params;
+}
+
 // Tests that an empty file returns EOF.
 TEST_F(NumpyIOTest, LoadEmptyFile) {
   FILE* stream = OpenInputFile("empty.npy");
@@ -194,6 +216,91 @@ TEST_F(NumpyIOTest, LoadMultipleArrays) {
   fclose(stream);
 }
 
+// Tests loading concatenated arrays from memory with and without importing.
+TEST_F(NumpyIOTest, LoadMultipleArraysFromMemory) {
+  for (auto options : {IREE_NUMPY_NPY_LOAD_OPTION_DEFAULT,
+                       IREE_NUMPY_NPY_LOAD_OPTION_MAP_FILE}) {
+    iree_const_byte_span_t contents = GetInputContents("multiple.npy");
+    int release_count = 0;
+    iree_hal_buffer_release_callback_t release_callback = {CountRelease,
+                                                           &release_count};
+    iree_hal_buffer_view_t* buffer_views[3] = {nullptr};
+    for (auto& buffer_view : buffer_views) {
+      IREE_ASSERT_OK(iree_numpy_npy_load_ndarray_from_memory(
+          &contents, options, GetReadOnlyBufferParams(), device_allocator_,
+          release_callback, &buffer_view));
+    }
+    ASSERT_EQ(contents.data_length, 0);
+
+    AssertBufferViewContents<float>(
+        buffer_views[0], {3}, IREE_HAL_ELEMENT_TYPE_FLOAT_32,
+        IREE_HAL_ENCODING_TYPE_DENSE_ROW_MAJOR, {1.1f, 2.2f, 3.3f});
+    AssertBufferViewContents<int32_t>(
+        buffer_views[1], {2, 2}, IREE_HAL_ELEMENT_TYPE_SINT_32,
+        IREE_HAL_ENCODING_TYPE_DENSE_ROW_MAJOR, {0, 1, 2, 3});
+    AssertBufferViewContents<int32_t>(
+        buffer_views[2], {}, IREE_HAL_ELEMENT_TYPE_SINT_32,
+        IREE_HAL_ENCODING_TYPE_DENSE_ROW_MAJOR, {42});
+
+    // The callback is issued exactly once per array whether the contents were
+    // imported or copied.
+    for (auto* buffer_view : buffer_views) {
+      iree_hal_buffer_view_release(buffer_view);
+    }
+    EXPECT_EQ(release_count, 3);
+
+    // Nothing remains to be loaded.
+    iree_hal_buffer_view_t* buffer_view = nullptr;
+    EXPECT_THAT(Status(iree_numpy_npy_load_ndarray_from_memory(
+                    &contents, options, GetReadOnlyBufferParams(),
+                    device_allocator_, release_callback, &buffer_view)),
+                StatusIs(StatusCode::kOutOfRange));
+    EXPECT_EQ(release_count, 4);
+  }
+}
+
+// Tests loading named arrays from an uncompressed npz archive.
+TEST_F(NumpyIOTest, LoadNpzArchive) {
+  iree_numpy_npz_archive_t archive;
+  IREE_ASSERT_OK(iree_numpy_npz_archive_initialize(
+      GetInputContents("arrays.npz"), iree_allocator_system(), &archive));
+  ASSERT_EQ(archive.entry_count, 2);
+  EXPECT_TRUE(iree_string_view_equal(archive.entries[0].name,
+                                     IREE_SV("single")));
+  EXPECT_TRUE(iree_string_view_equal(archive.entries[1].name,
+                                     IREE_SV("matrix")));
+
+  // np.array([[0, 1], [2, 3]], dtype=np.int32)
+  iree_host_size_t index = 0;
+  IREE_ASSERT_OK(
+      iree_numpy_npz_archive_find_entry(&archive, IREE_SV("matrix"), &index));
+  ASSERT_EQ(index, 1);
+  iree_hal_buffer_view_t* buffer_view = nullptr;
+  IREE_ASSERT_OK(iree_numpy_npz_archive_load_entry(
+      &archive, index, IREE_NUMPY_NPY_LOAD_OPTION_MAP_FILE,
+      GetReadOnlyBufferParams(), device_allocator_,
+      iree_hal_buffer_release_callback_null(), &buffer_view));
+  AssertBufferViewContents<int32_t>(
+      buffer_view, {2, 2}, IREE_HAL_ELEMENT_TYPE_SINT_32,
+      IREE_HAL_ENCODING_TYPE_DENSE_ROW_MAJOR, {0, 1, 2, 3});
+  iree_hal_buffer_view_release(buffer_view);
+
+  // np.array([1.1, 2.2, 3.3], dtype=np.float32)
+  IREE_ASSERT_OK(iree_numpy_npz_archive_load_entry(
+      &archive, 0, IREE_NUMPY_NPY_LOAD_OPTION_DEFAULT,
+      GetReadOnlyBufferParams(), device_allocator_,
+      iree_hal_buffer_release_callback_null(), &buffer_view));
+  AssertBufferViewContents<float>(
+      buffer_view, {3}, IREE_HAL_ELEMENT_TYPE_FLOAT_32,
+      IREE_HAL_ENCODING_TYPE_DENSE_ROW_MAJOR, {1.1f, 2.2f, 3.3f});
+  iree_hal_buffer_view_release(buffer_view);
+
+  EXPECT_THAT(Status(iree_numpy_npz_archive_find_entry(
+                  &archive, IREE_SV("missing"), &index)),
+              StatusIs(StatusCode::kNotFound));
+  iree_numpy_npz_archive_deinitialize(&archive);
+}
+
 // Tests loading arrays with various shapes.
 TEST_F(NumpyIOTest, ArrayShapes) {
   FILE* stream = OpenInputFile("array_shapes.npy");
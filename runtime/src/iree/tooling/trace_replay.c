@@ -149,8 +149,8 @@ static iree_status_t iree_trace_replay_load_bytecode_module(
     IREE_RETURN_IF_ERROR(iree_file_path_join(
         replay->root_path, iree_yaml_node_as_string(path_node),
         replay->host_allocator, &full_path));
-    status = iree_file_read_contents(full_path, replay->host_allocator,
-                                     &flatbuffer_contents);
+    status = iree_file_map_contents(full_path, replay->host_allocator,
+                                    &flatbuffer_contents);
     iree_allocator_free(replay->host_allocator, full_path);
   }
 
@@ -11,6 +11,7 @@
 #include <stdio.h>
 
 #include "iree/base/api.h"
+#include "iree/base/internal/atomics.h"
 #include "iree/base/internal/file_io.h"
 #include "iree/base/tracing.h"
 #include "iree/hal/api.h"
@@ -26,42 +27,128 @@ static iree_status_t iree_allocate_and_copy_cstring_from_view(
   return iree_ok_status();
 }
 
+// A mapped ndarray file shared by all buffers imported from it.
+typedef struct iree_tooling_mapped_file_t {
+  iree_atomic_ref_count_t ref_count;
+  iree_allocator_t host_allocator;
+  iree_file_contents_t* contents;
+} iree_tooling_mapped_file_t;
+
+static void iree_tooling_mapped_file_release(void* user_data,
+                                             iree_hal_buffer_t* buffer) {
+  iree_tooling_mapped_file_t* file = (iree_tooling_mapped_file_t*)user_data;
+  if (iree_atomic_ref_count_dec(&file->ref_count) == 1) {
+    iree_file_contents_free(file->contents);
+    iree_allocator_free(file->host_allocator, file);
+  }
+}
+
+// Returns a release callback holding a new reference to |file|.
+static iree_hal_buffer_release_callback_t iree_tooling_mapped_file_retain(
+    iree_tooling_mapped_file_t* file) {
+  iree_atomic_ref_count_inc(&file->ref_count);
+  iree_hal_buffer_release_callback_t callback = {
+      .fn = iree_tooling_mapped_file_release,
+      .user_data = file,
+  };
+  return callback;
+}
+
+// Pushes a buffer view for each array in the .npz archive |contents| to
+// |variant_list| in archive order.
+static iree_status_t iree_tooling_load_ndarrays_from_npz(
+    iree_tooling_mapped_file_t* file, iree_hal_buffer_params_t buffer_params,
+    iree_hal_allocator_t* device_allocator, iree_vm_list_t* variant_list) {
+  iree_numpy_npz_archive_t archive;
+  IREE_RETURN_IF_ERROR(iree_numpy_npz_archive_initialize(
+      file->contents->const_buffer, file->host_allocator, &archive));
+  iree_status_t status = iree_ok_status();
+  for (iree_host_size_t i = 0;
+       i < archive.entry_count && iree_status_is_ok(status); ++i) {
+    iree_hal_buffer_view_t* buffer_view = NULL;
+    status = iree_numpy_npz_archive_load_entry(
+        &archive, i, IREE_NUMPY_NPY_LOAD_OPTION_MAP_FILE, buffer_params,
+        device_allocator, iree_tooling_mapped_file_retain(file), &buffer_view);
+    if (iree_status_is_ok(status)) {
+      iree_vm_ref_t buffer_view_ref =
+          iree_hal_buffer_view_retain_ref(buffer_view);
+      status = iree_vm_list_push_ref_move(variant_list, &buffer_view_ref);
+    }
+    iree_hal_buffer_view_release(buffer_view);
+  }
+  iree_numpy_npz_archive_deinitialize(&archive);
+  return status;
+}
+
+// Pushes a buffer view for each of the concatenated .npy arrays in |contents|
+// to |variant_list|.
+static iree_status_t iree_tooling_load_ndarrays_from_npy(
+    iree_tooling_mapped_file_t* file, iree_hal_buffer_params_t buffer_params,
+    iree_hal_allocator_t* device_allocator, iree_vm_list_t* variant_list) {
+  iree_const_byte_span_t contents = file->contents->const_buffer;
+  iree_status_t status = iree_ok_status();
+  while (iree_status_is_ok(status) && contents.data_length > 0) {
+    iree_hal_buffer_view_t* buffer_view = NULL;
+    status = iree_numpy_npy_load_ndarray_from_memory(
+        &contents, IREE_NUMPY_NPY_LOAD_OPTION_MAP_FILE, buffer_params,
+        device_allocator, iree_tooling_mapped_file_retain(file), &buffer_view);
+    if (iree_status_is_ok(status)) {
+      iree_vm_ref_t buffer_view_ref =
+          iree_hal_buffer_view_retain_ref(buffer_view);
+      status = iree_vm_list_push_ref_move(variant_list, &buffer_view_ref);
+    }
+    iree_hal_buffer_view_release(buffer_view);
+  }
+  return status;
+}
+
+// Loads all arrays from the .npy or .npz file at |file_path|.
+// The file is mapped and on devices that can use host memory the arrays
+// reference the mapped pages directly; the mapping is released once the last
+// such buffer is destroyed.
 static iree_status_t iree_tooling_load_ndarrays_from_file(
     iree_string_view_t file_path, iree_hal_allocator_t* device_allocator,
     iree_vm_list_t* variant_list) {
+  iree_allocator_t host_allocator = iree_allocator_system();
   char* file_path_cstring = NULL;
   IREE_RETURN_IF_ERROR(iree_allocate_and_copy_cstring_from_view(
-      iree_allocator_system(), file_path, &file_path_cstring));
-  FILE* file = fopen(file_path_cstring, "rb");
-  iree_allocator_free(iree_allocator_system(), file_path_cstring);
-  if (!file) {
-    return iree_make_status(iree_status_code_from_errno(errno),
-                            "failed to open file '%.*s'", (int)file_path.size,
-                            file_path.data);
-  }
+      host_allocator, file_path, &file_path_cstring));
+  iree_file_contents_t* contents = NULL;
+  iree_status_t status =
+      iree_file_map_contents(file_path_cstring, host_allocator, &contents);
+  iree_allocator_free(host_allocator, file_path_cstring);
+  IREE_RETURN_IF_ERROR(status);
 
-  uint64_t file_length = 0;
-  iree_status_t status = iree_file_query_length(file, &file_length);
+  iree_tooling_mapped_file_t* file = NULL;
+  status = iree_allocator_malloc(host_allocator, sizeof(*file), (void**)&file);
+  if (!iree_status_is_ok(status)) {
+    iree_file_contents_free(contents);
+    return status;
+  }
+  iree_atomic_ref_count_init(&file->ref_count);
+  file->host_allocator = host_allocator;
+  file->contents = contents;
 
+  // Mapped pages are read-only and must not be written by the program.
   iree_hal_buffer_params_t buffer_params = {0};
   buffer_params.usage = IREE_HAL_BUFFER_USAGE_DEFAULT;
   buffer_params.access = IREE_HAL_MEMORY_ACCESS_READ;
   buffer_params.type = IREE_HAL_MEMORY_TYPE_DEVICE_LOCAL;
 
-  while (iree_status_is_ok(status) && !iree_file_is_at(file, file_length)) {
-    iree_hal_buffer_view_t* buffer_view = NULL;
-    status = iree_numpy_npy_load_ndarray(
-        file, IREE_NUMPY_NPY_LOAD_OPTION_DEFAULT, buffer_params,
-        device_allocator, &buffer_view);
-    if (iree_status_is_ok(status)) {
-      iree_vm_ref_t buffer_view_ref =
-          iree_hal_buffer_view_retain_ref(buffer_view);
-      status = iree_vm_list_push_ref_move(variant_list, &buffer_view_ref);
-    }
-    iree_hal_buffer_view_release(buffer_view);
+  // .npz files are zip archives and start with a local file header.
+  static const uint8_t kZipMagic[4] = {'P', 'K', 0x03, 0x04};
+  iree_const_byte_span_t bytes = contents->const_buffer;
+  if (bytes.data_length >= sizeof(kZipMagic) &&
+      memcmp(bytes.data, kZipMagic, sizeof(kZipMagic)) == 0) {
+    status = iree_tooling_load_ndarrays_from_npz(
+        file, buffer_params, device_allocator, variant_list);
+  } else {
+    status = iree_tooling_load_ndarrays_from_npy(
+        file, buffer_params, device_allocator, variant_list);
   }
 
-  fclose(file);
+  // Drop our reference; imported buffers keep the mapping alive.
+  iree_tooling_mapped_file_release(file, NULL);
   return status;
 }
 
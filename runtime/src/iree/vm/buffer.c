@@ -12,6 +12,12 @@
 #include "iree/base/tracing.h"
 #include "iree/vm/instance.h"
 
+#if defined(IREE_PLATFORM_ANDROID) || defined(IREE_PLATFORM_APPLE) || \
+    defined(IREE_PLATFORM_LINUX)
+#include <sys/mman.h>
+#include <unistd.h>
+#endif  // IREE_PLATFORM_*
+
 static iree_vm_ref_type_descriptor_t iree_vm_buffer_descriptor = {0};
 
 IREE_VM_DEFINE_TYPE_ADAPTERS(iree_vm_buffer, iree_vm_buffer_t);
@@ -264,6 +270,77 @@ IREE_API_EXPORT iree_status_t iree_vm_buffer_fill_elements(
   return iree_ok_status();
 }
 
+#if defined(IREE_PLATFORM_ANDROID) || defined(IREE_PLATFORM_APPLE) || \
+    defined(IREE_PLATFORM_LINUX)
+
+static void iree_vm_memory_advise(uint8_t* ptr, iree_host_size_t length,
+                                  iree_vm_buffer_advice_t advice) {
+  const uintptr_t page_size = (uintptr_t)sysconf(_SC_PAGESIZE);
+  const uintptr_t begin = (uintptr_t)ptr & ~(page_size - 1);
+  const uintptr_t end = iree_host_align((uintptr_t)ptr + length, page_size);
+  switch (advice) {
+    case IREE_VM_BUFFER_ADVICE_WILL_NEED:
+      madvise((void*)begin, end - begin, MADV_WILLNEED);
+      break;
+    case IREE_VM_BUFFER_ADVICE_DONT_NEED:
+      // NOTE: MADV_DONTNEED is not used as it zeros private anonymous memory.
+      // Reclaiming with MADV_PAGEOUT/MADV_COLD preserves contents for all
+      // memory types and only drops clean file-backed pages.
+#if defined(MADV_PAGEOUT)
+      if (madvise((void*)begin, end - begin, MADV_PAGEOUT) == 0) break;
+#endif  // MADV_PAGEOUT
+#if defined(MADV_COLD)
+      madvise((void*)begin, end - begin, MADV_COLD);
+#endif  // MADV_COLD
+      break;
+    default:
+      break;
+  }
+}
+
+#elif defined(IREE_PLATFORM_WINDOWS) && (_WIN32_WINNT >= 0x0602)
+
+static void iree_vm_memory_advise(uint8_t* ptr, iree_host_size_t length,
+                                  iree_vm_buffer_advice_t advice) {
+  switch (advice) {
+    case IREE_VM_BUFFER_ADVICE_WILL_NEED: {
+      WIN32_MEMORY_RANGE_ENTRY range = {
+          .VirtualAddress = ptr,
+          .NumberOfBytes = length,
+      };
+      PrefetchVirtualMemory(GetCurrentProcess(), 1, &range, 0);
+    } break;
+    case IREE_VM_BUFFER_ADVICE_DONT_NEED:
+      // Unlocking pages that are not locked removes them from the working set
+      // without discarding their contents.
+      VirtualUnlock(ptr, length);
+      break;
+    default:
+      break;
+  }
+}
+
+#else
+
+static void iree_vm_memory_advise(uint8_t* ptr, iree_host_size_t length,
+                                  iree_vm_buffer_advice_t advice) {}
+
+#endif  // IREE_PLATFORM_*
+
+IREE_API_EXPORT void iree_vm_buffer_advise(const iree_vm_buffer_t* buffer,
+                                           iree_host_size_t offset,
+                                           iree_host_size_t length,
+                                           iree_vm_buffer_advice_t advice) {
+  IREE_ASSERT_ARGUMENT(buffer);
+  if (offset >= buffer->data.data_length) return;
+  length = iree_min(length, buffer->data.data_length - offset);
+  if (!length) return;
+  IREE_TRACE_ZONE_BEGIN(z0);
+  IREE_TRACE_ZONE_APPEND_VALUE(z0, length);
+  iree_vm_memory_advise(buffer->data.data + offset, length, advice);
+  IREE_TRACE_ZONE_END(z0);
+}
+
 IREE_API_EXPORT iree_status_t iree_vm_buffer_read_elements(
     const iree_vm_buffer_t* source_buffer, iree_host_size_t source_offset,
     void* target_ptr, iree_host_size_t element_count,
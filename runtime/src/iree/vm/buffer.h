@@ -155,6 +155,26 @@ IREE_API_EXPORT iree_status_t iree_vm_buffer_fill_elements(
     iree_host_size_t element_count, iree_host_size_t element_length,
     const void* value);
 
+// Hints describing how the memory backing a buffer will be accessed.
+// Advice never changes the contents of a buffer and may be ignored.
+typedef enum iree_vm_buffer_advice_e {
+  // The range will be accessed soon and its pages should be made resident.
+  IREE_VM_BUFFER_ADVICE_WILL_NEED = 0,
+  // The range will not be accessed for a while and its resident pages may be
+  // reclaimed. Contents are preserved and paged back in if accessed again.
+  IREE_VM_BUFFER_ADVICE_DONT_NEED = 1,
+} iree_vm_buffer_advice_t;
+
+// Advises the system how a byte range of |buffer| will be accessed.
+// This is most useful for buffers referencing memory-mapped module rodata:
+// constants can be prefetched ahead of first use and their pages released
+// after they have been uploaded to a device. The range is expanded to whole
+// system pages and errors are ignored as advice is only a hint.
+IREE_API_EXPORT void iree_vm_buffer_advise(const iree_vm_buffer_t* buffer,
+                                           iree_host_size_t offset,
+                                           iree_host_size_t length,
+                                           iree_vm_buffer_advice_t advice);
+
 // Maps a subrange to a span of bytes within the |buffer| for read-only access.
 // |offset| and |length| must match the provided |alignment| (1, 2, 4, 8) and
 // will be rounded toward zero if they do not.
@@ -7,6 +7,8 @@
 #include "iree/vm/buffer.h"
 
 #include <cstddef>
+#include <cstdint>
+#include <vector>
 
 #include "iree/base/api.h"
 #include "iree/testing/gtest.h"
@@ -49,4 +51,29 @@ TEST_F(VMBufferTest, Initialize) {
   ASSERT_TRUE(did_free);
 }
 
+// Tests that advice is only a hint and never changes buffer contents, including
+// for private heap memory and ranges that are unaligned or out of bounds.
+TEST_F(VMBufferTest, AdvisePreservesContents) {
+  std::vector<uint8_t> data(64 * 1024 + 3);
+  for (size_t i = 0; i < data.size(); ++i) data[i] = (uint8_t)(i * 7);
+  iree_vm_buffer_t buffer;
+  iree_vm_buffer_initialize(
+      IREE_VM_BUFFER_ACCESS_ORIGIN_HOST,
+      iree_make_byte_span(data.data(), data.size()), iree_allocator_null(),
+      &buffer);
+
+  iree_vm_buffer_advise(&buffer, 0, data.size(),
+                        IREE_VM_BUFFER_ADVICE_WILL_NEED);
+  iree_vm_buffer_advise(&buffer, 1, 4097, IREE_VM_BUFFER_ADVICE_DONT_NEED);
+  iree_vm_buffer_advise(&buffer, 0, IREE_HOST_SIZE_MAX,
+                        IREE_VM_BUFFER_ADVICE_DONT_NEED);
+  iree_vm_buffer_advise(&buffer, data.size() + 1, 16,
+                        IREE_VM_BUFFER_ADVICE_DONT_NEED);
+
+  for (size_t i = 0; i < data.size(); ++i) {
+    ASSERT_EQ(data[i], (uint8_t)(i * 7)) << "at offset " << i;
+  }
+  iree_vm_buffer_deinitialize(&buffer);
+}
+
 }  // namespace
@@ -10,6 +10,7 @@
 
 #include "iree/base/api.h"
 #include "iree/base/internal/math.h"
+#include "iree/base/tracing.h"
 #include "iree/vm/api.h"
 #include "iree/vm/bytecode_disasm.h"
 #include "iree/vm/bytecode_dispatch_util.h"
@@ -61,6 +62,43 @@ static void iree_vm_bytecode_dispatch_discard_registers(
   }
 }
 
+// Decodes the remainder of a vm.cond_br instruction starting at |*pc_ptr|
+// (after the condition operand) and branches based on |condition|.
+// This is shared by vm.cond_br and the comparison ops that fuse with a
+// vm.cond_br immediately consuming their result.
+static inline void iree_vm_bytecode_dispatch_cond_branch(
+    const iree_vm_registers_t regs, const uint8_t* IREE_RESTRICT bytecode_data,
+    iree_vm_source_offset_t* IREE_RESTRICT pc_ptr, int32_t condition) {
+  iree_vm_source_offset_t pc = *pc_ptr;
+  int32_t true_block_pc = VM_DecBranchTarget("true_dest");
+  const iree_vm_register_remap_list_t* true_remap_list =
+      VM_DecBranchOperands("true_operands");
+  int32_t false_block_pc = VM_DecBranchTarget("false_dest");
+  const iree_vm_register_remap_list_t* false_remap_list =
+      VM_DecBranchOperands("false_operands");
+  if (condition) {
+    *pc_ptr = true_block_pc;
+    iree_vm_bytecode_dispatch_remap_branch_registers(regs, true_remap_list);
+  } else {
+    *pc_ptr = false_block_pc;
+    iree_vm_bytecode_dispatch_remap_branch_registers(regs, false_remap_list);
+  }
+}
+
+// Dispatch-time superinstruction fusing an op producing an i32 condition in
+// |result_ptr| with an immediately following vm.cond_br that consumes it.
+// The encoding is unchanged and the branch is executed inline, skipping the
+// dispatch of the vm.cond_br. Must be used after all operands and results of
+// the producing op have been decoded.
+#define VM_FuseCondBranch(result_ptr)                               \
+  if (bytecode_data[pc] == IREE_VM_OP_CORE_CondBranch &&            \
+      &regs.i32[VM_RegI32(OP_I16(1))] == (result_ptr)) {           \
+    IREE_DISPATCH_TRACE_INSTRUCTION(0, "CondBranch");               \
+    pc += 1 + kRegSize;                                             \
+    iree_vm_bytecode_dispatch_cond_branch(regs, bytecode_data, &pc, \
+                                          *(result_ptr));           \
+  }
+
 //===----------------------------------------------------------------------===//
 // Stack management
 //===----------------------------------------------------------------------===//
@@ -101,22 +139,14 @@ static void iree_vm_bytecode_stack_frame_cleanup(iree_vm_stack_frame_t* frame) {
   }
 }
 
-static iree_status_t iree_vm_bytecode_function_enter(
-    iree_vm_stack_t* stack, const iree_vm_function_t function,
-    iree_string_view_t cconv_results, iree_vm_stack_frame_t** out_callee_frame,
-    iree_vm_registers_t* out_callee_registers) {
-  iree_vm_bytecode_module_t* module =
-      (iree_vm_bytecode_module_t*)function.module->self;
-  if (IREE_UNLIKELY(function.ordinal >= module->function_descriptor_count)) {
-    return iree_make_status(IREE_STATUS_INVALID_ARGUMENT,
-                            "import ordinal out of range");
-  }
-  const iree_vm_FunctionDescriptor_t* target_descriptor =
-      &module->function_descriptor_table[function.ordinal];
+void iree_vm_bytecode_compute_frame_layout(
+    const iree_vm_FunctionDescriptor_t* descriptor,
+    iree_vm_bytecode_frame_layout_t* out_layout) {
+  memset(out_layout, 0, sizeof(*out_layout));
 
-  // We first compute the frame size of the callee and the masks we'll use to
+  // We compute the frame size of the function and the masks we'll use to
   // bounds check register access. This lets us allocate the entire frame
-  // (header, frame, and register storage) as a single pointer bump below.
+  // (header, frame, and register storage) as a single pointer bump on entry.
 
   // Round up register counts to the nearest power of 2 (if not already).
   // This let's us use bit masks on register accesses to do bounds checking
@@ -128,15 +158,13 @@ static iree_status_t iree_vm_bytecode_function_enter(
   // least allocate 1 register; this way an i32[reg & mask] will always point at
   // valid memory even if mask == 0.
   uint32_t i32_register_count = iree_math_round_up_to_pow2_u32(
-      VMMAX(1, target_descriptor->i32_register_count));
+      VMMAX(1, descriptor->i32_register_count));
   uint32_t ref_register_count = iree_math_round_up_to_pow2_u32(
-      VMMAX(1, target_descriptor->ref_register_count));
+      VMMAX(1, descriptor->ref_register_count));
   if (IREE_UNLIKELY(i32_register_count > IREE_I32_REGISTER_MASK) ||
       IREE_UNLIKELY(ref_register_count > IREE_REF_REGISTER_MASK)) {
-    // Register count overflow. A valid compiler should never produce files that
-    // hit this.
-    return iree_make_status(IREE_STATUS_RESOURCE_EXHAUSTED,
-                            "register count overflow");
+    // Register count overflow; the frame size is left as 0 to fail on entry.
+    return;
   }
 
   // We need to align the ref register start to the natural machine
@@ -148,8 +176,43 @@ static iree_status_t iree_vm_bytecode_function_enter(
       iree_host_align(i32_register_count * sizeof(int32_t), 16);
   iree_host_size_t ref_register_size =
       iree_host_align(ref_register_count * sizeof(iree_vm_ref_t), 16);
-  iree_host_size_t frame_size =
-      header_size + i32_register_size + ref_register_size;
+  out_layout->frame_size =
+      (uint32_t)(header_size + i32_register_size + ref_register_size);
+  out_layout->i32_register_count = (uint16_t)i32_register_count;
+  out_layout->ref_register_count = (uint16_t)ref_register_count;
+  out_layout->i32_register_offset = (uint32_t)header_size;
+  out_layout->ref_register_offset = (uint32_t)(header_size + i32_register_size);
+}
+
+static iree_status_t iree_vm_bytecode_function_enter(
+    iree_vm_stack_t* stack, const iree_vm_function_t function,
+    iree_string_view_t cconv_results, iree_vm_stack_frame_t** out_callee_frame,
+    iree_vm_registers_t* out_callee_registers) {
+  iree_vm_bytecode_module_t* module =
+      (iree_vm_bytecode_module_t*)function.module->self;
+  if (IREE_UNLIKELY(function.ordinal >= module->function_descriptor_count)) {
+    return iree_make_status(IREE_STATUS_INVALID_ARGUMENT,
+                            "import ordinal out of range");
+  }
+#if IREE_VM_BYTECODE_VERIFICATION_ENABLE && \
+    IREE_VM_BYTECODE_VERIFICATION_LAZY_ENABLE
+  if (IREE_UNLIKELY(!iree_atomic_load_int32(
+          &module->function_verified[function.ordinal],
+          iree_memory_order_acquire))) {
+    IREE_RETURN_IF_ERROR(
+        iree_vm_bytecode_module_verify_function(module, function.ordinal));
+  }
+#endif  // IREE_VM_BYTECODE_VERIFICATION_ENABLE &&
+        // IREE_VM_BYTECODE_VERIFICATION_LAZY_ENABLE
+  const iree_vm_bytecode_frame_layout_t* layout =
+      &module->frame_layout_table[function.ordinal];
+  if (IREE_UNLIKELY(layout->frame_size == 0)) {
+    // Register count overflow. A valid compiler should never produce files that
+    // hit this.
+    return iree_make_status(IREE_STATUS_RESOURCE_EXHAUSTED,
+                            "register count overflow");
+  }
+  const iree_host_size_t frame_size = layout->frame_size;
 
   // Enter function and allocate stack frame storage.
   IREE_RETURN_IF_ERROR(iree_vm_stack_function_enter(
@@ -161,10 +224,10 @@ static iree_status_t iree_vm_bytecode_function_enter(
       (iree_vm_bytecode_frame_storage_t*)iree_vm_stack_frame_storage(
           *out_callee_frame);
   stack_storage->cconv_results = cconv_results;
-  stack_storage->i32_register_count = i32_register_count;
-  stack_storage->ref_register_count = ref_register_count;
-  stack_storage->i32_register_offset = header_size;
-  stack_storage->ref_register_offset = header_size + i32_register_size;
+  stack_storage->i32_register_count = layout->i32_register_count;
+  stack_storage->ref_register_count = layout->ref_register_count;
+  stack_storage->i32_register_offset = layout->i32_register_offset;
+  stack_storage->ref_register_offset = layout->ref_register_offset;
   *out_callee_registers =
       iree_vm_bytecode_get_register_storage(*out_callee_frame);
 
@@ -649,6 +712,123 @@ static iree_status_t iree_vm_bytecode_call_import_variadic(
                                             out_caller_registers);
 }
 
+//===----------------------------------------------------------------------===//
+// Native tier
+//===----------------------------------------------------------------------===//
+
+#if IREE_VM_BYTECODE_NATIVE_TIER_ENABLE
+
+// Returns true and the translated entry point of |function_ordinal| if it has
+// one. Counts the invocation and translates the function when it crosses the
+// tier threshold. Functions are never translated more than once: those the
+// tier declines remain interpreted.
+static bool iree_vm_bytecode_native_tier_lookup(
+    iree_vm_stack_t* stack, iree_vm_bytecode_module_t* module,
+    int32_t function_ordinal, iree_vm_bytecode_native_entry_t* out_entry) {
+  const iree_vm_bytecode_native_tier_t* tier = module->native_tier;
+  if (IREE_LIKELY(!tier)) return false;
+#if IREE_VM_EXECUTION_TRACING_ENABLE
+  if (IREE_IS_DISPATCH_TRACING_ENABLED()) return false;
+#endif  // IREE_VM_EXECUTION_TRACING_ENABLE
+
+  iree_vm_bytecode_native_slot_t* slot =
+      &module->native_slots[function_ordinal];
+  intptr_t fn = iree_atomic_load_intptr(&slot->fn, iree_memory_order_acquire);
+  if (fn) {
+    out_entry->fn = (iree_vm_bytecode_native_function_t)fn;
+    out_entry->user_data = slot->user_data;
+    return true;
+  }
+
+  // Stop counting once the threshold is reached so that the count cannot wrap
+  // and retrigger translation. Concurrent callers may overshoot by a few.
+  const int32_t threshold = (int32_t)tier->invocation_threshold;
+  if (iree_atomic_load_int32(&slot->invocation_count,
+                             iree_memory_order_relaxed) >= threshold) {
+    return false;
+  }
+  if (iree_atomic_fetch_add_int32(&slot->invocation_count, 1,
+                                  iree_memory_order_relaxed) +
+          1 !=
+      threshold) {
+    return false;
+  }
+
+  // Only the caller that reached the threshold translates; all others keep
+  // interpreting until the entry point is published.
+  IREE_TRACE_ZONE_BEGIN(z0);
+  const iree_vm_FunctionDescriptor_t* descriptor =
+      &module->function_descriptor_table[function_ordinal];
+  iree_const_byte_span_t bytecode = iree_make_const_byte_span(
+      module->bytecode_data.data + descriptor->bytecode_offset,
+      descriptor->bytecode_length);
+  iree_vm_bytecode_native_entry_t entry = {NULL, NULL};
+  iree_status_t status =
+      tier->translate(tier->self, &module->interface,
+                      (uint16_t)function_ordinal, bytecode, &entry);
+  IREE_TRACE_ZONE_END(z0);
+  if (!iree_status_is_ok(status) || !entry.fn) {
+    iree_status_ignore(status);
+    return false;
+  }
+  slot->user_data = entry.user_data;
+  iree_atomic_store_intptr(&slot->fn, (intptr_t)entry.fn,
+                           iree_memory_order_release);
+  *out_entry = entry;
+  return true;
+}
+
+// Runs the translated |entry| on the entered |frame| and returns the register
+// list holding its results.
+static iree_status_t iree_vm_bytecode_native_tier_call(
+    iree_vm_stack_t* stack, const iree_vm_bytecode_native_entry_t entry,
+    iree_vm_stack_frame_t* frame, const iree_vm_registers_t regs,
+    const iree_vm_register_list_t** out_result_registers) {
+  const iree_vm_bytecode_module_state_t* module_state =
+      (const iree_vm_bytecode_module_state_t*)frame->module_state;
+  iree_vm_bytecode_native_frame_t native_frame;
+  native_frame.rwdata = module_state->rwdata_storage;
+  native_frame.i32_mask = regs.i32_mask;
+  native_frame.i32 = regs.i32;
+  native_frame.ref_mask = regs.ref_mask;
+  native_frame.ref = regs.ref;
+  *out_result_registers = NULL;
+  IREE_RETURN_IF_ERROR(entry.fn(entry.user_data, stack, frame, &native_frame,
+                                out_result_registers));
+  if (IREE_UNLIKELY(!*out_result_registers)) {
+    return iree_make_status(IREE_STATUS_FAILED_PRECONDITION,
+                            "native function returned no result registers");
+  }
+  return iree_ok_status();
+}
+
+#endif  // IREE_VM_BYTECODE_NATIVE_TIER_ENABLE
+
+// Runs the entered internal callee |*inout_frame| with the native tier if it
+// has been translated and returns to the caller frame. |out_handled| is false
+// if the callee must be interpreted.
+static inline iree_status_t iree_vm_bytecode_native_tier_call_internal(
+    iree_vm_stack_t* stack, iree_vm_bytecode_module_t* module,
+    int32_t function_ordinal, iree_vm_stack_frame_t** inout_frame,
+    iree_vm_registers_t* inout_regs, bool* out_handled) {
+  *out_handled = false;
+#if IREE_VM_BYTECODE_NATIVE_TIER_ENABLE
+  iree_vm_bytecode_native_entry_t entry;
+  if (!iree_vm_bytecode_native_tier_lookup(stack, module, function_ordinal,
+                                           &entry)) {
+    return iree_ok_status();
+  }
+  const iree_vm_register_list_t* result_registers = NULL;
+  IREE_RETURN_IF_ERROR(iree_vm_bytecode_native_tier_call(
+      stack, entry, *inout_frame, *inout_regs, &result_registers));
+  IREE_RETURN_IF_ERROR(iree_vm_bytecode_internal_leave(
+      stack, *inout_frame, *inout_regs, result_registers, inout_frame,
+      inout_regs));
+  *out_handled = true;
+#endif  // IREE_VM_BYTECODE_NATIVE_TIER_ENABLE
+  return iree_ok_status();
+}
+
 //===----------------------------------------------------------------------===//
 // Main interpreter dispatch routine
 //===----------------------------------------------------------------------===//
@@ -671,6 +851,19 @@ iree_status_t iree_vm_bytecode_dispatch_begin(
       stack, call.function, cconv_arguments, call.arguments, cconv_results,
       &current_frame, &regs));
 
+#if IREE_VM_BYTECODE_NATIVE_TIER_ENABLE
+  iree_vm_bytecode_native_entry_t native_entry;
+  if (iree_vm_bytecode_native_tier_lookup(stack, module,
+                                          call.function.ordinal,
+                                          &native_entry)) {
+    const iree_vm_register_list_t* result_registers = NULL;
+    IREE_RETURN_IF_ERROR(iree_vm_bytecode_native_tier_call(
+        stack, native_entry, current_frame, regs, &result_registers));
+    return iree_vm_bytecode_external_leave(stack, current_frame, &regs,
+                                           result_registers, call.results);
+  }
+#endif  // IREE_VM_BYTECODE_NATIVE_TIER_ENABLE
+
   return iree_vm_bytecode_dispatch(stack, module, current_frame, regs,
                                    call.results);
 }
@@ -721,8 +914,8 @@ static iree_status_t iree_vm_bytecode_dispatch(
 
     DISPATCH_OP(CORE, GlobalLoadI32, {
       uint32_t byte_offset = VM_DecGlobalAttr("global");
-      if (IREE_UNLIKELY(byte_offset >=
-                        module_state->rwdata_storage.data_length)) {
+      if (VM_UnverifiedCheck(byte_offset >=
+                             module_state->rwdata_storage.data_length)) {
         return iree_make_status(
             IREE_STATUS_OUT_OF_RANGE,
             "global byte_offset out of range: %d (rwdata=%zu)", byte_offset,
@@ -736,8 +929,8 @@ static iree_status_t iree_vm_bytecode_dispatch(
 
     DISPATCH_OP(CORE, GlobalStoreI32, {
       uint32_t byte_offset = VM_DecGlobalAttr("global");
-      if (IREE_UNLIKELY(byte_offset >=
-                        module_state->rwdata_storage.data_length)) {
+      if (VM_UnverifiedCheck(byte_offset >=
+                             module_state->rwdata_storage.data_length)) {
         return iree_make_status(
             IREE_STATUS_OUT_OF_RANGE,
             "global byte_offset out of range: %d (rwdata=%zu)", byte_offset,
@@ -779,8 +972,8 @@ static iree_status_t iree_vm_bytecode_dispatch(
 
     DISPATCH_OP(CORE, GlobalLoadI64, {
       uint32_t byte_offset = VM_DecGlobalAttr("global");
-      if (IREE_UNLIKELY(byte_offset >=
-                        module_state->rwdata_storage.data_length)) {
+      if (VM_UnverifiedCheck(byte_offset >=
+                             module_state->rwdata_storage.data_length)) {
         return iree_make_status(
             IREE_STATUS_OUT_OF_RANGE,
             "global byte_offset out of range: %d (rwdata=%zu)", byte_offset,
@@ -794,8 +987,8 @@ static iree_status_t iree_vm_bytecode_dispatch(
 
     DISPATCH_OP(CORE, GlobalStoreI64, {
       uint32_t byte_offset = VM_DecGlobalAttr("global");
-      if (IREE_UNLIKELY(byte_offset >=
-                        module_state->rwdata_storage.data_length)) {
+      if (VM_UnverifiedCheck(byte_offset >=
+                             module_state->rwdata_storage.data_length)) {
         return iree_make_status(
             IREE_STATUS_OUT_OF_RANGE,
             "global byte_offset out of range: %d (rwdata=%zu)", byte_offset,
@@ -837,7 +1030,7 @@ static iree_status_t iree_vm_bytecode_dispatch(
 
     DISPATCH_OP(CORE, GlobalLoadRef, {
       uint32_t global = VM_DecGlobalAttr("global");
-      if (IREE_UNLIKELY(global >= module_state->global_ref_count)) {
+      if (VM_UnverifiedCheck(global >= module_state->global_ref_count)) {
         return iree_make_status(
             IREE_STATUS_OUT_OF_RANGE,
             "global ref ordinal out of range: %d (table=%zu)", global,
@@ -853,7 +1046,7 @@ static iree_status_t iree_vm_bytecode_dispatch(
 
     DISPATCH_OP(CORE, GlobalStoreRef, {
       uint32_t global = VM_DecGlobalAttr("global");
-      if (IREE_UNLIKELY(global >= module_state->global_ref_count)) {
+      if (VM_UnverifiedCheck(global >= module_state->global_ref_count)) {
         return iree_make_status(
             IREE_STATUS_OUT_OF_RANGE,
             "global ref ordinal out of range: %d (table=%zu)", global,
@@ -933,7 +1126,8 @@ static iree_status_t iree_vm_bytecode_dispatch(
 
     DISPATCH_OP(CORE, ConstRefRodata, {
       uint32_t rodata_ordinal = VM_DecRodataAttr("rodata");
-      if (IREE_UNLIKELY(rodata_ordinal >= module_state->rodata_ref_count)) {
+      if (VM_UnverifiedCheck(rodata_ordinal >=
+                             module_state->rodata_ref_count)) {
         return iree_make_status(
             IREE_STATUS_OUT_OF_RANGE,
             "rodata ref ordinal out of range: %d (table=%zu)", rodata_ordinal,
@@ -1608,11 +1802,30 @@ static iree_status_t iree_vm_bytecode_dispatch(
     // Comparison ops
     //===------------------------------------------------------------------===//
 
-    DISPATCH_OP_CORE_BINARY_I32(CmpEQI32, vm_cmp_eq_i32);
-    DISPATCH_OP_CORE_BINARY_I32(CmpNEI32, vm_cmp_ne_i32);
-    DISPATCH_OP_CORE_BINARY_I32(CmpLTI32S, vm_cmp_lt_i32s);
-    DISPATCH_OP_CORE_BINARY_I32(CmpLTI32U, vm_cmp_lt_i32u);
-    DISPATCH_OP_CORE_UNARY_I32(CmpNZI32, vm_cmp_nz_i32);
+    // Comparisons are almost always immediately consumed by a vm.cond_br and
+    // we fuse the pair at dispatch time to avoid a round trip through the
+    // dispatch table. The result register is still written as it may have
+    // other uses.
+
+#define DISPATCH_OP_CORE_CMP_I32(op_name, op_func)  \
+  DISPATCH_OP(CORE, op_name, {                      \
+    int32_t lhs = VM_DecOperandRegI32("lhs");       \
+    int32_t rhs = VM_DecOperandRegI32("rhs");       \
+    int32_t* result = VM_DecResultRegI32("result"); \
+    *result = op_func(lhs, rhs);                    \
+    VM_FuseCondBranch(result);                      \
+  });
+
+    DISPATCH_OP_CORE_CMP_I32(CmpEQI32, vm_cmp_eq_i32);
+    DISPATCH_OP_CORE_CMP_I32(CmpNEI32, vm_cmp_ne_i32);
+    DISPATCH_OP_CORE_CMP_I32(CmpLTI32S, vm_cmp_lt_i32s);
+    DISPATCH_OP_CORE_CMP_I32(CmpLTI32U, vm_cmp_lt_i32u);
+    DISPATCH_OP(CORE, CmpNZI32, {
+      int32_t operand = VM_DecOperandRegI32("operand");
+      int32_t* result = VM_DecResultRegI32("result");
+      *result = vm_cmp_nz_i32(operand);
+      VM_FuseCondBranch(result);
+    });
 
 #define DISPATCH_OP_CORE_CMP_I64(op_name, op_func)  \
   DISPATCH_OP(CORE, op_name, {                      \
@@ -1620,6 +1833,7 @@ static iree_status_t iree_vm_bytecode_dispatch(
     int64_t rhs = VM_DecOperandRegI64("rhs");       \
     int32_t* result = VM_DecResultRegI32("result"); \
     *result = op_func(lhs, rhs);                    \
+    VM_FuseCondBranch(result);                      \
   });
 
     DISPATCH_OP_CORE_CMP_I64(CmpEQI64, vm_cmp_eq_i64);
@@ -1630,6 +1844,7 @@ static iree_status_t iree_vm_bytecode_dispatch(
       int64_t operand = VM_DecOperandRegI64("operand");
       int32_t* result = VM_DecResultRegI32("result");
       *result = vm_cmp_nz_i64(operand);
+      VM_FuseCondBranch(result);
     });
 
     DISPATCH_OP(CORE, CmpEQRef, {
@@ -1641,6 +1856,7 @@ static iree_status_t iree_vm_bytecode_dispatch(
       *result = vm_cmp_eq_ref(lhs, rhs);
       if (lhs_is_move) iree_vm_ref_release(lhs);
       if (rhs_is_move) iree_vm_ref_release(rhs);
+      VM_FuseCondBranch(result);
     });
     DISPATCH_OP(CORE, CmpNERef, {
       bool lhs_is_move;
@@ -1651,6 +1867,7 @@ static iree_status_t iree_vm_bytecode_dispatch(
       *result = vm_cmp_ne_ref(lhs, rhs);
       if (lhs_is_move) iree_vm_ref_release(lhs);
       if (rhs_is_move) iree_vm_ref_release(rhs);
+      VM_FuseCondBranch(result);
     });
     DISPATCH_OP(CORE, CmpNZRef, {
       bool operand_is_move;
@@ -1658,6 +1875,7 @@ static iree_status_t iree_vm_bytecode_dispatch(
       int32_t* result = VM_DecResultRegI32("result");
       *result = vm_cmp_nz_ref(operand);
       if (operand_is_move) iree_vm_ref_release(operand);
+      VM_FuseCondBranch(result);
     });
 
     //===------------------------------------------------------------------===//
@@ -1674,20 +1892,8 @@ static iree_status_t iree_vm_bytecode_dispatch(
 
     DISPATCH_OP(CORE, CondBranch, {
       int32_t condition = VM_DecOperandRegI32("condition");
-      int32_t true_block_pc = VM_DecBranchTarget("true_dest");
-      const iree_vm_register_remap_list_t* true_remap_list =
-          VM_DecBranchOperands("true_operands");
-      int32_t false_block_pc = VM_DecBranchTarget("false_dest");
-      const iree_vm_register_remap_list_t* false_remap_list =
-          VM_DecBranchOperands("false_operands");
-      if (condition) {
-        pc = true_block_pc;
-        iree_vm_bytecode_dispatch_remap_branch_registers(regs, true_remap_list);
-      } else {
-        pc = false_block_pc;
-        iree_vm_bytecode_dispatch_remap_branch_registers(regs,
-                                                         false_remap_list);
-      }
+      iree_vm_bytecode_dispatch_cond_branch(regs, bytecode_data, &pc,
+                                            condition);
     });
 
     DISPATCH_OP(CORE, Call, {
@@ -1712,9 +1918,17 @@ static iree_status_t iree_vm_bytecode_dispatch(
         IREE_RETURN_IF_ERROR(iree_vm_bytecode_internal_enter(
             stack, current_frame->function.module, function_ordinal,
             src_reg_list, dst_reg_list, &current_frame, &regs));
-        bytecode_data =
-            module->bytecode_data.data +
-            module->function_descriptor_table[function_ordinal].bytecode_offset;
+        // Callees translated by the native tier run to completion and leave us
+        // back in the caller frame.
+        bool called_natively = false;
+        IREE_RETURN_IF_ERROR(iree_vm_bytecode_native_tier_call_internal(
+            stack, module, function_ordinal, &current_frame, &regs,
+            &called_natively));
+        if (!called_natively) {
+          bytecode_data = module->bytecode_data.data +
+                          module->function_descriptor_table[function_ordinal]
+                              .bytecode_offset;
+        }
         pc = current_frame->pc;
       }
     });
@@ -1788,7 +2002,7 @@ static iree_status_t iree_vm_bytecode_dispatch(
       uint32_t function_ordinal = VM_DecFuncAttr("import");
       int32_t* result = VM_DecResultRegI32("result");
       uint32_t import_ordinal = function_ordinal & 0x7FFFFFFFu;
-      if (IREE_UNLIKELY(import_ordinal >= module_state->import_count)) {
+      if (VM_UnverifiedCheck(import_ordinal >= module_state->import_count)) {
         return iree_make_status(IREE_STATUS_INVALID_ARGUMENT,
                                 "import ordinal out of range");
       }
@@ -1871,8 +2085,8 @@ static iree_status_t iree_vm_bytecode_dispatch(
 
       DISPATCH_OP(EXT_F32, GlobalLoadF32, {
         uint32_t byte_offset = VM_DecGlobalAttr("global");
-        if (IREE_UNLIKELY(byte_offset >=
-                          module_state->rwdata_storage.data_length)) {
+        if (VM_UnverifiedCheck(byte_offset >=
+                               module_state->rwdata_storage.data_length)) {
           return iree_make_status(
               IREE_STATUS_OUT_OF_RANGE,
               "global byte_offset out of range: %d (rwdata=%zu)", byte_offset,
@@ -1886,8 +2100,8 @@ static iree_status_t iree_vm_bytecode_dispatch(
 
       DISPATCH_OP(EXT_F32, GlobalStoreF32, {
         uint32_t byte_offset = VM_DecGlobalAttr("global");
-        if (IREE_UNLIKELY(byte_offset >=
-                          module_state->rwdata_storage.data_length)) {
+        if (VM_UnverifiedCheck(byte_offset >=
+                               module_state->rwdata_storage.data_length)) {
           return iree_make_status(
               IREE_STATUS_OUT_OF_RANGE,
               "global byte_offset out of range: %d (rwdata=%zu)", byte_offset,
@@ -2078,6 +2292,7 @@ static iree_status_t iree_vm_bytecode_dispatch(
     float rhs = VM_DecOperandRegF32("rhs");           \
     int32_t* result = VM_DecResultRegI32("result");   \
     *result = op_func(lhs, rhs);                      \
+    VM_FuseCondBranch(result);                        \
   });
 
       DISPATCH_OP_EXT_F32_CMP_F32(CmpEQF32O, vm_cmp_eq_f32o);
@@ -10,6 +10,8 @@
 // avoid defining the IR inline here so that we can run this test on platforms
 // that we can't run the full MLIR compiler stack on.
 
+#include <set>
+
 #include "iree/base/api.h"
 #include "iree/testing/gtest.h"
 #include "iree/vm/api.h"
@@ -33,6 +35,25 @@ std::ostream& operator<<(std::ostream& os, const TestParams& params) {
   return os << name << "_" << params.function_name;
 }
 
+#if IREE_VM_BYTECODE_NATIVE_TIER_ENABLE
+// A native tier that records each function handed to it and declines to
+// translate any so that execution falls back to the interpreter.
+struct DecliningNativeTier {
+  static iree_status_t Translate(void* self, iree_vm_module_t* module,
+                                 uint16_t function_ordinal,
+                                 iree_const_byte_span_t bytecode,
+                                 iree_vm_bytecode_native_entry_t* out_entry) {
+    auto* tier = reinterpret_cast<DecliningNativeTier*>(self);
+    tier->translated_ordinals.push_back(function_ordinal);
+    return iree_make_status(IREE_STATUS_UNIMPLEMENTED, "declined");
+  }
+
+  std::vector<uint16_t> translated_ordinals;
+  iree_vm_bytecode_native_tier_t tier = {this, /*invocation_threshold=*/2,
+                                         DecliningNativeTier::Translate};
+};
+#endif  // IREE_VM_BYTECODE_NATIVE_TIER_ENABLE
+
 std::vector<TestParams> GetModuleTestParams() {
   std::vector<TestParams> test_params;
 
@@ -83,6 +104,10 @@ class VMBytecodeDispatchTest
             reinterpret_cast<const uint8_t*>(test_params.module_file.data),
             test_params.module_file.size},
         iree_allocator_null(), iree_allocator_system(), &bytecode_module_));
+#if IREE_VM_BYTECODE_NATIVE_TIER_ENABLE
+    IREE_CHECK_OK(iree_vm_bytecode_module_set_native_tier(bytecode_module_,
+                                                          &native_tier_.tier));
+#endif  // IREE_VM_BYTECODE_NATIVE_TIER_ENABLE
 
     std::vector<iree_vm_module_t*> modules = {bytecode_module_};
     IREE_CHECK_OK(iree_vm_context_create_with_modules(
@@ -110,6 +135,9 @@ class VMBytecodeDispatchTest
   iree_vm_instance_t* instance_ = nullptr;
   iree_vm_context_t* context_ = nullptr;
   iree_vm_module_t* bytecode_module_ = nullptr;
+#if IREE_VM_BYTECODE_NATIVE_TIER_ENABLE
+  DecliningNativeTier native_tier_;
+#endif  // IREE_VM_BYTECODE_NATIVE_TIER_ENABLE
 };
 
 TEST_P(VMBytecodeDispatchTest, Check) {
@@ -134,6 +162,32 @@ TEST_P(VMBytecodeDispatchTest, Check) {
   }
 }
 
+#if IREE_VM_BYTECODE_NATIVE_TIER_ENABLE
+// Runs each function past the tier threshold: every function reached must be
+// handed to the tier exactly once and keep producing the interpreter's results
+// after the tier declines it.
+TEST_P(VMBytecodeDispatchTest, NativeTierFallback) {
+  const auto& test_params = GetParam();
+  bool expect_failure = test_params.function_name.find("fail_") == 0;
+
+  for (int i = 0; i < 4; ++i) {
+    iree_status_t status = RunFunction(test_params.function_name.c_str());
+    if (expect_failure) {
+      EXPECT_FALSE(iree_status_is_ok(status));
+      iree_status_ignore(status);
+    } else if (!iree_status_is_ok(status)) {
+      GTEST_FAIL() << "Function expected success but failed with error: "
+                   << iree::Status(std::move(status)).ToString();
+    }
+  }
+
+  const auto& ordinals = native_tier_.translated_ordinals;
+  EXPECT_FALSE(ordinals.empty());
+  EXPECT_EQ(std::set<uint16_t>(ordinals.begin(), ordinals.end()).size(),
+            ordinals.size());
+}
+#endif  // IREE_VM_BYTECODE_NATIVE_TIER_ENABLE
+
 INSTANTIATE_TEST_SUITE_P(VMIRFunctions, VMBytecodeDispatchTest,
                          ::testing::ValuesIn(GetModuleTestParams()),
                          ::testing::PrintToStringParamName());
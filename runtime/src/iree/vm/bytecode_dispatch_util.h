@@ -111,9 +111,12 @@ static_assert(offsetof(iree_vm_register_remap_list_t, pairs) == 2,
               "Expect no padding in the struct");
 
 // Maps a type ID to a type def with clamping for out of bounds values.
+// Verified bytecode only contains in-range type IDs and skips the clamping.
 static inline const iree_vm_type_def_t* iree_vm_map_type(
     iree_vm_bytecode_module_t* module, int32_t type_id) {
+#if !IREE_VM_BYTECODE_VERIFICATION_ENABLE
   type_id = type_id >= module->type_count ? 0 : type_id;
+#endif  // !IREE_VM_BYTECODE_VERIFICATION_ENABLE
   return &module->type_table[type_id];
 }
 
@@ -177,6 +180,30 @@ static const int kRegSize = sizeof(uint16_t);
 // Each macro will increment the pc by the number of bytes read and as such must
 // be called in the same order the values are encoded.
 
+// Register ordinals decoded from instruction operands. Bytecode verified at
+// load time is known to only reference registers within the frame with the
+// correct bank bits and 64-bit alignment (see bytecode_verifier.h) and can use
+// the ordinals as-is; otherwise they are masked to the frame register storage.
+// Register lists are not covered and must always be masked.
+#if IREE_VM_BYTECODE_VERIFICATION_ENABLE
+#define VM_RegI32(ordinal) (ordinal)
+#define VM_RegI64(ordinal) (ordinal)
+#define VM_RegRef(ordinal) ((ordinal)&IREE_REF_REGISTER_MASK)
+#else
+#define VM_RegI32(ordinal) ((ordinal)&regs.i32_mask)
+#define VM_RegI64(ordinal) ((ordinal) & (regs.i32_mask & ~1))
+#define VM_RegRef(ordinal) ((ordinal)&regs.ref_mask)
+#endif  // IREE_VM_BYTECODE_VERIFICATION_ENABLE
+
+// Evaluates to |condition| when the bytecode has not been verified at load
+// time and otherwise to false so that range checks on constant operands the
+// verifier has already performed compile out.
+#if IREE_VM_BYTECODE_VERIFICATION_ENABLE
+#define VM_UnverifiedCheck(condition) false
+#else
+#define VM_UnverifiedCheck(condition) IREE_UNLIKELY(condition)
+#endif  // IREE_VM_BYTECODE_VERIFICATION_ENABLE
+
 #define VM_AlignPC(pc, alignment) \
   (pc) = ((pc) + ((alignment)-1)) & ~((alignment)-1)
 
@@ -222,22 +249,22 @@ static inline const iree_vm_register_remap_list_t* VM_DecBranchOperandsImpl(
   *pc = *pc + kRegSize + list->size * 2 * kRegSize;
   return list;
 }
-#define VM_DecOperandRegI32(name)      \
-  regs.i32[OP_I16(0) & regs.i32_mask]; \
+#define VM_DecOperandRegI32(name) \
+  regs.i32[VM_RegI32(OP_I16(0))]; \
   pc += kRegSize;
-#define VM_DecOperandRegI64(name)                           \
-  *((int64_t*)&regs.i32[OP_I16(0) & (regs.i32_mask & ~1)]); \
+#define VM_DecOperandRegI64(name)               \
+  *((int64_t*)&regs.i32[VM_RegI64(OP_I16(0))]); \
   pc += kRegSize;
 #define VM_DecOperandRegI64HostSize(name) \
   (iree_host_size_t) VM_DecOperandRegI64(name)
-#define VM_DecOperandRegF32(name)                  \
-  *((float*)&regs.i32[OP_I16(0) & regs.i32_mask]); \
+#define VM_DecOperandRegF32(name)             \
+  *((float*)&regs.i32[VM_RegI32(OP_I16(0))]); \
   pc += kRegSize;
-#define VM_DecOperandRegF64(name)                          \
-  *((double*)&regs.i32[OP_I16(0) & (regs.i32_mask & ~1)]); \
+#define VM_DecOperandRegF64(name)              \
+  *((double*)&regs.i32[VM_RegI64(OP_I16(0))]); \
   pc += kRegSize;
 #define VM_DecOperandRegRef(name, out_is_move)                      \
-  &regs.ref[OP_I16(0) & regs.ref_mask];                             \
+  &regs.ref[VM_RegRef(OP_I16(0))];                                  \
   *(out_is_move) = 0; /*= OP_I16(0) & IREE_REF_REGISTER_MOVE_BIT;*/ \
   pc += kRegSize;
 #define VM_DecVariadicOperands(name) \
@@ -250,20 +277,20 @@ static inline const iree_vm_register_list_t* VM_DecVariadicOperandsImpl(
   *pc = *pc + kRegSize + list->size * kRegSize;
   return list;
 }
-#define VM_DecResultRegI32(name)        \
-  &regs.i32[OP_I16(0) & regs.i32_mask]; \
+#define VM_DecResultRegI32(name)   \
+  &regs.i32[VM_RegI32(OP_I16(0))]; \
   pc += kRegSize;
-#define VM_DecResultRegI64(name)                           \
-  ((int64_t*)&regs.i32[OP_I16(0) & (regs.i32_mask & ~1)]); \
+#define VM_DecResultRegI64(name)               \
+  ((int64_t*)&regs.i32[VM_RegI64(OP_I16(0))]); \
   pc += kRegSize;
-#define VM_DecResultRegF32(name)                  \
-  ((float*)&regs.i32[OP_I16(0) & regs.i32_mask]); \
+#define VM_DecResultRegF32(name)             \
+  ((float*)&regs.i32[VM_RegI32(OP_I16(0))]); \
   pc += kRegSize;
-#define VM_DecResultRegF64(name)                          \
-  ((double*)&regs.i32[OP_I16(0) & (regs.i32_mask & ~1)]); \
+#define VM_DecResultRegF64(name)              \
+  ((double*)&regs.i32[VM_RegI64(OP_I16(0))]); \
   pc += kRegSize;
 #define VM_DecResultRegRef(name, out_is_move)                       \
-  &regs.ref[OP_I16(0) & regs.ref_mask];                             \
+  &regs.ref[VM_RegRef(OP_I16(0))];                                  \
   *(out_is_move) = 0; /*= OP_I16(0) & IREE_REF_REGISTER_MOVE_BIT;*/ \
   pc += kRegSize;
 #define VM_DecVariadicResults(name) VM_DecVariadicOperands(name)
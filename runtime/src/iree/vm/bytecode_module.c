@@ -236,6 +236,33 @@ static iree_status_t iree_vm_bytecode_module_resolve_types(
   return status;
 }
 
+#if IREE_VM_BYTECODE_VERIFICATION_ENABLE
+// Calculates the limits of the tables the bytecode may reference; the dispatch
+// loop relies on these being checked by the verifier instead of on each
+// instruction executed. |module_def| must have been verified.
+static void iree_vm_bytecode_module_calculate_verifier_limits(
+    iree_vm_BytecodeModuleDef_table_t module_def,
+    iree_vm_bytecode_verifier_limits_t* out_limits) {
+  memset(out_limits, 0, sizeof(*out_limits));
+  out_limits->internal_function_count = iree_vm_FunctionDescriptor_vec_len(
+      iree_vm_BytecodeModuleDef_function_descriptors(module_def));
+  out_limits->import_function_count = iree_vm_ImportFunctionDef_vec_len(
+      iree_vm_BytecodeModuleDef_imported_functions(module_def));
+  out_limits->type_count =
+      iree_vm_TypeDef_vec_len(iree_vm_BytecodeModuleDef_types(module_def));
+  iree_vm_ModuleStateDef_table_t module_state_def =
+      iree_vm_BytecodeModuleDef_module_state(module_def);
+  if (module_state_def) {
+    out_limits->rwdata_size =
+        iree_vm_ModuleStateDef_global_bytes_capacity(module_state_def);
+    out_limits->global_ref_count =
+        iree_vm_ModuleStateDef_global_ref_count(module_state_def);
+  }
+  out_limits->rodata_count = iree_vm_RodataSegmentDef_vec_len(
+      iree_vm_BytecodeModuleDef_rodata_segments(module_def));
+}
+#endif  // IREE_VM_BYTECODE_VERIFICATION_ENABLE
+
 // Verifies the structure of the FlatBuffer so that we can avoid doing so during
 // runtime. There are still some conditions we must be aware of (such as omitted
 // names on functions with internal linkage), however we shouldn't need to
@@ -243,10 +270,17 @@ static iree_status_t iree_vm_bytecode_module_resolve_types(
 static iree_status_t iree_vm_bytecode_module_flatbuffer_verify(
     iree_const_byte_span_t archive_contents,
     iree_const_byte_span_t flatbuffer_contents,
-    iree_host_size_t archive_rodata_offset) {
+    iree_host_size_t archive_rodata_offset,
+    iree_const_byte_span_t parameter_contents,
+    iree_allocator_t host_allocator) {
   // Run flatcc generated verification. This ensures all pointers are in-bounds
   // and that we can safely walk the file, but not that the actual contents of
   // the FlatBuffer meet our expectations.
+  //
+  // This always runs as nothing in the FlatBuffer can be safely read before it
+  // does. flatcc only bounds checks byte vectors and strings instead of walking
+  // them so the cost is proportional to the number of tables (types, segments,
+  // and functions) and not to the size of the embedded rodata or bytecode.
   int verify_ret = iree_vm_BytecodeModuleDef_verify_as_root(
       flatbuffer_contents.data, flatbuffer_contents.data_length);
   if (verify_ret != flatcc_verify_ok) {
@@ -291,6 +325,18 @@ static iree_status_t iree_vm_bytecode_module_flatbuffer_verify(
         iree_vm_RodataSegmentDef_external_data_offset(segment);
     uint64_t segment_length =
         iree_vm_RodataSegmentDef_external_data_length(segment);
+    if (iree_vm_RodataSegmentDef_external_data_in_parameters(segment)) {
+      if (segment_offset > parameter_contents.data_length ||
+          segment_length > parameter_contents.data_length - segment_offset) {
+        return iree_make_status(
+            IREE_STATUS_INVALID_ARGUMENT,
+            "rodata[%zu] parameter reference out of range (parameter file "
+            "has %" PRIhsz " bytes); was the module loaded with the "
+            "parameter file it was compiled with?",
+            i, parameter_contents.data_length);
+      }
+      continue;
+    }
     uint64_t segment_end =
         archive_rodata_offset + segment_offset + segment_length;
     if (segment_end > archive_contents.data_length) {
@@ -380,11 +426,41 @@ static iree_status_t iree_vm_bytecode_module_flatbuffer_verify(
 
   flatbuffers_uint8_vec_t bytecode_data =
       iree_vm_BytecodeModuleDef_bytecode_data(module_def);
+
+#if IREE_VM_BYTECODE_VERIFICATION_ENABLE
+  iree_vm_bytecode_verifier_limits_t verifier_limits;
+  iree_vm_bytecode_module_calculate_verifier_limits(module_def,
+                                                    &verifier_limits);
+#if IREE_VM_BYTECODE_VERIFICATION_LAZY_ENABLE
+  // Function bodies are verified on first call instead.
+  const bool verify_bytecode = false;
+#else
+  bool verify_bytecode = true;
+#endif  // IREE_VM_BYTECODE_VERIFICATION_LAZY_ENABLE
+#if IREE_VM_BYTECODE_VERIFICATION_CACHE_ENABLE && \
+    !IREE_VM_BYTECODE_VERIFICATION_LAZY_ENABLE
+  // The key covers the function descriptors and bytecode but not rodata so
+  // hashing it is cheaper than the verification it skips.
+  const uint64_t verification_key = iree_vm_bytecode_verification_cache_key(
+      &verifier_limits,
+      iree_make_const_byte_span(
+          function_descriptors,
+          iree_vm_FunctionDescriptor_vec_len(function_descriptors) *
+              sizeof(iree_vm_FunctionDescriptor_t)),
+      iree_make_const_byte_span(bytecode_data,
+                                flatbuffers_uint8_vec_len(bytecode_data)));
+  verify_bytecode =
+      !iree_vm_bytecode_verification_cache_lookup(verification_key);
+#endif  // IREE_VM_BYTECODE_VERIFICATION_CACHE_ENABLE &&
+        // !IREE_VM_BYTECODE_VERIFICATION_LAZY_ENABLE
+#endif  // IREE_VM_BYTECODE_VERIFICATION_ENABLE
+
   for (size_t i = 0;
        i < iree_vm_FunctionDescriptor_vec_len(function_descriptors); ++i) {
     iree_vm_FunctionDescriptor_struct_t function_descriptor =
         iree_vm_FunctionDescriptor_vec_at(function_descriptors, i);
     if (function_descriptor->bytecode_offset < 0 ||
+        function_descriptor->bytecode_length < 0 ||
         function_descriptor->bytecode_offset +
                 function_descriptor->bytecode_length >
             flatbuffers_uint8_vec_len(bytecode_data)) {
@@ -401,9 +477,32 @@ static iree_status_t iree_vm_bytecode_module_flatbuffer_verify(
           "functions[%zu] descriptor register count out of range", i);
     }
 
-    // TODO(benvanik): run bytecode verifier on contents.
+#if IREE_VM_BYTECODE_VERIFICATION_ENABLE
+    if (verify_bytecode) {
+      iree_status_t status = iree_vm_bytecode_verify_function(
+          &verifier_limits,
+          iree_make_const_byte_span(
+              bytecode_data + function_descriptor->bytecode_offset,
+              function_descriptor->bytecode_length),
+          function_descriptor->i32_register_count,
+          function_descriptor->ref_register_count, host_allocator);
+      if (!iree_status_is_ok(status)) {
+        return iree_status_annotate_f(status, "verifying functions[%zu]", i);
+      }
+    }
+#endif  // IREE_VM_BYTECODE_VERIFICATION_ENABLE
   }
 
+#if IREE_VM_BYTECODE_VERIFICATION_ENABLE &&     \
+    IREE_VM_BYTECODE_VERIFICATION_CACHE_ENABLE && \
+    !IREE_VM_BYTECODE_VERIFICATION_LAZY_ENABLE
+  if (verify_bytecode) {
+    iree_vm_bytecode_verification_cache_insert(verification_key);
+  }
+#endif  // IREE_VM_BYTECODE_VERIFICATION_ENABLE &&
+        // IREE_VM_BYTECODE_VERIFICATION_CACHE_ENABLE &&
+        // !IREE_VM_BYTECODE_VERIFICATION_LAZY_ENABLE
+
   return iree_ok_status();
 }
 
@@ -457,6 +556,16 @@ static void iree_vm_bytecode_module_destroy(void* self) {
                       (void*)module->archive_contents.data);
   module->archive_contents = iree_const_byte_span_empty();
   module->archive_allocator = iree_allocator_null();
+  iree_allocator_free(module->parameter_allocator,
+                      (void*)module->parameter_contents.data);
+  module->parameter_contents = iree_const_byte_span_empty();
+  module->parameter_allocator = iree_allocator_null();
+
+#if IREE_VM_BYTECODE_NATIVE_TIER_ENABLE
+  iree_allocator_free(module->allocator, module->native_slots);
+  module->native_slots = NULL;
+  module->native_tier = NULL;
+#endif  // IREE_VM_BYTECODE_NATIVE_TIER_ENABLE
 
   iree_allocator_free(module->allocator, module);
 
@@ -936,6 +1045,33 @@ static iree_host_size_t iree_vm_bytecode_module_layout_state(
   return offset;
 }
 
+// Returns the bytes of the rodata |segment| referenced directly from the
+// module archive or parameter file memory.
+static iree_byte_span_t iree_vm_bytecode_module_rodata_span(
+    iree_vm_bytecode_module_t* module,
+    iree_vm_RodataSegmentDef_table_t segment) {
+  if (iree_vm_RodataSegmentDef_embedded_data_is_present(segment)) {
+    // Data is embedded in the FlatBuffer.
+    return iree_make_byte_span(
+        (uint8_t*)iree_vm_RodataSegmentDef_embedded_data(segment),
+        flatbuffers_uint8_vec_len(
+            iree_vm_RodataSegmentDef_embedded_data(segment)));
+  }
+  if (iree_vm_RodataSegmentDef_external_data_in_parameters(segment)) {
+    // Data is stored in the parameter file at an absolute offset.
+    return iree_make_byte_span(
+        (uint8_t*)module->parameter_contents.data +
+            iree_vm_RodataSegmentDef_external_data_offset(segment),
+        iree_vm_RodataSegmentDef_external_data_length(segment));
+  }
+  // Data is concatenated with the FlatBuffer at some relative offset.
+  // Note that we've already verified the referenced range is in bounds.
+  return iree_make_byte_span(
+      (uint8_t*)module->archive_contents.data + module->archive_rodata_offset +
+          iree_vm_RodataSegmentDef_external_data_offset(segment),
+      iree_vm_RodataSegmentDef_external_data_length(segment));
+}
+
 static iree_status_t iree_vm_bytecode_module_alloc_state(
     void* self, iree_allocator_t allocator,
     iree_vm_module_state_t** out_module_state) {
@@ -964,24 +1100,8 @@ static iree_status_t iree_vm_bytecode_module_alloc_state(
   iree_vm_RodataSegmentDef_vec_t rodata_segments =
       iree_vm_BytecodeModuleDef_rodata_segments(module_def);
   for (int i = 0; i < state->rodata_ref_count; ++i) {
-    iree_vm_RodataSegmentDef_table_t segment =
-        iree_vm_RodataSegmentDef_vec_at(rodata_segments, i);
-    iree_byte_span_t byte_span = iree_byte_span_empty();
-    if (iree_vm_RodataSegmentDef_embedded_data_is_present(segment)) {
-      // Data is embedded in the FlatBuffer.
-      byte_span = iree_make_byte_span(
-          (uint8_t*)iree_vm_RodataSegmentDef_embedded_data(segment),
-          flatbuffers_uint8_vec_len(
-              iree_vm_RodataSegmentDef_embedded_data(segment)));
-    } else {
-      // Data is concatenated with the FlatBuffer at some relative offset.
-      // Note that we've already verified the referenced range is in bounds.
-      byte_span = iree_make_byte_span(
-          (uint8_t*)module->archive_contents.data +
-              module->archive_rodata_offset +
-              iree_vm_RodataSegmentDef_external_data_offset(segment),
-          iree_vm_RodataSegmentDef_external_data_length(segment));
-    }
+    iree_byte_span_t byte_span = iree_vm_bytecode_module_rodata_span(
+        module, iree_vm_RodataSegmentDef_vec_at(rodata_segments, i));
     iree_vm_buffer_t* ref = &state->rodata_ref_table[i];
     iree_vm_buffer_initialize(IREE_VM_BUFFER_ACCESS_ORIGIN_MODULE, byte_span,
                               iree_allocator_null(), ref);
@@ -1016,6 +1136,43 @@ static void iree_vm_bytecode_module_free_state(
   IREE_TRACE_ZONE_END(z0);
 }
 
+static iree_status_t iree_vm_bytecode_module_fork_state(
+    void* self, iree_vm_module_state_t* parent_module_state,
+    iree_allocator_t allocator, iree_vm_module_state_t** out_module_state) {
+  IREE_ASSERT_ARGUMENT(parent_module_state);
+  IREE_ASSERT_ARGUMENT(out_module_state);
+  IREE_TRACE_ZONE_BEGIN(z0);
+  *out_module_state = NULL;
+
+  iree_vm_bytecode_module_state_t* parent_state =
+      (iree_vm_bytecode_module_state_t*)parent_module_state;
+
+  // Start from a fresh state with rodata setup.
+  iree_vm_module_state_t* module_state = NULL;
+  IREE_RETURN_AND_END_ZONE_IF_ERROR(
+      z0, iree_vm_bytecode_module_alloc_state(self, allocator, &module_state));
+  iree_vm_bytecode_module_state_t* state =
+      (iree_vm_bytecode_module_state_t*)module_state;
+
+  // Copy primitive globals and retain the ref globals as they were after the
+  // parent was initialized.
+  memcpy(state->rwdata_storage.data, parent_state->rwdata_storage.data,
+         state->rwdata_storage.data_length);
+  for (iree_host_size_t i = 0; i < state->global_ref_count; ++i) {
+    iree_vm_ref_retain(&parent_state->global_ref_table[i],
+                       &state->global_ref_table[i]);
+  }
+
+  // Carry over resolved imports. Import function states are resolved at call
+  // time and will use the states of the context the call is made within.
+  memcpy(state->import_table, parent_state->import_table,
+         state->import_count * sizeof(*state->import_table));
+
+  *out_module_state = module_state;
+  IREE_TRACE_ZONE_END(z0);
+  return iree_ok_status();
+}
+
 static iree_status_t iree_vm_bytecode_module_resolve_import(
     void* self, iree_vm_module_state_t* module_state, iree_host_size_t ordinal,
     const iree_vm_function_t* function,
@@ -1122,6 +1279,18 @@ IREE_API_EXPORT iree_status_t iree_vm_bytecode_module_create(
     iree_vm_instance_t* instance, iree_const_byte_span_t archive_contents,
     iree_allocator_t archive_allocator, iree_allocator_t allocator,
     iree_vm_module_t** out_module) {
+  return iree_vm_bytecode_module_create_with_parameters(
+      instance, archive_contents, archive_allocator,
+      iree_const_byte_span_empty(), iree_allocator_null(), allocator,
+      out_module);
+}
+
+IREE_API_EXPORT iree_status_t iree_vm_bytecode_module_create_with_parameters(
+    iree_vm_instance_t* instance, iree_const_byte_span_t archive_contents,
+    iree_allocator_t archive_allocator,
+    iree_const_byte_span_t parameter_contents,
+    iree_allocator_t parameter_allocator, iree_allocator_t allocator,
+    iree_vm_module_t** out_module) {
   IREE_TRACE_ZONE_BEGIN(z0);
   IREE_ASSERT_ARGUMENT(out_module);
   *out_module = NULL;
@@ -1135,7 +1304,8 @@ IREE_API_EXPORT iree_status_t iree_vm_bytecode_module_create(
 
   IREE_TRACE_ZONE_BEGIN_NAMED(z1, "iree_vm_bytecode_module_flatbuffer_verify");
   iree_status_t status = iree_vm_bytecode_module_flatbuffer_verify(
-      archive_contents, flatbuffer_contents, archive_rodata_offset);
+      archive_contents, flatbuffer_contents, archive_rodata_offset,
+      parameter_contents, allocator);
   if (!iree_status_is_ok(status)) {
     IREE_TRACE_ZONE_END(z1);
     IREE_TRACE_ZONE_END(z0);
@@ -1156,19 +1326,53 @@ IREE_API_EXPORT iree_status_t iree_vm_bytecode_module_create(
   iree_vm_TypeDef_vec_t type_defs = iree_vm_BytecodeModuleDef_types(module_def);
   size_t type_table_size =
       iree_vm_TypeDef_vec_len(type_defs) * sizeof(iree_vm_type_def_t);
+  iree_vm_FunctionDescriptor_vec_t function_descriptors =
+      iree_vm_BytecodeModuleDef_function_descriptors(module_def);
+  iree_host_size_t function_descriptor_count =
+      iree_vm_FunctionDescriptor_vec_len(function_descriptors);
+  size_t frame_layout_table_size =
+      function_descriptor_count * sizeof(iree_vm_bytecode_frame_layout_t);
+  size_t function_verified_size = 0;
+#if IREE_VM_BYTECODE_VERIFICATION_ENABLE && \
+    IREE_VM_BYTECODE_VERIFICATION_LAZY_ENABLE
+  function_verified_size =
+      function_descriptor_count * sizeof(iree_atomic_int32_t);
+#endif  // IREE_VM_BYTECODE_VERIFICATION_ENABLE &&
+        // IREE_VM_BYTECODE_VERIFICATION_LAZY_ENABLE
 
   iree_vm_bytecode_module_t* module = NULL;
   IREE_RETURN_AND_END_ZONE_IF_ERROR(
-      z0, iree_allocator_malloc(allocator, sizeof(*module) + type_table_size,
+      z0, iree_allocator_malloc(allocator,
+                                sizeof(*module) + type_table_size +
+                                    frame_layout_table_size +
+                                    function_verified_size,
                                 (void**)&module));
   module->allocator = allocator;
 
-  iree_vm_FunctionDescriptor_vec_t function_descriptors =
-      iree_vm_BytecodeModuleDef_function_descriptors(module_def);
-  module->function_descriptor_count =
-      iree_vm_FunctionDescriptor_vec_len(function_descriptors);
+  module->function_descriptor_count = function_descriptor_count;
   module->function_descriptor_table = function_descriptors;
 
+  // Frame layouts are computed once here instead of on each function entry.
+  iree_vm_bytecode_frame_layout_t* frame_layout_table =
+      (iree_vm_bytecode_frame_layout_t*)((uint8_t*)module->type_table +
+                                         type_table_size);
+  for (iree_host_size_t i = 0; i < function_descriptor_count; ++i) {
+    iree_vm_bytecode_compute_frame_layout(&function_descriptors[i],
+                                          &frame_layout_table[i]);
+  }
+  module->frame_layout_table = frame_layout_table;
+
+#if IREE_VM_BYTECODE_VERIFICATION_ENABLE && \
+    IREE_VM_BYTECODE_VERIFICATION_LAZY_ENABLE
+  // Flags start cleared as the allocation is zeroed.
+  iree_vm_bytecode_module_calculate_verifier_limits(module_def,
+                                                    &module->verifier_limits);
+  module->function_verified =
+      (iree_atomic_int32_t*)((uint8_t*)frame_layout_table +
+                             frame_layout_table_size);
+#endif  // IREE_VM_BYTECODE_VERIFICATION_ENABLE &&
+        // IREE_VM_BYTECODE_VERIFICATION_LAZY_ENABLE
+
   flatbuffers_uint8_vec_t bytecode_data =
       iree_vm_BytecodeModuleDef_bytecode_data(module_def);
   module->bytecode_data = iree_make_const_byte_span(
@@ -1177,6 +1381,8 @@ IREE_API_EXPORT iree_status_t iree_vm_bytecode_module_create(
   module->archive_contents = archive_contents;
   module->archive_allocator = archive_allocator;
   module->archive_rodata_offset = archive_rodata_offset;
+  module->parameter_contents = parameter_contents;
+  module->parameter_allocator = parameter_allocator;
   module->def = module_def;
 
   module->type_count = iree_vm_TypeDef_vec_len(type_defs);
@@ -1205,6 +1411,7 @@ IREE_API_EXPORT iree_status_t iree_vm_bytecode_module_create(
 #endif  // IREE_VM_BACKTRACE_ENABLE
   module->interface.alloc_state = iree_vm_bytecode_module_alloc_state;
   module->interface.free_state = iree_vm_bytecode_module_free_state;
+  module->interface.fork_state = iree_vm_bytecode_module_fork_state;
   module->interface.resolve_import = iree_vm_bytecode_module_resolve_import;
   module->interface.notify = iree_vm_bytecode_module_notify;
   module->interface.begin_call = iree_vm_bytecode_module_begin_call;
@@ -1214,3 +1421,99 @@ IREE_API_EXPORT iree_status_t iree_vm_bytecode_module_create(
   IREE_TRACE_ZONE_END(z0);
   return iree_ok_status();
 }
+
+#if IREE_VM_BYTECODE_VERIFICATION_ENABLE && \
+    IREE_VM_BYTECODE_VERIFICATION_LAZY_ENABLE
+iree_status_t iree_vm_bytecode_module_verify_function(
+    iree_vm_bytecode_module_t* module, uint16_t function_ordinal) {
+  IREE_TRACE_ZONE_BEGIN(z0);
+  // Descriptor spans and register counts were checked when the module was
+  // loaded.
+  const iree_vm_FunctionDescriptor_t* function_descriptor =
+      &module->function_descriptor_table[function_ordinal];
+  iree_status_t status = iree_vm_bytecode_verify_function(
+      &module->verifier_limits,
+      iree_make_const_byte_span(
+          module->bytecode_data.data + function_descriptor->bytecode_offset,
+          function_descriptor->bytecode_length),
+      function_descriptor->i32_register_count,
+      function_descriptor->ref_register_count, module->allocator);
+  if (iree_status_is_ok(status)) {
+    iree_atomic_store_int32(&module->function_verified[function_ordinal], 1,
+                            iree_memory_order_release);
+  } else {
+    status = iree_status_annotate_f(status, "verifying functions[%u]",
+                                    function_ordinal);
+  }
+  IREE_TRACE_ZONE_END(z0);
+  return status;
+}
+#endif  // IREE_VM_BYTECODE_VERIFICATION_ENABLE &&
+        // IREE_VM_BYTECODE_VERIFICATION_LAZY_ENABLE
+
+IREE_API_EXPORT iree_status_t iree_vm_bytecode_module_advise_rodata(
+    iree_vm_module_t* module, iree_vm_buffer_advice_t advice) {
+  IREE_ASSERT_ARGUMENT(module);
+  if (module->destroy != iree_vm_bytecode_module_destroy) {
+    return iree_make_status(IREE_STATUS_INVALID_ARGUMENT,
+                            "module is not a bytecode module");
+  }
+  iree_vm_bytecode_module_t* bytecode_module =
+      (iree_vm_bytecode_module_t*)module->self;
+  IREE_TRACE_ZONE_BEGIN(z0);
+  iree_vm_RodataSegmentDef_vec_t rodata_segments =
+      iree_vm_BytecodeModuleDef_rodata_segments(bytecode_module->def);
+  for (size_t i = 0; i < iree_vm_RodataSegmentDef_vec_len(rodata_segments);
+       ++i) {
+    iree_vm_buffer_t buffer;
+    iree_vm_buffer_initialize(
+        IREE_VM_BUFFER_ACCESS_ORIGIN_MODULE,
+        iree_vm_bytecode_module_rodata_span(
+            bytecode_module,
+            iree_vm_RodataSegmentDef_vec_at(rodata_segments, i)),
+        iree_allocator_null(), &buffer);
+    iree_vm_buffer_advise(&buffer, 0, IREE_HOST_SIZE_MAX, advice);
+    iree_vm_buffer_deinitialize(&buffer);
+  }
+  IREE_TRACE_ZONE_END(z0);
+  return iree_ok_status();
+}
+
+#if IREE_VM_BYTECODE_NATIVE_TIER_ENABLE
+
+IREE_API_EXPORT iree_status_t iree_vm_bytecode_module_set_native_tier(
+    iree_vm_module_t* module, const iree_vm_bytecode_native_tier_t* tier) {
+  IREE_ASSERT_ARGUMENT(module);
+  IREE_ASSERT_ARGUMENT(tier);
+  if (module->destroy != iree_vm_bytecode_module_destroy) {
+    return iree_make_status(IREE_STATUS_INVALID_ARGUMENT,
+                            "module is not a bytecode module");
+  }
+  iree_vm_bytecode_module_t* bytecode_module =
+      (iree_vm_bytecode_module_t*)module->self;
+  if (bytecode_module->native_tier) {
+    return iree_make_status(IREE_STATUS_FAILED_PRECONDITION,
+                            "module already has a native tier");
+  }
+  if (!tier->translate) {
+    return iree_make_status(IREE_STATUS_INVALID_ARGUMENT,
+                            "native tier has no translate function");
+  }
+  if (tier->invocation_threshold == 0 ||
+      tier->invocation_threshold > INT32_MAX) {
+    return iree_make_status(IREE_STATUS_INVALID_ARGUMENT,
+                            "native tier invocation threshold %u out of range",
+                            tier->invocation_threshold);
+  }
+  IREE_TRACE_ZONE_BEGIN(z0);
+  IREE_RETURN_AND_END_ZONE_IF_ERROR(
+      z0, iree_allocator_malloc(bytecode_module->allocator,
+                                bytecode_module->function_descriptor_count *
+                                    sizeof(*bytecode_module->native_slots),
+                                (void**)&bytecode_module->native_slots));
+  bytecode_module->native_tier = tier;
+  IREE_TRACE_ZONE_END(z0);
+  return iree_ok_status();
+}
+
+#endif  // IREE_VM_BYTECODE_NATIVE_TIER_ENABLE
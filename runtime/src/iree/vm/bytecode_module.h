@@ -25,6 +25,23 @@ IREE_API_EXPORT iree_status_t iree_vm_bytecode_module_create(
     iree_allocator_t archive_allocator, iree_allocator_t allocator,
     iree_vm_module_t** out_module);
 
+// Creates a VM module from an in-memory ModuleDef FlatBuffer archive with
+// rodata segments stored in a separate |parameter_contents| file produced by
+// the compiler alongside the module. Parameter files contain only raw
+// constant data at the offsets recorded in the module and can be replaced with
+// new contents of the same layout (such as retrained weights) without
+// recompiling. The parameter file is usually memory-mapped so that constants
+// are paged in at disk bandwidth as they are uploaded to devices.
+// If a |parameter_allocator| is provided then it will be used to free the
+// |parameter_contents| when the module is destroyed and otherwise the
+// ownership of the memory remains with the caller.
+IREE_API_EXPORT iree_status_t iree_vm_bytecode_module_create_with_parameters(
+    iree_vm_instance_t* instance, iree_const_byte_span_t archive_contents,
+    iree_allocator_t archive_allocator,
+    iree_const_byte_span_t parameter_contents,
+    iree_allocator_t parameter_allocator, iree_allocator_t allocator,
+    iree_vm_module_t** out_module);
+
 // Parses the module archive header in |archive_contents|.
 // The subrange containing the FlatBuffer data is returned as well as the
 // offset where external rodata begins. Note that archives may have
@@ -34,6 +51,75 @@ IREE_API_EXPORT iree_status_t iree_vm_bytecode_module_parse_header(
     iree_const_byte_span_t* out_flatbuffer_contents,
     iree_host_size_t* out_rodata_offset);
 
+// Advises the system how the rodata segments of the bytecode |module| will be
+// accessed. Rodata referenced from the module archive is never touched when
+// the module is created and is only paged in as used. When the archive is a
+// memory-mapped file IREE_VM_BUFFER_ADVICE_WILL_NEED can be used to prefetch
+// constants ahead of first use and IREE_VM_BUFFER_ADVICE_DONT_NEED to release
+// pages that have been uploaded to devices and are no longer needed.
+IREE_API_EXPORT iree_status_t iree_vm_bytecode_module_advise_rodata(
+    iree_vm_module_t* module, iree_vm_buffer_advice_t advice);
+
+#if IREE_VM_BYTECODE_NATIVE_TIER_ENABLE
+
+// Register banks and module globals of a bytecode frame as seen by a native
+// tier function. Registers use the interpreter's layout and all indexing must
+// be ANDed with the bank mask.
+typedef struct iree_vm_bytecode_native_frame_t {
+  // Global storage of the module state the frame executes with.
+  iree_byte_span_t rwdata;
+  uint16_t i32_mask;
+  int32_t* i32;
+  uint16_t ref_mask;
+  iree_vm_ref_t* ref;
+} iree_vm_bytecode_native_frame_t;
+
+// Executes the entire body of a translated bytecode function on |frame|.
+// The frame has been entered and its argument registers populated exactly as
+// they would be for the interpreter. On success |out_result_registers| must be
+// set to the register list of the executed vm.return op and the caller
+// marshals the results and leaves the frame.
+//
+// Native functions must not call imports or other functions and must not
+// yield: functions containing such ops must be left to the interpreter.
+typedef iree_status_t(IREE_API_PTR* iree_vm_bytecode_native_function_t)(
+    void* user_data, iree_vm_stack_t* stack, iree_vm_stack_frame_t* frame,
+    const iree_vm_bytecode_native_frame_t* native_frame,
+    const iree_vm_register_list_t** out_result_registers);
+
+// A translated native entry point for a bytecode function.
+typedef struct iree_vm_bytecode_native_entry_t {
+  iree_vm_bytecode_native_function_t fn;
+  void* user_data;
+} iree_vm_bytecode_native_entry_t;
+
+// A native tier translating hot bytecode functions.
+typedef struct iree_vm_bytecode_native_tier_t {
+  void* self;
+  // Number of invocations of a function before it is translated, in
+  // [1, INT32_MAX].
+  uint32_t invocation_threshold;
+  // Translates the internal function |function_ordinal| of |module| with the
+  // given |bytecode| body. Leaving |out_entry->fn| NULL or returning an error
+  // keeps the function in the interpreter; errors are ignored. Called at most
+  // once per function and may be called concurrently for different functions.
+  iree_status_t(IREE_API_PTR* translate)(
+      void* self, iree_vm_module_t* module, uint16_t function_ordinal,
+      iree_const_byte_span_t bytecode,
+      iree_vm_bytecode_native_entry_t* out_entry);
+} iree_vm_bytecode_native_tier_t;
+
+// Registers a native |tier| with the bytecode |module|. Must be called before
+// any context using the module is created. |tier| must remain valid for the
+// lifetime of the module.
+//
+// Functions are always interpreted when resumed after a yield and when
+// execution tracing is enabled on the invocation.
+IREE_API_EXPORT iree_status_t iree_vm_bytecode_module_set_native_tier(
+    iree_vm_module_t* module, const iree_vm_bytecode_native_tier_t* tier);
+
+#endif  // IREE_VM_BYTECODE_NATIVE_TIER_ENABLE
+
 #ifdef __cplusplus
 }  // extern "C"
 #endif  // __cplusplus
@@ -17,6 +17,8 @@
 
 #include "iree/base/api.h"
 #include "iree/vm/api.h"
+#include "iree/vm/bytecode_module.h"
+#include "iree/vm/bytecode_verifier.h"
 
 // NOTE: include order matters:
 #include "iree/base/internal/flatcc/parsing.h"
@@ -41,18 +43,33 @@ extern "C" {
 // Matches BytecodeEncoder::kVersionMinor in the compiler.
 #define IREE_VM_BYTECODE_VERSION_MINOR 0
 
-// Maximum register count per bank.
-// This determines the bits required to reference registers in the VM bytecode.
-#define IREE_I32_REGISTER_COUNT 0x7FFF
-#define IREE_REF_REGISTER_COUNT 0x7FFF
-
-#define IREE_I32_REGISTER_MASK 0x7FFF
-
-#define IREE_REF_REGISTER_TYPE_BIT 0x8000
-#define IREE_REF_REGISTER_MOVE_BIT 0x4000
-#define IREE_REF_REGISTER_MASK 0x3FFF
-
 // A loaded bytecode module.
+// Stack frame layout of a bytecode function precomputed when the module is
+// loaded so that function entry only needs to bump the stack.
+typedef struct iree_vm_bytecode_frame_layout_t {
+  // Total size of the frame storage including registers, in bytes, or 0 if the
+  // register counts of the function exceed the register limits.
+  uint32_t frame_size;
+  // Counts of each register type rounded up to the next power of two.
+  uint16_t i32_register_count;
+  uint16_t ref_register_count;
+  // Relative byte offsets from the head of the frame storage.
+  uint32_t i32_register_offset;
+  uint32_t ref_register_offset;
+} iree_vm_bytecode_frame_layout_t;
+
+#if IREE_VM_BYTECODE_NATIVE_TIER_ENABLE
+// Per-function native tier state mapped 1:1 with internal functions.
+typedef struct iree_vm_bytecode_native_slot_t {
+  // Number of invocations counted so far, saturating at the tier threshold.
+  iree_atomic_int32_t invocation_count;
+  // Translated iree_vm_bytecode_native_function_t, or 0 if interpreted.
+  // Published with release semantics after |user_data| is set.
+  iree_atomic_intptr_t fn;
+  void* user_data;
+} iree_vm_bytecode_native_slot_t;
+#endif  // IREE_VM_BYTECODE_NATIVE_TIER_ENABLE
+
 typedef struct iree_vm_bytecode_module_t {
   // Interface routing to the bytecode module functions.
   // Must be first in the struct as we dereference the interface to find our
@@ -65,6 +82,9 @@ typedef struct iree_vm_bytecode_module_t {
   iree_host_size_t function_descriptor_count;
   const iree_vm_FunctionDescriptor_t* function_descriptor_table;
 
+  // Precomputed frame layouts mapped 1:1 with internal functions.
+  const iree_vm_bytecode_frame_layout_t* frame_layout_table;
+
   // A pointer to the bytecode data embedded within the module.
   iree_const_byte_span_t bytecode_data;
 
@@ -80,9 +100,31 @@ typedef struct iree_vm_bytecode_module_t {
   // aligned physical offset where content is located.
   iree_host_size_t archive_rodata_offset;
 
+  // Optional parameter file data and allocator (which may be null) holding
+  // rodata segments marked as external_data_in_parameters.
+  iree_const_byte_span_t parameter_contents;
+  iree_allocator_t parameter_allocator;
+
   // Loaded FlatBuffer module pointing into the archive contents.
   iree_vm_BytecodeModuleDef_table_t def;
 
+#if IREE_VM_BYTECODE_NATIVE_TIER_ENABLE
+  // Optional native tier and its per-function slots, allocated from
+  // |allocator| when the tier is set.
+  const iree_vm_bytecode_native_tier_t* native_tier;
+  iree_vm_bytecode_native_slot_t* native_slots;
+#endif  // IREE_VM_BYTECODE_NATIVE_TIER_ENABLE
+
+#if IREE_VM_BYTECODE_VERIFICATION_ENABLE && \
+    IREE_VM_BYTECODE_VERIFICATION_LAZY_ENABLE
+  // Limits the function bodies are verified against when first entered.
+  iree_vm_bytecode_verifier_limits_t verifier_limits;
+  // Per-function flags mapped 1:1 with internal functions that are set with
+  // release semantics once the function body has been verified.
+  iree_atomic_int32_t* function_verified;
+#endif  // IREE_VM_BYTECODE_VERIFICATION_ENABLE &&
+        // IREE_VM_BYTECODE_VERIFICATION_LAZY_ENABLE
+
   // Type table mapping module type IDs to registered VM types.
   iree_host_size_t type_count;
   iree_vm_type_def_t type_table[];
@@ -138,6 +180,20 @@ typedef struct iree_vm_bytecode_module_state_t {
   iree_allocator_t allocator;
 } iree_vm_bytecode_module_state_t;
 
+// Computes the stack frame layout of a function with |descriptor|.
+void iree_vm_bytecode_compute_frame_layout(
+    const iree_vm_FunctionDescriptor_t* descriptor,
+    iree_vm_bytecode_frame_layout_t* out_layout);
+
+#if IREE_VM_BYTECODE_VERIFICATION_ENABLE && \
+    IREE_VM_BYTECODE_VERIFICATION_LAZY_ENABLE
+// Verifies the body of the internal function |function_ordinal| and marks it as
+// verified on success. May be called concurrently for the same function.
+iree_status_t iree_vm_bytecode_module_verify_function(
+    iree_vm_bytecode_module_t* module, uint16_t function_ordinal);
+#endif  // IREE_VM_BYTECODE_VERIFICATION_ENABLE &&
+        // IREE_VM_BYTECODE_VERIFICATION_LAZY_ENABLE
+
 // Begins execution of the current frame and continues until either a yield or
 // return.
 iree_status_t iree_vm_bytecode_dispatch_begin(
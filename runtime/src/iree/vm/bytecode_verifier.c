@@ -0,0 +1,720 @@
+// Copyright 2023 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include "iree/vm/bytecode_verifier.h"
+
+#include <string.h>
+
+#include "iree/base/alignment.h"
+#include "iree/base/internal/math.h"
+#include "iree/base/tracing.h"
+#include "iree/vm/generated/bytecode_op_table.h"
+
+#if IREE_VM_BYTECODE_VERIFICATION_CACHE_ENABLE
+#include "iree/base/internal/call_once.h"
+#include "iree/base/internal/synchronization.h"
+#endif  // IREE_VM_BYTECODE_VERIFICATION_CACHE_ENABLE
+
+//===----------------------------------------------------------------------===//
+// Operand encodings
+//===----------------------------------------------------------------------===//
+// Each opcode maps to a string describing its operands in the order they are
+// encoded, one character per operand. The strings mirror the VM_Dec* sequences
+// used by bytecode_dispatch.c and must be kept in sync with it. NULL entries
+// are reserved or unsupported opcodes.
+//
+//   i: 32-bit register (i32/f32); 16-bit ordinal with no ref type bit
+//   l: 64-bit register (i64/f64); 16-bit even ordinal covering ordinal+1
+//   r: ref register; 16-bit ordinal with the ref type bit set
+//   g: 32-bit global; 32-bit byte offset into rwdata
+//   G: 64-bit global; 32-bit byte offset into rwdata
+//   q: ref global; 32-bit ordinal into the global ref table
+//   o: rodata; 32-bit ordinal into the rodata segment table
+//   t: type; 32-bit ordinal into the module type table
+//   c: callee; 32-bit internal function ordinal or import ordinal with MSB set
+//   a: 32-bit immediate
+//   A: 64-bit immediate
+//   s: string; 16-bit length followed by that many bytes
+//   v: register list; 2-byte aligned 16-bit count followed by registers
+//   n: value list; 2-byte aligned 16-bit count followed by 16-bit values
+//   b: branch target; 32-bit pc of an instruction within the function
+//   m: branch remap list; 2-byte aligned 16-bit count followed by src/dst
+//      register pairs
+
+static const char* const iree_vm_bytecode_core_op_encodings[256] = {
+  [IREE_VM_OP_CORE_GlobalLoadI32] = "gi",
+  [IREE_VM_OP_CORE_GlobalStoreI32] = "gi",
+  [IREE_VM_OP_CORE_GlobalLoadIndirectI32] = "ii",
+  [IREE_VM_OP_CORE_GlobalStoreIndirectI32] = "ii",
+  [IREE_VM_OP_CORE_GlobalLoadI64] = "Gl",
+  [IREE_VM_OP_CORE_GlobalStoreI64] = "Gl",
+  [IREE_VM_OP_CORE_GlobalLoadIndirectI64] = "il",
+  [IREE_VM_OP_CORE_GlobalStoreIndirectI64] = "il",
+  [IREE_VM_OP_CORE_GlobalLoadRef] = "qtr",
+  [IREE_VM_OP_CORE_GlobalStoreRef] = "qtr",
+  [IREE_VM_OP_CORE_GlobalLoadIndirectRef] = "itr",
+  [IREE_VM_OP_CORE_GlobalStoreIndirectRef] = "itr",
+  [IREE_VM_OP_CORE_ConstI32] = "ai",
+  [IREE_VM_OP_CORE_ConstI32Zero] = "i",
+  [IREE_VM_OP_CORE_ConstI64] = "Al",
+  [IREE_VM_OP_CORE_ConstI64Zero] = "l",
+  [IREE_VM_OP_CORE_ConstRefZero] = "r",
+  [IREE_VM_OP_CORE_ConstRefRodata] = "or",
+  [IREE_VM_OP_CORE_BufferAlloc] = "lr",
+  [IREE_VM_OP_CORE_BufferClone] = "rllr",
+  [IREE_VM_OP_CORE_BufferLength] = "rl",
+  [IREE_VM_OP_CORE_BufferCopy] = "rlrll",
+  [IREE_VM_OP_CORE_BufferCompare] = "rlrlli",
+  [IREE_VM_OP_CORE_BufferFillI8] = "rlli",
+  [IREE_VM_OP_CORE_BufferFillI16] = "rlli",
+  [IREE_VM_OP_CORE_BufferFillI32] = "rlli",
+  [IREE_VM_OP_CORE_BufferFillI64] = "rlll",
+  [IREE_VM_OP_CORE_BufferLoadI8U] = "rli",
+  [IREE_VM_OP_CORE_BufferLoadI8S] = "rli",
+  [IREE_VM_OP_CORE_BufferLoadI16U] = "rli",
+  [IREE_VM_OP_CORE_BufferLoadI16S] = "rli",
+  [IREE_VM_OP_CORE_BufferLoadI32] = "rli",
+  [IREE_VM_OP_CORE_BufferLoadI64] = "rll",
+  [IREE_VM_OP_CORE_BufferStoreI8] = "rli",
+  [IREE_VM_OP_CORE_BufferStoreI16] = "rli",
+  [IREE_VM_OP_CORE_BufferStoreI32] = "rli",
+  [IREE_VM_OP_CORE_BufferStoreI64] = "rll",
+  [IREE_VM_OP_CORE_ListAlloc] = "tir",
+  [IREE_VM_OP_CORE_ListReserve] = "ri",
+  [IREE_VM_OP_CORE_ListSize] = "ri",
+  [IREE_VM_OP_CORE_ListResize] = "ri",
+  [IREE_VM_OP_CORE_ListGetI32] = "rii",
+  [IREE_VM_OP_CORE_ListSetI32] = "rii",
+  [IREE_VM_OP_CORE_ListGetI64] = "ril",
+  [IREE_VM_OP_CORE_ListSetI64] = "ril",
+  [IREE_VM_OP_CORE_ListGetRef] = "ritr",
+  [IREE_VM_OP_CORE_ListSetRef] = "rir",
+  [IREE_VM_OP_CORE_SelectI32] = "iiii",
+  [IREE_VM_OP_CORE_SelectI64] = "illl",
+  [IREE_VM_OP_CORE_SelectRef] = "itrrr",
+  [IREE_VM_OP_CORE_SwitchI32] = "iavi",
+  [IREE_VM_OP_CORE_SwitchI64] = "iAvl",
+  [IREE_VM_OP_CORE_SwitchRef] = "itrvr",
+  [IREE_VM_OP_CORE_AddI32] = "iii",
+  [IREE_VM_OP_CORE_SubI32] = "iii",
+  [IREE_VM_OP_CORE_MulI32] = "iii",
+  [IREE_VM_OP_CORE_DivI32S] = "iii",
+  [IREE_VM_OP_CORE_DivI32U] = "iii",
+  [IREE_VM_OP_CORE_RemI32S] = "iii",
+  [IREE_VM_OP_CORE_RemI32U] = "iii",
+  [IREE_VM_OP_CORE_FMAI32] = "iiii",
+  [IREE_VM_OP_CORE_AbsI32] = "ii",
+  [IREE_VM_OP_CORE_NotI32] = "ii",
+  [IREE_VM_OP_CORE_AndI32] = "iii",
+  [IREE_VM_OP_CORE_OrI32] = "iii",
+  [IREE_VM_OP_CORE_XorI32] = "iii",
+  [IREE_VM_OP_CORE_CtlzI32] = "ii",
+  [IREE_VM_OP_CORE_AddI64] = "lll",
+  [IREE_VM_OP_CORE_SubI64] = "lll",
+  [IREE_VM_OP_CORE_MulI64] = "lll",
+  [IREE_VM_OP_CORE_DivI64S] = "lll",
+  [IREE_VM_OP_CORE_DivI64U] = "lll",
+  [IREE_VM_OP_CORE_RemI64S] = "lll",
+  [IREE_VM_OP_CORE_RemI64U] = "lll",
+  [IREE_VM_OP_CORE_FMAI64] = "llll",
+  [IREE_VM_OP_CORE_AbsI64] = "ll",
+  [IREE_VM_OP_CORE_NotI64] = "ll",
+  [IREE_VM_OP_CORE_AndI64] = "lll",
+  [IREE_VM_OP_CORE_OrI64] = "lll",
+  [IREE_VM_OP_CORE_XorI64] = "lll",
+  [IREE_VM_OP_CORE_CtlzI64] = "ll",
+  [IREE_VM_OP_CORE_TruncI32I8] = "ii",
+  [IREE_VM_OP_CORE_TruncI32I16] = "ii",
+  [IREE_VM_OP_CORE_ExtI8I32S] = "ii",
+  [IREE_VM_OP_CORE_ExtI8I32U] = "ii",
+  [IREE_VM_OP_CORE_ExtI16I32S] = "ii",
+  [IREE_VM_OP_CORE_ExtI16I32U] = "ii",
+  [IREE_VM_OP_CORE_TruncI64I32] = "li",
+  [IREE_VM_OP_CORE_ExtI32I64S] = "il",
+  [IREE_VM_OP_CORE_ExtI32I64U] = "il",
+  [IREE_VM_OP_CORE_ShlI32] = "iii",
+  [IREE_VM_OP_CORE_ShrI32S] = "iii",
+  [IREE_VM_OP_CORE_ShrI32U] = "iii",
+  [IREE_VM_OP_CORE_ShlI64] = "lil",
+  [IREE_VM_OP_CORE_ShrI64S] = "lil",
+  [IREE_VM_OP_CORE_ShrI64U] = "lil",
+  [IREE_VM_OP_CORE_CmpEQI32] = "iii",
+  [IREE_VM_OP_CORE_CmpNEI32] = "iii",
+  [IREE_VM_OP_CORE_CmpLTI32S] = "iii",
+  [IREE_VM_OP_CORE_CmpLTI32U] = "iii",
+  [IREE_VM_OP_CORE_CmpNZI32] = "ii",
+  [IREE_VM_OP_CORE_CmpEQI64] = "lli",
+  [IREE_VM_OP_CORE_CmpNEI64] = "lli",
+  [IREE_VM_OP_CORE_CmpLTI64S] = "lli",
+  [IREE_VM_OP_CORE_CmpLTI64U] = "lli",
+  [IREE_VM_OP_CORE_CmpNZI64] = "li",
+  [IREE_VM_OP_CORE_CmpEQRef] = "rri",
+  [IREE_VM_OP_CORE_CmpNERef] = "rri",
+  [IREE_VM_OP_CORE_CmpNZRef] = "ri",
+  [IREE_VM_OP_CORE_Branch] = "bm",
+  [IREE_VM_OP_CORE_CondBranch] = "ibmbm",
+  [IREE_VM_OP_CORE_Call] = "cvv",
+  [IREE_VM_OP_CORE_CallVariadic] = "cnvv",
+  [IREE_VM_OP_CORE_Return] = "v",
+  [IREE_VM_OP_CORE_Fail] = "is",
+  [IREE_VM_OP_CORE_ImportResolved] = "ci",
+  [IREE_VM_OP_CORE_Yield] = "bm",
+  [IREE_VM_OP_CORE_Trace] = "sv",
+  [IREE_VM_OP_CORE_Print] = "sv",
+  [IREE_VM_OP_CORE_Break] = "bm",
+  [IREE_VM_OP_CORE_CondBreak] = "ibm",
+};
+
+#if IREE_VM_EXT_F32_ENABLE
+static const char* const iree_vm_bytecode_ext_f32_op_encodings[256] = {
+  [IREE_VM_OP_EXT_F32_GlobalLoadF32] = "gi",
+  [IREE_VM_OP_EXT_F32_GlobalStoreF32] = "gi",
+  [IREE_VM_OP_EXT_F32_GlobalLoadIndirectF32] = "ii",
+  [IREE_VM_OP_EXT_F32_GlobalStoreIndirectF32] = "ii",
+  [IREE_VM_OP_EXT_F32_ConstF32] = "ai",
+  [IREE_VM_OP_EXT_F32_ConstF32Zero] = "i",
+  [IREE_VM_OP_EXT_F32_ListGetF32] = "rii",
+  [IREE_VM_OP_EXT_F32_ListSetF32] = "rii",
+  [IREE_VM_OP_EXT_F32_SelectF32] = "iiii",
+  [IREE_VM_OP_EXT_F32_SwitchF32] = "iavi",
+  [IREE_VM_OP_EXT_F32_AddF32] = "iii",
+  [IREE_VM_OP_EXT_F32_SubF32] = "iii",
+  [IREE_VM_OP_EXT_F32_MulF32] = "iii",
+  [IREE_VM_OP_EXT_F32_DivF32] = "iii",
+  [IREE_VM_OP_EXT_F32_RemF32] = "iii",
+  [IREE_VM_OP_EXT_F32_FMAF32] = "iiii",
+  [IREE_VM_OP_EXT_F32_AbsF32] = "ii",
+  [IREE_VM_OP_EXT_F32_NegF32] = "ii",
+  [IREE_VM_OP_EXT_F32_CeilF32] = "ii",
+  [IREE_VM_OP_EXT_F32_FloorF32] = "ii",
+  [IREE_VM_OP_EXT_F32_RoundF32] = "ii",
+  [IREE_VM_OP_EXT_F32_AtanF32] = "ii",
+  [IREE_VM_OP_EXT_F32_Atan2F32] = "iii",
+  [IREE_VM_OP_EXT_F32_CosF32] = "ii",
+  [IREE_VM_OP_EXT_F32_SinF32] = "ii",
+  [IREE_VM_OP_EXT_F32_ExpF32] = "ii",
+  [IREE_VM_OP_EXT_F32_Exp2F32] = "ii",
+  [IREE_VM_OP_EXT_F32_ExpM1F32] = "ii",
+  [IREE_VM_OP_EXT_F32_LogF32] = "ii",
+  [IREE_VM_OP_EXT_F32_Log10F32] = "ii",
+  [IREE_VM_OP_EXT_F32_Log1pF32] = "ii",
+  [IREE_VM_OP_EXT_F32_Log2F32] = "ii",
+  [IREE_VM_OP_EXT_F32_PowF32] = "iii",
+  [IREE_VM_OP_EXT_F32_RsqrtF32] = "ii",
+  [IREE_VM_OP_EXT_F32_SqrtF32] = "ii",
+  [IREE_VM_OP_EXT_F32_TanhF32] = "ii",
+  [IREE_VM_OP_EXT_F32_ErfF32] = "ii",
+  [IREE_VM_OP_EXT_F32_CastSI32F32] = "ii",
+  [IREE_VM_OP_EXT_F32_CastUI32F32] = "ii",
+  [IREE_VM_OP_EXT_F32_CastF32SI32] = "ii",
+  [IREE_VM_OP_EXT_F32_CastF32UI32] = "ii",
+  [IREE_VM_OP_EXT_F32_BitcastI32F32] = "ii",
+  [IREE_VM_OP_EXT_F32_BitcastF32I32] = "ii",
+  [IREE_VM_OP_EXT_F32_CmpEQF32O] = "iii",
+  [IREE_VM_OP_EXT_F32_CmpEQF32U] = "iii",
+  [IREE_VM_OP_EXT_F32_CmpNEF32O] = "iii",
+  [IREE_VM_OP_EXT_F32_CmpNEF32U] = "iii",
+  [IREE_VM_OP_EXT_F32_CmpLTF32O] = "iii",
+  [IREE_VM_OP_EXT_F32_CmpLTF32U] = "iii",
+  [IREE_VM_OP_EXT_F32_CmpLTEF32O] = "iii",
+  [IREE_VM_OP_EXT_F32_CmpLTEF32U] = "iii",
+  [IREE_VM_OP_EXT_F32_CmpNaNF32] = "ii",
+  [IREE_VM_OP_EXT_F32_BufferFillF32] = "rlli",
+  [IREE_VM_OP_EXT_F32_BufferLoadF32] = "rli",
+  [IREE_VM_OP_EXT_F32_BufferStoreF32] = "rli",
+};
+#endif  // IREE_VM_EXT_F32_ENABLE
+
+// Returns true if |opcode| never falls through to the next instruction.
+// vm.fail only traps when its status is non-zero but is always a block
+// terminator in the compiler.
+static bool iree_vm_bytecode_core_op_is_terminator(uint8_t opcode) {
+  switch (opcode) {
+    case IREE_VM_OP_CORE_Branch:
+    case IREE_VM_OP_CORE_CondBranch:
+    case IREE_VM_OP_CORE_Return:
+    case IREE_VM_OP_CORE_Fail:
+    case IREE_VM_OP_CORE_Yield:
+    case IREE_VM_OP_CORE_Break:
+    case IREE_VM_OP_CORE_CondBreak:
+      return true;
+    default:
+      return false;
+  }
+}
+
+//===----------------------------------------------------------------------===//
+// Function verification
+//===----------------------------------------------------------------------===//
+
+// Functions at or below this size verify without any heap allocations.
+#define IREE_VM_BYTECODE_VERIFIER_INLINE_LENGTH (4 * 1024)
+
+typedef struct iree_vm_bytecode_verifier_t {
+  const iree_vm_bytecode_verifier_limits_t* limits;
+  const uint8_t* data;
+  iree_host_size_t length;
+  uint16_t i32_register_count;
+  uint16_t ref_register_count;
+  // Bitmap with one bit per byte set at the start of each instruction.
+  uint64_t* instruction_starts;
+  // Bitmap with one bit per byte set at each branch target.
+  uint64_t* branch_targets;
+} iree_vm_bytecode_verifier_t;
+
+static inline void iree_vm_bytecode_bitmap_set(uint64_t* bitmap,
+                                               iree_host_size_t bit) {
+  bitmap[bit / 64] |= 1ull << (bit % 64);
+}
+
+static iree_status_t iree_vm_bytecode_verify_require(
+    const iree_vm_bytecode_verifier_t* verifier, iree_host_size_t pc,
+    iree_host_size_t length, iree_host_size_t instruction_pc) {
+  if (IREE_UNLIKELY(pc > verifier->length ||
+                    verifier->length - pc < length)) {
+    return iree_make_status(IREE_STATUS_INVALID_ARGUMENT,
+                            "instruction at pc %" PRIhsz
+                            " overruns the function body (%" PRIhsz " bytes)",
+                            instruction_pc, verifier->length);
+  }
+  return iree_ok_status();
+}
+
+static inline uint16_t iree_vm_bytecode_verify_load_u16(
+    const iree_vm_bytecode_verifier_t* verifier, iree_host_size_t pc) {
+  return iree_unaligned_load_le_u16((const uint16_t*)&verifier->data[pc]);
+}
+
+static inline uint32_t iree_vm_bytecode_verify_load_u32(
+    const iree_vm_bytecode_verifier_t* verifier, iree_host_size_t pc) {
+  return iree_unaligned_load_le_u32((const uint32_t*)&verifier->data[pc]);
+}
+
+// Verifies a register that may be of either bank as found in register lists.
+static iree_status_t iree_vm_bytecode_verify_any_register(
+    const iree_vm_bytecode_verifier_t* verifier, uint16_t reg,
+    iree_host_size_t instruction_pc) {
+  if (reg & IREE_REF_REGISTER_TYPE_BIT) {
+    if (IREE_UNLIKELY((reg & IREE_REF_REGISTER_MASK) >=
+                      verifier->ref_register_count)) {
+      return iree_make_status(
+          IREE_STATUS_INVALID_ARGUMENT,
+          "instruction at pc %" PRIhsz
+          " references ref register %u out of range (%u)",
+          instruction_pc, reg & IREE_REF_REGISTER_MASK,
+          verifier->ref_register_count);
+    }
+  } else if (IREE_UNLIKELY(reg >= verifier->i32_register_count)) {
+    return iree_make_status(IREE_STATUS_INVALID_ARGUMENT,
+                            "instruction at pc %" PRIhsz
+                            " references i32 register %u out of range (%u)",
+                            instruction_pc, reg, verifier->i32_register_count);
+  }
+  return iree_ok_status();
+}
+
+// Verifies a 2-byte aligned list of |stride| registers per entry at |*pc|.
+// If |check_registers| is false the entries are treated as opaque values.
+static iree_status_t iree_vm_bytecode_verify_list(
+    const iree_vm_bytecode_verifier_t* verifier, iree_host_size_t* pc,
+    iree_host_size_t stride, bool check_registers,
+    iree_host_size_t instruction_pc) {
+  *pc = iree_host_align(*pc, sizeof(uint16_t));
+  IREE_RETURN_IF_ERROR(iree_vm_bytecode_verify_require(
+      verifier, *pc, sizeof(uint16_t), instruction_pc));
+  iree_host_size_t count = iree_vm_bytecode_verify_load_u16(verifier, *pc);
+  *pc += sizeof(uint16_t);
+  iree_host_size_t entry_count = count * stride;
+  IREE_RETURN_IF_ERROR(iree_vm_bytecode_verify_require(
+      verifier, *pc, entry_count * sizeof(uint16_t), instruction_pc));
+  if (check_registers) {
+    for (iree_host_size_t i = 0; i < entry_count; ++i) {
+      IREE_RETURN_IF_ERROR(iree_vm_bytecode_verify_any_register(
+          verifier,
+          iree_vm_bytecode_verify_load_u16(verifier,
+                                           *pc + i * sizeof(uint16_t)),
+          instruction_pc));
+    }
+  }
+  *pc += entry_count * sizeof(uint16_t);
+  return iree_ok_status();
+}
+
+// Verifies a 32-bit ordinal at |*pc| is less than |limit|.
+static iree_status_t iree_vm_bytecode_verify_ordinal(
+    const iree_vm_bytecode_verifier_t* verifier, iree_host_size_t* pc,
+    iree_host_size_t limit, const char* table_name,
+    iree_host_size_t instruction_pc) {
+  IREE_RETURN_IF_ERROR(
+      iree_vm_bytecode_verify_require(verifier, *pc, 4, instruction_pc));
+  uint32_t ordinal = iree_vm_bytecode_verify_load_u32(verifier, *pc);
+  *pc += 4;
+  if (IREE_UNLIKELY(ordinal >= limit)) {
+    return iree_make_status(IREE_STATUS_INVALID_ARGUMENT,
+                            "instruction at pc %" PRIhsz
+                            " references %s %u out of range (%" PRIhsz ")",
+                            instruction_pc, table_name, ordinal, limit);
+  }
+  return iree_ok_status();
+}
+
+// Verifies a 32-bit rwdata byte offset at |*pc| for a global of |width| bytes.
+static iree_status_t iree_vm_bytecode_verify_global_offset(
+    const iree_vm_bytecode_verifier_t* verifier, iree_host_size_t* pc,
+    iree_host_size_t width, iree_host_size_t instruction_pc) {
+  IREE_RETURN_IF_ERROR(
+      iree_vm_bytecode_verify_require(verifier, *pc, 4, instruction_pc));
+  uint32_t byte_offset = iree_vm_bytecode_verify_load_u32(verifier, *pc);
+  *pc += 4;
+  const iree_host_size_t rwdata_size = verifier->limits->rwdata_size;
+  if (IREE_UNLIKELY(byte_offset > rwdata_size ||
+                    rwdata_size - byte_offset < width)) {
+    return iree_make_status(
+        IREE_STATUS_INVALID_ARGUMENT,
+        "instruction at pc %" PRIhsz " references global byte offset %u out "
+        "of range (rwdata=%" PRIhsz ")",
+        instruction_pc, byte_offset, rwdata_size);
+  }
+  return iree_ok_status();
+}
+
+// Verifies the operands of the instruction starting at |instruction_pc| with
+// the given |encoding| and advances |*pc| past them.
+static iree_status_t iree_vm_bytecode_verify_operands(
+    iree_vm_bytecode_verifier_t* verifier, const char* encoding,
+    iree_host_size_t* pc, iree_host_size_t instruction_pc) {
+  const iree_vm_bytecode_verifier_limits_t* limits = verifier->limits;
+  for (const char* c = encoding; *c; ++c) {
+    switch (*c) {
+      case 'i':
+      case 'l':
+      case 'r': {
+        IREE_RETURN_IF_ERROR(iree_vm_bytecode_verify_require(
+            verifier, *pc, sizeof(uint16_t), instruction_pc));
+        uint16_t reg = iree_vm_bytecode_verify_load_u16(verifier, *pc);
+        *pc += sizeof(uint16_t);
+        bool is_ref = (reg & IREE_REF_REGISTER_TYPE_BIT) != 0;
+        if (IREE_UNLIKELY(is_ref != (*c == 'r'))) {
+          return iree_make_status(IREE_STATUS_INVALID_ARGUMENT,
+                                  "instruction at pc %" PRIhsz
+                                  " has a register of the wrong bank",
+                                  instruction_pc);
+        }
+        const bool is_unaligned_i64 =
+            *c == 'l' &&
+            ((reg & 1) || reg + 1 >= verifier->i32_register_count);
+        if (IREE_UNLIKELY(is_unaligned_i64)) {
+          return iree_make_status(
+              IREE_STATUS_INVALID_ARGUMENT,
+              "instruction at pc %" PRIhsz
+              " references 64-bit register %u unaligned or out of range (%u)",
+              instruction_pc, reg, verifier->i32_register_count);
+        }
+        IREE_RETURN_IF_ERROR(iree_vm_bytecode_verify_any_register(
+            verifier, reg, instruction_pc));
+        break;
+      }
+      case 'g':
+        IREE_RETURN_IF_ERROR(iree_vm_bytecode_verify_global_offset(
+            verifier, pc, 4, instruction_pc));
+        break;
+      case 'G':
+        IREE_RETURN_IF_ERROR(iree_vm_bytecode_verify_global_offset(
+            verifier, pc, 8, instruction_pc));
+        break;
+      case 'q':
+        IREE_RETURN_IF_ERROR(iree_vm_bytecode_verify_ordinal(
+            verifier, pc, limits->global_ref_count, "ref global",
+            instruction_pc));
+        break;
+      case 'o':
+        IREE_RETURN_IF_ERROR(iree_vm_bytecode_verify_ordinal(
+            verifier, pc, limits->rodata_count, "rodata segment",
+            instruction_pc));
+        break;
+      case 't':
+        IREE_RETURN_IF_ERROR(iree_vm_bytecode_verify_ordinal(
+            verifier, pc, limits->type_count, "type", instruction_pc));
+        break;
+      case 'c': {
+        IREE_RETURN_IF_ERROR(
+            iree_vm_bytecode_verify_require(verifier, *pc, 4, instruction_pc));
+        uint32_t function_ordinal =
+            iree_vm_bytecode_verify_load_u32(verifier, *pc);
+        *pc += 4;
+        bool is_import = (function_ordinal & 0x80000000u) != 0;
+        uint32_t ordinal = function_ordinal & 0x7FFFFFFFu;
+        iree_host_size_t limit = is_import ? limits->import_function_count
+                                           : limits->internal_function_count;
+        if (IREE_UNLIKELY(ordinal >= limit)) {
+          return iree_make_status(
+              IREE_STATUS_INVALID_ARGUMENT,
+              "instruction at pc %" PRIhsz
+              " references %s function %u out of range (%" PRIhsz ")",
+              instruction_pc, is_import ? "import" : "internal", ordinal,
+              limit);
+        }
+        break;
+      }
+      case 'a':
+        IREE_RETURN_IF_ERROR(
+            iree_vm_bytecode_verify_require(verifier, *pc, 4, instruction_pc));
+        *pc += 4;
+        break;
+      case 'A':
+        IREE_RETURN_IF_ERROR(
+            iree_vm_bytecode_verify_require(verifier, *pc, 8, instruction_pc));
+        *pc += 8;
+        break;
+      case 's': {
+        IREE_RETURN_IF_ERROR(iree_vm_bytecode_verify_require(
+            verifier, *pc, sizeof(uint16_t), instruction_pc));
+        iree_host_size_t length =
+            iree_vm_bytecode_verify_load_u16(verifier, *pc);
+        *pc += sizeof(uint16_t);
+        IREE_RETURN_IF_ERROR(iree_vm_bytecode_verify_require(
+            verifier, *pc, length, instruction_pc));
+        *pc += length;
+        break;
+      }
+      case 'v':
+        IREE_RETURN_IF_ERROR(iree_vm_bytecode_verify_list(
+            verifier, pc, /*stride=*/1, /*check_registers=*/true,
+            instruction_pc));
+        break;
+      case 'n':
+        IREE_RETURN_IF_ERROR(iree_vm_bytecode_verify_list(
+            verifier, pc, /*stride=*/1, /*check_registers=*/false,
+            instruction_pc));
+        break;
+      case 'b': {
+        IREE_RETURN_IF_ERROR(
+            iree_vm_bytecode_verify_require(verifier, *pc, 4, instruction_pc));
+        uint32_t target_pc = iree_vm_bytecode_verify_load_u32(verifier, *pc);
+        *pc += 4;
+        if (IREE_UNLIKELY(target_pc >= verifier->length)) {
+          return iree_make_status(IREE_STATUS_INVALID_ARGUMENT,
+                                  "instruction at pc %" PRIhsz
+                                  " branches to pc %u outside of the function",
+                                  instruction_pc, target_pc);
+        }
+        iree_vm_bytecode_bitmap_set(verifier->branch_targets, target_pc);
+        break;
+      }
+      case 'm':
+        IREE_RETURN_IF_ERROR(iree_vm_bytecode_verify_list(
+            verifier, pc, /*stride=*/2, /*check_registers=*/true,
+            instruction_pc));
+        break;
+      default:
+        IREE_ASSERT_UNREACHABLE("unhandled operand encoding");
+        break;
+    }
+  }
+  return iree_ok_status();
+}
+
+// Returns true if all bytes in [pc, length) are zero.
+static bool iree_vm_bytecode_is_zero_padding(
+    const iree_vm_bytecode_verifier_t* verifier, iree_host_size_t pc) {
+  for (; pc < verifier->length; ++pc) {
+    if (verifier->data[pc] != 0) return false;
+  }
+  return true;
+}
+
+static iree_status_t iree_vm_bytecode_verify_instructions(
+    iree_vm_bytecode_verifier_t* verifier) {
+  iree_host_size_t pc = 0;
+  bool ended_with_terminator = false;
+  while (pc < verifier->length) {
+    // Function bodies are padded to 8 bytes with zeros that are included in
+    // the body length. Zero would otherwise decode as a GlobalLoadI32 that
+    // needs 7 bytes and as such valid padding can never be an instruction.
+    if (ended_with_terminator && verifier->length - pc < 8 &&
+        iree_vm_bytecode_is_zero_padding(verifier, pc)) {
+      break;
+    }
+
+    const iree_host_size_t instruction_pc = pc;
+    iree_vm_bytecode_bitmap_set(verifier->instruction_starts, instruction_pc);
+    const uint8_t opcode = verifier->data[pc++];
+    const char* encoding = iree_vm_bytecode_core_op_encodings[opcode];
+    if (opcode == IREE_VM_OP_CORE_PrefixExtF32) {
+#if IREE_VM_EXT_F32_ENABLE
+      IREE_RETURN_IF_ERROR(
+          iree_vm_bytecode_verify_require(verifier, pc, 1, instruction_pc));
+      encoding = iree_vm_bytecode_ext_f32_op_encodings[verifier->data[pc++]];
+#else
+      return iree_make_status(IREE_STATUS_UNIMPLEMENTED,
+                              "instruction at pc %" PRIhsz
+                              " requires the f32 extension which is not "
+                              "enabled in this build",
+                              instruction_pc);
+#endif  // IREE_VM_EXT_F32_ENABLE
+    } else if (opcode == IREE_VM_OP_CORE_PrefixExtF64) {
+      return iree_make_status(
+          IREE_STATUS_UNIMPLEMENTED,
+          "instruction at pc %" PRIhsz
+          " requires the f64 extension which is not supported by the runtime",
+          instruction_pc);
+    }
+    if (IREE_UNLIKELY(!encoding)) {
+      return iree_make_status(IREE_STATUS_INVALID_ARGUMENT,
+                              "invalid opcode 0x%02X at pc %" PRIhsz,
+                              verifier->data[pc - 1], instruction_pc);
+    }
+    IREE_RETURN_IF_ERROR(iree_vm_bytecode_verify_operands(verifier, encoding,
+                                                          &pc, instruction_pc));
+    ended_with_terminator = opcode != IREE_VM_OP_CORE_PrefixExtF32 &&
+                            iree_vm_bytecode_core_op_is_terminator(opcode);
+  }
+  if (!ended_with_terminator) {
+    return iree_make_status(IREE_STATUS_INVALID_ARGUMENT,
+                            "function does not end with a terminator");
+  }
+
+  // All branch targets must land on the start of an instruction.
+  const iree_host_size_t word_count = (verifier->length + 63) / 64;
+  for (iree_host_size_t i = 0; i < word_count; ++i) {
+    uint64_t misaligned_targets =
+        verifier->branch_targets[i] & ~verifier->instruction_starts[i];
+    if (IREE_UNLIKELY(misaligned_targets)) {
+      return iree_make_status(
+          IREE_STATUS_INVALID_ARGUMENT,
+          "branch target pc %" PRIhsz " is not the start of an instruction",
+          i * 64 + iree_math_count_trailing_zeros_u64(misaligned_targets));
+    }
+  }
+
+  return iree_ok_status();
+}
+
+iree_status_t iree_vm_bytecode_verify_function(
+    const iree_vm_bytecode_verifier_limits_t* limits,
+    iree_const_byte_span_t bytecode_data, uint16_t i32_register_count,
+    uint16_t ref_register_count, iree_allocator_t host_allocator) {
+  IREE_ASSERT_ARGUMENT(limits);
+  IREE_TRACE_ZONE_BEGIN(z0);
+  IREE_TRACE_ZONE_APPEND_VALUE(z0, (int64_t)bytecode_data.data_length);
+
+  // Bitmaps tracking instruction starts and branch targets, both stored in a
+  // single allocation (or on the stack for smaller functions).
+  const iree_host_size_t word_count = (bytecode_data.data_length + 63) / 64;
+  uint64_t inline_bitmaps[2 * (IREE_VM_BYTECODE_VERIFIER_INLINE_LENGTH / 64)];
+  uint64_t* bitmaps = inline_bitmaps;
+  if (bytecode_data.data_length > IREE_VM_BYTECODE_VERIFIER_INLINE_LENGTH) {
+    IREE_RETURN_AND_END_ZONE_IF_ERROR(
+        z0, iree_allocator_malloc(host_allocator,
+                                  2 * word_count * sizeof(uint64_t),
+                                  (void**)&bitmaps));
+  }
+  memset(bitmaps, 0, 2 * word_count * sizeof(uint64_t));
+
+  iree_vm_bytecode_verifier_t verifier = {
+      .limits = limits,
+      .data = bytecode_data.data,
+      .length = bytecode_data.data_length,
+      .i32_register_count = i32_register_count,
+      .ref_register_count = ref_register_count,
+      .instruction_starts = bitmaps,
+      .branch_targets = bitmaps + word_count,
+  };
+  iree_status_t status = iree_vm_bytecode_verify_instructions(&verifier);
+
+  if (bitmaps != inline_bitmaps) {
+    iree_allocator_free(host_allocator, bitmaps);
+  }
+  IREE_TRACE_ZONE_END(z0);
+  return status;
+}
+
+//===----------------------------------------------------------------------===//
+// Verification cache
+//===----------------------------------------------------------------------===//
+
+#if IREE_VM_BYTECODE_VERIFICATION_CACHE_ENABLE
+
+// Total number of verified module keys retained. Modules are replaced in FIFO
+// order as the cache is expected to hold only the handful of modules a process
+// repeatedly loads.
+#define IREE_VM_BYTECODE_VERIFICATION_CACHE_CAPACITY 32
+
+static struct {
+  iree_slim_mutex_t mutex;
+  iree_host_size_t count;
+  iree_host_size_t next_index;
+  uint64_t keys[IREE_VM_BYTECODE_VERIFICATION_CACHE_CAPACITY];
+} iree_vm_bytecode_verification_cache_;
+static iree_once_flag iree_vm_bytecode_verification_cache_flag_ =
+    IREE_ONCE_FLAG_INIT;
+static void iree_vm_bytecode_verification_cache_initialize(void) {
+  memset(&iree_vm_bytecode_verification_cache_, 0,
+         sizeof(iree_vm_bytecode_verification_cache_));
+  iree_slim_mutex_initialize(&iree_vm_bytecode_verification_cache_.mutex);
+}
+
+// 64-bit FNV-1a.
+static uint64_t iree_vm_bytecode_hash_bytes(uint64_t hash, const void* data,
+                                            iree_host_size_t data_length) {
+  const uint8_t* bytes = (const uint8_t*)data;
+  for (iree_host_size_t i = 0; i < data_length; ++i) {
+    hash ^= bytes[i];
+    hash *= 0x100000001B3ull;
+  }
+  return hash;
+}
+
+uint64_t iree_vm_bytecode_verification_cache_key(
+    const iree_vm_bytecode_verifier_limits_t* limits,
+    iree_const_byte_span_t function_descriptor_data,
+    iree_const_byte_span_t bytecode_data) {
+  IREE_TRACE_ZONE_BEGIN(z0);
+  uint64_t hash = 0xCBF29CE484222325ull;
+  // The descriptor table size is implied by the function count in |limits| so
+  // the concatenation of the inputs is unambiguous.
+  hash = iree_vm_bytecode_hash_bytes(hash, limits, sizeof(*limits));
+  hash = iree_vm_bytecode_hash_bytes(hash, function_descriptor_data.data,
+                                     function_descriptor_data.data_length);
+  hash = iree_vm_bytecode_hash_bytes(hash, bytecode_data.data,
+                                     bytecode_data.data_length);
+  IREE_TRACE_ZONE_END(z0);
+  return hash;
+}
+
+bool iree_vm_bytecode_verification_cache_lookup(uint64_t key) {
+  iree_call_once(&iree_vm_bytecode_verification_cache_flag_,
+                 iree_vm_bytecode_verification_cache_initialize);
+  bool found = false;
+  iree_slim_mutex_lock(&iree_vm_bytecode_verification_cache_.mutex);
+  for (iree_host_size_t i = 0; i < iree_vm_bytecode_verification_cache_.count;
+       ++i) {
+    if (iree_vm_bytecode_verification_cache_.keys[i] == key) {
+      found = true;
+      break;
+    }
+  }
+  iree_slim_mutex_unlock(&iree_vm_bytecode_verification_cache_.mutex);
+  return found;
+}
+
+void iree_vm_bytecode_verification_cache_insert(uint64_t key) {
+  iree_call_once(&iree_vm_bytecode_verification_cache_flag_,
+                 iree_vm_bytecode_verification_cache_initialize);
+  iree_slim_mutex_lock(&iree_vm_bytecode_verification_cache_.mutex);
+  iree_vm_bytecode_verification_cache_
+      .keys[iree_vm_bytecode_verification_cache_.next_index] = key;
+  iree_vm_bytecode_verification_cache_.next_index =
+      (iree_vm_bytecode_verification_cache_.next_index + 1) %
+      IREE_VM_BYTECODE_VERIFICATION_CACHE_CAPACITY;
+  if (iree_vm_bytecode_verification_cache_.count <
+      IREE_VM_BYTECODE_VERIFICATION_CACHE_CAPACITY) {
+    ++iree_vm_bytecode_verification_cache_.count;
+  }
+  iree_slim_mutex_unlock(&iree_vm_bytecode_verification_cache_.mutex);
+}
+
+#endif  // IREE_VM_BYTECODE_VERIFICATION_CACHE_ENABLE
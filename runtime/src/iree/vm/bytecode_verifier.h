@@ -0,0 +1,86 @@
+// Copyright 2023 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#ifndef IREE_VM_BYTECODE_VERIFIER_H_
+#define IREE_VM_BYTECODE_VERIFIER_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "iree/base/api.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif  // __cplusplus
+
+// Maximum register count per bank.
+// This determines the bits required to reference registers in the VM bytecode.
+#define IREE_I32_REGISTER_COUNT 0x7FFF
+#define IREE_REF_REGISTER_COUNT 0x7FFF
+
+#define IREE_I32_REGISTER_MASK 0x7FFF
+
+#define IREE_REF_REGISTER_TYPE_BIT 0x8000
+#define IREE_REF_REGISTER_MOVE_BIT 0x4000
+#define IREE_REF_REGISTER_MASK 0x3FFF
+
+// Module-wide tables that bytecode instructions may reference by ordinal.
+typedef struct iree_vm_bytecode_verifier_limits_t {
+  // Total number of internal functions with bytecode bodies.
+  iree_host_size_t internal_function_count;
+  // Total number of imported functions. Import ordinals have their MSB set.
+  iree_host_size_t import_function_count;
+  // Total number of entries in the module type table.
+  iree_host_size_t type_count;
+  // Size in bytes of the primitive global storage.
+  iree_host_size_t rwdata_size;
+  // Total number of ref globals.
+  iree_host_size_t global_ref_count;
+  // Total number of rodata segments.
+  iree_host_size_t rodata_count;
+} iree_vm_bytecode_verifier_limits_t;
+
+// Verifies the bytecode body of a single function in |bytecode_data|.
+//
+// On success the function is guaranteed to:
+//  - only contain opcodes supported by this runtime build;
+//  - have all operands fully contained within |bytecode_data|;
+//  - only reference registers within |i32_register_count| and
+//    |ref_register_count| with the proper register bank bits for the operand
+//    type and 64-bit registers aligned to even ordinals;
+//  - only reference types, functions, globals, and rodata within |limits|;
+//  - only branch to the start of instructions within the function;
+//  - end with a terminator instruction (optionally followed by padding).
+//
+// |host_allocator| is used for scratch memory when verifying large functions.
+iree_status_t iree_vm_bytecode_verify_function(
+    const iree_vm_bytecode_verifier_limits_t* limits,
+    iree_const_byte_span_t bytecode_data, uint16_t i32_register_count,
+    uint16_t ref_register_count, iree_allocator_t host_allocator);
+
+#if IREE_VM_BYTECODE_VERIFICATION_CACHE_ENABLE
+
+// Returns a key identifying the verification inputs of a module: its |limits|,
+// the raw bytes of its function descriptor table, and its bytecode data.
+uint64_t iree_vm_bytecode_verification_cache_key(
+    const iree_vm_bytecode_verifier_limits_t* limits,
+    iree_const_byte_span_t function_descriptor_data,
+    iree_const_byte_span_t bytecode_data);
+
+// Returns true if a module with the given |key| previously passed verification
+// in this process.
+bool iree_vm_bytecode_verification_cache_lookup(uint64_t key);
+
+// Records |key| as belonging to a module that passed verification.
+void iree_vm_bytecode_verification_cache_insert(uint64_t key);
+
+#endif  // IREE_VM_BYTECODE_VERIFICATION_CACHE_ENABLE
+
+#ifdef __cplusplus
+}  // extern "C"
+#endif  // __cplusplus
+
+#endif  // IREE_VM_BYTECODE_VERIFIER_H_
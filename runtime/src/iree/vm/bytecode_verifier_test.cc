@@ -0,0 +1,230 @@
+// Copyright 2023 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include "iree/vm/bytecode_verifier.h"
+
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+#include "iree/base/api.h"
+#include "iree/testing/gtest.h"
+#include "iree/vm/generated/bytecode_op_table.h"
+
+namespace {
+
+// Little-endian bytecode builder matching the compiler encoding.
+class BytecodeBuilder {
+ public:
+  size_t pc() const { return data_.size(); }
+  BytecodeBuilder& Op(uint8_t opcode) {
+    data_.push_back(opcode);
+    return *this;
+  }
+  BytecodeBuilder& U16(uint16_t value) {
+    data_.push_back(value & 0xFF);
+    data_.push_back(value >> 8);
+    return *this;
+  }
+  BytecodeBuilder& U32(uint32_t value) {
+    U16(value & 0xFFFF);
+    return U16(value >> 16);
+  }
+  BytecodeBuilder& U64(uint64_t value) {
+    U32(value & 0xFFFFFFFFu);
+    return U32(value >> 32);
+  }
+  BytecodeBuilder& Align2() {
+    if (data_.size() % 2) data_.push_back(0);
+    return *this;
+  }
+  BytecodeBuilder& List(std::vector<uint16_t> regs) {
+    Align2().U16(static_cast<uint16_t>(regs.size()));
+    for (uint16_t reg : regs) U16(reg);
+    return *this;
+  }
+  BytecodeBuilder& Remap(std::vector<std::pair<uint16_t, uint16_t>> pairs) {
+    Align2().U16(static_cast<uint16_t>(pairs.size()));
+    for (auto& pair : pairs) U16(pair.first).U16(pair.second);
+    return *this;
+  }
+  BytecodeBuilder& PadTo8() {
+    while (data_.size() % 8) data_.push_back(0);
+    return *this;
+  }
+  BytecodeBuilder& Patch32(size_t offset, uint32_t value) {
+    for (size_t i = 0; i < 4; ++i) {
+      data_[offset + i] = (value >> (i * 8)) & 0xFF;
+    }
+    return *this;
+  }
+  BytecodeBuilder& Truncate(size_t length) {
+    data_.resize(length);
+    return *this;
+  }
+  iree_const_byte_span_t span() const {
+    return iree_make_const_byte_span(data_.data(), data_.size());
+  }
+
+ private:
+  std::vector<uint8_t> data_;
+};
+
+constexpr uint16_t kRef = 0x8000;
+
+class VMBytecodeVerifierTest : public ::testing::Test {
+ protected:
+  VMBytecodeVerifierTest() {
+    limits_.internal_function_count = 2;
+    limits_.import_function_count = 1;
+    limits_.type_count = 3;
+    limits_.rwdata_size = 16;
+    limits_.global_ref_count = 1;
+    limits_.rodata_count = 1;
+  }
+
+  // Verifies |builder| and returns the resulting status code.
+  iree_status_code_t Verify(const BytecodeBuilder& builder,
+                            uint16_t i32_register_count = 4,
+                            uint16_t ref_register_count = 2) {
+    iree_status_t status = iree_vm_bytecode_verify_function(
+        &limits_, builder.span(), i32_register_count, ref_register_count,
+        iree_allocator_system());
+    iree_status_code_t status_code = iree_status_code(status);
+    iree_status_ignore(status);
+    return status_code;
+  }
+
+  iree_vm_bytecode_verifier_limits_t limits_ = {};
+};
+
+TEST_F(VMBytecodeVerifierTest, Valid) {
+  BytecodeBuilder b;
+  b.Op(IREE_VM_OP_CORE_ConstI32).U32(42).U16(0);
+  b.Op(IREE_VM_OP_CORE_ConstI64).U64(7).U16(2);
+  b.Op(IREE_VM_OP_CORE_ListAlloc).U32(1).U16(0).U16(kRef | 1);
+  b.Op(IREE_VM_OP_CORE_GlobalLoadI64).U32(8).U16(2);
+  b.Op(IREE_VM_OP_CORE_Call).U32(0x80000000u).List({0}).List({kRef | 0});
+  b.Op(IREE_VM_OP_CORE_Return).List({0, kRef | 1});
+  b.PadTo8();
+  EXPECT_EQ(IREE_STATUS_OK, Verify(b));
+}
+
+// Functions larger than the inline scratch storage use heap allocations.
+TEST_F(VMBytecodeVerifierTest, LargeFunction) {
+  BytecodeBuilder b;
+  while (b.pc() < 64 * 1024) {
+    b.Op(IREE_VM_OP_CORE_ConstI32).U32(static_cast<uint32_t>(b.pc())).U16(1);
+  }
+  b.Op(IREE_VM_OP_CORE_Branch).U32(0).Remap({});
+  EXPECT_EQ(IREE_STATUS_OK, Verify(b));
+}
+
+TEST_F(VMBytecodeVerifierTest, Branches) {
+  BytecodeBuilder b;
+  b.Op(IREE_VM_OP_CORE_ConstI32).U32(1).U16(0);
+  size_t loop_pc = b.pc();
+  b.Op(IREE_VM_OP_CORE_AddI32).U16(0).U16(0).U16(0);
+  b.Op(IREE_VM_OP_CORE_CondBranch).U16(0);
+  b.U32(static_cast<uint32_t>(loop_pc)).Remap({});
+  size_t exit_pc_offset = b.pc();
+  b.U32(0).Remap({{0, 1}});
+  size_t exit_pc = b.pc();
+  b.Op(IREE_VM_OP_CORE_Return).List({1});
+  b.Patch32(exit_pc_offset, static_cast<uint32_t>(exit_pc));
+  EXPECT_EQ(IREE_STATUS_OK, Verify(b));
+
+  // Branching into the middle of an instruction fails.
+  BytecodeBuilder misaligned;
+  misaligned.Op(IREE_VM_OP_CORE_ConstI32).U32(0).U16(0);
+  misaligned.Op(IREE_VM_OP_CORE_Branch).U32(1).Remap({});
+  EXPECT_EQ(IREE_STATUS_INVALID_ARGUMENT, Verify(misaligned));
+
+  // Branching outside of the function fails.
+  BytecodeBuilder out_of_range;
+  out_of_range.Op(IREE_VM_OP_CORE_Branch).U32(1000).Remap({});
+  EXPECT_EQ(IREE_STATUS_INVALID_ARGUMENT, Verify(out_of_range));
+}
+
+TEST_F(VMBytecodeVerifierTest, MalformedInstructions) {
+  // Truncated operand.
+  BytecodeBuilder truncated;
+  truncated.Op(IREE_VM_OP_CORE_ConstI32).U32(42).U16(0);
+  truncated.Truncate(truncated.pc() - 1);
+  EXPECT_EQ(IREE_STATUS_INVALID_ARGUMENT, Verify(truncated));
+
+  // Register list running off the end of the function.
+  BytecodeBuilder truncated_list;
+  truncated_list.Op(IREE_VM_OP_CORE_Return).Align2().U16(4).U16(0);
+  EXPECT_EQ(IREE_STATUS_INVALID_ARGUMENT, Verify(truncated_list));
+
+  // Reserved opcode.
+  BytecodeBuilder reserved;
+  reserved.Op(IREE_VM_OP_CORE_RSV_0x7F).Op(IREE_VM_OP_CORE_Return).List({});
+  EXPECT_EQ(IREE_STATUS_INVALID_ARGUMENT, Verify(reserved));
+
+  // Falling off the end of the function.
+  BytecodeBuilder no_terminator;
+  no_terminator.Op(IREE_VM_OP_CORE_ConstI32).U32(42).U16(0);
+  EXPECT_EQ(IREE_STATUS_INVALID_ARGUMENT, Verify(no_terminator));
+  EXPECT_EQ(IREE_STATUS_INVALID_ARGUMENT, Verify(BytecodeBuilder()));
+}
+
+TEST_F(VMBytecodeVerifierTest, Registers) {
+  // i32 register out of range.
+  BytecodeBuilder i32_range;
+  i32_range.Op(IREE_VM_OP_CORE_ConstI32).U32(0).U16(4);
+  i32_range.Op(IREE_VM_OP_CORE_Return).List({});
+  EXPECT_EQ(IREE_STATUS_INVALID_ARGUMENT, Verify(i32_range));
+
+  // Ref register used as an i32 operand.
+  BytecodeBuilder wrong_bank;
+  wrong_bank.Op(IREE_VM_OP_CORE_ConstI32).U32(0).U16(kRef | 0);
+  wrong_bank.Op(IREE_VM_OP_CORE_Return).List({});
+  EXPECT_EQ(IREE_STATUS_INVALID_ARGUMENT, Verify(wrong_bank));
+
+  // Unaligned and overflowing i64 registers.
+  BytecodeBuilder i64_unaligned;
+  i64_unaligned.Op(IREE_VM_OP_CORE_ConstI64).U64(0).U16(1);
+  i64_unaligned.Op(IREE_VM_OP_CORE_Return).List({});
+  EXPECT_EQ(IREE_STATUS_INVALID_ARGUMENT, Verify(i64_unaligned));
+  BytecodeBuilder i64_overflow;
+  i64_overflow.Op(IREE_VM_OP_CORE_ConstI64).U64(0).U16(2);
+  i64_overflow.Op(IREE_VM_OP_CORE_Return).List({});
+  EXPECT_EQ(IREE_STATUS_INVALID_ARGUMENT,
+            Verify(i64_overflow, /*i32_register_count=*/3));
+
+  // Ref register out of range in a register list.
+  BytecodeBuilder ref_range;
+  ref_range.Op(IREE_VM_OP_CORE_Return).List({kRef | 2});
+  EXPECT_EQ(IREE_STATUS_INVALID_ARGUMENT, Verify(ref_range));
+}
+
+TEST_F(VMBytecodeVerifierTest, ModuleOrdinals) {
+  // Type ordinal.
+  BytecodeBuilder type;
+  type.Op(IREE_VM_OP_CORE_ListAlloc).U32(3).U16(0).U16(kRef | 0);
+  type.Op(IREE_VM_OP_CORE_Return).List({});
+  EXPECT_EQ(IREE_STATUS_INVALID_ARGUMENT, Verify(type));
+
+  // Internal and import function ordinals.
+  BytecodeBuilder internal_function;
+  internal_function.Op(IREE_VM_OP_CORE_Call).U32(2).List({}).List({});
+  internal_function.Op(IREE_VM_OP_CORE_Return).List({});
+  EXPECT_EQ(IREE_STATUS_INVALID_ARGUMENT, Verify(internal_function));
+  BytecodeBuilder import_function;
+  import_function.Op(IREE_VM_OP_CORE_Call).U32(0x80000001u).List({}).List({});
+  import_function.Op(IREE_VM_OP_CORE_Return).List({});
+  EXPECT_EQ(IREE_STATUS_INVALID_ARGUMENT, Verify(import_function));
+
+  // Globals must be entirely within rwdata.
+  BytecodeBuilder global;
+  global.Op(IREE_VM_OP_CORE_GlobalLoadI64).U32(12).U16(0);
+  global.Op(IREE_VM_OP_CORE_Return).List({});
+  EXPECT_EQ(IREE_STATUS_INVALID_ARGUMENT, Verify(global));
+}
+
+}  // namespace
@@ -38,6 +38,19 @@ struct iree_vm_context_t {
     iree_vm_module_t** modules;
     iree_vm_module_state_t** module_states;
   } list;
+
+  // Frozen context this context was forked from, if any. Forked contexts share
+  // the module list of the parent and only maintain their own module states.
+  iree_vm_context_t* parent;
+  struct {
+    // Module states lazily forked from the parent, indexed by module ordinal.
+    // Zero if the state has not yet been forked. Modules that do not support
+    // forking have the parent state stored here on creation.
+    iree_atomic_intptr_t* states;
+    // Module states of the parent context, indexed by module ordinal. A state
+    // in |states| is owned by this context only if it differs from the parent.
+    iree_vm_module_state_t** parent_states;
+  } fork;
 };
 
 static void iree_vm_context_destroy(iree_vm_context_t* context);
@@ -95,6 +108,39 @@ static iree_status_t iree_vm_context_run_function(
   return status;
 }
 
+// Returns the state of the module at |ordinal| in the forked |context|,
+// forking it from the parent state if this is the first use.
+static iree_status_t iree_vm_context_query_forked_module_state(
+    iree_vm_context_t* context, iree_host_size_t ordinal,
+    iree_vm_module_state_t** out_module_state) {
+  iree_atomic_intptr_t* slot = &context->fork.states[ordinal];
+  intptr_t state = iree_atomic_load_intptr(slot, iree_memory_order_acquire);
+  iree_vm_module_state_t* parent_state = context->fork.parent_states[ordinal];
+  if (IREE_LIKELY(state) || !parent_state) {
+    *out_module_state = (iree_vm_module_state_t*)state;
+    return iree_ok_status();
+  }
+
+  // Fork the parent state. Multiple threads may race to fork the same module
+  // and only the first to publish its state wins; the others discard theirs.
+  IREE_TRACE_ZONE_BEGIN(z0);
+  iree_vm_module_t* module = context->list.modules[ordinal];
+  iree_vm_module_state_t* forked_state = NULL;
+  IREE_RETURN_AND_END_ZONE_IF_ERROR(
+      z0, module->fork_state(module->self, parent_state, context->allocator,
+                             &forked_state));
+  intptr_t expected = 0;
+  if (!iree_atomic_compare_exchange_strong_intptr(
+          slot, &expected, (intptr_t)forked_state, iree_memory_order_acq_rel,
+          iree_memory_order_acquire)) {
+    module->free_state(module->self, forked_state);
+    forked_state = (iree_vm_module_state_t*)expected;
+  }
+  *out_module_state = forked_state;
+  IREE_TRACE_ZONE_END(z0);
+  return iree_ok_status();
+}
+
 static iree_status_t iree_vm_context_query_module_state(
     void* state_resolver, iree_vm_module_t* module,
     iree_vm_module_state_t** out_module_state) {
@@ -107,6 +153,10 @@ static iree_status_t iree_vm_context_query_module_state(
   // To future performance profilers: sorry when N>>4 :)
   for (int i = 0; i < context->list.count; ++i) {
     if (context->list.modules[i] == module) {
+      if (IREE_UNLIKELY(context->parent)) {
+        return iree_vm_context_query_forked_module_state(context, i,
+                                                         out_module_state);
+      }
       *out_module_state = context->list.module_states[i];
       return iree_ok_status();
     }
@@ -114,6 +164,24 @@ static iree_status_t iree_vm_context_query_module_state(
   return iree_make_status(IREE_STATUS_NOT_FOUND);
 }
 
+// Returns true if the state of the module at |ordinal| is owned by |context|
+// and stores it in |out_module_state|. States of forked contexts that have not
+// been forked yet or are shared with the parent are not owned.
+static bool iree_vm_context_owned_module_state(
+    iree_vm_context_t* context, iree_host_size_t ordinal,
+    iree_vm_module_state_t** out_module_state) {
+  if (!context->parent) {
+    *out_module_state = context->list.module_states[ordinal];
+    return true;
+  }
+  iree_vm_module_state_t* state =
+      (iree_vm_module_state_t*)iree_atomic_load_intptr(
+          &context->fork.states[ordinal], iree_memory_order_acquire);
+  if (!state || state == context->fork.parent_states[ordinal]) return false;
+  *out_module_state = state;
+  return true;
+}
+
 // Checks that |dependency| is satisfied by the context.
 static iree_status_t iree_vm_context_check_module_dependency(
     void* user_data_ptr, const iree_vm_module_dependency_t* dependency) {
@@ -287,6 +355,23 @@ static void iree_vm_context_release_modules(iree_vm_context_t* context,
   IREE_TRACE_ZONE_END(z0);
 }
 
+// Releases all module states forked by |context|.
+// Module __deinit functions are not run as the states were initialized by the
+// parent context.
+static void iree_vm_context_release_forked_states(iree_vm_context_t* context) {
+  IREE_TRACE_ZONE_BEGIN(z0);
+  for (int i = (int)context->list.count - 1; i >= 0; --i) {
+    iree_vm_module_state_t* module_state = NULL;
+    if (iree_vm_context_owned_module_state(context, i, &module_state)) {
+      iree_vm_module_t* module = context->list.modules[i];
+      module->free_state(module->self, module_state);
+    }
+    iree_atomic_store_intptr(&context->fork.states[i], 0,
+                             iree_memory_order_relaxed);
+  }
+  IREE_TRACE_ZONE_END(z0);
+}
+
 IREE_API_EXPORT iree_status_t iree_vm_context_create(
     iree_vm_instance_t* instance, iree_vm_context_flags_t flags,
     iree_allocator_t allocator, iree_vm_context_t** out_context) {
@@ -317,10 +402,14 @@ IREE_API_EXPORT iree_status_t iree_vm_context_create_with_modules(
 
   context->context_id = iree_vm_context_allocate_id();
 
-  // TODO(benvanik): allow for non-frozen but static contexts.
+  // NOTE: contexts that need per-request mutable state on top of a static
+  // set of modules should use iree_vm_context_fork.
   context->is_frozen = module_count > 0;
   context->is_static = module_count > 0;
   context->flags = flags;
+  context->parent = NULL;
+  context->fork.states = NULL;
+  context->fork.parent_states = NULL;
 
   uint8_t* p = (uint8_t*)context + sizeof(iree_vm_context_t);
   context->list.modules = (iree_vm_module_t**)p;
@@ -348,7 +437,12 @@ static void iree_vm_context_destroy(iree_vm_context_t* context) {
 
   IREE_TRACE_ZONE_BEGIN(z0);
 
-  if (context->list.count > 0) {
+  if (context->parent) {
+    // Modules are owned by the parent; only our forked states are released.
+    iree_vm_context_release_forked_states(context);
+    iree_vm_context_release(context->parent);
+    context->parent = NULL;
+  } else if (context->list.count > 0) {
     iree_vm_context_release_modules(context, 0, context->list.count - 1);
   }
 
@@ -395,6 +489,12 @@ iree_vm_context_flags(const iree_vm_context_t* context) {
   return context->flags;
 }
 
+IREE_API_EXPORT iree_vm_instance_t* iree_vm_context_instance(
+    const iree_vm_context_t* context) {
+  IREE_ASSERT_ARGUMENT(context);
+  return context->instance;
+}
+
 IREE_API_EXPORT iree_status_t iree_vm_context_register_modules(
     iree_vm_context_t* context, iree_host_size_t module_count,
     iree_vm_module_t** modules) {
@@ -528,6 +628,71 @@ iree_vm_context_freeze(iree_vm_context_t* context) {
   return iree_ok_status();
 }
 
+IREE_API_EXPORT iree_status_t iree_vm_context_fork(
+    iree_vm_context_t* parent, iree_allocator_t allocator,
+    iree_vm_context_t** out_context) {
+  IREE_ASSERT_ARGUMENT(parent);
+  IREE_ASSERT_ARGUMENT(out_context);
+  *out_context = NULL;
+  if (!parent->is_frozen) {
+    return iree_make_status(IREE_STATUS_FAILED_PRECONDITION,
+                            "only frozen contexts can be forked");
+  }
+  IREE_TRACE_ZONE_BEGIN(z0);
+
+  // Resolve the parent states first; if the parent is itself forked this will
+  // fork its states so that they are stable for the lifetime of our context.
+  iree_host_size_t module_count = parent->list.count;
+  iree_host_size_t context_size =
+      sizeof(iree_vm_context_t) + sizeof(iree_atomic_intptr_t) * module_count +
+      sizeof(iree_vm_module_state_t*) * module_count;
+  iree_vm_context_t* context = NULL;
+  IREE_RETURN_AND_END_ZONE_IF_ERROR(
+      z0, iree_allocator_malloc(allocator, context_size, (void**)&context));
+  uint8_t* p = (uint8_t*)context + sizeof(iree_vm_context_t);
+  context->fork.states = (iree_atomic_intptr_t*)p;
+  p += sizeof(iree_atomic_intptr_t) * module_count;
+  context->fork.parent_states = (iree_vm_module_state_t**)p;
+  p += sizeof(iree_vm_module_state_t*) * module_count;
+  iree_status_t status = iree_ok_status();
+  for (iree_host_size_t i = 0; i < module_count; ++i) {
+    iree_vm_module_t* module = parent->list.modules[i];
+    iree_vm_module_state_t* parent_state = NULL;
+    status = iree_vm_context_query_module_state(parent, module, &parent_state);
+    if (!iree_status_is_ok(status)) break;
+    context->fork.parent_states[i] = parent_state;
+    // Modules that cannot fork share the parent state.
+    iree_atomic_store_intptr(
+        &context->fork.states[i],
+        module->fork_state ? 0 : (intptr_t)parent_state,
+        iree_memory_order_relaxed);
+  }
+  if (!iree_status_is_ok(status)) {
+    iree_allocator_free(allocator, context);
+    IREE_TRACE_ZONE_END(z0);
+    return status;
+  }
+
+  iree_atomic_ref_count_init(&context->ref_count);
+  context->instance = parent->instance;
+  iree_vm_instance_retain(context->instance);
+  context->allocator = allocator;
+  context->context_id = iree_vm_context_allocate_id();
+  context->is_frozen = 1;
+  context->is_static = 1;
+  context->flags = parent->flags;
+  context->list.count = module_count;
+  context->list.capacity = module_count;
+  context->list.modules = parent->list.modules;
+  context->list.module_states = NULL;
+  context->parent = parent;
+  iree_vm_context_retain(context->parent);
+
+  *out_context = context;
+  IREE_TRACE_ZONE_END(z0);
+  return iree_ok_status();
+}
+
 IREE_API_EXPORT iree_vm_state_resolver_t
 iree_vm_context_state_resolver(const iree_vm_context_t* context) {
   iree_vm_state_resolver_t state_resolver = {0};
@@ -616,7 +781,11 @@ static iree_status_t iree_vm_context_notify_forward(iree_vm_stack_t* stack,
   iree_status_t status = iree_ok_status();
   for (iree_host_size_t i = 0; i < context->list.count; ++i) {
     iree_vm_module_t* module = context->list.modules[i];
-    iree_vm_module_state_t* module_state = context->list.module_states[i];
+    iree_vm_module_state_t* module_state = NULL;
+    if (!iree_vm_context_owned_module_state(context, i, &module_state)) {
+      // Shared states are notified by the context owning them.
+      continue;
+    }
 
     // Call the module internal interface notify method.
     // This handles the resources owned by the module implementation itself
@@ -643,7 +812,11 @@ static iree_status_t iree_vm_context_notify_reverse(iree_vm_stack_t* stack,
   iree_status_t status = iree_ok_status();
   for (int i = (int)context->list.count - 1; i >= 0; --i) {
     iree_vm_module_t* module = context->list.modules[i];
-    iree_vm_module_state_t* module_state = context->list.module_states[i];
+    iree_vm_module_state_t* module_state = NULL;
+    if (!iree_vm_context_owned_module_state(context, i, &module_state)) {
+      // Shared states are notified by the context owning them.
+      continue;
+    }
 
     // Call the user-level notify method first.
     // This allows users to drop any state that they can rematerialize and
@@ -83,6 +83,10 @@ iree_vm_context_id(const iree_vm_context_t* context);
 IREE_API_EXPORT iree_vm_context_flags_t
 iree_vm_context_flags(const iree_vm_context_t* context);
 
+// Returns the instance the |context| was created within.
+IREE_API_EXPORT iree_vm_instance_t* iree_vm_context_instance(
+    const iree_vm_context_t* context);
+
 // Registers a list of modules with the context and resolves imports in the
 // order provided.
 // The modules will be retained by the context until destruction.
@@ -97,6 +101,33 @@ IREE_API_EXPORT iree_status_t iree_vm_context_register_modules(
 IREE_API_EXPORT iree_status_t
 iree_vm_context_freeze(iree_vm_context_t* context);
 
+// Creates a new context sharing the modules of the frozen |parent| context
+// with copy-on-write module state.
+//
+// Module state is forked lazily from the parent on first use within the new
+// context: for example bytecode modules receive a private copy of their
+// globals as they were after the parent ran its initializers. Globals
+// modified in the forked context are not observed by the parent or any sibling
+// forks. Ref globals initially reference the same objects as the parent and
+// mutations made through those objects (such as stores into a shared list) are
+// visible to all contexts referencing them.
+//
+// Modules that do not support forking (see iree_vm_module_t::fork_state) use
+// the parent module state directly and must be safe to use from all forked
+// contexts concurrently.
+//
+// Module initializers are not run for the forked context and deinitializers
+// are only run when the parent is destroyed. The forked context retains the
+// parent and is itself frozen.
+//
+// Forked contexts are cheap to create (a single allocation) and are intended
+// for per-request or per-session isolation of a shared program. Resolving
+// module state may happen concurrently from multiple threads.
+// |out_context| must be released by the caller.
+IREE_API_EXPORT iree_status_t iree_vm_context_fork(
+    iree_vm_context_t* parent, iree_allocator_t allocator,
+    iree_vm_context_t** out_context);
+
 // Returns a state resolver setup to use the |context| for resolving module
 // state.
 IREE_API_EXPORT iree_vm_state_resolver_t
@@ -8,8 +8,10 @@
 
 #include <stddef.h>
 
+#include "iree/base/internal/arena.h"
 #include "iree/base/internal/atomics.h"
 #include "iree/base/tracing.h"
+#include "iree/vm/stack.h"
 
 // Defined in their respective files:
 iree_status_t iree_vm_buffer_register_types(iree_vm_instance_t* instance);
@@ -27,6 +29,8 @@ static iree_status_t iree_vm_register_builtin_types(
 struct iree_vm_instance_t {
   iree_atomic_ref_count_t ref_count;
   iree_allocator_t allocator;
+  // Segments used by stacks that outgrow their initial storage.
+  iree_arena_block_pool_t stack_block_pool;
 };
 
 IREE_API_EXPORT iree_status_t iree_vm_instance_create(
@@ -41,6 +45,8 @@ IREE_API_EXPORT iree_status_t iree_vm_instance_create(
       iree_allocator_malloc(allocator, sizeof(*instance), (void**)&instance));
   instance->allocator = allocator;
   iree_atomic_ref_count_init(&instance->ref_count);
+  iree_arena_block_pool_initialize(IREE_VM_STACK_SEGMENT_SIZE, allocator,
+                                   &instance->stack_block_pool);
 
   iree_status_t status = iree_vm_register_builtin_types(instance);
 
@@ -56,6 +62,7 @@ IREE_API_EXPORT iree_status_t iree_vm_instance_create(
 static void iree_vm_instance_destroy(iree_vm_instance_t* instance) {
   IREE_TRACE_ZONE_BEGIN(z0);
   IREE_ASSERT_ARGUMENT(instance);
+  iree_arena_block_pool_deinitialize(&instance->stack_block_pool);
   iree_allocator_free(instance->allocator, instance);
   IREE_TRACE_ZONE_END(z0);
 }
@@ -77,3 +84,9 @@ iree_vm_instance_allocator(iree_vm_instance_t* instance) {
   IREE_ASSERT_ARGUMENT(instance);
   return instance->allocator;
 }
+
+IREE_API_EXPORT iree_arena_block_pool_t* iree_vm_instance_stack_block_pool(
+    iree_vm_instance_t* instance) {
+  IREE_ASSERT_ARGUMENT(instance);
+  return &instance->stack_block_pool;
+}
@@ -44,6 +44,14 @@ IREE_API_EXPORT void iree_vm_instance_release(iree_vm_instance_t* instance);
 IREE_API_EXPORT iree_allocator_t
 iree_vm_instance_allocator(iree_vm_instance_t* instance);
 
+typedef struct iree_arena_block_pool_t iree_arena_block_pool_t;
+
+// Returns a block pool shared by all stacks executing within the instance.
+// Stacks that outgrow their initial storage acquire additional segments from
+// the pool so that deep call chains reuse storage across invocations.
+IREE_API_EXPORT iree_arena_block_pool_t* iree_vm_instance_stack_block_pool(
+    iree_vm_instance_t* instance);
+
 #ifdef __cplusplus
 }  // extern "C"
 #endif  // __cplusplus
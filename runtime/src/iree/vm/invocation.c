@@ -12,6 +12,9 @@
 
 #include "iree/base/api.h"
 #include "iree/base/internal/debugging.h"
+#include "iree/base/internal/metrics.h"
+#include "iree/base/internal/sampling_tracer.h"
+#include "iree/base/internal/wait_handle.h"
 #include "iree/base/tracing.h"
 #include "iree/vm/ref.h"
 #include "iree/vm/stack.h"
@@ -179,6 +182,26 @@ static iree_status_t iree_vm_invoke_marshal_outputs(
   return iree_ok_status();
 }
 
+// Marshals between the calling convention |storage| described by
+// |cconv_fragment| and some user-defined source or target.
+typedef iree_status_t (*iree_vm_invoke_marshal_fn_t)(
+    void* user_data, iree_string_view_t cconv_fragment,
+    iree_byte_span_t storage);
+
+static iree_status_t iree_vm_invoke_marshal_inputs_from_list(
+    void* user_data, iree_string_view_t cconv_arguments,
+    iree_byte_span_t arguments) {
+  return iree_vm_invoke_marshal_inputs(
+      cconv_arguments, (const iree_vm_list_t*)user_data, arguments);
+}
+
+static iree_status_t iree_vm_invoke_marshal_outputs_to_list(
+    void* user_data, iree_string_view_t cconv_results,
+    iree_byte_span_t results) {
+  return iree_vm_invoke_marshal_outputs(cconv_results, results,
+                                        (iree_vm_list_t*)user_data);
+}
+
 //===----------------------------------------------------------------------===//
 // Fiber tracing support
 //===----------------------------------------------------------------------===//
@@ -248,11 +271,26 @@ static void iree_vm_invoke_fiber_leave(iree_vm_invocation_id_t invocation_id,
 // Synchronous invocation
 //===----------------------------------------------------------------------===//
 
-IREE_API_EXPORT iree_status_t iree_vm_invoke(
-    iree_vm_context_t* context, iree_vm_function_t function,
-    iree_vm_invocation_flags_t flags, const iree_vm_invocation_policy_t* policy,
-    const iree_vm_list_t* inputs, iree_vm_list_t* outputs,
-    iree_allocator_t host_allocator) {
+static iree_status_t iree_vm_begin_invoke_with_marshaler(
+    iree_vm_invoke_state_t* state, iree_vm_context_t* context,
+    iree_vm_function_t function, iree_vm_invocation_flags_t flags,
+    const iree_vm_invocation_policy_t* policy,
+    iree_vm_invoke_marshal_fn_t marshal_inputs, void* marshal_inputs_user_data,
+    iree_allocator_t host_allocator);
+static iree_status_t iree_vm_end_invoke_with_marshaler(
+    iree_vm_invoke_state_t* state, iree_vm_invoke_marshal_fn_t marshal_outputs,
+    void* marshal_outputs_user_data, iree_status_t* out_status);
+
+// Runs an invocation to completion using |state| as storage.
+// Inputs are produced by |marshal_inputs| and outputs are consumed by
+// |marshal_outputs| directly in calling convention layout.
+static iree_status_t iree_vm_invoke_with_marshalers(
+    iree_vm_invoke_state_t* state, iree_vm_context_t* context,
+    iree_vm_function_t function, iree_vm_invocation_flags_t flags,
+    const iree_vm_invocation_policy_t* policy,
+    iree_vm_invoke_marshal_fn_t marshal_inputs, void* marshal_inputs_user_data,
+    iree_vm_invoke_marshal_fn_t marshal_outputs,
+    void* marshal_outputs_user_data, iree_allocator_t host_allocator) {
   IREE_TRACE_ZONE_BEGIN(z0);
 
   // Bound the synchronous invocation to the timeout specified by the user
@@ -277,16 +315,16 @@ IREE_API_EXPORT iree_status_t iree_vm_invoke(
   // Perform the initial invocation step, which if synchronous may fully
   // complete the invocation before returning. If it yields we'll need to resume
   // it, possibly after taking care of pending waits.
-  iree_vm_invoke_state_t state = {0};
-  iree_status_t status = iree_vm_begin_invoke(&state, context, function, flags,
-                                              policy, inputs, host_allocator);
+  iree_status_t status = iree_vm_begin_invoke_with_marshaler(
+      state, context, function, flags, policy, marshal_inputs,
+      marshal_inputs_user_data, host_allocator);
   while (iree_status_is_deferred(status)) {
     // Grab the wait frame from the stack holding the wait parameters.
     // This is optional: if an invocation yields for cooperative scheduling
     // purposes there will not be a wait frame on the stack and we'll just
     // resume it below.
     iree_vm_stack_frame_t* current_frame =
-        iree_vm_stack_current_frame(state.stack);
+        iree_vm_stack_current_frame(state->stack);
     if (IREE_UNLIKELY(!current_frame)) {
       // Unbalanced stack.
       status = iree_make_status(IREE_STATUS_FAILED_PRECONDITION,
@@ -296,31 +334,32 @@ IREE_API_EXPORT iree_status_t iree_vm_invoke(
       // Perform the wait operation synchronously.
       // We do this outside of the fiber to match accounting with async
       // executors.
-      IREE_TRACE(iree_vm_invoke_fiber_leave(invocation_id, state.stack));
+      IREE_TRACE(iree_vm_invoke_fiber_leave(invocation_id, state->stack));
       IREE_TRACE_ZONE_END(zi);
 
       iree_vm_wait_frame_t* wait_frame =
           (iree_vm_wait_frame_t*)iree_vm_stack_frame_storage(current_frame);
-      status = iree_vm_wait_invoke(&state, wait_frame, deadline_ns);
+      status = iree_vm_wait_invoke(state, wait_frame, deadline_ns);
 
       // Restore tick zone and re-enter the fiber for the resume.
       IREE_TRACE_ZONE_BEGIN_NAMED(zi_next, "iree_vm_invoke_tick");
       zi = zi_next;
-      IREE_TRACE(iree_vm_invoke_fiber_reenter(invocation_id, state.stack));
+      IREE_TRACE(iree_vm_invoke_fiber_reenter(invocation_id, state->stack));
       if (!iree_status_is_ok(status)) break;
     }
 
     // Resume the invocation after its wait completes (if it wasn't just a
     // simple yield for cooperation). This may yield again and require another
     // tick or complete with OK (or an error).
-    status = iree_vm_resume_invoke(&state);
+    status = iree_vm_resume_invoke(state);
   }
 
   // If the invoke process itself was successful we can end the invocation
   // cleanly and get the invocation status as returned by the target function.
   iree_status_t invoke_status = iree_ok_status();
   if (iree_status_is_ok(status)) {
-    status = iree_vm_end_invoke(&state, outputs, &invoke_status);
+    status = iree_vm_end_invoke_with_marshaler(
+        state, marshal_outputs, marshal_outputs_user_data, &invoke_status);
   }
 
   // Otherwise if we failed to invoke we need to tear down the state to release
@@ -329,11 +368,11 @@ IREE_API_EXPORT iree_status_t iree_vm_invoke(
     // Cleanup the invocation state if the end wasn't able to.
     // This may leave the context in an unexpected state but the caller is
     // expected to tear down everything if this happens.
-    iree_vm_abort_invoke(&state);
+    iree_vm_abort_invoke(state);
   }
 
   // Leave the fiber context now that execution has completed.
-  IREE_TRACE(iree_vm_invoke_fiber_leave(invocation_id, state.stack));
+  IREE_TRACE(iree_vm_invoke_fiber_leave(invocation_id, state->stack));
   IREE_TRACE_ZONE_END(zi);
 
   // If we succeeded at invoking the status will be OK and the invoke_status
@@ -347,16 +386,49 @@ IREE_API_EXPORT iree_status_t iree_vm_invoke(
   return status;
 }
 
+IREE_METRIC_DEFINE(iree_vm_invocations_metric, COUNTER,
+                   "iree_vm_invocations_total",
+                   "Number of synchronous VM function invocations.");
+IREE_METRIC_DEFINE(iree_vm_invocation_failures_metric, COUNTER,
+                   "iree_vm_invocation_failures_total",
+                   "Number of synchronous VM invocations that failed.");
+IREE_METRIC_DEFINE(iree_vm_invocation_duration_metric, HISTOGRAM,
+                   "iree_vm_invocation_duration_microseconds",
+                   "Wall time of synchronous VM function invocations.");
+
+IREE_API_EXPORT iree_status_t iree_vm_invoke(
+    iree_vm_context_t* context, iree_vm_function_t function,
+    iree_vm_invocation_flags_t flags, const iree_vm_invocation_policy_t* policy,
+    const iree_vm_list_t* inputs, iree_vm_list_t* outputs,
+    iree_allocator_t host_allocator) {
+  IREE_METRICS(const iree_time_t start_ns = iree_time_now());
+  IREE_SAMPLED_ZONE_BEGIN(z_sample, "iree_vm_invoke");
+  iree_vm_invoke_state_t state = {0};
+  iree_status_t status = iree_vm_invoke_with_marshalers(
+      &state, context, function, flags, policy,
+      iree_vm_invoke_marshal_inputs_from_list, (void*)inputs,
+      iree_vm_invoke_marshal_outputs_to_list, outputs, host_allocator);
+  IREE_METRIC_ADD(iree_vm_invocations_metric, 1);
+  if (!iree_status_is_ok(status)) {
+    IREE_METRIC_ADD(iree_vm_invocation_failures_metric, 1);
+  }
+  IREE_METRIC_OBSERVE(iree_vm_invocation_duration_metric,
+                      (iree_time_now() - start_ns) / 1000);
+  IREE_SAMPLED_ZONE_END(z_sample);
+  return status;
+}
+
 //===----------------------------------------------------------------------===//
 // Asynchronous invocation
 //===----------------------------------------------------------------------===//
 
 // WARNING: this function cannot have any trace markers that span the begin
 // call; the begin may yield with zones still open.
-IREE_API_EXPORT iree_status_t iree_vm_begin_invoke(
+static iree_status_t iree_vm_begin_invoke_with_marshaler(
     iree_vm_invoke_state_t* state, iree_vm_context_t* context,
     iree_vm_function_t function, iree_vm_invocation_flags_t flags,
-    const iree_vm_invocation_policy_t* policy, const iree_vm_list_t* inputs,
+    const iree_vm_invocation_policy_t* policy,
+    iree_vm_invoke_marshal_fn_t marshal_inputs, void* marshal_inputs_user_data,
     iree_allocator_t host_allocator) {
   IREE_ASSERT_ARGUMENT(context);
   IREE_TRACE_ZONE_BEGIN(z0);
@@ -415,7 +487,7 @@ IREE_API_EXPORT iree_status_t iree_vm_begin_invoke(
   // buffer. If marshaling fails we need to cleanup the arguments.
   // NOTE: today we don't support variadic arguments through this interface.
   iree_status_t status =
-      iree_vm_invoke_marshal_inputs(cconv_arguments, inputs, arguments);
+      marshal_inputs(marshal_inputs_user_data, cconv_arguments, arguments);
   if (!iree_status_is_ok(status)) {
     iree_vm_invoke_release_io_storage(cconv_arguments, arguments);
     IREE_TRACE_ZONE_END(z0);
@@ -433,6 +505,8 @@ IREE_API_EXPORT iree_status_t iree_vm_begin_invoke(
                   sizeof(state->stack_storage) - result_storage_size),
               flags, iree_vm_context_state_resolver(context), host_allocator,
               &stack));
+  iree_vm_stack_set_block_pool(stack, iree_vm_instance_stack_block_pool(
+                                          iree_vm_context_instance(context)));
 
   // NOTE: at this point the stack must be properly deinitialized if we bail.
 
@@ -470,6 +544,16 @@ IREE_API_EXPORT iree_status_t iree_vm_begin_invoke(
   return iree_ok_status();
 }
 
+IREE_API_EXPORT iree_status_t iree_vm_begin_invoke(
+    iree_vm_invoke_state_t* state, iree_vm_context_t* context,
+    iree_vm_function_t function, iree_vm_invocation_flags_t flags,
+    const iree_vm_invocation_policy_t* policy, const iree_vm_list_t* inputs,
+    iree_allocator_t host_allocator) {
+  return iree_vm_begin_invoke_with_marshaler(
+      state, context, function, flags, policy,
+      iree_vm_invoke_marshal_inputs_from_list, (void*)inputs, host_allocator);
+}
+
 // WARNING: this function cannot have any trace markers that span the resume
 // call; the resume may yield with zones still open.
 IREE_API_EXPORT iree_status_t
@@ -526,6 +610,139 @@ iree_vm_resume_invoke(iree_vm_invoke_state_t* state) {
   return iree_ok_status();
 }
 
+// Queries all |wait_sources| without blocking.
+// Sets |out_any_resolved| if at least one source has resolved successfully and
+// |out_all_resolved| if all sources have. Returns the failure of the first
+// source that resolved with an error (or whose query failed).
+static iree_status_t iree_vm_wait_query_all(
+    iree_host_size_t count, const iree_wait_source_t* wait_sources,
+    bool* out_any_resolved, bool* out_all_resolved) {
+  *out_any_resolved = false;
+  *out_all_resolved = true;
+  for (iree_host_size_t i = 0; i < count; ++i) {
+    iree_status_code_t wait_status_code = IREE_STATUS_OK;
+    IREE_RETURN_IF_ERROR(
+        iree_wait_source_query(wait_sources[i], &wait_status_code));
+    if (wait_status_code == IREE_STATUS_OK) {
+      *out_any_resolved = true;
+    } else if (wait_status_code == IREE_STATUS_DEFERRED) {
+      *out_all_resolved = false;
+    } else {
+      return iree_status_from_code(wait_status_code);
+    }
+  }
+  return iree_ok_status();
+}
+
+// Inserts all unresolved |wait_sources| into |wait_set| as system wait handles.
+// Returns IREE_STATUS_UNAVAILABLE if any wait source cannot be exported.
+static iree_status_t iree_vm_wait_set_insert_sources(
+    iree_wait_set_t* wait_set, iree_host_size_t count,
+    const iree_wait_source_t* wait_sources) {
+  for (iree_host_size_t i = 0; i < count; ++i) {
+    iree_wait_source_t wait_source = wait_sources[i];
+    if (iree_wait_source_is_immediate(wait_source)) continue;
+    iree_wait_handle_t wait_handle = iree_wait_handle_immediate();
+    iree_wait_handle_t* wait_handle_ptr =
+        iree_wait_handle_from_source(&wait_source);
+    if (wait_handle_ptr) {
+      // Already a wait handle - can directly insert it.
+      wait_handle = *wait_handle_ptr;
+    } else {
+      iree_wait_primitive_t wait_primitive = iree_wait_primitive_immediate();
+      IREE_RETURN_IF_ERROR(iree_wait_source_export(
+          wait_source, IREE_WAIT_PRIMITIVE_TYPE_ANY, iree_immediate_timeout(),
+          &wait_primitive));
+      iree_wait_handle_wrap_primitive(wait_primitive.type, wait_primitive.value,
+                                      &wait_handle);
+    }
+    IREE_RETURN_IF_ERROR(iree_wait_set_insert(wait_set, wait_handle));
+  }
+  return iree_ok_status();
+}
+
+// Waits on all wait sources with a single system multi-wait.
+// Returns IREE_STATUS_UNAVAILABLE if wait sets are not supported on the
+// platform or any of the wait sources cannot be exported to a system wait
+// primitive; the caller must fall back to waiting on each source in turn.
+static iree_status_t iree_vm_wait_multi_system(
+    iree_vm_wait_type_t wait_type, iree_host_size_t count,
+    const iree_wait_source_t* wait_sources, iree_time_t deadline_ns,
+    iree_allocator_t host_allocator) {
+  iree_wait_set_t* wait_set = NULL;
+  iree_status_t status =
+      iree_wait_set_allocate(count, host_allocator, &wait_set);
+  if (iree_status_is_ok(status)) {
+    status = iree_vm_wait_set_insert_sources(wait_set, count, wait_sources);
+  }
+  if (!iree_status_is_ok(status)) {
+    iree_wait_set_free(wait_set);
+    iree_status_ignore(status);
+    return iree_status_from_code(IREE_STATUS_UNAVAILABLE);
+  }
+  if (wait_type == IREE_VM_WAIT_ANY) {
+    iree_wait_handle_t wake_handle = iree_wait_handle_immediate();
+    status = iree_wait_any(wait_set, deadline_ns, &wake_handle);
+  } else {
+    status = iree_wait_all(wait_set, deadline_ns);
+  }
+  iree_wait_set_free(wait_set);
+  return status;
+}
+
+// Waits on |count| |wait_sources| until any or all of them (based on
+// |wait_type|) resolve or |deadline_ns| elapses.
+//
+// Sources that have already resolved are handled without blocking. The
+// remaining sources are waited on with a single system multi-wait when they
+// can all be exported to wait primitives so that the host only wakes once.
+// Otherwise (such as on bare-metal) the sources are waited on one at a time.
+static iree_status_t iree_vm_wait_multi(iree_vm_wait_type_t wait_type,
+                                        iree_host_size_t count,
+                                        const iree_wait_source_t* wait_sources,
+                                        iree_time_t deadline_ns,
+                                        iree_allocator_t host_allocator) {
+  IREE_TRACE_ZONE_BEGIN(z0);
+  IREE_TRACE_ZONE_APPEND_VALUE(z0, (int64_t)count);
+
+  // Fast path for when the waits have already resolved (or failed).
+  bool any_resolved = false;
+  bool all_resolved = false;
+  IREE_RETURN_AND_END_ZONE_IF_ERROR(
+      z0, iree_vm_wait_query_all(count, wait_sources, &any_resolved,
+                                 &all_resolved));
+  if (all_resolved || (wait_type == IREE_VM_WAIT_ANY && any_resolved)) {
+    IREE_TRACE_ZONE_END(z0);
+    return iree_ok_status();
+  }
+
+  iree_status_t status = iree_vm_wait_multi_system(
+      wait_type, count, wait_sources, deadline_ns, host_allocator);
+  if (iree_status_is_unavailable(status)) {
+    // Multi-wait not available; wait on each source in turn. For wait-any we
+    // pick the first source to be (somewhat) deterministic.
+    iree_status_ignore(status);
+    status = iree_ok_status();
+    const iree_host_size_t wait_count =
+        wait_type == IREE_VM_WAIT_ANY ? 1 : count;
+    for (iree_host_size_t i = 0; i < wait_count; ++i) {
+      status = iree_wait_source_wait_one(wait_sources[i],
+                                         iree_make_deadline(deadline_ns));
+      if (!iree_status_is_ok(status)) break;
+    }
+  }
+
+  // Wait handles only indicate that the sources resolved and not whether they
+  // failed so we scan again to propagate errors.
+  if (iree_status_is_ok(status)) {
+    status = iree_vm_wait_query_all(count, wait_sources, &any_resolved,
+                                    &all_resolved);
+  }
+
+  IREE_TRACE_ZONE_END(z0);
+  return status;
+}
+
 IREE_API_EXPORT iree_status_t
 iree_vm_wait_invoke(iree_vm_invoke_state_t* state,
                     iree_vm_wait_frame_t* wait_frame, iree_time_t deadline_ns) {
@@ -554,12 +771,9 @@ iree_vm_wait_invoke(iree_vm_invoke_state_t* state,
     wait_frame->wait_status = iree_wait_source_wait_one(
         wait_frame->wait_sources[0], iree_make_deadline(min_deadline_ns));
   } else {
-    // TODO(benvanik): multi-wait when running synchronously. This is already
-    // supported by iree_loop_inline_t and maybe we can just reuse that. These
-    // are not currently emitted by the compiler.
-    return iree_make_status(
-        IREE_STATUS_UNIMPLEMENTED,
-        "multi-wait in synchronous invocations not yet implemented");
+    wait_frame->wait_status = iree_vm_wait_multi(
+        wait_frame->wait_type, wait_frame->count, wait_frame->wait_sources,
+        min_deadline_ns, iree_vm_stack_allocator(state->stack));
   }
 
   // Reset status to OK - the next resume will pick back up in the waiter.
@@ -570,9 +784,9 @@ iree_vm_wait_invoke(iree_vm_invoke_state_t* state,
   return iree_ok_status();
 }
 
-IREE_API_EXPORT iree_status_t iree_vm_end_invoke(iree_vm_invoke_state_t* state,
-                                                 iree_vm_list_t* outputs,
-                                                 iree_status_t* out_status) {
+static iree_status_t iree_vm_end_invoke_with_marshaler(
+    iree_vm_invoke_state_t* state, iree_vm_invoke_marshal_fn_t marshal_outputs,
+    void* marshal_outputs_user_data, iree_status_t* out_status) {
   IREE_ASSERT_ARGUMENT(state);
   IREE_ASSERT_ARGUMENT(out_status);
   *out_status = iree_ok_status();
@@ -602,8 +816,8 @@ IREE_API_EXPORT iree_status_t iree_vm_end_invoke(iree_vm_invoke_state_t* state,
   // the user-provided storage. The outputs list will retain all results.
   if (iree_status_is_ok(invoke_status)) {
     IREE_RETURN_AND_END_ZONE_IF_ERROR(
-        z0, iree_vm_invoke_marshal_outputs(state->cconv_results, state->results,
-                                           outputs));
+        z0, marshal_outputs(marshal_outputs_user_data, state->cconv_results,
+                            state->results));
   }
 
   // Cleanup the invocation resources.
@@ -615,6 +829,13 @@ IREE_API_EXPORT iree_status_t iree_vm_end_invoke(iree_vm_invoke_state_t* state,
   return iree_ok_status();
 }
 
+IREE_API_EXPORT iree_status_t iree_vm_end_invoke(iree_vm_invoke_state_t* state,
+                                                 iree_vm_list_t* outputs,
+                                                 iree_status_t* out_status) {
+  return iree_vm_end_invoke_with_marshaler(
+      state, iree_vm_invoke_marshal_outputs_to_list, outputs, out_status);
+}
+
 IREE_API_EXPORT void iree_vm_abort_invoke(iree_vm_invoke_state_t* state) {
   // We expect that the caller has already suspended the stack tracing zones,
   // but in failure cases we can end up here and want to ensure that things are
@@ -645,6 +866,308 @@ IREE_API_EXPORT void iree_vm_abort_invoke(iree_vm_invoke_state_t* state) {
   IREE_TRACE_ZONE_END(z0);
 }
 
+//===----------------------------------------------------------------------===//
+// Reusable synchronous invocation
+//===----------------------------------------------------------------------===//
+
+// Calls |visit| on each ref in the calling convention |storage|.
+static void iree_vm_invocation_record_visit_refs(
+    iree_string_view_t cconv_fragment, iree_byte_span_t storage,
+    void (*visit)(iree_vm_ref_t* ref)) {
+  if (!storage.data_length) return;
+  uint8_t* p = storage.data;
+  for (iree_host_size_t i = 0; i < cconv_fragment.size; ++i) {
+    switch (cconv_fragment.data[i]) {
+      default:
+      case IREE_VM_CCONV_TYPE_VOID:
+        break;
+      case IREE_VM_CCONV_TYPE_I32:
+      case IREE_VM_CCONV_TYPE_F32:
+        p += sizeof(int32_t);
+        break;
+      case IREE_VM_CCONV_TYPE_I64:
+      case IREE_VM_CCONV_TYPE_F64:
+        p += sizeof(int64_t);
+        break;
+      case IREE_VM_CCONV_TYPE_REF:
+        visit((iree_vm_ref_t*)p);
+        p += sizeof(iree_vm_ref_t);
+        break;
+    }
+  }
+}
+
+// Returns the calling convention type and storage pointer of the |i|th value
+// within |storage|.
+static iree_status_t iree_vm_invocation_record_lookup(
+    iree_string_view_t cconv_fragment, iree_byte_span_t storage,
+    iree_host_size_t i, char* out_type, uint8_t** out_ptr) {
+  uint8_t* p = storage.data;
+  iree_host_size_t value_i = 0;
+  for (iree_host_size_t cconv_i = 0; cconv_i < cconv_fragment.size;
+       ++cconv_i) {
+    char c = cconv_fragment.data[cconv_i];
+    iree_host_size_t value_size = 0;
+    switch (c) {
+      case IREE_VM_CCONV_TYPE_VOID:
+        continue;
+      case IREE_VM_CCONV_TYPE_I32:
+      case IREE_VM_CCONV_TYPE_F32:
+        value_size = sizeof(int32_t);
+        break;
+      case IREE_VM_CCONV_TYPE_I64:
+      case IREE_VM_CCONV_TYPE_F64:
+        value_size = sizeof(int64_t);
+        break;
+      case IREE_VM_CCONV_TYPE_REF:
+        value_size = sizeof(iree_vm_ref_t);
+        break;
+      default:
+        return iree_make_status(IREE_STATUS_UNIMPLEMENTED,
+                                "unsupported cconv type '%c'", c);
+    }
+    if (value_i == i) {
+      *out_type = c;
+      *out_ptr = p;
+      return iree_ok_status();
+    }
+    ++value_i;
+    p += value_size;
+  }
+  return iree_make_status(IREE_STATUS_OUT_OF_RANGE,
+                          "index %zu out of bounds (%zu)", i, value_i);
+}
+
+// Copies the bound arguments into the invocation argument storage. The callee
+// consumes the arguments so each ref is retained again.
+static iree_status_t iree_vm_invocation_record_marshal_inputs(
+    void* user_data, iree_string_view_t cconv_arguments,
+    iree_byte_span_t arguments) {
+  iree_vm_invocation_record_t* record = (iree_vm_invocation_record_t*)user_data;
+  memcpy(arguments.data, record->arguments.data, arguments.data_length);
+  iree_vm_invocation_record_visit_refs(cconv_arguments, arguments,
+                                       iree_vm_ref_retain_inplace);
+  return iree_ok_status();
+}
+
+// Moves the invocation results into the record result storage.
+static iree_status_t iree_vm_invocation_record_marshal_outputs(
+    void* user_data, iree_string_view_t cconv_results,
+    iree_byte_span_t results) {
+  iree_vm_invocation_record_t* record = (iree_vm_invocation_record_t*)user_data;
+  memcpy(record->results.data, results.data, results.data_length);
+  memset(results.data, 0, results.data_length);
+  return iree_ok_status();
+}
+
+IREE_API_EXPORT iree_status_t iree_vm_invocation_record_initialize(
+    iree_vm_context_t* context, iree_vm_function_t function,
+    iree_vm_invocation_flags_t flags, const iree_vm_invocation_policy_t* policy,
+    iree_allocator_t host_allocator, iree_vm_invocation_record_t* out_record) {
+  IREE_ASSERT_ARGUMENT(context);
+  IREE_ASSERT_ARGUMENT(out_record);
+  IREE_TRACE_ZONE_BEGIN(z0);
+  // NOTE: the invoke state is initialized on each invocation and is large enough
+  // that we avoid clearing it here.
+  memset(out_record, 0, offsetof(iree_vm_invocation_record_t, state));
+
+  iree_vm_function_signature_t signature =
+      iree_vm_function_signature(&function);
+  if (iree_vm_function_call_is_variadic_cconv(signature.calling_convention)) {
+    IREE_TRACE_ZONE_END(z0);
+    return iree_make_status(IREE_STATUS_UNIMPLEMENTED,
+                            "invocation records do not support variadic "
+                            "functions");
+  }
+  iree_string_view_t cconv_arguments = iree_string_view_empty();
+  iree_string_view_t cconv_results = iree_string_view_empty();
+  IREE_RETURN_AND_END_ZONE_IF_ERROR(
+      z0, iree_vm_function_call_get_cconv_fragments(
+              &signature, &cconv_arguments, &cconv_results));
+  iree_host_size_t arguments_size = 0;
+  IREE_RETURN_AND_END_ZONE_IF_ERROR(
+      z0, iree_vm_function_call_compute_cconv_fragment_size(
+              cconv_arguments, /*segment_size_list=*/NULL, &arguments_size));
+  iree_host_size_t results_size = 0;
+  IREE_RETURN_AND_END_ZONE_IF_ERROR(
+      z0, iree_vm_function_call_compute_cconv_fragment_size(
+              cconv_results, /*segment_size_list=*/NULL, &results_size));
+
+  // Arguments and results share a single allocation made once up front.
+  uint8_t* storage = NULL;
+  iree_host_size_t storage_size =
+      iree_host_align(arguments_size, iree_max_align_t) + results_size;
+  if (storage_size > 0) {
+    IREE_RETURN_AND_END_ZONE_IF_ERROR(
+        z0, iree_allocator_malloc(host_allocator, storage_size,
+                                  (void**)&storage));
+    memset(storage, 0, storage_size);
+  }
+
+  out_record->context = context;
+  iree_vm_context_retain(context);
+  out_record->function = function;
+  out_record->flags = flags;
+  out_record->policy = policy;
+  out_record->host_allocator = host_allocator;
+  out_record->cconv_arguments = cconv_arguments;
+  out_record->cconv_results = cconv_results;
+  out_record->arguments = iree_make_byte_span(storage, arguments_size);
+  out_record->results = iree_make_byte_span(
+      storage ? storage + iree_host_align(arguments_size, iree_max_align_t)
+              : NULL,
+      results_size);
+
+  IREE_TRACE_ZONE_END(z0);
+  return iree_ok_status();
+}
+
+IREE_API_EXPORT void iree_vm_invocation_record_deinitialize(
+    iree_vm_invocation_record_t* record) {
+  IREE_ASSERT_ARGUMENT(record);
+  IREE_TRACE_ZONE_BEGIN(z0);
+  iree_vm_invocation_record_visit_refs(record->cconv_arguments,
+                                       record->arguments, iree_vm_ref_release);
+  iree_vm_invocation_record_visit_refs(record->cconv_results, record->results,
+                                       iree_vm_ref_release);
+  iree_allocator_free(record->host_allocator, record->arguments.data);
+  iree_vm_context_release(record->context);
+  memset(record, 0, offsetof(iree_vm_invocation_record_t, state));
+  IREE_TRACE_ZONE_END(z0);
+}
+
+IREE_API_EXPORT iree_status_t iree_vm_invocation_record_bind_inputs(
+    iree_vm_invocation_record_t* record, const iree_vm_list_t* inputs) {
+  IREE_ASSERT_ARGUMENT(record);
+  iree_vm_invocation_record_visit_refs(record->cconv_arguments,
+                                       record->arguments, iree_vm_ref_release);
+  memset(record->arguments.data, 0, record->arguments.data_length);
+  iree_status_t status = iree_vm_invoke_marshal_inputs(
+      record->cconv_arguments, inputs, record->arguments);
+  if (!iree_status_is_ok(status)) {
+    iree_vm_invocation_record_visit_refs(
+        record->cconv_arguments, record->arguments, iree_vm_ref_release);
+    memset(record->arguments.data, 0, record->arguments.data_length);
+  }
+  return status;
+}
+
+IREE_API_EXPORT iree_status_t iree_vm_invocation_record_set_argument_value(
+    iree_vm_invocation_record_t* record, iree_host_size_t i,
+    const iree_vm_value_t* value) {
+  IREE_ASSERT_ARGUMENT(record);
+  IREE_ASSERT_ARGUMENT(value);
+  char type = 0;
+  uint8_t* p = NULL;
+  IREE_RETURN_IF_ERROR(iree_vm_invocation_record_lookup(
+      record->cconv_arguments, record->arguments, i, &type, &p));
+  switch (type) {
+    case IREE_VM_CCONV_TYPE_I32:
+      if (value->type != IREE_VM_VALUE_TYPE_I32) break;
+      memcpy(p, &value->i32, sizeof(int32_t));
+      return iree_ok_status();
+    case IREE_VM_CCONV_TYPE_I64:
+      if (value->type != IREE_VM_VALUE_TYPE_I64) break;
+      memcpy(p, &value->i64, sizeof(int64_t));
+      return iree_ok_status();
+    case IREE_VM_CCONV_TYPE_F32:
+      if (value->type != IREE_VM_VALUE_TYPE_F32) break;
+      memcpy(p, &value->f32, sizeof(float));
+      return iree_ok_status();
+    case IREE_VM_CCONV_TYPE_F64:
+      if (value->type != IREE_VM_VALUE_TYPE_F64) break;
+      memcpy(p, &value->f64, sizeof(double));
+      return iree_ok_status();
+    default:
+      break;
+  }
+  return iree_make_status(IREE_STATUS_INVALID_ARGUMENT,
+                          "argument %zu type mismatch; expected cconv '%c'", i,
+                          type);
+}
+
+IREE_API_EXPORT iree_status_t iree_vm_invocation_record_set_argument_ref_retain(
+    iree_vm_invocation_record_t* record, iree_host_size_t i,
+    const iree_vm_ref_t* value) {
+  IREE_ASSERT_ARGUMENT(record);
+  IREE_ASSERT_ARGUMENT(value);
+  char type = 0;
+  uint8_t* p = NULL;
+  IREE_RETURN_IF_ERROR(iree_vm_invocation_record_lookup(
+      record->cconv_arguments, record->arguments, i, &type, &p));
+  if (type != IREE_VM_CCONV_TYPE_REF) {
+    return iree_make_status(IREE_STATUS_INVALID_ARGUMENT,
+                            "argument %zu type mismatch; expected cconv '%c'",
+                            i, type);
+  }
+  iree_vm_ref_retain((iree_vm_ref_t*)value, (iree_vm_ref_t*)p);
+  return iree_ok_status();
+}
+
+IREE_API_EXPORT iree_status_t
+iree_vm_invocation_record_invoke(iree_vm_invocation_record_t* record) {
+  IREE_ASSERT_ARGUMENT(record);
+  // Drop results from the previous invocation; they are only valid until now.
+  iree_vm_invocation_record_visit_refs(record->cconv_results, record->results,
+                                       iree_vm_ref_release);
+  memset(record->results.data, 0, record->results.data_length);
+  return iree_vm_invoke_with_marshalers(
+      &record->state, record->context, record->function, record->flags,
+      record->policy, iree_vm_invocation_record_marshal_inputs, record,
+      iree_vm_invocation_record_marshal_outputs, record,
+      record->host_allocator);
+}
+
+IREE_API_EXPORT iree_status_t iree_vm_invocation_record_get_result_value(
+    const iree_vm_invocation_record_t* record, iree_host_size_t i,
+    iree_vm_value_t* out_value) {
+  IREE_ASSERT_ARGUMENT(record);
+  IREE_ASSERT_ARGUMENT(out_value);
+  char type = 0;
+  uint8_t* p = NULL;
+  IREE_RETURN_IF_ERROR(iree_vm_invocation_record_lookup(
+      record->cconv_results, record->results, i, &type, &p));
+  memset(out_value, 0, sizeof(*out_value));
+  switch (type) {
+    case IREE_VM_CCONV_TYPE_I32:
+      out_value->type = IREE_VM_VALUE_TYPE_I32;
+      memcpy(&out_value->i32, p, sizeof(int32_t));
+      return iree_ok_status();
+    case IREE_VM_CCONV_TYPE_I64:
+      out_value->type = IREE_VM_VALUE_TYPE_I64;
+      memcpy(&out_value->i64, p, sizeof(int64_t));
+      return iree_ok_status();
+    case IREE_VM_CCONV_TYPE_F32:
+      out_value->type = IREE_VM_VALUE_TYPE_F32;
+      memcpy(&out_value->f32, p, sizeof(float));
+      return iree_ok_status();
+    case IREE_VM_CCONV_TYPE_F64:
+      out_value->type = IREE_VM_VALUE_TYPE_F64;
+      memcpy(&out_value->f64, p, sizeof(double));
+      return iree_ok_status();
+    default:
+      return iree_make_status(IREE_STATUS_FAILED_PRECONDITION,
+                              "result %zu is not a value type", i);
+  }
+}
+
+IREE_API_EXPORT iree_status_t iree_vm_invocation_record_get_result_ref_retain(
+    const iree_vm_invocation_record_t* record, iree_host_size_t i,
+    iree_vm_ref_t* out_value) {
+  IREE_ASSERT_ARGUMENT(record);
+  IREE_ASSERT_ARGUMENT(out_value);
+  char type = 0;
+  uint8_t* p = NULL;
+  IREE_RETURN_IF_ERROR(iree_vm_invocation_record_lookup(
+      record->cconv_results, record->results, i, &type, &p));
+  if (type != IREE_VM_CCONV_TYPE_REF) {
+    return iree_make_status(IREE_STATUS_FAILED_PRECONDITION,
+                            "result %zu is not a ref type", i);
+  }
+  iree_vm_ref_retain((iree_vm_ref_t*)p, out_value);
+  return iree_ok_status();
+}
+
 //===----------------------------------------------------------------------===//
 // Loop-based asynchronous invocation
 //===----------------------------------------------------------------------===//
@@ -667,7 +1190,7 @@ IREE_API_EXPORT iree_status_t iree_vm_async_invoke(
     iree_loop_t loop, iree_vm_async_invoke_state_t* state,
     iree_vm_context_t* context, iree_vm_function_t function,
     iree_vm_invocation_flags_t flags, const iree_vm_invocation_policy_t* policy,
-    iree_vm_list_t* inputs, iree_vm_list_t* outputs,
+    iree_timeout_t timeout, iree_vm_list_t* inputs, iree_vm_list_t* outputs,
     iree_allocator_t host_allocator,
     iree_vm_async_invoke_callback_fn_t callback, void* user_data) {
   IREE_ASSERT_ARGUMENT(state);
@@ -682,7 +1205,7 @@ IREE_API_EXPORT iree_status_t iree_vm_async_invoke(
   state->begin_params.policy = policy;
   state->begin_params.inputs = inputs;
   iree_vm_list_retain(inputs);
-  state->deadline_ns = IREE_TIME_INFINITE_FUTURE;
+  state->deadline_ns = iree_timeout_as_deadline_ns(timeout);
   state->host_allocator = host_allocator;
   state->outputs = outputs;
   iree_vm_list_retain(outputs);
@@ -907,7 +1430,13 @@ static iree_status_t iree_vm_async_tick_invoke(
                                   iree_vm_async_wake_invoke, state);
     }
   } else {
-    // Resume from a yield point (cooperative scheduling).
+    // Resume from a yield point (cooperative scheduling). Invocations that
+    // have exceeded their deadline are not resumed and will be aborted.
+    if (IREE_UNLIKELY(state->deadline_ns != IREE_TIME_INFINITE_FUTURE &&
+                      iree_time_now() >= state->deadline_ns)) {
+      return iree_make_status(IREE_STATUS_DEADLINE_EXCEEDED,
+                              "invocation deadline elapsed while yielded");
+    }
     return iree_loop_call(loop, IREE_LOOP_PRIORITY_DEFAULT,
                           iree_vm_async_resume_invoke, state);
   }
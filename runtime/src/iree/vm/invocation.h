@@ -178,6 +178,99 @@ IREE_API_EXPORT iree_status_t iree_vm_end_invoke(iree_vm_invoke_state_t* state,
 // succeeded then iree_vm_end_invoke must be used instead.
 IREE_API_EXPORT void iree_vm_abort_invoke(iree_vm_invoke_state_t* state);
 
+//===----------------------------------------------------------------------===//
+// Reusable synchronous invocation
+//===----------------------------------------------------------------------===//
+
+// A pre-sized record for repeatedly invoking the same function.
+// Arguments are marshaled into the function calling convention once when bound
+// and results are left in calling convention layout for direct access, avoiding
+// the list marshaling performed by iree_vm_invoke. Once initialized
+// invocations perform no heap allocations unless the VM stack grows beyond its
+// inline storage.
+//
+// Usage:
+//   iree_vm_invocation_record_t* record = ...;  // ~IREE_VM_STACK_DEFAULT_SIZE
+//   iree_vm_invocation_record_initialize(context, function, ..., record);
+//   iree_vm_invocation_record_bind_inputs(record, inputs);
+//   for (...) {
+//     iree_vm_invocation_record_set_argument_value(record, 0, &value);
+//     status = iree_vm_invocation_record_invoke(record);
+//     iree_vm_invocation_record_get_result_value(record, 0, &result);
+//   }
+//   iree_vm_invocation_record_deinitialize(record);
+//
+// Thread-compatible: records may be used from any thread so long as calls are
+// not made concurrently.
+typedef struct iree_vm_invocation_record_t {
+  // Retains the context the invocation is running within.
+  iree_vm_context_t* context;
+  // Target function.
+  iree_vm_function_t function;
+  // Flags controlling invocation behavior.
+  iree_vm_invocation_flags_t flags;
+  // TBD.
+  const iree_vm_invocation_policy_t* policy;
+  // Allocator used for the record storage and any stack growth.
+  iree_allocator_t host_allocator;
+  // Parsed calling convention fragments of the target function.
+  iree_string_view_t cconv_arguments;
+  iree_string_view_t cconv_results;
+  // Bound arguments in calling convention layout. Refs are retained by the
+  // record and retained again for each invocation as the callee consumes them.
+  iree_byte_span_t arguments;
+  // Results of the last successful invocation in calling convention layout.
+  // Refs are owned by the record until the next invocation.
+  iree_byte_span_t results;
+  // Reused invocation state holding the inline VM stack storage.
+  iree_vm_invoke_state_t state;
+} iree_vm_invocation_record_t;
+
+// Initializes |out_record| for invoking |function| in |context|.
+// All arguments are initially zero/null. Variadic functions are not supported.
+// Must be deinitialized with iree_vm_invocation_record_deinitialize.
+IREE_API_EXPORT iree_status_t iree_vm_invocation_record_initialize(
+    iree_vm_context_t* context, iree_vm_function_t function,
+    iree_vm_invocation_flags_t flags, const iree_vm_invocation_policy_t* policy,
+    iree_allocator_t host_allocator, iree_vm_invocation_record_t* out_record);
+
+// Deinitializes |record| and releases all retained arguments and results.
+IREE_API_EXPORT void iree_vm_invocation_record_deinitialize(
+    iree_vm_invocation_record_t* record);
+
+// Binds all arguments from |inputs|, which must match the function signature.
+// List contents are captured and the caller can reuse it immediately.
+IREE_API_EXPORT iree_status_t iree_vm_invocation_record_bind_inputs(
+    iree_vm_invocation_record_t* record, const iree_vm_list_t* inputs);
+
+// Sets the primitive argument at |i|. The |value| type must match the type
+// declared by the function signature.
+IREE_API_EXPORT iree_status_t iree_vm_invocation_record_set_argument_value(
+    iree_vm_invocation_record_t* record, iree_host_size_t i,
+    const iree_vm_value_t* value);
+
+// Sets the ref argument at |i|, retaining a reference in the record.
+IREE_API_EXPORT iree_status_t iree_vm_invocation_record_set_argument_ref_retain(
+    iree_vm_invocation_record_t* record, iree_host_size_t i,
+    const iree_vm_ref_t* value);
+
+// Synchronously invokes the function with the bound arguments.
+// Results of any prior invocation are released first and upon success the new
+// results can be queried until the next invocation.
+IREE_API_EXPORT iree_status_t
+iree_vm_invocation_record_invoke(iree_vm_invocation_record_t* record);
+
+// Returns the primitive result at |i| from the last successful invocation.
+IREE_API_EXPORT iree_status_t iree_vm_invocation_record_get_result_value(
+    const iree_vm_invocation_record_t* record, iree_host_size_t i,
+    iree_vm_value_t* out_value);
+
+// Returns the ref result at |i| from the last successful invocation.
+// The ref will be retained and must be released by the caller.
+IREE_API_EXPORT iree_status_t iree_vm_invocation_record_get_result_ref_retain(
+    const iree_vm_invocation_record_t* record, iree_host_size_t i,
+    iree_vm_ref_t* out_value);
+
 //===----------------------------------------------------------------------===//
 // Loop-based asynchronous invocation
 //===----------------------------------------------------------------------===//
@@ -226,7 +319,10 @@ typedef struct iree_vm_async_invoke_state_t {
   // ID used for fiber tracing; either unique to the invocation or the context
   // based on the context concurrency mode.
   iree_vm_invocation_id_t invocation_id;
-  // TBD: deadline for when the invocation will be aborted.
+  // Absolute deadline bounding the entire invocation. Waits performed by the
+  // invocation are clamped to this deadline and fail with
+  // IREE_STATUS_DEADLINE_EXCEEDED when it elapses and the invocation is not
+  // resumed from yields after it has passed.
   iree_time_t deadline_ns;
   // Allocator used for transient allocations required during invocation.
   // If an arena it must remain valid for the duration of the invocation.
@@ -252,6 +348,13 @@ typedef struct iree_vm_async_invoke_state_t {
 // generally not be modified until the callback is issued. |outputs| will be
 // retained until the callback is made and must be released by the callback.
 //
+// |timeout| bounds the entire invocation across all of its waits and yields.
+// Waits requested by the program are clamped to the invocation deadline and
+// will receive IREE_STATUS_DEADLINE_EXCEEDED if it elapses first, allowing the
+// program to handle the failure. An invocation that yields for cooperative
+// scheduling after the deadline has elapsed is aborted and the callback will
+// receive IREE_STATUS_DEADLINE_EXCEEDED.
+//
 // The |callback| will receive |user_data| and is guaranteed to be called even
 // if the invocation fails due to an internal error. If the loop is aborted due
 // to a propagated scope failure the status passed to the callback will be
@@ -266,6 +369,7 @@ typedef struct iree_vm_async_invoke_state_t {
 //      loop,                  // loop to run in
 //      state,                 // state storage, must live until callback
 //      ...function...,        // target function
+//      timeout,               // bound on the total invocation time
 //      inputs, outputs, ...,  // input values and output storage (if needed)
 //      callback, state);      // user callback and user_data
 //  ...
@@ -286,7 +390,7 @@ IREE_API_EXPORT iree_status_t iree_vm_async_invoke(
     iree_loop_t loop, iree_vm_async_invoke_state_t* state,
     iree_vm_context_t* context, iree_vm_function_t function,
     iree_vm_invocation_flags_t flags, const iree_vm_invocation_policy_t* policy,
-    iree_vm_list_t* inputs, iree_vm_list_t* outputs,
+    iree_timeout_t timeout, iree_vm_list_t* inputs, iree_vm_list_t* outputs,
     iree_allocator_t host_allocator,
     iree_vm_async_invoke_callback_fn_t callback, void* user_data);
 
@@ -404,6 +404,69 @@ static void iree_vm_list_convert_value_type(
   }
 }
 
+// Loads a primitive value of |value_type| from |element_ptr|.
+static inline void iree_vm_list_load_value(const void* element_ptr,
+                                           iree_vm_value_type_t value_type,
+                                           iree_vm_value_t* out_value) {
+  out_value->type = value_type;
+  out_value->i64 = 0;
+#if defined(IREE_ENDIANNESS_LITTLE)
+  memcpy(out_value->value_storage, element_ptr,
+         iree_vm_value_type_size(value_type));
+#else
+  switch (iree_vm_value_type_size(value_type)) {
+    case 1:
+      out_value->i8 = *(const int8_t*)element_ptr;
+      break;
+    case 2:
+      out_value->i16 = *(const int16_t*)element_ptr;
+      break;
+    case 4:
+      out_value->i32 = *(const int32_t*)element_ptr;
+      break;
+    case 8:
+      out_value->i64 = *(const int64_t*)element_ptr;
+      break;
+  }
+#endif  // IREE_ENDIANNESS_LITTLE
+}
+
+// Stores the primitive |value| to |element_ptr| using the size of its type.
+static inline void iree_vm_list_store_value(const iree_vm_value_t* value,
+                                            void* element_ptr) {
+#if defined(IREE_ENDIANNESS_LITTLE)
+  memcpy(element_ptr, value->value_storage,
+         iree_vm_value_type_size(value->type));
+#else
+  switch (iree_vm_value_type_size(value->type)) {
+    case 1:
+      *(int8_t*)element_ptr = value->i8;
+      break;
+    case 2:
+      *(int16_t*)element_ptr = value->i16;
+      break;
+    case 4:
+      *(int32_t*)element_ptr = value->i32;
+      break;
+    case 8:
+      *(int64_t*)element_ptr = value->i64;
+      break;
+  }
+#endif  // IREE_ENDIANNESS_LITTLE
+}
+
+// Verifies that [offset, offset + count) is within the bounds of |list|.
+static iree_status_t iree_vm_list_check_range(const iree_vm_list_t* list,
+                                              iree_host_size_t offset,
+                                              iree_host_size_t count) {
+  if (offset > list->count || count > list->count - offset) {
+    return iree_make_status(IREE_STATUS_OUT_OF_RANGE,
+                            "range [%zu, %zu) out of bounds (%zu)", offset,
+                            offset + count, list->count);
+  }
+  return iree_ok_status();
+}
+
 IREE_API_EXPORT iree_status_t
 iree_vm_list_get_value(const iree_vm_list_t* list, iree_host_size_t i,
                        iree_vm_value_t* out_value) {
@@ -415,22 +478,8 @@ iree_vm_list_get_value(const iree_vm_list_t* list, iree_host_size_t i,
   memset(out_value, 0, sizeof(*out_value));
   switch (list->storage_mode) {
     case IREE_VM_LIST_STORAGE_MODE_VALUE: {
-      out_value->type = list->element_type.value_type;
-      // TODO(benvanik): #ifdef on LITTLE/BIG_ENDIAN and just memcpy.
-      switch (list->element_size) {
-        case 1:
-          out_value->i8 = *(int8_t*)element_ptr;
-          break;
-        case 2:
-          out_value->i16 = *(int16_t*)element_ptr;
-          break;
-        case 4:
-          out_value->i32 = *(int32_t*)element_ptr;
-          break;
-        case 8:
-          out_value->i64 = *(int64_t*)element_ptr;
-          break;
-      }
+      iree_vm_list_load_value((const void*)element_ptr,
+                              list->element_type.value_type, out_value);
       break;
     }
     case IREE_VM_LIST_STORAGE_MODE_VARIANT: {
@@ -462,22 +511,8 @@ IREE_API_EXPORT iree_status_t iree_vm_list_get_value_as(
   value.i64 = 0;
   switch (list->storage_mode) {
     case IREE_VM_LIST_STORAGE_MODE_VALUE: {
-      value.type = list->element_type.value_type;
-      // TODO(benvanik): #ifdef on LITTLE/BIG_ENDIAN and just memcpy.
-      switch (list->element_size) {
-        case 1:
-          value.i8 = *(int8_t*)element_ptr;
-          break;
-        case 2:
-          value.i16 = *(int16_t*)element_ptr;
-          break;
-        case 4:
-          value.i32 = *(int32_t*)element_ptr;
-          break;
-        case 8:
-          value.i64 = *(int64_t*)element_ptr;
-          break;
-      }
+      iree_vm_list_load_value((const void*)element_ptr,
+                              list->element_type.value_type, &value);
       break;
     }
     case IREE_VM_LIST_STORAGE_MODE_VARIANT: {
@@ -524,21 +559,7 @@ IREE_API_EXPORT iree_status_t iree_vm_list_set_value(
   uintptr_t element_ptr = (uintptr_t)list->storage + i * list->element_size;
   switch (list->storage_mode) {
     case IREE_VM_LIST_STORAGE_MODE_VALUE: {
-      // TODO(benvanik): #ifdef on LITTLE/BIG_ENDIAN and just memcpy.
-      switch (list->element_size) {
-        case 1:
-          *(int8_t*)element_ptr = converted_value.i8;
-          break;
-        case 2:
-          *(int16_t*)element_ptr = converted_value.i16;
-          break;
-        case 4:
-          *(int32_t*)element_ptr = converted_value.i32;
-          break;
-        case 8:
-          *(int64_t*)element_ptr = converted_value.i64;
-          break;
-      }
+      iree_vm_list_store_value(&converted_value, (void*)element_ptr);
       break;
     }
     case IREE_VM_LIST_STORAGE_MODE_VARIANT: {
@@ -566,6 +587,96 @@ iree_vm_list_push_value(iree_vm_list_t* list, const iree_vm_value_t* value) {
   return iree_vm_list_set_value(list, i, value);
 }
 
+IREE_API_EXPORT iree_status_t iree_vm_list_value_span(
+    iree_vm_list_t* list, iree_vm_value_type_t value_type,
+    iree_byte_span_t* out_span) {
+  *out_span = iree_make_byte_span(NULL, 0);
+  if (list->storage_mode != IREE_VM_LIST_STORAGE_MODE_VALUE ||
+      list->element_type.value_type != value_type) {
+    return iree_make_status(IREE_STATUS_FAILED_PRECONDITION,
+                            "list does not store values of type %d",
+                            (int)value_type);
+  }
+  *out_span =
+      iree_make_byte_span(list->storage, list->count * list->element_size);
+  return iree_ok_status();
+}
+
+IREE_API_EXPORT iree_status_t iree_vm_list_get_values(
+    const iree_vm_list_t* list, iree_host_size_t offset, iree_host_size_t count,
+    iree_vm_value_type_t value_type, void* out_values) {
+  IREE_RETURN_IF_ERROR(iree_vm_list_check_range(list, offset, count));
+  iree_host_size_t value_size = iree_vm_value_type_size(value_type);
+  if (value_size == 0) {
+    return iree_make_status(IREE_STATUS_INVALID_ARGUMENT,
+                            "invalid value type %d", (int)value_type);
+  }
+  if (list->storage_mode == IREE_VM_LIST_STORAGE_MODE_VALUE &&
+      list->element_type.value_type == value_type) {
+    // Fast path: storage matches the requested type exactly.
+    memcpy(out_values,
+           (const uint8_t*)list->storage + offset * list->element_size,
+           count * value_size);
+    return iree_ok_status();
+  }
+  uint8_t* out_ptr = (uint8_t*)out_values;
+  for (iree_host_size_t i = 0; i < count; ++i) {
+    iree_vm_value_t value;
+    IREE_RETURN_IF_ERROR(
+        iree_vm_list_get_value_as(list, offset + i, value_type, &value));
+    iree_vm_list_store_value(&value, out_ptr + i * value_size);
+  }
+  return iree_ok_status();
+}
+
+IREE_API_EXPORT iree_status_t iree_vm_list_set_values(
+    iree_vm_list_t* list, iree_host_size_t offset, iree_host_size_t count,
+    iree_vm_value_type_t value_type, const void* values) {
+  IREE_RETURN_IF_ERROR(iree_vm_list_check_range(list, offset, count));
+  iree_host_size_t value_size = iree_vm_value_type_size(value_type);
+  if (value_size == 0) {
+    return iree_make_status(IREE_STATUS_INVALID_ARGUMENT,
+                            "invalid value type %d", (int)value_type);
+  }
+  if (list->storage_mode == IREE_VM_LIST_STORAGE_MODE_VALUE &&
+      list->element_type.value_type == value_type) {
+    // Fast path: source matches the storage type exactly.
+    memcpy((uint8_t*)list->storage + offset * list->element_size, values,
+           count * value_size);
+    return iree_ok_status();
+  }
+  const uint8_t* values_ptr = (const uint8_t*)values;
+  for (iree_host_size_t i = 0; i < count; ++i) {
+    iree_vm_value_t value;
+    iree_vm_list_load_value(values_ptr + i * value_size, value_type, &value);
+    IREE_RETURN_IF_ERROR(iree_vm_list_set_value(list, offset + i, &value));
+  }
+  return iree_ok_status();
+}
+
+IREE_API_EXPORT iree_status_t iree_vm_list_append_span(
+    iree_vm_list_t* list, iree_vm_value_type_t value_type,
+    iree_const_byte_span_t values) {
+  iree_host_size_t value_size = iree_vm_value_type_size(value_type);
+  if (value_size == 0 || (values.data_length % value_size) != 0) {
+    return iree_make_status(IREE_STATUS_INVALID_ARGUMENT,
+                            "span of %zu bytes is not a whole number of "
+                            "values of type %d",
+                            values.data_length, (int)value_type);
+  }
+  iree_host_size_t offset = iree_vm_list_size(list);
+  iree_host_size_t count = values.data_length / value_size;
+  IREE_RETURN_IF_ERROR(iree_vm_list_resize(list, offset + count));
+  iree_status_t status =
+      iree_vm_list_set_values(list, offset, count, value_type, values.data);
+  if (!iree_status_is_ok(status)) {
+    // Drop the partially appended elements so the list is unchanged.
+    iree_vm_list_reset_range(list, offset, count);
+    list->count = offset;
+  }
+  return status;
+}
+
 IREE_API_EXPORT void* iree_vm_list_get_ref_deref(
     const iree_vm_list_t* list, iree_host_size_t i,
     const iree_vm_ref_type_descriptor_t* type_descriptor) {
@@ -686,6 +797,53 @@ IREE_API_EXPORT iree_status_t iree_vm_list_push_ref_move(iree_vm_list_t* list,
   return iree_vm_list_set_ref_move(list, i, value);
 }
 
+IREE_API_EXPORT iree_status_t iree_vm_list_get_refs_retain(
+    const iree_vm_list_t* list, iree_host_size_t offset, iree_host_size_t count,
+    iree_vm_ref_t* out_refs) {
+  IREE_RETURN_IF_ERROR(iree_vm_list_check_range(list, offset, count));
+  if (list->storage_mode == IREE_VM_LIST_STORAGE_MODE_REF) {
+    // Fast path: all elements are refs and no per-element variant decoding is
+    // required.
+    iree_vm_ref_t* ref_storage = (iree_vm_ref_t*)list->storage + offset;
+    for (iree_host_size_t i = 0; i < count; ++i) {
+      iree_vm_ref_retain(&ref_storage[i], &out_refs[i]);
+    }
+    return iree_ok_status();
+  }
+  for (iree_host_size_t i = 0; i < count; ++i) {
+    IREE_RETURN_IF_ERROR(
+        iree_vm_list_get_ref_retain(list, offset + i, &out_refs[i]));
+  }
+  return iree_ok_status();
+}
+
+IREE_API_EXPORT iree_status_t iree_vm_list_set_refs_retain(
+    iree_vm_list_t* list, iree_host_size_t offset, iree_host_size_t count,
+    const iree_vm_ref_t* refs) {
+  IREE_RETURN_IF_ERROR(iree_vm_list_check_range(list, offset, count));
+  if (list->storage_mode == IREE_VM_LIST_STORAGE_MODE_REF) {
+    // Fast path: the list holds a single ref type so we can verify all types
+    // up front (making no changes on failure) and then just retain.
+    iree_vm_ref_type_t ref_type = list->element_type.ref_type;
+    for (iree_host_size_t i = 0; i < count; ++i) {
+      if (refs[i].type != IREE_VM_REF_TYPE_NULL && refs[i].type != ref_type) {
+        return iree_make_status(IREE_STATUS_INVALID_ARGUMENT,
+                                "source ref type mismatch at index %zu", i);
+      }
+    }
+    iree_vm_ref_t* ref_storage = (iree_vm_ref_t*)list->storage + offset;
+    for (iree_host_size_t i = 0; i < count; ++i) {
+      iree_vm_ref_retain((iree_vm_ref_t*)&refs[i], &ref_storage[i]);
+    }
+    return iree_ok_status();
+  }
+  for (iree_host_size_t i = 0; i < count; ++i) {
+    IREE_RETURN_IF_ERROR(
+        iree_vm_list_set_ref_retain(list, offset + i, &refs[i]));
+  }
+  return iree_ok_status();
+}
+
 IREE_API_EXPORT iree_status_t iree_vm_list_pop_front_ref_move(
     iree_vm_list_t* list, iree_vm_ref_t* out_value) {
   iree_host_size_t list_size = iree_vm_list_size(list);
@@ -130,6 +130,34 @@ IREE_API_EXPORT iree_status_t iree_vm_list_set_value(
 IREE_API_EXPORT iree_status_t
 iree_vm_list_push_value(iree_vm_list_t* list, const iree_vm_value_t* value);
 
+// Returns a mutable view of the dense storage of a value list.
+// The list must store primitive values of exactly |value_type| and the
+// returned span covers all iree_vm_list_size elements. The view is invalidated
+// by any operation that changes the list size or capacity.
+IREE_API_EXPORT iree_status_t iree_vm_list_value_span(
+    iree_vm_list_t* list, iree_vm_value_type_t value_type,
+    iree_byte_span_t* out_span);
+
+// Copies |count| elements starting at |offset| into the dense |out_values|
+// array of |value_type| primitives. Elements will be converted using the value
+// type semantics if the list storage type differs.
+IREE_API_EXPORT iree_status_t iree_vm_list_get_values(
+    const iree_vm_list_t* list, iree_host_size_t offset, iree_host_size_t count,
+    iree_vm_value_type_t value_type, void* out_values);
+
+// Sets |count| elements starting at |offset| from the dense |values| array of
+// |value_type| primitives. Elements will be converted using the value type
+// semantics if the list storage type differs.
+IREE_API_EXPORT iree_status_t iree_vm_list_set_values(
+    iree_vm_list_t* list, iree_host_size_t offset, iree_host_size_t count,
+    iree_vm_value_type_t value_type, const void* values);
+
+// Appends the dense |values| array of |value_type| primitives to the end of
+// the list. The list is left unchanged on failure.
+IREE_API_EXPORT iree_status_t iree_vm_list_append_span(
+    iree_vm_list_t* list, iree_vm_value_type_t value_type,
+    iree_const_byte_span_t values);
+
 // Returns a dereferenced pointer to the given type if the element at the given
 // index matches the type. Returns NULL on error.
 IREE_API_EXPORT void* iree_vm_list_get_ref_deref(
@@ -168,6 +196,19 @@ IREE_API_EXPORT iree_status_t iree_vm_list_set_ref_move(iree_vm_list_t* list,
 IREE_API_EXPORT iree_status_t iree_vm_list_push_ref_move(iree_vm_list_t* list,
                                                          iree_vm_ref_t* value);
 
+// Retains |count| ref elements starting at |offset| into |out_refs|.
+// Any existing refs in |out_refs| will be released.
+IREE_API_EXPORT iree_status_t iree_vm_list_get_refs_retain(
+    const iree_vm_list_t* list, iree_host_size_t offset, iree_host_size_t count,
+    iree_vm_ref_t* out_refs);
+
+// Sets |count| ref elements starting at |offset| from |refs|, retaining a
+// reference to each in the list. Lists of a single ref type are validated
+// before any element is changed.
+IREE_API_EXPORT iree_status_t iree_vm_list_set_refs_retain(
+    iree_vm_list_t* list, iree_host_size_t offset, iree_host_size_t count,
+    const iree_vm_ref_t* refs);
+
 // Pops the front ref value from the list and transfers ownership to the caller.
 IREE_API_EXPORT iree_status_t
 iree_vm_list_pop_front_ref_move(iree_vm_list_t* list, iree_vm_ref_t* out_value);
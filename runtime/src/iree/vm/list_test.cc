@@ -647,6 +647,101 @@ TEST_F(VMListTest, PushPopRef) {
   iree_vm_list_release(list);
 }
 
+// Tests bulk value get/set with and without type conversion.
+TEST_F(VMListTest, BulkValues) {
+  iree_vm_type_def_t element_type =
+      iree_vm_type_def_make_value_type(IREE_VM_VALUE_TYPE_I32);
+  iree_vm_list_t* list = nullptr;
+  IREE_ASSERT_OK(
+      iree_vm_list_create(&element_type, 0, iree_allocator_system(), &list));
+
+  const int32_t values[5] = {0, 1, -2, 3, -4};
+  IREE_ASSERT_OK(iree_vm_list_append_span(
+      list, IREE_VM_VALUE_TYPE_I32,
+      iree_make_const_byte_span(values, sizeof(values))));
+  EXPECT_EQ(5, iree_vm_list_size(list));
+
+  // Direct access to the storage.
+  iree_byte_span_t span;
+  IREE_ASSERT_OK(iree_vm_list_value_span(list, IREE_VM_VALUE_TYPE_I32, &span));
+  ASSERT_EQ(sizeof(values), span.data_length);
+  EXPECT_EQ(0, memcmp(values, span.data, sizeof(values)));
+  EXPECT_THAT(
+      Status(iree_vm_list_value_span(list, IREE_VM_VALUE_TYPE_I64, &span)),
+      StatusIs(iree::StatusCode::kFailedPrecondition));
+
+  // Same-typed reads are a straight copy.
+  int32_t i32_values[3] = {0};
+  IREE_ASSERT_OK(
+      iree_vm_list_get_values(list, 2, 3, IREE_VM_VALUE_TYPE_I32, i32_values));
+  EXPECT_EQ(-2, i32_values[0]);
+  EXPECT_EQ(3, i32_values[1]);
+  EXPECT_EQ(-4, i32_values[2]);
+
+  // Converted reads sign extend.
+  int64_t i64_values[5] = {0};
+  IREE_ASSERT_OK(
+      iree_vm_list_get_values(list, 0, 5, IREE_VM_VALUE_TYPE_I64, i64_values));
+  for (iree_host_size_t i = 0; i < 5; ++i) {
+    EXPECT_EQ(values[i], i64_values[i]);
+  }
+
+  // Converted writes truncate into the storage type.
+  const int64_t new_values[2] = {10, -11};
+  IREE_ASSERT_OK(
+      iree_vm_list_set_values(list, 1, 2, IREE_VM_VALUE_TYPE_I64, new_values));
+  iree_vm_value_t value;
+  IREE_ASSERT_OK(
+      iree_vm_list_get_value_as(list, 2, IREE_VM_VALUE_TYPE_I32, &value));
+  EXPECT_EQ(-11, value.i32);
+
+  EXPECT_THAT(Status(iree_vm_list_get_values(list, 4, 2, IREE_VM_VALUE_TYPE_I32,
+                                             i32_values)),
+              StatusIs(iree::StatusCode::kOutOfRange));
+
+  iree_vm_list_release(list);
+}
+
+// Tests bulk ref get/set on a single-typed ref list.
+TEST_F(VMListTest, BulkRefs) {
+  iree_vm_type_def_t element_type =
+      iree_vm_type_def_make_ref_type(test_a_type_id());
+  iree_vm_list_t* list = nullptr;
+  IREE_ASSERT_OK(
+      iree_vm_list_create(&element_type, 0, iree_allocator_system(), &list));
+  IREE_ASSERT_OK(iree_vm_list_resize(list, 4));
+
+  iree_vm_ref_t refs[4] = {{0}};
+  for (iree_host_size_t i = 0; i < 4; ++i) {
+    refs[i] = MakeRef<A>((float)i);
+  }
+  IREE_ASSERT_OK(iree_vm_list_set_refs_retain(list, 0, 4, refs));
+  for (iree_host_size_t i = 0; i < 4; ++i) {
+    iree_vm_ref_release(&refs[i]);
+  }
+
+  iree_vm_ref_t out_refs[2] = {{0}};
+  IREE_ASSERT_OK(iree_vm_list_get_refs_retain(list, 1, 2, out_refs));
+  for (iree_host_size_t i = 0; i < 2; ++i) {
+    EXPECT_TRUE(test_a_isa(out_refs[i]));
+    EXPECT_EQ(i + 1, test_a_deref(out_refs[i])->data());
+    iree_vm_ref_release(&out_refs[i]);
+  }
+
+  // Mismatched types are rejected without modifying the list.
+  iree_vm_ref_t mixed_refs[2] = {MakeRef<A>(10.0f), MakeRef<B>(11)};
+  EXPECT_THAT(Status(iree_vm_list_set_refs_retain(list, 0, 2, mixed_refs)),
+              StatusIs(iree::StatusCode::kInvalidArgument));
+  iree_vm_ref_t ref_a{0};
+  IREE_ASSERT_OK(iree_vm_list_get_ref_retain(list, 0, &ref_a));
+  EXPECT_EQ(0, test_a_deref(ref_a)->data());
+  iree_vm_ref_release(&ref_a);
+  iree_vm_ref_release(&mixed_refs[0]);
+  iree_vm_ref_release(&mixed_refs[1]);
+
+  iree_vm_list_release(list);
+}
+
 // TODO(benvanik): test primitive variant get/set.
 
 // TODO(benvanik): test ref variant get/set.
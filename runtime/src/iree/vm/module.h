@@ -415,6 +415,18 @@ typedef struct iree_vm_module_t {
   void(IREE_API_PTR* free_state)(void* self,
                                  iree_vm_module_state_t* module_state);
 
+  // Optional: allocates module state data as a copy of an initialized
+  // |parent_state|. The new state must be immediately usable without running
+  // module initializers and must not alias any mutable storage of the parent
+  // such that changes to either state are not observed by the other. Resolved
+  // imports are carried over from the parent. Released with free_state.
+  //
+  // Modules that do not implement forking have their parent state shared by
+  // forked contexts (see iree_vm_context_fork).
+  iree_status_t(IREE_API_PTR* fork_state)(
+      void* self, iree_vm_module_state_t* parent_state,
+      iree_allocator_t allocator, iree_vm_module_state_t** out_module_state);
+
   // Resolves the import with the given ordinal to |function|.
   // The function is guaranteed to remain valid for the lifetime of the module
   // state.
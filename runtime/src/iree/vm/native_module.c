@@ -219,9 +219,21 @@ static iree_status_t IREE_API_PTR iree_vm_native_module_get_function_attr(
     return module->user_interface.get_function_attr(module->self, linkage,
                                                     ordinal, index, out_attr);
   }
-  // TODO(benvanik): implement native module reflection.
-  return iree_make_status(IREE_STATUS_UNIMPLEMENTED,
-                          "reflection not yet implemented");
+  if (linkage != IREE_VM_FUNCTION_LINKAGE_EXPORT) {
+    return iree_make_status(IREE_STATUS_INVALID_ARGUMENT,
+                            "only exported functions can be queried");
+  } else if (IREE_UNLIKELY(ordinal >= module->descriptor->export_count)) {
+    return iree_make_status(IREE_STATUS_INVALID_ARGUMENT,
+                            "export ordinal out of range (0 < %zu < %zu)",
+                            ordinal, module->descriptor->export_count);
+  }
+  const iree_vm_native_export_descriptor_t* export_descriptor =
+      &module->descriptor->exports[ordinal];
+  if (index >= export_descriptor->attr_count) {
+    return iree_status_from_code(IREE_STATUS_OUT_OF_RANGE);
+  }
+  *out_attr = export_descriptor->attrs[index];
+  return iree_ok_status();
 }
 
 static iree_status_t IREE_API_PTR iree_vm_native_module_lookup_function(
@@ -288,6 +300,15 @@ static void IREE_API_PTR iree_vm_native_module_free_state(
   IREE_ASSERT_EQ(module_state, NULL);
 }
 
+static iree_status_t IREE_API_PTR iree_vm_native_module_fork_state(
+    void* self, iree_vm_module_state_t* parent_state,
+    iree_allocator_t allocator, iree_vm_module_state_t** out_module_state) {
+  iree_vm_native_module_t* module = (iree_vm_native_module_t*)self;
+  *out_module_state = NULL;
+  return module->user_interface.fork_state(module->self, parent_state,
+                                           allocator, out_module_state);
+}
+
 static iree_status_t IREE_API_PTR iree_vm_native_module_resolve_import(
     void* self, iree_vm_module_state_t* module_state, iree_host_size_t ordinal,
     const iree_vm_function_t* function,
@@ -503,6 +524,10 @@ IREE_API_EXPORT iree_status_t iree_vm_native_module_initialize(
       iree_vm_native_module_get_function_attr;
   module->base_interface.alloc_state = iree_vm_native_module_alloc_state;
   module->base_interface.free_state = iree_vm_native_module_free_state;
+  // Only forkable if the user module is; otherwise state is shared.
+  if (module->user_interface.fork_state) {
+    module->base_interface.fork_state = iree_vm_native_module_fork_state;
+  }
   module->base_interface.resolve_import = iree_vm_native_module_resolve_import;
   module->base_interface.notify = iree_vm_native_module_notify;
   module->base_interface.begin_call = iree_vm_native_module_begin_call;
@@ -36,6 +36,8 @@ namespace vm {
 // std::tuple, and std::span to match fixed-length arrays of the same type,
 // tuples of mixed types, or dynamic arrays (variadic arguments). Results may be
 // returned as either their type or an std::tuple/std::array of types.
+// Functions taking only primitive arguments are called with values loaded
+// directly from the ABI argument buffer without intermediate storage.
 //
 // Usage:
 //   // Per-context module state that must only be thread-compatible.
@@ -85,7 +87,7 @@ class NativeModule {
         NativeModule::ModuleEnumerateDependencies;
     interface_.lookup_function = NativeModule::ModuleLookupFunction;
     interface_.get_function = NativeModule::ModuleGetFunction;
-    // TODO(benvanik): get_function_attr
+    interface_.get_function_attr = NativeModule::ModuleGetFunctionAttr;
     interface_.alloc_state = NativeModule::ModuleAllocState;
     interface_.free_state = NativeModule::ModuleFreeState;
     interface_.resolve_import = NativeModule::ModuleResolveImport;
@@ -168,7 +170,7 @@ class NativeModule {
       std::memset(out_signature, 0, sizeof(*out_signature));
     }
     auto* module = FromModulePointer(self);
-    if (IREE_UNLIKELY(ordinal > module->dispatch_table_.size())) {
+    if (IREE_UNLIKELY(ordinal >= module->dispatch_table_.size())) {
       return iree_make_status(IREE_STATUS_INVALID_ARGUMENT,
                               "function out of bounds: 0 < %zu < %zu", ordinal,
                               module->dispatch_table_.size());
@@ -188,6 +190,26 @@ class NativeModule {
     return iree_ok_status();
   }
 
+  static iree_status_t ModuleGetFunctionAttr(
+      void* self, iree_vm_function_linkage_t linkage, iree_host_size_t ordinal,
+      iree_host_size_t index, iree_string_pair_t* out_attr) {
+    auto* module = FromModulePointer(self);
+    if (IREE_UNLIKELY(linkage != IREE_VM_FUNCTION_LINKAGE_EXPORT)) {
+      return iree_make_status(IREE_STATUS_INVALID_ARGUMENT,
+                              "only exported functions can be queried");
+    } else if (IREE_UNLIKELY(ordinal >= module->dispatch_table_.size())) {
+      return iree_make_status(IREE_STATUS_INVALID_ARGUMENT,
+                              "function out of bounds: 0 < %zu < %zu", ordinal,
+                              module->dispatch_table_.size());
+    }
+    const auto& dispatch_function = module->dispatch_table_[ordinal];
+    if (index >= dispatch_function.attr_count) {
+      return iree_status_from_code(IREE_STATUS_OUT_OF_RANGE);
+    }
+    *out_attr = dispatch_function.attrs[index];
+    return iree_ok_status();
+  }
+
   static iree_status_t ModuleLookupFunction(void* self,
                                             iree_vm_function_linkage_t linkage,
                                             iree_string_view_t name,
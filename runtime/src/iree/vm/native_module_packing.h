@@ -7,6 +7,7 @@
 #ifndef IREE_VM_MODULE_ABI_PACKING_H_
 #define IREE_VM_MODULE_ABI_PACKING_H_
 
+#include <cstring>
 #include <memory>
 #include <tuple>
 #include <utility>
@@ -14,6 +15,7 @@
 
 #include "iree/base/api.h"
 #include "iree/base/internal/span.h"
+#include "iree/vm/buffer.h"
 #include "iree/vm/module.h"
 #include "iree/vm/ref.h"
 #include "iree/vm/stack.h"
@@ -383,7 +385,7 @@ struct ParamUnpack<ref<T>> {
     auto* reg_ptr = reinterpret_cast<iree_vm_ref_t*>(ptr);
     ptr += sizeof(iree_vm_ref_t);
     if (reg_ptr->type == ref_type_descriptor<T>::get()->type) {
-      out_param = vm::retain_ref(reinterpret_cast<T*>(reg_ptr->ptr));
+      out_param = vm::assign_ref(reinterpret_cast<T*>(reg_ptr->ptr));
       memset(reg_ptr, 0, sizeof(*reg_ptr));
     } else if (IREE_UNLIKELY(reg_ptr->type != IREE_VM_REF_TYPE_NULL)) {
       status =
@@ -408,7 +410,7 @@ struct ParamUnpack<const ref<T>> {
     auto* reg_ptr = reinterpret_cast<iree_vm_ref_t*>(ptr);
     ptr += sizeof(iree_vm_ref_t);
     if (reg_ptr->type == ref_type_descriptor<T>::get()->type) {
-      out_param = vm::retain_ref(reinterpret_cast<T*>(reg_ptr->ptr));
+      out_param = vm::assign_ref(reinterpret_cast<T*>(reg_ptr->ptr));
       memset(reg_ptr, 0, sizeof(*reg_ptr));
     } else if (IREE_UNLIKELY(reg_ptr->type != IREE_VM_REF_TYPE_NULL)) {
       status =
@@ -609,6 +611,75 @@ struct ResultPack<std::tuple<Ts...>> {
 
 }  // namespace impl
 
+//===----------------------------------------------------------------------===//
+// Packed primitive arguments
+//===----------------------------------------------------------------------===//
+// Functions taking only primitive arguments have a fixed argument buffer
+// layout known at compile time. Instead of unpacking into intermediate storage
+// the arguments are loaded from their static offsets and passed directly to the
+// target function.
+
+namespace impl {
+
+template <typename... Ts>
+struct all_primitive;
+template <>
+struct all_primitive<> : std::true_type {};
+template <typename T, typename... Ts>
+struct all_primitive<T, Ts...>
+    : std::integral_constant<
+          bool,
+          (std::is_arithmetic<typename remove_cvref<T>::type>::value ||
+           std::is_enum<typename remove_cvref<T>::type>::value) &&
+              all_primitive<Ts...>::value> {};
+
+// Total size in bytes of the packed primitive types Ts.
+template <typename... Ts>
+struct packed_size;
+template <>
+struct packed_size<> {
+  static constexpr size_t value = 0;
+};
+template <typename T, typename... Ts>
+struct packed_size<T, Ts...> {
+  static constexpr size_t value =
+      sizeof(typename remove_cvref<T>::type) + packed_size<Ts...>::value;
+};
+
+// Byte offset of the I-th packed primitive type in Ts.
+template <size_t I, typename... Ts>
+struct packed_offset;
+template <typename T, typename... Ts>
+struct packed_offset<0, T, Ts...> {
+  static constexpr size_t value = 0;
+};
+template <size_t I, typename T, typename... Ts>
+struct packed_offset<I, T, Ts...> {
+  static constexpr size_t value = sizeof(typename remove_cvref<T>::type) +
+                                  packed_offset<I - 1, Ts...>::value;
+};
+
+// Loads a primitive from a possibly unaligned argument buffer location.
+template <typename T>
+static inline T LoadPacked(const uint8_t* ptr) {
+  T value;
+  std::memcpy(&value, ptr, sizeof(value));
+  return value;
+}
+
+template <typename... Ts>
+static inline Status VerifyPackedArguments(iree_byte_span_t storage) {
+  if (IREE_UNLIKELY(storage.data_length != packed_size<Ts...>::value)) {
+    return iree_make_status(
+        IREE_STATUS_INVALID_ARGUMENT,
+        "argument buffer unpacking failure; expected %zu bytes but have %zu",
+        packed_size<Ts...>::value, storage.data_length);
+  }
+  return OkStatus();
+}
+
+}  // namespace impl
+
 //===----------------------------------------------------------------------===//
 // Function wrapping
 //===----------------------------------------------------------------------===//
@@ -619,15 +690,12 @@ struct DispatchFunctor {
 
   static Status Call(void (Owner::*ptr)(), Owner* self, iree_vm_stack_t* stack,
                      iree_vm_function_call_t call) {
-    // Marshal arguments into types/locals we can forward to the function.
-    IREE_ASSIGN_OR_RETURN(
-        auto params, impl::Unpacker::LoadSequence<Params...>(call.arguments));
-
     // Call the target function with the params.
     IREE_ASSIGN_OR_RETURN(
         auto results,
-        ApplyFn(reinterpret_cast<FnPtr>(ptr), self, std::move(params),
-                std::make_index_sequence<sizeof...(Params)>()));
+        Apply(reinterpret_cast<FnPtr>(ptr), self, call.arguments,
+              std::integral_constant<bool,
+                                     impl::all_primitive<Params...>::value>()));
 
     // Marshal call results back into the ABI results buffer.
     impl::result_ptr_t result_ptr = call.results.data;
@@ -636,11 +704,38 @@ struct DispatchFunctor {
     return OkStatus();
   }
 
+ private:
+  // Marshals arguments into types/locals we can forward to the function.
+  static StatusOr<Results> Apply(FnPtr ptr, Owner* self,
+                                 iree_byte_span_t arguments, std::false_type) {
+    IREE_ASSIGN_OR_RETURN(auto params,
+                          impl::Unpacker::LoadSequence<Params...>(arguments));
+    return ApplyFn(ptr, self, std::move(params),
+                   std::make_index_sequence<sizeof...(Params)>());
+  }
+
+  // Loads primitive arguments directly from the argument buffer.
+  static StatusOr<Results> Apply(FnPtr ptr, Owner* self,
+                                 iree_byte_span_t arguments, std::true_type) {
+    IREE_RETURN_IF_ERROR(impl::VerifyPackedArguments<Params...>(arguments));
+    return ApplyPackedFn(ptr, self, arguments.data,
+                         std::make_index_sequence<sizeof...(Params)>());
+  }
+
   template <typename T, size_t... I>
   static StatusOr<Results> ApplyFn(FnPtr ptr, Owner* self, T&& params,
                                    std::index_sequence<I...>) {
     return (self->*ptr)(std::move(std::get<I>(params))...);
   }
+
+  template <size_t... I>
+  static StatusOr<Results> ApplyPackedFn(FnPtr ptr, Owner* self,
+                                         const uint8_t* arguments,
+                                         std::index_sequence<I...>) {
+    return (self->*ptr)(
+        impl::LoadPacked<typename impl::remove_cvref<Params>::type>(
+            arguments + impl::packed_offset<I, Params...>::value)...);
+  }
 };
 
 // A DispatchFunctor specialization for methods with no return values.
@@ -650,17 +745,40 @@ struct DispatchFunctorVoid {
 
   static Status Call(void (Owner::*ptr)(), Owner* self, iree_vm_stack_t* stack,
                      iree_vm_function_call_t call) {
-    IREE_ASSIGN_OR_RETURN(
-        auto params, impl::Unpacker::LoadSequence<Params...>(call.arguments));
-    return ApplyFn(reinterpret_cast<FnPtr>(ptr), self, std::move(params),
+    return Apply(
+        reinterpret_cast<FnPtr>(ptr), self, call.arguments,
+        std::integral_constant<bool, impl::all_primitive<Params...>::value>());
+  }
+
+ private:
+  static Status Apply(FnPtr ptr, Owner* self, iree_byte_span_t arguments,
+                      std::false_type) {
+    IREE_ASSIGN_OR_RETURN(auto params,
+                          impl::Unpacker::LoadSequence<Params...>(arguments));
+    return ApplyFn(ptr, self, std::move(params),
                    std::make_index_sequence<sizeof...(Params)>());
   }
 
+  static Status Apply(FnPtr ptr, Owner* self, iree_byte_span_t arguments,
+                      std::true_type) {
+    IREE_RETURN_IF_ERROR(impl::VerifyPackedArguments<Params...>(arguments));
+    return ApplyPackedFn(ptr, self, arguments.data,
+                         std::make_index_sequence<sizeof...(Params)>());
+  }
+
   template <typename T, size_t... I>
   static Status ApplyFn(FnPtr ptr, Owner* self, T&& params,
                         std::index_sequence<I...>) {
     return (self->*ptr)(std::move(std::get<I>(params))...);
   }
+
+  template <size_t... I>
+  static Status ApplyPackedFn(FnPtr ptr, Owner* self, const uint8_t* arguments,
+                              std::index_sequence<I...>) {
+    return (self->*ptr)(
+        impl::LoadPacked<typename impl::remove_cvref<Params>::type>(
+            arguments + impl::packed_offset<I, Params...>::value)...);
+  }
 };
 
 }  // namespace packing
@@ -672,6 +790,9 @@ struct NativeFunction {
   void (Owner::*const ptr)();
   Status (*const call)(void (Owner::*ptr)(), Owner* self,
                        iree_vm_stack_t* stack, iree_vm_function_call_t call);
+  // An optional list of function-level reflection attributes.
+  iree_host_size_t attr_count;
+  const iree_string_pair_t* attrs;
 };
 
 template <typename Owner, typename Result, typename... Params>
@@ -680,7 +801,10 @@ constexpr NativeFunction<Owner> MakeNativeFunction(
   using dispatch_functor_t = packing::DispatchFunctor<Owner, Result, Params...>;
   return {iree_make_cstring_view(name),
           packing::cconv_storage<Result, sizeof...(Params), Params...>::value(),
-          (void (Owner::*)())fn, &dispatch_functor_t::Call};
+          (void (Owner::*)())fn,
+          &dispatch_functor_t::Call,
+          0,
+          nullptr};
 }
 
 template <typename Owner, typename... Params>
@@ -689,7 +813,51 @@ constexpr NativeFunction<Owner> MakeNativeFunction(
   using dispatch_functor_t = packing::DispatchFunctorVoid<Owner, Params...>;
   return {iree_make_cstring_view(name),
           packing::cconv_storage_void<sizeof...(Params), Params...>::value(),
-          (void (Owner::*)())fn, &dispatch_functor_t::Call};
+          (void (Owner::*)())fn,
+          &dispatch_functor_t::Call,
+          0,
+          nullptr};
+}
+
+// Makes a native function with reflection attributes. |attrs| must remain live
+// for the lifetime of the module.
+//
+// Example:
+//  static const iree_string_pair_t kMyMethodAttrs[] = {
+//    {iree_make_cstring_view("key"), iree_make_cstring_view("value")},
+//  };
+//  vm::MakeNativeFunction("my_method", &MyState::MyMethod, kMyMethodAttrs);
+// Makes a native function with reflection attributes. |attrs| must remain live
+// for the lifetime of the module.
+//
+// Example:
+//  static const iree_string_pair_t kMyMethodAttrs[] = {
+//    {iree_make_cstring_view("key"), iree_make_cstring_view("value")},
+//  };
+//  vm::MakeNativeFunction("my_method", &MyState::MyMethod, kMyMethodAttrs);
+template <typename Owner, typename Result, typename... Params, size_t N>
+constexpr NativeFunction<Owner> MakeNativeFunction(
+    const char* name, StatusOr<Result> (Owner::*fn)(Params...),
+    const iree_string_pair_t (&attrs)[N]) {
+  using dispatch_functor_t = packing::DispatchFunctor<Owner, Result, Params...>;
+  return {iree_make_cstring_view(name),
+          packing::cconv_storage<Result, sizeof...(Params), Params...>::value(),
+          (void (Owner::*)())fn,
+          &dispatch_functor_t::Call,
+          N,
+          attrs};
+}
+template <typename Owner, typename... Params, size_t N>
+constexpr NativeFunction<Owner> MakeNativeFunction(
+    const char* name, Status (Owner::*fn)(Params...),
+    const iree_string_pair_t (&attrs)[N]) {
+  using dispatch_functor_t = packing::DispatchFunctorVoid<Owner, Params...>;
+  return {iree_make_cstring_view(name),
+          packing::cconv_storage_void<sizeof...(Params), Params...>::value(),
+          (void (Owner::*)())fn,
+          &dispatch_functor_t::Call,
+          N,
+          attrs};
 }
 
 }  // namespace vm
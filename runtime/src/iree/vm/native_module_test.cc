@@ -6,15 +6,18 @@
 
 #include "iree/vm/native_module_test.h"
 
+#include <memory>
 #include <vector>
 
 #include "iree/base/api.h"
+#include "iree/base/loop_inline.h"
 #include "iree/testing/gtest.h"
 #include "iree/testing/status_matchers.h"
 #include "iree/vm/context.h"
 #include "iree/vm/instance.h"
 #include "iree/vm/invocation.h"
 #include "iree/vm/list.h"
+#include "iree/vm/native_module_cc.h"
 #include "iree/vm/ref.h"
 #include "iree/vm/value.h"
 
@@ -57,13 +60,16 @@ class VMNativeModuleTest : public ::testing::Test {
   }
 
   StatusOr<int32_t> RunFunction(iree_string_view_t function_name,
-                                int32_t arg0) {
+                                int32_t arg0,
+                                iree_vm_context_t* context = nullptr) {
+    if (!context) context = context_;
+
     // Lookup the entry function. This can be cached in an application if
     // multiple calls will be made.
     iree_vm_function_t function;
     IREE_RETURN_IF_ERROR(
         iree_vm_context_resolve_function(
-            context_, iree_make_cstring_view("module_b.entry"), &function),
+            context, iree_make_cstring_view("module_b.entry"), &function),
         "unable to resolve entry point");
 
     // Setup I/O lists and pass in the argument. The result list will be
@@ -80,7 +86,7 @@ class VMNativeModuleTest : public ::testing::Test {
 
     // Invoke the entry function to do our work. Runs synchronously.
     IREE_RETURN_IF_ERROR(
-        iree_vm_invoke(context_, function, IREE_VM_INVOCATION_FLAG_NONE,
+        iree_vm_invoke(context, function, IREE_VM_INVOCATION_FLAG_NONE,
                        /*policy=*/nullptr, input_list.get(), output_list.get(),
                        iree_allocator_system()));
 
@@ -91,7 +97,61 @@ class VMNativeModuleTest : public ::testing::Test {
     return ret0_value.i32;
   }
 
- private:
+  // Runs |function_name| with iree_vm_async_invoke on an inline loop bounded
+  // by |timeout|.
+  StatusOr<int32_t> AsyncRunFunction(iree_string_view_t function_name,
+                                     int32_t arg0, iree_timeout_t timeout) {
+    iree_vm_function_t function;
+    IREE_RETURN_IF_ERROR(
+        iree_vm_context_resolve_function(context_, function_name, &function),
+        "unable to resolve entry point");
+
+    vm::ref<iree_vm_list_t> input_list;
+    IREE_RETURN_IF_ERROR(iree_vm_list_create(
+        /*element_type=*/nullptr, 1, iree_allocator_system(), &input_list));
+    auto arg0_value = iree_vm_value_make_i32(arg0);
+    IREE_RETURN_IF_ERROR(
+        iree_vm_list_push_value(input_list.get(), &arg0_value));
+    vm::ref<iree_vm_list_t> output_list;
+    IREE_RETURN_IF_ERROR(iree_vm_list_create(
+        /*element_type=*/nullptr, 1, iree_allocator_system(), &output_list));
+
+    struct AsyncResult {
+      bool completed = false;
+      iree_status_t status = iree_ok_status();
+      int32_t ret0 = 0;
+    } result;
+    auto callback = +[](void* user_data, iree_loop_t loop,
+                        iree_status_t status, iree_vm_list_t* outputs) {
+      auto* result = reinterpret_cast<AsyncResult*>(user_data);
+      result->completed = true;
+      if (iree_status_is_ok(status)) {
+        iree_vm_value_t ret0_value;
+        status = iree_vm_list_get_value(outputs, 0, &ret0_value);
+        result->ret0 = ret0_value.i32;
+      }
+      result->status = status;
+      iree_vm_list_release(outputs);
+      return iree_ok_status();
+    };
+
+    iree_vm_async_invoke_state_t state;
+    iree_status_t loop_status = iree_ok_status();
+    IREE_RETURN_IF_ERROR(iree_vm_async_invoke(
+        iree_loop_inline(&loop_status), &state, context_, function,
+        IREE_VM_INVOCATION_FLAG_NONE, /*policy=*/nullptr, timeout,
+        input_list.get(), output_list.get(), iree_allocator_system(), callback,
+        &result));
+    IREE_RETURN_IF_ERROR(loop_status);
+    if (!result.completed) {
+      return iree_make_status(IREE_STATUS_INTERNAL,
+                              "inline loop did not complete the invocation");
+    }
+    IREE_RETURN_IF_ERROR(result.status);
+    return result.ret0;
+  }
+
+ protected:
   iree_vm_instance_t* instance_ = nullptr;
   iree_vm_context_t* context_ = nullptr;
 };
@@ -108,5 +168,271 @@ TEST_F(VMNativeModuleTest, Example) {
   ASSERT_EQ(v2, 8);
 }
 
+// Forked contexts start from the parent state and are isolated from the parent
+// and each other.
+TEST_F(VMNativeModuleTest, ForkContext) {
+  IREE_ASSERT_OK_AND_ASSIGN(
+      int32_t v0, RunFunction(iree_make_cstring_view("module_b.entry"), 1));
+  ASSERT_EQ(v0, 1);
+
+  iree_vm_context_t* fork_a = nullptr;
+  IREE_ASSERT_OK(
+      iree_vm_context_fork(context_, iree_allocator_system(), &fork_a));
+  iree_vm_context_t* fork_b = nullptr;
+  IREE_ASSERT_OK(
+      iree_vm_context_fork(context_, iree_allocator_system(), &fork_b));
+
+  IREE_ASSERT_OK_AND_ASSIGN(
+      int32_t a0,
+      RunFunction(iree_make_cstring_view("module_b.entry"), 2, fork_a));
+  ASSERT_EQ(a0, 4);
+  IREE_ASSERT_OK_AND_ASSIGN(
+      int32_t b0,
+      RunFunction(iree_make_cstring_view("module_b.entry"), 2, fork_b));
+  ASSERT_EQ(b0, 4);
+  IREE_ASSERT_OK_AND_ASSIGN(
+      int32_t a1,
+      RunFunction(iree_make_cstring_view("module_b.entry"), 3, fork_a));
+  ASSERT_EQ(a1, 8);
+
+  // Forks of forks start from the intermediate state.
+  iree_vm_context_t* fork_c = nullptr;
+  IREE_ASSERT_OK(
+      iree_vm_context_fork(fork_a, iree_allocator_system(), &fork_c));
+  iree_vm_context_release(fork_a);
+  IREE_ASSERT_OK_AND_ASSIGN(
+      int32_t c0,
+      RunFunction(iree_make_cstring_view("module_b.entry"), 1, fork_c));
+  ASSERT_EQ(c0, 10);
+  iree_vm_context_release(fork_c);
+  iree_vm_context_release(fork_b);
+
+  // The parent is unaffected by its forks.
+  IREE_ASSERT_OK_AND_ASSIGN(
+      int32_t v1, RunFunction(iree_make_cstring_view("module_b.entry"), 3));
+  ASSERT_EQ(v1, 5);
+}
+
+TEST_F(VMNativeModuleTest, ForkRequiresFrozenContext) {
+  iree_vm_context_t* context = nullptr;
+  IREE_ASSERT_OK(iree_vm_context_create(instance_, IREE_VM_CONTEXT_FLAG_NONE,
+                                        iree_allocator_system(), &context));
+  iree_vm_context_t* fork = nullptr;
+  iree_status_t status =
+      iree_vm_context_fork(context, iree_allocator_system(), &fork);
+  EXPECT_EQ(IREE_STATUS_FAILED_PRECONDITION, iree_status_code(status));
+  iree_status_ignore(status);
+  EXPECT_EQ(nullptr, fork);
+  iree_vm_context_release(context);
+}
+
+TEST_F(VMNativeModuleTest, AsyncInvoke) {
+  IREE_ASSERT_OK_AND_ASSIGN(
+      int32_t v0,
+      AsyncRunFunction(iree_make_cstring_view("module_b.entry"), 2,
+                       iree_infinite_timeout()));
+  ASSERT_EQ(v0, 2);
+  IREE_ASSERT_OK_AND_ASSIGN(
+      int32_t v1,
+      AsyncRunFunction(iree_make_cstring_view("module_b.entry"), 3,
+                       iree_make_timeout_ms(10000)));
+  ASSERT_EQ(v1, 6);
+}
+
+TEST_F(VMNativeModuleTest, InvocationRecord) {
+  iree_vm_function_t function;
+  IREE_ASSERT_OK(iree_vm_context_resolve_function(
+      context_, iree_make_cstring_view("module_b.entry"), &function));
+
+  // The record holds the VM stack storage inline so it's kept off the stack.
+  auto record = std::make_unique<iree_vm_invocation_record_t>();
+  IREE_ASSERT_OK(iree_vm_invocation_record_initialize(
+      context_, function, IREE_VM_INVOCATION_FLAG_NONE, /*policy=*/nullptr,
+      iree_allocator_system(), record.get()));
+
+  // Bind the initial arguments from a list and then rebind in-place.
+  vm::ref<iree_vm_list_t> input_list;
+  IREE_ASSERT_OK(iree_vm_list_create(/*element_type=*/nullptr, 1,
+                                     iree_allocator_system(), &input_list));
+  auto arg0_value = iree_vm_value_make_i32(1);
+  IREE_ASSERT_OK(iree_vm_list_push_value(input_list.get(), &arg0_value));
+  IREE_ASSERT_OK(
+      iree_vm_invocation_record_bind_inputs(record.get(), input_list.get()));
+
+  const int32_t expected[3] = {1, 4, 8};
+  for (int32_t i = 0; i < 3; ++i) {
+    if (i > 0) {
+      auto arg_value = iree_vm_value_make_i32(i + 1);
+      IREE_ASSERT_OK(iree_vm_invocation_record_set_argument_value(
+          record.get(), 0, &arg_value));
+    }
+    IREE_ASSERT_OK(iree_vm_invocation_record_invoke(record.get()));
+    iree_vm_value_t ret0_value;
+    IREE_ASSERT_OK(iree_vm_invocation_record_get_result_value(record.get(), 0,
+                                                              &ret0_value));
+    EXPECT_EQ(IREE_VM_VALUE_TYPE_I32, ret0_value.type);
+    EXPECT_EQ(expected[i], ret0_value.i32);
+  }
+
+  // Mismatched argument types are rejected.
+  auto bad_value = iree_vm_value_make_i64(1);
+  iree_status_t status = iree_vm_invocation_record_set_argument_value(
+      record.get(), 0, &bad_value);
+  EXPECT_EQ(IREE_STATUS_INVALID_ARGUMENT, iree_status_code(status));
+  iree_status_free(status);
+
+  iree_vm_invocation_record_deinitialize(record.get());
+}
+
+TEST_F(VMNativeModuleTest, FunctionReflection) {
+  iree_vm_function_t function;
+  IREE_ASSERT_OK(iree_vm_context_resolve_function(
+      context_, iree_make_cstring_view("module_b.entry"), &function));
+  EXPECT_TRUE(iree_string_view_equal(
+      iree_vm_function_lookup_attr_by_name(&function, IREE_SV("key1")),
+      IREE_SV("value1")));
+  EXPECT_TRUE(iree_string_view_is_empty(
+      iree_vm_function_lookup_attr_by_name(&function, IREE_SV("key2"))));
+}
+
+// Per-context state of the C++ module.
+struct CcModuleState final {
+  // Primitive-only arguments are loaded directly from the argument buffer.
+  StatusOr<int32_t> Add(int32_t a, int64_t b) {
+    return a + static_cast<int32_t>(b);
+  }
+  Status Accumulate(int32_t value) {
+    total += value;
+    return OkStatus();
+  }
+  StatusOr<int32_t> Total() { return total; }
+
+  // Ref arguments are marshaled through the generic unpacking path.
+  StatusOr<int32_t> ListSize(vm::ref<iree_vm_list_t> list) {
+    return static_cast<int32_t>(iree_vm_list_size(list.get()));
+  }
+
+  int32_t total = 0;
+};
+
+static const iree_string_pair_t kCcModuleAddAttrs[] = {
+    {iree_make_cstring_view("key1"), iree_make_cstring_view("value1")},
+};
+static const vm::NativeFunction<CcModuleState> kCcModuleFunctions[] = {
+    vm::MakeNativeFunction("accumulate", &CcModuleState::Accumulate),
+    vm::MakeNativeFunction("add", &CcModuleState::Add, kCcModuleAddAttrs),
+    vm::MakeNativeFunction("list_size", &CcModuleState::ListSize),
+    vm::MakeNativeFunction("total", &CcModuleState::Total),
+};
+
+class CcModule final : public vm::NativeModule<CcModuleState> {
+ public:
+  using vm::NativeModule<CcModuleState>::NativeModule;
+  StatusOr<std::unique_ptr<CcModuleState>> CreateState(
+      iree_allocator_t allocator) override {
+    return std::make_unique<CcModuleState>();
+  }
+};
+
+class VMNativeModuleCcTest : public ::testing::Test {
+ protected:
+  virtual void SetUp() {
+    IREE_CHECK_OK(iree_vm_instance_create(iree_allocator_system(), &instance_));
+    iree_vm_module_t* module =
+        std::make_unique<CcModule>(
+            "cc_module", /*version=*/0, instance_, iree_allocator_system(),
+            iree::span<const vm::NativeFunction<CcModuleState>>(
+                kCcModuleFunctions))
+            .release()
+            ->interface();
+    IREE_CHECK_OK(iree_vm_context_create_with_modules(
+        instance_, IREE_VM_CONTEXT_FLAG_NONE, 1, &module,
+        iree_allocator_system(), &context_));
+    iree_vm_module_release(module);
+  }
+
+  virtual void TearDown() {
+    iree_vm_context_release(context_);
+    iree_vm_instance_release(instance_);
+  }
+
+  // Invokes |function_name| with |inputs| and returns the outputs.
+  StatusOr<vm::ref<iree_vm_list_t>> Invoke(const char* function_name,
+                                           iree_vm_list_t* inputs) {
+    iree_vm_function_t function;
+    IREE_RETURN_IF_ERROR(iree_vm_context_resolve_function(
+        context_, iree_make_cstring_view(function_name), &function));
+    vm::ref<iree_vm_list_t> outputs;
+    IREE_RETURN_IF_ERROR(iree_vm_list_create(
+        /*element_type=*/nullptr, 1, iree_allocator_system(), &outputs));
+    IREE_RETURN_IF_ERROR(iree_vm_invoke(
+        context_, function, IREE_VM_INVOCATION_FLAG_NONE, /*policy=*/nullptr,
+        inputs, outputs.get(), iree_allocator_system()));
+    return std::move(outputs);
+  }
+
+  iree_vm_instance_t* instance_ = nullptr;
+  iree_vm_context_t* context_ = nullptr;
+};
+
+TEST_F(VMNativeModuleCcTest, PackedArguments) {
+  vm::ref<iree_vm_list_t> inputs;
+  IREE_ASSERT_OK(iree_vm_list_create(/*element_type=*/nullptr, 2,
+                                     iree_allocator_system(), &inputs));
+  auto a_value = iree_vm_value_make_i32(40);
+  IREE_ASSERT_OK(iree_vm_list_push_value(inputs.get(), &a_value));
+  auto b_value = iree_vm_value_make_i64(2);
+  IREE_ASSERT_OK(iree_vm_list_push_value(inputs.get(), &b_value));
+  IREE_ASSERT_OK_AND_ASSIGN(auto outputs, Invoke("cc_module.add", inputs.get()));
+  iree_vm_value_t ret0_value;
+  IREE_ASSERT_OK(iree_vm_list_get_value(outputs.get(), 0, &ret0_value));
+  EXPECT_EQ(42, ret0_value.i32);
+
+  for (int32_t i = 1; i <= 3; ++i) {
+    vm::ref<iree_vm_list_t> accumulate_inputs;
+    IREE_ASSERT_OK(iree_vm_list_create(/*element_type=*/nullptr, 1,
+                                       iree_allocator_system(),
+                                       &accumulate_inputs));
+    auto value = iree_vm_value_make_i32(i);
+    IREE_ASSERT_OK(iree_vm_list_push_value(accumulate_inputs.get(), &value));
+    IREE_ASSERT_OK(Invoke("cc_module.accumulate", accumulate_inputs.get()));
+  }
+  IREE_ASSERT_OK_AND_ASSIGN(auto total_outputs,
+                            Invoke("cc_module.total", /*inputs=*/nullptr));
+  IREE_ASSERT_OK(iree_vm_list_get_value(total_outputs.get(), 0, &ret0_value));
+  EXPECT_EQ(6, ret0_value.i32);
+}
+
+TEST_F(VMNativeModuleCcTest, RefArguments) {
+  vm::ref<iree_vm_list_t> list;
+  IREE_ASSERT_OK(iree_vm_list_create(/*element_type=*/nullptr, 3,
+                                     iree_allocator_system(), &list));
+  IREE_ASSERT_OK(iree_vm_list_resize(list.get(), 3));
+  vm::ref<iree_vm_list_t> inputs;
+  IREE_ASSERT_OK(iree_vm_list_create(/*element_type=*/nullptr, 1,
+                                     iree_allocator_system(), &inputs));
+  iree_vm_ref_t list_ref = iree_vm_list_retain_ref(list.get());
+  IREE_ASSERT_OK(iree_vm_list_push_ref_move(inputs.get(), &list_ref));
+  IREE_ASSERT_OK_AND_ASSIGN(auto outputs,
+                            Invoke("cc_module.list_size", inputs.get()));
+  iree_vm_value_t ret0_value;
+  IREE_ASSERT_OK(iree_vm_list_get_value(outputs.get(), 0, &ret0_value));
+  EXPECT_EQ(3, ret0_value.i32);
+}
+
+TEST_F(VMNativeModuleCcTest, FunctionReflection) {
+  iree_vm_function_t add_function;
+  IREE_ASSERT_OK(iree_vm_context_resolve_function(
+      context_, iree_make_cstring_view("cc_module.add"), &add_function));
+  EXPECT_TRUE(iree_string_view_equal(
+      iree_vm_function_lookup_attr_by_name(&add_function, IREE_SV("key1")),
+      IREE_SV("value1")));
+  iree_vm_function_t total_function;
+  IREE_ASSERT_OK(iree_vm_context_resolve_function(
+      context_, iree_make_cstring_view("cc_module.total"), &total_function));
+  EXPECT_TRUE(iree_string_view_is_empty(
+      iree_vm_function_lookup_attr_by_name(&total_function, IREE_SV("key1"))));
+}
+
 }  // namespace
 }  // namespace iree
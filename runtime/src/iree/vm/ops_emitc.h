@@ -10,6 +10,10 @@
 // This file contains utility macros used for things that EmitC  can't handle
 // directly.
 
+#include <string.h>
+
+#include "iree/vm/ref.h"
+
 // Assign a value through a pointer variable
 #define EMITC_DEREF_ASSIGN_VALUE(ptr, value) *(ptr) = (value)
 
@@ -60,4 +64,60 @@
 
 #define EMITC_ADD(lhs, rhs) ((lhs) + (rhs))
 
+// Inline variants of the iree_vm_ref_* functions used by generated code.
+// Generated functions move refs between registers on nearly every op and the
+// calls into the runtime otherwise dominate small functions. Only the count
+// manipulation is inlined: destroying an object requires the type descriptor
+// and goes through the out-of-line iree_vm_ref_release.
+
+static inline volatile iree_atomic_ref_count_t* iree_vm_ref_counter_ptr_inline(
+    iree_vm_ref_t* ref) {
+  return (volatile iree_atomic_ref_count_t*)(((uintptr_t)ref->ptr) +
+                                             ref->offsetof_counter);
+}
+
+// Releases |ref| as with iree_vm_ref_release.
+static inline void iree_vm_ref_release_inline(iree_vm_ref_t* ref) {
+  if (ref->ptr == NULL) return;
+  volatile iree_atomic_ref_count_t* counter =
+      iree_vm_ref_counter_ptr_inline(ref);
+  if (IREE_UNLIKELY(iree_atomic_ref_count_dec(counter) == 1)) {
+    // Last reference. Nothing else can observe the object so the count is
+    // restored and the out-of-line path performs the destruction.
+    iree_atomic_ref_count_inc(counter);
+    iree_vm_ref_release(ref);
+    return;
+  }
+  memset(ref, 0, sizeof(*ref));
+}
+
+// Retains |ref| into |out_ref| as with iree_vm_ref_retain.
+static inline void iree_vm_ref_retain_inline(iree_vm_ref_t* ref,
+                                             iree_vm_ref_t* out_ref) {
+  // NOTE: ref and out_ref may alias so we retain before we release.
+  iree_vm_ref_t temp_ref = *ref;
+  if (ref->ptr) iree_atomic_ref_count_inc(iree_vm_ref_counter_ptr_inline(ref));
+  if (out_ref->ptr) iree_vm_ref_release_inline(out_ref);
+  *out_ref = temp_ref;
+}
+
+// Assigns |ref| to |out_ref| as with iree_vm_ref_assign.
+static inline void iree_vm_ref_assign_inline(iree_vm_ref_t* ref,
+                                             iree_vm_ref_t* out_ref) {
+  if (ref == out_ref) return;
+  iree_vm_ref_t temp_ref = *ref;
+  if (out_ref->ptr) iree_vm_ref_release_inline(out_ref);
+  *out_ref = temp_ref;
+}
+
+// Moves |ref| to |out_ref| as with iree_vm_ref_move.
+static inline void iree_vm_ref_move_inline(iree_vm_ref_t* ref,
+                                           iree_vm_ref_t* out_ref) {
+  if (ref == out_ref) return;
+  iree_vm_ref_t temp_ref = *ref;
+  memset(ref, 0, sizeof(*ref));
+  if (out_ref->ptr) iree_vm_ref_release_inline(out_ref);
+  *out_ref = temp_ref;
+}
+
 #endif  // IREE_VM_OPS_EMITC_H_
@@ -9,13 +9,12 @@
 #include <string.h>
 
 #include "iree/base/internal/atomics.h"
+#include "iree/base/internal/math.h"
 
-// TODO(benvanik): dynamic, if we care - otherwise keep small.
-// After a dozen or so types the linear scan will likely start to spill the
-// DCACHE and need to be reworked. I suspect at the time we have >=64 types
-// we'll want to rewrite all of this anyway (using externalized type ID storage
-// or something more complex).
-#define IREE_VM_MAX_TYPE_ID 64
+// Type IDs are stored in 24-bit fields in both iree_vm_ref_t and
+// iree_vm_ref_type_descriptor_t and that is the only bound on the number of
+// types that can be registered.
+#define IREE_VM_MAX_TYPE_ID ((1u << 24) - 1)
 
 static inline volatile iree_atomic_ref_count_t* iree_vm_get_raw_counter_ptr(
     void* ptr, const iree_vm_ref_type_descriptor_t* type_descriptor) {
@@ -55,53 +54,175 @@ IREE_API_EXPORT void iree_vm_ref_object_release(
 // debugging. Note that this just points to registered descriptors (or NULL) for
 // each type ID in the type range and does not own the descriptors.
 //
+// The table is split into blocks that double in size: block 0 is statically
+// allocated and holds the first IREE_VM_TYPE_BLOCK_BASE_CAPACITY types and
+// block k holds the next IREE_VM_TYPE_BLOCK_BASE_CAPACITY << k types. Blocks
+// never move once allocated so lookups by type ID are O(1) and remain valid
+// across registrations. IREE_VM_TYPE_BLOCK_COUNT blocks are enough to cover the
+// full IREE_VM_MAX_TYPE_ID range.
+//
 // Note that [0] is always the NULL type and has a NULL descriptor. We don't
 // allow types to be registered there.
+#define IREE_VM_TYPE_BLOCK_BASE_CAPACITY 64
+#define IREE_VM_TYPE_BLOCK_COUNT 19
+static const iree_vm_ref_type_descriptor_t*
+    iree_vm_ref_type_block_0[IREE_VM_TYPE_BLOCK_BASE_CAPACITY] = {0};
+static const iree_vm_ref_type_descriptor_t**
+    iree_vm_ref_type_blocks[IREE_VM_TYPE_BLOCK_COUNT] = {
+        iree_vm_ref_type_block_0,
+};
+// Next type ID that will be assigned on registration.
+static iree_vm_ref_type_t iree_vm_ref_next_type_id = 1;
+
+// Open-addressed hash table from type name to descriptor used for
+// iree_vm_ref_lookup_registered_type. Kept at most half full. The initial
+// storage is static so that the common case never allocates.
+#define IREE_VM_TYPE_NAME_TABLE_INITIAL_CAPACITY 128
 static const iree_vm_ref_type_descriptor_t*
-    iree_vm_ref_type_descriptors[IREE_VM_MAX_TYPE_ID] = {0};
+    iree_vm_ref_type_name_table_initial
+        [IREE_VM_TYPE_NAME_TABLE_INITIAL_CAPACITY] = {0};
+static const iree_vm_ref_type_descriptor_t** iree_vm_ref_type_name_table =
+    iree_vm_ref_type_name_table_initial;
+static iree_host_size_t iree_vm_ref_type_name_table_capacity =
+    IREE_VM_TYPE_NAME_TABLE_INITIAL_CAPACITY;
+static iree_host_size_t iree_vm_ref_type_name_table_count = 0;
+
+// Maps a type ID to the registry block containing it and the index within it.
+static inline void iree_vm_ref_type_block_index(iree_vm_ref_type_t type,
+                                                iree_host_size_t* out_block,
+                                                iree_host_size_t* out_index) {
+  uint32_t q = type / IREE_VM_TYPE_BLOCK_BASE_CAPACITY + 1;
+  iree_host_size_t block = 31 - iree_math_count_leading_zeros_u32(q);
+  *out_block = block;
+  *out_index = type - IREE_VM_TYPE_BLOCK_BASE_CAPACITY * ((1u << block) - 1);
+}
 
 // Returns the type descriptor (or NULL) for the given type ID.
 static const iree_vm_ref_type_descriptor_t* iree_vm_ref_get_type_descriptor(
     iree_vm_ref_type_t type) {
-  if (type >= IREE_VM_MAX_TYPE_ID) {
+  if (type >= iree_vm_ref_next_type_id) {
     return NULL;
   }
-  return iree_vm_ref_type_descriptors[type];
+  iree_host_size_t block = 0;
+  iree_host_size_t index = 0;
+  iree_vm_ref_type_block_index(type, &block, &index);
+  return iree_vm_ref_type_blocks[block][index];
+}
+
+// FNV-1a hash of a type name.
+static uint32_t iree_vm_ref_type_name_hash(iree_string_view_t name) {
+  uint32_t hash = 2166136261u;
+  for (iree_host_size_t i = 0; i < name.size; ++i) {
+    hash ^= (uint8_t)name.data[i];
+    hash *= 16777619u;
+  }
+  return hash;
+}
+
+// Inserts |descriptor| into |table| of power-of-two |capacity|.
+// If a descriptor with the same name is already present the table is left
+// unchanged so that the first registration wins.
+static void iree_vm_ref_type_name_table_insert(
+    const iree_vm_ref_type_descriptor_t** table, iree_host_size_t capacity,
+    const iree_vm_ref_type_descriptor_t* descriptor) {
+  iree_host_size_t mask = capacity - 1;
+  iree_host_size_t i =
+      iree_vm_ref_type_name_hash(descriptor->type_name) & mask;
+  while (table[i]) {
+    if (iree_string_view_equal(table[i]->type_name, descriptor->type_name)) {
+      return;
+    }
+    i = (i + 1) & mask;
+  }
+  table[i] = descriptor;
+  ++iree_vm_ref_type_name_table_count;
+}
+
+// Grows the name table to keep it at most half full after another insertion.
+static iree_status_t iree_vm_ref_type_name_table_reserve(void) {
+  if ((iree_vm_ref_type_name_table_count + 1) * 2 <=
+      iree_vm_ref_type_name_table_capacity) {
+    return iree_ok_status();
+  }
+  iree_host_size_t new_capacity = iree_vm_ref_type_name_table_capacity * 2;
+  const iree_vm_ref_type_descriptor_t** new_table = NULL;
+  IREE_RETURN_IF_ERROR(iree_allocator_malloc(iree_allocator_system(),
+                                             new_capacity * sizeof(*new_table),
+                                             (void**)&new_table));
+  memset(new_table, 0, new_capacity * sizeof(*new_table));
+  const iree_vm_ref_type_descriptor_t** old_table = iree_vm_ref_type_name_table;
+  iree_host_size_t old_capacity = iree_vm_ref_type_name_table_capacity;
+  iree_vm_ref_type_name_table_count = 0;
+  for (iree_host_size_t i = 0; i < old_capacity; ++i) {
+    if (old_table[i]) {
+      iree_vm_ref_type_name_table_insert(new_table, new_capacity, old_table[i]);
+    }
+  }
+  iree_vm_ref_type_name_table = new_table;
+  iree_vm_ref_type_name_table_capacity = new_capacity;
+  if (old_table != iree_vm_ref_type_name_table_initial) {
+    iree_allocator_free(iree_allocator_system(), (void*)old_table);
+  }
+  return iree_ok_status();
 }
 
 IREE_API_EXPORT iree_status_t
 iree_vm_ref_register_type(iree_vm_ref_type_descriptor_t* descriptor) {
-  for (int i = 1; i <= IREE_VM_MAX_TYPE_ID; ++i) {
-    if (!iree_vm_ref_type_descriptors[i]) {
-      iree_vm_ref_type_descriptors[i] = descriptor;
-      descriptor->type = i;
-      return iree_ok_status();
-    }
+  iree_vm_ref_type_t type = iree_vm_ref_next_type_id;
+  if (type > IREE_VM_MAX_TYPE_ID) {
+    return iree_make_status(IREE_STATUS_RESOURCE_EXHAUSTED,
+                            "too many user-defined types registered; new type "
+                            "would exceed maximum of %u",
+                            IREE_VM_MAX_TYPE_ID);
+  }
+
+  // Allocate the block holding the new type ID if this is the first type in
+  // it. Blocks are never freed as refs may reference them for the lifetime of
+  // the process.
+  iree_host_size_t block = 0;
+  iree_host_size_t index = 0;
+  iree_vm_ref_type_block_index(type, &block, &index);
+  if (!iree_vm_ref_type_blocks[block]) {
+    iree_host_size_t block_capacity = IREE_VM_TYPE_BLOCK_BASE_CAPACITY
+                                      << block;
+    const iree_vm_ref_type_descriptor_t** block_storage = NULL;
+    IREE_RETURN_IF_ERROR(iree_allocator_malloc(
+        iree_allocator_system(), block_capacity * sizeof(*block_storage),
+        (void**)&block_storage));
+    memset(block_storage, 0, block_capacity * sizeof(*block_storage));
+    iree_vm_ref_type_blocks[block] = block_storage;
   }
-  // Too many user-defined types registered; need to increase
-  // IREE_VM_MAX_TYPE_ID.
-  return iree_make_status(IREE_STATUS_RESOURCE_EXHAUSTED,
-                          "too many user-defined types registered; new type "
-                          "would exceed maximum of %d",
-                          IREE_VM_MAX_TYPE_ID);
+  IREE_RETURN_IF_ERROR(iree_vm_ref_type_name_table_reserve());
+
+  iree_vm_ref_type_blocks[block][index] = descriptor;
+  descriptor->type = type;
+  iree_vm_ref_type_name_table_insert(iree_vm_ref_type_name_table,
+                                     iree_vm_ref_type_name_table_capacity,
+                                     descriptor);
+  ++iree_vm_ref_next_type_id;
+  return iree_ok_status();
 }
 
 IREE_API_EXPORT iree_string_view_t
 iree_vm_ref_type_name(iree_vm_ref_type_t type) {
-  if (type == 0 || type >= IREE_VM_MAX_TYPE_ID) {
+  const iree_vm_ref_type_descriptor_t* descriptor =
+      iree_vm_ref_get_type_descriptor(type);
+  if (!descriptor) {
     return iree_string_view_empty();
   }
-  return iree_vm_ref_type_descriptors[type]->type_name;
+  return descriptor->type_name;
 }
 
 IREE_API_EXPORT const iree_vm_ref_type_descriptor_t*
 iree_vm_ref_lookup_registered_type(iree_string_view_t full_name) {
-  for (int i = 1; i <= IREE_VM_MAX_TYPE_ID; ++i) {
-    if (!iree_vm_ref_type_descriptors[i]) break;
-    if (iree_string_view_equal(iree_vm_ref_type_descriptors[i]->type_name,
+  iree_host_size_t mask = iree_vm_ref_type_name_table_capacity - 1;
+  iree_host_size_t i = iree_vm_ref_type_name_hash(full_name) & mask;
+  while (iree_vm_ref_type_name_table[i]) {
+    if (iree_string_view_equal(iree_vm_ref_type_name_table[i]->type_name,
                                full_name)) {
-      return iree_vm_ref_type_descriptors[i];
+      return iree_vm_ref_type_name_table[i];
     }
+    i = (i + 1) & mask;
   }
   return NULL;
 }
@@ -129,6 +129,9 @@ IREE_API_EXPORT void iree_vm_ref_object_release(
 // NOTE: the name is not retained and must be kept live by the caller. Ideally
 // it is stored in static read-only memory in the binary.
 //
+// Type IDs are assigned sequentially and lookups by ID or name are O(1); the
+// only limit on the number of registered types is the 24-bit type ID range.
+//
 // WARNING: this function is not thread-safe and should only be used at startup
 // to register the types. Do not call this while any refs may be alive.
 IREE_API_EXPORT iree_status_t
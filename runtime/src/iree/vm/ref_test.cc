@@ -7,6 +7,7 @@
 #include "iree/vm/ref.h"
 
 #include <cstddef>
+#include <cstdio>
 
 #include "iree/base/api.h"
 #include "iree/testing/gtest.h"
@@ -88,6 +89,41 @@ TEST(VMRefTest, TypeRegistration) {
                          iree_make_cstring_view("asodjfaoisdjfaoisdfj")));
 }
 
+// Tests registering more types than fit in the initial registry storage.
+TEST(VMRefTest, ManyTypeRegistrations) {
+  static constexpr int kTypeCount = 300;
+  static char type_names[kTypeCount][32];
+  static iree_vm_ref_type_descriptor_t descriptors[kTypeCount];
+  static bool registered = false;
+  if (!registered) {
+    for (int i = 0; i < kTypeCount; ++i) {
+      snprintf(type_names[i], sizeof(type_names[i]), "ManyType%d", i);
+      descriptors[i] = {0};
+      descriptors[i].type_name = iree_make_cstring_view(type_names[i]);
+      descriptors[i].offsetof_counter =
+          offsetof(ref_object_c_t, ref_object.counter);
+      descriptors[i].destroy =
+          +[](void* ptr) { delete reinterpret_cast<ref_object_c_t*>(ptr); };
+      IREE_ASSERT_OK(iree_vm_ref_register_type(&descriptors[i]));
+    }
+    registered = true;
+  }
+  for (int i = 0; i < kTypeCount; ++i) {
+    EXPECT_EQ(&descriptors[i], iree_vm_ref_lookup_registered_type(
+                                   iree_make_cstring_view(type_names[i])));
+    iree_string_view_t name = iree_vm_ref_type_name(descriptors[i].type);
+    EXPECT_TRUE(iree_string_view_equal(name, descriptors[i].type_name));
+  }
+
+  // Refs of types beyond the initial storage must still be released through
+  // their registered descriptor.
+  iree_vm_ref_t ref = {0};
+  IREE_EXPECT_OK(iree_vm_ref_wrap_assign(
+      new ref_object_c_t(), descriptors[kTypeCount - 1].type, &ref));
+  EXPECT_EQ(1, ReadCounter(&ref));
+  iree_vm_ref_release(&ref);
+}
+
 // Tests wrapping a simple C struct.
 TEST(VMRefTest, WrappingCStruct) {
   RegisterTypeC();
@@ -196,6 +196,12 @@ IREE_VM_ABI_FIXED_STRUCT(iI, {
   int64_t i1;
 });
 
+IREE_VM_ABI_FIXED_STRUCT(iII, {
+  int32_t i0;
+  int64_t i1;
+  int64_t i2;
+});
+
 IREE_VM_ABI_FIXED_STRUCT(II, {
   int64_t i0;
   int64_t i1;
@@ -13,6 +13,7 @@
 
 #include "iree/base/alignment.h"
 #include "iree/base/api.h"
+#include "iree/base/internal/arena.h"
 #include "iree/base/tracing.h"
 #include "iree/vm/module.h"
 
@@ -70,14 +71,20 @@
 // with optimizations disabled; for example the debug register allocator may
 // expand the required register count for a function from 30 to 3000.
 //
-// To support these cases the stack can optionally be provided an allocator to
-// enable it to grow the stack when the initial storage is exhausted. As we
-// store pointers to the stack storage within the storage itself (such as the
-// iree_vm_registers_t pointers) this means we need to perform a fixup step
-// during reallocation to ensure they are all updated. This also means that the
-// pointers to the stack frames are possibly invalidated on every function
-// entry and that users of the stack cannot rely on pointer stability during
-// execution.
+// To support these cases the stack can optionally be provided an allocator or
+// block pool to enable it to grow the stack when the initial storage is
+// exhausted. Growth chains additional segments instead of reallocating such
+// that existing frames never move:
+//
+// [iree_vm_stack_t]
+//   +- base segment (initial storage) -> segment 1 -> segment 2 (cached)
+//
+// Frames never span segments: a frame that does not fit in the remaining
+// capacity of the current segment is placed at the start of the next one.
+// Segments are retained when the frames within them are left so that stacks
+// repeatedly entering and leaving deep call chains only pay for acquiring the
+// segments once. They are returned to their pool or allocator when the stack
+// is deinitialized.
 //
 // Calling convention
 // ------------------
@@ -115,11 +122,22 @@
 // code paths which are likely still in instruction cache the bulk of the work
 // amounts to some small memcpys.
 
-// Multiplier on the capacity of the stack frame storage when growing.
-// Since we never shrink stacks it's nice to keep this relative low. If we
-// measure a lot of growth happening in normal models we should increase this
-// but otherwise leave as small as we can to avoid overallocation.
-#define IREE_VM_STACK_GROWTH_FACTOR 2
+// A contiguous range of frame storage. Frames within a segment are packed in
+// LIFO order and all segments after the current one are unused.
+typedef struct iree_vm_stack_segment_t {
+  // Previous segment in the stack or NULL for the base segment.
+  struct iree_vm_stack_segment_t* prev;
+  // Next segment in the stack, if one has been acquired. Retained when empty.
+  struct iree_vm_stack_segment_t* next;
+  // Block the segment was acquired from if from a block pool or NULL if the
+  // segment was allocated from the stack allocator.
+  iree_arena_block_t* block;
+  // Base pointer to segment frame storage.
+  uint8_t* storage;
+  // Total capacity and used size of the storage, in bytes.
+  iree_host_size_t capacity;
+  iree_host_size_t size;
+} iree_vm_stack_segment_t;
 
 // A private stack frame header that allows us to walk the linked list of
 // frames without exposing their exact structure through the API. This makes it
@@ -128,8 +146,8 @@
 typedef struct iree_vm_stack_frame_header_t {
   // Size, in bytes, of the frame header and frame payload including registers.
   // Adding this value to the base header pointer will yield the next available
-  // memory location. Ensure that it does not exceed the total
-  // frame_storage_capacity.
+  // memory location. Ensure that it does not exceed the capacity of the
+  // segment containing the frame.
   iree_host_size_t frame_size;
 
   // Pointer to the parent stack frame, usually immediately preceding this one
@@ -151,36 +169,27 @@ typedef struct iree_vm_stack_frame_header_t {
   iree_vm_stack_frame_t frame;
 } iree_vm_stack_frame_header_t;
 
-// Core stack storage. This will be mapped either into dynamic memory allocated
-// by the member allocator or static memory allocated externally. Static stacks
-// cannot grow when storage runs out while dynamic ones will resize their stack.
+// Core stack storage. The base segment maps into static memory provided by the
+// user and additional segments are acquired from the block pool or allocator.
+// Stacks with neither cannot grow when the base segment runs out.
 struct iree_vm_stack_t {
   // NOTE: to get better cache hit rates we put the most frequently accessed
   // members first.
 
   // Pointer to the current top of the stack.
   // This can be used to walk the stack from top to bottom by following the
-  // |parent| pointers. Note that these pointers are invalidated each time the
-  // stack grows (if dynamic growth is enabled) and all of the frames will need
-  // updating.
+  // |parent| pointers.
   iree_vm_stack_frame_header_t* top;
 
-  // Base pointer to stack storage.
-  // For statically-allocated stacks this will (likely) point to immediately
-  // after the iree_vm_stack_t in memory. For dynamically-allocated stacks this
-  // will (likely) point to heap memory.
-  iree_host_size_t frame_storage_capacity;
-  iree_host_size_t frame_storage_size;
-  void* frame_storage;
+  // Segment containing |top| (or the base segment if the stack is empty).
+  iree_vm_stack_segment_t* segment;
+
+  // Total capacity of all acquired segments, in bytes.
+  iree_host_size_t total_capacity;
 
   // Flags controlling the behavior of the invocation owning this stack.
   iree_vm_invocation_flags_t flags;
 
-  // True if the stack owns the frame_storage and should free it when it is no
-  // longer required. Host stack-allocated stacks don't own their storage but
-  // may transition to owning it on dynamic growth.
-  bool owns_frame_storage;
-
   // Resolves a module to a module state within a context.
   // This will be called on function entry whenever module transitions occur.
   iree_vm_state_resolver_t state_resolver;
@@ -188,6 +197,12 @@ struct iree_vm_stack_t {
   // Allocator used for dynamic stack allocations. May be the null allocator
   // if growth is prohibited.
   iree_allocator_t allocator;
+
+  // Optional block pool used for acquiring additional segments.
+  iree_arena_block_pool_t* block_pool;
+
+  // Segment covering the storage provided on initialization.
+  iree_vm_stack_segment_t base_segment;
 };
 
 //===----------------------------------------------------------------------===//
@@ -211,16 +226,18 @@ IREE_API_EXPORT iree_status_t iree_vm_stack_initialize(
 
   iree_vm_stack_t* stack = (iree_vm_stack_t*)storage.data;
   memset(stack, 0, sizeof(iree_vm_stack_t));
-  stack->owns_frame_storage = false;
   stack->flags = flags;
   stack->state_resolver = state_resolver;
   stack->allocator = allocator;
+  stack->block_pool = NULL;
 
   iree_host_size_t storage_offset =
       iree_host_align(sizeof(iree_vm_stack_t), 16);
-  stack->frame_storage_capacity = storage.data_length - storage_offset;
-  stack->frame_storage_size = 0;
-  stack->frame_storage = storage.data + storage_offset;
+  stack->base_segment.storage = storage.data + storage_offset;
+  stack->base_segment.capacity = storage.data_length - storage_offset;
+  stack->base_segment.size = 0;
+  stack->segment = &stack->base_segment;
+  stack->total_capacity = stack->base_segment.capacity;
 
   stack->top = NULL;
 
@@ -241,16 +258,31 @@ IREE_API_EXPORT void iree_vm_stack_reset(iree_vm_stack_t* stack) {
   IREE_TRACE_ZONE_END(z0);
 }
 
+// Releases |segment| and all segments following it in the chain.
+static void iree_vm_stack_release_segments(iree_vm_stack_t* stack,
+                                           iree_vm_stack_segment_t* segment) {
+  while (segment) {
+    iree_vm_stack_segment_t* next_segment = segment->next;
+    stack->total_capacity -= segment->capacity;
+    if (segment->block) {
+      iree_arena_block_pool_release(stack->block_pool, segment->block,
+                                    segment->block);
+    } else {
+      iree_allocator_free(stack->allocator, segment);
+    }
+    segment = next_segment;
+  }
+}
+
 IREE_API_EXPORT void iree_vm_stack_deinitialize(iree_vm_stack_t* stack) {
   IREE_TRACE_ZONE_BEGIN(z0);
 
   // Release stack frame resources.
   iree_vm_stack_reset(stack);
 
-  // Drop allocated frame storage.
-  if (stack->owns_frame_storage) {
-    iree_allocator_free(stack->allocator, stack->frame_storage);
-  }
+  // Drop acquired segments.
+  iree_vm_stack_release_segments(stack, stack->base_segment.next);
+  stack->base_segment.next = NULL;
 
   IREE_TRACE_ZONE_END(z0);
 }
@@ -294,6 +326,20 @@ iree_vm_stack_invocation_flags(const iree_vm_stack_t* stack) {
   return stack->flags;
 }
 
+IREE_API_EXPORT iree_allocator_t
+iree_vm_stack_allocator(const iree_vm_stack_t* stack) {
+  return stack->allocator;
+}
+
+IREE_API_EXPORT void iree_vm_stack_set_block_pool(
+    iree_vm_stack_t* stack, iree_arena_block_pool_t* block_pool) {
+  IREE_ASSERT_ARGUMENT(stack);
+  // Segments remember where they came from but the pool must be stable for as
+  // long as any blocks are in use.
+  IREE_ASSERT(!stack->base_segment.next || stack->block_pool == block_pool);
+  stack->block_pool = block_pool;
+}
+
 IREE_API_EXPORT iree_vm_stack_frame_t* iree_vm_stack_top(
     iree_vm_stack_t* stack) {
   if (!stack->top) {
@@ -330,23 +376,33 @@ IREE_API_EXPORT iree_status_t iree_vm_stack_query_module_state(
                                                   module, out_module_state);
 }
 
-// Attempts to grow the stack store to hold at least |minimum_capacity|.
-// Pointers to existing stack frames will be invalidated and any pointers
-// embedded in the stack frame data structures will be updated.
+// Acquires a new segment with capacity for at least |minimum_capacity| bytes.
 // Fails if dynamic stack growth is disabled or the allocator is OOM.
-static iree_status_t iree_vm_stack_grow(iree_vm_stack_t* stack,
-                                        iree_host_size_t minimum_capacity) {
-  if (IREE_UNLIKELY(stack->allocator.ctl == NULL)) {
+static iree_status_t iree_vm_stack_acquire_segment(
+    iree_vm_stack_t* stack, iree_host_size_t minimum_capacity,
+    iree_vm_stack_segment_t** out_segment) {
+  *out_segment = NULL;
+
+  // Prefer the block pool when the segment fits in a block so that segments
+  // are shared with other stacks and rarely hit the system allocator.
+  const iree_host_size_t header_size =
+      iree_host_align(sizeof(iree_vm_stack_segment_t), 16);
+  const bool use_block_pool =
+      stack->block_pool &&
+      header_size + minimum_capacity <= stack->block_pool->usable_block_size;
+  iree_host_size_t total_size = 0;
+  if (use_block_pool) {
+    total_size = stack->block_pool->usable_block_size;
+  } else if (IREE_UNLIKELY(stack->allocator.ctl == NULL)) {
     return iree_make_status(
         IREE_STATUS_RESOURCE_EXHAUSTED,
         "stack initialized on the host stack and cannot grow");
+  } else {
+    total_size =
+        header_size + iree_max(minimum_capacity, IREE_VM_STACK_SEGMENT_SIZE);
   }
-
-  // Ensure we grow at least as much as required.
-  iree_host_size_t new_capacity = stack->frame_storage_capacity;
-  do {
-    new_capacity *= IREE_VM_STACK_GROWTH_FACTOR;
-  } while (new_capacity < minimum_capacity);
+  const iree_host_size_t capacity = total_size - header_size;
+  const iree_host_size_t new_capacity = stack->total_capacity + capacity;
   if (new_capacity > IREE_VM_STACK_MAX_SIZE) {
     return iree_make_status(IREE_STATUS_RESOURCE_EXHAUSTED,
                             "new stack size would exceed maximum size: %" PRIhsz
@@ -355,54 +411,73 @@ static iree_status_t iree_vm_stack_grow(iree_vm_stack_t* stack,
   }
 
   IREE_TRACE_ZONE_BEGIN(z0);
-
-  // Reallocate the frame storage. 99.9999% chance the new storage pointer will
-  // differ and we'll need to fix up pointers so we just always do that.
-  void* old_storage = stack->frame_storage;
-  void* new_storage = stack->frame_storage;
-  iree_status_t status;
-  if (stack->owns_frame_storage) {
-    // We own the storage already likely from a previous growth operation.
-    status =
-        iree_allocator_realloc(stack->allocator, new_capacity, &new_storage);
+  IREE_TRACE_ZONE_APPEND_VALUE(z0, (uint64_t)total_size);
+
+  iree_vm_stack_segment_t* segment = NULL;
+  iree_arena_block_t* block = NULL;
+  if (use_block_pool) {
+    IREE_RETURN_AND_END_ZONE_IF_ERROR(
+        z0, iree_arena_block_pool_acquire(stack->block_pool, &block));
+    segment = (iree_vm_stack_segment_t*)((uint8_t*)block -
+                                         stack->block_pool->usable_block_size);
   } else {
-    // We don't own the original storage so we are going to switch to our own
-    // newly-allocated storage instead. We need to make sure we copy over the
-    // existing stack contents.
-    status =
-        iree_allocator_malloc(stack->allocator, new_capacity, &new_storage);
-    if (iree_status_is_ok(status)) {
-      memcpy(new_storage, old_storage, stack->frame_storage_capacity);
-    }
-  }
-  if (!iree_status_is_ok(status)) {
-    IREE_TRACE_ZONE_END(z0);
-    return status;
-  }
-  stack->frame_storage = new_storage;
-  stack->frame_storage_capacity = new_capacity;
-  stack->owns_frame_storage = true;
-
-#define REBASE_POINTER(type, ptr, old_base, new_base)           \
-  if (ptr) {                                                    \
-    (ptr) = (type)(((uintptr_t)(ptr) - (uintptr_t)(old_base)) + \
-                   (uintptr_t)(new_base));                      \
+    IREE_RETURN_AND_END_ZONE_IF_ERROR(
+        z0, iree_allocator_malloc_uninitialized(stack->allocator, total_size,
+                                                (void**)&segment));
   }
+  segment->prev = NULL;
+  segment->next = NULL;
+  segment->block = block;
+  segment->storage = (uint8_t*)segment + header_size;
+  segment->capacity = capacity;
+  segment->size = 0;
+  stack->total_capacity = new_capacity;
+
+  *out_segment = segment;
+  IREE_TRACE_ZONE_END(z0);
+  return iree_ok_status();
+}
 
-  // Fixup embedded stack frame pointers.
-  REBASE_POINTER(iree_vm_stack_frame_header_t*, stack->top, old_storage,
-                 new_storage);
-  iree_vm_stack_frame_header_t* frame_header = stack->top;
-  while (frame_header != NULL) {
-    REBASE_POINTER(iree_vm_stack_frame_header_t*, frame_header->parent,
-                   old_storage, new_storage);
-    frame_header = frame_header->parent;
+// Reserves |frame_size| bytes for a new frame on the top of the stack.
+// Frames that do not fit in the current segment are placed in the next one,
+// reusing a previously acquired segment if it is large enough.
+static iree_status_t iree_vm_stack_reserve_frame(
+    iree_vm_stack_t* stack, iree_host_size_t frame_size,
+    iree_vm_stack_frame_header_t** out_frame_header) {
+  iree_vm_stack_segment_t* segment = stack->segment;
+  if (IREE_UNLIKELY(segment->size + frame_size > segment->capacity)) {
+    iree_vm_stack_segment_t* next_segment = segment->next;
+    if (next_segment && next_segment->capacity < frame_size) {
+      // The cached segments are too small; drop them for a larger one.
+      iree_vm_stack_release_segments(stack, next_segment);
+      segment->next = next_segment = NULL;
+    }
+    if (!next_segment) {
+      IREE_RETURN_IF_ERROR(
+          iree_vm_stack_acquire_segment(stack, frame_size, &next_segment));
+      next_segment->prev = segment;
+      segment->next = next_segment;
+    }
+    segment = next_segment;
+    stack->segment = segment;
   }
-
-  IREE_TRACE_ZONE_END(z0);
+  *out_frame_header =
+      (iree_vm_stack_frame_header_t*)(segment->storage + segment->size);
+  segment->size += frame_size;
   return iree_ok_status();
 }
 
+// Pops the frame on the top of the stack and restores the caller frame.
+static void iree_vm_stack_pop_frame(iree_vm_stack_t* stack) {
+  iree_vm_stack_segment_t* segment = stack->segment;
+  segment->size -= stack->top->frame_size;
+  if (segment->size == 0 && segment->prev) {
+    // Segment is now empty; keep it cached for the next descent.
+    stack->segment = segment->prev;
+  }
+  stack->top = stack->top->parent;
+}
+
 #if IREE_TRACING_FEATURES & IREE_TRACING_FEATURE_INSTRUMENTATION
 static iree_zone_id_t iree_vm_stack_trace_wait_zone_begin(
     iree_vm_wait_type_t wait_type, iree_host_size_t wait_count) {
@@ -439,22 +514,15 @@ IREE_API_EXPORT iree_status_t iree_vm_stack_wait_enter(
 
   // Allocate stack space and grow stack, if required.
   iree_host_size_t header_size = sizeof(iree_vm_stack_frame_header_t);
-  iree_host_size_t new_top =
-      stack->frame_storage_size + header_size + frame_size;
-  if (IREE_UNLIKELY(new_top > stack->frame_storage_capacity)) {
-    IREE_RETURN_IF_ERROR(iree_vm_stack_grow(stack, new_top));
-  }
+  iree_vm_stack_frame_header_t* frame_header = NULL;
+  IREE_RETURN_IF_ERROR(
+      iree_vm_stack_reserve_frame(stack, header_size + frame_size,
+                                  &frame_header));
 
-  // Try to reuse the same module state if the caller and callee are from the
-  // same module. Otherwise, query the state from the registered handler.
   iree_vm_stack_frame_header_t* caller_frame_header = stack->top;
   iree_vm_stack_frame_t* caller_frame =
       caller_frame_header ? &caller_frame_header->frame : NULL;
 
-  // Bump pointer and get real stack pointer offsets.
-  iree_vm_stack_frame_header_t* frame_header =
-      (iree_vm_stack_frame_header_t*)((uintptr_t)stack->frame_storage +
-                                      stack->frame_storage_size);
   memset(frame_header, 0, header_size + frame_size);
 
   frame_header->frame_size = header_size + frame_size;
@@ -469,7 +537,6 @@ IREE_API_EXPORT iree_status_t iree_vm_stack_wait_enter(
   callee_frame->type = IREE_VM_STACK_FRAME_WAIT;
   callee_frame->depth = caller_frame ? caller_frame->depth + 1 : 0;
 
-  stack->frame_storage_size = new_top;
   stack->top = frame_header;
 
   IREE_TRACE({
@@ -518,8 +585,7 @@ IREE_API_EXPORT iree_status_t iree_vm_stack_wait_leave(
   });
 
   // Restore the frame pointer to the caller.
-  stack->frame_storage_size -= stack->top->frame_size;
-  stack->top = stack->top->parent;
+  iree_vm_stack_pop_frame(stack);
 
   return iree_ok_status();
 }
@@ -546,14 +612,6 @@ IREE_API_EXPORT iree_status_t iree_vm_stack_function_enter(
     iree_vm_stack_frame_t** out_callee_frame) {
   if (out_callee_frame) *out_callee_frame = NULL;
 
-  // Allocate stack space and grow stack, if required.
-  iree_host_size_t header_size = sizeof(iree_vm_stack_frame_header_t);
-  iree_host_size_t new_top =
-      stack->frame_storage_size + header_size + frame_size;
-  if (IREE_UNLIKELY(new_top > stack->frame_storage_capacity)) {
-    IREE_RETURN_IF_ERROR(iree_vm_stack_grow(stack, new_top));
-  }
-
   // Try to reuse the same module state if the caller and callee are from the
   // same module. Otherwise, query the state from the registered handler.
   iree_vm_stack_frame_header_t* caller_frame_header = stack->top;
@@ -567,10 +625,12 @@ IREE_API_EXPORT iree_status_t iree_vm_stack_function_enter(
         stack->state_resolver.self, function->module, &module_state));
   }
 
-  // Bump pointer and get real stack pointer offsets.
-  iree_vm_stack_frame_header_t* frame_header =
-      (iree_vm_stack_frame_header_t*)((uintptr_t)stack->frame_storage +
-                                      stack->frame_storage_size);
+  // Allocate stack space and grow stack, if required.
+  iree_host_size_t header_size = sizeof(iree_vm_stack_frame_header_t);
+  iree_vm_stack_frame_header_t* frame_header = NULL;
+  IREE_RETURN_IF_ERROR(
+      iree_vm_stack_reserve_frame(stack, header_size + frame_size,
+                                  &frame_header));
   memset(frame_header, 0, header_size + frame_size);
 
   frame_header->frame_size = header_size + frame_size;
@@ -585,7 +645,6 @@ IREE_API_EXPORT iree_status_t iree_vm_stack_function_enter(
   callee_frame->pc = 0;
   callee_frame->depth = caller_frame ? caller_frame->depth + 1 : 0;
 
-  stack->frame_storage_size = new_top;
   stack->top = frame_header;
 
   IREE_TRACE({
@@ -619,8 +678,7 @@ iree_vm_stack_function_leave(iree_vm_stack_t* stack) {
   });
 
   // Restore the frame pointer to the caller.
-  stack->frame_storage_size -= stack->top->frame_size;
-  stack->top = stack->top->parent;
+  iree_vm_stack_pop_frame(stack);
 
   return iree_ok_status();
 }
@@ -41,6 +41,16 @@ extern "C" {
 // The maximum size of VM stack storage; anything larger is probably a bug.
 #define IREE_VM_STACK_MAX_SIZE (1 * 1024 * 1024)
 
+// The minimum size of each additional segment allocated from the stack
+// allocator when growing a stack. Segments for frames larger than this are
+// sized to fit the frame. When a block pool is used segments are instead the
+// size of the pool blocks.
+#if !defined(IREE_VM_STACK_SEGMENT_SIZE)
+#define IREE_VM_STACK_SEGMENT_SIZE (16 * 1024)
+#endif  // !IREE_VM_STACK_SEGMENT_SIZE
+
+typedef struct iree_arena_block_pool_t iree_arena_block_pool_t;
+
 enum iree_vm_invocation_flag_bits_t {
   IREE_VM_INVOCATION_FLAG_NONE = 0u,
 
@@ -199,6 +209,9 @@ typedef struct iree_vm_stack_t iree_vm_stack_t;
 // prevent growth. Use IREE_VM_STACK_DEFAULT_SIZE for a reasonable default or
 // use iree_vm_stack_allocate if the input programs may exceed reason.
 //
+// Growth chains additional segments of storage and never moves existing
+// frames; see iree_vm_stack_set_block_pool to share segments across stacks.
+//
 // The provided |state_resolver| will be used to resolve a module to a module
 // state within a context. This will be called on function entry whenever module
 // transitions occur.
@@ -247,6 +260,18 @@ IREE_API_EXPORT void iree_vm_stack_free(iree_vm_stack_t* stack);
 IREE_API_EXPORT iree_vm_invocation_flags_t
 iree_vm_stack_invocation_flags(const iree_vm_stack_t* stack);
 
+// Returns the allocator used for dynamic allocations made by the stack.
+// May be the null allocator if growth is prohibited.
+IREE_API_EXPORT iree_allocator_t
+iree_vm_stack_allocator(const iree_vm_stack_t* stack);
+
+// Sets a |block_pool| used to acquire additional stack segments when the
+// initial storage is exhausted. Frames that do not fit within a pool block fall
+// back to the stack allocator. The pool must remain valid until the stack is
+// deinitialized and must be set prior to the stack growing.
+IREE_API_EXPORT void iree_vm_stack_set_block_pool(
+    iree_vm_stack_t* stack, iree_arena_block_pool_t* block_pool);
+
 // Returns the top stack execution frame, ignore wait frames.
 IREE_API_EXPORT iree_vm_stack_frame_t* iree_vm_stack_top(
     iree_vm_stack_t* stack);
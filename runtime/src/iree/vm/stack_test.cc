@@ -7,6 +7,7 @@
 #include "iree/vm/stack.h"
 
 #include "iree/base/api.h"
+#include "iree/base/internal/arena.h"
 #include "iree/testing/gtest.h"
 #include "iree/testing/status_matchers.h"
 
@@ -120,6 +121,75 @@ TEST(VMStackTest, StackOverflow) {
   iree_vm_stack_deinitialize(stack);
 }
 
+// Tests that growing the stack chains segments and never moves frames.
+TEST(VMStackTest, GrowthPreservesFrames) {
+  iree_vm_state_resolver_t state_resolver = {nullptr, SentinelStateResolver};
+  IREE_VM_INLINE_STACK_INITIALIZE(stack, IREE_VM_INVOCATION_FLAG_NONE,
+                                  state_resolver, iree_allocator_system());
+
+  // Enter enough frames to exceed the initial storage several times over and
+  // ensure that frames entered prior to each growth remain valid.
+  iree_vm_function_t function_a = {MODULE_A_SENTINEL,
+                                   IREE_VM_FUNCTION_LINKAGE_INTERNAL, 0};
+  static const int kFrameCount = 64;
+  static const iree_host_size_t kFrameSize = 1024;
+  iree_vm_stack_frame_t* frames[kFrameCount] = {nullptr};
+  for (int i = 0; i < kFrameCount; ++i) {
+    IREE_ASSERT_OK(iree_vm_stack_function_enter(
+        stack, &function_a, IREE_VM_STACK_FRAME_NATIVE, kFrameSize, NULL,
+        &frames[i]));
+    memset(iree_vm_stack_frame_storage(frames[i]), i, kFrameSize);
+  }
+  for (int i = kFrameCount - 1; i >= 0; --i) {
+    EXPECT_EQ(frames[i], iree_vm_stack_current_frame(stack));
+    EXPECT_EQ(i, frames[i]->depth);
+    uint8_t* storage = (uint8_t*)iree_vm_stack_frame_storage(frames[i]);
+    EXPECT_EQ(i, storage[0]);
+    EXPECT_EQ(i, storage[kFrameSize - 1]);
+    IREE_EXPECT_OK(iree_vm_stack_function_leave(stack));
+  }
+
+  // Descending again reuses the segments acquired above.
+  for (int i = 0; i < kFrameCount; ++i) {
+    iree_vm_stack_frame_t* frame = nullptr;
+    IREE_ASSERT_OK(iree_vm_stack_function_enter(
+        stack, &function_a, IREE_VM_STACK_FRAME_NATIVE, kFrameSize, NULL,
+        &frame));
+    EXPECT_EQ(frames[i], frame);
+  }
+
+  iree_vm_stack_deinitialize(stack);
+}
+
+// Tests that stacks acquire segments from a block pool when provided.
+TEST(VMStackTest, GrowthFromBlockPool) {
+  iree_arena_block_pool_t block_pool;
+  iree_arena_block_pool_initialize(4096, iree_allocator_system(), &block_pool);
+
+  // No allocator is provided so any growth must come from the pool.
+  iree_vm_state_resolver_t state_resolver = {nullptr, SentinelStateResolver};
+  IREE_VM_INLINE_STACK_INITIALIZE(stack, IREE_VM_INVOCATION_FLAG_NONE,
+                                  state_resolver, iree_allocator_null());
+  iree_vm_stack_set_block_pool(stack, &block_pool);
+
+  iree_vm_function_t function_a = {MODULE_A_SENTINEL,
+                                   IREE_VM_FUNCTION_LINKAGE_INTERNAL, 0};
+  for (int i = 0; i < 32; ++i) {
+    IREE_ASSERT_OK(iree_vm_stack_function_enter(
+        stack, &function_a, IREE_VM_STACK_FRAME_NATIVE, 1024, NULL, NULL));
+  }
+
+  // Frames larger than a block would need the allocator.
+  iree_status_t status = iree_vm_stack_function_enter(
+      stack, &function_a, IREE_VM_STACK_FRAME_NATIVE, 8192, NULL, NULL);
+  IREE_EXPECT_STATUS_IS(IREE_STATUS_RESOURCE_EXHAUSTED, status);
+  iree_status_free(status);
+
+  // Deinitialization returns all blocks to the pool.
+  iree_vm_stack_deinitialize(stack);
+  iree_arena_block_pool_deinitialize(&block_pool);
+}
+
 // Tests unbalanced stack popping.
 TEST(VMStackTest, UnbalancedPop) {
   iree_vm_state_resolver_t state_resolver = {nullptr, SentinelStateResolver};
@@ -0,0 +1,349 @@
+// Copyright 2023 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include "module.h"
+
+#include <cstdio>
+#include <vector>
+
+#include "iree/modules/hal/types.h"
+#include "iree/vm/native_module_cc.h"
+
+// NOTE: this module is written in C++ using the native module wrapper and uses
+// template magic to handle marshaling arguments. For a lot of uses this is a
+// much friendlier way of exposing modules to the IREE VM and if performance and
+// code size are not a concern is a fine route to take. Here we do it for
+// brevity but all of the internal IREE modules are implemented in C.
+
+//===----------------------------------------------------------------------===//
+// !paged_kv.allocator type
+//===----------------------------------------------------------------------===//
+
+// Runtime type descriptor for the !paged_kv.allocator describing how to manage
+// it and destroy it. The type ID is allocated at runtime and does not need to
+// match the compiler ID.
+static iree_vm_ref_type_descriptor_t iree_paged_kv_allocator_descriptor = {0};
+
+// Block allocator handing out fixed-size KV-cache pages to sequences.
+// Sequences grow one page at a time as tokens are appended and return all of
+// their pages when released so that memory is only ever wasted in the last
+// partially-filled page of each sequence (instead of reserving the maximum
+// sequence length up front). Pages are identified by their ordinal in the
+// page pool the compiled program owns.
+typedef struct iree_paged_kv_allocator_t {
+  // Must be the first field; used to track the reference count of the object.
+  iree_vm_ref_object_t ref_object;
+  // Allocator the allocator and its tables were allocated from.
+  iree_allocator_t host_allocator;
+  // Total number of pages in the pool.
+  iree_host_size_t page_count;
+  // Number of tokens stored in each page.
+  iree_host_size_t page_tokens;
+  // Sequence owning each page or -1 if the page is free.
+  int64_t* page_owners;
+  // Ordinal of each page within its owning sequence.
+  int32_t* page_positions;
+  // Stack of free page ordinals with the next page to allocate on top.
+  int32_t* free_pages;
+  iree_host_size_t free_count;
+} iree_paged_kv_allocator_t;
+
+IREE_VM_DEFINE_TYPE_ADAPTERS(iree_paged_kv_allocator,
+                             iree_paged_kv_allocator_t);
+
+extern "C" iree_status_t iree_paged_kv_allocator_create(
+    iree_host_size_t page_count, iree_host_size_t page_tokens,
+    iree_allocator_t host_allocator,
+    iree_paged_kv_allocator_t** out_allocator) {
+  IREE_ASSERT_ARGUMENT(out_allocator);
+  *out_allocator = NULL;
+  if (page_count == 0 || page_count > INT32_MAX || page_tokens == 0) {
+    return iree_make_status(IREE_STATUS_INVALID_ARGUMENT,
+                            "invalid page pool of %zu pages of %zu tokens",
+                            page_count, page_tokens);
+  }
+
+  // Note that we allocate the allocator and all of its tables together.
+  iree_paged_kv_allocator_t* allocator = NULL;
+  iree_host_size_t total_size =
+      sizeof(*allocator) +
+      page_count * (sizeof(int64_t) + sizeof(int32_t) + sizeof(int32_t));
+  IREE_RETURN_IF_ERROR(
+      iree_allocator_malloc(host_allocator, total_size, (void**)&allocator));
+  allocator->ref_object.counter = IREE_ATOMIC_VAR_INIT(1);
+  allocator->host_allocator = host_allocator;
+  allocator->page_count = page_count;
+  allocator->page_tokens = page_tokens;
+  uint8_t* tables = (uint8_t*)allocator + sizeof(*allocator);
+  allocator->page_owners = (int64_t*)tables;
+  allocator->page_positions =
+      (int32_t*)(tables + page_count * sizeof(int64_t));
+  allocator->free_pages = allocator->page_positions + page_count;
+
+  // Push pages in reverse so that the lowest ordinals are allocated first.
+  for (iree_host_size_t i = 0; i < page_count; ++i) {
+    allocator->page_owners[i] = -1;
+    allocator->page_positions[i] = 0;
+    allocator->free_pages[i] = (int32_t)(page_count - i - 1);
+  }
+  allocator->free_count = page_count;
+
+  *out_allocator = allocator;
+  return iree_ok_status();
+}
+
+extern "C" void iree_paged_kv_allocator_destroy(void* ptr) {
+  iree_paged_kv_allocator_t* allocator = (iree_paged_kv_allocator_t*)ptr;
+  iree_allocator_free(allocator->host_allocator, ptr);
+}
+
+extern "C" iree_status_t iree_custom_module_paged_kv_register_types(
+    iree_vm_instance_t* instance) {
+  if (iree_paged_kv_allocator_descriptor.type) {
+    return iree_ok_status();  // Already registered.
+  }
+  iree_paged_kv_allocator_descriptor.type_name =
+      iree_make_cstring_view("paged_kv.allocator");
+  iree_paged_kv_allocator_descriptor.offsetof_counter =
+      offsetof(iree_paged_kv_allocator_t, ref_object.counter);
+  iree_paged_kv_allocator_descriptor.destroy = iree_paged_kv_allocator_destroy;
+  return iree_vm_ref_register_type(&iree_paged_kv_allocator_descriptor);
+}
+
+// Returns the number of pages currently owned by |sequence|.
+static iree_host_size_t iree_paged_kv_allocator_sequence_page_count(
+    const iree_paged_kv_allocator_t* allocator, int64_t sequence) {
+  iree_host_size_t count = 0;
+  for (iree_host_size_t i = 0; i < allocator->page_count; ++i) {
+    if (allocator->page_owners[i] == sequence) ++count;
+  }
+  return count;
+}
+
+//===----------------------------------------------------------------------===//
+// VM module interface implementation
+//===----------------------------------------------------------------------===//
+
+namespace {
+
+using namespace iree;
+
+// Per-context module state.
+class CustomModuleState final {
+ public:
+  explicit CustomModuleState(vm::ref<iree_hal_device_t> device,
+                             iree_allocator_t host_allocator)
+      : device_(std::move(device)), host_allocator_(host_allocator) {}
+  ~CustomModuleState() = default;
+
+  // Creates a new allocator for a pool of |page_count| pages each holding
+  // |page_tokens| tokens.
+  StatusOr<vm::ref<iree_paged_kv_allocator_t>> AllocatorCreate(
+      int64_t page_count, int64_t page_tokens) {
+    if (page_count < 0 || page_tokens < 0) {
+      return iree_make_status(IREE_STATUS_INVALID_ARGUMENT,
+                              "negative page pool dimensions");
+    }
+    vm::ref<iree_paged_kv_allocator_t> allocator;
+    IREE_RETURN_IF_ERROR(iree_paged_kv_allocator_create(
+        (iree_host_size_t)page_count, (iree_host_size_t)page_tokens,
+        host_allocator_, &allocator));
+    return std::move(allocator);
+  }
+
+  // Ensures |sequence| owns enough pages to hold |length| tokens. New pages
+  // are appended to the end of the sequence's page table and existing pages
+  // never move so previously written tokens remain valid.
+  Status Reserve(const vm::ref<iree_paged_kv_allocator_t> allocator,
+                 int64_t sequence, int64_t length) {
+    if (!allocator) {
+      return iree_make_status(IREE_STATUS_INVALID_ARGUMENT, "null allocator");
+    }
+    if (sequence < 0 || length < 0) {
+      return iree_make_status(IREE_STATUS_INVALID_ARGUMENT,
+                              "invalid sequence %" PRId64 " length %" PRId64,
+                              sequence, length);
+    }
+    iree_host_size_t required_pages =
+        ((iree_host_size_t)length + allocator->page_tokens - 1) /
+        allocator->page_tokens;
+    iree_host_size_t owned_pages =
+        iree_paged_kv_allocator_sequence_page_count(allocator.get(), sequence);
+    if (required_pages <= owned_pages) return OkStatus();
+    if (required_pages - owned_pages > allocator->free_count) {
+      return iree_make_status(
+          IREE_STATUS_RESOURCE_EXHAUSTED,
+          "sequence %" PRId64 " requires %zu more pages but only %zu are free",
+          sequence, required_pages - owned_pages, allocator->free_count);
+    }
+    for (iree_host_size_t i = owned_pages; i < required_pages; ++i) {
+      int32_t page = allocator->free_pages[--allocator->free_count];
+      allocator->page_owners[page] = sequence;
+      allocator->page_positions[page] = (int32_t)i;
+      fprintf(stdout, "ALLOCATE sequence %" PRId64 " page %d\n", sequence,
+              page);
+    }
+    fflush(stdout);
+    return OkStatus();
+  }
+
+  // Returns all pages owned by |sequence| to the pool.
+  Status Release(const vm::ref<iree_paged_kv_allocator_t> allocator,
+                 int64_t sequence) {
+    if (!allocator) {
+      return iree_make_status(IREE_STATUS_INVALID_ARGUMENT, "null allocator");
+    }
+    iree_host_size_t released_pages = 0;
+    for (iree_host_size_t i = 0; i < allocator->page_count; ++i) {
+      if (allocator->page_owners[i] != sequence) continue;
+      allocator->page_owners[i] = -1;
+      allocator->page_positions[i] = 0;
+      allocator->free_pages[allocator->free_count++] = (int32_t)i;
+      ++released_pages;
+    }
+    fprintf(stdout, "RELEASE sequence %" PRId64 " pages %zu free %zu\n",
+            sequence, released_pages, allocator->free_count);
+    fflush(stdout);
+    return OkStatus();
+  }
+
+  // Returns the number of pages available for allocation.
+  StatusOr<int64_t> FreePageCount(
+      const vm::ref<iree_paged_kv_allocator_t> allocator) {
+    if (!allocator) {
+      return iree_make_status(IREE_STATUS_INVALID_ARGUMENT, "null allocator");
+    }
+    return static_cast<int64_t>(allocator->free_count);
+  }
+
+  // Returns a [sequences.length, max_pages] tensor<?x?xi32> with the ordered
+  // page ordinals of each sequence in |sequences_view|. Rows are padded with
+  // page 0; programs are expected to mask tokens beyond each sequence length.
+  StatusOr<vm::ref<iree_hal_buffer_view_t>> PageTable(
+      const vm::ref<iree_paged_kv_allocator_t> allocator,
+      const vm::ref<iree_hal_buffer_view_t> sequences_view,
+      int64_t max_pages) {
+    if (!allocator) {
+      return iree_make_status(IREE_STATUS_INVALID_ARGUMENT, "null allocator");
+    }
+    if (max_pages < 0) {
+      return iree_make_status(IREE_STATUS_INVALID_ARGUMENT,
+                              "negative max page count");
+    }
+    if (!sequences_view ||
+        iree_hal_buffer_view_element_type(sequences_view.get()) !=
+            IREE_HAL_ELEMENT_TYPE_INT_64 ||
+        iree_hal_buffer_view_shape_rank(sequences_view.get()) != 1) {
+      return iree_make_status(IREE_STATUS_INVALID_ARGUMENT,
+                              "sequences must be a tensor<?xi64>");
+    }
+
+    // Read the sequence IDs back to the host. This is a synchronous call and
+    // the runtime has already waited for the input to be available.
+    iree_hal_dim_t sequence_count =
+        iree_hal_buffer_view_shape_dim(sequences_view.get(), 0);
+    std::vector<int64_t> sequences(sequence_count);
+    IREE_RETURN_IF_ERROR(iree_hal_buffer_map_read(
+        iree_hal_buffer_view_buffer(sequences_view.get()), 0, sequences.data(),
+        sequences.size() * sizeof(int64_t)));
+
+    // Scatter each owned page into its sequence row; pages beyond max_pages
+    // are dropped as the program cannot address them.
+    std::vector<int32_t> table(sequence_count * max_pages, 0);
+    for (iree_hal_dim_t i = 0; i < sequence_count; ++i) {
+      for (iree_host_size_t page = 0; page < allocator->page_count; ++page) {
+        if (allocator->page_owners[page] != sequences[i]) continue;
+        int32_t position = allocator->page_positions[page];
+        if (position >= max_pages) continue;
+        table[i * max_pages + position] = (int32_t)page;
+      }
+    }
+
+    // Upload the table to a new device buffer. The table is small so we pass
+    // it as initial data instead of mapping the buffer.
+    iree_hal_allocator_t* device_allocator =
+        iree_hal_device_allocator(device_.get());
+    iree_hal_buffer_params_t buffer_params = {
+        /*.usage=*/IREE_HAL_BUFFER_USAGE_DEFAULT |
+            IREE_HAL_BUFFER_USAGE_MAPPING,
+        /*.access=*/IREE_HAL_MEMORY_ACCESS_ALL,
+        /*.type=*/IREE_HAL_MEMORY_TYPE_OPTIMAL_FOR_DEVICE |
+            IREE_HAL_MEMORY_TYPE_HOST_VISIBLE,
+        /*.queue_affinity=*/IREE_HAL_QUEUE_AFFINITY_ANY,
+        /*.min_alignment=*/64,
+    };
+    const iree_hal_dim_t shape[2] = {sequence_count,
+                                     (iree_hal_dim_t)max_pages};
+    vm::ref<iree_hal_buffer_view_t> table_view;
+    IREE_RETURN_IF_ERROR(iree_hal_buffer_view_allocate_buffer(
+        device_allocator, IREE_ARRAYSIZE(shape), shape,
+        IREE_HAL_ELEMENT_TYPE_INT_32, IREE_HAL_ENCODING_TYPE_DENSE_ROW_MAJOR,
+        buffer_params,
+        iree_make_const_byte_span(table.data(),
+                                  table.size() * sizeof(int32_t)),
+        &table_view));
+    return std::move(table_view);
+  }
+
+ private:
+  // HAL device used for allocating page tables.
+  vm::ref<iree_hal_device_t> device_;
+
+  // Allocator that the caller requested we use for any allocations we need to
+  // perform during operation.
+  iree_allocator_t host_allocator_;
+};
+
+// Function table mapping imported function names to their implementation.
+static const vm::NativeFunction<CustomModuleState> kCustomModuleFunctions[] = {
+    vm::MakeNativeFunction("allocator.create",
+                           &CustomModuleState::AllocatorCreate),
+    vm::MakeNativeFunction("reserve", &CustomModuleState::Reserve),
+    vm::MakeNativeFunction("release", &CustomModuleState::Release),
+    vm::MakeNativeFunction("free_page_count",
+                           &CustomModuleState::FreePageCount),
+    vm::MakeNativeFunction("page_table", &CustomModuleState::PageTable),
+};
+
+// The module instance that will be allocated and reused across contexts.
+class CustomModule final : public vm::NativeModule<CustomModuleState> {
+ public:
+  using vm::NativeModule<CustomModuleState>::NativeModule;
+
+  void SetDevice(vm::ref<iree_hal_device_t> device) {
+    device_ = std::move(device);
+  }
+
+  // Creates per-context state when the module is added to a new context.
+  // May be called from any thread.
+  StatusOr<std::unique_ptr<CustomModuleState>> CreateState(
+      iree_allocator_t host_allocator) override {
+    auto state = std::make_unique<CustomModuleState>(vm::retain_ref(device_),
+                                                     host_allocator);
+    return state;
+  }
+
+ private:
+  vm::ref<iree_hal_device_t> device_;
+};
+
+}  // namespace
+
+// Note that while we are using C++ bindings internally we still expose the
+// module as a C instance. This hides the details of our implementation.
+extern "C" iree_status_t iree_custom_module_paged_kv_create(
+    iree_vm_instance_t* instance, iree_hal_device_t* device,
+    iree_allocator_t host_allocator, iree_vm_module_t** out_module) {
+  IREE_ASSERT_ARGUMENT(out_module);
+  *out_module = NULL;
+  auto module = std::make_unique<CustomModule>(
+      "paged_kv", /*version=*/0, instance, host_allocator,
+      iree::span<const vm::NativeFunction<CustomModuleState>>(
+          kCustomModuleFunctions));
+  module->SetDevice(vm::retain_ref(device));
+  *out_module = module.release()->interface();
+  return iree_ok_status();
+}
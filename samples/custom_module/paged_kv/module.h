@@ -0,0 +1,46 @@
+// Copyright 2023 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#ifndef IREE_SAMPLES_CUSTOM_MODULE_PAGED_KV_MODULE_H_
+#define IREE_SAMPLES_CUSTOM_MODULE_PAGED_KV_MODULE_H_
+
+#include <stdint.h>
+
+#include "iree/base/api.h"
+#include "iree/hal/api.h"
+#include "iree/vm/api.h"
+
+// A fixed-size pool of KV-cache pages shared by any number of sequences.
+typedef struct iree_paged_kv_allocator_t iree_paged_kv_allocator_t;
+IREE_VM_DECLARE_TYPE_ADAPTERS(iree_paged_kv_allocator,
+                              iree_paged_kv_allocator_t);
+
+#ifdef __cplusplus
+extern "C" {
+#endif  // __cplusplus
+
+// Creates a new !paged_kv.allocator managing |page_count| pages that each hold
+// |page_tokens| tokens. The allocator only tracks page ownership; the page
+// storage itself lives in the compiled program.
+iree_status_t iree_paged_kv_allocator_create(
+    iree_host_size_t page_count, iree_host_size_t page_tokens,
+    iree_allocator_t host_allocator, iree_paged_kv_allocator_t** out_allocator);
+
+// Registers types provided by the custom module.
+iree_status_t iree_custom_module_paged_kv_register_types(
+    iree_vm_instance_t* instance);
+
+// Creates a native custom module that can be reused in multiple contexts.
+// Page tables are returned as buffer views allocated from |device|.
+iree_status_t iree_custom_module_paged_kv_create(
+    iree_vm_instance_t* instance, iree_hal_device_t* device,
+    iree_allocator_t host_allocator, iree_vm_module_t** out_module);
+
+#ifdef __cplusplus
+}  // extern "C"
+#endif  // __cplusplus
+
+#endif  // IREE_SAMPLES_CUSTOM_MODULE_PAGED_KV_MODULE_H_
@@ -0,0 +1,223 @@
+// RUN: iree-compile %s --iree-hal-target-backends=llvm-cpu | custom-module-paged-kv-run - example.main | FileCheck %s
+
+module @example {
+  //===--------------------------------------------------------------------===//
+  // Imports
+  //===--------------------------------------------------------------------===//
+  // External function declarations for the methods implemented in the custom
+  // module C++ file. Note that they are prefixed with the `paged_kv.` module
+  // name.
+
+  // Creates an allocator for a pool of page_count pages of page_tokens tokens.
+  func.func private @paged_kv.allocator.create(i64, i64) -> !paged_kv.allocator
+
+  // Ensures the sequence owns enough pages to hold the given token length.
+  func.func private @paged_kv.reserve(!paged_kv.allocator, i64, i64)
+
+  // Returns all pages of the sequence to the pool.
+  func.func private @paged_kv.release(!paged_kv.allocator, i64)
+
+  // Returns the [sequences, max_pages] page ordinals of each sequence.
+  func.func private @paged_kv.page_table(!paged_kv.allocator, tensor<?xi64>, i64) -> tensor<?x?xi32>
+
+  //===--------------------------------------------------------------------===//
+  // KV-cache page pool
+  //===--------------------------------------------------------------------===//
+  // The program owns the page storage and the custom module only decides which
+  // pages belong to which sequence. Pages are [page_tokens, head_dim] and there
+  // are 8 pages of 4 tokens shared by all sequences. Sequences can be up to 16
+  // tokens (4 pages) long.
+
+  util.global private mutable @k_pages = dense<0.0> : tensor<8x4x4xf32>
+  util.global private mutable @v_pages = dense<0.0> : tensor<8x4x4xf32>
+
+  // Returns the page table row for a single sequence.
+  func.func private @lookup_pages(%allocator: !paged_kv.allocator, %sequence: i64) -> tensor<4xi32> {
+    %max_pages = arith.constant 4 : i64
+    %sequences = tensor.from_elements %sequence : tensor<1xi64>
+    %sequences_dyn = tensor.cast %sequences : tensor<1xi64> to tensor<?xi64>
+    %table_dyn = call @paged_kv.page_table(%allocator, %sequences_dyn, %max_pages) : (!paged_kv.allocator, tensor<?xi64>, i64) -> tensor<?x?xi32>
+    %table = tensor.cast %table_dyn : tensor<?x?xi32> to tensor<1x4xi32>
+    %row = tensor.collapse_shape %table [[0, 1]] : tensor<1x4xi32> into tensor<4xi32>
+    return %row : tensor<4xi32>
+  }
+
+  // Appends the token at |position| to |sequence| with all key and value
+  // components set to |value|. Grows the sequence by a page when the previous
+  // page is full and scatters the token into its page slot.
+  func.func private @append(%allocator: !paged_kv.allocator, %sequence: i64, %position: index, %value: f32) {
+    %c1 = arith.constant 1 : index
+    %c4 = arith.constant 4 : index
+    %length = arith.addi %position, %c1 : index
+    %length_i64 = arith.index_cast %length : index to i64
+    call @paged_kv.reserve(%allocator, %sequence, %length_i64) : (!paged_kv.allocator, i64, i64) -> ()
+    %pages = call @lookup_pages(%allocator, %sequence) : (!paged_kv.allocator, i64) -> tensor<4xi32>
+    %page_index = arith.divui %position, %c4 : index
+    %slot = arith.remui %position, %c4 : index
+    %page_i32 = tensor.extract %pages[%page_index] : tensor<4xi32>
+    %page = arith.index_cast %page_i32 : i32 to index
+    %entry = tensor.splat %value : tensor<1x1x4xf32>
+    %k_pages = util.global.load @k_pages : tensor<8x4x4xf32>
+    %k_pages_new = tensor.insert_slice %entry into %k_pages[%page, %slot, 0] [1, 1, 4] [1, 1, 1] : tensor<1x1x4xf32> into tensor<8x4x4xf32>
+    util.global.store %k_pages_new, @k_pages : tensor<8x4x4xf32>
+    %v_pages = util.global.load @v_pages : tensor<8x4x4xf32>
+    %v_pages_new = tensor.insert_slice %entry into %v_pages[%page, %slot, 0] [1, 1, 4] [1, 1, 1] : tensor<1x1x4xf32> into tensor<8x4x4xf32>
+    util.global.store %v_pages_new, @v_pages : tensor<8x4x4xf32>
+    return
+  }
+
+  // Single-head attention of |query| against the first |length| tokens of
+  // |sequence|. Keys and values are gathered out of the shared page pool
+  // through the sequence page table so the sequence pages need not be
+  // contiguous; slots past |length| (including page table padding) are masked.
+  func.func private @attention(%allocator: !paged_kv.allocator, %sequence: i64, %length: index, %query: tensor<4xf32>) -> tensor<4xf32> {
+    %cst_zero = arith.constant 0.0 : f32
+    %cst_min = arith.constant -1.0e+30 : f32
+    %cst_scale = arith.constant 0.5 : f32
+    %pages = call @lookup_pages(%allocator, %sequence) : (!paged_kv.allocator, i64) -> tensor<4xi32>
+    %k_pages = util.global.load @k_pages : tensor<8x4x4xf32>
+    %v_pages = util.global.load @v_pages : tensor<8x4x4xf32>
+
+    // Gather [tokens, head_dim] keys and values.
+    %keys_empty = tensor.empty() : tensor<16x4xf32>
+    %values_empty = tensor.empty() : tensor<16x4xf32>
+    %kv:2 = linalg.generic {
+      indexing_maps = [affine_map<(t, d) -> (t, d)>, affine_map<(t, d) -> (t, d)>],
+      iterator_types = ["parallel", "parallel"]
+    } outs(%keys_empty, %values_empty : tensor<16x4xf32>, tensor<16x4xf32>) {
+    ^bb0(%key_out: f32, %value_out: f32):
+      %c4 = arith.constant 4 : index
+      %t = linalg.index 0 : index
+      %d = linalg.index 1 : index
+      %page_index = arith.divui %t, %c4 : index
+      %slot = arith.remui %t, %c4 : index
+      %page_i32 = tensor.extract %pages[%page_index] : tensor<4xi32>
+      %page = arith.index_cast %page_i32 : i32 to index
+      %key = tensor.extract %k_pages[%page, %slot, %d] : tensor<8x4x4xf32>
+      %value = tensor.extract %v_pages[%page, %slot, %d] : tensor<8x4x4xf32>
+      linalg.yield %key, %value : f32, f32
+    } -> (tensor<16x4xf32>, tensor<16x4xf32>)
+
+    // scores[t] = q . k[t] scaled by 1/sqrt(head_dim).
+    %scores_empty = tensor.empty() : tensor<16xf32>
+    %scores_init = linalg.fill ins(%cst_zero : f32) outs(%scores_empty : tensor<16xf32>) -> tensor<16xf32>
+    %scores = linalg.generic {
+      indexing_maps = [affine_map<(t, d) -> (d)>, affine_map<(t, d) -> (t, d)>, affine_map<(t, d) -> (t)>],
+      iterator_types = ["parallel", "reduction"]
+    } ins(%query, %kv#0 : tensor<4xf32>, tensor<16x4xf32>) outs(%scores_init : tensor<16xf32>) {
+    ^bb0(%q: f32, %k: f32, %acc: f32):
+      %mul = arith.mulf %q, %k : f32
+      %add = arith.addf %acc, %mul : f32
+      linalg.yield %add : f32
+    } -> tensor<16xf32>
+    %masked = linalg.generic {
+      indexing_maps = [affine_map<(t) -> (t)>, affine_map<(t) -> (t)>],
+      iterator_types = ["parallel"]
+    } ins(%scores : tensor<16xf32>) outs(%scores_empty : tensor<16xf32>) {
+    ^bb0(%score: f32, %out: f32):
+      %t = linalg.index 0 : index
+      %valid = arith.cmpi ult, %t, %length : index
+      %scaled = arith.mulf %score, %cst_scale : f32
+      %result = arith.select %valid, %scaled, %cst_min : f32
+      linalg.yield %result : f32
+    } -> tensor<16xf32>
+
+    // Softmax over the valid tokens.
+    %scalar_empty = tensor.empty() : tensor<f32>
+    %max_init = linalg.fill ins(%cst_min : f32) outs(%scalar_empty : tensor<f32>) -> tensor<f32>
+    %max = linalg.generic {
+      indexing_maps = [affine_map<(t) -> (t)>, affine_map<(t) -> ()>],
+      iterator_types = ["reduction"]
+    } ins(%masked : tensor<16xf32>) outs(%max_init : tensor<f32>) {
+    ^bb0(%score: f32, %acc: f32):
+      %result = arith.maxf %score, %acc : f32
+      linalg.yield %result : f32
+    } -> tensor<f32>
+    %exp = linalg.generic {
+      indexing_maps = [affine_map<(t) -> (t)>, affine_map<(t) -> ()>, affine_map<(t) -> (t)>],
+      iterator_types = ["parallel"]
+    } ins(%masked, %max : tensor<16xf32>, tensor<f32>) outs(%scores_empty : tensor<16xf32>) {
+    ^bb0(%score: f32, %max_score: f32, %out: f32):
+      %sub = arith.subf %score, %max_score : f32
+      %result = math.exp %sub : f32
+      linalg.yield %result : f32
+    } -> tensor<16xf32>
+    %sum_init = linalg.fill ins(%cst_zero : f32) outs(%scalar_empty : tensor<f32>) -> tensor<f32>
+    %sum = linalg.generic {
+      indexing_maps = [affine_map<(t) -> (t)>, affine_map<(t) -> ()>],
+      iterator_types = ["reduction"]
+    } ins(%exp : tensor<16xf32>) outs(%sum_init : tensor<f32>) {
+    ^bb0(%weight: f32, %acc: f32):
+      %result = arith.addf %weight, %acc : f32
+      linalg.yield %result : f32
+    } -> tensor<f32>
+
+    // output[d] = sum_t softmax[t] * v[t, d].
+    %output_empty = tensor.empty() : tensor<4xf32>
+    %output_init = linalg.fill ins(%cst_zero : f32) outs(%output_empty : tensor<4xf32>) -> tensor<4xf32>
+    %weighted = linalg.generic {
+      indexing_maps = [affine_map<(t, d) -> (t)>, affine_map<(t, d) -> (t, d)>, affine_map<(t, d) -> (d)>],
+      iterator_types = ["reduction", "parallel"]
+    } ins(%exp, %kv#1 : tensor<16xf32>, tensor<16x4xf32>) outs(%output_init : tensor<4xf32>) {
+    ^bb0(%weight: f32, %v: f32, %acc: f32):
+      %mul = arith.mulf %weight, %v : f32
+      %add = arith.addf %acc, %mul : f32
+      linalg.yield %add : f32
+    } -> tensor<4xf32>
+    %output = linalg.generic {
+      indexing_maps = [affine_map<(d) -> (d)>, affine_map<(d) -> ()>, affine_map<(d) -> (d)>],
+      iterator_types = ["parallel"]
+    } ins(%weighted, %sum : tensor<4xf32>, tensor<f32>) outs(%output_empty : tensor<4xf32>) {
+    ^bb0(%numerator: f32, %denominator: f32, %out: f32):
+      %result = arith.divf %numerator, %denominator : f32
+      linalg.yield %result : f32
+    } -> tensor<4xf32>
+    return %output : tensor<4xf32>
+  }
+
+  //===--------------------------------------------------------------------===//
+  // Sample methods
+  //===--------------------------------------------------------------------===//
+
+  // CHECK-LABEL: INVOKE BEGIN example.main
+  func.func @main() -> tensor<2x4xf32> {
+    %c0 = arith.constant 0 : index
+    %c1 = arith.constant 1 : index
+    %c6 = arith.constant 6 : index
+    %page_count = arith.constant 8 : i64
+    %page_tokens = arith.constant 4 : i64
+    %sequence0 = arith.constant 0 : i64
+    %sequence1 = arith.constant 1 : i64
+    %value0 = arith.constant 1.0 : f32
+    %value1 = arith.constant 2.0 : f32
+    %allocator = call @paged_kv.allocator.create(%page_count, %page_tokens) : (i64, i64) -> !paged_kv.allocator
+
+    // Decode two sequences in lockstep so their pages interleave in the pool.
+    // CHECK: ALLOCATE sequence 0 page 0
+    // CHECK-NEXT: ALLOCATE sequence 1 page 1
+    // CHECK-NEXT: ALLOCATE sequence 0 page 2
+    // CHECK-NEXT: ALLOCATE sequence 1 page 3
+    scf.for %position = %c0 to %c6 step %c1 {
+      call @append(%allocator, %sequence0, %position, %value0) : (!paged_kv.allocator, i64, index, f32) -> ()
+      call @append(%allocator, %sequence1, %position, %value1) : (!paged_kv.allocator, i64, index, f32) -> ()
+    }
+
+    %query = arith.constant dense<[1.0, 0.5, 0.25, 0.125]> : tensor<4xf32>
+    %output0 = call @attention(%allocator, %sequence0, %c6, %query) : (!paged_kv.allocator, i64, index, tensor<4xf32>) -> tensor<4xf32>
+    %output1 = call @attention(%allocator, %sequence1, %c6, %query) : (!paged_kv.allocator, i64, index, tensor<4xf32>) -> tensor<4xf32>
+
+    // Finished sequences return their pages to the pool.
+    // CHECK: RELEASE sequence 0 pages 2 free 6
+    // CHECK-NEXT: RELEASE sequence 1 pages 2 free 8
+    call @paged_kv.release(%allocator, %sequence0) : (!paged_kv.allocator, i64) -> ()
+    call @paged_kv.release(%allocator, %sequence1) : (!paged_kv.allocator, i64) -> ()
+
+    %result_empty = tensor.empty() : tensor<2x4xf32>
+    %result0 = tensor.insert_slice %output0 into %result_empty[0, 0] [1, 4] [1, 1] : tensor<4xf32> into tensor<2x4xf32>
+    %result = tensor.insert_slice %output1 into %result0[1, 0] [1, 4] [1, 1] : tensor<4xf32> into tensor<2x4xf32>
+
+    // CHECK: MATCHED!
+    return %result : tensor<2x4xf32>
+  }
+  // CHECK-NEXT: INVOKE END
+}
@@ -31,12 +31,13 @@ iree_status_t create_device_with_static_loader(iree_allocator_t host_allocator,
   iree_hal_sync_device_params_t params;
   iree_hal_sync_device_params_initialize(&params);
 
-  // Register the statically linked executable library.
-  const iree_hal_executable_library_query_fn_t libraries[] = {
-      simple_mul_dispatch_0_library_query,
+  // Register the statically linked executable library. The library is only
+  // queried once an executable using it is loaded.
+  static const iree_hal_static_library_registration_t libraries[] = {
+      IREE_STATIC_LIBRARY_SIMPLE_MUL_DISPATCH_0_REGISTRATION,
   };
   iree_hal_executable_loader_t* library_loader = NULL;
-  iree_status_t status = iree_hal_static_library_loader_create(
+  iree_status_t status = iree_hal_static_library_loader_create_lazy(
       IREE_ARRAYSIZE(libraries), libraries,
       iree_hal_executable_import_provider_null(), host_allocator,
       &library_loader);
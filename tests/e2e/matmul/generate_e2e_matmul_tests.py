@@ -35,6 +35,7 @@ class ShapesId(enum.Enum):
   SMALL = "small"
   LARGE = "large"
   GPU_LARGE = "gpu_large"
+  BENCHMARK = "benchmark"
 
 
 # Enumerates of the collections of compilation info that we can generate tests
@@ -138,13 +139,41 @@ def get_test_shapes(shapes_id: ShapesId):
     ]
   if shapes_id == ShapesId.GPU_LARGE:
     return [TestShape(m=256, k=128, n=512)]
+  if shapes_id == ShapesId.BENCHMARK:
+    # Shape sweep for iree-e2e-matmul-test --benchmark_repetitions=N, which
+    # reports GFLOP/s per shape. Not used by any test target. Compile the
+    # generated code with the same flags as the test suite of interest (e.g.
+    # --iree-flow-enable-data-tiling for the mmt4d path) to measure the path
+    # that models take. Shapes are still checked against the reference matmul
+    # before they are timed, so the largest ones are kept around 1G MACs.
+    return [
+        # square matrices, aligned and not aligned to common tile sizes.
+        TestShape(m=256, k=256, n=256),
+        TestShape(m=512, k=512, n=512),
+        TestShape(m=1024, k=1024, n=1024),
+        TestShape(m=255, k=255, n=255),
+        TestShape(m=511, k=513, n=509),
+        TestShape(m=1021, k=1023, n=1025),
+        # odd rectangular matrices.
+        TestShape(m=127, k=1031, n=383),
+        TestShape(m=1000, k=77, n=1000),
+        # skinny matrices as found in batch-1 inference.
+        TestShape(m=1, k=4096, n=4096),  # vector*matrix
+        TestShape(m=4096, k=4096, n=1),  # matrix*vector
+        TestShape(m=2, k=2048, n=2048),
+        TestShape(m=4, k=2048, n=2048),
+        TestShape(m=16, k=2048, n=2048),
+        TestShape(m=2048, k=2048, n=16),
+        # large K, small M and N as in reductions.
+        TestShape(m=64, k=16384, n=64),
+    ]
   raise ValueError(shapes_id)
 
 
 # Returns the list of Dynamicity's to use for the collection of shapes
 # identified by shapes_id.
 def get_dynamicities(shapes_id: ShapesId):
-  if shapes_id == ShapesId.GPU_LARGE:
+  if shapes_id == ShapesId.GPU_LARGE or shapes_id == ShapesId.BENCHMARK:
     return [
         Dynamicity.STATIC,
     ]
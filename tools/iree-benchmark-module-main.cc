@@ -51,11 +51,27 @@
 // how the full program will run, though, and YMMV. Always verify timings with
 // an appropriate device-specific tool before trusting the more generic and
 // higher-level numbers from this tool.
-
+//
+// The benchmarks above are closed-loop: the next invocation is only issued
+// once the previous one completed and the reported latency never includes
+// time spent waiting to be serviced. To measure latency under a given load
+// --target_qps=N runs the --entry_function= open-loop instead: requests arrive
+// on a precomputed schedule (Poisson or fixed-rate, see --arrival_process=)
+// independent of completions and are served by --open_loop_concurrency=
+// contexts forked from the main one. Latency is measured from the scheduled
+// arrival of each request to its completion so queueing delay shows up in the
+// reported percentiles once the offered load exceeds what the device sustains.
+
+#include <algorithm>
 #include <array>
+#include <atomic>
+#include <chrono>
+#include <cmath>
 #include <cstdio>
 #include <iterator>
+#include <random>
 #include <string>
+#include <thread>
 #include <type_traits>
 #include <utility>
 #include <vector>
@@ -65,6 +81,7 @@
 #include "iree/base/internal/flags.h"
 #include "iree/base/tracing.h"
 #include "iree/hal/api.h"
+#include "iree/hal/local/local_executable.h"
 #include "iree/modules/hal/types.h"
 #include "iree/tooling/context_util.h"
 #include "iree/tooling/device_util.h"
@@ -90,7 +107,23 @@ IREE_FLAG(string, entry_function, "",
           "benchmarked and they are expected to not have input arguments.");
 
 IREE_FLAG(bool, print_statistics, false,
-          "Prints runtime statistics to stderr on exit.");
+          "Prints runtime statistics to stderr on exit, including per-export "
+          "timings of CPU executables.");
+
+IREE_FLAG(double, target_qps, 0.0,
+          "Runs --entry_function= open-loop with requests arriving at the "
+          "given rate (per second) instead of running the closed-loop "
+          "benchmarks. Reports latency percentiles and achieved throughput.");
+IREE_FLAG(string, arrival_process, "poisson",
+          "Arrival process of open-loop requests: 'poisson' for exponentially "
+          "distributed inter-arrival times or 'fixed' for a constant "
+          "interval of 1/--target_qps=.");
+IREE_FLAG(int32_t, open_loop_concurrency, 1,
+          "Number of contexts serving open-loop requests concurrently.");
+IREE_FLAG(int32_t, open_loop_requests, 1000,
+          "Total number of requests issued in open-loop mode.");
+IREE_FLAG(int32_t, open_loop_seed, 0,
+          "Seed of the open-loop arrival schedule.");
 
 // TODO(benvanik): move --function_input= flag into a util.
 static iree_status_t parse_function_input(iree_string_view_t flag_name,
@@ -125,6 +158,8 @@ IREE_FLAG_CALLBACK(
     "  2x2xi32=@some/file.bin\n"
     "numpy npy files (from numpy.save) can be read to provide 1+ values:\n"
     "  @some.npy\n"
+    "as can uncompressed npz archives (from numpy.savez) in archive order:\n"
+    "  @some.npz\n"
     "Each occurrence of the flag indicates an input in the order they were\n"
     "specified on the command line.");
 
@@ -425,6 +460,219 @@ void RegisterDispatchBenchmark(const std::string& function_name,
                                   : benchmark::kMicrosecond);
 }
 
+// Returns the arrival times of |request_count| open-loop requests relative
+// to the start of the run. Poisson arrivals have exponentially distributed
+// inter-arrival times with mean 1/|qps|.
+static std::vector<std::chrono::nanoseconds> GenerateArrivalSchedule(
+    double qps, bool poisson, int32_t request_count, uint32_t seed) {
+  std::vector<std::chrono::nanoseconds> schedule;
+  schedule.reserve(request_count);
+  std::mt19937_64 generator(seed);
+  std::exponential_distribution<double> interval_distribution(qps);
+  double arrival_s = 0.0;
+  for (int32_t i = 0; i < request_count; ++i) {
+    schedule.push_back(std::chrono::nanoseconds(
+        static_cast<int64_t>(arrival_s * 1e9)));
+    arrival_s += poisson ? interval_distribution(generator) : 1.0 / qps;
+  }
+  return schedule;
+}
+
+// Synchronously performs a single open-loop request. Functions using the
+// coarse-fences ABI are passed a null wait fence and a signal fence on
+// |semaphore| that is waited on before returning.
+static iree_status_t InvokeOpenLoopRequest(iree_vm_context_t* context,
+                                           iree_vm_function_t function,
+                                           iree_vm_list_t* common_inputs,
+                                           iree_hal_semaphore_t* semaphore,
+                                           uint64_t signal_value,
+                                           iree_vm_list_t* outputs) {
+  IREE_TRACE_SCOPE0("OpenLoopRequest");
+  iree_allocator_t host_allocator = iree_allocator_system();
+  if (!semaphore) {
+    IREE_RETURN_IF_ERROR(iree_vm_invoke(context, function,
+                                        IREE_VM_INVOCATION_FLAG_NONE,
+                                        /*policy=*/nullptr, common_inputs,
+                                        outputs, host_allocator));
+    return iree_vm_list_resize(outputs, 0);
+  }
+
+  vm::ref<iree_vm_list_t> inputs;
+  if (common_inputs) {
+    IREE_RETURN_IF_ERROR(
+        iree_vm_list_clone(common_inputs, host_allocator, &inputs));
+  } else {
+    IREE_RETURN_IF_ERROR(iree_vm_list_create(/*element_type=*/nullptr, 2,
+                                             host_allocator, &inputs));
+  }
+  vm::ref<iree_hal_fence_t> wait_fence;
+  vm::ref<iree_hal_fence_t> signal_fence;
+  IREE_RETURN_IF_ERROR(iree_hal_fence_create_at(semaphore, signal_value,
+                                                host_allocator, &signal_fence));
+  IREE_RETURN_IF_ERROR(iree_vm_list_push_ref_move(inputs.get(), wait_fence));
+  IREE_RETURN_IF_ERROR(
+      iree_vm_list_push_ref_retain(inputs.get(), signal_fence));
+  IREE_RETURN_IF_ERROR(iree_vm_invoke(context, function,
+                                      IREE_VM_INVOCATION_FLAG_NONE,
+                                      /*policy=*/nullptr, inputs.get(),
+                                      outputs, host_allocator));
+  IREE_RETURN_IF_ERROR(
+      iree_hal_fence_wait(signal_fence.get(), iree_infinite_timeout()));
+  return iree_vm_list_resize(outputs, 0);
+}
+
+// Returns the |percentile| (in [0, 100]) of the ascending |sorted_values|
+// using the nearest-rank method.
+static double NearestRankPercentile(const std::vector<double>& sorted_values,
+                                    double percentile) {
+  size_t rank = static_cast<size_t>(
+      std::ceil(percentile / 100.0 * sorted_values.size()));
+  return sorted_values[std::min(std::max(rank, size_t{1}),
+                                sorted_values.size()) -
+                       1];
+}
+
+// Issues --open_loop_requests= invocations of |function| on an arrival
+// schedule independent of their completion and prints the observed latency
+// distribution along with the achieved throughput.
+//
+// Each worker thread owns a context forked from |context| and pulls the next
+// scheduled request once it is idle, sleeping until the request arrives if it
+// is early. When all workers are busy requests queue up and the time spent
+// waiting is attributed to their latency since it is measured from the
+// scheduled arrival rather than from when the request started executing.
+static iree_status_t RunOpenLoop(const std::string& function_name,
+                                 iree_hal_device_t* device,
+                                 iree_vm_context_t* context,
+                                 iree_vm_function_t function, bool is_async,
+                                 iree_vm_list_t* inputs) {
+  IREE_TRACE_SCOPE0("RunOpenLoop");
+  iree_allocator_t host_allocator = iree_allocator_system();
+
+  iree_string_view_t arrival_process = iree_make_cstring_view(
+      FLAG_arrival_process);
+  bool poisson = iree_string_view_equal(arrival_process, IREE_SV("poisson"));
+  if (!poisson && !iree_string_view_equal(arrival_process, IREE_SV("fixed"))) {
+    return iree_make_status(IREE_STATUS_INVALID_ARGUMENT,
+                            "unsupported arrival process '%s'; expected "
+                            "'poisson' or 'fixed'",
+                            FLAG_arrival_process);
+  }
+  if (FLAG_open_loop_concurrency < 1 || FLAG_open_loop_requests < 1) {
+    return iree_make_status(IREE_STATUS_INVALID_ARGUMENT,
+                            "open-loop concurrency and request count must be "
+                            "positive");
+  }
+  const std::vector<std::chrono::nanoseconds> schedule =
+      GenerateArrivalSchedule(FLAG_target_qps, poisson,
+                              FLAG_open_loop_requests,
+                              static_cast<uint32_t>(FLAG_open_loop_seed));
+
+  // Everything a worker needs is created upfront so that setup costs are not
+  // attributed to the first requests.
+  struct Worker {
+    vm::ref<iree_vm_context_t> context;
+    vm::ref<iree_vm_list_t> inputs;
+    vm::ref<iree_vm_list_t> outputs;
+    vm::ref<iree_hal_semaphore_t> semaphore;
+  };
+  std::vector<Worker> workers(FLAG_open_loop_concurrency);
+  for (Worker& worker : workers) {
+    IREE_RETURN_IF_ERROR(
+        iree_vm_context_fork(context, host_allocator, &worker.context));
+    if (inputs) {
+      IREE_RETURN_IF_ERROR(
+          iree_vm_list_clone(inputs, host_allocator, &worker.inputs));
+    }
+    IREE_RETURN_IF_ERROR(iree_vm_list_create(/*element_type=*/nullptr, 16,
+                                             host_allocator, &worker.outputs));
+    if (is_async) {
+      IREE_RETURN_IF_ERROR(
+          iree_hal_semaphore_create(device, 0ull, &worker.semaphore));
+    }
+  }
+
+  std::vector<double> latencies_ns(schedule.size());
+  std::atomic<size_t> next_request{0};
+  std::atomic<bool> failed{false};
+  std::vector<iree_status_t> worker_statuses(workers.size(), iree_ok_status());
+  const auto start_time = std::chrono::steady_clock::now();
+  std::vector<std::thread> threads;
+  for (size_t i = 0; i < workers.size(); ++i) {
+    threads.emplace_back([&, i]() {
+      Worker& worker = workers[i];
+      uint64_t signal_value = 0;
+      while (!failed.load(std::memory_order_relaxed)) {
+        size_t request = next_request.fetch_add(1, std::memory_order_relaxed);
+        if (request >= schedule.size()) break;
+        const auto arrival_time = start_time + schedule[request];
+        std::this_thread::sleep_until(arrival_time);
+        iree_status_t status = InvokeOpenLoopRequest(
+            worker.context.get(), function, worker.inputs.get(),
+            worker.semaphore.get(), ++signal_value, worker.outputs.get());
+        if (!iree_status_is_ok(status)) {
+          worker_statuses[i] = status;
+          failed.store(true, std::memory_order_relaxed);
+          break;
+        }
+        latencies_ns[request] = std::chrono::duration<double, std::nano>(
+                                    std::chrono::steady_clock::now() -
+                                    arrival_time)
+                                    .count();
+      }
+    });
+  }
+  for (std::thread& thread : threads) thread.join();
+  const double duration_s = std::chrono::duration<double>(
+                                std::chrono::steady_clock::now() - start_time)
+                                .count();
+  iree_status_t status = iree_ok_status();
+  for (iree_status_t& worker_status : worker_statuses) {
+    status = iree_status_join(status, worker_status);
+  }
+  IREE_RETURN_IF_ERROR(status);
+
+  double unit_scale = 1e-6;
+  const char* unit_string = kMillisecondsUnitString;
+  if (FLAG_time_unit.first) {
+    switch (FLAG_time_unit.second) {
+      case benchmark::kMicrosecond:
+        unit_scale = 1e-3;
+        unit_string = kMicrosecondsUnitString;
+        break;
+      case benchmark::kNanosecond:
+        unit_scale = 1.0;
+        unit_string = kNanosecondsUnitString;
+        break;
+      default:
+        break;
+    }
+  }
+  std::vector<double> sorted_latencies = latencies_ns;
+  std::sort(sorted_latencies.begin(), sorted_latencies.end());
+  double mean_ns = 0.0;
+  for (double latency_ns : sorted_latencies) mean_ns += latency_ns;
+  mean_ns /= sorted_latencies.size();
+
+  fprintf(stdout,
+          "Open-loop BM_%s: %d requests, %s arrivals at %.2f qps, "
+          "%d contexts\n",
+          function_name.c_str(), FLAG_open_loop_requests,
+          poisson ? "poisson" : "fixed", FLAG_target_qps,
+          FLAG_open_loop_concurrency);
+  fprintf(stdout, "  achieved throughput: %.2f qps over %.3f s\n",
+          sorted_latencies.size() / duration_s, duration_s);
+  fprintf(stdout, "  latency (%s):\n", unit_string);
+  fprintf(stdout, "    mean %12.3f\n", mean_ns * unit_scale);
+  for (double percentile : {50.0, 90.0, 99.0, 99.9}) {
+    fprintf(stdout, "    p%-4g%12.3f\n", percentile,
+            NearestRankPercentile(sorted_latencies, percentile) * unit_scale);
+  }
+  fprintf(stdout, "    max  %12.3f\n",
+          sorted_latencies.back() * unit_scale);
+  return iree_ok_status();
+}
+
 // The lifetime of IREEBenchmark should be as long as
 // ::benchmark::RunSpecifiedBenchmarks() where the resources are used during
 // benchmarking.
@@ -437,6 +685,11 @@ class IREEBenchmark {
 
     // Order matters. Tear down modules first to release resources.
     inputs_.reset();
+    // Executables are released with the context so their statistics must be
+    // printed prior.
+    if (FLAG_print_statistics) {
+      IREE_IGNORE_ERROR(iree_hal_local_executable_statistics_fprint(stderr));
+    }
     context_.reset();
     main_module_.reset();
     instance_.reset();
@@ -460,7 +713,14 @@ class IREEBenchmark {
     }
 
     auto function_name = std::string(FLAG_entry_function);
-    if (!function_name.empty()) {
+    if (FLAG_target_qps > 0.0) {
+      if (function_name.empty()) {
+        return iree_make_status(IREE_STATUS_INVALID_ARGUMENT,
+                                "open-loop mode (--target_qps=) requires an "
+                                "--entry_function=");
+      }
+      return PrepareOpenLoopFunction(function_name);
+    } else if (!function_name.empty()) {
       IREE_RETURN_IF_ERROR(RegisterSpecificFunction(function_name));
     } else {
       IREE_RETURN_IF_ERROR(RegisterAllExportedFunctions());
@@ -468,6 +728,17 @@ class IREEBenchmark {
     return iree_ok_status();
   }
 
+  // Returns true if --target_qps= selected the open-loop mode, in which case
+  // RunOpenLoop is used in place of the registered benchmarks.
+  bool is_open_loop() const { return FLAG_target_qps > 0.0; }
+
+  iree_status_t RunOpenLoop() {
+    IREE_TRACE_SCOPE0("IREEBenchmark::RunOpenLoop");
+    return iree::RunOpenLoop(std::string(FLAG_entry_function), device_.get(),
+                             context_.get(), open_loop_function_,
+                             open_loop_is_async_, inputs_.get());
+  }
+
  private:
   iree_status_t Init() {
     IREE_TRACE_SCOPE0("IREEBenchmark::Init");
@@ -519,6 +790,24 @@ class IREEBenchmark {
     return iree_ok_status();
   }
 
+  iree_status_t PrepareOpenLoopFunction(const std::string& function_name) {
+    IREE_TRACE_SCOPE0("IREEBenchmark::PrepareOpenLoopFunction");
+    IREE_RETURN_IF_ERROR(iree_vm_module_lookup_function_by_name(
+        main_module_.get(), IREE_VM_FUNCTION_LINKAGE_EXPORT,
+        iree_string_view_t{function_name.data(), function_name.size()},
+        &open_loop_function_));
+    IREE_RETURN_IF_ERROR(ParseToVariantList(
+        device_allocator_.get(),
+        iree::span<const std::string>{FLAG_function_inputs.data(),
+                                      FLAG_function_inputs.size()},
+        iree_vm_instance_allocator(instance_.get()), &inputs_));
+    iree_string_view_t invocation_model = iree_vm_function_lookup_attr_by_name(
+        &open_loop_function_, IREE_SV("iree.abi.model"));
+    open_loop_is_async_ =
+        iree_string_view_equal(invocation_model, IREE_SV("coarse-fences"));
+    return iree_ok_status();
+  }
+
   iree_status_t RegisterAllExportedFunctions() {
     IREE_TRACE_SCOPE0("IREEBenchmark::RegisterAllExportedFunctions");
     iree_vm_module_signature_t signature =
@@ -594,6 +883,8 @@ class IREEBenchmark {
   iree::vm::ref<iree_hal_allocator_t> device_allocator_;
   iree::vm::ref<iree_vm_module_t> main_module_;
   iree::vm::ref<iree_vm_list_t> inputs_;
+  iree_vm_function_t open_loop_function_ = {};
+  bool open_loop_is_async_ = false;
 };
 }  // namespace
 }  // namespace iree
@@ -607,6 +898,11 @@ int main(int argc, char** argv) {
                            &argc, &argv);
   ::benchmark::Initialize(&argc, argv);
 
+  // Executables only record per-export statistics if enabled when loaded.
+  if (FLAG_print_statistics) {
+    iree_hal_local_executable_set_statistics_enabled(true);
+  }
+
   iree::IREEBenchmark iree_benchmark;
   iree_status_t status = iree_benchmark.Register();
   if (!iree_status_is_ok(status)) {
@@ -615,7 +911,16 @@ int main(int argc, char** argv) {
     return ret;
   }
   IREE_CHECK_OK(iree_hal_begin_profiling_from_flags(iree_benchmark.device()));
-  ::benchmark::RunSpecifiedBenchmarks();
+  if (iree_benchmark.is_open_loop()) {
+    status = iree_benchmark.RunOpenLoop();
+  } else {
+    ::benchmark::RunSpecifiedBenchmarks();
+  }
   IREE_CHECK_OK(iree_hal_end_profiling_from_flags(iree_benchmark.device()));
+  if (!iree_status_is_ok(status)) {
+    int ret = static_cast<int>(iree_status_code(status));
+    printf("%s\n", iree::Status(std::move(status)).ToString().c_str());
+    return ret;
+  }
   return 0;
 }
@@ -6,6 +6,22 @@
 
 // DISCLAIMER: this is leaky under error conditions as it's a benchmark tool and
 // not a correctness test.
+//
+// Calls are replayed in trace order. A call event may specify an integer
+// `stream` to model multiple independent sessions (such as interleaved prefill
+// and decode requests of a stateful LLM) sharing the loaded program:
+//   type: call
+//   function: module.decode
+//   stream: 1
+//   args: ...
+// Calls within a stream run in order while distinct streams each run on
+// their own thread concurrently with all others. Every stream besides the
+// default (0) uses a context forked from the one loaded by the trace so that
+// module globals (such as KV caches) are private to the stream.
+//
+// --timeline_output= writes the begin/end time of every call made during the
+// final benchmark iteration as Chrome trace event JSON (chrome://tracing or
+// https://ui.perfetto.dev) with one track per stream.
 
 #include <stdio.h>
 #include <stdlib.h>
@@ -14,6 +30,7 @@
 #include "iree/base/api.h"
 #include "iree/base/internal/flags.h"
 #include "iree/base/internal/path.h"
+#include "iree/base/internal/threading.h"
 #include "iree/hal/api.h"
 #include "iree/testing/benchmark.h"
 #include "iree/tooling/device_util.h"
@@ -28,6 +45,10 @@ IREE_FLAG(int32_t, call_iterations, 1,
           "Number of times to invoke each call in the trace. May break usage "
           "with stateful models.");
 
+IREE_FLAG(string, timeline_output, "",
+          "Writes the per-call timeline of the final benchmark iteration of "
+          "each trace to the given file as Chrome trace event JSON.");
+
 // A benchmark registration for each file to run.
 typedef struct iree_replay_benchmark_registration_t {
   iree_benchmark_def_t benchmark_def;  // Must be first.
@@ -38,6 +59,10 @@ typedef struct iree_replay_benchmark_registration_t {
   // Shared VM instance. Unowned; callers must retain for the valid lifetime of
   // the registration.
   iree_vm_instance_t* instance;
+  // Index of the registration used as the process ID in the timeline.
+  int index;
+  // Chrome trace events of the final iteration of the most recent run.
+  iree_string_builder_t timeline_events;
 } iree_replay_benchmark_registration_t;
 
 // A parsed call event from the trace file.
@@ -45,13 +70,38 @@ typedef struct iree_replay_benchmark_call_t {
   iree_vm_function_t function;
   iree_vm_list_t* input_list;
   iree_vm_list_t* output_list;
+  // Index of the stream the call is made on in the stream list.
+  iree_host_size_t stream_index;
+  // Time range of the most recent invocation.
+  iree_time_t start_time_ns;
+  iree_time_t end_time_ns;
 } iree_replay_benchmark_call_t;
 
-// A growable list of calls.
+// An independent sequence of calls executed concurrently with other streams.
+typedef struct iree_replay_benchmark_stream_t {
+  // Stream ID as specified in the trace.
+  int32_t id;
+  // Context the calls of the stream are made against. Forked from the replay
+  // context for all but the default stream. Retained.
+  iree_vm_context_t* context;
+  // Host allocator used for invocations.
+  iree_allocator_t host_allocator;
+  // Calls of the whole trace; only those on this stream are made.
+  struct iree_replay_benchmark_call_list_t* call_list;
+  // Index of this stream in the call list.
+  iree_host_size_t index;
+  // Result of the most recent run of the stream.
+  iree_status_t status;
+} iree_replay_benchmark_stream_t;
+
+// A growable list of calls along with the streams they are made on.
 typedef struct iree_replay_benchmark_call_list_t {
   size_t count;
   size_t capacity;
   iree_replay_benchmark_call_t* items;
+  size_t stream_count;
+  size_t stream_capacity;
+  iree_replay_benchmark_stream_t* streams;
 } iree_replay_benchmark_call_list_t;
 
 // Initializes |out_list| with an initial allocation.
@@ -61,6 +111,13 @@ static void iree_replay_benchmark_call_list_initialize(
   out_list->capacity = 32;
   out_list->items = (iree_replay_benchmark_call_t*)malloc(
       out_list->capacity * sizeof(*out_list->items));
+  // The default stream always exists and is first so that it runs on the
+  // benchmark thread.
+  out_list->stream_count = 1;
+  out_list->stream_capacity = 4;
+  out_list->streams = (iree_replay_benchmark_stream_t*)malloc(
+      out_list->stream_capacity * sizeof(*out_list->streams));
+  memset(&out_list->streams[0], 0, sizeof(out_list->streams[0]));
 }
 
 // Deinitializes |list| and frees all call resources.
@@ -72,6 +129,10 @@ static void iree_replay_benchmark_call_list_deinitialize(
     iree_vm_list_release(list->items[i].output_list);
   }
   free(list->items);
+  for (size_t i = 0; i < list->stream_count; ++i) {
+    iree_vm_context_release(list->streams[i].context);
+  }
+  free(list->streams);
   memset(list, 0, sizeof(*list));
 }
 
@@ -88,6 +149,23 @@ iree_replay_benchmark_call_list_acquire_back(
   return &list->items[list->count++];
 }
 
+// Returns the index of the stream with |id| in |list|, adding it if needed.
+static iree_host_size_t iree_replay_benchmark_call_list_find_stream(
+    iree_replay_benchmark_call_list_t* list, int32_t id) {
+  for (size_t i = 0; i < list->stream_count; ++i) {
+    if (list->streams[i].id == id) return i;
+  }
+  if (list->stream_count >= list->stream_capacity) {
+    list->stream_capacity *= 2;
+    list->streams = (iree_replay_benchmark_stream_t*)realloc(
+        list->streams, list->stream_capacity * sizeof(*list->streams));
+  }
+  iree_replay_benchmark_stream_t* stream = &list->streams[list->stream_count];
+  memset(stream, 0, sizeof(*stream));
+  stream->id = id;
+  return list->stream_count++;
+}
+
 // Processes a call trace event by preparing the inputs and appending it to the
 // provided |call_list|.
 static iree_status_t iree_replay_benchmark_prepare_call(
@@ -102,6 +180,22 @@ static iree_status_t iree_replay_benchmark_prepare_call(
   IREE_RETURN_IF_ERROR(iree_trace_replay_event_call_prepare(
       replay, document, event_node, &call->function, &call->input_list));
 
+  // Calls without a stream are made on the default stream 0.
+  yaml_node_t* stream_node = NULL;
+  IREE_RETURN_IF_ERROR(iree_yaml_mapping_try_find(
+      document, event_node, iree_make_cstring_view("stream"), &stream_node));
+  int32_t stream_id = 0;
+  if (stream_node &&
+      (stream_node->type != YAML_SCALAR_NODE ||
+       !iree_string_view_atoi_int32(iree_yaml_node_as_string(stream_node),
+                                    &stream_id))) {
+    return iree_make_status(IREE_STATUS_INVALID_ARGUMENT,
+                            "(%zu): expected an integer stream",
+                            stream_node->start_mark.line);
+  }
+  call->stream_index =
+      iree_replay_benchmark_call_list_find_stream(call_list, stream_id);
+
   // To avoid allocations in the inner benchmark loop we preallocate the outputs
   // here. To avoid a memory leak we'll need to trim it as soon as the call
   // returns as otherwise the list is retained for the lifetime of the
@@ -188,12 +282,102 @@ static iree_status_t iree_replay_benchmark_load_trace(
   return status;
 }
 
+// Makes the calls on |stream| in trace order, each FLAG_call_iterations times.
+static iree_status_t iree_replay_benchmark_run_stream(
+    iree_replay_benchmark_stream_t* stream) {
+  iree_replay_benchmark_call_list_t* call_list = stream->call_list;
+  for (size_t i = 0; i < call_list->count; ++i) {
+    iree_replay_benchmark_call_t* call = &call_list->items[i];
+    if (call->stream_index != stream->index) continue;
+    for (int32_t j = 0; j < FLAG_call_iterations; ++j) {
+      call->start_time_ns = iree_time_now();
+      IREE_RETURN_IF_ERROR(iree_vm_invoke(
+          stream->context, call->function, IREE_VM_INVOCATION_FLAG_NONE,
+          /*policy=*/NULL, call->input_list, call->output_list,
+          stream->host_allocator));
+      call->end_time_ns = iree_time_now();
+      IREE_RETURN_IF_ERROR(iree_vm_list_resize(call->output_list, 0));
+    }
+  }
+  return iree_ok_status();
+}
+
+static int iree_replay_benchmark_stream_thread_main(void* entry_arg) {
+  iree_replay_benchmark_stream_t* stream =
+      (iree_replay_benchmark_stream_t*)entry_arg;
+  stream->status = iree_replay_benchmark_run_stream(stream);
+  return 0;
+}
+
+// Runs all streams in |call_list| to completion. The first stream runs on the
+// calling thread and all others on their own threads.
+static iree_status_t iree_replay_benchmark_run_streams(
+    iree_replay_benchmark_call_list_t* call_list) {
+  iree_host_size_t thread_count = 0;
+  iree_thread_t** threads = (iree_thread_t**)malloc(
+      call_list->stream_count * sizeof(*threads));
+  iree_status_t status = iree_ok_status();
+  for (size_t i = 1; i < call_list->stream_count; ++i) {
+    iree_replay_benchmark_stream_t* stream = &call_list->streams[i];
+    stream->status = iree_ok_status();
+    iree_thread_create_params_t params;
+    memset(&params, 0, sizeof(params));
+    params.name = iree_make_cstring_view("iree-replay-stream");
+    status = iree_thread_create(iree_replay_benchmark_stream_thread_main,
+                                stream, params, stream->host_allocator,
+                                &threads[thread_count]);
+    if (!iree_status_is_ok(status)) break;
+    ++thread_count;
+  }
+  if (iree_status_is_ok(status)) {
+    status = iree_replay_benchmark_run_stream(&call_list->streams[0]);
+  }
+  // Releasing the threads joins them.
+  for (iree_host_size_t i = 0; i < thread_count; ++i) {
+    iree_thread_release(threads[i]);
+    status = iree_status_join(status, call_list->streams[i + 1].status);
+  }
+  free(threads);
+  return status;
+}
+
+// Replaces the timeline of |registration| with the times of the most recent
+// invocation of each call in |call_list| relative to |base_time_ns|.
+static iree_status_t iree_replay_benchmark_record_timeline(
+    iree_replay_benchmark_registration_t* registration,
+    iree_replay_benchmark_call_list_t* call_list, iree_time_t base_time_ns) {
+  iree_string_builder_t* builder = &registration->timeline_events;
+  iree_string_builder_deinitialize(builder);
+  iree_string_builder_initialize(iree_allocator_system(), builder);
+  for (size_t i = 0; i < call_list->stream_count; ++i) {
+    IREE_RETURN_IF_ERROR(iree_string_builder_append_format(
+        builder,
+        "%s{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":%d,"
+        "\"tid\":%d,\"args\":{\"name\":\"stream %d\"}}",
+        iree_string_builder_size(builder) ? ",\n" : "", registration->index,
+        call_list->streams[i].id, call_list->streams[i].id));
+  }
+  for (size_t i = 0; i < call_list->count; ++i) {
+    iree_replay_benchmark_call_t* call = &call_list->items[i];
+    iree_string_view_t name = iree_vm_function_name(&call->function);
+    IREE_RETURN_IF_ERROR(iree_string_builder_append_format(
+        builder,
+        ",\n{\"name\":\"%.*s\",\"ph\":\"X\",\"pid\":%d,\"tid\":%d,"
+        "\"ts\":%.3f,\"dur\":%.3f}",
+        (int)name.size, name.data, registration->index,
+        call_list->streams[call->stream_index].id,
+        (call->start_time_ns - base_time_ns) / 1000.0,
+        (call->end_time_ns - call->start_time_ns) / 1000.0));
+  }
+  return iree_ok_status();
+}
+
 // Benchmark function that runs a trace file.
 static iree_status_t iree_replay_benchmark_run_file(
     const iree_benchmark_def_t* benchmark_def,
     iree_benchmark_state_t* benchmark_state) {
-  const iree_replay_benchmark_registration_t* registration =
-      (const iree_replay_benchmark_registration_t*)benchmark_def->user_data;
+  iree_replay_benchmark_registration_t* registration =
+      (iree_replay_benchmark_registration_t*)benchmark_def->user_data;
 
   // Setup replay state used for this benchmark.
   iree_trace_replay_t replay;
@@ -217,19 +401,35 @@ static iree_status_t iree_replay_benchmark_run_file(
   IREE_RETURN_IF_ERROR(iree_replay_benchmark_load_trace(registration->file_path,
                                                         &replay, &call_list));
 
-  // Call the functions within the trace in order.
+  // The default stream uses the replay context directly while all others get
+  // their own fork of it so they don't share module state.
+  if (call_list.stream_count > 1) {
+    IREE_RETURN_IF_ERROR(iree_vm_context_freeze(replay.context));
+  }
+  for (size_t i = 0; i < call_list.stream_count; ++i) {
+    iree_replay_benchmark_stream_t* stream = &call_list.streams[i];
+    stream->host_allocator = replay.host_allocator;
+    stream->call_list = &call_list;
+    stream->index = i;
+    if (i == 0) {
+      stream->context = replay.context;
+      iree_vm_context_retain(stream->context);
+    } else {
+      IREE_RETURN_IF_ERROR(iree_vm_context_fork(
+          replay.context, replay.host_allocator, &stream->context));
+    }
+  }
+
+  // Call the functions within the trace in order on each stream.
+  iree_time_t iteration_start_time_ns = 0;
   while (iree_benchmark_keep_running(benchmark_state,
                                      /*batch_count=*/FLAG_call_iterations)) {
-    for (size_t i = 0; i < call_list.count; ++i) {
-      iree_replay_benchmark_call_t* call = &call_list.items[i];
-      for (int32_t j = 0; j < FLAG_call_iterations; ++j) {
-        IREE_RETURN_IF_ERROR(iree_vm_invoke(
-            replay.context, call->function, IREE_VM_INVOCATION_FLAG_NONE,
-            /*policy=*/NULL, call->input_list, call->output_list,
-            replay.host_allocator));
-        IREE_RETURN_IF_ERROR(iree_vm_list_resize(call->output_list, 0));
-      }
-    }
+    iteration_start_time_ns = iree_time_now();
+    IREE_RETURN_IF_ERROR(iree_replay_benchmark_run_streams(&call_list));
+  }
+  if (strlen(FLAG_timeline_output) > 0) {
+    IREE_RETURN_IF_ERROR(iree_replay_benchmark_record_timeline(
+        registration, &call_list, iteration_start_time_ns));
   }
 
   iree_replay_benchmark_call_list_deinitialize(&call_list);
@@ -241,7 +441,8 @@ static iree_status_t iree_replay_benchmark_run_file(
 }
 
 // Registers benchmarks for each trace file.
-static void iree_replay_benchmark_register_trace_files(
+static iree_replay_benchmark_registration_t*
+iree_replay_benchmark_register_trace_files(
     int file_count, char** file_paths, iree_vm_instance_t* instance) {
   static iree_replay_benchmark_registration_t* registrations = NULL;
   if (!registrations) free(registrations);
@@ -253,6 +454,9 @@ static void iree_replay_benchmark_register_trace_files(
     registrations[i].root_path = iree_file_path_dirname(file_path);
     registrations[i].file_path = file_path;
     registrations[i].instance = instance;
+    registrations[i].index = i;
+    iree_string_builder_initialize(iree_allocator_system(),
+                                   &registrations[i].timeline_events);
     registrations[i].benchmark_def = (iree_benchmark_def_t){
         .flags = IREE_BENCHMARK_FLAG_MEASURE_PROCESS_CPU_TIME |
                  IREE_BENCHMARK_FLAG_USE_REAL_TIME,
@@ -265,6 +469,32 @@ static void iree_replay_benchmark_register_trace_files(
     iree_benchmark_register(iree_file_path_stem(file_path),
                             &registrations[i].benchmark_def);
   }
+  return registrations;
+}
+
+// Writes the timelines recorded by each of the |file_count| |registrations| to
+// FLAG_timeline_output.
+static iree_status_t iree_replay_benchmark_write_timeline(
+    int file_count, iree_replay_benchmark_registration_t* registrations) {
+  FILE* file = fopen(FLAG_timeline_output, "wb");
+  if (!file) {
+    return iree_make_status(iree_status_code_from_errno(errno),
+                            "failed to open timeline file '%s'",
+                            FLAG_timeline_output);
+  }
+  fprintf(file, "{\"traceEvents\":[\n");
+  bool first = true;
+  for (int i = 0; i < file_count; ++i) {
+    iree_string_builder_t* builder = &registrations[i].timeline_events;
+    if (!iree_string_builder_size(builder)) continue;
+    fprintf(file, "%s%.*s", first ? "" : ",\n",
+            (int)iree_string_builder_size(builder),
+            iree_string_builder_buffer(builder));
+    first = false;
+  }
+  fprintf(file, "\n]}\n");
+  fclose(file);
+  return iree_ok_status();
 }
 
 int main(int argc, char** argv) {
@@ -284,8 +514,13 @@ int main(int argc, char** argv) {
   IREE_CHECK_OK(iree_vm_instance_create(iree_allocator_system(), &instance));
 
   // Register a benchmark per file provided and run them.
-  iree_replay_benchmark_register_trace_files(argc - 1, argv + 1, instance);
+  iree_replay_benchmark_registration_t* registrations =
+      iree_replay_benchmark_register_trace_files(argc - 1, argv + 1, instance);
   iree_benchmark_run_specified();
+  if (strlen(FLAG_timeline_output) > 0) {
+    IREE_CHECK_OK(
+        iree_replay_benchmark_write_timeline(argc - 1, registrations));
+  }
 
   iree_vm_instance_release(instance);
   return 0;
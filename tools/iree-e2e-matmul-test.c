@@ -25,6 +25,18 @@
 
 IREE_FLAG(bool, trace_execution, false, "Traces VM execution to stderr.");
 
+IREE_FLAG(int32_t, benchmark_repetitions, 0,
+          "If positive, each matmul that passes its check is then timed over\n"
+          "this many additional invocations and its GFLOP/s are reported.");
+IREE_FLAG(double, benchmark_peak_gflops, 0.0,
+          "Peak compute throughput of the device in GFLOP/s for the element\n"
+          "types under test, used to report a roofline estimate in benchmark\n"
+          "mode. Omitted from the report when 0.");
+IREE_FLAG(double, benchmark_peak_gbps, 0.0,
+          "Peak memory bandwidth of the device in GB/s, used together with\n"
+          "--benchmark_peak_gflops to bound the roofline estimate of\n"
+          "memory-bound shapes. Ignored when 0.");
+
 static const char* emoji(bool good) { return good ? "🦄" : "🐞"; }
 
 /*****************************************************************************
@@ -965,6 +977,102 @@ static iree_status_t do_matmul_and_check_results(
   return status;
 }
 
+// Returns the number of bytes a matmul with the given inputs must at least
+// move: the LHS, RHS, and accumulator are read once and the result written
+// once.
+static double matmul_min_bytes_moved(iree_hal_buffer_view_t* lhs,
+                                     iree_hal_buffer_view_t* rhs,
+                                     iree_hal_buffer_view_t* acc) {
+  return (double)iree_hal_buffer_view_byte_length(lhs) +
+         (double)iree_hal_buffer_view_byte_length(rhs) +
+         2.0 * (double)iree_hal_buffer_view_byte_length(acc);
+}
+
+// Times |FLAG_benchmark_repetitions| invocations of |function| on copies of
+// |original_device_inputs| and prints the achieved GFLOP/s to |file|, along
+// with a roofline estimate if the device peaks were given by flags.
+//
+// This is meant to run after |do_matmul_and_check_results| succeeded, which
+// also serves as the warm-up invocation. Copying the inputs is not timed.
+// Functions use the synchronous invocation model so that the results are
+// ready when iree_vm_invoke returns.
+static iree_status_t benchmark_matmul(FILE* file, iree_trace_replay_t* replay,
+                                      iree_vm_function_t function,
+                                      iree_vm_list_t* original_device_inputs) {
+  if (FLAG_benchmark_repetitions <= 0) return iree_ok_status();
+  iree_hal_allocator_t* device_allocator =
+      iree_hal_device_allocator(replay->device);
+  iree_hal_buffer_view_t* lhs = NULL;
+  iree_hal_buffer_view_t* rhs = NULL;
+  iree_hal_buffer_view_t* acc = NULL;
+  IREE_RETURN_IF_ERROR(
+      get_item_as_buffer_view(original_device_inputs, 0, &lhs));
+  IREE_RETURN_IF_ERROR(
+      get_item_as_buffer_view(original_device_inputs, 1, &rhs));
+  IREE_RETURN_IF_ERROR(
+      get_item_as_buffer_view(original_device_inputs, 2, &acc));
+  iree_hal_dim_t m_size, k_size, n_size;
+  IREE_RETURN_IF_ERROR(
+      get_matmul_sizes(lhs, rhs, acc, acc, &m_size, &k_size, &n_size));
+
+  matrix_mask_t none_masks[3] = {MATRIX_MASK_NONE, MATRIX_MASK_NONE,
+                                 MATRIX_MASK_NONE};
+  iree_status_t status = iree_ok_status();
+  iree_duration_t total_ns = 0;
+  iree_duration_t best_ns = IREE_DURATION_INFINITE;
+  for (int32_t i = 0; i < FLAG_benchmark_repetitions; ++i) {
+    iree_vm_list_t* device_inputs = NULL;
+    iree_vm_list_t* device_outputs = NULL;
+    status = mask_and_copy_device_buffer_views_to_device(
+        replay->device, device_allocator, original_device_inputs, none_masks,
+        &device_inputs);
+    if (iree_status_is_ok(status)) {
+      status = iree_vm_list_create(/*element_type=*/NULL,
+                                   /*initial_capacity=*/8,
+                                   replay->host_allocator, &device_outputs);
+    }
+    if (iree_status_is_ok(status)) {
+      iree_time_t start_ns = iree_time_now();
+      status = iree_vm_invoke(replay->context, function,
+                              IREE_VM_INVOCATION_FLAG_NONE,
+                              /*policy=*/NULL, device_inputs, device_outputs,
+                              replay->host_allocator);
+      iree_duration_t duration_ns = iree_time_now() - start_ns;
+      total_ns += duration_ns;
+      if (duration_ns < best_ns) best_ns = duration_ns;
+    }
+    iree_vm_list_release(device_outputs);
+    iree_vm_list_release(device_inputs);
+    if (!iree_status_is_ok(status)) return status;
+  }
+
+  // FLOP per nanosecond is the same as GFLOP/s.
+  double flops = 2.0 * (double)m_size * (double)k_size * (double)n_size;
+  double mean_ns = (double)total_ns / FLAG_benchmark_repetitions;
+  double mean_gflops = flops / mean_ns;
+  double best_gflops = flops / (double)best_ns;
+  fprintf(file,
+          "Benchmark (MxKxN): %" PRIdim "x%" PRIdim "x%" PRIdim
+          ": mean %.3f ms, %.2f GFLOP/s (best %.2f GFLOP/s)",
+          m_size, k_size, n_size, mean_ns * 1e-6, mean_gflops, best_gflops);
+  if (FLAG_benchmark_peak_gflops > 0.0) {
+    // Bytes per FLOP bound the throughput of memory-bound shapes such as
+    // matrix*vector products.
+    double roofline_gflops = FLAG_benchmark_peak_gflops;
+    if (FLAG_benchmark_peak_gbps > 0.0) {
+      double intensity = flops / matmul_min_bytes_moved(lhs, rhs, acc);
+      double memory_bound_gflops = intensity * FLAG_benchmark_peak_gbps;
+      if (memory_bound_gflops < roofline_gflops) {
+        roofline_gflops = memory_bound_gflops;
+      }
+    }
+    fprintf(file, ", roofline %.2f GFLOP/s (%.0f%%)", roofline_gflops,
+            100.0 * best_gflops / roofline_gflops);
+  }
+  fprintf(file, "\n");
+  return iree_ok_status();
+}
+
 const char* matrix_form(matrix_mask_t mask) {
   switch (mask) {
     case MATRIX_MASK_NONE:
@@ -1081,6 +1189,10 @@ static iree_status_t replay_event_call_matmul(iree_trace_replay_t* replay,
     iree_string_builder_deinitialize(&sb);
   }
 
+  if (iree_status_is_ok(status) && FLAG_benchmark_repetitions > 0) {
+    status = benchmark_matmul(stderr, replay, function, device_inputs);
+  }
+
   // Clean up.
   iree_vm_list_release(device_inputs);
 
@@ -70,6 +70,8 @@ IREE_FLAG_CALLBACK(
     "  2x2xi32=@some/file.bin\n"
     "numpy npy files (from numpy.save) can be read to provide 1+ values:\n"
     "  @some.npy\n"
+    "as can uncompressed npz archives (from numpy.savez) in archive order:\n"
+    "  @some.npz\n"
     "Each occurrence of the flag indicates an input in the order they were\n"
     "specified on the command line.");
 
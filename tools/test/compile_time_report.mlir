@@ -0,0 +1,20 @@
+// RUN: iree-compile --iree-hal-target-backends=vmvx --compile-time-report --compile-time-report-limit=0 -o /dev/null %s 2>&1 | FileCheck %s --check-prefix=REPORT
+// REPORT: IREE compile-time report
+// REPORT: Total pass time:
+// REPORT: Pass
+// Passes that only run nested pipelines are attributed to their nested passes.
+// REPORT-NOT: iree-hal-translate-executables
+// REPORT: canonicalize
+// REPORT-NOT: iree-hal-translate-executables
+// REPORT: Top-level symbol
+// REPORT-DAG: @abs_dispatch_0
+// REPORT-DAG: @abs
+
+// RUN: (iree-compile --iree-hal-target-backends=llvm-cpu --iree-llvm-codegen-partitions=4 %s | iree-run-module --device=local-task --entry_function=abs --function_input=f32=-2) | FileCheck %s --check-prefix=PARTITIONED
+
+// PARTITIONED-LABEL: EXEC @abs
+func.func @abs(%input : tensor<f32>) -> (tensor<f32>) {
+  %result = math.absf %input : tensor<f32>
+  return %result : tensor<f32>
+}
+// PARTITIONED: f32=2
@@ -0,0 +1,20 @@
+// Compiling twice with the same cache must produce identical modules with the
+// second compilation reusing the cached translations and binaries.
+
+// RUN: rm -rf %t && iree-compile --iree-hal-target-backends=llvm-cpu --iree-hal-executable-cache-dir=%t %s -o %t.cold.vmfb
+// RUN: iree-compile --iree-hal-target-backends=llvm-cpu --iree-hal-executable-cache-dir=%t %s -o %t.warm.vmfb
+// RUN: cmp %t.cold.vmfb %t.warm.vmfb
+// RUN: ls %t | FileCheck %s --check-prefix=ENTRIES
+// RUN: iree-run-module --device=local-task --module=%t.warm.vmfb --entry_function=abs --function_input=f32=-2 | FileCheck %s
+
+// One translation entry per dispatch and one serialization entry for the
+// linked executable.
+// ENTRIES-COUNT-2: {{^[0-9a-f]{64}\.mlir$}}
+// ENTRIES-NOT: .tmp
+
+// CHECK-LABEL: EXEC @abs
+func.func @abs(%input : tensor<f32>) -> (tensor<f32>) {
+  %result = math.absf %input : tensor<f32>
+  return %result : tensor<f32>
+}
+// CHECK: f32=2